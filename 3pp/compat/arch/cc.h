@@ -57,8 +57,11 @@ typedef uintptr_t          mem_ptr_t;
 #define PACK_STRUCT_FIELD(fld) fld
 #define ALIGNED(n)  __attribute__((aligned (n)))
 
-/* Used with IP headers only */
-#define LWIP_CHKSUM_ALGORITHM   1
+/* Checksum all packets with the word-at-a-time routine in
+   src/inet/inet.c instead of lwIP's portable byte-wise ones. */
+#define LWIP_CHKSUM(dataptr, len) inet_checksum_sum(dataptr, len)
+
+uint16_t inet_checksum_sum(const void *buf_p, size_t size);
 
 #define LWIP_PLATFORM_DIAG(msg)
 #define LWIP_PLATFORM_ASSERT(flag)
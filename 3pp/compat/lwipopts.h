@@ -67,6 +67,13 @@
 #    define LWIP_CHECKSUM_ON_COPY       0
 #endif
 
+/* Set to 1 to let sockets call the stack directly from the calling
+ * thread with the core lock taken, instead of passing a message to
+ * the tcpip thread for each operation. */
+#ifndef LWIP_TCPIP_CORE_LOCKING
+#    define LWIP_TCPIP_CORE_LOCKING     0
+#endif
+
 /* TCP/IP stack configuration. */
 
 #ifndef LWIP_RAW
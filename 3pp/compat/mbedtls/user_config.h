@@ -51,4 +51,13 @@
 
 #define MBEDTLS_AES_ROM_TABLES
 
+/* Smaller record buffers, see CONFIG_SSL_MAX_FRAGMENT_LENGTH. */
+#include "config.h"
+
+#if defined(CONFIG_SSL_MAX_FRAGMENT_LENGTH)
+#    if CONFIG_SSL_MAX_FRAGMENT_LENGTH > 0
+#        define MBEDTLS_SSL_MAX_CONTENT_LEN CONFIG_SSL_MAX_FRAGMENT_LENGTH
+#    endif
+#endif
+
 #endif
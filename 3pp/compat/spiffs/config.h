@@ -125,6 +125,13 @@
 // SPIFFS_LOCK and SPIFFS_UNLOCK protects spiffs from reentrancy on api level
 // These should be defined on a multithreaded system
 
+// Simba hooks, serializing api calls and updating the debug file
+// system counters.
+#if (CONFIG_SPIFFS_GC_THREAD == 1) || (CONFIG_SPIFFS_COUNTERS == 1)
+#define SPIFFS_LOCK(fs)                 spiffs_lock(fs)
+#define SPIFFS_UNLOCK(fs)               spiffs_unlock(fs)
+#endif
+
 // define this to enter a mutex if you're running on a multithreaded system
 #ifndef SPIFFS_LOCK
 #define SPIFFS_LOCK(fs)
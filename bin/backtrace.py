@@ -28,9 +28,31 @@ IGNORED_FUNCTIONS = [
     '_start'
 ]
 
-RE_BACKTRACE_ADDRESS = re.compile(r'^(: )(0x[0-9a-f]+)')
+RE_BACKTRACE_ADDRESS = re.compile(r'^(: )(0x[0-9a-f]+)(.*)')
 RE_BACKTRACE_HEADER = re.compile(
-    r'^(Backtrace|Mock \w+ backtrace) \(most recent call first\):')
+    r'^(Backtrace|Mock \w+ backtrace|Heap \S+ trace) '
+    r'\(most recent call first\):')
+
+
+def addr2line(program_name, cross_compile, addresses):
+    """Returns a list of 'function at file:line' strings, one per given
+    address.
+
+    """
+
+    if not addresses:
+        return []
+
+    command = [
+        cross_compile + 'addr2line',
+        '-f',
+        '-p',
+        '-e', program_name
+    ]
+    command += addresses
+    output = subprocess.check_output(command).decode('utf-8')
+
+    return output.splitlines()
 
 
 def print_backtrace_lines(backtrace_lines):
@@ -69,14 +91,16 @@ def main():
             if mo:
                 line = mo.group(1)
                 address = mo.group(2)
-                command = [
-                    cross_compile + 'addr2line',
-                    '-f',
-                    '-p',
-                    '-e', program_name,
-                    address
-                ]
-                line += subprocess.check_output(command).decode('utf-8')
+                rest = mo.group(3).strip()
+                line += addr2line(program_name,
+                                  cross_compile,
+                                  [address])[0] + '\n'
+
+                # Keep any text after the address, for example the
+                # buffer of a heap trace entry.
+                if rest:
+                    line = line.rstrip('\n') + ' (' + rest + ')\n'
+
                 backtrace_lines.append(line)
             else:
                 print_backtrace_lines(backtrace_lines)
@@ -0,0 +1,144 @@
+#!/usr/bin/env python
+#
+# Save benchmark results printed by harness_run_benchmarks() as a
+# baseline, and compare later runs against it.
+#
+
+from __future__ import print_function
+
+import sys
+import argparse
+import json
+import re
+
+
+RE_BENCHMARK = re.compile(r'^benchmark: (\S+): iterations\((\d+)\), '
+                          r'min\(([\d.]+)\), median\(([\d.]+)\), '
+                          r'p99\(([\d.]+)\)')
+
+STATISTICS = ['min', 'median', 'p99']
+
+
+def parse_output(filename):
+    """Parse benchmark results from given test output file.
+
+    """
+
+    benchmarks = {}
+
+    with open(filename) as fin:
+        for line in fin:
+            mo = RE_BENCHMARK.match(line.strip())
+
+            if not mo:
+                continue
+
+            benchmarks[mo.group(1)] = {
+                'iterations': int(mo.group(2)),
+                'min': float(mo.group(3)),
+                'median': float(mo.group(4)),
+                'p99': float(mo.group(5))
+            }
+
+    return benchmarks
+
+
+def do_save(args):
+    benchmarks = parse_output(args.outfile)
+
+    if not benchmarks:
+        sys.exit('error: no benchmarks found in ' + args.outfile)
+
+    with open(args.baseline, 'w') as fout:
+        json.dump(benchmarks, fout, indent=4, sort_keys=True)
+        fout.write('\n')
+
+    print('Saved {} benchmark(s) to {}.'.format(len(benchmarks),
+                                               args.baseline))
+
+
+def do_compare(args):
+    benchmarks = parse_output(args.outfile)
+
+    with open(args.baseline) as fin:
+        baseline = json.load(fin)
+
+    regressions = 0
+    fmt = '{:32} {:>12} {:>12} {:>8}  {}'
+
+    print(fmt.format('NAME', 'BASELINE', 'CURRENT', 'CHANGE', ''))
+
+    for name in sorted(set(baseline) | set(benchmarks)):
+        if name not in benchmarks:
+            print(fmt.format(name, '', '', '', 'MISSING'))
+            continue
+
+        current = benchmarks[name][args.statistic]
+
+        if name not in baseline:
+            print(fmt.format(name, '', current, '', 'NEW'))
+            continue
+
+        previous = baseline[name][args.statistic]
+
+        if previous > 0:
+            change = 100.0 * (current - previous) / previous
+        else:
+            change = 0.0
+
+        if change > args.threshold:
+            status = 'REGRESSION'
+            regressions += 1
+        elif change < -args.threshold:
+            status = 'IMPROVEMENT'
+        else:
+            status = ''
+
+        print(fmt.format(name,
+                         previous,
+                         current,
+                         '{:+.1f}%'.format(change),
+                         status))
+
+    if regressions > 0:
+        sys.exit('error: {} benchmark(s) regressed more than {}%.'.format(
+            regressions,
+            args.threshold))
+
+
+def main():
+    parser = argparse.ArgumentParser()
+
+    subparsers = parser.add_subparsers()
+
+    save_parser = subparsers.add_parser(
+        'save',
+        help='Save the results in given test output as a baseline.')
+    save_parser.add_argument('outfile', help='Test output file.')
+    save_parser.add_argument('baseline', help='Baseline JSON file.')
+    save_parser.set_defaults(func=do_save)
+
+    compare_parser = subparsers.add_parser(
+        'compare',
+        help='Compare the results in given test output to a baseline.')
+    compare_parser.add_argument(
+        '-t', '--threshold',
+        type=float,
+        default=10.0,
+        help='Regression threshold in percent (default: %(default)s).')
+    compare_parser.add_argument(
+        '-s', '--statistic',
+        choices=STATISTICS,
+        default='median',
+        help='Statistic to compare (default: %(default)s).')
+    compare_parser.add_argument('outfile', help='Test output file.')
+    compare_parser.add_argument('baseline', help='Baseline JSON file.')
+    compare_parser.set_defaults(func=do_compare)
+
+    args = parser.parse_args()
+
+    args.func(args)
+
+
+if __name__ == '__main__':
+    main()
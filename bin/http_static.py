@@ -0,0 +1,157 @@
+#!/usr/bin/env python3
+
+"""Generate a C source file with an array of static files served by
+http_server_route_static().
+
+"""
+
+import os
+import sys
+import argparse
+import gzip
+import hashlib
+import mimetypes
+
+
+HEADER_FMT = '''/**
+ * This file was generated by http_static.py. Do not edit.
+ */
+
+#include "simba.h"
+'''
+
+FILE_FMT = '''
+static const uint8_t {variable}[] = {{
+{data}
+}};
+'''
+
+ENTRY_FMT = '''    {{
+        .path_p = "{path}",
+        .content_type_p = "{content_type}",
+        .etag_p = "\\"{etag}\\"",
+        .flags = {flags},
+        .buf_p = {variable},
+        .size = {size}
+    }},
+'''
+
+FOOTER_FMT = '''
+const struct http_server_static_file_t {name}[] = {{
+{entries}    {{
+        .path_p = NULL
+    }}
+}};
+'''
+
+
+def format_data(data):
+    lines = []
+
+    for i in range(0, len(data), 12):
+        chunk = bytearray(data[i:i + 12])
+        lines.append('    ' + ', '.join(['0x{:02x}'.format(byte)
+                                         for byte in chunk]) + ',')
+
+    return '\n'.join(lines)
+
+
+def compress(data):
+    # A fixed modification time makes the output reproducible.
+    if sys.version_info[0] >= 3:
+        return gzip.compress(data, mtime=0)
+
+    import io
+
+    output = io.BytesIO()
+
+    with gzip.GzipFile(fileobj=output, mode='wb', mtime=0) as fout:
+        fout.write(data)
+
+    return output.getvalue()
+
+
+def find_files(root):
+    paths = []
+
+    for dirpath, _, filenames in os.walk(root):
+        for filename in filenames:
+            paths.append(os.path.join(dirpath, filename))
+
+    return sorted(paths)
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__)
+    parser.add_argument('--name',
+                        default='http_static_files',
+                        help='Name of the generated array.')
+    parser.add_argument('--prefix',
+                        default='/',
+                        help='Request path prefix of all files.')
+    parser.add_argument('--gzip',
+                        action='store_true',
+                        help='Store compressible files gzip compressed.')
+    parser.add_argument('--keep-uncompressed',
+                        action='store_true',
+                        help=('Also store files uncompressed, for clients '
+                              'not accepting gzip.'))
+    parser.add_argument('--output',
+                        required=True,
+                        help='Output C source file.')
+    parser.add_argument('root', help='Directory of files to serve.')
+    args = parser.parse_args()
+
+    prefix = args.prefix.rstrip('/') + '/'
+    files = []
+    entries = []
+
+    for index, filename in enumerate(find_files(args.root)):
+        with open(filename, 'rb') as fin:
+            data = fin.read()
+
+        path = prefix + os.path.relpath(filename, args.root).replace(os.sep,
+                                                                      '/')
+        content_type = mimetypes.guess_type(filename)[0]
+
+        if content_type is None:
+            content_type = 'application/octet-stream'
+
+        variants = []
+
+        if args.gzip:
+            compressed = compress(data)
+
+            if len(compressed) < len(data):
+                variants.append(('compressed', compressed,
+                                 'HTTP_SERVER_STATIC_FILE_GZIP'))
+
+        if not variants or args.keep_uncompressed:
+            variants.append(('plain', data, '0'))
+
+        for suffix, content, flags in variants:
+            etag = hashlib.sha1(content).hexdigest()[:16]
+
+            if content:
+                variable = 'file_{}_{}'.format(index, suffix)
+                files.append(FILE_FMT.format(variable=variable,
+                                             data=format_data(content)))
+            else:
+                variable = 'NULL'
+
+            entries.append(ENTRY_FMT.format(path=path,
+                                            content_type=content_type,
+                                            etag=etag,
+                                            flags=flags,
+                                            variable=variable,
+                                            size=len(content)))
+
+    with open(args.output, 'w') as fout:
+        fout.write(HEADER_FMT)
+        fout.write(''.join(files))
+        fout.write(FOOTER_FMT.format(name=args.name,
+                                     entries=''.join(entries)))
+
+
+if __name__ == '__main__':
+    main()
@@ -0,0 +1,359 @@
+#!/usr/bin/env python
+#
+# HTTP and MQTT request rate load generator. Requests are sent by a
+# number of concurrent clients for a given duration, and the request
+# rate and latency are printed. The latency is also printed in the
+# format of harness_run_benchmarks(), in milliseconds, so the results
+# can be saved and compared with benchmark.py.
+#
+
+from __future__ import print_function
+
+import argparse
+import socket
+import struct
+import threading
+import time
+
+try:
+    from urllib.parse import urlparse
+    from http.client import HTTPConnection
+except ImportError:
+    from urlparse import urlparse
+    from httplib import HTTPConnection
+
+
+MQTT_CONNECT = 0x10
+MQTT_CONNACK = 0x20
+MQTT_PUBLISH = 0x30
+MQTT_PUBACK = 0x40
+MQTT_SUBSCRIBE = 0x82
+MQTT_SUBACK = 0x90
+MQTT_DISCONNECT = 0xe0
+
+
+class Statistics(object):
+
+    def __init__(self):
+        self.lock = threading.Lock()
+        self.latencies = []
+        self.errors = 0
+
+    def add(self, latency):
+        with self.lock:
+            self.latencies.append(latency)
+
+    def add_error(self):
+        with self.lock:
+            self.errors += 1
+
+
+def percentile(values, fraction):
+    return values[min(int(fraction * len(values)), len(values) - 1)]
+
+
+def print_statistics(name, statistics, duration):
+    latencies = sorted(statistics.latencies)
+    requests = len(latencies)
+
+    print('Requests:   {}'.format(requests))
+    print('Errors:     {}'.format(statistics.errors))
+    print('Rate:       {:.1f} requests/s'.format(requests / duration))
+
+    if requests == 0:
+        return
+
+    minimum = 1000 * latencies[0]
+    median = 1000 * percentile(latencies, 0.5)
+    p99 = 1000 * percentile(latencies, 0.99)
+
+    print('Latency:    min {:.3f} ms, median {:.3f} ms, p99 {:.3f} ms'.format(
+        minimum,
+        median,
+        p99))
+    print('benchmark: {}: iterations({}), min({:.3f}), median({:.3f}), '
+          'p99({:.3f})'.format(name, requests, minimum, median, p99))
+
+
+def run_clients(target, args):
+    statistics = Statistics()
+    stop_time = time.time() + args.duration
+    threads = []
+
+    for i in range(args.concurrency):
+        thread = threading.Thread(target=target,
+                                  args=(i, args, stop_time, statistics))
+        thread.daemon = True
+        thread.start()
+        threads.append(thread)
+
+    for thread in threads:
+        thread.join()
+
+    return statistics
+
+
+def http_client(index, args, stop_time, statistics):
+    url = urlparse(args.url)
+    path = url.path or '/'
+
+    if url.query:
+        path += '?' + url.query
+
+    connection = None
+
+    while time.time() < stop_time:
+        try:
+            if connection is None:
+                connection = HTTPConnection(url.hostname,
+                                            url.port or 80,
+                                            timeout=args.timeout)
+
+            start = time.time()
+            connection.request(args.method,
+                               path,
+                               headers={'Connection': ('keep-alive'
+                                                       if args.keep_alive
+                                                       else 'close')})
+            response = connection.getresponse()
+            response.read()
+
+            if response.status >= 400:
+                statistics.add_error()
+            else:
+                statistics.add(time.time() - start)
+
+            if not args.keep_alive:
+                connection.close()
+                connection = None
+        except Exception:
+            statistics.add_error()
+
+            if connection is not None:
+                connection.close()
+                connection = None
+
+    if connection is not None:
+        connection.close()
+
+
+def do_http(args):
+    statistics = run_clients(http_client, args)
+    print_statistics(args.name or 'http_' + args.method.lower(),
+                     statistics,
+                     args.duration)
+
+
+def mqtt_string(value):
+    value = value.encode('utf-8')
+
+    return struct.pack('>H', len(value)) + value
+
+
+def mqtt_packet(packet_type, payload):
+    remaining_length = len(payload)
+    header = bytearray([packet_type])
+
+    while True:
+        byte = (remaining_length % 128)
+        remaining_length //= 128
+
+        if remaining_length > 0:
+            byte |= 0x80
+
+        header.append(byte)
+
+        if remaining_length == 0:
+            break
+
+    return bytes(header) + payload
+
+
+def mqtt_recv_exactly(sock, size):
+    data = b''
+
+    while len(data) < size:
+        chunk = sock.recv(size - len(data))
+
+        if not chunk:
+            raise Exception('Connection closed.')
+
+        data += chunk
+
+    return data
+
+
+def mqtt_recv(sock):
+    packet_type = bytearray(mqtt_recv_exactly(sock, 1))[0]
+    remaining_length = 0
+    multiplier = 1
+
+    while True:
+        byte = bytearray(mqtt_recv_exactly(sock, 1))[0]
+        remaining_length += (byte & 0x7f) * multiplier
+        multiplier *= 128
+
+        if (byte & 0x80) == 0:
+            break
+
+    return packet_type, mqtt_recv_exactly(sock, remaining_length)
+
+
+def mqtt_connect(index, args):
+    host, _, port = args.broker.partition(':')
+    sock = socket.create_connection((host, int(port or 1883)),
+                                    timeout=args.timeout)
+    sock.setsockopt(socket.IPPROTO_TCP, socket.TCP_NODELAY, 1)
+    payload = (mqtt_string('MQTT')
+               + struct.pack('>BBH', 4, 0x02, 60)
+               + mqtt_string('loadgen-{}'.format(index)))
+    sock.sendall(mqtt_packet(MQTT_CONNECT, payload))
+    packet_type, payload = mqtt_recv(sock)
+
+    if packet_type != MQTT_CONNACK or bytearray(payload)[1] != 0:
+        raise Exception('Connection refused.')
+
+    if args.response_topic:
+        payload = (struct.pack('>H', 1)
+                   + mqtt_string(args.response_topic)
+                   + struct.pack('B', args.qos))
+        sock.sendall(mqtt_packet(MQTT_SUBSCRIBE, payload))
+        packet_type, _ = mqtt_recv(sock)
+
+        if packet_type != MQTT_SUBACK:
+            raise Exception('Subscribe failed.')
+
+    return sock
+
+
+def mqtt_wait_for_response(sock, args, packet_id):
+    """Wait for the response of the published message; the PUBACK for
+    QoS 1, or the message on the response topic if given.
+
+    """
+
+    acked = (args.qos == 0)
+    responded = not args.response_topic
+
+    while not (acked and responded):
+        packet_type, payload = mqtt_recv(sock)
+
+        if (packet_type & 0xf0) == MQTT_PUBACK:
+            if struct.unpack('>H', payload[:2])[0] == packet_id:
+                acked = True
+        elif (packet_type & 0xf0) == MQTT_PUBLISH:
+            responded = True
+
+            # Acknowledge QoS 1 messages from the broker.
+            if (packet_type & 0x06) == 0x02:
+                topic_length = struct.unpack('>H', payload[:2])[0]
+                sock.sendall(mqtt_packet(
+                    MQTT_PUBACK,
+                    payload[2 + topic_length:4 + topic_length]))
+
+
+def mqtt_client(index, args, stop_time, statistics):
+    sock = None
+    packet_id = 0
+    message = b'x' * args.size
+
+    while time.time() < stop_time:
+        try:
+            if sock is None:
+                sock = mqtt_connect(index, args)
+
+            packet_id = (packet_id % 65535) + 1
+            payload = mqtt_string(args.topic)
+
+            if args.qos == 1:
+                payload += struct.pack('>H', packet_id)
+
+            start = time.time()
+            sock.sendall(mqtt_packet(MQTT_PUBLISH | (args.qos << 1),
+                                     payload + message))
+            mqtt_wait_for_response(sock, args, packet_id)
+            statistics.add(time.time() - start)
+        except Exception:
+            statistics.add_error()
+
+            if sock is not None:
+                sock.close()
+                sock = None
+
+            # Do not flood a broker that refuses connections.
+            time.sleep(0.1)
+
+    if sock is not None:
+        sock.sendall(mqtt_packet(MQTT_DISCONNECT, b''))
+        sock.close()
+
+
+def do_mqtt(args):
+    statistics = run_clients(mqtt_client, args)
+    print_statistics(args.name or 'mqtt_qos{}'.format(args.qos),
+                     statistics,
+                     args.duration)
+
+
+def main():
+    parser = argparse.ArgumentParser()
+
+    parser.add_argument('-c', '--concurrency',
+                        type=int,
+                        default=1,
+                        help='Number of concurrent clients (default: %(default)s).')
+    parser.add_argument('-d', '--duration',
+                        type=float,
+                        default=10.0,
+                        help='Test duration in seconds (default: %(default)s).')
+    parser.add_argument('-T', '--timeout',
+                        type=float,
+                        default=5.0,
+                        help='Request timeout in seconds (default: %(default)s).')
+    parser.add_argument('-n', '--name',
+                        help='Benchmark name in the output.')
+
+    subparsers = parser.add_subparsers()
+
+    http_parser = subparsers.add_parser(
+        'http',
+        help='Send HTTP requests to given URL.')
+    http_parser.add_argument('-m', '--method',
+                             default='GET',
+                             help='Request method (default: %(default)s).')
+    http_parser.add_argument('-k', '--keep-alive',
+                             action='store_true',
+                             help='Reuse the connection between requests.')
+    http_parser.add_argument('url', help='URL to request.')
+    http_parser.set_defaults(func=do_http)
+
+    mqtt_parser = subparsers.add_parser(
+        'mqtt',
+        help=('Publish messages to given MQTT broker. The latency is the time '
+              'until the PUBACK, or until a message is received on the '
+              'response topic if given, for example from a device echoing '
+              'the messages.'))
+    mqtt_parser.add_argument('-t', '--topic',
+                             default='loadgen/request',
+                             help='Publish topic (default: %(default)s).')
+    mqtt_parser.add_argument('-r', '--response-topic',
+                             help='Topic to wait for a response on.')
+    mqtt_parser.add_argument('-q', '--qos',
+                             type=int,
+                             choices=[0, 1],
+                             default=0,
+                             help='Quality of service (default: %(default)s).')
+    mqtt_parser.add_argument('-s', '--size',
+                             type=int,
+                             default=16,
+                             help='Message size (default: %(default)s).')
+    mqtt_parser.add_argument('broker', help='Broker as <host>[:<port>].')
+    mqtt_parser.set_defaults(func=do_mqtt)
+
+    args = parser.parse_args()
+
+    args.func(args)
+
+
+if __name__ == '__main__':
+    main()
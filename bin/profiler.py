@@ -0,0 +1,248 @@
+#!/usr/bin/env python3
+#
+# Symbolize the output of debug/profiler/print and write folded
+# stacks for flamegraph.pl, and print the functions with most
+# samples.
+#
+
+import os
+import sys
+import re
+import argparse
+import subprocess
+from collections import Counter
+
+sys.path.insert(0, os.path.dirname(os.path.realpath(__file__)))
+
+from backtrace import addr2line
+
+
+RE_SYMBOL = re.compile(r'^symbol (\S+) (0x[0-9a-f]+)')
+RE_THREAD = re.compile(r'^thread (0x[0-9a-f]+) (.*)')
+RE_SAMPLE = re.compile(r'^sample (0x[0-9a-f]+)((?: 0x[0-9a-f]+)+)')
+RE_DROPPED = re.compile(r'^dropped (\d+)')
+
+# Number of addresses given to each addr2line process.
+ADDR2LINE_CHUNK_SIZE = 512
+
+
+class Profile(object):
+
+    def __init__(self):
+        self.symbol = None
+        self.threads = {}
+        self.samples = []
+        self.dropped = 0
+
+
+def parse_output(filename):
+    """Parse the last profile in given file.
+
+    """
+
+    profile = None
+
+    with open(filename, encoding='utf-8', errors='ignore') as fin:
+        for line in fin:
+            line = line.strip()
+
+            if line == 'PROFILER-BEGIN':
+                profile = Profile()
+                continue
+
+            if profile is None:
+                continue
+
+            mo = RE_SAMPLE.match(line)
+
+            if mo:
+                profile.samples.append((int(mo.group(1), 16),
+                                        [int(pc, 16)
+                                         for pc in mo.group(2).split()]))
+                continue
+
+            mo = RE_THREAD.match(line)
+
+            if mo:
+                profile.threads[int(mo.group(1), 16)] = mo.group(2)
+                continue
+
+            mo = RE_SYMBOL.match(line)
+
+            if mo:
+                profile.symbol = (mo.group(1), int(mo.group(2), 16))
+                continue
+
+            mo = RE_DROPPED.match(line)
+
+            if mo:
+                profile.dropped = int(mo.group(1))
+
+    if profile is None:
+        sys.exit('error: no profile found in ' + filename)
+
+    return profile
+
+
+def load_offset(profile, program_name, cross_compile):
+    """Difference between the runtime and link time addresses, non-zero
+    for position independent executables.
+
+    """
+
+    if profile.symbol is None:
+        return 0
+
+    name, address = profile.symbol
+    output = subprocess.check_output([cross_compile + 'nm', program_name])
+
+    for line in output.decode('utf-8').splitlines():
+        items = line.split()
+
+        if len(items) == 3 and items[2] == name:
+            return address - int(items[0], 16)
+
+    return 0
+
+
+def symbolize(profile, program_name, cross_compile, lines):
+    """Returns a dictionary of runtime addresses to function names, or
+    'function (file:line)' if lines is True.
+
+    """
+
+    offset = load_offset(profile, program_name, cross_compile)
+    addresses = set()
+
+    for _, pcs in profile.samples:
+        addresses.add(pcs[0])
+
+        # The line of the call, not the one after it.
+        for pc in pcs[1:]:
+            addresses.add(pc - 1)
+
+    addresses = sorted(addresses)
+    names = {}
+
+    for i in range(0, len(addresses), ADDR2LINE_CHUNK_SIZE):
+        chunk = addresses[i:i + ADDR2LINE_CHUNK_SIZE]
+        locations = addr2line(program_name,
+                              cross_compile,
+                              [hex(address - offset) for address in chunk])
+
+        for address, location in zip(chunk, locations):
+            function, _, location = location.partition(' at ')
+
+            if function.startswith('??'):
+                function = '??'
+            elif lines:
+                function += ' (' + os.path.basename(location) + ')'
+
+            names[address] = function
+
+    return names
+
+
+def create_stacks(profile, names, merge_threads):
+    stacks = Counter()
+
+    for thrd, pcs in profile.samples:
+        frames = [names[pcs[0]]]
+        frames += [names[pc - 1] for pc in pcs[1:]]
+        frames.reverse()
+
+        if not merge_threads:
+            frames.insert(0, profile.threads.get(thrd, '[no thread]'))
+
+        stacks[';'.join(frames)] += 1
+
+    return stacks
+
+
+def print_top(profile, names, top):
+    total = len(profile.samples)
+    self_counts = Counter(names[pcs[0]] for _, pcs in profile.samples)
+    total_counts = Counter()
+
+    for _, pcs in profile.samples:
+        functions = set([names[pcs[0]]] + [names[pc - 1] for pc in pcs[1:]])
+
+        for function in functions:
+            total_counts[function] += 1
+
+    print('Samples: {}, dropped: {}'.format(total, profile.dropped))
+
+    if total == 0:
+        return
+
+    print()
+    print('{:>7} {:>7}  {}'.format('SELF', 'TOTAL', 'FUNCTION'))
+
+    for function, count in self_counts.most_common(top):
+        print('{:6.1f}% {:6.1f}%  {}'.format(
+            100.0 * count / total,
+            100.0 * total_counts[function] / total,
+            function))
+
+
+def print_ram_code_functions(profile, names, count):
+    """Print the functions with most samples as a RAM_CODE_FUNCTIONS
+    make variable.
+
+    """
+
+    self_counts = Counter(names[pcs[0]].split(' (')[0]
+                          for _, pcs in profile.samples)
+    functions = [function
+                 for function, _ in self_counts.most_common()
+                 if function != '??']
+
+    print('RAM_CODE_FUNCTIONS = {}'.format(' '.join(functions[:count])))
+
+
+def main():
+    parser = argparse.ArgumentParser(
+        description=('Symbolize the output of debug/profiler/print and create '
+                     'folded stacks for flamegraph.pl.'))
+    parser.add_argument('-c', '--cross-compile',
+                        default='',
+                        help='Toolchain prefix, for example arm-none-eabi-.')
+    parser.add_argument('-o', '--output',
+                        help='Folded stacks output file.')
+    parser.add_argument('-n', '--top',
+                        type=int,
+                        default=20,
+                        help='Number of functions to print (default: %(default)s).')
+    parser.add_argument('-l', '--lines',
+                        action='store_true',
+                        help='Add file and line to the function names.')
+    parser.add_argument('--merge-threads',
+                        action='store_true',
+                        help='Do not separate the stacks per thread.')
+    parser.add_argument('--ram-code-functions',
+                        type=int,
+                        help=('Print given number of functions with most '
+                              'samples as a RAM_CODE_FUNCTIONS make variable.'))
+    parser.add_argument('program', help='Program ELF file.')
+    parser.add_argument('infile', help='Output of debug/profiler/print.')
+    args = parser.parse_args()
+
+    profile = parse_output(args.infile)
+    names = symbolize(profile, args.program, args.cross_compile, args.lines)
+
+    if args.output:
+        stacks = create_stacks(profile, names, args.merge_threads)
+
+        with open(args.output, 'w') as fout:
+            for stack, count in sorted(stacks.items()):
+                fout.write('{} {}\n'.format(stack, count))
+
+    print_top(profile, names, args.top)
+
+    if args.ram_code_functions is not None:
+        print()
+        print_ram_code_functions(profile, names, args.ram_code_functions)
+
+
+if __name__ == '__main__':
+    main()
@@ -0,0 +1,453 @@
+#!/usr/bin/env python3
+
+"""Compile regular expressions to deterministic finite automatons
+matched by re_dfa_match().
+
+The pattern syntax is the one supported by re_compile(). A pattern is
+first compiled to a Thompson NFA with prioritized threads, and then
+converted to a DFA with the same leftmost-first (greedy/non-greedy)
+semantics as re_match().
+
+"""
+
+import sys
+import argparse
+
+
+HEADER_FMT = '''/**
+ * This file was generated by re_dfa.py. Do not edit.
+ */
+
+#include "simba.h"
+'''
+
+PATTERN_FMT = '''
+/* Pattern "{pattern}", {number_of_states} states and {number_of_classes} \
+classes. */
+
+static FAR const uint8_t {name}_classes[] = {{
+{classes}
+}};
+
+static FAR const uint8_t {name}_transitions[] = {{
+{transitions}
+}};
+
+static FAR const uint8_t {name}_accepting[] = {{
+{accepting}
+}};
+
+FAR const struct re_dfa_t {name} = {{
+    .classes_p = &{name}_classes[0],
+    .transitions_p = &{name}_transitions[0],
+    .accepting_p = &{name}_accepting[0],
+    .number_of_classes = {number_of_classes}
+}};
+'''
+
+# The transitions table is an uint8_t array and state 0 is the dead
+# state.
+STATES_MAX = 255
+
+WHITESPACE = frozenset(b' \t\n\v\f\r')
+DECIMAL_DIGIT = frozenset(range(ord('0'), ord('9') + 1))
+ALPHANUMERIC = frozenset(list(range(ord('a'), ord('z') + 1))
+                         + list(range(ord('A'), ord('Z') + 1))
+                         + list(DECIMAL_DIGIT)
+                         + [ord('_')])
+
+
+class Error(Exception):
+    pass
+
+
+def lower(value):
+    if ord('A') <= value <= ord('Z'):
+        value += 32
+
+    return value
+
+
+class Parser(object):
+
+    def __init__(self, pattern, ignorecase, dotall):
+        self.pattern = bytearray(pattern.encode('latin-1'))
+        self.ignorecase = ignorecase
+        self.dotall = dotall
+        self.pos = 0
+
+    def peek(self, offset=0):
+        if self.pos + offset < len(self.pattern):
+            return self.pattern[self.pos + offset]
+        else:
+            return None
+
+    def next(self):
+        value = self.peek()
+
+        if value is None:
+            raise Error('unexpected end of pattern')
+
+        self.pos += 1
+
+        return value
+
+    def text(self, value):
+        if self.ignorecase:
+            return frozenset([byte for byte in range(256)
+                              if lower(byte) == lower(value)])
+        else:
+            return frozenset([value])
+
+    def text_range(self, lower_value, upper_value):
+        if self.ignorecase:
+            lower_value = lower(lower_value)
+            upper_value = lower(upper_value)
+
+            return frozenset([byte for byte in range(256)
+                              if lower_value <= lower(byte) <= upper_value])
+        else:
+            return frozenset(range(lower_value, upper_value + 1))
+
+    def escape(self):
+        """Returns the escaped character, or a set for special escape
+        characters, as the second element.
+
+        """
+
+        value = self.next()
+
+        if value == ord('s'):
+            return True, WHITESPACE
+        elif value == ord('d'):
+            return True, DECIMAL_DIGIT
+        elif value == ord('w'):
+            return True, ALPHANUMERIC
+        else:
+            return False, value
+
+    def set(self):
+        members = set()
+
+        # Unescaped ']' and '-' are accepted as the first character.
+        if self.peek() in [ord(']'), ord('-')]:
+            members |= self.text(self.next())
+
+        while True:
+            value = self.next()
+
+            if value == ord(']'):
+                break
+
+            if value == ord('\\'):
+                special, value = self.escape()
+
+                if special:
+                    if ((self.peek() == ord('-'))
+                        and (self.peek(1) != ord(']'))):
+                        raise Error('special escape character in range')
+
+                    members |= value
+                    continue
+            elif value == ord('-'):
+                if self.peek() != ord(']'):
+                    raise Error("unescaped '-' in set")
+
+            if (self.peek() != ord('-')) or (self.peek(1) == ord(']')):
+                members |= self.text(value)
+                continue
+
+            # It's a range entry.
+            self.next()
+            upper_value = self.next()
+
+            if upper_value == ord('\\'):
+                special, upper_value = self.escape()
+
+                if special:
+                    raise Error('special escape character in range')
+            elif upper_value == ord('-'):
+                raise Error("unescaped '-' in range")
+
+            members |= self.text_range(value, upper_value)
+
+        return frozenset(members)
+
+    def members(self):
+        number_of_members = 0
+
+        while self.peek() is not None and chr(self.peek()).isdigit():
+            number_of_members *= 10
+            number_of_members += (self.next() - ord('0'))
+
+        if self.next() != ord('}'):
+            raise Error("expected '}'")
+
+        return number_of_members
+
+    def parse(self):
+        """Returns a list of atoms and their repetition.
+
+        """
+
+        items = []
+
+        while self.peek() is not None:
+            value = self.next()
+
+            if value == ord('.'):
+                if self.dotall:
+                    items.append([frozenset(range(256)), None])
+                else:
+                    items.append([frozenset(range(256)) - set(b'\n'), None])
+            elif value in b'*+?{':
+                if not items or items[-1][1] is not None:
+                    raise Error("nothing to repeat at position {}".format(
+                        self.pos - 1))
+
+                if value == ord('{'):
+                    items[-1][1] = self.members()
+                else:
+                    repetition = chr(value)
+
+                    if self.peek() == ord('?'):
+                        repetition += chr(self.next())
+
+                    items[-1][1] = repetition
+            elif value == ord('\\'):
+                special, value = self.escape()
+
+                if special:
+                    items.append([value, None])
+                else:
+                    items.append([self.text(value), None])
+            elif value == ord('['):
+                items.append([self.set(), None])
+            elif value in b'^$|()':
+                raise Error("'{}' is not supported".format(chr(value)))
+            else:
+                items.append([self.text(value), None])
+
+        return items
+
+
+def compile_nfa(items):
+    """Compile given items to a Thompson NFA program. The first target
+    of a split has the highest priority.
+
+    """
+
+    program = []
+
+    for members, repetition in items:
+        if repetition is None:
+            program.append(('char', members))
+        elif isinstance(repetition, int):
+            for _ in range(repetition):
+                program.append(('char', members))
+        elif repetition in ['?', '??']:
+            split = len(program)
+            program.append(None)
+            program.append(('char', members))
+            end = len(program)
+
+            if repetition == '?':
+                program[split] = ('split', split + 1, end)
+            else:
+                program[split] = ('split', end, split + 1)
+        elif repetition in ['*', '*?']:
+            split = len(program)
+            program.append(None)
+            program.append(('char', members))
+            program.append(('jump', split))
+            end = len(program)
+
+            if repetition == '*':
+                program[split] = ('split', split + 1, end)
+            else:
+                program[split] = ('split', end, split + 1)
+        else:
+            start = len(program)
+            program.append(('char', members))
+            end = len(program) + 1
+
+            if repetition == '+':
+                program.append(('split', start, end))
+            else:
+                program.append(('split', end, start))
+
+    program.append(('match', ))
+
+    return program
+
+
+def add_thread(program, threads, visited, pc):
+    if pc in visited:
+        return
+
+    visited.add(pc)
+    instruction = program[pc]
+
+    if instruction[0] == 'split':
+        add_thread(program, threads, visited, instruction[1])
+        add_thread(program, threads, visited, instruction[2])
+    elif instruction[0] == 'jump':
+        add_thread(program, threads, visited, instruction[1])
+    else:
+        threads.append(pc)
+
+
+def cut(program, threads):
+    """Threads with lower priority than a matching thread can never
+    give the result.
+
+    """
+
+    for i, pc in enumerate(threads):
+        if program[pc][0] == 'match':
+            return tuple(threads[:i + 1])
+
+    return tuple(threads)
+
+
+def step(program, state, byte):
+    threads = []
+    visited = set()
+
+    for pc in state:
+        instruction = program[pc]
+
+        if instruction[0] == 'char' and byte in instruction[1]:
+            add_thread(program, threads, visited, pc + 1)
+
+    return cut(program, threads)
+
+
+def is_accepting(program, state):
+    return len(state) > 0 and program[state[-1]][0] == 'match'
+
+
+def create_classes(program):
+    """Bytes that all char instructions treat equally share a class.
+
+    """
+
+    sets = [instruction[1]
+            for instruction in program
+            if instruction[0] == 'char']
+    signatures = {}
+    classes = []
+
+    for byte in range(256):
+        signature = tuple([byte in members for members in sets])
+
+        if signature not in signatures:
+            signatures[signature] = len(signatures)
+
+        classes.append(signatures[signature])
+
+    return classes
+
+
+def compile_dfa(program):
+    classes = create_classes(program)
+    number_of_classes = max(classes) + 1
+    representatives = [classes.index(i) for i in range(number_of_classes)]
+    threads = []
+    add_thread(program, threads, set(), 0)
+    start = cut(program, threads)
+
+    # State 0 is the dead state and state 1 the start state.
+    states = {(): 0, start: 1}
+    pending = [start]
+    transitions = []
+    accepting = []
+
+    while pending:
+        state = pending.pop(0)
+        accepting.append(int(is_accepting(program, state)))
+
+        for byte in representatives:
+            next_state = step(program, state, byte)
+
+            if next_state not in states:
+                if len(states) > STATES_MAX:
+                    raise Error('more than {} states'.format(STATES_MAX))
+
+                states[next_state] = len(states)
+                pending.append(next_state)
+
+            transitions.append(states[next_state])
+
+    return classes, transitions, accepting, number_of_classes
+
+
+def format_data(data):
+    lines = []
+
+    for i in range(0, len(data), 12):
+        lines.append('    ' + ', '.join(['{}'.format(value)
+                                         for value in data[i:i + 12]]) + ',')
+
+    return '\n'.join(lines)
+
+
+def format_pattern(pattern):
+    pattern = pattern.encode('unicode_escape').decode('ascii')
+
+    return pattern.replace('"', '\\"').replace('*/', '*\\/')
+
+
+def generate(name, pattern, flags):
+    parser = Parser(pattern, 'i' in flags, 's' in flags)
+
+    try:
+        program = compile_nfa(parser.parse())
+        classes, transitions, accepting, number_of_classes = compile_dfa(
+            program)
+    except Error as e:
+        sys.exit("error: {}: {}".format(name, e))
+
+    return PATTERN_FMT.format(name=name,
+                              pattern=format_pattern(pattern),
+                              number_of_states=len(accepting),
+                              number_of_classes=number_of_classes,
+                              classes=format_data(classes),
+                              transitions=format_data(transitions),
+                              accepting=format_data(accepting))
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__)
+    parser.add_argument('--pattern',
+                        nargs='+',
+                        action='append',
+                        required=True,
+                        metavar=('NAME', 'PATTERN'),
+                        help=('Variable name, pattern and optional flags. '
+                              'Flags are a combination of i (RE_IGNORECASE) '
+                              'and s (RE_DOTALL).'))
+    parser.add_argument('--output',
+                        required=True,
+                        help='Output C source file.')
+    args = parser.parse_args()
+
+    patterns = []
+
+    for pattern in args.pattern:
+        if len(pattern) not in [2, 3]:
+            parser.error('--pattern takes a name, a pattern and optional '
+                         'flags')
+
+        if len(pattern) == 2:
+            pattern.append('')
+
+        patterns.append(generate(*pattern))
+
+    with open(args.output, 'w') as fout:
+        fout.write(HEADER_FMT)
+        fout.write(''.join(patterns))
+
+
+if __name__ == '__main__':
+    main()
@@ -0,0 +1,107 @@
+#!/usr/bin/env python3
+
+"""Generate a C source file with an array of files for the romfs
+read-only file system.
+
+"""
+
+import os
+import argparse
+
+
+HEADER_FMT = '''/**
+ * This file was generated by romfs.py. Do not edit.
+ */
+
+#include "simba.h"
+'''
+
+FILE_FMT = '''
+static const uint8_t {variable}[] __attribute__ ((aligned ({align}))) = {{
+{data}
+}};
+'''
+
+ENTRY_FMT = '''    {{
+        .path_p = "{path}",
+        .buf_p = {variable},
+        .size = {size}
+    }},
+'''
+
+FOOTER_FMT = '''
+const struct romfs_file_t {name}[] = {{
+{entries}    {{
+        .path_p = NULL
+    }}
+}};
+'''
+
+
+def format_data(data):
+    lines = []
+
+    for i in range(0, len(data), 12):
+        chunk = bytearray(data[i:i + 12])
+        lines.append('    ' + ', '.join(['0x{:02x}'.format(byte)
+                                         for byte in chunk]) + ',')
+
+    return '\n'.join(lines)
+
+
+def find_files(root):
+    paths = []
+
+    for dirpath, _, filenames in os.walk(root):
+        for filename in filenames:
+            filename = os.path.join(dirpath, filename)
+            path = os.path.relpath(filename, root).replace(os.sep, '/')
+            paths.append((path, filename))
+
+    # Sorted as by strcmp(), as romfs uses a binary search.
+    return sorted(paths, key=lambda item: item[0].encode('utf-8'))
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__)
+    parser.add_argument('--name',
+                        default='romfs_files',
+                        help='Name of the generated array.')
+    parser.add_argument('--align',
+                        type=int,
+                        default=4,
+                        help='Alignment in bytes of the file contents.')
+    parser.add_argument('--output',
+                        required=True,
+                        help='Output C source file.')
+    parser.add_argument('root', help='Directory of files to store.')
+    args = parser.parse_args()
+
+    files = []
+    entries = []
+
+    for index, (path, filename) in enumerate(find_files(args.root)):
+        with open(filename, 'rb') as fin:
+            data = fin.read()
+
+        if data:
+            variable = 'file_{}'.format(index)
+            files.append(FILE_FMT.format(variable=variable,
+                                         align=args.align,
+                                         data=format_data(data)))
+        else:
+            variable = 'NULL'
+
+        entries.append(ENTRY_FMT.format(path=path,
+                                        variable=variable,
+                                        size=len(data)))
+
+    with open(args.output, 'w') as fout:
+        fout.write(HEADER_FMT)
+        fout.write(''.join(files))
+        fout.write(FOOTER_FMT.format(name=args.name,
+                                     entries=''.join(entries)))
+
+
+if __name__ == '__main__':
+    main()
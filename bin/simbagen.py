@@ -126,6 +126,8 @@ SIMBA_GEN_C_FMT = """\
 {eeprom}
 
 {soamdb}
+
+{fs_commands}
 """
 
 SYSINFO_FMT = """\
@@ -146,6 +148,14 @@ const FAR struct setting_t settings[] = {{
 }};
 
 const FAR uint8_t settings_default[CONFIG_SETTINGS_AREA_SIZE] = {{{default_data}}};
+
+static const FAR uint16_t settings_hash_indexes[] = {{{hash_indexes}}};
+
+const FAR struct settings_hash_t settings_hash = {{
+    .indexes_p = &settings_hash_indexes[0],
+    .seed = {hash_seed},
+    .mask = {hash_mask}
+}};
 """
 
 SETTING_HELPER_FUNCTIONS = """\
@@ -248,6 +258,50 @@ __attribute__ ((section (".eeprom"))) = {{{data}}};
 """
 
 
+def settings_hash_name(name, seed):
+    """FNV-1a hash of given setting name, the same as in
+    src/oam/settings.c.
+
+    """
+
+    value = (2166136261 ^ seed)
+
+    for byte in bytearray(name.encode('ascii')):
+        value ^= byte
+        value = ((value * 16777619) & 0xffffffff)
+
+    return value
+
+
+def create_settings_hash(names):
+    """Find a seed and table size that gives a perfect hash of given
+    setting names. Returns the seed, the mask and the table with
+    the setting index plus one, or zero for empty slots.
+
+    """
+
+    size = 1
+
+    while size < 2 * len(names):
+        size *= 2
+
+    while True:
+        for seed in range(256):
+            table = size * [0]
+
+            for index, name in enumerate(names):
+                slot = (settings_hash_name(name, seed) & (size - 1))
+
+                if table[slot] != 0:
+                    break
+
+                table[slot] = (index + 1)
+            else:
+                return seed, size - 1, table
+
+        size *= 2
+
+
 class Settings(object):
 
     def __init__(self, filename, endianess):
@@ -467,11 +521,17 @@ class Settings(object):
 
         default_data = ', '.join([str(byte)
                                   for byte in bytearray(self.as_binary())])
+        hash_seed, hash_mask, hash_indexes = create_settings_hash(
+            list(self.settings.keys()))
 
         return SETTINGS_FMT.format(names='\n'.join(names),
                                    functions='\n'.join(functions),
                                    array='\n'.join(array),
-                                   default_data=default_data)
+                                   default_data=default_data,
+                                   hash_indexes=', '.join([str(index)
+                                                           for index in hash_indexes]),
+                                   hash_seed=hash_seed,
+                                   hash_mask=hash_mask)
 
 
 class EepromSoft(object):
@@ -509,6 +569,102 @@ class Eeprom(object):
         return EEPROM_FMT.format(data=' ' + data + ' ')
 
 
+FS_COMMANDS_FMT = """\
+{declarations}
+const struct fs_command_t *const fs_static_commands[] = {{
+{commands}
+}};
+
+const int fs_static_commands_length = {length};
+"""
+
+# Section with the records of the commands defined by
+# FS_COMMAND_DEFINE().
+FS_COMMANDS_SECTION = b'.simba.fs_commands'
+
+
+def elf_section(filename, name):
+    """Returns the contents of the section with given name in given ELF
+    file, or None if missing.
+
+    """
+
+    with open(filename, 'rb') as fin:
+        data = bytearray(fin.read())
+
+    if data[:4] != bytearray(b'\x7fELF'):
+        return None
+
+    endianess_prefix = ('<' if data[5] == 1 else '>')
+
+    if data[4] == 2:
+        shoff = struct.unpack_from(endianess_prefix + 'Q', data, 0x28)[0]
+        shentsize, shnum, shstrndx = struct.unpack_from(
+            endianess_prefix + 'HHH', data, 0x3a)
+        header_fmt = endianess_prefix + 'IIQQQQ'
+    else:
+        shoff = struct.unpack_from(endianess_prefix + 'I', data, 0x20)[0]
+        shentsize, shnum, shstrndx = struct.unpack_from(
+            endianess_prefix + 'HHH', data, 0x2e)
+        header_fmt = endianess_prefix + 'IIIIII'
+
+    def section_header(index):
+        name_offset, _, _, _, offset, size = struct.unpack_from(
+            header_fmt, data, shoff + index * shentsize)
+
+        return name_offset, offset, size
+
+    _, names_offset, _ = section_header(shstrndx)
+
+    for index in range(shnum):
+        name_offset, offset, size = section_header(index)
+        begin = names_offset + name_offset
+        end = data.index(b'\0', begin)
+
+        if data[begin:end] == bytearray(name):
+            return bytes(data[offset:offset + size])
+
+    return None
+
+
+class FsCommands(object):
+    """Commands defined by FS_COMMAND_DEFINE() in given object files,
+    sorted by path.
+
+    """
+
+    def __init__(self, objects):
+        self.commands = []
+
+        for filename in objects:
+            section = elf_section(filename, FS_COMMANDS_SECTION)
+
+            if section is None:
+                continue
+
+            for record in section.split(b'\0'):
+                if record:
+                    symbol, path = record.decode('ascii').split(' ', 1)
+                    self.commands.append((path, symbol))
+
+        self.commands.sort()
+
+    def as_simba_gen_c_section(self):
+        declarations = ''.join([
+            'extern const struct fs_command_t {};\n'.format(symbol)
+            for _, symbol in self.commands
+        ])
+        commands = '\n'.join(['    &{},'.format(symbol)
+                              for _, symbol in self.commands])
+
+        if not commands:
+            commands = '    NULL'
+
+        return FS_COMMANDS_FMT.format(declarations=declarations,
+                                      commands=commands,
+                                      length=len(self.commands))
+
+
 class SoamDb(object):
 
     def __init__(self, dbfiles):
@@ -686,6 +842,7 @@ def do_source(args):
     eeprom_section = eeprom.as_simba_gen_c_section()
 
     soamdb = SoamDb(args.dbfiles)
+    fs_commands = FsCommands(args.object)
 
     os.chdir(args.output_directory)
     soamdb.write_to_file(args.name + '.soamdb')
@@ -700,7 +857,8 @@ def do_source(args):
             settings=settings_section,
             eeprom_soft=eeprom_soft_section,
             eeprom=eeprom_section,
-            soamdb=soamdb_section))
+            soamdb=soamdb_section,
+            fs_commands=fs_commands.as_simba_gen_c_section()))
 
     with open('eeprom_soft.bin', 'wb') as fout:
         fout.write(eeprom_soft.as_binary())
@@ -731,6 +889,11 @@ def main():
                                type=int,
                                required=True)
     source_parser.add_argument('--settings')
+    source_parser.add_argument('--object',
+                               action='append',
+                               default=[],
+                               help=('Object file to search for commands defined '
+                                     'by FS_COMMAND_DEFINE().'))
     source_parser.add_argument('dbfiles', nargs="*")
     source_parser.set_defaults(func=do_source)
 
@@ -14,6 +14,7 @@ import cmd
 import threading
 import serial
 import hashlib
+import re
 
 try:
     import lzma
@@ -56,17 +57,26 @@ SOAM_TYPE_DATABASE_ID_REQUEST          = 8
 SOAM_TYPE_DATABASE_ID_RESPONSE         = 9
 SOAM_TYPE_DATABASE_REQUEST             = 10
 SOAM_TYPE_DATABASE_RESPONSE            = 11
+SOAM_TYPE_LOG_POINT_DEFERRED           = 12
+SOAM_TYPE_BATCH                        = 13
 SOAM_TYPE_INVALID_TYPE                 = 15
 
 SOAM_SEGMENT_SIZE_MIN = 7
-SOAM_SEGMENT_SIZE_MAX = 1024
+# Limited by the 16 bits size field.
+SOAM_SEGMENT_SIZE_MAX = (5 + 0xffff)
 
+SOAM_SEGMENT_FLAGS_COMPRESSED  = (1 << 2)
 SOAM_SEGMENT_FLAGS_CONSECUTIVE = (1 << 1)
 SOAM_SEGMENT_FLAGS_LAST        = (1 << 0)
 
 DATABASE_COMPRESSION_SCHEME_LZMA         = 0
 DATABASE_COMPRESSION_SCHEME_UNCOMPRESSED = 1
 
+LOG_LEVELS = ['fatal', 'error', 'warning', 'info', 'debug']
+
+# Same syntax as the Simba std module, %[flags][width][length]specifier.
+RE_CONVERSION = re.compile(r'%[0-]?[0-9]*l?(.)', re.DOTALL)
+
 
 class CommandNotFoundError(Exception):
     """Given command was not found.
@@ -109,6 +119,45 @@ def crc_ccitt(data):
     return (msb << 8) + lsb
 
 
+def lzss_decompress(data):
+    """Decompress given LZSS compressed segment payload. A flag byte
+    precedes each group of eight items, least significant bit
+    first. A cleared bit is a literal byte, and a set bit a two bytes
+    match; 12 bits offset minus one followed by 4 bits length minus
+    three.
+
+    """
+
+    data = bytearray(data)
+    out = bytearray()
+    pos = 0
+
+    while pos < len(data):
+        flags = data[pos]
+        pos += 1
+
+        for bit in range(8):
+            if pos >= len(data):
+                break
+
+            if flags & (1 << bit):
+                offset = ((data[pos] << 4) | (data[pos + 1] >> 4)) + 1
+                length = (data[pos + 1] & 0xf) + 3
+                pos += 2
+
+                if offset > len(out):
+                    raise ValueError('bad compressed segment')
+
+                # The match may overlap the output.
+                for _ in range(length):
+                    out.append(out[-offset])
+            else:
+                out.append(data[pos])
+                pos += 1
+
+    return bytes(out)
+
+
 def format_printf(database, packet):
     """Format given printf packet.
 
@@ -154,6 +203,84 @@ def format_log_point(database, packet):
     return formatted_string
 
 
+def unpack_deferred_args(fmt, data):
+    """Unpack the arguments in given deferred log point data and format
+    them one by one using the conversion specifications in given
+    format string.
+
+    """
+
+    args = []
+    offset = 0
+
+    for mo in RE_CONVERSION.finditer(fmt):
+        conversion = mo.group(0).replace('l', '')
+        specifier = mo.group(1)
+
+        if specifier in 'sS':
+            end = data.index(b'\x00', offset)
+            value = data[offset:end].decode('ascii')
+            offset = end + 1
+            conversion = conversion[:-1] + 's'
+        elif specifier in 'cidux':
+            if specifier in 'ux':
+                value = struct.unpack('>I', data[offset:offset + 4])[0]
+            else:
+                value = struct.unpack('>i', data[offset:offset + 4])[0]
+
+            offset += 4
+        elif specifier == 'f':
+            value = struct.unpack('>f', data[offset:offset + 4])[0]
+            offset += 4
+        else:
+            # Not a conversion taking an argument, for example "%%".
+            args.append((mo.start(), mo.end(), specifier))
+            continue
+
+        args.append((mo.start(), mo.end(), conversion % value))
+
+    return args
+
+
+def format_deferred_log_point(database, packet):
+    """Format given deferred log point packet. Formatting of the entry
+    is deferred from the device to this function.
+
+    """
+
+    seconds, milliseconds, level = struct.unpack('>IHB', packet[0:7])
+    thread_name, object_name, fmt, data = packet[7:].split(b'\x00', 3)
+    header = '{}.{:03}:{}:{}:{}: '.format(seconds,
+                                          milliseconds,
+                                          LOG_LEVELS[level],
+                                          thread_name.decode('ascii'),
+                                          object_name.decode('ascii'))
+    fmt = fmt.decode('latin-1')
+
+    try:
+        if len(fmt) >= 2 and ord(fmt[0]) > 127:
+            # Only the conversion specifications are stored on the
+            # device, and the text is found in the database.
+            identity = (ord(fmt[0]) << 8) | ord(fmt[1])
+            args = unpack_deferred_args(fmt[2:], data)
+            message = database.formats[identity].format(
+                *[arg for _, _, arg in args])
+        else:
+            message = ''
+            end = 0
+
+            for start, stop, arg in unpack_deferred_args(fmt, data):
+                message += fmt[end:start] + arg
+                end = stop
+
+            message += fmt[end:]
+    except (KeyError, IndexError, ValueError, struct.error):
+        message = '<bad deferred log point {}>\n'.format(
+            repr(fmt + data.decode('latin-1')))
+
+    return header + message
+
+
 class Database(object):
     """The SOAM database.
 
@@ -229,6 +356,48 @@ class ReaderThread(threading.Thread):
 
         return packet
 
+    def output_packet(self, packet_type, packet):
+        """Output given standard output or log point packet. Returns
+        False for other packet types.
+
+        """
+
+        if packet_type == SOAM_TYPE_STDOUT_PRINTF:
+            formatted_string = format_printf(self.client.database, packet)
+            print(formatted_string, end='', file=self.ostream)
+        elif packet_type == SOAM_TYPE_STDOUT_BINARY:
+            print(packet, end='', file=self.ostream)
+        elif packet_type == SOAM_TYPE_LOG_POINT:
+            formatted_string = format_log_point(self.client.database, packet)
+            print(formatted_string, end='', file=self.ostream)
+        elif packet_type == SOAM_TYPE_LOG_POINT_DEFERRED:
+            formatted_string = format_deferred_log_point(
+                self.client.database,
+                packet)
+            print(formatted_string, end='', file=self.ostream)
+        else:
+            return False
+
+        return True
+
+    def output_batch(self, packet):
+        """Output all records in given batch packet. Each record is the
+        packet type, size and data.
+
+        """
+
+        pos = 0
+
+        while pos + 3 <= len(packet):
+            packet_type_flags, size = struct.unpack('>BH', packet[pos:pos + 3])
+            packet_type = (packet_type_flags >> 4)
+            record = packet[pos + 3:pos + 3 + size]
+            pos += (3 + size)
+
+            if not self.output_packet(packet_type, record):
+                print('warning: {}: bad batch record type'.format(packet_type),
+                      file=self.ostream)
+
     def _run(self):
         """Read packets from the soam server.
 
@@ -256,6 +425,17 @@ class ReaderThread(threading.Thread):
             flags = (segment_type_flags & 0xf)
             payload = segment[5:-2]
 
+            if flags & SOAM_SEGMENT_FLAGS_COMPRESSED:
+                try:
+                    payload = lzss_decompress(payload)
+                except (ValueError, IndexError):
+                    print('warning: {}: bad compressed segment'.format(segment),
+                          file=self.ostream)
+                    segments = None
+                    continue
+
+                flags &= ~SOAM_SEGMENT_FLAGS_COMPRESSED
+
             if segment_index is None:
                 segment_index = index + 1
             elif index == segment_index:
@@ -303,14 +483,10 @@ class ReaderThread(threading.Thread):
             packet = b''.join(segments)
 
             # Decode the reassembled packet.
-            if packet_type == SOAM_TYPE_STDOUT_PRINTF:
-                formatted_string = format_printf(self.client.database, packet)
-                print(formatted_string, end='', file=self.ostream)
-            elif packet_type == SOAM_TYPE_STDOUT_BINARY:
-                print(packet, end='', file=self.ostream)
-            elif packet_type == SOAM_TYPE_LOG_POINT:
-                formatted_string = format_log_point(self.client.database, packet)
-                print(formatted_string, end='', file=self.ostream)
+            if self.output_packet(packet_type, packet):
+                pass
+            elif packet_type == SOAM_TYPE_BATCH:
+                self.output_batch(packet)
             elif packet_type in [SOAM_TYPE_COMMAND_RESPONSE_DATA_PRINTF,
                                  SOAM_TYPE_COMMAND_RESPONSE_DATA_BINARY]:
                 response_data.append((packet_type, transaction_id, packet))
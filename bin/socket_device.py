@@ -4,6 +4,7 @@
 from __future__ import print_function
 
 import sys
+import time
 import struct
 import socket
 import argparse
@@ -24,6 +25,8 @@ TYPE_CAN_DEVICE_REQUEST                =  7
 TYPE_CAN_DEVICE_RESPONSE               =  8
 TYPE_I2C_DEVICE_REQUEST                =  9
 TYPE_I2C_DEVICE_RESPONSE               = 10
+TYPE_CAN_DEVICE_BINARY_REQUEST         = 13
+TYPE_CAN_DEVICE_BINARY_RESPONSE        = 14
 
 
 # Maps device type strings to request types.
@@ -36,6 +39,14 @@ REQUEST_TYPE_FROM_STRING = {
 }
 
 
+# Default Unix domain socket path of the Simba application, for
+# clients on the same host.
+UNIX_PATH = '/tmp/simba-socket-device'
+
+# Maximum number of bytes received at a time.
+READ_SIZE_MAX = 65536
+
+
 # Error codes.
 ENODEV     = 19
 EADDRINUSE = 98
@@ -54,8 +65,19 @@ class DeviceAlreadyInUseError(Exception):
 
 
 class SocketDevice(object):
+    """A socket device connection to the application, over TCP, or over
+    a Unix domain socket if `unix_path` is given. CAN frames are sent
+    and received on the binary format if `binary` is True.
+
+    """
 
-    def __init__(self, device_type, device_name, address=None, port=None):
+    def __init__(self,
+                 device_type,
+                 device_name,
+                 address=None,
+                 port=None,
+                 unix_path=None,
+                 binary=False):
         self.device_type = device_type
         self.device_name = device_name
 
@@ -68,7 +90,19 @@ class SocketDevice(object):
             port = 47000
 
         self.port = port
-        self.socket = socket.socket()
+        self.unix_path = unix_path
+        self.binary = binary
+
+        if unix_path is None:
+            self.socket = socket.socket()
+            self.socket.setsockopt(socket.IPPROTO_TCP, socket.TCP_NODELAY, 1)
+        else:
+            self.socket = socket.socket(socket.AF_UNIX, socket.SOCK_STREAM)
+
+        self.rx_buffer = bytearray()
+        self.rx_bytes = 0
+        self.tx_bytes = 0
+        self.start_time = time.time()
 
     def start(self):
         """Connect to the application and request the device.
@@ -90,16 +124,23 @@ class SocketDevice(object):
 
         """
 
+        if self.unix_path is None:
+            name = '{}:{}'.format(self.address, self.port)
+            address = (self.address, self.port)
+        else:
+            name = self.unix_path
+            address = self.unix_path
+
         try:
-            print('Connecting to {}:{}... '.format(self.address, self.port),
-                  flush=True,
-                  end='')
-            self.socket.connect((self.address, self.port))
+            print('Connecting to {}... '.format(name), flush=True, end='')
+            self.socket.connect(address)
             print('done.')
-        except ConnectionRefusedError:
+        except (ConnectionRefusedError, FileNotFoundError):
             print('failed.', flush=True)
             raise
 
+        self.start_time = time.time()
+
     def request_device(self):
         """Request the device.
 
@@ -111,7 +152,11 @@ class SocketDevice(object):
                   flush=True,
                   end='')
 
-            request_type = REQUEST_TYPE_FROM_STRING[self.device_type]
+            if self.binary and self.device_type == 'can':
+                request_type = TYPE_CAN_DEVICE_BINARY_REQUEST
+            else:
+                request_type = REQUEST_TYPE_FROM_STRING[self.device_type]
+
             request = struct.pack('>II', request_type, len(self.device_name))
             request += self.device_name.encode('utf-8')
 
@@ -164,39 +209,80 @@ class SocketDevice(object):
 
     def write(self, buf):
         self.socket.sendall(buf)
+        self.tx_bytes += len(buf)
+
+    def fill(self):
+        """Receive available data into the receive buffer. Returns False
+        if the connection was closed.
+
+        """
+
+        data = self.socket.recv(READ_SIZE_MAX)
+
+        if not data:
+            return False
+
+        self.rx_bytes += len(data)
+        self.rx_buffer += data
+
+        return True
+
+    def take(self, length):
+        buf = bytes(self.rx_buffer[:length])
+        del self.rx_buffer[:length]
+
+        return buf
 
     def read(self, length=1):
-        buf = b''
+        """Read given number of bytes, or less if the connection was
+        closed.
 
-        while len(buf) < length:
-            data = self.socket.recv(length - len(buf))
+        """
 
-            if not data:
+        while len(self.rx_buffer) < length:
+            if not self.fill():
                 break
 
-            buf += data
+        return self.take(length)
 
-        return buf
+    def read_available(self):
+        """Read all available data, waiting for at least one byte. Returns
+        an empty buffer if the connection was closed.
+
+        """
+
+        if not self.rx_buffer:
+            self.fill()
+
+        return self.take(len(self.rx_buffer))
 
     def readline(self):
         """Read a line.
 
         """
 
-        buf = b''
-
         while True:
-            data = self.socket.recv(1)
+            index = self.rx_buffer.find(b'\n')
 
-            if not data:
-                break
+            if index != -1:
+                return self.take(index + 1)
 
-            buf += data
+            if not self.fill():
+                return self.take(len(self.rx_buffer))
 
-            if data == b'\n':
-                break
+    def statistics(self):
+        """Returns a string of the number of transferred bytes and the
+        average throughput of the connection.
 
-        return buf
+        """
+
+        seconds = max(time.time() - self.start_time, 1e-9)
+
+        return 'rx: {} bytes, {:.1f} kB/s, tx: {} bytes, {:.1f} kB/s'.format(
+            self.rx_bytes,
+            self.rx_bytes / seconds / 1000,
+            self.tx_bytes,
+            self.tx_bytes / seconds / 1000)
 
 
 def reader_main(device):
@@ -205,17 +291,17 @@ def reader_main(device):
     """
 
     while True:
-        byte = device.read(1)
+        data = device.read_available()
 
-        if not byte:
-            print('Connection closed.')
+        if not data:
+            print('Connection closed ({}).'.format(device.statistics()))
             break
 
         timestamp = datetime.datetime.now().strftime("%H:%M:%S.%f")
         prefix = '{} {}({}) RX:'.format(timestamp,
                                         device.device_type,
                                         device.device_name)
-        print(prefix, byte)
+        print(prefix, data)
 
 
 def reader_hex_line_main(device):
@@ -224,10 +310,10 @@ def reader_hex_line_main(device):
     """
 
     while True:
-        byte = device.read(1)
+        data = device.read_available()
 
-        if not byte:
-            print('Connection closed.')
+        if not data:
+            print('Connection closed ({}).'.format(device.statistics()))
             break
 
         timestamp = datetime.datetime.now().strftime("%H:%M:%S.%f")
@@ -235,7 +321,7 @@ def reader_hex_line_main(device):
                                         device.device_type,
                                         device.device_name)
 
-        print(prefix, binascii.hexlify(byte))
+        print(prefix, binascii.hexlify(data))
 
 
 def reader_line_main(device):
@@ -247,7 +333,7 @@ def reader_line_main(device):
         line = device.readline()
 
         if not line:
-            print('Connection closed.')
+            print('Connection closed ({}).'.format(device.statistics()))
             break
 
         line = line.strip()
@@ -263,12 +349,16 @@ def reader_line_main(device):
             print(prefix, line)
 
 
-def monitor(device_type, device_name, address, port):
+def monitor(device_type, device_name, address, port, unix_path):
     """Monitor given device.
 
     """
 
-    device = SocketDevice(device_type, device_name, address, port)
+    device = SocketDevice(device_type,
+                          device_name,
+                          address,
+                          port,
+                          unix_path)
     device.start()
     reader = threading.Thread(target=reader_main, args=(device, ))
     reader.setDaemon(True)
@@ -278,12 +368,16 @@ def monitor(device_type, device_name, address, port):
         device.write(sys.stdin.read(1).encode('utf-8'))
 
 
-def monitor_escaped_line(device_type, device_name, address, port):
+def monitor_escaped_line(device_type, device_name, address, port, unix_path):
     """Monitor given device.
 
     """
 
-    device = SocketDevice(device_type, device_name, address, port)
+    device = SocketDevice(device_type,
+                          device_name,
+                          address,
+                          port,
+                          unix_path)
     device.start()
     reader = threading.Thread(target=reader_line_main, args=(device, ))
     reader.setDaemon(True)
@@ -299,12 +393,16 @@ def monitor_escaped_line(device_type, device_name, address, port):
         device.write(line.encode('utf-8'))
 
 
-def monitor_hex_line(device_type, device_name, address, port):
+def monitor_hex_line(device_type, device_name, address, port, unix_path):
     """Monitor given device.
 
     """
 
-    device = SocketDevice(device_type, device_name, address, port)
+    device = SocketDevice(device_type,
+                          device_name,
+                          address,
+                          port,
+                          unix_path)
     device.start()
     reader = threading.Thread(target=reader_hex_line_main, args=(device, ))
     reader.setDaemon(True)
@@ -320,12 +418,16 @@ def monitor_hex_line(device_type, device_name, address, port):
         device.write(line)
 
 
-def monitor_line(device_type, device_name, address, port):
+def monitor_line(device_type, device_name, address, port, unix_path):
     """Monitor given device.
 
     """
 
-    device = SocketDevice(device_type, device_name, address, port)
+    device = SocketDevice(device_type,
+                          device_name,
+                          address,
+                          port,
+                          unix_path)
     device.start()
     reader = threading.Thread(target=reader_line_main, args=(device, ))
     reader.setDaemon(True)
@@ -341,7 +443,7 @@ def monitor_line(device_type, device_name, address, port):
         device.write(line.encode('utf-8'))
 
 
-def request_all_devices(device_type, address, port):
+def request_all_devices(device_type, address, port, unix_path):
     """Request all devices of given type.
 
     """
@@ -351,7 +453,11 @@ def request_all_devices(device_type, address, port):
 
     while True:
         try:
-            device = SocketDevice(device_type, str(index), address, port)
+            device = SocketDevice(device_type,
+                                  str(index),
+                                  address,
+                                  port,
+                                  unix_path)
             device.start()
             reader = threading.Thread(target=reader_main, args=(device, ))
             reader.setDaemon(True)
@@ -367,7 +473,7 @@ def request_all_devices(device_type, address, port):
     return devices
 
 
-def request_all_line_devices(device_type, address, port):
+def request_all_line_devices(device_type, address, port, unix_path):
     """Request all line devices of given type.
 
     """
@@ -377,7 +483,11 @@ def request_all_line_devices(device_type, address, port):
 
     while True:
         try:
-            device = SocketDevice(device_type, str(index), address, port)
+            device = SocketDevice(device_type,
+                                  str(index),
+                                  address,
+                                  port,
+                                  unix_path)
             device.start()
             reader = threading.Thread(target=reader_line_main, args=(device, ))
             reader.setDaemon(True)
@@ -394,45 +504,78 @@ def request_all_line_devices(device_type, address, port):
 
 
 def do_pin(args):
-    monitor_line('pin', args.device, args.address, args.port)
+    monitor_line('pin',
+                 args.device,
+                 args.address,
+                 args.port,
+                 args.unix_path)
 
 
 def do_uart(args):
     if args.mode == 'escaped':
-        monitor_escaped_line('uart', args.device, args.address, args.port)
+        monitor_escaped_line('uart',
+                             args.device,
+                             args.address,
+                             args.port,
+                             args.unix_path)
     elif args.mode == 'hex':
-        monitor_hex_line('uart', args.device, args.address, args.port)
+        monitor_hex_line('uart',
+                         args.device,
+                         args.address,
+                         args.port,
+                         args.unix_path)
     else:
-        monitor('uart', args.device, args.address, args.port)
+        monitor('uart',
+                args.device,
+                args.address,
+                args.port,
+                args.unix_path)
 
 def do_pwm(args):
-    monitor_line('pwm', args.device, args.address, args.port)
+    monitor_line('pwm',
+                 args.device,
+                 args.address,
+                 args.port,
+                 args.unix_path)
 
 
 def do_can(args):
-    monitor_line('can', args.device, args.address, args.port)
+    monitor_line('can',
+                 args.device,
+                 args.address,
+                 args.port,
+                 args.unix_path)
 
 
 def do_i2c(args):
-    monitor_line('i2c', args.device, args.address, args.port)
+    monitor_line('i2c',
+                 args.device,
+                 args.address,
+                 args.port,
+                 args.unix_path)
 
 
 def do_monitor(args):
     uart_devices = request_all_devices('uart',
                                        args.address,
-                                       args.port)
+                                       args.port,
+                                       args.unix_path)
     pin_devices = request_all_line_devices('pin',
                                            args.address,
-                                           args.port)
+                                           args.port,
+                                           args.unix_path)
     pwm_devices = request_all_line_devices('pwm',
                                            args.address,
-                                           args.port)
+                                           args.port,
+                                           args.unix_path)
     can_devices = request_all_line_devices('can',
                                            args.address,
-                                           args.port)
+                                           args.port,
+                                           args.unix_path)
     i2c_devices = request_all_line_devices('i2c',
                                            args.address,
-                                           args.port)
+                                           args.port,
+                                           args.unix_path)
 
     input('Press <Enter> to exit.')
 
@@ -448,6 +591,12 @@ def main():
                         type=int,
                         default=47000,
                         help='TCP port to connect to (default: 47000).')
+    parser.add_argument('-u', '--unix-path',
+                        nargs='?',
+                        const=UNIX_PATH,
+                        help=('Connect to given Unix domain socket instead of '
+                              'TCP, for higher throughput on the same host '
+                              '(default: {}).'.format(UNIX_PATH)))
 
     # Workaround to make the subparser required in Python 3.
     subparsers = parser.add_subparsers(title='subcommands',
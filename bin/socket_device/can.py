@@ -3,9 +3,17 @@
 # A stub of python-can.
 #
 
-import binascii
+import struct
 from socket_device import SocketDevice
-import re
+
+
+# The binary CAN frame format; id, flags, size, two reserved bytes and
+# eight data bytes.
+FRAME_FORMAT = '>IBBxx8s'
+FRAME_SIZE = struct.calcsize(FRAME_FORMAT)
+
+FLAGS_EXTENDED_FRAME = 0x01
+FLAGS_RTR = 0x02
 
 
 rc = {}
@@ -13,10 +21,15 @@ rc = {}
 
 class Message(object):
 
-    def __init__(self, arbitration_id, extended_id, data):
+    def __init__(self,
+                 arbitration_id,
+                 extended_id,
+                 data,
+                 is_remote_frame=False):
         self.arbitration_id = arbitration_id
         self.extended_id = extended_id
         self.data = bytearray(data)
+        self.is_remote_frame = is_remote_frame
 
     def __repr__(self):
         return 'Message(arbitration_id={}, extended_id={}, data={})'.format(
@@ -27,14 +40,18 @@ class Message(object):
 
 class interface(object):
     class Bus(object):
-        """A stub communicating over a TCP socket instead of a CAN bus.
+        """A stub communicating over a socket instead of a CAN bus, using
+        the binary frame format. Give `unix_path` to connect to the
+        Unix domain socket of the application.
 
         """
 
         def __init__(self, device, *args, **kwargs):
             del args
-            del kwargs
-            self.device = SocketDevice('can', device)
+            self.device = SocketDevice('can',
+                                       device,
+                                       unix_path=kwargs.get('unix_path'),
+                                       binary=True)
             self.device.start()
 
         def send(self, message):
@@ -42,30 +59,34 @@ class interface(object):
 
             """
 
-            line = "id={:08x},extended={},size={},data=".format(
-                message.arbitration_id,
-                1 if message.extended_id else 0,
-                len(message.data))
-            line = line.encode('ascii')
-            line += binascii.hexlify(bytes(message.data))
-            line += b"\r\n"
+            flags = 0
+
+            if message.extended_id:
+                flags |= FLAGS_EXTENDED_FRAME
+
+            if message.is_remote_frame:
+                flags |= FLAGS_RTR
 
-            self.device.write(line)
+            self.device.write(struct.pack(FRAME_FORMAT,
+                                          message.arbitration_id,
+                                          flags,
+                                          len(message.data),
+                                          bytes(message.data)))
 
         def recv(self):
             """Read a message from the application.
 
             """
 
-            line = self.device.readline()
+            frame = self.device.read(FRAME_SIZE)
 
-            line = line.strip(b'\r\n')
-            mo = re.match(rb'id=(\w{8}),extended=(\d),size=(\d),data=(\w+)',
-                          line)
+            if len(frame) != FRAME_SIZE:
+                return None
 
-            arbitration_id = int(mo.group(1), 16)
-            extended_id = (mo.group(2) == b'1')
-            length = int(mo.group(3))
-            data = bytearray(binascii.unhexlify(mo.group(4)[0:2*length]))
+            arbitration_id, flags, size, data = struct.unpack(FRAME_FORMAT,
+                                                              frame)
 
-            return Message(arbitration_id, extended_id, data)
+            return Message(arbitration_id,
+                           (flags & FLAGS_EXTENDED_FRAME) != 0,
+                           data[:size],
+                           (flags & FLAGS_RTR) != 0)
@@ -7,15 +7,18 @@ from socket_device import SocketDevice
 
 
 class Serial(object):
-    """A stub communicating over a TCP socket instead of a serial port.
+    """A stub communicating over a socket instead of a serial port. Give
+    `unix_path` to connect to the Unix domain socket of the
+    application.
 
     """
 
     def __init__(self, device, *args, **kwargs):
         del args
-        del kwargs
 
-        self.device = SocketDevice('uart', device)
+        self.device = SocketDevice('uart',
+                                   device,
+                                   unix_path=kwargs.get('unix_path'))
         self.device.start()
 
     def close(self):
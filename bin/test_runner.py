@@ -0,0 +1,292 @@
+#!/usr/bin/env python
+#
+# Build and run test suites in parallel on the linux board, with a
+# timeout per suite, and write the results to a JUnit XML file.
+#
+
+from __future__ import print_function
+
+import os
+import sys
+import re
+import time
+import signal
+import argparse
+import threading
+import subprocess
+from xml.sax.saxutils import escape
+from xml.sax.saxutils import quoteattr
+
+try:
+    from queue import Queue
+except ImportError:
+    from Queue import Queue
+
+
+SIMBA_ROOT = os.path.dirname(os.path.dirname(os.path.realpath(__file__)))
+
+RE_TESTCASE = re.compile(r'^exit: (\w+): (PASSED|FAILED|SKIPPED)')
+
+# Characters not allowed in XML.
+RE_XML_INVALID = re.compile(u'[\x00-\x08\x0b\x0c\x0e-\x1f]')
+
+VIRTUAL_TIME_CDEFS = 'CONFIG_SYSTEM_TICKLESS=1 CONFIG_LINUX_VIRTUAL_TIME=1'
+
+# Number of output lines printed for a failed suite.
+FAILED_OUTPUT_LINES = 30
+
+
+class Suite(object):
+
+    def __init__(self, path, directory):
+        self.path = path
+        self.directory = directory
+        self.status = None
+        self.message = ''
+        self.output = ''
+        self.duration = 0.0
+        self.testcases = []
+
+
+def make_command(suite, args, target):
+    command = ['make', '-s', '-C', suite.directory, target, 'BOARD=' + args.board]
+
+    if args.virtual_time:
+        command += [
+            'BUILDDIR=build/{}-virtual-time'.format(args.board),
+            'CDEFS_EXTRA=' + VIRTUAL_TIME_CDEFS
+        ]
+
+    return command
+
+
+def execute(command, timeout):
+    """Execute given command in a new process group, killing the whole
+    group if it does not finish within given number of seconds. Returns
+    a tuple of the exit code, the output and if it timed out.
+
+    """
+
+    process = subprocess.Popen(command,
+                               stdout=subprocess.PIPE,
+                               stderr=subprocess.STDOUT,
+                               preexec_fn=os.setsid)
+    timed_out = []
+
+    def kill():
+        timed_out.append(True)
+
+        try:
+            os.killpg(process.pid, signal.SIGKILL)
+        except OSError:
+            pass
+
+    timer = threading.Timer(timeout, kill)
+    timer.start()
+
+    try:
+        output = process.communicate()[0]
+    finally:
+        timer.cancel()
+
+    return (process.returncode,
+            output.decode('utf-8', 'replace'),
+            bool(timed_out))
+
+
+def run_suite(suite, args):
+    start = time.time()
+    res, output, timed_out = execute(make_command(suite, args, 'all'),
+                                     args.build_timeout)
+
+    if res != 0:
+        suite.status = 'ERROR'
+        suite.message = ('build timed out' if timed_out else 'build failed')
+        suite.output = output
+    else:
+        res, output, timed_out = execute(make_command(suite, args, 'rerun'),
+                                         args.timeout)
+        suite.output = output
+
+        for line in output.splitlines():
+            mo = RE_TESTCASE.match(line.strip())
+
+            if mo:
+                suite.testcases.append((mo.group(1), mo.group(2)))
+
+        if timed_out:
+            suite.status = 'FAILED'
+            suite.message = 'timed out after {} seconds'.format(args.timeout)
+        elif res != 0:
+            suite.status = 'FAILED'
+            suite.message = 'exit code {}'.format(res)
+        else:
+            suite.status = 'PASSED'
+
+    suite.duration = time.time() - start
+
+
+def print_suite(suite, lock):
+    with lock:
+        print('{:7} {} ({:.1f} s){}'.format(
+            suite.status,
+            suite.path,
+            suite.duration,
+            ': ' + suite.message if suite.message else ''))
+
+        if suite.status != 'PASSED':
+            for line in suite.output.splitlines()[-FAILED_OUTPUT_LINES:]:
+                print('        ' + line)
+
+        sys.stdout.flush()
+
+
+def worker(suites, args, lock):
+    while True:
+        suite = suites.get()
+
+        if suite is None:
+            break
+
+        run_suite(suite, args)
+        print_suite(suite, lock)
+
+
+def write_junit(filename, suites, duration):
+    failures = sum([suite.status == 'FAILED' for suite in suites])
+    errors = sum([suite.status == 'ERROR' for suite in suites])
+
+    with open(filename, 'w') as fout:
+        fout.write('<?xml version="1.0" encoding="UTF-8"?>\n')
+        fout.write('<testsuites tests="{}" failures="{}" errors="{}" '
+                   'time="{:.3f}">\n'.format(len(suites),
+                                             failures,
+                                             errors,
+                                             duration))
+
+        for suite in suites:
+            classname = suite.path.replace('/', '.')
+            testcases = list(suite.testcases)
+
+            # The suite itself is a testcase if it failed without a
+            # failed testcase, for example on a build error or a
+            # timeout.
+            if (suite.status != 'PASSED'
+                and 'FAILED' not in [status for _, status in testcases]):
+                testcases.append(('suite', suite.status))
+
+            fout.write('  <testsuite name={} tests="{}" time="{:.3f}">\n'.format(
+                quoteattr(suite.path),
+                len(testcases),
+                suite.duration))
+
+            for name, status in testcases:
+                fout.write('    <testcase classname={} name={}'.format(
+                    quoteattr(classname),
+                    quoteattr(name)))
+
+                if status == 'PASSED':
+                    fout.write('/>\n')
+                    continue
+
+                fout.write('>\n')
+
+                if status == 'SKIPPED':
+                    fout.write('      <skipped/>\n')
+                else:
+                    fout.write('      <{} message={}>{}</{}>\n'.format(
+                        'error' if status == 'ERROR' else 'failure',
+                        quoteattr(suite.message or 'testcase failed'),
+                        escape(RE_XML_INVALID.sub('', suite.output)),
+                        'error' if status == 'ERROR' else 'failure'))
+
+                fout.write('    </testcase>\n')
+
+            fout.write('  </testsuite>\n')
+
+        fout.write('</testsuites>\n')
+
+
+def get_suites(board):
+    output = subprocess.check_output(['make',
+                                      '-s',
+                                      '-C', SIMBA_ROOT,
+                                      '--no-print-directory',
+                                      'print-TESTS',
+                                      'BOARD=' + board])
+
+    return output.decode('utf-8').split()
+
+
+def main():
+    parser = argparse.ArgumentParser(
+        description='Build and run test suites in parallel.')
+    parser.add_argument('-j', '--jobs',
+                        type=int,
+                        default=4,
+                        help='Number of suites to run in parallel (default: %(default)s).')
+    parser.add_argument('-t', '--timeout',
+                        type=float,
+                        default=120.0,
+                        help='Execution timeout per suite in seconds (default: %(default)s).')
+    parser.add_argument('--build-timeout',
+                        type=float,
+                        default=900.0,
+                        help='Build timeout per suite in seconds (default: %(default)s).')
+    parser.add_argument('-b', '--board',
+                        default='linux',
+                        help='Board (default: %(default)s).')
+    parser.add_argument('--virtual-time',
+                        action='store_true',
+                        help=('Build the suites with virtual time, in a separate '
+                              'build folder.'))
+    parser.add_argument('--junit',
+                        help='JUnit XML output file.')
+    parser.add_argument('suites',
+                        nargs='*',
+                        help='Test suites to run (default: all suites of the board).')
+    args = parser.parse_args()
+
+    if args.suites:
+        suites = [Suite(path, os.path.abspath(path)) for path in args.suites]
+    else:
+        suites = [Suite(path, os.path.join(SIMBA_ROOT, path))
+                  for path in get_suites(args.board)]
+
+    queue = Queue()
+    lock = threading.Lock()
+    threads = []
+    start = time.time()
+
+    for suite in suites:
+        queue.put(suite)
+
+    for _ in range(args.jobs):
+        queue.put(None)
+        thread = threading.Thread(target=worker, args=(queue, args, lock))
+        thread.daemon = True
+        thread.start()
+        threads.append(thread)
+
+    for thread in threads:
+        thread.join()
+
+    duration = time.time() - start
+    passed = sum([suite.status == 'PASSED' for suite in suites])
+
+    print()
+    print('test runner report: total({}), passed({}), failed({}), '
+          'time({:.1f} s)'.format(len(suites),
+                                  passed,
+                                  len(suites) - passed,
+                                  duration))
+
+    if args.junit:
+        write_junit(args.junit, suites, duration)
+
+    if passed != len(suites):
+        sys.exit(1)
+
+
+if __name__ == '__main__':
+    main()
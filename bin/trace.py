@@ -0,0 +1,181 @@
+#!/usr/bin/env python
+
+"""Convert a scheduler trace printed by /debug/trace/print into a
+Chrome trace event JSON file, viewable in chrome://tracing or the
+Perfetto UI.
+
+"""
+
+import sys
+import json
+import argparse
+
+
+TYPES = {
+    1: 'switch',
+    2: 'resume',
+    3: 'timer_expire',
+    4: 'queue_block',
+    5: 'queue_unblock',
+    6: 'sem_block',
+    7: 'sem_unblock',
+    8: 'mutex_block',
+    9: 'mutex_unblock'
+}
+
+TYPE_THRD_SWITCH = 1
+TYPE_THRD_RESUME = 2
+
+
+def parse(lines):
+    """Returns a dictionary of thread names and a list of records.
+
+    """
+
+    threads = {}
+    records = []
+    inside = False
+
+    for line in lines:
+        words = line.split()
+
+        if not words:
+            continue
+
+        if words[0] == 'TRACE-BEGIN':
+            threads = {}
+            records = []
+            inside = True
+        elif words[0] == 'TRACE-END':
+            inside = False
+        elif not inside:
+            continue
+        elif words[0] == 'thread':
+            threads[int(words[1], 16)] = ' '.join(words[2:])
+        elif words[0] == 'record':
+            records.append((int(words[1], 16),
+                            int(words[2]),
+                            int(words[3], 16),
+                            int(words[4])))
+
+    return threads, records
+
+
+def unwrap(records):
+    """Convert the 32 bits timestamps to monotonic timestamps.
+
+    """
+
+    offset = 0
+    previous = None
+    unwrapped = []
+
+    for timestamp, kind, obj, value in records:
+        if previous is not None and timestamp < previous:
+            offset += (1 << 32)
+
+        previous = timestamp
+        unwrapped.append((timestamp + offset, kind, obj, value))
+
+    return unwrapped
+
+
+def convert(threads, records, frequency):
+    """Create a list of trace events.
+
+    """
+
+    tids = {}
+    events = []
+
+    def tid_of(obj):
+        if obj not in tids:
+            tids[obj] = len(tids) + 1
+            events.append({
+                'name': 'thread_name',
+                'ph': 'M',
+                'pid': 1,
+                'tid': tids[obj],
+                'args': {
+                    'name': threads.get(obj, '0x{:08x}'.format(obj))
+                }
+            })
+
+        return tids[obj]
+
+    def us(timestamp):
+        return 1000000.0 * (timestamp - records[0][0]) / frequency
+
+    current = None
+    start = None
+
+    for timestamp, kind, obj, value in records:
+        if kind == TYPE_THRD_SWITCH:
+            if current is not None:
+                events.append({
+                    'name': threads.get(current, 'unknown'),
+                    'ph': 'X',
+                    'pid': 1,
+                    'tid': tid_of(current),
+                    'ts': us(start),
+                    'dur': us(timestamp) - us(start)
+                })
+
+            current = obj
+            start = timestamp
+        else:
+            if kind == TYPE_THRD_RESUME:
+                tid = tid_of(obj)
+            elif current is not None:
+                tid = tid_of(current)
+            else:
+                tid = 0
+
+            events.append({
+                'name': TYPES.get(kind, str(kind)),
+                'ph': 'i',
+                's': 't',
+                'pid': 1,
+                'tid': tid,
+                'ts': us(timestamp),
+                'args': {
+                    'object': '0x{:08x}'.format(obj),
+                    'value': value
+                }
+            })
+
+    return events
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__)
+    parser.add_argument('-f', '--frequency',
+                        type=float,
+                        default=1000000.0,
+                        help=('Timestamp frequency in Hz, the CPU clock '
+                              'frequency on target (default: 1000000, '
+                              'microseconds on Linux).'))
+    parser.add_argument('-o', '--output',
+                        help='Output file (default: stdout).')
+    parser.add_argument('infile',
+                        help='File with the output of /debug/trace/print.')
+    args = parser.parse_args()
+
+    with open(args.infile) as fin:
+        threads, records = parse(fin)
+
+    if not records:
+        sys.exit('No trace records found.')
+
+    events = convert(threads, unwrap(records), args.frequency)
+    output = json.dumps({'traceEvents': events}, indent=1)
+
+    if args.output:
+        with open(args.output, 'w') as fout:
+            fout.write(output)
+    else:
+        print(output)
+
+
+if __name__ == '__main__':
+    main()
@@ -9,7 +9,26 @@ import struct
 import zlib
 
 
-def create_header(binary, description):
+# Data formats in version 2 headers.
+BINARY_FORMAT_RAW = 0
+BINARY_FORMAT_PATCH = 1
+
+# Patch operations.
+PATCH_OP_COPY = 1
+PATCH_OP_DIFF = 2
+PATCH_OP_EXTRA = 3
+PATCH_OP_SEEK = 4
+
+# Minimum length of a match, and the number of bytes without an
+# improvement before a match ends.
+PATCH_MATCH_SIZE = 8
+PATCH_MATCH_LOOKAHEAD = 64
+
+# Shorter zero runs in diff data are not worth a copy operation.
+PATCH_COPY_SIZE_MIN = 4
+
+
+def create_header(binary, description, from_binary=None):
     """Create the upgrade binary header for given binary data.
 
    SIZE       TYPE  DESCRIPTION
@@ -21,6 +40,21 @@ def create_header(binary, description):
       4   uint32_t  CRC32 of the header (not including this field)
      0+  uint8_t[]  data
 
+    A patch has a version 2 header, where the data size and SHA1 are
+    of the application after the patch is applied.
+
+   SIZE       TYPE  DESCRIPTION
+      4   uint32_t  header version (2)
+      4   uint32_t  header size in bytes
+      4   uint32_t  data size in bytes
+     20  uint8_t[]  SHA1 of the data
+      4   uint32_t  data format (1 for patch)
+      4   uint32_t  current application size in bytes
+     20  uint8_t[]  SHA1 of the current application
+     1+   c-string  data description
+      4   uint32_t  CRC32 of the header (not including this field)
+     0+  uint8_t[]  patch
+
     """
 
     description += '\0'
@@ -28,31 +62,214 @@ def create_header(binary, description):
     if len(description) % 4 != 0:
         description += (4 - (len(description) % 4)) * '\0'
 
-    header = struct.pack('>III',
-                         1,
-                         36 + len(description),
-                         len(binary))
-    header += hashlib.sha1(binary).digest()
-    header += description
+    if from_binary is None:
+        header = struct.pack('>III',
+                             1,
+                             36 + len(description),
+                             len(binary))
+        header += hashlib.sha1(binary).digest()
+    else:
+        header = struct.pack('>III',
+                             2,
+                             64 + len(description),
+                             len(binary))
+        header += hashlib.sha1(binary).digest()
+        header += struct.pack('>II', BINARY_FORMAT_PATCH, len(from_binary))
+        header += hashlib.sha1(from_binary).digest()
+
+    header += description.encode('ascii')
     header += struct.pack('>I', zlib.crc32(header) & 0xffffffff)
 
     return header
 
+
+def pack_value(value):
+    """LEB128 encode given unsigned value.
+
+    """
+
+    packed = bytearray()
+
+    while value >= 0x80:
+        packed.append((value & 0x7f) | 0x80)
+        value >>= 7
+
+    packed.append(value)
+
+    return packed
+
+
+def pack_op(op, value):
+    return bytearray([op]) + pack_value(value)
+
+
+def match_size(from_binary, from_offset, to_binary, to_offset):
+    """Returns the size of the approximate match at given offsets. The
+    match is extended as long as more bytes are equal than not, as
+    in bsdiff.
+
+    """
+
+    size = min(len(from_binary) - from_offset, len(to_binary) - to_offset)
+    score = 0
+    best_score = 0
+    best_size = 0
+    i = 0
+
+    while i < size and i - best_size < PATCH_MATCH_LOOKAHEAD:
+        if from_binary[from_offset + i] == to_binary[to_offset + i]:
+            score += 1
+        else:
+            score -= 1
+
+        i += 1
+
+        if score > best_score:
+            best_score = score
+            best_size = i
+
+    return best_size
+
+
+def pack_match(from_binary, from_offset, to_binary, to_offset, size):
+    """Pack given match as copy operations of unchanged bytes and diff
+    operations of changed bytes.
+
+    """
+
+    diff = bytearray([(to_binary[to_offset + i]
+                       - from_binary[from_offset + i]) & 0xff
+                      for i in range(size)])
+    packed = bytearray()
+    begin = 0
+
+    while begin < size:
+        end = begin
+
+        while end < size and diff[end] == 0:
+            end += 1
+
+        if end - begin >= PATCH_COPY_SIZE_MIN or end == size:
+            packed += pack_op(PATCH_OP_COPY, end - begin)
+            begin = end
+
+        # Diff bytes until the next zero run long enough to copy.
+        end = begin
+
+        while end < size:
+            if (diff[end:end + PATCH_COPY_SIZE_MIN]
+                == bytearray(PATCH_COPY_SIZE_MIN)):
+                break
+
+            end += 1
+
+        if end > begin:
+            packed += pack_op(PATCH_OP_DIFF, end - begin)
+            packed += diff[begin:end]
+            begin = end
+
+    return packed
+
+
+def create_patch(from_binary, to_binary):
+    """Create a patch that converts given current application to given
+    new application. Each part of the new application is either
+    found at about the same place in the current application, and
+    written as the difference, or written as is.
+
+    """
+
+    from_binary = bytearray(from_binary)
+    to_binary = bytearray(to_binary)
+    index = {}
+
+    for i in range(len(from_binary) - PATCH_MATCH_SIZE + 1):
+        index.setdefault(bytes(from_binary[i:i + PATCH_MATCH_SIZE]), i)
+
+    patch = bytearray()
+    from_offset = 0
+    to_offset = 0
+    extra_offset = 0
+
+    while to_offset < len(to_binary):
+        # Try the position following the previous match first.
+        candidates = [from_offset]
+        key = bytes(to_binary[to_offset:to_offset + PATCH_MATCH_SIZE])
+
+        if key in index:
+            candidates.append(index[key])
+
+        best_size = 0
+        best_offset = 0
+
+        for offset in candidates:
+            size = match_size(from_binary, offset, to_binary, to_offset)
+
+            if size > best_size:
+                best_size = size
+                best_offset = offset
+
+        if best_size < PATCH_MATCH_SIZE:
+            to_offset += 1
+            continue
+
+        if to_offset > extra_offset:
+            patch += pack_op(PATCH_OP_EXTRA, to_offset - extra_offset)
+            patch += to_binary[extra_offset:to_offset]
+
+        if best_offset != from_offset:
+            adjustment = best_offset - from_offset
+
+            # Zigzag encode the signed adjustment.
+            if adjustment < 0:
+                adjustment = ((-adjustment) << 1) - 1
+            else:
+                adjustment <<= 1
+
+            patch += pack_op(PATCH_OP_SEEK, adjustment)
+
+        patch += pack_match(from_binary,
+                            best_offset,
+                            to_binary,
+                            to_offset,
+                            best_size)
+        from_offset = best_offset + best_size
+        to_offset += best_size
+        extra_offset = to_offset
+
+    if len(to_binary) > extra_offset:
+        patch += pack_op(PATCH_OP_EXTRA, len(to_binary) - extra_offset)
+        patch += to_binary[extra_offset:]
+
+    return bytes(patch)
+
+
 def main():
     parser = argparse.ArgumentParser()
     parser.add_argument('-o', '--output')
     parser.add_argument('-d', '--description', default="")
+    parser.add_argument('-f', '--from-binary',
+                        help=('Create a patch of given current application '
+                              'binary file instead.'))
     parser.add_argument('binary')
     args = parser.parse_args()
 
-    with open(args.binary) as fin:
+    with open(args.binary, 'rb') as fin:
         binary = fin.read()
 
-    header = create_header(binary, args.description)
+    if args.from_binary:
+        with open(args.from_binary, 'rb') as fin:
+            from_binary = fin.read()
+
+        header = create_header(binary, args.description, from_binary)
+        data = create_patch(from_binary, binary)
+    else:
+        header = create_header(binary, args.description)
+        data = binary
 
     with open(args.output, 'wb') as fout:
         fout.write(header)
-        fout.write(binary)
+        fout.write(data)
 
 
 
@@ -34,7 +34,8 @@ static struct network_interface_slip_t slip;
 
 int main()
 {
-    uint8_t data;
+    uint8_t buf[64];
+    size_t size;
     struct inet_ip_addr_t ipaddr;
     struct inet_ip_addr_t netmask;
     struct inet_ip_addr_t gateway;
@@ -63,8 +64,17 @@ int main()
     network_interface_start(&slip.network_interface);
 
     while (1) {
-        uart_read(&ipuart, &data, 1);
-        network_interface_slip_input(&slip, data);
+        /* Wait for at least one byte, then input all available
+           bytes at once. */
+        uart_read(&ipuart, &buf[0], 1);
+        size = chan_size(&ipuart);
+
+        if (size > sizeof(buf) - 1) {
+            size = sizeof(buf) - 1;
+        }
+
+        uart_read(&ipuart, &buf[1], size);
+        network_interface_slip_input_buffer(&slip, &buf[0], size + 1);
     }
 
     return (0);
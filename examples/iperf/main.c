@@ -0,0 +1,977 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2014-2018, Erik Moqvist
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use, copy,
+ * modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ * This file is part of the Simba project.
+ */
+
+#include "simba.h"
+
+/* Default iperf port. */
+#define PORT                                             5001
+
+/* Size of the read and write buffers, and the maximum datagram
+   length. */
+#ifndef BUFFER_SIZE
+#    define BUFFER_SIZE                                  1460
+#endif
+
+/* Maximum number of parallel streams of the servers and the
+   client. */
+#ifndef STREAMS_MAX
+#    define STREAMS_MAX                                     4
+#endif
+
+/* Server report flag of iperf 2. */
+#define HEADER_VERSION1                            0x80000000
+
+/* Number of times the final UDP datagram is sent while waiting for
+   the server report. */
+#define FIN_ATTEMPTS_MAX                                   10
+
+/* Header of every UDP datagram. */
+struct udp_datagram_t {
+    int32_t id;
+    uint32_t tv_sec;
+    uint32_t tv_usec;
+};
+
+/* Sent by the UDP server in response to the final datagram. */
+struct server_report_t {
+    int32_t flags;
+    int32_t total_len1;
+    int32_t total_len2;
+    int32_t stop_sec;
+    int32_t stop_usec;
+    int32_t error_cnt;
+    int32_t outorder_cnt;
+    int32_t datagrams;
+    int32_t jitter1;
+    int32_t jitter2;
+};
+
+#define REPORT_SIZE (sizeof(struct udp_datagram_t)     \
+                     + sizeof(struct server_report_t))
+
+struct tcp_stream_t {
+    int active;
+    struct socket_t socket;
+    struct inet_addr_t remote_addr;
+    struct time_t start;
+    uint64_t size;
+};
+
+enum udp_stream_state_t {
+    udp_stream_state_free_t = 0,
+    udp_stream_state_active_t,
+    udp_stream_state_done_t
+};
+
+struct udp_stream_t {
+    enum udp_stream_state_t state;
+    struct inet_addr_t remote_addr;
+    struct time_t start;
+    struct time_t stop;
+    uint64_t size;
+    int32_t last_id;
+    int32_t lost;
+    int32_t out_of_order;
+    int64_t last_transit;
+    /* RFC 1889 jitter in microseconds, scaled by 16. */
+    int64_t jitter;
+    struct server_report_t report;
+};
+
+struct client_args_t {
+    int udp;
+    size_t length;
+    int duration;
+    int streams;
+    unsigned long bitrate;
+    struct inet_addr_t remote_addr;
+};
+
+static struct tcp_stream_t tcp_streams[STREAMS_MAX];
+static struct udp_stream_t udp_streams[STREAMS_MAX];
+static struct socket_t client_sockets[STREAMS_MAX];
+
+static uint32_t tcp_server_buf[BUFFER_SIZE / 4];
+static uint32_t udp_server_buf[BUFFER_SIZE / 4];
+static uint32_t client_buf[BUFFER_SIZE / 4];
+
+static struct fs_command_t cmd_client;
+static struct shell_t shell;
+
+static THRD_STACK(tcp_server_stack, 2048);
+static THRD_STACK(udp_server_stack, 2048);
+
+static int64_t time_to_us(const struct time_t *time_p)
+{
+    return ((int64_t)time_p->seconds * 1000000
+            + time_p->nanoseconds / 1000);
+}
+
+static int64_t elapsed_us(const struct time_t *start_p)
+{
+    struct time_t now;
+
+    time_get(&now);
+
+    return (time_to_us(&now) - time_to_us(start_p));
+}
+
+/**
+ * Print the transferred size, the duration and the bitrate of given
+ * stream.
+ */
+static void print_report(void *chan_p,
+                         const char *name_p,
+                         int64_t duration,
+                         uint64_t size)
+{
+    int64_t duration_ms;
+    unsigned long kbits;
+
+    duration_ms = (duration / 1000);
+    kbits = 0;
+
+    if (duration_ms > 0) {
+        kbits = (unsigned long)((8 * size) / duration_ms);
+    }
+
+    std_fprintf(chan_p,
+                OSTR("[%s] %lu.%03lu sec  %lu KBytes  %lu Kbits/sec"),
+                name_p,
+                (unsigned long)(duration_ms / 1000),
+                (unsigned long)(duration_ms % 1000),
+                (unsigned long)(size / 1024),
+                kbits);
+}
+
+static void print_udp_report(void *chan_p,
+                             const char *name_p,
+                             const struct server_report_t *report_p)
+{
+    int64_t duration;
+    uint64_t size;
+    int32_t lost;
+    int32_t datagrams;
+    int32_t jitter;
+    unsigned long percent;
+
+    duration = ((int64_t)ntohl(report_p->stop_sec) * 1000000
+                + ntohl(report_p->stop_usec));
+    size = (((uint64_t)ntohl(report_p->total_len1) << 32)
+            | (uint32_t)ntohl(report_p->total_len2));
+    lost = ntohl(report_p->error_cnt);
+    datagrams = ntohl(report_p->datagrams);
+    jitter = (ntohl(report_p->jitter1) * 1000000
+              + ntohl(report_p->jitter2));
+    percent = 0;
+
+    if (datagrams > 0) {
+        percent = ((100UL * lost) / datagrams);
+    }
+
+    print_report(chan_p, name_p, duration, size);
+    std_fprintf(chan_p,
+                OSTR("  %lu.%03lu ms  %ld/%ld (%lu%%)  %ld out of order\r\n"),
+                (unsigned long)(jitter / 1000),
+                (unsigned long)(jitter % 1000),
+                (long)lost,
+                (long)datagrams,
+                percent,
+                (long)ntohl(report_p->outorder_cnt));
+}
+
+static struct tcp_stream_t *tcp_stream_alloc(void)
+{
+    int i;
+
+    for (i = 0; i < membersof(tcp_streams); i++) {
+        if (!tcp_streams[i].active) {
+            return (&tcp_streams[i]);
+        }
+    }
+
+    return (NULL);
+}
+
+static void tcp_server_accept(struct socket_t *listener_p,
+                              struct tcp_stream_t *stream_p)
+{
+    char buf[16];
+
+    if (socket_accept(listener_p,
+                      &stream_p->socket,
+                      &stream_p->remote_addr) != 0) {
+        return;
+    }
+
+    time_get(&stream_p->start);
+    stream_p->size = 0;
+    stream_p->active = 1;
+
+    std_printf(OSTR("[%d] TCP connection from %s:%u.\r\n"),
+               (int)(stream_p - &tcp_streams[0]),
+               inet_ntoa(&stream_p->remote_addr.ip, &buf[0]),
+               stream_p->remote_addr.port);
+}
+
+static void tcp_server_read(struct tcp_stream_t *stream_p, int revents)
+{
+    ssize_t size;
+    char name[8];
+
+    size = socket_size(&stream_p->socket);
+
+    if (size > 0) {
+        size = socket_read(&stream_p->socket,
+                           &tcp_server_buf[0],
+                           MIN(size, sizeof(tcp_server_buf)));
+
+        if (size > 0) {
+            stream_p->size += size;
+
+            return;
+        }
+    } else if ((revents & (SOCKET_POLLHUP | SOCKET_POLLERR)) == 0) {
+        return;
+    }
+
+    std_snprintf(&name[0],
+                 sizeof(name),
+                 FSTR("%3d"),
+                 (int)(stream_p - &tcp_streams[0]));
+    print_report(sys_get_stdout(),
+                 &name[0],
+                 elapsed_us(&stream_p->start),
+                 stream_p->size);
+    std_printf(OSTR("\r\n"));
+    socket_close(&stream_p->socket);
+    stream_p->active = 0;
+}
+
+/**
+ * Receive data from all iperf TCP clients, at most STREAMS_MAX at a
+ * time. All streams are served by this thread.
+ */
+static void *tcp_server_main(void *arg_p)
+{
+    struct socket_t listener;
+    struct inet_addr_t addr;
+    struct socket_pollfd_t fds[STREAMS_MAX + 1];
+    struct tcp_stream_t *streams[STREAMS_MAX + 1];
+    struct tcp_stream_t *stream_p;
+    int length;
+    int i;
+
+    thrd_set_name("iperf_tcp");
+
+    addr.ip.number = 0;
+    addr.port = PORT;
+
+    if (socket_open_tcp(&listener) != 0) {
+        std_printf(OSTR("Failed to open the TCP listener socket.\r\n"));
+
+        return (NULL);
+    }
+
+    if ((socket_bind(&listener, &addr) != 0)
+        || (socket_listen(&listener, STREAMS_MAX) != 0)) {
+        std_printf(OSTR("Failed to listen on TCP port %d.\r\n"), PORT);
+        socket_close(&listener);
+
+        return (NULL);
+    }
+
+    while (1) {
+        length = 0;
+        stream_p = tcp_stream_alloc();
+
+        /* Only accept new clients if there is a free stream. */
+        if (stream_p != NULL) {
+            fds[length].chan_p = &listener;
+            fds[length].events = SOCKET_POLLIN;
+            streams[length] = NULL;
+            length++;
+        }
+
+        for (i = 0; i < membersof(tcp_streams); i++) {
+            if (tcp_streams[i].active) {
+                fds[length].chan_p = &tcp_streams[i].socket;
+                fds[length].events = SOCKET_POLLIN;
+                streams[length] = &tcp_streams[i];
+                length++;
+            }
+        }
+
+        if (socket_poll(&fds[0], length, NULL) <= 0) {
+            continue;
+        }
+
+        for (i = 0; i < length; i++) {
+            if (fds[i].revents == 0) {
+                continue;
+            }
+
+            if (streams[i] == NULL) {
+                tcp_server_accept(&listener, stream_p);
+            } else {
+                tcp_server_read(streams[i], fds[i].revents);
+            }
+        }
+    }
+
+    return (NULL);
+}
+
+static struct udp_stream_t *udp_stream_find(struct inet_addr_t *addr_p)
+{
+    int i;
+
+    for (i = 0; i < membersof(udp_streams); i++) {
+        if ((udp_streams[i].state != udp_stream_state_free_t)
+            && (udp_streams[i].remote_addr.ip.number == addr_p->ip.number)
+            && (udp_streams[i].remote_addr.port == addr_p->port)) {
+            return (&udp_streams[i]);
+        }
+    }
+
+    return (NULL);
+}
+
+static void udp_stream_reset(struct udp_stream_t *stream_p,
+                             struct inet_addr_t *addr_p)
+{
+    memset(stream_p, 0, sizeof(*stream_p));
+    stream_p->state = udp_stream_state_active_t;
+    stream_p->remote_addr = *addr_p;
+    stream_p->last_id = -1;
+}
+
+/**
+ * Allocate a stream for a new client, preferably a free one and
+ * otherwise the one that finished first.
+ */
+static struct udp_stream_t *udp_stream_alloc(struct inet_addr_t *addr_p)
+{
+    struct udp_stream_t *stream_p;
+    int i;
+
+    stream_p = NULL;
+
+    for (i = 0; i < membersof(udp_streams); i++) {
+        if (udp_streams[i].state == udp_stream_state_free_t) {
+            stream_p = &udp_streams[i];
+            break;
+        }
+
+        if (udp_streams[i].state == udp_stream_state_done_t) {
+            if ((stream_p == NULL)
+                || (time_to_us(&udp_streams[i].stop)
+                    < time_to_us(&stream_p->stop))) {
+                stream_p = &udp_streams[i];
+            }
+        }
+    }
+
+    if (stream_p != NULL) {
+        udp_stream_reset(stream_p, addr_p);
+    }
+
+    return (stream_p);
+}
+
+static void udp_stream_finish(struct udp_stream_t *stream_p,
+                              int32_t datagrams)
+{
+    int64_t duration;
+    int64_t jitter;
+    struct server_report_t *report_p;
+    char name[8];
+
+    duration = (time_to_us(&stream_p->stop) - time_to_us(&stream_p->start));
+    jitter = (stream_p->jitter / 16);
+    report_p = &stream_p->report;
+
+    report_p->flags = htonl(HEADER_VERSION1);
+    report_p->total_len1 = htonl((uint32_t)(stream_p->size >> 32));
+    report_p->total_len2 = htonl((uint32_t)stream_p->size);
+    report_p->stop_sec = htonl((int32_t)(duration / 1000000));
+    report_p->stop_usec = htonl((int32_t)(duration % 1000000));
+    report_p->error_cnt = htonl(stream_p->lost
+                                + datagrams
+                                - (stream_p->last_id + 1));
+    report_p->outorder_cnt = htonl(stream_p->out_of_order);
+    report_p->datagrams = htonl(datagrams);
+    report_p->jitter1 = htonl((int32_t)(jitter / 1000000));
+    report_p->jitter2 = htonl((int32_t)(jitter % 1000000));
+    stream_p->state = udp_stream_state_done_t;
+
+    std_snprintf(&name[0],
+                 sizeof(name),
+                 FSTR("%3d"),
+                 (int)(stream_p - &udp_streams[0]));
+    print_udp_report(sys_get_stdout(), &name[0], report_p);
+}
+
+static void udp_stream_update(struct udp_stream_t *stream_p,
+                              struct udp_datagram_t *datagram_p,
+                              int32_t id,
+                              size_t size)
+{
+    int64_t transit;
+    int64_t delta;
+
+    time_get(&stream_p->stop);
+
+    if (stream_p->size == 0) {
+        stream_p->start = stream_p->stop;
+    }
+
+    stream_p->size += size;
+
+    /* Lost and reordered datagrams. */
+    if (id > stream_p->last_id) {
+        stream_p->lost += (id - stream_p->last_id - 1);
+        stream_p->last_id = id;
+    } else {
+        stream_p->out_of_order++;
+
+        if (stream_p->lost > 0) {
+            stream_p->lost--;
+        }
+    }
+
+    /* Jitter as specified in RFC 1889. */
+    transit = (time_to_us(&stream_p->stop)
+               - ((int64_t)ntohl(datagram_p->tv_sec) * 1000000
+                  + ntohl(datagram_p->tv_usec)));
+
+    if (stream_p->size > size) {
+        delta = (transit - stream_p->last_transit);
+
+        if (delta < 0) {
+            delta = -delta;
+        }
+
+        stream_p->jitter += (delta - ((stream_p->jitter + 8) / 16));
+    }
+
+    stream_p->last_transit = transit;
+}
+
+/**
+ * Receive datagrams from all iperf UDP clients and respond to the
+ * final datagram of each stream with a server report.
+ */
+static void *udp_server_main(void *arg_p)
+{
+    struct socket_t socket;
+    struct inet_addr_t addr;
+    struct udp_datagram_t datagram;
+    struct udp_stream_t *stream_p;
+    ssize_t size;
+    int32_t id;
+
+    thrd_set_name("iperf_udp");
+
+    addr.ip.number = 0;
+    addr.port = PORT;
+
+    if (socket_open_udp(&socket) != 0) {
+        std_printf(OSTR("Failed to open the UDP socket.\r\n"));
+
+        return (NULL);
+    }
+
+    if (socket_bind(&socket, &addr) != 0) {
+        std_printf(OSTR("Failed to bind to UDP port %d.\r\n"), PORT);
+        socket_close(&socket);
+
+        return (NULL);
+    }
+
+    while (1) {
+        size = socket_recvfrom(&socket,
+                               &udp_server_buf[0],
+                               sizeof(udp_server_buf),
+                               0,
+                               &addr);
+
+        if (size < (ssize_t)sizeof(datagram)) {
+            continue;
+        }
+
+        memcpy(&datagram, &udp_server_buf[0], sizeof(datagram));
+        id = ntohl(datagram.id);
+        stream_p = udp_stream_find(&addr);
+
+        if (id >= 0) {
+            if (stream_p == NULL) {
+                stream_p = udp_stream_alloc(&addr);
+
+                if (stream_p == NULL) {
+                    continue;
+                }
+            } else if (stream_p->state == udp_stream_state_done_t) {
+                udp_stream_reset(stream_p, &addr);
+            }
+
+            udp_stream_update(stream_p, &datagram, id, size);
+        } else if (stream_p != NULL) {
+            /* The final datagram is retransmitted until the report
+               is received by the client. */
+            if (stream_p->state == udp_stream_state_active_t) {
+                udp_stream_finish(stream_p, -id);
+            }
+
+            memcpy(&((uint8_t *)udp_server_buf)[sizeof(datagram)],
+                   &stream_p->report,
+                   sizeof(stream_p->report));
+            socket_sendto(&socket,
+                          &udp_server_buf[0],
+                          MAX(size, REPORT_SIZE),
+                          0,
+                          &addr);
+        }
+    }
+
+    return (NULL);
+}
+
+static int parse_long(const char *value_p, long *number_p)
+{
+    const char *end_p;
+
+    end_p = std_strtol(value_p, number_p);
+
+    if ((end_p == NULL) || (*number_p < 0)) {
+        return (-EINVAL);
+    }
+
+    switch (*end_p) {
+
+    case '\0':
+        break;
+
+    case 'k':
+    case 'K':
+        *number_p *= 1000;
+        end_p++;
+        break;
+
+    case 'm':
+    case 'M':
+        *number_p *= 1000000;
+        end_p++;
+        break;
+
+    default:
+        return (-EINVAL);
+    }
+
+    return (*end_p == '\0' ? 0 : -EINVAL);
+}
+
+static int parse_args(int argc,
+                      const char *argv[],
+                      struct client_args_t *args_p)
+{
+    const char *host_p;
+    long value;
+    int i;
+
+    host_p = NULL;
+    args_p->udp = 0;
+    args_p->length = 0;
+    args_p->duration = 10;
+    args_p->streams = 1;
+    args_p->bitrate = 1000000;
+    args_p->remote_addr.port = PORT;
+
+    for (i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "-u") == 0) {
+            args_p->udp = 1;
+            continue;
+        }
+
+        if (argv[i][0] != '-') {
+            host_p = argv[i];
+            continue;
+        }
+
+        if ((i + 1 == argc) || (parse_long(argv[i + 1], &value) != 0)) {
+            return (-EINVAL);
+        }
+
+        if (strcmp(argv[i], "-l") == 0) {
+            args_p->length = value;
+        } else if (strcmp(argv[i], "-t") == 0) {
+            args_p->duration = value;
+        } else if (strcmp(argv[i], "-P") == 0) {
+            args_p->streams = value;
+        } else if (strcmp(argv[i], "-b") == 0) {
+            args_p->bitrate = value;
+        } else if (strcmp(argv[i], "-p") == 0) {
+            args_p->remote_addr.port = value;
+        } else {
+            return (-EINVAL);
+        }
+
+        i++;
+    }
+
+    if (args_p->length == 0) {
+        args_p->length = (args_p->udp ? 1470 : BUFFER_SIZE);
+    }
+
+    args_p->length = MIN(args_p->length, BUFFER_SIZE);
+
+    if ((host_p == NULL)
+        || (args_p->length < REPORT_SIZE)
+        || (args_p->duration <= 0)
+        || (args_p->streams <= 0)
+        || (args_p->streams > STREAMS_MAX)
+        || (args_p->bitrate == 0)) {
+        return (-EINVAL);
+    }
+
+    return (inet_aton(host_p, &args_p->remote_addr.ip));
+}
+
+static void client_close(int streams)
+{
+    int i;
+
+    for (i = 0; i < streams; i++) {
+        socket_close(&client_sockets[i]);
+    }
+}
+
+/**
+ * Send data on all streams for the given duration, as fast as
+ * possible.
+ */
+static int tcp_client(void *out_p, struct client_args_t *args_p)
+{
+    struct socket_pollfd_t fds[STREAMS_MAX];
+    uint64_t sizes[STREAMS_MAX];
+    uint64_t total;
+    struct time_t start;
+    struct time_t timeout;
+    int64_t duration;
+    int64_t elapsed;
+    ssize_t size;
+    char name[8];
+    int i;
+
+    for (i = 0; i < args_p->streams; i++) {
+        if (socket_open_tcp(&client_sockets[i]) != 0) {
+            client_close(i);
+
+            return (-1);
+        }
+
+        if (socket_connect(&client_sockets[i], &args_p->remote_addr) != 0) {
+            std_fprintf(out_p, OSTR("Failed to connect to the server.\r\n"));
+            client_close(i + 1);
+
+            return (-1);
+        }
+
+        socket_set_nonblocking(&client_sockets[i], 1);
+        fds[i].chan_p = &client_sockets[i];
+        fds[i].events = SOCKET_POLLOUT;
+        sizes[i] = 0;
+    }
+
+    duration = (1000000LL * args_p->duration);
+    time_get(&start);
+
+    while (1) {
+        elapsed = elapsed_us(&start);
+
+        if (elapsed >= duration) {
+            break;
+        }
+
+        timeout.seconds = ((duration - elapsed) / 1000000);
+        timeout.nanoseconds = (((duration - elapsed) % 1000000) * 1000);
+
+        if (socket_poll(&fds[0], args_p->streams, &timeout) <= 0) {
+            continue;
+        }
+
+        for (i = 0; i < args_p->streams; i++) {
+            if (fds[i].revents & (SOCKET_POLLERR | SOCKET_POLLHUP)) {
+                std_fprintf(out_p, OSTR("Connection closed by the server.\r\n"));
+                client_close(args_p->streams);
+
+                return (-1);
+            }
+
+            if ((fds[i].revents & SOCKET_POLLOUT) == 0) {
+                continue;
+            }
+
+            size = socket_write(&client_sockets[i],
+                                &client_buf[0],
+                                args_p->length);
+
+            if (size > 0) {
+                sizes[i] += size;
+            }
+        }
+    }
+
+    elapsed = elapsed_us(&start);
+    total = 0;
+
+    for (i = 0; i < args_p->streams; i++) {
+        std_snprintf(&name[0], sizeof(name), FSTR("%3d"), i);
+        print_report(out_p, &name[0], elapsed, sizes[i]);
+        std_fprintf(out_p, OSTR("\r\n"));
+        total += sizes[i];
+    }
+
+    if (args_p->streams > 1) {
+        print_report(out_p, "SUM", elapsed, total);
+        std_fprintf(out_p, OSTR("\r\n"));
+    }
+
+    client_close(args_p->streams);
+
+    return (0);
+}
+
+static void udp_client_write(struct socket_t *socket_p,
+                             struct client_args_t *args_p,
+                             int32_t id)
+{
+    struct udp_datagram_t datagram;
+    struct time_t now;
+
+    time_get(&now);
+    datagram.id = htonl(id);
+    datagram.tv_sec = htonl(now.seconds);
+    datagram.tv_usec = htonl(now.nanoseconds / 1000);
+    memcpy(&client_buf[0], &datagram, sizeof(datagram));
+    socket_sendto(socket_p,
+                  &client_buf[0],
+                  args_p->length,
+                  0,
+                  &args_p->remote_addr);
+}
+
+/**
+ * Send the final datagram until the server report is received.
+ */
+static void udp_client_finish(void *out_p,
+                              struct socket_t *socket_p,
+                              struct client_args_t *args_p,
+                              int32_t datagrams,
+                              const char *name_p)
+{
+    struct server_report_t report;
+    struct inet_addr_t addr;
+    struct time_t timeout;
+    ssize_t size;
+    int attempt;
+
+    timeout.seconds = 0;
+    timeout.nanoseconds = 250000000;
+
+    for (attempt = 0; attempt < FIN_ATTEMPTS_MAX; attempt++) {
+        udp_client_write(socket_p, args_p, -datagrams);
+
+        if (chan_poll(socket_p, &timeout) == NULL) {
+            continue;
+        }
+
+        size = socket_recvfrom(socket_p,
+                               &client_buf[0],
+                               sizeof(client_buf),
+                               0,
+                               &addr);
+
+        if (size >= (ssize_t)REPORT_SIZE) {
+            memcpy(&report,
+                   &((uint8_t *)client_buf)[sizeof(struct udp_datagram_t)],
+                   sizeof(report));
+            std_fprintf(out_p, OSTR("Server report:\r\n"));
+            print_udp_report(out_p, name_p, &report);
+
+            return;
+        }
+    }
+
+    std_fprintf(out_p, OSTR("No server report received.\r\n"));
+}
+
+/**
+ * Send datagrams on all streams for the given duration, each stream
+ * at the given bitrate.
+ */
+static int udp_client(void *out_p, struct client_args_t *args_p)
+{
+    struct inet_addr_t addr;
+    struct time_t start;
+    int64_t duration;
+    int64_t period;
+    int64_t next;
+    int64_t elapsed;
+    int32_t datagrams;
+    char name[8];
+    int i;
+
+    addr.ip.number = 0;
+    addr.port = 0;
+
+    for (i = 0; i < args_p->streams; i++) {
+        if (socket_open_udp(&client_sockets[i]) != 0) {
+            client_close(i);
+
+            return (-1);
+        }
+
+        if (socket_bind(&client_sockets[i], &addr) != 0) {
+            client_close(i + 1);
+
+            return (-1);
+        }
+    }
+
+    memset(&client_buf[0], 0, sizeof(client_buf));
+    duration = (1000000LL * args_p->duration);
+    period = ((8000000LL * args_p->length) / args_p->bitrate);
+    next = 0;
+    datagrams = 0;
+    time_get(&start);
+
+    while (1) {
+        elapsed = elapsed_us(&start);
+
+        if (elapsed >= duration) {
+            break;
+        }
+
+        /* Datagrams are sent at absolute points in time to keep the
+           average bitrate even if the sleep resolution is low. */
+        if (elapsed < next) {
+            thrd_sleep_us(next - elapsed);
+            continue;
+        }
+
+        for (i = 0; i < args_p->streams; i++) {
+            udp_client_write(&client_sockets[i], args_p, datagrams);
+        }
+
+        datagrams++;
+        next += period;
+    }
+
+    elapsed = elapsed_us(&start);
+
+    for (i = 0; i < args_p->streams; i++) {
+        std_snprintf(&name[0], sizeof(name), FSTR("%3d"), i);
+        print_report(out_p,
+                     &name[0],
+                     elapsed,
+                     (uint64_t)datagrams * args_p->length);
+        std_fprintf(out_p, OSTR("  %ld datagrams\r\n"), (long)datagrams);
+        udp_client_finish(out_p,
+                          &client_sockets[i],
+                          args_p,
+                          datagrams,
+                          &name[0]);
+    }
+
+    client_close(args_p->streams);
+
+    return (0);
+}
+
+static int cmd_client_cb(int argc,
+                         const char *argv[],
+                         void *out_p,
+                         void *in_p,
+                         void *arg_p,
+                         void *call_arg_p)
+{
+    struct client_args_t args;
+
+    if (parse_args(argc, argv, &args) != 0) {
+        std_fprintf(out_p,
+                    OSTR("Usage: client [-u] [-l <length>] [-t <seconds>] "
+                         "[-P <streams>] [-b <bits/s>] [-p <port>] "
+                         "<server ip>\r\n"));
+
+        return (-EINVAL);
+    }
+
+    if (args.udp) {
+        return (udp_client(out_p, &args));
+    } else {
+        return (tcp_client(out_p, &args));
+    }
+}
+
+int main()
+{
+    sys_start();
+
+    std_printf(sys_get_info());
+
+    /* The servers are always running, as 'iperf -s' and 'iperf -s
+       -u'. */
+    thrd_spawn(tcp_server_main,
+               NULL,
+               0,
+               tcp_server_stack,
+               sizeof(tcp_server_stack));
+    thrd_spawn(udp_server_main,
+               NULL,
+               0,
+               udp_server_stack,
+               sizeof(udp_server_stack));
+
+    fs_command_init(&cmd_client,
+                    CSTR("/iperf/client"),
+                    cmd_client_cb,
+                    NULL);
+    fs_command_register(&cmd_client);
+
+    shell_init(&shell,
+               sys_get_stdin(),
+               sys_get_stdout(),
+               NULL,
+               NULL,
+               NULL,
+               NULL);
+    shell_main(&shell);
+
+    return (0);
+}
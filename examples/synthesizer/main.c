@@ -409,28 +409,19 @@ static int cmd_channel_off_cb(int argc,
 }
 
 static int handle_note_off(struct channel_t *channel_p,
-                           uint8_t *buf_p,
-                           size_t size)
+                           const struct midi_event_t *event_p)
 {
-    int note;
-
-    uart_read(&uart_midi, &buf_p[size], 2 - size);
-    note = *buf_p;
-
-    return (note_off(channel_p, note));
+    return (note_off(channel_p, event_p->data[0]));
 }
 
 static int handle_note_on(struct channel_t *channel_p,
-                          uint8_t *buf_p,
-                          size_t size)
+                          const struct midi_event_t *event_p)
 {
     int note;
     int velocity;
 
-    uart_read(&uart_midi, buf_p + size, 2 - size);
-
-    note = buf_p[0];
-    velocity = buf_p[1];
+    note = event_p->data[0];
+    velocity = event_p->data[1];
 
     if (channel_get_id(channel_p) == 9) {
         return (0);
@@ -512,53 +503,29 @@ static void *sensors_main(void *arg_p)
 }
 
 /**
- * A thread that reads the MIDI input and configures the synthesizer
- * accordingly.
+ * Handle MIDI events parsed from the MIDI input.
  */
-static void *midi_main(void *arg_p)
+static void on_midi_events(void *arg_p,
+                           const struct midi_event_t *events_p,
+                           size_t length)
 {
-    uint8_t buf[3], previous_status = 0;
-    uint8_t *buf_p;
-    uint8_t status;
-    int command;
-    int channel;
-    size_t size;
-
-    while (1) {
-        /* Wait for a MIDI command on the serial port. */
-        buf_p = buf;
-        uart_read(&uart_midi, buf_p, 1);
-
-        /* Use the previous status if a data byte is read. */
-        if ((*buf_p & 0x80) != 0) {
-            status = *buf_p++;
-            size = 0;
-        } else {
-            status = previous_status;
-            size = 1;
-        }
+    size_t i;
+    struct channel_t *channel_p;
 
-        /* Extract the command and the channel from the status. */
-        command = (status & 0xf0);
-        channel = (status & 0x0f);
+    for (i = 0; i < length; i++) {
+        channel_p = &synthesizer.channels[events_p[i].status & 0x0f];
 
-        switch (command) {
+        switch (events_p[i].status & 0xf0) {
 
         case MIDI_NOTE_OFF:
-            handle_note_off(&synthesizer.channels[channel],
-                            buf_p,
-                            size);
+            handle_note_off(channel_p, &events_p[i]);
             break;
 
         case MIDI_NOTE_ON:
-            handle_note_on(&synthesizer.channels[channel],
-                           buf_p,
-                           size);
-            previous_status = status;
+            handle_note_on(channel_p, &events_p[i]);
             break;
 
         case MIDI_SET_INTRUMENT:
-            uart_read(&uart_midi, buf_p, 1);
             break;
 
         default:
@@ -566,6 +533,22 @@ static void *midi_main(void *arg_p)
             break;
         }
     }
+}
+
+/**
+ * A thread that reads the MIDI input and configures the synthesizer
+ * accordingly.
+ */
+static void *midi_main(void *arg_p)
+{
+    struct midi_parser_t parser;
+
+    midi_parser_init(&parser, on_midi_events, NULL, NULL);
+
+    while (1) {
+        /* Wait for MIDI messages on the serial port. */
+        midi_parser_read(&parser, &uart_midi);
+    }
 
     return (NULL);
 }
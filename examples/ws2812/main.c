@@ -44,6 +44,7 @@ int main()
     int i;
 
     sys_start();
+    ws2812_module_init();
 
     ws2812_init(&ws2812, &pins[0], 1);
 
@@ -72,6 +72,12 @@ CLEAN = $(BUILDDIR) $(EXE) $(RUNLOG) size.log \
         coverage.log coverage.xml gmon.out *.gcov profile.log \
 	index.*html coverage coverage.info
 STUB ?=
+
+# Functions to place in RAM in addition to the ones declared with
+# RAM_CODE, for example the most sampled functions printed by
+# profiler.py --ram-code-functions. Requires -ffunction-sections.
+RAM_CODE_FUNCTIONS ?=
+RAM_CODE_SECTION ?= .ramfunc
 ENDIANESS ?= little
 
 EEPROM_SOFT_CHUNK_SIZE ?= 2048
@@ -222,6 +228,9 @@ else
 endif
 ifneq ($(STUB),)
 	stub.py patch "$(CROSS_COMPILE)" $$@ $$< $(STUB)
+endif
+ifneq ($(RAM_CODE_FUNCTIONS),)
+	$(CROSS_COMPILE)objcopy $(RAM_CODE_FUNCTIONS:%=--rename-section .text.%=$(RAM_CODE_SECTION).%) $$@
 endif
 	gcc -MM -MT $$@ $$(INC:%=-I%) $$(CDEFS:%=-D%) -o $(patsubst %.c,$(DEPSDIR)%.o.dep,$(abspath $1)) $$<
 endef
@@ -243,6 +252,9 @@ else
 endif
 ifneq ($(STUB),)
 	stub.py patch "$(CROSS_COMPILE)" $$@ $$< $(STUB)
+endif
+ifneq ($(RAM_CODE_FUNCTIONS),)
+	$(CROSS_COMPILE)objcopy $(RAM_CODE_FUNCTIONS:%=--rename-section .text.%=$(RAM_CODE_SECTION).%) $$@
 endif
 	$$(CXX) -MM -MT $$@ $$(INC:%=-I%) $$(CDEFS:%=-D%) -std=c++11 -o $(patsubst %.cpp,$(DEPSDIR)%.o.dep,$(abspath $1)) $$<
 endef
@@ -284,6 +296,7 @@ $(SOAMDBAPP) $(SIMBA_GEN_O): $(OBJ)
 	    --endianess $(ENDIANESS) \
 	    --eeprom-soft-chunk-size $(EEPROM_SOFT_CHUNK_SIZE) \
 	    $(SETTINGS_INI:%=--settings %) \
+	    $(OBJ:%=--object %) \
 	    $(SOAMDB)
 	@echo "CC $(SIMBA_GEN_C)"
 	$(CC) $(INC:%=-I%) $(CDEFS:%=-D%) $(CFLAGS) -o $@ $(SIMBA_GEN_C)
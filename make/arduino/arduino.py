@@ -11,6 +11,13 @@ import shutil
 import fnmatch
 
 
+# The Arduino IDE has no build step after compilation to run
+# simbagen.py in.
+ARDUINO_CDEFS = [
+    "CONFIG_FS_COMMANDS_STATIC=0"
+]
+
+
 ARDUINO_H = """/**
  * This is a generated file required by the Arduino build system."
  */
@@ -24,6 +31,13 @@ SIMBA_GEN_C_FMT = """
 const FAR char sysinfo[] = "app:    myapp built - by -.\\r\\n"
                            "board:  {board}\\r\\n"
                            "mcu:    {mcu}\\r\\n";
+
+/* There is no build step after compilation to find the commands
+   defined by FS_COMMAND_DEFINE(). They are registered at startup
+   instead, see CONFIG_FS_COMMANDS_STATIC. */
+const struct fs_command_t *const fs_static_commands[] = {{ NULL }};
+
+const int fs_static_commands_length = 0;
 """
 
 
@@ -220,7 +234,7 @@ def get_c_extra_flags(board, database):
     return " ".join(cflags
                     + ["\"-I{runtime.platform.path}/cores/simba/" + inc + "\""
                        for inc in incs]
-                    + ["-D" + d for d in cdefs])
+                    + ["-D" + d for d in cdefs + ARDUINO_CDEFS])
 
 
 def get_cxx_extra_flags(board, database):
@@ -240,7 +254,7 @@ def get_cxx_extra_flags(board, database):
     return " ".join(cxxflags
                     + ["\"-I{runtime.platform.path}/cores/simba/" + inc + "\""
                        for inc in incs]
-                    + ["-D" + d for d in cdefs])
+                    + ["-D" + d for d in cdefs + ARDUINO_CDEFS])
 
 
 def get_c_elf_extra_flags(board, database):
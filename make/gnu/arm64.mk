@@ -41,6 +41,17 @@ OPT ?= -O2
 CFLAGS += $(OPT)
 CXXFLAGS += $(OPT)
 
+# Set to yes to let the compiler use the floating point and Advanced
+# SIMD (NEON) registers. The threads and exception service routines
+# then store them as well.
+NEON ?= no
+
+ifeq ($(NEON),yes)
+GENERAL_REGS_ONLY =
+else
+GENERAL_REGS_ONLY = -mgeneral-regs-only
+endif
+
 CDEFS += F_CPU=$(F_CPU)UL
 
 CFLAGS += \
@@ -50,7 +61,7 @@ CFLAGS += \
 	-nostdlib \
 	-mlittle-endian \
         -mstrict-align \
-	-mgeneral-regs-only
+	$(GENERAL_REGS_ONLY)
 
 CXXFLAGS += \
         -ffunction-sections \
@@ -59,7 +70,7 @@ CXXFLAGS += \
 	-nostdlib \
 	-mlittle-endian \
         -mstrict-align \
-	-mgeneral-regs-only
+	$(GENERAL_REGS_ONLY)
 
 LDFLAGS += \
 	-Wl,-T$(LINKER_SCRIPT) \
@@ -68,7 +79,7 @@ LDFLAGS += \
 	-nostdlib \
 	-mlittle-endian \
         -mstrict-align \
-	-mgeneral-regs-only
+	$(GENERAL_REGS_ONLY)
 
 build: $(BIN)
 
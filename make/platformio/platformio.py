@@ -419,7 +419,8 @@ gen_command_action = ('"$PYTHONEXE" "$PLATFORMFW_DIR/bin/simbagen.py" '
                       '--board "$BOARD_DESC" '
                       '--mcu "$MCU_DESC" '
                       '--endianess little '
-                      '--eeprom-soft-chunk-size 2048 ')
+                      '--eeprom-soft-chunk-size 2048 '
+                      '${_concat("--object ", SOURCES, "", __env__)} ')
 
 # Get settings file path.
 settings_ini_encoded = ARGUMENTS.get('SETTINGS_INI')
@@ -0,0 +1,109 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2014-2018, Erik Moqvist
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use, copy,
+ * modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ * This file is part of the Simba project.
+ */
+
+#include "simba.h"
+
+/* Buffer alignment, at least the pointer size. */
+#define ALIGNMENT                                               \
+    (CONFIG_ALIGNMENT > sizeof(void *) ? CONFIG_ALIGNMENT : sizeof(void *))
+
+int arena_init(struct arena_t *self_p,
+               void *buf_p,
+               size_t size)
+{
+    ASSERTN(self_p != NULL, EINVAL);
+    ASSERTN(buf_p != NULL, EINVAL);
+
+    self_p->buf_p = buf_p;
+    self_p->size = size;
+    self_p->pos = 0;
+    self_p->pos_max = 0;
+    self_p->failed_allocs = 0;
+
+    return (0);
+}
+
+void *arena_alloc(struct arena_t *self_p,
+                  size_t size)
+{
+    ASSERTNRN(self_p != NULL, EINVAL);
+    ASSERTNRN(size > 0, EINVAL);
+
+    uintptr_t address;
+    size_t pos;
+
+    /* Align the buffer address. */
+    address = (uintptr_t)&self_p->buf_p[self_p->pos];
+    pos = (self_p->pos + (-address & (ALIGNMENT - 1)));
+
+    if ((pos > self_p->size) || (size > (self_p->size - pos))) {
+        self_p->failed_allocs++;
+
+        return (NULL);
+    }
+
+    self_p->pos = (pos + size);
+
+    if (self_p->pos > self_p->pos_max) {
+        self_p->pos_max = self_p->pos;
+    }
+
+    return (&self_p->buf_p[pos]);
+}
+
+size_t arena_mark(struct arena_t *self_p)
+{
+    ASSERTN(self_p != NULL, EINVAL);
+
+    return (self_p->pos);
+}
+
+int arena_reset(struct arena_t *self_p,
+                size_t mark)
+{
+    ASSERTN(self_p != NULL, EINVAL);
+    ASSERTN(mark <= self_p->pos, EINVAL);
+
+    self_p->pos = mark;
+
+    return (0);
+}
+
+int arena_get_stats(struct arena_t *self_p,
+                    struct arena_stats_t *stats_p)
+{
+    ASSERTN(self_p != NULL, EINVAL);
+    ASSERTN(stats_p != NULL, EINVAL);
+
+    stats_p->size = self_p->size;
+    stats_p->used = self_p->pos;
+    stats_p->used_max = self_p->pos_max;
+    stats_p->failed_allocs = self_p->failed_allocs;
+
+    return (0);
+}
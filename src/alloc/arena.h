@@ -0,0 +1,119 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2014-2018, Erik Moqvist
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use, copy,
+ * modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ * This file is part of the Simba project.
+ */
+
+#ifndef __ALLOC_ARENA_H__
+#define __ALLOC_ARENA_H__
+
+#include "simba.h"
+
+/**
+ * Arena statistics, see `arena_get_stats()`.
+ */
+struct arena_stats_t {
+    /** Size of the arena memory. */
+    size_t size;
+    /** Number of bytes in use. */
+    size_t used;
+    /** Maximum number of bytes in use. */
+    size_t used_max;
+    /** Number of failed allocations. */
+    uint32_t failed_allocs;
+};
+
+/**
+ * A bump pointer scratch arena.
+ */
+struct arena_t {
+    char *buf_p;
+    size_t size;
+    size_t pos;
+    size_t pos_max;
+    uint32_t failed_allocs;
+};
+
+/**
+ * Initialize given arena. An arena is not thread safe, and is
+ * typically used by a single thread, see `thrd_set_arena()`.
+ *
+ * @param[in] self_p Arena to initialize.
+ * @param[in] buf_p Arena memory.
+ * @param[in] size Size of the arena memory.
+ *
+ * @return zero(0) or negative error code.
+ */
+int arena_init(struct arena_t *self_p,
+               void *buf_p,
+               size_t size);
+
+/**
+ * Allocate a buffer of given size from given arena. The buffer is
+ * freed by `arena_reset()`.
+ *
+ * @param[in] self_p Arena to allocate from.
+ * @param[in] size Number of bytes to allocate.
+ *
+ * @return Pointer to allocated buffer, or NULL if the arena is
+ *         full.
+ */
+void *arena_alloc(struct arena_t *self_p,
+                  size_t size);
+
+/**
+ * Get a mark of the current allocation position in given arena, to
+ * later pass to `arena_reset()`.
+ *
+ * @param[in] self_p Arena.
+ *
+ * @return Mark.
+ */
+size_t arena_mark(struct arena_t *self_p);
+
+/**
+ * Free all buffers allocated from given arena after given mark was
+ * taken. Use zero(0) to free all buffers.
+ *
+ * @param[in] self_p Arena.
+ * @param[in] mark Mark from `arena_mark()`.
+ *
+ * @return zero(0) or negative error code.
+ */
+int arena_reset(struct arena_t *self_p,
+                size_t mark);
+
+/**
+ * Get the statistics of given arena.
+ *
+ * @param[in] self_p Arena to get statistics of.
+ * @param[out] stats_p Statistics.
+ *
+ * @return zero(0) or negative error code.
+ */
+int arena_get_stats(struct arena_t *self_p,
+                    struct arena_stats_t *stats_p);
+
+#endif
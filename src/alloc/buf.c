@@ -0,0 +1,428 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2014-2018, Erik Moqvist
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use, copy,
+ * modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ * This file is part of the Simba project.
+ */
+
+#include "simba.h"
+
+static struct buf_t *alloc_buf_isr(struct buf_pool_t *pool_p)
+{
+    struct buf_t *buf_p;
+
+    buf_p = pool_alloc_isr(&pool_p->pool);
+
+    if (buf_p == NULL) {
+        return (NULL);
+    }
+
+    buf_p->next_p = NULL;
+    buf_p->head_p = (uint8_t *)&buf_p[1];
+    buf_p->end_p = &buf_p->head_p[pool_p->size];
+    buf_p->data_p = buf_p->head_p;
+    buf_p->size = 0;
+    buf_p->pool_p = pool_p;
+    buf_p->free_fn = NULL;
+    buf_p->arg_p = NULL;
+    buf_p->refcount = 1;
+
+    return (buf_p);
+}
+
+/**
+ * Free the split reference created by `buf_split()`.
+ */
+static void free_split_reference(void *arg_p)
+{
+    buf_free_isr(arg_p);
+}
+
+struct buf_t *buf_alloc_isr(struct buf_pool_t *pool_p,
+                            size_t size,
+                            size_t headroom)
+{
+    ASSERTNRN(pool_p != NULL, EINVAL);
+    ASSERTNRN(headroom <= pool_p->size, EINVAL);
+
+    struct buf_t *head_p;
+    struct buf_t *buf_p;
+    struct buf_t **next_pp;
+    size_t buf_size;
+
+    head_p = NULL;
+    next_pp = &head_p;
+
+    do {
+        buf_p = alloc_buf_isr(pool_p);
+
+        if (buf_p == NULL) {
+            if (head_p != NULL) {
+                buf_free_isr(head_p);
+            }
+
+            return (NULL);
+        }
+
+        buf_p->data_p += headroom;
+        buf_size = (pool_p->size - headroom);
+
+        if (buf_size > size) {
+            buf_size = size;
+        }
+
+        buf_p->size = buf_size;
+        size -= buf_size;
+        headroom = 0;
+        *next_pp = buf_p;
+        next_pp = &buf_p->next_p;
+    } while (size > 0);
+
+    return (head_p);
+}
+
+int buf_pool_init(struct buf_pool_t *self_p,
+                  void *buf_p,
+                  size_t size,
+                  size_t buf_size)
+{
+    ASSERTN(self_p != NULL, EINVAL);
+    ASSERTN(buf_p != NULL, EINVAL);
+    ASSERTN(buf_size > 0, EINVAL);
+
+    self_p->size = buf_size;
+
+    return (pool_init(&self_p->pool,
+                      buf_p,
+                      size,
+                      sizeof(struct buf_t) + buf_size));
+}
+
+struct buf_t *buf_alloc(struct buf_pool_t *pool_p,
+                        size_t size,
+                        size_t headroom)
+{
+    ASSERTNRN(pool_p != NULL, EINVAL);
+    ASSERTNRN(headroom <= pool_p->size, EINVAL);
+
+    struct buf_t *buf_p;
+
+    sys_lock();
+    buf_p = buf_alloc_isr(pool_p, size, headroom);
+    sys_unlock();
+
+    return (buf_p);
+}
+
+struct buf_t *buf_alloc_ref(struct buf_pool_t *pool_p,
+                            void *data_p,
+                            size_t size,
+                            buf_free_fn_t free_fn,
+                            void *arg_p)
+{
+    ASSERTNRN(pool_p != NULL, EINVAL);
+    ASSERTNRN(data_p != NULL, EINVAL);
+
+    struct buf_t *buf_p;
+
+    sys_lock();
+    buf_p = alloc_buf_isr(pool_p);
+    sys_unlock();
+
+    if (buf_p == NULL) {
+        return (NULL);
+    }
+
+    buf_p->head_p = data_p;
+    buf_p->end_p = &buf_p->head_p[size];
+    buf_p->data_p = data_p;
+    buf_p->size = size;
+    buf_p->free_fn = free_fn;
+    buf_p->arg_p = arg_p;
+
+    return (buf_p);
+}
+
+int buf_ref(struct buf_t *self_p)
+{
+    ASSERTN(self_p != NULL, EINVAL);
+
+    sys_lock();
+    self_p->refcount++;
+    sys_unlock();
+
+    return (0);
+}
+
+int buf_free(struct buf_t *self_p)
+{
+    ASSERTN(self_p != NULL, EINVAL);
+
+    int res;
+
+    sys_lock();
+    res = buf_free_isr(self_p);
+    sys_unlock();
+
+    return (res);
+}
+
+int buf_free_isr(struct buf_t *self_p)
+{
+    ASSERTN(self_p != NULL, EINVAL);
+
+    struct buf_t *next_p;
+    int count;
+
+    count = 0;
+
+    while (self_p != NULL) {
+        self_p->refcount--;
+
+        if (self_p->refcount > 0) {
+            break;
+        }
+
+        next_p = self_p->next_p;
+
+        if (self_p->free_fn != NULL) {
+            self_p->free_fn(self_p->arg_p);
+        }
+
+        pool_free_isr(&self_p->pool_p->pool, self_p);
+        count++;
+        self_p = next_p;
+    }
+
+    return (count);
+}
+
+ssize_t buf_size(struct buf_t *self_p)
+{
+    ASSERTN(self_p != NULL, EINVAL);
+
+    ssize_t size;
+
+    size = 0;
+
+    while (self_p != NULL) {
+        size += self_p->size;
+        self_p = self_p->next_p;
+    }
+
+    return (size);
+}
+
+void *buf_push(struct buf_t *self_p, size_t size)
+{
+    ASSERTNRN(self_p != NULL, EINVAL);
+
+    if (size > (size_t)(self_p->data_p - self_p->head_p)) {
+        return (NULL);
+    }
+
+    self_p->data_p -= size;
+    self_p->size += size;
+
+    return (self_p->data_p);
+}
+
+void *buf_pull(struct buf_t *self_p, size_t size)
+{
+    ASSERTNRN(self_p != NULL, EINVAL);
+
+    if (size > self_p->size) {
+        return (NULL);
+    }
+
+    self_p->data_p += size;
+    self_p->size -= size;
+
+    return (self_p->data_p);
+}
+
+int buf_join(struct buf_t *self_p, struct buf_t *tail_p)
+{
+    ASSERTN(self_p != NULL, EINVAL);
+    ASSERTN(tail_p != NULL, EINVAL);
+
+    while (self_p->next_p != NULL) {
+        self_p = self_p->next_p;
+    }
+
+    self_p->next_p = tail_p;
+
+    return (0);
+}
+
+struct buf_t *buf_split(struct buf_t *self_p, size_t offset)
+{
+    ASSERTNRN(self_p != NULL, EINVAL);
+    ASSERTNRN(offset > 0, EINVAL);
+
+    struct buf_t *tail_p;
+
+    /* Find the buffer with the offset. */
+    while (offset > self_p->size) {
+        offset -= self_p->size;
+        self_p = self_p->next_p;
+
+        if (self_p == NULL) {
+            return (NULL);
+        }
+    }
+
+    if (offset == self_p->size) {
+        /* Between two buffers. */
+        tail_p = self_p->next_p;
+    } else {
+        /* Reference the data after the offset, keeping the buffer
+           until the reference is freed. */
+        tail_p = buf_alloc_ref(self_p->pool_p,
+                               &self_p->data_p[offset],
+                               self_p->size - offset,
+                               free_split_reference,
+                               self_p);
+
+        if (tail_p == NULL) {
+            return (NULL);
+        }
+
+        buf_ref(self_p);
+        tail_p->next_p = self_p->next_p;
+        self_p->size = offset;
+        /* The memory after the offset belongs to the reference. */
+        self_p->end_p = &self_p->data_p[offset];
+    }
+
+    self_p->next_p = NULL;
+
+    return (tail_p);
+}
+
+ssize_t buf_read(struct buf_t *self_p,
+                 size_t offset,
+                 void *dst_p,
+                 size_t size)
+{
+    ASSERTN(self_p != NULL, EINVAL);
+    ASSERTN((dst_p != NULL) || (size == 0), EINVAL);
+
+    uint8_t *u8_dst_p;
+    size_t left;
+    size_t n;
+
+    u8_dst_p = dst_p;
+    left = size;
+
+    while ((self_p != NULL) && (left > 0)) {
+        if (offset >= self_p->size) {
+            offset -= self_p->size;
+        } else {
+            n = MIN(self_p->size - offset, left);
+            memcpy(u8_dst_p, &self_p->data_p[offset], n);
+            u8_dst_p += n;
+            left -= n;
+            offset = 0;
+        }
+
+        self_p = self_p->next_p;
+    }
+
+    return (size - left);
+}
+
+ssize_t buf_write(struct buf_t *self_p,
+                  size_t offset,
+                  const void *src_p,
+                  size_t size)
+{
+    ASSERTN(self_p != NULL, EINVAL);
+    ASSERTN((src_p != NULL) || (size == 0), EINVAL);
+
+    const uint8_t *u8_src_p;
+    size_t left;
+    size_t n;
+
+    u8_src_p = src_p;
+    left = size;
+
+    while ((self_p != NULL) && (left > 0)) {
+        if (offset >= self_p->size) {
+            offset -= self_p->size;
+        } else {
+            n = MIN(self_p->size - offset, left);
+            memcpy(&self_p->data_p[offset], u8_src_p, n);
+            u8_src_p += n;
+            left -= n;
+            offset = 0;
+        }
+
+        self_p = self_p->next_p;
+    }
+
+    return (size - left);
+}
+
+ssize_t buf_append(struct buf_t *self_p,
+                   const void *src_p,
+                   size_t size)
+{
+    ASSERTN(self_p != NULL, EINVAL);
+    ASSERTN((src_p != NULL) || (size == 0), EINVAL);
+
+    const uint8_t *u8_src_p;
+    size_t left;
+    size_t n;
+
+    while (self_p->next_p != NULL) {
+        self_p = self_p->next_p;
+    }
+
+    u8_src_p = src_p;
+    left = size;
+
+    /* Only buffers in the pool memory have free memory after the
+       data. */
+    if (self_p->free_fn == NULL) {
+        n = MIN((size_t)(self_p->end_p - &self_p->data_p[self_p->size]),
+                left);
+        memcpy(&self_p->data_p[self_p->size], u8_src_p, n);
+        self_p->size += n;
+        u8_src_p += n;
+        left -= n;
+    }
+
+    if (left > 0) {
+        self_p->next_p = buf_alloc(self_p->pool_p, left, 0);
+
+        if (self_p->next_p == NULL) {
+            return (-ENOMEM);
+        }
+
+        buf_write(self_p->next_p, 0, u8_src_p, left);
+    }
+
+    return (size);
+}
@@ -0,0 +1,279 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2014-2018, Erik Moqvist
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use, copy,
+ * modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ * This file is part of the Simba project.
+ */
+
+#ifndef __ALLOC_BUF_H__
+#define __ALLOC_BUF_H__
+
+#include "simba.h"
+
+struct buf_t;
+
+/**
+ * Called when the last reference to a buffer created by
+ * `buf_alloc_ref()` is freed.
+ *
+ * @param[in] arg_p Argument given to `buf_alloc_ref()`.
+ */
+typedef void (*buf_free_fn_t)(void *arg_p);
+
+/**
+ * Compile time declaration of the memory of a buffer pool of
+ * ``length`` buffers of ``size`` data bytes each.
+ */
+#define BUF_POOL_BUFFER(name, size, length)                     \
+    POOL_BUFFER(name, sizeof(struct buf_t) + (size), length)
+
+/**
+ * A pool of buffers with a fixed data size.
+ */
+struct buf_pool_t {
+    struct pool_t pool;
+    size_t size;
+};
+
+/**
+ * A buffer in a chain of buffers. The data of a chain is the data of
+ * all buffers in it, in order. Only `data_p`, `size` and `next_p`
+ * may be read by the user, and they are modified with the functions
+ * in this module.
+ */
+struct buf_t {
+    /** Next buffer in the chain, or NULL. */
+    struct buf_t *next_p;
+    /** First data byte. */
+    uint8_t *data_p;
+    /** Number of data bytes in this buffer. */
+    size_t size;
+    /* Start of the memory, before any headroom. */
+    uint8_t *head_p;
+    /* End of the memory. */
+    uint8_t *end_p;
+    struct buf_pool_t *pool_p;
+    /* Called when freeing buffers referencing memory not in the
+       pool. */
+    buf_free_fn_t free_fn;
+    void *arg_p;
+    int refcount;
+};
+
+/**
+ * Initialize given buffer pool.
+ *
+ * @param[in] self_p Buffer pool to initialize.
+ * @param[in] buf_p Pool memory, preferably declared with
+ *                  `BUF_POOL_BUFFER()`.
+ * @param[in] size Size of the pool memory.
+ * @param[in] buf_size Number of data bytes in each buffer.
+ *
+ * @return zero(0) or negative error code.
+ */
+int buf_pool_init(struct buf_pool_t *self_p,
+                  void *buf_p,
+                  size_t size,
+                  size_t buf_size);
+
+/**
+ * Allocate a chain of buffers for given number of data bytes from
+ * given pool, with ``headroom`` bytes before the data in the first
+ * buffer for headers added later with `buf_push()`. The reference
+ * count of all buffers is one.
+ *
+ * @param[in] pool_p Buffer pool to allocate from.
+ * @param[in] size Number of data bytes in the chain.
+ * @param[in] headroom Number of bytes reserved before the data, at
+ *                     most the data size of the pool buffers.
+ *
+ * @return Allocated chain, or NULL if there are not enough free
+ *         buffers in the pool.
+ */
+struct buf_t *buf_alloc(struct buf_pool_t *pool_p,
+                        size_t size,
+                        size_t headroom);
+
+/**
+ * Same as `buf_alloc()`, but may be called from interrupt context.
+ */
+struct buf_t *buf_alloc_isr(struct buf_pool_t *pool_p,
+                            size_t size,
+                            size_t headroom);
+
+/**
+ * Allocate a buffer referencing given data, not copying it, for
+ * example a receive buffer of a driver or a lwIP pbuf. Given free
+ * function is called when the last reference to the buffer is freed.
+ *
+ * @param[in] pool_p Buffer pool to allocate the buffer from.
+ * @param[in] data_p Data to reference.
+ * @param[in] size Data size.
+ * @param[in] free_fn Free function, or NULL.
+ * @param[in] arg_p Free function argument.
+ *
+ * @return Allocated buffer, or NULL if the pool is empty.
+ */
+struct buf_t *buf_alloc_ref(struct buf_pool_t *pool_p,
+                            void *data_p,
+                            size_t size,
+                            buf_free_fn_t free_fn,
+                            void *arg_p);
+
+/**
+ * Add a reference to given buffer, which is freed when freed as many
+ * times as it is referenced. The rest of the chain is not
+ * referenced, but is kept by the buffer.
+ *
+ * @param[in] self_p Buffer to reference.
+ *
+ * @return zero(0) or negative error code.
+ */
+int buf_ref(struct buf_t *self_p);
+
+/**
+ * Remove a reference to the first buffer of given chain. The buffer
+ * is freed if it was the last reference, and then the next buffer in
+ * the chain, until a buffer still referenced elsewhere is found.
+ *
+ * @param[in] self_p Chain to free.
+ *
+ * @return Number of freed buffers or negative error code.
+ */
+int buf_free(struct buf_t *self_p);
+
+/**
+ * Same as `buf_free()`, but may be called from interrupt context.
+ */
+int buf_free_isr(struct buf_t *self_p);
+
+/**
+ * Get the number of data bytes in given chain.
+ *
+ * @param[in] self_p Chain.
+ *
+ * @return Number of data bytes or negative error code.
+ */
+ssize_t buf_size(struct buf_t *self_p);
+
+/**
+ * Prepend given number of bytes to the data of the first buffer in
+ * given chain, for example to add a protocol header.
+ *
+ * @param[in] self_p Chain.
+ * @param[in] size Number of bytes to prepend.
+ *
+ * @return Pointer to the first data byte, or NULL if there is not
+ *         enough headroom.
+ */
+void *buf_push(struct buf_t *self_p, size_t size);
+
+/**
+ * Remove given number of bytes from the start of the data of the
+ * first buffer in given chain, for example to strip a protocol
+ * header.
+ *
+ * @param[in] self_p Chain.
+ * @param[in] size Number of bytes to remove.
+ *
+ * @return Pointer to the first data byte after the removed bytes,
+ *         or NULL if the first buffer has not that many data bytes.
+ */
+void *buf_pull(struct buf_t *self_p, size_t size);
+
+/**
+ * Append given chain to given chain, without copying the data. The
+ * reference of the caller to the appended chain is taken over by the
+ * first chain.
+ *
+ * @param[in] self_p Chain to append to.
+ * @param[in] tail_p Chain to append.
+ *
+ * @return zero(0) or negative error code.
+ */
+int buf_join(struct buf_t *self_p, struct buf_t *tail_p);
+
+/**
+ * Split given chain at given offset, without copying the data. The
+ * chain keeps the first ``offset`` bytes, and the rest is returned as
+ * a new chain owned by the caller. A buffer referencing the data
+ * after the offset is allocated from the pool of the split buffer if
+ * the offset is not between two buffers.
+ *
+ * @param[in] self_p Chain to split.
+ * @param[in] offset Split offset, larger than zero(0) and smaller
+ *                   than the chain size.
+ *
+ * @return The chain after the offset, or NULL on failure.
+ */
+struct buf_t *buf_split(struct buf_t *self_p, size_t offset);
+
+/**
+ * Copy data from given chain.
+ *
+ * @param[in] self_p Chain to read from.
+ * @param[in] offset Offset in the chain data.
+ * @param[out] dst_p Destination buffer.
+ * @param[in] size Number of bytes to read.
+ *
+ * @return Number of read bytes, less than given size if the chain
+ *         ends, or negative error code.
+ */
+ssize_t buf_read(struct buf_t *self_p,
+                 size_t offset,
+                 void *dst_p,
+                 size_t size);
+
+/**
+ * Copy data into the existing data of given chain.
+ *
+ * @param[in] self_p Chain to write to.
+ * @param[in] offset Offset in the chain data.
+ * @param[in] src_p Source buffer.
+ * @param[in] size Number of bytes to write.
+ *
+ * @return Number of written bytes, less than given size if the chain
+ *         ends, or negative error code.
+ */
+ssize_t buf_write(struct buf_t *self_p,
+                  size_t offset,
+                  const void *src_p,
+                  size_t size);
+
+/**
+ * Append given data to given chain, first into the free memory after
+ * the data of the last buffer, and then into new buffers allocated
+ * from the pool of the last buffer.
+ *
+ * @param[in] self_p Chain to append to.
+ * @param[in] src_p Data to append.
+ * @param[in] size Number of bytes to append.
+ *
+ * @return Number of appended bytes or negative error code.
+ */
+ssize_t buf_append(struct buf_t *self_p,
+                   const void *src_p,
+                   size_t size);
+
+#endif
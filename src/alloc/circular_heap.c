@@ -36,6 +36,76 @@ struct header_t {
 #endif
 };
 
+#if CONFIG_HEAP_STATS == 1
+
+struct module_t {
+    int8_t initialized;
+    struct circular_heap_t *head_p;
+#    if CONFIG_HEAP_STATS_FS_COMMANDS == 1
+    struct fs_command_t cmd_list;
+#    endif
+};
+
+static struct module_t module;
+
+#    if CONFIG_HEAP_STATS_FS_COMMANDS == 1
+
+static int cmd_list_cb(int argc,
+                       const char *argv[],
+                       void *out_p,
+                       void *in_p,
+                       void *arg_p,
+                       void *call_arg_p)
+{
+    return (circular_heap_print(out_p));
+}
+
+#    endif
+
+static size_t largest_free(struct circular_heap_t *self_p)
+{
+    size_t size;
+
+    /* Same conditions as in circular_heap_alloc(). */
+    if (self_p->alloc_p >= self_p->free_p)  {
+        size = MAX(self_p->end_p - self_p->alloc_p,
+                   self_p->free_p - self_p->begin_p);
+    } else {
+        size = (self_p->free_p - self_p->alloc_p);
+    }
+
+    /* Leave room for the header and the alignment. */
+    if (size <= (sizeof(struct header_t) + 8)) {
+        return (0);
+    }
+
+    return (size - sizeof(struct header_t) - 8);
+}
+
+#endif
+
+int circular_heap_module_init(void)
+{
+#if CONFIG_HEAP_STATS == 1
+    /* Return immediately if the module is already initialized. */
+    if (module.initialized == 1) {
+        return (0);
+    }
+
+    module.initialized = 1;
+
+#    if CONFIG_HEAP_STATS_FS_COMMANDS == 1
+    fs_command_init(&module.cmd_list,
+                    CSTR("/alloc/circular_heap/list"),
+                    cmd_list_cb,
+                    NULL);
+    fs_command_register(&module.cmd_list);
+#    endif
+#endif
+
+    return (0);
+}
+
 int circular_heap_init(struct circular_heap_t *self_p,
                        void *buf_p,
                        size_t size)
@@ -48,6 +118,11 @@ int circular_heap_init(struct circular_heap_t *self_p,
     self_p->end_p = (buf_p + size);
     self_p->alloc_p = buf_p;
     self_p->free_p = buf_p;
+#if CONFIG_HEAP_STATS == 1
+    self_p->name_p = NULL;
+    memset(&self_p->stats, 0, sizeof(self_p->stats));
+    self_p->list_next_p = NULL;
+#endif
 
     return (0);
 }
@@ -92,9 +167,21 @@ void *circular_heap_alloc(struct circular_heap_t *self_p,
 
     if (header_p != NULL) {
         header_p->size = size;
+#if CONFIG_HEAP_STATS == 1
+        self_p->stats.allocs++;
+        self_p->stats.used += size;
+
+        if (self_p->stats.used > self_p->stats.used_max) {
+            self_p->stats.used_max = self_p->stats.used;
+        }
+#endif
 
         return (&header_p[1]);
     } else {
+#if CONFIG_HEAP_STATS == 1
+        self_p->stats.failed_allocs++;
+#endif
+
         return (NULL);
     }
 }
@@ -120,6 +207,106 @@ int circular_heap_free(struct circular_heap_t *self_p,
     }
 
     self_p->free_p += header_p->size;
+#if CONFIG_HEAP_STATS == 1
+    self_p->stats.frees++;
+    self_p->stats.used -= header_p->size;
+#endif
 
     return (0);
 }
+
+int circular_heap_get_stats(struct circular_heap_t *self_p,
+                            struct circular_heap_stats_t *stats_p)
+{
+    ASSERTN(self_p != NULL, EINVAL);
+    ASSERTN(stats_p != NULL, EINVAL);
+
+#if CONFIG_HEAP_STATS == 1
+    *stats_p = self_p->stats;
+    stats_p->largest_free = largest_free(self_p);
+
+    return (0);
+#else
+    return (-ENOSYS);
+#endif
+}
+
+#if CONFIG_HEAP_STATS == 1
+
+static int memory_usage(void *arg_p, struct sys_memory_usage_t *usage_p)
+{
+    struct circular_heap_t *self_p;
+
+    self_p = arg_p;
+    usage_p->used = self_p->stats.used;
+    usage_p->used_max = self_p->stats.used_max;
+
+    return (0);
+}
+
+#endif
+
+int circular_heap_register(struct circular_heap_t *self_p,
+                           const char *name_p)
+{
+    ASSERTN(self_p != NULL, EINVAL);
+    ASSERTN(name_p != NULL, EINVAL);
+
+#if CONFIG_HEAP_STATS == 1
+    circular_heap_module_init();
+
+    sys_lock();
+    self_p->name_p = name_p;
+    self_p->list_next_p = module.head_p;
+    module.head_p = self_p;
+    sys_unlock();
+
+    sys_memory_region_init(&self_p->memory_region,
+                           name_p,
+                           self_p->begin_p,
+                           (char *)self_p->end_p - (char *)self_p->begin_p,
+                           memory_usage,
+                           self_p);
+    sys_memory_region_register(&self_p->memory_region);
+
+    return (0);
+#else
+    return (-ENOSYS);
+#endif
+}
+
+int circular_heap_print(void *chan_p)
+{
+    ASSERTN(chan_p != NULL, EINVAL);
+
+#if CONFIG_HEAP_STATS == 1
+    struct circular_heap_t *heap_p;
+    struct circular_heap_stats_t stats;
+
+    std_fprintf(chan_p,
+                OSTR("                NAME      USED  USED-MAX  LARGEST"
+                     "      ALLOCS       FREES      FAILED\r\n"));
+
+    sys_lock();
+    heap_p = module.head_p;
+    sys_unlock();
+
+    while (heap_p != NULL) {
+        circular_heap_get_stats(heap_p, &stats);
+        std_fprintf(chan_p,
+                    OSTR("%20s %9lu %9lu %8lu %11lu %11lu %11lu\r\n"),
+                    heap_p->name_p,
+                    (unsigned long)stats.used,
+                    (unsigned long)stats.used_max,
+                    (unsigned long)stats.largest_free,
+                    (unsigned long)stats.allocs,
+                    (unsigned long)stats.frees,
+                    (unsigned long)stats.failed_allocs);
+        heap_p = heap_p->list_next_p;
+    }
+
+    return (0);
+#else
+    return (-ENOSYS);
+#endif
+}
@@ -31,14 +31,49 @@
 
 #include "simba.h"
 
+/**
+ * Circular heap statistics, see `circular_heap_get_stats()`.
+ */
+struct circular_heap_stats_t {
+    /** Number of bytes in use, including buffer headers. */
+    size_t used;
+    /** Maximum number of bytes in use since the last reset. */
+    size_t used_max;
+    /** Size of the biggest buffer that can be allocated. */
+    size_t largest_free;
+    /** Number of successful allocations. */
+    uint32_t allocs;
+    /** Number of buffers freed. */
+    uint32_t frees;
+    /** Number of failed allocations. */
+    uint32_t failed_allocs;
+};
+
 /* Circular_Heap. */
 struct circular_heap_t {
     void *begin_p;
     void *end_p;
     void *alloc_p;
     void *free_p;
+#if CONFIG_HEAP_STATS == 1
+    const char *name_p;
+    struct circular_heap_stats_t stats;
+    struct circular_heap_t *list_next_p;
+    struct sys_memory_region_t memory_region;
+#endif
 };
 
+/**
+ * Initialize the circular heap module, registering the statistics
+ * file system command. Called by `circular_heap_register()`.
+ *
+ * The module will only be initialized once even if this function is
+ * called multiple times.
+ *
+ * @return zero(0) or negative error code.
+ */
+int circular_heap_module_init(void);
+
 /**
  * Initialize given circular heap. Buffers must be freed in the same
  * order as they were allocated.
@@ -78,4 +113,40 @@ void *circular_heap_alloc(struct circular_heap_t *self_p,
 int circular_heap_free(struct circular_heap_t *self_p,
                        void *buf_p);
 
+/**
+ * Get the statistics of given circular heap. Requires
+ * ``CONFIG_HEAP_STATS``.
+ *
+ * @param[in] self_p Circular heap to get statistics of.
+ * @param[out] stats_p Statistics.
+ *
+ * @return zero(0) or negative error code.
+ */
+int circular_heap_get_stats(struct circular_heap_t *self_p,
+                            struct circular_heap_stats_t *stats_p);
+
+/**
+ * Register given circular heap by name, to be listed by
+ * `circular_heap_print()`, `sys_memory_print()` and the file system
+ * command. Requires
+ * ``CONFIG_HEAP_STATS``. A registered circular heap must never go
+ * out of scope.
+ *
+ * @param[in] self_p Circular heap to register.
+ * @param[in] name_p Circular heap name.
+ *
+ * @return zero(0) or negative error code.
+ */
+int circular_heap_register(struct circular_heap_t *self_p,
+                           const char *name_p);
+
+/**
+ * Print the statistics of all registered circular heaps.
+ *
+ * @param[in] chan_p Output channel.
+ *
+ * @return zero(0) or negative error code.
+ */
+int circular_heap_print(void *chan_p);
+
 #endif
@@ -29,6 +29,13 @@
 #include "simba.h"
 
 struct heap_buffer_header_t {
+#if CONFIG_HEAP_TLSF == 1
+    /* Physically previous block. Only valid if it is free. */
+    struct heap_buffer_header_t *prev_phys_p;
+    /* Size of the block including this header, and the block flags
+       in the two least significant bits. */
+    size_t block_size;
+#endif
     union {
         struct heap_fixed_t *fixed_p;
         struct heap_buffer_header_t *next_p;
@@ -37,20 +44,530 @@ struct heap_buffer_header_t {
     int count;
 };
 
+#if CONFIG_HEAP_TLSF == 1
+
+#define TLSF_ALIGN                         (1 << HEAP_TLSF_ALIGN_LOG2)
+#define TLSF_SMALL_BLOCK_SIZE              (1UL << HEAP_TLSF_FL_INDEX_SHIFT)
+#define TLSF_BLOCK_SIZE_MAX                (1UL << CONFIG_HEAP_TLSF_FL_INDEX_MAX)
+
+#define TLSF_BLOCK_FREE                                       0x1
+#define TLSF_BLOCK_PREV_FREE                                  0x2
+#define TLSF_BLOCK_FLAGS       (TLSF_BLOCK_FREE | TLSF_BLOCK_PREV_FREE)
+
+#define TLSF_ALIGN_UP(size)                                     \
+    (((size) + TLSF_ALIGN - 1) & ~(unsigned long)(TLSF_ALIGN - 1))
+
+/* Room for the header and the previous free block pointer. */
+#define TLSF_BLOCK_SIZE_MIN                                     \
+    TLSF_ALIGN_UP(sizeof(struct heap_buffer_header_t) + sizeof(void *))
+
+/* The sentinel block at the end of the heap is only a block size. */
+#define TLSF_SENTINEL_SIZE                                      \
+    offsetof(struct heap_buffer_header_t, u)
+
+static int tlsf_fls(unsigned long value)
+{
+    return (8 * sizeof(value) - 1 - __builtin_clzl(value));
+}
+
+static int tlsf_ffs(uint32_t value)
+{
+    return (__builtin_ctzl(value));
+}
+
+static size_t block_size(struct heap_buffer_header_t *header_p)
+{
+    return (header_p->block_size & ~TLSF_BLOCK_FLAGS);
+}
+
+static void block_set_size(struct heap_buffer_header_t *header_p,
+                           size_t size)
+{
+    header_p->block_size = (size | (header_p->block_size & TLSF_BLOCK_FLAGS));
+}
+
+static struct heap_buffer_header_t *block_next(
+    struct heap_buffer_header_t *header_p)
+{
+    return ((struct heap_buffer_header_t *)((char *)header_p
+                                            + block_size(header_p)));
+}
+
+/**
+ * Free blocks are double linked. The next pointer is stored in the
+ * header and the previous pointer first in the block data.
+ */
+static struct heap_buffer_header_t **block_prev_free(
+    struct heap_buffer_header_t *header_p)
+{
+    return ((struct heap_buffer_header_t **)&header_p[1]);
+}
+
+static void block_mark_free(struct heap_buffer_header_t *header_p)
+{
+    struct heap_buffer_header_t *next_p;
+
+    header_p->block_size |= TLSF_BLOCK_FREE;
+    next_p = block_next(header_p);
+    next_p->prev_phys_p = header_p;
+    next_p->block_size |= TLSF_BLOCK_PREV_FREE;
+}
+
+static void block_mark_used(struct heap_buffer_header_t *header_p)
+{
+    header_p->block_size &= ~TLSF_BLOCK_FREE;
+    block_next(header_p)->block_size &= ~TLSF_BLOCK_PREV_FREE;
+}
+
+/**
+ * First and second level indices of the free list of blocks of given
+ * size.
+ */
+static void tlsf_mapping_insert(unsigned long size,
+                                int *fl_p,
+                                int *sl_p)
+{
+    int fl;
+    int sl;
+
+    if (size < TLSF_SMALL_BLOCK_SIZE) {
+        fl = 0;
+        sl = (size >> HEAP_TLSF_ALIGN_LOG2);
+    } else {
+        fl = tlsf_fls(size);
+        sl = ((size >> (fl - HEAP_TLSF_SL_INDEX_COUNT_LOG2))
+              ^ HEAP_TLSF_SL_INDEX_COUNT);
+        fl -= (HEAP_TLSF_FL_INDEX_SHIFT - 1);
+    }
+
+    *fl_p = fl;
+    *sl_p = sl;
+}
+
+/**
+ * Insert given free block first in its free list.
+ */
+static void tlsf_insert(struct heap_tlsf_t *tlsf_p,
+                        struct heap_buffer_header_t *header_p)
+{
+    struct heap_buffer_header_t *head_p;
+    int fl;
+    int sl;
+
+    tlsf_mapping_insert(block_size(header_p), &fl, &sl);
+    head_p = tlsf_p->free_p[fl][sl];
+    header_p->u.next_p = head_p;
+    *block_prev_free(header_p) = NULL;
+
+    if (head_p != NULL) {
+        *block_prev_free(head_p) = header_p;
+    }
+
+    tlsf_p->free_p[fl][sl] = header_p;
+    tlsf_p->fl_bitmap |= (1UL << fl);
+    tlsf_p->sl_bitmap[fl] |= (1UL << sl);
+}
+
+/**
+ * Remove given free block from its free list.
+ */
+static void tlsf_remove(struct heap_tlsf_t *tlsf_p,
+                        struct heap_buffer_header_t *header_p)
+{
+    struct heap_buffer_header_t *prev_p;
+    struct heap_buffer_header_t *next_p;
+    int fl;
+    int sl;
+
+    prev_p = *block_prev_free(header_p);
+    next_p = header_p->u.next_p;
+
+    if (next_p != NULL) {
+        *block_prev_free(next_p) = prev_p;
+    }
+
+    if (prev_p != NULL) {
+        prev_p->u.next_p = next_p;
+    } else {
+        tlsf_mapping_insert(block_size(header_p), &fl, &sl);
+        tlsf_p->free_p[fl][sl] = next_p;
+
+        if (next_p == NULL) {
+            tlsf_p->sl_bitmap[fl] &= ~(1UL << sl);
+
+            if (tlsf_p->sl_bitmap[fl] == 0) {
+                tlsf_p->fl_bitmap &= ~(1UL << fl);
+            }
+        }
+    }
+}
+
+/**
+ * Find a free block of at least given size using the bitmaps.
+ */
+static struct heap_buffer_header_t *tlsf_search(struct heap_tlsf_t *tlsf_p,
+                                                unsigned long size)
+{
+    uint32_t fl_map;
+    uint32_t sl_map;
+    int fl;
+    int sl;
+
+    /* Round up to the next list so any block in it is big enough. */
+    if (size >= TLSF_SMALL_BLOCK_SIZE) {
+        size += ((1UL << (tlsf_fls(size) - HEAP_TLSF_SL_INDEX_COUNT_LOG2))
+                 - 1);
+
+        if (size >= TLSF_BLOCK_SIZE_MAX) {
+            return (NULL);
+        }
+    }
+
+    tlsf_mapping_insert(size, &fl, &sl);
+    sl_map = (tlsf_p->sl_bitmap[fl] & ((uint32_t)-1 << sl));
+
+    if (sl_map == 0) {
+        fl_map = (tlsf_p->fl_bitmap & ((uint32_t)-1 << (fl + 1)));
+
+        if (fl_map == 0) {
+            return (NULL);
+        }
+
+        fl = tlsf_ffs(fl_map);
+        sl_map = tlsf_p->sl_bitmap[fl];
+    }
+
+    sl = tlsf_ffs(sl_map);
+
+    return (tlsf_p->free_p[fl][sl]);
+}
+
+static void tlsf_init(struct heap_t *self_p)
+{
+    struct heap_buffer_header_t *header_p;
+    struct heap_buffer_header_t *prev_p;
+    char *begin_p;
+    char *end_p;
+    unsigned long size;
+    unsigned long left;
+
+    memset(&self_p->tlsf, 0, sizeof(self_p->tlsf));
+
+    /* Align the data of all blocks. */
+    begin_p = (char *)(TLSF_ALIGN_UP((uintptr_t)self_p->buf_p
+                                     + sizeof(*header_p))
+                       - sizeof(*header_p));
+    end_p = ((char *)self_p->buf_p + self_p->size - TLSF_SENTINEL_SIZE);
+
+    /* No room for the sentinel. */
+    if (end_p < begin_p) {
+        return;
+    }
+
+    left = ((end_p - begin_p) & ~(unsigned long)(TLSF_ALIGN - 1));
+    header_p = (struct heap_buffer_header_t *)begin_p;
+    header_p->block_size = 0;
+    prev_p = NULL;
+
+    /* Split the heap into free blocks smaller than the maximum block
+       size. */
+    while (left >= TLSF_BLOCK_SIZE_MIN) {
+        size = MIN(left, TLSF_BLOCK_SIZE_MAX - TLSF_ALIGN);
+
+        if ((left - size) < TLSF_BLOCK_SIZE_MIN) {
+            left = size;
+        }
+
+        header_p->block_size |= (size | TLSF_BLOCK_FREE);
+        tlsf_insert(&self_p->tlsf, header_p);
+        prev_p = header_p;
+        header_p = block_next(header_p);
+        header_p->prev_phys_p = prev_p;
+        header_p->block_size = TLSF_BLOCK_PREV_FREE;
+        left -= size;
+    }
+
+    /* The last header is the sentinel, an used block of size zero,
+       ending the heap. */
+}
+
+static struct heap_buffer_header_t *tlsf_alloc(struct heap_t *self_p,
+                                               size_t size)
+{
+    struct heap_buffer_header_t *header_p;
+    struct heap_buffer_header_t *rest_p;
+    unsigned long size_needed;
+    unsigned long size_rest;
+
+    if (size >= TLSF_BLOCK_SIZE_MAX) {
+        return (NULL);
+    }
+
+    size_needed = TLSF_ALIGN_UP(sizeof(*header_p) + size);
+
+    if (size_needed < TLSF_BLOCK_SIZE_MIN) {
+        size_needed = TLSF_BLOCK_SIZE_MIN;
+    }
+
+    header_p = tlsf_search(&self_p->tlsf, size_needed);
+
+    if (header_p == NULL) {
+        return (NULL);
+    }
+
+    tlsf_remove(&self_p->tlsf, header_p);
+    size_rest = (block_size(header_p) - size_needed);
+
+    /* Return the end of the block to the heap if big enough. */
+    if (size_rest >= TLSF_BLOCK_SIZE_MIN) {
+        block_set_size(header_p, size_needed);
+        rest_p = block_next(header_p);
+        rest_p->block_size = size_rest;
+        block_mark_free(rest_p);
+        tlsf_insert(&self_p->tlsf, rest_p);
+    }
+
+    block_mark_used(header_p);
+
+    return (header_p);
+}
+
+static void tlsf_free(struct heap_t *self_p,
+                      struct heap_buffer_header_t *header_p)
+{
+    struct heap_buffer_header_t *prev_p;
+    struct heap_buffer_header_t *next_p;
+    unsigned long size;
+
+    /* Merge with the previous block if free. */
+    if (header_p->block_size & TLSF_BLOCK_PREV_FREE) {
+        prev_p = header_p->prev_phys_p;
+        size = (block_size(prev_p) + block_size(header_p));
+
+        if (size < TLSF_BLOCK_SIZE_MAX) {
+            tlsf_remove(&self_p->tlsf, prev_p);
+            block_set_size(prev_p, size);
+            header_p = prev_p;
+        }
+    }
+
+    /* Merge with the next block if free. */
+    next_p = block_next(header_p);
+
+    if (next_p->block_size & TLSF_BLOCK_FREE) {
+        size = (block_size(header_p) + block_size(next_p));
+
+        if (size < TLSF_BLOCK_SIZE_MAX) {
+            tlsf_remove(&self_p->tlsf, next_p);
+            block_set_size(header_p, size);
+        }
+    }
+
+    block_mark_free(header_p);
+    tlsf_insert(&self_p->tlsf, header_p);
+}
+
+#endif
+
+#if CONFIG_HEAP_STATS == 1
+
+struct module_t {
+    int8_t initialized;
+    struct heap_t *head_p;
+#    if CONFIG_HEAP_STATS_FS_COMMANDS == 1
+    struct fs_command_t cmd_list;
+    struct fs_command_t cmd_reset;
+#        if CONFIG_HEAP_TRACE_LENGTH > 0
+    struct fs_command_t cmd_trace;
+#        endif
+    struct fs_counter_t allocs;
+    struct fs_counter_t frees;
+    struct fs_counter_t failed_allocs;
+#    endif
+};
+
+static struct module_t module;
+
+/* Metric families written by heap_print_openmetrics(), in the order
+   of stats_value(). Counter samples are suffixed with _total. */
+static const char *const openmetrics_families[][2] = {
+    { "heap_used_bytes", "gauge" },
+    { "heap_used_max_bytes", "gauge" },
+    { "heap_largest_free_bytes", "gauge" },
+    { "heap_allocs", "counter" },
+    { "heap_frees", "counter" },
+    { "heap_failed_allocs", "counter" }
+};
+
+static unsigned long stats_value(struct heap_stats_t *stats_p, int index)
+{
+    switch (index) {
+
+    case 0:
+        return (stats_p->used);
+
+    case 1:
+        return (stats_p->used_max);
+
+    case 2:
+        return (stats_p->largest_free);
+
+    case 3:
+        return (stats_p->allocs);
+
+    case 4:
+        return (stats_p->frees);
+
+    default:
+        return (stats_p->failed_allocs);
+    }
+}
+
+#    if CONFIG_HEAP_STATS_FS_COMMANDS == 1
+
+static int cmd_list_cb(int argc,
+                       const char *argv[],
+                       void *out_p,
+                       void *in_p,
+                       void *arg_p,
+                       void *call_arg_p)
+{
+    return (heap_print(out_p));
+}
+
+static int cmd_reset_cb(int argc,
+                        const char *argv[],
+                        void *out_p,
+                        void *in_p,
+                        void *arg_p,
+                        void *call_arg_p)
+{
+    struct heap_t *heap_p;
+
+    sys_lock();
+    heap_p = module.head_p;
+    sys_unlock();
+
+    while (heap_p != NULL) {
+        heap_reset_stats(heap_p);
+        heap_p = heap_p->list_next_p;
+    }
+
+    return (0);
+}
+
+#        if CONFIG_HEAP_TRACE_LENGTH > 0
+
+static int cmd_trace_cb(int argc,
+                        const char *argv[],
+                        void *out_p,
+                        void *in_p,
+                        void *arg_p,
+                        void *call_arg_p)
+{
+    struct heap_t *heap_p;
+
+    if (argc != 2) {
+        std_fprintf(out_p, OSTR("Usage: trace <heap>\r\n"));
+
+        return (-EINVAL);
+    }
+
+    sys_lock();
+    heap_p = module.head_p;
+    sys_unlock();
+
+    while (heap_p != NULL) {
+        if (strcmp(heap_p->name_p, argv[1]) == 0) {
+            return (heap_print_trace(heap_p, out_p));
+        }
+
+        heap_p = heap_p->list_next_p;
+    }
+
+    std_fprintf(out_p, OSTR("%s: heap not found\r\n"), argv[1]);
+
+    return (-ENOENT);
+}
+
+#        endif
+
+#    endif
+
+/**
+ * Increment given module counter. Counters are shared by all heaps,
+ * each protected by its own mutex.
+ */
+static void counter_increment(struct fs_counter_t *counter_p)
+{
+#    if CONFIG_HEAP_STATS_FS_COMMANDS == 1
+    sys_lock();
+    fs_counter_increment(counter_p, 1);
+    sys_unlock();
+#    endif
+}
+
+#    if CONFIG_HEAP_STATS_FS_COMMANDS == 1
+#        define COUNTER(name) (&module.name)
+#    else
+#        define COUNTER(name) NULL
+#    endif
+
+#    if CONFIG_HEAP_TRACE_LENGTH > 0
+
+static void trace_record(struct heap_t *self_p,
+                         void *caller_p,
+                         void *buf_p,
+                         size_t size)
+{
+    struct heap_trace_entry_t *entry_p;
+
+    entry_p = &self_p->trace.entries[self_p->trace.index];
+    entry_p->caller_p = caller_p;
+    entry_p->buf_p = buf_p;
+    entry_p->size = size;
+    self_p->trace.index++;
+
+    if (self_p->trace.index == CONFIG_HEAP_TRACE_LENGTH) {
+        self_p->trace.index = 0;
+    }
+
+    if (self_p->trace.length < CONFIG_HEAP_TRACE_LENGTH) {
+        self_p->trace.length++;
+    }
+}
+
+#    endif
+
+#endif
+
 static void *alloc_fixed_size(struct heap_t *self_p,
                               size_t size)
 {
     struct heap_buffer_header_t *header_p;
     struct heap_fixed_t *fixed_p = self_p->fixed;
+#if CONFIG_HEAP_TLSF == 0
     size_t left;
     char *next_p;
+#endif
 
     while (fixed_p != &self_p->fixed[HEAP_FIXED_SIZES_MAX]) {
         if (size <= fixed_p->size) {
             if (fixed_p->free_p != NULL) {
                 header_p = fixed_p->free_p;
                 fixed_p->free_p = header_p->u.next_p;
+#if CONFIG_HEAP_STATS == 1
+                self_p->stats.fixed[fixed_p - self_p->fixed].hits++;
+#endif
             } else {
+#if CONFIG_HEAP_TLSF == 1
+                header_p = tlsf_alloc(self_p, fixed_p->size);
+
+                /* Out of memory?. */
+                if (header_p == NULL) {
+                    break;
+                }
+#else
                 next_p = self_p->next_p;
 
                 /* Out of memory?. */
@@ -63,6 +580,10 @@ static void *alloc_fixed_size(struct heap_t *self_p,
                 header_p = self_p->next_p;
                 next_p += (sizeof(*header_p) + fixed_p->size);
                 self_p->next_p = next_p;
+#endif
+#if CONFIG_HEAP_STATS == 1
+                self_p->stats.fixed[fixed_p - self_p->fixed].misses++;
+#endif
             }
 
             /* Initialize the allocated buffer. */
@@ -80,6 +601,29 @@ static void *alloc_fixed_size(struct heap_t *self_p,
     return (NULL);
 }
 
+#if CONFIG_HEAP_TLSF == 1
+
+static void *alloc_dynamic_size(struct heap_t *self_p,
+                                size_t size)
+{
+    struct heap_buffer_header_t *header_p;
+
+    header_p = tlsf_alloc(self_p, size);
+
+    if (header_p == NULL) {
+        return (NULL);
+    }
+
+    /* Initialize the allocated buffer. */
+    header_p->u.fixed_p = NULL;
+    header_p->size = size;
+    header_p->count = 1;
+
+    return (&header_p[1]);
+}
+
+#else
+
 static void *alloc_dynamic_size(struct heap_t *self_p,
                                 size_t size)
 {
@@ -136,6 +680,8 @@ static void *alloc_dynamic_size(struct heap_t *self_p,
     return (&header_p[1]);
 }
 
+#endif
+
 static int free_fixed_size(struct heap_t *self_p,
                            struct heap_buffer_header_t *header_p)
 {
@@ -152,8 +698,136 @@ static int free_fixed_size(struct heap_t *self_p,
 static int free_dynamic_buffer(struct heap_t *self_p,
                                struct heap_buffer_header_t *header_p)
 {
+#if CONFIG_HEAP_TLSF == 1
+    tlsf_free(self_p, header_p);
+#else
     header_p->u.next_p = self_p->dynamic.free_p;
     self_p->dynamic.free_p = header_p;
+#endif
+
+    return (0);
+}
+
+#if CONFIG_HEAP_STATS == 1
+
+/**
+ * Number of heap bytes used by given allocated buffer.
+ */
+static size_t buffer_size(struct heap_buffer_header_t *header_p)
+{
+#    if CONFIG_HEAP_TLSF == 1
+    return (block_size(header_p));
+#    else
+    if (header_p->u.fixed_p != NULL) {
+        return (sizeof(*header_p) + header_p->u.fixed_p->size);
+    } else {
+        return (sizeof(*header_p) + header_p->size);
+    }
+#    endif
+}
+
+static size_t largest_free(struct heap_t *self_p)
+{
+    struct heap_buffer_header_t *header_p;
+    size_t size;
+#    if CONFIG_HEAP_TLSF == 1
+    int fl;
+    int sl;
+
+    if (self_p->tlsf.fl_bitmap == 0) {
+        return (0);
+    }
+
+    /* The largest block is in the last non-empty free list. */
+    fl = tlsf_fls(self_p->tlsf.fl_bitmap);
+    sl = tlsf_fls(self_p->tlsf.sl_bitmap[fl]);
+    header_p = self_p->tlsf.free_p[fl][sl];
+    size = 0;
+
+    while (header_p != NULL) {
+        if (block_size(header_p) > size) {
+            size = block_size(header_p);
+        }
+
+        header_p = header_p->u.next_p;
+    }
+
+    return (size - sizeof(*header_p));
+#    else
+    size_t left;
+
+    /* Memory never allocated. */
+    left = (self_p->size - ((char *)self_p->next_p - (char *)self_p->buf_p));
+
+    if (left > sizeof(*header_p)) {
+        size = (left - sizeof(*header_p));
+    } else {
+        size = 0;
+    }
+
+    header_p = self_p->dynamic.free_p;
+
+    while (header_p != NULL) {
+        if (header_p->size > size) {
+            size = header_p->size;
+        }
+
+        header_p = header_p->u.next_p;
+    }
+
+    return (size);
+#    endif
+}
+
+#endif
+
+int heap_module_init(void)
+{
+#if CONFIG_HEAP_STATS == 1
+    /* Return immediately if the module is already initialized. */
+    if (module.initialized == 1) {
+        return (0);
+    }
+
+    module.initialized = 1;
+
+#    if CONFIG_HEAP_STATS_FS_COMMANDS == 1
+    fs_command_init(&module.cmd_list,
+                    CSTR("/alloc/heap/list"),
+                    cmd_list_cb,
+                    NULL);
+    fs_command_register(&module.cmd_list);
+
+    fs_command_init(&module.cmd_reset,
+                    CSTR("/alloc/heap/reset"),
+                    cmd_reset_cb,
+                    NULL);
+    fs_command_register(&module.cmd_reset);
+
+#        if CONFIG_HEAP_TRACE_LENGTH > 0
+    fs_command_init(&module.cmd_trace,
+                    CSTR("/alloc/heap/trace"),
+                    cmd_trace_cb,
+                    NULL);
+    fs_command_register(&module.cmd_trace);
+#        endif
+
+    fs_counter_init(&module.allocs,
+                    CSTR("/alloc/heap/allocs"),
+                    0);
+    fs_counter_register(&module.allocs);
+
+    fs_counter_init(&module.frees,
+                    CSTR("/alloc/heap/frees"),
+                    0);
+    fs_counter_register(&module.frees);
+
+    fs_counter_init(&module.failed_allocs,
+                    CSTR("/alloc/heap/failed_allocs"),
+                    0);
+    fs_counter_register(&module.failed_allocs);
+#    endif
+#endif
 
     return (0);
 }
@@ -178,7 +852,21 @@ int heap_init(struct heap_t *self_p,
         self_p->fixed[i].size = sizes[i];
     }
 
+#if CONFIG_HEAP_TLSF == 1
+    tlsf_init(self_p);
+#else
     self_p->dynamic.free_p = NULL;
+#endif
+
+#if CONFIG_HEAP_STATS == 1
+    self_p->name_p = NULL;
+    memset(&self_p->stats, 0, sizeof(self_p->stats));
+    self_p->list_next_p = NULL;
+#    if CONFIG_HEAP_TRACE_LENGTH > 0
+    self_p->trace.index = 0;
+    self_p->trace.length = 0;
+#    endif
+#endif
 
     return (mutex_init(&self_p->mutex));
 }
@@ -199,8 +887,34 @@ void *heap_alloc(struct heap_t *self_p,
         buf_p = alloc_dynamic_size(self_p, size);
     }
 
+#if CONFIG_HEAP_STATS == 1
+    if (buf_p != NULL) {
+        self_p->stats.allocs++;
+        self_p->stats.used +=
+            buffer_size(&((struct heap_buffer_header_t *)buf_p)[-1]);
+
+        if (self_p->stats.used > self_p->stats.used_max) {
+            self_p->stats.used_max = self_p->stats.used;
+        }
+    } else {
+        self_p->stats.failed_allocs++;
+    }
+
+#    if CONFIG_HEAP_TRACE_LENGTH > 0
+    trace_record(self_p, __builtin_return_address(0), buf_p, size);
+#    endif
+#endif
+
     mutex_unlock(&self_p->mutex);
 
+#if CONFIG_HEAP_STATS == 1
+    if (buf_p != NULL) {
+        counter_increment(COUNTER(allocs));
+    } else {
+        counter_increment(COUNTER(failed_allocs));
+    }
+#endif
+
     return (buf_p);
 }
 
@@ -223,6 +937,14 @@ int heap_free(struct heap_t *self_p,
 
         /* Free when count is zero. */
         if (count == 0) {
+#if CONFIG_HEAP_STATS == 1
+            self_p->stats.frees++;
+            self_p->stats.used -= buffer_size(header_p);
+#    if CONFIG_HEAP_TRACE_LENGTH > 0
+            trace_record(self_p, __builtin_return_address(0), buf_p, 0);
+#    endif
+#endif
+
             if (header_p->u.fixed_p != NULL) {
                 count = free_fixed_size(self_p, header_p);
             } else {
@@ -235,6 +957,12 @@ int heap_free(struct heap_t *self_p,
 
     mutex_unlock(&self_p->mutex);
 
+#if CONFIG_HEAP_STATS == 1
+    if (count == 0) {
+        counter_increment(COUNTER(frees));
+    }
+#endif
+
     return (count);
 }
 
@@ -256,3 +984,224 @@ int heap_share(struct heap_t *self_p,
 
     return (0);
 }
+
+int heap_get_stats(struct heap_t *self_p,
+                   struct heap_stats_t *stats_p)
+{
+    ASSERTN(self_p != NULL, EINVAL);
+    ASSERTN(stats_p != NULL, EINVAL);
+
+#if CONFIG_HEAP_STATS == 1
+    mutex_lock(&self_p->mutex);
+    *stats_p = self_p->stats;
+    stats_p->largest_free = largest_free(self_p);
+    mutex_unlock(&self_p->mutex);
+
+    return (0);
+#else
+    return (-ENOSYS);
+#endif
+}
+
+int heap_reset_stats(struct heap_t *self_p)
+{
+    ASSERTN(self_p != NULL, EINVAL);
+
+#if CONFIG_HEAP_STATS == 1
+    size_t used;
+
+    mutex_lock(&self_p->mutex);
+    used = self_p->stats.used;
+    memset(&self_p->stats, 0, sizeof(self_p->stats));
+    self_p->stats.used = used;
+    self_p->stats.used_max = used;
+    mutex_unlock(&self_p->mutex);
+
+    return (0);
+#else
+    return (-ENOSYS);
+#endif
+}
+
+#if CONFIG_HEAP_STATS == 1
+
+static int memory_usage(void *arg_p, struct sys_memory_usage_t *usage_p)
+{
+    struct heap_t *self_p;
+
+    self_p = arg_p;
+    mutex_lock(&self_p->mutex);
+    usage_p->used = self_p->stats.used;
+    usage_p->used_max = self_p->stats.used_max;
+    mutex_unlock(&self_p->mutex);
+
+    return (0);
+}
+
+#endif
+
+int heap_register(struct heap_t *self_p,
+                  const char *name_p)
+{
+    ASSERTN(self_p != NULL, EINVAL);
+    ASSERTN(name_p != NULL, EINVAL);
+
+#if CONFIG_HEAP_STATS == 1
+    heap_module_init();
+
+    sys_lock();
+    self_p->name_p = name_p;
+    self_p->list_next_p = module.head_p;
+    module.head_p = self_p;
+    sys_unlock();
+
+    sys_memory_region_init(&self_p->memory_region,
+                           name_p,
+                           self_p->buf_p,
+                           self_p->size,
+                           memory_usage,
+                           self_p);
+    sys_memory_region_register(&self_p->memory_region);
+
+    return (0);
+#else
+    return (-ENOSYS);
+#endif
+}
+
+int heap_print(void *chan_p)
+{
+    ASSERTN(chan_p != NULL, EINVAL);
+
+#if CONFIG_HEAP_STATS == 1
+    struct heap_t *heap_p;
+    struct heap_stats_t stats;
+    int i;
+
+    std_fprintf(chan_p,
+                OSTR("                NAME      USED  USED-MAX  LARGEST"
+                     "      ALLOCS       FREES      FAILED\r\n"));
+
+    sys_lock();
+    heap_p = module.head_p;
+    sys_unlock();
+
+    while (heap_p != NULL) {
+        heap_get_stats(heap_p, &stats);
+        std_fprintf(chan_p,
+                    OSTR("%20s %9lu %9lu %8lu %11lu %11lu %11lu\r\n"),
+                    heap_p->name_p,
+                    (unsigned long)stats.used,
+                    (unsigned long)stats.used_max,
+                    (unsigned long)stats.largest_free,
+                    (unsigned long)stats.allocs,
+                    (unsigned long)stats.frees,
+                    (unsigned long)stats.failed_allocs);
+
+        for (i = 0; i < HEAP_FIXED_SIZES_MAX; i++) {
+            std_fprintf(chan_p,
+                        OSTR("%20s %9lu hits %lu misses %lu\r\n"),
+                        "fixed",
+                        (unsigned long)heap_p->fixed[i].size,
+                        (unsigned long)stats.fixed[i].hits,
+                        (unsigned long)stats.fixed[i].misses);
+        }
+
+        heap_p = heap_p->list_next_p;
+    }
+
+    return (0);
+#else
+    return (-ENOSYS);
+#endif
+}
+
+int heap_print_openmetrics(void *chan_p)
+{
+    ASSERTN(chan_p != NULL, EINVAL);
+
+#if CONFIG_HEAP_STATS == 1
+    struct heap_t *heap_p;
+    struct heap_stats_t stats;
+    int i;
+
+    for (i = 0; i < membersof(openmetrics_families); i++) {
+        std_fprintf(chan_p,
+                    OSTR("# TYPE %s %s\n"),
+                    openmetrics_families[i][0],
+                    openmetrics_families[i][1]);
+
+        sys_lock();
+        heap_p = module.head_p;
+        sys_unlock();
+
+        while (heap_p != NULL) {
+            heap_get_stats(heap_p, &stats);
+            std_fprintf(chan_p,
+                        OSTR("%s%s{heap=\"%s\"} %lu\n"),
+                        openmetrics_families[i][0],
+                        (i >= 3 ? "_total" : ""),
+                        heap_p->name_p,
+                        stats_value(&stats, i));
+            heap_p = heap_p->list_next_p;
+        }
+    }
+
+    return (0);
+#else
+    return (-ENOSYS);
+#endif
+}
+
+int heap_print_trace(struct heap_t *self_p,
+                     void *chan_p)
+{
+    ASSERTN(self_p != NULL, EINVAL);
+    ASSERTN(chan_p != NULL, EINVAL);
+
+#if (CONFIG_HEAP_STATS == 1) && (CONFIG_HEAP_TRACE_LENGTH > 0)
+    struct heap_trace_entry_t entry;
+    int i;
+    int index;
+    int length;
+
+    std_fprintf(chan_p,
+                OSTR("Heap %s trace (most recent call first):\r\n"),
+                (self_p->name_p != NULL ? self_p->name_p : "-"));
+
+    mutex_lock(&self_p->mutex);
+    length = self_p->trace.length;
+    mutex_unlock(&self_p->mutex);
+
+    for (i = 0; i < length; i++) {
+        /* Copy one entry at a time, as the output channel may
+           allocate from this heap. */
+        mutex_lock(&self_p->mutex);
+        index = (self_p->trace.index - 1 - i);
+
+        if (index < 0) {
+            index += CONFIG_HEAP_TRACE_LENGTH;
+        }
+
+        entry = self_p->trace.entries[index];
+        mutex_unlock(&self_p->mutex);
+
+        if (entry.size > 0) {
+            std_fprintf(chan_p,
+                        OSTR(": 0x%08lx alloc 0x%08lx %lu\r\n"),
+                        (unsigned long)(uintptr_t)entry.caller_p,
+                        (unsigned long)(uintptr_t)entry.buf_p,
+                        (unsigned long)entry.size);
+        } else {
+            std_fprintf(chan_p,
+                        OSTR(": 0x%08lx free 0x%08lx\r\n"),
+                        (unsigned long)(uintptr_t)entry.caller_p,
+                        (unsigned long)(uintptr_t)entry.buf_p);
+        }
+    }
+
+    return (0);
+#else
+    return (-ENOSYS);
+#endif
+}
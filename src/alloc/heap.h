@@ -45,6 +45,74 @@ struct heap_dynamic_t {
     void *free_p;
 };
 
+#if CONFIG_HEAP_TLSF == 1
+
+/**
+ * Base two logarithm of the number of second level free lists per
+ * first level.
+ */
+#    define HEAP_TLSF_SL_INDEX_COUNT_LOG2 3
+#    define HEAP_TLSF_SL_INDEX_COUNT (1 << HEAP_TLSF_SL_INDEX_COUNT_LOG2)
+
+/**
+ * Block sizes are multiples of 1 << HEAP_TLSF_ALIGN_LOG2, at least
+ * four bytes and the pointer size.
+ */
+#    if (CONFIG_ALIGNMENT > 4) || (__SIZEOF_POINTER__ > 4)
+#        define HEAP_TLSF_ALIGN_LOG2 3
+#    else
+#        define HEAP_TLSF_ALIGN_LOG2 2
+#    endif
+
+#    define HEAP_TLSF_FL_INDEX_SHIFT                    \
+    (HEAP_TLSF_SL_INDEX_COUNT_LOG2 + HEAP_TLSF_ALIGN_LOG2)
+#    define HEAP_TLSF_FL_INDEX_COUNT                    \
+    (CONFIG_HEAP_TLSF_FL_INDEX_MAX - HEAP_TLSF_FL_INDEX_SHIFT + 1)
+
+struct heap_tlsf_t {
+    uint32_t fl_bitmap;
+    uint32_t sl_bitmap[HEAP_TLSF_FL_INDEX_COUNT];
+    void *free_p[HEAP_TLSF_FL_INDEX_COUNT][HEAP_TLSF_SL_INDEX_COUNT];
+};
+
+#endif
+
+/**
+ * Heap statistics, see `heap_get_stats()`.
+ */
+struct heap_stats_t {
+    /** Number of bytes in use, including buffer headers. */
+    size_t used;
+    /** Maximum number of bytes in use since the last reset. */
+    size_t used_max;
+    /** Size of the biggest buffer that can be allocated from the
+        dynamic heap. */
+    size_t largest_free;
+    /** Number of successful allocations. */
+    uint32_t allocs;
+    /** Number of buffers freed. */
+    uint32_t frees;
+    /** Number of failed allocations. */
+    uint32_t failed_allocs;
+    /** Per fixed size allocations from the free list (hits) and from
+        new memory (misses). */
+    struct {
+        uint32_t hits;
+        uint32_t misses;
+    } fixed[HEAP_FIXED_SIZES_MAX];
+};
+
+/**
+ * An allocation trace entry.
+ */
+struct heap_trace_entry_t {
+    /** Return address of the heap_alloc() or heap_free() call. */
+    void *caller_p;
+    void *buf_p;
+    /** Requested size, or zero(0) for a free. */
+    size_t size;
+};
+
 /**
  * The heap struct.
  */
@@ -53,10 +121,38 @@ struct heap_t {
     size_t size;
     void *next_p;
     struct heap_fixed_t fixed[HEAP_FIXED_SIZES_MAX];
+#if CONFIG_HEAP_TLSF == 1
+    struct heap_tlsf_t tlsf;
+#else
     struct heap_dynamic_t dynamic;
+#endif
     struct mutex_t mutex;
+#if CONFIG_HEAP_STATS == 1
+    const char *name_p;
+    struct heap_stats_t stats;
+    struct heap_t *list_next_p;
+    struct sys_memory_region_t memory_region;
+#    if CONFIG_HEAP_TRACE_LENGTH > 0
+    struct {
+        struct heap_trace_entry_t entries[CONFIG_HEAP_TRACE_LENGTH];
+        int index;
+        int length;
+    } trace;
+#    endif
+#endif
 };
 
+/**
+ * Initialize the heap module, registering the statistics file system
+ * commands and counters. Called by `heap_register()`.
+ *
+ * The module will only be initialized once even if this function is
+ * called multiple times.
+ *
+ * @return zero(0) or negative error code.
+ */
+int heap_module_init(void);
+
 /**
  * Initialize given heap.
  *
@@ -78,6 +174,11 @@ int heap_init(struct heap_t *self_p,
  * if the requested buffer size is greater than the biggest fixed size
  * buffer.
  *
+ * With ``CONFIG_HEAP_TLSF`` the dynamic heap is a two-level
+ * segregated fit allocator, which allocates and frees in constant
+ * time and merges adjacent free buffers. Fixed size buffers are
+ * allocated from it when their free list is empty.
+ *
  * @param[in] self_p Heap to allocate from.
  * @param[in] size Number of bytes to allocate.
  *
@@ -112,4 +213,74 @@ int heap_share(struct heap_t *self_p,
                const void *buf_p,
                int count);
 
+/**
+ * Get the statistics of given heap. Requires ``CONFIG_HEAP_STATS``.
+ *
+ * @param[in] self_p Heap to get statistics of.
+ * @param[out] stats_p Statistics.
+ *
+ * @return zero(0) or negative error code.
+ */
+int heap_get_stats(struct heap_t *self_p,
+                   struct heap_stats_t *stats_p);
+
+/**
+ * Reset the counters and the maximum number of bytes in use of given
+ * heap. Requires ``CONFIG_HEAP_STATS``.
+ *
+ * @param[in] self_p Heap to reset statistics of.
+ *
+ * @return zero(0) or negative error code.
+ */
+int heap_reset_stats(struct heap_t *self_p);
+
+/**
+ * Register given heap by name, to be listed by `heap_print()`,
+ * `sys_memory_print()` and the file system commands. Requires ``CONFIG_HEAP_STATS``. A
+ * registered heap must never go out of scope. The file system
+ * counters count allocations from all heaps, registered or not,
+ * from the first call to this function.
+ *
+ * @param[in] self_p Heap to register.
+ * @param[in] name_p Heap name.
+ *
+ * @return zero(0) or negative error code.
+ */
+int heap_register(struct heap_t *self_p,
+                  const char *name_p);
+
+/**
+ * Print the statistics of all registered heaps.
+ *
+ * @param[in] chan_p Output channel.
+ *
+ * @return zero(0) or negative error code.
+ */
+int heap_print(void *chan_p);
+
+/**
+ * Write the statistics of all registered heaps to given channel in
+ * the OpenMetrics text format, with the heap name as label. Requires
+ * ``CONFIG_HEAP_STATS``.
+ *
+ * @param[in] chan_p Output channel.
+ *
+ * @return zero(0) or negative error code.
+ */
+int heap_print_openmetrics(void *chan_p);
+
+/**
+ * Print the allocation trace of given heap, most recent call
+ * first. Requires ``CONFIG_HEAP_STATS`` and
+ * ``CONFIG_HEAP_TRACE_LENGTH``. The caller addresses can be
+ * translated to function names and lines by ``bin/backtrace.py``.
+ *
+ * @param[in] self_p Heap to print the trace of.
+ * @param[in] chan_p Output channel.
+ *
+ * @return zero(0) or negative error code.
+ */
+int heap_print_trace(struct heap_t *self_p,
+                     void *chan_p);
+
 #endif
@@ -0,0 +1,249 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2014-2018, Erik Moqvist
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use, copy,
+ * modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ * This file is part of the Simba project.
+ */
+
+#include "simba.h"
+
+/* Lock-free when the target has a compare and swap instruction,
+   otherwise the free list is protected by the system lock. */
+#if defined(__GCC_HAVE_SYNC_COMPARE_AND_SWAP_4)
+#    define POOL_LOCK_FREE 1
+#else
+#    define POOL_LOCK_FREE 0
+#endif
+
+#define INDEX_MASK                                           0xffff
+#define TAG_INCREMENT                                       0x10000
+
+#if POOL_LOCK_FREE == 1
+#    define LOAD(var) __atomic_load_n(&(var), __ATOMIC_ACQUIRE)
+#    define STORE(var, value)                                   \
+    __atomic_store_n(&(var), (value), __ATOMIC_RELAXED)
+#    define CAS(var_p, expected_p, value)                       \
+    __atomic_compare_exchange_n((var_p),                        \
+                                (expected_p),                   \
+                                (value),                        \
+                                1,                              \
+                                __ATOMIC_ACQ_REL,               \
+                                __ATOMIC_ACQUIRE)
+#    define ADD(var, value)                                     \
+    __atomic_add_fetch(&(var), (value), __ATOMIC_RELAXED)
+#else
+#    define LOAD(var) (var)
+#    define STORE(var, value) ((var) = (value))
+#    define CAS(var_p, expected_p, value) (*(var_p) = (value), 1)
+#    define ADD(var, value) ((var) += (value))
+#endif
+
+/**
+ * The free list link, stored first in each free block.
+ */
+static uint32_t *block_link(struct pool_t *self_p, uint32_t index)
+{
+    return ((uint32_t *)&self_p->buf_p[(index - 1) * self_p->block_size]);
+}
+
+/**
+ * Pop the first block from the free list. The tag in the head makes
+ * the compare and swap fail if the list was modified between the
+ * load of the head and the swap, even if the same block is first
+ * again.
+ */
+static uint32_t pop(struct pool_t *self_p)
+{
+    uint32_t head;
+    uint32_t next;
+
+    head = LOAD(self_p->head);
+
+    do {
+        if ((head & INDEX_MASK) == 0) {
+            return (0);
+        }
+
+        next = ((head & ~INDEX_MASK) + TAG_INCREMENT);
+        next |= (LOAD(*block_link(self_p, head & INDEX_MASK)) & INDEX_MASK);
+    } while (!CAS(&self_p->head, &head, next));
+
+    return (head & INDEX_MASK);
+}
+
+static void push(struct pool_t *self_p, uint32_t index)
+{
+    uint32_t head;
+    uint32_t next;
+
+    head = LOAD(self_p->head);
+
+    do {
+        STORE(*block_link(self_p, index), head & INDEX_MASK);
+        next = (((head & ~INDEX_MASK) + TAG_INCREMENT) | index);
+    } while (!CAS(&self_p->head, &head, next));
+}
+
+static void update_used_max(struct pool_t *self_p, uint32_t used)
+{
+#if POOL_LOCK_FREE == 1
+    uint32_t used_max;
+
+    used_max = LOAD(self_p->used_max);
+
+    while (used > used_max) {
+        if (CAS(&self_p->used_max, &used_max, used)) {
+            break;
+        }
+    }
+#else
+    if (used > self_p->used_max) {
+        self_p->used_max = used;
+    }
+#endif
+}
+
+int pool_init(struct pool_t *self_p,
+              void *buf_p,
+              size_t size,
+              size_t block_size)
+{
+    ASSERTN(self_p != NULL, EINVAL);
+    ASSERTN(buf_p != NULL, EINVAL);
+    ASSERTN(block_size > 0, EINVAL);
+
+    uint32_t length;
+    uint32_t i;
+
+    block_size = POOL_BLOCK_SIZE(block_size);
+    length = (size / block_size);
+
+    ASSERTN(length > 0, EINVAL);
+    ASSERTN(length <= INDEX_MASK, EINVAL);
+
+    self_p->buf_p = buf_p;
+    self_p->block_size = block_size;
+    self_p->length = length;
+    self_p->used = 0;
+    self_p->used_max = 0;
+    self_p->allocs = 0;
+    self_p->failed_allocs = 0;
+
+    /* Link all blocks in address order. */
+    for (i = 1; i < length; i++) {
+        *block_link(self_p, i) = (i + 1);
+    }
+
+    *block_link(self_p, length) = 0;
+    self_p->head = 1;
+
+    return (0);
+}
+
+void *pool_alloc(struct pool_t *self_p)
+{
+    ASSERTNRN(self_p != NULL, EINVAL);
+
+    void *buf_p;
+
+#if POOL_LOCK_FREE == 1
+    buf_p = pool_alloc_isr(self_p);
+#else
+    sys_lock();
+    buf_p = pool_alloc_isr(self_p);
+    sys_unlock();
+#endif
+
+    return (buf_p);
+}
+
+RAM_CODE void *pool_alloc_isr(struct pool_t *self_p)
+{
+    uint32_t index;
+
+    index = pop(self_p);
+
+    if (index == 0) {
+        ADD(self_p->failed_allocs, 1);
+
+        return (NULL);
+    }
+
+    ADD(self_p->allocs, 1);
+    update_used_max(self_p, ADD(self_p->used, 1));
+
+    return (block_link(self_p, index));
+}
+
+int pool_free(struct pool_t *self_p, void *buf_p)
+{
+    ASSERTN(self_p != NULL, EINVAL);
+    ASSERTN(buf_p != NULL, EINVAL);
+
+    int res;
+
+#if POOL_LOCK_FREE == 1
+    res = pool_free_isr(self_p, buf_p);
+#else
+    sys_lock();
+    res = pool_free_isr(self_p, buf_p);
+    sys_unlock();
+#endif
+
+    return (res);
+}
+
+RAM_CODE int pool_free_isr(struct pool_t *self_p, void *buf_p)
+{
+    size_t offset;
+
+    offset = ((char *)buf_p - self_p->buf_p);
+
+    /* Not a block in this pool? */
+    if (((char *)buf_p < self_p->buf_p)
+        || (offset >= (self_p->length * self_p->block_size))
+        || ((offset % self_p->block_size) != 0)) {
+        return (-EINVAL);
+    }
+
+    ADD(self_p->used, -1);
+    push(self_p, (offset / self_p->block_size) + 1);
+
+    return (0);
+}
+
+int pool_get_stats(struct pool_t *self_p,
+                   struct pool_stats_t *stats_p)
+{
+    ASSERTN(self_p != NULL, EINVAL);
+    ASSERTN(stats_p != NULL, EINVAL);
+
+    stats_p->length = self_p->length;
+    stats_p->used = LOAD(self_p->used);
+    stats_p->used_max = LOAD(self_p->used_max);
+    stats_p->allocs = LOAD(self_p->allocs);
+    stats_p->failed_allocs = LOAD(self_p->failed_allocs);
+
+    return (0);
+}
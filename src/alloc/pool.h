@@ -0,0 +1,158 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2014-2018, Erik Moqvist
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use, copy,
+ * modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ * This file is part of the Simba project.
+ */
+
+#ifndef __ALLOC_POOL_H__
+#define __ALLOC_POOL_H__
+
+#include "simba.h"
+
+/**
+ * Block alignment, at least the pointer size.
+ */
+#define POOL_ALIGNMENT                                          \
+    (CONFIG_ALIGNMENT > sizeof(void *) ? CONFIG_ALIGNMENT : sizeof(void *))
+
+/**
+ * Size of a pool block holding an object of given size. A free block
+ * holds the free list link, so blocks are at least four bytes.
+ */
+#define POOL_BLOCK_SIZE(size)                                   \
+    (DIV_CEIL(((size) > 4 ? (size) : 4), POOL_ALIGNMENT)        \
+     * POOL_ALIGNMENT)
+
+/**
+ * Compile time declaration of the memory of a pool of ``length``
+ * blocks of ``size`` bytes each.
+ */
+#define POOL_BUFFER(name, size, length)                         \
+    uint64_t name[DIV_CEIL(POOL_BLOCK_SIZE(size) * (length),    \
+                           sizeof(uint64_t))]
+
+/**
+ * Compile time declaration of the memory of a pool of ``length``
+ * objects of given type.
+ */
+#define POOL_TYPE_BUFFER(name, type, length)    \
+    POOL_BUFFER(name, sizeof(type), length)
+
+/**
+ * Allocate an object of given type from given pool.
+ */
+#define POOL_ALLOC(self_p, type) ((type *)pool_alloc(self_p))
+
+/**
+ * Pool statistics, see `pool_get_stats()`.
+ */
+struct pool_stats_t {
+    /** Number of blocks in the pool. */
+    uint32_t length;
+    /** Number of allocated blocks. */
+    uint32_t used;
+    /** Maximum number of allocated blocks. */
+    uint32_t used_max;
+    /** Number of successful allocations. */
+    uint32_t allocs;
+    /** Number of failed allocations. */
+    uint32_t failed_allocs;
+};
+
+/**
+ * A pool of fixed size blocks.
+ */
+struct pool_t {
+    char *buf_p;
+    size_t block_size;
+    uint32_t length;
+    /* Index plus one of the first free block in the 16 least
+       significant bits, and a modification tag in the 16 most
+       significant bits. */
+    uint32_t head;
+    uint32_t used;
+    uint32_t used_max;
+    uint32_t allocs;
+    uint32_t failed_allocs;
+};
+
+/**
+ * Initialize given pool. The number of blocks is the buffer size
+ * divided by `POOL_BLOCK_SIZE(block_size)`, at most 65535.
+ *
+ * @param[in] self_p Pool to initialize.
+ * @param[in] buf_p Pool memory, preferably declared with
+ *                  `POOL_BUFFER()` or `POOL_TYPE_BUFFER()`.
+ * @param[in] size Size of the pool memory.
+ * @param[in] block_size Size of each block.
+ *
+ * @return zero(0) or negative error code.
+ */
+int pool_init(struct pool_t *self_p,
+              void *buf_p,
+              size_t size,
+              size_t block_size);
+
+/**
+ * Allocate a block from given pool.
+ *
+ * @param[in] self_p Pool to allocate from.
+ *
+ * @return Pointer to allocated block, or NULL if the pool is empty.
+ */
+void *pool_alloc(struct pool_t *self_p);
+
+/**
+ * Same as `pool_alloc()`, but may be called from interrupt context.
+ */
+void *pool_alloc_isr(struct pool_t *self_p);
+
+/**
+ * Free given block, previously allocated from given pool.
+ *
+ * @param[in] self_p Pool to free to.
+ * @param[in] buf_p Block to free.
+ *
+ * @return zero(0) or negative error code.
+ */
+int pool_free(struct pool_t *self_p, void *buf_p);
+
+/**
+ * Same as `pool_free()`, but may be called from interrupt context.
+ */
+int pool_free_isr(struct pool_t *self_p, void *buf_p);
+
+/**
+ * Get the statistics of given pool.
+ *
+ * @param[in] self_p Pool to get statistics of.
+ * @param[out] stats_p Statistics.
+ *
+ * @return zero(0) or negative error code.
+ */
+int pool_get_stats(struct pool_t *self_p,
+                   struct pool_stats_t *stats_p);
+
+#endif
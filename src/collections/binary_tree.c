@@ -27,6 +27,11 @@
  */
 
 #include "simba.h"
+#include <limits.h>
+
+/* Maximum height of the tree. An AVL tree of this height has
+   millions of nodes. */
+#define HEIGHT_MAX                                         32
 
 static void print_node(struct binary_tree_node_t *node_p)
 {
@@ -108,146 +113,316 @@ node_balance(struct binary_tree_node_t *node_p)
     return (node_p);
 }
 
-static int node_insert(struct binary_tree_node_t **parent_pp,
-                       struct binary_tree_node_t *node_p)
+/**
+ * Iterative search for the node with given key. Stores the links
+ * from the root down to the node, excluding the link to the node, in
+ * given path. Returns the link to the node, or the NULL link where it
+ * would be inserted.
+ */
+static struct binary_tree_node_t **
+node_find_link(struct binary_tree_t *self_p,
+               int key,
+               struct binary_tree_node_t ***path_ppp,
+               int *depth_p)
 {
-    int res = 0;
-    struct binary_tree_node_t *parent_p = *parent_pp;
+    struct binary_tree_node_t **link_pp;
+    int depth;
 
-    if (parent_p == NULL) {
-        *parent_pp = node_p;
-        return (0);
-    }
+    link_pp = &self_p->root_p;
+    depth = 0;
 
-    if (node_p->key < parent_p->key) {
-        res = node_insert(&parent_p->left_p, node_p);
-    } else if (node_p->key > parent_p->key ) {
-        res = node_insert(&parent_p->right_p, node_p);
-    } else {
-        return (-1);
+    while ((*link_pp != NULL) && ((*link_pp)->key != key)) {
+        path_ppp[depth++] = link_pp;
+
+        if (key < (*link_pp)->key) {
+            link_pp = &(*link_pp)->left_p;
+        } else {
+            link_pp = &(*link_pp)->right_p;
+        }
     }
 
-    *parent_pp = node_balance(parent_p);
+    *depth_p = depth;
 
-    return (res);
+    return (link_pp);
 }
 
-static struct binary_tree_node_t *
-node_find_min(struct binary_tree_node_t *node_p)
+/**
+ * Rebalance all nodes in given path, bottom up.
+ */
+static void path_balance(struct binary_tree_node_t ***path_ppp,
+                         int depth)
 {
-    if (node_p->left_p != NULL) {
-        return (node_find_min(node_p->left_p));
-    } else {
-        return (node_p);
+    while (depth > 0) {
+        depth--;
+        *path_ppp[depth] = node_balance(*path_ppp[depth]);
     }
 }
 
-static struct binary_tree_node_t *
-node_delete_min(struct binary_tree_node_t *node_p)
+static int node_height_of_length(size_t length)
 {
-    if (node_p->left_p == NULL) {
-        return (node_p->right_p);
+    int height;
+
+    height = 0;
+
+    while (length > 0) {
+        height++;
+        length >>= 1;
     }
 
-    node_p->left_p = node_delete_min(node_p->left_p);
+    return (height);
+}
+
+int binary_tree_init(struct binary_tree_t *self_p)
+{
+    ASSERTN(self_p != NULL, EINVAL);
+
+    self_p->root_p = NULL;
 
-    return (node_balance(node_p));
+    return (0);
 }
 
-static int node_delete_item(struct binary_tree_node_t **node_pp,
-                            int key)
+int binary_tree_insert(struct binary_tree_t *self_p,
+                       struct binary_tree_node_t *node_p)
 {
-    int res = 0;
-    struct binary_tree_node_t *left_p;
-    struct binary_tree_node_t *right_p;
-    struct binary_tree_node_t *m_p;
-    struct binary_tree_node_t *node_p = *node_pp;
+    ASSERTN(self_p != NULL, EINVAL);
+    ASSERTN(node_p != NULL, EINVAL);
+
+    struct binary_tree_node_t **path[HEIGHT_MAX];
+    struct binary_tree_node_t **link_pp;
+    int depth;
+
+    link_pp = node_find_link(self_p, node_p->key, &path[0], &depth);
+
+    if (*link_pp != NULL) {
+        return (-1);
+    }
+
+    node_p->height = 1;
+    node_p->left_p = NULL;
+    node_p->right_p= NULL;
+    *link_pp = node_p;
+    path_balance(&path[0], depth);
+
+    return (0);
+}
+
+int binary_tree_delete(struct binary_tree_t *self_p,
+                       int key)
+{
+    ASSERTN(self_p != NULL, EINVAL);
+
+    struct binary_tree_node_t **path[HEIGHT_MAX];
+    struct binary_tree_node_t **link_pp;
+    struct binary_tree_node_t **min_pp;
+    struct binary_tree_node_t *node_p;
+    struct binary_tree_node_t *min_p;
+    int depth;
+    int right_depth;
+
+    link_pp = node_find_link(self_p, key, &path[0], &depth);
+    node_p = *link_pp;
 
     if (node_p == NULL) {
         return (-1);
     }
 
-    if (key < node_p->key) {
-        res = node_delete_item(&node_p->left_p, key);
-    } else if (key > node_p->key) {
-        res = node_delete_item(&node_p->right_p, key);
+    if (node_p->right_p == NULL) {
+        *link_pp = node_p->left_p;
     } else {
-        left_p = node_p->left_p;
-        right_p = node_p->right_p;
+        /* Replace the node with the minimum node in its right
+           subtree. */
+        path[depth++] = link_pp;
+        right_depth = depth;
+        min_pp = &node_p->right_p;
+
+        while ((*min_pp)->left_p != NULL) {
+            path[depth++] = min_pp;
+            min_pp = &(*min_pp)->left_p;
+        }
 
-        if (right_p == NULL) {
-            *node_pp = left_p;
+        min_p = *min_pp;
+        *min_pp = min_p->right_p;
+        min_p->left_p = node_p->left_p;
+        min_p->right_p = node_p->right_p;
+        *link_pp = min_p;
 
-            return (0);
+        /* The right subtree is now linked from the minimum node. */
+        if (depth > right_depth) {
+            path[right_depth] = &min_p->right_p;
         }
+    }
 
-        m_p = node_find_min(right_p);
-        m_p->right_p = node_delete_min(right_p);
-        m_p->left_p = left_p;
+    path_balance(&path[0], depth);
 
-        *node_pp = node_balance(m_p);
+    return (0);
+}
 
-        return (0);
-    }
+struct binary_tree_node_t *
+binary_tree_search(struct binary_tree_t *self_p,
+                   int key)
+{
+    ASSERTNRN(self_p != NULL, EINVAL);
 
-    *node_pp = node_balance(node_p);
+    struct binary_tree_node_t *node_p;
 
-    return (res);
+    node_p = self_p->root_p;
+
+    while ((node_p != NULL) && (node_p->key != key)) {
+        if (key < node_p->key) {
+            node_p = node_p->left_p;
+        } else {
+            node_p = node_p->right_p;
+        }
+    }
+
+    return (node_p);
 }
 
-static struct binary_tree_node_t *
-node_search(struct binary_tree_node_t *node_p, int key)
+struct binary_tree_node_t *
+binary_tree_lower_bound(struct binary_tree_t *self_p,
+                        int key)
 {
-    if (node_p == NULL) {
-        return (NULL);
+    ASSERTNRN(self_p != NULL, EINVAL);
+
+    struct binary_tree_node_t *node_p;
+    struct binary_tree_node_t *found_p;
+
+    node_p = self_p->root_p;
+    found_p = NULL;
+
+    while (node_p != NULL) {
+        if (node_p->key >= key) {
+            found_p = node_p;
+            node_p = node_p->left_p;
+        } else {
+            node_p = node_p->right_p;
+        }
     }
 
-    if (key < node_p->key) {
-        return node_search(node_p->left_p, key);
-    } else if (key > node_p->key) {
-        return node_search(node_p->right_p, key);
-    } else {
-        return (node_p);
+    return (found_p);
+}
+
+struct binary_tree_node_t *
+binary_tree_upper_bound(struct binary_tree_t *self_p,
+                        int key)
+{
+    ASSERTNRN(self_p != NULL, EINVAL);
+
+    struct binary_tree_node_t *node_p;
+    struct binary_tree_node_t *found_p;
+
+    node_p = self_p->root_p;
+    found_p = NULL;
+
+    while (node_p != NULL) {
+        if (node_p->key > key) {
+            found_p = node_p;
+            node_p = node_p->left_p;
+        } else {
+            node_p = node_p->right_p;
+        }
     }
+
+    return (found_p);
 }
 
-int binary_tree_init(struct binary_tree_t *self_p)
+int binary_tree_iter_init(struct binary_tree_iter_t *self_p,
+                          struct binary_tree_t *tree_p,
+                          int low,
+                          int high)
 {
     ASSERTN(self_p != NULL, EINVAL);
+    ASSERTN(tree_p != NULL, EINVAL);
 
-    self_p->root_p = NULL;
+    self_p->tree_p = tree_p;
+    self_p->high = high;
+    self_p->next_p = binary_tree_lower_bound(tree_p, low);
 
     return (0);
 }
 
-int binary_tree_insert(struct binary_tree_t *self_p,
-                       struct binary_tree_node_t *node_p)
+struct binary_tree_node_t *
+binary_tree_iter_next(struct binary_tree_iter_t *self_p)
 {
-    ASSERTN(self_p != NULL, EINVAL);
-    ASSERTN(node_p != NULL, EINVAL);
+    ASSERTNRN(self_p != NULL, EINVAL);
 
-    node_p->height = 1;
-    node_p->left_p = NULL;
-    node_p->right_p= NULL;
+    struct binary_tree_node_t *node_p;
 
-    return (node_insert(&self_p->root_p, node_p));
+    node_p = self_p->next_p;
+
+    if ((node_p == NULL) || (node_p->key > self_p->high)) {
+        self_p->next_p = NULL;
+
+        return (NULL);
+    }
+
+    /* Find the next node before returning this one, so the caller
+       may delete it. */
+    if (node_p->key == INT_MAX) {
+        self_p->next_p = NULL;
+    } else {
+        self_p->next_p = binary_tree_upper_bound(self_p->tree_p,
+                                                 node_p->key);
+    }
+
+    return (node_p);
 }
 
-int binary_tree_delete(struct binary_tree_t *self_p,
-                       int key)
+int binary_tree_build(struct binary_tree_t *self_p,
+                      struct binary_tree_node_t **nodes_pp,
+                      size_t length)
 {
     ASSERTN(self_p != NULL, EINVAL);
+    ASSERTN((nodes_pp != NULL) || (length == 0), EINVAL);
+
+    struct {
+        size_t begin;
+        size_t end;
+        struct binary_tree_node_t **link_pp;
+    } stack[HEIGHT_MAX + 1];
+    struct binary_tree_node_t *node_p;
+    size_t i;
+    size_t middle;
+    int depth;
+
+    for (i = 1; i < length; i++) {
+        if (nodes_pp[i - 1]->key >= nodes_pp[i]->key) {
+            return (-EINVAL);
+        }
+    }
 
-    return (node_delete_item(&self_p->root_p, key));
-}
+    /* The middle node of each range is the root of its subtree. The
+       height of a subtree built this way only depends on its number
+       of nodes. */
+    self_p->root_p = NULL;
+    stack[0].begin = 0;
+    stack[0].end = length;
+    stack[0].link_pp = &self_p->root_p;
+    depth = 1;
 
-struct binary_tree_node_t *
-binary_tree_search(struct binary_tree_t *self_p,
-                   int key)
-{
-    ASSERTNRN(self_p != NULL, EINVAL);
+    while (depth > 0) {
+        depth--;
+
+        if (stack[depth].begin == stack[depth].end) {
+            *stack[depth].link_pp = NULL;
+            continue;
+        }
 
-    return (node_search(self_p->root_p, key));
+        middle = ((stack[depth].begin + stack[depth].end) / 2);
+        node_p = nodes_pp[middle];
+        node_p->height = node_height_of_length(stack[depth].end
+                                               - stack[depth].begin);
+        *stack[depth].link_pp = node_p;
+
+        stack[depth + 1].begin = stack[depth].begin;
+        stack[depth + 1].end = middle;
+        stack[depth + 1].link_pp = &node_p->left_p;
+        stack[depth].begin = (middle + 1);
+        stack[depth].link_pp = &node_p->right_p;
+        depth += 2;
+    }
+
+    return (0);
 }
 
 void binary_tree_print(struct binary_tree_t *self_p)
@@ -42,6 +42,15 @@ struct binary_tree_t {
     struct binary_tree_node_t *root_p;
 };
 
+/**
+ * An in-order binary tree iterator.
+ */
+struct binary_tree_iter_t {
+    struct binary_tree_t *tree_p;
+    struct binary_tree_node_t *next_p;
+    int high;
+};
+
 /**
  * Initialize given binary tree.
  *
@@ -92,6 +101,80 @@ struct binary_tree_node_t *
 binary_tree_search(struct binary_tree_t *self_p,
                    int key);
 
+/**
+ * Find the node with the smallest key greater than or equal to given
+ * key.
+ *
+ * @param[in] self_p Binary tree to search in.
+ * @param[in] key Key to search for.
+ *
+ * @return Pointer to found node or NULL if all keys are less than
+ *         given key.
+ */
+struct binary_tree_node_t *
+binary_tree_lower_bound(struct binary_tree_t *self_p,
+                        int key);
+
+/**
+ * Find the node with the smallest key greater than given key.
+ *
+ * @param[in] self_p Binary tree to search in.
+ * @param[in] key Key to search for.
+ *
+ * @return Pointer to found node or NULL if all keys are less than or
+ *         equal to given key.
+ */
+struct binary_tree_node_t *
+binary_tree_upper_bound(struct binary_tree_t *self_p,
+                        int key);
+
+/**
+ * Initialize given iterator to iterate over all nodes with keys in
+ * the range `low` to `high`, both inclusive, in key order. Use
+ * `INT_MIN` and `INT_MAX` to iterate over all nodes.
+ *
+ * The iterator does not allocate any memory. Nodes may be inserted
+ * and deleted during the iteration, including the node most recently
+ * returned by `binary_tree_iter_next()`.
+ *
+ * @param[out] self_p Iterator to initialize.
+ * @param[in] tree_p Binary tree to iterate over.
+ * @param[in] low Lowest key in range.
+ * @param[in] high Highest key in range.
+ *
+ * @return zero(0) or negative error code.
+ */
+int binary_tree_iter_init(struct binary_tree_iter_t *self_p,
+                          struct binary_tree_t *tree_p,
+                          int low,
+                          int high);
+
+/**
+ * Get the next node from given iterator.
+ *
+ * @param[in] self_p Initialized iterator.
+ *
+ * @return Next node or NULL if there are no more nodes in the range.
+ */
+struct binary_tree_node_t *
+binary_tree_iter_next(struct binary_tree_iter_t *self_p);
+
+/**
+ * Build a balanced binary tree from given array of nodes sorted by
+ * key, in linear time. Nodes already in the tree are discarded.
+ *
+ * @param[in] self_p Binary tree to build.
+ * @param[in] nodes_pp Array of nodes sorted by key, in ascending
+ *                     order.
+ * @param[in] length Number of nodes in the array.
+ *
+ * @return zero(0) on success, -EINVAL if the nodes are not sorted or
+ *         two nodes have the same key, otherwise negative error code.
+ */
+int binary_tree_build(struct binary_tree_t *self_p,
+                      struct binary_tree_node_t **nodes_pp,
+                      size_t length);
+
 /**
  * Print given binary tree.
  *
@@ -54,3 +54,223 @@ uint32_t bits_reverse_32(uint32_t value)
 
     return ((value >> 16) | (value << 16));
 }
+
+int bits_count_32_generic(uint32_t value)
+{
+    value = (value - ((value >> 1) & 0x55555555));
+    value = ((value & 0x33333333) + ((value >> 2) & 0x33333333));
+    value = ((value + (value >> 4)) & 0x0f0f0f0f);
+    value += (value >> 8);
+    value += (value >> 16);
+
+    return (value & 0x3f);
+}
+
+int bits_ctz_32_generic(uint32_t value)
+{
+    int count;
+
+    count = 0;
+
+    if ((value & 0xffff) == 0) {
+        count += 16;
+        value >>= 16;
+    }
+
+    if ((value & 0xff) == 0) {
+        count += 8;
+        value >>= 8;
+    }
+
+    if ((value & 0xf) == 0) {
+        count += 4;
+        value >>= 4;
+    }
+
+    if ((value & 0x3) == 0) {
+        count += 2;
+        value >>= 2;
+    }
+
+    if ((value & 0x1) == 0) {
+        count += 1;
+    }
+
+    return (count);
+}
+
+int bits_clz_32_generic(uint32_t value)
+{
+    int count;
+
+    count = 0;
+
+    if ((value & 0xffff0000) == 0) {
+        count += 16;
+        value <<= 16;
+    }
+
+    if ((value & 0xff000000) == 0) {
+        count += 8;
+        value <<= 8;
+    }
+
+    if ((value & 0xf0000000) == 0) {
+        count += 4;
+        value <<= 4;
+    }
+
+    if ((value & 0xc0000000) == 0) {
+        count += 2;
+        value <<= 2;
+    }
+
+    if ((value & 0x80000000) == 0) {
+        count += 1;
+    }
+
+    return (count);
+}
+
+/**
+ * Mask of bits from given bit to the end of its word.
+ */
+static uint32_t mask_from(int bit)
+{
+    return (0xffffffff << (bit % 32));
+}
+
+/**
+ * Mask of bits from the beginning of a word to given bit, exclusive,
+ * or all bits if at the beginning.
+ */
+static uint32_t mask_to(int bit)
+{
+    return (0xffffffff >> ((32 - (bit % 32)) % 32));
+}
+
+void bits_bitmap_set(uint32_t *bitmap_p, int first, int count)
+{
+    uint32_t *word_p;
+    uint32_t *last_p;
+    int end;
+
+    if (count <= 0) {
+        return;
+    }
+
+    end = (first + count);
+    word_p = &bitmap_p[first / 32];
+    last_p = &bitmap_p[(end - 1) / 32];
+
+    if (word_p == last_p) {
+        *word_p |= (mask_from(first) & mask_to(end));
+    } else {
+        *word_p++ |= mask_from(first);
+
+        while (word_p < last_p) {
+            *word_p++ = 0xffffffff;
+        }
+
+        *word_p |= mask_to(end);
+    }
+}
+
+void bits_bitmap_clear(uint32_t *bitmap_p, int first, int count)
+{
+    uint32_t *word_p;
+    uint32_t *last_p;
+    int end;
+
+    if (count <= 0) {
+        return;
+    }
+
+    end = (first + count);
+    word_p = &bitmap_p[first / 32];
+    last_p = &bitmap_p[(end - 1) / 32];
+
+    if (word_p == last_p) {
+        *word_p &= ~(mask_from(first) & mask_to(end));
+    } else {
+        *word_p++ &= ~mask_from(first);
+
+        while (word_p < last_p) {
+            *word_p++ = 0;
+        }
+
+        *word_p &= ~mask_to(end);
+    }
+}
+
+/**
+ * Find the first bit at or after start that differs from given
+ * inverted value, that is, the first set bit if invert is zero and
+ * the first cleared bit if invert is all ones.
+ */
+static int bitmap_find_first(const uint32_t *bitmap_p,
+                             int size,
+                             int start,
+                             uint32_t invert)
+{
+    int index;
+    int words;
+    uint32_t value;
+    int bit;
+
+    if (start >= size) {
+        return (-1);
+    }
+
+    index = (start / 32);
+    words = BITS_BITMAP_WORDS(size);
+    value = ((bitmap_p[index] ^ invert) & mask_from(start));
+
+    while (1) {
+        if (value != 0) {
+            bit = (32 * index + bits_ctz_32(value));
+
+            return (bit < size ? bit : -1);
+        }
+
+        index++;
+
+        if (index == words) {
+            return (-1);
+        }
+
+        value = (bitmap_p[index] ^ invert);
+    }
+}
+
+int bits_bitmap_find_first_set(const uint32_t *bitmap_p,
+                               int size,
+                               int start)
+{
+    return (bitmap_find_first(bitmap_p, size, start, 0));
+}
+
+int bits_bitmap_find_first_clear(const uint32_t *bitmap_p,
+                                 int size,
+                                 int start)
+{
+    return (bitmap_find_first(bitmap_p, size, start, 0xffffffff));
+}
+
+int bits_bitmap_count(const uint32_t *bitmap_p, int size)
+{
+    int count;
+    int i;
+
+    count = 0;
+
+    for (i = 0; i < size / 32; i++) {
+        count += bits_count_32(bitmap_p[i]);
+    }
+
+    if ((size % 32) != 0) {
+        count += bits_count_32(bitmap_p[i] & mask_to(size));
+    }
+
+    return (count);
+}
@@ -31,6 +31,23 @@
 
 #include "simba.h"
 
+/**
+ * Number of 32 bits words needed for a bitmap of given number of
+ * bits.
+ */
+#define BITS_BITMAP_WORDS(bits) (((bits) + 31) / 32)
+
+/**
+ * Declare a bitmap of given number of bits.
+ */
+#define BITS_BITMAP(name, bits) uint32_t name[BITS_BITMAP_WORDS(bits)]
+
+/* Builtins of 32 bits words. Not used on AVR, where they are slow
+   library calls operating on 16 bits integers. */
+#if defined(__GNUC__) && !defined(__AVR__)
+#    define BITS_HAS_BUILTINS
+#endif
+
 /**
  * Create a bit mask of given width.
  *
@@ -71,6 +88,162 @@ static inline uint32_t bits_insert_32(uint32_t dst,
     return (dst);
 }
 
+/* Portable implementations, used if builtins are missing. */
+int bits_count_32_generic(uint32_t value);
+int bits_ctz_32_generic(uint32_t value);
+int bits_clz_32_generic(uint32_t value);
+
+/**
+ * Count the number of set bits in given value.
+ *
+ * @param[in] value Value to count set bits in.
+ *
+ * @return Number of set bits.
+ */
+static inline int bits_count_32(uint32_t value)
+{
+#if defined(BITS_HAS_BUILTINS)
+    return (__builtin_popcount(value));
+#else
+    return (bits_count_32_generic(value));
+#endif
+}
+
+/**
+ * Count the number of trailing zeros in given value, that is, the
+ * position of the least significant set bit. On ARM this is an RBIT
+ * and a CLZ instruction.
+ *
+ * @param[in] value Value. Must not be zero.
+ *
+ * @return Number of trailing zeros, 0-31.
+ */
+static inline int bits_ctz_32(uint32_t value)
+{
+#if defined(BITS_HAS_BUILTINS)
+    return (__builtin_ctz(value));
+#else
+    return (bits_ctz_32_generic(value));
+#endif
+}
+
+/**
+ * Count the number of leading zeros in given value.
+ *
+ * @param[in] value Value. Must not be zero.
+ *
+ * @return Number of leading zeros, 0-31.
+ */
+static inline int bits_clz_32(uint32_t value)
+{
+#if defined(BITS_HAS_BUILTINS)
+    return (__builtin_clz(value));
+#else
+    return (bits_clz_32_generic(value));
+#endif
+}
+
+/**
+ * Find the first, least significant, set bit in given value.
+ *
+ * @param[in] value Value to search in.
+ *
+ * @return Bit position 0-31, or -1 if no bit is set.
+ */
+static inline int bits_find_first_set_32(uint32_t value)
+{
+    if (value == 0) {
+        return (-1);
+    }
+
+    return (bits_ctz_32(value));
+}
+
+/**
+ * Find the last, most significant, set bit in given value.
+ *
+ * @param[in] value Value to search in.
+ *
+ * @return Bit position 0-31, or -1 if no bit is set.
+ */
+static inline int bits_find_last_set_32(uint32_t value)
+{
+    if (value == 0) {
+        return (-1);
+    }
+
+    return (31 - bits_clz_32(value));
+}
+
+/**
+ * Set given range of bits in given bitmap.
+ *
+ * @param[in,out] bitmap_p Bitmap.
+ * @param[in] first First bit to set.
+ * @param[in] count Number of bits to set.
+ */
+void bits_bitmap_set(uint32_t *bitmap_p, int first, int count);
+
+/**
+ * Clear given range of bits in given bitmap.
+ *
+ * @param[in,out] bitmap_p Bitmap.
+ * @param[in] first First bit to clear.
+ * @param[in] count Number of bits to clear.
+ */
+void bits_bitmap_clear(uint32_t *bitmap_p, int first, int count);
+
+/**
+ * Test if given bit is set in given bitmap.
+ *
+ * @param[in] bitmap_p Bitmap.
+ * @param[in] bit Bit to test.
+ *
+ * @return true(1) if the bit is set, otherwise false(0).
+ */
+static inline int bits_bitmap_test(const uint32_t *bitmap_p, int bit)
+{
+    return ((bitmap_p[bit / 32] >> (bit % 32)) & 1);
+}
+
+/**
+ * Find the first set bit at or after given bit in given bitmap. The
+ * bitmap is scanned a word at a time.
+ *
+ * @param[in] bitmap_p Bitmap.
+ * @param[in] size Size of the bitmap in bits.
+ * @param[in] start First bit to search from.
+ *
+ * @return Found bit position, or -1 if no bit is set.
+ */
+int bits_bitmap_find_first_set(const uint32_t *bitmap_p,
+                               int size,
+                               int start);
+
+/**
+ * Find the first cleared bit at or after given bit in given bitmap,
+ * for example to find a free slot.
+ *
+ * @param[in] bitmap_p Bitmap.
+ * @param[in] size Size of the bitmap in bits.
+ * @param[in] start First bit to search from.
+ *
+ * @return Found bit position, or -1 if all bits are set.
+ */
+int bits_bitmap_find_first_clear(const uint32_t *bitmap_p,
+                                 int size,
+                                 int start);
+
+/**
+ * Count the number of set bits in given bitmap.
+ *
+ * @param[in] bitmap_p Bitmap.
+ * @param[in] size Size of the bitmap in bits.
+ *
+ * @return Number of set bits.
+ */
+int bits_bitmap_count(const uint32_t *bitmap_p, int size);
+
 /**
  * Reverse the order of given 8 bits.
  *
@@ -28,6 +28,12 @@
 
 #include "simba.h"
 
+#if CONFIG_CIRCULAR_BUFFER_MIRROR == 1
+#    include <unistd.h>
+#    include <sys/mman.h>
+#    include <sys/syscall.h>
+#endif
+
 static ssize_t find(const char *buf_p, ssize_t pos, ssize_t size, char value)
 {
     while (pos < size) {
@@ -54,10 +60,92 @@ int circular_buffer_init(struct circular_buffer_t *self_p,
     self_p->size = size;
     self_p->writepos = 0;
     self_p->readpos = 0;
+#if CONFIG_CIRCULAR_BUFFER_MIRROR == 1
+    self_p->mirrored = 0;
+#endif
 
     return (0);
 }
 
+#if CONFIG_CIRCULAR_BUFFER_MIRROR == 1
+
+int circular_buffer_mirror_init(struct circular_buffer_t *self_p,
+                                size_t size)
+{
+    ASSERTN(self_p != NULL, EINVAL);
+    ASSERTN(size > 0, EINVAL);
+
+    size_t page_size;
+    char *buf_p;
+    int fd;
+    int res;
+
+    page_size = sysconf(_SC_PAGESIZE);
+    size = DIV_CEIL(size, page_size) * page_size;
+    fd = syscall(SYS_memfd_create, "circular_buffer", 0);
+
+    if (fd < 0) {
+        return (-ENOMEM);
+    }
+
+    res = -ENOMEM;
+
+    if (ftruncate(fd, size) != 0) {
+        goto out;
+    }
+
+    /* Reserve address space for both mappings. */
+    buf_p = mmap(NULL,
+                 2 * size,
+                 PROT_NONE,
+                 MAP_PRIVATE | MAP_ANONYMOUS,
+                 -1,
+                 0);
+
+    if (buf_p == MAP_FAILED) {
+        goto out;
+    }
+
+    if ((mmap(&buf_p[0],
+              size,
+              PROT_READ | PROT_WRITE,
+              MAP_SHARED | MAP_FIXED,
+              fd,
+              0) == MAP_FAILED)
+        || (mmap(&buf_p[size],
+                 size,
+                 PROT_READ | PROT_WRITE,
+                 MAP_SHARED | MAP_FIXED,
+                 fd,
+                 0) == MAP_FAILED)) {
+        munmap(buf_p, 2 * size);
+        goto out;
+    }
+
+    circular_buffer_init(self_p, buf_p, size);
+    self_p->mirrored = 1;
+    res = 0;
+
+ out:
+    close(fd);
+
+    return (res);
+}
+
+int circular_buffer_mirror_destroy(struct circular_buffer_t *self_p)
+{
+    ASSERTN(self_p != NULL, EINVAL);
+    ASSERTN(self_p->mirrored == 1, EINVAL);
+
+    munmap(self_p->buf_p, 2 * self_p->size);
+    self_p->buf_p = NULL;
+    self_p->mirrored = 0;
+
+    return (0);
+}
+
+#endif
+
 ssize_t circular_buffer_write(struct circular_buffer_t *self_p,
                               const void *buf_p,
                               size_t size)
@@ -203,6 +291,13 @@ ssize_t circular_buffer_array_one(struct circular_buffer_t *self_p,
         first_chunk_size = (self_p->size - self_p->readpos);
     }
 
+#if CONFIG_CIRCULAR_BUFFER_MIRROR == 1
+    /* All used bytes are contiguous in a mirrored buffer. */
+    if (self_p->mirrored == 1) {
+        first_chunk_size = circular_buffer_used_size(self_p);
+    }
+#endif
+
     if (size > first_chunk_size) {
         size = first_chunk_size;
     }
@@ -218,6 +313,13 @@ ssize_t circular_buffer_array_two(struct circular_buffer_t *self_p,
                                   void **buf_pp,
                                   size_t size)
 {
+#if CONFIG_CIRCULAR_BUFFER_MIRROR == 1
+    /* The first chunk is never wrapped in a mirrored buffer. */
+    if (self_p->mirrored == 1) {
+        return (0);
+    }
+#endif
+
     /* Return immediately if there is no second chunk. */
     if (self_p->writepos >= self_p->readpos) {
         return (0);
@@ -234,6 +336,62 @@ ssize_t circular_buffer_array_two(struct circular_buffer_t *self_p,
     return (size);
 }
 
+ssize_t circular_buffer_reserve(struct circular_buffer_t *self_p,
+                                void **buf_pp,
+                                size_t size)
+{
+    size_t first_chunk_size;
+
+    if (self_p->readpos > self_p->writepos) {
+        first_chunk_size = (self_p->readpos - self_p->writepos - 1);
+    } else {
+        first_chunk_size = (self_p->size - self_p->writepos);
+
+        /* One byte is always left unused to tell a full buffer from
+           an empty one. */
+        if (self_p->readpos == 0) {
+            first_chunk_size--;
+        }
+    }
+
+#if CONFIG_CIRCULAR_BUFFER_MIRROR == 1
+    /* All unused bytes are contiguous in a mirrored buffer. */
+    if (self_p->mirrored == 1) {
+        first_chunk_size = circular_buffer_unused_size(self_p);
+    }
+#endif
+
+    if (size > first_chunk_size) {
+        size = first_chunk_size;
+    }
+
+    if (size > 0) {
+        *buf_pp = &self_p->buf_p[self_p->writepos];
+    }
+
+    return (size);
+}
+
+ssize_t circular_buffer_commit(struct circular_buffer_t *self_p,
+                               size_t size)
+{
+    size_t unused_size;
+
+    unused_size = circular_buffer_unused_size(self_p);
+
+    if (size > unused_size) {
+        size = unused_size;
+    }
+
+    self_p->writepos += size;
+
+    if (self_p->writepos >= self_p->size) {
+        self_p->writepos -= self_p->size;
+    }
+
+    return (size);
+}
+
 ssize_t circular_buffer_find(struct circular_buffer_t *self_p,
                              char value)
 {
@@ -37,6 +37,9 @@ struct circular_buffer_t {
     size_t size;
     size_t writepos;
     size_t readpos;
+#if CONFIG_CIRCULAR_BUFFER_MIRROR == 1
+    int mirrored;
+#endif
 };
 
 /**
@@ -52,6 +55,36 @@ int circular_buffer_init(struct circular_buffer_t *self_p,
                          void *buf_p,
                          size_t size);
 
+#if CONFIG_CIRCULAR_BUFFER_MIRROR == 1
+
+/**
+ * Initialize given circular buffer with memory mapped twice to
+ * consecutive virtual addresses, so that the used and unused parts
+ * of the buffer are always contiguous. `circular_buffer_array_one()`
+ * and `circular_buffer_reserve()` return all used and unused bytes,
+ * and `circular_buffer_array_two()` always returns zero(0).
+ *
+ * @param[in] self_p Circular buffer to initialize.
+ * @param[in] size Minimum size of the buffer. It is rounded up to a
+ *                 multiple of the page size.
+ *
+ * @return zero(0) or negative error code.
+ */
+int circular_buffer_mirror_init(struct circular_buffer_t *self_p,
+                                size_t size);
+
+/**
+ * Unmap the memory of given mirrored circular buffer.
+ *
+ * @param[in] self_p Circular buffer initialized with
+ *                   `circular_buffer_mirror_init()`.
+ *
+ * @return zero(0) or negative error code.
+ */
+int circular_buffer_mirror_destroy(struct circular_buffer_t *self_p);
+
+#endif
+
 /**
  * Write data to given circular buffer.
  *
@@ -150,6 +183,35 @@ ssize_t circular_buffer_array_two(struct circular_buffer_t *self_p,
                                   void **buf_pp,
                                   size_t size);
 
+/**
+ * Get a pointer to the next unused byte in the buffer. Data written
+ * to the array is made available to readers by
+ * `circular_buffer_commit()`.
+ *
+ * @param[in] self_p Circular buffer.
+ * @param[out] buf_pp A pointer to the start of the array. Only valid
+ *                    if the return value is greater than zero(0).
+ * @param[in] size Number of bytes asked for.
+ *
+ * @return Number of contiguous unused bytes in array or negative
+ *         error code.
+ */
+ssize_t circular_buffer_reserve(struct circular_buffer_t *self_p,
+                                void **buf_pp,
+                                size_t size);
+
+/**
+ * Commit given number of bytes written to the array returned by
+ * `circular_buffer_reserve()`.
+ *
+ * @param[in] self_p Circular buffer.
+ * @param[in] size Number of bytes to commit.
+ *
+ * @return Number of committed bytes or negative error code.
+ */
+ssize_t circular_buffer_commit(struct circular_buffer_t *self_p,
+                               size_t size);
+
 /**
  * Find the offset of the first location of given character.
  *
@@ -0,0 +1,160 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2014-2018, Erik Moqvist
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use, copy,
+ * modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ * This file is part of the Simba project.
+ */
+
+#include "simba.h"
+
+int dlist_init(struct dlist_t *self_p)
+{
+    ASSERTN(self_p != NULL, EINVAL);
+
+    self_p->head_p = NULL;
+    self_p->tail_p = NULL;
+
+    return (0);
+}
+
+void *dlist_peek_head(struct dlist_t *self_p)
+{
+    return (self_p->head_p);
+}
+
+void *dlist_next(void *v_elem_p)
+{
+    return (((struct dlist_elem_t *)v_elem_p)->next_p);
+}
+
+int dlist_add_head(struct dlist_t *self_p,
+                   void *elem_p)
+{
+    return (dlist_insert_before(self_p, self_p->head_p, elem_p));
+}
+
+int dlist_add_tail(struct dlist_t *self_p,
+                   void *elem_p)
+{
+    return (dlist_insert_before(self_p, NULL, elem_p));
+}
+
+int dlist_insert_before(struct dlist_t *self_p,
+                        void *v_next_elem_p,
+                        void *v_elem_p)
+{
+    ASSERTN(self_p != NULL, EINVAL);
+    ASSERTN(v_elem_p != NULL, EINVAL);
+
+    struct dlist_elem_t *elem_p;
+    struct dlist_elem_t *next_p;
+
+    elem_p = v_elem_p;
+    next_p = v_next_elem_p;
+    elem_p->next_p = next_p;
+
+    if (next_p != NULL) {
+        elem_p->prev_p = next_p->prev_p;
+        next_p->prev_p = elem_p;
+    } else {
+        elem_p->prev_p = self_p->tail_p;
+        self_p->tail_p = elem_p;
+    }
+
+    if (elem_p->prev_p != NULL) {
+        elem_p->prev_p->next_p = elem_p;
+    } else {
+        self_p->head_p = elem_p;
+    }
+
+    return (0);
+}
+
+void *dlist_remove(struct dlist_t *self_p,
+                   void *v_elem_p)
+{
+    ASSERTNRN(self_p != NULL, EINVAL);
+    ASSERTNRN(v_elem_p != NULL, EINVAL);
+
+    struct dlist_elem_t *elem_p;
+
+    elem_p = v_elem_p;
+
+    /* Only the head has no previous element. */
+    if (elem_p->prev_p != NULL) {
+        elem_p->prev_p->next_p = elem_p->next_p;
+    } else if (self_p->head_p == elem_p) {
+        self_p->head_p = elem_p->next_p;
+    } else {
+        return (NULL);
+    }
+
+    if (elem_p->next_p != NULL) {
+        elem_p->next_p->prev_p = elem_p->prev_p;
+    } else {
+        self_p->tail_p = elem_p->prev_p;
+    }
+
+    elem_p->next_p = NULL;
+    elem_p->prev_p = NULL;
+
+    return (elem_p);
+}
+
+void *dlist_remove_head(struct dlist_t *self_p)
+{
+    ASSERTNRN(self_p != NULL, EINVAL);
+
+    if (self_p->head_p == NULL) {
+        return (NULL);
+    }
+
+    return (dlist_remove(self_p, self_p->head_p));
+}
+
+int dlist_iter_init(struct dlist_iter_t *self_p,
+                    struct dlist_t *list_p)
+{
+    ASSERTN(self_p != NULL, EINVAL);
+    ASSERTN(list_p != NULL, EINVAL);
+
+    self_p->next_p = list_p->head_p;
+
+    return (0);
+}
+
+void *dlist_iter_next(struct dlist_iter_t *self_p)
+{
+    ASSERTNRN(self_p != NULL, EINVAL);
+
+    struct dlist_elem_t *elem_p;
+
+    elem_p = self_p->next_p;
+
+    if (elem_p != NULL) {
+        self_p->next_p = elem_p->next_p;
+    }
+
+    return (elem_p);
+}
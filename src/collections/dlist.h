@@ -0,0 +1,171 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2014-2018, Erik Moqvist
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use, copy,
+ * modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ * This file is part of the Simba project.
+ */
+
+#ifndef __COLLECTIONS_DLIST_H__
+#define __COLLECTIONS_DLIST_H__
+
+#include "simba.h"
+
+/**
+ * Doubly linked list elements must have this struct as their first
+ * member.
+ */
+struct dlist_elem_t {
+    struct dlist_elem_t *next_p;
+    struct dlist_elem_t *prev_p;
+};
+
+/**
+ * An intrusive doubly linked list.
+ */
+struct dlist_t {
+    struct dlist_elem_t *head_p;
+    struct dlist_elem_t *tail_p;
+};
+
+/**
+ * A doubly linked list iterator.
+ */
+struct dlist_iter_t {
+    struct dlist_elem_t *next_p;
+};
+
+/**
+ * Initialize given doubly linked list object.
+ *
+ * Elements in the list must have a `struct dlist_elem_t` as their
+ * first struct member.
+ *
+ * An element can only be part of one list at a time.
+ *
+ * @param[in] self_p List object to initialize.
+ *
+ * @return zero(0) or negative error code.
+ */
+int dlist_init(struct dlist_t *self_p);
+
+/**
+ * Peek at the first element in the list.
+ *
+ * @param[in] self_p List object.
+ *
+ * @return First element of the list, or NULL if the list is empty.
+ */
+void *dlist_peek_head(struct dlist_t *self_p);
+
+/**
+ * Get the element after given element.
+ *
+ * @param[in] elem_p Element in a list.
+ *
+ * @return Next element, or NULL if given element is the last
+ *         element.
+ */
+void *dlist_next(void *elem_p);
+
+/**
+ * Add given element to the beginning of given list.
+ *
+ * @param[in] self_p List object.
+ * @param[in] elem_p Element to add.
+ *
+ * @return zero(0) or negative error code.
+ */
+int dlist_add_head(struct dlist_t *self_p,
+                   void *elem_p);
+
+/**
+ * Add given element to the end of given list.
+ *
+ * @param[in] self_p List object.
+ * @param[in] elem_p Element to add.
+ *
+ * @return zero(0) or negative error code.
+ */
+int dlist_add_tail(struct dlist_t *self_p,
+                   void *elem_p);
+
+/**
+ * Insert given element before another element in given list.
+ *
+ * @param[in] self_p List object.
+ * @param[in] next_elem_p Element to insert before, or NULL to add
+ *                        the element to the end of the list.
+ * @param[in] elem_p Element to insert.
+ *
+ * @return zero(0) or negative error code.
+ */
+int dlist_insert_before(struct dlist_t *self_p,
+                        void *next_elem_p,
+                        void *elem_p);
+
+/**
+ * Remove given element from given list in constant time. The element
+ * must be in given list, or not in any list.
+ *
+ * @param[in] self_p List object.
+ * @param[in] elem_p Element to remove.
+ *
+ * @return Removed element, or NULL if the element was not in the
+ *         list.
+ */
+void *dlist_remove(struct dlist_t *self_p,
+                   void *elem_p);
+
+/**
+ * Get the first element of given list and then remove it from given
+ * list.
+ *
+ * @param[in] self_p List object.
+ *
+ * @return Removed element, or NULL if the list was empty.
+ */
+void *dlist_remove_head(struct dlist_t *self_p);
+
+/**
+ * Initialize given iterator object.
+ *
+ * @param[in] self_p Iterator to initialize.
+ * @param[in] list_p List object to iterate over.
+ *
+ * @return zero(0) or negative error code.
+ */
+int dlist_iter_init(struct dlist_iter_t *self_p,
+                    struct dlist_t *list_p);
+
+/**
+ * Get the next element from given iterator object. The returned
+ * element may be removed from the list before the next call.
+ *
+ * @param[in] self_p Iterator object.
+ *
+ * @return Next element, or NULL on end of list.
+ */
+void *dlist_iter_next(struct dlist_iter_t *self_p);
+
+#endif
@@ -205,3 +205,411 @@ int hash_map_get(struct hash_map_t *self_p,
 
     return (-ENODATA);
 }
+
+/* Number of entries moved from the old table per add and remove
+   call during a resize. */
+#define OPEN_MOVE_COUNT                                     4
+
+#define FNV_OFFSET_BASIS                           0x811c9dc5
+#define FNV_PRIME                                  0x01000193
+
+static uint32_t open_hash(struct hash_map_open_t *self_p,
+                          const void *key_p)
+{
+    uint32_t hash;
+
+    hash = self_p->hash(key_p);
+
+    /* Zero marks an empty entry. */
+    if (hash == 0) {
+        hash = 1;
+    }
+
+    return (hash);
+}
+
+static void open_table_init(struct hash_map_open_table_t *table_p,
+                            struct hash_map_open_entry_t *entries_p,
+                            size_t length)
+{
+    size_t i;
+
+    table_p->entries_p = entries_p;
+    table_p->mask = (length - 1);
+    table_p->length = 0;
+
+    for (i = 0; i < length; i++) {
+        entries_p[i].hash = 0;
+    }
+}
+
+/**
+ * Distance from the entry's ideal index to given index.
+ */
+static size_t open_table_distance(struct hash_map_open_table_t *table_p,
+                                  uint32_t hash,
+                                  size_t index)
+{
+    return ((index - hash) & table_p->mask);
+}
+
+/**
+ * Returns the index of given key, or -1 if missing.
+ */
+static ssize_t open_table_find(struct hash_map_open_t *self_p,
+                               struct hash_map_open_table_t *table_p,
+                               uint32_t hash,
+                               const void *key_p)
+{
+    struct hash_map_open_entry_t *entry_p;
+    size_t index;
+    size_t distance;
+
+    if (table_p->length == 0) {
+        return (-1);
+    }
+
+    index = (hash & table_p->mask);
+    distance = 0;
+
+    while (1) {
+        entry_p = &table_p->entries_p[index];
+
+        /* An entry closer to its ideal index than the searched key
+           would be ends the search. */
+        if ((entry_p->hash == 0)
+            || (open_table_distance(table_p, entry_p->hash, index) < distance)) {
+            return (-1);
+        }
+
+        if ((entry_p->hash == hash) && self_p->equal(entry_p->key_p, key_p)) {
+            return (index);
+        }
+
+        index = ((index + 1) & table_p->mask);
+        distance++;
+    }
+}
+
+/**
+ * Insert given key, known not to be in the table. The table must
+ * have at least one empty entry.
+ */
+static void open_table_insert(struct hash_map_open_table_t *table_p,
+                              uint32_t hash,
+                              const void *key_p,
+                              void *value_p)
+{
+    struct hash_map_open_entry_t *entry_p;
+    struct hash_map_open_entry_t entry;
+    struct hash_map_open_entry_t tmp;
+    size_t index;
+    size_t distance;
+    size_t entry_distance;
+
+    entry.hash = hash;
+    entry.key_p = key_p;
+    entry.value_p = value_p;
+    index = (hash & table_p->mask);
+    distance = 0;
+
+    while (1) {
+        entry_p = &table_p->entries_p[index];
+
+        if (entry_p->hash == 0) {
+            *entry_p = entry;
+            table_p->length++;
+
+            return;
+        }
+
+        /* Take the place of entries closer to their ideal index. */
+        entry_distance = open_table_distance(table_p, entry_p->hash, index);
+
+        if (entry_distance < distance) {
+            tmp = *entry_p;
+            *entry_p = entry;
+            entry = tmp;
+            distance = entry_distance;
+        }
+
+        index = ((index + 1) & table_p->mask);
+        distance++;
+    }
+}
+
+/**
+ * Remove the entry at given index and shift following entries back
+ * towards their ideal index.
+ */
+static void open_table_remove(struct hash_map_open_table_t *table_p,
+                              size_t index)
+{
+    struct hash_map_open_entry_t *entry_p;
+    size_t next;
+
+    while (1) {
+        next = ((index + 1) & table_p->mask);
+        entry_p = &table_p->entries_p[next];
+
+        if ((entry_p->hash == 0)
+            || (open_table_distance(table_p, entry_p->hash, next) == 0)) {
+            break;
+        }
+
+        table_p->entries_p[index] = *entry_p;
+        index = next;
+    }
+
+    table_p->entries_p[index].hash = 0;
+    table_p->length--;
+}
+
+/**
+ * Move a few entries from the old table to the current one, and free
+ * the old table when empty.
+ */
+static void open_move(struct hash_map_open_t *self_p)
+{
+    struct hash_map_open_table_t *old_p;
+    struct hash_map_open_entry_t *entry_p;
+    int count;
+
+    old_p = &self_p->old.table;
+
+    if (old_p->entries_p == NULL) {
+        return;
+    }
+
+    count = OPEN_MOVE_COUNT;
+
+    while ((count > 0) && (old_p->length > 0)) {
+        entry_p = &old_p->entries_p[self_p->old.index];
+
+        if (entry_p->hash == 0) {
+            self_p->old.index = ((self_p->old.index + 1) & old_p->mask);
+            continue;
+        }
+
+        open_table_insert(&self_p->table,
+                          entry_p->hash,
+                          entry_p->key_p,
+                          entry_p->value_p);
+        open_table_remove(old_p, self_p->old.index);
+        count--;
+    }
+
+    if (old_p->length == 0) {
+        if (old_p->entries_p != self_p->entries_p) {
+            heap_free(self_p->heap_p, old_p->entries_p);
+        }
+
+        old_p->entries_p = NULL;
+    }
+}
+
+/**
+ * Start a resize if the table is more than 7/8 full after adding an
+ * entry. No resize is started
+ * while the previous one is in progress.
+ */
+static void open_grow(struct hash_map_open_t *self_p)
+{
+    struct hash_map_open_entry_t *entries_p;
+    size_t length;
+
+    if ((self_p->heap_p == NULL) || (self_p->old.table.entries_p != NULL)) {
+        return;
+    }
+
+    length = (self_p->table.mask + 1);
+
+    if ((8 * (self_p->table.length + 1)) <= (7 * length)) {
+        return;
+    }
+
+    entries_p = heap_alloc(self_p->heap_p, 2 * length * sizeof(*entries_p));
+
+    if (entries_p == NULL) {
+        return;
+    }
+
+    self_p->old.table = self_p->table;
+    self_p->old.index = 0;
+    open_table_init(&self_p->table, entries_p, 2 * length);
+}
+
+int hash_map_open_init(struct hash_map_open_t *self_p,
+                       struct hash_map_open_entry_t *entries_p,
+                       size_t length,
+                       hash_map_open_hash_t hash,
+                       hash_map_open_equal_t equal,
+                       struct heap_t *heap_p)
+{
+    ASSERTN(self_p != NULL, EINVAL);
+    ASSERTN(entries_p != NULL, EINVAL);
+    ASSERTN((length > 0) && ((length & (length - 1)) == 0), EINVAL);
+    ASSERTN(hash != NULL, EINVAL);
+    ASSERTN(equal != NULL, EINVAL);
+
+    open_table_init(&self_p->table, entries_p, length);
+    self_p->old.table.entries_p = NULL;
+    self_p->old.table.length = 0;
+    self_p->entries_p = entries_p;
+    self_p->length = length;
+    self_p->hash = hash;
+    self_p->equal = equal;
+    self_p->heap_p = heap_p;
+
+    return (0);
+}
+
+int hash_map_open_add(struct hash_map_open_t *self_p,
+                      const void *key_p,
+                      void *value_p)
+{
+    ASSERTN(self_p != NULL, EINVAL);
+
+    uint32_t hash;
+    ssize_t index;
+
+    hash = open_hash(self_p, key_p);
+
+    /* Is the key already in map? */
+    index = open_table_find(self_p, &self_p->table, hash, key_p);
+
+    if (index >= 0) {
+        self_p->table.entries_p[index].value_p = value_p;
+
+        return (0);
+    }
+
+    index = open_table_find(self_p, &self_p->old.table, hash, key_p);
+
+    if (index >= 0) {
+        self_p->old.table.entries_p[index].value_p = value_p;
+
+        return (0);
+    }
+
+    open_move(self_p);
+    open_grow(self_p);
+
+    /* Keep one entry empty to terminate searches. */
+    if (self_p->table.length == self_p->table.mask) {
+        return (-ENOMEM);
+    }
+
+    open_table_insert(&self_p->table, hash, key_p, value_p);
+
+    return (0);
+}
+
+int hash_map_open_remove(struct hash_map_open_t *self_p,
+                         const void *key_p)
+{
+    ASSERTN(self_p != NULL, EINVAL);
+
+    uint32_t hash;
+    ssize_t index;
+    int res;
+
+    hash = open_hash(self_p, key_p);
+    res = 0;
+    index = open_table_find(self_p, &self_p->table, hash, key_p);
+
+    if (index >= 0) {
+        open_table_remove(&self_p->table, index);
+    } else {
+        index = open_table_find(self_p, &self_p->old.table, hash, key_p);
+
+        if (index >= 0) {
+            open_table_remove(&self_p->old.table, index);
+        } else {
+            res = -ENODATA;
+        }
+    }
+
+    open_move(self_p);
+
+    return (res);
+}
+
+int hash_map_open_get(struct hash_map_open_t *self_p,
+                      const void *key_p,
+                      void **value_pp)
+{
+    ASSERTN(self_p != NULL, EINVAL);
+    ASSERTN(value_pp != NULL, EINVAL);
+
+    uint32_t hash;
+    ssize_t index;
+
+    hash = open_hash(self_p, key_p);
+    index = open_table_find(self_p, &self_p->table, hash, key_p);
+
+    if (index >= 0) {
+        *value_pp = self_p->table.entries_p[index].value_p;
+
+        return (0);
+    }
+
+    index = open_table_find(self_p, &self_p->old.table, hash, key_p);
+
+    if (index >= 0) {
+        *value_pp = self_p->old.table.entries_p[index].value_p;
+
+        return (0);
+    }
+
+    return (-ENODATA);
+}
+
+size_t hash_map_open_length(struct hash_map_open_t *self_p)
+{
+    ASSERTN(self_p != NULL, EINVAL);
+
+    return (self_p->table.length + self_p->old.table.length);
+}
+
+int hash_map_open_destroy(struct hash_map_open_t *self_p)
+{
+    ASSERTN(self_p != NULL, EINVAL);
+
+    if (self_p->table.entries_p != self_p->entries_p) {
+        heap_free(self_p->heap_p, self_p->table.entries_p);
+    }
+
+    if ((self_p->old.table.entries_p != NULL)
+        && (self_p->old.table.entries_p != self_p->entries_p)) {
+        heap_free(self_p->heap_p, self_p->old.table.entries_p);
+    }
+
+    open_table_init(&self_p->table, self_p->entries_p, self_p->length);
+    self_p->old.table.entries_p = NULL;
+    self_p->old.table.length = 0;
+
+    return (0);
+}
+
+uint32_t hash_map_open_hash_string(const void *key_p)
+{
+    const uint8_t *c_p;
+    uint32_t hash;
+
+    c_p = key_p;
+    hash = FNV_OFFSET_BASIS;
+
+    while (*c_p != '\0') {
+        hash ^= *c_p++;
+        hash *= FNV_PRIME;
+    }
+
+    return (hash);
+}
+
+int hash_map_open_equal_string(const void *key1_p,
+                               const void *key2_p)
+{
+    return (strcmp(key1_p, key2_p) == 0);
+}
@@ -109,4 +109,155 @@ int hash_map_get(struct hash_map_t *self_p,
                  longptr_t key,
                  longptr_t *value_p);
 
+/**
+ * Hash function of an open addressing hash map. The returned value
+ * may be any 32 bits value.
+ */
+typedef uint32_t (*hash_map_open_hash_t)(const void *key_p);
+
+/**
+ * Key equality function of an open addressing hash map.
+ *
+ * @return true(1) if given keys are equal, otherwise false(0).
+ */
+typedef int (*hash_map_open_equal_t)(const void *key1_p,
+                                     const void *key2_p);
+
+struct hash_map_open_entry_t {
+    uint32_t hash;
+    const void *key_p;
+    void *value_p;
+};
+
+struct hash_map_open_table_t {
+    struct hash_map_open_entry_t *entries_p;
+    size_t mask;
+    size_t length;
+};
+
+struct hash_map_open_t {
+    struct hash_map_open_table_t table;
+    struct {
+        struct hash_map_open_table_t table;
+        size_t index;
+    } old;
+    struct hash_map_open_entry_t *entries_p;
+    size_t length;
+    hash_map_open_hash_t hash;
+    hash_map_open_equal_t equal;
+    struct heap_t *heap_p;
+};
+
+/**
+ * Initialize an open addressing hash map with given parameters. The
+ * map uses Robin Hood hashing on a table with a power of two number
+ * of entries.
+ *
+ * If a heap is given the map grows when it is 7/8 full. The new
+ * table, twice the size of the old one, is allocated from the heap
+ * and the old entries are moved to it a few at a time by following
+ * add and remove calls, so no single call moves all entries.
+ *
+ * Keys and values are not copied, they must be valid as long as they
+ * are in the map.
+ *
+ * @param[in,out] self_p Initialized hash map.
+ * @param[in] entries_p Array of entries.
+ * @param[in] length Number of entries in `entries_p`. Must be a
+ *                   power of two.
+ * @param[in] hash Hash function, for example
+ *                 `hash_map_open_hash_string()`.
+ * @param[in] equal Key equality function, for example
+ *                  `hash_map_open_equal_string()`.
+ * @param[in] heap_p Heap to allocate larger tables from, or NULL for
+ *                   a fixed size map.
+ *
+ * @return zero(0) or negative error code.
+ */
+int hash_map_open_init(struct hash_map_open_t *self_p,
+                       struct hash_map_open_entry_t *entries_p,
+                       size_t length,
+                       hash_map_open_hash_t hash,
+                       hash_map_open_equal_t equal,
+                       struct heap_t *heap_p);
+
+/**
+ * Add given key-value pair into the hash map. Overwrites old value
+ * if the key is already present in map.
+ *
+ * @param[in] self_p Initialized hash map.
+ * @param[in] key_p Key to add.
+ * @param[in] value_p Value to insert for key.
+ *
+ * @return zero(0) or negative error code.
+ */
+int hash_map_open_add(struct hash_map_open_t *self_p,
+                      const void *key_p,
+                      void *value_p);
+
+/**
+ * Remove given key from the hash map.
+ *
+ * @param[in] self_p Initialized hash map.
+ * @param[in] key_p Key to remove.
+ *
+ * @return zero(0) or negative error code.
+ */
+int hash_map_open_remove(struct hash_map_open_t *self_p,
+                         const void *key_p);
+
+/**
+ * Get value for given key.
+ *
+ * @param[in] self_p Initialized hash map.
+ * @param[in] key_p Key to find.
+ * @param[out] value_pp Value found for given key. Unmodified if the
+ *                      key was not found.
+ *
+ * @return zero(0) if the key was found, otherwise negative error
+ *         code.
+ */
+int hash_map_open_get(struct hash_map_open_t *self_p,
+                      const void *key_p,
+                      void **value_pp);
+
+/**
+ * Get the number of keys in the hash map.
+ *
+ * @param[in] self_p Initialized hash map.
+ *
+ * @return Number of keys.
+ */
+size_t hash_map_open_length(struct hash_map_open_t *self_p);
+
+/**
+ * Release heap memory allocated by given hash map. The map is empty
+ * and has its initial table after this call.
+ *
+ * @param[in] self_p Initialized hash map.
+ *
+ * @return zero(0) or negative error code.
+ */
+int hash_map_open_destroy(struct hash_map_open_t *self_p);
+
+/**
+ * FNV-1a hash of given null terminated string.
+ *
+ * @param[in] key_p String to hash.
+ *
+ * @return Hash.
+ */
+uint32_t hash_map_open_hash_string(const void *key_p);
+
+/**
+ * Compare given null terminated strings.
+ *
+ * @param[in] key1_p First string.
+ * @param[in] key2_p Second string.
+ *
+ * @return true(1) if the strings are equal, otherwise false(0).
+ */
+int hash_map_open_equal_string(const void *key1_p,
+                               const void *key2_p);
+
 #endif
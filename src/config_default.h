@@ -41,6 +41,7 @@
 #define PORT_HAS_HD44780
 #define PORT_HAS_ICSP_SOFT
 #define PORT_HAS_JTAG_SOFT
+#define PORT_HAS_SENSOR
 
 /**
  * Used to include driver header files and the c-file source.
@@ -49,6 +50,7 @@
 #    define PORT_HAS_ADC
 #    define PORT_HAS_CAN
 #    define PORT_HAS_DAC
+#    define PORT_HAS_DMA
 #    define PORT_HAS_EEPROM_SOFT
 #    define PORT_HAS_EXTI
 #    define PORT_HAS_FLASH
@@ -59,6 +61,7 @@
 #    define PORT_HAS_SD
 #    define PORT_HAS_SPI
 #    define PORT_HAS_DHT
+#    define PORT_HAS_POWER
 #endif
 
 #if defined(FAMILY_AVR)
@@ -83,6 +86,7 @@
 #    endif
 #    define PORT_HAS_WATCHDOG
 #    define PORT_HAS_DHT
+#    define PORT_HAS_POWER
 #endif
 
 #if defined(FAMILY_SAM)
@@ -90,6 +94,7 @@
 #    define PORT_HAS_CAN
 #    define PORT_HAS_CHIPID
 #    define PORT_HAS_DAC
+#    define PORT_HAS_DMA
 #    define PORT_HAS_EEPROM_SOFT
 #    define PORT_HAS_EXTI
 #    define PORT_HAS_FLASH
@@ -97,6 +102,7 @@
 #    define PORT_HAS_MCP2515
 #    define PORT_HAS_RANDOM
 #    define PORT_HAS_SD
+#    define PORT_HAS_SD_HOST
 #    define PORT_HAS_SPI
 #    define PORT_HAS_USB
 #    define PORT_HAS_USB_HOST
@@ -135,6 +141,7 @@
 #endif
 
 #if defined(FAMILY_STM32F1)
+#    define PORT_HAS_DMA
 #    define PORT_HAS_EEPROM_SOFT
 #    define PORT_HAS_FLASH
 #endif
@@ -159,6 +166,8 @@
 #if defined(FAMILY_NRF5)
 #    define PORT_HAS_EEPROM_SOFT
 #    define PORT_HAS_FLASH
+#    define PORT_HAS_I2C
+#    define PORT_HAS_SPI
 #endif
 
 #if defined(FAMILY_XVISOR_VIRT)
@@ -222,6 +231,18 @@
 #    endif
 #endif
 
+/**
+ * ESP32 core Simba runs on, zero(0) for the PRO core or one(1) for
+ * the APP core. All Simba threads and interrupts run on this
+ * core. The ESP-IDF Wi-Fi, lwIP and event loop tasks are pinned to
+ * the PRO core by the ESP-IDF configuration, so one(1) keeps network
+ * processing from stealing cycles from Simba threads. One(1)
+ * requires an ESP-IDF built without ``CONFIG_FREERTOS_UNICORE``.
+ */
+#ifndef CONFIG_SYS_SIMBA_MAIN_CORE
+#    define CONFIG_SYS_SIMBA_MAIN_CORE                      0
+#endif
+
 /**
  * Kick the watchdog in `sys_panic()` before writing to the console.
  */
@@ -317,6 +338,27 @@
 #    define CONFIG_LINUX_SOCKET_DEVICE                      0
 #endif
 
+/**
+ * Path of the Unix domain socket the Linux socket devices listens on,
+ * in addition to TCP port 47000. Clients on the same host can use it
+ * for higher throughput than TCP.
+ */
+#ifndef CONFIG_LINUX_SOCKET_DEVICE_UNIX_PATH
+#    define CONFIG_LINUX_SOCKET_DEVICE_UNIX_PATH            "/tmp/simba-socket-device"
+#endif
+
+/**
+ * Run the Linux port in virtual time. When all threads are waiting
+ * for a timer the system time jumps forward to the expiry of the
+ * next timer instead of waiting for it, so timeouts and sleeps take
+ * almost no wall clock time. Time runs at normal speed while any
+ * thread is running or no timer is active. Requires
+ * ``CONFIG_SYSTEM_TICKLESS``.
+ */
+#ifndef CONFIG_LINUX_VIRTUAL_TIME
+#    define CONFIG_LINUX_VIRTUAL_TIME                       0
+#endif
+
 /**
  * Enable the adc driver.
  */
@@ -328,6 +370,13 @@
 #    endif
 #endif
 
+/**
+ * Maximum number of interleaved channels in an ADC stream.
+ */
+#ifndef CONFIG_ADC_STREAM_CHANNELS_MAX
+#    define CONFIG_ADC_STREAM_CHANNELS_MAX                  8
+#endif
+
 /**
  * Enable the analog_input_pin driver.
  */
@@ -401,6 +450,14 @@
 #    endif
 #endif
 
+/**
+ * Number of bytes read from the ChaCha20 based random number
+ * generator before it is reseeded from the hardware.
+ */
+#ifndef CONFIG_RANDOM_CRYPTO_RESEED_SIZE
+#    define CONFIG_RANDOM_CRYPTO_RESEED_SIZE             4096
+#endif
+
 /**
  * Enable the ws2812 driver.
  */
@@ -445,6 +502,17 @@
 #    endif
 #endif
 
+/**
+ * Enable the dma driver.
+ */
+#ifndef CONFIG_DMA
+#    if defined(CONFIG_MINIMAL_SYSTEM) || !defined(PORT_HAS_DMA)
+#        define CONFIG_DMA                                  0
+#    else
+#        define CONFIG_DMA                                  1
+#    endif
+#endif
+
 /**
  * Enable the ds18b20 driver.
  */
@@ -467,6 +535,17 @@
 #    endif
 #endif
 
+/**
+ * Enable the eeprom_journal driver.
+ */
+#ifndef CONFIG_EEPROM_JOURNAL
+#    if defined(CONFIG_MINIMAL_SYSTEM) || !defined(PORT_HAS_EEPROM_SOFT)
+#        define CONFIG_EEPROM_JOURNAL                       0
+#    else
+#        define CONFIG_EEPROM_JOURNAL                       1
+#    endif
+#endif
+
 /**
  * Enable the eeprom_soft driver.
  */
@@ -513,6 +592,15 @@
 #    endif
 #endif
 
+/**
+ * Enable timestamped edge capture in the exti driver. Edges are
+ * timestamped with the cycle counter of the CPU in the interrupt
+ * handler, the same counter as used by ``CONFIG_THRD_CYCLES``.
+ */
+#ifndef CONFIG_EXTI_CAPTURE
+#    define CONFIG_EXTI_CAPTURE                             0
+#endif
+
 /**
  * Enable the pin change interrupt driver.
  */
@@ -598,6 +686,23 @@
 #    define CONFIG_EEPROM_I2C_NUMBER_OF_ATTEMPTS          100
 #endif
 
+/**
+ * Largest page size in bytes that can be given to
+ * `eeprom_i2c_set_page_size()`. A buffer of this size, plus the
+ * address, is allocated on the stack during page writes.
+ */
+#ifndef CONFIG_EEPROM_I2C_PAGE_SIZE_MAX
+#    define CONFIG_EEPROM_I2C_PAGE_SIZE_MAX                64
+#endif
+
+/**
+ * Maximum nesting depth of objects and arrays in documents parsed by
+ * the streaming JSON parser, `json_stream_input()`.
+ */
+#ifndef CONFIG_JSON_STREAM_DEPTH_MAX
+#    define CONFIG_JSON_STREAM_DEPTH_MAX                    8
+#endif
+
 /**
  * Enable the mcp2515 driver.
  */
@@ -609,6 +714,50 @@
 #    endif
 #endif
 
+/**
+ * SPI bus speed of the mcp2515 driver. The controller supports up to
+ * 10 MHz, and a fast bus is needed to keep up with a loaded 1 Mbps
+ * CAN bus.
+ */
+#ifndef CONFIG_MCP2515_SPI_SPEED
+#    define CONFIG_MCP2515_SPI_SPEED                   SPI_SPEED_8MBPS
+#endif
+
+/**
+ * Enable the EMAC Ethernet network interface. Only implemented for
+ * the SAM3X family, which requires an external RMII PHY. Disabled by
+ * default as the descriptor rings and receive buffers are statically
+ * allocated.
+ */
+#ifndef CONFIG_NETWORK_INTERFACE_EMAC
+#    define CONFIG_NETWORK_INTERFACE_EMAC                   0
+#endif
+
+/**
+ * Number of EMAC receive descriptors, each with a 128 bytes buffer.
+ */
+#ifndef CONFIG_NETWORK_INTERFACE_EMAC_RX_DESCRIPTORS
+#    define CONFIG_NETWORK_INTERFACE_EMAC_RX_DESCRIPTORS    16
+#endif
+
+/**
+ * Number of 128 bytes EMAC receive buffers. Received buffers are
+ * handed to the IP stack without copying, and the buffers not in the
+ * receive descriptors replace them until the IP stack has processed
+ * them. Must be greater than the number of receive descriptors.
+ */
+#ifndef CONFIG_NETWORK_INTERFACE_EMAC_RX_BUFFERS
+#    define CONFIG_NETWORK_INTERFACE_EMAC_RX_BUFFERS        32
+#endif
+
+/**
+ * Number of EMAC transmit descriptors, one per pbuf in the
+ * transmitted frames.
+ */
+#ifndef CONFIG_NETWORK_INTERFACE_EMAC_TX_DESCRIPTORS
+#    define CONFIG_NETWORK_INTERFACE_EMAC_TX_DESCRIPTORS    16
+#endif
+
 /**
  * Enable the nrf24l01 driver.
  */
@@ -697,6 +846,14 @@
 #    endif
 #endif
 
+/**
+ * Maximum number of simultaneously started software PWM:s with a
+ * duty cycle other than 0% and 100%.
+ */
+#ifndef CONFIG_PWM_SOFT_CHANNELS_MAX
+#    define CONFIG_PWM_SOFT_CHANNELS_MAX                    8
+#endif
+
 /**
  * Enable the sd driver.
  */
@@ -719,6 +876,16 @@
 #    endif
 #endif
 
+/**
+ * Transfers of at least this many bytes are performed with DMA on
+ * ports with a DMA controller, if the dma driver is
+ * enabled. Interrupt driven byte transfers have less overhead for
+ * short transfers.
+ */
+#ifndef CONFIG_SPI_DMA_SIZE_MIN
+#    define CONFIG_SPI_DMA_SIZE_MIN                         16
+#endif
+
 /**
  * Enable the uart driver.
  */
@@ -737,6 +904,29 @@
 #    endif
 #endif
 
+/**
+ * Receive and transmit with DMA in the uart driver. Received data is
+ * written to a circular buffer by the DMA controller and handed to
+ * the reader on idle line, and when the buffer wraps. Only
+ * implemented for the STM32F1 family.
+ */
+#ifndef CONFIG_UART_DMA
+#    if (CONFIG_DMA == 1) && defined(FAMILY_STM32F1)
+#        define CONFIG_UART_DMA                             1
+#    else
+#        define CONFIG_UART_DMA                             0
+#    endif
+#endif
+
+/**
+ * Size of the circular DMA receive buffer of each uart device, in
+ * bytes. It must hold at least the data received during one idle
+ * line interrupt latency.
+ */
+#ifndef CONFIG_UART_DMA_RX_BUFFER_SIZE
+#    define CONFIG_UART_DMA_RX_BUFFER_SIZE                  128
+#endif
+
 /**
  * Enable the uart_soft driver.
  */
@@ -866,6 +1056,22 @@
 #    define CONFIG_XBEE_CLIENT_RESPONSE_TIMEOUT_MS       1000
 #endif
 
+/**
+ * Maximum number of xbee_client frames waiting for a response at the
+ * same time.
+ */
+#ifndef CONFIG_XBEE_CLIENT_PENDING_MAX
+#    define CONFIG_XBEE_CLIENT_PENDING_MAX                 4
+#endif
+
+/**
+ * Size of the xbee_client thread buffer that input bytes are read
+ * into, and decoded from, in bulk.
+ */
+#ifndef CONFIG_XBEE_CLIENT_INPUT_BUFFER_SIZE
+#    define CONFIG_XBEE_CLIENT_INPUT_BUFFER_SIZE          32
+#endif
+
 /**
  * Enable the hx711 driver.
  */
@@ -877,6 +1083,25 @@
 #    endif
 #endif
 
+/**
+ * Enable continuous sampling of one or more HX711 in the hx711
+ * driver, with samples clocked out in an interrupt handler.
+ */
+#ifndef CONFIG_HX711_SAMPLER
+#    define CONFIG_HX711_SAMPLER                            0
+#endif
+
+/**
+ * Enable the sensor sampling scheduler.
+ */
+#ifndef CONFIG_SENSOR
+#    if defined(CONFIG_MINIMAL_SYSTEM) || !defined(PORT_HAS_SENSOR)
+#        define CONFIG_SENSOR                               0
+#    else
+#        define CONFIG_SENSOR                               1
+#    endif
+#endif
+
 /**
  * Enable the gnss driver.
  */
@@ -1099,6 +1324,17 @@
 #    endif
 #endif
 
+/**
+ * Initialize the dma driver module at system startup.
+ */
+#ifndef CONFIG_MODULE_INIT_DMA
+#    if CONFIG_DMA == 1
+#        define CONFIG_MODULE_INIT_DMA                      1
+#    else
+#        define CONFIG_MODULE_INIT_DMA                      0
+#    endif
+#endif
+
 /**
  * Initialize the ds18b20 driver module at system startup.
  */
@@ -1510,6 +1746,63 @@
 #    endif
 #endif
 
+/**
+ * Debug file system commands to dump and reset the scheduler trace
+ * buffer.
+ */
+#ifndef CONFIG_TRACE_FS_COMMANDS
+#    if defined(CONFIG_MINIMAL_SYSTEM)
+#        define CONFIG_TRACE_FS_COMMANDS                    0
+#    else
+#        define CONFIG_TRACE_FS_COMMANDS                    1
+#    endif
+#endif
+
+/**
+ * Debug file system commands to start, stop, dump and reset the
+ * sampling profiler.
+ */
+#ifndef CONFIG_PROFILER_FS_COMMANDS
+#    if defined(CONFIG_MINIMAL_SYSTEM)
+#        define CONFIG_PROFILER_FS_COMMANDS                 0
+#    else
+#        define CONFIG_PROFILER_FS_COMMANDS                 1
+#    endif
+#endif
+
+/**
+ * Debug file system commands to list and reset interrupt statistics.
+ */
+#ifndef CONFIG_ISR_STATS_FS_COMMANDS
+#    if defined(CONFIG_MINIMAL_SYSTEM)
+#        define CONFIG_ISR_STATS_FS_COMMANDS                0
+#    else
+#        define CONFIG_ISR_STATS_FS_COMMANDS                1
+#    endif
+#endif
+
+/**
+ * Debug file system command to list lock statistics.
+ */
+#ifndef CONFIG_LOCK_STATS_FS_COMMANDS
+#    if defined(CONFIG_MINIMAL_SYSTEM)
+#        define CONFIG_LOCK_STATS_FS_COMMANDS               0
+#    else
+#        define CONFIG_LOCK_STATS_FS_COMMANDS               1
+#    endif
+#endif
+
+/**
+ * Debug file system commands and counters of heap statistics.
+ */
+#ifndef CONFIG_HEAP_STATS_FS_COMMANDS
+#    if defined(CONFIG_MINIMAL_SYSTEM)
+#        define CONFIG_HEAP_STATS_FS_COMMANDS               0
+#    else
+#        define CONFIG_HEAP_STATS_FS_COMMANDS               1
+#    endif
+#endif
+
 /**
  * Debug file system command to list all network interfaces.
  */
@@ -1532,6 +1825,60 @@
 #    endif
 #endif
 
+/**
+ * Debug file system command to probe a host with a series of echo
+ * requests and print the latency statistics.
+ */
+#ifndef CONFIG_PING_FS_COMMAND_PROBE
+#    if defined(CONFIG_MINIMAL_SYSTEM)
+#        define CONFIG_PING_FS_COMMAND_PROBE                0
+#    else
+#        define CONFIG_PING_FS_COMMAND_PROBE                1
+#    endif
+#endif
+
+/**
+ * Debug file system counters of sent, received and lost probe echo
+ * requests, summed over all probes.
+ */
+#ifndef CONFIG_PING_PROBE_COUNTERS
+#    if defined(CONFIG_MINIMAL_SYSTEM)
+#        define CONFIG_PING_PROBE_COUNTERS                  0
+#    else
+#        define CONFIG_PING_PROBE_COUNTERS                  1
+#    endif
+#endif
+
+/**
+ * Maximum number of probe echo requests waiting for a reply at a
+ * time.
+ */
+#ifndef CONFIG_PING_PROBE_OUTSTANDING_MAX
+#    define CONFIG_PING_PROBE_OUTSTANDING_MAX               8
+#endif
+
+/**
+ * Debug file system command to list the socket DNS cache.
+ */
+#ifndef CONFIG_SOCKET_FS_COMMAND_DNS_CACHE_LIST
+#    if defined(CONFIG_MINIMAL_SYSTEM)
+#        define CONFIG_SOCKET_FS_COMMAND_DNS_CACHE_LIST     0
+#    else
+#        define CONFIG_SOCKET_FS_COMMAND_DNS_CACHE_LIST     1
+#    endif
+#endif
+
+/**
+ * Debug file system command to flush the socket DNS cache.
+ */
+#ifndef CONFIG_SOCKET_FS_COMMAND_DNS_CACHE_FLUSH
+#    if defined(CONFIG_MINIMAL_SYSTEM)
+#        define CONFIG_SOCKET_FS_COMMAND_DNS_CACHE_FLUSH    0
+#    else
+#        define CONFIG_SOCKET_FS_COMMAND_DNS_CACHE_FLUSH    1
+#    endif
+#endif
+
 /**
  * Debug file system command to list all services.
  */
@@ -1660,6 +2007,71 @@
 #    define CONFIG_UPGRADE_FS_COMMAND_BOOTLOADER_ENTER      1
 #endif
 
+/**
+ * Accept upgrade binary files with a patch of the current
+ * application instead of the whole application. The port must be
+ * able to read the current application during the upload.
+ */
+#ifndef CONFIG_UPGRADE_PATCH
+#    define CONFIG_UPGRADE_PATCH                            1
+#endif
+
+/**
+ * Write uploaded data to the port from a separate thread, so the
+ * transport keeps receiving while the flash memory is written. The
+ * data is buffered in two buffers of
+ * ``CONFIG_UPGRADE_PIPELINE_BUFFER_SIZE`` bytes each.
+ */
+#ifndef CONFIG_UPGRADE_PIPELINE
+#    define CONFIG_UPGRADE_PIPELINE                         0
+#endif
+
+/**
+ * Size of each of the two upgrade pipeline buffers.
+ */
+#ifndef CONFIG_UPGRADE_PIPELINE_BUFFER_SIZE
+#    define CONFIG_UPGRADE_PIPELINE_BUFFER_SIZE          1024
+#endif
+
+/**
+ * Priority of the upgrade pipeline writer thread.
+ */
+#ifndef CONFIG_UPGRADE_PIPELINE_PRIO
+#    define CONFIG_UPGRADE_PIPELINE_PRIO                   10
+#endif
+
+/**
+ * Stack size of the upgrade pipeline writer thread.
+ */
+#ifndef CONFIG_UPGRADE_PIPELINE_STACK_SIZE
+#    define CONFIG_UPGRADE_PIPELINE_STACK_SIZE           2048
+#endif
+
+/**
+ * Maximum Kermit long packet length accepted by the upgrade Kermit
+ * receiver, 94-9024. The packet buffer is this many bytes.
+ */
+#ifndef CONFIG_UPGRADE_KERMIT_PACKET_LENGTH_MAX
+#    define CONFIG_UPGRADE_KERMIT_PACKET_LENGTH_MAX      1024
+#endif
+
+/**
+ * Kermit sliding window size offered by the upgrade Kermit receiver,
+ * 1-31. One(1) disables sliding windows.
+ */
+#ifndef CONFIG_UPGRADE_KERMIT_WINDOW_SIZE
+#    define CONFIG_UPGRADE_KERMIT_WINDOW_SIZE               8
+#endif
+
+/**
+ * Maximum number of bytes in an UDS TransferData request, including
+ * the service id and the block sequence counter, advertised in the
+ * RequestDownload response.
+ */
+#ifndef CONFIG_UPGRADE_UDS_MAX_NUMBER_OF_BLOCK_LENGTH
+#    define CONFIG_UPGRADE_UDS_MAX_NUMBER_OF_BLOCK_LENGTH  16386
+#endif
+
 /**
  * The maximum length of an absolute path in the file system.
  */
@@ -1667,6 +2079,58 @@
 #    define CONFIG_FS_PATH_MAX                             64
 #endif
 
+/**
+ * Size of the read-ahead and write-behind buffer in each file object,
+ * used by files opened with ``FS_BUFFERED``. Zero(0) to remove the
+ * buffer from the file object, and ignore ``FS_BUFFERED``.
+ */
+#ifndef CONFIG_FS_FILE_BUFFER_SIZE
+#    if defined(CONFIG_MINIMAL_SYSTEM) || defined(ARCH_AVR)
+#        define CONFIG_FS_FILE_BUFFER_SIZE                  0
+#    else
+#        define CONFIG_FS_FILE_BUFFER_SIZE                 64
+#    endif
+#endif
+
+/**
+ * Collect the commands defined by FS_COMMAND_DEFINE() in a table
+ * generated by ``simbagen.py`` when the application is linked. Set
+ * to zero(0) in builds without that step, for example Arduino IDE
+ * builds, to register the commands at startup instead.
+ */
+#ifndef CONFIG_FS_COMMANDS_STATIC
+#    define CONFIG_FS_COMMANDS_STATIC                      1
+#endif
+
+/**
+ * Size of the sorted array of registered file system commands,
+ * counters and parameters searched with a binary search by
+ * fs_call(). The command list is searched linearly if more commands
+ * than this are registered. Zero(0) to disable the index.
+ */
+#ifndef CONFIG_FS_COMMANDS_INDEX_MAX
+#    if defined(CONFIG_MINIMAL_SYSTEM) || defined(ARCH_AVR)
+#        define CONFIG_FS_COMMANDS_INDEX_MAX               0
+#    else
+#        define CONFIG_FS_COMMANDS_INDEX_MAX               128
+#    endif
+#endif
+
+/**
+ * Asynchronous file reads and writes, performed by an I/O thread per
+ * file system. See fs_read_async() and fs_write_async().
+ */
+#ifndef CONFIG_FS_ASYNC
+#    define CONFIG_FS_ASYNC                                0
+#endif
+
+/**
+ * Priority of the file system I/O threads.
+ */
+#ifndef CONFIG_FS_ASYNC_THREAD_PRIO
+#    define CONFIG_FS_ASYNC_THREAD_PRIO                    50
+#endif
+
 /**
  * Maximum number of command arguments, including the command name.
  */
@@ -1707,6 +2171,18 @@
 #    endif
 #endif
 
+/**
+ * Debug file system command to write all counters in binary form, as
+ * done by `fs_counters_export()`.
+ */
+#ifndef CONFIG_FS_FS_COMMAND_COUNTERS_EXPORT
+#    if defined(BOARD_ARDUINO_NANO) || defined(BOARD_ARDUINO_UNO) || defined(BOARD_ARDUINO_PRO_MICRO) || defined(FAMILY_SPC5) || defined(CONFIG_MINIMAL_SYSTEM)
+#        define CONFIG_FS_FS_COMMAND_COUNTERS_EXPORT        0
+#    else
+#        define CONFIG_FS_FS_COMMAND_COUNTERS_EXPORT        1
+#    endif
+#endif
+
 /**
  * Debug file system command to list all registered file systems.
  */
@@ -1802,6 +2278,15 @@
 #    define CONFIG_MONITOR_THREAD_PERIOD_US           2000000
 #endif
 
+/**
+ * Priority inheritance and priority ceiling for mutexes. A thread
+ * holding a mutex runs with the priority of the most important
+ * waiting thread, or the mutex priority ceiling, if higher.
+ */
+#ifndef CONFIG_MUTEX_PRIO_INHERIT
+#    define CONFIG_MUTEX_PRIO_INHERIT                       0
+#endif
+
 /**
  * Use a preemptive scheduler.
  */
@@ -1836,6 +2321,23 @@
 #    define CONFIG_SETTINGS_BLOB                            1
 #endif
 
+/**
+ * Keep a copy of the settings area in RAM. Reads are served from the
+ * copy, and writes are kept there until written to the non-volatile
+ * memory by `settings_flush()`.
+ */
+#ifndef CONFIG_SETTINGS_MIRROR
+#    define CONFIG_SETTINGS_MIRROR                          0
+#endif
+
+/**
+ * Size in bytes of the blocks written by `settings_flush()`. Only
+ * modified blocks are written.
+ */
+#ifndef CONFIG_SETTINGS_MIRROR_BLOCK_SIZE
+#    define CONFIG_SETTINGS_MIRROR_BLOCK_SIZE              32
+#endif
+
 /**
  * Maximum number of characters in a shell command.
  */
@@ -1877,7 +2379,71 @@
 #endif
 
 /**
- * SPIFFS is a flash file system applicable for boards that has a
+ * Maximum number of channels in a single call to `socket_poll()`. The
+ * poll list is allocated on the calling thread's stack.
+ */
+#ifndef CONFIG_SOCKET_POLL_MAX
+#    define CONFIG_SOCKET_POLL_MAX                          32
+#endif
+
+/**
+ * Number of hostnames in the socket_gethostbyname() DNS cache.
+ */
+#ifndef CONFIG_SOCKET_DNS_CACHE_MAX
+#    define CONFIG_SOCKET_DNS_CACHE_MAX                     4
+#endif
+
+/**
+ * Size of the longest hostname that is cached by
+ * socket_gethostbyname(), including the null termination. Longer
+ * hostnames are looked up every time.
+ */
+#ifndef CONFIG_SOCKET_DNS_CACHE_HOSTNAME_MAX
+#    define CONFIG_SOCKET_DNS_CACHE_HOSTNAME_MAX            48
+#endif
+
+/**
+ * Number of seconds a resolved hostname is kept in the DNS cache.
+ */
+#ifndef CONFIG_SOCKET_DNS_CACHE_TTL
+#    define CONFIG_SOCKET_DNS_CACHE_TTL                     300
+#endif
+
+/**
+ * Number of seconds a hostname that could not be resolved is kept in
+ * the DNS cache.
+ */
+#ifndef CONFIG_SOCKET_DNS_CACHE_NEGATIVE_TTL
+#    define CONFIG_SOCKET_DNS_CACHE_NEGATIVE_TTL            30
+#endif
+
+/**
+ * Accumulate the lwIP statistics, memory pool errors, dropped packets
+ * and TCP retransmissions, into file system counters, and add the
+ * debug file system command ``/inet/lwip/stats`` that also lists the
+ * usage and high-water mark of each memory pool. Requires
+ * ``LWIP_STATS`` to be defined as ``1`` in the application makefile,
+ * for example ``CDEFS += LWIP_STATS=1``.
+ */
+#ifndef CONFIG_SOCKET_LWIP_STATS
+#    if defined(CONFIG_MINIMAL_SYSTEM)
+#        define CONFIG_SOCKET_LWIP_STATS                    0
+#    else
+#        define CONFIG_SOCKET_LWIP_STATS                    1
+#    endif
+#endif
+
+/**
+ * Period in milliseconds of the lwIP statistics accumulation. The
+ * lwIP statistics are 16 bits wide and must not wrap around within a
+ * period.
+ */
+#ifndef CONFIG_SOCKET_LWIP_STATS_PERIOD_MS
+#    define CONFIG_SOCKET_LWIP_STATS_PERIOD_MS              1000
+#endif
+
+/**
+ * SPIFFS is a flash file system applicable for boards that has a
  * reasonably big modifiable flash.
  */
 #ifndef CONFIG_SPIFFS
@@ -1890,6 +2456,111 @@
 #    endif
 #endif
 
+/**
+ * Serialize all spiffs API calls with a mutex and enable
+ * spiffs_gc_thread_start(), which starts a low priority thread that
+ * erases fully deleted blocks when the flash is idle. Erased blocks
+ * are then available for writes, which keeps the garbage collector
+ * out of the write path.
+ */
+#ifndef CONFIG_SPIFFS_GC_THREAD
+#    define CONFIG_SPIFFS_GC_THREAD                         0
+#endif
+
+/**
+ * Number of milliseconds without spiffs API calls before the flash
+ * is considered idle by the garbage collector thread.
+ */
+#ifndef CONFIG_SPIFFS_GC_THREAD_IDLE_MS
+#    define CONFIG_SPIFFS_GC_THREAD_IDLE_MS                 1000
+#endif
+
+/**
+ * Priority of the spiffs garbage collector thread.
+ */
+#ifndef CONFIG_SPIFFS_GC_THREAD_PRIO
+#    define CONFIG_SPIFFS_GC_THREAD_PRIO                    100
+#endif
+
+/**
+ * spiffs cache hit and miss, and garbage collector run and time
+ * counters in the debug file system.
+ */
+#ifndef CONFIG_SPIFFS_COUNTERS
+#    if defined(CONFIG_MINIMAL_SYSTEM)
+#        define CONFIG_SPIFFS_COUNTERS                      0
+#    else
+#        define CONFIG_SPIFFS_COUNTERS                      1
+#    endif
+#endif
+
+/**
+ * cowfs is a copy-on-write, wear levelling and power loss resilient
+ * file system for boards with a modifiable flash.
+ */
+#ifndef CONFIG_COWFS
+#    if defined(CONFIG_MINIMAL_SYSTEM)
+#        define CONFIG_COWFS                                0
+#    elif defined(PORT_HAS_FLASH)
+#        define CONFIG_COWFS                                1
+#    else
+#        define CONFIG_COWFS                                0
+#    endif
+#endif
+
+/**
+ * Maximum cowfs file and directory name length, excluding the null
+ * termination.
+ */
+#ifndef CONFIG_COWFS_NAME_MAX
+#    define CONFIG_COWFS_NAME_MAX                           32
+#endif
+
+/**
+ * Number of blocks cowfs searches for free blocks at a time, at one
+ * bit of RAM each. Must be a multiple of 32.
+ */
+#ifndef CONFIG_COWFS_LOOKAHEAD
+#    define CONFIG_COWFS_LOOKAHEAD                          256
+#endif
+
+/**
+ * Number of commits to a cowfs metadata block pair before it is moved
+ * to other blocks, for wear levelling. Zero(0) to never move metadata
+ * pairs, otherwise at least two.
+ */
+#ifndef CONFIG_COWFS_BLOCK_CYCLES
+#    define CONFIG_COWFS_BLOCK_CYCLES                       100
+#endif
+
+/**
+ * Maximum number of cowfs files open at the same time using the fs
+ * module.
+ */
+#ifndef CONFIG_COWFS_FS_FILES_MAX
+#    define CONFIG_COWFS_FS_FILES_MAX                       2
+#endif
+
+/**
+ * romfs is a read-only file system with files stored in memory
+ * mapped flash, generated at build time by bin/romfs.py.
+ */
+#ifndef CONFIG_ROMFS
+#    if defined(CONFIG_MINIMAL_SYSTEM) || defined(ARCH_AVR)
+#        define CONFIG_ROMFS                                0
+#    else
+#        define CONFIG_ROMFS                                1
+#    endif
+#endif
+
+/**
+ * Maximum number of romfs files open at the same time using the fs
+ * module.
+ */
+#ifndef CONFIG_ROMFS_FS_FILES_MAX
+#    define CONFIG_ROMFS_FS_FILES_MAX                       2
+#endif
+
 /**
  * FAT16 is a file system.
  */
@@ -1916,6 +2587,10 @@
 #define CONFIG_START_CONSOLE_UART                           1
 #define CONFIG_START_CONSOLE_USB_CDC                        2
 
+#define CONFIG_START_CONSOLE_OUTPUT_POLICY_BLOCK            0
+#define CONFIG_START_CONSOLE_OUTPUT_POLICY_DROP_OLDEST      1
+#define CONFIG_START_CONSOLE_OUTPUT_POLICY_DROP_NEWEST      2
+
 /**
  * Start the console device (UART/USB CDC) on system startup.
  */
@@ -1987,6 +2662,15 @@
 #    define CONFIG_START_CONSOLE_USB_CDC_ENDPOINT_OUT       3
 #endif
 
+/**
+ * Console USB CDC transmission buffer size. Output is sent from the
+ * endpoint IN interrupt instead of waiting for the hardware in the
+ * writing thread if greater than zero(0).
+ */
+#ifndef CONFIG_START_CONSOLE_USB_CDC_TX_BUFFER_SIZE
+#    define CONFIG_START_CONSOLE_USB_CDC_TX_BUFFER_SIZE     0
+#endif
+
 /**
  * Wait for the host to connect after starting the console.
  */
@@ -1994,6 +2678,43 @@
 #    define CONFIG_START_CONSOLE_USB_CDC_WAIT_FOR_CONNETION 1
 #endif
 
+/**
+ * Console output buffer size. Output is written to the buffer and
+ * sent to the console device by a drain thread, so printing threads
+ * do not wait for a slow console, if greater than zero(0).
+ */
+#ifndef CONFIG_START_CONSOLE_OUTPUT_BUFFER_SIZE
+#    define CONFIG_START_CONSOLE_OUTPUT_BUFFER_SIZE         0
+#endif
+
+/**
+ * What to do when the console output buffer is full. One of
+ * ``CONFIG_START_CONSOLE_OUTPUT_POLICY_BLOCK``,
+ * ``CONFIG_START_CONSOLE_OUTPUT_POLICY_DROP_OLDEST`` and
+ * ``CONFIG_START_CONSOLE_OUTPUT_POLICY_DROP_NEWEST``.
+ */
+#ifndef CONFIG_START_CONSOLE_OUTPUT_POLICY
+#    define CONFIG_START_CONSOLE_OUTPUT_POLICY CONFIG_START_CONSOLE_OUTPUT_POLICY_DROP_NEWEST
+#endif
+
+/**
+ * Console output drain thread priority.
+ */
+#ifndef CONFIG_START_CONSOLE_OUTPUT_PRIO
+#    define CONFIG_START_CONSOLE_OUTPUT_PRIO               30
+#endif
+
+/**
+ * Console output drain thread stack size in words.
+ */
+#ifndef CONFIG_START_CONSOLE_OUTPUT_STACK_SIZE
+#    if defined(ARCH_ESP32) || defined(ARCH_ARM64)
+#        define CONFIG_START_CONSOLE_OUTPUT_STACK_SIZE   2048
+#    else
+#        define CONFIG_START_CONSOLE_OUTPUT_STACK_SIZE    512
+#    endif
+#endif
+
 /**
  * Configure a default file system.
  */
@@ -2097,6 +2818,26 @@
 #    endif
 #endif
 
+/**
+ * Use the journaled software EEPROM implementation in the
+ * non-volatile memory module instead of the software EEPROM
+ * implementation. It uses the same flash blocks, but only appends
+ * changed bytes on write instead of copying the whole memory. Mount
+ * time is independent of the number of writes since the last
+ * compaction.
+ */
+#ifndef CONFIG_NVM_EEPROM_JOURNAL
+#    define CONFIG_NVM_EEPROM_JOURNAL                       0
+#endif
+
+/**
+ * Non-volatile memory journaled software EEPROM page size. Must be a
+ * multiple of four, and at most ``EEPROM_JOURNAL_PAGE_SIZE_MAX``.
+ */
+#ifndef CONFIG_NVM_EEPROM_JOURNAL_PAGE_SIZE
+#    define CONFIG_NVM_EEPROM_JOURNAL_PAGE_SIZE            32
+#endif
+
 /**
  * Non-volatile memory software EEPROM block 0 size. Must be a
  * multiple of ``CONFIG_NVM_EEPROM_SOFT_CHUNK_SIZE``.
@@ -2212,6 +2953,38 @@
 #    endif
 #endif
 
+/**
+ * Start the network, file system, non-volatile memory, settings and
+ * upgrade services in a low priority thread after `main()` is
+ * entered, instead of in `sys_start()`. Call `sys_start_wait()`
+ * before using them. Shortens the time to `main()` for applications
+ * that often do not use these services, for example after a wake up
+ * from deep sleep.
+ */
+#ifndef CONFIG_START_DEFERRED
+#    define CONFIG_START_DEFERRED                           0
+#endif
+
+/**
+ * Deferred start thread priority.
+ */
+#ifndef CONFIG_START_DEFERRED_PRIO
+#    define CONFIG_START_DEFERRED_PRIO                     100
+#endif
+
+/**
+ * Deferred start thread stack size in words.
+ */
+#ifndef CONFIG_START_DEFERRED_STACK_SIZE
+#    if defined(ARCH_ESP) || defined(ARCH_ESP32) || defined(ARCH_ARM64)
+#        define CONFIG_START_DEFERRED_STACK_SIZE         4096
+#    elif defined(BOARD_ARDUINO_DUE) || defined(ARCH_PPC) || defined(ARCH_MIPS)
+#        define CONFIG_START_DEFERRED_STACK_SIZE         1536
+#    else
+#        define CONFIG_START_DEFERRED_STACK_SIZE          768
+#    endif
+#endif
+
 /**
  * Start a SOAM thread communication over the console channels.
  */
@@ -2258,10 +3031,16 @@
 #endif
 
 /**
- * Maximum number of bytes in the print output buffer.
+ * Maximum number of bytes in the print output buffer. The buffer is
+ * allocated on the stack of the printing thread, and the output
+ * channel is written to each time it is full.
  */
 #ifndef CONFIG_STD_OUTPUT_BUFFER_MAX
-#    define CONFIG_STD_OUTPUT_BUFFER_MAX                   16
+#    if defined(ARCH_AVR)
+#        define CONFIG_STD_OUTPUT_BUFFER_MAX               16
+#    else
+#        define CONFIG_STD_OUTPUT_BUFFER_MAX               64
+#    endif
 #endif
 
 /**
@@ -2275,6 +3054,28 @@
 #    endif
 #endif
 
+/**
+ * Support for the ``%f`` format specifier in the print functions in
+ * the std module. Disable to save flash if no floating point numbers
+ * are printed.
+ */
+#ifndef CONFIG_STD_PRINTF_FLOAT
+#    define CONFIG_STD_PRINTF_FLOAT                CONFIG_FLOAT
+#endif
+
+/**
+ * Support for the ``ll`` length modifier, 64 bits integers, in the
+ * print functions in the std module. 64 bits division is expensive
+ * on AVR, where it is disabled by default.
+ */
+#ifndef CONFIG_STD_PRINTF_LONG_LONG
+#    if defined(ARCH_AVR)
+#        define CONFIG_STD_PRINTF_LONG_LONG                    0
+#    else
+#        define CONFIG_STD_PRINTF_LONG_LONG                    1
+#    endif
+#endif
+
 /**
  * Memory alignment for runtime memory allocations.
  */
@@ -2286,6 +3087,53 @@
 #    endif
 #endif
 
+/**
+ * Allocate dynamic size heap buffers with a two-level segregated fit
+ * (TLSF) allocator instead of a first fit free list. Allocation and
+ * free take constant time and adjacent free buffers are merged
+ * immediately.
+ */
+#ifndef CONFIG_HEAP_TLSF
+#    define CONFIG_HEAP_TLSF                                0
+#endif
+
+/**
+ * Base two logarithm of the maximum size of a TLSF heap block. Heap
+ * allocations bigger than this fail. Each step doubles the maximum
+ * block size and adds another first level free list array to
+ * ``struct heap_t``.
+ */
+#ifndef CONFIG_HEAP_TLSF_FL_INDEX_MAX
+#    define CONFIG_HEAP_TLSF_FL_INDEX_MAX                  16
+#endif
+
+/**
+ * Heap and circular heap statistics; bytes in use, maximum bytes in
+ * use, largest free block, fixed size free list hits and misses, and
+ * failed allocations.
+ */
+#ifndef CONFIG_HEAP_STATS
+#    define CONFIG_HEAP_STATS                               0
+#endif
+
+/**
+ * Number of allocations and frees recorded in the allocation trace
+ * ring of each heap, or zero(0) to disable allocation tracing.
+ * Requires ``CONFIG_HEAP_STATS``.
+ */
+#ifndef CONFIG_HEAP_TRACE_LENGTH
+#    define CONFIG_HEAP_TRACE_LENGTH                        0
+#endif
+
+/**
+ * Mirrored circular buffers, mapping the buffer memory twice to
+ * consecutive virtual addresses, see
+ * `circular_buffer_mirror_init()`. Only supported on Linux.
+ */
+#ifndef CONFIG_CIRCULAR_BUFFER_MIRROR
+#    define CONFIG_CIRCULAR_BUFFER_MIRROR                   0
+#endif
+
 /**
  * System tick frequency in Hertz.
  */
@@ -2324,163 +3172,808 @@
 #endif
 
 /**
- * Default thread log mask.
+ * Measure the time each thread runs on the CPU at every context
+ * switch, using the cycle counter of the CPU; DWT CYCCNT on ARM
+ * Cortex-M3/M4, CCOUNT on Xtensa and a microseconds monotonic clock
+ * on Linux. Cumulative cycles, number of context switches and the
+ * longest run slice of each thread are printed by the
+ * ``/kernel/thrd/list`` file system command.
  */
-#ifndef CONFIG_THRD_DEFAULT_LOG_MASK
-#    define CONFIG_THRD_DEFAULT_LOG_MASK       LOG_UPTO(INFO)
+#ifndef CONFIG_THRD_CYCLES
+#    define CONFIG_THRD_CYCLES                              0
 #endif
 
 /**
- * Regular expression module debug log mask.
+ * Record scheduler events in a binary ring buffer in RAM. Thread
+ * switches, thread resumes, timer expiries and blocking on queues,
+ * semaphores and mutexes are recorded with a cycle counter
+ * timestamp. See the :doc:`trace module
+ * <../library-reference/debug/trace>`.
  */
-#ifndef CONFIG_RE_DEBUG_LOG_MASK
-#    define CONFIG_RE_DEBUG_LOG_MASK                       -1
+#ifndef CONFIG_TRACE
+#    define CONFIG_TRACE                                    0
 #endif
 
 /**
- * Each thread has a list of environment variables associated with
- * it. A typical example of an environment variable is "CWD" - Current
- * Working Directory.
+ * Number of records in the scheduler trace ring buffer. Must be a
+ * power of two. The oldest record is overwritten when the buffer is
+ * full.
  */
-#ifndef CONFIG_THRD_ENV
-#    if defined(BOARD_ARDUINO_NANO) || defined(BOARD_ARDUINO_UNO) || defined(BOARD_ARDUINO_PRO_MICRO) || defined(CONFIG_MINIMAL_SYSTEM)
-#        define CONFIG_THRD_ENV                             0
-#    else
-#        define CONFIG_THRD_ENV                             1
-#    endif
+#ifndef CONFIG_TRACE_BUFFER_SIZE
+#    define CONFIG_TRACE_BUFFER_SIZE                      256
 #endif
 
 /**
- * Stack size of the idle thread.
+ * Sample the interrupted program counter, and on Linux a short frame
+ * pointer backtrace, periodically into a RAM buffer. On ARM the
+ * samples are taken in the system tick interrupt. See the
+ * :doc:`profiler module <../library-reference/debug/profiler>`.
  */
-#ifndef CONFIG_THRD_IDLE_STACK_SIZE
-#    if defined(ARCH_ARM) || defined(ARCH_MIPS)
-#        define CONFIG_THRD_IDLE_STACK_SIZE               384
-#    elif defined(ARCH_AVR) || defined(FAMILY_SPC5)
-#        define CONFIG_THRD_IDLE_STACK_SIZE               156
-#    elif defined(ARCH_ESP)
-#        define CONFIG_THRD_IDLE_STACK_SIZE               768
-#    else
-#        define CONFIG_THRD_IDLE_STACK_SIZE              2048
-#    endif
+#ifndef CONFIG_PROFILER
+#    define CONFIG_PROFILER                                 0
 #endif
 
 /**
- * Stack size of the monitor thread.
+ * Number of samples in the profiler buffer. Samples taken when the
+ * buffer is full are dropped and counted.
  */
-#ifndef CONFIG_THRD_MONITOR_STACK_SIZE
-#    if defined(ARCH_PPC) || defined(ARCH_ESP) || defined(ARCH_ESP32) || defined(ARCH_MIPS)
-#        define CONFIG_THRD_MONITOR_STACK_SIZE            768
-#    elif defined(ARCH_ARM)
-#        define CONFIG_THRD_MONITOR_STACK_SIZE            512
-#    elif defined(ARCH_AVR)
-#        define CONFIG_THRD_MONITOR_STACK_SIZE            256
+#ifndef CONFIG_PROFILER_BUFFER_SIZE
+#    if defined(ARCH_LINUX)
+#        define CONFIG_PROFILER_BUFFER_SIZE              4096
 #    else
-#        define CONFIG_THRD_MONITOR_STACK_SIZE           2048
+#        define CONFIG_PROFILER_BUFFER_SIZE               256
 #    endif
 #endif
 
 /**
- * Count the number of times each thread has been scheduled.
+ * Maximum number of return addresses stored in each profiler sample
+ * in addition to the program counter. Only the Linux port follows the
+ * frame pointers.
  */
-#ifndef CONFIG_THRD_SCHEDULED
-#    if defined(CONFIG_MINIMAL_SYSTEM)
-#        define CONFIG_THRD_SCHEDULED                       0
+#ifndef CONFIG_PROFILER_BACKTRACE_DEPTH
+#    if defined(ARCH_LINUX)
+#        define CONFIG_PROFILER_BACKTRACE_DEPTH            15
 #    else
-#        define CONFIG_THRD_SCHEDULED                       1
+#        define CONFIG_PROFILER_BACKTRACE_DEPTH             0
 #    endif
 #endif
 
 /**
- * Enable the thread stack heap allocator.
+ * Profiler sampling frequency in Hz on Linux, in consumed CPU
+ * time. Other ports sample at ``CONFIG_SYSTEM_TICK_FREQUENCY``.
  */
-#ifndef CONFIG_THRD_STACK_HEAP
-#    define CONFIG_THRD_STACK_HEAP                          0
+#ifndef CONFIG_PROFILER_FREQUENCY
+#    define CONFIG_PROFILER_FREQUENCY                    1000
 #endif
 
 /**
- * Size in bytes of the thread stack heap.
+ * Least severe log level kept by the ``LOG_OBJECT_PRINT*()`` macros,
+ * one of ``LOG_FATAL`` (0) to ``LOG_DEBUG`` (4). Calls with less
+ * severe levels are removed at compile time, for example debug log
+ * points in production builds with this set to ``LOG_INFO`` (3).
  */
-#ifndef CONFIG_THRD_STACK_HEAP_SIZE
-#    define CONFIG_THRD_STACK_HEAP_SIZE                     0
+#ifndef CONFIG_LOG_LEVEL_MIN
+#    define CONFIG_LOG_LEVEL_MIN                            4
 #endif
 
 /**
- * Threads are allowed to terminate.
+ * Record log entries written with `log_object_print_deferred()` in a
+ * binary ring buffer in RAM instead of formatting them. The entries
+ * are written to the log handlers by `log_deferred_flush()`, and
+ * formatted on the host by ``bin/soam.py`` if the handler is a SOAM
+ * log channel. See the :doc:`log module
+ * <../library-reference/debug/log>`.
  */
-#ifndef CONFIG_THRD_TERMINATE
-#    if defined(CONFIG_MINIMAL_SYSTEM)
-#        define CONFIG_THRD_TERMINATE                       0
-#    else
-#        define CONFIG_THRD_TERMINATE                       1
-#    endif
+#ifndef CONFIG_LOG_DEFERRED
+#    define CONFIG_LOG_DEFERRED                             0
 #endif
 
 /**
- * USB device vendor id.
+ * Number of entries in the deferred log ring buffer. Must be a power
+ * of two. The oldest entry is overwritten when the buffer is full.
  */
-#ifndef CONFIG_USB_DEVICE_VID
-#    define CONFIG_USB_DEVICE_VID                      0x2341
+#ifndef CONFIG_LOG_DEFERRED_BUFFER_SIZE
+#    define CONFIG_LOG_DEFERRED_BUFFER_SIZE                32
 #endif
 
 /**
- * USB device product id.
+ * Maximum number of arguments of a deferred log entry.
  */
-#ifndef CONFIG_USB_DEVICE_PID
-#    define CONFIG_USB_DEVICE_PID                      0x8037
+#ifndef CONFIG_LOG_DEFERRED_ARGS_MAX
+#    define CONFIG_LOG_DEFERRED_ARGS_MAX                    4
 #endif
 
 /**
- * Number of colums in Emacs text editor.
+ * Enable log_writer_start(), which starts a low priority thread that
+ * writes log entries to the log handlers. Threads with a staging
+ * buffer, see `log_set_thread_staging()`, format their log entries
+ * into it instead of writing them to the log handlers, and never
+ * block on a slow output channel.
  */
-#ifndef CONFIG_EMACS_COLUMNS_MAX
-#    define CONFIG_EMACS_COLUMNS_MAX                       80
+#ifndef CONFIG_LOG_WRITER
+#    define CONFIG_LOG_WRITER                               0
 #endif
 
 /**
- * Number of rows in Emacs text editor.
+ * Priority of the log writer thread.
  */
-#ifndef CONFIG_EMACS_ROWS_MAX
-#    define CONFIG_EMACS_ROWS_MAX                          24
+#ifndef CONFIG_LOG_WRITER_PRIO
+#    define CONFIG_LOG_WRITER_PRIO                        100
 #endif
 
 /**
- * Heap size of the emacs  text editor.
+ * Maximum size of a formatted log entry in a staging buffer. Longer
+ * entries are truncated. Entries are formatted on the stack of the
+ * logging thread.
  */
-#ifndef CONFIG_EMACS_HEAP_SIZE
-#    define CONFIG_EMACS_HEAP_SIZE                      32768
+#ifndef CONFIG_LOG_WRITER_ENTRY_SIZE_MAX
+#    define CONFIG_LOG_WRITER_ENTRY_SIZE_MAX              128
 #endif
 
 /**
- * System tick using a software timer instead of a hardware
- * timer. Suitable for ESP8266 to enable software PWM.
+ * Record acquisition count, wait time and hold time of the system
+ * lock, mutexes and reader-writer locks, in cycle counter ticks. See
+ * the :doc:`lock_stats module
+ * <../library-reference/sync/lock_stats>`.
  */
-#ifndef CONFIG_SYSTEM_TICK_SOFTWARE
-#    if (CONFIG_PWM_SOFT == 1) && defined(ARCH_ESP)
-#        define CONFIG_SYSTEM_TICK_SOFTWARE                 1
-#    else
-#        define CONFIG_SYSTEM_TICK_SOFTWARE                 0
-#    endif
+#ifndef CONFIG_LOCK_STATS
+#    define CONFIG_LOCK_STATS                               0
 #endif
 
 /**
- * Add support to wrap the HTTP server in SSL, creating a HTTPS
- * server.
+ * Record the number of calls and the execution time of each interrupt
+ * service routine, and the longest period interrupts are masked by
+ * the system lock, in cycle counter ticks. See the :doc:`isr_stats
+ * module <../library-reference/debug/isr_stats>`.
  */
-#ifndef CONFIG_HTTP_SERVER_SSL
-#    if defined(CONFIG_MINIMAL_SYSTEM)
-#        define CONFIG_HTTP_SERVER_SSL                      0
-#    elif defined(ARCH_ESP32) || defined(ARCH_LINUX)
-#        define CONFIG_HTTP_SERVER_SSL                      1
-#    else
-#        define CONFIG_HTTP_SERVER_SSL                      0
-#    endif
+#ifndef CONFIG_ISR_STATS
+#    define CONFIG_ISR_STATS                                0
 #endif
 
 /**
- * Sleep in the test harness before executing the first testcase.
+ * Earliest deadline first scheduling class for periodic threads, see
+ * `thrd_set_edf()`. Deadline misses and budget overruns are counted
+ * per thread and by the ``/kernel/thrd/edf/deadline_misses`` and
+ * ``/kernel/thrd/edf/budget_overruns`` file system counters.
  */
-#ifndef CONFIG_HARNESS_SLEEP_MS
+#ifndef CONFIG_THRD_EDF
+#    define CONFIG_THRD_EDF                                 0
+#endif
+
+/**
+ * Fixed priority of the EDF scheduling class. EDF threads run before
+ * fixed priority threads with this or lower priority.
+ */
+#ifndef CONFIG_THRD_EDF_PRIO
+#    define CONFIG_THRD_EDF_PRIO                            0
+#endif
+
+/**
+ * Inline `chan_read()`, `chan_write()`, `chan_getc()` and
+ * `chan_putc()` in the caller, saving a function call and the
+ * argument checks on every channel access. Increases the code size
+ * somewhat. Call the channel type functions directly, for example
+ * `queue_write()`, to also skip the write filter and the function
+ * pointer call when the channel type is known.
+ */
+#ifndef CONFIG_CHAN_INLINE
+#    define CONFIG_CHAN_INLINE                              0
+#endif
+
+/**
+ * Vectored write callback in channels, see `chan_writev()`. Adds one
+ * word to each channel. Without it `chan_writev()` writes one buffer
+ * at a time.
+ */
+#ifndef CONFIG_CHAN_WRITEV
+#    if defined(BOARD_ARDUINO_NANO) || defined(BOARD_ARDUINO_UNO) || defined(BOARD_ARDUINO_PRO_MICRO)
+#        define CONFIG_CHAN_WRITEV                          0
+#    else
+#        define CONFIG_CHAN_WRITEV                          1
+#    endif
+#endif
+
+/**
+ * Persistent channel poll sets, see `chan_pollset_wait()`. Adds three
+ * words to each channel.
+ */
+#ifndef CONFIG_CHAN_POLLSET
+#    define CONFIG_CHAN_POLLSET                             0
+#endif
+
+/**
+ * Maximum number of ready channels handled per reactor loop
+ * iteration, see `reactor_run_once()`. Uses one word of stack per
+ * channel.
+ */
+#ifndef CONFIG_REACTOR_READY_MAX
+#    define CONFIG_REACTOR_READY_MAX                        8
+#endif
+
+/**
+ * Index bus listeners in a hash table instead of a binary tree. See
+ * the :doc:`bus module <../library-reference/sync/bus>`.
+ */
+#ifndef CONFIG_BUS_HASH
+#    define CONFIG_BUS_HASH                                 0
+#endif
+
+/**
+ * Number of buckets in the bus listener hash table. Must be a power
+ * of two.
+ */
+#ifndef CONFIG_BUS_HASH_BUCKETS
+#    define CONFIG_BUS_HASH_BUCKETS                        16
+#endif
+
+/**
+ * Default thread log mask.
+ */
+#ifndef CONFIG_THRD_DEFAULT_LOG_MASK
+#    define CONFIG_THRD_DEFAULT_LOG_MASK       LOG_UPTO(INFO)
+#endif
+
+/**
+ * Regular expression module debug log mask.
+ */
+#ifndef CONFIG_RE_DEBUG_LOG_MASK
+#    define CONFIG_RE_DEBUG_LOG_MASK                       -1
+#endif
+
+/**
+ * Each thread has a list of environment variables associated with
+ * it. A typical example of an environment variable is "CWD" - Current
+ * Working Directory.
+ */
+#ifndef CONFIG_THRD_ENV
+#    if defined(BOARD_ARDUINO_NANO) || defined(BOARD_ARDUINO_UNO) || defined(BOARD_ARDUINO_PRO_MICRO) || defined(CONFIG_MINIMAL_SYSTEM)
+#        define CONFIG_THRD_ENV                             0
+#    else
+#        define CONFIG_THRD_ENV                             1
+#    endif
+#endif
+
+/**
+ * Each thread has a scratch arena pointer, see `thrd_set_arena()`.
+ */
+#ifndef CONFIG_THRD_ARENA
+#    define CONFIG_THRD_ARENA                               0
+#endif
+
+/**
+ * Store environment variables in hash tables instead of unsorted
+ * arrays, making lookups constant time on average. The FNV-1a hash
+ * of each name is stored with the variable. Lookups are fastest when
+ * the variables arrays are somewhat larger than the number of
+ * variables stored in them.
+ */
+#ifndef CONFIG_THRD_ENV_HASH
+#    define CONFIG_THRD_ENV_HASH                            0
+#endif
+
+/**
+ * Number of variables in the default global environment, used until
+ * `thrd_init_global_env()` is called.
+ */
+#ifndef CONFIG_THRD_ENV_GLOBAL_VARIABLES_MAX
+#    define CONFIG_THRD_ENV_GLOBAL_VARIABLES_MAX            4
+#endif
+
+/**
+ * Stack size of the idle thread.
+ */
+#ifndef CONFIG_THRD_IDLE_STACK_SIZE
+#    if defined(ARCH_ARM) || defined(ARCH_MIPS)
+#        define CONFIG_THRD_IDLE_STACK_SIZE               384
+#    elif defined(ARCH_AVR) || defined(FAMILY_SPC5)
+#        define CONFIG_THRD_IDLE_STACK_SIZE               156
+#    elif defined(ARCH_ESP)
+#        define CONFIG_THRD_IDLE_STACK_SIZE               768
+#    else
+#        define CONFIG_THRD_IDLE_STACK_SIZE              2048
+#    endif
+#endif
+
+/**
+ * Stack size of the monitor thread.
+ */
+#ifndef CONFIG_THRD_MONITOR_STACK_SIZE
+#    if defined(ARCH_PPC) || defined(ARCH_ESP) || defined(ARCH_ESP32) || defined(ARCH_MIPS)
+#        define CONFIG_THRD_MONITOR_STACK_SIZE            768
+#    elif defined(ARCH_ARM)
+#        define CONFIG_THRD_MONITOR_STACK_SIZE            512
+#    elif defined(ARCH_AVR)
+#        define CONFIG_THRD_MONITOR_STACK_SIZE            256
+#    else
+#        define CONFIG_THRD_MONITOR_STACK_SIZE           2048
+#    endif
+#endif
+
+/**
+ * Count the number of times each thread has been scheduled.
+ */
+#ifndef CONFIG_THRD_SCHEDULED
+#    if defined(CONFIG_MINIMAL_SYSTEM)
+#        define CONFIG_THRD_SCHEDULED                       0
+#    else
+#        define CONFIG_THRD_SCHEDULED                       1
+#    endif
+#endif
+
+/**
+ * Use a bitmap indexed ready queue in the scheduler, with one FIFO
+ * per priority level. Pushing and popping ready threads takes
+ * constant time, independent of the number of ready threads, at the
+ * cost of a larger scheduler data structure.
+ */
+#ifndef CONFIG_THRD_SCHEDULER_BITMAP
+#    define CONFIG_THRD_SCHEDULER_BITMAP                    0
+#endif
+
+/**
+ * Enable the thread stack heap allocator.
+ */
+#ifndef CONFIG_THRD_STACK_HEAP
+#    define CONFIG_THRD_STACK_HEAP                          0
+#endif
+
+/**
+ * Size in bytes of the thread stack heap.
+ */
+#ifndef CONFIG_THRD_STACK_HEAP_SIZE
+#    define CONFIG_THRD_STACK_HEAP_SIZE                     0
+#endif
+
+/**
+ * Comma separated list of up to eight thread stack size classes in
+ * ascending order, for example ``512,1024,2048``. Stacks up to the
+ * biggest size class are allocated from a free list of the smallest
+ * fitting class, which is a constant time operation that never
+ * fragments the stack heap. Bigger stacks are allocated from the
+ * dynamic part of the stack heap.
+ */
+#ifndef CONFIG_THRD_STACK_HEAP_FIXED_SIZES
+#    define CONFIG_THRD_STACK_HEAP_FIXED_SIZES              0
+#endif
+
+/**
+ * Threads are allowed to terminate.
+ */
+#ifndef CONFIG_THRD_TERMINATE
+#    if defined(CONFIG_MINIMAL_SYSTEM)
+#        define CONFIG_THRD_TERMINATE                       0
+#    else
+#        define CONFIG_THRD_TERMINATE                       1
+#    endif
+#endif
+
+/**
+ * Keep system tick timers in a hashed timing wheel instead of a
+ * sorted delta list. Starting and stopping a timer takes constant
+ * time, independent of the number of active timers.
+ */
+#ifndef CONFIG_TIMER_WHEEL
+#    define CONFIG_TIMER_WHEEL                              0
+#endif
+
+/**
+ * Number of slots in the timer wheel. Must be a power of two. Timers
+ * with a timeout longer than this number of system ticks go around
+ * the wheel more than once before they expire.
+ */
+#ifndef CONFIG_TIMER_WHEEL_SIZE
+#    define CONFIG_TIMER_WHEEL_SIZE                        64
+#endif
+
+/**
+ * Call the callbacks of timers initialized with ``TIMER_DEFERRED``
+ * from a high priority timer thread instead of from the timer
+ * interrupt.
+ */
+#ifndef CONFIG_TIMER_DEFERRED
+#    define CONFIG_TIMER_DEFERRED                           0
+#endif
+
+/**
+ * Timer thread priority.
+ */
+#ifndef CONFIG_TIMER_DEFERRED_PRIO
+#    define CONFIG_TIMER_DEFERRED_PRIO                    -80
+#endif
+
+/**
+ * Timer thread stack size in words.
+ */
+#ifndef CONFIG_TIMER_DEFERRED_STACK_SIZE
+#    if defined(ARCH_ESP) || defined(ARCH_ESP32) || defined(ARCH_ARM64)
+#        define CONFIG_TIMER_DEFERRED_STACK_SIZE         2048
+#    else
+#        define CONFIG_TIMER_DEFERRED_STACK_SIZE          768
+#    endif
+#endif
+
+/**
+ * USB device vendor id.
+ */
+#ifndef CONFIG_USB_DEVICE_VID
+#    define CONFIG_USB_DEVICE_VID                      0x2341
+#endif
+
+/**
+ * USB device product id.
+ */
+#ifndef CONFIG_USB_DEVICE_PID
+#    define CONFIG_USB_DEVICE_PID                      0x8037
+#endif
+
+/**
+ * Number of colums in Emacs text editor.
+ */
+#ifndef CONFIG_EMACS_COLUMNS_MAX
+#    define CONFIG_EMACS_COLUMNS_MAX                       80
+#endif
+
+/**
+ * Number of rows in Emacs text editor.
+ */
+#ifndef CONFIG_EMACS_ROWS_MAX
+#    define CONFIG_EMACS_ROWS_MAX                          24
+#endif
+
+/**
+ * Heap size of the emacs  text editor.
+ */
+#ifndef CONFIG_EMACS_HEAP_SIZE
+#    define CONFIG_EMACS_HEAP_SIZE                      32768
+#endif
+
+/**
+ * Size of the Emacs text editor output buffer. The terminal output
+ * is buffered and written once per screen update.
+ */
+#ifndef CONFIG_EMACS_OUTPUT_BUFFER_SIZE
+#    define CONFIG_EMACS_OUTPUT_BUFFER_SIZE               128
+#endif
+
+/**
+ * System tick using a software timer instead of a hardware
+ * timer. Suitable for ESP8266 to enable software PWM.
+ */
+#ifndef CONFIG_SYSTEM_TICK_SOFTWARE
+#    if (CONFIG_PWM_SOFT == 1) && defined(ARCH_ESP)
+#        define CONFIG_SYSTEM_TICK_SOFTWARE                 1
+#    else
+#        define CONFIG_SYSTEM_TICK_SOFTWARE                 0
+#    endif
+#endif
+
+/**
+ * Tickless idle. The idle thread programs the system tick timer to
+ * interrupt when the next timer expires, instead of taking the
+ * periodic system tick, and catches up the system time when woken
+ * up. Only implemented for ARM Cortex-M and Linux. Other ports keep
+ * the periodic system tick.
+ */
+#ifndef CONFIG_SYSTEM_TICKLESS
+#    define CONFIG_SYSTEM_TICKLESS                          0
+#endif
+
+/**
+ * Interrupt priority threshold of the system lock on ARM Cortex-M3
+ * and Cortex-M4, as an 8 bits NVIC priority register value. Zero(0)
+ * makes the system lock disable all interrupts. Any other value makes
+ * the system lock mask only interrupts with this or a numerically
+ * higher priority value using ``BASEPRI``. All interrupts are given
+ * this priority at startup. An interrupt service routine that never
+ * calls the kernel may be given a numerically lower priority with
+ * ``nvic_set_priority()`` to stay enabled in the system lock. Ignored
+ * by other ports.
+ */
+#ifndef CONFIG_SYS_LOCK_PRIO
+#    define CONFIG_SYS_LOCK_PRIO                            0
+#endif
+
+/**
+ * Add support to wrap the HTTP server in SSL, creating a HTTPS
+ * server.
+ */
+#ifndef CONFIG_HTTP_SERVER_SSL
+#    if defined(CONFIG_MINIMAL_SYSTEM)
+#        define CONFIG_HTTP_SERVER_SSL                      0
+#    elif defined(ARCH_ESP32) || defined(ARCH_LINUX)
+#        define CONFIG_HTTP_SERVER_SSL                      1
+#    else
+#        define CONFIG_HTTP_SERVER_SSL                      0
+#    endif
+#endif
+
+/**
+ * Add support for HTTPS requests in the HTTP client.
+ */
+#ifndef CONFIG_HTTP_CLIENT_SSL
+#    if defined(CONFIG_MINIMAL_SYSTEM)
+#        define CONFIG_HTTP_CLIENT_SSL                      0
+#    elif defined(ARCH_ESP32) || defined(ARCH_LINUX)
+#        define CONFIG_HTTP_CLIENT_SSL                      1
+#    else
+#        define CONFIG_HTTP_CLIENT_SSL                      0
+#    endif
+#endif
+
+/**
+ * Seed the SSL random number generator from the hardware random
+ * number generator, see the random driver, in addition to the
+ * entropy sources of the mbedTLS configuration.
+ */
+#ifndef CONFIG_SSL_HARDWARE_ENTROPY
+#    define CONFIG_SSL_HARDWARE_ENTROPY                     CONFIG_RANDOM
+#endif
+
+/**
+ * Number of TLS sessions cached by client side SSL sockets, keyed by
+ * server hostname. A cached session is resumed on the next connection
+ * to the same server, which skips the asymmetric crypto of the
+ * handshake. Zero(0) disables the cache.
+ */
+#ifndef CONFIG_SSL_SESSION_CACHE_MAX
+#    define CONFIG_SSL_SESSION_CACHE_MAX                    2
+#endif
+
+/**
+ * Maximum length of a server hostname in the TLS session cache,
+ * including the null termination. Sessions with longer hostnames are
+ * not cached.
+ */
+#ifndef CONFIG_SSL_SESSION_CACHE_HOSTNAME_MAX
+#    define CONFIG_SSL_SESSION_CACHE_HOSTNAME_MAX          64
+#endif
+
+/**
+ * Issue TLS session tickets from server side SSL contexts, letting
+ * clients resume their sessions without any server side state.
+ */
+#ifndef CONFIG_SSL_SESSION_TICKETS
+#    define CONFIG_SSL_SESSION_TICKETS                      1
+#endif
+
+/**
+ * Size in bytes of the stack buffer `ssl_socket_writev()` gathers
+ * small buffers in before encrypting them as one TLS record.
+ */
+#ifndef CONFIG_SSL_WRITEV_BUFFER_SIZE
+#    define CONFIG_SSL_WRITEV_BUFFER_SIZE                 256
+#endif
+
+/**
+ * Maximum number of open SSL sockets. Each open socket also
+ * allocates two TLS record buffers on the heap, see
+ * ``CONFIG_SSL_MAX_FRAGMENT_LENGTH``.
+ */
+#ifndef CONFIG_SSL_SOCKETS_MAX
+#    define CONFIG_SSL_SOCKETS_MAX                          1
+#endif
+
+/**
+ * Maximum TLS record payload length in bytes, one of 512, 1024, 2048
+ * and 4096, or zero(0) for the standard 16384 bytes. It sizes the
+ * mbedTLS record buffers of each SSL socket, and client side sockets
+ * ask the server to send records of at most this length with the
+ * max_fragment_length extension. The server has to support the
+ * extension. Server side sockets can only serve clients asking for
+ * it. Must be given on the command line or in ``config.h``,
+ * as it is also used to build the mbedTLS library.
+ */
+#ifndef CONFIG_SSL_MAX_FRAGMENT_LENGTH
+#    define CONFIG_SSL_MAX_FRAGMENT_LENGTH                  0
+#endif
+
+/**
+ * Lifetime in seconds of TLS session tickets issued by server side
+ * SSL contexts.
+ */
+#ifndef CONFIG_SSL_SESSION_TICKET_LIFETIME_S
+#    define CONFIG_SSL_SESSION_TICKET_LIFETIME_S        86400
+#endif
+
+/**
+ * Maximum number of QoS 1 and QoS 2 messages published by the MQTT
+ * client waiting for their acknowledgement at the same time. Also the
+ * number of incoming QoS 2 messages tracked for duplicate detection.
+ */
+#ifndef CONFIG_MQTT_CLIENT_INFLIGHT_MAX
+#    define CONFIG_MQTT_CLIENT_INFLIGHT_MAX                 4
+#endif
+
+/**
+ * Size in bytes of the topic and payload copy kept for each in-flight
+ * MQTT message. A publish of a larger message blocks until it has
+ * been acknowledged by the server.
+ */
+#ifndef CONFIG_MQTT_CLIENT_INFLIGHT_BUFFER_SIZE
+#    define CONFIG_MQTT_CLIENT_INFLIGHT_BUFFER_SIZE       128
+#endif
+
+/**
+ * Store messages published by the MQTT client while disconnected in
+ * a file, and publish them once connected again. See
+ * `mqtt_client_offline_queue_init()`.
+ */
+#ifndef CONFIG_MQTT_CLIENT_OFFLINE_QUEUE
+#    define CONFIG_MQTT_CLIENT_OFFLINE_QUEUE                0
+#endif
+
+/**
+ * Maximum number of buffers in one frame written by
+ * http_websocket_server_writev().
+ */
+#ifndef CONFIG_HTTP_WEBSOCKET_SERVER_IOV_MAX
+#    define CONFIG_HTTP_WEBSOCKET_SERVER_IOV_MAX            4
+#endif
+
+/**
+ * Negotiate the permessage-deflate extension, specified in RFC 7692,
+ * in the websocket client and server handshakes, and compress
+ * messages if the peer accepts it.
+ */
+#ifndef CONFIG_HTTP_WEBSOCKET_DEFLATE
+#    if defined(CONFIG_MINIMAL_SYSTEM)
+#        define CONFIG_HTTP_WEBSOCKET_DEFLATE               0
+#    elif defined(ARCH_ESP32) || defined(ARCH_LINUX)
+#        define CONFIG_HTTP_WEBSOCKET_DEFLATE               1
+#    else
+#        define CONFIG_HTTP_WEBSOCKET_DEFLATE               0
+#    endif
+#endif
+
+/**
+ * Base two logarithm of the largest websocket permessage-deflate
+ * sliding window, 8 to 15. Both this end and the peer are asked to
+ * compress with at most this window. A smaller window uses less RAM
+ * with context takeover, but compresses less.
+ */
+#ifndef CONFIG_HTTP_WEBSOCKET_DEFLATE_WINDOW_BITS
+#    define CONFIG_HTTP_WEBSOCKET_DEFLATE_WINDOW_BITS      10
+#endif
+
+/**
+ * Keep the websocket permessage-deflate sliding windows between
+ * messages, so that a message may refer to data in earlier
+ * messages. This compresses short similar messages much better, but
+ * uses one window of ``1 <<
+ * CONFIG_HTTP_WEBSOCKET_DEFLATE_WINDOW_BITS`` bytes per direction
+ * in each websocket. Set to zero(0) to negotiate no context takeover
+ * in both directions and use no windows.
+ */
+#ifndef CONFIG_HTTP_WEBSOCKET_DEFLATE_CONTEXT_TAKEOVER
+#    define CONFIG_HTTP_WEBSOCKET_DEFLATE_CONTEXT_TAKEOVER  1
+#endif
+
+/**
+ * Maximum payload size of the frames a compressed websocket message
+ * is sent in. Longer messages are fragmented.
+ */
+#ifndef CONFIG_HTTP_WEBSOCKET_DEFLATE_FRAME_SIZE
+#    define CONFIG_HTTP_WEBSOCKET_DEFLATE_FRAME_SIZE      256
+#endif
+
+/**
+ * Maximum number of options in a decoded CoAP message.
+ */
+#ifndef CONFIG_COAP_OPTIONS_MAX
+#    define CONFIG_COAP_OPTIONS_MAX                        16
+#endif
+
+/**
+ * Size of the CoAP server input and output message buffers. A
+ * message is a few bytes of header and options followed by a block
+ * of the payload, see `CONFIG_COAP_SERVER_BLOCK_SZX`.
+ */
+#ifndef CONFIG_COAP_SERVER_MESSAGE_SIZE_MAX
+#    define CONFIG_COAP_SERVER_MESSAGE_SIZE_MAX           320
+#endif
+
+/**
+ * Largest response payload of a CoAP server route. Responses larger
+ * than a block are sent block-wise as in RFC 7959.
+ */
+#ifndef CONFIG_COAP_SERVER_PAYLOAD_MAX
+#    define CONFIG_COAP_SERVER_PAYLOAD_MAX                512
+#endif
+
+/**
+ * Largest CoAP server block size as a size exponent, where the block
+ * size is 2^(4 + szx) bytes. The default 4 is 256 byte blocks.
+ */
+#ifndef CONFIG_COAP_SERVER_BLOCK_SZX
+#    define CONFIG_COAP_SERVER_BLOCK_SZX                    4
+#endif
+
+/**
+ * Maximum number of clients observing CoAP server resources.
+ */
+#ifndef CONFIG_COAP_SERVER_OBSERVERS_MAX
+#    define CONFIG_COAP_SERVER_OBSERVERS_MAX                4
+#endif
+
+/**
+ * Size of the longest CoAP server request path, including the null
+ * termination.
+ */
+#ifndef CONFIG_COAP_SERVER_PATH_MAX
+#    define CONFIG_COAP_SERVER_PATH_MAX                    32
+#endif
+
+/**
+ * Size of the CoAP client input and output message buffers.
+ */
+#ifndef CONFIG_COAP_CLIENT_MESSAGE_SIZE_MAX
+#    define CONFIG_COAP_CLIENT_MESSAGE_SIZE_MAX           320
+#endif
+
+/**
+ * Initial CoAP client wait for an acknowledgement before a
+ * confirmable request is retransmitted. The wait is doubled for each
+ * retransmission.
+ */
+#ifndef CONFIG_COAP_CLIENT_ACK_TIMEOUT_MS
+#    define CONFIG_COAP_CLIENT_ACK_TIMEOUT_MS            2000
+#endif
+
+/**
+ * Maximum number of retransmissions of a confirmable CoAP client
+ * request.
+ */
+#ifndef CONFIG_COAP_CLIENT_MAX_RETRANSMIT
+#    define CONFIG_COAP_CLIENT_MAX_RETRANSMIT               4
+#endif
+
+/**
+ * Size of the MQTT-SN client input and output message buffers.
+ */
+#ifndef CONFIG_MQTT_SN_CLIENT_MESSAGE_SIZE_MAX
+#    define CONFIG_MQTT_SN_CLIENT_MESSAGE_SIZE_MAX        128
+#endif
+
+/**
+ * MQTT-SN client wait for a response before a request is
+ * retransmitted.
+ */
+#ifndef CONFIG_MQTT_SN_CLIENT_RETRY_TIMEOUT_MS
+#    define CONFIG_MQTT_SN_CLIENT_RETRY_TIMEOUT_MS      10000
+#endif
+
+/**
+ * Maximum number of retransmissions of a MQTT-SN client request.
+ */
+#ifndef CONFIG_MQTT_SN_CLIENT_RETRY_MAX
+#    define CONFIG_MQTT_SN_CLIENT_RETRY_MAX                 3
+#endif
+
+/**
+ * Largest block size in bytes the TFTP server accepts in the blksize
+ * option of RFC 2348. Clients asking for more get this size. The
+ * server thread stack must fit a buffer of this size, so keep the
+ * default 512 bytes of the protocol on small targets. 1428 bytes fill
+ * an ethernet frame.
+ */
+#ifndef CONFIG_TFTP_SERVER_BLKSIZE_MAX
+#    define CONFIG_TFTP_SERVER_BLKSIZE_MAX                512
+#endif
+
+/**
+ * Largest number of blocks the TFTP server accepts in the windowsize
+ * option of RFC 7440, that is, the number of data packets sent or
+ * received per acknowledgement. Blocks are read from or written to
+ * the file one at a time, so a larger window costs no memory.
+ */
+#ifndef CONFIG_TFTP_SERVER_WINDOWSIZE_MAX
+#    define CONFIG_TFTP_SERVER_WINDOWSIZE_MAX              16
+#endif
+
+/**
+ * Sleep in the test harness before executing the first testcase.
+ */
+#ifndef CONFIG_HARNESS_SLEEP_MS
 #    define CONFIG_HARNESS_SLEEP_MS                       300
 #endif
 
@@ -2529,6 +4022,31 @@
 #    endif
 #endif
 
+/**
+ * Number of hash buckets the mock entries are indexed by, by id.
+ */
+#ifndef CONFIG_HARNESS_MOCK_BUCKETS_MAX
+#    if defined(BOARD_ARDUINO_NANO) || defined(BOARD_ARDUINO_UNO) || defined(BOARD_ARDUINO_PRO_MICRO)
+#        define CONFIG_HARNESS_MOCK_BUCKETS_MAX             1
+#    elif defined(ARCH_LINUX) || defined(ARCH_ARM64)
+#        define CONFIG_HARNESS_MOCK_BUCKETS_MAX           256
+#    else
+#        define CONFIG_HARNESS_MOCK_BUCKETS_MAX            16
+#    endif
+#endif
+
+/**
+ * Allocate mock entries with malloc() once the mock heap of
+ * ``CONFIG_HARNESS_MOCK_ENTRIES_MAX`` entries is full.
+ */
+#ifndef CONFIG_HARNESS_MOCK_MALLOC
+#    if defined(ARCH_LINUX)
+#        define CONFIG_HARNESS_MOCK_MALLOC                  1
+#    else
+#        define CONFIG_HARNESS_MOCK_MALLOC                  0
+#    endif
+#endif
+
 /**
  * Call sys_exit() immediately on test failure to stop the test suite
  * execution as early as possible.
@@ -2544,6 +4062,63 @@
 #    define CONFIG_HARNESS_DEBUG                            0
 #endif
 
+/**
+ * Enable harness_run_benchmarks(), timed with the cycle counter of
+ * the CPU.
+ */
+#ifndef CONFIG_HARNESS_BENCHMARK
+#    define CONFIG_HARNESS_BENCHMARK                        0
+#endif
+
+/**
+ * Number of samples measured per benchmark.
+ */
+#ifndef CONFIG_HARNESS_BENCHMARK_SAMPLES
+#    define CONFIG_HARNESS_BENCHMARK_SAMPLES               32
+#endif
+
+/**
+ * Minimum number of cycles per benchmark sample. The number of
+ * iterations per sample is increased until a sample takes at least
+ * this many cycles.
+ */
+#ifndef CONFIG_HARNESS_BENCHMARK_SAMPLE_CYCLES_MIN
+#    define CONFIG_HARNESS_BENCHMARK_SAMPLE_CYCLES_MIN  10000
+#endif
+
+/**
+ * Maximum number of iterations per benchmark sample.
+ */
+#ifndef CONFIG_HARNESS_BENCHMARK_ITERATIONS_MAX
+#    define CONFIG_HARNESS_BENCHMARK_ITERATIONS_MAX   1048576
+#endif
+
+/**
+ * Maximum number of connections an HTTP client keeps open to
+ * servers. The least recently used connection is closed when a new
+ * server is requested.
+ */
+#ifndef CONFIG_HTTP_CLIENT_CONNECTIONS_MAX
+#    define CONFIG_HTTP_CLIENT_CONNECTIONS_MAX              2
+#endif
+
+/**
+ * Maximum length of a host name in an HTTP client request,
+ * including null termination.
+ */
+#ifndef CONFIG_HTTP_CLIENT_HOST_MAX
+#    define CONFIG_HTTP_CLIENT_HOST_MAX                    64
+#endif
+
+/**
+ * Size of the per connection HTTP client read-ahead buffer, and of
+ * the buffer used to parse each response header line. Longer header
+ * lines are truncated.
+ */
+#ifndef CONFIG_HTTP_CLIENT_BUFFER_SIZE
+#    define CONFIG_HTTP_CLIENT_BUFFER_SIZE                128
+#endif
+
 /**
  * Size of the HTTP server request buffer. This buffer is used when
  * parsing received HTTP request headers.
@@ -2552,6 +4127,71 @@
 #    define CONFIG_HTTP_SERVER_REQUEST_BUFFER_SIZE        128
 #endif
 
+/**
+ * Size of the per connection HTTP server read-ahead buffer. Received
+ * data is read into this buffer in chunks, as much as is available
+ * in the socket, to avoid one socket read per request byte.
+ */
+#ifndef CONFIG_HTTP_SERVER_READ_AHEAD_SIZE
+#    define CONFIG_HTTP_SERVER_READ_AHEAD_SIZE            128
+#endif
+
+/**
+ * Maximum number of requests served on a persistent (keep-alive) HTTP
+ * server connection before it is closed. Set to one(1) to close the
+ * connection after each request.
+ */
+#ifndef CONFIG_HTTP_SERVER_KEEP_ALIVE_MAX_REQUESTS
+#    define CONFIG_HTTP_SERVER_KEEP_ALIVE_MAX_REQUESTS    100
+#endif
+
+/**
+ * Time in milliseconds a persistent HTTP server connection waits for
+ * the next request before it is closed. Idle connections are also
+ * closed when a new client is waiting for a connection thread.
+ */
+#ifndef CONFIG_HTTP_SERVER_KEEP_ALIVE_TIMEOUT_MS
+#    define CONFIG_HTTP_SERVER_KEEP_ALIVE_TIMEOUT_MS      5000
+#endif
+
+/**
+ * Size of the chunks static files are streamed from the file system
+ * in by the HTTP server. The buffer is allocated on the connection
+ * thread stack.
+ */
+#ifndef CONFIG_HTTP_SERVER_STATIC_CHUNK_SIZE
+#    define CONFIG_HTTP_SERVER_STATIC_CHUNK_SIZE          256
+#endif
+
+/**
+ * Number of nodes in the HTTP server route index, a trie of route
+ * path segments built by `http_server_init()`. Routes are searched
+ * linearly if the trie does not fit. Set to zero(0) to always search
+ * linearly.
+ */
+#ifndef CONFIG_HTTP_SERVER_ROUTE_NODES_MAX
+#    if defined(CONFIG_MINIMAL_SYSTEM)
+#        define CONFIG_HTTP_SERVER_ROUTE_NODES_MAX            0
+#    else
+#        define CONFIG_HTTP_SERVER_ROUTE_NODES_MAX           32
+#    endif
+#endif
+
+/**
+ * Maximum number of path parameters captured by a HTTP server route.
+ */
+#ifndef CONFIG_HTTP_SERVER_ROUTE_PARAMS_MAX
+#    define CONFIG_HTTP_SERVER_ROUTE_PARAMS_MAX             2
+#endif
+
+/**
+ * Size of a captured HTTP server route path parameter value,
+ * including the null termination. Longer values are truncated.
+ */
+#ifndef CONFIG_HTTP_SERVER_ROUTE_PARAM_SIZE
+#    define CONFIG_HTTP_SERVER_ROUTE_PARAM_SIZE            16
+#endif
+
 /**
  * Use lookup tables for CRC calculations. It is faster, but uses more
  * memory.
@@ -2560,6 +4200,90 @@
 #    define CONFIG_CRC_TABLE_LOOKUP                         1
 #endif
 
+/**
+ * Number of bytes `crc_32()` processes per iteration using lookup
+ * tables, 1, 4 or 8. Slicing-by-4 and slicing-by-8 are three to five
+ * times faster than one byte per iteration, but use 3 kB and 7 kB
+ * more lookup tables. Only used if ``CONFIG_CRC_TABLE_LOOKUP`` is
+ * enabled.
+ */
+#ifndef CONFIG_CRC_32_SLICES
+#    define CONFIG_CRC_32_SLICES                            1
+#endif
+
+/**
+ * Calculate `crc_32()` using hardware, if available: the CRC32
+ * instructions on ARMv8 (arm64), which are optional in ARMv8.0, and
+ * the CRC calculation unit on STM32F1 and STM32F2.
+ */
+#ifndef CONFIG_CRC_HARDWARE
+#    define CONFIG_CRC_HARDWARE                             0
+#endif
+
+/**
+ * Use a 8 kB lookup table in `base64_encode()` to encode 12 bits of
+ * input to two characters at a time, instead of a 64 bytes table.
+ */
+#ifndef CONFIG_BASE64_ENCODE_TABLE_16
+#    define CONFIG_BASE64_ENCODE_TABLE_16                   0
+#endif
+
+/**
+ * Base two logarithm of the number of entries in the hash table a
+ * deflate encoder finds matches with. Each entry uses two bytes of
+ * RAM in ``struct deflate_encoder_t``.
+ */
+#ifndef CONFIG_DEFLATE_ENCODER_HASH_BITS
+#    define CONFIG_DEFLATE_ENCODER_HASH_BITS                8
+#endif
+
+/**
+ * Use a 512 bytes lookup table in `hex_from_bin()` to convert one
+ * byte to two characters at a time, instead of a 16 bytes table.
+ */
+#ifndef CONFIG_HEX_FROM_BIN_TABLE_16
+#    if defined(CONFIG_MINIMAL_SYSTEM) || defined(ARCH_AVR)
+#        define CONFIG_HEX_FROM_BIN_TABLE_16                0
+#    else
+#        define CONFIG_HEX_FROM_BIN_TABLE_16                1
+#    endif
+#endif
+
+/**
+ * Maximum number of events a MIDI parser gives to its events
+ * callback at a time. Each event uses three bytes of RAM in ``struct
+ * midi_parser_t``.
+ */
+#ifndef CONFIG_MIDI_PARSER_EVENTS_MAX
+#    define CONFIG_MIDI_PARSER_EVENTS_MAX                  8
+#endif
+
+/**
+ * Maximum size of the SysEx data chunks a MIDI parser gives to its
+ * SysEx callback.
+ */
+#ifndef CONFIG_MIDI_PARSER_SYSEX_CHUNK_SIZE
+#    define CONFIG_MIDI_PARSER_SYSEX_CHUNK_SIZE            32
+#endif
+
+/**
+ * Number of voices in a mixer, that is, the maximum number of notes
+ * played at the same time. Each voice uses 32 bytes of RAM in
+ * ``struct mixer_t``.
+ */
+#ifndef CONFIG_MIXER_VOICES_MAX
+#    define CONFIG_MIXER_VOICES_MAX                        16
+#endif
+
+/**
+ * Number of samples a mixer renders per voice at a time. Voice states
+ * are loaded and stored once per block, so longer blocks are faster,
+ * but use four bytes of RAM per sample in ``struct mixer_t``.
+ */
+#ifndef CONFIG_MIXER_BLOCK_LENGTH
+#    define CONFIG_MIXER_BLOCK_LENGTH                      64
+#endif
+
 /**
  */
 #ifndef CONFIG_SPC5_BOOT_ENTRY_RCHW
@@ -2584,6 +4308,78 @@
 #    define CONFIG_SPC5_WATCHDOG_DISABLE                    1
 #endif
 
+/**
+ * Enable the MMU and the data and instruction caches on the Xvisor
+ * Virt-v8 at startup. The RAM and the flash are mapped as normal
+ * write-back cacheable memory and the peripherals as device
+ * memory.
+ */
+#ifndef CONFIG_XVISOR_VIRT_V8_MMU
+#    define CONFIG_XVISOR_VIRT_V8_MMU                       1
+#endif
+
+/**
+ * Minimum SNTP client poll interval in seconds.
+ */
+#ifndef CONFIG_SNTP_CLIENT_POLL_INTERVAL_MIN
+#    define CONFIG_SNTP_CLIENT_POLL_INTERVAL_MIN            64
+#endif
+
+/**
+ * Maximum SNTP client poll interval in seconds.
+ */
+#ifndef CONFIG_SNTP_CLIENT_POLL_INTERVAL_MAX
+#    define CONFIG_SNTP_CLIENT_POLL_INTERVAL_MAX            1024
+#endif
+
+/**
+ * Offset in milliseconds below which the SNTP client doubles the
+ * poll interval, and above which it halves it.
+ */
+#ifndef CONFIG_SNTP_CLIENT_POLL_OFFSET_THRESHOLD_MS
+#    define CONFIG_SNTP_CLIENT_POLL_OFFSET_THRESHOLD_MS     16
+#endif
+
+/**
+ * Offset in milliseconds above which the SNTP client sets the time
+ * instead of gradually adjusting it.
+ */
+#ifndef CONFIG_SNTP_CLIENT_STEP_THRESHOLD_MS
+#    define CONFIG_SNTP_CLIENT_STEP_THRESHOLD_MS            128
+#endif
+
+/**
+ * SNTP client thread response timeout in milliseconds.
+ */
+#ifndef CONFIG_SNTP_CLIENT_TIMEOUT_MS
+#    define CONFIG_SNTP_CLIENT_TIMEOUT_MS                   3000
+#endif
+
+/**
+ * Gradual time adjustment with `time_adjust()`. Makes `time_get()`
+ * take the system lock.
+ */
+#ifndef CONFIG_TIME_ADJUST
+#    define CONFIG_TIME_ADJUST                              1
+#endif
+
+/**
+ * Maximum time adjustment rate of `time_adjust()`, in microseconds
+ * per second. The default 500 is the maximum slew rate of NTP.
+ */
+#ifndef CONFIG_TIME_ADJUST_RATE_PPM
+#    define CONFIG_TIME_ADJUST_RATE_PPM                     500
+#endif
+
+/**
+ * A 64 bits cycle counter and monotonic microseconds clock, see
+ * `time_cycles()` and `time_monotonic_us()`. Adds a counter read to
+ * each system tick.
+ */
+#ifndef CONFIG_TIME_CYCLES
+#    define CONFIG_TIME_CYCLES                              0
+#endif
+
 /**
  * Include the function time_unix_time_to_date().
  */
@@ -2591,6 +4387,18 @@
 #    define CONFIG_TIME_UNIX_TIME_TO_DATE                   1
 #endif
 
+/**
+ * Include the cached time formatting functions, for example
+ * time_format_rfc1123(), and use them in the log and FAT16 modules.
+ */
+#ifndef CONFIG_TIME_FORMAT
+#    if defined(CONFIG_MINIMAL_SYSTEM) || defined(ARCH_AVR)
+#        define CONFIG_TIME_FORMAT                          0
+#    else
+#        define CONFIG_TIME_FORMAT                          1
+#    endif
+#endif
+
 /**
  * Embed the SOAM database in the application.
  */
@@ -2631,6 +4439,24 @@
 #    endif
 #endif
 
+/**
+ * Measure the number of cycles each module initialization and start
+ * step in `sys_start()` takes. They are printed by
+ * `sys_start_print()` and the ``/kernel/sys/start`` file system
+ * command.
+ */
+#ifndef CONFIG_SYS_START_TIMES
+#    define CONFIG_SYS_START_TIMES                          0
+#endif
+
+/**
+ * Maximum number of measured startup steps. Steps after the limit
+ * are not measured.
+ */
+#ifndef CONFIG_SYS_START_TIMES_MAX
+#    define CONFIG_SYS_START_TIMES_MAX                     48
+#endif
+
 /**
  * The external oscillator frequency in Hertz.
  */
@@ -2669,6 +4495,75 @@
 #    define CONFIG_EEPROM_SOFT_OVERWRITE_IDENTICAL_DATA     0
 #endif
 
+/**
+ * Number of 512 bytes blocks in the FAT16 block cache. FAT,
+ * directory and data blocks are kept in the cache at the same time if
+ * it has at least three blocks, so appending to a file does not write
+ * and re-read the same FAT and directory blocks for every data block.
+ */
+#ifndef CONFIG_FAT16_CACHE_BLOCKS
+#    if defined(ARCH_AVR)
+#        define CONFIG_FAT16_CACHE_BLOCKS                   1
+#    else
+#        define CONFIG_FAT16_CACHE_BLOCKS                   4
+#    endif
+#endif
+
+/**
+ * FAT32 volume support in the FAT16 module. FAT entries are 32 bits
+ * wide if enabled.
+ */
+#ifndef CONFIG_FAT16_FAT32
+#    if defined(ARCH_AVR)
+#        define CONFIG_FAT16_FAT32                          0
+#    else
+#        define CONFIG_FAT16_FAT32                          1
+#    endif
+#endif
+
+/**
+ * Size in bytes of the in-RAM free cluster bitmap in the FAT16
+ * module. Each bit tells if a cluster in a window of the FAT is free,
+ * so searching for free clusters does not read the FAT entry by
+ * entry. Set to zero(0) to disable the bitmap.
+ */
+#ifndef CONFIG_FAT16_FREE_BITMAP_SIZE
+#    if defined(ARCH_AVR)
+#        define CONFIG_FAT16_FREE_BITMAP_SIZE               0
+#    else
+#        define CONFIG_FAT16_FREE_BITMAP_SIZE               64
+#    endif
+#endif
+
+/**
+ * FAT16 block cache hit, miss and write counters in the debug file
+ * system.
+ */
+#ifndef CONFIG_FAT16_CACHE_COUNTERS
+#    if defined(CONFIG_MINIMAL_SYSTEM)
+#        define CONFIG_FAT16_CACHE_COUNTERS                 0
+#    else
+#        define CONFIG_FAT16_CACHE_COUNTERS                 1
+#    endif
+#endif
+
+/**
+ * Derived, do not set. One(1) if any module reads the thrd port cycle
+ * counter, which is then started and included.
+ */
+#if (CONFIG_THRD_CYCLES == 1)                                           \
+    || (CONFIG_TRACE == 1)                                              \
+    || (CONFIG_LOCK_STATS == 1)                                         \
+    || (CONFIG_EXTI_CAPTURE == 1)                                       \
+    || (CONFIG_HARNESS_BENCHMARK == 1)                                  \
+    || (CONFIG_SYS_START_TIMES == 1)                                    \
+    || (CONFIG_ISR_STATS == 1)                                          \
+    || (CONFIG_TIME_CYCLES == 1)
+#    define CONFIG_THRD_CYCLES_NEEDED                       1
+#else
+#    define CONFIG_THRD_CYCLES_NEEDED                       0
+#endif
+
 /**
  * Configuration validation.
  */
@@ -2684,4 +4579,16 @@
 #    error "CONFIG_START_SHELL and CONFIG_START_SOAM cannot both be set to 1."
 #endif
 
+#if (CONFIG_TIME_FORMAT == 1) && (CONFIG_TIME_UNIX_TIME_TO_DATE == 0)
+#    error "CONFIG_TIME_FORMAT requires CONFIG_TIME_UNIX_TIME_TO_DATE."
+#endif
+
+#if (CONFIG_TIMER_WHEEL == 1) && ((CONFIG_TIMER_WHEEL_SIZE & (CONFIG_TIMER_WHEEL_SIZE - 1)) != 0)
+#    error "CONFIG_TIMER_WHEEL_SIZE must be a power of two."
+#endif
+
+#if (CONFIG_CIRCULAR_BUFFER_MIRROR == 1) && !defined(ARCH_LINUX)
+#    error "CONFIG_CIRCULAR_BUFFER_MIRROR is only supported on Linux."
+#endif
+
 #endif
@@ -34,6 +34,10 @@
 #    define DPRINT(fmt, ...)
 #endif
 
+#if CONFIG_HARNESS_BENCHMARK == 1
+extern uint32_t thrd_cycles_get_isr(void);
+#endif
+
 /* A rough estimate of the average mock entry size, including heap
    allocation overhead. */
 #define MOCK_ENTRY_SIZE (sizeof(struct mock_entry_t) + 8 * sizeof(void *))
@@ -41,9 +45,10 @@
 #define HEAP_SIZE (MOCK_ENTRY_SIZE * CONFIG_HARNESS_MOCK_ENTRIES_MAX)
 
 struct mock_entry_t {
-    struct list_elem_t base;
-    struct entry_t *next_p;
+    struct mock_entry_t *next_p;
     const char *id_p;
+    uint32_t hash;
+    struct mock_entry_cb_t *cb_p;
 #if CONFIG_HARNESS_WRITE_BACKTRACE_DEPTH_MAX > 0
     struct {
         void *array[CONFIG_HARNESS_WRITE_BACKTRACE_DEPTH_MAX];
@@ -57,20 +62,23 @@ struct mock_entry_t {
 };
 
 struct mock_entry_cb_t {
-    struct list_elem_t base;
-    struct mock_entry_t *entry_p;
     harness_mock_cb_t fn;
     char arg[1];
 };
 
+/* Entries with the same hash, in insertion order. */
+struct mock_bucket_t {
+    struct mock_entry_t *head_p;
+    struct mock_entry_t *tail_p;
+};
+
 struct module_t {
     struct {
         struct heap_t obj;
         uint8_t buf[HEAP_SIZE];
     } heap;
     struct {
-        struct list_t list;
-        struct list_t cb_list;
+        struct mock_bucket_t buckets[CONFIG_HARNESS_MOCK_BUCKETS_MAX];
     } mock;
     struct mutex_t mutex;
     struct bus_t bus;
@@ -175,44 +183,106 @@ static int mock_entry_print_write_backtrace(struct mock_entry_t *entry_p)
 
 #endif
 
-static struct mock_entry_cb_t *alloc_mock_entry_cb(size_t size)
+/**
+ * Allocate from the mock heap, and from the system heap once the
+ * mock heap is full.
+ */
+static void *mock_alloc_no_lock(size_t size)
 {
-    struct mock_entry_cb_t *entry_cb_p;
+    void *buf_p;
 
-    mutex_lock(&module.mutex);
-    entry_cb_p = heap_alloc(&module.heap.obj,
-                            sizeof(*entry_cb_p) + size - 1);
-    mutex_unlock(&module.mutex);
+    buf_p = heap_alloc(&module.heap.obj, size);
 
-    return (entry_cb_p);
+#if CONFIG_HARNESS_MOCK_MALLOC == 1
+    if (buf_p == NULL) {
+        buf_p = malloc(size);
+    }
+#endif
+
+    return (buf_p);
 }
 
-static int free_mock_entry_cb_no_lock(struct mock_entry_cb_t *entry_cb_p)
+static void mock_free_no_lock(void *buf_p)
 {
-    heap_free(&module.heap.obj, entry_cb_p);
+#if CONFIG_HARNESS_MOCK_MALLOC == 1
+    if (((uint8_t *)buf_p < &module.heap.buf[0])
+        || ((uint8_t *)buf_p >= &module.heap.buf[sizeof(module.heap.buf)])) {
+        free(buf_p);
 
-    return (0);
+        return;
+    }
+#endif
+
+    heap_free(&module.heap.obj, buf_p);
 }
 
-static struct mock_entry_cb_t *find_mock_entry_cb(struct mock_entry_t *entry_p)
+/**
+ * 32 bits FNV-1a hash of given mock id.
+ */
+static uint32_t mock_hash(const char *id_p)
 {
-    struct list_iter_t iter;
-    struct mock_entry_cb_t *entry_cb_p;
+    uint32_t hash;
 
-    list_iter_init(&iter, &module.mock.cb_list);
+    hash = 2166136261UL;
 
-    while (1) {
-        entry_cb_p = (struct mock_entry_cb_t *)list_iter_next(&iter);
+    while (*id_p != '\0') {
+        hash ^= (uint8_t)*id_p++;
+        hash *= 16777619UL;
+    }
 
-        if (entry_cb_p == NULL) {
-            break;
-        }
+    return (hash);
+}
 
-        if (entry_cb_p->entry_p == entry_p) {
-            list_remove(&module.mock.cb_list, entry_cb_p);
-            break;
-        }
+static struct mock_bucket_t *mock_bucket(uint32_t hash)
+{
+    return (&module.mock.buckets[hash % CONFIG_HARNESS_MOCK_BUCKETS_MAX]);
+}
+
+static void add_mock_entry_no_lock(struct mock_entry_t *entry_p)
+{
+    struct mock_bucket_t *bucket_p;
+
+    bucket_p = mock_bucket(entry_p->hash);
+    entry_p->next_p = NULL;
+
+    if (bucket_p->tail_p == NULL) {
+        bucket_p->head_p = entry_p;
+    } else {
+        bucket_p->tail_p->next_p = entry_p;
+    }
+
+    bucket_p->tail_p = entry_p;
+}
+
+static void add_mock_entry(struct mock_entry_t *entry_p)
+{
+    mutex_lock(&module.mutex);
+    add_mock_entry_no_lock(entry_p);
+    mutex_unlock(&module.mutex);
+}
+
+static void remove_mock_entry_no_lock(struct mock_bucket_t *bucket_p,
+                                      struct mock_entry_t *prev_p,
+                                      struct mock_entry_t *entry_p)
+{
+    if (prev_p == NULL) {
+        bucket_p->head_p = entry_p->next_p;
+    } else {
+        prev_p->next_p = entry_p->next_p;
+    }
+
+    if (bucket_p->tail_p == entry_p) {
+        bucket_p->tail_p = prev_p;
     }
+}
+
+static struct mock_entry_cb_t *alloc_mock_entry_cb(size_t size)
+{
+    struct mock_entry_cb_t *entry_cb_p;
+
+    mutex_lock(&module.mutex);
+    entry_cb_p = mock_alloc_no_lock(sizeof(*entry_cb_p) + size - 1);
+    mutex_unlock(&module.mutex);
 
     return (entry_cb_p);
 }
@@ -224,11 +294,11 @@ static struct mock_entry_t *alloc_mock_entry_no_lock(const char *id_p,
 
     DPRINT("Allocating mock entry for id '%s'.\r\n", id_p);
 
-    entry_p = heap_alloc(&module.heap.obj,
-                         sizeof(*entry_p) + size - 1);
+    entry_p = mock_alloc_no_lock(sizeof(*entry_p) + size - 1);
 
     if (entry_p != NULL) {
         entry_p->id_p = id_p;
+        entry_p->cb_p = NULL;
     }
 
     return (entry_p);
@@ -251,7 +321,7 @@ static int free_mock_entry(struct mock_entry_t *entry_p)
     DPRINT("Freeing mock entry with id '%s'.\r\n", entry_p->id_p);
 
     mutex_lock(&module.mutex);
-    heap_free(&module.heap.obj, entry_p);
+    mock_free_no_lock(entry_p);
     mutex_unlock(&module.mutex);
 
     return (0);
@@ -264,34 +334,39 @@ static struct mock_entry_t *copy_mock_entry_no_lock(struct mock_entry_t *entry_p
     copy_p = alloc_mock_entry_no_lock(entry_p->id_p,
                                       entry_p->data.size);
     memcpy(copy_p, entry_p, sizeof(*entry_p) + entry_p->data.size - 1);
+    copy_p->cb_p = NULL;
 
     return (copy_p);
 }
 
+/**
+ * Find the oldest mock entry with given id. Entries are hashed by id
+ * and each hash bucket is kept in insertion order.
+ */
 static struct mock_entry_t *find_mock_entry(const char *id_p)
 {
-    struct list_iter_t iter;
+    struct mock_bucket_t *bucket_p;
+    struct mock_entry_t *prev_p;
     struct mock_entry_t *entry_p;
     struct mock_entry_t *new_entry_p;
     struct mock_entry_cb_t *entry_cb_p;
+    uint32_t hash;
     int res;
 
-    mutex_lock(&module.mutex);
+    hash = mock_hash(id_p);
 
-    list_iter_init(&iter, &module.mock.list);
-
-    while (1) {
-        entry_p = (struct mock_entry_t *)list_iter_next(&iter);
+    mutex_lock(&module.mutex);
 
-        if (entry_p == NULL) {
-            break;
-        }
+    bucket_p = mock_bucket(hash);
+    prev_p = NULL;
+    entry_p = bucket_p->head_p;
 
-        if (strcmp(entry_p->id_p, id_p) == 0) {
-            entry_cb_p = find_mock_entry_cb(entry_p);
+    while (entry_p != NULL) {
+        if ((entry_p->hash == hash) && (strcmp(entry_p->id_p, id_p) == 0)) {
+            entry_cb_p = entry_p->cb_p;
 
             if (entry_cb_p == NULL) {
-                list_remove(&module.mock.list, entry_p);
+                remove_mock_entry_no_lock(bucket_p, prev_p, entry_p);
             } else {
                 /* Make a copy of the mock entry since the mock
                    callback may modify it. */
@@ -302,10 +377,9 @@ static struct mock_entry_t *find_mock_entry(const char *id_p)
                                      &new_entry_p->data.size);
 
                 if (res == 1) {
-                    list_remove(&module.mock.list, entry_p);
-                    free_mock_entry_cb_no_lock(entry_cb_p);
-                } else {
-                    list_add_tail(&module.mock.cb_list, entry_cb_p);
+                    remove_mock_entry_no_lock(bucket_p, prev_p, entry_p);
+                    mock_free_no_lock(entry_cb_p);
+                    mock_free_no_lock(entry_p);
                 }
 
                 entry_p = new_entry_p;
@@ -313,6 +387,9 @@ static struct mock_entry_t *find_mock_entry(const char *id_p)
 
             break;
         }
+
+        prev_p = entry_p;
+        entry_p = entry_p->next_p;
     }
 
     mutex_unlock(&module.mutex);
@@ -320,6 +397,42 @@ static struct mock_entry_t *find_mock_entry(const char *id_p)
     return (entry_p);
 }
 
+/**
+ * Remove all unread mock entries and free them. Returns -1 if any
+ * entry was found.
+ */
+static int flush_mock_entries(void)
+{
+    struct mock_bucket_t *bucket_p;
+    struct mock_entry_t *entry_p;
+    int res;
+    int i;
+
+    res = 0;
+
+    for (i = 0; i < membersof(module.mock.buckets); i++) {
+        bucket_p = &module.mock.buckets[i];
+
+        while (bucket_p->head_p != NULL) {
+            entry_p = bucket_p->head_p;
+            bucket_p->head_p = entry_p->next_p;
+            std_printf(OSTR("Found unread mock id '%s'. Failing test.\r\n"),
+                       entry_p->id_p);
+            res = -1;
+
+            if (entry_p->cb_p != NULL) {
+                mock_free_no_lock(entry_p->cb_p);
+            }
+
+            mock_free_no_lock(entry_p);
+        }
+
+        bucket_p->tail_p = NULL;
+    }
+
+    return (res);
+}
+
 static int read_mock_entry(struct mock_entry_t *entry_p,
                            const char *id_p,
                            void *buf_p,
@@ -419,6 +532,7 @@ static ssize_t create_mock_entry(const char *id_p,
     }
 
     entry_p->data.size = size;
+    entry_p->hash = mock_hash(id_p);
     mock_entry_create_write_backtrace(entry_p);
 
     *entry_pp = entry_p;
@@ -474,7 +588,6 @@ int harness_run(struct harness_testcase_t *testcases_p)
 {
     int err;
     struct harness_testcase_t *testcase_p;
-    struct mock_entry_t *entry_p;
     size_t sizes[HEAP_FIXED_SIZES_MAX] = {
         8, 16, 32, 32, 32, 32, 32, 32
     };
@@ -501,9 +614,6 @@ int harness_run(struct harness_testcase_t *testcases_p)
     while (testcase_p->callback != NULL) {
         /* Reinitialize the heap before every testcase for minimal
            memory usage. */
-        list_init(&module.mock.list);
-        list_init(&module.mock.cb_list);
-
         heap_init(&module.heap.obj,
                   &module.heap.buf[0],
                   sizeof(module.heap.buf),
@@ -516,15 +626,13 @@ int harness_run(struct harness_testcase_t *testcases_p)
 
         err = testcase_p->callback();
 
-        do {
-            entry_p = (struct mock_entry_t *)list_remove_head(&module.mock.list);
+        mutex_lock(&module.mutex);
 
-            if (entry_p != NULL) {
-                std_printf(OSTR("Found unread mock id '%s'. Failing test.\r\n"),
-                           entry_p->id_p);
-                err = -1;
-            }
-        } while (entry_p != NULL);
+        if (flush_mock_entries() != 0) {
+            err = -1;
+        }
+
+        mutex_unlock(&module.mutex);
 
         if ((err < 0) || (harness_get_testcase_result() == -1)) {
             module.failed++;
@@ -557,6 +665,156 @@ int harness_run(struct harness_testcase_t *testcases_p)
     return (print_report_and_stop());
 }
 
+#if CONFIG_HARNESS_BENCHMARK == 1
+
+/**
+ * Call given benchmark callback and return the number of cycles it
+ * took.
+ */
+static uint32_t benchmark_measure(struct harness_benchmark_t *benchmark_p,
+                                  int iterations,
+                                  int *res_p)
+{
+    uint32_t start;
+
+    start = thrd_cycles_get_isr();
+    *res_p = benchmark_p->callback(iterations);
+
+    return (thrd_cycles_get_isr() - start);
+}
+
+/**
+ * Cycles per iteration in thousandths of a cycle.
+ */
+static uint32_t benchmark_per_iteration(uint32_t elapsed, int iterations)
+{
+    uint64_t value;
+
+    value = (((uint64_t)elapsed * 1000) / iterations);
+
+    if (value > UINT32_MAX) {
+        value = UINT32_MAX;
+    }
+
+    return ((uint32_t)value);
+}
+
+/**
+ * Warm up, find the number of iterations per sample and then measure
+ * all samples, sorted in ascending order.
+ */
+static int benchmark_run(struct harness_benchmark_t *benchmark_p,
+                         uint32_t *samples_p,
+                         int *iterations_p)
+{
+    uint32_t elapsed;
+    uint32_t sample;
+    int iterations;
+    int res;
+    int i;
+    int j;
+
+    /* Double the number of iterations until a sample is long enough
+       to be measured. This also warms up caches and branch
+       predictors. */
+    iterations = 1;
+
+    while (1) {
+        elapsed = benchmark_measure(benchmark_p, iterations, &res);
+
+        if (res != 0) {
+            return (res);
+        }
+
+        if ((elapsed >= CONFIG_HARNESS_BENCHMARK_SAMPLE_CYCLES_MIN)
+            || (iterations >= CONFIG_HARNESS_BENCHMARK_ITERATIONS_MAX)) {
+            break;
+        }
+
+        iterations *= 2;
+    }
+
+    for (i = 0; i < CONFIG_HARNESS_BENCHMARK_SAMPLES; i++) {
+        elapsed = benchmark_measure(benchmark_p, iterations, &res);
+
+        if (res != 0) {
+            return (res);
+        }
+
+        sample = benchmark_per_iteration(elapsed, iterations);
+
+        /* Insertion sort. */
+        for (j = i; (j > 0) && (samples_p[j - 1] > sample); j--) {
+            samples_p[j] = samples_p[j - 1];
+        }
+
+        samples_p[j] = sample;
+    }
+
+    *iterations_p = iterations;
+
+    return (0);
+}
+
+int harness_run_benchmarks(struct harness_benchmark_t *benchmarks_p)
+{
+    ASSERTN(benchmarks_p != NULL, EINVAL);
+
+    static uint32_t samples[CONFIG_HARNESS_BENCHMARK_SAMPLES];
+    struct harness_benchmark_t *benchmark_p;
+    uint32_t min;
+    uint32_t median;
+    uint32_t p99;
+    int iterations;
+    int res;
+    int err;
+
+    err = 0;
+    benchmark_p = benchmarks_p;
+
+    std_printf(OSTR("\r\n"));
+
+    while (benchmark_p->callback != NULL) {
+        res = benchmark_run(benchmark_p, &samples[0], &iterations);
+
+        if (res != 0) {
+            std_printf(OSTR("benchmark: %s: FAILED(%d)\r\n"),
+                       benchmark_p->name_p,
+                       res);
+            err = -1;
+        } else {
+            min = samples[0];
+            median = samples[CONFIG_HARNESS_BENCHMARK_SAMPLES / 2];
+            p99 = samples[((99 * CONFIG_HARNESS_BENCHMARK_SAMPLES + 99) / 100)
+                          - 1];
+            std_printf(OSTR("benchmark: %s: iterations(%d), "
+                            "min(%lu.%03lu), median(%lu.%03lu), "
+                            "p99(%lu.%03lu)\r\n"),
+                       benchmark_p->name_p,
+                       iterations,
+                       (unsigned long)(min / 1000),
+                       (unsigned long)(min % 1000),
+                       (unsigned long)(median / 1000),
+                       (unsigned long)(median % 1000),
+                       (unsigned long)(p99 / 1000),
+                       (unsigned long)(p99 % 1000));
+        }
+
+        benchmark_p++;
+    }
+
+    return (err);
+}
+
+#else
+
+int harness_run_benchmarks(struct harness_benchmark_t *benchmarks_p)
+{
+    return (-ENOSYS);
+}
+
+#endif
+
 int harness_expect(void *chan_p,
                    const char *pattern_p,
                    const struct time_t *timeout_p)
@@ -615,10 +873,7 @@ ssize_t harness_mock_write(const char *id_p,
         return (res);
     }
 
-    /* Add the entry at the end of the list. */
-    mutex_lock(&module.mutex);
-    list_add_tail(&module.mock.list, entry_p);
-    mutex_unlock(&module.mutex);
+    add_mock_entry(entry_p);
 
     return (res);
 }
@@ -672,17 +927,14 @@ ssize_t harness_mock_cwrite(const char *id_p,
     }
 
     /* Initiate the callback entry. */
-    entry_cb_p->entry_p = entry_p;
     entry_cb_p->fn = cb;
 
     if (arg_p != NULL) {
         memcpy(&entry_cb_p->arg[0], arg_p, arg_size);
     }
 
-    mutex_lock(&module.mutex);
-    list_add_tail(&module.mock.list, entry_p);
-    list_add_tail(&module.mock.cb_list, entry_cb_p);
-    mutex_unlock(&module.mutex);
+    entry_p->cb_p = entry_cb_p;
+    add_mock_entry(entry_p);
 
     return (size);
 }
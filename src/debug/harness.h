@@ -175,11 +175,24 @@ typedef int (*harness_mock_cb_t)(void *arg_p,
                                  void *buf_p,
                                  size_t *size_p);
 
+/**
+ * Benchmark callback that performs the benchmarked operation given
+ * number of times.
+ *
+ * @return zero(0) or negative error code.
+ */
+typedef int (*harness_benchmark_cb_t)(int iterations);
+
 struct harness_testcase_t {
     harness_testcase_cb_t callback;
     const char *name_p;
 };
 
+struct harness_benchmark_t {
+    harness_benchmark_cb_t callback;
+    const char *name_p;
+};
+
 /**
  * Run given testcases in the test harness.
  *
@@ -191,6 +204,26 @@ struct harness_testcase_t {
  */
 int harness_run(struct harness_testcase_t *testcases_p);
 
+/**
+ * Run given benchmarks. Increase the number of iterations per sample
+ * until a sample takes at least
+ * ``CONFIG_HARNESS_BENCHMARK_SAMPLE_CYCLES_MIN`` cycles, then measure
+ * ``CONFIG_HARNESS_BENCHMARK_SAMPLES`` samples. The minimum, median
+ * and 99th percentile cycles per iteration are printed on one line
+ * per benchmark, in the format ``bin/benchmark.py`` parses.
+ *
+ * The cycle counter is the one used by ``CONFIG_THRD_CYCLES``. It
+ * counts microseconds on Linux.
+ *
+ * @param[in] benchmarks_p An array of benchmarks to run. The last
+ *                         element in the array must have ``callback``
+ *                         and ``name_p`` set to NULL.
+ *
+ * @return zero(0) if all benchmarks passed, otherwise negative error
+ *         code.
+ */
+int harness_run_benchmarks(struct harness_benchmark_t *benchmarks_p);
+
 /**
  * Continiously read from given channel and return when given pattern
  * has been read, or when given timeout occurs.
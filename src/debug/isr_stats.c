@@ -0,0 +1,248 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2014-2018, Erik Moqvist
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use, copy,
+ * modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ * This file is part of the Simba project.
+ */
+
+#include "simba.h"
+
+#if CONFIG_ISR_STATS == 1
+
+struct module_t {
+    int8_t initialized;
+    struct isr_stats_t *head_p;
+    struct {
+        struct isr_stats_masked_t stats;
+        uint32_t start;
+        void *caller_p;
+    } masked;
+#if CONFIG_ISR_STATS_FS_COMMANDS == 1
+    struct fs_command_t cmd_list;
+    struct fs_command_t cmd_reset;
+#endif
+};
+
+/* Provided by the thread module. */
+extern uint32_t thrd_cycles_get_isr(void);
+
+static struct module_t module;
+
+#if CONFIG_ISR_STATS_FS_COMMANDS == 1
+
+static int cmd_list_cb(int argc,
+                       const char *argv[],
+                       void *out_p,
+                       void *in_p,
+                       void *arg_p,
+                       void *call_arg_p)
+{
+    return (isr_stats_print(out_p));
+}
+
+static int cmd_reset_cb(int argc,
+                        const char *argv[],
+                        void *out_p,
+                        void *in_p,
+                        void *arg_p,
+                        void *call_arg_p)
+{
+    return (isr_stats_reset());
+}
+
+#endif
+
+int isr_stats_module_init()
+{
+    /* Return immediately if the module is already initialized. */
+    if (module.initialized == 1) {
+        return (0);
+    }
+
+    module.initialized = 1;
+
+#if CONFIG_ISR_STATS_FS_COMMANDS == 1
+    fs_command_init(&module.cmd_list,
+                    CSTR("/debug/isr/list"),
+                    cmd_list_cb,
+                    NULL);
+    fs_command_register(&module.cmd_list);
+
+    fs_command_init(&module.cmd_reset,
+                    CSTR("/debug/isr/reset"),
+                    cmd_reset_cb,
+                    NULL);
+    fs_command_register(&module.cmd_reset);
+#endif
+
+    return (0);
+}
+
+uint32_t RAM_CODE isr_stats_now_isr(void)
+{
+    return (thrd_cycles_get_isr());
+}
+
+void RAM_CODE isr_stats_end_isr(struct isr_stats_t *self_p,
+                                uint32_t start)
+{
+    uint32_t time;
+
+    time = (thrd_cycles_get_isr() - start);
+    self_p->count++;
+    self_p->time += time;
+
+    if (time > self_p->max_time) {
+        self_p->max_time = time;
+    }
+
+    if (self_p->registered == 0) {
+        self_p->registered = 1;
+        self_p->next_p = module.head_p;
+        module.head_p = self_p;
+    }
+}
+
+void RAM_CODE isr_stats_masked_begin_isr(void *caller_p)
+{
+    module.masked.start = thrd_cycles_get_isr();
+    module.masked.caller_p = caller_p;
+}
+
+void RAM_CODE isr_stats_masked_end_isr(void)
+{
+    uint32_t time;
+
+    time = (thrd_cycles_get_isr() - module.masked.start);
+    module.masked.stats.count++;
+
+    if (time > module.masked.stats.max_time) {
+        module.masked.stats.max_time = time;
+        module.masked.stats.max_caller_p = module.masked.caller_p;
+    }
+}
+
+int isr_stats_get_masked(struct isr_stats_masked_t *masked_p)
+{
+    ASSERTN(masked_p != NULL, EINVAL);
+
+    sys_lock();
+    *masked_p = module.masked.stats;
+    sys_unlock();
+
+    return (0);
+}
+
+/* Print given total time in decimal, right aligned in a 19
+   characters wide column. */
+static void print_time_total(void *chan_p, uint64_t time)
+{
+#if CONFIG_STD_PRINTF_LONG_LONG == 1
+    std_fprintf(chan_p, OSTR("%19llu"), (unsigned long long)time);
+#else
+    /* Split into two parts that fit in an unsigned long each. */
+    if (time >= 1000000000) {
+        std_fprintf(chan_p,
+                    OSTR("%10lu%09lu"),
+                    (unsigned long)(time / 1000000000),
+                    (unsigned long)(time % 1000000000));
+    } else {
+        std_fprintf(chan_p, OSTR("%19lu"), (unsigned long)time);
+    }
+#endif
+}
+
+int isr_stats_print(void *chan_p)
+{
+    ASSERTN(chan_p != NULL, EINVAL);
+
+    struct isr_stats_t *stats_p;
+    struct isr_stats_t stats;
+    struct isr_stats_masked_t masked;
+
+    std_fprintf(chan_p,
+                OSTR("                NAME       COUNT"
+                     "          TIME-TOTAL    TIME-MAX    TIME-AVG\r\n"));
+
+    sys_lock();
+    stats_p = module.head_p;
+    sys_unlock();
+
+    while (stats_p != NULL) {
+        /* Take a consistent copy of the statistics. */
+        sys_lock();
+        stats = *stats_p;
+        sys_unlock();
+
+        std_fprintf(chan_p,
+                    OSTR("%20s %11lu "),
+                    stats.name_p,
+                    (unsigned long)stats.count);
+        print_time_total(chan_p, stats.time);
+        std_fprintf(chan_p,
+                    OSTR(" %11lu %11lu\r\n"),
+                    (unsigned long)stats.max_time,
+                    (unsigned long)(stats.count > 0
+                                    ? stats.time / stats.count
+                                    : 0));
+
+        stats_p = stats.next_p;
+    }
+
+    isr_stats_get_masked(&masked);
+
+    std_fprintf(chan_p,
+                OSTR("masked: count %lu, max-time %lu, max-caller 0x%08lx\r\n"),
+                (unsigned long)masked.count,
+                (unsigned long)masked.max_time,
+                (unsigned long)(uintptr_t)masked.max_caller_p);
+
+    return (0);
+}
+
+int isr_stats_reset()
+{
+    struct isr_stats_t *stats_p;
+
+    sys_lock();
+
+    stats_p = module.head_p;
+
+    while (stats_p != NULL) {
+        stats_p->count = 0;
+        stats_p->time = 0;
+        stats_p->max_time = 0;
+        stats_p = stats_p->next_p;
+    }
+
+    module.masked.stats.count = 0;
+    module.masked.stats.max_time = 0;
+    module.masked.stats.max_caller_p = NULL;
+
+    sys_unlock();
+
+    return (0);
+}
+
+#endif
@@ -0,0 +1,151 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2014-2018, Erik Moqvist
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use, copy,
+ * modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ * This file is part of the Simba project.
+ */
+
+#ifndef __DEBUG_ISR_STATS_H__
+#define __DEBUG_ISR_STATS_H__
+
+#include "simba.h"
+
+/**
+ * Statistics of an interrupt service routine. All times are in cycle
+ * counter ticks.
+ */
+struct isr_stats_t {
+    const char *name_p;
+    uint32_t count;
+    uint64_t time;
+    uint32_t max_time;
+    int8_t registered;
+    struct isr_stats_t *next_p;
+};
+
+/**
+ * Statistics of the periods interrupts are masked by the system lock
+ * in thread context. All times are in cycle counter ticks.
+ */
+struct isr_stats_masked_t {
+    uint32_t count;
+    uint32_t max_time;
+    /** Caller of `sys_lock()` in the longest period. */
+    void *max_caller_p;
+};
+
+#if CONFIG_ISR_STATS == 1
+/**
+ * Start measuring the execution time of an interrupt service
+ * routine. Declares static statistics with given variable name, and
+ * given interrupt name.
+ */
+#    define ISR_STATS_BEGIN_ISR(stats, name)                            \
+    static struct isr_stats_t stats = { .name_p = name };               \
+    uint32_t stats ## _start = isr_stats_now_isr()
+/** The interrupt service routine is about to return. */
+#    define ISR_STATS_END_ISR(stats)                    \
+    isr_stats_end_isr(&stats, stats ## _start)
+/** Interrupts were just masked by the system lock. */
+#    define ISR_STATS_MASKED_BEGIN_ISR()                                \
+    isr_stats_masked_begin_isr(__builtin_return_address(0))
+/** Interrupts are about to be unmasked by the system lock. */
+#    define ISR_STATS_MASKED_END_ISR() isr_stats_masked_end_isr()
+#else
+#    define ISR_STATS_BEGIN_ISR(stats, name)
+#    define ISR_STATS_END_ISR(stats)
+#    define ISR_STATS_MASKED_BEGIN_ISR()
+#    define ISR_STATS_MASKED_END_ISR()
+#endif
+
+/**
+ * Initialize the interrupt statistics module. This function must be
+ * called before calling any other function in this module.
+ *
+ * The module will only be initialized once even if this function is
+ * called multiple times.
+ *
+ * @return zero(0) or negative error code.
+ */
+int isr_stats_module_init(void);
+
+/**
+ * Get the current cycle counter value.
+ *
+ * @return Cycle counter value.
+ */
+uint32_t isr_stats_now_isr(void);
+
+/**
+ * Record that an interrupt service routine started at given cycle
+ * counter value is about to return. The statistics are added to the
+ * list printed by `isr_stats_print()` the first time this function is
+ * called. The execution time includes the time spent in interrupts
+ * with higher priority taken during the routine.
+ *
+ * @param[in] self_p Interrupt statistics.
+ * @param[in] start Cycle counter value when the routine was entered.
+ */
+void isr_stats_end_isr(struct isr_stats_t *self_p, uint32_t start);
+
+/**
+ * Record that interrupts were masked by the system lock.
+ *
+ * @param[in] caller_p Caller of `sys_lock()`.
+ */
+void isr_stats_masked_begin_isr(void *caller_p);
+
+/**
+ * Record that interrupts are about to be unmasked by the system lock.
+ */
+void isr_stats_masked_end_isr(void);
+
+/**
+ * Get the system lock masked interrupts statistics.
+ *
+ * @param[out] masked_p Masked interrupts statistics.
+ *
+ * @return zero(0) or negative error code.
+ */
+int isr_stats_get_masked(struct isr_stats_masked_t *masked_p);
+
+/**
+ * Print the statistics of all interrupt service routines that have
+ * been called, and the masked interrupts statistics, to given
+ * channel.
+ *
+ * @param[in] chan_p Output channel.
+ *
+ * @return zero(0) or negative error code.
+ */
+int isr_stats_print(void *chan_p);
+
+/**
+ * Reset all interrupt statistics.
+ *
+ * @return zero(0) or negative error code.
+ */
+int isr_stats_reset(void);
+
+#endif
@@ -29,15 +29,67 @@
 #include "simba.h"
 #include <stdarg.h>
 
+#if CONFIG_LOG_DEFERRED == 1
+
+#define DEFERRED_BUFFER_MASK (CONFIG_LOG_DEFERRED_BUFFER_SIZE - 1)
+
+#if (CONFIG_LOG_DEFERRED_BUFFER_SIZE & DEFERRED_BUFFER_MASK) != 0
+#    error "CONFIG_LOG_DEFERRED_BUFFER_SIZE must be a power of two."
+#endif
+
+/* Longest conversion specification written by the device side
+   formatter, including the null termination. */
+#define CONVERSION_MAX                                      16
+
+union deferred_arg_t {
+    long value;
+    const char *string_p;
+    far_string_t far_string_p;
+    float float_value;
+};
+
+/* A recorded log entry. The arguments are interpreted using the
+   conversion specifications in the format string. */
+struct deferred_entry_t {
+    const char *fmt_p;
+    const char *thrd_name_p;
+    const char *name_p;
+    struct time_t time;
+    int8_t level;
+    union deferred_arg_t args[CONFIG_LOG_DEFERRED_ARGS_MAX];
+};
+
+#endif
+
 struct module_t {
     int8_t initialized;
     struct log_handler_t handler;
     struct log_object_t object;
+    struct dlist_t handlers;
+    struct dlist_t objects;
     struct mutex_t mutex;
 #if CONFIG_LOG_FS_COMMANDS == 1
     struct fs_command_t cmd_print;
     struct fs_command_t cmd_list;
     struct fs_command_t cmd_set_log_mask;
+#    if CONFIG_LOG_DEFERRED == 1
+    struct fs_command_t cmd_flush;
+#    endif
+#endif
+#if CONFIG_LOG_DEFERRED == 1
+    struct {
+        uint32_t head;
+        uint32_t length;
+        uint32_t overwritten;
+        struct deferred_entry_t entries[CONFIG_LOG_DEFERRED_BUFFER_SIZE];
+    } deferred;
+#endif
+#if CONFIG_LOG_WRITER == 1
+    struct {
+        struct thrd_t *thrd_p;
+        struct sem_t sem;
+        struct log_staging_t *stagings_p;
+    } writer;
 #endif
 };
 
@@ -105,7 +157,7 @@ static int cmd_list_cb(int argc,
 
     std_fprintf(out_p, OSTR("OBJECT-NAME       MASK\r\n"));
 
-    object_p = &module.object;
+    object_p = dlist_peek_head(&module.objects);
 
     while (object_p != NULL) {
         std_fprintf(out_p,
@@ -113,7 +165,7 @@ static int cmd_list_cb(int argc,
                     object_p->name_p,
                     (int)object_p->mask);
 
-        object_p = object_p->next_p;
+        object_p = dlist_next(object_p);
     }
 
     mutex_unlock(&module.mutex);
@@ -153,7 +205,7 @@ static int cmd_set_log_mask_cb(int argc,
 
     mutex_lock(&module.mutex);
 
-    object_p = &module.object;
+    object_p = dlist_peek_head(&module.objects);
 
     while (object_p != NULL) {
         if (strcmp(object_p->name_p, name_p) == 0) {
@@ -161,7 +213,7 @@ static int cmd_set_log_mask_cb(int argc,
             found = 1;
         }
 
-        object_p = object_p->next_p;
+        object_p = dlist_next(object_p);
     }
 
     mutex_unlock(&module.mutex);
@@ -177,6 +229,695 @@ static int cmd_set_log_mask_cb(int argc,
     return (0);
 }
 
+#    if CONFIG_LOG_DEFERRED == 1
+
+/**
+ * The shell command callback for "/debug/log/flush".
+ */
+static int cmd_flush_cb(int argc,
+                        const char *argv[],
+                        void *out_p,
+                        void *in_p,
+                        void *arg_p,
+                        void *call_arg_p)
+{
+    int res;
+
+    if (argc != 1) {
+        std_fprintf(out_p, OSTR("Usage: flush\r\n"));
+
+        return (-EINVAL);
+    }
+
+    res = log_deferred_flush();
+
+    if (res < 0) {
+        return (res);
+    }
+
+    return (0);
+}
+
+#    endif
+
+#endif
+
+/**
+ * Returns the name to log given level with, or NULL if given level
+ * is disabled.
+ */
+static const char *get_name(struct log_object_t *self_p, int level)
+{
+    if (self_p == NULL) {
+        /* Use the thread log mask if no log object is given. */
+        if ((thrd_get_log_mask() & (1 << level)) == 0) {
+            return (NULL);
+        }
+
+        return ("default");
+    } else {
+        if ((self_p->mask & (1 << level)) == 0) {
+            return (NULL);
+        }
+
+        return (self_p->name_p);
+    }
+}
+
+static void write_header(void *chout_p,
+                         struct time_t *time_p,
+                         int level,
+                         const char *thrd_name_p,
+                         const char *name_p)
+{
+#if CONFIG_TIME_FORMAT == 1
+    char timestamp[16];
+
+    time_format_log_timestamp(&timestamp[0], sizeof(timestamp), time_p);
+    std_fprintf(chout_p,
+                FSTR("%s:%S:%s:%s: "),
+                &timestamp[0],
+                level_as_string[level],
+                thrd_name_p,
+                name_p);
+#else
+    std_fprintf(chout_p,
+                FSTR("%lu.%03lu:%S:%s:%s: "),
+                time_p->seconds,
+                time_p->nanoseconds / 1000000ul,
+                level_as_string[level],
+                thrd_name_p,
+                name_p);
+#endif
+}
+
+#if CONFIG_LOG_WRITER == 1
+
+/**
+ * Format given log entry into given staging buffer, prefixed by its
+ * size as 16 bits big endian, and wake up the log writer thread.
+ */
+static int stage(struct log_staging_t *staging_p,
+                 int level,
+                 const char *name_p,
+                 const char *fmt_p,
+                 va_list *ap_p)
+{
+    char buf[2 + CONFIG_LOG_WRITER_ENTRY_SIZE_MAX];
+    struct time_t now;
+#if CONFIG_TIME_FORMAT == 1
+    char timestamp[16];
+#endif
+    va_list ap;
+    ssize_t res;
+    size_t size;
+
+    time_get(&now);
+
+#if CONFIG_TIME_FORMAT == 1
+    time_format_log_timestamp(&timestamp[0], sizeof(timestamp), &now);
+    res = std_snprintf(&buf[2],
+                       CONFIG_LOG_WRITER_ENTRY_SIZE_MAX,
+                       FSTR("%s:%S:%s:%s: "),
+                       &timestamp[0],
+                       level_as_string[level],
+                       thrd_get_name(),
+                       name_p);
+#else
+    res = std_snprintf(&buf[2],
+                       CONFIG_LOG_WRITER_ENTRY_SIZE_MAX,
+                       FSTR("%lu.%03lu:%S:%s:%s: "),
+                       now.seconds,
+                       now.nanoseconds / 1000000ul,
+                       level_as_string[level],
+                       thrd_get_name(),
+                       name_p);
+#endif
+
+    if (res < 0) {
+        size = (CONFIG_LOG_WRITER_ENTRY_SIZE_MAX - 1);
+    } else {
+        size = res;
+        va_copy(ap, *ap_p);
+        res = std_vsnprintf(&buf[2 + size],
+                            CONFIG_LOG_WRITER_ENTRY_SIZE_MAX - size,
+                            fmt_p,
+                            &ap);
+        va_end(ap);
+
+        if (res < 0) {
+            size = (CONFIG_LOG_WRITER_ENTRY_SIZE_MAX - 1);
+        } else {
+            size += res;
+        }
+    }
+
+    if (spsc_queue_unused_size(&staging_p->queue) < size + 2) {
+        sys_lock();
+        staging_p->dropped++;
+        sys_unlock();
+
+        return (-ENOMEM);
+    }
+
+    buf[0] = (size >> 8);
+    buf[1] = size;
+    spsc_queue_write(&staging_p->queue, &buf[0], size + 2);
+    sem_give(&module.writer.sem, 1);
+
+    return (1);
+}
+
+/**
+ * Write all entries in given staging buffer to all log handlers. The
+ * module mutex must be taken by the caller.
+ *
+ * @return Number of dropped entries since the last call.
+ */
+static uint32_t drain(struct log_staging_t *staging_p)
+{
+    struct log_handler_t *handler_p;
+    char buf[CONFIG_LOG_WRITER_ENTRY_SIZE_MAX];
+    uint8_t header[2];
+    size_t size;
+    uint32_t dropped;
+
+    while (spsc_queue_size(&staging_p->queue) > 0) {
+        spsc_queue_read(&staging_p->queue, &header[0], sizeof(header));
+        size = ((header[0] << 8) | header[1]);
+        spsc_queue_read(&staging_p->queue, &buf[0], size);
+        handler_p = dlist_peek_head(&module.handlers);
+
+        while (handler_p != NULL) {
+            if (handler_p->chout_p != NULL) {
+                chan_control(handler_p->chout_p, CHAN_CONTROL_LOG_BEGIN);
+                chan_write(handler_p->chout_p, &buf[0], size);
+                chan_control(handler_p->chout_p, CHAN_CONTROL_LOG_END);
+            }
+
+            handler_p = dlist_next(handler_p);
+        }
+    }
+
+    sys_lock();
+    dropped = (staging_p->dropped - staging_p->reported);
+    staging_p->reported = staging_p->dropped;
+    sys_unlock();
+
+    return (dropped);
+}
+
+static void *writer_main(void *arg_p)
+{
+    struct log_staging_t *staging_p;
+    uint32_t dropped;
+
+    thrd_set_name("log");
+
+    while (1) {
+        sem_take(&module.writer.sem, NULL);
+
+        dropped = 0;
+
+        mutex_lock(&module.mutex);
+
+        staging_p = module.writer.stagings_p;
+
+        while (staging_p != NULL) {
+            dropped += drain(staging_p);
+            staging_p = staging_p->next_p;
+        }
+
+        mutex_unlock(&module.mutex);
+
+        if (dropped > 0) {
+            log_object_print(&module.object,
+                             LOG_WARNING,
+                             OSTR("%lu log entries dropped\r\n"),
+                             (unsigned long)dropped);
+        }
+
+#    if CONFIG_LOG_DEFERRED == 1
+        (void)log_deferred_flush();
+#    endif
+    }
+
+    return (NULL);
+}
+
+#endif
+
+static int vprint(struct log_object_t *self_p,
+                  int level,
+                  const char *fmt_p,
+                  va_list *ap_p)
+{
+    va_list ap;
+    struct time_t now;
+    struct log_handler_t *handler_p;
+    void *chout_p;
+    int count;
+    const char *name_p;
+#if CONFIG_LOG_WRITER == 1
+    struct log_staging_t *staging_p;
+#endif
+
+    /* Level filtering. */
+    name_p = get_name(self_p, level);
+
+    if (name_p == NULL) {
+        return (0);
+    }
+
+#if CONFIG_LOG_WRITER == 1
+    /* Leave the output to the log writer thread. */
+    if (module.writer.thrd_p != NULL) {
+        staging_p = thrd_self()->log_staging_p;
+
+        if (staging_p != NULL) {
+            return (stage(staging_p, level, name_p, fmt_p, ap_p));
+        }
+    }
+#endif
+
+    /* Print the formatted log entry to all handlers. */
+    count = 0;
+    handler_p = dlist_peek_head(&module.handlers);
+
+    mutex_lock(&module.mutex);
+
+    time_get(&now);
+
+    while (handler_p != NULL) {
+        chout_p = handler_p->chout_p;
+
+        if (chout_p != NULL) {
+            chan_control(chout_p, CHAN_CONTROL_LOG_BEGIN);
+
+            /* Write the header. */
+            write_header(chout_p, &now, level, thrd_get_name(), name_p);
+
+            /* Write the custom message. */
+            va_copy(ap, *ap_p);
+            std_vfprintf(chout_p, fmt_p, &ap);
+            va_end(ap);
+
+            chan_control(chout_p, CHAN_CONTROL_LOG_END);
+
+            count++;
+        }
+
+        handler_p = dlist_next(handler_p);
+    }
+
+    mutex_unlock(&module.mutex);
+
+    return (count);
+}
+
+#if CONFIG_LOG_DEFERRED == 1
+
+/**
+ * Returns the next conversion specification in given format string,
+ * or NULL if there are no more. The specification size and
+ * conversion character are written to given pointers. Same syntax
+ * as in the std module, %[flags][width][length]specifier.
+ */
+static const char *find_conversion(const char *fmt_p,
+                                   size_t *size_p,
+                                   char *conversion_p)
+{
+    const char *begin_p;
+
+    while (1) {
+        while ((*fmt_p != '%') && (*fmt_p != '\0')) {
+            fmt_p++;
+        }
+
+        if (*fmt_p == '\0') {
+            return (NULL);
+        }
+
+        begin_p = fmt_p;
+        fmt_p++;
+
+        if ((*fmt_p == '0') || (*fmt_p == '-')) {
+            fmt_p++;
+        }
+
+        while ((*fmt_p >= '0') && (*fmt_p <= '9')) {
+            fmt_p++;
+        }
+
+        if (*fmt_p == 'l') {
+            fmt_p++;
+        }
+
+        if (*fmt_p == '\0') {
+            return (NULL);
+        }
+
+        *size_p = (fmt_p - begin_p + 1);
+        *conversion_p = *fmt_p;
+
+        return (begin_p);
+    }
+}
+
+/**
+ * Returns true(1) if given conversion takes an argument.
+ */
+static int is_argument(char conversion)
+{
+    switch (conversion) {
+
+    case 's':
+    case 'S':
+    case 'c':
+    case 'i':
+    case 'd':
+    case 'u':
+    case 'x':
+    case 'f':
+        return (1);
+
+    default:
+        return (0);
+    }
+}
+
+/**
+ * Read the arguments of given format string into given array.
+ */
+static int read_args(const char *fmt_p,
+                     union deferred_arg_t *args_p,
+                     va_list *ap_p)
+{
+    size_t size;
+    char conversion;
+    int number_of_args;
+
+    number_of_args = 0;
+
+    while ((fmt_p = find_conversion(fmt_p, &size, &conversion)) != NULL) {
+        fmt_p += size;
+
+        if (!is_argument(conversion)) {
+            continue;
+        }
+
+        if (number_of_args == CONFIG_LOG_DEFERRED_ARGS_MAX) {
+            return (-EINVAL);
+        }
+
+        switch (conversion) {
+
+        case 's':
+            args_p->string_p = va_arg(*ap_p, const char *);
+            break;
+
+        case 'S':
+            args_p->far_string_p = va_arg(*ap_p, far_string_t);
+            break;
+
+        case 'f':
+            args_p->float_value = va_arg(*ap_p, double);
+            break;
+
+        default:
+            if (fmt_p[-2] == 'l') {
+                args_p->value = va_arg(*ap_p, long);
+            } else if ((conversion == 'u') || (conversion == 'x')) {
+                args_p->value = va_arg(*ap_p, unsigned int);
+            } else {
+                args_p->value = va_arg(*ap_p, int);
+            }
+
+            break;
+        }
+
+        args_p++;
+        number_of_args++;
+    }
+
+    return (number_of_args);
+}
+
+/**
+ * Write an entry to the ring buffer, overwriting the oldest entry if
+ * the buffer is full. This function must be called with the system
+ * lock taken or from an isr.
+ */
+static void write_entry_isr(const char *fmt_p,
+                            const char *thrd_name_p,
+                            const char *name_p,
+                            struct time_t *time_p,
+                            int level,
+                            union deferred_arg_t *args_p,
+                            int number_of_args)
+{
+    struct deferred_entry_t *entry_p;
+
+    entry_p = &module.deferred.entries[module.deferred.head
+                                       & DEFERRED_BUFFER_MASK];
+    entry_p->fmt_p = fmt_p;
+    entry_p->thrd_name_p = thrd_name_p;
+    entry_p->name_p = name_p;
+    entry_p->time = *time_p;
+    entry_p->level = level;
+    memcpy(&entry_p->args[0], args_p, number_of_args * sizeof(*args_p));
+    module.deferred.head++;
+
+    if (module.deferred.length < CONFIG_LOG_DEFERRED_BUFFER_SIZE) {
+        module.deferred.length++;
+    } else {
+        module.deferred.overwritten++;
+    }
+}
+
+/**
+ * Copy and remove the oldest entry in the ring buffer.
+ */
+static int pop_entry(struct deferred_entry_t *entry_p)
+{
+    int res;
+
+    res = 0;
+
+    sys_lock();
+
+    if (module.deferred.length > 0) {
+        *entry_p = module.deferred.entries[(module.deferred.head
+                                            - module.deferred.length)
+                                           & DEFERRED_BUFFER_MASK];
+        module.deferred.length--;
+        res = 1;
+    }
+
+    sys_unlock();
+
+    return (res);
+}
+
+static void write_u32(void *chout_p, uint32_t value)
+{
+    uint8_t buf[4];
+
+    buf[0] = (value >> 24);
+    buf[1] = (value >> 16);
+    buf[2] = (value >> 8);
+    buf[3] = value;
+
+    chan_write(chout_p, &buf[0], sizeof(buf));
+}
+
+/**
+ * Write given far string, including the null termination.
+ */
+static void write_string(void *chout_p, far_string_t string_p)
+{
+    if (string_p == NULL) {
+        string_p = FSTR("(null)");
+    }
+
+#if defined(FAR_SPECIAL_ADDRESS)
+    char c;
+
+    do {
+        c = *string_p++;
+        chan_write(chout_p, &c, 1);
+    } while (c != '\0');
+#else
+    chan_write(chout_p, string_p, strlen(string_p) + 1);
+#endif
+}
+
+/**
+ * Write given entry in the binary format decoded by bin/soam.py;
+ * seconds and milliseconds as 32 and 16 bits big endian, the level,
+ * the null terminated thread name, log object name and format
+ * string, followed by the arguments. Strings are null terminated,
+ * and all other arguments are 32 bits big endian.
+ */
+static void write_deferred_binary(void *chout_p,
+                                  struct deferred_entry_t *entry_p)
+{
+    union deferred_arg_t *arg_p;
+    const char *fmt_p;
+    size_t size;
+    char conversion;
+    uint8_t buf[3];
+    uint32_t value;
+
+    write_u32(chout_p, entry_p->time.seconds);
+    value = (entry_p->time.nanoseconds / 1000000ul);
+    buf[0] = (value >> 8);
+    buf[1] = value;
+    buf[2] = entry_p->level;
+    chan_write(chout_p, &buf[0], sizeof(buf));
+    write_string(chout_p, entry_p->thrd_name_p);
+    write_string(chout_p, entry_p->name_p);
+    write_string(chout_p, entry_p->fmt_p);
+
+    arg_p = &entry_p->args[0];
+    fmt_p = entry_p->fmt_p;
+
+    while ((fmt_p = find_conversion(fmt_p, &size, &conversion)) != NULL) {
+        fmt_p += size;
+
+        if (!is_argument(conversion)) {
+            continue;
+        }
+
+        switch (conversion) {
+
+        case 's':
+            write_string(chout_p, arg_p->string_p);
+            break;
+
+        case 'S':
+            write_string(chout_p, arg_p->far_string_p);
+            break;
+
+        case 'f':
+            memcpy(&value, &arg_p->float_value, sizeof(value));
+            write_u32(chout_p, value);
+            break;
+
+        default:
+            write_u32(chout_p, arg_p->value);
+            break;
+        }
+
+        arg_p++;
+    }
+}
+
+static void write_text(void *chout_p, const char *text_p, size_t size)
+{
+#if defined(FAR_SPECIAL_ADDRESS)
+    char c;
+
+    while (size > 0) {
+        c = *text_p++;
+        chan_write(chout_p, &c, 1);
+        size--;
+    }
+#else
+    if (size > 0) {
+        chan_write(chout_p, text_p, size);
+    }
+#endif
+}
+
+/**
+ * Format given entry on the device, one conversion at a time.
+ */
+static void write_deferred_text(void *chout_p,
+                                struct deferred_entry_t *entry_p)
+{
+    union deferred_arg_t *arg_p;
+    const char *fmt_p;
+    const char *conversion_p;
+    size_t size;
+    char conversion;
+    char buf[CONVERSION_MAX];
+    size_t i;
+
+    write_header(chout_p,
+                 &entry_p->time,
+                 entry_p->level,
+                 entry_p->thrd_name_p,
+                 entry_p->name_p);
+
+    arg_p = &entry_p->args[0];
+    fmt_p = entry_p->fmt_p;
+
+    while (1) {
+        conversion_p = find_conversion(fmt_p, &size, &conversion);
+
+        if (conversion_p == NULL) {
+            conversion_p = fmt_p;
+
+            while (*conversion_p != '\0') {
+                conversion_p++;
+            }
+
+            write_text(chout_p, fmt_p, conversion_p - fmt_p);
+            break;
+        }
+
+        write_text(chout_p, fmt_p, conversion_p - fmt_p);
+        fmt_p = (conversion_p + size);
+
+        /* Skip too long conversion specifications. */
+        if (size >= sizeof(buf)) {
+            if (is_argument(conversion)) {
+                arg_p++;
+            }
+
+            continue;
+        }
+
+        for (i = 0; i < size; i++) {
+            buf[i] = conversion_p[i];
+        }
+
+        buf[size] = '\0';
+
+        if (!is_argument(conversion)) {
+            std_fprintf(chout_p, &buf[0]);
+            continue;
+        }
+
+        switch (conversion) {
+
+        case 's':
+            std_fprintf(chout_p, &buf[0], arg_p->string_p);
+            break;
+
+        case 'S':
+            std_fprintf(chout_p, &buf[0], arg_p->far_string_p);
+            break;
+
+        case 'f':
+            std_fprintf(chout_p, &buf[0], (double)arg_p->float_value);
+            break;
+
+        default:
+            if (buf[size - 2] == 'l') {
+                std_fprintf(chout_p, &buf[0], arg_p->value);
+            } else {
+                std_fprintf(chout_p, &buf[0], (int)arg_p->value);
+            }
+
+            break;
+        }
+
+        arg_p++;
+    }
+}
+
 #endif
 
 int log_module_init()
@@ -189,13 +930,24 @@ int log_module_init()
     module.initialized = 1;
 
     mutex_init(&module.mutex);
+#if CONFIG_LOCK_STATS == 1
+    lock_stats_register(&module.mutex.stats, "log");
+#endif
+
+    dlist_init(&module.handlers);
+    dlist_init(&module.objects);
 
-    module.handler.chout_p = sys_get_stdout();
-    module.handler.next_p = NULL;
+    log_handler_init(&module.handler, sys_get_stdout());
+    dlist_add_head(&module.handlers, &module.handler);
 
-    module.object.name_p = "log";
-    module.object.mask = LOG_UPTO(INFO);
-    module.object.next_p = NULL;
+    log_object_init(&module.object, "log", LOG_UPTO(INFO));
+    dlist_add_head(&module.objects, &module.object);
+
+#if CONFIG_LOG_WRITER == 1
+    module.writer.thrd_p = NULL;
+    sem_init(&module.writer.sem, 1, 1);
+    module.writer.stagings_p = NULL;
+#endif
 
 #if CONFIG_LOG_FS_COMMANDS == 1
     fs_command_init(&module.cmd_print,
@@ -215,6 +967,14 @@ int log_module_init()
                     cmd_set_log_mask_cb,
                     NULL);
     fs_command_register(&module.cmd_set_log_mask);
+
+#    if CONFIG_LOG_DEFERRED == 1
+    fs_command_init(&module.cmd_flush,
+                    CSTR("/debug/log/flush"),
+                    cmd_flush_cb,
+                    NULL);
+    fs_command_register(&module.cmd_flush);
+#    endif
 #endif
 
     return (0);
@@ -225,10 +985,9 @@ int log_add_handler(struct log_handler_t *handler_p)
     ASSERTN(handler_p != NULL, EINVAL);
 
     mutex_lock(&module.mutex);
-
-    handler_p->next_p = module.handler.next_p;
-    module.handler.next_p = handler_p;
-
+    dlist_insert_before(&module.handlers,
+                        dlist_next(&module.handler),
+                        handler_p);
     mutex_unlock(&module.mutex);
 
     return (0);
@@ -238,29 +997,13 @@ int log_remove_handler(struct log_handler_t *handler_p)
 {
     ASSERTN(handler_p != NULL, EINVAL);
 
-    struct log_handler_t *curr_p, *prev_p;
+    int res;
 
     mutex_lock(&module.mutex);
-
-    curr_p = module.handler.next_p;
-    prev_p = &module.handler;
-
-    while (curr_p != NULL) {
-        if (curr_p == handler_p) {
-            if (prev_p != NULL) {
-                prev_p->next_p = curr_p->next_p;
-            }
-
-            curr_p->next_p = NULL;
-            mutex_unlock(&module.mutex);
-
-            return (0);
-        }
-    }
-
+    res = (dlist_remove(&module.handlers, handler_p) == NULL);
     mutex_unlock(&module.mutex);
 
-    return (1);
+    return (res);
 }
 
 int log_add_object(struct log_object_t *object_p)
@@ -268,10 +1011,9 @@ int log_add_object(struct log_object_t *object_p)
     ASSERTN(object_p != NULL, EINVAL);
 
     mutex_lock(&module.mutex);
-
-    object_p->next_p = module.object.next_p;
-    module.object.next_p = object_p;
-
+    dlist_insert_before(&module.objects,
+                        dlist_next(&module.object),
+                        object_p);
     mutex_unlock(&module.mutex);
 
     return (0);
@@ -281,36 +1023,98 @@ int log_remove_object(struct log_object_t *object_p)
 {
     ASSERTN(object_p != NULL, EINVAL);
 
-    struct log_object_t *curr_p, *prev_p;
+    int res;
 
     mutex_lock(&module.mutex);
+    res = (dlist_remove(&module.objects, object_p) == NULL);
+    mutex_unlock(&module.mutex);
 
-    curr_p = module.object.next_p;
-    prev_p = &module.object;
+    return (res);
+}
 
-    while (curr_p != NULL) {
-        if (curr_p == object_p) {
-            if (prev_p != NULL) {
-                prev_p->next_p = curr_p->next_p;
-            }
+int log_set_default_handler_output_channel(void *chout_p)
+{
+    module.handler.chout_p = chout_p;
 
-            curr_p->next_p = NULL;
-            mutex_unlock(&module.mutex);
+    return (0);
+}
 
-            return (0);
-        }
+int log_writer_start(void *stack_p, size_t stack_size)
+{
+    ASSERTN(stack_p != NULL, EINVAL);
+
+#if CONFIG_LOG_WRITER == 1
+    if (module.writer.thrd_p != NULL) {
+        return (-EBUSY);
     }
 
-    mutex_unlock(&module.mutex);
+    module.writer.thrd_p = thrd_spawn(writer_main,
+                                      NULL,
+                                      CONFIG_LOG_WRITER_PRIO,
+                                      stack_p,
+                                      stack_size);
 
-    return (1);
+    return (module.writer.thrd_p != NULL ? 0 : -1);
+#else
+    return (-ENOSYS);
+#endif
 }
 
-int log_set_default_handler_output_channel(void *chout_p)
+int log_staging_init(struct log_staging_t *self_p,
+                     void *buf_p,
+                     size_t size)
 {
-    module.handler.chout_p = chout_p;
+    ASSERTN(self_p != NULL, EINVAL);
 
-    return (0);
+    self_p->dropped = 0;
+    self_p->reported = 0;
+    self_p->next_p = NULL;
+
+    return (spsc_queue_init(&self_p->queue, buf_p, size));
+}
+
+struct log_staging_t *log_set_thread_staging(struct log_staging_t *staging_p)
+{
+#if CONFIG_LOG_WRITER == 1
+    struct thrd_t *thrd_p;
+    struct log_staging_t *old_p;
+    struct log_staging_t **staging_pp;
+
+    thrd_p = thrd_self();
+    old_p = thrd_p->log_staging_p;
+
+    if (old_p == staging_p) {
+        return (old_p);
+    }
+
+    mutex_lock(&module.mutex);
+
+    /* Write what is left in the old staging buffer and stop draining
+       it. */
+    if (old_p != NULL) {
+        (void)drain(old_p);
+        staging_pp = &module.writer.stagings_p;
+
+        while (*staging_pp != old_p) {
+            staging_pp = &(*staging_pp)->next_p;
+        }
+
+        *staging_pp = old_p->next_p;
+    }
+
+    if (staging_p != NULL) {
+        staging_p->next_p = module.writer.stagings_p;
+        module.writer.stagings_p = staging_p;
+    }
+
+    thrd_p->log_staging_p = staging_p;
+
+    mutex_unlock(&module.mutex);
+
+    return (old_p);
+#else
+    return (NULL);
+#endif
 }
 
 int log_handler_init(struct log_handler_t *self_p,
@@ -319,8 +1123,9 @@ int log_handler_init(struct log_handler_t *self_p,
     ASSERTN(self_p != NULL, EINVAL);
     ASSERTN(chout_p != NULL, EINVAL);
 
+    self_p->list_elem.next_p = NULL;
+    self_p->list_elem.prev_p = NULL;
     self_p->chout_p = chout_p;
-    self_p->next_p = NULL;
 
     return (0);
 }
@@ -332,6 +1137,8 @@ int log_object_init(struct log_object_t *self_p,
     ASSERTN(self_p != NULL, EINVAL);
     ASSERTN(name_p != NULL, EINVAL);
 
+    self_p->list_elem.next_p = NULL;
+    self_p->list_elem.prev_p = NULL;
     self_p->name_p = name_p;
     self_p->mask = mask;
 
@@ -370,65 +1177,165 @@ int log_object_print(struct log_object_t *self_p,
     ASSERTN(fmt_p != NULL, EINVAL);
 
     va_list ap;
+    int res;
+
+    va_start(ap, fmt_p);
+    res = vprint(self_p, level, fmt_p, &ap);
+    va_end(ap);
+
+    return (res);
+}
+
+int log_object_print_deferred(struct log_object_t *self_p,
+                              int level,
+                              const char *fmt_p,
+                              ...)
+{
+    ASSERTN(fmt_p != NULL, EINVAL);
+
+    va_list ap;
+    int res;
+
+#if CONFIG_LOG_DEFERRED == 1
+    union deferred_arg_t args[CONFIG_LOG_DEFERRED_ARGS_MAX];
     struct time_t now;
-    struct log_handler_t *handler_p;
-    void *chout_p;
-    int count;
     const char *name_p;
 
     /* Level filtering. */
-    if (self_p == NULL) {
-        /* Use the thread log mask if no log object is given. */
-        if ((thrd_get_log_mask() & (1 << level)) == 0) {
-            return (0);
-        }
+    name_p = get_name(self_p, level);
 
-        name_p = "default";
-    } else {
-        if ((self_p->mask & (1 << level)) == 0) {
-            return (0);
-        }
-
-        name_p = self_p->name_p;
+    if (name_p == NULL) {
+        return (0);
     }
 
-    /* Print the formatted log entry to all handlers. */
-    count = 0;
-    handler_p = &module.handler;
+    va_start(ap, fmt_p);
+    res = read_args(fmt_p, &args[0], &ap);
+    va_end(ap);
 
-    mutex_lock(&module.mutex);
+    if (res < 0) {
+        return (res);
+    }
 
     time_get(&now);
 
-    while (handler_p != NULL) {
-        chout_p = handler_p->chout_p;
+    sys_lock();
+    write_entry_isr(fmt_p,
+                    thrd_get_name(),
+                    name_p,
+                    &now,
+                    level,
+                    &args[0],
+                    res);
+    sys_unlock();
+
+    res = 1;
+#else
+    va_start(ap, fmt_p);
+    res = vprint(self_p, level, fmt_p, &ap);
+    va_end(ap);
+#endif
 
-        if (chout_p != NULL) {
-            chan_control(chout_p, CHAN_CONTROL_LOG_BEGIN);
+    return (res);
+}
 
-            /* Write the header. */
-            std_fprintf(chout_p,
-                        FSTR("%lu.%03lu:%S:%s:%s: "),
-                        now.seconds,
-                        now.nanoseconds / 1000000ul,
-                        level_as_string[level],
-                        thrd_get_name(),
-                        name_p);
+int log_object_print_isr(struct log_object_t *self_p,
+                         int level,
+                         const char *fmt_p,
+                         ...)
+{
+    ASSERTN(fmt_p != NULL, EINVAL);
 
-            /* Write the custom message. */
-            va_start(ap, fmt_p);
-            std_vfprintf(chout_p, fmt_p, &ap);
-            va_end(ap);
+#if CONFIG_LOG_DEFERRED == 1
+    va_list ap;
+    union deferred_arg_t args[CONFIG_LOG_DEFERRED_ARGS_MAX];
+    struct time_t now;
+    const char *name_p;
+    int res;
 
-            chan_control(chout_p, CHAN_CONTROL_LOG_END);
+    /* Level filtering. */
+    name_p = get_name(self_p, level);
 
-            count++;
+    if (name_p == NULL) {
+        return (0);
+    }
+
+    va_start(ap, fmt_p);
+    res = read_args(fmt_p, &args[0], &ap);
+    va_end(ap);
+
+    if (res < 0) {
+        return (res);
+    }
+
+    time_get_isr(&now);
+    write_entry_isr(fmt_p, "isr", name_p, &now, level, &args[0], res);
+
+#    if CONFIG_LOG_WRITER == 1
+    /* Let the log writer thread flush the entry. */
+    if (module.writer.thrd_p != NULL) {
+        sem_give_isr(&module.writer.sem, 1);
+    }
+#    endif
+
+    return (1);
+#else
+    return (-ENOSYS);
+#endif
+}
+
+int log_deferred_flush()
+{
+#if CONFIG_LOG_DEFERRED == 1
+    struct deferred_entry_t entry;
+    struct log_handler_t *handler_p;
+    void *chout_p;
+    uint32_t overwritten;
+    int count;
+
+    count = 0;
+
+    mutex_lock(&module.mutex);
+
+    while (pop_entry(&entry) == 1) {
+        handler_p = dlist_peek_head(&module.handlers);
+
+        while (handler_p != NULL) {
+            chout_p = handler_p->chout_p;
+
+            if (chout_p != NULL) {
+                if (chan_control(chout_p,
+                                 CHAN_CONTROL_LOG_DEFERRED_BEGIN) == 1) {
+                    write_deferred_binary(chout_p, &entry);
+                } else {
+                    chan_control(chout_p, CHAN_CONTROL_LOG_BEGIN);
+                    write_deferred_text(chout_p, &entry);
+                }
+
+                chan_control(chout_p, CHAN_CONTROL_LOG_END);
+            }
+
+            handler_p = dlist_next(handler_p);
         }
 
-        handler_p = handler_p->next_p;
+        count++;
     }
 
+    sys_lock();
+    overwritten = module.deferred.overwritten;
+    module.deferred.overwritten = 0;
+    sys_unlock();
+
     mutex_unlock(&module.mutex);
 
+    if (overwritten > 0) {
+        log_object_print(&module.object,
+                         LOG_WARNING,
+                         OSTR("%lu deferred log entries overwritten\r\n"),
+                         (unsigned long)overwritten);
+    }
+
     return (count);
+#else
+    return (0);
+#endif
 }
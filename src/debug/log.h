@@ -57,14 +57,25 @@
 #define LOG_NONE        0x00
 
 struct log_handler_t {
+    struct dlist_elem_t list_elem;
     void *chout_p;
-    struct log_handler_t *next_p;
 };
 
 struct log_object_t {
+    struct dlist_elem_t list_elem;
     const char *name_p;
     char mask;
-    struct log_object_t *next_p;
+};
+
+/**
+ * A staging buffer of a thread, drained by the log writer thread.
+ */
+struct log_staging_t {
+    struct spsc_queue_t queue;
+    /** Number of log entries dropped because the buffer was full. */
+    uint32_t dropped;
+    uint32_t reported;
+    struct log_staging_t *next_p;
 };
 
 /**
@@ -143,6 +154,194 @@ int log_object_print(struct log_object_t *self_p,
                      const char *fmt_p,
                      ...);
 
+/**
+ * Check if given log level is set in the log object mask. If so,
+ * record the format string, a timestamp and the arguments in the
+ * deferred log ring buffer. The entry is formatted and written to
+ * the log handlers later by `log_deferred_flush()`.
+ *
+ * Integer and character arguments are recorded as 32 bits, and
+ * floating point arguments as ``float``. String arguments are
+ * recorded as pointers and must be valid until the entry is flushed,
+ * as must the log object and thread names.
+ *
+ * The oldest entry is overwritten if the ring buffer is full.
+ *
+ * The entry is written immediately, as by `log_object_print()`, if
+ * ``CONFIG_LOG_DEFERRED`` is disabled.
+ *
+ * @param[in] self_p Log object, or NULL to use the thread's log mask.
+ * @param[in] level Log level.
+ * @param[in] fmt_p Log format string.
+ * @param[in] ... Variable argument list.
+ *
+ * @return true(1) if the entry was recorded, false(0) if the log
+ *         level is disabled, otherwise negative error code. The
+ *         number of handlers the entry was written to if
+ *         ``CONFIG_LOG_DEFERRED`` is disabled.
+ */
+int log_object_print_deferred(struct log_object_t *self_p,
+                              int level,
+                              const char *fmt_p,
+                              ...);
+
+/**
+ * Same as `log_object_print_deferred()`, but may only be called from
+ * an interrupt service routine or with the system lock taken. No lock
+ * is taken, so it can be used to log from interrupt handlers. The
+ * thread name of the entry is "isr".
+ *
+ * The entry is flushed by `log_deferred_flush()`, or by the log
+ * writer thread if started, see `log_writer_start()`.
+ *
+ * @param[in] self_p Log object, or NULL to use the thread's log mask.
+ * @param[in] level Log level.
+ * @param[in] fmt_p Log format string.
+ * @param[in] ... Variable argument list.
+ *
+ * @return true(1) if the entry was recorded, false(0) if the log
+ *         level is disabled, otherwise negative error code, -ENOSYS
+ *         if ``CONFIG_LOG_DEFERRED`` is disabled.
+ */
+int log_object_print_isr(struct log_object_t *self_p,
+                         int level,
+                         const char *fmt_p,
+                         ...);
+
+/**
+ * Inlined variant of `log_object_is_enabled_for()` used by the
+ * ``LOG_OBJECT_PRINT*()`` macros.
+ *
+ * @param[in] self_p Log object, or NULL to check the level in the
+ *                   thread log mask.
+ * @param[in] level Log level to check.
+ *
+ * @return true(1) if given log level is enabled, otherwise false(0).
+ */
+static inline int log_object_is_level_enabled(struct log_object_t *self_p,
+                                              int level)
+{
+    int mask;
+
+    if (self_p == NULL) {
+        mask = thrd_get_log_mask();
+    } else {
+        mask = self_p->mask;
+    }
+
+    return ((mask & (1 << level)) != 0);
+}
+
+/**
+ * Same as `log_object_print()`, but removed at compile time if
+ * ``level`` is less severe than ``CONFIG_LOG_LEVEL_MIN``, and the
+ * arguments are only evaluated if ``level`` is enabled. Use in hot
+ * paths, where a disabled log point should cost nothing or a single
+ * mask check.
+ *
+ * ``self_p`` and ``level`` are evaluated more than once, and the
+ * result of `log_object_print()` is discarded.
+ */
+#define LOG_OBJECT_PRINT(self_p, level, ...)                            \
+    do {                                                                \
+        if (((level) <= CONFIG_LOG_LEVEL_MIN)                           \
+            && log_object_is_level_enabled(self_p, level)) {            \
+            log_object_print(self_p, level, __VA_ARGS__);               \
+        }                                                               \
+    } while (0)
+
+/**
+ * Same as `LOG_OBJECT_PRINT()`, but for
+ * `log_object_print_deferred()`.
+ */
+#define LOG_OBJECT_PRINT_DEFERRED(self_p, level, ...)                   \
+    do {                                                                \
+        if (((level) <= CONFIG_LOG_LEVEL_MIN)                           \
+            && log_object_is_level_enabled(self_p, level)) {            \
+            log_object_print_deferred(self_p, level, __VA_ARGS__);      \
+        }                                                               \
+    } while (0)
+
+/**
+ * Same as `LOG_OBJECT_PRINT()`, but for `log_object_print_isr()`.
+ */
+#define LOG_OBJECT_PRINT_ISR(self_p, level, ...)                        \
+    do {                                                                \
+        if (((level) <= CONFIG_LOG_LEVEL_MIN)                           \
+            && log_object_is_level_enabled(self_p, level)) {            \
+            log_object_print_isr(self_p, level, __VA_ARGS__);           \
+        }                                                               \
+    } while (0)
+
+/**
+ * Write all entries in the deferred log ring buffer to all log
+ * handlers, oldest first, and remove them from the buffer.
+ *
+ * An entry is written in binary to handlers accepting
+ * ``CHAN_CONTROL_LOG_DEFERRED_BEGIN``, for example the SOAM log
+ * channel, and formatted by ``bin/soam.py`` on the host. It is
+ * formatted on the device for all other handlers, just as by
+ * `log_object_print()`.
+ *
+ * A warning with the number of overwritten entries is logged after
+ * the entries if the buffer has been full since the last flush.
+ *
+ * @return Number of written entries or negative error code.
+ */
+int log_deferred_flush(void);
+
+/**
+ * Start the log writer thread, which writes log entries in the
+ * staging buffers to all log handlers. It also flushes the deferred
+ * log ring buffer when woken up, for example by
+ * `log_object_print_isr()`. Only one log writer thread can be
+ * started.
+ *
+ * @param[in] stack_p Log writer thread stack.
+ * @param[in] stack_size Log writer thread stack size.
+ *
+ * @return zero(0) or negative error code, -ENOSYS if
+ *         ``CONFIG_LOG_WRITER`` is disabled.
+ */
+int log_writer_start(void *stack_p, size_t stack_size);
+
+/**
+ * Initialize given staging buffer.
+ *
+ * @param[out] self_p Staging buffer to initialize.
+ * @param[in] buf_p Buffer for formatted log entries.
+ * @param[in] size Size of the buffer. Must be a power of two.
+ *
+ * @return zero(0) or negative error code.
+ */
+int log_staging_init(struct log_staging_t *self_p,
+                     void *buf_p,
+                     size_t size);
+
+/**
+ * Bind given staging buffer to the current thread. Once the log
+ * writer thread is started, `log_object_print()` formats log entries
+ * of the current thread into the staging buffer and returns without
+ * waiting for any mutex or output channel. An entry is dropped, and
+ * ``dropped`` in the staging buffer incremented, if the staging
+ * buffer is full. The log writer thread logs a warning with the
+ * number of dropped entries.
+ *
+ * Staging buffers are single producer, single consumer, so a staging
+ * buffer must only be bound to one thread at a time.
+ *
+ * Entries left in the previously bound staging buffer are written to
+ * the log handlers before this function returns.
+ *
+ * @param[in] staging_p Staging buffer to bind, or NULL to write log
+ *                      entries of the current thread directly to the
+ *                      log handlers.
+ *
+ * @return Previously bound staging buffer, or NULL if none or if
+ *         ``CONFIG_LOG_WRITER`` is disabled.
+ */
+struct log_staging_t *log_set_thread_staging(struct log_staging_t *staging_p);
+
 /**
  * Initialize given log handler with given output channel.
  *
@@ -0,0 +1,297 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2014-2018, Erik Moqvist
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use, copy,
+ * modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ * This file is part of the Simba project.
+ */
+
+#include "simba.h"
+
+#if CONFIG_PROFILER == 1
+
+struct module_t {
+    int8_t initialized;
+    volatile int8_t sampling;
+    volatile uint32_t length;
+    uint32_t dropped;
+    struct profiler_sample_t samples[CONFIG_PROFILER_BUFFER_SIZE];
+#if CONFIG_PROFILER_FS_COMMANDS == 1
+    struct fs_command_t cmd_start;
+    struct fs_command_t cmd_stop;
+    struct fs_command_t cmd_print;
+    struct fs_command_t cmd_reset;
+#endif
+};
+
+/* Provided by the system and thread modules. */
+extern int sys_profiler_start(void);
+extern int sys_profiler_stop(void);
+extern struct thrd_t *thrd_trace_get_threads(void);
+
+static struct module_t module;
+
+#if CONFIG_PROFILER_FS_COMMANDS == 1
+
+static int cmd_start_cb(int argc,
+                        const char *argv[],
+                        void *out_p,
+                        void *in_p,
+                        void *arg_p,
+                        void *call_arg_p)
+{
+    return (profiler_start());
+}
+
+static int cmd_stop_cb(int argc,
+                       const char *argv[],
+                       void *out_p,
+                       void *in_p,
+                       void *arg_p,
+                       void *call_arg_p)
+{
+    return (profiler_stop());
+}
+
+static int cmd_print_cb(int argc,
+                        const char *argv[],
+                        void *out_p,
+                        void *in_p,
+                        void *arg_p,
+                        void *call_arg_p)
+{
+    return (profiler_print(out_p));
+}
+
+static int cmd_reset_cb(int argc,
+                        const char *argv[],
+                        void *out_p,
+                        void *in_p,
+                        void *arg_p,
+                        void *call_arg_p)
+{
+    return (profiler_reset());
+}
+
+#endif
+
+/**
+ * Copy the sample at given index, counted from the oldest sample.
+ */
+static int read_sample(uint32_t index, struct profiler_sample_t *sample_p)
+{
+    int res;
+
+    res = 0;
+
+    sys_lock();
+
+    if (index < module.length) {
+        *sample_p = module.samples[index];
+        res = 1;
+    }
+
+    sys_unlock();
+
+    return (res);
+}
+
+int profiler_module_init()
+{
+    /* Return immediately if the module is already initialized. */
+    if (module.initialized == 1) {
+        return (0);
+    }
+
+    module.initialized = 1;
+    module.sampling = 0;
+    module.length = 0;
+    module.dropped = 0;
+
+#if CONFIG_PROFILER_FS_COMMANDS == 1
+    fs_command_init(&module.cmd_start,
+                    CSTR("/debug/profiler/start"),
+                    cmd_start_cb,
+                    NULL);
+    fs_command_register(&module.cmd_start);
+
+    fs_command_init(&module.cmd_stop,
+                    CSTR("/debug/profiler/stop"),
+                    cmd_stop_cb,
+                    NULL);
+    fs_command_register(&module.cmd_stop);
+
+    fs_command_init(&module.cmd_print,
+                    CSTR("/debug/profiler/print"),
+                    cmd_print_cb,
+                    NULL);
+    fs_command_register(&module.cmd_print);
+
+    fs_command_init(&module.cmd_reset,
+                    CSTR("/debug/profiler/reset"),
+                    cmd_reset_cb,
+                    NULL);
+    fs_command_register(&module.cmd_reset);
+#endif
+
+    return (0);
+}
+
+int profiler_start()
+{
+    int res;
+
+    module.sampling = 1;
+    res = sys_profiler_start();
+
+    if (res != 0) {
+        module.sampling = 0;
+    }
+
+    return (res);
+}
+
+int profiler_stop()
+{
+    module.sampling = 0;
+
+    return (sys_profiler_stop());
+}
+
+int profiler_reset()
+{
+    sys_lock();
+    module.length = 0;
+    module.dropped = 0;
+    sys_unlock();
+
+    return (0);
+}
+
+void RAM_CODE profiler_sample_isr(struct thrd_t *thrd_p,
+                                  const uintptr_t *pcs_p,
+                                  int length)
+{
+    struct profiler_sample_t *sample_p;
+    int i;
+
+    if (module.sampling == 0) {
+        return;
+    }
+
+    if (module.length == CONFIG_PROFILER_BUFFER_SIZE) {
+        module.dropped++;
+
+        return;
+    }
+
+    sample_p = &module.samples[module.length];
+
+    if (length > membersof(sample_p->pcs)) {
+        length = membersof(sample_p->pcs);
+    }
+
+    sample_p->thrd_p = thrd_p;
+    sample_p->length = length;
+
+    for (i = 0; i < length; i++) {
+        sample_p->pcs[i] = pcs_p[i];
+    }
+
+    module.length++;
+}
+
+ssize_t profiler_read(struct profiler_sample_t *samples_p, size_t length)
+{
+    ASSERTN(samples_p != NULL, EINVAL);
+
+    size_t i;
+
+    for (i = 0; i < length; i++) {
+        if (read_sample(i, &samples_p[i]) == 0) {
+            break;
+        }
+    }
+
+    return (i);
+}
+
+int profiler_print(void *chan_p)
+{
+    ASSERTN(chan_p != NULL, EINVAL);
+
+    struct thrd_t *thrd_p;
+    struct profiler_sample_t sample;
+    uint32_t i;
+    int j;
+    int8_t sampling;
+
+    sampling = module.sampling;
+    module.sampling = 0;
+
+    std_fprintf(chan_p, OSTR("PROFILER-BEGIN\r\n"));
+
+    /* Lets the host find the load address of a position independent
+       executable. */
+    std_fprintf(chan_p,
+                OSTR("symbol profiler_print 0x%08lx\r\n"),
+                (unsigned long)(uintptr_t)profiler_print);
+
+    thrd_p = thrd_trace_get_threads();
+
+    while (thrd_p != NULL) {
+        std_fprintf(chan_p,
+                    OSTR("thread 0x%08lx %s\r\n"),
+                    (unsigned long)(uintptr_t)thrd_p,
+                    thrd_p->name_p);
+        thrd_p = thrd_p->next_p;
+    }
+
+    i = 0;
+
+    while (read_sample(i, &sample) == 1) {
+        std_fprintf(chan_p,
+                    OSTR("sample 0x%08lx"),
+                    (unsigned long)(uintptr_t)sample.thrd_p);
+
+        for (j = 0; j < sample.length; j++) {
+            std_fprintf(chan_p,
+                        OSTR(" 0x%08lx"),
+                        (unsigned long)sample.pcs[j]);
+        }
+
+        std_fprintf(chan_p, OSTR("\r\n"));
+        i++;
+    }
+
+    std_fprintf(chan_p,
+                OSTR("dropped %lu\r\n"),
+                (unsigned long)module.dropped);
+    std_fprintf(chan_p, OSTR("PROFILER-END\r\n"));
+
+    module.sampling = sampling;
+
+    return (0);
+}
+
+#endif
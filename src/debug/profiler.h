@@ -0,0 +1,115 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2014-2018, Erik Moqvist
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use, copy,
+ * modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ * This file is part of the Simba project.
+ */
+
+#ifndef __DEBUG_PROFILER_H__
+#define __DEBUG_PROFILER_H__
+
+#include "simba.h"
+
+/**
+ * A profiler sample. The first address is the interrupted program
+ * counter, followed by return addresses, most recent call first.
+ */
+struct profiler_sample_t {
+    /** Interrupted thread, or NULL if not a thread. */
+    struct thrd_t *thrd_p;
+    /** Number of addresses in `pcs`. */
+    uint8_t length;
+    uintptr_t pcs[1 + CONFIG_PROFILER_BACKTRACE_DEPTH];
+};
+
+/**
+ * Initialize the profiler module. This function must be called
+ * before calling any other function in this module.
+ *
+ * The module will only be initialized once even if this function is
+ * called multiple times.
+ *
+ * @return zero(0) or negative error code.
+ */
+int profiler_module_init(void);
+
+/**
+ * Start sampling.
+ *
+ * @return zero(0) or negative error code, -ENOSYS if the port has no
+ *         sampling support.
+ */
+int profiler_start(void);
+
+/**
+ * Stop sampling. The buffer is left untouched.
+ *
+ * @return zero(0) or negative error code.
+ */
+int profiler_stop(void);
+
+/**
+ * Remove all samples from the buffer and clear the dropped samples
+ * counter.
+ *
+ * @return zero(0) or negative error code.
+ */
+int profiler_reset(void);
+
+/**
+ * Add a sample to the buffer if sampling is started. The sample is
+ * dropped if the buffer is full. Called by the port from the sampling
+ * interrupt.
+ *
+ * @param[in] thrd_p Interrupted thread, or NULL if not a thread.
+ * @param[in] pcs_p Program counter followed by return addresses.
+ * @param[in] length Number of addresses in `pcs_p`.
+ */
+void profiler_sample_isr(struct thrd_t *thrd_p,
+                         const uintptr_t *pcs_p,
+                         int length);
+
+/**
+ * Copy samples from the buffer, oldest first. The samples are not
+ * removed from the buffer.
+ *
+ * @param[out] samples_p Destination array.
+ * @param[in] length Number of samples in the destination array.
+ *
+ * @return Number of copied samples or negative error code.
+ */
+ssize_t profiler_read(struct profiler_sample_t *samples_p, size_t length);
+
+/**
+ * Print all threads and samples in the buffer to given channel in the
+ * text format read by ``bin/profiler.py``. Sampling is paused while
+ * printing.
+ *
+ * @param[in] chan_p Output channel.
+ *
+ * @return zero(0) or negative error code.
+ */
+int profiler_print(void *chan_p);
+
+#endif
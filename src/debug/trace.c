@@ -0,0 +1,233 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2014-2018, Erik Moqvist
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use, copy,
+ * modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ * This file is part of the Simba project.
+ */
+
+#include "simba.h"
+
+#if CONFIG_TRACE == 1
+
+#define BUFFER_MASK (CONFIG_TRACE_BUFFER_SIZE - 1)
+
+#if (CONFIG_TRACE_BUFFER_SIZE & BUFFER_MASK) != 0
+#    error "CONFIG_TRACE_BUFFER_SIZE must be a power of two."
+#endif
+
+struct module_t {
+    int8_t initialized;
+    int8_t recording;
+    uint32_t head;
+    uint32_t length;
+    struct trace_record_t records[CONFIG_TRACE_BUFFER_SIZE];
+#if CONFIG_TRACE_FS_COMMANDS == 1
+    struct fs_command_t cmd_print;
+    struct fs_command_t cmd_reset;
+#endif
+};
+
+/* Provided by the thread module. */
+extern uint32_t thrd_cycles_get_isr(void);
+extern struct thrd_t *thrd_trace_get_threads(void);
+
+static struct module_t module;
+
+#if CONFIG_TRACE_FS_COMMANDS == 1
+
+static int cmd_print_cb(int argc,
+                        const char *argv[],
+                        void *out_p,
+                        void *in_p,
+                        void *arg_p,
+                        void *call_arg_p)
+{
+    return (trace_print(out_p));
+}
+
+static int cmd_reset_cb(int argc,
+                        const char *argv[],
+                        void *out_p,
+                        void *in_p,
+                        void *arg_p,
+                        void *call_arg_p)
+{
+    return (trace_reset());
+}
+
+#endif
+
+/**
+ * Copy the record at given index, counted from the oldest record.
+ */
+static int read_record(uint32_t index, struct trace_record_t *record_p)
+{
+    int res;
+
+    res = 0;
+
+    sys_lock();
+
+    if (index < module.length) {
+        *record_p = module.records[(module.head - module.length + index)
+                                   & BUFFER_MASK];
+        res = 1;
+    }
+
+    sys_unlock();
+
+    return (res);
+}
+
+int trace_module_init()
+{
+    /* Return immediately if the module is already initialized. */
+    if (module.initialized == 1) {
+        return (0);
+    }
+
+    module.initialized = 1;
+    module.head = 0;
+    module.length = 0;
+    module.recording = 1;
+
+#if CONFIG_TRACE_FS_COMMANDS == 1
+    fs_command_init(&module.cmd_print,
+                    CSTR("/debug/trace/print"),
+                    cmd_print_cb,
+                    NULL);
+    fs_command_register(&module.cmd_print);
+
+    fs_command_init(&module.cmd_reset,
+                    CSTR("/debug/trace/reset"),
+                    cmd_reset_cb,
+                    NULL);
+    fs_command_register(&module.cmd_reset);
+#endif
+
+    return (0);
+}
+
+void RAM_CODE trace_write_isr(int type, const void *object_p, int value)
+{
+    struct trace_record_t *record_p;
+
+    if (module.recording == 0) {
+        return;
+    }
+
+    record_p = &module.records[module.head & BUFFER_MASK];
+    record_p->timestamp = thrd_cycles_get_isr();
+    record_p->object = (uint32_t)(uintptr_t)object_p;
+    record_p->type = type;
+    record_p->value = value;
+    module.head++;
+
+    if (module.length < CONFIG_TRACE_BUFFER_SIZE) {
+        module.length++;
+    }
+}
+
+int trace_start()
+{
+    module.recording = 1;
+
+    return (0);
+}
+
+int trace_stop()
+{
+    module.recording = 0;
+
+    return (0);
+}
+
+int trace_reset()
+{
+    sys_lock();
+    module.length = 0;
+    sys_unlock();
+
+    return (0);
+}
+
+ssize_t trace_read(struct trace_record_t *records_p, size_t length)
+{
+    ASSERTN(records_p != NULL, EINVAL);
+
+    size_t i;
+
+    for (i = 0; i < length; i++) {
+        if (read_record(i, &records_p[i]) == 0) {
+            break;
+        }
+    }
+
+    return (i);
+}
+
+int trace_print(void *chan_p)
+{
+    ASSERTN(chan_p != NULL, EINVAL);
+
+    struct thrd_t *thrd_p;
+    struct trace_record_t record;
+    uint32_t i;
+    int8_t recording;
+
+    recording = module.recording;
+    module.recording = 0;
+
+    std_fprintf(chan_p, OSTR("TRACE-BEGIN\r\n"));
+
+    thrd_p = thrd_trace_get_threads();
+
+    while (thrd_p != NULL) {
+        std_fprintf(chan_p,
+                    OSTR("thread 0x%08lx %s\r\n"),
+                    (unsigned long)(uint32_t)(uintptr_t)thrd_p,
+                    thrd_p->name_p);
+        thrd_p = thrd_p->next_p;
+    }
+
+    i = 0;
+
+    while (read_record(i, &record) == 1) {
+        std_fprintf(chan_p,
+                    OSTR("record 0x%08lx %u 0x%08lx %d\r\n"),
+                    (unsigned long)record.timestamp,
+                    (unsigned int)record.type,
+                    (unsigned long)record.object,
+                    (int)record.value);
+        i++;
+    }
+
+    std_fprintf(chan_p, OSTR("TRACE-END\r\n"));
+
+    module.recording = recording;
+
+    return (0);
+}
+
+#endif
@@ -0,0 +1,145 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2014-2018, Erik Moqvist
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use, copy,
+ * modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ * This file is part of the Simba project.
+ */
+
+#ifndef __DEBUG_TRACE_H__
+#define __DEBUG_TRACE_H__
+
+#include "simba.h"
+
+/* Record types. */
+
+/** A thread was swapped in. The object is the swapped in thread. */
+#define TRACE_TYPE_THRD_SWITCH                              1
+/** A thread was resumed, often from an interrupt. The object is the
+    resumed thread. */
+#define TRACE_TYPE_THRD_RESUME                              2
+/** A timer expired. The object is the timer. */
+#define TRACE_TYPE_TIMER_EXPIRE                             3
+/** The current thread blocked on a queue. */
+#define TRACE_TYPE_QUEUE_BLOCK                              4
+/** The blocked thread continued after waiting on a queue. */
+#define TRACE_TYPE_QUEUE_UNBLOCK                            5
+/** The current thread blocked on a semaphore. */
+#define TRACE_TYPE_SEM_BLOCK                                6
+/** The blocked thread continued after waiting on a semaphore. */
+#define TRACE_TYPE_SEM_UNBLOCK                              7
+/** The current thread blocked on a mutex. */
+#define TRACE_TYPE_MUTEX_BLOCK                              8
+/** The blocked thread continued after waiting on a mutex. */
+#define TRACE_TYPE_MUTEX_UNBLOCK                            9
+
+/**
+ * Write a record to the trace buffer. Expands to nothing if
+ * ``CONFIG_TRACE`` is disabled. Must be called with the system lock
+ * taken or from an isr.
+ */
+#if CONFIG_TRACE == 1
+#    define TRACE_ISR(type, object_p, value)    \
+    trace_write_isr(TRACE_TYPE_ ## type, object_p, value)
+#else
+#    define TRACE_ISR(type, object_p, value)
+#endif
+
+/**
+ * A trace record. Object pointers are truncated to 32 bits.
+ */
+struct trace_record_t {
+    uint32_t timestamp;
+    uint32_t object;
+    uint8_t type;
+    int8_t value;
+};
+
+/**
+ * Initialize the trace module. This function must be called before
+ * calling any other function in this module.
+ *
+ * The module will only be initialized once even if this function is
+ * called multiple times.
+ *
+ * @return zero(0) or negative error code.
+ */
+int trace_module_init(void);
+
+/**
+ * Write a record to the trace buffer, overwriting the oldest record
+ * if the buffer is full. Use the `TRACE_ISR()` macro instead of
+ * calling this function directly. This function must be called with
+ * the system lock taken or from an isr.
+ *
+ * @param[in] type Record type, one of ``TRACE_TYPE_*``.
+ * @param[in] object_p Object the record refers to.
+ * @param[in] value Record specific value, the priority of the thread
+ *                  for thread records.
+ */
+void trace_write_isr(int type, const void *object_p, int value);
+
+/**
+ * Start recording. Recording is started by `trace_module_init()`.
+ *
+ * @return zero(0) or negative error code.
+ */
+int trace_start(void);
+
+/**
+ * Stop recording. The buffer is left untouched.
+ *
+ * @return zero(0) or negative error code.
+ */
+int trace_stop(void);
+
+/**
+ * Remove all records from the trace buffer.
+ *
+ * @return zero(0) or negative error code.
+ */
+int trace_reset(void);
+
+/**
+ * Copy records from the trace buffer, oldest first. The records are
+ * not removed from the buffer.
+ *
+ * @param[out] records_p Destination array.
+ * @param[in] length Number of records in the destination array.
+ *
+ * @return Number of copied records or negative error code.
+ */
+ssize_t trace_read(struct trace_record_t *records_p, size_t length);
+
+/**
+ * Print all threads and records in the trace buffer to given channel
+ * in the text format read by ``bin/trace.py``. Recording is stopped
+ * while printing.
+ *
+ * @param[in] chan_p Output channel.
+ *
+ * @return zero(0) or negative error code.
+ */
+int trace_print(void *chan_p);
+
+#endif
@@ -34,6 +34,47 @@ struct module_t {
     int8_t initialized;
 };
 
+#if defined(ADC_PORT_HAS_STREAM)
+
+/**
+ * Called by the port when the hardware has filled given block of
+ * stream samples. Writes the block to the ring buffer and resumes the
+ * reader. Blocks are dropped from an overrun until it has been
+ * reported to the reader.
+ */
+static void RAM_CODE stream_write_block_isr(struct adc_stream_t *self_p,
+                                            const uint16_t *block_p)
+{
+    size_t size;
+
+    size = (self_p->block_length * sizeof(*block_p));
+
+    if (self_p->overrun == 0) {
+        if (circular_buffer_unused_size(&self_p->buffer) < size) {
+            self_p->overrun = 1;
+        } else {
+            circular_buffer_write(&self_p->buffer, block_p, size);
+        }
+    }
+
+    if (self_p->reader.thrd_p != NULL) {
+        if ((self_p->overrun == 1)
+            || (circular_buffer_used_size(&self_p->buffer)
+                >= self_p->reader.size)) {
+            thrd_resume_isr(self_p->reader.thrd_p, 0);
+            self_p->reader.thrd_p = NULL;
+        }
+    }
+
+    /* Resume any polling thread. */
+    if (chan_is_polled_isr(&self_p->base)) {
+        thrd_resume_isr(self_p->base.reader_p, 0);
+        self_p->base.reader_p = NULL;
+    }
+}
+
+#endif
+
 #include "adc_port.i"
 
 static struct module_t module;
@@ -106,6 +147,142 @@ RAM_CODE int adc_convert_isr(struct adc_driver_t *self_p,
     return (adc_port_convert_isr(self_p, sample_p));
 }
 
+static ssize_t stream_read_cb(void *base_p, void *buf_p, size_t size)
+{
+    return (adc_stream_read(base_p, buf_p, size));
+}
+
+static size_t stream_size_cb(void *base_p)
+{
+    struct adc_stream_t *self_p;
+    size_t size;
+
+    self_p = base_p;
+
+    sys_lock();
+    size = circular_buffer_used_size(&self_p->buffer);
+    sys_unlock();
+
+    return (size);
+}
+
+int adc_stream_init(struct adc_stream_t *self_p,
+                    struct adc_device_t *dev_p,
+                    struct pin_device_t **pin_devices_pp,
+                    int number_of_channels,
+                    long sampling_rate,
+                    uint16_t *blocks_p,
+                    size_t block_length,
+                    void *buf_p,
+                    size_t size)
+{
+    ASSERTN(self_p != NULL, EINVAL);
+    ASSERTN(adc_is_valid_device(dev_p), EINVAL);
+    ASSERTN(pin_devices_pp != NULL, EINVAL);
+    ASSERTN(number_of_channels > 0, EINVAL);
+    ASSERTN(number_of_channels <= CONFIG_ADC_STREAM_CHANNELS_MAX, EINVAL);
+    ASSERTN(sampling_rate > 0, EINVAL);
+    ASSERTN(blocks_p != NULL, EINVAL);
+    ASSERTN(block_length > 0, EINVAL);
+    ASSERTN((block_length % number_of_channels) == 0, EINVAL);
+    ASSERTN(buf_p != NULL, EINVAL);
+    ASSERTN(size > 2 * block_length * sizeof(*blocks_p), EINVAL);
+
+    int i;
+
+    for (i = 0; i < number_of_channels; i++) {
+        ASSERTN(pin_is_valid_device(pin_devices_pp[i]), EINVAL);
+    }
+
+    chan_init(&self_p->base,
+              stream_read_cb,
+              chan_write_null,
+              stream_size_cb);
+
+    self_p->dev_p = dev_p;
+    self_p->sampling_rate = sampling_rate;
+    self_p->number_of_channels = number_of_channels;
+    self_p->blocks_p = blocks_p;
+    self_p->block_length = block_length;
+    self_p->overrun = 0;
+    self_p->reader.thrd_p = NULL;
+    circular_buffer_init(&self_p->buffer, buf_p, size);
+
+#if defined(ADC_PORT_HAS_STREAM)
+    return (adc_port_stream_init(self_p, pin_devices_pp));
+#else
+    return (-ENOSYS);
+#endif
+}
+
+int adc_stream_start(struct adc_stream_t *self_p)
+{
+    ASSERTN(self_p != NULL, EINVAL);
+
+#if defined(ADC_PORT_HAS_STREAM)
+    sys_lock();
+    circular_buffer_skip_front(&self_p->buffer,
+                               circular_buffer_used_size(&self_p->buffer));
+    self_p->overrun = 0;
+    sys_unlock();
+
+    return (adc_port_stream_start(self_p));
+#else
+    return (-ENOSYS);
+#endif
+}
+
+int adc_stream_stop(struct adc_stream_t *self_p)
+{
+    ASSERTN(self_p != NULL, EINVAL);
+
+#if defined(ADC_PORT_HAS_STREAM)
+    return (adc_port_stream_stop(self_p));
+#else
+    return (-ENOSYS);
+#endif
+}
+
+ssize_t adc_stream_read(struct adc_stream_t *self_p,
+                        void *buf_p,
+                        size_t size)
+{
+    ASSERTN(self_p != NULL, EINVAL);
+    ASSERTN(buf_p != NULL, EINVAL);
+    ASSERTN(size < self_p->buffer.size, EINVAL);
+
+    ssize_t res;
+    size_t used;
+
+    sys_lock();
+
+    while (1) {
+        used = circular_buffer_used_size(&self_p->buffer);
+
+        if (used >= size) {
+            res = circular_buffer_read(&self_p->buffer, buf_p, size);
+            break;
+        }
+
+        if (self_p->overrun == 1) {
+            /* Discard the samples before the gap and resume at the
+               next block. */
+            circular_buffer_skip_front(&self_p->buffer, used);
+            self_p->overrun = 0;
+            res = -EOVERFLOW;
+            break;
+        }
+
+        self_p->reader.thrd_p = thrd_self();
+        self_p->reader.size = size;
+        thrd_suspend_isr(NULL);
+    }
+
+    sys_unlock();
+
+    return (res);
+}
+
 int adc_is_valid_device(struct adc_device_t *dev_p)
 {
     return ((dev_p >= &adc_device[0])
@@ -37,6 +37,28 @@
  */
 #define ADC_REFERENCE_VCC ADC_PORT_REFERENCE_VCC
 
+/**
+ * Continuous, timer triggered convertion of one or more interleaved
+ * channels into a ring buffer.
+ */
+struct adc_stream_t {
+    struct chan_t base;
+    struct adc_device_t *dev_p;
+    long sampling_rate;
+    int number_of_channels;
+    uint16_t *blocks_p;
+    size_t block_length;
+    struct circular_buffer_t buffer;
+    int overrun;
+    struct {
+        struct thrd_t *thrd_p;
+        size_t size;
+    } reader;
+#if defined(ADC_PORT_HAS_STREAM)
+    struct adc_stream_port_t port;
+#endif
+};
+
 extern struct adc_device_t adc_device[ADC_DEVICE_MAX];
 
 /**
@@ -126,6 +148,87 @@ int adc_convert(struct adc_driver_t *self_p,
 int adc_convert_isr(struct adc_driver_t *self_p,
                     uint16_t *sample_p);
 
+/**
+ * Initialize given stream object. The stream converts given channels
+ * in order on each timer trigger, and the interleaved samples are
+ * delivered to the ring buffer in blocks of given number of
+ * samples. The hardware fills one of the two blocks in the block
+ * buffer, by DMA if supported, while the other one is copied to the
+ * ring buffer.
+ *
+ * The ADC device cannot be used for other convertions while the
+ * stream is started. All channels are converted using the supply
+ * voltage as reference.
+ *
+ * @param[out] self_p Stream object to initialize.
+ * @param[in] dev_p ADC device to use.
+ * @param[in] pin_devices_pp Pin devices of the channels to convert,
+ *                           in order. At most
+ *                           ``CONFIG_ADC_STREAM_CHANNELS_MAX``.
+ * @param[in] number_of_channels Number of pin devices.
+ * @param[in] sampling_rate Sampling rate per channel in Hz.
+ * @param[in] blocks_p Block buffer of two times block length
+ *                     samples.
+ * @param[in] block_length Number of samples in a block. Must be a
+ *                         multiple of the number of channels.
+ * @param[in] buf_p Ring buffer.
+ * @param[in] size Size of the ring buffer in bytes. Must fit at least
+ *                 two blocks.
+ *
+ * @return zero(0) or negative error code. Returns -ENOSYS if
+ *         streaming is not supported by the port.
+ */
+int adc_stream_init(struct adc_stream_t *self_p,
+                    struct adc_device_t *dev_p,
+                    struct pin_device_t **pin_devices_pp,
+                    int number_of_channels,
+                    long sampling_rate,
+                    uint16_t *blocks_p,
+                    size_t block_length,
+                    void *buf_p,
+                    size_t size);
+
+/**
+ * Start continuous convertions. The ring buffer is emptied.
+ *
+ * @param[in] self_p Initialized stream object.
+ *
+ * @return zero(0) or negative error code. Returns -EBUSY if other
+ *         convertions are ongoing on the device.
+ */
+int adc_stream_start(struct adc_stream_t *self_p);
+
+/**
+ * Stop continuous convertions.
+ *
+ * @param[in] self_p Started stream object.
+ *
+ * @return zero(0) or negative error code.
+ */
+int adc_stream_stop(struct adc_stream_t *self_p);
+
+/**
+ * Read interleaved samples from given stream. Blocks until given
+ * number of bytes are available. The stream object is also a
+ * channel, so `chan_read()` and `chan_poll()` can be used as well.
+ *
+ * A block is lost if the ring buffer is full when it is
+ * converted. This is reported as -EOVERFLOW by the first read that
+ * cannot be completed with the samples converted before the
+ * overrun. Those samples are discarded, and convertions resume at a
+ * block boundary, the first channel first.
+ *
+ * @param[in] self_p Started stream object.
+ * @param[out] buf_p Read samples.
+ * @param[in] size Number of bytes to read. Must be smaller than the
+ *                 ring buffer.
+ *
+ * @return Number of read bytes or negative error code.
+ */
+ssize_t adc_stream_read(struct adc_stream_t *self_p,
+                        void *buf_p,
+                        size_t size);
+
 /**
  * Check if given ADC device is valid.
  *
@@ -34,6 +34,29 @@ struct module_t {
     int8_t initialized;
 };
 
+#if defined(DAC_PORT_HAS_STREAM)
+
+/**
+ * Called by the port to refill given stream buffer. Returns the
+ * number of samples written by the fill callback, which the port
+ * pads to a full buffer.
+ */
+static size_t RAM_CODE stream_fill_isr(struct dac_stream_t *self_p,
+                                       void *samples_p)
+{
+    size_t length;
+
+    length = self_p->fill(self_p->arg_p, samples_p, self_p->length);
+
+    if (length < self_p->length) {
+        self_p->underruns++;
+    }
+
+    return (length);
+}
+
+#endif
+
 #include "dac_port.i"
 
 static struct module_t module;
@@ -98,4 +121,71 @@ int dac_convert(struct dac_driver_t *self_p,
     return (dac_port_convert(self_p, samples_p, length));
 }
 
+int dac_stream_init(struct dac_stream_t *self_p,
+                    struct dac_driver_t *drv_p,
+                    void **buffers_pp,
+                    int number_of_buffers,
+                    size_t length,
+                    dac_stream_fill_t fill,
+                    void *arg_p)
+{
+    ASSERTN(self_p != NULL, EINVAL);
+    ASSERTN(drv_p != NULL, EINVAL);
+    ASSERTN(buffers_pp != NULL, EINVAL);
+    ASSERTN((number_of_buffers == 2) || (number_of_buffers == 3), EINVAL);
+    ASSERTN(length > 0, EINVAL);
+    ASSERTN(fill != NULL, EINVAL);
+
+    self_p->drv_p = drv_p;
+    self_p->buffers_pp = buffers_pp;
+    self_p->number_of_buffers = number_of_buffers;
+    self_p->length = length;
+    self_p->fill = fill;
+    self_p->arg_p = arg_p;
+    self_p->underruns = 0;
+
+#if defined(DAC_PORT_HAS_STREAM)
+    return (0);
+#else
+    return (-ENOSYS);
+#endif
+}
+
+int dac_stream_start(struct dac_stream_t *self_p)
+{
+    ASSERTN(self_p != NULL, EINVAL);
+
+    self_p->underruns = 0;
+
+#if defined(DAC_PORT_HAS_STREAM)
+    return (dac_port_stream_start(self_p));
+#else
+    return (-ENOSYS);
+#endif
+}
+
+int dac_stream_stop(struct dac_stream_t *self_p)
+{
+    ASSERTN(self_p != NULL, EINVAL);
+
+#if defined(DAC_PORT_HAS_STREAM)
+    return (dac_port_stream_stop(self_p));
+#else
+    return (-ENOSYS);
+#endif
+}
+
+uint32_t dac_stream_get_underruns(struct dac_stream_t *self_p)
+{
+    ASSERTN(self_p != NULL, EINVAL);
+
+    uint32_t underruns;
+
+    sys_lock();
+    underruns = self_p->underruns;
+    sys_unlock();
+
+    return (underruns);
+}
+
 #endif
@@ -32,6 +32,41 @@
 #include "simba.h"
 #include "dac_port.h"
 
+/**
+ * Stream fill callback. Called from interrupt context when the
+ * hardware has finished converting a buffer, to refill it with the
+ * next samples. It must return quickly, so samples should be
+ * produced ahead of time by a thread.
+ *
+ * @param[in] arg_p Argument given to `dac_stream_init()`.
+ * @param[out] samples_p Buffer to fill.
+ * @param[in] length Length of the buffer.
+ *
+ * @return Number of written samples. Returning fewer than length
+ *         samples is an underrun, and the rest of the buffer is
+ *         filled with the last sample.
+ */
+typedef size_t (*dac_stream_fill_t)(void *arg_p,
+                                    void *samples_p,
+                                    size_t length);
+
+/**
+ * Continuous convertion of samples pulled from a callback into two
+ * or three buffers.
+ */
+struct dac_stream_t {
+    struct dac_driver_t *drv_p;
+    void **buffers_pp;
+    int number_of_buffers;
+    size_t length;
+    dac_stream_fill_t fill;
+    void *arg_p;
+    uint32_t underruns;
+#if defined(DAC_PORT_HAS_STREAM)
+    struct dac_stream_port_t port;
+#endif
+};
+
 extern struct dac_device_t dac_device[DAC_DEVICE_MAX];
 
 /**
@@ -97,4 +132,65 @@ int dac_convert(struct dac_driver_t *self_p,
                 void *samples_p,
                 size_t length);
 
+/**
+ * Initialize given stream object. All buffers are filled by the
+ * callback when the stream is started. Then, each time the hardware
+ * has finished converting a buffer, it is refilled while the
+ * following buffer is converted. Three buffers gives the callback
+ * one more buffer period of margin than two.
+ *
+ * The sample format is the same as for `dac_async_convert()`.
+ *
+ * @param[out] self_p Stream object to initialize.
+ * @param[in] drv_p Initialized driver object to convert samples
+ *                  with, at its sampling rate.
+ * @param[in] buffers_pp Array of sample buffers.
+ * @param[in] number_of_buffers Number of sample buffers, two or
+ *                              three.
+ * @param[in] length Length of each sample buffer.
+ * @param[in] fill Callback filling buffers with samples.
+ * @param[in] arg_p Callback argument.
+ *
+ * @return zero(0) or negative error code. Returns -ENOSYS if
+ *         streaming is not supported by the port.
+ */
+int dac_stream_init(struct dac_stream_t *self_p,
+                    struct dac_driver_t *drv_p,
+                    void **buffers_pp,
+                    int number_of_buffers,
+                    size_t length,
+                    dac_stream_fill_t fill,
+                    void *arg_p);
+
+/**
+ * Fill all buffers and start continuous convertions. The underrun
+ * counter is cleared.
+ *
+ * @param[in] self_p Initialized stream object.
+ *
+ * @return zero(0) or negative error code. Returns -EBUSY if other
+ *         convertions are ongoing on the device.
+ */
+int dac_stream_start(struct dac_stream_t *self_p);
+
+/**
+ * Stop continuous convertions. The output keeps the last converted
+ * value.
+ *
+ * @param[in] self_p Started stream object.
+ *
+ * @return zero(0) or negative error code.
+ */
+int dac_stream_stop(struct dac_stream_t *self_p);
+
+/**
+ * Get the number of buffers the fill callback has not filled
+ * completely since the stream was started.
+ *
+ * @param[in] self_p Stream object.
+ *
+ * @return Number of underruns.
+ */
+uint32_t dac_stream_get_underruns(struct dac_stream_t *self_p);
+
 #endif
@@ -0,0 +1,307 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2014-2018, Erik Moqvist
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use, copy,
+ * modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ * This file is part of the Simba project.
+ */
+
+
+#include "simba.h"
+
+#if CONFIG_DMA == 1
+
+struct module_t {
+    int8_t initialized;
+};
+
+static struct module_t module;
+
+/**
+ * Called by the port from interrupt context, or with the system lock
+ * taken, when the transfer on given channel is complete or has
+ * failed.
+ */
+static void transfer_complete_isr(struct dma_driver_t *self_p, int res)
+{
+    struct dma_transfer_t *transfer_p;
+
+    transfer_p = self_p->transfer_p;
+
+    if (transfer_p == NULL) {
+        return;
+    }
+
+    if (((transfer_p->flags & DMA_CIRCULAR) == 0) || (res != 0)) {
+        self_p->transfer_p = NULL;
+        self_p->res = res;
+#if CONFIG_POWER == 1
+        power_stay_awake_release_isr(POWER_MODE_IDLE);
+#endif
+
+        if (self_p->thrd_p != NULL) {
+            thrd_resume_isr(self_p->thrd_p, res);
+            self_p->thrd_p = NULL;
+        }
+    }
+
+    if (transfer_p->callback != NULL) {
+        transfer_p->callback(transfer_p->arg_p, res);
+    }
+}
+
+#include "dma_port.i"
+
+int dma_module_init(void)
+{
+    /* Return immediately if the module is already initialized. */
+    if (module.initialized == 1) {
+        return (0);
+    }
+
+    module.initialized = 1;
+
+    return (dma_port_module_init());
+}
+
+int dma_init(struct dma_driver_t *self_p,
+             struct dma_device_t *dev_p,
+             int request)
+{
+    ASSERTN(self_p != NULL, EINVAL);
+    ASSERTN(dev_p != NULL, EINVAL);
+
+    int res;
+
+    self_p->dev_p = dev_p;
+    self_p->transfer_p = NULL;
+    self_p->thrd_p = NULL;
+    self_p->res = 0;
+
+    sys_lock();
+    res = dma_port_channel_alloc(self_p, request);
+    sys_unlock();
+
+    return (res);
+}
+
+int dma_deinit(struct dma_driver_t *self_p)
+{
+    ASSERTN(self_p != NULL, EINVAL);
+
+    dma_stop(self_p);
+
+    sys_lock();
+    dma_port_channel_free(self_p);
+    sys_unlock();
+
+    return (0);
+}
+
+int dma_transfer_init(struct dma_transfer_t *self_p,
+                      int direction,
+                      volatile void *dst_p,
+                      const volatile void *src_p,
+                      size_t length,
+                      int flags)
+{
+    ASSERTN(self_p != NULL, EINVAL);
+    ASSERTN(dst_p != NULL, EINVAL);
+    ASSERTN(src_p != NULL, EINVAL);
+    ASSERTN(length > 0, EINVAL);
+
+    if ((direction != DMA_MEMORY_TO_MEMORY)
+        && (direction != DMA_MEMORY_TO_PERIPHERAL)
+        && (direction != DMA_PERIPHERAL_TO_MEMORY)) {
+        return (-EINVAL);
+    }
+
+    if ((flags & DMA_WIDTH_MASK) > DMA_WIDTH_32) {
+        return (-EINVAL);
+    }
+
+    if (length > DMA_PORT_LENGTH_MAX) {
+        return (-EINVAL);
+    }
+
+    self_p->direction = direction;
+    self_p->flags = flags;
+    self_p->dst_p = dst_p;
+    self_p->src_p = src_p;
+    self_p->length = length;
+    self_p->callback = NULL;
+    self_p->arg_p = NULL;
+
+    return (0);
+}
+
+int dma_transfer_set_callback(struct dma_transfer_t *self_p,
+                              dma_callback_t callback,
+                              void *arg_p)
+{
+    ASSERTN(self_p != NULL, EINVAL);
+
+    self_p->callback = callback;
+    self_p->arg_p = arg_p;
+
+    return (0);
+}
+
+int dma_async_start(struct dma_driver_t *self_p,
+                    struct dma_transfer_t *transfer_p)
+{
+    ASSERTN(self_p != NULL, EINVAL);
+    ASSERTN(transfer_p != NULL, EINVAL);
+
+    int res;
+
+    sys_lock();
+    res = dma_async_start_isr(self_p, transfer_p);
+    sys_unlock();
+
+    return (res);
+}
+
+int dma_async_start_isr(struct dma_driver_t *self_p,
+                        struct dma_transfer_t *transfer_p)
+{
+    int res;
+
+    if (self_p->transfer_p != NULL) {
+        return (-EBUSY);
+    }
+
+    self_p->transfer_p = transfer_p;
+    self_p->res = 0;
+
+#if CONFIG_POWER == 1
+    /* The DMA controller must run until the transfer is complete. The
+       port may complete it before returning. */
+    power_stay_awake_acquire_isr(POWER_MODE_IDLE);
+#endif
+
+    res = dma_port_start(self_p, transfer_p);
+
+    if (res != 0) {
+        self_p->transfer_p = NULL;
+#if CONFIG_POWER == 1
+        power_stay_awake_release_isr(POWER_MODE_IDLE);
+#endif
+    }
+
+    return (res);
+}
+
+int dma_async_wait(struct dma_driver_t *self_p)
+{
+    ASSERTN(self_p != NULL, EINVAL);
+
+    int res;
+
+    sys_lock();
+
+    if (self_p->transfer_p != NULL) {
+        self_p->thrd_p = thrd_self();
+        res = thrd_suspend_isr(NULL);
+    } else {
+        res = self_p->res;
+    }
+
+    sys_unlock();
+
+    return (res);
+}
+
+int dma_transfer(struct dma_driver_t *self_p,
+                 struct dma_transfer_t *transfer_p)
+{
+    ASSERTN(self_p != NULL, EINVAL);
+    ASSERTN(transfer_p != NULL, EINVAL);
+    ASSERTN((transfer_p->flags & DMA_CIRCULAR) == 0, EINVAL);
+
+    int res;
+
+    res = dma_async_start(self_p, transfer_p);
+
+    if (res != 0) {
+        return (res);
+    }
+
+    return (dma_async_wait(self_p));
+}
+
+int dma_stop(struct dma_driver_t *self_p)
+{
+    ASSERTN(self_p != NULL, EINVAL);
+
+    int res;
+
+    sys_lock();
+    res = dma_stop_isr(self_p);
+    sys_unlock();
+
+    return (res);
+}
+
+int dma_stop_isr(struct dma_driver_t *self_p)
+{
+    if (self_p->transfer_p != NULL) {
+        dma_port_stop(self_p);
+        self_p->transfer_p = NULL;
+        self_p->res = -ECANCELED;
+#if CONFIG_POWER == 1
+        power_stay_awake_release_isr(POWER_MODE_IDLE);
+#endif
+
+        if (self_p->thrd_p != NULL) {
+            thrd_resume_isr(self_p->thrd_p, -ECANCELED);
+            self_p->thrd_p = NULL;
+        }
+    }
+
+    return (0);
+}
+
+ssize_t dma_get_remaining(struct dma_driver_t *self_p)
+{
+    ASSERTN(self_p != NULL, EINVAL);
+
+    ssize_t res;
+
+    sys_lock();
+    res = dma_get_remaining_isr(self_p);
+    sys_unlock();
+
+    return (res);
+}
+
+ssize_t dma_get_remaining_isr(struct dma_driver_t *self_p)
+{
+    if (self_p->transfer_p == NULL) {
+        return (0);
+    }
+
+    return (dma_port_get_remaining(self_p));
+}
+
+#endif
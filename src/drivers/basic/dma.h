@@ -0,0 +1,230 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2014-2018, Erik Moqvist
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use, copy,
+ * modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ * This file is part of the Simba project.
+ */
+
+#ifndef __DRIVERS_DMA_H__
+#define __DRIVERS_DMA_H__
+
+#include "simba.h"
+#include "dma_port.h"
+
+/* Transfer directions. */
+#define DMA_MEMORY_TO_MEMORY                                    0
+#define DMA_MEMORY_TO_PERIPHERAL                                1
+#define DMA_PERIPHERAL_TO_MEMORY                                2
+
+/* Transfer flags. */
+#define DMA_WIDTH_8                                          0x00
+#define DMA_WIDTH_16                                         0x01
+#define DMA_WIDTH_32                                         0x02
+#define DMA_WIDTH_MASK                                       0x03
+#define DMA_CIRCULAR                                         0x10
+
+/* Use any channel, for memory to memory transfers. */
+#define DMA_REQUEST_NONE                                       -1
+
+/**
+ * Transfer completion callback, called from interrupt context when
+ * a transfer is complete. In circular mode, it is called each time
+ * the whole buffer has been transferred.
+ *
+ * @param[in] arg_p Callback argument.
+ * @param[in] res Zero(0) on success or negative error code.
+ */
+typedef void (*dma_callback_t)(void *arg_p, int res);
+
+/**
+ * A transfer descriptor.
+ */
+struct dma_transfer_t {
+    int direction;
+    int flags;
+    volatile void *dst_p;
+    const volatile void *src_p;
+    size_t length;
+    dma_callback_t callback;
+    void *arg_p;
+};
+
+extern struct dma_device_t dma_device[DMA_DEVICE_MAX];
+
+/**
+ * Initialize the DMA driver module. This function must be called
+ * before calling any other function in this module.
+ *
+ * The module will only be initialized once even if this function is
+ * called multiple times.
+ *
+ * @return zero(0) or negative error code.
+ */
+int dma_module_init(void);
+
+/**
+ * Initialize given driver object and allocate a channel of given DMA
+ * controller for given peripheral request.
+ *
+ * @param[out] self_p Driver object to initialize.
+ * @param[in] dev_p DMA controller to use.
+ * @param[in] request Peripheral request, the hardware handshaking
+ *                    interface on SAM and the channel number on
+ *                    STM32, or ``DMA_REQUEST_NONE`` for memory to
+ *                    memory transfers.
+ *
+ * @return zero(0) or negative error code, -EBUSY if no channel is
+ *         available.
+ */
+int dma_init(struct dma_driver_t *self_p,
+             struct dma_device_t *dev_p,
+             int request);
+
+/**
+ * Stop any ongoing transfer and free the channel allocated by
+ * `dma_init()`.
+ *
+ * @param[in] self_p Driver object.
+ *
+ * @return zero(0) or negative error code.
+ */
+int dma_deinit(struct dma_driver_t *self_p);
+
+/**
+ * Initialize given transfer descriptor. The peripheral address is
+ * not incremented, while memory addresses are.
+ *
+ * @param[out] self_p Transfer descriptor to initialize.
+ * @param[in] direction Transfer direction, one of
+ *                      ``DMA_MEMORY_TO_MEMORY``,
+ *                      ``DMA_MEMORY_TO_PERIPHERAL`` and
+ *                      ``DMA_PERIPHERAL_TO_MEMORY``.
+ * @param[in] dst_p Destination address.
+ * @param[in] src_p Source address.
+ * @param[in] length Number of elements of given width to transfer.
+ * @param[in] flags Element width ``DMA_WIDTH_*``, optionally ored
+ *                  with ``DMA_CIRCULAR`` to restart the transfer
+ *                  from the beginning of the buffer each time it
+ *                  completes.
+ *
+ * @return zero(0) or negative error code.
+ */
+int dma_transfer_init(struct dma_transfer_t *self_p,
+                      int direction,
+                      volatile void *dst_p,
+                      const volatile void *src_p,
+                      size_t length,
+                      int flags);
+
+/**
+ * Set the completion callback of given transfer descriptor.
+ *
+ * @param[in] self_p Transfer descriptor.
+ * @param[in] callback Callback called from interrupt context, or
+ *                     NULL.
+ * @param[in] arg_p Callback argument.
+ *
+ * @return zero(0) or negative error code.
+ */
+int dma_transfer_set_callback(struct dma_transfer_t *self_p,
+                              dma_callback_t callback,
+                              void *arg_p);
+
+/**
+ * Start given transfer on given channel. The descriptor must be kept
+ * until the transfer is complete or stopped.
+ *
+ * @param[in] self_p Driver object.
+ * @param[in] transfer_p Transfer to start.
+ *
+ * @return zero(0) or negative error code, -EBUSY if a transfer is
+ *         already ongoing.
+ */
+int dma_async_start(struct dma_driver_t *self_p,
+                    struct dma_transfer_t *transfer_p);
+
+/**
+ * Start given transfer from interrupt context or with the system
+ * lock taken. See `dma_async_start()` for a description.
+ */
+int dma_async_start_isr(struct dma_driver_t *self_p,
+                        struct dma_transfer_t *transfer_p);
+
+/**
+ * Wait for the ongoing transfer to complete. The calling thread is
+ * suspended and resumed by the transfer complete interrupt. A
+ * circular transfer never completes and is ended with `dma_stop()`.
+ *
+ * @param[in] self_p Driver object.
+ *
+ * @return zero(0) or negative error code, -EIO on a transfer error.
+ */
+int dma_async_wait(struct dma_driver_t *self_p);
+
+/**
+ * Start given transfer and wait for it to complete.
+ *
+ * @param[in] self_p Driver object.
+ * @param[in] transfer_p Transfer to perform, not circular.
+ *
+ * @return zero(0) or negative error code.
+ */
+int dma_transfer(struct dma_driver_t *self_p,
+                 struct dma_transfer_t *transfer_p);
+
+/**
+ * Stop the ongoing transfer, if any. A thread waiting in
+ * `dma_async_wait()` is resumed with -ECANCELED.
+ *
+ * @param[in] self_p Driver object.
+ *
+ * @return zero(0) or negative error code.
+ */
+int dma_stop(struct dma_driver_t *self_p);
+
+/**
+ * Stop the ongoing transfer from interrupt context or with the
+ * system lock taken. See `dma_stop()` for a description.
+ */
+int dma_stop_isr(struct dma_driver_t *self_p);
+
+/**
+ * Get the number of elements left to transfer in the current lap of
+ * the ongoing transfer, for example to find how much of a circular
+ * receive buffer has been written.
+ *
+ * @param[in] self_p Driver object.
+ *
+ * @return Number of elements left or negative error code.
+ */
+ssize_t dma_get_remaining(struct dma_driver_t *self_p);
+
+/**
+ * Get the number of elements left to transfer from interrupt context
+ * or with the system lock taken. See `dma_get_remaining()` for a
+ * description.
+ */
+ssize_t dma_get_remaining_isr(struct dma_driver_t *self_p);
+
+#endif
@@ -38,6 +38,42 @@ struct module_t {
 
 static struct module_t module;
 
+#if CONFIG_EXTI_CAPTURE == 1
+
+extern uint32_t thrd_cycles_get_isr(void);
+
+/**
+ * Timestamp the edge first for least jitter, then write it to the
+ * ring buffer, if not full.
+ */
+static RAM_CODE void on_capture_isr(void *arg_p)
+{
+    struct exti_capture_t *self_p;
+    uint32_t timestamp;
+    size_t head;
+
+    timestamp = thrd_cycles_get_isr();
+    self_p = arg_p;
+    head = self_p->head;
+
+    if ((head - self_p->tail) > self_p->mask) {
+        self_p->overflows++;
+
+        return;
+    }
+
+    self_p->buf_p[head & self_p->mask] = timestamp;
+    self_p->head = (head + 1);
+
+    /* Wake the reader once per batch. */
+    if (self_p->thrd_p != NULL) {
+        thrd_resume_isr(self_p->thrd_p, 0);
+        self_p->thrd_p = NULL;
+    }
+}
+
+#endif
+
 int exti_module_init()
 {
     /* Return immediately if the module is already initialized. */
@@ -89,4 +125,101 @@ int exti_clear(struct exti_driver_t *self_p)
     return (exti_port_clear(self_p));
 }
 
+#if CONFIG_EXTI_CAPTURE == 1
+
+int exti_capture_init(struct exti_capture_t *self_p,
+                      struct exti_device_t *dev_p,
+                      int trigger,
+                      uint32_t *buf_p,
+                      size_t length)
+{
+    ASSERTN(self_p != NULL, EINVAL);
+    ASSERTN(buf_p != NULL, EINVAL);
+    ASSERTN((length > 0) && ((length & (length - 1)) == 0), EINVAL);
+
+    self_p->buf_p = buf_p;
+    self_p->mask = (length - 1);
+    self_p->head = 0;
+    self_p->tail = 0;
+    self_p->overflows = 0;
+    self_p->thrd_p = NULL;
+
+    return (exti_init(&self_p->exti, dev_p, trigger, on_capture_isr, self_p));
+}
+
+int exti_capture_start(struct exti_capture_t *self_p)
+{
+    ASSERTN(self_p != NULL, EINVAL);
+
+    return (exti_start(&self_p->exti));
+}
+
+int exti_capture_stop(struct exti_capture_t *self_p)
+{
+    ASSERTN(self_p != NULL, EINVAL);
+
+    return (exti_stop(&self_p->exti));
+}
+
+ssize_t exti_capture_read(struct exti_capture_t *self_p,
+                          uint32_t *timestamps_p,
+                          size_t length,
+                          struct time_t *timeout_p)
+{
+    ASSERTN(self_p != NULL, EINVAL);
+    ASSERTN(timestamps_p != NULL, EINVAL);
+
+    size_t tail;
+    size_t size;
+    size_t i;
+    int res;
+
+    sys_lock();
+
+    if (self_p->head == self_p->tail) {
+        self_p->thrd_p = thrd_self();
+        res = thrd_suspend_isr(timeout_p);
+        self_p->thrd_p = NULL;
+
+        if (res != 0) {
+            sys_unlock();
+
+            return (res);
+        }
+    }
+
+    size = (self_p->head - self_p->tail);
+
+    sys_unlock();
+
+    if (size > length) {
+        size = length;
+    }
+
+    /* Only the interrupt handler writes the head and only this
+       function writes the tail, so the copy is done without the
+       system lock. */
+    tail = self_p->tail;
+
+    for (i = 0; i < size; i++) {
+        timestamps_p[i] = self_p->buf_p[(tail + i) & self_p->mask];
+    }
+
+    /* Free the slots after they have been copied. */
+    sys_lock();
+    self_p->tail = (tail + size);
+    sys_unlock();
+
+    return (size);
+}
+
+uint32_t exti_capture_get_overflows(struct exti_capture_t *self_p)
+{
+    ASSERTN(self_p != NULL, EINVAL);
+
+    return (self_p->overflows);
+}
+
+#endif
+
 #endif
@@ -49,6 +49,21 @@
 
 extern struct exti_device_t exti_device[EXTI_DEVICE_MAX];
 
+/**
+ * Edge capture. Each edge is timestamped in the interrupt handler
+ * and written to a single producer, single consumer ring buffer,
+ * read in batches by a thread.
+ */
+struct exti_capture_t {
+    struct exti_driver_t exti;
+    uint32_t *buf_p;
+    size_t mask;
+    volatile size_t head;
+    volatile size_t tail;
+    uint32_t overflows;
+    struct thrd_t *thrd_p;
+};
+
 /**
  * Initialize the external interrupt (EXTI) module. This function must
  * be called before calling any other function in this module.
@@ -109,4 +124,72 @@ int exti_stop(struct exti_driver_t *self_p);
  */
 int exti_clear(struct exti_driver_t *self_p);
 
+/**
+ * Initialize given capture object. Requires ``CONFIG_EXTI_CAPTURE``.
+ *
+ * @param[out] self_p Capture object to be initialized.
+ * @param[in] dev_p Device to use.
+ * @param[in] trigger One of ``EXTI_TRIGGER_BOTH_EDGES``,
+ *                    ``EXTI_TRIGGER_FALLING_EDGE`` or
+ *                    ``EXTI_TRIGGER_RISING_EDGE``.
+ * @param[in] buf_p Ring buffer of edge timestamps.
+ * @param[in] length Number of timestamps in the ring buffer. Must be
+ *                   a power of two.
+ *
+ * @return zero(0) or negative error code.
+ */
+int exti_capture_init(struct exti_capture_t *self_p,
+                      struct exti_device_t *dev_p,
+                      int trigger,
+                      uint32_t *buf_p,
+                      size_t length);
+
+/**
+ * Start capturing edges.
+ *
+ * @param[in] self_p Capture object.
+ *
+ * @return zero(0) or negative error code.
+ */
+int exti_capture_start(struct exti_capture_t *self_p);
+
+/**
+ * Stop capturing edges. Already captured edges can still be read.
+ *
+ * @param[in] self_p Capture object.
+ *
+ * @return zero(0) or negative error code.
+ */
+int exti_capture_stop(struct exti_capture_t *self_p);
+
+/**
+ * Read captured edge timestamps, oldest first. Waits for at least
+ * one edge, then reads as many as available, up to given length.
+ *
+ * Timestamps are cycle counter values; CPU cycles on ARM and Xtensa,
+ * and microseconds on Linux. Use the difference between consecutive
+ * timestamps, as the counter wraps.
+ *
+ * @param[in] self_p Capture object.
+ * @param[out] timestamps_p Read timestamps.
+ * @param[in] length Maximum number of timestamps to read.
+ * @param[in] timeout_p Read timeout, or NULL to wait forever.
+ *
+ * @return Number of read timestamps, or negative error code. Returns
+ *         -ETIMEDOUT if no edge was captured within the timeout.
+ */
+ssize_t exti_capture_read(struct exti_capture_t *self_p,
+                          uint32_t *timestamps_p,
+                          size_t length,
+                          struct time_t *timeout_p);
+
+/**
+ * Get the number of edges dropped because the ring buffer was full.
+ *
+ * @param[in] self_p Capture object.
+ *
+ * @return Number of dropped edges.
+ */
+uint32_t exti_capture_get_overflows(struct exti_capture_t *self_p);
+
 #endif
@@ -226,6 +226,67 @@ static inline int pin_device_write_low(const struct pin_device_t *dev_p)
     return (pin_port_device_write_low(dev_p));
 }
 
+#if defined(PIN_PORT_HAS_STATIC)
+
+/**
+ * Initializer of a compile time constant pin device on given port
+ * with given pin mask, for example ``&PINB`` and ``_BV(PINB5)`` on
+ * AVR, or ``SAM_PIOB`` and ``SAM_PIO_P27`` on SAM.
+ *
+ * Define the device as a ``static const struct pin_device_t`` and
+ * pass its address to the inlined `pin_device_*()` functions. The
+ * compiler then resolves the port and mask at compile time, and a
+ * write or toggle becomes a single register store. Intended for
+ * bit-banging applications and drivers where the pin is known at
+ * compile time.
+ */
+#define PIN_DEVICE_STATIC_INITIALIZER(port, mask)       \
+    PIN_PORT_DEVICE_STATIC_INITIALIZER(port, mask)
+
+/**
+ * Toggle the output value (high/low) of given pin device.
+ *
+ * This function may be called from interrupt context and with the
+ * system lock taken.
+ *
+ * @param[in] dev_p Pin device.
+ *
+ * @return zero(0) or negative error code.
+ */
+static inline int pin_device_toggle(const struct pin_device_t *dev_p)
+{
+    return (pin_port_device_toggle(dev_p));
+}
+
+#endif
+
+#if defined(PIN_PORT_HAS_BUSY_WAIT)
+
+/**
+ * Number of busy wait iterations for given number of CPU cycles,
+ * rounded down. Negative cycles gives zero iterations.
+ */
+#define PIN_BUSY_WAIT_ITERATIONS(cycles)                                \
+    (((cycles) > 0) ? ((cycles) / PIN_PORT_BUSY_WAIT_CYCLES_PER_ITERATION) : 0)
+
+/**
+ * Busy wait given number of iterations of the port specific cycle
+ * counted delay loop. Use `PIN_BUSY_WAIT_ITERATIONS()` to convert CPU
+ * cycles to iterations. Intended for bit-banging drivers that need
+ * delays shorter than `time_busy_wait_us()` can give.
+ *
+ * This function may be called from interrupt context and with the
+ * system lock taken.
+ *
+ * @param[in] iterations Number of iterations to wait.
+ */
+static inline void pin_busy_wait(int iterations)
+{
+    pin_port_busy_wait(iterations);
+}
+
+#endif
+
 /**
  * Check if given pin device is valid.
  *
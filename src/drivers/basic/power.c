@@ -30,10 +30,25 @@
 
 #if CONFIG_POWER == 1
 
+struct module_t {
+    int initialized;
+    /* Number of stay awake constraints per deepest allowed mode. */
+    int stay_awake[POWER_MODE_MAX];
+};
+
+static struct module_t module;
+
 #include "power_port.i"
 
 int power_module_init()
 {
+    /* Return immediately if the module is already initialized. */
+    if (module.initialized == 1) {
+        return (0);
+    }
+
+    module.initialized = 1;
+
     return (0);
 }
 
@@ -42,4 +57,82 @@ int power_deep_sleep(long microseconds)
     return (power_port_deep_sleep(microseconds));
 }
 
+int power_stay_awake_acquire(int mode)
+{
+    int res;
+
+    sys_lock();
+    res = power_stay_awake_acquire_isr(mode);
+    sys_unlock();
+
+    return (res);
+}
+
+int power_stay_awake_release(int mode)
+{
+    int res;
+
+    sys_lock();
+    res = power_stay_awake_release_isr(mode);
+    sys_unlock();
+
+    return (res);
+}
+
+int power_stay_awake_acquire_isr(int mode)
+{
+    if ((mode < 0) || (mode >= POWER_MODE_MAX)) {
+        return (-EINVAL);
+    }
+
+    module.stay_awake[mode]++;
+
+    return (0);
+}
+
+int power_stay_awake_release_isr(int mode)
+{
+    if ((mode < 0) || (mode >= POWER_MODE_MAX)) {
+        return (-EINVAL);
+    }
+
+    if (module.stay_awake[mode] == 0) {
+        return (-EINVAL);
+    }
+
+    module.stay_awake[mode]--;
+
+    return (0);
+}
+
+int power_idle_enter_isr(uint32_t ticks)
+{
+    int mode;
+    int i;
+
+    /* The system tick must keep running if a timer is. */
+    if (ticks == 0xffffffff) {
+        mode = POWER_PORT_MODE_MAX;
+    } else {
+        mode = POWER_MODE_IDLE;
+    }
+
+    /* The shallowest constrained mode wins. */
+    for (i = POWER_MODE_IDLE; i < mode; i++) {
+        if (module.stay_awake[i] > 0) {
+            mode = i;
+            break;
+        }
+    }
+
+    power_port_idle_enter_isr(mode);
+
+    return (mode);
+}
+
+void power_idle_exit_isr(int mode)
+{
+    power_port_idle_exit_isr(mode);
+}
+
 #endif
@@ -30,6 +30,21 @@
 #define __DRIVERS_POWER_H__
 
 #include "simba.h"
+
+/* Sleep modes entered by the idle thread, from the shallowest to the
+   deepest. */
+
+/** Stop the CPU until an interrupt occurs. All peripherals and the
+    system tick keep running. */
+#define POWER_MODE_IDLE                                         0
+
+/** Also stop the system tick and the clocks of most
+    peripherals. Woken up by external interrupts and a few port
+    specific peripherals only. The system time does not advance. */
+#define POWER_MODE_SLEEP                                        1
+
+#define POWER_MODE_MAX                                          2
+
 #include "power_port.h"
 
 /**
@@ -52,4 +67,60 @@ int power_module_init(void);
  */
 int power_deep_sleep(long microseconds);
 
+/**
+ * Do not let the idle thread enter sleep modes deeper than given
+ * mode until released by `power_stay_awake_release()`. Drivers hold
+ * a constraint while a peripheral needs its clock, for example while
+ * a transfer is in flight. Constraints nest.
+ *
+ * @param[in] mode Deepest allowed mode, one of ``POWER_MODE_*``.
+ *
+ * @return zero(0) or negative error code.
+ */
+int power_stay_awake_acquire(int mode);
+
+/**
+ * Release a constraint acquired with `power_stay_awake_acquire()`.
+ *
+ * @param[in] mode Same mode as given when acquired.
+ *
+ * @return zero(0) or negative error code.
+ */
+int power_stay_awake_release(int mode);
+
+/**
+ * Same as `power_stay_awake_acquire()`, but called from isr or with
+ * the system lock taken.
+ */
+int power_stay_awake_acquire_isr(int mode);
+
+/**
+ * Same as `power_stay_awake_release()`, but called from isr or with
+ * the system lock taken.
+ */
+int power_stay_awake_release_isr(int mode);
+
+/**
+ * Enter the deepest sleep mode allowed by the stay awake constraints
+ * and the port. A mode that stops the system tick is only entered if
+ * no timer is running. Called by the idle thread with the system
+ * lock taken just before it waits for an interrupt.
+ *
+ * @param[in] ticks Number of system ticks until the next timer
+ *                  expires, or 0xffffffff if no timer is running.
+ *
+ * @return Entered sleep mode.
+ */
+int power_idle_enter_isr(uint32_t ticks);
+
+/**
+ * Restore the peripherals after waking up from given sleep
+ * mode. Called by the idle thread with the system lock taken.
+ *
+ * @param[in] mode Mode returned by `power_idle_enter_isr()`.
+ *
+ * @return void.
+ */
+void power_idle_exit_isr(int mode);
+
 #endif
@@ -32,81 +32,281 @@
 
 #define DUTY_CYCLE_MAX module.duty_cycle_max
 
+/**
+ * A point in time in the period where one or more pins are set low.
+ */
+struct edge_t {
+    /* Timer count from the previous edge, or from the start of the
+       period for the first edge. */
+    unsigned int delta;
+    /* Range of pins in the table's low pins array. */
+    uint8_t begin;
+    uint8_t end;
+};
+
+/**
+ * Edges of one period. The last edge is the end of the period and
+ * has no pins.
+ */
+struct table_t {
+    int number_of_edges;
+    struct edge_t edges[CONFIG_PWM_SOFT_CHANNELS_MAX + 1];
+    int number_of_high_pins;
+    struct pwm_soft_port_pins_t high_pins[CONFIG_PWM_SOFT_CHANNELS_MAX];
+    struct pwm_soft_port_pins_t low_pins[CONFIG_PWM_SOFT_CHANNELS_MAX];
+};
+
 struct module_t {
     struct pwm_soft_port_module_t port;
     int initialized;
-    struct pwm_soft_driver_t tail_pwm_soft;
-    struct pwm_soft_driver_t *head_p;
-    /* A circular linked list of started devices (and this modules'
-       dummy software pwm). */
-    struct pwm_soft_driver_t *current_p;
     long frequency;
     long duty_cycle_max;
+    /* Started software PWM:s in the edge tables, sorted by duty
+       cycle. */
+    struct pwm_soft_driver_t *channels[CONFIG_PWM_SOFT_CHANNELS_MAX];
+    int number_of_channels;
+    struct sem_t sem;
+    struct table_t tables[2];
+    /* Table used by the interrupt handler. The other table replaces
+       it at the end of the period if pending is set. */
+    struct table_t *table_p;
+    int pending;
+    /* Index of the edge the timer is counting to. */
+    int edge;
+    /* Pins to write when the timer has been restarted. */
+    struct {
+        const struct pwm_soft_port_pins_t *pins_p;
+        int length;
+        int value;
+    } write;
+    /* Stopped software PWM:s waiting for the table swap. */
+    struct pwm_soft_driver_t *waiters_p;
 };
 
 static struct module_t module;
 
-static void unlink_pwm_soft_isr(struct pwm_soft_driver_t *self_p);
+static void clear_tables(void);
+static void swap_tables_isr(void);
+static unsigned int advance_edge_isr(void);
+static void write_edge_isr(void);
 
 #include "pwm_soft_port.i"
 
+static void clear_tables(void)
+{
+    int i;
+
+    sys_lock();
+
+    for (i = 0; i < 2; i++) {
+        module.tables[i].number_of_edges = 1;
+        module.tables[i].edges[0].delta = DUTY_CYCLE_MAX;
+        module.tables[i].edges[0].begin = 0;
+        module.tables[i].edges[0].end = 0;
+        module.tables[i].number_of_high_pins = 0;
+    }
+
+    module.table_p = &module.tables[0];
+    module.pending = 0;
+    module.edge = 0;
+    module.write.length = 0;
+
+    sys_unlock();
+}
+
 /**
- * Insert given object into the global list of software PWM objects.
+ * Replace the table used by the interrupt handler with the pending
+ * table and resume all stopped software PWM:s waiting for it.
  */
-static void insert_pwm_soft(struct pwm_soft_driver_t *self_p)
+static void swap_tables_isr(void)
 {
-    struct pwm_soft_driver_t *elem_p, *prev_p;
+    struct pwm_soft_driver_t *waiter_p;
 
-    sys_lock();
+    if (module.pending == 0) {
+        return;
+    }
 
-    /* Find element preceeding this one.*/
-    elem_p = module.head_p;
-    prev_p = &module.tail_pwm_soft;
+    if (module.table_p == &module.tables[0]) {
+        module.table_p = &module.tables[1];
+    } else {
+        module.table_p = &module.tables[0];
+    }
+
+    module.pending = 0;
+
+    while (module.waiters_p != NULL) {
+        waiter_p = module.waiters_p;
+        module.waiters_p = waiter_p->next_p;
+        waiter_p->next_p = NULL;
+        thrd_resume_isr(waiter_p->thrd_p, 0);
+        waiter_p->thrd_p = NULL;
+    }
+}
 
-    /* Delta is initially the timeout. */
-    while (elem_p->delta < self_p->delta) {
-        self_p->delta -= elem_p->delta;
-        prev_p = elem_p;
-        elem_p = elem_p->next_p;
+/**
+ * Called first in the timer interrupt handler. Advance to the next
+ * edge and return the timer count to it, so the timer can be
+ * restarted before the pins are written by `write_edge_isr()`.
+ */
+static unsigned int advance_edge_isr(void)
+{
+    struct table_t *table_p;
+    struct edge_t *edge_p;
+
+    table_p = module.table_p;
+
+    if (module.edge == table_p->number_of_edges - 1) {
+        /* One period has elapsed. Set all pins high. */
+        swap_tables_isr();
+        table_p = module.table_p;
+        module.write.pins_p = &table_p->high_pins[0];
+        module.write.length = table_p->number_of_high_pins;
+        module.write.value = 1;
+        module.edge = 0;
+    } else {
+        edge_p = &table_p->edges[module.edge];
+        module.write.pins_p = &table_p->low_pins[edge_p->begin];
+        module.write.length = (edge_p->end - edge_p->begin);
+        module.write.value = 0;
+        module.edge++;
     }
 
-    /* Insert new software PWM into list.*/
-    elem_p->delta -= self_p->delta;
-    self_p->next_p = elem_p;
-    prev_p->next_p = self_p;
+    return (table_p->edges[module.edge].delta);
+}
 
-    if (prev_p == &module.tail_pwm_soft) {
-        module.head_p = self_p;
+/**
+ * Write the pins of the edge reached in the timer interrupt handler.
+ */
+static void write_edge_isr(void)
+{
+    if (module.write.value == 1) {
+        pwm_soft_port_pins_write_high_isr(module.write.pins_p,
+                                          module.write.length);
+    } else {
+        pwm_soft_port_pins_write_low_isr(module.write.pins_p,
+                                         module.write.length);
     }
+}
+
+/**
+ * Build given table from the started software PWM:s.
+ */
+static void build_table(struct table_t *table_p)
+{
+    struct pwm_soft_driver_t *channel_p;
+    struct edge_t *edge_p;
+    long previous;
+    int number_of_low_pins;
+    int i;
+
+    table_p->number_of_edges = 0;
+    table_p->number_of_high_pins = 0;
+    number_of_low_pins = 0;
+    edge_p = NULL;
+    previous = 0;
+
+    for (i = 0; i < module.number_of_channels; i++) {
+        channel_p = module.channels[i];
+        table_p->number_of_high_pins =
+            pwm_soft_port_pins_add(&table_p->high_pins[0],
+                                   table_p->number_of_high_pins,
+                                   channel_p->pin_dev_p);
+
+        /* Pins with equal duty cycles share an edge. */
+        if ((edge_p == NULL) || (channel_p->duty_cycle != previous)) {
+            edge_p = &table_p->edges[table_p->number_of_edges++];
+            edge_p->delta = (channel_p->duty_cycle - previous);
+            edge_p->begin = number_of_low_pins;
+            previous = channel_p->duty_cycle;
+        }
 
+        number_of_low_pins = (edge_p->begin
+                              + pwm_soft_port_pins_add(
+                                  &table_p->low_pins[edge_p->begin],
+                                  number_of_low_pins - edge_p->begin,
+                                  channel_p->pin_dev_p));
+        edge_p->end = number_of_low_pins;
+    }
+
+    /* End of the period. */
+    edge_p = &table_p->edges[table_p->number_of_edges++];
+    edge_p->delta = (DUTY_CYCLE_MAX - previous);
+    edge_p->begin = number_of_low_pins;
+    edge_p->end = number_of_low_pins;
+}
+
+/**
+ * Build the table not used by the interrupt handler and make it
+ * pending. Must be called with the module semaphore taken.
+ */
+static void update_tables(void)
+{
+    struct table_t *table_p;
+
+    /* The interrupt handler must not swap to the table while it is
+       being built. */
+    sys_lock();
+    module.pending = 0;
+
+    if (module.table_p == &module.tables[0]) {
+        table_p = &module.tables[1];
+    } else {
+        table_p = &module.tables[0];
+    }
+
+    sys_unlock();
+
+    build_table(table_p);
+
+    sys_lock();
+    module.pending = 1;
     sys_unlock();
+
+    pwm_soft_port_tables_updated();
 }
 
 /**
- * Unlink given software PWM from the list of started software PWM:s.
+ * Insert given software PWM into the list of channels, sorted by
+ * duty cycle.
  */
-static void unlink_pwm_soft_isr(struct pwm_soft_driver_t *self_p)
+static int insert_channel(struct pwm_soft_driver_t *self_p)
 {
-    struct pwm_soft_driver_t *prev_p;
+    int i;
 
-    /* Add the delta to the next element. */
-    self_p->next_p->delta += self_p->delta;
+    if (module.number_of_channels == CONFIG_PWM_SOFT_CHANNELS_MAX) {
+        return (-ENOMEM);
+    }
 
-    /* Find element preceeding this one.*/
-    prev_p = module.head_p;
+    i = module.number_of_channels;
 
-    while (prev_p->next_p != self_p) {
-        prev_p = prev_p->next_p;
+    while ((i > 0) && (module.channels[i - 1]->duty_cycle > self_p->duty_cycle)) {
+        module.channels[i] = module.channels[i - 1];
+        i--;
     }
 
-    /* Remove software PWM from the list.*/
-    prev_p->next_p = self_p->next_p;
+    module.channels[i] = self_p;
+    module.number_of_channels++;
+    self_p->started = 1;
+
+    return (0);
+}
+
+/**
+ * Remove given software PWM from the list of channels.
+ */
+static void remove_channel(struct pwm_soft_driver_t *self_p)
+{
+    int i;
+
+    for (i = 0; module.channels[i] != self_p; i++);
+
+    module.number_of_channels--;
 
-    if (self_p == module.head_p) {
-        module.head_p = self_p->next_p;
+    for (; i < module.number_of_channels; i++) {
+        module.channels[i] = module.channels[i + 1];
     }
 
-    self_p->next_p = NULL;
+    self_p->started = 0;
 }
 
 int pwm_soft_module_init(long frequency)
@@ -115,12 +315,10 @@ int pwm_soft_module_init(long frequency)
         return (0);
     }
 
-    module.tail_pwm_soft.duty_cycle = -1;
-    module.tail_pwm_soft.thrd_p = NULL;
-    module.tail_pwm_soft.next_p = &module.tail_pwm_soft;
-    module.head_p = &module.tail_pwm_soft;
-    module.current_p = &module.tail_pwm_soft;
     module.frequency = frequency;
+    module.number_of_channels = 0;
+    module.waiters_p = NULL;
+    sem_init(&module.sem, 0, 1);
 
     if (pwm_soft_port_module_init(frequency) != 0) {
         return (-1);
@@ -135,7 +333,7 @@ int pwm_soft_set_frequency(long value)
 {
     /* It's not allowed to change the frequency with started software
        PWM drivers. */
-    if (module.head_p != &module.tail_pwm_soft) {
+    if (module.number_of_channels != 0) {
         return (-1);
     }
 
@@ -159,7 +357,7 @@ int pwm_soft_init(struct pwm_soft_driver_t *self_p,
 
     self_p->pin_dev_p = pin_dev_p;
     self_p->duty_cycle = duty_cycle;
-    self_p->delta = 0;
+    self_p->started = 0;
     self_p->thrd_p = NULL;
     self_p->next_p = NULL;
 
@@ -170,6 +368,9 @@ int pwm_soft_start(struct pwm_soft_driver_t *self_p)
 {
     ASSERTN(self_p != NULL, EINVAL);
 
+    int res;
+
+    res = 0;
     pin_device_set_mode(self_p->pin_dev_p, PIN_OUTPUT);
 
     if (self_p->duty_cycle == DUTY_CYCLE_MAX) {
@@ -178,31 +379,38 @@ int pwm_soft_start(struct pwm_soft_driver_t *self_p)
         pin_device_write_low(self_p->pin_dev_p);
 
         if (self_p->duty_cycle > 0) {
-            self_p->delta = self_p->duty_cycle;
-            insert_pwm_soft(self_p);
+            sem_take(&module.sem, NULL);
+            res = insert_channel(self_p);
+
+            if (res == 0) {
+                update_tables();
+            }
+
+            sem_give(&module.sem, 1);
         }
     }
 
-    return (0);
+    return (res);
 }
 
 int pwm_soft_stop(struct pwm_soft_driver_t *self_p)
 {
     ASSERTN(self_p != NULL, EINVAL);
 
-    if (!((self_p->duty_cycle == DUTY_CYCLE_MAX) ||
-          (self_p->duty_cycle == 0))) {
+    if (self_p->started == 1) {
+        sem_take(&module.sem, NULL);
+        remove_channel(self_p);
+        update_tables();
+        sem_give(&module.sem, 1);
+
+        /* Wait for the interrupt handler to stop using the pin. */
         sys_lock();
 
-        /* Is the timer started? */
-        if (self_p->next_p != NULL) {
-            /* Wait for the PWM to be inactive. */
-            if (self_p == module.current_p) {
-                self_p->thrd_p = thrd_self();
-                thrd_suspend_isr(NULL);
-            } else {
-                unlink_pwm_soft_isr(self_p);
-            }
+        if (module.pending == 1) {
+            self_p->thrd_p = thrd_self();
+            self_p->next_p = module.waiters_p;
+            module.waiters_p = self_p;
+            thrd_suspend_isr(NULL);
         }
 
         sys_unlock();
@@ -219,6 +427,19 @@ int pwm_soft_set_duty_cycle(struct pwm_soft_driver_t *self_p,
     ASSERTN(self_p != NULL, EINVAL);
     ASSERTN((value >= 0) && (value <= DUTY_CYCLE_MAX), EINVAL);
 
+    /* Move the falling edge in the next period if the pin stays in
+       the edge table. */
+    if ((self_p->started == 1) && (value > 0) && (value < DUTY_CYCLE_MAX)) {
+        sem_take(&module.sem, NULL);
+        remove_channel(self_p);
+        self_p->duty_cycle = value;
+        insert_channel(self_p);
+        update_tables();
+        sem_give(&module.sem, 1);
+
+        return (0);
+    }
+
     if (pwm_soft_stop(self_p) != 0) {
         return (-1);
     }
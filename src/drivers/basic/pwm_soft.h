@@ -36,7 +36,7 @@ struct pwm_soft_driver_t {
     struct pin_device_t *pin_dev_p;
     long frequency;
     long duty_cycle;
-    unsigned int delta;
+    int started;
     struct thrd_t *thrd_p;
     struct pwm_soft_driver_t *next_p;
 };
@@ -91,11 +91,14 @@ int pwm_soft_init(struct pwm_soft_driver_t *self_p,
 
 /**
  * Start outputting the PWM signal on the pin given to
- * `pwm_soft_init()`.
+ * `pwm_soft_init()`. The signal starts at the beginning of the next
+ * period.
  *
  * @param[in] self_p Driver object to start.
  *
- * @return zero(0) or negative error code.
+ * @return zero(0) or negative error code. -ENOMEM if
+ *         ``CONFIG_PWM_SOFT_CHANNELS_MAX`` software PWM:s are already
+ *         started.
  */
 int pwm_soft_start(struct pwm_soft_driver_t *self_p);
 
@@ -110,8 +113,10 @@ int pwm_soft_start(struct pwm_soft_driver_t *self_p);
 int pwm_soft_stop(struct pwm_soft_driver_t *self_p);
 
 /**
- * Set the duty cycle. Calls `pwm_soft_stop()` and `pwm_soft_start()`
- * to restart outputting the PWM signal with the new duty cycle.
+ * Set the duty cycle. The new duty cycle is used from the start of
+ * the next period, without interrupting the PWM signal. Changing
+ * to or from 0% or 100% calls `pwm_soft_stop()` and
+ * `pwm_soft_start()` to restart the PWM signal.
  *
  * @param[in] self_p Driver object.
  * @param[in] value Duty cycle. Use `pwm_soft_duty_cycle()` to convert
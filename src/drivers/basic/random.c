@@ -32,9 +32,181 @@
 
 #include "random_port.i"
 
+#define ROTL(value, shift)                              \
+    (((value) << (shift)) | ((value) >> (32 - (shift))))
+
+#define QUARTER_ROUND(a, b, c, d)                       \
+    a += b; d ^= a; d = ROTL(d, 16);                    \
+    c += d; b ^= c; b = ROTL(b, 12);                    \
+    a += b; d ^= a; d = ROTL(d, 8);                     \
+    c += d; b ^= c; b = ROTL(b, 7)
+
+struct module_t {
+    int initialized;
+    struct {
+        uint32_t key[8];
+        uint8_t buf[32];
+        size_t pos;
+        size_t left;
+    } crypto;
+    uint32_t fast[4];
+};
+
+static struct module_t module;
+
+/**
+ * Calculate a ChaCha20 block with given key, and a zero counter and
+ * nonce.
+ */
+static void chacha20_block(uint32_t *output_p, const uint32_t *key_p)
+{
+    uint32_t x[16];
+    int i;
+
+    x[0] = 0x61707865;
+    x[1] = 0x3320646e;
+    x[2] = 0x79622d32;
+    x[3] = 0x6b206574;
+
+    for (i = 0; i < 8; i++) {
+        x[4 + i] = key_p[i];
+    }
+
+    x[12] = 0;
+    x[13] = 0;
+    x[14] = 0;
+    x[15] = 0;
+
+    memcpy(output_p, &x[0], sizeof(x));
+
+    for (i = 0; i < 10; i++) {
+        QUARTER_ROUND(x[0], x[4], x[8], x[12]);
+        QUARTER_ROUND(x[1], x[5], x[9], x[13]);
+        QUARTER_ROUND(x[2], x[6], x[10], x[14]);
+        QUARTER_ROUND(x[3], x[7], x[11], x[15]);
+        QUARTER_ROUND(x[0], x[5], x[10], x[15]);
+        QUARTER_ROUND(x[1], x[6], x[11], x[12]);
+        QUARTER_ROUND(x[2], x[7], x[8], x[13]);
+        QUARTER_ROUND(x[3], x[4], x[9], x[14]);
+    }
+
+    for (i = 0; i < 16; i++) {
+        output_p[i] += x[i];
+    }
+}
+
+/**
+ * Generate the next 32 output bytes. The first half of the block
+ * replaces the key, so earlier output cannot be recovered from the
+ * state.
+ */
+static void crypto_refill(void)
+{
+    uint32_t block[16];
+    int i;
+
+    chacha20_block(&block[0], &module.crypto.key[0]);
+
+    for (i = 0; i < 8; i++) {
+        module.crypto.key[i] = block[i];
+        module.crypto.buf[4 * i + 0] = (block[8 + i] >> 0);
+        module.crypto.buf[4 * i + 1] = (block[8 + i] >> 8);
+        module.crypto.buf[4 * i + 2] = (block[8 + i] >> 16);
+        module.crypto.buf[4 * i + 3] = (block[8 + i] >> 24);
+    }
+
+    memset(&block[0], 0, sizeof(block));
+    module.crypto.pos = 0;
+}
+
+static void crypto_reseed_isr(void)
+{
+    int i;
+
+    for (i = 0; i < 8; i++) {
+        module.crypto.key[i] ^= random_port_read();
+    }
+
+    /* Drop buffered output generated with the old key. */
+    module.crypto.pos = sizeof(module.crypto.buf);
+    module.crypto.left = CONFIG_RANDOM_CRYPTO_RESEED_SIZE;
+}
+
+/**
+ * Read at most one buffer of random bytes.
+ */
+static size_t crypto_read_chunk_isr(uint8_t *buf_p, size_t size)
+{
+    if (module.crypto.left == 0) {
+        crypto_reseed_isr();
+    }
+
+    if (module.crypto.pos == sizeof(module.crypto.buf)) {
+        crypto_refill();
+    }
+
+    size = MIN(size, sizeof(module.crypto.buf) - module.crypto.pos);
+    size = MIN(size, module.crypto.left);
+    memcpy(buf_p, &module.crypto.buf[module.crypto.pos], size);
+
+    /* Never output the same bytes twice. */
+    memset(&module.crypto.buf[module.crypto.pos], 0, size);
+    module.crypto.pos += size;
+    module.crypto.left -= size;
+
+    return (size);
+}
+
+static uint32_t splitmix32(uint32_t *state_p)
+{
+    uint32_t value;
+
+    *state_p += 0x9e3779b9;
+    value = *state_p;
+    value = ((value ^ (value >> 16)) * 0x85ebca6b);
+    value = ((value ^ (value >> 13)) * 0xc2b2ae35);
+
+    return (value ^ (value >> 16));
+}
+
+static void fast_seed_isr(uint32_t seed)
+{
+    int i;
+
+    for (i = 0; i < 4; i++) {
+        module.fast[i] = splitmix32(&seed);
+    }
+
+    /* The all zero state is invalid. */
+    if ((module.fast[0] | module.fast[1] | module.fast[2] | module.fast[3])
+        == 0) {
+        module.fast[0] = 1;
+    }
+}
+
 int random_module_init()
 {
-    return (random_port_module_init());
+    uint32_t seed;
+
+    /* Return immediately if the module is already initialized. */
+    if (module.initialized == 1) {
+        return (0);
+    }
+
+    module.initialized = 1;
+
+    if (random_port_module_init() != 0) {
+        return (-1);
+    }
+
+    sys_lock();
+    memset(&module.crypto.key[0], 0, sizeof(module.crypto.key));
+    crypto_reseed_isr();
+    (void)random_crypto_read_isr(&seed, sizeof(seed));
+    fast_seed_isr(seed);
+    sys_unlock();
+
+    return (0);
 }
 
 uint32_t random_read()
@@ -42,4 +214,97 @@ uint32_t random_read()
     return (random_port_read());
 }
 
+ssize_t random_crypto_read(void *buf_p, size_t size)
+{
+    ASSERTN(buf_p != NULL, EINVAL);
+
+    uint8_t *u8_buf_p;
+    size_t left;
+    size_t n;
+
+    u8_buf_p = buf_p;
+    left = size;
+
+    /* One buffer at a time to keep interrupts enabled most of the
+       time. */
+    while (left > 0) {
+        sys_lock();
+        n = crypto_read_chunk_isr(u8_buf_p, left);
+        sys_unlock();
+        u8_buf_p += n;
+        left -= n;
+    }
+
+    return (size);
+}
+
+ssize_t random_crypto_read_isr(void *buf_p, size_t size)
+{
+    ASSERTN(buf_p != NULL, EINVAL);
+
+    uint8_t *u8_buf_p;
+    size_t left;
+    size_t n;
+
+    u8_buf_p = buf_p;
+    left = size;
+
+    while (left > 0) {
+        n = crypto_read_chunk_isr(u8_buf_p, left);
+        u8_buf_p += n;
+        left -= n;
+    }
+
+    return (size);
+}
+
+int random_crypto_reseed()
+{
+    sys_lock();
+    crypto_reseed_isr();
+    sys_unlock();
+
+    return (0);
+}
+
+uint32_t random_fast_read()
+{
+    uint32_t value;
+
+    sys_lock();
+    value = random_fast_read_isr();
+    sys_unlock();
+
+    return (value);
+}
+
+uint32_t random_fast_read_isr()
+{
+    uint32_t *s_p;
+    uint32_t value;
+    uint32_t t;
+
+    s_p = &module.fast[0];
+    value = (s_p[1] * 5);
+    value = (ROTL(value, 7) * 9);
+    t = (s_p[1] << 9);
+    s_p[2] ^= s_p[0];
+    s_p[3] ^= s_p[1];
+    s_p[1] ^= s_p[2];
+    s_p[0] ^= s_p[3];
+    s_p[2] ^= t;
+    s_p[3] = ROTL(s_p[3], 11);
+
+    return (value);
+}
+
+int random_fast_seed(uint32_t seed)
+{
+    sys_lock();
+    fast_seed_isr(seed);
+    sys_unlock();
+
+    return (0);
+}
+
 #endif
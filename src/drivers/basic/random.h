@@ -44,10 +44,66 @@
 int random_module_init(void);
 
 /**
- * Read a 32 bits random number from the hardware.
+ * Read a 32 bits random number from the hardware. Hardware random
+ * number generators are often slow, use ``random_crypto_read()`` or
+ * ``random_fast_read()`` when many random numbers are needed.
  *
  * @return A 32 bits random number.
  */
 uint32_t random_read(void);
 
+/**
+ * Read cryptographically secure random bytes from a ChaCha20 based
+ * generator. The generator is seeded from the hardware at module
+ * initialization, and reseeded after every
+ * ``CONFIG_RANDOM_CRYPTO_RESEED_SIZE`` read bytes.
+ *
+ * @param[out] buf_p Buffer to read into.
+ * @param[in] size Number of bytes to read.
+ *
+ * @return Number of read bytes or negative error code.
+ */
+ssize_t random_crypto_read(void *buf_p, size_t size);
+
+/**
+ * Same as ``random_crypto_read()``, but may only be called from an
+ * isr or with the system lock taken.
+ */
+ssize_t random_crypto_read_isr(void *buf_p, size_t size);
+
+/**
+ * Mix hardware random numbers into the ChaCha20 based generator
+ * state.
+ *
+ * @return zero(0) or negative error code.
+ */
+int random_crypto_reseed(void);
+
+/**
+ * Read a 32 bits random number from a xoshiro128** generator. It is
+ * much faster than the ChaCha20 based generator, but not
+ * cryptographically secure, and is intended for simulations, jitter
+ * and backoff. The generator is seeded from the ChaCha20 based
+ * generator at module initialization.
+ *
+ * @return A 32 bits random number.
+ */
+uint32_t random_fast_read(void);
+
+/**
+ * Same as ``random_fast_read()``, but may only be called from an isr
+ * or with the system lock taken.
+ */
+uint32_t random_fast_read_isr(void);
+
+/**
+ * Seed the xoshiro128** generator with given seed. The same seed
+ * always gives the same sequence of numbers.
+ *
+ * @param[in] seed Seed.
+ *
+ * @return zero(0) or negative error code.
+ */
+int random_fast_seed(uint32_t seed);
+
 #endif
@@ -104,6 +104,48 @@ static void write_data(struct hd44780_driver_t *self_p,
     write_byte(self_p, data, DELAY_37_US);
 }
 
+static int write_ddram_address(struct hd44780_driver_t *self_p,
+                               unsigned int row,
+                               unsigned int column)
+{
+    return (write_command_busy_wait(self_p,
+                                    (SET_DDRAM_ADDRESS
+                                     | ((0x40 * row) + column)),
+                                    DELAY_37_US));
+}
+
+static int clear_display(struct hd44780_driver_t *self_p)
+{
+    write_command_sleep(self_p, CLEAR_DISPLAY, DELAY_1520_US);
+
+    return (write_command_sleep(self_p, CURSOR_HOME, DELAY_1520_US));
+}
+
+/**
+ * Set given framebuffer character.
+ */
+static void framebuffer_set(struct hd44780_driver_t *self_p,
+                            unsigned int row,
+                            unsigned int column,
+                            uint8_t character)
+{
+    self_p->framebuffer.buf_p[row * self_p->number_of_columns + column] =
+        character;
+}
+
+/**
+ * Fill the framebuffer and the displayed characters with spaces, as
+ * the display after it has been cleared.
+ */
+static void framebuffer_reset(struct hd44780_driver_t *self_p)
+{
+    size_t size;
+
+    size = (self_p->number_of_rows * self_p->number_of_columns);
+    memset(self_p->framebuffer.buf_p, ' ', size);
+    memset(self_p->framebuffer.displayed_p, ' ', size);
+}
+
 int hd44780_module_init()
 {
     return (0);
@@ -128,10 +170,94 @@ int hd44780_init(struct hd44780_driver_t *self_p,
     self_p->number_of_rows = number_of_rows;
     self_p->number_of_columns = number_of_columns;
     self_p->display_on_off_control = DISPLAY_ON_OFF_CONTROL_D;
+    self_p->framebuffer.buf_p = NULL;
+
+    return (0);
+}
+
+int hd44780_framebuffer_init(struct hd44780_driver_t *self_p,
+                             void *buf_p,
+                             size_t size)
+{
+    ASSERTN(self_p != NULL, EINVAL);
+    ASSERTN(buf_p != NULL, EINVAL);
+
+    size_t number_of_characters;
+
+    number_of_characters = (self_p->number_of_rows
+                            * self_p->number_of_columns);
+
+    if (size < HD44780_FRAMEBUFFER_SIZE(self_p->number_of_rows,
+                                        self_p->number_of_columns)) {
+        return (-EINVAL);
+    }
+
+    self_p->framebuffer.buf_p = buf_p;
+    self_p->framebuffer.displayed_p = (self_p->framebuffer.buf_p
+                                       + number_of_characters);
+    framebuffer_reset(self_p);
 
     return (0);
 }
 
+ssize_t hd44780_flush(struct hd44780_driver_t *self_p)
+{
+    ASSERTN(self_p != NULL, EINVAL);
+
+    unsigned int row;
+    unsigned int column;
+    unsigned int index;
+    uint8_t *buf_p;
+    uint8_t *displayed_p;
+    int moved;
+    ssize_t written;
+
+    if (self_p->framebuffer.buf_p == NULL) {
+        return (-ENOSYS);
+    }
+
+    buf_p = self_p->framebuffer.buf_p;
+    displayed_p = self_p->framebuffer.displayed_p;
+    written = 0;
+    index = 0;
+
+    for (row = 0; row < self_p->number_of_rows; row++) {
+        /* The display address increments after each written
+           character, so only the first character in a sequence needs
+           a cursor move. */
+        moved = 0;
+
+        for (column = 0; column < self_p->number_of_columns; column++) {
+            if (buf_p[index] != displayed_p[index]) {
+                if (!moved) {
+                    write_ddram_address(self_p, row, column);
+                    moved = 1;
+                }
+
+                write_data(self_p, buf_p[index]);
+                displayed_p[index] = buf_p[index];
+                written++;
+            } else {
+                moved = 0;
+            }
+
+            index++;
+        }
+    }
+
+    /* Put the visible cursor back at the framebuffer cursor
+       position. */
+    if ((written > 0)
+        && (self_p->display_on_off_control & (DISPLAY_ON_OFF_CONTROL_C
+                                              | DISPLAY_ON_OFF_CONTROL_B))) {
+        write_ddram_address(self_p,
+                            self_p->cursor.row,
+                            self_p->cursor.column);
+    }
+
+    return (written);
+}
+
 int hd44780_start(struct hd44780_driver_t *self_p)
 {
     /* Give the device time to start. */
@@ -159,12 +285,26 @@ int hd44780_start(struct hd44780_driver_t *self_p)
                             DELAY_37_US);
     hd44780_text_show(self_p);
 
-    return (hd44780_clear(self_p));
+    self_p->cursor.row = 0;
+    self_p->cursor.column = 0;
+
+    if (self_p->framebuffer.buf_p != NULL) {
+        framebuffer_reset(self_p);
+    }
+
+    return (clear_display(self_p));
 }
 
 int hd44780_stop(struct hd44780_driver_t *self_p)
 {
-    return (hd44780_clear(self_p));
+    self_p->cursor.row = 0;
+    self_p->cursor.column = 0;
+
+    if (self_p->framebuffer.buf_p != NULL) {
+        framebuffer_reset(self_p);
+    }
+
+    return (clear_display(self_p));
 }
 
 int hd44780_display(struct hd44780_driver_t *self_p,
@@ -194,7 +334,15 @@ int hd44780_put(struct hd44780_driver_t *self_p, char character)
                             self_p->cursor.row + 1,
                             self_p->cursor.column);
     } else if (self_p->cursor.column < self_p->number_of_columns) {
-        write_data(self_p, (uint8_t)character);
+        if (self_p->framebuffer.buf_p != NULL) {
+            framebuffer_set(self_p,
+                            self_p->cursor.row,
+                            self_p->cursor.column,
+                            (uint8_t)character);
+        } else {
+            write_data(self_p, (uint8_t)character);
+        }
+
         self_p->cursor.column++;
     }
 
@@ -206,17 +354,21 @@ int hd44780_clear(struct hd44780_driver_t *self_p)
     self_p->cursor.row = 0;
     self_p->cursor.column = 0;
 
-    write_command_sleep(self_p, CLEAR_DISPLAY, DELAY_1520_US);
+    if (self_p->framebuffer.buf_p != NULL) {
+        memset(self_p->framebuffer.buf_p,
+               ' ',
+               self_p->number_of_rows * self_p->number_of_columns);
 
-    return (write_command_sleep(self_p, CURSOR_HOME, DELAY_1520_US));
+        return (0);
+    }
+
+    return (clear_display(self_p));
 }
 
 int hd44780_cursor_move(struct hd44780_driver_t *self_p,
                         unsigned int row,
                         unsigned int column)
 {
-    uint8_t command;
-
     if (row >= self_p->number_of_rows) {
         row = 0;
     }
@@ -228,11 +380,11 @@ int hd44780_cursor_move(struct hd44780_driver_t *self_p,
     self_p->cursor.row = row;
     self_p->cursor.column = column;
 
-    command = (SET_DDRAM_ADDRESS | ((0x40 * row) + column));
+    if (self_p->framebuffer.buf_p != NULL) {
+        return (0);
+    }
 
-    return (write_command_busy_wait(self_p,
-                                    command,
-                                    DELAY_37_US));
+    return (write_ddram_address(self_p, row, column));
 }
 
 int hd44780_cursor_show(struct hd44780_driver_t *self_p)
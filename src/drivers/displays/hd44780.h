@@ -29,6 +29,13 @@
 #ifndef __DRIVERS_HD44780_H__
 #define __DRIVERS_HD44780_H__
 
+/**
+ * Size in bytes of a framebuffer for a display with given number of
+ * rows and columns. The characters to display and the characters on
+ * the display are both stored.
+ */
+#define HD44780_FRAMEBUFFER_SIZE(rows, columns) (2 * (rows) * (columns))
+
 struct hd44780_driver_t {
     struct pin_device_t *rs_p;
     struct pin_device_t *enable_p;
@@ -43,6 +50,13 @@ struct hd44780_driver_t {
         unsigned int column;
     } cursor;
     uint8_t display_on_off_control;
+    struct {
+        /* Characters to display, or NULL if no framebuffer is
+           used. */
+        uint8_t *buf_p;
+        /* Characters on the display. */
+        uint8_t *displayed_p;
+    } framebuffer;
 };
 
 /**
@@ -82,6 +96,40 @@ int hd44780_init(struct hd44780_driver_t *self_p,
                  unsigned int number_of_rows,
                  unsigned int number_of_columns);
 
+/**
+ * Use given framebuffer for given driver. Call this function after
+ * `hd44780_init()` and before `hd44780_start()`.
+ *
+ * With a framebuffer, `hd44780_display()`, `hd44780_write()`,
+ * `hd44780_put()`, `hd44780_clear()` and `hd44780_cursor_move()` only
+ * modify the framebuffer. Call `hd44780_flush()` to write the
+ * characters that differ from the ones on the display. Several
+ * updates between flushes are coalesced, and the display is left
+ * untouched if nothing changed.
+ *
+ * @param[in] self_p Driver object.
+ * @param[in] buf_p Framebuffer.
+ * @param[in] size Framebuffer size in bytes. Must be at least
+ *                 `HD44780_FRAMEBUFFER_SIZE(number_of_rows,
+ *                 number_of_columns)`.
+ *
+ * @return zero(0) or negative error code.
+ */
+int hd44780_framebuffer_init(struct hd44780_driver_t *self_p,
+                             void *buf_p,
+                             size_t size);
+
+/**
+ * Write all framebuffer characters that differ from the ones on the
+ * display to the display. Consecutive changed characters on a row are
+ * written after a single cursor move.
+ *
+ * @param[in] self_p Driver object.
+ *
+ * @return Number of written characters or negative error code.
+ */
+ssize_t hd44780_flush(struct hd44780_driver_t *self_p);
+
 /**
  * Start the driver.
  *
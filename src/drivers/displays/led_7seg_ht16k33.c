@@ -118,6 +118,7 @@ int led_7seg_ht16k33_init(struct led_7seg_ht16k33_driver_t *self_p,
 
     self_p->i2c_p = i2c_p;
     self_p->i2c_addr = i2c_addr;
+    self_p->displayed.valid = 0;
     led_7seg_ht16k33_clear(self_p);
 
     return (0);
@@ -132,6 +133,9 @@ int led_7seg_ht16k33_start(struct led_7seg_ht16k33_driver_t *self_p)
         return (-ENOENT);
     }
 
+    /* The display RAM content is unknown. */
+    self_p->displayed.valid = 0;
+
     i2c_sendcmd(self_p, HT16K33_CMD_OSCILLATOR_ON);
     i2c_sendcmd(self_p, HT16K33_CMD_DISPLAY_ON | HT16K33_DISPLAY_BLINK_OFF);
     led_7seg_ht16k33_brightness(self_p, LED_7SEG_HT16K33_BRIGHTNESS_MAX);
@@ -229,17 +233,49 @@ int led_7seg_ht16k33_display(struct led_7seg_ht16k33_driver_t *self_p)
     ASSERTN(self_p != NULL, EINVAL);
 
     uint8_t sendbuf[HT16K33_CMD_SIZE + 2 * SEVEN_SEG_POSITIONS];
-    int i, r;
+    int i, r, first, last;
+    size_t size;
+
+    /* Find the changed positions. */
+    if (self_p->displayed.valid) {
+        first = -1;
+        last = -1;
+
+        for (i = 0; i < SEVEN_SEG_POSITIONS; i++) {
+            if (self_p->buf[i] != self_p->displayed.buf[i]) {
+                if (first == -1) {
+                    first = i;
+                }
+
+                last = i;
+            }
+        }
+
+        if (first == -1) {
+            return (0);
+        }
+    } else {
+        first = 0;
+        last = SEVEN_SEG_POSITIONS - 1;
+    }
 
-    // sendbuf[0] will be 0 which is our write command and start address.
+    // sendbuf[0] is our write command and start address. Every other
+    // address is unused.
     memset(sendbuf, 0, sizeof(sendbuf));
-    for (i = 0; i < sizeof(self_p->buf); i++)
-        sendbuf[(i * 2) + 1] = self_p->buf[i];
+    sendbuf[0] = (2 * first);
+
+    for (i = first; i <= last; i++)
+        sendbuf[(2 * (i - first)) + 1] = self_p->buf[i];
+
+    size = (HT16K33_CMD_SIZE + 2 * (last - first) + 1);
+    r = i2c_soft_write(self_p->i2c_p, self_p->i2c_addr, sendbuf, size);
 
-    r = i2c_soft_write(self_p->i2c_p, self_p->i2c_addr, sendbuf,
-                       sizeof(sendbuf));
+    if (r == size) {
+        memcpy(&self_p->displayed.buf[0],
+               &self_p->buf[0],
+               sizeof(self_p->displayed.buf));
+        self_p->displayed.valid = 1;
 
-    if (r == sizeof(sendbuf)) {
         return (0);
     }
     if (r < 0) {
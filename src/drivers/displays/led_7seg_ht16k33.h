@@ -33,6 +33,11 @@ struct led_7seg_ht16k33_driver_t {
     struct i2c_soft_driver_t *i2c_p;
     int i2c_addr;
     uint8_t buf[5];
+    struct {
+        /* The buffer last sent to the display. */
+        uint8_t buf[5];
+        int valid;
+    } displayed;
 };
 
 //! Minimum brightness.
@@ -77,7 +82,9 @@ int led_7seg_ht16k33_init(struct led_7seg_ht16k33_driver_t *self_p,
 int led_7seg_ht16k33_start(struct led_7seg_ht16k33_driver_t *self_p);
 
 /**
- * Send content of display buffer to the display.
+ * Send content of display buffer to the display. Only the positions
+ * that changed since the previous call are sent, in a single I2C
+ * write, and nothing is sent if the buffer is unchanged.
  *
  * @param[in] self_p Driver object.
  *
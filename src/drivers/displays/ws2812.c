@@ -32,39 +32,147 @@
 
 #if defined(ARCH_ESP32)
 
-static inline void nop(int number)
+/* The pulse train is generated by the RMT peripheral, one channel per
+   pin device. The 80 MHz APB clock divided by two gives 25 ns
+   ticks. */
+#define CLOCK_DIVIDER                                       2
+#define NS_TO_TICKS(ns)                               ((ns) / 25)
+
+#define ZERO ESP32_RMT_ENTRY(1, NS_TO_TICKS(400), 0, NS_TO_TICKS(850))
+#define ONE  ESP32_RMT_ENTRY(1, NS_TO_TICKS(800), 0, NS_TO_TICKS(450))
+
+/* Hold the line low for the reset period, then end the frame with a
+   zero duration. */
+#define END  ESP32_RMT_ENTRY(0, NS_TO_TICKS(50000), 0, 0)
+
+/* The transmitter wraps around in the channel RAM block. Each half
+   of the block, four bytes, is refilled when the transmitter has
+   passed it. */
+#define HALF_BLOCK_SIZE               (ESP32_RMT_RAM_BLOCK_SIZE / 2)
+#define BYTES_PER_HALF_BLOCK                   (HALF_BLOCK_SIZE / 8)
+
+/* Position of a channel when the end entry has been written. */
+#define POSITION_END                                   ((size_t)-1)
+
+#else
+#    error "Architecture not supported."
+#endif
+
+struct module_t {
+    int initialized;
+    int next_channel;
+    struct ws2812_driver_t *drivers_p[WS2812_PIN_DEVICES_MAX];
+};
+
+static struct module_t module;
+
+/**
+ * Encode the next byte(s) of given pin device into the half block the
+ * transmitter has passed.
+ */
+static RAM_CODE void fill_half_block_isr(struct ws2812_driver_t *self_p,
+                                         int index)
 {
+    volatile uint32_t *entry_p;
+    size_t position;
+    uint8_t value;
     int i;
+    int j;
+
+    position = self_p->async.positions[index];
 
-    for (i = 0; i < number; i++) {
-        asm volatile ("nop");
+    if (position == POSITION_END) {
+        return;
     }
+
+    entry_p = &ESP32_RMT_RAM[ESP32_RMT_RAM_BLOCK_SIZE * (self_p->channel + index)
+                             + (HALF_BLOCK_SIZE
+                                * ((position / BYTES_PER_HALF_BLOCK) % 2))];
+
+    for (i = 0; i < BYTES_PER_HALF_BLOCK; i++) {
+        if (position == self_p->async.size) {
+            *entry_p = END;
+            position = POSITION_END;
+            break;
+        }
+
+        value = self_p->async.buf_p[self_p->number_of_pins * position + index];
+
+        for (j = 7; j >= 0; j--) {
+            *entry_p++ = (((value >> j) & 0x01) ? ONE : ZERO);
+        }
+
+        position++;
+    }
+
+    self_p->async.positions[index] = position;
 }
 
-static inline void busy_wait_300_ns(void)
+static RAM_CODE void frame_done_isr(struct ws2812_driver_t *self_p)
 {
-    int i;
+    if (self_p->async.thrd_p != NULL) {
+        thrd_resume_isr(self_p->async.thrd_p, 0);
+        self_p->async.thrd_p = NULL;
+    }
 
-    for (i = 0; i < 13; i++) {
-        asm volatile ("nop");
+    if (self_p->async.callback != NULL) {
+        self_p->async.callback(self_p->async.arg_p);
     }
 }
 
-static inline void busy_wait_600_ns(void)
+static RAM_CODE void isr(void *arg_p)
 {
-    int i;
+    struct ws2812_driver_t *self_p;
+    uint32_t status;
+    int channel;
 
-    for (i = 0; i < 20; i++) {
-        asm volatile ("nop");
+    status = ESP32_RMT->INT_ST;
+    ESP32_RMT->INT_CLR = status;
+
+    for (channel = 0; channel < module.next_channel; channel++) {
+        self_p = module.drivers_p[channel];
+
+        if (status & ESP32_RMT_INT_TX_THR_EVENT(channel)) {
+            fill_half_block_isr(self_p, channel - self_p->channel);
+        }
+
+        if (status & ESP32_RMT_INT_TX_END(channel)) {
+            ESP32_RMT->CONF[channel].CONF1 &= ~ESP32_RMT_CONF1_TX_START;
+            self_p->async.number_of_active_pins--;
+
+            if (self_p->async.number_of_active_pins == 0) {
+                frame_done_isr(self_p);
+            }
+        }
     }
 }
 
-#else
-#    error "Architecture not supported."
-#endif
-
 int ws2812_module_init()
 {
+    /* Return immediately if the module is already initialized. */
+    if (module.initialized == 1) {
+        return (0);
+    }
+
+    module.initialized = 1;
+    module.next_channel = 0;
+
+    SET_PERI_REG_MASK(DPORT_PERIP_CLK_EN_REG, DPORT_RMT_CLK_EN);
+    CLEAR_PERI_REG_MASK(DPORT_PERIP_RST_EN_REG, DPORT_RMT_RST);
+
+    /* Direct access to the channel RAM and wrap around
+       transmission. */
+    ESP32_RMT->APB_CONF = (ESP32_RMT_APB_CONF_FIFO_MASK
+                           | ESP32_RMT_APB_CONF_MEM_TX_WRAP_EN);
+    ESP32_RMT->INT_ENA = 0;
+    ESP32_RMT->INT_CLR = 0xffffffff;
+
+    esp_xt_set_interrupt_handler(ESP32_CPU_INTR_RMT_NUM, isr, NULL);
+    esp_xt_ints_on(BIT(ESP32_CPU_INTR_RMT_NUM));
+    intr_matrix_set(xPortGetCoreID(),
+                    ESP32_INTR_SOURCE_RMT,
+                    ESP32_CPU_INTR_RMT_NUM);
+
     return (0);
 }
 
@@ -79,15 +187,38 @@ int ws2812_init(struct ws2812_driver_t *self_p,
             EINVAL);
 
     int i;
+    int channel;
+
+    if (module.next_channel + number_of_pins > WS2812_PIN_DEVICES_MAX) {
+        return (-ENOMEM);
+    }
 
     self_p->pins_pp = pins_pp;
     self_p->number_of_pins = number_of_pins;
-    self_p->mask = 0;
+    self_p->channel = module.next_channel;
+    self_p->async.number_of_active_pins = 0;
+    self_p->async.thrd_p = NULL;
+    self_p->async.callback = NULL;
+    module.next_channel += number_of_pins;
 
     for (i = 0; i < number_of_pins; i++) {
+        channel = (self_p->channel + i);
+        module.drivers_p[channel] = self_p;
+
         pin_device_set_mode(pins_pp[i], PIN_OUTPUT);
         pin_device_write_low(pins_pp[i]);
-        self_p->mask |= (1 << pins_pp[i]->id);
+
+        ESP32_RMT->CONF[channel].CONF0 = (ESP32_RMT_CONF0_DIV_CNT(CLOCK_DIVIDER)
+                                          | ESP32_RMT_CONF0_MEM_SIZE(1)
+                                          | ESP32_RMT_CONF0_CLK_EN);
+        ESP32_RMT->CONF[channel].CONF1 = (ESP32_RMT_CONF1_REF_ALWAYS_ON
+                                          | ESP32_RMT_CONF1_IDLE_OUT_EN);
+        ESP32_RMT->TX_LIM[channel] = HALF_BLOCK_SIZE;
+
+        /* Route the channel output to the pin. */
+        ESP32_GPIO->FUNC_OUT_SEL_CFG[pins_pp[i]->id] =
+            (ESP32_PERIPHERAL_SIGNAL_RMT_SIG_OUT0 + channel);
+        ESP32_IO_MUX->PIN[pins_pp[i]->iomux] = (ESP32_IO_MUX_PIN_MCU_SEL_GPIO);
     }
 
     return (0);
@@ -100,47 +231,63 @@ int ws2812_write(struct ws2812_driver_t *self_p,
     ASSERTN(self_p != NULL, EINVAL);
     ASSERTN(buffer_p != NULL, EINVAL);
 
-    int i, j, k, l;
-    uint32_t ones, zeros;
+    int res;
+
+    res = ws2812_async_write(self_p, buffer_p, number_of_pixles);
+
+    if (res != 0) {
+        return (res);
+    }
+
+    return (ws2812_async_wait(self_p));
+}
+
+int ws2812_async_write(struct ws2812_driver_t *self_p,
+                       const uint8_t *buffer_p,
+                       int number_of_pixles)
+{
+    ASSERTN(self_p != NULL, EINVAL);
+    ASSERTN(buffer_p != NULL, EINVAL);
+    ASSERTN(number_of_pixles >= 0, EINVAL);
+
+    int i;
+    int channel;
+    uint32_t mask;
+
+    if (self_p->async.number_of_active_pins > 0) {
+        return (-EBUSY);
+    }
 
-    /* Refresh, 50 us is not needed, 5 us is enough. */
-    time_busy_wait_us(5);
+    self_p->async.buf_p = buffer_p;
+    self_p->async.size = (3 * number_of_pixles);
+    mask = 0;
+
+    /* Fill both halves of each block before starting. */
+    for (i = 0; i < self_p->number_of_pins; i++) {
+        channel = (self_p->channel + i);
+        self_p->async.positions[i] = 0;
+        fill_half_block_isr(self_p, i);
+        fill_half_block_isr(self_p, i);
+        mask |= (ESP32_RMT_INT_TX_THR_EVENT(channel)
+                 | ESP32_RMT_INT_TX_END(channel));
+    }
 
     sys_lock();
 
-    for (i = 0; i < number_of_pixles; i++) {
-        for (j = 0; j < 3; j++) {
-            for (k = 7; k >= 0; k--) {
-                ones = 0;
-
-                for (l = 0; l < 8; l++) {
-                    if (l < self_p->number_of_pins) {
-                        if ((buffer_p[l] >> k) & 0x01) {
-                            ones |= (1 << self_p->pins_pp[l]->id);
-                        } else {
-                            nop(1);
-                        }
-                    } else {
-                            nop(3);
-                    }
-                }
-
-                zeros = ~ones;
-                zeros &= self_p->mask;
-
-                ESP32_GPIO->OUT[0].W1TS = self_p->mask;
-
-                /* Zeros. */
-                busy_wait_300_ns();
-                ESP32_GPIO->OUT[0].W1TC = zeros;
-
-                /* Ones. */
-                busy_wait_600_ns();
-                ESP32_GPIO->OUT[0].W1TC = ones;
-            }
+    self_p->async.number_of_active_pins = self_p->number_of_pins;
+    ESP32_RMT->INT_CLR = mask;
+    ESP32_RMT->INT_ENA |= mask;
 
-            buffer_p += self_p->number_of_pins;
-        }
+    for (i = 0; i < self_p->number_of_pins; i++) {
+        channel = (self_p->channel + i);
+        ESP32_RMT->CONF[channel].CONF1 |= ESP32_RMT_CONF1_MEM_RD_RST;
+        ESP32_RMT->CONF[channel].CONF1 &= ~ESP32_RMT_CONF1_MEM_RD_RST;
+    }
+
+    /* Start all channels back to back to keep the strips in step. */
+    for (i = 0; i < self_p->number_of_pins; i++) {
+        channel = (self_p->channel + i);
+        ESP32_RMT->CONF[channel].CONF1 |= ESP32_RMT_CONF1_TX_START;
     }
 
     sys_unlock();
@@ -148,4 +295,34 @@ int ws2812_write(struct ws2812_driver_t *self_p,
     return (0);
 }
 
+int ws2812_async_wait(struct ws2812_driver_t *self_p)
+{
+    ASSERTN(self_p != NULL, EINVAL);
+
+    sys_lock();
+
+    if (self_p->async.number_of_active_pins > 0) {
+        self_p->async.thrd_p = thrd_self();
+        thrd_suspend_isr(NULL);
+    }
+
+    sys_unlock();
+
+    return (0);
+}
+
+int ws2812_set_frame_done_callback(struct ws2812_driver_t *self_p,
+                                   ws2812_frame_done_t callback,
+                                   void *arg_p)
+{
+    ASSERTN(self_p != NULL, EINVAL);
+
+    sys_lock();
+    self_p->async.callback = callback;
+    self_p->async.arg_p = arg_p;
+    sys_unlock();
+
+    return (0);
+}
+
 #endif
@@ -36,10 +36,27 @@
  */
 #define WS2812_PIN_DEVICES_MAX                              8
 
+/**
+ * Frame done callback. Called from interrupt context when all pin
+ * devices have sent their frame, including the reset period.
+ *
+ * @param[in] arg_p Argument given to `ws2812_set_frame_done_callback()`.
+ */
+typedef void (*ws2812_frame_done_t)(void *arg_p);
+
 struct ws2812_driver_t {
     struct pin_device_t **pins_pp;
     int number_of_pins;
-    uint32_t mask;
+    int channel;
+    struct {
+        const uint8_t *buf_p;
+        size_t size;
+        size_t positions[WS2812_PIN_DEVICES_MAX];
+        int number_of_active_pins;
+        struct thrd_t *thrd_p;
+        ws2812_frame_done_t callback;
+        void *arg_p;
+    } async;
 };
 
 /**
@@ -56,6 +73,10 @@ int ws2812_module_init(void);
 /**
  * Initialize given driver object from given configuration.
  *
+ * Each pin device is driven by its own hardware channel, so all pin
+ * devices of all driver objects share ``WS2812_PIN_DEVICES_MAX``
+ * channels.
+ *
  * @param[out] self_p Driver object to be initialized.
  * @param[in] pin_devices_pp An array of pin device(s) to use. The
  *                           maximum length of the array is defined as
@@ -70,13 +91,9 @@ int ws2812_init(struct ws2812_driver_t *self_p,
                 int number_of_pin_devices);
 
 /**
- * Write given RGB colors to the NeoPixels.
- *
- * CAUTION: Interrupts are disabled during the write to meet the
- *          strict timing requirements on the pulse train. It takes
- *          ~30 us to write to one pixel, that is, interrupts are
- *          disabled for ~30 * number_of_pixles us. Long pixel chains
- *          may cause the rest of the system to misbehave.
+ * Write given RGB colors to the NeoPixels. Waits for the frame to be
+ * sent. Other threads and interrupts may run during the write, as
+ * the pulse train is generated by hardware.
  *
  * @param[in] self_p Driver object.
  * @param[in] colors_p An array of GRB colors to write to the
@@ -94,4 +111,47 @@ int ws2812_write(struct ws2812_driver_t *self_p,
                  const uint8_t *colors_p,
                  int number_of_pixles);
 
+/**
+ * Start writing given RGB colors to the NeoPixels and return
+ * immediately. The pin devices are written in parallel. Call
+ * `ws2812_async_wait()` to wait for the frame to be sent.
+ *
+ * @param[in] self_p Driver object.
+ * @param[in] colors_p An array of GRB colors, in the same format as
+ *                     for `ws2812_write()`. It must not be modified
+ *                     until the frame has been sent.
+ * @param[in] number_of_pixles Number of GRB colors per pin device
+ *                             in `colors_p`.
+ *
+ * @return zero(0) or negative error code.
+ */
+int ws2812_async_write(struct ws2812_driver_t *self_p,
+                       const uint8_t *colors_p,
+                       int number_of_pixles);
+
+/**
+ * Wait for an asynchronous write started by `ws2812_async_write()`
+ * to complete.
+ *
+ * @param[in] self_p Driver object.
+ *
+ * @return zero(0) or negative error code.
+ */
+int ws2812_async_wait(struct ws2812_driver_t *self_p);
+
+/**
+ * Set the function called from interrupt context each time a frame
+ * has been sent, for example to signal an event from interrupt
+ * context instead of waiting in `ws2812_async_wait()`.
+ *
+ * @param[in] self_p Driver object.
+ * @param[in] callback Callback, or NULL to disable it.
+ * @param[in] arg_p Argument passed to the callback.
+ *
+ * @return zero(0) or negative error code.
+ */
+int ws2812_set_frame_done_callback(struct ws2812_driver_t *self_p,
+                                   ws2812_frame_done_t callback,
+                                   void *arg_p);
+
 #endif
@@ -30,50 +30,21 @@
 #define __DRIVERS_TYPES_H__
 
 /**
- * Prologue of the software PWM interrupt handler.
+ * Prologue of the software PWM interrupt handler. Sets ``delta`` to
+ * the timer count to the next edge.
  */
-#define PWM_SOFT_ISR_PROLOGUE                                           \
-    struct pwm_soft_driver_t *elem_p;                                   \
-                                                                        \
-    /* Set the next timeout timer count early for better accuracy. */   \
-    elem_p = module.current_p->next_p;                                  \
-                                                                        \
-    while (elem_p->delta == 0) {                                        \
-        elem_p = elem_p->next_p;                                        \
-    }
+#define PWM_SOFT_ISR_PROLOGUE                                   \
+    unsigned int delta;                                         \
+                                                                \
+    /* Set the next timeout timer count early for better        \
+       accuracy. */                                             \
+    delta = advance_edge_isr();
 
 /**
  * Epilogue of the software PWM interrupt handler.
  */
-#define PWM_SOFT_ISR_EPILOGUE                                   \
-    /* Update pin values. */                                    \
-    elem_p = module.current_p;                                  \
-                                                                \
-    if (elem_p != &module.tail_pwm_soft) {                      \
-        do {                                                    \
-            pin_device_write_low(elem_p->pin_dev_p);            \
-            elem_p = elem_p->next_p;                            \
-        } while (elem_p->delta == 0);                           \
-    } else {                                                    \
-        /* One period has elapsed. Set all PWM:s high. */       \
-        elem_p = module.head_p;                                 \
-                                                                \
-        while (elem_p != &module.tail_pwm_soft) {               \
-            pin_device_write_high(elem_p->pin_dev_p);           \
-            elem_p = elem_p->next_p;                            \
-        }                                                       \
-                                                                \
-        elem_p = module.tail_pwm_soft.next_p;                   \
-    }                                                           \
-                                                                \
-    /* Unlink stopped elements. */                              \
-    if (module.current_p->thrd_p != NULL) {                     \
-        unlink_pwm_soft_isr(module.current_p);                  \
-        thrd_resume_isr(module.current_p->thrd_p, 0);           \
-        module.current_p->thrd_p = NULL;                        \
-    }                                                           \
-                                                                \
-    /* Save current element. */                                 \
-    module.current_p = elem_p;
+#define PWM_SOFT_ISR_EPILOGUE                   \
+    /* Update pin values. */                    \
+    write_edge_isr();
 
 #endif
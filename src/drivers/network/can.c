@@ -30,6 +30,45 @@
 
 #if CONFIG_CAN == 1
 
+/**
+ * Returns the frame reception timestamp for the current time.
+ */
+static inline uint32_t timestamp_isr(void)
+{
+    struct time_t uptime;
+
+    sys_uptime_isr(&uptime);
+
+    return ((uint32_t)uptime.seconds * 1000000
+            + (uint32_t)uptime.nanoseconds / 1000);
+}
+
+/**
+ * Returns true(1) if given received frame matches the driver
+ * acceptance filters, otherwise false(0).
+ */
+static int is_frame_accepted_isr(struct can_driver_t *self_p,
+                                 const struct can_frame_t *frame_p)
+{
+    const struct can_filter_t *filter_p;
+    int i;
+
+    if (self_p->filters.length == 0) {
+        return (1);
+    }
+
+    for (i = 0; i < self_p->filters.length; i++) {
+        filter_p = &self_p->filters.filters_p[i];
+
+        if ((frame_p->extended_frame == filter_p->extended_frame)
+            && (((frame_p->id ^ filter_p->id) & filter_p->mask) == 0)) {
+            return (1);
+        }
+    }
+
+    return (0);
+}
+
 #include "can_port.i"
 
 static ssize_t base_chan_read(void *base_p, void *buf_p, size_t size)
@@ -77,9 +116,32 @@ int can_init(struct can_driver_t *self_p,
 
     mutex_init(&self_p->mutex);
 
+    self_p->filters.filters_p = NULL;
+    self_p->filters.length = 0;
+
     return (can_port_init(self_p, dev_p, speed));
 }
 
+int can_set_filters(struct can_driver_t *self_p,
+                    const struct can_filter_t *filters_p,
+                    int length)
+{
+    ASSERTN(self_p != NULL, EINVAL);
+    ASSERTN((filters_p != NULL) || (length == 0), EINVAL);
+    ASSERTN(length >= 0, EINVAL);
+
+#if defined(CAN_PORT_FILTERS_MAX)
+    if (length > CAN_PORT_FILTERS_MAX) {
+        return (-EINVAL);
+    }
+#endif
+
+    self_p->filters.filters_p = filters_p;
+    self_p->filters.length = length;
+
+    return (0);
+}
+
 int can_start(struct can_driver_t *self_p)
 {
     ASSERTN(self_p != NULL, EINVAL);
@@ -105,6 +167,39 @@ ssize_t can_read(struct can_driver_t *self_p,
     return (queue_read(&self_p->chin, frame_p, size));
 }
 
+ssize_t can_read_many(struct can_driver_t *self_p,
+                      struct can_frame_t *frames_p,
+                      size_t length)
+{
+    ASSERTN(self_p != NULL, EINVAL);
+    ASSERTN(frames_p != NULL, EINVAL);
+    ASSERTN(length > 0, EINVAL);
+
+    ssize_t res;
+    size_t size;
+
+    /* Wait for the first frame. */
+    res = queue_read(&self_p->chin, frames_p, sizeof(*frames_p));
+
+    if (res != sizeof(*frames_p)) {
+        return (res);
+    }
+
+    /* Drain the frames already received without waiting for more. */
+    size = (queue_size(&self_p->chin) / sizeof(*frames_p));
+    size = (MIN(size, length - 1) * sizeof(*frames_p));
+
+    if (size > 0) {
+        res = queue_read(&self_p->chin, &frames_p[1], size);
+
+        if (res != size) {
+            return (res);
+        }
+    }
+
+    return (1 + size / sizeof(*frames_p));
+}
+
 ssize_t can_write(struct can_driver_t *self_p,
                   const struct can_frame_t *frame_p,
                   size_t size)
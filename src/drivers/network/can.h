@@ -30,6 +30,19 @@
 #define __DRIVERS_CAN_H__
 
 #include "simba.h"
+
+/**
+ * A hardware acceptance filter. A received frame is accepted if its
+ * frame format matches and all bits set in the mask are equal in the
+ * frame and filter ids.
+ */
+struct can_filter_t {
+    uint32_t id;                    /* Frame ID to match. */
+    uint32_t mask;                  /* Frame ID bits to compare. */
+    int extended_frame;             /* Match extended (29 bits) or
+                                       standard (11 bits) frames. */
+};
+
 #include "can_port.h"
 
 #define CAN_SPEED_1000KBPS CAN_PORT_SPEED_1000KBPS
@@ -44,8 +57,10 @@ struct can_frame_t {
         uint8_t size : 4;           /* Number of bytes in data array. */
     };
 #if CONFIG_CAN_FRAME_TIMESTAMP == 1
-    uint32_t timestamp;             /* Frame reception/transmission
-                                       timestamp. */
+    uint32_t timestamp;             /* Frame reception timestamp in
+                                       microseconds since startup,
+                                       with system tick
+                                       resolution. */
 #endif
     union {
         uint8_t u8[8];
@@ -84,6 +99,31 @@ int can_init(struct can_driver_t *self_p,
              void *rxbuf_p,
              size_t size);
 
+/**
+ * Set the acceptance filters of given driver object. A received frame
+ * is only written to the reception buffer if it matches at least one
+ * filter. All frames are accepted if no filters are set, which is the
+ * default.
+ *
+ * The filters are programmed into the controller hardware when the
+ * driver is started, so this function must be called before
+ * `can_start()`. Frames passing the hardware filters are matched
+ * exactly in software, in case the hardware can only approximate the
+ * filter list.
+ *
+ * @param[in] self_p Initialized driver object.
+ * @param[in] filters_p Array of filters. Must be valid as long as the
+ *                      driver is started.
+ * @param[in] length Number of filters in the array, or zero(0) to
+ *                   accept all frames.
+ *
+ * @return zero(0) or negative error code. Value -EINVAL if the
+ *         hardware does not have room for given number of filters.
+ */
+int can_set_filters(struct can_driver_t *self_p,
+                    const struct can_filter_t *filters_p,
+                    int length);
+
 /**
  * Starts the CAN device using configuration in given driver object.
  *
@@ -118,6 +158,21 @@ ssize_t can_read(struct can_driver_t *self_p,
                  struct can_frame_t *frame_p,
                  size_t size);
 
+/**
+ * Read up to given number of CAN frames from the CAN bus. Blocks until
+ * at least one frame is received, and then reads all frames already
+ * in the reception buffer, up to given number, in a single call.
+ *
+ * @param[in] self_p Initialized driver object.
+ * @param[out] frames_p Array of read frames.
+ * @param[in] length Number of frames in the array.
+ *
+ * @return Number of read frames or negative error code.
+ */
+ssize_t can_read_many(struct can_driver_t *self_p,
+                      struct can_frame_t *frames_p,
+                      size_t length);
+
 /**
  * Write one or more CAN frames to the CAN bus. Blocks until the
  * frame(s) have been transmitted.
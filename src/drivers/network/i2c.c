@@ -43,12 +43,77 @@ struct module_t {
 #endif
 };
 
+#if defined(I2C_PORT_HAS_ASYNC)
+
+static void i2c_port_transaction_start_isr(
+    struct i2c_transaction_t *transaction_p);
+
+/**
+ * Called by the port when the transaction at the head of the queue
+ * of given device is complete. Starts the next transaction, if any.
+ */
+static void transaction_complete_isr(struct i2c_device_t *dev_p,
+                                     ssize_t res)
+{
+    struct i2c_transaction_t *transaction_p;
+
+    transaction_p = dev_p->transactions.head_p;
+
+    if (transaction_p == NULL) {
+        return;
+    }
+
+    dev_p->transactions.head_p = transaction_p->next_p;
+    transaction_p->res = res;
+    transaction_p->done = 1;
+
+    if (transaction_p->callback != NULL) {
+        transaction_p->callback(transaction_p->arg_p, res);
+    }
+
+    if (transaction_p->thrd_p != NULL) {
+        thrd_resume_isr(transaction_p->thrd_p, 0);
+    }
+
+    if (dev_p->transactions.head_p != NULL) {
+        i2c_port_transaction_start_isr(dev_p->transactions.head_p);
+    }
+}
+
+#endif
+
 #if CONFIG_SOFTWARE_I2C == 1
 #    include "../ports/software/i2c_port.i"
 #else
 #    include "i2c_port.i"
 #endif
 
+#if defined(I2C_PORT_HAS_ASYNC)
+
+/**
+ * Perform a transaction of a single message and wait for it to
+ * complete.
+ */
+static ssize_t transfer(struct i2c_driver_t *self_p,
+                        int address,
+                        void *buf_p,
+                        size_t size,
+                        int flags)
+{
+    struct i2c_message_t message;
+    struct i2c_transaction_t transaction;
+
+    message.buf_p = buf_p;
+    message.size = size;
+    message.flags = flags;
+    i2c_transaction_init(&transaction, address, &message, 1);
+    i2c_transfer_async(self_p, &transaction);
+
+    return (i2c_transaction_wait(&transaction));
+}
+
+#endif
+
 static struct module_t module;
 
 #if CONFIG_I2C_FS_COMMAND_READ == 1
@@ -238,13 +303,28 @@ int i2c_start(struct i2c_driver_t *self_p)
 {
     ASSERTN(self_p != NULL, EINVAL);
 
-    return (i2c_port_start(self_p));
+    int res;
+
+    res = i2c_port_start(self_p);
+
+#if CONFIG_POWER == 1
+    /* The peripheral clock must run while started. */
+    if (res == 0) {
+        power_stay_awake_acquire(POWER_MODE_IDLE);
+    }
+#endif
+
+    return (res);
 }
 
 int i2c_stop(struct i2c_driver_t *self_p)
 {
     ASSERTN(self_p != NULL, EINVAL);
 
+#if CONFIG_POWER == 1
+    power_stay_awake_release(POWER_MODE_IDLE);
+#endif
+
     return (i2c_port_stop(self_p));
 }
 
@@ -258,7 +338,11 @@ ssize_t i2c_read(struct i2c_driver_t *self_p,
     ASSERTN(buf_p != NULL, EINVAL);
     ASSERTN(size > 0, EINVAL);
 
+#if defined(I2C_PORT_HAS_ASYNC)
+    return (transfer(self_p, address, buf_p, size, I2C_MESSAGE_READ));
+#else
     return (i2c_port_read(self_p, address, buf_p, size));
+#endif
 }
 
 ssize_t i2c_write(struct i2c_driver_t *self_p,
@@ -271,7 +355,15 @@ ssize_t i2c_write(struct i2c_driver_t *self_p,
     ASSERTN(buf_p != NULL, EINVAL);
     ASSERTN(size > 0, EINVAL);
 
+#if defined(I2C_PORT_HAS_ASYNC)
+    return (transfer(self_p,
+                     address,
+                     (void *)buf_p,
+                     size,
+                     I2C_MESSAGE_WRITE));
+#else
     return (i2c_port_write(self_p, address, buf_p, size));
+#endif
 }
 
 int i2c_scan(struct i2c_driver_t *self_p, int address)
@@ -318,4 +410,172 @@ ssize_t i2c_slave_write(struct i2c_driver_t *self_p,
     return (i2c_port_slave_write(self_p, buf_p, size));
 }
 
+int i2c_transaction_init(struct i2c_transaction_t *self_p,
+                         int address,
+                         struct i2c_message_t *messages_p,
+                         int length)
+{
+    ASSERTN(self_p != NULL, EINVAL);
+    ASSERTN(address < 128, EINVAL);
+    ASSERTN(messages_p != NULL, EINVAL);
+    ASSERTN(length > 0, EINVAL);
+
+    self_p->drv_p = NULL;
+    self_p->address = address;
+    self_p->messages_p = messages_p;
+    self_p->length = length;
+    self_p->callback = NULL;
+    self_p->arg_p = NULL;
+    self_p->res = 0;
+    self_p->done = 1;
+    self_p->thrd_p = NULL;
+    self_p->next_p = NULL;
+
+    return (0);
+}
+
+int i2c_transaction_set_callback(struct i2c_transaction_t *self_p,
+                                 i2c_callback_t callback,
+                                 void *arg_p)
+{
+    ASSERTN(self_p != NULL, EINVAL);
+
+    self_p->callback = callback;
+    self_p->arg_p = arg_p;
+
+    return (0);
+}
+
+int i2c_transfer_async(struct i2c_driver_t *self_p,
+                       struct i2c_transaction_t *transaction_p)
+{
+    ASSERTN(self_p != NULL, EINVAL);
+    ASSERTN(transaction_p != NULL, EINVAL);
+    ASSERTN(transaction_p->done == 1, EBUSY);
+
+    transaction_p->drv_p = self_p;
+    transaction_p->res = 0;
+    transaction_p->done = 0;
+    transaction_p->thrd_p = NULL;
+    transaction_p->next_p = NULL;
+
+#if defined(I2C_PORT_HAS_ASYNC)
+    struct i2c_device_t *dev_p;
+
+    dev_p = self_p->dev_p;
+
+    sys_lock();
+
+    if (dev_p->transactions.head_p == NULL) {
+        dev_p->transactions.head_p = transaction_p;
+        dev_p->transactions.tail_p = transaction_p;
+        i2c_port_transaction_start_isr(transaction_p);
+    } else {
+        dev_p->transactions.tail_p->next_p = transaction_p;
+        dev_p->transactions.tail_p = transaction_p;
+    }
+
+    sys_unlock();
+#else
+    struct i2c_message_t *message_p;
+    ssize_t res;
+    int i;
+
+    /* Synchronous fallback, one transfer per message. */
+    message_p = transaction_p->messages_p;
+
+    for (i = 0; i < transaction_p->length; i++, message_p++) {
+        if (message_p->flags & I2C_MESSAGE_READ) {
+            res = i2c_port_read(self_p,
+                                transaction_p->address,
+                                message_p->buf_p,
+                                message_p->size);
+        } else {
+            res = i2c_port_write(self_p,
+                                 transaction_p->address,
+                                 message_p->buf_p,
+                                 message_p->size);
+        }
+
+        if (res < 0) {
+            transaction_p->res = res;
+            break;
+        }
+
+        transaction_p->res += res;
+
+        if ((size_t)res != message_p->size) {
+            break;
+        }
+    }
+
+    transaction_p->done = 1;
+
+    if (transaction_p->callback != NULL) {
+        transaction_p->callback(transaction_p->arg_p, transaction_p->res);
+    }
+#endif
+
+    return (0);
+}
+
+ssize_t i2c_transaction_wait(struct i2c_transaction_t *self_p)
+{
+    ASSERTN(self_p != NULL, EINVAL);
+
+    ssize_t res;
+
+    sys_lock();
+
+    if (self_p->done == 0) {
+        self_p->thrd_p = thrd_self();
+        thrd_suspend_isr(NULL);
+    }
+
+    res = self_p->res;
+
+    sys_unlock();
+
+    return (res);
+}
+
+ssize_t i2c_write_read(struct i2c_driver_t *self_p,
+                       int address,
+                       const void *txbuf_p,
+                       size_t txsize,
+                       void *rxbuf_p,
+                       size_t rxsize)
+{
+    ASSERTN(self_p != NULL, EINVAL);
+    ASSERTN(txbuf_p != NULL, EINVAL);
+    ASSERTN(txsize > 0, EINVAL);
+    ASSERTN(rxbuf_p != NULL, EINVAL);
+    ASSERTN(rxsize > 0, EINVAL);
+
+    struct i2c_message_t messages[2];
+    struct i2c_transaction_t transaction;
+    ssize_t res;
+
+    messages[0].buf_p = (void *)txbuf_p;
+    messages[0].size = txsize;
+    messages[0].flags = I2C_MESSAGE_WRITE;
+    messages[1].buf_p = rxbuf_p;
+    messages[1].size = rxsize;
+    messages[1].flags = I2C_MESSAGE_READ;
+    i2c_transaction_init(&transaction, address, &messages[0], 2);
+    i2c_transfer_async(self_p, &transaction);
+    res = i2c_transaction_wait(&transaction);
+
+    if (res < 0) {
+        return (res);
+    }
+
+    /* The slave did not accept all written data. */
+    if ((size_t)res < txsize) {
+        return (-1);
+    }
+
+    return (res - txsize);
+}
+
 #endif
@@ -43,6 +43,46 @@
 #define I2C_BAUDRATE_400KBPS     I2C_PORT_BAUDRATE_400KBPS
 #define I2C_BAUDRATE_100KBPS     I2C_PORT_BAUDRATE_100KBPS
 
+/* Message flags. */
+#define I2C_MESSAGE_WRITE                                    0x00
+#define I2C_MESSAGE_READ                                     0x01
+
+/**
+ * Transaction completion callback, called from interrupt context on
+ * ports with asynchronous transfers, and from the calling thread
+ * otherwise.
+ *
+ * @param[in] arg_p Callback argument.
+ * @param[in] res Number of transferred bytes or negative error code.
+ */
+typedef void (*i2c_callback_t)(void *arg_p, ssize_t res);
+
+/**
+ * A read from or write to the slave. Messages in a transaction are
+ * separated by repeated start conditions.
+ */
+struct i2c_message_t {
+    void *buf_p;
+    size_t size;
+    int flags;
+};
+
+/**
+ * A transaction, queued on the bus of its driver.
+ */
+struct i2c_transaction_t {
+    struct i2c_driver_t *drv_p;
+    int address;
+    struct i2c_message_t *messages_p;
+    int length;
+    i2c_callback_t callback;
+    void *arg_p;
+    ssize_t res;
+    int done;
+    struct thrd_t *thrd_p;
+    struct i2c_transaction_t *next_p;
+};
+
 extern struct i2c_device_t i2c_device[I2C_DEVICE_MAX];
 
 /**
@@ -187,4 +227,86 @@ ssize_t i2c_slave_write(struct i2c_driver_t *self_p,
                         const void *buf_p,
                         size_t size);
 
+/**
+ * Initialize given transaction. The messages are transferred to and
+ * from given slave in order, with a repeated start condition between
+ * them and a stop condition after the last one.
+ *
+ * @param[out] self_p Transaction to initialize.
+ * @param[in] address Slave address.
+ * @param[in] messages_p Messages to transfer.
+ * @param[in] length Number of messages.
+ *
+ * @return zero(0) or negative error code.
+ */
+int i2c_transaction_init(struct i2c_transaction_t *self_p,
+                         int address,
+                         struct i2c_message_t *messages_p,
+                         int length);
+
+/**
+ * Set the completion callback of given transaction.
+ *
+ * @param[in] self_p Transaction.
+ * @param[in] callback Callback, or NULL.
+ * @param[in] arg_p Callback argument.
+ *
+ * @return zero(0) or negative error code.
+ */
+int i2c_transaction_set_callback(struct i2c_transaction_t *self_p,
+                                 i2c_callback_t callback,
+                                 void *arg_p);
+
+/**
+ * Queue given transaction on the bus of given driver and return
+ * immediately. Transactions on a bus are performed in the order they
+ * were queued, back-to-back from the i2c interrupt. The transaction
+ * must be kept until it is complete.
+ *
+ * A transaction ends early if the slave does not acknowledge. The
+ * result is -1 if the slave did not acknowledge its address, and
+ * otherwise the number of transferred bytes.
+ *
+ * Ports without asynchronous transfers perform the transaction
+ * before this function returns, with a stop and a start condition
+ * between messages instead of a repeated start.
+ *
+ * @param[in] self_p Started driver object.
+ * @param[in] transaction_p Transaction to queue.
+ *
+ * @return zero(0) or negative error code.
+ */
+int i2c_transfer_async(struct i2c_driver_t *self_p,
+                       struct i2c_transaction_t *transaction_p);
+
+/**
+ * Wait for given queued transaction to complete.
+ *
+ * @param[in] self_p Transaction.
+ *
+ * @return Number of transferred bytes or negative error code.
+ */
+ssize_t i2c_transaction_wait(struct i2c_transaction_t *self_p);
+
+/**
+ * Write given data to given slave, and then read from it after a
+ * repeated start condition, as one transaction. Typically used to
+ * read registers, with the register address as written data.
+ *
+ * @param[in] self_p Started driver object.
+ * @param[in] address Slave address.
+ * @param[in] txbuf_p Data to write.
+ * @param[in] txsize Number of bytes to write.
+ * @param[out] rxbuf_p Buffer to read into.
+ * @param[in] rxsize Number of bytes to read.
+ *
+ * @return Number of read bytes or negative error code.
+ */
+ssize_t i2c_write_read(struct i2c_driver_t *self_p,
+                       int address,
+                       const void *txbuf_p,
+                       size_t txsize,
+                       void *rxbuf_p,
+                       size_t rxsize);
+
 #endif
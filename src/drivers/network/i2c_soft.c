@@ -30,6 +30,28 @@
 
 #if CONFIG_I2C_SOFT == 1
 
+/* Number of times SCL is polled before going to sleep waiting for
+   clock stretching to end. Covers the SCL rise time. */
+#define CLOCK_STRETCHING_POLLS                              8
+
+#if defined(PIN_PORT_HAS_BUSY_WAIT)
+/* Estimated number of CPU cycles spent changing and reading pins per
+   half clock period. */
+#    define HALF_PERIOD_OVERHEAD_CYCLES                    12
+#endif
+
+/**
+ * Wait half a clock period.
+ */
+static inline void wait_half_period(struct i2c_soft_driver_t *self_p)
+{
+#if defined(PIN_PORT_HAS_BUSY_WAIT)
+    pin_busy_wait(self_p->half_period);
+#else
+    time_busy_wait_us(self_p->baudrate_us);
+#endif
+}
+
 /**
  * Wait for clock streching to end. That is, wait for SCL to be 1.
  *
@@ -39,6 +61,15 @@
 static int wait_for_clock_stretching_end(struct i2c_soft_driver_t *self_p)
 {
     long clock_stretching_us;
+    int i;
+
+    /* Busy poll first as the slave is most often not stretching the
+       clock, and sleeping is much longer than a clock period. */
+    for (i = 0; i < CLOCK_STRETCHING_POLLS; i++) {
+        if (pin_device_read(self_p->scl_p) == 1) {
+            return (0);
+        }
+    }
 
     clock_stretching_us = 0;
 
@@ -71,7 +102,7 @@ static int start_cond(struct i2c_soft_driver_t *self_p)
 
     /* SCL is high, set SDA from 1 to 0. */
     pin_device_set_mode(self_p->sda_p, PIN_OUTPUT);
-    time_busy_wait_us(self_p->baudrate_us);
+    wait_half_period(self_p);
 
     /* Set SCL low as preparation for the first transfer. */
     pin_device_set_mode(self_p->scl_p, PIN_OUTPUT);
@@ -89,7 +120,7 @@ static int stop_cond(struct i2c_soft_driver_t *self_p)
 {
     /* Set SDA to 0. */
     pin_device_set_mode(self_p->sda_p, PIN_OUTPUT);
-    time_busy_wait_us(self_p->baudrate_us);
+    wait_half_period(self_p);
 
     /* SDA to 1. */
     pin_device_set_mode(self_p->scl_p, PIN_INPUT);
@@ -100,18 +131,18 @@ static int stop_cond(struct i2c_soft_driver_t *self_p)
     }
 
     /* Stop bit setup time, minimum 4us. */
-    time_busy_wait_us(self_p->baudrate_us);
+    wait_half_period(self_p);
 
     /* SCL is high, set SDA from 0 to 1. */
     pin_device_set_mode(self_p->sda_p, PIN_INPUT);
-    time_busy_wait_us(self_p->baudrate_us);
+    wait_half_period(self_p);
 
     /* Make sure no device is pulling SDA low. */
     if (pin_device_read(self_p->sda_p) == 0) {
         return (-1);
     }
 
-    time_busy_wait_us(self_p->baudrate_us);
+    wait_half_period(self_p);
 
     return (0);
 }
@@ -132,14 +163,14 @@ static int write_bit(struct i2c_soft_driver_t *self_p,
     }
 
     /* SDA change propagation delay. */
-    time_busy_wait_us(self_p->baudrate_us);
+    wait_half_period(self_p);
 
     /* Set SCL high to indicate a new valid SDA value is available */
     pin_device_set_mode(self_p->scl_p, PIN_INPUT);
 
     /* Wait for SDA value to be read by slave, minimum of 4us for
        standard mode. */
-    time_busy_wait_us(self_p->baudrate_us);
+    wait_half_period(self_p);
 
     /* Clock stretching */
     if (wait_for_clock_stretching_end(self_p) != 0) {
@@ -166,7 +197,7 @@ static int read_bit(struct i2c_soft_driver_t *self_p,
 
     /* Wait for SDA value to be written by slave, minimum of 4us for
        standard mode. */
-    time_busy_wait_us(self_p->baudrate_us);
+    wait_half_period(self_p);
 
     /* Set SCL high to indicate a new valid SDA value is available. */
     pin_device_set_mode(self_p->scl_p, PIN_INPUT);
@@ -178,7 +209,7 @@ static int read_bit(struct i2c_soft_driver_t *self_p,
 
     /* Wait for SDA value to be written by slave, minimum of 4us for
        standard mode. */
-    time_busy_wait_us(self_p->baudrate_us);
+    wait_half_period(self_p);
 
     /* SCL is high, read out bit. */
     *value_p = pin_device_read(self_p->sda_p);
@@ -259,6 +290,10 @@ int i2c_soft_init(struct i2c_soft_driver_t *self_p,
     self_p->sda_p = sda_dev_p;
     self_p->baudrate = baudrate;
     self_p->baudrate_us = (1000000L / 2L / baudrate);
+#if defined(PIN_PORT_HAS_BUSY_WAIT)
+    self_p->half_period = PIN_BUSY_WAIT_ITERATIONS(
+        (long)(F_CPU / 2L / baudrate) - HALF_PERIOD_OVERHEAD_CYCLES);
+#endif
     self_p->max_clock_stretching_us = max_clock_stretching_us;
     self_p->clock_stretching_sleep_us = clock_stretching_sleep_us;
 
@@ -36,6 +36,9 @@ struct i2c_soft_driver_t {
     struct pin_device_t *sda_p;
     long baudrate;
     long baudrate_us;
+#if defined(PIN_PORT_HAS_BUSY_WAIT)
+    int half_period;
+#endif
     long max_clock_stretching_us;
     long clock_stretching_sleep_us;
 };
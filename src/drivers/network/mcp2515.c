@@ -45,12 +45,20 @@
 #define SPI_INSTR_RESET          0xc0
 
 /* Registers. */
+#define REG_RXF0SIDH         0x00
+#define REG_RXF1SIDH         0x04
+#define REG_RXF2SIDH         0x08
+#define REG_RXF3SIDH         0x10
+#define REG_RXF4SIDH         0x14
+#define REG_RXF5SIDH         0x18
 #define REG_BFPCTRL          0x0c
 #define REG_TXRTSCTRL        0x0d
 #define REG_CANSTAT          0x0e
 #define REG_CANCTRL          0x0f
 #define REG_TEC              0x1c
 #define REG_REC              0x1d
+#define REG_RXM0SIDH         0x20
+#define REG_RXM1SIDH         0x24
 #define REG_CNF3             0x28
 #define REG_CNF2             0x29
 #define REG_CNF1             0x2a
@@ -75,6 +83,12 @@
 
 /* RXBNCTRL */
 #define REG_RXBNCTRL_RXM_ANY     0x60
+#define REG_RXBNCTRL_RXM_FILTERS 0x00
+#define REG_RXBNCTRL_RXM_MASK    0x60
+#define REG_RXB0CTRL_BUKT        0x04
+
+/* TXBNCTRL */
+#define REG_TXBNCTRL_TXP_MASK    0x03
 
 /* CANINTE */
 #define REG_CANINTE_MERRE 0x80
@@ -106,6 +120,10 @@
 #define SPI_READ_STATUS_TXREQ2 0x40
 #define SPI_READ_STATUS_TX2IF  0x80
 
+/* Three TX buffers. */
+#define TX_BUFFERS_MAX         3
+#define TX_PRIORITY_MAX        3
+
 #define REG_CNF1_SJW(v) ((v) << 6)
 #define REG_CNF1_BRP(v) ((v))
 
@@ -140,9 +158,9 @@
                             REG_CNF3_WAKFIL(0) |        \
                             REG_CNF3_PHSEG2(6))
 
-/* MCP2515 frame structure. */
-struct spi_frame_t {
-    uint8_t instr;
+/* MCP2515 frame header, as laid out in the RX and TX buffer
+   registers. */
+struct spi_frame_header_t {
     uint8_t id_10_3;
     uint8_t eid_17_16 : 2;
     uint8_t reserved0 : 1;
@@ -155,8 +173,23 @@ struct spi_frame_t {
     uint8_t reserved1 : 2;
     uint8_t rtr : 1;
     uint8_t reserved2 : 1;
+} PACKED;
+
+/* READ RX BUFFER instruction, starting at RXBnSIDH. The data follows
+   in the same transfer. */
+struct spi_rx_frame_t {
+    uint8_t instr;
+    struct spi_frame_header_t header;
+} PACKED;
+
+/* WRITE instruction of a complete TX buffer, starting at TXBnCTRL to
+   set the transmit priority in the same transfer. */
+struct spi_tx_frame_t {
+    uint8_t instr;
+    uint8_t addr;
+    uint8_t ctrl;
+    struct spi_frame_header_t header;
     uint8_t data[8];
-    uint8_t canstat;
 } PACKED;
 
 /* Interrupt service routine serving the INT from the hardware. */
@@ -262,14 +295,15 @@ static int register_write(struct mcp2515_driver_t *self_p,
 }
 
 /**
- * Write bit(s) in register with mask.
+ * Modify bit(s) in register with mask, without verification.
  */
-static int register_write_bits(struct mcp2515_driver_t *self_p,
-                               uint8_t addr,
-                               uint8_t mask,
-                               uint8_t value)
+static int register_modify_bits(struct mcp2515_driver_t *self_p,
+                                uint8_t addr,
+                                uint8_t mask,
+                                uint8_t value)
 {
     uint8_t buf[4];
+    int res;
 
     buf[0] = SPI_INSTR_BIT_MODIFY;
     buf[1] = addr;
@@ -278,18 +312,29 @@ static int register_write_bits(struct mcp2515_driver_t *self_p,
 
     spi_take_bus(&self_p->spi);
     spi_select(&self_p->spi);
+    res = spi_write(&self_p->spi, buf, sizeof(buf));
+    spi_deselect(&self_p->spi);
+    spi_give_bus(&self_p->spi);
 
-    if (spi_write(&self_p->spi, buf, sizeof(buf)) != sizeof(buf)) {
-        spi_deselect(&self_p->spi);
-        spi_give_bus(&self_p->spi);
+    return (res == sizeof(buf) ? 0 : -1);
+}
+
+/**
+ * Write bit(s) in register with mask.
+ */
+static int register_write_bits(struct mcp2515_driver_t *self_p,
+                               uint8_t addr,
+                               uint8_t mask,
+                               uint8_t value)
+{
+    uint8_t buf[1];
+
+    if (register_modify_bits(self_p, addr, mask, value) != 0) {
         return (-1);
     }
 
     register_read(self_p, addr, buf);
 
-    spi_deselect(&self_p->spi);
-    spi_give_bus(&self_p->spi);
-
     /* Verify that the bits were written. */
     if ((buf[0] & mask) != value) {
         std_printf(FSTR("register_write_bits failed. wrote 0x%x but read %x\r\n"),
@@ -301,40 +346,135 @@ static int register_write_bits(struct mcp2515_driver_t *self_p,
     return (0);
 }
 
+/**
+ * Wait for a free TX buffer and return its index.
+ *
+ * The hardware transmits the pending buffer with the highest priority
+ * first, so each queued frame is given a lower priority than the
+ * frames already pending to keep the write order. Once the lowest
+ * priority has been used, wait for all pending frames to be
+ * transmitted before starting over at the highest priority.
+ */
+static int tx_buffer_alloc(struct mcp2515_driver_t *self_p,
+                           int *priority_p)
+{
+    int taken;
+    int i;
+
+    sem_take(&self_p->tx.sem, NULL);
+    taken = 1;
+
+    if (self_p->tx.priority < 0) {
+        while (taken < TX_BUFFERS_MAX) {
+            sem_take(&self_p->tx.sem, NULL);
+            taken++;
+        }
+
+        self_p->tx.priority = TX_PRIORITY_MAX;
+        sem_give(&self_p->tx.sem, taken - 1);
+    }
+
+    sys_lock();
+
+    for (i = 0; i < TX_BUFFERS_MAX; i++) {
+        if ((self_p->tx.pending & (1 << i)) == 0) {
+            break;
+        }
+    }
+
+    self_p->tx.pending |= (1 << i);
+    *priority_p = self_p->tx.priority;
+    self_p->tx.priority--;
+
+    sys_unlock();
+
+    return (i);
+}
+
+/**
+ * Mark given TX buffers as free after their frames were transmitted.
+ */
+static void tx_buffers_free(struct mcp2515_driver_t *self_p,
+                            int mask)
+{
+    int count;
+    int i;
+
+    count = 0;
+
+    sys_lock();
+
+    for (i = 0; i < TX_BUFFERS_MAX; i++) {
+        if (mask & self_p->tx.pending & (1 << i)) {
+            self_p->tx.pending &= ~(1 << i);
+            count++;
+        }
+    }
+
+    if (self_p->tx.pending == 0) {
+        self_p->tx.priority = TX_PRIORITY_MAX;
+    }
+
+    sys_unlock();
+
+    if (count > 0) {
+        sem_give(&self_p->tx.sem, count);
+    }
+}
+
 static ssize_t write_cb(void *arg_p,
                         const struct mcp2515_frame_t *frame_p,
                         size_t size)
 {
     struct mcp2515_driver_t *self_p;
-    struct spi_frame_t frame;
-    uint8_t rts = (SPI_INSTR_RTS | 0x1); /* Request to send mailbox 0. */
+    struct spi_tx_frame_t frame;
+    uint8_t rts;
+    int index;
+    int priority;
+    ssize_t length;
+    ssize_t res;
 
     self_p = container_of(arg_p, struct mcp2515_driver_t, chout);
 
-    /* Initiate frame. Always use TX mailbox 0. */
-    frame.instr = SPI_INSTR_LOAD_TX_BUFFER;
-    frame.id_10_3 = ((frame_p->id >> 3) & 0xff);
-    frame.id_2_0 = (frame_p->id & 0x7);
-    frame.ide = 0;
-    frame.eid_17_16 = (frame_p->id >> 27);
-    frame.eid_15_8 = (frame_p->id >> 19);
-    frame.eid_7_0 = (frame_p->id >> 11);
-    frame.rtr = frame_p->rtr;
-    frame.dlc = frame_p->size;
+    mutex_lock(&self_p->tx.mutex);
+
+    index = tx_buffer_alloc(self_p, &priority);
+
+    /* Write control register, header and data in a single burst. */
+    frame.instr = SPI_INSTR_WRITE;
+    frame.addr = (REG_TXB0CTRL + 0x10 * index);
+    frame.ctrl = priority;
+    memset(&frame.header, 0, sizeof(frame.header));
+    frame.header.id_10_3 = ((frame_p->id >> 3) & 0xff);
+    frame.header.id_2_0 = (frame_p->id & 0x7);
+    frame.header.rtr = frame_p->rtr;
+    frame.header.dlc = frame_p->size;
     memcpy(frame.data, frame_p->data, frame_p->size);
+    length = (offsetof(struct spi_tx_frame_t, data) + frame_p->size);
+    rts = (SPI_INSTR_RTS | (1 << index));
 
     spi_take_bus(&self_p->spi);
+
     spi_select(&self_p->spi);
+    res = spi_write(&self_p->spi, &frame, (size_t)length);
+    spi_deselect(&self_p->spi);
 
-    /* Write frame to hardware. */
-    spi_write(&self_p->spi, &frame, sizeof(frame));
-    spi_write(&self_p->spi, &rts, sizeof(rts));
+    /* Request to send as a separate instruction. */
+    if (res == length) {
+        spi_select(&self_p->spi);
+        res = spi_write(&self_p->spi, &rts, sizeof(rts));
+        spi_deselect(&self_p->spi);
+    }
 
-    spi_deselect(&self_p->spi);
     spi_give_bus(&self_p->spi);
 
-    /* Wait for the frame to be transmitted. */
-    sem_take(&self_p->tx_sem, NULL);
+    mutex_unlock(&self_p->tx.mutex);
+
+    if (res < 0) {
+        tx_buffers_free(self_p, (1 << index));
+
+        return (res);
+    }
 
     return (size);
 }
@@ -373,12 +513,165 @@ static int speed_to_cnf(int speed,
     return (0);
 }
 
+/**
+ * Returns true(1) if given frame matches the driver acceptance
+ * filters, otherwise false(0).
+ */
+static int is_frame_accepted(struct mcp2515_driver_t *self_p,
+                             const struct mcp2515_frame_t *frame_p)
+{
+    const struct mcp2515_filter_t *filter_p;
+    int i;
+
+    if (self_p->filters.length == 0) {
+        return (1);
+    }
+
+    for (i = 0; i < self_p->filters.length; i++) {
+        filter_p = &self_p->filters.filters_p[i];
+
+        if (((frame_p->id ^ filter_p->id) & filter_p->mask) == 0) {
+            return (1);
+        }
+    }
+
+    return (0);
+}
+
+/**
+ * Write given standard frame id to given SIDH and SIDL registers.
+ */
+static int register_write_sid(struct mcp2515_driver_t *self_p,
+                              uint8_t addr,
+                              uint32_t id)
+{
+    if (register_write(self_p, addr, (id >> 3) & 0xff) != 0) {
+        return (-1);
+    }
+
+    return (register_write(self_p, addr + 1, (id & 0x7) << 5));
+}
+
+/**
+ * Configure both receive buffers with the driver acceptance filters,
+ * or to accept any frame. Receive buffer 0 rolls over to receive
+ * buffer 1 when full.
+ */
+static int configure_filters(struct mcp2515_driver_t *self_p)
+{
+    static const uint8_t filters[] = {
+        REG_RXF0SIDH, REG_RXF1SIDH, REG_RXF2SIDH,
+        REG_RXF3SIDH, REG_RXF4SIDH, REG_RXF5SIDH
+    };
+    const struct mcp2515_filter_t *filters_p;
+    uint32_t mask;
+    uint8_t rxm;
+    int i;
+
+    filters_p = self_p->filters.filters_p;
+
+    if (self_p->filters.length == 0) {
+        rxm = REG_RXBNCTRL_RXM_ANY;
+    } else {
+        rxm = REG_RXBNCTRL_RXM_FILTERS;
+
+        /* All filters share one mask. */
+        mask = filters_p[0].mask;
+
+        for (i = 1; i < self_p->filters.length; i++) {
+            mask &= filters_p[i].mask;
+        }
+
+        if (register_write_sid(self_p, REG_RXM0SIDH, mask) != 0) {
+            return (-1);
+        }
+
+        if (register_write_sid(self_p, REG_RXM1SIDH, mask) != 0) {
+            return (-1);
+        }
+
+        /* Repeat the filters to fill all filter registers. */
+        for (i = 0; i < membersof(filters); i++) {
+            if (register_write_sid(
+                    self_p,
+                    filters[i],
+                    filters_p[i % self_p->filters.length].id) != 0) {
+                return (-1);
+            }
+        }
+    }
+
+    if (register_write_bits(self_p,
+                            REG_RXB0CTRL,
+                            REG_RXBNCTRL_RXM_MASK | REG_RXB0CTRL_BUKT,
+                            rxm | REG_RXB0CTRL_BUKT) != 0) {
+        return (-1);
+    }
+
+    return (register_write_bits(self_p,
+                                REG_RXB1CTRL,
+                                REG_RXBNCTRL_RXM_MASK,
+                                rxm));
+}
+
+/**
+ * Read the frame in given receive buffer with the READ RX BUFFER
+ * instruction, which also clears its interrupt flag.
+ */
+static int read_rx_buffer(struct mcp2515_driver_t *self_p,
+                          int index,
+                          struct mcp2515_frame_t *frame_p)
+{
+    struct spi_rx_frame_t spi_frame;
+    struct time_t uptime;
+    ssize_t res;
+
+    sys_uptime(&uptime);
+
+    spi_frame.instr = (SPI_INSTR_READ_RX_BUFFER | (index << 2));
+
+    spi_take_bus(&self_p->spi);
+    spi_select(&self_p->spi);
+
+    res = spi_transfer(&self_p->spi,
+                       &spi_frame,
+                       &spi_frame,
+                       sizeof(spi_frame));
+
+    if (res == sizeof(spi_frame)) {
+        frame_p->size = MIN(spi_frame.header.dlc, 8);
+
+        if (frame_p->size > 0) {
+            res = spi_read(&self_p->spi, &frame_p->data[0], frame_p->size);
+
+            if (res == frame_p->size) {
+                res = sizeof(spi_frame);
+            }
+        }
+    }
+
+    spi_deselect(&self_p->spi);
+    spi_give_bus(&self_p->spi);
+
+    if (res != sizeof(spi_frame)) {
+        return (-1);
+    }
+
+    frame_p->id = ((spi_frame.header.id_10_3 << 3) | spi_frame.header.id_2_0);
+    frame_p->rtr = spi_frame.header.srr;
+    frame_p->timestamp = ((uint32_t)uptime.seconds * 1000000
+                          + (uint32_t)uptime.nanoseconds / 1000);
+
+    return (0);
+}
+
 static void *isr_main(void *arg_p)
 {
     struct mcp2515_driver_t *self_p = arg_p;
     struct mcp2515_frame_t frame;
-    struct spi_frame_t spi_frame;
     uint8_t status;
+    uint8_t intf;
+    int i;
 
     thrd_set_name("mcp2515");
 
@@ -386,50 +679,70 @@ static void *isr_main(void *arg_p)
         /* Wait for signal from interrupt handler. */
         sem_take(&self_p->isr_sem, NULL);
 
-        /* Read status flags. */
-        if (read_status(self_p, &status) != 0) {
-            continue;
-        }
+        /* The interrupt is edge triggered, handle all events until
+           the INT pin is released. */
+        while (1) {
+            /* Read status flags. */
+            if (read_status(self_p, &status) != 0) {
+                break;
+            }
 
-        /* Handle RX frame available event. */
-        if (status & SPI_READ_STATUS_RX0IF) {
-            /* Read frame to temporary buffer. */
-            spi_frame.instr = SPI_INSTR_READ_RX_BUFFER;
-
-            spi_take_bus(&self_p->spi);
-            spi_select(&self_p->spi);
-            spi_transfer(&self_p->spi, &spi_frame, &spi_frame, sizeof(spi_frame));
-            spi_deselect(&self_p->spi);
-            spi_give_bus(&self_p->spi);
-
-            /* Create the driver frame. */
-            frame.id = ((spi_frame.id_10_3 << 3) | spi_frame.id_2_0);
-            frame.size = spi_frame.dlc;
-            frame.rtr = spi_frame.rtr;
-            memcpy(frame.data, spi_frame.data, frame.size);
-
-            /* Write the frame to the input channel. */
-            if (chan_write(self_p->chin_p, &frame, sizeof(frame)) != sizeof(frame)) {
-                PRINT_FILE_LINE();
+            if ((status & (SPI_READ_STATUS_RX0IF
+                           | SPI_READ_STATUS_RX1IF
+                           | SPI_READ_STATUS_TX0IF
+                           | SPI_READ_STATUS_TX1IF
+                           | SPI_READ_STATUS_TX2IF)) == 0) {
+                break;
             }
 
-            /* Read status flags. */
-            if (read_status(self_p, &status) != 0) {
-                continue;
+            /* Handle RX frame available events. Receive buffer 0
+               holds the oldest frame when both are full. */
+            for (i = 0; i < 2; i++) {
+                if ((status & (SPI_READ_STATUS_RX0IF << i)) == 0) {
+                    continue;
+                }
+
+                if (read_rx_buffer(self_p, i, &frame) != 0) {
+                    continue;
+                }
+
+                /* Write the frame to the input channel. */
+                if (is_frame_accepted(self_p, &frame)) {
+                    if (chan_write(self_p->chin_p,
+                                   &frame,
+                                   sizeof(frame)) != sizeof(frame)) {
+                        PRINT_FILE_LINE();
+                    }
+                }
+            }
+
+            /* Handle TX complete events. Clear the interrupt flags
+               to allow another transmission. */
+            intf = 0;
+
+            if (status & SPI_READ_STATUS_TX0IF) {
+                intf |= REG_CANINTF_TX0IF;
+            }
+
+            if (status & SPI_READ_STATUS_TX1IF) {
+                intf |= REG_CANINTF_TX1IF;
+            }
+
+            if (status & SPI_READ_STATUS_TX2IF) {
+                intf |= REG_CANINTF_TX2IF;
             }
-        }
 
-        /* Handle TX complete event. */
-        if (status & SPI_READ_STATUS_TX0IF) {
-            /* Clear the tx complete interrupt bit to allow aonther
-             * transmission. */
-            if (register_write_bits(self_p,
-                                    REG_CANINTF,
-                                    REG_CANINTF_TX0IF,
-                                    0) != 0) {
-                std_printf(FSTR("failed to clear tx interrupt flag\r\n"));
+            if (intf != 0) {
+                if (register_modify_bits(self_p, REG_CANINTF, intf, 0) != 0) {
+                    std_printf(FSTR("failed to clear tx interrupt flags\r\n"));
+                    break;
+                }
+
+                tx_buffers_free(self_p,
+                                (((intf & REG_CANINTF_TX0IF) ? 0x1 : 0)
+                                 | ((intf & REG_CANINTF_TX1IF) ? 0x2 : 0)
+                                 | ((intf & REG_CANINTF_TX2IF) ? 0x4 : 0)));
             }
-            sem_give(&self_p->tx_sem, 1);
         }
     }
 
@@ -453,9 +766,14 @@ int mcp2515_init(struct mcp2515_driver_t *self_p,
     self_p->mode = mode;
     self_p->speed = speed;
     self_p->chin_p = chin_p;
+    self_p->filters.filters_p = NULL;
+    self_p->filters.length = 0;
 
     sem_init(&self_p->isr_sem, 1, 1);
-    sem_init(&self_p->tx_sem, 0, 1);
+    sem_init(&self_p->tx.sem, TX_BUFFERS_MAX, TX_BUFFERS_MAX);
+    mutex_init(&self_p->tx.mutex);
+    self_p->tx.pending = 0;
+    self_p->tx.priority = TX_PRIORITY_MAX;
 
     exti_init(&self_p->exti,
               exti_p,
@@ -467,7 +785,7 @@ int mcp2515_init(struct mcp2515_driver_t *self_p,
              spi_p,
              cs_p,
              SPI_MODE_MASTER,
-             SPI_SPEED_1MBPS,
+             CONFIG_MCP2515_SPI_SPEED,
              0,
              0);
 
@@ -485,6 +803,24 @@ int mcp2515_init(struct mcp2515_driver_t *self_p,
     return (0);
 }
 
+int mcp2515_set_filters(struct mcp2515_driver_t *self_p,
+                        const struct mcp2515_filter_t *filters_p,
+                        int length)
+{
+    ASSERTN(self_p != NULL, EINVAL);
+    ASSERTN((filters_p != NULL) || (length == 0), EINVAL);
+    ASSERTN(length >= 0, EINVAL);
+
+    if (length > MCP2515_FILTERS_MAX) {
+        return (-EINVAL);
+    }
+
+    self_p->filters.filters_p = filters_p;
+    self_p->filters.length = length;
+
+    return (0);
+}
+
 int mcp2515_start(struct mcp2515_driver_t *self_p)
 {
     ASSERTN(self_p != NULL, EINVAL);
@@ -536,13 +872,19 @@ int mcp2515_start(struct mcp2515_driver_t *self_p)
         return (-1);
     }
 
-    /* Always use RX mailbox 0. */
-    if (register_write(self_p, REG_RXB0CTRL, REG_RXBNCTRL_RXM_ANY) != 0) {
-        std_printf(FSTR("failed to write rxb0ctrl\r\n"));
+    /* Use both RX mailboxes. */
+    if (configure_filters(self_p) != 0) {
+        std_printf(FSTR("failed to configure rx mailboxes\r\n"));
         return (-1);
     }
 
-    if (register_write(self_p, REG_CANINTE, REG_CANINTE_TX0IE) != 0) {
+    if (register_write(self_p,
+                       REG_CANINTE,
+                       (REG_CANINTE_TX2IE
+                        | REG_CANINTE_TX1IE
+                        | REG_CANINTE_TX0IE
+                        | REG_CANINTE_RX1IE
+                        | REG_CANINTE_RX0IE)) != 0) {
         std_printf(FSTR("failed to write caninte\r\n"));
         return (-1);
     }
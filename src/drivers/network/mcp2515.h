@@ -39,15 +39,26 @@
 #define MCP2515_MODE_NORMAL       0x00
 #define MCP2515_MODE_LOOPBACK     0x40
 
+/* Number of acceptance filters. */
+#define MCP2515_FILTERS_MAX         2
+
 /**/
 struct mcp2515_frame_t {
     uint32_t id;        /* Frame ID. */
     int size;           /* Number of bytes in data array. */
     int rtr;            /* Remote transmission request. */
-    uint32_t timestamp; /* Receive timestamp. */
+    uint32_t timestamp; /* Receive timestamp in microseconds since
+                           startup. */
     uint8_t data[8];    /* Payload. */
 };
 
+/* An acceptance filter. A frame is accepted if all bits set in the
+   mask are equal in the frame and filter ids. */
+struct mcp2515_filter_t {
+    uint32_t id;        /* Frame ID to match. */
+    uint32_t mask;      /* Frame ID bits to compare. */
+};
+
 /* Driver data structure. */
 struct mcp2515_driver_t {
     struct spi_driver_t spi;
@@ -57,7 +68,16 @@ struct mcp2515_driver_t {
     struct chan_t chout;
     struct chan_t *chin_p;
     struct sem_t isr_sem;
-    struct sem_t tx_sem;
+    struct {
+        struct mutex_t mutex;
+        struct sem_t sem;
+        int pending;
+        int priority;
+    } tx;
+    struct {
+        const struct mcp2515_filter_t *filters_p;
+        int length;
+    } filters;
     THRD_STACK(stack, 1024);
 };
 
@@ -83,6 +103,28 @@ int mcp2515_init(struct mcp2515_driver_t *self_p,
                  int mode,
                  int speed);
 
+/**
+ * Set the acceptance filters of given driver object. Must be called
+ * before `mcp2515_start()`. All frames are accepted if no filters are
+ * set, which is the default.
+ *
+ * The filters are programmed into both receive buffers, sharing one
+ * mask with the bits common to all filter masks. Frames passing the
+ * hardware filters are matched exactly in software.
+ *
+ * @param[in] self_p Initialized driver object.
+ * @param[in] filters_p Array of filters. Must be valid as long as the
+ *                      driver is started.
+ * @param[in] length Number of filters, at most
+ *                   ``MCP2515_FILTERS_MAX``, or zero(0) to accept all
+ *                   frames.
+ *
+ * @return zero(0) or negative error code.
+ */
+int mcp2515_set_filters(struct mcp2515_driver_t *self_p,
+                        const struct mcp2515_filter_t *filters_p,
+                        int length);
+
 /**
  * Starts the CAN device using given driver object.
  *
@@ -113,7 +155,9 @@ ssize_t mcp2515_read(struct mcp2515_driver_t *self_p,
                      struct mcp2515_frame_t *frame_p);
 
 /**
- * Write a CAN frame.
+ * Write a CAN frame. The frame is queued in one of the three TX
+ * buffers of the controller, in write order, and this function only
+ * blocks while all TX buffers are busy.
  *
  * @param[in] self_p Initialized driver object.
  * @param[out] frame_p Frame to write.
@@ -83,8 +83,29 @@
 #define REG_SETUP_AW_4BYTES 0x02
 #define REG_SETUP_AW_5BYTES 0x03
 
+/* 500 us retransmit delay, leaving room for a full ack payload, and
+   15 retransmits. */
+#define REG_SETUP_RETR_DEFAULT 0x1f
+
 #define REG_STATUS_RX_DR    0x40
 #define REG_STATUS_TX_DS    0x20
+#define REG_STATUS_MAX_RT   0x10
+#define REG_STATUS_RX_P_NO  0x0e
+
+#define REG_STATUS_IRQ (REG_STATUS_RX_DR        \
+                        | REG_STATUS_TX_DS      \
+                        | REG_STATUS_MAX_RT)
+
+#define REG_FIFO_STATUS_TX_FULL  0x20
+#define REG_FIFO_STATUS_TX_EMPTY 0x10
+#define REG_FIFO_STATUS_RX_EMPTY 0x01
+
+#define REG_FEATURE_EN_DPL     0x04
+#define REG_FEATURE_EN_ACK_PAY 0x02
+
+/* Written by the interrupt thread when a payload has left the TX
+   FIFO. */
+#define EVENT_TX                0x1
 
 static void isr(void *arg_p)
 {
@@ -94,42 +115,269 @@ static void isr(void *arg_p)
     queue_write_isr(&self_p->irqchan, &c, sizeof(c));
 }
 
+/**
+ * Execute given command. The bus must be taken. The status register
+ * is returned.
+ */
+static uint8_t command(struct nrf24l01_driver_t *self_p,
+                       uint8_t *buf_p,
+                       size_t size)
+{
+    spi_select(&self_p->spi);
+    spi_transfer(&self_p->spi, buf_p, buf_p, size);
+    spi_deselect(&self_p->spi);
+
+    return (buf_p[0]);
+}
+
+static uint8_t read_register(struct nrf24l01_driver_t *self_p,
+                             uint8_t reg)
+{
+    uint8_t buf[2];
+
+    buf[0] = (SPI_CMD_R_REGISTER | reg);
+    buf[1] = SPI_CMD_NOP;
+    command(self_p, buf, sizeof(buf));
+
+    return (buf[1]);
+}
+
+static uint8_t write_register(struct nrf24l01_driver_t *self_p,
+                              uint8_t reg,
+                              uint8_t value)
+{
+    uint8_t buf[2];
+
+    buf[0] = (SPI_CMD_W_REGISTER | reg);
+    buf[1] = value;
+
+    return (command(self_p, buf, sizeof(buf)));
+}
+
+static void write_address(struct nrf24l01_driver_t *self_p,
+                          uint8_t reg,
+                          uint32_t address,
+                          uint8_t pipe)
+{
+    uint8_t buf[6];
+
+    buf[0] = (SPI_CMD_W_REGISTER | reg);
+    buf[1] = address >> 24;
+    buf[2] = address >> 16;
+    buf[3] = address >> 8;
+    buf[4] = address;
+    buf[5] = pipe;
+    command(self_p, buf, sizeof(buf));
+}
+
+/**
+ * Write given payload padded to the maximum payload size using given
+ * command. The bus must be taken.
+ */
+static uint8_t write_payload(struct nrf24l01_driver_t *self_p,
+                             uint8_t cmd,
+                             const void *buf_p,
+                             size_t size)
+{
+    uint8_t buf[1 + PAYLOAD_MAX];
+
+    buf[0] = cmd;
+    memcpy(&buf[1], buf_p, size);
+    memset(&buf[1 + size], 0, PAYLOAD_MAX - size);
+
+    return (command(self_p, buf, sizeof(buf)));
+}
+
+/**
+ * Switch between primary receiver and transmitter. CE is left low.
+ * The bus must be taken.
+ */
+static void set_prim_rx(struct nrf24l01_driver_t *self_p,
+                        int prim_rx)
+{
+    uint8_t config;
+
+    pin_write(&self_p->ce, 0);
+
+    if (self_p->prim_rx == prim_rx) {
+        return;
+    }
+
+    config = (REG_CONFIG_EN_CRC | REG_CONFIG_CRCO | REG_CONFIG_PWR_UP);
+
+    if (prim_rx) {
+        config |= REG_CONFIG_PRIM_RX;
+    }
+
+    write_register(self_p, REG_CONFIG, config);
+    self_p->prim_rx = prim_rx;
+}
+
+/**
+ * Read one payload from the RX FIFO. Returns the pipe it was received
+ * on, or -1 if the FIFO is empty.
+ */
+static int read_payload(struct nrf24l01_driver_t *self_p,
+                        uint8_t *buf_p)
+{
+    int pipe;
+    uint8_t size;
+
+    spi_take_bus(&self_p->spi);
+
+    if (read_register(self_p, REG_FIFO_STATUS) & REG_FIFO_STATUS_RX_EMPTY) {
+        spi_give_bus(&self_p->spi);
+
+        return (-1);
+    }
+
+    size = PAYLOAD_MAX;
+
+    if (self_p->auto_ack) {
+        size = read_register(self_p, SPI_CMD_R_RX_PL_WID);
+
+        /* A corrupt width must be flushed according to the datasheet. */
+        if (size > PAYLOAD_MAX) {
+            buf_p[0] = SPI_CMD_FLUSH_RX;
+            command(self_p, buf_p, 1);
+            spi_give_bus(&self_p->spi);
+
+            return (-1);
+        }
+    }
+
+    memset(buf_p, 0, 1 + PAYLOAD_MAX);
+    buf_p[0] = SPI_CMD_R_RX_PAYLOAD;
+    pipe = ((command(self_p, buf_p, 1 + size) & REG_STATUS_RX_P_NO) >> 1);
+
+    spi_give_bus(&self_p->spi);
+
+    return (pipe);
+}
+
+static void handle_rx(struct nrf24l01_driver_t *self_p)
+{
+    int pipe;
+    uint8_t buf[1 + PAYLOAD_MAX];
+    struct queue_t *queue_p;
+
+    /* Empty the RX FIFO. The bus is not held while writing to the
+       queue as it may block. */
+    while (1) {
+        pipe = read_payload(self_p, buf);
+
+        if (pipe < 0) {
+            break;
+        }
+
+        queue_p = NULL;
+
+        if (pipe < membersof(self_p->pipes)) {
+            queue_p = self_p->pipes[pipe];
+        }
+
+        if (queue_p == NULL) {
+            queue_p = &self_p->chin;
+        }
+
+        queue_write(queue_p, &buf[1], PAYLOAD_MAX);
+    }
+}
+
+/**
+ * A payload was sent or retransmitted too many times. The bus must
+ * be taken.
+ */
+static void handle_tx(struct nrf24l01_driver_t *self_p,
+                      uint8_t status)
+{
+    uint8_t cmd;
+    uint32_t mask;
+
+    /* The payload is left in the FIFO and blocks all later payloads,
+       so drop them all. */
+    if (status & REG_STATUS_MAX_RT) {
+        cmd = SPI_CMD_FLUSH_TX;
+        command(self_p, &cmd, sizeof(cmd));
+        self_p->tx.failed = 1;
+    }
+
+    /* Return to the receiver when the FIFO has drained. */
+    if (read_register(self_p, REG_FIFO_STATUS) & REG_FIFO_STATUS_TX_EMPTY) {
+        if (self_p->listening) {
+            set_prim_rx(self_p, 1);
+            pin_write(&self_p->ce, 1);
+        } else {
+            pin_write(&self_p->ce, 0);
+        }
+    }
+
+    mask = EVENT_TX;
+    event_write(&self_p->tx.event, &mask, sizeof(mask));
+}
+
 static void *isr_main(void *arg_p)
 {
     char c;
     struct nrf24l01_driver_t *self_p = arg_p;
     uint8_t status;
-    uint8_t buf[33];
 
     while (1) {
         /* Wait for interrupt. */
         queue_read(&self_p->irqchan, &c, sizeof(c));
 
-        /* Read status. */
-        status = SPI_CMD_NOP;
-        spi_transfer(&self_p->spi, &status, &status, sizeof(status));
+        /* IRQ stays low as long as any flag is set, so no new
+           falling edge is seen until all flags are cleared. */
+        while (1) {
+            spi_take_bus(&self_p->spi);
 
-        /* Handle packet reception. */
-        if (status & REG_STATUS_RX_DR) {
-            buf[0] = SPI_CMD_R_RX_PAYLOAD;
-            spi_transfer(&self_p->spi, buf, buf, sizeof(buf));
-            queue_write(&self_p->chin, &buf[1], 32);
-        }
+            status = read_register(self_p, REG_STATUS);
 
-        /* Handle packet transmission completion. */
-        if (status & REG_STATUS_TX_DS) {
-            thrd_resume(self_p->thrd_p, 0);
-        }
+            if ((status & REG_STATUS_IRQ) == 0) {
+                spi_give_bus(&self_p->spi);
+                break;
+            }
+
+            /* Clear interrupt flags before handling them to not miss
+               new events. */
+            write_register(self_p, REG_STATUS, status & REG_STATUS_IRQ);
+
+            /* Handle packet transmission completion. */
+            if (status & (REG_STATUS_TX_DS | REG_STATUS_MAX_RT)) {
+                handle_tx(self_p, status);
+            }
+
+            spi_give_bus(&self_p->spi);
 
-        /* Clear interrupt flags. */
-        buf[0] = (SPI_CMD_W_REGISTER | REG_STATUS);
-        buf[1] = (REG_STATUS_RX_DR | REG_STATUS_TX_DS);
-        spi_write(&self_p->spi, buf, 2);
+            /* Handle packet reception, including ack payloads. */
+            if (status & REG_STATUS_RX_DR) {
+                handle_rx(self_p);
+            }
+        }
     }
 
     return (NULL);
 }
 
+/**
+ * Enter RX mode and return to it every time the TX FIFO has drained.
+ */
+static int listen(struct nrf24l01_driver_t *self_p)
+{
+    spi_take_bus(&self_p->spi);
+
+    self_p->listening = 1;
+
+    if (read_register(self_p, REG_FIFO_STATUS) & REG_FIFO_STATUS_TX_EMPTY) {
+        set_prim_rx(self_p, 1);
+        pin_write(&self_p->ce, 1);
+    }
+
+    spi_give_bus(&self_p->spi);
+
+    return (0);
+}
+
 int nrf24l01_module_init(void)
 {
     return (0);
@@ -148,10 +396,23 @@ int nrf24l01_init(struct nrf24l01_driver_t *self_p,
     ASSERTN(ce_p != NULL, EINVAL);
     ASSERTN(exti_p != NULL, EINVAL);
 
+    int i;
+
     self_p->address = address;
+    self_p->auto_ack = 0;
+    self_p->prim_rx = -1;
+    self_p->listening = 0;
+    self_p->tx.address = address;
+    self_p->tx.pipe = 0xff;
+    self_p->tx.failed = 0;
+
+    for (i = 0; i < membersof(self_p->pipes); i++) {
+        self_p->pipes[i] = NULL;
+    }
 
     queue_init(&self_p->irqchan, self_p->irqbuf, sizeof(self_p->irqbuf));
     queue_init(&self_p->chin, self_p->chinbuf, sizeof(self_p->chinbuf));
+    event_init(&self_p->tx.event);
 
     thrd_spawn(isr_main,
                self_p,
@@ -179,82 +440,93 @@ int nrf24l01_init(struct nrf24l01_driver_t *self_p,
     return (0);
 }
 
+int nrf24l01_set_auto_ack(struct nrf24l01_driver_t *self_p,
+                          int enable)
+{
+    ASSERTN(self_p != NULL, EINVAL);
+
+    self_p->auto_ack = (enable != 0);
+
+    return (0);
+}
+
+int nrf24l01_set_pipe_queue(struct nrf24l01_driver_t *self_p,
+                            int pipe,
+                            struct queue_t *queue_p)
+{
+    ASSERTN(self_p != NULL, EINVAL);
+    ASSERTN((pipe >= 0) && (pipe < membersof(self_p->pipes)), EINVAL);
+
+    sys_lock();
+    self_p->pipes[pipe] = queue_p;
+    sys_unlock();
+
+    return (0);
+}
+
 int nrf24l01_start(struct nrf24l01_driver_t *self_p)
 {
     ASSERTN(self_p != NULL, EINVAL);
 
-    uint8_t buf[6];
+    uint8_t cmd;
     int i;
 
     spi_start(&self_p->spi);
     spi_take_bus(&self_p->spi);
-    spi_select(&self_p->spi);
-
-    /* Use 4 bytes address. */
-    buf[0] = (SPI_CMD_W_REGISTER | REG_SETUP_AW);
-    buf[1] = REG_SETUP_AW_5BYTES;
-    spi_write(&self_p->spi, buf, 2);
 
-    /* Disable acknoledgements. */
-    buf[0] = (SPI_CMD_W_REGISTER | REG_EN_AA);
-    buf[1] = 0;
-    spi_write(&self_p->spi, buf, 2);
+    /* Use 5 bytes address. */
+    write_register(self_p, REG_SETUP_AW, REG_SETUP_AW_5BYTES);
+
+    if (self_p->auto_ack) {
+        /* Enhanced ShockBurst with acknowledgements, retransmits and
+           ack payloads. Ack payloads require dynamic payload
+           length. */
+        write_register(self_p, REG_EN_AA, 0x3f);
+        write_register(self_p, REG_SETUP_RETR, REG_SETUP_RETR_DEFAULT);
+        write_register(self_p,
+                       REG_FEATURE,
+                       REG_FEATURE_EN_DPL | REG_FEATURE_EN_ACK_PAY);
+        write_register(self_p, REG_DYNPD, 0x3f);
+    } else {
+        /* Disable acknoledgements. */
+        write_register(self_p, REG_EN_AA, 0);
+    }
 
     /* Set RX address for pipes. */
     for (i = 0; i < 2; i++) {
-        buf[0] = (SPI_CMD_W_REGISTER | (REG_RX_ADDR_P0 + i));
-        buf[1] = self_p->address >> 24;
-        buf[2] = self_p->address >> 16;
-        buf[3] = self_p->address >> 8;
-        buf[4] = self_p->address;
-        buf[5] = i;
-        spi_write(&self_p->spi, buf, 6);
+        write_address(self_p, REG_RX_ADDR_P0 + i, self_p->address, i);
     }
 
     for (; i < 6; i++) {
         /* Set RX address for pipe. */
-        buf[0] = (SPI_CMD_W_REGISTER |
-                  (REG_RX_ADDR_P0 + i));
-        buf[1] = i;
-        spi_write(&self_p->spi, buf, 2);
+        write_register(self_p, REG_RX_ADDR_P0 + i, i);
     }
 
     /* Receive 32 bytes. */
     for (i = 0; i < 6; i++) {
-        buf[0] = (SPI_CMD_W_REGISTER | (REG_RX_PW_P0 + i));
-        buf[1] = 32;
-        spi_write(&self_p->spi, buf, 2);
+        write_register(self_p, REG_RX_PW_P0 + i, PAYLOAD_MAX);
     }
 
     /* Enable RX pipes. */
-    buf[0] = (SPI_CMD_W_REGISTER | REG_EN_RXADDR);
-    buf[1] = 0x3f;
-    spi_write(&self_p->spi, buf, 2);
+    write_register(self_p, REG_EN_RXADDR, 0x3f);
 
     /* Power up. */
     pin_write(&self_p->ce, 0);
-
-    buf[0] = (SPI_CMD_W_REGISTER | REG_CONFIG);
-    buf[1] = (REG_CONFIG_EN_CRC |
-              REG_CONFIG_CRCO |
-              REG_CONFIG_PWR_UP);
-    spi_write(&self_p->spi, buf, 2);
+    self_p->prim_rx = -1;
+    set_prim_rx(self_p, 0);
 
     time_busy_wait_us(3000);
 
     /* Clear status flags. */
-    buf[0] = (SPI_CMD_W_REGISTER | REG_STATUS);
-    buf[1] = (REG_STATUS_RX_DR | REG_STATUS_TX_DS);
-    spi_write(&self_p->spi, buf, 2);
+    write_register(self_p, REG_STATUS, REG_STATUS_IRQ);
 
     /* Flush TX and RX fifos. */
-    buf[0] = SPI_CMD_FLUSH_TX;
-    spi_write(&self_p->spi, buf, 1);
+    cmd = SPI_CMD_FLUSH_TX;
+    command(self_p, &cmd, sizeof(cmd));
 
-    buf[0] = SPI_CMD_FLUSH_RX;
-    spi_write(&self_p->spi, buf, 1);
+    cmd = SPI_CMD_FLUSH_RX;
+    command(self_p, &cmd, sizeof(cmd));
 
-    spi_deselect(&self_p->spi);
     spi_give_bus(&self_p->spi);
 
     return (0);
@@ -275,31 +547,22 @@ ssize_t nrf24l01_read(struct nrf24l01_driver_t *self_p,
     ASSERTN(buf_p != NULL, EINVAL);
     ASSERTN(size > 0, EINVAL);
 
-    uint8_t buf[2];
-
     ASSERT(size == PAYLOAD_MAX);
 
-    spi_take_bus(&self_p->spi);
-    spi_select(&self_p->spi);
-
-    /* Setup RX mode. */
-    buf[0] = (SPI_CMD_W_REGISTER | REG_CONFIG);
-    buf[1] = (REG_CONFIG_EN_CRC |
-              REG_CONFIG_CRCO |
-              REG_CONFIG_PWR_UP |
-              REG_CONFIG_PRIM_RX);
-    spi_write(&self_p->spi, buf, sizeof(buf));
-
-    spi_deselect(&self_p->spi);
-    spi_give_bus(&self_p->spi);
-
     /* Activate RX mode. */
-    pin_write(&self_p->ce, 1);
+    listen(self_p);
 
     /* Wait for packet. */
     return (queue_read(&self_p->chin, buf_p, size));
 }
 
+int nrf24l01_listen(struct nrf24l01_driver_t *self_p)
+{
+    ASSERTN(self_p != NULL, EINVAL);
+
+    return (listen(self_p));
+}
+
 ssize_t nrf24l01_write(struct nrf24l01_driver_t *self_p,
                        uint32_t address,
                        uint8_t pipe,
@@ -310,39 +573,134 @@ ssize_t nrf24l01_write(struct nrf24l01_driver_t *self_p,
     ASSERTN(buf_p != NULL, EINVAL);
     ASSERTN(size > 0, EINVAL);
 
-    uint8_t buf[33];
+    ssize_t res;
 
-    ASSERT(size == PAYLOAD_MAX);
+    res = nrf24l01_write_async(self_p, address, pipe, buf_p, size);
 
-    spi_take_bus(&self_p->spi);
-    spi_select(&self_p->spi);
+    if (res < 0) {
+        return (res);
+    }
 
-    /* Set TX address. */
-    buf[0] = (SPI_CMD_W_REGISTER | REG_TX_ADDR);
-    buf[1] = address >> 24;
-    buf[2] = address >> 16;
-    buf[3] = address >> 8;
-    buf[4] = address;
-    buf[5] = pipe;
-    spi_write(&self_p->spi, buf, 6);
+    res = nrf24l01_flush(self_p);
 
-    /* Write payload. */
-    buf[0] = SPI_CMD_W_TX_PAYLOAD;
-    memcpy(&buf[1], buf_p, size);
-    spi_write(&self_p->spi, buf, 33);
+    if (res != 0) {
+        return (res);
+    }
 
-    spi_deselect(&self_p->spi);
-    spi_give_bus(&self_p->spi);
+    return (size);
+}
+
+ssize_t nrf24l01_write_async(struct nrf24l01_driver_t *self_p,
+                             uint32_t address,
+                             uint8_t pipe,
+                             const void *buf_p,
+                             size_t size)
+{
+    ASSERTN(self_p != NULL, EINVAL);
+    ASSERTN(buf_p != NULL, EINVAL);
+    ASSERTN(size > 0, EINVAL);
+    ASSERTN(size <= PAYLOAD_MAX, EINVAL);
 
-    self_p->thrd_p = thrd_self();
+    uint32_t mask;
+    uint8_t fifo_status;
+
+    while (1) {
+        spi_take_bus(&self_p->spi);
+
+        fifo_status = read_register(self_p, REG_FIFO_STATUS);
+
+        /* All payloads in the FIFO must have been sent before the
+           address is changed. */
+        if ((address == self_p->tx.address) && (pipe == self_p->tx.pipe)) {
+            if ((fifo_status & REG_FIFO_STATUS_TX_FULL) == 0) {
+                break;
+            }
+        } else if (fifo_status & REG_FIFO_STATUS_TX_EMPTY) {
+            write_address(self_p, REG_TX_ADDR, address, pipe);
+
+            /* Acknowledgements are received on pipe 0. */
+            if (self_p->auto_ack) {
+                write_address(self_p, REG_RX_ADDR_P0, address, pipe);
+            }
+
+            self_p->tx.address = address;
+            self_p->tx.pipe = pipe;
+            break;
+        }
 
-    /* Pulse CE high to start transmission. */
+        spi_give_bus(&self_p->spi);
+
+        /* Wait for a payload to leave the FIFO. */
+        mask = EVENT_TX;
+        event_read(&self_p->tx.event, &mask, sizeof(mask));
+    }
+
+    /* Leave RX mode. */
+    if (self_p->prim_rx != 0) {
+        set_prim_rx(self_p, 0);
+    }
+
+    write_payload(self_p, SPI_CMD_W_TX_PAYLOAD, buf_p, size);
+
+    /* CE is kept high to send all payloads in the FIFO back to
+       back. */
     pin_write(&self_p->ce, 1);
-    time_busy_wait_us(15);
-    pin_write(&self_p->ce, 0);
 
-    /* Wait for completion. */
-    thrd_suspend(NULL);
+    spi_give_bus(&self_p->spi);
+
+    return (size);
+}
+
+int nrf24l01_flush(struct nrf24l01_driver_t *self_p)
+{
+    ASSERTN(self_p != NULL, EINVAL);
+
+    int res;
+    uint32_t mask;
+
+    while (1) {
+        spi_take_bus(&self_p->spi);
+
+        if (read_register(self_p, REG_FIFO_STATUS) & REG_FIFO_STATUS_TX_EMPTY) {
+            break;
+        }
+
+        spi_give_bus(&self_p->spi);
+
+        mask = EVENT_TX;
+        event_read(&self_p->tx.event, &mask, sizeof(mask));
+    }
+
+    res = 0;
+
+    if (self_p->tx.failed) {
+        self_p->tx.failed = 0;
+        res = -EIO;
+    }
+
+    spi_give_bus(&self_p->spi);
+
+    return (res);
+}
+
+ssize_t nrf24l01_write_ack_payload(struct nrf24l01_driver_t *self_p,
+                                   int pipe,
+                                   const void *buf_p,
+                                   size_t size)
+{
+    ASSERTN(self_p != NULL, EINVAL);
+    ASSERTN((pipe >= 0) && (pipe < membersof(self_p->pipes)), EINVAL);
+    ASSERTN(buf_p != NULL, EINVAL);
+    ASSERTN(size > 0, EINVAL);
+    ASSERTN(size <= PAYLOAD_MAX, EINVAL);
+
+    if (!self_p->auto_ack) {
+        return (-ENOSYS);
+    }
+
+    spi_take_bus(&self_p->spi);
+    write_payload(self_p, SPI_CMD_W_ACK_PAYLOAD | pipe, buf_p, size);
+    spi_give_bus(&self_p->spi);
 
     return (size);
 }
@@ -37,8 +37,17 @@ struct nrf24l01_driver_t {
     struct pin_driver_t ce;
     struct queue_t irqchan;
     struct queue_t chin;
-    struct thrd_t *thrd_p;
+    struct queue_t *pipes[6];
+    struct {
+        struct event_t event;
+        uint32_t address;
+        uint8_t pipe;
+        int8_t failed;
+    } tx;
     uint32_t address;
+    int8_t auto_ack;
+    int8_t prim_rx;
+    int8_t listening;
     char irqbuf[8];
     char chinbuf[32];
     char stack[256];
@@ -75,6 +84,40 @@ int nrf24l01_init(struct nrf24l01_driver_t *self_p,
                   struct exti_device_t *exti_p,
                   uint32_t address);
 
+/**
+ * Enable or disable Enhanced ShockBurst acknowledgements, automatic
+ * retransmits and ack payloads. Disabled by default. Must be called
+ * before `nrf24l01_start()`, and both ends of a link must use the
+ * same setting.
+ *
+ * When enabled, pipe 0 receives the acknowledgements, and any ack
+ * payloads, for the current TX address, and can not be used to
+ * receive packets from other devices.
+ *
+ * @param[in] self_p Initialized driver object.
+ * @param[in] enable true(1) to enable, false(0) to disable.
+ *
+ * @return zero(0) or negative error code.
+ */
+int nrf24l01_set_auto_ack(struct nrf24l01_driver_t *self_p,
+                          int enable);
+
+/**
+ * Let packets received on given pipe be written to given queue
+ * instead of the driver input queue read by `nrf24l01_read()`. Each
+ * packet is written as 32 bytes.
+ *
+ * @param[in] self_p Initialized driver object.
+ * @param[in] pipe Pipe 0 through 5.
+ * @param[in] queue_p Initialized queue, or NULL to use the driver
+ *                    input queue again.
+ *
+ * @return zero(0) or negative error code.
+ */
+int nrf24l01_set_pipe_queue(struct nrf24l01_driver_t *self_p,
+                            int pipe,
+                            struct queue_t *queue_p);
+
 /**
  * Starts the NRF24L01 device using given driver object.
  *
@@ -107,15 +150,29 @@ ssize_t nrf24l01_read(struct nrf24l01_driver_t *self_p,
                       size_t size);
 
 /**
- * Write data to the NRF24L01 device.
+ * Enter RX mode without waiting for a packet. The device returns to
+ * RX mode every time the TX FIFO has drained. Read packets from the
+ * pipe queues or with `nrf24l01_read()`.
+ *
+ * @param[in] self_p Initialized driver object.
+ *
+ * @return zero(0) or negative error code.
+ */
+int nrf24l01_listen(struct nrf24l01_driver_t *self_p);
+
+/**
+ * Write data to the NRF24L01 device and wait for it to be sent.
  *
  * @param[in] self_p Initialized driver object.
  * @param[in] address 4 MSB:s of TX address.
  * @param[in] pipe LSB of TX address.
  * @param[in] buf_p Buffer to write.
- * @param[in] size Number of bytes to write (must be 32).
+ * @param[in] size Number of bytes to write, at most 32. Shorter
+ *                 payloads are padded with zeros.
  *
- * @return number of sent bytes or negative error code.
+ * @return number of sent bytes, -EIO if acknowledgements are enabled
+ *         and any payload was not acknowledged, or other negative
+ *         error code.
  */
 ssize_t nrf24l01_write(struct nrf24l01_driver_t *self_p,
                        uint32_t address,
@@ -123,4 +180,63 @@ ssize_t nrf24l01_write(struct nrf24l01_driver_t *self_p,
                        const void *buf_p,
                        size_t size);
 
+/**
+ * Write data to the TX FIFO of the NRF24L01 device without waiting
+ * for it to be sent. Only waits if the three entries deep FIFO is
+ * full, or for the FIFO to drain if the address differs from the
+ * previous write. Payloads are sent back to back as long as the FIFO
+ * is kept filled. Call `nrf24l01_flush()` to wait for all payloads
+ * to be sent.
+ *
+ * @param[in] self_p Initialized driver object.
+ * @param[in] address 4 MSB:s of TX address.
+ * @param[in] pipe LSB of TX address.
+ * @param[in] buf_p Buffer to write.
+ * @param[in] size Number of bytes to write, at most 32. Shorter
+ *                 payloads are padded with zeros.
+ *
+ * @return number of written bytes or negative error code.
+ */
+ssize_t nrf24l01_write_async(struct nrf24l01_driver_t *self_p,
+                             uint32_t address,
+                             uint8_t pipe,
+                             const void *buf_p,
+                             size_t size);
+
+/**
+ * Wait for all payloads written with `nrf24l01_write_async()` to be
+ * sent.
+ *
+ * A payload that is not acknowledged after all retransmits is
+ * dropped together with all payloads after it in the FIFO.
+ *
+ * @param[in] self_p Initialized driver object.
+ *
+ * @return zero(0), -EIO if any payload was dropped since the
+ *         previous flush, or other negative error code.
+ */
+int nrf24l01_flush(struct nrf24l01_driver_t *self_p);
+
+/**
+ * Write a payload to be sent to the transmitter together with the
+ * acknowledgement of the next packet received on given pipe. Up to
+ * three ack payloads can be pending. Requires acknowledgements to be
+ * enabled, see `nrf24l01_set_auto_ack()`.
+ *
+ * The transmitter receives ack payloads on its pipe 0.
+ *
+ * @param[in] self_p Initialized driver object.
+ * @param[in] pipe Pipe 0 through 5.
+ * @param[in] buf_p Buffer to write.
+ * @param[in] size Number of bytes to write, at most 32. Shorter
+ *                 payloads are padded with zeros.
+ *
+ * @return number of written bytes, -ENOSYS if acknowledgements are
+ *         disabled, or other negative error code.
+ */
+ssize_t nrf24l01_write_ack_payload(struct nrf24l01_driver_t *self_p,
+                                   int pipe,
+                                   const void *buf_p,
+                                   size_t size);
+
 #endif
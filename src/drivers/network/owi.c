@@ -53,20 +53,23 @@ int owi_reset(struct owi_driver_t *self_p)
 {
     ASSERTN(self_p != NULL, EINVAL);
 
+    const struct pin_device_t *dev_p;
     int attempts = 5;
     int err;
 
+    dev_p = self_p->pin.dev_p;
+
     do {
-        pin_write(&self_p->pin, 0);
+        pin_device_write_low(dev_p);
         time_busy_wait_us(480);
         sys_lock();
-        pin_write(&self_p->pin, 1);
-        pin_set_mode(&self_p->pin, PIN_INPUT);
+        pin_device_write_high(dev_p);
+        pin_device_set_mode(dev_p, PIN_INPUT);
         time_busy_wait_us(70);
-        err = pin_read(&self_p->pin);
+        err = pin_device_read(dev_p);
         sys_unlock();
         time_busy_wait_us(410);
-        pin_set_mode(&self_p->pin, PIN_OUTPUT);
+        pin_device_set_mode(dev_p, PIN_OUTPUT);
     } while ((--attempts > 0) && (err != 0));
 
     return (err == 0);
@@ -164,21 +167,24 @@ ssize_t owi_read(struct owi_driver_t *self_p,
     ASSERTN(buf_p != NULL, EINVAL);
     ASSERTN(size > 0, EINVAL);
 
+    const struct pin_device_t *dev_p;
     uint8_t *b_p = buf_p;
     int i;
 
+    dev_p = self_p->pin.dev_p;
+
     for (i = 0; i < size; i++) {
         sys_lock();
-        pin_write(&self_p->pin, 0);
+        pin_device_write_low(dev_p);
         time_busy_wait_us(5);
-        pin_set_mode(&self_p->pin, PIN_INPUT);
+        pin_device_set_mode(dev_p, PIN_INPUT);
         time_busy_wait_us(9);
         *b_p >>= 1;
-        *b_p |= (pin_read(&self_p->pin) << 7);
+        *b_p |= (pin_device_read(dev_p) << 7);
         sys_unlock();
         time_busy_wait_us(55);
-        pin_set_mode(&self_p->pin, PIN_OUTPUT);
-        pin_write(&self_p->pin, 1);
+        pin_device_set_mode(dev_p, PIN_OUTPUT);
+        pin_device_write_high(dev_p);
 
         if ((i & 0x7) == 0x7) {
             b_p++;
@@ -201,25 +207,28 @@ ssize_t owi_write(struct owi_driver_t *self_p,
     ASSERTN(buf_p != NULL, EINVAL);
     ASSERTN(size > 0, EINVAL);
 
+    const struct pin_device_t *dev_p;
     int i;
     uint8_t value = 0;
     const uint8_t *b_p = buf_p;
 
+    dev_p = self_p->pin.dev_p;
+
     for (i = 0; i < size; i++) {
         if ((i & 0x7) == 0) {
             value = *b_p++;
         }
 
         sys_lock();
-        pin_write(&self_p->pin, 0);
+        pin_device_write_low(dev_p);
 
         if (value & 1) {
             time_busy_wait_us(5);
-            pin_write(&self_p->pin, 1);
+            pin_device_write_high(dev_p);
             time_busy_wait_us(64);
         } else {
             time_busy_wait_us(59);
-            pin_write(&self_p->pin, 1);
+            pin_device_write_high(dev_p);
             time_busy_wait_us(10);
         }
 
@@ -34,8 +34,82 @@ struct module_t {
     int8_t initialized;
 };
 
+#if defined(SPI_PORT_HAS_ASYNC)
+
+static void transaction_start_isr(struct spi_device_t *dev_p);
+
+/**
+ * Called by the port when the transaction at the head of the queue
+ * of given device is complete. Starts the next transaction, if any.
+ */
+static void transaction_complete_isr(struct spi_device_t *dev_p,
+                                     ssize_t res)
+{
+    struct spi_transaction_t *transaction_p;
+
+    transaction_p = dev_p->transactions.head_p;
+
+    if (transaction_p == NULL) {
+        return;
+    }
+
+    dev_p->transactions.head_p = transaction_p->next_p;
+
+    if (transaction_p->flags & SPI_TRANSACTION_DESELECT) {
+        pin_write(&transaction_p->drv_p->ss, 1);
+    }
+
+    transaction_p->res = res;
+    transaction_p->done = 1;
+
+    if (transaction_p->callback != NULL) {
+        transaction_p->callback(transaction_p->arg_p, res);
+    }
+
+    if (transaction_p->thrd_p != NULL) {
+        thrd_resume_isr(transaction_p->thrd_p, 0);
+    }
+
+    if (dev_p->transactions.head_p != NULL) {
+        transaction_start_isr(dev_p);
+    }
+}
+
+#endif
+
 #include "spi_port.i"
 
+#if defined(SPI_PORT_HAS_ASYNC)
+
+/**
+ * Start the transaction at the head of the queue of given device.
+ */
+static void transaction_start_isr(struct spi_device_t *dev_p)
+{
+    struct spi_transaction_t *transaction_p;
+    struct spi_driver_t *drv_p;
+
+    transaction_p = dev_p->transactions.head_p;
+    drv_p = transaction_p->drv_p;
+
+    /* Reconfigure the hardware if another driver used it last. */
+    if (dev_p->drv_p != drv_p) {
+        dev_p->drv_p = drv_p;
+        spi_port_start(drv_p);
+    }
+
+    if (transaction_p->flags & SPI_TRANSACTION_SELECT) {
+        pin_write(&drv_p->ss, 0);
+    }
+
+    spi_port_transfer_start_isr(drv_p,
+                                transaction_p->rxbuf_p,
+                                transaction_p->txbuf_p,
+                                transaction_p->size);
+}
+
+#endif
+
 static struct module_t module;
 
 int spi_module_init(void)
@@ -106,11 +180,15 @@ int spi_take_bus(struct spi_driver_t *self_p)
 
     mutex_lock(&self_p->dev_p->mutex);
 
-    /* Configure and start SPI hardware with driver configuration. */
+#if !defined(SPI_PORT_HAS_ASYNC)
+    /* Configure and start SPI hardware with driver configuration. The
+       asynchronous ports does it when the first transaction of this
+       driver is started, as the transaction queue may not be empty. */
     if (self_p->dev_p->drv_p != self_p) {
         self_p->dev_p->drv_p = self_p;
         spi_port_start(self_p);
     }
+#endif
 
     return (0);
 }
@@ -147,7 +225,17 @@ ssize_t spi_transfer(struct spi_driver_t *self_p,
     ASSERTN((rxbuf_p != NULL) || (txbuf_p != NULL), EINVAL);
     ASSERTN(size > 0, EINVAL);
 
-    return(spi_port_transfer(self_p, rxbuf_p, txbuf_p, size));
+#if defined(SPI_PORT_HAS_ASYNC)
+    struct spi_transaction_t transaction;
+
+    /* Queue the transfer after any already queued transactions. */
+    spi_transaction_init(&transaction, rxbuf_p, txbuf_p, size, 0);
+    spi_transfer_async(self_p, &transaction);
+
+    return (spi_transaction_wait(&transaction));
+#else
+    return (spi_port_transfer(self_p, rxbuf_p, txbuf_p, size));
+#endif
 }
 
 ssize_t spi_read(struct spi_driver_t *self_p,
@@ -189,4 +277,117 @@ ssize_t spi_put(struct spi_driver_t *self_p,
     return (spi_write(self_p, &data, 1));
 }
 
+int spi_transaction_init(struct spi_transaction_t *self_p,
+                         void *rxbuf_p,
+                         const void *txbuf_p,
+                         size_t size,
+                         int flags)
+{
+    ASSERTN(self_p != NULL, EINVAL);
+    ASSERTN((rxbuf_p != NULL) || (txbuf_p != NULL), EINVAL);
+    ASSERTN(size > 0, EINVAL);
+
+    self_p->drv_p = NULL;
+    self_p->rxbuf_p = rxbuf_p;
+    self_p->txbuf_p = txbuf_p;
+    self_p->size = size;
+    self_p->flags = flags;
+    self_p->callback = NULL;
+    self_p->arg_p = NULL;
+    self_p->res = 0;
+    self_p->done = 1;
+    self_p->thrd_p = NULL;
+    self_p->next_p = NULL;
+
+    return (0);
+}
+
+int spi_transaction_set_callback(struct spi_transaction_t *self_p,
+                                 spi_callback_t callback,
+                                 void *arg_p)
+{
+    ASSERTN(self_p != NULL, EINVAL);
+
+    self_p->callback = callback;
+    self_p->arg_p = arg_p;
+
+    return (0);
+}
+
+int spi_transfer_async(struct spi_driver_t *self_p,
+                       struct spi_transaction_t *transaction_p)
+{
+    ASSERTN(self_p != NULL, EINVAL);
+    ASSERTN(transaction_p != NULL, EINVAL);
+    ASSERTN(transaction_p->done == 1, EBUSY);
+
+    transaction_p->drv_p = self_p;
+    transaction_p->res = 0;
+    transaction_p->done = 0;
+    transaction_p->thrd_p = NULL;
+    transaction_p->next_p = NULL;
+
+#if defined(SPI_PORT_HAS_ASYNC)
+    struct spi_device_t *dev_p;
+
+    dev_p = self_p->dev_p;
+
+    sys_lock();
+
+    if (dev_p->transactions.head_p == NULL) {
+        dev_p->transactions.head_p = transaction_p;
+        dev_p->transactions.tail_p = transaction_p;
+        transaction_start_isr(dev_p);
+    } else {
+        dev_p->transactions.tail_p->next_p = transaction_p;
+        dev_p->transactions.tail_p = transaction_p;
+    }
+
+    sys_unlock();
+#else
+    /* Synchronous fallback. The caller has taken the bus, so the
+       hardware is already configured for this driver. */
+    if (transaction_p->flags & SPI_TRANSACTION_SELECT) {
+        spi_select(self_p);
+    }
+
+    transaction_p->res = spi_port_transfer(self_p,
+                                           transaction_p->rxbuf_p,
+                                           transaction_p->txbuf_p,
+                                           transaction_p->size);
+
+    if (transaction_p->flags & SPI_TRANSACTION_DESELECT) {
+        spi_deselect(self_p);
+    }
+
+    transaction_p->done = 1;
+
+    if (transaction_p->callback != NULL) {
+        transaction_p->callback(transaction_p->arg_p, transaction_p->res);
+    }
+#endif
+
+    return (0);
+}
+
+ssize_t spi_transaction_wait(struct spi_transaction_t *self_p)
+{
+    ASSERTN(self_p != NULL, EINVAL);
+
+    ssize_t res;
+
+    sys_lock();
+
+    if (self_p->done == 0) {
+        self_p->thrd_p = thrd_self();
+        thrd_suspend_isr(NULL);
+    }
+
+    res = self_p->res;
+
+    sys_unlock();
+
+    return (res);
+}
+
 #endif
@@ -45,6 +45,37 @@
 #define SPI_SPEED_250KBPS SPI_PORT_SPEED_250KBPS
 #define SPI_SPEED_125KBPS SPI_PORT_SPEED_125KBPS
 
+/* Transaction flags. */
+#define SPI_TRANSACTION_SELECT                               0x01
+#define SPI_TRANSACTION_DESELECT                             0x02
+
+/**
+ * Transaction completion callback, called from interrupt context on
+ * ports with asynchronous transfers, and from the calling thread
+ * otherwise.
+ *
+ * @param[in] arg_p Callback argument.
+ * @param[in] res Number of transferred bytes or negative error code.
+ */
+typedef void (*spi_callback_t)(void *arg_p, ssize_t res);
+
+/**
+ * A transaction, queued on the bus of its driver.
+ */
+struct spi_transaction_t {
+    struct spi_driver_t *drv_p;
+    void *rxbuf_p;
+    const void *txbuf_p;
+    size_t size;
+    int flags;
+    spi_callback_t callback;
+    void *arg_p;
+    ssize_t res;
+    int done;
+    struct thrd_t *thrd_p;
+    struct spi_transaction_t *next_p;
+};
+
 extern struct spi_device_t spi_device[SPI_DEVICE_MAX];
 
 /**
@@ -198,4 +229,68 @@ ssize_t spi_get(struct spi_driver_t *self_p, uint8_t *data_p);
  */
 ssize_t spi_put(struct spi_driver_t *self_p, uint8_t data);
 
+/**
+ * Initialize given transaction.
+ *
+ * @param[out] self_p Transaction to initialize.
+ * @param[out] rxbuf_p Buffer to read into, or NULL.
+ * @param[in] txbuf_p Buffer to write, or NULL to write 0xff.
+ * @param[in] size Number of bytes to transfer.
+ * @param[in] flags ``SPI_TRANSACTION_SELECT`` to assert the slave
+ *                  select pin before the transfer and
+ *                  ``SPI_TRANSACTION_DESELECT`` to de-assert it
+ *                  after the transfer, or zero(0).
+ *
+ * @return zero(0) or negative error code.
+ */
+int spi_transaction_init(struct spi_transaction_t *self_p,
+                         void *rxbuf_p,
+                         const void *txbuf_p,
+                         size_t size,
+                         int flags);
+
+/**
+ * Set the completion callback of given transaction.
+ *
+ * @param[in] self_p Transaction.
+ * @param[in] callback Callback, or NULL.
+ * @param[in] arg_p Callback argument.
+ *
+ * @return zero(0) or negative error code.
+ */
+int spi_transaction_set_callback(struct spi_transaction_t *self_p,
+                                 spi_callback_t callback,
+                                 void *arg_p);
+
+/**
+ * Queue given transaction on the bus of given driver and return
+ * immediately. Transactions on a bus are performed in the order they
+ * were queued, back-to-back from the transfer complete interrupt,
+ * using DMA when available. The bus is reconfigured between
+ * transactions of different drivers.
+ *
+ * A thread that has taken the bus with `spi_take_bus()` may queue
+ * several transactions and give the bus back before they are
+ * complete. The transaction must be kept until it is complete.
+ *
+ * Ports without asynchronous transfers perform the transaction
+ * before this function returns.
+ *
+ * @param[in] self_p Initialized driver object.
+ * @param[in] transaction_p Transaction to queue.
+ *
+ * @return zero(0) or negative error code.
+ */
+int spi_transfer_async(struct spi_driver_t *self_p,
+                       struct spi_transaction_t *transaction_p);
+
+/**
+ * Wait for given queued transaction to complete.
+ *
+ * @param[in] self_p Transaction.
+ *
+ * @return Number of transferred bytes or negative error code.
+ */
+ssize_t spi_transaction_wait(struct spi_transaction_t *self_p);
+
 #endif
@@ -34,9 +34,188 @@ struct module_t {
     int8_t initialized;
 };
 
+#if defined(UART_PORT_HAS_FLOW_CONTROL)
+static ssize_t rx_write_isr(struct uart_driver_t *self_p,
+                            const void *buf_p,
+                            size_t size);
+#endif
+
 #include "uart_port.h"
 #include "uart_port.i"
 
+#if defined(UART_PORT_HAS_FLOW_CONTROL)
+
+/**
+ * Tell the sender to stop.
+ */
+static void rx_stop_isr(struct uart_driver_t *self_p)
+{
+    struct uart_flow_control_t *flow_control_p;
+
+    flow_control_p = &self_p->flow_control;
+    flow_control_p->rx_stopped = 1;
+
+    if (flow_control_p->mode == UART_FLOW_CONTROL_RTS_CTS) {
+        pin_write(&flow_control_p->rts, 1);
+    } else {
+        uart_port_send_char_isr(self_p, UART_XOFF);
+    }
+}
+
+/**
+ * Tell the sender to resume.
+ */
+static void rx_resume_isr(struct uart_driver_t *self_p)
+{
+    struct uart_flow_control_t *flow_control_p;
+
+    flow_control_p = &self_p->flow_control;
+    flow_control_p->rx_stopped = 0;
+
+    if (flow_control_p->mode == UART_FLOW_CONTROL_RTS_CTS) {
+        pin_write(&flow_control_p->rts, 0);
+    } else {
+        uart_port_send_char_isr(self_p, UART_XON);
+    }
+}
+
+/**
+ * Write received data to the input queue. Called by the port from
+ * interrupt context instead of queue_write_isr().
+ *
+ * @return Number of bytes written to the queue, XON and XOFF
+ *         characters included.
+ */
+static ssize_t rx_write_isr(struct uart_driver_t *self_p,
+                            const void *buf_p,
+                            size_t size)
+{
+    struct uart_flow_control_t *flow_control_p;
+    const uint8_t *u8_p;
+    ssize_t res;
+    size_t i;
+
+    flow_control_p = &self_p->flow_control;
+
+    if (flow_control_p->mode == UART_FLOW_CONTROL_XON_XOFF) {
+        u8_p = buf_p;
+        res = 0;
+
+        for (i = 0; i < size; i++) {
+            if (u8_p[i] == UART_XOFF) {
+                flow_control_p->tx_stopped = 1;
+                uart_port_tx_stop_isr(self_p);
+                res++;
+            } else if (u8_p[i] == UART_XON) {
+                flow_control_p->tx_stopped = 0;
+                uart_port_tx_resume_isr(self_p);
+                res++;
+            } else if (queue_write_isr(&self_p->base, &u8_p[i], 1) == 1) {
+                res++;
+            }
+        }
+    } else {
+        res = queue_write_isr(&self_p->base, buf_p, size);
+    }
+
+    if ((flow_control_p->mode != UART_FLOW_CONTROL_NONE)
+        && (flow_control_p->rx_stopped == 0)
+        && (queue_size(&self_p->base) >= flow_control_p->high)) {
+        rx_stop_isr(self_p);
+    }
+
+    return (res);
+}
+
+static ssize_t read_cb(void *arg_p, void *buf_p, size_t size)
+{
+    struct uart_driver_t *self_p;
+    struct uart_flow_control_t *flow_control_p;
+    size_t used;
+
+    self_p = container_of(arg_p, struct uart_driver_t, base);
+    flow_control_p = &self_p->flow_control;
+
+    /* Resume the sender before reading if the read drains the queue
+       to the low water mark, or the read may wait forever. */
+    sys_lock();
+
+    if (flow_control_p->rx_stopped == 1) {
+        used = queue_size(&self_p->base);
+
+        if ((used <= size) || ((used - size) <= flow_control_p->low)) {
+            rx_resume_isr(self_p);
+        }
+    }
+
+    sys_unlock();
+
+    return (queue_read(&self_p->base, buf_p, size));
+}
+
+#endif
+
+/**
+ * Write given buffer with the driver mutex taken, so writes from
+ * different threads are not interleaved.
+ */
+static ssize_t write_cb(void *arg_p,
+                        const void *buf_p,
+                        size_t size)
+{
+    struct uart_driver_t *self_p;
+    ssize_t res;
+
+    self_p = container_of(arg_p, struct uart_driver_t, base);
+
+    mutex_lock(&self_p->mutex);
+    res = uart_port_write_cb(arg_p, buf_p, size);
+    mutex_unlock(&self_p->mutex);
+
+    return (res);
+}
+
+#if CONFIG_CHAN_WRITEV == 1
+
+/**
+ * Write all buffers with the driver mutex taken once.
+ */
+static ssize_t writev_cb(void *arg_p,
+                         const struct iov_t *iov_p,
+                         size_t length)
+{
+    struct uart_driver_t *self_p;
+    ssize_t res;
+    ssize_t size;
+    size_t i;
+
+    self_p = container_of(arg_p, struct uart_driver_t, base);
+    size = 0;
+
+    mutex_lock(&self_p->mutex);
+
+    for (i = 0; i < length; i++) {
+        if (iov_p[i].size == 0) {
+            continue;
+        }
+
+        res = uart_port_write_cb(arg_p, iov_p[i].buf_p, iov_p[i].size);
+
+        if (res < 0) {
+            size = res;
+            break;
+        }
+
+        size += res;
+    }
+
+    mutex_unlock(&self_p->mutex);
+
+    return (size);
+}
+
+#endif
+
 static struct module_t module;
 
 int uart_module_init(void)
@@ -67,9 +246,18 @@ int uart_init(struct uart_driver_t *self_p,
 
     /* The base channel is used for both TX and RX. */
     queue_init(&self_p->base, rxbuf_p, size);
-    chan_set_write_cb(&self_p->base.base, uart_port_write_cb);
+    chan_set_write_cb(&self_p->base.base, write_cb);
+#if CONFIG_CHAN_WRITEV == 1
+    chan_set_writev_cb(&self_p->base.base, writev_cb);
+#endif
     chan_set_write_isr_cb(&self_p->base.base, uart_port_write_cb_isr);
 
+#if defined(UART_PORT_HAS_FLOW_CONTROL)
+    self_p->flow_control.mode = UART_FLOW_CONTROL_NONE;
+    self_p->flow_control.rx_stopped = 0;
+    self_p->flow_control.tx_stopped = 0;
+#endif
+
     return (0);
 }
 
@@ -77,13 +265,28 @@ int uart_start(struct uart_driver_t *self_p)
 {
     ASSERTN(self_p != NULL, EINVAL);
 
-    return (uart_port_start(self_p));
+    int res;
+
+    res = uart_port_start(self_p);
+
+#if CONFIG_POWER == 1
+    /* The peripheral clock must run while started. */
+    if (res == 0) {
+        power_stay_awake_acquire(POWER_MODE_IDLE);
+    }
+#endif
+
+    return (res);
 }
 
 int uart_stop(struct uart_driver_t *self_p)
 {
     ASSERTN(self_p != NULL, EINVAL);
 
+#if CONFIG_POWER == 1
+    power_stay_awake_release(POWER_MODE_IDLE);
+#endif
+
     return (uart_port_stop(self_p));
 }
 
@@ -96,6 +299,45 @@ int uart_set_frame_format(struct uart_driver_t *self_p, int format)
     return (0);
 }
 
+int uart_set_flow_control(struct uart_driver_t *self_p,
+                          int mode,
+                          struct pin_device_t *rts_pin_p,
+                          size_t high,
+                          size_t low)
+{
+    ASSERTN(self_p != NULL, EINVAL);
+    ASSERTN((mode != UART_FLOW_CONTROL_RTS_CTS) || (rts_pin_p != NULL),
+            EINVAL);
+    ASSERTN(low < high, EINVAL);
+
+#if defined(UART_PORT_HAS_FLOW_CONTROL)
+    struct uart_flow_control_t *flow_control_p;
+
+    flow_control_p = &self_p->flow_control;
+    flow_control_p->mode = mode;
+    flow_control_p->high = high;
+    flow_control_p->low = low;
+    flow_control_p->rx_stopped = 0;
+    flow_control_p->tx_stopped = 0;
+
+    if (mode == UART_FLOW_CONTROL_RTS_CTS) {
+        pin_init(&flow_control_p->rts, rts_pin_p, PIN_OUTPUT);
+        pin_write(&flow_control_p->rts, 0);
+    }
+
+    /* Reads resume the sender. */
+    if (mode == UART_FLOW_CONTROL_NONE) {
+        self_p->base.base.read = (chan_read_fn_t)queue_read;
+    } else {
+        self_p->base.base.read = read_cb;
+    }
+
+    return (0);
+#else
+    return (-ENOSYS);
+#endif
+}
+
 int uart_device_start(struct uart_device_t *dev_p,
                       long baudrate)
 {
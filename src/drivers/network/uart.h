@@ -30,6 +30,28 @@
 #define __DRIVERS_UART_H__
 
 #include "simba.h"
+
+/* Flow control modes. */
+#define UART_FLOW_CONTROL_NONE                                  0
+#define UART_FLOW_CONTROL_RTS_CTS                               1
+#define UART_FLOW_CONTROL_XON_XOFF                              2
+
+/* Software flow control characters. */
+#define UART_XON                                             0x11
+#define UART_XOFF                                            0x13
+
+/**
+ * Flow control state of a driver, on ports with flow control.
+ */
+struct uart_flow_control_t {
+    int mode;
+    size_t high;
+    size_t low;
+    struct pin_driver_t rts;
+    int8_t rx_stopped;                       /* The sender is told to stop. */
+    int8_t tx_stopped;                       /* XOFF received. */
+};
+
 #include "uart_port.h"
 
 /* UART frame formats */
@@ -153,6 +175,36 @@ int uart_stop(struct uart_driver_t *self_p);
  */
 int uart_set_frame_format(struct uart_driver_t *self_p, int format);
 
+/**
+ * Enable flow control with given mode. When the receive queue holds
+ * at least `high` bytes the sender is told to stop, and when a read
+ * drains it to `low` bytes or less the sender is told to resume. In
+ * ``UART_FLOW_CONTROL_RTS_CTS`` mode the RTS pin is driven high to
+ * stop and low to resume, and in ``UART_FLOW_CONTROL_XON_XOFF``
+ * mode ``UART_XOFF`` and ``UART_XON`` are sent. In the latter mode,
+ * received XOFF and XON characters stop and resume transmission, and
+ * are not written to the receive queue.
+ *
+ * This function must be called after `uart_init()` and before
+ * `uart_start()`. Only available on ports defining
+ * ``UART_PORT_HAS_FLOW_CONTROL``.
+ *
+ * @param[in] self_p Initialized driver object.
+ * @param[in] mode Flow control mode, ``UART_FLOW_CONTROL_*``.
+ * @param[in] rts_pin_p RTS output pin in
+ *                      ``UART_FLOW_CONTROL_RTS_CTS`` mode, otherwise
+ *                      NULL.
+ * @param[in] high Receive queue high water mark in bytes.
+ * @param[in] low Receive queue low water mark in bytes.
+ *
+ * @return zero(0) or negative error code.
+ */
+int uart_set_flow_control(struct uart_driver_t *self_p,
+                          int mode,
+                          struct pin_device_t *rts_pin_p,
+                          size_t high,
+                          size_t low);
+
 /**
  * Read data from the UART.
  *
@@ -162,8 +214,8 @@ int uart_set_frame_format(struct uart_driver_t *self_p, int format);
  *
  * @return Number of received bytes or negative error code.
  */
-#define uart_read(self_p, buf_p, size)           \
-    queue_read(&(self_p)->base, buf_p, size)
+#define uart_read(self_p, buf_p, size)                   \
+    (self_p)->base.base.read(&(self_p)->base.base, buf_p, size)
 
 /**
  * Write data to the UART.
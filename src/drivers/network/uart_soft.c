@@ -33,6 +33,35 @@
 /* Convert baud rate to microseconds. */
 #define BAUDRATE2US(baudrate) (1000000L / baudrate)
 
+#if defined(PIN_PORT_HAS_BUSY_WAIT)
+/* Estimated number of CPU cycles spent writing or sampling the pin
+   per bit. */
+#    define BIT_OVERHEAD_CYCLES                            12
+#endif
+
+/**
+ * Wait given fraction of a bit period.
+ */
+static inline void wait_bit(struct uart_soft_driver_t *self_p,
+                            int divider)
+{
+#if defined(PIN_PORT_HAS_BUSY_WAIT)
+    pin_busy_wait(self_p->bit_period / divider);
+#else
+    time_busy_wait_us(self_p->sample_time / divider);
+#endif
+}
+
+static inline void write_bit(struct uart_soft_driver_t *self_p,
+                             int value)
+{
+    if (value != 0) {
+        pin_device_write_high(self_p->tx_pin.dev_p);
+    } else {
+        pin_device_write_low(self_p->tx_pin.dev_p);
+    }
+}
+
 /**
  * The interrupt service routine is called on falling edges. Read a
  * byte and write it on the receive channel.
@@ -45,15 +74,15 @@ static void rx_isr(void *arg_p)
 
     /* Wait half the sample time so following samples are taken in the
        middle of the sample period.*/
-    time_busy_wait_us(self_p->sample_time / 3);
+    wait_bit(self_p, 3);
 
     /* Get 8 bits. */
     for (i = 0; i < 8; i++) {
-        time_busy_wait_us(self_p->sample_time);
+        wait_bit(self_p, 1);
 
         /* Sample the pin. */
         data >>= 1;
-        sample = pin_read(&self_p->rx_pin);
+        sample = pin_device_read(self_p->rx_pin.dev_p);
         data |= (0x80 * sample);
     }
 
@@ -80,20 +109,20 @@ static ssize_t uart_soft_write_cb(void *arg_p,
 
     for (i = 0; i < size; i++) {
         sys_lock();
-        pin_write(&self_p->tx_pin, 0);
+        write_bit(self_p, 0);
 
         /* Put 8 bits on the transmission wire. */
         data = tx_p[i];
 
         for (j = 0; j < 8; j++) {
-            time_busy_wait_us(self_p->sample_time);
-            pin_write(&self_p->tx_pin, data & 1);
+            wait_bit(self_p, 1);
+            write_bit(self_p, data & 1);
             data >>= 1;
         }
 
-        time_busy_wait_us(self_p->sample_time);
-        pin_write(&self_p->tx_pin, 1);
-        time_busy_wait_us(self_p->sample_time);
+        wait_bit(self_p, 1);
+        write_bit(self_p, 1);
+        wait_bit(self_p, 1);
         sys_unlock();
     }
 
@@ -115,6 +144,10 @@ int uart_soft_init(struct uart_soft_driver_t *self_p,
     ASSERTN(rxbuf_p != NULL, EINVAL);
 
     self_p->sample_time = BAUDRATE2US(baudrate);
+#if defined(PIN_PORT_HAS_BUSY_WAIT)
+    self_p->bit_period = PIN_BUSY_WAIT_ITERATIONS(
+        (long)(F_CPU / baudrate) - BIT_OVERHEAD_CYCLES);
+#endif
 
     chan_init(&self_p->chout,
               chan_read_null,
@@ -38,6 +38,9 @@ struct uart_soft_driver_t {
     struct chan_t chout;
     struct queue_t chin;
     int sample_time;
+#if defined(PIN_PORT_HAS_BUSY_WAIT)
+    int bit_period;
+#endif
     int baudrate;
 };
 
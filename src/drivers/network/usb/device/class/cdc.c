@@ -33,6 +33,53 @@
 #define LINE_STATE_DTR              0x01
 #define STAY_IN_BOOT_LOADER_MAGIC 0x7777
 
+/**
+ * Send buffered data to the hardware until the queue is empty or no
+ * endpoint bank is free. Keeps the IN interrupt enabled as long as
+ * there is something left to send.
+ */
+static void output_isr(struct usb_device_class_cdc_driver_t *self_p)
+{
+    ssize_t size;
+    void *buf_p;
+
+    while (1) {
+        size = queue_peek_contiguous_isr(&self_p->tx.queue, &buf_p);
+
+        if (size <= 0) {
+            if (!self_p->tx.zlp_pending) {
+                usb_device_disable_in_isr(self_p->drv_p, self_p->endpoint_out);
+
+                return;
+            }
+
+            /* The host needs a short packet to end the transfer. */
+            if (usb_device_write_packet_isr(self_p->drv_p,
+                                            self_p->endpoint_out,
+                                            NULL,
+                                            0) != 0) {
+                break;
+            }
+
+            self_p->tx.zlp_pending = 0;
+        } else {
+            size = usb_device_write_packet_isr(self_p->drv_p,
+                                               self_p->endpoint_out,
+                                               buf_p,
+                                               size);
+
+            if (size < 0) {
+                break;
+            }
+
+            queue_consume_isr(&self_p->tx.queue, size);
+            self_p->tx.zlp_pending = (size == USB_DEVICE_PACKET_SIZE_MAX);
+        }
+    }
+
+    usb_device_enable_in_isr(self_p->drv_p, self_p->endpoint_out);
+}
+
 /**
  * Output channel callback. Called when the user writes dat ato the
  * driver.
@@ -41,12 +88,23 @@ static ssize_t write_cb(void *chan_p,
                         const void *buf_p,
                         size_t size)
 {
+    ssize_t res;
     struct usb_device_class_cdc_driver_t *self_p;
 
     self_p = container_of(chan_p,
                           struct usb_device_class_cdc_driver_t,
                           chout);
 
+    if (self_p->tx.buffered) {
+        res = queue_write(&self_p->tx.queue, buf_p, size);
+
+        sys_lock();
+        usb_device_enable_in_isr(self_p->drv_p, self_p->endpoint_out);
+        sys_unlock();
+
+        return (res);
+    }
+
     return (usb_device_write(self_p->drv_p,
                              self_p->endpoint_out,
                              buf_p,
@@ -95,31 +153,62 @@ static int check_reset_to_bootloader(struct usb_device_class_cdc_driver_t *self_
  */
 static int start_of_frame_isr(struct usb_device_driver_base_t *base_p)
 {
-    char c;
+    ssize_t size;
+    void *buf_p;
     struct usb_device_class_cdc_driver_t *self_p;
 
     self_p = (struct usb_device_class_cdc_driver_t *)base_p;
 
-    /* Read data from the hardware and write it to the driver input
+    /* Read data from the hardware directly into the driver input
        queue. */
     while (1) {
-        if (usb_device_read_isr(self_p->drv_p,
-                                self_p->endpoint_in,
-                                &c,
-                                sizeof(c)) != sizeof(c)) {
+        size = queue_reserve_contiguous_isr(&self_p->chin, &buf_p);
+
+        if (size <= 0) {
             break;
         }
 
-        if (queue_write_isr(&self_p->chin,
-                            &c,
-                            sizeof(c)) != sizeof(c)) {
+        size = usb_device_read_isr(self_p->drv_p,
+                                   self_p->endpoint_in,
+                                   buf_p,
+                                   size);
+
+        if (size <= 0) {
             break;
         }
+
+        queue_commit_isr(&self_p->chin, size);
+    }
+
+    /* A writer that blocked on a full transmission queue after the
+       IN interrupt was disabled is served from here. */
+    if (self_p->tx.buffered) {
+        output_isr(self_p);
     }
 
     return (0);
 }
 
+/**
+ * USB device driver IN callback, called when an endpoint bank is
+ * free.
+ */
+static int in_isr(struct usb_device_driver_base_t *base_p,
+                  int endpoint)
+{
+    struct usb_device_class_cdc_driver_t *self_p;
+
+    self_p = (struct usb_device_class_cdc_driver_t *)base_p;
+
+    if (endpoint != self_p->endpoint_out) {
+        return (1);
+    }
+
+    output_isr(self_p);
+
+    return (0);
+}
+
 /**
  * USB device driver setup callback.
  */
@@ -254,6 +343,7 @@ int usb_device_class_cdc_init(struct usb_device_class_cdc_driver_t *self_p,
 {
     self_p->base.start_of_frame_isr = start_of_frame_isr;
     self_p->base.setup_isr = setup_isr;
+    self_p->base.in_isr = in_isr;
 #if CONFIG_USB_DEVICE_FS_COMMAND_LIST == 1
     self_p->base.print = print;
 #endif
@@ -262,6 +352,8 @@ int usb_device_class_cdc_init(struct usb_device_class_cdc_driver_t *self_p,
     self_p->endpoint_in = endpoint_in;
     self_p->endpoint_out = endpoint_out;
     self_p->line_state = 0;
+    self_p->tx.buffered = 0;
+    self_p->tx.zlp_pending = 0;
 
     self_p->line_info.dte_rate = 38400;
     self_p->line_info.char_format = 0;
@@ -280,6 +372,20 @@ int usb_device_class_cdc_init(struct usb_device_class_cdc_driver_t *self_p,
     return (0);
 }
 
+int usb_device_class_cdc_set_tx_buffer(struct usb_device_class_cdc_driver_t *self_p,
+                                       void *buf_p,
+                                       size_t size)
+{
+    ASSERTN(self_p != NULL, INVAL);
+    ASSERTN(buf_p != NULL, INVAL);
+    ASSERTN(size > 0, INVAL);
+
+    queue_init(&self_p->tx.queue, buf_p, size);
+    self_p->tx.buffered = 1;
+
+    return (0);
+}
+
 int usb_device_class_cdc_is_connected(struct usb_device_class_cdc_driver_t *self_p)
 {
     return (self_p->line_state != 0);
@@ -41,6 +41,11 @@ struct usb_device_class_cdc_driver_t {
     struct usb_cdc_line_info_t line_info;
     struct chan_t chout;
     struct queue_t chin;
+    struct {
+        int8_t buffered;
+        int8_t zlp_pending;
+        struct queue_t queue;
+    } tx;
 };
 
 /**
@@ -66,6 +71,26 @@ int usb_device_class_cdc_init(struct usb_device_class_cdc_driver_t *self_p,
                               void *rxbuf_p,
                               size_t size);
 
+/**
+ * Let writes to the CDC driver be buffered in given buffer instead of
+ * waiting for the hardware. Buffered data is sent from the endpoint
+ * IN interrupt, one full packet at a time, with a zero length packet
+ * after a transfer ending with a full packet. Call after
+ * `usb_device_class_cdc_init()` and before the USB device driver is
+ * started.
+ *
+ * @param[in] self_p Initialized driver object.
+ * @param[in] buf_p Transmission buffer.
+ * @param[in] size Transmission buffer size. A multiple of
+ *                 `USB_DEVICE_PACKET_SIZE_MAX` gives the fewest
+ *                 short packets.
+ *
+ * @return zero(0) or negative error code.
+ */
+int usb_device_class_cdc_set_tx_buffer(struct usb_device_class_cdc_driver_t *self_p,
+                                       void *buf_p,
+                                       size_t size);
+
 /**
  * Read data from the CDC driver.
  *
@@ -163,4 +163,38 @@ ssize_t usb_device_write_isr(struct usb_device_driver_t *self_p,
     return (usb_device_port_write_isr(self_p, endpoint, buf_p, size));
 }
 
+ssize_t usb_device_write_packet_isr(struct usb_device_driver_t *self_p,
+                                    int endpoint,
+                                    const void *buf_p,
+                                    size_t size)
+{
+    ASSERTN(self_p != NULL, INVAL);
+    ASSERTN(endpoint > 0, INVAL);
+    ASSERTN((buf_p != NULL) || (size == 0), INVAL);
+
+    return (usb_device_port_write_packet_isr(self_p,
+                                             endpoint,
+                                             buf_p,
+                                             MIN(size,
+                                                 USB_DEVICE_PACKET_SIZE_MAX)));
+}
+
+int usb_device_enable_in_isr(struct usb_device_driver_t *self_p,
+                             int endpoint)
+{
+    ASSERTN(self_p != NULL, INVAL);
+    ASSERTN(endpoint > 0, INVAL);
+
+    return (usb_device_port_enable_in_isr(self_p, endpoint));
+}
+
+int usb_device_disable_in_isr(struct usb_device_driver_t *self_p,
+                              int endpoint)
+{
+    ASSERTN(self_p != NULL, INVAL);
+    ASSERTN(endpoint > 0, INVAL);
+
+    return (usb_device_port_disable_in_isr(self_p, endpoint));
+}
+
 #endif
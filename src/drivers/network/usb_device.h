@@ -126,4 +126,50 @@ ssize_t usb_device_write_isr(struct usb_device_driver_t *self_p,
                              const void *buf_p,
                              size_t size);
 
+/**
+ * Write at most one packet of `USB_DEVICE_PACKET_SIZE_MAX` bytes to
+ * given endpoint from an isr or with the system lock taken. Never
+ * waits for the hardware. A size of zero(0) sends a zero length
+ * packet, which terminates a bulk transfer that ended with a full
+ * packet.
+ *
+ * @param[in] self_p Initialized driver object.
+ * @param[in] endpoint Endpoint to write to.
+ * @param[in] buf_p Buffer to write.
+ * @param[in] size Number of bytes to write.
+ *
+ * @return Number of bytes written, -EAGAIN if no endpoint bank is
+ *         free, or other negative error code.
+ */
+ssize_t usb_device_write_packet_isr(struct usb_device_driver_t *self_p,
+                                    int endpoint,
+                                    const void *buf_p,
+                                    size_t size);
+
+/**
+ * Enable the IN interrupt of given endpoint from an isr or with the
+ * system lock taken. The `in_isr` callback of the drivers is called
+ * every time an endpoint bank is free until the interrupt is
+ * disabled with `usb_device_disable_in_isr()`.
+ *
+ * @param[in] self_p Initialized driver object.
+ * @param[in] endpoint Endpoint to enable the IN interrupt for.
+ *
+ * @return zero(0) or negative error code.
+ */
+int usb_device_enable_in_isr(struct usb_device_driver_t *self_p,
+                             int endpoint);
+
+/**
+ * Disable the IN interrupt of given endpoint from an isr or with the
+ * system lock taken.
+ *
+ * @param[in] self_p Initialized driver object.
+ * @param[in] endpoint Endpoint to disable the IN interrupt for.
+ *
+ * @return zero(0) or negative error code.
+ */
+int usb_device_disable_in_isr(struct usb_device_driver_t *self_p,
+                              int endpoint);
+
 #endif
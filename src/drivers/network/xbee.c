@@ -34,6 +34,26 @@
 #define XON                                   0x11
 #define XOFF                                  0x13
 
+/* Decoder states. */
+#define DECODER_STATE_DELIMITER                  0
+#define DECODER_STATE_SIZE_MSB                   1
+#define DECODER_STATE_SIZE_LSB                   2
+#define DECODER_STATE_TYPE                       3
+#define DECODER_STATE_DATA                       4
+#define DECODER_STATE_CRC                        5
+
+/**
+ * Returns true(1) if given unescaped byte is one of the bytes that
+ * have to be escaped, otherwise false(0).
+ */
+static int is_escaped_byte(uint8_t byte)
+{
+    return ((byte == FRAME_DELIMITER)
+            || (byte == ESCAPE)
+            || (byte == XON)
+            || (byte == XOFF));
+}
+
 /**
  * Read a single byte from the transport channel.
  *
@@ -113,10 +133,7 @@ static ssize_t read_bytes(struct xbee_driver_t *self_p,
 
             /* The unescaped byte must be on of the following,
                otherwise it's a protocol error. */
-            if ((byte != FRAME_DELIMITER)
-                && (byte != ESCAPE)
-                && (byte != XON)
-                && (byte != XOFF)) {
+            if (!is_escaped_byte(byte)) {
                 return (-EPROTO);
             }
         }
@@ -218,8 +235,6 @@ int xbee_read(struct xbee_driver_t *self_p,
 
     frame_p->data.size = ((size[0] << 8) | size[1]);
 
-    std_printf(OSTR("frame_p->data.size: %d\r\n"), frame_p->data.size);
-    
     if (frame_p->data.size < 1) {
         return (-EPROTO);
     }
@@ -227,8 +242,6 @@ int xbee_read(struct xbee_driver_t *self_p,
     /* Read the frame id. */
     res = read_bytes(self_p, &frame_p->type, sizeof(frame_p->type));
 
-    std_printf(OSTR("frame_p->type: 0x%x\r\n"), frame_p->type);
-
     if (res != sizeof(frame_p->type)) {
         return (res);
     }
@@ -249,8 +262,8 @@ int xbee_read(struct xbee_driver_t *self_p,
         return (res);
     }
 
-    /* Read the CRC. */
-    res = read_byte(self_p, &crc);
+    /* Read the CRC, which is escaped as any other byte. */
+    res = read_bytes(self_p, &crc, sizeof(crc));
 
     if (res != sizeof(crc)) {
         return (res);
@@ -322,17 +335,140 @@ int xbee_write(struct xbee_driver_t *self_p,
     crc ^= 0xff;
 
     /* Write the checksum. */
-    res = chan_write(self_p->transport.chout_p,
-                     &crc,
-                     sizeof(crc));
+    res = write_bytes(self_p, &crc, sizeof(crc));
 
     if (res != sizeof(crc)) {
-        return (-EIO);
+        return (res);
     }
 
     return (0);
 }
 
+int xbee_decoder_init(struct xbee_decoder_t *self_p,
+                      struct xbee_frame_t *frame_p)
+{
+    ASSERTN(self_p != NULL, EINVAL);
+    ASSERTN(frame_p != NULL, EINVAL);
+
+    self_p->frame_p = frame_p;
+    self_p->state = DECODER_STATE_DELIMITER;
+    self_p->escaped = 0;
+
+    return (0);
+}
+
+int xbee_decoder_input(struct xbee_decoder_t *self_p,
+                       const uint8_t *buf_p,
+                       size_t *size_p)
+{
+    ASSERTN(self_p != NULL, EINVAL);
+    ASSERTN(buf_p != NULL, EINVAL);
+    ASSERTN(size_p != NULL, EINVAL);
+
+    int res;
+    size_t i;
+    uint8_t byte;
+    struct xbee_frame_t *frame_p;
+
+    frame_p = self_p->frame_p;
+    res = 0;
+
+    for (i = 0; (i < *size_p) && (res == 0); i++) {
+        byte = buf_p[i];
+
+        /* A frame delimiter always starts a new frame. */
+        if (byte == FRAME_DELIMITER) {
+            if (self_p->state != DECODER_STATE_DELIMITER) {
+                res = -EPROTO;
+            }
+
+            self_p->state = DECODER_STATE_SIZE_MSB;
+            self_p->escaped = 0;
+            continue;
+        }
+
+        /* Drop bytes outside frames. */
+        if (self_p->state == DECODER_STATE_DELIMITER) {
+            continue;
+        }
+
+        /* Unescape. */
+        if (self_p->escaped == 1) {
+            self_p->escaped = 0;
+            byte ^= 0x20;
+
+            if (!is_escaped_byte(byte)) {
+                self_p->state = DECODER_STATE_DELIMITER;
+                res = -EPROTO;
+                continue;
+            }
+        } else if (byte == ESCAPE) {
+            self_p->escaped = 1;
+            continue;
+        }
+
+        switch (self_p->state) {
+
+        case DECODER_STATE_SIZE_MSB:
+            self_p->size = (byte << 8);
+            self_p->state = DECODER_STATE_SIZE_LSB;
+            break;
+
+        case DECODER_STATE_SIZE_LSB:
+            self_p->size |= byte;
+
+            /* The size includes the frame type. */
+            if (self_p->size < 1) {
+                self_p->state = DECODER_STATE_DELIMITER;
+                res = -EPROTO;
+            } else if (self_p->size - 1 > sizeof(frame_p->data.buf)) {
+                self_p->state = DECODER_STATE_DELIMITER;
+                res = -ENOMEM;
+            } else {
+                self_p->state = DECODER_STATE_TYPE;
+            }
+            break;
+
+        case DECODER_STATE_TYPE:
+            frame_p->type = byte;
+            frame_p->data.size = (self_p->size - 1);
+            self_p->pos = 0;
+            self_p->crc = byte;
+
+            if (frame_p->data.size == 0) {
+                self_p->state = DECODER_STATE_CRC;
+            } else {
+                self_p->state = DECODER_STATE_DATA;
+            }
+            break;
+
+        case DECODER_STATE_DATA:
+            frame_p->data.buf[self_p->pos++] = byte;
+            self_p->crc += byte;
+
+            if (self_p->pos == frame_p->data.size) {
+                self_p->state = DECODER_STATE_CRC;
+            }
+            break;
+
+        default:
+            self_p->state = DECODER_STATE_DELIMITER;
+            self_p->crc += byte;
+
+            if (self_p->crc == 0xff) {
+                res = 1;
+            } else {
+                res = -EPROTO;
+            }
+            break;
+        }
+    }
+
+    *size_p = i;
+
+    return (res);
+}
+
 int xbee_print_frame(void *chan_p, struct xbee_frame_t *frame_p)
 {
     ASSERTN(chan_p != NULL, EINVAL);
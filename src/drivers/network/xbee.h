@@ -97,6 +97,16 @@ struct xbee_frame_t {
     } data;
 };
 
+/* Incremental decoder of escaped (API mode 2) frames. */
+struct xbee_decoder_t {
+    struct xbee_frame_t *frame_p;
+    uint8_t state;
+    uint8_t escaped;
+    uint8_t crc;
+    uint16_t size;
+    uint16_t pos;
+};
+
 /* The XBee driver. */
 struct xbee_driver_t {
     struct {
@@ -155,6 +165,39 @@ int xbee_read(struct xbee_driver_t *self_p,
 int xbee_write(struct xbee_driver_t *self_p,
                const struct xbee_frame_t *frame_p);
 
+/**
+ * Initialize given decoder. Decoded frames are written to given
+ * frame.
+ *
+ * @param[out] self_p Decoder to initialize.
+ * @param[in] frame_p Frame to decode into.
+ *
+ * @return zero(0) or negative error code.
+ */
+int xbee_decoder_init(struct xbee_decoder_t *self_p,
+                      struct xbee_frame_t *frame_p);
+
+/**
+ * Decode given escaped bytes, often all bytes currently available in
+ * the UART input queue. Decoding stops after the first complete
+ * frame, so call this function again with the remaining bytes until
+ * all bytes are consumed. Bytes before the frame delimiter are
+ * dropped, and a frame delimiter in the middle of a frame starts a
+ * new frame.
+ *
+ * @param[in] self_p Initialized decoder.
+ * @param[in] buf_p Bytes to decode.
+ * @param[in,out] size_p Number of bytes in given buffer as input,
+ *                       and number of consumed bytes as output.
+ *
+ * @return true(1) if a complete frame was decoded, false(0) if more
+ *         bytes are needed, or negative error code if a malformed
+ *         frame was dropped.
+ */
+int xbee_decoder_input(struct xbee_decoder_t *self_p,
+                       const uint8_t *buf_p,
+                       size_t *size_p);
+
 /**
  * Decode given frame and write it as a human readable string to given
  * channel.
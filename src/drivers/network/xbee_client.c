@@ -35,76 +35,284 @@
 #    define DLOG(level, msg, ...)
 #endif
 
-static uint8_t next_frame_id(struct xbee_client_t *self_p)
+static struct xbee_client_pending_t *find_pending(
+    struct xbee_client_t *self_p,
+    int frame_id)
 {
-    self_p->frame_id++;
+    int i;
 
-    if (self_p->frame_id == XBEE_FRAME_ID_NO_ACK) {
-        self_p->frame_id++;
+    for (i = 0; i < membersof(self_p->rpc.pending); i++) {
+        if (self_p->rpc.pending[i].frame_id == frame_id) {
+            return (&self_p->rpc.pending[i]);
+        }
     }
 
+    return (NULL);
+}
+
+/**
+ * Get the next frame id not used by any pending frame.
+ */
+static uint8_t next_frame_id(struct xbee_client_t *self_p)
+{
+    do {
+        self_p->frame_id++;
+
+        if (self_p->frame_id == XBEE_FRAME_ID_NO_ACK) {
+            self_p->frame_id++;
+        }
+    } while (find_pending(self_p, self_p->frame_id) != NULL);
+
     return (self_p->frame_id);
 }
 
+static void init_response_timeout(struct time_t *timeout_p)
+{
+    timeout_p->seconds = (CONFIG_XBEE_CLIENT_RESPONSE_TIMEOUT_MS / 1000);
+    timeout_p->nanoseconds =
+        (1000000L * (CONFIG_XBEE_CLIENT_RESPONSE_TIMEOUT_MS % 1000));
+}
+
+/**
+ * Allocate a pending frame with a unique frame id. Waits for a free
+ * entry if all are in use.
+ *
+ * @return Pending frame or NULL if none was freed in time.
+ */
+static struct xbee_client_pending_t *alloc_pending(
+    struct xbee_client_t *self_p,
+    void *buf_p,
+    size_t *size_p)
+{
+    struct xbee_client_pending_t *pending_p;
+    struct time_t timeout;
+
+    init_response_timeout(&timeout);
+
+    mutex_lock(&self_p->rpc.mutex);
+
+    while (1) {
+        pending_p = find_pending(self_p, XBEE_FRAME_ID_NO_ACK);
+
+        if (pending_p != NULL) {
+            break;
+        }
+
+        if (cond_wait(&self_p->rpc.cond,
+                      &self_p->rpc.mutex,
+                      &timeout) != 0) {
+            break;
+        }
+    }
+
+    if (pending_p != NULL) {
+        pending_p->frame_id = next_frame_id(self_p);
+        pending_p->done = 0;
+        pending_p->buf_p = buf_p;
+        pending_p->size_p = size_p;
+    }
+
+    mutex_unlock(&self_p->rpc.mutex);
+
+    return (pending_p);
+}
+
 /**
+ * Free given pending frame. The rpc mutex must be locked.
+ */
+static void free_pending(struct xbee_client_t *self_p,
+                         struct xbee_client_pending_t *pending_p)
+{
+    pending_p->frame_id = XBEE_FRAME_ID_NO_ACK;
+    cond_signal(&self_p->rpc.cond);
+}
+
+/**
+ * Wait for the response of given pending frame, and then free it.
+ *
  * @return zero(0) or negative error code.
  */
-static int communicate(struct xbee_client_t *self_p,
-                       struct xbee_frame_t *frame_p,
-                       uint8_t *response_buf_p,
-                       size_t *response_size_p)
+static int wait_pending(struct xbee_client_t *self_p,
+                        struct xbee_client_pending_t *pending_p)
 {
-    ssize_t res;
-    uint8_t frame_id;
+    int res;
     struct time_t timeout;
 
+    init_response_timeout(&timeout);
+
     mutex_lock(&self_p->rpc.mutex);
 
-    if (response_size_p != NULL) {
-        mutex_lock(&self_p->rpc.rx.mutex);
+    /* Resumed when (or if) the response is received. */
+    if (pending_p->done == 0) {
+        (void)cond_wait(&pending_p->cond, &self_p->rpc.mutex, &timeout);
+    }
 
-        /* Set the frame id. */
-        frame_id = next_frame_id(self_p);
-        frame_p->data.buf[0] = frame_id;
+    if (pending_p->done == 1) {
+        res = pending_p->res;
+    } else {
+        res = -ETIMEDOUT;
+    }
 
-        /* Response expected. */
-        self_p->rpc.rx.frame_p = frame_p;
-        self_p->rpc.rx.buf_p = response_buf_p;
-        self_p->rpc.rx.size_p = response_size_p;
+    free_pending(self_p, pending_p);
 
-        /* Write the frame. */
-        res = xbee_write(&self_p->driver, frame_p);
+    mutex_unlock(&self_p->rpc.mutex);
 
-        /* Resumed when (or if) the response is received. */
-        if (res == 0) {
-            timeout.seconds = (CONFIG_XBEE_CLIENT_RESPONSE_TIMEOUT_MS / 1000);
-            timeout.nanoseconds =
-                (1000000L * (CONFIG_XBEE_CLIENT_RESPONSE_TIMEOUT_MS % 1000));
-            res = cond_wait(&self_p->rpc.rx.cond,
-                            &self_p->rpc.rx.mutex,
-                            &timeout);
+    return (res);
+}
 
-            if (res == 0) {
-                res = self_p->rpc.rx.res;
-            }
+/**
+ * Find the pending frame with given frame id and lock the rpc mutex.
+ *
+ * @return Pending frame, with the rpc mutex locked, or NULL if not
+ *         found.
+ */
+static struct xbee_client_pending_t *lock_pending(
+    struct xbee_client_t *self_p,
+    int frame_id)
+{
+    struct xbee_client_pending_t *pending_p;
 
-            self_p->rpc.rx.frame_p = NULL;
-        }
+    mutex_lock(&self_p->rpc.mutex);
 
-        mutex_unlock(&self_p->rpc.rx.mutex);
+    if (frame_id != XBEE_FRAME_ID_NO_ACK) {
+        pending_p = find_pending(self_p, frame_id);
     } else {
-        /* Set the frame id. */
-        frame_p->data.buf[0] = XBEE_FRAME_ID_NO_ACK;
+        pending_p = NULL;
+    }
 
-        /* Write the frame. */
-        res = xbee_write(&self_p->driver, frame_p);
+    if (pending_p == NULL) {
+        mutex_unlock(&self_p->rpc.mutex);
     }
 
+    return (pending_p);
+}
+
+/**
+ * Resume the waiter of given pending frame and unlock the rpc mutex.
+ */
+static void complete_pending(struct xbee_client_t *self_p,
+                             struct xbee_client_pending_t *pending_p,
+                             int res)
+{
+    pending_p->res = res;
+    pending_p->done = 1;
+    cond_signal(&pending_p->cond);
     mutex_unlock(&self_p->rpc.mutex);
+}
+
+static int write_frame(struct xbee_client_t *self_p,
+                       struct xbee_frame_t *frame_p)
+{
+    int res;
+
+    mutex_lock(&self_p->tx.mutex);
+    res = xbee_write(&self_p->driver, frame_p);
+    mutex_unlock(&self_p->tx.mutex);
 
     return (res);
 }
 
+/**
+ * Write given frame with the frame id of given pending frame. The
+ * pending frame is freed on failure.
+ *
+ * @return zero(0) or negative error code.
+ */
+static int write_pending_frame(struct xbee_client_t *self_p,
+                               struct xbee_client_pending_t *pending_p,
+                               struct xbee_frame_t *frame_p)
+{
+    int res;
+
+    frame_p->data.buf[0] = pending_p->frame_id;
+    res = write_frame(self_p, frame_p);
+
+    if (res != 0) {
+        mutex_lock(&self_p->rpc.mutex);
+        free_pending(self_p, pending_p);
+        mutex_unlock(&self_p->rpc.mutex);
+    }
+
+    return (res);
+}
+
+/**
+ * Write given frame, and wait for its response if ``response_size_p``
+ * is not NULL.
+ *
+ * @return zero(0) or negative error code.
+ */
+static int communicate(struct xbee_client_t *self_p,
+                       struct xbee_frame_t *frame_p,
+                       uint8_t *response_buf_p,
+                       size_t *response_size_p)
+{
+    int res;
+    struct xbee_client_pending_t *pending_p;
+
+    if (response_size_p == NULL) {
+        frame_p->data.buf[0] = XBEE_FRAME_ID_NO_ACK;
+
+        return (write_frame(self_p, frame_p));
+    }
+
+    /* Response expected. */
+    pending_p = alloc_pending(self_p, response_buf_p, response_size_p);
+
+    if (pending_p == NULL) {
+        return (-ETIMEDOUT);
+    }
+
+    res = write_pending_frame(self_p, pending_p, frame_p);
+
+    if (res != 0) {
+        return (res);
+    }
+
+    return (wait_pending(self_p, pending_p));
+}
+
+/**
+ * Initialize a TX Request frame (frame id assigned later).
+ *
+ * @return zero(0) or negative error code.
+ */
+static int init_tx_request(struct xbee_frame_t *frame_p,
+                           const void *buf_p,
+                           size_t size,
+                           struct xbee_client_address_t *address_p)
+{
+    size_t pos;
+
+    switch (address_p->type) {
+
+    case xbee_client_address_type_16_bits_t:
+        frame_p->type = XBEE_FRAME_TYPE_TX_REQUEST_16_BIT_ADDRESS;
+        memcpy(&frame_p->data.buf[1], &address_p->buf[0], 2);
+        pos = 4;
+        break;
+
+    case xbee_client_address_type_64_bits_t:
+        frame_p->type = XBEE_FRAME_TYPE_TX_REQUEST_64_BIT_ADDRESS;
+        memcpy(&frame_p->data.buf[1], &address_p->buf[0], 8);
+        pos = 10;
+        break;
+
+    default:
+        return (-EINVAL);
+    }
+
+    if (size > sizeof(frame_p->data.buf) - pos) {
+        return (-EMSGSIZE);
+    }
+
+    frame_p->data.size = (pos + size);
+    frame_p->data.buf[pos - 1] = 0;
+    memcpy(&frame_p->data.buf[pos], buf_p, size);
+
+    return (0);
+}
+
 static int execute_at_command(struct xbee_client_t *self_p,
                               const char *command_p,
                               const uint8_t *parameter_p,
@@ -189,8 +397,8 @@ static int handle_tx_status(struct xbee_client_t *self_p,
 {
     ssize_t size;
     int frame_id;
-    int expected_frame_id;
     int status;
+    struct xbee_client_pending_t *pending_p;
 
     size = frame_p->data.size;
 
@@ -201,37 +409,25 @@ static int handle_tx_status(struct xbee_client_t *self_p,
 
     frame_id = frame_p->data.buf[0];
     status = frame_p->data.buf[1];
+    pending_p = lock_pending(self_p, frame_id);
 
-    mutex_lock(&self_p->rpc.rx.mutex);
-
-    if (self_p->rpc.rx.frame_p != NULL) {
-        expected_frame_id = self_p->rpc.rx.frame_p->data.buf[0];
-
-        if (expected_frame_id == frame_id) {
-            if (status != 0) {
-                DLOG(WARNING,
-                     "Negative response %d in TX Status for "
-                     "frame id 0x%02x.\r\n",
-                     status,
-                     frame_id);
-                status = -EPROTO;
-            }
+    if (pending_p == NULL) {
+        DLOG(DEBUG,
+             "Unexpected TX Status received for frame id 0x%02x.\r\n",
+             frame_id);
+        return (0);
+    }
 
-            self_p->rpc.rx.frame_p = NULL;
-            self_p->rpc.rx.res = status;
-            cond_signal(&self_p->rpc.rx.cond);
-        } else {
-            DLOG(DEBUG,
-                 "Expected frame id 0x%02x in TX Status but "
-                 "got 0x%02x.\r\n",
-                 expected_frame_id,
-                 frame_id);
-        }
-    } else {
-        DLOG(DEBUG, "Unexpected TX Status received.\r\n");
+    if (status != 0) {
+        DLOG(WARNING,
+             "Negative response %d in TX Status for "
+             "frame id 0x%02x.\r\n",
+             status,
+             frame_id);
+        status = -EPROTO;
     }
 
-    mutex_unlock(&self_p->rpc.rx.mutex);
+    complete_pending(self_p, pending_p, status);
 
     return (0);
 }
@@ -241,8 +437,8 @@ static int handle_at_command_response(struct xbee_client_t *self_p,
 {
     ssize_t size;
     int frame_id;
-    int expected_frame_id;
     int status;
+    struct xbee_client_pending_t *pending_p;
 
     size = frame_p->data.size;
 
@@ -256,45 +452,62 @@ static int handle_at_command_response(struct xbee_client_t *self_p,
 
     frame_id = frame_p->data.buf[0];
     status = frame_p->data.buf[3];
+    pending_p = lock_pending(self_p, frame_id);
 
-    mutex_lock(&self_p->rpc.rx.mutex);
-
-    if (self_p->rpc.rx.frame_p != NULL) {
-        expected_frame_id = self_p->rpc.rx.frame_p->data.buf[0];
-
-        if (expected_frame_id == frame_id) {
-            if (status == 0) {
-                size = MIN(size - 4, *self_p->rpc.rx.size_p);
-                memcpy(self_p->rpc.rx.buf_p, &frame_p->data.buf[4], size);
-            } else {
-                DLOG(WARNING,
-                     "Negative response %d in AT Command Response for "
-                     "frame id 0x%02x.\r\n",
-                     status,
-                     frame_id);
-                status = -EPROTO;
-            }
+    if (pending_p == NULL) {
+        DLOG(DEBUG,
+             "Unexpected AT Command Response received for frame id "
+             "0x%02x.\r\n",
+             frame_id);
+        return (0);
+    }
 
-            self_p->rpc.rx.frame_p = NULL;
-            *self_p->rpc.rx.size_p = size;
-            self_p->rpc.rx.res = status;
-            cond_signal(&self_p->rpc.rx.cond);
-        } else {
-            DLOG(DEBUG,
-                 "Expected frame id 0x%02x in AT Command Response but "
-                 "got 0x%02x.\r\n",
-                 expected_frame_id,
-                 frame_id);
+    if (status == 0) {
+        if (pending_p->size_p != NULL) {
+            size = MIN(size - 4, *pending_p->size_p);
+            memcpy(pending_p->buf_p, &frame_p->data.buf[4], size);
+            *pending_p->size_p = size;
         }
     } else {
-        DLOG(DEBUG, "Unexpected AT Command Response received.\r\n");
+        DLOG(WARNING,
+             "Negative response %d in AT Command Response for "
+             "frame id 0x%02x.\r\n",
+             status,
+             frame_id);
+        status = -EPROTO;
     }
 
-    mutex_unlock(&self_p->rpc.rx.mutex);
+    complete_pending(self_p, pending_p, status);
 
     return (0);
 }
 
+static void handle_frame(struct xbee_client_t *self_p,
+                         struct xbee_frame_t *frame_p)
+{
+    switch (frame_p->type) {
+
+    case XBEE_FRAME_TYPE_RX_PACKET_16_BIT_ADDRESS:
+        handle_rx_packet_16_bit_address(self_p, frame_p);
+        break;
+
+    case XBEE_FRAME_TYPE_RX_PACKET_64_BIT_ADDRESS:
+        handle_rx_packet_64_bit_address(self_p, frame_p);
+        break;
+
+    case XBEE_FRAME_TYPE_TX_STATUS:
+        handle_tx_status(self_p, frame_p);
+        break;
+
+    case XBEE_FRAME_TYPE_AT_COMMAND_RESPONSE:
+        handle_at_command_response(self_p, frame_p);
+        break;
+
+    default:
+        break;
+    }
+}
+
 int xbee_client_module_init()
 {
 #if CONFIG_XBEE_CLIENT_DEBUG_LOG_MASK > -1
@@ -311,6 +524,8 @@ int xbee_client_init(struct xbee_client_t *self_p,
                      size_t size,
                      int flags)
 {
+    int i;
+
     xbee_init(&self_p->driver, chin_p, chout_p);
     queue_init(&self_p->chin, buf_p, size);
 
@@ -319,11 +534,15 @@ int xbee_client_init(struct xbee_client_t *self_p,
     }
 
     self_p->frame_id = XBEE_FRAME_ID_NO_ACK;
-    self_p->rpc.rx.frame_p = NULL;
+
+    for (i = 0; i < membersof(self_p->rpc.pending); i++) {
+        self_p->rpc.pending[i].frame_id = XBEE_FRAME_ID_NO_ACK;
+        cond_init(&self_p->rpc.pending[i].cond);
+    }
 
     mutex_init(&self_p->rpc.mutex);
-    mutex_init(&self_p->rpc.rx.mutex);
-    cond_init(&self_p->rpc.rx.cond);
+    cond_init(&self_p->rpc.cond);
+    mutex_init(&self_p->tx.mutex);
 
 #if CONFIG_XBEE_CLIENT_DEBUG_LOG_MASK > -1
     log_object_init(&self_p->log,
@@ -339,40 +558,43 @@ void *xbee_client_main(void *arg_p)
     int res;
     struct xbee_client_t *self_p;
     struct xbee_frame_t frame;
+    struct xbee_decoder_t decoder;
+    uint8_t buf[CONFIG_XBEE_CLIENT_INPUT_BUFFER_SIZE];
+    ssize_t size;
+    size_t pos;
+    size_t consumed;
 
     self_p = arg_p;
+    xbee_decoder_init(&decoder, &frame);
 
     while (1) {
         if (chan_poll(self_p->driver.transport.chin_p, NULL) == NULL) {
             continue;
         }
 
-        res = xbee_read(&self_p->driver, &frame);
+        /* Read all available bytes, but at least one. */
+        size = chan_size(self_p->driver.transport.chin_p);
+        size = MAX(size, 1);
+        size = MIN(size, sizeof(buf));
+        size = chan_read(self_p->driver.transport.chin_p, &buf[0], size);
 
-        if (res != 0) {
+        if (size <= 0) {
             continue;
         }
 
-        switch (frame.type) {
+        /* Decode and handle all frames in the read bytes. */
+        pos = 0;
 
-        case XBEE_FRAME_TYPE_RX_PACKET_16_BIT_ADDRESS:
-            handle_rx_packet_16_bit_address(self_p, &frame);
-            break;
-
-        case XBEE_FRAME_TYPE_RX_PACKET_64_BIT_ADDRESS:
-            handle_rx_packet_64_bit_address(self_p, &frame);
-            break;
+        while (pos < size) {
+            consumed = (size - pos);
+            res = xbee_decoder_input(&decoder, &buf[pos], &consumed);
+            pos += consumed;
 
-        case XBEE_FRAME_TYPE_TX_STATUS:
-            handle_tx_status(self_p, &frame);
-            break;
-
-        case XBEE_FRAME_TYPE_AT_COMMAND_RESPONSE:
-            handle_at_command_response(self_p, &frame);
-            break;
-
-        default:
-            break;
+            if (res == 1) {
+                handle_frame(self_p, &frame);
+            } else if (res < 0) {
+                DLOG(DEBUG, "Dropped malformed frame with error %d.\r\n", res);
+            }
         }
     }
 
@@ -402,32 +624,15 @@ ssize_t xbee_client_write_to(struct xbee_client_t *self_p,
                              struct xbee_client_address_t *address_p)
 {
     struct xbee_frame_t frame;
-    size_t pos;
     size_t response_size;
     int res;
 
-    switch (address_p->type) {
+    res = init_tx_request(&frame, buf_p, size, address_p);
 
-    case xbee_client_address_type_16_bits_t:
-        frame.type = XBEE_FRAME_TYPE_TX_REQUEST_16_BIT_ADDRESS;
-        memcpy(&frame.data.buf[1], &address_p->buf[0], 2);
-        pos = 4;
-        break;
-
-    case xbee_client_address_type_64_bits_t:
-        frame.type = XBEE_FRAME_TYPE_TX_REQUEST_64_BIT_ADDRESS;
-        memcpy(&frame.data.buf[1], &address_p->buf[0], 8);
-        pos = 10;
-        break;
-
-    default:
-        return (-EINVAL);
+    if (res != 0) {
+        return (res);
     }
 
-    frame.data.size = (pos + size);
-    frame.data.buf[pos - 1] = 0;
-    memcpy(&frame.data.buf[pos], buf_p, size);
-
     if (flags & XBEE_CLIENT_NO_ACK) {
         res = communicate(self_p, &frame, NULL, NULL);
     } else {
@@ -442,6 +647,52 @@ ssize_t xbee_client_write_to(struct xbee_client_t *self_p,
     return (size);
 }
 
+int xbee_client_write_to_async(struct xbee_client_t *self_p,
+                               const void *buf_p,
+                               size_t size,
+                               struct xbee_client_address_t *address_p)
+{
+    struct xbee_frame_t frame;
+    struct xbee_client_pending_t *pending_p;
+    int res;
+
+    res = init_tx_request(&frame, buf_p, size, address_p);
+
+    if (res != 0) {
+        return (res);
+    }
+
+    pending_p = alloc_pending(self_p, NULL, NULL);
+
+    if (pending_p == NULL) {
+        return (-ETIMEDOUT);
+    }
+
+    res = write_pending_frame(self_p, pending_p, &frame);
+
+    if (res != 0) {
+        return (res);
+    }
+
+    return (frame.data.buf[0]);
+}
+
+int xbee_client_write_to_wait(struct xbee_client_t *self_p,
+                              int frame_id)
+{
+    struct xbee_client_pending_t *pending_p;
+
+    pending_p = lock_pending(self_p, frame_id);
+
+    if (pending_p == NULL) {
+        return (-EINVAL);
+    }
+
+    mutex_unlock(&self_p->rpc.mutex);
+
+    return (wait_pending(self_p, pending_p));
+}
+
 int xbee_client_pin_set_mode(struct xbee_client_t *self_p,
                              int pin,
                              int mode)
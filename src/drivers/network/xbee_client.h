@@ -54,6 +54,16 @@ struct xbee_client_address_t {
     uint8_t buf[8];
 };
 
+/* A frame waiting for its TX Status or AT Command Response. */
+struct xbee_client_pending_t {
+    uint8_t frame_id;
+    int done;
+    int res;
+    void *buf_p;
+    size_t *size_p;
+    struct cond_t cond;
+};
+
 /* The XBee client. */
 struct xbee_client_t {
     struct queue_t chin;
@@ -63,16 +73,13 @@ struct xbee_client_t {
         uint8_t value;
     } pins;
     struct {
-        struct {
-            struct mutex_t mutex;
-            struct cond_t cond;
-            struct xbee_frame_t *frame_p;
-            void *buf_p;
-            size_t *size_p;
-            int res;
-        } rx;
         struct mutex_t mutex;
+        struct cond_t cond;
+        struct xbee_client_pending_t pending[CONFIG_XBEE_CLIENT_PENDING_MAX];
     } rpc;
+    struct {
+        struct mutex_t mutex;
+    } tx;
 #if CONFIG_XBEE_CLIENT_DEBUG_LOG_MASK > -1
     struct log_object_t log;
 #endif
@@ -155,6 +162,40 @@ ssize_t xbee_client_write_to(struct xbee_client_t *self_p,
                              int flags,
                              struct xbee_client_address_t *address_p);
 
+/**
+ * Create a TX packet of given data and write it to given 16 or 64
+ * bits XBee address without waiting for its TX Status. Several
+ * packets may be outstanding at the same time, at most
+ * ``CONFIG_XBEE_CLIENT_PENDING_MAX``. Call
+ * ``xbee_client_write_to_wait()`` with the returned frame id to get
+ * the TX Status of the packet.
+ *
+ * @param[in] self_p Initialized client object.
+ * @param[in] buf_p Buffer to write.
+ * @param[in] size Number of bytes to write.
+ * @param[in] address_p Receiver address.
+ *
+ * @return Frame id of the written packet or negative error code.
+ */
+int xbee_client_write_to_async(struct xbee_client_t *self_p,
+                               const void *buf_p,
+                               size_t size,
+                               struct xbee_client_address_t *address_p);
+
+/**
+ * Wait for the TX Status of given packet written with
+ * ``xbee_client_write_to_async()``. Must be called once for each
+ * written packet, as the frame id is reserved until then.
+ *
+ * @param[in] self_p Initialized client object.
+ * @param[in] frame_id Frame id returned by
+ *                     ``xbee_client_write_to_async()``.
+ *
+ * @return zero(0) or negative error code.
+ */
+int xbee_client_write_to_wait(struct xbee_client_t *self_p,
+                              int frame_id);
+
 /**
  * Configure given pin to given mode.
  *
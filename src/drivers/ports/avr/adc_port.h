@@ -33,13 +33,18 @@
 
 #define ADC_PORT_REFERENCE_VCC _BV(REFS0)
 
+/* Continuous conversions in free running mode are supported. */
+#define ADC_PORT_HAS_STREAM
+
 struct adc_driver_t;
+struct adc_stream_t;
 
 struct adc_device_t {
     struct {
         struct adc_driver_t *head_p;
         struct adc_driver_t *tail_p;
     } jobs;
+    struct adc_stream_t *stream_p;
 };
 
 struct adc_driver_t {
@@ -58,4 +63,18 @@ struct adc_driver_t {
     struct adc_driver_t *next_p;
 };
 
+struct adc_stream_port_t {
+    uint8_t admux[CONFIG_ADC_STREAM_CHANNELS_MAX];
+#if defined(MUX5)
+    uint8_t adcsrb[CONFIG_ADC_STREAM_CHANNELS_MAX];
+#endif
+    int8_t pipeline[2];
+    int8_t next;
+    int keep;
+    long interrupt_count;
+    long interrupt_max;
+    int index;
+    size_t pos;
+};
+
 #endif
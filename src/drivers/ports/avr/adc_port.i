@@ -38,10 +38,77 @@
 #define SAMPLING_RATE_TO_INTERRUPT_MAX(rate) \
     ((SAMPLING_RATE_HZ + rate - 1) / rate)
 
+static void set_mux(struct adc_stream_t *self_p, int channel)
+{
+    ADMUX = self_p->port.admux[channel];
+#if defined(MUX5)
+    ADCSRB = self_p->port.adcsrb[channel];
+#else
+    ADCSRB = 0;
+#endif
+}
+
+static void stream_isr(struct adc_stream_t *self_p)
+{
+    int channel;
+    uint16_t *block_p;
+
+    /* A new mux setting is latched when a convertion starts, which
+       in free running mode is as soon as the previous one
+       completes. The mux written now is used by the convertion after
+       next. */
+    channel = self_p->port.pipeline[0];
+    self_p->port.pipeline[0] = self_p->port.pipeline[1];
+    self_p->port.pipeline[1] = self_p->port.next;
+    set_mux(self_p, self_p->port.next);
+    self_p->port.next++;
+
+    if (self_p->port.next == self_p->number_of_channels) {
+        self_p->port.next = 0;
+    }
+
+    if (channel == -1) {
+        return;
+    }
+
+    /* Keep one frame of all channels per sampling period. */
+    if (channel == 0) {
+        self_p->port.interrupt_count++;
+        self_p->port.keep = (self_p->port.interrupt_count
+                             == self_p->port.interrupt_max);
+
+        if (self_p->port.keep) {
+            self_p->port.interrupt_count = 0;
+        }
+    }
+
+    if (!self_p->port.keep) {
+        return;
+    }
+
+    block_p = &self_p->blocks_p[self_p->port.index * self_p->block_length];
+    block_p[self_p->port.pos++] = ADC;
+
+    /* Switch to the other block when this one is full. */
+    if (self_p->port.pos == self_p->block_length) {
+        self_p->port.pos = 0;
+        self_p->port.index ^= 1;
+        stream_write_block_isr(self_p, block_p);
+    }
+}
+
 ISR(ADC_vect)
 {
     struct adc_device_t *dev_p = &adc_device[0];
-    struct adc_driver_t *self_p = dev_p->jobs.head_p;
+    struct adc_driver_t *self_p;
+
+    if (dev_p->stream_p != NULL) {
+        stream_isr(dev_p->stream_p);
+
+        return;
+    }
+
+    self_p = dev_p->jobs.head_p;
 
     /* The AD Converter is running in free mode. */
     self_p->interrupt_count++;
@@ -93,6 +160,8 @@ static void start_adc_hw(struct adc_driver_t *self_p)
 
 static int adc_port_module_init(void)
 {
+    adc_device[0].stream_p = NULL;
+
     return (0);
 }
 
@@ -200,3 +269,78 @@ int adc_port_convert_isr(struct adc_driver_t *self_p,
 
     return (0);
 }
+
+static int adc_port_stream_init(struct adc_stream_t *self_p,
+                                struct pin_device_t **pin_devices_pp)
+{
+    int i;
+    int channel;
+
+    for (i = 0; i < self_p->number_of_channels; i++) {
+        channel = (pin_devices_pp[i] - &pin_a0_dev);
+
+        if ((channel < 0) || (channel > 15)) {
+            return (-EINVAL);
+        }
+
+        self_p->port.admux[i] = (ADC_PORT_REFERENCE_VCC | (channel & 0x07));
+#if defined(MUX5)
+        self_p->port.adcsrb[i] = channel > 7 ? _BV(MUX5) : 0;
+#endif
+        pin_device_set_mode(pin_devices_pp[i], PIN_INPUT);
+    }
+
+    /* All channels are converted in turn, so the frame rate is the
+       free running rate divided by the number of channels. */
+    self_p->port.interrupt_max =
+        SAMPLING_RATE_TO_INTERRUPT_MAX(self_p->sampling_rate
+                                       * self_p->number_of_channels);
+
+    return (0);
+}
+
+static int adc_port_stream_start(struct adc_stream_t *self_p)
+{
+    struct adc_device_t *dev_p;
+
+    dev_p = self_p->dev_p;
+
+    /* The first convertion is started with the first channel and the
+       second one inherits it, so its result is discarded. */
+    self_p->port.pipeline[0] = 0;
+    self_p->port.pipeline[1] = -1;
+    self_p->port.next = (1 % self_p->number_of_channels);
+    self_p->port.keep = 0;
+    self_p->port.interrupt_count = (self_p->port.interrupt_max - 1);
+    self_p->port.index = 0;
+    self_p->port.pos = 0;
+
+    sys_lock();
+
+    if (dev_p->jobs.head_p != NULL) {
+        sys_unlock();
+
+        return (-EBUSY);
+    }
+
+    dev_p->stream_p = self_p;
+
+    /* Start AD Converter in free running mode, clock div 32. */
+    set_mux(self_p, 0);
+    ADCSRA = (_BV(ADEN) | _BV(ADSC) | _BV(ADATE) | _BV(ADIE)
+              | _BV(ADPS2) | _BV(ADPS0));
+
+    sys_unlock();
+
+    return (0);
+}
+
+static int adc_port_stream_stop(struct adc_stream_t *self_p)
+{
+    sys_lock();
+    ADCSRA &= ~_BV(ADEN);
+    self_p->dev_p->stream_p = NULL;
+    sys_unlock();
+
+    return (0);
+}
@@ -34,8 +34,26 @@
 #define I2C_PORT_BAUDRATE_400KBPS  0x0c
 #define I2C_PORT_BAUDRATE_100KBPS  0x48
 
+/* Transactions are queued and performed from the TWI interrupt. */
+#define I2C_PORT_HAS_ASYNC
+
+struct i2c_message_t;
+struct i2c_transaction_t;
+
 struct i2c_device_t {
     struct i2c_driver_t *drv_p;
+    struct {
+        struct i2c_transaction_t *head_p;
+        struct i2c_transaction_t *tail_p;
+    } transactions;
+    struct {
+        struct i2c_message_t *message_p;
+        int left;
+        uint8_t *buf_p;
+        size_t size;
+        ssize_t res;
+        uint8_t twcr;
+    } master;
 };
 
 struct i2c_driver_t {
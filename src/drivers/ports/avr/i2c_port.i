@@ -81,68 +81,104 @@
 #define I2C_MISC_ERROR                     0x00
 
 /**
- * Transfer data to and from a slave.
- *
- * @return Number of bytes transferred or negative error code.
+ * Load the current message of the ongoing master transaction.
  */
-static ssize_t transfer(struct i2c_driver_t *self_p,
-                        int address,
-                        void *buf_p,
-                        size_t size,
-                        int direction)
+static void master_load_message(struct i2c_device_t *dev_p)
 {
-    self_p->address = ((address << 1) | direction);
-    self_p->buf_p = (void *)buf_p;
-    self_p->size = size;
-    self_p->thrd_p = thrd_self();
+    dev_p->master.buf_p = dev_p->master.message_p->buf_p;
+    dev_p->master.size = dev_p->master.message_p->size;
+}
 
-    /* Start the transfer by sending the START condition, and then
-       wait for the transfer to complete. */
-    sys_lock();
-    TWCR = (_BV(TWINT) | _BV(TWSTA) | _BV(TWEN) | _BV(TWIE));
-    thrd_suspend_isr(NULL);
-    sys_unlock();
+/**
+ * Send a stop condition and complete the ongoing master
+ * transaction. The stop condition is combined with the start
+ * condition of the next queued transaction, if any.
+ */
+static void master_complete_isr(struct i2c_device_t *dev_p, ssize_t res)
+{
+    dev_p->master.twcr = _BV(TWSTO);
+    transaction_complete_isr(dev_p, res);
 
-    return (size - self_p->size);
+    if (dev_p->master.twcr != 0) {
+        dev_p->master.twcr = 0;
+        TWCR = (_BV(TWINT) | _BV(TWSTO) | _BV(TWEN));
+    }
 }
 
-ISR(TWI_vect)
+/**
+ * Continue with the next message after a repeated start condition,
+ * or complete the transaction after the last message.
+ */
+static void master_next_message_isr(struct i2c_device_t *dev_p)
 {
-    struct i2c_device_t *dev_p = &i2c_device[0];
-    struct i2c_driver_t *drv_p = dev_p->drv_p;
-    uint8_t status;
-
-    if (drv_p == NULL) {
-        return;
+    dev_p->master.left--;
+
+    if (dev_p->master.left == 0) {
+        master_complete_isr(dev_p, dev_p->master.res);
+    } else {
+        dev_p->master.message_p++;
+        master_load_message(dev_p);
+        TWCR = (_BV(TWINT) | _BV(TWSTA) | _BV(TWEN) | _BV(TWIE));
     }
+}
 
-    status = (TWSR & 0xf8);
+static void i2c_port_transaction_start_isr(
+    struct i2c_transaction_t *transaction_p)
+{
+    struct i2c_device_t *dev_p;
+
+    dev_p = transaction_p->drv_p->dev_p;
+    dev_p->master.message_p = transaction_p->messages_p;
+    dev_p->master.left = transaction_p->length;
+    dev_p->master.res = 0;
+    master_load_message(dev_p);
+    TWBR = transaction_p->drv_p->twbr;
+
+    /* Send the START condition, after the STOP condition of the
+       previous transaction if it is just completed. */
+    TWCR = (_BV(TWINT) | dev_p->master.twcr | _BV(TWSTA) | _BV(TWEN)
+            | _BV(TWIE));
+    dev_p->master.twcr = 0;
+}
+
+static void master_isr(struct i2c_device_t *dev_p, uint8_t status)
+{
+    struct i2c_transaction_t *transaction_p;
+    uint8_t direction;
+
+    transaction_p = dev_p->transactions.head_p;
 
     switch (status) {
 
         /* Start. */
     case I2C_M_START:
     case I2C_M_REPEATED_START:
-        TWDR = drv_p->address;
+        if (dev_p->master.message_p->flags & I2C_MESSAGE_READ) {
+            direction = I2C_READ;
+        } else {
+            direction = I2C_WRITE;
+        }
+
+        TWDR = ((transaction_p->address << 1) | direction);
         TWCR = (_BV(TWINT) | _BV(TWEN) | _BV(TWIE));
         break;
 
         /* Acknowledgement. */
     case I2C_M_TX_SLA_W_ACK:
     case I2C_M_TX_DATA_ACK:
-        if (drv_p->size > 0) {
-            TWDR = *drv_p->buf_p++;
-            drv_p->size--;
+        if (dev_p->master.size > 0) {
+            TWDR = *dev_p->master.buf_p++;
+            dev_p->master.size--;
+            dev_p->master.res++;
             TWCR = (_BV(TWINT) | _BV(TWEN) | _BV(TWIE));
         } else {
-            TWCR = (_BV(TWINT) | _BV(TWSTO) | _BV(TWEN));
-            thrd_resume_isr(drv_p->thrd_p, 0);
+            master_next_message_isr(dev_p);
         }
 
         break;
 
     case I2C_M_RX_SLA_R_ACK:
-        if (drv_p->size > 1) {
+        if (dev_p->master.size > 1) {
             TWCR = (_BV(TWINT) | _BV(TWEA) | _BV(TWEN) | _BV(TWIE));
         } else {
             /* Last data read. */
@@ -152,10 +188,11 @@ ISR(TWI_vect)
         break;
 
     case I2C_M_RX_DATA_ACK:
-        *drv_p->buf_p++ = TWDR;
-        drv_p->size--;
+        *dev_p->master.buf_p++ = TWDR;
+        dev_p->master.size--;
+        dev_p->master.res++;
 
-        if (drv_p->size > 1) {
+        if (dev_p->master.size > 1) {
             TWCR = (_BV(TWINT) | _BV(TWEA) | _BV(TWEN) | _BV(TWIE));
         } else {
             /* Send NACK on last data read. */
@@ -164,17 +201,55 @@ ISR(TWI_vect)
 
         break;
 
-        /* Negative acknowledgement. */
     case I2C_M_RX_DATA_NACK:
-        *drv_p->buf_p++ = TWDR;
-        drv_p->size--;
+        /* The last byte of the message. */
+        *dev_p->master.buf_p++ = TWDR;
+        dev_p->master.size--;
+        dev_p->master.res++;
+        master_next_message_isr(dev_p);
+        break;
+
+        /* Negative acknowledgement. */
     case I2C_M_TX_SLA_W_NACK:
-    case I2C_M_TX_DATA_NACK:
     case I2C_M_RX_SLA_R_NACK:
-        TWCR = (_BV(TWINT) | _BV(TWSTO) | _BV(TWEN));
-        thrd_resume_isr(drv_p->thrd_p, -1);
+        master_complete_isr(dev_p, -1);
         break;
 
+    case I2C_M_TX_DATA_NACK:
+        /* The slave does not accept more data. */
+        master_complete_isr(dev_p, dev_p->master.res);
+        break;
+
+    default:
+        /* Arbitration lost or bus error. */
+        master_complete_isr(dev_p, -1);
+        break;
+    }
+}
+
+ISR(TWI_vect)
+{
+    struct i2c_device_t *dev_p = &i2c_device[0];
+    struct i2c_driver_t *drv_p = dev_p->drv_p;
+    uint8_t status;
+
+    status = (TWSR & 0xf8);
+
+    /* Master mode status codes. */
+    if ((status != I2C_MISC_ERROR) && (status < I2C_S_RX_SLA_W_ACK)) {
+        if (dev_p->transactions.head_p != NULL) {
+            master_isr(dev_p, status);
+        }
+
+        return;
+    }
+
+    if (drv_p == NULL) {
+        return;
+    }
+
+    switch (status) {
+
         /* Slave transmit. */
     case I2C_S_TX_DATA_ACK:
         drv_p->size--;
@@ -274,39 +349,20 @@ int i2c_port_stop(struct i2c_driver_t *self_p)
     return (0);
 }
 
-ssize_t i2c_port_read(struct i2c_driver_t *self_p,
-                      int address,
-                      void *buf_p,
-                      size_t size)
-{
-    return (transfer(self_p, address, buf_p, size, I2C_READ));
-}
-
-ssize_t i2c_port_write(struct i2c_driver_t *self_p,
-                       int address,
-                       const void *buf_p,
-                       size_t size)
-{
-    return (transfer(self_p, address, (void *)buf_p, size, I2C_WRITE));
-}
-
 int i2c_port_scan(struct i2c_driver_t *self_p,
                   int address)
 {
-    int res;
-
-    self_p->address = ((address << 1) | I2C_WRITE);
-    self_p->size = 0;
-    self_p->thrd_p = thrd_self();
+    struct i2c_message_t message;
+    struct i2c_transaction_t transaction;
 
-    /* Start the transfer by sending the START condition, and then
-       wait for the transfer to complete. */
-    sys_lock();
-    TWCR = (_BV(TWINT) | _BV(TWSTA) | _BV(TWEN) | _BV(TWIE));
-    res = thrd_suspend_isr(NULL);
-    sys_unlock();
+    /* An empty write is acknowledged by present slaves. */
+    message.buf_p = NULL;
+    message.size = 0;
+    message.flags = I2C_MESSAGE_WRITE;
+    i2c_transaction_init(&transaction, address, &message, 1);
+    i2c_transfer_async(self_p, &transaction);
 
-    return (res == 0);
+    return (i2c_transaction_wait(&transaction) == 0);
 }
 
 int i2c_port_slave_start(struct i2c_driver_t *self_p)
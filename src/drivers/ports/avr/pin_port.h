@@ -30,6 +30,7 @@
 #define __DRIVERS_PIN_PORT_H__
 
 #include <avr/io.h>
+#include <util/delay_basic.h>
 
 #define PIN(sfr_p)  ((sfr_p) + 0)
 #define DDR(sfr_p)  ((sfr_p) + 1)
@@ -95,4 +96,29 @@ static inline int pin_port_device_write_low(const struct pin_device_t *dev_p)
     return (0);
 }
 
+static inline int pin_port_device_toggle(const struct pin_device_t *dev_p)
+{
+    /* Writing one to the input register toggles the output. */
+    *PIN(dev_p->sfr_p) = dev_p->mask;
+
+    return (0);
+}
+
+/* Compile time constant pin devices. */
+#define PIN_PORT_HAS_STATIC                                    1
+#define PIN_PORT_DEVICE_STATIC_INITIALIZER(port, mask_)        \
+    { .sfr_p = (port), .mask = (mask_) }
+
+/* Cycle counted busy wait loop for bit-banging drivers. */
+#define PIN_PORT_HAS_BUSY_WAIT                                 1
+#define PIN_PORT_BUSY_WAIT_CYCLES_PER_ITERATION                4
+
+static inline void pin_port_busy_wait(int iterations)
+{
+    /* Zero iterations means 65536 iterations in _delay_loop_2(). */
+    if (iterations > 0) {
+        _delay_loop_2(iterations);
+    }
+}
+
 #endif
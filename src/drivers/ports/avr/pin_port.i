@@ -56,9 +56,7 @@ static int pin_port_write(struct pin_driver_t *self_p, int value)
 
 static int pin_port_toggle(struct pin_driver_t *self_p)
 {
-    *PORT(self_p->dev_p->sfr_p) ^= self_p->dev_p->mask;
-
-    return (0);
+    return (pin_device_toggle(self_p->dev_p));
 }
 
 static int pin_port_set_mode(struct pin_driver_t *self_p, int mode)
@@ -0,0 +1,51 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2018, Erik Moqvist
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use, copy,
+ * modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ * This file is part of the Simba project.
+ */
+
+static int power_port_deep_sleep(long microseconds)
+{
+    return (-ENOSYS);
+}
+
+/**
+ * The kernel enables the idle sleep mode at startup. Power-down stops
+ * all clocks but the watchdog's. Only external and pin change
+ * interrupts, a TWI address match and the watchdog wake up the CPU.
+ */
+static void power_port_idle_enter_isr(int mode)
+{
+    if (mode == POWER_MODE_SLEEP) {
+        SMCR = (_BV(SM1) | _BV(SE));
+    }
+}
+
+static void power_port_idle_exit_isr(int mode)
+{
+    if (mode == POWER_MODE_SLEEP) {
+        SMCR = _BV(SE);
+    }
+}
@@ -33,4 +33,12 @@ struct pwm_soft_port_module_t {
     uint8_t clock_select;
 };
 
+/**
+ * Pins on one I/O port.
+ */
+struct pwm_soft_port_pins_t {
+    volatile uint8_t *sfr_p;
+    uint8_t mask;
+};
+
 #endif
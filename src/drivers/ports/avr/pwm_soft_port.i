@@ -85,7 +85,7 @@ static void reset_timer_isr(uint16_t count)
 ISR(TIMER3_COMPA_vect)
 {
     PWM_SOFT_ISR_PROLOGUE;
-    reset_timer_isr(elem_p->delta);
+    reset_timer_isr(delta);
     PWM_SOFT_ISR_EPILOGUE;
 }
 
@@ -97,11 +97,11 @@ static int pwm_soft_port_module_init(long frequency)
         return (-1);
     }
 
-    module.tail_pwm_soft.delta = DUTY_CYCLE_MAX;
+    clear_tables();
 
     /* Enable the timer interrput. */
     TCCR3A = 0;
-    reset_timer_isr(module.tail_pwm_soft.delta);
+    reset_timer_isr(DUTY_CYCLE_MAX);
     TIMSK3 = _BV(OCIE3A);
 
     return (0);
@@ -115,9 +115,54 @@ static int pwm_soft_port_set_frequency(long value)
         return (-1);
     }
 
-    sys_lock();
-    module.tail_pwm_soft.delta = DUTY_CYCLE_MAX;
-    sys_unlock();
-    
+    clear_tables();
+
     return (0);
 }
+
+static int pwm_soft_port_pins_add(struct pwm_soft_port_pins_t *pins_p,
+                                  int length,
+                                  struct pin_device_t *pin_dev_p)
+{
+    int i;
+
+    /* Pins on the same I/O port are written at once. */
+    for (i = 0; i < length; i++) {
+        if (pins_p[i].sfr_p == pin_dev_p->sfr_p) {
+            pins_p[i].mask |= pin_dev_p->mask;
+
+            return (length);
+        }
+    }
+
+    pins_p[length].sfr_p = pin_dev_p->sfr_p;
+    pins_p[length].mask = pin_dev_p->mask;
+
+    return (length + 1);
+}
+
+static void pwm_soft_port_pins_write_high_isr(
+    const struct pwm_soft_port_pins_t *pins_p,
+    int length)
+{
+    int i;
+
+    for (i = 0; i < length; i++) {
+        *PORT(pins_p[i].sfr_p) |= pins_p[i].mask;
+    }
+}
+
+static void pwm_soft_port_pins_write_low_isr(
+    const struct pwm_soft_port_pins_t *pins_p,
+    int length)
+{
+    int i;
+
+    for (i = 0; i < length; i++) {
+        *PORT(pins_p[i].sfr_p) &= ~pins_p[i].mask;
+    }
+}
+
+static void pwm_soft_port_tables_updated(void)
+{
+}
@@ -76,12 +76,12 @@ static void rx_isr(int index)
         /* Write data to input queue. */
         if (queue_write_isr(&drv_p->base, &c, 1) != 1) {
 #if CONFIG_UART_FS_COUNTERS == 1
-            fs_counter_increment(&rx_channel_overflow, 1);
+            fs_counter_increment_isr(&rx_channel_overflow, 1);
 #endif
         }
     } else {
 #if CONFIG_UART_FS_COUNTERS == 1
-        fs_counter_increment(&rx_errors, 1);
+        fs_counter_increment_isr(&rx_errors, 1);
 #endif
     }
 }
@@ -173,8 +173,6 @@ static ssize_t uart_port_write_cb(void *arg_p,
 
     self_p = container_of(arg_p, struct uart_driver_t, base);
 
-    mutex_lock(&self_p->mutex);
-
     /* Initiate transfer by writing the first byte. */
     self_p->txbuf_p = (txbuf_p + 1);
     self_p->txsize = (size - 1);
@@ -190,8 +188,6 @@ static ssize_t uart_port_write_cb(void *arg_p,
 
     sys_unlock();
 
-    mutex_unlock(&self_p->mutex);
-
     return (size);
 }
 
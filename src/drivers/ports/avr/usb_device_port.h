@@ -31,11 +31,16 @@
 
 #include "simba.h"
 
+/* Size of a full speed bulk packet. */
+#define USB_DEVICE_PACKET_SIZE_MAX                         64
+
 struct usb_device_driver_base_t;
 
 typedef int (*usb_device_start_of_frame_cb_t)(struct usb_device_driver_base_t *self_p);
 typedef int (*usb_device_setup_cb_t)(struct usb_device_driver_base_t *self_p,
                                      struct usb_setup_t *setup_p);
+typedef int (*usb_device_in_cb_t)(struct usb_device_driver_base_t *self_p,
+                                  int endpoint);
 typedef int (*usb_device_print_cb_t)(struct usb_device_driver_base_t *self_p,
                                      void *chout_p);
 
@@ -43,6 +48,7 @@ struct usb_device_driver_base_t {
     struct usb_device_driver_base_t *next_p;
     usb_device_start_of_frame_cb_t start_of_frame_isr;
     usb_device_setup_cb_t setup_isr;
+    usb_device_in_cb_t in_isr;
 #if CONFIG_USB_DEVICE_FS_COMMAND_LIST == 1
     usb_device_print_cb_t print;
 #endif
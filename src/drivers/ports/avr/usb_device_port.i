@@ -298,6 +298,40 @@ static int handle_type_class(struct usb_device_driver_t *self_p,
     return (-1);
 }
 
+/**
+ * Call the IN callback of all drivers for each endpoint with a free
+ * bank and the IN interrupt enabled.
+ */
+static void handle_in_endpoints(struct usb_device_driver_t *self_p)
+{
+    int i;
+    int endpoint;
+    uint8_t pending;
+    struct usb_device_driver_base_t *driver_p;
+
+    pending = UEINT;
+
+    for (endpoint = 1; endpoint < membersof(endpoints); endpoint++) {
+        if ((pending & _BV(endpoint)) == 0) {
+            continue;
+        }
+
+        endpoint_select(endpoint);
+
+        if (((UEIENX & _BV(TXINE)) == 0) || ((UEINTX & _BV(TXINI)) == 0)) {
+            continue;
+        }
+
+        for (i = 0; i < self_p->drivers_max; i++) {
+            driver_p = self_p->drivers_pp[i];
+
+            if (driver_p->in_isr != NULL) {
+                driver_p->in_isr(driver_p, endpoint);
+            }
+        }
+    }
+}
+
 ISR(USB_COM_vect)
 {
     int res;
@@ -313,6 +347,10 @@ ISR(USB_COM_vect)
         return;
     }
 
+    if (UEINT & ~_BV(0)) {
+        handle_in_endpoints(self_p);
+    }
+
     endpoint_select(0);
 
     if ((UEINTX & _BV(RXSTPI)) == 0) {
@@ -522,6 +560,53 @@ static ssize_t usb_device_port_write_isr(struct usb_device_driver_t *self_p,
     return (r);
 }
 
+static ssize_t usb_device_port_write_packet_isr(struct usb_device_driver_t *self_p,
+                                                int endpoint,
+                                                const void *buf_p,
+                                                size_t size)
+{
+    size_t i;
+    const uint8_t* b_p;
+
+    endpoint_select(endpoint);
+
+    /* Both banks are owned by the hardware. */
+    if (read_write_allowed() == 0) {
+        return (-EAGAIN);
+    }
+
+    size = MIN(size, send_space());
+    b_p = buf_p;
+
+    for (i = 0; i < size; i++) {
+        UEDATX = *b_p++;
+    }
+
+    /* Hand the bank over to the hardware, possibly empty to send a
+       zero length packet. */
+    UEINTX = 0x3a;
+
+    return (size);
+}
+
+static int usb_device_port_enable_in_isr(struct usb_device_driver_t *self_p,
+                                         int endpoint)
+{
+    endpoint_select(endpoint);
+    UEIENX |= _BV(TXINE);
+
+    return (0);
+}
+
+static int usb_device_port_disable_in_isr(struct usb_device_driver_t *self_p,
+                                          int endpoint)
+{
+    endpoint_select(endpoint);
+    UEIENX &= ~_BV(TXINE);
+
+    return (0);
+}
+
 static ssize_t usb_device_port_write(struct usb_device_driver_t *self_p,
                                      int endpoint,
                                      const void *buf_p,
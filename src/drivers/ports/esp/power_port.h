@@ -29,4 +29,8 @@
 #ifndef __DRIVERS_POWER_PORT_H__
 #define __DRIVERS_POWER_PORT_H__
 
+/* The idle thread is a FreeRTOS task, so sleep modes are left to
+   FreeRTOS. */
+#define POWER_PORT_MODE_MAX                      POWER_MODE_IDLE
+
 #endif
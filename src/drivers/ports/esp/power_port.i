@@ -34,3 +34,11 @@ int power_port_deep_sleep(long microseconds)
 
     return (0);
 }
+
+static void power_port_idle_enter_isr(int mode)
+{
+}
+
+static void power_port_idle_exit_isr(int mode)
+{
+}
@@ -32,4 +32,13 @@
 struct pwm_soft_port_module_t {
 };
 
+/**
+ * GPIO 0-15 pins written with one register write, or the RTC GPIO
+ * pin.
+ */
+struct pwm_soft_port_pins_t {
+    struct pin_device_t *pin_dev_p;
+    uint32_t mask;
+};
+
 #endif
@@ -48,7 +48,7 @@ static void isr(void *arg_p)
 
     /* Clear the interrupt flag and start a new timer. */
     ESP8266_TIMER0->INT = ESP8266_TIMER_INT_CLR;
-    ESP8266_TIMER0->LOAD = elem_p->delta;
+    ESP8266_TIMER0->LOAD = delta;
 
     PWM_SOFT_ISR_EPILOGUE;
 }
@@ -59,7 +59,7 @@ static int pwm_soft_port_module_init(long frequency)
         return (-1);
     }
 
-    module.tail_pwm_soft.delta = DUTY_CYCLE_MAX;
+    clear_tables();
 
     /* Configure and start the software PWM timer. */
     ESP8266_TIMER0->CTRL = (ESP8266_TIMER_CTRL_ENABLE
@@ -69,7 +69,7 @@ static int pwm_soft_port_module_init(long frequency)
     _xt_isr_attach(ESP8266_IRQ_NUM_TIMER1, isr, NULL);
     TM1_EDGE_INT_ENABLE();
     _xt_isr_unmask(1 << ESP8266_IRQ_NUM_TIMER1);
-    ESP8266_TIMER0->LOAD = module.tail_pwm_soft.delta;
+    ESP8266_TIMER0->LOAD = DUTY_CYCLE_MAX;
 
     return (0);
 }
@@ -80,9 +80,63 @@ static int pwm_soft_port_set_frequency(long value)
         return (-1);
     }
 
-    sys_lock();
-    module.tail_pwm_soft.delta = DUTY_CYCLE_MAX;
-    sys_unlock();
+    clear_tables();
 
     return (0);
 }
+
+static int pwm_soft_port_pins_add(struct pwm_soft_port_pins_t *pins_p,
+                                  int length,
+                                  struct pin_device_t *pin_dev_p)
+{
+    int i;
+
+    if (pin_dev_p->id < 16) {
+        for (i = 0; i < length; i++) {
+            if (pins_p[i].pin_dev_p->id < 16) {
+                pins_p[i].mask |= pin_dev_p->mask;
+
+                return (length);
+            }
+        }
+    }
+
+    pins_p[length].pin_dev_p = pin_dev_p;
+    pins_p[length].mask = pin_dev_p->mask;
+
+    return (length + 1);
+}
+
+static void pwm_soft_port_pins_write_high_isr(
+    const struct pwm_soft_port_pins_t *pins_p,
+    int length)
+{
+    int i;
+
+    for (i = 0; i < length; i++) {
+        if (pins_p[i].pin_dev_p->id < 16) {
+            ESP8266_GPIO->OUT_W1TS = pins_p[i].mask;
+        } else {
+            pin_device_write_high(pins_p[i].pin_dev_p);
+        }
+    }
+}
+
+static void pwm_soft_port_pins_write_low_isr(
+    const struct pwm_soft_port_pins_t *pins_p,
+    int length)
+{
+    int i;
+
+    for (i = 0; i < length; i++) {
+        if (pins_p[i].pin_dev_p->id < 16) {
+            ESP8266_GPIO->OUT_W1TC = pins_p[i].mask;
+        } else {
+            pin_device_write_low(pins_p[i].pin_dev_p);
+        }
+    }
+}
+
+static void pwm_soft_port_tables_updated(void)
+{
+}
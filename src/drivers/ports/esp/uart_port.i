@@ -84,12 +84,12 @@ static inline void rx_isr(struct uart_driver_t *drv_p,
     if (error == 0) {
         /* Write data to input queue. */
         if (queue_write_isr(&drv_p->base, &c, 1) != 1) {
-            fs_counter_increment(&rx_channel_overflow, 1);
+            fs_counter_increment_isr(&rx_channel_overflow, 1);
         }
 
         xSemaphoreGiveFromISR(thrd_idle_sem, NULL);
     } else {
-        fs_counter_increment(&rx_errors, 1);
+        fs_counter_increment_isr(&rx_errors, 1);
     }
 }
 
@@ -168,8 +168,6 @@ static ssize_t uart_port_write_cb(void *arg_p,
 
     self_p = container_of(arg_p, struct uart_driver_t, base);
 
-    mutex_lock(&self_p->mutex);
-
     /* Initiate transfer by writing to the fifo. */
     self_p->txbuf_p = txbuf_p;
     self_p->txsize = size;
@@ -184,8 +182,6 @@ static ssize_t uart_port_write_cb(void *arg_p,
 
     sys_unlock();
 
-    mutex_unlock(&self_p->mutex);
-
     return (size);
 }
 
@@ -31,6 +31,10 @@
 
 #define ADC_PORT_REFERENCE_VCC 0
 
+/* Continuous conversions triggered by a system timer are
+   supported. */
+#define ADC_PORT_HAS_STREAM
+
 struct adc_driver_t;
 
 struct adc_device_t {
@@ -44,4 +48,11 @@ struct adc_driver_t {
     size_t length;
 };
 
+struct adc_stream_port_t {
+    struct timer_t timer;
+    uint8_t channels[CONFIG_ADC_STREAM_CHANNELS_MAX];
+    int index;
+    size_t pos;
+};
+
 #endif
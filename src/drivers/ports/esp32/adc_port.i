@@ -28,44 +28,83 @@
 
 #include "driver/adc.h"
 
-static int adc_port_module_init(void)
-{
-    esp_adc1_config_width(ADC_WIDTH_12Bit);
-
-    return (0);
-}
-
-static int adc_port_init(struct adc_driver_t *self_p,
-                         struct adc_device_t *dev_p,
-                         struct pin_device_t *pin_dev_p,
-                         int reference,
-                         long sampling_rate)
+/**
+ * Return the ADC1 channel of given pin, or -1 if the pin does not
+ * have one.
+ */
+static int pin_to_channel(struct pin_device_t *pin_dev_p)
 {
     if (pin_dev_p == &pin_device[32]) {
         /* GPIO36, ADC1, CH0. */
-        self_p->channel = 0;
+        return (0);
     } else if (pin_dev_p == &pin_device[33]) {
         /* GPIO37, ADC1, CH1. */
-        self_p->channel = 1;
+        return (1);
     } else if (pin_dev_p == &pin_device[34]) {
         /* GPIO38, ADC1, CH2. */
-        self_p->channel = 2;
+        return (2);
     } else if (pin_dev_p == &pin_device[35]) {
         /* GPIO39, ADC1, CH3. */
-        self_p->channel = 3;
+        return (3);
     } else if (pin_dev_p == &pin_device[28]) {
         /* GPIO32, ADC1, CH4. */
-        self_p->channel = 4;
+        return (4);
     } else if (pin_dev_p == &pin_device[29]) {
         /* GPIO33, ADC1, CH5. */
-        self_p->channel = 5;
+        return (5);
     } else if (pin_dev_p == &pin_device[30]) {
         /* GPIO34, ADC1, CH6. */
-        self_p->channel = 6;
+        return (6);
     } else if (pin_dev_p == &pin_device[31]) {
         /* GPIO35, ADC1, CH7. */
-        self_p->channel = 7;
-    } else {
+        return (7);
+    }
+
+    return (-1);
+}
+
+/**
+ * Convert one frame of all channels. Called in interrupt context by
+ * the stream timer.
+ */
+static void stream_timer_cb(void *arg_p)
+{
+    struct adc_stream_t *self_p;
+    uint16_t *block_p;
+    int i;
+
+    self_p = arg_p;
+    block_p = &self_p->blocks_p[self_p->port.index * self_p->block_length];
+
+    for (i = 0; i < self_p->number_of_channels; i++) {
+        block_p[self_p->port.pos++] =
+            esp_adc1_get_voltage(self_p->port.channels[i]);
+    }
+
+    /* Switch to the other block when this one is full. */
+    if (self_p->port.pos == self_p->block_length) {
+        self_p->port.pos = 0;
+        self_p->port.index ^= 1;
+        stream_write_block_isr(self_p, block_p);
+    }
+}
+
+static int adc_port_module_init(void)
+{
+    esp_adc1_config_width(ADC_WIDTH_12Bit);
+
+    return (0);
+}
+
+static int adc_port_init(struct adc_driver_t *self_p,
+                         struct adc_device_t *dev_p,
+                         struct pin_device_t *pin_dev_p,
+                         int reference,
+                         long sampling_rate)
+{
+    self_p->channel = pin_to_channel(pin_dev_p);
+
+    if (self_p->channel == -1) {
         return (-1);
     }
 
@@ -94,3 +133,48 @@ static int adc_port_convert_isr(struct adc_driver_t *self_p,
 {
     return (-1);
 }
+
+static int adc_port_stream_init(struct adc_stream_t *self_p,
+                                struct pin_device_t **pin_devices_pp)
+{
+    int i;
+    int channel;
+    struct time_t timeout;
+
+    for (i = 0; i < self_p->number_of_channels; i++) {
+        channel = pin_to_channel(pin_devices_pp[i]);
+
+        if (channel == -1) {
+            return (-EINVAL);
+        }
+
+        esp_adc1_config_channel_atten(channel, ADC_ATTEN_11db);
+        self_p->port.channels[i] = channel;
+    }
+
+    /* The timer resolution is one system tick, which limits the
+       highest sampling rate. */
+    timeout.seconds = 0;
+    timeout.nanoseconds = (1000000000L / self_p->sampling_rate);
+
+    return (timer_init(&self_p->port.timer,
+                       &timeout,
+                       stream_timer_cb,
+                       self_p,
+                       TIMER_PERIODIC));
+}
+
+static int adc_port_stream_start(struct adc_stream_t *self_p)
+{
+    self_p->port.index = 0;
+    self_p->port.pos = 0;
+
+    return (timer_start(&self_p->port.timer));
+}
+
+static int adc_port_stream_stop(struct adc_stream_t *self_p)
+{
+    timer_stop(&self_p->port.timer);
+
+    return (0);
+}
@@ -98,7 +98,7 @@ static int wait_for_bus_idle(volatile struct esp32_can_t *regs_p)
 static void reset_hw(volatile struct esp32_can_t *regs_p)
 {
     /* Reset the chip. */
-    regs_p->MODE = 1;
+    regs_p->MODE = (ESP32_CAN_MODE_RESET | ESP32_CAN_MODE_ACCEPTANCE_FILTER);
 
     /* Clear error counters and error code capture */
     regs_p->TXERR = 0;
@@ -109,13 +109,71 @@ static void reset_hw(volatile struct esp32_can_t *regs_p)
        register.  */
     (void)regs_p->INT;
 
-    /* Set chip to normal mode. */
-    regs_p->MODE = 0;
+    /* Set chip to normal mode with a single acceptance filter. */
+    regs_p->MODE = ESP32_CAN_MODE_ACCEPTANCE_FILTER;
 
     /* Enable all interrupts. */
     regs_p->INTE = 0xff;
 }
 
+/**
+ * Program the single acceptance filter of the hardware with the
+ * smallest code and mask accepting all frames matched by the driver
+ * filters. Mask bits set to one are don't care. Frames are matched
+ * exactly in software as the hardware filter may accept more frames
+ * than the filter list when there are several filters.
+ */
+static void configure_acceptance_filter(struct can_driver_t *self_p,
+                                        volatile struct esp32_can_t *regs_p)
+{
+    const struct can_filter_t *filters_p;
+    uint32_t code;
+    uint32_t dont_care;
+    int extended_frame;
+    int i;
+
+    filters_p = self_p->filters.filters_p;
+
+    /* Accept all frames. */
+    for (i = 0; i < 4; i++) {
+        regs_p->U.ACC.CODE[i] = 0;
+        regs_p->U.ACC.MASK[i] = 0xff;
+    }
+
+    if (self_p->filters.length == 0) {
+        return;
+    }
+
+    code = filters_p[0].id;
+    dont_care = ~filters_p[0].mask;
+    extended_frame = filters_p[0].extended_frame;
+
+    for (i = 1; i < self_p->filters.length; i++) {
+        /* The hardware filter cannot tell the frame formats apart. */
+        if (filters_p[i].extended_frame != extended_frame) {
+            return;
+        }
+
+        dont_care |= (~filters_p[i].mask | (filters_p[i].id ^ code));
+    }
+
+    if (extended_frame == 0) {
+        regs_p->U.ACC.CODE[0] = ((code >> 3) & 0xff);
+        regs_p->U.ACC.CODE[1] = ((code & 0x7) << 5);
+        regs_p->U.ACC.MASK[0] = ((dont_care >> 3) & 0xff);
+        regs_p->U.ACC.MASK[1] = (((dont_care & 0x7) << 5) | 0x1f);
+    } else {
+        regs_p->U.ACC.CODE[0] = ((code >> 21) & 0xff);
+        regs_p->U.ACC.CODE[1] = ((code >> 13) & 0xff);
+        regs_p->U.ACC.CODE[2] = ((code >> 5) & 0xff);
+        regs_p->U.ACC.CODE[3] = ((code & 0x1f) << 3);
+        regs_p->U.ACC.MASK[0] = ((dont_care >> 21) & 0xff);
+        regs_p->U.ACC.MASK[1] = ((dont_care >> 13) & 0xff);
+        regs_p->U.ACC.MASK[2] = ((dont_care >> 5) & 0xff);
+        regs_p->U.ACC.MASK[3] = (((dont_care & 0x1f) << 3) | 0x7);
+    }
+}
+
 /**
  * Read a frame from the hardware.
  */
@@ -144,6 +202,10 @@ static void read_frame_from_hw(struct can_driver_t *self_p,
     }
 
     frame.size = ESP32_CAN_FRAME_INFO_DLC_GET(frame_info);
+    frame.rtr = ((frame_info & ESP32_CAN_FRAME_INFO_RTR) != 0);
+#if CONFIG_CAN_FRAME_TIMESTAMP == 1
+    frame.timestamp = timestamp_isr();
+#endif
 
     /* Copy the frame data to the hardware. */
     for (i = 0; i < frame.size; i++) {
@@ -153,6 +215,10 @@ static void read_frame_from_hw(struct can_driver_t *self_p,
     /* Let the hardware know the frame has been read. */
     regs_p->COMMAND = ESP32_CAN_COMMAND_RELEASE_RECV_BUF;
 
+    if (!is_frame_accepted_isr(self_p, &frame)) {
+        return;
+    }
+
     /* Write the received frame to the application input channel. */
     if (queue_unused_size_isr(&self_p->chin) >= sizeof(frame)) {
         queue_write_isr(&self_p->chin,
@@ -165,7 +231,7 @@ static void read_frame_from_hw(struct can_driver_t *self_p,
             self_p->base.reader_p = NULL;
         }
     } else {
-        fs_counter_increment(&rx_channel_overflow, 1);
+        fs_counter_increment_isr(&rx_channel_overflow, 1);
     }
 }
 
@@ -244,7 +310,7 @@ static void isr(void *arg_p)
                      | ESP32_CAN_INT_ERR_PASSIVE
                      | ESP32_CAN_INT_ARB_LOST
                      | ESP32_CAN_INT_BUS_ERR)) {
-        fs_counter_increment(&errors, 1);
+        fs_counter_increment_isr(&errors, 1);
 
         /* In case of many errors or bus-off state reset the hardware */
         if (regs_p->STATUS & (ESP32_CAN_STATUS_ERR | ESP32_CAN_STATUS_BUS)) {
@@ -374,15 +440,8 @@ int can_port_start(struct can_driver_t *self_p)
     regs_p->BTIM0 = (self_p->speed & 0xff);
     regs_p->BTIM1 = ((self_p->speed >> 8) & 0xff);
 
-    /* Accept all frames. */
-    regs_p->U.ACC.CODE[0] = 0;
-    regs_p->U.ACC.CODE[1] = 0;
-    regs_p->U.ACC.CODE[2] = 0;
-    regs_p->U.ACC.CODE[3] = 0;
-    regs_p->U.ACC.MASK[0] = 0xff;
-    regs_p->U.ACC.MASK[1] = 0xff;
-    regs_p->U.ACC.MASK[2] = 0xff;
-    regs_p->U.ACC.MASK[3] = 0xff;
+    /* Acceptance filter. */
+    configure_acceptance_filter(self_p, regs_p);
 
     regs_p->OCTRL = (ESP32_CAN_OCTRL_MODE_NORMAL);
 
@@ -29,16 +29,28 @@
 #ifndef __DRIVERS_DAC_PORT_H__
 #define __DRIVERS_DAC_PORT_H__
 
+/* Continuous convertions from a hardware timer interrupt are
+   supported. */
+#define DAC_PORT_HAS_STREAM
+
 struct dac_driver_t;
+struct dac_stream_t;
 
 struct dac_device_t {
-    int dummy;
+    struct dac_stream_t *stream_p;
 };
 
 struct dac_driver_t {
     struct dac_device_t *dev_p;
     int pin0_channel;
     int pin1_channel;
+    long sampling_rate;
+};
+
+struct dac_stream_port_t {
+    int index;
+    size_t pos;
+    uint8_t last[2];
 };
 
 #endif
@@ -28,8 +28,91 @@
 
 #include "driver/dac.h"
 
+static int number_of_channels(struct dac_driver_t *self_p)
+{
+    return (self_p->pin1_channel == DAC_CHANNEL_MAX ? 1 : 2);
+}
+
+static void stream_refill_isr(struct dac_stream_t *self_p, int index)
+{
+    uint8_t *samples_p;
+    size_t length;
+    int channels;
+
+    samples_p = self_p->buffers_pp[index];
+    length = stream_fill_isr(self_p, samples_p);
+    channels = number_of_channels(self_p->drv_p);
+
+    /* Hold the output level on underrun. A partial frame is
+       overwritten. */
+    length -= (length % channels);
+
+    if (length > 0) {
+        self_p->port.last[0] = samples_p[length - channels];
+        self_p->port.last[1] = samples_p[length - 1];
+    }
+
+    while (length < self_p->length) {
+        samples_p[length] = self_p->port.last[0];
+
+        if (channels == 2) {
+            samples_p[length + 1] = self_p->port.last[1];
+        }
+
+        length += channels;
+    }
+}
+
+/**
+ * Output one frame per sampling period, triggered by timer 0 in timer
+ * group 1. There is no DMA to the DAC in this port.
+ */
+static RAM_CODE void isr(void *arg_p)
+{
+    struct dac_stream_t *self_p;
+    struct dac_driver_t *drv_p;
+    uint8_t *samples_p;
+
+    ESP32_TIMG1->INT.CLR = 1;
+    ESP32_TIMG1->TIMER[0].CONFIG |= (ESP32_TIMG_TIMER_CONFIG_ALARM_EN);
+
+    self_p = dac_device[0].stream_p;
+
+    if (self_p == NULL) {
+        return;
+    }
+
+    drv_p = self_p->drv_p;
+    samples_p = self_p->buffers_pp[self_p->port.index];
+    esp_dac_out_voltage(drv_p->pin0_channel, samples_p[self_p->port.pos++]);
+
+    if (drv_p->pin1_channel != DAC_CHANNEL_MAX) {
+        esp_dac_out_voltage(drv_p->pin1_channel,
+                            samples_p[self_p->port.pos++]);
+    }
+
+    /* Refill the finished buffer and continue with the next one. */
+    if (self_p->port.pos == self_p->length) {
+        stream_refill_isr(self_p, self_p->port.index);
+        self_p->port.pos = 0;
+        self_p->port.index++;
+
+        if (self_p->port.index == self_p->number_of_buffers) {
+            self_p->port.index = 0;
+        }
+    }
+}
+
 static int dac_port_module_init(void)
 {
+    dac_device[0].stream_p = NULL;
+
+    esp_xt_set_interrupt_handler(ESP32_CPU_INTR_DAC_NUM, isr, NULL);
+    esp_xt_ints_on(BIT(ESP32_CPU_INTR_DAC_NUM));
+    intr_matrix_set(xPortGetCoreID(),
+                    ESP32_INTR_SOURCE_TG1_T0_LEVEL,
+                    ESP32_CPU_INTR_DAC_NUM);
+
     return (0);
 }
 
@@ -40,6 +123,7 @@ static int dac_port_init(struct dac_driver_t *self_p,
                          long sampling_rate)
 {
     self_p->dev_p = dev_p;
+    self_p->sampling_rate = sampling_rate;
 
     /* Pin 0 channel. */
     if (pin0_dev_p == &pin_device[25]) {
@@ -91,3 +175,65 @@ static int dac_port_convert(struct dac_driver_t *self_p,
 
     return (0);
 }
+
+static int dac_port_stream_start(struct dac_stream_t *self_p)
+{
+    struct dac_device_t *dev_p;
+    int i;
+
+    dev_p = self_p->drv_p->dev_p;
+
+    /* Whole frames only. */
+    if ((self_p->length % number_of_channels(self_p->drv_p)) != 0) {
+        return (-EINVAL);
+    }
+
+    sys_lock();
+
+    if (dev_p->stream_p != NULL) {
+        sys_unlock();
+
+        return (-EBUSY);
+    }
+
+    self_p->port.index = 0;
+    self_p->port.pos = 0;
+    self_p->port.last[0] = 0;
+    self_p->port.last[1] = 0;
+
+    for (i = 0; i < self_p->number_of_buffers; i++) {
+        stream_refill_isr(self_p, i);
+    }
+
+    dev_p->stream_p = self_p;
+
+    /* Start the sampling timer. */
+    ESP32_TIMG1->TIMER[0].ALARMLO = (40000000 / self_p->drv_p->sampling_rate);
+    ESP32_TIMG1->TIMER[0].ALARMHI = 0;
+    ESP32_TIMG1->TIMER[0].LOADLO = 0;
+    ESP32_TIMG1->TIMER[0].LOADHI = 0;
+    ESP32_TIMG1->TIMER[0].LOAD = 1;
+    ESP32_TIMG1->TIMER[0].CONFIG = (ESP32_TIMG_TIMER_CONFIG_ALARM_EN
+                                    | ESP32_TIMG_TIMER_CONFIG_LEVEL_INT_EN
+                                    | ESP32_TIMG_TIMER_CONFIG_DIVIDER(1)
+                                    | ESP32_TIMG_TIMER_CONFIG_AUTORELOAD
+                                    | ESP32_TIMG_TIMER_CONFIG_INCREASE
+                                    | ESP32_TIMG_TIMER_CONFIG_EN);
+    ESP32_TIMG1->INT.ENA |= 1;
+
+    sys_unlock();
+
+    return (0);
+}
+
+static int dac_port_stream_stop(struct dac_stream_t *self_p)
+{
+    sys_lock();
+    ESP32_TIMG1->INT.ENA &= ~1;
+    ESP32_TIMG1->TIMER[0].CONFIG = 0;
+    ESP32_TIMG1->INT.CLR = 1;
+    self_p->drv_p->dev_p->stream_p = NULL;
+    sys_unlock();
+
+    return (0);
+}
@@ -31,6 +31,8 @@
 
 #include <io.h>
 
+#define UART_PORT_HAS_FLOW_CONTROL
+
 /*
  * ESP32 supports 5/6/7/8 data bits, N/E/O parity, 1/1.5 stop bits
  */
@@ -115,6 +117,7 @@ struct uart_driver_t {
     struct thrd_t *thrd_p;
     long baudrate;
     int format;
+    struct uart_flow_control_t flow_control;
 };
 
 #endif
@@ -92,8 +92,8 @@ static inline void rx_isr(struct uart_driver_t *drv_p,
     while (dev_p->regs_p->STATUS & ESP32_UART_STATUS_RXFIFO_CNT_MASK) {
         c = dev_p->regs_p->FIFO;
 
-        if (queue_write_isr(&drv_p->base, &c, 1) != 1) {
-            fs_counter_increment(&rx_channel_overflow, 1);
+        if (rx_write_isr(drv_p, &c, 1) != 1) {
+            fs_counter_increment_isr(&rx_channel_overflow, 1);
         }
     }
 
@@ -137,6 +137,33 @@ static RAM_CODE void isr(void *arg_p)
     }
 }
 
+static void uart_port_send_char_isr(struct uart_driver_t *self_p,
+                                    uint8_t c)
+{
+    volatile struct esp32_uart_t *regs_p;
+
+    regs_p = self_p->dev_p->regs_p;
+
+    /* Queued after the bytes already in the transmit fifo. */
+    while ((regs_p->STATUS & ESP32_UART_STATUS_TXFIFO_CNT_MASK)
+           >= ESP32_UART_STATUS_TXFIFO_CNT(128));
+
+    regs_p->FIFO = c;
+}
+
+static void uart_port_tx_stop_isr(struct uart_driver_t *self_p)
+{
+    /* Bytes already in the transmit fifo are still sent. */
+    self_p->dev_p->regs_p->INT_ENA &= ~ESP32_UART_INT_ENA_TXFIFO_EMPTY;
+}
+
+static void uart_port_tx_resume_isr(struct uart_driver_t *self_p)
+{
+    if (self_p->txsize > 0) {
+        self_p->dev_p->regs_p->INT_ENA |= ESP32_UART_INT_ENA_TXFIFO_EMPTY;
+    }
+}
+
 static int uart_port_module_init()
 {
     fs_counter_init(&rx_channel_overflow,
@@ -228,8 +255,6 @@ static ssize_t uart_port_write_cb(void *arg_p,
 
     self_p = container_of(arg_p, struct uart_driver_t, base);
 
-    mutex_lock(&self_p->mutex);
-
     /* Initiate transfer by writing to the fifo. */
     self_p->txbuf_p = txbuf_p;
     self_p->txsize = size;
@@ -237,15 +262,16 @@ static ssize_t uart_port_write_cb(void *arg_p,
 
     sys_lock();
 
-    if (fill_tx_fifo(self_p) > 0) {
+    /* Wait for XON before filling the fifo. */
+    if (self_p->flow_control.tx_stopped == 1) {
+        thrd_suspend_isr(NULL);
+    } else if (fill_tx_fifo(self_p) > 0) {
         self_p->dev_p->regs_p->INT_ENA |= ESP32_UART_INT_ENA_TXFIFO_EMPTY;
         thrd_suspend_isr(NULL);
     }
 
     sys_unlock();
 
-    mutex_unlock(&self_p->mutex);
-
     return (size);
 }
 
@@ -32,12 +32,30 @@
 
 #define ADC_PORT_REFERENCE_VCC 0
 
+#define ADC_PORT_HAS_STREAM
+
+struct adc_stream_t;
+
 struct adc_device_t {
     struct adc_driver_t *drv_p;
+    struct adc_stream_t *stream_p;
 };
 
 struct adc_driver_t {
     struct adc_device_t *dev_p;
 };
 
+struct adc_stream_port_t {
+    int index;
+    size_t pos;
+};
+
+/**
+ * Feed given converted sample to the stream started on given
+ * device, if any. Used to simulate the hardware. Must be called with
+ * the system lock taken.
+ */
+void adc_port_device_sample_isr(struct adc_device_t *dev_p,
+                                uint16_t sample);
+
 #endif
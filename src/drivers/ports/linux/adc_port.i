@@ -57,3 +57,53 @@ int adc_port_convert_isr(struct adc_driver_t *self_p,
 {
     return (-1);
 }
+
+static int adc_port_stream_init(struct adc_stream_t *self_p,
+                                struct pin_device_t **pin_devices_pp)
+{
+    return (0);
+}
+
+static int adc_port_stream_start(struct adc_stream_t *self_p)
+{
+    self_p->port.index = 0;
+    self_p->port.pos = 0;
+
+    sys_lock();
+    self_p->dev_p->stream_p = self_p;
+    sys_unlock();
+
+    return (0);
+}
+
+static int adc_port_stream_stop(struct adc_stream_t *self_p)
+{
+    sys_lock();
+    self_p->dev_p->stream_p = NULL;
+    sys_unlock();
+
+    return (0);
+}
+
+void adc_port_device_sample_isr(struct adc_device_t *dev_p,
+                                uint16_t sample)
+{
+    struct adc_stream_t *self_p;
+    uint16_t *block_p;
+
+    self_p = dev_p->stream_p;
+
+    if (self_p == NULL) {
+        return;
+    }
+
+    block_p = &self_p->blocks_p[self_p->port.index * self_p->block_length];
+    block_p[self_p->port.pos++] = sample;
+
+    /* Switch to the other block when this one is full. */
+    if (self_p->port.pos == self_p->block_length) {
+        self_p->port.pos = 0;
+        self_p->port.index ^= 1;
+        stream_write_block_isr(self_p, block_p);
+    }
+}
@@ -42,6 +42,19 @@ struct can_driver_t {
     struct can_device_t *dev_p;
     struct queue_t chin;
     struct mutex_t mutex;
+    struct {
+        const struct can_filter_t *filters_p;
+        int length;
+    } filters;
 };
 
+struct can_frame_t;
+
+/**
+ * Called by the socket device when a frame is received on given
+ * device. Must be called with the system lock taken.
+ */
+void can_port_device_rx_isr(struct can_device_t *dev_p,
+                            struct can_frame_t *frame_p);
+
 #endif
@@ -52,6 +52,31 @@ static ssize_t write_cb(void *arg_p,
     return (res);
 }
 
+void can_port_device_rx_isr(struct can_device_t *dev_p,
+                            struct can_frame_t *frame_p)
+{
+    struct can_driver_t *self_p;
+
+    self_p = dev_p->drv_p;
+
+    if (self_p == NULL) {
+        return;
+    }
+
+#if CONFIG_CAN_FRAME_TIMESTAMP == 1
+    frame_p->timestamp = timestamp_isr();
+#endif
+
+    /* There is no hardware, filter in software. */
+    if (!is_frame_accepted_isr(self_p, frame_p)) {
+        return;
+    }
+
+    if (queue_unused_size_isr(&self_p->chin) >= sizeof(*frame_p)) {
+        queue_write_isr(&self_p->chin, frame_p, sizeof(*frame_p));
+    }
+}
+
 static int can_port_module_init()
 {
     return (socket_device_module_init());
@@ -29,14 +29,34 @@
 #ifndef __DRIVERS_DAC_PORT_H__
 #define __DRIVERS_DAC_PORT_H__
 
+/* Continuous convertions are supported. */
+#define DAC_PORT_HAS_STREAM
+
 struct dac_driver_t;
+struct dac_stream_t;
 
 struct dac_device_t {
     struct dac_driver_t *drv_p;
+    struct dac_stream_t *stream_p;
 };
 
 struct dac_driver_t {
     struct dac_device_t *dev_p;
 };
 
+struct dac_stream_port_t {
+    int index;
+    size_t pos;
+    uint32_t last;
+};
+
+/**
+ * Take the next sample of the started stream on given device, as
+ * the hardware would on each sampling period.
+ *
+ * @return zero(0) or negative error code.
+ */
+int dac_port_device_convert_isr(struct dac_device_t *dev_p,
+                                uint32_t *sample_p);
+
 #endif
@@ -37,6 +37,8 @@ static int dac_port_init(struct dac_driver_t *self_p,
                          struct pin_device_t *pin1_dev_p,
                          long sampling_rate)
 {
+    self_p->dev_p = dev_p;
+
     return (0);
 }
 
@@ -58,3 +60,89 @@ static int dac_port_convert(struct dac_driver_t *self_p,
 {
     return (0);
 }
+
+static void stream_refill_isr(struct dac_stream_t *self_p, int index)
+{
+    uint32_t *samples_p;
+    size_t length;
+
+    samples_p = self_p->buffers_pp[index];
+    length = stream_fill_isr(self_p, samples_p);
+
+    /* Hold the output level on underrun. */
+    if (length > 0) {
+        self_p->port.last = samples_p[length - 1];
+    }
+
+    while (length < self_p->length) {
+        samples_p[length++] = self_p->port.last;
+    }
+}
+
+static int dac_port_stream_start(struct dac_stream_t *self_p)
+{
+    struct dac_device_t *dev_p;
+    int i;
+
+    dev_p = self_p->drv_p->dev_p;
+
+    sys_lock();
+
+    if (dev_p->stream_p != NULL) {
+        sys_unlock();
+
+        return (-EBUSY);
+    }
+
+    self_p->port.index = 0;
+    self_p->port.pos = 0;
+    self_p->port.last = 0;
+
+    for (i = 0; i < self_p->number_of_buffers; i++) {
+        stream_refill_isr(self_p, i);
+    }
+
+    dev_p->stream_p = self_p;
+
+    sys_unlock();
+
+    return (0);
+}
+
+static int dac_port_stream_stop(struct dac_stream_t *self_p)
+{
+    sys_lock();
+    self_p->drv_p->dev_p->stream_p = NULL;
+    sys_unlock();
+
+    return (0);
+}
+
+int dac_port_device_convert_isr(struct dac_device_t *dev_p,
+                                uint32_t *sample_p)
+{
+    struct dac_stream_t *self_p;
+    uint32_t *samples_p;
+
+    self_p = dev_p->stream_p;
+
+    if (self_p == NULL) {
+        return (-1);
+    }
+
+    samples_p = self_p->buffers_pp[self_p->port.index];
+    *sample_p = samples_p[self_p->port.pos++];
+
+    /* Refill the finished buffer and continue with the next one. */
+    if (self_p->port.pos == self_p->length) {
+        stream_refill_isr(self_p, self_p->port.index);
+        self_p->port.pos = 0;
+        self_p->port.index++;
+
+        if (self_p->port.index == self_p->number_of_buffers) {
+            self_p->port.index = 0;
+        }
+    }
+
+    return (0);
+}
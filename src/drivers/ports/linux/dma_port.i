@@ -0,0 +1,158 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2014-2018, Erik Moqvist
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use, copy,
+ * modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ * This file is part of the Simba project.
+ */
+
+
+/* The software DMA controller transfers one whole buffer each
+   millisecond, from a timer callback. */
+
+static void copy(volatile void *dst_p,
+                 const volatile void *src_p,
+                 size_t offset,
+                 int width)
+{
+    switch (width) {
+
+    case DMA_WIDTH_8:
+        ((volatile uint8_t *)dst_p)[offset] =
+            ((const volatile uint8_t *)src_p)[offset];
+        break;
+
+    case DMA_WIDTH_16:
+        ((volatile uint16_t *)dst_p)[offset] =
+            ((const volatile uint16_t *)src_p)[offset];
+        break;
+
+    default:
+        ((volatile uint32_t *)dst_p)[offset] =
+            ((const volatile uint32_t *)src_p)[offset];
+        break;
+    }
+}
+
+static void timer_cb(void *arg_p)
+{
+    struct dma_driver_t *self_p;
+    struct dma_transfer_t *transfer_p;
+    int width;
+    size_t i;
+
+    self_p = arg_p;
+    transfer_p = self_p->transfer_p;
+
+    if (transfer_p == NULL) {
+        return;
+    }
+
+    width = (transfer_p->flags & DMA_WIDTH_MASK);
+
+    for (i = 0; i < transfer_p->length; i++) {
+        switch (transfer_p->direction) {
+
+        case DMA_MEMORY_TO_PERIPHERAL:
+            /* The peripheral address is fixed. */
+            copy(transfer_p->dst_p,
+                 (const volatile uint8_t *)transfer_p->src_p + (i << width),
+                 0,
+                 width);
+            break;
+
+        case DMA_PERIPHERAL_TO_MEMORY:
+            copy((volatile uint8_t *)transfer_p->dst_p + (i << width),
+                 transfer_p->src_p,
+                 0,
+                 width);
+            break;
+
+        default:
+            copy(transfer_p->dst_p, transfer_p->src_p, i, width);
+            break;
+        }
+    }
+
+    transfer_complete_isr(self_p, 0);
+}
+
+static int dma_port_module_init(void)
+{
+    return (0);
+}
+
+static int dma_port_channel_alloc(struct dma_driver_t *self_p,
+                                  int request)
+{
+    struct dma_device_t *dev_p;
+    int i;
+
+    dev_p = self_p->dev_p;
+
+    for (i = 0; i < DMA_PORT_CHANNELS_MAX; i++) {
+        if (dev_p->channels[i] == NULL) {
+            dev_p->channels[i] = self_p;
+            self_p->channel = i;
+
+            return (0);
+        }
+    }
+
+    return (-EBUSY);
+}
+
+static void dma_port_channel_free(struct dma_driver_t *self_p)
+{
+    self_p->dev_p->channels[self_p->channel] = NULL;
+}
+
+static int dma_port_start(struct dma_driver_t *self_p,
+                          struct dma_transfer_t *transfer_p)
+{
+    struct time_t timeout;
+    int flags;
+
+    timeout.seconds = 0;
+    timeout.nanoseconds = 1000000;
+
+    if (transfer_p->flags & DMA_CIRCULAR) {
+        flags = TIMER_PERIODIC;
+    } else {
+        flags = 0;
+    }
+
+    timer_init(&self_p->timer, &timeout, timer_cb, self_p, flags);
+
+    return (timer_start_isr(&self_p->timer));
+}
+
+static void dma_port_stop(struct dma_driver_t *self_p)
+{
+    timer_stop_isr(&self_p->timer);
+}
+
+static ssize_t dma_port_get_remaining(struct dma_driver_t *self_p)
+{
+    return (self_p->transfer_p->length);
+}
@@ -35,8 +35,17 @@
 #define I2C_PORT_BAUDRATE_400KBPS  2
 #define I2C_PORT_BAUDRATE_100KBPS  3
 
+/* Transactions are queued and completed by the port. */
+#define I2C_PORT_HAS_ASYNC
+
+struct i2c_transaction_t;
+
 struct i2c_device_t {
     struct i2c_driver_t *drv_p;
+    struct {
+        struct i2c_transaction_t *head_p;
+        struct i2c_transaction_t *tail_p;
+    } transactions;
 };
 
 struct i2c_driver_t {
@@ -57,38 +57,48 @@ static int i2c_port_stop(struct i2c_driver_t *self_p)
     return (0);
 }
 
-static ssize_t i2c_port_read(struct i2c_driver_t *self_p,
-                             int address,
-                             void *buf_p,
-                             size_t size)
-{
-    return (-1);
-}
-
-static ssize_t i2c_port_write(struct i2c_driver_t *self_p,
-                              int address,
-                              const void *buf_p,
-                              size_t size)
+/**
+ * There is no hardware, so the transaction completes
+ * immediately. Written data is forwarded to a connected socket
+ * device, while reads fail.
+ */
+static void i2c_port_transaction_start_isr(
+    struct i2c_transaction_t *transaction_p)
 {
     struct i2c_device_t *dev_p;
+    struct i2c_message_t *message_p;
     ssize_t res;
-
-    dev_p = self_p->dev_p;
-
-    sys_lock();
-
-    if (socket_device_is_i2c_device_connected_isr(dev_p) == 1) {
-        res = socket_device_i2c_device_write_isr(dev_p,
-                                                 address,
-                                                 buf_p,
-                                                 size);
-    } else {
-        res = size;
+    ssize_t size;
+    int i;
+
+    dev_p = transaction_p->drv_p->dev_p;
+    message_p = transaction_p->messages_p;
+    res = 0;
+
+    for (i = 0; i < transaction_p->length; i++, message_p++) {
+        if (message_p->flags & I2C_MESSAGE_READ) {
+            res = -1;
+            break;
+        }
+
+        if (socket_device_is_i2c_device_connected_isr(dev_p) == 1) {
+            size = socket_device_i2c_device_write_isr(dev_p,
+                                                      transaction_p->address,
+                                                      message_p->buf_p,
+                                                      message_p->size);
+        } else {
+            size = message_p->size;
+        }
+
+        if (size < 0) {
+            res = size;
+            break;
+        }
+
+        res += size;
     }
 
-    sys_unlock();
-
-    return (res);
+    transaction_complete_isr(dev_p, res);
 }
 
 static int i2c_port_scan(struct i2c_driver_t *self_p,
@@ -82,14 +82,13 @@ int pin_port_device_write_high(const struct pin_device_t *dev_p)
     d_p = (struct pin_device_t *)dev_p;
     d_p->value = 1;
 
-    sys_lock();
-
+    /* Pins may be written from interrupt context and with the system
+       lock taken, so the lock is not taken here. A client
+       disconnecting meanwhile only makes the write fail. */
     if (socket_device_is_pin_device_connected_isr(d_p) == 1) {
         socket_device_pin_device_write_isr(d_p, "high\r\n", 6);
     }
 
-    sys_unlock();
-
     return (0);
 }
 
@@ -100,13 +99,12 @@ int pin_port_device_write_low(const struct pin_device_t *dev_p)
     d_p = (struct pin_device_t *)dev_p;
     d_p->value = 0;
 
-    sys_lock();
-
+    /* Pins may be written from interrupt context and with the system
+       lock taken, so the lock is not taken here. A client
+       disconnecting meanwhile only makes the write fail. */
     if (socket_device_is_pin_device_connected_isr(d_p) == 1) {
         socket_device_pin_device_write_isr(d_p, "low\r\n", 5);
     }
 
-    sys_unlock();
-
     return (0);
 }
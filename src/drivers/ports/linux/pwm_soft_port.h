@@ -32,4 +32,8 @@
 struct pwm_soft_port_module_t {
 };
 
+struct pwm_soft_port_pins_t {
+    struct pin_device_t *pin_dev_p;
+};
+
 #endif
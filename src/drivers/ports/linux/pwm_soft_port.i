@@ -26,12 +26,67 @@
  * This file is part of the Simba project.
  */
 
-static int pwm_soft_port_module_init()
+static int pwm_soft_port_module_init(long frequency)
 {
+    /* One microsecond resolution. */
+    module.duty_cycle_max = (1000000L / frequency);
+    clear_tables();
+
     return (0);
 }
 
 static int pwm_soft_port_set_frequency(long value)
 {
+    module.duty_cycle_max = (1000000L / value);
+    clear_tables();
+
     return (0);
 }
+
+static int pwm_soft_port_pins_add(struct pwm_soft_port_pins_t *pins_p,
+                                  int length,
+                                  struct pin_device_t *pin_dev_p)
+{
+    pins_p[length].pin_dev_p = pin_dev_p;
+
+    return (length + 1);
+}
+
+static void pwm_soft_port_pins_write_high_isr(
+    const struct pwm_soft_port_pins_t *pins_p,
+    int length)
+{
+    int i;
+
+    for (i = 0; i < length; i++) {
+        pin_device_write_high(pins_p[i].pin_dev_p);
+    }
+}
+
+static void pwm_soft_port_pins_write_low_isr(
+    const struct pwm_soft_port_pins_t *pins_p,
+    int length)
+{
+    int i;
+
+    for (i = 0; i < length; i++) {
+        pin_device_write_low(pins_p[i].pin_dev_p);
+    }
+}
+
+/**
+ * There is no timer interrupt. Run the edges until the end of the
+ * period, where the pending table is swapped in and its high pins
+ * are written.
+ */
+static void pwm_soft_port_tables_updated(void)
+{
+    sys_lock();
+
+    do {
+        advance_edge_isr();
+        write_edge_isr();
+    } while (module.pending == 1);
+
+    sys_unlock();
+}
@@ -30,8 +30,13 @@
 
 #include <pthread.h>
 #include <unistd.h>
+#include <time.h>
+#include <poll.h>
 #include <sys/types.h>
 #include <sys/socket.h>
+#include <sys/un.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
 #include <netdb.h>
 
 /**
@@ -48,6 +53,19 @@
 #define TYPE_CAN_DEVICE_RESPONSE                          (8)
 #define TYPE_I2C_DEVICE_REQUEST                           (9)
 #define TYPE_I2C_DEVICE_RESPONSE                         (10)
+#define TYPE_CAN_DEVICE_BINARY_REQUEST                   (13)
+#define TYPE_CAN_DEVICE_BINARY_RESPONSE                  (14)
+
+/**
+ * Binary CAN frame flags.
+ */
+#define CAN_BINARY_FLAGS_EXTENDED_FRAME                BIT(0)
+#define CAN_BINARY_FLAGS_RTR                           BIT(1)
+
+/**
+ * Maximum number of bytes read from a client socket at a time.
+ */
+#define READ_SIZE_MAX                                     1024
 
 /**
  * Convert given device pointer to its index.
@@ -81,6 +99,39 @@ struct device_response_t {
     int32_t result;
 };
 
+/**
+ * A CAN frame in the binary protocol, with the id in network byte
+ * order.
+ */
+struct can_binary_frame_t {
+    uint32_t id;
+    uint8_t flags;
+    uint8_t size;
+    uint8_t reserved[2];
+    uint8_t data[8];
+} __attribute__ ((packed));
+
+/**
+ * Throughput counters of a client connection.
+ */
+struct counters_t {
+    uint64_t rx_bytes;
+    uint64_t tx_bytes;
+    struct timespec connected;
+};
+
+/**
+ * Buffered reads from a client socket, to parse messages without a
+ * system call per field.
+ */
+struct reader_t {
+    int socket;
+    struct counters_t *counters_p;
+    size_t pos;
+    size_t size;
+    uint8_t buf[READ_SIZE_MAX];
+};
+
 /**
  * The client types.
  */
@@ -89,6 +140,7 @@ struct uart_client_t {
     struct uart_device_t *dev_p;
     char name[64];
     pthread_t thrd;
+    struct counters_t counters;
 };
 
 struct pin_client_t {
@@ -96,6 +148,7 @@ struct pin_client_t {
     struct pin_device_t *dev_p;
     char name[64];
     pthread_t thrd;
+    struct counters_t counters;
 };
 
 struct pwm_client_t {
@@ -103,13 +156,16 @@ struct pwm_client_t {
     struct pwm_device_t *dev_p;
     char name[64];
     pthread_t thrd;
+    struct counters_t counters;
 };
 
 struct can_client_t {
     int socket;
+    int binary;
     struct can_device_t *dev_p;
     char name[64];
     pthread_t thrd;
+    struct counters_t counters;
 };
 
 struct i2c_client_t {
@@ -117,6 +173,7 @@ struct i2c_client_t {
     struct i2c_device_t *dev_p;
     char name[64];
     pthread_t thrd;
+    struct counters_t counters;
 };
 
 static struct uart_client_t uart_clients[UART_DEVICE_MAX];
@@ -126,14 +183,141 @@ static struct can_client_t can_clients[CAN_DEVICE_MAX];
 static struct i2c_client_t i2c_clients[I2C_DEVICE_MAX];
 static struct module_t module;
 
+static void counters_init(struct counters_t *self_p)
+{
+    self_p->rx_bytes = 0;
+    self_p->tx_bytes = 0;
+    clock_gettime(CLOCK_MONOTONIC, &self_p->connected);
+}
+
+/**
+ * Print the disconnect message with the number of transferred bytes
+ * and the average throughput of the connection.
+ */
+static void print_disconnected(const char *type_p,
+                               const char *name_p,
+                               struct counters_t *counters_p)
+{
+    struct timespec now;
+    double seconds;
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    seconds = ((now.tv_sec - counters_p->connected.tv_sec)
+               + (now.tv_nsec - counters_p->connected.tv_nsec) / 1e9);
+
+    if (seconds <= 0.0) {
+        seconds = 1e-9;
+    }
+
+    printf("socket_device: %s device %s disconnected "
+           "(rx: %llu bytes, %.1f kB/s, tx: %llu bytes, %.1f kB/s)\n",
+           type_p,
+           name_p,
+           (unsigned long long)counters_p->rx_bytes,
+           counters_p->rx_bytes / seconds / 1000.0,
+           (unsigned long long)counters_p->tx_bytes,
+           counters_p->tx_bytes / seconds / 1000.0);
+    fflush(stdout);
+}
+
+static void reader_init(struct reader_t *self_p,
+                        int socket,
+                        struct counters_t *counters_p)
+{
+    self_p->socket = socket;
+    self_p->counters_p = counters_p;
+    self_p->pos = 0;
+    self_p->size = 0;
+}
+
+/**
+ * Read exactly given number of bytes.
+ *
+ * @return Number of read bytes, or zero(0) if the connection was
+ *         closed.
+ */
+static ssize_t reader_read(struct reader_t *self_p,
+                           void *buf_p,
+                           size_t size)
+{
+    uint8_t *u8_buf_p;
+    ssize_t res;
+    size_t left;
+    size_t n;
+
+    u8_buf_p = buf_p;
+    left = size;
+
+    while (left > 0) {
+        if (self_p->pos == self_p->size) {
+            res = read(self_p->socket, &self_p->buf[0], sizeof(self_p->buf));
+
+            if (res <= 0) {
+                return (0);
+            }
+
+            self_p->counters_p->rx_bytes += res;
+            self_p->pos = 0;
+            self_p->size = res;
+        }
+
+        n = MIN(left, self_p->size - self_p->pos);
+        memcpy(u8_buf_p, &self_p->buf[self_p->pos], n);
+        self_p->pos += n;
+        u8_buf_p += n;
+        left -= n;
+    }
+
+    return (size);
+}
+
 /**
- * Handle a UART client connection.
+ * Read and discard input data until the connection is closed.
+ */
+static void discard_input(int socket, struct counters_t *counters_p)
+{
+    uint8_t buf[READ_SIZE_MAX];
+    ssize_t size;
+
+    while (1) {
+        size = read(socket, &buf[0], sizeof(buf));
+
+        if (size <= 0) {
+            break;
+        }
+
+        counters_p->rx_bytes += size;
+    }
+}
+
+/**
+ * Write given buffer to a client.
+ */
+static ssize_t client_write(int socket,
+                            struct counters_t *counters_p,
+                            const void *buf_p,
+                            size_t size)
+{
+    ssize_t res;
+
+    res = write(socket, buf_p, size);
+
+    if (res > 0) {
+        counters_p->tx_bytes += res;
+    }
+
+    return (res);
+}
+
+/**
+ * Handle a UART client connection. All data available in the socket
+ * is input to the driver at once.
  */
 static void *uart_client_main(void *arg_p)
 {
     struct uart_client_t *client_p;
     ssize_t size;
-    uint8_t byte;
+    uint8_t buf[READ_SIZE_MAX];
 
     client_p = arg_p;
 
@@ -142,29 +326,23 @@ static void *uart_client_main(void *arg_p)
     fflush(stdout);
 
     while (1) {
-        size = read(client_p->socket, &byte, sizeof(byte));
+        size = read(client_p->socket, &buf[0], sizeof(buf));
 
-        if (size != sizeof(byte)) {
+        if (size <= 0) {
             break;
         }
 
-        sys_lock();
-
-        if (client_p->dev_p->drv_p != NULL) {
-            queue_write_isr(&client_p->dev_p->drv_p->base,
-                            &byte,
-                            sizeof(byte));
-        }
+        client_p->counters.rx_bytes += size;
 
+        sys_lock();
+        uart_port_device_rx_isr(client_p->dev_p, &buf[0], size);
         sys_unlock();
     }
 
     close(client_p->socket);
     client_p->socket = -2;
 
-    printf("socket_device: uart device %s disconnected\n",
-           &client_p->name[0]);
-    fflush(stdout);
+    print_disconnected("uart", &client_p->name[0], &client_p->counters);
 
     return (NULL);
 }
@@ -215,6 +393,7 @@ static int handle_uart_device_request(struct device_request_t *request_p,
     if (res == sizeof(response)) {
         uart_clients[index].socket = client;
         uart_clients[index].dev_p = &uart_device[index];
+        counters_init(&uart_clients[index].counters);
         strcpy(&uart_clients[index].name[0], device_p);
         res = pthread_create(&uart_clients[index].thrd,
                              NULL,
@@ -235,8 +414,6 @@ static int handle_uart_device_request(struct device_request_t *request_p,
 static void *pin_client_main(void *arg_p)
 {
     struct pin_client_t *client_p;
-    ssize_t size;
-    uint8_t byte;
 
     client_p = arg_p;
 
@@ -244,22 +421,13 @@ static void *pin_client_main(void *arg_p)
            &client_p->name[0]);
     fflush(stdout);
 
-    while (1) {
-        size = read(client_p->socket, &byte, sizeof(byte));
-
-        if (size != sizeof(byte)) {
-            break;
-        }
-
-        /* Discard input data for now. */
-    }
+    /* Discard input data for now. */
+    discard_input(client_p->socket, &client_p->counters);
 
     close(client_p->socket);
     client_p->socket = -2;
 
-    printf("socket_device: pin device %s disconnected\n",
-           &client_p->name[0]);
-    fflush(stdout);
+    print_disconnected("pin", &client_p->name[0], &client_p->counters);
 
     return (NULL);
 }
@@ -314,6 +482,7 @@ static int handle_pin_device_request(struct device_request_t *request_p,
     if (res == sizeof(response)) {
         pin_clients[index].socket = client;
         pin_clients[index].dev_p = &pin_device[index];
+        counters_init(&pin_clients[index].counters);
         strcpy(&pin_clients[index].name[0], device_p);
         res = pthread_create(&pin_clients[index].thrd,
                              NULL,
@@ -336,8 +505,6 @@ static int handle_pin_device_request(struct device_request_t *request_p,
 static void *pwm_client_main(void *arg_p)
 {
     struct pwm_client_t *client_p;
-    ssize_t size;
-    uint8_t byte;
 
     client_p = arg_p;
 
@@ -345,22 +512,13 @@ static void *pwm_client_main(void *arg_p)
            &client_p->name[0]);
     fflush(stdout);
 
-    while (1) {
-        size = read(client_p->socket, &byte, sizeof(byte));
-
-        if (size != sizeof(byte)) {
-            break;
-        }
-
-        /* Discard input data for now. */
-    }
+    /* Discard input data for now. */
+    discard_input(client_p->socket, &client_p->counters);
 
     close(client_p->socket);
     client_p->socket = -2;
 
-    printf("socket_device: pwm device %s disconnected\n",
-           &client_p->name[0]);
-    fflush(stdout);
+    print_disconnected("pwm", &client_p->name[0], &client_p->counters);
 
     return (NULL);
 }
@@ -424,6 +582,7 @@ static int handle_pwm_device_request(struct device_request_t *request_p,
     if (res == sizeof(response)) {
         pwm_clients[index].socket = client;
         pwm_clients[index].dev_p = &pwm_device[index];
+        counters_init(&pwm_clients[index].counters);
         strcpy(&pwm_clients[index].name[0], device_p);
         res = pthread_create(&pwm_clients[index].thrd,
                              NULL,
@@ -441,122 +600,168 @@ static int handle_pwm_device_request(struct device_request_t *request_p,
 #endif
 
 /**
- * Handle a can client connection.
+ * Read a frame on the text format
+ * ``id=<id>,extended=<extended>,size=<size>,data=<data>\r\n``.
+ *
+ * @return one(1) if a frame was read, zero(0) if the connection was
+ *         closed, and otherwise negative error code.
  */
-static void *can_client_main(void *arg_p)
+static int can_read_text_frame(struct reader_t *reader_p,
+                               struct can_frame_t *frame_p)
 {
-    struct can_client_t *client_p;
-    ssize_t size;
-    char buf[64];
-    struct can_frame_t frame;
+    char buf[36];
     int frame_size;
-    long value;
-    size_t i;
     int extended_frame;
+    long value;
+    int i;
 
-    client_p = arg_p;
+    if (reader_read(reader_p, &buf[0], 35) != 35) {
+        return (0);
+    }
 
-    printf("socket_device: can device %s connected\n",
-           &client_p->name[0]);
-    fflush(stdout);
+    buf[35] = '\0';
 
-    while (1) {
-        size = read(client_p->socket, &buf[0], 35);
+    if (sscanf(&buf[0],
+               "id=%08x,extended=%d,size=%d,data=",
+               &frame_p->id,
+               &extended_frame,
+               &frame_size) != 3) {
+        printf("warning: bad can message received: %s\n", &buf[0]);
+        fflush(stdout);
 
-        if (size == 0) {
-            break;
-        } else if (size != 35) {
-            printf("warning: bad can line size %d\n", (int)size);
-            fflush(stdout);
-            continue;
-        }
+        return (-1);
+    }
 
-        size = sscanf(&buf[0],
-                      "id=%08x,extended=%d,size=%d,data=",
-                      &frame.id,
-                      &extended_frame,
-                      &frame_size);
+    if ((extended_frame != 0) && (extended_frame != 1)) {
+        printf("warning: bad can message exteneded frame: %d\n",
+               extended_frame);
+        fflush(stdout);
 
-        frame.extended_frame = extended_frame;
+        return (-1);
+    }
 
-        if (size != 3) {
-            printf("warning: bad can message received: %s\n", &buf[0]);
-            fflush(stdout);
-            continue;
-        }
+    if ((frame_size < 0) || (frame_size > 8)) {
+        printf("warning: bad can message size: %d\n", frame_size);
+        fflush(stdout);
 
-        if ((frame.extended_frame != 0) && (frame.extended_frame != 1)) {
-            printf("warning: bad can message exteneded frame: %d\n",
-                   frame.extended_frame);
-            fflush(stdout);
-            continue;
+        return (-1);
+    }
+
+    frame_p->extended_frame = extended_frame;
+    frame_p->rtr = 0;
+    frame_p->size = frame_size;
+
+    /* Read the data. */
+    buf[0] = '0';
+    buf[1] = 'x';
+    buf[4] = '\0';
+
+    for (i = 0; i < frame_size; i++) {
+        if (reader_read(reader_p, &buf[2], 2) != 2) {
+            return (0);
         }
 
-        if (frame_size > 8) {
-            printf("warning: bad can message size: %d\n", frame_size);
-            fflush(stdout);
-            continue;
+        if (std_strtol(&buf[0], &value) == NULL) {
+            return (-1);
         }
 
-        frame.size = frame_size;
+        frame_p->data.u8[i] = value;
+    }
 
-        /* Read the data, one byte at a time. */
-        buf[0] = '0';
-        buf[1] = 'x';
-        buf[4] = '\0';
+    /* Read the line terminator. */
+    if (reader_read(reader_p, &buf[0], 2) != 2) {
+        return (0);
+    }
 
-        for (i = 0; i < frame_size; i++) {
-            size = read(client_p->socket, &buf[2], 2);
+    return (1);
+}
 
-            if (size == 0) {
-                break;
-            } else if (size != 2) {
-                printf("warning: bad can line size %d\n", (int)size);
-                fflush(stdout);
-                size = -1;
-                break;
-            }
+/**
+ * Read a frame on the binary format.
+ *
+ * @return one(1) if a frame was read, zero(0) if the connection was
+ *         closed, and otherwise negative error code.
+ */
+static int can_read_binary_frame(struct reader_t *reader_p,
+                                 struct can_frame_t *frame_p)
+{
+    struct can_binary_frame_t binary_frame;
 
-            if (std_strtol(&buf[0], &value) == NULL) {
-                size = -1;
-                break;
-            }
+    if (reader_read(reader_p,
+                    &binary_frame,
+                    sizeof(binary_frame)) != sizeof(binary_frame)) {
+        return (0);
+    }
+
+    if (binary_frame.size > 8) {
+        printf("warning: bad can message size: %d\n", binary_frame.size);
+        fflush(stdout);
+
+        return (-1);
+    }
+
+    frame_p->id = ntohl(binary_frame.id);
+    frame_p->extended_frame =
+        ((binary_frame.flags & CAN_BINARY_FLAGS_EXTENDED_FRAME) != 0);
+    frame_p->rtr = ((binary_frame.flags & CAN_BINARY_FLAGS_RTR) != 0);
+    frame_p->size = binary_frame.size;
+    memcpy(&frame_p->data.u8[0],
+           &binary_frame.data[0],
+           sizeof(frame_p->data.u8));
 
-            frame.data.u8[i] = value;
+    return (1);
+}
+
+/**
+ * Handle a can client connection.
+ */
+static void *can_client_main(void *arg_p)
+{
+    struct can_client_t *client_p;
+    struct reader_t reader;
+    struct can_frame_t frame;
+    int res;
+
+    client_p = arg_p;
+    reader_init(&reader, client_p->socket, &client_p->counters);
+
+    printf("socket_device: can device %s connected\n",
+           &client_p->name[0]);
+    fflush(stdout);
+
+    while (1) {
+        if (client_p->binary == 1) {
+            res = can_read_binary_frame(&reader, &frame);
+        } else {
+            res = can_read_text_frame(&reader, &frame);
         }
 
-        if (size == 0) {
+        if (res == 0) {
             break;
-        } else if (size == -1) {
+        } else if (res < 0) {
             continue;
         }
 
-        /* Read the line terminator. */
-        read(client_p->socket, &buf[0], 2);
-
         sys_lock();
-
-        if (client_p->dev_p->drv_p != NULL) {
-            queue_write_isr(&client_p->dev_p->drv_p->chin,
-                            &frame,
-                            sizeof(frame));
-        }
-
+        can_port_device_rx_isr(client_p->dev_p, &frame);
         sys_unlock();
     }
 
     close(client_p->socket);
     client_p->socket = -2;
 
-    printf("socket_device: can device %s disconnected\n",
-           &client_p->name[0]);
-    fflush(stdout);
+    print_disconnected("can", &client_p->name[0], &client_p->counters);
 
     return (NULL);
 }
 
+/**
+ * Handle a can device request. Frames are sent and received on the
+ * binary format if binary is true, and otherwise on the text format.
+ */
 static int handle_can_device_request(struct device_request_t *request_p,
-                                      int client)
+                                     int client,
+                                     int binary)
 {
     struct device_response_t response;
     int res;
@@ -573,7 +778,9 @@ static int handle_can_device_request(struct device_request_t *request_p,
     }
 
     /* Prepare the response. */
-    response.header.type = htonl(TYPE_CAN_DEVICE_RESPONSE);
+    response.header.type = htonl(binary == 1
+                                 ? TYPE_CAN_DEVICE_BINARY_RESPONSE
+                                 : TYPE_CAN_DEVICE_RESPONSE);
     response.header.size = htonl(4);
 
     if ((index < 0) || (index >= CAN_DEVICE_MAX)) {
@@ -599,8 +806,10 @@ static int handle_can_device_request(struct device_request_t *request_p,
 
     /* Start the client thread if everything went well so far. */
     if (res == sizeof(response)) {
+        can_clients[index].binary = binary;
         can_clients[index].socket = client;
         can_clients[index].dev_p = &can_device[index];
+        counters_init(&can_clients[index].counters);
         strcpy(&can_clients[index].name[0], device_p);
         res = pthread_create(&can_clients[index].thrd,
                              NULL,
@@ -621,8 +830,6 @@ static int handle_can_device_request(struct device_request_t *request_p,
 static void *i2c_client_main(void *arg_p)
 {
     struct i2c_client_t *client_p;
-    ssize_t size;
-    uint8_t byte;
 
     client_p = arg_p;
 
@@ -630,22 +837,13 @@ static void *i2c_client_main(void *arg_p)
            &client_p->name[0]);
     fflush(stdout);
 
-    while (1) {
-        size = read(client_p->socket, &byte, sizeof(byte));
-
-        if (size == 0) {
-            break;
-        }
-
-        /* Discard input data for now. */
-    }
+    /* Discard input data for now. */
+    discard_input(client_p->socket, &client_p->counters);
 
     close(client_p->socket);
     client_p->socket = -2;
 
-    printf("socket_device: i2c device %s disconnected\n",
-           &client_p->name[0]);
-    fflush(stdout);
+    print_disconnected("i2c", &client_p->name[0], &client_p->counters);
 
     return (NULL);
 }
@@ -696,6 +894,7 @@ static int handle_i2c_device_request(struct device_request_t *request_p,
     if (res == sizeof(response)) {
         i2c_clients[index].socket = client;
         i2c_clients[index].dev_p = &i2c_device[index];
+        counters_init(&i2c_clients[index].counters);
         strcpy(&i2c_clients[index].name[0], device_p);
         res = pthread_create(&i2c_clients[index].thrd,
                              NULL,
@@ -711,9 +910,9 @@ static int handle_i2c_device_request(struct device_request_t *request_p,
 }
 
 /**
- * Setup the listener socket.
+ * Setup the TCP listener socket.
  */
-static int setup_listener(void)
+static int setup_tcp_listener(void)
 {
     int listener;
     int yes;
@@ -784,91 +983,189 @@ static int setup_listener(void)
 }
 
 /**
- * Entry function of the socket device listener thread.
+ * Setup the Unix domain listener socket, for clients on the same
+ * host. It avoids the TCP/IP stack and is considerably faster than
+ * the TCP socket.
  */
-static void *listener_main(void *arg_p)
+static int setup_unix_listener(void)
 {
     int listener;
-    int client;
+    int res;
+    struct sockaddr_un addr;
+
+    listener = socket(AF_UNIX, SOCK_STREAM, 0);
+
+    if (listener == -1) {
+        perror("socket_device: socket");
+
+        return (-1);
+    }
+
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    strncpy(&addr.sun_path[0],
+            CONFIG_LINUX_SOCKET_DEVICE_UNIX_PATH,
+            sizeof(addr.sun_path) - 1);
+
+    /* Remove the socket file of a previous run. */
+    unlink(&addr.sun_path[0]);
+
+    res = bind(listener, (struct sockaddr *)&addr, sizeof(addr));
+
+    if (res == -1) {
+        perror("socket_device: bind");
+
+        goto close_socket;
+    }
+
+    res = listen(listener, 3);
+
+    if (res == -1) {
+        perror("socket_device: listen");
+
+        goto close_socket;
+    }
+
+    return (listener);
+
+ close_socket:
+    close(listener);
+
+    return (res);
+}
+
+/**
+ * Read the device request from given client and start the client
+ * thread.
+ */
+static void handle_client(int client)
+{
     ssize_t size;
     struct device_request_t request;
     struct header_t response;
     int res;
 
-    listener = setup_listener();
+    /* Read the request header. */
+    size = read(client, &request.header, sizeof(request.header));
 
-    if (listener < 0) {
-        printf("warning: socket_device: failed to setup listener socket\n");
-        fflush(stdout);
+    if (size != sizeof(request.header)) {
+        perror("socket_device: read request");
+        close(client);
 
-        return (NULL);
+        return;
     }
 
-    printf("info: socket_device: listening for clients on TCP port 47000\n");
-    fflush(stdout);
+    /* Host byte order. */
+    request.header.type = ntohl(request.header.type);
+    request.header.size = ntohl(request.header.size);
 
-    while (1) {
-        client = accept(listener, NULL, NULL);
+    /* Validate the size. */
+    if (request.header.size >= sizeof(request.device)) {
+        perror("socket_device: read request size");
+        close(client);
 
-        if (client == -1) {
-            perror("socket_device: accept");
-            continue;
-        }
+        return;
+    }
 
-        /* Read the request header. */
-        size = read(client, &request.header, sizeof(request.header));
+    /* Read the device name. */
+    size = read(client, &request.device[0], request.header.size);
 
-        if (size != sizeof(request.header)) {
-            perror("socket_device: read request");
-            close(client);
-            continue;
-        }
+    if (size != request.header.size) {
+        perror("socket_device: read request device name size");
+        close(client);
 
-        /* Host byte order. */
-        request.header.type = ntohl(request.header.type);
-        request.header.size = ntohl(request.header.size);
+        return;
+    }
 
-        /* Validate the size. */
-        if (request.header.size >= sizeof(request.device)) {
-            perror("socket_device: read request size");
-            close(client);
-            continue;
-        }
+    request.device[request.header.size] = '\0';
 
-        /* Read the device name. */
-        size = read(client, &request.device[0], request.header.size);
+    /* Handle the request type. */
+    if (request.header.type == TYPE_UART_DEVICE_REQUEST) {
+        res = handle_uart_device_request(&request, client);
+    } else if (request.header.type == TYPE_PIN_DEVICE_REQUEST) {
+        res = handle_pin_device_request(&request, client);
+#if CONFIG_PWM == 1
+    } else if (request.header.type == TYPE_PWM_DEVICE_REQUEST) {
+        res = handle_pwm_device_request(&request, client);
+#endif
+    } else if (request.header.type == TYPE_CAN_DEVICE_REQUEST) {
+        res = handle_can_device_request(&request, client, 0);
+    } else if (request.header.type == TYPE_CAN_DEVICE_BINARY_REQUEST) {
+        res = handle_can_device_request(&request, client, 1);
+    } else if (request.header.type == TYPE_I2C_DEVICE_REQUEST) {
+        res = handle_i2c_device_request(&request, client);
+    } else {
+        /* Send the response. */
+        response.type = htonl(TYPE_UNSUPPORTED_TYPE);
+        response.size = htonl(0);
+        write(client, &response, sizeof(response));
+        res = -1;
+    }
 
-        if (size != request.header.size) {
-            perror("socket_device: read request device name size");
-            close(client);
+    if (res != 0) {
+        close(client);
+    }
+}
+
+/**
+ * Entry function of the socket device listener thread.
+ */
+static void *listener_main(void *arg_p)
+{
+    struct pollfd fds[2];
+    int client;
+    int yes;
+    int i;
+
+    fds[0].fd = setup_tcp_listener();
+    fds[0].events = POLLIN;
+    fds[1].fd = setup_unix_listener();
+    fds[1].events = POLLIN;
+
+    if ((fds[0].fd < 0) && (fds[1].fd < 0)) {
+        printf("warning: socket_device: failed to setup listener socket\n");
+        fflush(stdout);
+
+        return (NULL);
+    }
+
+    if (fds[0].fd >= 0) {
+        printf("info: socket_device: listening for clients on TCP port "
+               "47000\n");
+    }
+
+    if (fds[1].fd >= 0) {
+        printf("info: socket_device: listening for clients on %s\n",
+               CONFIG_LINUX_SOCKET_DEVICE_UNIX_PATH);
+    }
+
+    fflush(stdout);
+
+    while (1) {
+        if (poll(&fds[0], membersof(fds), -1) <= 0) {
             continue;
         }
 
-        request.device[request.header.size] = '\0';
+        for (i = 0; i < membersof(fds); i++) {
+            if ((fds[i].revents & POLLIN) == 0) {
+                continue;
+            }
 
-        /* Handle the request type. */
-        if (request.header.type == TYPE_UART_DEVICE_REQUEST) {
-            res = handle_uart_device_request(&request, client);
-        } else if (request.header.type == TYPE_PIN_DEVICE_REQUEST) {
-            res = handle_pin_device_request(&request, client);
-#if CONFIG_PWM == 1
-        } else if (request.header.type == TYPE_PWM_DEVICE_REQUEST) {
-            res = handle_pwm_device_request(&request, client);
-#endif
-        } else if (request.header.type == TYPE_CAN_DEVICE_REQUEST) {
-            res = handle_can_device_request(&request, client);
-        } else if (request.header.type == TYPE_I2C_DEVICE_REQUEST) {
-            res = handle_i2c_device_request(&request, client);
-        } else {
-            /* Send the response. */
-            response.type = htonl(TYPE_UNSUPPORTED_TYPE);
-            response.size = htonl(0);
-            write(client, &response, sizeof(response));
-            res = -1;
-        }
+            client = accept(fds[i].fd, NULL, NULL);
 
-        if (res != 0) {
-            close(client);
+            if (client == -1) {
+                perror("socket_device: accept");
+                continue;
+            }
+
+            /* Send small messages, for example single characters
+               written to a UART, immediately. */
+            if (i == 0) {
+                yes = 1;
+                setsockopt(client, IPPROTO_TCP, TCP_NODELAY, &yes, sizeof(yes));
+            }
+
+            handle_client(client);
         }
     }
 
@@ -939,7 +1236,11 @@ ssize_t socket_device_uart_device_write_isr(
     const void *buf_p,
     size_t size)
 {
-    return (write(uart_clients[UART_INDEX(dev_p)].socket, buf_p, size));
+    struct uart_client_t *client_p;
+
+    client_p = &uart_clients[UART_INDEX(dev_p)];
+
+    return (client_write(client_p->socket, &client_p->counters, buf_p, size));
 }
 
 int socket_device_is_pin_device_connected_isr(
@@ -956,7 +1257,11 @@ ssize_t socket_device_pin_device_write_isr(const struct pin_device_t *dev_p,
                                            const void *buf_p,
                                            size_t size)
 {
-    return (write(pin_clients[PIN_INDEX(dev_p)].socket, buf_p, size));
+    struct pin_client_t *client_p;
+
+    client_p = &pin_clients[PIN_INDEX(dev_p)];
+
+    return (client_write(client_p->socket, &client_p->counters, buf_p, size));
 }
 
 int socket_device_is_pwm_device_connected_isr(
@@ -973,7 +1278,11 @@ ssize_t socket_device_pwm_device_write_isr(const struct pwm_device_t *dev_p,
                                            const void *buf_p,
                                            size_t size)
 {
-    return (write(pwm_clients[PWM_INDEX(dev_p)].socket, buf_p, size));
+    struct pwm_client_t *client_p;
+
+    client_p = &pwm_clients[PWM_INDEX(dev_p)];
+
+    return (client_write(client_p->socket, &client_p->counters, buf_p, size));
 }
 
 int socket_device_is_can_device_connected_isr(
@@ -991,42 +1300,64 @@ ssize_t socket_device_can_device_write_isr(const struct can_device_t *dev_p,
                                            size_t size)
 {
     const struct can_frame_t *frame_p;
+    struct can_client_t *client_p;
+    struct can_binary_frame_t binary_frame;
     char buf[64];
     ssize_t res;
-    int socket;
+    size_t length;
     size_t i;
 
-    socket = can_clients[CAN_INDEX(dev_p)].socket;
-
+    client_p = &can_clients[CAN_INDEX(dev_p)];
     frame_p = (struct can_frame_t *)buf_p;
 
-    /* Format the line to send to the client. */
-    sprintf(&buf[0],
-            "id=%08x,extended=%d,size=%d,data=",
-            frame_p->id,
-            (int)frame_p->extended_frame,
-            (int)frame_p->size);
+    if (client_p->binary == 1) {
+        binary_frame.id = htonl(frame_p->id);
+        binary_frame.flags = 0;
 
-    res = write(socket, &buf[0], strlen(&buf[0]));
+        if (frame_p->extended_frame == 1) {
+            binary_frame.flags |= CAN_BINARY_FLAGS_EXTENDED_FRAME;
+        }
 
-    if (res != strlen(&buf[0])) {
-        return (-1);
-    }
+        if (frame_p->rtr == 1) {
+            binary_frame.flags |= CAN_BINARY_FLAGS_RTR;
+        }
 
-    /* Write the data, one byte at a time. */
-    for (i = 0; i < frame_p->size; i++) {
-        sprintf(&buf[0], "%02x", frame_p->data.u8[i]);
+        binary_frame.size = frame_p->size;
+        binary_frame.reserved[0] = 0;
+        binary_frame.reserved[1] = 0;
+        memcpy(&binary_frame.data[0],
+               &frame_p->data.u8[0],
+               sizeof(binary_frame.data));
 
-        res = write(socket, &buf[0], 2);
+        res = client_write(client_p->socket,
+                           &client_p->counters,
+                           &binary_frame,
+                           sizeof(binary_frame));
 
-        if (res != 2) {
+        if (res != sizeof(binary_frame)) {
             return (-1);
         }
+
+        return (size);
     }
 
-    res = write(socket, "\r\n", 2);
+    /* Format the whole line and send it in one write. */
+    length = sprintf(&buf[0],
+                     "id=%08x,extended=%d,size=%d,data=",
+                     frame_p->id,
+                     (int)frame_p->extended_frame,
+                     (int)frame_p->size);
 
-    if (res != 2) {
+    for (i = 0; i < frame_p->size; i++) {
+        length += sprintf(&buf[length], "%02x", frame_p->data.u8[i]);
+    }
+
+    buf[length++] = '\r';
+    buf[length++] = '\n';
+
+    res = client_write(client_p->socket, &client_p->counters, &buf[0], length);
+
+    if (res != length) {
         return (-1);
     }
 
@@ -1048,39 +1379,56 @@ ssize_t socket_device_i2c_device_write_isr(const struct i2c_device_t *dev_p,
                                            const void *buf_p,
                                            size_t size)
 {
-    char buf[64];
+    struct i2c_client_t *client_p;
+    char buf[256];
     ssize_t res;
-    int socket;
+    size_t length;
     size_t i;
     const uint8_t *byte_p;
 
-    socket = i2c_clients[I2C_INDEX(dev_p)].socket;
-
-    /* Write the address. */
-    sprintf(&buf[0], "address=%04x,size=%04lx,data=", address, size);
+    client_p = &i2c_clients[I2C_INDEX(dev_p)];
+    byte_p = buf_p;
 
-    res = write(socket, &buf[0], strlen(&buf[0]));
+    /* Format the line in as few writes as possible, flushing the
+       buffer when full. */
+    length = sprintf(&buf[0], "address=%04x,size=%04lx,data=", address, size);
 
-    if (res != strlen(&buf[0])) {
-        return (-1);
-    }
+    for (i = 0; i < size; i++) {
+        if (length > sizeof(buf) - 3) {
+            res = client_write(client_p->socket,
+                               &client_p->counters,
+                               &buf[0],
+                               length);
+
+            if (res != length) {
+                return (-1);
+            }
 
-    /* Write the data, one byte at a time. */
-    byte_p = buf_p;
+            length = 0;
+        }
 
-    for (i = 0; i < size; i++) {
-        sprintf(&buf[0], "%02x", byte_p[i]);
+        length += sprintf(&buf[length], "%02x", byte_p[i]);
+    }
 
-        res = write(socket, &buf[0], 2);
+    if (length > sizeof(buf) - 2) {
+        res = client_write(client_p->socket,
+                           &client_p->counters,
+                           &buf[0],
+                           length);
 
-        if (res != 2) {
+        if (res != length) {
             return (-1);
         }
+
+        length = 0;
     }
 
-    res = write(socket, "\r\n", 2);
+    buf[length++] = '\r';
+    buf[length++] = '\n';
+
+    res = client_write(client_p->socket, &client_p->counters, &buf[0], length);
 
-    if (res != 2) {
+    if (res != length) {
         return (-1);
     }
 
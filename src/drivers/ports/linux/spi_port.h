@@ -40,11 +40,19 @@
 #define SPI_PORT_SPEED_250KBPS  0
 #define SPI_PORT_SPEED_125KBPS  0
 
+/* Transactions are queued and completed by the port. */
+#define SPI_PORT_HAS_ASYNC
+
 struct spi_driver_t;
+struct spi_transaction_t;
 
 struct spi_device_t {
     struct spi_driver_t *drv_p;
     struct mutex_t mutex;
+    struct {
+        struct spi_transaction_t *head_p;
+        struct spi_transaction_t *tail_p;
+    } transactions;
 };
 
 struct spi_driver_t {
@@ -36,6 +36,8 @@
  */
 #define UART_PORT_FRAME_FORMAT_DEFAULT 0
 
+#define UART_PORT_HAS_FLOW_CONTROL
+
 struct uart_device_t {
     struct uart_driver_t *drv_p;
 };
@@ -46,6 +48,16 @@ struct uart_driver_t {
     struct mutex_t mutex;
     long baudrate;
     int format;
+    struct uart_flow_control_t flow_control;
+    struct thrd_t *thrd_p;                   /* Writer waiting for XON. */
 };
 
+/**
+ * Write given received data to the driver started on given
+ * device. Called by the socket device with the system lock taken.
+ */
+void uart_port_device_rx_isr(struct uart_device_t *dev_p,
+                             const void *buf_p,
+                             size_t size);
+
 #endif
@@ -37,8 +37,36 @@ static int uart_port_module_init()
     return (socket_device_module_init());
 }
 
+static void uart_port_send_char_isr(struct uart_driver_t *self_p,
+                                    uint8_t c)
+{
+    uart_port_write_cb_isr(&self_p->base, &c, 1);
+}
+
+static void uart_port_tx_stop_isr(struct uart_driver_t *self_p)
+{
+}
+
+static void uart_port_tx_resume_isr(struct uart_driver_t *self_p)
+{
+    if (self_p->thrd_p != NULL) {
+        thrd_resume_isr(self_p->thrd_p, 0);
+        self_p->thrd_p = NULL;
+    }
+}
+
+void uart_port_device_rx_isr(struct uart_device_t *dev_p,
+                             const void *buf_p,
+                             size_t size)
+{
+    if (dev_p->drv_p != NULL) {
+        rx_write_isr(dev_p->drv_p, buf_p, size);
+    }
+}
+
 static int uart_port_start(struct uart_driver_t *self_p)
 {
+    self_p->thrd_p = NULL;
     self_p->dev_p->drv_p = self_p;
 
     return (0);
@@ -53,9 +81,19 @@ static ssize_t uart_port_write_cb(void *arg_p,
                                   const void *txbuf_p,
                                   size_t size)
 {
+    struct uart_driver_t *self_p;
     ssize_t res;
 
+    self_p = container_of(arg_p, struct uart_driver_t, base);
+
     sys_lock();
+
+    /* Wait for XON. */
+    while (self_p->flow_control.tx_stopped == 1) {
+        self_p->thrd_p = thrd_self();
+        thrd_suspend_isr(NULL);
+    }
+
     res = uart_port_write_cb_isr(arg_p, txbuf_p, size);
     sys_unlock();
 
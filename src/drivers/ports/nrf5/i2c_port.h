@@ -0,0 +1,65 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2014-2018, Erik Moqvist
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use, copy,
+ * modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ * This file is part of the Simba project.
+ */
+
+#ifndef __DRIVERS_I2C_PORT_H__
+#define __DRIVERS_I2C_PORT_H__
+
+/* Predefined baudrates. The TWIM is limited to 400 kbps. */
+#define I2C_PORT_BAUDRATE_1MBPS          NRF5_TWIM_FREQUENCY_K400
+#define I2C_PORT_BAUDRATE_400KBPS        NRF5_TWIM_FREQUENCY_K400
+#define I2C_PORT_BAUDRATE_100KBPS        NRF5_TWIM_FREQUENCY_K100
+
+/* Transactions are queued and performed with EasyDMA. */
+#define I2C_PORT_HAS_ASYNC
+
+/* Size of the buffer written data not in RAM is copied to, as
+   EasyDMA can only read from RAM. */
+#define I2C_PORT_TXBUF_SIZE 16
+
+struct i2c_transaction_t;
+
+struct i2c_device_t {
+    volatile struct nrf5_twim_t *regs_p;
+    const struct pin_device_t *scl_p;
+    const struct pin_device_t *sda_p;
+    struct i2c_driver_t *drv_p;
+    struct {
+        struct i2c_transaction_t *head_p;
+        struct i2c_transaction_t *tail_p;
+    } transactions;
+    int error;
+    uint8_t txbuf[I2C_PORT_TXBUF_SIZE];
+};
+
+struct i2c_driver_t {
+    struct i2c_device_t *dev_p;
+    int address;
+    uint32_t frequency;
+};
+
+#endif
@@ -0,0 +1,280 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2014-2018, Erik Moqvist
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use, copy,
+ * modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ * This file is part of the Simba project.
+ */
+
+static uint32_t pin_to_psel(const struct pin_device_t *pin_p)
+{
+    return (((pin_p->regs_p == NRF5_GPIO_P1) << 5) | pin_p->pin);
+}
+
+/**
+ * Start given transaction. The TWIM performs a write followed by a
+ * read with a repeated start condition using shortcuts, so a
+ * transaction must be a single read or write, or a write followed by
+ * a read. The transaction is completed by the STOPPED interrupt.
+ */
+static void i2c_port_transaction_start_isr(
+    struct i2c_transaction_t *transaction_p)
+{
+    struct i2c_driver_t *drv_p;
+    struct i2c_device_t *dev_p;
+    volatile struct nrf5_twim_t *regs_p;
+    struct i2c_message_t *message_p;
+    struct i2c_message_t *write_p;
+    struct i2c_message_t *read_p;
+
+    drv_p = transaction_p->drv_p;
+    dev_p = drv_p->dev_p;
+    regs_p = dev_p->regs_p;
+    message_p = transaction_p->messages_p;
+    write_p = NULL;
+    read_p = NULL;
+
+    if ((transaction_p->length == 2)
+        && ((message_p[0].flags & I2C_MESSAGE_READ) == 0)
+        && ((message_p[1].flags & I2C_MESSAGE_READ) != 0)) {
+        write_p = &message_p[0];
+        read_p = &message_p[1];
+    } else if (transaction_p->length == 1) {
+        if (message_p[0].flags & I2C_MESSAGE_READ) {
+            read_p = &message_p[0];
+        } else {
+            write_p = &message_p[0];
+        }
+    } else {
+        transaction_complete_isr(dev_p, -ENOSYS);
+
+        return;
+    }
+
+    if (((write_p != NULL) && (write_p->size > NRF5_EASYDMA_MAXCNT_MAX))
+        || ((read_p != NULL) && (read_p->size > NRF5_EASYDMA_MAXCNT_MAX))) {
+        transaction_complete_isr(dev_p, -EINVAL);
+
+        return;
+    }
+
+    /* Reconfigure the clock if another driver used the bus last. */
+    if (dev_p->drv_p != drv_p) {
+        dev_p->drv_p = drv_p;
+        regs_p->FREQUENCY = drv_p->frequency;
+    }
+
+    dev_p->error = 0;
+    regs_p->ADDRESS = transaction_p->address;
+    regs_p->TXD.MAXCNT = 0;
+    regs_p->RXD.MAXCNT = 0;
+
+    if (write_p != NULL) {
+        if (NRF5_IS_RAM(write_p->buf_p)) {
+            regs_p->TXD.PTR = (uint32_t)write_p->buf_p;
+        } else if (write_p->size <= sizeof(dev_p->txbuf)) {
+            memcpy(&dev_p->txbuf[0], write_p->buf_p, write_p->size);
+            regs_p->TXD.PTR = (uint32_t)&dev_p->txbuf[0];
+        } else {
+            transaction_complete_isr(dev_p, -EINVAL);
+
+            return;
+        }
+
+        regs_p->TXD.MAXCNT = write_p->size;
+    }
+
+    if (read_p != NULL) {
+        regs_p->RXD.PTR = (uint32_t)read_p->buf_p;
+        regs_p->RXD.MAXCNT = read_p->size;
+    }
+
+    regs_p->EVENTS.STOPPED = 0;
+    regs_p->EVENTS.ERROR = 0;
+
+    /* The hardware sends the repeated start and stop conditions. */
+    if ((write_p != NULL) && (read_p != NULL)) {
+        regs_p->SHORTS = (NRF5_TWIM_SHORTS_LASTTX_STARTRX
+                          | NRF5_TWIM_SHORTS_LASTRX_STOP);
+        regs_p->TASKS.STARTTX = 1;
+    } else if (write_p != NULL) {
+        regs_p->SHORTS = NRF5_TWIM_SHORTS_LASTTX_STOP;
+        regs_p->TASKS.STARTTX = 1;
+    } else {
+        regs_p->SHORTS = NRF5_TWIM_SHORTS_LASTRX_STOP;
+        regs_p->TASKS.STARTRX = 1;
+    }
+}
+
+static void isr(struct i2c_device_t *dev_p)
+{
+    volatile struct nrf5_twim_t *regs_p;
+    ssize_t res;
+
+    regs_p = dev_p->regs_p;
+
+    /* Not acknowledged address or data, or overrun. The stop
+       condition is not sent by the hardware. */
+    if (regs_p->EVENTS.ERROR == 1) {
+        regs_p->EVENTS.ERROR = 0;
+        dev_p->error = 1;
+        regs_p->ERRORSRC = regs_p->ERRORSRC;
+        regs_p->TASKS.STOP = 1;
+    }
+
+    if (regs_p->EVENTS.STOPPED == 1) {
+        regs_p->EVENTS.STOPPED = 0;
+        res = (regs_p->TXD.AMOUNT + regs_p->RXD.AMOUNT);
+
+        if ((dev_p->error == 1) && (res == 0)) {
+            res = -1;
+        }
+
+        transaction_complete_isr(dev_p, res);
+    }
+}
+
+ISR(spi0_twi0)
+{
+    isr(&i2c_device[0]);
+}
+
+int i2c_port_module_init()
+{
+    return (0);
+}
+
+int i2c_port_init(struct i2c_driver_t *self_p,
+                  struct i2c_device_t *dev_p,
+                  int baudrate,
+                  int address)
+{
+    self_p->dev_p = dev_p;
+    self_p->frequency = baudrate;
+    self_p->address = address;
+
+    return (0);
+}
+
+int i2c_port_start(struct i2c_driver_t *self_p)
+{
+    struct i2c_device_t *dev_p;
+    volatile struct nrf5_twim_t *regs_p;
+
+    dev_p = self_p->dev_p;
+    dev_p->drv_p = self_p;
+    regs_p = dev_p->regs_p;
+
+    /* Open drain outputs with pull-ups. */
+    dev_p->scl_p->regs_p->PIN_CNF[dev_p->scl_p->pin] =
+        (NRF5_GPIO_PIN_CNF_PULL_PULLUP | NRF5_GPIO_PIN_CNF_DRIVE_S0D1);
+    dev_p->sda_p->regs_p->PIN_CNF[dev_p->sda_p->pin] =
+        (NRF5_GPIO_PIN_CNF_PULL_PULLUP | NRF5_GPIO_PIN_CNF_DRIVE_S0D1);
+
+    regs_p->PSEL.SCL = pin_to_psel(dev_p->scl_p);
+    regs_p->PSEL.SDA = pin_to_psel(dev_p->sda_p);
+    regs_p->FREQUENCY = self_p->frequency;
+    regs_p->ENABLE = NRF5_TWIM_ENABLE_ENABLED;
+    regs_p->INTENSET = (NRF5_TWIM_INT_STOPPED | NRF5_TWIM_INT_ERROR);
+    nvic_enable_interrupt(NRF5_PERIPHERAL_ID(regs_p));
+
+    return (0);
+}
+
+int i2c_port_stop(struct i2c_driver_t *self_p)
+{
+    volatile struct nrf5_twim_t *regs_p;
+
+    regs_p = self_p->dev_p->regs_p;
+
+    nvic_disable_interrupt(NRF5_PERIPHERAL_ID(regs_p));
+    regs_p->INTENCLR = 0xffffffff;
+    regs_p->ENABLE = NRF5_TWIM_ENABLE_DISABLED;
+
+    return (0);
+}
+
+int i2c_port_scan(struct i2c_driver_t *self_p,
+                  int address)
+{
+    volatile struct nrf5_twim_t *regs_p;
+    uint8_t value;
+    uint32_t intenset;
+    int error;
+
+    regs_p = self_p->dev_p->regs_p;
+
+    /* Poll for completion instead of using the interrupt. */
+    intenset = regs_p->INTENSET;
+    regs_p->INTENCLR = intenset;
+
+    /* Read a single byte. */
+    regs_p->ADDRESS = address;
+    regs_p->RXD.PTR = (uint32_t)&value;
+    regs_p->RXD.MAXCNT = 1;
+    regs_p->SHORTS = NRF5_TWIM_SHORTS_LASTRX_STOP;
+    regs_p->EVENTS.STOPPED = 0;
+    regs_p->EVENTS.ERROR = 0;
+    regs_p->TASKS.STARTRX = 1;
+
+    while ((regs_p->EVENTS.STOPPED == 0) && (regs_p->EVENTS.ERROR == 0));
+
+    error = regs_p->EVENTS.ERROR;
+
+    if (error == 1) {
+        regs_p->ERRORSRC = regs_p->ERRORSRC;
+        regs_p->TASKS.STOP = 1;
+
+        while (regs_p->EVENTS.STOPPED == 0);
+    }
+
+    regs_p->EVENTS.STOPPED = 0;
+    regs_p->EVENTS.ERROR = 0;
+    regs_p->INTENSET = intenset;
+
+    return (error == 0);
+}
+
+int i2c_port_slave_start(struct i2c_driver_t *self_p)
+{
+    return (-ENOSYS);
+}
+
+int i2c_port_slave_stop(struct i2c_driver_t *self_p)
+{
+    return (-ENOSYS);
+}
+
+ssize_t i2c_port_slave_read(struct i2c_driver_t *self_p,
+                            void *buf_p,
+                            size_t size)
+{
+    return (-ENOSYS);
+}
+
+ssize_t i2c_port_slave_write(struct i2c_driver_t *self_p,
+                             const void *buf_p,
+                             size_t size)
+{
+    return (-ENOSYS);
+}
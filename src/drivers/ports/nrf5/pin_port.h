@@ -44,14 +44,17 @@ static inline int pin_port_device_set_mode(const struct pin_device_t *dev_p,
                                            int mode)
 {
     int res;
-    int index;
 
-    index = indexof(dev_p, pin_device);
-    
+    res = 0;
+
     switch (mode) {
 
     case PIN_OUTPUT:
-        dev_p->regs_p->PIN_CNF[index] = NRF5_GPIO_PIN_CNF_DIR_OUTPUT;
+        dev_p->regs_p->PIN_CNF[dev_p->pin] = NRF5_GPIO_PIN_CNF_DIR_OUTPUT;
+        break;
+
+    case PIN_INPUT:
+        dev_p->regs_p->PIN_CNF[dev_p->pin] = 0;
         break;
 
     default:
@@ -63,19 +66,19 @@ static inline int pin_port_device_set_mode(const struct pin_device_t *dev_p,
 
 static inline int pin_port_device_read(const struct pin_device_t *dev_p)
 {
-    return (-ENOSYS);
+    return ((dev_p->regs_p->IN >> dev_p->pin) & 1);
 }
 
 static inline int pin_port_device_write_high(const struct pin_device_t *dev_p)
 {
-    dev_p->regs_p->OUTCLR = BIT(dev_p->pin);
+    dev_p->regs_p->OUTSET = BIT(dev_p->pin);
 
     return (0);
 }
 
 static inline int pin_port_device_write_low(const struct pin_device_t *dev_p)
 {
-    dev_p->regs_p->OUTSET = BIT(dev_p->pin);
+    dev_p->regs_p->OUTCLR = BIT(dev_p->pin);
 
     return (0);
 }
@@ -40,7 +40,7 @@ static int pin_port_init(struct pin_driver_t *self_p,
 
 static int pin_port_read(struct pin_driver_t *self_p)
 {
-    return (-ENOSYS);
+    return (pin_device_read(self_p->dev_p));
 }
 
 static int pin_port_write(struct pin_driver_t *self_p, int value)
@@ -60,7 +60,7 @@ static int pin_port_toggle(struct pin_driver_t *self_p)
 
     value = (self_p->dev_p->regs_p->OUT & BIT(self_p->dev_p->pin));
 
-    return (pin_port_write(self_p, value));
+    return (pin_port_write(self_p, value == 0));
 }
 
 static int pin_port_set_mode(struct pin_driver_t *self_p, int mode)
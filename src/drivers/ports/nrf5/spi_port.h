@@ -0,0 +1,81 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2014-2018, Erik Moqvist
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use, copy,
+ * modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ * This file is part of the Simba project.
+ */
+
+#ifndef __DRIVERS_SPI_PORT_H__
+#define __DRIVERS_SPI_PORT_H__
+
+#include <io.h>
+
+/* Speed configuration. */
+#define SPI_PORT_SPEED_8MBPS    NRF5_SPIM_FREQUENCY_M8
+#define SPI_PORT_SPEED_4MBPS    NRF5_SPIM_FREQUENCY_M4
+#define SPI_PORT_SPEED_2MBPS    NRF5_SPIM_FREQUENCY_M2
+#define SPI_PORT_SPEED_1MBPS    NRF5_SPIM_FREQUENCY_M1
+#define SPI_PORT_SPEED_500KBPS  NRF5_SPIM_FREQUENCY_K500
+#define SPI_PORT_SPEED_250KBPS  NRF5_SPIM_FREQUENCY_K250
+#define SPI_PORT_SPEED_125KBPS  NRF5_SPIM_FREQUENCY_K125
+
+/* Transactions are queued and performed with EasyDMA. */
+#define SPI_PORT_HAS_ASYNC
+
+/* Size of the buffer transmitted data not in RAM is copied to, as
+   EasyDMA can only read from RAM. */
+#define SPI_PORT_TXBUF_SIZE 32
+
+struct spi_driver_t;
+struct spi_transaction_t;
+
+struct spi_device_t {
+    struct spi_driver_t *drv_p;
+    volatile struct nrf5_spim_t *regs_p;
+    const struct pin_device_t *mosi_p;
+    const struct pin_device_t *miso_p;
+    const struct pin_device_t *sck_p;
+    struct mutex_t mutex;
+    struct {
+        struct spi_transaction_t *head_p;
+        struct spi_transaction_t *tail_p;
+    } transactions;
+    uint8_t txbuf[SPI_PORT_TXBUF_SIZE];
+};
+
+struct spi_driver_t {
+    struct spi_device_t *dev_p;
+    struct pin_driver_t ss;
+    int mode;
+    int speed;
+    int polarity;
+    int phase;
+    uint8_t *rxbuf_p;                        /* Transfer receive buffer or NULL. */
+    const uint8_t *txbuf_p;                  /* Transfer transmit buffer or NULL. */
+    size_t size;                             /* Number of bytes left to transfer. */
+    size_t total;                            /* Transfer size. */
+    size_t chunk;                            /* Size of the ongoing EasyDMA transfer. */
+};
+
+#endif
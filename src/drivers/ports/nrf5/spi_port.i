@@ -0,0 +1,194 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2014-2018, Erik Moqvist
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use, copy,
+ * modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ * This file is part of the Simba project.
+ */
+
+static uint32_t pin_to_psel(const struct pin_device_t *pin_p)
+{
+    return (((pin_p->regs_p == NRF5_GPIO_P1) << 5) | pin_p->pin);
+}
+
+/**
+ * Start an EasyDMA transfer of the next chunk of the ongoing
+ * transfer. A chunk is limited by the maximum EasyDMA transfer size,
+ * and by the size of the device transmit buffer if the transmitted
+ * data is not in RAM. The ORC character 0xff is transmitted if there
+ * is no transmit buffer.
+ */
+static void chunk_start_isr(struct spi_driver_t *self_p)
+{
+    struct spi_device_t *dev_p;
+    volatile struct nrf5_spim_t *regs_p;
+    size_t n;
+
+    dev_p = self_p->dev_p;
+    regs_p = dev_p->regs_p;
+    n = MIN(self_p->size, NRF5_EASYDMA_MAXCNT_MAX);
+
+    if (self_p->txbuf_p == NULL) {
+        regs_p->TXD.MAXCNT = 0;
+    } else {
+        if (NRF5_IS_RAM(self_p->txbuf_p)) {
+            regs_p->TXD.PTR = (uint32_t)self_p->txbuf_p;
+        } else {
+            n = MIN(n, sizeof(dev_p->txbuf));
+            memcpy(&dev_p->txbuf[0], self_p->txbuf_p, n);
+            regs_p->TXD.PTR = (uint32_t)&dev_p->txbuf[0];
+        }
+
+        regs_p->TXD.MAXCNT = n;
+    }
+
+    if (self_p->rxbuf_p == NULL) {
+        regs_p->RXD.MAXCNT = 0;
+    } else {
+        regs_p->RXD.PTR = (uint32_t)self_p->rxbuf_p;
+        regs_p->RXD.MAXCNT = n;
+    }
+
+    self_p->chunk = n;
+    regs_p->EVENTS.END = 0;
+    regs_p->TASKS.START = 1;
+}
+
+/**
+ * SPI transfer complete interrupt.
+ */
+ISR(spi2)
+{
+    struct spi_device_t *dev_p = &spi_device[0];
+    struct spi_driver_t *drv_p = dev_p->drv_p;
+
+    if (drv_p == NULL) {
+        return;
+    }
+
+    if (dev_p->regs_p->EVENTS.END == 0) {
+        return;
+    }
+
+    dev_p->regs_p->EVENTS.END = 0;
+
+    if (drv_p->rxbuf_p != NULL) {
+        drv_p->rxbuf_p += drv_p->chunk;
+    }
+
+    if (drv_p->txbuf_p != NULL) {
+        drv_p->txbuf_p += drv_p->chunk;
+    }
+
+    drv_p->size -= drv_p->chunk;
+
+    /* Complete the transaction on complete transfer. */
+    if (drv_p->size == 0) {
+        transaction_complete_isr(dev_p, drv_p->total);
+    } else {
+        chunk_start_isr(drv_p);
+    }
+}
+
+static int spi_port_module_init(void)
+{
+    return (0);
+}
+
+static int spi_port_init(struct spi_driver_t *self_p,
+                         struct spi_device_t *dev_p,
+                         struct pin_device_t *ss_pin_p,
+                         int mode,
+                         int speed,
+                         int polarity,
+                         int phase)
+{
+    /* The SPIM is master only. */
+    if (mode != SPI_MODE_MASTER) {
+        return (-ENOSYS);
+    }
+
+    pin_init(&self_p->ss, ss_pin_p, PIN_OUTPUT);
+    pin_write(&self_p->ss, 1);
+
+    return (0);
+}
+
+static int spi_port_start(struct spi_driver_t *self_p)
+{
+    struct spi_device_t *dev_p;
+    volatile struct nrf5_spim_t *regs_p;
+
+    dev_p = self_p->dev_p;
+    regs_p = dev_p->regs_p;
+
+    /* Configure sck and mosi as outputs, and miso as input. */
+    pin_device_set_mode(dev_p->sck_p, PIN_OUTPUT);
+    pin_device_set_mode(dev_p->mosi_p, PIN_OUTPUT);
+    pin_device_set_mode(dev_p->miso_p, PIN_INPUT);
+
+    regs_p->ENABLE = NRF5_SPIM_ENABLE_DISABLED;
+    regs_p->PSEL.SCK = pin_to_psel(dev_p->sck_p);
+    regs_p->PSEL.MOSI = pin_to_psel(dev_p->mosi_p);
+    regs_p->PSEL.MISO = pin_to_psel(dev_p->miso_p);
+    regs_p->FREQUENCY = self_p->speed;
+    regs_p->CONFIG = ((NRF5_SPIM_CONFIG_CPHA * self_p->phase)
+                      | (NRF5_SPIM_CONFIG_CPOL * self_p->polarity));
+    regs_p->ORC = 0xff;
+    regs_p->ENABLE = NRF5_SPIM_ENABLE_ENABLED;
+    regs_p->INTENSET = NRF5_SPIM_INT_END;
+    nvic_enable_interrupt(NRF5_PERIPHERAL_ID(regs_p));
+
+    return (0);
+}
+
+static int spi_port_stop(struct spi_driver_t *self_p)
+{
+    volatile struct nrf5_spim_t *regs_p;
+
+    regs_p = self_p->dev_p->regs_p;
+
+    nvic_disable_interrupt(NRF5_PERIPHERAL_ID(regs_p));
+    regs_p->INTENCLR = 0xffffffff;
+    regs_p->ENABLE = NRF5_SPIM_ENABLE_DISABLED;
+
+    return (0);
+}
+
+/**
+ * Start a transfer. Called with the system lock taken or from
+ * interrupt context. The CPU is not involved until the END
+ * interrupt of the last chunk, which completes the transaction.
+ */
+static void spi_port_transfer_start_isr(struct spi_driver_t *self_p,
+                                        void *rxbuf_p,
+                                        const void *txbuf_p,
+                                        size_t n)
+{
+    self_p->rxbuf_p = rxbuf_p;
+    self_p->txbuf_p = txbuf_p;
+    self_p->size = n;
+    self_p->total = n;
+
+    chunk_start_isr(self_p);
+}
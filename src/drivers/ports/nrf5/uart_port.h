@@ -34,20 +34,30 @@
  */
 #define UART_PORT_FRAME_FORMAT_DEFAULT 0
 
+/* Size of the buffer data not in RAM is copied to before it is
+   transmitted, as EasyDMA can only read from RAM. */
+#define UART_PORT_TXBUF_SIZE 32
+
 struct uart_device_t {
     struct uart_driver_t *drv_p;
-    volatile struct nrf5_uart_t *regs_p;
+    volatile struct nrf5_uarte_t *regs_p;
     const struct pin_device_t *tx_pin_p;
     const struct pin_device_t *rx_pin_p;
 };
 
 struct uart_driver_t {
     struct queue_t base;
-    const struct uart_device_t *dev_p;
+    struct uart_device_t *dev_p;
     struct mutex_t mutex;
     long baudrate;
     int format;
     size_t rxsize;
+    struct thrd_t *thrd_p;
+    struct {
+        uint8_t buf[2];
+        int index;
+    } rx;
+    uint8_t txbuf[UART_PORT_TXBUF_SIZE];
 };
 
 #endif
@@ -26,79 +26,251 @@
  * This file is part of the Simba project.
  */
 
-ISR(uart0)
+static struct fs_counter_t rx_channel_overflow;
+static struct fs_counter_t rx_errors;
+
+static uint32_t baudrate_to_register(long baudrate)
+{
+    switch (baudrate) {
+
+    case 9600:
+        return (NRF5_UARTE_BAUDRATE_9600);
+
+    case 19200:
+        return (NRF5_UARTE_BAUDRATE_19200);
+
+    case 38400:
+        return (NRF5_UARTE_BAUDRATE_38400);
+
+    case 57600:
+        return (NRF5_UARTE_BAUDRATE_57600);
+
+    case 115200:
+        return (NRF5_UARTE_BAUDRATE_115200);
+
+    case 230400:
+        return (NRF5_UARTE_BAUDRATE_230400);
+
+    case 460800:
+        return (NRF5_UARTE_BAUDRATE_460800);
+
+    case 921600:
+        return (NRF5_UARTE_BAUDRATE_921600);
+
+    case 1000000:
+        return (NRF5_UARTE_BAUDRATE_1000000);
+
+    default:
+        return (0);
+    }
+}
+
+static uint32_t pin_to_psel(const struct pin_device_t *pin_p)
 {
-    struct uart_device_t *dev_p = &uart_device[0];
+    return (((pin_p->regs_p == NRF5_GPIO_P1) << 5) | pin_p->pin);
+}
+
+static void isr(int index)
+{
+    struct uart_device_t *dev_p = &uart_device[index];
     struct uart_driver_t *drv_p = dev_p->drv_p;
+    volatile struct nrf5_uarte_t *regs_p;
 
     if (drv_p == NULL) {
         return;
     }
 
-    /* TX and/or RX complete. */
+    regs_p = dev_p->regs_p;
+
+    /* The transmit buffer has been sent. */
+    if (regs_p->EVENTS.ENDTX == 1) {
+        regs_p->EVENTS.ENDTX = 0;
+
+        if (drv_p->thrd_p != NULL) {
+            thrd_resume_isr(drv_p->thrd_p, 0);
+            drv_p->thrd_p = NULL;
+        }
+    }
+
+    if (regs_p->EVENTS.ERROR == 1) {
+        regs_p->EVENTS.ERROR = 0;
+        regs_p->ERRORSRC = regs_p->ERRORSRC;
+        fs_counter_increment_isr(&rx_errors, 1);
+    }
+
+    /* A byte has been received. The ENDRX_STARTRX shortcut has
+       already started the reception into the other buffer. */
+    if (regs_p->EVENTS.ENDRX == 1) {
+        regs_p->EVENTS.ENDRX = 0;
+
+        if (queue_write_isr(&drv_p->base,
+                            &drv_p->rx.buf[drv_p->rx.index],
+                            1) != 1) {
+            fs_counter_increment_isr(&rx_channel_overflow, 1);
+        }
+
+        drv_p->rx.index ^= 1;
+    }
+
+    /* Give the buffer just read from for the reception after the
+       started one. */
+    if (regs_p->EVENTS.RXSTARTED == 1) {
+        regs_p->EVENTS.RXSTARTED = 0;
+        regs_p->RXD.PTR = (uint32_t)&drv_p->rx.buf[drv_p->rx.index ^ 1];
+    }
 }
 
+#define UART_ISR(vector, index)                 \
+    ISR(vector) {                               \
+        isr(index);                             \
+    }                                           \
+
+#if (UART_DEVICE_MAX >= 1)
+UART_ISR(uart0, 0)
+#endif
+
+#if (UART_DEVICE_MAX >= 2)
+UART_ISR(uart1, 1)
+#endif
+
 static int uart_port_module_init()
 {
+    fs_counter_init(&rx_channel_overflow,
+                    FSTR("/drivers/uart/rx_channel_overflow"),
+                    0);
+    fs_counter_register(&rx_channel_overflow);
+
+    fs_counter_init(&rx_errors,
+                    FSTR("/drivers/uart/rx_errors"),
+                    0);
+    fs_counter_register(&rx_errors);
+
     return (0);
 }
 
 static int uart_port_start(struct uart_driver_t *self_p)
 {
-    const struct uart_device_t *dev_p;
-    volatile struct nrf5_uart_t *regs_p;
-    int port;
-    
+    struct uart_device_t *dev_p;
+    volatile struct nrf5_uarte_t *regs_p;
+    uint32_t baudrate;
+
+    baudrate = baudrate_to_register(self_p->baudrate);
+
+    if (baudrate == 0) {
+        return (-EINVAL);
+    }
+
     dev_p = self_p->dev_p;
     regs_p = dev_p->regs_p;
 
     /* Configure pin functions. */
-    port = (dev_p->tx_pin_p->regs_p == NRF5_GPIO_P1);
-    regs_p->PSEL.TXD = ((port << 5) | dev_p->tx_pin_p->pin);
-    port = (dev_p->rx_pin_p->regs_p == NRF5_GPIO_P1);
-    regs_p->PSEL.RXD = ((port << 5) | dev_p->rx_pin_p->pin);
-    
-    regs_p->BAUDRATE = 0x01d7e000;
-    regs_p->ENABLE = 4;
-    regs_p->TASKS.STARTTX = 1;
+    regs_p->PSEL.TXD = pin_to_psel(dev_p->tx_pin_p);
+    regs_p->PSEL.RXD = pin_to_psel(dev_p->rx_pin_p);
+
+    regs_p->BAUDRATE = baudrate;
+    regs_p->CONFIG = 0;
+    regs_p->ENABLE = NRF5_UARTE_ENABLE_ENABLED;
+
+    regs_p->EVENTS.ENDTX = 0;
+    regs_p->EVENTS.ENDRX = 0;
+    regs_p->EVENTS.ERROR = 0;
+    regs_p->EVENTS.RXSTARTED = 0;
+
+    /* Receive one byte at a time into two alternating buffers, with
+       the next reception started by the hardware. The second buffer
+       is given once the first reception has started. */
+    self_p->thrd_p = NULL;
+    self_p->rx.index = 0;
+    regs_p->RXD.PTR = (uint32_t)&self_p->rx.buf[0];
+    regs_p->RXD.MAXCNT = 1;
+    regs_p->SHORTS = NRF5_UARTE_SHORTS_ENDRX_STARTRX;
     regs_p->TASKS.STARTRX = 1;
-    regs_p->EVENTS.TXDRDY = 0;
-    regs_p->EVENTS.RXDRDY = 0;
+
+    while (regs_p->EVENTS.RXSTARTED == 0);
+
+    regs_p->EVENTS.RXSTARTED = 0;
+    regs_p->RXD.PTR = (uint32_t)&self_p->rx.buf[1];
+
+    dev_p->drv_p = self_p;
+
+    regs_p->INTENSET = (NRF5_UARTE_INT_ENDRX
+                        | NRF5_UARTE_INT_ENDTX
+                        | NRF5_UARTE_INT_ERROR
+                        | NRF5_UARTE_INT_RXSTARTED);
+    nvic_enable_interrupt(NRF5_PERIPHERAL_ID(regs_p));
 
     return (0);
 }
 
 static int uart_port_stop(struct uart_driver_t *self_p)
 {
-    self_p->dev_p->regs_p->TASKS.SUSPEND = 1;
+    struct uart_device_t *dev_p;
+    volatile struct nrf5_uarte_t *regs_p;
+
+    dev_p = self_p->dev_p;
+    regs_p = dev_p->regs_p;
+
+    nvic_disable_interrupt(NRF5_PERIPHERAL_ID(regs_p));
+    regs_p->INTENCLR = 0xffffffff;
+    regs_p->SHORTS = 0;
+
+    /* The receiver must be stopped before the peripheral is
+       disabled. */
+    regs_p->EVENTS.RXTO = 0;
+    regs_p->TASKS.STOPRX = 1;
+
+    while (regs_p->EVENTS.RXTO == 0);
+
+    regs_p->ENABLE = NRF5_UARTE_ENABLE_DISABLED;
+    dev_p->drv_p = NULL;
 
     return (0);
 }
 
+/**
+ * Transmit given buffer with EasyDMA. The thread is suspended until
+ * the ENDTX interrupt, letting the CPU sleep, or run other threads,
+ * during the transfer. Data not in RAM is transmitted in chunks
+ * copied to the driver transmit buffer.
+ */
 static ssize_t uart_port_write_cb(void *arg_p,
                                   const void *buf_p,
                                   size_t size)
 {
-    size_t i;
     struct uart_driver_t *self_p;
-    volatile struct nrf5_uart_t *regs_p;
+    volatile struct nrf5_uarte_t *regs_p;
     const uint8_t *u8_buf_p;
+    size_t left;
+    size_t n;
 
     self_p = container_of(arg_p, struct uart_driver_t, base);
     regs_p = self_p->dev_p->regs_p;
     u8_buf_p = buf_p;
+    left = size;
 
-    mutex_lock(&self_p->mutex);
+    while (left > 0) {
+        if (NRF5_IS_RAM(u8_buf_p)) {
+            n = MIN(left, NRF5_EASYDMA_MAXCNT_MAX);
+            regs_p->TXD.PTR = (uint32_t)u8_buf_p;
+        } else {
+            n = MIN(left, sizeof(self_p->txbuf));
+            memcpy(&self_p->txbuf[0], u8_buf_p, n);
+            regs_p->TXD.PTR = (uint32_t)&self_p->txbuf[0];
+        }
 
-    for (i = 0; i < size; i++) {
-        regs_p->TXD = u8_buf_p[i];
+        regs_p->TXD.MAXCNT = n;
 
-        while (regs_p->EVENTS.TXDRDY == 0);
+        sys_lock();
 
-        regs_p->EVENTS.TXDRDY = 0;
-    }
+        self_p->thrd_p = thrd_self();
+        regs_p->TASKS.STARTTX = 1;
+        thrd_suspend_isr(NULL);
+
+        sys_unlock();
 
-    mutex_unlock(&self_p->mutex);
+        u8_buf_p += n;
+        left -= n;
+    }
 
     return (size);
 }
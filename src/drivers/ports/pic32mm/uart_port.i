@@ -77,7 +77,7 @@ ISR(uart2_reception)
         /* Write data to input queue. */
         if (queue_write_isr(&drv_p->base, &data, 1) != 1) {
 #if CONFIG_UART_FS_COUNTERS == 1
-            fs_counter_increment(&rx_channel_overflow, 1);
+            fs_counter_increment_isr(&rx_channel_overflow, 1);
 #endif
         }
     }
@@ -165,8 +165,6 @@ static ssize_t uart_port_write_cb(void *arg_p,
 
     self_p = container_of(arg_p, struct uart_driver_t, base);
 
-    mutex_lock(&self_p->mutex);
-
     /* Initiate transfer by writing to the fifo. */
     self_p->txbuf_p = buf_p;
     self_p->txsize = size;
@@ -180,8 +178,6 @@ static ssize_t uart_port_write_cb(void *arg_p,
 
     sys_unlock();
 
-    mutex_unlock(&self_p->mutex);
-
     return (size);
 }
 
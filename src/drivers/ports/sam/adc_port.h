@@ -31,7 +31,11 @@
 
 #define ADC_PORT_REFERENCE_VCC      0
 
+/* Continuous conversions through the PDC are supported. */
+#define ADC_PORT_HAS_STREAM
+
 struct adc_driver_t;
+struct adc_stream_t;
 
 struct adc_device_t {
     volatile struct sam_adc_t *regs_p;
@@ -45,6 +49,7 @@ struct adc_device_t {
         int channel;
         int id;
     } tc;
+    struct adc_stream_t *stream_p;
 };
 
 struct adc_driver_t {
@@ -58,4 +63,9 @@ struct adc_driver_t {
     struct adc_driver_t *next_p;
 };
 
+struct adc_stream_port_t {
+    int index;
+    uint8_t channels[CONFIG_ADC_STREAM_CHANNELS_MAX];
+};
+
 #endif
@@ -30,6 +30,63 @@
 #define STATE_RUNNING  0
 #define STATE_FINISHED 1
 
+/* Sampling rate used by single conversions. */
+#define SAMPLING_RATE_DEFAULT                            10000
+
+static void set_sampling_rate(struct adc_device_t *dev_p,
+                              long sampling_rate)
+{
+    uint32_t rc;
+    int channel;
+
+    channel = dev_p->tc.channel;
+    rc = (F_CPU / 8 / sampling_rate);
+    dev_p->tc.regs_p->CHANNEL[channel].RA = (rc / 2);
+    dev_p->tc.regs_p->CHANNEL[channel].RC = rc;
+}
+
+/**
+ * Configure given pin as an analog input and return its ADC channel.
+ */
+static int pin_to_channel(struct pin_device_t *pin_dev_p)
+{
+    uint32_t mask;
+
+    /* Disable the pull-up. */
+    mask = pin_dev_p->mask;
+    pin_dev_p->pio_p->PDR = mask;
+    pin_dev_p->pio_p->PUDR = mask;
+    pin_dev_p->pio_p->ABSR |= mask;
+
+    if (pin_dev_p == &pin_a0_dev) {
+        return (7);
+    } else if (pin_dev_p == &pin_a1_dev) {
+        return (6);
+    } else if (pin_dev_p == &pin_a2_dev) {
+        return (5);
+    } else if (pin_dev_p == &pin_a3_dev) {
+        return (4);
+    } else if (pin_dev_p == &pin_a4_dev) {
+        return (3);
+    } else if (pin_dev_p == &pin_a5_dev) {
+        return (2);
+    } else if (pin_dev_p == &pin_a6_dev) {
+        return (1);
+    } else if (pin_dev_p == &pin_a7_dev) {
+        return (0);
+    } else if (pin_dev_p == &pin_a8_dev) {
+        return (10);
+    } else if (pin_dev_p == &pin_a9_dev) {
+        return (11);
+    } else if (pin_dev_p == &pin_a10_dev) {
+        return (12);
+    } else if (pin_dev_p == &pin_a11_dev) {
+        return (13);
+    }
+
+    return (-1);
+}
+
 static void start_adc_hw(struct adc_driver_t *self_p)
 {
     volatile struct sam_adc_t *regs_p;
@@ -58,10 +115,34 @@ static void stop_adc_hw(struct adc_driver_t *self_p)
     regs_p->IDR = (SAM_ADC_IDR_ENDRX);
 }
 
+static void stream_isr(struct adc_stream_t *self_p)
+{
+    volatile struct sam_adc_t *regs_p;
+    uint16_t *block_p;
+
+    regs_p = self_p->dev_p->regs_p;
+
+    /* The PDC has switched to the next block. Hand over the completed
+       one and queue it again as the next block. */
+    block_p = &self_p->blocks_p[self_p->port.index * self_p->block_length];
+    self_p->port.index ^= 1;
+    stream_write_block_isr(self_p, block_p);
+    regs_p->PDC.RNPR = (uint32_t)block_p;
+    regs_p->PDC.RNCR = self_p->block_length;
+}
+
 ISR(adc)
 {
     struct adc_device_t *dev_p = &adc_device[0];
-    struct adc_driver_t *self_p = dev_p->jobs.head_p;
+    struct adc_driver_t *self_p;
+
+    if (dev_p->stream_p != NULL) {
+        stream_isr(dev_p->stream_p);
+
+        return;
+    }
+
+    self_p = dev_p->jobs.head_p;
 
     /* Mark the job as finished. */
     self_p->state = STATE_FINISHED;
@@ -86,10 +167,10 @@ ISR(adc)
 static int adc_port_module_init(void)
 {
     int channel;
-    uint32_t rc;
-    uint32_t sampling_rate = 10000;
     struct adc_device_t *dev_p = &adc_device[0];
 
+    dev_p->stream_p = NULL;
+
     /* Setup a Timer Counter to send the clock pulses to the ADC. */
     pmc_peripheral_clock_enable(dev_p->tc.id);
 
@@ -103,9 +184,7 @@ static int adc_port_module_init(void)
                                               | TC_CMR_WAVEFORM_WAVE
                                               | TC_CMR_WAVEFORM_WAVSEL_UP_RC
                                               | TC_CMR_WAVEFORM_TCCLKS(1));
-    rc = (F_CPU / 8 / sampling_rate);
-    dev_p->tc.regs_p->CHANNEL[channel].RA = (rc / 2);
-    dev_p->tc.regs_p->CHANNEL[channel].RC = rc;
+    set_sampling_rate(dev_p, SAMPLING_RATE_DEFAULT);
     dev_p->tc.regs_p->CHANNEL[channel].CCR = (TC_CCR_SWTRG | TC_CCR_CLKEN);
 
     /* Setup the ADC clocked by Timer Counter 0, channel 2. */
@@ -130,41 +209,8 @@ static int adc_port_init(struct adc_driver_t *self_p,
                          int reference,
                          long sampling_rate)
 {
-    uint32_t mask;
-
     self_p->dev_p = dev_p;
-
-    /* Disable the pull-up. */
-    mask = pin_dev_p->mask;
-    pin_dev_p->pio_p->PDR = mask;
-    pin_dev_p->pio_p->PUDR = mask;
-    pin_dev_p->pio_p->ABSR |= mask;
-
-    if (pin_dev_p == &pin_a0_dev) {
-        self_p->channel = 7;
-    } else if (pin_dev_p == &pin_a1_dev) {
-        self_p->channel = 6;
-    } else if (pin_dev_p == &pin_a2_dev) {
-        self_p->channel = 5;
-    } else if (pin_dev_p == &pin_a3_dev) {
-        self_p->channel = 4;
-    } else if (pin_dev_p == &pin_a4_dev) {
-        self_p->channel = 3;
-    } else if (pin_dev_p == &pin_a5_dev) {
-        self_p->channel = 2;
-    } else if (pin_dev_p == &pin_a6_dev) {
-        self_p->channel = 1;
-    } else if (pin_dev_p == &pin_a7_dev) {
-        self_p->channel = 0;
-    } else if (pin_dev_p == &pin_a8_dev) {
-        self_p->channel = 10;
-    } else if (pin_dev_p == &pin_a9_dev) {
-        self_p->channel = 11;
-    } else if (pin_dev_p == &pin_a10_dev) {
-        self_p->channel = 12;
-    } else if (pin_dev_p == &pin_a11_dev) {
-        self_p->channel = 13;
-    }
+    self_p->channel = pin_to_channel(pin_dev_p);
 
     return (0);
 }
@@ -226,3 +272,97 @@ int adc_port_convert_isr(struct adc_driver_t *self_p,
 {
     return (-1);
 }
+
+static int adc_port_stream_init(struct adc_stream_t *self_p,
+                                struct pin_device_t **pin_devices_pp)
+{
+    int i;
+    int channel;
+
+    for (i = 0; i < self_p->number_of_channels; i++) {
+        channel = pin_to_channel(pin_devices_pp[i]);
+
+        if (channel == -1) {
+            return (-EINVAL);
+        }
+
+        self_p->port.channels[i] = channel;
+    }
+
+    return (0);
+}
+
+static int adc_port_stream_start(struct adc_stream_t *self_p)
+{
+    struct adc_device_t *dev_p;
+    volatile struct sam_adc_t *regs_p;
+    uint32_t seqr[2];
+    int i;
+
+    dev_p = self_p->dev_p;
+    regs_p = dev_p->regs_p;
+
+    /* The user sequencer converts the channels in given order, one
+       sequence per timer trigger. */
+    seqr[0] = 0;
+    seqr[1] = 0;
+
+    for (i = 0; i < self_p->number_of_channels; i++) {
+        seqr[i / 8] |= (self_p->port.channels[i] << (4 * (i % 8)));
+    }
+
+    sys_lock();
+
+    if (dev_p->jobs.head_p != NULL) {
+        sys_unlock();
+
+        return (-EBUSY);
+    }
+
+    dev_p->stream_p = self_p;
+    self_p->port.index = 0;
+    set_sampling_rate(dev_p, self_p->sampling_rate);
+
+    regs_p->SEQR1 = seqr[0];
+    regs_p->SEQR2 = seqr[1];
+    regs_p->MR |= SAM_ADC_MR_USEQ;
+
+    /* Double buffering in the PDC, the next block is queued by the
+       end of receive interrupt. */
+    regs_p->PDC.RPR = (uint32_t)&self_p->blocks_p[0];
+    regs_p->PDC.RCR = self_p->block_length;
+    regs_p->PDC.RNPR = (uint32_t)&self_p->blocks_p[self_p->block_length];
+    regs_p->PDC.RNCR = self_p->block_length;
+
+    /* With the user sequencer enabled the channel enable bits selects
+       sequence slots instead of channels. */
+    regs_p->CHER = ((1 << self_p->number_of_channels) - 1);
+    regs_p->IER = (SAM_ADC_IER_ENDRX);
+
+    sys_unlock();
+
+    return (0);
+}
+
+static int adc_port_stream_stop(struct adc_stream_t *self_p)
+{
+    struct adc_device_t *dev_p;
+    volatile struct sam_adc_t *regs_p;
+
+    dev_p = self_p->dev_p;
+    regs_p = dev_p->regs_p;
+
+    sys_lock();
+
+    regs_p->CHDR = ((1 << self_p->number_of_channels) - 1);
+    regs_p->IDR = (SAM_ADC_IDR_ENDRX);
+    regs_p->MR &= ~SAM_ADC_MR_USEQ;
+    regs_p->PDC.RNCR = 0;
+    regs_p->PDC.RCR = 0;
+    set_sampling_rate(dev_p, SAMPLING_RATE_DEFAULT);
+    dev_p->stream_p = NULL;
+
+    sys_unlock();
+
+    return (0);
+}
@@ -49,6 +49,9 @@
                                  | CAN_BR_SJW(2)          \
                                  | CAN_BR_BRP(0x29))
 
+/* One RX mailbox per filter, all but the TX mailbox. */
+#define CAN_PORT_FILTERS_MAX                                        7
+
 struct can_device_t {
     struct can_driver_t *drv_p;
     volatile struct sam_can_t *regs_p;
@@ -72,6 +75,10 @@ struct can_driver_t {
     size_t txsize;
     struct queue_t chin;
     struct mutex_t mutex;
+    struct {
+        const struct can_filter_t *filters_p;
+        int length;
+    } filters;
 };
 
 #endif
@@ -28,9 +28,11 @@
 
 #include "simba.h"
 
-#define MAILBOX_TX     0
-#define MAILBOX_RX_EID 1
-#define MAILBOX_RX_SID 2
+#define MAILBOX_TX       0
+#define MAILBOX_RX_EID   1
+#define MAILBOX_RX_SID   2
+#define MAILBOX_RX_FIRST 1
+#define MAILBOX_MAX      8
 
 static struct fs_counter_t rx_channel_overflow;
 
@@ -49,7 +51,7 @@ static void read_frame_from_hw(struct can_driver_t *self_p,
     frame.size = ((msr & CAN_MSR_MDLC_MASK) >> CAN_MSR_MDLC_POS);
     frame.rtr = ((msr & CAN_MSR_MRTR) != 0);
 #if CONFIG_CAN_FRAME_TIMESTAMP == 1
-    frame.timestamp = 0;
+    frame.timestamp = timestamp_isr();
 #endif
     frame.data.u32[0] = mailbox_p->MDL;
     frame.data.u32[1] = mailbox_p->MDH;
@@ -57,6 +59,10 @@ static void read_frame_from_hw(struct can_driver_t *self_p,
     /* Allow reception of the next message. */
     mailbox_p->MCR = CAN_MCR_MTCR;
 
+    if (!is_frame_accepted_isr(self_p, &frame)) {
+        return;
+    }
+
     /* Write the received frame to the application input channel. */
     if (queue_unused_size_isr(&self_p->chin) >= sizeof(frame)) {
         queue_write_isr(&self_p->chin,
@@ -69,7 +75,7 @@ static void read_frame_from_hw(struct can_driver_t *self_p,
             self_p->base.reader_p = NULL;
         }
     } else {
-        fs_counter_increment(&rx_channel_overflow, 1);
+        fs_counter_increment_isr(&rx_channel_overflow, 1);
     }
 }
 
@@ -93,10 +99,33 @@ static void write_frame_to_hw(volatile struct sam_can_mailbox_t *mailbox_p,
                       | CAN_MCR_MTCR);
 }
 
+/**
+ * Configure given mailbox to receive frames matching given filter.
+ */
+static void configure_rx_mailbox(volatile struct sam_can_mailbox_t *mailbox_p,
+                                 const struct can_filter_t *filter_p)
+{
+    mailbox_p->MMR = CAN_MMR_MOT_MB_RX;
+
+    if (filter_p->extended_frame == 0) {
+        mailbox_p->MAM = (CAN_MAM_MIDE
+                          | CAN_MAM_MIDVA(filter_p->mask & 0x7ff));
+        mailbox_p->MID = CAN_MID_MIDVA(filter_p->id & 0x7ff);
+    } else {
+        mailbox_p->MAM = (CAN_MAM_MIDE
+                          | CAN_MAM_MIDVA(filter_p->mask & 0x7ff)
+                          | CAN_MAM_MIDVB(filter_p->mask >> 11));
+        mailbox_p->MID = (CAN_MID_MIDE
+                          | CAN_MID_MIDVA(filter_p->id & 0x7ff)
+                          | CAN_MID_MIDVB(filter_p->id >> 11));
+    }
+}
+
 static void isr(struct can_device_t *dev_p)
 {
     struct can_driver_t *self_p;
     uint32_t status;
+    int i;
 
     if (dev_p->drv_p == NULL) {
         return;
@@ -121,14 +150,11 @@ static void isr(struct can_device_t *dev_p)
         }
     }
 
-    if ((status & (1 << MAILBOX_RX_EID)) != 0) {
-        read_frame_from_hw(self_p,
-                           &dev_p->regs_p->MAILBOX[MAILBOX_RX_EID]);
-    }
-
-    if ((status & (1 << MAILBOX_RX_SID)) != 0) {
-        read_frame_from_hw(self_p,
-                           &dev_p->regs_p->MAILBOX[MAILBOX_RX_SID]);
+    /* Handle RX complete interrupts. */
+    for (i = MAILBOX_RX_FIRST; i < MAILBOX_MAX; i++) {
+        if ((status & (1 << i)) != 0) {
+            read_frame_from_hw(self_p, &dev_p->regs_p->MAILBOX[i]);
+        }
     }
 }
 
@@ -196,6 +222,7 @@ int can_port_start(struct can_driver_t *self_p)
     uint32_t mask;
     volatile struct sam_pio_t *pio_p;
     struct can_device_t *dev_p = self_p->dev_p;
+    int i;
 
     /* Configure tx pin. */
     mask = dev_p->tx.mask;
@@ -216,22 +243,40 @@ int can_port_start(struct can_driver_t *self_p)
     dev_p->regs_p->MAILBOX[MAILBOX_TX].MAM = CAN_MAM_MIDVA(0x7ff);
     dev_p->regs_p->MAILBOX[MAILBOX_TX].MID &= ~CAN_MAM_MIDE;
 
-    /* 1 RX mailboxes for extended ID. */
-    dev_p->regs_p->MAILBOX[MAILBOX_RX_EID].MMR = CAN_MMR_MOT_MB_RX;
-    dev_p->regs_p->MAILBOX[MAILBOX_RX_EID].MAM = CAN_MAM_MIDE;
-    dev_p->regs_p->MAILBOX[MAILBOX_RX_EID].MID = CAN_MID_MIDE;
+    /* Disable remaining mailboxes. */
+    for (i = MAILBOX_RX_FIRST; i < MAILBOX_MAX; i++) {
+        dev_p->regs_p->MAILBOX[i].MMR = 0;
+    }
 
-    /* 1 RX mailboxes for standard ID. */
-    dev_p->regs_p->MAILBOX[MAILBOX_RX_SID].MMR = CAN_MMR_MOT_MB_RX;
-    dev_p->regs_p->MAILBOX[MAILBOX_RX_SID].MAM = 0;
-    dev_p->regs_p->MAILBOX[MAILBOX_RX_SID].MID = 0;
+    if (self_p->filters.length == 0) {
+        /* 1 RX mailboxes for extended ID. */
+        dev_p->regs_p->MAILBOX[MAILBOX_RX_EID].MMR = CAN_MMR_MOT_MB_RX;
+        dev_p->regs_p->MAILBOX[MAILBOX_RX_EID].MAM = CAN_MAM_MIDE;
+        dev_p->regs_p->MAILBOX[MAILBOX_RX_EID].MID = CAN_MID_MIDE;
+
+        /* 1 RX mailboxes for standard ID. */
+        dev_p->regs_p->MAILBOX[MAILBOX_RX_SID].MMR = CAN_MMR_MOT_MB_RX;
+        dev_p->regs_p->MAILBOX[MAILBOX_RX_SID].MAM = 0;
+        dev_p->regs_p->MAILBOX[MAILBOX_RX_SID].MID = 0;
+        mask = (CAN_IER_MB1 | CAN_IER_MB2);
+    } else {
+        /* One RX mailbox per acceptance filter. */
+        mask = 0;
+
+        for (i = 0; i < self_p->filters.length; i++) {
+            configure_rx_mailbox(
+                &dev_p->regs_p->MAILBOX[MAILBOX_RX_FIRST + i],
+                &self_p->filters.filters_p[i]);
+            mask |= (1 << (MAILBOX_RX_FIRST + i));
+        }
+    }
 
     /* Baud rate. */
     dev_p->regs_p->BR = self_p->speed;
 
     dev_p->regs_p->IDR = 0xffffffff;
     /* Enable interrupt for RX mailboxes.*/
-    dev_p->regs_p->IER = (CAN_IER_MB1 | CAN_IER_MB2);
+    dev_p->regs_p->IER = mask;
     dev_p->regs_p->MR = (CAN_MR_CANEN);
 
     while ((dev_p->regs_p->SR & CAN_SR_WAKEUP) == 0);
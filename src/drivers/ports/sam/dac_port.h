@@ -29,7 +29,11 @@
 #ifndef __DRIVERS_DAC_PORT_H__
 #define __DRIVERS_DAC_PORT_H__
 
+/* Continuous convertions through the PDC are supported. */
+#define DAC_PORT_HAS_STREAM
+
 struct dac_driver_t;
+struct dac_stream_t;
 
 struct dac_device_t {
     volatile struct sam_dacc_t *regs_p;
@@ -43,6 +47,7 @@ struct dac_device_t {
         int channel;
         int id;
     } tc;
+    struct dac_stream_t *stream_p;
 };
 
 struct dac_driver_t {
@@ -58,4 +63,9 @@ struct dac_driver_t {
     struct dac_driver_t *next_p;
 };
 
+struct dac_stream_port_t {
+    int index;
+    uint32_t last;
+};
+
 #endif
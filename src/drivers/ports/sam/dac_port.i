@@ -51,10 +51,53 @@ static void convert_stop(struct dac_driver_t *self_p)
     self_p->dev_p->regs_p->CHDR = self_p->chxr;
 }
 
+static void stream_refill_isr(struct dac_stream_t *self_p, int index)
+{
+    uint32_t *samples_p;
+    size_t length;
+
+    samples_p = self_p->buffers_pp[index];
+    length = stream_fill_isr(self_p, samples_p);
+
+    /* Hold the output level on underrun. */
+    if (length > 0) {
+        self_p->port.last = samples_p[length - 1];
+    }
+
+    while (length < self_p->length) {
+        samples_p[length++] = self_p->port.last;
+    }
+}
+
+static void stream_isr(struct dac_stream_t *self_p)
+{
+    volatile struct sam_dacc_t *regs_p;
+    int index;
+
+    regs_p = self_p->drv_p->dev_p->regs_p;
+
+    /* The PDC has moved on to the queued buffer. Refill the finished
+       one and queue the buffer after the one being converted. */
+    index = self_p->port.index;
+    self_p->port.index = ((index + 1) % self_p->number_of_buffers);
+    stream_refill_isr(self_p, index);
+    index = ((index + 2) % self_p->number_of_buffers);
+    regs_p->PDC.TNPR = (uint32_t)self_p->buffers_pp[index];
+    regs_p->PDC.TNCR = self_p->length;
+}
+
 ISR(dacc)
 {
     struct dac_device_t *dev_p = &dac_device[0];
-    struct dac_driver_t *self_p = dev_p->jobs.head_p;
+    struct dac_driver_t *self_p;
+
+    if (dev_p->stream_p != NULL) {
+        stream_isr(dev_p->stream_p);
+
+        return;
+    }
+
+    self_p = dev_p->jobs.head_p;
 
     /* Add more samples to the PDC, if any. */
     if (self_p->next.length > 0) {
@@ -231,3 +274,64 @@ static int dac_port_convert(struct dac_driver_t *self_p,
 
     return (0);
 }
+
+static int dac_port_stream_start(struct dac_stream_t *self_p)
+{
+    struct dac_device_t *dev_p;
+    volatile struct sam_dacc_t *regs_p;
+    int i;
+
+    dev_p = self_p->drv_p->dev_p;
+    regs_p = dev_p->regs_p;
+
+    sys_lock();
+
+    if ((dev_p->jobs.head_p != NULL) || (dev_p->stream_p != NULL)) {
+        sys_unlock();
+
+        return (-EBUSY);
+    }
+
+    self_p->port.index = 0;
+    self_p->port.last = 0;
+
+    for (i = 0; i < self_p->number_of_buffers; i++) {
+        stream_refill_isr(self_p, i);
+    }
+
+    dev_p->stream_p = self_p;
+
+    /* The first two buffers are given to the PDC, which switches to
+       the next one by itself. */
+    regs_p->PDC.TPR = (uint32_t)self_p->buffers_pp[0];
+    regs_p->PDC.TCR = self_p->length;
+    regs_p->PDC.TNPR = (uint32_t)self_p->buffers_pp[1];
+    regs_p->PDC.TNCR = self_p->length;
+    regs_p->IER = (SAM_DACC_IER_ENDTX);
+    regs_p->CHER = self_p->drv_p->chxr;
+
+    sys_unlock();
+
+    return (0);
+}
+
+static int dac_port_stream_stop(struct dac_stream_t *self_p)
+{
+    struct dac_device_t *dev_p;
+    volatile struct sam_dacc_t *regs_p;
+
+    dev_p = self_p->drv_p->dev_p;
+    regs_p = dev_p->regs_p;
+
+    sys_lock();
+
+    regs_p->IDR = (SAM_DACC_IDR_ENDTX);
+    regs_p->CHDR = self_p->drv_p->chxr;
+    regs_p->PDC.TNCR = 0;
+    regs_p->PDC.TCR = 0;
+    dev_p->stream_p = NULL;
+
+    sys_unlock();
+
+    return (0);
+}
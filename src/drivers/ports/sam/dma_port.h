@@ -0,0 +1,61 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2014-2018, Erik Moqvist
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use, copy,
+ * modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ * This file is part of the Simba project.
+ */
+
+#ifndef __DRIVERS_DMA_PORT_H__
+#define __DRIVERS_DMA_PORT_H__
+
+#define DMA_PORT_CHANNELS_MAX                                   6
+#define DMA_PORT_LENGTH_MAX                                 0xfff
+
+struct dma_driver_t;
+struct dma_transfer_t;
+
+struct dma_device_t {
+    volatile struct sam_dmac_t *regs_p;
+    int id;
+    struct dma_driver_t *channels[DMA_PORT_CHANNELS_MAX];
+};
+
+struct dma_driver_t {
+    struct dma_device_t *dev_p;
+    int channel;
+    int request;
+    struct dma_transfer_t *transfer_p;
+    struct thrd_t *thrd_p;
+    int res;
+    /* Linked list item pointing to itself in circular mode. */
+    struct {
+        uint32_t saddr;
+        uint32_t daddr;
+        uint32_t ctrla;
+        uint32_t ctrlb;
+        uint32_t dscr;
+    } lli;
+};
+
+#endif
@@ -0,0 +1,215 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2014-2018, Erik Moqvist
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use, copy,
+ * modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ * This file is part of the Simba project.
+ */
+
+
+/* Address incrementing modes. */
+#define INCR_INCREMENTING 0
+#define INCR_FIXED        2
+
+/* Flow controller and transfer types. */
+#define FC_MEM2MEM        0
+#define FC_MEM2PER        1
+#define FC_PER2MEM        2
+
+static void channel_disable(struct dma_driver_t *self_p)
+{
+    volatile struct sam_dmac_t *regs_p;
+    int channel;
+
+    regs_p = self_p->dev_p->regs_p;
+    channel = self_p->channel;
+
+    regs_p->EBCIDR = ((DMAC_EBCIDR_BTC0 | DMAC_EBCIDR_ERR0) << channel);
+    regs_p->CHDR = (DMAC_CHDR_DIS0 << channel);
+
+    while ((regs_p->CHSR & (DMAC_CHSR_ENA0 << channel)) != 0);
+}
+
+ISR(dmac)
+{
+    struct dma_device_t *dev_p;
+    struct dma_driver_t *self_p;
+    uint32_t status;
+    int channel;
+
+    dev_p = &dma_device[0];
+
+    /* Reading the status register clears it. */
+    status = (dev_p->regs_p->EBCISR & dev_p->regs_p->EBCIMR);
+
+    for (channel = 0; channel < DMA_PORT_CHANNELS_MAX; channel++) {
+        self_p = dev_p->channels[channel];
+
+        if (self_p == NULL) {
+            continue;
+        }
+
+        if (status & (DMAC_EBCISR_ERR0 << channel)) {
+            channel_disable(self_p);
+            transfer_complete_isr(self_p, -EIO);
+        } else if (status & (DMAC_EBCISR_BTC0 << channel)) {
+            if ((self_p->transfer_p->flags & DMA_CIRCULAR) == 0) {
+                channel_disable(self_p);
+            }
+
+            transfer_complete_isr(self_p, 0);
+        }
+    }
+}
+
+static int dma_port_module_init(void)
+{
+    struct dma_device_t *dev_p;
+
+    dev_p = &dma_device[0];
+
+    pmc_peripheral_clock_enable(dev_p->id);
+
+    /* Round robin arbitration between the channels. */
+    dev_p->regs_p->GCFG = DMAC_GCFG_ARB_CFG;
+    dev_p->regs_p->EN = DMAC_EN_ENABLE;
+
+    nvic_enable_interrupt(dev_p->id);
+
+    return (0);
+}
+
+static int dma_port_channel_alloc(struct dma_driver_t *self_p,
+                                  int request)
+{
+    struct dma_device_t *dev_p;
+    int i;
+
+    dev_p = self_p->dev_p;
+
+    for (i = 0; i < DMA_PORT_CHANNELS_MAX; i++) {
+        if (dev_p->channels[i] == NULL) {
+            dev_p->channels[i] = self_p;
+            self_p->channel = i;
+            self_p->request = request;
+
+            return (0);
+        }
+    }
+
+    return (-EBUSY);
+}
+
+static void dma_port_channel_free(struct dma_driver_t *self_p)
+{
+    self_p->dev_p->channels[self_p->channel] = NULL;
+}
+
+static int dma_port_start(struct dma_driver_t *self_p,
+                          struct dma_transfer_t *transfer_p)
+{
+    volatile struct sam_dmac_t *regs_p;
+    int channel;
+    int width;
+    uint32_t ctrla;
+    uint32_t ctrlb;
+    uint32_t cfg;
+
+    regs_p = self_p->dev_p->regs_p;
+    channel = self_p->channel;
+    width = (transfer_p->flags & DMA_WIDTH_MASK);
+
+    ctrla = (DMAC_CTRLA_BTSIZE(transfer_p->length)
+             | DMAC_CTRLA_SRC_WIDTH(width)
+             | DMAC_CTRLA_DST_WIDTH(width));
+    cfg = DMAC_CFG_FIFOCFG(1);
+
+    switch (transfer_p->direction) {
+
+    case DMA_MEMORY_TO_PERIPHERAL:
+        ctrlb = (DMAC_CTRLB_FC(FC_MEM2PER)
+                 | DMAC_CTRLB_SRC_INCR(INCR_INCREMENTING)
+                 | DMAC_CTRLB_DST_INCR(INCR_FIXED));
+        cfg |= (DMAC_CFG_DST_PER(self_p->request) | DMAC_CFG_DST_H2SEL);
+        break;
+
+    case DMA_PERIPHERAL_TO_MEMORY:
+        ctrlb = (DMAC_CTRLB_FC(FC_PER2MEM)
+                 | DMAC_CTRLB_SRC_INCR(INCR_FIXED)
+                 | DMAC_CTRLB_DST_INCR(INCR_INCREMENTING));
+        cfg |= (DMAC_CFG_SRC_PER(self_p->request) | DMAC_CFG_SRC_H2SEL);
+        break;
+
+    default:
+        ctrlb = (DMAC_CTRLB_FC(FC_MEM2MEM)
+                 | DMAC_CTRLB_SRC_INCR(INCR_INCREMENTING)
+                 | DMAC_CTRLB_DST_INCR(INCR_INCREMENTING));
+        break;
+    }
+
+    /* Clear any pending status. */
+    (void)regs_p->EBCISR;
+
+    regs_p->channel[channel].CFG = cfg;
+
+    if (transfer_p->flags & DMA_CIRCULAR) {
+        /* The linked list item is fetched after each buffer, and
+           restarts the same buffer. */
+        self_p->lli.saddr = (uint32_t)transfer_p->src_p;
+        self_p->lli.daddr = (uint32_t)transfer_p->dst_p;
+        self_p->lli.ctrla = ctrla;
+        self_p->lli.ctrlb = ctrlb;
+        self_p->lli.dscr = (uint32_t)&self_p->lli;
+        regs_p->channel[channel].DSCR = (uint32_t)&self_p->lli;
+        regs_p->channel[channel].CTRLB = ctrlb;
+    } else {
+        regs_p->channel[channel].SADDR = (uint32_t)transfer_p->src_p;
+        regs_p->channel[channel].DADDR = (uint32_t)transfer_p->dst_p;
+        regs_p->channel[channel].DSCR = 0;
+        regs_p->channel[channel].CTRLA = ctrla;
+        regs_p->channel[channel].CTRLB = (ctrlb
+                                          | DMAC_CTRLB_SRC_DSCR
+                                          | DMAC_CTRLB_DST_DSCR);
+    }
+
+    regs_p->EBCIER = ((DMAC_EBCIER_BTC0 | DMAC_EBCIER_ERR0) << channel);
+    regs_p->CHER = (DMAC_CHER_ENA0 << channel);
+
+    return (0);
+}
+
+static void dma_port_stop(struct dma_driver_t *self_p)
+{
+    channel_disable(self_p);
+}
+
+static ssize_t dma_port_get_remaining(struct dma_driver_t *self_p)
+{
+    uint32_t done;
+
+    /* BTSIZE reads as the number of transfers already performed. */
+    done = self_p->dev_p->regs_p->channel[self_p->channel].CTRLA;
+    done = ((done & DMAC_CTRLA_BTSIZE_MASK) >> DMAC_CTRLA_BTSIZE_POS);
+
+    return (self_p->transfer_p->length - done);
+}
@@ -45,6 +45,11 @@
      | SAM_TWI_CWGR_CHDIV(206)                  \
      | SAM_TWI_CWGR_CKDIV(1))
 
+/* Transactions are queued and performed from the TWI interrupt. */
+#define I2C_PORT_HAS_ASYNC
+
+struct i2c_transaction_t;
+
 struct i2c_device_t {
     int id;
     volatile struct sam_twi_t *regs_p;
@@ -57,6 +62,15 @@ struct i2c_device_t {
         uint32_t mask;
     } sda;
     struct i2c_driver_t *drv_p;
+    struct {
+        struct i2c_transaction_t *head_p;
+        struct i2c_transaction_t *tail_p;
+    } transactions;
+    struct {
+        uint8_t *buf_p;
+        size_t size;
+        ssize_t res;
+    } master;
 };
 
 struct i2c_driver_t {
@@ -26,6 +26,154 @@
  * This file is part of the Simba project.
  */
 
+/**
+ * Start given transaction. The TWI can only send a repeated start
+ * condition between an internal address of up to three bytes and a
+ * read, so a transaction must be a single read or write, or a write
+ * of one to three bytes followed by a read.
+ */
+static void i2c_port_transaction_start_isr(
+    struct i2c_transaction_t *transaction_p)
+{
+    struct i2c_driver_t *drv_p;
+    struct i2c_device_t *dev_p;
+    volatile struct sam_twi_t *regs_p;
+    struct i2c_message_t *message_p;
+    const uint8_t *iadr_p;
+    uint32_t iadr;
+    size_t i;
+    size_t iadrsz;
+
+    drv_p = transaction_p->drv_p;
+    dev_p = drv_p->dev_p;
+    regs_p = dev_p->regs_p;
+    message_p = transaction_p->messages_p;
+    iadr = 0;
+    iadrsz = 0;
+
+    if ((transaction_p->length == 2)
+        && ((message_p[0].flags & I2C_MESSAGE_READ) == 0)
+        && ((message_p[1].flags & I2C_MESSAGE_READ) != 0)
+        && (message_p[0].size >= 1)
+        && (message_p[0].size <= 3)) {
+        iadr_p = message_p[0].buf_p;
+        iadrsz = message_p[0].size;
+
+        for (i = 0; i < iadrsz; i++) {
+            iadr <<= 8;
+            iadr |= iadr_p[i];
+        }
+
+        message_p++;
+    } else if (transaction_p->length != 1) {
+        transaction_complete_isr(dev_p, -ENOSYS);
+
+        return;
+    }
+
+    /* Reconfigure the clock if another driver used the bus last. */
+    if (dev_p->drv_p != drv_p) {
+        dev_p->drv_p = drv_p;
+        regs_p->CWGR = drv_p->cwgr;
+    }
+
+    dev_p->master.buf_p = message_p->buf_p;
+    dev_p->master.size = message_p->size;
+    dev_p->master.res = iadrsz;
+
+    if (message_p->flags & I2C_MESSAGE_READ) {
+        regs_p->MMR = (SAM_TWI_MMR_DADR(transaction_p->address)
+                       | SAM_TWI_MMR_IADRSZ(iadrsz)
+                       | SAM_TWI_MMR_MREAD);
+        regs_p->IADR = iadr;
+
+        /* The stop condition is sent after the byte being received
+           when it is requested. */
+        if (message_p->size == 1) {
+            regs_p->CR = (SAM_TWI_CR_START | SAM_TWI_CR_STOP);
+        } else {
+            regs_p->CR = SAM_TWI_CR_START;
+        }
+
+        regs_p->IER = (SAM_TWI_IER_RXRDY | SAM_TWI_IER_NACK);
+    } else {
+        regs_p->MMR = SAM_TWI_MMR_DADR(transaction_p->address);
+        regs_p->CR = SAM_TWI_CR_START;
+
+        /* The transmit holding register is empty, so the interrupt
+           handler writes the first byte. */
+        regs_p->IER = (SAM_TWI_IER_TXRDY | SAM_TWI_IER_NACK);
+    }
+}
+
+static void isr(struct i2c_device_t *dev_p)
+{
+    volatile struct sam_twi_t *regs_p;
+    uint32_t sr;
+    ssize_t res;
+
+    regs_p = dev_p->regs_p;
+    sr = (regs_p->SR & regs_p->IMR);
+
+    if (sr & SAM_TWI_SR_NACK) {
+        regs_p->IDR = (SAM_TWI_IDR_TXCOMP
+                       | SAM_TWI_IDR_RXRDY
+                       | SAM_TWI_IDR_TXRDY
+                       | SAM_TWI_IDR_NACK);
+
+        /* Not acknowledged address or data. */
+        res = dev_p->master.res;
+
+        if (res == 0) {
+            res = -1;
+        }
+
+        transaction_complete_isr(dev_p, res);
+
+        return;
+    }
+
+    if (sr & SAM_TWI_SR_RXRDY) {
+        *dev_p->master.buf_p++ = regs_p->RHR;
+        dev_p->master.size--;
+        dev_p->master.res++;
+
+        if (dev_p->master.size == 1) {
+            regs_p->CR = SAM_TWI_CR_STOP;
+        } else if (dev_p->master.size == 0) {
+            regs_p->IDR = SAM_TWI_IDR_RXRDY;
+            regs_p->IER = SAM_TWI_IER_TXCOMP;
+        }
+    }
+
+    if (sr & SAM_TWI_SR_TXRDY) {
+        if (dev_p->master.size > 0) {
+            regs_p->THR = *dev_p->master.buf_p++;
+            dev_p->master.size--;
+            dev_p->master.res++;
+        } else {
+            regs_p->CR = SAM_TWI_CR_STOP;
+            regs_p->IDR = SAM_TWI_IDR_TXRDY;
+            regs_p->IER = SAM_TWI_IER_TXCOMP;
+        }
+    }
+
+    if (sr & SAM_TWI_SR_TXCOMP) {
+        regs_p->IDR = (SAM_TWI_IDR_TXCOMP | SAM_TWI_IDR_NACK);
+        transaction_complete_isr(dev_p, dev_p->master.res);
+    }
+}
+
+ISR(twi0)
+{
+    isr(&i2c_device[0]);
+}
+
+ISR(twi1)
+{
+    isr(&i2c_device[1]);
+}
+
 int i2c_port_module_init()
 {
     return (0);
@@ -77,6 +225,7 @@ int i2c_port_start(struct i2c_driver_t *self_p)
 
     /* Master mode. */
     regs_p->CR = SAM_TWI_CR_MSEN;
+    nvic_enable_interrupt(dev_p->id);
 
     return (0);
 }
@@ -88,89 +237,6 @@ int i2c_port_stop(struct i2c_driver_t *self_p)
     return (0);
 }
 
-ssize_t i2c_port_read(struct i2c_driver_t *self_p,
-                      int address,
-                      void *buf_p,
-                      size_t size)
-{
-    volatile struct sam_twi_t *regs_p;
-    size_t i;
-    uint8_t *u8_buf_p;
-
-    u8_buf_p = buf_p;
-    regs_p = self_p->dev_p->regs_p;
-
-    /* Slave address and read command. */
-    regs_p->MMR = (SAM_TWI_MMR_DADR(address)
-                   | SAM_TWI_MMR_MREAD);
-
-    /* Read from the slave into given buffer. */
-    regs_p->CR = SAM_TWI_CR_START;
-
-    for (i = 0; i < size - 1; i++) {
-        while ((regs_p->SR & SAM_TWI_SR_RXRDY) == 0);
-
-        u8_buf_p[i] = regs_p->RHR;
-    }
-
-    /* Send the stop condition after next read. */
-    regs_p->CR = SAM_TWI_CR_STOP;
-
-    /* Read the last byte. */
-    while ((regs_p->SR & SAM_TWI_SR_RXRDY) == 0);
-
-    u8_buf_p[i] = regs_p->RHR;
-
-    /* Wait for completion. */
-    while ((regs_p->SR & SAM_TWI_SR_TXCOMP) == 0);
-
-    return (size);
-}
-
-ssize_t i2c_port_write(struct i2c_driver_t *self_p,
-                       int address,
-                       const void *buf_p,
-                       size_t size)
-{
-    ssize_t res;
-    volatile struct sam_twi_t *regs_p;
-    size_t i;
-    const uint8_t *u8_buf_p;
-    uint32_t sr;
-
-    res = size;
-    u8_buf_p = buf_p;
-    regs_p = self_p->dev_p->regs_p;
-
-    /* Slave address. */
-    regs_p->MMR = SAM_TWI_MMR_DADR(address);
-
-    /* Write given buffer to the slave. */
-    regs_p->CR = SAM_TWI_CR_START;
-
-    /* Write the first byte. */
-    for (i = 0; i < size; i++) {
-        regs_p->THR = u8_buf_p[i];
-
-        do {
-            sr = regs_p->SR;
-        } while ((sr & SAM_TWI_SR_TXRDY) == 0);
-
-        if (sr & SAM_TWI_SR_NACK) {
-            res = -1;
-            break;
-        }
-    }
-
-    /* Send the stop condition. */
-    regs_p->CR = SAM_TWI_CR_STOP;
-
-    /* Wait for completion. */
-    while ((regs_p->SR & SAM_TWI_SR_TXCOMP) == 0);
-
-    return (res);
-}
-
 int i2c_port_scan(struct i2c_driver_t *self_p,
                   int address)
 {
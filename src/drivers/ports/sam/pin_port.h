@@ -69,4 +69,36 @@ static inline int pin_port_device_write_low(const struct pin_device_t *dev_p)
     return (0);
 }
 
+static inline int pin_port_device_toggle(const struct pin_device_t *dev_p)
+{
+    if (dev_p->pio_p->ODSR & dev_p->mask) {
+        dev_p->pio_p->CODR = dev_p->mask;
+    } else {
+        dev_p->pio_p->SODR = dev_p->mask;
+    }
+
+    return (0);
+}
+
+/* Compile time constant pin devices. */
+#define PIN_PORT_HAS_STATIC                                    1
+#define PIN_PORT_DEVICE_STATIC_INITIALIZER(port, mask_)        \
+    { .pio_p = (port), .mask = (mask_) }
+
+/* Cycle counted busy wait loop for bit-banging drivers. */
+#define PIN_PORT_HAS_BUSY_WAIT                                 1
+#define PIN_PORT_BUSY_WAIT_CYCLES_PER_ITERATION                3
+
+static inline void pin_port_busy_wait(int iterations)
+{
+    if (iterations <= 0) {
+        return;
+    }
+
+    asm volatile("L_%=_pin_port_busy_wait:"       "\n\t"
+                 "subs   %0, #1"                  "\n\t"
+                 "bne    L_%=_pin_port_busy_wait" "\n"
+                 : "+r" (iterations) : );
+}
+
 #endif
@@ -66,15 +66,7 @@ static int pin_port_write(struct pin_driver_t *self_p, int value)
 
 static int pin_port_toggle(struct pin_driver_t *self_p)
 {
-    const struct pin_device_t *dev_p = self_p->dev_p;
-
-    if (dev_p->pio_p->ODSR & dev_p->mask) {
-        pin_device_write_low(dev_p);
-    } else {
-        pin_device_write_high(dev_p);
-    }
-
-    return (0);
+    return (pin_device_toggle(self_p->dev_p));
 }
 
 static int pin_port_set_mode(struct pin_driver_t *self_p, int mode)
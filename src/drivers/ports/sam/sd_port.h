@@ -0,0 +1,58 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2014-2018, Erik Moqvist
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use, copy,
+ * modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ * This file is part of the Simba project.
+ */
+
+#ifndef __DRIVERS_SD_PORT_H__
+#define __DRIVERS_SD_PORT_H__
+
+#include <io.h>
+
+/* MCCK, MCCDA and MCDA0-3 on PIOA, peripheral A. */
+#define SD_PORT_PINS_MASK                                       \
+    (SAM_PIO_P19 | SAM_PIO_P20 | SAM_PIO_P21                    \
+     | SAM_PIO_P22 | SAM_PIO_P23 | SAM_PIO_P24)
+
+struct sd_device_t {
+    volatile struct sam_hsmci_t *regs_p;
+    int id;
+    volatile struct sam_pio_t *pio_p;
+    int dma_request;
+};
+
+struct sd_host_t {
+    struct sd_device_t *dev_p;
+    uint32_t rca;
+    uint32_t cid[4];
+    uint32_t csd[4];
+#if CONFIG_DMA == 1
+    int8_t dma_state;                        /* 0: none, 1: ok, -1: failed. */
+    struct dma_driver_t dma;
+    struct dma_transfer_t transfer;
+#endif
+};
+
+#endif
@@ -0,0 +1,614 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2014-2018, Erik Moqvist
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use, copy,
+ * modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ * This file is part of the Simba project.
+ */
+
+/* Clock frequencies. MCCK is MCK / (2 * (CLKDIV + 1)). */
+#define CLKDIV_IDENTIFICATION     (F_CPU / 2 / 400000)
+#define CLKDIV_DEFAULT_SPEED                         1
+#define CLKDIV_HIGH_SPEED                            0
+
+/* Command flags. */
+#define CMDR_R1     (SAM_HSMCI_CMDR_RSPTYP_48_BIT | SAM_HSMCI_CMDR_MAXLAT)
+#define CMDR_R1B    (SAM_HSMCI_CMDR_RSPTYP_R1B | SAM_HSMCI_CMDR_MAXLAT)
+#define CMDR_R2     (SAM_HSMCI_CMDR_RSPTYP_136_BIT | SAM_HSMCI_CMDR_MAXLAT)
+#define CMDR_READ   (SAM_HSMCI_CMDR_TRCMD_START_DATA | SAM_HSMCI_CMDR_TRDIR)
+#define CMDR_WRITE  (SAM_HSMCI_CMDR_TRCMD_START_DATA)
+
+#define SR_RESPONSE_ERRORS (SAM_HSMCI_SR_RINDE                          \
+                            | SAM_HSMCI_SR_RDIRE                        \
+                            | SAM_HSMCI_SR_RCRCE                        \
+                            | SAM_HSMCI_SR_RENDE                        \
+                            | SAM_HSMCI_SR_RTOE                         \
+                            | SAM_HSMCI_SR_CSTOE)
+#define SR_DATA_ERRORS     (SAM_HSMCI_SR_DCRCE                          \
+                            | SAM_HSMCI_SR_DTOE                         \
+                            | SAM_HSMCI_SR_OVRE                         \
+                            | SAM_HSMCI_SR_UNRE)
+
+/* Transfer directions. */
+#define TRANSFER_READ                                0
+#define TRANSFER_WRITE                               1
+
+/* OCR register. */
+#define OCR_VOLTAGE_WINDOW                  0x00ff8000
+#define OCR_CCS                             0x40000000
+#define OCR_BUSY                            0x80000000
+
+/* Argument of the switch function command to enable high speed. */
+#define SWITCH_FUNC_HIGH_SPEED              0x80fffff1
+
+/* Size of the switch function status. */
+#define SWITCH_FUNC_STATUS_SIZE                     64
+
+/* Maximum number of blocks per transfer, limited by the DMA
+   controller. */
+#if CONFIG_DMA == 1
+#    define BLOCKS_MAX (DMA_PORT_LENGTH_MAX / (SD_BLOCK_SIZE / 4))
+#else
+#    define BLOCKS_MAX                                  0xffff
+#endif
+
+/**
+ * Wait for any of given status flags to be set. Busy wait for a
+ * short while, then sleep between polls.
+ */
+static int wait_for_status(volatile struct sam_hsmci_t *regs_p,
+                           uint32_t mask,
+                           int timeout_ms)
+{
+    int i;
+
+    for (i = 0; i < 1000; i++) {
+        if (regs_p->SR & mask) {
+            return (0);
+        }
+    }
+
+    for (i = 0; i < timeout_ms; i++) {
+        if (regs_p->SR & mask) {
+            return (0);
+        }
+
+        thrd_sleep_us(1000);
+    }
+
+    return (-ETIMEDOUT);
+}
+
+/**
+ * Send given command and wait for its response.
+ */
+static int command(struct sd_driver_t *self_p,
+                   uint32_t cmdr,
+                   uint32_t arg,
+                   uint32_t errors)
+{
+    volatile struct sam_hsmci_t *regs_p;
+    uint32_t sr;
+
+    regs_p = self_p->host.dev_p->regs_p;
+
+    regs_p->ARGR = arg;
+    regs_p->CMDR = cmdr;
+
+    if (wait_for_status(regs_p, SAM_HSMCI_SR_CMDRDY, 100) != 0) {
+        return (-ETIMEDOUT);
+    }
+
+    sr = regs_p->SR;
+
+    if (sr & errors) {
+        return (-EIO);
+    }
+
+    /* Wait for the card to release the data line. */
+    if ((cmdr & SAM_HSMCI_CMDR_RSPTYP_MASK) == SAM_HSMCI_CMDR_RSPTYP_R1B) {
+        if (wait_for_status(regs_p, SAM_HSMCI_SR_NOTBUSY, 1000) != 0) {
+            return (-ETIMEDOUT);
+        }
+    }
+
+    return (0);
+}
+
+static int command_r1(struct sd_driver_t *self_p,
+                      int index,
+                      uint32_t arg)
+{
+    return (command(self_p,
+                    SAM_HSMCI_CMDR_CMDNB(index) | CMDR_R1,
+                    arg,
+                    SR_RESPONSE_ERRORS));
+}
+
+static int application_command_r1(struct sd_driver_t *self_p,
+                                  int index,
+                                  uint32_t arg)
+{
+    if (command_r1(self_p, CMD_APP_CMD, self_p->host.rca) != 0) {
+        return (-1);
+    }
+
+    return (command_r1(self_p, index, arg));
+}
+
+/**
+ * Read a 136 bits response as big endian bytes, the same layout as
+ * the CID and CSD registers read in SPI mode.
+ */
+static void read_response_136(struct sd_driver_t *self_p,
+                              void *dst_p)
+{
+    int i;
+    uint32_t *dst_u32_p;
+
+    dst_u32_p = dst_p;
+
+    for (i = 0; i < 4; i++) {
+        dst_u32_p[i] = htonl(self_p->host.dev_p->regs_p->RSPR[0]);
+    }
+}
+
+/**
+ * Transfer data words between the FIFO and given buffer by polling
+ * the status register. Used for short and unaligned transfers.
+ */
+static int transfer_poll(struct sd_driver_t *self_p,
+                         int direction,
+                         void *buf_p,
+                         size_t size)
+{
+    volatile struct sam_hsmci_t *regs_p;
+    uint8_t *u8buf_p;
+    uint32_t word;
+    uint32_t flag;
+    size_t i;
+
+    regs_p = self_p->host.dev_p->regs_p;
+    u8buf_p = buf_p;
+
+    if (direction == TRANSFER_READ) {
+        flag = SAM_HSMCI_SR_RXRDY;
+    } else {
+        flag = SAM_HSMCI_SR_TXRDY;
+    }
+
+    for (i = 0; i < size; i += 4) {
+        if (wait_for_status(regs_p, flag | SR_DATA_ERRORS, 1000) != 0) {
+            return (-ETIMEDOUT);
+        }
+
+        if (regs_p->SR & SR_DATA_ERRORS) {
+            return (-EIO);
+        }
+
+        if (direction == TRANSFER_READ) {
+            word = regs_p->RDR;
+            memcpy(&u8buf_p[i], &word, 4);
+        } else {
+            memcpy(&word, &u8buf_p[i], 4);
+            regs_p->TDR = word;
+        }
+    }
+
+    return (0);
+}
+
+/**
+ * Transfer given data with DMA if the buffer is word aligned,
+ * otherwise by polling.
+ */
+static int transfer(struct sd_driver_t *self_p,
+                    int direction,
+                    void *buf_p,
+                    size_t size)
+{
+    volatile struct sam_hsmci_t *regs_p;
+    int res;
+
+    regs_p = self_p->host.dev_p->regs_p;
+
+#if CONFIG_DMA == 1
+    if ((self_p->host.dma_state == 1) && (((uintptr_t)buf_p & 0x3) == 0)) {
+        if (direction == TRANSFER_READ) {
+            dma_transfer_init(&self_p->host.transfer,
+                              DMA_PERIPHERAL_TO_MEMORY,
+                              buf_p,
+                              &regs_p->RDR,
+                              size / 4,
+                              DMA_WIDTH_32);
+        } else {
+            dma_transfer_init(&self_p->host.transfer,
+                              DMA_MEMORY_TO_PERIPHERAL,
+                              &regs_p->TDR,
+                              buf_p,
+                              size / 4,
+                              DMA_WIDTH_32);
+        }
+
+        regs_p->DMA = SAM_HSMCI_DMA_DMAEN;
+        res = dma_transfer(&self_p->host.dma, &self_p->host.transfer);
+        regs_p->DMA = 0;
+    } else {
+        res = transfer_poll(self_p, direction, buf_p, size);
+    }
+#else
+    res = transfer_poll(self_p, direction, buf_p, size);
+#endif
+
+    if (res != 0) {
+        return (res);
+    }
+
+    /* All blocks are transferred, and written blocks programmed, when
+       XFRDONE is set. */
+    if (wait_for_status(regs_p, SAM_HSMCI_SR_XFRDONE, 2000) != 0) {
+        return (-ETIMEDOUT);
+    }
+
+    if (regs_p->SR & SR_DATA_ERRORS) {
+        return (-EIO);
+    }
+
+    return (0);
+}
+
+/**
+ * Read or write given number of blocks with a single or multiple
+ * block command.
+ */
+static ssize_t transfer_blocks(struct sd_driver_t *self_p,
+                               int direction,
+                               void *buf_p,
+                               uint32_t block,
+                               size_t count)
+{
+    volatile struct sam_hsmci_t *regs_p;
+    uint32_t cmdr;
+    int index;
+    int res;
+
+    regs_p = self_p->host.dev_p->regs_p;
+
+    if (self_p->type != TYPE_SDHC) {
+        block <<= 9;
+    }
+
+    if (direction == TRANSFER_READ) {
+        index = (count == 1 ? CMD_READ_SINGLE_BLOCK : CMD_READ_MULTIPLE_BLOCK);
+        cmdr = CMDR_READ;
+    } else {
+        index = (count == 1 ? CMD_WRITE_BLOCK : CMD_WRITE_MULTIPLE_BLOCK);
+        cmdr = CMDR_WRITE;
+    }
+
+    if (count == 1) {
+        cmdr |= SAM_HSMCI_CMDR_TRTYP_SINGLE;
+    } else {
+        cmdr |= SAM_HSMCI_CMDR_TRTYP_MULTIPLE;
+    }
+
+    regs_p->BLKR = (SAM_HSMCI_BLKR_BCNT(count)
+                    | SAM_HSMCI_BLKR_BLKLEN(SD_BLOCK_SIZE));
+
+    res = command(self_p,
+                  SAM_HSMCI_CMDR_CMDNB(index) | CMDR_R1 | cmdr,
+                  block,
+                  SR_RESPONSE_ERRORS);
+
+    if (res != 0) {
+        return (direction == TRANSFER_READ
+                ? -SD_ERR_READ_COMMAND
+                : -SD_ERR_WRITE_BLOCK);
+    }
+
+    res = transfer(self_p, direction, buf_p, count * SD_BLOCK_SIZE);
+
+    /* Stop the transmission, also after an error. */
+    if (count > 1) {
+        if (command(self_p,
+                    (SAM_HSMCI_CMDR_CMDNB(CMD_STOP_TRANSMISSION)
+                     | CMDR_R1B
+                     | SAM_HSMCI_CMDR_TRCMD_STOP_DATA),
+                    0,
+                    SR_RESPONSE_ERRORS) != 0) {
+            if (res == 0) {
+                res = -SD_ERR_STOP_TRANSMISSION;
+            }
+        }
+    }
+
+    if (res != 0) {
+        return (res);
+    }
+
+    return (count * SD_BLOCK_SIZE);
+}
+
+static ssize_t transfer_blocks_chunked(struct sd_driver_t *self_p,
+                                       int direction,
+                                       void *buf_p,
+                                       uint32_t block,
+                                       size_t count)
+{
+    ssize_t res;
+    size_t n;
+    uint8_t *u8buf_p;
+
+    u8buf_p = buf_p;
+
+    while (count > 0) {
+        n = MIN(count, BLOCKS_MAX);
+        res = transfer_blocks(self_p, direction, u8buf_p, block, n);
+
+        if (res < 0) {
+            return (res);
+        }
+
+        u8buf_p += res;
+        block += n;
+        count -= n;
+    }
+
+    return (u8buf_p - (uint8_t *)buf_p);
+}
+
+/**
+ * Switch the card to high speed mode. Returns zero(0) if the card
+ * supports high speed.
+ */
+static int switch_to_high_speed(struct sd_driver_t *self_p)
+{
+    volatile struct sam_hsmci_t *regs_p;
+    uint32_t status[SWITCH_FUNC_STATUS_SIZE / 4];
+    uint8_t *u8status_p;
+
+    regs_p = self_p->host.dev_p->regs_p;
+    u8status_p = (uint8_t *)&status[0];
+
+    regs_p->BLKR = (SAM_HSMCI_BLKR_BCNT(1)
+                    | SAM_HSMCI_BLKR_BLKLEN(SWITCH_FUNC_STATUS_SIZE));
+
+    if (command(self_p,
+                (SAM_HSMCI_CMDR_CMDNB(CMD_SWITCH_FUNC)
+                 | CMDR_R1
+                 | CMDR_READ
+                 | SAM_HSMCI_CMDR_TRTYP_SINGLE),
+                SWITCH_FUNC_HIGH_SPEED,
+                SR_RESPONSE_ERRORS) != 0) {
+        return (-1);
+    }
+
+    if (transfer_poll(self_p,
+                      TRANSFER_READ,
+                      &status[0],
+                      sizeof(status)) != 0) {
+        return (-1);
+    }
+
+    if (wait_for_status(regs_p, SAM_HSMCI_SR_XFRDONE, 100) != 0) {
+        return (-1);
+    }
+
+    /* Function group 1 is set to function 1, high speed, on
+       success. */
+    return ((u8status_p[16] & 0xf) == 1 ? 0 : -1);
+}
+
+static int sd_port_start(struct sd_driver_t *self_p)
+{
+    struct sd_device_t *dev_p;
+    volatile struct sam_hsmci_t *regs_p;
+    uint32_t ocr;
+    int i;
+
+    dev_p = self_p->host.dev_p;
+    regs_p = dev_p->regs_p;
+    self_p->type = TYPE_UNKNOWN;
+    self_p->host.rca = 0;
+
+#if CONFIG_DMA == 1
+    if (self_p->host.dma_state == 0) {
+        self_p->host.dma_state = -1;
+
+        if (dma_module_init() == 0) {
+            if (dma_init(&self_p->host.dma,
+                         &dma_device[0],
+                         dev_p->dma_request) == 0) {
+                self_p->host.dma_state = 1;
+            }
+        }
+    }
+#endif
+
+    pmc_peripheral_clock_enable(dev_p->id);
+
+    /* Let the peripheral control the pins. */
+    dev_p->pio_p->PDR = SD_PORT_PINS_MASK;
+    dev_p->pio_p->PUER = SD_PORT_PINS_MASK;
+    dev_p->pio_p->ABSR &= ~SD_PORT_PINS_MASK;
+
+    regs_p->CR = SAM_HSMCI_CR_SWRST;
+    regs_p->IDR = 0xffffffff;
+    regs_p->DTOR = (SAM_HSMCI_DTOR_DTOCYC(0xf) | SAM_HSMCI_DTOR_DTOMUL(7));
+    regs_p->CSTOR = (SAM_HSMCI_CSTOR_CSTOCYC(0xf)
+                     | SAM_HSMCI_CSTOR_CSTOMUL(7));
+    regs_p->CFG = (SAM_HSMCI_CFG_FIFOMODE | SAM_HSMCI_CFG_FERRCTRL);
+    regs_p->MR = (SAM_HSMCI_MR_CLKDIV(CLKDIV_IDENTIFICATION)
+                  | SAM_HSMCI_MR_PWSDIV(7)
+                  | SAM_HSMCI_MR_RDPROOF
+                  | SAM_HSMCI_MR_WRPROOF);
+    regs_p->SDCR = (SAM_HSMCI_SDCR_SDCSEL(0) | SAM_HSMCI_SDCR_SDCBUS_1);
+    regs_p->CR = (SAM_HSMCI_CR_MCIEN | SAM_HSMCI_CR_PWSDIS);
+
+    /* Send 74 clock cycles. */
+    if (command(self_p, SAM_HSMCI_CMDR_SPCMD_INIT, 0, 0) != 0) {
+        return (-SD_ERR_GO_IDLE_STATE);
+    }
+
+    /* Reset the card. */
+    if (command(self_p, SAM_HSMCI_CMDR_CMDNB(CMD_GO_IDLE_STATE), 0, 0) != 0) {
+        return (-SD_ERR_GO_IDLE_STATE);
+    }
+
+    /* Check for version 2.00 or later of the specification; 2.7-3.6V
+       and check pattern. */
+    if (command_r1(self_p, CMD_SEND_IF_COND, 0x100 | CHECK_PATTERN) != 0) {
+        return (-SD_ERR_SEND_IF_COND);
+    }
+
+    if ((regs_p->RSPR[0] & 0xff) != CHECK_PATTERN) {
+        return (-SD_ERR_CHECK_PATTERN);
+    }
+
+    self_p->type = TYPE_SD2;
+
+    /* Tell the card that the host supports SDHC, and wait for it to
+       finish its power up. The R3 response has no CRC. */
+    for (i = 0; i < 1000; i++) {
+        if (command_r1(self_p, CMD_APP_CMD, 0) != 0) {
+            return (-SD_ERR_SD_SEND_OP_COND);
+        }
+
+        if (command(self_p,
+                    SAM_HSMCI_CMDR_CMDNB(ACMD_SD_SEND_OP_COND) | CMDR_R1,
+                    OCR_CCS | OCR_VOLTAGE_WINDOW,
+                    SR_RESPONSE_ERRORS & ~SAM_HSMCI_SR_RCRCE) != 0) {
+            return (-SD_ERR_SD_SEND_OP_COND);
+        }
+
+        ocr = regs_p->RSPR[0];
+
+        if (ocr & OCR_BUSY) {
+            break;
+        }
+
+        thrd_sleep_us(1000);
+    }
+
+    if (i == 1000) {
+        return (-SD_ERR_SD_SEND_OP_COND);
+    }
+
+    if (ocr & OCR_CCS) {
+        self_p->type = TYPE_SDHC;
+    }
+
+    /* Identification. */
+    if (command(self_p,
+                SAM_HSMCI_CMDR_CMDNB(CMD_ALL_SEND_CID) | CMDR_R2,
+                0,
+                SR_RESPONSE_ERRORS) != 0) {
+        return (-SD_ERR_ALL_SEND_CID);
+    }
+
+    read_response_136(self_p, &self_p->host.cid);
+
+    if (command_r1(self_p, CMD_SEND_RELATIVE_ADDR, 0) != 0) {
+        return (-SD_ERR_SEND_RELATIVE_ADDR);
+    }
+
+    self_p->host.rca = (regs_p->RSPR[0] & 0xffff0000);
+
+    if (command(self_p,
+                SAM_HSMCI_CMDR_CMDNB(CMD_SEND_CSD) | CMDR_R2,
+                self_p->host.rca,
+                SR_RESPONSE_ERRORS) != 0) {
+        return (-SD_ERR_SEND_CSD);
+    }
+
+    read_response_136(self_p, &self_p->host.csd);
+
+    /* Enter the transfer state. */
+    if (command(self_p,
+                SAM_HSMCI_CMDR_CMDNB(CMD_SELECT_DESELECT_CARD) | CMDR_R1B,
+                self_p->host.rca,
+                SR_RESPONSE_ERRORS) != 0) {
+        return (-SD_ERR_SELECT_CARD);
+    }
+
+    /* Use all four data lines. */
+    if (application_command_r1(self_p, ACMD_SET_BUS_WIDTH, 2) != 0) {
+        return (-SD_ERR_SET_BUS_WIDTH);
+    }
+
+    regs_p->SDCR = (SAM_HSMCI_SDCR_SDCSEL(0) | SAM_HSMCI_SDCR_SDCBUS_4);
+
+    if (self_p->type != TYPE_SDHC) {
+        if (command_r1(self_p, CMD_SET_BLOCKLEN, SD_BLOCK_SIZE) != 0) {
+            return (-SD_ERR_SET_BLOCKLEN);
+        }
+    }
+
+    /* Raise the clock frequency, to high speed if supported by the
+       card. */
+    regs_p->MR &= ~SAM_HSMCI_MR_CLKDIV_MASK;
+
+    if (switch_to_high_speed(self_p) == 0) {
+        regs_p->CFG |= SAM_HSMCI_CFG_HSMODE;
+        regs_p->MR |= SAM_HSMCI_MR_CLKDIV(CLKDIV_HIGH_SPEED);
+    } else {
+        regs_p->MR |= SAM_HSMCI_MR_CLKDIV(CLKDIV_DEFAULT_SPEED);
+    }
+
+    return (0);
+}
+
+static int sd_port_stop(struct sd_driver_t *self_p)
+{
+    volatile struct sam_hsmci_t *regs_p;
+
+    regs_p = self_p->host.dev_p->regs_p;
+    regs_p->CR = SAM_HSMCI_CR_MCIDIS;
+    pmc_peripheral_clock_disable(self_p->host.dev_p->id);
+
+    return (0);
+}
+
+static ssize_t sd_port_read_blocks(struct sd_driver_t *self_p,
+                                   void *dst_p,
+                                   uint32_t src_block,
+                                   size_t count)
+{
+    return (transfer_blocks_chunked(self_p,
+                                    TRANSFER_READ,
+                                    dst_p,
+                                    src_block,
+                                    count));
+}
+
+static ssize_t sd_port_write_blocks(struct sd_driver_t *self_p,
+                                    uint32_t dst_block,
+                                    const void *src_p,
+                                    size_t count)
+{
+    return (transfer_blocks_chunked(self_p,
+                                    TRANSFER_WRITE,
+                                    (void *)src_p,
+                                    dst_block,
+                                    count));
+}
@@ -40,7 +40,11 @@
 #define SPI_PORT_SPEED_250KBPS  (F_CPU /  250000)
 #define SPI_PORT_SPEED_125KBPS  (F_CPU /  120000)
 
+/* Transactions are queued and completed from interrupt context. */
+#define SPI_PORT_HAS_ASYNC
+
 struct spi_driver_t;
+struct spi_transaction_t;
 
 struct spi_device_t {
     struct spi_driver_t *drv_p;
@@ -50,6 +54,19 @@ struct spi_device_t {
     struct pin_device_t *sck_p;
     int id;
     struct mutex_t mutex;
+    struct {
+        struct spi_transaction_t *head_p;
+        struct spi_transaction_t *tail_p;
+    } transactions;
+#if CONFIG_DMA == 1
+    struct {
+        int8_t state;                        /* 0: none, 1: ok, -1: failed. */
+        struct dma_driver_t tx;
+        struct dma_driver_t rx;
+        struct dma_transfer_t tx_transfer;
+        struct dma_transfer_t rx_transfer;
+    } dma;
+#endif
 };
 
 struct spi_driver_t {
@@ -62,7 +79,7 @@ struct spi_driver_t {
     uint8_t *rxbuf_p;                        /* Transfer receive buffer or NULL. */
     const uint8_t *txbuf_p;                  /* Transfer transmit buffer or NULL. */
     size_t size;                             /* Number of bytes left to transfer. */
-    struct thrd_t *thrd_p;                   /* Waiting thread. */
+    size_t total;                            /* Transfer size. */
 };
 
 #endif
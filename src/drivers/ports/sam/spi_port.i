@@ -26,6 +26,10 @@
  * This file is part of the Simba project.
  */
 
+/* DMA controller hardware interface numbers of SPI0. */
+#define DMA_REQUEST_SPI0_TX                                     1
+#define DMA_REQUEST_SPI0_RX                                     2
+
 /**
  * SPI TX complete interrupt.
  */
@@ -51,11 +55,11 @@ ISR(spi0)
         *drv_p->rxbuf_p++ = drv_p->dev_p->regs_p->RDR;
     }
 
-    /* Resume on complete transfer. */
+    /* Complete the transaction on complete transfer. */
     if (drv_p->size == 0) {
         /* Disable tx interrupt. */
         dev_p->regs_p->IDR = (SPI_IDR_TXEMPTY);
-        thrd_resume_isr(drv_p->thrd_p, 0);
+        transaction_complete_isr(dev_p, drv_p->total);
     } else {
         /* Write next byte. */
         if (drv_p->txbuf_p != NULL) {
@@ -68,9 +72,113 @@ ISR(spi0)
     }
 }
 
+#if CONFIG_DMA == 1
+
+/**
+ * Called when the RX DMA transfer is complete, that is, when the
+ * last byte has been received.
+ */
+static void dma_rx_complete_isr(void *arg_p, int res)
+{
+    struct spi_device_t *dev_p;
+
+    dev_p = arg_p;
+
+    if (res != 0) {
+        dma_stop_isr(&dev_p->dma.tx);
+        transaction_complete_isr(dev_p, res);
+    } else {
+        transaction_complete_isr(dev_p, dev_p->drv_p->total);
+    }
+}
+
+/**
+ * Called when the TX DMA transfer is complete, that is, when the
+ * last byte has been written to the transmit data register.
+ */
+static void dma_tx_complete_isr(void *arg_p, int res)
+{
+    struct spi_device_t *dev_p;
+
+    dev_p = arg_p;
+
+    if (res != 0) {
+        dma_stop_isr(&dev_p->dma.rx);
+        transaction_complete_isr(dev_p, res);
+    } else if (dev_p->drv_p->rxbuf_p == NULL) {
+        /* Complete from the SPI interrupt when the last byte has been
+           shifted out. */
+        dev_p->regs_p->IER = (SPI_IER_TXEMPTY);
+    }
+}
+
+static int dma_transfer_start_isr(struct spi_driver_t *self_p,
+                                  void *rxbuf_p,
+                                  const void *txbuf_p,
+                                  size_t n)
+{
+    struct spi_device_t *dev_p;
+
+    dev_p = self_p->dev_p;
+
+    /* Discard any stale received byte and clear overrun. */
+    (void)dev_p->regs_p->RDR;
+    (void)dev_p->regs_p->SR;
+
+    if (rxbuf_p != NULL) {
+        /* Transmit 0xff, the receive buffer is overwritten anyway. */
+        if (txbuf_p == NULL) {
+            memset(rxbuf_p, 0xff, n);
+            txbuf_p = rxbuf_p;
+        }
+
+        dma_transfer_init(&dev_p->dma.rx_transfer,
+                          DMA_PERIPHERAL_TO_MEMORY,
+                          rxbuf_p,
+                          &dev_p->regs_p->RDR,
+                          n,
+                          DMA_WIDTH_8);
+        dma_transfer_set_callback(&dev_p->dma.rx_transfer,
+                                  dma_rx_complete_isr,
+                                  dev_p);
+
+        if (dma_async_start_isr(&dev_p->dma.rx,
+                                &dev_p->dma.rx_transfer) != 0) {
+            return (-1);
+        }
+    }
+
+    dma_transfer_init(&dev_p->dma.tx_transfer,
+                      DMA_MEMORY_TO_PERIPHERAL,
+                      (void *)&dev_p->regs_p->TDR,
+                      txbuf_p,
+                      n,
+                      DMA_WIDTH_8);
+    dma_transfer_set_callback(&dev_p->dma.tx_transfer,
+                              dma_tx_complete_isr,
+                              dev_p);
+
+    if (dma_async_start_isr(&dev_p->dma.tx,
+                            &dev_p->dma.tx_transfer) != 0) {
+        if (rxbuf_p != NULL) {
+            dma_stop_isr(&dev_p->dma.rx);
+        }
+
+        return (-1);
+    }
+
+    return (0);
+}
+
+#endif
+
 static int spi_port_module_init(void)
 {
+#if CONFIG_DMA == 1
+    return (dma_module_init());
+#else
     return (0);
+#endif
 }
 
 static int spi_port_init(struct spi_driver_t *self_p,
@@ -88,6 +196,26 @@ static int spi_port_init(struct spi_driver_t *self_p,
         pin_init(&self_p->ss, ss_pin_p, PIN_INPUT);
     }
 
+#if CONFIG_DMA == 1
+    /* Allocate DMA channels once per device. Fall back to interrupt
+       driven transfers if no channels are available. */
+    if (dev_p->dma.state == 0) {
+        dev_p->dma.state = -1;
+
+        if (dma_init(&dev_p->dma.tx,
+                     &dma_device[0],
+                     DMA_REQUEST_SPI0_TX) == 0) {
+            if (dma_init(&dev_p->dma.rx,
+                         &dma_device[0],
+                         DMA_REQUEST_SPI0_RX) == 0) {
+                dev_p->dma.state = 1;
+            } else {
+                dma_deinit(&dev_p->dma.tx);
+            }
+        }
+    }
+#endif
+
     return (0);
 }
 
@@ -145,19 +273,38 @@ static int spi_port_stop(struct spi_driver_t *self_p)
     return (0);
 }
 
-static ssize_t spi_port_transfer(struct spi_driver_t *self_p,
-                                 void *rxbuf_p,
-                                 const void *txbuf_p,
-                                 size_t n)
+/**
+ * Start a transfer. Called with the system lock taken or from
+ * interrupt context. The transaction is completed from interrupt
+ * context.
+ */
+static void spi_port_transfer_start_isr(struct spi_driver_t *self_p,
+                                        void *rxbuf_p,
+                                        const void *txbuf_p,
+                                        size_t n)
 {
     struct spi_device_t *dev_p = self_p->dev_p;
 
     self_p->rxbuf_p = rxbuf_p;
     self_p->txbuf_p = txbuf_p;
-    self_p->size = (n - 1);
-    self_p->thrd_p = thrd_self();
+    self_p->total = n;
 
-    sys_lock();
+#if CONFIG_DMA == 1
+    if ((dev_p->dma.state == 1)
+        && (n >= CONFIG_SPI_DMA_SIZE_MIN)
+        && (n <= DMA_PORT_LENGTH_MAX)) {
+        /* The TX complete interrupt is only enabled for transmit
+           only transfers, which has nothing left to transfer once
+           it fires. */
+        self_p->size = 0;
+
+        if (dma_transfer_start_isr(self_p, rxbuf_p, txbuf_p, n) == 0) {
+            return;
+        }
+    }
+#endif
+
+    self_p->size = (n - 1);
 
     /* Write first byte. The rest are written from isr. */
     if (self_p->txbuf_p != NULL) {
@@ -168,10 +315,4 @@ static ssize_t spi_port_transfer(struct spi_driver_t *self_p,
 
     /* Enable tx interrupt. */
     dev_p->regs_p->IER = (SPI_IER_TXEMPTY);
-
-    thrd_suspend_isr(NULL);
-
-    sys_unlock();
-
-    return (n);
 }
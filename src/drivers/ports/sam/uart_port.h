@@ -36,6 +36,8 @@
  */
 #define UART_PORT_FRAME_FORMAT_DEFAULT 0
 
+#define UART_PORT_HAS_FLOW_CONTROL
+
 struct uart_device_t {
     struct uart_driver_t *drv_p;         /* Current started driver. */
     volatile struct sam_uart_t *regs_p;
@@ -62,6 +64,7 @@ struct uart_driver_t {
     struct thrd_t *thrd_p;
     long baudrate;
     int format;
+    struct uart_flow_control_t flow_control;
 };
 
 #endif
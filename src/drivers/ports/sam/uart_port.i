@@ -44,6 +44,41 @@ static int uart_port_module_init()
     return (0);
 }
 
+static void uart_port_send_char_isr(struct uart_driver_t *self_p,
+                                    uint8_t c)
+{
+    volatile struct sam_uart_t *regs_p;
+    uint32_t ptsr;
+
+    regs_p = self_p->dev_p->regs_p;
+
+    /* Pause the PDC while writing the character ahead of any ongoing
+       transfer. */
+    ptsr = regs_p->PDC.PTSR;
+    regs_p->PDC.PTCR = (PERIPH_PTCR_TXTDIS);
+
+    while ((regs_p->CSR & US_CSR_TXRDY) == 0);
+
+    regs_p->THR = c;
+
+    if (ptsr & PERIPH_PTSR_TXTEN) {
+        regs_p->PDC.PTCR = (PERIPH_PTCR_TXTEN);
+    }
+}
+
+static void uart_port_tx_stop_isr(struct uart_driver_t *self_p)
+{
+    self_p->dev_p->regs_p->PDC.PTCR = (PERIPH_PTCR_TXTDIS);
+}
+
+static void uart_port_tx_resume_isr(struct uart_driver_t *self_p)
+{
+    /* Continue an ongoing transfer. */
+    if (self_p->dev_p->regs_p->PDC.TCR > 0) {
+        self_p->dev_p->regs_p->PDC.PTCR = (PERIPH_PTCR_TXTEN);
+    }
+}
+
 static int uart_port_start(struct uart_driver_t *self_p)
 {
     uint16_t cd;
@@ -131,16 +166,16 @@ static ssize_t uart_port_write_cb(void *arg_p,
     self_p = container_of(arg_p, struct uart_driver_t, base);
     dev_p = self_p->dev_p;
 
-    mutex_lock(&self_p->mutex);
-
     sys_lock();
 
     /* Initiate transfer by writing to the PDC registers. */
     dev_p->regs_p->PDC.TPR = (uint32_t)txbuf_p;
     dev_p->regs_p->PDC.TCR = size;
 
-    /* Enalbe the PDC. */
-    dev_p->regs_p->PDC.PTCR = (PERIPH_PTCR_TXTEN);
+    /* Enalbe the PDC, unless XOFF was received. */
+    if (self_p->flow_control.tx_stopped == 0) {
+        dev_p->regs_p->PDC.PTCR = (PERIPH_PTCR_TXTEN);
+    }
 
     dev_p->regs_p->IER = (US_IER_ENDTX);
 
@@ -153,8 +188,6 @@ static ssize_t uart_port_write_cb(void *arg_p,
 
     sys_unlock();
 
-    mutex_unlock(&self_p->mutex);
-
     return (size);
 }
 
@@ -191,11 +224,11 @@ static void isr(int index)
 
         if (error == 0) {
             /* Write data to input queue. */
-            if (queue_write_isr(&drv_p->base, dev_p->rxbuf, 1) != 1) {
-                fs_counter_increment(&rx_channel_overflow, 1);
+            if (rx_write_isr(drv_p, dev_p->rxbuf, 1) != 1) {
+                fs_counter_increment_isr(&rx_channel_overflow, 1);
             }
         } else {
-            fs_counter_increment(&rx_errors, 1);
+            fs_counter_increment_isr(&rx_errors, 1);
         }
 
         /* Reset counter to receive next byte. */
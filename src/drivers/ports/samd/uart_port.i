@@ -128,8 +128,6 @@ static ssize_t uart_port_write_cb(void *arg_p,
     self_p = container_of(arg_p, struct uart_driver_t, base);
     dev_p = self_p->dev_p;
 
-    mutex_lock(&self_p->mutex);
-
     sys_lock();
 
     /* Initiate transfer by writing to the PDC registers. */
@@ -150,8 +148,6 @@ static ssize_t uart_port_write_cb(void *arg_p,
 
     sys_unlock();
 
-    mutex_unlock(&self_p->mutex);
-
     return (size);
 }
 
@@ -189,10 +185,10 @@ static void isr(int index)
         if (error == 0) {
             /* Write data to input queue. */
             if (queue_write_isr(&drv_p->base, dev_p->rxbuf, 1) != 1) {
-                fs_counter_increment(&rx_channel_overflow, 1);
+                fs_counter_increment_isr(&rx_channel_overflow, 1);
             }
         } else {
-            fs_counter_increment(&rx_errors, 1);
+            fs_counter_increment_isr(&rx_errors, 1);
         }
 
         /* Reset counter to receive next byte. */
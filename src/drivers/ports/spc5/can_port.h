@@ -62,6 +62,10 @@ struct can_driver_t {
     size_t txsize;
     struct queue_t chin;
     struct mutex_t mutex;
+    struct {
+        const struct can_filter_t *filters_p;
+        int length;
+    } filters;
 };
 
 #endif
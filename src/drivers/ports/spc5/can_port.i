@@ -44,7 +44,7 @@ static void read_frame_from_hw(struct can_driver_t *self_p,
                   >> SPC5_FLEXCAN_MSGBUF_CTRL_STATUS_LENGTH_POS);
     frame.rtr = 0;
 #if CONFIG_CAN_FRAME_TIMESTAMP == 1
-    frame.timestamp = 0;
+    frame.timestamp = timestamp_isr();
 #endif
     frame.data.u32[0] = msgbuf_p->DATA[0];
     frame.data.u32[1] = msgbuf_p->DATA[1];
@@ -68,6 +68,11 @@ static void read_frame_from_hw(struct can_driver_t *self_p,
         msgbuf_p->CTRL_STATUS = SPC5_FLEXCAN_MSGBUF_CTRL_STATUS_CODE(4);
     }
 
+    /* No hardware filters are used, filter in software. */
+    if (!is_frame_accepted_isr(self_p, &frame)) {
+        return;
+    }
+
     /* Write the received frame to the application input channel. */
     if (queue_unused_size_isr(&self_p->chin) >= sizeof(frame)) {
         queue_write_isr(&self_p->chin,
@@ -80,7 +85,7 @@ static void read_frame_from_hw(struct can_driver_t *self_p,
             self_p->base.reader_p = NULL;
         }
     } else {
-        fs_counter_increment(&rx_channel_overflow, 1);
+        fs_counter_increment_isr(&rx_channel_overflow, 1);
     }
 }
 
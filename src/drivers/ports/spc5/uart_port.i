@@ -90,12 +90,12 @@ static void rx_isr(int index)
         /* Write data to input queue. */
         if (queue_write_isr(&drv_p->base, &c, 1) != 1) {
 #if CONFIG_FS_COUNTERS_UART == 1
-            fs_counter_increment(&rx_channel_overflow, 1);
+            fs_counter_increment_isr(&rx_channel_overflow, 1);
 #endif
         }
     } else {
 #if CONFIG_FS_COUNTERS_UART == 1
-        fs_counter_increment(&errors, 1);
+        fs_counter_increment_isr(&errors, 1);
 #endif
     }
 }
@@ -110,7 +110,7 @@ static void err_isr(int index)
                              | SPC5_LINFLEX_UARTSR_BOF);
 
 #if CONFIG_FS_COUNTERS_UART == 1
-    fs_counter_increment(&errors, 1);
+    fs_counter_increment_isr(&errors, 1);
 #endif
 }
 
@@ -205,8 +205,6 @@ static ssize_t uart_port_write_cb(void *arg_p,
     self_p = container_of(arg_p, struct uart_driver_t, base);
     regs_p = self_p->dev_p->regs_p;
 
-    mutex_lock(&self_p->mutex);
-
     self_p->txbuf_p = (txbuf_p + 1);
     self_p->txsize = (size - 1);
     self_p->thrd_p = thrd_self();
@@ -218,8 +216,6 @@ static ssize_t uart_port_write_cb(void *arg_p,
     thrd_suspend_isr(NULL);
     sys_unlock();
 
-    mutex_unlock(&self_p->mutex);
-
     return (size);
 }
 
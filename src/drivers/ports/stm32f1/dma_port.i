@@ -0,0 +1,222 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2014-2018, Erik Moqvist
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use, copy,
+ * modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ * This file is part of the Simba project.
+ */
+
+
+static void channel_disable(struct dma_driver_t *self_p)
+{
+    volatile struct stm32_dma_t *regs_p;
+
+    regs_p = self_p->dev_p->regs_p;
+    regs_p->CHANNEL[self_p->channel].CCR = 0;
+    regs_p->IFCR = STM32_DMA_IFCR_ALL(self_p->channel);
+}
+
+static void isr(int channel)
+{
+    struct dma_device_t *dev_p;
+    struct dma_driver_t *self_p;
+    uint32_t status;
+
+    dev_p = &dma_device[0];
+    self_p = dev_p->channels[channel];
+    status = dev_p->regs_p->ISR;
+
+    if (self_p == NULL) {
+        dev_p->regs_p->IFCR = STM32_DMA_IFCR_ALL(channel);
+
+        return;
+    }
+
+    if (status & STM32_DMA_ISR_TEIF(channel)) {
+        channel_disable(self_p);
+        transfer_complete_isr(self_p, -EIO);
+    } else if (status & STM32_DMA_ISR_TCIF(channel)) {
+        if (self_p->transfer_p->flags & DMA_CIRCULAR) {
+            dev_p->regs_p->IFCR = STM32_DMA_IFCR_ALL(channel);
+        } else {
+            channel_disable(self_p);
+        }
+
+        transfer_complete_isr(self_p, 0);
+    }
+}
+
+ISR(dma1_ch1)
+{
+    isr(0);
+}
+
+ISR(dma1_ch2)
+{
+    isr(1);
+}
+
+ISR(dma1_ch3)
+{
+    isr(2);
+}
+
+ISR(dma1_ch4)
+{
+    isr(3);
+}
+
+ISR(dma1_ch5)
+{
+    isr(4);
+}
+
+ISR(dma1_ch6)
+{
+    isr(5);
+}
+
+ISR(dma1_ch7)
+{
+    isr(6);
+}
+
+static int dma_port_module_init(void)
+{
+    STM32_RCC->AHBENR |= STM32_RCC_AHBENR_DMA1EN;
+
+    return (0);
+}
+
+/**
+ * Peripheral requests are hardwired to channels, so the request is
+ * the channel number, 1 to 7.
+ */
+static int dma_port_channel_alloc(struct dma_driver_t *self_p,
+                                  int request)
+{
+    struct dma_device_t *dev_p;
+    int channel;
+
+    dev_p = self_p->dev_p;
+
+    if (request == DMA_REQUEST_NONE) {
+        for (channel = DMA_PORT_CHANNELS_MAX - 1; channel >= 0; channel--) {
+            if (dev_p->channels[channel] == NULL) {
+                break;
+            }
+        }
+    } else if ((request >= 1) && (request <= DMA_PORT_CHANNELS_MAX)) {
+        channel = (request - 1);
+
+        if (dev_p->channels[channel] != NULL) {
+            channel = -1;
+        }
+    } else {
+        return (-EINVAL);
+    }
+
+    if (channel < 0) {
+        return (-EBUSY);
+    }
+
+    dev_p->channels[channel] = self_p;
+    self_p->channel = channel;
+    nvic_enable_interrupt(dev_p->irq + channel);
+
+    return (0);
+}
+
+static void dma_port_channel_free(struct dma_driver_t *self_p)
+{
+    self_p->dev_p->channels[self_p->channel] = NULL;
+}
+
+static int dma_port_start(struct dma_driver_t *self_p,
+                          struct dma_transfer_t *transfer_p)
+{
+    volatile struct stm32_dma_t *regs_p;
+    int channel;
+    int width;
+    uint32_t ccr;
+    uint32_t cpar;
+    uint32_t cmar;
+
+    regs_p = self_p->dev_p->regs_p;
+    channel = self_p->channel;
+    width = (transfer_p->flags & DMA_WIDTH_MASK);
+
+    ccr = (STM32_DMA_CCR_PSIZE(width)
+           | STM32_DMA_CCR_MSIZE(width)
+           | STM32_DMA_CCR_MINC
+           | STM32_DMA_CCR_TCIE
+           | STM32_DMA_CCR_TEIE);
+
+    switch (transfer_p->direction) {
+
+    case DMA_MEMORY_TO_PERIPHERAL:
+        ccr |= STM32_DMA_CCR_DIR;
+        cpar = (uint32_t)transfer_p->dst_p;
+        cmar = (uint32_t)transfer_p->src_p;
+        break;
+
+    case DMA_PERIPHERAL_TO_MEMORY:
+        cpar = (uint32_t)transfer_p->src_p;
+        cmar = (uint32_t)transfer_p->dst_p;
+        break;
+
+    default:
+        /* The peripheral side is the incrementing source. */
+        if (transfer_p->flags & DMA_CIRCULAR) {
+            return (-EINVAL);
+        }
+
+        ccr |= (STM32_DMA_CCR_MEM2MEM | STM32_DMA_CCR_PINC);
+        cpar = (uint32_t)transfer_p->src_p;
+        cmar = (uint32_t)transfer_p->dst_p;
+        break;
+    }
+
+    if (transfer_p->flags & DMA_CIRCULAR) {
+        ccr |= STM32_DMA_CCR_CIRC;
+    }
+
+    channel_disable(self_p);
+    regs_p->CHANNEL[channel].CNDTR = transfer_p->length;
+    regs_p->CHANNEL[channel].CPAR = cpar;
+    regs_p->CHANNEL[channel].CMAR = cmar;
+    regs_p->CHANNEL[channel].CCR = ccr;
+    regs_p->CHANNEL[channel].CCR = (ccr | STM32_DMA_CCR_EN);
+
+    return (0);
+}
+
+static void dma_port_stop(struct dma_driver_t *self_p)
+{
+    channel_disable(self_p);
+}
+
+static ssize_t dma_port_get_remaining(struct dma_driver_t *self_p)
+{
+    return (self_p->dev_p->regs_p->CHANNEL[self_p->channel].CNDTR);
+}
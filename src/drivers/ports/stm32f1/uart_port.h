@@ -31,9 +31,24 @@
 
 #define UART_PORT_FRAME_FORMAT_DEFAULT 0
 
+#define UART_PORT_HAS_FLOW_CONTROL
+
 struct uart_device_t {
     struct uart_driver_t *drv_p;
     volatile struct stm32_usart_t *regs_p;
+#if CONFIG_UART_DMA == 1
+    struct {
+        int tx_request;
+        int rx_request;
+        int8_t state;                        /* 0: none, 1: ok, -1: failed. */
+        struct dma_driver_t tx;
+        struct dma_driver_t rx;
+        struct dma_transfer_t tx_transfer;
+        struct dma_transfer_t rx_transfer;
+        size_t rxpos;                        /* Next byte to hand to the reader. */
+        uint8_t rxbuf[CONFIG_UART_DMA_RX_BUFFER_SIZE];
+    } dma;
+#endif
 };
 
 struct uart_driver_t {
@@ -45,6 +60,7 @@ struct uart_driver_t {
     struct thrd_t *thrd_p;
     long baudrate;
     int format; /* bits 0-7 are 8-15 of CR1, bits 8-15 are 8-15 of CR2 */
+    struct uart_flow_control_t flow_control;
 };
 
 #endif
@@ -28,8 +28,123 @@
 
 static struct fs_counter_t rx_channel_overflow;
 static struct fs_counter_t rx_errors;
+static struct fs_counter_t rx_overrun;
 static struct fs_counter_t tx_resume_thrd_null;
 
+#if CONFIG_UART_DMA == 1
+
+static void dma_rx_write_isr(struct uart_driver_t *drv_p,
+                             const uint8_t *buf_p,
+                             size_t size)
+{
+    ssize_t res;
+
+    if (size == 0) {
+        return;
+    }
+
+    res = rx_write_isr(drv_p, buf_p, size);
+
+    if (res < 0) {
+        res = 0;
+    }
+
+    if (res != size) {
+        fs_counter_increment_isr(&rx_channel_overflow, size - res);
+    }
+}
+
+/**
+ * Hand all bytes written by the DMA controller since last time to
+ * the reader.
+ */
+static void dma_rx_flush_isr(struct uart_device_t *dev_p)
+{
+    struct uart_driver_t *drv_p;
+    size_t head;
+
+    drv_p = dev_p->drv_p;
+
+    if (drv_p == NULL) {
+        return;
+    }
+
+    head = (CONFIG_UART_DMA_RX_BUFFER_SIZE
+            - dma_get_remaining_isr(&dev_p->dma.rx));
+
+    if (head == CONFIG_UART_DMA_RX_BUFFER_SIZE) {
+        head = 0;
+    }
+
+    /* The buffer has wrapped. */
+    if (head < dev_p->dma.rxpos) {
+        dma_rx_write_isr(drv_p,
+                         &dev_p->dma.rxbuf[dev_p->dma.rxpos],
+                         CONFIG_UART_DMA_RX_BUFFER_SIZE - dev_p->dma.rxpos);
+        dev_p->dma.rxpos = 0;
+    }
+
+    dma_rx_write_isr(drv_p,
+                     &dev_p->dma.rxbuf[dev_p->dma.rxpos],
+                     head - dev_p->dma.rxpos);
+    dev_p->dma.rxpos = head;
+}
+
+/**
+ * Called once per lap of the circular receive buffer.
+ */
+static void dma_rx_complete_isr(void *arg_p, int res)
+{
+    if (res != 0) {
+        fs_counter_increment_isr(&rx_errors, 1);
+    }
+
+    dma_rx_flush_isr(arg_p);
+}
+
+static int dma_rx_start(struct uart_device_t *dev_p)
+{
+    dev_p->dma.rxpos = 0;
+    dma_transfer_init(&dev_p->dma.rx_transfer,
+                      DMA_PERIPHERAL_TO_MEMORY,
+                      &dev_p->dma.rxbuf[0],
+                      &dev_p->regs_p->DR,
+                      CONFIG_UART_DMA_RX_BUFFER_SIZE,
+                      DMA_WIDTH_8 | DMA_CIRCULAR);
+    dma_transfer_set_callback(&dev_p->dma.rx_transfer,
+                              dma_rx_complete_isr,
+                              dev_p);
+
+    return (dma_async_start(&dev_p->dma.rx, &dev_p->dma.rx_transfer));
+}
+
+/**
+ * Allocate DMA channels once per device. Falls back to interrupt
+ * driven transfers if no channels are available.
+ */
+static int dma_channels_init(struct uart_device_t *dev_p)
+{
+    if (dev_p->dma.state == 0) {
+        dev_p->dma.state = -1;
+
+        if (dma_init(&dev_p->dma.tx,
+                     &dma_device[0],
+                     dev_p->dma.tx_request) == 0) {
+            if (dma_init(&dev_p->dma.rx,
+                         &dma_device[0],
+                         dev_p->dma.rx_request) == 0) {
+                dev_p->dma.state = 1;
+            } else {
+                dma_deinit(&dev_p->dma.tx);
+            }
+        }
+    }
+
+    return (dev_p->dma.state == 1);
+}
+
+#endif
+
 static void isr(int index)
 {
     struct uart_device_t *dev_p = &uart_device[index];
@@ -45,18 +160,50 @@ static void isr(int index)
 
     sr = regs_p->SR;
 
+    /* A byte was lost as the previous was not read in time. It is
+       cleared when the data register is read below. */
+    if (sr & STM32_USART_SR_ORE) {
+        fs_counter_increment_isr(&rx_overrun, 1);
+    }
+
+#if CONFIG_UART_DMA == 1
+    if (dev_p->dma.state == 1) {
+        /* Clear the idle line and overrun flags by reading the data
+           register after the status register, then hand received
+           bytes to the reader. */
+        if (sr & (STM32_USART_SR_IDLE | STM32_USART_SR_ORE)) {
+            (void)regs_p->DR;
+            dma_rx_flush_isr(dev_p);
+        }
+
+        sr &= ~STM32_USART_SR_RXNE;
+    }
+#endif
+
     /* TX complete. */
     if (sr & STM32_USART_SR_TC) {
         if (drv_p->txsize > 0) {
-            regs_p->DR = *drv_p->txbuf_p++;
-            drv_p->txsize--;
+            /* Stopped by XOFF. Resumed by XON. */
+            if (drv_p->flow_control.tx_stopped == 1) {
+                regs_p->SR = ~STM32_USART_SR_TC;
+            } else {
+                regs_p->DR = *drv_p->txbuf_p++;
+                drv_p->txsize--;
+            }
+#if CONFIG_UART_DMA == 1
+        } else if ((dev_p->dma.state == 1)
+                   && (dma_get_remaining_isr(&dev_p->dma.tx) > 0)) {
+            /* DMA requests paused by XOFF. */
+            regs_p->SR = ~STM32_USART_SR_TC;
+#endif
         } else {
             regs_p->SR = ~STM32_USART_SR_TC;
 
             if (drv_p->thrd_p != NULL) {
                 thrd_resume_isr(drv_p->thrd_p, 0);
+                drv_p->thrd_p = NULL;
             } else {
-                fs_counter_increment(&tx_resume_thrd_null, 1);
+                fs_counter_increment_isr(&tx_resume_thrd_null, 1);
             }
         }
     }
@@ -69,11 +216,11 @@ static void isr(int index)
             byte = regs_p->DR;
 
             /* Write data to input queue. */
-            if (queue_write_isr(&drv_p->base, &byte, 1) != 1) {
-                fs_counter_increment(&rx_channel_overflow, 1);
+            if (rx_write_isr(drv_p, &byte, 1) != 1) {
+                fs_counter_increment_isr(&rx_channel_overflow, 1);
             }
         } else {
-            fs_counter_increment(&rx_errors, 1);
+            fs_counter_increment_isr(&rx_errors, 1);
         }
     }
 }
@@ -93,6 +240,51 @@ ISR(usart3)
     isr(2);
 }
 
+static void uart_port_send_char_isr(struct uart_driver_t *self_p,
+                                    uint8_t c)
+{
+    volatile struct stm32_usart_t *regs_p;
+    uint32_t cr3;
+
+    regs_p = self_p->dev_p->regs_p;
+
+    /* Pause DMA requests while writing the character ahead of any
+       ongoing transfer. */
+    cr3 = regs_p->CR3;
+    regs_p->CR3 = (cr3 & ~STM32_USART_CR3_DMAT);
+
+    while ((regs_p->SR & STM32_USART_SR_TXE) == 0);
+
+    regs_p->DR = c;
+    regs_p->CR3 = cr3;
+}
+
+static void uart_port_tx_stop_isr(struct uart_driver_t *self_p)
+{
+    self_p->dev_p->regs_p->CR3 &= ~STM32_USART_CR3_DMAT;
+}
+
+static void uart_port_tx_resume_isr(struct uart_driver_t *self_p)
+{
+    volatile struct stm32_usart_t *regs_p;
+
+    regs_p = self_p->dev_p->regs_p;
+
+#if CONFIG_UART_DMA == 1
+    if (self_p->dev_p->dma.state == 1) {
+        regs_p->CR3 |= STM32_USART_CR3_DMAT;
+
+        return;
+    }
+#endif
+
+    /* Continue an ongoing interrupt driven transfer. */
+    if ((self_p->txsize > 0) && (self_p->thrd_p != NULL)) {
+        regs_p->DR = *self_p->txbuf_p++;
+        self_p->txsize--;
+    }
+}
+
 static int uart_port_module_init()
 {
     fs_counter_init(&rx_channel_overflow,
@@ -105,12 +297,21 @@ static int uart_port_module_init()
                     0);
     fs_counter_register(&rx_errors);
 
+    fs_counter_init(&rx_overrun,
+                    FSTR("/drivers/uart/rx_overrun"),
+                    0);
+    fs_counter_register(&rx_overrun);
+
     fs_counter_init(&tx_resume_thrd_null,
                     FSTR("/drivers/uart/tx_resume_thrd_null"),
                     0);
     fs_counter_register(&tx_resume_thrd_null);
 
+#if CONFIG_UART_DMA == 1
+    return (dma_module_init());
+#else
     return (0);
+#endif
 }
 
 static int uart_port_start(struct uart_driver_t *self_p)
@@ -126,14 +327,53 @@ static int uart_port_start(struct uart_driver_t *self_p)
     regs_p->CR3 = 0;
     regs_p->BRR = ((F_CPU / 16 / self_p->baudrate) << 4);
     regs_p->SR = 0;
+
+#if CONFIG_UART_DMA == 1
+    if (dma_channels_init(dev_p) == 1) {
+        /* The DMA controller reads received bytes, and the idle line
+           interrupt hands them to the reader. */
+        regs_p->CR3 = (STM32_USART_CR3_DMAR
+                       | STM32_USART_CR3_DMAT
+                       | STM32_USART_CR3_EIE);
+        regs_p->CR1 = (((self_p->format << 8) & 0x0000ff00)
+                       | STM32_USART_CR1_UE
+                       | STM32_USART_CR1_TCIE
+                       | STM32_USART_CR1_IDLEIE
+                       | STM32_USART_CR1_TE
+                       | STM32_USART_CR1_RE);
+        dev_p->drv_p = self_p;
+
+        if (dma_rx_start(dev_p) != 0) {
+            dev_p->drv_p = NULL;
+            regs_p->CR1 = 0;
+            regs_p->CR3 = 0;
+
+            return (-1);
+        }
+    } else {
+        regs_p->CR1 = (((self_p->format << 8) & 0x0000ff00)
+                       | STM32_USART_CR1_UE
+                       | STM32_USART_CR1_TCIE
+                       | STM32_USART_CR1_RXNEIE
+                       | STM32_USART_CR1_TE
+                       | STM32_USART_CR1_RE);
+    }
+#else
     regs_p->CR1 = (((self_p->format << 8) & 0x0000ff00)
                    | STM32_USART_CR1_UE
                    | STM32_USART_CR1_TCIE
                    | STM32_USART_CR1_RXNEIE
                    | STM32_USART_CR1_TE
                    | STM32_USART_CR1_RE);
+#endif
+
     regs_p->CR2 = (self_p->format & 0x0000ff00);
 
+    /* The transmitter waits for CTS in hardware. */
+    if (self_p->flow_control.mode == UART_FLOW_CONTROL_RTS_CTS) {
+        regs_p->CR3 |= STM32_USART_CR3_CTSE;
+    }
+
     /* nvic */
     nvic_enable_interrupt(37);
 
@@ -146,6 +386,13 @@ static int uart_port_stop(struct uart_driver_t *self_p)
 {
     self_p->dev_p->regs_p->CR1 = 0;
 
+#if CONFIG_UART_DMA == 1
+    if (self_p->dev_p->dma.state == 1) {
+        dma_stop(&self_p->dev_p->dma.rx);
+        self_p->dev_p->regs_p->CR3 = 0;
+    }
+#endif
+
     return (0);
 }
 
@@ -157,20 +404,57 @@ static ssize_t uart_port_write_cb(void *arg_p,
 
     self_p = container_of(arg_p, struct uart_driver_t, base);
 
-    mutex_lock(&self_p->mutex);
+#if CONFIG_UART_DMA == 1
+    struct uart_device_t *dev_p;
+    ssize_t res;
+
+    dev_p = self_p->dev_p;
+
+    if (dev_p->dma.state == 1) {
+        dma_transfer_init(&dev_p->dma.tx_transfer,
+                          DMA_MEMORY_TO_PERIPHERAL,
+                          &dev_p->regs_p->DR,
+                          txbuf_p,
+                          size,
+                          DMA_WIDTH_8);
 
-    /* Initiate transfer by writing the first byte. */
-    self_p->txbuf_p = (txbuf_p + 1);
-    self_p->txsize = (size - 1);
+        /* The transmission complete interrupt resumes the thread
+           once the last byte has been sent. */
+        self_p->txsize = 0;
+        self_p->thrd_p = thrd_self();
+
+        sys_lock();
+        dev_p->regs_p->SR = ~STM32_USART_SR_TC;
+
+        res = dma_async_start_isr(&dev_p->dma.tx, &dev_p->dma.tx_transfer);
+
+        if (res == 0) {
+            thrd_suspend_isr(NULL);
+            res = size;
+        }
+
+        sys_unlock();
+
+        return (res);
+    }
+#endif
+
+    self_p->txbuf_p = txbuf_p;
+    self_p->txsize = size;
     self_p->thrd_p = thrd_self();
 
     sys_lock();
-    self_p->dev_p->regs_p->DR = self_p->txbuf_p[-1];
+
+    /* Initiate transfer by writing the first byte, unless XOFF was
+       received. */
+    if (self_p->flow_control.tx_stopped == 0) {
+        self_p->dev_p->regs_p->DR = *self_p->txbuf_p++;
+        self_p->txsize--;
+    }
+
     thrd_suspend_isr(NULL);
     sys_unlock();
 
-    mutex_unlock(&self_p->mutex);
-
     return (size);
 }
 
@@ -64,10 +64,10 @@ static void isr(int index)
 
             /* Write data to input queue. */
             if (queue_write_isr(&drv_p->base, &byte, 1) != 1) {
-                fs_counter_increment(&rx_channel_overflow, 1);
+                fs_counter_increment_isr(&rx_channel_overflow, 1);
             }
         } else {
-            fs_counter_increment(&rx_errors, 1);
+            fs_counter_increment_isr(&rx_errors, 1);
         }
     }
 }
@@ -166,8 +166,6 @@ static ssize_t uart_port_write_cb(void *arg_p,
 
     self_p = container_of(arg_p, struct uart_driver_t, base);
 
-    mutex_lock(&self_p->mutex);
-
     /* Initiate transfer by writing the first byte. */
     self_p->txbuf_p = (txbuf_p + 1);
     self_p->txsize = (size - 1);
@@ -178,8 +176,6 @@ static ssize_t uart_port_write_cb(void *arg_p,
     thrd_suspend_isr(NULL);
     sys_unlock();
 
-    mutex_unlock(&self_p->mutex);
-
     return (size);
 }
 
@@ -38,6 +38,9 @@
 #define RECALL_E          0xb8
 #define READ_POWER_SUPPLY 0xb4
 
+/* Completion poll period in ds18b20_convert_wait(). */
+#define CONVERT_POLL_PERIOD_MS                             10
+
 struct ds18b20_scratchpad_t {
     int16_t temperature;
     int8_t high_trigger;
@@ -76,7 +79,12 @@ static int cmd_list_cb(int argc,
     self_p = module.list_p;
 
     while (self_p != NULL) {
-        owi_search(self_p->owi_p);
+        /* Search the bus only once, the result is kept by the OWI
+           driver. */
+        if (self_p->owi_p->len == 0) {
+            owi_search(self_p->owi_p);
+        }
+
         ds18b20_convert(self_p);
         dev_p = self_p->owi_p->devices_p;
 
@@ -174,18 +182,92 @@ int ds18b20_convert(struct ds18b20_driver_t *self_p)
 {
     ASSERTN(self_p != NULL, EINVAL);
 
+    int res;
+
+    res = ds18b20_convert_async(self_p);
+
+    if (res != 0) {
+        return (res);
+    }
+
+    return (ds18b20_convert_wait(self_p));
+}
+
+int ds18b20_convert_async(struct ds18b20_driver_t *self_p)
+{
+    ASSERTN(self_p != NULL, EINVAL);
+
     uint8_t b;
 
+    /* Parasite powered sensors pull the bus low in the read time
+       slot. */
+    owi_reset(self_p->owi_p);
+    b = OWI_SKIP_ROM;
+    owi_write(self_p->owi_p, &b, 8);
+    b = READ_POWER_SUPPLY;
+    owi_write(self_p->owi_p, &b, 8);
+    b = 0;
+    owi_read(self_p->owi_p, &b, 1);
+    self_p->convert.parasite = ((b & 0x1) == 0);
+
+    /* All sensors on the bus convert in parallel. */
     owi_reset(self_p->owi_p);
     b = OWI_SKIP_ROM;
     owi_write(self_p->owi_p, &b, 8);
     b = CONVERT_T;
     owi_write(self_p->owi_p, &b, 8);
-    thrd_sleep_ms(750);
+    time_get(&self_p->convert.start);
 
     return (0);
 }
 
+int ds18b20_convert_is_done(struct ds18b20_driver_t *self_p)
+{
+    ASSERTN(self_p != NULL, EINVAL);
+
+    struct time_t now;
+    struct time_t elapsed;
+    uint8_t b;
+
+    time_get(&now);
+    time_subtract(&elapsed, &now, &self_p->convert.start);
+
+    if ((elapsed.seconds > 0)
+        || (elapsed.nanoseconds >= 1000000L * DS18B20_CONVERT_TIME_MS)) {
+        return (1);
+    }
+
+    if (self_p->convert.parasite) {
+        return (0);
+    }
+
+    /* Sensors still converting pull the bus low in the read time
+       slot. */
+    b = 0;
+    owi_read(self_p->owi_p, &b, 1);
+
+    return (b & 0x1);
+}
+
+int ds18b20_convert_wait(struct ds18b20_driver_t *self_p)
+{
+    ASSERTN(self_p != NULL, EINVAL);
+
+    int res;
+
+    while (1) {
+        res = ds18b20_convert_is_done(self_p);
+
+        if (res != 0) {
+            break;
+        }
+
+        thrd_sleep_ms(CONVERT_POLL_PERIOD_MS);
+    }
+
+    return (res < 0 ? res : 0);
+}
+
 #if CONFIG_FLOAT == 1
 
 int ds18b20_read(struct ds18b20_driver_t *self_p,
@@ -34,9 +34,16 @@
 /* DS18B20 one wire family code. */
 #define DS18B20_FAMILY_CODE 0x28
 
+/* Maximum temperature conversion time in milliseconds. */
+#define DS18B20_CONVERT_TIME_MS 750
+
 struct ds18b20_driver_t {
     struct owi_driver_t *owi_p;
     struct ds18b20_driver_t *next_p;
+    struct {
+        struct time_t start;
+        int8_t parasite;
+    } convert;
 };
 
 /**
@@ -63,8 +70,9 @@ int ds18b20_init(struct ds18b20_driver_t *self_p,
                  struct owi_driver_t *owi_p);
 
 /**
- * Start a temperature convertion on all sensors. The converted
- * temperature can later be read with ``ds18b20_read*()``.
+ * Start a temperature convertion on all sensors and wait for it to
+ * complete. The converted temperature can later be read with
+ * ``ds18b20_read*()``.
  *
  * @param[in] self_p Initialized driver object.
  *
@@ -72,6 +80,42 @@ int ds18b20_init(struct ds18b20_driver_t *self_p,
  */
 int ds18b20_convert(struct ds18b20_driver_t *self_p);
 
+/**
+ * Start a temperature convertion on all sensors at once without
+ * waiting for it to complete. Call ``ds18b20_convert_is_done()`` or
+ * ``ds18b20_convert_wait()`` before reading the converted
+ * temperatures with ``ds18b20_read*()``.
+ *
+ * @param[in] self_p Initialized driver object.
+ *
+ * @return zero(0) or negative error code.
+ */
+int ds18b20_convert_async(struct ds18b20_driver_t *self_p);
+
+/**
+ * Check if the convertion started by ``ds18b20_convert_async()`` has
+ * completed on all sensors. Externally powered sensors report
+ * completion on the bus, often well before the worst case 750 ms
+ * convertion time. Parasite powered sensors can not, and the worst
+ * case time is used if any such sensor is on the bus.
+ *
+ * @param[in] self_p Initialized driver object.
+ *
+ * @return true(1) if completed, false(0) if not, otherwise negative
+ *         error code.
+ */
+int ds18b20_convert_is_done(struct ds18b20_driver_t *self_p);
+
+/**
+ * Wait for the convertion started by ``ds18b20_convert_async()`` to
+ * complete on all sensors.
+ *
+ * @param[in] self_p Initialized driver object.
+ *
+ * @return zero(0) or negative error code.
+ */
+int ds18b20_convert_wait(struct ds18b20_driver_t *self_p);
+
 /**
  * Read the most recently converted temperature from given sensor.
  *
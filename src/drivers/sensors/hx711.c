@@ -211,3 +211,324 @@ int hx711_set_offset(struct hx711_driver_t *self_p,
 }
 
 #endif
+
+#if CONFIG_HX711_SAMPLER == 1
+
+/* Hold PD_SCK high at least 60 us to reset the devices. */
+#define RESET_US 100
+
+/* What triggers sampling. */
+#define PACING_NONE                              0
+#define PACING_TIMER                             1
+#define PACING_EXTI                              2
+
+static RAM_CODE void write_samples_isr(struct hx711_sampler_t *self_p,
+                                       struct time_t *timestamp_p)
+{
+    struct hx711_sampler_device_t *device_p;
+    size_t head;
+    size_t i;
+
+    for (i = 0; i < self_p->length; i++) {
+        device_p = &self_p->devices_p[i];
+        head = device_p->head;
+
+        if ((head - device_p->tail) > device_p->mask) {
+            device_p->overflows++;
+            continue;
+        }
+
+        /* Sign extension. */
+        if (0x800000 & device_p->value) {
+            device_p->value |= 0xff000000;
+        }
+
+        device_p->buf_p[head & device_p->mask].timestamp = *timestamp_p;
+        device_p->buf_p[head & device_p->mask].value = device_p->value;
+        device_p->head = (head + 1);
+
+        /* Wake the reader once per batch. */
+        if (device_p->thrd_p != NULL) {
+            thrd_resume_isr(device_p->thrd_p, 0);
+            device_p->thrd_p = NULL;
+        }
+    }
+}
+
+static void on_timeout_isr(void *arg_p)
+{
+    (void)hx711_sampler_sample_isr(arg_p);
+}
+
+#if CONFIG_EXTI == 1
+
+static RAM_CODE void on_drdy_isr(void *arg_p)
+{
+    struct hx711_sampler_t *self_p;
+
+    self_p = arg_p;
+
+    if (hx711_sampler_sample_isr(self_p) == 1) {
+        /* Ignore the edges of the clocked out data bits. */
+        (void)exti_clear(&self_p->exti);
+    }
+}
+
+#endif
+
+/**
+ * Configure the pins and reset all devices.
+ */
+static void reset_devices(struct hx711_sampler_t *self_p)
+{
+    size_t i;
+
+    for (i = 0; i < self_p->length; i++) {
+        pin_device_set_mode(self_p->devices_p[i].driver_p->dout_p,
+                            PIN_INPUT);
+    }
+
+    pin_device_set_mode(self_p->pd_sck_p, PIN_OUTPUT);
+    pin_device_write_high(self_p->pd_sck_p);
+    time_busy_wait_us(RESET_US);
+    pin_device_write_low(self_p->pd_sck_p);
+}
+
+int hx711_sampler_device_init(struct hx711_sampler_device_t *self_p,
+                              struct hx711_driver_t *driver_p,
+                              struct hx711_sample_t *buf_p,
+                              size_t length)
+{
+    ASSERTN(self_p != NULL, EINVAL);
+    ASSERTN(driver_p != NULL, EINVAL);
+    ASSERTN(buf_p != NULL, EINVAL);
+    ASSERTN((length > 0) && ((length & (length - 1)) == 0), EINVAL);
+
+    self_p->driver_p = driver_p;
+    self_p->buf_p = buf_p;
+    self_p->mask = (length - 1);
+    self_p->head = 0;
+    self_p->tail = 0;
+    self_p->overflows = 0;
+    self_p->thrd_p = NULL;
+
+    return (0);
+}
+
+int hx711_sampler_init(struct hx711_sampler_t *self_p,
+                       struct hx711_sampler_device_t *devices_p,
+                       size_t length,
+                       enum hx711_channel_gain_t channel_gain)
+{
+    ASSERTN(self_p != NULL, EINVAL);
+    ASSERTN(devices_p != NULL, EINVAL);
+    ASSERTN(length > 0, EINVAL);
+
+    size_t i;
+
+    self_p->devices_p = devices_p;
+    self_p->length = length;
+    self_p->channel_gain = channel_gain;
+    self_p->pd_sck_p = devices_p[0].driver_p->pd_sck_p;
+    self_p->pacing = PACING_NONE;
+
+    for (i = 1; i < length; i++) {
+        if (devices_p[i].driver_p->pd_sck_p != self_p->pd_sck_p) {
+            return (-EINVAL);
+        }
+    }
+
+    return (0);
+}
+
+int hx711_sampler_start(struct hx711_sampler_t *self_p,
+                        const struct time_t *period_p)
+{
+    ASSERTN(self_p != NULL, EINVAL);
+
+    reset_devices(self_p);
+
+    if (period_p == NULL) {
+        self_p->pacing = PACING_NONE;
+
+        return (0);
+    }
+
+    self_p->pacing = PACING_TIMER;
+    timer_init(&self_p->timer,
+               period_p,
+               on_timeout_isr,
+               self_p,
+               TIMER_PERIODIC);
+
+    return (timer_start(&self_p->timer));
+}
+
+#if CONFIG_EXTI == 1
+
+int hx711_sampler_start_exti(struct hx711_sampler_t *self_p,
+                             struct exti_device_t *drdy_p)
+{
+    ASSERTN(self_p != NULL, EINVAL);
+    ASSERTN(drdy_p != NULL, EINVAL);
+
+    int res;
+
+    res = exti_init(&self_p->exti,
+                    drdy_p,
+                    EXTI_TRIGGER_FALLING_EDGE,
+                    on_drdy_isr,
+                    self_p);
+
+    if (res != 0) {
+        return (res);
+    }
+
+    reset_devices(self_p);
+    self_p->pacing = PACING_EXTI;
+
+    return (exti_start(&self_p->exti));
+}
+
+#endif
+
+int hx711_sampler_stop(struct hx711_sampler_t *self_p)
+{
+    ASSERTN(self_p != NULL, EINVAL);
+
+    int res;
+
+    switch (self_p->pacing) {
+
+    case PACING_TIMER:
+        res = timer_stop(&self_p->timer);
+
+        if (res > 0) {
+            res = 0;
+        }
+        break;
+
+#if CONFIG_EXTI == 1
+    case PACING_EXTI:
+        res = exti_stop(&self_p->exti);
+        break;
+#endif
+
+    default:
+        res = 0;
+        break;
+    }
+
+    self_p->pacing = PACING_NONE;
+
+    return (res);
+}
+
+RAM_CODE int hx711_sampler_sample_isr(struct hx711_sampler_t *self_p)
+{
+    struct time_t timestamp;
+    size_t i;
+    int bit;
+
+    /* All devices must have finished their conversions. */
+    for (i = 0; i < self_p->length; i++) {
+        if (pin_device_read(self_p->devices_p[i].driver_p->dout_p) != 0) {
+            return (0);
+        }
+    }
+
+    sys_uptime_isr(&timestamp);
+
+    for (i = 0; i < self_p->length; i++) {
+        self_p->devices_p[i].value = 0;
+    }
+
+    /* Clock out the 24 data bits of all devices in parallel. */
+    for (bit = 0; bit < 24; bit++) {
+        pin_device_write_high(self_p->pd_sck_p);
+        time_busy_wait_us(1);
+
+        for (i = 0; i < self_p->length; i++) {
+            self_p->devices_p[i].value <<= 1;
+            self_p->devices_p[i].value |=
+                pin_device_read(self_p->devices_p[i].driver_p->dout_p);
+        }
+
+        pin_device_write_low(self_p->pd_sck_p);
+        time_busy_wait_us(1);
+    }
+
+    /* Select channel and gain of the next conversion with 1-3
+       additional pulses. */
+    for (bit = 0; bit < self_p->channel_gain; bit++) {
+        pin_device_write_high(self_p->pd_sck_p);
+        time_busy_wait_us(1);
+        pin_device_write_low(self_p->pd_sck_p);
+        time_busy_wait_us(1);
+    }
+
+    write_samples_isr(self_p, &timestamp);
+
+    return (1);
+}
+
+ssize_t hx711_sampler_read(struct hx711_sampler_device_t *self_p,
+                           struct hx711_sample_t *samples_p,
+                           size_t length,
+                           struct time_t *timeout_p)
+{
+    ASSERTN(self_p != NULL, EINVAL);
+    ASSERTN(samples_p != NULL, EINVAL);
+
+    size_t tail;
+    size_t size;
+    size_t i;
+    int res;
+
+    sys_lock();
+
+    if (self_p->head == self_p->tail) {
+        self_p->thrd_p = thrd_self();
+        res = thrd_suspend_isr(timeout_p);
+        self_p->thrd_p = NULL;
+
+        if (res != 0) {
+            sys_unlock();
+
+            return (res);
+        }
+    }
+
+    size = (self_p->head - self_p->tail);
+
+    sys_unlock();
+
+    if (size > length) {
+        size = length;
+    }
+
+    /* Only the interrupt handler writes the head and only this
+       function writes the tail, so the copy is done without the
+       system lock. */
+    tail = self_p->tail;
+
+    for (i = 0; i < size; i++) {
+        samples_p[i] = self_p->buf_p[(tail + i) & self_p->mask];
+    }
+
+    /* Free the slots after they have been copied. */
+    sys_lock();
+    self_p->tail = (tail + size);
+    sys_unlock();
+
+    return (size);
+}
+
+uint32_t hx711_sampler_get_overflows(struct hx711_sampler_device_t *self_p)
+{
+    ASSERTN(self_p != NULL, EINVAL);
+
+    return (self_p->overflows);
+}
+
+#endif
@@ -45,6 +45,44 @@ struct hx711_driver_t {
     float offset;
 };
 
+/* A timestamped raw sample. */
+struct hx711_sample_t {
+    struct time_t timestamp;
+    int32_t value;
+};
+
+/**
+ * A device sampled by a sampler. Samples are written to a single
+ * producer, single consumer ring buffer in the interrupt handler,
+ * and read in batches by a thread.
+ */
+struct hx711_sampler_device_t {
+    struct hx711_driver_t *driver_p;
+    struct hx711_sample_t *buf_p;
+    size_t mask;
+    volatile size_t head;
+    volatile size_t tail;
+    uint32_t overflows;
+    int32_t value;
+    struct thrd_t *thrd_p;
+};
+
+/**
+ * Continuous sampling of one or more HX711 sharing a PD_SCK pin. All
+ * devices are clocked in parallel from an interrupt handler.
+ */
+struct hx711_sampler_t {
+    struct hx711_sampler_device_t *devices_p;
+    size_t length;
+    enum hx711_channel_gain_t channel_gain;
+    struct pin_device_t *pd_sck_p;
+    int pacing;
+    struct timer_t timer;
+#if CONFIG_EXTI == 1
+    struct exti_driver_t exti;
+#endif
+};
+
 /**
  * Initialize the hx711 module. This function must be called before
  * calling any other function in this module.
@@ -146,4 +184,125 @@ int hx711_set_scale(struct hx711_driver_t *self_p,
 int hx711_set_offset(struct hx711_driver_t *self_p,
                      float offset);
 
+/**
+ * Initialize given sampler device. Requires ``CONFIG_HX711_SAMPLER``.
+ *
+ * @param[out] self_p Sampler device to initialize.
+ * @param[in] driver_p Initialized driver object of the device.
+ * @param[in] buf_p Ring buffer of samples.
+ * @param[in] length Number of samples in the ring buffer. Must be a
+ *                   power of two.
+ *
+ * @return zero(0) or negative error code.
+ */
+int hx711_sampler_device_init(struct hx711_sampler_device_t *self_p,
+                              struct hx711_driver_t *driver_p,
+                              struct hx711_sample_t *buf_p,
+                              size_t length);
+
+/**
+ * Initialize given sampler of given devices, which must all share
+ * the same PD_SCK pin. Requires ``CONFIG_HX711_SAMPLER``.
+ *
+ * @param[out] self_p Sampler to initialize.
+ * @param[in] devices_p Array of initialized sampler devices.
+ * @param[in] length Number of devices in the array.
+ * @param[in] channel_gain Channel and gain combination of all
+ *                         samples but the first, which is always
+ *                         channel A with gain 128.
+ *
+ * @return zero(0) or negative error code.
+ */
+int hx711_sampler_init(struct hx711_sampler_t *self_p,
+                       struct hx711_sampler_device_t *devices_p,
+                       size_t length,
+                       enum hx711_channel_gain_t channel_gain);
+
+/**
+ * Start sampling paced by a timer. All devices are reset, so they
+ * start their conversions at the same time. The timer callback
+ * samples all devices if all are ready, so the timer period should
+ * be a fraction of the sample period, for example 2 ms at 80
+ * samples per second.
+ *
+ * @param[in] self_p Initialized sampler.
+ * @param[in] period_p Timer period, or NULL to only sample when
+ *                     ``hx711_sampler_sample_isr()`` is called, for
+ *                     example from a hardware timer interrupt.
+ *
+ * @return zero(0) or negative error code.
+ */
+int hx711_sampler_start(struct hx711_sampler_t *self_p,
+                        const struct time_t *period_p);
+
+#if CONFIG_EXTI == 1
+
+/**
+ * Start sampling on data ready interrupts. All devices are reset, so
+ * they start their conversions at the same time. All devices are
+ * sampled when given external interrupt device, connected to the
+ * DOUT pin of one of the devices, detects a falling edge. If the
+ * devices do not share a crystal their conversions drift apart, so
+ * connect the device finishing its conversion last, or use
+ * ``hx711_sampler_start()`` instead.
+ *
+ * @param[in] self_p Initialized sampler.
+ * @param[in] drdy_p External interrupt device connected to a DOUT
+ *                   pin.
+ *
+ * @return zero(0) or negative error code.
+ */
+int hx711_sampler_start_exti(struct hx711_sampler_t *self_p,
+                             struct exti_device_t *drdy_p);
+
+#endif
+
+/**
+ * Stop given sampler. Already taken samples can still be read.
+ *
+ * @param[in] self_p Started sampler.
+ *
+ * @return zero(0) or negative error code.
+ */
+int hx711_sampler_stop(struct hx711_sampler_t *self_p);
+
+/**
+ * Sample all devices if all of them are ready, otherwise do
+ * nothing. Must be called from an interrupt handler, or with the
+ * system lock taken. The 24 data bits and the channel and gain
+ * pulses are clocked out of all devices in parallel.
+ *
+ * @param[in] self_p Started sampler.
+ *
+ * @return true(1) if the devices were sampled, otherwise false(0).
+ */
+int hx711_sampler_sample_isr(struct hx711_sampler_t *self_p);
+
+/**
+ * Read samples of given device, oldest first. Waits for at least one
+ * sample, then reads as many as available, up to given length.
+ *
+ * @param[in] self_p Sampler device.
+ * @param[out] samples_p Read sign extended raw samples.
+ * @param[in] length Maximum number of samples to read.
+ * @param[in] timeout_p Read timeout, or NULL to wait forever.
+ *
+ * @return Number of read samples, or negative error code. Returns
+ *         -ETIMEDOUT if no sample was taken within the timeout.
+ */
+ssize_t hx711_sampler_read(struct hx711_sampler_device_t *self_p,
+                           struct hx711_sample_t *samples_p,
+                           size_t length,
+                           struct time_t *timeout_p);
+
+/**
+ * Get the number of samples dropped because the ring buffer of given
+ * device was full.
+ *
+ * @param[in] self_p Sampler device.
+ *
+ * @return Number of dropped samples.
+ */
+uint32_t hx711_sampler_get_overflows(struct hx711_sampler_device_t *self_p);
+
 #endif
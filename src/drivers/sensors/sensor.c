@@ -0,0 +1,429 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2014-2018, Erik Moqvist
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use, copy,
+ * modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ * This file is part of the Simba project.
+ */
+
+#include "simba.h"
+
+#if CONFIG_SENSOR == 1
+
+/* Process period when no sensor is added. */
+#define IDLE_PERIOD_MS                                   1000
+
+static uint32_t now_ms(void)
+{
+    struct time_t now;
+
+    time_get(&now);
+
+    return ((uint32_t)now.seconds * 1000 + now.nanoseconds / 1000000);
+}
+
+/**
+ * Milliseconds from given time to given deadline, negative if the
+ * deadline has passed. Wrap safe.
+ */
+static int32_t left_ms(uint32_t now, uint32_t deadline)
+{
+    return ((int32_t)(deadline - now));
+}
+
+/**
+ * Find a sensor, before given sensor, sharing its start callback and
+ * that was started, successfully or not, in given round.
+ */
+static struct sensor_t *find_started(struct sensor_scheduler_t *self_p,
+                                     struct sensor_t *sensor_p,
+                                     uint32_t round)
+{
+    struct sensor_t *curr_p;
+
+    curr_p = self_p->sensors_p;
+
+    while (curr_p != sensor_p) {
+        if ((curr_p->round == round)
+            && (curr_p->start.callback == sensor_p->start.callback)
+            && (curr_p->start.arg_p == sensor_p->start.arg_p)) {
+            return (curr_p);
+        }
+
+        curr_p = curr_p->next_p;
+    }
+
+    return (NULL);
+}
+
+static void schedule_next(struct sensor_t *sensor_p, uint32_t now)
+{
+    sensor_p->converting = 0;
+    sensor_p->deadline_ms += sensor_p->period_ms;
+
+    /* Skip missed samples instead of catching up. */
+    if (left_ms(now, sensor_p->deadline_ms) < 0) {
+        sensor_p->deadline_ms = (now + sensor_p->period_ms);
+    }
+}
+
+/**
+ * Start conversions of all due sensors. Sensors sharing a start
+ * callback are started once.
+ */
+static void start_due(struct sensor_scheduler_t *self_p, uint32_t now)
+{
+    struct sensor_t *sensor_p;
+    struct sensor_t *started_p;
+    int res;
+
+    self_p->round++;
+    sensor_p = self_p->sensors_p;
+
+    while (sensor_p != NULL) {
+        if ((sensor_p->converting == 0)
+            && (left_ms(now, sensor_p->deadline_ms) <= 0)) {
+            sensor_p->round = self_p->round;
+
+            if (sensor_p->start.callback == NULL) {
+                res = 0;
+            } else {
+                started_p = find_started(self_p, sensor_p, self_p->round);
+
+                if (started_p == NULL) {
+                    res = sensor_p->start.callback(sensor_p->start.arg_p);
+                } else if (started_p->converting == 1) {
+                    res = (started_p->ready_ms - now);
+                } else {
+                    res = -EIO;
+                }
+            }
+
+            if (res >= 0) {
+                sensor_p->ready_ms = (now + res);
+                sensor_p->converting = 1;
+            } else {
+                sensor_p->errors++;
+                schedule_next(sensor_p, now);
+            }
+        }
+
+        sensor_p = sensor_p->next_p;
+    }
+}
+
+/**
+ * Read and publish all finished samples. The sensors list is sorted
+ * by bus, so all transactions on one bus are made back to back.
+ */
+static void read_ready(struct sensor_scheduler_t *self_p, uint32_t now)
+{
+    struct sensor_t *sensor_p;
+    ssize_t res;
+
+    sensor_p = self_p->sensors_p;
+
+    while (sensor_p != NULL) {
+        if ((sensor_p->converting == 1)
+            && (left_ms(now, sensor_p->ready_ms) <= 0)) {
+            res = sensor_p->read(sensor_p, self_p->buf_p, sensor_p->size);
+
+            if (res >= 0) {
+                bus_write(self_p->bus_p, sensor_p->id, self_p->buf_p, res);
+            } else {
+                sensor_p->errors++;
+            }
+
+            schedule_next(sensor_p, now);
+        }
+
+        sensor_p = sensor_p->next_p;
+    }
+}
+
+static int next_timeout(struct sensor_scheduler_t *self_p, uint32_t now)
+{
+    struct sensor_t *sensor_p;
+    int32_t timeout;
+    int32_t left;
+
+    timeout = IDLE_PERIOD_MS;
+    sensor_p = self_p->sensors_p;
+
+    while (sensor_p != NULL) {
+        if (sensor_p->converting == 1) {
+            left = left_ms(now, sensor_p->ready_ms);
+        } else {
+            left = left_ms(now, sensor_p->deadline_ms);
+        }
+
+        if (left < timeout) {
+            timeout = left;
+        }
+
+        sensor_p = sensor_p->next_p;
+    }
+
+    if (timeout < 0) {
+        timeout = 0;
+    }
+
+    return (timeout);
+}
+
+#if CONFIG_DS18B20 == 1
+
+static int ds18b20_sensor_start(void *arg_p)
+{
+    int res;
+
+    res = ds18b20_convert_async(arg_p);
+
+    if (res != 0) {
+        return (res);
+    }
+
+    return (DS18B20_CONVERT_TIME_MS);
+}
+
+static ssize_t ds18b20_sensor_read(struct sensor_t *sensor_p,
+                                   void *buf_p,
+                                   size_t size)
+{
+    struct sensor_ds18b20_t *self_p;
+    int res;
+
+    self_p = container_of(sensor_p, struct sensor_ds18b20_t, base);
+    res = ds18b20_read_fixed_point(self_p->driver_p, self_p->id_p, buf_p);
+
+    if (res != 0) {
+        return (res);
+    }
+
+    return (size);
+}
+
+#endif
+
+int sensor_init(struct sensor_t *self_p,
+                int id,
+                int period_ms,
+                void *bus_p,
+                sensor_read_t read,
+                void *arg_p,
+                size_t size)
+{
+    ASSERTN(self_p != NULL, EINVAL);
+    ASSERTN(period_ms > 0, EINVAL);
+    ASSERTN(read != NULL, EINVAL);
+
+    self_p->next_p = NULL;
+    self_p->id = id;
+    self_p->period_ms = period_ms;
+    self_p->bus_p = bus_p;
+    self_p->start.callback = NULL;
+    self_p->start.arg_p = NULL;
+    self_p->read = read;
+    self_p->arg_p = arg_p;
+    self_p->size = size;
+    self_p->converting = 0;
+    self_p->round = 0;
+    self_p->deadline_ms = 0;
+    self_p->ready_ms = 0;
+    self_p->errors = 0;
+
+    return (0);
+}
+
+int sensor_set_start(struct sensor_t *self_p,
+                     sensor_start_t callback,
+                     void *arg_p)
+{
+    ASSERTN(self_p != NULL, EINVAL);
+
+    self_p->start.callback = callback;
+    self_p->start.arg_p = arg_p;
+
+    return (0);
+}
+
+uint32_t sensor_get_errors(struct sensor_t *self_p)
+{
+    ASSERTN(self_p != NULL, EINVAL);
+
+    return (self_p->errors);
+}
+
+#if CONFIG_DS18B20 == 1
+
+int sensor_ds18b20_init(struct sensor_ds18b20_t *self_p,
+                        int id,
+                        int period_ms,
+                        struct ds18b20_driver_t *driver_p,
+                        const uint8_t *id_p)
+{
+    ASSERTN(self_p != NULL, EINVAL);
+    ASSERTN(driver_p != NULL, EINVAL);
+    ASSERTN(id_p != NULL, EINVAL);
+
+    int res;
+
+    res = sensor_init(&self_p->base,
+                      id,
+                      period_ms,
+                      driver_p->owi_p,
+                      ds18b20_sensor_read,
+                      NULL,
+                      sizeof(int));
+
+    if (res != 0) {
+        return (res);
+    }
+
+    self_p->driver_p = driver_p;
+    self_p->id_p = id_p;
+
+    return (sensor_set_start(&self_p->base, ds18b20_sensor_start, driver_p));
+}
+
+#endif
+
+int sensor_scheduler_init(struct sensor_scheduler_t *self_p,
+                          struct bus_t *bus_p,
+                          void *buf_p,
+                          size_t size)
+{
+    ASSERTN(self_p != NULL, EINVAL);
+    ASSERTN(bus_p != NULL, EINVAL);
+    ASSERTN(buf_p != NULL, EINVAL);
+
+    self_p->bus_p = bus_p;
+    self_p->sensors_p = NULL;
+    self_p->round = 0;
+    self_p->buf_p = buf_p;
+    self_p->size = size;
+
+    return (mutex_init(&self_p->mutex));
+}
+
+int sensor_scheduler_add(struct sensor_scheduler_t *self_p,
+                         struct sensor_t *sensor_p)
+{
+    ASSERTN(self_p != NULL, EINVAL);
+    ASSERTN(sensor_p != NULL, EINVAL);
+
+    struct sensor_t **next_pp;
+    struct sensor_t **last_pp;
+
+    if (sensor_p->size > self_p->size) {
+        return (-EINVAL);
+    }
+
+    mutex_lock(&self_p->mutex);
+
+    /* Insert after the last sensor on the same bus, or last. */
+    last_pp = NULL;
+    next_pp = &self_p->sensors_p;
+
+    while (*next_pp != NULL) {
+        if ((*next_pp)->bus_p == sensor_p->bus_p) {
+            last_pp = &(*next_pp)->next_p;
+        }
+
+        next_pp = &(*next_pp)->next_p;
+    }
+
+    if (last_pp == NULL) {
+        last_pp = next_pp;
+    }
+
+    sensor_p->next_p = *last_pp;
+    sensor_p->converting = 0;
+    sensor_p->deadline_ms = now_ms();
+    *last_pp = sensor_p;
+
+    mutex_unlock(&self_p->mutex);
+
+    return (0);
+}
+
+int sensor_scheduler_remove(struct sensor_scheduler_t *self_p,
+                            struct sensor_t *sensor_p)
+{
+    ASSERTN(self_p != NULL, EINVAL);
+    ASSERTN(sensor_p != NULL, EINVAL);
+
+    struct sensor_t **next_pp;
+    int res;
+
+    res = -ENOENT;
+
+    mutex_lock(&self_p->mutex);
+
+    next_pp = &self_p->sensors_p;
+
+    while (*next_pp != NULL) {
+        if (*next_pp == sensor_p) {
+            *next_pp = sensor_p->next_p;
+            sensor_p->next_p = NULL;
+            res = 0;
+            break;
+        }
+
+        next_pp = &(*next_pp)->next_p;
+    }
+
+    mutex_unlock(&self_p->mutex);
+
+    return (res);
+}
+
+int sensor_scheduler_process(struct sensor_scheduler_t *self_p)
+{
+    ASSERTN(self_p != NULL, EINVAL);
+
+    int timeout;
+
+    mutex_lock(&self_p->mutex);
+    start_due(self_p, now_ms());
+    read_ready(self_p, now_ms());
+    timeout = next_timeout(self_p, now_ms());
+    mutex_unlock(&self_p->mutex);
+
+    return (timeout);
+}
+
+void *sensor_scheduler_main(void *arg_p)
+{
+    struct sensor_scheduler_t *self_p;
+
+    self_p = arg_p;
+
+    while (1) {
+        thrd_sleep_ms(sensor_scheduler_process(self_p));
+    }
+
+    return (NULL);
+}
+
+#endif
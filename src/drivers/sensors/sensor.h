@@ -0,0 +1,235 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2014-2018, Erik Moqvist
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use, copy,
+ * modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ * This file is part of the Simba project.
+ */
+
+#ifndef __DRIVERS_SENSOR_H__
+#define __DRIVERS_SENSOR_H__
+
+#include "simba.h"
+
+struct sensor_t;
+
+/**
+ * Start a conversion.
+ *
+ * @param[in] arg_p Start argument given to ``sensor_set_start()``.
+ *
+ * @return Conversion time in milliseconds or negative error code.
+ */
+typedef int (*sensor_start_t)(void *arg_p);
+
+/**
+ * Read the result of a finished conversion.
+ *
+ * @param[in] sensor_p Sensor to read.
+ * @param[out] buf_p Buffer to read into.
+ * @param[in] size Buffer size, the sample size given to
+ *                 ``sensor_init()``.
+ *
+ * @return Number of read bytes or negative error code.
+ */
+typedef ssize_t (*sensor_read_t)(struct sensor_t *sensor_p,
+                                 void *buf_p,
+                                 size_t size);
+
+/* A periodically sampled sensor. */
+struct sensor_t {
+    struct sensor_t *next_p;
+    int id;
+    int period_ms;
+    void *bus_p;
+    struct {
+        sensor_start_t callback;
+        void *arg_p;
+    } start;
+    sensor_read_t read;
+    void *arg_p;
+    size_t size;
+    int converting;
+    uint32_t round;
+    uint32_t deadline_ms;
+    uint32_t ready_ms;
+    uint32_t errors;
+};
+
+/* Scheduler of sensor samples. */
+struct sensor_scheduler_t {
+    struct bus_t *bus_p;
+    struct sensor_t *sensors_p;
+    struct mutex_t mutex;
+    uint32_t round;
+    void *buf_p;
+    size_t size;
+};
+
+#if CONFIG_DS18B20 == 1
+
+/* A DS18B20 sensor. */
+struct sensor_ds18b20_t {
+    struct sensor_t base;
+    struct ds18b20_driver_t *driver_p;
+    const uint8_t *id_p;
+};
+
+#endif
+
+/**
+ * Initialize given sensor.
+ *
+ * @param[out] self_p Sensor to initialize.
+ * @param[in] id Bus message id of published samples.
+ * @param[in] period_ms Sample period in milliseconds.
+ * @param[in] bus_p Physical bus the sensor is connected to, for
+ *                  example an I2C or OWI driver. Transactions of
+ *                  sensors on the same bus are made one after the
+ *                  other.
+ * @param[in] read Read callback.
+ * @param[in] arg_p Read callback argument, available as
+ *                  ``sensor_p->arg_p`` in the callback.
+ * @param[in] size Sample size in bytes.
+ *
+ * @return zero(0) or negative error code.
+ */
+int sensor_init(struct sensor_t *self_p,
+                int id,
+                int period_ms,
+                void *bus_p,
+                sensor_read_t read,
+                void *arg_p,
+                size_t size);
+
+/**
+ * Set the start callback of given sensor. Without a start callback
+ * the sample is read immediately. With a start callback all due
+ * conversions are started before any sample is read, so they run in
+ * parallel. Sensors with the same start callback and argument, for
+ * example all DS18B20 on one OWI bus, share a single start call.
+ *
+ * @param[in] self_p Initialized sensor.
+ * @param[in] callback Start callback.
+ * @param[in] arg_p Start callback argument.
+ *
+ * @return zero(0) or negative error code.
+ */
+int sensor_set_start(struct sensor_t *self_p,
+                     sensor_start_t callback,
+                     void *arg_p);
+
+/**
+ * Get the number of failed starts and reads of given sensor.
+ *
+ * @param[in] self_p Initialized sensor.
+ *
+ * @return Number of errors.
+ */
+uint32_t sensor_get_errors(struct sensor_t *self_p);
+
+#if CONFIG_DS18B20 == 1
+
+/**
+ * Initialize given DS18B20 sensor. Samples are published as an
+ * ``int`` temperature in Q4 fixed point format, as read by
+ * ``ds18b20_read_fixed_point()``. All DS18B20 sensors of the same
+ * driver share one conversion.
+ *
+ * @param[out] self_p Sensor to initialize.
+ * @param[in] id Bus message id of published samples.
+ * @param[in] period_ms Sample period in milliseconds.
+ * @param[in] driver_p Initialized DS18B20 driver.
+ * @param[in] id_p DS18B20 sensor identity.
+ *
+ * @return zero(0) or negative error code.
+ */
+int sensor_ds18b20_init(struct sensor_ds18b20_t *self_p,
+                        int id,
+                        int period_ms,
+                        struct ds18b20_driver_t *driver_p,
+                        const uint8_t *id_p);
+
+#endif
+
+/**
+ * Initialize given scheduler.
+ *
+ * @param[out] self_p Scheduler to initialize.
+ * @param[in] bus_p Bus to publish samples on.
+ * @param[in] buf_p Sample buffer, at least as big as the biggest
+ *                  sample.
+ * @param[in] size Sample buffer size.
+ *
+ * @return zero(0) or negative error code.
+ */
+int sensor_scheduler_init(struct sensor_scheduler_t *self_p,
+                          struct bus_t *bus_p,
+                          void *buf_p,
+                          size_t size);
+
+/**
+ * Add given sensor to given scheduler. The first sample is due
+ * immediately. Sensors with the same period are sampled together.
+ *
+ * @param[in] self_p Initialized scheduler.
+ * @param[in] sensor_p Initialized sensor to add.
+ *
+ * @return zero(0) or negative error code.
+ */
+int sensor_scheduler_add(struct sensor_scheduler_t *self_p,
+                         struct sensor_t *sensor_p);
+
+/**
+ * Remove given sensor from given scheduler.
+ *
+ * @param[in] self_p Initialized scheduler.
+ * @param[in] sensor_p Sensor to remove.
+ *
+ * @return zero(0) or negative error code.
+ */
+int sensor_scheduler_remove(struct sensor_scheduler_t *self_p,
+                            struct sensor_t *sensor_p);
+
+/**
+ * Start all due conversions, and then read and publish all finished
+ * samples, bus by bus.
+ *
+ * @param[in] self_p Initialized scheduler.
+ *
+ * @return Milliseconds until this function has to be called again.
+ */
+int sensor_scheduler_process(struct sensor_scheduler_t *self_p);
+
+/**
+ * The scheduler thread entry function. Calls
+ * ``sensor_scheduler_process()`` and sleeps until it has to be called
+ * again, forever.
+ *
+ * @param[in] arg_p Initialized scheduler.
+ *
+ * @return Never returns.
+ */
+void *sensor_scheduler_main(void *arg_p);
+
+#endif
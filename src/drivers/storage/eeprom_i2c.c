@@ -58,6 +58,141 @@ static ssize_t try_write(struct eeprom_i2c_driver_t *self_p,
     return (res);
 }
 
+/**
+ * Wait for an ongoing write cycle to complete. The EEPROM does not
+ * acknowledge its address until the cycle is complete.
+ */
+static int wait_for_write_cycle(struct eeprom_i2c_driver_t *self_p)
+{
+    int attempt;
+    int res;
+
+    if (!self_p->write_in_progress) {
+        return (0);
+    }
+
+    for (attempt = 0;
+         attempt < CONFIG_EEPROM_I2C_NUMBER_OF_ATTEMPTS;
+         attempt++) {
+        res = i2c_scan(self_p->i2c_p, self_p->i2c_address);
+
+        if (res < 0) {
+            return (res);
+        }
+
+        if (res == 1) {
+            self_p->write_in_progress = 0;
+
+            return (0);
+        }
+    }
+
+    return (-ETIMEDOUT);
+}
+
+/**
+ * Write given data within a single page, starting a write cycle.
+ */
+static int write_page(struct eeprom_i2c_driver_t *self_p,
+                      uint32_t dst,
+                      const uint8_t *src_p,
+                      size_t size)
+{
+    ssize_t res;
+    uint8_t buf[2 + CONFIG_EEPROM_I2C_PAGE_SIZE_MAX];
+
+    res = wait_for_write_cycle(self_p);
+
+    if (res != 0) {
+        return (res);
+    }
+
+    buf[0] = (uint8_t)(dst >> 8);
+    buf[1] = (uint8_t)dst;
+    memcpy(&buf[2], src_p, size);
+
+    res = try_write(self_p, &buf[0], size + 2);
+
+    if (res != (size + 2)) {
+        return (res < 0 ? res : -EIO);
+    }
+
+    self_p->write_in_progress = 1;
+
+    return (0);
+}
+
+/**
+ * Write the write buffer contents to the EEPROM, if any.
+ */
+static int write_shadow(struct eeprom_i2c_driver_t *self_p)
+{
+    int res;
+
+    if (self_p->shadow.length == 0) {
+        return (0);
+    }
+
+    res = write_page(self_p,
+                     self_p->shadow.address,
+                     self_p->shadow.buf_p,
+                     self_p->shadow.length);
+
+    self_p->shadow.length = 0;
+
+    return (res);
+}
+
+/**
+ * Write given data within a single page, either to the write buffer
+ * or directly to the EEPROM.
+ */
+static int write_chunk(struct eeprom_i2c_driver_t *self_p,
+                       uint32_t dst,
+                       const uint8_t *src_p,
+                       size_t size)
+{
+    int res;
+    size_t offset;
+
+    if (self_p->shadow.buf_p == NULL) {
+        return (write_page(self_p, dst, src_p, size));
+    }
+
+    /* Append to, or overwrite data in, the buffered page. */
+    if ((self_p->shadow.length > 0)
+        && ((dst / self_p->page_size)
+            == (self_p->shadow.address / self_p->page_size))
+        && (dst >= self_p->shadow.address)
+        && (dst <= self_p->shadow.address + self_p->shadow.length)) {
+        offset = (dst - self_p->shadow.address);
+        memcpy(&self_p->shadow.buf_p[offset], src_p, size);
+
+        if ((offset + size) > self_p->shadow.length) {
+            self_p->shadow.length = (offset + size);
+        }
+
+        return (0);
+    }
+
+    res = write_shadow(self_p);
+
+    if (res != 0) {
+        return (res);
+    }
+
+    /* Full pages are written directly. */
+    if (size == self_p->page_size) {
+        return (write_page(self_p, dst, src_p, size));
+    }
+
+    memcpy(self_p->shadow.buf_p, src_p, size);
+    self_p->shadow.address = dst;
+    self_p->shadow.length = size;
+
+    return (0);
+}
+
 int eeprom_i2c_module_init()
 {
     return (0);
@@ -71,10 +206,78 @@ int eeprom_i2c_init(struct eeprom_i2c_driver_t *self_p,
     self_p->i2c_p = i2c_p;
     self_p->i2c_address = i2c_address;
     self_p->size = size;
+    self_p->page_size = 1;
+    self_p->write_in_progress = 0;
+    self_p->shadow.buf_p = NULL;
+    self_p->shadow.size = 0;
+    self_p->shadow.length = 0;
 
     return (0);
 }
 
+int eeprom_i2c_set_page_size(struct eeprom_i2c_driver_t *self_p,
+                             size_t page_size)
+{
+    ASSERTN(self_p != NULL, EINVAL);
+    ASSERTN(page_size > 0, EINVAL);
+    ASSERTN(page_size <= CONFIG_EEPROM_I2C_PAGE_SIZE_MAX, EINVAL);
+
+    int res;
+
+    if ((self_p->shadow.buf_p != NULL) && (self_p->shadow.size < page_size)) {
+        return (-EINVAL);
+    }
+
+    res = write_shadow(self_p);
+
+    if (res != 0) {
+        return (res);
+    }
+
+    self_p->page_size = page_size;
+
+    return (0);
+}
+
+int eeprom_i2c_set_write_buffer(struct eeprom_i2c_driver_t *self_p,
+                                void *buf_p,
+                                size_t size)
+{
+    ASSERTN(self_p != NULL, EINVAL);
+
+    int res;
+
+    if ((buf_p != NULL) && (size < self_p->page_size)) {
+        return (-EINVAL);
+    }
+
+    res = write_shadow(self_p);
+
+    if (res != 0) {
+        return (res);
+    }
+
+    self_p->shadow.buf_p = buf_p;
+    self_p->shadow.size = size;
+
+    return (0);
+}
+
+int eeprom_i2c_flush(struct eeprom_i2c_driver_t *self_p)
+{
+    ASSERTN(self_p != NULL, EINVAL);
+
+    int res;
+
+    res = write_shadow(self_p);
+
+    if (res != 0) {
+        return (res);
+    }
+
+    return (wait_for_write_cycle(self_p));
+}
+
 ssize_t eeprom_i2c_read(struct eeprom_i2c_driver_t *self_p,
                         void *dst_p,
                         uint32_t src,
@@ -83,6 +286,7 @@ ssize_t eeprom_i2c_read(struct eeprom_i2c_driver_t *self_p,
     ASSERTN(self_p != NULL, EINVAL);
     ASSERTN(dst_p != NULL, EINVAL);
 
+    int attempt;
     ssize_t res;
     uint8_t buf[2];
 
@@ -94,21 +298,38 @@ ssize_t eeprom_i2c_read(struct eeprom_i2c_driver_t *self_p,
         return (-EINVAL);
     }
 
-    /* Write the address to read from. */
+    if (size == 0) {
+        return (0);
+    }
+
+    res = eeprom_i2c_flush(self_p);
+
+    if (res != 0) {
+        return (res);
+    }
+
+    /* Write the address to read from and then read all data in one
+       sequential read. The EEPROM increments the address across page
+       boundaries. */
     buf[0] = (uint8_t)(src >> 8);
     buf[1] = (uint8_t)src;
 
-    res = try_write(self_p, &buf[0], sizeof(buf));
+    for (attempt = 0;
+         attempt < CONFIG_EEPROM_I2C_NUMBER_OF_ATTEMPTS;
+         attempt++) {
+        res = i2c_write_read(self_p->i2c_p,
+                             self_p->i2c_address,
+                             &buf[0],
+                             sizeof(buf),
+                             dst_p,
+                             size);
 
-    if (res != sizeof(buf)) {
-        return (res);
+        if (res == size) {
+            break;
+        }
     }
 
-    /* Read data from the EEPROM. */
-    return (i2c_read(self_p->i2c_p,
-                     self_p->i2c_address,
-                     dst_p,
-                     size));
+    return (res);
 }
 
 ssize_t eeprom_i2c_write(struct eeprom_i2c_driver_t *self_p,
@@ -119,10 +340,10 @@ ssize_t eeprom_i2c_write(struct eeprom_i2c_driver_t *self_p,
     ASSERTN(self_p != NULL, EINVAL);
     ASSERTN(src_p != NULL, EINVAL);
 
-    size_t i;
-    ssize_t res;
+    int res;
+    size_t left;
+    size_t chunk_size;
     const uint8_t *u8_src_p;
-    uint8_t buf[3];
 
     if (dst >= self_p->size) {
         return (-EINVAL);
@@ -133,19 +354,26 @@ ssize_t eeprom_i2c_write(struct eeprom_i2c_driver_t *self_p,
     }
 
     u8_src_p = src_p;
+    left = size;
 
-    /* Write one byte at a time. No page write support for now as it
-       makes the implementation more complicated. */
-    for (i = 0; i < size; i++, dst++) {
-        buf[0] = (uint8_t)(dst >> 8);
-        buf[1] = (uint8_t)dst;
-        buf[2] = u8_src_p[i];
+    /* Write one page at a time, as the EEPROM wraps around to the
+       start of the page when writing past its end. */
+    while (left > 0) {
+        chunk_size = (self_p->page_size - (dst % self_p->page_size));
 
-        res = try_write(self_p, &buf[0], sizeof(buf));
+        if (chunk_size > left) {
+            chunk_size = left;
+        }
+
+        res = write_chunk(self_p, dst, u8_src_p, chunk_size);
 
-        if (res != sizeof(buf)) {
+        if (res != 0) {
             return (res);
         }
+
+        dst += chunk_size;
+        u8_src_p += chunk_size;
+        left -= chunk_size;
     }
 
     return (size);
@@ -35,6 +35,14 @@ struct eeprom_i2c_driver_t {
     struct i2c_driver_t *i2c_p;
     int i2c_address;
     uint32_t size;
+    size_t page_size;
+    int write_in_progress;
+    struct {
+        uint8_t *buf_p;
+        size_t size;
+        uint32_t address;
+        size_t length;
+    } shadow;
 };
 
 /**
@@ -64,7 +72,52 @@ int eeprom_i2c_init(struct eeprom_i2c_driver_t *self_p,
                     uint32_t size);
 
 /**
- * Read into given buffer from given EEPROM address.
+ * Set the page size of the EEPROM, as found in its datasheet, often
+ * 32 or 64 bytes. Writes are split at page boundaries and each page
+ * is written in a single write cycle. The page size is one byte by
+ * default, which works with all EEPROMs but is slow.
+ *
+ * Pending data in the write buffer is written to the EEPROM before
+ * the page size is changed.
+ *
+ * @param[in] self_p Initialized driver object.
+ * @param[in] page_size Page size in bytes, at most
+ *                      ``CONFIG_EEPROM_I2C_PAGE_SIZE_MAX``.
+ *
+ * @return zero(0) or negative error code.
+ */
+int eeprom_i2c_set_page_size(struct eeprom_i2c_driver_t *self_p,
+                             size_t page_size);
+
+/**
+ * Set a RAM buffer used to coalesce adjacent small writes within a
+ * page into a single page write. Data is kept in the buffer until a
+ * write outside of it, a read or a call to `eeprom_i2c_flush()`.
+ *
+ * @param[in] self_p Initialized driver object.
+ * @param[in] buf_p Buffer of at least the page size, or NULL to
+ *                  write directly to the EEPROM.
+ * @param[in] size Buffer size in bytes.
+ *
+ * @return zero(0) or negative error code.
+ */
+int eeprom_i2c_set_write_buffer(struct eeprom_i2c_driver_t *self_p,
+                                void *buf_p,
+                                size_t size);
+
+/**
+ * Write pending data in the write buffer to the EEPROM and wait for
+ * the write cycle to complete.
+ *
+ * @param[in] self_p Initialized driver object.
+ *
+ * @return zero(0) or negative error code.
+ */
+int eeprom_i2c_flush(struct eeprom_i2c_driver_t *self_p);
+
+/**
+ * Read into given buffer from given EEPROM address, as one sequential
+ * read.
  *
  * @param[in] self_p Initialized driver object.
  * @param[out] dst_p Buffer to read into.
@@ -79,7 +132,9 @@ ssize_t eeprom_i2c_read(struct eeprom_i2c_driver_t *self_p,
                         size_t size);
 
 /**
- * Write given buffer to given EEPROM address.
+ * Write given buffer to given EEPROM address. This function returns
+ * without waiting for the last write cycle to complete; the next
+ * access polls the EEPROM until it acknowledges its address again.
  *
  * @param[in] self_p Initialized driver object.
  * @param[in] dst EEPROM address to write to.
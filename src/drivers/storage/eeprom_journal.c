@@ -0,0 +1,775 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2014-2018, Erik Moqvist
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use, copy,
+ * modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ * This file is part of the Simba project.
+ */
+
+#include "simba.h"
+
+#if CONFIG_EEPROM_JOURNAL == 1
+
+/**
+ * Valid pattern in the block header, the same as in the eeprom_soft
+ * driver.
+ */
+#define VALID_PATTERN                                  0xa5c3
+
+#define BLOCK_HEADER_SIZE        sizeof(struct block_header_t)
+#define RECORD_HEADER_SIZE      sizeof(struct record_header_t)
+
+/**
+ * Record offsets in the index and in the records are in words of
+ * four bytes.
+ */
+#define WORD_SIZE                                           4
+
+/**
+ * Index of pages without records since the snapshot.
+ */
+#define INDEX_NONE                                     0xffff
+
+#define RECORD_SIZE(size)                                             \
+    (RECORD_HEADER_SIZE + (((size) + WORD_SIZE - 1) & ~(WORD_SIZE - 1)))
+
+struct block_header_t {
+    uint32_t crc;
+    uint16_t revision;
+    uint16_t valid;
+};
+
+struct record_header_t {
+    uint16_t address;
+    uint16_t size;
+    /* Index of the previous record in the same page, or
+       INDEX_NONE. */
+    uint16_t previous;
+    uint16_t crc;
+};
+
+/**
+ * Check if a revision is later than another.
+ */
+static int is_later_revision(uint16_t revision_1, uint16_t revision_2)
+{
+    if (revision_1 > revision_2) {
+        return ((revision_1 - revision_2) < 0x8000);
+    } else {
+        return (!((revision_2 - revision_1) < 0x8000));
+    }
+}
+
+static uintptr_t record_address(struct eeprom_journal_driver_t *self_p,
+                                uint16_t index)
+{
+    return (self_p->current.block_p->address + WORD_SIZE * index);
+}
+
+static uint16_t record_crc(struct record_header_t *header_p,
+                           const void *buf_p)
+{
+    uint16_t crc;
+
+    crc = crc_ccitt(0xffff, header_p, offsetof(struct record_header_t, crc));
+
+    return (crc_ccitt(crc, buf_p, header_p->size));
+}
+
+/**
+ * Calculate the crc of the snapshot in given block.
+ */
+static int calculate_snapshot_crc(struct eeprom_journal_driver_t *self_p,
+                                  const struct eeprom_journal_block_t *block_p,
+                                  uint32_t *crc_p)
+{
+    uint8_t buf[EEPROM_JOURNAL_PAGE_SIZE_MAX];
+    size_t offset;
+    size_t size;
+    uint32_t crc;
+
+    crc = 0;
+
+    for (offset = 0; offset < self_p->eeprom_size; offset += size) {
+        size = MIN(sizeof(buf), self_p->eeprom_size - offset);
+
+        if (flash_read(self_p->flash_p,
+                       &buf[0],
+                       block_p->address + BLOCK_HEADER_SIZE + offset,
+                       size) != size) {
+            return (-1);
+        }
+
+        crc = crc_32(crc, &buf[0], size);
+
+#if CONFIG_PREEMPTIVE_SCHEDULER == 0
+        thrd_yield();
+#endif
+    }
+
+    *crc_p = crc;
+
+    return (0);
+}
+
+static int write_block_header(struct eeprom_journal_driver_t *self_p,
+                              const struct eeprom_journal_block_t *block_p,
+                              uint32_t crc,
+                              uint16_t revision)
+{
+    struct block_header_t header;
+
+    header.crc = crc;
+    header.revision = revision;
+    header.valid = VALID_PATTERN;
+
+    if (flash_write(self_p->flash_p,
+                    block_p->address,
+                    &header,
+                    sizeof(header)) != sizeof(header)) {
+        return (-1);
+    }
+
+    return (0);
+}
+
+/**
+ * Read given range within one page. The records of the page are
+ * visited from the latest to the oldest until all bytes are found,
+ * and the remaining bytes are read from the snapshot.
+ */
+static int read_page(struct eeprom_journal_driver_t *self_p,
+                     uint8_t *dst_p,
+                     size_t address,
+                     size_t size)
+{
+    uint8_t found[EEPROM_JOURNAL_PAGE_SIZE_MAX / 8];
+    uint8_t buf[EEPROM_JOURNAL_PAGE_SIZE_MAX];
+    struct record_header_t header;
+    uint16_t index;
+    size_t left;
+    size_t begin;
+    size_t end;
+    size_t i;
+    size_t j;
+
+    memset(&found[0], 0, sizeof(found));
+    left = size;
+    index = self_p->index_p[address / self_p->page_size];
+
+    while ((index != INDEX_NONE) && (left > 0)) {
+        if (flash_read(self_p->flash_p,
+                       &header,
+                       record_address(self_p, index),
+                       sizeof(header)) != sizeof(header)) {
+            return (-1);
+        }
+
+        begin = MAX(header.address, address);
+        end = MIN(header.address + header.size, address + size);
+
+        if (begin < end) {
+            if (flash_read(self_p->flash_p,
+                           &buf[0],
+                           (record_address(self_p, index)
+                            + RECORD_HEADER_SIZE
+                            + begin
+                            - header.address),
+                           end - begin) != (end - begin)) {
+                return (-1);
+            }
+
+            for (i = begin; i < end; i++) {
+                j = (i - address);
+
+                if ((found[j / 8] & (1 << (j % 8))) == 0) {
+                    found[j / 8] |= (1 << (j % 8));
+                    dst_p[j] = buf[i - begin];
+                    left--;
+                }
+            }
+        }
+
+        /* Records are only linked to older records. */
+        if ((header.previous != INDEX_NONE) && (header.previous >= index)) {
+            return (-1);
+        }
+
+        index = header.previous;
+    }
+
+    if (left == 0) {
+        return (0);
+    }
+
+    if (flash_read(self_p->flash_p,
+                   &buf[0],
+                   (self_p->current.block_p->address
+                    + BLOCK_HEADER_SIZE
+                    + address),
+                   size) != size) {
+        return (-1);
+    }
+
+    for (j = 0; j < size; j++) {
+        if ((found[j / 8] & (1 << (j % 8))) == 0) {
+            dst_p[j] = buf[j];
+        }
+    }
+
+    return (0);
+}
+
+static ssize_t read_inner(struct eeprom_journal_driver_t *self_p,
+                          uint8_t *dst_p,
+                          size_t src,
+                          size_t size)
+{
+    size_t left;
+    size_t n;
+
+    left = size;
+
+    while (left > 0) {
+        n = MIN(left, self_p->page_size - (src % self_p->page_size));
+
+        if (read_page(self_p, dst_p, src, n) != 0) {
+            return (-1);
+        }
+
+        dst_p += n;
+        src += n;
+        left -= n;
+    }
+
+    return (size);
+}
+
+static int compact_inner(struct eeprom_journal_driver_t *self_p)
+{
+    const struct eeprom_journal_block_t *block_p;
+    uint8_t buf[EEPROM_JOURNAL_PAGE_SIZE_MAX];
+    uint16_t revision;
+    size_t offset;
+    size_t size;
+    uint32_t crc;
+    size_t i;
+
+    block_p = (self_p->current.block_p + 1);
+
+    if (block_p == &self_p->blocks_p[self_p->number_of_blocks]) {
+        block_p = &self_p->blocks_p[0];
+    }
+
+    if (flash_erase(self_p->flash_p, block_p->address, block_p->size) != 0) {
+        return (-1);
+    }
+
+    /* Write the current content as the snapshot of the next block. */
+    crc = 0;
+
+    for (offset = 0; offset < self_p->eeprom_size; offset += size) {
+        size = MIN(self_p->page_size, self_p->eeprom_size - offset);
+
+        if (read_page(self_p, &buf[0], offset, size) != 0) {
+            return (-1);
+        }
+
+        if (flash_write(self_p->flash_p,
+                        block_p->address + BLOCK_HEADER_SIZE + offset,
+                        &buf[0],
+                        size) != size) {
+            return (-1);
+        }
+
+        crc = crc_32(crc, &buf[0], size);
+
+#if CONFIG_PREEMPTIVE_SCHEDULER == 0
+        thrd_yield();
+#endif
+    }
+
+    /* The header is written last, making the new block valid. */
+    revision = (self_p->current.revision + 1);
+
+    if (write_block_header(self_p, block_p, crc, revision) != 0) {
+        return (-1);
+    }
+
+    self_p->current.block_p = block_p;
+    self_p->current.revision = revision;
+    self_p->current.offset = self_p->journal_offset;
+
+    for (i = 0; i < EEPROM_JOURNAL_INDEX_LENGTH(self_p->eeprom_size,
+                                                self_p->page_size); i++) {
+        self_p->index_p[i] = INDEX_NONE;
+    }
+
+    return (0);
+}
+
+/**
+ * Append a record with given data within one page, unless the data
+ * is identical to the current content.
+ */
+static int write_page(struct eeprom_journal_driver_t *self_p,
+                      size_t address,
+                      const uint8_t *src_p,
+                      size_t size)
+{
+    uint8_t buf[RECORD_HEADER_SIZE + EEPROM_JOURNAL_PAGE_SIZE_MAX];
+    struct record_header_t header;
+    size_t record_size;
+    size_t page;
+
+    if (read_page(self_p, &buf[0], address, size) != 0) {
+        return (-1);
+    }
+
+    if (memcmp(&buf[0], src_p, size) == 0) {
+        return (0);
+    }
+
+    record_size = RECORD_SIZE(size);
+
+    if (self_p->current.offset + record_size > self_p->current.block_p->size) {
+        if (compact_inner(self_p) != 0) {
+            return (-1);
+        }
+    }
+
+    page = (address / self_p->page_size);
+    header.address = address;
+    header.size = size;
+    header.previous = self_p->index_p[page];
+    header.crc = record_crc(&header, src_p);
+
+    /* Header, data and padding in one flash write. */
+    memcpy(&buf[0], &header, sizeof(header));
+    memcpy(&buf[RECORD_HEADER_SIZE], src_p, size);
+    memset(&buf[RECORD_HEADER_SIZE + size],
+           0xff,
+           record_size - RECORD_HEADER_SIZE - size);
+
+    if (flash_write(self_p->flash_p,
+                    self_p->current.block_p->address + self_p->current.offset,
+                    &buf[0],
+                    record_size) != record_size) {
+        /* The record may be partially written. Compact before the
+           next write. */
+        self_p->current.offset = self_p->current.block_p->size;
+
+        return (-1);
+    }
+
+    self_p->index_p[page] = (self_p->current.offset / WORD_SIZE);
+    self_p->current.offset += record_size;
+
+    return (0);
+}
+
+static ssize_t write_inner(struct eeprom_journal_driver_t *self_p,
+                           size_t dst,
+                           const uint8_t *src_p,
+                           size_t size)
+{
+    size_t left;
+    size_t n;
+
+    left = size;
+
+    while (left > 0) {
+        n = MIN(left, self_p->page_size - (dst % self_p->page_size));
+
+        if (write_page(self_p, dst, src_p, n) != 0) {
+            return (-1);
+        }
+
+        src_p += n;
+        dst += n;
+        left -= n;
+    }
+
+    return (size);
+}
+
+static int is_blank_record(struct record_header_t *header_p)
+{
+    return ((header_p->address == 0xffff)
+            && (header_p->size == 0xffff)
+            && (header_p->previous == 0xffff)
+            && (header_p->crc == 0xffff));
+}
+
+static int is_valid_record(struct eeprom_journal_driver_t *self_p,
+                           size_t offset,
+                           struct record_header_t *header_p)
+{
+    uint8_t buf[EEPROM_JOURNAL_PAGE_SIZE_MAX];
+    size_t page;
+
+    if ((header_p->size == 0) || (header_p->size > self_p->page_size)) {
+        return (0);
+    }
+
+    if (header_p->address + header_p->size > self_p->eeprom_size) {
+        return (0);
+    }
+
+    page = (header_p->address / self_p->page_size);
+
+    if (page != ((header_p->address + header_p->size - 1)
+                 / self_p->page_size)) {
+        return (0);
+    }
+
+    if (header_p->previous != self_p->index_p[page]) {
+        return (0);
+    }
+
+    if (offset + RECORD_SIZE(header_p->size) > self_p->current.block_p->size) {
+        return (0);
+    }
+
+    if (flash_read(self_p->flash_p,
+                   &buf[0],
+                   (self_p->current.block_p->address
+                    + offset
+                    + RECORD_HEADER_SIZE),
+                   header_p->size) != header_p->size) {
+        return (0);
+    }
+
+    return (record_crc(header_p, &buf[0]) == header_p->crc);
+}
+
+/**
+ * Build the index from the records in the journal of the current
+ * block.
+ */
+static int mount_journal(struct eeprom_journal_driver_t *self_p)
+{
+    struct record_header_t header;
+    size_t offset;
+    size_t i;
+
+    for (i = 0; i < EEPROM_JOURNAL_INDEX_LENGTH(self_p->eeprom_size,
+                                                self_p->page_size); i++) {
+        self_p->index_p[i] = INDEX_NONE;
+    }
+
+    offset = self_p->journal_offset;
+
+    while (offset + RECORD_HEADER_SIZE <= self_p->current.block_p->size) {
+        if (flash_read(self_p->flash_p,
+                       &header,
+                       self_p->current.block_p->address + offset,
+                       sizeof(header)) != sizeof(header)) {
+            return (-1);
+        }
+
+        if (is_blank_record(&header)) {
+            break;
+        }
+
+        /* A partially written record, or other data. The journal is
+           full and will be compacted on next write. */
+        if (!is_valid_record(self_p, offset, &header)) {
+            offset = self_p->current.block_p->size;
+            break;
+        }
+
+        self_p->index_p[header.address / self_p->page_size] =
+            (offset / WORD_SIZE);
+        offset += RECORD_SIZE(header.size);
+    }
+
+    self_p->current.offset = offset;
+
+    return (0);
+}
+
+int eeprom_journal_module_init()
+{
+    return (flash_module_init());
+}
+
+int eeprom_journal_init(struct eeprom_journal_driver_t *self_p,
+                        struct flash_driver_t *flash_p,
+                        const struct eeprom_journal_block_t *blocks_p,
+                        int number_of_blocks,
+                        size_t eeprom_size,
+                        size_t page_size,
+                        uint16_t *index_p)
+{
+    ASSERTN(self_p != NULL, EINVAL);
+    ASSERTN(flash_p != NULL, EINVAL);
+    ASSERTN(blocks_p != NULL, EINVAL);
+    ASSERTN(number_of_blocks >= 2, EINVAL);
+    ASSERTN((eeprom_size > 0) && (eeprom_size <= 0xffff), EINVAL);
+    ASSERTN((eeprom_size % WORD_SIZE) == 0, EINVAL);
+    ASSERTN((page_size > 0) && (page_size <= EEPROM_JOURNAL_PAGE_SIZE_MAX),
+            EINVAL);
+    ASSERTN((page_size % WORD_SIZE) == 0, EINVAL);
+    ASSERTN(index_p != NULL, EINVAL);
+
+    int i;
+
+    self_p->flash_p = flash_p;
+    self_p->blocks_p = blocks_p;
+    self_p->number_of_blocks = number_of_blocks;
+    self_p->eeprom_size = eeprom_size;
+    self_p->page_size = page_size;
+    self_p->journal_offset = (BLOCK_HEADER_SIZE + eeprom_size);
+    self_p->index_p = index_p;
+    self_p->current.block_p = NULL;
+
+    for (i = 0; i < number_of_blocks; i++) {
+        ASSERTN(blocks_p[i].size >= (self_p->journal_offset
+                                     + 2 * RECORD_SIZE(page_size)), EINVAL);
+        ASSERTN(blocks_p[i].size <= WORD_SIZE * INDEX_NONE, EINVAL);
+    }
+
+    mutex_init(&self_p->mutex);
+
+    return (0);
+}
+
+int eeprom_journal_mount(struct eeprom_journal_driver_t *self_p)
+{
+    ASSERTN(self_p != NULL, EINVAL);
+
+    const struct eeprom_journal_block_t *block_p;
+    const struct eeprom_journal_block_t *latest_block_p;
+    struct block_header_t header;
+    uint16_t latest_revision;
+    uint32_t crc;
+    int res;
+    int i;
+
+    res = -1;
+    latest_block_p = NULL;
+    latest_revision = 0;
+
+    mutex_lock(&self_p->mutex);
+
+    /* Find the block with the latest revision and a valid
+       snapshot. */
+    for (i = 0; i < self_p->number_of_blocks; i++) {
+        block_p = &self_p->blocks_p[i];
+
+        if (flash_read(self_p->flash_p,
+                       &header,
+                       block_p->address,
+                       sizeof(header)) != sizeof(header)) {
+            continue;
+        }
+
+        if (header.valid != VALID_PATTERN) {
+            continue;
+        }
+
+        if ((latest_block_p != NULL)
+            && (is_later_revision(header.revision, latest_revision) == 0)) {
+            continue;
+        }
+
+        if (calculate_snapshot_crc(self_p, block_p, &crc) != 0) {
+            continue;
+        }
+
+        if (crc != header.crc) {
+            continue;
+        }
+
+        latest_block_p = block_p;
+        latest_revision = header.revision;
+    }
+
+    if (latest_block_p != NULL) {
+        self_p->current.block_p = latest_block_p;
+        self_p->current.revision = latest_revision;
+        res = mount_journal(self_p);
+
+        if (res != 0) {
+            self_p->current.block_p = NULL;
+        }
+    }
+
+    mutex_unlock(&self_p->mutex);
+
+    return (res);
+}
+
+int eeprom_journal_format(struct eeprom_journal_driver_t *self_p)
+{
+    ASSERTN(self_p != NULL, EINVAL);
+
+    uint32_t crc;
+    int res;
+    int i;
+
+    res = 0;
+
+    mutex_lock(&self_p->mutex);
+
+    self_p->current.block_p = NULL;
+
+    for (i = 0; i < self_p->number_of_blocks; i++) {
+        if (flash_erase(self_p->flash_p,
+                        self_p->blocks_p[i].address,
+                        self_p->blocks_p[i].size) != 0) {
+            res = -1;
+            break;
+        }
+    }
+
+    if (res == 0) {
+        res = calculate_snapshot_crc(self_p, &self_p->blocks_p[0], &crc);
+    }
+
+    if (res == 0) {
+        res = write_block_header(self_p, &self_p->blocks_p[0], crc, 0);
+    }
+
+    mutex_unlock(&self_p->mutex);
+
+    return (res);
+}
+
+ssize_t eeprom_journal_read(struct eeprom_journal_driver_t *self_p,
+                            void *dst_p,
+                            uintptr_t src,
+                            size_t size)
+{
+    ASSERTN(self_p != NULL, EINVAL);
+    ASSERTN(dst_p != NULL, EINVAL);
+
+    ssize_t res;
+
+    if (self_p->current.block_p == NULL) {
+        return (-ENOTMOUNTED);
+    }
+
+    if ((src >= self_p->eeprom_size) || (size > self_p->eeprom_size - src)) {
+        return (-EINVAL);
+    }
+
+    mutex_lock(&self_p->mutex);
+    res = read_inner(self_p, dst_p, src, size);
+    mutex_unlock(&self_p->mutex);
+
+    return (res);
+}
+
+ssize_t eeprom_journal_write(struct eeprom_journal_driver_t *self_p,
+                             uintptr_t dst,
+                             const void *src_p,
+                             size_t size)
+{
+    ASSERTN(self_p != NULL, EINVAL);
+    ASSERTN(src_p != NULL, EINVAL);
+
+    struct iov_uintptr_t iov_dst;
+    struct iov_t iov_src;
+
+    iov_dst.address = dst;
+    iov_dst.size = size;
+    iov_src.buf_p = (void *)src_p;
+
+    return (eeprom_journal_vwrite(self_p, &iov_dst, &iov_src, 1));
+}
+
+ssize_t eeprom_journal_vwrite(struct eeprom_journal_driver_t *self_p,
+                              struct iov_uintptr_t *dst_p,
+                              struct iov_t *src_p,
+                              size_t length)
+{
+    ASSERTN(self_p != NULL, EINVAL);
+    ASSERTN(dst_p != NULL, EINVAL);
+    ASSERTN(src_p != NULL, EINVAL);
+
+    ssize_t res;
+    size_t i;
+
+    if (self_p->current.block_p == NULL) {
+        return (-ENOTMOUNTED);
+    }
+
+    for (i = 0; i < length; i++) {
+        if ((dst_p[i].address >= self_p->eeprom_size)
+            || (dst_p[i].size > self_p->eeprom_size - dst_p[i].address)) {
+            return (-EINVAL);
+        }
+    }
+
+    res = 0;
+
+    mutex_lock(&self_p->mutex);
+
+    for (i = 0; i < length; i++) {
+        if (write_inner(self_p,
+                        dst_p[i].address,
+                        src_p[i].buf_p,
+                        dst_p[i].size) != dst_p[i].size) {
+            res = -1;
+            break;
+        }
+
+        res += dst_p[i].size;
+    }
+
+    mutex_unlock(&self_p->mutex);
+
+    return (res);
+}
+
+int eeprom_journal_compact(struct eeprom_journal_driver_t *self_p)
+{
+    ASSERTN(self_p != NULL, EINVAL);
+
+    int res;
+
+    if (self_p->current.block_p == NULL) {
+        return (-ENOTMOUNTED);
+    }
+
+    mutex_lock(&self_p->mutex);
+    res = compact_inner(self_p);
+    mutex_unlock(&self_p->mutex);
+
+    return (res);
+}
+
+ssize_t eeprom_journal_get_free(struct eeprom_journal_driver_t *self_p)
+{
+    ASSERTN(self_p != NULL, EINVAL);
+
+    if (self_p->current.block_p == NULL) {
+        return (-ENOTMOUNTED);
+    }
+
+    return (self_p->current.block_p->size - self_p->current.offset);
+}
+
+#endif
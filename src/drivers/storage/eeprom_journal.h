@@ -0,0 +1,215 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2014-2018, Erik Moqvist
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use, copy,
+ * modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ * This file is part of the Simba project.
+ */
+
+#ifndef __DRIVERS_EEPROM_JOURNAL_H__
+#define __DRIVERS_EEPROM_JOURNAL_H__
+
+#include "simba.h"
+
+/**
+ * Maximum page size.
+ */
+#define EEPROM_JOURNAL_PAGE_SIZE_MAX                       64
+
+/**
+ * Number of elements in the index array of an EEPROM of given size,
+ * with given page size.
+ */
+#define EEPROM_JOURNAL_INDEX_LENGTH(eeprom_size, page_size)     \
+    DIV_CEIL(eeprom_size, page_size)
+
+struct eeprom_journal_block_t {
+    uintptr_t address;
+    size_t size;
+};
+
+struct eeprom_journal_driver_t {
+    struct flash_driver_t *flash_p;
+    const struct eeprom_journal_block_t *blocks_p;
+    int number_of_blocks;
+    size_t eeprom_size;
+    size_t page_size;
+    size_t journal_offset;
+    uint16_t *index_p;
+    struct {
+        const struct eeprom_journal_block_t *block_p;
+        uint16_t revision;
+        size_t offset;
+    } current;
+    struct mutex_t mutex;
+};
+
+/**
+ * Initialize the journaled software EEPROM module. This function
+ * must be called before calling any other function in this module.
+ *
+ * The module will only be initialized once even if this function is
+ * called multiple times.
+ *
+ * @return zero(0) or negative error code.
+ */
+int eeprom_journal_module_init(void);
+
+/**
+ * Initialize given driver object.
+ *
+ * Each flash memory block starts with an eight bytes header and a
+ * snapshot of the EEPROM, followed by a journal of records. A write
+ * appends one record per page with the address, the data and a
+ * CRC. When the journal is full the current EEPROM content is
+ * written as a snapshot to the next block, called compaction, so
+ * each block is erased once per compaction instead of once per
+ * block worth of written data.
+ *
+ * The block header format is the same as the one of the
+ * `eeprom_soft` driver, so a software EEPROM chunk with
+ * `chunk_size` equal to `eeprom_size + 8` made by the build system
+ * is a valid snapshot.
+ *
+ * @param[out] self_p Driver object to initialize.
+ * @param[in] flash_p Flash driver.
+ * @param[in] blocks_p Flash memory blocks to use. Each block must
+ *                     fit the header, the snapshot and at least two
+ *                     records of one page each.
+ * @param[in] number_of_blocks Number of blocks, at least two.
+ * @param[in] eeprom_size EEPROM size in bytes, at most 65535.
+ * @param[in] page_size Page size in bytes, at most
+ *                      `EEPROM_JOURNAL_PAGE_SIZE_MAX`. A record
+ *                      never spans more than one page, and reading a
+ *                      page only visits the records written to it.
+ * @param[in] index_p Index of the latest record of each page,
+ *                    `EEPROM_JOURNAL_INDEX_LENGTH(eeprom_size,
+ *                    page_size)` elements. Built by
+ *                    `eeprom_journal_mount()` and updated on
+ *                    writes.
+ *
+ * @return zero(0) or negative error code.
+ */
+int eeprom_journal_init(struct eeprom_journal_driver_t *self_p,
+                        struct flash_driver_t *flash_p,
+                        const struct eeprom_journal_block_t *blocks_p,
+                        int number_of_blocks,
+                        size_t eeprom_size,
+                        size_t page_size,
+                        uint16_t *index_p);
+
+/**
+ * Mount given journaled software EEPROM. The latest block is found
+ * by reading the block headers, and the index is built by reading
+ * the record headers in its journal.
+ *
+ * @param[in] self_p Driver object to mount.
+ *
+ * @return zero(0) or negative error code.
+ */
+int eeprom_journal_mount(struct eeprom_journal_driver_t *self_p);
+
+/**
+ * Format given journaled software EEPROM. All bytes are 0xff after
+ * formatting.
+ *
+ * @param[in] self_p Driver object to format.
+ *
+ * @return zero(0) or negative error code.
+ */
+int eeprom_journal_format(struct eeprom_journal_driver_t *self_p);
+
+/**
+ * Read into given buffer from given address.
+ *
+ * @param[in] self_p Initialized driver object.
+ * @param[out] dst_p Buffer to read into.
+ * @param[in] src EEPROM address to read from. Addressing starts at
+ *                zero(0).
+ * @param[in] size Number of bytes to read.
+ *
+ * @return Number of bytes read or negative error code.
+ */
+ssize_t eeprom_journal_read(struct eeprom_journal_driver_t *self_p,
+                            void *dst_p,
+                            uintptr_t src,
+                            size_t size);
+
+/**
+ * Write given buffer to given address. Pages with identical data are
+ * not written.
+ *
+ * @param[in] self_p Initialized driver object.
+ * @param[in] dst EEPROM address to write to. Addressing starts at
+ *                zero(0).
+ * @param[in] src_p Buffer to write.
+ * @param[in] size Number of bytes to write.
+ *
+ * @return Number of bytes written or negative error code.
+ */
+ssize_t eeprom_journal_write(struct eeprom_journal_driver_t *self_p,
+                             uintptr_t dst,
+                             const void *src_p,
+                             size_t size);
+
+/**
+ * Write given buffers to given EEPROM addresses. Unlike
+ * `eeprom_soft_vwrite()` the buffers are written one record at a
+ * time, so a power loss may leave only some of them written.
+ *
+ * @param[in] self_p Initialized driver object.
+ * @param[in] dst_p EEPROM address ranges to write.
+ * @param[in] src_p Buffers to write in the same order as in
+ *                  `dst_p`. The size fields are not used.
+ * @param[in] length Number of elements in `dst_p` and `src_p`.
+ *
+ * @return Number of bytes written or negative error code.
+ */
+ssize_t eeprom_journal_vwrite(struct eeprom_journal_driver_t *self_p,
+                              struct iov_uintptr_t *dst_p,
+                              struct iov_t *src_p,
+                              size_t length);
+
+/**
+ * Write a snapshot of the EEPROM to the next block and start a new
+ * journal in it. Compaction is done by writes when the journal is
+ * full, but may be done earlier, for example by a low priority
+ * thread when `eeprom_journal_get_free()` is low, to keep writes
+ * fast.
+ *
+ * @param[in] self_p Mounted driver object.
+ *
+ * @return zero(0) or negative error code.
+ */
+int eeprom_journal_compact(struct eeprom_journal_driver_t *self_p);
+
+/**
+ * Get the number of free bytes in the journal of the current block.
+ *
+ * @param[in] self_p Mounted driver object.
+ *
+ * @return Number of free bytes or negative error code.
+ */
+ssize_t eeprom_journal_get_free(struct eeprom_journal_driver_t *self_p);
+
+#endif
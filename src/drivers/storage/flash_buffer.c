@@ -0,0 +1,302 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2014-2018, Erik Moqvist
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use, copy,
+ * modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ * This file is part of the Simba project.
+ */
+
+#include "simba.h"
+
+#if CONFIG_FLASH == 1
+
+/**
+ * Get the overlap of given address range and the range from begin to
+ * end, as an offset into given range and a size.
+ */
+static size_t get_overlap(uintptr_t address,
+                          size_t size,
+                          uintptr_t begin,
+                          uintptr_t end,
+                          size_t *offset_p)
+{
+    if (begin < address) {
+        begin = address;
+    }
+
+    if (end > address + size) {
+        end = (address + size);
+    }
+
+    if (begin >= end) {
+        return (0);
+    }
+
+    *offset_p = (begin - address);
+
+    return (end - begin);
+}
+
+/**
+ * Erase all scheduled sectors up to, and including, the sector of
+ * the last byte before given address.
+ */
+static int erase_ahead_until(struct flash_buffer_t *self_p,
+                             uintptr_t end)
+{
+    while ((self_p->erase_ahead.next < self_p->erase_ahead.end)
+           && (self_p->erase_ahead.next < end)) {
+        if (flash_buffer_erase_next(self_p) < 0) {
+            return (-1);
+        }
+    }
+
+    return (0);
+}
+
+static int program(struct flash_buffer_t *self_p,
+                   uintptr_t dst,
+                   const void *src_p,
+                   size_t size)
+{
+    if (erase_ahead_until(self_p, dst + size) != 0) {
+        return (-1);
+    }
+
+    if (flash_write(self_p->flash_p, dst, src_p, size) != (ssize_t)size) {
+        return (-1);
+    }
+
+    return (0);
+}
+
+int flash_buffer_module_init()
+{
+    return (flash_module_init());
+}
+
+int flash_buffer_init(struct flash_buffer_t *self_p,
+                      struct flash_driver_t *flash_p,
+                      void *buf_p,
+                      size_t size)
+{
+    ASSERTN(self_p != NULL, EINVAL);
+    ASSERTN(flash_p != NULL, EINVAL);
+    ASSERTN(buf_p != NULL, EINVAL);
+    ASSERTN(size > 0, EINVAL);
+
+    self_p->flash_p = flash_p;
+    self_p->buf_p = buf_p;
+    self_p->size = size;
+    self_p->pending.address = 0;
+    self_p->pending.size = 0;
+    self_p->erase_ahead.end = 0;
+    self_p->erase_ahead.next = 0;
+    self_p->erase_ahead.sector_size = 0;
+
+    return (0);
+}
+
+ssize_t flash_buffer_read(struct flash_buffer_t *self_p,
+                          void *dst_p,
+                          uintptr_t src,
+                          size_t size)
+{
+    ASSERTN(self_p != NULL, EINVAL);
+    ASSERTN(dst_p != NULL, EINVAL);
+    ASSERTN(size > 0, EINVAL);
+
+    ssize_t res;
+    size_t offset;
+    size_t overlap;
+    uint8_t *u8dst_p;
+
+    res = flash_read(self_p->flash_p, dst_p, src, size);
+
+    if (res != (ssize_t)size) {
+        return (res);
+    }
+
+    u8dst_p = dst_p;
+
+    /* Sectors scheduled for erasure reads as erased. */
+    overlap = get_overlap(src,
+                          size,
+                          self_p->erase_ahead.next,
+                          self_p->erase_ahead.end,
+                          &offset);
+
+    if (overlap > 0) {
+        memset(&u8dst_p[offset], 0xff, overlap);
+    }
+
+    /* Pending data replaces the flash memory contents. */
+    overlap = get_overlap(src,
+                          size,
+                          self_p->pending.address,
+                          self_p->pending.address + self_p->pending.size,
+                          &offset);
+
+    if (overlap > 0) {
+        memcpy(&u8dst_p[offset],
+               &self_p->buf_p[src + offset - self_p->pending.address],
+               overlap);
+    }
+
+    return (size);
+}
+
+ssize_t flash_buffer_write(struct flash_buffer_t *self_p,
+                           uintptr_t dst,
+                           const void *src_p,
+                           size_t size)
+{
+    ASSERTN(self_p != NULL, EINVAL);
+    ASSERTN(src_p != NULL, EINVAL);
+    ASSERTN(size > 0, EINVAL);
+
+    const uint8_t *u8src_p;
+    size_t left;
+    size_t offset;
+    size_t n;
+
+    u8src_p = src_p;
+    left = size;
+
+    while (left > 0) {
+        /* Program pending data not followed by this write. */
+        if ((self_p->pending.size > 0)
+            && (dst != self_p->pending.address + self_p->pending.size)) {
+            if (flash_buffer_flush(self_p) != 0) {
+                return (-1);
+            }
+        }
+
+        offset = (dst % self_p->size);
+
+        if (self_p->pending.size == 0) {
+            /* Program whole pages directly. */
+            if ((offset == 0) && (left >= self_p->size)) {
+                n = (left - (left % self_p->size));
+
+                if (program(self_p, dst, u8src_p, n) != 0) {
+                    return (-1);
+                }
+
+                dst += n;
+                u8src_p += n;
+                left -= n;
+                continue;
+            }
+
+            self_p->pending.address = dst;
+        }
+
+        /* Buffer up to the end of the page. */
+        n = MIN(left, self_p->size - offset);
+        memcpy(&self_p->buf_p[self_p->pending.size], u8src_p, n);
+        self_p->pending.size += n;
+        dst += n;
+        u8src_p += n;
+        left -= n;
+
+        if (offset + n == self_p->size) {
+            if (flash_buffer_flush(self_p) != 0) {
+                return (-1);
+            }
+        }
+    }
+
+    return (size);
+}
+
+int flash_buffer_flush(struct flash_buffer_t *self_p)
+{
+    ASSERTN(self_p != NULL, EINVAL);
+
+    int res;
+
+    if (self_p->pending.size == 0) {
+        return (0);
+    }
+
+    res = program(self_p,
+                  self_p->pending.address,
+                  self_p->buf_p,
+                  self_p->pending.size);
+    self_p->pending.size = 0;
+
+    return (res);
+}
+
+int flash_buffer_erase(struct flash_buffer_t *self_p,
+                       uintptr_t addr,
+                       size_t size)
+{
+    ASSERTN(self_p != NULL, EINVAL);
+    ASSERTN(size > 0, EINVAL);
+
+    if (flash_buffer_flush(self_p) != 0) {
+        return (-1);
+    }
+
+    return (flash_erase(self_p->flash_p, addr, size));
+}
+
+int flash_buffer_erase_ahead(struct flash_buffer_t *self_p,
+                             uintptr_t addr,
+                             size_t size,
+                             size_t sector_size)
+{
+    ASSERTN(self_p != NULL, EINVAL);
+    ASSERTN(sector_size > 0, EINVAL);
+    ASSERTN((addr % sector_size) == 0, EINVAL);
+    ASSERTN((size % sector_size) == 0, EINVAL);
+
+    self_p->erase_ahead.next = addr;
+    self_p->erase_ahead.end = (addr + size);
+    self_p->erase_ahead.sector_size = sector_size;
+
+    return (0);
+}
+
+int flash_buffer_erase_next(struct flash_buffer_t *self_p)
+{
+    ASSERTN(self_p != NULL, EINVAL);
+
+    if (self_p->erase_ahead.next >= self_p->erase_ahead.end) {
+        return (0);
+    }
+
+    if (flash_erase(self_p->flash_p,
+                    self_p->erase_ahead.next,
+                    self_p->erase_ahead.sector_size) != 0) {
+        return (-1);
+    }
+
+    self_p->erase_ahead.next += self_p->erase_ahead.sector_size;
+
+    return (1);
+}
+
+#endif
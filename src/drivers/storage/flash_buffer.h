@@ -0,0 +1,169 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2014-2018, Erik Moqvist
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use, copy,
+ * modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ * This file is part of the Simba project.
+ */
+
+#ifndef __DRIVERS_FLASH_BUFFER_H__
+#define __DRIVERS_FLASH_BUFFER_H__
+
+#include "simba.h"
+
+/**
+ * A write buffer on top of a flash driver.
+ */
+struct flash_buffer_t {
+    struct flash_driver_t *flash_p;
+    uint8_t *buf_p;
+    size_t size;
+    struct {
+        uintptr_t address;
+        size_t size;
+    } pending;
+    struct {
+        uintptr_t end;
+        uintptr_t next;
+        size_t sector_size;
+    } erase_ahead;
+};
+
+/**
+ * Initialize the flash buffer module. This function must be called
+ * before calling any other function in this module.
+ *
+ * The module will only be initialized once even if this function is
+ * called multiple times.
+ *
+ * @return zero(0) or negative error code.
+ */
+int flash_buffer_module_init(void);
+
+/**
+ * Initialize given flash buffer. Small writes to consecutive
+ * addresses are collected in given page buffer, and programmed with
+ * a single `flash_write()` call once the page is full, or when the
+ * buffer is flushed.
+ *
+ * @param[out] self_p Flash buffer to initialize.
+ * @param[in] flash_p Initialized flash driver to write to.
+ * @param[in] buf_p Page buffer.
+ * @param[in] size Page buffer size, and the flash page size. Pending
+ *                 data never crosses a page boundary.
+ *
+ * @return zero(0) or negative error code.
+ */
+int flash_buffer_init(struct flash_buffer_t *self_p,
+                      struct flash_driver_t *flash_p,
+                      void *buf_p,
+                      size_t size);
+
+/**
+ * Read data from given address. Data written to the buffer, but not
+ * yet programmed, is included, and so are erases scheduled with
+ * `flash_buffer_erase_ahead()` that are not yet performed.
+ *
+ * @param[in] self_p Initialized flash buffer.
+ * @param[out] dst_p Buffer to read into.
+ * @param[in] src Address in flash memory to read from.
+ * @param[in] size Number of bytes to read.
+ *
+ * @return Number of read bytes `size`, or negative error code.
+ */
+ssize_t flash_buffer_read(struct flash_buffer_t *self_p,
+                          void *dst_p,
+                          uintptr_t src,
+                          size_t size);
+
+/**
+ * Write data to given address. Data is programmed once a page is
+ * complete, a non-consecutive address is written, or the buffer is
+ * flushed. Whole pages are programmed directly.
+ *
+ * @param[in] self_p Initialized flash buffer.
+ * @param[in] dst Address in flash memory to write to.
+ * @param[in] src_p Buffer to write.
+ * @param[in] size Number of bytes to write.
+ *
+ * @return Number of written bytes `size`, or negative error code.
+ */
+ssize_t flash_buffer_write(struct flash_buffer_t *self_p,
+                           uintptr_t dst,
+                           const void *src_p,
+                           size_t size);
+
+/**
+ * Program any pending data.
+ *
+ * @param[in] self_p Initialized flash buffer.
+ *
+ * @return zero(0) or negative error code.
+ */
+int flash_buffer_flush(struct flash_buffer_t *self_p);
+
+/**
+ * Flush pending data and erase all sectors part of given memory
+ * range.
+ *
+ * @param[in] self_p Initialized flash buffer.
+ * @param[in] addr Address in flash memory to erase from.
+ * @param[in] size Number of bytes to erase.
+ *
+ * @return zero(0) or negative error code.
+ */
+int flash_buffer_erase(struct flash_buffer_t *self_p,
+                       uintptr_t addr,
+                       size_t size);
+
+/**
+ * Schedule the sectors of given memory range for erasure, without
+ * erasing anything yet. Sectors are erased one at a time by
+ * `flash_buffer_erase_next()`, typically called while waiting for
+ * more data to write, and otherwise just before pending data is
+ * programmed into them. This replaces one long erase before a
+ * firmware upload with short ones spread over the upload.
+ *
+ * @param[in] self_p Initialized flash buffer.
+ * @param[in] addr Sector aligned address of the range.
+ * @param[in] size Size of the range, a multiple of the sector size.
+ * @param[in] sector_size Sector size of the flash memory.
+ *
+ * @return zero(0) or negative error code.
+ */
+int flash_buffer_erase_ahead(struct flash_buffer_t *self_p,
+                             uintptr_t addr,
+                             size_t size,
+                             size_t sector_size);
+
+/**
+ * Erase the next sector scheduled by `flash_buffer_erase_ahead()`.
+ *
+ * @param[in] self_p Initialized flash buffer.
+ *
+ * @return true(1) if a sector was erased, false(0) if no sector is
+ *         left to erase, or negative error code.
+ */
+int flash_buffer_erase_next(struct flash_buffer_t *self_p);
+
+#endif
@@ -181,17 +181,15 @@ static int wait_not_busy(struct sd_driver_t *self_p,
 }
 
 /**
- * Send command index with given argument to SD card.
+ * Send command index with given argument to SD card without waiting
+ * for it to be idle.
  */
-static int command_write(struct sd_driver_t *self_p,
-                         uint8_t index,
-                         uint32_t arg)
+static int command_send(struct sd_driver_t *self_p,
+                        uint8_t index,
+                        uint32_t arg)
 {
     struct command_t command;
 
-    /* Wait for the card to be idle. */
-    wait_not_busy(self_p, 300);
-
     /* Initiate the command. */
     command.index = (0x40 | index);
     command.arg = htonl(arg);
@@ -206,6 +204,19 @@ static int command_write(struct sd_driver_t *self_p,
     return (0);
 }
 
+/**
+ * Send command index with given argument to SD card.
+ */
+static int command_write(struct sd_driver_t *self_p,
+                         uint8_t index,
+                         uint32_t arg)
+{
+    /* Wait for the card to be idle. */
+    wait_not_busy(self_p, 300);
+
+    return (command_send(self_p, index, arg));
+}
+
 /**
  * Send command index with given argument to SD card and wait for the
  * response a response with only the idle bit set.
@@ -261,6 +272,39 @@ static int command_check_call_idle(struct sd_driver_t *self_p,
     return (command_check_call(self_p, index, arg, R1_IDLE_STATE));
 }
 
+/**
+ * Stop a read multiple block transmission. The card is sending data
+ * when the command is sent, so do not wait for it to be idle, and
+ * skip the stuff byte preceding the response.
+ */
+static int stop_transmission(struct sd_driver_t *self_p)
+{
+    int i;
+    uint8_t response;
+
+    if (command_send(self_p, CMD_STOP_TRANSMISSION, 0) != 0) {
+        return (-1);
+    }
+
+    spi_get(self_p->spi_p, &response);
+
+    for (i = 0; i < RESPONSE_RETRIES; i++) {
+        if (spi_get(self_p->spi_p, &response) != 1) {
+            return (-1);
+        }
+
+        if ((response & R1_RESERVED) == 0) {
+            break;
+        }
+    }
+
+    if (response != 0) {
+        return (-1);
+    }
+
+    return (wait_not_busy(self_p, WRITE_TIMEOUT));
+}
+
 /**
  * Execute given application command.
  */
@@ -276,6 +320,89 @@ static uint8_t application_command_call(struct sd_driver_t *self_p,
     return (command_call(self_p, index, arg, response_p));
 }
 
+/**
+ * Receive a data block and check its checksum.
+ */
+static int read_data_block(struct sd_driver_t *self_p,
+                           void *dst_p,
+                           size_t size)
+{
+    uint16_t real_crc, expected_crc;
+
+    /* Receive the data block start token. */
+    if (wait_for_data_start_block(self_p) != 0) {
+        return (-SD_ERR_READ_DATA_START_BLOCK);
+    }
+
+    /* Receive the data and it's checksum. */
+    spi_read(self_p->spi_p, dst_p, size);
+    spi_read(self_p->spi_p, &expected_crc, sizeof(expected_crc));
+
+    /* Calculate the checksum of the received data. */
+    real_crc = crc_xmodem(0, dst_p, size);
+    expected_crc = ntohs(expected_crc);
+
+    if (real_crc != expected_crc) {
+        return (-SD_ERR_READ_WRONG_DATA_CRC);
+    }
+
+    return (0);
+}
+
+/**
+ * Send a data block starting with given token and wait for the card
+ * to program it.
+ */
+static int write_data_block(struct sd_driver_t *self_p,
+                            uint8_t token,
+                            const void *src_p)
+{
+    uint16_t crc;
+    uint8_t response;
+
+    /* Calculate the checksum of the data. */
+    crc = crc_xmodem(0, src_p, SD_BLOCK_SIZE);
+    crc = htons(crc);
+
+    /* Write the start token. */
+    spi_put(self_p->spi_p, token);
+
+    /* Write the data and it's checksum. */
+    spi_write(self_p->spi_p, src_p, SD_BLOCK_SIZE);
+    spi_write(self_p->spi_p, &crc, sizeof(crc));
+
+    /* Wait for the data-response token. */
+    spi_get(self_p->spi_p, &response);
+
+    if ((response & TOKEN_DATA_RES_MASK) != TOKEN_DATA_RES_ACCEPTED) {
+        return (-SD_ERR_WRITE_BLOCK_TOKEN_DATA_RES_ACCEPTED);
+    }
+
+    /* Wait for the write operation to complete. */
+    if (wait_not_busy(self_p, WRITE_TIMEOUT) != 0) {
+        return (-SD_ERR_WRITE_BLOCK_WAIT_NOT_BUSY);
+    }
+
+    return (0);
+}
+
+/**
+ * Read the card status after a write and check that no error
+ * occurred.
+ */
+static int check_write_status(struct sd_driver_t *self_p)
+{
+    uint8_t response;
+
+    if (command_check_call(self_p, CMD_SEND_STATUS, 0, 0) != 0) {
+        return (-SD_ERR_WRITE_BLOCK_SEND_STATUS);
+    }
+
+    spi_get(self_p->spi_p, &response);
+
+    return (response == 0 ? 0 : -1);
+}
+
 /**
  * Read from the SD card.
  */
@@ -285,7 +412,6 @@ static ssize_t read(struct sd_driver_t *self_p,
                     void *dst_p,
                     size_t size)
 {
-    uint16_t real_crc, expected_crc;
     ssize_t res;
 
     spi_take_bus(self_p->spi_p);
@@ -297,27 +423,12 @@ static ssize_t read(struct sd_driver_t *self_p,
         goto out;
     }
 
-    /* Receive the data block start token. */
-    if (wait_for_data_start_block(self_p) != 0) {
-        res = -SD_ERR_READ_DATA_START_BLOCK;
-        goto out;
-    }
-
-    /* Receive the data and it's checksum. */
-    spi_read(self_p->spi_p, dst_p, size);
-    spi_read(self_p->spi_p, &expected_crc, sizeof(expected_crc));
-
-    /* Calculate the checksum of the received data. */
-    real_crc = crc_xmodem(0, dst_p, size);
-    expected_crc = ntohs(expected_crc);
+    res = read_data_block(self_p, dst_p, size);
 
-    if (real_crc != expected_crc) {
-        res = -SD_ERR_READ_WRONG_DATA_CRC;
-        goto out;
+    if (res == 0) {
+        res = size;
     }
 
-    res = size;
-
  out:
     spi_deselect(self_p->spi_p);
     spi_give_bus(self_p->spi_p);
@@ -325,6 +436,10 @@ static ssize_t read(struct sd_driver_t *self_p,
     return (res);
 }
 
+#if defined(PORT_HAS_SD_HOST)
+#    include "sd_port.i"
+#endif
+
 int sd_init(struct sd_driver_t *self_p,
             struct spi_driver_t *spi_p)
 {
@@ -332,10 +447,30 @@ int sd_init(struct sd_driver_t *self_p,
     ASSERTN(spi_p != NULL, EINVAL);
 
     self_p->spi_p = spi_p;
+#if defined(PORT_HAS_SD_HOST)
+    self_p->host.dev_p = NULL;
+#endif
 
     return (0);
 }
 
+#if defined(PORT_HAS_SD_HOST)
+
+int sd_init_host(struct sd_driver_t *self_p,
+                 struct sd_device_t *dev_p)
+{
+    ASSERTN(self_p != NULL, EINVAL);
+    ASSERTN(dev_p != NULL, EINVAL);
+
+    memset(&self_p->host, 0, sizeof(self_p->host));
+    self_p->spi_p = NULL;
+    self_p->host.dev_p = dev_p;
+
+    return (0);
+}
+
+#endif
+
 int sd_start(struct sd_driver_t *self_p)
 {
     ASSERTN(self_p != NULL, EINVAL);
@@ -346,6 +481,12 @@ int sd_start(struct sd_driver_t *self_p)
     uint8_t buf[8];
     uint8_t response;
 
+#if defined(PORT_HAS_SD_HOST)
+    if (self_p->host.dev_p != NULL) {
+        return (sd_port_start(self_p));
+    }
+#endif
+
     res = -1;
 
     /* Start with unknown card type */
@@ -449,6 +590,12 @@ int sd_stop(struct sd_driver_t *self_p)
 {
     ASSERTN(self_p != NULL, EINVAL);
 
+#if defined(PORT_HAS_SD_HOST)
+    if (self_p->host.dev_p != NULL) {
+        return (sd_port_stop(self_p));
+    }
+#endif
+
     return (0);
 }
 
@@ -458,6 +605,15 @@ ssize_t sd_read_cid(struct sd_driver_t *self_p,
     ASSERTN(self_p != NULL, EINVAL);
     ASSERTN(cid_p != NULL, EINVAL);
 
+#if defined(PORT_HAS_SD_HOST)
+    /* The CID is read during the identification in sd_start(). */
+    if (self_p->host.dev_p != NULL) {
+        memcpy(cid_p, &self_p->host.cid, sizeof(*cid_p));
+
+        return (sizeof(*cid_p));
+    }
+#endif
+
     return (read(self_p, CMD_SEND_CID, 0, cid_p, sizeof(*cid_p)));
 }
 
@@ -467,6 +623,15 @@ ssize_t sd_read_csd(struct sd_driver_t *self_p,
     ASSERTN(self_p != NULL, EINVAL);
     ASSERTN(csd_p != NULL, EINVAL);
 
+#if defined(PORT_HAS_SD_HOST)
+    /* The CSD is read before the card is selected in sd_start(). */
+    if (self_p->host.dev_p != NULL) {
+        memcpy(csd_p, &self_p->host.csd, sizeof(*csd_p));
+
+        return (sizeof(*csd_p));
+    }
+#endif
+
     return (read(self_p, CMD_SEND_CSD, 0, csd_p, sizeof(*csd_p)));
 }
 
@@ -515,6 +680,12 @@ ssize_t sd_read_block(struct sd_driver_t *self_p,
     ASSERTN(self_p != NULL, EINVAL);
     ASSERTN(dst_p != NULL, EINVAL);
 
+#if defined(PORT_HAS_SD_HOST)
+    if (self_p->host.dev_p != NULL) {
+        return (sd_port_read_blocks(self_p, dst_p, src_block, 1));
+    }
+#endif
+
     if (self_p->type != TYPE_SDHC) {
         src_block <<= 9;
     }
@@ -526,6 +697,76 @@ ssize_t sd_read_block(struct sd_driver_t *self_p,
                  SD_BLOCK_SIZE));
 }
 
+ssize_t sd_read_blocks(struct sd_driver_t *self_p,
+                       void *dst_p,
+                       uint32_t src_block,
+                       size_t count)
+{
+    ASSERTN(self_p != NULL, EINVAL);
+    ASSERTN(dst_p != NULL, EINVAL);
+
+    ssize_t res;
+    size_t i;
+    uint8_t *u8dst_p;
+
+#if defined(PORT_HAS_SD_HOST)
+    if (self_p->host.dev_p != NULL) {
+        return (sd_port_read_blocks(self_p, dst_p, src_block, count));
+    }
+#endif
+
+    if (count == 1) {
+        return (sd_read_block(self_p, dst_p, src_block));
+    }
+
+    if (self_p->type != TYPE_SDHC) {
+        src_block <<= 9;
+    }
+
+    u8dst_p = dst_p;
+
+    spi_take_bus(self_p->spi_p);
+    spi_select(self_p->spi_p);
+
+    /* Issue read multiple block command. */
+    if (command_check_call(self_p,
+                           CMD_READ_MULTIPLE_BLOCK,
+                           src_block,
+                           0) != 0) {
+        res = -SD_ERR_READ_COMMAND;
+        goto out;
+    }
+
+    res = 0;
+
+    for (i = 0; i < count; i++) {
+        res = read_data_block(self_p, u8dst_p, SD_BLOCK_SIZE);
+
+        if (res != 0) {
+            break;
+        }
+
+        u8dst_p += SD_BLOCK_SIZE;
+    }
+
+    /* Stop the transmission, also after an error. */
+    if (stop_transmission(self_p) != 0) {
+        if (res == 0) {
+            res = -SD_ERR_STOP_TRANSMISSION;
+        }
+    }
+
+    if (res == 0) {
+        res = (count * SD_BLOCK_SIZE);
+    }
+
+ out:
+    spi_deselect(self_p->spi_p);
+    spi_give_bus(self_p->spi_p);
+
+    return (res);
+}
+
 ssize_t sd_write_block(struct sd_driver_t *self_p,
                        uint32_t dst_block,
                        const void *src_p)
@@ -534,20 +775,18 @@ ssize_t sd_write_block(struct sd_driver_t *self_p,
     ASSERTN(src_p != NULL, EINVAL);
 
     ssize_t res;
-    uint16_t crc;
-    uint8_t response;
 
-    res = -1;
+#if defined(PORT_HAS_SD_HOST)
+    if (self_p->host.dev_p != NULL) {
+        return (sd_port_write_blocks(self_p, dst_block, src_p, 1));
+    }
+#endif
 
     /* Check for byte address adjustment. */
     if (self_p->type != TYPE_SDHC) {
         dst_block <<= 9;
     }
 
-    /* Calculate the checksum of the reseiced data. */
-    crc = crc_xmodem(0, src_p, SD_BLOCK_SIZE);
-    crc = htons(crc);
-
     spi_take_bus(self_p->spi_p);
     spi_select(self_p->spi_p);
 
@@ -557,35 +796,104 @@ ssize_t sd_write_block(struct sd_driver_t *self_p,
         goto out;
     }
 
-    /* Write the start token. */
-    spi_put(self_p->spi_p, TOKEN_DATA_START_BLOCK);
+    res = write_data_block(self_p, TOKEN_DATA_START_BLOCK, src_p);
 
-    /* Write the data and it's checksum. */
-    spi_write(self_p->spi_p, src_p, SD_BLOCK_SIZE);
-    spi_write(self_p->spi_p, &crc, sizeof(crc));
+    if (res != 0) {
+        goto out;
+    }
 
-    /* Wait for the data-response token. */
-    spi_get(self_p->spi_p, &response);
+    res = check_write_status(self_p);
 
-    if ((response & TOKEN_DATA_RES_MASK) != TOKEN_DATA_RES_ACCEPTED) {
-        res = -SD_ERR_WRITE_BLOCK_TOKEN_DATA_RES_ACCEPTED;
+    if (res == 0) {
+        res = SD_BLOCK_SIZE;
+    }
+
+ out:
+    spi_deselect(self_p->spi_p);
+    spi_give_bus(self_p->spi_p);
+
+    return (res);
+}
+
+ssize_t sd_write_blocks(struct sd_driver_t *self_p,
+                        uint32_t dst_block,
+                        const void *src_p,
+                        size_t count)
+{
+    ASSERTN(self_p != NULL, EINVAL);
+    ASSERTN(src_p != NULL, EINVAL);
+
+    ssize_t res;
+    size_t i;
+    uint8_t response;
+    const uint8_t *u8src_p;
+
+#if defined(PORT_HAS_SD_HOST)
+    if (self_p->host.dev_p != NULL) {
+        return (sd_port_write_blocks(self_p, dst_block, src_p, count));
+    }
+#endif
+
+    if (count == 1) {
+        return (sd_write_block(self_p, dst_block, src_p));
+    }
+
+    if (self_p->type != TYPE_SDHC) {
+        dst_block <<= 9;
+    }
+
+    u8src_p = src_p;
+
+    spi_take_bus(self_p->spi_p);
+    spi_select(self_p->spi_p);
+
+    /* Let the card pre-erase the blocks to be written. It is only a
+       hint, so errors are ignored. */
+    if (command_check_call(self_p, CMD_APP_CMD, 0, 0) == 0) {
+        command_call(self_p, ACMD_SET_WR_BLK_ERASE_COUNT, count, &response);
+    }
+
+    /* Issue write multiple block command. */
+    if (command_check_call(self_p,
+                           CMD_WRITE_MULTIPLE_BLOCK,
+                           dst_block,
+                           0) != 0) {
+        res = -SD_ERR_WRITE_BLOCK;
         goto out;
     }
 
-    /* Wait for the write operation to complete and check status */
+    res = 0;
+
+    for (i = 0; i < count; i++) {
+        res = write_data_block(self_p, TOKEN_WRITE_MULTIPLE_TOKEN, u8src_p);
+
+        if (res != 0) {
+            break;
+        }
+
+        u8src_p += SD_BLOCK_SIZE;
+    }
+
+    /* Stop the transmission, also after an error, and wait for the
+       card to finish programming. */
+    spi_put(self_p->spi_p, TOKEN_STOP_TRAN_TOKEN);
+    spi_get(self_p->spi_p, &response);
+
     if (wait_not_busy(self_p, WRITE_TIMEOUT) != 0) {
-        res = -SD_ERR_WRITE_BLOCK_WAIT_NOT_BUSY;
-        goto out;
+        if (res == 0) {
+            res = -SD_ERR_STOP_TRANSMISSION;
+        }
     }
 
-    if (command_check_call(self_p, CMD_SEND_STATUS, 0, 0) != 0) {
-        res = -SD_ERR_WRITE_BLOCK_SEND_STATUS;
+    if (res != 0) {
         goto out;
     }
 
-    spi_get(self_p->spi_p, &response);
+    res = check_write_status(self_p);
 
-    res = (response == 0 ? SD_BLOCK_SIZE : -1);
+    if (res == 0) {
+        res = (count * SD_BLOCK_SIZE);
+    }
 
  out:
     spi_deselect(self_p->spi_p);
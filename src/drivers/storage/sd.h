@@ -46,6 +46,13 @@
 #define SD_ERR_WRITE_BLOCK_TOKEN_DATA_RES_ACCEPTED   5012
 #define SD_ERR_WRITE_BLOCK_WAIT_NOT_BUSY             5013
 #define SD_ERR_WRITE_BLOCK_SEND_STATUS               5014
+#define SD_ERR_STOP_TRANSMISSION                     5015
+#define SD_ERR_ALL_SEND_CID                          5016
+#define SD_ERR_SEND_RELATIVE_ADDR                    5017
+#define SD_ERR_SEND_CSD                              5018
+#define SD_ERR_SELECT_CARD                           5019
+#define SD_ERR_SET_BUS_WIDTH                         5020
+#define SD_ERR_SET_BLOCKLEN                          5021
 
 #define SD_BLOCK_SIZE 512
 
@@ -171,11 +178,22 @@ union sd_csd_t {
     struct sd_csd_v2_t v2;
 };
 
+#if defined(PORT_HAS_SD_HOST)
+#    include "sd_port.h"
+#endif
+
 struct sd_driver_t {
     struct spi_driver_t *spi_p;
     int type;
+#if defined(PORT_HAS_SD_HOST)
+    struct sd_host_t host;
+#endif
 };
 
+#if defined(PORT_HAS_SD_HOST)
+extern struct sd_device_t sd_device[SD_DEVICE_MAX];
+#endif
+
 /**
  * Initialize given driver object.
  *
@@ -186,6 +204,28 @@ struct sd_driver_t {
 int sd_init(struct sd_driver_t *self_p,
             struct spi_driver_t *spi_p);
 
+#if defined(PORT_HAS_SD_HOST)
+
+/**
+ * Initialize given driver object to use the native SD bus of given
+ * host controller instead of SPI. `sd_start()` identifies the card in
+ * one bit mode, then switches to a four bit data bus, and to high
+ * speed if the card supports it. Block transfers use DMA when the
+ * dma driver is enabled.
+ *
+ * All other functions in this module behave the same as in SPI
+ * mode, so for example the fat16 block callbacks need no changes.
+ *
+ * @param[in,out] self_p Driver object to initialize.
+ * @param[in] dev_p SD host controller device to use.
+ *
+ * @return zero(0) or negative error code.
+ */
+int sd_init_host(struct sd_driver_t *self_p,
+                 struct sd_device_t *dev_p);
+
+#endif
+
 /**
  * Start given SD card driver. This resets the SD card and performs
  * the initialization sequence.
@@ -259,6 +299,24 @@ ssize_t sd_read_block(struct sd_driver_t *self_p,
                       void *dst_p,
                       uint32_t src_block);
 
+/**
+ * Read given number of consecutive blocks from SD card with a single
+ * read multiple block command, which is considerably faster than
+ * reading one block at a time.
+ *
+ * @param[in] self_p Initialized driver object.
+ * @param[in] dst_p Buffer to read into. Must be at least ``count *
+ *                  SD_BLOCK_SIZE`` bytes.
+ * @param[in] src_block First block to read from.
+ * @param[in] count Number of blocks to read.
+ *
+ * @return Number of read bytes or negative error code.
+ */
+ssize_t sd_read_blocks(struct sd_driver_t *self_p,
+                       void *dst_p,
+                       uint32_t src_block,
+                       size_t count);
+
 /**
  * Write data to the SD card.
  *
@@ -272,4 +330,22 @@ ssize_t sd_write_block(struct sd_driver_t *self_p,
                        uint32_t dst_block,
                        const void *src_p);
 
+/**
+ * Write given number of consecutive blocks to the SD card with a
+ * single write multiple block command. The card is told to pre-erase
+ * the blocks before they are written.
+ *
+ * @param[in] self_p Initialized driver object.
+ * @param[in] dst_block First block to write to.
+ * @param[in] src_p Buffer to write. Must be ``count * SD_BLOCK_SIZE``
+ *                  bytes.
+ * @param[in] count Number of blocks to write.
+ *
+ * @return Number of written bytes or negative error code.
+ */
+ssize_t sd_write_blocks(struct sd_driver_t *self_p,
+                        uint32_t dst_block,
+                        const void *src_p,
+                        size_t count);
+
 #endif
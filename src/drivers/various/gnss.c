@@ -70,62 +70,26 @@ static int read_byte(struct gnss_driver_t *self_p,
 }
 
 /**
- * Find the start of an NMEA sentence (dollar sign).
+ * Publish the current fix on the bus, if any.
  */
-static int find_sentence_start(struct gnss_driver_t *self_p)
+static void publish_fix(struct gnss_driver_t *self_p,
+                        enum nmea_sentence_type_t type)
 {
-    int res;
-    char byte;
-
-    while (1) {
-        res = read_byte(self_p, &byte);
-
-        if (res != sizeof(byte)) {
-            return (res);
-        }
+    struct gnss_fix_t fix;
 
-        if (byte == '$') {
-            self_p->nmea.input.buf[0] = '$';
-            self_p->nmea.input.size = 1;
-            DLOG(DEBUG, "NMEA sentence start found.\r\n");
-            break;
-        }
+    if (self_p->fix.bus_p == NULL) {
+        return;
     }
 
-    return (0);
-}
-
-/**
- * Read the rest of the sentence (until linefeed).
- */
-static int read_until_sentence_end(struct gnss_driver_t *self_p)
-{
-    int res;
-    char byte;
-
-    while (1) {
-        res = read_byte(self_p, &byte);
-
-        if (res != sizeof(byte)) {
-            return (res);
-        }
+    fix.type = type;
+    fix.date = self_p->date;
+    fix.latitude = self_p->position.latitude_degrees;
+    fix.longitude = self_p->position.longitude_degrees;
+    fix.speed = self_p->speed;
+    fix.number_of_satellites = self_p->number_of_satellites;
+    fix.altitude = self_p->altitude;
 
-        /* Space for the read character and a null-termination. */
-        if ((self_p->nmea.input.size + 1) == sizeof(self_p->nmea.input.buf)) {
-            self_p->nmea.input.size = 0;
-            return (-ENOMEM);
-        }
-
-        self_p->nmea.input.buf[self_p->nmea.input.size] = byte;
-        self_p->nmea.input.size++;
-
-        if (byte == '\n') {
-            self_p->nmea.input.buf[self_p->nmea.input.size] = '\0';
-            break;
-        }
-    }
-
-    return (0);
+    bus_write(self_p->fix.bus_p, self_p->fix.id, &fix, sizeof(fix));
 }
 
 /**
@@ -178,6 +142,7 @@ static int process_gga(struct gnss_driver_t *self_p)
     self_p->altitude = altitude;
 
     sys_uptime(&self_p->gga_timestamp);
+    publish_fix(self_p, nmea_sentence_type_gga_t);
 
     return (0);
 }
@@ -266,26 +231,19 @@ static int process_rmc(struct gnss_driver_t *self_p)
     self_p->speed = NMEA_KNOTS_TO_METERS_PER_SECOND(speed);
 
     sys_uptime(&self_p->rmc_timestamp);
+    publish_fix(self_p, nmea_sentence_type_rmc_t);
 
     return (0);
 }
 
 /**
- * Process the read sentence.
+ * Process the decoded sentence.
  */
 static int process_sentence(struct gnss_driver_t *self_p)
 {
-    ssize_t res;
-
-    /* Decode the sentence. */
-    res = nmea_decode(&self_p->nmea.decoded,
-                      &self_p->nmea.input.buf[0],
-                      self_p->nmea.input.size);
+    int res;
 
-    if (res != 0) {
-        DLOG(WARNING, "NMEA sentence decoding failed with %d.\r\n", res);
-        return (res);
-    }
+    res = 0;
 
     /* Process the decoded sentence. */
     switch (self_p->nmea.decoded.type) {
@@ -305,7 +263,7 @@ static int process_sentence(struct gnss_driver_t *self_p)
         break;
     }
 
-    return (0);
+    return (res);
 }
 
 int gnss_module_init()
@@ -330,7 +288,8 @@ int gnss_init(struct gnss_driver_t *self_p,
     self_p->rmc_timestamp.seconds = -1;
     self_p->gga_timestamp.seconds = -1;
     self_p->position.timestamp_p = &self_p->rmc_timestamp;
-    self_p->nmea.input.size = 0;
+    self_p->fix.bus_p = NULL;
+    nmea_decoder_init(&self_p->nmea.decoder, NMEA_SENTENCE_TYPE_MASK_ALL);
 
 #if CONFIG_GNSS_DEBUG_LOG_MASK > -1
     log_object_init(&self_p->log, "gnss", CONFIG_GNSS_DEBUG_LOG_MASK);
@@ -339,34 +298,56 @@ int gnss_init(struct gnss_driver_t *self_p,
     return (0);
 }
 
+int gnss_set_sentence_types(struct gnss_driver_t *self_p,
+                            uint32_t types_mask)
+{
+    ASSERTN(self_p != NULL, EINVAL);
+
+    return (nmea_decoder_init(&self_p->nmea.decoder, types_mask));
+}
+
+int gnss_set_bus(struct gnss_driver_t *self_p,
+                 struct bus_t *bus_p,
+                 int id)
+{
+    ASSERTN(self_p != NULL, EINVAL);
+
+    self_p->fix.bus_p = bus_p;
+    self_p->fix.id = id;
+
+    return (0);
+}
+
 int gnss_read(struct gnss_driver_t *self_p)
 {
     int res;
+    char byte;
 
-    /* Find the beginning of an NMEA sentence if the sentence buffer
-       is empty. */
-    if (self_p->nmea.input.size == 0) {
-        res = find_sentence_start(self_p);
+    /* Feed the decoder until a complete sentence has been
+       decoded. */
+    while (1) {
+        res = read_byte(self_p, &byte);
 
-        if (res != 0) {
+        if (res != sizeof(byte)) {
             return (res);
         }
-    }
 
-    /* Read the rest of the sentence. */
-    res = read_until_sentence_end(self_p);
+        res = nmea_decoder_input(&self_p->nmea.decoder,
+                                 byte,
+                                 &self_p->nmea.decoded);
 
-    if (res != 0) {
-        return (res);
-    }
+        if (res == 1) {
+            break;
+        }
 
-    /* Process the read sentence. */
-    res = process_sentence(self_p);
+        if (res < 0) {
+            DLOG(WARNING, "NMEA sentence decoding failed with %d.\r\n", res);
 
-    /* Expect a new sentence. */
-    self_p->nmea.input.size = 0;
+            return (res);
+        }
+    }
 
-    return (res);
+    return (process_sentence(self_p));
 }
 
 int gnss_write(struct gnss_driver_t *self_p,
@@ -31,6 +31,25 @@
 
 #include "simba.h"
 
+/**
+ * A fix published on the bus given to `gnss_set_bus()`, with the
+ * most recently received values.
+ */
+struct gnss_fix_t {
+    /** Type of the sentence that updated the fix, GGA or RMC. */
+    enum nmea_sentence_type_t type;
+    struct date_t date;
+    /** Latitude in microdegrees. */
+    long latitude;
+    /** Longitude in microdegrees. */
+    long longitude;
+    /** Speed in millimeters per second. */
+    long speed;
+    int number_of_satellites;
+    /** Altitude in millimeters. */
+    long altitude;
+};
+
 struct gnss_driver_t {
     void *chin_p;
     void *chout_p;
@@ -46,12 +65,13 @@ struct gnss_driver_t {
     int number_of_satellites;
     long altitude;
     struct {
-        struct {
-            char buf[NMEA_SENTENCE_SIZE_MAX];
-            size_t size;
-        } input;
+        struct nmea_decoder_t decoder;
         struct nmea_sentence_t decoded;
     } nmea;
+    struct {
+        struct bus_t *bus_p;
+        int id;
+    } fix;
 #if CONFIG_GNSS_DEBUG_LOG_MASK > -1
     struct log_object_t log;
 #endif
@@ -81,9 +101,39 @@ int gnss_init(struct gnss_driver_t *self_p,
               void *chin_p,
               void *chout_p);
 
+/**
+ * Only decode NMEA sentences of given types. All other sentences are
+ * skipped by `gnss_read()` as soon as their type is known. All types
+ * are decoded by default.
+ *
+ * @param[in] self_p Initialized driver object.
+ * @param[in] types_mask Sentence types to decode, see
+ *                       `nmea_decoder_init()`.
+ *
+ * @return zero(0) or negative error code.
+ */
+int gnss_set_sentence_types(struct gnss_driver_t *self_p,
+                            uint32_t types_mask);
+
+/**
+ * Publish a ``struct gnss_fix_t`` with given message id on given bus
+ * every time a GGA or RMC sentence has been read.
+ *
+ * @param[in] self_p Initialized driver object.
+ * @param[in] bus_p Bus to publish fixes on, or NULL to stop
+ *                  publishing.
+ * @param[in] id Message id.
+ *
+ * @return zero(0) or negative error code.
+ */
+int gnss_set_bus(struct gnss_driver_t *self_p,
+                 struct bus_t *bus_p,
+                 int id);
+
 /**
  * Update the GNSS driver state by reading and parsing a NMEA sentence
- * from the transport channel.
+ * from the transport channel. The sentence is decoded byte by byte
+ * as it is read.
  *
  * NOTE: NMEA sentences will be lost if this function is called too
  *       seldom (due to transport channel input overrun).
@@ -28,43 +28,251 @@
 
 #include "simba.h"
 
+static FAR const char alphabet[] =
+    "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+
+#if CONFIG_BASE64_ENCODE_TABLE_16 == 1
+
+/* Two characters per 12 bits of input. */
+static FAR const char encode_table[] =
+    "AAABACADAEAFAGAHAIAJAKALAMANAOAPAQARASATAUAVAWAXAYAZAaAbAcAdAeAf"
+    "AgAhAiAjAkAlAmAnAoApAqArAsAtAuAvAwAxAyAzA0A1A2A3A4A5A6A7A8A9A+A/"
+    "BABBBCBDBEBFBGBHBIBJBKBLBMBNBOBPBQBRBSBTBUBVBWBXBYBZBaBbBcBdBeBf"
+    "BgBhBiBjBkBlBmBnBoBpBqBrBsBtBuBvBwBxByBzB0B1B2B3B4B5B6B7B8B9B+B/"
+    "CACBCCCDCECFCGCHCICJCKCLCMCNCOCPCQCRCSCTCUCVCWCXCYCZCaCbCcCdCeCf"
+    "CgChCiCjCkClCmCnCoCpCqCrCsCtCuCvCwCxCyCzC0C1C2C3C4C5C6C7C8C9C+C/"
+    "DADBDCDDDEDFDGDHDIDJDKDLDMDNDODPDQDRDSDTDUDVDWDXDYDZDaDbDcDdDeDf"
+    "DgDhDiDjDkDlDmDnDoDpDqDrDsDtDuDvDwDxDyDzD0D1D2D3D4D5D6D7D8D9D+D/"
+    "EAEBECEDEEEFEGEHEIEJEKELEMENEOEPEQERESETEUEVEWEXEYEZEaEbEcEdEeEf"
+    "EgEhEiEjEkElEmEnEoEpEqErEsEtEuEvEwExEyEzE0E1E2E3E4E5E6E7E8E9E+E/"
+    "FAFBFCFDFEFFFGFHFIFJFKFLFMFNFOFPFQFRFSFTFUFVFWFXFYFZFaFbFcFdFeFf"
+    "FgFhFiFjFkFlFmFnFoFpFqFrFsFtFuFvFwFxFyFzF0F1F2F3F4F5F6F7F8F9F+F/"
+    "GAGBGCGDGEGFGGGHGIGJGKGLGMGNGOGPGQGRGSGTGUGVGWGXGYGZGaGbGcGdGeGf"
+    "GgGhGiGjGkGlGmGnGoGpGqGrGsGtGuGvGwGxGyGzG0G1G2G3G4G5G6G7G8G9G+G/"
+    "HAHBHCHDHEHFHGHHHIHJHKHLHMHNHOHPHQHRHSHTHUHVHWHXHYHZHaHbHcHdHeHf"
+    "HgHhHiHjHkHlHmHnHoHpHqHrHsHtHuHvHwHxHyHzH0H1H2H3H4H5H6H7H8H9H+H/"
+    "IAIBICIDIEIFIGIHIIIJIKILIMINIOIPIQIRISITIUIVIWIXIYIZIaIbIcIdIeIf"
+    "IgIhIiIjIkIlImInIoIpIqIrIsItIuIvIwIxIyIzI0I1I2I3I4I5I6I7I8I9I+I/"
+    "JAJBJCJDJEJFJGJHJIJJJKJLJMJNJOJPJQJRJSJTJUJVJWJXJYJZJaJbJcJdJeJf"
+    "JgJhJiJjJkJlJmJnJoJpJqJrJsJtJuJvJwJxJyJzJ0J1J2J3J4J5J6J7J8J9J+J/"
+    "KAKBKCKDKEKFKGKHKIKJKKKLKMKNKOKPKQKRKSKTKUKVKWKXKYKZKaKbKcKdKeKf"
+    "KgKhKiKjKkKlKmKnKoKpKqKrKsKtKuKvKwKxKyKzK0K1K2K3K4K5K6K7K8K9K+K/"
+    "LALBLCLDLELFLGLHLILJLKLLLMLNLOLPLQLRLSLTLULVLWLXLYLZLaLbLcLdLeLf"
+    "LgLhLiLjLkLlLmLnLoLpLqLrLsLtLuLvLwLxLyLzL0L1L2L3L4L5L6L7L8L9L+L/"
+    "MAMBMCMDMEMFMGMHMIMJMKMLMMMNMOMPMQMRMSMTMUMVMWMXMYMZMaMbMcMdMeMf"
+    "MgMhMiMjMkMlMmMnMoMpMqMrMsMtMuMvMwMxMyMzM0M1M2M3M4M5M6M7M8M9M+M/"
+    "NANBNCNDNENFNGNHNINJNKNLNMNNNONPNQNRNSNTNUNVNWNXNYNZNaNbNcNdNeNf"
+    "NgNhNiNjNkNlNmNnNoNpNqNrNsNtNuNvNwNxNyNzN0N1N2N3N4N5N6N7N8N9N+N/"
+    "OAOBOCODOEOFOGOHOIOJOKOLOMONOOOPOQOROSOTOUOVOWOXOYOZOaObOcOdOeOf"
+    "OgOhOiOjOkOlOmOnOoOpOqOrOsOtOuOvOwOxOyOzO0O1O2O3O4O5O6O7O8O9O+O/"
+    "PAPBPCPDPEPFPGPHPIPJPKPLPMPNPOPPPQPRPSPTPUPVPWPXPYPZPaPbPcPdPePf"
+    "PgPhPiPjPkPlPmPnPoPpPqPrPsPtPuPvPwPxPyPzP0P1P2P3P4P5P6P7P8P9P+P/"
+    "QAQBQCQDQEQFQGQHQIQJQKQLQMQNQOQPQQQRQSQTQUQVQWQXQYQZQaQbQcQdQeQf"
+    "QgQhQiQjQkQlQmQnQoQpQqQrQsQtQuQvQwQxQyQzQ0Q1Q2Q3Q4Q5Q6Q7Q8Q9Q+Q/"
+    "RARBRCRDRERFRGRHRIRJRKRLRMRNRORPRQRRRSRTRURVRWRXRYRZRaRbRcRdReRf"
+    "RgRhRiRjRkRlRmRnRoRpRqRrRsRtRuRvRwRxRyRzR0R1R2R3R4R5R6R7R8R9R+R/"
+    "SASBSCSDSESFSGSHSISJSKSLSMSNSOSPSQSRSSSTSUSVSWSXSYSZSaSbScSdSeSf"
+    "SgShSiSjSkSlSmSnSoSpSqSrSsStSuSvSwSxSySzS0S1S2S3S4S5S6S7S8S9S+S/"
+    "TATBTCTDTETFTGTHTITJTKTLTMTNTOTPTQTRTSTTTUTVTWTXTYTZTaTbTcTdTeTf"
+    "TgThTiTjTkTlTmTnToTpTqTrTsTtTuTvTwTxTyTzT0T1T2T3T4T5T6T7T8T9T+T/"
+    "UAUBUCUDUEUFUGUHUIUJUKULUMUNUOUPUQURUSUTUUUVUWUXUYUZUaUbUcUdUeUf"
+    "UgUhUiUjUkUlUmUnUoUpUqUrUsUtUuUvUwUxUyUzU0U1U2U3U4U5U6U7U8U9U+U/"
+    "VAVBVCVDVEVFVGVHVIVJVKVLVMVNVOVPVQVRVSVTVUVVVWVXVYVZVaVbVcVdVeVf"
+    "VgVhViVjVkVlVmVnVoVpVqVrVsVtVuVvVwVxVyVzV0V1V2V3V4V5V6V7V8V9V+V/"
+    "WAWBWCWDWEWFWGWHWIWJWKWLWMWNWOWPWQWRWSWTWUWVWWWXWYWZWaWbWcWdWeWf"
+    "WgWhWiWjWkWlWmWnWoWpWqWrWsWtWuWvWwWxWyWzW0W1W2W3W4W5W6W7W8W9W+W/"
+    "XAXBXCXDXEXFXGXHXIXJXKXLXMXNXOXPXQXRXSXTXUXVXWXXXYXZXaXbXcXdXeXf"
+    "XgXhXiXjXkXlXmXnXoXpXqXrXsXtXuXvXwXxXyXzX0X1X2X3X4X5X6X7X8X9X+X/"
+    "YAYBYCYDYEYFYGYHYIYJYKYLYMYNYOYPYQYRYSYTYUYVYWYXYYYZYaYbYcYdYeYf"
+    "YgYhYiYjYkYlYmYnYoYpYqYrYsYtYuYvYwYxYyYzY0Y1Y2Y3Y4Y5Y6Y7Y8Y9Y+Y/"
+    "ZAZBZCZDZEZFZGZHZIZJZKZLZMZNZOZPZQZRZSZTZUZVZWZXZYZZZaZbZcZdZeZf"
+    "ZgZhZiZjZkZlZmZnZoZpZqZrZsZtZuZvZwZxZyZzZ0Z1Z2Z3Z4Z5Z6Z7Z8Z9Z+Z/"
+    "aAaBaCaDaEaFaGaHaIaJaKaLaMaNaOaPaQaRaSaTaUaVaWaXaYaZaaabacadaeaf"
+    "agahaiajakalamanaoapaqarasatauavawaxayaza0a1a2a3a4a5a6a7a8a9a+a/"
+    "bAbBbCbDbEbFbGbHbIbJbKbLbMbNbObPbQbRbSbTbUbVbWbXbYbZbabbbcbdbebf"
+    "bgbhbibjbkblbmbnbobpbqbrbsbtbubvbwbxbybzb0b1b2b3b4b5b6b7b8b9b+b/"
+    "cAcBcCcDcEcFcGcHcIcJcKcLcMcNcOcPcQcRcScTcUcVcWcXcYcZcacbcccdcecf"
+    "cgchcicjckclcmcncocpcqcrcsctcucvcwcxcyczc0c1c2c3c4c5c6c7c8c9c+c/"
+    "dAdBdCdDdEdFdGdHdIdJdKdLdMdNdOdPdQdRdSdTdUdVdWdXdYdZdadbdcdddedf"
+    "dgdhdidjdkdldmdndodpdqdrdsdtdudvdwdxdydzd0d1d2d3d4d5d6d7d8d9d+d/"
+    "eAeBeCeDeEeFeGeHeIeJeKeLeMeNeOePeQeReSeTeUeVeWeXeYeZeaebecedeeef"
+    "egeheiejekelemeneoepeqereseteuevewexeyeze0e1e2e3e4e5e6e7e8e9e+e/"
+    "fAfBfCfDfEfFfGfHfIfJfKfLfMfNfOfPfQfRfSfTfUfVfWfXfYfZfafbfcfdfeff"
+    "fgfhfifjfkflfmfnfofpfqfrfsftfufvfwfxfyfzf0f1f2f3f4f5f6f7f8f9f+f/"
+    "gAgBgCgDgEgFgGgHgIgJgKgLgMgNgOgPgQgRgSgTgUgVgWgXgYgZgagbgcgdgegf"
+    "ggghgigjgkglgmgngogpgqgrgsgtgugvgwgxgygzg0g1g2g3g4g5g6g7g8g9g+g/"
+    "hAhBhChDhEhFhGhHhIhJhKhLhMhNhOhPhQhRhShThUhVhWhXhYhZhahbhchdhehf"
+    "hghhhihjhkhlhmhnhohphqhrhshthuhvhwhxhyhzh0h1h2h3h4h5h6h7h8h9h+h/"
+    "iAiBiCiDiEiFiGiHiIiJiKiLiMiNiOiPiQiRiSiTiUiViWiXiYiZiaibicidieif"
+    "igihiiijikiliminioipiqirisitiuiviwixiyizi0i1i2i3i4i5i6i7i8i9i+i/"
+    "jAjBjCjDjEjFjGjHjIjJjKjLjMjNjOjPjQjRjSjTjUjVjWjXjYjZjajbjcjdjejf"
+    "jgjhjijjjkjljmjnjojpjqjrjsjtjujvjwjxjyjzj0j1j2j3j4j5j6j7j8j9j+j/"
+    "kAkBkCkDkEkFkGkHkIkJkKkLkMkNkOkPkQkRkSkTkUkVkWkXkYkZkakbkckdkekf"
+    "kgkhkikjkkklkmknkokpkqkrksktkukvkwkxkykzk0k1k2k3k4k5k6k7k8k9k+k/"
+    "lAlBlClDlElFlGlHlIlJlKlLlMlNlOlPlQlRlSlTlUlVlWlXlYlZlalblcldlelf"
+    "lglhliljlklllmlnlolplqlrlsltlulvlwlxlylzl0l1l2l3l4l5l6l7l8l9l+l/"
+    "mAmBmCmDmEmFmGmHmImJmKmLmMmNmOmPmQmRmSmTmUmVmWmXmYmZmambmcmdmemf"
+    "mgmhmimjmkmlmmmnmompmqmrmsmtmumvmwmxmymzm0m1m2m3m4m5m6m7m8m9m+m/"
+    "nAnBnCnDnEnFnGnHnInJnKnLnMnNnOnPnQnRnSnTnUnVnWnXnYnZnanbncndnenf"
+    "ngnhninjnknlnmnnnonpnqnrnsntnunvnwnxnynzn0n1n2n3n4n5n6n7n8n9n+n/"
+    "oAoBoCoDoEoFoGoHoIoJoKoLoMoNoOoPoQoRoSoToUoVoWoXoYoZoaobocodoeof"
+    "ogohoiojokolomonooopoqorosotouovowoxoyozo0o1o2o3o4o5o6o7o8o9o+o/"
+    "pApBpCpDpEpFpGpHpIpJpKpLpMpNpOpPpQpRpSpTpUpVpWpXpYpZpapbpcpdpepf"
+    "pgphpipjpkplpmpnpopppqprpsptpupvpwpxpypzp0p1p2p3p4p5p6p7p8p9p+p/"
+    "qAqBqCqDqEqFqGqHqIqJqKqLqMqNqOqPqQqRqSqTqUqVqWqXqYqZqaqbqcqdqeqf"
+    "qgqhqiqjqkqlqmqnqoqpqqqrqsqtquqvqwqxqyqzq0q1q2q3q4q5q6q7q8q9q+q/"
+    "rArBrCrDrErFrGrHrIrJrKrLrMrNrOrPrQrRrSrTrUrVrWrXrYrZrarbrcrdrerf"
+    "rgrhrirjrkrlrmrnrorprqrrrsrtrurvrwrxryrzr0r1r2r3r4r5r6r7r8r9r+r/"
+    "sAsBsCsDsEsFsGsHsIsJsKsLsMsNsOsPsQsRsSsTsUsVsWsXsYsZsasbscsdsesf"
+    "sgshsisjskslsmsnsospsqsrssstsusvswsxsyszs0s1s2s3s4s5s6s7s8s9s+s/"
+    "tAtBtCtDtEtFtGtHtItJtKtLtMtNtOtPtQtRtStTtUtVtWtXtYtZtatbtctdtetf"
+    "tgthtitjtktltmtntotptqtrtstttutvtwtxtytzt0t1t2t3t4t5t6t7t8t9t+t/"
+    "uAuBuCuDuEuFuGuHuIuJuKuLuMuNuOuPuQuRuSuTuUuVuWuXuYuZuaubucudueuf"
+    "uguhuiujukulumunuoupuqurusutuuuvuwuxuyuzu0u1u2u3u4u5u6u7u8u9u+u/"
+    "vAvBvCvDvEvFvGvHvIvJvKvLvMvNvOvPvQvRvSvTvUvVvWvXvYvZvavbvcvdvevf"
+    "vgvhvivjvkvlvmvnvovpvqvrvsvtvuvvvwvxvyvzv0v1v2v3v4v5v6v7v8v9v+v/"
+    "wAwBwCwDwEwFwGwHwIwJwKwLwMwNwOwPwQwRwSwTwUwVwWwXwYwZwawbwcwdwewf"
+    "wgwhwiwjwkwlwmwnwowpwqwrwswtwuwvwwwxwywzw0w1w2w3w4w5w6w7w8w9w+w/"
+    "xAxBxCxDxExFxGxHxIxJxKxLxMxNxOxPxQxRxSxTxUxVxWxXxYxZxaxbxcxdxexf"
+    "xgxhxixjxkxlxmxnxoxpxqxrxsxtxuxvxwxxxyxzx0x1x2x3x4x5x6x7x8x9x+x/"
+    "yAyByCyDyEyFyGyHyIyJyKyLyMyNyOyPyQyRySyTyUyVyWyXyYyZyaybycydyeyf"
+    "ygyhyiyjykylymynyoypyqyrysytyuyvywyxyyyzy0y1y2y3y4y5y6y7y8y9y+y/"
+    "zAzBzCzDzEzFzGzHzIzJzKzLzMzNzOzPzQzRzSzTzUzVzWzXzYzZzazbzczdzezf"
+    "zgzhzizjzkzlzmznzozpzqzrzsztzuzvzwzxzyzzz0z1z2z3z4z5z6z7z8z9z+z/"
+    "0A0B0C0D0E0F0G0H0I0J0K0L0M0N0O0P0Q0R0S0T0U0V0W0X0Y0Z0a0b0c0d0e0f"
+    "0g0h0i0j0k0l0m0n0o0p0q0r0s0t0u0v0w0x0y0z000102030405060708090+0/"
+    "1A1B1C1D1E1F1G1H1I1J1K1L1M1N1O1P1Q1R1S1T1U1V1W1X1Y1Z1a1b1c1d1e1f"
+    "1g1h1i1j1k1l1m1n1o1p1q1r1s1t1u1v1w1x1y1z101112131415161718191+1/"
+    "2A2B2C2D2E2F2G2H2I2J2K2L2M2N2O2P2Q2R2S2T2U2V2W2X2Y2Z2a2b2c2d2e2f"
+    "2g2h2i2j2k2l2m2n2o2p2q2r2s2t2u2v2w2x2y2z202122232425262728292+2/"
+    "3A3B3C3D3E3F3G3H3I3J3K3L3M3N3O3P3Q3R3S3T3U3V3W3X3Y3Z3a3b3c3d3e3f"
+    "3g3h3i3j3k3l3m3n3o3p3q3r3s3t3u3v3w3x3y3z303132333435363738393+3/"
+    "4A4B4C4D4E4F4G4H4I4J4K4L4M4N4O4P4Q4R4S4T4U4V4W4X4Y4Z4a4b4c4d4e4f"
+    "4g4h4i4j4k4l4m4n4o4p4q4r4s4t4u4v4w4x4y4z404142434445464748494+4/"
+    "5A5B5C5D5E5F5G5H5I5J5K5L5M5N5O5P5Q5R5S5T5U5V5W5X5Y5Z5a5b5c5d5e5f"
+    "5g5h5i5j5k5l5m5n5o5p5q5r5s5t5u5v5w5x5y5z505152535455565758595+5/"
+    "6A6B6C6D6E6F6G6H6I6J6K6L6M6N6O6P6Q6R6S6T6U6V6W6X6Y6Z6a6b6c6d6e6f"
+    "6g6h6i6j6k6l6m6n6o6p6q6r6s6t6u6v6w6x6y6z606162636465666768696+6/"
+    "7A7B7C7D7E7F7G7H7I7J7K7L7M7N7O7P7Q7R7S7T7U7V7W7X7Y7Z7a7b7c7d7e7f"
+    "7g7h7i7j7k7l7m7n7o7p7q7r7s7t7u7v7w7x7y7z707172737475767778797+7/"
+    "8A8B8C8D8E8F8G8H8I8J8K8L8M8N8O8P8Q8R8S8T8U8V8W8X8Y8Z8a8b8c8d8e8f"
+    "8g8h8i8j8k8l8m8n8o8p8q8r8s8t8u8v8w8x8y8z808182838485868788898+8/"
+    "9A9B9C9D9E9F9G9H9I9J9K9L9M9N9O9P9Q9R9S9T9U9V9W9X9Y9Z9a9b9c9d9e9f"
+    "9g9h9i9j9k9l9m9n9o9p9q9r9s9t9u9v9w9x9y9z909192939495969798999+9/"
+    "+A+B+C+D+E+F+G+H+I+J+K+L+M+N+O+P+Q+R+S+T+U+V+W+X+Y+Z+a+b+c+d+e+f"
+    "+g+h+i+j+k+l+m+n+o+p+q+r+s+t+u+v+w+x+y+z+0+1+2+3+4+5+6+7+8+9+++/"
+    "/A/B/C/D/E/F/G/H/I/J/K/L/M/N/O/P/Q/R/S/T/U/V/W/X/Y/Z/a/b/c/d/e/f"
+    "/g/h/i/j/k/l/m/n/o/p/q/r/s/t/u/v/w/x/y/z/0/1/2/3/4/5/6/7/8/9/+//";
+
+#endif
+
+/* Index of each character, 0xff for invalid characters. The padding
+   character '=' is decoded as zero. */
+static FAR const uint8_t decode_table[256] = {
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0x3e, 0xff, 0xff, 0xff, 0x3f,
+    0x34, 0x35, 0x36, 0x37, 0x38, 0x39, 0x3a, 0x3b, 0x3c, 0x3d, 0xff, 0xff,
+    0xff, 0x00, 0xff, 0xff, 0xff, 0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06,
+    0x07, 0x08, 0x09, 0x0a, 0x0b, 0x0c, 0x0d, 0x0e, 0x0f, 0x10, 0x11, 0x12,
+    0x13, 0x14, 0x15, 0x16, 0x17, 0x18, 0x19, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0x1a, 0x1b, 0x1c, 0x1d, 0x1e, 0x1f, 0x20, 0x21, 0x22, 0x23, 0x24,
+    0x25, 0x26, 0x27, 0x28, 0x29, 0x2a, 0x2b, 0x2c, 0x2d, 0x2e, 0x2f, 0x30,
+    0x31, 0x32, 0x33, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff,
+};
+
 /**
- * Index must be a number 0-64.
+ * Encode three bytes to four characters.
  */
-static char index_to_encoded(int index)
+static void encode_group(char *dst_p, const uint8_t *src_p)
 {
-    if ((index >= 0) && (index <= 25)) {
-        return ('A' + index - 0);
-    } else if ((index >= 26) && (index <= 51)) {
-        return ('a' + index - 26);
-    } else if ((index >= 52) && (index <= 61)) {
-        return ('0' + index - 52);
-    } else if (index == 62) {
-        return ('+');
-    } else if (index == 63) {
-        return ('/');
+    uint32_t value;
+
+    value = (((uint32_t)src_p[0] << 16)
+             | ((uint32_t)src_p[1] << 8)
+             | src_p[2]);
+
+#if CONFIG_BASE64_ENCODE_TABLE_16 == 1
+    dst_p[0] = encode_table[2 * (value >> 12)];
+    dst_p[1] = encode_table[2 * (value >> 12) + 1];
+    dst_p[2] = encode_table[2 * (value & 0xfff)];
+    dst_p[3] = encode_table[2 * (value & 0xfff) + 1];
+#else
+    dst_p[0] = alphabet[value >> 18];
+    dst_p[1] = alphabet[(value >> 12) & 0x3f];
+    dst_p[2] = alphabet[(value >> 6) & 0x3f];
+    dst_p[3] = alphabet[value & 0x3f];
+#endif
+}
+
+/**
+ * Encode the last one or two bytes to four characters, including
+ * padding.
+ */
+static void encode_tail(char *dst_p, const uint8_t *src_p, size_t size)
+{
+    uint32_t value;
+
+    value = ((uint32_t)src_p[0] << 16);
+
+    if (size == 2) {
+        value |= ((uint32_t)src_p[1] << 8);
+    }
+
+    dst_p[0] = alphabet[value >> 18];
+    dst_p[1] = alphabet[(value >> 12) & 0x3f];
+
+    if (size == 2) {
+        dst_p[2] = alphabet[(value >> 6) & 0x3f];
     } else {
-        return ('=');
+        dst_p[2] = '=';
     }
+
+    dst_p[3] = '=';
 }
 
-static int encoded_to_index(char encoded)
+/**
+ * Decode four characters to three bytes.
+ *
+ * @return zero(0) or -1 if any character is invalid.
+ */
+static int decode_group(uint8_t *dst_p, const char *src_p)
 {
-    if ((encoded >= 'A') && (encoded <= 'Z')) {
-        return (0 + encoded - 'A');
-    } else if ((encoded >= 'a') && (encoded <= 'z')) {
-        return (26 + encoded - 'a');
-    } else if ((encoded >= '0') && (encoded <= '9')) {
-        return (52 + encoded - '0');
-    } else if (encoded == '+') {
-        return (62);
-    } else if (encoded == '/') {
-        return (63);
-    } else if (encoded == '=') {
-        return (0);
+    uint8_t index[4];
+    uint32_t value;
+
+    index[0] = decode_table[(uint8_t)src_p[0]];
+    index[1] = decode_table[(uint8_t)src_p[1]];
+    index[2] = decode_table[(uint8_t)src_p[2]];
+    index[3] = decode_table[(uint8_t)src_p[3]];
+
+    /* One check for all four characters. */
+    if (((index[0] | index[1] | index[2] | index[3]) & 0x80) != 0) {
+        return (-1);
     }
 
-    return (-1);
+    value = (((uint32_t)index[0] << 18)
+             | ((uint32_t)index[1] << 12)
+             | ((uint32_t)index[2] << 6)
+             | index[3]);
+
+    dst_p[0] = (value >> 16);
+    dst_p[1] = (value >> 8);
+    dst_p[2] = value;
+
+    return (0);
 }
 
 int base64_encode(char *dst_p, const void *src_p, size_t size)
@@ -72,35 +280,19 @@ int base64_encode(char *dst_p, const void *src_p, size_t size)
     ASSERTN(dst_p != NULL, EINVAL);
     ASSERTN(src_p != NULL, EINVAL);
 
-    int i;
-    int j;
-    int index;
-    const uint8_t *s_p = src_p;
-
-    for (i = 0, j = 0; i < size; i += 3, j += 4) {
-        index = ((s_p[i + 0] & 0xfc) >> 2);
-        dst_p[j + 0] = index_to_encoded(index);
-        index = ((s_p[i + 0] & 0x03) << 4);
-
-        if (i + 1 < size) {
-            index |= ((s_p[i + 1] & 0xf0) >> 4);
-            dst_p[j + 1] = index_to_encoded(index);
-            index = (s_p[i + 1] & 0x0f) << 2;
-            
-            if (i + 2 < size) {
-                index |= ((s_p[i + 2] & 0xc0) >> 6);
-                dst_p[j + 2] = index_to_encoded(index);
-                index = (s_p[i + 2] & 0x3f);
-                dst_p[j + 3] = index_to_encoded(index);
-            } else {
-                dst_p[j + 2] = index_to_encoded(index);
-                dst_p[j + 3] = index_to_encoded(64);
-            }
-        } else {
-            dst_p[j + 1] = index_to_encoded(index);
-            dst_p[j + 2] = index_to_encoded(64);
-            dst_p[j + 3] = index_to_encoded(64);
-        }
+    const uint8_t *s_p;
+
+    s_p = src_p;
+
+    while (size >= 3) {
+        encode_group(dst_p, s_p);
+        dst_p += 4;
+        s_p += 3;
+        size -= 3;
+    }
+
+    if (size > 0) {
+        encode_tail(dst_p, s_p, size);
     }
 
     return (0);
@@ -111,32 +303,202 @@ int base64_decode(void *dst_p, const char *src_p, size_t size)
     ASSERTN(dst_p != NULL, EINVAL);
     ASSERTN(src_p != NULL, EINVAL);
 
-    int i;
-    int j;
-    int index[4];
-    uint8_t *d_p = dst_p;
-    
+    uint8_t *d_p;
+
     if ((size % 4) != 0) {
         return (-EINVAL);
     }
 
-    for (i = 0, j = 0; i < size; i += 4, j += 3) {
-        index[0] = encoded_to_index(src_p[i + 0]);
-        index[1] = encoded_to_index(src_p[i + 1]);
-        index[2] = encoded_to_index(src_p[i + 2]);
-        index[3] = encoded_to_index(src_p[i + 3]);
+    d_p = dst_p;
 
-        if ((index[0] == -1)
-            || (index[1] == -1)
-            || (index[2] == -1)
-            || (index[3] == -1)) {
+    while (size > 0) {
+        if (decode_group(d_p, src_p) != 0) {
             return (-1);
         }
 
-        d_p[j] = ((index[0] << 2) | (index[1] >> 4));
-        d_p[j + 1] = ((index[1] << 4) | (index[2] >> 2));
-        d_p[j + 2] = ((index[2] << 6) | index[3]);
+        d_p += 3;
+        src_p += 4;
+        size -= 4;
+    }
+
+    return (0);
+}
+
+int base64_encoder_init(struct base64_encoder_t *self_p, void *chan_p)
+{
+    ASSERTN(self_p != NULL, EINVAL);
+    ASSERTN(chan_p != NULL, EINVAL);
+
+    self_p->chan_p = chan_p;
+    self_p->size = 0;
+
+    return (0);
+}
+
+ssize_t base64_encoder_write(struct base64_encoder_t *self_p,
+                             const void *buf_p,
+                             size_t size)
+{
+    ASSERTN(self_p != NULL, EINVAL);
+    ASSERTN(buf_p != NULL, EINVAL);
+
+    char encoded[64];
+    const uint8_t *u8_buf_p;
+    size_t left;
+    size_t encoded_size;
+
+    u8_buf_p = buf_p;
+    left = size;
+    encoded_size = 0;
+
+    /* Complete a group with data from previous writes. */
+    while ((self_p->size > 0) && (left > 0)) {
+        self_p->buf[self_p->size] = *u8_buf_p++;
+        self_p->size++;
+        left--;
+
+        if (self_p->size == 3) {
+            encode_group(&encoded[0], &self_p->buf[0]);
+            encoded_size = 4;
+            self_p->size = 0;
+        }
     }
-    
+
+    while (left >= 3) {
+        encode_group(&encoded[encoded_size], u8_buf_p);
+        encoded_size += 4;
+        u8_buf_p += 3;
+        left -= 3;
+
+        if (encoded_size == sizeof(encoded)) {
+            if (chan_write(self_p->chan_p,
+                           &encoded[0],
+                           encoded_size) != encoded_size) {
+                return (-EIO);
+            }
+
+            encoded_size = 0;
+        }
+    }
+
+    if (encoded_size > 0) {
+        if (chan_write(self_p->chan_p,
+                       &encoded[0],
+                       encoded_size) != encoded_size) {
+            return (-EIO);
+        }
+    }
+
+    /* Save the remaining bytes for the next write. */
+    while (left > 0) {
+        self_p->buf[self_p->size] = *u8_buf_p++;
+        self_p->size++;
+        left--;
+    }
+
+    return (size);
+}
+
+int base64_encoder_flush(struct base64_encoder_t *self_p)
+{
+    ASSERTN(self_p != NULL, EINVAL);
+
+    char encoded[4];
+
+    if (self_p->size == 0) {
+        return (0);
+    }
+
+    encode_tail(&encoded[0], &self_p->buf[0], self_p->size);
+    self_p->size = 0;
+
+    if (chan_write(self_p->chan_p,
+                   &encoded[0],
+                   sizeof(encoded)) != sizeof(encoded)) {
+        return (-EIO);
+    }
+
+    return (0);
+}
+
+int base64_decoder_init(struct base64_decoder_t *self_p, void *chan_p)
+{
+    ASSERTN(self_p != NULL, EINVAL);
+    ASSERTN(chan_p != NULL, EINVAL);
+
+    self_p->chan_p = chan_p;
+    self_p->size = 0;
+
+    return (0);
+}
+
+ssize_t base64_decoder_write(struct base64_decoder_t *self_p,
+                             const char *buf_p,
+                             size_t size)
+{
+    ASSERTN(self_p != NULL, EINVAL);
+    ASSERTN(buf_p != NULL, EINVAL);
+
+    uint8_t decoded[48];
+    size_t decoded_size;
+    size_t i;
+
+    decoded_size = 0;
+
+    for (i = 0; i < size; i++) {
+        self_p->buf[self_p->size] = buf_p[i];
+        self_p->size++;
+
+        if (self_p->size < 4) {
+            continue;
+        }
+
+        self_p->size = 0;
+
+        if (decode_group(&decoded[decoded_size], &self_p->buf[0]) != 0) {
+            return (-EINVAL);
+        }
+
+        /* Padding characters are not decoded. */
+        if (self_p->buf[2] == '=') {
+            decoded_size += 1;
+        } else if (self_p->buf[3] == '=') {
+            decoded_size += 2;
+        } else {
+            decoded_size += 3;
+        }
+
+        if (decoded_size > sizeof(decoded) - 3) {
+            if (chan_write(self_p->chan_p,
+                           &decoded[0],
+                           decoded_size) != decoded_size) {
+                return (-EIO);
+            }
+
+            decoded_size = 0;
+        }
+    }
+
+    if (decoded_size > 0) {
+        if (chan_write(self_p->chan_p,
+                       &decoded[0],
+                       decoded_size) != decoded_size) {
+            return (-EIO);
+        }
+    }
+
+    return (size);
+}
+
+int base64_decoder_flush(struct base64_decoder_t *self_p)
+{
+    ASSERTN(self_p != NULL, EINVAL);
+
+    if (self_p->size != 0) {
+        self_p->size = 0;
+
+        return (-EINVAL);
+    }
+
     return (0);
 }
@@ -31,6 +31,24 @@
 
 #include "simba.h"
 
+/**
+ * Encode data in chunks to a channel.
+ */
+struct base64_encoder_t {
+    void *chan_p;
+    uint8_t buf[3];
+    size_t size;
+};
+
+/**
+ * Decode data in chunks to a channel.
+ */
+struct base64_decoder_t {
+    void *chan_p;
+    char buf[4];
+    size_t size;
+};
+
 /**
  * Encode given buffer. The encoded data will be ~33.3% larger than
  * the source data. Choose the destination buffer size accordingly.
@@ -56,4 +74,75 @@ int base64_encode(char *dst_p, const void *src_p, size_t size);
  */
 int base64_decode(void *dst_p, const char *src_p, size_t size);
 
+/**
+ * Initialize given encoder object. Encoded data will be written to
+ * given channel.
+ *
+ * @param[out] self_p Encoder object to initialize.
+ * @param[in] chan_p Output channel.
+ *
+ * @return zero(0) or negative error code.
+ */
+int base64_encoder_init(struct base64_encoder_t *self_p, void *chan_p);
+
+/**
+ * Encode given chunk of data and write it to the output channel. Up
+ * to two bytes are kept in the encoder until next write or flush.
+ *
+ * @param[in] self_p Initialized encoder object.
+ * @param[in] buf_p Input data.
+ * @param[in] size Number of bytes in the input data.
+ *
+ * @return Number of input bytes or negative error code.
+ */
+ssize_t base64_encoder_write(struct base64_encoder_t *self_p,
+                             const void *buf_p,
+                             size_t size);
+
+/**
+ * Encode remaining input data, if any, with padding and write it to
+ * the output channel. Call when all input data has been written.
+ *
+ * @param[in] self_p Initialized encoder object.
+ *
+ * @return zero(0) or negative error code.
+ */
+int base64_encoder_flush(struct base64_encoder_t *self_p);
+
+/**
+ * Initialize given decoder object. Decoded data will be written to
+ * given channel.
+ *
+ * @param[out] self_p Decoder object to initialize.
+ * @param[in] chan_p Output channel.
+ *
+ * @return zero(0) or negative error code.
+ */
+int base64_decoder_init(struct base64_decoder_t *self_p, void *chan_p);
+
+/**
+ * Decode given chunk of base64 encoded data and write it to the
+ * output channel. Unlike `base64_decode()`, padding characters are
+ * not decoded.
+ *
+ * @param[in] self_p Initialized decoder object.
+ * @param[in] buf_p Encoded input data.
+ * @param[in] size Number of bytes in the encoded input data.
+ *
+ * @return Number of input bytes or negative error code.
+ */
+ssize_t base64_decoder_write(struct base64_decoder_t *self_p,
+                             const char *buf_p,
+                             size_t size);
+
+/**
+ * Check that all written encoded data has been decoded.
+ *
+ * @param[in] self_p Initialized decoder object.
+ *
+ * @return zero(0) or -EINVAL if the encoded data size is not a
+ *         multiple of four.
+ */
+int base64_decoder_flush(struct base64_decoder_t *self_p);
+
 #endif
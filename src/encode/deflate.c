@@ -0,0 +1,1004 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2014-2018, Erik Moqvist
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use, copy,
+ * modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ * This file is part of the Simba project.
+ */
+
+#include "simba.h"
+
+#define LENGTH_MIN                                          3
+#define LENGTH_MAX                                        258
+
+/* Block types. */
+#define BLOCK_TYPE_STORED                                   0
+#define BLOCK_TYPE_FIXED                                    1
+#define BLOCK_TYPE_DYNAMIC                                  2
+
+/* Decoder states. */
+#define STATE_HEADER                                        0
+#define STATE_STORED                                        1
+#define STATE_HUFFMAN                                       2
+#define STATE_MATCH                                         3
+#define STATE_END                                           4
+
+/* Base lengths and number of extra bits of length symbols 257 to
+   285. */
+static FAR const uint16_t length_bases[29] = {
+    3, 4, 5, 6, 7, 8, 9, 10, 11, 13, 15, 17, 19, 23, 27, 31,
+    35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258
+};
+
+static FAR const uint8_t length_extra_bits[29] = {
+    0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2,
+    3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0
+};
+
+/* Base distances and number of extra bits of distance symbols 0 to
+   29. */
+static FAR const uint16_t distance_bases[30] = {
+    1, 2, 3, 4, 5, 7, 9, 13, 17, 25, 33, 49, 65, 97, 129, 193,
+    257, 385, 513, 769, 1025, 1537, 2049, 3073, 4097, 6145,
+    8193, 12289, 16385, 24577
+};
+
+static FAR const uint8_t distance_extra_bits[30] = {
+    0, 0, 0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6, 6,
+    7, 7, 8, 8, 9, 9, 10, 10, 11, 11, 12, 12, 13, 13
+};
+
+/* Order of the code length code lengths in a dynamic block
+   header. */
+static FAR const uint8_t code_length_order[19] = {
+    16, 17, 18, 0, 8, 7, 9, 6, 10, 5, 11, 4, 12, 3, 13, 2, 14, 1, 15
+};
+
+static void encoder_output_flush(struct deflate_encoder_t *self_p)
+{
+    if (self_p->output.size == 0) {
+        return;
+    }
+
+    if (chan_write(self_p->chan_p,
+                   &self_p->output.buf[0],
+                   self_p->output.size) != self_p->output.size) {
+        self_p->output.res = -EIO;
+    }
+
+    self_p->output.size = 0;
+}
+
+/**
+ * Write given number of bits, least significant bit first.
+ */
+static void encoder_put_bits(struct deflate_encoder_t *self_p,
+                             uint32_t value,
+                             int length)
+{
+    self_p->bits.value |= (value << self_p->bits.length);
+    self_p->bits.length += length;
+
+    while (self_p->bits.length >= 8) {
+        self_p->output.buf[self_p->output.size++] = self_p->bits.value;
+        self_p->bits.value >>= 8;
+        self_p->bits.length -= 8;
+
+        if (self_p->output.size == sizeof(self_p->output.buf)) {
+            encoder_output_flush(self_p);
+        }
+    }
+}
+
+/**
+ * Write given Huffman code, most significant bit first.
+ */
+static void encoder_put_code(struct deflate_encoder_t *self_p,
+                             uint32_t code,
+                             int length)
+{
+    uint32_t reversed;
+    int i;
+
+    reversed = 0;
+
+    for (i = 0; i < length; i++) {
+        reversed = ((reversed << 1) | (code & 1));
+        code >>= 1;
+    }
+
+    encoder_put_bits(self_p, reversed, length);
+}
+
+/**
+ * Write given literal/length symbol with its fixed Huffman code.
+ */
+static void encoder_put_symbol(struct deflate_encoder_t *self_p,
+                               int symbol)
+{
+    if (symbol < 144) {
+        encoder_put_code(self_p, 0x30 + symbol, 8);
+    } else if (symbol < 256) {
+        encoder_put_code(self_p, 0x190 + symbol - 144, 9);
+    } else if (symbol < 280) {
+        encoder_put_code(self_p, symbol - 256, 7);
+    } else {
+        encoder_put_code(self_p, 0xc0 + symbol - 280, 8);
+    }
+}
+
+static void encoder_put_match(struct deflate_encoder_t *self_p,
+                              size_t length,
+                              size_t distance)
+{
+    int i;
+
+    i = (membersof(length_bases) - 1);
+
+    while (length_bases[i] > length) {
+        i--;
+    }
+
+    encoder_put_symbol(self_p, 257 + i);
+    encoder_put_bits(self_p,
+                     length - length_bases[i],
+                     length_extra_bits[i]);
+
+    i = (membersof(distance_bases) - 1);
+
+    while (distance_bases[i] > distance) {
+        i--;
+    }
+
+    encoder_put_code(self_p, i, 5);
+    encoder_put_bits(self_p,
+                     distance - distance_bases[i],
+                     distance_extra_bits[i]);
+}
+
+static int encoder_hash(const uint8_t *buf_p)
+{
+    uint32_t value;
+
+    value = (((uint32_t)buf_p[0] << 16)
+             | ((uint32_t)buf_p[1] << 8)
+             | buf_p[2]);
+
+    value *= 2654435761UL;
+
+    return (value >> (32 - CONFIG_DEFLATE_ENCODER_HASH_BITS));
+}
+
+/**
+ * Get the byte at given offset from the start of the written buffer,
+ * which is in the window if negative.
+ */
+static uint8_t encoder_byte(struct deflate_encoder_t *self_p,
+                            const uint8_t *buf_p,
+                            long offset)
+{
+    if (offset >= 0) {
+        return (buf_p[offset]);
+    }
+
+    return (self_p->window.buf_p[(self_p->pos + offset)
+                                 & (self_p->window.size - 1)]);
+}
+
+/**
+ * Get the length of the match at given distance from given position
+ * in the written buffer.
+ */
+static size_t encoder_match_length(struct deflate_encoder_t *self_p,
+                                   const uint8_t *buf_p,
+                                   size_t pos,
+                                   size_t distance,
+                                   size_t length_max)
+{
+    size_t length;
+    long offset;
+
+    length = 0;
+
+    if (distance <= pos) {
+        while ((length < length_max)
+               && (buf_p[pos - distance + length] == buf_p[pos + length])) {
+            length++;
+        }
+    } else {
+        offset = ((long)pos - (long)distance);
+
+        while ((length < length_max)
+               && (encoder_byte(self_p, buf_p, offset + length)
+                   == buf_p[pos + length])) {
+            length++;
+        }
+    }
+
+    return (length);
+}
+
+/**
+ * Save given data in the window.
+ */
+static void encoder_window_write(struct deflate_encoder_t *self_p,
+                                 const uint8_t *buf_p,
+                                 size_t size)
+{
+    size_t index;
+    size_t n;
+
+    if (size > self_p->window.size) {
+        buf_p += (size - self_p->window.size);
+        size = self_p->window.size;
+    }
+
+    index = ((self_p->pos - size) & (self_p->window.size - 1));
+    n = MIN(size, self_p->window.size - index);
+    memcpy(&self_p->window.buf_p[index], buf_p, n);
+    memcpy(&self_p->window.buf_p[0], &buf_p[n], size - n);
+
+    self_p->window.length += size;
+
+    if (self_p->window.length > self_p->window.size) {
+        self_p->window.length = self_p->window.size;
+    }
+}
+
+int deflate_encoder_init(struct deflate_encoder_t *self_p,
+                         void *chan_p,
+                         int window_bits,
+                         void *window_p)
+{
+    ASSERTN(self_p != NULL, EINVAL);
+    ASSERTN(chan_p != NULL, EINVAL);
+    ASSERTN((window_bits >= 8) && (window_bits <= 15), EINVAL);
+
+    self_p->chan_p = chan_p;
+    self_p->distance_max = (1 << window_bits);
+    self_p->window.buf_p = window_p;
+    self_p->window.size = (1 << window_bits);
+    self_p->window.length = 0;
+    self_p->pos = 0;
+    memset(&self_p->hash[0], 0, sizeof(self_p->hash));
+    self_p->block_open = 0;
+    self_p->bits.value = 0;
+    self_p->bits.length = 0;
+    self_p->output.size = 0;
+    self_p->output.res = 0;
+
+    return (0);
+}
+
+ssize_t deflate_encoder_write(struct deflate_encoder_t *self_p,
+                              const void *buf_p,
+                              size_t size)
+{
+    ASSERTN(self_p != NULL, EINVAL);
+    ASSERTN((buf_p != NULL) || (size == 0), EINVAL);
+
+    const uint8_t *u8_buf_p;
+    size_t pos;
+    size_t history;
+    size_t distance;
+    size_t length;
+    size_t length_max;
+    size_t end;
+    int hash;
+    uint16_t pos16;
+
+    if (size == 0) {
+        return (0);
+    }
+
+    u8_buf_p = buf_p;
+
+    if (self_p->window.buf_p != NULL) {
+        history = self_p->window.length;
+    } else {
+        history = 0;
+    }
+
+    /* A block with fixed Huffman codes. */
+    if (self_p->block_open == 0) {
+        encoder_put_bits(self_p, BLOCK_TYPE_FIXED << 1, 3);
+        self_p->block_open = 1;
+    }
+
+    pos = 0;
+
+    while (pos < size) {
+        length = 0;
+
+        if (pos + LENGTH_MIN <= size) {
+            hash = encoder_hash(&u8_buf_p[pos]);
+            pos16 = (self_p->pos + pos);
+            distance = (uint16_t)(pos16 - self_p->hash[hash]);
+            self_p->hash[hash] = pos16;
+
+            /* The hash table entry may be old, or belong to other
+               data with the same hash, but the match is verified. */
+            if ((distance > 0)
+                && (distance <= self_p->distance_max)
+                && (distance <= pos + history)) {
+                length_max = MIN(size - pos, LENGTH_MAX);
+                length = encoder_match_length(self_p,
+                                              u8_buf_p,
+                                              pos,
+                                              distance,
+                                              length_max);
+            }
+        }
+
+        if (length >= LENGTH_MIN) {
+            encoder_put_match(self_p, length, distance);
+            end = (pos + length);
+
+            /* Add the matched positions to the hash table. */
+            for (pos++; (pos < end) && (pos + LENGTH_MIN <= size); pos++) {
+                self_p->hash[encoder_hash(&u8_buf_p[pos])] = (self_p->pos + pos);
+            }
+
+            pos = end;
+        } else {
+            encoder_put_symbol(self_p, u8_buf_p[pos]);
+            pos++;
+        }
+    }
+
+    self_p->pos += size;
+
+    if (self_p->window.buf_p != NULL) {
+        encoder_window_write(self_p, u8_buf_p, size);
+    }
+
+    if (self_p->output.res != 0) {
+        self_p->output.res = 0;
+
+        return (-EIO);
+    }
+
+    return (size);
+}
+
+int deflate_encoder_flush(struct deflate_encoder_t *self_p)
+{
+    ASSERTN(self_p != NULL, EINVAL);
+
+    int res;
+
+    /* End of block. */
+    if (self_p->block_open == 1) {
+        encoder_put_symbol(self_p, 256);
+        self_p->block_open = 0;
+    }
+
+    /* Header of an empty stored block, padded to a byte
+       boundary. */
+    encoder_put_bits(self_p, BLOCK_TYPE_STORED << 1, 3);
+
+    if (self_p->bits.length > 0) {
+        encoder_put_bits(self_p, 0, 8 - self_p->bits.length);
+    }
+
+    encoder_output_flush(self_p);
+    res = self_p->output.res;
+    self_p->output.res = 0;
+
+    return (res);
+}
+
+static void decoder_reset(struct deflate_decoder_t *self_p)
+{
+    self_p->state = STATE_HEADER;
+    self_p->final = 0;
+    self_p->input.pos = 0;
+    self_p->input.size = 0;
+    self_p->bits.value = 0;
+    self_p->bits.length = 0;
+}
+
+/**
+ * Get the next input byte.
+ *
+ * @return The byte, or -1 at the end of the input.
+ */
+static int decoder_get_byte(struct deflate_decoder_t *self_p)
+{
+    ssize_t res;
+
+    if (self_p->input.pos == self_p->input.size) {
+        res = chan_read(self_p->chan_p,
+                        &self_p->input.buf[0],
+                        sizeof(self_p->input.buf));
+
+        if (res <= 0) {
+            return (-1);
+        }
+
+        self_p->input.pos = 0;
+        self_p->input.size = res;
+    }
+
+    return (self_p->input.buf[self_p->input.pos++]);
+}
+
+/**
+ * Get given number of bits, at most 15, least significant bit first.
+ */
+static int decoder_get_bits(struct deflate_decoder_t *self_p, int length)
+{
+    int value;
+    int byte;
+
+    while (self_p->bits.length < length) {
+        byte = decoder_get_byte(self_p);
+
+        if (byte < 0) {
+            return (-EPROTO);
+        }
+
+        self_p->bits.value |= ((uint32_t)byte << self_p->bits.length);
+        self_p->bits.length += 8;
+    }
+
+    value = (self_p->bits.value & ((1UL << length) - 1));
+    self_p->bits.value >>= length;
+    self_p->bits.length -= length;
+
+    return (value);
+}
+
+/**
+ * Create a canonical Huffman code table from given code lengths.
+ */
+static int decoder_build(uint16_t *counts_p,
+                         uint16_t *symbols_p,
+                         const uint8_t *lengths_p,
+                         int length)
+{
+    uint16_t offsets[16];
+    long left;
+    int i;
+
+    memset(counts_p, 0, 16 * sizeof(*counts_p));
+
+    for (i = 0; i < length; i++) {
+        counts_p[lengths_p[i]]++;
+    }
+
+    /* Over-subscribed codes are invalid. */
+    left = 1;
+
+    for (i = 1; i < 16; i++) {
+        left <<= 1;
+        left -= counts_p[i];
+
+        if (left < 0) {
+            return (-EPROTO);
+        }
+    }
+
+    offsets[1] = 0;
+
+    for (i = 1; i < 15; i++) {
+        offsets[i + 1] = (offsets[i] + counts_p[i]);
+    }
+
+    for (i = 0; i < length; i++) {
+        if (lengths_p[i] != 0) {
+            symbols_p[offsets[lengths_p[i]]++] = i;
+        }
+    }
+
+    return (0);
+}
+
+/**
+ * Decode a symbol with given Huffman code table, one bit at a time.
+ */
+static int decoder_decode(struct deflate_decoder_t *self_p,
+                          const uint16_t *counts_p,
+                          const uint16_t *symbols_p)
+{
+    long code;
+    long first;
+    int index;
+    int bit;
+    int i;
+
+    code = 0;
+    first = 0;
+    index = 0;
+
+    for (i = 1; i < 16; i++) {
+        bit = decoder_get_bits(self_p, 1);
+
+        if (bit < 0) {
+            return (bit);
+        }
+
+        code |= bit;
+
+        if (code - first < counts_p[i]) {
+            return (symbols_p[index + (code - first)]);
+        }
+
+        index += counts_p[i];
+        first += counts_p[i];
+        first <<= 1;
+        code <<= 1;
+    }
+
+    return (-EPROTO);
+}
+
+static int decoder_read_stored_header(struct deflate_decoder_t *self_p)
+{
+    int bytes[4];
+    int i;
+
+    /* Skip to the byte boundary. */
+    self_p->bits.value = 0;
+    self_p->bits.length = 0;
+
+    for (i = 0; i < 4; i++) {
+        bytes[i] = decoder_get_byte(self_p);
+
+        if (bytes[i] < 0) {
+            return (-EPROTO);
+        }
+    }
+
+    /* Length and its one's complement. */
+    if (((bytes[0] ^ bytes[2]) != 0xff) || ((bytes[1] ^ bytes[3]) != 0xff)) {
+        return (-EPROTO);
+    }
+
+    self_p->left = ((bytes[1] << 8) | bytes[0]);
+
+    return (0);
+}
+
+static int decoder_build_fixed(struct deflate_decoder_t *self_p)
+{
+    uint8_t lengths[288];
+
+    memset(&lengths[0], 8, 144);
+    memset(&lengths[144], 9, 112);
+    memset(&lengths[256], 7, 24);
+    memset(&lengths[280], 8, 8);
+    (void)decoder_build(&self_p->literal.counts[0],
+                        &self_p->literal.symbols[0],
+                        &lengths[0],
+                        288);
+
+    memset(&lengths[0], 5, 30);
+    (void)decoder_build(&self_p->distance_code.counts[0],
+                        &self_p->distance_code.symbols[0],
+                        &lengths[0],
+                        30);
+
+    return (0);
+}
+
+/**
+ * Read the Huffman code tables of a dynamic block.
+ */
+static int decoder_read_dynamic(struct deflate_decoder_t *self_p)
+{
+    uint8_t lengths[286 + 30];
+    uint16_t counts[16];
+    uint16_t symbols[19];
+    int literals;
+    int distances;
+    int codes;
+    int index;
+    int symbol;
+    int length;
+    int repeat;
+    int res;
+    int i;
+
+    literals = decoder_get_bits(self_p, 5);
+    distances = decoder_get_bits(self_p, 5);
+    codes = decoder_get_bits(self_p, 4);
+
+    if ((literals < 0) || (distances < 0) || (codes < 0)) {
+        return (-EPROTO);
+    }
+
+    literals += 257;
+    distances += 1;
+    codes += 4;
+
+    if ((literals > 286) || (distances > 30)) {
+        return (-EPROTO);
+    }
+
+    /* The code length code. */
+    memset(&lengths[0], 0, 19);
+
+    for (i = 0; i < codes; i++) {
+        res = decoder_get_bits(self_p, 3);
+
+        if (res < 0) {
+            return (res);
+        }
+
+        lengths[code_length_order[i]] = res;
+    }
+
+    res = decoder_build(&counts[0], &symbols[0], &lengths[0], 19);
+
+    if (res != 0) {
+        return (res);
+    }
+
+    /* Literal/length and distance code lengths. */
+    index = 0;
+
+    while (index < literals + distances) {
+        symbol = decoder_decode(self_p, &counts[0], &symbols[0]);
+
+        if (symbol < 0) {
+            return (symbol);
+        }
+
+        if (symbol < 16) {
+            lengths[index++] = symbol;
+            continue;
+        }
+
+        length = 0;
+
+        if (symbol == 16) {
+            if (index == 0) {
+                return (-EPROTO);
+            }
+
+            length = lengths[index - 1];
+            res = decoder_get_bits(self_p, 2);
+            repeat = (3 + res);
+        } else if (symbol == 17) {
+            res = decoder_get_bits(self_p, 3);
+            repeat = (3 + res);
+        } else {
+            res = decoder_get_bits(self_p, 7);
+            repeat = (11 + res);
+        }
+
+        if ((res < 0) || (index + repeat > literals + distances)) {
+            return (-EPROTO);
+        }
+
+        while (repeat > 0) {
+            lengths[index++] = length;
+            repeat--;
+        }
+    }
+
+    /* The end of block code is required. */
+    if (lengths[256] == 0) {
+        return (-EPROTO);
+    }
+
+    res = decoder_build(&self_p->literal.counts[0],
+                        &self_p->literal.symbols[0],
+                        &lengths[0],
+                        literals);
+
+    if (res != 0) {
+        return (res);
+    }
+
+    return (decoder_build(&self_p->distance_code.counts[0],
+                          &self_p->distance_code.symbols[0],
+                          &lengths[literals],
+                          distances));
+}
+
+static int decoder_read_header(struct deflate_decoder_t *self_p)
+{
+    int res;
+
+    res = decoder_get_bits(self_p, 3);
+
+    if (res < 0) {
+        return (res);
+    }
+
+    self_p->final = (res & 1);
+
+    switch (res >> 1) {
+
+    case BLOCK_TYPE_STORED:
+        self_p->state = STATE_STORED;
+
+        return (decoder_read_stored_header(self_p));
+
+    case BLOCK_TYPE_FIXED:
+        self_p->state = STATE_HUFFMAN;
+
+        return (decoder_build_fixed(self_p));
+
+    case BLOCK_TYPE_DYNAMIC:
+        self_p->state = STATE_HUFFMAN;
+
+        return (decoder_read_dynamic(self_p));
+
+    default:
+        return (-EPROTO);
+    }
+}
+
+/**
+ * Read a literal, the end of the block, or a length and a distance.
+ *
+ * @return The literal, 256 if there is no literal, or negative error
+ *         code.
+ */
+static int decoder_read_symbol(struct deflate_decoder_t *self_p,
+                               size_t pos)
+{
+    int symbol;
+    int res;
+
+    symbol = decoder_decode(self_p,
+                            &self_p->literal.counts[0],
+                            &self_p->literal.symbols[0]);
+
+    if (symbol < 256) {
+        return (symbol);
+    }
+
+    if (symbol == 256) {
+        self_p->state = STATE_HEADER;
+
+        return (256);
+    }
+
+    symbol -= 257;
+
+    if (symbol >= membersof(length_bases)) {
+        return (-EPROTO);
+    }
+
+    res = decoder_get_bits(self_p, length_extra_bits[symbol]);
+
+    if (res < 0) {
+        return (res);
+    }
+
+    self_p->left = (length_bases[symbol] + res);
+
+    symbol = decoder_decode(self_p,
+                            &self_p->distance_code.counts[0],
+                            &self_p->distance_code.symbols[0]);
+
+    if (symbol < 0) {
+        return (symbol);
+    }
+
+    if (symbol >= membersof(distance_bases)) {
+        return (-EPROTO);
+    }
+
+    res = decoder_get_bits(self_p, distance_extra_bits[symbol]);
+
+    if (res < 0) {
+        return (res);
+    }
+
+    self_p->distance = (distance_bases[symbol] + res);
+
+    /* The distance must not reach beyond the decompressed data. */
+    if (self_p->window.buf_p != NULL) {
+        if (self_p->distance > self_p->window.length) {
+            return (-EPROTO);
+        }
+    } else if (self_p->distance > pos) {
+        return (-EPROTO);
+    }
+
+    self_p->state = STATE_MATCH;
+
+    return (256);
+}
+
+/**
+ * Output given decompressed byte, and save it in the window if there
+ * is one.
+ */
+static void decoder_put(struct deflate_decoder_t *self_p,
+                        uint8_t *buf_p,
+                        size_t size,
+                        size_t *pos_p,
+                        uint8_t byte)
+{
+    if (self_p->window.buf_p != NULL) {
+        self_p->window.buf_p[self_p->window.pos] = byte;
+        self_p->window.pos++;
+        self_p->window.pos &= (self_p->window.size - 1);
+
+        if (self_p->window.length < self_p->window.size) {
+            self_p->window.length++;
+        }
+    }
+
+    if (*pos_p < size) {
+        buf_p[*pos_p] = byte;
+    }
+
+    (*pos_p)++;
+}
+
+int deflate_decoder_init(struct deflate_decoder_t *self_p,
+                         void *chan_p,
+                         int window_bits,
+                         void *window_p)
+{
+    ASSERTN(self_p != NULL, EINVAL);
+    ASSERTN(chan_p != NULL, EINVAL);
+    ASSERTN((window_bits >= 8) && (window_bits <= 15), EINVAL);
+
+    self_p->chan_p = chan_p;
+    self_p->window.buf_p = window_p;
+    self_p->window.size = (1 << window_bits);
+    self_p->window.pos = 0;
+    self_p->window.length = 0;
+    decoder_reset(self_p);
+
+    return (0);
+}
+
+ssize_t deflate_decoder_read(struct deflate_decoder_t *self_p,
+                             void *buf_p,
+                             size_t size)
+{
+    ASSERTN(self_p != NULL, EINVAL);
+    ASSERTN(buf_p != NULL, EINVAL);
+    ASSERTN(size > 0, EINVAL);
+
+    uint8_t *u8_buf_p;
+    size_t pos;
+    int full;
+    int res;
+
+    if (self_p->state == STATE_END) {
+        decoder_reset(self_p);
+
+        return (0);
+    }
+
+    u8_buf_p = buf_p;
+    pos = 0;
+
+    while (1) {
+        /* Data read in chunks is kept in the window. */
+        full = ((self_p->window.buf_p != NULL) && (pos == size));
+
+        switch (self_p->state) {
+
+        case STATE_HEADER:
+            if (self_p->final == 1) {
+                goto out;
+            }
+
+            /* The input may end at a block boundary. */
+            if (self_p->bits.length == 0) {
+                res = decoder_get_byte(self_p);
+
+                if (res < 0) {
+                    goto out;
+                }
+
+                self_p->bits.value = res;
+                self_p->bits.length = 8;
+            }
+
+            res = decoder_read_header(self_p);
+
+            if (res != 0) {
+                return (res);
+            }
+
+            break;
+
+        case STATE_STORED:
+            if (self_p->left == 0) {
+                self_p->state = STATE_HEADER;
+                break;
+            }
+
+            if (full) {
+                return (pos);
+            }
+
+            res = decoder_get_byte(self_p);
+
+            if (res < 0) {
+                return (-EPROTO);
+            }
+
+            decoder_put(self_p, u8_buf_p, size, &pos, res);
+            self_p->left--;
+            break;
+
+        case STATE_HUFFMAN:
+            if (full) {
+                return (pos);
+            }
+
+            res = decoder_read_symbol(self_p, pos);
+
+            if (res < 0) {
+                return (res);
+            } else if (res < 256) {
+                decoder_put(self_p, u8_buf_p, size, &pos, res);
+            }
+
+            break;
+
+        case STATE_MATCH:
+            if (self_p->left == 0) {
+                self_p->state = STATE_HUFFMAN;
+                break;
+            }
+
+            if (full) {
+                return (pos);
+            }
+
+            if (self_p->window.buf_p != NULL) {
+                res = self_p->window.buf_p[(self_p->window.pos
+                                            - self_p->distance)
+                                           & (self_p->window.size - 1)];
+            } else if (pos < size) {
+                res = u8_buf_p[pos - self_p->distance];
+            } else {
+                /* Dropped data. */
+                res = 0;
+            }
+
+            decoder_put(self_p, u8_buf_p, size, &pos, res);
+            self_p->left--;
+            break;
+
+        default:
+            return (-EPROTO);
+        }
+    }
+
+ out:
+    /* End of the stream. */
+    if ((self_p->window.buf_p != NULL) && (pos > 0)) {
+        self_p->state = STATE_END;
+
+        return (pos);
+    }
+
+    decoder_reset(self_p);
+
+    return (MIN(pos, size));
+}
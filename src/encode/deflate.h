@@ -0,0 +1,201 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2014-2018, Erik Moqvist
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use, copy,
+ * modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ * This file is part of the Simba project.
+ */
+
+#ifndef __ENCODE_DEFLATE_H__
+#define __ENCODE_DEFLATE_H__
+
+#include "simba.h"
+
+/**
+ * Compress data in chunks to a channel.
+ */
+struct deflate_encoder_t {
+    void *chan_p;
+    /* Largest distance of a match. */
+    size_t distance_max;
+    /* Data written in earlier calls, or NULL if matches are only
+       searched for within each written buffer. */
+    struct {
+        uint8_t *buf_p;
+        size_t size;
+        size_t length;
+    } window;
+    /* Stream position of the next written byte. */
+    uint32_t pos;
+    /* Lower 16 bits of the stream position of the latest three bytes
+       with given hash. */
+    uint16_t hash[1 << CONFIG_DEFLATE_ENCODER_HASH_BITS];
+    int block_open;
+    struct {
+        uint32_t value;
+        int length;
+    } bits;
+    struct {
+        uint8_t buf[16];
+        size_t size;
+        int res;
+    } output;
+};
+
+/**
+ * Decompress data read from a channel.
+ */
+struct deflate_decoder_t {
+    void *chan_p;
+    /* Decompressed data of earlier calls, or NULL if each call
+       decompresses a whole stream. */
+    struct {
+        uint8_t *buf_p;
+        size_t size;
+        size_t pos;
+        size_t length;
+    } window;
+    int state;
+    int final;
+    size_t left;
+    size_t distance;
+    struct {
+        uint8_t buf[16];
+        size_t pos;
+        size_t size;
+    } input;
+    struct {
+        uint32_t value;
+        int length;
+    } bits;
+    struct {
+        uint16_t counts[16];
+        uint16_t symbols[288];
+    } literal;
+    struct {
+        uint16_t counts[16];
+        uint16_t symbols[30];
+    } distance_code;
+};
+
+/**
+ * Initialize given encoder object. Compressed data, raw deflate as
+ * specified in RFC 1951, will be written to given channel. Data is
+ * compressed with a hash table of recent three byte sequences and
+ * written in blocks with fixed Huffman codes, which is fast and uses
+ * little RAM, but compresses less than for example zlib.
+ *
+ * @param[out] self_p Encoder object to initialize.
+ * @param[in] chan_p Output channel.
+ * @param[in] window_bits Base two logarithm of the largest distance
+ *                        of a match, 8 to 15.
+ * @param[in] window_p Buffer of ``1 << window_bits`` bytes to keep
+ *                     previously written data in, so that later
+ *                     writes can refer to it, or NULL to only find
+ *                     matches within each written buffer.
+ *
+ * @return zero(0) or negative error code.
+ */
+int deflate_encoder_init(struct deflate_encoder_t *self_p,
+                         void *chan_p,
+                         int window_bits,
+                         void *window_p);
+
+/**
+ * Compress given chunk of data and write it to the output
+ * channel. Up to 16 bytes of compressed data are kept in the encoder
+ * until next write or flush.
+ *
+ * @param[in] self_p Initialized encoder object.
+ * @param[in] buf_p Input data.
+ * @param[in] size Number of bytes in the input data.
+ *
+ * @return Number of input bytes or negative error code.
+ */
+ssize_t deflate_encoder_write(struct deflate_encoder_t *self_p,
+                              const void *buf_p,
+                              size_t size);
+
+/**
+ * End the current block and write all compressed data to the output
+ * channel, padded to a byte boundary with an empty stored block (a
+ * sync flush). The final four bytes of the empty stored block,
+ * ``0x00 0x00 0xff 0xff``, are not written, as required by the
+ * websocket permessage-deflate extension. Append them if the
+ * compressed data is decompressed by other means.
+ *
+ * Compression continues with a new block in the same stream on next
+ * write.
+ *
+ * @param[in] self_p Initialized encoder object.
+ *
+ * @return zero(0) or negative error code.
+ */
+int deflate_encoder_flush(struct deflate_encoder_t *self_p);
+
+/**
+ * Initialize given decoder object. Raw deflate compressed data, as
+ * specified in RFC 1951, will be read from given channel. Up to 16
+ * bytes are read at a time, and a read returning zero(0) or a
+ * negative value is the end of the compressed data.
+ *
+ * @param[out] self_p Decoder object to initialize.
+ * @param[in] chan_p Input channel.
+ * @param[in] window_bits Base two logarithm of the largest distance
+ *                        of a match in the compressed data, 8 to
+ *                        15. Only used if ``window_p`` is not NULL.
+ * @param[in] window_p Buffer of ``1 << window_bits`` bytes to keep
+ *                     decompressed data in, so that the data can be
+ *                     read in chunks and later compressed data can
+ *                     refer to it, or NULL to decompress a whole
+ *                     stream into the buffer of each read.
+ *
+ * @return zero(0) or negative error code.
+ */
+int deflate_decoder_init(struct deflate_decoder_t *self_p,
+                         void *chan_p,
+                         int window_bits,
+                         void *window_p);
+
+/**
+ * Read decompressed data. The stream ends after the final block, or
+ * when the input channel ends at a block boundary. Input read ahead
+ * of the end of the final block is discarded. Decompression of next
+ * stream starts on next read, still referring to the decompressed
+ * data of earlier streams if there is a window.
+ *
+ * Without a window, the whole stream is decompressed by one call,
+ * and data not fitting in the buffer is dropped.
+ *
+ * @param[in] self_p Initialized decoder object.
+ * @param[out] buf_p Buffer to read into.
+ * @param[in] size Size of the buffer.
+ *
+ * @return Number of read bytes, zero(0) at the end of the stream, or
+ *         negative error code.
+ */
+ssize_t deflate_decoder_read(struct deflate_decoder_t *self_p,
+                             void *buf_p,
+                             size_t size);
+
+#endif
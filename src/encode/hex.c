@@ -28,33 +28,57 @@
 
 #include "simba.h"
 
-static int to_nibble(int ch)
-{
-    ch = tolower(ch);
-
-    if ((ch >= '0') && (ch <= '9')) {
-        return (ch - '0');
-    } else if ((ch >= 'a') && (ch <= 'f')) {
-        return (ch - 'a' + 10);
-    } else {
-        return (-EINVAL);
-    }
-}
-
-static int from_nibble(uint8_t nibble)
-{
-    if (nibble < 10) {
-        return (nibble + '0');
-    } else {
-        return (nibble + 'a' - 10);
-    }
-}
+#if CONFIG_HEX_FROM_BIN_TABLE_16 == 1
+
+/* Two characters per byte. */
+static FAR const char from_bin_table[] =
+    "000102030405060708090a0b0c0d0e0f101112131415161718191a1b1c1d1e1f"
+    "202122232425262728292a2b2c2d2e2f303132333435363738393a3b3c3d3e3f"
+    "404142434445464748494a4b4c4d4e4f505152535455565758595a5b5c5d5e5f"
+    "606162636465666768696a6b6c6d6e6f707172737475767778797a7b7c7d7e7f"
+    "808182838485868788898a8b8c8d8e8f909192939495969798999a9b9c9d9e9f"
+    "a0a1a2a3a4a5a6a7a8a9aaabacadaeafb0b1b2b3b4b5b6b7b8b9babbbcbdbebf"
+    "c0c1c2c3c4c5c6c7c8c9cacbcccdcecfd0d1d2d3d4d5d6d7d8d9dadbdcdddedf"
+    "e0e1e2e3e4e5e6e7e8e9eaebecedeeeff0f1f2f3f4f5f6f7f8f9fafbfcfdfeff";
+
+#else
+
+static FAR const char digits[] = "0123456789abcdef";
+
+#endif
+
+/* Nibble of each character, 0xff for invalid characters. */
+static FAR const uint8_t to_nibble_table[256] = {
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08, 0x09, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0x0a, 0x0b, 0x0c, 0x0d, 0x0e, 0x0f, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0x0a, 0x0b, 0x0c, 0x0d, 0x0e, 0x0f, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff,
+};
 
 int hex_to_bin(void *dst_p, const char *src_p, size_t size)
 {
     size_t i;
     uint8_t *u8_dst_p;
-    int ch;
+    uint8_t high;
+    uint8_t low;
 
     if ((size % 2) != 0) {
         return (-EINVAL);
@@ -64,23 +88,15 @@ int hex_to_bin(void *dst_p, const char *src_p, size_t size)
     size /= 2;
 
     for (i = 0; i < size; i++) {
-        /* First nibble. */
-        ch = to_nibble(src_p[2 * i]);
-
-        if (ch < 0) {
-            return (ch);
-        }
-
-        u8_dst_p[i] = ((uint8_t)ch << 4);
-
-        /* Second nibble. */
-        ch = to_nibble(src_p[2 * i + 1]);
+        high = to_nibble_table[(uint8_t)src_p[2 * i]];
+        low = to_nibble_table[(uint8_t)src_p[2 * i + 1]];
 
-        if (ch < 0) {
-            return (ch);
+        /* One check for both nibbles. */
+        if (((high | low) & 0xf0) != 0) {
+            return (-EINVAL);
         }
 
-        u8_dst_p[i] |= (uint8_t)ch;
+        u8_dst_p[i] = ((high << 4) | low);
     }
 
     return (size);
@@ -94,8 +110,13 @@ int hex_from_bin(char *dst_p, const void *src_p, size_t size)
     u8_src_p = (const uint8_t *)src_p;
 
     for (i = 0; i < size; i++) {
-        dst_p[2 * i] = from_nibble((u8_src_p[i] >> 4) & 0x0f);
-        dst_p[2 * i + 1] = from_nibble(u8_src_p[i] & 0x0f);
+#if CONFIG_HEX_FROM_BIN_TABLE_16 == 1
+        dst_p[2 * i] = from_bin_table[2 * u8_src_p[i]];
+        dst_p[2 * i + 1] = from_bin_table[2 * u8_src_p[i] + 1];
+#else
+        dst_p[2 * i] = digits[u8_src_p[i] >> 4];
+        dst_p[2 * i + 1] = digits[u8_src_p[i] & 0x0f];
+#endif
     }
 
     dst_p[2 * size] = '\0';
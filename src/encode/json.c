@@ -56,6 +56,22 @@
 
 #include "simba.h"
 
+/* Streaming parser states. */
+#define STREAM_STATE_VALUE                                  0
+#define STREAM_STATE_VALUE_OR_END                           1
+#define STREAM_STATE_KEY                                    2
+#define STREAM_STATE_KEY_OR_END                             3
+#define STREAM_STATE_COLON                                  4
+#define STREAM_STATE_COMMA_OR_END                           5
+#define STREAM_STATE_STRING                                 6
+#define STREAM_STATE_STRING_ESCAPE                          7
+#define STREAM_STATE_PRIMITIVE                              8
+
+/* Path match status of an element. */
+#define STREAM_STATUS_NONE                                  0
+#define STREAM_STATUS_PREFIX                                1
+#define STREAM_STATUS_FULL                                  2
+
 struct dump_t {
     struct json_t *self_p;
     struct json_tok_t *tokens_p;
@@ -531,6 +547,615 @@ static struct json_tok_t *object_get(struct json_t *self_p,
     return (NULL);
 }
 
+/**
+ * Find given path segment, where the first segment is one(1). Returns
+ * the segment type, '.' or '[', zero(0) if missing or negative error
+ * code.
+ */
+static int stream_path_segment(const char *path_p,
+                               int index,
+                               const char **begin_pp,
+                               size_t *size_p)
+{
+    char type;
+    const char *end_p;
+    const char *next_p;
+
+    /* Skip the root. */
+    path_p++;
+
+    while (1) {
+        type = *path_p++;
+
+        if (type == '.') {
+            end_p = path_p;
+
+            while ((*end_p != '\0') && (*end_p != '.') && (*end_p != '[')) {
+                end_p++;
+            }
+
+            next_p = end_p;
+        } else if (type == '[') {
+            end_p = strchr(path_p, ']');
+
+            if (end_p == NULL) {
+                return (-EINVAL);
+            }
+
+            next_p = (end_p + 1);
+        } else if (type == '\0') {
+            return (0);
+        } else {
+            return (-EINVAL);
+        }
+
+        if (end_p == path_p) {
+            return (-EINVAL);
+        }
+
+        index--;
+
+        if (index == 0) {
+            *begin_pp = path_p;
+            *size_p = (end_p - path_p);
+
+            return (type);
+        }
+
+        path_p = next_p;
+    }
+}
+
+/**
+ * Get the path match status of a child, with given key or index, of
+ * the innermost object or array.
+ */
+static int stream_child_status(struct json_stream_t *self_p,
+                               int parent_status,
+                               const char *key_p,
+                               size_t key_size,
+                               int index)
+{
+    int type;
+    int i;
+    int segment_index;
+    const char *segment_p;
+    size_t size;
+
+    if (parent_status != STREAM_STATUS_PREFIX) {
+        return (parent_status);
+    }
+
+    type = stream_path_segment(self_p->path_p,
+                               self_p->depth,
+                               &segment_p,
+                               &size);
+
+    if ((size != 1) || (segment_p[0] != '*')) {
+        if (type == '.') {
+            if ((key_p == NULL)
+                || (size != key_size)
+                || (memcmp(segment_p, key_p, size) != 0)) {
+                return (STREAM_STATUS_NONE);
+            }
+        } else {
+            if (key_p != NULL) {
+                return (STREAM_STATUS_NONE);
+            }
+
+            segment_index = 0;
+
+            for (i = 0; i < size; i++) {
+                segment_index = (10 * segment_index + segment_p[i] - '0');
+            }
+
+            if (segment_index != index) {
+                return (STREAM_STATUS_NONE);
+            }
+        }
+    }
+
+    if (self_p->depth == self_p->number_of_path_segments) {
+        return (STREAM_STATUS_FULL);
+    }
+
+    return (STREAM_STATUS_PREFIX);
+}
+
+static int stream_emit(struct json_stream_t *self_p,
+                       enum json_event_type_t type,
+                       const char *buf_p,
+                       size_t size)
+{
+    return (self_p->callback(self_p->arg_p, type, buf_p, size));
+}
+
+/**
+ * Get the path match status of a value that is about to be parsed.
+ */
+static int stream_value_status(struct json_stream_t *self_p)
+{
+    int status;
+    struct json_stream_level_t *parent_p;
+
+    if (self_p->depth == 0) {
+        if (self_p->number_of_path_segments == 0) {
+            return (STREAM_STATUS_FULL);
+        } else {
+            return (STREAM_STATUS_PREFIX);
+        }
+    }
+
+    parent_p = &self_p->stack[self_p->depth - 1];
+
+    if (parent_p->type == JSON_OBJECT) {
+        return (parent_p->child_status);
+    }
+
+    status = stream_child_status(self_p,
+                                 parent_p->status,
+                                 NULL,
+                                 0,
+                                 parent_p->index);
+    parent_p->index++;
+
+    return (status);
+}
+
+static void stream_value_end(struct json_stream_t *self_p)
+{
+    if (self_p->depth == 0) {
+        self_p->state = STREAM_STATE_VALUE;
+    } else {
+        self_p->state = STREAM_STATE_COMMA_OR_END;
+    }
+}
+
+/**
+ * Store given key or value character, unless it is not needed.
+ */
+static int stream_store(struct json_stream_t *self_p, char c)
+{
+    if (self_p->is_key) {
+        if (self_p->status == STREAM_STATUS_NONE) {
+            return (0);
+        }
+    } else if (self_p->status != STREAM_STATUS_FULL) {
+        return (0);
+    }
+
+    if ((self_p->pos + 1) >= self_p->size) {
+        return (JSON_ERROR_NOMEM);
+    }
+
+    self_p->buf_p[self_p->pos++] = c;
+
+    return (0);
+}
+
+static int stream_string_end(struct json_stream_t *self_p)
+{
+    int res;
+    struct json_stream_level_t *parent_p;
+
+    self_p->buf_p[self_p->pos] = '\0';
+    res = 0;
+
+    if (self_p->is_key) {
+        parent_p = &self_p->stack[self_p->depth - 1];
+        parent_p->child_status = stream_child_status(self_p,
+                                                     parent_p->status,
+                                                     self_p->buf_p,
+                                                     self_p->pos,
+                                                     0);
+
+        if (parent_p->status == STREAM_STATUS_FULL) {
+            res = stream_emit(self_p,
+                              JSON_EVENT_KEY,
+                              self_p->buf_p,
+                              self_p->pos);
+        }
+
+        self_p->state = STREAM_STATE_COLON;
+    } else {
+        if (self_p->status == STREAM_STATUS_FULL) {
+            res = stream_emit(self_p,
+                              JSON_EVENT_STRING,
+                              self_p->buf_p,
+                              self_p->pos);
+        }
+
+        stream_value_end(self_p);
+    }
+
+    return (res);
+}
+
+static int stream_primitive_end(struct json_stream_t *self_p)
+{
+    int res;
+
+    self_p->buf_p[self_p->pos] = '\0';
+    res = 0;
+
+    if (self_p->status == STREAM_STATUS_FULL) {
+        res = stream_emit(self_p,
+                          JSON_EVENT_PRIMITIVE,
+                          self_p->buf_p,
+                          self_p->pos);
+    }
+
+    stream_value_end(self_p);
+
+    return (res);
+}
+
+static int stream_container_begin(struct json_stream_t *self_p,
+                                  int type,
+                                  int status)
+{
+    struct json_stream_level_t *entry_p;
+
+    if (self_p->depth == CONFIG_JSON_STREAM_DEPTH_MAX) {
+        return (JSON_ERROR_NOMEM);
+    }
+
+    entry_p = &self_p->stack[self_p->depth++];
+    entry_p->type = type;
+    entry_p->status = status;
+    entry_p->child_status = STREAM_STATUS_NONE;
+    entry_p->index = 0;
+
+    if (type == JSON_OBJECT) {
+        self_p->state = STREAM_STATE_KEY_OR_END;
+
+        if (status == STREAM_STATUS_FULL) {
+            return (stream_emit(self_p, JSON_EVENT_OBJECT_BEGIN, NULL, 0));
+        }
+    } else {
+        self_p->state = STREAM_STATE_VALUE_OR_END;
+
+        if (status == STREAM_STATUS_FULL) {
+            return (stream_emit(self_p, JSON_EVENT_ARRAY_BEGIN, NULL, 0));
+        }
+    }
+
+    return (0);
+}
+
+static int stream_container_end(struct json_stream_t *self_p,
+                                int type)
+{
+    int res;
+    struct json_stream_level_t *entry_p;
+
+    entry_p = &self_p->stack[self_p->depth - 1];
+
+    if (entry_p->type != type) {
+        return (JSON_ERROR_INVAL);
+    }
+
+    self_p->depth--;
+    res = 0;
+
+    if (entry_p->status == STREAM_STATUS_FULL) {
+        if (type == JSON_OBJECT) {
+            res = stream_emit(self_p, JSON_EVENT_OBJECT_END, NULL, 0);
+        } else {
+            res = stream_emit(self_p, JSON_EVENT_ARRAY_END, NULL, 0);
+        }
+    }
+
+    stream_value_end(self_p);
+
+    return (res);
+}
+
+static int stream_value_begin(struct json_stream_t *self_p, char c)
+{
+    int status;
+
+    status = stream_value_status(self_p);
+
+    if (c == '{') {
+        return (stream_container_begin(self_p, JSON_OBJECT, status));
+    } else if (c == '[') {
+        return (stream_container_begin(self_p, JSON_ARRAY, status));
+    }
+
+    self_p->is_key = 0;
+    self_p->status = status;
+    self_p->pos = 0;
+
+    if (c == '"') {
+        self_p->state = STREAM_STATE_STRING;
+
+        return (0);
+    } else if ((c == '-') || isalnum((int)c)) {
+        self_p->state = STREAM_STATE_PRIMITIVE;
+
+        return (stream_store(self_p, c));
+    }
+
+    return (JSON_ERROR_INVAL);
+}
+
+static int stream_input_char(struct json_stream_t *self_p, char c)
+{
+    int res;
+
+    switch (self_p->state) {
+
+    case STREAM_STATE_STRING:
+        if (c == '"') {
+            return (stream_string_end(self_p));
+        } else if (c == '\\') {
+            self_p->state = STREAM_STATE_STRING_ESCAPE;
+        }
+
+        return (stream_store(self_p, c));
+
+    case STREAM_STATE_STRING_ESCAPE:
+        self_p->state = STREAM_STATE_STRING;
+
+        return (stream_store(self_p, c));
+
+    case STREAM_STATE_PRIMITIVE:
+        if (isspace((int)c) || (c == ',') || (c == ']') || (c == '}')) {
+            res = stream_primitive_end(self_p);
+
+            if (res != 0) {
+                return (res);
+            }
+
+            /* The delimiter is parsed below. */
+            break;
+        }
+
+        if (!isalnum((int)c) && (c != '.') && (c != '+') && (c != '-')) {
+            return (JSON_ERROR_INVAL);
+        }
+
+        return (stream_store(self_p, c));
+
+    default:
+        break;
+    }
+
+    if (isspace((int)c)) {
+        return (0);
+    }
+
+    switch (self_p->state) {
+
+    case STREAM_STATE_VALUE_OR_END:
+        if (c == ']') {
+            return (stream_container_end(self_p, JSON_ARRAY));
+        }
+
+        return (stream_value_begin(self_p, c));
+
+    case STREAM_STATE_VALUE:
+        return (stream_value_begin(self_p, c));
+
+    case STREAM_STATE_KEY_OR_END:
+        if (c == '}') {
+            return (stream_container_end(self_p, JSON_OBJECT));
+        }
+
+        /* Fall through. */
+
+    case STREAM_STATE_KEY:
+        if (c != '"') {
+            return (JSON_ERROR_INVAL);
+        }
+
+        self_p->is_key = 1;
+        self_p->status = self_p->stack[self_p->depth - 1].status;
+        self_p->pos = 0;
+        self_p->state = STREAM_STATE_STRING;
+
+        return (0);
+
+    case STREAM_STATE_COLON:
+        if (c != ':') {
+            return (JSON_ERROR_INVAL);
+        }
+
+        self_p->state = STREAM_STATE_VALUE;
+
+        return (0);
+
+    case STREAM_STATE_COMMA_OR_END:
+        if (c == ',') {
+            if (self_p->stack[self_p->depth - 1].type == JSON_OBJECT) {
+                self_p->state = STREAM_STATE_KEY;
+            } else {
+                self_p->state = STREAM_STATE_VALUE;
+            }
+
+            return (0);
+        } else if (c == '}') {
+            return (stream_container_end(self_p, JSON_OBJECT));
+        } else if (c == ']') {
+            return (stream_container_end(self_p, JSON_ARRAY));
+        }
+
+        return (JSON_ERROR_INVAL);
+
+    default:
+        return (JSON_ERROR_INVAL);
+    }
+}
+
+/**
+ * Write the buffered data to the channel.
+ */
+static int writer_flush_buffer(struct json_writer_t *self_p)
+{
+    if ((self_p->res != 0) || (self_p->pos == 0)) {
+        return (self_p->res);
+    }
+
+    if (chan_write(self_p->chan_p,
+                   self_p->buf_p,
+                   self_p->pos) != self_p->pos) {
+        self_p->res = -EIO;
+    } else {
+        self_p->written += self_p->pos;
+        self_p->pos = 0;
+    }
+
+    return (self_p->res);
+}
+
+static int writer_write(struct json_writer_t *self_p,
+                        const char *buf_p,
+                        size_t size)
+{
+    size_t n;
+
+    while ((size > 0) && (self_p->res == 0)) {
+        /* Write directly to the channel if larger than the buffer. */
+        if ((self_p->pos == 0) && (size >= self_p->size)) {
+            if (chan_write(self_p->chan_p, buf_p, size) != size) {
+                self_p->res = -EIO;
+            } else {
+                self_p->written += size;
+            }
+
+            break;
+        }
+
+        n = MIN(size, self_p->size - self_p->pos);
+        memcpy(&self_p->buf_p[self_p->pos], buf_p, n);
+        self_p->pos += n;
+        buf_p += n;
+        size -= n;
+
+        if (self_p->pos == self_p->size) {
+            writer_flush_buffer(self_p);
+        }
+    }
+
+    return (self_p->res);
+}
+
+static int writer_char(struct json_writer_t *self_p, char c)
+{
+    return (writer_write(self_p, &c, 1));
+}
+
+/**
+ * Write a comma if given element is not the first in its object or
+ * array.
+ */
+static void writer_delimiter(struct json_writer_t *self_p)
+{
+    if (self_p->comma) {
+        writer_char(self_p, ',');
+    }
+}
+
+/**
+ * Write given string with quotes, copying runs of characters that
+ * need no escaping at once.
+ */
+static int writer_escaped_string(struct json_writer_t *self_p,
+                                 const char *string_p)
+{
+    static const char hex[] = "0123456789abcdef";
+    const char *begin_p;
+    char escape[6];
+    size_t size;
+    unsigned char c;
+
+    writer_char(self_p, '"');
+
+    while (1) {
+        begin_p = string_p;
+
+        while ((*string_p != '\0')
+               && (*string_p != '"')
+               && (*string_p != '\\')
+               && ((unsigned char)*string_p >= 0x20)) {
+            string_p++;
+        }
+
+        writer_write(self_p, begin_p, string_p - begin_p);
+
+        if (*string_p == '\0') {
+            break;
+        }
+
+        c = *string_p++;
+        escape[0] = '\\';
+        size = 2;
+
+        switch (c) {
+
+        case '"':
+        case '\\':
+            escape[1] = c;
+            break;
+
+        case '\n':
+            escape[1] = 'n';
+            break;
+
+        case '\r':
+            escape[1] = 'r';
+            break;
+
+        case '\t':
+            escape[1] = 't';
+            break;
+
+        default:
+            escape[1] = 'u';
+            escape[2] = '0';
+            escape[3] = '0';
+            escape[4] = hex[c >> 4];
+            escape[5] = hex[c & 0xf];
+            size = 6;
+            break;
+        }
+
+        writer_write(self_p, &escape[0], size);
+    }
+
+    return (writer_char(self_p, '"'));
+}
+
+/**
+ * Format given value backwards, ending at given pointer, with at
+ * least given number of digits. Returns a pointer to the first
+ * digit.
+ */
+static char *writer_format_unsigned(char *end_p,
+                                    unsigned long value,
+                                    int number_of_digits)
+{
+    do {
+        *--end_p = ('0' + (value % 10));
+        value /= 10;
+        number_of_digits--;
+    } while ((value > 0) || (number_of_digits > 0));
+
+    return (end_p);
+}
+
+static int writer_value(struct json_writer_t *self_p,
+                        const char *buf_p,
+                        size_t size)
+{
+    writer_delimiter(self_p);
+    writer_write(self_p, buf_p, size);
+    self_p->comma = 1;
+
+    return (self_p->res);
+}
+
 int json_init(struct json_t *self_p,
               struct json_tok_t *tokens_p,
               int num_tokens)
@@ -881,6 +1506,273 @@ struct json_tok_t *json_array_get(struct json_t *self_p,
     return (NULL);
 }
 
+int json_stream_init(struct json_stream_t *self_p,
+                     char *buf_p,
+                     size_t size,
+                     json_stream_callback_t callback,
+                     void *arg_p)
+{
+    ASSERTN(self_p != NULL, EINVAL);
+    ASSERTN(buf_p != NULL, EINVAL);
+    ASSERTN(size > 0, EINVAL);
+    ASSERTN(callback != NULL, EINVAL);
+
+    self_p->callback = callback;
+    self_p->arg_p = arg_p;
+    self_p->path_p = "$";
+    self_p->number_of_path_segments = 0;
+    self_p->state = STREAM_STATE_VALUE;
+    self_p->depth = 0;
+    self_p->buf_p = buf_p;
+    self_p->size = size;
+    self_p->pos = 0;
+
+    return (0);
+}
+
+int json_stream_set_path(struct json_stream_t *self_p,
+                         const char *path_p)
+{
+    ASSERTN(self_p != NULL, EINVAL);
+
+    int i;
+    int type;
+    const char *segment_p;
+    size_t size;
+    int number_of_segments;
+
+    if (path_p == NULL) {
+        path_p = "$";
+    }
+
+    if (path_p[0] != '$') {
+        return (-EINVAL);
+    }
+
+    number_of_segments = 0;
+
+    while (1) {
+        type = stream_path_segment(path_p,
+                                   number_of_segments + 1,
+                                   &segment_p,
+                                   &size);
+
+        if (type < 0) {
+            return (type);
+        } else if (type == 0) {
+            break;
+        }
+
+        /* Indexes are decimal numbers. */
+        if ((type == '[') && ((size != 1) || (segment_p[0] != '*'))) {
+            for (i = 0; i < size; i++) {
+                if (!isdigit((int)segment_p[i])) {
+                    return (-EINVAL);
+                }
+            }
+        }
+
+        number_of_segments++;
+    }
+
+    if (number_of_segments > CONFIG_JSON_STREAM_DEPTH_MAX) {
+        return (-EINVAL);
+    }
+
+    self_p->path_p = path_p;
+    self_p->number_of_path_segments = number_of_segments;
+
+    return (0);
+}
+
+int json_stream_input(struct json_stream_t *self_p,
+                      const void *buf_p,
+                      size_t size)
+{
+    ASSERTN(self_p != NULL, EINVAL);
+    ASSERTN(buf_p != NULL, EINVAL);
+
+    int res;
+    size_t i;
+    const char *c_buf_p;
+
+    c_buf_p = buf_p;
+
+    for (i = 0; i < size; i++) {
+        res = stream_input_char(self_p, c_buf_p[i]);
+
+        if (res != 0) {
+            return (res);
+        }
+    }
+
+    return (0);
+}
+
+int json_writer_init(struct json_writer_t *self_p,
+                     void *chan_p,
+                     char *buf_p,
+                     size_t size)
+{
+    ASSERTN(self_p != NULL, EINVAL);
+    ASSERTN(chan_p != NULL, EINVAL);
+    ASSERTN(buf_p != NULL, EINVAL);
+    ASSERTN(size > 0, EINVAL);
+
+    self_p->chan_p = chan_p;
+    self_p->buf_p = buf_p;
+    self_p->size = size;
+    self_p->pos = 0;
+    self_p->comma = 0;
+    self_p->res = 0;
+    self_p->written = 0;
+
+    return (0);
+}
+
+int json_writer_begin_object(struct json_writer_t *self_p)
+{
+    ASSERTN(self_p != NULL, EINVAL);
+
+    writer_delimiter(self_p);
+    self_p->comma = 0;
+
+    return (writer_char(self_p, '{'));
+}
+
+int json_writer_end_object(struct json_writer_t *self_p)
+{
+    ASSERTN(self_p != NULL, EINVAL);
+
+    self_p->comma = 1;
+
+    return (writer_char(self_p, '}'));
+}
+
+int json_writer_begin_array(struct json_writer_t *self_p)
+{
+    ASSERTN(self_p != NULL, EINVAL);
+
+    writer_delimiter(self_p);
+    self_p->comma = 0;
+
+    return (writer_char(self_p, '['));
+}
+
+int json_writer_end_array(struct json_writer_t *self_p)
+{
+    ASSERTN(self_p != NULL, EINVAL);
+
+    self_p->comma = 1;
+
+    return (writer_char(self_p, ']'));
+}
+
+int json_writer_key(struct json_writer_t *self_p, const char *key_p)
+{
+    ASSERTN(self_p != NULL, EINVAL);
+    ASSERTN(key_p != NULL, EINVAL);
+
+    writer_delimiter(self_p);
+    writer_escaped_string(self_p, key_p);
+    self_p->comma = 0;
+
+    return (writer_char(self_p, ':'));
+}
+
+int json_writer_string(struct json_writer_t *self_p, const char *value_p)
+{
+    ASSERTN(self_p != NULL, EINVAL);
+    ASSERTN(value_p != NULL, EINVAL);
+
+    writer_delimiter(self_p);
+    writer_escaped_string(self_p, value_p);
+    self_p->comma = 1;
+
+    return (self_p->res);
+}
+
+int json_writer_integer(struct json_writer_t *self_p, long value)
+{
+    ASSERTN(self_p != NULL, EINVAL);
+
+    return (json_writer_decimal(self_p, value, 0));
+}
+
+int json_writer_decimal(struct json_writer_t *self_p,
+                        long value,
+                        int number_of_decimals)
+{
+    ASSERTN(self_p != NULL, EINVAL);
+    ASSERTN(number_of_decimals >= 0, EINVAL);
+    ASSERTN(number_of_decimals <= 9, EINVAL);
+
+    char buf[24];
+    char *begin_p;
+    unsigned long magnitude;
+    unsigned long divisor;
+    int i;
+
+    if (value < 0) {
+        magnitude = -(unsigned long)value;
+    } else {
+        magnitude = value;
+    }
+
+    begin_p = &buf[sizeof(buf)];
+
+    if (number_of_decimals > 0) {
+        divisor = 1;
+
+        for (i = 0; i < number_of_decimals; i++) {
+            divisor *= 10;
+        }
+
+        begin_p = writer_format_unsigned(begin_p,
+                                         magnitude % divisor,
+                                         number_of_decimals);
+        *--begin_p = '.';
+        magnitude /= divisor;
+    }
+
+    begin_p = writer_format_unsigned(begin_p, magnitude, 1);
+
+    if (value < 0) {
+        *--begin_p = '-';
+    }
+
+    return (writer_value(self_p, begin_p, &buf[sizeof(buf)] - begin_p));
+}
+
+int json_writer_boolean(struct json_writer_t *self_p, int value)
+{
+    ASSERTN(self_p != NULL, EINVAL);
+
+    if (value) {
+        return (writer_value(self_p, "true", 4));
+    } else {
+        return (writer_value(self_p, "false", 5));
+    }
+}
+
+int json_writer_null(struct json_writer_t *self_p)
+{
+    ASSERTN(self_p != NULL, EINVAL);
+
+    return (writer_value(self_p, "null", 4));
+}
+
+ssize_t json_writer_flush(struct json_writer_t *self_p)
+{
+    ASSERTN(self_p != NULL, EINVAL);
+
+    if (writer_flush_buffer(self_p) != 0) {
+        return (self_p->res);
+    }
+
+    return (self_p->written);
+}
+
 void json_token_object(struct json_tok_t *token_p,
                        int num_keys)
 {
@@ -90,6 +90,95 @@ enum json_err_t {
     JSON_ERROR_PART = -3
 };
 
+/**
+ * Streaming JSON parser event type.
+ */
+enum json_event_type_t {
+    /** Start of an object, ``{``. */
+    JSON_EVENT_OBJECT_BEGIN = 0,
+
+    /** End of an object, ``}``. */
+    JSON_EVENT_OBJECT_END,
+
+    /** Start of an array, ``[``. */
+    JSON_EVENT_ARRAY_BEGIN,
+
+    /** End of an array, ``]``. */
+    JSON_EVENT_ARRAY_END,
+
+    /** Object key. */
+    JSON_EVENT_KEY,
+
+    /** String value. */
+    JSON_EVENT_STRING,
+
+    /** Other primitive value: number, boolean (true/false) or null. */
+    JSON_EVENT_PRIMITIVE
+};
+
+/**
+ * Streaming JSON parser event callback.
+ *
+ * @param[in] arg_p Argument given to `json_stream_init()`.
+ * @param[in] type Event type.
+ * @param[in] buf_p Null terminated key or value of key, string and
+ *                  primitive events, otherwise NULL. Escape
+ *                  sequences in strings are not decoded.
+ * @param[in] size Key or value length, not including the null
+ *                 termination.
+ *
+ * @return zero(0) to continue parsing, or negative error code to
+ *         abort parsing with given error.
+ */
+typedef int (*json_stream_callback_t)(void *arg_p,
+                                      enum json_event_type_t type,
+                                      const char *buf_p,
+                                      size_t size);
+
+/**
+ * An object or array in the streaming JSON parser nesting stack.
+ */
+struct json_stream_level_t {
+    int8_t type;
+    int8_t status;
+    int8_t child_status;
+    int index;
+};
+
+/**
+ * Streaming JSON parser. Parses a document in chunks of any size,
+ * calling a callback for each parsed element, without storing the
+ * document or any tokens.
+ */
+struct json_stream_t {
+    json_stream_callback_t callback;
+    void *arg_p;
+    const char *path_p;
+    int number_of_path_segments;
+    int8_t state;
+    int8_t depth;
+    int8_t status;
+    int8_t is_key;
+    char *buf_p;
+    size_t size;
+    size_t pos;
+    struct json_stream_level_t stack[CONFIG_JSON_STREAM_DEPTH_MAX];
+};
+
+/**
+ * Buffered JSON writer. Formats a document element by element into a
+ * buffer, which is written to a channel when full.
+ */
+struct json_writer_t {
+    void *chan_p;
+    char *buf_p;
+    size_t size;
+    size_t pos;
+    int comma;
+    int res;
+    ssize_t written;
+};
+
 /*
  * JSON token description.
  */
@@ -236,6 +325,196 @@ struct json_tok_t *json_array_get(struct json_t *self_p,
                                   int index,
                                   struct json_tok_t *array_p);
 
+/**
+ * Initialize given streaming JSON parser.
+ *
+ * @param[out] self_p Parser to initialize.
+ * @param[in] buf_p Buffer for the key or value currently being
+ *                  parsed. Longer keys and values makes the parser
+ *                  fail with ``JSON_ERROR_NOMEM``.
+ * @param[in] size Buffer size, including the null termination.
+ * @param[in] callback Called for each parsed element.
+ * @param[in] arg_p Callback argument.
+ *
+ * @return zero(0) or negative error code.
+ */
+int json_stream_init(struct json_stream_t *self_p,
+                     char *buf_p,
+                     size_t size,
+                     json_stream_callback_t callback,
+                     void *arg_p);
+
+/**
+ * Only call the callback for elements matching given path, and all
+ * elements within matching objects and arrays. Keys and values not
+ * matching the path are not stored in the parser buffer, so their
+ * length is not limited.
+ *
+ * The path starts with ``$``, the root, followed by zero or more
+ * ``.key`` and ``[index]`` segments. ``*`` matches any key or index,
+ * for example ``$.sensors[*].id`` matches the value of the key
+ * ``id`` in all objects in the array ``sensors``.
+ *
+ * Must be called before the document is parsed.
+ *
+ * @param[in] self_p Initialized parser.
+ * @param[in] path_p Path, or NULL to match all elements. The path
+ *                   must be valid as long as the parser is used.
+ *
+ * @return zero(0) or negative error code.
+ */
+int json_stream_set_path(struct json_stream_t *self_p,
+                         const char *path_p);
+
+/**
+ * Parse given chunk of a JSON document, calling the callback for all
+ * elements completed within the chunk. Completed documents are
+ * followed by zero or more new documents in the same stream.
+ *
+ * @param[in] self_p Initialized parser.
+ * @param[in] buf_p Chunk to parse.
+ * @param[in] size Chunk size in bytes.
+ *
+ * @return zero(0) or negative error code.
+ */
+int json_stream_input(struct json_stream_t *self_p,
+                      const void *buf_p,
+                      size_t size);
+
+/**
+ * Initialize given JSON writer. Elements are formatted into given
+ * buffer, which is written to given channel when full and by
+ * `json_writer_flush()`.
+ *
+ * The writer adds commas and colons between elements, but does not
+ * verify that the document is well formed.
+ *
+ * Writer functions return zero(0) or a negative error code. An error
+ * is sticky; all following writer calls fail with the same error.
+ *
+ * @param[out] self_p Writer to initialize.
+ * @param[in] chan_p Channel to write the document to.
+ * @param[in] buf_p Output buffer.
+ * @param[in] size Output buffer size in bytes.
+ *
+ * @return zero(0) or negative error code.
+ */
+int json_writer_init(struct json_writer_t *self_p,
+                     void *chan_p,
+                     char *buf_p,
+                     size_t size);
+
+/**
+ * Begin an object, ``{``.
+ *
+ * @param[in] self_p Initialized writer.
+ *
+ * @return zero(0) or negative error code.
+ */
+int json_writer_begin_object(struct json_writer_t *self_p);
+
+/**
+ * End an object, ``}``.
+ *
+ * @param[in] self_p Initialized writer.
+ *
+ * @return zero(0) or negative error code.
+ */
+int json_writer_end_object(struct json_writer_t *self_p);
+
+/**
+ * Begin an array, ``[``.
+ *
+ * @param[in] self_p Initialized writer.
+ *
+ * @return zero(0) or negative error code.
+ */
+int json_writer_begin_array(struct json_writer_t *self_p);
+
+/**
+ * End an array, ``]``.
+ *
+ * @param[in] self_p Initialized writer.
+ *
+ * @return zero(0) or negative error code.
+ */
+int json_writer_end_array(struct json_writer_t *self_p);
+
+/**
+ * Write given object key. The value is written by the next call.
+ *
+ * @param[in] self_p Initialized writer.
+ * @param[in] key_p Key, escaped as a string.
+ *
+ * @return zero(0) or negative error code.
+ */
+int json_writer_key(struct json_writer_t *self_p, const char *key_p);
+
+/**
+ * Write given string value. Quotes, backslashes and control
+ * characters are escaped.
+ *
+ * @param[in] self_p Initialized writer.
+ * @param[in] value_p Null terminated string.
+ *
+ * @return zero(0) or negative error code.
+ */
+int json_writer_string(struct json_writer_t *self_p, const char *value_p);
+
+/**
+ * Write given integer value.
+ *
+ * @param[in] self_p Initialized writer.
+ * @param[in] value Value to write.
+ *
+ * @return zero(0) or negative error code.
+ */
+int json_writer_integer(struct json_writer_t *self_p, long value);
+
+/**
+ * Write given fixed point value as a decimal number, for example
+ * ``-1.250`` for value -1250 with three decimals.
+ *
+ * @param[in] self_p Initialized writer.
+ * @param[in] value Value multiplied by 10 to the power of given
+ *                  number of decimals.
+ * @param[in] number_of_decimals Number of decimals, 0 to 9.
+ *
+ * @return zero(0) or negative error code.
+ */
+int json_writer_decimal(struct json_writer_t *self_p,
+                        long value,
+                        int number_of_decimals);
+
+/**
+ * Write given boolean value, ``true`` or ``false``.
+ *
+ * @param[in] self_p Initialized writer.
+ * @param[in] value Value to write.
+ *
+ * @return zero(0) or negative error code.
+ */
+int json_writer_boolean(struct json_writer_t *self_p, int value);
+
+/**
+ * Write ``null``.
+ *
+ * @param[in] self_p Initialized writer.
+ *
+ * @return zero(0) or negative error code.
+ */
+int json_writer_null(struct json_writer_t *self_p);
+
+/**
+ * Write buffered data to the channel.
+ *
+ * @param[in] self_p Initialized writer.
+ *
+ * @return Total number of bytes written to the channel or negative
+ *         error code.
+ */
+ssize_t json_writer_flush(struct json_writer_t *self_p);
+
 /**
  * Initialize a JSON object token.
  *
@@ -28,7 +28,16 @@
 
 #include "simba.h"
 
-static uint8_t calculate_crc(char *buf_p, size_t size)
+/* Incremental decoder states. */
+#define DECODER_STATE_START                                 0
+#define DECODER_STATE_ADDRESS                               1
+#define DECODER_STATE_FIELDS                                2
+#define DECODER_STATE_CRC_HIGH                              3
+#define DECODER_STATE_CRC_LOW                               4
+#define DECODER_STATE_CR                                    5
+#define DECODER_STATE_LF                                    6
+
+static uint8_t calculate_crc(const char *buf_p, size_t size)
 {
     size_t i;
     uint8_t crc;
@@ -42,50 +51,163 @@ static uint8_t calculate_crc(char *buf_p, size_t size)
     return (crc);
 }
 
-static int decode_triple(char *src_p,
+/**
+ * Parse given number of decimal digits.
+ *
+ * @return zero(0) or -EPROTO if a character is not a digit.
+ */
+static int parse_digits(const char *src_p, size_t size, long *value_p)
+{
+    long value;
+    size_t i;
+
+    value = 0;
+
+    for (i = 0; i < size; i++) {
+        if (!isdigit((int)src_p[i])) {
+            return (-EPROTO);
+        }
+
+        value = (10 * value + (src_p[i] - '0'));
+    }
+
+    *value_p = value;
+
+    return (0);
+}
+
+/**
+ * Parse the fraction digits of a number as given number of decimals.
+ * Further digits are truncated.
+ */
+static int parse_fraction(const char *src_p,
+                          size_t size,
+                          int decimals,
+                          long *value_p)
+{
+    long value;
+    long truncated;
+    int i;
+
+    if (parse_digits(src_p, MIN(size, decimals), &value) != 0) {
+        return (-EPROTO);
+    }
+
+    for (i = size; i < decimals; i++) {
+        value *= 10;
+    }
+
+    /* Only truncated digits may be left. */
+    if (size > decimals) {
+        if (parse_digits(&src_p[decimals],
+                         size - decimals,
+                         &truncated) != 0) {
+            return (-EPROTO);
+        }
+    }
+
+    *value_p = value;
+
+    return (0);
+}
+
+/**
+ * Decode given six digits ``aabbcc``, optionally followed by a
+ * fraction, which is decoded as milliseconds.
+ */
+static int decode_triple(const char *src_p,
+                         size_t size,
                          int *v0_p,
                          int *v1_p,
-                         int *v2_p)
+                         int *v2_p,
+                         int *milliseconds_p)
 {
     long v0;
     long v1;
     long v2;
-    char *dot_p;
+    long milliseconds;
 
-    /* Discard any sub-seconds for now. */
-    dot_p = strchr(src_p, '.');
+    milliseconds = 0;
 
-    if (dot_p != NULL) {
-        *dot_p = '\0';
+    if (size < 6) {
+        return (-EPROTO);
     }
 
-    /* The string length must be exactly 6. */
-    if (src_p[6] != '\0') {
+    if (size > 6) {
+        if (src_p[6] != '.') {
+            return (-EPROTO);
+        }
+
+        if (parse_fraction(&src_p[7], size - 7, 3, &milliseconds) != 0) {
+            return (-EPROTO);
+        }
+    }
+
+    if ((parse_digits(&src_p[0], 2, &v0) != 0)
+        || (parse_digits(&src_p[2], 2, &v1) != 0)
+        || (parse_digits(&src_p[4], 2, &v2) != 0)) {
         return (-EPROTO);
     }
 
-    /* v2. */
-    if (std_strtolb(&src_p[4], &v2, 10) != &src_p[6]) {
+    *v0_p = v0;
+    *v1_p = v1;
+    *v2_p = v2;
+
+    if (milliseconds_p != NULL) {
+        *milliseconds_p = milliseconds;
+    }
+
+    return (0);
+}
+
+/**
+ * Decode given position angle ``d{2,3}mm.m+`` and direction using
+ * integer arithmetic only.
+ */
+static int decode_position(const char *angle_p,
+                           size_t size,
+                           char direction,
+                           long *degrees_p)
+{
+    size_t pos;
+    size_t minutes_pos;
+    long degrees;
+    long minutes;
+    long fraction;
+
+    pos = 0;
+
+    while ((pos < size) && (angle_p[pos] != '.')) {
+        pos++;
+    }
+
+    /* The string must contain a dot at position 4 or later. */
+    if ((pos == size) || (pos < 4)) {
         return (-EPROTO);
     }
 
-    src_p[4] = '\0';
+    minutes_pos = (pos - 2);
 
-    /* v1. */
-    if (std_strtolb(&src_p[2], &v1, 10) != &src_p[4]) {
+    if ((parse_digits(&angle_p[0], minutes_pos, &degrees) != 0)
+        || (parse_digits(&angle_p[minutes_pos], 2, &minutes) != 0)
+        || (parse_fraction(&angle_p[pos + 1],
+                           size - pos - 1,
+                           6,
+                           &fraction) != 0)) {
         return (-EPROTO);
     }
 
-    src_p[2] = '\0';
+    degrees = ((degrees * 1000000) + (minutes * 1000000 + fraction) / 60);
 
-    /* v0. */
-    if (std_strtolb(&src_p[0], &v0, 10) != &src_p[2]) {
+    /* Positive sign for north and east, negtive for south and
+       west. */
+    if ((direction == 'S') || (direction == 'W')) {
+        degrees *= -1;
+    } else if ((direction != 'N') && (direction != 'E')) {
         return (-EPROTO);
     }
 
-    *v0_p = v0;
-    *v1_p = v1;
-    *v2_p = v2;
+    *degrees_p = degrees;
 
     return (0);
 }
@@ -595,6 +717,366 @@ ssize_t nmea_decode(struct nmea_sentence_t *dst_p,
     return (res);
 }
 
+/**
+ * Get the sentence type from given address field, for example
+ * ``GPGGA``.
+ */
+static int decoder_type(const char *address_p, size_t size)
+{
+    if (size == 5) {
+        if (memcmp(&address_p[2], "GGA", 3) == 0) {
+            return (nmea_sentence_type_gga_t);
+        } else if (memcmp(&address_p[2], "GLL", 3) == 0) {
+            return (nmea_sentence_type_gll_t);
+        } else if (memcmp(&address_p[2], "GSA", 3) == 0) {
+            return (nmea_sentence_type_gsa_t);
+        } else if (memcmp(&address_p[2], "GSV", 3) == 0) {
+            return (nmea_sentence_type_gsv_t);
+        } else if (memcmp(&address_p[2], "RMC", 3) == 0) {
+            return (nmea_sentence_type_rmc_t);
+        } else if (memcmp(&address_p[2], "VTG", 3) == 0) {
+            return (nmea_sentence_type_vtg_t);
+        }
+    }
+
+    return (nmea_sentence_type_raw_t);
+}
+
+/**
+ * Get given field, or NULL if missing.
+ */
+static char *decoder_field(struct nmea_decoder_t *self_p,
+                           int index)
+{
+    if (index >= self_p->number_of_fields) {
+        return (NULL);
+    }
+
+    return (&self_p->buf[self_p->fields[index]]);
+}
+
+/**
+ * Start a new field. The field separator is replaced by a
+ * null-termination in all but raw sentences.
+ */
+static int decoder_field_start(struct nmea_decoder_t *self_p)
+{
+    if (self_p->number_of_fields == NMEA_DECODER_FIELDS_MAX) {
+        return (-ENOMEM);
+    }
+
+    if (self_p->type != nmea_sentence_type_raw_t) {
+        self_p->buf[self_p->size - 1] = '\0';
+    }
+
+    self_p->fields[self_p->number_of_fields] = self_p->size;
+    self_p->number_of_fields++;
+
+    return (0);
+}
+
+/**
+ * Assign the decoded fields to given sentence.
+ */
+static int decoder_assign(struct nmea_decoder_t *self_p,
+                          struct nmea_sentence_t *dst_p)
+{
+    int i;
+    char *last_p;
+
+    dst_p->type = self_p->type;
+
+    switch (self_p->type) {
+
+    case nmea_sentence_type_gga_t:
+        dst_p->gga.time_of_fix_p = decoder_field(self_p, 1);
+        dst_p->gga.latitude.angle_p = decoder_field(self_p, 2);
+        dst_p->gga.latitude.direction_p = decoder_field(self_p, 3);
+        dst_p->gga.longitude.angle_p = decoder_field(self_p, 4);
+        dst_p->gga.longitude.direction_p = decoder_field(self_p, 5);
+        dst_p->gga.fix_quality_p = decoder_field(self_p, 6);
+        dst_p->gga.number_of_tracked_satellites_p = decoder_field(self_p, 7);
+        dst_p->gga.horizontal_dilution_of_position_p = decoder_field(self_p, 8);
+        dst_p->gga.altitude.value_p = decoder_field(self_p, 9);
+        dst_p->gga.altitude.unit_p = decoder_field(self_p, 10);
+        dst_p->gga.height_of_geoid.value_p = decoder_field(self_p, 11);
+        dst_p->gga.height_of_geoid.unit_p = decoder_field(self_p, 12);
+        last_p = decoder_field(self_p, 14);
+        break;
+
+    case nmea_sentence_type_gll_t:
+        dst_p->gll.latitude.angle_p = decoder_field(self_p, 1);
+        dst_p->gll.latitude.direction_p = decoder_field(self_p, 2);
+        dst_p->gll.longitude.angle_p = decoder_field(self_p, 3);
+        dst_p->gll.longitude.direction_p = decoder_field(self_p, 4);
+        dst_p->gll.time_of_fix_p = decoder_field(self_p, 5);
+        dst_p->gll.data_active_p = decoder_field(self_p, 6);
+        last_p = decoder_field(self_p, 7);
+        break;
+
+    case nmea_sentence_type_gsa_t:
+        dst_p->gsa.selection_p = decoder_field(self_p, 1);
+        dst_p->gsa.fix_p = decoder_field(self_p, 2);
+
+        for (i = 0; i < membersof(dst_p->gsa.prns); i++) {
+            dst_p->gsa.prns[i] = decoder_field(self_p, 3 + i);
+        }
+
+        dst_p->gsa.pdop_p = decoder_field(self_p, 15);
+        dst_p->gsa.hdop_p = decoder_field(self_p, 16);
+        last_p = decoder_field(self_p, 17);
+        dst_p->gsa.vdop_p = last_p;
+        break;
+
+    case nmea_sentence_type_gsv_t:
+        dst_p->gsv.number_of_sentences_p = decoder_field(self_p, 1);
+        dst_p->gsv.sentence_p = decoder_field(self_p, 2);
+        dst_p->gsv.number_of_satellites_p = decoder_field(self_p, 3);
+
+        for (i = 0; i < membersof(dst_p->gsv.satellites); i++) {
+            dst_p->gsv.satellites[i].prn_p = decoder_field(self_p, 4 + 4 * i);
+            dst_p->gsv.satellites[i].elevation_p =
+                decoder_field(self_p, 5 + 4 * i);
+            dst_p->gsv.satellites[i].azimuth_p =
+                decoder_field(self_p, 6 + 4 * i);
+            dst_p->gsv.satellites[i].snr_p = decoder_field(self_p, 7 + 4 * i);
+        }
+
+        last_p = dst_p->gsv.satellites[3].snr_p;
+        break;
+
+    case nmea_sentence_type_rmc_t:
+        dst_p->rmc.time_of_fix_p = decoder_field(self_p, 1);
+        dst_p->rmc.status_p = decoder_field(self_p, 2);
+        dst_p->rmc.latitude.angle_p = decoder_field(self_p, 3);
+        dst_p->rmc.latitude.direction_p = decoder_field(self_p, 4);
+        dst_p->rmc.longitude.angle_p = decoder_field(self_p, 5);
+        dst_p->rmc.longitude.direction_p = decoder_field(self_p, 6);
+        dst_p->rmc.speed_knots_p = decoder_field(self_p, 7);
+        dst_p->rmc.track_angle_p = decoder_field(self_p, 8);
+        dst_p->rmc.date_p = decoder_field(self_p, 9);
+        dst_p->rmc.magnetic_variation.angle_p = decoder_field(self_p, 10);
+        last_p = decoder_field(self_p, 11);
+        dst_p->rmc.magnetic_variation.direction_p = last_p;
+        break;
+
+    case nmea_sentence_type_vtg_t:
+        dst_p->vtg.track_made_good_true.value_p = decoder_field(self_p, 1);
+        dst_p->vtg.track_made_good_true.relative_to_p =
+            decoder_field(self_p, 2);
+        dst_p->vtg.track_made_good_magnetic.value_p = decoder_field(self_p, 3);
+        dst_p->vtg.track_made_good_magnetic.relative_to_p =
+            decoder_field(self_p, 4);
+        dst_p->vtg.ground_speed_knots.value_p = decoder_field(self_p, 5);
+        dst_p->vtg.ground_speed_knots.unit_p = decoder_field(self_p, 6);
+        dst_p->vtg.ground_speed_kmph.value_p = decoder_field(self_p, 7);
+        last_p = decoder_field(self_p, 8);
+        dst_p->vtg.ground_speed_kmph.unit_p = last_p;
+        break;
+
+    default:
+        dst_p->raw.str_p = &self_p->buf[0];
+        last_p = dst_p->raw.str_p;
+        break;
+    }
+
+    /* All values found? */
+    if (last_p == NULL) {
+        return (-EPROTO);
+    }
+
+    return (1);
+}
+
+/**
+ * The address field has been received. Returns zero(0) if the
+ * sentence shall be decoded, one(1) if it shall be skipped, or
+ * negative error code.
+ */
+static int decoder_address_end(struct nmea_decoder_t *self_p,
+                               size_t size)
+{
+    /* Only GNSS talkers are supported. */
+    if (self_p->buf[0] != 'G') {
+        return (-EPROTO);
+    }
+
+    self_p->type = decoder_type(&self_p->buf[0], size);
+
+    if ((self_p->types_mask & NMEA_SENTENCE_TYPE_MASK(self_p->type)) == 0) {
+        return (1);
+    }
+
+    self_p->state = DECODER_STATE_FIELDS;
+
+    return (0);
+}
+
+/**
+ * Decode given checksum character.
+ */
+static int decoder_crc_digit(char byte)
+{
+    if ((byte >= '0') && (byte <= '9')) {
+        return (byte - '0');
+    } else if ((byte >= 'A') && (byte <= 'F')) {
+        return (byte - 'A' + 10);
+    } else if ((byte >= 'a') && (byte <= 'f')) {
+        return (byte - 'a' + 10);
+    }
+
+    return (-EPROTO);
+}
+
+int nmea_decoder_init(struct nmea_decoder_t *self_p,
+                      uint32_t types_mask)
+{
+    ASSERTN(self_p != NULL, EINVAL);
+
+    self_p->types_mask = types_mask;
+    self_p->state = DECODER_STATE_START;
+
+    return (0);
+}
+
+int nmea_decoder_input(struct nmea_decoder_t *self_p,
+                       char byte,
+                       struct nmea_sentence_t *dst_p)
+{
+    ASSERTN(self_p != NULL, EINVAL);
+    ASSERTN(dst_p != NULL, EINVAL);
+
+    int res;
+    int digit;
+
+    switch (self_p->state) {
+
+    case DECODER_STATE_START:
+        break;
+
+    case DECODER_STATE_ADDRESS:
+    case DECODER_STATE_FIELDS:
+        if (byte == '*') {
+            if (self_p->state == DECODER_STATE_ADDRESS) {
+                res = decoder_address_end(self_p, self_p->size);
+
+                if (res != 0) {
+                    self_p->state = DECODER_STATE_START;
+
+                    return (res < 0 ? res : 0);
+                }
+            }
+
+            self_p->buf[self_p->size] = '\0';
+            self_p->state = DECODER_STATE_CRC_HIGH;
+
+            return (0);
+        }
+
+        /* Space for the read character, a dollar sign and a
+           null-termination. */
+        if ((self_p->size + 2) == sizeof(self_p->buf)) {
+            self_p->state = DECODER_STATE_START;
+
+            return (-ENOMEM);
+        }
+
+        self_p->buf[self_p->size] = byte;
+        self_p->size++;
+        self_p->crc ^= byte;
+
+        if (byte != ',') {
+            return (0);
+        }
+
+        /* Skip unwanted sentences as soon as the type is known. */
+        if (self_p->state == DECODER_STATE_ADDRESS) {
+            res = decoder_address_end(self_p, self_p->size - 1);
+
+            if (res != 0) {
+                self_p->state = DECODER_STATE_START;
+
+                return (res < 0 ? res : 0);
+            }
+        }
+
+        if (decoder_field_start(self_p) != 0) {
+            self_p->state = DECODER_STATE_START;
+
+            return (-ENOMEM);
+        }
+
+        return (0);
+
+    case DECODER_STATE_CRC_HIGH:
+    case DECODER_STATE_CRC_LOW:
+        digit = decoder_crc_digit(byte);
+
+        if (digit < 0) {
+            break;
+        }
+
+        self_p->expected_crc = ((self_p->expected_crc << 4) | digit);
+        self_p->state++;
+
+        return (0);
+
+    case DECODER_STATE_CR:
+        if (byte != '\r') {
+            break;
+        }
+
+        self_p->state = DECODER_STATE_LF;
+
+        return (0);
+
+    case DECODER_STATE_LF:
+        if (byte != '\n') {
+            break;
+        }
+
+        self_p->state = DECODER_STATE_START;
+
+        if (self_p->crc != self_p->expected_crc) {
+            return (-EPROTO);
+        }
+
+        return (decoder_assign(self_p, dst_p));
+
+    default:
+        break;
+    }
+
+    /* Protocol error in the checksum or line termination. */
+    res = 0;
+
+    if (self_p->state != DECODER_STATE_START) {
+        self_p->state = DECODER_STATE_START;
+        res = -EPROTO;
+    }
+
+    /* Find the start of a sentence. */
+    if (byte == '$') {
+        self_p->state = DECODER_STATE_ADDRESS;
+        self_p->type = nmea_sentence_type_raw_t;
+        self_p->crc = 0;
+        self_p->expected_crc = 0;
+        self_p->size = 0;
+        self_p->number_of_fields = 1;
+        self_p->fields[0] = 0;
+    }
+
+    return (res);
+}
+
+/**
+ * Size of given fix time or date string, excluding any sub-seconds.
+ */
+static size_t triple_size(const char *src_p)
+{
+    return (strcspn(src_p, "."));
+}
+
 int nmea_decode_fix_time(char *src_p,
                          int *hour_p,
                          int *minute_p,
@@ -605,7 +1087,16 @@ int nmea_decode_fix_time(char *src_p,
     ASSERTN(minute_p != NULL, EINVAL);
     ASSERTN(second_p != NULL, EINVAL);
 
-    return (decode_triple(src_p, hour_p, minute_p, second_p));
+    size_t size;
+
+    /* Discard any sub-seconds. */
+    size = triple_size(src_p);
+
+    if (size != 6) {
+        return (-EPROTO);
+    }
+
+    return (decode_triple(src_p, size, hour_p, minute_p, second_p, NULL));
 }
 
 int nmea_decode_date(char *src_p,
@@ -618,7 +1109,15 @@ int nmea_decode_date(char *src_p,
     ASSERTN(month_p != NULL, EINVAL);
     ASSERTN(date_p != NULL, EINVAL);
 
-    return (decode_triple(src_p, date_p, month_p, year_p));
+    size_t size;
+
+    size = triple_size(src_p);
+
+    if (size != 6) {
+        return (-EPROTO);
+    }
+
+    return (decode_triple(src_p, size, date_p, month_p, year_p, NULL));
 }
 
 int nmea_decode_position(struct nmea_position_t *src_p,
@@ -627,56 +1126,277 @@ int nmea_decode_position(struct nmea_position_t *src_p,
     ASSERTN(src_p != NULL, EINVAL);
     ASSERTN(degrees_p != NULL, EINVAL);
 
-    size_t pos;
-    size_t minutes_pos;
-    long degrees;
-    long minutes;
-    char *angle_p;
-    char *direction_p;
-    const char *minutes_end_p;
+    return (decode_position(src_p->angle_p,
+                            strlen(src_p->angle_p),
+                            src_p->direction_p[0],
+                            degrees_p));
+}
 
-    angle_p = src_p->angle_p;
-    direction_p = src_p->direction_p;
+ssize_t nmea_decode_view(struct nmea_view_t *dst_p,
+                         const char *src_p,
+                         size_t size)
+{
+    ASSERTN(dst_p != NULL, EINVAL);
+    ASSERTN(src_p != NULL, EINVAL);
 
-    pos = strcspn(angle_p, ".");
+    size_t i;
+    size_t end;
+    int high;
+    int low;
+    struct nmea_field_t *field_p;
 
-    /* The string must contain a dot at position 4 or later. */
-    if ((angle_p[pos] == '\0') || (pos < 4)) {
+    /* Basic validation of the sentence. */
+    if ((size < 7)
+        || (src_p[0] != '$')
+        || (src_p[1] != 'G')
+        || (src_p[size - 5] != '*')
+        || (src_p[size - 2] != '\r')
+        || (src_p[size - 1] != '\n')) {
         return (-EPROTO);
     }
 
-    minutes_pos = (pos - 2);
+    /* The field offsets are 8 bits. */
+    if (size > 255) {
+        return (-ENOMEM);
+    }
+
+    /* Check the CRC. */
+    end = (size - 5);
+    high = decoder_crc_digit(src_p[end + 1]);
+    low = decoder_crc_digit(src_p[end + 2]);
+
+    if ((high < 0) || (low < 0)) {
+        return (-EPROTO);
+    }
+
+    if (calculate_crc(&src_p[1], end - 1) != ((high << 4) | low)) {
+        return (-EPROTO);
+    }
+
+    /* Split the sentence into fields in one pass. */
+    dst_p->sentence_p = src_p;
+    field_p = &dst_p->fields[0];
+    field_p->offset = 1;
+    dst_p->number_of_fields = 1;
+
+    for (i = 1; i < end; i++) {
+        if (src_p[i] != ',') {
+            continue;
+        }
+
+        if (dst_p->number_of_fields == NMEA_DECODER_FIELDS_MAX) {
+            return (-ENOMEM);
+        }
+
+        field_p->size = (i - field_p->offset);
+        field_p++;
+        field_p->offset = (i + 1);
+        dst_p->number_of_fields++;
+    }
+
+    field_p->size = (end - field_p->offset);
+    dst_p->type = decoder_type(&src_p[1], dst_p->fields[0].size);
+
+    return (dst_p->number_of_fields);
+}
+
+const char *nmea_view_field(struct nmea_view_t *self_p,
+                            int index,
+                            size_t *size_p)
+{
+    ASSERTNRN(self_p != NULL, EINVAL);
+    ASSERTNRN(size_p != NULL, EINVAL);
+
+    if ((index < 0) || (index >= self_p->number_of_fields)) {
+        return (NULL);
+    }
+
+    *size_p = self_p->fields[index].size;
 
-    /* Minutes. */
-    minutes_end_p = std_strtodfp(&angle_p[minutes_pos], &minutes, 6);
+    return (&self_p->sentence_p[self_p->fields[index].offset]);
+}
+
+/**
+ * Get given non-empty field in given view.
+ */
+static int view_field(struct nmea_view_t *self_p,
+                      int index,
+                      const char **buf_pp,
+                      size_t *size_p)
+{
+    *buf_pp = nmea_view_field(self_p, index, size_p);
 
-    if (minutes_end_p == NULL) {
+    if (*buf_pp == NULL) {
         return (-EPROTO);
     }
 
-    /* Only truncated digits may be left in the string. */
-    pos = strspn(minutes_end_p, "0123456789");
+    if (*size_p == 0) {
+        return (-ENODATA);
+    }
 
-    if (minutes_end_p[pos] != '\0') {
+    return (0);
+}
+
+int nmea_view_decode_fix_time(struct nmea_view_t *self_p,
+                              int index,
+                              int *hour_p,
+                              int *minute_p,
+                              int *second_p,
+                              int *millisecond_p)
+{
+    ASSERTN(self_p != NULL, EINVAL);
+    ASSERTN(hour_p != NULL, EINVAL);
+    ASSERTN(minute_p != NULL, EINVAL);
+    ASSERTN(second_p != NULL, EINVAL);
+    ASSERTN(millisecond_p != NULL, EINVAL);
+
+    int res;
+    const char *buf_p;
+    size_t size;
+
+    res = view_field(self_p, index, &buf_p, &size);
+
+    if (res != 0) {
+        return (res);
+    }
+
+    return (decode_triple(buf_p,
+                          size,
+                          hour_p,
+                          minute_p,
+                          second_p,
+                          millisecond_p));
+}
+
+int nmea_view_decode_date(struct nmea_view_t *self_p,
+                          int index,
+                          int *year_p,
+                          int *month_p,
+                          int *date_p)
+{
+    ASSERTN(self_p != NULL, EINVAL);
+    ASSERTN(year_p != NULL, EINVAL);
+    ASSERTN(month_p != NULL, EINVAL);
+    ASSERTN(date_p != NULL, EINVAL);
+
+    int res;
+    const char *buf_p;
+    size_t size;
+
+    res = view_field(self_p, index, &buf_p, &size);
+
+    if (res != 0) {
+        return (res);
+    }
+
+    if (size != 6) {
         return (-EPROTO);
     }
 
-    /* Degrees. */
-    angle_p[minutes_pos] = '\0';
+    return (decode_triple(buf_p, size, date_p, month_p, year_p, NULL));
+}
+
+int nmea_view_decode_position(struct nmea_view_t *self_p,
+                              int index,
+                              long *degrees_p)
+{
+    ASSERTN(self_p != NULL, EINVAL);
+    ASSERTN(degrees_p != NULL, EINVAL);
+
+    int res;
+    const char *angle_p;
+    size_t angle_size;
+    const char *direction_p;
+    size_t direction_size;
+
+    res = view_field(self_p, index, &angle_p, &angle_size);
+
+    if (res != 0) {
+        return (res);
+    }
+
+    res = view_field(self_p, index + 1, &direction_p, &direction_size);
+
+    if (res != 0) {
+        return (res);
+    }
 
-    if (std_strtolb(&angle_p[0], &degrees, 10) != &angle_p[minutes_pos]) {
+    if (direction_size != 1) {
         return (-EPROTO);
     }
 
-    *degrees_p = ((degrees * 1000000) + (minutes / 60));
+    return (decode_position(angle_p, angle_size, direction_p[0], degrees_p));
+}
 
-    /* Positive sign for north and east, negtive for south and
-       west. */
-    if ((*direction_p == 'S') || (*direction_p == 'W')) {
-        *degrees_p *= -1;
-    } else if ((*direction_p != 'N') && (*direction_p != 'E')) {
+int nmea_view_decode_fixed(struct nmea_view_t *self_p,
+                           int index,
+                           int decimals,
+                           long *value_p)
+{
+    ASSERTN(self_p != NULL, EINVAL);
+    ASSERTN(decimals >= 0, EINVAL);
+    ASSERTN(value_p != NULL, EINVAL);
+
+    int res;
+    const char *buf_p;
+    size_t size;
+    size_t pos;
+    long integer;
+    long fraction;
+    long scale;
+    int i;
+    int negative;
+
+    res = view_field(self_p, index, &buf_p, &size);
+
+    if (res != 0) {
+        return (res);
+    }
+
+    negative = (buf_p[0] == '-');
+
+    if (negative) {
+        buf_p++;
+        size--;
+    }
+
+    pos = 0;
+
+    while ((pos < size) && (buf_p[pos] != '.')) {
+        pos++;
+    }
+
+    /* At least one integer digit. */
+    if (pos == 0) {
+        return (-EPROTO);
+    }
+
+    if (parse_digits(&buf_p[0], pos, &integer) != 0) {
         return (-EPROTO);
     }
 
+    fraction = 0;
+
+    if (pos < size) {
+        if (parse_fraction(&buf_p[pos + 1],
+                           size - pos - 1,
+                           decimals,
+                           &fraction) != 0) {
+            return (-EPROTO);
+        }
+    }
+
+    scale = 1;
+
+    for (i = 0; i < decimals; i++) {
+        scale *= 10;
+    }
+
+    *value_p = (integer * scale + fraction);
+
+    if (negative) {
+        *value_p *= -1;
+    }
+
     return (0);
 }
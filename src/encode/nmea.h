@@ -36,6 +36,21 @@
 #define NMEA_KNOTS_TO_METERS_PER_SECOND(knots) \
     DIV_ROUND((51444L * knots), 100000L)
 
+/* Maximum number of fields in a sentence decoded by the incremental
+   decoder, including the address field. */
+#define NMEA_DECODER_FIELDS_MAX                            24
+
+/**
+ * Sentence type mask bit of given sentence type.
+ */
+#define NMEA_SENTENCE_TYPE_MASK(type) (1UL << (type))
+
+/**
+ * Sentence type mask with all sentence types.
+ */
+#define NMEA_SENTENCE_TYPE_MASK_ALL \
+    (NMEA_SENTENCE_TYPE_MASK(nmea_sentence_type_max_t) - 1)
+
 struct nmea_position_t {
     char *angle_p;
     char *direction_p;
@@ -163,6 +178,44 @@ struct nmea_sentence_t {
     };
 };
 
+/**
+ * A field in a sentence view.
+ */
+struct nmea_field_t {
+    /* Offset of the field in the sentence. */
+    uint8_t offset;
+    /* Number of characters in the field. */
+    uint8_t size;
+};
+
+/**
+ * A sentence decoded as offsets and sizes of its fields in the
+ * original sentence string, which is not modified. Field zero is the
+ * address field, for example ``GPGGA``, followed by the data fields
+ * in the order defined by the NMEA standard.
+ */
+struct nmea_view_t {
+    const char *sentence_p;
+    enum nmea_sentence_type_t type;
+    int number_of_fields;
+    struct nmea_field_t fields[NMEA_DECODER_FIELDS_MAX];
+};
+
+/**
+ * An incremental NMEA decoder.
+ */
+struct nmea_decoder_t {
+    uint32_t types_mask;
+    int8_t state;
+    int8_t type;
+    uint8_t crc;
+    uint8_t expected_crc;
+    uint8_t size;
+    uint8_t number_of_fields;
+    uint8_t fields[NMEA_DECODER_FIELDS_MAX];
+    char buf[NMEA_SENTENCE_SIZE_MAX];
+};
+
 /**
  * Encode given NMEA sentence into given buffer.
  *
@@ -194,6 +247,151 @@ ssize_t nmea_decode(struct nmea_sentence_t *dst_p,
                     char *src_p,
                     size_t size);
 
+/**
+ * Decode given NMEA sentence into given view without copying or
+ * modifying the sentence. This is faster than `nmea_decode()`, and
+ * the view fields can be converted to integers with the
+ * `nmea_view_decode_*()` functions.
+ *
+ * @param[out] dst_p Decoded view, with references to the sentence.
+ * @param[in] src_p Sentence to decode, starting with a dollar sign
+ *                  and ending with <CR><LF>. It does not have to be
+ *                  null-terminated.
+ * @param[in] size Number of bytes in the sentence to decode.
+ *
+ * @return Number of fields, including the address field, or negative
+ *         error code.
+ */
+ssize_t nmea_decode_view(struct nmea_view_t *dst_p,
+                         const char *src_p,
+                         size_t size);
+
+/**
+ * Get given field in given view. The field is not null-terminated.
+ *
+ * @param[in] self_p Decoded view.
+ * @param[in] index Field index, where zero(0) is the address field.
+ * @param[out] size_p Number of characters in the field.
+ *
+ * @return Pointer to the field in the sentence, or NULL if the
+ *         sentence has no such field.
+ */
+const char *nmea_view_field(struct nmea_view_t *self_p,
+                            int index,
+                            size_t *size_p);
+
+/**
+ * Decode given fix time field ``hhmmss[.s+]`` in given view. The
+ * output variables have not been modified if the decoding failed.
+ *
+ * @param[in] self_p Decoded view.
+ * @param[in] index Fix time field index.
+ * @param[out] hour_p Decoded hour.
+ * @param[out] minute_p Decoded minute.
+ * @param[out] second_p Decoded second.
+ * @param[out] millisecond_p Decoded millisecond, or zero(0) if the
+ *                           field has no sub-seconds.
+ *
+ * @return zero(0), -ENODATA if the field is empty, or other negative
+ *         error code.
+ */
+int nmea_view_decode_fix_time(struct nmea_view_t *self_p,
+                              int index,
+                              int *hour_p,
+                              int *minute_p,
+                              int *second_p,
+                              int *millisecond_p);
+
+/**
+ * Decode given date field ``ddmmyy`` in given view. The output
+ * variables have not been modified if the decoding failed.
+ *
+ * @param[in] self_p Decoded view.
+ * @param[in] index Date field index.
+ * @param[out] year_p Decoded year.
+ * @param[out] month_p Decoded month.
+ * @param[out] date_p Decoded date.
+ *
+ * @return zero(0), -ENODATA if the field is empty, or other negative
+ *         error code.
+ */
+int nmea_view_decode_date(struct nmea_view_t *self_p,
+                          int index,
+                          int *year_p,
+                          int *month_p,
+                          int *date_p);
+
+/**
+ * Decode given position angle field ``d{2,3}mm.m+`` and the
+ * direction field ``[NSEW]`` after it in given view, as
+ * `nmea_decode_position()`. The output variable has not been
+ * modified if the decoding failed.
+ *
+ * @param[in] self_p Decoded view.
+ * @param[in] index Angle field index.
+ * @param[out] degrees_p Decoded position in microdegrees.
+ *
+ * @return zero(0), -ENODATA if a field is empty, or other negative
+ *         error code.
+ */
+int nmea_view_decode_position(struct nmea_view_t *self_p,
+                              int index,
+                              long *degrees_p);
+
+/**
+ * Decode given decimal number field ``-?d+(.d*)?`` in given view as
+ * a fixed-point integer with given number of decimals. Further
+ * decimals are truncated. For example, ``545.4`` with two decimals
+ * is decoded as 54540. The output variable has not been modified if
+ * the decoding failed.
+ *
+ * @param[in] self_p Decoded view.
+ * @param[in] index Field index.
+ * @param[in] decimals Number of decimals.
+ * @param[out] value_p Decoded value.
+ *
+ * @return zero(0), -ENODATA if the field is empty, or other negative
+ *         error code.
+ */
+int nmea_view_decode_fixed(struct nmea_view_t *self_p,
+                           int index,
+                           int decimals,
+                           long *value_p);
+
+/**
+ * Initialize given incremental decoder.
+ *
+ * @param[out] self_p Decoder to initialize.
+ * @param[in] types_mask Sentence types to decode, a bitwise OR of
+ *                       `NMEA_SENTENCE_TYPE_MASK()` of each wanted
+ *                       type, or `NMEA_SENTENCE_TYPE_MASK_ALL`. Other
+ *                       sentences are skipped as soon as their
+ *                       address field has been decoded. Sentences of
+ *                       unknown types are of type raw.
+ *
+ * @return zero(0) or negative error code.
+ */
+int nmea_decoder_init(struct nmea_decoder_t *self_p,
+                      uint32_t types_mask);
+
+/**
+ * Decode given byte of an NMEA sentence. The checksum is calculated
+ * and the sentence is split into fields as the bytes arrive, so no
+ * complete sentence has to be buffered and decoded afterwards.
+ *
+ * @param[in] self_p Initialized decoder.
+ * @param[in] byte Byte to decode.
+ * @param[out] dst_p Decoded sentence if one(1) is returned. It has
+ *                   references to the decoder buffer, which are
+ *                   valid until the next call to this function.
+ *
+ * @return true(1) if a complete sentence was decoded, false(0) if
+ *         more bytes are needed, or negative error code.
+ */
+int nmea_decoder_input(struct nmea_decoder_t *self_p,
+                       char byte,
+                       struct nmea_sentence_t *dst_p);
+
 /**
  * Decode given NMEA fix time ``hhmmss``. The output variables have
  * not been modified if the decoding failed.
@@ -0,0 +1,2153 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2014-2018, Erik Moqvist
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use, copy,
+ * modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ * This file is part of the Simba project.
+ */
+
+/*
+ * A copy-on-write file system for NOR flash.
+ *
+ * Blocks 0 and 1 form the superblock metadata pair. Its tail points
+ * to the metadata pair of the root directory. A directory is a chain
+ * of metadata pairs, linked by their tails. A metadata block is
+ * rewritten as a whole on each commit, to the erased other block in
+ * the pair, and the block with the latest revision and a valid CRC is
+ * used. A pair is moved to a newly allocated block every
+ * CONFIG_COWFS_BLOCK_CYCLES commits, and the reference to it is
+ * updated in its parent.
+ *
+ * File data is stored in a backwards linked skip-list of blocks. The
+ * block with index n starts with pointers to the blocks with indexes
+ * n - 1, n - 2, n - 4, ..., n - 2^ctz(n), which makes seeking
+ * O(log(n)). Modified data is always written to new blocks, and the
+ * directory entry is updated when the file is synchronized.
+ *
+ * Free blocks are found by traversing the file system into a
+ * lookahead bitmap of CONFIG_COWFS_LOOKAHEAD blocks, starting at a
+ * pseudo random block when mounted.
+ */
+
+#include "simba.h"
+
+#if CONFIG_COWFS == 1
+
+#define BLOCK_NULL                                      0xffffffff
+
+#define TYPE_FILE                                                1
+#define TYPE_DIR                                                 2
+#define TYPE_SUPERBLOCK                                          3
+
+#define MAGIC                                              "cowfs"
+
+/* Internal file flags, in addition to FS_READ, FS_WRITE, FS_APPEND
+   and FS_SYNC. */
+#define F_DIRTY                                               0x10
+#define F_WRITING                                             0x20
+#define F_READING                                             0x40
+
+/* Return value of lookup() for the root directory. */
+#define LOOKUP_ROOT                                              2
+
+struct header_t {
+    uint32_t revision;
+    uint32_t size;
+    uint32_t tail[2];
+};
+
+struct entry_t {
+    uint8_t type;
+    uint8_t name_size;
+    uint16_t reserved;
+    uint32_t u[2];
+};
+
+#define ENTRIES_OFFSET                     sizeof(struct header_t)
+
+static int block_read(struct cowfs_t *self_p,
+                      uint32_t block,
+                      uint32_t off,
+                      void *dst_p,
+                      size_t size)
+{
+    if (flash_read(self_p->flash_p,
+                   dst_p,
+                   self_p->address + block * self_p->block_size + off,
+                   size) != size) {
+        return (-EIO);
+    }
+
+    return (0);
+}
+
+static int block_write(struct cowfs_t *self_p,
+                       uint32_t block,
+                       uint32_t off,
+                       const void *src_p,
+                       size_t size)
+{
+    if (flash_write(self_p->flash_p,
+                    self_p->address + block * self_p->block_size + off,
+                    src_p,
+                    size) != size) {
+        return (-EIO);
+    }
+
+    return (0);
+}
+
+static int block_erase(struct cowfs_t *self_p, uint32_t block)
+{
+    if (flash_erase(self_p->flash_p,
+                    self_p->address + block * self_p->block_size,
+                    self_p->block_size) != 0) {
+        return (-EIO);
+    }
+
+    return (0);
+}
+
+static int pair_equal(const uint32_t *a_p, const uint32_t *b_p)
+{
+    return (((a_p[0] == b_p[0]) && (a_p[1] == b_p[1]))
+            || ((a_p[0] == b_p[1]) && (a_p[1] == b_p[0])));
+}
+
+static uint32_t entries_size_max(struct cowfs_t *self_p)
+{
+    return (self_p->block_size - sizeof(struct header_t) - sizeof(uint32_t));
+}
+
+/**
+ * Index of the skip-list block containing given file offset. The
+ * offset is replaced by the offset within the block.
+ */
+static uint32_t ctz_index(struct cowfs_t *self_p, size_t *off_p)
+{
+    size_t size;
+    uint32_t b;
+    uint32_t i;
+
+    size = *off_p;
+    b = (self_p->block_size - 2 * sizeof(uint32_t));
+    i = (size / b);
+
+    if (i == 0) {
+        return (0);
+    }
+
+    i = ((size - 4 * (__builtin_popcount(i - 1) + 2)) / b);
+    *off_p = (size - b * i - 4 * __builtin_popcount(i));
+
+    return (i);
+}
+
+static int ctz_find(struct cowfs_t *self_p,
+                    uint32_t head,
+                    uint32_t size,
+                    size_t pos,
+                    uint32_t *block_p,
+                    uint32_t *off_p)
+{
+    int res;
+    uint32_t current;
+    uint32_t target;
+    uint32_t skip;
+    size_t off;
+
+    if (size == 0) {
+        *block_p = BLOCK_NULL;
+        *off_p = 0;
+
+        return (0);
+    }
+
+    off = (size - 1);
+    current = ctz_index(self_p, &off);
+    off = pos;
+    target = ctz_index(self_p, &off);
+
+    /* Take the largest skip not passing the target. */
+    while (current > target) {
+        skip = MIN(31 - __builtin_clz(current - target),
+                   __builtin_ctz(current));
+        res = block_read(self_p, head, 4 * skip, &head, sizeof(head));
+
+        if (res != 0) {
+            return (res);
+        }
+
+        current -= (1 << skip);
+    }
+
+    *block_p = head;
+    *off_p = off;
+
+    return (0);
+}
+
+static void lookahead_mark(struct cowfs_t *self_p, uint32_t block)
+{
+    uint32_t off;
+
+    off = ((block + self_p->block_count - self_p->lookahead.start)
+           % self_p->block_count);
+
+    if (off < self_p->lookahead.size) {
+        self_p->lookahead.bits[off / 32] |= (1 << (off % 32));
+    }
+}
+
+static int ctz_traverse(struct cowfs_t *self_p,
+                        uint32_t head,
+                        uint32_t size)
+{
+    int res;
+    uint32_t index;
+    uint32_t heads[2];
+    size_t off;
+    int count;
+
+    if (size == 0) {
+        return (0);
+    }
+
+    off = (size - 1);
+    index = ctz_index(self_p, &off);
+
+    while (1) {
+        lookahead_mark(self_p, head);
+
+        if (index == 0) {
+            break;
+        }
+
+        /* Even indexes have at least two pointers. */
+        count = (2 - (index & 1));
+        res = block_read(self_p,
+                         head,
+                         0,
+                         &heads[0],
+                         count * sizeof(heads[0]));
+
+        if (res != 0) {
+            return (res);
+        }
+
+        if (count == 2) {
+            lookahead_mark(self_p, heads[0]);
+        }
+
+        head = heads[count - 1];
+        index -= count;
+    }
+
+    return (0);
+}
+
+static int mdir_fetch(struct cowfs_t *self_p,
+                      struct cowfs_mdir_t *mdir_p,
+                      const uint32_t *pair_p)
+{
+    int res;
+    int i;
+    int found;
+    struct header_t header;
+    uint32_t crc;
+    uint32_t stored_crc;
+    uint32_t off;
+    size_t size;
+    uint8_t buf[32];
+
+    found = 0;
+
+    for (i = 0; i < 2; i++) {
+        res = block_read(self_p, pair_p[i], 0, &header, sizeof(header));
+
+        if (res != 0) {
+            return (res);
+        }
+
+        if (header.size > entries_size_max(self_p)) {
+            continue;
+        }
+
+        if (found && ((int32_t)(header.revision - mdir_p->revision) <= 0)) {
+            continue;
+        }
+
+        crc = crc_32(0, &header, sizeof(header));
+
+        for (off = 0; off < header.size; off += size) {
+            size = MIN(sizeof(buf), header.size - off);
+            res = block_read(self_p,
+                             pair_p[i],
+                             ENTRIES_OFFSET + off,
+                             &buf[0],
+                             size);
+
+            if (res != 0) {
+                return (res);
+            }
+
+            crc = crc_32(crc, &buf[0], size);
+        }
+
+        res = block_read(self_p,
+                         pair_p[i],
+                         ENTRIES_OFFSET + header.size,
+                         &stored_crc,
+                         sizeof(stored_crc));
+
+        if (res != 0) {
+            return (res);
+        }
+
+        if (crc != stored_crc) {
+            continue;
+        }
+
+        found = 1;
+        mdir_p->pair[0] = pair_p[i];
+        mdir_p->pair[1] = pair_p[1 - i];
+        mdir_p->revision = header.revision;
+        mdir_p->size = header.size;
+        mdir_p->tail[0] = header.tail[0];
+        mdir_p->tail[1] = header.tail[1];
+    }
+
+    return (found ? 0 : -EIO);
+}
+
+/**
+ * Read the entry at given offset and advance the offset to the next
+ * entry.
+ *
+ * @return true(1) if an entry was read, false(0) at the end of the
+ *         metadata block, or negative error code.
+ */
+static int mdir_next(struct cowfs_t *self_p,
+                     const struct cowfs_mdir_t *mdir_p,
+                     uint32_t *off_p,
+                     struct entry_t *entry_p)
+{
+    int res;
+
+    if (*off_p >= mdir_p->size) {
+        return (0);
+    }
+
+    res = block_read(self_p,
+                     mdir_p->pair[0],
+                     ENTRIES_OFFSET + *off_p,
+                     entry_p,
+                     sizeof(*entry_p));
+
+    if (res != 0) {
+        return (res);
+    }
+
+    *off_p += (sizeof(*entry_p) + entry_p->name_size);
+
+    return (1);
+}
+
+static int mdir_read_name(struct cowfs_t *self_p,
+                          const struct cowfs_mdir_t *mdir_p,
+                          uint32_t off,
+                          const struct entry_t *entry_p,
+                          char *name_p)
+{
+    return (block_read(self_p,
+                       mdir_p->pair[0],
+                       ENTRIES_OFFSET + off + sizeof(*entry_p),
+                       name_p,
+                       entry_p->name_size));
+}
+
+/**
+ * Traverse all metadata pairs in given directory chain and all its
+ * files and sub-directories, and mark their blocks in the lookahead
+ * bitmap.
+ */
+static int traverse(struct cowfs_t *self_p, const uint32_t *pair_p)
+{
+    int res;
+    struct cowfs_mdir_t mdir;
+    struct entry_t entry;
+    uint32_t pair[2];
+    uint32_t off;
+
+    pair[0] = pair_p[0];
+    pair[1] = pair_p[1];
+
+    while (pair[0] != BLOCK_NULL) {
+        lookahead_mark(self_p, pair[0]);
+        lookahead_mark(self_p, pair[1]);
+        res = mdir_fetch(self_p, &mdir, &pair[0]);
+
+        if (res != 0) {
+            return (res);
+        }
+
+        off = 0;
+
+        while ((res = mdir_next(self_p, &mdir, &off, &entry)) == 1) {
+            if (entry.type == TYPE_FILE) {
+                res = ctz_traverse(self_p, entry.u[0], entry.u[1]);
+            } else if (entry.type == TYPE_DIR) {
+                res = traverse(self_p, &entry.u[0]);
+            } else {
+                res = 0;
+            }
+
+            if (res != 0) {
+                return (res);
+            }
+        }
+
+        if (res != 0) {
+            return (res);
+        }
+
+        pair[0] = mdir.tail[0];
+        pair[1] = mdir.tail[1];
+    }
+
+    return (0);
+}
+
+static int lookahead_fill(struct cowfs_t *self_p)
+{
+    int res;
+    uint32_t superblock[2] = { 0, 1 };
+    struct cowfs_file_t *file_p;
+
+    memset(&self_p->lookahead.bits[0], 0, sizeof(self_p->lookahead.bits));
+
+    res = traverse(self_p, &superblock[0]);
+
+    if (res != 0) {
+        return (res);
+    }
+
+    /* Blocks of open files that are not yet committed. */
+    file_p = self_p->files_p;
+
+    while (file_p != NULL) {
+        if (file_p->flags & F_DIRTY) {
+            res = ctz_traverse(self_p, file_p->head, file_p->size);
+
+            if (res != 0) {
+                return (res);
+            }
+        }
+
+        if (file_p->flags & F_WRITING) {
+            res = ctz_traverse(self_p, file_p->block, file_p->pos);
+
+            if (res != 0) {
+                return (res);
+            }
+        }
+
+        file_p = file_p->next_p;
+    }
+
+    return (0);
+}
+
+/**
+ * Blocks allocated after this call are not handed out again until
+ * all blocks in the file system have been searched. Called at the
+ * beginning of each operation that allocates blocks.
+ */
+static void alloc_ack(struct cowfs_t *self_p)
+{
+    self_p->lookahead.ack = self_p->block_count;
+}
+
+static int block_alloc(struct cowfs_t *self_p, uint32_t *block_p)
+{
+    int res;
+    uint32_t index;
+    uint32_t *bits_p;
+
+    bits_p = &self_p->lookahead.bits[0];
+
+    while (1) {
+        while (self_p->lookahead.index < self_p->lookahead.size) {
+            index = self_p->lookahead.index++;
+
+            if ((bits_p[index / 32] & (1 << (index % 32))) == 0) {
+                bits_p[index / 32] |= (1 << (index % 32));
+                *block_p = ((self_p->lookahead.start + index)
+                            % self_p->block_count);
+
+                return (0);
+            }
+        }
+
+        if (self_p->lookahead.ack == 0) {
+            return (-ENOSPC);
+        }
+
+        /* Move the lookahead window to the next blocks. */
+        self_p->lookahead.start = ((self_p->lookahead.start
+                                    + self_p->lookahead.size)
+                                   % self_p->block_count);
+        self_p->lookahead.size = MIN(CONFIG_COWFS_LOOKAHEAD,
+                                     self_p->lookahead.ack);
+        self_p->lookahead.ack -= self_p->lookahead.size;
+        self_p->lookahead.index = 0;
+
+        res = lookahead_fill(self_p);
+
+        if (res != 0) {
+            self_p->lookahead.size = 0;
+
+            return (res);
+        }
+    }
+}
+
+/**
+ * Copy one block to a newly allocated block, or create a new file
+ * skip-list block, appended after given head of the list with given
+ * size.
+ */
+static int ctz_extend(struct cowfs_t *self_p,
+                      uint32_t head,
+                      size_t size,
+                      uint32_t *block_p,
+                      uint32_t *off_p)
+{
+    int res;
+    uint32_t block;
+    uint32_t index;
+    uint32_t skips;
+    uint32_t i;
+    size_t off;
+    size_t n;
+    uint8_t buf[32];
+
+    res = block_alloc(self_p, &block);
+
+    if (res != 0) {
+        return (res);
+    }
+
+    res = block_erase(self_p, block);
+
+    if (res != 0) {
+        return (res);
+    }
+
+    if (size == 0) {
+        *block_p = block;
+        *off_p = 0;
+
+        return (0);
+    }
+
+    off = (size - 1);
+    index = ctz_index(self_p, &off);
+    off++;
+
+    /* Copy the partially written last block. */
+    if (off != self_p->block_size) {
+        for (i = 0; i < off; i += n) {
+            n = MIN(sizeof(buf), off - i);
+            res = block_read(self_p, head, i, &buf[0], n);
+
+            if (res == 0) {
+                res = block_write(self_p, block, i, &buf[0], n);
+            }
+
+            if (res != 0) {
+                return (res);
+            }
+        }
+
+        *block_p = block;
+        *off_p = off;
+
+        return (0);
+    }
+
+    /* Write the skip pointers in a new block. */
+    index++;
+    skips = (__builtin_ctz(index) + 1);
+
+    for (i = 0; i < skips; i++) {
+        res = block_write(self_p, block, 4 * i, &head, sizeof(head));
+
+        if ((res == 0) && (i != skips - 1)) {
+            res = block_read(self_p, head, 4 * i, &head, sizeof(head));
+        }
+
+        if (res != 0) {
+            return (res);
+        }
+    }
+
+    *block_p = block;
+    *off_p = (4 * skips);
+
+    return (0);
+}
+
+static int mdir_copy(struct cowfs_t *self_p,
+                     uint32_t src,
+                     uint32_t dst,
+                     uint32_t *dst_off_p,
+                     uint32_t off,
+                     uint32_t size,
+                     uint32_t *crc_p)
+{
+    int res;
+    uint8_t buf[32];
+    uint32_t n;
+
+    while (size > 0) {
+        n = MIN(sizeof(buf), size);
+        res = block_read(self_p, src, ENTRIES_OFFSET + off, &buf[0], n);
+
+        if (res == 0) {
+            res = block_write(self_p, dst, *dst_off_p, &buf[0], n);
+        }
+
+        if (res != 0) {
+            return (res);
+        }
+
+        *crc_p = crc_32(*crc_p, &buf[0], n);
+        *dst_off_p += n;
+        off += n;
+        size -= n;
+    }
+
+    return (0);
+}
+
+static int relocate(struct cowfs_t *self_p,
+                    const uint32_t *old_p,
+                    const uint32_t *new_p);
+
+/**
+ * Write a new revision of given metadata pair, with the entry of
+ * size old_size at offset off replaced by given entry, and
+ * optionally a new tail. An entry is deleted if entry_p is NULL, and
+ * inserted if old_size is zero.
+ */
+static int mdir_commit(struct cowfs_t *self_p,
+                       struct cowfs_mdir_t *mdir_p,
+                       uint32_t off,
+                       uint32_t old_size,
+                       const struct entry_t *entry_p,
+                       const char *name_p,
+                       const uint32_t *tail_p)
+{
+    int res;
+    struct header_t header;
+    uint32_t block;
+    uint32_t other;
+    uint32_t dst_off;
+    uint32_t crc;
+    uint32_t old[2];
+    int relocating;
+
+    header.revision = (mdir_p->revision + 1);
+    header.size = (mdir_p->size - old_size);
+
+    if (entry_p != NULL) {
+        header.size += (sizeof(*entry_p) + entry_p->name_size);
+    }
+
+    if (header.size > entries_size_max(self_p)) {
+        return (-ENOSPC);
+    }
+
+    if (tail_p == NULL) {
+        tail_p = &mdir_p->tail[0];
+    }
+
+    header.tail[0] = tail_p[0];
+    header.tail[1] = tail_p[1];
+
+    /* Wear level by moving the pair to two new blocks now and
+       then. The superblock is always in blocks 0 and 1. Both new
+       blocks are erased, as an old metadata block with a higher
+       revision must not be mistaken for the latest one. */
+    relocating = ((CONFIG_COWFS_BLOCK_CYCLES > 0)
+                  && ((header.revision % CONFIG_COWFS_BLOCK_CYCLES) == 0)
+                  && (mdir_p->pair[0] > 1));
+
+    if (relocating) {
+        res = block_alloc(self_p, &block);
+
+        if (res == 0) {
+            res = block_alloc(self_p, &other);
+        }
+
+        if (res == 0) {
+            res = block_erase(self_p, other);
+        }
+
+        if (res != 0) {
+            return (res);
+        }
+    } else {
+        block = mdir_p->pair[1];
+        other = mdir_p->pair[0];
+    }
+
+    res = block_erase(self_p, block);
+
+    if (res != 0) {
+        return (res);
+    }
+
+    res = block_write(self_p, block, 0, &header, sizeof(header));
+
+    if (res != 0) {
+        return (res);
+    }
+
+    crc = crc_32(0, &header, sizeof(header));
+    dst_off = ENTRIES_OFFSET;
+    res = mdir_copy(self_p, mdir_p->pair[0], block, &dst_off, 0, off, &crc);
+
+    if (res != 0) {
+        return (res);
+    }
+
+    if (entry_p != NULL) {
+        res = block_write(self_p, block, dst_off, entry_p, sizeof(*entry_p));
+
+        if (res != 0) {
+            return (res);
+        }
+
+        crc = crc_32(crc, entry_p, sizeof(*entry_p));
+        dst_off += sizeof(*entry_p);
+        res = block_write(self_p, block, dst_off, name_p, entry_p->name_size);
+
+        if (res != 0) {
+            return (res);
+        }
+
+        crc = crc_32(crc, name_p, entry_p->name_size);
+        dst_off += entry_p->name_size;
+    }
+
+    res = mdir_copy(self_p,
+                    mdir_p->pair[0],
+                    block,
+                    &dst_off,
+                    off + old_size,
+                    mdir_p->size - off - old_size,
+                    &crc);
+
+    if (res != 0) {
+        return (res);
+    }
+
+    res = block_write(self_p, block, dst_off, &crc, sizeof(crc));
+
+    if (res != 0) {
+        return (res);
+    }
+
+    old[0] = mdir_p->pair[0];
+    old[1] = mdir_p->pair[1];
+    mdir_p->pair[0] = block;
+    mdir_p->pair[1] = other;
+    mdir_p->revision = header.revision;
+    mdir_p->size = header.size;
+    mdir_p->tail[0] = header.tail[0];
+    mdir_p->tail[1] = header.tail[1];
+
+    if (relocating) {
+        res = relocate(self_p, &old[0], &mdir_p->pair[0]);
+    }
+
+    return (res);
+}
+
+/**
+ * Find the metadata pair referencing given pair, either as its tail
+ * or in a directory entry.
+ *
+ * @return true(1) if found as a tail, true(2) if found in an entry,
+ *         false(0) if not found, or negative error code.
+ */
+static int parent_find(struct cowfs_t *self_p,
+                       const uint32_t *chain_p,
+                       const uint32_t *pair_p,
+                       struct cowfs_mdir_t *mdir_p,
+                       uint32_t *off_p,
+                       struct entry_t *entry_p)
+{
+    int res;
+    uint32_t pair[2];
+    uint32_t off;
+
+    pair[0] = chain_p[0];
+    pair[1] = chain_p[1];
+
+    while (pair[0] != BLOCK_NULL) {
+        res = mdir_fetch(self_p, mdir_p, &pair[0]);
+
+        if (res != 0) {
+            return (res);
+        }
+
+        if (pair_equal(&mdir_p->tail[0], pair_p)) {
+            return (1);
+        }
+
+        off = 0;
+
+        while (1) {
+            *off_p = off;
+            res = mdir_next(self_p, mdir_p, &off, entry_p);
+
+            if (res <= 0) {
+                break;
+            }
+
+            if (entry_p->type != TYPE_DIR) {
+                continue;
+            }
+
+            if (pair_equal(&entry_p->u[0], pair_p)) {
+                return (2);
+            }
+
+            res = parent_find(self_p,
+                              &entry_p->u[0],
+                              pair_p,
+                              mdir_p,
+                              off_p,
+                              entry_p);
+
+            if (res != 0) {
+                return (res);
+            }
+
+            /* Fetch the current pair again after the recursion. */
+            res = mdir_fetch(self_p, mdir_p, &pair[0]);
+
+            if (res != 0) {
+                return (res);
+            }
+        }
+
+        if (res < 0) {
+            return (res);
+        }
+
+        pair[0] = mdir_p->tail[0];
+        pair[1] = mdir_p->tail[1];
+    }
+
+    return (0);
+}
+
+/**
+ * Update the reference to a moved metadata pair.
+ */
+static int relocate(struct cowfs_t *self_p,
+                    const uint32_t *old_p,
+                    const uint32_t *new_p)
+{
+    int res;
+    uint32_t superblock[2] = { 0, 1 };
+    struct cowfs_mdir_t mdir;
+    struct entry_t entry;
+    char name[255];
+    uint32_t off;
+    struct cowfs_file_t *file_p;
+
+    res = parent_find(self_p, &superblock[0], old_p, &mdir, &off, &entry);
+
+    if (res == 1) {
+        res = mdir_commit(self_p, &mdir, mdir.size, 0, NULL, NULL, new_p);
+    } else if (res == 2) {
+        res = mdir_read_name(self_p, &mdir, off, &entry, &name[0]);
+
+        if (res == 0) {
+            entry.u[0] = new_p[0];
+            entry.u[1] = new_p[1];
+            res = mdir_commit(self_p,
+                              &mdir,
+                              off,
+                              sizeof(entry) + entry.name_size,
+                              &entry,
+                              &name[0],
+                              NULL);
+        }
+    } else if (res == 0) {
+        res = -EIO;
+    }
+
+    if (res != 0) {
+        return (res);
+    }
+
+    if (pair_equal(&self_p->root[0], old_p)) {
+        self_p->root[0] = new_p[0];
+        self_p->root[1] = new_p[1];
+    }
+
+    for (file_p = self_p->files_p; file_p != NULL; file_p = file_p->next_p) {
+        if (pair_equal(&file_p->dir[0], old_p)) {
+            file_p->dir[0] = new_p[0];
+            file_p->dir[1] = new_p[1];
+        }
+    }
+
+    return (0);
+}
+
+/**
+ * Allocate and erase one block of a new metadata pair. The other
+ * block is erased by the first commit.
+ */
+static int mdir_create(struct cowfs_t *self_p, struct cowfs_mdir_t *mdir_p)
+{
+    int res;
+
+    res = block_alloc(self_p, &mdir_p->pair[0]);
+
+    if (res != 0) {
+        return (res);
+    }
+
+    res = block_alloc(self_p, &mdir_p->pair[1]);
+
+    if (res != 0) {
+        return (res);
+    }
+
+    mdir_p->revision = 0;
+    mdir_p->size = 0;
+    mdir_p->tail[0] = BLOCK_NULL;
+    mdir_p->tail[1] = BLOCK_NULL;
+
+    return (block_erase(self_p, mdir_p->pair[0]));
+}
+
+/**
+ * Find given name in given directory chain.
+ *
+ * @return true(1) if found, with mdir_p set to the pair of the entry,
+ *         false(0) if not found, with mdir_p set to the last pair in
+ *         the chain, or negative error code.
+ */
+static int chain_find(struct cowfs_t *self_p,
+                      const uint32_t *chain_p,
+                      const char *name_p,
+                      size_t name_size,
+                      struct cowfs_mdir_t *mdir_p,
+                      uint32_t *off_p,
+                      struct entry_t *entry_p)
+{
+    int res;
+    uint32_t pair[2];
+    uint32_t off;
+    char name[CONFIG_COWFS_NAME_MAX];
+
+    pair[0] = chain_p[0];
+    pair[1] = chain_p[1];
+
+    while (1) {
+        res = mdir_fetch(self_p, mdir_p, &pair[0]);
+
+        if (res != 0) {
+            return (res);
+        }
+
+        off = 0;
+
+        while (1) {
+            *off_p = off;
+            res = mdir_next(self_p, mdir_p, &off, entry_p);
+
+            if (res <= 0) {
+                break;
+            }
+
+            if (entry_p->name_size != name_size) {
+                continue;
+            }
+
+            res = mdir_read_name(self_p, mdir_p, *off_p, entry_p, &name[0]);
+
+            if (res != 0) {
+                return (res);
+            }
+
+            if (memcmp(&name[0], name_p, name_size) == 0) {
+                return (1);
+            }
+        }
+
+        if (res < 0) {
+            return (res);
+        }
+
+        if (mdir_p->tail[0] == BLOCK_NULL) {
+            return (0);
+        }
+
+        pair[0] = mdir_p->tail[0];
+        pair[1] = mdir_p->tail[1];
+    }
+}
+
+/**
+ * Add given entry to the last metadata pair in a directory chain, or
+ * to a new pair linked to it if full.
+ */
+static int chain_insert(struct cowfs_t *self_p,
+                        struct cowfs_mdir_t *last_p,
+                        const struct entry_t *entry_p,
+                        const char *name_p)
+{
+    int res;
+    struct cowfs_mdir_t mdir;
+
+    res = mdir_commit(self_p, last_p, last_p->size, 0, entry_p, name_p, NULL);
+
+    if (res != -ENOSPC) {
+        return (res);
+    }
+
+    res = mdir_create(self_p, &mdir);
+
+    if (res != 0) {
+        return (res);
+    }
+
+    res = mdir_commit(self_p, &mdir, 0, 0, entry_p, name_p, NULL);
+
+    if (res != 0) {
+        return (res);
+    }
+
+    return (mdir_commit(self_p,
+                        last_p,
+                        last_p->size,
+                        0,
+                        NULL,
+                        NULL,
+                        &mdir.pair[0]));
+}
+
+/**
+ * Find given path.
+ *
+ * @return true(1) if found, false(0) if only the last path component
+ *         is missing, LOOKUP_ROOT for the root directory, or negative
+ *         error code. The first pair of the directory, the last path
+ *         component and the pair with the entry, or the last pair of
+ *         the directory if not found, are always set if zero or one
+ *         is returned.
+ */
+static int lookup(struct cowfs_t *self_p,
+                  const char *path_p,
+                  uint32_t *dir_p,
+                  const char **name_pp,
+                  size_t *name_size_p,
+                  struct cowfs_mdir_t *mdir_p,
+                  uint32_t *off_p,
+                  struct entry_t *entry_p)
+{
+    int res;
+    size_t size;
+
+    dir_p[0] = self_p->root[0];
+    dir_p[1] = self_p->root[1];
+
+    while (*path_p == '/') {
+        path_p++;
+    }
+
+    if (*path_p == '\0') {
+        return (LOOKUP_ROOT);
+    }
+
+    while (1) {
+        size = strcspn(path_p, "/");
+
+        if (size > CONFIG_COWFS_NAME_MAX) {
+            return (-ENAMETOOLONG);
+        }
+
+        res = chain_find(self_p, dir_p, path_p, size, mdir_p, off_p, entry_p);
+
+        if (res < 0) {
+            return (res);
+        }
+
+        *name_pp = path_p;
+        *name_size_p = size;
+        path_p += size;
+
+        while (*path_p == '/') {
+            path_p++;
+        }
+
+        if (*path_p == '\0') {
+            return (res);
+        }
+
+        if (res == 0) {
+            return (-ENOENT);
+        }
+
+        if (entry_p->type != TYPE_DIR) {
+            return (-ENOTDIR);
+        }
+
+        dir_p[0] = entry_p->u[0];
+        dir_p[1] = entry_p->u[1];
+    }
+}
+
+static int file_commit(struct cowfs_file_t *file_p)
+{
+    int res;
+    struct cowfs_t *self_p;
+    struct cowfs_mdir_t mdir;
+    struct entry_t entry;
+    uint32_t off;
+
+    self_p = file_p->cowfs_p;
+    res = chain_find(self_p,
+                     &file_p->dir[0],
+                     &file_p->name[0],
+                     file_p->name_size,
+                     &mdir,
+                     &off,
+                     &entry);
+
+    if (res == 0) {
+        res = -ENOENT;
+    }
+
+    if (res < 0) {
+        return (res);
+    }
+
+    entry.u[0] = file_p->head;
+    entry.u[1] = file_p->size;
+
+    return (mdir_commit(self_p,
+                        &mdir,
+                        off,
+                        sizeof(entry) + entry.name_size,
+                        &entry,
+                        &file_p->name[0],
+                        NULL));
+}
+
+static ssize_t file_write_data(struct cowfs_file_t *file_p,
+                               const uint8_t *buf_p,
+                               size_t size)
+{
+    int res;
+    struct cowfs_t *self_p;
+    size_t left;
+    size_t n;
+
+    self_p = file_p->cowfs_p;
+    left = size;
+
+    while (left > 0) {
+        if (!(file_p->flags & F_WRITING)
+            || (file_p->off == self_p->block_size)) {
+            /* Continue after the block containing the byte before
+               the current position. */
+            if (!(file_p->flags & F_WRITING) && (file_p->pos > 0)) {
+                res = ctz_find(self_p,
+                               file_p->head,
+                               file_p->size,
+                               file_p->pos - 1,
+                               &file_p->block,
+                               &file_p->off);
+
+                if (res != 0) {
+                    return (res);
+                }
+            }
+
+            res = ctz_extend(self_p,
+                             file_p->block,
+                             file_p->pos,
+                             &file_p->block,
+                             &file_p->off);
+
+            if (res != 0) {
+                return (res);
+            }
+
+            file_p->flags |= F_WRITING;
+        }
+
+        n = MIN(left, self_p->block_size - file_p->off);
+        res = block_write(self_p, file_p->block, file_p->off, buf_p, n);
+
+        if (res != 0) {
+            return (res);
+        }
+
+        file_p->pos += n;
+        file_p->off += n;
+        buf_p += n;
+        left -= n;
+    }
+
+    return (size);
+}
+
+/**
+ * Write the rest of the old file after the current position to end
+ * the new skip-list.
+ */
+static int file_flush(struct cowfs_file_t *file_p)
+{
+    ssize_t res;
+    struct cowfs_t *self_p;
+    size_t pos;
+    uint32_t block;
+    uint32_t off;
+    size_t n;
+    uint8_t buf[32];
+
+    self_p = file_p->cowfs_p;
+    file_p->flags &= ~F_READING;
+
+    if (!(file_p->flags & F_WRITING)) {
+        return (0);
+    }
+
+    pos = file_p->pos;
+    off = self_p->block_size;
+
+    while (file_p->pos < file_p->size) {
+        if (off == self_p->block_size) {
+            res = ctz_find(self_p,
+                           file_p->head,
+                           file_p->size,
+                           file_p->pos,
+                           &block,
+                           &off);
+
+            if (res != 0) {
+                return (res);
+            }
+        }
+
+        n = MIN(sizeof(buf), file_p->size - file_p->pos);
+        n = MIN(n, self_p->block_size - off);
+        res = block_read(self_p, block, off, &buf[0], n);
+
+        if (res != 0) {
+            return (res);
+        }
+
+        off += n;
+        res = file_write_data(file_p, &buf[0], n);
+
+        if (res < 0) {
+            return (res);
+        }
+    }
+
+    file_p->head = file_p->block;
+    file_p->size = file_p->pos;
+    file_p->pos = pos;
+    file_p->flags &= ~F_WRITING;
+    file_p->flags |= F_DIRTY;
+
+    return (0);
+}
+
+#if CONFIG_FILESYSTEM_GENERIC == 1
+
+static struct cowfs_t *to_cowfs(struct fs_filesystem_t *filesystem_p)
+{
+    return (container_of(filesystem_p->fs.generic.ops_p,
+                         struct cowfs_t,
+                         ops));
+}
+
+static int generic_file_open(struct fs_filesystem_t *filesystem_p,
+                             struct fs_file_t *file_p,
+                             const char *path_p,
+                             int flags)
+{
+    struct cowfs_t *self_p;
+    struct cowfs_file_t *cowfs_file_p;
+    size_t i;
+
+    self_p = to_cowfs(filesystem_p);
+
+    for (i = 0; i < membersof(self_p->fs_files); i++) {
+        cowfs_file_p = &self_p->fs_files[i];
+
+        if (cowfs_file_p->cowfs_p == NULL) {
+            if (cowfs_file_open(self_p, cowfs_file_p, path_p, flags) != 0) {
+                cowfs_file_p->cowfs_p = NULL;
+
+                return (-1);
+            }
+
+            file_p->u.generic_p = cowfs_file_p;
+
+            return (0);
+        }
+    }
+
+    return (-1);
+}
+
+static int generic_file_close(struct fs_file_t *file_p)
+{
+    return (cowfs_file_close(file_p->u.generic_p));
+}
+
+static ssize_t generic_file_read(struct fs_file_t *file_p,
+                                 void *dst_p,
+                                 size_t size)
+{
+    return (cowfs_file_read(file_p->u.generic_p, dst_p, size));
+}
+
+static ssize_t generic_file_write(struct fs_file_t *file_p,
+                                  const void *src_p,
+                                  size_t size)
+{
+    return (cowfs_file_write(file_p->u.generic_p, src_p, size));
+}
+
+static int generic_file_seek(struct fs_file_t *file_p,
+                             int offset,
+                             int whence)
+{
+    return (cowfs_file_seek(file_p->u.generic_p, offset, whence));
+}
+
+static ssize_t generic_file_tell(struct fs_file_t *file_p)
+{
+    return (cowfs_file_tell(file_p->u.generic_p));
+}
+
+static int generic_mkdir(struct fs_filesystem_t *filesystem_p,
+                         const char *path_p)
+{
+    return (cowfs_mkdir(to_cowfs(filesystem_p), path_p));
+}
+
+static int generic_remove(struct fs_filesystem_t *filesystem_p,
+                          const char *path_p)
+{
+    return (cowfs_remove(to_cowfs(filesystem_p), path_p));
+}
+
+static int generic_stat(struct fs_filesystem_t *filesystem_p,
+                        const char *path_p,
+                        struct fs_stat_t *stat_p)
+{
+    return (cowfs_stat(to_cowfs(filesystem_p), path_p, stat_p));
+}
+
+#endif
+
+int cowfs_init(struct cowfs_t *self_p,
+               struct flash_driver_t *flash_p,
+               uintptr_t address,
+               uint32_t block_size,
+               uint32_t block_count)
+{
+    ASSERTN(self_p != NULL, EINVAL);
+    ASSERTN(flash_p != NULL, EINVAL);
+    ASSERTN(block_size >= 128, EINVAL);
+    ASSERTN(block_count >= 4, EINVAL);
+
+#if CONFIG_FILESYSTEM_GENERIC == 1
+    size_t i;
+#endif
+
+    self_p->flash_p = flash_p;
+    self_p->address = address;
+    self_p->block_size = block_size;
+    self_p->block_count = block_count;
+    self_p->root[0] = BLOCK_NULL;
+    self_p->root[1] = BLOCK_NULL;
+    self_p->files_p = NULL;
+
+#if CONFIG_FILESYSTEM_GENERIC == 1
+    self_p->ops.file_open = generic_file_open;
+    self_p->ops.file_close = generic_file_close;
+    self_p->ops.file_read = generic_file_read;
+    self_p->ops.file_write = generic_file_write;
+    self_p->ops.file_seek = generic_file_seek;
+    self_p->ops.file_tell = generic_file_tell;
+    self_p->ops.mkdir = generic_mkdir;
+    self_p->ops.remove = generic_remove;
+    self_p->ops.stat = generic_stat;
+
+    for (i = 0; i < membersof(self_p->fs_files); i++) {
+        self_p->fs_files[i].cowfs_p = NULL;
+    }
+#endif
+
+    return (0);
+}
+
+int cowfs_mount(struct cowfs_t *self_p)
+{
+    ASSERTN(self_p != NULL, EINVAL);
+
+    int res;
+    uint32_t superblock[2] = { 0, 1 };
+    struct cowfs_mdir_t mdir;
+    struct entry_t entry;
+    uint32_t off;
+    char name[sizeof(MAGIC) - 1];
+
+    res = mdir_fetch(self_p, &mdir, &superblock[0]);
+
+    if (res != 0) {
+        return (res);
+    }
+
+    off = 0;
+    res = mdir_next(self_p, &mdir, &off, &entry);
+
+    if (res != 1) {
+        return (-EINVAL);
+    }
+
+    if ((entry.type != TYPE_SUPERBLOCK)
+        || (entry.name_size != sizeof(name))
+        || (entry.u[0] != self_p->block_size)
+        || (entry.u[1] != self_p->block_count)) {
+        return (-EINVAL);
+    }
+
+    res = mdir_read_name(self_p, &mdir, 0, &entry, &name[0]);
+
+    if (res != 0) {
+        return (res);
+    }
+
+    if (memcmp(&name[0], MAGIC, sizeof(name)) != 0) {
+        return (-EINVAL);
+    }
+
+    self_p->root[0] = mdir.tail[0];
+    self_p->root[1] = mdir.tail[1];
+    self_p->files_p = NULL;
+
+    /* Start allocating at a block given by the root directory
+       revision, which changes on every commit to it. */
+    res = mdir_fetch(self_p, &mdir, &self_p->root[0]);
+
+    if (res != 0) {
+        return (res);
+    }
+
+    self_p->lookahead.start = (crc_32(0, &mdir, sizeof(mdir))
+                               % self_p->block_count);
+    self_p->lookahead.size = 0;
+    self_p->lookahead.index = 0;
+    alloc_ack(self_p);
+
+    return (0);
+}
+
+int cowfs_unmount(struct cowfs_t *self_p)
+{
+    ASSERTN(self_p != NULL, EINVAL);
+
+    if (self_p->files_p != NULL) {
+        return (-EBUSY);
+    }
+
+    self_p->root[0] = BLOCK_NULL;
+    self_p->root[1] = BLOCK_NULL;
+
+    return (0);
+}
+
+int cowfs_format(struct cowfs_t *self_p)
+{
+    ASSERTN(self_p != NULL, EINVAL);
+
+    int res;
+    struct cowfs_mdir_t superblock;
+    struct cowfs_mdir_t root;
+    struct entry_t entry;
+
+    /* Blocks 1 and 3 are erased by the commits. */
+    res = block_erase(self_p, 0);
+
+    if (res != 0) {
+        return (res);
+    }
+
+    res = block_erase(self_p, 2);
+
+    if (res != 0) {
+        return (res);
+    }
+
+    root.pair[0] = 2;
+    root.pair[1] = 3;
+    root.revision = 0;
+    root.size = 0;
+    root.tail[0] = BLOCK_NULL;
+    root.tail[1] = BLOCK_NULL;
+    res = mdir_commit(self_p, &root, 0, 0, NULL, NULL, NULL);
+
+    if (res != 0) {
+        return (res);
+    }
+
+    superblock.pair[0] = 0;
+    superblock.pair[1] = 1;
+    superblock.revision = 0;
+    superblock.size = 0;
+    superblock.tail[0] = BLOCK_NULL;
+    superblock.tail[1] = BLOCK_NULL;
+    entry.type = TYPE_SUPERBLOCK;
+    entry.name_size = (sizeof(MAGIC) - 1);
+    entry.reserved = 0;
+    entry.u[0] = self_p->block_size;
+    entry.u[1] = self_p->block_count;
+
+    return (mdir_commit(self_p,
+                        &superblock,
+                        0,
+                        0,
+                        &entry,
+                        MAGIC,
+                        &root.pair[0]));
+}
+
+int cowfs_file_open(struct cowfs_t *self_p,
+                    struct cowfs_file_t *file_p,
+                    const char *path_p,
+                    int flags)
+{
+    ASSERTN(self_p != NULL, EINVAL);
+    ASSERTN(file_p != NULL, EINVAL);
+    ASSERTN(path_p != NULL, EINVAL);
+
+    int res;
+    const char *name_p;
+    size_t name_size;
+    struct cowfs_mdir_t mdir;
+    struct entry_t entry;
+    uint32_t off;
+
+    res = lookup(self_p,
+                 path_p,
+                 &file_p->dir[0],
+                 &name_p,
+                 &name_size,
+                 &mdir,
+                 &off,
+                 &entry);
+
+    if (res == LOOKUP_ROOT) {
+        return (-EISDIR);
+    } else if (res == 1) {
+        if ((flags & FS_CREAT) && (flags & FS_EXCL)) {
+            return (-EEXIST);
+        }
+
+        if (entry.type != TYPE_FILE) {
+            return (-EISDIR);
+        }
+    } else if (res == 0) {
+        if (!(flags & FS_CREAT)) {
+            return (-ENOENT);
+        }
+
+        alloc_ack(self_p);
+        entry.type = TYPE_FILE;
+        entry.name_size = name_size;
+        entry.reserved = 0;
+        entry.u[0] = BLOCK_NULL;
+        entry.u[1] = 0;
+        res = chain_insert(self_p, &mdir, &entry, name_p);
+    }
+
+    if (res < 0) {
+        return (res);
+    }
+
+    file_p->cowfs_p = self_p;
+    memcpy(&file_p->name[0], name_p, name_size);
+    file_p->name_size = name_size;
+    file_p->flags = (flags & (FS_READ | FS_WRITE | FS_APPEND | FS_SYNC));
+    file_p->head = entry.u[0];
+    file_p->size = entry.u[1];
+    file_p->pos = 0;
+
+    if ((flags & FS_TRUNC) && (file_p->size > 0)) {
+        file_p->head = BLOCK_NULL;
+        file_p->size = 0;
+        file_p->flags |= F_DIRTY;
+    }
+
+    file_p->next_p = self_p->files_p;
+    self_p->files_p = file_p;
+
+    return (0);
+}
+
+int cowfs_file_close(struct cowfs_file_t *file_p)
+{
+    ASSERTN(file_p != NULL, EINVAL);
+
+    int res;
+    struct cowfs_file_t **file_pp;
+
+    res = cowfs_file_sync(file_p);
+
+    /* Always remove the file from the list of open files. */
+    file_pp = &file_p->cowfs_p->files_p;
+
+    while (*file_pp != NULL) {
+        if (*file_pp == file_p) {
+            *file_pp = file_p->next_p;
+            break;
+        }
+
+        file_pp = &(*file_pp)->next_p;
+    }
+
+    file_p->cowfs_p = NULL;
+
+    return (res);
+}
+
+ssize_t cowfs_file_read(struct cowfs_file_t *file_p,
+                        void *buf_p,
+                        size_t size)
+{
+    ASSERTN(file_p != NULL, EINVAL);
+    ASSERTN(buf_p != NULL, EINVAL);
+
+    int res;
+    struct cowfs_t *self_p;
+    uint8_t *b_p;
+    size_t left;
+    size_t n;
+
+    if (!(file_p->flags & FS_READ)) {
+        return (-EACCES);
+    }
+
+    self_p = file_p->cowfs_p;
+
+    if (file_p->flags & F_WRITING) {
+        res = file_flush(file_p);
+
+        if (res != 0) {
+            return (res);
+        }
+    }
+
+    if (file_p->pos >= file_p->size) {
+        return (0);
+    }
+
+    size = MIN(size, file_p->size - file_p->pos);
+    left = size;
+    b_p = buf_p;
+
+    while (left > 0) {
+        if (!(file_p->flags & F_READING)
+            || (file_p->off == self_p->block_size)) {
+            res = ctz_find(self_p,
+                           file_p->head,
+                           file_p->size,
+                           file_p->pos,
+                           &file_p->block,
+                           &file_p->off);
+
+            if (res != 0) {
+                return (res);
+            }
+
+            file_p->flags |= F_READING;
+        }
+
+        n = MIN(left, self_p->block_size - file_p->off);
+        res = block_read(self_p, file_p->block, file_p->off, b_p, n);
+
+        if (res != 0) {
+            return (res);
+        }
+
+        file_p->pos += n;
+        file_p->off += n;
+        b_p += n;
+        left -= n;
+    }
+
+    return (size);
+}
+
+ssize_t cowfs_file_write(struct cowfs_file_t *file_p,
+                         const void *buf_p,
+                         size_t size)
+{
+    ASSERTN(file_p != NULL, EINVAL);
+    ASSERTN(buf_p != NULL, EINVAL);
+
+    static const uint8_t zeros[16] = { 0 };
+    ssize_t res;
+    size_t pos;
+
+    if (!(file_p->flags & FS_WRITE)) {
+        return (-EACCES);
+    }
+
+    alloc_ack(file_p->cowfs_p);
+    file_p->flags &= ~F_READING;
+
+    if (!(file_p->flags & F_WRITING)) {
+        if ((file_p->flags & FS_APPEND) && (file_p->pos < file_p->size)) {
+            file_p->pos = file_p->size;
+        }
+
+        /* Fill the gap after the end of the file with zeros. */
+        if (file_p->pos > file_p->size) {
+            pos = file_p->pos;
+            file_p->pos = file_p->size;
+
+            while (file_p->pos < pos) {
+                res = file_write_data(file_p,
+                                      &zeros[0],
+                                      MIN(sizeof(zeros), pos - file_p->pos));
+
+                if (res < 0) {
+                    return (res);
+                }
+            }
+        }
+    }
+
+    res = file_write_data(file_p, buf_p, size);
+
+    if (res < 0) {
+        return (res);
+    }
+
+    if (file_p->flags & FS_SYNC) {
+        res = cowfs_file_sync(file_p);
+
+        if (res != 0) {
+            return (res);
+        }
+    }
+
+    return (size);
+}
+
+int cowfs_file_seek(struct cowfs_file_t *file_p, int offset, int whence)
+{
+    ASSERTN(file_p != NULL, EINVAL);
+
+    int res;
+    ssize_t pos;
+
+    res = file_flush(file_p);
+
+    if (res != 0) {
+        return (res);
+    }
+
+    switch (whence) {
+
+    case FS_SEEK_SET:
+        pos = offset;
+        break;
+
+    case FS_SEEK_CUR:
+        pos = (file_p->pos + offset);
+        break;
+
+    case FS_SEEK_END:
+        pos = (file_p->size + offset);
+        break;
+
+    default:
+        return (-EINVAL);
+    }
+
+    if (pos < 0) {
+        return (-EINVAL);
+    }
+
+    file_p->pos = pos;
+
+    return (0);
+}
+
+ssize_t cowfs_file_tell(struct cowfs_file_t *file_p)
+{
+    ASSERTN(file_p != NULL, EINVAL);
+
+    return (file_p->pos);
+}
+
+ssize_t cowfs_file_size(struct cowfs_file_t *file_p)
+{
+    ASSERTN(file_p != NULL, EINVAL);
+
+    if (file_p->flags & F_WRITING) {
+        return (MAX(file_p->pos, file_p->size));
+    }
+
+    return (file_p->size);
+}
+
+int cowfs_file_sync(struct cowfs_file_t *file_p)
+{
+    ASSERTN(file_p != NULL, EINVAL);
+
+    int res;
+
+    alloc_ack(file_p->cowfs_p);
+    res = file_flush(file_p);
+
+    if (res != 0) {
+        return (res);
+    }
+
+    if (file_p->flags & F_DIRTY) {
+        res = file_commit(file_p);
+
+        if (res != 0) {
+            return (res);
+        }
+
+        file_p->flags &= ~F_DIRTY;
+    }
+
+    return (0);
+}
+
+int cowfs_mkdir(struct cowfs_t *self_p, const char *path_p)
+{
+    ASSERTN(self_p != NULL, EINVAL);
+    ASSERTN(path_p != NULL, EINVAL);
+
+    int res;
+    uint32_t dir[2];
+    const char *name_p;
+    size_t name_size;
+    struct cowfs_mdir_t mdir;
+    struct cowfs_mdir_t child;
+    struct entry_t entry;
+    uint32_t off;
+
+    res = lookup(self_p,
+                 path_p,
+                 &dir[0],
+                 &name_p,
+                 &name_size,
+                 &mdir,
+                 &off,
+                 &entry);
+
+    if (res != 0) {
+        return (res < 0 ? res : -EEXIST);
+    }
+
+    alloc_ack(self_p);
+
+    /* Write the new directory before adding it to its parent. */
+    res = mdir_create(self_p, &child);
+
+    if (res != 0) {
+        return (res);
+    }
+
+    res = mdir_commit(self_p, &child, 0, 0, NULL, NULL, NULL);
+
+    if (res != 0) {
+        return (res);
+    }
+
+    entry.type = TYPE_DIR;
+    entry.name_size = name_size;
+    entry.reserved = 0;
+    entry.u[0] = child.pair[0];
+    entry.u[1] = child.pair[1];
+
+    return (chain_insert(self_p, &mdir, &entry, name_p));
+}
+
+int cowfs_remove(struct cowfs_t *self_p, const char *path_p)
+{
+    ASSERTN(self_p != NULL, EINVAL);
+    ASSERTN(path_p != NULL, EINVAL);
+
+    int res;
+    uint32_t dir[2];
+    const char *name_p;
+    size_t name_size;
+    struct cowfs_mdir_t mdir;
+    struct cowfs_mdir_t child;
+    struct entry_t entry;
+    uint32_t off;
+    uint32_t pair[2];
+
+    res = lookup(self_p,
+                 path_p,
+                 &dir[0],
+                 &name_p,
+                 &name_size,
+                 &mdir,
+                 &off,
+                 &entry);
+
+    if (res == LOOKUP_ROOT) {
+        return (-EINVAL);
+    } else if (res == 0) {
+        return (-ENOENT);
+    } else if (res < 0) {
+        return (res);
+    }
+
+    /* Only empty directories can be removed. */
+    if (entry.type == TYPE_DIR) {
+        pair[0] = entry.u[0];
+        pair[1] = entry.u[1];
+
+        while (pair[0] != BLOCK_NULL) {
+            res = mdir_fetch(self_p, &child, &pair[0]);
+
+            if (res != 0) {
+                return (res);
+            }
+
+            if (child.size > 0) {
+                return (-ENOTEMPTY);
+            }
+
+            pair[0] = child.tail[0];
+            pair[1] = child.tail[1];
+        }
+    }
+
+    alloc_ack(self_p);
+
+    return (mdir_commit(self_p,
+                        &mdir,
+                        off,
+                        sizeof(entry) + entry.name_size,
+                        NULL,
+                        NULL,
+                        NULL));
+}
+
+int cowfs_stat(struct cowfs_t *self_p,
+               const char *path_p,
+               struct fs_stat_t *stat_p)
+{
+    ASSERTN(self_p != NULL, EINVAL);
+    ASSERTN(path_p != NULL, EINVAL);
+    ASSERTN(stat_p != NULL, EINVAL);
+
+    int res;
+    uint32_t dir[2];
+    const char *name_p;
+    size_t name_size;
+    struct cowfs_mdir_t mdir;
+    struct entry_t entry;
+    uint32_t off;
+
+    res = lookup(self_p,
+                 path_p,
+                 &dir[0],
+                 &name_p,
+                 &name_size,
+                 &mdir,
+                 &off,
+                 &entry);
+
+    if (res == LOOKUP_ROOT) {
+        stat_p->type = FS_TYPE_DIR;
+        stat_p->size = 0;
+
+        return (0);
+    } else if (res == 0) {
+        return (-ENOENT);
+    } else if (res < 0) {
+        return (res);
+    }
+
+    if (entry.type == TYPE_DIR) {
+        stat_p->type = FS_TYPE_DIR;
+        stat_p->size = 0;
+    } else {
+        stat_p->type = FS_TYPE_FILE;
+        stat_p->size = entry.u[1];
+    }
+
+    return (0);
+}
+
+int cowfs_dir_open(struct cowfs_t *self_p,
+                   struct cowfs_dir_t *dir_p,
+                   const char *path_p)
+{
+    ASSERTN(self_p != NULL, EINVAL);
+    ASSERTN(dir_p != NULL, EINVAL);
+    ASSERTN(path_p != NULL, EINVAL);
+
+    int res;
+    uint32_t dir[2];
+    const char *name_p;
+    size_t name_size;
+    struct entry_t entry;
+    uint32_t off;
+
+    res = lookup(self_p,
+                 path_p,
+                 &dir[0],
+                 &name_p,
+                 &name_size,
+                 &dir_p->mdir,
+                 &off,
+                 &entry);
+
+    if (res == 1) {
+        if (entry.type != TYPE_DIR) {
+            return (-ENOTDIR);
+        }
+
+        dir[0] = entry.u[0];
+        dir[1] = entry.u[1];
+    } else if (res == 0) {
+        return (-ENOENT);
+    } else if (res < 0) {
+        return (res);
+    }
+
+    res = mdir_fetch(self_p, &dir_p->mdir, &dir[0]);
+
+    if (res != 0) {
+        return (res);
+    }
+
+    dir_p->cowfs_p = self_p;
+    dir_p->off = 0;
+
+    return (0);
+}
+
+int cowfs_dir_read(struct cowfs_dir_t *dir_p,
+                   struct fs_dir_entry_t *entry_p)
+{
+    ASSERTN(dir_p != NULL, EINVAL);
+    ASSERTN(entry_p != NULL, EINVAL);
+
+    int res;
+    struct entry_t entry;
+    uint32_t off;
+    uint32_t tail[2];
+
+    while (1) {
+        off = dir_p->off;
+        res = mdir_next(dir_p->cowfs_p, &dir_p->mdir, &dir_p->off, &entry);
+
+        if (res < 0) {
+            return (res);
+        }
+
+        if (res == 1) {
+            break;
+        }
+
+        if (dir_p->mdir.tail[0] == BLOCK_NULL) {
+            return (0);
+        }
+
+        tail[0] = dir_p->mdir.tail[0];
+        tail[1] = dir_p->mdir.tail[1];
+        res = mdir_fetch(dir_p->cowfs_p, &dir_p->mdir, &tail[0]);
+
+        if (res != 0) {
+            return (res);
+        }
+
+        dir_p->off = 0;
+    }
+
+    res = mdir_read_name(dir_p->cowfs_p,
+                         &dir_p->mdir,
+                         off,
+                         &entry,
+                         &entry_p->name[0]);
+
+    if (res != 0) {
+        return (res);
+    }
+
+    entry_p->name[entry.name_size] = '\0';
+
+    if (entry.type == TYPE_DIR) {
+        entry_p->type = FS_TYPE_DIR;
+        entry_p->size = 0;
+    } else {
+        entry_p->type = FS_TYPE_FILE;
+        entry_p->size = entry.u[1];
+    }
+
+    memset(&entry_p->latest_mod_date, 0, sizeof(entry_p->latest_mod_date));
+
+    return (1);
+}
+
+int cowfs_dir_close(struct cowfs_dir_t *dir_p)
+{
+    ASSERTN(dir_p != NULL, EINVAL);
+
+    return (0);
+}
+
+#endif
@@ -0,0 +1,302 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2014-2018, Erik Moqvist
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use, copy,
+ * modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ * This file is part of the Simba project.
+ */
+
+#ifndef __FILESYSTEMS_COWFS_H__
+#define __FILESYSTEMS_COWFS_H__
+
+#include "simba.h"
+
+struct flash_driver_t;
+
+/**
+ * A fetched metadata block pair. The first block in the pair is the
+ * one with the latest valid revision.
+ */
+struct cowfs_mdir_t {
+    uint32_t pair[2];
+    uint32_t revision;
+    uint32_t size;
+    uint32_t tail[2];
+};
+
+struct cowfs_file_t {
+    struct cowfs_t *cowfs_p;
+    /* First metadata pair of the directory the file is in. */
+    uint32_t dir[2];
+    char name[CONFIG_COWFS_NAME_MAX];
+    uint8_t name_size;
+    uint8_t flags;
+    /* Committed, or flushed but not yet committed, skip-list. */
+    uint32_t head;
+    uint32_t size;
+    size_t pos;
+    /* Block and offset of the current position when reading or
+       writing. */
+    uint32_t block;
+    uint32_t off;
+    struct cowfs_file_t *next_p;
+};
+
+struct cowfs_dir_t {
+    struct cowfs_t *cowfs_p;
+    struct cowfs_mdir_t mdir;
+    uint32_t off;
+};
+
+struct cowfs_t {
+    struct flash_driver_t *flash_p;
+    uintptr_t address;
+    uint32_t block_size;
+    uint32_t block_count;
+    uint32_t root[2];
+    struct {
+        uint32_t start;
+        uint32_t size;
+        uint32_t index;
+        uint32_t ack;
+        uint32_t bits[CONFIG_COWFS_LOOKAHEAD / 32];
+    } lookahead;
+    struct cowfs_file_t *files_p;
+#if CONFIG_FILESYSTEM_GENERIC == 1
+    /* Operations and open files for fs_filesystem_init_generic(). */
+    struct fs_filesystem_operations_t ops;
+    struct cowfs_file_t fs_files[CONFIG_COWFS_FS_FILES_MAX];
+#endif
+};
+
+/**
+ * Initialize given file system on given flash memory
+ * area. ``block_size`` must be the flash erase block size, or a
+ * multiple of it.
+ *
+ * To access the file system using the fs module, pass ``&self_p->ops``
+ * to `fs_filesystem_init_generic()`.
+ *
+ * @param[out] self_p File system to initialize.
+ * @param[in] flash_p Initialized flash driver.
+ * @param[in] address Address of the first block in the flash memory.
+ * @param[in] block_size Block size in bytes.
+ * @param[in] block_count Number of blocks, at least four.
+ *
+ * @return zero(0) or negative error code.
+ */
+int cowfs_init(struct cowfs_t *self_p,
+               struct flash_driver_t *flash_p,
+               uintptr_t address,
+               uint32_t block_size,
+               uint32_t block_count);
+
+/**
+ * Mount given file system. Only the superblock is read.
+ *
+ * @param[in] self_p Initialized file system.
+ *
+ * @return zero(0) or negative error code.
+ */
+int cowfs_mount(struct cowfs_t *self_p);
+
+/**
+ * Unmount given file system. All open files must be closed first.
+ *
+ * @param[in] self_p Mounted file system.
+ *
+ * @return zero(0) or negative error code.
+ */
+int cowfs_unmount(struct cowfs_t *self_p);
+
+/**
+ * Create an empty file system. All data is lost.
+ *
+ * @param[in] self_p Initialized, unmounted, file system.
+ *
+ * @return zero(0) or negative error code.
+ */
+int cowfs_format(struct cowfs_t *self_p);
+
+/**
+ * Open a file by file path and mode flags.
+ *
+ * @param[in] self_p Mounted file system.
+ * @param[out] file_p File object to initialize.
+ * @param[in] path_p Path of the file to open.
+ * @param[in] flags A bitwise-or of the ``FS_`` flags ``FS_READ``,
+ *                  ``FS_WRITE``, ``FS_APPEND``, ``FS_SYNC``,
+ *                  ``FS_CREAT``, ``FS_EXCL`` and ``FS_TRUNC``.
+ *
+ * @return zero(0) or negative error code.
+ */
+int cowfs_file_open(struct cowfs_t *self_p,
+                    struct cowfs_file_t *file_p,
+                    const char *path_p,
+                    int flags);
+
+/**
+ * Commit any changes and close given file.
+ *
+ * @param[in] file_p File to close.
+ *
+ * @return zero(0) or negative error code.
+ */
+int cowfs_file_close(struct cowfs_file_t *file_p);
+
+/**
+ * Read data from given file.
+ *
+ * @param[in] file_p File to read from.
+ * @param[out] buf_p Buffer to read into.
+ * @param[in] size Number of bytes to read.
+ *
+ * @return Number of bytes read, or negative error code.
+ */
+ssize_t cowfs_file_read(struct cowfs_file_t *file_p,
+                        void *buf_p,
+                        size_t size);
+
+/**
+ * Write data to given file. Written data is not visible after a
+ * power failure until the file is synchronized or closed, unless the
+ * file was opened with ``FS_SYNC``.
+ *
+ * @param[in] file_p File to write to.
+ * @param[in] buf_p Buffer to write.
+ * @param[in] size Number of bytes to write.
+ *
+ * @return Number of bytes written, or negative error code.
+ */
+ssize_t cowfs_file_write(struct cowfs_file_t *file_p,
+                         const void *buf_p,
+                         size_t size);
+
+/**
+ * Set the file position. The position may be beyond the end of the
+ * file, and the gap is filled with zeros when written.
+ *
+ * @param[in] file_p File.
+ * @param[in] offset Offset relative to ``whence``.
+ * @param[in] whence ``FS_SEEK_SET``, ``FS_SEEK_CUR`` or
+ *                   ``FS_SEEK_END``.
+ *
+ * @return zero(0) or negative error code.
+ */
+int cowfs_file_seek(struct cowfs_file_t *file_p, int offset, int whence);
+
+/**
+ * Get the file position.
+ *
+ * @param[in] file_p File.
+ *
+ * @return The position, or negative error code.
+ */
+ssize_t cowfs_file_tell(struct cowfs_file_t *file_p);
+
+/**
+ * Get the file size.
+ *
+ * @param[in] file_p File.
+ *
+ * @return The size, or negative error code.
+ */
+ssize_t cowfs_file_size(struct cowfs_file_t *file_p);
+
+/**
+ * Atomically commit all written data and the new file size.
+ *
+ * @param[in] file_p File to synchronize.
+ *
+ * @return zero(0) or negative error code.
+ */
+int cowfs_file_sync(struct cowfs_file_t *file_p);
+
+/**
+ * Create a directory.
+ *
+ * @param[in] self_p Mounted file system.
+ * @param[in] path_p Path of the directory to create.
+ *
+ * @return zero(0) or negative error code.
+ */
+int cowfs_mkdir(struct cowfs_t *self_p, const char *path_p);
+
+/**
+ * Remove a file or an empty directory.
+ *
+ * @param[in] self_p Mounted file system.
+ * @param[in] path_p Path to remove.
+ *
+ * @return zero(0) or negative error code.
+ */
+int cowfs_remove(struct cowfs_t *self_p, const char *path_p);
+
+/**
+ * Get the type and size of given path.
+ *
+ * @param[in] self_p Mounted file system.
+ * @param[in] path_p Path.
+ * @param[out] stat_p Path stats.
+ *
+ * @return zero(0) or negative error code.
+ */
+int cowfs_stat(struct cowfs_t *self_p,
+               const char *path_p,
+               struct fs_stat_t *stat_p);
+
+/**
+ * Open a directory for reading.
+ *
+ * @param[in] self_p Mounted file system.
+ * @param[out] dir_p Directory object to initialize.
+ * @param[in] path_p Path of the directory.
+ *
+ * @return zero(0) or negative error code.
+ */
+int cowfs_dir_open(struct cowfs_t *self_p,
+                   struct cowfs_dir_t *dir_p,
+                   const char *path_p);
+
+/**
+ * Read the next entry in given directory.
+ *
+ * @param[in] dir_p Directory.
+ * @param[out] entry_p Read entry.
+ *
+ * @return true(1) if an entry was read, false(0) if there are no
+ *         more entries, or negative error code.
+ */
+int cowfs_dir_read(struct cowfs_dir_t *dir_p,
+                   struct fs_dir_entry_t *entry_p);
+
+/**
+ * Close given directory.
+ *
+ * @param[in] dir_p Directory.
+ *
+ * @return zero(0) or negative error code.
+ */
+int cowfs_dir_close(struct cowfs_dir_t *dir_p);
+
+#endif
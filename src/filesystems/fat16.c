@@ -26,12 +26,24 @@
 /* define fields in flags_ require sync directory entry. */
 #define F_OFLAG (O_RDWR | O_APPEND | O_SYNC)
 #define F_FILE_DIR_DIRTY 0x80
+/* O_STREAM is stored in the O_CREAT bit, which is only used in open. */
+#define F_FILE_STREAM 0x10
 
 /** Value for byte 510 and 511 of boot block or MBR. */
 #define BOOTSIG ntohs(0x55aa)
 
-#define CACHE_FOR_READ  0    /* cache a block for read. */
-#define CACHE_FOR_WRITE 1    /* cache a block and set dirty. */
+#define CACHE_FOR_READ      0 /* cache a block for read. */
+#define CACHE_FOR_WRITE     1 /* cache a block and set dirty. */
+#define CACHE_NO_READ       2 /* do not read the block from the device. */
+#define CACHE_FOR_OVERWRITE (CACHE_FOR_WRITE | CACHE_NO_READ)
+
+/* Cache priorities. Blocks with lower priority are evicted first. */
+#define CACHE_PRIO_DATA 0
+#define CACHE_PRIO_DIR  1
+#define CACHE_PRIO_FAT  2
+
+/* Block number of an unused cache block. */
+#define CACHE_BLOCK_NONE 0xffffffff
 
 /* FAT16 end of chain value used by Microsoft. */
 #define EOC16 0xffff
@@ -48,6 +60,24 @@
 /* Mask a for FAT32 entry. Entries are 28 bits. */
 #define ENTRY32_MASK 0x0fffffff
 
+/* End of chain value of the widest supported FAT entry. Entries read
+   from a FAT16 volume are widened to this value. */
+#if CONFIG_FAT16_FAT32 == 1
+#    define EOC EOC32
+#    define EOC_MIN EOC32_MIN
+#else
+#    define EOC EOC16
+#    define EOC_MIN EOC16_MIN
+#endif
+
+/* Free cluster count of unknown value. */
+#define FREE_COUNT_UNKNOWN ((fat_t)-1)
+
+/* FAT32 FSInfo signatures. */
+#define FSINFO_LEAD_SIGNATURE   0x41615252
+#define FSINFO_STRUCT_SIGNATURE 0x61417272
+#define FSINFO_TRAIL_SIGNATURE  0xaa550000
+
 /* Type name for directoryEntry. */
 
 /* escape for name[0] = 0xe5. */
@@ -78,9 +108,68 @@
 /** Default time for file timestamp is 1 am. */
 #define DEFAULT_TIME (1 << 11)
 
+#if CONFIG_FAT16_CACHE_COUNTERS == 1
+#    define COUNTER_INC(name) module.name.value++
+#else
+#    define COUNTER_INC(name)
+#endif
+
+struct module_t {
+    int initialized;
+#if CONFIG_FAT16_CACHE_COUNTERS == 1
+    struct fs_counter_t cache_hits;
+    struct fs_counter_t cache_misses;
+    struct fs_counter_t cache_writes;
+#endif
+};
+
+static struct module_t module;
+
 static int is_end_of_cluster(fat_t cluster)
 {
-    return (cluster >= 0xfff8);
+    return (cluster >= EOC_MIN);
+}
+
+static inline int is_fat32(struct fat16_t *self_p)
+{
+#if CONFIG_FAT16_FAT32 == 1
+    return (self_p->fat_type == 32);
+#else
+    return (0);
+#endif
+}
+
+/**
+ * First cluster of given directory entry.
+ */
+static inline fat_t dir_first_cluster(struct fat16_t *self_p,
+                                      const struct dir_t *dir_p)
+{
+#if CONFIG_FAT16_FAT32 == 1
+    if (is_fat32(self_p)) {
+        return (((fat_t)dir_p->first_cluster_high << 16)
+                | dir_p->first_cluster_low);
+    }
+#endif
+
+    return (dir_p->first_cluster_low);
+}
+
+/**
+ * Set the first cluster of given directory entry.
+ */
+static inline void dir_set_first_cluster(struct fat16_t *self_p,
+                                         struct dir_t *dir_p,
+                                         fat_t cluster)
+{
+    dir_p->first_cluster_low = (cluster & 0xffff);
+    dir_p->first_cluster_high = 0;
+
+#if CONFIG_FAT16_FAT32 == 1
+    if (is_fat32(self_p)) {
+        dir_p->first_cluster_high = (cluster >> 16);
+    }
+#endif
 }
 
 /**
@@ -199,33 +288,176 @@ static int make_name_from_83(char *dst_p, const char *dname_p)
     return (0);
 }
 
-static int cache_flush(struct fat16_t *self_p)
+static void cache_init(struct fat16_t *self_p)
+{
+    struct fat16_cache_block_t *block_p;
+    int i;
+
+    self_p->cache.tick = 0;
+
+    for (i = 0; i < membersof(self_p->cache.blocks); i++) {
+        block_p = &self_p->cache.blocks[i];
+        block_p->block_number = CACHE_BLOCK_NONE;
+        block_p->dirty = 0;
+        block_p->priority = CACHE_PRIO_DATA;
+        block_p->used = 0;
+        block_p->mirror_block = 0;
+    }
+}
+
+/**
+ * Write given cached block, and its FAT mirror block, to the device.
+ */
+static int cache_write_block(struct fat16_t *self_p,
+                             struct fat16_cache_block_t *block_p)
 {
-    struct fat16_cache_t *cache_p = &self_p->cache;
+    if (self_p->write(self_p->arg_p,
+                      block_p->block_number,
+                      block_p->buffer.data) != BLOCK_SIZE) {
+        return (-1);
+    }
+
+    COUNTER_INC(cache_writes);
 
-    if (cache_p->dirty) {
+    if (block_p->mirror_block) {
         if (self_p->write(self_p->arg_p,
-                          cache_p->block_number,
-                          cache_p->buffer.data) != BLOCK_SIZE) {
+                          block_p->mirror_block,
+                          block_p->buffer.data) != BLOCK_SIZE) {
             return (-1);
         }
 
-        if (cache_p->mirror_block) {
-            if (self_p->write(self_p->arg_p,
-                              cache_p->mirror_block,
-                              cache_p->buffer.data) != BLOCK_SIZE) {
-                return (-1);
+        COUNTER_INC(cache_writes);
+        block_p->mirror_block = 0;
+    }
+
+    block_p->dirty = 0;
+
+    return (0);
+}
+
+/**
+ * Write all dirty blocks to the device, in block number order to let
+ * the device stream writes to consecutive blocks.
+ */
+static int cache_flush(struct fat16_t *self_p)
+{
+    struct fat16_cache_block_t *block_p;
+    struct fat16_cache_block_t *lowest_p;
+    int i;
+
+    while (1) {
+        lowest_p = NULL;
+
+        for (i = 0; i < membersof(self_p->cache.blocks); i++) {
+            block_p = &self_p->cache.blocks[i];
+
+            if (!block_p->dirty) {
+                continue;
+            }
+
+            if ((lowest_p == NULL)
+                || (block_p->block_number < lowest_p->block_number)) {
+                lowest_p = block_p;
             }
+        }
 
-            cache_p->mirror_block = 0;
+        if (lowest_p == NULL) {
+            return (0);
         }
 
-        cache_p->dirty = 0;
+        if (cache_write_block(self_p, lowest_p) != 0) {
+            return (-1);
+        }
+    }
+}
+
+/**
+ * Find the cache block to reuse for a block not in the cache; an
+ * unused block, or the least recently used block of the lowest
+ * priority.
+ */
+static struct fat16_cache_block_t *cache_find_victim(struct fat16_t *self_p)
+{
+    struct fat16_cache_block_t *block_p;
+    struct fat16_cache_block_t *victim_p;
+    uint16_t tick;
+    int i;
+
+    tick = self_p->cache.tick;
+    victim_p = &self_p->cache.blocks[0];
+
+    for (i = 0; i < membersof(self_p->cache.blocks); i++) {
+        block_p = &self_p->cache.blocks[i];
+
+        if (block_p->block_number == CACHE_BLOCK_NONE) {
+            return (block_p);
+        }
+
+        if (block_p->priority < victim_p->priority) {
+            victim_p = block_p;
+        } else if ((block_p->priority == victim_p->priority)
+                   && ((uint16_t)(tick - block_p->used)
+                       > (uint16_t)(tick - victim_p->used))) {
+            victim_p = block_p;
+        }
+    }
+
+    return (victim_p);
+}
+
+/**
+ * Write dirty cached blocks in given range to the device.
+ */
+static int cache_flush_range(struct fat16_t *self_p,
+                             uint32_t block_number,
+                             size_t count)
+{
+    struct fat16_cache_block_t *block_p;
+    int i;
+
+    for (i = 0; i < membersof(self_p->cache.blocks); i++) {
+        block_p = &self_p->cache.blocks[i];
+
+        if (!block_p->dirty) {
+            continue;
+        }
+
+        if ((block_p->block_number - block_number) >= count) {
+            continue;
+        }
+
+        if (cache_write_block(self_p, block_p) != 0) {
+            return (-1);
+        }
     }
 
     return (0);
 }
 
+/**
+ * Remove cached blocks in given range, about to be overwritten on
+ * the device, from the cache.
+ */
+static void cache_discard_range(struct fat16_t *self_p,
+                                uint32_t block_number,
+                                size_t count)
+{
+    struct fat16_cache_block_t *block_p;
+    int i;
+
+    for (i = 0; i < membersof(self_p->cache.blocks); i++) {
+        block_p = &self_p->cache.blocks[i];
+
+        if ((block_p->block_number - block_number) >= count) {
+            continue;
+        }
+
+        block_p->block_number = CACHE_BLOCK_NONE;
+        block_p->dirty = 0;
+        block_p->mirror_block = 0;
+    }
+}
+
 static inline uint8_t block_of_cluster(uint8_t blocks_per_cluster,
                                        uint32_t position)
 {
@@ -237,11 +469,6 @@ static inline uint16_t cache_data_offset(uint32_t position)
     return (position & 0x1ff);
 }
 
-static inline void cache_set_dirty(struct fat16_cache_t *cache_p)
-{
-    cache_p->dirty |= CACHE_FOR_WRITE;
-}
-
 static inline uint32_t data_block_lba(struct fat16_file_t *file_p,
                                       uint8_t block_of_cluster)
 {
@@ -251,57 +478,226 @@ static inline uint32_t data_block_lba(struct fat16_file_t *file_p,
             block_of_cluster);
 }
 
-static int cache_raw_block(struct fat16_t *self_p,
-                           uint32_t block_number,
-                           uint8_t action)
+/**
+ * Get given block from the cache, reading it from the device if it is
+ * not cached and CACHE_NO_READ is not set in action.
+ *
+ * @return Cached block or NULL on failure.
+ */
+static struct fat16_cache_block_t *cache_raw_block(struct fat16_t *self_p,
+                                                   uint32_t block_number,
+                                                   uint8_t action,
+                                                   uint8_t priority)
 {
-    struct fat16_cache_t *cache_p = &self_p->cache;
+    struct fat16_cache_block_t *block_p;
+    int i;
 
-    if (cache_p->block_number != block_number) {
-        if (cache_flush(self_p) != 0) {
-            return (-1);
+    self_p->cache.tick++;
+
+    for (i = 0; i < membersof(self_p->cache.blocks); i++) {
+        block_p = &self_p->cache.blocks[i];
+
+        if (block_p->block_number == block_number) {
+            COUNTER_INC(cache_hits);
+            goto out;
+        }
+    }
+
+    COUNTER_INC(cache_misses);
+    block_p = cache_find_victim(self_p);
+
+    if (block_p->dirty) {
+        if (cache_write_block(self_p, block_p) != 0) {
+            return (NULL);
         }
+    }
 
+    block_p->block_number = CACHE_BLOCK_NONE;
+
+    if (!(action & CACHE_NO_READ)) {
         if (self_p->read(self_p->arg_p,
-                         cache_p->buffer.data,
+                         block_p->buffer.data,
                          block_number) != BLOCK_SIZE) {
-            return (-1);
+            return (NULL);
         }
+    }
+
+    block_p->block_number = block_number;
+
+ out:
+    block_p->used = self_p->cache.tick;
+    block_p->priority = priority;
+    block_p->dirty |= (action & CACHE_FOR_WRITE);
+
+    return (block_p);
+}
 
-        cache_p->block_number = block_number;
+/**
+ * Block of the first FAT with the entry of given cluster.
+ */
+static inline uint32_t fat_block(struct fat16_t *self_p, fat_t cluster)
+{
+    if (is_fat32(self_p)) {
+        return (self_p->fat_start_block + (cluster >> 7));
+    } else {
+        return (self_p->fat_start_block + (cluster >> 8));
+    }
+}
+
+/**
+ * Value of given entry in given cached FAT block. End of chain values
+ * of FAT16 entries are widened to EOC.
+ */
+static inline fat_t fat_entry_get(struct fat16_t *self_p,
+                                  struct fat16_cache_block_t *block_p,
+                                  fat_t cluster)
+{
+    fat_t value;
+
+#if CONFIG_FAT16_FAT32 == 1
+    if (is_fat32(self_p)) {
+        return (block_p->buffer.fat32[cluster & 0x7f] & ENTRY32_MASK);
     }
+#endif
 
-    cache_p->dirty |= action;
+    value = block_p->buffer.fat16[cluster & 0xff];
 
-    return (0);
+    if (value >= EOC16_MIN) {
+        value = EOC;
+    }
+
+    return (value);
 }
 
 static int fat_get(struct fat16_t *self_p,
                    fat_t cluster,
                    fat_t* value)
 {
-    uint32_t lba;
+    struct fat16_cache_block_t *block_p;
 
     if (cluster > (self_p->cluster_count + 1)) {
         return (-1);
     }
 
-    lba = self_p->fat_start_block + (cluster >> 8);
+    block_p = cache_raw_block(self_p,
+                              fat_block(self_p, cluster),
+                              CACHE_FOR_READ,
+                              CACHE_PRIO_FAT);
+
+    if (block_p == NULL) {
+        return (-1);
+    }
+
+    *value = fat_entry_get(self_p, block_p, cluster);
+
+    return (0);
+}
+
+#if CONFIG_FAT16_FREE_BITMAP_SIZE > 0
+
+/**
+ * Load the free cluster bitmap window starting at given cluster from
+ * the FAT.
+ */
+static int free_bitmap_load(struct fat16_t *self_p, fat_t start)
+{
+    struct fat16_free_bitmap_t *bitmap_p;
+    uint32_t cluster;
+    fat_t value;
+    int i;
+
+    bitmap_p = &self_p->free_bitmap;
+    bitmap_p->valid = 0;
+    memset(&bitmap_p->bits[0], 0, sizeof(bitmap_p->bits));
+
+    for (i = 0; i < 8 * sizeof(bitmap_p->bits); i++) {
+        cluster = ((uint32_t)start + i);
 
-    if (lba != self_p->cache.block_number) {
-        if (cache_raw_block(self_p, lba, CACHE_FOR_READ)) {
+        /* Clusters beyond the end of the volume are never free. */
+        if (cluster > ((uint32_t)self_p->cluster_count + 1)) {
+            value = EOC;
+        } else if (fat_get(self_p, cluster, &value) != 0) {
             return (-1);
         }
+
+        if (value != 0) {
+            bitmap_p->bits[i / 8] |= (1 << (i % 8));
+        }
     }
 
-    *value = self_p->cache.buffer.fat[cluster & 0xff];
+    bitmap_p->start = start;
+    bitmap_p->valid = 1;
 
     return (0);
 }
 
+/**
+ * Update the bitmap bit of given cluster, if within the window.
+ */
+static void free_bitmap_update(struct fat16_t *self_p,
+                               fat_t cluster,
+                               fat_t value)
+{
+    struct fat16_free_bitmap_t *bitmap_p;
+    fat_t offset;
+
+    bitmap_p = &self_p->free_bitmap;
+    offset = (fat_t)(cluster - bitmap_p->start);
+
+    if (!bitmap_p->valid || (offset >= 8 * sizeof(bitmap_p->bits))) {
+        return;
+    }
+
+    if (value != 0) {
+        bitmap_p->bits[offset / 8] |= (1 << (offset % 8));
+    } else {
+        bitmap_p->bits[offset / 8] &= ~(1 << (offset % 8));
+    }
+}
+
+#endif
+
+/**
+ * Check if given cluster is free, using the free cluster bitmap if
+ * available.
+ *
+ * @return true(1) if free, false(0) if allocated, otherwise negative
+ *         error code.
+ */
+static int cluster_is_free(struct fat16_t *self_p, fat_t cluster)
+{
+#if CONFIG_FAT16_FREE_BITMAP_SIZE > 0
+    struct fat16_free_bitmap_t *bitmap_p;
+    fat_t offset;
+
+    bitmap_p = &self_p->free_bitmap;
+    offset = (fat_t)(cluster - bitmap_p->start);
+
+    if (!bitmap_p->valid || (offset >= 8 * sizeof(bitmap_p->bits))) {
+        if (free_bitmap_load(self_p, cluster) != 0) {
+            return (-1);
+        }
+
+        offset = 0;
+    }
+
+    return ((bitmap_p->bits[offset / 8] & (1 << (offset % 8))) == 0);
+#else
+    fat_t value;
+
+    if (fat_get(self_p, cluster, &value) != 0) {
+        return (-1);
+    }
+
+    return (value == 0);
+#endif
+}
+
 static int fat_put(struct fat16_t *self_p, fat_t cluster, fat_t value)
 {
+    struct fat16_cache_block_t *block_p;
     uint32_t lba;
+    fat_t old_value;
 
     if (cluster < 2) {
         return (-1);
@@ -311,34 +707,111 @@ static int fat_put(struct fat16_t *self_p, fat_t cluster, fat_t value)
         return (-1);
     }
 
-    lba = self_p->fat_start_block + (cluster >> 8);
+    lba = fat_block(self_p, cluster);
+    block_p = cache_raw_block(self_p, lba, CACHE_FOR_WRITE, CACHE_PRIO_FAT);
 
-    if (lba != self_p->cache.block_number) {
-        if (cache_raw_block(self_p, lba, CACHE_FOR_READ) != 0) {
-            return (-1);
-        }
+    if (block_p == NULL) {
+        return (-1);
     }
 
-    self_p->cache.buffer.fat[cluster & 0xff] = value;
-    cache_set_dirty(&self_p->cache);
+    old_value = fat_entry_get(self_p, block_p, cluster);
+
+#if CONFIG_FAT16_FAT32 == 1
+    if (is_fat32(self_p)) {
+        /* The four most significant bits are reserved. */
+        block_p->buffer.fat32[cluster & 0x7f] &= ~ENTRY32_MASK;
+        block_p->buffer.fat32[cluster & 0x7f] |= (value & ENTRY32_MASK);
+    } else {
+        block_p->buffer.fat16[cluster & 0xff] = value;
+    }
+#else
+    block_p->buffer.fat16[cluster & 0xff] = value;
+#endif
 
     if (self_p->fat_count > 1) {
-        self_p->cache.mirror_block = (lba + self_p->blocks_per_fat);
+        block_p->mirror_block = (lba + self_p->blocks_per_fat);
+    }
+
+#if CONFIG_FAT16_FREE_BITMAP_SIZE > 0
+    free_bitmap_update(self_p, cluster, value);
+#endif
+
+    /* Keep the free cluster hints up to date. */
+    if ((old_value == 0) && (value != 0)) {
+        if (self_p->free_count != FREE_COUNT_UNKNOWN) {
+            self_p->free_count--;
+        }
+
+        self_p->next_free = (cluster + 1);
+
+        if (self_p->next_free > (self_p->cluster_count + 1)) {
+            self_p->next_free = 2;
+        }
+
+        self_p->fsinfo_dirty = 1;
+    } else if ((old_value != 0) && (value == 0)) {
+        if (self_p->free_count != FREE_COUNT_UNKNOWN) {
+            self_p->free_count++;
+        }
+
+        self_p->fsinfo_dirty = 1;
     }
 
     return (0);
 }
 
+/**
+ * Write the free cluster hints to the FSInfo block of a FAT32 volume,
+ * if changed.
+ */
+static int fsinfo_write(struct fat16_t *self_p)
+{
+    struct fat16_cache_block_t *block_p;
+    struct fsinfo_t *fsinfo_p;
+
+    if (!self_p->fsinfo_dirty || (self_p->fsinfo_block == 0)) {
+        return (0);
+    }
+
+    block_p = cache_raw_block(self_p,
+                              self_p->fsinfo_block,
+                              CACHE_FOR_WRITE,
+                              CACHE_PRIO_DATA);
+
+    if (block_p == NULL) {
+        return (-1);
+    }
+
+    fsinfo_p = &block_p->buffer.fsinfo;
+    fsinfo_p->free_count = self_p->free_count;
+
+    if (self_p->free_count == FREE_COUNT_UNKNOWN) {
+        fsinfo_p->free_count = 0xffffffff;
+    }
+
+    fsinfo_p->next_free = self_p->next_free;
+    self_p->fsinfo_dirty = 0;
+
+    return (0);
+}
+
 static struct dir_t* cache_dir_entry(struct fat16_t *self_p,
-                                     uint16_t block,
+                                     uint32_t block,
                                      uint16_t index,
                                      uint8_t action)
 {
-    if (cache_raw_block(self_p, block + (index >> 4), action) != 0) {
+    struct fat16_cache_block_t *block_p;
+
+    block_p = cache_raw_block(self_p,
+                              block + (index >> 4),
+                              action,
+                              CACHE_PRIO_DIR);
+
+    if (block_p == NULL) {
         return (NULL);
     }
 
-    return (&self_p->cache.buffer.dir[index & 0xf]);
+    return (&block_p->buffer.dir[index & 0xf]);
 }
 
 static int free_chain(struct fat16_t *self_p, fat_t cluster)
@@ -363,41 +836,76 @@ static int free_chain(struct fat16_t *self_p, fat_t cluster)
 }
 
 /**
- * Write the volume start block to disk.
+ * Forget all free cluster hints.
+ */
+static void free_hints_init(struct fat16_t *self_p)
+{
+    self_p->fsinfo_block = 0;
+    self_p->fsinfo_dirty = 0;
+    self_p->free_count = FREE_COUNT_UNKNOWN;
+    self_p->next_free = 2;
+#if CONFIG_FAT16_FREE_BITMAP_SIZE > 0
+    self_p->free_bitmap.valid = 0;
+#endif
+}
+
+/**
+ * Write given boot sector or FSInfo block to disk.
  */
 static int write_volume_block(struct fat16_t *self_p,
                               uint32_t volume_start_block,
-                              struct fbs_t *fbs_p)
+                              const void *fbs_p)
 {
+    struct fat16_cache_block_t *block_p;
+
     /* Cache volume start block. */
-    if (cache_raw_block(self_p, volume_start_block, CACHE_FOR_WRITE) != 0) {
+    block_p = cache_raw_block(self_p,
+                              volume_start_block,
+                              CACHE_FOR_WRITE,
+                              CACHE_PRIO_DATA);
+
+    if (block_p == NULL) {
         return (-1);
     }
 
     /* Write the boot sector to the start block. */
-    self_p->cache.buffer.fbs = *fbs_p;
+    memcpy(&block_p->buffer, fbs_p, sizeof(block_p->buffer));
 
     return (cache_flush(self_p));
 }
 
 static int format_fat_blocks(struct fat16_t *self_p,
                              uint32_t fat_start_block,
-                             uint32_t fat_end_block)
+                             uint32_t fat_end_block,
+                             int fat32)
 {
+    struct fat16_cache_block_t *block_p;
     uint32_t block;
 
     for (block = fat_start_block; block < fat_end_block; block++) {
         /* Cache the next block within the fat. */
-        if (cache_raw_block(self_p, block, CACHE_FOR_WRITE) != 0) {
-            return (-1);
+        block_p = cache_raw_block(self_p,
+                                  block,
+                                  CACHE_FOR_OVERWRITE,
+                                  CACHE_PRIO_FAT);
 
+        if (block_p == NULL) {
+            return (-1);
         }
+
         /* Format the block. */
-        memset(&self_p->cache.buffer, 0, sizeof(self_p->cache.buffer));
+        memset(&block_p->buffer, 0, sizeof(block_p->buffer));
 
         if (block == fat_start_block) {
-            self_p->cache.buffer.fat[0] = 0xfff8;
-            self_p->cache.buffer.fat[1] = 0xffff;
+            if (fat32) {
+                block_p->buffer.fat32[0] = 0x0ffffff8;
+                block_p->buffer.fat32[1] = EOC32;
+                /* The root directory. */
+                block_p->buffer.fat32[2] = EOC32;
+            } else {
+                block_p->buffer.fat16[0] = 0xfff8;
+                block_p->buffer.fat16[1] = 0xffff;
+            }
         }
 
         if (cache_flush(self_p) != 0) {
@@ -412,16 +920,22 @@ static int format_root_dir_blocks(struct fat16_t *self_p,
                                   uint32_t root_dir_start_block,
                                   uint32_t root_dir_end_block)
 {
+    struct fat16_cache_block_t *block_p;
     uint32_t block;
 
     for (block = root_dir_start_block; block < root_dir_end_block; block++) {
         /* Cache the next block within the root directory. */
-        if (cache_raw_block(self_p, block, CACHE_FOR_WRITE) != 0) {
+        block_p = cache_raw_block(self_p,
+                                  block,
+                                  CACHE_FOR_OVERWRITE,
+                                  CACHE_PRIO_DIR);
+
+        if (block_p == NULL) {
             return (-1);
         }
 
         /* Clear the block. */
-        memset(&self_p->cache.buffer, 0, sizeof(self_p->cache.buffer));
+        memset(&block_p->buffer, 0, sizeof(block_p->buffer));
 
         /* The flush function writes to the mirrored fat block as well. */
         if (cache_flush(self_p) != 0) {
@@ -432,6 +946,35 @@ static int format_root_dir_blocks(struct fat16_t *self_p,
     return (0);
 }
 
+int fat16_module_init(void)
+{
+    /* Return immediately if the module is already initialized. */
+    if (module.initialized == 1) {
+        return (0);
+    }
+
+    module.initialized = 1;
+
+#if CONFIG_FAT16_CACHE_COUNTERS == 1
+    fs_counter_init(&module.cache_hits,
+                    CSTR("/filesystems/fat16/cache/hits"),
+                    0);
+    fs_counter_register(&module.cache_hits);
+
+    fs_counter_init(&module.cache_misses,
+                    CSTR("/filesystems/fat16/cache/misses"),
+                    0);
+    fs_counter_register(&module.cache_misses);
+
+    fs_counter_init(&module.cache_writes,
+                    CSTR("/filesystems/fat16/cache/writes"),
+                    0);
+    fs_counter_register(&module.cache_writes);
+#endif
+
+    return (0);
+}
+
 int fat16_init(struct fat16_t *self_p,
                fat16_read_t read,
                fat16_write_t write,
@@ -447,11 +990,29 @@ int fat16_init(struct fat16_t *self_p,
         return (-EINVAL);
     }
 
+    fat16_module_init();
+
     /* Initialize datastructure.*/
     self_p->read = read;
     self_p->write = write;
+    self_p->read_blocks = NULL;
+    self_p->write_blocks = NULL;
     self_p->arg_p = arg_p;
     self_p->partition = partition;
+    cache_init(self_p);
+    free_hints_init(self_p);
+
+    return (0);
+}
+
+int fat16_set_blocks_callbacks(struct fat16_t *self_p,
+                               fat16_read_blocks_t read_blocks,
+                               fat16_write_blocks_t write_blocks)
+{
+    ASSERTN(self_p != NULL, EINVAL);
+
+    self_p->read_blocks = read_blocks;
+    self_p->write_blocks = write_blocks;
 
     return (0);
 }
@@ -461,73 +1022,177 @@ int fat16_mount(struct fat16_t *self_p)
     ASSERTN(self_p != NULL, EINVAL);
 
     uint32_t total_blocks;
+    uint32_t cluster_count;
     struct bpb_t* bpb_p;
+    struct fat16_cache_block_t *block_p;
+#if CONFIG_FAT16_FAT32 == 1
+    struct fsinfo_t *fsinfo_p;
+    uint16_t fat32_flags = 0;
+#endif
 
     /* Initialize the cache. */
-    self_p->cache.block_number = 0xffffffff;
-    self_p->cache.dirty = 0;
-    self_p->cache.mirror_block = 0;
+    cache_init(self_p);
+    free_hints_init(self_p);
     self_p->volume_start_block = 0;
 
     /* If part == 0 assume super floppy with FAT16 boot sector in
        block zero. */
     /* If part > 0 assume mbr volume with partition table. */
     if (self_p->partition > 0) {
-        if (cache_raw_block(self_p,
-                            self_p->volume_start_block,
-                            CACHE_FOR_READ) != 0) {
+        block_p = cache_raw_block(self_p,
+                                  self_p->volume_start_block,
+                                  CACHE_FOR_READ,
+                                  CACHE_PRIO_DATA);
+
+        if (block_p == NULL) {
             return (-1);
         }
 
         self_p->volume_start_block =
-            self_p->cache.buffer.mbr.part[self_p->partition - 1].first_sector;
+            block_p->buffer.mbr.part[self_p->partition - 1].first_sector;
     }
 
-    if (cache_raw_block(self_p, self_p->volume_start_block, CACHE_FOR_READ) != 0) {
+    block_p = cache_raw_block(self_p,
+                              self_p->volume_start_block,
+                              CACHE_FOR_READ,
+                              CACHE_PRIO_DATA);
+
+    if (block_p == NULL) {
         return (-1);
     }
 
     /* Check boot block signature. */
-    if (self_p->cache.buffer.fbs.boot_sector_sig != BOOTSIG) {
+    if (block_p->buffer.fbs.boot_sector_sig != BOOTSIG) {
+        return (-1);
+    }
+
+    bpb_p = &block_p->buffer.fbs.bpb;
+
+    /* Check valid FAT volume. */
+    if ((bpb_p->bytes_per_sector != 512)       /* Only allow 512 byte
+                                                  blocks. */
+        || (bpb_p->reserved_sector_count == 0) /* Invalid volume. */
+        || (bpb_p->fat_count == 0)             /* Invalid volume. */
+        || (bpb_p->sectors_per_cluster == 0)
+        || (bpb_p->sectors_per_cluster
+            & (bpb_p->sectors_per_cluster - 1))) {
         return (-1);
     }
 
-    bpb_p = &self_p->cache.buffer.fbs.bpb;
     self_p->fat_count = bpb_p->fat_count;
     self_p->blocks_per_cluster = bpb_p->sectors_per_cluster;
     self_p->blocks_per_fat = bpb_p->sectors_per_fat;
     self_p->root_dir_entry_count = bpb_p->root_dir_entry_count;
     self_p->fat_start_block = (self_p->volume_start_block
                                + bpb_p->reserved_sector_count);
+    self_p->root_dir_cluster = 0;
+
+#if CONFIG_FAT16_FAT32 == 1
+    /* Sectors per FAT is zero for FAT32. */
+    if (bpb_p->sectors_per_fat == 0) {
+        self_p->blocks_per_fat = block_p->buffer.fbs32.sectors_per_fat32;
+        self_p->root_dir_cluster = block_p->buffer.fbs32.fat32_root_cluster;
+        fat32_flags = block_p->buffer.fbs32.fat32_flags;
+
+        if (block_p->buffer.fbs32.fat32_fsinfo != 0) {
+            self_p->fsinfo_block = (self_p->volume_start_block
+                                    + block_p->buffer.fbs32.fat32_fsinfo);
+        }
+    }
+#endif
+
+    if (self_p->blocks_per_fat == 0) {
+        return (-1);
+    }
+
     self_p->root_dir_start_block =
         (self_p->fat_start_block
-         + bpb_p->fat_count * bpb_p->sectors_per_fat);
+         + bpb_p->fat_count * self_p->blocks_per_fat);
     self_p->data_start_block =
         (self_p->root_dir_start_block
          + ((32 * bpb_p->root_dir_entry_count + 511) / 512));
     total_blocks = (bpb_p->total_sectors_small
                     ? bpb_p->total_sectors_small
                     : bpb_p->total_sectors_large);
-    self_p->cluster_count =
+
+    if (total_blocks < (self_p->data_start_block - self_p->volume_start_block)) {
+        return (-1);
+    }
+
+    cluster_count =
         ((total_blocks - (self_p->data_start_block - self_p->volume_start_block))
          / bpb_p->sectors_per_cluster);
 
-    /* Check valid FAT16 volume. */
-    if ((bpb_p->bytes_per_sector != 512)       /* Only allow 512 byte
-                                                  blocks. */
-        || (bpb_p->sectors_per_fat == 0)       /* Zero for FAT32. */
-        || (self_p->cluster_count < 4085)      /* FAT12 if true. */
-        || (total_blocks > 0x800000)           /* Max size for FAT16
+    /* The FAT type is given by the number of clusters. */
+    if (cluster_count < 4085) {
+        /* FAT12. */
+        return (-1);
+    } else if (cluster_count < 65525) {
+        self_p->fat_type = 16;
+
+        if ((bpb_p->sectors_per_fat == 0)
+            || (bpb_p->root_dir_entry_count == 0)
+            || (total_blocks > 0x800000)       /* Max size for FAT16
                                                   volume. */
-        || (bpb_p->reserved_sector_count == 0) /* Invalid volume. */
-        || (bpb_p->fat_count == 0)             /* Invalid volume. */
-        || (bpb_p->sectors_per_fat < (self_p->cluster_count >> 8))
-        || (bpb_p->sectors_per_cluster == 0)
-        || (bpb_p->sectors_per_cluster
-            & (bpb_p->sectors_per_cluster - 1))) {
+            || (self_p->blocks_per_fat < (cluster_count >> 8))) {
+            return (-1);
+        }
+    } else {
+#if CONFIG_FAT16_FAT32 == 1
+        self_p->fat_type = 32;
+
+        if ((bpb_p->sectors_per_fat != 0)
+            || (self_p->blocks_per_fat < ((cluster_count + 2 + 127) >> 7))
+            || (self_p->root_dir_cluster < 2)
+            || (self_p->root_dir_cluster > cluster_count + 1)) {
+            return (-1);
+        }
+
+        /* Only the active FAT is used if mirroring is disabled. */
+        if (fat32_flags & 0x80) {
+            self_p->fat_start_block += ((fat32_flags & 0xf)
+                                        * self_p->blocks_per_fat);
+            self_p->fat_count = 1;
+        }
+#else
         return (-1);
+#endif
     }
 
+    self_p->cluster_count = cluster_count;
+
+#if CONFIG_FAT16_FAT32 == 1
+    /* Read the free cluster hints. They are only hints, so ignore
+       invalid values. */
+    if (self_p->fsinfo_block != 0) {
+        block_p = cache_raw_block(self_p,
+                                  self_p->fsinfo_block,
+                                  CACHE_FOR_READ,
+                                  CACHE_PRIO_DATA);
+
+        if (block_p == NULL) {
+            return (-1);
+        }
+
+        fsinfo_p = &block_p->buffer.fsinfo;
+
+        if ((fsinfo_p->lead_signature != FSINFO_LEAD_SIGNATURE)
+            || (fsinfo_p->struct_signature != FSINFO_STRUCT_SIGNATURE)
+            || (fsinfo_p->trail_signature != FSINFO_TRAIL_SIGNATURE)) {
+            self_p->fsinfo_block = 0;
+        } else {
+            if (fsinfo_p->free_count <= cluster_count) {
+                self_p->free_count = fsinfo_p->free_count;
+            }
+
+            if ((fsinfo_p->next_free >= 2)
+                && (fsinfo_p->next_free <= cluster_count + 1)) {
+                self_p->next_free = fsinfo_p->next_free;
+            }
+        }
+    }
+#endif
+
     return (0);
 }
 
@@ -535,6 +1200,10 @@ int fat16_unmount(struct fat16_t *self_p)
 {
     ASSERTN(self_p != NULL, EINVAL);
 
+    if (fsinfo_write(self_p) != 0) {
+        return (-1);
+    }
+
     return (cache_flush(self_p));
 }
 
@@ -550,9 +1219,8 @@ int fat16_format(struct fat16_t *self_p)
     uint32_t root_dir_block_count;
 
     /* Initialize the cache. */
-    self_p->cache.block_number = 0xffffffff;
-    self_p->cache.dirty = 0;
-    self_p->cache.mirror_block = 0;
+    cache_init(self_p);
+    free_hints_init(self_p);
 
     volume_start_block = 0;
 
@@ -599,14 +1267,16 @@ int fat16_format(struct fat16_t *self_p)
 
     if (format_fat_blocks(self_p,
                           fat_start_block,
-                          fat_start_block + blocks_per_fat) != 0) {
+                          fat_start_block + blocks_per_fat,
+                          0) != 0) {
         return (-1);
     }
 
     if (fbs.bpb.fat_count > 1) {
         if (format_fat_blocks(self_p,
                               fat_start_block + blocks_per_fat,
-                              fat_start_block + 2 * blocks_per_fat) != 0) {
+                              fat_start_block + 2 * blocks_per_fat,
+                              0) != 0) {
             return (-1);
         }
     }
@@ -620,26 +1290,163 @@ int fat16_format(struct fat16_t *self_p)
     return (0);
 }
 
+int fat16_format_fat32(struct fat16_t *self_p, uint32_t block_count)
+{
+    ASSERTN(self_p != NULL, EINVAL);
+
+#if CONFIG_FAT16_FAT32 == 1
+    struct fbs32_t fbs;
+    struct fsinfo_t fsinfo;
+    uint8_t blocks_per_cluster;
+    uint32_t fat_start_block;
+    uint32_t blocks_per_fat;
+    uint32_t data_start_block;
+    uint32_t cluster_count;
+
+    /* Initialize the cache. */
+    cache_init(self_p);
+    free_hints_init(self_p);
+
+    /* Cluster size recommended by Microsoft. */
+    if (block_count <= 532480) {
+        blocks_per_cluster = 1;
+    } else if (block_count <= 16777216) {
+        blocks_per_cluster = 8;
+    } else if (block_count <= 33554432) {
+        blocks_per_cluster = 16;
+    } else if (block_count <= 67108864) {
+        blocks_per_cluster = 32;
+    } else {
+        blocks_per_cluster = 64;
+    }
+
+    /* Make the FATs large enough for all blocks after the reserved
+       blocks, which is slightly more than needed. */
+    fat_start_block = 32;
+
+    if (block_count <= fat_start_block) {
+        return (-1);
+    }
+
+    blocks_per_fat = (((block_count - fat_start_block) / blocks_per_cluster
+                       + 2) * 4 + 511) / 512;
+    data_start_block = (fat_start_block + 2 * blocks_per_fat);
+
+    if (block_count <= data_start_block) {
+        return (-1);
+    }
+
+    cluster_count = ((block_count - data_start_block) / blocks_per_cluster);
+
+    /* FAT16 if true. */
+    if (cluster_count < 65525) {
+        return (-1);
+    }
+
+    /* Initiate the boot sector. */
+    memset(&fbs, 0, sizeof(fbs));
+    fbs.jmp_to_boot_code[0] = 0xeb;
+    fbs.jmp_to_boot_code[1] = 0x58;
+    fbs.jmp_to_boot_code[2] = 0x90;
+    memcpy(fbs.oem_name, "simba   ", sizeof(fbs.oem_name));
+
+    fbs.bpb.bytes_per_sector = 512;
+    fbs.bpb.sectors_per_cluster = blocks_per_cluster;
+    fbs.bpb.reserved_sector_count = fat_start_block;
+    fbs.bpb.fat_count = 2;
+    fbs.bpb.root_dir_entry_count = 0;
+    fbs.bpb.total_sectors_small = 0;
+    fbs.bpb.media_type = 248;
+    fbs.bpb.sectors_per_fat = 0;
+    fbs.bpb.sectors_per_track = 32;
+    fbs.bpb.head_count = 64;
+    fbs.bpb.hiddden_sectors = 0;
+    fbs.bpb.total_sectors_large = block_count;
+
+    fbs.sectors_per_fat32 = blocks_per_fat;
+    fbs.fat32_flags = 0;
+    fbs.fat32_version = 0;
+    fbs.fat32_root_cluster = 2;
+    fbs.fat32_fsinfo = 1;
+    fbs.fat32_back_boot_block = 6;
+
+    fbs.drive_number = 128;
+    fbs.boot_signature = 41;
+    fbs.volume_serial_number = 1817095464;
+    memcpy(fbs.volume_label, "NO NAME    ", sizeof(fbs.volume_label));
+    memcpy(fbs.file_system_type, "FAT32   ", sizeof(fbs.file_system_type));
+    fbs.boot_sector_sig = BOOTSIG;
+
+    /* Initiate the FSInfo block. The root directory uses cluster
+       two. */
+    memset(&fsinfo, 0, sizeof(fsinfo));
+    fsinfo.lead_signature = FSINFO_LEAD_SIGNATURE;
+    fsinfo.struct_signature = FSINFO_STRUCT_SIGNATURE;
+    fsinfo.free_count = (cluster_count - 1);
+    fsinfo.next_free = 3;
+    fsinfo.trail_signature = FSINFO_TRAIL_SIGNATURE;
+
+    /* The boot sector and FSInfo block, and their backups. */
+    if (write_volume_block(self_p, 0, &fbs) != 0) {
+        return (-1);
+    }
+
+    if (write_volume_block(self_p, 1, &fsinfo) != 0) {
+        return (-1);
+    }
+
+    if (write_volume_block(self_p, 6, &fbs) != 0) {
+        return (-1);
+    }
+
+    if (write_volume_block(self_p, 7, &fsinfo) != 0) {
+        return (-1);
+    }
+
+    if (format_fat_blocks(self_p,
+                          fat_start_block,
+                          fat_start_block + blocks_per_fat,
+                          1) != 0) {
+        return (-1);
+    }
+
+    if (format_fat_blocks(self_p,
+                          fat_start_block + blocks_per_fat,
+                          fat_start_block + 2 * blocks_per_fat,
+                          1) != 0) {
+        return (-1);
+    }
+
+    return (format_root_dir_blocks(self_p,
+                                   data_start_block,
+                                   data_start_block + blocks_per_cluster));
+#else
+    return (-ENOSYS);
+#endif
+}
+
 int fat16_print(struct fat16_t *self_p, void *chan_p)
 {
     ASSERTN(self_p != NULL, EINVAL);
     ASSERTN(chan_p != NULL, EINVAL);
 
     std_fprintf(chan_p,
-                FSTR("fat_count = %u\r\n"
+                FSTR("fat_type = %u\r\n"
+                     "fat_count = %u\r\n"
                      "blocks_per_cluster = %u\r\n"
                      "root_dir_entry_count = %u\r\n"
-                     "blocks_per_fat = %u\r\n"
-                     "cluster_count = %u\r\n"
+                     "blocks_per_fat = %lu\r\n"
+                     "cluster_count = %lu\r\n"
                      "volume_start_block = %lu\r\n"
                      "fat_start_block = %lu\r\n"
                      "root_dir_start_block = %lu\r\n"
                      "data_start_block = %lu\r\n"),
+                (unsigned int)self_p->fat_type,
                 (unsigned int)self_p->fat_count,
                 (unsigned int)self_p->blocks_per_cluster,
                 (unsigned int)self_p->root_dir_entry_count,
-                (unsigned int)self_p->blocks_per_fat,
-                (unsigned int)self_p->cluster_count,
+                (unsigned long)self_p->blocks_per_fat,
+                (unsigned long)self_p->cluster_count,
                 (unsigned long)self_p->volume_start_block,
                 (unsigned long)self_p->fat_start_block,
                 (unsigned long)self_p->root_dir_start_block,
@@ -648,44 +1455,98 @@ int fat16_print(struct fat16_t *self_p, void *chan_p)
     return (0);
 }
 
-static int add_cluster(struct fat16_file_t *file_p)
+/**
+ * Find `count` consecutive free clusters, starting the search at
+ * given cluster. Returns the first cluster in the run, or zero(0) if
+ * no such run was found.
+ */
+static fat_t find_free_clusters(struct fat16_t *self_p,
+                                fat_t cluster,
+                                fat_t count)
 {
-    /* Start search after last cluster of file or at cluster two in FAT. */
-    fat_t free_cluster = file_p->cur_cluster ? file_p->cur_cluster : 1;
-    fat_t value;
     fat_t i;
-    fat_t cluster_count = file_p->fat16_p->cluster_count;
+    fat_t first;
+    fat_t length;
+    int res;
 
-    for (i = 0; ; i++) {
-        /* Return no free clusters. */
-        if (i >= cluster_count) {
-            return (-1);
+    first = 0;
+    length = 0;
+
+    for (i = 0; i < self_p->cluster_count; i++) {
+        /* Fat has cluster_count + 2 entries. A run cannot wrap. */
+        if ((cluster < 2) || (cluster > self_p->cluster_count + 1)) {
+            cluster = 2;
+            length = 0;
         }
 
-        /* Fat has cluster_count + 2 entries. */
-        if (free_cluster > cluster_count) {
-            free_cluster = 1;
+        res = cluster_is_free(self_p, cluster);
+
+        if (res < 0) {
+            return (0);
+        }
+
+        if (res == 1) {
+            if (length == 0) {
+                first = cluster;
+            }
+
+            length++;
+
+            if (length == count) {
+                return (first);
+            }
+        } else {
+            length = 0;
         }
 
-        free_cluster++;
+        cluster++;
+    }
+
+    return (0);
+}
 
-        if (fat_get(file_p->fat16_p, free_cluster, &value) != 0) {
+static int add_cluster(struct fat16_file_t *file_p)
+{
+    struct fat16_t *self_p;
+    fat_t free_cluster;
+    int res;
+
+    self_p = file_p->fat16_p;
+    free_cluster = 0;
+
+    /* Keep the file contiguous if the cluster after the last cluster
+       of the file is free. */
+    if ((file_p->cur_cluster != 0)
+        && (file_p->cur_cluster <= self_p->cluster_count)) {
+        res = cluster_is_free(self_p, file_p->cur_cluster + 1);
+
+        if (res < 0) {
             return (-1);
         }
 
-        if (value == 0) {
-            break;
+        if (res == 1) {
+            free_cluster = (file_p->cur_cluster + 1);
+        }
+    }
+
+    /* Otherwise start the search at the free cluster hint. */
+    if (free_cluster == 0) {
+        free_cluster = find_free_clusters(self_p, self_p->next_free, 1);
+
+        /* Return no free clusters. */
+        if (free_cluster == 0) {
+            return (-1);
         }
     }
 
     /* Mark cluster allocated. */
-    if (fat_put(file_p->fat16_p, free_cluster, EOC16) != 0) {
+    if (fat_put(self_p, free_cluster, EOC) != 0) {
         return (-1);
     }
 
     if (file_p->cur_cluster != 0) {
         /* Link cluster to chain. */
-        if (fat_put(file_p->fat16_p, file_p->cur_cluster, free_cluster) != 0) {
+        if (fat_put(self_p, file_p->cur_cluster, free_cluster) != 0) {
             return (-1);
         }
     } else {
@@ -703,19 +1564,31 @@ static int dir_init(struct dir_t *dir_p,
                     uint8_t *name_p,
                     uint8_t attributes)
 {
+#if CONFIG_TIME_FORMAT == 1
+    uint16_t date;
+    uint16_t time;
+#endif
+
     /* Initialize as empty file. */
     memset(dir_p, 0, sizeof(*dir_p));
     memcpy(dir_p->name, name_p, 11);
 
     dir_p->attributes = attributes;
 
-    /* Set timestamps with user function or use default date/time. */
-    /* if (dateTime) { */
-    /*     dateTime(&dir_p->creationDate, &dir_p->creationTime); */
-    /* } else { */
+    /* Use the current date and time if set, otherwise the default
+       date/time. */
+#if CONFIG_TIME_FORMAT == 1
+    if (time_format_fat(&date, &time) == 0) {
+        dir_p->creation_date = date;
+        dir_p->creation_time = time;
+    } else {
+        dir_p->creation_date = DEFAULT_DATE;
+        dir_p->creation_time = DEFAULT_TIME;
+    }
+#else
     dir_p->creation_date = DEFAULT_DATE;
     dir_p->creation_time = DEFAULT_TIME;
-    /* } */
+#endif
 
     dir_p->last_access_date = dir_p->creation_date;
     dir_p->last_write_date = dir_p->creation_date;
@@ -729,7 +1602,7 @@ static int get_dir_at_index_in_root(struct fat16_t *self_p,
                                     struct dir_t *dir_p)
 {
     int dir_entries_per_block;
-    int block;
+    uint32_t block;
     struct dir_t *d_p;
 
     dir_entries_per_block = (512 / sizeof(struct dir_t));
@@ -767,49 +1640,134 @@ static int get_dir_at_index_in_root(struct fat16_t *self_p,
  */
 static int dir_open_in_blocks(struct fat16_t *self_p,
                               const uint8_t *name_p,
-                              int16_t *block_p,
+                              uint32_t *block_p,
                               int16_t *index_p,
-                              int start_block,
-                              int end_block)
+                              uint32_t start_block,
+                              uint32_t end_block)
 {
-    int16_t block;
+    uint32_t block;
     int16_t index;
     int dir_entries_per_block;
     struct dir_t *dir_p;
 
-    dir_entries_per_block = (512 / sizeof(*dir_p));
+    dir_entries_per_block = (512 / sizeof(*dir_p));
+
+    for (block = start_block; block < end_block; block++) {
+        for (index = 0; index < dir_entries_per_block; index++) {
+            if (!(dir_p = cache_dir_entry(self_p,
+                                          block,
+                                          index,
+                                          CACHE_FOR_READ))) {
+                return (-1);
+            }
+
+            if ((dir_p->name[0] == DIR_NAME_FREE)
+                || (dir_p->name[0] == DIR_NAME_DELETED)) {
+                /* Remember first empty slot */
+                if (*index_p < 0) {
+                    *block_p = block;
+                    *index_p = index;
+                }
+
+                /* Done if no entries follow. */
+                if (dir_p->name[0] == DIR_NAME_FREE) {
+                    return (0);
+                }
+            } else if (memcmp(name_p, dir_p->name, 11) == 0) {
+                /* Existing file. */
+                *block_p = block;
+                *index_p = index;
+                return (1);
+            }
+        }
+    }
+
+    return (0);
+}
+
+/**
+ * Open directory with given name in the directory starting at given
+ * cluster.
+ *
+ * @param[out] index_p If true(1) is returned this is the index of an
+ *                     existing file. If false(0) is returned this is
+ *                     the index of the first empty directory
+ *                     entry. Otherwise ignore this value.
+ *
+ * @return zero(0) or negative error code.
+ */
+static int dir_open_in_chain(struct fat16_t *self_p,
+                             const uint8_t *name_p,
+                             fat_t cluster,
+                             int extend,
+                             uint32_t *block_p,
+                             int16_t *index_p)
+{
+    uint32_t start_block;
+    fat_t next;
+    int res = -1;
+
+    *index_p = -1;         /* index of empty slot. */
+
+    /* Iterate over clusters allocated by this folder. */
+    while (1) {
+        start_block = (self_p->data_start_block
+                       + ((cluster - 2) * self_p->blocks_per_cluster));
+
+        if ((res = dir_open_in_blocks(self_p,
+                                      name_p,
+                                      block_p,
+                                      index_p,
+                                      start_block,
+                                      start_block + self_p->blocks_per_cluster)) < 0) {
+            return (-1);
+        }
+
+        if (res == 1) {
+            return (res);
+        }
+
+        if (fat_get(self_p, cluster, &next) != 0) {
+            return (-1);
+        }
+
+        if (is_end_of_cluster(next)) {
+            break;
+        }
+
+        cluster = next;
+    }
+
+    /* Add an empty cluster to a full directory. */
+    if ((*index_p < 0) && extend) {
+        next = find_free_clusters(self_p, self_p->next_free, 1);
 
-    for (block = start_block; block < end_block; block++) {
-        for (index = 0; index < dir_entries_per_block; index++) {
-            if (!(dir_p = cache_dir_entry(self_p,
-                                          block,
-                                          index,
-                                          CACHE_FOR_READ))) {
-                return (-1);
-            }
+        if (next == 0) {
+            return (-1);
+        }
 
-            if ((dir_p->name[0] == DIR_NAME_FREE)
-                || (dir_p->name[0] == DIR_NAME_DELETED)) {
-                /* Remember first empty slot */
-                if (*index_p < 0) {
-                    *block_p = block;
-                    *index_p = index;
-                }
+        if (fat_put(self_p, next, EOC) != 0) {
+            return (-1);
+        }
 
-                /* Done if no entries follow. */
-                if (dir_p->name[0] == DIR_NAME_FREE) {
-                    return (0);
-                }
-            } else if (memcmp(name_p, dir_p->name, 11) == 0) {
-                /* Existing file. */
-                *block_p = block;
-                *index_p = index;
-                return (1);
-            }
+        if (fat_put(self_p, cluster, next) != 0) {
+            return (-1);
+        }
+
+        start_block = (self_p->data_start_block
+                       + ((next - 2) * self_p->blocks_per_cluster));
+
+        if (format_root_dir_blocks(self_p,
+                                   start_block,
+                                   start_block + self_p->blocks_per_cluster) != 0) {
+            return (-1);
         }
+
+        *block_p = start_block;
+        *index_p = 0;
     }
 
-    return (0);
+    return (res);
 }
 
 /**
@@ -824,12 +1782,23 @@ static int dir_open_in_blocks(struct fat16_t *self_p,
  */
 static int dir_open_in_root(struct fat16_t *self_p,
                             const uint8_t *name_p,
-                            int16_t *block_p,
+                            int extend,
+                            uint32_t *block_p,
                             int16_t *index_p)
 {
     int root_dir_block_count;
     int dir_entries_per_block;
 
+    /* The FAT32 root directory is a cluster chain. */
+    if (is_fat32(self_p)) {
+        return (dir_open_in_chain(self_p,
+                                  name_p,
+                                  self_p->root_dir_cluster,
+                                  extend,
+                                  block_p,
+                                  index_p));
+    }
+
     *index_p = -1;         /* index of empty slot. */
     dir_entries_per_block = (512 / sizeof(struct dir_t));
     root_dir_block_count = (self_p->root_dir_entry_count / dir_entries_per_block);
@@ -855,13 +1824,11 @@ static int dir_open_in_root(struct fat16_t *self_p,
  */
 static int dir_open_in_subdir(struct fat16_t *self_p,
                               const uint8_t *name_p,
-                              int16_t *block_p,
+                              int extend,
+                              uint32_t *block_p,
                               int16_t *index_p)
 {
-    fat_t cluster;
-    int start_block;
     struct dir_t *dir_p;
-    int res = -1;
 
     /* Cache the parent directory. */
     if (!(dir_p = cache_dir_entry(self_p,
@@ -871,31 +1838,13 @@ static int dir_open_in_subdir(struct fat16_t *self_p,
         return (-1);
     }
 
-    *index_p = -1;         /* index of empty slot. */
-
-    /* Search for the file in the subdirectory. Iterate over clusters
-       allocated by this folder. */
-    cluster = dir_p->first_cluster_low;
-
-    do {
-        start_block = (self_p->data_start_block
-                       + ((cluster - 2) * self_p->blocks_per_cluster));
-
-        if ((res = dir_open_in_blocks(self_p,
-                                      name_p,
-                                      block_p,
-                                      index_p,
-                                      start_block,
-                                      start_block + self_p->blocks_per_cluster)) < 0) {
-            return (-1);
-        }
-
-        if (fat_get(self_p, cluster, &cluster) != 0) {
-            return (-1);
-        }
-    } while (!is_end_of_cluster(cluster));
-
-    return (res);
+    /* Search for the file in the subdirectory. */
+    return (dir_open_in_chain(self_p,
+                              name_p,
+                              dir_first_cluster(self_p, dir_p),
+                              extend,
+                              block_p,
+                              index_p));
 }
 
 /**
@@ -939,14 +1888,15 @@ static int dir_open(struct fat16_t *self_p,
                     const char *path_p,
                     int oflag,
                     uint8_t attributes,
-                    int16_t *block_p,
+                    uint32_t *block_p,
                     int16_t *index_p)
 {
     uint8_t dname[11];              /* name formated for dir entry. */
     struct dir_t *dir_p = NULL;     /* pointer to cached dir entry. */
     int res;
+    int extend;
     int depth = 0;
-    int16_t parent_block = -1;
+    uint32_t parent_block = 0;
     int16_t parent_index = -1;
 
     do {
@@ -954,12 +1904,17 @@ static int dir_open(struct fat16_t *self_p,
             return (-1);
         }
 
+        /* A full folder is extended if the last name in the path is
+           about to be created. */
+        extend = ((path_p == NULL)
+                  && ((oflag & (O_CREAT | O_WRITE)) == (O_CREAT | O_WRITE)));
+
         if (depth == 0) {
             /* Search for the name in the root folder. */
-            res = dir_open_in_root(self_p, dname, block_p, index_p);
+            res = dir_open_in_root(self_p, dname, extend, block_p, index_p);
         } else {
             /* Search for the name in a subfolder. */
-            res = dir_open_in_subdir(self_p, dname, block_p, index_p);
+            res = dir_open_in_subdir(self_p, dname, extend, block_p, index_p);
         }
 
         if (res < 0) {
@@ -1030,11 +1985,47 @@ static int dir_open(struct fat16_t *self_p,
     return (0);
 }
 
+/**
+ * Move to the next cluster of given file when writing at the start of
+ * a cluster, adding a cluster at the end of the chain.
+ */
+static int get_cluster(struct fat16_file_t *file_p)
+{
+    fat_t next;
+
+    if (file_p->cur_cluster == 0) {
+        if (file_p->first_cluster == 0) {
+            /* Allocate first cluster of file. */
+            if (add_cluster(file_p) != 0) {
+                return (FAT16_EOF);
+            }
+        } else {
+            file_p->cur_cluster = file_p->first_cluster;
+        }
+    } else {
+        if (fat_get(file_p->fat16_p, file_p->cur_cluster, &next) != 0) {
+            return (FAT16_EOF);
+        }
+
+        if (is_end_of_cluster(next)) {
+            /* Add cluster if at end of chain. */
+            if (add_cluster(file_p) != 0) {
+                return (FAT16_EOF);
+            }
+        } else {
+            file_p->cur_cluster = next;
+        }
+    }
+
+    return (0);
+}
+
 static int get_block(struct fat16_file_t *file_p,
-                     uint16_t *block_offset_p)
+                     uint16_t *block_offset_p,
+                     struct fat16_cache_block_t **block_pp)
 {
+    struct fat16_cache_block_t *block_p;
     uint8_t blk_of_cluster;
-    fat_t next;
     uint32_t lba;
 
     blk_of_cluster = block_of_cluster(file_p->fat16_p->blocks_per_cluster,
@@ -1044,28 +2035,8 @@ static int get_block(struct fat16_file_t *file_p,
 
     if ((blk_of_cluster == 0) && (*block_offset_p == 0)) {
         /* Start of new cluster. */
-        if (file_p->cur_cluster == 0) {
-            if (file_p->first_cluster == 0) {
-                /* Allocate first cluster of file. */
-                if (add_cluster(file_p) != 0) {
-                    return (FAT16_EOF);
-                }
-            } else {
-                file_p->cur_cluster = file_p->first_cluster;
-            }
-        } else {
-            if (fat_get(file_p->fat16_p, file_p->cur_cluster, &next) != 0) {
-                return (FAT16_EOF);
-            }
-
-            if (is_end_of_cluster(next)) {
-                /* Add cluster if at end of chain. */
-                if (add_cluster(file_p) != 0) {
-                    return (FAT16_EOF);
-                }
-            } else {
-                file_p->cur_cluster = next;
-            }
+        if (get_cluster(file_p) != 0) {
+            return (FAT16_EOF);
         }
     }
 
@@ -1073,32 +2044,169 @@ static int get_block(struct fat16_file_t *file_p,
 
     if ((*block_offset_p == 0) && (file_p->cur_position >= file_p->file_size)) {
         /* Start of new block don't need to read into cache. */
-        if (cache_flush(file_p->fat16_p) != 0) {
+        block_p = cache_raw_block(file_p->fat16_p,
+                                  lba,
+                                  CACHE_FOR_OVERWRITE,
+                                  CACHE_PRIO_DATA);
+
+        if (block_p == NULL) {
             return (FAT16_EOF);
         }
 
-        file_p->fat16_p->cache.block_number = lba;
-        memset(&file_p->fat16_p->cache.buffer,
-               0,
-               sizeof(file_p->fat16_p->cache.buffer));
-        cache_set_dirty(&file_p->fat16_p->cache);
+        memset(&block_p->buffer, 0, sizeof(block_p->buffer));
     } else {
         /* Rewrite part of block. */
-        if (cache_raw_block(file_p->fat16_p, lba, CACHE_FOR_WRITE) != 0) {
+        block_p = cache_raw_block(file_p->fat16_p,
+                                  lba,
+                                  CACHE_FOR_WRITE,
+                                  CACHE_PRIO_DATA);
+
+        if (block_p == NULL) {
             return (FAT16_EOF);
         }
     }
 
+    *block_pp = block_p;
+
     return (0);
 }
 
+/**
+ * Read whole blocks at the current block aligned position directly
+ * into given buffer, following contiguous clusters. The cache is
+ * bypassed.
+ *
+ * @return Number of read bytes, zero(0) if fewer than two blocks can
+ *         be read at once, or negative error code.
+ */
+static ssize_t file_read_blocks(struct fat16_file_t *file_p,
+                                uint8_t *dst_p,
+                                size_t size,
+                                uint8_t blk_of_cluster)
+{
+    struct fat16_t *self_p;
+    uint8_t blocks_per_cluster;
+    size_t count;
+    size_t wanted;
+    fat_t cluster;
+    fat_t next;
+    uint32_t lba;
+
+    self_p = file_p->fat16_p;
+
+    if (self_p->read_blocks == NULL) {
+        return (0);
+    }
+
+    wanted = (size / BLOCK_SIZE);
+
+    if (wanted < 2) {
+        return (0);
+    }
+
+    blocks_per_cluster = self_p->blocks_per_cluster;
+    count = (blocks_per_cluster - blk_of_cluster);
+    cluster = file_p->cur_cluster;
+
+    while (count < wanted) {
+        if (fat_get(self_p, cluster, &next) != 0) {
+            return (-1);
+        }
+
+        if (next != (fat_t)(cluster + 1)) {
+            break;
+        }
+
+        cluster = next;
+        count += blocks_per_cluster;
+    }
+
+    count = MIN(count, wanted);
+
+    if (count < 2) {
+        return (0);
+    }
+
+    lba = data_block_lba(file_p, blk_of_cluster);
+
+    if (cache_flush_range(self_p, lba, count) != 0) {
+        return (-1);
+    }
+
+    if (self_p->read_blocks(self_p->arg_p,
+                            dst_p,
+                            lba,
+                            count) != (ssize_t)(count * BLOCK_SIZE)) {
+        return (-1);
+    }
+
+    /* The cluster of the last read block. */
+    file_p->cur_cluster += ((blk_of_cluster + count - 1) / blocks_per_cluster);
+
+    return (count * BLOCK_SIZE);
+}
+
+/**
+ * Write whole blocks left in the current cluster at the current block
+ * aligned position directly from given buffer. The cache is bypassed.
+ *
+ * @return Number of written bytes, zero(0) if fewer than two blocks
+ *         can be written at once, or negative error code.
+ */
+static ssize_t file_write_blocks(struct fat16_file_t *file_p,
+                                 const uint8_t *src_p,
+                                 size_t size)
+{
+    struct fat16_t *self_p;
+    uint8_t blk_of_cluster;
+    size_t count;
+    uint32_t lba;
+
+    self_p = file_p->fat16_p;
+
+    if (self_p->write_blocks == NULL) {
+        return (0);
+    }
+
+    if (cache_data_offset(file_p->cur_position) != 0) {
+        return (0);
+    }
+
+    blk_of_cluster = block_of_cluster(self_p->blocks_per_cluster,
+                                      file_p->cur_position);
+    count = MIN((size_t)(self_p->blocks_per_cluster - blk_of_cluster),
+                size / BLOCK_SIZE);
+
+    if (count < 2) {
+        return (0);
+    }
+
+    if (blk_of_cluster == 0) {
+        if (get_cluster(file_p) != 0) {
+            return (-1);
+        }
+    }
+
+    lba = data_block_lba(file_p, blk_of_cluster);
+    cache_discard_range(self_p, lba, count);
+
+    if (self_p->write_blocks(self_p->arg_p,
+                             lba,
+                             src_p,
+                             count) != (ssize_t)(count * BLOCK_SIZE)) {
+        return (-1);
+    }
+
+    return (count * BLOCK_SIZE);
+}
+
 static int file_open(struct fat16_t *self_p,
                      struct fat16_file_t *file_p,
                      const char* path_p,
                      int oflag,
                      uint8_t attributes)
 {
-    int16_t block;
+    uint32_t block;
     int16_t index;
     struct dir_t* dir_p;
 
@@ -1137,9 +2245,13 @@ static int file_open(struct fat16_t *self_p,
     file_p->dir_entry_block = block;
     file_p->dir_entry_index = index;
     file_p->file_size = dir_p->file_size;
-    file_p->first_cluster = dir_p->first_cluster_low;
+    file_p->first_cluster = dir_first_cluster(self_p, dir_p);
     file_p->flags = oflag & (O_RDWR | O_SYNC | O_APPEND);
 
+    if (oflag & O_STREAM) {
+        file_p->flags |= (F_FILE_STREAM | O_APPEND);
+    }
+
     if (oflag & O_TRUNC) {
         return (fat16_file_truncate(file_p, 0));
     }
@@ -1163,6 +2275,11 @@ int fat16_file_close(struct fat16_file_t *file_p)
 {
     ASSERTN(file_p != NULL, EINVAL);
 
+    /* Free cluster hints are written on close, not on every sync. */
+    if (fsinfo_write(file_p->fat16_p) != 0) {
+        return (FAT16_EOF);
+    }
+
     if (fat16_file_sync(file_p) != 0) {
         return (FAT16_EOF);
     }
@@ -1182,6 +2299,8 @@ ssize_t fat16_file_read(struct fat16_file_t *file_p,
     uint16_t block_offset;
     uint8_t *src_p, *dst_p;
     size_t n;
+    ssize_t res;
+    struct fat16_cache_block_t *block_p;
 
     /* Error if not open for read. */
     if (!(file_p->flags & O_READ)) {
@@ -1218,15 +2337,34 @@ ssize_t fat16_file_read(struct fat16_file_t *file_p,
             }
         }
 
+        /* Read whole blocks directly into the caller's buffer. */
+        if (block_offset == 0) {
+            res = file_read_blocks(file_p, dst_p, left, blk_of_cluster);
+
+            if (res < 0) {
+                return (FAT16_EOF);
+            }
+
+            if (res > 0) {
+                file_p->cur_position += res;
+                dst_p += res;
+                left -= res;
+                continue;
+            }
+        }
+
         /* Cache data block. */
-        if (cache_raw_block(file_p->fat16_p,
-                            data_block_lba(file_p, blk_of_cluster),
-                            CACHE_FOR_READ) != 0) {
+        block_p = cache_raw_block(file_p->fat16_p,
+                                  data_block_lba(file_p, blk_of_cluster),
+                                  CACHE_FOR_READ,
+                                  CACHE_PRIO_DATA);
+
+        if (block_p == NULL) {
             return (FAT16_EOF);
         }
 
         /* Location of data in cache. */
-        src_p = file_p->fat16_p->cache.buffer.data + block_offset;
+        src_p = block_p->buffer.data + block_offset;
 
         /* Max number of byte available in block. */
         n = 512 - block_offset;
@@ -1258,6 +2396,8 @@ ssize_t fat16_file_write(struct fat16_file_t *file_p,
     uint16_t block_offset;
     uint8_t* dst_p;
     size_t n;
+    ssize_t res;
+    struct fat16_cache_block_t *block_p;
     const char *csrc_p;
 
     csrc_p = src_p;
@@ -1276,11 +2416,25 @@ ssize_t fat16_file_write(struct fat16_file_t *file_p,
     }
 
     while (left > 0) {
-        if (get_block(file_p, &block_offset) != 0) {
+        /* Write whole blocks directly from the caller's buffer. */
+        res = file_write_blocks(file_p, (const uint8_t *)csrc_p, left);
+
+        if (res < 0) {
+            return (FAT16_EOF);
+        }
+
+        if (res > 0) {
+            file_p->cur_position += res;
+            left -= res;
+            csrc_p += res;
+            continue;
+        }
+
+        if (get_block(file_p, &block_offset, &block_p) != 0) {
             return (FAT16_EOF);
         }
 
-        dst_p = file_p->fat16_p->cache.buffer.data + block_offset;
+        dst_p = block_p->buffer.data + block_offset;
 
         /* Max space in block. */
         n = 512 - block_offset;
@@ -1305,7 +2459,12 @@ ssize_t fat16_file_write(struct fat16_file_t *file_p,
     }
 
     if (file_p->flags & O_SYNC) {
-        if (fat16_file_sync(file_p) != 0) {
+        if (file_p->flags & F_FILE_STREAM) {
+            /* Directory entry is written on explicit sync and close. */
+            if (cache_flush(file_p->fat16_p) != 0) {
+                return (FAT16_EOF);
+            }
+        } else if (fat16_file_sync(file_p) != 0) {
             return (FAT16_EOF);
         }
     }
@@ -1407,12 +2566,10 @@ int fat16_file_truncate(struct fat16_file_t *file_p,
                 return (-1);
             }
         }
-
-        return (0);
     }
 
-    /* Filesize and size are zero - nothing to do. */
-    if (file_p->file_size == 0) {
+    /* No clusters - nothing to do. */
+    if (file_p->first_cluster == 0) {
         return (0);
     }
 
@@ -1438,11 +2595,11 @@ int fat16_file_truncate(struct fat16_file_t *file_p,
 
         if (!is_end_of_cluster(to_free)) {
             /* Free extra clusters. */
-            if (!fat_put(file_p->fat16_p, file_p->cur_cluster, EOC16)) {
+            if (fat_put(file_p->fat16_p, file_p->cur_cluster, EOC) != 0) {
                 return (-1);
             }
 
-            if (!free_chain(file_p->fat16_p, to_free)) {
+            if (free_chain(file_p->fat16_p, to_free) != 0) {
                 return (-1);
             }
         }
@@ -1465,11 +2622,90 @@ ssize_t fat16_file_size(struct fat16_file_t *file_p)
     return (file_p->file_size);
 }
 
+int fat16_file_preallocate(struct fat16_file_t *file_p,
+                           size_t size)
+{
+    ASSERTN(file_p != NULL, EINVAL);
+
+    struct fat16_t *self_p;
+    uint32_t cluster_size;
+    uint32_t count;
+    fat_t last;
+    fat_t next;
+    fat_t first;
+    fat_t i;
+
+    if (!(file_p->flags & O_WRITE)) {
+        return (-1);
+    }
+
+    self_p = file_p->fat16_p;
+    cluster_size = ((uint32_t)self_p->blocks_per_cluster * BLOCK_SIZE);
+    count = ((size + cluster_size - 1) / cluster_size);
+    last = 0;
+
+    /* Find the last cluster of the file. */
+    if (file_p->first_cluster != 0) {
+        next = file_p->first_cluster;
+
+        do {
+            last = next;
+            count = (count > 0 ? count - 1 : 0);
+
+            if (fat_get(self_p, last, &next) != 0) {
+                return (-1);
+            }
+        } while (!is_end_of_cluster(next));
+    }
+
+    if (count == 0) {
+        return (0);
+    }
+
+    if (count > self_p->cluster_count) {
+        return (-1);
+    }
+
+    first = find_free_clusters(self_p,
+                               (last != 0 ? last + 1 : self_p->next_free),
+                               count);
+
+    if (first == 0) {
+        return (-1);
+    }
+
+    /* Link the new clusters into a chain. */
+    for (i = first; i < first + count - 1; i++) {
+        if (fat_put(self_p, i, i + 1) != 0) {
+            return (-1);
+        }
+    }
+
+    if (fat_put(self_p, first + count - 1, EOC) != 0) {
+        return (-1);
+    }
+
+    if (last != 0) {
+        if (fat_put(self_p, last, first) != 0) {
+            return (-1);
+        }
+    } else {
+        file_p->first_cluster = first;
+        file_p->flags |= F_FILE_DIR_DIRTY;
+    }
+
+    return (fat16_file_sync(file_p));
+}
+
 int fat16_file_sync(struct fat16_file_t *file_p)
 {
     ASSERTN(file_p != NULL, EINVAL);
 
     struct dir_t* dir_p;
+#if CONFIG_TIME_FORMAT == 1
+    uint16_t date;
+    uint16_t time;
+#endif
 
     if (file_p->flags & F_FILE_DIR_DIRTY) {
         /* Cache directory entry. */
@@ -1484,13 +2720,16 @@ int fat16_file_sync(struct fat16_file_t *file_p)
 
         /* Update file size and first cluster. */
         dir_p->file_size = file_p->file_size;
-        dir_p->first_cluster_low = file_p->first_cluster;
-
-        /* Set modify time if user supplied a callback date/time function. */
-        /* if (dateTime) { */
-        /*     dateTime(&dir_p->last_write_date, &dir_p->last_write_time); */
-        /*     dir_p->last_access_date = dir_p->last_write_date; */
-        /* } */
+        dir_set_first_cluster(file_p->fat16_p, dir_p, file_p->first_cluster);
+
+#if CONFIG_TIME_FORMAT == 1
+        /* Set the modify time if the current date and time is set. */
+        if (time_format_fat(&date, &time) == 0) {
+            dir_p->last_write_date = date;
+            dir_p->last_write_time = time;
+            dir_p->last_access_date = date;
+        }
+#endif
 
         file_p->flags &= ~F_FILE_DIR_DIRTY;
     }
@@ -1509,6 +2748,7 @@ int fat16_dir_open(struct fat16_t *self_p,
     struct fat16_file_t *file_p = &dir_p->file;
     uint8_t dname[11];
     struct dir_t dir;
+    fat_t cluster;
 
     /* Root directory is special. */
     if ((strcmp(path_p, ".") == 0) && (oflag & O_READ)) {
@@ -1516,6 +2756,28 @@ int fat16_dir_open(struct fat16_t *self_p,
         dir_p->root_index = 0;
         file_p->fat16_p = self_p;
 
+        /* The FAT32 root directory is read as a file of all its
+           clusters. */
+        if (is_fat32(self_p)) {
+            dir_p->root_index = -1;
+            file_p->flags = O_READ;
+            file_p->dir_entry_block = 0;
+            file_p->dir_entry_index = 0;
+            file_p->first_cluster = self_p->root_dir_cluster;
+            file_p->cur_cluster = 0;
+            file_p->cur_position = 0;
+            file_p->file_size = 0;
+            cluster = self_p->root_dir_cluster;
+
+            do {
+                file_p->file_size += (self_p->blocks_per_cluster * BLOCK_SIZE);
+
+                if (fat_get(self_p, cluster, &cluster) != 0) {
+                    return (-1);
+                }
+            } while (!is_end_of_cluster(cluster));
+        }
+
         return (0);
     } else if (file_open(self_p, file_p, path_p, oflag, DIR_ATTR_DIRECTORY) != 0) {
         return (-1);
@@ -105,6 +105,13 @@
  */
 #define O_TRUNC            0x40
 
+/**
+ * Streaming writes. Implies O_APPEND. Synchronous writes (O_SYNC)
+ * only flush data and FAT blocks, while the directory entry is
+ * written in fat16_file_sync() and fat16_file_close().
+ */
+#define O_STREAM           0x80
+
 /**
  * File is read-only.
  */
@@ -149,10 +156,30 @@ typedef ssize_t (*fat16_write_t)(void *arg_p,
                                  uint32_t dst_block,
                                  const void *src_p);
 
+/**
+ * Read function callback of given number of consecutive blocks.
+ */
+typedef ssize_t (*fat16_read_blocks_t)(void *arg_p,
+                                       void *dst_p,
+                                       uint32_t src_block,
+                                       size_t count);
+
+/**
+ * Write function callback of given number of consecutive blocks.
+ */
+typedef ssize_t (*fat16_write_blocks_t)(void *arg_p,
+                                        uint32_t dst_block,
+                                        const void *src_p,
+                                        size_t count);
+
 /**
  * A FAT entry.
  */
+#if CONFIG_FAT16_FAT32 == 1
+typedef uint32_t fat_t;
+#else
 typedef uint16_t fat_t;
+#endif
 
 /**
  * FAT Time Format. A FAT directory entry time stamp is a 16-bit
@@ -394,6 +421,123 @@ struct fbs_t {
     uint16_t boot_sector_sig;
 } PACKED;
 
+/**
+ * Boot sector for a FAT32 volume. The BIOS parameter block is
+ * extended with FAT32 specific fields.
+ */
+struct fbs32_t {
+    /**
+     * X86 jmp to boot program
+     */
+    uint8_t jmp_to_boot_code[3];
+    /**
+     * Informational only - don't depend on it
+     */
+    char oem_name[8];
+    /**
+     * BIOS Parameter Block
+     */
+    struct bpb_t bpb;
+    /**
+     * Count of sectors occupied by one FAT.
+     */
+    uint32_t sectors_per_fat32;
+    /**
+     * Bits 0-3 is the active FAT if bit 7 is set. FATs are mirrored
+     * if bit 7 is cleared.
+     */
+    uint16_t fat32_flags;
+    /**
+     * FAT32 version. Must be zero.
+     */
+    uint16_t fat32_version;
+    /**
+     * First cluster of the root directory.
+     */
+    uint32_t fat32_root_cluster;
+    /**
+     * Sector number of the FSInfo structure, relative to the start
+     * of the volume.
+     */
+    uint16_t fat32_fsinfo;
+    /**
+     * Sector number of the backup boot sector, or zero.
+     */
+    uint16_t fat32_back_boot_block;
+    /**
+     * Reserved - should be zero.
+     */
+    uint8_t fat32_reserved[12];
+    /**
+     * For int0x13 use value 0x80 for hard drive
+     */
+    uint8_t drive_number;
+    /**
+     * Used by Windows NT - should be zero for FAT
+     */
+    uint8_t reserved1;
+    /**
+     * 0x29 if next three fields are valid
+     */
+    uint8_t boot_signature;
+    /**
+     * Usually generated by combining date and time
+     */
+    uint32_t volume_serial_number;
+    /**
+     * Should match volume label in root dir
+     */
+    char volume_label[11];
+    /**
+     * Informational only - don't depend on it
+     */
+    char file_system_type[8];
+    /**
+     * X86 boot code
+     */
+    uint8_t boot_code[420];
+    /**
+     * Must be 0x55AA
+     */
+    uint16_t boot_sector_sig;
+} PACKED;
+
+/**
+ * FAT32 FSInfo sector. Holds hints of the number of free clusters
+ * and where to start looking for a free cluster.
+ */
+struct fsinfo_t {
+    /**
+     * Must be 0x41615252.
+     */
+    uint32_t lead_signature;
+    /**
+     * Reserved - should be zero.
+     */
+    uint8_t reserved1[480];
+    /**
+     * Must be 0x61417272.
+     */
+    uint32_t struct_signature;
+    /**
+     * Last known free cluster count, or 0xffffffff if unknown.
+     */
+    uint32_t free_count;
+    /**
+     * Cluster to start looking for free clusters at, or 0xffffffff if
+     * unknown.
+     */
+    uint32_t next_free;
+    /**
+     * Reserved - should be zero.
+     */
+    uint8_t reserved2[12];
+    /**
+     * Must be 0xaa550000.
+     */
+    uint32_t trail_signature;
+} PACKED;
+
 /**
  * Master Boot Record. The first block of a storage device that is
  * formatted with a MBR.
@@ -490,40 +634,74 @@ struct dir_t {
 union fat16_cache16_t {
     /* Used to access cached file data blocks. */
     uint8_t data[512];
-    /* Used to access cached FAT entries. */
-    fat_t fat[256];
+    /* Used to access cached FAT16 entries. */
+    uint16_t fat16[256];
+    /* Used to access cached FAT32 entries. */
+    uint32_t fat32[128];
     /* Used to access cached directory entries. */
     struct dir_t dir[16];
     /* Used to access a cached Master Boot Record. */
     struct mbr_t mbr;
     /* Used to access to a cached FAT16 boot sector. */
     struct fbs_t fbs;
+    /* Used to access to a cached FAT32 boot sector. */
+    struct fbs32_t fbs32;
+    /* Used to access to a cached FAT32 FSInfo sector. */
+    struct fsinfo_t fsinfo;
 };
 
-struct fat16_cache_t {
+struct fat16_cache_block_t {
     uint32_t block_number;         /* Logical number of block in the cache */
     uint8_t dirty;                 /* cacheFlush() will write block if true */
+    uint8_t priority;              /* lower priority blocks are evicted first */
+    uint16_t used;                 /* cache tick of latest access */
     uint32_t mirror_block;         /* mirror block for second FAT */
     union fat16_cache16_t buffer;  /* 512 byte cache for raw blocks */
 };
 
+struct fat16_cache_t {
+    uint16_t tick;                 /* incremented on every access */
+    struct fat16_cache_block_t blocks[CONFIG_FAT16_CACHE_BLOCKS];
+};
+
+#if CONFIG_FAT16_FREE_BITMAP_SIZE > 0
+struct fat16_free_bitmap_t {
+    uint8_t valid;                 /* bits are loaded from the FAT */
+    fat_t start;                   /* first cluster in the window */
+    uint8_t bits[CONFIG_FAT16_FREE_BITMAP_SIZE]; /* set if allocated */
+};
+#endif
+
 struct fat16_t {
     /* Data block read and wrte functions. */
     fat16_read_t read;
     fat16_write_t write;
+    fat16_read_blocks_t read_blocks;
+    fat16_write_blocks_t write_blocks;
     void *arg_p;
     unsigned int partition;
 
     /* Volume info */
+    uint8_t fat_type;              /* 16 or 32 */
     uint8_t fat_count;             /* number of FATs */
     uint8_t blocks_per_cluster;    /* must be power of 2 */
     uint16_t root_dir_entry_count; /* should be 512 for FAT16 */
-    fat_t blocks_per_fat;          /* number of blocks in one FAT */
+    uint32_t blocks_per_fat;       /* number of blocks in one FAT */
     fat_t cluster_count;           /* total clusters in volume */
     uint32_t volume_start_block;   /* start of volume */
     uint32_t fat_start_block;      /* start of first FAT */
     uint32_t root_dir_start_block; /* start of root dir */
     uint32_t data_start_block;     /* start of data clusters */
+    fat_t root_dir_cluster;        /* first cluster of FAT32 root dir */
+
+    /* Free cluster hints, stored in the FSInfo block on FAT32. */
+    uint32_t fsinfo_block;         /* zero(0) if missing */
+    uint8_t fsinfo_dirty;          /* hints changed since written */
+    fat_t free_count;              /* all ones if unknown */
+    fat_t next_free;               /* start of free cluster search */
+#if CONFIG_FAT16_FREE_BITMAP_SIZE > 0
+    struct fat16_free_bitmap_t free_bitmap;
+#endif
 
     /* block cache */
     struct fat16_cache_t cache;
@@ -532,7 +710,7 @@ struct fat16_t {
 struct fat16_file_t {
     struct fat16_t *fat16_p; /* file system that contains this file */
     uint8_t flags;           /* see above for bit definitions */
-    int16_t dir_entry_block; /* block of directory entry for open file */
+    uint32_t dir_entry_block; /* block of directory entry for open file */
     int16_t dir_entry_index; /* index of directory entry for open file */
     fat_t first_cluster;     /* first cluster of file */
     size_t file_size;        /* fileSize */
@@ -558,6 +736,17 @@ struct fat16_stat_t {
     int is_dir;
 };
 
+/**
+ * Initialize the FAT16 module, registering the block cache counters
+ * in the debug file system. Called by `fat16_init()`.
+ *
+ * The module will only be initialized once even if this function is
+ * called multiple times.
+ *
+ * @return zero(0) or negative error code.
+ */
+int fat16_module_init(void);
+
 /**
  * Initialize a FAT16 volume.
  *
@@ -582,7 +771,26 @@ int fat16_init(struct fat16_t *self_p,
                unsigned int partition);
 
 /**
- * Mount given FAT16 volume.
+ * Set callbacks used to read and write several consecutive blocks at
+ * once. File reads and writes of whole blocks within a cluster, or
+ * for reads, within a run of contiguous clusters, are then done
+ * directly between the device and the caller's buffer, bypassing the
+ * block cache. Typically `sd_read_blocks()` and `sd_write_blocks()`.
+ *
+ * @param[in] self_p Initialized FAT16 object.
+ * @param[in] read_blocks Callback function used to read consecutive
+ *                        blocks, or NULL.
+ * @param[in] write_blocks Callback function used to write
+ *                         consecutive blocks, or NULL.
+ *
+ * @return zero(0) or negative error code.
+ */
+int fat16_set_blocks_callbacks(struct fat16_t *self_p,
+                               fat16_read_blocks_t read_blocks,
+                               fat16_write_blocks_t write_blocks);
+
+/**
+ * Mount given FAT16 or FAT32 volume.
  *
  * @param[in] self_p FAT16 object.
  *
@@ -606,6 +814,18 @@ int fat16_unmount(struct fat16_t *self_p);
  */
 int fat16_format(struct fat16_t *self_p);
 
+/**
+ * Create an empty FAT32 file system of given size on the device. The
+ * volume must have at least 65525 clusters, that is, at least about
+ * 33 MB.
+ *
+ * @param[in] self_p FAT16 object.
+ * @param[in] block_count Size of the volume in 512 bytes blocks.
+ *
+ * @return zero(0) or negative error code.
+ */
+int fat16_format_fat32(struct fat16_t *self_p, uint32_t block_count);
+
 /**
  * Print volume information to given channel.
  *
@@ -704,6 +924,23 @@ ssize_t fat16_file_tell(struct fat16_file_t *file_p);
 int fat16_file_truncate(struct fat16_file_t *file_p,
                         size_t size);
 
+/**
+ * Reserve a contiguous cluster chain large enough to hold `size`
+ * bytes, starting right after the last cluster of the file if
+ * possible. The file size is not changed, so later writes fill the
+ * reserved clusters without searching the FAT for free clusters. The
+ * reserved clusters stay allocated to the file until it is
+ * truncated.
+ *
+ * @param[in] file_p File object opened for writing.
+ * @param[in] size Number of bytes to reserve space for, counted from
+ *                 the beginning of the file.
+ *
+ * @return zero(0) or negative error code.
+ */
+int fat16_file_preallocate(struct fat16_file_t *file_p,
+                           size_t size);
+
 /**
  * Return number of bytes in the file.
  *
@@ -31,9 +31,35 @@
 
 #define FS_NAME_MAX                                          64
 
+/* Counters are updated with lock-free atomic operations when the
+   target has 64 bits atomics. AVR masks interrupts and restores the
+   previous state, which is safe in both thread and interrupt
+   context. Other targets, for example Cortex-M, ESP32 and SPC5, take
+   the system lock, so interrupt handlers must use
+   fs_counter_increment_isr(). */
+#if defined(__GCC_HAVE_SYNC_COMPARE_AND_SWAP_8)
+#    define COUNTER_LOCK_FREE 1
+#else
+#    define COUNTER_LOCK_FREE 0
+#endif
+
+struct commands_iter_t {
+    int static_index;
+    struct fs_command_t *registered_p;
+};
+
 struct module_t {
     int8_t initialized;
-    struct fs_command_t *commands_p;
+    struct dlist_t commands;
+#if CONFIG_FS_COMMANDS_INDEX_MAX > 0
+    /* Commands sorted by path, valid if all registered commands
+       fit. */
+    struct {
+        int number_of_commands;
+        int length;
+        const struct fs_command_t *commands[CONFIG_FS_COMMANDS_INDEX_MAX];
+    } index;
+#endif
     struct fs_filesystem_t *filesystems_p;
     struct fs_counter_t *counters_p;
     struct fs_parameter_t *parameters_p;
@@ -64,6 +90,9 @@ struct module_t {
 #if CONFIG_FS_FS_COMMAND_COUNTERS_RESET == 1
     struct fs_command_t cmd_counters_reset;
 #endif
+#if CONFIG_FS_FS_COMMAND_COUNTERS_EXPORT == 1
+    struct fs_command_t cmd_counters_export;
+#endif
 #if CONFIG_FS_FS_COMMAND_PARAMETERS_LIST == 1
     struct fs_command_t cmd_parameters_list;
 #endif
@@ -72,20 +101,115 @@ struct module_t {
 static struct module_t module;
 static char empty_path[] = "";
 
+#if COUNTER_LOCK_FREE == 0 && defined(ARCH_AVR)
+
+static inline uint8_t counter_lock(void)
+{
+    uint8_t sreg;
+
+    sreg = SREG;
+    asm volatile ("cli" ::: "memory");
+
+    return (sreg);
+}
+
+static inline void counter_unlock(uint8_t sreg)
+{
+    asm volatile ("" ::: "memory");
+    SREG = sreg;
+}
+
+#endif
+
+/**
+ * Add given value to given counter.
+ */
+static RAM_CODE void counter_add(struct fs_counter_t *counter_p,
+                                 uint64_t value,
+                                 int isr)
+{
+#if COUNTER_LOCK_FREE == 1
+    (void)isr;
+    __atomic_add_fetch(&counter_p->value, value, __ATOMIC_RELAXED);
+#elif defined(ARCH_AVR)
+    uint8_t sreg;
+
+    (void)isr;
+    sreg = counter_lock();
+    counter_p->value += value;
+    counter_unlock(sreg);
+#else
+    if (isr) {
+        sys_lock_isr();
+        counter_p->value += value;
+        sys_unlock_isr();
+    } else {
+        sys_lock();
+        counter_p->value += value;
+        sys_unlock();
+    }
+#endif
+}
+
+/**
+ * Read a snapshot of given counter, never a half updated value.
+ */
+static uint64_t counter_load(struct fs_counter_t *counter_p)
+{
+    uint64_t value;
+
+#if COUNTER_LOCK_FREE == 1
+    value = __atomic_load_n(&counter_p->value, __ATOMIC_RELAXED);
+#elif defined(ARCH_AVR)
+    uint8_t sreg;
+
+    sreg = counter_lock();
+    value = counter_p->value;
+    counter_unlock(sreg);
+#else
+    sys_lock();
+    value = counter_p->value;
+    sys_unlock();
+#endif
+
+    return (value);
+}
+
+static void counter_store(struct fs_counter_t *counter_p,
+                          uint64_t value)
+{
+#if COUNTER_LOCK_FREE == 1
+    __atomic_store_n(&counter_p->value, value, __ATOMIC_RELAXED);
+#elif defined(ARCH_AVR)
+    uint8_t sreg;
+
+    sreg = counter_lock();
+    counter_p->value = value;
+    counter_unlock(sreg);
+#else
+    sys_lock();
+    counter_p->value = value;
+    sys_unlock();
+#endif
+}
+
 static int counter_get(struct fs_counter_t *counter_p,
                        void *chout_p)
 {
+    uint64_t value;
+
+    value = counter_load(counter_p);
     std_fprintf(chout_p,
                 OSTR("%08lx%08lx\r\n"),
-                (long)(counter_p->value >> 32),
-                (long)(counter_p->value & 0xffffffff));
+                (long)(value >> 32),
+                (long)(value & 0xffffffff));
 
     return (0);
 }
 
 static int counter_set(struct fs_counter_t *counter_p)
 {
-    counter_p->value = 0;
+    counter_store(counter_p, 0);
 
     return (0);
 }
@@ -423,6 +547,28 @@ static int cmd_counters_reset_cb(int argc,
 
 #endif
 
+#if CONFIG_FS_FS_COMMAND_COUNTERS_EXPORT == 1
+
+static int cmd_counters_export_cb(int argc,
+                                  const char *argv[],
+                                  void *chout_p,
+                                  void *chin_p,
+                                  void *arg_p,
+                                  void *call_arg_p)
+{
+    ssize_t res;
+
+    res = fs_counters_export(chout_p);
+
+    if (res < 0) {
+        return (res);
+    }
+
+    return (0);
+}
+
+#endif
+
 #if CONFIG_FS_FS_COMMAND_PARAMETERS_LIST == 1
 
 static int cmd_parameters_list_cb(int argc,
@@ -540,6 +686,383 @@ static int command_parse(char *command_p, const char *argv[])
     return (argc);
 }
 
+/**
+ * Index of the first of given sorted commands with given path,
+ * without leading slash, or of the first command with a greater path
+ * if not found.
+ */
+static int lower_bound(const struct fs_command_t *const *commands_pp,
+                       int length,
+                       const char *path_p,
+                       int *found_p)
+{
+    int low;
+    int high;
+    int middle;
+    int res;
+
+    low = 0;
+    high = length;
+    *found_p = 0;
+
+    while (low < high) {
+        middle = ((low + high) / 2);
+        res = std_strcmp(path_p, &commands_pp[middle]->path_p[1]);
+
+        if (res > 0) {
+            low = (middle + 1);
+        } else {
+            if (res == 0) {
+                *found_p = 1;
+            }
+
+            high = middle;
+        }
+    }
+
+    return (low);
+}
+
+#if CONFIG_FS_COMMANDS_INDEX_MAX > 0
+
+/**
+ * Index of the first of given sorted commands with a path, without
+ * leading slash, not starting with given prefix and greater than it.
+ */
+static int prefix_upper_bound(const struct fs_command_t *const *commands_pp,
+                              int length,
+                              const char *prefix_p,
+                              size_t size)
+{
+    int low;
+    int high;
+    int middle;
+
+    low = 0;
+    high = length;
+
+    while (low < high) {
+        middle = ((low + high) / 2);
+
+        if (std_strncmp(&commands_pp[middle]->path_p[1],
+                        prefix_p,
+                        size) <= 0) {
+            low = (middle + 1);
+        } else {
+            high = middle;
+        }
+    }
+
+    return (low);
+}
+
+/**
+ * Widen given first and last command to include given range of
+ * sorted commands.
+ */
+static void range_merge(const struct fs_command_t **first_pp,
+                        const struct fs_command_t **last_pp,
+                        const struct fs_command_t *const *commands_pp,
+                        int low,
+                        int high)
+{
+    if (low >= high) {
+        return;
+    }
+
+    if ((*first_pp == NULL)
+        || (std_strcmp_f(commands_pp[low]->path_p,
+                         (*first_pp)->path_p) < 0)) {
+        *first_pp = commands_pp[low];
+    }
+
+    if ((*last_pp == NULL)
+        || (std_strcmp_f(commands_pp[high - 1]->path_p,
+                         (*last_pp)->path_p) > 0)) {
+        *last_pp = commands_pp[high - 1];
+    }
+}
+
+#endif
+
+/**
+ * Iterate over the static and the registered commands, merged in
+ * path order.
+ */
+static void commands_iter_init(struct commands_iter_t *self_p)
+{
+    self_p->static_index = 0;
+    self_p->registered_p = dlist_peek_head(&module.commands);
+}
+
+static const struct fs_command_t *commands_iter_next(
+    struct commands_iter_t *self_p)
+{
+    const struct fs_command_t *static_p;
+    const struct fs_command_t *registered_p;
+
+    static_p = NULL;
+
+    if (self_p->static_index < fs_static_commands_length) {
+        static_p = fs_static_commands[self_p->static_index];
+    }
+
+    registered_p = self_p->registered_p;
+
+    if (static_p == NULL) {
+        if (registered_p != NULL) {
+            self_p->registered_p = dlist_next(self_p->registered_p);
+        }
+
+        return (registered_p);
+    }
+
+    if ((registered_p == NULL)
+        || (std_strcmp_f(static_p->path_p, registered_p->path_p) <= 0)) {
+        self_p->static_index++;
+
+        return (static_p);
+    }
+
+    self_p->registered_p = dlist_next(self_p->registered_p);
+
+    return (registered_p);
+}
+
+#if CONFIG_FS_COMMANDS_INDEX_MAX > 0
+
+/**
+ * Add given command to the index after any commands with the same
+ * path, just as in the command list.
+ */
+static void index_insert(struct fs_command_t *command_p)
+{
+    int low;
+    int high;
+    int middle;
+
+    module.index.number_of_commands++;
+
+    if (module.index.number_of_commands > CONFIG_FS_COMMANDS_INDEX_MAX) {
+        return;
+    }
+
+    low = 0;
+    high = module.index.length;
+
+    while (low < high) {
+        middle = ((low + high) / 2);
+
+        if (std_strcmp_f(command_p->path_p,
+                         module.index.commands[middle]->path_p) < 0) {
+            high = middle;
+        } else {
+            low = (middle + 1);
+        }
+    }
+
+    memmove(&module.index.commands[low + 1],
+            &module.index.commands[low],
+            (module.index.length - low) * sizeof(command_p));
+    module.index.commands[low] = command_p;
+    module.index.length++;
+}
+
+/**
+ * Rebuild the index from the command list.
+ */
+static void index_rebuild(void)
+{
+    struct fs_command_t *command_p;
+
+    module.index.length = 0;
+    command_p = dlist_peek_head(&module.commands);
+
+    while (command_p != NULL) {
+        module.index.commands[module.index.length++] = command_p;
+        command_p = dlist_next(command_p);
+    }
+}
+
+static void index_remove(struct fs_command_t *command_p)
+{
+    int i;
+
+    module.index.number_of_commands--;
+
+    if (module.index.number_of_commands >= CONFIG_FS_COMMANDS_INDEX_MAX) {
+        if (module.index.number_of_commands == CONFIG_FS_COMMANDS_INDEX_MAX) {
+            index_rebuild();
+        }
+
+        return;
+    }
+
+    i = 0;
+
+    while (module.index.commands[i] != command_p) {
+        i++;
+    }
+
+    module.index.length--;
+    memmove(&module.index.commands[i],
+            &module.index.commands[i + 1],
+            (module.index.length - i) * sizeof(command_p));
+}
+
+#endif
+
+#if CONFIG_FS_ASYNC == 1
+
+static void async_init(struct fs_filesystem_t *self_p)
+{
+    self_p->async.thrd_p = NULL;
+    sem_init(&self_p->async.sem, 1, 1);
+    self_p->async.head_p = NULL;
+    self_p->async.tail_p = NULL;
+}
+
+static int async_queue(struct fs_file_t *file_p,
+                       int write,
+                       void *buf_p,
+                       size_t size,
+                       struct fs_request_t *request_p)
+{
+    struct fs_filesystem_t *filesystem_p;
+
+    filesystem_p = file_p->filesystem_p;
+    request_p->file_p = file_p;
+    request_p->write = write;
+    request_p->buf_p = buf_p;
+    request_p->size = size;
+    request_p->next_p = NULL;
+
+    sys_lock();
+
+    if (filesystem_p->async.head_p == NULL) {
+        filesystem_p->async.head_p = request_p;
+    } else {
+        filesystem_p->async.tail_p->next_p = request_p;
+    }
+
+    filesystem_p->async.tail_p = request_p;
+    sem_give_isr(&filesystem_p->async.sem, 1);
+
+    sys_unlock();
+
+    return (0);
+}
+
+/**
+ * Remove the first request from the queue, and all directly
+ * following requests on the same file with buffers directly after
+ * the previous request's buffer.
+ *
+ * @return Merged size of the removed requests, or -1 if the queue is
+ *         empty.
+ */
+static ssize_t async_dequeue(struct fs_filesystem_t *self_p,
+                             struct fs_request_t **head_pp)
+{
+    struct fs_request_t *request_p;
+    struct fs_request_t *next_p;
+    ssize_t size;
+
+    sys_lock();
+
+    request_p = self_p->async.head_p;
+
+    if (request_p == NULL) {
+        sys_unlock();
+
+        return (-1);
+    }
+
+    *head_pp = request_p;
+    size = request_p->size;
+
+    while (1) {
+        next_p = request_p->next_p;
+
+        if ((next_p == NULL)
+            || (next_p->file_p != request_p->file_p)
+            || (next_p->write != request_p->write)
+            || (next_p->buf_p != ((uint8_t *)request_p->buf_p
+                                  + request_p->size))) {
+            break;
+        }
+
+        size += next_p->size;
+        request_p = next_p;
+    }
+
+    self_p->async.head_p = request_p->next_p;
+    request_p->next_p = NULL;
+
+    sys_unlock();
+
+    return (size);
+}
+
+static void async_complete(struct fs_request_t *request_p, ssize_t res)
+{
+    struct fs_request_t *next_p;
+
+    /* Bytes transferred are given to the requests in order. */
+    while (request_p != NULL) {
+        next_p = request_p->next_p;
+
+        if (res < 0) {
+            request_p->res = res;
+        } else {
+            request_p->res = MIN(res, (ssize_t)request_p->size);
+            res -= request_p->res;
+        }
+
+        if (request_p->callback != NULL) {
+            request_p->callback(request_p, request_p->arg_p);
+        } else {
+            event_write(request_p->event_p,
+                        &request_p->mask,
+                        sizeof(request_p->mask));
+        }
+
+        request_p = next_p;
+    }
+}
+
+static void *async_main(void *arg_p)
+{
+    struct fs_filesystem_t *self_p;
+    struct fs_request_t *request_p;
+    ssize_t size;
+    ssize_t res;
+
+    self_p = arg_p;
+    thrd_set_name("fs_async");
+
+    while (1) {
+        size = async_dequeue(self_p, &request_p);
+
+        if (size < 0) {
+            sem_take(&self_p->async.sem, NULL);
+            continue;
+        }
+
+        if (request_p->write == 1) {
+            res = fs_write(request_p->file_p, request_p->buf_p, size);
+        } else {
+            res = fs_read(request_p->file_p, request_p->buf_p, size);
+        }
+
+        async_complete(request_p, res);
+    }
+
+    return (NULL);
+}
+
+#endif
+
 static int cmd_counter_cb(int argc,
                           const char *argv[],
                           void *chout_p,
@@ -562,7 +1085,11 @@ int fs_module_init()
     }
 
     module.initialized = 1;
-    module.commands_p = NULL;
+    dlist_init(&module.commands);
+#if CONFIG_FS_COMMANDS_INDEX_MAX > 0
+    module.index.number_of_commands = 0;
+    module.index.length = 0;
+#endif
     module.filesystems_p = NULL;
     module.counters_p = NULL;
     module.parameters_p = NULL;
@@ -639,6 +1166,14 @@ int fs_module_init()
     fs_command_register(&module.cmd_counters_reset);
 #endif
 
+#if CONFIG_FS_FS_COMMAND_COUNTERS_EXPORT == 1
+    fs_command_init(&module.cmd_counters_export,
+                    CSTR("/filesystems/fs/counters/export"),
+                    cmd_counters_export_cb,
+                    NULL);
+    fs_command_register(&module.cmd_counters_export);
+#endif
+
 #if CONFIG_FS_FS_COMMAND_PARAMETERS_LIST == 1
     fs_command_init(&module.cmd_parameters_list,
                     CSTR("/filesystems/fs/parameters/list"),
@@ -657,8 +1192,9 @@ int fs_call(char *command_p,
 {
     ASSERTN(command_p != NULL, EINVAL);
 
-    int argc, skip_slash;
+    int argc, skip_slash, i, found;
     const char *argv[CONFIG_FS_COMMAND_ARGS_MAX];
+    const struct fs_command_t *found_p;
     struct fs_command_t *current_p;
 
     argc = command_parse(command_p, argv);
@@ -667,26 +1203,58 @@ int fs_call(char *command_p,
         return (argc);
     }
 
-    /* Find given command. */
-    current_p = module.commands_p;
     skip_slash = (argv[0][0] != '/');
+    found_p = NULL;
 
-    while (current_p != NULL) {
-        if (std_strcmp(argv[0], &current_p->path_p[skip_slash]) == 0) {
-            return (current_p->callback(argc,
-                                        argv,
-                                        chout_p,
-                                        chin_p,
-                                        current_p->arg_p,
-                                        arg_p));
-        }
+    /* Binary search in the commands defined at link time. */
+    i = lower_bound(fs_static_commands,
+                    fs_static_commands_length,
+                    &argv[0][1 - skip_slash],
+                    &found);
+
+    if (found == 1) {
+        found_p = fs_static_commands[i];
+    } else {
+#if CONFIG_FS_COMMANDS_INDEX_MAX > 0
+        /* Binary search in the index if all commands fit in it. */
+        if (module.index.number_of_commands <= CONFIG_FS_COMMANDS_INDEX_MAX) {
+            i = lower_bound(module.index.commands,
+                            module.index.length,
+                            &argv[0][1 - skip_slash],
+                            &found);
+
+            if (found == 1) {
+                found_p = module.index.commands[i];
+            }
+        } else
+#endif
+        {
+            /* Find given command. */
+            current_p = dlist_peek_head(&module.commands);
+
+            while (current_p != NULL) {
+                if (std_strcmp(argv[0], &current_p->path_p[skip_slash]) == 0) {
+                    found_p = current_p;
+                    break;
+                }
 
-        current_p = current_p->next_p;
+                current_p = dlist_next(current_p);
+            }
+        }
     }
 
-    std_fprintf(chout_p, OSTR("%s: command not found\r\n"), argv[0]);
+    if (found_p == NULL) {
+        std_fprintf(chout_p, OSTR("%s: command not found\r\n"), argv[0]);
 
-    return (-ENOCOMMAND);
+        return (-ENOCOMMAND);
+    }
+
+    return (found_p->callback(argc,
+                              argv,
+                              chout_p,
+                              chin_p,
+                              found_p->arg_p,
+                              arg_p));
 }
 
 /**
@@ -916,6 +1484,15 @@ int fs_open(struct fs_file_t *self_p, const char *path_p, int flags)
 
     self_p->filesystem_p = filesystem_p;
 
+#if CONFIG_FS_FILE_BUFFER_SIZE > 0
+    self_p->buffer.enabled = ((flags & FS_BUFFERED) != 0);
+    self_p->buffer.dirty = 0;
+    self_p->buffer.pos = 0;
+    self_p->buffer.size = 0;
+#endif
+
+    flags &= ~FS_BUFFERED;
+
     switch (filesystem_p->type) {
 
 #if CONFIG_FAT16 == 1
@@ -954,10 +1531,8 @@ int fs_open(struct fs_file_t *self_p, const char *path_p, int flags)
     }
 }
 
-int fs_close(struct fs_file_t *self_p)
+static int raw_close(struct fs_file_t *self_p)
 {
-    ASSERTN(self_p != NULL, EINVAL);
-
     switch (self_p->filesystem_p->type) {
 
 #if CONFIG_FAT16 == 1
@@ -987,11 +1562,8 @@ int fs_close(struct fs_file_t *self_p)
     }
 }
 
-ssize_t fs_read(struct fs_file_t *self_p, void *dst_p, size_t size)
+static ssize_t raw_read(struct fs_file_t *self_p, void *dst_p, size_t size)
 {
-    ASSERTN(self_p != NULL, EINVAL);
-    ASSERTN((dst_p != NULL) || (size == 0), EINVAL);
-
     switch (self_p->filesystem_p->type) {
 
 #if CONFIG_FAT16 == 1
@@ -1034,41 +1606,10 @@ ssize_t fs_read(struct fs_file_t *self_p, void *dst_p, size_t size)
     }
 }
 
-ssize_t fs_read_line(struct fs_file_t *self_p, void *dst_p, size_t size)
-{
-    ASSERTN(self_p != NULL, EINVAL);
-    ASSERTN(dst_p != NULL, EINVAL);
-
-    ssize_t i;
-    char *d_p;
-
-    d_p = dst_p;
-    i = 0;
-
-    /* Read one byte at a time until a newline is found, the
-       destination buffer is full, or end of file is reached. */
-    while (i < size) {
-        if (fs_read(self_p, &d_p[i], 1) != 1) {
-            d_p[i] = '\0';
-            return (i > 0 ? i : -1);
-        }
-
-        if (d_p[i] == '\n') {
-            d_p[i] = '\0';
-            return (i);
-        }
-
-        i++;
-    }
-
-    return (i == size ? size : -1);
-}
-
-ssize_t fs_write(struct fs_file_t *self_p, const void *src_p, size_t size)
+static ssize_t raw_write(struct fs_file_t *self_p,
+                         const void *src_p,
+                         size_t size)
 {
-    ASSERTN(self_p != NULL, EINVAL);
-    ASSERTN((src_p != NULL) || (size == 0), EINVAL);
-
     switch (self_p->filesystem_p->type) {
 
 #if CONFIG_FAT16 == 1
@@ -1102,10 +1643,72 @@ ssize_t fs_write(struct fs_file_t *self_p, const void *src_p, size_t size)
     }
 }
 
-int fs_seek(struct fs_file_t *self_p, int offset, int whence)
+int fs_request_init(struct fs_request_t *self_p,
+                    fs_request_callback_t callback,
+                    void *arg_p)
 {
     ASSERTN(self_p != NULL, EINVAL);
+    ASSERTN(callback != NULL, EINVAL);
+
+    self_p->callback = callback;
+    self_p->arg_p = arg_p;
+    self_p->event_p = NULL;
+    self_p->mask = 0;
+    self_p->res = 0;
+
+    return (0);
+}
+
+int fs_request_init_event(struct fs_request_t *self_p,
+                          struct event_t *event_p,
+                          uint32_t mask)
+{
+    ASSERTN(self_p != NULL, EINVAL);
+    ASSERTN(event_p != NULL, EINVAL);
+
+    self_p->callback = NULL;
+    self_p->arg_p = NULL;
+    self_p->event_p = event_p;
+    self_p->mask = mask;
+    self_p->res = 0;
+
+    return (0);
+}
+
+int fs_read_async(struct fs_file_t *self_p,
+                  void *dst_p,
+                  size_t size,
+                  struct fs_request_t *request_p)
+{
+    ASSERTN(self_p != NULL, EINVAL);
+    ASSERTN(dst_p != NULL, EINVAL);
+    ASSERTN(request_p != NULL, EINVAL);
 
+#if CONFIG_FS_ASYNC == 1
+    return (async_queue(self_p, 0, dst_p, size, request_p));
+#else
+    return (-ENOSYS);
+#endif
+}
+
+int fs_write_async(struct fs_file_t *self_p,
+                   const void *src_p,
+                   size_t size,
+                   struct fs_request_t *request_p)
+{
+    ASSERTN(self_p != NULL, EINVAL);
+    ASSERTN(src_p != NULL, EINVAL);
+    ASSERTN(request_p != NULL, EINVAL);
+
+#if CONFIG_FS_ASYNC == 1
+    return (async_queue(self_p, 1, (void *)src_p, size, request_p));
+#else
+    return (-ENOSYS);
+#endif
+}
+
+static int raw_seek(struct fs_file_t *self_p, int offset, int whence)
+{
     switch (self_p->filesystem_p->type) {
 
 #if CONFIG_FAT16 == 1
@@ -1143,10 +1746,8 @@ int fs_seek(struct fs_file_t *self_p, int offset, int whence)
     }
 }
 
-ssize_t fs_tell(struct fs_file_t *self_p)
+static ssize_t raw_tell(struct fs_file_t *self_p)
 {
-    ASSERTN(self_p != NULL, EINVAL);
-
     switch (self_p->filesystem_p->type) {
 
 #if CONFIG_FAT16 == 1
@@ -1162,6 +1763,13 @@ ssize_t fs_tell(struct fs_file_t *self_p)
         return (spiffs_tell(self_p->filesystem_p->fs.spiffs_p,
                             self_p->u.spiffs));
 
+#endif
+
+#if CONFIG_FILESYSTEM_GENERIC == 1
+
+    case fs_type_generic_t:
+        return (self_p->filesystem_p->fs.generic.ops_p->file_tell(self_p));
+
 #endif
 
     default:
@@ -1169,6 +1777,277 @@ ssize_t fs_tell(struct fs_file_t *self_p)
     }
 }
 
+#if CONFIG_FS_FILE_BUFFER_SIZE > 0
+
+/**
+ * Write buffered data to the file system.
+ */
+static int buffer_flush(struct fs_file_t *self_p)
+{
+    ssize_t size;
+
+    size = self_p->buffer.size;
+    self_p->buffer.dirty = 0;
+    self_p->buffer.pos = 0;
+    self_p->buffer.size = 0;
+
+    if (size == 0) {
+        return (0);
+    }
+
+    if (raw_write(self_p, &self_p->buffer.buf[0], size) != size) {
+        return (-EIO);
+    }
+
+    return (0);
+}
+
+static ssize_t buffer_read(struct fs_file_t *self_p,
+                           void *dst_p,
+                           size_t size)
+{
+    ssize_t res;
+    size_t left;
+    size_t n;
+    char *d_p;
+    int direct;
+
+    if (self_p->buffer.dirty) {
+        res = buffer_flush(self_p);
+
+        if (res != 0) {
+            return (res);
+        }
+    }
+
+    d_p = dst_p;
+    left = size;
+
+    while (left > 0) {
+        if (self_p->buffer.pos == self_p->buffer.size) {
+            /* Large reads are not buffered. */
+            direct = (left >= CONFIG_FS_FILE_BUFFER_SIZE);
+
+            if (direct) {
+                res = raw_read(self_p, d_p, left);
+            } else {
+                res = raw_read(self_p,
+                               &self_p->buffer.buf[0],
+                               CONFIG_FS_FILE_BUFFER_SIZE);
+            }
+
+            if (res <= 0) {
+                if ((res < 0) && (left == size)) {
+                    return (res);
+                }
+
+                break;
+            }
+
+            if (direct) {
+                d_p += res;
+                left -= res;
+                continue;
+            }
+
+            self_p->buffer.pos = 0;
+            self_p->buffer.size = res;
+        }
+
+        n = MIN(left, self_p->buffer.size - self_p->buffer.pos);
+        memcpy(d_p, &self_p->buffer.buf[self_p->buffer.pos], n);
+        self_p->buffer.pos += n;
+        d_p += n;
+        left -= n;
+    }
+
+    return (size - left);
+}
+
+static ssize_t buffer_write(struct fs_file_t *self_p,
+                            const void *src_p,
+                            size_t size)
+{
+    ssize_t res;
+    size_t unread;
+
+    /* Move the file system position back to the user position before
+       writing after read-ahead. */
+    if (!self_p->buffer.dirty) {
+        unread = (self_p->buffer.size - self_p->buffer.pos);
+        self_p->buffer.pos = 0;
+        self_p->buffer.size = 0;
+
+        if (unread > 0) {
+            res = raw_seek(self_p, -(int)unread, FS_SEEK_CUR);
+
+            if (res != 0) {
+                return (res);
+            }
+        }
+    }
+
+    if (self_p->buffer.size + size > CONFIG_FS_FILE_BUFFER_SIZE) {
+        res = buffer_flush(self_p);
+
+        if (res != 0) {
+            return (res);
+        }
+
+        /* Large writes are not buffered. */
+        if (size >= CONFIG_FS_FILE_BUFFER_SIZE) {
+            return (raw_write(self_p, src_p, size));
+        }
+    }
+
+    memcpy(&self_p->buffer.buf[self_p->buffer.size], src_p, size);
+    self_p->buffer.size += size;
+    self_p->buffer.dirty = 1;
+
+    return (size);
+}
+
+#endif
+
+int fs_close(struct fs_file_t *self_p)
+{
+    ASSERTN(self_p != NULL, EINVAL);
+
+    int res;
+
+    res = fs_flush(self_p);
+
+    if (res != 0) {
+        (void)raw_close(self_p);
+
+        return (res);
+    }
+
+    return (raw_close(self_p));
+}
+
+ssize_t fs_read(struct fs_file_t *self_p, void *dst_p, size_t size)
+{
+    ASSERTN(self_p != NULL, EINVAL);
+    ASSERTN((dst_p != NULL) || (size == 0), EINVAL);
+
+#if CONFIG_FS_FILE_BUFFER_SIZE > 0
+    if (self_p->buffer.enabled) {
+        return (buffer_read(self_p, dst_p, size));
+    }
+#endif
+
+    return (raw_read(self_p, dst_p, size));
+}
+
+ssize_t fs_read_line(struct fs_file_t *self_p, void *dst_p, size_t size)
+{
+    ASSERTN(self_p != NULL, EINVAL);
+    ASSERTN(dst_p != NULL, EINVAL);
+
+    ssize_t i;
+    char *d_p;
+
+    d_p = dst_p;
+    i = 0;
+
+    /* Read one byte at a time until a newline is found, the
+       destination buffer is full, or end of file is reached. */
+    while (i < size) {
+        if (fs_read(self_p, &d_p[i], 1) != 1) {
+            d_p[i] = '\0';
+            return (i > 0 ? i : -1);
+        }
+
+        if (d_p[i] == '\n') {
+            d_p[i] = '\0';
+            return (i);
+        }
+
+        i++;
+    }
+
+    return (i == size ? size : -1);
+}
+
+ssize_t fs_write(struct fs_file_t *self_p, const void *src_p, size_t size)
+{
+    ASSERTN(self_p != NULL, EINVAL);
+    ASSERTN((src_p != NULL) || (size == 0), EINVAL);
+
+#if CONFIG_FS_FILE_BUFFER_SIZE > 0
+    if (self_p->buffer.enabled) {
+        return (buffer_write(self_p, src_p, size));
+    }
+#endif
+
+    return (raw_write(self_p, src_p, size));
+}
+
+int fs_flush(struct fs_file_t *self_p)
+{
+    ASSERTN(self_p != NULL, EINVAL);
+
+#if CONFIG_FS_FILE_BUFFER_SIZE > 0
+    if (self_p->buffer.enabled && self_p->buffer.dirty) {
+        return (buffer_flush(self_p));
+    }
+#endif
+
+    return (0);
+}
+
+int fs_seek(struct fs_file_t *self_p, int offset, int whence)
+{
+    ASSERTN(self_p != NULL, EINVAL);
+
+#if CONFIG_FS_FILE_BUFFER_SIZE > 0
+    int res;
+
+    if (self_p->buffer.enabled) {
+        if (self_p->buffer.dirty) {
+            res = buffer_flush(self_p);
+
+            if (res != 0) {
+                return (res);
+            }
+        } else {
+            /* The file system position is after the read-ahead
+               data. */
+            if (whence == FS_SEEK_CUR) {
+                offset -= (self_p->buffer.size - self_p->buffer.pos);
+            }
+
+            self_p->buffer.pos = 0;
+            self_p->buffer.size = 0;
+        }
+    }
+#endif
+
+    return (raw_seek(self_p, offset, whence));
+}
+
+ssize_t fs_tell(struct fs_file_t *self_p)
+{
+    ASSERTN(self_p != NULL, EINVAL);
+
+    ssize_t res;
+
+    res = raw_tell(self_p);
+
+#if CONFIG_FS_FILE_BUFFER_SIZE > 0
+    if (self_p->buffer.enabled && (res >= 0)) {
+        if (self_p->buffer.dirty) {
+            res += self_p->buffer.size;
+        } else {
+            res -= (self_p->buffer.size - self_p->buffer.pos);
+        }
+    }
+#endif
+
+    return (res);
+}
+
 int fs_mkdir(const char *path_p)
 {
     ASSERTN(path_p != NULL, EINVAL);
@@ -1205,6 +2084,18 @@ int fs_mkdir(const char *path_p)
         }
 #endif
 
+#if CONFIG_FILESYSTEM_GENERIC == 1
+
+    case fs_type_generic_t:
+        if (filesystem_p->fs.generic.ops_p->mkdir == NULL) {
+            return (-1);
+        }
+
+        return (filesystem_p->fs.generic.ops_p->mkdir(filesystem_p,
+                                                      path_p));
+
+#endif
+
     default:
         return (-1);
     }
@@ -1367,6 +2258,18 @@ int fs_remove(const char *path_p)
     case fs_type_spiffs_t:
         return (spiffs_remove(filesystem_p->fs.spiffs_p, path_p));
 
+#endif
+
+#if CONFIG_FILESYSTEM_GENERIC == 1
+
+    case fs_type_generic_t:
+        if (filesystem_p->fs.generic.ops_p->remove == NULL) {
+            return (-1);
+        }
+
+        return (filesystem_p->fs.generic.ops_p->remove(filesystem_p,
+                                                       path_p));
+
 #endif
 
     default:
@@ -1427,6 +2330,57 @@ int fs_stat(const char *path_p, struct fs_stat_t *stat_p)
         }
 #endif
 
+#if CONFIG_FILESYSTEM_GENERIC == 1
+
+    case fs_type_generic_t:
+        if (filesystem_p->fs.generic.ops_p->stat == NULL) {
+            return (-1);
+        }
+
+        return (filesystem_p->fs.generic.ops_p->stat(filesystem_p,
+                                                     path_p,
+                                                     stat_p));
+
+#endif
+
+    default:
+        return (-1);
+    }
+}
+
+int fs_mmap(const char *path_p, const void **buf_pp, size_t *size_p)
+{
+    ASSERTN(path_p != NULL, EINVAL);
+    ASSERTN(buf_pp != NULL, EINVAL);
+    ASSERTN(size_p != NULL, EINVAL);
+
+    struct fs_filesystem_t *filesystem_p;
+    char path[CONFIG_FS_PATH_MAX];
+
+    if (create_absolute_path(path, path_p) != 0) {
+        return (-1);
+    }
+
+    if (get_filesystem_path_from_path(&filesystem_p, &path_p, &path[0]) != 0) {
+        return (-1);
+    }
+
+    switch (filesystem_p->type) {
+
+#if CONFIG_FILESYSTEM_GENERIC == 1
+
+    case fs_type_generic_t:
+        if (filesystem_p->fs.generic.ops_p->mmap == NULL) {
+            return (-1);
+        }
+
+        return (filesystem_p->fs.generic.ops_p->mmap(filesystem_p,
+                                                     path_p,
+                                                     buf_pp,
+                                                     size_p));
+
+#endif
+
     default:
         return (-1);
     }
@@ -1537,7 +2491,8 @@ int fs_list(const char *path_p,
     ASSERTN(chout_p != NULL, EINVAL);
 
     int buf_length, path_offset, filter_offset, path_length;
-    struct fs_command_t *command_p;
+    struct commands_iter_t iter;
+    const struct fs_command_t *command_p;
     char buf[64], next_char;
 
     filter_offset = path_length = strlen(path_p);
@@ -1560,7 +2515,8 @@ int fs_list(const char *path_p,
 
     /* Find all paths matching given path and filter and output the
        file or folder matching the filter. */
-    command_p = module.commands_p;
+    commands_iter_init(&iter);
+    command_p = commands_iter_next(&iter);
 
     while (command_p != NULL) {
         /* Path match? */
@@ -1594,7 +2550,7 @@ int fs_list(const char *path_p,
             }
         }
 
-        command_p = command_p->next_p;
+        command_p = commands_iter_next(&iter);
     }
 
     return (0);
@@ -1605,8 +2561,12 @@ int fs_auto_complete(char *path_p)
     ASSERTN(path_p != NULL, EINVAL);
 
     char next_char;
-    int mismatch, path_length, offset, size;
-    struct fs_command_t *command_p, *next_p;
+    int path_length, offset, size;
+    const struct fs_command_t *first_p, *last_p, *command_p;
+    struct commands_iter_t iter;
+#if CONFIG_FS_COMMANDS_INDEX_MAX > 0
+    int low, high, found;
+#endif
 
     offset = 0;
     size = path_length = strlen(path_p);
@@ -1617,66 +2577,83 @@ int fs_auto_complete(char *path_p)
         offset = 1;
     }
 
-    /* Find the first command matching given path. */
-    command_p = module.commands_p;
+    /* The commands are sorted, so the commands matching given path
+       are adjacent. Find the first and the last of them. */
+    first_p = NULL;
+    last_p = NULL;
+
+#if CONFIG_FS_COMMANDS_INDEX_MAX > 0
+    if (module.index.number_of_commands <= CONFIG_FS_COMMANDS_INDEX_MAX) {
+        low = lower_bound(module.index.commands,
+                          module.index.length,
+                          &path_p[1 - offset],
+                          &found);
+        high = prefix_upper_bound(module.index.commands,
+                                  module.index.length,
+                                  &path_p[1 - offset],
+                                  size - (1 - offset));
+        range_merge(&first_p, &last_p, module.index.commands, low, high);
+        low = lower_bound(fs_static_commands,
+                          fs_static_commands_length,
+                          &path_p[1 - offset],
+                          &found);
+        high = prefix_upper_bound(fs_static_commands,
+                                  fs_static_commands_length,
+                                  &path_p[1 - offset],
+                                  size - (1 - offset));
+        range_merge(&first_p, &last_p, fs_static_commands, low, high);
+    } else
+#endif
+    {
+        commands_iter_init(&iter);
+        command_p = commands_iter_next(&iter);
+
+        while (command_p != NULL) {
+            if (std_strncmp(&command_p->path_p[offset],
+                            path_p,
+                            size) == 0) {
+                if (first_p == NULL) {
+                    first_p = command_p;
+                }
 
-    while (command_p != NULL) {
-        if (std_strncmp(&command_p->path_p[offset],
-                        path_p,
-                        size) == 0) {
-            break;
-        }
+                last_p = command_p;
+            } else if (first_p != NULL) {
+                break;
+            }
 
-        command_p = command_p->next_p;
+            command_p = commands_iter_next(&iter);
+        }
     }
 
     /* No command matching the path. */
-    if (command_p == NULL) {
+    if (first_p == NULL) {
         return (-ENOENT);
     }
 
-    /* Auto-complete given path. Compare the next character each
-       iteration.
+    /* Auto-complete given path. All commands matching the path have
+       the same next character if the first and the last have it.
 
        Example:
        path_p = "/tm"
-       commands = ["/tmp/foo", "/tmp/bar", "/zoo/lander"]
+       commands = ["/tmp/bar", "/tmp/foo", "/zoo/lander"]
        auto-completed = "/tmp/" */
     while (1) {
-        mismatch = 0;
-        next_char = command_p->path_p[offset + size];
+        next_char = first_p->path_p[offset + size];
 
-        /* It's a match if all commands matching path has the same
-           next character. */
-        next_p = command_p;
-
-        while ((next_p != NULL)
-               && (std_strncmp(&next_p->path_p[offset],
-                               path_p,
-                               size) == 0)) {
-            if (next_p->path_p[offset + size] != next_char) {
-                mismatch = 1;
-                break;
-            }
-
-            next_p = next_p->next_p;
+        if (last_p->path_p[offset + size] != next_char) {
+            break;
         }
 
-        /* Completion happend? */
-        if (mismatch == 0) {
-            path_p[size] = next_char;
-            size++;
+        path_p[size] = next_char;
+        size++;
 
-            /* Auto-complete one directory at a time. */
-            if (next_char == '/') {
-                break;
-            } else if (next_char == '\0') {
-                /* Append a space on commands. */
-                path_p[size - 1] = ' ';
-                path_p[size] = '\0';
-                break;
-            }
-        } else {
+        /* Auto-complete one directory at a time. */
+        if (next_char == '/') {
+            break;
+        } else if (next_char == '\0') {
+            /* Append a space on commands. */
+            path_p[size - 1] = ' ';
+            path_p[size] = '\0';
             break;
         }
     }
@@ -1755,6 +2732,9 @@ int fs_filesystem_init_generic(struct fs_filesystem_t *self_p,
     self_p->name_p = name_p;
     self_p->type = fs_type_generic_t;
     self_p->fs.generic.ops_p = ops_p;
+#if CONFIG_FS_ASYNC == 1
+    async_init(self_p);
+#endif
 
     return (0);
 }
@@ -1772,6 +2752,9 @@ int fs_filesystem_init_fat16(struct fs_filesystem_t *self_p,
     self_p->name_p = name_p;
     self_p->type = fs_type_fat16_t;
     self_p->fs.fat16_p = fat16_p;
+#if CONFIG_FS_ASYNC == 1
+    async_init(self_p);
+#endif
 
     return (0);
 }
@@ -1800,6 +2783,9 @@ int fs_filesystem_init_spiffs(struct fs_filesystem_t *self_p,
     self_p->type = fs_type_spiffs_t;
     self_p->fs.spiffs_p = spiffs_p;
     self_p->config.spiffs_p = config_p;
+#if CONFIG_FS_ASYNC == 1
+    async_init(self_p);
+#endif
 
     return (0);
 }
@@ -1823,6 +2809,30 @@ int fs_filesystem_deregister(struct fs_filesystem_t *self_p)
     return (-1);
 }
 
+int fs_filesystem_async_start(struct fs_filesystem_t *self_p,
+                              void *stack_p,
+                              size_t stack_size)
+{
+    ASSERTN(self_p != NULL, EINVAL);
+    ASSERTN(stack_p != NULL, EINVAL);
+
+#if CONFIG_FS_ASYNC == 1
+    if (self_p->async.thrd_p != NULL) {
+        return (-EBUSY);
+    }
+
+    self_p->async.thrd_p = thrd_spawn(async_main,
+                                      self_p,
+                                      CONFIG_FS_ASYNC_THREAD_PRIO,
+                                      stack_p,
+                                      stack_size);
+
+    return (self_p->async.thrd_p != NULL ? 0 : -1);
+#else
+    return (-ENOSYS);
+#endif
+}
+
 int fs_command_init(struct fs_command_t *self_p,
                     far_string_t path_p,
                     fs_callback_t callback,
@@ -1832,7 +2842,8 @@ int fs_command_init(struct fs_command_t *self_p,
     ASSERTN(path_p != NULL, EINVAL);
     ASSERTN(callback != NULL, EINVAL);
 
-    self_p->next_p = NULL;
+    self_p->list_elem.next_p = NULL;
+    self_p->list_elem.prev_p = NULL;
     self_p->path_p = path_p;
     self_p->callback = callback;
     self_p->arg_p = arg_p;
@@ -1844,38 +2855,44 @@ int fs_command_register(struct fs_command_t *command_p)
 {
     ASSERTN(command_p != NULL, EINVAL);
 
-    struct fs_command_t *current_p, *prev_p;
+    int res;
+    struct fs_command_t *current_p;
 
     /* Insert in alphabetical order. */
-    prev_p = NULL;
-    current_p = module.commands_p;
+    current_p = dlist_peek_head(&module.commands);
 
     while (current_p != NULL) {
         if (std_strcmp_f(command_p->path_p, current_p->path_p) < 0) {
             break;
         }
 
-        prev_p = current_p;
-        current_p = current_p->next_p;
+        current_p = dlist_next(current_p);
     }
 
-    /* Insert into the list. */
-    command_p->next_p = current_p;
+    res = dlist_insert_before(&module.commands, current_p, command_p);
 
-    if (prev_p == NULL) {
-        module.commands_p = command_p;
-    } else {
-        prev_p->next_p = command_p;
+#if CONFIG_FS_COMMANDS_INDEX_MAX > 0
+    if (res == 0) {
+        index_insert(command_p);
     }
+#endif
 
-    return (0);
+    return (res);
 }
 
 int fs_command_deregister(struct fs_command_t *command_p)
 {
-    ASSERTN(0, ENOSYS);
+    ASSERTN(command_p != NULL, EINVAL);
 
-    return (-1);
+    if (dlist_remove(&module.commands, command_p) == NULL) {
+        return (-ENOENT);
+    }
+
+#if CONFIG_FS_COMMANDS_INDEX_MAX > 0
+    index_remove(command_p);
+#endif
+
+    return (0);
 }
 
 int fs_counter_init(struct fs_counter_t *self_p,
@@ -1901,7 +2918,38 @@ RAM_CODE int fs_counter_increment(struct fs_counter_t *self_p,
 {
     ASSERTN(self_p != NULL, EINVAL);
 
-    self_p->value += value;
+    counter_add(self_p, value, 0);
+
+    return (0);
+}
+
+RAM_CODE int fs_counter_increment_isr(struct fs_counter_t *self_p,
+                                      uint64_t value)
+{
+    ASSERTN(self_p != NULL, EINVAL);
+
+    counter_add(self_p, value, 1);
+
+    return (0);
+}
+
+int fs_counter_get(struct fs_counter_t *self_p,
+                   uint64_t *value_p)
+{
+    ASSERTN(self_p != NULL, EINVAL);
+    ASSERTN(value_p != NULL, EINVAL);
+
+    *value_p = counter_load(self_p);
+
+    return (0);
+}
+
+int fs_counter_set(struct fs_counter_t *self_p,
+                   uint64_t value)
+{
+    ASSERTN(self_p != NULL, EINVAL);
+
+    counter_store(self_p, value);
 
     return (0);
 }
@@ -1921,9 +2969,106 @@ int fs_counter_register(struct fs_counter_t *counter_p)
 
 int fs_counter_deregister(struct fs_counter_t *counter_p)
 {
-    ASSERTN(0, ENOSYS);
+    ASSERTN(counter_p != NULL, EINVAL);
 
-    return (0);
+    struct fs_counter_t **current_pp;
+
+    /* Remove the counter from the counter list. */
+    current_pp = &module.counters_p;
+
+    while (*current_pp != counter_p) {
+        if (*current_pp == NULL) {
+            return (-ENOENT);
+        }
+
+        current_pp = &(*current_pp)->next_p;
+    }
+
+    *current_pp = counter_p->next_p;
+
+    return (fs_command_deregister(&counter_p->command));
+}
+
+ssize_t fs_counters_export(void *chout_p)
+{
+    ASSERTN(chout_p != NULL, EINVAL);
+
+    struct fs_counter_t *counter_p;
+    char path[FS_NAME_MAX];
+    uint8_t buf[8];
+    uint64_t value;
+    size_t length;
+    ssize_t number_of_counters;
+    int i;
+
+    number_of_counters = 0;
+    counter_p = module.counters_p;
+
+    while (counter_p != NULL) {
+        std_strcpy(path, counter_p->command.path_p);
+        length = strlen(path);
+        value = counter_load(counter_p);
+
+        buf[0] = length;
+
+        if (chan_write(chout_p, &buf[0], 1) != 1) {
+            return (-EIO);
+        }
+
+        if (chan_write(chout_p, &path[0], length) != length) {
+            return (-EIO);
+        }
+
+        for (i = 7; i >= 0; i--) {
+            buf[i] = value;
+            value >>= 8;
+        }
+
+        if (chan_write(chout_p, &buf[0], sizeof(buf)) != sizeof(buf)) {
+            return (-EIO);
+        }
+
+        number_of_counters++;
+        counter_p = counter_p->next_p;
+    }
+
+    /* End of export. */
+    buf[0] = 0;
+
+    if (chan_write(chout_p, &buf[0], 1) != 1) {
+        return (-EIO);
+    }
+
+    return (number_of_counters);
+}
+
+ssize_t fs_counters_print_openmetrics(void *chout_p)
+{
+    ASSERTN(chout_p != NULL, EINVAL);
+
+#if CONFIG_STD_PRINTF_LONG_LONG == 1
+    struct fs_counter_t *counter_p;
+    char path[FS_NAME_MAX];
+    ssize_t number_of_counters;
+
+    std_fprintf(chout_p, OSTR("# TYPE fs_counter counter\n"));
+    number_of_counters = 0;
+    counter_p = module.counters_p;
+
+    while (counter_p != NULL) {
+        std_strcpy(path, counter_p->command.path_p);
+        std_fprintf(chout_p,
+                    OSTR("fs_counter_total{path=\"%s\"} %llu\n"),
+                    &path[0],
+                    (unsigned long long)counter_load(counter_p));
+        number_of_counters++;
+        counter_p = counter_p->next_p;
+    }
+
+    return (number_of_counters);
+#else
+    return (-ENOSYS);
+#endif
 }
 
 int fs_parameter_init(struct fs_parameter_t *self_p,
@@ -1966,9 +3111,24 @@ int fs_parameter_register(struct fs_parameter_t *parameter_p)
 
 int fs_parameter_deregister(struct fs_parameter_t *parameter_p)
 {
-    ASSERTN(0, ENOSYS);
+    ASSERTN(parameter_p != NULL, EINVAL);
 
-    return (0);
+    struct fs_parameter_t **current_pp;
+
+    /* Remove the parameter from the parameter list. */
+    current_pp = &module.parameters_p;
+
+    while (*current_pp != parameter_p) {
+        if (*current_pp == NULL) {
+            return (-ENOENT);
+        }
+
+        current_pp = &(*current_pp)->next_p;
+    }
+
+    *current_pp = parameter_p->next_p;
+
+    return (fs_command_deregister(&parameter_p->command));
 }
 
 int fs_parameter_int_set(void *value_p, const char *src_p)
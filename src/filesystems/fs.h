@@ -88,6 +88,13 @@
  */
 #define FS_TRUNC            0x40
 
+/**
+ * Buffer small reads and writes in the file object, see
+ * ``CONFIG_FS_FILE_BUFFER_SIZE``. Buffered data is written when the
+ * buffer is full, and by `fs_seek()` and `fs_close()`.
+ */
+#define FS_BUFFERED         0x80
+
 #define FS_TYPE_FILE                1
 #define FS_TYPE_DIR                 2
 #define FS_TYPE_HARD_LINK           3
@@ -192,6 +199,14 @@ struct fs_filesystem_t {
         struct fs_filesystem_spiffs_config_t *spiffs_p;
 #endif
     } config;
+#if CONFIG_FS_ASYNC == 1
+    struct {
+        struct thrd_t *thrd_p;
+        struct sem_t sem;
+        struct fs_request_t *head_p;
+        struct fs_request_t *tail_p;
+    } async;
+#endif
     struct fs_filesystem_t *next_p;
 };
 
@@ -204,8 +219,51 @@ struct fs_file_t {
 #endif
 #if CONFIG_SPIFFS == 1
         spiffs_file_t spiffs;
+#endif
+#if CONFIG_FILESYSTEM_GENERIC == 1
+        void *generic_p;
 #endif
     } u;
+#if CONFIG_FS_FILE_BUFFER_SIZE > 0
+    /* Either read-ahead data not yet read by the user, from pos to
+       size, or data not yet written to the file system, from zero to
+       size. */
+    struct {
+        int enabled;
+        int dirty;
+        size_t pos;
+        size_t size;
+        char buf[CONFIG_FS_FILE_BUFFER_SIZE];
+    } buffer;
+#endif
+};
+
+struct fs_request_t;
+
+/**
+ * Asynchronous request completion callback prototype, called by the
+ * file system I/O thread.
+ *
+ * @param[in] request_p Completed request. Its ``res`` member is the
+ *                      number of bytes read or written, or negative
+ *                      error code.
+ * @param[in] arg_p Argument passed to `fs_request_init()`.
+ */
+typedef void (*fs_request_callback_t)(struct fs_request_t *request_p,
+                                      void *arg_p);
+
+/** An asynchronous read or write request. */
+struct fs_request_t {
+    struct fs_file_t *file_p;
+    int write;
+    void *buf_p;
+    size_t size;
+    ssize_t res;
+    fs_request_callback_t callback;
+    void *arg_p;
+    struct event_t *event_p;
+    uint32_t mask;
+    struct fs_request_t *next_p;
 };
 
 /** Path stats. */
@@ -216,12 +274,72 @@ struct fs_stat_t {
 
 /* Command. */
 struct fs_command_t {
+    struct dlist_elem_t list_elem;
     far_string_t path_p;
     fs_callback_t callback;
     void *arg_p;
-    struct fs_command_t *next_p;
 };
 
+/**
+ * Define a command at file scope, instead of calling
+ * `fs_command_init()` and `fs_command_register()` at startup. The
+ * command is a constant, and ``simbagen.py`` creates a table of all
+ * defined commands sorted by path when the application is linked. It
+ * is called by `fs_call()` just as registered commands, but cannot
+ * be deregistered.
+ *
+ * If ``CONFIG_FS_COMMANDS_STATIC`` is zero(0) the command is a
+ * variable instead, registered at startup by
+ * `FS_COMMAND_REGISTER()`.
+ *
+ * @param[in] name Name of the command, unique in the application.
+ * @param[in] path Path of the command as a string literal.
+ * @param[in] callback Command callback function.
+ * @param[in] arg_p Callback argument.
+ */
+#if CONFIG_FS_COMMANDS_STATIC == 1
+#    define FS_COMMAND_DEFINE(name, path, callback, arg_p)              \
+    static const FAR char fs_command_ ## name ## _path[] = path;        \
+    extern const struct fs_command_t fs_command_ ## name;               \
+    const struct fs_command_t fs_command_ ## name = {                   \
+        { NULL, NULL },                                                 \
+        fs_command_ ## name ## _path,                                   \
+        callback,                                                       \
+        arg_p                                                           \
+    };                                                                  \
+    __asm__(".pushsection .simba.fs_commands,\"\"\n"                   \
+            ".asciz \"fs_command_" #name " " path "\"\n"                \
+            ".popsection")
+#else
+#    define FS_COMMAND_DEFINE(name, path, callback, arg_p)              \
+    static const FAR char fs_command_ ## name ## _path[] = path;        \
+    struct fs_command_t fs_command_ ## name = {                         \
+        { NULL, NULL },                                                 \
+        fs_command_ ## name ## _path,                                   \
+        callback,                                                       \
+        arg_p                                                           \
+    }
+#endif
+
+/**
+ * Register given command defined by `FS_COMMAND_DEFINE()`. Call it
+ * from the module init function. Does nothing if
+ * ``CONFIG_FS_COMMANDS_STATIC`` is one(1), as the command is then in
+ * the table generated when the application is linked.
+ *
+ * @param[in] name Name of the command.
+ */
+#if CONFIG_FS_COMMANDS_STATIC == 1
+#    define FS_COMMAND_REGISTER(name)
+#else
+#    define FS_COMMAND_REGISTER(name)                                   \
+    fs_command_register(&fs_command_ ## name)
+#endif
+
+/* All commands defined by FS_COMMAND_DEFINE(), sorted by path. */
+extern const struct fs_command_t *const fs_static_commands[];
+extern const int fs_static_commands_length;
+
 /* Counter. */
 struct fs_counter_t {
     struct fs_command_t command;
@@ -267,6 +385,16 @@ struct fs_filesystem_operations_t {
     ssize_t (*file_write)(struct fs_file_t *self_p, const void *src_p, size_t size);
     int (*file_seek)(struct fs_file_t *self_p, int offset, int whence);
     ssize_t (*file_tell)(struct fs_file_t *self_p);
+    /* Optional path operations. Set to NULL if not supported. */
+    int (*mkdir)(struct fs_filesystem_t *filesystem_p, const char *path_p);
+    int (*remove)(struct fs_filesystem_t *filesystem_p, const char *path_p);
+    int (*stat)(struct fs_filesystem_t *filesystem_p,
+                const char *path_p,
+                struct fs_stat_t *stat_p);
+    int (*mmap)(struct fs_filesystem_t *filesystem_p,
+                const char *path_p,
+                const void **buf_pp,
+                size_t *size_p);
 };
 
 /**
@@ -317,7 +445,8 @@ int fs_call(char *command_p,
  * @param[in] flags Mode of file open. A combination of ``FS_READ``,
  *                  ``FS_RDONLY``, ``FS_WRITE``, ``FS_WRONLY``,
  *                  ``FS_RDWR``, ``FS_APPEND``, ``FS_SYNC``,
- *                  ``FS_CREAT``, ``FS_EXCL`` and ``FS_TRUNC``.
+ *                  ``FS_CREAT``, ``FS_EXCL``, ``FS_TRUNC`` and
+ *                  ``FS_BUFFERED``.
  *
  * @return zero(0) or negative error code.
  */
@@ -346,9 +475,10 @@ ssize_t fs_read(struct fs_file_t *self_p, void *dst_p, size_t size);
 
 /**
  * Read one line from given file into given buffer. The function reads
- * one character at a time from given file until the destination
- * buffer is full, a newline ``\n`` is found or end of file is
- * reached.
+ * from given file until the destination buffer is full, a newline
+ * ``\n`` is found or end of file is reached. Open the file with
+ * ``FS_BUFFERED`` to read the file in blocks instead of one character
+ * at a time.
  *
  * @param[in] self_p Initialized file object.
  * @param[out] dst_p Buffer to read data into. Should fit the whole
@@ -374,6 +504,82 @@ ssize_t fs_read_line(struct fs_file_t *self_p, void *dst_p, size_t size);
  */
 ssize_t fs_write(struct fs_file_t *self_p, const void *src_p, size_t size);
 
+/**
+ * Write data buffered in given file object to the file system. Only
+ * files opened with ``FS_BUFFERED`` buffer written data.
+ *
+ * @param[in] self_p Initialized file object.
+ *
+ * @return zero(0) or negative error code.
+ */
+int fs_flush(struct fs_file_t *self_p);
+
+/**
+ * Initialize given asynchronous request, completed by calling given
+ * callback.
+ *
+ * @param[out] self_p Request to initialize.
+ * @param[in] callback Completion callback.
+ * @param[in] arg_p Completion callback argument.
+ *
+ * @return zero(0) or negative error code.
+ */
+int fs_request_init(struct fs_request_t *self_p,
+                    fs_request_callback_t callback,
+                    void *arg_p);
+
+/**
+ * Initialize given asynchronous request, completed by writing given
+ * mask to given event.
+ *
+ * @param[out] self_p Request to initialize.
+ * @param[in] event_p Event to write to.
+ * @param[in] mask Mask to write to the event.
+ *
+ * @return zero(0) or negative error code.
+ */
+int fs_request_init_event(struct fs_request_t *self_p,
+                          struct event_t *event_p,
+                          uint32_t mask);
+
+/**
+ * Queue a read from given file into given buffer. The read is
+ * performed by the I/O thread of the file system, started by
+ * `fs_filesystem_async_start()`, and the request is completed when
+ * done. Reads of the same file into consecutive buffers queued after
+ * each other are merged into one read.
+ *
+ * The file must not be used by any other function until the request
+ * is completed.
+ *
+ * @param[in] self_p Initialized file object.
+ * @param[out] dst_p Buffer to read data into.
+ * @param[in] size Number of bytes to read.
+ * @param[in] request_p Initialized request, not in use.
+ *
+ * @return zero(0) or negative error code.
+ */
+int fs_read_async(struct fs_file_t *self_p,
+                  void *dst_p,
+                  size_t size,
+                  struct fs_request_t *request_p);
+
+/**
+ * Queue a write from given buffer into given file. Works as
+ * `fs_read_async()`, but writes.
+ *
+ * @param[in] self_p Initialized file object.
+ * @param[in] src_p Buffer to write.
+ * @param[in] size Number of bytes to write.
+ * @param[in] request_p Initialized request, not in use.
+ *
+ * @return zero(0) or negative error code.
+ */
+int fs_write_async(struct fs_file_t *self_p,
+                   const void *src_p,
+                   size_t size,
+                   struct fs_request_t *request_p);
+
 /**
  * Sets the file's read/write position relative to whence.
  *
@@ -448,6 +654,20 @@ int fs_remove(const char *path_p);
  */
 int fs_stat(const char *path_p, struct fs_stat_t *stat_p);
 
+/**
+ * Get the address and size of given file's contents, for files
+ * stored contiguously in memory mapped read-only memory, for example
+ * in a romfs file system. The contents are accessed directly, without
+ * copying them to RAM.
+ *
+ * @param[in] path_p The path of the file.
+ * @param[out] buf_pp File contents.
+ * @param[out] size_p File size.
+ *
+ * @return zero(0) or negative error code.
+ */
+int fs_mmap(const char *path_p, const void **buf_pp, size_t *size_p);
+
 /**
  * Craete a directory with given path.
  *
@@ -598,6 +818,23 @@ int fs_filesystem_register(struct fs_filesystem_t *self_p);
  */
 int fs_filesystem_deregister(struct fs_filesystem_t *self_p);
 
+/**
+ * Start the I/O thread of given file system, performing requests
+ * queued by `fs_read_async()` and `fs_write_async()`. Requests are
+ * performed in the order they were queued. Do not access the file
+ * system from other threads while requests are queued, as the file
+ * systems are not thread safe.
+ *
+ * @param[in] self_p Initialized file system.
+ * @param[in] stack_p I/O thread stack.
+ * @param[in] stack_size I/O thread stack size.
+ *
+ * @return zero(0) or negative error code.
+ */
+int fs_filesystem_async_start(struct fs_filesystem_t *self_p,
+                              void *stack_p,
+                              size_t stack_size);
+
 /**
  * Initialize given command.
  *
@@ -646,9 +883,12 @@ int fs_counter_init(struct fs_counter_t *self_p,
                     uint64_t value);
 
 /**
- * Increment given counter.
+ * Increment given counter. Lock-free only on targets with 64 bits
+ * atomic instructions, for example Linux. AVR masks interrupts and
+ * other targets, including the ARM, ESP32 and SPC5 ones, take the
+ * system lock. Use `fs_counter_increment_isr()` in interrupt context.
  *
- * @param[in] self_p Command to initialize.
+ * @param[in] self_p Counter to increment.
  * @param[in] value Increment value.
  *
  * @return zero(0) or negative error code.
@@ -656,6 +896,40 @@ int fs_counter_init(struct fs_counter_t *self_p,
 int fs_counter_increment(struct fs_counter_t *self_p,
                          uint64_t value);
 
+/**
+ * Increment given counter from interrupt context.
+ *
+ * @param[in] self_p Counter to increment.
+ * @param[in] value Increment value.
+ *
+ * @return zero(0) or negative error code.
+ */
+int fs_counter_increment_isr(struct fs_counter_t *self_p,
+                             uint64_t value);
+
+/**
+ * Get the value of given counter. The value is read atomically and
+ * is never torn by a concurrent increment.
+ *
+ * @param[in] self_p Counter to read.
+ * @param[out] value_p Counter value.
+ *
+ * @return zero(0) or negative error code.
+ */
+int fs_counter_get(struct fs_counter_t *self_p,
+                   uint64_t *value_p);
+
+/**
+ * Set the value of given counter.
+ *
+ * @param[in] self_p Counter to set.
+ * @param[in] value New counter value.
+ *
+ * @return zero(0) or negative error code.
+ */
+int fs_counter_set(struct fs_counter_t *self_p,
+                   uint64_t value);
+
 /**
  * Register given counter.
  *
@@ -674,6 +948,31 @@ int fs_counter_register(struct fs_counter_t *counter_p);
  */
 int fs_counter_deregister(struct fs_counter_t *counter_p);
 
+/**
+ * Write the names and values of all registered counters to given
+ * channel in binary form, for monitoring tools to poll without
+ * parsing text. Each counter is written as a one byte path length,
+ * the path, and the value as a 64 bits big endian integer. The export
+ * ends with a zero path length.
+ *
+ * @param[in] chout_p Output channel.
+ *
+ * @return Number of exported counters or negative error code.
+ */
+ssize_t fs_counters_export(void *chout_p);
+
+/**
+ * Write all registered counters to given channel in the OpenMetrics
+ * text format, as samples of the counter family ``fs_counter`` with
+ * the counter path as label. Requires
+ * ``CONFIG_STD_PRINTF_LONG_LONG``.
+ *
+ * @param[in] chout_p Output channel.
+ *
+ * @return Number of written counters or negative error code.
+ */
+ssize_t fs_counters_print_openmetrics(void *chout_p);
+
 /**
  * Initialize given parameter.
  *
@@ -0,0 +1,280 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2014-2018, Erik Moqvist
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use, copy,
+ * modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ * This file is part of the Simba project.
+ */
+
+#include "simba.h"
+
+#if CONFIG_ROMFS == 1
+
+#if CONFIG_FILESYSTEM_GENERIC == 1
+
+static struct romfs_t *to_romfs(struct fs_filesystem_t *filesystem_p)
+{
+    return (container_of(filesystem_p->fs.generic.ops_p,
+                         struct romfs_t,
+                         ops));
+}
+
+static int generic_file_open(struct fs_filesystem_t *filesystem_p,
+                             struct fs_file_t *file_p,
+                             const char *path_p,
+                             int flags)
+{
+    struct romfs_t *self_p;
+    const struct romfs_file_t *romfs_file_p;
+    size_t i;
+
+    if (flags != FS_READ) {
+        return (-1);
+    }
+
+    self_p = to_romfs(filesystem_p);
+    romfs_file_p = romfs_find(self_p, path_p);
+
+    if (romfs_file_p == NULL) {
+        return (-1);
+    }
+
+    for (i = 0; i < membersof(self_p->fs_files); i++) {
+        if (self_p->fs_files[i].file_p == NULL) {
+            self_p->fs_files[i].file_p = romfs_file_p;
+            self_p->fs_files[i].pos = 0;
+            file_p->u.generic_p = &self_p->fs_files[i];
+
+            return (0);
+        }
+    }
+
+    return (-1);
+}
+
+static int generic_file_close(struct fs_file_t *file_p)
+{
+    struct romfs_fs_file_t *romfs_file_p;
+
+    romfs_file_p = file_p->u.generic_p;
+    romfs_file_p->file_p = NULL;
+
+    return (0);
+}
+
+static ssize_t generic_file_read(struct fs_file_t *file_p,
+                                 void *dst_p,
+                                 size_t size)
+{
+    struct romfs_fs_file_t *romfs_file_p;
+
+    romfs_file_p = file_p->u.generic_p;
+
+    if (romfs_file_p->pos >= romfs_file_p->file_p->size) {
+        return (0);
+    }
+
+    size = MIN(size, romfs_file_p->file_p->size - romfs_file_p->pos);
+    memcpy(dst_p,
+           (const uint8_t *)romfs_file_p->file_p->buf_p + romfs_file_p->pos,
+           size);
+    romfs_file_p->pos += size;
+
+    return (size);
+}
+
+static ssize_t generic_file_write(struct fs_file_t *file_p,
+                                  const void *src_p,
+                                  size_t size)
+{
+    return (-1);
+}
+
+static int generic_file_seek(struct fs_file_t *file_p,
+                             int offset,
+                             int whence)
+{
+    struct romfs_fs_file_t *romfs_file_p;
+    ssize_t pos;
+
+    romfs_file_p = file_p->u.generic_p;
+
+    switch (whence) {
+
+    case FS_SEEK_SET:
+        pos = offset;
+        break;
+
+    case FS_SEEK_CUR:
+        pos = (romfs_file_p->pos + offset);
+        break;
+
+    case FS_SEEK_END:
+        pos = (romfs_file_p->file_p->size + offset);
+        break;
+
+    default:
+        return (-1);
+    }
+
+    if ((pos < 0) || (pos > (ssize_t)romfs_file_p->file_p->size)) {
+        return (-1);
+    }
+
+    romfs_file_p->pos = pos;
+
+    return (0);
+}
+
+static ssize_t generic_file_tell(struct fs_file_t *file_p)
+{
+    struct romfs_fs_file_t *romfs_file_p;
+
+    romfs_file_p = file_p->u.generic_p;
+
+    return (romfs_file_p->pos);
+}
+
+static int generic_stat(struct fs_filesystem_t *filesystem_p,
+                        const char *path_p,
+                        struct fs_stat_t *stat_p)
+{
+    const struct romfs_file_t *romfs_file_p;
+
+    romfs_file_p = romfs_find(to_romfs(filesystem_p), path_p);
+
+    if (romfs_file_p == NULL) {
+        return (-1);
+    }
+
+    stat_p->size = romfs_file_p->size;
+    stat_p->type = FS_TYPE_FILE;
+
+    return (0);
+}
+
+static int generic_mmap(struct fs_filesystem_t *filesystem_p,
+                        const char *path_p,
+                        const void **buf_pp,
+                        size_t *size_p)
+{
+    return (romfs_mmap(to_romfs(filesystem_p), path_p, buf_pp, size_p));
+}
+
+#endif
+
+int romfs_init(struct romfs_t *self_p,
+               const struct romfs_file_t *files_p)
+{
+    ASSERTN(self_p != NULL, EINVAL);
+    ASSERTN(files_p != NULL, EINVAL);
+
+#if CONFIG_FILESYSTEM_GENERIC == 1
+    size_t i;
+#endif
+
+    self_p->files_p = files_p;
+    self_p->number_of_files = 0;
+
+    while (files_p[self_p->number_of_files].path_p != NULL) {
+        self_p->number_of_files++;
+    }
+
+#if CONFIG_FILESYSTEM_GENERIC == 1
+    memset(&self_p->ops, 0, sizeof(self_p->ops));
+    self_p->ops.file_open = generic_file_open;
+    self_p->ops.file_close = generic_file_close;
+    self_p->ops.file_read = generic_file_read;
+    self_p->ops.file_write = generic_file_write;
+    self_p->ops.file_seek = generic_file_seek;
+    self_p->ops.file_tell = generic_file_tell;
+    self_p->ops.stat = generic_stat;
+    self_p->ops.mmap = generic_mmap;
+
+    for (i = 0; i < membersof(self_p->fs_files); i++) {
+        self_p->fs_files[i].file_p = NULL;
+    }
+#endif
+
+    return (0);
+}
+
+const struct romfs_file_t *romfs_find(struct romfs_t *self_p,
+                                      const char *path_p)
+{
+    ASSERTNRN(self_p != NULL, EINVAL);
+    ASSERTNRN(path_p != NULL, EINVAL);
+
+    size_t low;
+    size_t high;
+    size_t middle;
+    int res;
+
+    if (path_p[0] == '/') {
+        path_p++;
+    }
+
+    low = 0;
+    high = self_p->number_of_files;
+
+    while (low < high) {
+        middle = ((low + high) / 2);
+        res = strcmp(path_p, self_p->files_p[middle].path_p);
+
+        if (res == 0) {
+            return (&self_p->files_p[middle]);
+        } else if (res < 0) {
+            high = middle;
+        } else {
+            low = (middle + 1);
+        }
+    }
+
+    return (NULL);
+}
+
+int romfs_mmap(struct romfs_t *self_p,
+               const char *path_p,
+               const void **buf_pp,
+               size_t *size_p)
+{
+    ASSERTN(self_p != NULL, EINVAL);
+    ASSERTN(path_p != NULL, EINVAL);
+    ASSERTN(buf_pp != NULL, EINVAL);
+    ASSERTN(size_p != NULL, EINVAL);
+
+    const struct romfs_file_t *file_p;
+
+    file_p = romfs_find(self_p, path_p);
+
+    if (file_p == NULL) {
+        return (-ENOENT);
+    }
+
+    *buf_pp = file_p->buf_p;
+    *size_p = file_p->size;
+
+    return (0);
+}
+
+#endif
@@ -0,0 +1,105 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2014-2018, Erik Moqvist
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use, copy,
+ * modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ * This file is part of the Simba project.
+ */
+
+#ifndef __FILESYSTEMS_ROMFS_H__
+#define __FILESYSTEMS_ROMFS_H__
+
+#include "simba.h"
+
+/**
+ * A file in a read-only file system, typically generated at build
+ * time by ``bin/romfs.py``. The file contents are stored in read-only
+ * memory, which is directly addressable flash on most boards.
+ */
+struct romfs_file_t {
+    /* Path without leading slash, or NULL for the last file in the
+       array. */
+    const char *path_p;
+    const void *buf_p;
+    size_t size;
+};
+
+struct romfs_fs_file_t {
+    const struct romfs_file_t *file_p;
+    size_t pos;
+};
+
+struct romfs_t {
+    /* Sorted by path. */
+    const struct romfs_file_t *files_p;
+    size_t number_of_files;
+#if CONFIG_FILESYSTEM_GENERIC == 1
+    /* Operations and open files for fs_filesystem_init_generic(). */
+    struct fs_filesystem_operations_t ops;
+    struct romfs_fs_file_t fs_files[CONFIG_ROMFS_FS_FILES_MAX];
+#endif
+};
+
+/**
+ * Initialize given read-only file system with given files, sorted by
+ * path and terminated by a file with ``path_p`` set to NULL.
+ *
+ * To access the file system using the fs module, pass ``&self_p->ops``
+ * to `fs_filesystem_init_generic()`.
+ *
+ * @param[out] self_p File system to initialize.
+ * @param[in] files_p Array of files.
+ *
+ * @return zero(0) or negative error code.
+ */
+int romfs_init(struct romfs_t *self_p,
+               const struct romfs_file_t *files_p);
+
+/**
+ * Find given file using a binary search.
+ *
+ * @param[in] self_p Initialized file system.
+ * @param[in] path_p File path. A leading slash is ignored.
+ *
+ * @return The file or NULL if not found.
+ */
+const struct romfs_file_t *romfs_find(struct romfs_t *self_p,
+                                      const char *path_p);
+
+/**
+ * Get the address and size of given file's contents, without copying
+ * them.
+ *
+ * @param[in] self_p Initialized file system.
+ * @param[in] path_p File path. A leading slash is ignored.
+ * @param[out] buf_pp File contents.
+ * @param[out] size_p File size.
+ *
+ * @return zero(0) or negative error code.
+ */
+int romfs_mmap(struct romfs_t *self_p,
+               const char *path_p,
+               const void **buf_pp,
+               size_t *size_p);
+
+#endif
@@ -25,3 +25,218 @@
  *
  * This file is part of the Simba project.
  */
+
+#include "simba.h"
+
+#if CONFIG_SPIFFS == 1
+
+#include "spiffs_nucleus.h"
+
+struct module_t {
+    int initialized;
+#if CONFIG_SPIFFS_GC_THREAD == 1
+    struct mutex_t mutex;
+    struct {
+        struct thrd_t *thrd_p;
+        int accessed;
+        int pending;
+    } gc;
+#endif
+#if CONFIG_SPIFFS_COUNTERS == 1
+    struct {
+        uint32_t cache_hits;
+        uint32_t cache_misses;
+        uint32_t gc_runs;
+        struct time_t time;
+    } snapshot;
+    struct fs_counter_t cache_hits;
+    struct fs_counter_t cache_misses;
+    struct fs_counter_t gc_runs;
+    struct fs_counter_t gc_time;
+#endif
+};
+
+static struct module_t module;
+
+#if CONFIG_SPIFFS_COUNTERS == 1
+
+/**
+ * Difference between given current and snapshot values. The runtime
+ * variables are cleared when the file system is mounted.
+ */
+static uint32_t delta(uint32_t value, uint32_t snapshot)
+{
+    if (value >= snapshot) {
+        return (value - snapshot);
+    }
+
+    return (value);
+}
+
+#endif
+
+#if CONFIG_SPIFFS_GC_THREAD == 1
+
+static void *gc_main(void *arg_p)
+{
+    struct spiffs_t *self_p;
+    int32_t res;
+
+    self_p = arg_p;
+    thrd_set_name("spiffs_gc");
+
+    while (1) {
+        thrd_sleep_ms(CONFIG_SPIFFS_GC_THREAD_IDLE_MS);
+
+        /* Blocks are only deleted by API calls, and the flash is
+           not idle if there were any since last wakeup. */
+        if (module.gc.accessed == 1) {
+            module.gc.accessed = 0;
+            module.gc.pending = 1;
+            continue;
+        }
+
+        if (module.gc.pending == 0) {
+            continue;
+        }
+
+        /* Erase one block at a time, and stop as soon as the file
+           system is accessed again. */
+        while (module.gc.accessed == 0) {
+            spiffs_lock(self_p);
+
+            if (spiffs_mounted(self_p)) {
+                res = spiffs_gc_quick(self_p, 0);
+            } else {
+                res = SPIFFS_ERR_NOT_MOUNTED;
+            }
+
+            spiffs_unlock(self_p);
+
+            if (res != SPIFFS_OK) {
+                module.gc.pending = 0;
+                break;
+            }
+        }
+    }
+
+    return (NULL);
+}
+
+#endif
+
+int spiffs_module_init(void)
+{
+    /* Return immediately if the module is already initialized. */
+    if (module.initialized == 1) {
+        return (0);
+    }
+
+    module.initialized = 1;
+
+#if CONFIG_SPIFFS_GC_THREAD == 1
+    mutex_init(&module.mutex);
+#endif
+
+#if CONFIG_SPIFFS_COUNTERS == 1
+    fs_counter_init(&module.cache_hits,
+                    CSTR("/filesystems/spiffs/cache/hits"),
+                    0);
+    fs_counter_register(&module.cache_hits);
+
+    fs_counter_init(&module.cache_misses,
+                    CSTR("/filesystems/spiffs/cache/misses"),
+                    0);
+    fs_counter_register(&module.cache_misses);
+
+    fs_counter_init(&module.gc_runs,
+                    CSTR("/filesystems/spiffs/gc/runs"),
+                    0);
+    fs_counter_register(&module.gc_runs);
+
+    fs_counter_init(&module.gc_time,
+                    CSTR("/filesystems/spiffs/gc/time"),
+                    0);
+    fs_counter_register(&module.gc_time);
+#endif
+
+    return (0);
+}
+
+int spiffs_gc_thread_start(struct spiffs_t *self_p,
+                           void *stack_p,
+                           size_t stack_size)
+{
+    ASSERTN(self_p != NULL, EINVAL);
+    ASSERTN(stack_p != NULL, EINVAL);
+
+#if CONFIG_SPIFFS_GC_THREAD == 1
+    spiffs_module_init();
+
+    if (module.gc.thrd_p != NULL) {
+        return (-EBUSY);
+    }
+
+    module.gc.thrd_p = thrd_spawn(gc_main,
+                                  self_p,
+                                  CONFIG_SPIFFS_GC_THREAD_PRIO,
+                                  stack_p,
+                                  stack_size);
+
+    return (module.gc.thrd_p != NULL ? 0 : -1);
+#else
+    return (-ENOSYS);
+#endif
+}
+
+void spiffs_lock(struct spiffs_t *self_p)
+{
+    if (module.initialized == 0) {
+        spiffs_module_init();
+    }
+
+#if CONFIG_SPIFFS_GC_THREAD == 1
+    mutex_lock(&module.mutex);
+
+    if (thrd_self() != module.gc.thrd_p) {
+        module.gc.accessed = 1;
+    }
+#endif
+
+#if CONFIG_SPIFFS_COUNTERS == 1
+    module.snapshot.cache_hits = self_p->cache_hits;
+    module.snapshot.cache_misses = self_p->cache_misses;
+    module.snapshot.gc_runs = self_p->stats_gc_runs;
+    time_get(&module.snapshot.time);
+#endif
+}
+
+void spiffs_unlock(struct spiffs_t *self_p)
+{
+#if CONFIG_SPIFFS_COUNTERS == 1
+    uint32_t gc_runs;
+    struct time_t now;
+
+    module.cache_hits.value += delta(self_p->cache_hits,
+                                     module.snapshot.cache_hits);
+    module.cache_misses.value += delta(self_p->cache_misses,
+                                       module.snapshot.cache_misses);
+    gc_runs = delta(self_p->stats_gc_runs, module.snapshot.gc_runs);
+
+    /* The whole API call is accounted as garbage collection time if
+       the garbage collector was run. */
+    if (gc_runs > 0) {
+        module.gc_runs.value += gc_runs;
+        time_get(&now);
+        time_subtract(&now, &now, &module.snapshot.time);
+        module.gc_time.value += (1000ull * now.seconds
+                                 + now.nanoseconds / 1000000);
+    }
+#endif
+
+#if CONFIG_SPIFFS_GC_THREAD == 1
+    mutex_unlock(&module.mutex);
+#endif
+}
+
+#endif
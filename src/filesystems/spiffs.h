@@ -878,6 +878,44 @@ uint32_t spiffs_buffer_bytes_for_cache(struct spiffs_t *self_p,
 #    endif
 #endif
 
+/**
+ * Initialize the spiffs module. This function is called
+ * automatically by the first spiffs API call, and it is safe to call
+ * it multiple times.
+ *
+ * @return zero(0) or negative error code.
+ */
+int spiffs_module_init(void);
+
+/**
+ * Start a low priority thread that erases fully deleted blocks in
+ * given file system when there has been no spiffs API calls for
+ * ``CONFIG_SPIFFS_GC_THREAD_IDLE_MS`` milliseconds. Only one garbage
+ * collector thread can be started.
+ *
+ * @param[in] self_p The file system struct.
+ * @param[in] stack_p Garbage collector thread stack.
+ * @param[in] stack_size Garbage collector thread stack size.
+ *
+ * @return zero(0) or negative error code, -ENOSYS if
+ *         ``CONFIG_SPIFFS_GC_THREAD`` is disabled.
+ */
+int spiffs_gc_thread_start(struct spiffs_t *self_p,
+                           void *stack_p,
+                           size_t stack_size);
+
+/**
+ * Called at the beginning of each spiffs API call. Used internally
+ * by spiffs.
+ */
+void spiffs_lock(struct spiffs_t *self_p);
+
+/**
+ * Called at the end of each spiffs API call. Used internally by
+ * spiffs.
+ */
+void spiffs_unlock(struct spiffs_t *self_p);
+
 /* Used internally by spiffs. */
 typedef spiffs_block_ix_t spiffs_block_ix;
 typedef spiffs_page_ix_t spiffs_page_ix;
@@ -33,18 +33,53 @@ static inline uint32_t rotateleft(uint32_t value, int positions)
     return ((value << positions) | (value >> (32 - positions)));
 }
 
-static void block_update(struct sha1_t *self_p,
-                         uint8_t *block_p)
+/**
+ * Read a big endian 32 bits word from given, possibly unaligned,
+ * buffer.
+ */
+static inline uint32_t read_word(const uint8_t *buf_p)
 {
-    uint32_t a ,b ,c ,d ,e, f, i ,t ,w[80];
-    uint32_t *b_p = (uint32_t *)block_p;
+    return (((uint32_t)buf_p[0] << 24)
+            | ((uint32_t)buf_p[1] << 16)
+            | ((uint32_t)buf_p[2] << 8)
+            | ((uint32_t)buf_p[3] << 0));
+}
 
-    for (i = 0; i < 16; i++) {
-        w[i] = ntohl(b_p[i]);
+/**
+ * Return the message schedule word of given round. Only the last 16
+ * words are kept, in a circular buffer.
+ */
+static inline uint32_t schedule(uint32_t *w_p, int i)
+{
+    if (i >= 16) {
+        w_p[i & 15] = rotateleft(w_p[(i - 3) & 15]
+                                 ^ w_p[(i - 8) & 15]
+                                 ^ w_p[(i - 14) & 15]
+                                 ^ w_p[i & 15],
+                                 1);
     }
 
-    for (i = 16; i < 80; i++) {
-        w[i] = rotateleft(w[i - 3] ^ w[i - 8] ^ w[i - 14] ^ w[i - 16], 1);
+    return (w_p[i & 15]);
+}
+
+#define ROUND(f, k)                                                     \
+    do {                                                                \
+        t = rotateleft(a, 5) + (f) + e + (k) + schedule(&w[0], i);      \
+        e = d;                                                          \
+        d = c;                                                          \
+        c = rotateleft(b, 30);                                          \
+        b = a;                                                          \
+        a = t;                                                          \
+    } while (0)
+
+static void block_update(struct sha1_t *self_p,
+                         const uint8_t *block_p)
+{
+    uint32_t a, b, c, d, e, t, w[16];
+    int i;
+
+    for (i = 0; i < 16; i++) {
+        w[i] = read_word(&block_p[4 * i]);
     }
 
     a = self_p->h[0];
@@ -54,43 +89,19 @@ static void block_update(struct sha1_t *self_p,
     e = self_p->h[4];
 
     for (i = 0; i < 20; i++) {
-        f = ((b & c) ^ (~b & d));
-        t = rotateleft(a, 5) + f + e + 0x5a827999 + w[i];
-        e = d;
-        d = c;
-        c = rotateleft(b, 30);
-        b = a;
-        a = t;
+        ROUND((d ^ (b & (c ^ d))), 0x5a827999);
     }
 
     for (; i < 40; i++) {
-        f = (b ^ c ^ d);
-        t = rotateleft(a, 5) + f + e + 0x6ed9eba1 + w[i];
-        e = d;
-        d = c;
-        c = rotateleft(b, 30);
-        b = a;
-        a = t;
+        ROUND((b ^ c ^ d), 0x6ed9eba1);
     }
 
     for (; i < 60; i++) {
-        f = ((b & c) ^ (b & d) ^ (c & d));
-        t = rotateleft(a, 5) + f + e + 0x8f1bbcdc + w[i];
-        e = d;
-        d = c;
-        c = rotateleft(b, 30);
-        b = a;
-        a = t;
+        ROUND(((b & c) | (d & (b | c))), 0x8f1bbcdc);
     }
 
     for (; i < 80; i++) {
-        f = (b ^ c ^ d);
-        t = rotateleft(a,5) + f + e + 0xca62c1d6 + w[i];
-        e = d;
-        d = c;
-        c = rotateleft(b, 30);
-        b = a;
-        a = t;
+        ROUND((b ^ c ^ d), 0xca62c1d6);
     }
 
     self_p->h[0] += a;
@@ -139,10 +150,10 @@ int sha1_update(struct sha1_t *self_p,
         }
     }
 
-    /* Main loop. */
+    /* Main loop: Process complete blocks directly from the input
+       buffer. */
     while (size >= 64) {
-        memcpy(&self_p->block.buf[0], b_p, 64);
-        block_update(self_p, self_p->block.buf);
+        block_update(self_p, b_p);
         size -= 64;
         b_p += 64;
     }
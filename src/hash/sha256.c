@@ -0,0 +1,301 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2018, Erik Moqvist
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use, copy,
+ * modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ * This file is part of the Simba project.
+ */
+
+#include "simba.h"
+
+static FAR const uint32_t k[64] = {
+    0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5,
+    0x3956c25b, 0x59f111f1, 0x923f82a4, 0xab1c5ed5,
+    0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3,
+    0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174,
+    0xe49b69c1, 0xefbe4786, 0x0fc19dc6, 0x240ca1cc,
+    0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da,
+    0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7,
+    0xc6e00bf3, 0xd5a79147, 0x06ca6351, 0x14292967,
+    0x27b70a85, 0x2e1b2138, 0x4d2c6dfc, 0x53380d13,
+    0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85,
+    0xa2bfe8a1, 0xa81a664b, 0xc24b8b70, 0xc76c51a3,
+    0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070,
+    0x19a4c116, 0x1e376c08, 0x2748774c, 0x34b0bcb5,
+    0x391c0cb3, 0x4ed8aa4a, 0x5b9cca4f, 0x682e6ff3,
+    0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208,
+    0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2
+};
+
+static inline uint32_t rotateright(uint32_t value, int positions)
+{
+    return ((value >> positions) | (value << (32 - positions)));
+}
+
+/**
+ * Read a big endian 32 bits word from given, possibly unaligned,
+ * buffer.
+ */
+static inline uint32_t read_word(const uint8_t *buf_p)
+{
+    return (((uint32_t)buf_p[0] << 24)
+            | ((uint32_t)buf_p[1] << 16)
+            | ((uint32_t)buf_p[2] << 8)
+            | ((uint32_t)buf_p[3] << 0));
+}
+
+#define CH(x, y, z) ((z) ^ ((x) & ((y) ^ (z))))
+#define MAJ(x, y, z) (((x) & (y)) | ((z) & ((x) | (y))))
+#define SIGMA0(x) (rotateright(x, 2) ^ rotateright(x, 13) ^ rotateright(x, 22))
+#define SIGMA1(x) (rotateright(x, 6) ^ rotateright(x, 11) ^ rotateright(x, 25))
+#define GAMMA0(x) (rotateright(x, 7) ^ rotateright(x, 18) ^ ((x) >> 3))
+#define GAMMA1(x) (rotateright(x, 17) ^ rotateright(x, 19) ^ ((x) >> 10))
+
+/**
+ * Return the message schedule word of given round. Only the last 16
+ * words are kept, in a circular buffer.
+ */
+static inline uint32_t schedule(uint32_t *w_p, int i)
+{
+    if (i >= 16) {
+        w_p[i & 15] += (GAMMA1(w_p[(i - 2) & 15])
+                        + w_p[(i - 7) & 15]
+                        + GAMMA0(w_p[(i - 15) & 15]));
+    }
+
+    return (w_p[i & 15]);
+}
+
+/**
+ * One compression round. Instead of shifting all eight working
+ * variables each round, the caller rotates the argument order.
+ */
+#define ROUND(a, b, c, d, e, f, g, h, i)                                \
+    do {                                                                \
+        t = (h + SIGMA1(e) + CH(e, f, g) + k[i] + schedule(&w[0], i));  \
+        d += t;                                                         \
+        h = (t + SIGMA0(a) + MAJ(a, b, c));                             \
+    } while (0)
+
+static void block_update(struct sha256_t *self_p,
+                         const uint8_t *block_p)
+{
+    uint32_t a, b, c, d, e, f, g, h, t, w[16];
+    int i;
+
+    for (i = 0; i < 16; i++) {
+        w[i] = read_word(&block_p[4 * i]);
+    }
+
+    a = self_p->h[0];
+    b = self_p->h[1];
+    c = self_p->h[2];
+    d = self_p->h[3];
+    e = self_p->h[4];
+    f = self_p->h[5];
+    g = self_p->h[6];
+    h = self_p->h[7];
+
+    for (i = 0; i < 64; i += 8) {
+        ROUND(a, b, c, d, e, f, g, h, i + 0);
+        ROUND(h, a, b, c, d, e, f, g, i + 1);
+        ROUND(g, h, a, b, c, d, e, f, i + 2);
+        ROUND(f, g, h, a, b, c, d, e, i + 3);
+        ROUND(e, f, g, h, a, b, c, d, i + 4);
+        ROUND(d, e, f, g, h, a, b, c, i + 5);
+        ROUND(c, d, e, f, g, h, a, b, i + 6);
+        ROUND(b, c, d, e, f, g, h, a, i + 7);
+    }
+
+    self_p->h[0] += a;
+    self_p->h[1] += b;
+    self_p->h[2] += c;
+    self_p->h[3] += d;
+    self_p->h[4] += e;
+    self_p->h[5] += f;
+    self_p->h[6] += g;
+    self_p->h[7] += h;
+}
+
+int sha256_init(struct sha256_t *self_p)
+{
+    ASSERTN(self_p != NULL, EINVAL);
+
+    self_p->block.size = 0;
+    self_p->h[0] = 0x6a09e667;
+    self_p->h[1] = 0xbb67ae85;
+    self_p->h[2] = 0x3c6ef372;
+    self_p->h[3] = 0xa54ff53a;
+    self_p->h[4] = 0x510e527f;
+    self_p->h[5] = 0x9b05688c;
+    self_p->h[6] = 0x1f83d9ab;
+    self_p->h[7] = 0x5be0cd19;
+    self_p->size = 0;
+
+    return (0);
+}
+
+int sha256_update(struct sha256_t *self_p,
+                  const void *buf_p,
+                  size_t size)
+{
+    ASSERTN(self_p != NULL, EINVAL);
+    ASSERTN((buf_p != NULL) || (size == 0), EINVAL);
+
+    uint32_t temp;
+    const uint8_t *b_p = buf_p;
+
+    self_p->size += size;
+
+    /* Prologue: Fill the buffer. */
+    if (self_p->block.size > 0) {
+        if ((self_p->block.size + size) >= 64) {
+            temp = (64 - self_p->block.size);
+            memcpy(&self_p->block.buf[self_p->block.size], b_p, temp);
+            size -= temp;
+            b_p += temp;
+            block_update(self_p, self_p->block.buf);
+            self_p->block.size = 0;
+        }
+    }
+
+    /* Main loop: Process complete blocks directly from the input
+       buffer. */
+    while (size >= 64) {
+        block_update(self_p, b_p);
+        size -= 64;
+        b_p += 64;
+    }
+
+    /* Epilogue: Save left over block in buffer. */
+    if (size > 0) {
+        memcpy(&self_p->block.buf[self_p->block.size], b_p, size);
+        self_p->block.size += size;
+    }
+
+    return (0);
+}
+
+int sha256_digest(struct sha256_t *self_p,
+                  uint8_t *hash_p)
+{
+    ASSERTN(self_p != NULL, EINVAL);
+    ASSERTN(hash_p != NULL, EINVAL);
+
+    int i;
+
+    i = self_p->block.size;
+
+    /* Add the last byte 0x80 and zero-padding. */
+    self_p->block.buf[i++] = 0x80;
+
+    if (i > 56) {
+        if (i < 64) {
+            memset(&self_p->block.buf[i], 0, 64 - i);
+        }
+
+        block_update(self_p, self_p->block.buf);
+        i = 0;
+    }
+
+    if (i < 56) {
+        memset(&self_p->block.buf[i], 0, 56 - i);
+    }
+
+    /* Append the message length and do the last block update. */
+    for (i = 0; i < 8; i++) {
+        self_p->block.buf[56 + i] = ((8 * self_p->size) >> (56 - 8 * i));
+    }
+
+    block_update(self_p, self_p->block.buf);
+
+    /* Copy the hash to the output buffer. */
+    for (i = 0; i < membersof(self_p->h); i++) {
+        self_p->h[i] = htonl(self_p->h[i]);
+    }
+
+    memcpy(hash_p, self_p->h, 32);
+
+    return (0);
+}
+
+static void hmac_pad(struct sha256_hmac_t *self_p, uint8_t pad)
+{
+    uint8_t buf[64];
+    int i;
+
+    for (i = 0; i < sizeof(buf); i++) {
+        buf[i] = (self_p->key[i] ^ pad);
+    }
+
+    sha256_init(&self_p->sha256);
+    sha256_update(&self_p->sha256, &buf[0], sizeof(buf));
+}
+
+int sha256_hmac_init(struct sha256_hmac_t *self_p,
+                     const void *key_p,
+                     size_t size)
+{
+    ASSERTN(self_p != NULL, EINVAL);
+    ASSERTN((key_p != NULL) || (size == 0), EINVAL);
+
+    memset(&self_p->key[0], 0, sizeof(self_p->key));
+
+    if (size > sizeof(self_p->key)) {
+        sha256_init(&self_p->sha256);
+        sha256_update(&self_p->sha256, key_p, size);
+        sha256_digest(&self_p->sha256, &self_p->key[0]);
+    } else if (size > 0) {
+        memcpy(&self_p->key[0], key_p, size);
+    }
+
+    hmac_pad(self_p, 0x36);
+
+    return (0);
+}
+
+int sha256_hmac_update(struct sha256_hmac_t *self_p,
+                       const void *buf_p,
+                       size_t size)
+{
+    ASSERTN(self_p != NULL, EINVAL);
+
+    return (sha256_update(&self_p->sha256, buf_p, size));
+}
+
+int sha256_hmac_digest(struct sha256_hmac_t *self_p,
+                       uint8_t *hmac_p)
+{
+    ASSERTN(self_p != NULL, EINVAL);
+    ASSERTN(hmac_p != NULL, EINVAL);
+
+    uint8_t hash[32];
+
+    sha256_digest(&self_p->sha256, &hash[0]);
+    hmac_pad(self_p, 0x5c);
+    sha256_update(&self_p->sha256, &hash[0], sizeof(hash));
+    sha256_digest(&self_p->sha256, hmac_p);
+    memset(&self_p->key[0], 0, sizeof(self_p->key));
+
+    return (0);
+}
@@ -0,0 +1,125 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2018, Erik Moqvist
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use, copy,
+ * modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ * This file is part of the Simba project.
+ */
+
+#ifndef __HASH_SHA256_H__
+#define __HASH_SHA256_H__
+
+#include "simba.h"
+
+struct sha256_t {
+    struct {
+        uint8_t buf[64];
+        uint32_t size;
+    } block;
+    uint32_t h[8];
+    uint64_t size;
+};
+
+struct sha256_hmac_t {
+    struct sha256_t sha256;
+    uint8_t key[64];
+};
+
+/**
+ * Initialize given SHA256 object.
+ *
+ * @param[in,out] self_p SHA256 object.
+ *
+ * @return zero(0) or negative error code.
+ */
+int sha256_init(struct sha256_t *self_p);
+
+/**
+ * Update the sha object with the given buffer. Repeated calls are
+ * equivalent to a single call with the concatenation of all the
+ * arguments.
+ *
+ * @param[in] self_p SHA256 object.
+ * @param[in] buf_p Buffer to update the sha object with.
+ * @param[in] size Size of the buffer.
+ *
+ * @return zero(0) or negative error code.
+ */
+int sha256_update(struct sha256_t *self_p,
+                  const void *buf_p,
+                  size_t size);
+
+/**
+ * Return the digest of the strings passed to the sha256_update()
+ * method so far. This is a 32-byte value which may contain non-ASCII
+ * characters, including null bytes.
+ *
+ * @param[in] self_p SHA256 object.
+ * @param[out] hash_p Hash sum.
+ *
+ * @return zero(0) or negative error code.
+ */
+int sha256_digest(struct sha256_t *self_p,
+                  uint8_t *hash_p);
+
+/**
+ * Initialize given HMAC-SHA256 object with given key.
+ *
+ * @param[out] self_p HMAC object.
+ * @param[in] key_p Key.
+ * @param[in] size Key size in bytes. Keys longer than 64 bytes are
+ *                 hashed.
+ *
+ * @return zero(0) or negative error code.
+ */
+int sha256_hmac_init(struct sha256_hmac_t *self_p,
+                     const void *key_p,
+                     size_t size);
+
+/**
+ * Update the HMAC object with the given buffer.
+ *
+ * @param[in] self_p HMAC object.
+ * @param[in] buf_p Buffer to update the HMAC object with.
+ * @param[in] size Size of the buffer.
+ *
+ * @return zero(0) or negative error code.
+ */
+int sha256_hmac_update(struct sha256_hmac_t *self_p,
+                       const void *buf_p,
+                       size_t size);
+
+/**
+ * Return the 32 bytes HMAC of the strings passed to the
+ * sha256_hmac_update() method so far. The key is cleared from the
+ * object.
+ *
+ * @param[in] self_p HMAC object.
+ * @param[out] hmac_p HMAC.
+ *
+ * @return zero(0) or negative error code.
+ */
+int sha256_hmac_digest(struct sha256_hmac_t *self_p,
+                       uint8_t *hmac_p);
+
+#endif
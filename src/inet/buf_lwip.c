@@ -0,0 +1,104 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2014-2018, Erik Moqvist
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use, copy,
+ * modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ * This file is part of the Simba project.
+ */
+
+#include "simba.h"
+
+#if !defined(ARCH_LINUX)
+
+#include "lwip/pbuf.h"
+
+static void free_pbuf(void *arg_p)
+{
+    pbuf_free(arg_p);
+}
+
+struct buf_t *buf_lwip_from_pbuf(struct buf_pool_t *pool_p,
+                                 struct pbuf *pbuf_p)
+{
+    ASSERTNRN(pool_p != NULL, EINVAL);
+    ASSERTNRN(pbuf_p != NULL, EINVAL);
+
+    struct buf_t *head_p;
+    struct buf_t *buf_p;
+    struct buf_t **next_pp;
+
+    head_p = NULL;
+    next_pp = &head_p;
+
+    while (pbuf_p != NULL) {
+        buf_p = buf_alloc_ref(pool_p,
+                              pbuf_p->payload,
+                              pbuf_p->len,
+                              free_pbuf,
+                              pbuf_p);
+
+        if (buf_p == NULL) {
+            if (head_p != NULL) {
+                buf_free(head_p);
+            }
+
+            return (NULL);
+        }
+
+        pbuf_ref(pbuf_p);
+        *next_pp = buf_p;
+        next_pp = &buf_p->next_p;
+
+        /* The last pbuf of a packet. */
+        if (pbuf_p->len == pbuf_p->tot_len) {
+            break;
+        }
+
+        pbuf_p = pbuf_p->next;
+    }
+
+    return (head_p);
+}
+
+struct pbuf *buf_lwip_to_pbuf(struct buf_t *buf_p)
+{
+    ASSERTNRN(buf_p != NULL, EINVAL);
+
+    struct pbuf *pbuf_p;
+    ssize_t size;
+
+    size = buf_size(buf_p);
+
+    /* RAM pbufs have contiguous payload. */
+    pbuf_p = pbuf_alloc(PBUF_RAW, size, PBUF_RAM);
+
+    if (pbuf_p == NULL) {
+        return (NULL);
+    }
+
+    buf_read(buf_p, 0, pbuf_p->payload, size);
+
+    return (pbuf_p);
+}
+
+#endif
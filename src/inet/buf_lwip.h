@@ -0,0 +1,60 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2014-2018, Erik Moqvist
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use, copy,
+ * modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ * This file is part of the Simba project.
+ */
+
+#ifndef __INET_BUF_LWIP_H__
+#define __INET_BUF_LWIP_H__
+
+#include "simba.h"
+
+struct pbuf;
+
+/**
+ * Create a buffer chain referencing the data of given lwIP pbuf
+ * chain, without copying it. Each pbuf in the chain is referenced
+ * until the buffer referencing it is freed, so the caller still owns
+ * its own reference to the pbuf chain. Not available on Linux.
+ *
+ * @param[in] pool_p Buffer pool to allocate the buffers from.
+ * @param[in] pbuf_p The pbuf chain.
+ *
+ * @return Buffer chain, or NULL on failure.
+ */
+struct buf_t *buf_lwip_from_pbuf(struct buf_pool_t *pool_p,
+                                 struct pbuf *pbuf_p);
+
+/**
+ * Create an lwIP pbuf with a copy of the data in given buffer chain,
+ * to pass to lwIP functions taking a pbuf. Not available on Linux.
+ *
+ * @param[in] buf_p The buffer chain.
+ *
+ * @return The pbuf, or NULL on failure.
+ */
+struct pbuf *buf_lwip_to_pbuf(struct buf_t *buf_p);
+
+#endif
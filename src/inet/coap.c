@@ -0,0 +1,439 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2014-2018, Erik Moqvist
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use, copy,
+ * modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ * This file is part of the Simba project.
+ */
+
+#include "simba.h"
+
+#define COAP_VERSION                                            1
+#define PAYLOAD_MARKER                                       0xff
+
+/* Option number after the payload has been added. */
+#define OPTION_NUMBER_PAYLOAD                             0x10000
+
+/**
+ * Decode an option delta or length nibble, and its extended bytes.
+ */
+static int decode_nibble(const uint8_t *buf_p,
+                         size_t size,
+                         size_t *pos_p,
+                         int *value_p)
+{
+    switch (*value_p) {
+
+    case 13:
+        if (*pos_p + 1 > size) {
+            return (-EBADMSG);
+        }
+
+        *value_p = (buf_p[*pos_p] + 13);
+        *pos_p += 1;
+        break;
+
+    case 14:
+        if (*pos_p + 2 > size) {
+            return (-EBADMSG);
+        }
+
+        *value_p = (((buf_p[*pos_p] << 8) | buf_p[*pos_p + 1]) + 269);
+        *pos_p += 2;
+        break;
+
+    case 15:
+        return (-EBADMSG);
+
+    default:
+        break;
+    }
+
+    return (0);
+}
+
+/**
+ * Encode an option delta or length as a nibble, and append its
+ * extended bytes to given buffer.
+ */
+static int encode_nibble(uint32_t value, uint8_t *buf_p, size_t *pos_p)
+{
+    if (value < 13) {
+        return (value);
+    }
+
+    if (value < 269) {
+        buf_p[(*pos_p)++] = (value - 13);
+
+        return (13);
+    }
+
+    value -= 269;
+    buf_p[(*pos_p)++] = (value >> 8);
+    buf_p[(*pos_p)++] = value;
+
+    return (14);
+}
+
+static void encoder_write(struct coap_encoder_t *self_p,
+                          const void *buf_p,
+                          size_t size)
+{
+    if (self_p->pos + size > self_p->size) {
+        self_p->overflow = 1;
+
+        return;
+    }
+
+    memcpy(&self_p->buf_p[self_p->pos], buf_p, size);
+    self_p->pos += size;
+}
+
+int coap_message_decode(struct coap_message_t *self_p,
+                        const uint8_t *buf_p,
+                        size_t size)
+{
+    ASSERTN(self_p != NULL, EINVAL);
+    ASSERTN(buf_p != NULL, EINVAL);
+
+    size_t pos;
+    int number;
+    int delta;
+    int length;
+    struct coap_option_t *option_p;
+
+    if (size < 4) {
+        return (-EBADMSG);
+    }
+
+    if ((buf_p[0] >> 6) != COAP_VERSION) {
+        return (-EBADMSG);
+    }
+
+    self_p->type = ((buf_p[0] >> 4) & 0x3);
+    self_p->token_size = (buf_p[0] & 0xf);
+    self_p->code = buf_p[1];
+    self_p->message_id = ((buf_p[2] << 8) | buf_p[3]);
+    self_p->options.length = 0;
+    self_p->payload_p = NULL;
+    self_p->payload_size = 0;
+    pos = 4;
+
+    if ((self_p->token_size > COAP_TOKEN_SIZE_MAX)
+        || (pos + self_p->token_size > size)) {
+        return (-EBADMSG);
+    }
+
+    memcpy(&self_p->token[0], &buf_p[pos], self_p->token_size);
+    pos += self_p->token_size;
+
+    /* An empty message has no token, options or payload. */
+    if (self_p->code == COAP_CODE_EMPTY) {
+        if ((self_p->token_size != 0) || (pos != size)) {
+            return (-EBADMSG);
+        }
+
+        return (0);
+    }
+
+    number = 0;
+
+    while (pos < size) {
+        if (buf_p[pos] == PAYLOAD_MARKER) {
+            pos++;
+
+            /* A payload marker followed by no payload is an error. */
+            if (pos == size) {
+                return (-EBADMSG);
+            }
+
+            self_p->payload_p = &buf_p[pos];
+            self_p->payload_size = (size - pos);
+            break;
+        }
+
+        delta = (buf_p[pos] >> 4);
+        length = (buf_p[pos] & 0xf);
+        pos++;
+
+        if (decode_nibble(buf_p, size, &pos, &delta) != 0) {
+            return (-EBADMSG);
+        }
+
+        if (decode_nibble(buf_p, size, &pos, &length) != 0) {
+            return (-EBADMSG);
+        }
+
+        if (pos + length > size) {
+            return (-EBADMSG);
+        }
+
+        if (self_p->options.length == membersof(self_p->options.buf)) {
+            return (-EBADMSG);
+        }
+
+        number += delta;
+        option_p = &self_p->options.buf[self_p->options.length];
+        option_p->number = number;
+        option_p->size = length;
+        option_p->value_p = &buf_p[pos];
+        self_p->options.length++;
+        pos += length;
+    }
+
+    return (0);
+}
+
+int coap_message_get_uint_option(const struct coap_message_t *self_p,
+                                 int number,
+                                 uint32_t *value_p)
+{
+    ASSERTN(self_p != NULL, EINVAL);
+    ASSERTN(value_p != NULL, EINVAL);
+
+    const struct coap_option_t *option_p;
+    size_t i;
+    size_t j;
+
+    for (i = 0; i < self_p->options.length; i++) {
+        option_p = &self_p->options.buf[i];
+
+        if (option_p->number == number) {
+            /* At most four bytes. */
+            if (option_p->size > 4) {
+                return (-EBADMSG);
+            }
+
+            *value_p = 0;
+
+            for (j = 0; j < option_p->size; j++) {
+                *value_p <<= 8;
+                *value_p |= option_p->value_p[j];
+            }
+
+            return (0);
+        }
+    }
+
+    return (-ENOENT);
+}
+
+ssize_t coap_message_get_path(const struct coap_message_t *self_p,
+                              char *buf_p,
+                              size_t size)
+{
+    ASSERTN(self_p != NULL, EINVAL);
+    ASSERTN(buf_p != NULL, EINVAL);
+    ASSERTN(size > 0, EINVAL);
+
+    const struct coap_option_t *option_p;
+    size_t pos;
+    size_t i;
+
+    pos = 0;
+
+    for (i = 0; i < self_p->options.length; i++) {
+        option_p = &self_p->options.buf[i];
+
+        if (option_p->number != COAP_OPTION_URI_PATH) {
+            continue;
+        }
+
+        /* Room for the separator, the segment and the null
+           termination. */
+        if (pos + 1 + option_p->size + 1 > size) {
+            return (-ENOMEM);
+        }
+
+        buf_p[pos++] = '/';
+        memcpy(&buf_p[pos], option_p->value_p, option_p->size);
+        pos += option_p->size;
+    }
+
+    if (pos == 0) {
+        if (size < 2) {
+            return (-ENOMEM);
+        }
+
+        buf_p[pos++] = '/';
+    }
+
+    buf_p[pos] = '\0';
+
+    return (pos);
+}
+
+int coap_encoder_init(struct coap_encoder_t *self_p,
+                      uint8_t *buf_p,
+                      size_t size,
+                      int type,
+                      int code,
+                      uint16_t message_id,
+                      const uint8_t *token_p,
+                      size_t token_size)
+{
+    ASSERTN(self_p != NULL, EINVAL);
+    ASSERTN(buf_p != NULL, EINVAL);
+    ASSERTN(token_size <= COAP_TOKEN_SIZE_MAX, EINVAL);
+
+    uint8_t header[4];
+
+    self_p->buf_p = buf_p;
+    self_p->size = size;
+    self_p->pos = 0;
+    self_p->option_number = 0;
+    self_p->overflow = 0;
+
+    header[0] = ((COAP_VERSION << 6) | (type << 4) | token_size);
+    header[1] = code;
+    header[2] = (message_id >> 8);
+    header[3] = message_id;
+    encoder_write(self_p, &header[0], sizeof(header));
+    encoder_write(self_p, token_p, token_size);
+
+    return (0);
+}
+
+int coap_encoder_add_option(struct coap_encoder_t *self_p,
+                            int number,
+                            const void *value_p,
+                            size_t size)
+{
+    ASSERTN(self_p != NULL, EINVAL);
+    ASSERTN((value_p != NULL) || (size == 0), EINVAL);
+
+    uint8_t header[5];
+    size_t pos;
+    int delta;
+    int length;
+
+    if (number < self_p->option_number) {
+        return (-EINVAL);
+    }
+
+    pos = 1;
+    delta = encode_nibble(number - self_p->option_number, &header[0], &pos);
+    length = encode_nibble(size, &header[0], &pos);
+    header[0] = ((delta << 4) | length);
+    encoder_write(self_p, &header[0], pos);
+    encoder_write(self_p, value_p, size);
+    self_p->option_number = number;
+
+    return (0);
+}
+
+int coap_encoder_add_uint_option(struct coap_encoder_t *self_p,
+                                 int number,
+                                 uint32_t value)
+{
+    ASSERTN(self_p != NULL, EINVAL);
+
+    uint8_t buf[4];
+    size_t size;
+
+    size = 0;
+
+    while (value > 0) {
+        size++;
+        buf[sizeof(buf) - size] = value;
+        value >>= 8;
+    }
+
+    return (coap_encoder_add_option(self_p,
+                                    number,
+                                    &buf[sizeof(buf) - size],
+                                    size));
+}
+
+int coap_encoder_add_path(struct coap_encoder_t *self_p,
+                          const char *path_p)
+{
+    ASSERTN(self_p != NULL, EINVAL);
+    ASSERTN(path_p != NULL, EINVAL);
+
+    const char *end_p;
+    int res;
+
+    while (*path_p != '\0') {
+        if (*path_p == '/') {
+            path_p++;
+            continue;
+        }
+
+        end_p = strchr(path_p, '/');
+
+        if (end_p == NULL) {
+            end_p = (path_p + strlen(path_p));
+        }
+
+        res = coap_encoder_add_option(self_p,
+                                      COAP_OPTION_URI_PATH,
+                                      path_p,
+                                      end_p - path_p);
+
+        if (res != 0) {
+            return (res);
+        }
+
+        path_p = end_p;
+    }
+
+    return (0);
+}
+
+int coap_encoder_add_payload(struct coap_encoder_t *self_p,
+                             const void *buf_p,
+                             size_t size)
+{
+    ASSERTN(self_p != NULL, EINVAL);
+    ASSERTN((buf_p != NULL) || (size == 0), EINVAL);
+
+    uint8_t marker;
+
+    if (self_p->option_number == OPTION_NUMBER_PAYLOAD) {
+        return (-EINVAL);
+    }
+
+    self_p->option_number = OPTION_NUMBER_PAYLOAD;
+
+    if (size == 0) {
+        return (0);
+    }
+
+    marker = PAYLOAD_MARKER;
+    encoder_write(self_p, &marker, 1);
+    encoder_write(self_p, buf_p, size);
+
+    return (0);
+}
+
+ssize_t coap_encoder_get_size(struct coap_encoder_t *self_p)
+{
+    ASSERTN(self_p != NULL, EINVAL);
+
+    if (self_p->overflow == 1) {
+        return (-ENOMEM);
+    }
+
+    return (self_p->pos);
+}
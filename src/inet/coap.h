@@ -0,0 +1,267 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2014-2018, Erik Moqvist
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use, copy,
+ * modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ * This file is part of the Simba project.
+ */
+
+#ifndef __INET_COAP_H__
+#define __INET_COAP_H__
+
+#include "simba.h"
+
+/**
+ * Message types.
+ */
+#define COAP_TYPE_CONFIRMABLE                                   0
+#define COAP_TYPE_NON_CONFIRMABLE                               1
+#define COAP_TYPE_ACKNOWLEDGEMENT                               2
+#define COAP_TYPE_RESET                                         3
+
+/**
+ * Message codes, written as class and detail, for example 2.05 for
+ * Content.
+ */
+#define COAP_CODE(class, detail)            (((class) << 5) | (detail))
+#define COAP_CODE_CLASS(code)                          ((code) >> 5)
+
+#define COAP_CODE_EMPTY                             COAP_CODE(0, 0)
+#define COAP_CODE_GET                               COAP_CODE(0, 1)
+#define COAP_CODE_POST                              COAP_CODE(0, 2)
+#define COAP_CODE_PUT                               COAP_CODE(0, 3)
+#define COAP_CODE_DELETE                            COAP_CODE(0, 4)
+#define COAP_CODE_CREATED                           COAP_CODE(2, 1)
+#define COAP_CODE_DELETED                           COAP_CODE(2, 2)
+#define COAP_CODE_VALID                             COAP_CODE(2, 3)
+#define COAP_CODE_CHANGED                           COAP_CODE(2, 4)
+#define COAP_CODE_CONTENT                           COAP_CODE(2, 5)
+#define COAP_CODE_BAD_REQUEST                       COAP_CODE(4, 0)
+#define COAP_CODE_BAD_OPTION                        COAP_CODE(4, 2)
+#define COAP_CODE_NOT_FOUND                         COAP_CODE(4, 4)
+#define COAP_CODE_METHOD_NOT_ALLOWED                COAP_CODE(4, 5)
+#define COAP_CODE_REQUEST_ENTITY_TOO_LARGE          COAP_CODE(4, 13)
+#define COAP_CODE_INTERNAL_SERVER_ERROR             COAP_CODE(5, 0)
+
+/**
+ * Option numbers.
+ */
+#define COAP_OPTION_OBSERVE                                     6
+#define COAP_OPTION_URI_PATH                                   11
+#define COAP_OPTION_CONTENT_FORMAT                             12
+#define COAP_OPTION_URI_QUERY                                  15
+#define COAP_OPTION_BLOCK2                                     23
+#define COAP_OPTION_BLOCK1                                     27
+#define COAP_OPTION_SIZE2                                      28
+
+/**
+ * Content formats.
+ */
+#define COAP_CONTENT_FORMAT_TEXT_PLAIN                          0
+#define COAP_CONTENT_FORMAT_APPLICATION_OCTET_STREAM           42
+#define COAP_CONTENT_FORMAT_APPLICATION_JSON                   50
+#define COAP_CONTENT_FORMAT_APPLICATION_CBOR                   60
+
+/**
+ * The largest token.
+ */
+#define COAP_TOKEN_SIZE_MAX                                     8
+
+/**
+ * Block option value of given block number, more flag and size
+ * exponent, see RFC 7959.
+ */
+#define COAP_BLOCK(num, more, szx)                              \
+    (((uint32_t)(num) << 4) | ((more) << 3) | (szx))
+#define COAP_BLOCK_NUM(block)                         ((block) >> 4)
+#define COAP_BLOCK_MORE(block)                  (((block) >> 3) & 1)
+#define COAP_BLOCK_SZX(block)                         ((block) & 7)
+#define COAP_BLOCK_SIZE(szx)                         (16 << (szx))
+
+struct coap_option_t {
+    uint16_t number;
+    uint16_t size;
+    const uint8_t *value_p;
+};
+
+/**
+ * A decoded message. The option values and the payload point into
+ * the decoded buffer.
+ */
+struct coap_message_t {
+    int type;
+    int code;
+    uint16_t message_id;
+    uint8_t token[COAP_TOKEN_SIZE_MAX];
+    size_t token_size;
+    struct {
+        struct coap_option_t buf[CONFIG_COAP_OPTIONS_MAX];
+        size_t length;
+    } options;
+    const uint8_t *payload_p;
+    size_t payload_size;
+};
+
+/**
+ * Encodes a message into a buffer. Options must be added in
+ * ascending option number order, followed by the payload.
+ */
+struct coap_encoder_t {
+    uint8_t *buf_p;
+    size_t size;
+    size_t pos;
+    int option_number;
+    int overflow;
+};
+
+/**
+ * Decode given message.
+ *
+ * @param[out] self_p Decoded message.
+ * @param[in] buf_p Encoded message.
+ * @param[in] size Size of the encoded message.
+ *
+ * @return zero(0) or negative error code.
+ */
+int coap_message_decode(struct coap_message_t *self_p,
+                        const uint8_t *buf_p,
+                        size_t size);
+
+/**
+ * Get the value of first option with given number as an unsigned
+ * integer.
+ *
+ * @param[in] self_p Decoded message.
+ * @param[in] number Option number.
+ * @param[out] value_p Option value.
+ *
+ * @return zero(0) or -ENOENT if the option is missing.
+ */
+int coap_message_get_uint_option(const struct coap_message_t *self_p,
+                                 int number,
+                                 uint32_t *value_p);
+
+/**
+ * Get the request path by joining all Uri-Path options with ``/``,
+ * for example ``/sensors/temp``. The path is ``/`` if there are no
+ * Uri-Path options.
+ *
+ * @param[in] self_p Decoded message.
+ * @param[out] buf_p Null terminated path.
+ * @param[in] size Size of the path buffer.
+ *
+ * @return Path length or negative error code.
+ */
+ssize_t coap_message_get_path(const struct coap_message_t *self_p,
+                              char *buf_p,
+                              size_t size);
+
+/**
+ * Initialize given encoder and encode the message header and token.
+ *
+ * @param[out] self_p Encoder to initialize.
+ * @param[in] buf_p Buffer to encode the message into.
+ * @param[in] size Size of the buffer.
+ * @param[in] type Message type, one of ``COAP_TYPE_*``.
+ * @param[in] code Message code, one of ``COAP_CODE_*``.
+ * @param[in] message_id Message id.
+ * @param[in] token_p Token.
+ * @param[in] token_size Token size, at most ``COAP_TOKEN_SIZE_MAX``.
+ *
+ * @return zero(0) or negative error code.
+ */
+int coap_encoder_init(struct coap_encoder_t *self_p,
+                      uint8_t *buf_p,
+                      size_t size,
+                      int type,
+                      int code,
+                      uint16_t message_id,
+                      const uint8_t *token_p,
+                      size_t token_size);
+
+/**
+ * Encode given option.
+ *
+ * @param[in] self_p Encoder.
+ * @param[in] number Option number, not smaller than the previous
+ *                   option number.
+ * @param[in] value_p Option value.
+ * @param[in] size Option value size.
+ *
+ * @return zero(0) or negative error code.
+ */
+int coap_encoder_add_option(struct coap_encoder_t *self_p,
+                            int number,
+                            const void *value_p,
+                            size_t size);
+
+/**
+ * Encode given option with an unsigned integer value, using as few
+ * bytes as possible.
+ *
+ * @param[in] self_p Encoder.
+ * @param[in] number Option number.
+ * @param[in] value Option value.
+ *
+ * @return zero(0) or negative error code.
+ */
+int coap_encoder_add_uint_option(struct coap_encoder_t *self_p,
+                                 int number,
+                                 uint32_t value);
+
+/**
+ * Encode given path as one Uri-Path option per ``/`` separated
+ * segment.
+ *
+ * @param[in] self_p Encoder.
+ * @param[in] path_p Path, for example ``/sensors/temp``.
+ *
+ * @return zero(0) or negative error code.
+ */
+int coap_encoder_add_path(struct coap_encoder_t *self_p,
+                          const char *path_p);
+
+/**
+ * Encode given payload. No options can be added after the payload.
+ *
+ * @param[in] self_p Encoder.
+ * @param[in] buf_p Payload.
+ * @param[in] size Payload size. Nothing is encoded if zero.
+ *
+ * @return zero(0) or negative error code.
+ */
+int coap_encoder_add_payload(struct coap_encoder_t *self_p,
+                             const void *buf_p,
+                             size_t size);
+
+/**
+ * Get the size of the encoded message.
+ *
+ * @param[in] self_p Encoder.
+ *
+ * @return Message size or -ENOMEM if the message did not fit in the
+ *         buffer.
+ */
+ssize_t coap_encoder_get_size(struct coap_encoder_t *self_p);
+
+#endif
@@ -0,0 +1,542 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2014-2018, Erik Moqvist
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use, copy,
+ * modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ * This file is part of the Simba project.
+ */
+
+#include "simba.h"
+
+/* Observe option values in a request. */
+#define OBSERVE_REGISTER                                        0
+#define OBSERVE_DEREGISTER                                      1
+
+static int is_token(const struct coap_message_t *message_p,
+                    const uint8_t *token_p)
+{
+    return ((message_p->token_size == 2)
+            && (message_p->token[0] == token_p[0])
+            && (message_p->token[1] == token_p[1]));
+}
+
+static void next_token(struct coap_client_t *self_p, uint8_t *token_p)
+{
+    token_p[0] = (self_p->token >> 8);
+    token_p[1] = self_p->token;
+    self_p->token++;
+}
+
+static ssize_t send_message(struct coap_client_t *self_p,
+                            const uint8_t *buf_p,
+                            size_t size)
+{
+    return (socket_sendto(&self_p->socket,
+                          buf_p,
+                          size,
+                          0,
+                          &self_p->remote_addr));
+}
+
+/**
+ * Send an empty message, that is, an acknowledgement or a reset.
+ */
+static void send_empty(struct coap_client_t *self_p,
+                       int type,
+                       uint16_t message_id)
+{
+    struct coap_encoder_t encoder;
+    uint8_t buf[4];
+
+    coap_encoder_init(&encoder,
+                      &buf[0],
+                      sizeof(buf),
+                      type,
+                      COAP_CODE_EMPTY,
+                      message_id,
+                      NULL,
+                      0);
+    send_message(self_p, &buf[0], sizeof(buf));
+}
+
+/**
+ * Encode a request in the output buffer.
+ *
+ * @return zero(0) or negative error code.
+ */
+static int encode_request(struct coap_client_t *self_p,
+                          int type,
+                          int code,
+                          uint16_t message_id,
+                          const uint8_t *token_p,
+                          const char *path_p,
+                          int observe,
+                          int32_t block,
+                          const void *payload_p,
+                          size_t payload_size)
+{
+    struct coap_encoder_t encoder;
+    ssize_t res;
+
+    coap_encoder_init(&encoder,
+                      &self_p->output.buf[0],
+                      sizeof(self_p->output.buf),
+                      type,
+                      code,
+                      message_id,
+                      token_p,
+                      2);
+
+    if (observe >= 0) {
+        coap_encoder_add_uint_option(&encoder, COAP_OPTION_OBSERVE, observe);
+    }
+
+    coap_encoder_add_path(&encoder, path_p);
+
+    if (block >= 0) {
+        coap_encoder_add_uint_option(&encoder, COAP_OPTION_BLOCK2, block);
+    }
+
+    coap_encoder_add_payload(&encoder, payload_p, payload_size);
+    res = coap_encoder_get_size(&encoder);
+
+    if (res < 0) {
+        return (res);
+    }
+
+    self_p->output.size = res;
+
+    return (0);
+}
+
+/**
+ * Send the request in the output buffer and wait for its response. A
+ * confirmable request is retransmitted until it is acknowledged,
+ * while a separate response is waited for without retransmissions.
+ */
+static int exchange(struct coap_client_t *self_p,
+                    int type,
+                    uint16_t message_id,
+                    const uint8_t *token_p,
+                    struct coap_message_t *response_p)
+{
+    struct inet_addr_t remote_addr;
+    struct time_t timeout;
+    int timeout_ms;
+    int retransmissions;
+    int acknowledged;
+    ssize_t size;
+
+    timeout_ms = CONFIG_COAP_CLIENT_ACK_TIMEOUT_MS;
+    retransmissions = 0;
+    acknowledged = (type != COAP_TYPE_CONFIRMABLE);
+    size = send_message(self_p,
+                        &self_p->output.buf[0],
+                        self_p->output.size);
+
+    if (size < 0) {
+        return (size);
+    }
+
+    while (1) {
+        timeout.seconds = (timeout_ms / 1000);
+        timeout.nanoseconds = ((timeout_ms % 1000) * 1000000L);
+        socket_set_timeout(&self_p->socket, SOCKET_TIMEOUT_RECV, &timeout);
+        size = socket_recvfrom(&self_p->socket,
+                               &self_p->input.buf[0],
+                               sizeof(self_p->input.buf),
+                               0,
+                               &remote_addr);
+
+        if (size == -ETIMEDOUT) {
+            if (retransmissions == CONFIG_COAP_CLIENT_MAX_RETRANSMIT) {
+                return (-ETIMEDOUT);
+            }
+
+            retransmissions++;
+            timeout_ms *= 2;
+
+            if (!acknowledged) {
+                send_message(self_p,
+                             &self_p->output.buf[0],
+                             self_p->output.size);
+            }
+
+            continue;
+        }
+
+        if (size < 0) {
+            return (size);
+        }
+
+        if (coap_message_decode(response_p,
+                                &self_p->input.buf[0],
+                                size) != 0) {
+            continue;
+        }
+
+        switch (response_p->type) {
+
+        case COAP_TYPE_ACKNOWLEDGEMENT:
+            if (response_p->message_id != message_id) {
+                continue;
+            }
+
+            /* An empty acknowledgement means that a separate response
+               follows. */
+            if (response_p->code == COAP_CODE_EMPTY) {
+                acknowledged = 1;
+                continue;
+            }
+
+            if (!is_token(response_p, token_p)) {
+                continue;
+            }
+
+            return (0);
+
+        case COAP_TYPE_RESET:
+            if (response_p->message_id == message_id) {
+                return (-ECONNRESET);
+            }
+
+            continue;
+
+        default:
+            if (!is_token(response_p, token_p)
+                || (COAP_CODE_CLASS(response_p->code) == 0)) {
+                if (response_p->type == COAP_TYPE_CONFIRMABLE) {
+                    send_empty(self_p,
+                               COAP_TYPE_RESET,
+                               response_p->message_id);
+                }
+
+                continue;
+            }
+
+            if (response_p->type == COAP_TYPE_CONFIRMABLE) {
+                send_empty(self_p,
+                           COAP_TYPE_ACKNOWLEDGEMENT,
+                           response_p->message_id);
+            }
+
+            return (0);
+        }
+    }
+}
+
+/**
+ * Send given request and wait for the response, fetching all blocks
+ * of a response split into blocks. The response payload is discarded
+ * if buf_p is NULL.
+ */
+static ssize_t request(struct coap_client_t *self_p,
+                       int type,
+                       int code,
+                       const char *path_p,
+                       const uint8_t *token_p,
+                       int observe,
+                       const void *payload_p,
+                       size_t payload_size,
+                       void *buf_p,
+                       size_t size,
+                       int *code_p,
+                       int *observed_p)
+{
+    struct coap_message_t response;
+    uint16_t message_id;
+    uint32_t block;
+    uint32_t value;
+    int32_t next_block;
+    size_t pos;
+    int res;
+
+    pos = 0;
+    next_block = -1;
+
+    while (1) {
+        message_id = self_p->message_id++;
+        res = encode_request(self_p,
+                             type,
+                             code,
+                             message_id,
+                             token_p,
+                             path_p,
+                             observe,
+                             next_block,
+                             payload_p,
+                             payload_size);
+
+        if (res != 0) {
+            return (res);
+        }
+
+        res = exchange(self_p, type, message_id, token_p, &response);
+
+        if (res != 0) {
+            return (res);
+        }
+
+        *code_p = response.code;
+
+        if (observed_p != NULL) {
+            *observed_p = (coap_message_get_uint_option(&response,
+                                                        COAP_OPTION_OBSERVE,
+                                                        &value) == 0);
+            observed_p = NULL;
+        }
+
+        if (buf_p != NULL) {
+            if (pos + response.payload_size > size) {
+                return (-EMSGSIZE);
+            }
+
+            memcpy(&((uint8_t *)buf_p)[pos],
+                   response.payload_p,
+                   response.payload_size);
+        }
+
+        pos += response.payload_size;
+
+        if (coap_message_get_uint_option(&response,
+                                         COAP_OPTION_BLOCK2,
+                                         &block) != 0) {
+            break;
+        }
+
+        if (!COAP_BLOCK_MORE(block)) {
+            break;
+        }
+
+        /* Ask for the next block with the block size chosen by the
+           server. Only the first request registers an observer and
+           carries the payload. */
+        next_block = COAP_BLOCK(COAP_BLOCK_NUM(block) + 1,
+                                0,
+                                COAP_BLOCK_SZX(block));
+        observe = -1;
+        payload_p = NULL;
+        payload_size = 0;
+    }
+
+    return (pos);
+}
+
+int coap_client_init(struct coap_client_t *self_p,
+                     const struct inet_addr_t *remote_addr_p)
+{
+    ASSERTN(self_p != NULL, EINVAL);
+    ASSERTN(remote_addr_p != NULL, EINVAL);
+
+    self_p->remote_addr = *remote_addr_p;
+    self_p->message_id = 0;
+    self_p->token = 0;
+    self_p->observe.active = 0;
+    self_p->output.size = 0;
+
+    return (0);
+}
+
+int coap_client_start(struct coap_client_t *self_p)
+{
+    ASSERTN(self_p != NULL, EINVAL);
+
+    return (socket_open_udp(&self_p->socket));
+}
+
+int coap_client_stop(struct coap_client_t *self_p)
+{
+    ASSERTN(self_p != NULL, EINVAL);
+
+    self_p->observe.active = 0;
+
+    return (socket_close(&self_p->socket));
+}
+
+ssize_t coap_client_request(struct coap_client_t *self_p,
+                            int type,
+                            int code,
+                            const char *path_p,
+                            const void *payload_p,
+                            size_t payload_size,
+                            void *buf_p,
+                            size_t size,
+                            int *code_p)
+{
+    ASSERTN(self_p != NULL, EINVAL);
+    ASSERTN(path_p != NULL, EINVAL);
+    ASSERTN((payload_p != NULL) || (payload_size == 0), EINVAL);
+    ASSERTN(buf_p != NULL, EINVAL);
+    ASSERTN(code_p != NULL, EINVAL);
+
+    uint8_t token[2];
+
+    next_token(self_p, &token[0]);
+
+    return (request(self_p,
+                    type,
+                    code,
+                    path_p,
+                    &token[0],
+                    -1,
+                    payload_p,
+                    payload_size,
+                    buf_p,
+                    size,
+                    code_p,
+                    NULL));
+}
+
+ssize_t coap_client_observe(struct coap_client_t *self_p,
+                            const char *path_p,
+                            void *buf_p,
+                            size_t size,
+                            int *code_p)
+{
+    ASSERTN(self_p != NULL, EINVAL);
+    ASSERTN(path_p != NULL, EINVAL);
+    ASSERTN(buf_p != NULL, EINVAL);
+    ASSERTN(code_p != NULL, EINVAL);
+
+    next_token(self_p, &self_p->observe.token[0]);
+    self_p->observe.active = 0;
+
+    return (request(self_p,
+                    COAP_TYPE_CONFIRMABLE,
+                    COAP_CODE_GET,
+                    path_p,
+                    &self_p->observe.token[0],
+                    OBSERVE_REGISTER,
+                    NULL,
+                    0,
+                    buf_p,
+                    size,
+                    code_p,
+                    &self_p->observe.active));
+}
+
+ssize_t coap_client_read_notification(struct coap_client_t *self_p,
+                                      void *buf_p,
+                                      size_t size,
+                                      int *code_p)
+{
+    ASSERTN(self_p != NULL, EINVAL);
+    ASSERTN(buf_p != NULL, EINVAL);
+    ASSERTN(code_p != NULL, EINVAL);
+
+    struct coap_message_t message;
+    struct inet_addr_t remote_addr;
+    uint32_t value;
+    ssize_t res;
+
+    if (!self_p->observe.active) {
+        return (-ENOENT);
+    }
+
+    while (1) {
+        res = socket_recvfrom(&self_p->socket,
+                              &self_p->input.buf[0],
+                              sizeof(self_p->input.buf),
+                              0,
+                              &remote_addr);
+
+        if (res < 0) {
+            return (res);
+        }
+
+        if (coap_message_decode(&message, &self_p->input.buf[0], res) != 0) {
+            continue;
+        }
+
+        if ((message.type == COAP_TYPE_ACKNOWLEDGEMENT)
+            || (message.type == COAP_TYPE_RESET)) {
+            continue;
+        }
+
+        /* Reject confirmable messages that are not notifications. */
+        if (!is_token(&message, &self_p->observe.token[0])
+            || (COAP_CODE_CLASS(message.code) == 0)) {
+            if (message.type == COAP_TYPE_CONFIRMABLE) {
+                send_empty(self_p, COAP_TYPE_RESET, message.message_id);
+            }
+
+            continue;
+        }
+
+        if (message.type == COAP_TYPE_CONFIRMABLE) {
+            send_empty(self_p,
+                       COAP_TYPE_ACKNOWLEDGEMENT,
+                       message.message_id);
+        }
+
+        /* A notification without the observe option, or with an
+           error code, ends the observation. */
+        if ((COAP_CODE_CLASS(message.code) != 2)
+            || (coap_message_get_uint_option(&message,
+                                             COAP_OPTION_OBSERVE,
+                                             &value) != 0)) {
+            self_p->observe.active = 0;
+        }
+
+        *code_p = message.code;
+
+        if (message.payload_size > size) {
+            return (-EMSGSIZE);
+        }
+
+        memcpy(buf_p, message.payload_p, message.payload_size);
+
+        return (message.payload_size);
+    }
+}
+
+int coap_client_cancel_observe(struct coap_client_t *self_p,
+                               const char *path_p)
+{
+    ASSERTN(self_p != NULL, EINVAL);
+    ASSERTN(path_p != NULL, EINVAL);
+
+    ssize_t res;
+    int code;
+
+    if (!self_p->observe.active) {
+        return (-ENOENT);
+    }
+
+    self_p->observe.active = 0;
+
+    res = request(self_p,
+                  COAP_TYPE_CONFIRMABLE,
+                  COAP_CODE_GET,
+                  path_p,
+                  &self_p->observe.token[0],
+                  OBSERVE_DEREGISTER,
+                  NULL,
+                  0,
+                  NULL,
+                  0,
+                  &code,
+                  NULL);
+
+    return (res < 0 ? res : 0);
+}
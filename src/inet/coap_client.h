@@ -0,0 +1,170 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2014-2018, Erik Moqvist
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use, copy,
+ * modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ * This file is part of the Simba project.
+ */
+
+#ifndef __INET_COAP_CLIENT_H__
+#define __INET_COAP_CLIENT_H__
+
+#include "simba.h"
+
+struct coap_client_t {
+    struct inet_addr_t remote_addr;
+    struct socket_t socket;
+    uint16_t message_id;
+    uint16_t token;
+    /* Token of the observed resource. */
+    struct {
+        int active;
+        uint8_t token[2];
+    } observe;
+    struct {
+        uint8_t buf[CONFIG_COAP_CLIENT_MESSAGE_SIZE_MAX];
+        size_t size;
+    } output;
+    struct {
+        uint8_t buf[CONFIG_COAP_CLIENT_MESSAGE_SIZE_MAX];
+    } input;
+};
+
+/**
+ * Initialize given CoAP client.
+ *
+ * @param[out] self_p CoAP client to initialize.
+ * @param[in] remote_addr_p Address and port of the server.
+ *
+ * @return zero(0) or negative error code.
+ */
+int coap_client_init(struct coap_client_t *self_p,
+                     const struct inet_addr_t *remote_addr_p);
+
+/**
+ * Open the client socket.
+ *
+ * @param[in] self_p CoAP client.
+ *
+ * @return zero(0) or negative error code.
+ */
+int coap_client_start(struct coap_client_t *self_p);
+
+/**
+ * Close the client socket.
+ *
+ * @param[in] self_p CoAP client.
+ *
+ * @return zero(0) or negative error code.
+ */
+int coap_client_stop(struct coap_client_t *self_p);
+
+/**
+ * Send a request to the server and wait for the response.
+ *
+ * Confirmable requests are retransmitted with exponential back-off,
+ * starting after `CONFIG_COAP_CLIENT_ACK_TIMEOUT_MS` milliseconds, at
+ * most `CONFIG_COAP_CLIENT_MAX_RETRANSMIT` times. Both piggybacked
+ * and separate responses are accepted. A response split into blocks
+ * by the server is fetched block by block and reassembled in given
+ * buffer.
+ *
+ * @param[in] self_p CoAP client.
+ * @param[in] type ``COAP_TYPE_CONFIRMABLE`` or
+ *                 ``COAP_TYPE_NON_CONFIRMABLE``.
+ * @param[in] code Request method, one of ``COAP_CODE_GET``,
+ *                 ``COAP_CODE_POST``, ``COAP_CODE_PUT`` and
+ *                 ``COAP_CODE_DELETE``.
+ * @param[in] path_p Request path.
+ * @param[in] payload_p Request payload, or NULL.
+ * @param[in] payload_size Request payload size.
+ * @param[out] buf_p Response payload.
+ * @param[in] size Size of the response payload buffer.
+ * @param[out] code_p Response code.
+ *
+ * @return Response payload size or negative error code. -ETIMEDOUT
+ *         if the server did not respond, -ECONNRESET if the server
+ *         rejected the request and -EMSGSIZE if the response did not
+ *         fit in given buffer.
+ */
+ssize_t coap_client_request(struct coap_client_t *self_p,
+                            int type,
+                            int code,
+                            const char *path_p,
+                            const void *payload_p,
+                            size_t payload_size,
+                            void *buf_p,
+                            size_t size,
+                            int *code_p);
+
+/**
+ * Observe given resource, see RFC 7641. This is a confirmable GET
+ * request that asks the server to send a notification each time the
+ * resource changes. Read the notifications with
+ * `coap_client_read_notification()`. Only one resource can be
+ * observed at a time.
+ *
+ * @param[in] self_p CoAP client.
+ * @param[in] path_p Path of the resource to observe.
+ * @param[out] buf_p Current resource representation.
+ * @param[in] size Size of the buffer.
+ * @param[out] code_p Response code.
+ *
+ * @return Response payload size or negative error code.
+ */
+ssize_t coap_client_observe(struct coap_client_t *self_p,
+                            const char *path_p,
+                            void *buf_p,
+                            size_t size,
+                            int *code_p);
+
+/**
+ * Wait for the next notification of the observed resource. A
+ * notification larger than a block only contains the first block.
+ * Use the socket receive timeout to limit the wait.
+ *
+ * @param[in] self_p CoAP client.
+ * @param[out] buf_p Notification payload.
+ * @param[in] size Size of the buffer.
+ * @param[out] code_p Notification code. Anything but 2.05 Content
+ *                    ends the observation.
+ *
+ * @return Notification payload size or negative error code.
+ */
+ssize_t coap_client_read_notification(struct coap_client_t *self_p,
+                                      void *buf_p,
+                                      size_t size,
+                                      int *code_p);
+
+/**
+ * Stop observing given resource.
+ *
+ * @param[in] self_p CoAP client.
+ * @param[in] path_p Path of the observed resource.
+ *
+ * @return zero(0) or negative error code.
+ */
+int coap_client_cancel_observe(struct coap_client_t *self_p,
+                               const char *path_p);
+
+#endif
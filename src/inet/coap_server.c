@@ -0,0 +1,702 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2014-2018, Erik Moqvist
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use, copy,
+ * modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ * This file is part of the Simba project.
+ */
+
+#include "simba.h"
+
+/* Observe option values in a request. */
+#define OBSERVE_REGISTER                                        0
+#define OBSERVE_DEREGISTER                                      1
+
+/* The observe sequence number is 24 bits. */
+#define OBSERVE_SEQUENCE_MASK                            0xffffff
+
+/**
+ * Response message fields that are not in the route response.
+ */
+struct response_header_t {
+    int type;
+    uint16_t message_id;
+    const uint8_t *token_p;
+    size_t token_size;
+    /* Observe sequence number, or -1 for none. */
+    int32_t observe;
+    /* Requested block number and size exponent. */
+    uint32_t block_num;
+    int block_szx;
+};
+
+static int is_same_addr(const struct inet_addr_t *left_p,
+                        const struct inet_addr_t *right_p)
+{
+    return ((left_p->ip.number == right_p->ip.number)
+            && (left_p->port == right_p->port));
+}
+
+static int route_has_method(const struct coap_server_route_t *route_p,
+                            int code)
+{
+    if (route_p->methods == 0) {
+        return (1);
+    }
+
+    return ((route_p->methods & (1 << code)) != 0);
+}
+
+static int route_match(const struct coap_server_route_t *route_p,
+                       const char *path_p)
+{
+    size_t length;
+
+    length = strlen(route_p->path_p);
+
+    if ((length > 0) && (route_p->path_p[length - 1] == '/')) {
+        return (strncmp(route_p->path_p, path_p, length) == 0);
+    }
+
+    return (strcmp(route_p->path_p, path_p) == 0);
+}
+
+/**
+ * Find the route of given path and method. Sets code to 4.04 Not
+ * Found or 4.05 Method Not Allowed if there is none.
+ */
+static const struct coap_server_route_t *find_route(
+    struct coap_server_t *self_p,
+    const char *path_p,
+    int method,
+    int *code_p)
+{
+    const struct coap_server_route_t *route_p;
+
+    *code_p = COAP_CODE_NOT_FOUND;
+    route_p = self_p->routes_p;
+
+    while (route_p->path_p != NULL) {
+        if (route_match(route_p, path_p)) {
+            if (route_has_method(route_p, method)) {
+                return (route_p);
+            }
+
+            *code_p = COAP_CODE_METHOD_NOT_ALLOWED;
+        }
+
+        route_p++;
+    }
+
+    return (NULL);
+}
+
+static int default_code(int method)
+{
+    switch (method) {
+
+    case COAP_CODE_POST:
+    case COAP_CODE_PUT:
+        return (COAP_CODE_CHANGED);
+
+    case COAP_CODE_DELETE:
+        return (COAP_CODE_DELETED);
+
+    default:
+        return (COAP_CODE_CONTENT);
+    }
+}
+
+static ssize_t send_message(struct coap_server_t *self_p,
+                            const uint8_t *buf_p,
+                            size_t size,
+                            const struct inet_addr_t *remote_addr_p)
+{
+    return (socket_sendto(&self_p->socket,
+                          buf_p,
+                          size,
+                          0,
+                          remote_addr_p));
+}
+
+/**
+ * Send an empty message, that is, an acknowledgement or a reset.
+ */
+static int send_empty(struct coap_server_t *self_p,
+                      int type,
+                      uint16_t message_id,
+                      const struct inet_addr_t *remote_addr_p)
+{
+    struct coap_encoder_t encoder;
+    uint8_t buf[4];
+
+    coap_encoder_init(&encoder,
+                      &buf[0],
+                      sizeof(buf),
+                      type,
+                      COAP_CODE_EMPTY,
+                      message_id,
+                      NULL,
+                      0);
+
+    return (send_message(self_p, &buf[0], sizeof(buf), remote_addr_p));
+}
+
+/**
+ * Encode given response to the output buffer and send it. The
+ * response payload is split into blocks if it does not fit in a
+ * single block of given size, see RFC 7959.
+ */
+static int send_response(struct coap_server_t *self_p,
+                         const struct response_header_t *header_p,
+                         const struct coap_server_response_t *response_p,
+                         const struct inet_addr_t *remote_addr_p)
+{
+    struct coap_encoder_t encoder;
+    size_t block_size;
+    size_t offset;
+    size_t size;
+    int is_block;
+    int more;
+    ssize_t res;
+
+    block_size = COAP_BLOCK_SIZE(header_p->block_szx);
+    offset = (header_p->block_num * block_size);
+    size = response_p->size;
+    is_block = ((size > block_size) || (header_p->block_num > 0));
+    more = 0;
+
+    if (is_block) {
+        if (offset >= size) {
+            size = 0;
+        } else {
+            size = MIN(size - offset, block_size);
+            more = (offset + size < response_p->size);
+        }
+    } else {
+        offset = 0;
+    }
+
+    coap_encoder_init(&encoder,
+                      &self_p->output.buf[0],
+                      sizeof(self_p->output.buf),
+                      header_p->type,
+                      response_p->code,
+                      header_p->message_id,
+                      header_p->token_p,
+                      header_p->token_size);
+
+    if (header_p->observe >= 0) {
+        coap_encoder_add_uint_option(&encoder,
+                                     COAP_OPTION_OBSERVE,
+                                     header_p->observe);
+    }
+
+    if (response_p->content_format >= 0) {
+        coap_encoder_add_uint_option(&encoder,
+                                     COAP_OPTION_CONTENT_FORMAT,
+                                     response_p->content_format);
+    }
+
+    if (is_block) {
+        coap_encoder_add_uint_option(&encoder,
+                                     COAP_OPTION_BLOCK2,
+                                     COAP_BLOCK(header_p->block_num,
+                                                more,
+                                                header_p->block_szx));
+
+        /* Tell the client the total size in the first block. */
+        if (header_p->block_num == 0) {
+            coap_encoder_add_uint_option(&encoder,
+                                         COAP_OPTION_SIZE2,
+                                         response_p->size);
+        }
+    }
+
+    coap_encoder_add_payload(&encoder, &response_p->buf_p[offset], size);
+    res = coap_encoder_get_size(&encoder);
+    self_p->output.size = 0;
+
+    if (res < 0) {
+        return (res);
+    }
+
+    if (header_p->type == COAP_TYPE_ACKNOWLEDGEMENT) {
+        self_p->output.size = res;
+        self_p->output.remote_addr = *remote_addr_p;
+        self_p->output.message_id = header_p->message_id;
+    }
+
+    res = send_message(self_p, &self_p->output.buf[0], res, remote_addr_p);
+
+    return (res < 0 ? res : 0);
+}
+
+static struct coap_server_observer_t *find_observer(
+    struct coap_server_t *self_p,
+    const struct inet_addr_t *remote_addr_p,
+    const uint8_t *token_p,
+    size_t token_size)
+{
+    struct coap_server_observer_t *observer_p;
+    int i;
+
+    for (i = 0; i < membersof(self_p->observers); i++) {
+        observer_p = &self_p->observers[i];
+
+        if (observer_p->route_p == NULL) {
+            continue;
+        }
+
+        if (is_same_addr(&observer_p->remote_addr, remote_addr_p)
+            && (observer_p->token_size == token_size)
+            && (memcmp(&observer_p->token[0], token_p, token_size) == 0)) {
+            return (observer_p);
+        }
+    }
+
+    return (NULL);
+}
+
+/**
+ * Add given client as an observer of given route. An existing
+ * registration with the same token is replaced.
+ *
+ * @return zero(0) or negative error code.
+ */
+static int add_observer(struct coap_server_t *self_p,
+                        const struct coap_server_route_t *route_p,
+                        const struct coap_server_request_t *request_p)
+{
+    const struct coap_message_t *message_p;
+    struct coap_server_observer_t *observer_p;
+    int i;
+
+    message_p = request_p->message_p;
+
+    if (strlen(request_p->path_p) >= CONFIG_COAP_SERVER_PATH_MAX) {
+        return (-ENOMEM);
+    }
+
+    observer_p = find_observer(self_p,
+                               &request_p->remote_addr,
+                               &message_p->token[0],
+                               message_p->token_size);
+
+    if (observer_p == NULL) {
+        for (i = 0; i < membersof(self_p->observers); i++) {
+            if (self_p->observers[i].route_p == NULL) {
+                observer_p = &self_p->observers[i];
+                break;
+            }
+        }
+    }
+
+    if (observer_p == NULL) {
+        return (-ENOMEM);
+    }
+
+    observer_p->route_p = route_p;
+    observer_p->remote_addr = request_p->remote_addr;
+    memcpy(&observer_p->token[0],
+           &message_p->token[0],
+           message_p->token_size);
+    observer_p->token_size = message_p->token_size;
+    observer_p->message_id = message_p->message_id;
+    strcpy(&observer_p->path[0], request_p->path_p);
+
+    return (0);
+}
+
+static void remove_observer(struct coap_server_t *self_p,
+                            const struct inet_addr_t *remote_addr_p,
+                            const uint8_t *token_p,
+                            size_t token_size)
+{
+    struct coap_server_observer_t *observer_p;
+
+    observer_p = find_observer(self_p, remote_addr_p, token_p, token_size);
+
+    if (observer_p != NULL) {
+        observer_p->route_p = NULL;
+    }
+}
+
+/**
+ * A reset in response to a notification cancels the observation.
+ */
+static void handle_reset(struct coap_server_t *self_p,
+                         const struct coap_message_t *message_p,
+                         const struct inet_addr_t *remote_addr_p)
+{
+    struct coap_server_observer_t *observer_p;
+    int i;
+
+    for (i = 0; i < membersof(self_p->observers); i++) {
+        observer_p = &self_p->observers[i];
+
+        if ((observer_p->route_p != NULL)
+            && (observer_p->message_id == message_p->message_id)
+            && is_same_addr(&observer_p->remote_addr, remote_addr_p)) {
+            observer_p->route_p = NULL;
+        }
+    }
+}
+
+static int handle_request(struct coap_server_t *self_p,
+                          const struct coap_message_t *message_p,
+                          const struct inet_addr_t *remote_addr_p)
+{
+    const struct coap_server_route_t *route_p;
+    struct coap_server_request_t request;
+    struct coap_server_response_t response;
+    struct response_header_t header;
+    char path[CONFIG_COAP_SERVER_PATH_MAX];
+    uint32_t observe;
+    uint32_t block;
+    int code;
+
+    /* Piggyback the response on the acknowledgement of confirmable
+       requests. */
+    if (message_p->type == COAP_TYPE_CONFIRMABLE) {
+        header.type = COAP_TYPE_ACKNOWLEDGEMENT;
+        header.message_id = message_p->message_id;
+    } else {
+        header.type = COAP_TYPE_NON_CONFIRMABLE;
+        header.message_id = self_p->message_id++;
+    }
+
+    header.token_p = &message_p->token[0];
+    header.token_size = message_p->token_size;
+    header.observe = -1;
+    header.block_num = 0;
+    header.block_szx = CONFIG_COAP_SERVER_BLOCK_SZX;
+
+    if (coap_message_get_uint_option(message_p,
+                                     COAP_OPTION_BLOCK2,
+                                     &block) == 0) {
+        header.block_num = COAP_BLOCK_NUM(block);
+        header.block_szx = COAP_BLOCK_SZX(block);
+
+        /* Respond with smaller blocks than asked for if needed,
+           starting at the same offset. */
+        if (header.block_szx > CONFIG_COAP_SERVER_BLOCK_SZX) {
+            header.block_num <<= (header.block_szx
+                                  - CONFIG_COAP_SERVER_BLOCK_SZX);
+            header.block_szx = CONFIG_COAP_SERVER_BLOCK_SZX;
+        }
+    }
+
+    response.code = default_code(message_p->code);
+    response.content_format = -1;
+    response.buf_p = &self_p->payload[0];
+    response.size = 0;
+
+    if (coap_message_get_path(message_p, &path[0], sizeof(path)) < 0) {
+        response.code = COAP_CODE_BAD_REQUEST;
+
+        return (send_response(self_p, &header, &response, remote_addr_p));
+    }
+
+    route_p = find_route(self_p, &path[0], message_p->code, &code);
+
+    if (route_p == NULL) {
+        response.code = code;
+
+        return (send_response(self_p, &header, &response, remote_addr_p));
+    }
+
+    request.remote_addr = *remote_addr_p;
+    request.message_p = message_p;
+    request.path_p = &path[0];
+
+    if (route_p->callback(self_p, &request, &response) != 0) {
+        response.code = COAP_CODE_INTERNAL_SERVER_ERROR;
+        response.content_format = -1;
+        response.size = 0;
+    }
+
+    if (response.size > sizeof(self_p->payload)) {
+        response.size = sizeof(self_p->payload);
+    }
+
+    /* Register or deregister an observer. Only GET requests with a
+       successful response can be observed. */
+    if ((message_p->code == COAP_CODE_GET)
+        && (coap_message_get_uint_option(message_p,
+                                         COAP_OPTION_OBSERVE,
+                                         &observe) == 0)) {
+        if ((observe == OBSERVE_REGISTER)
+            && (COAP_CODE_CLASS(response.code) == 2)
+            && (header.block_num == 0)) {
+            if (add_observer(self_p, route_p, &request) == 0) {
+                header.observe = self_p->observe_sequence;
+            }
+        } else if (observe == OBSERVE_DEREGISTER) {
+            remove_observer(self_p,
+                            remote_addr_p,
+                            &message_p->token[0],
+                            message_p->token_size);
+        }
+    }
+
+    return (send_response(self_p, &header, &response, remote_addr_p));
+}
+
+static int handle_message(struct coap_server_t *self_p,
+                          const uint8_t *buf_p,
+                          size_t size,
+                          const struct inet_addr_t *remote_addr_p)
+{
+    struct coap_message_t message;
+    int res;
+
+    res = coap_message_decode(&message, buf_p, size);
+
+    if (res != 0) {
+        /* Reject malformed confirmable messages. */
+        if ((size >= 4)
+            && (((buf_p[0] >> 4) & 0x3) == COAP_TYPE_CONFIRMABLE)) {
+            send_empty(self_p,
+                       COAP_TYPE_RESET,
+                       ((buf_p[2] << 8) | buf_p[3]),
+                       remote_addr_p);
+        }
+
+        return (res);
+    }
+
+    switch (message.type) {
+
+    case COAP_TYPE_ACKNOWLEDGEMENT:
+        return (0);
+
+    case COAP_TYPE_RESET:
+        handle_reset(self_p, &message, remote_addr_p);
+
+        return (0);
+
+    default:
+        break;
+    }
+
+    /* Empty confirmable messages are pings, answered with a
+       reset. Responses are not expected by a server. */
+    if ((COAP_CODE_CLASS(message.code) != 0)
+        || (message.code == COAP_CODE_EMPTY)) {
+        if (message.type == COAP_TYPE_CONFIRMABLE) {
+            send_empty(self_p,
+                       COAP_TYPE_RESET,
+                       message.message_id,
+                       remote_addr_p);
+        }
+
+        return (0);
+    }
+
+    /* Resend the response of a retransmitted request. */
+    if ((message.type == COAP_TYPE_CONFIRMABLE)
+        && (self_p->output.size > 0)
+        && (self_p->output.message_id == message.message_id)
+        && is_same_addr(&self_p->output.remote_addr, remote_addr_p)) {
+        res = send_message(self_p,
+                           &self_p->output.buf[0],
+                           self_p->output.size,
+                           remote_addr_p);
+
+        return (res < 0 ? res : 0);
+    }
+
+    return (handle_request(self_p, &message, remote_addr_p));
+}
+
+int coap_server_init(struct coap_server_t *self_p,
+                     const struct inet_addr_t *addr_p,
+                     const struct coap_server_route_t *routes_p)
+{
+    ASSERTN(self_p != NULL, EINVAL);
+    ASSERTN(addr_p != NULL, EINVAL);
+    ASSERTN(routes_p != NULL, EINVAL);
+
+    int i;
+
+    self_p->addr = *addr_p;
+    self_p->routes_p = routes_p;
+    self_p->message_id = 0;
+    self_p->observe_sequence = 0;
+    self_p->output.size = 0;
+
+    for (i = 0; i < membersof(self_p->observers); i++) {
+        self_p->observers[i].route_p = NULL;
+    }
+
+    return (0);
+}
+
+int coap_server_start(struct coap_server_t *self_p)
+{
+    ASSERTN(self_p != NULL, EINVAL);
+
+    int res;
+
+    res = socket_open_udp(&self_p->socket);
+
+    if (res != 0) {
+        return (res);
+    }
+
+    res = socket_bind(&self_p->socket, &self_p->addr);
+
+    if (res != 0) {
+        socket_close(&self_p->socket);
+    }
+
+    return (res);
+}
+
+int coap_server_stop(struct coap_server_t *self_p)
+{
+    ASSERTN(self_p != NULL, EINVAL);
+
+    int i;
+
+    for (i = 0; i < membersof(self_p->observers); i++) {
+        self_p->observers[i].route_p = NULL;
+    }
+
+    return (socket_close(&self_p->socket));
+}
+
+int coap_server_process(struct coap_server_t *self_p)
+{
+    ASSERTN(self_p != NULL, EINVAL);
+
+    struct inet_addr_t remote_addr;
+    ssize_t size;
+
+    size = socket_recvfrom(&self_p->socket,
+                           &self_p->input.buf[0],
+                           sizeof(self_p->input.buf),
+                           0,
+                           &remote_addr);
+
+    if (size < 0) {
+        return (size);
+    }
+
+    return (handle_message(self_p,
+                           &self_p->input.buf[0],
+                           size,
+                           &remote_addr));
+}
+
+int coap_server_notify(struct coap_server_t *self_p,
+                       const char *path_p)
+{
+    ASSERTN(self_p != NULL, EINVAL);
+    ASSERTN(path_p != NULL, EINVAL);
+
+    struct coap_server_observer_t *observer_p;
+    struct coap_message_t message;
+    struct coap_server_request_t request;
+    struct coap_server_response_t response;
+    struct response_header_t header;
+    int count;
+    int res;
+    int i;
+
+    count = 0;
+    self_p->observe_sequence++;
+    self_p->observe_sequence &= OBSERVE_SEQUENCE_MASK;
+
+    for (i = 0; i < membersof(self_p->observers); i++) {
+        observer_p = &self_p->observers[i];
+
+        if ((observer_p->route_p == NULL)
+            || (strcmp(&observer_p->path[0], path_p) != 0)) {
+            continue;
+        }
+
+        /* The route callback is given a GET request without
+           options. */
+        message.type = COAP_TYPE_NON_CONFIRMABLE;
+        message.code = COAP_CODE_GET;
+        message.message_id = self_p->message_id++;
+        memcpy(&message.token[0],
+               &observer_p->token[0],
+               observer_p->token_size);
+        message.token_size = observer_p->token_size;
+        message.options.length = 0;
+        message.payload_p = NULL;
+        message.payload_size = 0;
+
+        request.remote_addr = observer_p->remote_addr;
+        request.message_p = &message;
+        request.path_p = &observer_p->path[0];
+
+        response.code = COAP_CODE_CONTENT;
+        response.content_format = -1;
+        response.buf_p = &self_p->payload[0];
+        response.size = 0;
+
+        if (observer_p->route_p->callback(self_p,
+                                          &request,
+                                          &response) != 0) {
+            response.code = COAP_CODE_INTERNAL_SERVER_ERROR;
+            response.content_format = -1;
+            response.size = 0;
+        }
+
+        if (response.size > sizeof(self_p->payload)) {
+            response.size = sizeof(self_p->payload);
+        }
+
+        header.type = COAP_TYPE_NON_CONFIRMABLE;
+        header.message_id = message.message_id;
+        header.token_p = &message.token[0];
+        header.token_size = message.token_size;
+        header.observe = self_p->observe_sequence;
+        header.block_num = 0;
+        header.block_szx = CONFIG_COAP_SERVER_BLOCK_SZX;
+        observer_p->message_id = message.message_id;
+
+        /* An error response ends the observation. */
+        if (COAP_CODE_CLASS(response.code) != 2) {
+            header.observe = -1;
+            observer_p->route_p = NULL;
+        }
+
+        res = send_response(self_p,
+                            &header,
+                            &response,
+                            &observer_p->remote_addr);
+
+        if (res != 0) {
+            return (res);
+        }
+
+        count++;
+    }
+
+    return (count);
+}
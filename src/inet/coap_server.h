@@ -0,0 +1,181 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2014-2018, Erik Moqvist
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use, copy,
+ * modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ * This file is part of the Simba project.
+ */
+
+#ifndef __INET_COAP_SERVER_H__
+#define __INET_COAP_SERVER_H__
+
+#include "simba.h"
+
+/**
+ * Route method masks. A route without methods matches all methods.
+ */
+#define COAP_SERVER_ROUTE_GET                            (1 << 1)
+#define COAP_SERVER_ROUTE_POST                           (1 << 2)
+#define COAP_SERVER_ROUTE_PUT                            (1 << 3)
+#define COAP_SERVER_ROUTE_DELETE                         (1 << 4)
+
+struct coap_server_t;
+
+struct coap_server_request_t {
+    struct inet_addr_t remote_addr;
+    /* The request message, with the options and the payload. */
+    const struct coap_message_t *message_p;
+    /* The request path, see coap_message_get_path(). */
+    const char *path_p;
+};
+
+/**
+ * The response of a route callback. The callback writes the payload
+ * to given buffer and sets size to the payload size. Payloads larger
+ * than a block are split into blocks by the server.
+ */
+struct coap_server_response_t {
+    /* 2.05 Content, 2.04 Changed or 2.02 Deleted by default. */
+    int code;
+    /* One of COAP_CONTENT_FORMAT_*, or -1 for none. */
+    int content_format;
+    uint8_t *buf_p;
+    size_t size;
+};
+
+typedef int (*coap_server_route_callback_t)(struct coap_server_t *self_p,
+                                            struct coap_server_request_t *request_p,
+                                            struct coap_server_response_t *response_p);
+
+/**
+ * Call given callback for requests with given path. A path ending
+ * with ``/`` matches all paths below it, while other paths must
+ * match the whole request path. The first matching route in the
+ * routes array is called. The last route in the array has path NULL.
+ *
+ * The callback returns zero(0) or negative error code. The server
+ * responds with 5.00 Internal Server Error on failure.
+ */
+struct coap_server_route_t {
+    const char *path_p;
+    coap_server_route_callback_t callback;
+    /* Zero or more of COAP_SERVER_ROUTE_*, or zero for all
+       methods. */
+    int methods;
+};
+
+/**
+ * A client observing a resource, see RFC 7641.
+ */
+struct coap_server_observer_t {
+    const struct coap_server_route_t *route_p;
+    struct inet_addr_t remote_addr;
+    uint8_t token[COAP_TOKEN_SIZE_MAX];
+    size_t token_size;
+    /* Message id of the last notification, to match a reset from the
+       client. */
+    uint16_t message_id;
+    char path[CONFIG_COAP_SERVER_PATH_MAX];
+};
+
+struct coap_server_t {
+    struct inet_addr_t addr;
+    const struct coap_server_route_t *routes_p;
+    struct socket_t socket;
+    uint16_t message_id;
+    uint32_t observe_sequence;
+    struct coap_server_observer_t observers[CONFIG_COAP_SERVER_OBSERVERS_MAX];
+    struct {
+        uint8_t buf[CONFIG_COAP_SERVER_MESSAGE_SIZE_MAX];
+    } input;
+    /* The last piggybacked response is kept to answer a retransmitted
+       confirmable request without calling the route callback
+       again. */
+    struct {
+        uint8_t buf[CONFIG_COAP_SERVER_MESSAGE_SIZE_MAX];
+        size_t size;
+        struct inet_addr_t remote_addr;
+        uint16_t message_id;
+    } output;
+    uint8_t payload[CONFIG_COAP_SERVER_PAYLOAD_MAX];
+};
+
+/**
+ * Initialize given CoAP server.
+ *
+ * @param[out] self_p CoAP server to initialize.
+ * @param[in] addr_p Local address and port of the server, normally
+ *                   port 5683.
+ * @param[in] routes_p An array of routes, terminated by a route
+ *                     with path NULL.
+ *
+ * @return zero(0) or negative error code.
+ */
+int coap_server_init(struct coap_server_t *self_p,
+                     const struct inet_addr_t *addr_p,
+                     const struct coap_server_route_t *routes_p);
+
+/**
+ * Open and bind the server socket.
+ *
+ * @param[in] self_p CoAP server.
+ *
+ * @return zero(0) or negative error code.
+ */
+int coap_server_start(struct coap_server_t *self_p);
+
+/**
+ * Close the server socket and forget all observers.
+ *
+ * @param[in] self_p CoAP server.
+ *
+ * @return zero(0) or negative error code.
+ */
+int coap_server_stop(struct coap_server_t *self_p);
+
+/**
+ * Receive one message from the server socket and handle it. All
+ * routes are called from the calling thread. Wait for the server
+ * socket to become readable with `socket_poll()` to serve other
+ * sockets and channels from the same thread.
+ *
+ * @param[in] self_p CoAP server.
+ *
+ * @return zero(0) or negative error code.
+ */
+int coap_server_process(struct coap_server_t *self_p);
+
+/**
+ * Notify all observers of given path that the resource has changed.
+ * The route callback is called once per observer to create the
+ * notification, which is sent as a non-confirmable message.
+ *
+ * @param[in] self_p CoAP server.
+ * @param[in] path_p Path of the changed resource.
+ *
+ * @return Number of notified observers or negative error code.
+ */
+int coap_server_notify(struct coap_server_t *self_p,
+                       const char *path_p);
+
+#endif
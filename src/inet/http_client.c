@@ -0,0 +1,691 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2014-2018, Erik Moqvist
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use, copy,
+ * modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ * This file is part of the Simba project.
+ */
+
+#include "simba.h"
+
+static FAR const char *actions[] = {
+    FSTR("GET"),
+    FSTR("POST"),
+    FSTR("PUT"),
+    FSTR("DELETE")
+};
+
+/**
+ * Compare given header field name to given lowercase reference name.
+ */
+static int is_name(const char *name_p, const char *reference_p)
+{
+    while (tolower((int)*name_p) == *reference_p) {
+        if (*name_p == '\0') {
+            return (1);
+        }
+
+        name_p++;
+        reference_p++;
+    }
+
+    return (0);
+}
+
+static void connection_close(struct http_client_t *self_p,
+                             struct http_client_connection_t *connection_p)
+{
+#if CONFIG_HTTP_CLIENT_SSL == 1
+    if (connection_p->ssl == 1) {
+        (void)ssl_socket_close(&connection_p->ssl_socket);
+    }
+#endif
+
+    (void)socket_close(&connection_p->socket);
+    connection_p->open = 0;
+}
+
+static int connection_open(struct http_client_t *self_p,
+                           struct http_client_connection_t *connection_p,
+                           const struct http_client_request_t *request_p)
+{
+    struct inet_addr_t server_addr;
+
+    if (socket_gethostbyname(request_p->host_p, &server_addr.ip) != 0) {
+        return (-EHOSTUNREACH);
+    }
+
+    server_addr.port = request_p->port;
+
+    if (socket_open_tcp(&connection_p->socket) != 0) {
+        return (-EIO);
+    }
+
+    if (socket_connect(&connection_p->socket, &server_addr) != 0) {
+        (void)socket_close(&connection_p->socket);
+
+        return (-EIO);
+    }
+
+    connection_p->chan_p = &connection_p->socket;
+
+#if CONFIG_HTTP_CLIENT_SSL == 1
+    if (request_p->ssl == 1) {
+        /* The hostname is used for server certificate verification
+           and to resume a cached session with the server. */
+        if (ssl_socket_open(&connection_p->ssl_socket,
+                            self_p->ssl_context_p,
+                            &connection_p->socket,
+                            0,
+                            request_p->host_p) != 0) {
+            (void)socket_close(&connection_p->socket);
+
+            return (-EIO);
+        }
+
+        connection_p->chan_p = &connection_p->ssl_socket;
+    }
+#endif
+
+    strcpy(&connection_p->host[0], request_p->host_p);
+    connection_p->port = request_p->port;
+    connection_p->ssl = request_p->ssl;
+    connection_p->input.pos = 0;
+    connection_p->input.size = 0;
+    connection_p->open = 1;
+
+    return (0);
+}
+
+/**
+ * Find an idle connection to the server in given request, or a
+ * connection slot to open a new connection in. The least recently
+ * used connection is closed if all slots are taken.
+ */
+static struct http_client_connection_t *connection_get(
+    struct http_client_t *self_p,
+    const struct http_client_request_t *request_p)
+{
+    int i;
+    struct http_client_connection_t *connection_p;
+    struct http_client_connection_t *free_p;
+
+    free_p = NULL;
+
+    for (i = 0; i < membersof(self_p->connections); i++) {
+        connection_p = &self_p->connections[i];
+
+        if (connection_p->open == 0) {
+            if ((free_p == NULL) || (free_p->open == 1)) {
+                free_p = connection_p;
+            }
+        } else if ((connection_p->port == request_p->port)
+                   && (connection_p->ssl == request_p->ssl)
+                   && (strcmp(&connection_p->host[0],
+                              request_p->host_p) == 0)) {
+            return (connection_p);
+        } else if ((free_p == NULL)
+                   || ((free_p->open == 1)
+                       && (connection_p->used < free_p->used))) {
+            free_p = connection_p;
+        }
+    }
+
+    if (free_p->open == 1) {
+        connection_close(self_p, free_p);
+    }
+
+    return (free_p);
+}
+
+/**
+ * Read more data into the input buffer if it is empty. Only bytes
+ * already received are read, but at least one, so that the read
+ * never blocks waiting for data beyond the end of the response.
+ *
+ * @return zero(0) or negative error code.
+ */
+static int input_fill(struct http_client_connection_t *connection_p)
+{
+    size_t size;
+
+    if (connection_p->input.pos < connection_p->input.size) {
+        return (0);
+    }
+
+    size = chan_size(connection_p->chan_p);
+
+    if (size == 0) {
+        size = 1;
+    } else if (size > sizeof(connection_p->input.buf)) {
+        size = sizeof(connection_p->input.buf);
+    }
+
+    if (chan_read(connection_p->chan_p,
+                  &connection_p->input.buf[0],
+                  size) != size) {
+        connection_p->input.pos = 0;
+        connection_p->input.size = 0;
+
+        return (-EIO);
+    }
+
+    connection_p->input.pos = 0;
+    connection_p->input.size = size;
+
+    return (0);
+}
+
+/**
+ * Read a line terminated by CRLF. The line is truncated if it does
+ * not fit in given buffer.
+ *
+ * @return Line length, or negative error code.
+ */
+static ssize_t input_readline(struct http_client_connection_t *connection_p,
+                              char *buf_p,
+                              size_t size)
+{
+    size_t length;
+    char c;
+
+    length = 0;
+
+    while (1) {
+        if (input_fill(connection_p) != 0) {
+            return (-EIO);
+        }
+
+        c = connection_p->input.buf[connection_p->input.pos++];
+
+        if (c == '\n') {
+            break;
+        }
+
+        if (length < size - 1) {
+            buf_p[length++] = c;
+        }
+    }
+
+    if ((length > 0) && (buf_p[length - 1] == '\r')) {
+        length--;
+    }
+
+    buf_p[length] = '\0';
+
+    return (length);
+}
+
+/**
+ * Read up to given number of body bytes. Buffered bytes are read
+ * first, and then, if the number of left bytes is known, directly
+ * from the socket into the destination buffer.
+ */
+static ssize_t input_read(struct http_client_connection_t *connection_p,
+                          char *buf_p,
+                          size_t size,
+                          long left)
+{
+    size_t buffered;
+
+    buffered = (connection_p->input.size - connection_p->input.pos);
+
+    if (buffered == 0) {
+        if (left == -1) {
+            if (input_fill(connection_p) != 0) {
+                return (0);
+            }
+
+            buffered = connection_p->input.size;
+        } else {
+            return (chan_read(connection_p->chan_p, buf_p, size));
+        }
+    }
+
+    if (size > buffered) {
+        size = buffered;
+    }
+
+    memcpy(buf_p,
+           &connection_p->input.buf[connection_p->input.pos],
+           size);
+    connection_p->input.pos += size;
+
+    return (size);
+}
+
+static int write_request(struct http_client_connection_t *connection_p,
+                         const struct http_client_request_t *request_p)
+{
+    std_fprintf(connection_p->chan_p,
+                FSTR("%S %s HTTP/1.1\r\n"
+                     "Host: %s\r\n"),
+                actions[request_p->action],
+                request_p->path_p,
+                request_p->host_p);
+
+    if (request_p->body_p != NULL) {
+        std_fprintf(connection_p->chan_p,
+                    FSTR("Content-Length: %lu\r\n"),
+                    (unsigned long)request_p->size);
+    }
+
+    if (request_p->headers_p != NULL) {
+        std_fprintf(connection_p->chan_p,
+                    FSTR("%s"),
+                    request_p->headers_p);
+    }
+
+    if (chan_write(connection_p->chan_p, "\r\n", 2) != 2) {
+        return (-EIO);
+    }
+
+    if (request_p->body_p != NULL) {
+        if (chan_write(connection_p->chan_p,
+                       request_p->body_p,
+                       request_p->size) != request_p->size) {
+            return (-EIO);
+        }
+    }
+
+    return (0);
+}
+
+/**
+ * Read the status line and the header of the response.
+ */
+static int read_response(struct http_client_t *self_p,
+                         struct http_client_connection_t *connection_p,
+                         struct http_client_response_t *response_p)
+{
+    char buf[CONFIG_HTTP_CLIENT_BUFFER_SIZE];
+    char *name_p;
+    char *value_p;
+    long code;
+    ssize_t res;
+
+    res = input_readline(connection_p, &buf[0], sizeof(buf));
+
+    if (res < 0) {
+        return (res);
+    }
+
+    /* For example "HTTP/1.1 200 OK". */
+    if ((res < 12)
+        || (strncmp(&buf[0], "HTTP/1.", 7) != 0)
+        || (buf[8] != ' ')
+        || (std_strtolb(&buf[9], &code, 10) == NULL)) {
+        return (-EPROTO);
+    }
+
+    response_p->code = code;
+    memset(&response_p->headers, 0, sizeof(response_p->headers));
+    self_p->response.keep_alive = (buf[7] == '1');
+    self_p->response.chunked = 0;
+
+    while (1) {
+        res = input_readline(connection_p, &buf[0], sizeof(buf));
+
+        if (res < 0) {
+            return (res);
+        } else if (res == 0) {
+            break;
+        }
+
+        name_p = &buf[0];
+        value_p = strchr(name_p, ':');
+
+        if (value_p == NULL) {
+            continue;
+        }
+
+        *value_p++ = '\0';
+
+        while (*value_p == ' ') {
+            value_p++;
+        }
+
+        if (is_name(name_p, "content-length")) {
+            if (std_strtolb(value_p,
+                            &response_p->headers.content_length.value,
+                            10) != NULL) {
+                response_p->headers.content_length.present = 1;
+            }
+        } else if (is_name(name_p, "content-type")) {
+            strncpy(&response_p->headers.content_type.value[0],
+                    value_p,
+                    sizeof(response_p->headers.content_type.value) - 1);
+            response_p->headers.content_type.present = 1;
+        } else if (is_name(name_p, "transfer-encoding")) {
+            if (strcmp(value_p, "chunked") == 0) {
+                self_p->response.chunked = 1;
+            }
+        } else if (is_name(name_p, "connection")) {
+            if (is_name(value_p, "close")) {
+                self_p->response.keep_alive = 0;
+            } else if (is_name(value_p, "keep-alive")) {
+                self_p->response.keep_alive = 1;
+            }
+        }
+    }
+
+    /* Find out where the body ends. */
+    if ((response_p->code < 200)
+        || (response_p->code == 204)
+        || (response_p->code == 304)) {
+        self_p->response.left = 0;
+        self_p->response.done = 1;
+    } else if (self_p->response.chunked == 1) {
+        self_p->response.left = 0;
+        self_p->response.done = 0;
+    } else if (response_p->headers.content_length.present == 1) {
+        self_p->response.left = response_p->headers.content_length.value;
+        self_p->response.done = (self_p->response.left == 0);
+    } else {
+        self_p->response.left = -1;
+        self_p->response.done = 0;
+        self_p->response.keep_alive = 0;
+    }
+
+    return (0);
+}
+
+/**
+ * The whole body has been read. Keep the connection for the next
+ * request to the same server, or close it.
+ */
+static void response_end(struct http_client_t *self_p)
+{
+    if (self_p->response.keep_alive == 0) {
+        connection_close(self_p, self_p->response.connection_p);
+    }
+
+    self_p->response.connection_p = NULL;
+}
+
+/**
+ * Read the size line of the next chunk, and the trailer if it is the
+ * last chunk.
+ *
+ * @return Chunk size, or negative error code.
+ */
+static long read_chunk_size(struct http_client_connection_t *connection_p)
+{
+    char buf[24];
+    long size;
+
+    if (input_readline(connection_p, &buf[0], sizeof(buf)) < 0) {
+        return (-EIO);
+    }
+
+    /* Chunk extensions after the size are ignored. */
+    if ((std_strtolb(&buf[0], &size, 16) == NULL) || (size < 0)) {
+        return (-EPROTO);
+    }
+
+    if (size == 0) {
+        /* Skip the trailer. */
+        while (1) {
+            switch (input_readline(connection_p, &buf[0], sizeof(buf))) {
+
+            case 0:
+                return (0);
+
+            case -EIO:
+                return (-EIO);
+
+            default:
+                break;
+            }
+        }
+    }
+
+    return (size);
+}
+
+int http_client_init(struct http_client_t *self_p,
+                     struct ssl_context_t *ssl_context_p)
+{
+    ASSERTN(self_p != NULL, EINVAL);
+
+    int i;
+
+    self_p->ssl_context_p = ssl_context_p;
+    self_p->used = 0;
+    self_p->response.connection_p = NULL;
+
+    for (i = 0; i < membersof(self_p->connections); i++) {
+        self_p->connections[i].open = 0;
+    }
+
+    return (0);
+}
+
+int http_client_request(struct http_client_t *self_p,
+                        const struct http_client_request_t *request_p,
+                        struct http_client_response_t *response_p)
+{
+    ASSERTN(self_p != NULL, EINVAL);
+    ASSERTN(request_p != NULL, EINVAL);
+    ASSERTN(request_p->host_p != NULL, EINVAL);
+    ASSERTN(request_p->path_p != NULL, EINVAL);
+    ASSERTN(request_p->action <= http_client_request_action_delete_t,
+            EINVAL);
+    ASSERTN(response_p != NULL, EINVAL);
+
+    int res;
+    int reused;
+    struct http_client_connection_t *connection_p;
+
+    if (strlen(request_p->host_p) >= CONFIG_HTTP_CLIENT_HOST_MAX) {
+        return (-ENAMETOOLONG);
+    }
+
+#if CONFIG_HTTP_CLIENT_SSL == 1
+    if ((request_p->ssl == 1) && (self_p->ssl_context_p == NULL)) {
+        return (-EINVAL);
+    }
+#else
+    if (request_p->ssl == 1) {
+        return (-ENOSYS);
+    }
+#endif
+
+    /* The body of the previous response was not read to the end. */
+    if (self_p->response.connection_p != NULL) {
+        connection_close(self_p, self_p->response.connection_p);
+        self_p->response.connection_p = NULL;
+    }
+
+    connection_p = connection_get(self_p, request_p);
+    reused = connection_p->open;
+
+    while (1) {
+        if (connection_p->open == 0) {
+            res = connection_open(self_p, connection_p, request_p);
+
+            if (res != 0) {
+                return (res);
+            }
+        }
+
+        res = write_request(connection_p, request_p);
+
+        if (res == 0) {
+            res = read_response(self_p, connection_p, response_p);
+        }
+
+        if (res == 0) {
+            break;
+        }
+
+        connection_close(self_p, connection_p);
+
+        /* The server may have closed an idle connection. Retry once
+           on a new connection. */
+        if ((reused == 0) || (res != -EIO)) {
+            return (res);
+        }
+
+        reused = 0;
+    }
+
+    connection_p->used = self_p->used++;
+    self_p->response.connection_p = connection_p;
+
+    if (self_p->response.done == 1) {
+        response_end(self_p);
+    }
+
+    return (0);
+}
+
+ssize_t http_client_response_read(struct http_client_t *self_p,
+                                  void *buf_p,
+                                  size_t size)
+{
+    ASSERTN(self_p != NULL, EINVAL);
+    ASSERTN(buf_p != NULL, EINVAL);
+    ASSERTN(size > 0, EINVAL);
+
+    struct http_client_connection_t *connection_p;
+    char crlf[2];
+    ssize_t res;
+
+    connection_p = self_p->response.connection_p;
+
+    if (connection_p == NULL) {
+        return (0);
+    }
+
+    if ((self_p->response.chunked == 1) && (self_p->response.left == 0)) {
+        self_p->response.left = read_chunk_size(connection_p);
+
+        if (self_p->response.left < 0) {
+            res = self_p->response.left;
+            self_p->response.keep_alive = 0;
+            response_end(self_p);
+
+            return (res);
+        } else if (self_p->response.left == 0) {
+            response_end(self_p);
+
+            return (0);
+        }
+    }
+
+    if ((self_p->response.left != -1) && ((long)size > self_p->response.left)) {
+        size = self_p->response.left;
+    }
+
+    res = input_read(connection_p, buf_p, size, self_p->response.left);
+
+    if (self_p->response.left == -1) {
+        /* The server closes the connection at the end of the
+           body. */
+        if (res <= 0) {
+            response_end(self_p);
+
+            return (0);
+        }
+
+        return (res);
+    }
+
+    if (res <= 0) {
+        self_p->response.keep_alive = 0;
+        response_end(self_p);
+
+        return (-EIO);
+    }
+
+    self_p->response.left -= res;
+
+    if (self_p->response.left == 0) {
+        if (self_p->response.chunked == 1) {
+            /* CRLF after the chunk data. */
+            if (input_readline(connection_p,
+                               &crlf[0],
+                               sizeof(crlf)) != 0) {
+                self_p->response.keep_alive = 0;
+                response_end(self_p);
+
+                return (-EIO);
+            }
+        } else {
+            response_end(self_p);
+        }
+    }
+
+    return (res);
+}
+
+ssize_t http_client_response_copy(struct http_client_t *self_p,
+                                  void *chout_p)
+{
+    ASSERTN(self_p != NULL, EINVAL);
+    ASSERTN(chout_p != NULL, EINVAL);
+
+    char buf[64];
+    ssize_t size;
+    ssize_t res;
+
+    size = 0;
+
+    while (1) {
+        res = http_client_response_read(self_p, &buf[0], sizeof(buf));
+
+        if (res <= 0) {
+            break;
+        }
+
+        if (chan_write(chout_p, &buf[0], res) != res) {
+            return (-EIO);
+        }
+
+        size += res;
+    }
+
+    if (res < 0) {
+        return (res);
+    }
+
+    return (size);
+}
+
+int http_client_close(struct http_client_t *self_p)
+{
+    ASSERTN(self_p != NULL, EINVAL);
+
+    int i;
+
+    for (i = 0; i < membersof(self_p->connections); i++) {
+        if (self_p->connections[i].open == 1) {
+            connection_close(self_p, &self_p->connections[i]);
+        }
+    }
+
+    self_p->response.connection_p = NULL;
+
+    return (0);
+}
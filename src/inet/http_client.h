@@ -0,0 +1,198 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2014-2018, Erik Moqvist
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use, copy,
+ * modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ * This file is part of the Simba project.
+ */
+
+#ifndef __INET_HTTP_CLIENT_H__
+#define __INET_HTTP_CLIENT_H__
+
+#include "simba.h"
+
+/**
+ * Request action types.
+ */
+enum http_client_request_action_t {
+    http_client_request_action_get_t = 0,
+    http_client_request_action_post_t,
+    http_client_request_action_put_t,
+    http_client_request_action_delete_t
+};
+
+/**
+ * HTTP request.
+ */
+struct http_client_request_t {
+    enum http_client_request_action_t action;
+    const char *host_p;
+    int port;
+    /** Use TLS. Requires an SSL context given to
+        `http_client_init()`. */
+    int ssl;
+    const char *path_p;
+    /** Extra header fields, each terminated by ``"\r\n"``, or
+        NULL. ``Host``, ``Content-Length`` and ``Connection`` are
+        added by the client. */
+    const char *headers_p;
+    /** Request body, or NULL. */
+    const void *body_p;
+    size_t size;
+};
+
+/**
+ * HTTP response status and header fields.
+ */
+struct http_client_response_t {
+    int code;
+    struct {
+        struct {
+            int present;
+            long value;
+        } content_length;
+        struct {
+            int present;
+            char value[52];
+        } content_type;
+    } headers;
+};
+
+/**
+ * A pooled connection to a server.
+ */
+struct http_client_connection_t {
+    /* Zero(0) if free. */
+    int open;
+    char host[CONFIG_HTTP_CLIENT_HOST_MAX];
+    int port;
+    int ssl;
+    /* Last use, for eviction of the least recently used idle
+       connection. */
+    uint32_t used;
+    struct socket_t socket;
+#if CONFIG_HTTP_CLIENT_SSL == 1
+    struct ssl_socket_t ssl_socket;
+#endif
+    void *chan_p;
+    /* Read-ahead buffer used to parse the response header and chunk
+       sizes. */
+    struct {
+        char buf[CONFIG_HTTP_CLIENT_BUFFER_SIZE];
+        size_t pos;
+        size_t size;
+    } input;
+};
+
+struct http_client_t {
+    struct ssl_context_t *ssl_context_p;
+    struct http_client_connection_t connections[CONFIG_HTTP_CLIENT_CONNECTIONS_MAX];
+    uint32_t used;
+    /* Connection and body state of the current response. */
+    struct {
+        struct http_client_connection_t *connection_p;
+        int keep_alive;
+        int chunked;
+        /* Bytes left in the body or current chunk, or -1 if the body
+           ends when the server closes the connection. */
+        long left;
+        int done;
+    } response;
+};
+
+/**
+ * Initialize given HTTP client. The client keeps connections to
+ * servers open between requests, and reuses them for later requests
+ * to the same server. A client may only be used by one thread at a
+ * time.
+ *
+ * @param[out] self_p HTTP client to initialize.
+ * @param[in] ssl_context_p Client side SSL context used for requests
+ *                          with ``ssl`` set, or NULL. The TLS
+ *                          session of a server is resumed when
+ *                          reconnecting, if the SSL module session
+ *                          cache is enabled.
+ *
+ * @return zero(0) or negative error code.
+ */
+int http_client_init(struct http_client_t *self_p,
+                     struct ssl_context_t *ssl_context_p);
+
+/**
+ * Send given request and read the response status line and header.
+ * An idle connection to the server is reused, and a new connection
+ * is opened if there is none, or if the server has closed it.
+ *
+ * The response body must then be read with
+ * `http_client_response_read()` or `http_client_response_copy()`
+ * before the next request is sent.
+ *
+ * @param[in] self_p HTTP client.
+ * @param[in] request_p Request to send.
+ * @param[out] response_p Response status code and header fields.
+ *
+ * @return zero(0) or negative error code.
+ */
+int http_client_request(struct http_client_t *self_p,
+                        const struct http_client_request_t *request_p,
+                        struct http_client_response_t *response_p);
+
+/**
+ * Read up to given number of bytes of the response body. Chunked
+ * bodies are decoded. The connection is put back in the pool when
+ * the whole body has been read, unless the server closes it.
+ *
+ * @param[in] self_p HTTP client.
+ * @param[out] buf_p Buffer to read into.
+ * @param[in] size Size of the buffer.
+ *
+ * @return Number of read bytes, zero(0) at the end of the body, or
+ *         negative error code.
+ */
+ssize_t http_client_response_read(struct http_client_t *self_p,
+                                  void *buf_p,
+                                  size_t size);
+
+/**
+ * Read the whole response body and write it to given channel, for
+ * example a file or an upgrade stream, without buffering it all in
+ * RAM.
+ *
+ * @param[in] self_p HTTP client.
+ * @param[in] chout_p Channel to write the body to.
+ *
+ * @return Body size or negative error code.
+ */
+ssize_t http_client_response_copy(struct http_client_t *self_p,
+                                  void *chout_p);
+
+/**
+ * Close all pooled connections of given HTTP client.
+ *
+ * @param[in] self_p HTTP client.
+ *
+ * @return zero(0) or negative error code.
+ */
+int http_client_close(struct http_client_t *self_p);
+
+#endif
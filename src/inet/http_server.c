@@ -28,10 +28,15 @@
 
 #include "simba.h"
 
+/* Static file response content length special values. */
+#define CONTENT_LENGTH_CHUNKED                                 -1
+#define CONTENT_LENGTH_NONE                                    -2
+
 static const FAR char ok_fmt[] =
     "HTTP/1.1 200 OK\r\n"
     "Content-Type: %s\r\n"
     "Content-Length: %d\r\n"
+    "%s"
     "\r\n";
 
 static const FAR char unauthorized_fmt[] =
@@ -39,22 +44,222 @@ static const FAR char unauthorized_fmt[] =
     "WWW-Authenticate: Basic realm=\"\"\r\n"
     "Content-Type: %s\r\n"
     "Content-Length: %d\r\n"
+    "%s"
     "\r\n";
 
 static const FAR char not_found_fmt[] =
     "HTTP/1.1 404 Not Found\r\n"
     "Content-Type: %s\r\n"
     "Content-Length: %d\r\n"
+    "%s"
     "\r\n";
 
 static const FAR char bad_request_header[] =
     "HTTP/1.1 400 Bad Request\r\n"
     "Content-Type: text/plain\r\n"
     "Content-Length: 32\r\n"
+    "Connection: close\r\n"
     "\r\n"
     "Failed to parse the HTTP header.";
 
-static int read_initial_request_line(void *chan_p,
+/**
+ * Header fields saved in the request object.
+ */
+struct header_t {
+    const char *name_p;
+    size_t present_offset;
+    size_t value_offset;
+    /* Zero if the value is an integer. */
+    size_t size;
+};
+
+#define HEADER_OFFSET(member)                                   \
+    offsetof(struct http_server_request_t, headers.member)
+
+#define HEADER_STRING(name, member)                                     \
+    {                                                                   \
+        name,                                                           \
+        HEADER_OFFSET(member.present),                                  \
+        HEADER_OFFSET(member.value),                                    \
+        sizeof(((struct http_server_request_t *)0)->headers.member.value) \
+    }
+
+#define HEADER_INTEGER(name, member)            \
+    {                                           \
+        name,                                   \
+        HEADER_OFFSET(member.present),          \
+        HEADER_OFFSET(member.value),            \
+        0                                       \
+    }
+
+/**
+ * Known header fields indexed by a perfect hash of the header name,
+ * see `header_hash()`.
+ */
+static const struct header_t headers[16] = {
+    [2] = HEADER_STRING("Sec-WebSocket-Key", sec_websocket_key),
+    [3] = HEADER_STRING("Expect", expect),
+    [4] = HEADER_STRING("If-None-Match", if_none_match),
+    [9] = HEADER_STRING("Connection", connection),
+    [11] = HEADER_STRING("Sec-WebSocket-Extensions", sec_websocket_extensions),
+    [12] = HEADER_STRING("Authorization", authorization),
+    [13] = HEADER_INTEGER("Content-Length", content_length),
+    [14] = HEADER_STRING("Accept-Encoding", accept_encoding),
+    [15] = HEADER_STRING("Content-Type", content_type)
+};
+
+/**
+ * The length xor the first character of all known header names
+ * differs in the lower four bits, which makes it a perfect hash.
+ */
+static int header_hash(const char *name_p, size_t length)
+{
+    return ((length ^ name_p[0]) & 0xf);
+}
+
+static ssize_t input_read(struct http_server_connection_t *connection_p,
+                          void *buf_p,
+                          size_t size);
+
+static ssize_t input_write(struct http_server_connection_t *connection_p,
+                           const void *buf_p,
+                           size_t size);
+
+static size_t input_size(struct http_server_connection_t *connection_p);
+
+/**
+ * Get given connections' read-ahead channel.
+ */
+static struct http_server_connection_t *
+input_connection(void *self_p)
+{
+    return (container_of(self_p, struct http_server_connection_t, input));
+}
+
+static ssize_t input_read_chan(void *self_p,
+                               void *buf_p,
+                               size_t size)
+{
+    return (input_read(input_connection(self_p), buf_p, size));
+}
+
+static ssize_t input_write_chan(void *self_p,
+                                const void *buf_p,
+                                size_t size)
+{
+    return (input_write(input_connection(self_p), buf_p, size));
+}
+
+static size_t input_size_chan(void *self_p)
+{
+    return (input_size(input_connection(self_p)));
+}
+
+/**
+ * Read as many bytes as are available in the socket into the
+ * read-ahead buffer, but at least one.
+ */
+static int input_fill(struct http_server_connection_t *connection_p)
+{
+    size_t size;
+    ssize_t res;
+
+    size = chan_size(connection_p->input.chan_p);
+
+    if (size == 0) {
+        size = 1;
+    } else if (size > sizeof(connection_p->input.buf)) {
+        size = sizeof(connection_p->input.buf);
+    }
+
+    res = chan_read(connection_p->input.chan_p,
+                    &connection_p->input.buf[0],
+                    size);
+
+    if (res <= 0) {
+        return (-EIO);
+    }
+
+    connection_p->input.pos = 0;
+    connection_p->input.size = res;
+
+    return (0);
+}
+
+/**
+ * Read one byte from the read-ahead buffer.
+ */
+static int input_get(struct http_server_connection_t *connection_p,
+                     char *c_p)
+{
+    if (connection_p->input.pos == connection_p->input.size) {
+        if (input_fill(connection_p) != 0) {
+            return (-EIO);
+        }
+    }
+
+    *c_p = connection_p->input.buf[connection_p->input.pos++];
+
+    return (0);
+}
+
+/**
+ * Read from the read-ahead buffer first, and then directly from the
+ * socket.
+ */
+static ssize_t input_read(struct http_server_connection_t *connection_p,
+                          void *buf_p,
+                          size_t size)
+{
+    size_t left;
+    size_t buffered;
+    ssize_t res;
+    char *b_p;
+
+    b_p = buf_p;
+    left = size;
+    buffered = (connection_p->input.size - connection_p->input.pos);
+
+    if (buffered > 0) {
+        if (buffered > left) {
+            buffered = left;
+        }
+
+        memcpy(b_p, &connection_p->input.buf[connection_p->input.pos], buffered);
+        connection_p->input.pos += buffered;
+        b_p += buffered;
+        left -= buffered;
+    }
+
+    if (left > 0) {
+        res = chan_read(connection_p->input.chan_p, b_p, left);
+
+        if (res < 0) {
+            if (left == size) {
+                return (res);
+            }
+        } else {
+            left -= res;
+        }
+    }
+
+    return (size - left);
+}
+
+static ssize_t input_write(struct http_server_connection_t *connection_p,
+                           const void *buf_p,
+                           size_t size)
+{
+    return (chan_write(connection_p->input.chan_p, buf_p, size));
+}
+
+static size_t input_size(struct http_server_connection_t *connection_p)
+{
+    return ((connection_p->input.size - connection_p->input.pos)
+            + chan_size(connection_p->input.chan_p));
+}
+
+static int read_initial_request_line(struct http_server_connection_t *connection_p,
                                      char *buf_p,
                                      struct http_server_request_t *request_p)
 {
@@ -72,7 +277,7 @@ static int read_initial_request_line(void *chan_p,
             return (-ENOMEM);
         }
 
-        if (chan_read(chan_p, buf_p, sizeof(*buf_p)) != sizeof(*buf_p)) {
+        if (input_get(connection_p, buf_p) != 0) {
             return (-EIO);
         }
 
@@ -103,10 +308,13 @@ static int read_initial_request_line(void *chan_p,
         return (-1);
     }
 
-    log_object_print(NULL,
+    LOG_OBJECT_PRINT(NULL,
                      LOG_DEBUG,
                      OSTR("%s %s %s\r\n"), action_p, path_p, proto_p);
 
+    /* Persistent connections are the default in HTTP/1.1 only. */
+    connection_p->keep_alive = (strcmp(proto_p, "HTTP/1.1") == 0);
+
     /* Save the action and path in the request struct. */
     size = sizeof(request_p->path);
     strncpy(request_p->path, path_p, size - 1);
@@ -123,7 +331,7 @@ static int read_initial_request_line(void *chan_p,
     return (0);
 }
 
-static int read_header_line(void *chan_p,
+static int read_header_line(struct http_server_connection_t *connection_p,
                             char *buf_p,
                             char **header_pp,
                             char **value_pp)
@@ -139,7 +347,7 @@ static int read_header_line(void *chan_p,
             return (-ENOMEM);
         }
 
-        if (chan_read(chan_p, buf_p, sizeof(*buf_p)) != sizeof(*buf_p)) {
+        if (input_get(connection_p, buf_p) != 0) {
             return (-EIO);
         }
 
@@ -176,12 +384,13 @@ static int read_request(struct http_server_t *self_p,
 {
     int res;
     char buf[CONFIG_HTTP_SERVER_REQUEST_BUFFER_SIZE];
-    char *header_p;
+    char *name_p;
     char *value_p;
-    size_t size;
+    char *field_p;
+    const struct header_t *header_p;
 
     /* Read the intial line in the request. */
-    res = read_initial_request_line(connection_p->chan_p,
+    res = read_initial_request_line(connection_p,
                                     buf,
                                     request_p);
 
@@ -190,12 +399,13 @@ static int read_request(struct http_server_t *self_p,
     }
 
     memset(&request_p->headers, 0, sizeof(request_p->headers));
+    request_p->params.length = 0;
 
     /* Read the header lines. */
     while (1) {
-        res = read_header_line(connection_p->chan_p,
+        res = read_header_line(connection_p,
                                buf,
-                               &header_p,
+                               &name_p,
                                &value_p);
 
         if (res == 1) {
@@ -204,33 +414,36 @@ static int read_request(struct http_server_t *self_p,
             return (res);
         }
 
-        log_object_print(NULL, LOG_DEBUG, OSTR("%s: %s\r\n"), header_p, value_p);
+        LOG_OBJECT_PRINT(NULL, LOG_DEBUG, OSTR("%s: %s\r\n"), name_p, value_p);
 
         /* Save the header field in the request object. */
-        if (strcmp(header_p, "Sec-WebSocket-Key") == 0) {
-            request_p->headers.sec_websocket_key.present = 1;
-            size = sizeof(request_p->headers.sec_websocket_key.value);
-            strncpy(request_p->headers.sec_websocket_key.value, value_p, size - 1);
-            request_p->headers.sec_websocket_key.value[size - 1] = '\0';
-        } else if (strcmp(header_p, "Content-Type") == 0) {
-            request_p->headers.content_type.present = 1;
-            size = sizeof(request_p->headers.content_type.value);
-            strncpy(request_p->headers.content_type.value, value_p, size - 1);
-            request_p->headers.content_type.value[size - 1] = '\0';
-        } else if (strcmp(header_p, "Content-Length") == 0) {
-            if (std_strtol(value_p, &request_p->headers.content_length.value) != NULL) {
-                request_p->headers.content_length.present = 1;
+        header_p = &headers[header_hash(name_p, value_p - name_p - 2)];
+
+        if ((header_p->name_p == NULL)
+            || (strcmp(header_p->name_p, name_p) != 0)) {
+            continue;
+        }
+
+        field_p = ((char *)request_p + header_p->value_offset);
+
+        if (header_p->size == 0) {
+            if (std_strtol(value_p, (long *)field_p) == NULL) {
+                continue;
             }
-        } else if (strcmp(header_p, "Authorization") == 0) {
-            request_p->headers.authorization.present = 1;
-            size = sizeof(request_p->headers.authorization.value);
-            strncpy(request_p->headers.authorization.value, value_p, size - 1);
-            request_p->headers.authorization.value[size - 1] = '\0';
-        } else if (strcmp(header_p, "Expect") == 0) {
-            request_p->headers.expect.present = 1;
-            size = sizeof(request_p->headers.expect.value);
-            strncpy(request_p->headers.expect.value, value_p, size - 1);
-            request_p->headers.expect.value[size - 1] = '\0';
+        } else {
+            strncpy(field_p, value_p, header_p->size - 1);
+            field_p[header_p->size - 1] = '\0';
+        }
+
+        *(int *)((char *)request_p + header_p->present_offset) = 1;
+    }
+
+    /* The client may ask to close the connection, or to upgrade it
+       to another protocol. */
+    if (request_p->headers.connection.present == 1) {
+        if ((strcmp(request_p->headers.connection.value, "keep-alive") != 0)
+            && (strcmp(request_p->headers.connection.value, "Keep-Alive") != 0)) {
+            connection_p->keep_alive = 0;
         }
     }
 
@@ -238,221 +451,1266 @@ static int read_request(struct http_server_t *self_p,
 }
 
 /**
- * Search for given path in the routes array and return its callback.
+ * A path parameter position in the request path.
  */
-static http_server_route_callback_t
-find_route_callback(struct http_server_t *self_p,
-                    const char *path_p)
-{
-    const struct http_server_route_t *route_p;
-
-    route_p = self_p->routes_p;
+struct capture_t {
+    uint8_t offset;
+    uint8_t length;
+};
 
-    while (route_p->path_p != NULL) {
-        if (strncmp(route_p->path_p, path_p, strlen(route_p->path_p)) == 0) {
-            return (route_p->callback);
-        }
+/**
+ * Route search state.
+ */
+struct route_match_t {
+    const char *path_p;
+    const char *end_p;
+    enum http_server_request_action_t action;
+    int count;
+    struct capture_t captures[CONFIG_HTTP_SERVER_ROUTE_PARAMS_MAX];
+    struct {
+        int route;
+        int count;
+        struct capture_t captures[CONFIG_HTTP_SERVER_ROUTE_PARAMS_MAX];
+    } best;
+};
+
+static int is_param_segment(const char *segment_p, size_t length)
+{
+    return ((length >= 2)
+            && (segment_p[0] == '{')
+            && (segment_p[length - 1] == '}'));
+}
 
-        route_p++;
+static const char *find_segment_end(const char *begin_p, const char *end_p)
+{
+    while ((begin_p < end_p) && (*begin_p != '/')) {
+        begin_p++;
     }
 
-    return (NULL);
+    return (begin_p);
 }
 
-static int handle_request(struct http_server_t *self_p,
-                          struct http_server_connection_t *connection_p)
+static void capture_push(struct route_match_t *match_p,
+                         const char *segment_p,
+                         const char *segment_end_p)
 {
-    int res;
-    struct http_server_request_t request;
-    http_server_route_callback_t callback;
-
-    /* Read the HTTP request. */
-    res = read_request(self_p, connection_p, &request);
-
-    if (res != 0) {
-        /* Reply with a Bad Request if the header could not be read.*/
-        std_fprintf(connection_p->chan_p, bad_request_header);
-
-        return (res);
+    if (match_p->count < CONFIG_HTTP_SERVER_ROUTE_PARAMS_MAX) {
+        match_p->captures[match_p->count].offset = (segment_p - match_p->path_p);
+        match_p->captures[match_p->count].length = (segment_end_p - segment_p);
     }
 
-    /* Find the callback for given path. */
-    callback = find_route_callback(self_p, request.path);
-
-    if (callback == NULL) {
-        callback = self_p->on_no_route;
-    }
+    match_p->count++;
+}
 
-    /* Call the callback and write the response if requested. */
-    return (callback(connection_p, &request));
+static int route_has_action(const struct http_server_route_t *route_p,
+                            enum http_server_request_action_t action)
+{
+    return ((route_p->actions == 0) || (route_p->actions & (1 << action)));
 }
 
 /**
- * The connection thread serves a client for the duration of the
- * socket lifetime.
+ * Returns true(1) if given route path matches the request path,
+ * otherwise false(0). Path parameters are captured in given match
+ * object.
  */
-static void *connection_main(void *arg_p)
+static int route_match(const char *route_p, struct route_match_t *match_p)
 {
-    struct http_server_connection_t *connection_p = arg_p;
-    struct http_server_t *self_p = connection_p->self_p;
-    uint32_t mask;
+    const char *path_p;
+    const char *route_end_p;
+    const char *path_end_p;
+    size_t length;
 
-    /* thrd_init_env(buf, sizeof(buf)); */
-    /* thrd_set_env("CWD", self_p->root_path_p); */
-    thrd_set_name(connection_p->thrd.name_p);
+    path_p = match_p->path_p;
+    match_p->count = 0;
 
-    /* Wait for a connection from the listener. */
-    while (1) {
-        log_object_print(NULL,
-                         LOG_DEBUG,
-                         OSTR("Connection thread '%s' waiting for a new connection.\r\n"),
-                         thrd_get_name());
+    if ((route_p[0] != '/')
+        || (path_p == match_p->end_p)
+        || (path_p[0] != '/')) {
+        return (0);
+    }
 
-        mask = 0x1;
-        event_read(&connection_p->events, &mask, sizeof(mask));
+    route_p++;
+    path_p++;
 
-        if (mask & 0x1) {
-#if CONFIG_HTTP_SERVER_SSL == 1
-            if (self_p->ssl_context_p != NULL) {
-                ssl_socket_open(&connection_p->ssl_socket,
-                                self_p->ssl_context_p,
-                                &connection_p->socket,
-                                SSL_SOCKET_SERVER_SIDE,
-                                NULL);
-            }
-#endif
+    while (*route_p != '\0') {
+        route_end_p = strchr(route_p, '/');
+
+        if (route_end_p == NULL) {
+            route_end_p = (route_p + strlen(route_p));
+        }
 
-            handle_request(self_p, connection_p);
+        length = (route_end_p - route_p);
+        path_end_p = find_segment_end(path_p, match_p->end_p);
 
-#if CONFIG_HTTP_SERVER_SSL == 1
-            if (self_p->ssl_context_p != NULL) {
-                (void)ssl_socket_close(&connection_p->ssl_socket);
+        if (is_param_segment(route_p, length)) {
+            if (path_end_p == path_p) {
+                return (0);
             }
-#endif
 
-            (void)socket_close(&connection_p->socket);
+            capture_push(match_p, path_p, path_end_p);
+        } else if ((length != (path_end_p - path_p))
+                   || (strncmp(route_p, path_p, length) != 0)) {
+            return (0);
+        }
 
-            /* Add thread to the free list. */
-            sys_lock();
-            connection_p->state = http_server_connection_state_free_t;
-            sys_unlock();
-            mask = 0x1;
-            event_write(&self_p->events, &mask, sizeof(mask));
+        /* The whole request path must be consumed by a route not
+           ending with a '/'. */
+        if (*route_end_p == '\0') {
+            return (path_end_p == match_p->end_p);
+        }
+
+        if (path_end_p == match_p->end_p) {
+            return (0);
         }
+
+        route_p = (route_end_p + 1);
+        path_p = (path_end_p + 1);
     }
 
-    return (NULL);
+    /* The route ends with a '/' and matches everything below it. */
+    return (1);
 }
 
-static int handle_accept(struct http_server_t *self_p,
-                         struct http_server_connection_t *connection_p)
+#if CONFIG_HTTP_SERVER_ROUTE_NODES_MAX > 0
+
+/**
+ * Find the first route with the same path as given route, starting
+ * at given route, that handles given action.
+ */
+static int find_route_with_action(struct http_server_t *self_p,
+                                  int route,
+                                  enum http_server_request_action_t action)
 {
-    uint32_t mask;
+    const struct http_server_route_t *route_p;
+    const char *path_p;
 
-    mask = 0x1;
-    event_write(&connection_p->events, &mask, sizeof(mask));
+    route_p = &self_p->routes_p[route];
+    path_p = route_p->path_p;
 
-    return (0);
+    while (route_p->path_p != NULL) {
+        if ((strcmp(route_p->path_p, path_p) == 0)
+            && route_has_action(route_p, action)) {
+            return (route_p - self_p->routes_p);
+        }
+
+        route_p++;
+    }
+
+    return (-1);
 }
 
-static struct http_server_connection_t *
-allocate_connection(struct http_server_t *self_p)
+/**
+ * Add given route to the route index. Returns zero(0) on success and
+ * negative error code if the index is full.
+ */
+static int route_index_add(struct http_server_t *self_p, int route)
 {
-    uint32_t mask;
-    struct http_server_connection_t *connection_p;
+    struct http_server_route_node_t *nodes_p;
+    const char *route_p;
+    const char *route_end_p;
+    size_t length;
+    int is_param;
+    int node;
+    int child;
+
+    nodes_p = &self_p->route_index.nodes[0];
+    route_p = self_p->routes_p[route].path_p;
+
+    if (route_p[0] != '/') {
+        return (-EINVAL);
+    }
 
-    while (1) {
-        sys_lock();
+    route_p++;
+    node = 0;
 
-        connection_p = self_p->connections_p;
+    while (*route_p != '\0') {
+        route_end_p = strchr(route_p, '/');
 
-        while (connection_p->thrd.stack.buf_p != NULL) {
-            if (connection_p->state == http_server_connection_state_free_t) {
-                connection_p->state = http_server_connection_state_allocated_t;
+        if (route_end_p == NULL) {
+            route_end_p = (route_p + strlen(route_p));
+        }
+
+        length = (route_end_p - route_p);
+
+        if (length > 255) {
+            return (-E2BIG);
+        }
+
+        is_param = is_param_segment(route_p, length);
+
+        /* Find the child node of this segment. */
+        child = nodes_p[node].child;
+
+        while (child != -1) {
+            if ((nodes_p[child].length == length)
+                && (strncmp(nodes_p[child].segment_p, route_p, length) == 0)) {
                 break;
             }
 
-            connection_p++;
+            child = nodes_p[child].sibling;
         }
 
-        sys_unlock();
+        /* Add a child node if missing. */
+        if (child == -1) {
+            if (self_p->route_index.length == CONFIG_HTTP_SERVER_ROUTE_NODES_MAX) {
+                return (-ENOMEM);
+            }
 
-        /* Connection available. */
-        if (connection_p->thrd.name_p != NULL) {
-            break;
+            child = self_p->route_index.length++;
+            nodes_p[child].segment_p = route_p;
+            nodes_p[child].length = length;
+            nodes_p[child].is_param = is_param;
+            nodes_p[child].child = -1;
+            nodes_p[child].sibling = nodes_p[node].child;
+            nodes_p[child].route = -1;
+            nodes_p[child].prefix_route = -1;
+            nodes_p[node].child = child;
         }
 
-        mask = 0x1;
-        event_read(&self_p->events, &mask, sizeof(mask));
+        node = child;
+
+        if (*route_end_p == '\0') {
+            if (nodes_p[node].route == -1) {
+                nodes_p[node].route = route;
+            }
+
+            return (0);
+        }
+
+        route_p = (route_end_p + 1);
     }
 
-    return (connection_p);
+    if (nodes_p[node].prefix_route == -1) {
+        nodes_p[node].prefix_route = route;
+    }
+
+    return (0);
 }
 
 /**
- * The listener thread main function. The listener listens for
- * connections from clients.
+ * Build the route index. Routes are searched linearly if it fails.
  */
-static void *listener_main(void *arg_p)
+static void route_index_build(struct http_server_t *self_p)
 {
-    struct http_server_t *self_p = arg_p;
-    struct http_server_listener_t *listener_p;
-    struct http_server_connection_t *connection_p;
-    struct inet_addr_t addr;
+    int route;
+
+    self_p->route_index.length = 1;
+    self_p->route_index.nodes[0].segment_p = "";
+    self_p->route_index.nodes[0].length = 0;
+    self_p->route_index.nodes[0].is_param = 0;
+    self_p->route_index.nodes[0].child = -1;
+    self_p->route_index.nodes[0].sibling = -1;
+    self_p->route_index.nodes[0].route = -1;
+    self_p->route_index.nodes[0].prefix_route = -1;
+
+    for (route = 0; self_p->routes_p[route].path_p != NULL; route++) {
+        if (route_index_add(self_p, route) != 0) {
+            log_object_print(NULL,
+                             LOG_WARNING,
+                             OSTR("route index full, searching linearly\r\n"));
+            self_p->route_index.length = -1;
+            break;
+        }
+    }
+}
 
-    thrd_set_name(self_p->listener_p->thrd.name_p);
+/**
+ * Keep given route if it handles the request action and comes before
+ * the best route found so far.
+ */
+static void route_index_candidate(struct http_server_t *self_p,
+                                  int route,
+                                  struct route_match_t *match_p)
+{
+    if (route == -1) {
+        return;
+    }
 
-    listener_p = self_p->listener_p;
+    route = find_route_with_action(self_p, route, match_p->action);
 
-    if (socket_open_tcp(&listener_p->socket) != 0) {
-        log_object_print(NULL,
-                         LOG_ERROR,
-                         OSTR("failed to open socket\r\n"));
-        return (NULL);
+    if (route == -1) {
+        return;
     }
 
-    if (inet_aton(listener_p->address_p, &addr.ip) != 0) {
-        return (NULL);
+    if ((match_p->best.route != -1) && (match_p->best.route < route)) {
+        return;
     }
 
-    addr.port = listener_p->port;
+    match_p->best.route = route;
+    match_p->best.count = match_p->count;
+    memcpy(&match_p->best.captures[0],
+           &match_p->captures[0],
+           sizeof(match_p->best.captures));
+}
 
-    if (socket_bind(&listener_p->socket, &addr) != 0) {
-        log_object_print(NULL,
-                         LOG_ERROR,
-                         OSTR("failed to bind socket\r\n"));
-        return (NULL);
+/**
+ * Search for routes matching the request path below given node.
+ * Given path points just after the segment of the node.
+ */
+static void route_index_search(struct http_server_t *self_p,
+                               int node,
+                               const char *path_p,
+                               struct route_match_t *match_p)
+{
+    struct http_server_route_node_t *node_p;
+    const char *path_end_p;
+    int child;
+
+    node_p = &self_p->route_index.nodes[node];
+
+    if (path_p == match_p->end_p) {
+        route_index_candidate(self_p, node_p->route, match_p);
+
+        return;
     }
 
-    if (socket_listen(&listener_p->socket, 3) != 0) {
+    route_index_candidate(self_p, node_p->prefix_route, match_p);
+    path_p++;
+    path_end_p = find_segment_end(path_p, match_p->end_p);
+    child = node_p->child;
+
+    while (child != -1) {
+        node_p = &self_p->route_index.nodes[child];
+
+        if (node_p->is_param) {
+            if (path_end_p > path_p) {
+                capture_push(match_p, path_p, path_end_p);
+                route_index_search(self_p, child, path_end_p, match_p);
+                match_p->count--;
+            }
+        } else if ((node_p->length == (path_end_p - path_p))
+                   && (strncmp(node_p->segment_p,
+                               path_p,
+                               node_p->length) == 0)) {
+            route_index_search(self_p, child, path_end_p, match_p);
+        }
+
+        child = node_p->sibling;
+    }
+}
+
+#endif
+
+/**
+ * Search for the first route matching given request and return its
+ * callback. Path parameters are saved in the request.
+ */
+static http_server_route_callback_t
+find_route_callback(struct http_server_t *self_p,
+                    struct http_server_request_t *request_p)
+{
+    const struct http_server_route_t *route_p;
+    struct route_match_t match;
+    int i;
+    size_t size;
+
+    /* The query string is not part of the path. */
+    match.path_p = &request_p->path[0];
+    match.end_p = (match.path_p + strcspn(match.path_p, "?"));
+    match.action = request_p->action;
+    match.count = 0;
+    match.best.route = -1;
+    match.best.count = 0;
+
+#if CONFIG_HTTP_SERVER_ROUTE_NODES_MAX > 0
+    if (self_p->route_index.length != -1) {
+        if (match.path_p < match.end_p) {
+            route_index_search(self_p, 0, match.path_p, &match);
+        }
+    } else
+#endif
+    {
+        route_p = self_p->routes_p;
+
+        while (route_p->path_p != NULL) {
+            if (route_has_action(route_p, match.action)
+                && route_match(route_p->path_p, &match)) {
+                match.best.route = (route_p - self_p->routes_p);
+                match.best.count = match.count;
+                memcpy(&match.best.captures[0],
+                       &match.captures[0],
+                       sizeof(match.best.captures));
+                break;
+            }
+
+            route_p++;
+        }
+    }
+
+    if (match.best.route == -1) {
+        return (NULL);
+    }
+
+    /* Save captured path parameters in the request. */
+    request_p->params.length = MIN(match.best.count,
+                                   CONFIG_HTTP_SERVER_ROUTE_PARAMS_MAX);
+
+    for (i = 0; i < request_p->params.length; i++) {
+        size = MIN(match.best.captures[i].length,
+                   CONFIG_HTTP_SERVER_ROUTE_PARAM_SIZE - 1);
+        memcpy(&request_p->params.values[i][0],
+               &request_p->path[match.best.captures[i].offset],
+               size);
+        request_p->params.values[i][size] = '\0';
+    }
+
+    return (self_p->routes_p[match.best.route].callback);
+}
+
+static int handle_request(struct http_server_t *self_p,
+                          struct http_server_connection_t *connection_p,
+                          int requests)
+{
+    int res;
+    struct http_server_request_t request;
+    http_server_route_callback_t callback;
+
+    /* Read the HTTP request. */
+    res = read_request(self_p, connection_p, &request);
+
+    if (res != 0) {
+        /* Reply with a Bad Request if the header could not be read,
+           unless the client closed the connection. */
+        connection_p->keep_alive = 0;
+
+        if (res != -EIO) {
+            std_fprintf(connection_p->chan_p, bad_request_header);
+        }
+
+        return (res);
+    }
+
+    if (requests == CONFIG_HTTP_SERVER_KEEP_ALIVE_MAX_REQUESTS) {
+        connection_p->keep_alive = 0;
+    }
+
+    /* Find the callback for given path. */
+    callback = find_route_callback(self_p, &request);
+
+    if (callback == NULL) {
+        callback = self_p->on_no_route;
+    }
+
+    /* Call the callback and write the response if requested. */
+    res = callback(connection_p, &request);
+
+    if (res < 0) {
+        connection_p->keep_alive = 0;
+    }
+
+    return (res);
+}
+
+/**
+ * Wait for the next request on a persistent connection. Returns
+ * zero(0) when request data is available, and negative error code if
+ * the connection timed out or shall be closed to make room for a new
+ * client.
+ */
+static int wait_for_request(struct http_server_connection_t *connection_p)
+{
+    struct chan_list_t list;
+    struct chan_list_elem_t elements[2];
+    struct time_t timeout;
+    uint32_t mask;
+    void *chan_p;
+    int res;
+
+    /* Pipelined requests may already be buffered. */
+    if (chan_size(connection_p->chan_p) > 0) {
+        return (0);
+    }
+
+    sys_lock();
+    connection_p->state = http_server_connection_state_idle_t;
+    sys_unlock();
+
+    timeout.seconds = (CONFIG_HTTP_SERVER_KEEP_ALIVE_TIMEOUT_MS / 1000);
+    timeout.nanoseconds =
+        ((CONFIG_HTTP_SERVER_KEEP_ALIVE_TIMEOUT_MS % 1000) * 1000000);
+
+    chan_list_init(&list, &elements[0], membersof(elements));
+    chan_list_add(&list, &connection_p->socket);
+    chan_list_add(&list, &connection_p->events);
+    chan_p = chan_list_poll(&list, &timeout);
+    chan_list_destroy(&list);
+
+    res = -ETIMEDOUT;
+
+    if (chan_p == &connection_p->socket) {
+        res = 0;
+    } else if (chan_p == &connection_p->events) {
+        mask = 0x2;
+        event_read(&connection_p->events, &mask, sizeof(mask));
+        res = -ECONNRESET;
+    }
+
+    sys_lock();
+
+    /* The listener may have asked us to close while data arrived. */
+    if ((res == 0) && (event_size(&connection_p->events) > 0)) {
+        res = -ECONNRESET;
+    }
+
+    connection_p->state = http_server_connection_state_allocated_t;
+    sys_unlock();
+
+    return (res);
+}
+
+/**
+ * Serve requests on given connection until the client closes it,
+ * asks to close it, an error occurs or the keep-alive limits are
+ * reached.
+ */
+static void handle_connection(struct http_server_t *self_p,
+                              struct http_server_connection_t *connection_p)
+{
+    int requests;
+
+    requests = 0;
+
+    do {
+        requests++;
+        handle_request(self_p, connection_p, requests);
+
+        if (!connection_p->keep_alive) {
+            break;
+        }
+    } while (wait_for_request(connection_p) == 0);
+}
+
+/**
+ * Prepare given accepted connection for reading requests.
+ */
+static void connection_open(struct http_server_t *self_p,
+                            struct http_server_connection_t *connection_p)
+{
+#if CONFIG_HTTP_SERVER_SSL == 1
+    if (self_p->ssl_context_p != NULL) {
+        ssl_socket_open(&connection_p->ssl_socket,
+                        self_p->ssl_context_p,
+                        &connection_p->socket,
+                        SSL_SOCKET_SERVER_SIDE,
+                        NULL);
+    }
+#endif
+
+    connection_p->input.pos = 0;
+    connection_p->input.size = 0;
+}
+
+static void connection_close(struct http_server_t *self_p,
+                             struct http_server_connection_t *connection_p)
+{
+#if CONFIG_HTTP_SERVER_SSL == 1
+    if (self_p->ssl_context_p != NULL) {
+        (void)ssl_socket_close(&connection_p->ssl_socket);
+    }
+#endif
+
+    (void)socket_close(&connection_p->socket);
+}
+
+/**
+ * Setup the channels of given connection.
+ */
+static void connection_init_chan(struct http_server_t *self_p,
+                                 struct http_server_connection_t *connection_p)
+{
+#if CONFIG_HTTP_SERVER_SSL == 1
+    if (self_p->ssl_context_p == NULL) {
+        connection_p->input.chan_p = &connection_p->socket;
+    } else {
+        connection_p->input.chan_p = &connection_p->ssl_socket;
+    }
+#else
+    connection_p->input.chan_p = &connection_p->socket;
+#endif
+
+    chan_init(&connection_p->input.base,
+              input_read_chan,
+              input_write_chan,
+              input_size_chan);
+    connection_p->chan_p = &connection_p->input.base;
+}
+
+/**
+ * The connection thread serves a client for the duration of the
+ * socket lifetime.
+ */
+static void *connection_main(void *arg_p)
+{
+    struct http_server_connection_t *connection_p = arg_p;
+    struct http_server_t *self_p = connection_p->self_p;
+    uint32_t mask;
+
+    /* thrd_init_env(buf, sizeof(buf)); */
+    /* thrd_set_env("CWD", self_p->root_path_p); */
+    thrd_set_name(connection_p->thrd.name_p);
+
+    /* Wait for a connection from the listener. */
+    while (1) {
+        log_object_print(NULL,
+                         LOG_DEBUG,
+                         OSTR("Connection thread '%s' waiting for a new connection.\r\n"),
+                         thrd_get_name());
+
+        mask = 0x1;
+        event_read(&connection_p->events, &mask, sizeof(mask));
+
+        if (mask & 0x1) {
+            connection_open(self_p, connection_p);
+            event_clear(&connection_p->events, 0x2);
+            handle_connection(self_p, connection_p);
+            connection_close(self_p, connection_p);
+
+            /* Add thread to the free list. */
+            sys_lock();
+            connection_p->state = http_server_connection_state_free_t;
+            sys_unlock();
+            mask = 0x1;
+            event_write(&self_p->events, &mask, sizeof(mask));
+        }
+    }
+
+    return (NULL);
+}
+
+static int handle_accept(struct http_server_t *self_p,
+                         struct http_server_connection_t *connection_p)
+{
+    uint32_t mask;
+
+    mask = 0x1;
+    event_write(&connection_p->events, &mask, sizeof(mask));
+
+    return (0);
+}
+
+/**
+ * Ask the first idle persistent connection to close.
+ */
+static void close_idle_connection(struct http_server_t *self_p)
+{
+    uint32_t mask;
+    struct http_server_connection_t *connection_p;
+
+    sys_lock();
+
+    connection_p = self_p->connections_p;
+
+    while (connection_p->thrd.stack.buf_p != NULL) {
+        if (connection_p->state == http_server_connection_state_idle_t) {
+            mask = 0x2;
+            event_write_isr(&connection_p->events, &mask, sizeof(mask));
+            break;
+        }
+
+        connection_p++;
+    }
+
+    sys_unlock();
+}
+
+static struct http_server_connection_t *
+allocate_connection(struct http_server_t *self_p)
+{
+    uint32_t mask;
+    struct http_server_connection_t *connection_p;
+    struct chan_list_t list;
+    struct chan_list_elem_t elements[2];
+
+    while (1) {
+        sys_lock();
+
+        connection_p = self_p->connections_p;
+
+        while (connection_p->thrd.stack.buf_p != NULL) {
+            if (connection_p->state == http_server_connection_state_free_t) {
+                connection_p->state = http_server_connection_state_allocated_t;
+                break;
+            }
+
+            connection_p++;
+        }
+
+        sys_unlock();
+
+        /* Connection available. */
+        if (connection_p->thrd.name_p != NULL) {
+            break;
+        }
+
+        /* Close an idle persistent connection if a client is waiting
+           to be accepted, and wait for it to be freed. Otherwise wait
+           for a connection to be freed or a client to connect. */
+        if (chan_size(&self_p->listener_p->socket) > 0) {
+            close_idle_connection(self_p);
+            mask = 0x1;
+            event_read(&self_p->events, &mask, sizeof(mask));
+        } else {
+            chan_list_init(&list, &elements[0], membersof(elements));
+            chan_list_add(&list, &self_p->listener_p->socket);
+            chan_list_add(&list, &self_p->events);
+
+            if (chan_list_poll(&list, NULL) == &self_p->events) {
+                mask = 0x1;
+                event_read(&self_p->events, &mask, sizeof(mask));
+            }
+
+            chan_list_destroy(&list);
+        }
+    }
+
+    return (connection_p);
+}
+
+/**
+ * Open the listener socket and start listening for connections.
+ */
+static int listener_open(struct http_server_listener_t *listener_p)
+{
+    struct inet_addr_t addr;
+
+    if (socket_open_tcp(&listener_p->socket) != 0) {
+        log_object_print(NULL,
+                         LOG_ERROR,
+                         OSTR("failed to open socket\r\n"));
+        return (-1);
+    }
+
+    if (inet_aton(listener_p->address_p, &addr.ip) != 0) {
+        return (-EINVAL);
+    }
+
+    addr.port = listener_p->port;
+
+    if (socket_bind(&listener_p->socket, &addr) != 0) {
+        log_object_print(NULL,
+                         LOG_ERROR,
+                         OSTR("failed to bind socket\r\n"));
+        return (-1);
+    }
+
+    if (socket_listen(&listener_p->socket, 3) != 0) {
         log_object_print(NULL,
                          LOG_ERROR,
                          OSTR("failed to listen on socket\r\n"));
+        return (-1);
+    }
+
+    log_object_print(NULL,
+                     LOG_INFO,
+                     OSTR("serving HTTP on %s:%u\r\n"),
+                     listener_p->address_p,
+                     listener_p->port);
+
+    return (0);
+}
+
+/**
+ * The listener thread main function. The listener listens for
+ * connections from clients.
+ */
+static void *listener_main(void *arg_p)
+{
+    struct http_server_t *self_p = arg_p;
+    struct http_server_listener_t *listener_p;
+    struct http_server_connection_t *connection_p;
+    struct inet_addr_t addr;
+
+    thrd_set_name(self_p->listener_p->thrd.name_p);
+
+    listener_p = self_p->listener_p;
+
+    if (listener_open(listener_p) != 0) {
         return (NULL);
     }
 
-    log_object_print(NULL,
-                     LOG_INFO,
-                     OSTR("serving HTTP on %s:%u\r\n"),
-                     listener_p->address_p,
-                     listener_p->port);
+    /* Wait for clients to connect. */
+    while (1) {
+        /* Allocate a connection. */
+        connection_p = allocate_connection(self_p);
+
+        /* Wait for a client to connect. */
+        socket_accept(&listener_p->socket,
+                      &connection_p->socket,
+                      &addr);
+
+        handle_accept(self_p, connection_p);
+    }
+
+    return (NULL);
+}
+
+#if CONFIG_CHAN_POLLSET == 1
+
+static void reactor_connection_close(struct http_server_t *self_p,
+                                     struct http_server_connection_t *connection_p)
+{
+    reactor_chan_remove(self_p->reactor.reactor_p, &connection_p->reactor.chan);
+    reactor_timer_stop(&connection_p->reactor.keep_alive_timer);
+    connection_close(self_p, connection_p);
+    connection_p->state = http_server_connection_state_free_t;
+
+    /* Accept clients waiting for a free connection. */
+    if (!self_p->reactor.listener_added) {
+        reactor_chan_add(self_p->reactor.reactor_p, &self_p->reactor.listener);
+        self_p->reactor.listener_added = 1;
+    }
+}
+
+/**
+ * Find a free connection, or close the first idle persistent
+ * connection to make room for a new client.
+ */
+static struct http_server_connection_t *
+reactor_allocate_connection(struct http_server_t *self_p)
+{
+    struct http_server_connection_t *connection_p;
+    struct http_server_connection_t *idle_p;
+
+    idle_p = NULL;
+    connection_p = self_p->connections_p;
+
+    while (connection_p->thrd.name_p != NULL) {
+        if (connection_p->state == http_server_connection_state_free_t) {
+            return (connection_p);
+        }
+
+        if ((idle_p == NULL)
+            && (connection_p->state == http_server_connection_state_idle_t)) {
+            idle_p = connection_p;
+        }
+
+        connection_p++;
+    }
+
+    if (idle_p != NULL) {
+        reactor_connection_close(self_p, idle_p);
+    }
+
+    return (idle_p);
+}
+
+/**
+ * Called when a client is waiting to be accepted.
+ */
+static void on_reactor_accept(void *arg_p)
+{
+    struct http_server_t *self_p;
+    struct http_server_connection_t *connection_p;
+    struct inet_addr_t addr;
+
+    self_p = arg_p;
+    connection_p = reactor_allocate_connection(self_p);
+
+    /* Wait for a connection to be closed. */
+    if (connection_p == NULL) {
+        reactor_chan_remove(self_p->reactor.reactor_p,
+                            &self_p->reactor.listener);
+        self_p->reactor.listener_added = 0;
+
+        return;
+    }
+
+    socket_accept(&self_p->listener_p->socket, &connection_p->socket, &addr);
+    connection_p->state = http_server_connection_state_allocated_t;
+    connection_p->reactor.requests = 0;
+    connection_open(self_p, connection_p);
+    reactor_chan_add(self_p->reactor.reactor_p, &connection_p->reactor.chan);
+}
 
-    /* Wait for clients to connect. */
-    while (1) {
-        /* Allocate a connection. */
-        connection_p = allocate_connection(self_p);
+/**
+ * Called when there is request data on given connection.
+ */
+static void on_reactor_request(void *arg_p)
+{
+    struct http_server_t *self_p;
+    struct http_server_connection_t *connection_p;
 
-        /* Wait for a client to connect. */
-        socket_accept(&listener_p->socket,
-                      &connection_p->socket,
-                      &addr);
+    connection_p = arg_p;
+    self_p = connection_p->self_p;
+    reactor_timer_stop(&connection_p->reactor.keep_alive_timer);
+    connection_p->state = http_server_connection_state_allocated_t;
 
-        handle_accept(self_p, connection_p);
+    /* Pipelined requests may already be buffered. */
+    do {
+        connection_p->reactor.requests++;
+        handle_request(self_p, connection_p, connection_p->reactor.requests);
+
+        if (!connection_p->keep_alive) {
+            reactor_connection_close(self_p, connection_p);
+
+            return;
+        }
+    } while (input_size(connection_p) > 0);
+
+    connection_p->state = http_server_connection_state_idle_t;
+    reactor_timer_start(&connection_p->reactor.keep_alive_timer);
+}
+
+static void on_reactor_keep_alive_timeout(void *arg_p)
+{
+    struct http_server_connection_t *connection_p;
+
+    connection_p = arg_p;
+    reactor_connection_close(connection_p->self_p, connection_p);
+}
+
+#endif
+
+/**
+ * Content types of file system files by file name extension.
+ */
+static const struct {
+    const char *extension_p;
+    const char *content_type_p;
+} content_types[] = {
+    { ".html", "text/html" },
+    { ".htm", "text/html" },
+    { ".css", "text/css" },
+    { ".js", "application/javascript" },
+    { ".json", "application/json" },
+    { ".txt", "text/plain" },
+    { ".svg", "image/svg+xml" },
+    { ".png", "image/png" },
+    { ".jpg", "image/jpeg" },
+    { ".ico", "image/x-icon" },
+    { NULL, "application/octet-stream" }
+};
+
+static const char *get_content_type(const char *path_p, size_t length)
+{
+    int i;
+    size_t extension_length;
+
+    for (i = 0; content_types[i].extension_p != NULL; i++) {
+        extension_length = strlen(content_types[i].extension_p);
+
+        if ((length >= extension_length)
+            && (strncmp(&path_p[length - extension_length],
+                        content_types[i].extension_p,
+                        extension_length) == 0)) {
+            break;
+        }
+    }
+
+    return (content_types[i].content_type_p);
+}
+
+static const struct http_server_static_file_t *
+find_static_file(struct http_server_t *self_p,
+                 const char *path_p,
+                 size_t length,
+                 int gzip)
+{
+    const struct http_server_static_file_t *file_p;
+
+    file_p = self_p->static_files_p;
+
+    if (file_p == NULL) {
+        return (NULL);
+    }
+
+    while (file_p->path_p != NULL) {
+        if ((strncmp(file_p->path_p, path_p, length) == 0)
+            && (file_p->path_p[length] == '\0')) {
+            if (gzip || !(file_p->flags & HTTP_SERVER_STATIC_FILE_GZIP)) {
+                return (file_p);
+            }
+        }
+
+        file_p++;
     }
 
     return (NULL);
 }
 
+/**
+ * Write a static file response header. Give size as
+ * CONTENT_LENGTH_CHUNKED for chunked transfer encoding, and
+ * CONTENT_LENGTH_NONE for a response without content.
+ */
+static int write_static_header(struct http_server_connection_t *connection_p,
+                               const char *status_p,
+                               const char *content_type_p,
+                               ssize_t size,
+                               int flags,
+                               const char *etag_p)
+{
+    char buf[192];
+    char *buf_p;
+    size_t length;
+
+    /* Make sure the header fits in the buffer. */
+    length = strlen(status_p);
+
+    if (content_type_p != NULL) {
+        length += strlen(content_type_p);
+    }
+
+    if (etag_p != NULL) {
+        length += strlen(etag_p);
+    }
+
+    if (length > 64) {
+        return (-E2BIG);
+    }
+
+    buf_p = &buf[0];
+    buf_p += std_sprintf(buf_p, FSTR("HTTP/1.1 %s\r\n"), status_p);
+
+    if (content_type_p != NULL) {
+        buf_p += std_sprintf(buf_p, FSTR("Content-Type: %s\r\n"), content_type_p);
+    }
+
+    if (size == CONTENT_LENGTH_CHUNKED) {
+        buf_p += std_sprintf(buf_p, FSTR("Transfer-Encoding: chunked\r\n"));
+    } else if (size >= 0) {
+        buf_p += std_sprintf(buf_p, FSTR("Content-Length: %lu\r\n"), (unsigned long)size);
+    }
+
+    if (flags & HTTP_SERVER_STATIC_FILE_GZIP) {
+        buf_p += std_sprintf(buf_p, FSTR("Content-Encoding: gzip\r\n"));
+    }
+
+    if (etag_p != NULL) {
+        buf_p += std_sprintf(buf_p, FSTR("ETag: %s\r\n"), etag_p);
+    }
+
+    if (!connection_p->keep_alive) {
+        buf_p += std_sprintf(buf_p, FSTR("Connection: close\r\n"));
+    }
+
+    buf_p += std_sprintf(buf_p, FSTR("\r\n"));
+    length = (buf_p - &buf[0]);
+
+    if (chan_write(connection_p->chan_p, &buf[0], length) != length) {
+        return (-EIO);
+    }
+
+    return (0);
+}
+
+/**
+ * Write given static file directly from its buffer, or only the
+ * header if the client already has it.
+ */
+static int write_static_file(struct http_server_connection_t *connection_p,
+                             struct http_server_request_t *request_p,
+                             const struct http_server_static_file_t *file_p)
+{
+    int res;
+
+    if ((file_p->etag_p != NULL)
+        && (request_p->headers.if_none_match.present == 1)
+        && (strcmp(request_p->headers.if_none_match.value,
+                   file_p->etag_p) == 0)) {
+        return (write_static_header(connection_p,
+                                    "304 Not Modified",
+                                    NULL,
+                                    CONTENT_LENGTH_NONE,
+                                    0,
+                                    file_p->etag_p));
+    }
+
+    res = write_static_header(connection_p,
+                              "200 OK",
+                              file_p->content_type_p,
+                              file_p->size,
+                              file_p->flags,
+                              file_p->etag_p);
+
+    if (res != 0) {
+        return (res);
+    }
+
+    if (file_p->size > 0) {
+        if (chan_write(connection_p->chan_p,
+                       file_p->buf_p,
+                       file_p->size) != file_p->size) {
+            return (-EIO);
+        }
+    }
+
+    return (0);
+}
+
+/**
+ * Write given chunk of given size using chunked transfer
+ * encoding. The data starts at offset 8 in given buffer, and there
+ * must be room for two more bytes after it, so the chunk is written
+ * with a single channel write.
+ */
+static int write_chunk(void *chan_p, char *buf_p, size_t size)
+{
+    char header[8];
+    size_t header_length;
+
+    header_length = std_sprintf(&header[0], FSTR("%x\r\n"), (int)size);
+    memcpy(&buf_p[8 - header_length], &header[0], header_length);
+    buf_p[8 + size] = '\r';
+    buf_p[8 + size + 1] = '\n';
+    size += (header_length + 2);
+
+    if (chan_write(chan_p, &buf_p[8 - header_length], size) != size) {
+        return (-EIO);
+    }
+
+    return (0);
+}
+
+/**
+ * Stream given file from the file system root path using chunked
+ * transfer encoding. Prefer the gzip compressed file if accepted by
+ * the client.
+ */
+static int write_fs_file(struct http_server_connection_t *connection_p,
+                         const char *path_p,
+                         size_t length,
+                         int gzip)
+{
+    struct fs_file_t file;
+    char buf[8 + CONFIG_HTTP_SERVER_STATIC_CHUNK_SIZE + 2];
+    const char *root_path_p;
+    size_t root_length;
+    ssize_t size;
+    int flags;
+    int res;
+
+    root_path_p = connection_p->self_p->root_path_p;
+    root_length = strlen(root_path_p);
+
+    /* Do not give access to files outside the root path. */
+    if (strstr(path_p, "..") != NULL) {
+        return (-ENOENT);
+    }
+
+    /* Root path, request path and ".gz" in the buffer. */
+    if (root_length + length + 4 > sizeof(buf)) {
+        return (-ENOENT);
+    }
+
+    memcpy(&buf[0], root_path_p, root_length);
+    memcpy(&buf[root_length], path_p, length);
+    strcpy(&buf[root_length + length], ".gz");
+    res = -1;
+    flags = 0;
+
+    if (gzip) {
+        res = fs_open(&file, &buf[0], FS_READ);
+
+        if (res == 0) {
+            flags = HTTP_SERVER_STATIC_FILE_GZIP;
+        }
+    }
+
+    if (res != 0) {
+        buf[root_length + length] = '\0';
+
+        if (fs_open(&file, &buf[0], FS_READ) != 0) {
+            return (-ENOENT);
+        }
+    }
+
+    res = write_static_header(connection_p,
+                              "200 OK",
+                              get_content_type(path_p, length),
+                              CONTENT_LENGTH_CHUNKED,
+                              flags,
+                              NULL);
+
+    while (res == 0) {
+        size = fs_read(&file, &buf[8], CONFIG_HTTP_SERVER_STATIC_CHUNK_SIZE);
+
+        if (size < 0) {
+            res = -EIO;
+            break;
+        }
+
+        if (size == 0) {
+            if (chan_write(connection_p->chan_p, "0\r\n\r\n", 5) != 5) {
+                res = -EIO;
+            }
+
+            break;
+        }
+
+        res = write_chunk(connection_p->chan_p, &buf[0], size);
+    }
+
+    fs_close(&file);
+
+    return (res);
+}
+
+/**
+ * Channel writing the data written to it in chunks of at most
+ * CONFIG_HTTP_SERVER_STATIC_CHUNK_SIZE bytes, for responses of
+ * unknown size.
+ */
+struct chunked_output_t {
+    struct chan_t base;
+    void *chan_p;
+    size_t size;
+    int res;
+    char buf[8 + CONFIG_HTTP_SERVER_STATIC_CHUNK_SIZE + 2];
+};
+
+static ssize_t chunked_output_write(void *arg_p,
+                                    const void *buf_p,
+                                    size_t size)
+{
+    struct chunked_output_t *self_p;
+    const char *b_p;
+    size_t left;
+    size_t n;
+
+    self_p = arg_p;
+    b_p = buf_p;
+    left = size;
+
+    while ((left > 0) && (self_p->res == 0)) {
+        n = MIN(left, CONFIG_HTTP_SERVER_STATIC_CHUNK_SIZE - self_p->size);
+        memcpy(&self_p->buf[8 + self_p->size], b_p, n);
+        self_p->size += n;
+        b_p += n;
+        left -= n;
+
+        if (self_p->size == CONFIG_HTTP_SERVER_STATIC_CHUNK_SIZE) {
+            self_p->res = write_chunk(self_p->chan_p,
+                                      &self_p->buf[0],
+                                      self_p->size);
+            self_p->size = 0;
+        }
+    }
+
+    return (self_p->res == 0 ? size : self_p->res);
+}
+
+/**
+ * Write the last data chunk, if any, and the zero size terminating
+ * chunk.
+ */
+static int chunked_output_finish(struct chunked_output_t *self_p)
+{
+    if ((self_p->res == 0) && (self_p->size > 0)) {
+        self_p->res = write_chunk(self_p->chan_p,
+                                  &self_p->buf[0],
+                                  self_p->size);
+    }
+
+    if (self_p->res == 0) {
+        if (chan_write(self_p->chan_p, "0\r\n\r\n", 5) != 5) {
+            self_p->res = -EIO;
+        }
+    }
+
+    return (self_p->res);
+}
+
 int http_server_init(struct http_server_t *self_p,
                      struct http_server_listener_t *listener_p,
                      struct http_server_connection_t *connections_p,
@@ -474,6 +1732,11 @@ int http_server_init(struct http_server_t *self_p,
     self_p->routes_p = routes_p;
     self_p->on_no_route = on_no_route;
     self_p->ssl_context_p = NULL;
+    self_p->static_files_p = NULL;
+
+#if CONFIG_HTTP_SERVER_ROUTE_NODES_MAX > 0
+    route_index_build(self_p);
+#endif
 
     connection_p = self_p->connections_p;
 
@@ -523,16 +1786,7 @@ int http_server_start(struct http_server_t *self_p)
 
     /* Spawn the connection threads. */
     while (connection_p->thrd.stack.buf_p != NULL) {
-#if CONFIG_HTTP_SERVER_SSL == 1
-        if (self_p->ssl_context_p == NULL) {
-            connection_p->chan_p = &connection_p->socket;
-        } else {
-            connection_p->chan_p = &connection_p->ssl_socket;
-        }
-#else
-        connection_p->chan_p = &connection_p->socket;
-#endif
-
+        connection_init_chan(self_p, connection_p);
         connection_p->thrd.id_p =
             thrd_spawn(connection_main,
                        connection_p,
@@ -546,6 +1800,63 @@ int http_server_start(struct http_server_t *self_p)
     return (0);
 }
 
+#if CONFIG_CHAN_POLLSET == 1
+
+int http_server_reactor_start(struct http_server_t *self_p,
+                              struct reactor_t *reactor_p)
+{
+    ASSERTN(self_p != NULL, EINVAL);
+    ASSERTN(reactor_p != NULL, EINVAL);
+
+    struct http_server_connection_t *connection_p;
+    struct time_t timeout;
+    int res;
+
+    res = listener_open(self_p->listener_p);
+
+    if (res != 0) {
+        return (res);
+    }
+
+    timeout.seconds = (CONFIG_HTTP_SERVER_KEEP_ALIVE_TIMEOUT_MS / 1000);
+    timeout.nanoseconds =
+        ((CONFIG_HTTP_SERVER_KEEP_ALIVE_TIMEOUT_MS % 1000) * 1000000);
+
+    connection_p = self_p->connections_p;
+
+    while (connection_p->thrd.name_p != NULL) {
+        connection_init_chan(self_p, connection_p);
+        reactor_chan_init(&connection_p->reactor.chan,
+                          &connection_p->socket,
+                          on_reactor_request,
+                          connection_p);
+        reactor_timer_init(&connection_p->reactor.keep_alive_timer,
+                           reactor_p,
+                           &timeout,
+                           on_reactor_keep_alive_timeout,
+                           connection_p,
+                           0);
+        connection_p++;
+    }
+
+    self_p->reactor.reactor_p = reactor_p;
+    reactor_chan_init(&self_p->reactor.listener,
+                      &self_p->listener_p->socket,
+                      on_reactor_accept,
+                      self_p);
+    res = reactor_chan_add(reactor_p, &self_p->reactor.listener);
+
+    if (res != 0) {
+        return (res);
+    }
+
+    self_p->reactor.listener_added = 1;
+
+    return (0);
+}
+
+#endif
+
 int http_server_stop(struct http_server_t *self_p)
 {
     ASSERTN(self_p != NULL, EINVAL);
@@ -563,8 +1874,9 @@ int http_server_response_write(struct http_server_connection_t *connection_p,
 
     int res = 0;
     ssize_t size;
-    char buf[128];
+    char buf[160];
     char *content_type_p;
+    char *connection_header_p;
 
     /* Set content type. */
     if (response_p->content.type == http_server_content_type_text_plain_t) {
@@ -576,22 +1888,33 @@ int http_server_response_write(struct http_server_connection_t *connection_p,
         return (-1);
     }
 
+    /* Tell the client when the connection will be closed after this
+       response. */
+    if (connection_p->keep_alive) {
+        connection_header_p = "";
+    } else {
+        connection_header_p = "Connection: close\r\n";
+    }
+
     /* Write the header. */
     if (response_p->code == http_server_response_code_200_ok_t) {
         size = std_sprintf(buf,
                            ok_fmt,
                            content_type_p,
-                           response_p->content.size);
+                           response_p->content.size,
+                           connection_header_p);
     } else if (response_p->code == http_server_response_code_401_unauthorized_t) {
         size = std_sprintf(buf,
                            unauthorized_fmt,
                            content_type_p,
-                           response_p->content.size);
+                           response_p->content.size,
+                           connection_header_p);
     } else {
         size = std_sprintf(buf,
                            not_found_fmt,
                            content_type_p,
-                           response_p->content.size);
+                           response_p->content.size,
+                           connection_header_p);
     }
 
     res = chan_write(connection_p->chan_p, buf, size);
@@ -615,3 +1938,101 @@ int http_server_response_write(struct http_server_connection_t *connection_p,
 
     return (res);
 }
+
+int http_server_set_static_files(struct http_server_t *self_p,
+                                 const struct http_server_static_file_t *files_p)
+{
+    ASSERTN(self_p != NULL, EINVAL);
+    ASSERTN(files_p != NULL, EINVAL);
+
+    self_p->static_files_p = files_p;
+
+    return (0);
+}
+
+int http_server_route_static(struct http_server_connection_t *connection_p,
+                             struct http_server_request_t *request_p)
+{
+    ASSERTN(connection_p != NULL, EINVAL);
+    ASSERTN(request_p != NULL, EINVAL);
+
+    struct http_server_t *self_p;
+    const struct http_server_static_file_t *file_p;
+    struct http_server_response_t response;
+    size_t length;
+    int gzip;
+    int res;
+
+    self_p = connection_p->self_p;
+
+    if (request_p->action == http_server_request_action_get_t) {
+        /* The query string is not part of the file path. */
+        length = strcspn(request_p->path, "?");
+        gzip = ((request_p->headers.accept_encoding.present == 1)
+                && (strstr(request_p->headers.accept_encoding.value,
+                           "gzip") != NULL));
+
+        file_p = find_static_file(self_p, request_p->path, length, gzip);
+
+        if (file_p != NULL) {
+            return (write_static_file(connection_p, request_p, file_p));
+        }
+
+        if (self_p->root_path_p != NULL) {
+            res = write_fs_file(connection_p, request_p->path, length, gzip);
+
+            if (res != -ENOENT) {
+                return (res);
+            }
+        }
+    }
+
+    if (self_p->on_no_route != http_server_route_static) {
+        return (self_p->on_no_route(connection_p, request_p));
+    }
+
+    response.code = http_server_response_code_404_not_found_t;
+    response.content.type = http_server_content_type_text_plain_t;
+    response.content.buf_p = "Not Found";
+    response.content.size = 9;
+
+    return (http_server_response_write(connection_p, request_p, &response));
+}
+
+int http_server_route_metrics(struct http_server_connection_t *connection_p,
+                              struct http_server_request_t *request_p)
+{
+    ASSERTN(connection_p != NULL, EINVAL);
+    ASSERTN(request_p != NULL, EINVAL);
+
+    struct chunked_output_t output;
+    int res;
+
+    res = write_static_header(connection_p,
+                              "200 OK",
+                              "application/openmetrics-text; version=1.0.0; charset=utf-8",
+                              CONTENT_LENGTH_CHUNKED,
+                              0,
+                              NULL);
+
+    if (res != 0) {
+        return (res);
+    }
+
+    chan_init(&output.base,
+              chan_read_null,
+              chunked_output_write,
+              chan_size_null);
+    output.chan_p = connection_p->chan_p;
+    output.size = 0;
+    output.res = 0;
+
+    /* Written directly from the registries. Statistics disabled in
+       the configuration are left out. */
+    fs_counters_print_openmetrics(&output);
+    thrd_print_openmetrics(&output);
+    heap_print_openmetrics(&output);
+    std_fprintf(&output, OSTR("# EOF\n"));
+
+    return (chunked_output_finish(&output));
+}
@@ -31,6 +31,19 @@
 
 #include "simba.h"
 
+/**
+ * The static file content is gzip compressed.
+ */
+#define HTTP_SERVER_STATIC_FILE_GZIP                        0x1
+
+/**
+ * Route action masks. A route without actions matches all actions.
+ */
+#define HTTP_SERVER_ROUTE_GET                                 \
+    (1 << http_server_request_action_get_t)
+#define HTTP_SERVER_ROUTE_POST                                \
+    (1 << http_server_request_action_post_t)
+
 /**
  * Request action types.
  */
@@ -52,6 +65,7 @@ enum http_server_content_type_t {
  */
 enum http_server_response_code_t {
     http_server_response_code_200_ok_t = 200,
+    http_server_response_code_304_not_modified_t = 304,
     http_server_response_code_400_bad_request_t = 400,
     http_server_response_code_401_unauthorized_t = 401,
     http_server_response_code_404_not_found_t = 404
@@ -62,7 +76,9 @@ enum http_server_response_code_t {
  */
 enum http_server_connection_state_t {
     http_server_connection_state_free_t = 0,
-    http_server_connection_state_allocated_t
+    http_server_connection_state_allocated_t,
+    /* Waiting for the next request on a persistent connection. */
+    http_server_connection_state_idle_t
 };
 
 /**
@@ -92,7 +108,30 @@ struct http_server_request_t {
             int present;
             char value[20];
         } expect;
+        struct {
+            int present;
+            char value[16];
+        } connection;
+        struct {
+            int present;
+            char value[24];
+        } if_none_match;
+        struct {
+            int present;
+            char value[32];
+        } accept_encoding;
+        struct {
+            int present;
+            char value[96];
+        } sec_websocket_extensions;
     } headers;
+    /* Path parameter values captured by the matched route, in the
+       order they appear in the route path. */
+    struct {
+        int length;
+        char values[CONFIG_HTTP_SERVER_ROUTE_PARAMS_MAX]
+                   [CONFIG_HTTP_SERVER_ROUTE_PARAM_SIZE];
+    } params;
 };
 
 /**
@@ -143,25 +182,107 @@ struct http_server_connection_t {
     struct ssl_socket_t ssl_socket;
 #endif
     void *chan_p;
+    /* Read-ahead buffer wrapping the socket channel. All reads from
+       chan_p go through this buffer. */
+    struct {
+        struct chan_t base;
+        void *chan_p;
+        char buf[CONFIG_HTTP_SERVER_READ_AHEAD_SIZE];
+        size_t pos;
+        size_t size;
+    } input;
+    /* Keep the connection open after the current request. */
+    int keep_alive;
     struct event_t events;
+#if CONFIG_CHAN_POLLSET == 1
+    struct {
+        struct reactor_chan_t chan;
+        struct reactor_timer_t keep_alive_timer;
+        int requests;
+    } reactor;
+#endif
 };
 
 /**
  * Call given callback for given path.
+ *
+ * The path is a sequence of ``/`` separated segments. A segment
+ * written as ``{name}`` is a path parameter matching any segment,
+ * which is copied to the request ``params`` member. A path ending
+ * with ``/`` matches all paths below it, while other paths must match
+ * the whole request path, except the query string. The first
+ * matching route in the routes array is called.
+ *
+ * The callback must read the complete request body, if any, as the
+ * connection may be kept open for the next request. The connection
+ * is closed if the callback returns a negative error code.
  */
 struct http_server_route_t {
     const char *path_p;
     http_server_route_callback_t callback;
+    /* Zero or more of HTTP_SERVER_ROUTE_*, or zero for all
+       actions. */
+    int actions;
+};
+
+/**
+ * A path segment in the route index.
+ */
+struct http_server_route_node_t {
+    const char *segment_p;
+    uint8_t length;
+    uint8_t is_param;
+    int16_t child;
+    int16_t sibling;
+    /* Index of the first route ending at this node, or -1. */
+    int16_t route;
+    /* Index of the first route ending with a '/' at this node, or
+       -1. */
+    int16_t prefix_route;
+};
+
+/**
+ * A static file served by `http_server_route_static()`, typically
+ * generated at build time by ``bin/http_static.py``. The content is
+ * written to the socket directly from given buffer, which may be in
+ * flash.
+ */
+struct http_server_static_file_t {
+    /* Request path, or NULL for the last file in the array. */
+    const char *path_p;
+    const char *content_type_p;
+    /* Quoted entity tag, or NULL. */
+    const char *etag_p;
+    /* Zero or more of HTTP_SERVER_STATIC_FILE_*. */
+    int flags;
+    const void *buf_p;
+    size_t size;
 };
 
 struct http_server_t {
     const char *root_path_p;
     const struct http_server_route_t *routes_p;
+    const struct http_server_static_file_t *static_files_p;
     http_server_route_callback_t on_no_route;
     struct http_server_listener_t *listener_p;
     struct http_server_connection_t *connections_p;
     struct ssl_context_t *ssl_context_p;
     struct event_t events;
+#if CONFIG_CHAN_POLLSET == 1
+    struct {
+        struct reactor_t *reactor_p;
+        struct reactor_chan_t listener;
+        int listener_added;
+    } reactor;
+#endif
+#if CONFIG_HTTP_SERVER_ROUTE_NODES_MAX > 0
+    /* Routes trie built by http_server_init(). Not used if length is
+       -1. */
+    struct {
+        struct http_server_route_node_t nodes[CONFIG_HTTP_SERVER_ROUTE_NODES_MAX];
+        int length;
+    } route_index;
+#endif
 };
 
 /**
@@ -171,7 +292,8 @@ struct http_server_t {
  * @param[in] self_p Http server to initialize.
  * @param[in] listener_p Listener.
  * @param[in] connections_p A NULL terminated list of connections.
- * @param[in] root_path_p Working directory for the connection threads.
+ * @param[in] root_path_p File system directory of files served by
+ *                        `http_server_route_static()`, or NULL.
  * @param[in] routes_p An array of routes.
  * @param[in] on_no_route Callback called for all requests without a
  *                        matching route in route_p.
@@ -199,6 +321,62 @@ int http_server_init(struct http_server_t *self_p,
 int http_server_wrap_ssl(struct http_server_t *self_p,
                          struct ssl_context_t *context_p);
 
+/**
+ * Set the array of static files served by
+ * `http_server_route_static()`. The files are searched before the
+ * file system root path.
+ *
+ * @param[in] self_p Http server.
+ * @param[in] files_p An array of files, terminated by an entry with
+ *                    ``path_p`` set to NULL. If two entries have the
+ *                    same path, a gzip compressed one should come
+ *                    first, and is only served to clients accepting
+ *                    gzip.
+ *
+ * @return zero(0) or negative error code.
+ */
+int http_server_set_static_files(struct http_server_t *self_p,
+                                 const struct http_server_static_file_t *files_p);
+
+/**
+ * Route callback serving static files, first from the static files
+ * array and then from the file system root path given to
+ * `http_server_init()`. Add it to the routes array or use it as the
+ * no route callback.
+ *
+ * Static files from the array are written directly from their
+ * buffers, with ``ETag`` and ``If-None-Match`` support. File system
+ * files are streamed using chunked transfer encoding, and
+ * ``<path>.gz`` is served with ``Content-Encoding: gzip`` instead of
+ * ``<path>`` if present and accepted by the client.
+ *
+ * @param[in] connection_p Current connection.
+ * @param[in] request_p Current request.
+ *
+ * @return zero(0) or negative error code.
+ */
+int http_server_route_static(struct http_server_connection_t *connection_p,
+                             struct http_server_request_t *request_p);
+
+/**
+ * Route callback writing all registered file system counters, thread
+ * statistics and heap statistics in the OpenMetrics text format, for
+ * Prometheus compatible scrapers. Socket statistics are included as
+ * file system counters. Add it to the routes array, typically as
+ * ``/metrics``.
+ *
+ * The values are read directly from the registries and streamed
+ * using chunked transfer encoding, so the response size is not
+ * limited by any buffer.
+ *
+ * @param[in] connection_p Current connection.
+ * @param[in] request_p Current request.
+ *
+ * @return zero(0) or negative error code.
+ */
+int http_server_route_metrics(struct http_server_connection_t *connection_p,
+                              struct http_server_request_t *request_p);
+
 /**
  * Start given HTTP server.
  *
@@ -210,6 +388,28 @@ int http_server_wrap_ssl(struct http_server_t *self_p,
  */
 int http_server_start(struct http_server_t *self_p);
 
+/**
+ * Start given HTTP server in given reactor instead of in threads, so
+ * the number of connections is limited by RAM rather than by thread
+ * stacks. Start listening for connections, which are served by the
+ * thread running the reactor loop. The listener and connection
+ * thread stacks are not used and may be omitted.
+ *
+ * Route callbacks are called from the reactor loop, and a request is
+ * read and its response written without serving other connections
+ * and timers in between, so route callbacks must not block for long.
+ *
+ * Must be called before the reactor loop is started, or from the
+ * reactor loop. Only available if ``CONFIG_CHAN_POLLSET`` is 1.
+ *
+ * @param[in] self_p Http server.
+ * @param[in] reactor_p Reactor to serve the connections from.
+ *
+ * @return zero(0) or negative error code.
+ */
+int http_server_reactor_start(struct http_server_t *self_p,
+                              struct reactor_t *reactor_p);
+
 /**
  * Stop given HTTP server.
  *
@@ -28,12 +28,17 @@
 
 #include "simba.h"
 
-static int readline(struct http_websocket_client_t *self_p,
-                    const FAR char *expected_p,
-                    size_t size)
+/**
+ * Read a line, without the line ending, into given buffer. Characters
+ * not fitting in the buffer are dropped.
+ *
+ * @return Line length or negative error code.
+ */
+static ssize_t readline(struct http_websocket_client_t *self_p,
+                        char *buf_p,
+                        size_t size)
 {
-    int pos;
-    int match = 1;
+    size_t pos;
     char curr, prev;
 
     pos = 0;
@@ -52,30 +57,66 @@ static int readline(struct http_websocket_client_t *self_p,
             break;
         }
 
-        /* Compare the read byte to the expected byte. */
-        if (expected_p != NULL) {
-            if (pos < size) {
-                if (curr != expected_p[pos]) {
-                    match = 0;
-                }
-            }
+        if ((prev != '\0') && (pos < size - 1)) {
+            buf_p[pos++] = prev;
         }
 
         prev = curr;
-        pos++;
     }
 
-    if (match == 0) {
-        return (pos);
-    } else {
-        if ((pos - 1) == size) {
-            return (0);
+    buf_p[pos] = '\0';
+
+    return (pos);
+}
+
+#if CONFIG_HTTP_WEBSOCKET_DEFLATE == 1
+
+/**
+ * Compare given header field name to given lowercase reference name.
+ */
+static int is_name(const char *name_p, const char *reference_p)
+{
+    while (tolower((int)*name_p) == *reference_p) {
+        if (*name_p == '\0') {
+            return (1);
         }
+
+        name_p++;
+        reference_p++;
     }
 
-    return (-1);
+    return (0);
 }
 
+/**
+ * Enable compression if accepted by the server in given response
+ * header field.
+ */
+static int handle_header(struct http_websocket_client_t *self_p,
+                         char *line_p)
+{
+    char *value_p;
+
+    value_p = strchr(line_p, ':');
+
+    if (value_p == NULL) {
+        return (0);
+    }
+
+    *value_p++ = '\0';
+
+    if (!is_name(line_p, "sec-websocket-extensions")) {
+        return (0);
+    }
+
+    /* The connection fails if the server responds with an extension
+       that was not offered. */
+    return (http_websocket_deflate_client_accept(&self_p->deflate,
+                                                 value_p));
+}
+
+#endif
+
 int http_websocket_client_init(struct http_websocket_client_t *self_p,
                                const char *host_p,
                                int port,
@@ -89,6 +130,12 @@ int http_websocket_client_init(struct http_websocket_client_t *self_p,
     self_p->server.port = port;
     self_p->path_p = path_p;
 
+#if CONFIG_HTTP_WEBSOCKET_DEFLATE == 1
+    (void)http_websocket_deflate_init(&self_p->deflate,
+                                      &self_p->server.socket,
+                                      1);
+#endif
+
     return (0);
 }
 
@@ -96,14 +143,19 @@ int http_websocket_client_connect(struct http_websocket_client_t *self_p)
 {
     ASSERTN(self_p != NULL, EINVAL);
 
-    int res;
+    ssize_t res;
     struct inet_addr_t server_addr;
-
-    if (inet_aton(self_p->server.host_p, &server_addr.ip)  != 0) 
-    {
-        std_printf(FSTR("Bad ip address %s.\r\n"), self_p->server.host_p);
+#if CONFIG_HTTP_WEBSOCKET_DEFLATE == 1
+    char buf[160];
+#else
+    char buf[16];
+#endif
+
+    if (socket_gethostbyname(self_p->server.host_p, &server_addr.ip) != 0) {
+        std_printf(FSTR("Bad host %s.\r\n"), self_p->server.host_p);
         return (-1);
     }
+
     server_addr.port = self_p->server.port;
 
     /* Open a TCP socket and connect to the server. */
@@ -117,7 +169,24 @@ int http_websocket_client_connect(struct http_websocket_client_t *self_p)
         return (-EIO);
     }
 
+    self_p->frame.left = 0;
+
     /* Perform the handshake with the server. */
+#if CONFIG_HTTP_WEBSOCKET_DEFLATE == 1
+    self_p->frame.compressed = 0;
+    (void)http_websocket_deflate_offer(&self_p->deflate, &buf[0], sizeof(buf));
+    std_fprintf(&self_p->server.socket,
+                FSTR("GET %s HTTP/1.1\r\n"
+                     "Host: %s\r\n"
+                     "Upgrade: WebSocket\r\n"
+                     "Connection: Upgrade\r\n"
+                     "Origin: SimbaWebSocketClient\r\n"
+                     "Sec-WebSocket-Extensions: %s\r\n"
+                     "\r\n"),
+                self_p->path_p,
+                self_p->server.host_p,
+                &buf[0]);
+#else
     std_fprintf(&self_p->server.socket,
                 FSTR("GET %s HTTP/1.1\r\n"
                      "Host: %s\r\n"
@@ -127,23 +196,36 @@ int http_websocket_client_connect(struct http_websocket_client_t *self_p)
                      "\r\n"),
                 self_p->path_p,
                 self_p->server.host_p);
+#endif
 
     /* Expect a positive response. */
-    if (readline(self_p, FSTR("HTTP/1.1 101"), 12) != 0) {
+    res = readline(self_p, &buf[0], sizeof(buf));
+
+    if (res < 0) {
+        return (res);
+    }
+
+    if (strncmp(&buf[0], "HTTP/1.1 101", 12) != 0) {
         return (-1);
     }
 
     /* Find the empty line at the end of the message. */
     while (1) {
-        res = readline(self_p, FSTR(""), 0);
+        res = readline(self_p, &buf[0], sizeof(buf));
 
         if (res == 0) {
             break;
-        } else if (res > 0) {
-            continue;
-        } else {
+        } else if (res < 0) {
             return (res);
         }
+
+#if CONFIG_HTTP_WEBSOCKET_DEFLATE == 1
+        res = handle_header(self_p, &buf[0]);
+
+        if (res != 0) {
+            return (res);
+        }
+#endif
     }
 
     return (0);
@@ -165,9 +247,32 @@ ssize_t http_websocket_client_read(struct http_websocket_client_t *self_p,
     ASSERTN(size > 0, EINVAL);
 
     uint8_t buf[16];
+    uint8_t *u8_buf_p = buf_p;
     size_t left = size, n;
+#if CONFIG_HTTP_WEBSOCKET_DEFLATE == 1
+    ssize_t res;
+#endif
 
     while (left > 0) {
+#if CONFIG_HTTP_WEBSOCKET_DEFLATE == 1
+        /* Read decompressed message data. */
+        if (self_p->frame.compressed == 1) {
+            res = http_websocket_deflate_read(&self_p->deflate,
+                                              u8_buf_p,
+                                              left);
+
+            if (res < 0) {
+                return (res);
+            } else if (res == 0) {
+                self_p->frame.compressed = 0;
+            }
+
+            u8_buf_p += res;
+            left -= res;
+            continue;
+        }
+#endif
+
         /* Read buffered frame data. */
         if (self_p->frame.left > 0) {
             if (left > self_p->frame.left) {
@@ -176,11 +281,12 @@ ssize_t http_websocket_client_read(struct http_websocket_client_t *self_p,
                 n = left;
             }
 
-            if (socket_read(&self_p->server.socket, buf_p, n) != n) {
+            if (socket_read(&self_p->server.socket, u8_buf_p, n) != n) {
                 return (-EIO);
             }
 
             self_p->frame.left -= n;
+            u8_buf_p += n;
             left -= n;
         }
 
@@ -210,10 +316,31 @@ ssize_t http_websocket_client_read(struct http_websocket_client_t *self_p,
             }
 
             if (buf[1] & INET_HTTP_WEBSOCKET_MASK) {
-                if (socket_read(&self_p->server.socket, buf, 4) != 4) {
+                if (socket_read(&self_p->server.socket, &buf[10], 4) != 4) {
                     return (-EIO);
                 }
             }
+
+#if CONFIG_HTTP_WEBSOCKET_DEFLATE == 1
+            /* The RSV1 bit is set in the first frame of compressed
+               messages. */
+            if (buf[0] & INET_HTTP_WEBSOCKET_RSV1) {
+                res = http_websocket_deflate_read_begin(
+                    &self_p->deflate,
+                    ((buf[0] & INET_HTTP_WEBSOCKET_FIN) != 0),
+                    self_p->frame.left,
+                    ((buf[1] & INET_HTTP_WEBSOCKET_MASK)
+                     ? &buf[10]
+                     : NULL));
+
+                if (res != 0) {
+                    return (-EPROTO);
+                }
+
+                self_p->frame.left = 0;
+                self_p->frame.compressed = 1;
+            }
+#endif
         }
     }
 
@@ -233,6 +360,20 @@ ssize_t http_websocket_client_write(struct http_websocket_client_t *self_p,
     uint8_t header[16];
     size_t header_size = 2;
 
+#if CONFIG_HTTP_WEBSOCKET_DEFLATE == 1
+    struct iov_t iov;
+
+    if (self_p->deflate.enabled == 1) {
+        iov.buf_p = (void *)buf_p;
+        iov.size = size;
+
+        return (http_websocket_deflate_writev(&self_p->deflate,
+                                              type,
+                                              &iov,
+                                              1));
+    }
+#endif
+
     header[0] = (INET_HTTP_WEBSOCKET_FIN | type);
 
     if (size < 126) {
@@ -39,8 +39,14 @@ struct http_websocket_client_t {
     } server;
     struct {
         size_t left;
+#if CONFIG_HTTP_WEBSOCKET_DEFLATE == 1
+        int compressed;
+#endif
     } frame;
     const char *path_p;
+#if CONFIG_HTTP_WEBSOCKET_DEFLATE == 1
+    struct http_websocket_deflate_t deflate;
+#endif
 };
 
 /**
@@ -59,7 +65,9 @@ int http_websocket_client_init(struct http_websocket_client_t *self_p,
                                const char *path_p);
 
 /**
- * Connect given http to the server.
+ * Connect given http to the server. The permessage-deflate extension
+ * is offered if ``CONFIG_HTTP_WEBSOCKET_DEFLATE`` is enabled, and
+ * used if accepted by the server.
  *
  * @param[in] self_p Http to connect.
  *
@@ -0,0 +1,788 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2014-2018, Erik Moqvist
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use, copy,
+ * modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ * This file is part of the Simba project.
+ */
+
+#include "simba.h"
+
+#if CONFIG_HTTP_WEBSOCKET_DEFLATE == 1
+
+/**
+ * Parameters of a permessage-deflate extension offer or response. A
+ * window bits parameter is zero(0) if missing, and -1 if given
+ * without a value.
+ */
+struct params_t {
+    int server_no_context_takeover;
+    int client_no_context_takeover;
+    int server_max_window_bits;
+    int client_max_window_bits;
+};
+
+/* Appended to each received message before decompression. */
+static const uint8_t empty_stored_block_tail[4] = {
+    0x00, 0x00, 0xff, 0xff
+};
+
+static const char *skip_whitespace(const char *buf_p)
+{
+    while ((*buf_p == ' ') || (*buf_p == '\t')) {
+        buf_p++;
+    }
+
+    return (buf_p);
+}
+
+/**
+ * Get the end of given token at the start of given buffer, or NULL
+ * if the buffer does not start with the token.
+ */
+static const char *parse_token(const char *buf_p, const char *token_p)
+{
+    size_t length;
+
+    length = strlen(token_p);
+
+    if (strncmp(buf_p, token_p, length) != 0) {
+        return (NULL);
+    }
+
+    buf_p += length;
+
+    if ((*buf_p != '\0') && (strchr(" \t;,=", *buf_p) == NULL)) {
+        return (NULL);
+    }
+
+    return (buf_p);
+}
+
+/**
+ * Parse the optional, and optionally quoted, value of a window bits
+ * parameter.
+ */
+static const char *parse_window_bits(const char *buf_p, int *value_p)
+{
+    int quoted;
+    int value;
+
+    buf_p = skip_whitespace(buf_p);
+
+    if (*buf_p != '=') {
+        *value_p = -1;
+
+        return (buf_p);
+    }
+
+    buf_p = skip_whitespace(buf_p + 1);
+    quoted = (*buf_p == '"');
+
+    if (quoted) {
+        buf_p++;
+    }
+
+    if (!isdigit((int)*buf_p)) {
+        return (NULL);
+    }
+
+    value = 0;
+
+    while (isdigit((int)*buf_p)) {
+        value = (10 * value + *buf_p - '0');
+        buf_p++;
+
+        if (value > 15) {
+            return (NULL);
+        }
+    }
+
+    if (quoted) {
+        if (*buf_p != '"') {
+            return (NULL);
+        }
+
+        buf_p++;
+    }
+
+    if (value < 8) {
+        return (NULL);
+    }
+
+    *value_p = value;
+
+    return (buf_p);
+}
+
+/**
+ * Parse the parameters of a permessage-deflate extension element, up
+ * to the next element. Unknown and repeated parameters are invalid.
+ */
+static int parse_params(const char *buf_p, struct params_t *params_p)
+{
+    const char *next_p;
+
+    memset(params_p, 0, sizeof(*params_p));
+
+    while (1) {
+        buf_p = skip_whitespace(buf_p);
+
+        if ((*buf_p == '\0') || (*buf_p == ',')) {
+            return (0);
+        }
+
+        if (*buf_p != ';') {
+            return (-1);
+        }
+
+        buf_p = skip_whitespace(buf_p + 1);
+
+        if ((next_p = parse_token(buf_p, "server_no_context_takeover")) != NULL) {
+            if (params_p->server_no_context_takeover == 1) {
+                return (-1);
+            }
+
+            params_p->server_no_context_takeover = 1;
+        } else if ((next_p = parse_token(buf_p, "client_no_context_takeover")) != NULL) {
+            if (params_p->client_no_context_takeover == 1) {
+                return (-1);
+            }
+
+            params_p->client_no_context_takeover = 1;
+        } else if ((next_p = parse_token(buf_p, "server_max_window_bits")) != NULL) {
+            if (params_p->server_max_window_bits != 0) {
+                return (-1);
+            }
+
+            next_p = parse_window_bits(next_p,
+                                       &params_p->server_max_window_bits);
+
+            /* The value is required. */
+            if (params_p->server_max_window_bits == -1) {
+                return (-1);
+            }
+        } else if ((next_p = parse_token(buf_p, "client_max_window_bits")) != NULL) {
+            if (params_p->client_max_window_bits != 0) {
+                return (-1);
+            }
+
+            next_p = parse_window_bits(next_p,
+                                       &params_p->client_max_window_bits);
+        } else {
+            return (-1);
+        }
+
+        if (next_p == NULL) {
+            return (-1);
+        }
+
+        buf_p = next_p;
+    }
+}
+
+/**
+ * Find the first permessage-deflate extension element with valid
+ * parameters in given header field value.
+ */
+static int parse_extensions(const char *buf_p, struct params_t *params_p)
+{
+    const char *next_p;
+
+    while (buf_p != NULL) {
+        buf_p = skip_whitespace(buf_p);
+        next_p = parse_token(buf_p, "permessage-deflate");
+
+        if ((next_p != NULL) && (parse_params(next_p, params_p) == 0)) {
+            return (0);
+        }
+
+        buf_p = strchr(buf_p, ',');
+
+        if (buf_p != NULL) {
+            buf_p++;
+        }
+    }
+
+    return (-1);
+}
+
+/**
+ * Start compressing and decompressing messages with given negotiated
+ * parameters.
+ */
+static void enable(struct http_websocket_deflate_t *self_p,
+                   int local_window_bits,
+                   int local_no_context_takeover,
+                   int remote_window_bits,
+                   int remote_no_context_takeover)
+{
+    void *window_p;
+
+    self_p->output.window_bits = local_window_bits;
+    self_p->output.no_context_takeover = local_no_context_takeover;
+    self_p->input.window_bits = remote_window_bits;
+    self_p->input.no_context_takeover = remote_no_context_takeover;
+
+    /* Without context takeover each message is compressed on its
+       own, with matches only within the message. */
+    window_p = NULL;
+
+#if CONFIG_HTTP_WEBSOCKET_DEFLATE_CONTEXT_TAKEOVER == 1
+    if (local_no_context_takeover == 0) {
+        window_p = &self_p->output.window[0];
+    }
+#endif
+
+    (void)deflate_encoder_init(&self_p->output.encoder,
+                               &self_p->output.base,
+                               local_window_bits,
+                               window_p);
+
+    /* Messages are decompressed into the read buffer if the peer's
+       window does not fit in ours. */
+    window_p = NULL;
+
+#if CONFIG_HTTP_WEBSOCKET_DEFLATE_CONTEXT_TAKEOVER == 1
+    if (remote_window_bits <= CONFIG_HTTP_WEBSOCKET_DEFLATE_WINDOW_BITS) {
+        window_p = &self_p->input.window[0];
+    }
+#endif
+
+    (void)deflate_decoder_init(&self_p->input.decoder,
+                               &self_p->input.base,
+                               CONFIG_HTTP_WEBSOCKET_DEFLATE_WINDOW_BITS,
+                               window_p);
+
+    self_p->enabled = 1;
+}
+
+/**
+ * Write the buffered compressed data as a frame. All frames but the
+ * first are continuation frames.
+ */
+static int write_frame(struct http_websocket_deflate_t *self_p, int fin)
+{
+    uint8_t header[14];
+    size_t header_size;
+    size_t size;
+
+    size = self_p->output.size;
+    header[0] = self_p->output.opcode;
+
+    if (fin == 1) {
+        header[0] |= INET_HTTP_WEBSOCKET_FIN;
+    }
+
+    header_size = 2;
+
+    if (size < 126) {
+        header[1] = size;
+    } else if (size < 65536) {
+        header[1] = 126;
+        header[2] = ((size >> 8) & 0xff);
+        header[3] = ((size >> 0) & 0xff);
+        header_size += 2;
+    } else {
+        header[1] = 127;
+        memset(&header[2], 0, 4);
+        header[6] = ((size >> 24) & 0xff);
+        header[7] = ((size >> 16) & 0xff);
+        header[8] = ((size >>  8) & 0xff);
+        header[9] = ((size >>  0) & 0xff);
+        header_size += 8;
+    }
+
+    /* A client masks its frames, with a zero masking key. */
+    if (self_p->mask == 1) {
+        header[1] |= INET_HTTP_WEBSOCKET_MASK;
+        memset(&header[header_size], 0, 4);
+        header_size += 4;
+    }
+
+    /* The header is put just before the payload, and both are
+       written at once. */
+    memcpy(&self_p->output.buf[sizeof(header) - header_size],
+           &header[0],
+           header_size);
+    size += header_size;
+
+    if (socket_write(self_p->socket_p,
+                     &self_p->output.buf[sizeof(header) - header_size],
+                     size) != size) {
+        return (-EIO);
+    }
+
+    self_p->output.opcode = 0;
+    self_p->output.size = 0;
+
+    return (0);
+}
+
+/**
+ * Output channel of the encoder. A frame is written when the frame
+ * buffer is full and more compressed data follows.
+ */
+static ssize_t output_write(void *base_p, const void *buf_p, size_t size)
+{
+    struct http_websocket_deflate_t *self_p;
+    const uint8_t *u8_buf_p;
+    size_t left;
+    size_t n;
+
+    self_p = container_of(base_p, struct http_websocket_deflate_t, output);
+    u8_buf_p = buf_p;
+    left = size;
+
+    while (left > 0) {
+        if (self_p->output.size == CONFIG_HTTP_WEBSOCKET_DEFLATE_FRAME_SIZE) {
+            if (write_frame(self_p, 0) != 0) {
+                return (-EIO);
+            }
+        }
+
+        n = MIN(left,
+                CONFIG_HTTP_WEBSOCKET_DEFLATE_FRAME_SIZE - self_p->output.size);
+        memcpy(&self_p->output.buf[14 + self_p->output.size], u8_buf_p, n);
+        self_p->output.size += n;
+        u8_buf_p += n;
+        left -= n;
+    }
+
+    return (size);
+}
+
+/**
+ * Read the header of a continuation frame.
+ */
+static int read_frame_header(struct http_websocket_deflate_t *self_p)
+{
+    uint8_t header[14];
+    size_t size;
+
+    if (socket_read(self_p->socket_p, &header[0], 2) != 2) {
+        return (-EIO);
+    }
+
+    self_p->input.fin = ((header[0] & INET_HTTP_WEBSOCKET_FIN) != 0);
+    self_p->input.masked = ((header[1] & INET_HTTP_WEBSOCKET_MASK) != 0);
+    self_p->input.left = (header[1] & ~INET_HTTP_WEBSOCKET_MASK);
+
+    if (self_p->input.left == 126) {
+        size = 2;
+    } else if (self_p->input.left == 127) {
+        size = 8;
+    } else {
+        size = 0;
+    }
+
+    if (self_p->input.masked) {
+        size += 4;
+    }
+
+    if (size > 0) {
+        if (socket_read(self_p->socket_p, &header[2], size) != size) {
+            return (-EIO);
+        }
+    }
+
+    if (self_p->input.left == 126) {
+        self_p->input.left = ((uint32_t)(header[2]) << 8 | header[3]);
+    } else if (self_p->input.left == 127) {
+        self_p->input.left = ((uint32_t)(header[6]) << 24
+                              | (uint32_t)(header[7]) << 16
+                              | (uint32_t)(header[8]) << 8
+                              | header[9]);
+    }
+
+    if (self_p->input.masked) {
+        memcpy(&self_p->input.masking_key[0], &header[2 + size - 4], 4);
+    }
+
+    self_p->input.pos = 0;
+
+    return (0);
+}
+
+/**
+ * Input channel of the decoder. Reads the payload of the frames of
+ * the current message, followed by the four bytes of the empty
+ * stored block the sender removed.
+ */
+static ssize_t input_read(void *base_p, void *buf_p, size_t size)
+{
+    struct http_websocket_deflate_t *self_p;
+    uint8_t *u8_buf_p;
+    size_t i;
+
+    self_p = container_of(base_p, struct http_websocket_deflate_t, input);
+
+    while (self_p->input.left == 0) {
+        if (self_p->input.fin == 0) {
+            if (read_frame_header(self_p) != 0) {
+                return (-EIO);
+            }
+        } else if (self_p->input.tail > 0) {
+            size = MIN(size, self_p->input.tail);
+            memcpy(buf_p,
+                   &empty_stored_block_tail[4 - self_p->input.tail],
+                   size);
+            self_p->input.tail -= size;
+
+            return (size);
+        } else {
+            return (0);
+        }
+    }
+
+    size = MIN(size, self_p->input.left);
+
+    if (socket_read(self_p->socket_p, buf_p, size) != size) {
+        return (-EIO);
+    }
+
+    if (self_p->input.masked) {
+        u8_buf_p = buf_p;
+
+        for (i = 0; i < size; i++) {
+            u8_buf_p[i] ^= self_p->input.masking_key[(self_p->input.pos + i) % 4];
+        }
+    }
+
+    self_p->input.pos += size;
+    self_p->input.left -= size;
+
+    return (size);
+}
+
+int http_websocket_deflate_init(struct http_websocket_deflate_t *self_p,
+                                struct socket_t *socket_p,
+                                int mask)
+{
+    ASSERTN(self_p != NULL, EINVAL);
+    ASSERTN(socket_p != NULL, EINVAL);
+
+    self_p->socket_p = socket_p;
+    self_p->mask = mask;
+    self_p->enabled = 0;
+    chan_init(&self_p->output.base,
+              chan_read_null,
+              output_write,
+              chan_size_null);
+    chan_init(&self_p->input.base,
+              input_read,
+              chan_write_null,
+              chan_size_null);
+
+    return (0);
+}
+
+ssize_t http_websocket_deflate_offer(struct http_websocket_deflate_t *self_p,
+                                     char *buf_p,
+                                     size_t size)
+{
+    ASSERTN(self_p != NULL, EINVAL);
+    ASSERTN(buf_p != NULL, EINVAL);
+
+    self_p->enabled = 0;
+
+#if CONFIG_HTTP_WEBSOCKET_DEFLATE_CONTEXT_TAKEOVER == 1
+    return (std_snprintf(buf_p,
+                         size,
+                         FSTR("permessage-deflate; "
+                              "server_max_window_bits=%d; "
+                              "client_max_window_bits=%d"),
+                         CONFIG_HTTP_WEBSOCKET_DEFLATE_WINDOW_BITS,
+                         CONFIG_HTTP_WEBSOCKET_DEFLATE_WINDOW_BITS));
+#else
+    return (std_snprintf(buf_p,
+                         size,
+                         FSTR("permessage-deflate; "
+                              "server_no_context_takeover; "
+                              "client_no_context_takeover")));
+#endif
+}
+
+int http_websocket_deflate_client_accept(struct http_websocket_deflate_t *self_p,
+                                         const char *response_p)
+{
+    ASSERTN(self_p != NULL, EINVAL);
+    ASSERTN(response_p != NULL, EINVAL);
+
+    struct params_t params;
+    int local_window_bits;
+    int remote_window_bits;
+
+    if (parse_extensions(response_p, &params) != 0) {
+        return (-EPROTO);
+    }
+
+    /* The value is required in a response. */
+    if (params.client_max_window_bits == -1) {
+        return (-EPROTO);
+    }
+
+    local_window_bits = 15;
+    remote_window_bits = 15;
+
+    if (params.client_max_window_bits > 0) {
+        local_window_bits = params.client_max_window_bits;
+    }
+
+    if (params.server_max_window_bits > 0) {
+        remote_window_bits = params.server_max_window_bits;
+    }
+
+#if CONFIG_HTTP_WEBSOCKET_DEFLATE_CONTEXT_TAKEOVER == 1
+    /* The server accepted the offered window size limit. */
+    if (params.server_max_window_bits == 0) {
+        remote_window_bits = CONFIG_HTTP_WEBSOCKET_DEFLATE_WINDOW_BITS;
+    } else if (remote_window_bits > CONFIG_HTTP_WEBSOCKET_DEFLATE_WINDOW_BITS) {
+        return (-EPROTO);
+    }
+
+    local_window_bits = MIN(local_window_bits,
+                            CONFIG_HTTP_WEBSOCKET_DEFLATE_WINDOW_BITS);
+    enable(self_p,
+           local_window_bits,
+           params.client_no_context_takeover,
+           remote_window_bits,
+           params.server_no_context_takeover);
+#else
+    /* Messages from the server are decompressed into the read
+       buffer. */
+    if (params.server_no_context_takeover == 0) {
+        return (-EPROTO);
+    }
+
+    enable(self_p, local_window_bits, 1, remote_window_bits, 1);
+#endif
+
+    return (0);
+}
+
+ssize_t http_websocket_deflate_server_accept(struct http_websocket_deflate_t *self_p,
+                                             const char *offer_p,
+                                             char *buf_p,
+                                             size_t size)
+{
+    ASSERTN(self_p != NULL, EINVAL);
+    ASSERTN(offer_p != NULL, EINVAL);
+    ASSERTN(buf_p != NULL, EINVAL);
+
+    struct params_t params;
+    int local_window_bits;
+    int local_no_context_takeover;
+    int remote_window_bits;
+    int remote_no_context_takeover;
+    far_string_t server_no_context_takeover_p;
+    far_string_t client_no_context_takeover_p;
+
+    self_p->enabled = 0;
+
+    if (parse_extensions(offer_p, &params) != 0) {
+        return (-EPROTO);
+    }
+
+    local_window_bits = 15;
+    remote_window_bits = 15;
+
+    if (params.server_max_window_bits > 0) {
+        local_window_bits = params.server_max_window_bits;
+    }
+
+    if (params.client_max_window_bits > 0) {
+        remote_window_bits = params.client_max_window_bits;
+    }
+
+#if CONFIG_HTTP_WEBSOCKET_DEFLATE_CONTEXT_TAKEOVER == 1
+    local_window_bits = MIN(local_window_bits,
+                            CONFIG_HTTP_WEBSOCKET_DEFLATE_WINDOW_BITS);
+    local_no_context_takeover = params.server_no_context_takeover;
+
+    /* Limit the client window if the client supports it, and
+       otherwise decompress its messages into the read buffer, which
+       requires no context takeover. */
+    if (params.client_max_window_bits != 0) {
+        remote_window_bits = MIN(remote_window_bits,
+                                 CONFIG_HTTP_WEBSOCKET_DEFLATE_WINDOW_BITS);
+    }
+
+    remote_no_context_takeover =
+        ((params.client_no_context_takeover == 1)
+         || (remote_window_bits > CONFIG_HTTP_WEBSOCKET_DEFLATE_WINDOW_BITS));
+#else
+    local_no_context_takeover = 1;
+    remote_no_context_takeover = 1;
+#endif
+
+    enable(self_p,
+           local_window_bits,
+           local_no_context_takeover,
+           remote_window_bits,
+           remote_no_context_takeover);
+
+    if (local_no_context_takeover == 1) {
+        server_no_context_takeover_p = FSTR("; server_no_context_takeover");
+    } else {
+        server_no_context_takeover_p = FSTR("");
+    }
+
+    if (remote_no_context_takeover == 1) {
+        client_no_context_takeover_p = FSTR("; client_no_context_takeover");
+    } else {
+        client_no_context_takeover_p = FSTR("");
+    }
+
+    /* The client window size may only be given if offered. */
+    if (params.client_max_window_bits != 0) {
+        return (std_snprintf(buf_p,
+                             size,
+                             FSTR("permessage-deflate; "
+                                  "server_max_window_bits=%d%S%S; "
+                                  "client_max_window_bits=%d"),
+                             local_window_bits,
+                             server_no_context_takeover_p,
+                             client_no_context_takeover_p,
+                             remote_window_bits));
+    } else {
+        return (std_snprintf(buf_p,
+                             size,
+                             FSTR("permessage-deflate; "
+                                  "server_max_window_bits=%d%S%S"),
+                             local_window_bits,
+                             server_no_context_takeover_p,
+                             client_no_context_takeover_p));
+    }
+}
+
+ssize_t http_websocket_deflate_writev(struct http_websocket_deflate_t *self_p,
+                                      int type,
+                                      const struct iov_t *iov_p,
+                                      size_t length)
+{
+    ASSERTN(self_p != NULL, EINVAL);
+    ASSERTN(iov_p != NULL, EINVAL);
+
+    size_t size;
+    size_t i;
+
+    /* Only the first frame of a compressed message has the RSV1
+       bit set. */
+    self_p->output.opcode = (INET_HTTP_WEBSOCKET_RSV1 | type);
+    self_p->output.size = 0;
+    size = 0;
+
+    for (i = 0; i < length; i++) {
+        if (deflate_encoder_write(&self_p->output.encoder,
+                                  iov_p[i].buf_p,
+                                  iov_p[i].size) != iov_p[i].size) {
+            return (-EIO);
+        }
+
+        size += iov_p[i].size;
+    }
+
+    if (deflate_encoder_flush(&self_p->output.encoder) != 0) {
+        return (-EIO);
+    }
+
+    if (write_frame(self_p, 1) != 0) {
+        return (-EIO);
+    }
+
+    return (size);
+}
+
+int http_websocket_deflate_read_begin(struct http_websocket_deflate_t *self_p,
+                                      int fin,
+                                      size_t size,
+                                      const uint8_t *masking_key_p)
+{
+    ASSERTN(self_p != NULL, EINVAL);
+
+    if (self_p->enabled == 0) {
+        return (-EPROTO);
+    }
+
+    self_p->input.fin = fin;
+    self_p->input.left = size;
+    self_p->input.masked = (masking_key_p != NULL);
+
+    if (masking_key_p != NULL) {
+        memcpy(&self_p->input.masking_key[0], masking_key_p, 4);
+    }
+
+    self_p->input.pos = 0;
+    self_p->input.tail = sizeof(empty_stored_block_tail);
+
+    return (0);
+}
+
+ssize_t http_websocket_deflate_read(struct http_websocket_deflate_t *self_p,
+                                    void *buf_p,
+                                    size_t size)
+{
+    ASSERTN(self_p != NULL, EINVAL);
+    ASSERTN(buf_p != NULL, EINVAL);
+    ASSERTN(size > 0, EINVAL);
+
+    ssize_t res;
+
+    res = deflate_decoder_read(&self_p->input.decoder, buf_p, size);
+
+    if (res == 0) {
+        res = http_websocket_deflate_read_end(self_p);
+    }
+
+    return (res);
+}
+
+int http_websocket_deflate_read_end(struct http_websocket_deflate_t *self_p)
+{
+    ASSERTN(self_p != NULL, EINVAL);
+
+    uint8_t buf[16];
+    ssize_t res;
+
+    /* The rest of the message is decompressed to keep the window up
+       to date. */
+    do {
+        res = deflate_decoder_read(&self_p->input.decoder,
+                                   &buf[0],
+                                   sizeof(buf));
+    } while (res > 0);
+
+    if (res < 0) {
+        return (res);
+    }
+
+    /* Input after the final block, if any. */
+    do {
+        res = input_read(&self_p->input.base, &buf[0], sizeof(buf));
+    } while (res > 0);
+
+    return (res);
+}
+
+#endif
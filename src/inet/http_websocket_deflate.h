@@ -0,0 +1,208 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2014-2018, Erik Moqvist
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use, copy,
+ * modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ * This file is part of the Simba project.
+ */
+
+#ifndef __INET_HTTP_WEBSOCKET_DEFLATE_H__
+#define __INET_HTTP_WEBSOCKET_DEFLATE_H__
+
+#include "simba.h"
+
+#if CONFIG_HTTP_WEBSOCKET_DEFLATE_CONTEXT_TAKEOVER == 1
+#    define HTTP_WEBSOCKET_DEFLATE_WINDOW_SIZE          \
+    (1 << CONFIG_HTTP_WEBSOCKET_DEFLATE_WINDOW_BITS)
+#endif
+
+/**
+ * The permessage-deflate extension state of a websocket.
+ */
+struct http_websocket_deflate_t {
+    struct socket_t *socket_p;
+    /* Mask sent frames, as a client does. */
+    int mask;
+    /* One(1) if the extension was negotiated. */
+    int enabled;
+    /* Messages sent by this end. */
+    struct {
+        struct chan_t base;
+        struct deflate_encoder_t encoder;
+        int window_bits;
+        int no_context_takeover;
+        /* Opcode and flags of the next frame. */
+        uint8_t opcode;
+        size_t size;
+        /* Room for the frame header before the payload. */
+        uint8_t buf[14 + CONFIG_HTTP_WEBSOCKET_DEFLATE_FRAME_SIZE];
+#if CONFIG_HTTP_WEBSOCKET_DEFLATE_CONTEXT_TAKEOVER == 1
+        uint8_t window[HTTP_WEBSOCKET_DEFLATE_WINDOW_SIZE];
+#endif
+    } output;
+    /* Messages sent by the peer. */
+    struct {
+        struct chan_t base;
+        struct deflate_decoder_t decoder;
+        int window_bits;
+        int no_context_takeover;
+        /* Current frame. */
+        int fin;
+        size_t left;
+        int masked;
+        uint8_t masking_key[4];
+        size_t pos;
+        /* Bytes left of the empty stored block appended to the
+           message. */
+        size_t tail;
+#if CONFIG_HTTP_WEBSOCKET_DEFLATE_CONTEXT_TAKEOVER == 1
+        uint8_t window[HTTP_WEBSOCKET_DEFLATE_WINDOW_SIZE];
+#endif
+    } input;
+};
+
+/**
+ * Initialize given extension object. The extension is not used until
+ * negotiated in the handshake.
+ *
+ * @param[out] self_p Extension object to initialize.
+ * @param[in] socket_p Websocket connection.
+ * @param[in] mask One(1) to mask sent frames, as a client does, or
+ *                 zero(0).
+ *
+ * @return zero(0) or negative error code.
+ */
+int http_websocket_deflate_init(struct http_websocket_deflate_t *self_p,
+                                struct socket_t *socket_p,
+                                int mask);
+
+/**
+ * Format the ``Sec-WebSocket-Extensions`` header field value a
+ * client offers the extension with.
+ *
+ * @param[in] self_p Extension object.
+ * @param[out] buf_p Buffer to write the null terminated value to.
+ * @param[in] size Buffer size.
+ *
+ * @return Value length or negative error code.
+ */
+ssize_t http_websocket_deflate_offer(struct http_websocket_deflate_t *self_p,
+                                     char *buf_p,
+                                     size_t size);
+
+/**
+ * Enable the extension with the parameters in the
+ * ``Sec-WebSocket-Extensions`` header field value of the server
+ * handshake response.
+ *
+ * @param[in] self_p Extension object.
+ * @param[in] response_p Header field value.
+ *
+ * @return zero(0) if enabled, or -EPROTO if the server did not
+ *         accept the offer, or accepted it with invalid parameters.
+ */
+int http_websocket_deflate_client_accept(struct http_websocket_deflate_t *self_p,
+                                         const char *response_p);
+
+/**
+ * Accept the first permessage-deflate offer with valid parameters in
+ * the ``Sec-WebSocket-Extensions`` header field value of a client
+ * handshake request, if any, and format the response header field
+ * value.
+ *
+ * @param[in] self_p Extension object.
+ * @param[in] offer_p Header field value.
+ * @param[out] buf_p Buffer to write the null terminated response
+ *                   value to.
+ * @param[in] size Buffer size.
+ *
+ * @return Response value length, or negative error code if no offer
+ *         was accepted.
+ */
+ssize_t http_websocket_deflate_server_accept(struct http_websocket_deflate_t *self_p,
+                                             const char *offer_p,
+                                             char *buf_p,
+                                             size_t size);
+
+/**
+ * Compress given buffers as one message and write it, in one or more
+ * frames of at most ``CONFIG_HTTP_WEBSOCKET_DEFLATE_FRAME_SIZE`` bytes
+ * of payload.
+ *
+ * @param[in] self_p Extension object.
+ * @param[in] type One of ``HTTP_TYPE_TEXT`` and ``HTTP_TYPE_BINARY``.
+ * @param[in] iov_p Array of buffers to write.
+ * @param[in] length Number of buffers in the array.
+ *
+ * @return Number of written bytes or negative error code.
+ */
+ssize_t http_websocket_deflate_writev(struct http_websocket_deflate_t *self_p,
+                                      int type,
+                                      const struct iov_t *iov_p,
+                                      size_t length);
+
+/**
+ * Start reading a compressed message, after the header of its first
+ * frame has been read.
+ *
+ * @param[in] self_p Extension object.
+ * @param[in] fin One(1) if the frame is the last of the message.
+ * @param[in] size Frame payload size.
+ * @param[in] masking_key_p Frame masking key, or NULL if not masked.
+ *
+ * @return zero(0) or negative error code.
+ */
+int http_websocket_deflate_read_begin(struct http_websocket_deflate_t *self_p,
+                                      int fin,
+                                      size_t size,
+                                      const uint8_t *masking_key_p);
+
+/**
+ * Read decompressed data of the current message. Continuation frames
+ * are read as needed. Without context takeover, see
+ * ``CONFIG_HTTP_WEBSOCKET_DEFLATE_CONTEXT_TAKEOVER``, and on a server
+ * whose client may use a larger window than configured, the whole
+ * message is decompressed by one call and data not fitting in given
+ * buffer is dropped.
+ *
+ * @param[in] self_p Extension object.
+ * @param[out] buf_p Buffer to read into.
+ * @param[in] size Buffer size.
+ *
+ * @return Number of read bytes, zero(0) at the end of the message, or
+ *         negative error code.
+ */
+ssize_t http_websocket_deflate_read(struct http_websocket_deflate_t *self_p,
+                                    void *buf_p,
+                                    size_t size);
+
+/**
+ * Decompress and drop the rest of the current message.
+ *
+ * @param[in] self_p Extension object.
+ *
+ * @return zero(0) or negative error code.
+ */
+int http_websocket_deflate_read_end(struct http_websocket_deflate_t *self_p);
+
+#endif
@@ -28,6 +28,54 @@
 
 #include "simba.h"
 
+/**
+ * Unmask given payload in place. The bulk of the payload is processed
+ * 32 bits at a time from the first aligned address, with the masking
+ * key rotated to match.
+ */
+static void unmask(uint8_t *buf_p,
+                   size_t size,
+                   const uint8_t *masking_key_p)
+{
+    uint8_t key[4];
+    uint32_t key32;
+    uint32_t *buf32_p;
+    size_t pos;
+
+    pos = 0;
+
+    /* Bytes up to the first aligned address. */
+    while ((size > 0) && (((uintptr_t)buf_p & 0x3) != 0)) {
+        *buf_p++ ^= masking_key_p[pos % 4];
+        pos++;
+        size--;
+    }
+
+    /* Aligned words. The key is rotated so its first byte masks the
+       first byte of each word, independent of the byte order. */
+    key[0] = masking_key_p[(pos + 0) % 4];
+    key[1] = masking_key_p[(pos + 1) % 4];
+    key[2] = masking_key_p[(pos + 2) % 4];
+    key[3] = masking_key_p[(pos + 3) % 4];
+    memcpy(&key32, &key[0], sizeof(key32));
+    buf32_p = (uint32_t *)buf_p;
+
+    while (size >= 4) {
+        *buf32_p++ ^= key32;
+        size -= 4;
+    }
+
+    /* Trailing bytes. */
+    buf_p = (uint8_t *)buf32_p;
+    pos = 0;
+
+    while (size > 0) {
+        *buf_p++ ^= key[pos];
+        pos++;
+        size--;
+    }
+}
+
 int http_websocket_server_init(struct http_websocket_server_t *self_p,
                                struct socket_t *socket_p)
 {
@@ -36,16 +84,67 @@ int http_websocket_server_init(struct http_websocket_server_t *self_p,
 
     self_p->socket_p = socket_p;
 
+#if CONFIG_HTTP_WEBSOCKET_DEFLATE == 1
+    (void)http_websocket_deflate_init(&self_p->deflate, socket_p, 0);
+#endif
+
     return (0);
 }
 
+#if CONFIG_HTTP_WEBSOCKET_DEFLATE == 1
+
+/**
+ * Read the rest of a compressed message, after the header of its
+ * first frame.
+ */
+static ssize_t read_compressed(struct http_websocket_server_t *self_p,
+                               void *buf_p,
+                               size_t size)
+{
+    uint8_t *u8_buf_p;
+    size_t left;
+    ssize_t res;
+
+    u8_buf_p = buf_p;
+    left = size;
+
+    while (left > 0) {
+        res = http_websocket_deflate_read(&self_p->deflate, u8_buf_p, left);
+
+        if (res < 0) {
+            return (res);
+        } else if (res == 0) {
+            return (size - left);
+        }
+
+        u8_buf_p += res;
+        left -= res;
+    }
+
+    /* Discard leftover data. */
+    res = http_websocket_deflate_read_end(&self_p->deflate);
+
+    if (res != 0) {
+        return (res);
+    }
+
+    return (size);
+}
+
+#endif
+
 int http_websocket_server_handshake(struct http_websocket_server_t *self_p,
                                     struct http_server_request_t *request_p)
 {
     ASSERTN(self_p != NULL, EINVAL)
     ASSERTN(request_p != NULL, EINVAL)
 
+#if CONFIG_HTTP_WEBSOCKET_DEFLATE == 1
+    char buf[288];
+    char extensions[128];
+#else
     char buf[160];
+#endif
     char accept_key[29];
     const char *key_p;
     struct sha1_t sha;
@@ -86,10 +185,26 @@ int http_websocket_server_handshake(struct http_websocket_server_t *self_p,
                        FSTR("HTTP/1.1 101 Switching Protocols\r\n"
                             "Upgrade: websocket\r\n"
                             "Connection: Upgrade\r\n"
-                            "Sec-WebSocket-Accept: %s\r\n"
-                            "\r\n"),
+                            "Sec-WebSocket-Accept: %s\r\n"),
                        accept_key);
 
+#if CONFIG_HTTP_WEBSOCKET_DEFLATE == 1
+    /* Compress messages if the client offers it. */
+    if (request_p->headers.sec_websocket_extensions.present == 1) {
+        if (http_websocket_deflate_server_accept(
+                &self_p->deflate,
+                request_p->headers.sec_websocket_extensions.value,
+                &extensions[0],
+                sizeof(extensions)) > 0) {
+            size += std_sprintf(&buf[size],
+                                FSTR("Sec-WebSocket-Extensions: %s\r\n"),
+                                &extensions[0]);
+        }
+    }
+#endif
+
+    size += std_sprintf(&buf[size], FSTR("\r\n"));
+
     if (socket_write(self_p->socket_p, buf, size) != size) {
         return (-EIO);
     }
@@ -109,9 +224,8 @@ ssize_t http_websocket_server_read(struct http_websocket_server_t *self_p,
     uint8_t buf[16], *b_p = buf_p;
     size_t payload_left, left = size, n;
     int fin = 0;
-    uint8_t masking_key[4];
-    int pos;
-    int i;
+    uint8_t *masking_key_p;
+    size_t header_size;
 
     while (fin == 0) {
         /* Read the next frame. */
@@ -122,38 +236,61 @@ ssize_t http_websocket_server_read(struct http_websocket_server_t *self_p,
         fin = (buf[0] & INET_HTTP_WEBSOCKET_FIN);
         payload_left = (buf[1] & ~INET_HTTP_WEBSOCKET_MASK);
 
+        /* Read the rest of the header, that is the extended payload
+           length and the masking key, at once. */
         if (payload_left == 126) {
-            if (socket_read(self_p->socket_p, &buf[2], 2) != 2) {
+            header_size = 2;
+        } else if (payload_left == 127) {
+            header_size = 8;
+        } else {
+            header_size = 0;
+        }
+
+        masking_key_p = &buf[2 + header_size];
+
+        if (buf[1] & INET_HTTP_WEBSOCKET_MASK) {
+            header_size += 4;
+        } else {
+            memset(masking_key_p, 0, 4);
+        }
+
+        if (header_size > 0) {
+            if (socket_read(self_p->socket_p,
+                            &buf[2],
+                            header_size) != header_size) {
                 return (-EIO);
             }
+        }
 
+        if (payload_left == 126) {
             payload_left = ((uint32_t)(buf[2]) << 8 | buf[3]);
         } else if (payload_left == 127) {
-            if (socket_read(self_p->socket_p, &buf[2], 8) != 8) {
-                return (-EIO);
-            }
-
             payload_left = ((uint32_t)(buf[6]) << 24
                     | (uint32_t)(buf[7]) << 16
                     | (uint32_t)(buf[8]) << 8
                     | buf[9]);
         }
 
-        /* Read the mask. */
-        if (buf[1] & INET_HTTP_WEBSOCKET_MASK) {
-            if (socket_read(self_p->socket_p,
-                            &masking_key[0],
-                            sizeof(masking_key)) != sizeof(masking_key)) {
-                return (-EIO);
+#if CONFIG_HTTP_WEBSOCKET_DEFLATE == 1
+        /* The RSV1 bit is set in the first frame of compressed
+           messages. */
+        if (buf[0] & INET_HTTP_WEBSOCKET_RSV1) {
+            if (http_websocket_deflate_read_begin(
+                    &self_p->deflate,
+                    (fin != 0),
+                    payload_left,
+                    ((buf[1] & INET_HTTP_WEBSOCKET_MASK)
+                     ? masking_key_p
+                     : NULL)) != 0) {
+                return (-EPROTO);
             }
-        } else {
-            memset(&masking_key[0], 0, sizeof(masking_key));
+
+            return (read_compressed(self_p, buf_p, size));
         }
+#endif
 
         /* Read the payload. */
-        pos = 0;
-
-        while ((payload_left > 0) && (left > 0)) {
+        if ((payload_left > 0) && (left > 0)) {
             if (payload_left < left) {
                 n = payload_left;
             } else {
@@ -164,39 +301,94 @@ ssize_t http_websocket_server_read(struct http_websocket_server_t *self_p,
                 return (-1);
             }
 
-            for (i = 0; i < n; i++) {
-                *b_p++ ^= masking_key[pos % 4];
-                pos++;
+            if (buf[1] & INET_HTTP_WEBSOCKET_MASK) {
+                unmask(b_p, n, masking_key_p);
             }
 
+            b_p += n;
             left -= n;
             payload_left -= n;
         }
 
         /* Discard leftover data. */
         while (payload_left > 0) {
-            if (socket_read(self_p->socket_p, buf, 1) != 1) {
+            n = MIN(payload_left, sizeof(buf));
+
+            if (socket_read(self_p->socket_p, buf, n) != n) {
                 return (-1);
             }
 
-            payload_left--;
+            payload_left -= n;
         }
     }
 
     return (size - left);
 }
 
-ssize_t http_websocket_server_write(struct http_websocket_server_t *self_p,
-                                    int type,
-                                    const void *buf_p,
-                                    uint32_t size)
+/**
+ * Write given header and payload buffers with one gathered socket
+ * write, or one write per buffer if not supported by the socket.
+ */
+static ssize_t write_iov(struct http_websocket_server_t *self_p,
+                         struct iov_t *iov_p,
+                         size_t length,
+                         size_t size)
+{
+    ssize_t res;
+    size_t i;
+
+    res = socket_writev(self_p->socket_p, iov_p, length);
+
+    if (res != -ENOSYS) {
+        return (res);
+    }
+
+    for (i = 0; i < length; i++) {
+        if (iov_p[i].size == 0) {
+            continue;
+        }
+
+        if (socket_write(self_p->socket_p,
+                         iov_p[i].buf_p,
+                         iov_p[i].size) != iov_p[i].size) {
+            return (-EIO);
+        }
+    }
+
+    return (size);
+}
+
+ssize_t http_websocket_server_writev(struct http_websocket_server_t *self_p,
+                                     int type,
+                                     const struct iov_t *iov_p,
+                                     size_t length)
 {
     ASSERTN(self_p != NULL, EINVAL)
-    ASSERTN(buf_p != NULL, EINVAL)
-    ASSERTN(size > 0, EINVAL)
+    ASSERTN(iov_p != NULL, EINVAL)
+    ASSERTN(length > 0, EINVAL)
+    ASSERTN(length <= CONFIG_HTTP_WEBSOCKET_SERVER_IOV_MAX, EINVAL)
 
     uint8_t header[16];
     size_t header_size = 2;
+    struct iov_t iov[1 + CONFIG_HTTP_WEBSOCKET_SERVER_IOV_MAX];
+    uint32_t size;
+    size_t i;
+
+#if CONFIG_HTTP_WEBSOCKET_DEFLATE == 1
+    if (self_p->deflate.enabled == 1) {
+        return (http_websocket_deflate_writev(&self_p->deflate,
+                                              type,
+                                              iov_p,
+                                              length));
+    }
+#endif
+
+    size = 0;
+
+    for (i = 0; i < length; i++) {
+        size += iov_p[i].size;
+        iov[i + 1] = iov_p[i];
+    }
 
     header[0] = (INET_HTTP_WEBSOCKET_FIN | type);
 
@@ -220,15 +412,33 @@ ssize_t http_websocket_server_write(struct http_websocket_server_t *self_p,
         header_size += 8;
     }
 
-    if (socket_write(self_p->socket_p,
-                     header,
-                     header_size) != header_size) {
-        return (-EIO);
-    }
+    /* The header and the payload in one gathered write. */
+    iov[0].buf_p = &header[0];
+    iov[0].size = header_size;
 
-    if (socket_write(self_p->socket_p, buf_p, size) != size) {
+    if (write_iov(self_p,
+                  &iov[0],
+                  length + 1,
+                  header_size + size) != (header_size + size)) {
         return (-EIO);
     }
 
     return (size);
 }
+
+ssize_t http_websocket_server_write(struct http_websocket_server_t *self_p,
+                                    int type,
+                                    const void *buf_p,
+                                    uint32_t size)
+{
+    ASSERTN(self_p != NULL, EINVAL)
+    ASSERTN(buf_p != NULL, EINVAL)
+    ASSERTN(size > 0, EINVAL)
+
+    struct iov_t iov;
+
+    iov.buf_p = (void *)buf_p;
+    iov.size = size;
+
+    return (http_websocket_server_writev(self_p, type, &iov, 1));
+}
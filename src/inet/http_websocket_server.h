@@ -33,6 +33,9 @@
 
 struct http_websocket_server_t {
     struct socket_t *socket_p;
+#if CONFIG_HTTP_WEBSOCKET_DEFLATE == 1
+    struct http_websocket_deflate_t deflate;
+#endif
 };
 
 /**
@@ -49,7 +52,8 @@ int http_websocket_server_init(struct http_websocket_server_t *self_p,
 
 /**
  * Read the handshake request from the client and send the handshake
- * response.
+ * response. The permessage-deflate extension is accepted if offered
+ * by the client and ``CONFIG_HTTP_WEBSOCKET_DEFLATE`` is enabled.
  *
  * @param[in] self_p Websocket server.
  * @param[in] request_p Read handshake request.
@@ -60,7 +64,8 @@ int http_websocket_server_handshake(struct http_websocket_server_t *self_p,
                                     struct http_server_request_t *request_p);
 
 /**
- * Read a message from given websocket.
+ * Read a message from given websocket. Compressed messages are
+ * decompressed.
  *
  * @param[in] self_p Websocket to read from.
  * @param[out] type_p Read message type.
@@ -75,6 +80,23 @@ ssize_t http_websocket_server_read(struct http_websocket_server_t *self_p,
                                    void *buf_p,
                                    size_t size);
 
+/**
+ * Write given data buffers as one frame to given websocket. The
+ * header and all buffers are written with one gathered socket write.
+ *
+ * @param[in] self_p Websocket to write to.
+ * @param[in] type One of ``HTTP_TYPE_TEXT`` and ``HTTP_TYPE_BINARY``.
+ * @param[in] iov_p Array of buffers to write.
+ * @param[in] length Number of buffers in the array. At most
+ *                   ``CONFIG_HTTP_WEBSOCKET_SERVER_IOV_MAX``.
+ *
+ * @return Number of bytes written or negative error code.
+ */
+ssize_t http_websocket_server_writev(struct http_websocket_server_t *self_p,
+                                     int type,
+                                     const struct iov_t *iov_p,
+                                     size_t length);
+
 /**
  * Write given message to given websocket.
  *
@@ -28,35 +28,79 @@
 
 #include "simba.h"
 
-static uint32_t inet_checksum_begin(void)
-{
-  return (0);
-}
-
-static uint32_t inet_checksum_acc(uint32_t acc, uint16_t *buf_p, size_t size)
+/**
+ * Returns the ones' complement sum of all 16 bit words in given
+ * buffer in memory byte order. Four 32 bit words are added to a 64
+ * bit accumulator per iteration, and the carries are folded once at
+ * the end instead of after each addition.
+ */
+static uint16_t checksum_sum(const uint8_t *buf_p, size_t size)
 {
-    while (size > 1) {
-        acc += htons(*buf_p);
+    uint64_t acc;
+    uint32_t sum;
+    uint16_t word;
+    int odd;
+
+    acc = 0;
+    odd = ((uintptr_t)buf_p & 1);
+
+    /* Align to a 16 bit boundary. The sum is byte swapped at the
+       end to compensate. */
+    if (odd && (size > 0)) {
+        word = 0;
+        ((uint8_t *)&word)[1] = *buf_p;
+        acc += word;
         buf_p++;
+        size--;
+    }
+
+    /* Align to a 32 bit boundary. */
+    if (((uintptr_t)buf_p & 2) && (size >= 2)) {
+        acc += *(const uint16_t *)buf_p;
+        buf_p += 2;
         size -= 2;
     }
 
-    if (size > 0) {
-        acc += (htons(*buf_p) & 0xff00);
+    while (size >= 16) {
+        acc += ((const uint32_t *)buf_p)[0];
+        acc += ((const uint32_t *)buf_p)[1];
+        acc += ((const uint32_t *)buf_p)[2];
+        acc += ((const uint32_t *)buf_p)[3];
+        buf_p += 16;
+        size -= 16;
     }
 
-    return (acc);
-}
+    while (size >= 4) {
+        acc += *(const uint32_t *)buf_p;
+        buf_p += 4;
+        size -= 4;
+    }
 
-static uint16_t inet_checksum_end(uint32_t acc)
-{
-    acc = (acc >> 16) + (acc & 0xffffUL);
+    if (size >= 2) {
+        acc += *(const uint16_t *)buf_p;
+        buf_p += 2;
+        size -= 2;
+    }
 
-    if ((acc & 0xffff0000UL) != 0) {
-        acc = (acc >> 16) + (acc & 0xffffUL);
+    /* Pad a trailing byte with a zero byte. */
+    if (size > 0) {
+        word = 0;
+        ((uint8_t *)&word)[0] = *buf_p;
+        acc += word;
     }
 
-    return (~acc);
+    /* Fold the carries. */
+    acc = (acc >> 32) + (acc & 0xffffffffUL);
+    acc = (acc >> 32) + (acc & 0xffffffffUL);
+    sum = (uint32_t)acc;
+    sum = (sum >> 16) + (sum & 0xffffUL);
+    sum = (sum >> 16) + (sum & 0xffffUL);
+
+    if (odd) {
+        sum = (((sum & 0xff) << 8) | (sum >> 8));
+    }
+
+    return (sum);
 }
 
 int inet_module_init()
@@ -125,10 +169,10 @@ char *inet_ntoa(const struct inet_ip_addr_t *src_p,
 
 uint16_t inet_checksum(void *buf_p, size_t size)
 {
-    uint32_t acc;
-
-    acc = inet_checksum_begin();
-    acc = inet_checksum_acc(acc, buf_p, size);
+    return (~ntohs(checksum_sum(buf_p, size)));
+}
 
-    return (inet_checksum_end(acc));
+uint16_t inet_checksum_sum(const void *buf_p, size_t size)
+{
+    return (checksum_sum(buf_p, size));
 }
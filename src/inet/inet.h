@@ -105,4 +105,17 @@ char *inet_ntoa(const struct inet_ip_addr_t *src_p,
  */
 uint16_t inet_checksum(void *buf_p, size_t size);
 
+/**
+ * Calculate the ones' complement sum of all 16 bit words in given
+ * buffer, without complementing it. The sum is returned in network
+ * byte order, and is used by the lwIP stack to checksum all packets,
+ * see ``LWIP_CHKSUM`` in ``arch/cc.h``.
+ *
+ * @param[in] buf_p Buffer to calculate the sum of.
+ * @param[in] size Size of the buffer.
+ *
+ * @return Calculated sum in network byte order.
+ */
+uint16_t inet_checksum_sum(const void *buf_p, size_t size);
+
 #endif
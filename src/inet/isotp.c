@@ -25,7 +25,6 @@
  *
  * This file is part of the Simba project.
  */
-
 #include "simba.h"
 
 #define TYPE_SINGLE_FRAME                          0
@@ -33,6 +32,18 @@
 #define TYPE_CONSECUTIVE_FRAME                     2
 #define TYPE_FLOW_CONTROL_FRAME                    3
 
+/* Flow status of flow control frames. */
+#define FLOW_STATUS_CONTINUE_TO_SEND               0
+#define FLOW_STATUS_WAIT                           1
+#define FLOW_STATUS_OVERFLOW                       2
+
+/* Classic CAN frame size. */
+#define FRAME_SIZE                                 8
+
+/* Largest message length in the 12 bits length field of a first
+   frame. Longer messages use the 32 bits escape sequence. */
+#define FIRST_FRAME_LENGTH_MAX                  4095
+
 enum state_t {
     state_idle_t = 0,
 
@@ -45,51 +56,125 @@ enum state_t {
     state_flow_control_frame_received_t
 };
 
+/**
+ * Returns the largest message length that fits in a single frame.
+ */
+static size_t single_frame_length_max(struct isotp_t *self_p)
+{
+    if (self_p->frame_size == FRAME_SIZE) {
+        return (FRAME_SIZE - 1);
+    } else {
+        return (self_p->frame_size - 2);
+    }
+}
+
+/**
+ * Decode given separation time in ISO-TP encoding to microseconds.
+ */
+static int decode_separation_time(int separation_time)
+{
+    if (separation_time <= 0x7f) {
+        return (1000 * separation_time);
+    } else if ((separation_time >= 0xf1) && (separation_time <= 0xf9)) {
+        return (100 * (separation_time - 0xf0));
+    } else {
+        /* Reserved values means the longest separation time. */
+        return (127000);
+    }
+}
+
 static ssize_t handle_input_idle(struct isotp_t *self_p,
                                  const uint8_t *buf_p,
                                  size_t size)
 {
     int res;
     int type;
+    size_t length;
+    size_t offset;
 
     type = (buf_p[0] >> 4);
 
     switch (type) {
 
     case TYPE_SINGLE_FRAME:
-        size = (buf_p[0] & 0x0f);
+        length = (buf_p[0] & 0x0f);
+        offset = 1;
+
+        /* Length in the second byte of CAN FD frames. */
+        if ((length == 0)
+            && (self_p->flags & ISOTP_FLAGS_CAN_FD)
+            && (size >= 2)) {
+            length = buf_p[1];
+            offset = 2;
+
+            if (length > single_frame_length_max(self_p)) {
+                res = -1;
+                break;
+            }
+        } else if (length > 7) {
+            res = -1;
+            break;
+        }
 
-        if ((size > 7) || (size == 0)) {
+        if ((length == 0) || (length > (size - offset))) {
             res = -1;
             break;
         }
 
-        if (size > self_p->size) {
+        if (length > self_p->size) {
             res = -1;
             break;
         }
 
-        memcpy(self_p->message_p, &buf_p[1], size);
-        res = size;
+        memcpy(self_p->message_p, &buf_p[offset], length);
+        res = length;
         break;
 
     case TYPE_FIRST_FRAME:
-        size = (((buf_p[0] & 0x0f) << 8) | buf_p[1]);
+        if (size < 2) {
+            res = -1;
+            break;
+        }
+
+        length = (((buf_p[0] & 0x0f) << 8) | buf_p[1]);
+        offset = 2;
+
+        /* Escape sequence with a 32 bits length. */
+        if (length == 0) {
+            if (size < 6) {
+                res = -1;
+                break;
+            }
+
+            length = (((uint32_t)buf_p[2] << 24)
+                      | ((uint32_t)buf_p[3] << 16)
+                      | ((uint32_t)buf_p[4] << 8)
+                      | ((uint32_t)buf_p[5] << 0));
+            offset = 6;
+        }
 
-        if (size < 8) {
+        if (length <= single_frame_length_max(self_p)) {
             res = -1;
             break;
         }
 
-        if (size > self_p->size) {
+        if (length > self_p->size) {
             res = -1;
             break;
         }
 
-        memcpy(self_p->message_p, &buf_p[2], 6);
-        self_p->message.size = size;
-        self_p->message.offset = 6;
+        size = (MIN(size, self_p->frame_size) - offset);
+
+        if (size == 0) {
+            res = -1;
+            break;
+        }
+
+        memcpy(self_p->message_p, &buf_p[offset], size);
+        self_p->message.size = length;
+        self_p->message.offset = size;
         self_p->message.next_index = 1;
+        self_p->message.block_counter = 0;
 
         if (self_p->flags & ISOTP_FLAGS_NO_FLOW_CONTROL) {
             self_p->state = state_flow_control_frame_sent_t;
@@ -124,7 +209,24 @@ static ssize_t handle_input_first_frame_sent(struct isotp_t *self_p,
         return (-1);
     }
 
-    self_p->state = state_flow_control_frame_received_t;
+    switch (buf_p[0] & 0x0f) {
+
+    case FLOW_STATUS_CONTINUE_TO_SEND:
+        self_p->message.block_size = buf_p[1];
+        self_p->message.block_counter = 0;
+        self_p->message.separation_time_us = decode_separation_time(buf_p[2]);
+        self_p->state = state_flow_control_frame_received_t;
+        break;
+
+    case FLOW_STATUS_WAIT:
+        break;
+
+    default:
+        /* The receiver cannot take the whole message. */
+        self_p->state = state_idle_t;
+
+        return (-1);
+    }
 
     return (0);
 }
@@ -149,16 +251,26 @@ static ssize_t handle_input_flow_control_sent(struct isotp_t *self_p,
         return (-1);
     }
 
-    memcpy(&self_p->message_p[self_p->message.offset], &buf_p[1], size - 1);
-    self_p->message.offset += (size - 1);
+    /* Padding after the end of the message is discarded. */
+    size = MIN(size - 1, self_p->message.size - self_p->message.offset);
+    memcpy(&self_p->message_p[self_p->message.offset], &buf_p[1], size);
+    self_p->message.offset += size;
     self_p->message.next_index++;
     self_p->message.next_index %= 16;
+    res = 0;
 
     if (self_p->message.offset >= self_p->message.size) {
         res = self_p->message.size;
         self_p->state = state_idle_t;
-    } else {
-        res = 0;
+    } else if (self_p->flow_control.block_size > 0) {
+        self_p->message.block_counter++;
+
+        /* Send another flow control frame after each block. */
+        if ((self_p->message.block_counter == self_p->flow_control.block_size)
+            && !(self_p->flags & ISOTP_FLAGS_NO_FLOW_CONTROL)) {
+            self_p->message.block_counter = 0;
+            self_p->state = state_first_frame_received_t;
+        }
     }
 
     return (res);
@@ -168,15 +280,7 @@ static ssize_t handle_input_flow_control_received(struct isotp_t *self_p,
                                                   const uint8_t *buf_p,
                                                   size_t size)
 {
-    int type;
-
-    type = (buf_p[0] >> 4);
-
-    if (type != TYPE_FLOW_CONTROL_FRAME) {
-        return (-1);
-    }
-
-    return (0);
+    return (handle_input_first_frame_sent(self_p, buf_p, size));
 }
 
 static ssize_t handle_output_idle(struct isotp_t *self_p,
@@ -184,21 +288,45 @@ static ssize_t handle_output_idle(struct isotp_t *self_p,
                                   size_t *output_size_p)
 {
     int res;
+    size_t offset;
+    size_t size;
 
     res = 0;
 
-    if (self_p->size < 8) {
+    if (self_p->size <= 7) {
         output_p[0] = ((TYPE_SINGLE_FRAME << 4) | self_p->size);
         memcpy(&output_p[1], self_p->message_p, self_p->size);
         *output_size_p = (self_p->size + 1);
         res = self_p->size;
-    } else {
-        output_p[0] = ((TYPE_FIRST_FRAME << 4) | (self_p->size >> 8));
+    } else if (self_p->size <= single_frame_length_max(self_p)) {
+        output_p[0] = (TYPE_SINGLE_FRAME << 4);
         output_p[1] = self_p->size;
-        memcpy(&output_p[2], self_p->message_p, 6);
-        *output_size_p = 8;
-        self_p->message.offset = 6;
+        memcpy(&output_p[2], self_p->message_p, self_p->size);
+        *output_size_p = (self_p->size + 2);
+        res = self_p->size;
+    } else {
+        if (self_p->size <= FIRST_FRAME_LENGTH_MAX) {
+            output_p[0] = ((TYPE_FIRST_FRAME << 4) | (self_p->size >> 8));
+            output_p[1] = self_p->size;
+            offset = 2;
+        } else {
+            output_p[0] = (TYPE_FIRST_FRAME << 4);
+            output_p[1] = 0;
+            output_p[2] = (self_p->size >> 24);
+            output_p[3] = (self_p->size >> 16);
+            output_p[4] = (self_p->size >> 8);
+            output_p[5] = (self_p->size >> 0);
+            offset = 6;
+        }
+
+        size = (self_p->frame_size - offset);
+        memcpy(&output_p[offset], self_p->message_p, size);
+        *output_size_p = self_p->frame_size;
+        self_p->message.offset = size;
         self_p->message.next_index = 1;
+        self_p->message.block_size = 0;
+        self_p->message.block_counter = 0;
+        self_p->message.separation_time_us = 0;
 
         if (self_p->flags & ISOTP_FLAGS_NO_FLOW_CONTROL) {
             self_p->state = state_flow_control_frame_received_t;
@@ -214,9 +342,9 @@ static ssize_t handle_output_first_frame_received(struct isotp_t *self_p,
                                                   uint8_t *buf_p,
                                                   size_t *size_p)
 {
-    buf_p[0] = (TYPE_FLOW_CONTROL_FRAME << 4);
-    buf_p[1] = 0;
-    buf_p[2] = 0;
+    buf_p[0] = ((TYPE_FLOW_CONTROL_FRAME << 4) | FLOW_STATUS_CONTINUE_TO_SEND);
+    buf_p[1] = self_p->flow_control.block_size;
+    buf_p[2] = self_p->flow_control.separation_time;
     *size_p = 3;
     self_p->state = state_flow_control_frame_sent_t;
 
@@ -233,7 +361,7 @@ static ssize_t handle_output_flow_control_received(struct isotp_t *self_p,
     res = 0;
 
     buf_p[0] = ((TYPE_CONSECUTIVE_FRAME << 4) | self_p->message.next_index);
-    size = MIN(self_p->size - self_p->message.offset, 7);
+    size = MIN(self_p->size - self_p->message.offset, self_p->frame_size - 1);
     memcpy(&buf_p[1], &self_p->message_p[self_p->message.offset], size);
     *size_p = (size + 1);
     self_p->message.offset += size;
@@ -243,6 +371,14 @@ static ssize_t handle_output_flow_control_received(struct isotp_t *self_p,
     if (self_p->message.offset >= self_p->size) {
         self_p->state = state_idle_t;
         res = self_p->size;
+    } else if (self_p->message.block_size > 0) {
+        self_p->message.block_counter++;
+
+        /* Wait for a flow control frame after each block. */
+        if ((self_p->message.block_counter == self_p->message.block_size)
+            && !(self_p->flags & ISOTP_FLAGS_NO_FLOW_CONTROL)) {
+            self_p->state = state_first_frame_sent_t;
+        }
     }
 
     return (res);
@@ -262,9 +398,40 @@ int isotp_init(struct isotp_t *self_p,
     self_p->state = state_idle_t;
     self_p->flags = flags;
 
+    if (flags & ISOTP_FLAGS_CAN_FD) {
+        self_p->frame_size = ISOTP_FRAME_SIZE_MAX;
+    } else {
+        self_p->frame_size = FRAME_SIZE;
+    }
+
+    self_p->flow_control.block_size = 0;
+    self_p->flow_control.separation_time = 0;
+    self_p->message.separation_time_us = 0;
+
+    return (0);
+}
+
+int isotp_set_flow_control(struct isotp_t *self_p,
+                           int block_size,
+                           int separation_time)
+{
+    ASSERTN(self_p != NULL, EINVAL);
+    ASSERTN((block_size >= 0) && (block_size <= 255), EINVAL);
+    ASSERTN((separation_time >= 0) && (separation_time <= 255), EINVAL);
+
+    self_p->flow_control.block_size = block_size;
+    self_p->flow_control.separation_time = separation_time;
+
     return (0);
 }
 
+int isotp_get_separation_time_us(struct isotp_t *self_p)
+{
+    ASSERTN(self_p != NULL, EINVAL);
+
+    return (self_p->message.separation_time_us);
+}
+
 ssize_t isotp_input(struct isotp_t *self_p,
                     const uint8_t *buf_p,
                     size_t size)
@@ -274,6 +441,10 @@ ssize_t isotp_input(struct isotp_t *self_p,
 
     ssize_t res;
 
+    if (size == 0) {
+        return (-1);
+    }
+
     switch (self_p->state) {
 
     case state_idle_t:
@@ -337,3 +508,220 @@ ssize_t isotp_output(struct isotp_t *self_p,
 
     return (res);
 }
+
+#if CONFIG_CAN == 1
+
+static int manager_write_frame(struct isotp_manager_t *self_p,
+                               uint32_t id,
+                               const uint8_t *buf_p,
+                               size_t size)
+{
+    struct can_frame_t frame;
+
+    memset(&frame, 0, sizeof(frame));
+    frame.id = id;
+    frame.extended_frame = (id > 0x7ff);
+    frame.size = size;
+    memcpy(&frame.data.u8[0], buf_p, size);
+
+    if (can_write(self_p->can_p, &frame, sizeof(frame)) != sizeof(frame)) {
+        return (-1);
+    }
+
+    return (0);
+}
+
+/**
+ * Transmit consecutive frames of given session until the message is
+ * complete or the peer must send a flow control frame.
+ */
+static ssize_t manager_transmit(struct isotp_manager_t *self_p,
+                                struct isotp_session_t *session_p)
+{
+    ssize_t res;
+    uint8_t buf[FRAME_SIZE];
+    size_t size;
+
+    while (1) {
+        res = isotp_output(&session_p->tx.isotp, &buf[0], &size);
+
+        if (size > 0) {
+            if (manager_write_frame(self_p,
+                                    session_p->tx_id,
+                                    &buf[0],
+                                    size) != 0) {
+                res = -1;
+            }
+        }
+
+        if ((res != 0) || (size == 0)) {
+            break;
+        }
+
+        if ((session_p->tx.isotp.state == state_flow_control_frame_received_t)
+            && (session_p->tx.isotp.message.separation_time_us > 0)) {
+            thrd_sleep_us(session_p->tx.isotp.message.separation_time_us);
+        }
+    }
+
+    if (res != 0) {
+        session_p->tx.busy = 0;
+    }
+
+    return (res);
+}
+
+int isotp_manager_init(struct isotp_manager_t *self_p,
+                       struct can_driver_t *can_p)
+{
+    ASSERTN(self_p != NULL, EINVAL);
+    ASSERTN(can_p != NULL, EINVAL);
+
+    self_p->can_p = can_p;
+    self_p->sessions_p = NULL;
+
+    return (0);
+}
+
+int isotp_manager_add_session(struct isotp_manager_t *self_p,
+                              struct isotp_session_t *session_p,
+                              uint32_t rx_id,
+                              uint32_t tx_id,
+                              uint8_t *buf_p,
+                              size_t size,
+                              int flags)
+{
+    ASSERTN(self_p != NULL, EINVAL);
+    ASSERTN(session_p != NULL, EINVAL);
+    ASSERTN(buf_p != NULL, EINVAL);
+
+    /* The CAN driver only has classic frames. */
+    if (flags & ISOTP_FLAGS_CAN_FD) {
+        return (-ENOSYS);
+    }
+
+    if (isotp_init(&session_p->rx, buf_p, size, flags) != 0) {
+        return (-1);
+    }
+
+    session_p->rx_id = rx_id;
+    session_p->tx_id = tx_id;
+    session_p->flags = flags;
+    session_p->tx.busy = 0;
+    session_p->next_p = self_p->sessions_p;
+    self_p->sessions_p = session_p;
+
+    return (0);
+}
+
+ssize_t isotp_manager_write(struct isotp_manager_t *self_p,
+                            struct isotp_session_t *session_p,
+                            const uint8_t *message_p,
+                            size_t size)
+{
+    ASSERTN(self_p != NULL, EINVAL);
+    ASSERTN(session_p != NULL, EINVAL);
+    ASSERTN(message_p != NULL, EINVAL);
+
+    if (session_p->tx.busy == 1) {
+        return (-EBUSY);
+    }
+
+    if (isotp_init(&session_p->tx.isotp,
+                   (uint8_t *)message_p,
+                   size,
+                   session_p->flags) != 0) {
+        return (-1);
+    }
+
+    session_p->tx.busy = 1;
+
+    return (manager_transmit(self_p, session_p));
+}
+
+ssize_t isotp_manager_input(struct isotp_manager_t *self_p,
+                            const struct can_frame_t *frame_p,
+                            struct isotp_session_t **session_pp)
+{
+    ASSERTN(self_p != NULL, EINVAL);
+    ASSERTN(frame_p != NULL, EINVAL);
+    ASSERTN(session_pp != NULL, EINVAL);
+
+    struct isotp_session_t *session_p;
+    ssize_t res;
+    uint8_t buf[FRAME_SIZE];
+    size_t size;
+
+    *session_pp = NULL;
+    session_p = self_p->sessions_p;
+
+    while (session_p != NULL) {
+        if (session_p->rx_id == frame_p->id) {
+            break;
+        }
+
+        session_p = session_p->next_p;
+    }
+
+    /* Ignore frames of other nodes. */
+    if ((session_p == NULL) || (frame_p->size == 0)) {
+        return (0);
+    }
+
+    *session_pp = session_p;
+
+    /* Flow control frames belongs to the outgoing message, all other
+       frames to the incoming message. */
+    if ((frame_p->data.u8[0] >> 4) == TYPE_FLOW_CONTROL_FRAME) {
+        if (session_p->tx.busy == 0) {
+            return (-1);
+        }
+
+        res = isotp_input(&session_p->tx.isotp,
+                          &frame_p->data.u8[0],
+                          frame_p->size);
+
+        if (res != 0) {
+            session_p->tx.busy = 0;
+
+            return (res);
+        }
+
+        res = manager_transmit(self_p, session_p);
+
+        return (res < 0 ? res : 0);
+    }
+
+    res = isotp_input(&session_p->rx,
+                      &frame_p->data.u8[0],
+                      frame_p->size);
+
+    if (res < 0) {
+        /* Drop the partly received message. */
+        session_p->rx.state = state_idle_t;
+
+        return (res);
+    }
+
+    /* Send a flow control frame if requested. */
+    if (session_p->rx.state == state_first_frame_received_t) {
+        if (isotp_output(&session_p->rx, &buf[0], &size) != 0) {
+            return (-1);
+        }
+
+        if (manager_write_frame(self_p, session_p->tx_id, &buf[0], size) != 0) {
+            return (-1);
+        }
+    }
+
+    return (res);
+}
+
+int isotp_manager_is_writing(struct isotp_session_t *session_p)
+{
+    ASSERTN(session_p != NULL, EINVAL);
+
+    return (session_p->tx.busy);
+}
+
+#endif
@@ -33,15 +33,34 @@
 
 #define ISOTP_FLAGS_NO_FLOW_CONTROL            (1 << 0)
 
+/**
+ * Use CAN FD frames of up to 64 bytes instead of classic 8 bytes CAN
+ * frames.
+ */
+#define ISOTP_FLAGS_CAN_FD                     (1 << 1)
+
+/**
+ * Maximum frame size in bytes.
+ */
+#define ISOTP_FRAME_SIZE_MAX                   64
+
 struct isotp_t {
     uint8_t *message_p;
     size_t size;
     int state;
     int flags;
+    size_t frame_size;
+    struct {
+        int block_size;
+        int separation_time;
+    } flow_control;
     struct {
         size_t size;
         size_t offset;
         int next_index;
+        int block_counter;
+        int block_size;
+        int separation_time_us;
     } message;
 };
 
@@ -67,6 +86,37 @@ int isotp_init(struct isotp_t *self_p,
                size_t size,
                int flags);
 
+/**
+ * Set the block size and minimum separation time sent in flow
+ * control frames of a receiving ISO-TP object. The peer sends at most
+ * block size consecutive frames per flow control frame, waiting at
+ * least the separation time between them. Both are zero(0) by
+ * default, that is, all consecutive frames as fast as possible.
+ *
+ * @param[in] self_p Initialized ISO-TP object.
+ * @param[in] block_size Block size, 0-255. Zero(0) for no limit.
+ * @param[in] separation_time Minimum separation time in ISO-TP
+ *                            encoding. 0-127 milliseconds, or 0xf1-0xf9
+ *                            for 100-900 microseconds.
+ *
+ * @return zero(0) or negative error code.
+ */
+int isotp_set_flow_control(struct isotp_t *self_p,
+                           int block_size,
+                           int separation_time);
+
+/**
+ * Get the minimum separation time in microseconds between
+ * consecutive frames of a transmitting ISO-TP object, as requested by
+ * the peer in its last flow control frame. The caller should wait at
+ * least this long before calling isotp_output() again.
+ *
+ * @param[in] self_p Initialized ISO-TP object.
+ *
+ * @return Separation time in microseconds.
+ */
+int isotp_get_separation_time_us(struct isotp_t *self_p);
+
 /**
  * Input a CAN frame into given ISO-TP object. Always call
  * isotp_output() after this function returns zero(0) to check if
@@ -94,7 +144,8 @@ ssize_t isotp_input(struct isotp_t *self_p,
  *
  * @param[in] self_p Initialized ISO-TP object.
  * @param[out] buf_p Output data to be transmitted to the peer. The
- *                   size of this buffer must be at least eight bytes.
+ *                   size of this buffer must be at least eight bytes,
+ *                   or ``ISOTP_FRAME_SIZE_MAX`` bytes for CAN FD.
  * @param[out] size_p Number of bytes to be transmitted.
  *
  * @return Once a complete ISO-TP message has been transmitted the
@@ -108,4 +159,117 @@ ssize_t isotp_output(struct isotp_t *self_p,
                      uint8_t *buf_p,
                      size_t *size_p);
 
+#if CONFIG_CAN == 1
+
+/**
+ * An ISO-TP session between two nodes, identified by a pair of CAN
+ * frame ids. A message can be received and transmitted at the same
+ * time.
+ */
+struct isotp_session_t {
+    uint32_t rx_id;
+    uint32_t tx_id;
+    int flags;
+    struct isotp_t rx;
+    struct {
+        struct isotp_t isotp;
+        int busy;
+    } tx;
+    struct isotp_session_t *next_p;
+};
+
+/**
+ * Multiplexes many ISO-TP sessions over one CAN driver.
+ */
+struct isotp_manager_t {
+    struct can_driver_t *can_p;
+    struct isotp_session_t *sessions_p;
+};
+
+/**
+ * Initialize given ISO-TP manager.
+ *
+ * @param[in] self_p Manager to initialize.
+ * @param[in] can_p Started CAN driver to transmit frames on.
+ *
+ * @return zero(0) or negative error code.
+ */
+int isotp_manager_init(struct isotp_manager_t *self_p,
+                       struct can_driver_t *can_p);
+
+/**
+ * Add given session to given manager. Use isotp_set_flow_control()
+ * on ``rx`` of the session to set the block size and separation time
+ * of incoming messages.
+ *
+ * @param[in] self_p Initialized manager.
+ * @param[in] session_p Session to add.
+ * @param[in] rx_id CAN frame id of frames sent by the peer.
+ * @param[in] tx_id CAN frame id of frames sent to the peer.
+ * @param[in] buf_p Reception buffer for incoming messages.
+ * @param[in] size Size of the reception buffer in bytes.
+ * @param[in] flags Configuration flags. ``ISOTP_FLAGS_CAN_FD`` is not
+ *                  supported as the CAN driver only has classic
+ *                  frames.
+ *
+ * @return zero(0) or negative error code.
+ */
+int isotp_manager_add_session(struct isotp_manager_t *self_p,
+                              struct isotp_session_t *session_p,
+                              uint32_t rx_id,
+                              uint32_t tx_id,
+                              uint8_t *buf_p,
+                              size_t size,
+                              int flags);
+
+/**
+ * Start transmitting given message in given session. Single frame
+ * messages are transmitted immediately. Longer messages are
+ * transmitted by isotp_manager_input() as the peer's flow control
+ * frames are received. The message buffer must be valid until the
+ * transmission is complete, see isotp_manager_is_writing().
+ *
+ * @param[in] self_p Initialized manager.
+ * @param[in] session_p Session to transmit the message in.
+ * @param[in] message_p Message to transmit.
+ * @param[in] size Size of the message in bytes.
+ *
+ * @return Size of the message if completely transmitted, zero(0) if
+ *         the transmission continues, -EBUSY if the session already
+ *         transmits a message, or other negative error code.
+ */
+ssize_t isotp_manager_write(struct isotp_manager_t *self_p,
+                            struct isotp_session_t *session_p,
+                            const uint8_t *message_p,
+                            size_t size);
+
+/**
+ * Input a CAN frame read from the CAN driver into given manager. The
+ * frame is passed to the session with matching receive id, and any
+ * frames that session replies with are transmitted. Frames of other
+ * ids are ignored.
+ *
+ * @param[in] self_p Initialized manager.
+ * @param[in] frame_p Received CAN frame.
+ * @param[out] session_pp Session the frame was passed to, or NULL.
+ *
+ * @return Size of the message if a complete message was received in
+ *         the session, otherwise zero(0) or negative error code.
+ */
+ssize_t isotp_manager_input(struct isotp_manager_t *self_p,
+                            const struct can_frame_t *frame_p,
+                            struct isotp_session_t **session_pp);
+
+/**
+ * Check if given session is transmitting a message.
+ *
+ * @param[in] session_p Session to check.
+ *
+ * @return true(1) if a message is being transmitted, otherwise
+ *         false(0).
+ */
+int isotp_manager_is_writing(struct isotp_session_t *session_p);
+
+#endif
+
 #endif
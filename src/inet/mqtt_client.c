@@ -59,6 +59,18 @@
 
 #define CONNECTION_ACCEPTED 0
 
+/** Connect acknowledge flags. */
+#define SESSION_PRESENT 0x1
+
+/** Publish flags. */
+#define DUP_FLAG        0x8
+
+/** In-flight message states. */
+#define INFLIGHT_FREE          0
+#define INFLIGHT_WAIT_PUBACK   1
+#define INFLIGHT_WAIT_PUBREC   2
+#define INFLIGHT_WAIT_PUBCOMP  3
+
 #define CONTROL_CONNECT        0
 #define CONTROL_DISCONNECT     1
 #define CONTROL_PING           2
@@ -66,10 +78,20 @@
 #define CONTROL_SUBSCRIBE      4
 #define CONTROL_UNSUBSCRIBE    5
 #define CONTROL_NONE           6
+#define CONTROL_REPLAY         7
+
+/** Size of an offline queue record header. */
+#define RECORD_HEADER_SIZE     8
 
 //! Length of a MQTT CONNECT variable header.
 #define CONNECT_VAR_HDR_LEN   10
 
+/** Messages to publish passed from the application. */
+struct publish_args_t {
+    struct mqtt_application_message_t *messages_p;
+    size_t length;
+};
+
 static const char *message_fmt[] = {
     "forbidden",
     "connect",
@@ -132,23 +154,48 @@ static int write_mqtt_string(struct mqtt_client_t *self_p,
 }
 
 /**
- * Write the fixed header of the MQTT message to the server.
+ * Write given buffers to the server, in one operation if the
+ * transport supports it.
  */
-static int write_fixed_header(struct mqtt_client_t *self_p,
-                              int type,
-                              int flags,
-                              size_t size)
+static int write_iov(struct mqtt_client_t *self_p,
+                     const struct iov_t *iov_p,
+                     size_t length)
+{
+    size_t i;
+    size_t size;
+
+    size = 0;
+
+    for (i = 0; i < length; i++) {
+        size += iov_p[i].size;
+    }
+
+    if (chan_writev(self_p->transport.out_p, iov_p, length) != size) {
+        return (-EIO);
+    }
+
+    return (0);
+}
+
+/**
+ * Encode the fixed header of a MQTT message into given buffer of at
+ * least five bytes. Returns the header size.
+ */
+static int encode_fixed_header(struct mqtt_client_t *self_p,
+                               uint8_t *buf_p,
+                               int type,
+                               int flags,
+                               size_t size)
 {
-    uint8_t buf[5];
     int pos;
     uint8_t encoded_byte;
 
-    log_object_print(self_p->log_object_p,
+    LOG_OBJECT_PRINT(self_p->log_object_p,
                      LOG_DEBUG,
                      OSTR("Writing MQTT message '%s' to the server.\r\n"),
                      message_fmt[type]);
 
-    buf[0] = (type << 4) | flags;
+    buf_p[0] = (type << 4) | flags;
     pos = 1;
 
     do {
@@ -162,10 +209,26 @@ static int write_fixed_header(struct mqtt_client_t *self_p,
             encoded_byte |= 0x80;
         }
 
-        buf[pos] = encoded_byte;
+        buf_p[pos] = encoded_byte;
         pos++;
     } while (size > 0);
 
+    return (pos);
+}
+
+/**
+ * Write the fixed header of the MQTT message to the server.
+ */
+static int write_fixed_header(struct mqtt_client_t *self_p,
+                              int type,
+                              int flags,
+                              size_t size)
+{
+    uint8_t buf[5];
+    int pos;
+
+    pos = encode_fixed_header(self_p, &buf[0], type, flags, size);
+
     if (chan_write(self_p->transport.out_p, &buf[0], pos) != pos) {
         return (-EIO);
     }
@@ -211,6 +274,233 @@ static int read_fixed_header(struct mqtt_client_t *self_p,
     return (0);
 }
 
+/**
+ * Write a packet identifier to the server.
+ */
+static int write_packet_id(struct mqtt_client_t *self_p,
+                           uint16_t packet_id)
+{
+    uint8_t buf[2];
+
+    buf[0] = MSB(packet_id);
+    buf[1] = LSB(packet_id);
+
+    if (chan_write(self_p->transport.out_p, &buf[0], 2) != 2) {
+        return (-EIO);
+    }
+
+    return (0);
+}
+
+/**
+ * Read a packet identifier from the server.
+ */
+static int read_packet_id(struct mqtt_client_t *self_p,
+                          size_t size,
+                          uint16_t *packet_id_p)
+{
+    uint8_t buf[2];
+
+    if (size != 2) {
+        return (-EMSGSIZE);
+    }
+
+    if (chan_read(self_p->transport.in_p, &buf[0], 2) != 2) {
+        return (-EIO);
+    }
+
+    *packet_id_p = (((uint16_t)buf[0] << 8) | buf[1]);
+
+    return (0);
+}
+
+/**
+ * Write a PUBACK, PUBREC, PUBREL or PUBCOMP packet to the server.
+ */
+static int write_ack(struct mqtt_client_t *self_p,
+                     int type,
+                     uint16_t packet_id)
+{
+    int res;
+
+    /* PUBREL has reserved flags 0b0010. */
+    res = write_fixed_header(self_p,
+                             type,
+                             (type == MQTT_PUBREL ? 2 : 0),
+                             2);
+
+    if (res != 0) {
+        return (res);
+    }
+
+    return (write_packet_id(self_p, packet_id));
+}
+
+/**
+ * Allocate a packet identifier not used by any in-flight message.
+ */
+static uint16_t alloc_packet_id(struct mqtt_client_t *self_p)
+{
+    uint16_t packet_id;
+    int i;
+
+    while (1) {
+        packet_id = self_p->inflight.next_packet_id++;
+
+        /* Zero is not a valid packet identifier. */
+        if (self_p->inflight.next_packet_id == 0) {
+            self_p->inflight.next_packet_id = 1;
+        }
+
+        for (i = 0; i < membersof(self_p->inflight.outgoing); i++) {
+            if ((self_p->inflight.outgoing[i].state != INFLIGHT_FREE)
+                && (self_p->inflight.outgoing[i].packet_id == packet_id)) {
+                break;
+            }
+        }
+
+        if (i == membersof(self_p->inflight.outgoing)) {
+            return (packet_id);
+        }
+    }
+}
+
+/**
+ * Find the in-flight message with given packet identifier.
+ */
+static struct mqtt_client_inflight_t *
+find_inflight(struct mqtt_client_t *self_p,
+              uint16_t packet_id)
+{
+    int i;
+    struct mqtt_client_inflight_t *inflight_p;
+
+    for (i = 0; i < membersof(self_p->inflight.outgoing); i++) {
+        inflight_p = &self_p->inflight.outgoing[i];
+
+        if ((inflight_p->state != INFLIGHT_FREE)
+            && (inflight_p->packet_id == packet_id)) {
+            return (inflight_p);
+        }
+    }
+
+    return (NULL);
+}
+
+/**
+ * Remove given message from the in-flight window.
+ */
+static void complete_inflight(struct mqtt_client_t *self_p,
+                              struct mqtt_client_inflight_t *inflight_p)
+{
+    inflight_p->state = INFLIGHT_FREE;
+    self_p->inflight.length--;
+}
+
+/**
+ * Write a publish message to the server. The header, topic and
+ * payload are written in a single gathered write, without copying
+ * the topic and payload.
+ */
+static int write_publish(struct mqtt_client_t *self_p,
+                         struct mqtt_application_message_t *message_p,
+                         uint16_t packet_id,
+                         int dup)
+{
+    int pos;
+    int flags;
+    size_t size;
+    uint8_t header[7];
+    uint8_t packet_id_buf[2];
+    struct iov_t iov[4];
+
+    size = (message_p->topic.size + message_p->payload.size + 2);
+    flags = (message_p->qos << 1);
+
+    if (message_p->qos > 0) {
+        size += 2;
+    }
+
+    if (dup == 1) {
+        flags |= DUP_FLAG;
+    }
+
+    /* The fixed header followed by the topic length. */
+    pos = encode_fixed_header(self_p, &header[0], MQTT_PUBLISH, flags, size);
+    header[pos++] = MSB(message_p->topic.size);
+    header[pos++] = LSB(message_p->topic.size);
+
+    iov[0].buf_p = &header[0];
+    iov[0].size = pos;
+    iov[1].buf_p = (void *)message_p->topic.buf_p;
+    iov[1].size = message_p->topic.size;
+    iov[2].buf_p = &packet_id_buf[0];
+    iov[2].size = 0;
+    iov[3].buf_p = (void *)message_p->payload.buf_p;
+    iov[3].size = message_p->payload.size;
+
+    if (message_p->qos > 0) {
+        packet_id_buf[0] = MSB(packet_id);
+        packet_id_buf[1] = LSB(packet_id);
+        iov[2].size = 2;
+    }
+
+    return (write_iov(self_p, &iov[0], membersof(iov)));
+}
+
+/**
+ * Retransmit all in-flight messages after a reconnect. Messages that
+ * the server already has received are dropped if the session was not
+ * resumed.
+ */
+static int retransmit_inflight(struct mqtt_client_t *self_p,
+                               int session_present)
+{
+    int i;
+    int res;
+    struct mqtt_client_inflight_t *inflight_p;
+
+    if (session_present == 0) {
+        memset(&self_p->inflight.incoming[0],
+               0,
+               sizeof(self_p->inflight.incoming));
+    }
+
+    for (i = 0; i < membersof(self_p->inflight.outgoing); i++) {
+        inflight_p = &self_p->inflight.outgoing[i];
+
+        switch (inflight_p->state) {
+
+        case INFLIGHT_WAIT_PUBACK:
+        case INFLIGHT_WAIT_PUBREC:
+            res = write_publish(self_p,
+                                &inflight_p->message,
+                                inflight_p->packet_id,
+                                session_present);
+            break;
+
+        case INFLIGHT_WAIT_PUBCOMP:
+            if (session_present == 1) {
+                res = write_ack(self_p, MQTT_PUBREL, inflight_p->packet_id);
+            } else {
+                complete_inflight(self_p, inflight_p);
+                res = 0;
+            }
+            break;
+
+        default:
+            res = 0;
+            break;
+        }
+
+        if (res != 0) {
+            return (res);
+        }
+    }
+
+    return (0);
+}
+
 /**
  * Send the connect message to the server.
  */
@@ -238,11 +528,11 @@ static int handle_control_connect(struct mqtt_client_t *self_p)
         memset(options_p, 0, sizeof(*options_p));
     }
 
-    /*
-     * We currently do not support ressuming session, so force clean
-     * session.
-     */
-    flags = CLEAN_SESSION;
+    self_p->inflight.resume_session = options_p->resume_session;
+
+    if (options_p->resume_session == 0) {
+        flags = CLEAN_SESSION;
+    }
 
     /*
       * Be sure that 'will' topic and payload are both either set or
@@ -390,7 +680,7 @@ static int handle_response_connack(struct mqtt_client_t *self_p,
         return (-EIO);
     }
 
-    if (buf[0] != 0) {
+    if ((buf[0] & ~SESSION_PRESENT) != 0) {
         return (-1);
     }
 
@@ -400,7 +690,17 @@ static int handle_response_connack(struct mqtt_client_t *self_p,
 
     self_p->state = mqtt_client_state_connected_t;
 
-    return (0);
+#if CONFIG_MQTT_CLIENT_OFFLINE_QUEUE == 1
+    /* Publish the messages stored while disconnected before
+       accepting new control messages. */
+    if (self_p->offline.replay_pos < self_p->offline.size) {
+        self_p->message.type = CONTROL_REPLAY;
+    }
+#endif
+
+    return (retransmit_inflight(self_p,
+                                ((self_p->inflight.resume_session == 1)
+                                 && ((buf[0] & SESSION_PRESENT) != 0))));
 }
 
 /**
@@ -457,104 +757,462 @@ static int handle_response_ping(struct mqtt_client_t *self_p,
 }
 
 /**
- * Send the publish message to the server.
+ * Send given publish message to the server. QoS 1 and QoS 2 messages
+ * are added to the in-flight window, with a copy of the message if it
+ * fits in the window buffer.
  */
-static int handle_control_publish(struct mqtt_client_t *self_p)
+static int publish_message(struct mqtt_client_t *self_p,
+                           struct mqtt_application_message_t *message_p)
 {
-    int res = 0;
-    uint8_t buf[2];
+    int res;
+    int i;
+    struct mqtt_client_inflight_t *inflight_p;
+
+    if (message_p->qos == mqtt_qos_0_t) {
+        return (write_publish(self_p, message_p, 0, 0));
+    }
+
+    /* Only called if there is a free entry. */
+    for (i = 0; i < membersof(self_p->inflight.outgoing); i++) {
+        inflight_p = &self_p->inflight.outgoing[i];
+
+        if (inflight_p->state == INFLIGHT_FREE) {
+            break;
+        }
+    }
+
+    inflight_p->packet_id = alloc_packet_id(self_p);
+
+    if (message_p->qos == mqtt_qos_1_t) {
+        inflight_p->state = INFLIGHT_WAIT_PUBACK;
+    } else {
+        inflight_p->state = INFLIGHT_WAIT_PUBREC;
+    }
+
+    /* Keep a copy of the message for retransmission if it fits,
+       otherwise the application has to wait for the
+       acknowledgement. */
+    if ((message_p->topic.size + message_p->payload.size)
+        <= sizeof(inflight_p->buf)) {
+        memcpy(&inflight_p->buf[0],
+               message_p->topic.buf_p,
+               message_p->topic.size);
+
+        if (message_p->payload.size > 0) {
+            memcpy(&inflight_p->buf[message_p->topic.size],
+                   message_p->payload.buf_p,
+                   message_p->payload.size);
+        }
+
+        inflight_p->message.topic.buf_p = &inflight_p->buf[0];
+        inflight_p->message.topic.size = message_p->topic.size;
+        inflight_p->message.payload.buf_p =
+            &inflight_p->buf[message_p->topic.size];
+        inflight_p->message.payload.size = message_p->payload.size;
+        inflight_p->message.qos = message_p->qos;
+        inflight_p->blocking = 0;
+    } else {
+        inflight_p->message = *message_p;
+        inflight_p->blocking = 1;
+    }
+
+    self_p->inflight.length++;
+
+    res = write_publish(self_p,
+                        &inflight_p->message,
+                        inflight_p->packet_id,
+                        0);
+
+    if (res != 0) {
+        complete_inflight(self_p, inflight_p);
+    }
+
+    return (res);
+}
+
+/**
+ * Returns one(1) if a message owned by the application is in the
+ * in-flight window, otherwise zero(0).
+ */
+static int is_blocked(struct mqtt_client_t *self_p)
+{
+    int i;
+
+    for (i = 0; i < membersof(self_p->inflight.outgoing); i++) {
+        if ((self_p->inflight.outgoing[i].state != INFLIGHT_FREE)
+            && (self_p->inflight.outgoing[i].blocking == 1)) {
+            return (1);
+        }
+    }
+
+    return (0);
+}
+
+/**
+ * Send the remaining messages of the current publish request, as long
+ * as there is room in the in-flight window. The application is resumed
+ * once all messages are written, and any message not copied to the
+ * window has been acknowledged.
+ */
+static int publish_continue(struct mqtt_client_t *self_p)
+{
+    int res;
     struct mqtt_application_message_t *message_p;
+
+    res = 0;
+
+    while (self_p->publish.length > 0) {
+        message_p = self_p->publish.messages_p;
+
+        if (is_blocked(self_p) == 1) {
+            return (0);
+        }
+
+        if ((message_p->qos != mqtt_qos_0_t)
+            && (self_p->inflight.length == CONFIG_MQTT_CLIENT_INFLIGHT_MAX)) {
+            return (0);
+        }
+
+        res = publish_message(self_p, message_p);
+
+        if (res != 0) {
+            break;
+        }
+
+        self_p->publish.messages_p++;
+        self_p->publish.length--;
+    }
+
+    if ((res == 0) && (is_blocked(self_p) == 1)) {
+        return (0);
+    }
+
+    self_p->publish.length = 0;
+    self_p->message.type = CONTROL_NONE;
+    chan_write(&self_p->control.out, &res, sizeof(res));
+
+    return (res);
+}
+
+/**
+ * Start publishing the messages of a publish request from the
+ * application.
+ */
+static int handle_control_publish(struct mqtt_client_t *self_p)
+{
+    struct publish_args_t *args_p;
+
+    if (queue_read(&self_p->control.in,
+                   &args_p,
+                   sizeof(args_p)) != sizeof(args_p)) {
+        return (-1);
+    }
+
+    self_p->publish.messages_p = args_p->messages_p;
+    self_p->publish.length = args_p->length;
+    self_p->message.type = CONTROL_PUBLISH;
+
+    return (publish_continue(self_p));
+}
+
+#if CONFIG_MQTT_CLIENT_OFFLINE_QUEUE == 1
+
+/**
+ * Append given message to the offline queue file. A record is an
+ * eight bytes header, followed by the topic and the payload. The
+ * header contains the QoS, the topic size, the payload size and a
+ * CRC-32 of the header and the data.
+ */
+static int offline_append(struct mqtt_client_t *self_p,
+                          struct mqtt_application_message_t *message_p)
+{
+    uint8_t header[RECORD_HEADER_SIZE];
+    uint32_t crc;
     size_t size;
 
+    size = (message_p->topic.size + message_p->payload.size);
+
+    if ((size > CONFIG_MQTT_CLIENT_INFLIGHT_BUFFER_SIZE)
+        || (message_p->topic.size > 0xff)
+        || (self_p->offline.size + RECORD_HEADER_SIZE + size
+            > self_p->offline.size_max)) {
+        self_p->offline.counters.dropped += (RECORD_HEADER_SIZE + size);
+
+        return (-ENOSPC);
+    }
+
+    header[0] = message_p->qos;
+    header[1] = message_p->topic.size;
+    header[2] = MSB(message_p->payload.size);
+    header[3] = LSB(message_p->payload.size);
+    crc = crc_32(0, &header[0], 4);
+    crc = crc_32(crc, message_p->topic.buf_p, message_p->topic.size);
+
+    if (message_p->payload.size > 0) {
+        crc = crc_32(crc, message_p->payload.buf_p, message_p->payload.size);
+    }
+
+    header[4] = (crc >> 24);
+    header[5] = (crc >> 16);
+    header[6] = (crc >> 8);
+    header[7] = crc;
+
+    if (fs_seek(&self_p->offline.file,
+                self_p->offline.size,
+                FS_SEEK_SET) != 0) {
+        return (-EIO);
+    }
+
+    if (fs_write(&self_p->offline.file,
+                 &header[0],
+                 sizeof(header)) != sizeof(header)) {
+        return (-EIO);
+    }
+
+    if (fs_write(&self_p->offline.file,
+                 message_p->topic.buf_p,
+                 message_p->topic.size) != message_p->topic.size) {
+        return (-EIO);
+    }
+
+    if (message_p->payload.size > 0) {
+        if (fs_write(&self_p->offline.file,
+                     message_p->payload.buf_p,
+                     message_p->payload.size) != message_p->payload.size) {
+            return (-EIO);
+        }
+    }
+
+    self_p->offline.size += (RECORD_HEADER_SIZE + size);
+    self_p->offline.counters.queued += (RECORD_HEADER_SIZE + size);
+
+    return (0);
+}
+
+/**
+ * Store the messages of a publish request from the application in
+ * the offline queue.
+ */
+static int offline_handle_control_publish(struct mqtt_client_t *self_p)
+{
+    int res;
+    int result;
+    size_t i;
+    struct publish_args_t *args_p;
+
     if (queue_read(&self_p->control.in,
-                   &message_p,
-                   sizeof(message_p)) != sizeof(message_p)) {
+                   &args_p,
+                   sizeof(args_p)) != sizeof(args_p)) {
         return (-1);
     }
 
-    /* Write the fixed header. */
-    size = (message_p->topic.size + message_p->payload.size + 2);
+    result = 0;
 
-    if (message_p->qos > 0) {
-        size += 2;
+    for (i = 0; i < args_p->length; i++) {
+        res = offline_append(self_p, &args_p->messages_p[i]);
+
+        if (res != 0) {
+            result = res;
+        }
     }
 
-    res = write_fixed_header(self_p,
-                             MQTT_PUBLISH,
-                             (message_p->qos << 1),
-                             size);
+    chan_write(&self_p->control.out, &result, sizeof(result));
 
-    if (res != 0) {
-        return (res);
+    return (0);
+}
+
+/**
+ * Read the record at the replay position of the offline queue. Returns
+ * the record size, zero(0) if any data at the replay position is not
+ * a valid record, or negative error code.
+ */
+static ssize_t offline_read(struct mqtt_client_t *self_p,
+                            struct mqtt_application_message_t *message_p,
+                            uint8_t *buf_p)
+{
+    uint8_t header[RECORD_HEADER_SIZE];
+    uint32_t crc;
+    size_t size;
+
+    if (fs_seek(&self_p->offline.file,
+                self_p->offline.replay_pos,
+                FS_SEEK_SET) != 0) {
+        return (-EIO);
     }
 
-    /* Write the variable header. */
-    buf[0] = 0;
-    buf[1] = message_p->topic.size;
+    if (fs_read(&self_p->offline.file,
+                &header[0],
+                sizeof(header)) != sizeof(header)) {
+        return (0);
+    }
+
+    message_p->qos = header[0];
+    message_p->topic.size = header[1];
+    message_p->payload.size = (((size_t)header[2] << 8) | header[3]);
+    size = (message_p->topic.size + message_p->payload.size);
+
+    if ((message_p->qos > mqtt_qos_2_t)
+        || (size > CONFIG_MQTT_CLIENT_INFLIGHT_BUFFER_SIZE)) {
+        return (0);
+    }
+
+    if (fs_read(&self_p->offline.file, buf_p, size) != size) {
+        return (0);
+    }
+
+    crc = crc_32(0, &header[0], 4);
+    crc = crc_32(crc, buf_p, size);
+
+    if (crc != (((uint32_t)header[4] << 24)
+                | ((uint32_t)header[5] << 16)
+                | ((uint32_t)header[6] << 8)
+                | header[7])) {
+        return (0);
+    }
+
+    message_p->topic.buf_p = &buf_p[0];
+    message_p->payload.buf_p = &buf_p[message_p->topic.size];
+
+    return (RECORD_HEADER_SIZE + size);
+}
+
+/**
+ * Publish the messages in the offline queue, as long as there is room
+ * in the in-flight window. The file is truncated when all messages
+ * have been published.
+ */
+static int offline_replay(struct mqtt_client_t *self_p)
+{
+    int res;
+    ssize_t size;
+    struct mqtt_application_message_t message;
+    uint8_t buf[CONFIG_MQTT_CLIENT_INFLIGHT_BUFFER_SIZE];
+
+    while (self_p->offline.replay_pos < self_p->offline.size) {
+        if (self_p->inflight.length == CONFIG_MQTT_CLIENT_INFLIGHT_MAX) {
+            return (0);
+        }
+
+        size = offline_read(self_p, &message, &buf[0]);
+
+        if (size < 0) {
+            return (size);
+        }
+
+        /* Drop everything after a corrupt record, most likely an
+           interrupted append. */
+        if (size == 0) {
+            self_p->offline.counters.dropped +=
+                (self_p->offline.size - self_p->offline.replay_pos);
+            break;
+        }
+
+        res = publish_message(self_p, &message);
+
+        if (res != 0) {
+            return (res);
+        }
+
+        self_p->offline.replay_pos += size;
+        self_p->offline.counters.replayed += size;
+    }
+
+    self_p->message.type = CONTROL_NONE;
+    self_p->offline.size = 0;
+    self_p->offline.replay_pos = 0;
+    fs_close(&self_p->offline.file);
+
+    return (fs_open(&self_p->offline.file,
+                    self_p->offline.path_p,
+                    FS_CREAT | FS_TRUNC | FS_RDWR));
+}
+
+#endif
+
+/**
+ * Handle the puback message from the server.
+ */
+static int handle_response_puback(struct mqtt_client_t *self_p,
+                                  size_t size)
+{
+    int res;
+    uint16_t packet_id;
+    struct mqtt_client_inflight_t *inflight_p;
 
-    if (chan_write(self_p->transport.out_p, &buf[0], 2) != 2) {
-        return (-EIO);
-    }
+    res = read_packet_id(self_p, size, &packet_id);
 
-    if (chan_write(self_p->transport.out_p,
-                   message_p->topic.buf_p,
-                   message_p->topic.size) != message_p->topic.size) {
-        return (-EIO);
+    if (res != 0) {
+        return (res);
     }
 
-    if (message_p->qos > 0) {
-        buf[0] = 0;
-        buf[1] = 1;
-
-        if (chan_write(self_p->transport.out_p, &buf[0], 2) != 2) {
-            return (-EIO);
-        }
-    }
+    inflight_p = find_inflight(self_p, packet_id);
 
-    /* Write the payload. */
-    if (message_p->payload.size > 0) {
-        if (chan_write(self_p->transport.out_p,
-                       message_p->payload.buf_p,
-                       message_p->payload.size) != message_p->payload.size) {
-            return (-EIO);
-        }
+    /* Ignore acknowledgements of unknown messages, most likely
+       duplicates after a reconnect. */
+    if ((inflight_p == NULL)
+        || (inflight_p->state != INFLIGHT_WAIT_PUBACK)) {
+        return (0);
     }
 
-    self_p->message.type = CONTROL_PUBLISH;
+    complete_inflight(self_p, inflight_p);
 
     return (0);
 }
 
 /**
- * Handle the puback message from the server.
+ * Handle the pubrec message from the server by releasing the
+ * message.
  */
-static int handle_response_puback(struct mqtt_client_t *self_p,
+static int handle_response_pubrec(struct mqtt_client_t *self_p,
                                   size_t size)
 {
-    uint8_t buf[2];
+    int res;
+    uint16_t packet_id;
+    struct mqtt_client_inflight_t *inflight_p;
 
-    if (self_p->message.type != CONTROL_PUBLISH) {
-        return (-1);
+    res = read_packet_id(self_p, size, &packet_id);
+
+    if (res != 0) {
+        return (res);
     }
 
-    self_p->message.type = CONTROL_NONE;
+    inflight_p = find_inflight(self_p, packet_id);
 
-    if (size != 2) {
-        return (-EMSGSIZE);
+    if ((inflight_p == NULL)
+        || (inflight_p->state == INFLIGHT_WAIT_PUBACK)) {
+        return (0);
     }
 
-    if (chan_read(self_p->transport.in_p, &buf[0], size) != size) {
-        return (-EIO);
-    }
+    inflight_p->state = INFLIGHT_WAIT_PUBCOMP;
 
-    if (buf[0] != 0) {
-        return (-1);
+    return (write_ack(self_p, MQTT_PUBREL, packet_id));
+}
+
+/**
+ * Handle the pubcomp message from the server.
+ */
+static int handle_response_pubcomp(struct mqtt_client_t *self_p,
+                                   size_t size)
+{
+    int res;
+    uint16_t packet_id;
+    struct mqtt_client_inflight_t *inflight_p;
+
+    res = read_packet_id(self_p, size, &packet_id);
+
+    if (res != 0) {
+        return (res);
     }
 
-    if (buf[1] != 1) {
-        return (-1);
+    inflight_p = find_inflight(self_p, packet_id);
+
+    if ((inflight_p == NULL)
+        || (inflight_p->state != INFLIGHT_WAIT_PUBCOMP)) {
+        return (0);
     }
 
+    complete_inflight(self_p, inflight_p);
+
     return (0);
 }
 
@@ -584,11 +1242,11 @@ static int handle_control_subscribe(struct mqtt_client_t *self_p)
     }
 
     /* Write the packet identifier. */
-    buf[0] = 0;
-    buf[1] = 1;
+    self_p->message.packet_id = alloc_packet_id(self_p);
+    res = write_packet_id(self_p, self_p->message.packet_id);
 
-    if (chan_write(self_p->transport.out_p, &buf[0], 2) != 2) {
-        return (-EIO);
+    if (res != 0) {
+        return (res);
     }
 
     /* Write the topic filter length. */
@@ -640,11 +1298,11 @@ static int handle_response_suback(struct mqtt_client_t *self_p,
         return (-EIO);
     }
 
-    if (buf[0] != 0) {
+    if (buf[0] != MSB(self_p->message.packet_id)) {
         return (-1);
     }
 
-    if (buf[1] != 1) {
+    if (buf[1] != LSB(self_p->message.packet_id)) {
         return (-1);
     }
 
@@ -681,11 +1339,11 @@ static int handle_control_unsubscribe(struct mqtt_client_t *self_p)
     }
 
     /* Write the packet identifier. */
-    buf[0] = 0;
-    buf[1] = 2;
+    self_p->message.packet_id = alloc_packet_id(self_p);
+    res = write_packet_id(self_p, self_p->message.packet_id);
 
-    if (chan_write(self_p->transport.out_p, &buf[0], 2) != 2) {
-        return (-EIO);
+    if (res != 0) {
+        return (res);
     }
 
     /* Write the topic filter length. */
@@ -730,17 +1388,95 @@ static int handle_response_unsuback(struct mqtt_client_t *self_p,
         return (-EIO);
     }
 
-    if (buf[0] != 0) {
+    if (buf[0] != MSB(self_p->message.packet_id)) {
         return (-1);
     }
 
-    if (buf[1] != 2) {
+    if (buf[1] != LSB(self_p->message.packet_id)) {
         return (-1);
     }
 
     return (0);
 }
 
+/**
+ * Remember given incoming QoS 2 packet identifier until the server
+ * releases it. Returns one(1) if the packet identifier already is
+ * known, that is, if the message is a duplicate.
+ */
+static int add_incoming(struct mqtt_client_t *self_p,
+                        uint16_t packet_id)
+{
+    int i;
+    uint16_t *free_p;
+
+    free_p = NULL;
+
+    for (i = 0; i < membersof(self_p->inflight.incoming); i++) {
+        if (self_p->inflight.incoming[i] == packet_id) {
+            return (1);
+        }
+
+        if (self_p->inflight.incoming[i] == 0) {
+            free_p = &self_p->inflight.incoming[i];
+        }
+    }
+
+    /* Duplicates are not detected if the list is full. */
+    if (free_p != NULL) {
+        *free_p = packet_id;
+    }
+
+    return (0);
+}
+
+/**
+ * Handle the pubrel message from the server.
+ */
+static int handle_pubrel(struct mqtt_client_t *self_p,
+                         size_t size)
+{
+    int res;
+    int i;
+    uint16_t packet_id;
+
+    res = read_packet_id(self_p, size, &packet_id);
+
+    if (res != 0) {
+        return (res);
+    }
+
+    for (i = 0; i < membersof(self_p->inflight.incoming); i++) {
+        if (self_p->inflight.incoming[i] == packet_id) {
+            self_p->inflight.incoming[i] = 0;
+        }
+    }
+
+    return (write_ack(self_p, MQTT_PUBCOMP, packet_id));
+}
+
+/**
+ * Read and discard given number of bytes from the server.
+ */
+static int discard(struct mqtt_client_t *self_p,
+                   size_t size)
+{
+    uint8_t buf[16];
+    size_t n;
+
+    while (size > 0) {
+        n = MIN(size, sizeof(buf));
+
+        if (chan_read(self_p->transport.in_p, &buf[0], n) != n) {
+            return (-EIO);
+        }
+
+        size -= n;
+    }
+
+    return (0);
+}
+
 /**
  * Handle the publish message from the server.
  */
@@ -753,6 +1489,8 @@ static int handle_publish(struct mqtt_client_t *self_p,
     size_t payload_size;
     uint8_t buf[2];
     uint8_t qos;
+    uint16_t packet_id;
+    int duplicate;
     char topic[128];
 
     /* Read the variable header. */
@@ -776,24 +1514,29 @@ static int handle_publish(struct mqtt_client_t *self_p,
     topic[topic_size] = '\0';
     qos = ((flags >> 1) & 0x3);
 
-    log_object_print(self_p->log_object_p,
+    LOG_OBJECT_PRINT(self_p->log_object_p,
                      LOG_DEBUG,
                      OSTR("QoS: %d, Flags: 0x%02x.\r\n"),
                      qos,
                      flags);
 
+    duplicate = 0;
+
     if (qos == 0) {
         payload_size = (size - topic_size - 2);
     } else {
         /* Read the packet identifier. */
-        if (chan_read(self_p->transport.in_p, buf, 2) != 2) {
-            return (-EIO);
+        res = read_packet_id(self_p, 2, &packet_id);
+
+        if (res != 0) {
+            return (res);
         }
 
         if (qos == 1) {
-            res = write_fixed_header(self_p, MQTT_PUBACK, 0, 2);
+            res = write_ack(self_p, MQTT_PUBACK, packet_id);
         } else if (qos == 2) {
-            res = write_fixed_header(self_p, MQTT_PUBREC, 0, 2);
+            duplicate = add_incoming(self_p, packet_id);
+            res = write_ack(self_p, MQTT_PUBREC, packet_id);
         } else {
             res = (-EPROTO);
         }
@@ -802,14 +1545,14 @@ static int handle_publish(struct mqtt_client_t *self_p,
             return (res);
         }
 
-        /* Write the variable header. */
-        if (chan_write(self_p->transport.out_p, &buf[0], 2) != 2) {
-            return (-EIO);
-        }
-
         payload_size = (size - topic_size - 4);
     }
 
+    /* A QoS 2 message is delivered to the application only once. */
+    if (duplicate == 1) {
+        return (discard(self_p, payload_size));
+    }
+
     if (self_p->on_publish(self_p,
                            topic,
                            self_p->transport.in_p,
@@ -827,6 +1570,7 @@ static int read_control_message(struct mqtt_client_t *self_p)
 {
     int res = -1;
     char type;
+    void *arg_p;
 
     if (queue_read(&self_p->control.in,
                    &type,
@@ -834,51 +1578,57 @@ static int read_control_message(struct mqtt_client_t *self_p)
         return (-1);
     }
 
-    switch (self_p->state) {
+    /* A connect is also accepted when connected, to reconnect over a
+       new transport. */
+    if (type == CONTROL_CONNECT) {
+        res = handle_control_connect(self_p);
 
-    case mqtt_client_state_disconnected_t:
-        {
-            switch (type) {
+        if (res != 0) {
+            chan_write(&self_p->control.out, &res, sizeof(res));
+        }
 
-            case CONTROL_CONNECT:
-                res = handle_control_connect(self_p);
-                break;
+        return (res);
+    }
 
-            default:
-                break;
-            }
+    if (self_p->state != mqtt_client_state_connected_t) {
+#if CONFIG_MQTT_CLIENT_OFFLINE_QUEUE == 1
+        if ((type == CONTROL_PUBLISH) && (self_p->offline.path_p != NULL)) {
+            return (offline_handle_control_publish(self_p));
         }
-        break;
+#endif
 
-    case mqtt_client_state_connected_t:
-        {
-            switch (type) {
+        /* Discard the argument, if any, and fail the operation. */
+        if ((type != CONTROL_DISCONNECT) && (type != CONTROL_PING)) {
+            queue_read(&self_p->control.in, &arg_p, sizeof(arg_p));
+        }
 
-            case CONTROL_DISCONNECT:
-                res = handle_control_disconnect(self_p);
-                chan_write(&self_p->control.out, &res, sizeof(res));
-                break;
+        res = -ENOTCONN;
+        chan_write(&self_p->control.out, &res, sizeof(res));
 
-            case CONTROL_PING:
-                res = handle_control_ping(self_p);
-                break;
+        return (0);
+    }
 
-            case CONTROL_PUBLISH:
-                res = handle_control_publish(self_p);
-                break;
+    switch (type) {
 
-            case CONTROL_SUBSCRIBE:
-                res = handle_control_subscribe(self_p);
-                break;
+    case CONTROL_DISCONNECT:
+        res = handle_control_disconnect(self_p);
+        chan_write(&self_p->control.out, &res, sizeof(res));
+        break;
 
-            case CONTROL_UNSUBSCRIBE:
-                res = handle_control_unsubscribe(self_p);
-                break;
+    case CONTROL_PING:
+        res = handle_control_ping(self_p);
+        break;
 
-            default:
-                break;
-            }
-        }
+    case CONTROL_PUBLISH:
+        res = handle_control_publish(self_p);
+        break;
+
+    case CONTROL_SUBSCRIBE:
+        res = handle_control_subscribe(self_p);
+        break;
+
+    case CONTROL_UNSUBSCRIBE:
+        res = handle_control_unsubscribe(self_p);
         break;
 
     default:
@@ -888,6 +1638,46 @@ static int read_control_message(struct mqtt_client_t *self_p)
     return (0);
 }
 
+/**
+ * Fail the operation the application is waiting for, if any, as the
+ * connection to the server is broken. The in-flight messages are kept
+ * for retransmission, except a message owned by the application.
+ */
+static void abort_pending(struct mqtt_client_t *self_p)
+{
+    int i;
+    int res;
+    struct mqtt_client_inflight_t *inflight_p;
+
+    self_p->state = mqtt_client_state_disconnected_t;
+
+    if (self_p->message.type == CONTROL_NONE) {
+        return;
+    }
+
+    /* The replay continues on the next connect. */
+    if (self_p->message.type == CONTROL_REPLAY) {
+        self_p->message.type = CONTROL_NONE;
+
+        return;
+    }
+
+    for (i = 0; i < membersof(self_p->inflight.outgoing); i++) {
+        inflight_p = &self_p->inflight.outgoing[i];
+
+        if ((inflight_p->state != INFLIGHT_FREE)
+            && (inflight_p->blocking == 1)) {
+            inflight_p->state = INFLIGHT_FREE;
+            self_p->inflight.length--;
+        }
+    }
+
+    self_p->publish.length = 0;
+    self_p->message.type = CONTROL_NONE;
+    res = -EIO;
+    chan_write(&self_p->control.out, &res, sizeof(res));
+}
+
 /**
  * Read a MQTT message from the server.
  */
@@ -903,10 +1693,12 @@ static int read_server_message(struct mqtt_client_t *self_p)
     size = 0;
 
     if (read_fixed_header(self_p, &type, &flags, &size) != 0) {
+        abort_pending(self_p);
+
         return (-EIO);
     }
 
-    log_object_print(self_p->log_object_p,
+    LOG_OBJECT_PRINT(self_p->log_object_p,
                      LOG_DEBUG,
                      OSTR("Read MQTT message '%s' from the server.\r\n"),
                      message_fmt[type]);
@@ -920,12 +1712,18 @@ static int read_server_message(struct mqtt_client_t *self_p)
 
     case MQTT_PUBACK:
         res = handle_response_puback(self_p, size);
-        chan_write(&self_p->control.out, &res, sizeof(res));
         break;
 
     case MQTT_PUBREC:
+        res = handle_response_pubrec(self_p, size);
+        break;
+
     case MQTT_PUBREL:
+        res = handle_pubrel(self_p, size);
+        break;
+
     case MQTT_PUBCOMP:
+        res = handle_response_pubcomp(self_p, size);
         break;
 
     case MQTT_SUBACK:
@@ -984,6 +1782,12 @@ int mqtt_client_init(struct mqtt_client_t *self_p,
     self_p->log_object_p = log_object_p;
     self_p->state = mqtt_client_state_disconnected_t;
     self_p->message.type = CONTROL_NONE;
+    self_p->publish.length = 0;
+    memset(&self_p->inflight, 0, sizeof(self_p->inflight));
+#if CONFIG_MQTT_CLIENT_OFFLINE_QUEUE == 1
+    memset(&self_p->offline, 0, sizeof(self_p->offline));
+#endif
+    self_p->inflight.next_packet_id = 1;
     self_p->transport.out_p = transport_out_p;
     self_p->transport.in_p = transport_in_p;
     queue_init(&self_p->control.out, NULL, 0);
@@ -1043,10 +1847,27 @@ int mqtt_client_publish(struct mqtt_client_t *self_p,
     ASSERTN(self_p != NULL, EINVAL)
     ASSERTN(message_p != NULL, EINVAL)
 
+    return (mqtt_client_publish_many(self_p, message_p, 1));
+}
+
+int mqtt_client_publish_many(struct mqtt_client_t *self_p,
+                             struct mqtt_application_message_t *messages_p,
+                             size_t length)
+{
+    ASSERTN(self_p != NULL, EINVAL)
+    ASSERTN(messages_p != NULL, EINVAL)
+
+    struct publish_args_t args;
+    struct publish_args_t *args_p;
+
+    args.messages_p = messages_p;
+    args.length = length;
+    args_p = &args;
+
     return (control_routine(self_p,
                             CONTROL_PUBLISH,
-                            &message_p,
-                            sizeof(message_p)));
+                            &args_p,
+                            sizeof(args_p)));
 }
 
 int mqtt_client_subscribe(struct mqtt_client_t *self_p,
@@ -1073,33 +1894,187 @@ int mqtt_client_unsubscribe(struct mqtt_client_t *self_p,
                             sizeof(message_p)));
 }
 
+#if CONFIG_MQTT_CLIENT_OFFLINE_QUEUE == 1
+
+int mqtt_client_offline_queue_init(struct mqtt_client_t *self_p,
+                                   const char *path_p,
+                                   size_t size_max)
+{
+    ASSERTN(self_p != NULL, EINVAL)
+    ASSERTN(path_p != NULL, EINVAL)
+
+    ssize_t size;
+
+    if (fs_open(&self_p->offline.file,
+                path_p,
+                FS_CREAT | FS_RDWR) != 0) {
+        return (-EIO);
+    }
+
+    /* Messages stored before a restart are published on the first
+       connect. */
+    if (fs_seek(&self_p->offline.file, 0, FS_SEEK_END) != 0) {
+        fs_close(&self_p->offline.file);
+
+        return (-EIO);
+    }
+
+    size = fs_tell(&self_p->offline.file);
+
+    if (size < 0) {
+        fs_close(&self_p->offline.file);
+
+        return (-EIO);
+    }
+
+    self_p->offline.path_p = path_p;
+    self_p->offline.size = size;
+    self_p->offline.size_max = size_max;
+    self_p->offline.replay_pos = 0;
+
+    return (0);
+}
+
+#endif
+
+/**
+ * Only accept a new control message when the previous one is
+ * completed and there is room for another message in the in-flight
+ * window.
+ */
+static int is_control_accepted(struct mqtt_client_t *self_p)
+{
+    return ((self_p->message.type == CONTROL_NONE)
+            && (self_p->inflight.length < CONFIG_MQTT_CLIENT_INFLIGHT_MAX));
+}
+
+/**
+ * Handle data on given channel, either the control channel or the
+ * transport input channel.
+ */
+static void handle_chan(struct mqtt_client_t *self_p, void *chan_p)
+{
+    int res;
+
+    if (chan_p == &self_p->control.in) {
+        res = read_control_message(self_p);
+    } else if (chan_p == self_p->transport.in_p) {
+        res = read_server_message(self_p);
+
+        /* An acknowledgement may have made room for more messages in
+           the in-flight window. */
+        if (res == 0) {
+            if (self_p->message.type == CONTROL_PUBLISH) {
+                res = publish_continue(self_p);
+            }
+
+#if CONFIG_MQTT_CLIENT_OFFLINE_QUEUE == 1
+            if (self_p->message.type == CONTROL_REPLAY) {
+                res = offline_replay(self_p);
+            }
+#endif
+        }
+    } else {
+        res = -1;
+    }
+
+    if (res != 0) {
+        self_p->on_error(self_p, res);
+    }
+}
+
 void *mqtt_client_main(void *arg_p)
 {
     struct mqtt_client_t *self_p = arg_p;
     struct chan_list_t list;
     struct chan_list_elem_t elements[2];
-    void *chan_p;
-    int res;
 
     thrd_set_name(self_p->name_p);
 
-    chan_list_init(&list, &elements[0], membersof(elements));
-    chan_list_add(&list, &self_p->control.in);
-    chan_list_add(&list, self_p->transport.in_p);
-
     while (1) {
-        chan_p = chan_list_poll(&list, NULL);
+        chan_list_init(&list, &elements[0], membersof(elements));
 
-        if (chan_p == &self_p->control.in) {
-            res = read_control_message(self_p);
-        } else if (chan_p == self_p->transport.in_p) {
-            res = read_server_message(self_p);
-        } else {
-            res = -1;
+        if (is_control_accepted(self_p)) {
+            chan_list_add(&list, &self_p->control.in);
         }
 
-        if (res != 0) {
-            self_p->on_error(self_p, res);
-        }
+        chan_list_add(&list, self_p->transport.in_p);
+        handle_chan(self_p, chan_list_poll(&list, NULL));
+    }
+}
+
+#if CONFIG_CHAN_POLLSET == 1
+
+/**
+ * Add the control channel to the reactor when a new control message
+ * is accepted, and remove it otherwise.
+ */
+static void reactor_update_control(struct mqtt_client_t *self_p)
+{
+    int accepted;
+
+    accepted = is_control_accepted(self_p);
+
+    if (accepted == self_p->reactor.control_added) {
+        return;
+    }
+
+    if (accepted) {
+        reactor_chan_add(self_p->reactor.reactor_p, &self_p->reactor.control);
+    } else {
+        reactor_chan_remove(self_p->reactor.reactor_p,
+                            &self_p->reactor.control);
+    }
+
+    self_p->reactor.control_added = accepted;
+}
+
+static void on_reactor_control(void *arg_p)
+{
+    struct mqtt_client_t *self_p;
+
+    self_p = arg_p;
+    handle_chan(self_p, &self_p->control.in);
+    reactor_update_control(self_p);
+}
+
+static void on_reactor_transport(void *arg_p)
+{
+    struct mqtt_client_t *self_p;
+
+    self_p = arg_p;
+    handle_chan(self_p, self_p->transport.in_p);
+    reactor_update_control(self_p);
+}
+
+int mqtt_client_reactor_add(struct mqtt_client_t *self_p,
+                            struct reactor_t *reactor_p)
+{
+    ASSERTN(self_p != NULL, EINVAL);
+    ASSERTN(reactor_p != NULL, EINVAL);
+
+    int res;
+
+    self_p->reactor.reactor_p = reactor_p;
+    self_p->reactor.control_added = 0;
+    reactor_chan_init(&self_p->reactor.control,
+                      &self_p->control.in,
+                      on_reactor_control,
+                      self_p);
+    reactor_chan_init(&self_p->reactor.transport,
+                      self_p->transport.in_p,
+                      on_reactor_transport,
+                      self_p);
+
+    res = reactor_chan_add(reactor_p, &self_p->reactor.transport);
+
+    if (res != 0) {
+        return (res);
     }
+
+    reactor_update_control(self_p);
+
+    return (0);
 }
+
+#endif
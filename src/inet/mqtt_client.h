@@ -84,6 +84,27 @@ struct mqtt_string_t {
     size_t size;
 };
 
+/**
+ * MQTT application message.
+ */
+struct mqtt_application_message_t {
+    struct mqtt_string_t topic;
+    struct mqtt_string_t payload;
+    enum mqtt_qos_t qos;
+};
+
+/**
+ * A published QoS 1 or QoS 2 message waiting for its acknowledgement
+ * from the server.
+ */
+struct mqtt_client_inflight_t {
+    int state;
+    uint16_t packet_id;
+    int blocking;
+    struct mqtt_application_message_t message;
+    uint8_t buf[CONFIG_MQTT_CLIENT_INFLIGHT_BUFFER_SIZE];
+};
+
 /**
  * MQTT client.
  */
@@ -93,8 +114,34 @@ struct mqtt_client_t {
     int state;
     struct {
         int type;
+        uint16_t packet_id;
         void *data_p;
     } message;
+    struct {
+        uint16_t next_packet_id;
+        int length;
+        int resume_session;
+        struct mqtt_client_inflight_t outgoing[CONFIG_MQTT_CLIENT_INFLIGHT_MAX];
+        uint16_t incoming[CONFIG_MQTT_CLIENT_INFLIGHT_MAX];
+    } inflight;
+    struct {
+        struct mqtt_application_message_t *messages_p;
+        size_t length;
+    } publish;
+#if CONFIG_MQTT_CLIENT_OFFLINE_QUEUE == 1
+    struct {
+        const char *path_p;
+        struct fs_file_t file;
+        size_t size;
+        size_t size_max;
+        size_t replay_pos;
+        struct {
+            uint32_t queued;
+            uint32_t dropped;
+            uint32_t replayed;
+        } counters;
+    } offline;
+#endif
     struct {
         void *out_p;
         void *in_p;
@@ -105,15 +152,14 @@ struct mqtt_client_t {
     } control;
     mqtt_on_publish_t on_publish;
     mqtt_on_error_t on_error;
-};
-
-/**
- * MQTT application message.
- */
-struct mqtt_application_message_t {
-    struct mqtt_string_t topic;
-    struct mqtt_string_t payload;
-    enum mqtt_qos_t qos;
+#if CONFIG_CHAN_POLLSET == 1
+    struct {
+        struct reactor_chan_t control;
+        struct reactor_chan_t transport;
+        struct reactor_t *reactor_p;
+        int control_added;
+    } reactor;
+#endif
 };
 
 /**
@@ -131,6 +177,13 @@ struct mqtt_conn_options_t {
 
     /*! Keep alive interval in seconds. */
     int keep_alive_s;
+
+    /**
+     * Resume the previous session instead of starting a clean
+     * one. In-flight messages are then retransmitted with the DUP
+     * flag set once connected.
+     */
+    int resume_session;
 };
 
 /**
@@ -156,6 +209,38 @@ int mqtt_client_init(struct mqtt_client_t *self_p,
                      mqtt_on_publish_t on_publish,
                      mqtt_on_error_t on_error);
 
+/**
+ * Store messages published while disconnected from the server in
+ * given file, instead of failing the publish. The stored messages
+ * are published, using the in-flight window, as soon as the client
+ * is connected again. They are published before any message
+ * published after the connect, to keep the order. Messages already in
+ * the file are published on the first connect, so no messages are
+ * lost over a restart.
+ *
+ * The file is append-only while disconnected, and every message is
+ * protected by a CRC-32 checksum. A message that does not fit in the
+ * file, or is larger than ``CONFIG_MQTT_CLIENT_INFLIGHT_BUFFER_SIZE``,
+ * is dropped. The file is truncated once all messages have been
+ * published.
+ *
+ * The number of queued, dropped and replayed bytes are counted in
+ * ``self_p->offline.counters``.
+ *
+ * This function must be called before the client thread is started.
+ * Only available if ``CONFIG_MQTT_CLIENT_OFFLINE_QUEUE`` is 1.
+ *
+ * @param[in] self_p MQTT client.
+ * @param[in] path_p Path of the file to store the messages in. Must
+ *                   be valid as long as the client is used.
+ * @param[in] size_max Maximum size of the file in bytes.
+ *
+ * @return zero(0) or negative error code.
+ */
+int mqtt_client_offline_queue_init(struct mqtt_client_t *self_p,
+                                   const char *path_p,
+                                   size_t size_max);
+
 /**
  * MQTT client thread.
  *
@@ -165,6 +250,24 @@ int mqtt_client_init(struct mqtt_client_t *self_p,
  */
 void *mqtt_client_main(void *arg_p);
 
+/**
+ * Serve given MQTT client from given reactor instead of a client
+ * thread, so many clients share one thread and stack. The callbacks
+ * are called from the reactor thread, while all other functions in
+ * this module must still be called from other threads, as they wait
+ * for the reactor to complete the request.
+ *
+ * Must be called before the reactor loop is started, or from the
+ * reactor loop. Only available if ``CONFIG_CHAN_POLLSET`` is 1.
+ *
+ * @param[in] self_p MQTT client.
+ * @param[in] reactor_p Reactor to serve the client from.
+ *
+ * @return zero(0) or negative error code.
+ */
+int mqtt_client_reactor_add(struct mqtt_client_t *self_p,
+                            struct reactor_t *reactor_p);
+
 /**
  * Establish a connection to the server.
  *
@@ -203,18 +306,43 @@ int mqtt_client_disconnect(struct mqtt_client_t *self_p);
 int mqtt_client_ping(struct mqtt_client_t *self_p);
 
 /**
- * Publish given topic.
+ * Publish given message. A QoS 1 or QoS 2 message is copied to the
+ * in-flight window and this function returns as soon as it has been
+ * written to the server, without waiting for its acknowledgement. It
+ * only blocks when the window is full, or when the message is too big
+ * for the window, see ``CONFIG_MQTT_CLIENT_INFLIGHT_MAX`` and
+ * ``CONFIG_MQTT_CLIENT_INFLIGHT_BUFFER_SIZE``.
+ *
+ * Messages still in flight are retransmitted by the next call to
+ * `mqtt_client_connect()`.
  *
  * @param[in] self_p MQTT client.
- * @param[in] topic_p Topic.
- * @param[in] payload_p Payload to publish. May be NULL.
- * @param[in] payload_size Number of bytes in the payload.
+ * @param[in] message_p The message to publish.
  *
  * @return zero(0) or negative error code.
  */
 int mqtt_client_publish(struct mqtt_client_t *self_p,
                         struct mqtt_application_message_t *message_p);
 
+/**
+ * Publish given array of messages in a single request to the client
+ * thread, which is cheaper than calling `mqtt_client_publish()` once
+ * per message. The messages are written to the server in order,
+ * waiting for room in the in-flight window as needed. Each message is
+ * written in a single gathered write if the transport is a socket,
+ * without copying the topic and payload of QoS 0 messages.
+ *
+ * @param[in] self_p MQTT client.
+ * @param[in] messages_p Array of messages to publish.
+ * @param[in] length Number of messages in the array.
+ *
+ * @return zero(0) or negative error code. Messages before the failing
+ *         one have been published.
+ */
+int mqtt_client_publish_many(struct mqtt_client_t *self_p,
+                             struct mqtt_application_message_t *messages_p,
+                             size_t length);
+
 /**
  * Subscribe to given message.
  *
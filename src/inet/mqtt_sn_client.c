@@ -0,0 +1,752 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2014-2018, Erik Moqvist
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use, copy,
+ * modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ * This file is part of the Simba project.
+ */
+
+#include "simba.h"
+
+/* Message types. */
+#define TYPE_CONNECT                                        0x04
+#define TYPE_CONNACK                                        0x05
+#define TYPE_REGISTER                                       0x0a
+#define TYPE_REGACK                                         0x0b
+#define TYPE_PUBLISH                                        0x0c
+#define TYPE_PUBACK                                         0x0d
+#define TYPE_SUBSCRIBE                                      0x12
+#define TYPE_SUBACK                                         0x13
+#define TYPE_PINGREQ                                        0x16
+#define TYPE_PINGRESP                                       0x17
+#define TYPE_DISCONNECT                                     0x18
+
+/* Flags. */
+#define FLAGS_DUP                                           0x80
+#define FLAGS_QOS(qos)                               (((qos) & 0x3) << 5)
+#define FLAGS_QOS_GET(flags)                           (((flags) >> 5) & 0x3)
+#define FLAGS_CLEAN_SESSION                                 0x04
+#define FLAGS_TOPIC_ID_TYPE_NORMAL                          0x00
+#define FLAGS_TOPIC_ID_TYPE_PREDEFINED                      0x01
+
+#define PROTOCOL_ID                                         0x01
+
+#define RETURN_CODE_ACCEPTED                                0x00
+
+/* The message type follows a length field of one or three bytes. */
+#define TYPE_OFFSET                                            3
+
+/* No message id to match in the response. */
+#define NO_MSG_ID                                             -1
+
+static void pack_u16(uint8_t *buf_p, uint16_t value)
+{
+    buf_p[0] = (value >> 8);
+    buf_p[1] = value;
+}
+
+static uint16_t unpack_u16(const uint8_t *buf_p)
+{
+    return ((buf_p[0] << 8) | buf_p[1]);
+}
+
+/**
+ * Start a message of given type in the output buffer.
+ *
+ * @return Pointer to the variable part of the message.
+ */
+static uint8_t *output_begin(struct mqtt_sn_client_t *self_p, int type)
+{
+    self_p->output.buf[TYPE_OFFSET] = type;
+
+    return (&self_p->output.buf[TYPE_OFFSET + 1]);
+}
+
+/**
+ * Put given string last in the message in the output buffer.
+ *
+ * @return Pointer after the string, or NULL if it does not fit.
+ */
+static uint8_t *output_string(struct mqtt_sn_client_t *self_p,
+                              uint8_t *buf_p,
+                              const char *string_p)
+{
+    size_t size;
+
+    size = strlen(string_p);
+
+    if (size > (size_t)(&self_p->output.buf[sizeof(self_p->output.buf)]
+                        - buf_p)) {
+        return (NULL);
+    }
+
+    memcpy(buf_p, string_p, size);
+
+    return (buf_p + size);
+}
+
+/**
+ * Prepend the length field to the message ending at given pointer. A
+ * short message has a one byte length field, and a long message a
+ * three bytes length field.
+ */
+static int output_end(struct mqtt_sn_client_t *self_p, uint8_t *end_p)
+{
+    size_t size;
+
+    if (end_p == NULL) {
+        return (-EMSGSIZE);
+    }
+
+    size = (end_p - &self_p->output.buf[TYPE_OFFSET]);
+
+    if (size + 1 < 256) {
+        self_p->output.pos = (TYPE_OFFSET - 1);
+        self_p->output.buf[TYPE_OFFSET - 1] = (size + 1);
+        size += 1;
+    } else {
+        self_p->output.pos = 0;
+        size += 3;
+        self_p->output.buf[0] = 0x01;
+        pack_u16(&self_p->output.buf[1], size);
+    }
+
+    self_p->output.size = size;
+
+    return (0);
+}
+
+static ssize_t send_output(struct mqtt_sn_client_t *self_p)
+{
+    return (socket_sendto(&self_p->socket,
+                          &self_p->output.buf[self_p->output.pos],
+                          self_p->output.size,
+                          0,
+                          &self_p->gateway_addr));
+}
+
+/**
+ * Send a short message from given buffer, without touching the
+ * output buffer, which may hold a request waiting for its response.
+ */
+static void send_ack(struct mqtt_sn_client_t *self_p,
+                     int type,
+                     uint16_t topic_id,
+                     uint16_t msg_id)
+{
+    uint8_t buf[7];
+
+    buf[0] = sizeof(buf);
+    buf[1] = type;
+    pack_u16(&buf[2], topic_id);
+    pack_u16(&buf[4], msg_id);
+    buf[6] = RETURN_CODE_ACCEPTED;
+
+    (void)socket_sendto(&self_p->socket,
+                        &buf[0],
+                        sizeof(buf),
+                        0,
+                        &self_p->gateway_addr);
+}
+
+/**
+ * Find the type and variable part of given received message.
+ *
+ * @return zero(0) or negative error code.
+ */
+static int decode(const uint8_t *buf_p,
+                  size_t size,
+                  int *type_p,
+                  const uint8_t **body_pp,
+                  size_t *body_size_p)
+{
+    size_t length;
+    size_t header_size;
+
+    if (size < 2) {
+        return (-EBADMSG);
+    }
+
+    if (buf_p[0] == 0x01) {
+        if (size < 4) {
+            return (-EBADMSG);
+        }
+
+        length = unpack_u16(&buf_p[1]);
+        header_size = 4;
+    } else {
+        length = buf_p[0];
+        header_size = 2;
+    }
+
+    if ((length != size) || (length < header_size)) {
+        return (-EBADMSG);
+    }
+
+    *type_p = buf_p[header_size - 1];
+    *body_pp = &buf_p[header_size];
+    *body_size_p = (length - header_size);
+
+    return (0);
+}
+
+/**
+ * Handle a message sent by the gateway on its own initiative.
+ */
+static void handle_gateway_message(struct mqtt_sn_client_t *self_p,
+                                   int type,
+                                   const uint8_t *body_p,
+                                   size_t size)
+{
+    uint8_t buf[2];
+    uint16_t topic_id;
+    uint16_t msg_id;
+
+    switch (type) {
+
+    case TYPE_PUBLISH:
+        if (size < 5) {
+            return;
+        }
+
+        topic_id = unpack_u16(&body_p[1]);
+        msg_id = unpack_u16(&body_p[3]);
+
+        if (FLAGS_QOS_GET(body_p[0]) == 1) {
+            send_ack(self_p, TYPE_PUBACK, topic_id, msg_id);
+        }
+
+        if (self_p->on_publish != NULL) {
+            self_p->on_publish(self_p, topic_id, &body_p[5], size - 5);
+        }
+
+        break;
+
+    case TYPE_REGISTER:
+        /* A topic name matching a subscription with wildcards. */
+        if (size < 4) {
+            return;
+        }
+
+        send_ack(self_p,
+                 TYPE_REGACK,
+                 unpack_u16(&body_p[0]),
+                 unpack_u16(&body_p[2]));
+        break;
+
+    case TYPE_PINGREQ:
+        buf[0] = sizeof(buf);
+        buf[1] = TYPE_PINGRESP;
+        (void)socket_sendto(&self_p->socket,
+                            &buf[0],
+                            sizeof(buf),
+                            0,
+                            &self_p->gateway_addr);
+        break;
+
+    default:
+        break;
+    }
+}
+
+/**
+ * Receive and decode a message from the gateway.
+ *
+ * @return zero(0) or negative error code.
+ */
+static int receive(struct mqtt_sn_client_t *self_p,
+                   int *type_p,
+                   const uint8_t **body_pp,
+                   size_t *body_size_p)
+{
+    struct inet_addr_t remote_addr;
+    ssize_t size;
+
+    while (1) {
+        size = socket_recvfrom(&self_p->socket,
+                               &self_p->input.buf[0],
+                               sizeof(self_p->input.buf),
+                               0,
+                               &remote_addr);
+
+        if (size < 0) {
+            return (size);
+        }
+
+        /* Ignore messages from anyone but the gateway. */
+        if ((remote_addr.ip.number != self_p->gateway_addr.ip.number)
+            || (remote_addr.port != self_p->gateway_addr.port)) {
+            continue;
+        }
+
+        if (decode(&self_p->input.buf[0],
+                   size,
+                   type_p,
+                   body_pp,
+                   body_size_p) == 0) {
+            return (0);
+        }
+    }
+}
+
+/**
+ * Get the message id of given response, or NO_MSG_ID if the type has
+ * none.
+ */
+static int response_msg_id(int type, const uint8_t *body_p, size_t size)
+{
+    switch (type) {
+
+    case TYPE_REGACK:
+    case TYPE_PUBACK:
+        if (size >= 5) {
+            return (unpack_u16(&body_p[2]));
+        }
+
+        break;
+
+    case TYPE_SUBACK:
+        if (size >= 6) {
+            return (unpack_u16(&body_p[3]));
+        }
+
+        break;
+
+    default:
+        break;
+    }
+
+    return (NO_MSG_ID);
+}
+
+/**
+ * Send the request in the output buffer and wait for a response of
+ * given type, retransmitting the request on timeout. Messages
+ * published by the gateway meanwhile are handled.
+ *
+ * @return zero(0) or negative error code.
+ */
+static int exchange(struct mqtt_sn_client_t *self_p,
+                    int response_type,
+                    int msg_id,
+                    const uint8_t **body_pp,
+                    size_t *body_size_p)
+{
+    struct time_t timeout;
+    int retransmissions;
+    int type;
+    int res;
+
+    timeout.seconds = (CONFIG_MQTT_SN_CLIENT_RETRY_TIMEOUT_MS / 1000);
+    timeout.nanoseconds =
+        ((CONFIG_MQTT_SN_CLIENT_RETRY_TIMEOUT_MS % 1000) * 1000000L);
+    retransmissions = 0;
+    res = send_output(self_p);
+
+    if (res < 0) {
+        return (res);
+    }
+
+    while (1) {
+        socket_set_timeout(&self_p->socket, SOCKET_TIMEOUT_RECV, &timeout);
+        res = receive(self_p, &type, body_pp, body_size_p);
+
+        if (res == -ETIMEDOUT) {
+            if (retransmissions == CONFIG_MQTT_SN_CLIENT_RETRY_MAX) {
+                return (-ETIMEDOUT);
+            }
+
+            retransmissions++;
+
+            /* Retransmitted publish and subscribe requests are marked
+               as duplicates. */
+            type = self_p->output.buf[TYPE_OFFSET];
+
+            if ((type == TYPE_PUBLISH) || (type == TYPE_SUBSCRIBE)) {
+                self_p->output.buf[TYPE_OFFSET + 1] |= FLAGS_DUP;
+            }
+
+            res = send_output(self_p);
+
+            if (res < 0) {
+                return (res);
+            }
+
+            continue;
+        }
+
+        if (res != 0) {
+            return (res);
+        }
+
+        if ((type == response_type)
+            && (response_msg_id(type, *body_pp, *body_size_p) == msg_id)) {
+            return (0);
+        }
+
+        handle_gateway_message(self_p, type, *body_pp, *body_size_p);
+    }
+}
+
+static uint16_t next_msg_id(struct mqtt_sn_client_t *self_p)
+{
+    /* Zero is not a valid message id. */
+    self_p->msg_id++;
+
+    if (self_p->msg_id == 0) {
+        self_p->msg_id++;
+    }
+
+    return (self_p->msg_id);
+}
+
+/**
+ * Send a disconnect request, with a sleep duration if positive.
+ */
+static int disconnect(struct mqtt_sn_client_t *self_p, int duration_s)
+{
+    const uint8_t *body_p;
+    size_t size;
+    uint8_t *buf_p;
+    int res;
+
+    buf_p = output_begin(self_p, TYPE_DISCONNECT);
+
+    if (duration_s > 0) {
+        pack_u16(buf_p, duration_s);
+        buf_p += 2;
+    }
+
+    output_end(self_p, buf_p);
+    res = exchange(self_p, TYPE_DISCONNECT, NO_MSG_ID, &body_p, &size);
+
+    if (res != 0) {
+        return (res);
+    }
+
+    if (duration_s > 0) {
+        self_p->state = mqtt_sn_client_state_asleep_t;
+    } else {
+        self_p->state = mqtt_sn_client_state_disconnected_t;
+    }
+
+    return (0);
+}
+
+int mqtt_sn_client_init(struct mqtt_sn_client_t *self_p,
+                        const struct inet_addr_t *gateway_addr_p,
+                        const char *client_id_p,
+                        mqtt_sn_client_on_publish_t on_publish,
+                        void *arg_p)
+{
+    ASSERTN(self_p != NULL, EINVAL);
+    ASSERTN(gateway_addr_p != NULL, EINVAL);
+    ASSERTN(client_id_p != NULL, EINVAL);
+
+    self_p->gateway_addr = *gateway_addr_p;
+    self_p->client_id_p = client_id_p;
+    self_p->state = mqtt_sn_client_state_disconnected_t;
+    self_p->msg_id = 0;
+    self_p->on_publish = on_publish;
+    self_p->arg_p = arg_p;
+
+    return (0);
+}
+
+int mqtt_sn_client_start(struct mqtt_sn_client_t *self_p)
+{
+    ASSERTN(self_p != NULL, EINVAL);
+
+    return (socket_open_udp(&self_p->socket));
+}
+
+int mqtt_sn_client_stop(struct mqtt_sn_client_t *self_p)
+{
+    ASSERTN(self_p != NULL, EINVAL);
+
+    self_p->state = mqtt_sn_client_state_disconnected_t;
+
+    return (socket_close(&self_p->socket));
+}
+
+int mqtt_sn_client_connect(struct mqtt_sn_client_t *self_p,
+                           int keep_alive_s,
+                           int clean_session)
+{
+    ASSERTN(self_p != NULL, EINVAL);
+
+    const uint8_t *body_p;
+    size_t size;
+    uint8_t *buf_p;
+    int res;
+
+    buf_p = output_begin(self_p, TYPE_CONNECT);
+    buf_p[0] = (clean_session ? FLAGS_CLEAN_SESSION : 0);
+    buf_p[1] = PROTOCOL_ID;
+    pack_u16(&buf_p[2], keep_alive_s);
+    res = output_end(self_p, output_string(self_p,
+                                           &buf_p[4],
+                                           self_p->client_id_p));
+
+    if (res != 0) {
+        return (res);
+    }
+
+    res = exchange(self_p, TYPE_CONNACK, NO_MSG_ID, &body_p, &size);
+
+    if (res != 0) {
+        return (res);
+    }
+
+    if ((size < 1) || (body_p[0] != RETURN_CODE_ACCEPTED)) {
+        return (-ECONNREFUSED);
+    }
+
+    self_p->state = mqtt_sn_client_state_active_t;
+
+    return (0);
+}
+
+int mqtt_sn_client_disconnect(struct mqtt_sn_client_t *self_p)
+{
+    ASSERTN(self_p != NULL, EINVAL);
+
+    return (disconnect(self_p, 0));
+}
+
+int mqtt_sn_client_sleep(struct mqtt_sn_client_t *self_p, int duration_s)
+{
+    ASSERTN(self_p != NULL, EINVAL);
+    ASSERTN(duration_s > 0, EINVAL);
+
+    if (self_p->state != mqtt_sn_client_state_active_t) {
+        return (-ENOTCONN);
+    }
+
+    return (disconnect(self_p, duration_s));
+}
+
+int mqtt_sn_client_ping(struct mqtt_sn_client_t *self_p)
+{
+    ASSERTN(self_p != NULL, EINVAL);
+
+    const uint8_t *body_p;
+    size_t size;
+    uint8_t *buf_p;
+    int res;
+
+    buf_p = output_begin(self_p, TYPE_PINGREQ);
+
+    /* An asleep client is awake until the gateway has sent all
+       buffered messages and the ping response. */
+    if (self_p->state == mqtt_sn_client_state_asleep_t) {
+        buf_p = output_string(self_p, buf_p, self_p->client_id_p);
+    }
+
+    res = output_end(self_p, buf_p);
+
+    if (res != 0) {
+        return (res);
+    }
+
+    return (exchange(self_p, TYPE_PINGRESP, NO_MSG_ID, &body_p, &size));
+}
+
+int mqtt_sn_client_register(struct mqtt_sn_client_t *self_p,
+                            const char *topic_p,
+                            uint16_t *topic_id_p)
+{
+    ASSERTN(self_p != NULL, EINVAL);
+    ASSERTN(topic_p != NULL, EINVAL);
+    ASSERTN(topic_id_p != NULL, EINVAL);
+
+    const uint8_t *body_p;
+    size_t size;
+    uint8_t *buf_p;
+    uint16_t msg_id;
+    int res;
+
+    if (self_p->state != mqtt_sn_client_state_active_t) {
+        return (-ENOTCONN);
+    }
+
+    msg_id = next_msg_id(self_p);
+    buf_p = output_begin(self_p, TYPE_REGISTER);
+    pack_u16(&buf_p[0], 0);
+    pack_u16(&buf_p[2], msg_id);
+    res = output_end(self_p, output_string(self_p, &buf_p[4], topic_p));
+
+    if (res != 0) {
+        return (res);
+    }
+
+    res = exchange(self_p, TYPE_REGACK, msg_id, &body_p, &size);
+
+    if (res != 0) {
+        return (res);
+    }
+
+    if (body_p[4] != RETURN_CODE_ACCEPTED) {
+        return (-ECONNREFUSED);
+    }
+
+    *topic_id_p = unpack_u16(&body_p[0]);
+
+    return (0);
+}
+
+int mqtt_sn_client_subscribe(struct mqtt_sn_client_t *self_p,
+                             const char *topic_p,
+                             int qos,
+                             uint16_t *topic_id_p)
+{
+    ASSERTN(self_p != NULL, EINVAL);
+    ASSERTN(topic_p != NULL, EINVAL);
+    ASSERTN((qos == 0) || (qos == 1), EINVAL);
+    ASSERTN(topic_id_p != NULL, EINVAL);
+
+    const uint8_t *body_p;
+    size_t size;
+    uint8_t *buf_p;
+    uint16_t msg_id;
+    int res;
+
+    if (self_p->state != mqtt_sn_client_state_active_t) {
+        return (-ENOTCONN);
+    }
+
+    msg_id = next_msg_id(self_p);
+    buf_p = output_begin(self_p, TYPE_SUBSCRIBE);
+    buf_p[0] = (FLAGS_QOS(qos) | FLAGS_TOPIC_ID_TYPE_NORMAL);
+    pack_u16(&buf_p[1], msg_id);
+    res = output_end(self_p, output_string(self_p, &buf_p[3], topic_p));
+
+    if (res != 0) {
+        return (res);
+    }
+
+    res = exchange(self_p, TYPE_SUBACK, msg_id, &body_p, &size);
+
+    if (res != 0) {
+        return (res);
+    }
+
+    if (body_p[5] != RETURN_CODE_ACCEPTED) {
+        return (-ECONNREFUSED);
+    }
+
+    *topic_id_p = unpack_u16(&body_p[1]);
+
+    return (0);
+}
+
+int mqtt_sn_client_publish(struct mqtt_sn_client_t *self_p,
+                           uint16_t topic_id,
+                           int qos,
+                           const void *buf_p,
+                           size_t size)
+{
+    ASSERTN(self_p != NULL, EINVAL);
+    ASSERTN((qos >= -1) && (qos <= 1), EINVAL);
+    ASSERTN((buf_p != NULL) || (size == 0), EINVAL);
+
+    const uint8_t *body_p;
+    size_t body_size;
+    uint8_t *u8_buf_p;
+    uint16_t msg_id;
+    int res;
+
+    if ((qos != -1) && (self_p->state != mqtt_sn_client_state_active_t)) {
+        return (-ENOTCONN);
+    }
+
+    if (qos == 1) {
+        msg_id = next_msg_id(self_p);
+    } else {
+        msg_id = 0;
+    }
+
+    u8_buf_p = output_begin(self_p, TYPE_PUBLISH);
+
+    if (qos == -1) {
+        u8_buf_p[0] = (FLAGS_QOS(3) | FLAGS_TOPIC_ID_TYPE_PREDEFINED);
+    } else {
+        u8_buf_p[0] = (FLAGS_QOS(qos) | FLAGS_TOPIC_ID_TYPE_NORMAL);
+    }
+
+    pack_u16(&u8_buf_p[1], topic_id);
+    pack_u16(&u8_buf_p[3], msg_id);
+    u8_buf_p += 5;
+
+    if (size > (size_t)(&self_p->output.buf[sizeof(self_p->output.buf)]
+                        - u8_buf_p)) {
+        return (-EMSGSIZE);
+    }
+
+    memcpy(u8_buf_p, buf_p, size);
+    output_end(self_p, u8_buf_p + size);
+
+    if (qos < 1) {
+        res = send_output(self_p);
+
+        if (res < 0) {
+            return (res);
+        }
+
+        return (0);
+    }
+
+    res = exchange(self_p, TYPE_PUBACK, msg_id, &body_p, &body_size);
+
+    if (res != 0) {
+        return (res);
+    }
+
+    if (body_p[4] != RETURN_CODE_ACCEPTED) {
+        return (-ECONNREFUSED);
+    }
+
+    return (0);
+}
+
+int mqtt_sn_client_receive(struct mqtt_sn_client_t *self_p,
+                           const struct time_t *timeout_p)
+{
+    ASSERTN(self_p != NULL, EINVAL);
+
+    const uint8_t *body_p;
+    size_t size;
+    int type;
+    int res;
+
+    socket_set_timeout(&self_p->socket, SOCKET_TIMEOUT_RECV, timeout_p);
+    res = receive(self_p, &type, &body_p, &size);
+
+    if (res != 0) {
+        return (res);
+    }
+
+    handle_gateway_message(self_p, type, body_p, size);
+
+    return (0);
+}
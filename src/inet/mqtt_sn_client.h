@@ -0,0 +1,237 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2014-2018, Erik Moqvist
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use, copy,
+ * modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ * This file is part of the Simba project.
+ */
+
+#ifndef __INET_MQTT_SN_CLIENT_H__
+#define __INET_MQTT_SN_CLIENT_H__
+
+#include "simba.h"
+
+enum mqtt_sn_client_state_t {
+    mqtt_sn_client_state_disconnected_t = 0,
+    mqtt_sn_client_state_active_t,
+    mqtt_sn_client_state_asleep_t
+};
+
+struct mqtt_sn_client_t;
+
+/**
+ * Called for each message published by the gateway.
+ *
+ * @param[in] self_p MQTT-SN client.
+ * @param[in] topic_id Topic id of the message.
+ * @param[in] buf_p Message data.
+ * @param[in] size Message data size.
+ */
+typedef void (*mqtt_sn_client_on_publish_t)(struct mqtt_sn_client_t *self_p,
+                                            uint16_t topic_id,
+                                            const void *buf_p,
+                                            size_t size);
+
+struct mqtt_sn_client_t {
+    struct inet_addr_t gateway_addr;
+    struct socket_t socket;
+    const char *client_id_p;
+    enum mqtt_sn_client_state_t state;
+    uint16_t msg_id;
+    mqtt_sn_client_on_publish_t on_publish;
+    void *arg_p;
+    struct {
+        uint8_t buf[CONFIG_MQTT_SN_CLIENT_MESSAGE_SIZE_MAX];
+        size_t pos;
+        size_t size;
+    } output;
+    struct {
+        uint8_t buf[CONFIG_MQTT_SN_CLIENT_MESSAGE_SIZE_MAX];
+    } input;
+};
+
+/**
+ * Initialize given MQTT-SN client.
+ *
+ * @param[out] self_p MQTT-SN client to initialize.
+ * @param[in] gateway_addr_p Address and port of the gateway.
+ * @param[in] client_id_p Client id, 1 to 23 characters.
+ * @param[in] on_publish Called for each message published by the
+ *                       gateway, or NULL.
+ * @param[in] arg_p Argument available to the callback in the
+ *                  ``arg_p`` member.
+ *
+ * @return zero(0) or negative error code.
+ */
+int mqtt_sn_client_init(struct mqtt_sn_client_t *self_p,
+                        const struct inet_addr_t *gateway_addr_p,
+                        const char *client_id_p,
+                        mqtt_sn_client_on_publish_t on_publish,
+                        void *arg_p);
+
+/**
+ * Open the client socket.
+ *
+ * @param[in] self_p MQTT-SN client.
+ *
+ * @return zero(0) or negative error code.
+ */
+int mqtt_sn_client_start(struct mqtt_sn_client_t *self_p);
+
+/**
+ * Close the client socket.
+ *
+ * @param[in] self_p MQTT-SN client.
+ *
+ * @return zero(0) or negative error code.
+ */
+int mqtt_sn_client_stop(struct mqtt_sn_client_t *self_p);
+
+/**
+ * Connect to the gateway.
+ *
+ * Requests are retransmitted every
+ * ``CONFIG_MQTT_SN_CLIENT_RETRY_TIMEOUT_MS`` milliseconds, at most
+ * ``CONFIG_MQTT_SN_CLIENT_RETRY_MAX`` times, until the gateway
+ * responds. This applies to all requests.
+ *
+ * @param[in] self_p MQTT-SN client.
+ * @param[in] keep_alive_s Keep alive duration in seconds. Call
+ *                         `mqtt_sn_client_ping()` more often than
+ *                         this.
+ * @param[in] clean_session One(1) to start a new session, or zero(0)
+ *                          to resume the previous one, including its
+ *                          registered topics and subscriptions.
+ *
+ * @return zero(0), -ETIMEDOUT if the gateway did not respond,
+ *         -ECONNREFUSED if the gateway rejected the request, or other
+ *         negative error code.
+ */
+int mqtt_sn_client_connect(struct mqtt_sn_client_t *self_p,
+                           int keep_alive_s,
+                           int clean_session);
+
+/**
+ * Disconnect from the gateway.
+ *
+ * @param[in] self_p MQTT-SN client.
+ *
+ * @return zero(0) or negative error code.
+ */
+int mqtt_sn_client_disconnect(struct mqtt_sn_client_t *self_p);
+
+/**
+ * Tell the gateway that the client goes to sleep for given duration.
+ * The gateway buffers messages to the client while it sleeps, and
+ * sends them once the client calls `mqtt_sn_client_ping()`, which
+ * must be done within the sleep duration. Call
+ * `mqtt_sn_client_connect()` to become active again.
+ *
+ * @param[in] self_p MQTT-SN client.
+ * @param[in] duration_s Sleep duration in seconds.
+ *
+ * @return zero(0) or negative error code.
+ */
+int mqtt_sn_client_sleep(struct mqtt_sn_client_t *self_p, int duration_s);
+
+/**
+ * Ping the gateway. When asleep, messages buffered by the gateway are
+ * received, and given to the on publish callback, before the client
+ * goes back to sleep.
+ *
+ * @param[in] self_p MQTT-SN client.
+ *
+ * @return zero(0) or negative error code.
+ */
+int mqtt_sn_client_ping(struct mqtt_sn_client_t *self_p);
+
+/**
+ * Register given topic name at the gateway, and get the topic id to
+ * publish to it with.
+ *
+ * @param[in] self_p MQTT-SN client.
+ * @param[in] topic_p Topic name.
+ * @param[out] topic_id_p Topic id.
+ *
+ * @return zero(0) or negative error code.
+ */
+int mqtt_sn_client_register(struct mqtt_sn_client_t *self_p,
+                            const char *topic_p,
+                            uint16_t *topic_id_p);
+
+/**
+ * Subscribe to given topic name.
+ *
+ * @param[in] self_p MQTT-SN client.
+ * @param[in] topic_p Topic name, possibly with wildcards.
+ * @param[in] qos Largest quality of service of received messages,
+ *                zero(0) or one(1).
+ * @param[out] topic_id_p Topic id of received messages, or zero(0)
+ *                        for topic names with wildcards, for which
+ *                        the gateway registers each matching topic
+ *                        name before publishing to it.
+ *
+ * @return zero(0) or negative error code.
+ */
+int mqtt_sn_client_subscribe(struct mqtt_sn_client_t *self_p,
+                             const char *topic_p,
+                             int qos,
+                             uint16_t *topic_id_p);
+
+/**
+ * Publish given message.
+ *
+ * Quality of service -1 messages are sent to a topic id predefined
+ * in the gateway, without acknowledgement, and may be sent without
+ * connecting. Quality of service 0 and 1 messages are sent to a
+ * registered topic id, and the latter are acknowledged by the
+ * gateway.
+ *
+ * @param[in] self_p MQTT-SN client.
+ * @param[in] topic_id Topic id.
+ * @param[in] qos Quality of service, -1, 0 or 1.
+ * @param[in] buf_p Message data.
+ * @param[in] size Message data size.
+ *
+ * @return zero(0) or negative error code.
+ */
+int mqtt_sn_client_publish(struct mqtt_sn_client_t *self_p,
+                           uint16_t topic_id,
+                           int qos,
+                           const void *buf_p,
+                           size_t size);
+
+/**
+ * Wait for a message from the gateway and handle it. Published
+ * messages are given to the on publish callback.
+ *
+ * @param[in] self_p MQTT-SN client.
+ * @param[in] timeout_p Longest wait, or NULL to wait forever.
+ *
+ * @return zero(0), -ETIMEDOUT if no message was received, or other
+ *         negative error code.
+ */
+int mqtt_sn_client_receive(struct mqtt_sn_client_t *self_p,
+                           const struct time_t *timeout_p);
+
+#endif
@@ -130,24 +130,38 @@ int network_interface_start(struct network_interface_t *netif_p)
 #include "lwip/tcpip.h"
 #include "lwip/raw.h"
 
+/**
+ * The drivers initialize their netif before it is added.
+ */
+static err_t netif_init_cb(struct netif *netif_p)
+{
+    return (ERR_OK);
+}
+
 int network_interface_add(struct network_interface_t *netif_p)
 {
     ASSERTN(netif_p != NULL, EINVAL);
 
     ip_addr_t ipaddr, netmask, gw;
+    u8_t flags;
 
     ipaddr.addr = netif_p->info.address.number;
     netmask.addr = netif_p->info.netmask.number;
     gw.addr = netif_p->info.gateway.number;
 
+    /* netif_add() clears the flags set by the driver. */
+    flags = ((struct netif *)netif_p->netif_p)->flags;
+
     netif_add(netif_p->netif_p,
               &ipaddr,
               &netmask,
               &gw,
               NULL,
-              NULL,
+              netif_init_cb,
               NULL);
 
+    ((struct netif *)netif_p->netif_p)->flags |= flags;
+
     netif_p->next_p = module.network_interfaces_p;
     module.network_interfaces_p = netif_p;
 
@@ -0,0 +1,834 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2014-2018, Erik Moqvist
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use, copy,
+ * modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ * This file is part of the Simba project.
+ */
+
+#include "simba.h"
+
+#if CONFIG_NETWORK_INTERFACE_EMAC == 1
+
+#include "lwip/init.h"
+#include "lwip/tcpip.h"
+#include "lwip/pbuf.h"
+#include "netif/etharp.h"
+
+#if !LWIP_SUPPORT_CUSTOM_PBUF
+#    error "The EMAC driver requires custom pbufs."
+#endif
+
+#define RX_DESCRIPTORS_MAX  CONFIG_NETWORK_INTERFACE_EMAC_RX_DESCRIPTORS
+#define RX_BUFFERS_MAX      CONFIG_NETWORK_INTERFACE_EMAC_RX_BUFFERS
+#define TX_DESCRIPTORS_MAX  CONFIG_NETWORK_INTERFACE_EMAC_TX_DESCRIPTORS
+
+#if RX_BUFFERS_MAX <= RX_DESCRIPTORS_MAX
+#    error "There must be more receive buffers than receive descriptors."
+#endif
+
+/* PHY registers and bits, IEEE 802.3 clause 22. */
+#define PHY_BMCR                                      0
+#define PHY_BMSR                                      1
+#define PHY_ANLPAR                                    5
+
+#define PHY_BMCR_AUTONEG_RESTART                 0x0200
+#define PHY_BMCR_AUTONEG_ENABLE                  0x1000
+
+#define PHY_BMSR_LINK_STATUS                     0x0004
+
+#define PHY_ANLPAR_10_FULL                       0x0040
+#define PHY_ANLPAR_100_HALF                      0x0080
+#define PHY_ANLPAR_100_FULL                      0x0100
+
+/* The RMII pins PB0-PB9, all on peripheral A. */
+#define PIO_MASK                             0x000003ff
+
+#define ISR_MASK (SAM_EMAC_ISR_RCOMP                    \
+                  | SAM_EMAC_ISR_RXUBR                  \
+                  | SAM_EMAC_ISR_ROVR                   \
+                  | SAM_EMAC_ISR_TCOMP                  \
+                  | SAM_EMAC_ISR_TXERR                  \
+                  | SAM_EMAC_ISR_TUND                   \
+                  | SAM_EMAC_ISR_RLEX)
+
+struct descriptor_t {
+    uint32_t address;
+    uint32_t status;
+};
+
+/* A receive buffer handed to lwIP as a custom pbuf referencing its
+   data. The custom pbuf must be the first member. */
+struct rx_buffer_t {
+    struct pbuf_custom custom;
+    struct rx_buffer_t *next_p;
+    uint8_t *data_p;
+};
+
+struct module_t {
+    int8_t initialized;
+    struct network_interface_emac_t *self_p;
+    struct netif netif;
+    struct {
+        struct rx_buffer_t *free_p;
+        struct rx_buffer_t *descriptor_buffers[RX_DESCRIPTORS_MAX];
+        struct rx_buffer_t buffers[RX_BUFFERS_MAX];
+        struct fs_counter_t frames;
+        struct fs_counter_t bytes;
+        struct fs_counter_t errors;
+    } rx;
+    struct {
+        struct pbuf *pbufs[TX_DESCRIPTORS_MAX];
+        struct fs_counter_t frames;
+        struct fs_counter_t bytes;
+        struct fs_counter_t errors;
+    } tx;
+};
+
+static struct module_t module;
+
+/* The descriptor rings and the receive buffers are accessed by the
+   EMAC DMA. */
+static volatile struct descriptor_t rx_descriptors[RX_DESCRIPTORS_MAX]
+__attribute__ ((aligned (8)));
+static volatile struct descriptor_t tx_descriptors[TX_DESCRIPTORS_MAX]
+__attribute__ ((aligned (8)));
+static uint8_t rx_data[RX_BUFFERS_MAX][SAM_EMAC_RX_BUFFER_SIZE]
+__attribute__ ((aligned (8)));
+
+ISR(emac)
+{
+    uint32_t isr;
+
+    /* Reading the status clears it. */
+    isr = SAM_EMAC->ISR;
+
+    if ((isr & ISR_MASK) != 0) {
+        if (module.self_p != NULL) {
+            sem_give_isr(&module.self_p->sem, 1);
+        }
+    }
+}
+
+static uint16_t phy_transfer(uint32_t man)
+{
+    SAM_EMAC->MAN = (SAM_EMAC_MAN_SOF(1) | SAM_EMAC_MAN_CODE(2) | man);
+
+    /* A management frame takes about 25 us at MCK/64. */
+    while ((SAM_EMAC->NSR & SAM_EMAC_NSR_IDLE) == 0);
+
+    return (SAM_EMAC->MAN & SAM_EMAC_MAN_DATA_MASK);
+}
+
+static uint16_t phy_read(struct network_interface_emac_t *self_p,
+                         int reg)
+{
+    return (phy_transfer(SAM_EMAC_MAN_RW_READ
+                         | SAM_EMAC_MAN_PHYA(self_p->phy_address)
+                         | SAM_EMAC_MAN_REGA(reg)));
+}
+
+static void phy_write(struct network_interface_emac_t *self_p,
+                      int reg,
+                      uint16_t value)
+{
+    phy_transfer(SAM_EMAC_MAN_RW_WRITE
+                 | SAM_EMAC_MAN_PHYA(self_p->phy_address)
+                 | SAM_EMAC_MAN_REGA(reg)
+                 | SAM_EMAC_MAN_DATA(value));
+}
+
+static void netif_set_link_up_cb(void *arg_p)
+{
+    netif_set_link_up(arg_p);
+}
+
+static void netif_set_link_down_cb(void *arg_p)
+{
+    netif_set_link_down(arg_p);
+}
+
+/**
+ * Poll the PHY for link changes and configure the speed and duplex
+ * mode negotiated by the PHY.
+ */
+static void update_link(struct network_interface_emac_t *self_p)
+{
+    uint16_t anlpar;
+    uint32_t ncfgr;
+    int link_up;
+
+    /* The link status is latched low, so read it twice to get the
+       current status. */
+    phy_read(self_p, PHY_BMSR);
+    link_up = ((phy_read(self_p, PHY_BMSR) & PHY_BMSR_LINK_STATUS) != 0);
+
+    if (link_up == self_p->link_up) {
+        return;
+    }
+
+    self_p->link_up = link_up;
+
+    if (link_up == 1) {
+        anlpar = phy_read(self_p, PHY_ANLPAR);
+        ncfgr = (SAM_EMAC->NCFGR
+                 & ~(SAM_EMAC_NCFGR_SPD | SAM_EMAC_NCFGR_FD));
+
+        if (anlpar & PHY_ANLPAR_100_FULL) {
+            ncfgr |= (SAM_EMAC_NCFGR_SPD | SAM_EMAC_NCFGR_FD);
+        } else if (anlpar & PHY_ANLPAR_100_HALF) {
+            ncfgr |= SAM_EMAC_NCFGR_SPD;
+        } else if (anlpar & PHY_ANLPAR_10_FULL) {
+            ncfgr |= SAM_EMAC_NCFGR_FD;
+        }
+
+        SAM_EMAC->NCFGR = ncfgr;
+        tcpip_callback(netif_set_link_up_cb, &module.netif);
+    } else {
+        tcpip_callback(netif_set_link_down_cb, &module.netif);
+    }
+}
+
+static void rx_buffer_put(struct rx_buffer_t *buffer_p)
+{
+    sys_lock();
+    buffer_p->next_p = module.rx.free_p;
+    module.rx.free_p = buffer_p;
+    sys_unlock();
+}
+
+static struct rx_buffer_t *rx_buffer_get(void)
+{
+    struct rx_buffer_t *buffer_p;
+
+    sys_lock();
+    buffer_p = module.rx.free_p;
+
+    if (buffer_p != NULL) {
+        module.rx.free_p = buffer_p->next_p;
+    }
+
+    sys_unlock();
+
+    return (buffer_p);
+}
+
+/**
+ * Called by lwIP when it has processed a received buffer.
+ */
+static void rx_buffer_free(struct pbuf *pbuf_p)
+{
+    struct network_interface_emac_t *self_p;
+
+    self_p = module.self_p;
+    rx_buffer_put((struct rx_buffer_t *)pbuf_p);
+
+    /* Resume reception if it was paused by lack of buffers. */
+    if (self_p->rx.starving == 1) {
+        self_p->rx.starving = 0;
+        sem_give(&self_p->sem, 1);
+    }
+}
+
+static void rx_frame_discard(struct network_interface_emac_t *self_p)
+{
+    if (self_p->rx.pbuf_p != NULL) {
+        pbuf_free(self_p->rx.pbuf_p);
+        self_p->rx.pbuf_p = NULL;
+        fs_counter_increment(&module.rx.errors, 1);
+    }
+
+    self_p->rx.size = 0;
+}
+
+/**
+ * Hand all received buffers to lwIP, chaining the buffers of each
+ * frame, and give the descriptors new buffers. Reception is paused if
+ * there are no free buffers, until lwIP frees one.
+ */
+static void rx_process(struct network_interface_emac_t *self_p)
+{
+    volatile struct descriptor_t *descriptor_p;
+    struct rx_buffer_t *buffer_p;
+    struct rx_buffer_t *free_p;
+    struct pbuf *pbuf_p;
+    uint32_t status;
+    uint32_t rsr;
+    size_t size;
+    int index;
+
+    rsr = SAM_EMAC->RSR;
+    SAM_EMAC->RSR = rsr;
+
+    if (rsr & (SAM_EMAC_RSR_OVR | SAM_EMAC_RSR_BNA)) {
+        fs_counter_increment(&module.rx.errors, 1);
+    }
+
+    while (1) {
+        index = self_p->rx.index;
+        descriptor_p = &rx_descriptors[index];
+
+        if ((descriptor_p->address & SAM_EMAC_RX_ADDRESS_OWNERSHIP) == 0) {
+            break;
+        }
+
+        free_p = rx_buffer_get();
+
+        if (free_p == NULL) {
+            self_p->rx.starving = 1;
+
+            /* A buffer may have been freed before the flag was set. */
+            free_p = rx_buffer_get();
+
+            if (free_p == NULL) {
+                break;
+            }
+
+            self_p->rx.starving = 0;
+        }
+
+        status = descriptor_p->status;
+        buffer_p = module.rx.descriptor_buffers[index];
+
+        /* Give the descriptor back to the EMAC with the new buffer. */
+        module.rx.descriptor_buffers[index] = free_p;
+
+        if (index == RX_DESCRIPTORS_MAX - 1) {
+            descriptor_p->address = ((uint32_t)free_p->data_p
+                                     | SAM_EMAC_RX_ADDRESS_WRAP);
+            self_p->rx.index = 0;
+        } else {
+            descriptor_p->address = (uint32_t)free_p->data_p;
+            self_p->rx.index++;
+        }
+
+        if (status & SAM_EMAC_RX_STATUS_SOF) {
+            rx_frame_discard(self_p);
+        } else if (self_p->rx.pbuf_p == NULL) {
+            /* The start of the frame was lost. */
+            rx_buffer_put(buffer_p);
+            continue;
+        }
+
+        if (status & SAM_EMAC_RX_STATUS_EOF) {
+            /* The length of the last buffer is the frame length minus
+               the length of the previous buffers. */
+            size = (status & SAM_EMAC_RX_STATUS_LENGTH_MASK);
+
+            if ((size <= self_p->rx.size)
+                || (size - self_p->rx.size > SAM_EMAC_RX_BUFFER_SIZE)) {
+                rx_buffer_put(buffer_p);
+                rx_frame_discard(self_p);
+                fs_counter_increment(&module.rx.errors, 1);
+                continue;
+            }
+
+            size -= self_p->rx.size;
+        } else {
+            size = SAM_EMAC_RX_BUFFER_SIZE;
+        }
+
+        buffer_p->custom.custom_free_function = rx_buffer_free;
+        pbuf_p = pbuf_alloced_custom(PBUF_RAW,
+                                     size,
+                                     PBUF_REF,
+                                     &buffer_p->custom,
+                                     buffer_p->data_p,
+                                     SAM_EMAC_RX_BUFFER_SIZE);
+
+        if (self_p->rx.pbuf_p == NULL) {
+            self_p->rx.pbuf_p = pbuf_p;
+        } else {
+            pbuf_cat(self_p->rx.pbuf_p, pbuf_p);
+        }
+
+        self_p->rx.size += size;
+
+        if (status & SAM_EMAC_RX_STATUS_EOF) {
+            fs_counter_increment(&module.rx.frames, 1);
+            fs_counter_increment(&module.rx.bytes, self_p->rx.size);
+
+            if (tcpip_input(self_p->rx.pbuf_p, &module.netif) != ERR_OK) {
+                pbuf_free(self_p->rx.pbuf_p);
+                fs_counter_increment(&module.rx.errors, 1);
+            }
+
+            self_p->rx.pbuf_p = NULL;
+            self_p->rx.size = 0;
+        }
+    }
+}
+
+/**
+ * Free transmitted frames, or all queued frames if force is
+ * true. Must be called with the tx mutex locked.
+ */
+static void tx_reclaim(struct network_interface_emac_t *self_p,
+                       int force)
+{
+    uint32_t status;
+    int tail;
+
+    while (self_p->tx.count > 0) {
+        tail = self_p->tx.tail;
+        status = tx_descriptors[tail].status;
+
+        if (((status & SAM_EMAC_TX_STATUS_USED) == 0) && !force) {
+            break;
+        }
+
+        if (status & (SAM_EMAC_TX_STATUS_EXHAUSTED
+                      | SAM_EMAC_TX_STATUS_UNDERRUN
+                      | SAM_EMAC_TX_STATUS_RETRY)) {
+            fs_counter_increment(&module.tx.errors, 1);
+        }
+
+        pbuf_free(module.tx.pbufs[tail]);
+        module.tx.pbufs[tail] = NULL;
+
+        /* Mark all descriptors of the frame as used. */
+        do {
+            status = tx_descriptors[tail].status;
+            tx_descriptors[tail].status = ((status & SAM_EMAC_TX_STATUS_WRAP)
+                                           | SAM_EMAC_TX_STATUS_USED);
+            tail++;
+
+            if (tail == TX_DESCRIPTORS_MAX) {
+                tail = 0;
+            }
+
+            self_p->tx.count--;
+        } while ((status & SAM_EMAC_TX_STATUS_LAST) == 0);
+
+        self_p->tx.tail = tail;
+    }
+}
+
+/**
+ * Referenced pbufs may be reused by their owner once this function
+ * returns, and may be located in flash, which the EMAC DMA cannot
+ * read, but received buffers are reference counted and can be sent
+ * as they are.
+ */
+static int is_dma_safe(struct pbuf *pbuf_p)
+{
+    while (pbuf_p != NULL) {
+        if (((pbuf_p->type == PBUF_REF) || (pbuf_p->type == PBUF_ROM))
+            && ((pbuf_p->flags & PBUF_FLAG_IS_CUSTOM) == 0)) {
+            return (0);
+        }
+
+        pbuf_p = pbuf_p->next;
+    }
+
+    return (1);
+}
+
+/**
+ * Queue given frame for transmission, one descriptor per pbuf in the
+ * chain.
+ */
+static err_t linkoutput(struct netif *netif_p, struct pbuf *pbuf_p)
+{
+    struct network_interface_emac_t *self_p;
+    struct pbuf *frame_p;
+    struct pbuf *q_p;
+    uint32_t status;
+    uint32_t first_status;
+    int count;
+    int first;
+    int index;
+
+    self_p = module.self_p;
+
+    if (is_dma_safe(pbuf_p)) {
+        frame_p = pbuf_p;
+        pbuf_ref(frame_p);
+    } else {
+        frame_p = pbuf_alloc(PBUF_RAW, pbuf_p->tot_len, PBUF_RAM);
+
+        if (frame_p == NULL) {
+            fs_counter_increment(&module.tx.errors, 1);
+
+            return (ERR_MEM);
+        }
+
+        pbuf_copy(frame_p, pbuf_p);
+    }
+
+    count = 0;
+
+    for (q_p = frame_p; q_p != NULL; q_p = q_p->next) {
+        if (q_p->len > 0) {
+            count++;
+        }
+    }
+
+    mutex_lock(&self_p->tx.mutex);
+
+    tx_reclaim(self_p, 0);
+
+    if ((count == 0)
+        || (self_p->started == 0)
+        || (count > TX_DESCRIPTORS_MAX - self_p->tx.count)) {
+        mutex_unlock(&self_p->tx.mutex);
+        pbuf_free(frame_p);
+        fs_counter_increment(&module.tx.errors, 1);
+
+        return (ERR_MEM);
+    }
+
+    first = self_p->tx.head;
+    index = first;
+    first_status = 0;
+
+    for (q_p = frame_p; q_p != NULL; q_p = q_p->next) {
+        if (q_p->len == 0) {
+            continue;
+        }
+
+        count--;
+        status = q_p->len;
+
+        if (count == 0) {
+            status |= SAM_EMAC_TX_STATUS_LAST;
+        }
+
+        if (index == TX_DESCRIPTORS_MAX - 1) {
+            status |= SAM_EMAC_TX_STATUS_WRAP;
+        }
+
+        tx_descriptors[index].address = (uint32_t)q_p->payload;
+
+        /* The first descriptor is given to the EMAC last. */
+        if (index == first) {
+            first_status = status;
+        } else {
+            tx_descriptors[index].status = status;
+            self_p->tx.count++;
+        }
+
+        index++;
+
+        if (index == TX_DESCRIPTORS_MAX) {
+            index = 0;
+        }
+    }
+
+    module.tx.pbufs[first] = frame_p;
+    tx_descriptors[first].status = first_status;
+    self_p->tx.count++;
+    self_p->tx.head = index;
+    SAM_EMAC->NCR |= SAM_EMAC_NCR_TSTART;
+
+    mutex_unlock(&self_p->tx.mutex);
+
+    fs_counter_increment(&module.tx.frames, 1);
+    fs_counter_increment(&module.tx.bytes, frame_p->tot_len);
+
+    return (ERR_OK);
+}
+
+static void *emac_main(void *arg_p)
+{
+    struct network_interface_emac_t *self_p;
+    struct time_t timeout;
+
+    self_p = arg_p;
+    thrd_set_name("emac");
+
+    /* Poll the PHY for link changes once a second. */
+    timeout.seconds = 1;
+    timeout.nanoseconds = 0;
+
+    while (1) {
+        sem_take(&self_p->sem, &timeout);
+
+        if (self_p->started == 0) {
+            continue;
+        }
+
+        update_link(self_p);
+        rx_process(self_p);
+
+        mutex_lock(&self_p->tx.mutex);
+        tx_reclaim(self_p, 0);
+        mutex_unlock(&self_p->tx.mutex);
+    }
+
+    return (NULL);
+}
+
+static int start(struct network_interface_t *netif_p)
+{
+    struct network_interface_emac_t *self_p;
+    const uint8_t *mac_p;
+
+    self_p = container_of(netif_p,
+                          struct network_interface_emac_t,
+                          network_interface);
+    mac_p = &self_p->mac_address[0];
+
+    if (self_p->started == 1) {
+        return (0);
+    }
+
+    pmc_peripheral_clock_enable(PERIPHERAL_ID_EMAC);
+
+    SAM_PIOB->PDR = PIO_MASK;
+    SAM_PIOB->ABSR &= ~PIO_MASK;
+
+    SAM_EMAC->NCR = 0;
+    SAM_EMAC->IDR = 0xffffffff;
+    SAM_EMAC->NCR = SAM_EMAC_NCR_CLRSTAT;
+    SAM_EMAC->RSR = (SAM_EMAC_RSR_BNA | SAM_EMAC_RSR_REC | SAM_EMAC_RSR_OVR);
+    SAM_EMAC->TSR = (SAM_EMAC_TSR_UBR
+                     | SAM_EMAC_TSR_COL
+                     | SAM_EMAC_TSR_RLES
+                     | SAM_EMAC_TSR_BEX
+                     | SAM_EMAC_TSR_COMP
+                     | SAM_EMAC_TSR_UND);
+    (void)SAM_EMAC->ISR;
+
+    SAM_EMAC->USRIO = (SAM_EMAC_USRIO_RMII | SAM_EMAC_USRIO_CLKEN);
+    SAM_EMAC->NCFGR = (SAM_EMAC_NCFGR_CLK_MCK_64
+                       | SAM_EMAC_NCFGR_SPD
+                       | SAM_EMAC_NCFGR_FD
+                       | SAM_EMAC_NCFGR_DRFCS);
+    SAM_EMAC->SA[0].B = ((mac_p[3] << 24)
+                         | (mac_p[2] << 16)
+                         | (mac_p[1] << 8)
+                         | mac_p[0]);
+    SAM_EMAC->SA[0].T = ((mac_p[5] << 8) | mac_p[4]);
+
+    /* Continue where the rings were left if restarted. */
+    rx_frame_discard(self_p);
+    SAM_EMAC->RBQP = (uint32_t)&rx_descriptors[self_p->rx.index];
+    SAM_EMAC->TBQP = (uint32_t)&tx_descriptors[self_p->tx.head];
+
+    SAM_EMAC->NCR = (SAM_EMAC_NCR_RE | SAM_EMAC_NCR_TE | SAM_EMAC_NCR_MPE);
+
+    phy_write(self_p,
+              PHY_BMCR,
+              PHY_BMCR_AUTONEG_ENABLE | PHY_BMCR_AUTONEG_RESTART);
+    self_p->link_up = 0;
+    self_p->started = 1;
+
+    SAM_EMAC->IER = ISR_MASK;
+    nvic_enable_interrupt(PERIPHERAL_ID_EMAC);
+
+    sem_give(&self_p->sem, 1);
+
+    return (0);
+}
+
+static int stop(struct network_interface_t *netif_p)
+{
+    struct network_interface_emac_t *self_p;
+
+    self_p = container_of(netif_p,
+                          struct network_interface_emac_t,
+                          network_interface);
+
+    nvic_disable_interrupt(PERIPHERAL_ID_EMAC);
+    SAM_EMAC->IDR = 0xffffffff;
+    SAM_EMAC->NCR = 0;
+
+    mutex_lock(&self_p->tx.mutex);
+    self_p->started = 0;
+    tx_reclaim(self_p, 1);
+    mutex_unlock(&self_p->tx.mutex);
+
+    self_p->link_up = 0;
+    tcpip_callback(netif_set_link_down_cb, &module.netif);
+
+    return (0);
+}
+
+static int is_up(struct network_interface_t *netif_p)
+{
+    struct network_interface_emac_t *self_p;
+
+    self_p = container_of(netif_p,
+                          struct network_interface_emac_t,
+                          network_interface);
+
+    return (self_p->started && self_p->link_up);
+}
+
+static int set_ip_info(struct network_interface_t *netif_p,
+                       const struct inet_if_ip_info_t *info_p)
+{
+    ip_addr_t ipaddr, netmask, gw;
+
+    ipaddr.addr = info_p->address.number;
+    netmask.addr = info_p->netmask.number;
+    gw.addr = info_p->gateway.number;
+    netif_set_addr(&module.netif, &ipaddr, &netmask, &gw);
+
+    return (0);
+}
+
+static int get_ip_info(struct network_interface_t *netif_p,
+                       struct inet_if_ip_info_t *info_p)
+{
+    info_p->address.number = module.netif.ip_addr.addr;
+    info_p->netmask.number = module.netif.netmask.addr;
+    info_p->gateway.number = module.netif.gw.addr;
+
+    return (0);
+}
+
+int network_interface_emac_module_init(void)
+{
+    /* Return immediately if the module is already initialized. */
+    if (module.initialized == 1) {
+        return (0);
+    }
+
+    module.initialized = 1;
+
+    fs_counter_init(&module.rx.frames,
+                    FSTR("/inet/network_interface/emac/rx_frames"),
+                    0);
+    fs_counter_register(&module.rx.frames);
+    fs_counter_init(&module.rx.bytes,
+                    FSTR("/inet/network_interface/emac/rx_bytes"),
+                    0);
+    fs_counter_register(&module.rx.bytes);
+    fs_counter_init(&module.rx.errors,
+                    FSTR("/inet/network_interface/emac/rx_errors"),
+                    0);
+    fs_counter_register(&module.rx.errors);
+    fs_counter_init(&module.tx.frames,
+                    FSTR("/inet/network_interface/emac/tx_frames"),
+                    0);
+    fs_counter_register(&module.tx.frames);
+    fs_counter_init(&module.tx.bytes,
+                    FSTR("/inet/network_interface/emac/tx_bytes"),
+                    0);
+    fs_counter_register(&module.tx.bytes);
+    fs_counter_init(&module.tx.errors,
+                    FSTR("/inet/network_interface/emac/tx_errors"),
+                    0);
+    fs_counter_register(&module.tx.errors);
+
+    return (0);
+}
+
+int network_interface_emac_init(struct network_interface_emac_t *self_p,
+                                const uint8_t *mac_address_p,
+                                int phy_address,
+                                struct inet_ip_addr_t *ipaddr_p,
+                                struct inet_ip_addr_t *netmask_p,
+                                struct inet_ip_addr_t *gateway_p)
+{
+    ASSERTN(self_p != NULL, EINVAL);
+    ASSERTN(mac_address_p != NULL, EINVAL);
+    ASSERTN((phy_address >= 0) && (phy_address < 32), EINVAL);
+    ASSERTN(ipaddr_p != NULL, EINVAL);
+    ASSERTN(netmask_p != NULL, EINVAL);
+    ASSERTN(gateway_p != NULL, EINVAL);
+
+    int i;
+
+    /* There is only one EMAC. */
+    if (module.self_p != NULL) {
+        return (-EBUSY);
+    }
+
+    module.self_p = self_p;
+
+    memcpy(&self_p->mac_address[0],
+           mac_address_p,
+           sizeof(self_p->mac_address));
+    self_p->phy_address = phy_address;
+    self_p->started = 0;
+    self_p->link_up = 0;
+    sem_init(&self_p->sem, 1, 1);
+
+    /* Give each receive descriptor a buffer and put the rest in the
+       free list. */
+    module.rx.free_p = NULL;
+
+    for (i = 0; i < RX_BUFFERS_MAX; i++) {
+        module.rx.buffers[i].data_p = &rx_data[i][0];
+
+        if (i < RX_DESCRIPTORS_MAX) {
+            module.rx.descriptor_buffers[i] = &module.rx.buffers[i];
+            rx_descriptors[i].address = (uint32_t)&rx_data[i][0];
+            rx_descriptors[i].status = 0;
+        } else {
+            rx_buffer_put(&module.rx.buffers[i]);
+        }
+    }
+
+    rx_descriptors[RX_DESCRIPTORS_MAX - 1].address |= SAM_EMAC_RX_ADDRESS_WRAP;
+    self_p->rx.index = 0;
+    self_p->rx.starving = 0;
+    self_p->rx.pbuf_p = NULL;
+    self_p->rx.size = 0;
+
+    /* All transmit descriptors are owned by software. */
+    for (i = 0; i < TX_DESCRIPTORS_MAX; i++) {
+        tx_descriptors[i].address = 0;
+        tx_descriptors[i].status = SAM_EMAC_TX_STATUS_USED;
+        module.tx.pbufs[i] = NULL;
+    }
+
+    tx_descriptors[TX_DESCRIPTORS_MAX - 1].status |= SAM_EMAC_TX_STATUS_WRAP;
+    self_p->tx.head = 0;
+    self_p->tx.tail = 0;
+    self_p->tx.count = 0;
+    mutex_init(&self_p->tx.mutex);
+
+    self_p->network_interface.name_p = "emac";
+    self_p->network_interface.info.address = *ipaddr_p;
+    self_p->network_interface.info.netmask = *netmask_p;
+    self_p->network_interface.info.gateway = *gateway_p;
+    self_p->network_interface.start = start;
+    self_p->network_interface.stop = stop;
+    self_p->network_interface.is_up = is_up;
+    self_p->network_interface.set_ip_info = set_ip_info;
+    self_p->network_interface.get_ip_info = get_ip_info;
+    self_p->network_interface.netif_p = &module.netif;
+
+    module.netif.name[0] = 'e';
+    module.netif.name[1] = 'n';
+    module.netif.output = etharp_output;
+    module.netif.linkoutput = linkoutput;
+    module.netif.mtu = 1500;
+    module.netif.hwaddr_len = ETHARP_HWADDR_LEN;
+    memcpy(&module.netif.hwaddr[0], mac_address_p, ETHARP_HWADDR_LEN);
+    module.netif.flags = (NETIF_FLAG_BROADCAST | NETIF_FLAG_ETHARP);
+
+    thrd_spawn(emac_main,
+               self_p,
+               -15,
+               self_p->stack,
+               sizeof(self_p->stack));
+
+    return (0);
+}
+
+#endif
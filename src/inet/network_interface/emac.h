@@ -0,0 +1,92 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2014-2018, Erik Moqvist
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use, copy,
+ * modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ * This file is part of the Simba project.
+ */
+
+#ifndef __INET_NETWORK_INTERFACE_EMAC_H__
+#define __INET_NETWORK_INTERFACE_EMAC_H__
+
+#include "simba.h"
+
+#if CONFIG_NETWORK_INTERFACE_EMAC == 1
+
+struct network_interface_emac_t {
+    struct network_interface_t network_interface;
+    uint8_t mac_address[6];
+    int phy_address;
+    int started;
+    int link_up;
+    struct sem_t sem;
+    struct {
+        int index;
+        int starving;
+        struct pbuf *pbuf_p;
+        size_t size;
+    } rx;
+    struct {
+        int head;
+        int tail;
+        int count;
+        struct mutex_t mutex;
+    } tx;
+    THRD_STACK(stack, 1024);
+};
+
+/**
+ * Initialize the EMAC module.
+ *
+ * @return zero(0) or negative error code.
+ */
+int network_interface_emac_module_init(void);
+
+/**
+ * Initialize given Ethernet network interface, using the EMAC and a
+ * RMII PHY connected to pins PB0-PB9. Received frames are handed to
+ * the IP stack in the DMA buffers they were received in, and
+ * transmitted frames are sent from the buffers of the IP stack,
+ * without copying.
+ *
+ * There is only one EMAC, so only one interface can be initialized.
+ *
+ * @param[in] self_p Interface to initialize.
+ * @param[in] mac_address_p Six bytes MAC address.
+ * @param[in] phy_address PHY address on the management bus, 0-31.
+ * @param[in] ipaddr_p Network interface IP address.
+ * @param[in] netmask_p Network interface netmask.
+ * @param[in] gateway_p Network interface gateway.
+ *
+ * @return zero(0) or negative error code.
+ */
+int network_interface_emac_init(struct network_interface_emac_t *self_p,
+                                const uint8_t *mac_address_p,
+                                int phy_address,
+                                struct inet_ip_addr_t *ipaddr_p,
+                                struct inet_ip_addr_t *netmask_p,
+                                struct inet_ip_addr_t *gateway_p);
+
+#endif
+
+#endif
@@ -53,6 +53,23 @@
 static int netif_allocated = 0;
 static struct netif netif;
 
+/**
+ * Returns the number of bytes in given buffer before the first END or
+ * ESC byte, that is, the number of bytes that are not escaped.
+ */
+static size_t span_length(const uint8_t *buf_p, size_t size)
+{
+    size_t i;
+
+    for (i = 0; i < size; i++) {
+        if ((buf_p[i] == SLIP_END) || (buf_p[i] == SLIP_ESC)) {
+            break;
+        }
+    }
+
+    return (i);
+}
+
 /**
  * Encapsulate given packet and write it to the output channel.
  */
@@ -65,8 +82,11 @@ static err_t output(struct netif *netif_p,
 #endif
                     )
 {
-    int i;
     uint8_t data;
+    uint8_t escape[2];
+    const uint8_t *buf_p;
+    size_t left;
+    size_t n;
     struct network_interface_slip_t *self_p;
 
     self_p = container_of((void *)netif_p,
@@ -77,25 +97,32 @@ static err_t output(struct netif *netif_p,
     chan_write(self_p->chout_p, &data, 1);
 
     while (pbuf_p != NULL) {
-        for (i = 0; i < pbuf_p->len; i++) {
-            data = ((uint8_t *)pbuf_p->payload)[i];
-
-            switch (data) {
-
-            case SLIP_END:
-                data = SLIP_ESC;
-                chan_write(self_p->chout_p, &data, 1);
-                data = SLIP_ESC_END;
-                break;
-
-            case SLIP_ESC:
-                data = SLIP_ESC;
-                chan_write(self_p->chout_p, &data, 1);
-                data = SLIP_ESC_ESC;
-                break;
+        buf_p = pbuf_p->payload;
+        left = pbuf_p->len;
+
+        while (left > 0) {
+            /* Write bytes that are not escaped in one go. */
+            n = span_length(buf_p, left);
+
+            if (n > 0) {
+                chan_write(self_p->chout_p, buf_p, n);
+                buf_p += n;
+                left -= n;
             }
 
-            chan_write(self_p->chout_p, &data, 1);
+            if (left > 0) {
+                escape[0] = SLIP_ESC;
+
+                if (*buf_p == SLIP_END) {
+                    escape[1] = SLIP_ESC_END;
+                } else {
+                    escape[1] = SLIP_ESC_ESC;
+                }
+
+                chan_write(self_p->chout_p, &escape[0], sizeof(escape));
+                buf_p++;
+                left--;
+            }
         }
 
         pbuf_p = pbuf_p->next;
@@ -261,6 +288,49 @@ int network_interface_slip_input(struct network_interface_slip_t *self_p,
     return (0);
 }
 
+int network_interface_slip_input_buffer(struct network_interface_slip_t *self_p,
+                                        const uint8_t *buf_p,
+                                        size_t size)
+{
+    ASSERTN(self_p != NULL, EINVAL);
+    ASSERTN(buf_p != NULL, EINVAL);
+
+    int res;
+    size_t n;
+    size_t m;
+
+    res = 0;
+
+    while (size > 0) {
+        if ((self_p->state == NETWORK_INTERFACE_SLIP_STATE_ESCAPE)
+            || (*buf_p == SLIP_END)
+            || (*buf_p == SLIP_ESC)) {
+            if (network_interface_slip_input(self_p, *buf_p) < 0) {
+                res = -1;
+            }
+
+            buf_p++;
+            size--;
+        } else {
+            /* Copy bytes that are not escaped in one go, truncating
+               long packets. */
+            n = span_length(buf_p, size);
+            m = MIN(n, (NETWORK_INTERFACE_SLIP_FRAME_SIZE_MAX
+                        - self_p->frame.size));
+            memcpy(&self_p->frame.buf_p[self_p->frame.size], buf_p, m);
+            self_p->frame.size += m;
+            buf_p += n;
+            size -= n;
+
+            if (m < n) {
+                res = -1;
+            }
+        }
+    }
+
+    return (res);
+}
+
 #else
 
 int network_interface_slip_module_init(void)
@@ -286,4 +356,11 @@ int network_interface_slip_input(struct network_interface_slip_t *self_p,
     return (0);
 }
 
+int network_interface_slip_input_buffer(struct network_interface_slip_t *self_p,
+                                        const uint8_t *buf_p,
+                                        size_t size)
+{
+    return (0);
+}
+
 #endif
@@ -88,4 +88,23 @@ int network_interface_slip_init(struct network_interface_slip_t *self_p,
 int network_interface_slip_input(struct network_interface_slip_t *self_p,
                                  uint8_t data);
 
+/**
+ * Input a buffer of bytes into the SLIP IP stack. Bytes that are not
+ * escaped are copied in bulk to the frame buffer, and all complete
+ * frames are input to the IP stack. Normally a user thread reads all
+ * bytes available in the UART, see ``chan_size()``, and calls this
+ * function with them, which keeps up with much higher baudrates than
+ * network_interface_slip_input().
+ *
+ * @param[in] self_p Initialized slip.
+ * @param[in] buf_p Bytes to input into the stack.
+ * @param[in] size Number of bytes.
+ *
+ * @return zero(0) or negative error code if any frame was truncated
+ *         or malformed.
+ */
+int network_interface_slip_input_buffer(struct network_interface_slip_t *self_p,
+                                        const uint8_t *buf_p,
+                                        size_t size);
+
 #endif
@@ -46,10 +46,285 @@ struct module_t {
 #if CONFIG_PING_FS_COMMAND_PING == 1
     struct fs_command_t cmd_ping;
 #endif
+#if CONFIG_PING_FS_COMMAND_PROBE == 1
+    struct fs_command_t cmd_probe;
+    struct ping_probe_t probe;
+#endif
+#if CONFIG_PING_PROBE_COUNTERS == 1
+    struct fs_counter_t probe_sent;
+    struct fs_counter_t probe_received;
+    struct fs_counter_t probe_lost;
+#endif
 };
 
 static struct module_t module;
 
+/**
+ * Returns the histogram bucket index of given round trip time.
+ */
+static int histogram_index(uint32_t value)
+{
+    int magnitude;
+
+    if (value < 8) {
+        return (value);
+    }
+
+    if (value >= (1UL << 24)) {
+        return (PING_PROBE_HISTOGRAM_LENGTH - 1);
+    }
+
+    magnitude = 3;
+
+    while ((value >> (magnitude + 1)) != 0) {
+        magnitude++;
+    }
+
+    return (8 * (magnitude - 2) + ((value >> (magnitude - 3)) & 0x7));
+}
+
+/**
+ * Returns the highest round trip time recorded in given histogram
+ * bucket.
+ */
+static uint32_t histogram_highest_value(int index)
+{
+    int shift;
+
+    if (index < 8) {
+        return (index);
+    }
+
+    /* The last bucket also holds all longer times. */
+    if (index == PING_PROBE_HISTOGRAM_LENGTH - 1) {
+        return (0xffffffff);
+    }
+
+    shift = (index / 8 - 1);
+
+    return (((uint32_t)(8 + (index & 0x7) + 1) << shift) - 1);
+}
+
+/**
+ * Returns the round trip time below which given number of per mille
+ * of the received replies were received.
+ */
+static uint32_t histogram_percentile(struct ping_probe_t *self_p,
+                                     int per_mille)
+{
+    uint32_t target;
+    uint32_t count;
+    uint32_t value;
+    int i;
+
+    target = ((self_p->histogram.received * per_mille + 999) / 1000);
+    count = 0;
+
+    for (i = 0; i < PING_PROBE_HISTOGRAM_LENGTH; i++) {
+        count += self_p->histogram.buckets[i];
+
+        if (count >= target) {
+            break;
+        }
+    }
+
+    value = histogram_highest_value(i);
+
+    if (value > self_p->histogram.max_us) {
+        value = self_p->histogram.max_us;
+    }
+
+    if (value < self_p->histogram.min_us) {
+        value = self_p->histogram.min_us;
+    }
+
+    return (value);
+}
+
+static void histogram_record(struct ping_probe_t *self_p,
+                             uint32_t value)
+{
+    if ((self_p->histogram.received == 0)
+        || (value < self_p->histogram.min_us)) {
+        self_p->histogram.min_us = value;
+    }
+
+    if (value > self_p->histogram.max_us) {
+        self_p->histogram.max_us = value;
+    }
+
+    self_p->histogram.buckets[histogram_index(value)]++;
+    self_p->histogram.received++;
+
+#if CONFIG_PING_PROBE_COUNTERS == 1
+    fs_counter_increment(&module.probe_received, 1);
+#endif
+}
+
+/**
+ * Returns given time in microseconds, or zero if negative.
+ */
+static uint32_t time_to_us(struct time_t *time_p)
+{
+    if ((time_p->seconds < 0) || (time_p->nanoseconds < 0)) {
+        return (0);
+    }
+
+    return (time_p->seconds * 1000000UL + time_p->nanoseconds / 1000);
+}
+
+static int probe_send(struct ping_probe_t *self_p,
+                      struct socket_t *socket_p,
+                      struct ping_probe_request_t *request_p,
+                      struct time_t *now_p)
+{
+    struct echo_header_t request;
+    struct inet_addr_t address;
+
+    address.ip = self_p->address;
+    address.port = 0;
+
+    request.type = ECHO_REQUEST;
+    request.code = 0;
+    request.checksum = 0;
+    request.id = htons(self_p->id);
+    request.seqno = htons(self_p->seqno);
+    request.checksum = htons(inet_checksum(&request, sizeof(request)));
+
+    if (socket_sendto(socket_p,
+                      &request,
+                      sizeof(request),
+                      0,
+                      &address) != sizeof(request)) {
+        return (-EIO);
+    }
+
+    request_p->outstanding = 1;
+    request_p->seqno = self_p->seqno;
+    request_p->sent_at = *now_p;
+    self_p->seqno++;
+    self_p->histogram.sent++;
+
+#if CONFIG_PING_PROBE_COUNTERS == 1
+    fs_counter_increment(&module.probe_sent, 1);
+#endif
+
+    return (0);
+}
+
+/**
+ * Read one packet from given socket and match it with an outstanding
+ * echo request.
+ */
+static void probe_receive(struct ping_probe_t *self_p,
+                          struct socket_t *socket_p)
+{
+    struct echo_header_t *reply_p;
+    struct ping_probe_request_t *request_p;
+    struct inet_addr_t address;
+    struct time_t now, round_trip_time;
+    uint8_t reply[28]; /* IP header and icmp packet. */
+    uint16_t seqno;
+    int i;
+
+    time_get(&now);
+
+    if (socket_recvfrom(socket_p,
+                        &reply,
+                        sizeof(reply),
+                        0,
+                        &address) != sizeof(reply)) {
+        return;
+    }
+
+    reply_p = (struct echo_header_t *)&reply[20];
+
+    /* Packets for all raw sockets with ICMP are received, so replies
+       to other pings are silently dropped. */
+    if ((reply_p->type != ECHO_REPLY)
+        || (reply_p->code != 0)
+        || (ntohs(reply_p->id) != self_p->id)
+        || (inet_checksum(reply_p, sizeof(*reply_p)) != 0)) {
+        return;
+    }
+
+    seqno = ntohs(reply_p->seqno);
+
+    for (i = 0; i < membersof(self_p->requests); i++) {
+        request_p = &self_p->requests[i];
+
+        if ((request_p->outstanding == 1) && (request_p->seqno == seqno)) {
+            request_p->outstanding = 0;
+            time_subtract(&round_trip_time, &now, &request_p->sent_at);
+            histogram_record(self_p, time_to_us(&round_trip_time));
+
+            return;
+        }
+    }
+
+    self_p->histogram.unexpected++;
+}
+
+/**
+ * Count outstanding echo requests sent at or before given time as
+ * lost.
+ */
+static void probe_expire(struct ping_probe_t *self_p,
+                         struct time_t *sent_before_p)
+{
+    struct ping_probe_request_t *request_p;
+    int i;
+
+    for (i = 0; i < membersof(self_p->requests); i++) {
+        request_p = &self_p->requests[i];
+
+        if (request_p->outstanding == 0) {
+            continue;
+        }
+
+        if (time_compare(&request_p->sent_at,
+                         sent_before_p) != time_compare_greater_than_t) {
+            request_p->outstanding = 0;
+            self_p->histogram.lost++;
+
+#if CONFIG_PING_PROBE_COUNTERS == 1
+            fs_counter_increment(&module.probe_lost, 1);
+#endif
+        }
+    }
+}
+
+/**
+ * Returns a free request slot, or NULL if all are outstanding. The
+ * oldest outstanding request is stored in given pointer.
+ */
+static struct ping_probe_request_t *probe_find_free(
+    struct ping_probe_t *self_p,
+    struct ping_probe_request_t **oldest_pp)
+{
+    struct ping_probe_request_t *request_p;
+    struct ping_probe_request_t *free_p;
+    int i;
+
+    free_p = NULL;
+    *oldest_pp = NULL;
+
+    for (i = 0; i < membersof(self_p->requests); i++) {
+        request_p = &self_p->requests[i];
+
+        if (request_p->outstanding == 0) {
+            free_p = request_p;
+        } else if ((*oldest_pp == NULL)
+                   || (time_compare(&request_p->sent_at,
+                                    &(*oldest_pp)->sent_at)
+                       == time_compare_less_than_t)) {
+            *oldest_pp = request_p;
+        }
+    }
+
+    return (free_p);
+}
+
 #if CONFIG_PING_FS_COMMAND_PING == 1
 
 static int cmd_ping_cb(int argc,
@@ -98,6 +373,78 @@ static int cmd_ping_cb(int argc,
 
 #endif
 
+#if CONFIG_PING_FS_COMMAND_PROBE == 1
+
+static int cmd_probe_cb(int argc,
+                        const char *argv[],
+                        void *out_p,
+                        void *in_p,
+                        void *arg_p,
+                        void *call_arg_p)
+{
+    long count;
+    long interval_ms;
+    struct inet_ip_addr_t address;
+    struct time_t interval, timeout;
+    struct ping_probe_stats_t stats;
+    const char *remote_host_p;
+
+    if (argc != 4) {
+        std_fprintf(out_p,
+                    OSTR("Usage: probe <remote host> <count> "
+                         "<interval ms>\r\n"));
+        return (-1);
+    }
+
+    remote_host_p = argv[1];
+
+    if (inet_aton(remote_host_p, &address) != 0) {
+        std_fprintf(out_p, OSTR("Bad ip address '%s'.\r\n"), remote_host_p);
+        return (-1);
+    }
+
+    if ((std_strtol(argv[2], &count) == NULL) || (count < 0)) {
+        std_fprintf(out_p, OSTR("Bad count '%s'.\r\n"), argv[2]);
+        return (-1);
+    }
+
+    if ((std_strtol(argv[3], &interval_ms) == NULL) || (interval_ms < 0)) {
+        std_fprintf(out_p, OSTR("Bad interval '%s'.\r\n"), argv[3]);
+        return (-1);
+    }
+
+    interval.seconds = (interval_ms / 1000);
+    interval.nanoseconds = ((interval_ms % 1000) * 1000000);
+    timeout.seconds = 3;
+    timeout.nanoseconds = 0;
+
+    ping_probe_init(&module.probe, &address, &interval, &timeout);
+
+    if (ping_probe_run(&module.probe, count) != 0) {
+        std_fprintf(out_p, OSTR("Failed to probe '%s'.\r\n"), remote_host_p);
+        return (-1);
+    }
+
+    ping_probe_get_stats(&module.probe, &stats);
+
+    std_fprintf(out_p,
+                OSTR("SENT  RECEIVED  LOST  UNEXPECTED  "
+                     "MIN(us)  P50(us)  P99(us)  MAX(us)\r\n"
+                     "%4lu  %8lu  %4lu  %10lu  %7lu  %7lu  %7lu  %7lu\r\n"),
+                (unsigned long)stats.sent,
+                (unsigned long)stats.received,
+                (unsigned long)stats.lost,
+                (unsigned long)stats.unexpected,
+                (unsigned long)stats.min_us,
+                (unsigned long)stats.p50_us,
+                (unsigned long)stats.p99_us,
+                (unsigned long)stats.max_us);
+
+    return (0);
+}
+
+#endif
+
 int ping_module_init(void)
 {
     /* Return immediately if the module is already initialized. */
@@ -115,6 +462,31 @@ int ping_module_init(void)
     fs_command_register(&module.cmd_ping);
 #endif
 
+#if CONFIG_PING_FS_COMMAND_PROBE == 1
+    fs_command_init(&module.cmd_probe,
+                    CSTR("/inet/ping/probe"),
+                    cmd_probe_cb,
+                    NULL);
+    fs_command_register(&module.cmd_probe);
+#endif
+
+#if CONFIG_PING_PROBE_COUNTERS == 1
+    fs_counter_init(&module.probe_sent,
+                    CSTR("/inet/ping/probe/sent"),
+                    0);
+    fs_counter_register(&module.probe_sent);
+
+    fs_counter_init(&module.probe_received,
+                    CSTR("/inet/ping/probe/received"),
+                    0);
+    fs_counter_register(&module.probe_received);
+
+    fs_counter_init(&module.probe_lost,
+                    CSTR("/inet/ping/probe/lost"),
+                    0);
+    fs_counter_register(&module.probe_lost);
+#endif
+
     return (socket_module_init());
 }
 
@@ -214,3 +586,141 @@ int ping_host_by_ip_address(struct inet_ip_addr_t *address_p,
 
     return (res);
 }
+
+int ping_probe_init(struct ping_probe_t *self_p,
+                    struct inet_ip_addr_t *address_p,
+                    struct time_t *interval_p,
+                    struct time_t *timeout_p)
+{
+    ASSERTN(self_p != NULL, EINVAL);
+    ASSERTN(address_p != NULL, EINVAL);
+    ASSERTN(interval_p != NULL, EINVAL);
+    ASSERTN(timeout_p != NULL, EINVAL);
+
+    self_p->address = *address_p;
+    self_p->interval = *interval_p;
+    self_p->timeout = *timeout_p;
+    self_p->id = module.ping_id++;
+    self_p->seqno = 0;
+    memset(&self_p->requests[0], 0, sizeof(self_p->requests));
+
+    return (ping_probe_reset(self_p));
+}
+
+int ping_probe_run(struct ping_probe_t *self_p, int count)
+{
+    ASSERTN(self_p != NULL, EINVAL);
+    ASSERTN(count >= 0, EINVAL);
+
+    int res;
+    struct socket_t socket;
+    struct ping_probe_request_t *free_p;
+    struct ping_probe_request_t *oldest_p;
+    struct time_t now, send_at, expire_at, deadline, sent_before, timeout;
+
+    if (socket_open_raw(&socket) != 0) {
+        return (-EIO);
+    }
+
+    res = 0;
+    time_get(&send_at);
+
+    while (1) {
+        time_get(&now);
+        time_subtract(&sent_before, &now, &self_p->timeout);
+        probe_expire(self_p, &sent_before);
+        free_p = probe_find_free(self_p, &oldest_p);
+
+        if ((count == 0) && (oldest_p == NULL)) {
+            break;
+        }
+
+        /* Send the next request if it is due and there is room for
+           it. A late request is sent immediately, but the following
+           requests are not sent in a burst to catch up. */
+        if ((count > 0) && (free_p != NULL)) {
+            if (time_compare(&now, &send_at) != time_compare_less_than_t) {
+                res = probe_send(self_p, &socket, free_p, &now);
+
+                if (res != 0) {
+                    break;
+                }
+
+                count--;
+                time_add(&send_at, &send_at, &self_p->interval);
+
+                if (time_compare(&send_at, &now) == time_compare_less_than_t) {
+                    send_at = now;
+                }
+
+                continue;
+            }
+
+            deadline = send_at;
+        } else {
+            deadline.seconds = 0x7fffffff;
+            deadline.nanoseconds = 0;
+        }
+
+        if (oldest_p != NULL) {
+            time_add(&expire_at, &oldest_p->sent_at, &self_p->timeout);
+
+            if (time_compare(&expire_at,
+                             &deadline) == time_compare_less_than_t) {
+                deadline = expire_at;
+            }
+        }
+
+        /* Wait for a reply until the next request is due or the
+           oldest outstanding request times out. */
+        time_subtract(&timeout, &deadline, &now);
+
+        if ((timeout.seconds < 0) || (timeout.nanoseconds < 0)) {
+            timeout.seconds = 0;
+            timeout.nanoseconds = 0;
+        }
+
+        if (chan_poll(&socket, &timeout) != NULL) {
+            probe_receive(self_p, &socket);
+        }
+    }
+
+    socket_close(&socket);
+
+    return (res);
+}
+
+int ping_probe_get_stats(struct ping_probe_t *self_p,
+                         struct ping_probe_stats_t *stats_p)
+{
+    ASSERTN(self_p != NULL, EINVAL);
+    ASSERTN(stats_p != NULL, EINVAL);
+
+    stats_p->sent = self_p->histogram.sent;
+    stats_p->received = self_p->histogram.received;
+    stats_p->lost = self_p->histogram.lost;
+    stats_p->unexpected = self_p->histogram.unexpected;
+
+    if (self_p->histogram.received > 0) {
+        stats_p->min_us = self_p->histogram.min_us;
+        stats_p->p50_us = histogram_percentile(self_p, 500);
+        stats_p->p99_us = histogram_percentile(self_p, 990);
+        stats_p->max_us = self_p->histogram.max_us;
+    } else {
+        stats_p->min_us = 0;
+        stats_p->p50_us = 0;
+        stats_p->p99_us = 0;
+        stats_p->max_us = 0;
+    }
+
+    return (0);
+}
+
+int ping_probe_reset(struct ping_probe_t *self_p)
+{
+    ASSERTN(self_p != NULL, EINVAL);
+
+    memset(&self_p->histogram, 0, sizeof(self_p->histogram));
+
+    return (0);
+}
@@ -31,6 +31,58 @@
 
 #include "simba.h"
 
+/**
+ * Number of buckets in the probe latency histogram. Round trip times
+ * below 8 us get one bucket each, and every power of two above that
+ * is split into 8 buckets, so a recorded time is within 12.5% of the
+ * actual time. Times of 2^24 us (about 16 s) and above are recorded
+ * in the last bucket.
+ */
+#define PING_PROBE_HISTOGRAM_LENGTH                           176
+
+/**
+ * Probe statistics. All times are in microseconds, and are zero if
+ * no reply has been received.
+ */
+struct ping_probe_stats_t {
+    /** Number of sent echo request packets. */
+    uint32_t sent;
+    /** Number of matched echo reply packets. */
+    uint32_t received;
+    /** Number of echo requests without reply within the timeout. */
+    uint32_t lost;
+    /** Number of duplicated, late or unknown echo replies. */
+    uint32_t unexpected;
+    uint32_t min_us;
+    uint32_t p50_us;
+    uint32_t p99_us;
+    uint32_t max_us;
+};
+
+struct ping_probe_request_t {
+    int8_t outstanding;
+    uint16_t seqno;
+    struct time_t sent_at;
+};
+
+struct ping_probe_t {
+    struct inet_ip_addr_t address;
+    struct time_t interval;
+    struct time_t timeout;
+    uint16_t id;
+    uint16_t seqno;
+    struct ping_probe_request_t requests[CONFIG_PING_PROBE_OUTSTANDING_MAX];
+    struct {
+        uint32_t sent;
+        uint32_t received;
+        uint32_t lost;
+        uint32_t unexpected;
+        uint32_t min_us;
+        uint32_t max_us;
+        uint32_t buckets[PING_PROBE_HISTOGRAM_LENGTH];
+    } histogram;
+};
+
 /**
  * Initialize the ping module. This function must be called before
  * calling any other function in this module.
@@ -61,4 +113,58 @@ int ping_host_by_ip_address(struct inet_ip_addr_t *address_p,
                             struct time_t *timeout_p,
                             struct time_t *round_trip_time_p);
 
+/**
+ * Initialize given probe. A probe sends echo request packets to given
+ * host at a fixed rate, with up to
+ * ``CONFIG_PING_PROBE_OUTSTANDING_MAX`` requests waiting for a reply
+ * at a time, and records the round trip times in a latency
+ * histogram.
+ *
+ * @param[in] self_p Probe to initialize.
+ * @param[in] address_p IP address of the host to probe.
+ * @param[in] interval_p Time between echo requests. A zero interval
+ *                       sends a new request as soon as there is room
+ *                       for it.
+ * @param[in] timeout_p Time to wait for an echo reply before the
+ *                      request is counted as lost.
+ *
+ * @return zero(0) or negative error code.
+ */
+int ping_probe_init(struct ping_probe_t *self_p,
+                    struct inet_ip_addr_t *address_p,
+                    struct time_t *interval_p,
+                    struct time_t *timeout_p);
+
+/**
+ * Send given number of echo requests and wait for their replies or
+ * timeouts. The results are added to the probe statistics, so
+ * consecutive calls measure continuously.
+ *
+ * @param[in] self_p Probe to run.
+ * @param[in] count Number of echo requests to send.
+ *
+ * @return zero(0) or negative error code.
+ */
+int ping_probe_run(struct ping_probe_t *self_p, int count);
+
+/**
+ * Get the statistics of given probe.
+ *
+ * @param[in] self_p Probe to get the statistics of.
+ * @param[out] stats_p Probe statistics.
+ *
+ * @return zero(0) or negative error code.
+ */
+int ping_probe_get_stats(struct ping_probe_t *self_p,
+                         struct ping_probe_stats_t *stats_p);
+
+/**
+ * Clear the statistics of given probe.
+ *
+ * @param[in] self_p Probe to reset.
+ *
+ * @return zero(0) or negative error code.
+ */
+int ping_probe_reset(struct ping_probe_t *self_p);
+
 #endif
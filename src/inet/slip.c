@@ -34,40 +34,64 @@
 #define SLIP_ESC_END      0xdc
 #define SLIP_ESC_ESC      0xdd
 
+/**
+ * Returns the number of bytes in given buffer before the first END or
+ * ESC byte, that is, the number of bytes that are not escaped.
+ */
+static size_t span_length(const uint8_t *buf_p, size_t size)
+{
+    size_t i;
+
+    for (i = 0; i < size; i++) {
+        if ((buf_p[i] == SLIP_END) || (buf_p[i] == SLIP_ESC)) {
+            break;
+        }
+    }
+
+    return (i);
+}
+
 static ssize_t packet_write(void *chan_p,
                             const void *buf_p,
                             size_t size)
 {
     struct slip_t *self_p;
-    int i;
+    size_t left;
+    size_t n;
     uint8_t data;
+    uint8_t escape[2];
     const uint8_t *b_p;
 
     self_p = container_of(chan_p, struct slip_t, chout);
     b_p = buf_p;
+    left = size;
 
     data = SLIP_END;
     chan_write(self_p->chout_p, &data, 1);
 
-    for (i = 0; i < size; i++) {
-        data = b_p[i];
+    while (left > 0) {
+        /* Write bytes that are not escaped in one go. */
+        n = span_length(b_p, left);
 
-        switch (data) {
+        if (n > 0) {
+            chan_write(self_p->chout_p, b_p, n);
+            b_p += n;
+            left -= n;
+        }
 
-        case SLIP_END:
-            data = SLIP_ESC;
-            chan_write(self_p->chout_p, &data, 1);
-            data = SLIP_ESC_END;
-            break;
+        if (left > 0) {
+            escape[0] = SLIP_ESC;
 
-        case SLIP_ESC:
-            data = SLIP_ESC;
-            chan_write(self_p->chout_p, &data, 1);
-            data = SLIP_ESC_ESC;
-            break;
-        }
+            if (*b_p == SLIP_END) {
+                escape[1] = SLIP_ESC_END;
+            } else {
+                escape[1] = SLIP_ESC_ESC;
+            }
 
-        chan_write(self_p->chout_p, &data, 1);
+            chan_write(self_p->chout_p, &escape[0], sizeof(escape));
+            b_p++;
+            left--;
+        }
     }
 
     data = SLIP_END;
@@ -152,6 +176,56 @@ ssize_t slip_input(struct slip_t *self_p,
     return (res);
 }
 
+ssize_t slip_input_buffer(struct slip_t *self_p,
+                          const uint8_t *buf_p,
+                          size_t size,
+                          size_t *consumed_p)
+{
+    ASSERTN(self_p != NULL, EINVAL);
+    ASSERTN(buf_p != NULL, EINVAL);
+    ASSERTN(consumed_p != NULL, EINVAL);
+
+    const uint8_t *b_p;
+    ssize_t res;
+    size_t n;
+    size_t m;
+
+    b_p = buf_p;
+    res = 0;
+
+    while (size > 0) {
+        if ((self_p->rx.is_escaped == 1)
+            || (*b_p == SLIP_END)
+            || (*b_p == SLIP_ESC)) {
+            res = slip_input(self_p, *b_p);
+            b_p++;
+            size--;
+
+            if (res != 0) {
+                break;
+            }
+        } else {
+            /* Copy bytes that are not escaped in one go, truncating
+               long packets. */
+            n = span_length(b_p, size);
+            m = MIN(n, self_p->rx.size - self_p->rx.pos);
+            memcpy(&self_p->rx.buf_p[self_p->rx.pos], b_p, m);
+            self_p->rx.pos += m;
+            b_p += n;
+            size -= n;
+
+            if (m < n) {
+                res = -1;
+                break;
+            }
+        }
+    }
+
+    *consumed_p = (b_p - buf_p);
+
+    return (res);
+}
+
 void *slip_get_output_channel(struct slip_t *self_p)
 {
     ASSERTNRN(self_p != NULL, EINVAL);
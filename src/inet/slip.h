@@ -64,6 +64,27 @@ int slip_init(struct slip_t *self_p,
 ssize_t slip_input(struct slip_t *self_p,
                    uint8_t data);
 
+/**
+ * Input data bytes into the slip parser. Bytes that are not escaped
+ * are copied to the frame buffer in bulk, which is much faster than
+ * calling slip_input() for each byte. Input stops after a complete
+ * frame or an error, so call this function again with the remaining
+ * bytes until all are consumed.
+ *
+ * @param[in] self_p Slip object.
+ * @param[in] buf_p Data bytes to input.
+ * @param[in] size Number of bytes to input.
+ * @param[out] consumed_p Number of input bytes consumed.
+ *
+ * @return Once a complete SLIP frame has been received the size of
+ *         the frame is returned. Meanwhile, zero(0) or negative error
+ *         code is returned.
+ */
+ssize_t slip_input_buffer(struct slip_t *self_p,
+                          const uint8_t *buf_p,
+                          size_t size,
+                          size_t *consumed_p);
+
 /**
  * Get the output channel for given slip object.
  *
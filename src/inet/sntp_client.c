@@ -0,0 +1,420 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2014-2018, Erik Moqvist
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use, copy,
+ * modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ * This file is part of the Simba project.
+ */
+
+#include "simba.h"
+
+/* Seconds from 1900 (NTP) to 1970 (Unix). */
+#define NTP_UNIX_OFFSET                         2208988800UL
+
+#define PACKET_SIZE                                       48
+
+/* Leap indicator 0, version 4 and mode 3 (client). */
+#define REQUEST_HEADER                                  0x23
+
+#define STEP_THRESHOLD_US (1000L * CONFIG_SNTP_CLIENT_STEP_THRESHOLD_MS)
+
+#define MODE_SERVER                                        4
+#define LEAP_INDICATOR_UNSYNCHRONIZED                      3
+
+/* Timestamp offsets in the packet. */
+#define ORIGINATE_TIMESTAMP                               24
+#define RECEIVE_TIMESTAMP                                 32
+#define TRANSMIT_TIMESTAMP                                40
+
+struct module_t {
+    int8_t initialized;
+    struct fs_counter_t requests;
+    struct fs_counter_t timeouts;
+    struct fs_counter_t bad_responses;
+    struct fs_counter_t steps;
+    struct fs_counter_t slews;
+};
+
+static struct module_t module;
+
+static void timestamp_pack(uint8_t *buf_p, struct time_t *time_p)
+{
+    uint32_t seconds;
+    uint32_t fraction;
+
+    seconds = (time_p->seconds + NTP_UNIX_OFFSET);
+    fraction = ((((uint64_t)time_p->nanoseconds) << 32) / 1000000000UL);
+
+    buf_p[0] = (seconds >> 24);
+    buf_p[1] = (seconds >> 16);
+    buf_p[2] = (seconds >> 8);
+    buf_p[3] = seconds;
+    buf_p[4] = (fraction >> 24);
+    buf_p[5] = (fraction >> 16);
+    buf_p[6] = (fraction >> 8);
+    buf_p[7] = fraction;
+}
+
+static void timestamp_unpack(struct time_t *time_p, const uint8_t *buf_p)
+{
+    uint32_t seconds;
+    uint32_t fraction;
+
+    seconds = (((uint32_t)buf_p[0] << 24)
+               | ((uint32_t)buf_p[1] << 16)
+               | ((uint32_t)buf_p[2] << 8)
+               | buf_p[3]);
+    fraction = (((uint32_t)buf_p[4] << 24)
+                | ((uint32_t)buf_p[5] << 16)
+                | ((uint32_t)buf_p[6] << 8)
+                | buf_p[7]);
+
+    time_p->seconds = (seconds - NTP_UNIX_OFFSET);
+    time_p->nanoseconds = ((fraction * 1000000000ULL) >> 32);
+}
+
+static int is_timestamp_zero(const uint8_t *buf_p)
+{
+    int i;
+
+    for (i = 0; i < 8; i++) {
+        if (buf_p[i] != 0) {
+            return (0);
+        }
+    }
+
+    return (1);
+}
+
+/**
+ * Returns given time in microseconds, or a value larger than any
+ * step threshold if it does not fit in a long.
+ */
+static long time_to_microseconds(struct time_t *time_p)
+{
+    if (time_p->seconds > 2000) {
+        return (2000000000L);
+    } else if (time_p->seconds < -2000) {
+        return (-2000000000L);
+    }
+
+    return (1000000L * time_p->seconds + time_p->nanoseconds / 1000);
+}
+
+static long absolute(long value)
+{
+    if (value < 0) {
+        return (-value);
+    }
+
+    return (value);
+}
+
+static void increase_poll_interval(struct sntp_client_t *self_p)
+{
+    self_p->poll_interval *= 2;
+
+    if (self_p->poll_interval > CONFIG_SNTP_CLIENT_POLL_INTERVAL_MAX) {
+        self_p->poll_interval = CONFIG_SNTP_CLIENT_POLL_INTERVAL_MAX;
+    }
+}
+
+static void decrease_poll_interval(struct sntp_client_t *self_p)
+{
+    self_p->poll_interval /= 2;
+
+    if (self_p->poll_interval < CONFIG_SNTP_CLIENT_POLL_INTERVAL_MIN) {
+        self_p->poll_interval = CONFIG_SNTP_CLIENT_POLL_INTERVAL_MIN;
+    }
+}
+
+/**
+ * Wait for the response to given request. Returns the size of the
+ * response or negative error code.
+ */
+static ssize_t exchange(struct sntp_client_t *self_p,
+                        struct socket_t *socket_p,
+                        uint8_t *request_p,
+                        uint8_t *response_p,
+                        struct time_t *timeout_p,
+                        struct time_t *request_time_p,
+                        struct time_t *response_time_p)
+{
+    ssize_t size;
+    struct time_t elapsed;
+    struct time_t timeout;
+    struct inet_addr_t address;
+
+    timeout = *timeout_p;
+    time_get(request_time_p);
+    timestamp_pack(&request_p[TRANSMIT_TIMESTAMP], request_time_p);
+
+    if (socket_sendto(socket_p,
+                      request_p,
+                      PACKET_SIZE,
+                      0,
+                      &self_p->server) != PACKET_SIZE) {
+        return (-EIO);
+    }
+
+    fs_counter_increment(&module.requests, 1);
+
+    while (1) {
+        if (chan_poll(socket_p, &timeout) == NULL) {
+            fs_counter_increment(&module.timeouts, 1);
+
+            return (-ETIMEDOUT);
+        }
+
+        size = socket_recvfrom(socket_p,
+                               response_p,
+                               PACKET_SIZE,
+                               0,
+                               &address);
+        time_get(response_time_p);
+
+        /* Decrement the timeout by the elapsed time waiting for a
+           packet. */
+        time_subtract(&elapsed, response_time_p, request_time_p);
+        time_subtract(&timeout, timeout_p, &elapsed);
+
+        if ((timeout.seconds < 0) || (timeout.nanoseconds < 0)) {
+            timeout.seconds = 0;
+            timeout.nanoseconds = 0;
+        }
+
+        /* Drop packets not responding to this request. */
+        if ((size != PACKET_SIZE)
+            || (address.ip.number != self_p->server.ip.number)
+            || (address.port != self_p->server.port)
+            || (memcmp(&response_p[ORIGINATE_TIMESTAMP],
+                       &request_p[TRANSMIT_TIMESTAMP],
+                       8) != 0)) {
+            fs_counter_increment(&module.bad_responses, 1);
+            continue;
+        }
+
+        return (size);
+    }
+}
+
+/**
+ * Correct the system time by given offset.
+ */
+static void discipline(struct sntp_client_t *self_p,
+                       struct time_t *offset_p)
+{
+    long offset;
+    long previous;
+    long difference;
+    struct time_t now;
+
+    offset = time_to_microseconds(offset_p);
+
+    previous = time_to_microseconds(&self_p->offset);
+
+    /* Steps are not part of the jitter. */
+    if ((self_p->synchronized == 1)
+        && (absolute(previous) <= STEP_THRESHOLD_US)
+        && (absolute(offset) <= STEP_THRESHOLD_US)) {
+        difference = absolute(offset - previous);
+
+        /* Exponential average with weight 1/4, as in RFC 5905. */
+        self_p->jitter += ((difference - self_p->jitter) / 4);
+    }
+
+    self_p->offset = *offset_p;
+
+    if (absolute(offset) > STEP_THRESHOLD_US) {
+        time_get(&now);
+        time_add(&now, &now, offset_p);
+        time_set(&now);
+        fs_counter_increment(&module.steps, 1);
+        self_p->poll_interval = CONFIG_SNTP_CLIENT_POLL_INTERVAL_MIN;
+    } else {
+#if CONFIG_TIME_ADJUST == 1
+        time_adjust(offset);
+#else
+        time_get(&now);
+        time_add(&now, &now, offset_p);
+        time_set(&now);
+#endif
+        fs_counter_increment(&module.slews, 1);
+
+        if (absolute(offset)
+            < 1000L * CONFIG_SNTP_CLIENT_POLL_OFFSET_THRESHOLD_MS) {
+            increase_poll_interval(self_p);
+        } else {
+            decrease_poll_interval(self_p);
+        }
+    }
+
+    self_p->synchronized = 1;
+}
+
+int sntp_client_module_init(void)
+{
+    /* Return immediately if the module is already initialized. */
+    if (module.initialized == 1) {
+        return (0);
+    }
+
+    module.initialized = 1;
+
+    fs_counter_init(&module.requests,
+                    FSTR("/inet/sntp_client/requests"),
+                    0);
+    fs_counter_register(&module.requests);
+
+    fs_counter_init(&module.timeouts,
+                    FSTR("/inet/sntp_client/timeouts"),
+                    0);
+    fs_counter_register(&module.timeouts);
+
+    fs_counter_init(&module.bad_responses,
+                    FSTR("/inet/sntp_client/bad_responses"),
+                    0);
+    fs_counter_register(&module.bad_responses);
+
+    fs_counter_init(&module.steps,
+                    FSTR("/inet/sntp_client/steps"),
+                    0);
+    fs_counter_register(&module.steps);
+
+    fs_counter_init(&module.slews,
+                    FSTR("/inet/sntp_client/slews"),
+                    0);
+    fs_counter_register(&module.slews);
+
+    return (socket_module_init());
+}
+
+int sntp_client_init(struct sntp_client_t *self_p,
+                     struct inet_addr_t *server_p)
+{
+    ASSERTN(self_p != NULL, EINVAL);
+    ASSERTN(server_p != NULL, EINVAL);
+
+    self_p->server = *server_p;
+    self_p->poll_interval = CONFIG_SNTP_CLIENT_POLL_INTERVAL_MIN;
+    self_p->offset.seconds = 0;
+    self_p->offset.nanoseconds = 0;
+    self_p->delay = 0;
+    self_p->jitter = 0;
+    self_p->synchronized = 0;
+
+    return (0);
+}
+
+int sntp_client_sync(struct sntp_client_t *self_p,
+                     struct time_t *timeout_p)
+{
+    ASSERTN(self_p != NULL, EINVAL);
+    ASSERTN(timeout_p != NULL, EINVAL);
+
+    ssize_t res;
+    struct socket_t socket;
+    uint8_t request[PACKET_SIZE];
+    uint8_t response[PACKET_SIZE];
+    struct time_t t1, t2, t3, t4;
+    struct time_t offset, delay, server_delay;
+
+    memset(&request[0], 0, sizeof(request));
+    request[0] = REQUEST_HEADER;
+
+    if (socket_open_udp(&socket) != 0) {
+        return (-1);
+    }
+
+    res = exchange(self_p,
+                   &socket,
+                   &request[0],
+                   &response[0],
+                   timeout_p,
+                   &t1,
+                   &t4);
+    socket_close(&socket);
+
+    if (res < 0) {
+        increase_poll_interval(self_p);
+
+        return (res);
+    }
+
+    /* Reject unsynchronized servers and kiss-of-death packets
+       (stratum 0), and back off. */
+    if (((response[0] & 0x7) != MODE_SERVER)
+        || ((response[0] >> 6) == LEAP_INDICATOR_UNSYNCHRONIZED)
+        || (response[1] == 0)
+        || is_timestamp_zero(&response[TRANSMIT_TIMESTAMP])) {
+        fs_counter_increment(&module.bad_responses, 1);
+        self_p->poll_interval = CONFIG_SNTP_CLIENT_POLL_INTERVAL_MAX;
+
+        return (-EPROTO);
+    }
+
+    timestamp_unpack(&t2, &response[RECEIVE_TIMESTAMP]);
+    timestamp_unpack(&t3, &response[TRANSMIT_TIMESTAMP]);
+
+    /* offset = ((t2 - t1) + (t3 - t4)) / 2 */
+    time_subtract(&offset, &t2, &t1);
+    time_subtract(&delay, &t3, &t4);
+    time_add(&offset, &offset, &delay);
+    offset.nanoseconds = (offset.nanoseconds / 2
+                          + (offset.seconds % 2) * 500000000L);
+    offset.seconds /= 2;
+
+    /* delay = (t4 - t1) - (t3 - t2) */
+    time_subtract(&delay, &t4, &t1);
+    time_subtract(&server_delay, &t3, &t2);
+    time_subtract(&delay, &delay, &server_delay);
+    self_p->delay = time_to_microseconds(&delay);
+
+    discipline(self_p, &offset);
+
+    return (0);
+}
+
+int sntp_client_get_poll_interval(struct sntp_client_t *self_p)
+{
+    ASSERTN(self_p != NULL, EINVAL);
+
+    return (self_p->poll_interval);
+}
+
+void *sntp_client_main(void *arg_p)
+{
+    struct sntp_client_t *self_p;
+    struct time_t timeout;
+
+    self_p = arg_p;
+    timeout.seconds = CONFIG_SNTP_CLIENT_TIMEOUT_MS / 1000;
+    timeout.nanoseconds = 1000000L * (CONFIG_SNTP_CLIENT_TIMEOUT_MS % 1000);
+
+    while (1) {
+        sntp_client_sync(self_p, &timeout);
+        thrd_sleep(self_p->poll_interval);
+    }
+
+    return (NULL);
+}
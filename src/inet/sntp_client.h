@@ -0,0 +1,116 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2014-2018, Erik Moqvist
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use, copy,
+ * modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ * This file is part of the Simba project.
+ */
+
+#ifndef __INET_SNTP_CLIENT_H__
+#define __INET_SNTP_CLIENT_H__
+
+#include "simba.h"
+
+/**
+ * An SNTP client disciplining the system time.
+ */
+struct sntp_client_t {
+    struct inet_addr_t server;
+    /** Poll interval in seconds. */
+    int poll_interval;
+    /** Clock offset of the last synchronization, the time to add to
+        the system time to get the server time. */
+    struct time_t offset;
+    /** Round trip delay of the last synchronization in
+        microseconds. */
+    long delay;
+    /** Smoothed difference between consecutive offsets in
+        microseconds. */
+    long jitter;
+    int8_t synchronized;
+};
+
+/**
+ * Initialize the SNTP client module. This function must be called
+ * before calling any other function in this module.
+ *
+ * The module will only be initialized once even if this function is
+ * called multiple times.
+ *
+ * @return zero(0) or negative error code.
+ */
+int sntp_client_module_init(void);
+
+/**
+ * Initialize given SNTP client.
+ *
+ * @param[in] self_p SNTP client to initialize.
+ * @param[in] server_p Address of the NTP server. Usually port 123.
+ *
+ * @return zero(0) or negative error code.
+ */
+int sntp_client_init(struct sntp_client_t *self_p,
+                     struct inet_addr_t *server_p);
+
+/**
+ * Request the time from the server and discipline the system time
+ * with the measured offset. Offsets larger than
+ * ``CONFIG_SNTP_CLIENT_STEP_THRESHOLD_MS`` are corrected at once with
+ * `time_set()`, smaller offsets gradually with `time_adjust()` so the
+ * time never jumps.
+ *
+ * The poll interval is doubled, up to
+ * ``CONFIG_SNTP_CLIENT_POLL_INTERVAL_MAX``, when the offset is below
+ * ``CONFIG_SNTP_CLIENT_POLL_OFFSET_THRESHOLD_MS`` or the request
+ * failed, halved when the offset is above that threshold, and set to
+ * ``CONFIG_SNTP_CLIENT_POLL_INTERVAL_MIN`` when the time was stepped.
+ *
+ * @param[in] self_p SNTP client.
+ * @param[in] timeout_p Time to wait for the response.
+ *
+ * @return zero(0) or negative error code.
+ */
+int sntp_client_sync(struct sntp_client_t *self_p,
+                     struct time_t *timeout_p);
+
+/**
+ * Get the current poll interval, the number of seconds to wait
+ * before the next call to `sntp_client_sync()`.
+ *
+ * @param[in] self_p SNTP client.
+ *
+ * @return Poll interval in seconds.
+ */
+int sntp_client_get_poll_interval(struct sntp_client_t *self_p);
+
+/**
+ * SNTP client thread. Calls `sntp_client_sync()` forever, sleeping
+ * the poll interval in between.
+ *
+ * @param[in] arg_p SNTP client.
+ *
+ * @return Never returns.
+ */
+void *sntp_client_main(void *arg_p);
+
+#endif
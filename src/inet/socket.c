@@ -34,6 +34,216 @@
 #define STATE_SENDTO           3
 #define STATE_CONNECT          4
 #define STATE_CLOSED           5
+#define STATE_RECV_PBUF        6
+#define STATE_CONNECTING       7
+
+struct dns_cache_entry_t {
+    char hostname[CONFIG_SOCKET_DNS_CACHE_HOSTNAME_MAX];
+    struct inet_ip_addr_t ip;
+    /* Zero(0) for resolved hostnames, or the negative error code of
+       the failed lookup. */
+    int res;
+    /* Uptime in seconds when the entry expires. */
+    uint32_t expires;
+};
+
+struct dns_cache_t {
+    int8_t initialized;
+    struct sem_t sem;
+    struct dns_cache_entry_t entries[CONFIG_SOCKET_DNS_CACHE_MAX];
+#if CONFIG_SOCKET_FS_COMMAND_DNS_CACHE_LIST == 1
+    struct fs_command_t cmd_list;
+#endif
+#if CONFIG_SOCKET_FS_COMMAND_DNS_CACHE_FLUSH == 1
+    struct fs_command_t cmd_flush;
+#endif
+};
+
+static struct dns_cache_t dns_cache;
+
+static int dns_lookup(const char *hostname_p,
+                      struct inet_ip_addr_t *ip_p);
+
+static uint32_t dns_cache_now(void)
+{
+    struct time_t now;
+
+    sys_uptime(&now);
+
+    return (now.seconds);
+}
+
+/**
+ * Find the unexpired entry of given hostname, or NULL if missing.
+ */
+static struct dns_cache_entry_t *dns_cache_find(const char *hostname_p,
+                                                uint32_t now)
+{
+    struct dns_cache_entry_t *entry_p;
+    int i;
+
+    for (i = 0; i < membersof(dns_cache.entries); i++) {
+        entry_p = &dns_cache.entries[i];
+
+        if (entry_p->hostname[0] == '\0') {
+            continue;
+        }
+
+        if ((int32_t)(entry_p->expires - now) <= 0) {
+            entry_p->hostname[0] = '\0';
+            continue;
+        }
+
+        if (strcmp(entry_p->hostname, hostname_p) == 0) {
+            return (entry_p);
+        }
+    }
+
+    return (NULL);
+}
+
+/**
+ * Save given lookup result, replacing an empty entry, or the entry
+ * that expires first if the cache is full.
+ */
+static void dns_cache_save(const char *hostname_p,
+                           const struct inet_ip_addr_t *ip_p,
+                           int res,
+                           uint32_t now)
+{
+    struct dns_cache_entry_t *entry_p;
+    struct dns_cache_entry_t *oldest_p;
+    int i;
+
+    /* Hostnames that do not fit are never cached. */
+    if (strlen(hostname_p) >= CONFIG_SOCKET_DNS_CACHE_HOSTNAME_MAX) {
+        return;
+    }
+
+    entry_p = dns_cache_find(hostname_p, now);
+
+    if (entry_p == NULL) {
+        oldest_p = &dns_cache.entries[0];
+
+        for (i = 0; i < membersof(dns_cache.entries); i++) {
+            entry_p = &dns_cache.entries[i];
+
+            if (entry_p->hostname[0] == '\0') {
+                oldest_p = entry_p;
+                break;
+            }
+
+            if ((int32_t)(entry_p->expires - oldest_p->expires) < 0) {
+                oldest_p = entry_p;
+            }
+        }
+
+        entry_p = oldest_p;
+        strcpy(entry_p->hostname, hostname_p);
+    }
+
+    entry_p->res = res;
+
+    if (res == 0) {
+        entry_p->ip = *ip_p;
+        entry_p->expires = (now + CONFIG_SOCKET_DNS_CACHE_TTL);
+    } else {
+        entry_p->ip.number = 0;
+        entry_p->expires = (now + CONFIG_SOCKET_DNS_CACHE_NEGATIVE_TTL);
+    }
+}
+
+#if CONFIG_SOCKET_FS_COMMAND_DNS_CACHE_LIST == 1
+
+static int cmd_dns_cache_list_cb(int argc,
+                                 const char *argv[],
+                                 void *out_p,
+                                 void *in_p,
+                                 void *arg_p,
+                                 void *call_arg_p)
+{
+    struct dns_cache_entry_t *entry_p;
+    char buf[16];
+    uint32_t now;
+    int i;
+
+    std_fprintf(out_p, OSTR("HOSTNAME                          "
+                            "ADDRESS          "
+                            "TTL\r\n"));
+
+    now = dns_cache_now();
+    sem_take(&dns_cache.sem, NULL);
+
+    for (i = 0; i < membersof(dns_cache.entries); i++) {
+        entry_p = &dns_cache.entries[i];
+
+        if (entry_p->hostname[0] == '\0') {
+            continue;
+        }
+
+        if ((int32_t)(entry_p->expires - now) <= 0) {
+            continue;
+        }
+
+        if (entry_p->res == 0) {
+            inet_ntoa(&entry_p->ip, &buf[0]);
+        } else {
+            strcpy(&buf[0], "-");
+        }
+
+        std_fprintf(out_p,
+                    OSTR("%-32s  %-15s  %lu\r\n"),
+                    &entry_p->hostname[0],
+                    &buf[0],
+                    (unsigned long)(entry_p->expires - now));
+    }
+
+    sem_give(&dns_cache.sem, 1);
+
+    return (0);
+}
+
+#endif
+
+#if CONFIG_SOCKET_FS_COMMAND_DNS_CACHE_FLUSH == 1
+
+static int cmd_dns_cache_flush_cb(int argc,
+                                  const char *argv[],
+                                  void *out_p,
+                                  void *in_p,
+                                  void *arg_p,
+                                  void *call_arg_p)
+{
+    return (socket_dns_cache_flush());
+}
+
+#endif
+
+static void dns_cache_module_init(void)
+{
+    if (dns_cache.initialized == 1) {
+        return;
+    }
+
+    dns_cache.initialized = 1;
+    sem_init(&dns_cache.sem, 0, 1);
+
+#if CONFIG_SOCKET_FS_COMMAND_DNS_CACHE_LIST == 1
+    fs_command_init(&dns_cache.cmd_list,
+                    CSTR("/inet/socket/dns_cache/list"),
+                    cmd_dns_cache_list_cb,
+                    NULL);
+    fs_command_register(&dns_cache.cmd_list);
+#endif
+
+#if CONFIG_SOCKET_FS_COMMAND_DNS_CACHE_FLUSH == 1
+    fs_command_init(&dns_cache.cmd_flush,
+                    CSTR("/inet/socket/dns_cache/flush"),
+                    cmd_dns_cache_flush_cb,
+                    NULL);
+    fs_command_register(&dns_cache.cmd_flush);
+#endif
+}
 
 #if !defined(ARCH_LINUX)
 
@@ -52,6 +262,79 @@
 #include "lwip/udp.h"
 #include "lwip/tcpip.h"
 #include "lwip/raw.h"
+#include "lwip/dns.h"
+
+#if !defined(ARCH_ESP) && !defined(ARCH_ESP32)
+#    include "lwip/stats.h"
+#    include "lwip/timers.h"
+#    define SOCKET_LWIP_MEM_STATS (LWIP_STATS && MEM_STATS)
+#    define SOCKET_LWIP_STATS (LWIP_STATS                            \
+                               && MEMP_STATS                        \
+                               && (CONFIG_SOCKET_LWIP_STATS == 1))
+#else
+#    define SOCKET_LWIP_MEM_STATS 0
+#    define SOCKET_LWIP_STATS 0
+#endif
+
+#if SOCKET_LWIP_STATS
+
+/* Name and error counter path of each memory pool. */
+#define LWIP_MEMPOOL(name, num, size, desc)                             \
+    static FAR const char memp_ ## name ## _name[] = desc;              \
+    static FAR const char memp_ ## name ## _err_path[] =                \
+        "/inet/lwip/memp/" desc "/err";
+#include "lwip/memp_std.h"
+
+static FAR const char link_drop_path[] = "/inet/lwip/link/drop";
+static FAR const char ip_drop_path[] = "/inet/lwip/ip/drop";
+static FAR const char tcp_xmit_path[] = "/inet/lwip/tcp/xmit";
+static FAR const char tcp_rexmit_path[] = "/inet/lwip/tcp/rexmit";
+static FAR const char tcp_drop_path[] = "/inet/lwip/tcp/drop";
+static FAR const char udp_drop_path[] = "/inet/lwip/udp/drop";
+static FAR const char mem_err_path[] = "/inet/lwip/mem/err";
+
+struct lwip_stat_t {
+    far_string_t name_p;
+    far_string_t path_p;
+    STAT_COUNTER *value_p;
+};
+
+/* lwIP statistics accumulated into counters. The memory pool errors
+   come first, in pool order. */
+static const struct lwip_stat_t lwip_stat_counters[] = {
+#define LWIP_MEMPOOL(name, num, size, desc)                             \
+    {                                                                   \
+        memp_ ## name ## _name,                                         \
+        memp_ ## name ## _err_path,                                     \
+        &lwip_stats.memp[MEMP_ ## name].err                             \
+    },
+#include "lwip/memp_std.h"
+#if LINK_STATS
+    { NULL, link_drop_path, &lwip_stats.link.drop },
+#endif
+#if IP_STATS
+    { NULL, ip_drop_path, &lwip_stats.ip.drop },
+#endif
+#if TCP_STATS
+    { NULL, tcp_xmit_path, &lwip_stats.tcp.xmit },
+    { NULL, tcp_rexmit_path, &lwip_stats.tcp.rexmit },
+    { NULL, tcp_drop_path, &lwip_stats.tcp.drop },
+#endif
+#if UDP_STATS
+    { NULL, udp_drop_path, &lwip_stats.udp.drop },
+#endif
+#if MEM_STATS
+    { NULL, mem_err_path, &lwip_stats.mem.err },
+#endif
+};
+
+struct lwip_stat_counter_t {
+    struct fs_counter_t counter;
+    /* lwIP counter value at the previous accumulation. */
+    STAT_COUNTER previous;
+};
+
+#endif
 
 #if defined(ARCH_ESP) || defined(ARCH_ESP32)
 
@@ -73,6 +356,13 @@ struct module_t {
     struct fs_counter_t raw_rx_bytes;
     struct fs_counter_t raw_tx_bytes;
 #endif
+#if SOCKET_LWIP_MEM_STATS
+    struct sys_memory_region_t lwip_mem_region;
+#endif
+#if SOCKET_LWIP_STATS
+    struct lwip_stat_counter_t lwip_counters[membersof(lwip_stat_counters)];
+    struct fs_command_t cmd_lwip_stats;
+#endif
 };
 
 struct send_to_args_t {
@@ -82,6 +372,8 @@ struct send_to_args_t {
     const struct inet_addr_t *remote_addr_p;
     struct {
         size_t left;
+        const struct iov_t *iov_p;
+        size_t iov_left;
     } extra;
 };
 
@@ -95,6 +387,12 @@ struct recv_from_args_t {
     } extra;
 };
 
+struct dns_lookup_args_t {
+    const char *hostname_p;
+    struct inet_ip_addr_t *ip_p;
+    struct thrd_t *thrd_p;
+};
+
 struct tcp_accept_args_t {
     struct socket_t *accepted_p;
     struct inet_addr_t *addr_p;
@@ -102,6 +400,11 @@ struct tcp_accept_args_t {
 
 static struct module_t module;
 
+static const struct time_t zero_timeout = {
+    .seconds = 0,
+    .nanoseconds = 0
+};
+
 #if defined(ARCH_ESP32)
 
 /**
@@ -138,6 +441,7 @@ static void init(struct socket_t *self_p,
               (chan_read_fn_t)socket_read,
               (chan_write_fn_t)socket_write,
               (chan_size_fn_t)socket_size);
+    chan_set_writev_cb(&self_p->base, (chan_writev_fn_t)socket_writev);
 
     self_p->type = type;
     self_p->pcb_p = pcb_p;
@@ -146,6 +450,64 @@ static void init(struct socket_t *self_p,
     self_p->input.u.recvfrom.left = 0;
     self_p->input.u.recvfrom.closed = 0;
     self_p->output.cb.state = STATE_IDLE;
+    self_p->options.nonblocking = 0;
+    self_p->options.recv_timeout.seconds = -1;
+    self_p->options.send_timeout.seconds = -1;
+    self_p->options.connect_timeout.seconds = -1;
+}
+
+/**
+ * Call given callback in the LwIP core context and wait for the
+ * result. With core locking the callback is called directly from the
+ * calling thread. A callback that completes the operation resumes
+ * the calling thread before it is suspended, and the suspend call
+ * returns immediately. Otherwise a message is passed to the LwIP
+ * thread, which costs at least two context switches.
+ */
+static int tcpip_call(void *ctx_p,
+                      void (*callback)(void *ctx_p),
+                      const struct time_t *timeout_p)
+{
+#if LWIP_TCPIP_CORE_LOCKING == 1
+    LOCK_TCPIP_CORE();
+    callback(ctx_p);
+    UNLOCK_TCPIP_CORE();
+#else
+    tcpip_callback_with_block(callback, ctx_p, 0);
+#endif
+
+    return (thrd_suspend(timeout_p));
+}
+
+/**
+ * Call given callback in the LwIP core context and wait for the
+ * result, at most given socket timeout. On timeout, the cancel
+ * callback is called in the LwIP core context to abort the operation
+ * if it is still pending. It resumes the thread with the cancel
+ * result. An operation that completed after the timeout has already
+ * resumed the thread with its result, and the cancel callback does
+ * nothing.
+ */
+static int tcpip_call_timed(struct socket_t *self_p,
+                            void (*callback)(void *ctx_p),
+                            void (*cancel)(void *ctx_p),
+                            const struct time_t *timeout_p)
+{
+    int res;
+
+    if (self_p->options.nonblocking == 1) {
+        timeout_p = &zero_timeout;
+    } else if (timeout_p->seconds < 0) {
+        timeout_p = NULL;
+    }
+
+    res = tcpip_call(self_p, callback, timeout_p);
+
+    if (res == -ETIMEDOUT) {
+        res = tcpip_call(self_p, cancel, NULL);
+    }
+
+    return (res);
 }
 
 /**
@@ -158,9 +520,22 @@ static int tcpip_call_input(struct socket_t *self_p,
     self_p->input.cb.args_p = args_p;
     self_p->input.cb.thrd_p = thrd_self();
 
-    tcpip_callback_with_block(callback, self_p, 0);
+    return (tcpip_call(self_p, callback, NULL));
+}
+
+/**
+ * Call given callback from the LwIP thread, with given timeout.
+ */
+static int tcpip_call_input_timed(struct socket_t *self_p,
+                                  void (*callback)(void *ctx_p),
+                                  void *args_p,
+                                  void (*cancel)(void *ctx_p),
+                                  const struct time_t *timeout_p)
+{
+    self_p->input.cb.args_p = args_p;
+    self_p->input.cb.thrd_p = thrd_self();
 
-    return (thrd_suspend(NULL));
+    return (tcpip_call_timed(self_p, callback, cancel, timeout_p));
 }
 
 /**
@@ -173,9 +548,22 @@ static int tcpip_call_output(struct socket_t *self_p,
     self_p->output.cb.args_p = args_p;
     self_p->output.cb.thrd_p = thrd_self();
 
-    tcpip_callback_with_block(callback, self_p, 0);
+    return (tcpip_call(self_p, callback, NULL));
+}
+
+/**
+ * Call given callback from the LwIP thread, with given timeout.
+ */
+static int tcpip_call_output_timed(struct socket_t *self_p,
+                                   void (*callback)(void *ctx_p),
+                                   void *args_p,
+                                   void (*cancel)(void *ctx_p),
+                                   const struct time_t *timeout_p)
+{
+    self_p->output.cb.args_p = args_p;
+    self_p->output.cb.thrd_p = thrd_self();
 
-    return (thrd_suspend(NULL));
+    return (tcpip_call_timed(self_p, callback, cancel, timeout_p));
 }
 
 static void resume_thrd(struct thrd_t *thrd_p, int res)
@@ -218,6 +606,117 @@ static void resume_if_polled(struct socket_t *socket_p)
  * ESP, this is the FreeRTOS LwIP-thread.
  */
 
+/**
+ * Error code of an operation that did not complete in time.
+ */
+static int timeout_error(struct socket_t *socket_p)
+{
+    if (socket_p->options.nonblocking == 1) {
+        return (-EAGAIN);
+    }
+
+    return (-ETIMEDOUT);
+}
+
+/**
+ * Cancel a pending receive or accept operation. Already received TCP
+ * data is returned.
+ */
+static void input_cancel_cb(void *ctx_p)
+{
+    struct socket_t *socket_p = ctx_p;
+    struct recv_from_args_t *args_p;
+    ssize_t res;
+
+    switch (socket_p->input.cb.state) {
+
+    case STATE_RECVFROM:
+        res = timeout_error(socket_p);
+
+        if (socket_p->type == SOCKET_TYPE_STREAM) {
+            args_p = socket_p->input.cb.args_p;
+
+            if (args_p->extra.left < args_p->size) {
+                res = (args_p->size - args_p->extra.left);
+                fs_counter_increment(&module.tcp_rx_bytes, res);
+            }
+        }
+
+        break;
+
+    case STATE_ACCEPT:
+    case STATE_RECV_PBUF:
+        res = timeout_error(socket_p);
+        break;
+
+    default:
+        /* Completed before cancelled. */
+        return;
+    }
+
+    socket_p->input.cb.state = STATE_IDLE;
+    resume_thrd(socket_p->input.cb.thrd_p, res);
+}
+
+/**
+ * Cancel a pending TCP send operation. The number of already queued
+ * bytes is returned.
+ */
+static void output_cancel_cb(void *ctx_p)
+{
+    struct socket_t *socket_p = ctx_p;
+    struct send_to_args_t *args_p;
+    size_t left;
+    size_t i;
+    ssize_t res;
+
+    if (socket_p->output.cb.state != STATE_SENDTO) {
+        return;
+    }
+
+    args_p = socket_p->output.cb.args_p;
+    left = args_p->extra.left;
+
+    for (i = 0; i < args_p->extra.iov_left; i++) {
+        left += args_p->extra.iov_p[i].size;
+    }
+
+    if (left < args_p->size) {
+        res = (args_p->size - left);
+        fs_counter_increment(&module.tcp_tx_bytes, res);
+    } else {
+        res = timeout_error(socket_p);
+    }
+
+    socket_p->output.cb.state = STATE_IDLE;
+    resume_thrd(socket_p->output.cb.thrd_p, res);
+}
+
+/**
+ * Cancel a pending TCP connect operation. A non-blocking socket
+ * continues connecting in the background, and is writable once
+ * connected. Otherwise the connection attempt is aborted.
+ */
+static void connect_cancel_cb(void *ctx_p)
+{
+    struct socket_t *socket_p = ctx_p;
+
+    if (socket_p->output.cb.state != STATE_CONNECT) {
+        return;
+    }
+
+    if (socket_p->options.nonblocking == 1) {
+        socket_p->output.cb.state = STATE_CONNECTING;
+        resume_thrd(socket_p->input.cb.thrd_p, -EINPROGRESS);
+    } else {
+        /* The error callback frees the PCB. */
+        socket_p->output.cb.state = STATE_CLOSED;
+        tcp_abort(socket_p->pcb_p);
+        socket_p->pcb_p = NULL;
+        resume_thrd(socket_p->input.cb.thrd_p, -ETIMEDOUT);
+    }
+}
+
 /**
  * Copy data to the reading threads' buffer and resume the thread.
  */
@@ -341,6 +840,48 @@ static void udp_connect_cb(void *ctx_p)
     resume_thrd(socket_p->input.cb.thrd_p, res);
 }
 
+/**
+ * Create a pbuf chain referencing the data in given io vector. No
+ * data is copied. LwIP copies referenced pbufs that are queued, for
+ * example while waiting for an ARP response, so the data may be
+ * reused once the packet has been sent.
+ */
+static struct pbuf *udp_iov_to_pbuf(const struct iov_t *iov_p,
+                                    size_t length)
+{
+    struct pbuf *head_p;
+    struct pbuf *pbuf_p;
+    size_t i;
+
+    head_p = NULL;
+
+    for (i = 0; i < length; i++) {
+        if (iov_p[i].size == 0) {
+            continue;
+        }
+
+        pbuf_p = pbuf_alloc(PBUF_RAW, iov_p[i].size, PBUF_REF);
+
+        if (pbuf_p == NULL) {
+            if (head_p != NULL) {
+                pbuf_free(head_p);
+            }
+
+            return (NULL);
+        }
+
+        pbuf_p->payload = iov_p[i].buf_p;
+
+        if (head_p == NULL) {
+            head_p = pbuf_p;
+        } else {
+            pbuf_cat(head_p, pbuf_p);
+        }
+    }
+
+    return (head_p);
+}
+
 static void udp_send_to_cb(void *ctx_p)
 {
     struct socket_t *socket_p = ctx_p;
@@ -351,12 +892,21 @@ static void udp_send_to_cb(void *ctx_p)
 
     args_p = socket_p->output.cb.args_p;
 
-    /* Copy the data to a pbuf.*/
-    pbuf_p = pbuf_alloc(PBUF_TRANSPORT, args_p->size, PBUF_RAM);
+    if (args_p->extra.iov_p != NULL) {
+        pbuf_p = udp_iov_to_pbuf(args_p->extra.iov_p,
+                                 args_p->extra.iov_left);
+    } else {
+        /* Copy the data to a pbuf.*/
+        pbuf_p = pbuf_alloc(PBUF_TRANSPORT, args_p->size, PBUF_RAM);
+
+        if (pbuf_p != NULL) {
+            memcpy(pbuf_p->payload, args_p->buf_p, args_p->size);
+        }
+    }
+
     res = -1;
 
     if (pbuf_p != NULL) {
-        memcpy(pbuf_p->payload, args_p->buf_p, args_p->size);
         res = args_p->size;
 
         if (args_p->remote_addr_p != NULL) {
@@ -414,6 +964,23 @@ static ssize_t udp_send_to(struct socket_t *self_p,
     args.size = size;
     args.flags = flags;
     args.remote_addr_p = remote_addr_p;
+    args.extra.iov_p = NULL;
+
+    return (tcpip_call_output(self_p, udp_send_to_cb, &args));
+}
+
+static ssize_t udp_write_iov(struct socket_t *self_p,
+                             const struct iov_t *iov_p,
+                             size_t length,
+                             size_t size)
+{
+    struct send_to_args_t args;
+
+    args.size = size;
+    args.flags = 0;
+    args.remote_addr_p = NULL;
+    args.extra.iov_p = iov_p;
+    args.extra.iov_left = length;
 
     return (tcpip_call_output(self_p, udp_send_to_cb, &args));
 }
@@ -431,7 +998,11 @@ static ssize_t udp_recv_from(struct socket_t *self_p,
     args.flags = flags;
     args.remote_addr_p = remote_addr_p;
 
-    return (tcpip_call_input(self_p, udp_recv_from_cb, &args));
+    return (tcpip_call_input_timed(self_p,
+                                   udp_recv_from_cb,
+                                   &args,
+                                   input_cancel_cb,
+                                   &self_p->options.recv_timeout));
 }
 
 /**
@@ -487,41 +1058,130 @@ static void tcp_recv_buffer(struct socket_t *socket_p)
 }
 
 /**
- * This function is called when data has been acknowledged by the
- * remote endpoint.
+ * Hand over the received pbuf chain to the reading thread and resume
+ * it. Already read data is acknowledged and removed from the chain,
+ * and the rest is acknowledged when the reader releases the chain.
  */
-static err_t on_tcp_sent(void *arg_p,
-                         struct tcp_pcb *pcb_p,
-                         u16_t len)
+static void tcp_recv_pbuf_resume(struct socket_t *socket_p)
 {
-    struct socket_t *socket_p = arg_p;
-    struct send_to_args_t *args_p;
-    size_t size;
+    struct pbuf **pbuf_pp;
+    struct pbuf *pbuf_p;
+    struct pbuf *next_p;
+    size_t offset;
 
-    if (socket_p->output.cb.state == STATE_SENDTO) {
-        args_p = socket_p->output.cb.args_p;
-        size = MIN(args_p->extra.left,
-                   tcp_sndbuf(((struct tcp_pcb *)socket_p->pcb_p)));
+    pbuf_pp = socket_p->input.cb.args_p;
+    pbuf_p = socket_p->input.u.recvfrom.pbuf_p;
+    offset = (pbuf_p->tot_len - socket_p->input.u.recvfrom.left);
+    socket_p->input.u.recvfrom.pbuf_p = NULL;
+    socket_p->input.u.recvfrom.left = 0;
+
+    if (offset > 0) {
+        tcp_recved(socket_p->pcb_p, offset);
+
+        /* Free fully read pbufs and hide the read part of the first
+           remaining one. */
+        while (offset >= pbuf_p->len) {
+            offset -= pbuf_p->len;
+            next_p = pbuf_p->next;
+            pbuf_p->next = NULL;
+            pbuf_p->tot_len = pbuf_p->len;
+            pbuf_free(pbuf_p);
+            pbuf_p = next_p;
+        }
 
-        if (tcp_write(socket_p->pcb_p,
-                      args_p->buf_p,
-                      size,
-                      TCP_WRITE_FLAG_COPY) == ERR_OK) {
-            args_p->buf_p += size;
-            args_p->extra.left -= size;
-
-            /* Resume if all data has been written. */
-            if (args_p->extra.left == 0) {
-                tcp_output(socket_p->pcb_p);
-                socket_p->output.cb.state = STATE_IDLE;
-                fs_counter_increment(&module.tcp_tx_bytes, args_p->size);
-                resume_thrd(socket_p->output.cb.thrd_p, args_p->size);
-            } else {
-                socket_p->output.cb.state = STATE_SENDTO;
+        pbuf_header(pbuf_p, -(s16_t)offset);
+    }
+
+    socket_p->input.cb.state = STATE_IDLE;
+    fs_counter_increment(&module.tcp_rx_bytes, pbuf_p->tot_len);
+    *pbuf_pp = pbuf_p;
+    resume_thrd(socket_p->input.cb.thrd_p, pbuf_p->tot_len);
+}
+
+/**
+ * Queue as much of the data left to write as fits in the send
+ * buffer. All io vector elements are queued from the same LwIP
+ * callback, and the segments are output once.
+ *
+ * @return zero(0) if all data has been queued, one(1) if waiting for
+ *         send buffer space, or negative error code.
+ */
+static int tcp_write_args(struct socket_t *socket_p,
+                          struct send_to_args_t *args_p)
+{
+    struct tcp_pcb *pcb_p;
+    size_t size;
+    u8_t flags;
+
+    pcb_p = socket_p->pcb_p;
+
+    while (1) {
+        /* Continue with the next io vector element. */
+        while (args_p->extra.left == 0) {
+            if (args_p->extra.iov_left == 0) {
+                tcp_output(pcb_p);
+
+                return (0);
             }
-        } else {
+
+            args_p->buf_p = args_p->extra.iov_p->buf_p;
+            args_p->extra.left = args_p->extra.iov_p->size;
+            args_p->extra.iov_p++;
+            args_p->extra.iov_left--;
+        }
+
+        size = MIN(args_p->extra.left, tcp_sndbuf(pcb_p));
+
+        if (size == 0) {
+            tcp_output(pcb_p);
+
+            return (1);
+        }
+
+        flags = TCP_WRITE_FLAG_COPY;
+
+        /* Do not push partial data. */
+        if ((size < args_p->extra.left) || (args_p->extra.iov_left > 0)) {
+            flags |= TCP_WRITE_FLAG_MORE;
+        }
+
+        if (tcp_write(pcb_p, args_p->buf_p, size, flags) != ERR_OK) {
+            return (-1);
+        }
+
+        args_p->buf_p += size;
+        args_p->extra.left -= size;
+    }
+}
+
+/**
+ * This function is called when data has been acknowledged by the
+ * remote endpoint.
+ */
+static err_t on_tcp_sent(void *arg_p,
+                         struct tcp_pcb *pcb_p,
+                         u16_t len)
+{
+    struct socket_t *socket_p = arg_p;
+    struct send_to_args_t *args_p;
+    int res;
+
+    if (socket_p->output.cb.state == STATE_SENDTO) {
+        args_p = socket_p->output.cb.args_p;
+        res = tcp_write_args(socket_p, args_p);
+
+        /* Resume if all data has been written. */
+        if (res == 0) {
+            socket_p->output.cb.state = STATE_IDLE;
+            fs_counter_increment(&module.tcp_tx_bytes, args_p->size);
+            resume_thrd(socket_p->output.cb.thrd_p, args_p->size);
+        } else if (res < 0) {
+            socket_p->output.cb.state = STATE_IDLE;
             resume_thrd(socket_p->output.cb.thrd_p, 0);
         }
+    } else {
+        /* Send buffer space is available. */
+        resume_if_polled(socket_p);
     }
 
     return (ERR_OK);
@@ -542,6 +1202,8 @@ static void on_tcp_err(void *arg_p, err_t err)
     if (socket_p->output.cb.state == STATE_CONNECT) {
         socket_p->output.cb.state = STATE_CLOSED;
         resume_thrd(socket_p->input.cb.thrd_p, -1);
+    } else {
+        resume_if_polled(socket_p);
     }
 }
 
@@ -579,6 +1241,8 @@ static err_t on_tcp_recv(void *arg_p,
 
         if (socket_p->input.cb.state == STATE_RECVFROM) {
             tcp_recv_buffer(socket_p);
+        } else if (socket_p->input.cb.state == STATE_RECV_PBUF) {
+            tcp_recv_pbuf_resume(socket_p);
         } else {
             resume_if_polled(socket_p);
         }
@@ -589,6 +1253,9 @@ static err_t on_tcp_recv(void *arg_p,
             args_p = socket_p->input.cb.args_p;
             resume_thrd(socket_p->input.cb.thrd_p,
                         args_p->size - args_p->extra.left);
+        } else if (socket_p->input.cb.state == STATE_RECV_PBUF) {
+            socket_p->input.cb.state = STATE_IDLE;
+            resume_thrd(socket_p->input.cb.thrd_p, 0);
         } else {
             resume_if_polled(socket_p);
         }
@@ -739,8 +1406,14 @@ static err_t on_tcp_connected(void *arg_p,
 {
     struct socket_t *socket_p = arg_p;
 
-    socket_p->output.cb.state = STATE_IDLE;
-    resume_thrd(socket_p->input.cb.thrd_p, err);
+    if (socket_p->output.cb.state == STATE_CONNECTING) {
+        /* A non-blocking connect completed. */
+        socket_p->output.cb.state = STATE_IDLE;
+        resume_if_polled(socket_p);
+    } else {
+        socket_p->output.cb.state = STATE_IDLE;
+        resume_thrd(socket_p->input.cb.thrd_p, err);
+    }
 
     return (ERR_OK);
 }
@@ -783,37 +1456,64 @@ static void tcp_recv_from_cb(void *ctx_p)
     }
 }
 
+static void tcp_recv_pbuf_cb(void *ctx_p)
+{
+    struct socket_t *socket_p = ctx_p;
+
+    if (socket_p->input.u.recvfrom.pbuf_p != NULL) {
+        /* Data available. */
+        tcp_recv_pbuf_resume(socket_p);
+    } else if ((socket_p->input.u.recvfrom.closed == 1)
+               || (socket_p->pcb_p == NULL)) {
+        /* Socket closed. */
+        resume_thrd(socket_p->input.cb.thrd_p, 0);
+    } else {
+        socket_p->input.cb.state = STATE_RECV_PBUF;
+    }
+}
+
+static void tcp_release_cb(void *ctx_p)
+{
+    struct socket_t *socket_p = ctx_p;
+    struct pbuf *pbuf_p;
+
+    pbuf_p = socket_p->input.cb.args_p;
+
+    /* Open the receive window again. */
+    if (socket_p->pcb_p != NULL) {
+        tcp_recved(socket_p->pcb_p, pbuf_p->tot_len);
+    }
+
+    pbuf_free(pbuf_p);
+    resume_thrd(socket_p->input.cb.thrd_p, 0);
+}
+
 static void tcp_send_to_cb(void *ctx_p)
 {
     struct socket_t *socket_p = ctx_p;
     struct send_to_args_t *args_p;
-    size_t size;
+    int res;
 
     if (socket_p->pcb_p == NULL) {
         resume_thrd(socket_p->output.cb.thrd_p, 0);
         return;
     }
 
-    args_p = socket_p->output.cb.args_p;
-    size = MIN(args_p->extra.left,
-               tcp_sndbuf(((struct tcp_pcb *)socket_p->pcb_p)));
-
-    if (tcp_write(socket_p->pcb_p,
-                  args_p->buf_p,
-                  size,
-                  TCP_WRITE_FLAG_COPY) == ERR_OK) {
-        args_p->buf_p += size;
-        args_p->extra.left -= size;
+    if (socket_p->output.cb.state == STATE_CONNECTING) {
+        resume_thrd(socket_p->output.cb.thrd_p, -EAGAIN);
+        return;
+    }
 
-        /* Resume if all data has been written. Otherwise the sent
-           callback will send the rest of the data and resume. */
-        if (args_p->extra.left == 0) {
-            tcp_output(socket_p->pcb_p);
-            fs_counter_increment(&module.tcp_tx_bytes, args_p->size);
-            resume_thrd(socket_p->output.cb.thrd_p, args_p->size);
-        } else {
-            socket_p->output.cb.state = STATE_SENDTO;
-        }
+    args_p = socket_p->output.cb.args_p;
+    res = tcp_write_args(socket_p, args_p);
+
+    /* Resume if all data has been written. Otherwise the sent
+       callback will send the rest of the data and resume. */
+    if (res == 0) {
+        fs_counter_increment(&module.tcp_tx_bytes, args_p->size);
+        resume_thrd(socket_p->output.cb.thrd_p, args_p->size);
+    } else if (res == 1) {
+        socket_p->output.cb.state = STATE_SENDTO;
     } else {
         resume_thrd(socket_p->output.cb.thrd_p, 0);
     }
@@ -831,8 +1531,35 @@ static ssize_t tcp_send_to(struct socket_t *self_p,
     args.size = size;
     args.flags = flags;
     args.extra.left = size;
+    args.extra.iov_p = NULL;
+    args.extra.iov_left = 0;
+
+    return (tcpip_call_output_timed(self_p,
+                                    tcp_send_to_cb,
+                                    &args,
+                                    output_cancel_cb,
+                                    &self_p->options.send_timeout));
+}
 
-    return (tcpip_call_output(self_p, tcp_send_to_cb, &args));
+static ssize_t tcp_write_iov(struct socket_t *self_p,
+                             const struct iov_t *iov_p,
+                             size_t length,
+                             size_t size)
+{
+    struct send_to_args_t args;
+
+    args.buf_p = NULL;
+    args.size = size;
+    args.flags = 0;
+    args.extra.left = 0;
+    args.extra.iov_p = iov_p;
+    args.extra.iov_left = length;
+
+    return (tcpip_call_output_timed(self_p,
+                                    tcp_send_to_cb,
+                                    &args,
+                                    output_cancel_cb,
+                                    &self_p->options.send_timeout));
 }
 
 static ssize_t tcp_recv_from(struct socket_t *self_p,
@@ -849,7 +1576,11 @@ static ssize_t tcp_recv_from(struct socket_t *self_p,
     args.remote_addr_p = remote_addr_p;
     args.extra.left = size;
 
-    return (tcpip_call_input(self_p, tcp_recv_from_cb, &args));
+    return (tcpip_call_input_timed(self_p,
+                                   tcp_recv_from_cb,
+                                   &args,
+                                   input_cancel_cb,
+                                   &self_p->options.recv_timeout));
 }
 
 #if CONFIG_SOCKET_RAW == 1
@@ -1034,11 +1765,232 @@ static ssize_t raw_recv_from(struct socket_t *self_p,
     args.remote_addr_p = remote_addr_p;
     args.extra.left = size;
 
-    return (tcpip_call_input(self_p, raw_recv_from_cb, &args));
+    return (tcpip_call_input_timed(self_p,
+                                   raw_recv_from_cb,
+                                   &args,
+                                   input_cancel_cb,
+                                   &self_p->options.recv_timeout));
+}
+
+#endif
+
+static void on_dns_found(const char *name_p,
+#if LWIP_VERSION_MINOR <= 4
+                         ip_addr_t *ipaddr_p,
+#else
+                         const ip_addr_t *ipaddr_p,
+#endif
+                         void *arg_p)
+{
+    struct dns_lookup_args_t *args_p = arg_p;
+    int res;
+
+    if (ipaddr_p != NULL) {
+        args_p->ip_p->number = ip_addr_get_ip4_u32(ipaddr_p);
+        res = 0;
+    } else {
+        res = -EHOSTUNREACH;
+    }
+
+    resume_thrd(args_p->thrd_p, res);
+}
+
+static void dns_lookup_cb(void *ctx_p)
+{
+    struct dns_lookup_args_t *args_p = ctx_p;
+    ip_addr_t ip;
+
+    switch (dns_gethostbyname(args_p->hostname_p,
+                              &ip,
+                              on_dns_found,
+                              args_p)) {
+
+    case ERR_OK:
+        /* Found in the lwIP host table. */
+        args_p->ip_p->number = ip_addr_get_ip4_u32(&ip);
+        resume_thrd(args_p->thrd_p, 0);
+        break;
+
+    case ERR_INPROGRESS:
+        /* A query was sent. on_dns_found() resumes the thread. */
+        break;
+
+    default:
+        resume_thrd(args_p->thrd_p, -EINVAL);
+        break;
+    }
+}
+
+/**
+ * Look up given hostname using the lwIP DNS client, which resends
+ * the query and gives up on its own.
+ */
+static int dns_lookup(const char *hostname_p,
+                      struct inet_ip_addr_t *ip_p)
+{
+    struct dns_lookup_args_t args;
+
+    args.hostname_p = hostname_p;
+    args.ip_p = ip_p;
+    args.thrd_p = thrd_self();
+
+    return (tcpip_call(&args, dns_lookup_cb, NULL));
+}
+
+#if SOCKET_LWIP_MEM_STATS
+
+static int lwip_mem_memory_usage(void *arg_p,
+                                 struct sys_memory_usage_t *usage_p)
+{
+    usage_p->size = lwip_stats.mem.avail;
+    usage_p->used = lwip_stats.mem.used;
+    usage_p->used_max = lwip_stats.mem.max;
+
+    return (0);
+}
+
+#endif
+
+/**
+ * Register the lwIP heap as a memory region. Requires LWIP_STATS.
+ */
+static void register_lwip_memory_region(void)
+{
+#if SOCKET_LWIP_MEM_STATS
+    sys_memory_region_init(&module.lwip_mem_region,
+                           "lwip_mem",
+                           NULL,
+                           0,
+                           lwip_mem_memory_usage,
+                           NULL);
+    sys_memory_region_register(&module.lwip_mem_region);
+#endif
+}
+
+#if SOCKET_LWIP_STATS
+
+/**
+ * Add the increase of the lwIP statistics since the previous call to
+ * their counters. The lwIP statistics are only 16 bits wide, and are
+ * accumulated often enough to not wrap around in between. Must be
+ * called in the LwIP core context.
+ */
+static void lwip_stats_accumulate(void)
+{
+    struct lwip_stat_counter_t *counter_p;
+    STAT_COUNTER value;
+    int i;
+
+    for (i = 0; i < membersof(lwip_stat_counters); i++) {
+        counter_p = &module.lwip_counters[i];
+        value = *lwip_stat_counters[i].value_p;
+        fs_counter_increment(&counter_p->counter,
+                             (STAT_COUNTER)(value - counter_p->previous));
+        counter_p->previous = value;
+    }
+}
+
+static void lwip_stats_timeout_cb(void *arg_p)
+{
+    lwip_stats_accumulate();
+    sys_timeout(CONFIG_SOCKET_LWIP_STATS_PERIOD_MS,
+                lwip_stats_timeout_cb,
+                NULL);
 }
 
+/**
+ * Called in the LwIP core context once the stack is initialized.
+ */
+static void lwip_stats_start_cb(void *arg_p)
+{
+    sys_timeout(CONFIG_SOCKET_LWIP_STATS_PERIOD_MS,
+                lwip_stats_timeout_cb,
+                NULL);
+}
+
+static void lwip_stats_accumulate_cb(void *ctx_p)
+{
+    lwip_stats_accumulate();
+    resume_thrd(ctx_p, 0);
+}
+
+static int cmd_lwip_stats_cb(int argc,
+                             const char *argv[],
+                             void *out_p,
+                             void *in_p,
+                             void *arg_p,
+                             void *call_arg_p)
+{
+    uint64_t value;
+    int i;
+
+    /* Accumulate the latest lwIP values into the counters. */
+    tcpip_call(thrd_self(), lwip_stats_accumulate_cb, NULL);
+
+    std_fprintf(out_p,
+                OSTR("POOL                AVAIL    USED     MAX  ERRORS\r\n"));
+
+    /* Memory pools, with high-water marks. */
+    for (i = 0; i < MEMP_MAX; i++) {
+        fs_counter_get(&module.lwip_counters[i].counter, &value);
+        std_fprintf(out_p,
+                    OSTR("%-16S  %6u  %6u  %6u  %6lu\r\n"),
+                    lwip_stat_counters[i].name_p,
+                    (unsigned int)lwip_stats.memp[i].avail,
+                    (unsigned int)lwip_stats.memp[i].used,
+                    (unsigned int)lwip_stats.memp[i].max,
+                    (unsigned long)value);
+    }
+
+#if MEM_STATS
+    std_fprintf(out_p,
+                OSTR("%-16s  %6u  %6u  %6u  %6u\r\n"),
+                "heap",
+                (unsigned int)lwip_stats.mem.avail,
+                (unsigned int)lwip_stats.mem.used,
+                (unsigned int)lwip_stats.mem.max,
+                (unsigned int)lwip_stats.mem.err);
 #endif
 
+    /* Protocol counters. */
+    std_fprintf(out_p, OSTR("\r\nCOUNTER                           VALUE\r\n"));
+
+    for (i = MEMP_MAX; i < membersof(lwip_stat_counters); i++) {
+        fs_counter_get(&module.lwip_counters[i].counter, &value);
+        std_fprintf(out_p,
+                    OSTR("%-24S  %12lu\r\n"),
+                    lwip_stat_counters[i].path_p,
+                    (unsigned long)value);
+    }
+
+    return (0);
+}
+
+#endif
+
+/**
+ * Register the lwIP statistics counters and the stats command.
+ */
+static void register_lwip_stats(void)
+{
+#if SOCKET_LWIP_STATS
+    int i;
+
+    for (i = 0; i < membersof(lwip_stat_counters); i++) {
+        fs_counter_init(&module.lwip_counters[i].counter,
+                        lwip_stat_counters[i].path_p,
+                        0);
+        fs_counter_register(&module.lwip_counters[i].counter);
+    }
+
+    fs_command_init(&module.cmd_lwip_stats,
+                    CSTR("/inet/lwip/stats"),
+                    cmd_lwip_stats_cb,
+                    NULL);
+    fs_command_register(&module.cmd_lwip_stats);
+#endif
+}
+
 int socket_module_init(void)
 {
     /* Return immediately if the module is already initialized. */
@@ -1047,6 +1999,7 @@ int socket_module_init(void)
     }
 
     module.initialized = 1;
+    dns_cache_module_init();
 
     /* UDP counters. */
     fs_counter_init(&module.udp_rx_bytes,
@@ -1089,11 +2042,19 @@ int socket_module_init(void)
 
 #endif
 
+    register_lwip_stats();
+
 #if !defined(ARCH_ESP) && !defined(ARCH_ESP32)
     /* Initialize the LwIP stack. */
+#    if SOCKET_LWIP_STATS
+    tcpip_init(lwip_stats_start_cb, NULL);
+#    else
     tcpip_init(NULL, NULL);
+#    endif
 #endif
 
+    register_lwip_memory_region();
+
     return (0);
 }
 
@@ -1230,9 +2191,11 @@ int socket_connect(struct socket_t *self_p,
     switch (self_p->type) {
 
     case SOCKET_TYPE_STREAM:
-        return (tcpip_call_input(self_p,
-                                 tcp_connect_cb,
-                                 (struct inet_addr_t *)remote_addr_p));
+        return (tcpip_call_input_timed(self_p,
+                                       tcp_connect_cb,
+                                       (struct inet_addr_t *)remote_addr_p,
+                                       connect_cancel_cb,
+                                       &self_p->options.connect_timeout));
 
     case SOCKET_TYPE_DGRAM:
         return (tcpip_call_input(self_p,
@@ -1245,34 +2208,6 @@ int socket_connect(struct socket_t *self_p,
 
 }
 
-int socket_connect_by_hostname(struct socket_t *self_p,
-                               const char *hostname_p,
-                               uint16_t port)
-{
-    ASSERTN(self_p != NULL, EINVAL);
-    ASSERTN(hostname_p != NULL, EINVAL);
-    ASSERTN(self_p->type == SOCKET_TYPE_STREAM, EINVAL);
-
-    /* struct inet_ip_addr_t ip2; */
-    /* ip_addr_t ip; */
-
-    /* if (inet_aton("216.58.211.142", &ip2) != 0) { */
-    /*     return (-1); */
-    /* } */
-
-    /* ip.addr = ip2.number; */
-
-    /* if (tcp_connect(self_p->pcb_p, &ip, port, on_tcp_connected) != ERR_OK) { */
-    /*     return (-1); */
-    /* } */
-
-    /* self_p->io.thrd_p = thrd_self(); */
-    /* thrd_suspend(NULL); */
-
-    /* return (self_p->io.size == ERR_OK ? 0 : -1); */
-    return (-1);
-}
-
 int socket_accept(struct socket_t *self_p,
                   struct socket_t *accepted_p,
                   struct inet_addr_t *addr_p)
@@ -1285,7 +2220,11 @@ int socket_accept(struct socket_t *self_p,
     args.accepted_p = accepted_p;
     args.addr_p = addr_p;
 
-    return (tcpip_call_input(self_p, tcp_accept_cb, &args));
+    return (tcpip_call_input_timed(self_p,
+                                   tcp_accept_cb,
+                                   &args,
+                                   input_cancel_cb,
+                                   &self_p->options.recv_timeout));
 }
 
 ssize_t socket_sendto(struct socket_t *self_p,
@@ -1394,17 +2333,125 @@ ssize_t socket_read(struct socket_t *self_p,
     return (socket_recvfrom(self_p, buf_p, size, 0, NULL));
 }
 
+ssize_t socket_writev(struct socket_t *self_p,
+                      const struct iov_t *iov_p,
+                      size_t length)
+{
+    size_t size;
+    size_t i;
+
+    ASSERTN(self_p != NULL, EINVAL);
+    ASSERTN(iov_p != NULL, EINVAL);
+    ASSERTN(length > 0, EINVAL);
+
+    size = 0;
+
+    for (i = 0; i < length; i++) {
+        size += iov_p[i].size;
+    }
+
+    if (size == 0) {
+        return (0);
+    }
+
+    switch (self_p->type) {
+
+    case SOCKET_TYPE_STREAM:
+        return (tcp_write_iov(self_p, iov_p, length, size));
+
+    case SOCKET_TYPE_DGRAM:
+        return (udp_write_iov(self_p, iov_p, length, size));
+
+    default:
+        return (-1);
+    }
+}
+
+ssize_t socket_recv_pbuf(struct socket_t *self_p,
+                         struct pbuf **pbuf_pp)
+{
+    ASSERTN(self_p != NULL, EINVAL);
+    ASSERTN(pbuf_pp != NULL, EINVAL);
+
+    if (self_p->type != SOCKET_TYPE_STREAM) {
+        return (-1);
+    }
+
+    return (tcpip_call_input_timed(self_p,
+                                   tcp_recv_pbuf_cb,
+                                   pbuf_pp,
+                                   input_cancel_cb,
+                                   &self_p->options.recv_timeout));
+}
+
+int socket_release(struct socket_t *self_p,
+                   struct pbuf *pbuf_p)
+{
+    ASSERTN(self_p != NULL, EINVAL);
+    ASSERTN(pbuf_p != NULL, EINVAL);
+
+    return (tcpip_call_input(self_p, tcp_release_cb, pbuf_p));
+}
+
 ssize_t socket_size(struct socket_t *self_p)
 {
     ASSERTN(self_p != NULL, EINVAL);
 
-    return (self_p->input.u.common.left != 0);
+    return (self_p->input.u.common.left);
+}
+
+/**
+ * Get the currently pending poll events of given socket. The fields
+ * are updated by the LwIP thread, so the result is a snapshot.
+ */
+static int socket_revents_isr(struct socket_t *self_p)
+{
+    struct tcp_pcb *pcb_p;
+    int revents;
+
+    revents = 0;
+
+    if (self_p->input.u.common.left > 0) {
+        revents |= SOCKET_POLLIN;
+    }
+
+    if (self_p->type != SOCKET_TYPE_STREAM) {
+        return (revents | SOCKET_POLLOUT);
+    }
+
+    pcb_p = self_p->pcb_p;
+
+    if (pcb_p == NULL) {
+        return (revents | SOCKET_POLLERR | SOCKET_POLLHUP);
+    }
+
+    if (self_p->input.u.recvfrom.closed == 1) {
+        revents |= (SOCKET_POLLIN | SOCKET_POLLHUP);
+    }
+
+    /* Listening sockets have no send buffer. */
+    if ((pcb_p->state == ESTABLISHED) || (pcb_p->state == CLOSE_WAIT)) {
+        if ((self_p->output.cb.state == STATE_IDLE)
+            && (tcp_sndbuf(pcb_p) > 0)) {
+            revents |= SOCKET_POLLOUT;
+        }
+    }
+
+    return (revents);
 }
 
 #else
 
+static int dns_lookup(const char *hostname_p,
+                      struct inet_ip_addr_t *ip_p)
+{
+    return (-ENOSYS);
+}
+
 int socket_module_init(void)
 {
+    dns_cache_module_init();
+
     return (0);
 }
 
@@ -1423,6 +2470,14 @@ int socket_open_raw(struct socket_t *self_p)
     return (-ENOSYS);
 }
 
+int socket_open(struct socket_t *self_p,
+                int domain,
+                int type,
+                int protocol)
+{
+    return (-ENOSYS);
+}
+
 int socket_close(struct socket_t *self_p)
 {
     return (-ENOSYS);
@@ -1492,6 +2547,25 @@ ssize_t socket_read(struct socket_t *self_p,
     return (socket_recvfrom(self_p, buf_p, size, 0, NULL));
 }
 
+ssize_t socket_writev(struct socket_t *self_p,
+                      const struct iov_t *iov_p,
+                      size_t length)
+{
+    return (-ENOSYS);
+}
+
+ssize_t socket_recv_pbuf(struct socket_t *self_p,
+                         struct pbuf **pbuf_pp)
+{
+    return (-ENOSYS);
+}
+
+int socket_release(struct socket_t *self_p,
+                   struct pbuf *pbuf_p)
+{
+    return (-ENOSYS);
+}
+
 ssize_t socket_size(struct socket_t *self_p)
 {
     ASSERTN(self_p != NULL, EINVAL);
@@ -1499,4 +2573,254 @@ ssize_t socket_size(struct socket_t *self_p)
     return (-ENOSYS);
 }
 
+static int socket_revents_isr(struct socket_t *self_p)
+{
+    return (SOCKET_POLLERR);
+}
+
 #endif
+
+int socket_connect_by_hostname(struct socket_t *self_p,
+                               const char *hostname_p,
+                               uint16_t port)
+{
+    ASSERTN(self_p != NULL, EINVAL);
+    ASSERTN(hostname_p != NULL, EINVAL);
+
+    int res;
+    struct inet_addr_t remote_addr;
+
+    res = socket_gethostbyname(hostname_p, &remote_addr.ip);
+
+    if (res != 0) {
+        return (res);
+    }
+
+    remote_addr.port = port;
+
+    return (socket_connect(self_p, &remote_addr));
+}
+
+int socket_gethostbyname(const char *hostname_p,
+                         struct inet_ip_addr_t *ip_p)
+{
+    ASSERTN(hostname_p != NULL, EINVAL);
+    ASSERTN(ip_p != NULL, EINVAL);
+
+    int res;
+    uint32_t now;
+    struct dns_cache_entry_t *entry_p;
+
+    /* Addresses in dotted decimal notation need no lookup. */
+    if (inet_aton(hostname_p, ip_p) == 0) {
+        return (0);
+    }
+
+    now = dns_cache_now();
+    sem_take(&dns_cache.sem, NULL);
+    entry_p = dns_cache_find(hostname_p, now);
+
+    if (entry_p != NULL) {
+        res = entry_p->res;
+
+        if (res == 0) {
+            *ip_p = entry_p->ip;
+        }
+    }
+
+    sem_give(&dns_cache.sem, 1);
+
+    if (entry_p != NULL) {
+        return (res);
+    }
+
+    res = dns_lookup(hostname_p, ip_p);
+
+    /* Only cache answers, not local failures. */
+    if ((res == 0) || (res == -EHOSTUNREACH)) {
+        sem_take(&dns_cache.sem, NULL);
+        dns_cache_save(hostname_p, ip_p, res, dns_cache_now());
+        sem_give(&dns_cache.sem, 1);
+    }
+
+    return (res);
+}
+
+int socket_dns_cache_flush(void)
+{
+    int i;
+
+    sem_take(&dns_cache.sem, NULL);
+
+    for (i = 0; i < membersof(dns_cache.entries); i++) {
+        dns_cache.entries[i].hostname[0] = '\0';
+    }
+
+    sem_give(&dns_cache.sem, 1);
+
+    return (0);
+}
+
+/**
+ * Update the returned events of all given channels.
+ *
+ * @return Number of channels with returned events.
+ */
+static int poll_scan_isr(struct socket_pollfd_t *fds_p, size_t length)
+{
+    struct chan_t *chan_p;
+    size_t i;
+    int revents;
+    int res;
+
+    res = 0;
+
+    for (i = 0; i < length; i++) {
+        chan_p = fds_p[i].chan_p;
+
+        if (chan_p->size == (chan_size_fn_t)socket_size) {
+            revents = socket_revents_isr(fds_p[i].chan_p);
+        } else {
+            /* Writes to other channels block until completed. */
+            revents = SOCKET_POLLOUT;
+
+            if (chan_p->size(chan_p) > 0) {
+                revents |= SOCKET_POLLIN;
+            }
+        }
+
+        /* Errors and hangups are always reported. */
+        revents &= (fds_p[i].events | SOCKET_POLLERR | SOCKET_POLLHUP);
+        fds_p[i].revents = revents;
+
+        if (revents != 0) {
+            res++;
+        }
+    }
+
+    return (res);
+}
+
+int socket_poll(struct socket_pollfd_t *fds_p,
+                size_t length,
+                const struct time_t *timeout_p)
+{
+    ASSERTN(fds_p != NULL, EINVAL);
+    ASSERTN(length > 0, EINVAL);
+    ASSERTN(length <= CONFIG_SOCKET_POLL_MAX, EINVAL);
+
+    struct chan_list_t list;
+    struct chan_list_elem_t elements[CONFIG_SOCKET_POLL_MAX];
+    struct chan_t *chan_p;
+    struct time_t deadline;
+    struct time_t remaining;
+    struct time_t *remaining_p;
+    size_t i;
+    int res;
+
+    chan_list_init(&list, &elements[0], length);
+
+    for (i = 0; i < length; i++) {
+        chan_list_add(&list, fds_p[i].chan_p);
+    }
+
+    remaining_p = NULL;
+
+    if (timeout_p != NULL) {
+        remaining = *timeout_p;
+        time_get(&deadline);
+        time_add(&deadline, &deadline, &remaining);
+        remaining_p = &remaining;
+    }
+
+    while (1) {
+        /* Wakeups for unrequested events must not extend the
+           timeout. */
+        if (timeout_p != NULL) {
+            time_get(&remaining);
+            time_subtract(&remaining, &deadline, &remaining);
+
+            if (remaining.seconds < 0) {
+                remaining.seconds = 0;
+                remaining.nanoseconds = 0;
+            }
+        }
+
+        sys_lock();
+
+        res = poll_scan_isr(fds_p, length);
+
+        if (res > 0) {
+            break;
+        }
+
+        /* Add the thread as a reader on all channels. Any channel
+           event resumes it, and the events are checked again. */
+        for (i = 0; i < length; i++) {
+            chan_p = fds_p[i].chan_p;
+            chan_p->reader_p = thrd_self();
+            chan_p->list_p = &list;
+        }
+
+        if (thrd_suspend_isr(remaining_p) == -ETIMEDOUT) {
+            for (i = 0; i < length; i++) {
+                chan_p = fds_p[i].chan_p;
+                chan_p->reader_p = NULL;
+                chan_p->list_p = NULL;
+            }
+
+            res = 0;
+            break;
+        }
+
+        sys_unlock();
+    }
+
+    sys_unlock();
+
+    return (res);
+}
+
+int socket_set_timeout(struct socket_t *self_p,
+                       int operation,
+                       const struct time_t *timeout_p)
+{
+    ASSERTN(self_p != NULL, EINVAL);
+
+    struct time_t *dst_p;
+
+    switch (operation) {
+
+    case SOCKET_TIMEOUT_RECV:
+        dst_p = &self_p->options.recv_timeout;
+        break;
+
+    case SOCKET_TIMEOUT_SEND:
+        dst_p = &self_p->options.send_timeout;
+        break;
+
+    case SOCKET_TIMEOUT_CONNECT:
+        dst_p = &self_p->options.connect_timeout;
+        break;
+
+    default:
+        return (-EINVAL);
+    }
+
+    if (timeout_p != NULL) {
+        *dst_p = *timeout_p;
+    } else {
+        dst_p->seconds = -1;
+    }
+
+    return (0);
+}
+
+int socket_set_nonblocking(struct socket_t *self_p, int enabled)
+{
+    ASSERTN(self_p != NULL, EINVAL);
+
+    self_p->options.nonblocking = (enabled ? 1 : 0);
+
+    return (0);
+}
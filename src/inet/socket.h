@@ -32,6 +32,7 @@
 #include "simba.h"
 
 #define SOCKET_DOMAIN_INET     0
+#define SOCKET_DOMAIN_AF_INET  SOCKET_DOMAIN_INET
 
 /** TCP socket type. */
 #define SOCKET_TYPE_STREAM     1
@@ -44,6 +45,29 @@
 
 #define SOCKET_PROTO_ICMP      0
 
+/** Data is available to read, a connection is ready to be accepted
+    or the remote peer closed the connection. */
+#define SOCKET_POLLIN          0x01
+
+/** Data can be written without waiting for send buffer space. */
+#define SOCKET_POLLOUT         0x02
+
+/** An error occured, for example a connection reset. Always
+    reported. */
+#define SOCKET_POLLERR         0x04
+
+/** The connection has been closed. Always reported. */
+#define SOCKET_POLLHUP         0x08
+
+/** Timeout of receive and accept operations. */
+#define SOCKET_TIMEOUT_RECV    0
+
+/** Timeout of send operations waiting for send buffer space. */
+#define SOCKET_TIMEOUT_SEND    1
+
+/** Timeout of connect operations. */
+#define SOCKET_TIMEOUT_CONNECT 2
+
 struct socket_t {
     struct chan_t base;
     int type;
@@ -77,9 +101,28 @@ struct socket_t {
             struct thrd_t *thrd_p;
         } cb;
     } output;
+    struct {
+        int nonblocking;
+        /* Negative seconds to wait forever. */
+        struct time_t recv_timeout;
+        struct time_t send_timeout;
+        struct time_t connect_timeout;
+    } options;
     void *pcb_p;
 };
 
+/**
+ * A channel and its events to wait for in ``socket_poll()``.
+ */
+struct socket_pollfd_t {
+    /** Socket or any other channel. */
+    void *chan_p;
+    /** Requested events. */
+    int events;
+    /** Returned events. */
+    int revents;
+};
+
 /**
  * Initialize the socket module. This function will start the lwIP
  * TCP/IP stack. This function must be called before calling any other
@@ -187,6 +230,8 @@ int socket_connect(struct socket_t *self_p,
  * and that is used to identify the device in various forms of
  * electronic communication, such as the World Wide Web.
  *
+ * The hostname is resolved with socket_gethostbyname().
+ *
  * @param[in] self_p Socket.
  * @param[in] hostname_p The hostname of the remote device to connect
  *                       to.
@@ -198,6 +243,32 @@ int socket_connect_by_hostname(struct socket_t *self_p,
                                const char *hostname_p,
                                uint16_t port);
 
+/**
+ * Resolve given hostname to an IPv4 address. Addresses in dotted
+ * decimal notation are converted without a lookup. Other hostnames
+ * are looked up with DNS, and the result is kept in a small cache
+ * for `CONFIG_SOCKET_DNS_CACHE_TTL` seconds. Hostnames that could
+ * not be resolved are cached as well, for
+ * `CONFIG_SOCKET_DNS_CACHE_NEGATIVE_TTL` seconds, so that repeated
+ * attempts to reach a missing host fail fast.
+ *
+ * @param[in] hostname_p Hostname to resolve.
+ * @param[out] ip_p Resolved address.
+ *
+ * @return zero(0) or negative error code. -EHOSTUNREACH if the
+ *         hostname could not be resolved.
+ */
+int socket_gethostbyname(const char *hostname_p,
+                         struct inet_ip_addr_t *ip_p);
+
+/**
+ * Remove all entries from the DNS cache, both resolved and failed
+ * lookups.
+ *
+ * @return zero(0) or negative error code.
+ */
+int socket_dns_cache_flush(void);
+
 /**
  * Accept a client connect attempt. Only applicable for TCP sockets
  * that are listening for connections.
@@ -274,6 +345,111 @@ ssize_t socket_read(struct socket_t *self_p,
                     void *buf_p,
                     size_t size);
 
+/**
+ * Write the data in given io vector to given TCP or UDP socket. All
+ * elements are queued in the TCP/IP stack in a single call into the
+ * stack thread, which avoids assembling a frame in an intermediate
+ * buffer. For UDP sockets the elements are sent, without being
+ * copied, as a single datagram to the address given to
+ * ``socket_connect()``.
+ *
+ * @param[in] self_p Socket.
+ * @param[in] iov_p Io vector of buffers to send.
+ * @param[in] length Number of elements in the io vector.
+ *
+ * @return Number of written bytes or negative error code.
+ */
+ssize_t socket_writev(struct socket_t *self_p,
+                      const struct iov_t *iov_p,
+                      size_t length);
+
+/**
+ * Wait for data on given TCP socket and take ownership of the
+ * received lwIP pbuf chain, instead of copying the data to a
+ * buffer. The data is acknowledged to the remote peer first when the
+ * chain is released with ``socket_release()``, which must be called
+ * once the data has been consumed.
+ *
+ * @param[in] self_p Socket.
+ * @param[out] pbuf_pp Received pbuf chain.
+ *
+ * @return Number of bytes in the chain, zero(0) if the socket is
+ *         closed or negative error code.
+ */
+ssize_t socket_recv_pbuf(struct socket_t *self_p,
+                         struct pbuf **pbuf_pp);
+
+/**
+ * Release given pbuf chain received with ``socket_recv_pbuf()``. Must
+ * be called from the reading thread.
+ *
+ * @param[in] self_p Socket the chain was received on.
+ * @param[in] pbuf_p Pbuf chain to release.
+ *
+ * @return zero(0) or negative error code.
+ */
+int socket_release(struct socket_t *self_p,
+                   struct pbuf *pbuf_p);
+
+/**
+ * Wait for events on given sockets and channels, or a timeout. The
+ * channels may be any mix of sockets, queues, UARTs and other
+ * channels. Other channels than sockets only report
+ * ``SOCKET_POLLIN`` if data is available, and are always writable.
+ *
+ * A channel polled with this function must not be in a channel poll
+ * set, and must not be polled by other threads.
+ *
+ * @param[in,out] fds_p Channels and requested events. The returned
+ *                      events are written to the revents member.
+ * @param[in] length Number of channels. At most
+ *                   ``CONFIG_SOCKET_POLL_MAX``.
+ * @param[in] timeout_p Time to wait for an event before a timeout
+ *                      occurs. Set to NULL to wait forever.
+ *
+ * @return Number of channels with returned events, zero(0) on
+ *         timeout or negative error code.
+ */
+int socket_poll(struct socket_pollfd_t *fds_p,
+                size_t length,
+                const struct time_t *timeout_p);
+
+/**
+ * Set the time to wait for given operation to complete. An operation
+ * that does not complete in time fails with ``-ETIMEDOUT``, unless
+ * some data was already received or sent, in which case the number
+ * of transferred bytes is returned. A TCP connect attempt that times
+ * out is aborted. The timeouts of an accepted socket are initially
+ * infinite.
+ *
+ * @param[in] self_p Socket.
+ * @param[in] operation One of ``SOCKET_TIMEOUT_RECV``,
+ *                      ``SOCKET_TIMEOUT_SEND`` and
+ *                      ``SOCKET_TIMEOUT_CONNECT``.
+ * @param[in] timeout_p Timeout, or NULL to wait forever.
+ *
+ * @return zero(0) or negative error code.
+ */
+int socket_set_timeout(struct socket_t *self_p,
+                       int operation,
+                       const struct time_t *timeout_p);
+
+/**
+ * Enable or disable non-blocking mode of given socket. Operations
+ * that would have to wait instead fail with ``-EAGAIN``, or return
+ * the number of already transferred bytes. A TCP connect returns
+ * ``-EINPROGRESS`` and continues in the background. Use
+ * ``socket_poll()`` to wait for the socket to become writable once
+ * connected.
+ *
+ * @param[in] self_p Socket.
+ * @param[in] enabled One(1) to enable non-blocking mode, zero(0) to
+ *                    disable it.
+ *
+ * @return zero(0) or negative error code.
+ */
+int socket_set_nonblocking(struct socket_t *self_p, int enabled);
+
 /**
  * Get the number of input bytes currently stored in the socket. May
  * return less bytes than number of bytes stored in the channel.
@@ -39,37 +39,107 @@
 #include "mbedtls/error.h"
 #include "mbedtls/debug.h"
 #include "mbedtls/timing.h"
+#include "mbedtls/ssl_ticket.h"
+
+/* Client side session resumption needs mbedTLS session support. */
+#if (CONFIG_SSL_SESSION_CACHE_MAX > 0) && defined(MBEDTLS_SSL_CLI_C)
+#    define SESSION_CACHE 1
+#else
+#    define SESSION_CACHE 0
+#endif
+
+#if (CONFIG_SSL_SESSION_TICKETS == 1)           \
+    && defined(MBEDTLS_SSL_SESSION_TICKETS)     \
+    && defined(MBEDTLS_SSL_TICKET_C)            \
+    && defined(MBEDTLS_SSL_SRV_C)
+#    define SESSION_TICKETS 1
+#else
+#    define SESSION_TICKETS 0
+#endif
+
+#if CONFIG_SSL_MAX_FRAGMENT_LENGTH == 0
+#elif CONFIG_SSL_MAX_FRAGMENT_LENGTH == 512
+#    define MAX_FRAG_LEN MBEDTLS_SSL_MAX_FRAG_LEN_512
+#elif CONFIG_SSL_MAX_FRAGMENT_LENGTH == 1024
+#    define MAX_FRAG_LEN MBEDTLS_SSL_MAX_FRAG_LEN_1024
+#elif CONFIG_SSL_MAX_FRAGMENT_LENGTH == 2048
+#    define MAX_FRAG_LEN MBEDTLS_SSL_MAX_FRAG_LEN_2048
+#elif CONFIG_SSL_MAX_FRAGMENT_LENGTH == 4096
+#    define MAX_FRAG_LEN MBEDTLS_SSL_MAX_FRAG_LEN_4096
+#else
+#    error "CONFIG_SSL_MAX_FRAGMENT_LENGTH must be 0, 512, 1024, 2048 or 4096."
+#endif
+
+#if SESSION_CACHE == 1
+
+/* A cached client side session. */
+struct session_cache_entry_t {
+    int valid;
+    char hostname[CONFIG_SSL_SESSION_CACHE_HOSTNAME_MAX];
+    mbedtls_ssl_session session;
+};
+
+#endif
 
 struct module_t {
     int8_t initialized;
     mbedtls_entropy_context entropy;
     mbedtls_ctr_drbg_context ctr_drbg;
-    mbedtls_ssl_context ssl;
-    int ssl_allocated;
+    struct {
+        mbedtls_ssl_context ssl;
+        int allocated;
+    } sockets[CONFIG_SSL_SOCKETS_MAX];
     mbedtls_ssl_config conf;
     int conf_allocated;
     mbedtls_x509_crt cert;
     mbedtls_pk_context key;
     mbedtls_x509_crt ca_certs;
     mbedtls_timing_delay_context timer;
+#if SESSION_CACHE == 1
+    struct {
+        struct session_cache_entry_t entries[CONFIG_SSL_SESSION_CACHE_MAX];
+        int next;
+    } session_cache;
+#endif
+#if SESSION_TICKETS == 1
+    mbedtls_ssl_ticket_context ticket;
+#endif
 };
 
 static struct module_t module;
 
 static void *alloc_ssl(void)
 {
-    if (module.ssl_allocated == 1) {
-        return (NULL);
+    void *ssl_p;
+    int i;
+
+    ssl_p = NULL;
+
+    /* Sockets may be opened by several threads. */
+    sys_lock();
+
+    for (i = 0; i < membersof(module.sockets); i++) {
+        if (module.sockets[i].allocated == 0) {
+            module.sockets[i].allocated = 1;
+            ssl_p = &module.sockets[i].ssl;
+            break;
+        }
     }
 
-    module.ssl_allocated = 1;
+    sys_unlock();
 
-    return (&module.ssl);
+    return (ssl_p);
 }
 
 static void free_ssl(void *ssl_p)
 {
-    module.ssl_allocated = 0;
+    int i;
+
+    for (i = 0; i < membersof(module.sockets); i++) {
+        if (&module.sockets[i].ssl == ssl_p) {
+            module.sockets[i].allocated = 0;
+        }
+    }
 }
 
 static void *alloc_conf(void)
@@ -88,6 +158,78 @@ static void free_conf(void *conf_p)
     module.conf_allocated = 0;
 }
 
+#if SESSION_CACHE == 1
+
+/**
+ * Find the cached session of given server hostname.
+ */
+static struct session_cache_entry_t *
+session_cache_find(const char *server_hostname_p)
+{
+    int i;
+    struct session_cache_entry_t *entry_p;
+
+    for (i = 0; i < membersof(module.session_cache.entries); i++) {
+        entry_p = &module.session_cache.entries[i];
+
+        if ((entry_p->valid == 1)
+            && (strcmp(&entry_p->hostname[0], server_hostname_p) == 0)) {
+            return (entry_p);
+        }
+    }
+
+    return (NULL);
+}
+
+/**
+ * Remove given entry from the session cache.
+ */
+static void session_cache_remove(struct session_cache_entry_t *entry_p)
+{
+    mbedtls_ssl_session_free(&entry_p->session);
+    entry_p->valid = 0;
+}
+
+/**
+ * Save the session of given handshaked SSL context in the cache,
+ * replacing any previous session of the same server, or else the
+ * oldest entry.
+ */
+static void session_cache_save(mbedtls_ssl_context *ssl_p,
+                               const char *server_hostname_p)
+{
+    struct session_cache_entry_t *entry_p;
+
+    if (strlen(server_hostname_p) >= CONFIG_SSL_SESSION_CACHE_HOSTNAME_MAX) {
+        return;
+    }
+
+    entry_p = session_cache_find(server_hostname_p);
+
+    if (entry_p == NULL) {
+        entry_p = &module.session_cache.entries[module.session_cache.next];
+        module.session_cache.next++;
+        module.session_cache.next %= membersof(module.session_cache.entries);
+    }
+
+    if (entry_p->valid == 1) {
+        session_cache_remove(entry_p);
+    }
+
+    mbedtls_ssl_session_init(&entry_p->session);
+
+    if (mbedtls_ssl_get_session(ssl_p, &entry_p->session) != 0) {
+        mbedtls_ssl_session_free(&entry_p->session);
+
+        return;
+    }
+
+    strcpy(&entry_p->hostname[0], server_hostname_p);
+    entry_p->valid = 1;
+}
+
+#endif
+
 static int ssl_send(void *ctx_p,
                     const unsigned char *buf_p,
                     size_t len)
@@ -102,6 +244,34 @@ static int ssl_recv(void *ctx_p,
     return (socket_read(ctx_p, buf_p, len));
 }
 
+#if CONFIG_SSL_HARDWARE_ENTROPY == 1
+
+/**
+ * Entropy source reading the hardware random number generator.
+ */
+static int hardware_entropy_poll(void *data_p,
+                                 unsigned char *output_p,
+                                 size_t len,
+                                 size_t *olen_p)
+{
+    uint32_t value;
+    size_t size;
+
+    *olen_p = len;
+
+    while (len > 0) {
+        value = random_read();
+        size = MIN(len, sizeof(value));
+        memcpy(output_p, &value, size);
+        output_p += size;
+        len -= size;
+    }
+
+    return (0);
+}
+
+#endif
+
 int ssl_module_init()
 {
     /* Return immediately if the module is already initialized. */
@@ -114,6 +284,20 @@ int ssl_module_init()
     mbedtls_entropy_init(&module.entropy);
     mbedtls_ctr_drbg_init(&module.ctr_drbg);
 
+#if CONFIG_SSL_HARDWARE_ENTROPY == 1
+    if (random_module_init() != 0) {
+        return (-1);
+    }
+
+    if (mbedtls_entropy_add_source(&module.entropy,
+                                   hardware_entropy_poll,
+                                   NULL,
+                                   32,
+                                   MBEDTLS_ENTROPY_SOURCE_STRONG) != 0) {
+        return (-1);
+    }
+#endif
+
     /* Random generator seed initialization. */
     if (mbedtls_ctr_drbg_seed(&module.ctr_drbg,
                               mbedtls_entropy_func,
@@ -148,6 +332,7 @@ int ssl_context_init(struct ssl_context_t *self_p,
 
     self_p->server_side = -1;
     self_p->verify_mode = -1;
+    self_p->ticket_p = NULL;
 
     return (0);
 }
@@ -157,6 +342,13 @@ int ssl_context_destroy(struct ssl_context_t *self_p)
     ASSERTN(self_p != NULL, EINVAL);
     ASSERTN(self_p->conf_p != NULL, EINVAL);
 
+#if SESSION_TICKETS == 1
+    if (self_p->ticket_p != NULL) {
+        mbedtls_ssl_ticket_free(self_p->ticket_p);
+        self_p->ticket_p = NULL;
+    }
+#endif
+
     free_conf(self_p->conf_p);
 
     return (0);
@@ -244,6 +436,11 @@ int ssl_socket_open(struct ssl_socket_t *self_p,
     int res;
     int authmode;
     int server_side;
+#if SESSION_CACHE == 1
+    struct session_cache_entry_t *entry_p;
+
+    entry_p = NULL;
+#endif
 
     server_side = (flags & SSL_SOCKET_SERVER_SIDE);
     
@@ -265,6 +462,40 @@ int ssl_socket_open(struct ssl_socket_t *self_p,
             mbedtls_ssl_conf_authmode(context_p->conf_p, context_p->verify_mode);
         }
 
+#if defined(MAX_FRAG_LEN) && defined(MBEDTLS_SSL_MAX_FRAGMENT_LENGTH)
+        /* Ask the server for records that fit in the reduced record
+           buffers. Servers only answer the request of the client. */
+        if (server_side == 0) {
+            if (mbedtls_ssl_conf_max_frag_len(context_p->conf_p,
+                                              MAX_FRAG_LEN) != 0) {
+                return (-1);
+            }
+        }
+#endif
+
+#if SESSION_TICKETS == 1
+        /* Issue session tickets so clients can resume their sessions
+           without the asymmetric crypto. Full handshakes are still
+           possible if the ticket key cannot be created. */
+        if (server_side == SSL_SOCKET_SERVER_SIDE) {
+            mbedtls_ssl_ticket_init(&module.ticket);
+
+            if (mbedtls_ssl_ticket_setup(&module.ticket,
+                                         mbedtls_ctr_drbg_random,
+                                         &module.ctr_drbg,
+                                         MBEDTLS_CIPHER_AES_256_GCM,
+                                         CONFIG_SSL_SESSION_TICKET_LIFETIME_S) == 0) {
+                mbedtls_ssl_conf_session_tickets_cb(context_p->conf_p,
+                                                    mbedtls_ssl_ticket_write,
+                                                    mbedtls_ssl_ticket_parse,
+                                                    &module.ticket);
+                context_p->ticket_p = &module.ticket;
+            } else {
+                mbedtls_ssl_ticket_free(&module.ticket);
+            }
+        }
+#endif
+
         context_p->server_side = server_side;
     } else if (context_p->server_side != server_side) {
         return (-1);
@@ -283,6 +514,7 @@ int ssl_socket_open(struct ssl_socket_t *self_p,
               (chan_read_fn_t)ssl_socket_read,
               (chan_write_fn_t)ssl_socket_write,
               (chan_size_fn_t)ssl_socket_size);
+    chan_set_writev_cb(&self_p->base, (chan_writev_fn_t)ssl_socket_writev);
 
     /* Inilialize the SSL session. */
     mbedtls_ssl_init(self_p->ssl_p);
@@ -306,13 +538,34 @@ int ssl_socket_open(struct ssl_socket_t *self_p,
                                          server_hostname_p) != 0) {
                 goto err2;
             }
+
+#if SESSION_CACHE == 1
+            /* Try to resume the previous session with the server. */
+            entry_p = session_cache_find(server_hostname_p);
+
+            if (entry_p != NULL) {
+                if (mbedtls_ssl_set_session(self_p->ssl_p,
+                                            &entry_p->session) != 0) {
+                    session_cache_remove(entry_p);
+                    entry_p = NULL;
+                }
+            }
+#endif
         }
     }
-    
+
     /* Perform the handshake with the remote peer. */
     res = mbedtls_ssl_handshake(self_p->ssl_p);
 
     if (res != 0) {
+#if SESSION_CACHE == 1
+        /* Do not offer a session the server might have rejected
+           again. */
+        if (entry_p != NULL) {
+            session_cache_remove(entry_p);
+        }
+#endif
+
         goto err2;
     }
 
@@ -327,6 +580,14 @@ int ssl_socket_open(struct ssl_socket_t *self_p,
         }
     }
 
+#if SESSION_CACHE == 1
+    /* Save the session, which may have a new ticket, for the next
+       connection to the same server. */
+    if ((server_side == 0) && (server_hostname_p != NULL)) {
+        session_cache_save(self_p->ssl_p, server_hostname_p);
+    }
+#endif
+
     return (0);
 
  err2:
@@ -360,6 +621,91 @@ ssize_t ssl_socket_write(struct ssl_socket_t *self_p,
     return (mbedtls_ssl_write(self_p->ssl_p, buf_p, size));
 }
 
+/**
+ * Write all of given buffer, which may be more than one TLS record.
+ */
+static ssize_t write_all(struct ssl_socket_t *self_p,
+                         const uint8_t *buf_p,
+                         size_t size)
+{
+    int res;
+    size_t left;
+
+    left = size;
+
+    while (left > 0) {
+        res = mbedtls_ssl_write(self_p->ssl_p, buf_p, left);
+
+        if (res < 0) {
+            return (res);
+        }
+
+        buf_p += res;
+        left -= res;
+    }
+
+    return (size);
+}
+
+ssize_t ssl_socket_writev(struct ssl_socket_t *self_p,
+                          const struct iov_t *iov_p,
+                          size_t length)
+{
+    ASSERTN(self_p != NULL, EINVAL);
+    ASSERTN(self_p->ssl_p != NULL, EINVAL);
+    ASSERTN((iov_p != NULL) || (length == 0), EINVAL);
+
+    uint8_t buf[CONFIG_SSL_WRITEV_BUFFER_SIZE];
+    size_t pos;
+    size_t size;
+    size_t i;
+    ssize_t res;
+
+    pos = 0;
+    size = 0;
+
+    for (i = 0; i < length; i++) {
+        /* Flush gathered buffers that the next one does not fit
+           with. */
+        if ((pos > 0) && (iov_p[i].size > sizeof(buf) - pos)) {
+            res = write_all(self_p, &buf[0], pos);
+
+            if (res < 0) {
+                return (res);
+            }
+
+            size += pos;
+            pos = 0;
+        }
+
+        /* Large buffers are written without copying them. */
+        if (iov_p[i].size >= sizeof(buf)) {
+            res = write_all(self_p, iov_p[i].buf_p, iov_p[i].size);
+
+            if (res < 0) {
+                return (res);
+            }
+
+            size += iov_p[i].size;
+        } else {
+            memcpy(&buf[pos], iov_p[i].buf_p, iov_p[i].size);
+            pos += iov_p[i].size;
+        }
+    }
+
+    if (pos > 0) {
+        res = write_all(self_p, &buf[0], pos);
+
+        if (res < 0) {
+            return (res);
+        }
+
+        size += pos;
+    }
+
+    return (size);
+}
+
 ssize_t ssl_socket_read(struct ssl_socket_t *self_p,
                         void *buf_p,
                         size_t size)
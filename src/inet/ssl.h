@@ -50,6 +50,7 @@ struct ssl_context_t {
     void *conf_p;
     int server_side;
     int verify_mode;
+    void *ticket_p;
 };
 
 struct ssl_socket_t {
@@ -143,7 +144,11 @@ int ssl_context_set_verify_mode(struct ssl_context_t *self_p,
  *                              side sockets to verify the
  *                              server. Give as NULL to skip the
  *                              verification. Must be NULL for server
- *                              side sockets.
+ *                              side sockets. Also the key of the
+ *                              session cache, so a client side
+ *                              socket resumes the previous session
+ *                              with the same server, see
+ *                              ``CONFIG_SSL_SESSION_CACHE_MAX``.
  *
  * @return zero(0) or negative error code.
  */
@@ -175,6 +180,22 @@ ssize_t ssl_socket_write(struct ssl_socket_t *self_p,
                          const void *buf_p,
                          size_t size);
 
+/**
+ * Write the buffers in given io vector to given SSL socket. Small
+ * buffers are copied to a buffer of ``CONFIG_SSL_WRITEV_BUFFER_SIZE``
+ * bytes on the stack and sent in one TLS record, instead of one
+ * record per buffer.
+ *
+ * @param[in] self_p SSL socket.
+ * @param[in] iov_p Io vector of buffers to send.
+ * @param[in] length Number of elements in the io vector.
+ *
+ * @return Number of written bytes or negative error code.
+ */
+ssize_t ssl_socket_writev(struct ssl_socket_t *self_p,
+                          const struct iov_t *iov_p,
+                          size_t length);
+
 /**
  * Read data from given SSL socket.
  *
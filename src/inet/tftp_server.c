@@ -34,6 +34,7 @@
 #define OPCODE_DATA                                        3
 #define OPCODE_ACKNOWLEDGMENT                              4
 #define OPCODE_ERROR                                       5
+#define OPCODE_OPTION_ACKNOWLEDGMENT                       6
 
 /* Error codes. */
 #define ERROR_NOT_DEFINED                                  0
@@ -44,7 +45,8 @@
 #define ERROR_UNKNOWN_TRANSFER_ID                          5
 #define ERROR_FILE_ALREADY_EXISTS                          6
 #define ERROR_NO_SUCH_USER                                 7
-#define ERROR_CODE_MAX                                     8
+#define ERROR_OPTION_NEGOTIATION                           8
+#define ERROR_CODE_MAX                                     9
 
 /* Protocol acces macros. */
 #define OPCODE(buf_p)           ((buf_p[0] << 8) | buf_p[1])
@@ -53,7 +55,18 @@
 
 /* Sizes. */
 #define DATA_SIZE                                        512
-#define BUFFER_SIZE                          (DATA_SIZE + 4)
+#define BLKSIZE_MIN                                        8
+
+#if CONFIG_TFTP_SERVER_BLKSIZE_MAX > DATA_SIZE
+#    define BUFFER_SIZE         (CONFIG_TFTP_SERVER_BLKSIZE_MAX + 4)
+#else
+#    define BUFFER_SIZE                      (DATA_SIZE + 4)
+#endif
+
+/* Negotiated options. */
+#define OPTION_BLKSIZE                                  0x01
+#define OPTION_WINDOWSIZE                               0x02
+#define OPTION_TSIZE                                    0x04
 
 struct client_t {
     struct tftp_server_t *server_p;
@@ -63,7 +76,18 @@ struct client_t {
     const char *filename_p;
     uint32_t number_of_bytes_transferred;
     struct {
-        uint16_t block_number;
+        int flags;
+        int blksize;
+        int windowsize;
+        long tsize;
+    } options;
+    struct {
+        /* Absolute number of the first block in the window, not
+           wrapped at 16 bits like the block number on the wire. */
+        uint32_t block;
+        /* Number of blocks sent in the current window. */
+        int count;
+        /* Size of the last block sent or received. */
         ssize_t size;
         int retransmit_counter;
     } data;
@@ -78,6 +102,7 @@ static const char *error_code_str[ERROR_CODE_MAX + 1] = {
     "unknown transfer id",
     "file already exists",
     "no such user",
+    "option negotiation failed",
     "invalid error code"
 };
 
@@ -106,12 +131,76 @@ static int find_string(const char **buf_pp,
     return (0);
 }
 
-static int parse_request(const char *buf_p,
+/**
+ * Case insensitive string comparison, as option names are case
+ * insensitive.
+ */
+static int option_name_equal(const char *name_p, const char *reference_p)
+{
+    while (tolower((int)*name_p) == *reference_p) {
+        if (*name_p == '\0') {
+            return (1);
+        }
+
+        name_p++;
+        reference_p++;
+    }
+
+    return (0);
+}
+
+/**
+ * Parse given option and save its value in the client, if supported
+ * and valid. Unsupported options are ignored, as mandated by RFC
+ * 2347.
+ */
+static void parse_option(struct client_t *self_p,
+                         const char *name_p,
+                         const char *value_p)
+{
+    long value;
+
+    if (std_strtol(value_p, &value) == NULL) {
+        return;
+    }
+
+    if (option_name_equal(name_p, "blksize")) {
+        /* RFC 2348. */
+        if ((value < BLKSIZE_MIN) || (value > 65464)) {
+            return;
+        }
+
+        self_p->options.blksize = MIN(value, CONFIG_TFTP_SERVER_BLKSIZE_MAX);
+        self_p->options.flags |= OPTION_BLKSIZE;
+    } else if (option_name_equal(name_p, "windowsize")) {
+        /* RFC 7440. */
+        if ((value < 1) || (value > 65535)) {
+            return;
+        }
+
+        self_p->options.windowsize = MIN(value,
+                                         CONFIG_TFTP_SERVER_WINDOWSIZE_MAX);
+        self_p->options.flags |= OPTION_WINDOWSIZE;
+    } else if (option_name_equal(name_p, "tsize")) {
+        /* RFC 2349. */
+        if (value < 0) {
+            return;
+        }
+
+        self_p->options.tsize = value;
+        self_p->options.flags |= OPTION_TSIZE;
+    }
+}
+
+static int parse_request(struct client_t *self_p,
+                         const char *buf_p,
                          size_t size,
-                         const char **filename_pp,
                          const char **mode_pp)
 {
-    if (find_string(&buf_p, &size, filename_pp) != 0) {
+    const char *name_p;
+    const char *value_p;
+
+    if (find_string(&buf_p, &size, &self_p->filename_p) != 0) {
         return (-1);
     }
 
@@ -119,6 +208,15 @@ static int parse_request(const char *buf_p,
         return (-1);
     }
 
+    /* Options as name and value pairs, if any. */
+    while (find_string(&buf_p, &size, &name_p) == 0) {
+        if (find_string(&buf_p, &size, &value_p) != 0) {
+            return (-1);
+        }
+
+        parse_option(self_p, name_p, value_p);
+    }
+
     return (0);
 }
 
@@ -154,19 +252,80 @@ static int error_transmit(struct tftp_server_t *server_p,
     return (0);
 }
 
-static int client_data_write(struct client_t *self_p)
+/**
+ * Append given option name and value, both null terminated, to given
+ * buffer.
+ *
+ * @return Number of bytes added to the buffer.
+ */
+static size_t format_option(char *buf_p,
+                            const char *name_p,
+                            unsigned long value)
+{
+    size_t size;
+
+    strcpy(buf_p, name_p);
+    size = (strlen(name_p) + 1);
+    size += (std_sprintf(&buf_p[size], FSTR("%lu"), value) + 1);
+
+    return (size);
+}
+
+/**
+ * Write an option acknowledgement packet with all accepted options.
+ */
+static int client_oack_write(struct client_t *self_p)
+{
+    char *buf_p;
+    size_t size;
+
+    buf_p = (char *)self_p->buf_p;
+    buf_p[0] = 0;
+    buf_p[1] = OPCODE_OPTION_ACKNOWLEDGMENT;
+    size = 2;
+
+    if (self_p->options.flags & OPTION_BLKSIZE) {
+        size += format_option(&buf_p[size],
+                              "blksize",
+                              self_p->options.blksize);
+    }
+
+    if (self_p->options.flags & OPTION_WINDOWSIZE) {
+        size += format_option(&buf_p[size],
+                              "windowsize",
+                              self_p->options.windowsize);
+    }
+
+    if (self_p->options.flags & OPTION_TSIZE) {
+        size += format_option(&buf_p[size],
+                              "tsize",
+                              self_p->options.tsize);
+    }
+
+    if (socket_write(&self_p->socket, self_p->buf_p, size) != size) {
+        return (-1);
+    }
+
+    return (0);
+}
+
+/**
+ * Write one data packet with given block read from the file, which
+ * must be positioned at the start of the block.
+ */
+static int client_data_write(struct client_t *self_p, uint32_t block)
 {
     size_t size;
 
     self_p->buf_p[0] = 0;
     self_p->buf_p[1] = OPCODE_DATA;
-    self_p->buf_p[2] = (self_p->data.block_number >> 8);
-    self_p->buf_p[3] = self_p->data.block_number;
+    self_p->buf_p[2] = (block >> 8);
+    self_p->buf_p[3] = block;
     size = 4;
 
     self_p->data.size = fs_read(&self_p->file,
                                 &self_p->buf_p[4],
-                                DATA_SIZE);
+                                self_p->options.blksize);
 
     if (self_p->data.size < 0) {
         self_p->data.size = 0;
@@ -181,31 +340,73 @@ static int client_data_write(struct client_t *self_p)
     return (0);
 }
 
-static int client_data_transmit(struct client_t *self_p)
+/**
+ * Write the window of data packets starting at the first
+ * unacknowledged block, or the option acknowledgement if options were
+ * negotiated and the transfer has not yet started. The window ends
+ * early at the last, not full, block of the file.
+ */
+static int client_window_write(struct client_t *self_p)
 {
-    self_p->data.retransmit_counter = 0;
+    uint32_t block;
 
-    return (client_data_write(self_p));
-}
+    if (self_p->data.block == 0) {
+        return (client_oack_write(self_p));
+    }
 
-static int client_data_retransmit(struct client_t *self_p)
-{
-    if (fs_seek(&self_p->file, -self_p->data.size, FS_SEEK_CUR) != 0) {
+    block = self_p->data.block;
+
+    if (fs_seek(&self_p->file,
+                (block - 1) * self_p->options.blksize,
+                FS_SEEK_SET) != 0) {
         return (-1);
     }
 
+    for (self_p->data.count = 0;
+         self_p->data.count < self_p->options.windowsize;
+         self_p->data.count++) {
+        if (client_data_write(self_p, block) != 0) {
+            return (-1);
+        }
+
+        block++;
+
+        if (self_p->data.size < self_p->options.blksize) {
+            self_p->data.count++;
+            break;
+        }
+    }
+
+    return (0);
+}
+
+static int client_window_transmit(struct client_t *self_p)
+{
+    self_p->data.retransmit_counter = 0;
+
+    return (client_window_write(self_p));
+}
+
+static int client_window_retransmit(struct client_t *self_p)
+{
     self_p->data.retransmit_counter++;
 
-    return (client_data_write(self_p));
+    return (client_window_write(self_p));
 }
 
 static int client_ack_write(struct client_t *self_p)
 {
     uint16_t block_number;
 
-    /* Block number holds the value of the next expected block to
+    /* The option acknowledgement replaces the acknowledgement of
+       block zero. */
+    if ((self_p->data.block == 1) && (self_p->options.flags != 0)) {
+        return (client_oack_write(self_p));
+    }
+
+    /* Block holds the value of the next expected block to
        receive. */
-    block_number = (self_p->data.block_number - 1);
+    block_number = (self_p->data.block - 1);
 
     self_p->buf_p[0] = 0;
     self_p->buf_p[1] = OPCODE_ACKNOWLEDGMENT;
@@ -258,6 +459,8 @@ static int client_read_request_transfer_data(struct client_t *self_p)
 {
     int opcode;
     uint16_t block_number;
+    int acked;
+    int count;
     uint16_t error_code;
     struct time_t timeout;
     ssize_t size;
@@ -265,19 +468,19 @@ static int client_read_request_transfer_data(struct client_t *self_p)
     timeout.seconds = (self_p->server_p->timeout_ms / 1000);
     timeout.nanoseconds = 1000000L * (self_p->server_p->timeout_ms % 1000);
 
-    if (client_data_transmit(self_p) != 0) {
+    if (client_window_transmit(self_p) != 0) {
         return (-1);
     }
 
     while (1) {
         /* Waiting for acknowlegement or error. Retransmit outstanding
-           data packet on timeout, or bail. */
+           data packets on timeout, or bail. */
         if (chan_poll(&self_p->socket, &timeout) == NULL) {
             if (self_p->data.retransmit_counter == 2) {
                 return (-1);
             }
 
-            if (client_data_retransmit(self_p) != 0) {
+            if (client_window_retransmit(self_p) != 0) {
                 return (-1);
             }
 
@@ -299,34 +502,52 @@ static int client_read_request_transfer_data(struct client_t *self_p)
         case OPCODE_ACKNOWLEDGMENT:
             block_number = BLOCK_NUMBER(self_p->buf_p);
 
+            /* Number of acknowledged blocks in the window. The
+               option acknowledgement is acknowledged by block
+               zero. */
+            if (self_p->data.block == 0) {
+                acked = (block_number == 0 ? 1 : 0);
+                count = 1;
+            } else {
+                acked = (uint16_t)(block_number - self_p->data.block + 1);
+                count = self_p->data.count;
+            }
+
             /* Ignore bad acknowlegement packets. */
-            if (block_number != self_p->data.block_number) {
+            if ((acked == 0) || (acked > count)) {
                 log_object_print(NULL,
                                  LOG_DEBUG,
                                  OSTR("ignoring block number %u when"
                                       " expecting %u\r\n"),
                                  block_number,
-                                 self_p->data.block_number);
+                                 (uint16_t)(self_p->data.block + count - 1));
                 continue;
             }
 
-            self_p->number_of_bytes_transferred += self_p->data.size;
-
-            /* The last packet is not full. */
-            if (self_p->data.size < DATA_SIZE) {
-                log_object_print(NULL,
-                                 LOG_INFO,
-                                 OSTR("sent %u bytes\r\n"),
-                                 self_p->number_of_bytes_transferred);
-                return (0);
+            if (self_p->data.block > 0) {
+                self_p->number_of_bytes_transferred +=
+                    (acked * self_p->options.blksize);
+
+                /* The last packet is not full. */
+                if ((acked == count)
+                    && (self_p->data.size < self_p->options.blksize)) {
+                    self_p->number_of_bytes_transferred -=
+                        (self_p->options.blksize - self_p->data.size);
+                    log_object_print(NULL,
+                                     LOG_INFO,
+                                     OSTR("sent %u bytes\r\n"),
+                                     self_p->number_of_bytes_transferred);
+                    return (0);
+                }
             }
 
-            /* The block has been acknowleged. Increment the block
-               number for the next block. */
-            self_p->data.block_number++;
+            /* Slide the window past the acknowleged blocks. A partly
+               acknowledged window is retransmitted from the first
+               unacknowledged block, as in RFC 7440. */
+            self_p->data.block += acked;
 
-            /* Transmit next data packet. */
-            if (client_data_transmit(self_p) != 0) {
+            /* Transmit next window of data packets. */
+            if (client_window_transmit(self_p) != 0) {
                 return (-1);
             }
             break;
@@ -404,32 +625,56 @@ static int client_write_request_transfer_data(struct client_t *self_p)
         case OPCODE_DATA:
             block_number = BLOCK_NUMBER(self_p->buf_p);
 
-            /* Ignore bad data packets. */
-            if (block_number != self_p->data.block_number) {
+            /* Ignore bad data packets. Acknowledge the last received
+               block to make the client retransmit the rest of the
+               window, as in RFC 7440. */
+            if (block_number != (uint16_t)self_p->data.block) {
                 log_object_print(NULL,
                                  LOG_INFO,
                                  OSTR("ignoring block number %u when"
                                       " expecting %u\r\n"),
                                  block_number,
-                                 self_p->data.block_number);
+                                 (uint16_t)self_p->data.block);
+
+                if (self_p->options.windowsize > 1) {
+                    self_p->data.count = 0;
+
+                    if (client_ack_transmit(self_p) != 0) {
+                        return (-1);
+                    }
+                }
+
                 continue;
             }
 
-            if (fs_write(&self_p->file, &self_p->buf_p[4], size) != size) {
+            if (size > self_p->options.blksize) {
                 return (-1);
             }
 
-            self_p->data.block_number++;
-
-            /* Transmit ack packet. */
-            if (client_ack_transmit(self_p) != 0) {
+            if (fs_write(&self_p->file, &self_p->buf_p[4], size) != size) {
                 return (-1);
             }
 
+            self_p->data.block++;
+            self_p->data.count++;
             self_p->number_of_bytes_transferred += size;
 
+            /* Transmit ack packet at the end of the window or on the
+               last block. */
+            if ((self_p->data.count == self_p->options.windowsize)
+                || (size < self_p->options.blksize)) {
+                self_p->data.count = 0;
+
+                if (client_ack_transmit(self_p) != 0) {
+                    return (-1);
+                }
+            } else {
+                /* Restart the timeout from the window. */
+                self_p->data.retransmit_counter = 0;
+            }
+
             /* The last packet is not full. */
-            if (size < DATA_SIZE) {
+            if (size < self_p->options.blksize) {
                 log_object_print(NULL,
                                  LOG_INFO,
                                  OSTR("received %u bytes\r\n"),
@@ -474,10 +719,14 @@ static int client_open(struct client_t *self_p,
     const char *error_message_p;
 
     error_message_p = NULL;
+    self_p->options.flags = 0;
+    self_p->options.blksize = DATA_SIZE;
+    self_p->options.windowsize = 1;
+    self_p->options.tsize = 0;
 
-    if (parse_request((const char *)&buf_p[2],
+    if (parse_request(self_p,
+                      (const char *)&buf_p[2],
                       size - 2,
-                      &self_p->filename_p,
                       &mode_p) != 0) {
         error_message_p = "malformed request";
         goto err;
@@ -498,7 +747,8 @@ static int client_open(struct client_t *self_p,
 
     self_p->buf_p = buf_p;
     self_p->number_of_bytes_transferred = 0;
-    self_p->data.block_number = 1;
+    self_p->data.block = 1;
+    self_p->data.count = 0;
     self_p->server_p = server_p;
 
     return (0);
@@ -520,6 +770,26 @@ static int client_close(struct client_t *self_p)
     return (0);
 }
 
+/**
+ * Returns the size of given file, or negative error code.
+ */
+static long file_size(struct fs_file_t *file_p)
+{
+    long size;
+
+    if (fs_seek(file_p, 0, FS_SEEK_END) != 0) {
+        return (-1);
+    }
+
+    size = fs_tell(file_p);
+
+    if (fs_seek(file_p, 0, FS_SEEK_SET) != 0) {
+        return (-1);
+    }
+
+    return (size);
+}
+
 static int handle_read_request(struct tftp_server_t *self_p,
                                uint8_t *buf_p,
                                size_t size,
@@ -536,6 +806,20 @@ static int handle_read_request(struct tftp_server_t *self_p,
                              LOG_INFO,
                              OSTR("reading from '%s'\r\n"),
                              client.filename_p);
+
+            if (client.options.flags & OPTION_TSIZE) {
+                client.options.tsize = file_size(&client.file);
+
+                if (client.options.tsize < 0) {
+                    client.options.flags &= ~OPTION_TSIZE;
+                }
+            }
+
+            /* Block zero is the option acknowledgement. */
+            if (client.options.flags != 0) {
+                client.data.block = 0;
+            }
+
             res = client_read_request_transfer_data(&client);
             (void)fs_close(&client.file);
         } else {
@@ -134,6 +134,7 @@
  */
 
 #define INET_HTTP_WEBSOCKET_FIN  0x80
+#define INET_HTTP_WEBSOCKET_RSV1 0x40
 #define INET_HTTP_WEBSOCKET_MASK 0x80
 
 #endif
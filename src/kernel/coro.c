@@ -0,0 +1,208 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2014-2018, Erik Moqvist
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use, copy,
+ * modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ * This file is part of the Simba project.
+ */
+
+#include "simba.h"
+
+#define EVENT_TIMEOUT                                     0x1
+
+static void on_timeout(void *arg_p)
+{
+    struct coro_t *self_p;
+    uint32_t mask;
+
+    self_p = arg_p;
+    self_p->state = CORO_STATE_READY;
+
+    /* Wake up the scheduler. */
+    mask = EVENT_TIMEOUT;
+    event_write_isr(&self_p->scheduler_p->event, &mask, sizeof(mask));
+}
+
+static int is_ready(struct coro_t *coro_p)
+{
+    switch (coro_p->state) {
+
+    case CORO_STATE_READY:
+        return (1);
+
+    case CORO_STATE_WAITING:
+        return (chan_size(coro_p->chan_p) > 0);
+
+    default:
+        return (0);
+    }
+}
+
+static int is_in_list(struct chan_list_t *list_p, struct chan_t *chan_p)
+{
+    size_t i;
+
+    for (i = 0; i < list_p->len; i++) {
+        if (list_p->elements_p[i].chan_p == chan_p) {
+            return (1);
+        }
+    }
+
+    return (0);
+}
+
+/**
+ * Suspend the scheduler thread until a sleep timer expires or data is
+ * written to a channel a coroutine is waiting for.
+ */
+static void wait_for_ready(struct coro_scheduler_t *self_p)
+{
+    struct coro_t *coro_p;
+    struct time_t tick;
+    const struct time_t *timeout_p;
+    uint32_t mask;
+
+    chan_list_init(&self_p->list,
+                   self_p->elements_p,
+                   self_p->number_of_elements);
+    chan_list_add(&self_p->list, &self_p->event);
+    timeout_p = NULL;
+
+    for (coro_p = self_p->coros_p; coro_p != NULL; coro_p = coro_p->next_p) {
+        if (coro_p->state != CORO_STATE_WAITING) {
+            continue;
+        }
+
+        if (is_in_list(&self_p->list, coro_p->chan_p)) {
+            continue;
+        }
+
+        /* Poll every tick if there are too many channels. */
+        if (chan_list_add(&self_p->list, coro_p->chan_p) != 0) {
+            tick.seconds = 0;
+            tick.nanoseconds = (1000000000L / CONFIG_SYSTEM_TICK_FREQUENCY);
+            timeout_p = &tick;
+        }
+    }
+
+    chan_list_poll(&self_p->list, timeout_p);
+    chan_list_destroy(&self_p->list);
+
+    mask = EVENT_TIMEOUT;
+    event_try_read(&self_p->event, &mask, sizeof(mask));
+}
+
+int coro_scheduler_init(struct coro_scheduler_t *self_p,
+                        struct chan_list_elem_t *elements_p,
+                        size_t number_of_elements)
+{
+    ASSERTN(self_p != NULL, EINVAL);
+    ASSERTN(elements_p != NULL, EINVAL);
+    ASSERTN(number_of_elements > 0, EINVAL);
+
+    self_p->coros_p = NULL;
+    self_p->elements_p = elements_p;
+    self_p->number_of_elements = number_of_elements;
+
+    return (event_init(&self_p->event));
+}
+
+int coro_scheduler_run(struct coro_scheduler_t *self_p)
+{
+    ASSERTN(self_p != NULL, EINVAL);
+
+    struct coro_t **coro_pp;
+    struct coro_t *coro_p;
+    int ran;
+    int res;
+
+    while (self_p->coros_p != NULL) {
+        ran = 0;
+        coro_pp = &self_p->coros_p;
+
+        while ((coro_p = *coro_pp) != NULL) {
+            if (is_ready(coro_p)) {
+                ran = 1;
+                coro_p->state = CORO_STATE_READY;
+                res = coro_p->func(coro_p, coro_p->arg_p);
+
+                if (res == CORO_RESULT_DONE) {
+                    *coro_pp = coro_p->next_p;
+                    continue;
+                }
+            }
+
+            coro_pp = &coro_p->next_p;
+        }
+
+        if (ran == 0) {
+            wait_for_ready(self_p);
+        }
+    }
+
+    return (0);
+}
+
+int coro_spawn(struct coro_t *self_p,
+               struct coro_scheduler_t *scheduler_p,
+               coro_fn_t func,
+               void *arg_p)
+{
+    ASSERTN(self_p != NULL, EINVAL);
+    ASSERTN(scheduler_p != NULL, EINVAL);
+    ASSERTN(func != NULL, EINVAL);
+
+    struct coro_t **coro_pp;
+
+    self_p->func = func;
+    self_p->arg_p = arg_p;
+    self_p->resume_point = 0;
+    self_p->state = CORO_STATE_READY;
+    self_p->chan_p = NULL;
+    self_p->scheduler_p = scheduler_p;
+    self_p->next_p = NULL;
+
+    /* Append to keep the list intact if called by a running
+       coroutine. */
+    coro_pp = &scheduler_p->coros_p;
+
+    while (*coro_pp != NULL) {
+        coro_pp = &(*coro_pp)->next_p;
+    }
+
+    *coro_pp = self_p;
+
+    return (0);
+}
+
+int coro_sleep_start(struct coro_t *self_p,
+                     const struct time_t *timeout_p)
+{
+    ASSERTN(self_p != NULL, EINVAL);
+    ASSERTN(timeout_p != NULL, EINVAL);
+
+    self_p->state = CORO_STATE_SLEEPING;
+    timer_init(&self_p->timer, timeout_p, on_timeout, self_p, 0);
+
+    return (timer_start(&self_p->timer));
+}
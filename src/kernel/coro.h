@@ -0,0 +1,190 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2014-2018, Erik Moqvist
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use, copy,
+ * modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ * This file is part of the Simba project.
+ */
+
+#ifndef __KERNEL_CORO_H__
+#define __KERNEL_CORO_H__
+
+#include "simba.h"
+
+/* Coroutine return values, used by the macros below. */
+#define CORO_RESULT_DONE                                    0
+#define CORO_RESULT_YIELDED                                 1
+#define CORO_RESULT_WAITING                                 2
+
+/* Coroutine states. */
+#define CORO_STATE_READY                                    0
+#define CORO_STATE_WAITING                                  1
+#define CORO_STATE_SLEEPING                                 2
+
+/**
+ * Start of a coroutine body. Must be the first statement in the
+ * coroutine function.
+ *
+ * Local variables are not preserved across suspension points, so
+ * keep all state that must survive a suspension in a structure
+ * pointed to by ``arg_p``. ``switch`` statements must not contain
+ * suspension points.
+ */
+#define CORO_BEGIN(self_p)                      \
+    switch ((self_p)->resume_point) {           \
+    case 0:
+
+/**
+ * End of a coroutine body. Must be the last statement in the
+ * coroutine function. The coroutine is removed from its scheduler
+ * when it gets here.
+ */
+#define CORO_END(self_p)                        \
+    }                                           \
+    (self_p)->resume_point = 0;                 \
+    return (CORO_RESULT_DONE)
+
+/**
+ * Let other ready coroutines run before continuing.
+ */
+#define CORO_YIELD(self_p)                              \
+    do {                                                \
+        (self_p)->resume_point = __LINE__;              \
+        return (CORO_RESULT_YIELDED);                   \
+    case __LINE__:;                                     \
+    } while (0)
+
+/**
+ * Wait for data to be available on given channel, for example a
+ * queue or an event channel. The data must be read, without
+ * blocking, by the coroutine.
+ */
+#define CORO_AWAIT_CHAN(self_p, channel_p)                      \
+    do {                                                        \
+        (self_p)->chan_p = (struct chan_t *)(channel_p);        \
+        (self_p)->resume_point = __LINE__;                      \
+    case __LINE__:                                              \
+        if (chan_size((self_p)->chan_p) == 0) {                 \
+            (self_p)->state = CORO_STATE_WAITING;               \
+            return (CORO_RESULT_WAITING);                       \
+        }                                                       \
+        (self_p)->chan_p = NULL;                                \
+    } while (0)
+
+/**
+ * Sleep for given time, with the same resolution as timers.
+ */
+#define CORO_SLEEP(self_p, timeout_p)                           \
+    do {                                                        \
+        coro_sleep_start(self_p, timeout_p);                    \
+        (self_p)->resume_point = __LINE__;                      \
+        return (CORO_RESULT_WAITING);                           \
+    case __LINE__:;                                             \
+    } while (0)
+
+struct coro_t;
+
+/**
+ * Coroutine function. Its body must be enclosed in `CORO_BEGIN()`
+ * and `CORO_END()`.
+ */
+typedef int (*coro_fn_t)(struct coro_t *self_p, void *arg_p);
+
+struct coro_scheduler_t {
+    struct coro_t *coros_p;
+    struct event_t event;
+    struct chan_list_t list;
+    struct chan_list_elem_t *elements_p;
+    size_t number_of_elements;
+};
+
+/* A stackless coroutine. */
+struct coro_t {
+    coro_fn_t func;
+    void *arg_p;
+    uint16_t resume_point;
+    volatile int8_t state;
+    struct chan_t *chan_p;
+    struct timer_t timer;
+    struct coro_scheduler_t *scheduler_p;
+    struct coro_t *next_p;
+};
+
+/**
+ * Initialize given coroutine scheduler. The scheduler runs its
+ * coroutines in the thread calling `coro_scheduler_run()`.
+ *
+ * @param[in] self_p Scheduler to initialize.
+ * @param[in] elements_p Channel list elements used when waiting for
+ *                       channels. One element is used by the
+ *                       scheduler itself, and one per channel
+ *                       coroutines are waiting for. If there are more
+ *                       channels than elements, the channels are
+ *                       polled every system tick instead.
+ * @param[in] number_of_elements Number of elements in
+ *                               ``elements_p``.
+ *
+ * @return zero(0) or negative error code.
+ */
+int coro_scheduler_init(struct coro_scheduler_t *self_p,
+                        struct chan_list_elem_t *elements_p,
+                        size_t number_of_elements);
+
+/**
+ * Run coroutines until all have finished. Suspends the calling
+ * thread when all coroutines are waiting.
+ *
+ * @param[in] self_p Scheduler to run.
+ *
+ * @return zero(0) or negative error code.
+ */
+int coro_scheduler_run(struct coro_scheduler_t *self_p);
+
+/**
+ * Add given coroutine to given scheduler. Must be called before the
+ * scheduler is started, or by a coroutine in the same scheduler.
+ *
+ * @param[in] self_p Coroutine to initialize and add.
+ * @param[in] scheduler_p Scheduler to add the coroutine to.
+ * @param[in] func Coroutine function.
+ * @param[in] arg_p Argument passed to ``func``.
+ *
+ * @return zero(0) or negative error code.
+ */
+int coro_spawn(struct coro_t *self_p,
+               struct coro_scheduler_t *scheduler_p,
+               coro_fn_t func,
+               void *arg_p);
+
+/**
+ * Start the sleep timer of given coroutine. Used by `CORO_SLEEP()`.
+ *
+ * @param[in] self_p Coroutine to sleep.
+ * @param[in] timeout_p Sleep time.
+ *
+ * @return zero(0) or negative error code.
+ */
+int coro_sleep_start(struct coro_t *self_p,
+                     const struct time_t *timeout_p);
+
+#endif
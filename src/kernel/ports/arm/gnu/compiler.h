@@ -37,6 +37,10 @@ typedef const FAR char *far_string_t;
 
 #define RAM_CODE
 
+/* Put zero initialized data in the fastest RAM, if the linker script
+   has a .fast_bss section. Otherwise it ends up in .bss. */
+#define FAST_DATA __attribute__ ((section (".bss.fast")))
+
 #define PACKED __attribute__((packed))
 
 #endif
@@ -34,24 +34,123 @@
 #    define SYSTEM_TIMER_LOAD_RELOAD_NOM 20000000
 #endif
 
+#define SYSTEM_TIMER_LOAD                                       \
+    SYSTEM_TIMER_LOAD_RELOAD(SYSTEM_TIMER_LOAD_RELOAD_NOM           \
+                             / CONFIG_SYSTEM_TICK_FREQUENCY)
+
+#if CONFIG_SYSTEM_TICKLESS == 1
+
+struct sys_port_tickless_t {
+    uint32_t ticks;
+    uint32_t cycles_into_tick;
+    uint32_t load;
+    int restore_load;
+};
+
+static struct sys_port_tickless_t tickless;
+
+#endif
+
+#if CONFIG_PROFILER == 1
+__attribute__((used))
+static void sys_port_tick_isr(void)
+#else
 ISR(sys_tick)
+#endif
 {
 #if defined(FAMILY_STM32F2)
     /* Kick the watchdog. */
     STM32_IWDG->KR = 0xaaaa;
 #endif
 
+#if CONFIG_SYSTEM_TICKLESS == 1
+    /* The remainder of a tick after a tickless period has elapsed,
+       continue with full ticks. */
+    if (tickless.restore_load == 1) {
+        ARM_ST->LOAD = SYSTEM_TIMER_LOAD;
+        tickless.restore_load = 0;
+    }
+#endif
+
     sys_tick_isr();
 }
 
+#if CONFIG_PROFILER == 1
+
+/**
+ * Sample the program counter of the interrupted code from the
+ * exception stack frame. The system tick interrupt is masked by the
+ * system lock, so code running with the lock taken is sampled when
+ * the lock is released.
+ */
+__attribute__((used))
+static void sys_port_profiler_sample_isr(uint32_t *msp_p,
+                                         uint32_t exc_return)
+{
+    uint32_t *frame_p;
+    uintptr_t pc;
+
+    /* Bit 2 in EXC_RETURN is set if the frame was stacked on the
+       process stack. */
+    if (exc_return & 0x4) {
+        asm volatile ("mrs %0, psp" : "=r" (frame_p));
+    } else {
+        frame_p = msp_p;
+    }
+
+    /* r0-r3, r12, lr, pc and xpsr. */
+    pc = frame_p[6];
+    profiler_sample_isr(thrd_self(), &pc, 1);
+}
+
+__attribute__((naked))
+ISR(sys_tick)
+{
+    /* Pass the stack pointer before any push and EXC_RETURN to the
+       sampler. Two registers are pushed to keep the stack 8 bytes
+       aligned. Only basic asm is used as the registers r4-r11 of the
+       interrupted code must not be touched. */
+    asm volatile ("mov r0, sp\n"
+                  "mov r1, lr\n"
+                  "push {r0, lr}\n"
+                  "bl sys_port_profiler_sample_isr\n"
+                  "bl sys_port_tick_isr\n"
+                  "pop {r0, pc}");
+}
+
+static int sys_port_profiler_start(void)
+{
+    return (0);
+}
+
+static int sys_port_profiler_stop(void)
+{
+    return (0);
+}
+
+#endif
+
 static int sys_port_module_init(void)
 {
     /* Setup the system tick timer. */
-    ARM_ST->LOAD = SYSTEM_TIMER_LOAD_RELOAD(SYSTEM_TIMER_LOAD_RELOAD_NOM
-                                            / CONFIG_SYSTEM_TICK_FREQUENCY);
+    ARM_ST->LOAD = SYSTEM_TIMER_LOAD;
     ARM_ST->CTRL = (SYSTEM_TIMER_CTRL_TICKINT
                     | SYSTEM_TIMER_CTRL_ENABLE);
 
+#if (CONFIG_SYS_LOCK_PRIO != 0) && !defined(FAMILY_SAMD)
+    int i;
+
+    /* Give all interrupts the system lock priority so the kernel
+       interrupt service routines are masked by the system lock. */
+    for (i = 0; i < membersof(ARM_NVIC->IP); i++) {
+        nvic_set_priority(i, CONFIG_SYS_LOCK_PRIO);
+    }
+
+    ARM_SCB->SHPR3 = (SCB_SHPR3_PRI_15(CONFIG_SYS_LOCK_PRIO)
+                      | SCB_SHPR3_PRI_14(CONFIG_SYS_LOCK_PRIO));
+    asm volatile("msr basepri, %0" : : "r" (0) : "memory");
+#endif
+
     /* Enable interrupts. */
     asm volatile("cpsie i" : : : "memory");
 
@@ -88,6 +187,92 @@ static int sys_port_get_time_into_tick()
     return (0);
 }
 
+#if CONFIG_SYSTEM_TICKLESS == 1
+
+/**
+ * Restart the system timer with given number of cycles left until the
+ * next tick, followed by full ticks.
+ */
+static void sys_port_tickless_restart(uint32_t cycles)
+{
+    ARM_ST->LOAD = (cycles - 1);
+    ARM_ST->VAL = 0;
+    tickless.restore_load = 1;
+}
+
+static void sys_port_tickless_enter_isr(uint32_t ticks)
+{
+    uint32_t ticks_max;
+
+    /* The system timer is a 24 bits counter. */
+    ticks_max = (SYSTEM_TIMER_LOAD_RELOAD_MASK / (SYSTEM_TIMER_LOAD + 1));
+
+    if (ticks > ticks_max) {
+        ticks = ticks_max;
+    }
+
+    if (ticks <= 1) {
+        tickless.ticks = 0;
+
+        return;
+    }
+
+    tickless.ticks = ticks;
+    tickless.cycles_into_tick = (SYSTEM_TIMER_LOAD - ARM_ST->VAL);
+    tickless.load = (ticks * (SYSTEM_TIMER_LOAD + 1)
+                     - tickless.cycles_into_tick);
+    sys_port_tickless_restart(tickless.load);
+}
+
+static uint32_t sys_port_tickless_exit_isr(void)
+{
+    uint32_t cycles;
+    uint32_t ticks;
+
+    if (tickless.ticks == 0) {
+        return (0);
+    }
+
+    ticks = tickless.ticks;
+    tickless.ticks = 0;
+
+    if (ARM_ST->CTRL & SYSTEM_TIMER_CTRL_COUNTFLAG) {
+        /* The last tick is accounted for by the pending system tick
+           interrupt. */
+        cycles = (tickless.load - 1 - ARM_ST->VAL);
+        ticks--;
+    } else {
+        /* Woken up by another interrupt. */
+        cycles = (tickless.cycles_into_tick
+                  + tickless.load - 1 - ARM_ST->VAL);
+        ticks = (cycles / (SYSTEM_TIMER_LOAD + 1));
+        cycles %= (SYSTEM_TIMER_LOAD + 1);
+    }
+
+    sys_port_tickless_restart(SYSTEM_TIMER_LOAD + 1 - cycles);
+
+    return (ticks);
+}
+
+#endif
+
+#if (CONFIG_SYS_LOCK_PRIO != 0) && !defined(FAMILY_SAMD)
+
+static void sys_port_lock(void)
+{
+    asm volatile("msr basepri, %0"
+                 :
+                 : "r" (CONFIG_SYS_LOCK_PRIO)
+                 : "memory");
+}
+
+static void sys_port_unlock(void)
+{
+    asm volatile("msr basepri, %0" : : "r" (0) : "memory");
+}
+
+#else
+
 static void sys_port_lock(void)
 {
     asm volatile("cpsid i" : : : "memory");
@@ -98,6 +283,57 @@ static void sys_port_unlock(void)
     asm volatile("cpsie i" : : : "memory");
 }
 
+#endif
+
+#define SYS_PORT_HAS_LOCK_PRIO
+
+#if !defined(FAMILY_SAMD)
+
+static int sys_port_lock_prio(int prio)
+{
+    int basepri;
+
+    /* basepri_max only ever raises the masking level, which makes
+       the critical sections nestable. */
+    asm volatile("mrs %0, basepri\n"
+                 "msr basepri_max, %1"
+                 : "=&r" (basepri)
+                 : "r" (prio)
+                 : "memory");
+
+    return (basepri);
+}
+
+static void sys_port_unlock_prio(int state)
+{
+    asm volatile("msr basepri, %0" : : "r" (state) : "memory");
+}
+
+#else
+
+/* Cortex-M0 has no BASEPRI, mask all interrupts. */
+static int sys_port_lock_prio(int prio)
+{
+    int primask;
+
+    asm volatile("mrs %0, primask\n"
+                 "cpsid i"
+                 : "=r" (primask)
+                 :
+                 : "memory");
+
+    return (primask);
+}
+
+static void sys_port_unlock_prio(int state)
+{
+    if (state == 0) {
+        asm volatile("cpsie i" : : : "memory");
+    }
+}
+
+#endif
+
 static void sys_port_lock_isr(void)
 {
 }
@@ -40,8 +40,27 @@
 #define THRD_PORT_CONTEXT_STORE_ISR
 #define THRD_PORT_CONTEXT_LOAD_ISR
 
+/* Frequency of thrd_port_cycles_get(), the DWT cycle counter. SAMD
+   has none. */
+#if !defined(FAMILY_SAMD)
+#    define THRD_PORT_CYCLES_FREQUENCY                      F_CPU
+#endif
+
+/* The floating point registers s16-s31 are only saved for threads
+   that used the FPU since they were swapped in. */
+#if defined(__ARM_FP)
+#    define THRD_PORT_FPU                                   1
+#else
+#    define THRD_PORT_FPU                                   0
+#endif
+
 struct thrd_port_context_t {
     /* Context stored by the software. */
+#if THRD_PORT_FPU == 1
+    /* The CONTROL register. s16-s31 are stored here if FPCA is
+       set. */
+    uint32_t control;
+#endif
     uint32_t r4;
     uint32_t r5;
     uint32_t r6;
@@ -53,12 +53,34 @@ static void thrd_port_swap(struct thrd_t *in_p,
     asm volatile ("push {lr}");
     asm volatile ("push {r4-r11}");
 
+#if THRD_PORT_FPU == 1
+    /* Store the floating point registers only if the FPU has been
+       used, that is, if CONTROL.FPCA is set. */
+    asm volatile ("mrs r2, control\n"
+                  "tst r2, #4\n"
+                  "it ne\n"
+                  "vpushne {s16-s31}\n"
+                  "push {r2}");
+#endif
+
     /* Save 'out_p' stack pointer. */
     asm volatile ("mov %0, sp" : "=r" (out_p->port.context_p));
 
     /* Restore 'in_p' stack pointer. */
     asm volatile ("mov sp, %0" : : "r" (in_p->port.context_p));
 
+#if THRD_PORT_FPU == 1
+    /* Load the floating point registers if they were stored, and
+       restore CONTROL.FPCA. A cleared FPCA makes interrupts in
+       threads not using the FPU as cheap as without FPU. */
+    asm volatile ("pop {r2}\n"
+                  "tst r2, #4\n"
+                  "it ne\n"
+                  "vpopne {s16-s31}\n"
+                  "msr control, r2\n"
+                  "isb");
+#endif
+
     /* Load registers. pop lr to pc and continue execution. */
     asm volatile ("pop {r4-r11}");
     asm volatile ("pop {pc}");
@@ -85,12 +107,31 @@ static void thrd_port_init_main(struct thrd_port_t *port)
     /* Start the timer counter. */
     SAM_TC0->CHANNEL[0].CCR = (TC_CCR_SWTRG | TC_CCR_CLKEN);
 #endif
+
+#if THRD_PORT_FPU == 1
+    /* Enable the FPU with automatic and lazy state preservation on
+       exception entry. */
+    ARM_CPACR |= CPACR_CP10_CP11_FULL_ACCESS;
+    ARM_FPCCR |= (FPCCR_ASPEN | FPCCR_LSPEN);
+    asm volatile ("dsb");
+    asm volatile ("isb");
+#endif
+
+#if (CONFIG_THRD_CYCLES_NEEDED == 1) && !defined(FAMILY_SAMD)
+    /* Start the cycle counter. */
+    ARM_DEMCR |= DEMCR_TRCENA;
+    ARM_DWT->CYCCNT = 0;
+    ARM_DWT->CTRL |= DWT_CTRL_CYCCNTENA;
+#endif
 }
 
 __attribute__((naked))
 static void thrd_port_main(void)
 {
     /* Enable interrupts. */
+#if (CONFIG_SYS_LOCK_PRIO != 0) && !defined(FAMILY_SAMD)
+    asm volatile ("msr basepri, %0" : : "r" (0));
+#endif
     asm volatile ("cpsie i");
 
     /* Call thread main function with argument. */
@@ -113,6 +154,10 @@ static int thrd_port_spawn(struct thrd_t *thrd_p,
     thrd_p->port.context_p = context_p;
 
     /* Prepare the software context. */
+#if THRD_PORT_FPU == 1
+    /* Privileged, main stack pointer and no floating point context. */
+    context_p->control = 0;
+#endif
     context_p->r9 = (uint32_t)main;
     context_p->r10 = (uint32_t)arg_p;
 
@@ -124,8 +169,25 @@ static int thrd_port_spawn(struct thrd_t *thrd_p,
 
 static void thrd_port_idle_wait(struct thrd_t *thrd_p)
 {
+    sys_idle_enter_isr();
+
     /* Wait for an interrupt to occur. */
+#if (CONFIG_SYS_LOCK_PRIO != 0) && !defined(FAMILY_SAMD)
+    /* Interrupts masked by BASEPRI do not wake up the core, but
+       interrupts masked by PRIMASK do. */
+    asm volatile ("cpsid i\n"
+                  "msr basepri, %0\n"
+                  "wfi\n"
+                  "msr basepri, %1\n"
+                  "cpsie i"
+                  :
+                  : "r" (0), "r" (CONFIG_SYS_LOCK_PRIO)
+                  : "memory");
+#else
     asm volatile ("wfi");
+#endif
+
+    sys_idle_exit_isr();
 
     /* Unlock the system to handle the interrupt. */
     sys_unlock();
@@ -160,6 +222,19 @@ static void thrd_port_cpu_usage_stop(struct thrd_t *thrd_p)
 #endif
 }
 
+#if CONFIG_THRD_CYCLES_NEEDED == 1
+
+static uint32_t thrd_port_cycles_get(void)
+{
+#if !defined(FAMILY_SAMD)
+    return (ARM_DWT->CYCCNT);
+#else
+    return (0);
+#endif
+}
+
+#endif
+
 #if CONFIG_MONITOR_THREAD == 1
 
 static cpu_usage_t thrd_port_cpu_usage_get(struct thrd_t *thrd_p)
@@ -198,6 +198,25 @@ struct arm_system_timer_t {
 #define SYSTEM_TIMER_CALIB_SKEW         BIT(30)
 #define SYSTEM_TIMER_CALIB_NOREF        BIT(31)
 
+/* Data watchpoint and trace unit. Not available on Cortex-M0(+). */
+struct arm_dwt_t {
+    uint32_t CTRL;
+    uint32_t CYCCNT;
+};
+
+/* DWT Control Register */
+#define DWT_CTRL_CYCCNTENA              BIT(0)
+
+/* Debug Exception and Monitor Control Register */
+#define DEMCR_TRCENA                    BIT(24)
+
+/* Coprocessor Access Control Register */
+#define CPACR_CP10_CP11_FULL_ACCESS     (0xf << 20)
+
+/* Floating-point Context Control Register */
+#define FPCCR_ASPEN                     BIT(31)
+#define FPCCR_LSPEN                     BIT(30)
+
 /* System nested vectored interrupt controller. */
 struct arm_nvic_t {
     uint32_t ISE[2];
@@ -210,8 +229,8 @@ struct arm_nvic_t {
     uint32_t reserved4[30];
     uint32_t IAB[2];
     uint32_t reserved5[62];
-    uint32_t IP[8];
-    uint32_t reserved6[697];
+    uint8_t IP[240];
+    uint32_t reserved6[644];
     uint32_t STIR;
 };
 
@@ -229,10 +248,7 @@ struct arm_nvic_t {
 
 #define NVIC_IABR_GET(id)     ((ARM_NVIC->IAB[(id) / 32] >> ((id) % 32)) & 0x1)
 
-#define NVIC_IP_SET(id, prio) (ARM_NVIC->IP[id] |= (prio))
-#define NVIC_IP_GET(id)       (ARM_NVIC->IP[id])
-
-#define NVIC_IP_SET(id, prio) (ARM_NVIC->IP[id] |= (prio))
+#define NVIC_IP_SET(id, prio) (ARM_NVIC->IP[id] = (prio))
 #define NVIC_IP_GET(id)       (ARM_NVIC->IP[id])
 
 #define NVIC_STIR_INTID(id)   (id)
@@ -241,6 +257,10 @@ struct arm_nvic_t {
 #define ARM_SCB        ((volatile struct arm_system_control_block_t *)0xe000e008u)
 #define ARM_ST         ((volatile struct arm_system_timer_t         *)0xe000e010u)
 #define ARM_NVIC       ((volatile struct arm_nvic_t                 *)0xe000e100u)
+#define ARM_DWT        ((volatile struct arm_dwt_t                  *)0xe0001000u)
+#define ARM_DEMCR      (*(volatile uint32_t                         *)0xe000edfcu)
+#define ARM_CPACR      (*(volatile uint32_t                         *)0xe000ed88u)
+#define ARM_FPCCR      (*(volatile uint32_t                         *)0xe000ef34u)
 
 static inline void nvic_enable_interrupt(int id)
 {
@@ -254,4 +274,13 @@ static inline void nvic_disable_interrupt(int id)
     ARM_NVIC->ICP[id / 32] = (1 << (id % 32));
 }
 
+/**
+ * Set the priority of given interrupt. A numerically lower value is a
+ * higher priority. Only the most significant bits are implemented.
+ */
+static inline void nvic_set_priority(int id, int prio)
+{
+    ARM_NVIC->IP[id] = prio;
+}
+
 #endif
@@ -41,8 +41,28 @@
 #define THRD_PORT_CONTEXT_STORE_ISR
 #define THRD_PORT_CONTEXT_LOAD_ISR
 
+/* The callee-saved floating point registers d8-d15 are stored in the
+   thread context when the compiler may use the floating point and
+   Advanced SIMD registers, that is, when not built with
+   -mgeneral-regs-only. */
+#if defined(__ARM_FP)
+#    define THRD_PORT_FPU                                   1
+#else
+#    define THRD_PORT_FPU                                   0
+#endif
+
 struct thrd_port_context_t {
     /* Context stored by the software. */
+#if THRD_PORT_FPU == 1
+    uint64_t d8;
+    uint64_t d9;
+    uint64_t d10;
+    uint64_t d11;
+    uint64_t d12;
+    uint64_t d13;
+    uint64_t d14;
+    uint64_t d15;
+#endif
     uint64_t x0;
     uint64_t x1;
     uint64_t x2;
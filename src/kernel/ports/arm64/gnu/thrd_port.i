@@ -102,6 +102,15 @@ static void thrd_port_cpu_usage_stop(struct thrd_t *thrd_p)
 {
 }
 
+#if CONFIG_THRD_CYCLES_NEEDED == 1
+
+static uint32_t thrd_port_cycles_get(void)
+{
+    return (0);
+}
+
+#endif
+
 #if CONFIG_MONITOR_THREAD == 1
 
 static cpu_usage_t thrd_port_cpu_usage_get(struct thrd_t *thrd_p)
@@ -26,6 +26,9 @@
  * This file is part of the Simba project.
  */
 
+/* Number of hardware compare channels for high resolution timers. */
+#define TIMER_PORT_HIGH_RESOLUTION_CHANNELS 1
+
 static int timer_port_module_init(void)
 {
     return (0);
@@ -39,10 +42,12 @@ static int timer_port_high_resolution_init(
     return (-ENOSYS);
 }
 
-static void timer_port_high_resolution_start_isr(struct timer_t *self_p)
+static void timer_port_high_resolution_start_isr(int channel,
+                                                 struct timer_t *self_p)
 {
 }
 
-static void timer_port_high_resolution_stop_isr(struct timer_t *self_p)
+static void timer_port_high_resolution_stop_isr(int channel,
+                                                struct timer_t *self_p)
 {
 }
@@ -33,6 +33,17 @@
 
 #define PACKED __attribute__((packed))
 
+/**
+ * The system lock is a single instruction on AVR, so it is inlined
+ * into the callers instead of calling sys_lock() and sys_unlock(),
+ * unless lock or isr statistics are enabled. The lock does not nest,
+ * so interrupts are unconditionally enabled on unlock.
+ */
+#define SYS_PORT_INLINE_LOCK() asm volatile ("cli" ::: "memory")
+#define SYS_PORT_INLINE_UNLOCK() asm volatile ("sei" ::: "memory")
+#define SYS_PORT_INLINE_LOCK_ISR() do { } while (0)
+#define SYS_PORT_INLINE_UNLOCK_ISR() do { } while (0)
+
 static inline uint32_t htonl(uint32_t v)
 {
     return (((v) << 24)
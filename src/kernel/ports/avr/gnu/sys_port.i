@@ -65,6 +65,10 @@ static int sys_port_module_init(void)
     OCR1A = TCNT1_MAX;
     TIMSK1 = _BV(OCIE1A);
 
+    /* The idle thread enters the idle sleep mode, or a deeper mode
+       selected by the power driver. */
+    SMCR = _BV(SE);
+
     /* Enable interrupts. */
     asm volatile ("sei");
 
@@ -109,6 +113,20 @@ static int sys_port_backtrace(void **buf_pp, size_t size)
     return (0);
 }
 
+#if CONFIG_PROFILER == 1
+
+static int sys_port_profiler_start(void)
+{
+    return (-ENOSYS);
+}
+
+static int sys_port_profiler_stop(void)
+{
+    return (-ENOSYS);
+}
+
+#endif
+
 static long sys_port_get_time_into_tick()
 {
     long cpu_cycles;
@@ -124,6 +142,19 @@ static long sys_port_get_time_into_tick()
     return (1000ul * (cpu_cycles / (F_CPU / 1000000ul)));
 }
 
+#if CONFIG_SYSTEM_TICKLESS == 1
+
+static void sys_port_tickless_enter_isr(uint32_t ticks)
+{
+}
+
+static uint32_t sys_port_tickless_exit_isr(void)
+{
+    return (0);
+}
+
+#endif
+
 static void sys_port_lock(void)
 {
     asm volatile ("cli" ::: "memory");
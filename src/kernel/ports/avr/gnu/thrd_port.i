@@ -140,11 +140,15 @@ static int thrd_port_spawn(struct thrd_t *thrd,
 
 static void thrd_port_idle_wait(struct thrd_t *thrd_p)
 {
+    sys_idle_enter_isr();
+
     /* NOTE: will enter sleep before any interrupt is taken. */
     asm volatile ("sei" : : : "memory");
     asm volatile ("sleep" : : : "memory");
     asm volatile ("cli" : : : "memory");
 
+    sys_idle_exit_isr();
+
     /* Add this thread to the ready list and reschedule. */
     thrd_p->state = THRD_STATE_READY;
     scheduler_ready_push(thrd_p);
@@ -167,6 +171,15 @@ static void thrd_port_cpu_usage_stop(struct thrd_t *thrd_p)
 {
 }
 
+#if CONFIG_THRD_CYCLES_NEEDED == 1
+
+static uint32_t thrd_port_cycles_get(void)
+{
+    return (0);
+}
+
+#endif
+
 #if CONFIG_MONITOR_THREAD == 1
 
 static cpu_usage_t thrd_port_cpu_usage_get(struct thrd_t *thrd_p)
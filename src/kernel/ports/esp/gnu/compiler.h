@@ -40,6 +40,8 @@ typedef const FAR char *far_string_t;
 
 #define RAM_CODE
 
+#define FAST_DATA
+
 #define PACKED __attribute__((packed))
 
 char *strsep(char **string_pp, const char *delim_p);
@@ -36,6 +36,9 @@
 #define THRD_PORT_STACK(name, size)             \
     uint32_t name[DIV_CEIL(sizeof(struct thrd_t) + (size), sizeof(uint32_t))] __attribute__ ((section (".simba_other_stacks")))
 
+/* Frequency of thrd_port_cycles_get(), the CCOUNT register. */
+#define THRD_PORT_CYCLES_FREQUENCY                          F_CPU
+
 struct thrd_port_context_t {
     uint32_t a0;           /* Return addess from the swap function. */
     uint32_t a12;
@@ -43,6 +43,9 @@ typedef const FAR char *far_string_t;
 /* Put code in RAM. */
 #define RAM_CODE                              IRAM_ATTR
 
+/* All data is in internal DRAM. */
+#define FAST_DATA
+
 #define PACKED __attribute__((packed))
 
 #endif
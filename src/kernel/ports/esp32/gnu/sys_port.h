@@ -48,4 +48,31 @@ static inline uint16_t htons(uint16_t v)
 
 #define ntohs(v) htons(v)
 
+struct queue_t;
+
+/**
+ * Schedule threads resumed from a FreeRTOS task outside Simba. The
+ * system lock only masks interrupts on the current core, so resume
+ * the threads with the system lock taken on the Simba core, then call
+ * this function.
+ */
+void sys_port_notify_from_task(void);
+
+/**
+ * Write given data to given queue from a FreeRTOS task outside
+ * Simba, for example an ESP-IDF task on the other core, and schedule
+ * the reading thread. A write from the other core is made on the
+ * Simba core by an inter-processor call. It never blocks on the
+ * queue, so data that does not fit in the queue is not written.
+ *
+ * @param[in] queue_p Queue read by a Simba thread.
+ * @param[in] buf_p Data to write.
+ * @param[in] size Size of the data.
+ *
+ * @return Number of written bytes or negative error code.
+ */
+ssize_t sys_port_queue_write_from_task(struct queue_t *queue_p,
+                                       const void *buf_p,
+                                       size_t size);
+
 #endif
@@ -30,15 +30,26 @@
 
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
+#include "freertos/semphr.h"
 #include "esp_system.h"
 #include "esp_intr.h"
 #include "esp_attr.h"
 
 #include "nvs_flash.h"
 
+#if CONFIG_FREERTOS_UNICORE == 0
+#    include "esp_ipc.h"
+#endif
+
+#if (CONFIG_SYS_SIMBA_MAIN_CORE == 1) && (CONFIG_FREERTOS_UNICORE == 1)
+#    error "CONFIG_SYS_SIMBA_MAIN_CORE 1 requires a dual core ESP-IDF."
+#endif
+
 /* The main function is defined by the user in main.c. */
 extern int main();
 
+extern xSemaphoreHandle thrd_idle_sem;
+
 static void RAM_CODE sys_port_tick()
 {
     /* Clear the interrupt flag and configure the timer to raise an
@@ -94,11 +105,38 @@ static int sys_port_backtrace(void **buf_pp, size_t size)
     return (0);
 }
 
+#if CONFIG_PROFILER == 1
+
+static int sys_port_profiler_start(void)
+{
+    return (-ENOSYS);
+}
+
+static int sys_port_profiler_stop(void)
+{
+    return (-ENOSYS);
+}
+
+#endif
+
 static int sys_port_get_time_into_tick()
 {
     return (0);
 }
 
+#if CONFIG_SYSTEM_TICKLESS == 1
+
+static void sys_port_tickless_enter_isr(uint32_t ticks)
+{
+}
+
+static uint32_t sys_port_tickless_exit_isr(void)
+{
+    return (0);
+}
+
+#endif
+
 static void RAM_CODE sys_port_lock(void)
 {
     portDISABLE_INTERRUPTS();
@@ -126,6 +164,60 @@ static void sys_port_interrupt_cpu_usage_reset(void)
 {
 }
 
+void sys_port_notify_from_task(void)
+{
+    xSemaphoreGive(thrd_idle_sem);
+}
+
+struct queue_write_from_task_t {
+    struct queue_t *queue_p;
+    const void *buf_p;
+    size_t size;
+    ssize_t res;
+};
+
+static void queue_write_from_task(void *arg_p)
+{
+    struct queue_write_from_task_t *args_p;
+
+    args_p = arg_p;
+
+    sys_lock();
+    args_p->res = queue_write_isr(args_p->queue_p,
+                                  args_p->buf_p,
+                                  args_p->size);
+    sys_unlock();
+}
+
+ssize_t sys_port_queue_write_from_task(struct queue_t *queue_p,
+                                       const void *buf_p,
+                                       size_t size)
+{
+    struct queue_write_from_task_t args;
+
+    args.queue_p = queue_p;
+    args.buf_p = buf_p;
+    args.size = size;
+
+#if CONFIG_FREERTOS_UNICORE == 1
+    queue_write_from_task(&args);
+#else
+    /* The system lock only masks interrupts on the current core, so
+       the write must be made on the Simba core. */
+    if (xPortGetCoreID() == CONFIG_SYS_SIMBA_MAIN_CORE) {
+        queue_write_from_task(&args);
+    } else if (esp_ipc_call_blocking(CONFIG_SYS_SIMBA_MAIN_CORE,
+                                     queue_write_from_task,
+                                     &args) != ESP_OK) {
+        return (-EIO);
+    }
+#endif
+
+    sys_port_notify_from_task();
+
+    return (args.res);
+}
+
 /**
  * Simba runs in this FreeRTOS task.
  */
@@ -156,7 +248,7 @@ int app_main()
                                 NULL,
                                 5,
                                 NULL,
-                                0);
+                                CONFIG_SYS_SIMBA_MAIN_CORE);
 
     return (0);
 }
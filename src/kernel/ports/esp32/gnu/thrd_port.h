@@ -36,6 +36,9 @@
 #define THRD_PORT_STACK(name, size)             \
     uint32_t name[DIV_CEIL(sizeof(struct thrd_t) + (size), sizeof(uint32_t))]
 
+/* Frequency of thrd_port_cycles_get(), the CCOUNT register. */
+#define THRD_PORT_CYCLES_FREQUENCY                          F_CPU
+
 void thrd_port_set_main_thrd(struct thrd_t *thrd_p);
 
 void thrd_port_set_main_thrd_stack_top(void *top_p);
@@ -137,6 +137,19 @@ static void thrd_port_cpu_usage_stop(struct thrd_t *thrd_p)
 {
 }
 
+#if CONFIG_THRD_CYCLES_NEEDED == 1
+
+static uint32_t RAM_CODE thrd_port_cycles_get(void)
+{
+    uint32_t ccount;
+
+    asm volatile ("rsr %0, ccount" : "=a" (ccount));
+
+    return (ccount);
+}
+
+#endif
+
 #if CONFIG_MONITOR_THREAD == 1
 
 static cpu_usage_t thrd_port_cpu_usage_get(struct thrd_t *thrd_p)
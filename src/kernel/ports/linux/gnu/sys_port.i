@@ -29,6 +29,8 @@
 #include <pthread.h>
 #include <execinfo.h>
 #include <signal.h>
+#include <sys/time.h>
+#include <errno.h>
 
 static pthread_mutex_t mutex;
 
@@ -40,6 +42,110 @@ struct sys_port_t {
 
 static struct sys_port_t sys_port;
 
+#if (CONFIG_LINUX_VIRTUAL_TIME == 1) && (CONFIG_SYSTEM_TICKLESS == 0)
+#    error "CONFIG_LINUX_VIRTUAL_TIME requires CONFIG_SYSTEM_TICKLESS."
+#endif
+
+#if CONFIG_SYSTEM_TICKLESS == 1
+
+#define SYS_PORT_TICK_PERIOD_NS (1000000000LL / CONFIG_SYSTEM_TICK_FREQUENCY)
+
+/* Tickless idle state, protected by the system lock. */
+struct sys_port_tickless_t {
+    int64_t last_tick_ns;
+    uint32_t ticks;
+    int active;
+    int kicked;
+    pthread_t idle_thrd;
+#if CONFIG_LINUX_VIRTUAL_TIME == 1
+    int jump;
+    int64_t offset_ns;
+#endif
+};
+
+static struct sys_port_tickless_t tickless;
+
+static int64_t sys_port_now_ns(void)
+{
+    struct timespec now;
+
+    clock_gettime(CLOCK_REALTIME, &now);
+
+#if CONFIG_LINUX_VIRTUAL_TIME == 1
+    return (1000000000LL * now.tv_sec + now.tv_nsec + tickless.offset_ns);
+#else
+    return (1000000000LL * now.tv_sec + now.tv_nsec);
+#endif
+}
+
+/**
+ * The tick thread sleeps until the next tick is due, or until the
+ * idle thread has programmed a longer tickless period.
+ */
+static void *sys_port_ticker(void *arg)
+{
+    struct timespec abstimeout;
+    int64_t deadline_ns;
+    uint32_t ticks;
+#if CONFIG_LINUX_VIRTUAL_TIME == 1
+    int64_t now_ns;
+#endif
+
+    pthread_mutex_lock(&mutex);
+
+    while (1) {
+        deadline_ns = (tickless.last_tick_ns
+                       + tickless.ticks * SYS_PORT_TICK_PERIOD_NS);
+
+#if CONFIG_LINUX_VIRTUAL_TIME == 1
+        if ((tickless.jump == 1) && (tickless.kicked == 0)) {
+            /* All threads are waiting for a timer. Jump forward to
+               its expiry instead of waiting for it. */
+            tickless.jump = 0;
+            now_ns = sys_port_now_ns();
+
+            if (deadline_ns > now_ns) {
+                tickless.offset_ns += (deadline_ns - now_ns);
+            }
+        } else {
+            deadline_ns -= tickless.offset_ns;
+#endif
+            abstimeout.tv_sec = (deadline_ns / 1000000000LL);
+            abstimeout.tv_nsec = (deadline_ns % 1000000000LL);
+            pthread_cond_timedwait(&sys_port.cond, &mutex, &abstimeout);
+#if CONFIG_LINUX_VIRTUAL_TIME == 1
+        }
+#endif
+
+        ticks = ((sys_port_now_ns() - tickless.last_tick_ns)
+                 / SYS_PORT_TICK_PERIOD_NS);
+
+        if (ticks >= tickless.ticks) {
+            tickless.last_tick_ns += (ticks * SYS_PORT_TICK_PERIOD_NS);
+            tickless.ticks = 1;
+            tickless.active = 0;
+#if CONFIG_LINUX_VIRTUAL_TIME == 1
+            tickless.jump = 0;
+#endif
+            sys_tick_skip_isr(ticks - 1);
+            pthread_mutex_unlock(&mutex);
+            sys_tick_isr();
+            pthread_mutex_lock(&mutex);
+        } else if (tickless.kicked == 1) {
+            /* Another thread made a Simba thread ready, wake up the
+               idle thread. */
+            tickless.kicked = 0;
+            pthread_mutex_unlock(&mutex);
+            thrd_tick_isr();
+            pthread_mutex_lock(&mutex);
+        }
+    }
+
+    return (NULL);
+}
+
+#else
+
 static void *sys_port_ticker(void *arg)
 {
     struct timespec abstimeout;
@@ -65,6 +171,8 @@ static void *sys_port_ticker(void *arg)
     return (NULL);
 }
 
+#endif
+
 static void sys_port_stop(int error)
 {
     exit(error);
@@ -100,6 +208,187 @@ static int sys_port_get_time_into_tick()
     return (0);
 }
 
+#if CONFIG_PROFILER == 1
+
+#if defined(__x86_64__)
+
+/**
+ * Store the interrupted program counter followed by return addresses
+ * found by following the frame pointers. Frames outside the stack of
+ * the interrupted thread are not followed.
+ */
+static int sys_port_profiler_backtrace(struct sigcontext *context_p,
+                                       struct thrd_t *thrd_p,
+                                       uintptr_t *pcs_p,
+                                       int size)
+{
+    uintptr_t *frame_p;
+    uintptr_t *next_p;
+    int length;
+
+    pcs_p[0] = context_p->rip;
+    length = 1;
+
+    if (thrd_p == NULL) {
+        return (length);
+    }
+
+    frame_p = (uintptr_t *)context_p->rbp;
+
+    while (length < size) {
+        if ((frame_p < (uintptr_t *)context_p->rsp)
+            || (&frame_p[2] > (uintptr_t *)thrd_p->port.stack_top_p)
+            || (((uintptr_t)frame_p % sizeof(*frame_p)) != 0)) {
+            break;
+        }
+
+        pcs_p[length] = frame_p[1];
+        length++;
+        next_p = (uintptr_t *)frame_p[0];
+
+        if (next_p <= frame_p) {
+            break;
+        }
+
+        frame_p = next_p;
+    }
+
+    return (length);
+}
+
+static void sys_port_profiler_handler(int signal,
+                                      siginfo_t *info_p,
+                                      void *ucontext_p)
+{
+    struct thrd_t *thrd_p;
+    uintptr_t pcs[1 + CONFIG_PROFILER_BACKTRACE_DEPTH];
+    int length;
+
+    /* The signal is delivered to the pthread that consumed the CPU
+       time. It is not a Simba thread if it is for example the tick
+       thread or a device thread. */
+    thrd_p = thrd_self();
+
+    if ((thrd_p != NULL) && !pthread_equal(pthread_self(), thrd_p->port.thrd)) {
+        thrd_p = NULL;
+    }
+
+    /* The machine context has the layout of the kernel signal
+       context. */
+    length = sys_port_profiler_backtrace(
+        (struct sigcontext *)&((ucontext_t *)ucontext_p)->uc_mcontext,
+        thrd_p,
+        &pcs[0],
+        membersof(pcs));
+    profiler_sample_isr(thrd_p, &pcs[0], length);
+}
+
+static int sys_port_profiler_set_timer(long interval)
+{
+    struct itimerval value;
+
+    value.it_interval.tv_sec = 0;
+    value.it_interval.tv_usec = interval;
+    value.it_value = value.it_interval;
+
+    if (setitimer(ITIMER_VIRTUAL, &value, NULL) != 0) {
+        return (-errno);
+    }
+
+    return (0);
+}
+
+/**
+ * Sample on a timer counting the CPU time consumed by the
+ * process. ITIMER_PROF and SIGPROF are used by gprof.
+ */
+static int sys_port_profiler_start(void)
+{
+    struct sigaction action;
+
+    memset(&action, 0, sizeof(action));
+    action.sa_sigaction = sys_port_profiler_handler;
+    action.sa_flags = (SA_SIGINFO | SA_RESTART);
+    sigemptyset(&action.sa_mask);
+
+    if (sigaction(SIGVTALRM, &action, NULL) != 0) {
+        return (-errno);
+    }
+
+    return (sys_port_profiler_set_timer(1000000L / CONFIG_PROFILER_FREQUENCY));
+}
+
+static int sys_port_profiler_stop(void)
+{
+    return (sys_port_profiler_set_timer(0));
+}
+
+#else
+
+static int sys_port_profiler_start(void)
+{
+    return (-ENOSYS);
+}
+
+static int sys_port_profiler_stop(void)
+{
+    return (-ENOSYS);
+}
+
+#endif
+
+#endif
+
+#if CONFIG_SYSTEM_TICKLESS == 1
+
+static void sys_port_tickless_enter_isr(uint32_t ticks)
+{
+    if (ticks <= 1) {
+        return;
+    }
+
+    tickless.ticks = ticks;
+    tickless.active = 1;
+    tickless.idle_thrd = pthread_self();
+#if CONFIG_LINUX_VIRTUAL_TIME == 1
+    /* No timer is running if the tickless period is the maximum,
+       and only an external event can wake up a thread. */
+    tickless.jump = (ticks != 0xffffffff);
+#endif
+    pthread_cond_signal(&sys_port.cond);
+}
+
+static uint32_t sys_port_tickless_exit_isr(void)
+{
+    uint32_t ticks;
+
+    if (tickless.active == 0) {
+        return (0);
+    }
+
+    tickless.active = 0;
+#if CONFIG_LINUX_VIRTUAL_TIME == 1
+    tickless.jump = 0;
+#endif
+    ticks = ((sys_port_now_ns() - tickless.last_tick_ns)
+             / SYS_PORT_TICK_PERIOD_NS);
+
+    /* The tick thread accounts for the ticks if the tickless period
+       has elapsed. */
+    if (ticks >= tickless.ticks) {
+        ticks = 0;
+    } else {
+        tickless.last_tick_ns += (ticks * SYS_PORT_TICK_PERIOD_NS);
+    }
+
+    tickless.ticks = 1;
+    pthread_cond_signal(&sys_port.cond);
+
+    return (ticks);
+}
+
+#endif
+
 static void sys_port_lock(void)
 {
     pthread_mutex_lock(&mutex);
@@ -107,6 +396,17 @@ static void sys_port_lock(void)
 
 static void sys_port_unlock(void)
 {
+#if CONFIG_SYSTEM_TICKLESS == 1
+    /* A thread other than the idle thread, for example the socket
+       device, may have made a Simba thread ready. This corresponds to
+       an interrupt waking up the CPU. */
+    if ((tickless.active == 1)
+        && !pthread_equal(pthread_self(), tickless.idle_thrd)) {
+        tickless.kicked = 1;
+        pthread_cond_signal(&sys_port.cond);
+    }
+#endif
+
     pthread_mutex_unlock(&mutex);
 }
 
@@ -149,6 +449,12 @@ int sys_port_module_init(void)
 
     signal(SIGSEGV, signal_handler);
 
+#if CONFIG_SYSTEM_TICKLESS == 1
+    pthread_cond_init(&sys_port.cond, NULL);
+    tickless.last_tick_ns = sys_port_now_ns();
+    tickless.ticks = 1;
+#endif
+
     /* Start sys tick thrd.*/
     if (pthread_create(&sys_port.thrd, NULL, sys_port_ticker, NULL)) {
         fprintf(stderr, "Error creating ticker thrd\n");
@@ -37,6 +37,13 @@
 
 #define THRD_PORT_STACK(name, size) char name[sizeof(struct thrd_t) + (size)]
 
+/* Frequency of thrd_port_cycles_get(), the monotonic clock in
+   microseconds. Not given with virtual time, so that the time cycles
+   follow the virtual uptime instead. */
+#if CONFIG_LINUX_VIRTUAL_TIME == 0
+#    define THRD_PORT_CYCLES_FREQUENCY                      1000000UL
+#endif
+
 struct thrd_port_t {
     void *arg_p;
     pthread_t thrd;
@@ -44,6 +51,10 @@ struct thrd_port_t {
     pthread_cond_t cond;
     void *(*main)(void *arg);
     void *arg;
+#if CONFIG_PROFILER == 1
+    /* Highest stack address followed by the profiler. */
+    void *stack_top_p;
+#endif
 };
 
 #endif
@@ -29,11 +29,17 @@
 struct thrd_port_idle_t {
     pthread_mutex_t mutex;
     pthread_cond_t cond;
+    int pending;
 };
 
 static struct thrd_t main_thrd;
 extern char __main_stack_end;
 
+#if CONFIG_PROFILER == 1
+/* Provided by glibc. */
+extern void *__libc_stack_end;
+#endif
+
 static struct thrd_t *thrd_port_get_main_thrd(void)
 {
     return (&main_thrd);
@@ -46,7 +52,8 @@ static char *thrd_port_get_main_thrd_stack_top(void)
 
 static struct thrd_port_idle_t idle = {
     .mutex = PTHREAD_MUTEX_INITIALIZER,
-    .cond = PTHREAD_COND_INITIALIZER
+    .cond = PTHREAD_COND_INITIALIZER,
+    .pending = 0
 };
 
 static void *thrd_port_main(void *arg_p)
@@ -54,6 +61,9 @@ static void *thrd_port_main(void *arg_p)
     struct thrd_port_t *port_p;
 
     port_p = arg_p;
+#if CONFIG_PROFILER == 1
+    port_p->stack_top_p = __builtin_frame_address(0);
+#endif
     pthread_cond_wait(&port_p->cond, &port_p->mutex);
     pthread_mutex_unlock(&port_p->mutex);
     sys_unlock();
@@ -81,6 +91,10 @@ static void thrd_port_init_main(struct thrd_port_t *port_p)
 {
     port_p->main = NULL;
     port_p->arg = NULL;
+#if CONFIG_PROFILER == 1
+    port_p->thrd = pthread_self();
+    port_p->stack_top_p = __libc_stack_end;
+#endif
     pthread_mutex_init(&port_p->mutex, NULL);
     pthread_cond_init (&port_p->cond, NULL);
 }
@@ -97,6 +111,9 @@ static int thrd_port_spawn(struct thrd_t *thrd_p,
     port_p = &thrd_p->port;
     port_p->main = main;
     port_p->arg = arg_p;
+#if CONFIG_PROFILER == 1
+    port_p->stack_top_p = NULL;
+#endif
     pthread_mutex_init(&port_p->mutex, NULL);
     pthread_cond_init (&port_p->cond, NULL);
     pthread_mutex_lock(&port_p->mutex);
@@ -109,14 +126,32 @@ static int thrd_port_spawn(struct thrd_t *thrd_p,
     return (0);
 }
 
+static void thrd_port_signal_idle(void)
+{
+    pthread_mutex_lock(&idle.mutex);
+    idle.pending = 1;
+    pthread_cond_signal(&idle.cond);
+    pthread_mutex_unlock(&idle.mutex);
+}
+
 static void thrd_port_idle_wait(struct thrd_t *thrd_p)
 {
+    sys_lock();
+    sys_idle_enter_isr();
+    sys_unlock();
+
     pthread_mutex_lock(&idle.mutex);
-    pthread_cond_wait(&idle.cond, &idle.mutex);
+
+    while (idle.pending == 0) {
+        pthread_cond_wait(&idle.cond, &idle.mutex);
+    }
+
+    idle.pending = 0;
     pthread_mutex_unlock(&idle.mutex);
 
     /* Add this thread to the ready list and reschedule. */
     sys_lock();
+    sys_idle_exit_isr();
     thrd_p->state = THRD_STATE_READY;
     scheduler_ready_push(thrd_p);
     thrd_reschedule();
@@ -125,18 +160,12 @@ static void thrd_port_idle_wait(struct thrd_t *thrd_p)
 
 static void thrd_port_on_suspend_timer_expired(struct thrd_t *thrd_p)
 {
-    /* Signal idle thrd.*/
-    pthread_mutex_lock(&idle.mutex);
-    pthread_cond_signal(&idle.cond);
-    pthread_mutex_unlock(&idle.mutex);
+    thrd_port_signal_idle();
 }
 
 static void thrd_port_tick(void)
 {
-    /* Signal idle thrd.*/
-    pthread_mutex_lock(&idle.mutex);
-    pthread_cond_signal(&idle.cond);
-    pthread_mutex_unlock(&idle.mutex);
+    thrd_port_signal_idle();
 }
 
 static void thrd_port_cpu_usage_start(struct thrd_t *thrd_p)
@@ -147,6 +176,20 @@ static void thrd_port_cpu_usage_stop(struct thrd_t *thrd_p)
 {
 }
 
+#if CONFIG_THRD_CYCLES_NEEDED == 1
+
+static uint32_t thrd_port_cycles_get(void)
+{
+    struct timespec now;
+
+    /* Microseconds. */
+    clock_gettime(CLOCK_MONOTONIC, &now);
+
+    return (1000000UL * now.tv_sec + now.tv_nsec / 1000);
+}
+
+#endif
+
 #if CONFIG_MONITOR_THREAD == 1
 
 static cpu_usage_t thrd_port_cpu_usage_get(struct thrd_t *thrd_p)
@@ -37,6 +37,8 @@ typedef const FAR char *far_string_t;
 
 #define RAM_CODE
 
+#define FAST_DATA
+
 #define PACKED __attribute__((packed))
 
 #endif
@@ -179,6 +179,20 @@ static int sys_port_backtrace(void **buf_pp, size_t size)
     return (depth);
 }
 
+#if CONFIG_PROFILER == 1
+
+static int sys_port_profiler_start(void)
+{
+    return (-ENOSYS);
+}
+
+static int sys_port_profiler_stop(void)
+{
+    return (-ENOSYS);
+}
+
+#endif
+
 static int32_t sys_port_get_time_into_tick()
 {
     uint32_t count;
@@ -188,6 +202,19 @@ static int32_t sys_port_get_time_into_tick()
     return (1000 * (count / (F_CPU / 1000000)));
 }
 
+#if CONFIG_SYSTEM_TICKLESS == 1
+
+static void sys_port_tickless_enter_isr(uint32_t ticks)
+{
+}
+
+static uint32_t sys_port_tickless_exit_isr(void)
+{
+    return (0);
+}
+
+#endif
+
 static void sys_port_lock(void)
 {
     asm volatile("wrteei 0");
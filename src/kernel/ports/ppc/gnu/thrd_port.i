@@ -106,6 +106,15 @@ static void thrd_port_cpu_usage_stop(struct thrd_t *thrd_p)
     thrd_p->port.cpu.period.time += (SPC5_STM->CNT - thrd_p->port.cpu.start);
 }
 
+#if CONFIG_THRD_CYCLES_NEEDED == 1
+
+static uint32_t thrd_port_cycles_get(void)
+{
+    return (0);
+}
+
+#endif
+
 #if CONFIG_MONITOR_THREAD == 1
 
 #    if CONFIG_FLOAT == 1
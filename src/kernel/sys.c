@@ -32,10 +32,21 @@
 #define SECONDS_PER_MSB (INT_MAX / CONFIG_SYSTEM_TICK_FREQUENCY)
 #define TICKS_PER_MSB   (SECONDS_PER_MSB * CONFIG_SYSTEM_TICK_FREQUENCY)
 
-#if CONFIG_SYS_LOG_MASK > 0
-#    define LOG_OBJECT_PRINT(...) log_object_print(__VA_ARGS__)
+#if CONFIG_SYS_START_TIMES == 1
+
+extern uint32_t thrd_cycles_get_isr(void);
+
+/* Run given startup step and save the number of cycles it took. */
+#    define START_STEP(name, call)                                      \
+    do {                                                                \
+        uint32_t start;                                                 \
+                                                                        \
+        start = thrd_cycles_get_isr();                                  \
+        call;                                                           \
+        start_times_add(FSTR(name), thrd_cycles_get_isr() - start);     \
+    } while (0)
 #else
-#    define LOG_OBJECT_PRINT(...)
+#    define START_STEP(name, call) call
 #endif
 
 /* 64 bits so it does not wrap around during the system's uptime. */
@@ -47,21 +58,43 @@ struct tick_t {
 struct module_t {
     int8_t initialized;
     struct tick_t tick;
+    int lock_prio_depth;
+#if CONFIG_POWER == 1
+    int idle_mode;
+#endif
+#if CONFIG_LOCK_STATS == 1
+    struct lock_stats_t lock_stats;
+#endif
 #if CONFIG_SYS_RESET_CAUSE == 1
     enum sys_reset_cause_t reset_cause;
 #endif
-#if CONFIG_SYS_FS_COMMANDS == 1
-    struct fs_command_t cmd_info;
-    struct fs_command_t cmd_config;
-    struct fs_command_t cmd_uptime;
-    struct fs_command_t cmd_panic;
-    struct fs_command_t cmd_reboot;
-    struct fs_command_t cmd_backtrace;
-    struct fs_command_t cmd_reset_cause;
-#endif
+    struct {
+        struct sys_memory_region_t *head_p;
+        struct sys_memory_region_t *tail_p;
+    } memory;
 };
 
-static struct module_t module;
+/* The tick and lock state is used from the system tick interrupt. */
+static struct module_t module FAST_DATA;
+
+#if CONFIG_SYS_START_TIMES == 1
+
+struct start_step_t {
+    far_string_t name_p;
+    uint32_t cycles;
+};
+
+static struct {
+    struct start_step_t steps[CONFIG_SYS_START_TIMES_MAX];
+    int length;
+} start_times;
+
+#endif
+
+#if CONFIG_START_DEFERRED == 1
+static struct sem_t deferred_sem;
+static THRD_STACK(deferred_stack, CONFIG_START_DEFERRED_STACK_SIZE);
+#endif
 
 struct sys_t sys = {
     .on_fatal_callback = sys_stop,
@@ -86,6 +119,7 @@ static const FAR char config[] =
     "        preemptive-scheduler=" STRINGIFY(CONFIG_PREEMPTIVE_SCHEDULER) "\r\n"
     "        profile-stack=" STRINGIFY(CONFIG_PROFILE_STACK) "\r\n"
     "        system-tick-frequency=" STRINGIFY(CONFIG_SYSTEM_TICK_FREQUENCY) "\r\n"
+    "        system-tickless=" STRINGIFY(CONFIG_SYSTEM_TICKLESS) "\r\n"
 
 #endif
 
@@ -116,6 +150,14 @@ extern void time_tick_isr(void);
 extern void timer_tick_isr(void);
 extern void thrd_tick_isr(void);
 
+#if CONFIG_SYSTEM_TICKLESS == 1
+extern uint32_t timer_tick_next_expiry_isr(void);
+extern void timer_tick_skip_isr(uint32_t ticks);
+#    if CONFIG_THRD_EDF == 1
+extern void thrd_tick_skip_isr(uint32_t ticks);
+#    endif
+#endif
+
 static void RAM_CODE sys_tick_isr(void)
 {
     module.tick.lsb++;
@@ -127,8 +169,42 @@ static void RAM_CODE sys_tick_isr(void)
 
     timer_tick_isr();
     thrd_tick_isr();
+
+#if CONFIG_TIME_CYCLES == 1
+    time_cycles_isr();
+#endif
+}
+
+#if CONFIG_SYSTEM_TICKLESS == 1
+
+/**
+ * Account for given number of ticks that passed without the tick
+ * interrupt being taken. No timer expires.
+ */
+static void sys_tick_skip_isr(uint32_t ticks)
+{
+    if (ticks == 0) {
+        return;
+    }
+
+    module.tick.lsb += ticks;
+
+    while (module.tick.lsb >= TICKS_PER_MSB) {
+        module.tick.msb++;
+        module.tick.lsb -= TICKS_PER_MSB;
+    }
+
+    timer_tick_skip_isr(ticks);
+#if CONFIG_THRD_EDF == 1
+    thrd_tick_skip_isr(ticks);
+#endif
+#if CONFIG_TIME_CYCLES == 1
+    time_cycles_isr();
+#endif
 }
 
+#endif
+
 #include "sys_port.i"
 
 static void tick_to_time(struct time_t *time_p,
@@ -145,139 +221,161 @@ static void tick_to_time(struct time_t *time_p,
                                    / CONFIG_SYSTEM_TICK_FREQUENCY));
 }
 
+#if CONFIG_SYS_START_TIMES == 1
+
+static void start_times_add(far_string_t name_p, uint32_t cycles)
+{
+    struct start_step_t *step_p;
+
+    if (start_times.length == membersof(start_times.steps)) {
+        return;
+    }
+
+    step_p = &start_times.steps[start_times.length];
+    step_p->name_p = name_p;
+    step_p->cycles = cycles;
+    start_times.length++;
+}
+
+#endif
+
 static void init_drivers(void)
 {
 #if CONFIG_MODULE_INIT_ADC == 1
-    adc_module_init();
+    START_STEP("adc", adc_module_init());
 #endif
 
 #if CONFIG_MODULE_INIT_ANALOG_INPUT_PIN == 1
-    analog_input_pin_module_init();
+    START_STEP("analog_input_pin", analog_input_pin_module_init());
 #endif
 
 #if CONFIG_MODULE_INIT_ANALOG_OUTPUT_PIN == 1
-    analog_output_pin_module_init();
+    START_STEP("analog_output_pin", analog_output_pin_module_init());
 #endif
 
 #if CONFIG_MODULE_INIT_CAN == 1
-    can_module_init();
+    START_STEP("can", can_module_init());
 #endif
 
 #if CONFIG_MODULE_INIT_CHIPID == 1
 #endif
 
 #if CONFIG_MODULE_INIT_DAC == 1
-    dac_module_init();
+    START_STEP("dac", dac_module_init());
+#endif
+
+#if CONFIG_MODULE_INIT_DMA == 1
+    START_STEP("dma", dma_module_init());
 #endif
 
 #if CONFIG_MODULE_INIT_DS18B20 == 1
-    ds18b20_module_init();
+    START_STEP("ds18b20", ds18b20_module_init());
 #endif
 
 #if CONFIG_MODULE_INIT_DHT == 1
-    dht_module_init();
+    START_STEP("dht", dht_module_init());
 #endif
 
 #if CONFIG_MODULE_INIT_DS3231 == 1
 #endif
 
 #if CONFIG_MODULE_INIT_ESP_WIFI == 1
-    esp_wifi_module_init();
+    START_STEP("esp_wifi", esp_wifi_module_init());
 #endif
 
 #if CONFIG_MODULE_INIT_EXTI == 1
-    exti_module_init();
+    START_STEP("exti", exti_module_init());
 #endif
 
 #if CONFIG_MODULE_INIT_FLASH == 1
-    flash_module_init();
+    START_STEP("flash", flash_module_init());
 #endif
 
 #if CONFIG_MODULE_INIT_I2C == 1
-    i2c_module_init();
+    START_STEP("i2c", i2c_module_init());
 #endif
 
 #if CONFIG_MODULE_INIT_I2C_SOFT == 1
-    i2c_soft_module_init();
+    START_STEP("i2c_soft", i2c_soft_module_init());
 #endif
 
 #if CONFIG_MODULE_INIT_MCP2515 == 1
 #endif
 
 #if CONFIG_MODULE_INIT_NRF24L01 == 1
-    nrf24l01_module_init();
+    START_STEP("nrf24l01", nrf24l01_module_init());
 #endif
 
 #if CONFIG_MODULE_INIT_OWI == 1
 #endif
 
 #if CONFIG_MODULE_INIT_PIN == 1
-    pin_module_init();
+    START_STEP("pin", pin_module_init());
 #endif
 
 #if CONFIG_MODULE_INIT_POWER == 1
-    power_module_init();
+    START_STEP("power", power_module_init());
 #endif
 
 #if CONFIG_MODULE_INIT_PWM == 1
-    pwm_module_init();
+    START_STEP("pwm", pwm_module_init());
 #endif
 
 #if CONFIG_MODULE_INIT_PWM_SOFT == 1
-    pwm_soft_module_init(500);
+    START_STEP("pwm_soft", pwm_soft_module_init(500));
 #endif
 
 #if CONFIG_MODULE_INIT_SD == 1
 #endif
 
 #if CONFIG_MODULE_INIT_SPI == 1
-    spi_module_init();
+    START_STEP("spi", spi_module_init());
 #endif
 
 #if CONFIG_MODULE_INIT_UART == 1
-    uart_module_init();
+    START_STEP("uart", uart_module_init());
 #endif
 
 #if CONFIG_MODULE_INIT_UART_SOFT == 1
 #endif
 
 #if CONFIG_MODULE_INIT_USB_DEVICE == 1
-    usb_device_module_init();
+    START_STEP("usb_device", usb_device_module_init());
 #endif
 
 #if CONFIG_MODULE_INIT_USB_HOST == 1
-    usb_host_module_init();
+    START_STEP("usb_host", usb_host_module_init());
 #endif
 
 #if CONFIG_MODULE_INIT_WATCHDOG == 1
-    watchdog_module_init();
+    START_STEP("watchdog", watchdog_module_init());
 #endif
 
 #if CONFIG_MODULE_INIT_RANDOM == 1
-    random_module_init();
+    START_STEP("random", random_module_init());
 #endif
 }
 
 static void init_inet(void)
 {
 #if CONFIG_MODULE_INIT_INET == 1
-    inet_module_init();
+    START_STEP("inet", inet_module_init());
 #endif
 
 #if CONFIG_MODULE_INIT_PING == 1
-    ping_module_init();
+    START_STEP("ping", ping_module_init());
 #endif
 
 #if CONFIG_MODULE_INIT_SOCKET == 1
-    socket_module_init();
+    START_STEP("socket", socket_module_init());
 #endif
 
 #if CONFIG_MODULE_INIT_NETWORK_INTERFACE == 1
-    network_interface_module_init();
+    START_STEP("network_interface", network_interface_module_init());
 #endif
 
 #if CONFIG_MODULE_INIT_SSL == 1
-    ssl_module_init();
+    START_STEP("ssl", ssl_module_init());
 #endif
 }
 
@@ -415,6 +513,42 @@ static int cmd_reset_cause_cb(int argc,
     return (0);
 }
 
+static int cmd_memory_cb(int argc,
+                         const char *argv[],
+                         void *out_p,
+                         void *in_p,
+                         void *arg_p,
+                         void *call_arg_p)
+{
+    return (sys_memory_print(out_p));
+}
+
+static int cmd_start_cb(int argc,
+                        const char *argv[],
+                        void *out_p,
+                        void *in_p,
+                        void *arg_p,
+                        void *call_arg_p)
+{
+    return (sys_start_print(out_p));
+}
+
+FS_COMMAND_DEFINE(sys_info, "/kernel/sys/info", cmd_info_cb, NULL);
+FS_COMMAND_DEFINE(sys_config, "/kernel/sys/config", cmd_config_cb, NULL);
+FS_COMMAND_DEFINE(sys_uptime, "/kernel/sys/uptime", cmd_uptime_cb, NULL);
+FS_COMMAND_DEFINE(sys_panic, "/kernel/sys/panic", cmd_panic_cb, NULL);
+FS_COMMAND_DEFINE(sys_reboot, "/kernel/sys/reboot", cmd_reboot_cb, NULL);
+FS_COMMAND_DEFINE(sys_backtrace,
+                  "/kernel/sys/backtrace",
+                  cmd_backtrace_cb,
+                  NULL);
+FS_COMMAND_DEFINE(sys_reset_cause,
+                  "/kernel/sys/reset_cause",
+                  cmd_reset_cause_cb,
+                  NULL);
+FS_COMMAND_DEFINE(sys_memory, "/kernel/sys/memory", cmd_memory_cb, NULL);
+FS_COMMAND_DEFINE(sys_start, "/kernel/sys/start", cmd_start_cb, NULL);
+
 #endif
 
 static ssize_t panic_write(void *self_p,
@@ -433,6 +567,55 @@ static ssize_t panic_write(void *self_p,
     return (size);
 }
 
+/**
+ * Start services that the application may use later, if at all. They
+ * are started in a low priority thread after main() if
+ * CONFIG_START_DEFERRED is set.
+ */
+static void start_services(void)
+{
+    init_inet();
+
+#if CONFIG_START_NVM == 1
+    START_STEP("start_nvm", start_nvm());
+#endif
+
+#if CONFIG_MODULE_INIT_SETTINGS == 1
+    START_STEP("settings", settings_module_init());
+#endif
+
+#if CONFIG_START_FILESYSTEM == 1
+    START_STEP("start_filesystem", start_filesystem());
+#endif
+
+#if CONFIG_START_NETWORK == 1
+    START_STEP("start_network", start_network());
+#endif
+
+#if CONFIG_MODULE_INIT_UPGRADE == 1
+    START_STEP("upgrade", upgrade_module_init());
+#endif
+}
+
+#if CONFIG_START_DEFERRED == 1
+
+static void *deferred_main(void *arg_p)
+{
+    thrd_set_name("sys_start");
+
+    start_services();
+    sem_give(&deferred_sem, 1);
+
+#if CONFIG_THRD_TERMINATE == 0
+    /* Returning would terminate the thread. */
+    thrd_suspend(NULL);
+#endif
+
+    return (NULL);
+}
+
+#endif
+
 int sys_module_init(void)
 {
     /* Return immediately if the module is already initialized. */
@@ -442,48 +625,20 @@ int sys_module_init(void)
 
     module.initialized = 1;
 
+#if CONFIG_LOCK_STATS == 1
+    lock_stats_register(&module.lock_stats, "sys");
+#endif
+
 #if CONFIG_SYS_FS_COMMANDS == 1
-    fs_command_init(&module.cmd_info,
-                    CSTR("/kernel/sys/info"),
-                    cmd_info_cb,
-                    NULL);
-    fs_command_register(&module.cmd_info);
-
-    fs_command_init(&module.cmd_config,
-                    CSTR("/kernel/sys/config"),
-                    cmd_config_cb,
-                    NULL);
-    fs_command_register(&module.cmd_config);
-
-    fs_command_init(&module.cmd_uptime,
-                    CSTR("/kernel/sys/uptime"),
-                    cmd_uptime_cb,
-                    NULL);
-    fs_command_register(&module.cmd_uptime);
-
-    fs_command_init(&module.cmd_panic,
-                    CSTR("/kernel/sys/panic"),
-                    cmd_panic_cb,
-                    NULL);
-    fs_command_register(&module.cmd_panic);
-
-    fs_command_init(&module.cmd_reboot,
-                    CSTR("/kernel/sys/reboot"),
-                    cmd_reboot_cb,
-                    NULL);
-    fs_command_register(&module.cmd_reboot);
-
-    fs_command_init(&module.cmd_backtrace,
-                    CSTR("/kernel/sys/backtrace"),
-                    cmd_backtrace_cb,
-                    NULL);
-    fs_command_register(&module.cmd_backtrace);
-
-    fs_command_init(&module.cmd_reset_cause,
-                    CSTR("/kernel/sys/reset_cause"),
-                    cmd_reset_cause_cb,
-                    NULL);
-    fs_command_register(&module.cmd_reset_cause);
+    FS_COMMAND_REGISTER(sys_info);
+    FS_COMMAND_REGISTER(sys_config);
+    FS_COMMAND_REGISTER(sys_uptime);
+    FS_COMMAND_REGISTER(sys_panic);
+    FS_COMMAND_REGISTER(sys_reboot);
+    FS_COMMAND_REGISTER(sys_backtrace);
+    FS_COMMAND_REGISTER(sys_reset_cause);
+    FS_COMMAND_REGISTER(sys_memory);
+    FS_COMMAND_REGISTER(sys_start);
 #endif
 
     return (sys_port_module_init());
@@ -495,77 +650,124 @@ int sys_start(void)
     sys.stdout_p = chan_null();
 
 #if CONFIG_MODULE_INIT_RWLOCK == 1
-    rwlock_module_init();
+    START_STEP("rwlock", rwlock_module_init());
 #endif
 #if CONFIG_MODULE_INIT_FS == 1
-    fs_module_init();
+    START_STEP("fs", fs_module_init());
 #endif
 #if CONFIG_MODULE_INIT_STD == 1
-    std_module_init();
+    START_STEP("std", std_module_init());
 #endif
 #if CONFIG_MODULE_INIT_SEM == 1
-    sem_module_init();
+    START_STEP("sem", sem_module_init());
 #endif
 #if CONFIG_MODULE_INIT_TIMER == 1
-    timer_module_init();
+    START_STEP("timer", timer_module_init());
 #endif
 #if CONFIG_MODULE_INIT_LOG == 1
-    log_module_init();
+    START_STEP("log", log_module_init());
+#endif
+#if CONFIG_TRACE == 1
+    START_STEP("trace", trace_module_init());
+#endif
+#if CONFIG_PROFILER == 1
+    START_STEP("profiler", profiler_module_init());
+#endif
+#if CONFIG_LOCK_STATS == 1
+    START_STEP("lock_stats", lock_stats_module_init());
+#endif
+#if CONFIG_ISR_STATS == 1
+    START_STEP("isr_stats", isr_stats_module_init());
 #endif
 #if CONFIG_MODULE_INIT_CHAN == 1
-    chan_module_init();
+    START_STEP("chan", chan_module_init());
 #endif
 #if CONFIG_MODULE_INIT_THRD == 1
-    thrd_module_init();
+    START_STEP("thrd", thrd_module_init());
 #endif
 #if CONFIG_MODULE_INIT_SHELL == 1
-    shell_module_init();
+    START_STEP("shell", shell_module_init());
 #endif
-    sys_module_init();
+    START_STEP("sys", sys_module_init());
 #if CONFIG_MODULE_INIT_BUS == 1
-    bus_module_init();
+    START_STEP("bus", bus_module_init());
 #endif
 
     init_drivers();
-    init_inet();
 
 #if CONFIG_START_CONSOLE != CONFIG_START_CONSOLE_NONE
-    start_console();
+    START_STEP("start_console", start_console());
 #endif
 
 #if CONFIG_START_SHELL == 1
-    start_shell();
+    START_STEP("start_shell", start_shell());
 #endif
 
 #if CONFIG_START_SOAM == 1
-    start_soam();
+    START_STEP("start_soam", start_soam());
 #endif
 
-#if CONFIG_START_NVM == 1
-    start_nvm();
+#if CONFIG_START_DEFERRED == 1
+    sem_init(&deferred_sem, 1, 1);
+    thrd_spawn(deferred_main,
+               NULL,
+               CONFIG_START_DEFERRED_PRIO,
+               deferred_stack,
+               sizeof(deferred_stack));
+#else
+    start_services();
 #endif
 
-#if CONFIG_MODULE_INIT_SETTINGS == 1
-    settings_module_init();
-#endif
+    return (0);
+}
 
-#if CONFIG_START_FILESYSTEM == 1
-    start_filesystem();
+int sys_start_wait(void)
+{
+#if CONFIG_START_DEFERRED == 1
+    sem_take(&deferred_sem, NULL);
+    sem_give(&deferred_sem, 1);
 #endif
 
-#if CONFIG_START_NETWORK == 1
-    start_network();
-#endif
+    return (0);
+}
 
-#if CONFIG_MODULE_INIT_UPGRADE == 1
-    upgrade_module_init();
-#endif
+int sys_start_print(void *chan_p)
+{
+    ASSERTN(chan_p != NULL, EINVAL);
+
+#if CONFIG_SYS_START_TIMES == 1
+    int i;
+    uint32_t total;
+
+    std_fprintf(chan_p, OSTR("NAME                     CYCLES\r\n"));
+
+    total = 0;
+
+    for (i = 0; i < start_times.length; i++) {
+        std_fprintf(chan_p,
+                    OSTR("%-20S %10lu\r\n"),
+                    start_times.steps[i].name_p,
+                    (unsigned long)start_times.steps[i].cycles);
+        total += start_times.steps[i].cycles;
+    }
+
+    std_fprintf(chan_p,
+                OSTR("%-20s %10lu\r\n"),
+                "total",
+                (unsigned long)total);
 
     return (0);
+#else
+    return (-ENOSYS);
+#endif
 }
 
 void sys_stop(int error)
 {
+#if CONFIG_START_CONSOLE_OUTPUT_BUFFER_SIZE > 0
+    console_flush();
+#endif
+
     sys_port_stop(error);
 }
 
@@ -627,6 +829,135 @@ int sys_backtrace(void **buf_pp, size_t size)
     return (sys_port_backtrace(buf_pp, size));
 }
 
+int sys_memory_region_init(struct sys_memory_region_t *self_p,
+                           const char *name_p,
+                           const void *buf_p,
+                           size_t size,
+                           sys_memory_usage_fn_t usage,
+                           void *arg_p)
+{
+    ASSERTN(self_p != NULL, EINVAL);
+    ASSERTN(name_p != NULL, EINVAL);
+
+    self_p->name_p = name_p;
+    self_p->buf_p = buf_p;
+    self_p->size = size;
+    self_p->usage = usage;
+    self_p->arg_p = arg_p;
+    self_p->next_p = NULL;
+
+    return (0);
+}
+
+int sys_memory_region_register(struct sys_memory_region_t *self_p)
+{
+    ASSERTN(self_p != NULL, EINVAL);
+
+    sys_lock();
+
+    if (module.memory.head_p == NULL) {
+        module.memory.head_p = self_p;
+    } else {
+        module.memory.tail_p->next_p = self_p;
+    }
+
+    module.memory.tail_p = self_p;
+
+    sys_unlock();
+
+    return (0);
+}
+
+int sys_memory_region_get_usage(struct sys_memory_region_t *self_p,
+                                struct sys_memory_usage_t *usage_p)
+{
+    ASSERTN(self_p != NULL, EINVAL);
+    ASSERTN(usage_p != NULL, EINVAL);
+
+    usage_p->size = self_p->size;
+    usage_p->used = self_p->size;
+    usage_p->used_max = self_p->size;
+
+    if (self_p->usage == NULL) {
+        return (0);
+    }
+
+    return (self_p->usage(self_p->arg_p, usage_p));
+}
+
+int sys_memory_print(void *chan_p)
+{
+    ASSERTN(chan_p != NULL, EINVAL);
+
+    struct sys_memory_region_t *region_p;
+    struct sys_memory_usage_t usage;
+
+    std_fprintf(chan_p,
+                OSTR("NAME                 ADDRESS          SIZE      USED"
+                     "       MAX  MAX%%\r\n"));
+
+    region_p = module.memory.head_p;
+
+    while (region_p != NULL) {
+        if (sys_memory_region_get_usage(region_p, &usage) != 0) {
+            usage.used = -1;
+            usage.used_max = -1;
+        }
+
+        std_fprintf(chan_p, OSTR("%-20s "), region_p->name_p);
+
+        if (region_p->buf_p != NULL) {
+            std_fprintf(chan_p,
+                        OSTR("0x%08lx "),
+                        (unsigned long)(uintptr_t)region_p->buf_p);
+        } else {
+            std_fprintf(chan_p, OSTR("-          "));
+        }
+
+        std_fprintf(chan_p, OSTR("%9lu "), (unsigned long)usage.size);
+
+        if (usage.used >= 0) {
+            std_fprintf(chan_p, OSTR("%9lu "), (unsigned long)usage.used);
+        } else {
+            std_fprintf(chan_p, OSTR("        - "));
+        }
+
+        if (usage.used_max >= 0) {
+            std_fprintf(chan_p,
+                        OSTR("%9lu %4u%%\r\n"),
+                        (unsigned long)usage.used_max,
+                        (unsigned int)(usage.size > 0
+                                       ? ((100UL * usage.used_max)
+                                          / usage.size)
+                                       : 0));
+        } else {
+            std_fprintf(chan_p, OSTR("        -     -\r\n"));
+        }
+
+        region_p = region_p->next_p;
+    }
+
+    return (0);
+}
+
+#if CONFIG_PROFILER == 1
+
+/**
+ * Start and stop the port sampling interrupt, used by the profiler
+ * module.
+ */
+int sys_profiler_start(void)
+{
+    return (sys_port_profiler_start());
+}
+
+int sys_profiler_stop(void)
+{
+    return (sys_port_profiler_stop());
+}
+
+#endif
+
 enum sys_reset_cause_t sys_reset_cause()
 {
 #if CONFIG_SYS_RESET_CAUSE == 1
@@ -705,26 +1036,102 @@ void *sys_get_stdout()
     return (sys.stdout_p);
 }
 
-void sys_lock()
+void (sys_lock)()
 {
+    LOCK_STATS_WAIT_BEGIN_ISR(start);
+
     sys_port_lock();
+    LOCK_STATS_TAKEN_ISR(&module.lock_stats, start);
+    ISR_STATS_MASKED_BEGIN_ISR();
 }
 
-void sys_unlock()
+void (sys_unlock)()
 {
+    ISR_STATS_MASKED_END_ISR();
+    LOCK_STATS_GIVEN_ISR(&module.lock_stats);
     sys_port_unlock();
 }
 
-void RAM_CODE sys_lock_isr()
+void RAM_CODE (sys_lock_isr)()
 {
     sys_port_lock_isr();
 }
 
-void RAM_CODE sys_unlock_isr()
+void RAM_CODE (sys_unlock_isr)()
 {
     sys_port_unlock_isr();
 }
 
+int sys_lock_prio(int prio)
+{
+#if defined(SYS_PORT_HAS_LOCK_PRIO)
+    return (sys_port_lock_prio(prio));
+#else
+    if (module.lock_prio_depth == 0) {
+        sys_lock();
+    }
+
+    module.lock_prio_depth++;
+
+    return (0);
+#endif
+}
+
+void sys_unlock_prio(int state)
+{
+#if defined(SYS_PORT_HAS_LOCK_PRIO)
+    sys_port_unlock_prio(state);
+#else
+    module.lock_prio_depth--;
+
+    if (module.lock_prio_depth == 0) {
+        sys_unlock();
+    }
+#endif
+}
+
+void sys_tickless_enter_isr(void)
+{
+#if CONFIG_SYSTEM_TICKLESS == 1
+    sys_port_tickless_enter_isr(timer_tick_next_expiry_isr());
+#endif
+}
+
+void sys_tickless_exit_isr(void)
+{
+#if CONFIG_SYSTEM_TICKLESS == 1
+    sys_tick_skip_isr(sys_port_tickless_exit_isr());
+#endif
+}
+
+void sys_idle_enter_isr(void)
+{
+    uint32_t ticks;
+
+#if CONFIG_SYSTEM_TICKLESS == 1
+    ticks = timer_tick_next_expiry_isr();
+    sys_port_tickless_enter_isr(ticks);
+#else
+    /* The next tick. */
+    ticks = 1;
+#endif
+
+#if CONFIG_POWER == 1
+    module.idle_mode = power_idle_enter_isr(ticks);
+#else
+    (void)ticks;
+#endif
+}
+
+void sys_idle_exit_isr(void)
+{
+#if CONFIG_POWER == 1
+    power_idle_exit_isr(module.idle_mode);
+#endif
+
+    sys_tickless_exit_isr();
+}
+
 far_string_t sys_get_info()
 {
     return (sysinfo);
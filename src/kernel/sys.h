@@ -45,6 +45,43 @@ typedef uint32_t cpu_usage_t;
 
 typedef void (*sys_on_fatal_fn_t)(int error);
 
+/**
+ * Memory region usage, see `sys_memory_region_get_usage()`.
+ */
+struct sys_memory_usage_t {
+    /** Region capacity in bytes. */
+    size_t size;
+    /** Number of bytes in use, or negative if unknown. */
+    ssize_t used;
+    /** Maximum number of bytes in use, or negative if unknown. */
+    ssize_t used_max;
+};
+
+/**
+ * Fill in the usage of a memory region. The size is initialized to
+ * the region size and the used fields to the size before the call.
+ *
+ * @param[in] arg_p Argument given to `sys_memory_region_init()`.
+ * @param[in,out] usage_p Region usage.
+ *
+ * @return zero(0) or negative error code.
+ */
+typedef int (*sys_memory_usage_fn_t)(void *arg_p,
+                                     struct sys_memory_usage_t *usage_p);
+
+/**
+ * A named memory region, listed by `sys_memory_print()` once
+ * registered.
+ */
+struct sys_memory_region_t {
+    const char *name_p;
+    const void *buf_p;
+    size_t size;
+    sys_memory_usage_fn_t usage;
+    void *arg_p;
+    struct sys_memory_region_t *next_p;
+};
+
 /**
  * System reset causes.
  */
@@ -121,6 +158,31 @@ int sys_module_init(void);
  */
 int sys_start(void);
 
+/**
+ * Wait for the services started in the background by `sys_start()`
+ * to be started, if ``CONFIG_START_DEFERRED`` is set. Call this
+ * function before using the network, file system, non-volatile
+ * memory, settings or upgrade modules. Returns immediately if the
+ * services are already started, or if they were started by
+ * `sys_start()` itself.
+ *
+ * @return zero(0) or negative error code.
+ */
+int sys_start_wait(void);
+
+/**
+ * Print the number of cycles each module initialization and start
+ * step of `sys_start()` took, in startup order. Requires
+ * ``CONFIG_SYS_START_TIMES``. The cycle counter is the one used by
+ * ``CONFIG_THRD_CYCLES``, and it is started by the thrd module, so
+ * steps before it may be reported as zero cycles.
+ *
+ * @param[in] chan_p Output channel.
+ *
+ * @return zero(0) or negative error code.
+ */
+int sys_start_print(void *chan_p);
+
 /**
  * Stop the system.
  *
@@ -261,6 +323,86 @@ void sys_lock_isr(void);
  */
 void sys_unlock_isr(void);
 
+/* Ports with a single instruction system lock inline it. The
+   functions above still exist, with their names in parentheses, so
+   their addresses can be taken. */
+#if defined(SYS_PORT_INLINE_LOCK)                               \
+    && (CONFIG_LOCK_STATS == 0)                                 \
+    && (CONFIG_ISR_STATS == 0)
+#    define sys_lock() SYS_PORT_INLINE_LOCK()
+#    define sys_unlock() SYS_PORT_INLINE_UNLOCK()
+#    define sys_lock_isr() SYS_PORT_INLINE_LOCK_ISR()
+#    define sys_unlock_isr() SYS_PORT_INLINE_UNLOCK_ISR()
+#endif
+
+/**
+ * Enter a critical section that masks interrupts with given or lower
+ * priority, that is, with a numerically equal or higher 8 bits NVIC
+ * priority value. Higher priority interrupts stay enabled. Used by
+ * subsystems to protect data shared with their own interrupt service
+ * routines without masking unrelated interrupts. Critical sections
+ * may be nested, and must be left in the reverse order they were
+ * entered.
+ *
+ * On ARM Cortex-M3 and Cortex-M4 the critical section is implemented
+ * with ``BASEPRI`` and may be entered from both thread and interrupt
+ * context. Cortex-M0 masks all interrupts. Other ports take the
+ * system lock, so the critical section must not be entered with the
+ * system lock taken, or from interrupt context.
+ *
+ * @param[in] prio Non-zero priority to mask.
+ *
+ * @return State to pass to `sys_unlock_prio()`.
+ */
+int sys_lock_prio(int prio);
+
+/**
+ * Leave a critical section entered with `sys_lock_prio()`.
+ *
+ * @param[in] state State returned by `sys_lock_prio()`.
+ *
+ * @return void.
+ */
+void sys_unlock_prio(int state);
+
+/**
+ * Program the system tick timer to interrupt when the next timer
+ * expires instead of on every tick, if the port supports tickless
+ * idle (see ``CONFIG_SYSTEM_TICKLESS``). Called by the idle thread
+ * with the system lock taken just before it waits for an interrupt.
+ *
+ * @return void.
+ */
+void sys_tickless_enter_isr(void);
+
+/**
+ * Account for the ticks that passed while waiting for an interrupt in
+ * the idle thread and restart the periodic system tick. Called by the
+ * idle thread with the system lock taken when woken up.
+ *
+ * @return void.
+ */
+void sys_tickless_exit_isr(void);
+
+/**
+ * Prepare for waiting for an interrupt in the idle thread. Enters
+ * tickless mode, if enabled, and the deepest sleep mode allowed by
+ * the power driver (see ``CONFIG_POWER``). Called by the idle thread
+ * with the system lock taken.
+ *
+ * @return void.
+ */
+void sys_idle_enter_isr(void);
+
+/**
+ * Leave the sleep mode and tickless mode entered by
+ * `sys_idle_enter_isr()`. Called by the idle thread with the system
+ * lock taken when woken up.
+ *
+ * @return void.
+ */
+void sys_idle_exit_isr(void);
+
 /**
  * Get a pointer to the application information string.
  *
@@ -298,4 +440,58 @@ void sys_interrupt_cpu_usage_reset(void);
  */
 far_string_t sys_reset_cause_as_string(enum sys_reset_cause_t reset_cause);
 
+/**
+ * Initialize given memory region. A static region, for example a
+ * buffer that is always fully used, has no usage callback.
+ *
+ * @param[in] self_p Memory region to initialize.
+ * @param[in] name_p Region name.
+ * @param[in] buf_p Start address of the region, or NULL if the region
+ *                  is not contiguous.
+ * @param[in] size Region size in bytes.
+ * @param[in] usage Usage callback, or NULL if all of the region is
+ *                  always in use.
+ * @param[in] arg_p Usage callback argument.
+ *
+ * @return zero(0) or negative error code.
+ */
+int sys_memory_region_init(struct sys_memory_region_t *self_p,
+                           const char *name_p,
+                           const void *buf_p,
+                           size_t size,
+                           sys_memory_usage_fn_t usage,
+                           void *arg_p);
+
+/**
+ * Add given memory region to the list printed by
+ * `sys_memory_print()`. A registered region must never go out of
+ * scope.
+ *
+ * @param[in] self_p Memory region to register.
+ *
+ * @return zero(0) or negative error code.
+ */
+int sys_memory_region_register(struct sys_memory_region_t *self_p);
+
+/**
+ * Get the current usage of given memory region.
+ *
+ * @param[in] self_p Memory region.
+ * @param[out] usage_p Region usage.
+ *
+ * @return zero(0) or negative error code.
+ */
+int sys_memory_region_get_usage(struct sys_memory_region_t *self_p,
+                                struct sys_memory_usage_t *usage_p);
+
+/**
+ * Print the usage of all registered memory regions, in registration
+ * order.
+ *
+ * @param[in] chan_p Output channel.
+ *
+ * @return zero(0) or negative error code.
+ */
+int sys_memory_print(void *chan_p);
+
 #endif
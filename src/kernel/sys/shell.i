@@ -31,9 +31,18 @@ static THRD_STACK(shell_stack, CONFIG_START_SHELL_STACK_SIZE);
 
 static int start_shell(void)
 {
+    void *chout_p;
+
+    /* The shell output is never dropped by the console. */
+    chout_p = sys_get_stdout();
+
+    if (chout_p == console_get_output_channel()) {
+        chout_p = console_get_priority_output_channel();
+    }
+
     shell_init(&shell,
                sys_get_stdin(),
-               sys_get_stdout(),
+               chout_p,
                NULL,
                NULL,
                NULL,
@@ -71,8 +71,8 @@ static int start_soam(void)
     }
 
     res = soam_init(&soam,
-                    &soam_buf[0],
-                    sizeof(soam_buf),
+                    &soam_tx_buf[0],
+                    sizeof(soam_tx_buf),
                     slip_get_output_channel(&slip));
 
     if (res != 0) {
@@ -41,16 +41,53 @@ enum thrd_state_t {
 #define THRD_STACK_LOW_MAGIC      0x1337
 #define THRD_FILL_PATTERN           0x19
 
+#if CONFIG_THRD_SCHEDULER_BITMAP == 1
+
+/* One level per possible thread priority. Level zero is the highest
+   priority, -128. */
+#define READY_QUEUE_LEVELS                256
+#define READY_QUEUE_WORDS                 (READY_QUEUE_LEVELS / 32)
+
+struct ready_queue_fifo_t {
+    struct thrd_prio_list_elem_t *head_p;
+    struct thrd_prio_list_elem_t *tail_p;
+};
+
+/* A bitmap with one bit per non-empty level, and a summary bitmap
+   with one bit per non-zero bitmap word. */
+struct ready_queue_t {
+    uint8_t summary;
+    uint32_t bitmap[READY_QUEUE_WORDS];
+    struct ready_queue_fifo_t fifos[READY_QUEUE_LEVELS];
+};
+
+#endif
+
 struct module_t {
     int8_t initialized;
     struct {
         struct thrd_t *current_p;
+#if CONFIG_THRD_SCHEDULER_BITMAP == 1
+        struct ready_queue_t ready;
+#else
         struct thrd_prio_list_t ready;
+#endif
+#if CONFIG_THRD_CYCLES == 1
+        uint32_t slice_start;
+#endif
+#if CONFIG_THRD_EDF == 1
+        struct {
+            struct thrd_prio_list_t ready;
+            uint32_t tick;
+        } edf;
+#endif
     } scheduler;
     struct thrd_t *threads_p;
+    struct sys_memory_region_t stacks_region;
 #if CONFIG_THRD_ENV == 1
     struct {
-        struct thrd_environment_variable_t global_variables[4];
+        struct thrd_environment_variable_t global_variables[
+            CONFIG_THRD_ENV_GLOBAL_VARIABLES_MAX];
         struct thrd_environment_t global;
         struct mutex_t mutex;
     } env;
@@ -58,6 +95,13 @@ struct module_t {
 #if CONFIG_THRD_FS_COMMANDS == 1
     struct fs_command_t cmd_list;
     struct fs_command_t cmd_set_log_mask;
+#    if CONFIG_THRD_CYCLES == 1
+    struct fs_counter_t context_switches;
+#    endif
+#    if CONFIG_THRD_EDF == 1
+    struct fs_counter_t deadline_misses;
+    struct fs_counter_t budget_overruns;
+#    endif
 #endif
 #if CONFIG_MONITOR_THREAD == 1
     struct fs_command_t cmd_monitor_set_period_ms;
@@ -65,16 +109,213 @@ struct module_t {
 #endif
 };
 
-static struct module_t module;
+/* Accessed on every context switch and system tick, but never by
+   DMA. */
+static struct module_t module FAST_DATA;
 
 #if CONFIG_THRD_STACK_HEAP == 1
 static struct heap_t stack_heap;
 static THRD_STACK(stack_heap_buffer, CONFIG_THRD_STACK_HEAP_SIZE);
-static size_t stack_heap_fixed_buffer_sizes[HEAP_FIXED_SIZES_MAX] = { 0, };
+static size_t stack_heap_fixed_buffer_sizes[HEAP_FIXED_SIZES_MAX] = {
+    CONFIG_THRD_STACK_HEAP_FIXED_SIZES
+};
 #endif
 
 #if CONFIG_THRD_ENV == 1
 
+#if CONFIG_THRD_ENV_HASH == 1
+
+/**
+ * 32 bits FNV-1a hash of given variable name.
+ */
+static uint32_t env_hash(const char *name_p)
+{
+    uint32_t hash;
+
+    hash = 2166136261UL;
+
+    while (*name_p != '\0') {
+        hash ^= (uint8_t)*name_p++;
+        hash *= 16777619UL;
+    }
+
+    return (hash);
+}
+
+/**
+ * Open addressing with linear probing. Find the slot of given
+ * variable, or the empty slot ending its probe sequence.
+ *
+ * @return Slot index, or -1 if the variable is missing and there is
+ *         no empty slot.
+ */
+static int env_find(struct thrd_environment_t *env_p,
+                    const char *name_p,
+                    uint32_t hash)
+{
+    size_t i;
+    size_t index;
+    struct thrd_environment_variable_t *variable_p;
+
+    index = (hash % env_p->max_number_of_variables);
+
+    for (i = 0; i < env_p->max_number_of_variables; i++) {
+        variable_p = &env_p->variables_p[index];
+
+        if (variable_p->name_p == NULL) {
+            return (index);
+        }
+
+        if ((variable_p->hash == hash)
+            && (strcmp(variable_p->name_p, name_p) == 0)) {
+            return (index);
+        }
+
+        index++;
+
+        if (index == env_p->max_number_of_variables) {
+            index = 0;
+        }
+    }
+
+    return (-1);
+}
+
+/**
+ * Remove the variable in given slot and move following variables in
+ * the same probe sequence backwards to keep the sequence unbroken.
+ */
+static void env_remove(struct thrd_environment_t *env_p, size_t index)
+{
+    size_t i;
+    size_t next;
+    size_t home;
+    struct thrd_environment_variable_t *variables_p;
+
+    variables_p = env_p->variables_p;
+    next = index;
+
+    for (i = 1; i < env_p->max_number_of_variables; i++) {
+        next++;
+
+        if (next == env_p->max_number_of_variables) {
+            next = 0;
+        }
+
+        if (variables_p[next].name_p == NULL) {
+            break;
+        }
+
+        home = (variables_p[next].hash % env_p->max_number_of_variables);
+
+        /* Move the variable if the emptied slot is between its home
+           slot and its current slot. */
+        if (((index <= next) && ((home <= index) || (home > next)))
+            || ((index > next) && ((home <= index) && (home > next)))) {
+            variables_p[index] = variables_p[next];
+            index = next;
+        }
+    }
+
+    variables_p[index].name_p = NULL;
+    variables_p[index].value_p = NULL;
+    env_p->number_of_variables--;
+}
+
+static void init_env(struct thrd_environment_t *env_p,
+                     struct thrd_environment_variable_t *variables_p,
+                     size_t length)
+{
+    size_t i;
+
+    for (i = 0; i < length; i++) {
+        variables_p[i].name_p = NULL;
+        variables_p[i].value_p = NULL;
+    }
+
+    env_p->variables_p = variables_p;
+    env_p->number_of_variables = 0;
+    env_p->max_number_of_variables = length;
+}
+
+static int set_env(struct thrd_environment_t *env_p,
+                   const char *name_p,
+                   const char *value_p)
+{
+    int index;
+    uint32_t hash;
+    struct thrd_environment_variable_t *variable_p;
+
+    if (env_p->max_number_of_variables == 0) {
+        return (-1);
+    }
+
+    hash = env_hash(name_p);
+    index = env_find(env_p, name_p, hash);
+
+    /* Missing variable and no free space. */
+    if (index == -1) {
+        return ((value_p == NULL) ? 0 : -1);
+    }
+
+    variable_p = &env_p->variables_p[index];
+
+    if (variable_p->name_p != NULL) {
+        if (value_p != NULL) {
+            /* Replace the value. */
+            variable_p->value_p = value_p;
+        } else {
+            /* Remove the variable. */
+            env_remove(env_p, index);
+        }
+
+        return (0);
+    }
+
+    if (value_p == NULL) {
+        return (0);
+    }
+
+
+    /* Set the new variable. */
+    variable_p->name_p = name_p;
+    variable_p->value_p = value_p;
+    variable_p->hash = hash;
+    env_p->number_of_variables++;
+
+    return (0);
+}
+
+static const char *get_env(struct thrd_environment_t *env_p,
+                           const char *name_p)
+{
+    int index;
+
+    if (env_p->number_of_variables == 0) {
+        return (NULL);
+    }
+
+    index = env_find(env_p, name_p, env_hash(name_p));
+
+    if (index == -1) {
+        return (NULL);
+    }
+
+    /* The value of an empty slot is NULL. */
+    return (env_p->variables_p[index].value_p);
+}
+
+#else
+
+static void init_env(struct thrd_environment_t *env_p,
+                     struct thrd_environment_variable_t *variables_p,
+                     size_t length)
+{
+    env_p->variables_p = variables_p;
+    env_p->number_of_variables = 0;
+    env_p->max_number_of_variables = length;
+}
+
 static int set_env(struct thrd_environment_t *env_p,
                    const char *name_p,
                    const char *value_p)
@@ -136,6 +377,8 @@ static const char *get_env(struct thrd_environment_t *env_p,
 
 #endif
 
+#endif
+
 /* Forward declarations for thrd_port. */
 static void scheduler_ready_push(struct thrd_t *thrd_p);
 
@@ -182,6 +425,8 @@ static void on_suspend_timer_expired(void *arg_p)
     /* The timer is no longer in use. */
     thrd_p->timer_p = NULL;
 
+    TRACE_ISR(THRD_RESUME, thrd_p, thrd_p->prio);
+
     /* Push thread on scheduler ready queue. */
     thrd_p->err = -ETIMEDOUT;
     thrd_p->state = THRD_STATE_READY;
@@ -190,6 +435,220 @@ static void on_suspend_timer_expired(void *arg_p)
     thrd_port_on_suspend_timer_expired(thrd_p);
 }
 
+#if CONFIG_THRD_SCHEDULER_BITMAP == 1
+
+static void ready_queue_init(struct ready_queue_t *self_p)
+{
+    memset(self_p, 0, sizeof(*self_p));
+}
+
+static RAM_CODE void ready_queue_push(struct ready_queue_t *self_p,
+                                      struct thrd_t *thrd_p)
+{
+    struct ready_queue_fifo_t *fifo_p;
+    struct thrd_prio_list_elem_t *elem_p;
+    int level;
+
+    level = (thrd_p->prio + 128);
+    thrd_p->scheduler.level = level;
+    elem_p = &thrd_p->scheduler.elem;
+    elem_p->next_p = NULL;
+    fifo_p = &self_p->fifos[level];
+
+    if (fifo_p->head_p == NULL) {
+        fifo_p->head_p = elem_p;
+        self_p->bitmap[level / 32] |= (1UL << (level % 32));
+        self_p->summary |= (1 << (level / 32));
+    } else {
+        fifo_p->tail_p->next_p = elem_p;
+    }
+
+    fifo_p->tail_p = elem_p;
+}
+
+static RAM_CODE void ready_queue_clear_level(struct ready_queue_t *self_p,
+                                             int level)
+{
+    self_p->bitmap[level / 32] &= ~(1UL << (level % 32));
+
+    if (self_p->bitmap[level / 32] == 0) {
+        self_p->summary &= ~(1 << (level / 32));
+    }
+}
+
+static RAM_CODE struct thrd_t *ready_queue_pop(struct ready_queue_t *self_p)
+{
+    struct ready_queue_fifo_t *fifo_p;
+    struct thrd_prio_list_elem_t *elem_p;
+    int word;
+    int level;
+
+    if (self_p->summary == 0) {
+        return (NULL);
+    }
+
+    /* Find the highest priority non-empty level. */
+    word = __builtin_ctz(self_p->summary);
+    level = (32 * word + __builtin_ctzl(self_p->bitmap[word]));
+    fifo_p = &self_p->fifos[level];
+    elem_p = fifo_p->head_p;
+    fifo_p->head_p = elem_p->next_p;
+
+    if (fifo_p->head_p == NULL) {
+        ready_queue_clear_level(self_p, level);
+    }
+
+    return (elem_p->thrd_p);
+}
+
+static RAM_CODE int ready_queue_remove(struct ready_queue_t *self_p,
+                                       struct thrd_t *thrd_p)
+{
+    struct ready_queue_fifo_t *fifo_p;
+    struct thrd_prio_list_elem_t *curr_p;
+    struct thrd_prio_list_elem_t *prev_p;
+    struct thrd_prio_list_elem_t *elem_p;
+    int level;
+
+    level = thrd_p->scheduler.level;
+    elem_p = &thrd_p->scheduler.elem;
+    fifo_p = &self_p->fifos[level];
+    curr_p = fifo_p->head_p;
+    prev_p = NULL;
+
+    while (curr_p != NULL) {
+        if (curr_p == elem_p) {
+            if (prev_p != NULL) {
+                prev_p->next_p = elem_p->next_p;
+            } else {
+                fifo_p->head_p = elem_p->next_p;
+            }
+
+            if (fifo_p->tail_p == elem_p) {
+                fifo_p->tail_p = prev_p;
+            }
+
+            if (fifo_p->head_p == NULL) {
+                ready_queue_clear_level(self_p, level);
+            }
+
+            return (0);
+        }
+
+        prev_p = curr_p;
+        curr_p = curr_p->next_p;
+    }
+
+    return (-1);
+}
+
+#endif
+
+#if CONFIG_THRD_EDF == 1
+
+/**
+ * Returns true(1) if tick a is before tick b, taking wrap around into
+ * account.
+ */
+static inline int edf_tick_before(uint32_t a, uint32_t b)
+{
+    return ((int32_t)(a - b) < 0);
+}
+
+/**
+ * Insert given thread into the EDF ready list, sorted by absolute
+ * deadline. Threads with equal deadlines are scheduled in FIFO
+ * order.
+ */
+static RAM_CODE void edf_ready_push(struct thrd_t *thrd_p)
+{
+    struct thrd_prio_list_elem_t *elem_p;
+    struct thrd_prio_list_elem_t *prev_p;
+    struct thrd_prio_list_elem_t *curr_p;
+
+    elem_p = &thrd_p->scheduler.elem;
+    prev_p = NULL;
+    curr_p = module.scheduler.edf.ready.head_p;
+
+    while (curr_p != NULL) {
+        if (edf_tick_before(thrd_p->edf.absolute_deadline,
+                            curr_p->thrd_p->edf.absolute_deadline)) {
+            break;
+        }
+
+        prev_p = curr_p;
+        curr_p = curr_p->next_p;
+    }
+
+    elem_p->next_p = curr_p;
+
+    if (prev_p == NULL) {
+        module.scheduler.edf.ready.head_p = elem_p;
+    } else {
+        prev_p->next_p = elem_p;
+    }
+}
+
+/**
+ * Returns the priority of the most important thread in the fixed
+ * priority ready list, or a lower priority than any thread if it is
+ * empty.
+ */
+static RAM_CODE int fixed_ready_top_prio(void)
+{
+#if CONFIG_THRD_SCHEDULER_BITMAP == 1
+    int word;
+
+    if (module.scheduler.ready.summary == 0) {
+        return (128);
+    }
+
+    word = __builtin_ctz(module.scheduler.ready.summary);
+
+    return (32 * word
+            + __builtin_ctzl(module.scheduler.ready.bitmap[word])
+            - 128);
+#else
+    if (module.scheduler.ready.head_p == NULL) {
+        return (128);
+    }
+
+    return (module.scheduler.ready.head_p->thrd_p->prio);
+#endif
+}
+
+/**
+ * Account one tick to the current EDF thread. A thread consuming
+ * more than its budget in the current period has its budget
+ * replenished and its absolute deadline postponed by one period,
+ * as in a constant bandwidth server, so an overrunning thread
+ * cannot starve other EDF threads.
+ */
+static RAM_CODE void edf_tick(void)
+{
+    struct thrd_t *thrd_p;
+
+    module.scheduler.edf.tick++;
+    thrd_p = module.scheduler.current_p;
+
+    if ((thrd_p->edf.period == 0) || (thrd_p->edf.budget == 0)) {
+        return;
+    }
+
+    thrd_p->edf.used++;
+
+    if (thrd_p->edf.used > thrd_p->edf.budget) {
+        thrd_p->edf.used = 0;
+        thrd_p->edf.absolute_deadline += thrd_p->edf.period;
+        thrd_p->edf.budget_overruns++;
+#if CONFIG_THRD_FS_COMMANDS == 1
+        module.budget_overruns.value++;
+#endif
+    }
+}
+
+#endif
+
 /**
  * Push a thread on the list of threads that are ready to be
  * scheduled.
@@ -200,7 +659,19 @@ static void on_suspend_timer_expired(void *arg_p)
  */
 static void scheduler_ready_push(struct thrd_t *thrd_p)
 {
+#if CONFIG_THRD_EDF == 1
+    if (thrd_p->edf.period != 0) {
+        edf_ready_push(thrd_p);
+
+        return;
+    }
+#endif
+
+#if CONFIG_THRD_SCHEDULER_BITMAP == 1
+    ready_queue_push(&module.scheduler.ready, thrd_p);
+#else
     thrd_prio_list_push_isr(&module.scheduler.ready, &thrd_p->scheduler.elem);
+#endif
 }
 
 /**
@@ -210,7 +681,121 @@ static void scheduler_ready_push(struct thrd_t *thrd_p)
  */
 static struct thrd_t *scheduler_ready_pop(void)
 {
-    return (thrd_prio_list_pop_isr(&module.scheduler.ready)->thrd_p);
+#if CONFIG_THRD_EDF == 1
+    struct thrd_prio_list_elem_t *elem_p;
+
+    /* EDF threads run before fixed priority threads with the same
+       priority as the EDF class. */
+    elem_p = module.scheduler.edf.ready.head_p;
+
+    if ((elem_p != NULL) && (fixed_ready_top_prio() >= CONFIG_THRD_EDF_PRIO)) {
+        module.scheduler.edf.ready.head_p = elem_p->next_p;
+
+        return (elem_p->thrd_p);
+    }
+#endif
+
+#if CONFIG_THRD_SCHEDULER_BITMAP == 1
+    return (ready_queue_pop(&module.scheduler.ready));
+#else
+    return (thrd_prio_list_pop_isr(&module.scheduler.ready)->thrd_p);
+#endif
+}
+
+/**
+ * Remove given thread from the ready list.
+ *
+ * @param[in] thrd_p Thread to remove.
+ *
+ * @return zero(0) or negative error code.
+ */
+static int scheduler_ready_remove(struct thrd_t *thrd_p)
+{
+#if CONFIG_THRD_EDF == 1
+    if (thrd_p->edf.period != 0) {
+        return (thrd_prio_list_remove_isr(&module.scheduler.edf.ready,
+                                          &thrd_p->scheduler.elem));
+    }
+#endif
+
+#if CONFIG_THRD_SCHEDULER_BITMAP == 1
+    return (ready_queue_remove(&module.scheduler.ready, thrd_p));
+#else
+    return (thrd_prio_list_remove_isr(&module.scheduler.ready,
+                                      &thrd_p->scheduler.elem));
+#endif
+}
+
+#if CONFIG_THRD_CYCLES == 1
+
+/**
+ * Account the cycles the outgoing thread has been running since it
+ * was swapped in.
+ */
+static RAM_CODE void cycles_update(struct thrd_t *out_p)
+{
+    uint32_t now;
+    uint32_t slice;
+
+    now = thrd_port_cycles_get();
+    slice = (now - module.scheduler.slice_start);
+    module.scheduler.slice_start = now;
+
+    out_p->statistics.cycles.total += slice;
+    out_p->statistics.cycles.switches++;
+
+    if (slice > out_p->statistics.cycles.max_slice) {
+        out_p->statistics.cycles.max_slice = slice;
+    }
+
+#if CONFIG_THRD_FS_COMMANDS == 1
+    module.context_switches.value++;
+#endif
+}
+
+#endif
+
+#if CONFIG_THRD_CYCLES_NEEDED == 1
+
+/**
+ * Cycle counter timestamp, used by the trace, lock statistics,
+ * interrupt statistics, exti capture and harness benchmark modules,
+ * the startup times of the sys module and the time cycles.
+ */
+uint32_t RAM_CODE thrd_cycles_get_isr(void)
+{
+    return (thrd_port_cycles_get());
+}
+
+#endif
+
+#if (CONFIG_TRACE == 1) || (CONFIG_PROFILER == 1)
+
+/**
+ * First thread in the list of all threads, used by the trace and
+ * profiler modules.
+ */
+struct thrd_t *thrd_trace_get_threads(void)
+{
+    return (module.threads_p);
+}
+
+#endif
+
+static void cycles_init(struct thrd_t *thrd_p)
+{
+#if CONFIG_THRD_CYCLES == 1
+    thrd_p->statistics.cycles.total = 0;
+    thrd_p->statistics.cycles.switches = 0;
+    thrd_p->statistics.cycles.max_slice = 0;
+#endif
+}
+
+static void edf_init(struct thrd_t *thrd_p)
+{
+#if CONFIG_THRD_EDF == 1
+    memset(&thrd_p->edf, 0, sizeof(thrd_p->edf));
+#endif
 }
 
 /**
@@ -235,6 +820,10 @@ static void thrd_reschedule(void)
 
     if (in_p != out_p) {
         module.scheduler.current_p = in_p;
+        TRACE_ISR(THRD_SWITCH, in_p, in_p->prio);
+#if CONFIG_THRD_CYCLES == 1
+        cycles_update(out_p);
+#endif
         thrd_port_cpu_usage_stop(out_p);
         thrd_port_cpu_usage_start(in_p);
         thrd_port_swap(in_p, out_p);
@@ -255,28 +844,77 @@ static void thrd_fill_pattern(char *from_p, size_t size)
     }
 }
 
-#if CONFIG_THRD_FS_COMMANDS == 1
+#endif
+
+#if (CONFIG_THRD_CPU_USAGE == 1)                \
+    || (CONFIG_THRD_SCHEDULED == 1)             \
+    || (CONFIG_PROFILE_STACK == 1)              \
+    || (CONFIG_THRD_CYCLES == 1)
 
-static int thrd_get_used_stack(struct thrd_t *thrd_p)
+/**
+ * Write one OpenMetrics family with a sample per thread. Counter
+ * samples are suffixed with _total.
+ */
+static void print_openmetrics_family(void *chout_p,
+                                     const char *name_p,
+                                     int counter,
+                                     int index)
 {
-    char *stack_p;
-    size_t i;
+    struct thrd_t *thrd_p;
+    unsigned long value;
 
-    stack_p = (char *)&thrd_p[1];
-    i = 0;
+    std_fprintf(chout_p,
+                OSTR("# TYPE %s %s\n"),
+                name_p,
+                (counter ? "counter" : "gauge"));
+    thrd_p = module.threads_p;
 
-    /* Stack grows towards lower memory addresses, so start from the
-       bottom.*/
-    while ((i < thrd_p->stack_size) &&
-           (stack_p[i] == THRD_FILL_PATTERN)) {
-        i++;
-    }
+    while (thrd_p != NULL) {
+        switch (index) {
 
-    return (thrd_p->stack_size - i);
-}
+#if CONFIG_THRD_CPU_USAGE == 1
+        case 0:
+#    if CONFIG_FLOAT == 1
+            value = (unsigned long)(thrd_p->statistics.cpu.usage + 0.5);
+#    else
+            value = (unsigned long)thrd_p->statistics.cpu.usage;
+#    endif
+            break;
+#endif
+
+#if CONFIG_THRD_SCHEDULED == 1
+        case 1:
+            value = thrd_p->statistics.scheduled;
+            break;
+#endif
+
+#if CONFIG_PROFILE_STACK == 1
+        case 2:
+            value = thrd_get_max_stack_usage(thrd_p);
+            break;
+#endif
 
+#if CONFIG_THRD_CYCLES == 1
+        case 3:
+            value = thrd_p->statistics.cycles.switches;
+            break;
 #endif
 
+        default:
+            value = 0;
+            break;
+        }
+
+        std_fprintf(chout_p,
+                    OSTR("%s%s{thread=\"%s\"} %lu\n"),
+                    name_p,
+                    (counter ? "_total" : ""),
+                    thrd_p->name_p,
+                    value);
+        thrd_p = thrd_p->next_p;
+    }
+}
+
 #endif
 
 #if CONFIG_THRD_FS_COMMANDS == 1
@@ -308,6 +946,9 @@ static int cmd_list_cb(int argc,
 #endif
 #if CONFIG_PROFILE_STACK == 1
                      "  MAX-STACK-USAGE"
+#endif
+#if CONFIG_THRD_CYCLES == 1
+                     "             CYCLES    SWITCHES   MAX-SLICE"
 #endif
                      "  LOGMASK\r\n"));
 
@@ -324,6 +965,9 @@ static int cmd_list_cb(int argc,
 #endif
 #if CONFIG_PROFILE_STACK == 1
                          "    %6d/%6d"
+#endif
+#if CONFIG_THRD_CYCLES == 1
+                         "   %08lx%08lx %11lu %11lu"
 #endif
                          "     0x%02x\r\n"),
                     thrd_p->name_p,
@@ -339,8 +983,15 @@ static int cmd_list_cb(int argc,
                     (unsigned int)thrd_p->statistics.scheduled,
 #endif
 #if CONFIG_PROFILE_STACK == 1
-                    thrd_get_used_stack(thrd_p),
+                    thrd_get_max_stack_usage(thrd_p),
                     (int)thrd_p->stack_size,
+#endif
+#if CONFIG_THRD_CYCLES == 1
+                    (unsigned long)(thrd_p->statistics.cycles.total >> 32),
+                    (unsigned long)(thrd_p->statistics.cycles.total
+                                    & 0xffffffff),
+                    (unsigned long)thrd_p->statistics.cycles.switches,
+                    (unsigned long)thrd_p->statistics.cycles.max_slice,
 #endif
                     thrd_p->log_mask);
 
@@ -398,9 +1049,46 @@ static void *idle_thrd(void *arg_p)
     return (NULL);
 }
 
+/**
+ * Total size and maximum usage of all thread stacks. The main thread
+ * stack is not included if its size is unknown.
+ */
+static int stacks_memory_usage(void *arg_p,
+                               struct sys_memory_usage_t *usage_p)
+{
+    struct thrd_t *thrd_p;
+    int used;
+
+    usage_p->size = 0;
+    usage_p->used = -1;
+    usage_p->used_max = 0;
+    thrd_p = module.threads_p;
+
+    while (thrd_p != NULL) {
+        if ((thrd_p != thrd_port_get_main_thrd())
+            || (thrd_port_get_main_thrd_stack_top() != NULL)) {
+            usage_p->size += thrd_p->stack_size;
+            used = thrd_get_max_stack_usage(thrd_p);
+
+            if (used < 0) {
+                usage_p->used_max = -1;
+            } else if (usage_p->used_max >= 0) {
+                usage_p->used_max += used;
+            }
+        }
+
+        thrd_p = thrd_p->next_p;
+    }
+
+    return (0);
+}
+
 int thrd_module_init(void)
 {
     struct thrd_t *thrd_p;
+#if CONFIG_THRD_STACK_HEAP == 1
+    int i;
+#endif
 
     /* Return immediately if the module is already initialized. */
     if (module.initialized == 1) {
@@ -409,21 +1097,51 @@ int thrd_module_init(void)
 
     module.initialized = 1;
 
+#if CONFIG_THRD_SCHEDULER_BITMAP == 1
+    ready_queue_init(&module.scheduler.ready);
+#else
     thrd_prio_list_init(&module.scheduler.ready);
+#endif
+
+#if CONFIG_THRD_EDF == 1
+    thrd_prio_list_init(&module.scheduler.edf.ready);
+    module.scheduler.edf.tick = 0;
+#endif
 
 #if CONFIG_THRD_STACK_HEAP == 1
+    /* The heap uses the last size as the biggest fixed size, so
+       repeat the biggest configured size in unused entries. */
+    for (i = 1; i < HEAP_FIXED_SIZES_MAX; i++) {
+        if (stack_heap_fixed_buffer_sizes[i] == 0) {
+            stack_heap_fixed_buffer_sizes[i] = stack_heap_fixed_buffer_sizes[i - 1];
+        }
+    }
+
     heap_init(&stack_heap,
               &stack_heap_buffer[0],
               sizeof(stack_heap_buffer),
               &stack_heap_fixed_buffer_sizes[0]);
+#    if CONFIG_HEAP_STATS == 1
+    heap_register(&stack_heap, "thrd_stack_heap");
+#    endif
 #endif
 
+    sys_memory_region_init(&module.stacks_region,
+                           "thrd_stacks",
+                           NULL,
+                           0,
+                           stacks_memory_usage,
+                           NULL);
+    sys_memory_region_register(&module.stacks_region);
+
 #if CONFIG_THRD_ENV == 1
-    module.env.global.variables_p = module.env.global_variables;
-    module.env.global.number_of_variables = 0;
-    module.env.global.max_number_of_variables =
-        membersof(module.env.global_variables);
+    init_env(&module.env.global,
+             module.env.global_variables,
+             membersof(module.env.global_variables));
     mutex_init(&module.env.mutex);
+#    if CONFIG_LOCK_STATS == 1
+    lock_stats_register(&module.env.mutex.stats, "thrd_env");
+#    endif
 #endif
 
 #if CONFIG_PROFILE_STACK == 1
@@ -454,12 +1172,28 @@ int thrd_module_init(void)
     thrd_p->statistics.scheduled = 0;
 #endif
 
+    cycles_init(thrd_p);
+    edf_init(thrd_p);
+
 #if CONFIG_THRD_ENV == 1
     thrd_p->env.variables_p = NULL;
     thrd_p->env.number_of_variables = 0;
     thrd_p->env.max_number_of_variables = 0;
 #endif
 
+#if CONFIG_THRD_ARENA == 1
+    thrd_p->arena_p = NULL;
+#endif
+
+#if CONFIG_LOG_WRITER == 1
+    thrd_p->log_staging_p = NULL;
+#endif
+
+#if CONFIG_MUTEX_PRIO_INHERIT == 1
+    thrd_p->mutex.held_p = NULL;
+    thrd_p->mutex.blocked_on_p = NULL;
+#endif
+
 #if CONFIG_PANIC_ASSERT == 1
     thrd_p->stack_low_magic = THRD_STACK_LOW_MAGIC;
 #endif
@@ -472,6 +1206,10 @@ int thrd_module_init(void)
     module.threads_p = thrd_p;
 
     thrd_port_init_main(&thrd_p->port);
+
+#if CONFIG_THRD_CYCLES == 1
+    module.scheduler.slice_start = thrd_port_cycles_get();
+#endif
     thrd_spawn(idle_thrd, NULL, 127, idle_thrd_stack, sizeof(idle_thrd_stack));
 
 #if CONFIG_MONITOR_THREAD == 1
@@ -495,6 +1233,25 @@ int thrd_module_init(void)
                     NULL);
     fs_command_register(&module.cmd_set_log_mask);
 
+#    if CONFIG_THRD_CYCLES == 1
+    fs_counter_init(&module.context_switches,
+                    CSTR("/kernel/thrd/context_switches"),
+                    0);
+    fs_counter_register(&module.context_switches);
+#    endif
+
+#    if CONFIG_THRD_EDF == 1
+    fs_counter_init(&module.deadline_misses,
+                    CSTR("/kernel/thrd/edf/deadline_misses"),
+                    0);
+    fs_counter_register(&module.deadline_misses);
+
+    fs_counter_init(&module.budget_overruns,
+                    CSTR("/kernel/thrd/edf/budget_overruns"),
+                    0);
+    fs_counter_register(&module.budget_overruns);
+#    endif
+
 #    if CONFIG_MONITOR_THREAD == 1
     fs_command_init(&module.cmd_monitor_set_period_ms,
                     CSTR("/kernel/thrd/monitor/set_period_ms"),
@@ -549,12 +1306,28 @@ struct thrd_t *thrd_spawn(void *(*main)(void *),
     thrd_p->statistics.scheduled = 0;
 #endif
 
+    cycles_init(thrd_p);
+    edf_init(thrd_p);
+
 #if CONFIG_THRD_ENV == 1
     thrd_p->env.variables_p = NULL;
     thrd_p->env.number_of_variables = 0;
     thrd_p->env.max_number_of_variables = 0;
 #endif
 
+#if CONFIG_THRD_ARENA == 1
+    thrd_p->arena_p = NULL;
+#endif
+
+#if CONFIG_LOG_WRITER == 1
+    thrd_p->log_staging_p = NULL;
+#endif
+
+#if CONFIG_MUTEX_PRIO_INHERIT == 1
+    thrd_p->mutex.held_p = NULL;
+    thrd_p->mutex.blocked_on_p = NULL;
+#endif
+
 #if CONFIG_PANIC_ASSERT == 1
     thrd_p->stack_low_magic = THRD_STACK_LOW_MAGIC;
 #endif
@@ -627,8 +1400,7 @@ int thrd_join(struct thrd_t *thrd_p)
 int thrd_terminate(struct thrd_t *thrd_p)
 {
     sys_lock();
-    thrd_prio_list_remove_isr(&module.scheduler.ready,
-                              &thrd_p->scheduler.elem);
+    scheduler_ready_remove(thrd_p);
 #if CONFIG_THRD_TERMINATE == 1
     sem_give_isr(&thrd_self()->join_sem, 1);
 #endif
@@ -721,11 +1493,53 @@ int thrd_get_log_mask(void)
     return (module.scheduler.current_p->log_mask);
 }
 
+struct arena_t *thrd_set_arena(struct arena_t *arena_p)
+{
+#if CONFIG_THRD_ARENA == 1
+    struct arena_t *old_p;
+
+    old_p = module.scheduler.current_p->arena_p;
+    module.scheduler.current_p->arena_p = arena_p;
+
+    return (old_p);
+#else
+    return (NULL);
+#endif
+}
+
+struct arena_t *thrd_get_arena(void)
+{
+#if CONFIG_THRD_ARENA == 1
+    return (module.scheduler.current_p->arena_p);
+#else
+    return (NULL);
+#endif
+}
+
 int thrd_set_prio(struct thrd_t *thrd_p, int prio)
 {
     ASSERTN(thrd_p != NULL, EINVAL);
 
-    thrd_p->prio = prio;
+    sys_lock();
+    thrd_set_prio_isr(thrd_p, prio);
+    sys_unlock();
+
+    return (0);
+}
+
+int thrd_set_prio_isr(struct thrd_t *thrd_p, int prio)
+{
+    if (thrd_p->prio == prio) {
+        return (0);
+    }
+
+    if (thrd_p->state == THRD_STATE_READY) {
+        scheduler_ready_remove(thrd_p);
+        thrd_p->prio = prio;
+        scheduler_ready_push(thrd_p);
+    } else {
+        thrd_p->prio = prio;
+    }
 
     return (0);
 }
@@ -735,14 +1549,127 @@ int thrd_get_prio(void)
     return (module.scheduler.current_p->prio);
 }
 
+int thrd_set_edf(struct thrd_t *thrd_p,
+                 const struct time_t *period_p,
+                 const struct time_t *deadline_p,
+                 const struct time_t *budget_p)
+{
+    ASSERTN(thrd_p != NULL, EINVAL);
+
+#if CONFIG_THRD_EDF == 1
+    int ready;
+    uint32_t period;
+
+    if (period_p != NULL) {
+        period = t2st(period_p);
+
+        if (period == 0) {
+            return (-EINVAL);
+        }
+    } else {
+        period = 0;
+    }
+
+    sys_lock();
+
+    ready = (thrd_p->state == THRD_STATE_READY);
+
+    if (ready) {
+        scheduler_ready_remove(thrd_p);
+    }
+
+    if (period != 0) {
+        /* Remember the fixed priority when entering the EDF class. */
+        if (thrd_p->edf.period == 0) {
+            thrd_p->edf.prio = thrd_p->prio;
+        }
+
+        thrd_p->edf.period = period;
+        thrd_p->edf.deadline = ((deadline_p != NULL)
+                                ? t2st(deadline_p)
+                                : period);
+        thrd_p->edf.budget = ((budget_p != NULL) ? t2st(budget_p) : 0);
+        thrd_p->edf.release = module.scheduler.edf.tick;
+        thrd_p->edf.absolute_deadline = (thrd_p->edf.release
+                                         + thrd_p->edf.deadline);
+        thrd_p->edf.used = 0;
+        thrd_p->prio = CONFIG_THRD_EDF_PRIO;
+    } else if (thrd_p->edf.period != 0) {
+        thrd_p->edf.period = 0;
+        thrd_p->prio = thrd_p->edf.prio;
+    }
+
+    if (ready) {
+        scheduler_ready_push(thrd_p);
+    }
+
+    sys_unlock();
+
+    return (0);
+#else
+    return (-ENOSYS);
+#endif
+}
+
+int thrd_wait_period(void)
+{
+#if CONFIG_THRD_EDF == 1
+    struct thrd_t *thrd_p;
+    struct time_t timeout;
+    uint32_t now;
+    int res;
+
+    thrd_p = module.scheduler.current_p;
+
+    if (thrd_p->edf.period == 0) {
+        return (-EINVAL);
+    }
+
+    res = 0;
+
+    sys_lock();
+
+    now = module.scheduler.edf.tick;
+
+    if (edf_tick_before(thrd_p->edf.absolute_deadline, now)) {
+        thrd_p->edf.deadline_misses++;
+#if CONFIG_THRD_FS_COMMANDS == 1
+        module.deadline_misses.value++;
+#endif
+        res = 1;
+    }
+
+    /* Start the next job. A job that completes after the next
+       release starts its successor immediately. */
+    thrd_p->edf.release += thrd_p->edf.period;
+
+    if (edf_tick_before(thrd_p->edf.release, now)) {
+        thrd_p->edf.release = now;
+    }
+
+    thrd_p->edf.absolute_deadline = (thrd_p->edf.release
+                                     + thrd_p->edf.deadline);
+    thrd_p->edf.used = 0;
+
+    if (thrd_p->edf.release != now) {
+        st2t(thrd_p->edf.release - now, &timeout);
+        thrd_suspend_isr(&timeout);
+    }
+
+    sys_unlock();
+
+    return (res);
+#else
+    return (-ENOSYS);
+#endif
+}
+
 int thrd_init_global_env(struct thrd_environment_variable_t *variables_p,
                          int length)
 {
 #if CONFIG_THRD_ENV == 1
     mutex_lock(&module.env.mutex);
-    module.env.global.variables_p = variables_p;
-    module.env.global.number_of_variables = 0;
-    module.env.global.max_number_of_variables = length;
+    init_env(&module.env.global, variables_p, length);
     mutex_unlock(&module.env.mutex);
 
     return (0);
@@ -789,9 +1716,7 @@ int thrd_init_env(struct thrd_environment_variable_t *variables_p,
                   int length)
 {
 #if CONFIG_THRD_ENV == 1
-    module.scheduler.current_p->env.variables_p = variables_p;
-    module.scheduler.current_p->env.number_of_variables = 0;
-    module.scheduler.current_p->env.max_number_of_variables = length;
+    init_env(&module.scheduler.current_p->env, variables_p, length);
 
     return (0);
 #else
@@ -829,8 +1754,25 @@ const char *thrd_get_env(const char *name_p)
 #endif
 }
 
+#if (CONFIG_SYSTEM_TICKLESS == 1) && (CONFIG_THRD_EDF == 1)
+
+/**
+ * Account for ticks that passed in the idle thread without the tick
+ * interrupt being taken.
+ */
+void thrd_tick_skip_isr(uint32_t ticks)
+{
+    module.scheduler.edf.tick += ticks;
+}
+
+#endif
+
 void RAM_CODE thrd_tick_isr(void)
 {
+#if CONFIG_THRD_EDF == 1
+    edf_tick();
+#endif
+
     thrd_port_tick();
 
 #if CONFIG_PREEMPTIVE_SCHEDULER == 1
@@ -850,9 +1792,8 @@ int thrd_suspend_isr(const struct time_t *timeout_p)
         thrd_p->state = THRD_STATE_READY;
         scheduler_ready_push(thrd_p);
     } else {
-        thrd_p->state = THRD_STATE_SUSPENDED;
-
         if (timeout_p != NULL) {
+            /* The thread keeps running, and must not be resumed. */
             if ((timeout_p->seconds <= 0) && (timeout_p->nanoseconds <= 0)) {
                 return (-ETIMEDOUT);
             } else {
@@ -866,6 +1807,8 @@ int thrd_suspend_isr(const struct time_t *timeout_p)
                 timer_start_isr(&timer);
             }
         }
+
+        thrd_p->state = THRD_STATE_SUSPENDED;
     }
 
     thrd_reschedule();
@@ -881,6 +1824,7 @@ int thrd_resume_isr(struct thrd_t *thrd_p, int err)
     thrd_p->err = err;
 
     if (thrd_p->state == THRD_STATE_SUSPENDED) {
+        TRACE_ISR(THRD_RESUME, thrd_p, thrd_p->prio);
         thrd_p->state = THRD_STATE_READY;
 
         if (thrd_p->timer_p != NULL) {
@@ -920,12 +1864,91 @@ void *thrd_stack_alloc(size_t size)
 int thrd_stack_free(void *stack_p)
 {
 #if CONFIG_THRD_STACK_HEAP == 1
+    struct thrd_t **thrd_pp;
+
+    /* Terminated threads are still in the list of threads. Remove
+       the thread using this stack before it is reused. */
+    sys_lock();
+
+    thrd_pp = &module.threads_p;
+
+    while (*thrd_pp != NULL) {
+        if (*thrd_pp == stack_p) {
+            *thrd_pp = (*thrd_pp)->next_p;
+            break;
+        }
+
+        thrd_pp = &(*thrd_pp)->next_p;
+    }
+
+    sys_unlock();
+
     return (heap_free(&stack_heap, stack_p));
 #else
     return (-1);
 #endif
 }
 
+int thrd_get_max_stack_usage(struct thrd_t *thrd_p)
+{
+    ASSERTN(thrd_p != NULL, EINVAL);
+
+#if CONFIG_PROFILE_STACK == 1
+    char *stack_p;
+    size_t i;
+
+    stack_p = (char *)&thrd_p[1];
+    i = 0;
+
+    /* Stack grows towards lower memory addresses, so start from the
+       bottom.*/
+    while ((i < thrd_p->stack_size) &&
+           (stack_p[i] == THRD_FILL_PATTERN)) {
+        i++;
+    }
+
+    return (thrd_p->stack_size - i);
+#else
+    return (-ENOSYS);
+#endif
+}
+
+int thrd_print_openmetrics(void *chout_p)
+{
+    ASSERTN(chout_p != NULL, EINVAL);
+
+#if (CONFIG_THRD_CYCLES == 1) && (CONFIG_STD_PRINTF_LONG_LONG == 1)
+    struct thrd_t *thrd_p;
+#endif
+
+#if CONFIG_THRD_CPU_USAGE == 1
+    print_openmetrics_family(chout_p, "thrd_cpu_usage_percent", 0, 0);
+#endif
+#if CONFIG_THRD_SCHEDULED == 1
+    print_openmetrics_family(chout_p, "thrd_scheduled", 1, 1);
+#endif
+#if CONFIG_PROFILE_STACK == 1
+    print_openmetrics_family(chout_p, "thrd_stack_usage_max_bytes", 0, 2);
+#endif
+#if CONFIG_THRD_CYCLES == 1
+    print_openmetrics_family(chout_p, "thrd_switches", 1, 3);
+#    if CONFIG_STD_PRINTF_LONG_LONG == 1
+    std_fprintf(chout_p, OSTR("# TYPE thrd_cycles counter\n"));
+    thrd_p = module.threads_p;
+
+    while (thrd_p != NULL) {
+        std_fprintf(chout_p,
+                    OSTR("thrd_cycles_total{thread=\"%s\"} %llu\n"),
+                    thrd_p->name_p,
+                    (unsigned long long)thrd_p->statistics.cycles.total);
+        thrd_p = thrd_p->next_p;
+    }
+#    endif
+#endif
+
+    return (0);
+}
+
 const void *thrd_get_bottom_of_stack(struct thrd_t *thrd_p)
 {
     return (thrd_port_get_bottom_of_stack(thrd_p));
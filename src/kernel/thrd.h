@@ -42,6 +42,17 @@
  */
 #define THRD_STACK(name, size) THRD_PORT_STACK(name, size)
 
+/**
+ * Same as `THRD_STACK()`, but the stack is placed in the fastest RAM
+ * of the MCU, for example the core coupled memory on STM32F3. The
+ * fast RAM is not accessible by DMA on all MCUs, so do not use
+ * buffers on such stacks for DMA transfers.
+ *
+ * @param[in] name The name of the stack.
+ * @param[in] size Size of the stack in bytes.
+ */
+#define THRD_STACK_FAST(name, size) THRD_PORT_STACK(name, size) FAST_DATA
+
 /**
  * Push all callee-save registers not part of the context struct. The
  * preemptive scheduler requires this macro before the
@@ -71,9 +82,15 @@
 /**
  * A thread environment variable.
  */
+struct arena_t;
+struct mutex_t;
+
 struct thrd_environment_variable_t {
     const char *name_p;
     const char *value_p;
+#if CONFIG_THRD_ENV_HASH == 1
+    uint32_t hash;
+#endif
 };
 
 struct thrd_environment_t {
@@ -85,6 +102,9 @@ struct thrd_environment_t {
 struct thrd_t {
     struct {
         struct thrd_prio_list_elem_t elem;
+#if CONFIG_THRD_SCHEDULER_BITMAP == 1
+        uint8_t level;
+#endif
     } scheduler;
     struct thrd_port_t port;
     int8_t prio;
@@ -109,10 +129,43 @@ struct thrd_t {
 #endif
 #if CONFIG_THRD_SCHEDULED == 1
         uint32_t scheduled;
+#endif
+#if CONFIG_THRD_CYCLES == 1
+        struct {
+            uint64_t total;
+            uint32_t switches;
+            uint32_t max_slice;
+        } cycles;
 #endif
     } statistics;
 #if CONFIG_THRD_ENV == 1
     struct thrd_environment_t env;
+#endif
+#if CONFIG_THRD_ARENA == 1
+    struct arena_t *arena_p;
+#endif
+#if CONFIG_LOG_WRITER == 1
+    struct log_staging_t *log_staging_p;
+#endif
+#if CONFIG_MUTEX_PRIO_INHERIT == 1
+    struct {
+        int8_t base_prio;
+        struct mutex_t *held_p;
+        struct mutex_t *blocked_on_p;
+    } mutex;
+#endif
+#if CONFIG_THRD_EDF == 1
+    struct {
+        uint32_t period;
+        uint32_t deadline;
+        uint32_t budget;
+        uint32_t release;
+        uint32_t absolute_deadline;
+        uint32_t used;
+        uint32_t deadline_misses;
+        uint32_t budget_overruns;
+        int8_t prio;
+    } edf;
 #endif
     size_t stack_size;
 #if CONFIG_PANIC_ASSERT == 1
@@ -284,6 +337,25 @@ int thrd_set_log_mask(struct thrd_t *thrd_p, int mask);
  */
 int thrd_get_log_mask(void);
 
+/**
+ * Bind given scratch arena to the current thread. Requires
+ * ``CONFIG_THRD_ARENA``.
+ *
+ * @param[in] arena_p Arena to bind, or NULL to unbind the current
+ *                    arena.
+ *
+ * @return Previously bound arena, or NULL.
+ */
+struct arena_t *thrd_set_arena(struct arena_t *arena_p);
+
+/**
+ * Get the scratch arena bound to the current thread.
+ *
+ * @return Bound arena, or NULL if no arena is bound or
+ *         ``CONFIG_THRD_ARENA`` is disabled.
+ */
+struct arena_t *thrd_get_arena(void);
+
 /**
  * Set the priority of given thread.
  *
@@ -294,6 +366,18 @@ int thrd_get_log_mask(void);
  */
 int thrd_set_prio(struct thrd_t *thrd_p, int prio);
 
+/**
+ * Set the priority of given thread from isr or with the system lock
+ * taken. A ready thread is moved to the ready queue of its new
+ * priority.
+ *
+ * @param[in] thrd_p Thread to set the priority for.
+ * @param[in] prio Priority.
+ *
+ * @return zero(0) or negative error code.
+ */
+int thrd_set_prio_isr(struct thrd_t *thrd_p, int prio);
+
 /**
  * Get the priority of the current thread.
  *
@@ -301,6 +385,45 @@ int thrd_set_prio(struct thrd_t *thrd_p, int prio);
  */
 int thrd_get_prio(void);
 
+/**
+ * Move given thread to the earliest deadline first (EDF) scheduling
+ * class, or back to its fixed priority if `period_p` is NULL.
+ *
+ * EDF threads run periodic jobs. The first job is released when this
+ * function is called and each job ends by calling
+ * `thrd_wait_period()`. Among ready EDF threads the one with the
+ * earliest absolute deadline runs first. The EDF class as a whole
+ * runs at priority ``CONFIG_THRD_EDF_PRIO``; fixed priority threads
+ * with a higher priority preempt EDF threads.
+ *
+ * All times are rounded down to system ticks.
+ *
+ * @param[in] thrd_p Thread.
+ * @param[in] period_p Job release period, or NULL to leave the EDF
+ *                     class.
+ * @param[in] deadline_p Deadline relative to the release of each
+ *                       job, or NULL for the period.
+ * @param[in] budget_p Execution time budget of each job, or NULL for
+ *                     no budget enforcement. A job that overruns its
+ *                     budget gets a new budget and its deadline is
+ *                     postponed by one period.
+ *
+ * @return zero(0) or negative error code.
+ */
+int thrd_set_edf(struct thrd_t *thrd_p,
+                 const struct time_t *period_p,
+                 const struct time_t *deadline_p,
+                 const struct time_t *budget_p);
+
+/**
+ * End the current job of the calling EDF thread and sleep until the
+ * next job is released.
+ *
+ * @return zero(0) if the job met its deadline, one(1) if it missed
+ *         it, otherwise negative error code.
+ */
+int thrd_wait_period(void);
+
 /**
  * Initialize the global environment variables storage. These
  * variables are shared among all threads.
@@ -420,6 +543,29 @@ void *thrd_stack_alloc(size_t size);
  */
 int thrd_stack_free(void *stack_p);
 
+/**
+ * Get the maximum number of stack bytes used by given thread since
+ * it was spawned. The stack is filled with a pattern when the thread
+ * is spawned, and the high-water mark is the deepest overwritten
+ * byte. Requires ``CONFIG_PROFILE_STACK``.
+ *
+ * @param[in] thrd_p Thread to get the maximum stack usage of.
+ *
+ * @return Maximum stack usage in bytes, or negative error code.
+ */
+int thrd_get_max_stack_usage(struct thrd_t *thrd_p);
+
+/**
+ * Write the statistics of all threads to given channel in the
+ * OpenMetrics text format, with the thread name as label. Only the
+ * statistics enabled in the configuration are written.
+ *
+ * @param[in] chout_p Output channel.
+ *
+ * @return zero(0) or negative error code.
+ */
+int thrd_print_openmetrics(void *chout_p);
+
 /**
  * Get the pointer to given threads' bottom of stack.
  *
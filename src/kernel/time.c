@@ -29,12 +29,110 @@
 #include "simba.h"
 #include "time_port.i"
 
+#if CONFIG_TIME_CYCLES == 1
+/* Provided by the thread module. */
+extern uint32_t thrd_cycles_get_isr(void);
+
+/* The thrd port cycle counter, if the port has one. */
+#    if defined(THRD_PORT_CYCLES_FREQUENCY)
+#        define CYCLES_FREQUENCY THRD_PORT_CYCLES_FREQUENCY
+#    else
+/* Microseconds since startup on ports without a cycle counter. */
+#        define CYCLES_FREQUENCY                              1000000UL
+#    endif
+#endif
+
 struct module_t {
     struct time_t uptime_offset;
+#if CONFIG_TIME_ADJUST == 1
+    struct {
+        /* Uptime when the adjustment started. */
+        struct time_t start;
+        /* Microseconds to adjust the time with. */
+        long microseconds;
+    } adjust;
+#endif
+#if CONFIG_TIME_CYCLES == 1
+    struct {
+        uint32_t last;
+        uint32_t wraps;
+        /* Zero(0) for the nominal frequency. */
+        uint32_t frequency;
+    } cycles;
+#endif
 };
 
 static struct module_t module;
 
+#if CONFIG_TIME_CYCLES == 1
+
+static uint32_t cycles_get_isr(void)
+{
+#    if defined(THRD_PORT_CYCLES_FREQUENCY)
+    return (thrd_cycles_get_isr());
+#    else
+    struct time_t uptime;
+
+    sys_uptime_isr(&uptime);
+
+    return (1000000UL * uptime.seconds + uptime.nanoseconds / 1000);
+#    endif
+}
+
+#endif
+
+#if CONFIG_TIME_ADJUST == 1
+
+/**
+ * Returns the number of microseconds of the ongoing adjustment
+ * applied at given uptime, at most CONFIG_TIME_ADJUST_RATE_PPM
+ * microseconds per elapsed second.
+ */
+static long adjust_get_applied(struct time_t *uptime_p)
+{
+    struct time_t elapsed;
+    long maximum;
+    long applied;
+
+    if (module.adjust.microseconds == 0) {
+        return (0);
+    }
+
+    if (module.adjust.microseconds < 0) {
+        maximum = -module.adjust.microseconds;
+    } else {
+        maximum = module.adjust.microseconds;
+    }
+
+    time_subtract(&elapsed, uptime_p, &module.adjust.start);
+
+    if (elapsed.seconds > maximum / CONFIG_TIME_ADJUST_RATE_PPM) {
+        applied = maximum;
+    } else {
+        applied = (elapsed.seconds * CONFIG_TIME_ADJUST_RATE_PPM
+                   + ((elapsed.nanoseconds / 1000000)
+                      * CONFIG_TIME_ADJUST_RATE_PPM) / 1000);
+
+        if (applied > maximum) {
+            applied = maximum;
+        }
+    }
+
+    if (module.adjust.microseconds < 0) {
+        applied = -applied;
+    }
+
+    return (applied);
+}
+
+static void microseconds_to_time(struct time_t *res_p, long microseconds)
+{
+    res_p->seconds = (microseconds / 1000000);
+    res_p->nanoseconds = (1000 * (microseconds % 1000000));
+}
+
+#endif
+
 static void adjust_result(struct time_t *res_p)
 {
     /* abs(nanoseconds) must be less than 1000000000. */
@@ -60,10 +158,40 @@ int time_get(struct time_t *now_p)
 {
     ASSERTN(now_p != NULL, EINVAL);
 
+#if CONFIG_TIME_ADJUST == 1
+    int res;
+
+    sys_lock();
+    res = time_get_isr(now_p);
+    sys_unlock();
+
+    return (res);
+#else
     if (sys_uptime(now_p) != 0) {
         return (-1);
     }
 
+    return (time_add(now_p, now_p, &module.uptime_offset));
+#endif
+}
+
+int time_get_isr(struct time_t *now_p)
+{
+    ASSERTN(now_p != NULL, EINVAL);
+
+#if CONFIG_TIME_ADJUST == 1
+    struct time_t applied;
+#endif
+
+    if (sys_uptime_isr(now_p) != 0) {
+        return (-1);
+    }
+
+#if CONFIG_TIME_ADJUST == 1
+    microseconds_to_time(&applied, adjust_get_applied(now_p));
+    time_add(now_p, now_p, &applied);
+#endif
+
     return (time_add(now_p, now_p, &module.uptime_offset));
 }
 
@@ -77,9 +205,58 @@ int time_set(struct time_t *new_p)
         return (-1);
     }
 
+#if CONFIG_TIME_ADJUST == 1
+    /* A step cancels any ongoing adjustment. */
+    sys_lock();
+    module.adjust.microseconds = 0;
+    time_subtract(&module.uptime_offset, new_p, &uptime);
+    sys_unlock();
+
+    return (0);
+#else
     return (time_subtract(&module.uptime_offset, new_p, &uptime));
+#endif
+}
+
+#if CONFIG_TIME_ADJUST == 1
+
+int time_adjust(long microseconds)
+{
+    struct time_t uptime;
+    struct time_t applied;
+
+    if (sys_uptime(&uptime) != 0) {
+        return (-1);
+    }
+
+    sys_lock();
+
+    /* Keep the part of the ongoing adjustment already applied. */
+    microseconds_to_time(&applied, adjust_get_applied(&uptime));
+    time_add(&module.uptime_offset, &module.uptime_offset, &applied);
+    module.adjust.start = uptime;
+    module.adjust.microseconds = microseconds;
+
+    sys_unlock();
+
+    return (0);
 }
 
+long time_adjust_get_remaining(void)
+{
+    struct time_t uptime;
+    long remaining;
+
+    sys_lock();
+    sys_uptime_isr(&uptime);
+    remaining = (module.adjust.microseconds - adjust_get_applied(&uptime));
+    sys_unlock();
+
+    return (remaining);
+}
+
+#endif
+
 int time_add(struct time_t *res_p,
              struct time_t *left_p,
              struct time_t *right_p)
@@ -131,6 +308,10 @@ enum time_compare_t time_compare(struct time_t *left_p,
 #    include "time/unix_time_to_date.i"
 #endif
 
+#if CONFIG_TIME_FORMAT == 1
+#    include "time/format.i"
+#endif
+
 void time_busy_wait_us(int microseconds)
 {
     time_port_busy_wait_us(microseconds);
@@ -159,3 +340,68 @@ int time_micros_maximum()
 {
     return (time_port_micros_maximum());
 }
+
+#if CONFIG_TIME_CYCLES == 1
+
+uint64_t time_cycles(void)
+{
+    uint64_t cycles;
+
+    sys_lock();
+    cycles = time_cycles_isr();
+    sys_unlock();
+
+    return (cycles);
+}
+
+uint64_t RAM_CODE time_cycles_isr(void)
+{
+    uint32_t now;
+
+    /* Extend the 32 bits counter to 64 bits. Called at least once per
+       system tick, so no wrap is missed as long as the counter period
+       is longer than the tick period. */
+    now = cycles_get_isr();
+
+    if (now < module.cycles.last) {
+        module.cycles.wraps++;
+    }
+
+    module.cycles.last = now;
+
+    return (((uint64_t)module.cycles.wraps << 32) | now);
+}
+
+uint32_t time_cycles_frequency(void)
+{
+    if (module.cycles.frequency != 0) {
+        return (module.cycles.frequency);
+    }
+
+    return (CYCLES_FREQUENCY);
+}
+
+int time_cycles_set_frequency(uint32_t frequency)
+{
+    module.cycles.frequency = frequency;
+
+    return (0);
+}
+
+uint64_t time_cycles_to_us(uint64_t cycles)
+{
+    uint32_t frequency;
+
+    frequency = time_cycles_frequency();
+
+    /* Whole seconds and the remainder separately to not overflow. */
+    return ((cycles / frequency) * 1000000
+            + ((cycles % frequency) * 1000000) / frequency);
+}
+
+uint64_t time_monotonic_us(void)
+{
+    return (time_cycles_to_us(time_cycles()));
+}
+
+#endif
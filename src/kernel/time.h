@@ -83,7 +83,18 @@ enum time_compare_t {
 int time_get(struct time_t *now_p);
 
 /**
- * Set current time in seconds and nanoseconds.
+ * Get current time in seconds and nanoseconds from interrupt context
+ * or with the system lock taken.
+ *
+ * @param[out] now_p Read current time.
+ *
+ * @return zero(0) or negative error code.
+ */
+int time_get_isr(struct time_t *now_p);
+
+/**
+ * Set current time in seconds and nanoseconds. Cancels any ongoing
+ * adjustment started by `time_adjust()`.
  *
  * @param[in] new_p New current time.
  *
@@ -91,6 +102,31 @@ int time_get(struct time_t *now_p);
  */
 int time_set(struct time_t *new_p);
 
+/**
+ * Gradually adjust the current time by given number of microseconds,
+ * similar to adjtime(3). The time returned by `time_get()` runs at
+ * most ``CONFIG_TIME_ADJUST_RATE_PPM`` parts per million faster or
+ * slower than the uptime until the adjustment is complete, so it
+ * never jumps and never runs backwards. A new adjustment replaces the
+ * remaining part of an ongoing adjustment. Requires
+ * ``CONFIG_TIME_ADJUST``.
+ *
+ * @param[in] microseconds Number of microseconds to adjust the time
+ *                         with, positive to advance it and negative
+ *                         to retard it.
+ *
+ * @return zero(0) or negative error code.
+ */
+int time_adjust(long microseconds);
+
+/**
+ * Get the remaining part of the ongoing adjustment started by
+ * `time_adjust()`.
+ *
+ * @return Remaining number of microseconds to adjust the time with.
+ */
+long time_adjust_get_remaining(void);
+
 /**
  * Add given times.
  *
@@ -142,6 +178,50 @@ enum time_compare_t time_compare(struct time_t *left_p,
 int time_unix_time_to_date(struct date_t *date_p,
                            struct time_t *time_p);
 
+/**
+ * Format given time as ``<seconds>.<milliseconds>``, as in the log
+ * entry header. The seconds are only formatted once per second,
+ * after that they are copied from a cache.
+ *
+ * @param[out] buf_p Buffer to write the null terminated string to.
+ * @param[in] size Buffer size. Up to 16 bytes are needed.
+ * @param[in] time_p Time to format.
+ *
+ * @return String length or negative error code.
+ */
+ssize_t time_format_log_timestamp(char *buf_p,
+                                  size_t size,
+                                  struct time_t *time_p);
+
+/**
+ * Format the current time as a RFC 1123 date, for example ``Sun, 06
+ * Nov 1994 08:49:37 GMT``, as used in HTTP headers. The current time
+ * is taken as unix time, normally set with `time_set()` or by the
+ * SNTP client.
+ *
+ * The formatted date is cached and updated at most once per second.
+ * Within a day only the time of day is updated, so the unix time is
+ * only converted to a date when the day changes.
+ *
+ * @param[out] buf_p Buffer to write the null terminated string to.
+ * @param[in] size Buffer size. At least 30 bytes.
+ *
+ * @return String length or negative error code.
+ */
+ssize_t time_format_rfc1123(char *buf_p, size_t size);
+
+/**
+ * Get the current time as FAT directory entry date and time words,
+ * from the same cache as `time_format_rfc1123()`.
+ *
+ * @param[out] date_p FAT date.
+ * @param[out] time_p FAT time, with two seconds resolution.
+ *
+ * @return zero(0), -ERANGE if the current year is not in the FAT
+ *         range 1980 to 2107, or other negative error code.
+ */
+int time_format_fat(uint16_t *date_p, uint16_t *time_p);
+
 /**
  * Busy wait for given number of microseconds.
  *
@@ -203,4 +283,61 @@ int time_micros_resolution(void);
  */
 int time_micros_maximum(void);
 
+/**
+ * Get the number of cycles of the free running cycle counter, the CPU
+ * cycle counter on ARM (not SAMD), ESP and ESP32, the monotonic clock
+ * in microseconds on Linux, and the uptime in microseconds on other
+ * ports. The counter is extended to 64 bits and never wraps. It may
+ * stop in deep sleep modes. Requires ``CONFIG_TIME_CYCLES``.
+ *
+ * @return Current number of cycles.
+ */
+uint64_t time_cycles(void);
+
+/**
+ * Same as `time_cycles()`, but may only be called from interrupt
+ * context or with the system lock taken.
+ *
+ * @return Current number of cycles.
+ */
+uint64_t time_cycles_isr(void);
+
+/**
+ * Get the cycle counter frequency, as given to
+ * `time_cycles_set_frequency()`, or else the nominal frequency.
+ *
+ * @return Cycle counter frequency in Hz.
+ */
+uint32_t time_cycles_frequency(void);
+
+/**
+ * Set the cycle counter frequency used when converting cycles to
+ * time, for example after calibrating the CPU clock against a
+ * reference, or after changing the CPU frequency. Give zero(0) to use
+ * the nominal frequency.
+ *
+ * @param[in] frequency Cycle counter frequency in Hz.
+ *
+ * @return zero(0) or negative error code.
+ */
+int time_cycles_set_frequency(uint32_t frequency);
+
+/**
+ * Convert given number of cycles to microseconds.
+ *
+ * @param[in] cycles Number of cycles.
+ *
+ * @return Microseconds.
+ */
+uint64_t time_cycles_to_us(uint64_t cycles);
+
+/**
+ * Get the time in microseconds from the 64 bits cycle counter, see
+ * `time_cycles()`. Cheaper and with higher resolution than
+ * `time_get()`, but not adjusted by `time_set()`.
+ *
+ * @return Monotonic time in microseconds.
+ */
+uint64_t time_monotonic_us(void);
+
 #endif
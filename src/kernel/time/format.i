@@ -0,0 +1,275 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2014-2018, Erik Moqvist
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use, copy,
+ * modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ * This file is part of the Simba project.
+ */
+
+/* Length of a RFC 1123 date, "Sun, 06 Nov 1994 08:49:37 GMT". */
+#define RFC1123_LENGTH 29
+
+struct format_t {
+    struct {
+        int8_t valid;
+        int32_t seconds;
+        uint8_t length;
+        char buf[11];
+    } log;
+    struct {
+        int8_t valid;
+        int32_t seconds;
+        struct date_t date;
+        char rfc1123[RFC1123_LENGTH];
+        uint16_t fat_date;
+        uint16_t fat_time;
+    } calendar;
+};
+
+static struct format_t format;
+
+static FAR const char day_names[] = "SunMonTueWedThuFriSat";
+static FAR const char month_names[] = "JanFebMarAprMayJunJulAugSepOctNovDec";
+
+/**
+ * Copy the three letter name at given index in given names.
+ */
+static void format_name(char *buf_p, FAR const char *names_p, int index)
+{
+    buf_p[0] = names_p[3 * index + 0];
+    buf_p[1] = names_p[3 * index + 1];
+    buf_p[2] = names_p[3 * index + 2];
+}
+
+static void format_two_digits(char *buf_p, int value)
+{
+    buf_p[0] = ('0' + value / 10);
+    buf_p[1] = ('0' + value % 10);
+}
+
+/**
+ * Format the time of day of the cached date.
+ */
+static void format_time_of_day(void)
+{
+    struct date_t *date_p;
+
+    date_p = &format.calendar.date;
+    format_two_digits(&format.calendar.rfc1123[17], date_p->hour);
+    format_two_digits(&format.calendar.rfc1123[20], date_p->minute);
+    format_two_digits(&format.calendar.rfc1123[23], date_p->second);
+    format.calendar.fat_time = ((date_p->hour << 11)
+                                | (date_p->minute << 5)
+                                | (date_p->second / 2));
+}
+
+/**
+ * Format all fields of the cached date.
+ */
+static void format_date(void)
+{
+    struct date_t *date_p;
+    char *buf_p;
+
+    date_p = &format.calendar.date;
+    buf_p = &format.calendar.rfc1123[0];
+    format_name(&buf_p[0], &day_names[0], date_p->day);
+    buf_p[3] = ',';
+    buf_p[4] = ' ';
+    format_two_digits(&buf_p[5], date_p->date);
+    buf_p[7] = ' ';
+    format_name(&buf_p[8], &month_names[0], date_p->month - 1);
+    buf_p[11] = ' ';
+    format_two_digits(&buf_p[12], date_p->year / 100);
+    format_two_digits(&buf_p[14], date_p->year % 100);
+    buf_p[16] = ' ';
+    buf_p[19] = ':';
+    buf_p[22] = ':';
+    memcpy(&buf_p[25], " GMT", 4);
+
+    /* FAT dates count years from 1980. */
+    if ((date_p->year >= 1980) && (date_p->year <= 2107)) {
+        format.calendar.fat_date = (((date_p->year - 1980) << 9)
+                                    | (date_p->month << 5)
+                                    | date_p->date);
+    } else {
+        format.calendar.fat_date = 0;
+    }
+
+    format_time_of_day();
+}
+
+/**
+ * Bring the cached calendar date up to date with the current
+ * time. Within a day only the time of day is advanced and formatted,
+ * and the date is converted and formatted again when the day
+ * changes, or when the time was set.
+ */
+static int format_update_isr(void)
+{
+    struct time_t now;
+    struct date_t *date_p;
+    int32_t elapsed;
+    int res;
+
+    time_get_isr(&now);
+
+    if ((format.calendar.valid == 1)
+        && (now.seconds == format.calendar.seconds)) {
+        return (0);
+    }
+
+    date_p = &format.calendar.date;
+    elapsed = (now.seconds - format.calendar.seconds);
+
+    if ((format.calendar.valid == 1)
+        && (elapsed > 0)
+        && (elapsed < 86400)) {
+        elapsed += (date_p->hour * 3600L
+                    + date_p->minute * 60
+                    + date_p->second);
+
+        if (elapsed < 86400) {
+            date_p->hour = (elapsed / 3600);
+            date_p->minute = ((elapsed / 60) % 60);
+            date_p->second = (elapsed % 60);
+            format.calendar.seconds = now.seconds;
+            format_time_of_day();
+
+            return (0);
+        }
+    }
+
+    res = time_unix_time_to_date(date_p, &now);
+
+    if (res != 0) {
+        format.calendar.valid = 0;
+
+        return (res);
+    }
+
+    format.calendar.seconds = now.seconds;
+    format.calendar.valid = 1;
+    format_date();
+
+    return (0);
+}
+
+ssize_t time_format_log_timestamp(char *buf_p,
+                                  size_t size,
+                                  struct time_t *time_p)
+{
+    ASSERTN(buf_p != NULL, EINVAL);
+    ASSERTN(time_p != NULL, EINVAL);
+
+    ssize_t length;
+    int milliseconds;
+
+    if (size < sizeof(format.log.buf) + 5) {
+        return (-ENOMEM);
+    }
+
+    sys_lock();
+
+    if ((format.log.valid == 1) && (time_p->seconds == format.log.seconds)) {
+        length = format.log.length;
+        memcpy(buf_p, &format.log.buf[0], length);
+        sys_unlock();
+    } else {
+        sys_unlock();
+
+        /* Format the seconds once per second. */
+        length = std_snprintf(buf_p,
+                              sizeof(format.log.buf),
+                              FSTR("%lu"),
+                              time_p->seconds);
+
+        sys_lock();
+        memcpy(&format.log.buf[0], buf_p, length);
+        format.log.length = length;
+        format.log.seconds = time_p->seconds;
+        format.log.valid = 1;
+        sys_unlock();
+    }
+
+    milliseconds = (time_p->nanoseconds / 1000000);
+    buf_p[length++] = '.';
+    buf_p[length++] = ('0' + milliseconds / 100);
+    format_two_digits(&buf_p[length], milliseconds % 100);
+    length += 2;
+    buf_p[length] = '\0';
+
+    return (length);
+}
+
+ssize_t time_format_rfc1123(char *buf_p, size_t size)
+{
+    ASSERTN(buf_p != NULL, EINVAL);
+
+    int res;
+
+    if (size < RFC1123_LENGTH + 1) {
+        return (-ENOMEM);
+    }
+
+    sys_lock();
+    res = format_update_isr();
+
+    if (res == 0) {
+        memcpy(buf_p, &format.calendar.rfc1123[0], RFC1123_LENGTH);
+    }
+
+    sys_unlock();
+
+    if (res != 0) {
+        return (res);
+    }
+
+    buf_p[RFC1123_LENGTH] = '\0';
+
+    return (RFC1123_LENGTH);
+}
+
+int time_format_fat(uint16_t *date_p, uint16_t *time_p)
+{
+    ASSERTN(date_p != NULL, EINVAL);
+    ASSERTN(time_p != NULL, EINVAL);
+
+    int res;
+
+    sys_lock();
+    res = format_update_isr();
+
+    if (res == 0) {
+        if (format.calendar.fat_date == 0) {
+            res = -ERANGE;
+        } else {
+            *date_p = format.calendar.fat_date;
+            *time_p = format.calendar.fat_time;
+        }
+    }
+
+    sys_unlock();
+
+    return (res);
+}
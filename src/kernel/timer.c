@@ -33,6 +33,19 @@
  */
 #define TIMER_HIGH_RESOLUTION (1 << 1)
 
+/**
+ * Deferred timer waiting for the timer thread to call its callback.
+ */
+#define TIMER_DEFERRED_PENDING (1 << 3)
+
+/**
+ * The channel hint given by TIMER_CHANNEL(), and the high resolution
+ * channel selected by timer_init().
+ */
+#define TIMER_CHANNEL_HINT_MASK (0xf << 8)
+#define TIMER_CHANNEL_SHIFT 12
+#define TIMER_CHANNEL_MASK (0x7 << TIMER_CHANNEL_SHIFT)
+
 #include "timer_port.i"
 
 struct timer_list_t {
@@ -41,32 +54,62 @@ struct timer_list_t {
     struct timer_t tail;     /* Tail element of list. */
 };
 
+#if CONFIG_TIMER_WHEEL == 1
+
+#define TIMER_WHEEL_MASK (CONFIG_TIMER_WHEEL_SIZE - 1)
+
+/* A hashed timing wheel. A timer is stored in the slot of the tick it
+   expires on, and its delta is the number of remaining turns of the
+   wheel before it expires. */
+struct timer_wheel_t {
+    uint32_t tick;
+    struct timer_t *expired_p;
+    struct timer_t *slots[CONFIG_TIMER_WHEEL_SIZE];
+};
+
+#endif
+
 struct module_t {
+    int8_t initialized;
     struct {
+#if CONFIG_TIMER_WHEEL == 1
+        struct timer_wheel_t tick;
+#else
         struct timer_list_t tick;
-        struct timer_list_t high_resolution;
+#endif
+        struct timer_list_t high_resolution[
+            TIMER_PORT_HIGH_RESOLUTION_CHANNELS];
     } timers;
+    int next_channel;
+#if CONFIG_TIMER_DEFERRED == 1
+    struct {
+        struct timer_t *head_p;
+        struct timer_t **tail_pp;
+        int8_t started;
+        struct thrd_t *thrd_p;
+    } deferred;
+#endif
 };
 
 static struct module_t module = {
     .timers = {
+#if CONFIG_TIMER_WHEEL == 0
         .tick = {
             .head_p = &module.timers.tick.tail,
             .tail = {
                 .next_p = NULL,
+                .pprev_p = &module.timers.tick.head_p,
                 .delta = 0xffffffff
             }
         },
-        .high_resolution = {
-            .head_p = &module.timers.high_resolution.tail,
-            .tail = {
-                .next_p = NULL,
-                .delta = 0xffffffff
-            }
-        }
+#endif
     }
 };
 
+#if CONFIG_TIMER_DEFERRED == 1
+static THRD_STACK(deferred_stack, CONFIG_TIMER_DEFERRED_STACK_SIZE);
+#endif
+
 /**
  * Insert given timer in given list of active timers.
  */
@@ -98,54 +141,306 @@ static void RAM_CODE timer_list_insert_isr(struct timer_list_t *self_p,
     timer_p->next_p = elem_p;
 
     if (prev_p == NULL) {
-        self_p->head_p = timer_p;
+        timer_p->pprev_p = &self_p->head_p;
     } else {
-        prev_p->next_p = timer_p;
+        timer_p->pprev_p = &prev_p->next_p;
     }
+
+    *timer_p->pprev_p = timer_p;
+    elem_p->pprev_p = &timer_p->next_p;
 }
 
 /**
- * Remove given timer from given list of active timers.
+ * Remove given timer from given list of active timers in constant
+ * time.
+ *
+ * @return true(1) if the timer was removed, false(0) if it was not
+ *         in the list.
  */
 static int timer_list_remove_isr(struct timer_list_t *self_p,
                                  struct timer_t *timer_p)
 {
-    struct timer_t *elem_p;
-    struct timer_t *prev_p;
+    struct timer_t *next_p;
 
-    /* Find element preceeding this timer.*/
-    elem_p = self_p->head_p;
-    prev_p = NULL;
+    if (timer_p->pprev_p == NULL) {
+        return (0);
+    }
 
-    while (elem_p != NULL) {
-        if (elem_p == timer_p) {
-            /* Remove the timer from the list. */
-            if (prev_p != NULL) {
-                prev_p->next_p = elem_p->next_p;
-            } else {
-                self_p->head_p = elem_p->next_p;
-            }
+    next_p = timer_p->next_p;
+    *timer_p->pprev_p = next_p;
+    next_p->pprev_p = timer_p->pprev_p;
 
-            /* Add the delta timeout to the next timer. */
-            if (elem_p->next_p != &self_p->tail) {
-                elem_p->next_p->delta += elem_p->delta;
-            }
+    /* Add the delta timeout to the next timer. */
+    if (next_p != &self_p->tail) {
+        next_p->delta += timer_p->delta;
+    }
 
-            return (1);
-        }
+    timer_p->pprev_p = NULL;
 
-        prev_p = elem_p;
-        elem_p = elem_p->next_p;
+    return (1);
+}
+
+/**
+ * Remove the first timer from given list of active timers.
+ */
+static struct timer_t *RAM_CODE
+timer_list_remove_head_isr(struct timer_list_t *self_p)
+{
+    struct timer_t *timer_p;
+
+    timer_p = self_p->head_p;
+    self_p->head_p = timer_p->next_p;
+    self_p->head_p->pprev_p = &self_p->head_p;
+    timer_p->pprev_p = NULL;
+
+    return (timer_p);
+}
+
+#if CONFIG_TIMER_WHEEL == 1
+
+/**
+ * Add given timer first in given list.
+ */
+static void RAM_CODE timer_wheel_link_isr(struct timer_t **head_pp,
+                                          struct timer_t *timer_p)
+{
+    timer_p->next_p = *head_pp;
+
+    if (timer_p->next_p != NULL) {
+        timer_p->next_p->pprev_p = &timer_p->next_p;
     }
 
-    return (0);
+    timer_p->pprev_p = head_pp;
+    *head_pp = timer_p;
 }
 
+/**
+ * Remove given timer from the list it is in.
+ */
+static void RAM_CODE timer_wheel_unlink_isr(struct timer_t *timer_p)
+{
+    *timer_p->pprev_p = timer_p->next_p;
+
+    if (timer_p->next_p != NULL) {
+        timer_p->next_p->pprev_p = timer_p->pprev_p;
+    }
+
+    timer_p->pprev_p = NULL;
+}
+
+/**
+ * Insert given timer in the wheel. The timer expires after delta
+ * ticks.
+ */
+static void RAM_CODE timer_wheel_insert_isr(struct timer_wheel_t *self_p,
+                                            struct timer_t *timer_p)
+{
+    struct timer_t **slot_pp;
+
+    slot_pp = &self_p->slots[(self_p->tick + timer_p->delta)
+                             & TIMER_WHEEL_MASK];
+    timer_p->delta = ((timer_p->delta - 1) / CONFIG_TIMER_WHEEL_SIZE);
+    timer_wheel_link_isr(slot_pp, timer_p);
+}
+
+/**
+ * Remove given timer from the wheel.
+ *
+ * @return true(1) if the timer was removed, false(0) if it was not
+ *         in the wheel.
+ */
+static int timer_wheel_remove_isr(struct timer_wheel_t *self_p,
+                                  struct timer_t *timer_p)
+{
+    if (timer_p->pprev_p == NULL) {
+        return (0);
+    }
+
+    timer_wheel_unlink_isr(timer_p);
+
+    return (1);
+}
+
+#endif
+
 static int is_high_resolution_timer(struct timer_t *self_p)
 {
     return (self_p->flags & TIMER_HIGH_RESOLUTION);
 }
 
+static int high_resolution_channel(struct timer_t *self_p)
+{
+    return ((self_p->flags & TIMER_CHANNEL_MASK) >> TIMER_CHANNEL_SHIFT);
+}
+
+#if CONFIG_TIMER_DEFERRED == 1
+
+/**
+ * Remove given timer from the list of deferred timers waiting for
+ * the timer thread.
+ *
+ * @return true(1) if the timer was removed, false(0) if it was not
+ *         in the list.
+ */
+static int deferred_remove_isr(struct timer_t *timer_p)
+{
+    struct timer_t **elem_pp;
+
+    if (!(timer_p->flags & TIMER_DEFERRED_PENDING)) {
+        return (0);
+    }
+
+    elem_pp = &module.deferred.head_p;
+
+    while (*elem_pp != timer_p) {
+        elem_pp = &(*elem_pp)->deferred_next_p;
+    }
+
+    *elem_pp = timer_p->deferred_next_p;
+
+    if (module.deferred.tail_pp == &timer_p->deferred_next_p) {
+        module.deferred.tail_pp = elem_pp;
+    }
+
+    timer_p->flags &= ~TIMER_DEFERRED_PENDING;
+
+    return (1);
+}
+
+static void *deferred_main(void *arg_p)
+{
+    struct timer_t *timer_p;
+    timer_callback_t callback;
+    void *callback_arg_p;
+
+    thrd_set_name("timer");
+
+    while (1) {
+        sys_lock();
+
+        while (module.deferred.head_p == NULL) {
+            module.deferred.thrd_p = thrd_self();
+            thrd_suspend_isr(NULL);
+        }
+
+        timer_p = module.deferred.head_p;
+        deferred_remove_isr(timer_p);
+        callback = timer_p->callback;
+        callback_arg_p = timer_p->arg_p;
+        sys_unlock();
+
+        callback(callback_arg_p);
+    }
+
+    return (NULL);
+}
+
+/**
+ * Spawn the timer thread, unless already spawned.
+ */
+static int deferred_start(void)
+{
+    int spawn;
+
+    sys_lock();
+    spawn = (module.deferred.started == 0);
+    module.deferred.started = 1;
+    sys_unlock();
+
+    if (spawn) {
+        if (thrd_spawn(deferred_main,
+                       NULL,
+                       CONFIG_TIMER_DEFERRED_PRIO,
+                       deferred_stack,
+                       sizeof(deferred_stack)) == NULL) {
+            return (-ENOMEM);
+        }
+    }
+
+    return (0);
+}
+
+#endif
+
+/**
+ * Call the callback of given expired timer, or let the timer thread
+ * call it for deferred timers.
+ */
+static void RAM_CODE timer_expire_isr(struct timer_t *timer_p)
+{
+    TRACE_ISR(TIMER_EXPIRE, timer_p, 0);
+
+#if CONFIG_TIMER_DEFERRED == 1
+    if (timer_p->flags & TIMER_DEFERRED) {
+        if (!(timer_p->flags & TIMER_DEFERRED_PENDING)) {
+            timer_p->flags |= TIMER_DEFERRED_PENDING;
+            timer_p->deferred_next_p = NULL;
+            *module.deferred.tail_pp = timer_p;
+            module.deferred.tail_pp = &timer_p->deferred_next_p;
+
+            if (module.deferred.thrd_p != NULL) {
+                thrd_resume_isr(module.deferred.thrd_p, 0);
+                module.deferred.thrd_p = NULL;
+            }
+        }
+
+        return;
+    }
+#endif
+
+    timer_p->callback(timer_p->arg_p);
+}
+
+#if CONFIG_TIMER_WHEEL == 1
+
+void RAM_CODE timer_tick_isr(void)
+{
+    struct timer_t *timer_p;
+    struct timer_t *next_p;
+    struct timer_wheel_t *wheel_p;
+
+    wheel_p = &module.timers.tick;
+
+    sys_lock_isr();
+
+    wheel_p->tick++;
+    timer_p = wheel_p->slots[wheel_p->tick & TIMER_WHEEL_MASK];
+
+    /* Move all expired timers in the current slot to the expired
+       list. Timers started or stopped by the callbacks are then
+       handled correctly. */
+    while (timer_p != NULL) {
+        next_p = timer_p->next_p;
+
+        if (timer_p->delta == 0) {
+            timer_wheel_unlink_isr(timer_p);
+            timer_wheel_link_isr(&wheel_p->expired_p, timer_p);
+        } else {
+            timer_p->delta--;
+        }
+
+        timer_p = next_p;
+    }
+
+    /* Fire all expired timers.*/
+    while (wheel_p->expired_p != NULL) {
+        timer_p = wheel_p->expired_p;
+        timer_wheel_unlink_isr(timer_p);
+        timer_expire_isr(timer_p);
+
+        /* Re-set periodic timers. */
+        if ((timer_p->flags & TIMER_PERIODIC)
+            && (timer_p->pprev_p == NULL)) {
+            timer_p->delta = timer_p->timeout;
+            timer_wheel_insert_isr(wheel_p, timer_p);
+        }
+    }
+
+    sys_unlock_isr();
+}
+
+#else
+
 void RAM_CODE timer_tick_isr(void)
 {
     struct timer_t *timer_p;
@@ -161,12 +456,13 @@ void RAM_CODE timer_tick_isr(void)
         list_p->head_p->delta--;
 
         while (list_p->head_p->delta == 0) {
-            timer_p = list_p->head_p;
-            list_p->head_p = timer_p->next_p;
-            timer_p->callback(timer_p->arg_p);
+            timer_p = timer_list_remove_head_isr(list_p);
+            timer_expire_isr(timer_p);
 
-            /* Re-set periodic timers. */
-            if (timer_p->flags & TIMER_PERIODIC) {
+            /* Re-set periodic timers, unless restarted by the
+               callback. */
+            if ((timer_p->flags & TIMER_PERIODIC)
+                && (timer_p->pprev_p == NULL)) {
                 timer_p->delta = timer_p->timeout;
                 timer_list_insert_isr(list_p, timer_p);
             }
@@ -176,33 +472,227 @@ void RAM_CODE timer_tick_isr(void)
     sys_unlock_isr();
 }
 
-void RAM_CODE timer_high_resolution_isr(void)
+#endif
+
+#if CONFIG_SYSTEM_TICKLESS == 1
+
+#    if CONFIG_TIMER_WHEEL == 1
+
+uint32_t timer_tick_next_expiry_isr(void)
+{
+    struct timer_t *timer_p;
+    struct timer_wheel_t *wheel_p;
+    uint32_t ticks;
+    uint32_t next;
+    int i;
+
+    wheel_p = &module.timers.tick;
+    next = 0xffffffff;
+
+    for (i = 1; i <= CONFIG_TIMER_WHEEL_SIZE; i++) {
+        timer_p = wheel_p->slots[(wheel_p->tick + i) & TIMER_WHEEL_MASK];
+
+        while (timer_p != NULL) {
+            ticks = (i + timer_p->delta * CONFIG_TIMER_WHEEL_SIZE);
+
+            if (ticks < next) {
+                next = ticks;
+            }
+
+            timer_p = timer_p->next_p;
+        }
+
+        /* No timer expires earlier than one in this slot without
+           remaining turns. */
+        if (next == i) {
+            break;
+        }
+    }
+
+    return (next);
+}
+
+void timer_tick_skip_isr(uint32_t ticks)
+{
+    struct timer_t *timer_p;
+    struct timer_t *next_p;
+    struct timer_wheel_t *wheel_p;
+
+    wheel_p = &module.timers.tick;
+
+    while (ticks > 0) {
+        wheel_p->tick++;
+        timer_p = wheel_p->slots[wheel_p->tick & TIMER_WHEEL_MASK];
+
+        while (timer_p != NULL) {
+            next_p = timer_p->next_p;
+
+            if (timer_p->delta == 0) {
+                /* Should not expire while skipping. Move it to the
+                   next slot so it expires on the next tick. */
+                timer_wheel_unlink_isr(timer_p);
+                timer_wheel_link_isr(
+                    &wheel_p->slots[(wheel_p->tick + 1) & TIMER_WHEEL_MASK],
+                    timer_p);
+            } else {
+                timer_p->delta--;
+            }
+
+            timer_p = next_p;
+        }
+
+        ticks--;
+    }
+}
+
+#    else
+
+uint32_t timer_tick_next_expiry_isr(void)
+{
+    struct timer_list_t *list_p;
+
+    list_p = &module.timers.tick;
+
+    if (list_p->head_p == &list_p->tail) {
+        return (0xffffffff);
+    }
+
+    return (list_p->head_p->delta);
+}
+
+void timer_tick_skip_isr(uint32_t ticks)
+{
+    struct timer_list_t *list_p;
+
+    list_p = &module.timers.tick;
+
+    if (list_p->head_p == &list_p->tail) {
+        return;
+    }
+
+    /* The first timer should not expire while skipping. If it would,
+       let it expire on the next tick instead. */
+    if (list_p->head_p->delta > ticks) {
+        list_p->head_p->delta -= ticks;
+    } else {
+        list_p->head_p->delta = 1;
+    }
+}
+
+#    endif
+
+#endif
+
+/**
+ * Insert given high resolution timer in the list of given channel,
+ * and restart the hardware compare with the first timer.
+ */
+static void RAM_CODE high_resolution_insert_isr(int channel,
+                                                struct timer_t *timer_p)
+{
+    struct timer_list_t *list_p;
+
+    list_p = &module.timers.high_resolution[channel];
+
+    /* Stop any running timer as the new timer may expire before
+       it. The stop function will update the stopped timers delta
+       to the remaining time. */
+    if (list_p->head_p != &list_p->tail) {
+        timer_port_high_resolution_stop_isr(channel, list_p->head_p);
+    }
+
+    timer_list_insert_isr(list_p, timer_p);
+    timer_port_high_resolution_start_isr(channel, list_p->head_p);
+}
+
+/**
+ * Remove given high resolution timer from the list of its channel,
+ * and restart the hardware compare if it was the first timer.
+ *
+ * @return true(1) if the timer was removed, false(0) if it was not
+ *         in the list.
+ */
+static int high_resolution_remove_isr(struct timer_t *timer_p)
+{
+    struct timer_list_t *list_p;
+    int channel;
+    int first;
+
+    channel = high_resolution_channel(timer_p);
+    list_p = &module.timers.high_resolution[channel];
+    first = (timer_p == list_p->head_p);
+
+    /* The stop function will update the stopped timers delta to the
+       remaining time, which is given to the next timer. */
+    if (first) {
+        timer_port_high_resolution_stop_isr(channel, timer_p);
+    }
+
+    if (timer_list_remove_isr(list_p, timer_p) == 0) {
+        return (0);
+    }
+
+    if (first && (list_p->head_p != &list_p->tail)) {
+        timer_port_high_resolution_start_isr(channel, list_p->head_p);
+    }
+
+    return (1);
+}
+
+void RAM_CODE timer_high_resolution_isr(int channel)
 {
     struct timer_t *timer_p;
     struct timer_list_t *list_p;
 
-    list_p = &module.timers.high_resolution;
+    list_p = &module.timers.high_resolution[channel];
 
     sys_lock_isr();
 
     /* Remove the timer from the list. */
-    timer_p = list_p->head_p;
-    list_p->head_p = timer_p->next_p;
+    timer_p = timer_list_remove_head_isr(list_p);
 
     /* Start the next timer before calling the callback for higher
        accuracy, if any. */
     if (list_p->head_p != &list_p->tail) {
-        timer_port_high_resolution_start_isr(list_p->head_p);
+        timer_port_high_resolution_start_isr(channel, list_p->head_p);
     }
 
     /* Fire the expired timer.*/
-    timer_p->callback(timer_p->arg_p);
+    timer_expire_isr(timer_p);
+
+    /* Re-set periodic timers, unless restarted by the callback. */
+    if ((timer_p->flags & TIMER_PERIODIC) && (timer_p->pprev_p == NULL)) {
+        timer_p->delta = timer_p->timeout;
+        high_resolution_insert_isr(channel, timer_p);
+    }
 
     sys_unlock_isr();
 }
 
 int timer_module_init(void)
 {
+    struct timer_list_t *list_p;
+    int i;
+
+    /* Return immediately if the module is already initialized. */
+    if (module.initialized == 1) {
+        return (0);
+    }
+
+    module.initialized = 1;
+
+    for (i = 0; i < TIMER_PORT_HIGH_RESOLUTION_CHANNELS; i++) {
+        list_p = &module.timers.high_resolution[i];
+        list_p->head_p = &list_p->tail;
+        list_p->tail.next_p = NULL;
+        list_p->tail.pprev_p = &list_p->head_p;
+        list_p->tail.delta = 0xffffffff;
+    }
+
+#if CONFIG_TIMER_DEFERRED == 1
+    module.deferred.tail_pp = &module.deferred.head_p;
+#endif
+
     return (timer_port_module_init());
 }
 
@@ -217,13 +707,37 @@ int timer_init(struct timer_t *self_p,
     ASSERTN(callback != NULL, EINVAL);
 
     int res;
+    int channel;
+
+    if (flags & TIMER_DEFERRED) {
+#if CONFIG_TIMER_DEFERRED == 1
+        res = deferred_start();
+
+        if (res != 0) {
+            return (res);
+        }
+#else
+        return (-ENOSYS);
+#endif
+    }
 
     res = timer_port_high_resolution_init(self_p,
                                           timeout_p,
                                           flags);
 
     if (res == 0) {
-        flags |= TIMER_HIGH_RESOLUTION;
+        /* Use the hinted channel, or the next channel in turn. */
+        if (flags & TIMER_CHANNEL_HINT_MASK) {
+            channel = ((((flags & TIMER_CHANNEL_HINT_MASK) >> 8) - 1)
+                       % TIMER_PORT_HIGH_RESOLUTION_CHANNELS);
+        } else {
+            channel = module.next_channel;
+            module.next_channel = ((channel + 1)
+                                   % TIMER_PORT_HIGH_RESOLUTION_CHANNELS);
+        }
+
+        flags &= ~TIMER_CHANNEL_MASK;
+        flags |= (TIMER_HIGH_RESOLUTION | (channel << TIMER_CHANNEL_SHIFT));
     } else {
         self_p->timeout = t2st(timeout_p);
 
@@ -232,6 +746,7 @@ int timer_init(struct timer_t *self_p,
         }
     }
 
+    self_p->pprev_p = NULL;
     self_p->flags = flags;
     self_p->callback = callback;
     self_p->arg_p = arg_p;
@@ -252,29 +767,33 @@ int timer_start(struct timer_t *self_p)
 
 int RAM_CODE timer_start_isr(struct timer_t *self_p)
 {
-    struct timer_list_t *list_p;
+    /* Restart the timer if already started. Its remaining delta is
+       given to the next timer. */
+    if (is_high_resolution_timer(self_p)) {
+        high_resolution_remove_isr(self_p);
+    } else {
+#if CONFIG_TIMER_WHEEL == 0
+        timer_list_remove_isr(&module.timers.tick, self_p);
+#endif
+    }
 
     self_p->delta = self_p->timeout;
 
     if (is_high_resolution_timer(self_p)) {
-        list_p = &module.timers.high_resolution;
-
-        /* Stop any running timer as the new timer may expire before
-           it. The stop function will update the stopped timers delta
-           to the remaining time. */
-        if (list_p->head_p != &list_p->tail) {
-            timer_port_high_resolution_stop_isr(list_p->head_p);
-        }
-
-        timer_list_insert_isr(list_p, self_p);
-        timer_port_high_resolution_start_isr(list_p->head_p);
+        high_resolution_insert_isr(high_resolution_channel(self_p), self_p);
     } else {
         /* Must wait at least two ticks to ensure the timer does not
            expire early since it may be started close to the next tick
            occurs. */
         self_p->delta++;
 
+#if CONFIG_TIMER_WHEEL == 1
+        /* Restart the timer if already started. */
+        timer_wheel_remove_isr(&module.timers.tick, self_p);
+        timer_wheel_insert_isr(&module.timers.tick, self_p);
+#else
         timer_list_insert_isr(&module.timers.tick, self_p);
+#endif
     }
 
     return (0);
@@ -295,17 +814,21 @@ int timer_stop(struct timer_t *self_p)
 
 int timer_stop_isr(struct timer_t *self_p)
 {
-    struct timer_list_t *list_p;
+    int res;
 
     if (is_high_resolution_timer(self_p)) {
-        list_p = &module.timers.high_resolution;
-
-        if (self_p == list_p->head_p) {
-            timer_port_high_resolution_stop_isr(self_p);
-        }
+        res = high_resolution_remove_isr(self_p);
     } else {
-        list_p = &module.timers.tick;
+#if CONFIG_TIMER_WHEEL == 1
+        res = timer_wheel_remove_isr(&module.timers.tick, self_p);
+#else
+        res = timer_list_remove_isr(&module.timers.tick, self_p);
+#endif
     }
 
-    return (timer_list_remove_isr(list_p, self_p));
+#if CONFIG_TIMER_DEFERRED == 1
+    res |= deferred_remove_isr(self_p);
+#endif
+
+    return (res);
 }
@@ -40,17 +40,44 @@
  */
 #define TIMER_PERIODIC        (1 << 0)
 
+/**
+ * Call the callback from the timer thread instead of from interrupt
+ * context. The interrupt handler only queues the expired timer, so
+ * it stays short no matter how much work the callback does, and the
+ * callback may call any function that may be called from a thread.
+ * The timer thread has priority ``CONFIG_TIMER_DEFERRED_PRIO``.
+ *
+ * A periodic timer that expires again before its previous callback
+ * has been called is only called once. Requires
+ * ``CONFIG_TIMER_DEFERRED``.
+ */
+#define TIMER_DEFERRED        (1 << 2)
+
+/**
+ * Hint the hardware compare channel to use for a high resolution
+ * timer. Timers on different channels expire independently of each
+ * other, so a timer with a tight deadline can be given a channel of
+ * its own. The channel number is taken modulo the number of channels
+ * of the port, and timers without a hint are spread evenly over the
+ * channels. Ignored for system tick timers.
+ */
+#define TIMER_CHANNEL(channel) ((((channel) & 0x7) + 1) << 8)
+
 /** Timer callback prototype. */
 typedef void (*timer_callback_t)(void *arg_p);
 
 /* Timer. */
 struct timer_t {
     struct timer_t *next_p;
+    struct timer_t **pprev_p;
     uint32_t delta;
     uint32_t timeout;
     int flags;
     timer_callback_t callback;
     void *arg_p;
+#if CONFIG_TIMER_DEFERRED == 1
+    struct timer_t *deferred_next_p;
+#endif
 };
 
 /**
@@ -75,10 +102,12 @@ int timer_module_init(void);
  * @param[in] self_p Timer object to initialize with given parameters.
  * @param[in] timeout_p The timer timeout value.
  * @param[in] callback Functaion called when the timer expires. Called
- *                     from interrupt context.
+ *                     from interrupt context, or from the timer
+ *                     thread if ``TIMER_DEFERRED`` is set.
  * @param[in] arg_p Function callback argument. Passed to the callback
  *                  when the timer expires.
- * @param[in] flags Set TIMER_PERIODIC for periodic timer.
+ * @param[in] flags Set TIMER_PERIODIC for periodic timer, and
+ *                  TIMER_DEFERRED and TIMER_CHANNEL() as needed.
  *
  * @return zero(0) or negative error code.
  */
@@ -110,6 +139,9 @@ int timer_start_isr(struct timer_t *self_p);
  * expired or was never started. A stopped timer may be restarted with
  * the initial timeout by calling `timer_start()`.
  *
+ * A deferred timer that has expired but whose callback has not yet
+ * been called is stopped, and its callback is not called.
+ *
  * @param[in] self_p Timer object to stop.
  *
  * @return true(1) if the timer was stopped, false(0) if the timer
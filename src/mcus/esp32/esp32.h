@@ -175,6 +175,8 @@
 #define ESP32_CPU_INTR_UART_NUM      ESP32_CPU_INTR_PERIPHERAL_13_PRIO_1
 #define ESP32_CPU_INTR_CAN_NUM       ESP32_CPU_INTR_PERIPHERAL_17_PRIO_1
 #define ESP32_CPU_INTR_SPI_NUM       ESP32_CPU_INTR_PERIPHERAL_18_PRIO_1
+#define ESP32_CPU_INTR_DAC_NUM       ESP32_CPU_INTR_PERIPHERAL_14_PRIO_1
+#define ESP32_CPU_INTR_RMT_NUM       ESP32_CPU_INTR_PERIPHERAL_8_PRIO_1
 
 /**
  * Interrupt matrix mapping registers.
@@ -1236,6 +1238,81 @@ struct esp32_spi_t {
 #define ESP32_SPI_USER_USR_MOSI                        BIT(27)
 #define ESP32_SPI_USER_USR_MISO                        BIT(28)
 
+/**
+ * Remote Control Peripheral.
+ */
+struct esp32_rmt_t {
+    uint32_t DATA_CH[8];
+    struct {
+        uint32_t CONF0;
+        uint32_t CONF1;
+    } CONF[8];
+    uint32_t STATUS[8];
+    uint32_t APB_MEM_ADDR[8];
+    uint32_t INT_RAW;
+    uint32_t INT_ST;
+    uint32_t INT_ENA;
+    uint32_t INT_CLR;
+    uint32_t CARRIER_DUTY[8];
+    uint32_t TX_LIM[8];
+    uint32_t APB_CONF;
+    uint32_t RESERVED0[2];
+    uint32_t DATE;
+};
+
+/* Configuration register 0. */
+#define ESP32_RMT_CONF0_DIV_CNT_POS                        (0)
+#define ESP32_RMT_CONF0_DIV_CNT_MASK                    \
+    (0xff << ESP32_RMT_CONF0_DIV_CNT_POS)
+#define ESP32_RMT_CONF0_DIV_CNT(value)                  \
+    BITFIELD_SET(ESP32_RMT_CONF0_DIV_CNT, value)
+#define ESP32_RMT_CONF0_IDLE_THRES_POS                     (8)
+#define ESP32_RMT_CONF0_IDLE_THRES_MASK                 \
+    (0x3fff << ESP32_RMT_CONF0_IDLE_THRES_POS)
+#define ESP32_RMT_CONF0_IDLE_THRES(value)               \
+    BITFIELD_SET(ESP32_RMT_CONF0_IDLE_THRES, value)
+#define ESP32_RMT_CONF0_MEM_SIZE_POS                      (24)
+#define ESP32_RMT_CONF0_MEM_SIZE_MASK                   \
+    (0xf << ESP32_RMT_CONF0_MEM_SIZE_POS)
+#define ESP32_RMT_CONF0_MEM_SIZE(value)                 \
+    BITFIELD_SET(ESP32_RMT_CONF0_MEM_SIZE, value)
+#define ESP32_RMT_CONF0_CARRIER_EN                     BIT(28)
+#define ESP32_RMT_CONF0_CARRIER_OUT_LV                 BIT(29)
+#define ESP32_RMT_CONF0_MEM_PD                         BIT(30)
+#define ESP32_RMT_CONF0_CLK_EN                         BIT(31)
+
+/* Configuration register 1. */
+#define ESP32_RMT_CONF1_TX_START                        BIT(0)
+#define ESP32_RMT_CONF1_RX_EN                           BIT(1)
+#define ESP32_RMT_CONF1_MEM_WR_RST                      BIT(2)
+#define ESP32_RMT_CONF1_MEM_RD_RST                      BIT(3)
+#define ESP32_RMT_CONF1_APB_MEM_RST                     BIT(4)
+#define ESP32_RMT_CONF1_MEM_OWNER                       BIT(5)
+#define ESP32_RMT_CONF1_TX_CONTI_MODE                   BIT(6)
+#define ESP32_RMT_CONF1_REF_CNT_RST                    BIT(16)
+#define ESP32_RMT_CONF1_REF_ALWAYS_ON                  BIT(17)
+#define ESP32_RMT_CONF1_IDLE_OUT_LV                    BIT(18)
+#define ESP32_RMT_CONF1_IDLE_OUT_EN                    BIT(19)
+
+/* Interrupt registers. */
+#define ESP32_RMT_INT_TX_END(channel)             BIT(3 * (channel))
+#define ESP32_RMT_INT_RX_END(channel)         BIT(3 * (channel) + 1)
+#define ESP32_RMT_INT_ERR(channel)            BIT(3 * (channel) + 2)
+#define ESP32_RMT_INT_TX_THR_EVENT(channel)      BIT(24 + (channel))
+
+/* APB configuration register. */
+#define ESP32_RMT_APB_CONF_FIFO_MASK                    BIT(0)
+#define ESP32_RMT_APB_CONF_MEM_TX_WRAP_EN               BIT(1)
+
+/* Channel RAM. Each channel has a block of 64 entries. */
+#define ESP32_RMT_RAM_BLOCK_SIZE                            64
+
+#define ESP32_RMT_ENTRY(level0, duration0, level1, duration1)   \
+    (((uint32_t)(level1) << 31)                                 \
+     | ((uint32_t)(duration1) << 16)                            \
+     | ((uint32_t)(level0) << 15)                               \
+     | (uint32_t)(duration0))
+
 struct esp32_rtc_control_t {
 };
 
@@ -1402,7 +1479,8 @@ struct esp32_rnd_t {
 #define ESP32_I2C0             ((volatile struct esp32_i2c_t      *)0x3ff53000)
 #define ESP32_UDMA0            ((volatile struct esp32__t         *)0x3ff54000)
 #define ESP32_SDIO_SLAVE_1     ((volatile struct esp32__t         *)0x3ff55000)
-#define ESP32_RMT              ((volatile struct esp32__t         *)0x3ff56000)
+#define ESP32_RMT              ((volatile struct esp32_rmt_t      *)0x3ff56000)
+#define ESP32_RMT_RAM          ((volatile uint32_t                *)0x3ff56800)
 #define ESP32_PCNT             ((volatile struct esp32__t         *)0x3ff57000)
 #define ESP32_SDIO_SLAVE_2     ((volatile struct esp32__t         *)0x3ff58000)
 #define ESP32_LED_PWM          ((volatile struct esp32__t         *)0x3ff59000)
@@ -52,6 +52,9 @@ LIBPATH += "$(SIMBA_ROOT)/src/mcus/esp32/ld" \
 
 LDFLAGS += -Wl,-T$(LINKER_SCRIPT)
 
+# Functions in RAM_CODE_FUNCTIONS are placed in IRAM.
+RAM_CODE_SECTION = .iram1
+
 LIB += \
 	app_update \
 	hal \
@@ -34,6 +34,7 @@ struct uart_device_t uart_device[UART_DEVICE_MAX];
 struct can_device_t can_device[CAN_DEVICE_MAX];
 struct adc_device_t adc_device[ADC_DEVICE_MAX];
 struct dac_device_t dac_device[DAC_DEVICE_MAX];
+struct dma_device_t dma_device[DMA_DEVICE_MAX];
 
 struct flash_device_t flash_device[FLASH_DEVICE_MAX] = {
     { .mutex = { .is_locked = 0, .waiters = { .head_p = NULL } } },
@@ -64,6 +65,10 @@ struct spi_device_t spi_device[SPI_DEVICE_MAX] = {
             .waiters = {
                 .head_p = NULL
             }
+        },
+        .transactions = {
+            .head_p = NULL,
+            .tail_p = NULL
         }
     }
 };
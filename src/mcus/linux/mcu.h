@@ -39,5 +39,6 @@
 #define FLASH_DEVICE_MAX                                   16
 #define DAC_DEVICE_MAX                                     16
 #define I2C_DEVICE_MAX                                     16
+#define DMA_DEVICE_MAX                                      2
 
 #endif
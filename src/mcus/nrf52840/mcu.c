@@ -84,7 +84,7 @@ struct pin_device_t pin_device[PIN_DEVICE_MAX] = {
 struct uart_device_t uart_device[UART_DEVICE_MAX] = {
     {
         .drv_p = NULL,
-        .regs_p = NRF5_UART0,
+        .regs_p = NRF5_UARTE0,
         .tx_pin_p = &pin_device[6],
         .rx_pin_p = &pin_device[8]
     }
@@ -92,5 +92,34 @@ struct uart_device_t uart_device[UART_DEVICE_MAX] = {
 
 struct flash_device_t flash_device[FLASH_DEVICE_MAX];
 
-/* Use software i2c. */
-struct i2c_device_t i2c_device[I2C_DEVICE_MAX];
+struct i2c_device_t i2c_device[I2C_DEVICE_MAX] = {
+    {
+        .regs_p = NRF5_TWIM0,
+        .scl_p = &pin_device[27],
+        .sda_p = &pin_device[26],
+        .drv_p = NULL,
+        .transactions = {
+            .head_p = NULL,
+            .tail_p = NULL
+        }
+    }
+};
+
+struct spi_device_t spi_device[SPI_DEVICE_MAX] = {
+    {
+        .drv_p = NULL,
+        .regs_p = NRF5_SPIM2,
+        .mosi_p = &pin_device[45],
+        .miso_p = &pin_device[46],
+        .sck_p = &pin_device[47],
+        .mutex = {
+            .is_locked = 0,
+            .waiters = {
+                .head_p = NULL }
+        },
+        .transactions = {
+            .head_p = NULL,
+            .tail_p = NULL
+        }
+    }
+};
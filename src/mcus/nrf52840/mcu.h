@@ -34,6 +34,7 @@
 #define PIN_DEVICE_MAX     48
 #define UART_DEVICE_MAX     1
 #define I2C_DEVICE_MAX      1
+#define SPI_DEVICE_MAX      1
 #define FLASH_DEVICE_MAX    1
 
 #endif
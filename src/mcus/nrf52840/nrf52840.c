@@ -65,6 +65,54 @@ void isr_pend_sv(void)          __attribute__ ((weak, alias("isr_none")));
 void isr_sys_tick(void)         __attribute__ ((weak, alias("isr_none")));
 
 /* Non-system exceptions (16+). */
+void isr_power_clock(void)      __attribute__ ((weak, alias("isr_none")));
+void isr_radio(void)            __attribute__ ((weak, alias("isr_none")));
+void isr_uart0(void)            __attribute__ ((weak, alias("isr_none")));
+void isr_spi0_twi0(void)        __attribute__ ((weak, alias("isr_none")));
+void isr_spi1_twi1(void)        __attribute__ ((weak, alias("isr_none")));
+void isr_nfct(void)             __attribute__ ((weak, alias("isr_none")));
+void isr_gpiote(void)           __attribute__ ((weak, alias("isr_none")));
+void isr_saadc(void)            __attribute__ ((weak, alias("isr_none")));
+void isr_timer0(void)           __attribute__ ((weak, alias("isr_none")));
+void isr_timer1(void)           __attribute__ ((weak, alias("isr_none")));
+void isr_timer2(void)           __attribute__ ((weak, alias("isr_none")));
+void isr_rtc0(void)             __attribute__ ((weak, alias("isr_none")));
+void isr_temp(void)             __attribute__ ((weak, alias("isr_none")));
+void isr_rng(void)              __attribute__ ((weak, alias("isr_none")));
+void isr_ecb(void)              __attribute__ ((weak, alias("isr_none")));
+void isr_ccm_aar(void)          __attribute__ ((weak, alias("isr_none")));
+void isr_wdt(void)              __attribute__ ((weak, alias("isr_none")));
+void isr_rtc1(void)             __attribute__ ((weak, alias("isr_none")));
+void isr_qdec(void)             __attribute__ ((weak, alias("isr_none")));
+void isr_comp_lpcomp(void)      __attribute__ ((weak, alias("isr_none")));
+void isr_swi0_egu0(void)        __attribute__ ((weak, alias("isr_none")));
+void isr_swi1_egu1(void)        __attribute__ ((weak, alias("isr_none")));
+void isr_swi2_egu2(void)        __attribute__ ((weak, alias("isr_none")));
+void isr_swi3_egu3(void)        __attribute__ ((weak, alias("isr_none")));
+void isr_swi4_egu4(void)        __attribute__ ((weak, alias("isr_none")));
+void isr_swi5_egu5(void)        __attribute__ ((weak, alias("isr_none")));
+void isr_timer3(void)           __attribute__ ((weak, alias("isr_none")));
+void isr_timer4(void)           __attribute__ ((weak, alias("isr_none")));
+void isr_pwm0(void)             __attribute__ ((weak, alias("isr_none")));
+void isr_pdm(void)              __attribute__ ((weak, alias("isr_none")));
+void isr_reserved6(void)        __attribute__ ((weak, alias("isr_none")));
+void isr_reserved7(void)        __attribute__ ((weak, alias("isr_none")));
+void isr_mwu(void)              __attribute__ ((weak, alias("isr_none")));
+void isr_pwm1(void)             __attribute__ ((weak, alias("isr_none")));
+void isr_pwm2(void)             __attribute__ ((weak, alias("isr_none")));
+void isr_spi2(void)             __attribute__ ((weak, alias("isr_none")));
+void isr_rtc2(void)             __attribute__ ((weak, alias("isr_none")));
+void isr_i2s(void)              __attribute__ ((weak, alias("isr_none")));
+void isr_fpu(void)              __attribute__ ((weak, alias("isr_none")));
+void isr_usbd(void)             __attribute__ ((weak, alias("isr_none")));
+void isr_uart1(void)            __attribute__ ((weak, alias("isr_none")));
+void isr_qspi(void)             __attribute__ ((weak, alias("isr_none")));
+void isr_cryptocell(void)       __attribute__ ((weak, alias("isr_none")));
+void isr_reserved8(void)        __attribute__ ((weak, alias("isr_none")));
+void isr_reserved9(void)        __attribute__ ((weak, alias("isr_none")));
+void isr_pwm3(void)             __attribute__ ((weak, alias("isr_none")));
+void isr_reserved10(void)       __attribute__ ((weak, alias("isr_none")));
+void isr_spi3(void)             __attribute__ ((weak, alias("isr_none")));
 
 void isr_reset(void)
 {
@@ -117,4 +165,52 @@ void (*vector_table[])(void) = {
     isr_sys_tick,
 
     /* Non-system exceptions (16+). */
+    isr_power_clock,
+    isr_radio,
+    isr_uart0,
+    isr_spi0_twi0,
+    isr_spi1_twi1,
+    isr_nfct,
+    isr_gpiote,
+    isr_saadc,
+    isr_timer0,
+    isr_timer1,
+    isr_timer2,
+    isr_rtc0,
+    isr_temp,
+    isr_rng,
+    isr_ecb,
+    isr_ccm_aar,
+    isr_wdt,
+    isr_rtc1,
+    isr_qdec,
+    isr_comp_lpcomp,
+    isr_swi0_egu0,
+    isr_swi1_egu1,
+    isr_swi2_egu2,
+    isr_swi3_egu3,
+    isr_swi4_egu4,
+    isr_swi5_egu5,
+    isr_timer3,
+    isr_timer4,
+    isr_pwm0,
+    isr_pdm,
+    isr_reserved6,
+    isr_reserved7,
+    isr_mwu,
+    isr_pwm1,
+    isr_pwm2,
+    isr_spi2,
+    isr_rtc2,
+    isr_i2s,
+    isr_fpu,
+    isr_usbd,
+    isr_uart1,
+    isr_qspi,
+    isr_cryptocell,
+    isr_reserved8,
+    isr_reserved9,
+    isr_pwm3,
+    isr_reserved10,
+    isr_spi3,
 };
@@ -46,6 +46,8 @@ struct nrf5_gpio_t {
 };
 
 #define NRF5_GPIO_PIN_CNF_DIR_OUTPUT                   BIT(0)
+#define NRF5_GPIO_PIN_CNF_PULL_PULLUP                  (3 << 2)
+#define NRF5_GPIO_PIN_CNF_DRIVE_S0D1                   (6 << 8)
 
 /* 49. UART. */
 struct nrf5_uart_t {
@@ -96,13 +98,302 @@ struct nrf5_uart_t {
 /* . */
 #define NRF5_UART_            BIT(0)
 
+/* 50. UARTE - Universal asynchronous receiver/transmitter with
+   EasyDMA. */
+struct nrf5_uarte_t {
+    struct {
+        uint32_t STARTRX;
+        uint32_t STOPRX;
+        uint32_t STARTTX;
+        uint32_t STOPTX;
+        uint32_t RESERVED0[7];
+        uint32_t FLUSHRX;
+    } TASKS;
+    uint32_t RESERVED0[52];
+    struct {
+        uint32_t CTS;
+        uint32_t NCTS;
+        uint32_t RXDRDY;
+        uint32_t RESERVED0;
+        uint32_t ENDRX;
+        uint32_t RESERVED1[2];
+        uint32_t TXDRDY;
+        uint32_t ENDTX;
+        uint32_t ERROR;
+        uint32_t RESERVED2[7];
+        uint32_t RXTO;
+        uint32_t RESERVED3;
+        uint32_t RXSTARTED;
+        uint32_t TXSTARTED;
+        uint32_t RESERVED4;
+        uint32_t TXSTOPPED;
+    } EVENTS;
+    uint32_t RESERVED1[41];
+    uint32_t SHORTS;
+    uint32_t RESERVED2[63];
+    uint32_t INTEN;
+    uint32_t INTENSET;
+    uint32_t INTENCLR;
+    uint32_t RESERVED3[93];
+    uint32_t ERRORSRC;
+    uint32_t RESERVED4[31];
+    uint32_t ENABLE;
+    uint32_t RESERVED5;
+    struct {
+        uint32_t RTS;
+        uint32_t TXD;
+        uint32_t CTS;
+        uint32_t RXD;
+    } PSEL;
+    uint32_t RESERVED6[3];
+    uint32_t BAUDRATE;
+    uint32_t RESERVED7[3];
+    struct {
+        uint32_t PTR;
+        uint32_t MAXCNT;
+        uint32_t AMOUNT;
+    } RXD;
+    uint32_t RESERVED8;
+    struct {
+        uint32_t PTR;
+        uint32_t MAXCNT;
+        uint32_t AMOUNT;
+    } TXD;
+    uint32_t RESERVED9[7];
+    uint32_t CONFIG;
+};
+
+/* Shortcuts. */
+#define NRF5_UARTE_SHORTS_ENDRX_STARTRX                BIT(5)
+#define NRF5_UARTE_SHORTS_ENDRX_STOPRX                 BIT(6)
+
+/* Interrupts. */
+#define NRF5_UARTE_INT_ENDRX                           BIT(4)
+#define NRF5_UARTE_INT_ENDTX                           BIT(8)
+#define NRF5_UARTE_INT_ERROR                           BIT(9)
+#define NRF5_UARTE_INT_RXSTARTED                       BIT(19)
+
+/* Enable. */
+#define NRF5_UARTE_ENABLE_DISABLED                     0
+#define NRF5_UARTE_ENABLE_ENABLED                      8
+
+/* Baudrate. */
+#define NRF5_UARTE_BAUDRATE_9600                       0x00275000
+#define NRF5_UARTE_BAUDRATE_19200                      0x004ea000
+#define NRF5_UARTE_BAUDRATE_38400                      0x009d0000
+#define NRF5_UARTE_BAUDRATE_57600                      0x00eb0000
+#define NRF5_UARTE_BAUDRATE_115200                     0x01d60000
+#define NRF5_UARTE_BAUDRATE_230400                     0x03b00000
+#define NRF5_UARTE_BAUDRATE_460800                     0x07400000
+#define NRF5_UARTE_BAUDRATE_921600                     0x0f000000
+#define NRF5_UARTE_BAUDRATE_1000000                    0x10000000
+
+/* 31. SPIM - Serial peripheral interface master with EasyDMA. */
+struct nrf5_spim_t {
+    struct {
+        uint32_t RESERVED0[4];
+        uint32_t START;
+        uint32_t STOP;
+        uint32_t RESERVED1;
+        uint32_t SUSPEND;
+        uint32_t RESUME;
+    } TASKS;
+    uint32_t RESERVED0[55];
+    struct {
+        uint32_t RESERVED0;
+        uint32_t STOPPED;
+        uint32_t RESERVED1[2];
+        uint32_t ENDRX;
+        uint32_t RESERVED2;
+        uint32_t END;
+        uint32_t RESERVED3;
+        uint32_t ENDTX;
+        uint32_t RESERVED4[10];
+        uint32_t STARTED;
+    } EVENTS;
+    uint32_t RESERVED1[44];
+    uint32_t SHORTS;
+    uint32_t RESERVED2[64];
+    uint32_t INTENSET;
+    uint32_t INTENCLR;
+    uint32_t RESERVED3[125];
+    uint32_t ENABLE;
+    uint32_t RESERVED4;
+    struct {
+        uint32_t SCK;
+        uint32_t MOSI;
+        uint32_t MISO;
+        uint32_t CSN;
+    } PSEL;
+    uint32_t RESERVED5[3];
+    uint32_t FREQUENCY;
+    uint32_t RESERVED6[3];
+    struct {
+        uint32_t PTR;
+        uint32_t MAXCNT;
+        uint32_t AMOUNT;
+        uint32_t LIST;
+    } RXD;
+    struct {
+        uint32_t PTR;
+        uint32_t MAXCNT;
+        uint32_t AMOUNT;
+        uint32_t LIST;
+    } TXD;
+    uint32_t CONFIG;
+    uint32_t RESERVED7[26];
+    uint32_t ORC;
+};
+
+/* Shortcuts. */
+#define NRF5_SPIM_SHORTS_END_START                     BIT(17)
+
+/* Interrupts. */
+#define NRF5_SPIM_INT_END                              BIT(6)
+
+/* Enable. */
+#define NRF5_SPIM_ENABLE_DISABLED                      0
+#define NRF5_SPIM_ENABLE_ENABLED                       7
+
+/* Frequency. */
+#define NRF5_SPIM_FREQUENCY_K125                       0x02000000
+#define NRF5_SPIM_FREQUENCY_K250                       0x04000000
+#define NRF5_SPIM_FREQUENCY_K500                       0x08000000
+#define NRF5_SPIM_FREQUENCY_M1                         0x10000000
+#define NRF5_SPIM_FREQUENCY_M2                         0x20000000
+#define NRF5_SPIM_FREQUENCY_M4                         0x40000000
+#define NRF5_SPIM_FREQUENCY_M8                         0x80000000
+
+/* Configuration. */
+#define NRF5_SPIM_CONFIG_ORDER_LSBFIRST                BIT(0)
+#define NRF5_SPIM_CONFIG_CPHA                          BIT(1)
+#define NRF5_SPIM_CONFIG_CPOL                          BIT(2)
+
+/* 33. TWIM - I2C compatible two-wire interface master with
+   EasyDMA. */
+struct nrf5_twim_t {
+    struct {
+        uint32_t STARTRX;
+        uint32_t RESERVED0;
+        uint32_t STARTTX;
+        uint32_t RESERVED1[2];
+        uint32_t STOP;
+        uint32_t RESERVED2;
+        uint32_t SUSPEND;
+        uint32_t RESUME;
+    } TASKS;
+    uint32_t RESERVED0[56];
+    struct {
+        uint32_t STOPPED;
+        uint32_t RESERVED0[7];
+        uint32_t ERROR;
+        uint32_t RESERVED1[8];
+        uint32_t SUSPENDED;
+        uint32_t RXSTARTED;
+        uint32_t TXSTARTED;
+        uint32_t RESERVED2[2];
+        uint32_t LASTRX;
+        uint32_t LASTTX;
+    } EVENTS;
+    uint32_t RESERVED1[39];
+    uint32_t SHORTS;
+    uint32_t RESERVED2[63];
+    uint32_t INTEN;
+    uint32_t INTENSET;
+    uint32_t INTENCLR;
+    uint32_t RESERVED3[110];
+    uint32_t ERRORSRC;
+    uint32_t RESERVED4[14];
+    uint32_t ENABLE;
+    uint32_t RESERVED5;
+    struct {
+        uint32_t SCL;
+        uint32_t SDA;
+    } PSEL;
+    uint32_t RESERVED6[5];
+    uint32_t FREQUENCY;
+    uint32_t RESERVED7[3];
+    struct {
+        uint32_t PTR;
+        uint32_t MAXCNT;
+        uint32_t AMOUNT;
+        uint32_t LIST;
+    } RXD;
+    struct {
+        uint32_t PTR;
+        uint32_t MAXCNT;
+        uint32_t AMOUNT;
+        uint32_t LIST;
+    } TXD;
+    uint32_t RESERVED8[13];
+    uint32_t ADDRESS;
+};
+
+/* Shortcuts. */
+#define NRF5_TWIM_SHORTS_LASTTX_STARTRX                BIT(7)
+#define NRF5_TWIM_SHORTS_LASTTX_SUSPEND                BIT(8)
+#define NRF5_TWIM_SHORTS_LASTTX_STOP                   BIT(9)
+#define NRF5_TWIM_SHORTS_LASTRX_STARTTX                BIT(10)
+#define NRF5_TWIM_SHORTS_LASTRX_STOP                   BIT(12)
+
+/* Interrupts. */
+#define NRF5_TWIM_INT_STOPPED                          BIT(1)
+#define NRF5_TWIM_INT_ERROR                            BIT(9)
+
+/* Error source. */
+#define NRF5_TWIM_ERRORSRC_OVERRUN                     BIT(0)
+#define NRF5_TWIM_ERRORSRC_ANACK                       BIT(1)
+#define NRF5_TWIM_ERRORSRC_DNACK                       BIT(2)
+
+/* Enable. */
+#define NRF5_TWIM_ENABLE_DISABLED                      0
+#define NRF5_TWIM_ENABLE_ENABLED                       6
+
+/* Frequency. */
+#define NRF5_TWIM_FREQUENCY_K100                       0x01980000
+#define NRF5_TWIM_FREQUENCY_K250                       0x04000000
+#define NRF5_TWIM_FREQUENCY_K400                       0x06400000
+
+/* 21. PPI - Programmable peripheral interconnect. */
+struct nrf5_ppi_t {
+    struct {
+        uint32_t EN;
+        uint32_t DIS;
+    } TASKS_CHG[6];
+    uint32_t RESERVED0[308];
+    uint32_t CHEN;
+    uint32_t CHENSET;
+    uint32_t CHENCLR;
+    uint32_t RESERVED1;
+    struct {
+        uint32_t EEP;
+        uint32_t TEP;
+    } CH[20];
+    uint32_t RESERVED2[148];
+    uint32_t CHG[6];
+    uint32_t RESERVED3[62];
+    struct {
+        uint32_t TEP;
+    } FORK[32];
+};
+
+/* Number of PPI channels programmable by the user. */
+#define NRF5_PPI_CHANNEL_MAX                           20
+
+/* EasyDMA can only access data RAM. */
+#define NRF5_IS_RAM(buf_p)                                      \
+    ((((uint32_t)(uintptr_t)(buf_p)) & 0xe0000000u) == 0x20000000u)
+
+/* Maximum number of bytes in one EasyDMA transfer. */
+#define NRF5_EASYDMA_MAXCNT_MAX                        0xffff
+
 /* Base addresses of peripherals. */
 #define NRF5_CLOCK           ((volatile struct nrf5__t *)0x40000000u)
 #define NRF5_POWER           ((volatile struct nrf5__t *)0x40000000u)
 #define NRF5_RADIO           ((volatile struct nrf5__t *)0x40001000u)
 #define NRF5_UART0       ((volatile struct nrf5_uart_t *)0x40002000u)
-#define NRF5_UARTE0          ((volatile struct nrf5__t *)0x40002000u)
-#define NRF5_TWIM0           ((volatile struct nrf5__t *)0x40003000u)
+#define NRF5_UARTE0          ((volatile struct nrf5_uarte_t *)0x40002000u)
+#define NRF5_TWIM0           ((volatile struct nrf5_twim_t *)0x40003000u)
 #define NRF5_TWIS0           ((volatile struct nrf5__t *)0x40003000u)
 #define NRF5_SPIS0           ((volatile struct nrf5__t *)0x40003000u)
 #define NRF5_SPI0            ((volatile struct nrf5__t *)0x40003000u)
@@ -149,20 +440,20 @@ struct nrf5_uart_t {
 #define NRF5_PDM             ((volatile struct nrf5__t *)0x4001d000u)
 #define NRF5_ACL             ((volatile struct nrf5__t *)0x4001e000u)
 #define NRF5_NVMC            ((volatile struct nrf5__t *)0x4001e000u)
-#define NRF5_PPI             ((volatile struct nrf5__t *)0x4001f000u)
+#define NRF5_PPI             ((volatile struct nrf5_ppi_t *)0x4001f000u)
 #define NRF5_MWU             ((volatile struct nrf5__t *)0x40020000u)
 #define NRF5_PWM1            ((volatile struct nrf5__t *)0x40021000u)
 #define NRF5_PWM2            ((volatile struct nrf5__t *)0x40022000u)
 #define NRF5_SPIS2           ((volatile struct nrf5__t *)0x40023000u)
-#define NRF5_SPIM2           ((volatile struct nrf5__t *)0x40023000u)
+#define NRF5_SPIM2           ((volatile struct nrf5_spim_t *)0x40023000u)
 #define NRF5_SPI2            ((volatile struct nrf5__t *)0x40023000u)
 #define NRF5_RTC2            ((volatile struct nrf5__t *)0x40024000u)
 #define NRF5_I2S             ((volatile struct nrf5__t *)0x40025000u)
 #define NRF5_FPU             ((volatile struct nrf5__t *)0x40026000u)
 #define NRF5_USBD            ((volatile struct nrf5__t *)0x40027000u)
-#define NRF5_UARTE1          ((volatile struct nrf5__t *)0x40028000u)
+#define NRF5_UARTE1          ((volatile struct nrf5_uarte_t *)0x40028000u)
 #define NRF5_QSPI            ((volatile struct nrf5__t *)0x40029000u)
-#define NRF5_SPIM3           ((volatile struct nrf5__t *)0x4002b000u)
+#define NRF5_SPIM3           ((volatile struct nrf5_spim_t *)0x4002f000u)
 #define NRF5_PWM3            ((volatile struct nrf5__t *)0x4002d000u)
 #define NRF5_GPIO_P0     ((volatile struct nrf5_gpio_t *)0x50000000u)
 #define NRF5_GPIO_P1     ((volatile struct nrf5_gpio_t *)0x50000300u)
@@ -170,8 +461,35 @@ struct nrf5_uart_t {
 #define NRF5_FICR            ((volatile struct nrf5__t *)0x10000000u)
 #define NRF5_UICR            ((volatile struct nrf5__t *)0x10001000u)
 
+/* The peripheral id is also its interrupt number. */
+#define NRF5_PERIPHERAL_ID(regs_p)                              \
+    ((((uint32_t)(uintptr_t)(regs_p)) >> 12) & 0x3f)
+
 /* Interrupt service routine. */
 #define ISR(vector)                             \
     void isr_ ## vector(void)
 
+/**
+ * Connect given event register to given task register with given PPI
+ * channel. The task is then triggered by the hardware on the event,
+ * without waking the CPU, for example a TIMER compare event starting
+ * a SPIM transfer.
+ */
+static inline void nrf5_ppi_connect(int channel,
+                                    volatile uint32_t *event_p,
+                                    volatile uint32_t *task_p)
+{
+    NRF5_PPI->CH[channel].EEP = (uint32_t)(uintptr_t)event_p;
+    NRF5_PPI->CH[channel].TEP = (uint32_t)(uintptr_t)task_p;
+    NRF5_PPI->CHENSET = (1u << channel);
+}
+
+/**
+ * Disable given PPI channel.
+ */
+static inline void nrf5_ppi_disconnect(int channel)
+{
+    NRF5_PPI->CHENCLR = (1u << channel);
+}
+
 #endif
@@ -153,6 +153,10 @@ struct spi_device_t spi_device[SPI_DEVICE_MAX] = {
             .is_locked = 0,
             .waiters = {
                 .head_p = NULL }
+        },
+        .transactions = {
+            .head_p = NULL,
+            .tail_p = NULL
         }
     }
 };
@@ -425,6 +429,23 @@ struct dac_device_t dac_device[DAC_DEVICE_MAX] = {
     }
 };
 
+struct dma_device_t dma_device[DMA_DEVICE_MAX] = {
+    {
+        .regs_p = SAM_DMAC,
+        .id = PERIPHERAL_ID_DMAC,
+        .channels = { NULL, NULL, NULL, NULL, NULL, NULL }
+    }
+};
+
+struct sd_device_t sd_device[SD_DEVICE_MAX] = {
+    {
+        .regs_p = SAM_HSMCI,
+        .id = PERIPHERAL_ID_HSMCI,
+        .pio_p = SAM_PIOA,
+        .dma_request = 0
+    }
+};
+
 struct usb_device_t usb_device[USB_DEVICE_MAX] = {
     {
         .drv_p = NULL,
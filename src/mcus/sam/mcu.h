@@ -45,10 +45,12 @@
 #    define PWM_DEVICE_MAX              12
 #    define ADC_DEVICE_MAX               1
 #    define DAC_DEVICE_MAX               1
+#    define DMA_DEVICE_MAX               1
 #    define FLASH_DEVICE_MAX             1
 #    define CAN_DEVICE_MAX               2
 #    define USB_DEVICE_MAX               1
 #    define I2C_DEVICE_MAX               2
+#    define SD_DEVICE_MAX                1
 #elif defined(MCU_SAMD21G18)
 #    define PIN_DEVICE_MAX              10
 #    define UART_DEVICE_MAX              2
@@ -33,15 +33,19 @@
     static void isr_ ## vector ## _wrapper(void)                \
     {                                                           \
         uint32_t start;                                         \
+        ISR_STATS_BEGIN_ISR(stats, #vector);                    \
         start = SAM_TC0->CHANNEL[0].CV;                         \
         isr_ ## vector();                                       \
         sys.interrupt.time += (SAM_TC0->CHANNEL[0].CV - start); \
+        ISR_STATS_END_ISR(stats);                               \
     }
 #else
 #    define ISR_WRAPPER(vector)                         \
     static void isr_ ## vector ## _wrapper(void)        \
     {                                                   \
+        ISR_STATS_BEGIN_ISR(stats, #vector);            \
         isr_ ## vector();                               \
+        ISR_STATS_END_ISR(stats);                       \
     }
 #endif
 
@@ -412,8 +412,8 @@ struct sam_dmac_t {
 #define DMAC_CTRLA_DONE                 BIT(31)
 
 /* DMAC Channel x [x = 0..5] Control B Register */
-#define DMAC_CTRLB_SRC_DSCR             (16)
-#define DMAC_CTRLB_DST_DSCR             (20)
+#define DMAC_CTRLB_SRC_DSCR             BIT(16)
+#define DMAC_CTRLB_DST_DSCR             BIT(20)
 #define DMAC_CTRLB_FC_POS               (21)
 #define DMAC_CTRLB_FC_MASK              (0x7 << DMAC_CTRLB_FC_POS)
 #define DMAC_CTRLB_FC(value)            BITFIELD_SET(DMAC_CTRLB_FC, (value))
@@ -1698,6 +1698,131 @@ struct sam_hsmci_t {
     uint32_t FIFO[256];
 };
 
+/* Control Register. */
+#define SAM_HSMCI_CR_MCIEN              BIT(0)
+#define SAM_HSMCI_CR_MCIDIS             BIT(1)
+#define SAM_HSMCI_CR_PWSEN              BIT(2)
+#define SAM_HSMCI_CR_PWSDIS             BIT(3)
+#define SAM_HSMCI_CR_SWRST              BIT(7)
+
+/* Mode Register. */
+#define SAM_HSMCI_MR_CLKDIV_POS         (0)
+#define SAM_HSMCI_MR_CLKDIV_MASK        (0xff << SAM_HSMCI_MR_CLKDIV_POS)
+#define SAM_HSMCI_MR_CLKDIV(value)      BITFIELD_SET(SAM_HSMCI_MR_CLKDIV, value)
+#define SAM_HSMCI_MR_PWSDIV_POS         (8)
+#define SAM_HSMCI_MR_PWSDIV_MASK        (0x7 << SAM_HSMCI_MR_PWSDIV_POS)
+#define SAM_HSMCI_MR_PWSDIV(value)      BITFIELD_SET(SAM_HSMCI_MR_PWSDIV, value)
+#define SAM_HSMCI_MR_RDPROOF            BIT(11)
+#define SAM_HSMCI_MR_WRPROOF            BIT(12)
+#define SAM_HSMCI_MR_FBYTE              BIT(13)
+#define SAM_HSMCI_MR_PADV               BIT(14)
+
+/* Data Timeout Register. */
+#define SAM_HSMCI_DTOR_DTOCYC_POS       (0)
+#define SAM_HSMCI_DTOR_DTOCYC_MASK      (0xf << SAM_HSMCI_DTOR_DTOCYC_POS)
+#define SAM_HSMCI_DTOR_DTOCYC(value)    BITFIELD_SET(SAM_HSMCI_DTOR_DTOCYC, value)
+#define SAM_HSMCI_DTOR_DTOMUL_POS       (4)
+#define SAM_HSMCI_DTOR_DTOMUL_MASK      (0x7 << SAM_HSMCI_DTOR_DTOMUL_POS)
+#define SAM_HSMCI_DTOR_DTOMUL(value)    BITFIELD_SET(SAM_HSMCI_DTOR_DTOMUL, value)
+
+/* SD/SDIO Card Register. */
+#define SAM_HSMCI_SDCR_SDCSEL_POS       (0)
+#define SAM_HSMCI_SDCR_SDCSEL_MASK      (0x3 << SAM_HSMCI_SDCR_SDCSEL_POS)
+#define SAM_HSMCI_SDCR_SDCSEL(value)    BITFIELD_SET(SAM_HSMCI_SDCR_SDCSEL, value)
+#define SAM_HSMCI_SDCR_SDCBUS_POS       (6)
+#define SAM_HSMCI_SDCR_SDCBUS_MASK      (0x3 << SAM_HSMCI_SDCR_SDCBUS_POS)
+#define SAM_HSMCI_SDCR_SDCBUS(value)    BITFIELD_SET(SAM_HSMCI_SDCR_SDCBUS, value)
+#define SAM_HSMCI_SDCR_SDCBUS_1         SAM_HSMCI_SDCR_SDCBUS(0)
+#define SAM_HSMCI_SDCR_SDCBUS_4         SAM_HSMCI_SDCR_SDCBUS(2)
+#define SAM_HSMCI_SDCR_SDCBUS_8         SAM_HSMCI_SDCR_SDCBUS(3)
+
+/* Command Register. */
+#define SAM_HSMCI_CMDR_CMDNB_POS        (0)
+#define SAM_HSMCI_CMDR_CMDNB_MASK       (0x3f << SAM_HSMCI_CMDR_CMDNB_POS)
+#define SAM_HSMCI_CMDR_CMDNB(value)     BITFIELD_SET(SAM_HSMCI_CMDR_CMDNB, value)
+#define SAM_HSMCI_CMDR_RSPTYP_POS       (6)
+#define SAM_HSMCI_CMDR_RSPTYP_MASK      (0x3 << SAM_HSMCI_CMDR_RSPTYP_POS)
+#define SAM_HSMCI_CMDR_RSPTYP(value)    BITFIELD_SET(SAM_HSMCI_CMDR_RSPTYP, value)
+#define SAM_HSMCI_CMDR_RSPTYP_NORESP    SAM_HSMCI_CMDR_RSPTYP(0)
+#define SAM_HSMCI_CMDR_RSPTYP_48_BIT    SAM_HSMCI_CMDR_RSPTYP(1)
+#define SAM_HSMCI_CMDR_RSPTYP_136_BIT   SAM_HSMCI_CMDR_RSPTYP(2)
+#define SAM_HSMCI_CMDR_RSPTYP_R1B       SAM_HSMCI_CMDR_RSPTYP(3)
+#define SAM_HSMCI_CMDR_SPCMD_POS        (8)
+#define SAM_HSMCI_CMDR_SPCMD_MASK       (0x7 << SAM_HSMCI_CMDR_SPCMD_POS)
+#define SAM_HSMCI_CMDR_SPCMD(value)     BITFIELD_SET(SAM_HSMCI_CMDR_SPCMD, value)
+#define SAM_HSMCI_CMDR_SPCMD_STD        SAM_HSMCI_CMDR_SPCMD(0)
+#define SAM_HSMCI_CMDR_SPCMD_INIT       SAM_HSMCI_CMDR_SPCMD(1)
+#define SAM_HSMCI_CMDR_OPDCMD           BIT(11)
+#define SAM_HSMCI_CMDR_MAXLAT           BIT(12)
+#define SAM_HSMCI_CMDR_TRCMD_POS        (16)
+#define SAM_HSMCI_CMDR_TRCMD_MASK       (0x3 << SAM_HSMCI_CMDR_TRCMD_POS)
+#define SAM_HSMCI_CMDR_TRCMD(value)     BITFIELD_SET(SAM_HSMCI_CMDR_TRCMD, value)
+#define SAM_HSMCI_CMDR_TRCMD_NO_DATA    SAM_HSMCI_CMDR_TRCMD(0)
+#define SAM_HSMCI_CMDR_TRCMD_START_DATA SAM_HSMCI_CMDR_TRCMD(1)
+#define SAM_HSMCI_CMDR_TRCMD_STOP_DATA  SAM_HSMCI_CMDR_TRCMD(2)
+#define SAM_HSMCI_CMDR_TRDIR            BIT(18)
+#define SAM_HSMCI_CMDR_TRTYP_POS        (19)
+#define SAM_HSMCI_CMDR_TRTYP_MASK       (0x7 << SAM_HSMCI_CMDR_TRTYP_POS)
+#define SAM_HSMCI_CMDR_TRTYP(value)     BITFIELD_SET(SAM_HSMCI_CMDR_TRTYP, value)
+#define SAM_HSMCI_CMDR_TRTYP_SINGLE     SAM_HSMCI_CMDR_TRTYP(0)
+#define SAM_HSMCI_CMDR_TRTYP_MULTIPLE   SAM_HSMCI_CMDR_TRTYP(1)
+
+/* Block Register. */
+#define SAM_HSMCI_BLKR_BCNT_POS         (0)
+#define SAM_HSMCI_BLKR_BCNT_MASK        (0xffff << SAM_HSMCI_BLKR_BCNT_POS)
+#define SAM_HSMCI_BLKR_BCNT(value)      BITFIELD_SET(SAM_HSMCI_BLKR_BCNT, value)
+#define SAM_HSMCI_BLKR_BLKLEN_POS       (16)
+#define SAM_HSMCI_BLKR_BLKLEN_MASK      (0xffff << SAM_HSMCI_BLKR_BLKLEN_POS)
+#define SAM_HSMCI_BLKR_BLKLEN(value)    BITFIELD_SET(SAM_HSMCI_BLKR_BLKLEN, value)
+
+/* Completion Signal Timeout Register. */
+#define SAM_HSMCI_CSTOR_CSTOCYC_POS     (0)
+#define SAM_HSMCI_CSTOR_CSTOCYC_MASK    (0xf << SAM_HSMCI_CSTOR_CSTOCYC_POS)
+#define SAM_HSMCI_CSTOR_CSTOCYC(value)  BITFIELD_SET(SAM_HSMCI_CSTOR_CSTOCYC, value)
+#define SAM_HSMCI_CSTOR_CSTOMUL_POS     (4)
+#define SAM_HSMCI_CSTOR_CSTOMUL_MASK    (0x7 << SAM_HSMCI_CSTOR_CSTOMUL_POS)
+#define SAM_HSMCI_CSTOR_CSTOMUL(value)  BITFIELD_SET(SAM_HSMCI_CSTOR_CSTOMUL, value)
+
+/* Status Register. */
+#define SAM_HSMCI_SR_CMDRDY             BIT(0)
+#define SAM_HSMCI_SR_RXRDY              BIT(1)
+#define SAM_HSMCI_SR_TXRDY              BIT(2)
+#define SAM_HSMCI_SR_BLKE               BIT(3)
+#define SAM_HSMCI_SR_DTIP               BIT(4)
+#define SAM_HSMCI_SR_NOTBUSY            BIT(5)
+#define SAM_HSMCI_SR_RINDE              BIT(16)
+#define SAM_HSMCI_SR_RDIRE              BIT(17)
+#define SAM_HSMCI_SR_RCRCE              BIT(18)
+#define SAM_HSMCI_SR_RENDE              BIT(19)
+#define SAM_HSMCI_SR_RTOE               BIT(20)
+#define SAM_HSMCI_SR_DCRCE              BIT(21)
+#define SAM_HSMCI_SR_DTOE               BIT(22)
+#define SAM_HSMCI_SR_CSTOE              BIT(23)
+#define SAM_HSMCI_SR_BLKOVRE            BIT(24)
+#define SAM_HSMCI_SR_DMADONE            BIT(25)
+#define SAM_HSMCI_SR_FIFOEMPTY          BIT(26)
+#define SAM_HSMCI_SR_XFRDONE            BIT(27)
+#define SAM_HSMCI_SR_ACKRCV             BIT(28)
+#define SAM_HSMCI_SR_ACKRCVE            BIT(29)
+#define SAM_HSMCI_SR_OVRE               BIT(30)
+#define SAM_HSMCI_SR_UNRE               BIT(31)
+
+/* DMA Configuration Register. */
+#define SAM_HSMCI_DMA_OFFSET_POS        (0)
+#define SAM_HSMCI_DMA_OFFSET_MASK       (0x3 << SAM_HSMCI_DMA_OFFSET_POS)
+#define SAM_HSMCI_DMA_OFFSET(value)     BITFIELD_SET(SAM_HSMCI_DMA_OFFSET, value)
+#define SAM_HSMCI_DMA_CHKSIZE_POS       (4)
+#define SAM_HSMCI_DMA_CHKSIZE_MASK      (0x3 << SAM_HSMCI_DMA_CHKSIZE_POS)
+#define SAM_HSMCI_DMA_CHKSIZE(value)    BITFIELD_SET(SAM_HSMCI_DMA_CHKSIZE, value)
+#define SAM_HSMCI_DMA_DMAEN             BIT(8)
+#define SAM_HSMCI_DMA_ROPT              BIT(12)
+
+/* Configuration Register. */
+#define SAM_HSMCI_CFG_FIFOMODE          BIT(0)
+#define SAM_HSMCI_CFG_FERRCTRL          BIT(4)
+#define SAM_HSMCI_CFG_HSMODE            BIT(8)
+#define SAM_HSMCI_CFG_LSYNC             BIT(12)
+
 /* 39. Universal Synchrounous Asynchronous Receiver Tranceiver. */
 struct sam_uotghs_t {
 
@@ -2494,6 +2619,172 @@ struct sam_can_t {
 #define CAN_MCR_MACR                    BIT(22)
 #define CAN_MCR_MTCR                    BIT(23)
 
+/* 41. Ethernet MAC 10/100. */
+struct sam_emac_t {
+    uint32_t NCR;
+    uint32_t NCFGR;
+    uint32_t NSR;
+    uint32_t RESERVED0[2];
+    uint32_t TSR;
+    uint32_t RBQP;
+    uint32_t TBQP;
+    uint32_t RSR;
+    uint32_t ISR;
+    uint32_t IER;
+    uint32_t IDR;
+    uint32_t IMR;
+    uint32_t MAN;
+    uint32_t PTR;
+    uint32_t PFR;
+    uint32_t FTO;
+    uint32_t SCF;
+    uint32_t MCF;
+    uint32_t FRO;
+    uint32_t FCSE;
+    uint32_t ALE;
+    uint32_t DTF;
+    uint32_t LCOL;
+    uint32_t ECOL;
+    uint32_t TUND;
+    uint32_t CSE;
+    uint32_t RRE;
+    uint32_t ROV;
+    uint32_t RSE;
+    uint32_t ELE;
+    uint32_t RJA;
+    uint32_t USF;
+    uint32_t STE;
+    uint32_t RLE;
+    uint32_t RESERVED1;
+    uint32_t HRB;
+    uint32_t HRT;
+    struct {
+        uint32_t B;
+        uint32_t T;
+    } SA[4];
+    uint32_t TID;
+    uint32_t RESERVED2;
+    uint32_t USRIO;
+};
+
+/* Network control register. */
+#define SAM_EMAC_NCR_LB                 BIT(0)
+#define SAM_EMAC_NCR_LLB                BIT(1)
+#define SAM_EMAC_NCR_RE                 BIT(2)
+#define SAM_EMAC_NCR_TE                 BIT(3)
+#define SAM_EMAC_NCR_MPE                BIT(4)
+#define SAM_EMAC_NCR_CLRSTAT            BIT(5)
+#define SAM_EMAC_NCR_INCSTAT            BIT(6)
+#define SAM_EMAC_NCR_WESTAT             BIT(7)
+#define SAM_EMAC_NCR_BP                 BIT(8)
+#define SAM_EMAC_NCR_TSTART             BIT(9)
+#define SAM_EMAC_NCR_THALT              BIT(10)
+
+/* Network configuration register. */
+#define SAM_EMAC_NCFGR_SPD              BIT(0)
+#define SAM_EMAC_NCFGR_FD               BIT(1)
+#define SAM_EMAC_NCFGR_JFRAME           BIT(3)
+#define SAM_EMAC_NCFGR_CAF              BIT(4)
+#define SAM_EMAC_NCFGR_NBC              BIT(5)
+#define SAM_EMAC_NCFGR_MTI              BIT(6)
+#define SAM_EMAC_NCFGR_UNI              BIT(7)
+#define SAM_EMAC_NCFGR_BIG              BIT(8)
+#define SAM_EMAC_NCFGR_CLK_POS          (10)
+#define SAM_EMAC_NCFGR_CLK_MASK         (0x3 << SAM_EMAC_NCFGR_CLK_POS)
+#define SAM_EMAC_NCFGR_CLK(value)       BITFIELD_SET(SAM_EMAC_NCFGR_CLK, value)
+#define SAM_EMAC_NCFGR_CLK_MCK_8        SAM_EMAC_NCFGR_CLK(0)
+#define SAM_EMAC_NCFGR_CLK_MCK_16       SAM_EMAC_NCFGR_CLK(1)
+#define SAM_EMAC_NCFGR_CLK_MCK_32       SAM_EMAC_NCFGR_CLK(2)
+#define SAM_EMAC_NCFGR_CLK_MCK_64       SAM_EMAC_NCFGR_CLK(3)
+#define SAM_EMAC_NCFGR_RTY              BIT(12)
+#define SAM_EMAC_NCFGR_PAE              BIT(13)
+#define SAM_EMAC_NCFGR_RBOF_POS         (14)
+#define SAM_EMAC_NCFGR_RBOF_MASK        (0x3 << SAM_EMAC_NCFGR_RBOF_POS)
+#define SAM_EMAC_NCFGR_RBOF(value)      BITFIELD_SET(SAM_EMAC_NCFGR_RBOF, value)
+#define SAM_EMAC_NCFGR_RLCE             BIT(16)
+#define SAM_EMAC_NCFGR_DRFCS            BIT(17)
+#define SAM_EMAC_NCFGR_EFRHD            BIT(18)
+#define SAM_EMAC_NCFGR_IRXFCS           BIT(19)
+
+/* Network status register. */
+#define SAM_EMAC_NSR_MDIO               BIT(1)
+#define SAM_EMAC_NSR_IDLE               BIT(2)
+
+/* Transmit status register. */
+#define SAM_EMAC_TSR_UBR                BIT(0)
+#define SAM_EMAC_TSR_COL                BIT(1)
+#define SAM_EMAC_TSR_RLES               BIT(2)
+#define SAM_EMAC_TSR_TGO                BIT(3)
+#define SAM_EMAC_TSR_BEX                BIT(4)
+#define SAM_EMAC_TSR_COMP               BIT(5)
+#define SAM_EMAC_TSR_UND                BIT(6)
+
+/* Receive status register. */
+#define SAM_EMAC_RSR_BNA                BIT(0)
+#define SAM_EMAC_RSR_REC                BIT(1)
+#define SAM_EMAC_RSR_OVR                BIT(2)
+
+/* Interrupt status, enable, disable and mask registers. */
+#define SAM_EMAC_ISR_MFD                BIT(0)
+#define SAM_EMAC_ISR_RCOMP              BIT(1)
+#define SAM_EMAC_ISR_RXUBR              BIT(2)
+#define SAM_EMAC_ISR_TXUBR              BIT(3)
+#define SAM_EMAC_ISR_TUND               BIT(4)
+#define SAM_EMAC_ISR_RLEX               BIT(5)
+#define SAM_EMAC_ISR_TXERR              BIT(6)
+#define SAM_EMAC_ISR_TCOMP              BIT(7)
+#define SAM_EMAC_ISR_ROVR               BIT(10)
+#define SAM_EMAC_ISR_HRESP              BIT(11)
+#define SAM_EMAC_ISR_PFRE               BIT(12)
+#define SAM_EMAC_ISR_PTZ                BIT(13)
+
+/* Phy maintenance register. */
+#define SAM_EMAC_MAN_DATA_POS           (0)
+#define SAM_EMAC_MAN_DATA_MASK          (0xffff << SAM_EMAC_MAN_DATA_POS)
+#define SAM_EMAC_MAN_DATA(value)        BITFIELD_SET(SAM_EMAC_MAN_DATA, value)
+#define SAM_EMAC_MAN_CODE_POS           (16)
+#define SAM_EMAC_MAN_CODE_MASK          (0x3 << SAM_EMAC_MAN_CODE_POS)
+#define SAM_EMAC_MAN_CODE(value)        BITFIELD_SET(SAM_EMAC_MAN_CODE, value)
+#define SAM_EMAC_MAN_REGA_POS           (18)
+#define SAM_EMAC_MAN_REGA_MASK          (0x1f << SAM_EMAC_MAN_REGA_POS)
+#define SAM_EMAC_MAN_REGA(value)        BITFIELD_SET(SAM_EMAC_MAN_REGA, value)
+#define SAM_EMAC_MAN_PHYA_POS           (23)
+#define SAM_EMAC_MAN_PHYA_MASK          (0x1f << SAM_EMAC_MAN_PHYA_POS)
+#define SAM_EMAC_MAN_PHYA(value)        BITFIELD_SET(SAM_EMAC_MAN_PHYA, value)
+#define SAM_EMAC_MAN_RW_POS             (28)
+#define SAM_EMAC_MAN_RW_MASK            (0x3 << SAM_EMAC_MAN_RW_POS)
+#define SAM_EMAC_MAN_RW(value)          BITFIELD_SET(SAM_EMAC_MAN_RW, value)
+#define SAM_EMAC_MAN_RW_WRITE           SAM_EMAC_MAN_RW(1)
+#define SAM_EMAC_MAN_RW_READ            SAM_EMAC_MAN_RW(2)
+#define SAM_EMAC_MAN_SOF_POS            (30)
+#define SAM_EMAC_MAN_SOF_MASK           (0x3 << SAM_EMAC_MAN_SOF_POS)
+#define SAM_EMAC_MAN_SOF(value)         BITFIELD_SET(SAM_EMAC_MAN_SOF, value)
+
+/* User input/output register. */
+#define SAM_EMAC_USRIO_RMII             BIT(0)
+#define SAM_EMAC_USRIO_CLKEN            BIT(1)
+
+/* Receive buffer descriptor. */
+#define SAM_EMAC_RX_ADDRESS_OWNERSHIP   BIT(0)
+#define SAM_EMAC_RX_ADDRESS_WRAP        BIT(1)
+#define SAM_EMAC_RX_ADDRESS_MASK        (0xfffffffc)
+#define SAM_EMAC_RX_STATUS_LENGTH_MASK  (0xfff)
+#define SAM_EMAC_RX_STATUS_SOF          BIT(14)
+#define SAM_EMAC_RX_STATUS_EOF          BIT(15)
+
+/* Size of the receive buffers. */
+#define SAM_EMAC_RX_BUFFER_SIZE         128
+
+/* Transmit buffer descriptor. */
+#define SAM_EMAC_TX_STATUS_LENGTH_MASK  (0x7ff)
+#define SAM_EMAC_TX_STATUS_LAST         BIT(15)
+#define SAM_EMAC_TX_STATUS_NO_CRC       BIT(16)
+#define SAM_EMAC_TX_STATUS_EXHAUSTED    BIT(27)
+#define SAM_EMAC_TX_STATUS_UNDERRUN     BIT(28)
+#define SAM_EMAC_TX_STATUS_RETRY        BIT(29)
+#define SAM_EMAC_TX_STATUS_WRAP         BIT(30)
+#define SAM_EMAC_TX_STATUS_USED         BIT(31)
+
 /* 42. True Random Number Generator. */
 struct sam_trng_t {
     uint32_t CR;
@@ -92,7 +92,21 @@ struct pin_device_t pin_device[PIN_DEVICE_MAX] = {
 struct uart_device_t uart_device[UART_DEVICE_MAX] = {
     {
         .drv_p = NULL,
-        .regs_p = STM32_USART1
+        .regs_p = STM32_USART1,
+#if CONFIG_UART_DMA == 1
+        .dma = {
+            .tx_request = 4,
+            .rx_request = 5
+        }
+#endif
+    }
+};
+
+struct dma_device_t dma_device[DMA_DEVICE_MAX] = {
+    {
+        .regs_p = STM32_DMA1,
+        .irq = 11,
+        .channels = { NULL, NULL, NULL, NULL, NULL, NULL, NULL }
     }
 };
 
@@ -37,5 +37,6 @@
 #define I2C_DEVICE_MAX      2
 #define CAN_DEVICE_MAX      1
 #define FLASH_DEVICE_MAX    1
+#define DMA_DEVICE_MAX      1
 
 #endif
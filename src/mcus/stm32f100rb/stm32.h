@@ -55,6 +55,7 @@ struct stm32_usart_t {
 /* Auxiliary Control Register 1 */
 #define STM32_USART_CR1_RE            BIT(2)
 #define STM32_USART_CR1_TE            BIT(3)
+#define STM32_USART_CR1_IDLEIE        BIT(4)
 #define STM32_USART_CR1_RXNEIE        BIT(5)
 #define STM32_USART_CR1_TCIE          BIT(6)
 #define STM32_USART_CR1_TXEIE         BIT(7)
@@ -65,6 +66,12 @@ struct stm32_usart_t {
 /* Auxiliary Control Register 2 */
 #define STM32_USART_CR2_STOP          BIT(12)
 
+/* Auxiliary Control Register 3 */
+#define STM32_USART_CR3_EIE           BIT(0)
+#define STM32_USART_CR3_DMAR          BIT(6)
+#define STM32_USART_CR3_DMAT          BIT(7)
+#define STM32_USART_CR3_CTSE          BIT(9)
+
 struct stm32_rcc_t {
     uint32_t CR;
     uint32_t CFGR;
@@ -103,6 +110,9 @@ struct stm32_rcc_t {
 #define STM32_RCC_CFGR_PLLMUL_3       STM32_RCC_CFGR_PLLMUL(1)
 #define STM32_RCC_CFGR_PLLMUL_6       STM32_RCC_CFGR_PLLMUL(4)
 
+#define STM32_RCC_AHBENR_DMA1EN       BIT(0)
+#define STM32_RCC_AHBENR_CRCEN        BIT(6)
+
 #define STM32_RCC_APB1ENR_PWREN       BIT(28)
 
 struct stm32_pwr_t {
@@ -110,6 +120,47 @@ struct stm32_pwr_t {
     uint32_t CSR;
 };
 
+/* DMA. */
+struct stm32_dma_t {
+    uint32_t ISR;
+    uint32_t IFCR;
+    struct {
+        uint32_t CCR;
+        uint32_t CNDTR;
+        uint32_t CPAR;
+        uint32_t CMAR;
+        uint32_t RESERVED;
+    } CHANNEL[7];
+};
+
+/* Interrupt status and flag clear registers, for given channel
+   index. */
+#define STM32_DMA_ISR_GIF(channel)    BIT(4 * (channel))
+#define STM32_DMA_ISR_TCIF(channel)   BIT(4 * (channel) + 1)
+#define STM32_DMA_ISR_HTIF(channel)   BIT(4 * (channel) + 2)
+#define STM32_DMA_ISR_TEIF(channel)   BIT(4 * (channel) + 3)
+#define STM32_DMA_IFCR_ALL(channel)   (0xf << (4 * (channel)))
+
+/* Channel configuration register. */
+#define STM32_DMA_CCR_EN              BIT(0)
+#define STM32_DMA_CCR_TCIE            BIT(1)
+#define STM32_DMA_CCR_HTIE            BIT(2)
+#define STM32_DMA_CCR_TEIE            BIT(3)
+#define STM32_DMA_CCR_DIR             BIT(4)
+#define STM32_DMA_CCR_CIRC            BIT(5)
+#define STM32_DMA_CCR_PINC            BIT(6)
+#define STM32_DMA_CCR_MINC            BIT(7)
+#define STM32_DMA_CCR_PSIZE_POS       (8)
+#define STM32_DMA_CCR_PSIZE_MASK      (0x3 << STM32_DMA_CCR_PSIZE_POS)
+#define STM32_DMA_CCR_PSIZE(value)    BITFIELD_SET(STM32_DMA_CCR_PSIZE, value)
+#define STM32_DMA_CCR_MSIZE_POS       (10)
+#define STM32_DMA_CCR_MSIZE_MASK      (0x3 << STM32_DMA_CCR_MSIZE_POS)
+#define STM32_DMA_CCR_MSIZE(value)    BITFIELD_SET(STM32_DMA_CCR_MSIZE, value)
+#define STM32_DMA_CCR_PL_POS          (12)
+#define STM32_DMA_CCR_PL_MASK         (0x3 << STM32_DMA_CCR_PL_POS)
+#define STM32_DMA_CCR_PL(value)       BITFIELD_SET(STM32_DMA_CCR_PL, value)
+#define STM32_DMA_CCR_MEM2MEM         BIT(14)
+
 struct stm32_gpio_t {
     uint32_t CRL;
     uint32_t CRH;
@@ -120,6 +171,15 @@ struct stm32_gpio_t {
     uint32_t LCKR;
 };
 
+/* CRC calculation unit. */
+struct stm32_crc_t {
+    uint32_t DR;
+    uint32_t IDR;
+    uint32_t CR;
+};
+
+#define STM32_CRC_CR_RESET            BIT(0)
+
 /* Base addresses of peripherals. */
 #define STM32_PWR               ((volatile struct stm32_pwr_t *)  0x40007000ul)
 #define STM32_GPIOA             ((volatile struct stm32_gpio_t *) 0x40010800ul)
@@ -127,7 +187,9 @@ struct stm32_gpio_t {
 #define STM32_GPIOC             ((volatile struct stm32_gpio_t *) 0x40011000ul)
 #define STM32_GPIOD             ((volatile struct stm32_gpio_t *) 0x40011400ul)
 #define STM32_USART1            ((volatile struct stm32_usart_t *)0x40013800ul)
+#define STM32_DMA1              ((volatile struct stm32_dma_t *)  0x40020000ul)
 #define STM32_RCC               ((volatile struct stm32_rcc_t *)  0x40021000ul)
+#define STM32_CRC               ((volatile struct stm32_crc_t *)  0x40023000ul)
 
 /* Interrupt service routine. */
 #define ISR(vector)                             \
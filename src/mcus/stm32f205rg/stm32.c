@@ -31,7 +31,9 @@
 #define ISR_WRAPPER(vector)                             \
     static void isr_ ## vector ## _wrapper(void)        \
     {                                                   \
+        ISR_STATS_BEGIN_ISR(stats, #vector);            \
         isr_ ## vector();                               \
+        ISR_STATS_END_ISR(stats);                       \
     }
 
 /* Defined in the linker script. */
@@ -121,6 +121,8 @@ struct stm32_rcc_t {
 #define STM32_RCC_CFGR_PLLMUL_3       STM32_RCC_CFGR_PLLMUL(1)
 #define STM32_RCC_CFGR_PLLMUL_6       STM32_RCC_CFGR_PLLMUL(4)
 
+#define STM32_RCC_AHB1ENR_CRCEN       BIT(12)
+
 #define STM32_RCC_APB1ENR_PWREN       BIT(28)
 
 struct stm32_pwr_t {
@@ -167,6 +169,15 @@ struct stm32_sdio_t {
     uint32_t FIFO;
 };
 
+/* CRC calculation unit. */
+struct stm32_crc_t {
+    uint32_t DR;
+    uint32_t IDR;
+    uint32_t CR;
+};
+
+#define STM32_CRC_CR_RESET            BIT(0)
+
 /* Base addresses of peripherals. */
 #define STM32_PWR            ((volatile struct stm32_pwr_t *)  0x40007000ul)
 #define STM32_GPIOA          ((volatile struct stm32_gpio_t *) 0x40020000ul)
@@ -177,6 +188,7 @@ struct stm32_sdio_t {
 #define STM32_SDIO           ((volatile struct stm32_sdio_t *) 0x40012c00ul)
 #define STM32_IWDG           ((volatile struct stm32_iwdg_t *) 0x40003000ul)
 #define STM32_RCC            ((volatile struct stm32_rcc_t *)  0x40023800ul)
+#define STM32_CRC            ((volatile struct stm32_crc_t *)  0x40023000ul)
 
 /* Interrupt service routine. */
 #define ISR(vector)                             \
@@ -45,4 +45,14 @@ MCU_DESC = "ST STM32F303VC ARM Cortex-M4 @ 72MHz, 40k sram, 256k flash"
 LIBPATH += "$(SIMBA_ROOT)/src/mcus/$(MCU)"
 LINKER_SCRIPT ?= script.ld
 
+SIZE_SUMMARY_CMD ?= $(SIMBA_ROOT)/bin/memory_usage.py \
+			--ram-section .fast_relocate \
+			--ram-section .fast_bss \
+			--ram-section .relocate \
+			--ram-section .bss \
+			--ram-section .main_stack \
+			--rom-section .text \
+			--rom-section .nvm.eeprom_soft \
+			${EXE}
+
 include $(SIMBA_ROOT)/make/$(TOOLCHAIN)/arm.mk
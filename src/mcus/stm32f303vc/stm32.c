@@ -40,7 +40,9 @@
 #define ISR_WRAPPER(vector)                             \
     static void isr_ ## vector ## _wrapper(void)        \
     {                                                   \
+        ISR_STATS_BEGIN_ISR(stats, #vector);            \
         isr_ ## vector();                               \
+        ISR_STATS_END_ISR(stats);                       \
     }
 
 /* Defined in the linker script. */
@@ -51,6 +53,10 @@ extern uint32_t __relocate_start__;
 extern uint32_t __relocate_end__;
 extern uint32_t __zero_start__;
 extern uint32_t __zero_end__;
+extern uint32_t __fast_relocate_start__;
+extern uint32_t __fast_relocate_end__;
+extern uint32_t __fast_zero_start__;
+extern uint32_t __fast_zero_end__;
 
 extern struct sys_t sys;
 
@@ -290,8 +296,15 @@ void isr_reset(void)
 
     /* clock_init(); */
 
-    /* Initialize the relocate segment */
+    /* Initialize the core coupled memory relocate segment, stored
+       just before the relocate segment in flash. */
     src_p = &__text_end__;
+
+    for (dst_p = &__fast_relocate_start__; dst_p < &__fast_relocate_end__;) {
+        *dst_p++ = *src_p++;
+    }
+
+    /* Initialize the relocate segment */
     dst_p = &__relocate_start__;
 
     if (src_p != dst_p) {
@@ -305,6 +318,10 @@ void isr_reset(void)
         *dst_p++ = 0;
     }
 
+    for (dst_p = &__fast_zero_start__; dst_p < &__fast_zero_end__;) {
+        *dst_p++ = 0;
+    }
+
     /* Branch to main function */
     main();
 
@@ -36,4 +36,37 @@
 #define I2C_DEVICE_MAX                                      1
 #define FLASH_DEVICE_MAX                                    1
 
+/* Number of cores in the guest, see mcu.dts. */
+#define XVISOR_VIRT_V8_CPU_MAX                              4
+
+/**
+ * Start given function on given secondary core using PSCI. Simba
+ * threads and interrupts only run on core zero(0), so the function
+ * runs with interrupts masked and must not call any kernel
+ * functions. Exchange data with the Simba threads in shared memory,
+ * for example using the atomic_* built-ins, which requires
+ * ``CONFIG_XVISOR_VIRT_V8_MMU``. The core waits for events forever
+ * if the function returns.
+ *
+ * @param[in] cpu Core to start, one(1) to
+ *                ``XVISOR_VIRT_V8_CPU_MAX`` - 1.
+ * @param[in] entry Function to call on the core.
+ * @param[in] arg_p Argument to the function.
+ * @param[in] stack_p Stack of the core.
+ * @param[in] stack_size Size of the stack.
+ *
+ * @return zero(0) or negative error code.
+ */
+int xvisor_virt_v8_cpu_start(int cpu,
+                             void (*entry)(void *arg_p),
+                             void *arg_p,
+                             void *stack_p,
+                             size_t stack_size);
+
+/**
+ * Enable the MMU and the caches on the calling core, using the
+ * translation tables created at startup.
+ */
+void xvisor_virt_v8_mmu_enable(void);
+
 #endif
@@ -28,8 +28,86 @@
 
 #include "simba.h"
 
+/* PSCI function identifiers and return codes. */
+#define PSCI_CPU_ON_64                               0xc4000003
+#define PSCI_SUCCESS                                          0
+#define PSCI_INVALID_PARAMETERS                              -2
+#define PSCI_ALREADY_ON                                      -4
+#define PSCI_ON_PENDING                                      -5
+
+/* Memory attribute indexes in MAIR_EL1, device nGnRE and normal
+   inner and outer write-back read and write allocate memory. */
+#define MAIR_INDEX_DEVICE                                     0
+#define MAIR_INDEX_NORMAL                                     1
+#define MAIR_EL1_VALUE                          \
+    ((0x04ULL << (8 * MAIR_INDEX_DEVICE))       \
+     | (0xffULL << (8 * MAIR_INDEX_NORMAL)))
+
+/* Translation table descriptor fields. */
+#define DESC_BLOCK                                          0x1
+#define DESC_TABLE                                          0x3
+#define DESC_ATTR_INDEX(index)                    ((index) << 2)
+#define DESC_AP_RO                                     (2 << 6)
+#define DESC_SH_INNER                                  (3 << 8)
+#define DESC_AF                                       (1 << 10)
+#define DESC_PXN                                   (1ULL << 53)
+#define DESC_UXN                                   (1ULL << 54)
+
+#define DESC_DEVICE (DESC_BLOCK                         \
+                     | DESC_ATTR_INDEX(MAIR_INDEX_DEVICE)       \
+                     | DESC_AF                                  \
+                     | DESC_PXN                                 \
+                     | DESC_UXN)
+#define DESC_NORMAL (DESC_BLOCK                         \
+                     | DESC_ATTR_INDEX(MAIR_INDEX_NORMAL)       \
+                     | DESC_SH_INNER                            \
+                     | DESC_AF                                  \
+                     | DESC_UXN)
+
+/* 4 GB virtual address space using the 4 KB granule and inner
+   shareable, write-back cacheable table walks. The table walk
+   starts at level 1 with 1 GB per entry. */
+#define TCR_EL1_VALUE ((64 - 32)                  \
+                       | (1 << 8)                 \
+                       | (1 << 10)                \
+                       | (3 << 12)                \
+                       | (1 << 23))
+
+#define SCTLR_EL1_M                                      BIT(0)
+#define SCTLR_EL1_A                                      BIT(1)
+#define SCTLR_EL1_C                                      BIT(2)
+#define SCTLR_EL1_I                                     BIT(12)
+
+/* Mapped memory. */
+#define ROM_SIZE                                     0x02000000
+#define RAM_ADDRESS                                  0x40000000
+#define BLOCK_SIZE_2M                                0x00200000
+
+/* Started core information, read by the secondary core before its
+   caches are enabled. Keep in sync with
+   xvisor_virt_v8_secondary_entry. */
+struct xvisor_virt_v8_cpu_t {
+    void (*entry)(void *arg_p);
+    void *arg_p;
+    void *stack_top_p;
+};
+
+extern void xvisor_virt_v8_secondary_entry(void);
+
 static void (*irq_table[128])(void);
 
+static struct xvisor_virt_v8_cpu_t cpus[XVISOR_VIRT_V8_CPU_MAX];
+
+#if CONFIG_XVISOR_VIRT_V8_MMU == 1
+
+/* Level 1 table with one entry per GB, and a level 2 table with 2 MB
+   blocks for the first GB, which contains both the flash and the
+   peripherals. */
+static uint64_t level_1_table[4] __attribute__ ((aligned (4096)));
+static uint64_t level_2_table[512] __attribute__ ((aligned (4096)));
+
+#endif
+
 /**
  * Do nothing if no interrupt service routine is installed in the
  * interrupt vector.
@@ -83,10 +161,155 @@ int rand()
     return (0);
 }
 
+/**
+ * Clean and invalidate given memory area from the data cache to the
+ * point of coherency.
+ */
+static void dcache_clean_invalidate(void *buf_p, size_t size)
+{
+    uint64_t line_size;
+    uint64_t address;
+    uint64_t end;
+
+    line_size = (4 << ((ARM64_MRS("ctr_el0") >> 16) & 0xf));
+    address = ((uint64_t)buf_p & ~(line_size - 1));
+    end = ((uint64_t)buf_p + size);
+
+    while (address < end) {
+        asm volatile ("dc civac, %0" : : "r" (address) : "memory");
+        address += line_size;
+    }
+
+    asm volatile ("dsb sy" : : : "memory");
+}
+
+static int64_t psci_call(uint64_t function,
+                         uint64_t arg0,
+                         uint64_t arg1,
+                         uint64_t arg2)
+{
+    register uint64_t x0 asm ("x0") = function;
+    register uint64_t x1 asm ("x1") = arg0;
+    register uint64_t x2 asm ("x2") = arg1;
+    register uint64_t x3 asm ("x3") = arg2;
+
+    asm volatile ("hvc #0"
+                  : "+r" (x0)
+                  : "r" (x1), "r" (x2), "r" (x3)
+                  : "x4", "x5", "x6", "x7", "x8", "x9", "x10", "x11",
+                    "x12", "x13", "x14", "x15", "x16", "x17", "memory");
+
+    return ((int64_t)x0);
+}
+
+#if CONFIG_XVISOR_VIRT_V8_MMU == 1
+
+void xvisor_virt_v8_mmu_enable(void)
+{
+    uint64_t sctlr;
+
+    ARM64_MSR("mair_el1", MAIR_EL1_VALUE);
+    ARM64_MSR("tcr_el1", TCR_EL1_VALUE);
+    ARM64_MSR("ttbr0_el1", (uint64_t)&level_1_table[0]);
+    asm volatile ("isb\n"
+                  "tlbi vmalle1\n"
+                  "dsb nsh\n"
+                  "isb"
+                  : : : "memory");
+
+    sctlr = ARM64_MRS("sctlr_el1");
+    sctlr &= ~SCTLR_EL1_A;
+    sctlr |= (SCTLR_EL1_M | SCTLR_EL1_C | SCTLR_EL1_I);
+    ARM64_MSR("sctlr_el1", sctlr);
+    asm volatile ("isb" : : : "memory");
+}
+
+/**
+ * Identity map the flash as read-only normal memory, the peripherals
+ * as device memory and the first GB of RAM as normal memory, and
+ * enable the MMU and the caches.
+ */
+static void mmu_init(void)
+{
+    uint64_t address;
+    int i;
+
+    for (i = 0; i < membersof(level_2_table); i++) {
+        address = ((uint64_t)i * BLOCK_SIZE_2M);
+
+        if (address < ROM_SIZE) {
+            level_2_table[i] = (address | DESC_NORMAL | DESC_AP_RO);
+        } else {
+            level_2_table[i] = (address | DESC_DEVICE);
+        }
+    }
+
+    level_1_table[0] = ((uint64_t)&level_2_table[0] | DESC_TABLE);
+    level_1_table[1] = (RAM_ADDRESS | DESC_NORMAL);
+
+    /* Discard any stale cache lines of the tables written with the
+       caches disabled. */
+    dcache_clean_invalidate(&level_1_table[0], sizeof(level_1_table));
+    dcache_clean_invalidate(&level_2_table[0], sizeof(level_2_table));
+
+    xvisor_virt_v8_mmu_enable();
+}
+
+#endif
+
+int xvisor_virt_v8_cpu_start(int cpu,
+                             void (*entry)(void *arg_p),
+                             void *arg_p,
+                             void *stack_p,
+                             size_t stack_size)
+{
+    struct xvisor_virt_v8_cpu_t *cpu_p;
+    int64_t res;
+
+    if ((cpu < 1) || (cpu >= XVISOR_VIRT_V8_CPU_MAX)) {
+        return (-EINVAL);
+    }
+
+    cpu_p = &cpus[cpu];
+    cpu_p->entry = entry;
+    cpu_p->arg_p = arg_p;
+    cpu_p->stack_top_p = (void *)(((uintptr_t)stack_p + stack_size) & ~15UL);
+
+    /* The secondary core reads its information and uses its stack
+       before its caches are enabled. */
+    dcache_clean_invalidate(cpu_p, sizeof(*cpu_p));
+    dcache_clean_invalidate(stack_p, stack_size);
+
+    res = psci_call(PSCI_CPU_ON_64,
+                    cpu,
+                    (uint64_t)xvisor_virt_v8_secondary_entry,
+                    (uint64_t)cpu_p);
+
+    switch (res) {
+
+    case PSCI_SUCCESS:
+        return (0);
+
+    case PSCI_INVALID_PARAMETERS:
+        return (-EINVAL);
+
+    case PSCI_ALREADY_ON:
+    case PSCI_ON_PENDING:
+        return (-EBUSY);
+
+    default:
+        return (-EIO);
+    }
+}
+
 void xvisor_virt_v8_init(void)
 {
     int i;
 
+#if CONFIG_XVISOR_VIRT_V8_MMU == 1
+    mmu_init();
+#endif
+
     for (i = 32 / 16; i < 96 / 16; i++) {
         VIRT_GIC_DIST->CONFIG[i] = 0;
     }
@@ -28,6 +28,262 @@
 
 #include "simba.h"
 
+static void flush_events(struct midi_parser_t *self_p)
+{
+    if (self_p->events.length > 0) {
+        self_p->on_events(self_p->arg_p,
+                          &self_p->events.buf[0],
+                          self_p->events.length);
+        self_p->events.length = 0;
+    }
+}
+
+static void add_event(struct midi_parser_t *self_p,
+                      uint8_t status,
+                      uint8_t data0,
+                      uint8_t data1)
+{
+    struct midi_event_t *event_p;
+
+    event_p = &self_p->events.buf[self_p->events.length];
+    event_p->status = status;
+    event_p->data[0] = data0;
+    event_p->data[1] = data1;
+    self_p->events.length++;
+
+    if (self_p->events.length == membersof(self_p->events.buf)) {
+        flush_events(self_p);
+    }
+}
+
+/**
+ * Give buffered SysEx data to the SysEx callback, after all events
+ * parsed before it.
+ */
+static void flush_sysex(struct midi_parser_t *self_p, int flags)
+{
+    flush_events(self_p);
+
+    if (self_p->on_sysex != NULL) {
+        self_p->on_sysex(self_p->arg_p,
+                         &self_p->sysex.buf[0],
+                         self_p->sysex.size,
+                         self_p->sysex.flags | flags);
+    }
+
+    self_p->sysex.flags = 0;
+    self_p->sysex.size = 0;
+}
+
+static void end_sysex(struct midi_parser_t *self_p)
+{
+    flush_sysex(self_p, MIDI_PARSER_SYSEX_LAST);
+    self_p->sysex.active = 0;
+}
+
+/**
+ * Number of data bytes following given status byte.
+ */
+static int status_to_expected(uint8_t status)
+{
+    switch (status & 0xf0) {
+
+    case MIDI_PROGRAM_CHANGE:
+    case MIDI_CHANNEL_PRESSURE:
+        return (1);
+
+    case 0xf0:
+        switch (status) {
+
+        case MIDI_TIME_CODE_QUARTER_FRAME:
+        case MIDI_SONG_SELECT:
+            return (1);
+
+        case MIDI_SONG_POSITION_POINTER:
+            return (2);
+
+        default:
+            return (0);
+        }
+
+    default:
+        return (2);
+    }
+}
+
+static void parse_status(struct midi_parser_t *self_p, uint8_t byte)
+{
+    if (self_p->sysex.active == 1) {
+        end_sysex(self_p);
+
+        if (byte == MIDI_SYSEX_END) {
+            return;
+        }
+    }
+
+    self_p->size = 0;
+
+    if (byte == MIDI_SYSEX_START) {
+        self_p->status = 0;
+        self_p->sysex.active = 1;
+        self_p->sysex.flags = MIDI_PARSER_SYSEX_FIRST;
+        self_p->sysex.size = 0;
+    } else if (byte == MIDI_SYSEX_END) {
+        /* End without start. */
+        self_p->status = 0;
+        self_p->discarded++;
+    } else {
+        /* Running status is only used by channel messages. */
+        self_p->status = byte;
+        self_p->expected = status_to_expected(byte);
+
+        if (self_p->expected == 0) {
+            add_event(self_p, byte, 0, 0);
+            self_p->status = 0;
+        }
+    }
+}
+
+static void parse_data(struct midi_parser_t *self_p, uint8_t byte)
+{
+    if (self_p->sysex.active == 1) {
+        self_p->sysex.buf[self_p->sysex.size++] = byte;
+
+        if (self_p->sysex.size == membersof(self_p->sysex.buf)) {
+            flush_sysex(self_p, 0);
+        }
+
+        return;
+    }
+
+    if (self_p->status == 0) {
+        self_p->discarded++;
+
+        return;
+    }
+
+    self_p->data[self_p->size++] = byte;
+
+    if (self_p->size < self_p->expected) {
+        return;
+    }
+
+    add_event(self_p,
+              self_p->status,
+              self_p->data[0],
+              (self_p->expected == 2 ? self_p->data[1] : 0));
+    self_p->size = 0;
+
+    if (self_p->status >= MIDI_SYSEX_START) {
+        self_p->status = 0;
+    }
+}
+
+int midi_parser_init(struct midi_parser_t *self_p,
+                     midi_parser_on_events_t on_events,
+                     midi_parser_on_sysex_t on_sysex,
+                     void *arg_p)
+{
+    ASSERTN(self_p != NULL, EINVAL);
+    ASSERTN(on_events != NULL, EINVAL);
+
+    self_p->on_events = on_events;
+    self_p->on_sysex = on_sysex;
+    self_p->arg_p = arg_p;
+    self_p->status = 0;
+    self_p->size = 0;
+    self_p->expected = 0;
+    self_p->sysex.active = 0;
+    self_p->sysex.flags = 0;
+    self_p->sysex.size = 0;
+    self_p->events.length = 0;
+    self_p->discarded = 0;
+
+    return (0);
+}
+
+int midi_parser_write(struct midi_parser_t *self_p,
+                      const uint8_t *buf_p,
+                      size_t size)
+{
+    ASSERTN(self_p != NULL, EINVAL);
+    ASSERTN((buf_p != NULL) || (size == 0), EINVAL);
+
+    size_t i;
+    uint8_t byte;
+
+    for (i = 0; i < size; i++) {
+        byte = buf_p[i];
+
+        if (byte >= MIDI_TIMING_CLOCK) {
+            /* Real-time messages may be anywhere, even in the middle
+               of other messages. */
+            add_event(self_p, byte, 0, 0);
+        } else if (byte & 0x80) {
+            parse_status(self_p, byte);
+        } else {
+            parse_data(self_p, byte);
+        }
+    }
+
+    flush_events(self_p);
+
+    return (0);
+}
+
+ssize_t midi_parser_read(struct midi_parser_t *self_p, void *chan_p)
+{
+    ASSERTN(self_p != NULL, EINVAL);
+    ASSERTN(chan_p != NULL, EINVAL);
+
+    uint8_t buf[16];
+    ssize_t res;
+    size_t size;
+    size_t available;
+    ssize_t total;
+
+    /* Wait for the first byte, then parse it together with all bytes
+       already received. */
+    res = chan_read(chan_p, &buf[0], 1);
+
+    if (res != 1) {
+        return (res < 0 ? res : -EIO);
+    }
+
+    size = 1;
+    total = 0;
+
+    while (1) {
+        available = MIN(chan_size(chan_p), sizeof(buf) - size);
+
+        if (available > 0) {
+            res = chan_read(chan_p, &buf[size], available);
+
+            if (res < 0) {
+                return (res);
+            }
+
+            size += res;
+        }
+
+        midi_parser_write(self_p, &buf[0], size);
+        total += size;
+
+        if (chan_size(chan_p) == 0) {
+            break;
+        }
+
+        size = 0;
+    }
+
+    return (total);
+}
+
+uint32_t midi_parser_get_discarded(struct midi_parser_t *self_p)
+{
+    return (self_p->discarded);
+}
+
 #if CONFIG_FLOAT == 1
 
 /* MIDI note number to frequency. */
@@ -45,6 +45,24 @@
 #define MIDI_SET_INTRUMENT            0xc0
 #define MIDI_PERC                     0x99
 
+/* MIDI system messages. */
+#define MIDI_SYSEX_START              0xf0
+#define MIDI_TIME_CODE_QUARTER_FRAME  0xf1
+#define MIDI_SONG_POSITION_POINTER    0xf2
+#define MIDI_SONG_SELECT              0xf3
+#define MIDI_TUNE_REQUEST             0xf6
+#define MIDI_SYSEX_END                0xf7
+#define MIDI_TIMING_CLOCK             0xf8
+#define MIDI_START                    0xfa
+#define MIDI_CONTINUE                 0xfb
+#define MIDI_STOP                     0xfc
+#define MIDI_ACTIVE_SENSING           0xfe
+#define MIDI_RESET                    0xff
+
+/* SysEx chunk flags. */
+#define MIDI_PARSER_SYSEX_FIRST       0x01
+#define MIDI_PARSER_SYSEX_LAST        0x02
+
 #define MIDI_NOTE_MAX 128
 
 /* Midi notees. */
@@ -158,6 +176,123 @@
 #define MIDI_PERC_MUTE_TRIANGLE      80
 #define MIDI_PERC_OPEN_TRIANGLE      81
 
+/**
+ * A parsed MIDI message, except SysEx.
+ */
+struct midi_event_t {
+    /** Status byte. The command and the channel for channel
+        messages, for example ``MIDI_NOTE_ON | 3``. */
+    uint8_t status;
+    /** Data bytes. Unused data bytes are zero(0). */
+    uint8_t data[2];
+};
+
+/**
+ * Called with the events parsed from the input, in input order.
+ *
+ * @param[in] arg_p Argument given to `midi_parser_init()`.
+ * @param[in] events_p Parsed events.
+ * @param[in] length Number of events.
+ */
+typedef void (*midi_parser_on_events_t)(void *arg_p,
+                                        const struct midi_event_t *events_p,
+                                        size_t length);
+
+/**
+ * Called with a chunk of SysEx data, excluding the start and end
+ * bytes. A SysEx message may be delivered in several chunks.
+ *
+ * @param[in] arg_p Argument given to `midi_parser_init()`.
+ * @param[in] buf_p SysEx data.
+ * @param[in] size Size of the data, possibly zero for the last
+ *                 chunk.
+ * @param[in] flags ``MIDI_PARSER_SYSEX_FIRST`` for the first chunk
+ *                  and ``MIDI_PARSER_SYSEX_LAST`` for the last
+ *                  chunk of a message.
+ */
+typedef void (*midi_parser_on_sysex_t)(void *arg_p,
+                                       const uint8_t *buf_p,
+                                       size_t size,
+                                       int flags);
+
+/**
+ * A byte streaming MIDI parser.
+ */
+struct midi_parser_t {
+    midi_parser_on_events_t on_events;
+    midi_parser_on_sysex_t on_sysex;
+    void *arg_p;
+    uint8_t status;
+    uint8_t size;
+    uint8_t expected;
+    uint8_t data[2];
+    struct {
+        int active;
+        int flags;
+        size_t size;
+        uint8_t buf[CONFIG_MIDI_PARSER_SYSEX_CHUNK_SIZE];
+    } sysex;
+    struct {
+        size_t length;
+        struct midi_event_t buf[CONFIG_MIDI_PARSER_EVENTS_MAX];
+    } events;
+    uint32_t discarded;
+};
+
+/**
+ * Initialize given MIDI parser.
+ *
+ * @param[out] self_p Parser to initialize.
+ * @param[in] on_events Called with parsed events.
+ * @param[in] on_sysex Called with SysEx chunks, or NULL to discard
+ *                     SysEx data.
+ * @param[in] arg_p Callbacks argument.
+ *
+ * @return zero(0) or negative error code.
+ */
+int midi_parser_init(struct midi_parser_t *self_p,
+                     midi_parser_on_events_t on_events,
+                     midi_parser_on_sysex_t on_sysex,
+                     void *arg_p);
+
+/**
+ * Parse given input bytes. Running status, real-time messages in
+ * the middle of other messages and SysEx messages are handled. The
+ * parsed events are given to the events callback in batches of up
+ * to ``CONFIG_MIDI_PARSER_EVENTS_MAX`` events, and all parsed events
+ * are delivered when this function returns.
+ *
+ * @param[in] self_p Initialized parser.
+ * @param[in] buf_p Input bytes.
+ * @param[in] size Number of input bytes.
+ *
+ * @return zero(0) or negative error code.
+ */
+int midi_parser_write(struct midi_parser_t *self_p,
+                      const uint8_t *buf_p,
+                      size_t size);
+
+/**
+ * Wait for input on given channel and parse it. All bytes available
+ * after the first one are parsed as well, in one batch.
+ *
+ * @param[in] self_p Initialized parser.
+ * @param[in] chan_p Input channel, for example an UART driver.
+ *
+ * @return Number of parsed bytes or negative error code.
+ */
+ssize_t midi_parser_read(struct midi_parser_t *self_p, void *chan_p);
+
+/**
+ * Get the number of data bytes discarded since the parser was
+ * initialized, because they were not part of a message.
+ *
+ * @param[in] self_p Initialized parser.
+ *
+ * @return Number of discarded bytes.
+ */
+uint32_t midi_parser_get_discarded(struct midi_parser_t *self_p);
+
 /**
  * Get the frequency for given note.
  *
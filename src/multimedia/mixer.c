@@ -0,0 +1,734 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2014-2018, Erik Moqvist
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use, copy,
+ * modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ * This file is part of the Simba project.
+ */
+
+#include "simba.h"
+
+const FAR int16_t mixer_waveform_sine[MIXER_WAVEFORM_LENGTH] = {
+    0, 804, 1608, 2410, 3212, 4011, 4808, 5602,
+    6393, 7179, 7962, 8739, 9512, 10278, 11039, 11793,
+    12539, 13279, 14010, 14732, 15446, 16151, 16846, 17530,
+    18204, 18868, 19519, 20159, 20787, 21403, 22005, 22594,
+    23170, 23731, 24279, 24811, 25329, 25832, 26319, 26790,
+    27245, 27683, 28105, 28510, 28898, 29268, 29621, 29956,
+    30273, 30571, 30852, 31113, 31356, 31580, 31785, 31971,
+    32137, 32285, 32412, 32521, 32609, 32678, 32728, 32757,
+    32767, 32757, 32728, 32678, 32609, 32521, 32412, 32285,
+    32137, 31971, 31785, 31580, 31356, 31113, 30852, 30571,
+    30273, 29956, 29621, 29268, 28898, 28510, 28105, 27683,
+    27245, 26790, 26319, 25832, 25329, 24811, 24279, 23731,
+    23170, 22594, 22005, 21403, 20787, 20159, 19519, 18868,
+    18204, 17530, 16846, 16151, 15446, 14732, 14010, 13279,
+    12539, 11793, 11039, 10278, 9512, 8739, 7962, 7179,
+    6393, 5602, 4808, 4011, 3212, 2410, 1608, 804,
+    0, -804, -1608, -2410, -3212, -4011, -4808, -5602,
+    -6393, -7179, -7962, -8739, -9512, -10278, -11039, -11793,
+    -12539, -13279, -14010, -14732, -15446, -16151, -16846, -17530,
+    -18204, -18868, -19519, -20159, -20787, -21403, -22005, -22594,
+    -23170, -23731, -24279, -24811, -25329, -25832, -26319, -26790,
+    -27245, -27683, -28105, -28510, -28898, -29268, -29621, -29956,
+    -30273, -30571, -30852, -31113, -31356, -31580, -31785, -31971,
+    -32137, -32285, -32412, -32521, -32609, -32678, -32728, -32757,
+    -32767, -32757, -32728, -32678, -32609, -32521, -32412, -32285,
+    -32137, -31971, -31785, -31580, -31356, -31113, -30852, -30571,
+    -30273, -29956, -29621, -29268, -28898, -28510, -28105, -27683,
+    -27245, -26790, -26319, -25832, -25329, -24811, -24279, -23731,
+    -23170, -22594, -22005, -21403, -20787, -20159, -19519, -18868,
+    -18204, -17530, -16846, -16151, -15446, -14732, -14010, -13279,
+    -12539, -11793, -11039, -10278, -9512, -8739, -7962, -7179,
+    -6393, -5602, -4808, -4011, -3212, -2410, -1608, -804
+};
+
+const FAR int16_t mixer_waveform_square[MIXER_WAVEFORM_LENGTH] = {
+    32767, 32767, 32767, 32767, 32767, 32767, 32767, 32767,
+    32767, 32767, 32767, 32767, 32767, 32767, 32767, 32767,
+    32767, 32767, 32767, 32767, 32767, 32767, 32767, 32767,
+    32767, 32767, 32767, 32767, 32767, 32767, 32767, 32767,
+    32767, 32767, 32767, 32767, 32767, 32767, 32767, 32767,
+    32767, 32767, 32767, 32767, 32767, 32767, 32767, 32767,
+    32767, 32767, 32767, 32767, 32767, 32767, 32767, 32767,
+    32767, 32767, 32767, 32767, 32767, 32767, 32767, 32767,
+    32767, 32767, 32767, 32767, 32767, 32767, 32767, 32767,
+    32767, 32767, 32767, 32767, 32767, 32767, 32767, 32767,
+    32767, 32767, 32767, 32767, 32767, 32767, 32767, 32767,
+    32767, 32767, 32767, 32767, 32767, 32767, 32767, 32767,
+    32767, 32767, 32767, 32767, 32767, 32767, 32767, 32767,
+    32767, 32767, 32767, 32767, 32767, 32767, 32767, 32767,
+    32767, 32767, 32767, 32767, 32767, 32767, 32767, 32767,
+    32767, 32767, 32767, 32767, 32767, 32767, 32767, 32767,
+    -32767, -32767, -32767, -32767, -32767, -32767, -32767, -32767,
+    -32767, -32767, -32767, -32767, -32767, -32767, -32767, -32767,
+    -32767, -32767, -32767, -32767, -32767, -32767, -32767, -32767,
+    -32767, -32767, -32767, -32767, -32767, -32767, -32767, -32767,
+    -32767, -32767, -32767, -32767, -32767, -32767, -32767, -32767,
+    -32767, -32767, -32767, -32767, -32767, -32767, -32767, -32767,
+    -32767, -32767, -32767, -32767, -32767, -32767, -32767, -32767,
+    -32767, -32767, -32767, -32767, -32767, -32767, -32767, -32767,
+    -32767, -32767, -32767, -32767, -32767, -32767, -32767, -32767,
+    -32767, -32767, -32767, -32767, -32767, -32767, -32767, -32767,
+    -32767, -32767, -32767, -32767, -32767, -32767, -32767, -32767,
+    -32767, -32767, -32767, -32767, -32767, -32767, -32767, -32767,
+    -32767, -32767, -32767, -32767, -32767, -32767, -32767, -32767,
+    -32767, -32767, -32767, -32767, -32767, -32767, -32767, -32767,
+    -32767, -32767, -32767, -32767, -32767, -32767, -32767, -32767,
+    -32767, -32767, -32767, -32767, -32767, -32767, -32767, -32767
+};
+
+const FAR int16_t mixer_waveform_saw[MIXER_WAVEFORM_LENGTH] = {
+    -32767, -32510, -32253, -31996, -31739, -31482, -31225, -30968,
+    -30711, -30454, -30197, -29940, -29683, -29426, -29169, -28912,
+    -28655, -28398, -28141, -27884, -27627, -27370, -27113, -26856,
+    -26599, -26342, -26085, -25828, -25571, -25314, -25057, -24800,
+    -24543, -24286, -24029, -23772, -23515, -23258, -23001, -22744,
+    -22487, -22230, -21973, -21716, -21459, -21202, -20945, -20688,
+    -20431, -20174, -19917, -19660, -19403, -19146, -18889, -18632,
+    -18375, -18118, -17861, -17604, -17347, -17090, -16833, -16576,
+    -16319, -16062, -15805, -15548, -15291, -15034, -14777, -14520,
+    -14263, -14006, -13749, -13492, -13235, -12978, -12721, -12464,
+    -12207, -11950, -11693, -11436, -11179, -10922, -10665, -10408,
+    -10151, -9894, -9637, -9380, -9123, -8866, -8609, -8352,
+    -8095, -7838, -7581, -7324, -7067, -6810, -6553, -6296,
+    -6039, -5782, -5525, -5268, -5011, -4754, -4497, -4240,
+    -3983, -3726, -3469, -3212, -2955, -2698, -2441, -2184,
+    -1927, -1670, -1413, -1156, -899, -642, -385, -128,
+    128, 385, 642, 899, 1156, 1413, 1670, 1927,
+    2184, 2441, 2698, 2955, 3212, 3469, 3726, 3983,
+    4240, 4497, 4754, 5011, 5268, 5525, 5782, 6039,
+    6296, 6553, 6810, 7067, 7324, 7581, 7838, 8095,
+    8352, 8609, 8866, 9123, 9380, 9637, 9894, 10151,
+    10408, 10665, 10922, 11179, 11436, 11693, 11950, 12207,
+    12464, 12721, 12978, 13235, 13492, 13749, 14006, 14263,
+    14520, 14777, 15034, 15291, 15548, 15805, 16062, 16319,
+    16576, 16833, 17090, 17347, 17604, 17861, 18118, 18375,
+    18632, 18889, 19146, 19403, 19660, 19917, 20174, 20431,
+    20688, 20945, 21202, 21459, 21716, 21973, 22230, 22487,
+    22744, 23001, 23258, 23515, 23772, 24029, 24286, 24543,
+    24800, 25057, 25314, 25571, 25828, 26085, 26342, 26599,
+    26856, 27113, 27370, 27627, 27884, 28141, 28398, 28655,
+    28912, 29169, 29426, 29683, 29940, 30197, 30454, 30711,
+    30968, 31225, 31482, 31739, 31996, 32253, 32510, 32767
+};
+
+/* Frequencies of MIDI notes 120 to 131 in Q16.16. */
+static const FAR uint32_t top_octave_frequencies[12] = {
+    548668578, 581294109, 615859655, 652480576,
+    691279090, 732384684, 775934544, 822074013,
+    870957077, 922746880, 977616265, 1035748353
+};
+
+static uint32_t note_to_phase_increment(int note, int sample_rate)
+{
+    uint64_t increment;
+
+    increment = top_octave_frequencies[note % 12];
+    increment = ((increment << 16) / sample_rate);
+
+    return (increment >> (10 - note / 12));
+}
+
+/**
+ * Voice levels are Q15.16, the upper half being the amplitude.
+ */
+static int32_t velocity_to_level(int velocity)
+{
+    return (((velocity * 32767) / 127) << 16);
+}
+
+/**
+ * Linearly ramp from the current level to given level over given
+ * number of samples.
+ */
+static void ramp(struct mixer_voice_t *voice_p,
+                 int32_t level,
+                 uint32_t samples)
+{
+    voice_p->remaining = samples;
+    voice_p->increment = ((level - voice_p->level) / (int32_t)samples);
+}
+
+static void enter_release(struct mixer_t *self_p,
+                          struct mixer_voice_t *voice_p)
+{
+    voice_p->state = MIXER_VOICE_STATE_RELEASE;
+
+    if ((self_p->envelope.release == 0) || (voice_p->level == 0)) {
+        voice_p->level = 0;
+        voice_p->state = MIXER_VOICE_STATE_IDLE;
+    } else {
+        ramp(voice_p, 0, self_p->envelope.release);
+    }
+}
+
+/**
+ * Start the next envelope phase, skipping phases of zero length.
+ */
+static void next_phase(struct mixer_t *self_p,
+                       struct mixer_voice_t *voice_p)
+{
+    switch (voice_p->state) {
+
+    case MIXER_VOICE_STATE_ATTACK:
+        voice_p->level = voice_p->peak;
+        voice_p->state = MIXER_VOICE_STATE_DECAY;
+
+        if (self_p->envelope.decay > 0) {
+            ramp(voice_p, voice_p->sustain, self_p->envelope.decay);
+            break;
+        }
+
+        /* Fall through. */
+
+    case MIXER_VOICE_STATE_DECAY:
+        voice_p->level = voice_p->sustain;
+
+        if (voice_p->sustain == 0) {
+            voice_p->state = MIXER_VOICE_STATE_IDLE;
+        } else {
+            voice_p->state = MIXER_VOICE_STATE_SUSTAIN;
+            voice_p->increment = 0;
+            voice_p->remaining = UINT32_MAX;
+        }
+
+        break;
+
+    case MIXER_VOICE_STATE_RELEASE:
+        voice_p->level = 0;
+        voice_p->state = MIXER_VOICE_STATE_IDLE;
+        break;
+
+    default:
+        break;
+    }
+}
+
+static void start_voice(struct mixer_t *self_p,
+                        struct mixer_voice_t *voice_p,
+                        int channel,
+                        int note,
+                        int velocity)
+{
+    self_p->age++;
+    voice_p->age = self_p->age;
+    voice_p->channel = channel;
+    voice_p->note = note;
+    voice_p->released = 0;
+    voice_p->phase_increment = note_to_phase_increment(note,
+                                                       self_p->sample_rate);
+    voice_p->peak = velocity_to_level(velocity);
+    voice_p->sustain = ((((int64_t)voice_p->peak >> 16)
+                         * self_p->envelope.sustain) >> 15) << 16;
+    voice_p->state = MIXER_VOICE_STATE_ATTACK;
+
+    /* Ramp up from the current level of a restarted or stolen voice
+       to avoid a click. */
+    if (self_p->envelope.attack > 0) {
+        ramp(voice_p, voice_p->peak, self_p->envelope.attack);
+    } else {
+        next_phase(self_p, voice_p);
+    }
+}
+
+static struct mixer_voice_t *find_voice(struct mixer_t *self_p,
+                                        int channel,
+                                        int note)
+{
+    int i;
+    struct mixer_voice_t *voice_p;
+
+    for (i = 0; i < membersof(self_p->voices); i++) {
+        voice_p = &self_p->voices[i];
+
+        if ((voice_p->state != MIXER_VOICE_STATE_IDLE)
+            && (voice_p->channel == channel)
+            && (voice_p->note == note)) {
+            return (voice_p);
+        }
+    }
+
+    return (NULL);
+}
+
+/**
+ * An idle voice, or the quietest releasing voice, or the oldest
+ * voice.
+ */
+static struct mixer_voice_t *allocate_voice(struct mixer_t *self_p)
+{
+    int i;
+    struct mixer_voice_t *voice_p;
+    struct mixer_voice_t *released_p;
+    struct mixer_voice_t *oldest_p;
+
+    released_p = NULL;
+    oldest_p = &self_p->voices[0];
+
+    for (i = 0; i < membersof(self_p->voices); i++) {
+        voice_p = &self_p->voices[i];
+
+        if (voice_p->state == MIXER_VOICE_STATE_IDLE) {
+            return (voice_p);
+        }
+
+        if (voice_p->state == MIXER_VOICE_STATE_RELEASE) {
+            if ((released_p == NULL) || (voice_p->level < released_p->level)) {
+                released_p = voice_p;
+            }
+        }
+
+        if ((self_p->age - voice_p->age) > (self_p->age - oldest_p->age)) {
+            oldest_p = voice_p;
+        }
+    }
+
+    self_p->stolen++;
+
+    if (released_p != NULL) {
+        return (released_p);
+    }
+
+    return (oldest_p);
+}
+
+/**
+ * Add given number of samples of given voice to given samples. The
+ * envelope is not changing phase within the samples.
+ */
+static void render_samples(struct mixer_voice_t *voice_p,
+                           struct mixer_channel_t *channel_p,
+                           int32_t *samples_p,
+                           size_t length)
+{
+    const FAR int16_t *waveform_p;
+    uint32_t phase;
+    uint32_t phase_increment;
+    int32_t level;
+    int32_t increment;
+    int shift;
+    int mask;
+    int index;
+    int32_t fraction;
+    int32_t sample;
+    int32_t next;
+    size_t i;
+
+    waveform_p = channel_p->waveform_p;
+    shift = channel_p->shift;
+    mask = channel_p->mask;
+    phase = voice_p->phase;
+    phase_increment = voice_p->phase_increment;
+    level = voice_p->level;
+    increment = voice_p->increment;
+
+    for (i = 0; i < length; i++) {
+        /* Linear interpolation between two waveform samples. */
+        index = (phase >> shift);
+        fraction = ((phase >> (shift - 15)) & 0x7fff);
+        sample = waveform_p[index];
+        next = waveform_p[(index + 1) & mask];
+        sample += (((next - sample) * fraction) >> 15);
+
+        samples_p[i] += ((sample * (level >> 16)) >> 15);
+        phase += phase_increment;
+        level += increment;
+    }
+
+    voice_p->phase = phase;
+    voice_p->level = level;
+}
+
+/**
+ * Add one block of given voice to given samples.
+ */
+static void render_voice(struct mixer_t *self_p,
+                         struct mixer_voice_t *voice_p,
+                         int32_t *samples_p,
+                         size_t length)
+{
+    size_t size;
+
+    if ((voice_p->released == 1)
+        && (voice_p->state != MIXER_VOICE_STATE_RELEASE)) {
+        enter_release(self_p, voice_p);
+    }
+
+    while ((length > 0) && (voice_p->state != MIXER_VOICE_STATE_IDLE)) {
+        size = length;
+
+        if (voice_p->remaining < size) {
+            size = voice_p->remaining;
+        }
+
+        render_samples(voice_p,
+                       &self_p->channels[voice_p->channel],
+                       samples_p,
+                       size);
+
+        if (voice_p->state != MIXER_VOICE_STATE_SUSTAIN) {
+            voice_p->remaining -= size;
+
+            if (voice_p->remaining == 0) {
+                next_phase(self_p, voice_p);
+            }
+        }
+
+        samples_p += size;
+        length -= size;
+    }
+}
+
+static void render_block(struct mixer_t *self_p,
+                         int32_t *samples_p,
+                         size_t length,
+                         void (*lock)(void),
+                         void (*unlock)(void))
+{
+    int i;
+    struct mixer_voice_t *voice_p;
+    struct mixer_voice_t voice;
+
+    memset(samples_p, 0, sizeof(*samples_p) * length);
+
+    for (i = 0; i < membersof(self_p->voices); i++) {
+        voice_p = &self_p->voices[i];
+
+        /* Render a copy of the voice without the lock held, and store
+           it only if the voice was not restarted meanwhile. */
+        lock();
+
+        if ((voice_p->state == MIXER_VOICE_STATE_IDLE)
+            || (self_p->channels[voice_p->channel].muted == 1)) {
+            unlock();
+            continue;
+        }
+
+        voice = *voice_p;
+        unlock();
+
+        render_voice(self_p, &voice, samples_p, length);
+
+        lock();
+
+        if (voice_p->age == voice.age) {
+            voice.released = voice_p->released;
+            *voice_p = voice;
+        }
+
+        unlock();
+    }
+}
+
+static int render(struct mixer_t *self_p,
+                  int32_t *samples_p,
+                  size_t length,
+                  void (*lock)(void),
+                  void (*unlock)(void))
+{
+    size_t size;
+
+    while (length > 0) {
+        size = MIN(length, CONFIG_MIXER_BLOCK_LENGTH);
+        render_block(self_p, samples_p, size, lock, unlock);
+        samples_p += size;
+        length -= size;
+    }
+
+    return (0);
+}
+
+static void render_dac(struct mixer_t *self_p,
+                       uint32_t *samples_p,
+                       size_t length,
+                       void (*lock)(void),
+                       void (*unlock)(void))
+{
+    size_t size;
+    size_t i;
+    int32_t sample;
+
+    while (length > 0) {
+        size = MIN(length, CONFIG_MIXER_BLOCK_LENGTH);
+        render_block(self_p, self_p->block, size, lock, unlock);
+
+        for (i = 0; i < size; i++) {
+            sample = ((self_p->block[i] >> self_p->output_shift) + 2048);
+
+            if (sample < 0) {
+                sample = 0;
+            } else if (sample > 4095) {
+                sample = 4095;
+            }
+
+            samples_p[i] = sample;
+        }
+
+        samples_p += size;
+        length -= size;
+    }
+}
+
+int mixer_init(struct mixer_t *self_p, int sample_rate)
+{
+    ASSERTN(self_p != NULL, EINVAL);
+    ASSERTN(sample_rate > 0, EINVAL);
+
+    int i;
+
+    memset(self_p, 0, sizeof(*self_p));
+    self_p->sample_rate = sample_rate;
+    self_p->output_shift = 8;
+    self_p->envelope.sustain = 32767;
+
+    for (i = 0; i < MIXER_CHANNELS_MAX; i++) {
+        mixer_set_waveform(self_p,
+                           i,
+                           mixer_waveform_sine,
+                           MIXER_WAVEFORM_LENGTH);
+    }
+
+    return (0);
+}
+
+int mixer_set_waveform(struct mixer_t *self_p,
+                       int channel,
+                       const FAR int16_t *waveform_p,
+                       size_t length)
+{
+    ASSERTN(self_p != NULL, EINVAL);
+    ASSERTN(waveform_p != NULL, EINVAL);
+
+    struct mixer_channel_t *channel_p;
+    int shift;
+
+    if ((channel < 0) || (channel >= MIXER_CHANNELS_MAX)) {
+        return (-EINVAL);
+    }
+
+    if ((length < 2) || (length > 65536) || ((length & (length - 1)) != 0)) {
+        return (-EINVAL);
+    }
+
+    shift = 32;
+
+    while ((1UL << (32 - shift)) < length) {
+        shift--;
+    }
+
+    channel_p = &self_p->channels[channel];
+
+    sys_lock();
+    channel_p->waveform_p = waveform_p;
+    channel_p->mask = (length - 1);
+    channel_p->shift = shift;
+    sys_unlock();
+
+    return (0);
+}
+
+int mixer_set_envelope(struct mixer_t *self_p,
+                       uint32_t attack,
+                       uint32_t decay,
+                       int sustain,
+                       uint32_t release)
+{
+    ASSERTN(self_p != NULL, EINVAL);
+
+    if ((sustain < 0) || (sustain > 32767)) {
+        return (-EINVAL);
+    }
+
+    sys_lock();
+    self_p->envelope.attack = attack;
+    self_p->envelope.decay = decay;
+    self_p->envelope.sustain = sustain;
+    self_p->envelope.release = release;
+    sys_unlock();
+
+    return (0);
+}
+
+int mixer_set_muted(struct mixer_t *self_p, int channel, int muted)
+{
+    ASSERTN(self_p != NULL, EINVAL);
+
+    if ((channel < 0) || (channel >= MIXER_CHANNELS_MAX)) {
+        return (-EINVAL);
+    }
+
+    self_p->channels[channel].muted = (muted != 0);
+
+    return (0);
+}
+
+int mixer_set_output_shift(struct mixer_t *self_p, int shift)
+{
+    ASSERTN(self_p != NULL, EINVAL);
+
+    if ((shift < 0) || (shift > 31)) {
+        return (-EINVAL);
+    }
+
+    self_p->output_shift = shift;
+
+    return (0);
+}
+
+int mixer_note_on(struct mixer_t *self_p,
+                  int channel,
+                  int note,
+                  int velocity)
+{
+    ASSERTN(self_p != NULL, EINVAL);
+
+    struct mixer_voice_t *voice_p;
+
+    if ((channel < 0) || (channel >= MIXER_CHANNELS_MAX)) {
+        return (-EINVAL);
+    }
+
+    if ((note < 0) || (note >= MIDI_NOTE_MAX)) {
+        return (-EINVAL);
+    }
+
+    if ((velocity < 0) || (velocity > 127)) {
+        return (-EINVAL);
+    }
+
+    if (velocity == 0) {
+        return (mixer_note_off(self_p, channel, note));
+    }
+
+    sys_lock();
+
+    voice_p = find_voice(self_p, channel, note);
+
+    if (voice_p == NULL) {
+        voice_p = allocate_voice(self_p);
+    }
+
+    start_voice(self_p, voice_p, channel, note, velocity);
+
+    sys_unlock();
+
+    return (0);
+}
+
+int mixer_note_off(struct mixer_t *self_p, int channel, int note)
+{
+    ASSERTN(self_p != NULL, EINVAL);
+
+    struct mixer_voice_t *voice_p;
+
+    sys_lock();
+
+    voice_p = find_voice(self_p, channel, note);
+
+    if (voice_p != NULL) {
+        voice_p->released = 1;
+    }
+
+    sys_unlock();
+
+    return (0);
+}
+
+int mixer_all_notes_off(struct mixer_t *self_p)
+{
+    ASSERTN(self_p != NULL, EINVAL);
+
+    int i;
+
+    sys_lock();
+
+    for (i = 0; i < membersof(self_p->voices); i++) {
+        self_p->voices[i].released = 1;
+    }
+
+    sys_unlock();
+
+    return (0);
+}
+
+int mixer_get_active_voices(struct mixer_t *self_p)
+{
+    ASSERTN(self_p != NULL, EINVAL);
+
+    int i;
+    int count;
+
+    count = 0;
+
+    for (i = 0; i < membersof(self_p->voices); i++) {
+        if (self_p->voices[i].state != MIXER_VOICE_STATE_IDLE) {
+            count++;
+        }
+    }
+
+    return (count);
+}
+
+uint32_t mixer_get_stolen_voices(struct mixer_t *self_p)
+{
+    return (self_p->stolen);
+}
+
+int mixer_render(struct mixer_t *self_p,
+                 int32_t *samples_p,
+                 size_t length)
+{
+    ASSERTN(self_p != NULL, EINVAL);
+    ASSERTN(samples_p != NULL, EINVAL);
+
+    return (render(self_p, samples_p, length, sys_lock, sys_unlock));
+}
+
+int mixer_render_isr(struct mixer_t *self_p,
+                     int32_t *samples_p,
+                     size_t length)
+{
+    return (render(self_p, samples_p, length, sys_lock_isr, sys_unlock_isr));
+}
+
+int mixer_render_dac(struct mixer_t *self_p,
+                     uint32_t *samples_p,
+                     size_t length)
+{
+    ASSERTN(self_p != NULL, EINVAL);
+    ASSERTN(samples_p != NULL, EINVAL);
+
+    render_dac(self_p, samples_p, length, sys_lock, sys_unlock);
+
+    return (0);
+}
+
+size_t mixer_dac_stream_fill_isr(void *arg_p,
+                                 void *samples_p,
+                                 size_t length)
+{
+    render_dac(arg_p, samples_p, length, sys_lock_isr, sys_unlock_isr);
+
+    return (length);
+}
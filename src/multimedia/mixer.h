@@ -0,0 +1,297 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2014-2018, Erik Moqvist
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use, copy,
+ * modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ * This file is part of the Simba project.
+ */
+
+#ifndef __MULTIMEDIA_MIXER_H__
+#define __MULTIMEDIA_MIXER_H__
+
+#include "simba.h"
+
+/** Number of MIDI channels. */
+#define MIXER_CHANNELS_MAX                                   16
+
+/** Length of the built-in waveforms. */
+#define MIXER_WAVEFORM_LENGTH                               256
+
+/* Voice states. */
+#define MIXER_VOICE_STATE_IDLE                                0
+#define MIXER_VOICE_STATE_ATTACK                              1
+#define MIXER_VOICE_STATE_DECAY                               2
+#define MIXER_VOICE_STATE_SUSTAIN                             3
+#define MIXER_VOICE_STATE_RELEASE                             4
+
+/**
+ * A voice playing one note, a wavetable oscillator and an envelope.
+ */
+struct mixer_voice_t {
+    uint32_t age;
+    uint32_t phase;
+    uint32_t phase_increment;
+    int32_t level;
+    int32_t increment;
+    uint32_t remaining;
+    int32_t peak;
+    int32_t sustain;
+    uint8_t channel;
+    uint8_t note;
+    uint8_t state;
+    uint8_t released;
+};
+
+/**
+ * Per MIDI channel configuration.
+ */
+struct mixer_channel_t {
+    const FAR int16_t *waveform_p;
+    uint16_t mask;
+    uint8_t shift;
+    uint8_t muted;
+};
+
+/**
+ * A polyphonic mixer.
+ */
+struct mixer_t {
+    int sample_rate;
+    int output_shift;
+    uint32_t age;
+    struct {
+        uint32_t attack;
+        uint32_t decay;
+        int32_t sustain;
+        uint32_t release;
+    } envelope;
+    struct mixer_channel_t channels[MIXER_CHANNELS_MAX];
+    struct mixer_voice_t voices[CONFIG_MIXER_VOICES_MAX];
+    int32_t block[CONFIG_MIXER_BLOCK_LENGTH];
+    uint32_t stolen;
+};
+
+/** One cycle of a sine wave, in Q15. */
+extern const FAR int16_t mixer_waveform_sine[MIXER_WAVEFORM_LENGTH];
+
+/** One cycle of a square wave, in Q15. */
+extern const FAR int16_t mixer_waveform_square[MIXER_WAVEFORM_LENGTH];
+
+/** One cycle of a saw wave, in Q15. */
+extern const FAR int16_t mixer_waveform_saw[MIXER_WAVEFORM_LENGTH];
+
+/**
+ * Initialize given mixer. All channels play the built-in sine wave,
+ * the envelope has no attack, decay or release and full sustain,
+ * and the output shift is 8.
+ *
+ * @param[out] self_p Mixer to initialize.
+ * @param[in] sample_rate Sample rate in Hz.
+ *
+ * @return zero(0) or negative error code.
+ */
+int mixer_init(struct mixer_t *self_p, int sample_rate);
+
+/**
+ * Set the waveform played by the voices of given channel. Voices
+ * already playing switch waveform immediately.
+ *
+ * @param[in] self_p Initialized mixer.
+ * @param[in] channel MIDI channel, 0 to 15.
+ * @param[in] waveform_p One cycle of the waveform in Q15. It is read
+ *                       while rendering, and must not be modified or
+ *                       freed while in use.
+ * @param[in] length Number of samples in the waveform, a power of
+ *                   two from 2 to 65536.
+ *
+ * @return zero(0) or negative error code.
+ */
+int mixer_set_waveform(struct mixer_t *self_p,
+                       int channel,
+                       const FAR int16_t *waveform_p,
+                       size_t length);
+
+/**
+ * Set the envelope of notes started after this call. The amplitude
+ * rises linearly to the velocity during the attack, falls linearly
+ * to the sustain level during the decay, and falls linearly to zero
+ * during the release, after the note off. A note with zero sustain
+ * ends after the decay.
+ *
+ * @param[in] self_p Initialized mixer.
+ * @param[in] attack Attack time in samples.
+ * @param[in] decay Decay time in samples.
+ * @param[in] sustain Sustain level in Q15, 0 to 32767.
+ * @param[in] release Release time in samples.
+ *
+ * @return zero(0) or negative error code.
+ */
+int mixer_set_envelope(struct mixer_t *self_p,
+                       uint32_t attack,
+                       uint32_t decay,
+                       int sustain,
+                       uint32_t release);
+
+/**
+ * Mute or unmute given channel. The voices of a muted channel are
+ * neither rendered nor advanced.
+ *
+ * @param[in] self_p Initialized mixer.
+ * @param[in] channel MIDI channel, 0 to 15.
+ * @param[in] muted true(1) to mute, false(0) to unmute.
+ *
+ * @return zero(0) or negative error code.
+ */
+int mixer_set_muted(struct mixer_t *self_p, int channel, int muted);
+
+/**
+ * Set the right shift applied to the mixed signal in
+ * `mixer_render_dac()`. Each full scale voice adds 15 bits of
+ * amplitude, so 8 never clips 16 full scale voices on a 12 bits
+ * DAC. Smaller shifts are louder, and the output saturates.
+ *
+ * @param[in] self_p Initialized mixer.
+ * @param[in] shift Right shift, 0 to 31.
+ *
+ * @return zero(0) or negative error code.
+ */
+int mixer_set_output_shift(struct mixer_t *self_p, int shift);
+
+/**
+ * Start playing given note. The voice already playing the note on
+ * the channel is restarted, otherwise an idle voice is used. If all
+ * voices are busy, the quietest voice in its release phase is
+ * stolen, or the oldest voice if none is releasing.
+ *
+ * @param[in] self_p Initialized mixer.
+ * @param[in] channel MIDI channel, 0 to 15.
+ * @param[in] note MIDI note, 0 to 127.
+ * @param[in] velocity MIDI velocity, 1 to 127. Zero(0) is a note
+ *                     off, as in MIDI.
+ *
+ * @return zero(0) or negative error code.
+ */
+int mixer_note_on(struct mixer_t *self_p,
+                  int channel,
+                  int note,
+                  int velocity);
+
+/**
+ * Start the release phase of given note, if playing.
+ *
+ * @param[in] self_p Initialized mixer.
+ * @param[in] channel MIDI channel, 0 to 15.
+ * @param[in] note MIDI note, 0 to 127.
+ *
+ * @return zero(0) or negative error code.
+ */
+int mixer_note_off(struct mixer_t *self_p, int channel, int note);
+
+/**
+ * Start the release phase of all notes on all channels.
+ *
+ * @param[in] self_p Initialized mixer.
+ *
+ * @return zero(0) or negative error code.
+ */
+int mixer_all_notes_off(struct mixer_t *self_p);
+
+/**
+ * Get the number of voices playing a note, including voices in the
+ * release phase.
+ *
+ * @param[in] self_p Initialized mixer.
+ *
+ * @return Number of active voices.
+ */
+int mixer_get_active_voices(struct mixer_t *self_p);
+
+/**
+ * Get the number of voices stolen by `mixer_note_on()` since the
+ * mixer was initialized.
+ *
+ * @param[in] self_p Initialized mixer.
+ *
+ * @return Number of stolen voices.
+ */
+uint32_t mixer_get_stolen_voices(struct mixer_t *self_p);
+
+/**
+ * Render and mix the next samples of all voices, one block of
+ * ``CONFIG_MIXER_BLOCK_LENGTH`` samples at a time. A full scale
+ * voice is 32767.
+ *
+ * Rendering is done without the system lock held, except when
+ * loading and storing the state of each voice, so notes can be
+ * started and stopped by other threads and interrupts while
+ * rendering.
+ *
+ * @param[in] self_p Initialized mixer.
+ * @param[out] samples_p Mixed samples.
+ * @param[in] length Number of samples to render.
+ *
+ * @return zero(0) or negative error code.
+ */
+int mixer_render(struct mixer_t *self_p,
+                 int32_t *samples_p,
+                 size_t length);
+
+/**
+ * Same as `mixer_render()`, but may only be called from an
+ * interrupt service routine, or with the system lock taken.
+ */
+int mixer_render_isr(struct mixer_t *self_p,
+                     int32_t *samples_p,
+                     size_t length);
+
+/**
+ * Render and mix the next samples, and convert them to 12 bits
+ * unsigned DAC samples centered at 2048, as given to
+ * `dac_async_convert()`.
+ *
+ * @param[in] self_p Initialized mixer.
+ * @param[out] samples_p DAC samples.
+ * @param[in] length Number of samples to render.
+ *
+ * @return zero(0) or negative error code.
+ */
+int mixer_render_dac(struct mixer_t *self_p,
+                     uint32_t *samples_p,
+                     size_t length);
+
+/**
+ * DAC stream fill callback rendering the mixer given as ``arg_p``,
+ * to be given to `dac_stream_init()`. The samples are rendered in
+ * interrupt context when a buffer has been converted.
+ *
+ * @param[in] arg_p Initialized mixer.
+ * @param[out] samples_p DAC samples.
+ * @param[in] length Number of samples to render.
+ *
+ * @return Number of rendered samples, always length.
+ */
+size_t mixer_dac_stream_fill_isr(void *arg_p,
+                                 void *samples_p,
+                                 size_t length);
+
+#endif
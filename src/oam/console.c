@@ -45,7 +45,7 @@ int console_module_init(void)
     return (uart_module_init());
 }
 
-int console_init(void)
+static int backend_init(void)
 {
     return (uart_init(&module.console.uart,
                       &uart_device[CONFIG_START_CONSOLE_DEVICE_INDEX],
@@ -79,7 +79,7 @@ void *console_set_output_channel(void *chan_p)
     return (NULL);
 }
 
-void *console_get_output_channel()
+static void *backend_get_output_channel(void)
 {
     return (&module.console.uart.base);
 }
@@ -93,6 +93,9 @@ struct module_t {
         struct usb_device_driver_base_t *drivers[1];
         struct usb_device_class_cdc_driver_t cdc;
         uint8_t rxbuf[32];
+#if CONFIG_START_CONSOLE_USB_CDC_TX_BUFFER_SIZE > 0
+        uint8_t txbuf[CONFIG_START_CONSOLE_USB_CDC_TX_BUFFER_SIZE];
+#endif
     } console;
 };
 
@@ -106,7 +109,7 @@ int console_module_init(void)
     return (0);
 }
 
-int console_init(void)
+static int backend_init(void)
 {
     /* Initialize the CDC driver object. */
     usb_device_class_cdc_init(&module.console.cdc,
@@ -115,6 +118,11 @@ int console_init(void)
                               3,
                               module.console.rxbuf,
                               sizeof(module.console.rxbuf));
+#if CONFIG_START_CONSOLE_USB_CDC_TX_BUFFER_SIZE > 0
+    usb_device_class_cdc_set_tx_buffer(&module.console.cdc,
+                                       module.console.txbuf,
+                                       sizeof(module.console.txbuf));
+#endif
     module.console.drivers[0] = &module.console.cdc.base;
 
     /* Initialize the USB device driver. */
@@ -165,7 +173,7 @@ void *console_set_output_channel(void *chan_p)
     return (NULL);
 }
 
-void *console_get_output_channel(void)
+static void *backend_get_output_channel(void)
 {
     return (&module.console.cdc.chout);
 }
@@ -196,7 +204,7 @@ int console_module_init(void)
     return (0);
 }
 
-int console_init(void)
+static int backend_init(void)
 {
     return (0);
 }
@@ -230,7 +238,7 @@ void *console_set_output_channel(void *chan_p)
     return (0);
 }
 
-void *console_get_output_channel(void)
+static void *backend_get_output_channel(void)
 {
     return (module.console.chout_p);
 }
@@ -238,3 +246,313 @@ void *console_get_output_channel(void)
 #else
 #    error "Bad console."
 #endif
+
+#if CONFIG_START_CONSOLE_OUTPUT_BUFFER_SIZE > 0
+
+/* Buffered console output, sent to the console device by the drain
+   thread. */
+struct output_t {
+    struct chan_t base;
+    struct chan_t priority;
+    int policy;
+    uint32_t dropped;
+    size_t head;
+    size_t tail;
+    size_t size;
+    char buf[CONFIG_START_CONSOLE_OUTPUT_BUFFER_SIZE];
+    struct thrd_t *drain_thrd_p;
+    struct thrd_prio_list_t writers;
+};
+
+static struct output_t output;
+static THRD_STACK(drain_stack, CONFIG_START_CONSOLE_OUTPUT_STACK_SIZE);
+
+static void output_put_isr(const char *buf_p, size_t size)
+{
+    while (size > 0) {
+        output.buf[output.head] = *buf_p++;
+        output.head++;
+
+        if (output.head == sizeof(output.buf)) {
+            output.head = 0;
+        }
+
+        output.size++;
+        size--;
+    }
+}
+
+static void output_skip_isr(size_t size)
+{
+    output.tail += size;
+
+    if (output.tail >= sizeof(output.buf)) {
+        output.tail -= sizeof(output.buf);
+    }
+
+    output.size -= size;
+}
+
+/**
+ * Write given data to the output buffer, waiting for free space or
+ * dropping data according to given policy if the buffer is full.
+ */
+static ssize_t output_write_policy(const void *buf_p,
+                                   size_t size,
+                                   int policy)
+{
+    struct thrd_prio_list_elem_t elem;
+    const char *c_buf_p;
+    size_t left;
+    size_t n;
+
+    c_buf_p = buf_p;
+    left = size;
+
+    sys_lock();
+
+    switch (policy) {
+
+    case CONFIG_START_CONSOLE_OUTPUT_POLICY_DROP_OLDEST:
+        /* Only the end of the data fits in the buffer. */
+        if (left > sizeof(output.buf)) {
+            n = (left - sizeof(output.buf));
+            output.dropped += n;
+            c_buf_p += n;
+            left -= n;
+        }
+
+        n = (sizeof(output.buf) - output.size);
+
+        if (left > n) {
+            output.dropped += (left - n);
+            output_skip_isr(left - n);
+        }
+
+        output_put_isr(c_buf_p, left);
+        break;
+
+    case CONFIG_START_CONSOLE_OUTPUT_POLICY_DROP_NEWEST:
+        n = MIN(left, sizeof(output.buf) - output.size);
+        output.dropped += (left - n);
+        output_put_isr(c_buf_p, n);
+        break;
+
+    default:
+        while (1) {
+            n = MIN(left, sizeof(output.buf) - output.size);
+            output_put_isr(c_buf_p, n);
+            c_buf_p += n;
+            left -= n;
+
+            if (left == 0) {
+                break;
+            }
+
+            /* Wait for the drain thread to make room. */
+            if (output.drain_thrd_p != NULL) {
+                thrd_resume_isr(output.drain_thrd_p, 0);
+                output.drain_thrd_p = NULL;
+            }
+
+            elem.thrd_p = thrd_self();
+            thrd_prio_list_push_isr(&output.writers, &elem);
+            thrd_suspend_isr(NULL);
+        }
+
+        break;
+    }
+
+    if ((output.drain_thrd_p != NULL) && (output.size > 0)) {
+        thrd_resume_isr(output.drain_thrd_p, 0);
+        output.drain_thrd_p = NULL;
+    }
+
+    sys_unlock();
+
+    return (size);
+}
+
+static ssize_t output_write(void *self_p, const void *buf_p, size_t size)
+{
+    return (output_write_policy(buf_p, size, output.policy));
+}
+
+static ssize_t output_priority_write(void *self_p,
+                                     const void *buf_p,
+                                     size_t size)
+{
+    return (output_write_policy(buf_p,
+                                size,
+                                CONFIG_START_CONSOLE_OUTPUT_POLICY_BLOCK));
+}
+
+/**
+ * Move at most given number of bytes from the output buffer to given
+ * buffer, and let blocked writers continue.
+ */
+static size_t output_take_isr(char *buf_p, size_t size)
+{
+    struct thrd_prio_list_elem_t *elem_p;
+    size_t n;
+
+    size = MIN(output.size, size);
+    n = MIN(size, sizeof(output.buf) - output.tail);
+    memcpy(buf_p, &output.buf[output.tail], n);
+    memcpy(&buf_p[n], &output.buf[0], size - n);
+    output_skip_isr(size);
+
+    while ((elem_p = thrd_prio_list_pop_isr(&output.writers)) != NULL) {
+        thrd_resume_isr(elem_p->thrd_p, 0);
+    }
+
+    return (size);
+}
+
+static void *drain_main(void *arg_p)
+{
+    char buf[32];
+    size_t size;
+
+    thrd_set_name("console");
+
+    while (1) {
+        sys_lock();
+
+        if (output.size == 0) {
+            output.drain_thrd_p = thrd_self();
+            thrd_suspend_isr(NULL);
+        }
+
+        size = output_take_isr(&buf[0], sizeof(buf));
+        sys_unlock();
+
+        chan_write(backend_get_output_channel(), &buf[0], size);
+    }
+
+    return (NULL);
+}
+
+static int output_init(void)
+{
+    chan_init(&output.base,
+              chan_read_null,
+              output_write,
+              chan_size_null);
+    chan_init(&output.priority,
+              chan_read_null,
+              output_priority_write,
+              chan_size_null);
+    output.policy = CONFIG_START_CONSOLE_OUTPUT_POLICY;
+    output.dropped = 0;
+    output.head = 0;
+    output.tail = 0;
+    output.size = 0;
+    output.drain_thrd_p = NULL;
+    thrd_prio_list_init(&output.writers);
+
+    if (thrd_spawn(drain_main,
+                   NULL,
+                   CONFIG_START_CONSOLE_OUTPUT_PRIO,
+                   drain_stack,
+                   sizeof(drain_stack)) == NULL) {
+        return (-ENOMEM);
+    }
+
+    return (0);
+}
+
+int console_init(void)
+{
+    int res;
+
+    res = backend_init();
+
+    if (res != 0) {
+        return (res);
+    }
+
+    return (output_init());
+}
+
+void *console_get_output_channel(void)
+{
+    return (&output.base);
+}
+
+void *console_get_priority_output_channel(void)
+{
+    return (&output.priority);
+}
+
+int console_flush(void)
+{
+    char buf[32];
+    size_t size;
+
+    while (1) {
+        sys_lock();
+        size = output_take_isr(&buf[0], sizeof(buf));
+        sys_unlock();
+
+        if (size == 0) {
+            break;
+        }
+
+        chan_write(backend_get_output_channel(), &buf[0], size);
+    }
+
+    return (0);
+}
+
+int console_set_output_policy(int policy)
+{
+    if ((policy != CONFIG_START_CONSOLE_OUTPUT_POLICY_BLOCK)
+        && (policy != CONFIG_START_CONSOLE_OUTPUT_POLICY_DROP_OLDEST)
+        && (policy != CONFIG_START_CONSOLE_OUTPUT_POLICY_DROP_NEWEST)) {
+        return (-EINVAL);
+    }
+
+    output.policy = policy;
+
+    return (0);
+}
+
+uint32_t console_get_output_dropped(void)
+{
+    return (output.dropped);
+}
+
+#else
+
+int console_init(void)
+{
+    return (backend_init());
+}
+
+void *console_get_output_channel(void)
+{
+    return (backend_get_output_channel());
+}
+
+void *console_get_priority_output_channel(void)
+{
+    return (backend_get_output_channel());
+}
+
+int console_flush(void)
+{
+    return (0);
+}
+
+int console_set_output_policy(int policy)
+{
+    return (-ENOSYS);
+}
+
+uint32_t console_get_output_dropped(void)
+{
+    return (0);
+}
+
+#endif
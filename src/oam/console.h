@@ -85,10 +85,48 @@ void *console_get_input_channel(void);
 void *console_set_output_channel(void *chan_p);
 
 /**
- * Get the pointer to the output channel.
+ * Get the pointer to the output channel. Writes to it are buffered,
+ * and data may be dropped according to the output policy, if
+ * ``CONFIG_START_CONSOLE_OUTPUT_BUFFER_SIZE`` is greater than
+ * zero(0).
  *
  * @return Output channel or NULL.
  */
 void *console_get_output_channel(void);
 
+/**
+ * Get the pointer to the priority output channel, used by the shell.
+ * Writes to it share the output buffer with the output channel, but
+ * are never dropped. They wait for room in the buffer instead.
+ *
+ * @return Priority output channel or NULL.
+ */
+void *console_get_priority_output_channel(void);
+
+/**
+ * Write all buffered output to the console device from the calling
+ * thread.
+ *
+ * @return zero(0) or negative error code.
+ */
+int console_flush(void);
+
+/**
+ * Set what to do when the output buffer is full.
+ *
+ * @param[in] policy One of ``CONFIG_START_CONSOLE_OUTPUT_POLICY_BLOCK``,
+ *                   ``CONFIG_START_CONSOLE_OUTPUT_POLICY_DROP_OLDEST`` and
+ *                   ``CONFIG_START_CONSOLE_OUTPUT_POLICY_DROP_NEWEST``.
+ *
+ * @return zero(0) or negative error code.
+ */
+int console_set_output_policy(int policy);
+
+/**
+ * Get the number of dropped output bytes.
+ *
+ * @return Number of dropped bytes.
+ */
+uint32_t console_get_output_dropped(void);
+
 #endif
@@ -28,7 +28,9 @@
 
 #include "simba.h"
 
-#if CONFIG_NVM_EEPROM_SOFT == 1
+#if CONFIG_NVM_EEPROM_JOURNAL == 1
+#    include "ports/nvm_port_eeprom_journal.h"
+#elif CONFIG_NVM_EEPROM_SOFT == 1
 #    include "ports/nvm_port_eeprom_soft.h"
 #else
 #    include "nvm_port.h"
@@ -47,7 +49,9 @@ struct module_t {
 
 static struct module_t module;
 
-#if CONFIG_NVM_EEPROM_SOFT == 1
+#if CONFIG_NVM_EEPROM_JOURNAL == 1
+#    include "ports/nvm_port_eeprom_journal.i"
+#elif CONFIG_NVM_EEPROM_SOFT == 1
 #    include "ports/nvm_port_eeprom_soft.i"
 #else
 #    include "nvm_port.i"
@@ -208,3 +212,14 @@ ssize_t nvm_vwrite(struct iov_uintptr_t *dst_p,
 
     return (nvm_port_vwrite(dst_p, src_p, length));
 }
+
+int nvm_compact()
+{
+    ASSERTN(module.initialized == 1, EINVAL);
+
+#if CONFIG_NVM_EEPROM_JOURNAL == 1
+    return (nvm_port_compact());
+#else
+    return (0);
+#endif
+}
@@ -97,4 +97,15 @@ ssize_t nvm_vwrite(struct iov_uintptr_t *dst_p,
                    struct iov_t *src_p,
                    size_t length);
 
+/**
+ * Compact the non-volatile memory, if supported by the
+ * implementation. Only the journaled software EEPROM implementation
+ * needs compaction, which otherwise is done by a write when the
+ * journal is full. Call this function from a low priority thread to
+ * avoid slow writes.
+ *
+ * @return zero(0) or negative error code.
+ */
+int nvm_compact(void);
+
 #endif
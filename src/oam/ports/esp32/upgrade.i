@@ -31,10 +31,20 @@
 #include "esp_ota_ops.h"
 
 #define STAY_MAGIC "stay"
+#define VERIFIED_MAGIC 0x56455249
+
+/* Written after the application was verified, just before its SHA1
+   and size at the end of the partition. */
+struct verified_marker_t {
+    uint32_t magic;
+    uint32_t size;
+    uint8_t sha1[20];
+};
 
 struct application_t {
     const esp_partition_t *partition_p;
     size_t offset;
+    size_t erased;
 };
 
 static struct application_t application;
@@ -98,6 +108,53 @@ static int application_sha1(uint8_t *dst_p, size_t size)
     return (0);
 }
 
+static size_t get_verified_marker_offset(const esp_partition_t *partition_p)
+{
+    return (partition_p->size
+            - sizeof(module.header.size)
+            - sizeof(module.header.sha1)
+            - sizeof(struct verified_marker_t));
+}
+
+static int verified_marker_read(const esp_partition_t *partition_p,
+                                struct verified_marker_t *marker_p)
+{
+    if (esp_esp_partition_read(partition_p,
+                               get_verified_marker_offset(partition_p),
+                               marker_p,
+                               sizeof(*marker_p)) != ESP_OK) {
+        return (-1);
+    }
+
+    return (0);
+}
+
+/**
+ * Record that the application with given size and SHA1 has been
+ * verified. The marker is erased along with the size and SHA1 when
+ * the next upload begins, so a marker never outlives its
+ * application.
+ */
+static int verified_marker_write(const esp_partition_t *partition_p,
+                                 uint32_t size,
+                                 const uint8_t *sha1_p)
+{
+    struct verified_marker_t marker;
+
+    marker.magic = VERIFIED_MAGIC;
+    marker.size = size;
+    memcpy(&marker.sha1[0], sha1_p, sizeof(marker.sha1));
+
+    if (esp_esp_partition_write(partition_p,
+                                get_verified_marker_offset(partition_p),
+                                &marker,
+                                sizeof(marker)) != ESP_OK) {
+        return (-1);
+    }
+
+    return (0);
+}
+
 static int upgrade_port_bootloader_enter()
 {
     const esp_partition_t *partition_p;
@@ -197,7 +254,9 @@ static int upgrade_port_application_enter()
 {
     const esp_partition_t *partition_p;
 
-    if (upgrade_application_is_valid(1) != 1) {
+    /* Only hashes the application if it has not been verified
+       earlier. */
+    if (upgrade_application_is_valid(0) != 1) {
         return (-1);
     }
 
@@ -248,6 +307,7 @@ static int upgrade_port_application_erase()
 static int upgrade_port_application_is_valid(int quick)
 {
     static const esp_partition_t *partition_p;
+    struct verified_marker_t marker;
     uint8_t expected_sha1[20];
     uint8_t sha1[20];
     size_t size;
@@ -282,13 +342,49 @@ static int upgrade_port_application_is_valid(int quick)
         memset(&sha1[0], 0xff, sizeof(sha1));
 
         return (memcmp(&sha1[0], &expected_sha1[0], sizeof(sha1)) != 0);
-    } else {
-        if (application_sha1(&sha1[0], size) != 0) {
-            return (-1);
-        }
+    }
 
-        return (memcmp(&sha1[0], &expected_sha1[0], sizeof(sha1)) == 0);
+    if (verified_marker_read(partition_p, &marker) != 0) {
+        return (-1);
     }
+
+    /* No need to hash an application that has already been
+       verified. */
+    if (marker.magic == VERIFIED_MAGIC) {
+        return ((marker.size == size)
+                && (memcmp(&marker.sha1[0],
+                           &expected_sha1[0],
+                           sizeof(marker.sha1)) == 0));
+    }
+
+    if (application_sha1(&sha1[0], size) != 0) {
+        return (-1);
+    }
+
+    if (memcmp(&sha1[0], &expected_sha1[0], sizeof(sha1)) != 0) {
+        return (0);
+    }
+
+    /* Only write the marker if erased, as flash bits can only be
+       cleared. The application is valid even if the write fails. */
+    memset(&sha1[0], 0xff, sizeof(sha1));
+
+    if ((marker.magic == 0xffffffff)
+        && (marker.size == 0xffffffff)
+        && (memcmp(&marker.sha1[0], &sha1[0], sizeof(sha1)) == 0)) {
+        verified_marker_write(partition_p, size, &expected_sha1[0]);
+    }
+
+    return (1);
+}
+
+static int upgrade_port_application_read(void *dst_p,
+                                         size_t src,
+                                         size_t size)
+{
+    /* The application partition is erased and written during the
+       upload, so there is no current application to patch. */
+    return (-ENOSYS);
 }
 
 static int upgrade_port_binary_upload_begin()
@@ -301,6 +397,17 @@ static int upgrade_port_binary_upload_begin()
     }
 
     application.offset = 0;
+    application.erased = 0;
+
+    /* Invalidate the current application by erasing the last sector
+       with its size and SHA1. The other sectors are erased just
+       before written, instead of all up front. */
+    if (esp_esp_partition_erase_range(
+            application.partition_p,
+            application.partition_p->size - SPI_FLASH_SEC_SIZE,
+            SPI_FLASH_SEC_SIZE) != ESP_OK) {
+        return (-1);
+    }
 
     return (0);
 }
@@ -308,6 +415,22 @@ static int upgrade_port_binary_upload_begin()
 static int upgrade_port_binary_upload(const void *buf_p,
                                       size_t size)
 {
+    while (application.offset + size > application.erased) {
+        if (application.erased
+            >= application.partition_p->size - SPI_FLASH_SEC_SIZE) {
+            std_printf(FSTR("error: application too big\r\n"));
+            return (-1);
+        }
+
+        if (esp_esp_partition_erase_range(application.partition_p,
+                                          application.erased,
+                                          SPI_FLASH_SEC_SIZE) != ESP_OK) {
+            return (-1);
+        }
+
+        application.erased += SPI_FLASH_SEC_SIZE;
+    }
+
     if (esp_esp_partition_write(application.partition_p,
                                 application.offset,
                                 buf_p,
@@ -339,7 +462,15 @@ static int upgrade_port_binary_upload_end()
         return (-1);
     }
 
-    if (upgrade_application_is_valid(0) != 1) {
+    /* The data was hashed by upgrade_binary_upload() while written,
+       so the next boot does not have to hash it again. */
+    if (upgrade_application_is_valid(1) != 1) {
+        return (-1);
+    }
+
+    if (verified_marker_write(application.partition_p,
+                              module.header.size,
+                              &module.header.sha1[0]) != 0) {
         return (-1);
     }
 
@@ -71,6 +71,13 @@ static int upgrade_port_application_is_valid()
     return (0);
 }
 
+static int upgrade_port_application_read(void *dst_p,
+                                         size_t src,
+                                         size_t size)
+{
+    return (-ENOSYS);
+}
+
 static int upgrade_port_binary_upload_begin()
 {
     return (0);
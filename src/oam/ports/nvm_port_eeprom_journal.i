@@ -0,0 +1,106 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2014-2018, Erik Moqvist
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use, copy,
+ * modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ * This file is part of the Simba project.
+ */
+/* Same blocks as the software EEPROM implementation, which makes
+   images created by the build system usable. */
+uint8_t nvm_eeprom_soft_block_0[CONFIG_NVM_EEPROM_SOFT_BLOCK_0_SIZE]
+__attribute__ ((section (".nvm.eeprom_soft.block_0"), weak));
+
+uint8_t nvm_eeprom_soft_block_1[CONFIG_NVM_EEPROM_SOFT_BLOCK_1_SIZE]
+__attribute__ ((section (".nvm.eeprom_soft.block_1"), weak));
+
+static int nvm_port_module_init(void)
+{
+    int res;
+
+    res = eeprom_journal_module_init();
+
+    if (res != 0) {
+        return (res);
+    }
+
+    res = flash_init(&module.port.flash,
+                     &flash_device[CONFIG_NVM_EEPROM_SOFT_FLASH_DEVICE_INDEX]);
+
+    if (res != 0) {
+        return (res);
+    }
+
+    module.port.blocks[0].address = (uintptr_t)&nvm_eeprom_soft_block_0[0];
+    module.port.blocks[0].size = sizeof(nvm_eeprom_soft_block_0);
+    module.port.blocks[1].address = (uintptr_t)&nvm_eeprom_soft_block_1[0];
+    module.port.blocks[1].size = sizeof(nvm_eeprom_soft_block_1);
+
+    return (eeprom_journal_init(&module.port.eeprom_journal,
+                                &module.port.flash,
+                                &module.port.blocks[0],
+                                membersof(module.port.blocks),
+                                CONFIG_NVM_SIZE,
+                                CONFIG_NVM_EEPROM_JOURNAL_PAGE_SIZE,
+                                &module.port.index[0]));
+}
+
+static int nvm_port_mount()
+{
+    return (eeprom_journal_mount(&module.port.eeprom_journal));
+}
+
+static int nvm_port_format()
+{
+    return (eeprom_journal_format(&module.port.eeprom_journal));
+}
+
+static ssize_t nvm_port_read(void *dst_p, size_t src, size_t size)
+{
+    return (eeprom_journal_read(&module.port.eeprom_journal,
+                                dst_p,
+                                src,
+                                size));
+}
+
+static ssize_t nvm_port_write(size_t dst, const void *src_p, size_t size)
+{
+    return (eeprom_journal_write(&module.port.eeprom_journal,
+                                 dst,
+                                 src_p,
+                                 size));
+}
+
+static ssize_t nvm_port_vwrite(struct iov_uintptr_t *dst_p,
+                               struct iov_t *src_p,
+                               size_t length)
+{
+    return (eeprom_journal_vwrite(&module.port.eeprom_journal,
+                                  dst_p,
+                                  src_p,
+                                  length));
+}
+
+static int nvm_port_compact()
+{
+    return (eeprom_journal_compact(&module.port.eeprom_journal));
+}
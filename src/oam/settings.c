@@ -28,6 +28,9 @@
 
 #include "simba.h"
 
+#define MIRROR_NUMBER_OF_BLOCKS                                 \
+    DIV_CEIL(CONFIG_SETTINGS_AREA_SIZE, CONFIG_SETTINGS_MIRROR_BLOCK_SIZE)
+
 struct module_t {
     int8_t initialized;
 #if CONFIG_SETTINGS_FS_COMMAND_LIST == 1
@@ -42,6 +45,16 @@ struct module_t {
 #if CONFIG_SETTINGS_FS_COMMAND_WRITE == 1
     struct fs_command_t cmd_write;
 #endif
+#if CONFIG_SETTINGS_MIRROR == 1
+#    if CONFIG_SETTINGS_FS_COMMAND_WRITE == 1
+    struct fs_command_t cmd_flush;
+#    endif
+    struct {
+        int8_t loaded;
+        uint8_t dirty[DIV_CEIL(MIRROR_NUMBER_OF_BLOCKS, 8)];
+        uint8_t buf[CONFIG_SETTINGS_AREA_SIZE];
+    } mirror;
+#endif
 };
 
 static struct module_t module;
@@ -50,24 +63,176 @@ extern const FAR struct setting_t settings[];
 const FAR uint8_t settings_default[CONFIG_SETTINGS_AREA_SIZE]
 __attribute__ ((weak)) = { 0xff, };
 
+/* Replaced by the hash table generated by simbagen.py. Builds
+   without it, for example Arduino IDE builds, search the settings
+   array linearly. */
+const FAR struct settings_hash_t settings_hash
+__attribute__ ((weak)) = { NULL, 0, 0 };
+
+/**
+ * FNV-1a hash of given name, the same as in simbagen.py.
+ */
+static uint32_t hash_name(const char *name_p, uint32_t seed)
+{
+    uint32_t hash;
+
+    hash = (2166136261UL ^ seed);
+
+    while (*name_p != '\0') {
+        hash ^= (uint8_t)*name_p++;
+        hash *= 16777619UL;
+    }
+
+    return (hash);
+}
+
 static const FAR struct setting_t *get_setting_by_name(
     const char *name_p)
 {
     const FAR struct setting_t *setting_p;
+    uint16_t index;
 
-    setting_p = &settings[0];
+    if (settings_hash.indexes_p == NULL) {
+        setting_p = &settings[0];
 
-    while (setting_p->name_p != NULL) {
-        if (std_strcmp(name_p, setting_p->name_p) == 0) {
-            return (setting_p);
+        while (setting_p->name_p != NULL) {
+            if (std_strcmp(name_p, setting_p->name_p) == 0) {
+                return (setting_p);
+            }
+
+            setting_p++;
         }
 
-        setting_p++;
+        return (NULL);
+    }
+
+    index = settings_hash.indexes_p[hash_name(name_p, settings_hash.seed)
+                                    & settings_hash.mask];
+
+    if (index == 0) {
+        return (NULL);
+    }
+
+    setting_p = &settings[index - 1];
+
+    if (std_strcmp(name_p, setting_p->name_p) != 0) {
+        return (NULL);
+    }
+
+    return (setting_p);
+}
+
+#if CONFIG_SETTINGS_MIRROR == 1
+
+static int mirror_load(void)
+{
+    if (module.mirror.loaded == 1) {
+        return (0);
+    }
+
+    if (nvm_read(&module.mirror.buf[0],
+                 0,
+                 sizeof(module.mirror.buf)) != sizeof(module.mirror.buf)) {
+        return (-EIO);
+    }
+
+    module.mirror.loaded = 1;
+
+    return (0);
+}
+
+static int is_mirrored(size_t address, size_t size)
+{
+    return ((address < CONFIG_SETTINGS_AREA_SIZE)
+            && (size <= CONFIG_SETTINGS_AREA_SIZE - address));
+}
+
+static ssize_t mirror_read(void *dst_p, size_t src, size_t size)
+{
+    if (mirror_load() != 0) {
+        return (-EIO);
+    }
+
+    memcpy(dst_p, &module.mirror.buf[src], size);
+
+    return (size);
+}
+
+static ssize_t mirror_write(size_t dst, const void *src_p, size_t size)
+{
+    const uint8_t *s_p;
+    size_t i;
+    size_t block;
+
+    if (mirror_load() != 0) {
+        return (-EIO);
+    }
+
+    s_p = src_p;
+
+    /* Only modified bytes make their block dirty. */
+    for (i = 0; i < size; i++) {
+        if (module.mirror.buf[dst + i] != s_p[i]) {
+            module.mirror.buf[dst + i] = s_p[i];
+            block = ((dst + i) / CONFIG_SETTINGS_MIRROR_BLOCK_SIZE);
+            module.mirror.dirty[block / 8] |= (1 << (block % 8));
+        }
     }
 
-    return (NULL);
+    return (size);
 }
 
+static int is_dirty(size_t block)
+{
+    return ((module.mirror.dirty[block / 8] >> (block % 8)) & 1);
+}
+
+/**
+ * Write each sequence of consecutive dirty blocks to the
+ * non-volatile memory.
+ */
+static int mirror_flush(void)
+{
+    size_t begin;
+    size_t end;
+    size_t address;
+    size_t size;
+
+    begin = 0;
+
+    while (begin < MIRROR_NUMBER_OF_BLOCKS) {
+        if (!is_dirty(begin)) {
+            begin++;
+            continue;
+        }
+
+        end = (begin + 1);
+
+        while ((end < MIRROR_NUMBER_OF_BLOCKS) && is_dirty(end)) {
+            end++;
+        }
+
+        address = (begin * CONFIG_SETTINGS_MIRROR_BLOCK_SIZE);
+        size = MIN(end * CONFIG_SETTINGS_MIRROR_BLOCK_SIZE,
+                   CONFIG_SETTINGS_AREA_SIZE) - address;
+
+        if (nvm_write(address,
+                      &module.mirror.buf[address],
+                      size) != size) {
+            return (-EIO);
+        }
+
+        while (begin < end) {
+            module.mirror.dirty[begin / 8] &= ~(1 << (begin % 8));
+            begin++;
+        }
+    }
+
+    return (0);
+}
+
+#endif
+
 #if CONFIG_SETTINGS_FS_COMMAND_LIST == 1
 
 static int cmd_list_cb(int argc,
@@ -380,6 +545,26 @@ static int cmd_write_cb(int argc,
 
 #endif
 
+#if (CONFIG_SETTINGS_MIRROR == 1) && (CONFIG_SETTINGS_FS_COMMAND_WRITE == 1)
+
+static int cmd_flush_cb(int argc,
+                        const char *argv[],
+                        void *chout_p,
+                        void *chin_p,
+                        void *arg_p,
+                        void *call_arg_p)
+{
+    if (argc != 1) {
+        std_fprintf(chout_p, OSTR("Usage: flush\r\n"));
+
+        return (-EINVAL);
+    }
+
+    return (settings_flush());
+}
+
+#endif
+
 static int reset(size_t address, size_t size)
 {
     size_t i;
@@ -399,7 +584,7 @@ static int reset(size_t address, size_t size)
             buf[i] = settings_default[address + i];
         }
 
-        if (nvm_write(address, &buf[0], size) != size) {
+        if (settings_write(address, &buf[0], size) != size) {
             return (-1);
         }
 
@@ -451,6 +636,14 @@ int settings_module_init(void)
     fs_command_register(&module.cmd_write);
 #endif
 
+#if (CONFIG_SETTINGS_MIRROR == 1) && (CONFIG_SETTINGS_FS_COMMAND_WRITE == 1)
+    fs_command_init(&module.cmd_flush,
+                    CSTR("/oam/settings/flush"),
+                    cmd_flush_cb,
+                    NULL);
+    fs_command_register(&module.cmd_flush);
+#endif
+
     return (nvm_module_init());
 }
 
@@ -459,6 +652,12 @@ ssize_t settings_read(void *dst_p, size_t src, size_t size)
     ASSERTN(dst_p != NULL, EINVAL);
     ASSERTN(size > 0, EINVAL);
 
+#if CONFIG_SETTINGS_MIRROR == 1
+    if (is_mirrored(src, size)) {
+        return (mirror_read(dst_p, src, size));
+    }
+#endif
+
     return (nvm_read(dst_p, src, size));
 }
 
@@ -467,6 +666,12 @@ ssize_t settings_write(size_t dst, const void *src_p, size_t size)
     ASSERTN(src_p != NULL, EINVAL);
     ASSERTN(size > 0, EINVAL);
 
+#if CONFIG_SETTINGS_MIRROR == 1
+    if (is_mirrored(dst, size)) {
+        return (mirror_write(dst, src_p, size));
+    }
+#endif
+
     return (nvm_write(dst, src_p, size));
 }
 
@@ -548,3 +753,12 @@ int settings_reset_all()
 {
     return (reset(0, sizeof(settings_default)));
 }
+
+int settings_flush()
+{
+#if CONFIG_SETTINGS_MIRROR == 1
+    return (mirror_flush());
+#else
+    return (0);
+#endif
+}
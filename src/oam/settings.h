@@ -49,6 +49,17 @@ struct setting_t {
     size_t size;
 };
 
+/**
+ * Perfect hash of the setting names, generated by simbagen.py. Each
+ * slot is an index in the settings array plus one, or zero(0) if
+ * unused.
+ */
+struct settings_hash_t {
+    FAR const uint16_t *indexes_p;
+    uint32_t seed;
+    uint32_t mask;
+};
+
 /**
  * Initialize the settings module. This function must be called before
  * calling any other function in this module.
@@ -136,4 +147,13 @@ int settings_reset_by_name(const char *name_p,
  */
 int settings_reset_all(void);
 
+/**
+ * Write all modified settings to the non-volatile memory. Only
+ * needed if ``CONFIG_SETTINGS_MIRROR`` is enabled, as writes are
+ * otherwise written through immediately.
+ *
+ * @return zero(0) or negative error code.
+ */
+int settings_flush(void);
+
 #endif
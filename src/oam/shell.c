@@ -1151,6 +1151,44 @@ static int read_command(struct shell_t *self_p)
     return (-E2BIG);
 }
 
+/**
+ * Read the next command in batch mode. Nothing is echoed and no line
+ * editing is done.
+ *
+ * @return Command length or negative error code.
+ */
+static int read_command_batch(struct shell_t *self_p)
+{
+    char c;
+    struct shell_line_t *line_p;
+
+    line_p = &self_p->line;
+    line_p->length = 0;
+
+    while (1) {
+        if (chan_read(self_p->chin_p, &c, sizeof(c)) != sizeof(c)) {
+            return (-EIO);
+        }
+
+        if (c == NEWLINE) {
+            break;
+        } else if (c == CARRIAGE_RETURN) {
+            continue;
+        }
+
+        /* Characters not fitting in the line are dropped, just as in
+           interactive mode. */
+        if (line_p->length < CONFIG_SHELL_COMMAND_MAX - 1) {
+            line_p->buf[line_p->length++] = c;
+        }
+    }
+
+    line_p->buf[line_p->length] = '\0';
+    line_p->cursor = line_p->length;
+
+    return (line_p->length);
+}
+
 int shell_module_init()
 {
     /* Return immediately if the module is already initialized. */
@@ -1203,6 +1241,7 @@ int shell_init(struct shell_t *self_p,
     self_p->name_p = name_p;
     self_p->username_p = username_p;
     self_p->password_p = password_p;
+    self_p->batch = 0;
 
     /* Always authorized if no login is required. */
     if (username_p == NULL) {
@@ -1219,6 +1258,15 @@ int shell_init(struct shell_t *self_p,
     return (0);
 }
 
+int shell_set_batch_mode(struct shell_t *self_p, int enabled)
+{
+    ASSERTN(self_p != NULL, EINVAL);
+
+    self_p->batch = enabled;
+
+    return (0);
+}
+
 void *shell_main(void *arg_p)
 {
     ASSERTNRN(arg_p != NULL, EINVAL);
@@ -1244,7 +1292,11 @@ void *shell_main(void *arg_p)
         }
 
         /* Read command.*/
-        res = read_command(self_p);
+        if (self_p->batch == 1) {
+            res = read_command_batch(self_p);
+        } else {
+            res = read_command(self_p);
+        }
 
         if (res > 0) {
             stripped_line_p = std_strip(line_get_buf(&self_p->line),
@@ -1274,7 +1326,9 @@ void *shell_main(void *arg_p)
             break;
         }
 
-        std_fprintf(self_p->chout_p, FSTR(CONFIG_SHELL_PROMPT));
+        if (self_p->batch == 0) {
+            std_fprintf(self_p->chout_p, FSTR(CONFIG_SHELL_PROMPT));
+        }
     }
 
     return (NULL);
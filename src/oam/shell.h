@@ -55,6 +55,7 @@ struct shell_t {
     int carriage_return_received;
     int newline_received;
     int authorized;
+    int batch;
 
 #if CONFIG_SHELL_MINIMAL == 0
     struct {
@@ -108,6 +109,23 @@ int shell_init(struct shell_t *self_p,
                const char *username_p,
                const char *password_p);
 
+/**
+ * Enable or disable batch mode. In batch mode command lines are
+ * executed without echo, line editing, auto-completion, history and
+ * prompt, which is useful when a script is piped to the shell. The
+ * command output and the ``OK`` or ``ERROR(<code>)`` line are still
+ * written for each command.
+ *
+ * Call this function before starting the shell thread.
+ *
+ * @param[in] self_p Shell to configure.
+ * @param[in] enabled True(1) to enable batch mode, false(0) to
+ *                    disable it.
+ *
+ * @return zero(0) or negative error code.
+ */
+int shell_set_batch_mode(struct shell_t *self_p, int enabled);
+
 /**
  * The shell main function that listens for commands on the input
  * channel and send response on the output channel. All received
@@ -41,47 +41,319 @@
 #define SOAM_TYPE_DATABASE_ID_RESPONSE               (9 << 4)
 #define SOAM_TYPE_DATABASE_REQUEST                  (10 << 4)
 #define SOAM_TYPE_DATABASE_RESPONSE                 (11 << 4)
+#define SOAM_TYPE_LOG_POINT_DEFERRED                (12 << 4)
+#define SOAM_TYPE_BATCH                             (13 << 4)
 #define SOAM_TYPE_INVALID_TYPE                      (15 << 4)
 
+#define SOAM_PACKET_FLAGS_COMPRESSED                 (1 << 2)
 #define SOAM_PACKET_FLAGS_CONSECUTIVE                (1 << 1)
 #define SOAM_PACKET_FLAGS_LAST                       (1 << 0)
 
 #define BUFFER_SIZE                                        64
 
+/* Size of a record header in a batch packet; the packet type and the
+   record size. */
+#define BATCH_RECORD_HEADER_SIZE                            3
+
+/* Smaller packets are not compressed. */
+#define COMPRESSION_SIZE_MIN                                8
+
+/* LZSS parameters. A match is 12 bits offset and 4 bits length. */
+#define LZSS_HASH_SIZE                                     64
+#define LZSS_LENGTH_MIN                                     3
+#define LZSS_LENGTH_MAX                                    18
+#define LZSS_OFFSET_MAX                                  4096
+
 /* The generated SOAM database id. */
 extern char soam_database_id[];
 extern const size_t soam_database_compressed_size;
 extern const uint8_t soam_database_compressed[];
 
+/**
+ * LZSS compress given data. A flag byte precedes each group of eight
+ * items, least significant bit first. A cleared bit is a literal
+ * byte, and a set bit a two bytes match; 12 bits offset minus one
+ * followed by 4 bits length minus three. The last position of each
+ * three bytes sequence is kept in a small hash table.
+ *
+ * @return Compressed size, or -1 if it does not fit in the
+ *         destination buffer.
+ */
+static ssize_t lzss_compress(uint8_t *dst_p,
+                             size_t dst_size,
+                             const uint8_t *src_p,
+                             size_t size)
+{
+    uint16_t positions[LZSS_HASH_SIZE];
+    size_t pos;
+    size_t dst_pos;
+    size_t flags_pos;
+    size_t candidate;
+    size_t offset;
+    size_t length;
+    int bit;
+    int hash;
+
+    memset(&positions[0], 0, sizeof(positions));
+    pos = 0;
+    dst_pos = 0;
+    flags_pos = 0;
+    offset = 0;
+    bit = 8;
+
+    while (pos < size) {
+        if (bit == 8) {
+            if (dst_pos == dst_size) {
+                return (-1);
+            }
+
+            flags_pos = dst_pos++;
+            dst_p[flags_pos] = 0;
+            bit = 0;
+        }
+
+        length = 0;
+
+        if (pos + LZSS_LENGTH_MIN <= size) {
+            hash = (((src_p[pos] << 4) ^ (src_p[pos + 1] << 2) ^ src_p[pos + 2])
+                    & (LZSS_HASH_SIZE - 1));
+            candidate = positions[hash];
+            positions[hash] = (pos + 1);
+
+            if (candidate > 0) {
+                candidate--;
+                offset = (pos - candidate);
+
+                if (offset <= LZSS_OFFSET_MAX) {
+                    while ((length < LZSS_LENGTH_MAX)
+                           && (pos + length < size)
+                           && (src_p[candidate + length] == src_p[pos + length])) {
+                        length++;
+                    }
+                }
+            }
+        }
+
+        if (length >= LZSS_LENGTH_MIN) {
+            if (dst_pos + 2 > dst_size) {
+                return (-1);
+            }
+
+            dst_p[flags_pos] |= (1 << bit);
+            dst_p[dst_pos++] = ((offset - 1) >> 4);
+            dst_p[dst_pos++] = ((((offset - 1) & 0xf) << 4)
+                                | (length - LZSS_LENGTH_MIN));
+            pos += length;
+        } else {
+            if (dst_pos == dst_size) {
+                return (-1);
+            }
+
+            dst_p[dst_pos++] = src_p[pos++];
+        }
+
+        bit++;
+    }
+
+    return (dst_pos);
+}
+
+static int is_compressible(struct soam_t *self_p, size_t payload_size)
+{
+    int type;
+
+    if (self_p->compression.buf_p == NULL) {
+        return (0);
+    }
+
+    if (payload_size < COMPRESSION_SIZE_MIN) {
+        return (0);
+    }
+
+    type = (self_p->tx.buf_p[0] & 0xf0);
+
+    return ((type == SOAM_TYPE_COMMAND_RESPONSE_DATA_PRINTF)
+            || (type == SOAM_TYPE_COMMAND_RESPONSE_DATA_BINARY));
+}
+
 /**
  * Finalize and output current packet to the output channel.
  */
 static ssize_t packet_output(struct soam_t *self_p)
 {
     ssize_t size;
+    ssize_t res;
+    size_t payload_size;
     size_t payload_crc_size;
     uint16_t crc;
+    uint8_t *buf_p;
+
+    buf_p = self_p->tx.buf_p;
+    payload_size = (self_p->tx.pos - 5);
+    size = (payload_size + 7);
+
+    /* Send the compressed payload if smaller. */
+    if (is_compressible(self_p, payload_size)) {
+        res = lzss_compress(&self_p->compression.buf_p[5],
+                            payload_size - 1,
+                            &buf_p[5],
+                            payload_size);
+
+        if (res > 0) {
+            self_p->compression.buf_p[0] = (buf_p[0]
+                                            | SOAM_PACKET_FLAGS_COMPRESSED);
+            self_p->compression.buf_p[1] = buf_p[1];
+            buf_p = self_p->compression.buf_p;
+            size = (res + 7);
+        }
+    }
 
-    size = (self_p->tx.pos + 2);
     payload_crc_size = (size - 5);
 
     /* Write packet size and crc fields. */
-    self_p->tx.buf_p[2] = self_p->transaction_id;
-    self_p->tx.buf_p[3] = (payload_crc_size >> 8);
-    self_p->tx.buf_p[4] = payload_crc_size;
+    buf_p[2] = self_p->transaction_id;
+    buf_p[3] = (payload_crc_size >> 8);
+    buf_p[4] = payload_crc_size;
 
-    crc = crc_ccitt(0xffff, &self_p->tx.buf_p[0], size - 2);
+    crc = crc_ccitt(0xffff, &buf_p[0], size - 2);
 
-    self_p->tx.buf_p[size - 2] = (crc >> 8);
-    self_p->tx.buf_p[size - 1] = crc;
+    buf_p[size - 2] = (crc >> 8);
+    buf_p[size - 1] = crc;
 
-    if (chan_write(self_p->tx.chout_p,
-                   &self_p->tx.buf_p[0],
-                   size) != size) {
+    if (chan_write(self_p->tx.chout_p, &buf_p[0], size) != size) {
         return (-1);
     }
 
-    return (size - 7);
+    return (payload_size);
+}
+
+static int is_batchable(int type)
+{
+    switch (type & 0xf0) {
+
+    case SOAM_TYPE_STDOUT_PRINTF:
+    case SOAM_TYPE_STDOUT_BINARY:
+    case SOAM_TYPE_LOG_POINT:
+    case SOAM_TYPE_LOG_POINT_DEFERRED:
+        return (1);
+
+    default:
+        return (0);
+    }
+}
+
+/**
+ * Output the batch packet if it has any records. The transmission
+ * mutex must be taken by the caller.
+ */
+static int batch_output(struct soam_t *self_p)
+{
+    ssize_t res;
+
+    if (self_p->batch.number_of_records == 0) {
+        return (0);
+    }
+
+    self_p->batch.number_of_records = 0;
+    self_p->tx.buf_p[0] = (SOAM_TYPE_BATCH | SOAM_PACKET_FLAGS_LAST);
+    res = packet_output(self_p);
+
+    return (res < 0 ? -1 : 0);
+}
+
+static void batch_init(struct soam_t *self_p)
+{
+    self_p->tx.buf_p[0] = SOAM_TYPE_BATCH;
+    self_p->tx.buf_p[1] = self_p->tx.packet_index++;
+    self_p->tx.pos = 5;
+}
+
+static ssize_t batch_record_begin(struct soam_t *self_p,
+                                  int type)
+{
+    /* Output the batch packet if the record header does not fit. */
+    if (self_p->tx.pos + BATCH_RECORD_HEADER_SIZE > self_p->tx.size - 2) {
+        (void)batch_output(self_p);
+    }
+
+    if (self_p->batch.number_of_records == 0) {
+        batch_init(self_p);
+    }
+
+    self_p->batch.in_record = 1;
+    self_p->batch.plain = 0;
+    self_p->batch.record_type = type;
+    self_p->batch.record_pos = self_p->tx.pos;
+    self_p->tx.buf_p[self_p->tx.pos] = type;
+    self_p->tx.pos += BATCH_RECORD_HEADER_SIZE;
+
+    return (0);
+}
+
+/**
+ * Make room for more data of the current record when the batch
+ * packet is full.
+ */
+static int batch_record_overflow(struct soam_t *self_p)
+{
+    size_t size;
+
+    size = (self_p->tx.pos - self_p->batch.record_pos);
+
+    if (self_p->batch.number_of_records > 0) {
+        /* Output the complete records and move the current record to
+           a new batch packet. */
+        self_p->tx.pos = self_p->batch.record_pos;
+
+        if (batch_output(self_p) != 0) {
+            return (-1);
+        }
+
+        batch_init(self_p);
+        memmove(&self_p->tx.buf_p[5],
+                &self_p->tx.buf_p[self_p->batch.record_pos],
+                size);
+        self_p->tx.buf_p[5] = self_p->batch.record_type;
+        self_p->batch.record_pos = 5;
+        self_p->tx.pos = (5 + size);
+    } else {
+        /* The record does not fit in a batch packet. Transmit it as
+           a regular packet instead. */
+        size -= BATCH_RECORD_HEADER_SIZE;
+        memmove(&self_p->tx.buf_p[5],
+                &self_p->tx.buf_p[5 + BATCH_RECORD_HEADER_SIZE],
+                size);
+        self_p->tx.buf_p[0] = self_p->batch.record_type;
+        self_p->tx.pos = (5 + size);
+        self_p->batch.plain = 1;
+    }
+
+    return (0);
+}
+
+static ssize_t batch_record_end(struct soam_t *self_p)
+{
+    size_t size;
+
+    self_p->batch.in_record = 0;
+
+    if (self_p->tx.pos == -1) {
+        self_p->batch.number_of_records = 0;
+        mutex_unlock(&self_p->tx.mutex);
+
+        return (-1);
+    }
+
+    size = (self_p->tx.pos
+            - self_p->batch.record_pos
+            - BATCH_RECORD_HEADER_SIZE);
+    self_p->tx.buf_p[self_p->batch.record_pos + 1] = (size >> 8);
+    self_p->tx.buf_p[self_p->batch.record_pos + 2] = size;
+    self_p->batch.number_of_records++;
+
+    mutex_unlock(&self_p->tx.mutex);
+
+    return (size);
 }
 
 static ssize_t printf_or_binary_write(struct soam_t *self_p,
@@ -161,6 +433,14 @@ static int log_control(void *chan_p,
     case CHAN_CONTROL_LOG_BEGIN:
         return (soam_write_begin(self_p, SOAM_TYPE_LOG_POINT));
 
+    case CHAN_CONTROL_LOG_DEFERRED_BEGIN:
+        if (soam_write_begin(self_p, SOAM_TYPE_LOG_POINT_DEFERRED) != 0) {
+            return (-1);
+        }
+
+        /* Binary entries are accepted. */
+        return (1);
+
     case CHAN_CONTROL_LOG_END:
         return (soam_write_end(self_p));
 
@@ -305,6 +585,11 @@ int soam_init(struct soam_t *self_p,
 
     self_p->is_printf = 0;
     self_p->transaction_id = 0;
+    self_p->batch.enabled = 0;
+    self_p->batch.in_record = 0;
+    self_p->batch.number_of_records = 0;
+    self_p->compression.buf_p = NULL;
+    self_p->compression.size = 0;
 
     chan_init(&self_p->stdout_chan,
               chan_read_null,
@@ -392,6 +677,15 @@ ssize_t soam_write_begin(struct soam_t *self_p,
 {
     mutex_lock(&self_p->tx.mutex);
 
+    if (self_p->batch.enabled == 1) {
+        if (is_batchable(type)) {
+            return (batch_record_begin(self_p, type));
+        }
+
+        /* Keep the packet order. */
+        (void)batch_output(self_p);
+    }
+
     /* First packet initialization. */
     self_p->tx.buf_p[0] = type;
     self_p->tx.buf_p[1] = self_p->tx.packet_index++;
@@ -414,6 +708,16 @@ ssize_t soam_write_chunk(struct soam_t *self_p,
     while (left > 0) {
         /* Output if the transmission buffer is full. */
         if (self_p->tx.pos == (self_p->tx.size - 2)) {
+            if ((self_p->batch.in_record == 1) && (self_p->batch.plain == 0)) {
+                if (batch_record_overflow(self_p) != 0) {
+                    self_p->tx.pos = -1;
+
+                    return (-1);
+                }
+
+                continue;
+            }
+
             if (packet_output(self_p) <= 0) {
                 self_p->tx.pos = -1;
 
@@ -446,6 +750,12 @@ ssize_t soam_write_end(struct soam_t *self_p)
 {
     ssize_t size;
 
+    if ((self_p->batch.in_record == 1) && (self_p->batch.plain == 0)) {
+        return (batch_record_end(self_p));
+    }
+
+    self_p->batch.in_record = 0;
+
     /* Output last packet, if any. */
     if (self_p->tx.pos != -1) {
         self_p->tx.buf_p[0] |= SOAM_PACKET_FLAGS_LAST;
@@ -473,6 +783,51 @@ ssize_t soam_write(struct soam_t *self_p,
     return (soam_write_end(self_p));
 }
 
+int soam_set_batching(struct soam_t *self_p, int enabled)
+{
+    ASSERTN(self_p != NULL, EINVAL);
+    ASSERTN(self_p->tx.size >= (SOAM_PACKET_SIZE_MIN
+                                + BATCH_RECORD_HEADER_SIZE
+                                + 1), EINVAL);
+
+    int res;
+
+    mutex_lock(&self_p->tx.mutex);
+    res = batch_output(self_p);
+    self_p->batch.enabled = enabled;
+    mutex_unlock(&self_p->tx.mutex);
+
+    return (res);
+}
+
+int soam_flush(struct soam_t *self_p)
+{
+    ASSERTN(self_p != NULL, EINVAL);
+
+    int res;
+
+    mutex_lock(&self_p->tx.mutex);
+    res = batch_output(self_p);
+    mutex_unlock(&self_p->tx.mutex);
+
+    return (res);
+}
+
+int soam_set_compression_buffer(struct soam_t *self_p,
+                                void *buf_p,
+                                size_t size)
+{
+    ASSERTN(self_p != NULL, EINVAL);
+    ASSERTN((buf_p == NULL) || (size >= self_p->tx.size), EINVAL);
+
+    mutex_lock(&self_p->tx.mutex);
+    self_p->compression.buf_p = buf_p;
+    self_p->compression.size = size;
+    mutex_unlock(&self_p->tx.mutex);
+
+    return (0);
+}
+
 void *soam_get_log_input_channel(struct soam_t *self_p)
 {
     return (&self_p->log_chan);
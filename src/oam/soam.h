@@ -39,6 +39,18 @@ struct soam_t {
         void *chout_p;
         uint8_t packet_index;
     } tx;
+    struct {
+        int8_t enabled;
+        int8_t in_record;
+        int8_t plain;
+        uint8_t record_type;
+        ssize_t record_pos;
+        int number_of_records;
+    } batch;
+    struct {
+        uint8_t *buf_p;
+        size_t size;
+    } compression;
     struct chan_t stdout_chan;
     struct chan_t log_chan;
     struct chan_t command_chan;
@@ -131,6 +143,50 @@ ssize_t soam_write(struct soam_t *self_p,
                    const void *buf_p,
                    size_t size);
 
+/**
+ * Enable or disable batching of small packets. With batching enabled,
+ * standard output and log point packets are coalesced into batch
+ * packets, which are transmitted when full, before any other
+ * packet type, and by `soam_flush()`. Packets larger than a batch
+ * packet are transmitted as usual. ``bin/soam.py`` splits batch
+ * packets into the original packets.
+ *
+ * Pending packets are transmitted when batching is disabled.
+ *
+ * @param[in] self_p Soam object.
+ * @param[in] enabled true(1) to enable batching, false(0) to disable
+ *                    it.
+ *
+ * @return zero(0) or negative error code.
+ */
+int soam_set_batching(struct soam_t *self_p, int enabled);
+
+/**
+ * Transmit the pending batch packet, if any.
+ *
+ * @param[in] self_p Soam object.
+ *
+ * @return zero(0) or negative error code.
+ */
+int soam_flush(struct soam_t *self_p);
+
+/**
+ * Set the buffer to compress command response data packets into. A
+ * packet is LZSS compressed if that makes it smaller, and
+ * decompressed by ``bin/soam.py``.
+ *
+ * @param[in] self_p Soam object.
+ * @param[in] buf_p Compression buffer, or NULL to disable
+ *                  compression.
+ * @param[in] size Compression buffer size. Must be at least the
+ *                 transmission buffer size.
+ *
+ * @return zero(0) or negative error code.
+ */
+int soam_set_compression_buffer(struct soam_t *self_p,
+                                void *buf_p,
+                                size_t size);
+
 /**
  * Get the log input channel. This channel can be set as output
  * channel of the log module with
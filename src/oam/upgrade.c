@@ -28,9 +28,26 @@
 
 #include "simba.h"
 
+/* Data formats in version 2 headers. */
+#define BINARY_FORMAT_RAW                                   0
+#define BINARY_FORMAT_PATCH                                 1
+
+/* Patch operations. */
+#define PATCH_OP_COPY                                       1
+#define PATCH_OP_DIFF                                       2
+#define PATCH_OP_EXTRA                                      3
+#define PATCH_OP_SEEK                                       4
+
+#define PATCH_STATE_OP                                      0
+#define PATCH_STATE_VALUE                                   1
+#define PATCH_STATE_DATA                                    2
+
 struct upgrade_binary_header_t {
     uint32_t size;
     uint8_t sha1[20];
+    uint32_t format;
+    uint32_t from_size;
+    uint8_t from_sha1[20];
     char description[128];
 };
 
@@ -40,6 +57,32 @@ struct module_t {
     ssize_t header_size;
     size_t offset;
     struct upgrade_binary_header_t header;
+    struct sha1_t sha1;
+    size_t size;
+#if CONFIG_UPGRADE_PIPELINE == 1
+    struct {
+        struct {
+            uint8_t buf[CONFIG_UPGRADE_PIPELINE_BUFFER_SIZE];
+            size_t size;
+        } buffers[2];
+        /* Index of the buffer filled by the uploading thread. The
+           other buffer is free or written by the writer thread. */
+        int current;
+        struct sem_t free;
+        struct sem_t ready;
+        int res;
+    } pipeline;
+#endif
+#if CONFIG_UPGRADE_PATCH == 1
+    struct {
+        int state;
+        uint8_t op;
+        uint32_t value;
+        int shift;
+        size_t left;
+        size_t from_offset;
+    } patch;
+#endif
 #if CONFIG_UPGRADE_FS_COMMAND_BOOTLOADER_ENTER == 1
     struct fs_command_t cmd_bootloader_enter;
 #endif
@@ -56,48 +99,404 @@ struct module_t {
 
 static struct module_t module;
 
+#if CONFIG_UPGRADE_PIPELINE == 1
+static THRD_STACK(pipeline_stack, CONFIG_UPGRADE_PIPELINE_STACK_SIZE);
+#endif
+
 #include "upgrade.i"
 
+static uint32_t read_uint32(const uint8_t *buf_p)
+{
+    return (((uint32_t)buf_p[0] << 24)
+            | ((uint32_t)buf_p[1] << 16)
+            | ((uint32_t)buf_p[2] << 8)
+            | buf_p[3]);
+}
+
+/**
+ * Version 1 headers are followed by the application, while version 2
+ * headers also have a data format field, and the size and SHA1 of
+ * the application a patch is created from.
+ */
 static int binary_header_parse(struct upgrade_binary_header_t *header_p,
                                uint8_t *src_p,
                                size_t size)
 {
     uint32_t version;
-    uint32_t crc;
+    size_t description_offset;
+
+    version = read_uint32(&src_p[0]);
+
+    switch (version) {
 
-    version = ((src_p[0] << 24)
-               | (src_p[1] << 16)
-               | (src_p[2] << 8)
-               | src_p[3]);
+    case 1:
+        header_p->format = BINARY_FORMAT_RAW;
+        description_offset = 32;
+        break;
 
-    if (version != 1) {
+#if CONFIG_UPGRADE_PATCH == 1
+    case 2:
+        if (size < 68) {
+            return (-1);
+        }
+
+        header_p->format = read_uint32(&src_p[32]);
+        header_p->from_size = read_uint32(&src_p[36]);
+        memcpy(&header_p->from_sha1[0],
+               &src_p[40],
+               sizeof(header_p->from_sha1));
+        description_offset = 60;
+
+        if ((header_p->format != BINARY_FORMAT_RAW)
+            && (header_p->format != BINARY_FORMAT_PATCH)) {
+            return (-1);
+        }
+
+        break;
+#endif
+
+    default:
         return (-1);
     }
 
-    crc = ((src_p[size - 4] << 24)
-           | (src_p[size - 3] << 16)
-           | (src_p[size - 2] << 8)
-           | src_p[size - 1]);
-
-    if (crc_32(0, src_p, size - 4) != crc) {
+    if (crc_32(0, src_p, size - 4) != read_uint32(&src_p[size - 4])) {
         return (-1);
     }
 
-    header_p->size = ((src_p[8] << 24)
-                      | (src_p[9] << 16)
-                      | (src_p[10] << 8)
-                      | src_p[11]);
+    header_p->size = read_uint32(&src_p[8]);
     memcpy(&header_p->sha1[0], &src_p[12], sizeof(header_p->sha1));
 
-    if (strlen((char *)&src_p[32]) >= sizeof(header_p->description)) {
+    if (strlen((char *)&src_p[description_offset])
+        >= sizeof(header_p->description)) {
         return (-1);
     }
 
-    strcpy(&header_p->description[0], (char *)&src_p[32]);
+    strcpy(&header_p->description[0], (char *)&src_p[description_offset]);
 
     return (0);
 }
 
+#if CONFIG_UPGRADE_PIPELINE == 1
+
+/**
+ * Write each filled buffer to the port, while the uploading thread
+ * fills the other buffer.
+ */
+static void *pipeline_main(void *arg_p)
+{
+    int index;
+    uint8_t *buf_p;
+    size_t size;
+
+    thrd_set_name("upgrade_writer");
+
+    index = 0;
+
+    while (1) {
+        sem_take(&module.pipeline.ready, NULL);
+
+        buf_p = &module.pipeline.buffers[index].buf[0];
+        size = module.pipeline.buffers[index].size;
+
+        /* Hash the data while it is written, so the port does not
+           have to read the whole application back to validate
+           it. */
+        sha1_update(&module.sha1, buf_p, size);
+
+        if (module.pipeline.res == 0) {
+            module.pipeline.res = upgrade_port_binary_upload(buf_p, size);
+        }
+
+        index ^= 1;
+        sem_give(&module.pipeline.free, 1);
+    }
+
+    return (NULL);
+}
+
+/**
+ * Pass the current buffer to the writer thread, and wait for the
+ * other buffer to be free.
+ */
+static void pipeline_submit(void)
+{
+    sem_give(&module.pipeline.ready, 1);
+    sem_take(&module.pipeline.free, NULL);
+    module.pipeline.current ^= 1;
+    module.pipeline.buffers[module.pipeline.current].size = 0;
+}
+
+/**
+ * Wait for the writer thread to write all submitted data.
+ */
+static void pipeline_wait(void)
+{
+    sem_take(&module.pipeline.free, NULL);
+    sem_give(&module.pipeline.free, 1);
+}
+
+static int pipeline_flush(void)
+{
+    if (module.pipeline.buffers[module.pipeline.current].size > 0) {
+        pipeline_submit();
+    }
+
+    pipeline_wait();
+
+    return (module.pipeline.res);
+}
+
+static int data_write(const void *buf_p, size_t size)
+{
+    const uint8_t *u8_buf_p;
+    size_t chunk_size;
+    size_t *size_p;
+
+    u8_buf_p = buf_p;
+    module.size += size;
+
+    while (size > 0) {
+        size_p = &module.pipeline.buffers[module.pipeline.current].size;
+        chunk_size = MIN(size, CONFIG_UPGRADE_PIPELINE_BUFFER_SIZE - *size_p);
+        memcpy(&module.pipeline.buffers[module.pipeline.current].buf[*size_p],
+               u8_buf_p,
+               chunk_size);
+        *size_p += chunk_size;
+        u8_buf_p += chunk_size;
+        size -= chunk_size;
+
+        if (*size_p == CONFIG_UPGRADE_PIPELINE_BUFFER_SIZE) {
+            pipeline_submit();
+        }
+    }
+
+    return (module.pipeline.res);
+}
+
+#else
+
+static int data_write(const void *buf_p, size_t size)
+{
+    /* Hash the data while it is written, so the port does not have
+       to read the whole application back to validate it. */
+    sha1_update(&module.sha1, (void *)buf_p, size);
+    module.size += size;
+
+    return (upgrade_port_binary_upload(buf_p, size));
+}
+
+#endif
+
+#if CONFIG_UPGRADE_PATCH == 1
+
+/**
+ * Check that the current application is the one the patch was
+ * created from.
+ */
+static int patch_check_from(void)
+{
+    struct sha1_t sha1;
+    uint8_t from_sha1[20];
+    size_t offset;
+    size_t size;
+
+    sha1_init(&sha1);
+
+    for (offset = 0; offset < module.header.from_size; offset += size) {
+        size = MIN(sizeof(module.buf), module.header.from_size - offset);
+
+        if (upgrade_port_application_read(&module.buf[0],
+                                          offset,
+                                          size) != 0) {
+            return (-1);
+        }
+
+        sha1_update(&sha1, &module.buf[0], size);
+    }
+
+    sha1_digest(&sha1, &from_sha1[0]);
+
+    return (memcmp(&from_sha1[0],
+                   &module.header.from_sha1[0],
+                   sizeof(from_sha1)) == 0 ? 0 : -1);
+}
+
+static int patch_copy(size_t size)
+{
+    size_t chunk_size;
+
+    while (size > 0) {
+        chunk_size = MIN(size, sizeof(module.buf));
+
+        if (upgrade_port_application_read(&module.buf[0],
+                                          module.patch.from_offset,
+                                          chunk_size) != 0) {
+            return (-1);
+        }
+
+        if (data_write(&module.buf[0], chunk_size) != 0) {
+            return (-1);
+        }
+
+        module.patch.from_offset += chunk_size;
+        size -= chunk_size;
+    }
+
+    return (0);
+}
+
+/**
+ * Start executing the operation that was just parsed.
+ */
+static int patch_op_begin(void)
+{
+    int32_t adjustment;
+    uint32_t value;
+
+    value = module.patch.value;
+    module.patch.state = PATCH_STATE_OP;
+
+    switch (module.patch.op) {
+
+    case PATCH_OP_COPY:
+    case PATCH_OP_DIFF:
+        if (value > module.header.from_size - module.patch.from_offset) {
+            return (-1);
+        }
+
+        if (value > module.header.size - module.size) {
+            return (-1);
+        }
+
+        if (module.patch.op == PATCH_OP_COPY) {
+            return (patch_copy(value));
+        }
+
+        break;
+
+    case PATCH_OP_EXTRA:
+        if (value > module.header.size - module.size) {
+            return (-1);
+        }
+
+        break;
+
+    case PATCH_OP_SEEK:
+        /* Zigzag encoded signed adjustment. */
+        adjustment = (int32_t)((value >> 1) ^ -(value & 1));
+
+        if ((adjustment < -(int32_t)module.patch.from_offset)
+            || (adjustment > (int32_t)(module.header.from_size
+                                       - module.patch.from_offset))) {
+            return (-1);
+        }
+
+        module.patch.from_offset += adjustment;
+
+        return (0);
+
+    default:
+        return (-1);
+    }
+
+    if (value > 0) {
+        module.patch.left = value;
+        module.patch.state = PATCH_STATE_DATA;
+    }
+
+    return (0);
+}
+
+/**
+ * Apply given patch data. A patch is a sequence of operations, each
+ * an one byte operation code followed by a LEB128 encoded value.
+ *
+ * COPY  Write given number of bytes from the current application.
+ * DIFF  Followed by given number of bytes, each added to the next
+ *       byte in the current application.
+ * EXTRA Followed by given number of bytes to write.
+ * SEEK  Move the current application offset by given signed value.
+ */
+static int patch_process(const uint8_t *buf_p, size_t size)
+{
+    size_t chunk_size;
+    size_t i;
+
+    while (size > 0) {
+        switch (module.patch.state) {
+
+        case PATCH_STATE_OP:
+            module.patch.op = *buf_p;
+            module.patch.value = 0;
+            module.patch.shift = 0;
+            module.patch.state = PATCH_STATE_VALUE;
+            buf_p++;
+            size--;
+            break;
+
+        case PATCH_STATE_VALUE:
+            if (module.patch.shift > 28) {
+                return (-1);
+            }
+
+            module.patch.value |= ((uint32_t)(*buf_p & 0x7f)
+                                   << module.patch.shift);
+            module.patch.shift += 7;
+
+            if ((*buf_p & 0x80) == 0) {
+                if (patch_op_begin() != 0) {
+                    return (-1);
+                }
+            }
+
+            buf_p++;
+            size--;
+            break;
+
+        default:
+            chunk_size = MIN(size, module.patch.left);
+
+            if (module.patch.op == PATCH_OP_DIFF) {
+                chunk_size = MIN(chunk_size, sizeof(module.buf));
+
+                if (upgrade_port_application_read(&module.buf[0],
+                                                  module.patch.from_offset,
+                                                  chunk_size) != 0) {
+                    return (-1);
+                }
+
+                for (i = 0; i < chunk_size; i++) {
+                    module.buf[i] += buf_p[i];
+                }
+
+                if (data_write(&module.buf[0], chunk_size) != 0) {
+                    return (-1);
+                }
+
+                module.patch.from_offset += chunk_size;
+            } else {
+                if (data_write(buf_p, chunk_size) != 0) {
+                    return (-1);
+                }
+            }
+
+            module.patch.left -= chunk_size;
+            buf_p += chunk_size;
+            size -= chunk_size;
+
+            if (module.patch.left == 0) {
+                module.patch.state = PATCH_STATE_OP;
+            }
+
+            break;
+        }
+    }
+
+    return (0);
+}
+
+#endif
+
 #if CONFIG_UPGRADE_FS_COMMAND_BOOTLOADER_ENTER == 1
 
 /**
@@ -219,6 +618,21 @@ int upgrade_module_init()
     fs_command_register(&module.cmd_application_is_valid);
 #endif
 
+#if CONFIG_UPGRADE_PIPELINE == 1
+    /* The uploading thread initially owns one of the two
+       buffers. */
+    sem_init(&module.pipeline.free, 1, 2);
+    sem_init(&module.pipeline.ready, 1, 1);
+
+    if (thrd_spawn(pipeline_main,
+                   NULL,
+                   CONFIG_UPGRADE_PIPELINE_PRIO,
+                   pipeline_stack,
+                   sizeof(pipeline_stack)) == NULL) {
+        return (-1);
+    }
+#endif
+
     return (0);
 }
 
@@ -259,8 +673,22 @@ int upgrade_application_is_valid(int quick)
 
 int upgrade_binary_upload_begin()
 {
+#if CONFIG_UPGRADE_PIPELINE == 1
+    /* An earlier upload may have been aborted without calling
+       upgrade_binary_upload_end(). */
+    pipeline_wait();
+    module.pipeline.buffers[module.pipeline.current].size = 0;
+    module.pipeline.res = 0;
+#endif
+
     module.header_size = -1;
     module.offset = 0;
+    module.size = 0;
+    sha1_init(&module.sha1);
+#if CONFIG_UPGRADE_PATCH == 1
+    module.patch.state = PATCH_STATE_OP;
+    module.patch.from_offset = 0;
+#endif
 
     return (upgrade_port_binary_upload_begin());
 }
@@ -322,15 +750,82 @@ int upgrade_binary_upload(const void *buf_p,
         buf_p += chunk_size;
         module.header_size = 0;
 
+#if CONFIG_UPGRADE_PATCH == 1
+        if (module.header.format == BINARY_FORMAT_PATCH) {
+            if (patch_check_from() != 0) {
+                log_object_print(NULL,
+                                 LOG_ERROR,
+                                 OSTR("upgrade patch is not created from "
+                                      "the current application\r\n"));
+                return (-1);
+            }
+        }
+#endif
+
         if (size == 0) {
             return (0);
         }
     }
 
-    return (upgrade_port_binary_upload(buf_p, size));
+#if CONFIG_UPGRADE_PATCH == 1
+    if (module.header.format == BINARY_FORMAT_PATCH) {
+        if (patch_process(buf_p, size) != 0) {
+            log_object_print(NULL,
+                             LOG_ERROR,
+                             OSTR("failed to apply upgrade patch\r\n"));
+            return (-1);
+        }
+
+        return (0);
+    }
+#endif
+
+    return (data_write(buf_p, size));
 }
 
 int upgrade_binary_upload_end()
 {
+    uint8_t sha1[20];
+
+#if CONFIG_UPGRADE_PIPELINE == 1
+    if (pipeline_flush() != 0) {
+        return (-1);
+    }
+#endif
+
+    /* Only verify the data if the header was parsed. */
+    if (module.header_size == 0) {
+#if CONFIG_UPGRADE_PATCH == 1
+        if ((module.header.format == BINARY_FORMAT_PATCH)
+            && (module.patch.state != PATCH_STATE_OP)) {
+            log_object_print(NULL,
+                             LOG_ERROR,
+                             OSTR("truncated upgrade patch\r\n"));
+            return (-1);
+        }
+#endif
+
+        if (module.size != module.header.size) {
+            log_object_print(NULL,
+                             LOG_ERROR,
+                             OSTR("received %u bytes of data, but expected "
+                                  "%u\r\n"),
+                             module.size,
+                             module.header.size);
+            return (-1);
+        }
+
+        sha1_digest(&module.sha1, &sha1[0]);
+
+        if (memcmp(&sha1[0],
+                   &module.header.sha1[0],
+                   sizeof(sha1)) != 0) {
+            log_object_print(NULL,
+                             LOG_ERROR,
+                             OSTR("upgrade data sha1 mismatch\r\n"));
+            return (-1);
+        }
+    }
+
     return (upgrade_port_binary_upload_end());
 }
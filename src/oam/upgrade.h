@@ -93,9 +93,12 @@ int upgrade_application_erase(void);
  * area.
  *
  * @param[in] quick Perform a quick validation. The quick validation
- *                  is port specific, while the non-quick validation
- *                  always calculates a checksum of the application
- *                  and compares it to the expected checksum.
+ *                  is port specific. The non-quick validation
+ *                  calculates a checksum of the application and
+ *                  compares it to the expected checksum, unless the
+ *                  port has recorded that the application was
+ *                  verified by `upgrade_binary_upload_end()` or an
+ *                  earlier non-quick validation.
  *
  * @return true(1) if a valid application exists in the memory region,
  *         otherwise false(0).
@@ -103,7 +106,9 @@ int upgrade_application_erase(void);
 int upgrade_application_is_valid(int quick);
 
 /**
- * Begin an upload transaction of a .ubin file.
+ * Begin an upload transaction of a .ubin file. The file contains
+ * either the application, or a patch of the current application
+ * created by ``bin/upgrade.py --from-binary``.
  *
  * @return zero(0) or negative error code.
  */
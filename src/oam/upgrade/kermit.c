@@ -37,6 +37,7 @@
 #define PACKET_TYPE_SEND         'S'
 #define PACKET_TYPE_DATA         'D'
 #define PACKET_TYPE_ACK          'Y'
+#define PACKET_TYPE_NAK          'N'
 #define PACKET_TYPE_BREAK        'B'
 
 /* Configuration. */
@@ -49,17 +50,33 @@
 #define REFUSE                       'N'
 #define CLOCK_CHECK_TYPE             '1'
 #define LONG_PACKETS                  2
-#define NO_WINDOWS                    0
-#define LONG_PACKETS_LENGTH_MAX_MSB   1
-#define LONG_PACKETS_LENGTH_MAX_LSB  94
+#define SLIDING_WINDOWS               4
+#define LONG_PACKETS_LENGTH_MAX       CONFIG_UPGRADE_KERMIT_PACKET_LENGTH_MAX
+#define LONG_PACKETS_LENGTH_MAX_MSB   (LONG_PACKETS_LENGTH_MAX / 95)
+#define LONG_PACKETS_LENGTH_MAX_LSB   (LONG_PACKETS_LENGTH_MAX % 95)
+#define WINDOW_SIZE                   CONFIG_UPGRADE_KERMIT_WINDOW_SIZE
+
+#if WINDOW_SIZE > 1
+#    define CAPABILITIES              (LONG_PACKETS | SLIDING_WINDOWS)
+#else
+#    define CAPABILITIES              LONG_PACKETS
+#endif
+
+/* Sequence numbers are modulo 64. */
+#define SEQUENCE_NUMBER_MASK       0x3f
+
+/* Offset of the first capabilities field in the send packet. */
+#define SEND_CAPAS_OFFSET             9
 
 struct upgrade_kermit_t {
     void *chin_p;
     void *chout_p;
     struct {
-        uint8_t buf[256];
+        uint8_t buf[LONG_PACKETS_LENGTH_MAX];
         size_t size;
     } input;
+    int sequence_number;
+    int window_size;
 };
 
 static struct upgrade_kermit_t module;
@@ -95,6 +112,14 @@ static uint8_t unescape(uint8_t value)
     }
 }
 
+/**
+ * Fold given sum into a type 1 block check value.
+ */
+static inline int checksum_fold(int sum)
+{
+    return ((sum + ((sum >> 6) & 0x03)) & 0x3f);
+}
+
 /**
  * Calculate the checksum of given buffer.
  */
@@ -107,10 +132,13 @@ static int checksum(uint8_t *buf_p, size_t length)
         length--;
     }
 
-    return ((checksum + ((checksum >> 6) & 0x03)) & 0x3f);
+    return (checksum_fold(checksum));
 }
 
-static int write_ack(int sequence_number)
+/**
+ * Write an empty packet of given type.
+ */
+static int write_empty(int sequence_number, int type)
 {
     uint8_t response[6];
 
@@ -118,7 +146,7 @@ static int write_ack(int sequence_number)
     response[0] = START_OF_HEADING;
     response[1] = encode(3);
     response[2] = encode(sequence_number);
-    response[3] = PACKET_TYPE_ACK;
+    response[3] = type;
     response[4] = encode(checksum(&response[1], 3));
     response[5] = END_OF_LINE;
 
@@ -127,12 +155,57 @@ static int write_ack(int sequence_number)
     return (0);
 }
 
+static int write_ack(int sequence_number)
+{
+    return (write_empty(sequence_number, PACKET_TYPE_ACK));
+}
+
+/**
+ * Ask the sender to retransmit the packet with given sequence
+ * number. The packet being received is discarded.
+ */
+static int write_nak(int sequence_number)
+{
+    return (write_empty(sequence_number, PACKET_TYPE_NAK));
+}
+
 /**
  * Handle a send packet.
  */
 static int handle_send(int sequence_number)
 {
     uint8_t response[20];
+    size_t i;
+    int window_size;
+
+    /* Use the smallest of the two window sizes. The window size
+       field follows the last capabilities field, which has the least
+       significant bit cleared. */
+    module.window_size = 1;
+
+    if (module.input.size > SEND_CAPAS_OFFSET) {
+        i = SEND_CAPAS_OFFSET;
+
+        while ((i < module.input.size - 1)
+               && (decode(module.input.buf[i]) & 0x01)) {
+            i++;
+        }
+
+        if ((decode(module.input.buf[SEND_CAPAS_OFFSET]) & SLIDING_WINDOWS)
+            && (i + 1 < module.input.size)) {
+            window_size = decode(module.input.buf[i + 1]);
+
+            if (window_size > WINDOW_SIZE) {
+                window_size = WINDOW_SIZE;
+            }
+
+            if (window_size > 1) {
+                module.window_size = window_size;
+            }
+        }
+    }
+
+    module.sequence_number = ((sequence_number + 1) & SEQUENCE_NUMBER_MASK);
 
     /* Build the response packet. */
     response[0] = START_OF_HEADING;
@@ -148,8 +221,8 @@ static int handle_send(int sequence_number)
     response[10] = REFUSE;
     response[11] = CLOCK_CHECK_TYPE;
     response[12] = REFUSE;
-    response[13] = encode(LONG_PACKETS);
-    response[14] = encode(NO_WINDOWS);
+    response[13] = encode(CAPABILITIES);
+    response[14] = encode(WINDOW_SIZE);
     response[15] = encode(LONG_PACKETS_LENGTH_MAX_MSB);
     response[16] = encode(LONG_PACKETS_LENGTH_MAX_LSB);
     response[17] = encode(checksum(&response[1], 16));
@@ -192,6 +265,34 @@ static int handle_default(int sequence_number)
     return (write_ack(sequence_number));
 }
 
+/**
+ * Handle a packet that is not the next expected packet. A packet in
+ * the window before the expected packet was already processed, but
+ * its ACK was lost and is resent. A packet in the window after the
+ * expected packet means that packets were lost, and those are NAKed
+ * along with the received packet, which is not buffered.
+ */
+static int handle_out_of_sequence(int sequence_number)
+{
+    int distance;
+    int i;
+
+    distance = ((sequence_number - module.sequence_number)
+                & SEQUENCE_NUMBER_MASK);
+
+    if (distance >= SEQUENCE_NUMBER_MASK + 1 - module.window_size) {
+        return (write_ack(sequence_number));
+    }
+
+    if (distance < module.window_size) {
+        for (i = 0; i <= distance; i++) {
+            write_nak((module.sequence_number + i) & SEQUENCE_NUMBER_MASK);
+        }
+    }
+
+    return (0);
+}
+
 /**
  * Read a packet from the input channel and process it.
  */
@@ -246,11 +347,26 @@ static int handle_packet(void)
 
         length = (95 * length_msb + length_lsb);
 
+        /* The header checksum. */
         chan_read(module.chin_p, &value, sizeof(value));
-        /* Should compare the checksums here. */
+
+        if (value != encode(checksum_fold(actual_checksum))) {
+            std_printf(FSTR("error: bad header checksum\r\n"));
+
+            return (write_nak(module.sequence_number));
+        }
+
         actual_checksum += value;
     }
 
+    /* The remaining packet bytes are discarded when the next packet
+       is searched for. */
+    if (length - 1 > (int)sizeof(module.input.buf)) {
+        std_printf(FSTR("error: packet too long\r\n"));
+
+        return (write_nak(module.sequence_number));
+    }
+
     /* Read the packet. */
     module.input.size = 0;
 
@@ -261,9 +377,7 @@ static int handle_packet(void)
         module.input.buf[module.input.size++] = value;
     }
 
-    actual_checksum += ((actual_checksum >> 6) & 0x03);
-    actual_checksum &= 0x3f;
-    actual_checksum = encode(actual_checksum);
+    actual_checksum = encode(checksum_fold(actual_checksum));
 
     /* Read the checksum. */
     chan_read(module.chin_p, &value, sizeof(value));
@@ -276,7 +390,7 @@ static int handle_packet(void)
                    actual_checksum,
                    expected_checksum);
 
-        return (-1);
+        return (write_nak(module.sequence_number));
     }
 
     /* Read end character. */
@@ -285,14 +399,21 @@ static int handle_packet(void)
     if (value != END_OF_LINE) {
         std_printf(FSTR("error: bad end character %d\r\n"), value);
 
-        return (-1);
+        return (write_nak(module.sequence_number));
     }
 
-    switch (type) {
+    /* A send packet (re)starts the transfer. */
+    if (type == PACKET_TYPE_SEND) {
+        return (handle_send(sequence_number));
+    }
 
-    case PACKET_TYPE_SEND:
-        res = handle_send(sequence_number);
-        break;
+    if (sequence_number != module.sequence_number) {
+        return (handle_out_of_sequence(sequence_number));
+    }
+
+    module.sequence_number = ((sequence_number + 1) & SEQUENCE_NUMBER_MASK);
+
+    switch (type) {
 
     case PACKET_TYPE_DATA:
         res = handle_data(sequence_number);
@@ -358,6 +479,9 @@ int upgrade_kermit_load_file()
         return (-1);
     }
 
+    module.sequence_number = 0;
+    module.window_size = 1;
+
     while (1) {
         res = handle_packet();
 
@@ -31,8 +31,16 @@
 /* Application valid flag. */
 #define APPLICATION_VALID_FLAG                             0xbe
 
+/* The maximum TransferData request length, including the service id
+   and the block sequence counter. */
+#define MAX_NUMBER_OF_BLOCK_LENGTH CONFIG_UPGRADE_UDS_MAX_NUMBER_OF_BLOCK_LENGTH
+
 /* The maximum data transfer size. */
-#define TRANSFER_DATA_SIZE_MAX                             4096
+#define TRANSFER_DATA_SIZE_MAX           (MAX_NUMBER_OF_BLOCK_LENGTH - 2)
+
+/* Transferred data is read from the input channel and written to the
+   memory in chunks of this size. */
+#define WRITE_CHUNK_SIZE                                    256
 
 /* Data IDentifiers (DID). */
 #define DID_VERSION                                      0xf000
@@ -132,7 +140,7 @@ static int write_application(struct upgrade_uds_t *self_p,
                              size_t size)
 {
     size_t left;
-    uint8_t buffer[TRANSFER_DATA_SIZE_MAX];
+    uint8_t buffer[WRITE_CHUNK_SIZE];
     size_t n;
 
     left = size;
@@ -632,6 +640,7 @@ static int handle_request_download(struct upgrade_uds_t *self_p,
 
     /* Save the address and size. */
     self_p->swdl.next_block_sequence_counter = 1;
+    self_p->swdl.has_previous_block = 0;
 
     if (upgrade_binary_upload_begin() != 0) {
         ignore_and_write_negative_response(self_p,
@@ -650,10 +659,10 @@ static int handle_request_download(struct upgrade_uds_t *self_p,
                    (REQUEST_DOWNLOAD | POSITIVE_RESPONSE));
 
     buf[0] = 0x40;
-    buf[1] = ((TRANSFER_DATA_SIZE_MAX >> 24) & 0xff);
-    buf[2] = ((TRANSFER_DATA_SIZE_MAX >> 16) & 0xff);
-    buf[3] = ((TRANSFER_DATA_SIZE_MAX >> 8) & 0xff);
-    buf[4] = ((TRANSFER_DATA_SIZE_MAX >> 0) & 0xff);
+    buf[1] = ((MAX_NUMBER_OF_BLOCK_LENGTH >> 24) & 0xff);
+    buf[2] = ((MAX_NUMBER_OF_BLOCK_LENGTH >> 16) & 0xff);
+    buf[3] = ((MAX_NUMBER_OF_BLOCK_LENGTH >> 8) & 0xff);
+    buf[4] = ((MAX_NUMBER_OF_BLOCK_LENGTH >> 0) & 0xff);
 
     chan_write(self_p->chout_p, buf, sizeof(buf));
 
@@ -670,6 +679,11 @@ static int handle_request_download(struct upgrade_uds_t *self_p,
  * Data" service must be used several times in succession until all
  * data has arrived.
  *
+ * A request with the previous block sequence counter is a
+ * retransmission of a block that was already written, as the tester
+ * did not receive the response. It is answered positively without
+ * writing the data again.
+ *
  * @param[in] self_p UDS object..
  * @param[in] length Number of bytes left on the input channel.
  *
@@ -706,6 +720,31 @@ static int handle_transfer_data(struct upgrade_uds_t *self_p,
     chan_read(self_p->chin_p, &block_sequence_counter, sizeof(block_sequence_counter));
     length--;
 
+    /* At most the advertised block length. */
+    if (length > TRANSFER_DATA_SIZE_MAX) {
+        ignore_and_write_negative_response(self_p,
+                                           length,
+                                           TRANSFER_DATA,
+                                           REQUEST_OUT_OF_RANGE);
+
+        return (-1);
+    }
+
+    /* Acknowledge a retransmitted block again. */
+    if (self_p->swdl.has_previous_block
+        && (block_sequence_counter
+            == (uint8_t)(self_p->swdl.next_block_sequence_counter - 1))) {
+        ignore(self_p, length);
+        write_response(self_p,
+                       sizeof(block_sequence_counter),
+                       (TRANSFER_DATA | POSITIVE_RESPONSE));
+        chan_write(self_p->chout_p,
+                   &block_sequence_counter,
+                   sizeof(block_sequence_counter));
+
+        return (0);
+    }
+
     /* Only accept the expected sequence counter. */
     if (block_sequence_counter != self_p->swdl.next_block_sequence_counter) {
         ignore_and_write_negative_response(self_p,
@@ -719,6 +758,7 @@ static int handle_transfer_data(struct upgrade_uds_t *self_p,
     /* Write to the memory. */
     if (write_application(self_p, length) == 0) {
         self_p->swdl.next_block_sequence_counter++;
+        self_p->swdl.has_previous_block = 1;
         write_response(self_p,
                        sizeof(block_sequence_counter),
                        (TRANSFER_DATA | POSITIVE_RESPONSE));
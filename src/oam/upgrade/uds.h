@@ -41,6 +41,7 @@ struct upgrade_uds_t {
     void *chout_p;
     struct {
         uint8_t next_block_sequence_counter;
+        int has_previous_block;
     } swdl;
 };
 
@@ -0,0 +1,639 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2014-2018, Erik Moqvist
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use, copy,
+ * modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ * This file is part of the Simba project.
+ */
+
+#include "simba.h"
+
+/* Sine of 0 to pi / 2 in Q15, in DSP_FFT_LENGTH_MAX / 4 steps. */
+static const FAR int16_t sine_table[DSP_FFT_LENGTH_MAX / 4 + 1] = {
+    0, 201, 402, 603, 804, 1005, 1206, 1407,
+    1608, 1809, 2009, 2210, 2410, 2611, 2811, 3012,
+    3212, 3412, 3612, 3811, 4011, 4210, 4410, 4609,
+    4808, 5007, 5205, 5404, 5602, 5800, 5998, 6195,
+    6393, 6590, 6786, 6983, 7179, 7375, 7571, 7767,
+    7962, 8157, 8351, 8545, 8739, 8933, 9126, 9319,
+    9512, 9704, 9896, 10087, 10278, 10469, 10659, 10849,
+    11039, 11228, 11417, 11605, 11793, 11980, 12167, 12353,
+    12539, 12725, 12910, 13094, 13279, 13462, 13645, 13828,
+    14010, 14191, 14372, 14553, 14732, 14912, 15090, 15269,
+    15446, 15623, 15800, 15976, 16151, 16325, 16499, 16673,
+    16846, 17018, 17189, 17360, 17530, 17700, 17869, 18037,
+    18204, 18371, 18537, 18703, 18868, 19032, 19195, 19357,
+    19519, 19680, 19841, 20000, 20159, 20317, 20475, 20631,
+    20787, 20942, 21096, 21250, 21403, 21554, 21705, 21856,
+    22005, 22154, 22301, 22448, 22594, 22739, 22884, 23027,
+    23170, 23311, 23452, 23592, 23731, 23870, 24007, 24143,
+    24279, 24413, 24547, 24680, 24811, 24942, 25072, 25201,
+    25329, 25456, 25582, 25708, 25832, 25955, 26077, 26198,
+    26319, 26438, 26556, 26674, 26790, 26905, 27019, 27133,
+    27245, 27356, 27466, 27575, 27683, 27790, 27896, 28001,
+    28105, 28208, 28310, 28411, 28510, 28609, 28706, 28803,
+    28898, 28992, 29085, 29177, 29268, 29358, 29447, 29534,
+    29621, 29706, 29791, 29874, 29956, 30037, 30117, 30195,
+    30273, 30349, 30424, 30498, 30571, 30643, 30714, 30783,
+    30852, 30919, 30985, 31050, 31113, 31176, 31237, 31297,
+    31356, 31414, 31470, 31526, 31580, 31633, 31685, 31736,
+    31785, 31833, 31880, 31926, 31971, 32014, 32057, 32098,
+    32137, 32176, 32213, 32250, 32285, 32318, 32351, 32382,
+    32412, 32441, 32469, 32495, 32521, 32545, 32567, 32589,
+    32609, 32628, 32646, 32663, 32678, 32692, 32705, 32717,
+    32728, 32737, 32745, 32752, 32757, 32761, 32765, 32766,
+    32767
+};
+
+static int16_t saturate_q15(int64_t value)
+{
+    if (value > INT16_MAX) {
+        return (INT16_MAX);
+    } else if (value < INT16_MIN) {
+        return (INT16_MIN);
+    }
+
+    return (value);
+}
+
+static int32_t saturate_q31(int64_t value)
+{
+    if (value > INT32_MAX) {
+        return (INT32_MAX);
+    } else if (value < INT32_MIN) {
+        return (INT32_MIN);
+    }
+
+    return (value);
+}
+
+static uint32_t isqrt(uint32_t value)
+{
+    uint32_t root;
+    uint32_t bit;
+
+    root = 0;
+    bit = (1UL << 30);
+
+    while (bit > value) {
+        bit >>= 2;
+    }
+
+    while (bit != 0) {
+        if (value >= root + bit) {
+            value -= (root + bit);
+            root = ((root >> 1) + bit);
+        } else {
+            root >>= 1;
+        }
+
+        bit >>= 2;
+    }
+
+    return (root);
+}
+
+#if defined(__ARM_FEATURE_DSP)
+
+/**
+ * Dot product of given Q15 vectors, two multiplications per
+ * instruction.
+ */
+static int64_t dot_q15(const int16_t *a_p, const int16_t *b_p, int length)
+{
+    uint32_t lo;
+    uint32_t hi;
+    uint32_t a;
+    uint32_t b;
+    int64_t sum;
+    int i;
+
+    lo = 0;
+    hi = 0;
+
+    for (i = 0; i + 1 < length; i += 2) {
+        /* Unaligned word loads are allowed on Cortex-M4. */
+        memcpy(&a, &a_p[i], sizeof(a));
+        memcpy(&b, &b_p[i], sizeof(b));
+        asm volatile ("smlald %0, %1, %2, %3"
+                      : "+r" (lo), "+r" (hi)
+                      : "r" (a), "r" (b));
+    }
+
+    sum = (int64_t)(((uint64_t)hi << 32) | lo);
+
+    if (i < length) {
+        sum += ((int32_t)a_p[i] * b_p[i]);
+    }
+
+    return (sum);
+}
+
+#else
+
+static int64_t dot_q15(const int16_t *a_p, const int16_t *b_p, int length)
+{
+    int64_t sum;
+    int i;
+
+    sum = 0;
+
+    for (i = 0; i < length; i++) {
+        sum += ((int32_t)a_p[i] * b_p[i]);
+    }
+
+    return (sum);
+}
+
+#endif
+
+static int64_t dot_q31(const int32_t *a_p, const int32_t *b_p, int length)
+{
+    int64_t sum;
+    int i;
+
+    sum = 0;
+
+    for (i = 0; i < length; i++) {
+        sum += ((int64_t)a_p[i] * b_p[i]);
+    }
+
+    return (sum);
+}
+
+/**
+ * Add given sample to the filter state. Each sample is stored twice,
+ * so the last length samples are always contiguous, newest first,
+ * starting at the index.
+ */
+static void fir_q15_push(struct dsp_fir_q15_t *self_p, int16_t sample)
+{
+    if (self_p->index == 0) {
+        self_p->index = self_p->length;
+    }
+
+    self_p->index--;
+    self_p->state_p[self_p->index] = sample;
+    self_p->state_p[self_p->index + self_p->length] = sample;
+}
+
+static int16_t fir_q15_output(struct dsp_fir_q15_t *self_p)
+{
+    return (saturate_q15(dot_q15(&self_p->state_p[self_p->index],
+                                 self_p->coeffs_p,
+                                 self_p->length) >> 15));
+}
+
+/**
+ * Sine of given angle in Q15. The angle is in units of 2 * pi /
+ * DSP_FFT_LENGTH_MAX.
+ */
+static int16_t sine(int angle)
+{
+    angle &= (DSP_FFT_LENGTH_MAX - 1);
+
+    if (angle < DSP_FFT_LENGTH_MAX / 4) {
+        return (sine_table[angle]);
+    } else if (angle < DSP_FFT_LENGTH_MAX / 2) {
+        return (sine_table[DSP_FFT_LENGTH_MAX / 2 - angle]);
+    } else if (angle < 3 * DSP_FFT_LENGTH_MAX / 4) {
+        return (-sine_table[angle - DSP_FFT_LENGTH_MAX / 2]);
+    } else {
+        return (-sine_table[DSP_FFT_LENGTH_MAX - angle]);
+    }
+}
+
+static void bit_reverse(int16_t *buf_p, size_t length)
+{
+    size_t i;
+    size_t j;
+    size_t bit;
+    int16_t value;
+
+    j = 0;
+
+    for (i = 1; i < length; i++) {
+        bit = (length >> 1);
+
+        while (j & bit) {
+            j ^= bit;
+            bit >>= 1;
+        }
+
+        j |= bit;
+
+        if (i < j) {
+            value = buf_p[2 * i];
+            buf_p[2 * i] = buf_p[2 * j];
+            buf_p[2 * j] = value;
+            value = buf_p[2 * i + 1];
+            buf_p[2 * i + 1] = buf_p[2 * j + 1];
+            buf_p[2 * j + 1] = value;
+        }
+    }
+}
+
+int dsp_fir_q15_init(struct dsp_fir_q15_t *self_p,
+                     const int16_t *coeffs_p,
+                     int16_t *state_p,
+                     int length)
+{
+    ASSERTN(self_p != NULL, EINVAL);
+    ASSERTN(coeffs_p != NULL, EINVAL);
+    ASSERTN(state_p != NULL, EINVAL);
+    ASSERTN(length > 0, EINVAL);
+
+    self_p->coeffs_p = coeffs_p;
+    self_p->state_p = state_p;
+    self_p->length = length;
+    self_p->index = 0;
+    memset(state_p, 0, 2 * length * sizeof(*state_p));
+
+    return (0);
+}
+
+int dsp_fir_q15_process(struct dsp_fir_q15_t *self_p,
+                        const int16_t *src_p,
+                        int16_t *dst_p,
+                        size_t length)
+{
+    ASSERTN(self_p != NULL, EINVAL);
+    ASSERTN(src_p != NULL, EINVAL);
+    ASSERTN(dst_p != NULL, EINVAL);
+
+    size_t i;
+
+    for (i = 0; i < length; i++) {
+        fir_q15_push(self_p, src_p[i]);
+        dst_p[i] = fir_q15_output(self_p);
+    }
+
+    return (0);
+}
+
+int dsp_fir_q31_init(struct dsp_fir_q31_t *self_p,
+                     const int32_t *coeffs_p,
+                     int32_t *state_p,
+                     int length)
+{
+    ASSERTN(self_p != NULL, EINVAL);
+    ASSERTN(coeffs_p != NULL, EINVAL);
+    ASSERTN(state_p != NULL, EINVAL);
+    ASSERTN(length > 0, EINVAL);
+
+    self_p->coeffs_p = coeffs_p;
+    self_p->state_p = state_p;
+    self_p->length = length;
+    self_p->index = 0;
+    memset(state_p, 0, 2 * length * sizeof(*state_p));
+
+    return (0);
+}
+
+int dsp_fir_q31_process(struct dsp_fir_q31_t *self_p,
+                        const int32_t *src_p,
+                        int32_t *dst_p,
+                        size_t length)
+{
+    ASSERTN(self_p != NULL, EINVAL);
+    ASSERTN(src_p != NULL, EINVAL);
+    ASSERTN(dst_p != NULL, EINVAL);
+
+    size_t i;
+
+    for (i = 0; i < length; i++) {
+        if (self_p->index == 0) {
+            self_p->index = self_p->length;
+        }
+
+        self_p->index--;
+        self_p->state_p[self_p->index] = src_p[i];
+        self_p->state_p[self_p->index + self_p->length] = src_p[i];
+        dst_p[i] = saturate_q31(dot_q31(&self_p->state_p[self_p->index],
+                                        self_p->coeffs_p,
+                                        self_p->length) >> 31);
+    }
+
+    return (0);
+}
+
+int dsp_biquad_q15_init(struct dsp_biquad_q15_t *self_p,
+                        const int16_t *coeffs_p,
+                        int16_t *state_p,
+                        int number_of_stages,
+                        int post_shift)
+{
+    ASSERTN(self_p != NULL, EINVAL);
+    ASSERTN(coeffs_p != NULL, EINVAL);
+    ASSERTN(state_p != NULL, EINVAL);
+    ASSERTN(number_of_stages > 0, EINVAL);
+    ASSERTN((post_shift >= 0) && (post_shift < 15), EINVAL);
+
+    self_p->coeffs_p = coeffs_p;
+    self_p->state_p = state_p;
+    self_p->number_of_stages = number_of_stages;
+    self_p->post_shift = post_shift;
+    memset(state_p, 0, 4 * number_of_stages * sizeof(*state_p));
+
+    return (0);
+}
+
+int dsp_biquad_q15_process(struct dsp_biquad_q15_t *self_p,
+                           const int16_t *src_p,
+                           int16_t *dst_p,
+                           size_t length)
+{
+    ASSERTN(self_p != NULL, EINVAL);
+    ASSERTN(src_p != NULL, EINVAL);
+    ASSERTN(dst_p != NULL, EINVAL);
+
+    const int16_t *coeffs_p;
+    int16_t *state_p;
+    int64_t sum;
+    int16_t sample;
+    size_t i;
+    int stage;
+
+    for (i = 0; i < length; i++) {
+        sample = src_p[i];
+        coeffs_p = self_p->coeffs_p;
+        state_p = self_p->state_p;
+
+        for (stage = 0; stage < self_p->number_of_stages; stage++) {
+            sum = ((int32_t)coeffs_p[0] * sample
+                   + (int32_t)coeffs_p[1] * state_p[0]
+                   + (int32_t)coeffs_p[2] * state_p[1]);
+            sum -= ((int32_t)coeffs_p[3] * state_p[2]
+                    + (int32_t)coeffs_p[4] * state_p[3]);
+            state_p[1] = state_p[0];
+            state_p[0] = sample;
+            sample = saturate_q15(sum >> (15 - self_p->post_shift));
+            state_p[3] = state_p[2];
+            state_p[2] = sample;
+            coeffs_p += 5;
+            state_p += 4;
+        }
+
+        dst_p[i] = sample;
+    }
+
+    return (0);
+}
+
+int dsp_biquad_q31_init(struct dsp_biquad_q31_t *self_p,
+                        const int32_t *coeffs_p,
+                        int32_t *state_p,
+                        int number_of_stages,
+                        int post_shift)
+{
+    ASSERTN(self_p != NULL, EINVAL);
+    ASSERTN(coeffs_p != NULL, EINVAL);
+    ASSERTN(state_p != NULL, EINVAL);
+    ASSERTN(number_of_stages > 0, EINVAL);
+    ASSERTN((post_shift >= 0) && (post_shift < 31), EINVAL);
+
+    self_p->coeffs_p = coeffs_p;
+    self_p->state_p = state_p;
+    self_p->number_of_stages = number_of_stages;
+    self_p->post_shift = post_shift;
+    memset(state_p, 0, 4 * number_of_stages * sizeof(*state_p));
+
+    return (0);
+}
+
+int dsp_biquad_q31_process(struct dsp_biquad_q31_t *self_p,
+                           const int32_t *src_p,
+                           int32_t *dst_p,
+                           size_t length)
+{
+    ASSERTN(self_p != NULL, EINVAL);
+    ASSERTN(src_p != NULL, EINVAL);
+    ASSERTN(dst_p != NULL, EINVAL);
+
+    const int32_t *coeffs_p;
+    int32_t *state_p;
+    int64_t sum;
+    int32_t sample;
+    size_t i;
+    int stage;
+
+    for (i = 0; i < length; i++) {
+        sample = src_p[i];
+        coeffs_p = self_p->coeffs_p;
+        state_p = self_p->state_p;
+
+        for (stage = 0; stage < self_p->number_of_stages; stage++) {
+            sum = ((int64_t)coeffs_p[0] * sample
+                   + (int64_t)coeffs_p[1] * state_p[0]
+                   + (int64_t)coeffs_p[2] * state_p[1]);
+            sum -= ((int64_t)coeffs_p[3] * state_p[2]
+                    + (int64_t)coeffs_p[4] * state_p[3]);
+            state_p[1] = state_p[0];
+            state_p[0] = sample;
+            sample = saturate_q31(sum >> (31 - self_p->post_shift));
+            state_p[3] = state_p[2];
+            state_p[2] = sample;
+            coeffs_p += 5;
+            state_p += 4;
+        }
+
+        dst_p[i] = sample;
+    }
+
+    return (0);
+}
+
+int dsp_decimator_q15_init(struct dsp_decimator_q15_t *self_p,
+                           const int16_t *coeffs_p,
+                           int16_t *state_p,
+                           int length,
+                           int factor)
+{
+    ASSERTN(self_p != NULL, EINVAL);
+    ASSERTN(factor > 0, EINVAL);
+
+    self_p->factor = factor;
+    self_p->phase = 0;
+
+    return (dsp_fir_q15_init(&self_p->fir, coeffs_p, state_p, length));
+}
+
+ssize_t dsp_decimator_q15_process(struct dsp_decimator_q15_t *self_p,
+                                  const int16_t *src_p,
+                                  int16_t *dst_p,
+                                  size_t length)
+{
+    ASSERTN(self_p != NULL, EINVAL);
+    ASSERTN(src_p != NULL, EINVAL);
+    ASSERTN(dst_p != NULL, EINVAL);
+
+    size_t i;
+    ssize_t count;
+
+    count = 0;
+
+    for (i = 0; i < length; i++) {
+        fir_q15_push(&self_p->fir, src_p[i]);
+
+        if (self_p->phase == 0) {
+            dst_p[count] = fir_q15_output(&self_p->fir);
+            count++;
+        }
+
+        self_p->phase++;
+
+        if (self_p->phase == self_p->factor) {
+            self_p->phase = 0;
+        }
+    }
+
+    return (count);
+}
+
+int dsp_fft_q15(int16_t *buf_p, size_t length)
+{
+    ASSERTN(buf_p != NULL, EINVAL);
+    ASSERTN((length >= 2) && (length <= DSP_FFT_LENGTH_MAX), EINVAL);
+    ASSERTN((length & (length - 1)) == 0, EINVAL);
+
+    size_t size;
+    size_t half;
+    size_t start;
+    size_t k;
+    int step;
+    int16_t *a_p;
+    int16_t *b_p;
+    int32_t c;
+    int32_t s;
+    int32_t real;
+    int32_t imag;
+
+    bit_reverse(buf_p, length);
+
+    for (size = 2; size <= length; size *= 2) {
+        half = (size / 2);
+        step = (DSP_FFT_LENGTH_MAX / size);
+
+        for (start = 0; start < length; start += size) {
+            for (k = 0; k < half; k++) {
+                /* The twiddle factor is c - j * s. */
+                c = sine(k * step + DSP_FFT_LENGTH_MAX / 4);
+                s = sine(k * step);
+                a_p = &buf_p[2 * (start + k)];
+                b_p = &buf_p[2 * (start + k + half)];
+                real = ((c * b_p[0] + s * b_p[1] + 0x4000) >> 15);
+                imag = ((c * b_p[1] - s * b_p[0] + 0x4000) >> 15);
+                b_p[0] = saturate_q15((a_p[0] - real + 1) >> 1);
+                b_p[1] = saturate_q15((a_p[1] - imag + 1) >> 1);
+                a_p[0] = saturate_q15((a_p[0] + real + 1) >> 1);
+                a_p[1] = saturate_q15((a_p[1] + imag + 1) >> 1);
+            }
+        }
+    }
+
+    return (0);
+}
+
+int dsp_magnitude_q15(const int16_t *src_p, int16_t *dst_p, size_t length)
+{
+    ASSERTN(src_p != NULL, EINVAL);
+    ASSERTN(dst_p != NULL, EINVAL);
+
+    size_t i;
+    int32_t real;
+    int32_t imag;
+
+    for (i = 0; i < length; i++) {
+        real = src_p[2 * i];
+        imag = src_p[2 * i + 1];
+        dst_p[i] = saturate_q15(isqrt((uint32_t)(real * real)
+                                      + (uint32_t)(imag * imag)));
+    }
+
+    return (0);
+}
+
+int32_t dsp_rms_q15(const int16_t *buf_p, size_t length)
+{
+    ASSERTN(buf_p != NULL, EINVAL);
+    ASSERTN(length > 0, EINVAL);
+
+    uint64_t sum;
+    size_t i;
+
+    sum = 0;
+
+    for (i = 0; i < length; i++) {
+        sum += ((int32_t)buf_p[i] * buf_p[i]);
+    }
+
+    return (saturate_q15(isqrt(sum / length)));
+}
+
+int32_t dsp_peak_q15(const int16_t *buf_p, size_t length)
+{
+    ASSERTN(buf_p != NULL, EINVAL);
+
+    int32_t peak;
+    int32_t value;
+    size_t i;
+
+    peak = 0;
+
+    for (i = 0; i < length; i++) {
+        value = buf_p[i];
+
+        if (value < 0) {
+            value = -value;
+        }
+
+        if (value > peak) {
+            peak = value;
+        }
+    }
+
+    return (saturate_q15(peak));
+}
+
+int dsp_q15_from_adc(const uint16_t *src_p,
+                     int16_t *dst_p,
+                     size_t length,
+                     int resolution)
+{
+    ASSERTN(src_p != NULL, EINVAL);
+    ASSERTN(dst_p != NULL, EINVAL);
+    ASSERTN((resolution > 0) && (resolution <= 16), EINVAL);
+
+    size_t i;
+    int32_t offset;
+    int32_t scale;
+
+    offset = (1L << (resolution - 1));
+    scale = (1L << (16 - resolution));
+
+    for (i = 0; i < length; i++) {
+        dst_p[i] = (((int32_t)src_p[i] - offset) * scale);
+    }
+
+    return (0);
+}
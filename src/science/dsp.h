@@ -0,0 +1,335 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2014-2018, Erik Moqvist
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use, copy,
+ * modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ * This file is part of the Simba project.
+ */
+
+#ifndef __SCIENCE_DSP_H__
+#define __SCIENCE_DSP_H__
+
+#include "simba.h"
+
+/** Maximum FFT length. */
+#define DSP_FFT_LENGTH_MAX                               1024
+
+/**
+ * Q15 finite impulse response filter.
+ */
+struct dsp_fir_q15_t {
+    const int16_t *coeffs_p;
+    int16_t *state_p;
+    int length;
+    int index;
+};
+
+/**
+ * Q31 finite impulse response filter.
+ */
+struct dsp_fir_q31_t {
+    const int32_t *coeffs_p;
+    int32_t *state_p;
+    int length;
+    int index;
+};
+
+/**
+ * Cascaded Q15 biquad infinite impulse response filter.
+ */
+struct dsp_biquad_q15_t {
+    const int16_t *coeffs_p;
+    int16_t *state_p;
+    int number_of_stages;
+    int post_shift;
+};
+
+/**
+ * Cascaded Q31 biquad infinite impulse response filter.
+ */
+struct dsp_biquad_q31_t {
+    const int32_t *coeffs_p;
+    int32_t *state_p;
+    int number_of_stages;
+    int post_shift;
+};
+
+/**
+ * Q15 FIR filter and decimator.
+ */
+struct dsp_decimator_q15_t {
+    struct dsp_fir_q15_t fir;
+    int factor;
+    int phase;
+};
+
+/**
+ * Initialize given Q15 FIR filter. The output sample is the sum of
+ * the coefficient and input sample products, y[n] = c[0] * x[n] +
+ * c[1] * x[n - 1] + ... + c[length - 1] * x[n - length + 1],
+ * saturated to Q15.
+ *
+ * The filter is computed with two 16 bit multiplications per
+ * instruction on ARM Cortex-M4.
+ *
+ * @param[out] self_p Filter to initialize.
+ * @param[in] coeffs_p Filter coefficients.
+ * @param[in] state_p State buffer of two times length samples. It
+ *                    must not be modified by the caller.
+ * @param[in] length Number of coefficients.
+ *
+ * @return zero(0) or negative error code.
+ */
+int dsp_fir_q15_init(struct dsp_fir_q15_t *self_p,
+                     const int16_t *coeffs_p,
+                     int16_t *state_p,
+                     int length);
+
+/**
+ * Filter given samples. The input and output buffers may be the
+ * same.
+ *
+ * @param[in] self_p Initialized filter.
+ * @param[in] src_p Input samples.
+ * @param[out] dst_p Output samples.
+ * @param[in] length Number of samples.
+ *
+ * @return zero(0) or negative error code.
+ */
+int dsp_fir_q15_process(struct dsp_fir_q15_t *self_p,
+                        const int16_t *src_p,
+                        int16_t *dst_p,
+                        size_t length);
+
+/**
+ * Initialize given Q31 FIR filter. See `dsp_fir_q15_init()`. The sum
+ * is calculated in 64 bits without overflow detection, so scale the
+ * input down by the 2-logarithm of the length bits for full scale
+ * signals.
+ *
+ * @param[out] self_p Filter to initialize.
+ * @param[in] coeffs_p Filter coefficients.
+ * @param[in] state_p State buffer of two times length samples. It
+ *                    must not be modified by the caller.
+ * @param[in] length Number of coefficients.
+ *
+ * @return zero(0) or negative error code.
+ */
+int dsp_fir_q31_init(struct dsp_fir_q31_t *self_p,
+                     const int32_t *coeffs_p,
+                     int32_t *state_p,
+                     int length);
+
+/**
+ * Filter given samples. The input and output buffers may be the
+ * same.
+ *
+ * @param[in] self_p Initialized filter.
+ * @param[in] src_p Input samples.
+ * @param[out] dst_p Output samples.
+ * @param[in] length Number of samples.
+ *
+ * @return zero(0) or negative error code.
+ */
+int dsp_fir_q31_process(struct dsp_fir_q31_t *self_p,
+                        const int32_t *src_p,
+                        int32_t *dst_p,
+                        size_t length);
+
+/**
+ * Initialize given cascaded Q15 biquad filter. Each stage has the
+ * five coefficients b0, b1, b2, a1 and a2 of the transfer function
+ * H(z) = (b0 + b1 * z^-1 + b2 * z^-2) / (1 + a1 * z^-1 + a2 * z^-2),
+ * all divided by two to the power of given post shift to fit in the
+ * Q15 range.
+ *
+ * @param[out] self_p Filter to initialize.
+ * @param[in] coeffs_p Five coefficients per stage, first stage first.
+ * @param[in] state_p State buffer of four samples per stage. It must
+ *                    not be modified by the caller.
+ * @param[in] number_of_stages Number of stages.
+ * @param[in] post_shift Coefficient scaling, 0 to 14.
+ *
+ * @return zero(0) or negative error code.
+ */
+int dsp_biquad_q15_init(struct dsp_biquad_q15_t *self_p,
+                        const int16_t *coeffs_p,
+                        int16_t *state_p,
+                        int number_of_stages,
+                        int post_shift);
+
+/**
+ * Filter given samples. The input and output buffers may be the
+ * same.
+ *
+ * @param[in] self_p Initialized filter.
+ * @param[in] src_p Input samples.
+ * @param[out] dst_p Output samples.
+ * @param[in] length Number of samples.
+ *
+ * @return zero(0) or negative error code.
+ */
+int dsp_biquad_q15_process(struct dsp_biquad_q15_t *self_p,
+                           const int16_t *src_p,
+                           int16_t *dst_p,
+                           size_t length);
+
+/**
+ * Initialize given cascaded Q31 biquad filter. See
+ * `dsp_biquad_q15_init()`.
+ *
+ * @param[out] self_p Filter to initialize.
+ * @param[in] coeffs_p Five coefficients per stage, first stage first.
+ * @param[in] state_p State buffer of four samples per stage. It must
+ *                    not be modified by the caller.
+ * @param[in] number_of_stages Number of stages.
+ * @param[in] post_shift Coefficient scaling, 0 to 30.
+ *
+ * @return zero(0) or negative error code.
+ */
+int dsp_biquad_q31_init(struct dsp_biquad_q31_t *self_p,
+                        const int32_t *coeffs_p,
+                        int32_t *state_p,
+                        int number_of_stages,
+                        int post_shift);
+
+/**
+ * Filter given samples. The input and output buffers may be the
+ * same.
+ *
+ * @param[in] self_p Initialized filter.
+ * @param[in] src_p Input samples.
+ * @param[out] dst_p Output samples.
+ * @param[in] length Number of samples.
+ *
+ * @return zero(0) or negative error code.
+ */
+int dsp_biquad_q31_process(struct dsp_biquad_q31_t *self_p,
+                           const int32_t *src_p,
+                           int32_t *dst_p,
+                           size_t length);
+
+/**
+ * Initialize given decimator. The input is low pass filtered by given
+ * FIR filter and every factor:th filtered sample is output. Only the
+ * output samples are calculated.
+ *
+ * @param[out] self_p Decimator to initialize.
+ * @param[in] coeffs_p FIR filter coefficients.
+ * @param[in] state_p State buffer of two times length samples.
+ * @param[in] length Number of coefficients.
+ * @param[in] factor Decimation factor.
+ *
+ * @return zero(0) or negative error code.
+ */
+int dsp_decimator_q15_init(struct dsp_decimator_q15_t *self_p,
+                           const int16_t *coeffs_p,
+                           int16_t *state_p,
+                           int length,
+                           int factor);
+
+/**
+ * Decimate given samples. The input and output buffers may be the
+ * same. The phase is kept between calls, so the input length does
+ * not have to be a multiple of the factor.
+ *
+ * @param[in] self_p Initialized decimator.
+ * @param[in] src_p Input samples.
+ * @param[out] dst_p Output samples. Room for at least length divided
+ *                   by factor, rounded up, samples.
+ * @param[in] length Number of input samples.
+ *
+ * @return Number of output samples or negative error code.
+ */
+ssize_t dsp_decimator_q15_process(struct dsp_decimator_q15_t *self_p,
+                                  const int16_t *src_p,
+                                  int16_t *dst_p,
+                                  size_t length);
+
+/**
+ * In place radix-2 fast fourier transform of given complex Q15
+ * samples. The samples are scaled by 1/2 in each stage to avoid
+ * overflow, so the output is the discrete fourier transform divided
+ * by the length.
+ *
+ * @param[in,out] buf_p Interleaved real and imaginary parts of the
+ *                      samples, two times length values.
+ * @param[in] length Number of complex samples, a power of two from 2
+ *                   to ``DSP_FFT_LENGTH_MAX``, inclusive.
+ *
+ * @return zero(0) or negative error code.
+ */
+int dsp_fft_q15(int16_t *buf_p, size_t length);
+
+/**
+ * Calculate the magnitudes of given complex Q15 samples, for example
+ * the output of `dsp_fft_q15()`. The input and output buffers may be
+ * the same.
+ *
+ * @param[in] src_p Interleaved real and imaginary parts of the
+ *                  samples, two times length values.
+ * @param[out] dst_p Magnitudes.
+ * @param[in] length Number of complex samples.
+ *
+ * @return zero(0) or negative error code.
+ */
+int dsp_magnitude_q15(const int16_t *src_p, int16_t *dst_p, size_t length);
+
+/**
+ * Calculate the root mean square of given samples.
+ *
+ * @param[in] buf_p Samples.
+ * @param[in] length Number of samples.
+ *
+ * @return Root mean square, saturated to Q15, or negative error code.
+ */
+int32_t dsp_rms_q15(const int16_t *buf_p, size_t length);
+
+/**
+ * Find the largest absolute value of given samples.
+ *
+ * @param[in] buf_p Samples.
+ * @param[in] length Number of samples.
+ *
+ * @return Peak value, saturated to Q15, or negative error code.
+ */
+int32_t dsp_peak_q15(const int16_t *buf_p, size_t length);
+
+/**
+ * Convert given unsigned ADC samples, for example read from an ADC
+ * stream, to signed Q15 samples centered at half the ADC range. The
+ * input and output buffers may be the same.
+ *
+ * @param[in] src_p ADC samples.
+ * @param[out] dst_p Q15 samples.
+ * @param[in] length Number of samples.
+ * @param[in] resolution ADC resolution in bits, 1 to 16.
+ *
+ * @return zero(0) or negative error code.
+ */
+int dsp_q15_from_adc(const uint16_t *src_p,
+                     int16_t *dst_p,
+                     size_t length,
+                     int resolution);
+
+#endif
@@ -35,6 +35,200 @@
 /* Inverse log base 2 of 10. */
 #define INV_LOG2_10_Q1DOT31 UINT64_C(0x268826a1)
 
+/* Log base 2 of e. */
+#define LOG2_E_Q2DOT30      INT64_C(1549082005)
+
+/* Natural logarithm of 2. */
+#define LN2_Q0DOT32         UINT64_C(2977044472)
+
+/* Turns per radian, 1 / (2 * pi). */
+#define TURNS_PER_RADIAN_Q0DOT32 INT64_C(683565276)
+
+/* Pi. */
+#define PI_Q2DOT30          INT64_C(3373259426)
+
+/* Sine of 0 to pi / 2 in 256 steps. */
+static const FAR int32_t sine_q2dot30[257] = {
+    0, 6588356, 13176464, 19764076, 26350943, 32936819,
+    39521455, 46104602, 52686014, 59265442, 65842639, 72417357,
+    78989349, 85558366, 92124163, 98686491, 105245103, 111799753,
+    118350194, 124896179, 131437462, 137973796, 144504935, 151030634,
+    157550647, 164064728, 170572633, 177074115, 183568930, 190056834,
+    196537583, 203010932, 209476638, 215934457, 222384147, 228825464,
+    235258165, 241682010, 248096755, 254502159, 260897982, 267283981,
+    273659918, 280025552, 286380643, 292724951, 299058239, 305380268,
+    311690799, 317989595, 324276419, 330551034, 336813204, 343062693,
+    349299266, 355522689, 361732726, 367929144, 374111709, 380280190,
+    386434353, 392573967, 398698801, 404808624, 410903207, 416982319,
+    423045732, 429093217, 435124548, 441139496, 447137835, 453119340,
+    459083786, 465030947, 470960600, 476872522, 482766489, 488642281,
+    494499676, 500338453, 506158392, 511959275, 517740883, 523502998,
+    529245404, 534967884, 540670223, 546352205, 552013618, 557654248,
+    563273883, 568872310, 574449320, 580004702, 585538248, 591049748,
+    596538995, 602005783, 607449906, 612871159, 618269338, 623644239,
+    628995660, 634323400, 639627258, 644907034, 650162530, 655393548,
+    660599890, 665781362, 670937767, 676068911, 681174602, 686254647,
+    691308855, 696337036, 701339000, 706314559, 711263525, 716185713,
+    721080937, 725949013, 730789757, 735602987, 740388522, 745146182,
+    749875788, 754577161, 759250125, 763894504, 768510122, 773096806,
+    777654384, 782182683, 786681534, 791150767, 795590213, 799999706,
+    804379079, 808728167, 813046808, 817334838, 821592095, 825818421,
+    830013654, 834177638, 838310216, 842411232, 846480531, 850517961,
+    854523370, 858496606, 862437520, 866345964, 870221790, 874064853,
+    877875009, 881652112, 885396022, 889106597, 892783698, 896427186,
+    900036924, 903612776, 907154608, 910662286, 914135678, 917574653,
+    920979082, 924348837, 927683790, 930983817, 934248793, 937478595,
+    940673101, 943832191, 946955747, 950043650, 953095785, 956112036,
+    959092290, 962036435, 964944360, 967815955, 970651112, 973449725,
+    976211688, 978936898, 981625251, 984276646, 986890984, 989468165,
+    992008094, 994510675, 996975812, 999403415, 1001793390, 1004145648,
+    1006460100, 1008736660, 1010975242, 1013175761, 1015338134, 1017462281,
+    1019548121, 1021595575, 1023604567, 1025575020, 1027506862, 1029400018,
+    1031254418, 1033069992, 1034846671, 1036584389, 1038283080, 1039942680,
+    1041563127, 1043144360, 1044686319, 1046188946, 1047652185, 1049075980,
+    1050460278, 1051805027, 1053110176, 1054375676, 1055601479, 1056787540,
+    1057933813, 1059040255, 1060106826, 1061133483, 1062120190, 1063066909,
+    1063973603, 1064840240, 1065666786, 1066453210, 1067199483, 1067905576,
+    1068571464, 1069197120, 1069782521, 1070327646, 1070832474, 1071296985,
+    1071721163, 1072104991, 1072448455, 1072751542, 1073014240, 1073236540,
+    1073418433, 1073559913, 1073660973, 1073721611, 1073741824
+};
+
+/* 2 to the power of 0 to 63 / 64 in 64 steps. */
+static const FAR uint32_t exp2_q2dot30[64] = {
+    1073741824, 1085434106, 1097253708, 1109202018, 1121280436, 1133490379,
+    1145833280, 1158310587, 1170923762, 1183674286, 1196563654, 1209593378,
+    1222764986, 1236080024, 1249540052, 1263146652, 1276901417, 1290805962,
+    1304861917, 1319070932, 1333434672, 1347954824, 1362633090, 1377471191,
+    1392470869, 1407633882, 1422962010, 1438457051, 1454120821, 1469955159,
+    1485961921, 1502142985, 1518500250, 1535035634, 1551751076, 1568648537,
+    1585730000, 1602997467, 1620452965, 1638098541, 1655936265, 1673968228,
+    1692196547, 1710623359, 1729250827, 1748081133, 1767116489, 1786359126,
+    1805811301, 1825475297, 1845353420, 1865448001, 1885761398, 1906295993,
+    1927054196, 1948038440, 1969251188, 1990694927, 2012372174, 2034285470,
+    2056437387, 2078830522, 2101467502, 2124350982
+};
+
+/* Arc tangent of 2 to the power of 0 to -30, in radians. */
+static const FAR int32_t atan_q2dot30[31] = {
+    843314857, 497837829, 263043837, 133525159, 67021687, 33543516,
+    16775851, 8388437, 4194283, 2097149, 1048576, 524288,
+    262144, 131072, 65536, 32768, 16384, 8192,
+    4096, 2048, 1024, 512, 256, 128,
+    64, 32, 16, 8, 4, 2,
+    1
+};
+
+/**
+ * Sine of given phase, where 2 to the power of 32 is one turn, in
+ * Q2.30.
+ */
+static int32_t sine_of_phase(uint32_t phase)
+{
+    uint32_t position;
+    int index;
+    int32_t fraction;
+    int32_t value;
+
+    /* The position within the quadrant, mirrored in the second and
+       fourth quadrants. */
+    position = (phase & 0x3fffffff);
+
+    if (phase & 0x40000000) {
+        position = (0x40000000 - position);
+    }
+
+    index = (position >> 22);
+
+    if (index == 256) {
+        value = sine_q2dot30[256];
+    } else {
+        /* Linear interpolation between the table entries. */
+        fraction = ((position >> 6) & 0xffff);
+        value = (sine_q2dot30[index]
+                 + (((int64_t)(sine_q2dot30[index + 1] - sine_q2dot30[index])
+                     * fraction) >> 16));
+    }
+
+    if (phase & 0x80000000) {
+        value = -value;
+    }
+
+    return (value);
+}
+
+/**
+ * Convert given angle in radians to a phase, where 2 to the power of
+ * 32 is one turn.
+ */
+static uint32_t radians_to_phase(int32_t angle, int precision)
+{
+    return ((uint32_t)(((int64_t)angle * TURNS_PER_RADIAN_Q0DOT32)
+                       >> precision));
+}
+
+/**
+ * Shift given value right, rounding to nearest.
+ */
+static int64_t shift_right_round(int64_t value, int shift)
+{
+    if (shift == 0) {
+        return (value);
+    }
+
+    return ((value + ((int64_t)1 << (shift - 1))) >> shift);
+}
+
+/**
+ * 2 to the power of given exponent in x precision, in given
+ * precision.
+ */
+static int32_t exp2_fixed_point(int64_t x, int x_precision, int precision)
+{
+    int64_t integer;
+    uint32_t fraction;
+    int64_t u;
+    int64_t u2;
+    int64_t u3;
+    int64_t polynomial;
+    int64_t mantissa;
+    int64_t shift;
+
+    /* x = integer + fraction, where 0 <= fraction < 1. */
+    integer = (x >> x_precision);
+
+    if (x_precision >= 32) {
+        fraction = (uint32_t)(x >> (x_precision - 32));
+    } else {
+        fraction = ((uint32_t)x << (32 - x_precision));
+    }
+
+    /* 2^fraction = 2^(index / 64) * 2^remainder, where 2^remainder =
+       e^u is calculated with a third degree Taylor polynomial. */
+    u = ((((uint64_t)(fraction & 0x3ffffff)) * LN2_Q0DOT32) >> 34);
+    u2 = ((u * u) >> 30);
+    u3 = ((u2 * u) >> 30);
+    polynomial = ((INT64_C(1) << 30) + u + u2 / 2 + u3 / 6);
+    mantissa = ((exp2_q2dot30[fraction >> 26] * polynomial) >> 30);
+
+    /* mantissa * 2^integer in given precision. */
+    shift = (integer + precision - 30);
+
+    if (shift > 0) {
+        return (INT32_MAX);
+    } else if (shift < -62) {
+        return (0);
+    }
+
+    mantissa = shift_right_round(mantissa, -shift);
+
+    if (mantissa > INT32_MAX) {
+        return (INT32_MAX);
+    }
+
+    return (mantissa);
+}
+
 #if CONFIG_FLOAT == 1
 
 float math_radians_to_degrees(float value)
@@ -111,3 +305,125 @@ int32_t math_log10_fixed_point(uint32_t x, int precision)
 
     return (y >> 31);
 }
+
+uint32_t math_sqrt_fixed_point(uint32_t x, int precision)
+{
+    ASSERTN((precision > 0) && (precision < 32), EINVAL);
+
+    uint64_t value;
+    uint64_t root;
+    uint64_t bit;
+
+    value = ((uint64_t)x << precision);
+    root = 0;
+    bit = ((uint64_t)1 << 62);
+
+    while (bit > value) {
+        bit >>= 2;
+    }
+
+    while (bit != 0) {
+        if (value >= root + bit) {
+            value -= (root + bit);
+            root = ((root >> 1) + bit);
+        } else {
+            root >>= 1;
+        }
+
+        bit >>= 2;
+    }
+
+    return (root);
+}
+
+int32_t math_sin_fixed_point(int32_t angle, int precision)
+{
+    ASSERTN((precision > 0) && (precision < 31), EINVAL);
+
+    return (shift_right_round(sine_of_phase(radians_to_phase(angle,
+                                                             precision)),
+                              30 - precision));
+}
+
+int32_t math_cos_fixed_point(int32_t angle, int precision)
+{
+    ASSERTN((precision > 0) && (precision < 31), EINVAL);
+
+    return (shift_right_round(
+                sine_of_phase(radians_to_phase(angle, precision) + 0x40000000),
+                30 - precision));
+}
+
+int32_t math_atan2_fixed_point(int32_t y, int32_t x, int precision)
+{
+    ASSERTN((precision > 0) && (precision < 30), EINVAL);
+
+    int64_t x64;
+    int64_t y64;
+    int64_t x_next;
+    int64_t angle;
+    int i;
+
+    if ((x == 0) && (y == 0)) {
+        return (0);
+    }
+
+    x64 = x;
+    y64 = y;
+    angle = 0;
+
+    /* Rotate to the right half plane. */
+    if (x64 < 0) {
+        x64 = -x64;
+        y64 = -y64;
+
+        if (y >= 0) {
+            angle = PI_Q2DOT30;
+        } else {
+            angle = -PI_Q2DOT30;
+        }
+    }
+
+    /* Scale up small vectors for accuracy. The CORDIC gain of 1.65
+       cannot overflow. */
+    while ((x64 < ((int64_t)1 << 40))
+           && (y64 < ((int64_t)1 << 40))
+           && (y64 > -((int64_t)1 << 40))) {
+        x64 <<= 1;
+        y64 <<= 1;
+    }
+
+    /* CORDIC vectoring mode, rotate the vector to the x-axis. */
+    for (i = 0; i < membersof(atan_q2dot30); i++) {
+        if (y64 > 0) {
+            x_next = (x64 + (y64 >> i));
+            y64 -= (x64 >> i);
+            angle += atan_q2dot30[i];
+        } else {
+            x_next = (x64 - (y64 >> i));
+            y64 += (x64 >> i);
+            angle -= atan_q2dot30[i];
+        }
+
+        x64 = x_next;
+    }
+
+    return (shift_right_round(angle, 30 - precision));
+}
+
+int32_t math_exp2_fixed_point(int32_t x, int precision)
+{
+    ASSERTN((precision > 0) && (precision < 31), EINVAL);
+
+    return (exp2_fixed_point(x, precision, precision));
+}
+
+int32_t math_exp_fixed_point(int32_t x, int precision)
+{
+    ASSERTN((precision > 0) && (precision < 31), EINVAL);
+
+    /* e^x = 2^(x * log2(e)). */
+    return (exp2_fixed_point((int64_t)x * LOG2_E_Q2DOT30,
+                             precision + 30,
+                             precision));
+}
@@ -88,4 +88,86 @@ int32_t math_ln_fixed_point(uint32_t x, int precision);
  */
 int32_t math_log10_fixed_point(uint32_t x, int precision);
 
+/**
+ * Calculate the square root of given value in given fixed point
+ * precision. The result is rounded down.
+ *
+ * @param[in] x Value to calculate the square root of.
+ * @param[in] precision Fixed point precision in the range 1 to 31,
+ *                      inclusive.
+ *
+ * @return Square root of given value x, in given precision.
+ */
+uint32_t math_sqrt_fixed_point(uint32_t x, int precision);
+
+/**
+ * Calculate the sine of given angle in given fixed point
+ * precision. The sine is interpolated linearly between the entries
+ * of a 256 entries quarter wave table. The error is less than 5e-6,
+ * plus one unit in the last place of given precision.
+ *
+ * @param[in] angle Angle in radians. Any value is allowed.
+ * @param[in] precision Fixed point precision of the angle and the
+ *                      result, in the range 1 to 30, inclusive.
+ *
+ * @return Sine of given angle, in given precision.
+ */
+int32_t math_sin_fixed_point(int32_t angle, int precision);
+
+/**
+ * Calculate the cosine of given angle in given fixed point
+ * precision. See `math_sin_fixed_point()` for the error.
+ *
+ * @param[in] angle Angle in radians. Any value is allowed.
+ * @param[in] precision Fixed point precision of the angle and the
+ *                      result, in the range 1 to 30, inclusive.
+ *
+ * @return Cosine of given angle, in given precision.
+ */
+int32_t math_cos_fixed_point(int32_t angle, int precision);
+
+/**
+ * Calculate the angle of the vector (x, y) using CORDIC, in given
+ * fixed point precision. x and y may have any, but the same, scale.
+ * The error is less than 1e-8 radians, plus one unit in the last
+ * place of given precision.
+ *
+ * @param[in] y Y-coordinate.
+ * @param[in] x X-coordinate.
+ * @param[in] precision Fixed point precision of the result in the
+ *                      range 1 to 29, inclusive.
+ *
+ * @return Angle in radians in the range -pi to pi, inclusive, in
+ *         given precision. Zero(0) if both x and y are zero.
+ */
+int32_t math_atan2_fixed_point(int32_t y, int32_t x, int precision);
+
+/**
+ * Calculate 2 to the power of given value in given fixed point
+ * precision. A 64 entries table and a third degree polynomial are
+ * used. The relative error is less than 1e-8, plus one unit in the
+ * last place of given precision.
+ *
+ * @param[in] x Exponent.
+ * @param[in] precision Fixed point precision of the exponent and the
+ *                      result, in the range 1 to 30, inclusive.
+ *
+ * @return 2 to the power of x in given precision, saturated to
+ *         INT32_MAX.
+ */
+int32_t math_exp2_fixed_point(int32_t x, int precision);
+
+/**
+ * Calculate e to the power of given value in given fixed point
+ * precision. See `math_exp2_fixed_point()` for the error.
+ *
+ * @param[in] x Exponent.
+ * @param[in] precision Fixed point precision of the exponent and the
+ *                      result, in the range 1 to 30, inclusive.
+ *
+ * @return e to the power of x in given precision, saturated to
+ *         INT32_MAX.
+ */
+int32_t math_exp_fixed_point(int32_t x, int precision);
+
 #endif
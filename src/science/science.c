@@ -35,11 +35,116 @@
 #define SEA_LEVEL_TEMPERATURE                    288.15
 #define TEMPERATURE_LAPSE_RATE                   0.0065
 
+/* (IDEAL_GAS_CONSTANT * TEMPERATURE_LAPSE_RATE)
+   / (EARTH_SURFACE_GRAVITATIONAL_ACCELERATION * MOLAR_MASS). */
+#define RL_GM_Q8DOT24                            INT64_C(3192087)
+
+/* The inverse of RL_GM. */
+#define GM_RL_Q8DOT24                            INT64_C(88178969)
+
+/* SEA_LEVEL_TEMPERATURE / TEMPERATURE_LAPSE_RATE. */
+#define T0_L_Q24DOT8                             INT64_C(11348677)
+
+/* TEMPERATURE_LAPSE_RATE / SEA_LEVEL_TEMPERATURE. */
+#define L_T0_Q0DOT40                             INT64_C(24802449)
+
+/* Speed conversion factors. */
+#define MPS_TO_KMPH_Q8DOT24                      INT64_C(60397978)
+#define MPS_FROM_KMPH_Q8DOT24                    INT64_C(4660338)
+#define MPS_TO_KNOTS_Q8DOT24                     INT64_C(32612299)
+#define MPS_FROM_KNOTS_Q8DOT24                   INT64_C(8630946)
+#define MPS_TO_MPH_Q8DOT24                       INT64_C(37529563)
+#define MPS_FROM_MPH_Q8DOT24                     INT64_C(7500087)
+
+static int32_t multiply_q8dot24(int32_t value, int64_t factor)
+{
+    return ((value * factor + (1 << 23)) >> 24);
+}
+
 int science_module_init()
 {
     return (0);
 }
 
+int32_t science_pressure_to_altitude_fixed_point(uint32_t pressure,
+                                                 uint32_t pressure_at_sea_level,
+                                                 int precision)
+{
+    uint64_t ratio;
+    int64_t exponent;
+    int64_t power;
+
+    if ((precision < 1) || (precision > 16)) {
+        return (INT32_MIN);
+    }
+
+    if ((pressure <= 22632) || (pressure >= 2 * (uint64_t)pressure_at_sea_level)) {
+        return (INT32_MIN);
+    }
+
+    /* altitude = T0 / L * (1 - (pressure / pressure_at_sea_level) ^
+       (R * L / (g * M))). */
+    ratio = (((uint64_t)pressure << 24) / pressure_at_sea_level);
+    exponent = (((int64_t)math_log2_fixed_point(ratio, 24) * RL_GM_Q8DOT24)
+                >> 24);
+    power = math_exp2_fixed_point(exponent, 24);
+
+    return ((((1 << 24) - power) * T0_L_Q24DOT8) >> (32 - precision));
+}
+
+int32_t science_pressure_from_altitude_fixed_point(int32_t altitude,
+                                                   uint32_t pressure_at_sea_level,
+                                                   int precision)
+{
+    ASSERTN((precision > 0) && (precision <= 16), EINVAL);
+
+    int64_t base;
+    int64_t exponent;
+    int64_t power;
+
+    if (altitude >= (11000L << precision)) {
+        return (-EINVAL);
+    }
+
+    /* pressure = pressure_at_sea_level * (1 - L * altitude / T0) ^
+       (g * M / (R * L)). */
+    base = ((1 << 24) - ((altitude * L_T0_Q0DOT40) >> (precision + 16)));
+    exponent = ((math_log2_fixed_point(base, 24) * GM_RL_Q8DOT24) >> 24);
+    power = math_exp2_fixed_point(exponent, 24);
+
+    return ((pressure_at_sea_level * power + (1 << 23)) >> 24);
+}
+
+int32_t science_mps_to_kmph_fixed_point(int32_t speed)
+{
+    return (multiply_q8dot24(speed, MPS_TO_KMPH_Q8DOT24));
+}
+
+int32_t science_mps_from_kmph_fixed_point(int32_t speed)
+{
+    return (multiply_q8dot24(speed, MPS_FROM_KMPH_Q8DOT24));
+}
+
+int32_t science_mps_to_knots_fixed_point(int32_t speed)
+{
+    return (multiply_q8dot24(speed, MPS_TO_KNOTS_Q8DOT24));
+}
+
+int32_t science_mps_from_knots_fixed_point(int32_t speed)
+{
+    return (multiply_q8dot24(speed, MPS_FROM_KNOTS_Q8DOT24));
+}
+
+int32_t science_mps_to_mph_fixed_point(int32_t speed)
+{
+    return (multiply_q8dot24(speed, MPS_TO_MPH_Q8DOT24));
+}
+
+int32_t science_mps_from_mph_fixed_point(int32_t speed)
+{
+    return (multiply_q8dot24(speed, MPS_FROM_MPH_Q8DOT24));
+}
+
 #if CONFIG_FLOAT == 1
 
 float science_pressure_to_altitude(float pressure,
@@ -120,4 +120,92 @@ float science_mps_to_mph(float speed);
  */
 float science_mps_from_mph(float speed);
 
+/**
+ * Convert given pressure to its altitude, in fixed point. Only
+ * integer operations are used. The error is less than 2 cm, plus one
+ * unit in the last place of given precision.
+ *
+ * @param[in] pressure Pressure in Pascal. Must be higher than 22632
+ *                     Pa (11000 meters).
+ * @param[in] pressure_at_sea_level Sea level pressure in Pascal.
+ * @param[in] precision Fixed point precision of the altitude in the
+ *                      range 1 to 16, inclusive.
+ *
+ * @return Altitude in meters in given precision, or INT32_MIN if an
+ *         error occurred.
+ */
+int32_t science_pressure_to_altitude_fixed_point(uint32_t pressure,
+                                                 uint32_t pressure_at_sea_level,
+                                                 int precision);
+
+/**
+ * Convert given altitude to its pressure, in fixed point. Only
+ * integer operations are used. The error is less than 1 Pa.
+ *
+ * @param[in] altitude Altitude in meters in given precision. Must be
+ *                     lower than 11000 meters.
+ * @param[in] pressure_at_sea_level Sea level pressure in Pascal.
+ * @param[in] precision Fixed point precision of the altitude in the
+ *                      range 1 to 16, inclusive.
+ *
+ * @return Pressure in Pascal, or negative error code.
+ */
+int32_t science_pressure_from_altitude_fixed_point(int32_t altitude,
+                                                   uint32_t pressure_at_sea_level,
+                                                   int precision);
+
+/**
+ * Convert given speed from m/s to km/h, in fixed point.
+ *
+ * @param[in] speed Speed in m/s in any fixed point precision.
+ *
+ * @return Speed in km/h in the precision of given speed.
+ */
+int32_t science_mps_to_kmph_fixed_point(int32_t speed);
+
+/**
+ * Convert given speed from km/h to m/s, in fixed point.
+ *
+ * @param[in] speed Speed in km/h in any fixed point precision.
+ *
+ * @return Speed in m/s in the precision of given speed.
+ */
+int32_t science_mps_from_kmph_fixed_point(int32_t speed);
+
+/**
+ * Convert given speed from m/s to knots, in fixed point.
+ *
+ * @param[in] speed Speed in m/s in any fixed point precision.
+ *
+ * @return Speed in knots in the precision of given speed.
+ */
+int32_t science_mps_to_knots_fixed_point(int32_t speed);
+
+/**
+ * Convert given speed from knots to m/s, in fixed point.
+ *
+ * @param[in] speed Speed in knots in any fixed point precision.
+ *
+ * @return Speed in m/s in the precision of given speed.
+ */
+int32_t science_mps_from_knots_fixed_point(int32_t speed);
+
+/**
+ * Convert given speed from m/s to mi/h, in fixed point.
+ *
+ * @param[in] speed Speed in m/s in any fixed point precision.
+ *
+ * @return Speed in mi/h in the precision of given speed.
+ */
+int32_t science_mps_to_mph_fixed_point(int32_t speed);
+
+/**
+ * Convert given speed from mi/h to m/s, in fixed point.
+ *
+ * @param[in] speed Speed in mi/h in any fixed point precision.
+ *
+ * @return Speed in m/s in the precision of given speed.
+ */
+int32_t science_mps_from_mph_fixed_point(int32_t speed);
+
 #endif
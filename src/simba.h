@@ -88,11 +88,13 @@ typedef intptr_t longptr_t;
 #include "collections/bits.h"
 #include "collections/fifo.h"
 #include "collections/list.h"
+#include "collections/dlist.h"
 #include "collections/hash_map.h"
 #include "collections/circular_buffer.h"
 
 #include "kernel/time.h"
 
+#include "sync/lock_stats.h"
 #include "sync/sem.h"
 
 #include "sync/chan.h"
@@ -103,12 +105,21 @@ typedef intptr_t longptr_t;
 #include "sync/mutex.h"
 #include "sync/cond.h"
 #include "sync/queue.h"
+#include "sync/mailbox.h"
+#include "sync/spsc_queue.h"
 #include "sync/event.h"
 #include "sync/rwlock.h"
 #include "sync/bus.h"
+#include "sync/work_queue.h"
+#include "sync/reactor.h"
 
+#include "kernel/coro.h"
+
+#include "alloc/arena.h"
 #include "alloc/heap.h"
 #include "alloc/circular_heap.h"
+#include "alloc/pool.h"
+#include "alloc/buf.h"
 
 #if CONFIG_FAT16 == 1
 #    include "filesystems/fat16.h"
@@ -117,11 +128,16 @@ typedef intptr_t longptr_t;
 
 #include "oam/console.h"
 #include "filesystems/fs.h"
+#include "filesystems/cowfs.h"
+#include "filesystems/romfs.h"
 #include "oam/shell.h"
 #include "oam/service.h"
 #include "oam/nvm.h"
 
 #include "debug/log.h"
+#include "debug/trace.h"
+#include "debug/profiler.h"
+#include "debug/isr_stats.h"
 
 #include "text/color.h"
 #include "text/re.h"
@@ -130,12 +146,14 @@ typedef intptr_t longptr_t;
 #include "text/emacs.h"
 
 #include "encode/base64.h"
+#include "encode/deflate.h"
 #include "encode/hex.h"
 #include "encode/json.h"
 #include "encode/nmea.h"
 
 #include "hash/crc.h"
 #include "hash/sha1.h"
+#include "hash/sha256.h"
 
 #include "inet/types.h"
 #include "inet/inet.h"
@@ -164,6 +182,9 @@ typedef intptr_t longptr_t;
 #ifdef PORT_HAS_DAC
 #    include "drivers/basic/dac.h"
 #endif
+#ifdef PORT_HAS_DMA
+#    include "drivers/basic/dma.h"
+#endif
 #ifdef PORT_HAS_SPI
 #    include "drivers/network/spi.h"
 #endif
@@ -181,6 +202,7 @@ typedef intptr_t longptr_t;
 #endif
 #ifdef PORT_HAS_FLASH
 #    include "drivers/storage/flash.h"
+#    include "drivers/storage/flash_buffer.h"
 #endif
 #ifdef PORT_HAS_ANALOG_INPUT_PIN
 #    include "drivers/basic/analog_input_pin.h"
@@ -244,6 +266,7 @@ typedef intptr_t longptr_t;
 #endif
 #ifdef PORT_HAS_EEPROM_SOFT
 #    include "drivers/storage/eeprom_soft.h"
+#    include "drivers/storage/eeprom_journal.h"
 #endif
 #ifdef PORT_HAS_EEPROM_I2C
 #    include "drivers/storage/eeprom_i2c.h"
@@ -266,6 +289,9 @@ typedef intptr_t longptr_t;
 #ifdef PORT_HAS_DHT
 #    include "drivers/sensors/dht.h"
 #endif
+#ifdef PORT_HAS_SENSOR
+#    include "drivers/sensors/sensor.h"
+#endif
 #ifdef PORT_HAS_PCINT
 #    include "drivers/basic/pcint.h"
 #endif
@@ -284,6 +310,7 @@ typedef intptr_t longptr_t;
 #include "debug/harness.h"
 
 #include "multimedia/midi.h"
+#include "multimedia/mixer.h"
 
 #include "inet/socket.h"
 
@@ -292,15 +319,23 @@ typedef intptr_t longptr_t;
 #endif
 
 #include "inet/slip.h"
+#include "inet/coap.h"
+#include "inet/coap_server.h"
+#include "inet/coap_client.h"
+#include "inet/http_client.h"
 #include "inet/http_server.h"
+#include "inet/http_websocket_deflate.h"
 #include "inet/http_websocket_server.h"
 #include "inet/http_websocket_client.h"
 #include "inet/tftp_server.h"
 #include "inet/mqtt_client.h"
+#include "inet/mqtt_sn_client.h"
 #include "inet/network_interface.h"
 #include "inet/network_interface/slip.h"
 #include "inet/network_interface/wifi.h"
 #include "inet/ping.h"
+#include "inet/sntp_client.h"
+#include "inet/buf_lwip.h"
 
 #include "oam/soam.h"
 
@@ -308,6 +343,10 @@ typedef intptr_t longptr_t;
 #    include "inet/network_interface/driver/esp.h"
 #endif
 
+#if defined(FAMILY_SAM)
+#    include "inet/network_interface/emac.h"
+#endif
+
 #if defined(FAMILY_LINUX) || defined(FAMILY_ESP32)
 #    include "oam/upgrade.h"
 #    include "oam/upgrade/kermit.h"
@@ -318,6 +357,7 @@ typedef intptr_t longptr_t;
 
 #include "science/science.h"
 #include "science/math.h"
+#include "science/dsp.h"
 
 #include <simba_gen.h>
 
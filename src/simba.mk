@@ -33,7 +33,7 @@ ifeq ($(TYPE),suite)
   INC += $(SIMBA_ROOT)/tst/stubs
 
   ALLOC_SRC += heap.c
-  COLLECTIONS_SRC += circular_buffer.c binary_tree.c list.c
+  COLLECTIONS_SRC += circular_buffer.c binary_tree.c dlist.c list.c
   DEBUG_SRC += log.c harness.c
   DRIVERS_SRC += storage/flash.c network/uart.c
   ENCODE_SRC +=
@@ -72,7 +72,7 @@ ifeq ($(TYPE),suite)
   endif
 
   ifneq ($(FAMILY),avr)
-    DRIVERS_SRC += storage/eeprom_soft.c
+    DRIVERS_SRC += storage/eeprom_soft.c storage/eeprom_journal.c
   endif
 
   ifeq ($(MCU),atmega32u4)
@@ -89,8 +89,11 @@ INC += $(SIMBA_ROOT)/src
 INC += $(SIMBA_ROOT)/3pp/compat
 
 # Alloc package.
-ALLOC_SRC ?= circular_heap.c \
-	     heap.c
+ALLOC_SRC ?= arena.c \
+	     buf.c \
+	     circular_heap.c \
+	     heap.c \
+	     pool.c
 
 SRC += $(ALLOC_SRC:%=$(SIMBA_ROOT)/src/alloc/%)
 
@@ -99,6 +102,7 @@ COLLECTIONS_SRC ?= \
 	binary_tree.c \
 	bits.c \
 	circular_buffer.c \
+	dlist.c \
 	hash_map.c \
 	list.c
 
@@ -106,7 +110,10 @@ SRC += $(COLLECTIONS_SRC:%=$(SIMBA_ROOT)/src/collections/%)
 
 # Debug package.
 DEBUG_SRC ?= log.c \
-	     harness.c
+	     harness.c \
+	     trace.c \
+	     profiler.c \
+	     isr_stats.c
 
 SRC += $(DEBUG_SRC:%=$(SIMBA_ROOT)/src/debug/%)
 
@@ -119,6 +126,7 @@ DRIVERS_SRC ?= \
 	basic/analog_output_pin.c \
 	basic/chipid.c \
 	basic/dac.c \
+	basic/dma.c \
 	basic/exti.c \
 	basic/pcint.c \
 	basic/pin.c \
@@ -157,10 +165,13 @@ DRIVERS_SRC ?= \
 	sensors/dht.c \
 	sensors/ds18b20.c \
 	sensors/hx711.c \
+	sensors/sensor.c \
 	sensors/sht3xd.c \
 	storage/eeprom_i2c.c \
+	storage/eeprom_journal.c \
 	storage/eeprom_soft.c \
 	storage/flash.c \
+	storage/flash_buffer.c \
 	storage/sd.c \
 	various/ds3231.c \
 	various/gnss.c
@@ -174,6 +185,7 @@ endif
 # Encode package.
 ENCODE_SRC ?= \
 	base64.c \
+	deflate.c \
 	hex.c \
 	json.c \
 	nmea.c
@@ -182,7 +194,8 @@ SRC += $(ENCODE_SRC:%=$(SIMBA_ROOT)/src/encode/%)
 
 # Hash package.
 HASH_SRC ?= crc.c \
-	    sha1.c
+	    sha1.c \
+	    sha256.c
 
 SRC += $(HASH_SRC:%=$(SIMBA_ROOT)/src/hash/%)
 
@@ -195,24 +208,36 @@ endif
 INC += $(SIMBA_ROOT)/3pp/mbedtls/include
 
 INET_SRC_TMP = \
+	coap.c \
+	coap_client.c \
+	coap_server.c \
+	http_client.c \
 	http_server.c \
+	http_websocket_deflate.c \
 	http_websocket_server.c \
 	http_websocket_client.c \
 	inet.c \
 	isotp.c \
 	mqtt_client.c \
+	mqtt_sn_client.c \
 	tftp_server.c \
 	network_interface.c \
 	network_interface/slip.c \
 	network_interface/wifi.c \
 	slip.c \
 	socket.c \
-	ping.c
+	ping.c \
+	sntp_client.c \
+	buf_lwip.c
 
 ifeq ($(FAMILY),$(filter $(FAMILY), esp esp32))
     INET_SRC_TMP += network_interface/driver/esp.c
 endif
 
+ifeq ($(FAMILY),sam)
+    INET_SRC_TMP += network_interface/emac.c
+endif
+
 ifneq ($(ARCH),$(filter $(ARCH), esp esp32 linux))
     LWIP_SRC ?= \
 	3pp/lwip-1.4.1/src/core/stats.c \
@@ -330,6 +355,7 @@ endif
 INC += $(SIMBA_ROOT)/src/kernel/ports/$(ARCH)/$(TOOLCHAIN)
 
 KERNEL_SRC_TMP = \
+	coro.c \
 	errno.c \
 	sys.c \
 	thrd.c \
@@ -357,7 +383,7 @@ KERNEL_SRC ?= $(KERNEL_SRC_TMP)
 SRC += $(KERNEL_SRC:%=$(SIMBA_ROOT)/src/kernel/%)
 
 # Multimedia package.
-MULTIMEDIA_SRC ?= midi.c
+MULTIMEDIA_SRC ?= midi.c mixer.c
 
 SRC += $(MULTIMEDIA_SRC:%=$(SIMBA_ROOT)/src/multimedia/%)
 
@@ -388,8 +414,10 @@ SRC += $(OAM_SRC:%=$(SIMBA_ROOT)/src/oam/%)
 # Filesystems package.
 INC += $(SIMBA_ROOT)/3pp/spiffs-0.3.5/src
 
-FILESYSTEMS_SRC ?= fat16.c \
+FILESYSTEMS_SRC ?= cowfs.c \
+	       fat16.c \
 	       fs.c \
+	       romfs.c \
 	       spiffs.c
 
 SRC += $(FILESYSTEMS_SRC:%=$(SIMBA_ROOT)/src/filesystems/%)
@@ -408,10 +436,15 @@ SYNC_SRC ?= bus.c \
 	    chan.c \
 	    cond.c \
 	    event.c \
+	    lock_stats.c \
+	    mailbox.c \
 	    mutex.c \
 	    queue.c \
+	    reactor.c \
 	    rwlock.c \
-	    sem.c
+	    sem.c \
+	    spsc_queue.c \
+	    work_queue.c
 
 SRC += $(SYNC_SRC:%=$(SIMBA_ROOT)/src/sync/%)
 
@@ -448,6 +481,7 @@ SRC += $(TEXT_SRC:%=$(SIMBA_ROOT)/src/text/%)
 
 # Science package.
 SCIENCE_SRC ?= \
+	dsp.c \
 	math.c \
 	science.c
 
@@ -28,74 +28,94 @@
 
 #include "simba.h"
 
-int bus_module_init()
+#if CONFIG_BUS_HASH == 1
+
+#define BUCKET(self_p, id)                                              \
+    ((self_p)->buckets[(unsigned int)(id) & (CONFIG_BUS_HASH_BUCKETS - 1)])
+
+static struct bus_listener_t *next_listener(struct bus_listener_t *curr_p,
+                                            int id)
 {
-    return (0);
+    while ((curr_p != NULL) && (curr_p->id != id)) {
+        curr_p = curr_p->next_p;
+    }
+
+    return (curr_p);
 }
 
-int bus_init(struct bus_t *self_p)
+static struct bus_listener_t *first_listener(struct bus_t *self_p,
+                                             int id)
 {
-    ASSERTN(self_p != NULL, EINVAL);
+    return (next_listener(BUCKET(self_p, id), id));
+}
 
-    binary_tree_init(&self_p->listeners);
-    rwlock_init(&self_p->rwlock);
+static int attach(struct bus_t *self_p,
+                  struct bus_listener_t *listener_p)
+{
+    listener_p->next_p = BUCKET(self_p, listener_p->id);
+    BUCKET(self_p, listener_p->id) = listener_p;
 
     return (0);
 }
 
-int bus_listener_init(struct bus_listener_t *self_p,
-                      int id,
-                      void *chan_p)
+static int detach(struct bus_t *self_p,
+                  struct bus_listener_t *listener_p)
 {
-    ASSERTN(self_p != NULL, EINVAL);
-    ASSERTN(chan_p != NULL, EINVAL);
+    struct bus_listener_t **curr_pp;
 
-    self_p->base.key = id;
-    self_p->id = id;
-    self_p->chan_p = chan_p;
-    self_p->next_p = NULL;
+    curr_pp = &BUCKET(self_p, listener_p->id);
 
-    return (0);
+    while (*curr_pp != NULL) {
+        if (*curr_pp == listener_p) {
+            *curr_pp = listener_p->next_p;
+
+            return (0);
+        }
+
+        curr_pp = &(*curr_pp)->next_p;
+    }
+
+    return (-1);
 }
 
-int bus_attach(struct bus_t *self_p,
-               struct bus_listener_t *listener_p)
+#else
+
+static struct bus_listener_t *first_listener(struct bus_t *self_p,
+                                             int id)
 {
-    ASSERTN(self_p != NULL, EINVAL);
-    ASSERTN(listener_p != NULL, EINVAL);
+    return ((struct bus_listener_t *)binary_tree_search(&self_p->listeners,
+                                                        id));
+}
 
-    struct bus_listener_t *head_p;
+static struct bus_listener_t *next_listener(struct bus_listener_t *curr_p,
+                                            int id)
+{
+    return (curr_p);
+}
 
-    rwlock_writer_take(&self_p->rwlock);
+static int attach(struct bus_t *self_p,
+                  struct bus_listener_t *listener_p)
+{
+    struct bus_listener_t *head_p;
 
     /* Try to insert the node into the tree. It fails if there already
      * is a node with the same key (id).*/
     if (binary_tree_insert(&self_p->listeners, &listener_p->base) != 0) {
-        head_p = (struct bus_listener_t *)binary_tree_search(
-            &self_p->listeners, listener_p->id);
-
+        head_p = first_listener(self_p, listener_p->id);
         listener_p->next_p = head_p->next_p;
         head_p->next_p = listener_p;
     }
 
-    rwlock_writer_give(&self_p->rwlock);
-
     return (0);
 }
 
-int bus_detach(struct bus_t *self_p,
-               struct bus_listener_t *listener_p)
+static int detach(struct bus_t *self_p,
+                  struct bus_listener_t *listener_p)
 {
-    ASSERTN(self_p != NULL, EINVAL);
-    ASSERTN(listener_p != NULL, EINVAL);
-
     int res = 0;
     struct bus_listener_t *head_p, *curr_p, *prev_p;
 
-    rwlock_writer_take(&self_p->rwlock);
-
-    head_p = (struct bus_listener_t *)binary_tree_search(
-        &self_p->listeners, listener_p->id);
+    head_p = first_listener(self_p, listener_p->id);
 
     if (head_p == NULL) {
         res = -1;
@@ -123,6 +143,98 @@ int bus_detach(struct bus_t *self_p,
         }
     }
 
+    return (res);
+}
+
+#endif
+
+/**
+ * Write given message to all listeners of given id. The bus must be
+ * locked by the caller.
+ */
+static int write_listeners(struct bus_t *self_p,
+                           int id,
+                           const void *buf_p,
+                           size_t size)
+{
+    int number_of_receivers;
+    struct bus_listener_t *curr_p;
+
+    number_of_receivers = 0;
+    curr_p = first_listener(self_p, id);
+
+    while (curr_p != NULL) {
+        ((struct chan_t *)curr_p->chan_p)->write(curr_p->chan_p,
+                                                 buf_p,
+                                                 size);
+        number_of_receivers++;
+        curr_p = next_listener(curr_p->next_p, id);
+    }
+
+    return (number_of_receivers);
+}
+
+int bus_module_init()
+{
+    return (0);
+}
+
+int bus_init(struct bus_t *self_p)
+{
+    ASSERTN(self_p != NULL, EINVAL);
+
+#if CONFIG_BUS_HASH == 1
+    memset(&self_p->buckets[0], 0, sizeof(self_p->buckets));
+#else
+    binary_tree_init(&self_p->listeners);
+#endif
+    rwlock_init(&self_p->rwlock);
+
+    return (0);
+}
+
+int bus_listener_init(struct bus_listener_t *self_p,
+                      int id,
+                      void *chan_p)
+{
+    ASSERTN(self_p != NULL, EINVAL);
+    ASSERTN(chan_p != NULL, EINVAL);
+
+#if CONFIG_BUS_HASH == 0
+    self_p->base.key = id;
+#endif
+    self_p->id = id;
+    self_p->chan_p = chan_p;
+    self_p->next_p = NULL;
+
+    return (0);
+}
+
+int bus_attach(struct bus_t *self_p,
+               struct bus_listener_t *listener_p)
+{
+    ASSERTN(self_p != NULL, EINVAL);
+    ASSERTN(listener_p != NULL, EINVAL);
+
+    int res;
+
+    rwlock_writer_take(&self_p->rwlock);
+    res = attach(self_p, listener_p);
+    rwlock_writer_give(&self_p->rwlock);
+
+    return (res);
+}
+
+int bus_detach(struct bus_t *self_p,
+               struct bus_listener_t *listener_p)
+{
+    ASSERTN(self_p != NULL, EINVAL);
+    ASSERTN(listener_p != NULL, EINVAL);
+
+    int res;
+
+    rwlock_writer_take(&self_p->rwlock);
+    res = detach(self_p, listener_p);
     rwlock_writer_give(&self_p->rwlock);
 
     return (res);
@@ -137,21 +249,71 @@ int bus_write(struct bus_t *self_p,
     ASSERTN(buf_p != NULL, EINVAL);
     ASSERTN(size > 0, EINVAL);
 
+    int number_of_receivers;
+
+    rwlock_reader_take(&self_p->rwlock);
+    number_of_receivers = write_listeners(self_p, id, buf_p, size);
+    rwlock_reader_give(&self_p->rwlock);
+
+    return (number_of_receivers);
+}
+
+int bus_write_many(struct bus_t *self_p,
+                   const struct bus_message_t *messages_p,
+                   size_t length)
+{
+    ASSERTN(self_p != NULL, EINVAL);
+    ASSERTN(messages_p != NULL, EINVAL);
+
+    int number_of_receivers;
+    size_t i;
+
+    number_of_receivers = 0;
+
+    rwlock_reader_take(&self_p->rwlock);
+
+    for (i = 0; i < length; i++) {
+        number_of_receivers += write_listeners(self_p,
+                                               messages_p[i].id,
+                                               messages_p[i].buf_p,
+                                               messages_p[i].size);
+    }
+
+    rwlock_reader_give(&self_p->rwlock);
+
+    return (number_of_receivers);
+}
+
+int bus_write_shared(struct bus_t *self_p,
+                     int id,
+                     struct heap_t *heap_p,
+                     void *buf_p)
+{
+    ASSERTN(self_p != NULL, EINVAL);
+    ASSERTN(heap_p != NULL, EINVAL);
+    ASSERTN(buf_p != NULL, EINVAL);
+
     int number_of_receivers;
     struct bus_listener_t *curr_p;
 
     rwlock_reader_take(&self_p->rwlock);
 
-    curr_p = (struct bus_listener_t *)binary_tree_search(
-        &self_p->listeners, id);
+    /* Take all references before the first write, as a listener may
+       free its reference before the last write is done. */
     number_of_receivers = 0;
+    curr_p = first_listener(self_p, id);
 
     while (curr_p != NULL) {
-        ((struct chan_t *)curr_p->chan_p)->write(curr_p->chan_p,
-                                                 buf_p,
-                                                 size);
         number_of_receivers++;
-        curr_p = curr_p->next_p;
+        curr_p = next_listener(curr_p->next_p, id);
+    }
+
+    if (number_of_receivers > 0) {
+        heap_share(heap_p, buf_p, number_of_receivers);
+        number_of_receivers = write_listeners(self_p,
+                                              id,
+                                              &buf_p,
+                                              sizeof(buf_p));
     }
 
     rwlock_reader_give(&self_p->rwlock);
@@ -31,18 +31,35 @@
 
 #include "simba.h"
 
+struct heap_t;
+
 struct bus_t {
     struct rwlock_t rwlock;
+#if CONFIG_BUS_HASH == 1
+    struct bus_listener_t *buckets[CONFIG_BUS_HASH_BUCKETS];
+#else
     struct binary_tree_t listeners;
+#endif
 };
 
 struct bus_listener_t {
+#if CONFIG_BUS_HASH == 0
     struct binary_tree_node_t base;
+#endif
     int id;
     void *chan_p;
     struct bus_listener_t *next_p;
 };
 
+/**
+ * A message in a batch written by `bus_write_many()`.
+ */
+struct bus_message_t {
+    int id;
+    const void *buf_p;
+    size_t size;
+};
+
 /**
  * Initialize the bus module. This function must be called before
  * calling any other function in this module.
@@ -122,4 +139,40 @@ int bus_write(struct bus_t *self_p,
               const void *buf_p,
               size_t size);
 
+/**
+ * Write given batch of messages to given bus. The bus is locked once
+ * for the whole batch.
+ *
+ * @param[in] self_p Bus to write the messages to.
+ * @param[in] messages_p Messages to write.
+ * @param[in] length Number of messages.
+ *
+ * @return Total number of listeners that received the messages, or
+ *         negative error code.
+ */
+int bus_write_many(struct bus_t *self_p,
+                   const struct bus_message_t *messages_p,
+                   size_t length);
+
+/**
+ * Write a reference to given heap allocated buffer to all listeners
+ * of given message id, instead of copying the message into each
+ * listener channel. The share count of the buffer is incremented
+ * once per listener. Each listener reads a ``void *`` from its
+ * channel and must free it with `heap_free()` when done with
+ * it. The caller keeps its own reference, and must free it as well.
+ *
+ * @param[in] self_p Bus to write the message to.
+ * @param[in] id Message identity.
+ * @param[in] heap_p Heap the buffer was allocated from.
+ * @param[in] buf_p Buffer allocated with `heap_alloc()`.
+ *
+ * @return Number of listeners that received the message, or negative
+ *         error code.
+ */
+int bus_write_shared(struct bus_t *self_p,
+                     int id,
+                     struct heap_t *heap_p,
+                     void *buf_p);
+
 #endif
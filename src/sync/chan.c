@@ -28,6 +28,10 @@
 
 #include "simba.h"
 
+#define POLLSET_STATE_IDLE                                  0
+#define POLLSET_STATE_READY                                 1
+#define POLLSET_STATE_REPORTED                              2
+
 static const struct chan_t null = {
     .read = chan_read_null,
     .write = chan_write_null,
@@ -58,8 +62,16 @@ int chan_init(struct chan_t *self_p,
     self_p->control = chan_control_null;
     self_p->write_filter_cb = NULL;
     self_p->write_filter_isr_cb = NULL;
+#if CONFIG_CHAN_WRITEV == 1
+    self_p->writev = NULL;
+#endif
     self_p->reader_p = NULL;
     self_p->list_p = NULL;
+#if CONFIG_CHAN_POLLSET == 1
+    self_p->pollset_p = NULL;
+    self_p->pollset_next_p = NULL;
+    self_p->pollset_state = POLLSET_STATE_IDLE;
+#endif
 
     return (0);
 }
@@ -84,8 +96,23 @@ int chan_set_write_cb(struct chan_t *self_p,
                       chan_write_fn_t write_cb)
 {
     self_p->write = write_cb;
+#if CONFIG_CHAN_WRITEV == 1
+    self_p->writev = NULL;
+#endif
+
+    return (0);
+}
+
+int chan_set_writev_cb(struct chan_t *self_p,
+                       chan_writev_fn_t writev_cb)
+{
+#if CONFIG_CHAN_WRITEV == 1
+    self_p->writev = writev_cb;
 
     return (0);
+#else
+    return (-ENOSYS);
+#endif
 }
 
 int chan_set_write_isr_cb(struct chan_t *self_p,
@@ -144,9 +171,9 @@ int chan_set_control_cb(struct chan_t *self_p,
     return (0);
 }
 
-ssize_t chan_read(void *self_p,
-                  void *buf_p,
-                  size_t size)
+ssize_t (chan_read)(void *self_p,
+                    void *buf_p,
+                    size_t size)
 {
     ASSERTN(self_p != NULL, EINVAL);
     ASSERTN(((struct chan_t *)self_p)->read != NULL, EINVAL);
@@ -156,9 +183,9 @@ ssize_t chan_read(void *self_p,
     return (((struct chan_t *)self_p)->read(self_p, buf_p, size));
 }
 
-ssize_t chan_write(void *v_self_p,
-                   const void *buf_p,
-                   size_t size)
+ssize_t (chan_write)(void *v_self_p,
+                     const void *buf_p,
+                     size_t size)
 {
     ASSERTN(v_self_p != NULL, EINVAL);
     ASSERTN(((struct chan_t *)v_self_p)->write != NULL, EINVAL);
@@ -178,7 +205,67 @@ ssize_t chan_write(void *v_self_p,
     return (self_p->write(self_p, buf_p, size));
 }
 
-int chan_getc(void *self_p)
+ssize_t chan_writev(void *v_self_p,
+                    const struct iov_t *iov_p,
+                    size_t length)
+{
+    ASSERTN(v_self_p != NULL, EINVAL);
+    ASSERTN((iov_p != NULL) || (length == 0), EINVAL);
+
+#if CONFIG_CHAN_WRITEV == 1
+    struct chan_t *self_p;
+    ssize_t res;
+
+    self_p = v_self_p;
+
+    /* The write filter sees one buffer at a time. */
+    if ((self_p->writev != NULL) && (self_p->write_filter_cb == NULL)) {
+        res = self_p->writev(self_p, iov_p, length);
+
+        if (res != -ENOSYS) {
+            return (res);
+        }
+    }
+#endif
+
+    return (chan_writev_generic(v_self_p, iov_p, length));
+}
+
+ssize_t chan_writev_generic(void *self_p,
+                            const struct iov_t *iov_p,
+                            size_t length)
+{
+    ASSERTN(self_p != NULL, EINVAL);
+    ASSERTN((iov_p != NULL) || (length == 0), EINVAL);
+
+    size_t i;
+    ssize_t res;
+    ssize_t size;
+
+    size = 0;
+
+    for (i = 0; i < length; i++) {
+        if (iov_p[i].size == 0) {
+            continue;
+        }
+
+        res = chan_write(self_p, iov_p[i].buf_p, iov_p[i].size);
+
+        if (res < 0) {
+            return (res);
+        }
+
+        size += res;
+
+        if (res != iov_p[i].size) {
+            break;
+        }
+    }
+
+    return (size);
+}
+
+int (chan_getc)(void *self_p)
 {
     ssize_t res;
     unsigned char character;
@@ -192,7 +279,7 @@ int chan_getc(void *self_p)
     return (res);
 }
 
-int chan_putc(void *self_p, int character)
+int (chan_putc)(void *self_p, int character)
 {
     ssize_t res;
     unsigned char uc_character;
@@ -344,6 +431,232 @@ void *chan_poll(void *chan_p, const struct time_t *timeout_p)
     return (chan_list_poll(&list, timeout_p));
 }
 
+#if CONFIG_CHAN_POLLSET == 1
+
+static void pollset_push_ready_isr(struct chan_pollset_t *self_p,
+                                   struct chan_t *chan_p)
+{
+    chan_p->pollset_next_p = NULL;
+    chan_p->pollset_state = POLLSET_STATE_READY;
+
+    if (self_p->ready_tail_p == NULL) {
+        self_p->ready_head_p = chan_p;
+    } else {
+        self_p->ready_tail_p->pollset_next_p = chan_p;
+    }
+
+    self_p->ready_tail_p = chan_p;
+}
+
+/**
+ * Called by channel writers through `chan_is_polled_isr()`.
+ */
+static int pollset_write_isr(struct chan_t *chan_p)
+{
+    struct chan_pollset_t *pollset_p;
+
+    /* A blocked reader receives the data directly. */
+    if (chan_p->reader_p != NULL) {
+        return (0);
+    }
+
+    pollset_p = chan_p->pollset_p;
+
+    /* Reported channels are checked for data in the next wait. */
+    if (chan_p->pollset_state == POLLSET_STATE_IDLE) {
+        pollset_push_ready_isr(pollset_p, chan_p);
+    }
+
+    if (pollset_p->thrd_p == NULL) {
+        return (0);
+    }
+
+    /* Let the writer resume the waiting thread. */
+    chan_p->reader_p = pollset_p->thrd_p;
+    pollset_p->thrd_p = NULL;
+
+    return (1);
+}
+
+#endif
+
+int chan_pollset_init(struct chan_pollset_t *self_p)
+{
+    ASSERTN(self_p != NULL, EINVAL);
+
+    self_p->ready_head_p = NULL;
+    self_p->ready_tail_p = NULL;
+    self_p->reported_p = NULL;
+    self_p->thrd_p = NULL;
+
+    return (0);
+}
+
+int chan_pollset_add(struct chan_pollset_t *self_p, void *v_chan_p)
+{
+    ASSERTN(self_p != NULL, EINVAL);
+    ASSERTN(v_chan_p != NULL, EINVAL);
+
+#if CONFIG_CHAN_POLLSET == 1
+    struct chan_t *chan_p;
+    int res;
+
+    chan_p = v_chan_p;
+    res = 0;
+
+    sys_lock();
+
+    if (chan_p->pollset_p != NULL) {
+        res = -EBUSY;
+    } else {
+        chan_p->pollset_p = self_p;
+        chan_p->pollset_state = POLLSET_STATE_IDLE;
+
+        /* Data written before the channel was added. */
+        if (chan_p->size(chan_p) > 0) {
+            pollset_push_ready_isr(self_p, chan_p);
+
+            if (self_p->thrd_p != NULL) {
+                thrd_resume_isr(self_p->thrd_p, 0);
+                self_p->thrd_p = NULL;
+            }
+        }
+    }
+
+    sys_unlock();
+
+    return (res);
+#else
+    return (-ENOSYS);
+#endif
+}
+
+int chan_pollset_remove(struct chan_pollset_t *self_p, void *v_chan_p)
+{
+    ASSERTN(self_p != NULL, EINVAL);
+    ASSERTN(v_chan_p != NULL, EINVAL);
+
+#if CONFIG_CHAN_POLLSET == 1
+    struct chan_t *chan_p;
+    struct chan_t *prev_p;
+    struct chan_t **curr_pp;
+
+    chan_p = v_chan_p;
+
+    sys_lock();
+
+    if (chan_p->pollset_p != self_p) {
+        sys_unlock();
+
+        return (-1);
+    }
+
+    if (chan_p->pollset_state == POLLSET_STATE_READY) {
+        curr_pp = &self_p->ready_head_p;
+    } else {
+        curr_pp = &self_p->reported_p;
+    }
+
+    prev_p = NULL;
+
+    while (*curr_pp != NULL) {
+        if (*curr_pp == chan_p) {
+            *curr_pp = chan_p->pollset_next_p;
+
+            if (self_p->ready_tail_p == chan_p) {
+                self_p->ready_tail_p = prev_p;
+            }
+
+            break;
+        }
+
+        prev_p = *curr_pp;
+        curr_pp = &prev_p->pollset_next_p;
+    }
+
+    chan_p->pollset_p = NULL;
+    chan_p->pollset_next_p = NULL;
+    chan_p->pollset_state = POLLSET_STATE_IDLE;
+
+    sys_unlock();
+
+    return (0);
+#else
+    return (-ENOSYS);
+#endif
+}
+
+int chan_pollset_wait(struct chan_pollset_t *self_p,
+                      void **chans_pp,
+                      size_t length,
+                      const struct time_t *timeout_p)
+{
+    ASSERTN(self_p != NULL, EINVAL);
+    ASSERTN(chans_pp != NULL, EINVAL);
+    ASSERTN(length > 0, EINVAL);
+
+#if CONFIG_CHAN_POLLSET == 1
+    struct chan_t *chan_p;
+    struct chan_t *next_p;
+    int res;
+
+    sys_lock();
+
+    /* Channels returned by the previous wait are ready again if they
+       still have data. */
+    chan_p = self_p->reported_p;
+    self_p->reported_p = NULL;
+
+    while (chan_p != NULL) {
+        next_p = chan_p->pollset_next_p;
+
+        if (chan_p->size(chan_p) > 0) {
+            pollset_push_ready_isr(self_p, chan_p);
+        } else {
+            chan_p->pollset_next_p = NULL;
+            chan_p->pollset_state = POLLSET_STATE_IDLE;
+        }
+
+        chan_p = next_p;
+    }
+
+    /* Wait for a channel to become ready. */
+    if (self_p->ready_head_p == NULL) {
+        self_p->thrd_p = thrd_self();
+
+        if (thrd_suspend_isr(timeout_p) == -ETIMEDOUT) {
+            self_p->thrd_p = NULL;
+            sys_unlock();
+
+            return (-ETIMEDOUT);
+        }
+    }
+
+    /* Move up to length ready channels to the reported list. */
+    res = 0;
+
+    while ((self_p->ready_head_p != NULL) && (res < length)) {
+        chan_p = self_p->ready_head_p;
+        self_p->ready_head_p = chan_p->pollset_next_p;
+        chan_p->pollset_next_p = self_p->reported_p;
+        chan_p->pollset_state = POLLSET_STATE_REPORTED;
+        self_p->reported_p = chan_p;
+        chans_pp[res] = chan_p;
+        res++;
+    }
+
+    if (self_p->ready_head_p == NULL) {
+        self_p->ready_tail_p = NULL;
+    }
+
+    sys_unlock();
+
+    return (res);
+#else
+    return (-ENOSYS);
+#endif
+}
+
 void *chan_null(void)
 {
     return ((void *)&null);
@@ -384,6 +697,12 @@ RAM_CODE int chan_is_polled_isr(struct chan_t *self_p)
 
     /* Already resumed? */
     if (self_p->list_p == NULL) {
+#if CONFIG_CHAN_POLLSET == 1
+        if (self_p->pollset_p != NULL) {
+            return (pollset_write_isr(self_p));
+        }
+#endif
+
         return (0);
     }
 
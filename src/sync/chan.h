@@ -62,6 +62,15 @@
  */
 #define CHAN_CONTROL_BLOCKING_READ                          6
 
+/**
+ * Beginning of a binary deferred log entry. A channel returns one(1)
+ * if it accepts binary entries, and the entry is then ended with
+ * ``CHAN_CONTROL_LOG_END``. Otherwise the entry is formatted and
+ * written between ``CHAN_CONTROL_LOG_BEGIN`` and
+ * ``CHAN_CONTROL_LOG_END``.
+ */
+#define CHAN_CONTROL_LOG_DEFERRED_BEGIN                     7
+
 /**
  * Channel read function callback type.
  *
@@ -88,6 +97,19 @@ typedef ssize_t (*chan_write_fn_t)(void *self_p,
                                    const void *buf_p,
                                    size_t size);
 
+/**
+ * Channel vectored write function callback type.
+ *
+ * @param[in] self_p Channel to write to.
+ * @param[in] iov_p Io vector of buffers to write.
+ * @param[in] length Number of elements in the io vector.
+ *
+ * @return Number of written bytes or negative error code.
+ */
+typedef ssize_t (*chan_writev_fn_t)(void *self_p,
+                                    const struct iov_t *iov_p,
+                                    size_t length);
+
 /**
  * Channel control function callback type.
  *
@@ -132,6 +154,20 @@ struct chan_list_t {
     size_t len;
 };
 
+/**
+ * A persistent set of channels to wait for data on. Channels put
+ * themselves on the ready list when written to, so a wait only visits
+ * ready channels.
+ */
+struct chan_pollset_t {
+    struct chan_t *ready_head_p;
+    struct chan_t *ready_tail_p;
+    /* Channels returned by the last wait. */
+    struct chan_t *reported_p;
+    /* Thread waiting for a ready channel. */
+    struct thrd_t *thrd_p;
+};
+
 /**
  * Channel datastructure.
  */
@@ -143,10 +179,20 @@ struct chan_t {
     chan_write_filter_fn_t write_filter_cb;
     chan_write_fn_t write_isr;
     chan_write_filter_fn_t write_filter_isr_cb;
+#if CONFIG_CHAN_WRITEV == 1
+    /* Vectored write, or NULL to write one buffer at a time. */
+    chan_writev_fn_t writev;
+#endif
     /* Reader thread waiting for data. */
     struct thrd_t *reader_p;
     /* Used by the reader when polling channels. */
     struct chan_list_t *list_p;
+#if CONFIG_CHAN_POLLSET == 1
+    /* Poll set this channel belongs to, if any. */
+    struct chan_pollset_t *pollset_p;
+    struct chan_t *pollset_next_p;
+    int pollset_state;
+#endif
 };
 
 /**
@@ -186,7 +232,9 @@ int chan_init(struct chan_t *self_p,
               chan_size_fn_t size);
 
 /**
- * Set the write function callback.
+ * Set the write function callback. Also clears the vectored write
+ * function callback, as it most likely belongs to the replaced write
+ * function.
  *
  * @param[in] self_p Initialized driver object.
  * @param[in] write_cb Write function to set.
@@ -196,6 +244,19 @@ int chan_init(struct chan_t *self_p,
 int chan_set_write_cb(struct chan_t *self_p,
                       chan_write_fn_t write_cb);
 
+/**
+ * Set the vectored write function callback, used by `chan_writev()`
+ * to write all buffers in one operation. Without it, the buffers are
+ * written one at a time with the write function callback.
+ *
+ * @param[in] self_p Initialized driver object.
+ * @param[in] writev_cb Vectored write function to set, or NULL.
+ *
+ * @return zero(0) or negative error code.
+ */
+int chan_set_writev_cb(struct chan_t *self_p,
+                       chan_writev_fn_t writev_cb);
+
 /**
  * Set the write isr function callback.
  *
@@ -276,6 +337,39 @@ ssize_t chan_write(void *self_p,
                    const void *buf_p,
                    size_t size);
 
+/**
+ * Write the buffers in given io vector to given channel. Channels
+ * with a vectored write function callback write all buffers in one
+ * operation, for example as a single TCP segment or UART transfer,
+ * without interleaving data from other writers. Other channels, and
+ * channels with a write filter, get one `chan_write()` call per
+ * buffer.
+ *
+ * @param[in] self_p Channel to write to.
+ * @param[in] iov_p Io vector of buffers to write.
+ * @param[in] length Number of elements in the io vector.
+ *
+ * @return Number of written bytes or negative error code.
+ */
+ssize_t chan_writev(void *self_p,
+                    const struct iov_t *iov_p,
+                    size_t length);
+
+/**
+ * Write the buffers in given io vector to given channel with one
+ * `chan_write()` call per buffer. Vectored write callbacks may call
+ * this function for vectors they cannot write in one operation.
+ *
+ * @param[in] self_p Channel to write to.
+ * @param[in] iov_p Io vector of buffers to write.
+ * @param[in] length Number of elements in the io vector.
+ *
+ * @return Number of written bytes or negative error code.
+ */
+ssize_t chan_writev_generic(void *self_p,
+                            const struct iov_t *iov_p,
+                            size_t length);
+
 /**
  * Read a character from given channel. The behaviour of this function
  * depends on the channel implementation. Often, the calling thread
@@ -311,6 +405,73 @@ int chan_putc(void *self_p, int character);
  */
 size_t chan_size(void *self_p);
 
+#if CONFIG_CHAN_INLINE == 1
+
+/* Inline versions of the functions above, used in their place if
+   CONFIG_CHAN_INLINE is set. They do not check their arguments. */
+
+static inline ssize_t chan_read_inline(void *self_p,
+                                       void *buf_p,
+                                       size_t size)
+{
+    return (((struct chan_t *)self_p)->read(self_p, buf_p, size));
+}
+
+static inline ssize_t chan_write_inline(void *v_self_p,
+                                        const void *buf_p,
+                                        size_t size)
+{
+    struct chan_t *self_p;
+
+    self_p = (struct chan_t *)v_self_p;
+
+    if (self_p->write_filter_cb != NULL) {
+        if (self_p->write_filter_cb(self_p, buf_p, size) == 1) {
+            return (size);
+        }
+    }
+
+    return (self_p->write(self_p, buf_p, size));
+}
+
+static inline int chan_getc_inline(void *self_p)
+{
+    ssize_t res;
+    unsigned char character;
+
+    res = chan_read_inline(self_p, &character, sizeof(character));
+
+    if (res == sizeof(character)) {
+        res = (int)character;
+    }
+
+    return (res);
+}
+
+static inline int chan_putc_inline(void *self_p, int character)
+{
+    ssize_t res;
+    unsigned char uc_character;
+
+    uc_character = (unsigned char)character;
+    res = chan_write_inline(self_p, &uc_character, sizeof(uc_character));
+
+    if (res == sizeof(uc_character)) {
+        res = 0;
+    }
+
+    return (res);
+}
+
+#    define chan_read(self_p, buf_p, size)      \
+    chan_read_inline(self_p, buf_p, size)
+#    define chan_write(self_p, buf_p, size)     \
+    chan_write_inline(self_p, buf_p, size)
+#    define chan_getc(self_p) chan_getc_inline(self_p)
+#    define chan_putc(self_p, character) chan_putc_inline(self_p, character)
+
+#endif
+
 /**
  * Control given channel.
  *
@@ -418,6 +579,59 @@ void *chan_list_poll(struct chan_list_t *self_p,
  */
 void *chan_poll(void *chan_p, const struct time_t *timeout_p);
 
+/**
+ * Initialize given empty poll set.
+ *
+ * @param[in] self_p Poll set to initialize.
+ *
+ * @return zero(0) or negative error code.
+ */
+int chan_pollset_init(struct chan_pollset_t *self_p);
+
+/**
+ * Add given channel to given poll set. A channel can only be in one
+ * poll set at a time, and must not be polled with `chan_list_poll()`
+ * while in a poll set.
+ *
+ * @param[in] self_p Poll set.
+ * @param[in] chan_p Channel to add.
+ *
+ * @return zero(0) or negative error code.
+ */
+int chan_pollset_add(struct chan_pollset_t *self_p, void *chan_p);
+
+/**
+ * Remove given channel from given poll set.
+ *
+ * @param[in] self_p Poll set.
+ * @param[in] chan_p Channel to remove.
+ *
+ * @return zero(0) or negative error code.
+ */
+int chan_pollset_remove(struct chan_pollset_t *self_p, void *chan_p);
+
+/**
+ * Wait for at least one channel in given poll set to have data ready
+ * to be read, or a timeout. Channels returned by the previous wait
+ * are returned again if they still have data, so channels do not
+ * have to be read until empty.
+ *
+ * Only one thread may wait on a poll set at a time.
+ *
+ * @param[in] self_p Poll set to wait on.
+ * @param[out] chans_pp Array of channels with data.
+ * @param[in] length Size of the channels array.
+ * @param[in] timeout_p Time to wait for data on any channel before a
+ *                      timeout occurs. Set to NULL to wait forever.
+ *
+ * @return Number of channels with data, -ETIMEDOUT on timeout or
+ *         other negative error code.
+ */
+int chan_pollset_wait(struct chan_pollset_t *self_p,
+                      void **chans_pp,
+                      size_t length,
+                      const struct time_t *timeout_p);
+
 /**
  * Get a reference to the null channel. This channel will ignore all
  * written data but return that it was successfully written.
@@ -28,6 +28,64 @@
 
 #include "simba.h"
 
+struct event_waiter_elem_t {
+    struct thrd_t *thrd_p;
+    uint32_t mask;
+    int flags;
+    struct event_waiter_elem_t *next_p;
+};
+
+/**
+ * Get the events in the mask of given waiter that satisfies its wait,
+ * or zero(0) if the wait is not satisfied.
+ */
+static uint32_t waiter_events(struct event_waiter_elem_t *elem_p,
+                              uint32_t mask)
+{
+    mask &= elem_p->mask;
+
+    if ((elem_p->flags & EVENT_WAIT_ALL) && (mask != elem_p->mask)) {
+        mask = 0;
+    }
+
+    return (mask);
+}
+
+/**
+ * Resume all waiters whose wait is satisfied, and then clear the
+ * events of the resumed waiters that asked for it.
+ */
+static void resume_waiters_isr(struct event_t *self_p)
+{
+    struct event_waiter_elem_t **elem_pp;
+    struct event_waiter_elem_t *elem_p;
+    uint32_t mask;
+    uint32_t clear_mask;
+
+    clear_mask = 0;
+    elem_pp = &self_p->waiters_p;
+
+    while (*elem_pp != NULL) {
+        elem_p = *elem_pp;
+        mask = waiter_events(elem_p, self_p->mask);
+
+        if (mask != 0) {
+            *elem_pp = elem_p->next_p;
+            elem_p->mask = mask;
+
+            if (elem_p->flags & EVENT_WAIT_CLEAR) {
+                clear_mask |= mask;
+            }
+
+            thrd_resume_isr(elem_p->thrd_p, 0);
+        } else {
+            elem_pp = &elem_p->next_p;
+        }
+    }
+
+    self_p->mask &= ~clear_mask;
+}
+
 int event_init(struct event_t *self_p)
 {
     ASSERTN(self_p != NULL, EINVAL);
@@ -39,6 +97,7 @@ int event_init(struct event_t *self_p)
 
     self_p->mask = 0;
     self_p->reader_mask = 0;
+    self_p->waiters_p = NULL;
 
     return (0);
 }
@@ -77,6 +136,60 @@ ssize_t event_read(struct event_t *self_p,
     return (size);
 }
 
+int event_wait(struct event_t *self_p,
+               uint32_t *mask_p,
+               int flags,
+               const struct time_t *timeout_p)
+{
+    ASSERTN(self_p != NULL, EINVAL);
+    ASSERTN(mask_p != NULL, EINVAL);
+
+    struct event_waiter_elem_t elem;
+    struct event_waiter_elem_t **elem_pp;
+    uint32_t mask;
+    int res;
+
+    res = 0;
+    elem.mask = *mask_p;
+    elem.flags = flags;
+
+    sys_lock();
+
+    mask = waiter_events(&elem, self_p->mask);
+
+    if (mask != 0) {
+        *mask_p = mask;
+
+        if (flags & EVENT_WAIT_CLEAR) {
+            self_p->mask &= ~mask;
+        }
+    } else {
+        elem.thrd_p = thrd_self();
+        elem.next_p = self_p->waiters_p;
+        self_p->waiters_p = &elem;
+
+        if (thrd_suspend_isr(timeout_p) == -ETIMEDOUT) {
+            /* Remove this thread from the list of waiters. */
+            elem_pp = &self_p->waiters_p;
+
+            while (*elem_pp != &elem) {
+                elem_pp = &(*elem_pp)->next_p;
+            }
+
+            *elem_pp = elem.next_p;
+            *mask_p &= self_p->mask;
+            res = -ETIMEDOUT;
+        } else {
+            /* The writer stored the events in the element. */
+            *mask_p = elem.mask;
+        }
+    }
+
+    sys_unlock();
+
+    return (res);
+}
+
 ssize_t event_try_read(struct event_t *self_p,
                        void *buf_p,
                        size_t size)
@@ -144,6 +257,10 @@ ssize_t event_write_isr(struct event_t *self_p,
         self_p->base.reader_p = NULL;
     }
 
+    if (self_p->waiters_p != NULL) {
+        resume_waiters_isr(self_p);
+    }
+
     return (size);
 }
 
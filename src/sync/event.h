@@ -31,6 +31,18 @@
 
 #include "simba.h"
 
+/**
+ * Wait for all events in the mask, instead of any of them. A flag to
+ * `event_wait()`.
+ */
+#define EVENT_WAIT_ALL                                   0x01
+
+/**
+ * Clear the events that satisfied the wait. A flag to
+ * `event_wait()`.
+ */
+#define EVENT_WAIT_CLEAR                                 0x02
+
 /**
  * Event channel.
  */
@@ -38,6 +50,7 @@ struct event_t {
     struct chan_t base;
     uint32_t mask;                 /* Events that occured. */
     uint32_t reader_mask;          /* Events the reader are waiting for. */
+    struct event_waiter_elem_t *waiters_p; /* Threads in event_wait(). */
 };
 
 /**
@@ -68,6 +81,31 @@ ssize_t event_read(struct event_t *self_p,
                    void *buf_p,
                    size_t size);
 
+/**
+ * Wait for events in given mask to occur, or a timeout. Any number of
+ * threads may wait on the same event channel, each with its own mask
+ * and flags. A write resumes all waiters whose wait is satisfied by
+ * the events set after the write, and then clears the events of the
+ * waiters that passed `EVENT_WAIT_CLEAR`.
+ *
+ * @param[in] self_p Event channel object.
+ * @param[in, out] mask_p The mask of events to wait for. When the
+ *                        function returns the mask contains the
+ *                        events in the mask that have occured.
+ * @param[in] flags Zero(0) to wait for any event in the mask, or a
+ *                  combination of `EVENT_WAIT_ALL` and
+ *                  `EVENT_WAIT_CLEAR`.
+ * @param[in] timeout_p Time to wait before a timeout occurs. Set to
+ *                      NULL to wait forever.
+ *
+ * @return zero(0), -ETIMEDOUT on timeout or other negative error
+ *         code.
+ */
+int event_wait(struct event_t *self_p,
+               uint32_t *mask_p,
+               int flags,
+               const struct time_t *timeout_p);
+
 /**
  * Try to read one or more events in given event mask. This function
  * returns immediately, even if no event has occured. When the
@@ -0,0 +1,237 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2014-2018, Erik Moqvist
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use, copy,
+ * modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ * This file is part of the Simba project.
+ */
+
+#include "simba.h"
+
+#if CONFIG_LOCK_STATS == 1
+
+struct module_t {
+    int8_t initialized;
+    struct lock_stats_t *head_p;
+#if CONFIG_LOCK_STATS_FS_COMMANDS == 1
+    struct fs_command_t cmd_list;
+    struct fs_command_t cmd_reset;
+#endif
+};
+
+/* Provided by the thread module. */
+extern uint32_t thrd_cycles_get_isr(void);
+
+static struct module_t module;
+
+#if CONFIG_LOCK_STATS_FS_COMMANDS == 1
+
+static int cmd_list_cb(int argc,
+                       const char *argv[],
+                       void *out_p,
+                       void *in_p,
+                       void *arg_p,
+                       void *call_arg_p)
+{
+    return (lock_stats_print(out_p));
+}
+
+static int cmd_reset_cb(int argc,
+                        const char *argv[],
+                        void *out_p,
+                        void *in_p,
+                        void *arg_p,
+                        void *call_arg_p)
+{
+    return (lock_stats_reset());
+}
+
+#endif
+
+static void reset(struct lock_stats_t *self_p)
+{
+    self_p->count = 0;
+    self_p->wait_time = 0;
+    self_p->max_wait_time = 0;
+    self_p->hold_time = 0;
+    self_p->max_hold_time = 0;
+}
+
+int lock_stats_module_init()
+{
+    /* Return immediately if the module is already initialized. */
+    if (module.initialized == 1) {
+        return (0);
+    }
+
+    module.initialized = 1;
+
+#if CONFIG_LOCK_STATS_FS_COMMANDS == 1
+    fs_command_init(&module.cmd_list,
+                    CSTR("/sync/locks/list"),
+                    cmd_list_cb,
+                    NULL);
+    fs_command_register(&module.cmd_list);
+
+    fs_command_init(&module.cmd_reset,
+                    CSTR("/sync/locks/reset"),
+                    cmd_reset_cb,
+                    NULL);
+    fs_command_register(&module.cmd_reset);
+#endif
+
+    return (0);
+}
+
+int lock_stats_init(struct lock_stats_t *self_p)
+{
+    ASSERTN(self_p != NULL, EINVAL);
+
+    self_p->name_p = NULL;
+    reset(self_p);
+    self_p->holders = 0;
+    self_p->taken_at = 0;
+    self_p->next_p = NULL;
+
+    return (0);
+}
+
+int lock_stats_register(struct lock_stats_t *self_p,
+                        const char *name_p)
+{
+    ASSERTN(self_p != NULL, EINVAL);
+    ASSERTN(name_p != NULL, EINVAL);
+
+    sys_lock();
+    self_p->name_p = name_p;
+    self_p->next_p = module.head_p;
+    module.head_p = self_p;
+    sys_unlock();
+
+    return (0);
+}
+
+uint32_t RAM_CODE lock_stats_now_isr(void)
+{
+    return (thrd_cycles_get_isr());
+}
+
+void RAM_CODE lock_stats_taken_isr(struct lock_stats_t *self_p,
+                                   uint32_t start)
+{
+    uint32_t now;
+    uint32_t wait_time;
+
+    now = thrd_cycles_get_isr();
+    wait_time = (now - start);
+    self_p->count++;
+    self_p->wait_time += wait_time;
+
+    if (wait_time > self_p->max_wait_time) {
+        self_p->max_wait_time = wait_time;
+    }
+
+    /* The lock is held from the first holder takes it until the last
+       holder gives it. */
+    if (self_p->holders == 0) {
+        self_p->taken_at = now;
+    }
+
+    self_p->holders++;
+}
+
+void RAM_CODE lock_stats_given_isr(struct lock_stats_t *self_p)
+{
+    uint32_t hold_time;
+
+    self_p->holders--;
+
+    if (self_p->holders == 0) {
+        hold_time = (thrd_cycles_get_isr() - self_p->taken_at);
+        self_p->hold_time += hold_time;
+
+        if (hold_time > self_p->max_hold_time) {
+            self_p->max_hold_time = hold_time;
+        }
+    }
+}
+
+int lock_stats_print(void *chan_p)
+{
+    ASSERTN(chan_p != NULL, EINVAL);
+
+    struct lock_stats_t *stats_p;
+    struct lock_stats_t stats;
+
+    std_fprintf(chan_p,
+                OSTR("                NAME       COUNT"
+                     "          WAIT-TOTAL    WAIT-MAX"
+                     "          HOLD-TOTAL    HOLD-MAX\r\n"));
+
+    sys_lock();
+    stats_p = module.head_p;
+    sys_unlock();
+
+    while (stats_p != NULL) {
+        /* Take a consistent copy of the statistics. */
+        sys_lock();
+        stats = *stats_p;
+        sys_unlock();
+
+        std_fprintf(chan_p,
+                    OSTR("%20s %11lu    %08lx%08lx %11lu"
+                         "    %08lx%08lx %11lu\r\n"),
+                    stats.name_p,
+                    (unsigned long)stats.count,
+                    (unsigned long)(stats.wait_time >> 32),
+                    (unsigned long)stats.wait_time,
+                    (unsigned long)stats.max_wait_time,
+                    (unsigned long)(stats.hold_time >> 32),
+                    (unsigned long)stats.hold_time,
+                    (unsigned long)stats.max_hold_time);
+
+        stats_p = stats.next_p;
+    }
+
+    return (0);
+}
+
+int lock_stats_reset()
+{
+    struct lock_stats_t *stats_p;
+
+    sys_lock();
+
+    stats_p = module.head_p;
+
+    while (stats_p != NULL) {
+        reset(stats_p);
+        stats_p = stats_p->next_p;
+    }
+
+    sys_unlock();
+
+    return (0);
+}
+
+#endif
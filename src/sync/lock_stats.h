@@ -0,0 +1,143 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2014-2018, Erik Moqvist
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use, copy,
+ * modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ * This file is part of the Simba project.
+ */
+
+#ifndef __SYNC_LOCK_STATS_H__
+#define __SYNC_LOCK_STATS_H__
+
+#include "simba.h"
+
+/**
+ * Statistics of a lock. All times are in cycle counter ticks.
+ */
+struct lock_stats_t {
+    const char *name_p;
+    uint32_t count;
+    uint64_t wait_time;
+    uint32_t max_wait_time;
+    uint64_t hold_time;
+    uint32_t max_hold_time;
+    /* Number of threads currently holding the lock. */
+    int holders;
+    uint32_t taken_at;
+    struct lock_stats_t *next_p;
+};
+
+#if CONFIG_LOCK_STATS == 1
+/**
+ * Start measuring the wait time of a lock. Declares a variable with
+ * given name. Must be called with the system lock taken or from an
+ * isr, except by the system lock itself.
+ */
+#    define LOCK_STATS_WAIT_BEGIN_ISR(start)    \
+    uint32_t start = lock_stats_now_isr()
+/** The lock was taken after waiting since start. */
+#    define LOCK_STATS_TAKEN_ISR(stats_p, start)        \
+    lock_stats_taken_isr(stats_p, start)
+/** The lock was given. */
+#    define LOCK_STATS_GIVEN_ISR(stats_p) lock_stats_given_isr(stats_p)
+#else
+#    define LOCK_STATS_WAIT_BEGIN_ISR(start)
+#    define LOCK_STATS_TAKEN_ISR(stats_p, start)
+#    define LOCK_STATS_GIVEN_ISR(stats_p)
+#endif
+
+/**
+ * Initialize the lock statistics module. This function must be
+ * called before calling any other function in this module.
+ *
+ * The module will only be initialized once even if this function is
+ * called multiple times.
+ *
+ * @return zero(0) or negative error code.
+ */
+int lock_stats_module_init(void);
+
+/**
+ * Reset given lock statistics. Called when initializing a lock.
+ *
+ * @param[in] self_p Lock statistics to initialize.
+ *
+ * @return zero(0) or negative error code.
+ */
+int lock_stats_init(struct lock_stats_t *self_p);
+
+/**
+ * Add given lock statistics to the list printed by
+ * `lock_stats_print()`. Only register locks that are never
+ * destroyed, for example module locks.
+ *
+ * @param[in] self_p Lock statistics to register.
+ * @param[in] name_p Lock name.
+ *
+ * @return zero(0) or negative error code.
+ */
+int lock_stats_register(struct lock_stats_t *self_p,
+                        const char *name_p);
+
+/**
+ * Get the current cycle counter value.
+ *
+ * @return Cycle counter value.
+ */
+uint32_t lock_stats_now_isr(void);
+
+/**
+ * Record that the lock of given statistics was taken. Must be called
+ * with the lock taken.
+ *
+ * @param[in] self_p Lock statistics.
+ * @param[in] start Cycle counter value when the thread started to
+ *                  wait for the lock.
+ */
+void lock_stats_taken_isr(struct lock_stats_t *self_p, uint32_t start);
+
+/**
+ * Record that the lock of given statistics was given. Must be called
+ * before the lock is given.
+ *
+ * @param[in] self_p Lock statistics.
+ */
+void lock_stats_given_isr(struct lock_stats_t *self_p);
+
+/**
+ * Print the statistics of all registered locks to given channel.
+ *
+ * @param[in] chan_p Output channel.
+ *
+ * @return zero(0) or negative error code.
+ */
+int lock_stats_print(void *chan_p);
+
+/**
+ * Reset the statistics of all registered locks.
+ *
+ * @return zero(0) or negative error code.
+ */
+int lock_stats_reset(void);
+
+#endif
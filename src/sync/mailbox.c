@@ -0,0 +1,257 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2014-2018, Erik Moqvist
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use, copy,
+ * modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ * This file is part of the Simba project.
+ */
+
+#include "simba.h"
+
+struct mailbox_elem_t {
+    struct thrd_prio_list_elem_t base;
+    void *message_p;
+    int prio;
+};
+
+/**
+ * Insert given message after all messages with higher or the same
+ * priority.
+ */
+static void slots_insert(struct mailbox_t *self_p,
+                         void *message_p,
+                         int prio)
+{
+    int i;
+    int prev;
+
+    i = self_p->count;
+
+    while (i > 0) {
+        prev = ((self_p->head + i - 1) % self_p->length);
+
+        if (self_p->slots_p[prev].prio <= prio) {
+            break;
+        }
+
+        self_p->slots_p[(self_p->head + i) % self_p->length] =
+            self_p->slots_p[prev];
+        i--;
+    }
+
+    i = ((self_p->head + i) % self_p->length);
+    self_p->slots_p[i].message_p = message_p;
+    self_p->slots_p[i].prio = prio;
+    self_p->count++;
+}
+
+static ssize_t mailbox_read(struct mailbox_t *self_p,
+                            void *buf_p,
+                            size_t size)
+{
+    ASSERTN(size == sizeof(void *), EINVAL);
+
+    int res;
+
+    res = mailbox_receive(self_p, (void **)buf_p, NULL);
+
+    if (res != 0) {
+        return (res);
+    }
+
+    return (size);
+}
+
+static ssize_t mailbox_write(struct mailbox_t *self_p,
+                             const void *buf_p,
+                             size_t size)
+{
+    ASSERTN(size == sizeof(void *), EINVAL);
+
+    int res;
+
+    res = mailbox_send(self_p, *(void **)buf_p, 0, NULL);
+
+    if (res != 0) {
+        return (res);
+    }
+
+    return (size);
+}
+
+int mailbox_init(struct mailbox_t *self_p,
+                 struct mailbox_slot_t *slots_p,
+                 int length)
+{
+    ASSERTN(self_p != NULL, EINVAL);
+    ASSERTN(slots_p != NULL, EINVAL);
+    ASSERTN(length > 0, EINVAL);
+
+    chan_init(&self_p->base,
+              (chan_read_fn_t)mailbox_read,
+              (chan_write_fn_t)mailbox_write,
+              (chan_size_fn_t)mailbox_size);
+
+    self_p->slots_p = slots_p;
+    self_p->length = length;
+    self_p->head = 0;
+    self_p->count = 0;
+    thrd_prio_list_init(&self_p->receivers);
+    thrd_prio_list_init(&self_p->senders);
+
+    return (0);
+}
+
+int mailbox_send(struct mailbox_t *self_p,
+                 void *message_p,
+                 int prio,
+                 const struct time_t *timeout_p)
+{
+    ASSERTN(self_p != NULL, EINVAL);
+
+    int res;
+    struct mailbox_elem_t elem;
+
+    sys_lock();
+
+    res = mailbox_send_isr(self_p, message_p, prio);
+
+    if (res == -EAGAIN) {
+        /* Full. Wait for a receiver to insert the message. */
+        elem.base.thrd_p = thrd_self();
+        elem.message_p = message_p;
+        elem.prio = prio;
+        thrd_prio_list_push_isr(&self_p->senders, &elem.base);
+        res = thrd_suspend_isr(timeout_p);
+
+        if (res == -ETIMEDOUT) {
+            thrd_prio_list_remove_isr(&self_p->senders, &elem.base);
+        }
+    }
+
+    sys_unlock();
+
+    return (res);
+}
+
+int mailbox_send_isr(struct mailbox_t *self_p,
+                     void *message_p,
+                     int prio)
+{
+    ASSERTN(self_p != NULL, EINVAL);
+
+    struct mailbox_elem_t *elem_p;
+
+    /* Hand over the message to a waiting receiver. The mailbox is
+       empty if there is one. */
+    elem_p = (struct mailbox_elem_t *)thrd_prio_list_pop_isr(
+        &self_p->receivers);
+
+    if (elem_p != NULL) {
+        elem_p->message_p = message_p;
+        thrd_resume_isr(elem_p->base.thrd_p, 0);
+
+        return (0);
+    }
+
+    if (self_p->count == self_p->length) {
+        return (-EAGAIN);
+    }
+
+    slots_insert(self_p, message_p, prio);
+
+    if (chan_is_polled_isr(&self_p->base)) {
+        thrd_resume_isr(self_p->base.reader_p, 0);
+        self_p->base.reader_p = NULL;
+    }
+
+    return (0);
+}
+
+int mailbox_receive(struct mailbox_t *self_p,
+                    void **message_pp,
+                    const struct time_t *timeout_p)
+{
+    ASSERTN(self_p != NULL, EINVAL);
+    ASSERTN(message_pp != NULL, EINVAL);
+
+    int res;
+    struct mailbox_elem_t elem;
+
+    sys_lock();
+
+    res = mailbox_receive_isr(self_p, message_pp);
+
+    if (res == -EAGAIN) {
+        /* Empty. Wait for a sender to hand over a message. */
+        elem.base.thrd_p = thrd_self();
+        thrd_prio_list_push_isr(&self_p->receivers, &elem.base);
+        res = thrd_suspend_isr(timeout_p);
+
+        if (res == -ETIMEDOUT) {
+            thrd_prio_list_remove_isr(&self_p->receivers, &elem.base);
+        } else {
+            *message_pp = elem.message_p;
+        }
+    }
+
+    sys_unlock();
+
+    return (res);
+}
+
+int mailbox_receive_isr(struct mailbox_t *self_p,
+                        void **message_pp)
+{
+    ASSERTN(self_p != NULL, EINVAL);
+    ASSERTN(message_pp != NULL, EINVAL);
+
+    struct mailbox_elem_t *elem_p;
+
+    if (self_p->count == 0) {
+        return (-EAGAIN);
+    }
+
+    *message_pp = self_p->slots_p[self_p->head].message_p;
+    self_p->head = ((self_p->head + 1) % self_p->length);
+    self_p->count--;
+
+    /* Insert the message of the highest priority waiting sender in
+       the freed slot. */
+    elem_p = (struct mailbox_elem_t *)thrd_prio_list_pop_isr(
+        &self_p->senders);
+
+    if (elem_p != NULL) {
+        slots_insert(self_p, elem_p->message_p, elem_p->prio);
+        thrd_resume_isr(elem_p->base.thrd_p, 0);
+    }
+
+    return (0);
+}
+
+ssize_t mailbox_size(struct mailbox_t *self_p)
+{
+    ASSERTN(self_p != NULL, EINVAL);
+
+    return (self_p->count);
+}
@@ -0,0 +1,151 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2014-2018, Erik Moqvist
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use, copy,
+ * modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ * This file is part of the Simba project.
+ */
+
+#ifndef __SYNC_MAILBOX_H__
+#define __SYNC_MAILBOX_H__
+
+#include "simba.h"
+
+/**
+ * A message slot in a mailbox.
+ */
+struct mailbox_slot_t {
+    void *message_p;
+    int prio;
+};
+
+/**
+ * Mailbox channel passing message pointers between threads without
+ * copying the messages. Messages with higher priority (lower value,
+ * as for threads) are received first, and messages with the same
+ * priority in the order they were sent.
+ *
+ * As a channel, `chan_read()` and `chan_write()` receive and send
+ * one message pointer of size ``sizeof(void *)``, waiting forever,
+ * and written messages have priority zero(0). `chan_poll()` returns
+ * when there is a message in the mailbox.
+ */
+struct mailbox_t {
+    struct chan_t base;
+    struct mailbox_slot_t *slots_p;
+    int length;
+    int head;
+    int count;
+    /* Threads waiting for a message. */
+    struct thrd_prio_list_t receivers;
+    /* Threads waiting for a free slot. */
+    struct thrd_prio_list_t senders;
+};
+
+/**
+ * Initialize given mailbox.
+ *
+ * @param[in] self_p Mailbox to initialize.
+ * @param[in] slots_p Message slots.
+ * @param[in] length Number of slots in `slots_p`, the maximum number
+ *                   of messages in the mailbox.
+ *
+ * @return zero(0) or negative error code.
+ */
+int mailbox_init(struct mailbox_t *self_p,
+                 struct mailbox_slot_t *slots_p,
+                 int length);
+
+/**
+ * Send given message to given mailbox. Waits for a free slot if the
+ * mailbox is full. The message is handed over directly to the
+ * highest priority thread waiting for a message, if any.
+ *
+ * @param[in] self_p Mailbox.
+ * @param[in] message_p Message to send.
+ * @param[in] prio Message priority.
+ * @param[in] timeout_p Time to wait for a free slot before a timeout
+ *                      occurs. Set to NULL to wait forever.
+ *
+ * @return zero(0), -ETIMEDOUT on timeout or other negative error
+ *         code.
+ */
+int mailbox_send(struct mailbox_t *self_p,
+                 void *message_p,
+                 int prio,
+                 const struct time_t *timeout_p);
+
+/**
+ * Send given message to given mailbox from isr or with the system
+ * lock taken (see `sys_lock()`). Never waits.
+ *
+ * @param[in] self_p Mailbox.
+ * @param[in] message_p Message to send.
+ * @param[in] prio Message priority.
+ *
+ * @return zero(0), -EAGAIN if the mailbox is full or other negative
+ *         error code.
+ */
+int mailbox_send_isr(struct mailbox_t *self_p,
+                     void *message_p,
+                     int prio);
+
+/**
+ * Receive the highest priority message from given mailbox. Waits for
+ * a message if the mailbox is empty.
+ *
+ * @param[in] self_p Mailbox.
+ * @param[out] message_pp Received message.
+ * @param[in] timeout_p Time to wait for a message before a timeout
+ *                      occurs. Set to NULL to wait forever.
+ *
+ * @return zero(0), -ETIMEDOUT on timeout or other negative error
+ *         code.
+ */
+int mailbox_receive(struct mailbox_t *self_p,
+                    void **message_pp,
+                    const struct time_t *timeout_p);
+
+/**
+ * Receive the highest priority message from given mailbox from isr
+ * or with the system lock taken (see `sys_lock()`). Never waits.
+ *
+ * @param[in] self_p Mailbox.
+ * @param[out] message_pp Received message.
+ *
+ * @return zero(0), -EAGAIN if the mailbox is empty or other negative
+ *         error code.
+ */
+int mailbox_receive_isr(struct mailbox_t *self_p,
+                        void **message_pp);
+
+/**
+ * Get the number of messages in given mailbox.
+ *
+ * @param[in] self_p Mailbox.
+ *
+ * @return Number of messages in the mailbox.
+ */
+ssize_t mailbox_size(struct mailbox_t *self_p);
+
+#endif
@@ -28,6 +28,121 @@
 
 #include "simba.h"
 
+#if CONFIG_MUTEX_PRIO_INHERIT == 1
+
+/**
+ * Move given thread to its priority position in the waiters list of
+ * given mutex, after its priority was raised.
+ */
+static void waiters_requeue(struct mutex_t *self_p,
+                            struct thrd_t *thrd_p)
+{
+    struct thrd_prio_list_elem_t *elem_p;
+
+    elem_p = self_p->waiters.head_p;
+
+    while (elem_p->thrd_p != thrd_p) {
+        elem_p = elem_p->next_p;
+    }
+
+    thrd_prio_list_remove_isr(&self_p->waiters, elem_p);
+    thrd_prio_list_push_isr(&self_p->waiters, elem_p);
+}
+
+/**
+ * Raise the priority of given thread to given priority, and of the
+ * owner of the mutex it waits for, and so on.
+ */
+static void raise_prio(struct thrd_t *thrd_p, int prio)
+{
+    struct mutex_t *mutex_p;
+
+    while (prio < thrd_p->prio) {
+        thrd_set_prio_isr(thrd_p, prio);
+        mutex_p = thrd_p->mutex.blocked_on_p;
+
+        if (mutex_p == NULL) {
+            break;
+        }
+
+        waiters_requeue(mutex_p, thrd_p);
+        thrd_p = mutex_p->owner_p;
+    }
+}
+
+/**
+ * The priority of given thread from its base priority, and the
+ * priority ceilings and highest priority waiters of all mutexes it
+ * holds.
+ */
+static int owner_prio(struct thrd_t *thrd_p)
+{
+    struct mutex_t *mutex_p;
+    int prio;
+
+    prio = thrd_p->mutex.base_prio;
+    mutex_p = thrd_p->mutex.held_p;
+
+    while (mutex_p != NULL) {
+        if ((mutex_p->has_prio_ceiling == 1)
+            && (mutex_p->prio_ceiling < prio)) {
+            prio = mutex_p->prio_ceiling;
+        }
+
+        /* The waiters are sorted by priority. */
+        if ((mutex_p->waiters.head_p != NULL)
+            && (mutex_p->waiters.head_p->thrd_p->prio < prio)) {
+            prio = mutex_p->waiters.head_p->thrd_p->prio;
+        }
+
+        mutex_p = mutex_p->next_p;
+    }
+
+    return (prio);
+}
+
+/**
+ * Make given thread the owner of given mutex, and raise its priority
+ * to the priority ceiling and the remaining waiters.
+ */
+static void take_ownership(struct mutex_t *self_p,
+                           struct thrd_t *thrd_p)
+{
+    if (thrd_p->mutex.held_p == NULL) {
+        thrd_p->mutex.base_prio = thrd_p->prio;
+    }
+
+    self_p->owner_p = thrd_p;
+    self_p->next_p = thrd_p->mutex.held_p;
+    thrd_p->mutex.held_p = self_p;
+    raise_prio(thrd_p, owner_prio(thrd_p));
+}
+
+/**
+ * Remove given mutex from the mutexes held by its owner, and
+ * recalculate the priority of the owner from the mutexes it still
+ * holds.
+ */
+static void release_ownership(struct mutex_t *self_p)
+{
+    struct thrd_t *thrd_p;
+    struct mutex_t **mutex_pp;
+
+    thrd_p = self_p->owner_p;
+    mutex_pp = &thrd_p->mutex.held_p;
+
+    while (*mutex_pp != self_p) {
+        mutex_pp = &(*mutex_pp)->next_p;
+    }
+
+    *mutex_pp = self_p->next_p;
+    self_p->owner_p = NULL;
+    self_p->next_p = NULL;
+    thrd_set_prio_isr(thrd_p, owner_prio(thrd_p));
+}
+
+#endif
+
 int mutex_module_init(void)
 {
     return (0);
@@ -38,9 +153,34 @@ int mutex_init(struct mutex_t *self_p)
     self_p->is_locked = 0;
     thrd_prio_list_init(&self_p->waiters);
 
+#if CONFIG_MUTEX_PRIO_INHERIT == 1
+    self_p->owner_p = NULL;
+    self_p->next_p = NULL;
+    self_p->has_prio_ceiling = 0;
+    self_p->prio_ceiling = 0;
+#endif
+
+#if CONFIG_LOCK_STATS == 1
+    lock_stats_init(&self_p->stats);
+#endif
+
     return (0);
 }
 
+int mutex_set_prio_ceiling(struct mutex_t *self_p, int prio)
+{
+    ASSERTN(self_p != NULL, EINVAL);
+
+#if CONFIG_MUTEX_PRIO_INHERIT == 1
+    self_p->has_prio_ceiling = 1;
+    self_p->prio_ceiling = prio;
+
+    return (0);
+#else
+    return (-ENOSYS);
+#endif
+}
+
 int mutex_lock(struct mutex_t *self_p)
 {
     int res;
@@ -67,14 +207,28 @@ int mutex_lock_isr(struct mutex_t *self_p)
 {
     struct thrd_prio_list_elem_t elem;
 
+    LOCK_STATS_WAIT_BEGIN_ISR(start);
+
     if (self_p->is_locked == 1) {
         elem.thrd_p = thrd_self();
         thrd_prio_list_push_isr(&self_p->waiters, &elem);
+#if CONFIG_MUTEX_PRIO_INHERIT == 1
+        /* Let the owner inherit the priority of this thread. */
+        elem.thrd_p->mutex.blocked_on_p = self_p;
+        raise_prio(self_p->owner_p, elem.thrd_p->prio);
+#endif
+        TRACE_ISR(MUTEX_BLOCK, self_p, 0);
         thrd_suspend_isr(NULL);
+        TRACE_ISR(MUTEX_UNBLOCK, self_p, 0);
     } else {
         self_p->is_locked = 1;
+#if CONFIG_MUTEX_PRIO_INHERIT == 1
+        take_ownership(self_p, thrd_self());
+#endif
     }
 
+    LOCK_STATS_TAKEN_ISR(&self_p->stats, start);
+
     return (0);
 }
 
@@ -82,9 +236,19 @@ int mutex_unlock_isr(struct mutex_t *self_p)
 {
     struct thrd_prio_list_elem_t *elem_p;
 
+    LOCK_STATS_GIVEN_ISR(&self_p->stats);
+
+#if CONFIG_MUTEX_PRIO_INHERIT == 1
+    release_ownership(self_p);
+#endif
+
     elem_p = thrd_prio_list_pop_isr(&self_p->waiters);
 
     if (elem_p != NULL) {
+#if CONFIG_MUTEX_PRIO_INHERIT == 1
+        elem_p->thrd_p->mutex.blocked_on_p = NULL;
+        take_ownership(self_p, elem_p->thrd_p);
+#endif
         thrd_resume_isr(elem_p->thrd_p, 0);
     } else {
         self_p->is_locked = 0;
@@ -36,6 +36,18 @@ struct mutex_t {
     int8_t is_locked;
     /** Wait list. */
     struct thrd_prio_list_t waiters;
+#if CONFIG_MUTEX_PRIO_INHERIT == 1
+    /** Thread holding the mutex. */
+    struct thrd_t *owner_p;
+    /** Next mutex held by the owner. */
+    struct mutex_t *next_p;
+    /** Priority ceiling, if has_prio_ceiling is one(1). */
+    int8_t has_prio_ceiling;
+    int prio_ceiling;
+#endif
+#if CONFIG_LOCK_STATS == 1
+    struct lock_stats_t stats;
+#endif
 };
 
 /**
@@ -59,7 +71,25 @@ int mutex_module_init(void);
 int mutex_init(struct mutex_t *self_p);
 
 /**
- * Lock given mutex.
+ * Set the priority ceiling of given mutex. A thread holding the mutex
+ * runs with at least the ceiling priority. Mutexes are initialized
+ * without priority ceiling. Requires ``CONFIG_MUTEX_PRIO_INHERIT``.
+ *
+ * @param[in] self_p Mutex to set the priority ceiling of.
+ * @param[in] prio Priority ceiling.
+ *
+ * @return zero(0) or negative error code.
+ */
+int mutex_set_prio_ceiling(struct mutex_t *self_p, int prio);
+
+/**
+ * Lock given mutex. If ``CONFIG_MUTEX_PRIO_INHERIT`` is enabled and
+ * the mutex is held by a thread with lower priority than the calling
+ * thread, the holding thread inherits the priority of the calling
+ * thread until it unlocks the mutex. The priority is also inherited
+ * by the owner of the mutex the holding thread waits for, if any, and
+ * so on. A thread holding several mutexes runs with the highest
+ * priority of the threads waiting for any of them.
  *
  * @param[in] self_p Mutex to lock.
  *
@@ -41,6 +41,39 @@ struct queue_writer_elem_t {
     size_t left;
 };
 
+/**
+ * Move data of blocked writers into the queue buffer.
+ */
+static void fill_from_writers_isr(struct queue_t *self_p)
+{
+    size_t n;
+
+    while (self_p->writer_p != NULL) {
+        n = circular_buffer_write(&self_p->buffer,
+                                  self_p->writer_p->buf_p,
+                                  self_p->writer_p->left);
+
+        if (n == 0) {
+            break;
+        }
+
+        self_p->writer_p->buf_p += n;
+        self_p->writer_p->left -= n;
+
+        /* Writer buffer empty. */
+        if (self_p->writer_p->left == 0) {
+            /* Wake the writer. */
+            thrd_resume_isr(self_p->writer_p->base.thrd_p,
+                            self_p->writer_p->size);
+
+            /* More writers waiting? */
+            self_p->writer_p =
+                (struct queue_writer_elem_t *)thrd_prio_list_pop_isr(
+                    &self_p->writers);
+        }
+    }
+}
+
 static int control(struct queue_t *self_p, int operation)
 {
     int res;
@@ -78,6 +111,7 @@ int queue_init(struct queue_t *self_p,
               (chan_write_fn_t)queue_write,
               (chan_size_fn_t)queue_size);
     chan_set_write_isr_cb(&self_p->base, (chan_write_fn_t)queue_write_isr);
+    chan_set_writev_cb(&self_p->base, (chan_writev_fn_t)queue_writev);
     chan_set_control_cb(&self_p->base, (chan_control_fn_t)control);
 
     thrd_prio_list_init(&self_p->writers);
@@ -209,7 +243,9 @@ ssize_t queue_read(struct queue_t *self_p, void *buf_p, size_t size)
             self_p->reader.size = size;
             self_p->reader.left = left;
 
+            TRACE_ISR(QUEUE_BLOCK, self_p, 0);
             size = thrd_suspend_isr(NULL);
+            TRACE_ISR(QUEUE_UNBLOCK, self_p, 0);
         }
     }
 
@@ -255,7 +291,9 @@ ssize_t queue_write(struct queue_t *self_p,
                                         (struct thrd_prio_list_elem_t *)&elem);
             }
 
+            TRACE_ISR(QUEUE_BLOCK, self_p, 1);
             res = thrd_suspend_isr(NULL);
+            TRACE_ISR(QUEUE_UNBLOCK, self_p, 1);
         }
     }
 
@@ -264,6 +302,53 @@ ssize_t queue_write(struct queue_t *self_p,
     return (res);
 }
 
+ssize_t queue_writev(struct queue_t *self_p,
+                     const struct iov_t *iov_p,
+                     size_t length)
+{
+    ASSERTN(self_p != NULL, EINVAL);
+    ASSERTN((iov_p != NULL) || (length == 0), EINVAL);
+
+    size_t i;
+    size_t size;
+    ssize_t res;
+
+    size = 0;
+
+    for (i = 0; i < length; i++) {
+        size += iov_p[i].size;
+    }
+
+    sys_lock();
+
+    /* Write all buffers at once, without waking the reader in
+       between, if there is room and no blocked writer to pass. */
+    if ((self_p->writer_p == NULL)
+        && ((ssize_t)size <= queue_unused_size_isr(self_p))) {
+        res = 0;
+
+        for (i = 0; i < length; i++) {
+            if (iov_p[i].size == 0) {
+                continue;
+            }
+
+            res = queue_write_isr(self_p, iov_p[i].buf_p, iov_p[i].size);
+
+            if (res < 0) {
+                break;
+            }
+        }
+
+        sys_unlock();
+
+        return (res < 0 ? res : size);
+    }
+
+    sys_unlock();
+
+    return (chan_writev_generic(self_p, iov_p, length));
+}
+
 RAM_CODE ssize_t queue_write_isr(struct queue_t *self_p,
                                  const void *buf_p,
                                  size_t size)
@@ -379,3 +464,138 @@ ssize_t queue_ignore(struct queue_t *self_p,
 
     return (size - left);
 }
+
+ssize_t queue_peek_contiguous(struct queue_t *self_p,
+                              void **buf_pp)
+{
+    ASSERTN(self_p != NULL, EINVAL);
+    ASSERTN(self_p->buf_p != NULL, EINVAL);
+    ASSERTN(buf_pp != NULL, EINVAL);
+
+    ssize_t res;
+
+    sys_lock();
+    res = queue_peek_contiguous_isr(self_p, buf_pp);
+    sys_unlock();
+
+    return (res);
+}
+
+RAM_CODE ssize_t queue_peek_contiguous_isr(struct queue_t *self_p,
+                                           void **buf_pp)
+{
+    if (circular_buffer_used_size(&self_p->buffer) == 0) {
+        fill_from_writers_isr(self_p);
+    }
+
+    return (circular_buffer_array_one(&self_p->buffer,
+                                      buf_pp,
+                                      self_p->buffer.size));
+}
+
+ssize_t queue_consume(struct queue_t *self_p,
+                      size_t size)
+{
+    ASSERTN(self_p != NULL, EINVAL);
+    ASSERTN(self_p->buf_p != NULL, EINVAL);
+
+    ssize_t res;
+
+    sys_lock();
+    res = queue_consume_isr(self_p, size);
+    sys_unlock();
+
+    return (res);
+}
+
+RAM_CODE ssize_t queue_consume_isr(struct queue_t *self_p,
+                                   size_t size)
+{
+    ssize_t res;
+
+    res = circular_buffer_skip_front(&self_p->buffer, size);
+    fill_from_writers_isr(self_p);
+
+    return (res);
+}
+
+ssize_t queue_reserve_contiguous(struct queue_t *self_p,
+                                 void **buf_pp)
+{
+    ASSERTN(self_p != NULL, EINVAL);
+    ASSERTN(self_p->buf_p != NULL, EINVAL);
+    ASSERTN(buf_pp != NULL, EINVAL);
+
+    ssize_t res;
+
+    sys_lock();
+    res = queue_reserve_contiguous_isr(self_p, buf_pp);
+    sys_unlock();
+
+    return (res);
+}
+
+RAM_CODE ssize_t queue_reserve_contiguous_isr(struct queue_t *self_p,
+                                              void **buf_pp)
+{
+    /* Write is not possible to a stopped queue. */
+    if (self_p->state == QUEUE_STATE_STOPPED) {
+        return (-1);
+    }
+
+    return (circular_buffer_reserve(&self_p->buffer,
+                                    buf_pp,
+                                    self_p->buffer.size));
+}
+
+ssize_t queue_commit(struct queue_t *self_p,
+                     size_t size)
+{
+    ASSERTN(self_p != NULL, EINVAL);
+    ASSERTN(self_p->buf_p != NULL, EINVAL);
+
+    ssize_t res;
+
+    sys_lock();
+    res = queue_commit_isr(self_p, size);
+    sys_unlock();
+
+    return (res);
+}
+
+RAM_CODE ssize_t queue_commit_isr(struct queue_t *self_p,
+                                  size_t size)
+{
+    size_t n;
+
+    /* Resume any polling thread. */
+    if (chan_is_polled_isr(&self_p->base)) {
+        thrd_resume_isr(self_p->base.reader_p, 0);
+        self_p->base.reader_p = NULL;
+    }
+
+    if (self_p->state == QUEUE_STATE_STOPPED) {
+        return (-1);
+    }
+
+    size = circular_buffer_commit(&self_p->buffer, size);
+
+    /* The buffer is empty when a reader is waiting, so the committed
+       bytes are the next bytes to read. */
+    if (self_p->base.reader_p != NULL) {
+        n = circular_buffer_read(&self_p->buffer,
+                                 self_p->reader.buf_p,
+                                 self_p->reader.left);
+        self_p->reader.buf_p += n;
+        self_p->reader.left -= n;
+
+        /* Read buffer full. */
+        if (self_p->reader.left == 0) {
+            /* Wake the reader. */
+            thrd_resume_isr(self_p->base.reader_p, self_p->reader.size);
+            self_p->base.reader_p = NULL;
+        }
+    }
+
+    return (size);
+}
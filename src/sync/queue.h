@@ -162,6 +162,21 @@ ssize_t queue_write(struct queue_t *self_p,
                     const void *buf_p,
                     size_t size);
 
+/**
+ * Write the buffers in given io vector to given queue. The buffers
+ * are written in one operation if they fit in the queue, otherwise
+ * one buffer at a time, blocking until all bytes have been written.
+ *
+ * @param[in] self_p Queue to write to.
+ * @param[in] iov_p Io vector of buffers to write.
+ * @param[in] length Number of elements in the io vector.
+ *
+ * @return Number of bytes written or negative error code.
+ */
+ssize_t queue_writev(struct queue_t *self_p,
+                     const struct iov_t *iov_p,
+                     size_t length);
+
 /**
  * Write bytes to given queue from isr or with the system lock
  * taken (see `sys_lock()`). May write less than size bytes.
@@ -216,4 +231,110 @@ ssize_t queue_unused_size_isr(struct queue_t *self_p);
 ssize_t queue_ignore(struct queue_t *self_p,
                      size_t size);
 
+/**
+ * Get a pointer to the next contiguous readable bytes of given
+ * buffered queue, without copying them. Data of blocked writers is
+ * moved into the queue buffer first if the buffer is empty. The
+ * bytes stay in the queue until they are released with
+ * `queue_consume()`.
+ *
+ * @param[in] self_p Queue.
+ * @param[out] buf_pp A pointer to the start of the readable
+ *                    bytes. Only valid if the return value is
+ *                    greater than zero(0).
+ *
+ * @return Number of contiguous readable bytes or negative error code.
+ */
+ssize_t queue_peek_contiguous(struct queue_t *self_p,
+                              void **buf_pp);
+
+/**
+ * Same as `queue_peek_contiguous()`, but from isr or with the system
+ * lock taken (see `sys_lock()`).
+ *
+ * @param[in] self_p Queue.
+ * @param[out] buf_pp A pointer to the start of the readable bytes.
+ *
+ * @return Number of contiguous readable bytes or negative error code.
+ */
+ssize_t queue_peek_contiguous_isr(struct queue_t *self_p,
+                                  void **buf_pp);
+
+/**
+ * Release given number of bytes previously returned by
+ * `queue_peek_contiguous()`. Data of blocked writers is moved into
+ * the freed space.
+ *
+ * @param[in] self_p Queue.
+ * @param[in] size Number of bytes to release.
+ *
+ * @return Number of bytes released or negative error code.
+ */
+ssize_t queue_consume(struct queue_t *self_p,
+                      size_t size);
+
+/**
+ * Same as `queue_consume()`, but from isr or with the system lock
+ * taken (see `sys_lock()`). Writers blocked on a full queue are
+ * resumed once their data has been moved into the freed space.
+ *
+ * @param[in] self_p Queue.
+ * @param[in] size Number of bytes to release.
+ *
+ * @return Number of bytes released or negative error code.
+ */
+ssize_t queue_consume_isr(struct queue_t *self_p,
+                          size_t size);
+
+/**
+ * Get a pointer to the next contiguous unused bytes of given
+ * buffered queue. Write directly into the array and then publish the
+ * written bytes with `queue_commit()`.
+ *
+ * @param[in] self_p Queue.
+ * @param[out] buf_pp A pointer to the start of the unused
+ *                    bytes. Only valid if the return value is
+ *                    greater than zero(0).
+ *
+ * @return Number of contiguous unused bytes or negative error code.
+ */
+ssize_t queue_reserve_contiguous(struct queue_t *self_p,
+                                 void **buf_pp);
+
+/**
+ * Same as `queue_reserve_contiguous()`, but from isr or with the
+ * system lock taken (see `sys_lock()`).
+ *
+ * @param[in] self_p Queue.
+ * @param[out] buf_pp A pointer to the start of the unused bytes.
+ *
+ * @return Number of contiguous unused bytes or negative error code.
+ */
+ssize_t queue_reserve_contiguous_isr(struct queue_t *self_p,
+                                     void **buf_pp);
+
+/**
+ * Publish given number of bytes written to the array returned by
+ * `queue_reserve_contiguous()`. A waiting reader is resumed.
+ *
+ * @param[in] self_p Queue.
+ * @param[in] size Number of bytes to publish.
+ *
+ * @return Number of bytes published or negative error code.
+ */
+ssize_t queue_commit(struct queue_t *self_p,
+                     size_t size);
+
+/**
+ * Same as `queue_commit()`, but from isr or with the system lock
+ * taken (see `sys_lock()`).
+ *
+ * @param[in] self_p Queue.
+ * @param[in] size Number of bytes to publish.
+ *
+ * @return Number of bytes published or negative error code.
+ */
+ssize_t queue_commit_isr(struct queue_t *self_p,
+                         size_t size);
+
 #endif
@@ -0,0 +1,425 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2014-2018, Erik Moqvist
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use, copy,
+ * modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ * This file is part of the Simba project.
+ */
+
+#include "simba.h"
+
+#define EVENT_WAKEUP                                      0x1
+
+static void pending_remove_isr(struct reactor_t *self_p,
+                               struct reactor_work_t *work_p)
+{
+    struct reactor_work_t *prev_p;
+    struct reactor_work_t *curr_p;
+
+    prev_p = NULL;
+    curr_p = self_p->pending.head_p;
+
+    while (curr_p != NULL) {
+        if (curr_p == work_p) {
+            if (prev_p != NULL) {
+                prev_p->next_p = curr_p->next_p;
+            } else {
+                self_p->pending.head_p = curr_p->next_p;
+            }
+
+            if (self_p->pending.tail_p == curr_p) {
+                self_p->pending.tail_p = prev_p;
+            }
+
+            self_p->pending.length--;
+
+            return;
+        }
+
+        prev_p = curr_p;
+        curr_p = curr_p->next_p;
+    }
+}
+
+static struct reactor_work_t *pending_pop(struct reactor_t *self_p)
+{
+    struct reactor_work_t *work_p;
+
+    sys_lock();
+
+    work_p = self_p->pending.head_p;
+
+    if (work_p != NULL) {
+        self_p->pending.head_p = work_p->next_p;
+
+        if (self_p->pending.head_p == NULL) {
+            self_p->pending.tail_p = NULL;
+        }
+
+        self_p->pending.length--;
+        work_p->pending = 0;
+    }
+
+    sys_unlock();
+
+    return (work_p);
+}
+
+/**
+ * Call the work items submitted before this function was called.
+ */
+static int run_pending(struct reactor_t *self_p)
+{
+    struct reactor_work_t *work_p;
+    int length;
+    int i;
+
+    sys_lock();
+    length = self_p->pending.length;
+    sys_unlock();
+
+    for (i = 0; i < length; i++) {
+        work_p = pending_pop(self_p);
+
+        if (work_p == NULL) {
+            break;
+        }
+
+        work_p->func(work_p->arg_p);
+    }
+
+    return (i);
+}
+
+static struct reactor_chan_t *find_chan(struct reactor_t *self_p,
+                                        void *chan_p)
+{
+    struct reactor_chan_t *reactor_chan_p;
+
+    reactor_chan_p = self_p->chans_p;
+
+    while (reactor_chan_p != NULL) {
+        if (reactor_chan_p->chan_p == chan_p) {
+            break;
+        }
+
+        reactor_chan_p = reactor_chan_p->next_p;
+    }
+
+    return (reactor_chan_p);
+}
+
+static void on_timeout(void *arg_p)
+{
+    struct reactor_work_t *work_p;
+
+    work_p = arg_p;
+
+    /* A periodic timer may expire again before its callback is
+       called, which is ignored. */
+    (void)reactor_work_submit_isr(work_p->reactor_p, work_p);
+}
+
+int reactor_init(struct reactor_t *self_p)
+{
+    ASSERTN(self_p != NULL, EINVAL);
+
+    self_p->chans_p = NULL;
+    self_p->pending.head_p = NULL;
+    self_p->pending.tail_p = NULL;
+    self_p->pending.length = 0;
+    self_p->stopped = 0;
+    chan_pollset_init(&self_p->pollset);
+    event_init(&self_p->wakeup);
+
+    return (chan_pollset_add(&self_p->pollset, &self_p->wakeup));
+}
+
+int reactor_run(struct reactor_t *self_p)
+{
+    ASSERTN(self_p != NULL, EINVAL);
+
+    int res;
+
+    while (!self_p->stopped) {
+        res = reactor_run_once(self_p, NULL);
+
+        if ((res < 0) && (res != -ETIMEDOUT)) {
+            return (res);
+        }
+    }
+
+    self_p->stopped = 0;
+
+    return (0);
+}
+
+int reactor_run_once(struct reactor_t *self_p,
+                     const struct time_t *timeout_p)
+{
+    ASSERTN(self_p != NULL, EINVAL);
+
+    void *chans[CONFIG_REACTOR_READY_MAX];
+    struct reactor_chan_t *reactor_chan_p;
+    uint32_t mask;
+    int length;
+    int res;
+    int i;
+
+    length = chan_pollset_wait(&self_p->pollset,
+                               &chans[0],
+                               membersof(chans),
+                               timeout_p);
+
+    if (length < 0) {
+        return (length);
+    }
+
+    res = 0;
+
+    for (i = 0; i < length; i++) {
+        if (chans[i] == &self_p->wakeup) {
+            mask = EVENT_WAKEUP;
+            event_read(&self_p->wakeup, &mask, sizeof(mask));
+        } else {
+            /* Earlier callbacks may have removed the channel. */
+            reactor_chan_p = find_chan(self_p, chans[i]);
+
+            if (reactor_chan_p != NULL) {
+                reactor_chan_p->func(reactor_chan_p->arg_p);
+                res++;
+            }
+        }
+    }
+
+    res += run_pending(self_p);
+
+    return (res);
+}
+
+int reactor_stop(struct reactor_t *self_p)
+{
+    ASSERTN(self_p != NULL, EINVAL);
+
+    uint32_t mask;
+
+    self_p->stopped = 1;
+    mask = EVENT_WAKEUP;
+
+    event_write(&self_p->wakeup, &mask, sizeof(mask));
+
+    return (0);
+}
+
+int reactor_chan_init(struct reactor_chan_t *self_p,
+                      void *chan_p,
+                      reactor_fn_t func,
+                      void *arg_p)
+{
+    ASSERTN(self_p != NULL, EINVAL);
+    ASSERTN(chan_p != NULL, EINVAL);
+    ASSERTN(func != NULL, EINVAL);
+
+    self_p->chan_p = chan_p;
+    self_p->func = func;
+    self_p->arg_p = arg_p;
+    self_p->next_p = NULL;
+
+    return (0);
+}
+
+int reactor_chan_add(struct reactor_t *self_p,
+                     struct reactor_chan_t *chan_p)
+{
+    ASSERTN(self_p != NULL, EINVAL);
+    ASSERTN(chan_p != NULL, EINVAL);
+
+    int res;
+
+    res = chan_pollset_add(&self_p->pollset, chan_p->chan_p);
+
+    if (res != 0) {
+        return (res);
+    }
+
+    chan_p->next_p = self_p->chans_p;
+    self_p->chans_p = chan_p;
+
+    return (0);
+}
+
+int reactor_chan_remove(struct reactor_t *self_p,
+                        struct reactor_chan_t *chan_p)
+{
+    ASSERTN(self_p != NULL, EINVAL);
+    ASSERTN(chan_p != NULL, EINVAL);
+
+    struct reactor_chan_t **curr_pp;
+
+    curr_pp = &self_p->chans_p;
+
+    while (*curr_pp != NULL) {
+        if (*curr_pp == chan_p) {
+            *curr_pp = chan_p->next_p;
+            chan_p->next_p = NULL;
+            chan_pollset_remove(&self_p->pollset, chan_p->chan_p);
+
+            return (0);
+        }
+
+        curr_pp = &(*curr_pp)->next_p;
+    }
+
+    return (-ENOENT);
+}
+
+int reactor_work_init(struct reactor_work_t *self_p,
+                      reactor_fn_t func,
+                      void *arg_p)
+{
+    ASSERTN(self_p != NULL, EINVAL);
+    ASSERTN(func != NULL, EINVAL);
+
+    self_p->func = func;
+    self_p->arg_p = arg_p;
+    self_p->reactor_p = NULL;
+    self_p->pending = 0;
+    self_p->next_p = NULL;
+
+    return (0);
+}
+
+int reactor_work_submit(struct reactor_t *self_p,
+                        struct reactor_work_t *work_p)
+{
+    ASSERTN(self_p != NULL, EINVAL);
+    ASSERTN(work_p != NULL, EINVAL);
+
+    int res;
+
+    sys_lock();
+    res = reactor_work_submit_isr(self_p, work_p);
+    sys_unlock();
+
+    return (res);
+}
+
+int reactor_work_submit_isr(struct reactor_t *self_p,
+                            struct reactor_work_t *work_p)
+{
+    uint32_t mask;
+
+    if (work_p->pending) {
+        return (-EBUSY);
+    }
+
+    work_p->reactor_p = self_p;
+    work_p->pending = 1;
+    work_p->next_p = NULL;
+
+    if (self_p->pending.tail_p != NULL) {
+        self_p->pending.tail_p->next_p = work_p;
+    } else {
+        self_p->pending.head_p = work_p;
+    }
+
+    self_p->pending.tail_p = work_p;
+    self_p->pending.length++;
+
+    mask = EVENT_WAKEUP;
+    event_write_isr(&self_p->wakeup, &mask, sizeof(mask));
+
+    return (0);
+}
+
+int reactor_work_cancel(struct reactor_work_t *work_p)
+{
+    ASSERTN(work_p != NULL, EINVAL);
+
+    int res;
+
+    res = -ENOENT;
+
+    sys_lock();
+
+    if (work_p->pending) {
+        pending_remove_isr(work_p->reactor_p, work_p);
+        work_p->pending = 0;
+        res = 0;
+    }
+
+    sys_unlock();
+
+    return (res);
+}
+
+int reactor_timer_init(struct reactor_timer_t *self_p,
+                       struct reactor_t *reactor_p,
+                       const struct time_t *timeout_p,
+                       reactor_fn_t func,
+                       void *arg_p,
+                       int flags)
+{
+    ASSERTN(self_p != NULL, EINVAL);
+    ASSERTN(reactor_p != NULL, EINVAL);
+    ASSERTN(timeout_p != NULL, EINVAL);
+    ASSERTN(func != NULL, EINVAL);
+
+    reactor_work_init(&self_p->work, func, arg_p);
+    self_p->work.reactor_p = reactor_p;
+
+    return (timer_init(&self_p->timer,
+                       timeout_p,
+                       on_timeout,
+                       &self_p->work,
+                       flags));
+}
+
+int reactor_timer_start(struct reactor_timer_t *self_p)
+{
+    ASSERTN(self_p != NULL, EINVAL);
+
+    sys_lock();
+    timer_stop_isr(&self_p->timer);
+    timer_start_isr(&self_p->timer);
+    sys_unlock();
+
+    return (0);
+}
+
+int reactor_timer_stop(struct reactor_timer_t *self_p)
+{
+    ASSERTN(self_p != NULL, EINVAL);
+
+    sys_lock();
+    timer_stop_isr(&self_p->timer);
+
+    if (self_p->work.pending) {
+        pending_remove_isr(self_p->work.reactor_p, &self_p->work);
+        self_p->work.pending = 0;
+    }
+
+    sys_unlock();
+
+    return (0);
+}
@@ -0,0 +1,254 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2014-2018, Erik Moqvist
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use, copy,
+ * modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ * This file is part of the Simba project.
+ */
+
+#ifndef __SYNC_REACTOR_H__
+#define __SYNC_REACTOR_H__
+
+#include "simba.h"
+
+typedef void (*reactor_fn_t)(void *arg_p);
+
+/* Deferred work, called from the reactor loop. */
+struct reactor_work_t {
+    reactor_fn_t func;
+    void *arg_p;
+    struct reactor_t *reactor_p;
+    int pending;
+    struct reactor_work_t *next_p;
+};
+
+/* A timer with its expiry callback called from the reactor loop. */
+struct reactor_timer_t {
+    struct reactor_work_t work;
+    struct timer_t timer;
+};
+
+/* A channel with a callback called when it has data. */
+struct reactor_chan_t {
+    void *chan_p;
+    reactor_fn_t func;
+    void *arg_p;
+    struct reactor_chan_t *next_p;
+};
+
+/**
+ * Single threaded event loop calling callbacks for ready channels,
+ * expired timers and submitted work. All callbacks are called from
+ * the thread running the loop, one at a time, so they may share data
+ * without locking, but must not block for long.
+ */
+struct reactor_t {
+    struct chan_pollset_t pollset;
+    /* Written to wake the loop when work is submitted. */
+    struct event_t wakeup;
+    struct reactor_chan_t *chans_p;
+    struct {
+        struct reactor_work_t *head_p;
+        struct reactor_work_t *tail_p;
+        int length;
+    } pending;
+    int stopped;
+};
+
+/**
+ * Initialize given reactor. Requires ``CONFIG_CHAN_POLLSET``.
+ *
+ * @param[in] self_p Reactor to initialize.
+ *
+ * @return zero(0) or negative error code.
+ */
+int reactor_init(struct reactor_t *self_p);
+
+/**
+ * Run the reactor loop in the calling thread until `reactor_stop()`
+ * is called.
+ *
+ * @param[in] self_p Reactor to run.
+ *
+ * @return zero(0) or negative error code.
+ */
+int reactor_run(struct reactor_t *self_p);
+
+/**
+ * Wait for at least one ready channel or submitted work, or a
+ * timeout, and call their callbacks. Work submitted while running
+ * callbacks is called in the next iteration.
+ *
+ * @param[in] self_p Reactor to run.
+ * @param[in] timeout_p Time to wait before a timeout occurs. Set to
+ *                      NULL to wait forever.
+ *
+ * @return Number of called callbacks, -ETIMEDOUT on timeout or other
+ *         negative error code.
+ */
+int reactor_run_once(struct reactor_t *self_p,
+                     const struct time_t *timeout_p);
+
+/**
+ * Make `reactor_run()` return after the current iteration. May be
+ * called from any thread or callback.
+ *
+ * @param[in] self_p Reactor to stop.
+ *
+ * @return zero(0) or negative error code.
+ */
+int reactor_stop(struct reactor_t *self_p);
+
+/**
+ * Initialize given reactor channel.
+ *
+ * @param[in] self_p Reactor channel to initialize.
+ * @param[in] chan_p Channel to wait for data on.
+ * @param[in] func Function to call when the channel has data.
+ * @param[in] arg_p Argument passed to ``func``.
+ *
+ * @return zero(0) or negative error code.
+ */
+int reactor_chan_init(struct reactor_chan_t *self_p,
+                      void *chan_p,
+                      reactor_fn_t func,
+                      void *arg_p);
+
+/**
+ * Add given channel to given reactor. The channel callback is called
+ * in every loop iteration as long as the channel has data, so it does
+ * not have to read all data at once. The channel must not be polled
+ * by any other thread while added.
+ *
+ * Channels are added and removed by the thread running the reactor
+ * loop, or before the loop is started.
+ *
+ * @param[in] self_p Reactor.
+ * @param[in] chan_p Reactor channel to add.
+ *
+ * @return zero(0) or negative error code.
+ */
+int reactor_chan_add(struct reactor_t *self_p,
+                     struct reactor_chan_t *chan_p);
+
+/**
+ * Remove given channel from given reactor. Its callback is not called
+ * after this function returns, so a callback may remove any channel,
+ * including its own.
+ *
+ * @param[in] self_p Reactor.
+ * @param[in] chan_p Reactor channel to remove.
+ *
+ * @return zero(0), -ENOENT if the channel is not added, or other
+ *         negative error code.
+ */
+int reactor_chan_remove(struct reactor_t *self_p,
+                        struct reactor_chan_t *chan_p);
+
+/**
+ * Initialize given work item.
+ *
+ * @param[in] self_p Work item to initialize.
+ * @param[in] func Function to call from the reactor loop.
+ * @param[in] arg_p Argument passed to ``func``.
+ *
+ * @return zero(0) or negative error code.
+ */
+int reactor_work_init(struct reactor_work_t *self_p,
+                      reactor_fn_t func,
+                      void *arg_p);
+
+/**
+ * Submit given work item to given reactor. May be called from any
+ * thread or callback. The work item may be submitted again once its
+ * function is called.
+ *
+ * @param[in] self_p Reactor to submit to.
+ * @param[in] work_p Work item to submit.
+ *
+ * @return zero(0), -EBUSY if the work item is already submitted, or
+ *         other negative error code.
+ */
+int reactor_work_submit(struct reactor_t *self_p,
+                        struct reactor_work_t *work_p);
+
+/**
+ * See `reactor_work_submit()` for a description.
+ *
+ * This function may only be called from an isr or with the system
+ * lock taken (see `sys_lock()`).
+ */
+int reactor_work_submit_isr(struct reactor_t *self_p,
+                            struct reactor_work_t *work_p);
+
+/**
+ * Cancel given submitted work item.
+ *
+ * @param[in] work_p Work item to cancel.
+ *
+ * @return zero(0), -ENOENT if the work item is not submitted, or
+ *         other negative error code.
+ */
+int reactor_work_cancel(struct reactor_work_t *work_p);
+
+/**
+ * Initialize given reactor timer.
+ *
+ * @param[in] self_p Timer to initialize.
+ * @param[in] reactor_p Reactor to call the expiry callback from.
+ * @param[in] timeout_p The timer timeout value.
+ * @param[in] func Function to call from the reactor loop when the
+ *                 timer expires.
+ * @param[in] arg_p Argument passed to ``func``.
+ * @param[in] flags Set TIMER_PERIODIC for periodic timer.
+ *
+ * @return zero(0) or negative error code.
+ */
+int reactor_timer_init(struct reactor_timer_t *self_p,
+                       struct reactor_t *reactor_p,
+                       const struct time_t *timeout_p,
+                       reactor_fn_t func,
+                       void *arg_p,
+                       int flags);
+
+/**
+ * Start given timer, or restart it with the initial timeout if
+ * already started.
+ *
+ * @param[in] self_p Timer to start.
+ *
+ * @return zero(0) or negative error code.
+ */
+int reactor_timer_start(struct reactor_timer_t *self_p);
+
+/**
+ * Stop given timer. The expiry callback is not called after this
+ * function returns, even if the timer already expired.
+ *
+ * @param[in] self_p Timer to stop.
+ *
+ * @return zero(0) or negative error code.
+ */
+int reactor_timer_stop(struct reactor_timer_t *self_p);
+
+#endif
@@ -28,11 +28,75 @@
 
 #include "simba.h"
 
-struct rwlock_elem_t {
-    struct thrd_t *thrd_p;
-    volatile struct rwlock_elem_t *next_p;
-    volatile struct rwlock_elem_t *prev_p;
-};
+/**
+ * Returns true(1) if given reader has to wait for the lock.
+ */
+static int reader_must_wait(struct rwlock_t *self_p,
+                            struct thrd_t *thrd_p)
+{
+    struct thrd_prio_list_elem_t *writer_p;
+
+    if (self_p->number_of_writers > 0) {
+        return (1);
+    }
+
+    writer_p = self_p->writers.head_p;
+
+    if (writer_p == NULL) {
+        return (0);
+    }
+
+    switch (self_p->policy) {
+
+    case RWLOCK_POLICY_READER_PREFERENCE:
+        return (0);
+
+    case RWLOCK_POLICY_PRIO:
+        return (writer_p->thrd_p->prio <= thrd_p->prio);
+
+    default:
+        return (1);
+    }
+}
+
+static void writer_taken(struct rwlock_t *self_p)
+{
+    self_p->number_of_writers = 1;
+    self_p->sequence++;
+}
+
+/**
+ * Hand over the lock to the next waiters, if any, when neither
+ * readers nor writers hold it. Ownership is transferred before the
+ * waiters are resumed.
+ */
+static void wake_next(struct rwlock_t *self_p)
+{
+    struct thrd_prio_list_elem_t *elem_p;
+
+    if ((self_p->number_of_readers > 0) || (self_p->number_of_writers > 0)) {
+        return;
+    }
+
+    /* Readers allowed to take the lock by the policy go first. */
+    while ((self_p->readers.head_p != NULL)
+           && !reader_must_wait(self_p, self_p->readers.head_p->thrd_p)) {
+        elem_p = thrd_prio_list_pop_isr(&self_p->readers);
+        self_p->number_of_readers++;
+        thrd_resume_isr(elem_p->thrd_p, 0);
+    }
+
+    if (self_p->number_of_readers > 0) {
+        return;
+    }
+
+    elem_p = thrd_prio_list_pop_isr(&self_p->writers);
+
+    if (elem_p != NULL) {
+        writer_taken(self_p);
+        thrd_resume_isr(elem_p->thrd_p, 0);
+    }
+}
 
 int rwlock_module_init(void)
 {
@@ -45,8 +109,32 @@ int rwlock_init(struct rwlock_t *self_p)
 
     self_p->number_of_readers = 0;
     self_p->number_of_writers = 0;
-    self_p->readers_p = NULL;
-    self_p->writers_p = NULL;
+    thrd_prio_list_init(&self_p->readers);
+    thrd_prio_list_init(&self_p->writers);
+    self_p->policy = RWLOCK_POLICY_WRITER_PREFERENCE;
+    self_p->sequence = 0;
+
+#if CONFIG_LOCK_STATS == 1
+    lock_stats_init(&self_p->stats);
+#endif
+
+    return (0);
+}
+
+int rwlock_set_policy(struct rwlock_t *self_p, int policy)
+{
+    ASSERTN(self_p != NULL, EINVAL);
+
+    if ((policy != RWLOCK_POLICY_READER_PREFERENCE)
+        && (policy != RWLOCK_POLICY_WRITER_PREFERENCE)
+        && (policy != RWLOCK_POLICY_PRIO)) {
+        return (-EINVAL);
+    }
+
+    sys_lock();
+    self_p->policy = policy;
+    wake_next(self_p);
+    sys_unlock();
 
     return (0);
 }
@@ -55,26 +143,26 @@ int rwlock_reader_take(struct rwlock_t *self_p)
 {
     ASSERTN(self_p != NULL, EINVAL);
 
-    struct rwlock_elem_t elem;
-    int res = 0;
+    struct thrd_prio_list_elem_t elem;
 
     sys_lock();
 
-    self_p->number_of_readers++;
+    LOCK_STATS_WAIT_BEGIN_ISR(start);
 
-    /* Wait if the lock is taken by a writer. */
-    if (self_p->number_of_writers > 0) {
-        elem.thrd_p = thrd_self();
-        elem.next_p = self_p->readers_p;
-        elem.prev_p = NULL;
-        self_p->readers_p = &elem;
+    elem.thrd_p = thrd_self();
 
+    if (reader_must_wait(self_p, elem.thrd_p)) {
+        thrd_prio_list_push_isr(&self_p->readers, &elem);
         thrd_suspend_isr(NULL);
+    } else {
+        self_p->number_of_readers++;
     }
 
+    LOCK_STATS_TAKEN_ISR(&self_p->stats, start);
+
     sys_unlock();
 
-    return (res);
+    return (0);
 }
 
 int rwlock_reader_give(struct rwlock_t *self_p)
@@ -92,21 +180,9 @@ int rwlock_reader_give_isr(struct rwlock_t *self_p)
 {
     ASSERTN(self_p != NULL, EINVAL);
 
-    volatile struct rwlock_elem_t *elem_p;
-
+    LOCK_STATS_GIVEN_ISR(&self_p->stats);
     self_p->number_of_readers--;
-
-    if ((self_p->number_of_writers > 0)
-        && (self_p->number_of_readers == 0)) {
-        elem_p = self_p->writers_p;
-        self_p->writers_p = elem_p->next_p;
-
-        if (self_p->writers_p != NULL) {
-            self_p->writers_p->prev_p = NULL;
-        }
-
-        thrd_resume_isr(elem_p->thrd_p, 0);
-    }
+    wake_next(self_p);
 
     return (0);
 }
@@ -115,27 +191,27 @@ int rwlock_writer_take(struct rwlock_t *self_p)
 {
     ASSERTN(self_p != NULL, EINVAL);
 
-    struct rwlock_elem_t elem;
-    int res = 0;
+    struct thrd_prio_list_elem_t elem;
 
     sys_lock();
 
-    self_p->number_of_writers++;
+    LOCK_STATS_WAIT_BEGIN_ISR(start);
 
-    /* Wait if the lock is taken by a reader or another writer. */
+    /* Wait if the lock is taken by readers or another writer. */
     if ((self_p->number_of_readers > 0)
-        || (self_p->number_of_writers > 1)) {
+        || (self_p->number_of_writers > 0)) {
         elem.thrd_p = thrd_self();
-        elem.next_p = self_p->writers_p;
-        elem.prev_p = NULL;
-        self_p->writers_p = &elem;
-
+        thrd_prio_list_push_isr(&self_p->writers, &elem);
         thrd_suspend_isr(NULL);
+    } else {
+        writer_taken(self_p);
     }
 
+    LOCK_STATS_TAKEN_ISR(&self_p->stats, start);
+
     sys_unlock();
 
-    return (res);
+    return (0);
 }
 
 int rwlock_writer_give(struct rwlock_t *self_p)
@@ -151,34 +227,41 @@ int rwlock_writer_give(struct rwlock_t *self_p)
 
 int rwlock_writer_give_isr(struct rwlock_t *self_p)
 {
-    volatile struct rwlock_elem_t *elem_p;
-
-    self_p->number_of_writers--;
+    ASSERTN(self_p != NULL, EINVAL);
 
-    if (self_p->number_of_writers > 0) {
-        elem_p = self_p->writers_p;
-        self_p->writers_p = elem_p->next_p;
+    LOCK_STATS_GIVEN_ISR(&self_p->stats);
+    self_p->number_of_writers = 0;
+    self_p->sequence++;
+    wake_next(self_p);
 
-        if (self_p->writers_p != NULL) {
-            self_p->writers_p->prev_p = NULL;
-        }
+    return (0);
+}
 
-        thrd_resume_isr(elem_p->thrd_p, 0);
-    } else if (self_p->number_of_readers > 0) {
-        elem_p = self_p->readers_p;
+uint32_t rwlock_optimistic_read_begin(struct rwlock_t *self_p)
+{
+    ASSERTN(self_p != NULL, EINVAL);
 
-        do {
-            self_p->readers_p = elem_p->next_p;
+    uint32_t sequence;
 
-            if (self_p->readers_p != NULL) {
-                self_p->readers_p->prev_p = NULL;
-            }
+    while (1) {
+        sequence = self_p->sequence;
 
-            thrd_resume_isr(elem_p->thrd_p, 0);
+        if ((sequence & 1) == 0) {
+            break;
+        }
 
-            elem_p = elem_p->next_p;
-        } while (elem_p != NULL);
+        /* Wait for the writer to give the lock. */
+        rwlock_reader_take(self_p);
+        rwlock_reader_give(self_p);
     }
 
-    return (0);
+    return (sequence);
+}
+
+int rwlock_optimistic_read_retry(struct rwlock_t *self_p,
+                                 uint32_t sequence)
+{
+    ASSERTN(self_p != NULL, EINVAL);
+
+    return (self_p->sequence != sequence);
 }
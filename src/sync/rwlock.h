@@ -31,11 +31,39 @@
 
 #include "simba.h"
 
+/**
+ * Readers take the lock whenever no writer holds it. Writers may
+ * starve.
+ */
+#define RWLOCK_POLICY_READER_PREFERENCE                     0
+
+/**
+ * Readers wait while a writer holds or waits for the lock. This is
+ * the default policy.
+ */
+#define RWLOCK_POLICY_WRITER_PREFERENCE                     1
+
+/**
+ * Readers wait while a writer holds the lock, or a writer with the
+ * same or higher priority waits for it.
+ */
+#define RWLOCK_POLICY_PRIO                                  2
+
 struct rwlock_t {
+    /** Number of readers holding the lock. */
     int number_of_readers;
+    /** One(1) if a writer holds the lock, otherwise zero(0). */
     int number_of_writers;
-    volatile struct rwlock_elem_t *readers_p;
-    volatile struct rwlock_elem_t *writers_p;
+    /** Waiting readers, highest priority first. */
+    struct thrd_prio_list_t readers;
+    /** Waiting writers, highest priority first. */
+    struct thrd_prio_list_t writers;
+    int policy;
+    /** Odd while a writer holds the lock. */
+    volatile uint32_t sequence;
+#if CONFIG_LOCK_STATS == 1
+    struct lock_stats_t stats;
+#endif
 };
 
 /**
@@ -58,6 +86,20 @@ int rwlock_module_init(void);
  */
 int rwlock_init(struct rwlock_t *self_p);
 
+/**
+ * Set the policy of given reader-writer lock. Waiting threads are
+ * always woken up in priority order, the policy decides if waiting
+ * readers or writers are woken up first.
+ *
+ * @param[in] self_p Reader-writer lock.
+ * @param[in] policy One of ``RWLOCK_POLICY_READER_PREFERENCE``,
+ *                   ``RWLOCK_POLICY_WRITER_PREFERENCE`` and
+ *                   ``RWLOCK_POLICY_PRIO``.
+ *
+ * @return zero(0) or negative error code.
+ */
+int rwlock_set_policy(struct rwlock_t *self_p, int policy);
+
 /**
  * Take given reader-writer lock. Multiple threads can have the reader
  * lock at the same time.
@@ -116,4 +158,36 @@ int rwlock_writer_give(struct rwlock_t *self_p);
  */
 int rwlock_writer_give_isr(struct rwlock_t *self_p);
 
+/**
+ * Begin an optimistic read section of given reader-writer lock. The
+ * reader does not take the lock, so it never blocks writers, but has
+ * to read the protected data again if
+ * ``rwlock_optimistic_read_retry()`` returns true. Waits if a writer
+ * holds the lock.
+ *
+ * Only use optimistic reads for data that can be read safely while
+ * it is modified, for example a few integers, and not for linked data
+ * structures.
+ *
+ * @param[in] self_p Reader-writer lock.
+ *
+ * @return Sequence number to pass to
+ *         ``rwlock_optimistic_read_retry()``.
+ */
+uint32_t rwlock_optimistic_read_begin(struct rwlock_t *self_p);
+
+/**
+ * End an optimistic read section started with
+ * ``rwlock_optimistic_read_begin()``.
+ *
+ * @param[in] self_p Reader-writer lock.
+ * @param[in] sequence Sequence number returned by
+ *                     ``rwlock_optimistic_read_begin()``.
+ *
+ * @return true(1) if a writer took the lock during the read section
+ *         and the data has to be read again, otherwise false(0).
+ */
+int rwlock_optimistic_read_retry(struct rwlock_t *self_p,
+                                 uint32_t sequence);
+
 #endif
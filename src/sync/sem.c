@@ -62,7 +62,9 @@ int sem_take(struct sem_t *self_p,
     if (self_p->count == self_p->count_max) {
         elem.thrd_p = thrd_self();
         thrd_prio_list_push_isr(&self_p->waiters, &elem);
+        TRACE_ISR(SEM_BLOCK, self_p, 0);
         err = thrd_suspend_isr(timeout_p);
+        TRACE_ISR(SEM_UNBLOCK, self_p, err);
 
         if (err == -ETIMEDOUT) {
             thrd_prio_list_remove_isr(&self_p->waiters, &elem);
@@ -0,0 +1,239 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2014-2018, Erik Moqvist
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use, copy,
+ * modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ * This file is part of the Simba project.
+ */
+
+#include "simba.h"
+
+/* The producer publishes the write position after copying the data,
+   and the consumer publishes the read position after copying it
+   out, both with release semantics. */
+#define LOAD(pos) __atomic_load_n(&(pos), __ATOMIC_ACQUIRE)
+#define STORE(pos, value) __atomic_store_n(&(pos), (value), __ATOMIC_RELEASE)
+
+#if CONFIG_CHAN_POLLSET == 1
+#    define IS_IN_POLLSET(self_p) ((self_p)->base.pollset_p != NULL)
+#else
+#    define IS_IN_POLLSET(self_p) 0
+#endif
+
+/**
+ * Copy as much as possible of given buffer into the queue.
+ */
+static RAM_CODE size_t produce(struct spsc_queue_t *self_p,
+                               const char *buf_p,
+                               size_t size)
+{
+    size_t writepos;
+    size_t i;
+    size_t n;
+
+    writepos = self_p->writepos;
+    n = (self_p->mask + 1 - (writepos - LOAD(self_p->readpos)));
+
+    if (size < n) {
+        n = size;
+    }
+
+    for (i = 0; i < n; i++) {
+        self_p->buf_p[(writepos + i) & self_p->mask] = buf_p[i];
+    }
+
+    STORE(self_p->writepos, writepos + n);
+
+    return (n);
+}
+
+/**
+ * Copy as much as possible from the queue into given buffer.
+ */
+static RAM_CODE size_t consume(struct spsc_queue_t *self_p,
+                               char *buf_p,
+                               size_t size)
+{
+    size_t readpos;
+    size_t i;
+    size_t n;
+
+    readpos = self_p->readpos;
+    n = (LOAD(self_p->writepos) - readpos);
+
+    if (size < n) {
+        n = size;
+    }
+
+    for (i = 0; i < n; i++) {
+        buf_p[i] = self_p->buf_p[(readpos + i) & self_p->mask];
+    }
+
+    STORE(self_p->readpos, readpos + n);
+
+    return (n);
+}
+
+/**
+ * Resume the consumer if it is waiting for data. This function must
+ * be called with the system lock taken or from an isr.
+ */
+static RAM_CODE void resume_reader_isr(struct spsc_queue_t *self_p)
+{
+    struct thrd_t *reader_p;
+
+    reader_p = self_p->base.reader_p;
+
+    if (reader_p == NULL) {
+        /* A channel in a poll set is made ready without a reader. */
+        if (IS_IN_POLLSET(self_p) && chan_is_polled_isr(&self_p->base)) {
+            thrd_resume_isr(self_p->base.reader_p, 0);
+            self_p->base.reader_p = NULL;
+        }
+
+        return;
+    }
+
+    /* A polling reader is resumed by the first channel with
+       data. */
+    if (self_p->base.list_p != NULL) {
+        if (chan_is_polled_isr(&self_p->base)) {
+            thrd_resume_isr(reader_p, 0);
+        }
+    } else {
+        thrd_resume_isr(reader_p, 0);
+    }
+
+    self_p->base.reader_p = NULL;
+}
+
+int spsc_queue_init(struct spsc_queue_t *self_p,
+                    void *buf_p,
+                    size_t size)
+{
+    ASSERTN(self_p != NULL, EINVAL);
+    ASSERTN(buf_p != NULL, EINVAL);
+    ASSERTN((size > 0) && ((size & (size - 1)) == 0), EINVAL);
+
+    chan_init(&self_p->base,
+              (chan_read_fn_t)spsc_queue_read,
+              (chan_write_fn_t)spsc_queue_write,
+              (chan_size_fn_t)spsc_queue_size);
+    chan_set_write_isr_cb(&self_p->base,
+                          (chan_write_fn_t)spsc_queue_write_isr);
+
+    self_p->buf_p = buf_p;
+    self_p->mask = (size - 1);
+    self_p->writepos = 0;
+    self_p->readpos = 0;
+
+    return (0);
+}
+
+ssize_t spsc_queue_read(struct spsc_queue_t *self_p,
+                        void *buf_p,
+                        size_t size)
+{
+    ASSERTN(self_p != NULL, EINVAL);
+    ASSERTN(buf_p != NULL, EINVAL);
+
+    char *c_buf_p;
+    size_t left;
+
+    c_buf_p = buf_p;
+    left = size;
+
+    while (1) {
+        left -= consume(self_p, &c_buf_p[size - left], left);
+
+        if (left == 0) {
+            break;
+        }
+
+        /* Suspend until the producer has written more data. The
+           producer checks for a reader after publishing its data, so
+           the data is checked again after the reader is set. */
+        sys_lock();
+
+        self_p->base.reader_p = thrd_self();
+        __atomic_thread_fence(__ATOMIC_SEQ_CST);
+
+        if (LOAD(self_p->writepos) == self_p->readpos) {
+            thrd_suspend_isr(NULL);
+        }
+
+        self_p->base.reader_p = NULL;
+
+        sys_unlock();
+    }
+
+    return (size);
+}
+
+ssize_t spsc_queue_write(struct spsc_queue_t *self_p,
+                         const void *buf_p,
+                         size_t size)
+{
+    ASSERTN(self_p != NULL, EINVAL);
+    ASSERTN(buf_p != NULL, EINVAL);
+
+    size_t n;
+
+    n = produce(self_p, buf_p, size);
+    __atomic_thread_fence(__ATOMIC_SEQ_CST);
+
+    /* Only take the lock if the reader is waiting. */
+    if ((self_p->base.reader_p != NULL) || IS_IN_POLLSET(self_p)) {
+        sys_lock();
+        resume_reader_isr(self_p);
+        sys_unlock();
+    }
+
+    return (n);
+}
+
+RAM_CODE ssize_t spsc_queue_write_isr(struct spsc_queue_t *self_p,
+                                      const void *buf_p,
+                                      size_t size)
+{
+    size_t n;
+
+    n = produce(self_p, buf_p, size);
+    resume_reader_isr(self_p);
+
+    return (n);
+}
+
+RAM_CODE ssize_t spsc_queue_size(struct spsc_queue_t *self_p)
+{
+    ASSERTN(self_p != NULL, EINVAL);
+
+    return (LOAD(self_p->writepos) - LOAD(self_p->readpos));
+}
+
+ssize_t spsc_queue_unused_size(struct spsc_queue_t *self_p)
+{
+    ASSERTN(self_p != NULL, EINVAL);
+
+    return (self_p->mask + 1 - spsc_queue_size(self_p));
+}
@@ -0,0 +1,127 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2014-2018, Erik Moqvist
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use, copy,
+ * modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ * This file is part of the Simba project.
+ */
+
+#ifndef __SYNC_SPSC_QUEUE_H__
+#define __SYNC_SPSC_QUEUE_H__
+
+#include "simba.h"
+
+/**
+ * Single producer, single consumer queue. The producer and the
+ * consumer only synchronize through the read and write indices, so
+ * no lock is taken when data is available to the consumer or room
+ * is available to the producer. The system lock is only taken to
+ * suspend and resume the consumer.
+ */
+struct spsc_queue_t {
+    struct chan_t base;
+    char *buf_p;
+    size_t mask;
+    /* Written by the producer only. */
+    size_t writepos;
+    /* Written by the consumer only. */
+    size_t readpos;
+};
+
+/**
+ * Initialize given queue.
+ *
+ * @param[in] self_p Queue to initialize.
+ * @param[in] buf_p Buffer.
+ * @param[in] size Size of buffer. Must be a power of two.
+ *
+ * @return zero(0) or negative error code.
+ */
+int spsc_queue_init(struct spsc_queue_t *self_p,
+                    void *buf_p,
+                    size_t size);
+
+/**
+ * Read from given queue. Blocks until `size` bytes has been read.
+ * Only one thread may read from the queue.
+ *
+ * @param[in] self_p Queue to read from.
+ * @param[in] buf_p Buffer to read to.
+ * @param[in] size Size to read.
+ *
+ * @return Number of read bytes or negative error code.
+ */
+ssize_t spsc_queue_read(struct spsc_queue_t *self_p,
+                        void *buf_p,
+                        size_t size);
+
+/**
+ * Write bytes to given queue from a thread. Never blocks. Only one
+ * thread or interrupt service routine may write to the queue.
+ *
+ * @param[in] self_p Queue to write to.
+ * @param[in] buf_p Buffer to write from.
+ * @param[in] size Number of bytes to write.
+ *
+ * @return Number of written bytes, less than `size` if the queue
+ *         is full, or negative error code.
+ */
+ssize_t spsc_queue_write(struct spsc_queue_t *self_p,
+                         const void *buf_p,
+                         size_t size);
+
+/**
+ * Write bytes to given queue from an interrupt service routine, or
+ * with the system lock taken. Only one thread or interrupt service
+ * routine may write to the queue.
+ *
+ * @param[in] self_p Queue to write to.
+ * @param[in] buf_p Buffer to write from.
+ * @param[in] size Number of bytes to write.
+ *
+ * @return Number of written bytes, less than `size` if the queue
+ *         is full, or negative error code.
+ */
+ssize_t spsc_queue_write_isr(struct spsc_queue_t *self_p,
+                             const void *buf_p,
+                             size_t size);
+
+/**
+ * Get the number of bytes currently stored in the queue.
+ *
+ * @param[in] self_p Queue.
+ *
+ * @return Number of bytes in the queue.
+ */
+ssize_t spsc_queue_size(struct spsc_queue_t *self_p);
+
+/**
+ * Get the number of unused bytes in the queue.
+ *
+ * @param[in] self_p Queue.
+ *
+ * @return Number of unused bytes in the queue.
+ */
+ssize_t spsc_queue_unused_size(struct spsc_queue_t *self_p);
+
+#endif
@@ -0,0 +1,270 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2014-2018, Erik Moqvist
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use, copy,
+ * modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ * This file is part of the Simba project.
+ */
+
+#include "simba.h"
+
+static struct work_t *pending_pop_isr(struct work_queue_t *self_p)
+{
+    struct work_t *work_p;
+
+    work_p = self_p->pending.head_p;
+
+    if (work_p != NULL) {
+        self_p->pending.head_p = work_p->next_p;
+
+        if (self_p->pending.head_p == NULL) {
+            self_p->pending.tail_p = NULL;
+        }
+
+        work_p->state = WORK_STATE_IDLE;
+    }
+
+    return (work_p);
+}
+
+static void pending_remove_isr(struct work_queue_t *self_p,
+                               struct work_t *work_p)
+{
+    struct work_t *curr_p;
+    struct work_t *prev_p;
+
+    curr_p = self_p->pending.head_p;
+    prev_p = NULL;
+
+    while (curr_p != NULL) {
+        if (curr_p == work_p) {
+            if (prev_p != NULL) {
+                prev_p->next_p = curr_p->next_p;
+            } else {
+                self_p->pending.head_p = curr_p->next_p;
+            }
+
+            if (self_p->pending.tail_p == curr_p) {
+                self_p->pending.tail_p = prev_p;
+            }
+
+            return;
+        }
+
+        prev_p = curr_p;
+        curr_p = curr_p->next_p;
+    }
+}
+
+static void push_isr(struct work_queue_t *self_p,
+                     struct work_t *work_p)
+{
+    struct thrd_prio_list_elem_t *elem_p;
+
+    work_p->state = WORK_STATE_PENDING;
+    work_p->queue_p = self_p;
+    work_p->next_p = NULL;
+
+    if (self_p->pending.tail_p != NULL) {
+        self_p->pending.tail_p->next_p = work_p;
+    } else {
+        self_p->pending.head_p = work_p;
+    }
+
+    self_p->pending.tail_p = work_p;
+
+    /* Resume an idle worker, if any. */
+    elem_p = thrd_prio_list_pop_isr(&self_p->idle);
+
+    if (elem_p != NULL) {
+        thrd_resume_isr(elem_p->thrd_p, 0);
+    }
+}
+
+static void on_delay_expired(void *arg_p)
+{
+    struct work_t *work_p;
+
+    work_p = arg_p;
+
+    if (work_p->state == WORK_STATE_DELAYED) {
+        push_isr(work_p->queue_p, work_p);
+    }
+}
+
+static void *worker_main(void *arg_p)
+{
+    struct work_queue_t *self_p;
+    struct work_t *work_p;
+    struct thrd_prio_list_elem_t elem;
+
+    self_p = arg_p;
+    elem.thrd_p = thrd_self();
+
+    while (1) {
+        sys_lock();
+
+        while ((work_p = pending_pop_isr(self_p)) == NULL) {
+            thrd_prio_list_push_isr(&self_p->idle, &elem);
+            thrd_suspend_isr(NULL);
+        }
+
+        sys_unlock();
+
+        work_p->func(work_p->arg_p);
+    }
+
+    return (NULL);
+}
+
+int work_init(struct work_t *self_p,
+              work_fn_t func,
+              void *arg_p)
+{
+    ASSERTN(self_p != NULL, EINVAL);
+    ASSERTN(func != NULL, EINVAL);
+
+    self_p->func = func;
+    self_p->arg_p = arg_p;
+    self_p->state = WORK_STATE_IDLE;
+    self_p->queue_p = NULL;
+    self_p->next_p = NULL;
+
+    return (0);
+}
+
+int work_queue_init(struct work_queue_t *self_p,
+                    int prio,
+                    void *stacks_p,
+                    size_t stack_size,
+                    int number_of_workers)
+{
+    ASSERTN(self_p != NULL, EINVAL);
+    ASSERTN(stacks_p != NULL, EINVAL);
+    ASSERTN(number_of_workers > 0, EINVAL);
+
+    int i;
+
+    self_p->pending.head_p = NULL;
+    self_p->pending.tail_p = NULL;
+    thrd_prio_list_init(&self_p->idle);
+
+    for (i = 0; i < number_of_workers; i++) {
+        if (thrd_spawn(worker_main,
+                       self_p,
+                       prio,
+                       (char *)stacks_p + i * stack_size,
+                       stack_size) == NULL) {
+            return (-ENOMEM);
+        }
+    }
+
+    return (0);
+}
+
+int work_queue_submit(struct work_queue_t *self_p,
+                      struct work_t *work_p)
+{
+    ASSERTN(self_p != NULL, EINVAL);
+    ASSERTN(work_p != NULL, EINVAL);
+
+    int res;
+
+    sys_lock();
+    res = work_queue_submit_isr(self_p, work_p);
+    sys_unlock();
+
+    return (res);
+}
+
+int work_queue_submit_isr(struct work_queue_t *self_p,
+                          struct work_t *work_p)
+{
+    if (work_p->state != WORK_STATE_IDLE) {
+        return (-EBUSY);
+    }
+
+    push_isr(self_p, work_p);
+
+    return (0);
+}
+
+int work_queue_submit_delayed(struct work_queue_t *self_p,
+                              struct work_t *work_p,
+                              const struct time_t *delay_p)
+{
+    ASSERTN(self_p != NULL, EINVAL);
+    ASSERTN(work_p != NULL, EINVAL);
+    ASSERTN(delay_p != NULL, EINVAL);
+
+    int res;
+
+    res = 0;
+
+    sys_lock();
+
+    if (work_p->state == WORK_STATE_IDLE) {
+        work_p->state = WORK_STATE_DELAYED;
+        work_p->queue_p = self_p;
+        timer_init(&work_p->timer, delay_p, on_delay_expired, work_p, 0);
+        timer_start_isr(&work_p->timer);
+    } else {
+        res = -EBUSY;
+    }
+
+    sys_unlock();
+
+    return (res);
+}
+
+int work_cancel(struct work_t *work_p)
+{
+    ASSERTN(work_p != NULL, EINVAL);
+
+    int res;
+
+    res = 0;
+
+    sys_lock();
+
+    switch (work_p->state) {
+
+    case WORK_STATE_DELAYED:
+        timer_stop_isr(&work_p->timer);
+        break;
+
+    case WORK_STATE_PENDING:
+        pending_remove_isr(work_p->queue_p, work_p);
+        break;
+
+    default:
+        res = -ENOENT;
+        break;
+    }
+
+    work_p->state = WORK_STATE_IDLE;
+
+    sys_unlock();
+
+    return (res);
+}
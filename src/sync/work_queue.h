@@ -0,0 +1,148 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2014-2018, Erik Moqvist
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use, copy,
+ * modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ * This file is part of the Simba project.
+ */
+
+#ifndef __SYNC_WORK_QUEUE_H__
+#define __SYNC_WORK_QUEUE_H__
+
+#include "simba.h"
+
+typedef void (*work_fn_t)(void *arg_p);
+
+/** The work item is not queued. */
+#define WORK_STATE_IDLE                                     0
+/** The work item is waiting for its delay to expire. */
+#define WORK_STATE_DELAYED                                  1
+/** The work item is queued and waiting for a worker thread. */
+#define WORK_STATE_PENDING                                  2
+
+/* A work item. */
+struct work_t {
+    work_fn_t func;
+    void *arg_p;
+    int state;
+    struct work_queue_t *queue_p;
+    struct timer_t timer;
+    struct work_t *next_p;
+};
+
+/* Work queue. */
+struct work_queue_t {
+    struct {
+        struct work_t *head_p;
+        struct work_t *tail_p;
+    } pending;
+    struct thrd_prio_list_t idle;
+};
+
+/**
+ * Initialize given work item. A work item may be submitted to a work
+ * queue again once the worker thread has started executing it.
+ *
+ * @param[in] self_p Work item to initialize.
+ * @param[in] func Function to call in a worker thread.
+ * @param[in] arg_p Argument passed to ``func``.
+ *
+ * @return zero(0) or negative error code.
+ */
+int work_init(struct work_t *self_p,
+              work_fn_t func,
+              void *arg_p);
+
+/**
+ * Initialize given work queue and spawn its worker threads. All
+ * worker threads share the work queue, and run with given priority.
+ *
+ * @param[in] self_p Work queue to initialize.
+ * @param[in] prio Worker threads priority.
+ * @param[in] stacks_p An array of ``number_of_workers`` thread
+ *                     stacks, declared with ``THRD_STACK()``.
+ * @param[in] stack_size Size of each thread stack in ``stacks_p``.
+ * @param[in] number_of_workers Number of worker threads to spawn.
+ *
+ * @return zero(0) or negative error code.
+ */
+int work_queue_init(struct work_queue_t *self_p,
+                    int prio,
+                    void *stacks_p,
+                    size_t stack_size,
+                    int number_of_workers);
+
+/**
+ * Submit given work item to given work queue. The work item is
+ * executed by the first available worker thread, in submission
+ * order.
+ *
+ * @param[in] self_p Work queue to submit to.
+ * @param[in] work_p Work item to submit.
+ *
+ * @return zero(0), -EBUSY if the work item is already submitted, or
+ *         other negative error code.
+ */
+int work_queue_submit(struct work_queue_t *self_p,
+                      struct work_t *work_p);
+
+/**
+ * Submit given work item to given work queue from isr or with the
+ * system lock taken. Never blocks or allocates memory.
+ *
+ * @param[in] self_p Work queue to submit to.
+ * @param[in] work_p Work item to submit.
+ *
+ * @return zero(0), -EBUSY if the work item is already submitted, or
+ *         other negative error code.
+ */
+int work_queue_submit_isr(struct work_queue_t *self_p,
+                          struct work_t *work_p);
+
+/**
+ * Submit given work item to given work queue when given delay has
+ * expired. The delay is implemented with a timer in the work item.
+ *
+ * @param[in] self_p Work queue to submit to.
+ * @param[in] work_p Work item to submit.
+ * @param[in] delay_p Delay before the work item is submitted.
+ *
+ * @return zero(0), -EBUSY if the work item is already submitted, or
+ *         other negative error code.
+ */
+int work_queue_submit_delayed(struct work_queue_t *self_p,
+                              struct work_t *work_p,
+                              const struct time_t *delay_p);
+
+/**
+ * Cancel given submitted or delayed work item. A work item that a
+ * worker thread already started executing can not be cancelled.
+ *
+ * @param[in] work_p Work item to cancel.
+ *
+ * @return zero(0), -ENOENT if the work item is not submitted, or
+ *         other negative error code.
+ */
+int work_cancel(struct work_t *work_p);
+
+#endif
@@ -28,6 +28,139 @@
 
 #include "simba.h"
 
+#define FNV_OFFSET_BASIS                                  2166136261UL
+#define FNV_PRIME                                             16777619UL
+
+/**
+ * Sequential reader of the configuration file contents, from the
+ * buffer or from the file.
+ */
+struct reader_t {
+    struct configfile_t *configfile_p;
+    /* Offset of the next character. */
+    size_t offset;
+    char buf[32];
+    size_t pos;
+    size_t size;
+};
+
+static uint32_t hash_update(uint32_t hash, int c)
+{
+    return ((hash ^ (uint8_t)c) * FNV_PRIME);
+}
+
+static uint32_t hash_string(uint32_t hash, const char *str_p)
+{
+    while (*str_p != '\0') {
+        hash = hash_update(hash, *str_p++);
+    }
+
+    return (hash);
+}
+
+static uint32_t hash_property(const char *section_p,
+                              const char *property_p)
+{
+    uint32_t hash;
+
+    hash = hash_string(FNV_OFFSET_BASIS, section_p);
+    hash = hash_update(hash, ']');
+
+    return (hash_string(hash, property_p));
+}
+
+static int reader_init(struct reader_t *self_p,
+                       struct configfile_t *configfile_p,
+                       size_t offset)
+{
+    self_p->configfile_p = configfile_p;
+    self_p->offset = offset;
+    self_p->pos = 0;
+    self_p->size = 0;
+
+    if (configfile_p->file_p != NULL) {
+        return (fs_seek(configfile_p->file_p, offset, FS_SEEK_SET));
+    }
+
+    return (0);
+}
+
+/**
+ * Returns the next character, or -1 at the end of the contents.
+ */
+static int reader_getc(struct reader_t *self_p)
+{
+    struct configfile_t *configfile_p;
+    ssize_t size;
+    int c;
+
+    configfile_p = self_p->configfile_p;
+
+    if (configfile_p->file_p == NULL) {
+        if (self_p->offset >= configfile_p->size) {
+            return (-1);
+        }
+
+        c = (uint8_t)configfile_p->buf_p[self_p->offset];
+    } else {
+        if (self_p->pos == self_p->size) {
+            size = fs_read(configfile_p->file_p,
+                           &self_p->buf[0],
+                           sizeof(self_p->buf));
+
+            if (size <= 0) {
+                return (-1);
+            }
+
+            self_p->pos = 0;
+            self_p->size = size;
+        }
+
+        c = (uint8_t)self_p->buf[self_p->pos];
+        self_p->pos++;
+    }
+
+    if (c == '\0') {
+        return (-1);
+    }
+
+    self_p->offset++;
+
+    return (c);
+}
+
+/**
+ * Returns the first character on next line, or -1.
+ */
+static int reader_skip_line(struct reader_t *self_p, int c)
+{
+    while ((c != '\n') && (c != -1)) {
+        c = reader_getc(self_p);
+    }
+
+    if (c == -1) {
+        return (-1);
+    }
+
+    return (reader_getc(self_p));
+}
+
+static int is_section_name_end(int c)
+{
+    return ((c == ']') || (c == '\n') || (c == -1));
+}
+
+static int is_property_name_end(int c)
+{
+    return ((c == ' ')
+            || (c == '\t')
+            || (c == ':')
+            || (c == '=')
+            || (c == '\r')
+            || (c == '\n')
+            || (c == -1));
+}
+
 /**
  * Ignore one line.
  */
@@ -162,6 +295,192 @@ static char *parse_property(char *buf_p,
     return (std_strip(value_p, NULL));
 }
 
+/**
+ * Returns true(1) if the name at given offset is given name.
+ */
+static int is_name_at(struct configfile_t *self_p,
+                      size_t offset,
+                      const char *name_p,
+                      int is_section)
+{
+    struct reader_t reader;
+    int c;
+
+    if (reader_init(&reader, self_p, offset) != 0) {
+        return (0);
+    }
+
+    while (1) {
+        c = reader_getc(&reader);
+
+        if (is_section == 1) {
+            /* Carriage returns are not part of section names. */
+            if (c == '\r') {
+                continue;
+            }
+
+            if (is_section_name_end(c)) {
+                return (*name_p == '\0');
+            }
+        } else if (is_property_name_end(c)) {
+            return (*name_p == '\0');
+        }
+
+        if (*name_p != c) {
+            return (0);
+        }
+
+        name_p++;
+    }
+}
+
+/**
+ * Read the value of the property at given offset. Same format as in
+ * parse_property().
+ */
+static char *read_property_value(struct configfile_t *self_p,
+                                 size_t offset,
+                                 char *value_p,
+                                 int length)
+{
+    struct reader_t reader;
+    int value_length;
+    int c;
+
+    if (reader_init(&reader, self_p, offset) != 0) {
+        return (NULL);
+    }
+
+    value_length = 0;
+
+    /* Ignore whitespaces before ':'. */
+    do {
+        c = reader_getc(&reader);
+    } while ((c == ' ') || (c == '\t'));
+
+    if ((c != ':') && (c != '=')) {
+        /* Malformed property entry. */
+        return (NULL);
+    }
+
+    /* Ignore whitespaces after ':'. */
+    do {
+        c = reader_getc(&reader);
+    } while ((c == ' ') || (c == '\t'));
+
+    while (c != '\n') {
+        if (c == -1) {
+            return (NULL);
+        }
+
+        /* Ignore any carriage return. */
+        if (c != '\r') {
+            if (value_length == (length - 1)) {
+                return (NULL);
+            }
+
+            value_p[value_length] = c;
+            value_length++;
+        }
+
+        c = reader_getc(&reader);
+    }
+
+    value_p[value_length] = '\0';
+
+    return (std_strip(value_p, NULL));
+}
+
+static int compare_entries(const struct configfile_index_entry_t *left_p,
+                           const struct configfile_index_entry_t *right_p)
+{
+    if (left_p->hash != right_p->hash) {
+        return (left_p->hash > right_p->hash);
+    }
+
+    return (left_p->property_offset > right_p->property_offset);
+}
+
+/**
+ * Shell sort the index entries. Does not use the stack for recursion
+ * and is fast enough for the number of properties in a configuration
+ * file.
+ */
+static void sort_entries(struct configfile_index_entry_t *entries_p,
+                         int length)
+{
+    struct configfile_index_entry_t entry;
+    int gap;
+    int i;
+    int j;
+
+    for (gap = length / 2; gap > 0; gap /= 2) {
+        for (i = gap; i < length; i++) {
+            entry = entries_p[i];
+
+            for (j = i;
+                 (j >= gap) && compare_entries(&entries_p[j - gap], &entry);
+                 j -= gap) {
+                entries_p[j] = entries_p[j - gap];
+            }
+
+            entries_p[j] = entry;
+        }
+    }
+}
+
+static char *get_indexed(struct configfile_t *self_p,
+                         const char *section_p,
+                         const char *property_p,
+                         char *value_p,
+                         int length)
+{
+    struct configfile_index_entry_t *entries_p;
+    uint32_t hash;
+    int low;
+    int high;
+    int middle;
+
+    entries_p = self_p->index.entries_p;
+    hash = hash_property(section_p, property_p);
+
+    /* Find the first entry with given hash. */
+    low = 0;
+    high = self_p->index.length;
+
+    while (low < high) {
+        middle = (low + (high - low) / 2);
+
+        if (entries_p[middle].hash < hash) {
+            low = middle + 1;
+        } else {
+            high = middle;
+        }
+    }
+
+    /* The first entry with matching names, in file order. */
+    while ((low < self_p->index.length) && (entries_p[low].hash == hash)) {
+        if (is_name_at(self_p,
+                       entries_p[low].section_offset,
+                       section_p,
+                       1)
+            && is_name_at(self_p,
+                          entries_p[low].property_offset,
+                          property_p,
+                          0)) {
+            return (read_property_value(self_p,
+                                        (entries_p[low].property_offset
+                                         + strlen(property_p)),
+                                        value_p,
+                                        length));
+        }
+
+        low++;
+    }
+
+    return (NULL);
+}
+
 int configfile_init(struct configfile_t *self_p,
                     char *buf_p,
                     size_t size)
@@ -172,10 +491,122 @@ int configfile_init(struct configfile_t *self_p,
 
     self_p->buf_p = buf_p;
     self_p->size = size;
+    self_p->file_p = NULL;
+    self_p->index.entries_p = NULL;
+    self_p->index.length = 0;
+
+    return (0);
+}
+
+int configfile_init_file(struct configfile_t *self_p,
+                         struct fs_file_t *file_p)
+{
+    ASSERTN(self_p != NULL, EINVAL);
+    ASSERTN(file_p != NULL, EINVAL);
+
+    self_p->buf_p = NULL;
+    self_p->size = 0;
+    self_p->file_p = file_p;
+    self_p->index.entries_p = NULL;
+    self_p->index.length = 0;
 
     return (0);
 }
 
+int configfile_index(struct configfile_t *self_p,
+                     struct configfile_index_entry_t *entries_p,
+                     int length)
+{
+    ASSERTN(self_p != NULL, EINVAL);
+    ASSERTN(entries_p != NULL, EINVAL);
+    ASSERTN(length >= 0, EINVAL);
+
+    struct reader_t reader;
+    struct configfile_index_entry_t *entry_p;
+    int res;
+    int c;
+    int number_of_entries;
+    int in_section;
+    uint32_t section_offset;
+    uint32_t section_hash;
+    uint32_t property_offset;
+    int property_length;
+    uint32_t hash;
+
+    self_p->index.entries_p = NULL;
+    self_p->index.length = 0;
+
+    res = reader_init(&reader, self_p, 0);
+
+    if (res != 0) {
+        return (res);
+    }
+
+    number_of_entries = 0;
+    in_section = 0;
+    section_offset = 0;
+    section_hash = 0;
+    c = reader_getc(&reader);
+
+    while (c != -1) {
+        if ((c == '\r') || (c == '\n')) {
+            /* A line may start with "\r", or be empty. */
+            c = reader_getc(&reader);
+        } else if ((c == '#') || (c == ';')) {
+            c = reader_skip_line(&reader, c);
+        } else if (c == '[') {
+            section_offset = reader.offset;
+            hash = FNV_OFFSET_BASIS;
+            c = reader_getc(&reader);
+
+            while (!is_section_name_end(c)) {
+                /* Ignore any carriage return. */
+                if (c != '\r') {
+                    hash = hash_update(hash, c);
+                }
+
+                c = reader_getc(&reader);
+            }
+
+            section_hash = hash_update(hash, ']');
+            in_section = 1;
+            c = reader_skip_line(&reader, c);
+        } else {
+            property_offset = (reader.offset - 1);
+            property_length = 0;
+            hash = section_hash;
+
+            while (!is_property_name_end(c)) {
+                hash = hash_update(hash, c);
+                property_length++;
+                c = reader_getc(&reader);
+            }
+
+            /* Properties outside sections and lines starting with
+               whitespace are ignored. */
+            if ((in_section == 1) && (property_length > 0)) {
+                if (number_of_entries == length) {
+                    return (-ENOMEM);
+                }
+
+                entry_p = &entries_p[number_of_entries];
+                entry_p->hash = hash;
+                entry_p->section_offset = section_offset;
+                entry_p->property_offset = property_offset;
+                number_of_entries++;
+            }
+
+            c = reader_skip_line(&reader, c);
+        }
+    }
+
+    sort_entries(entries_p, number_of_entries);
+    self_p->index.entries_p = entries_p;
+    self_p->index.length = number_of_entries;
+
+    return (number_of_entries);
+}
+
 int configfile_set(struct configfile_t *self_p,
                    const char *section_p,
                    const char *property_p,
@@ -201,6 +632,15 @@ char *configfile_get(struct configfile_t *self_p,
     int property_length;
     char *buf_p;
 
+    if (self_p->index.entries_p != NULL) {
+        return (get_indexed(self_p, section_p, property_p, value_p, length));
+    }
+
+    /* The file is only read using the index. */
+    if (self_p->file_p != NULL) {
+        return (NULL);
+    }
+
     in_correct_section = 0;
     buf_p = self_p->buf_p;
     section_length = strlen(section_p);
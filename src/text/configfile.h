@@ -31,9 +31,26 @@
 
 #include "simba.h"
 
+/**
+ * An index entry of a property. Entries are sorted by hash, and then
+ * by property offset.
+ */
+struct configfile_index_entry_t {
+    /* FNV-1a hash of the section name, ']' and the property name. */
+    uint32_t hash;
+    /* Offsets of the section and property names in the file. */
+    uint32_t section_offset;
+    uint32_t property_offset;
+};
+
 struct configfile_t {
     char *buf_p;
     size_t size;
+    struct fs_file_t *file_p;
+    struct {
+        struct configfile_index_entry_t *entries_p;
+        int length;
+    } index;
 };
 
 /**
@@ -50,6 +67,42 @@ int configfile_init(struct configfile_t *self_p,
                     char *buf_p,
                     size_t size);
 
+/**
+ * Initialize given configuration file object to read the
+ * configuration from given opened file instead of from a buffer in
+ * RAM. The file contents are read in small chunks when needed, and
+ * only the index created by `configfile_index()` is kept in RAM. The
+ * index must be created before any property can be read.
+ *
+ * @param[in,out] self_p Object to initialize.
+ * @param[in] file_p File opened for reading. It must be kept open
+ *                   while the object is used.
+ *
+ * @return zero(0) or negative error code.
+ */
+int configfile_init_file(struct configfile_t *self_p,
+                         struct fs_file_t *file_p);
+
+/**
+ * Parse the configuration file once and create an index of all its
+ * properties in given array of entries. Properties are then found
+ * with a binary search in the index instead of searching the whole
+ * configuration file for each property. The index is invalid if the
+ * configuration file is modified.
+ *
+ * @param[in] self_p Initialized parser.
+ * @param[out] entries_p Array to store the index in. It must be kept
+ *                       valid while the object is used.
+ * @param[in] length Length of the entries array.
+ *
+ * @return Number of indexed properties, -ENOMEM if the configuration
+ *         file has more than length properties, or other negative
+ *         error code.
+ */
+int configfile_index(struct configfile_t *self_p,
+                     struct configfile_index_entry_t *entries_p,
+                     int length);
+
 /**
  * Set the value of given property in given section.
  *
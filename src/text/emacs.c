@@ -30,21 +30,113 @@
 
 #include "atto.h"
 
+/* Output channel buffering the terminal output of the editor. */
+struct output_t {
+    struct chan_t base;
+    void *chout_p;
+    size_t size;
+    char buf[CONFIG_EMACS_OUTPUT_BUFFER_SIZE];
+};
+
+/* Input channel flushing the buffered output before reading. */
+struct input_t {
+    struct chan_t base;
+    void *chin_p;
+    struct output_t *output_p;
+};
+
+static void output_flush(struct output_t *self_p)
+{
+    if (self_p->size > 0) {
+        chan_write(self_p->chout_p, &self_p->buf[0], self_p->size);
+        self_p->size = 0;
+    }
+}
+
+static ssize_t output_write(void *base_p, const void *buf_p, size_t size)
+{
+    struct output_t *self_p;
+    size_t n;
+    size_t left;
+    const char *c_buf_p;
+
+    self_p = base_p;
+    c_buf_p = buf_p;
+    left = size;
+
+    while (left > 0) {
+        if (self_p->size == sizeof(self_p->buf)) {
+            output_flush(self_p);
+        }
+
+        n = MIN(left, sizeof(self_p->buf) - self_p->size);
+        memcpy(&self_p->buf[self_p->size], c_buf_p, n);
+        self_p->size += n;
+        c_buf_p += n;
+        left -= n;
+    }
+
+    return (size);
+}
+
+static ssize_t input_read(void *base_p, void *buf_p, size_t size)
+{
+    struct input_t *self_p;
+
+    self_p = base_p;
+
+    /* The screen is redisplayed before the editor waits for the next
+       key, so the whole update is written at once. */
+    output_flush(self_p->output_p);
+
+    return (chan_read(self_p->chin_p, buf_p, size));
+}
+
+static size_t input_size(void *base_p)
+{
+    struct input_t *self_p;
+
+    self_p = base_p;
+
+    return (chan_size(self_p->chin_p));
+}
+
 int emacs(const char *path_p, void *chin_p, void *chout_p)
 {
     ASSERTN(chin_p != NULL, EINVAL);
     ASSERTN(chout_p != NULL, EINVAL);
 
     const char *args[2];
+    struct output_t output;
+    struct input_t input;
+    int res;
 
     args[1] = path_p;
 
-    atto_curses_set_input_channel(chin_p);
-    atto_curses_set_output_channel(chout_p);
+    output.chout_p = chout_p;
+    output.size = 0;
+    chan_init(&output.base,
+              chan_read_null,
+              output_write,
+              chan_size_null);
+
+    input.chin_p = chin_p;
+    input.output_p = &output;
+    chan_init(&input.base,
+              input_read,
+              chan_write_null,
+              input_size);
+
+    atto_curses_set_input_channel(&input);
+    atto_curses_set_output_channel(&output);
 
     if (path_p != NULL) {
-        return (atto_main(2, (char **)args));
+        res = atto_main(2, (char **)args);
     } else {
-        return (atto_main(1, NULL));
+        res = atto_main(1, NULL);
     }
+
+    output_flush(&output);
+
+    return (res);
 }
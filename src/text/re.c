@@ -1188,3 +1188,41 @@ ssize_t re_match(const char *compiled_p,
 
     return (match(&state));
 }
+
+ssize_t re_dfa_match(FAR const struct re_dfa_t *dfa_p,
+                     const char *buf_p,
+                     size_t size)
+{
+    ASSERTN(dfa_p != NULL, EINVAL);
+    ASSERTN((buf_p != NULL) || (size == 0), EINVAL);
+
+    ssize_t matched_size;
+    size_t i;
+    int state;
+
+    state = 1;
+    matched_size = -1;
+
+    if (dfa_p->accepting_p[0] != 0) {
+        matched_size = 0;
+    }
+
+    /* Once a state is accepting, only higher priority threads are
+       left, so a later accepting state overrides the earlier
+       match. */
+    for (i = 0; i < size; i++) {
+        state = dfa_p->transitions_p[(size_t)(state - 1)
+                                     * dfa_p->number_of_classes
+                                     + dfa_p->classes_p[(uint8_t)buf_p[i]]];
+
+        if (state == 0) {
+            break;
+        }
+
+        if (dfa_p->accepting_p[state - 1] != 0) {
+            matched_size = (i + 1);
+        }
+    }
+
+    return (matched_size);
+}
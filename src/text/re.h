@@ -61,6 +61,23 @@ struct re_group_t {
     ssize_t size;
 };
 
+/**
+ * A regular expression compiled to a deterministic finite automaton
+ * at build time by ``bin/re_dfa.py``. State zero(0) is the dead state
+ * and state one(1) the start state.
+ */
+struct re_dfa_t {
+    /* Character class of each byte. */
+    FAR const uint8_t *classes_p;
+    /* Next state indexed by current state, starting at state one(1),
+       and character class. */
+    FAR const uint8_t *transitions_p;
+    /* Non-zero if the pattern has matched in given state, starting at
+       state one(1).*/
+    FAR const uint8_t *accepting_p;
+    uint16_t number_of_classes;
+};
+
 /**
  * Initialize the re module. This function must be called before
  * calling any other function in this module.
@@ -127,4 +144,22 @@ ssize_t re_match(const char *compiled_p,
                  struct re_group_t *groups_p,
                  size_t *number_of_groups_p);
 
+/**
+ * Apply given precompiled regular expression to the beginning of
+ * given string. The result is the same as re_match() for the same
+ * pattern, but the time is linear in the input size and no stack or
+ * heap memory is needed, making it suitable for untrusted input.
+ *
+ * Generate the automaton with ``bin/re_dfa.py``.
+ *
+ * @param[in] dfa_p Precompiled regular expression.
+ * @param[in] buf_p Buffer to apply the regular expression to.
+ * @param[in] size Number of bytes in the buffer.
+ *
+ * @return Number of matched bytes or negative error code.
+ */
+ssize_t re_dfa_match(FAR const struct re_dfa_t *dfa_p,
+                     const char *buf_p,
+                     size_t size);
+
 #endif
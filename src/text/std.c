@@ -32,7 +32,11 @@
 #include <math.h>
 
 /* +7 for floating point decimal point and fraction. */
-#define VALUE_BUF_MAX (3 * sizeof(long) + 7)
+#if CONFIG_STD_PRINTF_LONG_LONG == 1
+#    define VALUE_BUF_MAX (3 * sizeof(long long) + 7)
+#else
+#    define VALUE_BUF_MAX (3 * sizeof(long) + 7)
+#endif
 
 struct buffered_output_t {
     void *chan_p;
@@ -65,44 +69,56 @@ static int char_in_string(char c, const char *str_p)
 }
 
 /**
- * Put characters to buffer.
+ * Write characters to buffer.
  */
-static void sprintf_putc(char c, void *arg_p)
+static void sprintf_write(const char *buf_p, size_t size, void *arg_p)
 {
     char **dst_pp = arg_p;
 
-    *(*dst_pp)++ = c;
+    memcpy(*dst_pp, buf_p, size);
+    *dst_pp += size;
 }
 
 /**
- * Put characters to buffer.
+ * Write characters to buffer.
  */
-static void snprintf_putc(char c, void *arg_p)
+static void snprintf_write(const char *buf_p, size_t size, void *arg_p)
 {
     struct snprintf_output_t *output_p;
+    size_t left;
 
     output_p = arg_p;
 
     if (output_p->size < output_p->size_max) {
-        output_p->dst_p[output_p->size] = c;
+        left = (output_p->size_max - output_p->size);
+        memcpy(&output_p->dst_p[output_p->size], buf_p, MIN(size, left));
     }
 
-    output_p->size++;
+    output_p->size += size;
 }
 
 /**
- * Put characters to standard output.
+ * Write characters to standard output. The channel is only written to
+ * when the output buffer is full.
  */
-static void fprintf_putc(char c, void *arg_p)
+static void fprintf_write(const char *buf_p, size_t size, void *arg_p)
 {
     struct buffered_output_t *output_p = arg_p;
+    size_t chunk_size;
 
-    output_p->buffer[output_p->pos++] = c;
-    output_p->size++;
+    output_p->size += size;
 
-    if (output_p->pos == membersof(output_p->buffer)) {
-        chan_write(output_p->chan_p, output_p->buffer, output_p->pos);
-        output_p->pos = 0;
+    while (size > 0) {
+        chunk_size = MIN(size, membersof(output_p->buffer) - output_p->pos);
+        memcpy(&output_p->buffer[output_p->pos], buf_p, chunk_size);
+        output_p->pos += chunk_size;
+        buf_p += chunk_size;
+        size -= chunk_size;
+
+        if (output_p->pos == membersof(output_p->buffer)) {
+            chan_write(output_p->chan_p, output_p->buffer, output_p->pos);
+            output_p->pos = 0;
+        }
     }
 }
 
@@ -118,19 +134,29 @@ static void output_flush(struct buffered_output_t *output_p)
 }
 
 /**
- * Put characters to standard output from interrupt context or with
+ * Write characters to standard output from interrupt context or with
  * the system lock taken.
  */
-static void fprintf_putc_isr(char c, void *arg_p)
+static void fprintf_write_isr(const char *buf_p, size_t size, void *arg_p)
 {
     struct buffered_output_t *output_p = arg_p;
+    size_t chunk_size;
 
-    output_p->buffer[output_p->pos++] = c;
-    output_p->size++;
+    output_p->size += size;
 
-    if (output_p->pos == membersof(output_p->buffer)) {
-        chan_write_isr(output_p->chan_p, output_p->buffer, output_p->pos);
-        output_p->pos = 0;
+    while (size > 0) {
+        chunk_size = MIN(size, membersof(output_p->buffer) - output_p->pos);
+        memcpy(&output_p->buffer[output_p->pos], buf_p, chunk_size);
+        output_p->pos += chunk_size;
+        buf_p += chunk_size;
+        size -= chunk_size;
+
+        if (output_p->pos == membersof(output_p->buffer)) {
+            chan_write_isr(output_p->chan_p,
+                           output_p->buffer,
+                           output_p->pos);
+            output_p->pos = 0;
+        }
     }
 }
 
@@ -145,63 +171,217 @@ static void output_flush_isr(struct buffered_output_t *output_p)
     }
 }
 
-static void formats(void (*std_putc)(char c, void *arg_p),
+/**
+ * Write given character given number of times.
+ */
+static void pad(void (*std_write)(const char *buf_p,
+                                  size_t size,
+                                  void *arg_p),
+                void *arg_p,
+                char c,
+                int width)
+{
+    char buf[8];
+    int size;
+
+    if (width <= 0) {
+        return;
+    }
+
+    memset(&buf[0], c, MIN(width, sizeof(buf)));
+
+    while (width > 0) {
+        size = MIN(width, sizeof(buf));
+        std_write(&buf[0], size, arg_p);
+        width -= size;
+    }
+}
+
+static void formats(void (*std_write)(const char *buf_p,
+                                      size_t size,
+                                      void *arg_p),
                     void *arg_p,
-                    char *str_p,
+                    const char *str_p,
                     char flags,
                     int width,
                     char negative_sign)
 {
-    char *s_p = str_p;
+    size_t size;
 
-    while (*s_p++ != '\0') {
-        width--;
-    }
+    size = strlen(str_p);
+    width -= size;
 
-    /* Right justification. */
     if (flags != '-') {
+        /* Right justification. */
         if ((negative_sign == 1) && (flags == '0')) {
-            std_putc(*str_p++, arg_p);
+            std_write(str_p, 1, arg_p);
+            str_p++;
+            size--;
         }
 
-        while (width > 0) {
-            std_putc(flags, arg_p);
-            width--;
+        pad(std_write, arg_p, flags, width);
+        std_write(str_p, size, arg_p);
+    } else {
+        /* Left justification. */
+        std_write(str_p, size, arg_p);
+        pad(std_write, arg_p, ' ', width);
+    }
+}
+
+/**
+ * The two ASCII digits of all numbers from 0 to 99.
+ */
+static FAR const char digit_pairs[] =
+    "00010203040506070809"
+    "10111213141516171819"
+    "20212223242526272829"
+    "30313233343536373839"
+    "40414243444546474849"
+    "50515253545556575859"
+    "60616263646566676869"
+    "70717273747576777879"
+    "80818283848586878889"
+    "90919293949596979899";
+
+static FAR const char hex_digits[] = "0123456789abcdef";
+
+/**
+ * Format given value two decimal digits at a time, ending at given
+ * position. The int version is used for non-long arguments, as int
+ * division is cheaper than long division on many targets.
+ */
+static char *format_decimal_int(char *str_p, unsigned int value)
+{
+    unsigned int i;
+
+    while (value >= 100) {
+        i = (2 * (value % 100));
+        value /= 100;
+        *--str_p = digit_pairs[i + 1];
+        *--str_p = digit_pairs[i];
+    }
+
+    if (value >= 10) {
+        i = (2 * value);
+        *--str_p = digit_pairs[i + 1];
+        *--str_p = digit_pairs[i];
+    } else {
+        *--str_p = ('0' + value);
+    }
+
+    return (str_p);
+}
+
+static char *format_decimal_long(char *str_p, unsigned long value)
+{
+    unsigned int i;
+
+    while (value > UINT_MAX) {
+        i = (2 * (value % 100));
+        value /= 100;
+        *--str_p = digit_pairs[i + 1];
+        *--str_p = digit_pairs[i];
+    }
+
+    return (format_decimal_int(str_p, value));
+}
+
+static char *format_hex(char *str_p, unsigned long value)
+{
+    do {
+        *--str_p = hex_digits[value & 0xf];
+        value >>= 4;
+    } while (value > 0);
+
+    return (str_p);
+}
+
+#if CONFIG_STD_PRINTF_LONG_LONG == 1
+
+static char *format_decimal_long_long(char *str_p, unsigned long long value)
+{
+    unsigned int i;
+
+    while (value > ULONG_MAX) {
+        i = (2 * (value % 100));
+        value /= 100;
+        *--str_p = digit_pairs[i + 1];
+        *--str_p = digit_pairs[i];
+    }
+
+    return (format_decimal_long(str_p, value));
+}
+
+static char *format_hex_long_long(char *str_p, unsigned long long value)
+{
+    do {
+        *--str_p = hex_digits[value & 0xf];
+        value >>= 4;
+    } while (value > 0);
+
+    return (str_p);
+}
+
+static char *formatll(char c,
+                      char *str_p,
+                      va_list *ap_p,
+                      char *negative_sign_p)
+{
+    unsigned long long value;
+    long long signed_value;
+
+    signed_value = va_arg(*ap_p, long long);
+    value = (unsigned long long)signed_value;
+
+    if ((c == 'i') || (c == 'd')) {
+        if (signed_value < 0) {
+            value = (0ULL - value);
+            *negative_sign_p = 1;
         }
     }
 
-    /* Number */
-    while (*str_p != '\0') {
-        std_putc(*str_p++, arg_p);
+    if (c == 'x') {
+        str_p = format_hex_long_long(str_p, value);
+    } else {
+        str_p = format_decimal_long_long(str_p, value);
     }
 
-    /* Left justification. */
-    while (width > 0) {
-        std_putc(' ', arg_p);
-        width--;
+    if (*negative_sign_p == 1) {
+        *--str_p = '-';
     }
+
+    return (str_p);
 }
 
+#endif
+
 static char *formati(char c,
                      char *str_p,
-                     char radix,
                      va_list *ap_p,
                      char length,
                      char *negative_sign_p)
 {
     unsigned long value;
-    char digit;
+    long signed_value;
+
+#if CONFIG_STD_PRINTF_LONG_LONG == 1
+    if (length == 2) {
+        return (formatll(c, str_p, ap_p, negative_sign_p));
+    }
+#endif
 
     /* Get argument. */
     if (length == 0) {
-        value = (unsigned long)va_arg(*ap_p, int);
+        signed_value = va_arg(*ap_p, int);
     } else {
-        value = (unsigned long)va_arg(*ap_p, long);
+        signed_value = va_arg(*ap_p, long);
     }
 
+    value = (unsigned long)signed_value;
+
     if ((c == 'i') || (c == 'd')) {
-        if (value & (1UL << (sizeof(value) * CHAR_BIT - 1))) {
-            value *= -1;
+        if (signed_value < 0) {
+            value = (0UL - value);
             *negative_sign_p = 1;
         }
     }
@@ -211,14 +391,13 @@ static char *formati(char c,
     }
 
     /* Format number into buffer. */
-    do {
-        digit = (char)(value % radix);
-        value /= radix;
-        if (digit > 9) {
-            digit += 39;
-        }
-        *--str_p = ('0' + digit);
-    } while (value > 0);
+    if (c == 'x') {
+        str_p = format_hex(str_p, value);
+    } else if (length == 0) {
+        str_p = format_decimal_int(str_p, value);
+    } else {
+        str_p = format_decimal_long(str_p, value);
+    }
 
     if (*negative_sign_p == 1) {
         *--str_p = '-';
@@ -227,7 +406,7 @@ static char *formati(char c,
     return (str_p);
 }
 
-#if CONFIG_FLOAT == 1
+#if CONFIG_STD_PRINTF_FLOAT == 1
 
 static char *formatf(char c,
                      char *str_p,
@@ -288,7 +467,46 @@ static char *formatf(char c,
 
 #endif
 
-static void vcprintf(void (*std_putc)(char c, void *arg_p),
+/**
+ * Write the text up to the next conversion specification or the end
+ * of the format string.
+ *
+ * @return Format string at the next conversion specification or the
+ *         end.
+ */
+static far_string_t write_text(void (*std_write)(const char *buf_p,
+                                                 size_t size,
+                                                 void *arg_p),
+                               void *arg_p,
+                               far_string_t fmt_p)
+{
+#if defined(FAR_SPECIAL_ADDRESS)
+    char c;
+
+    while (((c = *fmt_p) != '%') && (c != '\0')) {
+        std_write(&c, 1, arg_p);
+        fmt_p++;
+    }
+#else
+    far_string_t text_p;
+
+    text_p = fmt_p;
+
+    while ((*fmt_p != '%') && (*fmt_p != '\0')) {
+        fmt_p++;
+    }
+
+    if (fmt_p > text_p) {
+        std_write(text_p, fmt_p - text_p, arg_p);
+    }
+#endif
+
+    return (fmt_p);
+}
+
+static void vcprintf(void (*std_write)(const char *buf_p,
+                                       size_t size,
+                                       void *arg_p),
                      void *arg_p,
                      far_string_t fmt_p,
                      va_list *ap_p)
@@ -298,10 +516,11 @@ static void vcprintf(void (*std_putc)(char c, void *arg_p),
 
     buf[sizeof(buf) - 1] = '\0';
 
-    while ((c = *fmt_p++) != '\0') {
-        if (c != '%') {
-            std_putc(c, arg_p);
-            continue;
+    while (1) {
+        fmt_p = write_text(std_write, arg_p, fmt_p);
+
+        if (*fmt_p++ == '\0') {
+            break;
         }
 
         /* Prototype: %[flags][width][length]specifier  */
@@ -330,6 +549,13 @@ static void vcprintf(void (*std_putc)(char c, void *arg_p),
         if (c == 'l') {
             length = 1;
             c = *fmt_p++;
+
+#if CONFIG_STD_PRINTF_LONG_LONG == 1
+            if (c == 'l') {
+                length = 2;
+                c = *fmt_p++;
+            }
+#endif
         }
 
         if (c == '\0') {
@@ -357,16 +583,16 @@ static void vcprintf(void (*std_putc)(char c, void *arg_p),
 
                 /* Right justification. */
                 if (flags != '-') {
-                    formats(std_putc, arg_p, s_p, flags, width, negative_sign);
+                    formats(std_write, arg_p, s_p, flags, width, negative_sign);
                 }
 
-                while (*far_string_p != '\0') {
-                    std_putc(*far_string_p++, arg_p);
+                while ((c = *far_string_p++) != '\0') {
+                    std_write(&c, 1, arg_p);
                 }
 
                 /* Left justification. */
                 if (flags == '-') {
-                    formats(std_putc, arg_p, s_p, flags, width, negative_sign);
+                    formats(std_write, arg_p, s_p, flags, width, negative_sign);
                 }
             }
 
@@ -390,25 +616,22 @@ static void vcprintf(void (*std_putc)(char c, void *arg_p),
         case 'i':
         case 'd':
         case 'u':
-            s_p = formati(c, &buf[sizeof(buf) - 1], 10, ap_p, length, &negative_sign);
-            break;
-
         case 'x':
-            s_p = formati(c, &buf[sizeof(buf) - 1], 16, ap_p, length, &negative_sign);
+            s_p = formati(c, &buf[sizeof(buf) - 1], ap_p, length, &negative_sign);
             break;
 
-#if CONFIG_FLOAT == 1
+#if CONFIG_STD_PRINTF_FLOAT == 1
         case 'f':
             s_p = formatf(c, &buf[sizeof(buf) - 1], ap_p, length, &negative_sign);
             break;
 #endif
 
         default:
-            std_putc(c, arg_p);
+            std_write(&c, 1, arg_p);
             continue;
         }
 
-        formats(std_putc, arg_p, s_p, flags, width, negative_sign);
+        formats(std_write, arg_p, s_p, flags, width, negative_sign);
     }
 }
 
@@ -417,7 +640,7 @@ static void cvcprintf(struct buffered_output_t *output_p,
                       va_list *ap_p)
 {
     chan_control(output_p->chan_p, CHAN_CONTROL_PRINTF_BEGIN);
-    vcprintf(fprintf_putc, output_p, fmt_p, ap_p);
+    vcprintf(fprintf_write, output_p, fmt_p, ap_p);
     output_flush(output_p);
     chan_control(output_p->chan_p, CHAN_CONTROL_PRINTF_END);
 }
@@ -480,8 +703,8 @@ ssize_t std_vsprintf(char *dst_p, far_string_t fmt_p, va_list *ap_p)
 
     char *d_p = dst_p;
 
-    vcprintf(sprintf_putc, &d_p, fmt_p, ap_p);
-    sprintf_putc('\0', &d_p);
+    vcprintf(sprintf_write, &d_p, fmt_p, ap_p);
+    sprintf_write("", 1, &d_p);
 
     return (d_p - dst_p - 1);
 }
@@ -504,8 +727,8 @@ ssize_t std_vsnprintf(char *dst_p,
     output.size = 0;
     output.size_max = size;
 
-    vcprintf(snprintf_putc, &output, fmt_p, ap_p);
-    snprintf_putc('\0', &output);
+    vcprintf(snprintf_write, &output, fmt_p, ap_p);
+    snprintf_write("", 1, &output);
 
     /* Force the string to be NULL terminated. */
     dst_p[size - 1] = '\0';
@@ -597,7 +820,7 @@ ssize_t std_printf_isr(far_string_t fmt_p, ...)
     output.chan_p = sys_get_stdout();
 
     va_start(ap, fmt_p);
-    vcprintf(fprintf_putc_isr, &output, fmt_p, &ap);
+    vcprintf(fprintf_write_isr, &output, fmt_p, &ap);
     output_flush_isr(&output);
     va_end(ap);
 
@@ -614,7 +837,7 @@ ssize_t std_fprintf_isr(void *chan_p, far_string_t fmt_p, ...)
     output.chan_p = chan_p;
 
     va_start(ap, fmt_p);
-    vcprintf(fprintf_putc_isr, &output, fmt_p, &ap);
+    vcprintf(fprintf_write_isr, &output, fmt_p, &ap);
     output_flush_isr(&output);
     va_end(ap);
 
@@ -726,128 +949,187 @@ static char *skipwhite(const char *q_p)
     return (p_p);
 }
 
-/*
- * strtod implementation.
- * author: Yasuhiro Matsumoto
- * license: public domain
+#if __DBL_MANT_DIG__ > 24
+typedef uint64_t mantissa_t;
+#    define MANTISSA_DIGITS_MAX                             19
+#    define MANTISSA_EXACT_MAX                    (1ULL << 53)
+#else
+typedef uint32_t mantissa_t;
+#    define MANTISSA_DIGITS_MAX                              9
+#    define MANTISSA_EXACT_MAX                     (1UL << 24)
+#endif
+
+/**
+ * Powers of ten that are exactly representable as a double.
  */
-const char *std_strtod(const char *str, double *value_p)
-{
-    double d = 0.0;
-    int sign;
-    int n = 0;
-    const char *p, *a;
+static FAR const double exact_powers_of_ten[] = {
+    1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10
+#if __DBL_MANT_DIG__ > 24
+    , 1e11, 1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20,
+    1e21, 1e22
+#endif
+};
 
-    a = p = str;
-    p = skipwhite(p);
+#define POW10_EXACT_MAX (membersof(exact_powers_of_ten) - 1)
 
-    /* decimal part */
-    sign = 1;
+/**
+ * Both the mantissa and the power of ten are exact, and a single
+ * multiplication or division gives the correctly rounded result
+ * (Clinger's fast path). Returns -1 if the fast path cannot be
+ * used.
+ */
+static int strtod_fast(mantissa_t mantissa, int exponent, double *value_p)
+{
+    /* Move part of a too big exponent to the mantissa if the result
+       is still exact. */
+    while ((exponent > (int)POW10_EXACT_MAX)
+           && (mantissa <= MANTISSA_EXACT_MAX / 10)) {
+        mantissa *= 10;
+        exponent--;
+    }
 
-    if (*p == '-') {
-        sign = -1;
-        ++p;
-    } else if (*p == '+') {
-        ++p;
+    if (mantissa > MANTISSA_EXACT_MAX) {
+        return (-1);
     }
 
-    if (isdigit((int)*p)) {
-        d = (double)(*p++ - '0');
+    if (exponent < 0) {
+        if (-exponent > (int)POW10_EXACT_MAX) {
+            return (-1);
+        }
 
-        while (*p && isdigit((int)*p)) {
-            d = d * 10.0 + (double)(*p - '0');
-            ++p;
-            ++n;
+        *value_p = ((double)mantissa / exact_powers_of_ten[-exponent]);
+    } else {
+        if (exponent > (int)POW10_EXACT_MAX) {
+            return (-1);
         }
 
-        a = p;
-    } else if (*p != '.') {
-        goto done;
+        *value_p = ((double)mantissa * exact_powers_of_ten[exponent]);
     }
 
-    d *= sign;
+    return (0);
+}
+
+const char *std_strtod(const char *str_p, double *value_p)
+{
+    const char *p_p;
+    const char *number_p;
+    const char *exponent_p;
+    mantissa_t mantissa;
+    int number_of_digits;
+    int exponent;
+    int exponent_value;
+    int negative;
+    int fraction;
+    int truncated;
+    int digit_found;
+    double value;
 
-    /* fraction part */
-    if (*p == '.') {
-        double f = 0.0;
-        double base = 0.1;
-        ++p;
+    p_p = skipwhite(str_p);
+    number_p = p_p;
+    negative = 0;
 
-        if (isdigit((int)*p)) {
-            while (*p && isdigit((int)*p)) {
-                f += base * (*p - '0') ;
-                base /= 10.0;
-                ++p;
-                ++n;
+    if (*p_p == '-') {
+        negative = 1;
+        p_p++;
+    } else if (*p_p == '+') {
+        p_p++;
+    }
+
+    /* Integer and fraction parts. Only the most significant digits
+       fitting in the mantissa are kept. */
+    mantissa = 0;
+    number_of_digits = 0;
+    exponent = 0;
+    fraction = 0;
+    truncated = 0;
+    digit_found = 0;
+
+    while (1) {
+        if (isdigit((int)*p_p)) {
+            digit_found = 1;
+
+            if (number_of_digits < MANTISSA_DIGITS_MAX) {
+                mantissa = (10 * mantissa + (*p_p - '0'));
+
+                if (mantissa != 0) {
+                    number_of_digits++;
+                }
+
+                if (fraction == 1) {
+                    exponent--;
+                }
+            } else {
+                if (*p_p != '0') {
+                    truncated = 1;
+                }
+
+                if (fraction == 0) {
+                    exponent++;
+                }
             }
+        } else if ((*p_p == '.') && (fraction == 0)) {
+            fraction = 1;
+        } else {
+            break;
         }
 
-        d += f * sign;
-        a = p;
+        p_p++;
     }
 
-    /* exponential part */
-    if ((*p == 'E') || (*p == 'e')) {
-        int e = 0;
-        ++p;
+    if (digit_found == 0) {
+        *value_p = 0.0;
 
-        sign = 1;
+        return (str_p);
+    }
+
+    /* Exponent part, only if followed by at least one digit. */
+    if ((*p_p == 'e') || (*p_p == 'E')) {
+        exponent_p = &p_p[1];
 
-        if (*p == '-') {
-            sign = -1;
-            ++p;
-        } else if (*p == '+') {
-            ++p;
+        if ((*exponent_p == '-') || (*exponent_p == '+')) {
+            exponent_p++;
         }
 
-        if (isdigit((int)*p)) {
-            while (*p == '0') {
-                ++p;
-            }
+        if (isdigit((int)*exponent_p)) {
+            exponent_value = 0;
 
-            e = (int)(*p++ - '0');
+            while (isdigit((int)*exponent_p)) {
+                /* Saturate; the result is zero or infinity anyway. */
+                if (exponent_value < 10000) {
+                    exponent_value = (10 * exponent_value
+                                      + (*exponent_p - '0'));
+                }
 
-            while (*p && isdigit((int)*p)) {
-                e = e * 10 + (int)(*p - '0');
-                ++p;
+                exponent_p++;
             }
 
-            e *= sign;
-        } else if (!isdigit((int)*(a-1))) {
-            a = str;
-            goto done;
-        } else if (*p == 0) {
-            goto done;
-        }
+            if (p_p[1] == '-') {
+                exponent -= exponent_value;
+            } else {
+                exponent += exponent_value;
+            }
 
-        if (d == 2.2250738585072011 && e == -308) {
-            d = 0.0;
-            a = p;
-            goto done;
+            p_p = exponent_p;
         }
+    }
 
-        if (d == 2.2250738585072012 && e <= -308) {
-#if __DBL_MANT_DIG__ > 24
-            d *= 1.0e-308l;
-            a = p;
-#else
-            d = 0.0;
-            a = str;
-#endif
-            goto done;
-        }
+    if (mantissa == 0) {
+        value = 0.0;
+    } else if ((truncated == 1)
+               || (strtod_fast(mantissa, exponent, &value) != 0)) {
+        /* Rare slow path, the string is a valid decimal number. */
+        *value_p = strtod(number_p, NULL);
 
-        d *= pow(10.0, (double) e);
-        a = p;
-    } else if (p > str && !isdigit((int)*(p-1))) {
-        a = str;
-        goto done;
+        return (p_p);
     }
 
- done:
-    *value_p = d;
+    if (negative == 1) {
+        value = -value;
+    }
+
+    *value_p = value;
 
-    return (a);
+    return (p_p);
 }
 
 #endif
@@ -856,56 +1138,59 @@ const char *std_strtodfp(const char *str_p,
                          long *value_p,
                          int precision)
 {
-    int i;
-    long integer;
-    long decimals;
+    ASSERTNRN(str_p != NULL, EINVAL);
+    ASSERTNRN(value_p != NULL, EINVAL);
+
+    const char *p_p;
+    long value;
+    int negative;
     int number_of_decimals;
-    const char *integer_end_p;
-    const char *decimal_end_p;
 
-    /* Integer part. */
-    integer_end_p = std_strtolb(&str_p[0], &integer, 10);
+    p_p = str_p;
+    negative = 0;
 
-    if (integer_end_p == NULL) {
-        return (NULL);
+    if (*p_p == '-') {
+        negative = 1;
+        p_p++;
+    } else if (*p_p == '+') {
+        p_p++;
     }
 
-    for (i = 0; i < precision; i++) {
-        integer *= 10;
+    if (!isdigit((int)*p_p)) {
+        return (NULL);
     }
 
-    *value_p = integer;
+    /* Integer part. */
+    value = 0;
 
-    if (*integer_end_p != '.') {
-        return (integer_end_p);
+    while (isdigit((int)*p_p)) {
+        value = (10 * value + (*p_p++ - '0'));
     }
 
-    /* Decimal part. */
-    decimal_end_p = std_strtolb(&integer_end_p[1], &decimals, 10);
+    /* Decimal part, truncated to given precision. */
+    number_of_decimals = 0;
 
-    if (decimal_end_p == NULL) {
-        return (integer_end_p + 1);
-    }
-
-    number_of_decimals = (decimal_end_p - &integer_end_p[1]);
+    if (*p_p == '.') {
+        p_p++;
 
-    /* Truncate decimals if needed. */
-    if (number_of_decimals > precision) {
-        for (i = 0; i < (number_of_decimals - precision); i++) {
-            decimals /= 10;
-            decimal_end_p--;
+        while (isdigit((int)*p_p) && (number_of_decimals < precision)) {
+            value = (10 * value + (*p_p++ - '0'));
+            number_of_decimals++;
         }
+    }
 
-        number_of_decimals = precision;
+    while (number_of_decimals < precision) {
+        value *= 10;
+        number_of_decimals++;
     }
 
-    for (i = 0; i < (precision - number_of_decimals); i++) {
-        decimals *= 10;
+    if (negative == 1) {
+        value = -value;
     }
 
-    *value_p += decimals;
+    *value_p = value;
 
-    return (decimal_end_p);
+    return (p_p);
 }
 
 int std_strcpy(char *dst_p, far_string_t fsrc_p)
@@ -55,7 +55,8 @@ int std_module_init(void);
  *
  * * flags: ``0`` or ``-``
  * * width: ``0``..``127``
- * * length: ``l`` for long or nothing
+ * * length: ``l`` for long, ``ll`` for long long if
+ *   ``CONFIG_STD_PRINTF_LONG_LONG`` is set, or nothing
  * * specifier: ``c``, ``s``, ``S``, ``d``, ``i``, ``u``, ``x`` or ``f``
  *
  * The ``S`` specifier expects a far string (``far_string_t``)
@@ -238,7 +239,11 @@ const char *std_strtolb(const char *str_p,
 const char *std_strtol(const char *str_p, long *value_p);
 
 /**
- * Convert given string to a double.
+ * Convert given string to a double. Numbers with few enough
+ * significant digits and a small exponent, which is the common case,
+ * are converted using integer arithmetic and a single floating point
+ * operation, giving a correctly rounded result. Other numbers are
+ * converted by the C library strtod().
  *
  * @param[in] str_p Double string.
  * @param[out] value_p Parsed value.
@@ -248,7 +253,9 @@ const char *std_strtol(const char *str_p, long *value_p);
 const char *std_strtod(const char *str_p, double *value_p);
 
 /**
- * Convert string to decimal fixed point number with given precision.
+ * Convert string to decimal fixed point number with given precision,
+ * using integer arithmetic only. Decimals beyond the precision are
+ * truncated, and not consumed.
  *
  * @param[in] str_p Double string.
  * @param[out] value_p Decimal fixed point number of given precision.
@@ -0,0 +1,156 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2014-2018, Erik Moqvist
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use, copy,
+ * modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ * This file is part of the Simba project.
+ */
+
+#include "simba.h"
+
+#include "simba.h"
+
+static uint64_t buf[32];
+static THRD_STACK(worker_stack, 1024);
+static struct arena_t worker_arena;
+static uint64_t worker_buf[8];
+static struct arena_t *worker_arena_p;
+
+static int test_alloc(void)
+{
+    struct arena_t arena;
+    struct arena_stats_t stats;
+    char *buf_p;
+    void *buf2_p;
+    size_t mark;
+
+    BTASSERT(arena_init(&arena, &buf[0], sizeof(buf)) == 0);
+
+    /* Allocations are aligned. */
+    buf_p = arena_alloc(&arena, 1);
+    BTASSERT(buf_p == (char *)&buf[0]);
+    buf2_p = arena_alloc(&arena, 8);
+    BTASSERT(buf2_p != NULL);
+    BTASSERTI(((uintptr_t)buf2_p % sizeof(void *)), ==, 0);
+    BTASSERT((char *)buf2_p > buf_p);
+
+    /* Free everything allocated after the mark. */
+    mark = arena_mark(&arena);
+    BTASSERT(arena_alloc(&arena, 100) != NULL);
+    BTASSERT(arena_reset(&arena, mark) == 0);
+    BTASSERTI(arena_mark(&arena), ==, mark);
+
+    BTASSERT(arena_get_stats(&arena, &stats) == 0);
+    BTASSERTI(stats.size, ==, sizeof(buf));
+    BTASSERTI(stats.used, ==, mark);
+    BTASSERTI(stats.used_max, ==, mark + 100);
+    BTASSERTI(stats.failed_allocs, ==, 0);
+
+    /* Free all. */
+    BTASSERT(arena_reset(&arena, 0) == 0);
+    BTASSERTI(arena_mark(&arena), ==, 0);
+
+    return (0);
+}
+
+static int test_overflow(void)
+{
+    struct arena_t arena;
+    struct arena_stats_t stats;
+
+    BTASSERT(arena_init(&arena, &buf[0], sizeof(buf)) == 0);
+
+    BTASSERT(arena_alloc(&arena, sizeof(buf) + 1) == NULL);
+    BTASSERT(arena_alloc(&arena, sizeof(buf) - 1) != NULL);
+
+    /* The aligned position is past the end of the arena. */
+    BTASSERT(arena_alloc(&arena, 1) == NULL);
+
+    BTASSERT(arena_reset(&arena, 0) == 0);
+    BTASSERT(arena_alloc(&arena, sizeof(buf)) != NULL);
+    BTASSERT(arena_alloc(&arena, 1) == NULL);
+
+    BTASSERT(arena_get_stats(&arena, &stats) == 0);
+    BTASSERTI(stats.used, ==, sizeof(buf));
+    BTASSERTI(stats.failed_allocs, ==, 3);
+
+    return (0);
+}
+
+static void *worker_main(void *arg_p)
+{
+    thrd_set_arena(&worker_arena);
+    worker_arena_p = thrd_get_arena();
+    arena_alloc(thrd_get_arena(), 16);
+
+    thrd_suspend(NULL);
+
+    return (NULL);
+}
+
+static int test_thrd_arena(void)
+{
+    struct arena_t arena;
+
+    BTASSERT(thrd_get_arena() == NULL);
+    BTASSERT(arena_init(&arena, &buf[0], sizeof(buf)) == 0);
+    BTASSERT(thrd_set_arena(&arena) == NULL);
+    BTASSERT(thrd_get_arena() == &arena);
+
+    /* Each thread has its own arena. */
+    BTASSERT(arena_init(&worker_arena,
+                        &worker_buf[0],
+                        sizeof(worker_buf)) == 0);
+    BTASSERT(thrd_spawn(worker_main,
+                        NULL,
+                        -1,
+                        worker_stack,
+                        sizeof(worker_stack)) != NULL);
+    thrd_yield();
+
+    BTASSERT(worker_arena_p == &worker_arena);
+    BTASSERTI(arena_mark(&worker_arena), ==, 16);
+    BTASSERT(thrd_get_arena() == &arena);
+    BTASSERTI(arena_mark(&arena), ==, 0);
+
+    BTASSERT(thrd_set_arena(NULL) == &arena);
+    BTASSERT(thrd_get_arena() == NULL);
+
+    return (0);
+}
+
+int main()
+{
+    struct harness_testcase_t testcases[] = {
+        { test_alloc, "test_alloc" },
+        { test_overflow, "test_overflow" },
+        { test_thrd_arena, "test_thrd_arena" },
+        { NULL, NULL }
+    };
+
+    sys_start();
+
+    harness_run(testcases);
+
+    return (0);
+}
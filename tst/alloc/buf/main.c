@@ -0,0 +1,274 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2014-2018, Erik Moqvist
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use, copy,
+ * modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ * This file is part of the Simba project.
+ */
+
+#include "simba.h"
+
+static BUF_POOL_BUFFER(pool_buf, 16, 8);
+static struct buf_pool_t pool;
+static int free_count;
+
+static uint32_t used(void)
+{
+    struct pool_stats_t stats;
+
+    pool_get_stats(&pool.pool, &stats);
+
+    return (stats.used);
+}
+
+static void free_cb(void *arg_p)
+{
+    free_count += *(int *)arg_p;
+}
+
+static int test_init(void)
+{
+    BTASSERT(buf_pool_init(&pool, &pool_buf[0], sizeof(pool_buf), 16) == 0);
+    BTASSERTI(used(), ==, 0);
+
+    return (0);
+}
+
+static int test_alloc_free(void)
+{
+    struct buf_t *buf_p;
+
+    /* Three buffers, with headroom in the first. */
+    buf_p = buf_alloc(&pool, 40, 4);
+    BTASSERT(buf_p != NULL);
+    BTASSERTI(buf_size(buf_p), ==, 40);
+    BTASSERTI(buf_p->size, ==, 12);
+    BTASSERTI(buf_p->next_p->size, ==, 16);
+    BTASSERTI(buf_p->next_p->next_p->size, ==, 12);
+    BTASSERT(buf_p->next_p->next_p->next_p == NULL);
+    BTASSERTI(used(), ==, 3);
+    BTASSERTI(buf_free(buf_p), ==, 3);
+    BTASSERTI(used(), ==, 0);
+
+    /* An empty buffer. */
+    buf_p = buf_alloc(&pool, 0, 0);
+    BTASSERT(buf_p != NULL);
+    BTASSERTI(buf_size(buf_p), ==, 0);
+    BTASSERTI(buf_free(buf_p), ==, 1);
+
+    /* Not enough buffers. */
+    BTASSERT(buf_alloc(&pool, 8 * 16 + 1, 0) == NULL);
+    BTASSERTI(used(), ==, 0);
+
+    /* Reference counting. */
+    buf_p = buf_alloc(&pool, 20, 0);
+    BTASSERT(buf_p != NULL);
+    BTASSERT(buf_ref(buf_p) == 0);
+    BTASSERTI(buf_free(buf_p), ==, 0);
+    BTASSERTI(used(), ==, 2);
+    BTASSERTI(buf_free(buf_p), ==, 2);
+    BTASSERTI(used(), ==, 0);
+
+    return (0);
+}
+
+static int test_push_pull(void)
+{
+    struct buf_t *buf_p;
+    uint8_t *data_p;
+
+    buf_p = buf_alloc(&pool, 8, 4);
+    BTASSERT(buf_p != NULL);
+    data_p = buf_p->data_p;
+
+    /* Add a header in the headroom. */
+    BTASSERT(buf_push(buf_p, 4) == &data_p[-4]);
+    BTASSERTI(buf_p->size, ==, 12);
+    BTASSERT(buf_push(buf_p, 1) == NULL);
+
+    /* Strip it again. */
+    BTASSERT(buf_pull(buf_p, 4) == data_p);
+    BTASSERTI(buf_p->size, ==, 8);
+    BTASSERT(buf_pull(buf_p, 9) == NULL);
+    BTASSERT(buf_pull(buf_p, 8) == &data_p[8]);
+    BTASSERTI(buf_p->size, ==, 0);
+
+    BTASSERTI(buf_free(buf_p), ==, 1);
+
+    return (0);
+}
+
+static int test_read_write_append(void)
+{
+    struct buf_t *buf_p;
+    uint8_t data[48];
+    uint8_t buf[48];
+    int i;
+
+    for (i = 0; i < membersof(data); i++) {
+        data[i] = i;
+    }
+
+    buf_p = buf_alloc(&pool, 20, 2);
+    BTASSERT(buf_p != NULL);
+
+    /* Write and read across the buffer boundary. */
+    BTASSERTI(buf_write(buf_p, 0, &data[0], 20), ==, 20);
+    BTASSERTI(buf_read(buf_p, 10, &buf[0], 10), ==, 10);
+    BTASSERTM(&buf[0], &data[10], 10);
+
+    /* Beyond the end. */
+    BTASSERTI(buf_write(buf_p, 18, &data[0], 4), ==, 2);
+    BTASSERTI(buf_read(buf_p, 15, &buf[0], 10), ==, 5);
+    BTASSERTI(buf_read(buf_p, 20, &buf[0], 10), ==, 0);
+
+    /* Append fills the last buffer, and then new buffers. */
+    BTASSERTI(buf_write(buf_p, 18, &data[18], 2), ==, 2);
+    BTASSERTI(buf_append(buf_p, &data[20], 28), ==, 28);
+    BTASSERTI(buf_size(buf_p), ==, 48);
+    BTASSERTI(used(), ==, 4);
+    BTASSERTI(buf_read(buf_p, 0, &buf[0], sizeof(buf)), ==, 48);
+    BTASSERTM(&buf[0], &data[0], 48);
+
+    BTASSERTI(buf_free(buf_p), ==, 4);
+
+    return (0);
+}
+
+static int test_split_join(void)
+{
+    struct buf_t *buf_p;
+    struct buf_t *tail_p;
+    struct buf_t *tail2_p;
+    struct buf_t *appended_p;
+    uint8_t data[40];
+    uint8_t buf[40];
+    int i;
+
+    for (i = 0; i < membersof(data); i++) {
+        data[i] = i;
+    }
+
+    buf_p = buf_alloc(&pool, 40, 0);
+    BTASSERT(buf_p != NULL);
+    BTASSERTI(buf_write(buf_p, 0, &data[0], 40), ==, 40);
+    BTASSERTI(used(), ==, 3);
+
+    /* Between two buffers, no allocation. */
+    tail_p = buf_split(buf_p, 16);
+    BTASSERT(tail_p != NULL);
+    BTASSERTI(buf_size(buf_p), ==, 16);
+    BTASSERTI(buf_size(tail_p), ==, 24);
+    BTASSERTI(used(), ==, 3);
+
+    /* Inside a buffer, referencing the data after the offset. */
+    tail2_p = buf_split(tail_p, 4);
+    BTASSERT(tail2_p != NULL);
+    BTASSERTI(buf_size(tail_p), ==, 4);
+    BTASSERTI(buf_size(tail2_p), ==, 20);
+    BTASSERTI(used(), ==, 4);
+    BTASSERTI(buf_read(tail2_p, 0, &buf[0], sizeof(buf)), ==, 20);
+    BTASSERTM(&buf[0], &data[20], 20);
+
+    /* No room for appending to the split buffer. */
+    BTASSERTI(buf_append(tail_p, &data[0], 1), ==, 1);
+    BTASSERTI(used(), ==, 5);
+    BTASSERTI(buf_read(tail2_p, 0, &buf[0], 1), ==, 1);
+    BTASSERTI(buf[0], ==, 20);
+    BTASSERT(buf_split(tail_p, 5) == NULL);
+    appended_p = buf_split(tail_p, 4);
+    BTASSERT(appended_p != NULL);
+    BTASSERTI(buf_free(appended_p), ==, 1);
+
+    /* Still referenced by the split buffer. */
+    BTASSERTI(buf_free(tail_p), ==, 0);
+
+    /* Beyond the end. */
+    BTASSERT(buf_split(buf_p, 17) == NULL);
+
+    /* Join the parts again. */
+    BTASSERT(buf_join(buf_p, tail2_p) == 0);
+    BTASSERTI(buf_size(buf_p), ==, 36);
+    BTASSERTI(buf_read(buf_p, 14, &buf[0], 4), ==, 4);
+    BTASSERTI(buf[0], ==, 14);
+    BTASSERTI(buf[1], ==, 15);
+    BTASSERTI(buf[2], ==, 20);
+    BTASSERTI(buf[3], ==, 21);
+
+    /* The split buffer is freed with its reference. */
+    BTASSERTI(used(), ==, 4);
+    BTASSERTI(buf_free(buf_p), ==, 3);
+    BTASSERTI(used(), ==, 0);
+
+    return (0);
+}
+
+static int test_alloc_ref(void)
+{
+    struct buf_t *buf_p;
+    uint8_t data[32];
+    int weight;
+
+    weight = 1;
+    free_count = 0;
+    buf_p = buf_alloc_ref(&pool, &data[0], sizeof(data), free_cb, &weight);
+    BTASSERT(buf_p != NULL);
+    BTASSERT(buf_p->data_p == &data[0]);
+    BTASSERTI(buf_size(buf_p), ==, 32);
+
+    /* No headroom. */
+    BTASSERT(buf_push(buf_p, 1) == NULL);
+
+    /* Appended data goes into a new buffer. */
+    BTASSERTI(buf_append(buf_p, "foo", 3), ==, 3);
+    BTASSERTI(buf_size(buf_p), ==, 35);
+    BTASSERT(buf_p->next_p != NULL);
+
+    BTASSERT(buf_ref(buf_p) == 0);
+    BTASSERTI(buf_free(buf_p), ==, 0);
+    BTASSERTI(free_count, ==, 0);
+    BTASSERTI(buf_free(buf_p), ==, 2);
+    BTASSERTI(free_count, ==, 1);
+    BTASSERTI(used(), ==, 0);
+
+    return (0);
+}
+
+int main()
+{
+    struct harness_testcase_t testcases[] = {
+        { test_init, "test_init" },
+        { test_alloc_free, "test_alloc_free" },
+        { test_push_pull, "test_push_pull" },
+        { test_read_write_append, "test_read_write_append" },
+        { test_split_join, "test_split_join" },
+        { test_alloc_ref, "test_alloc_ref" },
+        { NULL, NULL }
+    };
+
+    sys_start();
+
+    harness_run(testcases);
+
+    return (0);
+}
@@ -82,10 +82,59 @@ static int test_alloc_free(void)
     return (0);
 }
 
+static int test_stats(void)
+{
+    static struct circular_heap_t circular_heap;
+    struct circular_heap_stats_t stats;
+    void *bufs[2];
+    char command[64];
+    struct queue_t out;
+    char buf[512];
+
+    BTASSERT(circular_heap_init(&circular_heap,
+                                buffer,
+                                sizeof(buffer)) == 0);
+    BTASSERT(circular_heap_register(&circular_heap, "circ") == 0);
+
+    BTASSERT(circular_heap_get_stats(&circular_heap, &stats) == 0);
+    BTASSERTI(stats.used, ==, 0);
+    BTASSERTI(stats.largest_free, >=, 200);
+
+    bufs[0] = circular_heap_alloc(&circular_heap, 100);
+    BTASSERT(bufs[0] != NULL);
+    bufs[1] = circular_heap_alloc(&circular_heap, 100);
+    BTASSERT(bufs[1] != NULL);
+    BTASSERT(circular_heap_alloc(&circular_heap, 100) == NULL);
+
+    BTASSERT(circular_heap_get_stats(&circular_heap, &stats) == 0);
+    BTASSERTI(stats.allocs, ==, 2);
+    BTASSERTI(stats.failed_allocs, ==, 1);
+    BTASSERTI(stats.used, >=, 200);
+    BTASSERTI(stats.largest_free, <, 100);
+
+    /* The largest free block is big enough to allocate. */
+    BTASSERT(circular_heap_alloc(&circular_heap,
+                                 stats.largest_free) != NULL);
+
+    BTASSERT(circular_heap_free(&circular_heap, bufs[0]) == 0);
+    BTASSERT(circular_heap_get_stats(&circular_heap, &stats) == 0);
+    BTASSERTI(stats.frees, ==, 1);
+    BTASSERTI(stats.used_max, >, stats.used);
+
+    BTASSERT(queue_init(&out, &buf[0], sizeof(buf)) == 0);
+    strcpy(command, "/alloc/circular_heap/list");
+    BTASSERT(fs_call(command, NULL, &out, NULL) == 0);
+    BTASSERTI(harness_expect(&out, "NAME      USED", NULL), >, 0);
+    BTASSERTI(harness_expect(&out, "circ", NULL), >, 0);
+
+    return (0);
+}
+
 int main()
 {
     struct harness_testcase_t testcases[] = {
         { test_alloc_free, "test_alloc_free" },
+        { test_stats, "test_stats" },
         { NULL, NULL }
     };
 
@@ -157,6 +157,108 @@ static int test_out_of_memory(void)
     return (0);
 }
 
+static int test_stats(void)
+{
+    static struct heap_t heap;
+    struct heap_stats_t stats;
+    void *buffers[3];
+    size_t sizes[8] = { 16, 32, 64, 128, 256, 512, 512, 512 };
+    size_t used;
+    char command[64];
+    struct queue_t out;
+    char buf[2048];
+
+    BTASSERT(heap_init(&heap, buffer, sizeof(buffer), sizes) == 0);
+    BTASSERT(heap_register(&heap, "stats") == 0);
+
+    BTASSERT(heap_get_stats(&heap, &stats) == 0);
+    BTASSERTI(stats.used, ==, 0);
+    BTASSERTI(stats.largest_free, >, 1900);
+
+    /* A fixed size miss, a hit and a dynamic size buffer. */
+    buffers[0] = heap_alloc(&heap, 10);
+    BTASSERT(buffers[0] != NULL);
+    BTASSERT(heap_free(&heap, buffers[0]) == 0);
+    buffers[0] = heap_alloc(&heap, 12);
+    BTASSERT(buffers[0] != NULL);
+    buffers[1] = heap_alloc(&heap, 600);
+    BTASSERT(buffers[1] != NULL);
+
+    BTASSERT(heap_get_stats(&heap, &stats) == 0);
+    BTASSERTI(stats.allocs, ==, 3);
+    BTASSERTI(stats.frees, ==, 1);
+    BTASSERTI(stats.fixed[0].hits, ==, 1);
+    BTASSERTI(stats.fixed[0].misses, ==, 1);
+    BTASSERTI(stats.used, >=, 616);
+    BTASSERTI(stats.used_max, ==, stats.used);
+    used = stats.used;
+
+    /* Out of memory. */
+    BTASSERT(heap_alloc(&heap, 3000) == NULL);
+    buffers[2] = heap_alloc(&heap, 1000);
+    BTASSERT(buffers[2] != NULL);
+    BTASSERT(heap_free(&heap, buffers[2]) == 0);
+    BTASSERT(heap_free(&heap, buffers[1]) == 0);
+
+    BTASSERT(heap_get_stats(&heap, &stats) == 0);
+    BTASSERTI(stats.failed_allocs, ==, 1);
+    BTASSERTI(stats.used, <, used);
+    BTASSERTI(stats.used_max, >, used + 1000);
+    BTASSERTI(stats.largest_free, >=, 1000);
+
+    BTASSERT(queue_init(&out, &buf[0], sizeof(buf)) == 0);
+
+    strcpy(command, "/alloc/heap/list");
+    BTASSERT(fs_call(command, NULL, &out, NULL) == 0);
+    BTASSERTI(harness_expect(&out, "NAME      USED", NULL), >, 0);
+    BTASSERTI(harness_expect(&out, "stats", NULL), >, 0);
+
+    BTASSERT(heap_print_openmetrics(&out) == 0);
+    BTASSERTI(harness_expect(&out, "# TYPE heap_used_bytes gauge\n", NULL), >, 0);
+    BTASSERTI(harness_expect(&out, "# TYPE heap_allocs counter\n", NULL), >, 0);
+    BTASSERTI(harness_expect(&out,
+                             "heap_allocs_total{heap=\"stats\"} 4\n",
+                             NULL), >, 0);
+    BTASSERTI(harness_expect(&out,
+                             "heap_frees_total{heap=\"stats\"} 3\n",
+                             NULL), >, 0);
+    BTASSERTI(harness_expect(&out,
+                             "heap_failed_allocs_total{heap=\"stats\"} 1\n",
+                             NULL), >, 0);
+
+    /* The most recent call first. */
+    strcpy(command, "/alloc/heap/trace stats");
+    BTASSERT(fs_call(command, NULL, &out, NULL) == 0);
+    BTASSERTI(harness_expect(&out,
+                             "Heap stats trace (most recent call first):\r\n",
+                             NULL), >, 0);
+    BTASSERTI(harness_expect(&out, " free ", NULL), >, 0);
+    BTASSERTI(harness_expect(&out, " free ", NULL), >, 0);
+    BTASSERTI(harness_expect(&out, " alloc ", NULL), >, 0);
+    BTASSERTI(harness_expect(&out, " 1000\r\n", NULL), >, 0);
+    BTASSERTI(harness_expect(&out, " alloc ", NULL), >, 0);
+    BTASSERTI(harness_expect(&out, " 3000\r\n", NULL), >, 0);
+
+    strcpy(command, "/alloc/heap/trace missing");
+    BTASSERT(fs_call(command, NULL, &out, NULL) == -ENOENT);
+    BTASSERTI(harness_expect(&out, "missing: heap not found\r\n", NULL), >, 0);
+
+    strcpy(command, "/alloc/heap/reset");
+    BTASSERT(fs_call(command, NULL, &out, NULL) == 0);
+    BTASSERT(heap_get_stats(&heap, &stats) == 0);
+    BTASSERTI(stats.allocs, ==, 0);
+    BTASSERTI(stats.failed_allocs, ==, 0);
+    BTASSERTI(stats.used_max, ==, stats.used);
+
+    /* Failed allocations in all heaps since the module was
+       initialized by heap_register(). */
+    strcpy(command, "/alloc/heap/failed_allocs");
+    BTASSERT(fs_call(command, NULL, &out, NULL) == 0);
+    BTASSERTI(harness_expect(&out, "0000000000000001\r\n", NULL), >, 0);
+
+    return (0);
+}
+
 int main()
 {
     struct harness_testcase_t testcases[] = {
@@ -165,6 +267,7 @@ int main()
         { test_share, "test_share" },
         { test_big_buffer, "test_big_buffer" },
         { test_out_of_memory, "test_out_of_memory" },
+        { test_stats, "test_stats" },
         { NULL, NULL }
     };
 
@@ -0,0 +1,236 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2014-2018, Erik Moqvist
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use, copy,
+ * modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ * This file is part of the Simba project.
+ */
+
+#include "simba.h"
+
+static char buffer[8192];
+
+static size_t sizes[8] = { 16, 32, 64, 128, 256, 512, 512, 512 };
+
+static int test_alloc_free(void)
+{
+    int i;
+    struct heap_t heap;
+    void *buffers[16];
+
+    BTASSERT(heap_init(&heap, buffer, sizeof(buffer), sizes) == 0);
+
+    /* Allocate a few fixed and dynamic size buffers... */
+    for (i = 0; i < 16; i++) {
+        buffers[i] = heap_alloc(&heap, 1 + (32 * i));
+        BTASSERT(buffers[i] != NULL);
+        memset(buffers[i], -1, 1 + (32 * i));
+    }
+
+    /* ...and free them. */
+    for (i = 0; i < 16; i++) {
+        BTASSERT(heap_free(&heap, buffers[i]) == 0);
+    }
+
+    /* Allocate again... */
+    for (i = 0; i < 16; i++) {
+        buffers[i] = heap_alloc(&heap, 1 + (32 * i));
+        BTASSERT(buffers[i] != NULL);
+        memset(buffers[i], -1, 1 + (32 * i));
+    }
+
+    /* ...and free them in reverse order. */
+    for (i = 15; i >= 0; i--) {
+        BTASSERT(heap_free(&heap, buffers[i]) == 0);
+    }
+
+    return (0);
+}
+
+static int test_double_free(void)
+{
+    struct heap_t heap;
+    void *buf_p;
+
+    BTASSERT(heap_init(&heap, buffer, sizeof(buffer), sizes) == 0);
+
+    buf_p = heap_alloc(&heap, 1);
+    BTASSERT(buf_p != NULL);
+    BTASSERT(heap_free(&heap, buf_p) == 0);
+    BTASSERT(heap_free(&heap, buf_p) == -1);
+
+    buf_p = heap_alloc(&heap, 1000);
+    BTASSERT(buf_p != NULL);
+    BTASSERT(heap_free(&heap, buf_p) == 0);
+    BTASSERT(heap_free(&heap, buf_p) == -1);
+
+    return (0);
+}
+
+static int test_share(void)
+{
+    struct heap_t heap;
+    void *buf_p;
+
+    BTASSERT(heap_init(&heap, buffer, sizeof(buffer), sizes) == 0);
+
+    buf_p = heap_alloc(&heap, 700);
+    BTASSERT(buf_p != NULL);
+    BTASSERT(heap_share(&heap, buf_p, 2) == 0);
+    BTASSERT(heap_free(&heap, buf_p) == 2);
+    BTASSERT(heap_free(&heap, buf_p) == 1);
+    BTASSERT(heap_free(&heap, buf_p) == 0);
+
+    return (0);
+}
+
+static int test_coalesce(void)
+{
+    struct heap_t heap;
+    struct heap_stats_t stats;
+    void *buffers[3];
+    void *buf_p;
+    int i;
+
+    BTASSERT(heap_init(&heap, buffer, 4096, sizes) == 0);
+
+    /* Use the whole heap with three buffers. */
+    for (i = 0; i < 3; i++) {
+        buffers[i] = heap_alloc(&heap, 1200);
+        BTASSERT(buffers[i] != NULL);
+        memset(buffers[i], i, 1200);
+    }
+
+    BTASSERT(heap_alloc(&heap, 2000) == NULL);
+
+    /* Free the outer buffers first, then the middle buffer, which is
+       merged with both its neighbours. */
+    BTASSERT(heap_free(&heap, buffers[0]) == 0);
+    BTASSERT(heap_free(&heap, buffers[2]) == 0);
+    BTASSERT(heap_alloc(&heap, 2000) == NULL);
+    BTASSERT(heap_get_stats(&heap, &stats) == 0);
+    BTASSERTI(stats.largest_free, <, 2000);
+    BTASSERTI(stats.largest_free, >=, 1200);
+    BTASSERT(heap_free(&heap, buffers[1]) == 0);
+    BTASSERT(heap_get_stats(&heap, &stats) == 0);
+    BTASSERTI(stats.largest_free, >, 4000);
+    BTASSERTI(stats.used, ==, 0);
+
+    buf_p = heap_alloc(&heap, 3500);
+    BTASSERT(buf_p != NULL);
+    memset(buf_p, -1, 3500);
+    BTASSERT(heap_free(&heap, buf_p) == 0);
+
+    return (0);
+}
+
+static int test_fragmentation(void)
+{
+    struct heap_t heap;
+    void *buffers[24];
+    int i;
+    int round;
+    size_t size;
+    size_t small_sizes[8] = { 8, 8, 8, 8, 8, 8, 8, 8 };
+
+    BTASSERT(heap_init(&heap, buffer, 4096, small_sizes) == 0);
+
+    for (i = 0; i < membersof(buffers); i++) {
+        buffers[i] = NULL;
+    }
+
+    /* Allocate and free buffers of varying sizes in an interleaved
+       order. */
+    for (round = 0; round < 50; round++) {
+        for (i = (round % 3); i < membersof(buffers); i += 3) {
+            if (buffers[i] != NULL) {
+                BTASSERT(heap_free(&heap, buffers[i]) == 0);
+                buffers[i] = NULL;
+            } else {
+                size = (9 + ((round * 37 + i * 101) % 400));
+                buffers[i] = heap_alloc(&heap, size);
+
+                if (buffers[i] != NULL) {
+                    memset(buffers[i], i, size);
+                }
+            }
+        }
+    }
+
+    for (i = 0; i < membersof(buffers); i++) {
+        if (buffers[i] != NULL) {
+            BTASSERT(heap_free(&heap, buffers[i]) == 0);
+        }
+    }
+
+    /* All free memory is merged again. */
+    buffers[0] = heap_alloc(&heap, 3500);
+    BTASSERT(buffers[0] != NULL);
+    BTASSERT(heap_free(&heap, buffers[0]) == 0);
+
+    return (0);
+}
+
+static int test_out_of_memory(void)
+{
+    struct heap_t heap;
+    void *buf_p;
+
+    /* Bigger than the maximum block size. */
+    BTASSERT(heap_init(&heap, buffer, sizeof(buffer), sizes) == 0);
+    BTASSERT(heap_alloc(&heap, 4096) == NULL);
+
+    /* A small heap. */
+    BTASSERT(heap_init(&heap, buffer, 160, sizes) == 0);
+
+    buf_p = heap_alloc(&heap, 1);
+    BTASSERT(buf_p != NULL);
+
+    buf_p = heap_alloc(&heap, 600);
+    BTASSERT(buf_p == NULL);
+
+    /* A heap too small for any buffer. */
+    BTASSERT(heap_init(&heap, buffer, 8, sizes) == 0);
+    BTASSERT(heap_alloc(&heap, 1) == NULL);
+
+    return (0);
+}
+
+int main()
+{
+    struct harness_testcase_t testcases[] = {
+        { test_alloc_free, "test_alloc_free" },
+        { test_double_free, "test_double_free" },
+        { test_share, "test_share" },
+        { test_coalesce, "test_coalesce" },
+        { test_fragmentation, "test_fragmentation" },
+        { test_out_of_memory, "test_out_of_memory" },
+        { NULL, NULL }
+    };
+
+    sys_start();
+
+    harness_run(testcases);
+
+    return (0);
+}
@@ -0,0 +1,213 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2014-2018, Erik Moqvist
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use, copy,
+ * modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ * This file is part of the Simba project.
+ */
+
+#include "simba.h"
+
+struct frame_t {
+    uint32_t id;
+    uint8_t data[9];
+};
+
+static POOL_TYPE_BUFFER(frames_buf, struct frame_t, 4);
+static POOL_BUFFER(bytes_buf, 1, 32);
+
+static struct pool_t pool;
+static THRD_STACK(worker_stack, 1024);
+
+static int test_alloc_free(void)
+{
+    struct pool_t frames;
+    struct pool_stats_t stats;
+    struct frame_t *frames_p[5];
+    int i;
+
+    BTASSERT(pool_init(&frames,
+                       &frames_buf[0],
+                       sizeof(frames_buf),
+                       sizeof(struct frame_t)) == 0);
+
+    /* Allocate all blocks. */
+    for (i = 0; i < 4; i++) {
+        frames_p[i] = POOL_ALLOC(&frames, struct frame_t);
+        BTASSERT(frames_p[i] != NULL);
+        BTASSERT(((uintptr_t)frames_p[i] % sizeof(void *)) == 0);
+        frames_p[i]->id = i;
+        memset(&frames_p[i]->data[0], i, sizeof(frames_p[i]->data));
+    }
+
+    /* Blocks do not overlap. */
+    for (i = 0; i < 4; i++) {
+        BTASSERTI(frames_p[i]->id, ==, i);
+        BTASSERTI(frames_p[i]->data[8], ==, i);
+    }
+
+    frames_p[4] = pool_alloc(&frames);
+    BTASSERT(frames_p[4] == NULL);
+
+    BTASSERT(pool_get_stats(&frames, &stats) == 0);
+    BTASSERTI(stats.length, ==, 4);
+    BTASSERTI(stats.used, ==, 4);
+    BTASSERTI(stats.used_max, ==, 4);
+    BTASSERTI(stats.allocs, ==, 4);
+    BTASSERTI(stats.failed_allocs, ==, 1);
+
+    /* Free in another order and allocate again. The most recently
+       freed block is allocated first. */
+    BTASSERT(pool_free(&frames, frames_p[2]) == 0);
+    BTASSERT(pool_free(&frames, frames_p[0]) == 0);
+    BTASSERT(pool_alloc(&frames) == frames_p[0]);
+    BTASSERT(pool_alloc_isr(&frames) == frames_p[2]);
+
+    for (i = 0; i < 4; i++) {
+        BTASSERT(pool_free_isr(&frames, frames_p[i]) == 0);
+    }
+
+    BTASSERT(pool_get_stats(&frames, &stats) == 0);
+    BTASSERTI(stats.used, ==, 0);
+    BTASSERTI(stats.used_max, ==, 4);
+    BTASSERTI(stats.allocs, ==, 6);
+
+    /* Not blocks of the pool. */
+    BTASSERT(pool_free(&frames, &stats) == -EINVAL);
+    BTASSERT(pool_free(&frames, &frames_p[1]->data[0]) == -EINVAL);
+
+    return (0);
+}
+
+static int test_small_blocks(void)
+{
+    struct pool_t bytes;
+    struct pool_stats_t stats;
+    uint8_t *buf_p;
+    int i;
+
+    BTASSERT(pool_init(&bytes, &bytes_buf[0], sizeof(bytes_buf), 1) == 0);
+    BTASSERT(pool_get_stats(&bytes, &stats) == 0);
+    BTASSERTI(stats.length, ==, 32);
+
+    for (i = 0; i < 32; i++) {
+        buf_p = pool_alloc(&bytes);
+        BTASSERT(buf_p != NULL);
+        *buf_p = i;
+    }
+
+    BTASSERT(pool_alloc(&bytes) == NULL);
+
+    return (0);
+}
+
+static void *worker_main(void *arg_p)
+{
+    void *bufs[2];
+    int i;
+
+    for (i = 0; i < 1000; i++) {
+        bufs[0] = pool_alloc(&pool);
+        bufs[1] = pool_alloc(&pool);
+        thrd_yield();
+
+        if (bufs[0] != NULL) {
+            pool_free(&pool, bufs[0]);
+        }
+
+        if (bufs[1] != NULL) {
+            pool_free(&pool, bufs[1]);
+        }
+    }
+
+    thrd_suspend(NULL);
+
+    return (NULL);
+}
+
+static int test_threads(void)
+{
+    struct pool_stats_t stats;
+    struct thrd_t *thrd_p;
+    void *bufs[3];
+    int i;
+    int j;
+
+    BTASSERT(pool_init(&pool,
+                       &frames_buf[0],
+                       sizeof(frames_buf),
+                       sizeof(struct frame_t)) == 0);
+
+    thrd_p = thrd_spawn(worker_main,
+                        NULL,
+                        0,
+                        worker_stack,
+                        sizeof(worker_stack));
+    BTASSERT(thrd_p != NULL);
+
+    for (i = 0; i < 1000; i++) {
+        for (j = 0; j < 3; j++) {
+            bufs[j] = pool_alloc(&pool);
+        }
+
+        thrd_yield();
+
+        for (j = 0; j < 3; j++) {
+            if (bufs[j] != NULL) {
+                BTASSERT(pool_free(&pool, bufs[j]) == 0);
+            }
+        }
+    }
+
+    thrd_sleep_ms(10);
+
+    /* All blocks are back in the pool. */
+    BTASSERT(pool_get_stats(&pool, &stats) == 0);
+    BTASSERTI(stats.used, ==, 0);
+    BTASSERTI(stats.used_max, ==, 4);
+    BTASSERTI(stats.allocs + stats.failed_allocs, ==, 5000);
+
+    for (i = 0; i < 4; i++) {
+        BTASSERT(pool_alloc(&pool) != NULL);
+    }
+
+    BTASSERT(pool_alloc(&pool) == NULL);
+
+    return (0);
+}
+
+int main()
+{
+    struct harness_testcase_t testcases[] = {
+        { test_alloc_free, "test_alloc_free" },
+        { test_small_blocks, "test_small_blocks" },
+        { test_threads, "test_threads" },
+        { NULL, NULL }
+    };
+
+    sys_start();
+
+    harness_run(testcases);
+
+    return (0);
+}
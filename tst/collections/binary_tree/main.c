@@ -27,6 +27,7 @@
  */
 
 #include "simba.h"
+#include <limits.h>
 
 static struct binary_tree_t foo;
 static struct binary_tree_node_t nodes[16];
@@ -142,6 +143,179 @@ int test_search_empty(void)
     return (0);
 }
 
+/**
+ * Returns the height of given subtree, or -1 if it is not a valid
+ * AVL tree.
+ */
+static int check_node(struct binary_tree_node_t *node_p,
+                      int64_t low,
+                      int64_t high)
+{
+    int left;
+    int right;
+
+    if (node_p == NULL) {
+        return (0);
+    }
+
+    if ((node_p->key < low) || (node_p->key > high)) {
+        return (-1);
+    }
+
+    left = check_node(node_p->left_p, low, (int64_t)node_p->key - 1);
+    right = check_node(node_p->right_p, (int64_t)node_p->key + 1, high);
+
+    if ((left < 0) || (right < 0) || (left - right > 1) || (right - left > 1)) {
+        return (-1);
+    }
+
+    if (node_p->height != (1 + MAX(left, right))) {
+        return (-1);
+    }
+
+    return (node_p->height);
+}
+
+int test_range(void)
+{
+    struct binary_tree_t tree;
+    struct binary_tree_iter_t iter;
+    struct binary_tree_node_t *node_p;
+    int i;
+
+    BTASSERT(binary_tree_init(&tree) == 0);
+
+    /* Keys 0, 10, 20, ..., 150. */
+    for (i = 0; i < membersof(nodes); i++) {
+        nodes[i].key = (10 * i);
+        BTASSERT(binary_tree_insert(&tree, &nodes[i]) == 0);
+    }
+
+    BTASSERT(check_node(tree.root_p, INT_MIN, INT_MAX) > 0);
+
+    BTASSERT(binary_tree_lower_bound(&tree, 30) == &nodes[3]);
+    BTASSERT(binary_tree_lower_bound(&tree, 31) == &nodes[4]);
+    BTASSERT(binary_tree_lower_bound(&tree, -5) == &nodes[0]);
+    BTASSERT(binary_tree_lower_bound(&tree, 151) == NULL);
+    BTASSERT(binary_tree_upper_bound(&tree, 30) == &nodes[4]);
+    BTASSERT(binary_tree_upper_bound(&tree, 29) == &nodes[3]);
+    BTASSERT(binary_tree_upper_bound(&tree, 150) == NULL);
+
+    /* All nodes in order. */
+    BTASSERT(binary_tree_iter_init(&iter, &tree, INT_MIN, INT_MAX) == 0);
+
+    for (i = 0; i < membersof(nodes); i++) {
+        BTASSERT(binary_tree_iter_next(&iter) == &nodes[i]);
+    }
+
+    BTASSERT(binary_tree_iter_next(&iter) == NULL);
+    BTASSERT(binary_tree_iter_next(&iter) == NULL);
+
+    /* Keys 25 to 60, deleting each returned node. */
+    BTASSERT(binary_tree_iter_init(&iter, &tree, 25, 60) == 0);
+
+    for (i = 3; i <= 6; i++) {
+        node_p = binary_tree_iter_next(&iter);
+        BTASSERT(node_p == &nodes[i]);
+        BTASSERT(binary_tree_delete(&tree, node_p->key) == 0);
+    }
+
+    BTASSERT(binary_tree_iter_next(&iter) == NULL);
+    BTASSERT(binary_tree_search(&tree, 30) == NULL);
+    BTASSERT(binary_tree_search(&tree, 70) == &nodes[7]);
+    BTASSERT(check_node(tree.root_p, INT_MIN, INT_MAX) > 0);
+
+    /* An empty range. */
+    BTASSERT(binary_tree_iter_init(&iter, &tree, 31, 39) == 0);
+    BTASSERT(binary_tree_iter_next(&iter) == NULL);
+
+    /* Iteration ends at the largest possible key. */
+    duplicate.key = INT_MAX;
+    BTASSERT(binary_tree_insert(&tree, &duplicate) == 0);
+    BTASSERT(binary_tree_iter_init(&iter, &tree, 151, INT_MAX) == 0);
+    BTASSERT(binary_tree_iter_next(&iter) == &duplicate);
+    BTASSERT(binary_tree_iter_next(&iter) == NULL);
+
+    return (0);
+}
+
+int test_build(void)
+{
+    struct binary_tree_t tree;
+    struct binary_tree_iter_t iter;
+    struct binary_tree_node_t *nodes_p[membersof(nodes)];
+    size_t length;
+    int i;
+
+    BTASSERT(binary_tree_init(&tree) == 0);
+
+    for (i = 0; i < membersof(nodes); i++) {
+        nodes[i].key = (2 * i);
+        nodes_p[i] = &nodes[i];
+    }
+
+    /* Build trees of all sizes. */
+    for (length = 0; length <= membersof(nodes); length++) {
+        BTASSERT(binary_tree_build(&tree, &nodes_p[0], length) == 0);
+        BTASSERT(check_node(tree.root_p, INT_MIN, INT_MAX) >= 0);
+        BTASSERT(binary_tree_iter_init(&iter, &tree, INT_MIN, INT_MAX) == 0);
+
+        for (i = 0; i < length; i++) {
+            BTASSERT(binary_tree_iter_next(&iter) == &nodes[i]);
+        }
+
+        BTASSERT(binary_tree_iter_next(&iter) == NULL);
+    }
+
+    /* The tree can be modified after a build. */
+    duplicate.key = 3;
+    BTASSERT(binary_tree_insert(&tree, &duplicate) == 0);
+    BTASSERT(binary_tree_delete(&tree, 0) == 0);
+    BTASSERT(check_node(tree.root_p, INT_MIN, INT_MAX) > 0);
+
+    /* Unsorted nodes. */
+    nodes_p[3] = &nodes[1];
+    BTASSERT(binary_tree_build(&tree, &nodes_p[0], 4) == -EINVAL);
+
+    return (0);
+}
+
+int test_random(void)
+{
+    static struct binary_tree_node_t random_nodes[256];
+    struct binary_tree_t tree;
+    int i;
+    int key;
+    int count;
+    uint32_t seed;
+
+    BTASSERT(binary_tree_init(&tree) == 0);
+    seed = 1;
+    count = 0;
+
+    /* Random inserts and deletes, validating the tree after each
+       operation. */
+    for (i = 0; i < 4096; i++) {
+        seed = (1103515245 * seed + 12345);
+        key = ((seed >> 16) % membersof(random_nodes));
+
+        if (binary_tree_search(&tree, key) == NULL) {
+            random_nodes[key].key = key;
+            BTASSERT(binary_tree_insert(&tree, &random_nodes[key]) == 0);
+            count++;
+        } else {
+            BTASSERT(binary_tree_delete(&tree, key) == 0);
+            count--;
+        }
+
+        BTASSERT(check_node(tree.root_p, INT_MIN, INT_MAX) >= 0);
+    }
+
+    BTASSERT(count > 0);
+
+    return (0);
+}
+
 int main()
 {
     struct harness_testcase_t testcases[] = {
@@ -150,6 +324,9 @@ int main()
         { test_search, "test_search" },
         { test_delete, "test_delete" },
         { test_search_empty, "test_search_empty" },
+        { test_range, "test_range" },
+        { test_build, "test_build" },
+        { test_random, "test_random" },
         { NULL, NULL }
     };
 
@@ -107,6 +107,99 @@ static int test_reverse_32(void)
     return (0);
 }
 
+static int test_count(void)
+{
+    int i;
+    uint32_t value;
+
+    BTASSERTI(bits_count_32(0), ==, 0);
+    BTASSERTI(bits_count_32(0xffffffff), ==, 32);
+    BTASSERTI(bits_count_32(0x80000001), ==, 2);
+    BTASSERTI(bits_count_32_generic(0), ==, 0);
+
+    value = 0x12345678;
+
+    for (i = 0; i < 64; i++) {
+        BTASSERTI(bits_count_32_generic(value), ==, bits_count_32(value));
+        value = (1103515245 * value + 12345);
+    }
+
+    return (0);
+}
+
+static int test_find_first_last_set(void)
+{
+    int i;
+
+    BTASSERTI(bits_find_first_set_32(0), ==, -1);
+    BTASSERTI(bits_find_last_set_32(0), ==, -1);
+
+    for (i = 0; i < 32; i++) {
+        BTASSERTI(bits_find_first_set_32(1 << i), ==, i);
+        BTASSERTI(bits_find_last_set_32(1 << i), ==, i);
+        BTASSERTI(bits_ctz_32_generic(1 << i), ==, i);
+        BTASSERTI(bits_clz_32_generic(1 << i), ==, 31 - i);
+        BTASSERTI(bits_find_first_set_32(0xffffffff << i), ==, i);
+        BTASSERTI(bits_find_last_set_32(0xffffffff >> i), ==, 31 - i);
+    }
+
+    return (0);
+}
+
+static int test_bitmap(void)
+{
+    BITS_BITMAP(bitmap, 100);
+    int i;
+
+    BTASSERTI(membersof(bitmap), ==, 4);
+    memset(&bitmap[0], 0, sizeof(bitmap));
+
+    BTASSERTI(bits_bitmap_find_first_set(&bitmap[0], 100, 0), ==, -1);
+    BTASSERTI(bits_bitmap_find_first_clear(&bitmap[0], 100, 0), ==, 0);
+    BTASSERTI(bits_bitmap_count(&bitmap[0], 100), ==, 0);
+
+    /* A range within a word. */
+    bits_bitmap_set(&bitmap[0], 3, 4);
+    BTASSERTI(bitmap[0], ==, 0x78);
+    BTASSERTI(bits_bitmap_find_first_set(&bitmap[0], 100, 0), ==, 3);
+    BTASSERTI(bits_bitmap_find_first_set(&bitmap[0], 100, 6), ==, 6);
+    BTASSERTI(bits_bitmap_find_first_set(&bitmap[0], 100, 7), ==, -1);
+
+    /* A range spanning three words. */
+    bits_bitmap_set(&bitmap[0], 30, 40);
+    BTASSERTI(bitmap[0], ==, 0xc0000078);
+    BTASSERTI(bitmap[1], ==, 0xffffffff);
+    BTASSERTI(bitmap[2], ==, 0x3f);
+    BTASSERTI(bits_bitmap_count(&bitmap[0], 100), ==, 44);
+    BTASSERTI(bits_bitmap_find_first_set(&bitmap[0], 100, 7), ==, 30);
+    BTASSERTI(bits_bitmap_find_first_clear(&bitmap[0], 100, 30), ==, 70);
+
+    for (i = 30; i < 70; i++) {
+        BTASSERTI(bits_bitmap_test(&bitmap[0], i), ==, 1);
+    }
+
+    BTASSERTI(bits_bitmap_test(&bitmap[0], 70), ==, 0);
+
+    /* Clear a word aligned range. */
+    bits_bitmap_clear(&bitmap[0], 32, 32);
+    BTASSERTI(bitmap[1], ==, 0);
+    BTASSERTI(bits_bitmap_find_first_set(&bitmap[0], 100, 32), ==, 64);
+    bits_bitmap_clear(&bitmap[0], 0, 100);
+    BTASSERTI(bits_bitmap_count(&bitmap[0], 100), ==, 0);
+
+    /* Bits after the end of the bitmap are ignored. */
+    bitmap[3] = 0xfffffff0;
+    BTASSERTI(bits_bitmap_find_first_set(&bitmap[0], 100, 0), ==, -1);
+    BTASSERTI(bits_bitmap_count(&bitmap[0], 100), ==, 0);
+    bits_bitmap_set(&bitmap[0], 0, 100);
+    BTASSERTI(bits_bitmap_find_first_clear(&bitmap[0], 100, 0), ==, -1);
+    BTASSERTI(bits_bitmap_find_first_set(&bitmap[0], 100, 99), ==, 99);
+    BTASSERTI(bits_bitmap_find_first_set(&bitmap[0], 100, 100), ==, -1);
+    BTASSERTI(bits_bitmap_count(&bitmap[0], 100), ==, 100);
+
+    return (0);
+}
+
 int main()
 {
     struct harness_testcase_t testcases[] = {
@@ -115,6 +208,9 @@ int main()
         { test_reverse_8, "test_reverse_8" },
         { test_reverse_16, "test_reverse_16" },
         { test_reverse_32, "test_reverse_32" },
+        { test_count, "test_count" },
+        { test_find_first_last_set, "test_find_first_last_set" },
+        { test_bitmap, "test_bitmap" },
         { NULL, NULL }
     };
 
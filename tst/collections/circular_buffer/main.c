@@ -185,6 +185,50 @@ int test_array(void)
     return (0);
 }
 
+int test_reserve_commit(void)
+{
+    struct circular_buffer_t foo;
+    char foobuf[8];
+    char buf[8];
+    void *buf_p;
+
+    BTASSERT(circular_buffer_init(&foo, &foobuf[0], sizeof(foobuf)) == 0);
+
+    /* One byte is always unused. */
+    BTASSERTI(circular_buffer_reserve(&foo, &buf_p, 8), ==, 7);
+    BTASSERT(buf_p == &foobuf[0]);
+
+    /* Write five bytes in place. */
+    memcpy(buf_p, "12345", 5);
+    BTASSERTI(circular_buffer_commit(&foo, 5), ==, 5);
+    BTASSERTI(circular_buffer_used_size(&foo), ==, 5);
+    BTASSERTI(circular_buffer_reserve(&foo, &buf_p, 8), ==, 2);
+    BTASSERT(buf_p == &foobuf[5]);
+
+    /* Read four bytes. Three bytes until the end of the buffer. */
+    BTASSERTI(circular_buffer_read(&foo, &buf[0], 4), ==, 4);
+    BTASSERTM(&buf[0], "1234", 4);
+    BTASSERTI(circular_buffer_reserve(&foo, &buf_p, 8), ==, 3);
+    BTASSERT(buf_p == &foobuf[5]);
+    memcpy(buf_p, "678", 3);
+    BTASSERTI(circular_buffer_commit(&foo, 3), ==, 3);
+
+    /* Wrapped around. */
+    BTASSERTI(circular_buffer_reserve(&foo, &buf_p, 8), ==, 3);
+    BTASSERT(buf_p == &foobuf[0]);
+    BTASSERTI(circular_buffer_reserve(&foo, &buf_p, 2), ==, 2);
+    memcpy(buf_p, "9a", 2);
+    BTASSERTI(circular_buffer_commit(&foo, 2), ==, 2);
+    BTASSERTI(circular_buffer_read(&foo, &buf[0], 8), ==, 6);
+    BTASSERTM(&buf[0], "56789a", 6);
+
+    /* Commits are limited to the unused size. */
+    BTASSERTI(circular_buffer_commit(&foo, 9), ==, 7);
+    BTASSERTI(circular_buffer_reserve(&foo, &buf_p, 8), ==, 0);
+
+    return (0);
+}
+
 int test_find(void)
 {
     struct circular_buffer_t foo;
@@ -226,6 +270,47 @@ int test_find(void)
     return (0);
 }
 
+int test_mirror(void)
+{
+#if CONFIG_CIRCULAR_BUFFER_MIRROR == 1
+    struct circular_buffer_t foo;
+    char *buf_p;
+    char data[64];
+    ssize_t size;
+
+    BTASSERT(circular_buffer_mirror_init(&foo, 100) == 0);
+    size = foo.size;
+    BTASSERT(size >= 100);
+
+    /* Move the positions close to the end of the buffer. */
+    BTASSERTI(circular_buffer_reserve(&foo, (void **)&buf_p, size), ==, size - 1);
+    BTASSERTI(circular_buffer_commit(&foo, size - 10), ==, size - 10);
+    BTASSERTI(circular_buffer_skip_front(&foo, size - 10), ==, size - 10);
+
+    /* The reserved span crosses the end of the buffer memory. */
+    BTASSERTI(circular_buffer_reserve(&foo, (void **)&buf_p, 30), ==, 30);
+    memcpy(buf_p, "0123456789abcdefghijklmnopqrst", 30);
+    BTASSERTI(circular_buffer_commit(&foo, 30), ==, 30);
+    BTASSERTI(foo.writepos, ==, 20);
+
+    /* Written data is readable through both mappings. */
+    BTASSERT(memcmp(&foo.buf_p[0], "abcdefghij", 10) == 0);
+
+    BTASSERTI(circular_buffer_array_one(&foo, (void **)&buf_p, 64), ==, 30);
+    BTASSERT(memcmp(buf_p, "0123456789abcdefghijklmnopqrst", 30) == 0);
+    BTASSERTI(circular_buffer_array_two(&foo, (void **)&buf_p, 64), ==, 0);
+
+    BTASSERTI(circular_buffer_read(&foo, &data[0], 64), ==, 30);
+    BTASSERT(memcmp(&data[0], "0123456789abcdefghijklmnopqrst", 30) == 0);
+
+    BTASSERT(circular_buffer_mirror_destroy(&foo) == 0);
+
+    return (0);
+#else
+    return (1);
+#endif
+}
+
 int main()
 {
     struct harness_testcase_t testcases[] = {
@@ -233,6 +318,8 @@ int main()
         { test_skip, "test_skip" },
         { test_array, "test_array" },
         { test_find, "test_find" },
+        { test_reserve_commit, "test_reserve_commit" },
+        { test_mirror, "test_mirror" },
         { NULL, NULL }
     };
 
@@ -0,0 +1,130 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2014-2018, Erik Moqvist
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use, copy,
+ * modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ * This file is part of the Simba project.
+ */
+
+#include "simba.h"
+
+#include "simba.h"
+
+struct my_elem_t {
+    struct dlist_elem_t base;
+    int foo;
+};
+
+static int test_add_remove(void)
+{
+    struct dlist_t list;
+    struct my_elem_t elems[4];
+
+    BTASSERT(dlist_init(&list) == 0);
+    BTASSERT(dlist_peek_head(&list) == NULL);
+    BTASSERT(dlist_remove_head(&list) == NULL);
+
+    BTASSERT(dlist_add_tail(&list, &elems[1]) == 0);
+    BTASSERT(dlist_add_head(&list, &elems[0]) == 0);
+    BTASSERT(dlist_add_tail(&list, &elems[3]) == 0);
+    BTASSERT(dlist_insert_before(&list, &elems[3], &elems[2]) == 0);
+
+    /* 0, 1, 2, 3. */
+    BTASSERT(dlist_peek_head(&list) == &elems[0]);
+    BTASSERT(dlist_next(&elems[0]) == &elems[1]);
+    BTASSERT(dlist_next(&elems[1]) == &elems[2]);
+    BTASSERT(dlist_next(&elems[2]) == &elems[3]);
+    BTASSERT(dlist_next(&elems[3]) == NULL);
+
+    /* Remove from the middle, the tail and the head. */
+    BTASSERT(dlist_remove(&list, &elems[1]) == &elems[1]);
+    BTASSERT(dlist_remove(&list, &elems[1]) == NULL);
+    BTASSERT(dlist_remove(&list, &elems[3]) == &elems[3]);
+    BTASSERT(list.tail_p == &elems[2].base);
+    BTASSERT(dlist_remove(&list, &elems[0]) == &elems[0]);
+    BTASSERT(dlist_peek_head(&list) == &elems[2]);
+    BTASSERT(dlist_remove_head(&list) == &elems[2]);
+    BTASSERT(dlist_peek_head(&list) == NULL);
+    BTASSERT(list.tail_p == NULL);
+
+    /* Add again. */
+    BTASSERT(dlist_insert_before(&list, NULL, &elems[3]) == 0);
+    BTASSERT(dlist_insert_before(&list, &elems[3], &elems[0]) == 0);
+    BTASSERT(dlist_remove_head(&list) == &elems[0]);
+    BTASSERT(dlist_remove_head(&list) == &elems[3]);
+    BTASSERT(dlist_remove_head(&list) == NULL);
+
+    return (0);
+}
+
+static int test_iterate_and_remove(void)
+{
+    struct dlist_t list;
+    struct dlist_iter_t iter;
+    struct my_elem_t elems[5];
+    struct my_elem_t *elem_p;
+    int i;
+
+    BTASSERT(dlist_init(&list) == 0);
+
+    for (i = 0; i < membersof(elems); i++) {
+        elems[i].foo = i;
+        BTASSERT(dlist_add_tail(&list, &elems[i]) == 0);
+    }
+
+    /* Remove all even elements while iterating. */
+    BTASSERT(dlist_iter_init(&iter, &list) == 0);
+    i = 0;
+
+    while ((elem_p = dlist_iter_next(&iter)) != NULL) {
+        BTASSERTI(elem_p->foo, ==, i);
+
+        if ((elem_p->foo % 2) == 0) {
+            BTASSERT(dlist_remove(&list, elem_p) == elem_p);
+        }
+
+        i++;
+    }
+
+    BTASSERTI(i, ==, 5);
+    BTASSERT(dlist_remove_head(&list) == &elems[1]);
+    BTASSERT(dlist_remove_head(&list) == &elems[3]);
+    BTASSERT(dlist_remove_head(&list) == NULL);
+
+    return (0);
+}
+
+int main()
+{
+    struct harness_testcase_t testcases[] = {
+        { test_add_remove, "test_add_remove" },
+        { test_iterate_and_remove, "test_iterate_and_remove" },
+        { NULL, NULL }
+    };
+
+    sys_start();
+
+    harness_run(testcases);
+
+    return (0);
+}
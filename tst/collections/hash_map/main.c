@@ -112,11 +112,166 @@ int test_pointer_as_key(void)
     return (0);
 }
 
+static uint32_t hash_collide(const void *key_p)
+{
+    return (0);
+}
+
+int test_open_string_keys(void)
+{
+    struct hash_map_open_t map;
+    struct hash_map_open_entry_t entries[8];
+    void *value_p;
+    int a, b, c;
+    char key[8];
+
+    BTASSERT(hash_map_open_init(&map,
+                                &entries[0],
+                                membersof(entries),
+                                hash_map_open_hash_string,
+                                hash_map_open_equal_string,
+                                NULL) == 0);
+
+    BTASSERT(hash_map_open_add(&map, "/foo", &a) == 0);
+    BTASSERT(hash_map_open_add(&map, "/bar", &b) == 0);
+    BTASSERT(hash_map_open_add(&map, "/bar", &c) == 0);
+    BTASSERTI(hash_map_open_length(&map), ==, 2);
+
+    /* The key is compared by value, not by pointer. */
+    strcpy(key, "/bar");
+    BTASSERT(hash_map_open_get(&map, key, &value_p) == 0);
+    BTASSERT(value_p == &c);
+    BTASSERT(hash_map_open_get(&map, "/foo", &value_p) == 0);
+    BTASSERT(value_p == &a);
+    BTASSERT(hash_map_open_get(&map, "/fie", &value_p) == -ENODATA);
+
+    BTASSERT(hash_map_open_remove(&map, "/foo") == 0);
+    BTASSERT(hash_map_open_remove(&map, "/foo") == -ENODATA);
+    BTASSERT(hash_map_open_get(&map, "/foo", &value_p) == -ENODATA);
+    BTASSERTI(hash_map_open_length(&map), ==, 1);
+
+    /* Fill the map. One entry is always kept empty. */
+    BTASSERT(hash_map_open_add(&map, "1", &a) == 0);
+    BTASSERT(hash_map_open_add(&map, "2", &a) == 0);
+    BTASSERT(hash_map_open_add(&map, "3", &a) == 0);
+    BTASSERT(hash_map_open_add(&map, "4", &a) == 0);
+    BTASSERT(hash_map_open_add(&map, "5", &a) == 0);
+    BTASSERT(hash_map_open_add(&map, "6", &a) == 0);
+    BTASSERT(hash_map_open_add(&map, "7", &a) == -ENOMEM);
+    BTASSERT(hash_map_open_add(&map, "6", &b) == 0);
+    BTASSERTI(hash_map_open_length(&map), ==, 7);
+
+    return (0);
+}
+
+int test_open_collisions(void)
+{
+    struct hash_map_open_t map;
+    struct hash_map_open_entry_t entries[8];
+    void *value_p;
+    int values[7];
+    char keys[7][2];
+    int i;
+
+    BTASSERT(hash_map_open_init(&map,
+                                &entries[0],
+                                membersof(entries),
+                                hash_collide,
+                                hash_map_open_equal_string,
+                                NULL) == 0);
+
+    for (i = 0; i < membersof(keys); i++) {
+        keys[i][0] = ('a' + i);
+        keys[i][1] = '\0';
+        BTASSERT(hash_map_open_add(&map, &keys[i][0], &values[i]) == 0);
+    }
+
+    /* Remove from the middle of the probe sequence. */
+    BTASSERT(hash_map_open_remove(&map, "c") == 0);
+    BTASSERT(hash_map_open_remove(&map, "a") == 0);
+
+    for (i = 0; i < membersof(keys); i++) {
+        if ((i == 0) || (i == 2)) {
+            BTASSERT(hash_map_open_get(&map, &keys[i][0], &value_p)
+                     == -ENODATA);
+        } else {
+            BTASSERT(hash_map_open_get(&map, &keys[i][0], &value_p) == 0);
+            BTASSERT(value_p == &values[i]);
+        }
+    }
+
+    return (0);
+}
+
+int test_open_resize(void)
+{
+    struct hash_map_open_t map;
+    struct hash_map_open_entry_t entries[4];
+    struct heap_t heap;
+    static uint64_t heap_buf[32768 / sizeof(uint64_t)];
+    size_t sizes[HEAP_FIXED_SIZES_MAX] = {
+        8, 16, 32, 64, 128, 256, 512, 1024
+    };
+    static char keys[200][8];
+    void *value_p;
+    int i;
+    int j;
+
+    BTASSERT(heap_init(&heap, &heap_buf[0], sizeof(heap_buf), sizes) == 0);
+    BTASSERT(hash_map_open_init(&map,
+                                &entries[0],
+                                membersof(entries),
+                                hash_map_open_hash_string,
+                                hash_map_open_equal_string,
+                                &heap) == 0);
+
+    /* Grow the map a couple of times. All keys are found during and
+       after each resize. */
+    for (i = 0; i < membersof(keys); i++) {
+        std_sprintf(&keys[i][0], FSTR("k%d"), i);
+        BTASSERT(hash_map_open_add(&map, &keys[i][0], &keys[i][1]) == 0);
+        BTASSERTI(hash_map_open_length(&map), ==, i + 1);
+
+        for (j = 0; j <= i; j++) {
+            BTASSERT(hash_map_open_get(&map, &keys[j][0], &value_p) == 0);
+            BTASSERT(value_p == &keys[j][1]);
+        }
+    }
+
+    BTASSERTI(map.table.mask + 1, >=, 256);
+
+    /* Remove every second key. */
+    for (i = 0; i < membersof(keys); i += 2) {
+        BTASSERT(hash_map_open_remove(&map, &keys[i][0]) == 0);
+    }
+
+    for (i = 0; i < membersof(keys); i++) {
+        if ((i % 2) == 0) {
+            BTASSERT(hash_map_open_get(&map, &keys[i][0], &value_p)
+                     == -ENODATA);
+        } else {
+            BTASSERT(hash_map_open_get(&map, &keys[i][0], &value_p) == 0);
+        }
+    }
+
+    BTASSERTI(hash_map_open_length(&map), ==, membersof(keys) / 2);
+
+    /* Back to the initial table. */
+    BTASSERT(hash_map_open_destroy(&map) == 0);
+    BTASSERT(map.table.entries_p == &entries[0]);
+    BTASSERTI(hash_map_open_length(&map), ==, 0);
+
+    return (0);
+}
+
 int main()
 {
     struct harness_testcase_t testcases[] = {
         { test_add_get_remove, "test_add_get_remove" },
         { test_pointer_as_key, "test_pointer_as_key" },
+        { test_open_string_keys, "test_open_string_keys" },
+        { test_open_collisions, "test_open_collisions" },
+        { test_open_resize, "test_open_resize" },
         { NULL, NULL }
     };
 
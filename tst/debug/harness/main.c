@@ -30,6 +30,12 @@
 #include "my_module.h"
 #include "my_module_mock.h"
 
+#if CONFIG_HARNESS_MOCK_MALLOC == 1
+#    define MOCK_MANY_ENTRIES (2 * CONFIG_HARNESS_MOCK_ENTRIES_MAX)
+#else
+#    define MOCK_MANY_ENTRIES (CONFIG_HARNESS_MOCK_ENTRIES_MAX / 4)
+#endif
+
 struct arg_t {
     size_t offset;
     size_t length;
@@ -274,6 +280,46 @@ static int test_mock_cwrite(void)
     return (0);
 }
 
+static int test_mock_many(void)
+{
+    int value;
+    int i;
+
+    /* More entries than fits in the mock heap if allocated with
+       malloc() when it is full. */
+    for (i = 0; i < MOCK_MANY_ENTRIES; i++) {
+        value = i;
+        BTASSERT(harness_mock_write("many(a)",
+                                    &value,
+                                    sizeof(value)) == sizeof(value));
+        value = -i;
+        BTASSERT(harness_mock_write("many(b)",
+                                    &value,
+                                    sizeof(value)) == sizeof(value));
+    }
+
+    /* Entries are read in write order per id. */
+    for (i = 0; i < MOCK_MANY_ENTRIES; i++) {
+        BTASSERT(harness_mock_read("many(b)",
+                                   &value,
+                                   sizeof(value)) == sizeof(value));
+        BTASSERTI(value, ==, -i);
+    }
+
+    for (i = 0; i < MOCK_MANY_ENTRIES; i++) {
+        BTASSERT(harness_mock_read("many(a)",
+                                   &value,
+                                   sizeof(value)) == sizeof(value));
+        BTASSERTI(value, ==, i);
+    }
+
+    BTASSERTI(harness_mock_try_read("many(a)",
+                                    &value,
+                                    sizeof(value)), ==, -ENOENT);
+
+    return (0);
+}
+
 static int test_stub(void)
 {
     mock_write_foo(0);
@@ -286,6 +332,53 @@ static int test_stub(void)
     return (0);
 }
 
+static int benchmark_iterations_total;
+
+static int benchmark_loop(int iterations)
+{
+    volatile int value;
+    int i;
+
+    value = 0;
+
+    for (i = 0; i < iterations; i++) {
+        value++;
+    }
+
+    benchmark_iterations_total += iterations;
+
+    return (value == iterations ? 0 : -1);
+}
+
+static int benchmark_fail(int iterations)
+{
+    return (-EIO);
+}
+
+static int test_benchmark(void)
+{
+    struct harness_benchmark_t benchmarks[] = {
+        { benchmark_loop, "benchmark_loop" },
+        { NULL, NULL }
+    };
+    struct harness_benchmark_t failing_benchmarks[] = {
+        { benchmark_fail, "benchmark_fail" },
+        { benchmark_loop, "benchmark_loop" },
+        { NULL, NULL }
+    };
+
+    benchmark_iterations_total = 0;
+    BTASSERT(harness_run_benchmarks(&benchmarks[0]) == 0);
+    BTASSERT(benchmark_iterations_total > CONFIG_HARNESS_BENCHMARK_SAMPLES);
+
+    /* The remaining benchmarks are run after a failure. */
+    benchmark_iterations_total = 0;
+    BTASSERT(harness_run_benchmarks(&failing_benchmarks[0]) == -1);
+    BTASSERT(benchmark_iterations_total > CONFIG_HARNESS_BENCHMARK_SAMPLES);
+
+    return (0);
+}
+
 /* Overrides the weak definition in my_module_mock.c. */
 int STUB(bar)()
 {
@@ -302,7 +395,9 @@ int main()
         { test_mock_wait_notify, "test_mock_wait_notify" },
         { test_mock_mwrite, "test_mock_mwrite" },
         { test_mock_cwrite, "test_mock_cwrite" },
+        { test_mock_many, "test_mock_many" },
         { test_stub, "test_stub" },
+        { test_benchmark, "test_benchmark" },
         { NULL, NULL }
     };
 
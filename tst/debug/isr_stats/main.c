@@ -0,0 +1,150 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2014-2018, Erik Moqvist
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use, copy,
+ * modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ * This file is part of the Simba project.
+ */
+
+#include "simba.h"
+
+/* Busy wait for given number of cycle counter ticks, microseconds on
+   Linux. */
+static void busy_wait(uint32_t ticks)
+{
+    uint32_t start;
+
+    start = isr_stats_now_isr();
+
+    while ((isr_stats_now_isr() - start) < ticks);
+}
+
+/* Simulated interrupt service routine, taking given time to execute. */
+static void isr_foo(uint32_t ticks)
+{
+    ISR_STATS_BEGIN_ISR(stats, "foo");
+    busy_wait(ticks);
+    ISR_STATS_END_ISR(stats);
+}
+
+static int test_init(void)
+{
+    BTASSERT(isr_stats_module_init() == 0);
+    BTASSERT(isr_stats_module_init() == 0);
+
+    return (0);
+}
+
+static int test_isr(void)
+{
+    char command[64];
+    struct queue_t out;
+    char buf[512];
+
+    BTASSERT(queue_init(&out, &buf[0], sizeof(buf)) == 0);
+
+    isr_foo(100);
+    isr_foo(5000);
+    isr_foo(100);
+
+    strcpy(command, "/debug/isr/list");
+    BTASSERT(fs_call(command, NULL, &out, NULL) == 0);
+    BTASSERTI(harness_expect(&out, "NAME       COUNT", NULL), >, 0);
+    BTASSERTI(harness_expect(&out, "foo           3", NULL), >, 0);
+    BTASSERTI(harness_expect(&out, "masked: count ", NULL), >, 0);
+
+    return (0);
+}
+
+static int test_masked(void)
+{
+    struct isr_stats_masked_t masked;
+    uint32_t max_time;
+
+    BTASSERT(isr_stats_reset() == 0);
+
+    /* Mask interrupts for a short time. */
+    sys_lock();
+    busy_wait(100);
+    sys_unlock();
+
+    BTASSERT(isr_stats_get_masked(&masked) == 0);
+    BTASSERTI(masked.count, >=, 1);
+    BTASSERTI(masked.max_time, >=, 100);
+    BTASSERT(masked.max_caller_p != NULL);
+    max_time = masked.max_time;
+
+    /* Mask interrupts for a longer time. The maximum never
+       decreases. */
+    sys_lock();
+    busy_wait(5000);
+    sys_unlock();
+
+    BTASSERT(isr_stats_get_masked(&masked) == 0);
+    BTASSERTI(masked.count, >=, 2);
+    BTASSERTI(masked.max_time, >=, 5000);
+    BTASSERTI(masked.max_time, >=, max_time);
+    BTASSERT(masked.max_caller_p != NULL);
+
+    return (0);
+}
+
+static int test_reset(void)
+{
+    char command[64];
+    struct queue_t out;
+    char buf[512];
+
+    BTASSERT(queue_init(&out, &buf[0], sizeof(buf)) == 0);
+
+    strcpy(command, "/debug/isr/reset");
+    BTASSERT(fs_call(command, NULL, &out, NULL) == 0);
+
+    strcpy(command, "/debug/isr/list");
+    BTASSERT(fs_call(command, NULL, &out, NULL) == 0);
+    BTASSERTI(harness_expect(&out, "foo           0", NULL), >, 0);
+
+    isr_foo(10);
+
+    BTASSERT(fs_call(command, NULL, &out, NULL) == 0);
+    BTASSERTI(harness_expect(&out, "foo           1", NULL), >, 0);
+
+    return (0);
+}
+
+int main()
+{
+    struct harness_testcase_t testcases[] = {
+        { test_init, "test_init" },
+        { test_isr, "test_isr" },
+        { test_masked, "test_masked" },
+        { test_reset, "test_reset" },
+        { NULL, NULL }
+    };
+
+    sys_start();
+
+    harness_run(testcases);
+
+    return (0);
+}
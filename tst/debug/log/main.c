@@ -72,6 +72,57 @@ int test_print(void)
     return (0);
 }
 
+static int evaluated;
+
+static int evaluate(int value)
+{
+    evaluated++;
+
+    return (value);
+}
+
+int test_print_macro(void)
+{
+    struct log_object_t foo;
+    int mask;
+
+    BTASSERT(log_object_init(&foo,
+                             "foo",
+                             LOG_UPTO(WARNING)) == 0);
+
+    /* Enabled level. */
+    evaluated = 0;
+    LOG_OBJECT_PRINT(&foo, LOG_ERROR, FSTR("a = %d\r\n"), evaluate(1));
+    BTASSERTI(evaluated, ==, 1);
+
+    /* Disabled in the log object mask. The arguments are not
+       evaluated. */
+    LOG_OBJECT_PRINT(&foo, LOG_INFO, FSTR("b = %d\r\n"), evaluate(2));
+    BTASSERTI(evaluated, ==, 1);
+
+    /* All levels are kept by default. */
+    BTASSERT(log_object_set_log_mask(&foo, LOG_ALL) == 0);
+    LOG_OBJECT_PRINT(&foo, LOG_INFO, FSTR("c = %d\r\n"), evaluate(3));
+    BTASSERTI(evaluated, ==, 2);
+    LOG_OBJECT_PRINT(&foo, LOG_DEBUG, FSTR("d = %d\r\n"), evaluate(4));
+    BTASSERTI(evaluated, ==, 3);
+
+    /* The thread log mask is used without a log object. */
+    mask = thrd_get_log_mask();
+    thrd_set_log_mask(thrd_self(), LOG_MASK(ERROR));
+    LOG_OBJECT_PRINT(NULL, LOG_WARNING, FSTR("e = %d\r\n"), evaluate(5));
+    BTASSERTI(evaluated, ==, 3);
+    LOG_OBJECT_PRINT(NULL, LOG_ERROR, FSTR("f = %d\r\n"), evaluate(6));
+    BTASSERTI(evaluated, ==, 4);
+    thrd_set_log_mask(thrd_self(), mask);
+
+    BTASSERT(log_object_is_level_enabled(&foo, LOG_DEBUG) == 1);
+    BTASSERT(log_object_set_log_mask(&foo, LOG_NONE) == 0);
+    BTASSERT(log_object_is_level_enabled(&foo, LOG_FATAL) == 0);
+
+    return (0);
+}
+
 int test_object(void)
 {
     struct log_object_t foo;
@@ -162,6 +213,48 @@ int test_log_mask(void)
     return (0);
 }
 
+int test_deferred(void)
+{
+    struct log_object_t foo;
+    struct log_handler_t handler;
+    struct queue_t queue;
+    uint8_t buf[128];
+
+    BTASSERT(log_object_init(&foo, "foo", LOG_UPTO(INFO)) == 0);
+    BTASSERT(queue_init(&queue, &buf[0], sizeof(buf)) == 0);
+    BTASSERT(log_handler_init(&handler, &queue) == 0);
+    BTASSERT(log_add_handler(&handler) == 0);
+
+    /* Written immediately when deferred logging is disabled. */
+    BTASSERTI(log_object_print_deferred(&foo,
+                                        LOG_INFO,
+                                        FSTR("x = %d\r\n"),
+                                        1), ==, 2);
+    BTASSERT(harness_expect(&queue, "main:foo: x = 1\r\n", NULL) > 0);
+    BTASSERTI(log_deferred_flush(), ==, 0);
+
+    sys_lock();
+    BTASSERTI(log_object_print_isr(&foo, LOG_INFO, FSTR("isr\r\n")),
+              ==,
+              -ENOSYS);
+    sys_unlock();
+
+    BTASSERT(log_remove_handler(&handler) == 0);
+
+    return (0);
+}
+
+int test_writer(void)
+{
+    static uint8_t stack[64];
+
+    /* The log writer thread is disabled by default. */
+    BTASSERTI(log_writer_start(&stack[0], sizeof(stack)), ==, -ENOSYS);
+    BTASSERT(log_set_thread_staging(NULL) == NULL);
+
+    return (0);
+}
+
 int test_fs(void)
 {
     char command[64];
@@ -232,9 +325,12 @@ int main()
     struct harness_testcase_t testcases[] = {
         { test_init, "test_init" },
         { test_print, "test_print" },
+        { test_print_macro, "test_print_macro" },
         { test_object, "test_object" },
         { test_handler, "test_handler" },
         { test_log_mask, "test_log_mask" },
+        { test_deferred, "test_deferred" },
+        { test_writer, "test_writer" },
         { test_fs, "test_fs" },
         { NULL, NULL }
     };
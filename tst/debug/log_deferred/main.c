@@ -0,0 +1,269 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2014-2018, Erik Moqvist
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use, copy,
+ * modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ * This file is part of the Simba project.
+ */
+
+
+#include "simba.h"
+
+/* A channel accepting binary deferred log entries. */
+struct binary_chan_t {
+    struct chan_t base;
+    uint8_t buf[256];
+    size_t size;
+};
+
+static ssize_t binary_chan_write(void *self_p,
+                                 const void *buf_p,
+                                 size_t size)
+{
+    struct binary_chan_t *chan_p;
+
+    chan_p = self_p;
+
+    if (chan_p->size + size > sizeof(chan_p->buf)) {
+        return (-ENOMEM);
+    }
+
+    memcpy(&chan_p->buf[chan_p->size], buf_p, size);
+    chan_p->size += size;
+
+    return (size);
+}
+
+static int binary_chan_control(void *self_p, int operation)
+{
+    return (operation == CHAN_CONTROL_LOG_DEFERRED_BEGIN);
+}
+
+static int test_init(void)
+{
+    BTASSERT(log_module_init() == 0);
+
+    return (0);
+}
+
+static int test_deferred(void)
+{
+    struct log_object_t foo;
+    struct log_handler_t handler;
+    struct queue_t queue;
+    uint8_t buf[256];
+    char *expected_p;
+
+    BTASSERT(log_object_init(&foo, "foo", LOG_UPTO(INFO)) == 0);
+    BTASSERT(queue_init(&queue, &buf[0], sizeof(buf)) == 0);
+    BTASSERT(log_handler_init(&handler, &queue) == 0);
+    BTASSERT(log_add_handler(&handler) == 0);
+    thrd_set_log_mask(thrd_self(), LOG_UPTO(INFO));
+
+    /* Nothing is written until flushed. */
+    BTASSERT(log_object_print_deferred(&foo,
+                                       LOG_INFO,
+                                       FSTR("x = %d, y = %lu, z = 0x%02x\r\n"),
+                                       -1,
+                                       100000ul,
+                                       10) == 1);
+    BTASSERT(log_object_print_deferred(&foo,
+                                       LOG_WARNING,
+                                       FSTR("%s %S %c %-4s| 100%%\r\n"),
+                                       "foo",
+                                       FSTR("bar"),
+                                       'c',
+                                       "fie") == 1);
+    BTASSERT(log_object_print_deferred(&foo,
+                                       LOG_DEBUG,
+                                       FSTR("filtered\r\n")) == 0);
+    BTASSERT(log_object_print_deferred(NULL,
+                                       LOG_ERROR,
+                                       FSTR("no arguments\r\n")) == 1);
+    BTASSERTI(queue_size(&queue), ==, 0);
+
+    /* Too many arguments. */
+    BTASSERTI(log_object_print_deferred(&foo,
+                                        LOG_INFO,
+                                        FSTR("%d %d %d %d %d\r\n"),
+                                        1, 2, 3, 4, 5), ==, -EINVAL);
+
+    /* Format the entries on the device. */
+    BTASSERTI(log_deferred_flush(), ==, 3);
+    BTASSERTI(log_deferred_flush(), ==, 0);
+
+    expected_p = ":info:main:foo: x = -1, y = 100000, z = 0x0a\r\n";
+    BTASSERT(harness_expect(&queue, expected_p, NULL) > 0);
+    expected_p = ":warning:main:foo: foo bar c fie | 100%\r\n";
+    BTASSERT(harness_expect(&queue, expected_p, NULL) > 0);
+    expected_p = ":error:main:default: no arguments\r\n";
+    BTASSERT(harness_expect(&queue, expected_p, NULL) > 0);
+
+    BTASSERT(log_remove_handler(&handler) == 0);
+
+    return (0);
+}
+
+static int test_deferred_binary(void)
+{
+    struct log_object_t foo;
+    struct log_handler_t handler;
+    struct binary_chan_t chan;
+    static const uint8_t expected[] = {
+        /* Level, thread name and log object name. */
+        LOG_INFO, 'm', 'a', 'i', 'n', '\0', 'f', 'o', 'o', '\0',
+        /* Format string. */
+        '%', 'l', 'd', ' ', '%', 'u', ' ', '%', 's', '\n', '\0',
+        /* Arguments. */
+        0xff, 0xff, 0xff, 0xfe, 0x00, 0x00, 0x01, 0x02, 'b', 'a', 'r', '\0'
+    };
+
+    BTASSERT(log_object_init(&foo, "foo", LOG_UPTO(INFO)) == 0);
+    BTASSERT(chan_init(&chan.base,
+                       chan_read_null,
+                       binary_chan_write,
+                       chan_size_null) == 0);
+    chan_set_control_cb(&chan.base, binary_chan_control);
+    chan.size = 0;
+    BTASSERT(log_handler_init(&handler, &chan) == 0);
+    BTASSERT(log_add_handler(&handler) == 0);
+
+    BTASSERT(log_object_print_deferred(&foo,
+                                       LOG_INFO,
+                                       FSTR("%ld %u %s\n"),
+                                       -2l,
+                                       0x102,
+                                       "bar") == 1);
+    BTASSERTI(log_deferred_flush(), ==, 1);
+
+    /* Seconds and milliseconds followed by the expected data. */
+    BTASSERTI(chan.size, ==, 6 + sizeof(expected));
+    BTASSERTM(&chan.buf[6], &expected[0], sizeof(expected));
+
+    BTASSERT(log_remove_handler(&handler) == 0);
+
+    return (0);
+}
+
+static int test_deferred_overwritten(void)
+{
+    struct log_object_t foo;
+    struct log_handler_t handler;
+    struct queue_t queue;
+    uint8_t buf[512];
+    int i;
+
+    BTASSERT(log_object_init(&foo, "foo", LOG_UPTO(INFO)) == 0);
+    BTASSERT(queue_init(&queue, &buf[0], sizeof(buf)) == 0);
+    BTASSERT(log_handler_init(&handler, &queue) == 0);
+    BTASSERT(log_add_handler(&handler) == 0);
+
+    /* The buffer has room for 8 entries. */
+    for (i = 0; i < 10; i++) {
+        BTASSERT(log_object_print_deferred(&foo,
+                                           LOG_INFO,
+                                           FSTR("i = %d\r\n"),
+                                           i) == 1);
+    }
+
+    BTASSERTI(log_deferred_flush(), ==, 8);
+
+    /* The two oldest entries are overwritten. */
+    BTASSERT(harness_expect(&queue, "foo: i = 2\r\n", NULL) > 0);
+    BTASSERT(harness_expect(&queue, "foo: i = 9\r\n", NULL) > 0);
+    BTASSERT(harness_expect(&queue,
+                            "log: 2 deferred log entries overwritten\r\n",
+                            NULL) > 0);
+
+    BTASSERT(log_remove_handler(&handler) == 0);
+
+    return (0);
+}
+
+static int test_isr(void)
+{
+    struct log_object_t foo;
+    struct log_handler_t handler;
+    struct queue_t queue;
+    uint8_t buf[128];
+
+    BTASSERT(log_object_init(&foo, "foo", LOG_UPTO(INFO)) == 0);
+    BTASSERT(queue_init(&queue, &buf[0], sizeof(buf)) == 0);
+    BTASSERT(log_handler_init(&handler, &queue) == 0);
+    BTASSERT(log_add_handler(&handler) == 0);
+
+    /* Log with the system lock taken, as in an interrupt handler. */
+    sys_lock();
+    BTASSERT(log_object_print_isr(&foo,
+                                  LOG_INFO,
+                                  FSTR("isr %d\r\n"),
+                                  5) == 1);
+    BTASSERT(log_object_print_isr(&foo,
+                                  LOG_DEBUG,
+                                  FSTR("filtered\r\n")) == 0);
+    sys_unlock();
+
+    BTASSERTI(log_deferred_flush(), ==, 1);
+    BTASSERT(harness_expect(&queue, ":info:isr:foo: isr 5\r\n", NULL) > 0);
+
+    BTASSERT(log_remove_handler(&handler) == 0);
+
+    return (0);
+}
+
+static int test_fs(void)
+{
+    char command[64];
+    struct queue_t queue;
+    uint8_t buf[64];
+
+    BTASSERT(queue_init(&queue, &buf[0], sizeof(buf)) == 0);
+
+    strcpy(command, "/debug/log/flush");
+    BTASSERT(fs_call(command, NULL, &queue, NULL) == 0);
+
+    strcpy(command, "/debug/log/flush d");
+    BTASSERT(fs_call(command, NULL, &queue, NULL) == -EINVAL);
+    BTASSERT(harness_expect(&queue, "Usage: flush\r\n", NULL) > 0);
+
+    return (0);
+}
+
+int main()
+{
+    struct harness_testcase_t testcases[] = {
+        { test_init, "test_init" },
+        { test_deferred, "test_deferred" },
+        { test_deferred_binary, "test_deferred_binary" },
+        { test_deferred_overwritten, "test_deferred_overwritten" },
+        { test_isr, "test_isr" },
+        { test_fs, "test_fs" },
+        { NULL, NULL }
+    };
+
+    sys_start();
+
+    harness_run(testcases);
+
+    return (0);
+}
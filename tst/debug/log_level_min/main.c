@@ -0,0 +1,97 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2014-2018, Erik Moqvist
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use, copy,
+ * modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ * This file is part of the Simba project.
+ */
+
+
+#include "simba.h"
+
+static int evaluated;
+
+static int evaluate(int value)
+{
+    evaluated++;
+
+    return (value);
+}
+
+static int test_print_macro(void)
+{
+    struct log_object_t foo;
+    int mask;
+
+    BTASSERT(log_module_init() == 0);
+    BTASSERT(log_object_init(&foo,
+                             "foo",
+                             LOG_UPTO(WARNING)) == 0);
+
+    /* Enabled level. */
+    evaluated = 0;
+    LOG_OBJECT_PRINT(&foo, LOG_ERROR, FSTR("a = %d\r\n"), evaluate(1));
+    BTASSERTI(evaluated, ==, 1);
+
+    /* Disabled in the log object mask. The arguments are not
+       evaluated. */
+    LOG_OBJECT_PRINT(&foo, LOG_INFO, FSTR("b = %d\r\n"), evaluate(2));
+    BTASSERTI(evaluated, ==, 1);
+
+    /* Less severe than CONFIG_LOG_LEVEL_MIN, and removed even though
+       enabled in the log object mask. */
+    BTASSERT(log_object_set_log_mask(&foo, LOG_ALL) == 0);
+    LOG_OBJECT_PRINT(&foo, LOG_INFO, FSTR("c = %d\r\n"), evaluate(3));
+    BTASSERTI(evaluated, ==, 2);
+    LOG_OBJECT_PRINT(&foo, LOG_DEBUG, FSTR("d = %d\r\n"), evaluate(4));
+    BTASSERTI(evaluated, ==, 2);
+
+    /* The thread log mask is used without a log object. */
+    mask = thrd_get_log_mask();
+    thrd_set_log_mask(thrd_self(), LOG_MASK(ERROR));
+    LOG_OBJECT_PRINT(NULL, LOG_WARNING, FSTR("e = %d\r\n"), evaluate(5));
+    BTASSERTI(evaluated, ==, 2);
+    LOG_OBJECT_PRINT(NULL, LOG_ERROR, FSTR("f = %d\r\n"), evaluate(6));
+    BTASSERTI(evaluated, ==, 3);
+    thrd_set_log_mask(thrd_self(), mask);
+
+    BTASSERT(log_object_is_level_enabled(&foo, LOG_DEBUG) == 1);
+    BTASSERT(log_object_set_log_mask(&foo, LOG_NONE) == 0);
+    BTASSERT(log_object_is_level_enabled(&foo, LOG_FATAL) == 0);
+
+    return (0);
+}
+
+int main()
+{
+    struct harness_testcase_t testcases[] = {
+        { test_print_macro, "test_print_macro" },
+        { NULL, NULL }
+    };
+
+    sys_start();
+
+    harness_run(testcases);
+
+    return (0);
+}
@@ -0,0 +1,121 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2014-2018, Erik Moqvist
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use, copy,
+ * modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ * This file is part of the Simba project.
+ */
+
+
+#include "simba.h"
+
+static THRD_STACK(writer_stack, 1024);
+static struct log_staging_t staging;
+static uint8_t staging_buf[128];
+
+static int test_writer(void)
+{
+    struct log_object_t foo;
+    struct log_handler_t handler;
+    struct queue_t queue;
+    uint8_t buf[256];
+    char expected[64];
+    int i;
+    int staged;
+
+    BTASSERT(log_module_init() == 0);
+    BTASSERT(log_object_init(&foo, "foo", LOG_UPTO(INFO)) == 0);
+    BTASSERT(queue_init(&queue, &buf[0], sizeof(buf)) == 0);
+    BTASSERT(log_handler_init(&handler, &queue) == 0);
+    BTASSERT(log_add_handler(&handler) == 0);
+    BTASSERT(log_staging_init(&staging,
+                              &staging_buf[0],
+                              sizeof(staging_buf)) == 0);
+    BTASSERT(log_set_thread_staging(&staging) == NULL);
+
+    /* Written to the handlers until the writer thread is started. */
+    BTASSERTI(log_object_print(&foo, LOG_INFO, FSTR("direct\r\n")), ==, 2);
+    BTASSERT(harness_expect(&queue, "main:foo: direct\r\n", NULL) > 0);
+
+    BTASSERT(log_writer_start(&writer_stack, sizeof(writer_stack)) == 0);
+    BTASSERT(log_writer_start(&writer_stack,
+                              sizeof(writer_stack)) == -EBUSY);
+
+    /* The writer thread has lower priority than this thread, and
+       writes the entry when this thread waits for it. */
+    BTASSERTI(log_object_print(&foo, LOG_INFO, FSTR("staged %d\r\n"), 1),
+              ==,
+              1);
+    BTASSERTI(queue_size(&queue), ==, 0);
+    BTASSERT(harness_expect(&queue, "main:foo: staged 1\r\n", NULL) > 0);
+
+    /* Entries are dropped when the staging buffer is full. */
+    staged = 0;
+
+    for (i = 0; i < 8; i++) {
+        if (log_object_print(&foo,
+                             LOG_INFO,
+                             FSTR("i = %d\r\n"),
+                             i) == 1) {
+            staged++;
+        }
+    }
+
+    BTASSERT(staged > 0);
+    BTASSERTI(staging.dropped, ==, 8 - staged);
+    std_sprintf(&expected[0],
+                FSTR(":warning:log:log: %d log entries dropped\r\n"),
+                8 - staged);
+    BTASSERT(harness_expect(&queue, "main:foo: i = 0\r\n", NULL) > 0);
+    BTASSERT(harness_expect(&queue, &expected[0], NULL) > 0);
+
+    /* Entries logged from interrupt context are flushed by the
+       writer thread. */
+    sys_lock();
+    BTASSERT(log_object_print_isr(&foo, LOG_INFO, FSTR("isr\r\n")) == 1);
+    sys_unlock();
+    BTASSERT(harness_expect(&queue, ":info:isr:foo: isr\r\n", NULL) > 0);
+
+    /* Unbind the staging buffer. */
+    BTASSERT(log_set_thread_staging(NULL) == &staging);
+    BTASSERTI(log_object_print(&foo, LOG_INFO, FSTR("direct\r\n")), ==, 2);
+    BTASSERT(harness_expect(&queue, "main:foo: direct\r\n", NULL) > 0);
+
+    BTASSERT(log_remove_handler(&handler) == 0);
+
+    return (0);
+}
+
+int main()
+{
+    struct harness_testcase_t testcases[] = {
+        { test_writer, "test_writer" },
+        { NULL, NULL }
+    };
+
+    sys_start();
+
+    harness_run(testcases);
+
+    return (0);
+}
@@ -0,0 +1,208 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2014-2018, Erik Moqvist
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use, copy,
+ * modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ * This file is part of the Simba project.
+ */
+
+#include "simba.h"
+
+static volatile uint32_t counter;
+static struct profiler_sample_t samples[CONFIG_PROFILER_BUFFER_SIZE];
+
+/**
+ * Consume CPU time until given number of samples are in the buffer,
+ * or give up after a while.
+ */
+static void __attribute__((noinline)) busy_wait_for_samples(int length)
+{
+    uint32_t i;
+
+    for (i = 0; i < 100000; i++) {
+        counter = 0;
+
+        while (counter < 100000) {
+            counter++;
+        }
+
+        if (profiler_read(&samples[0], length) == length) {
+            break;
+        }
+    }
+}
+
+static int test_init(void)
+{
+    BTASSERT(profiler_module_init() == 0);
+    BTASSERT(profiler_module_init() == 0);
+
+    return (0);
+}
+
+static int test_sample(void)
+{
+    int length;
+    int i;
+    int found;
+
+    BTASSERT(profiler_reset() == 0);
+    BTASSERT(profiler_read(&samples[0], membersof(samples)) == 0);
+    BTASSERT(profiler_start() == 0);
+
+    busy_wait_for_samples(8);
+
+    BTASSERT(profiler_stop() == 0);
+    length = profiler_read(&samples[0], membersof(samples));
+    BTASSERTI(length, >=, 8);
+
+    /* The main thread is interrupted in the busy loop, and the frame
+       pointers are followed at least to this function. */
+    found = 0;
+
+    for (i = 0; i < length; i++) {
+        if (samples[i].thrd_p != thrd_self()) {
+            continue;
+        }
+
+        BTASSERT(samples[i].pcs[0] != 0);
+
+        if (samples[i].length > 1) {
+            found = 1;
+        }
+    }
+
+    BTASSERT(found == 1);
+
+    /* No samples are taken when stopped. */
+    busy_wait_for_samples(1);
+    BTASSERTI(profiler_read(&samples[0], membersof(samples)), ==, length);
+
+    return (0);
+}
+
+static int test_full(void)
+{
+    uintptr_t pcs[CONFIG_PROFILER_BACKTRACE_DEPTH + 4];
+    struct queue_t out;
+    char buf[8192];
+    int length;
+    int i;
+    char c;
+
+    for (i = 0; i < membersof(pcs); i++) {
+        pcs[i] = (0x1000 + i);
+    }
+
+    BTASSERT(profiler_reset() == 0);
+
+    /* Samples are only added when started. */
+    profiler_sample_isr(thrd_self(), &pcs[0], membersof(pcs));
+    BTASSERT(profiler_read(&samples[0], membersof(samples)) == 0);
+
+    /* Too long backtraces are truncated. */
+    BTASSERT(profiler_start() == 0);
+    profiler_sample_isr(NULL, &pcs[0], membersof(pcs));
+    BTASSERT(profiler_stop() == 0);
+    length = profiler_read(&samples[0], membersof(samples));
+    BTASSERTI(length, >=, 1);
+
+    for (i = 0; i < length; i++) {
+        if (samples[i].pcs[0] == 0x1000) {
+            break;
+        }
+    }
+
+    BTASSERTI(i, <, length);
+    BTASSERT(samples[i].thrd_p == NULL);
+    BTASSERTI(samples[i].length, ==, CONFIG_PROFILER_BACKTRACE_DEPTH + 1);
+    BTASSERTI(samples[i].pcs[CONFIG_PROFILER_BACKTRACE_DEPTH],
+              ==,
+              0x1000 + CONFIG_PROFILER_BACKTRACE_DEPTH);
+
+    /* Samples are dropped when the buffer is full. */
+    BTASSERT(profiler_start() == 0);
+
+    for (i = 0; i < CONFIG_PROFILER_BUFFER_SIZE; i++) {
+        profiler_sample_isr(thrd_self(), &pcs[0], 1);
+    }
+
+    BTASSERT(profiler_stop() == 0);
+    BTASSERTI(profiler_read(&samples[0], membersof(samples)),
+              ==,
+              CONFIG_PROFILER_BUFFER_SIZE);
+
+    BTASSERT(queue_init(&out, &buf[0], sizeof(buf)) == 0);
+    BTASSERT(profiler_print(&out) == 0);
+    BTASSERTI(harness_expect(&out, "dropped ", NULL), >, 0);
+    BTASSERTI(queue_read(&out, &c, sizeof(c)), ==, 1);
+    BTASSERT((c >= '1') && (c <= '9'));
+
+    return (0);
+}
+
+static int test_fs(void)
+{
+    char command[64];
+    struct queue_t out;
+    char buf[2048];
+
+    BTASSERT(queue_init(&out, &buf[0], sizeof(buf)) == 0);
+
+    strcpy(command, "/debug/profiler/reset");
+    BTASSERT(fs_call(command, NULL, &out, NULL) == 0);
+    strcpy(command, "/debug/profiler/start");
+    BTASSERT(fs_call(command, NULL, &out, NULL) == 0);
+
+    busy_wait_for_samples(1);
+
+    strcpy(command, "/debug/profiler/stop");
+    BTASSERT(fs_call(command, NULL, &out, NULL) == 0);
+
+    strcpy(command, "/debug/profiler/print");
+    BTASSERT(fs_call(command, NULL, &out, NULL) == 0);
+    BTASSERTI(harness_expect(&out, "PROFILER-BEGIN\r\n", NULL), >, 0);
+    BTASSERTI(harness_expect(&out, " main\r\n", NULL), >, 0);
+    BTASSERTI(harness_expect(&out, "sample 0x", NULL), >, 0);
+    BTASSERTI(harness_expect(&out, "dropped 0\r\n", NULL), >, 0);
+    BTASSERTI(harness_expect(&out, "PROFILER-END\r\n", NULL), >, 0);
+
+    return (0);
+}
+
+int main()
+{
+    struct harness_testcase_t testcases[] = {
+        { test_init, "test_init" },
+        { test_sample, "test_sample" },
+        { test_full, "test_full" },
+        { test_fs, "test_fs" },
+        { NULL, NULL }
+    };
+
+    sys_start();
+
+    harness_run(testcases);
+
+    return (0);
+}
@@ -0,0 +1,238 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2014-2018, Erik Moqvist
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use, copy,
+ * modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ * This file is part of the Simba project.
+ */
+
+#include "simba.h"
+
+static THRD_STACK(reader_stack, 1024);
+static struct queue_t queue;
+static char queue_buf[256];
+
+/**
+ * Find the first record of given type and object at or after given
+ * index.
+ */
+static int find_record(struct trace_record_t *records_p,
+                       int length,
+                       int index,
+                       int type,
+                       const void *object_p)
+{
+    while (index < length) {
+        if ((records_p[index].type == type)
+            && (records_p[index].object == (uint32_t)(uintptr_t)object_p)) {
+            return (index);
+        }
+
+        index++;
+    }
+
+    return (-1);
+}
+
+static void *reader_main(void *arg_p)
+{
+    char value;
+
+    thrd_set_name("reader");
+    queue_read(&queue, &value, sizeof(value));
+
+    return (NULL);
+}
+
+static int test_init(void)
+{
+    BTASSERT(trace_module_init() == 0);
+    BTASSERT(trace_module_init() == 0);
+
+    return (0);
+}
+
+static int test_sleep(void)
+{
+    struct trace_record_t records[CONFIG_TRACE_BUFFER_SIZE];
+    int length;
+    int index;
+
+    BTASSERT(trace_reset() == 0);
+    BTASSERT(trace_read(&records[0], membersof(records)) == 0);
+
+    thrd_sleep_ms(20);
+
+    BTASSERT(trace_stop() == 0);
+    length = trace_read(&records[0], membersof(records));
+    BTASSERT(length > 0);
+
+    /* The sleep timer expires and resumes this thread, which is then
+       swapped in. */
+    index = find_record(&records[0],
+                        length,
+                        0,
+                        TRACE_TYPE_THRD_RESUME,
+                        thrd_self());
+    BTASSERT(index >= 0);
+    BTASSERT(find_record(&records[0],
+                         length,
+                         index,
+                         TRACE_TYPE_THRD_SWITCH,
+                         thrd_self()) > index);
+    BTASSERT(trace_start() == 0);
+
+    return (0);
+}
+
+static int test_queue(void)
+{
+    struct trace_record_t records[CONFIG_TRACE_BUFFER_SIZE];
+    struct thrd_t *thrd_p;
+    int length;
+    int block;
+    int unblock;
+    char value;
+
+    BTASSERT(queue_init(&queue, &queue_buf[0], sizeof(queue_buf)) == 0);
+    BTASSERT(trace_reset() == 0);
+
+    thrd_p = thrd_spawn(reader_main,
+                        NULL,
+                        -1,
+                        reader_stack,
+                        sizeof(reader_stack));
+    BTASSERT(thrd_p != NULL);
+
+    /* Let the reader block on the empty queue. */
+    thrd_sleep_ms(10);
+
+    value = 1;
+    BTASSERTI(queue_write(&queue, &value, sizeof(value)), ==, 1);
+    BTASSERT(thrd_join(thrd_p) == 0);
+
+    BTASSERT(trace_stop() == 0);
+    length = trace_read(&records[0], membersof(records));
+
+    /* The reader blocks and is unblocked by the write. */
+    block = find_record(&records[0],
+                        length,
+                        0,
+                        TRACE_TYPE_QUEUE_BLOCK,
+                        &queue);
+    BTASSERT(block >= 0);
+    unblock = find_record(&records[0],
+                          length,
+                          block,
+                          TRACE_TYPE_QUEUE_UNBLOCK,
+                          &queue);
+    BTASSERT(unblock > block);
+    BTASSERT(find_record(&records[0],
+                         length,
+                         block,
+                         TRACE_TYPE_THRD_RESUME,
+                         thrd_p) < unblock);
+    BTASSERT(trace_start() == 0);
+
+    return (0);
+}
+
+static int test_overwrite(void)
+{
+    struct trace_record_t records[CONFIG_TRACE_BUFFER_SIZE];
+    int i;
+
+    BTASSERT(trace_reset() == 0);
+
+    sys_lock();
+
+    for (i = 0; i < CONFIG_TRACE_BUFFER_SIZE + 10; i++) {
+        trace_write_isr(TRACE_TYPE_TIMER_EXPIRE, (void *)(uintptr_t)i, 0);
+    }
+
+    BTASSERT(trace_stop() == 0);
+
+    sys_unlock();
+
+    /* Only the newest records are kept. */
+    BTASSERTI(trace_read(&records[0], membersof(records)),
+              ==,
+              CONFIG_TRACE_BUFFER_SIZE);
+    BTASSERTI(records[0].object, ==, 10);
+    BTASSERTI(records[CONFIG_TRACE_BUFFER_SIZE - 1].object,
+              ==,
+              CONFIG_TRACE_BUFFER_SIZE + 9);
+    BTASSERTI(records[0].type, ==, TRACE_TYPE_TIMER_EXPIRE);
+
+    /* Partial read. */
+    BTASSERTI(trace_read(&records[0], 2), ==, 2);
+    BTASSERTI(records[1].object, ==, 11);
+
+    BTASSERT(trace_start() == 0);
+
+    return (0);
+}
+
+static int test_fs(void)
+{
+    char command[64];
+    struct queue_t out;
+    char buf[1024];
+
+    BTASSERT(queue_init(&out, &buf[0], sizeof(buf)) == 0);
+
+    strcpy(command, "/debug/trace/reset");
+    BTASSERT(fs_call(command, NULL, &out, NULL) == 0);
+
+    sys_lock();
+    trace_write_isr(TRACE_TYPE_MUTEX_BLOCK, (void *)0x1234, -3);
+    sys_unlock();
+
+    strcpy(command, "/debug/trace/print");
+    BTASSERT(fs_call(command, NULL, &out, NULL) == 0);
+    BTASSERTI(harness_expect(&out, "TRACE-BEGIN\r\n", NULL), >, 0);
+    BTASSERTI(harness_expect(&out, "thread 0x", NULL), >, 0);
+    BTASSERTI(harness_expect(&out, " main\r\n", NULL), >, 0);
+    BTASSERTI(harness_expect(&out, " 8 0x00001234 -3\r\n", NULL), >, 0);
+    BTASSERTI(harness_expect(&out, "TRACE-END\r\n", NULL), >, 0);
+
+    return (0);
+}
+
+int main()
+{
+    struct harness_testcase_t testcases[] = {
+        { test_init, "test_init" },
+        { test_sleep, "test_sleep" },
+        { test_queue, "test_queue" },
+        { test_overwrite, "test_overwrite" },
+        { test_fs, "test_fs" },
+        { NULL, NULL }
+    };
+
+    sys_start();
+
+    harness_run(testcases);
+
+    return (0);
+}
@@ -87,11 +87,40 @@ static int test_transfer(void)
     return (0);
 }
 
+static int test_transfer_async(void)
+{
+    struct spi_transaction_t transactions[2];
+
+    BTASSERT(spi_transaction_init(&transactions[0],
+                                  NULL,
+                                  &txbuf[0],
+                                  4,
+                                  SPI_TRANSACTION_SELECT) == 0);
+    BTASSERT(spi_transaction_init(&transactions[1],
+                                  &rxbuf[0],
+                                  &txbuf[0],
+                                  sizeof(rxbuf),
+                                  SPI_TRANSACTION_DESELECT) == 0);
+
+    /* Queue both transactions and give the bus before they are
+       complete. */
+    BTASSERT(spi_take_bus(&spi) == 0);
+    BTASSERT(spi_transfer_async(&spi, &transactions[0]) == 0);
+    BTASSERT(spi_transfer_async(&spi, &transactions[1]) == 0);
+    BTASSERT(spi_give_bus(&spi) == 0);
+
+    BTASSERT(spi_transaction_wait(&transactions[0]) == 4);
+    BTASSERT(spi_transaction_wait(&transactions[1]) == sizeof(rxbuf));
+
+    return (0);
+}
+
 int main()
 {
     struct harness_testcase_t testcases[] = {
         { test_init, "test_init" },
         { test_transfer, "test_transfer" },
+        { test_transfer_async, "test_transfer_async" },
         { NULL, NULL }
     };
 
@@ -56,6 +56,16 @@ int test_convert(void)
     return (0);
 }
 
+int test_convert_async(void)
+{
+    BTASSERT(ds18b20_convert_async(&ds) == 0);
+    BTASSERTI(ds18b20_convert_is_done(&ds), ==, 0);
+    BTASSERT(ds18b20_convert_wait(&ds) == 0);
+    BTASSERTI(ds18b20_convert_is_done(&ds), ==, 1);
+
+    return (0);
+}
+
 int test_read(void)
 {
     int i;
@@ -134,6 +144,7 @@ int main()
         { test_init, "test_init" },
         { test_scan, "test_scan" },
         { test_convert, "test_convert" },
+        { test_convert_async, "test_convert_async" },
         { test_read, "test_read" },
         { test_read_fixed_point, "test_read_fixed_point" },
         { test_read_string, "test_read_string" },
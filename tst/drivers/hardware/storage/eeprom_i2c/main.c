@@ -216,6 +216,72 @@ static int test_read_write_bad_address(void)
     return (0);
 }
 
+static int test_page_write(void)
+{
+    int i;
+    uint8_t write_buf[300];
+    uint8_t read_buf[300];
+    uint8_t shadow_buf[32];
+    struct time_t start;
+    struct time_t stop;
+
+    for (i = 0; i < membersof(write_buf); i++) {
+        write_buf[i] = i;
+    }
+
+    BTASSERT(eeprom_i2c_set_page_size(&eeprom_i2c, 32) == 0);
+
+    /* Unaligned write spanning several pages. */
+    time_get(&start);
+    BTASSERT(eeprom_i2c_write(&eeprom_i2c,
+                              7,
+                              &write_buf[0],
+                              sizeof(write_buf)) == sizeof(write_buf));
+    BTASSERT(eeprom_i2c_flush(&eeprom_i2c) == 0);
+    time_get(&stop);
+    time_subtract(&stop, &stop, &start);
+    std_printf(OSTR("Wrote %u bytes in %lu ms.\r\n"),
+               sizeof(write_buf),
+               (unsigned long)(stop.seconds * 1000
+                               + stop.nanoseconds / 1000000));
+
+    memset(&read_buf[0], 0, sizeof(read_buf));
+    BTASSERT(eeprom_i2c_read(&eeprom_i2c,
+                             &read_buf[0],
+                             7,
+                             sizeof(read_buf)) == sizeof(read_buf));
+    BTASSERTM(&read_buf[0], &write_buf[0], sizeof(write_buf));
+
+    /* Adjacent small writes are coalesced in the write buffer. */
+    BTASSERT(eeprom_i2c_set_write_buffer(&eeprom_i2c,
+                                         &shadow_buf[0],
+                                         16) == -EINVAL);
+    BTASSERT(eeprom_i2c_set_write_buffer(&eeprom_i2c,
+                                         &shadow_buf[0],
+                                         sizeof(shadow_buf)) == 0);
+
+    for (i = 0; i < 40; i += 4) {
+        write_buf[i] = (0xff - i);
+        BTASSERT(eeprom_i2c_write(&eeprom_i2c,
+                                  7 + i,
+                                  &write_buf[i],
+                                  4) == 4);
+    }
+
+    /* A read writes the buffered data first. */
+    memset(&read_buf[0], 0, sizeof(read_buf));
+    BTASSERT(eeprom_i2c_read(&eeprom_i2c,
+                             &read_buf[0],
+                             7,
+                             sizeof(read_buf)) == sizeof(read_buf));
+    BTASSERTM(&read_buf[0], &write_buf[0], sizeof(write_buf));
+
+    BTASSERT(eeprom_i2c_set_write_buffer(&eeprom_i2c, NULL, 0) == 0);
+    BTASSERT(eeprom_i2c_set_page_size(&eeprom_i2c, 1) == 0);
+
+    return (0);
+}
+
 int main()
 {
     struct harness_testcase_t testcases[] = {
@@ -224,6 +290,7 @@ int main()
         { test_read_write_sizes, "test_read_write_sizes" },
         { test_read_write_low_high, "test_read_write_low_high" },
         { test_read_write_bad_address, "test_read_write_bad_address" },
+        { test_page_write, "test_page_write" },
         { NULL, NULL }
     };
 
@@ -273,6 +273,35 @@ static int test_read_write(void)
     return (0);
 }
 
+static int test_read_write_blocks(void)
+{
+    static uint8_t blocks[4 * SD_BLOCK_SIZE];
+    int i, res;
+
+    for (i = 0; i < membersof(blocks); i++) {
+        blocks[i] = ((i / SD_BLOCK_SIZE + i) & 0xff);
+    }
+
+    BTASSERT((res = sd_write_blocks(&sd, 8, blocks, 4)) == sizeof(blocks),
+             ", res = %d\r\n", res);
+    memset(blocks, 0, sizeof(blocks));
+    BTASSERT((res = sd_read_blocks(&sd, blocks, 8, 4)) == sizeof(blocks),
+             ", res = %d\r\n", res);
+
+    for (i = 0; i < membersof(blocks); i++) {
+        BTASSERT(blocks[i] == ((i / SD_BLOCK_SIZE + i) & 0xff));
+    }
+
+    /* Single blocks of the multiple block write. */
+    BTASSERT(sd_read_block(&sd, buf, 10) == SD_BLOCK_SIZE);
+
+    for (i = 0; i < membersof(buf); i++) {
+        BTASSERT(buf[i] == ((2 + i) & 0xff));
+    }
+
+    return (0);
+}
+
 static int test_write_performance(void)
 {
     int i, block, res;
@@ -350,6 +379,7 @@ int main()
         { test_read_cid, "test_read_cid" },
         { test_read_csd, "test_read_csd" },
         { test_read_write, "test_read_write" },
+        { test_read_write_blocks, "test_read_write_blocks" },
         { test_write_performance, "test_write_performance" },
         { test_read_performance, "test_read_performance" },
         { NULL, NULL }
@@ -0,0 +1,144 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2018, Erik Moqvist
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use, copy,
+ * modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ * This file is part of the Simba project.
+ */
+
+#include "simba.h"
+
+static struct adc_stream_t stream;
+static uint16_t blocks[2][4];
+static uint16_t ringbuf[13];
+static struct pin_device_t *pins[] = {
+    &pin_a0_dev,
+    &pin_a1_dev
+};
+
+static void convert(uint16_t first, int length)
+{
+    int i;
+
+    sys_lock();
+
+    for (i = 0; i < length; i++) {
+        adc_port_device_sample_isr(&adc_device[0], first + i);
+    }
+
+    sys_unlock();
+}
+
+static int test_stream(void)
+{
+    uint16_t samples[6];
+
+    BTASSERT(adc_module_init() == 0);
+    BTASSERT(adc_stream_init(&stream,
+                             &adc_device[0],
+                             &pins[0],
+                             membersof(pins),
+                             1000,
+                             &blocks[0][0],
+                             membersof(blocks[0]),
+                             &ringbuf[0],
+                             sizeof(ringbuf)) == 0);
+    BTASSERT(adc_stream_start(&stream) == 0);
+
+    /* Samples are delivered in complete blocks. */
+    convert(0, 3);
+    BTASSERT(chan_size(&stream) == 0);
+    convert(3, 5);
+    BTASSERT(chan_size(&stream) == 8 * sizeof(uint16_t));
+
+    BTASSERT(adc_stream_read(&stream, &samples[0], sizeof(samples))
+             == sizeof(samples));
+    BTASSERT(samples[0] == 0);
+    BTASSERT(samples[5] == 5);
+    BTASSERT(chan_read(&stream, &samples[0], 2 * sizeof(uint16_t))
+             == 2 * sizeof(uint16_t));
+    BTASSERT(samples[0] == 6);
+    BTASSERT(samples[1] == 7);
+
+    BTASSERT(adc_stream_stop(&stream) == 0);
+
+    /* No samples are delivered when stopped. */
+    convert(0, 4);
+    BTASSERT(chan_size(&stream) == 0);
+
+    return (0);
+}
+
+static int test_overrun(void)
+{
+    uint16_t samples[4];
+
+    BTASSERT(adc_stream_start(&stream) == 0);
+
+    /* The ring buffer fits three blocks, the fourth is lost. */
+    convert(0, 16);
+    BTASSERT(chan_size(&stream) == 12 * sizeof(uint16_t));
+
+    /* The samples before the gap can be read. */
+    BTASSERT(adc_stream_read(&stream, &samples[0], sizeof(samples))
+             == sizeof(samples));
+    BTASSERT(samples[0] == 0);
+    BTASSERT(adc_stream_read(&stream, &samples[0], sizeof(samples))
+             == sizeof(samples));
+    BTASSERT(samples[0] == 4);
+
+    /* Blocks are dropped until the overrun has been reported. */
+    convert(16, 4);
+    BTASSERT(adc_stream_read(&stream, &samples[0], 3 * sizeof(uint16_t))
+             == 3 * sizeof(uint16_t));
+    BTASSERT(samples[0] == 8);
+    BTASSERT(adc_stream_read(&stream, &samples[0], sizeof(samples))
+             == -EOVERFLOW);
+    BTASSERT(chan_size(&stream) == 0);
+
+    /* Conversions resume at a block boundary. */
+    convert(20, 4);
+    BTASSERT(adc_stream_read(&stream, &samples[0], sizeof(samples))
+             == sizeof(samples));
+    BTASSERT(samples[0] == 20);
+    BTASSERT(samples[3] == 23);
+
+    BTASSERT(adc_stream_stop(&stream) == 0);
+
+    return (0);
+}
+
+int main()
+{
+    struct harness_testcase_t testcases[] = {
+        { test_stream, "test_stream" },
+        { test_overrun, "test_overrun" },
+        { NULL, NULL }
+    };
+
+    sys_start();
+
+    harness_run(testcases);
+
+    return (0);
+}
@@ -0,0 +1,178 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2018, Erik Moqvist
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use, copy,
+ * modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ * This file is part of the Simba project.
+ */
+
+#include "simba.h"
+
+static struct dac_driver_t dac;
+static struct dac_stream_t stream;
+static uint32_t buffers[3][4];
+static void *buffers_p[] = {
+    &buffers[0][0],
+    &buffers[1][0],
+    &buffers[2][0]
+};
+static uint32_t next_sample;
+static size_t fill_length;
+
+static size_t fill(void *arg_p, void *samples_p, size_t length)
+{
+    uint32_t *buf_p;
+    size_t i;
+
+    buf_p = samples_p;
+
+    if (fill_length < length) {
+        length = fill_length;
+    }
+
+    for (i = 0; i < length; i++) {
+        buf_p[i] = next_sample++;
+    }
+
+    return (length);
+}
+
+static int convert(uint32_t *samples_p, int length)
+{
+    int i;
+    int res;
+
+    res = 0;
+
+    sys_lock();
+
+    for (i = 0; i < length; i++) {
+        res = dac_port_device_convert_isr(&dac_device[0], &samples_p[i]);
+
+        if (res != 0) {
+            break;
+        }
+    }
+
+    sys_unlock();
+
+    return (res);
+}
+
+static int test_stream(void)
+{
+    uint32_t samples[16];
+    int i;
+
+    BTASSERT(dac_module_init() == 0);
+    BTASSERT(dac_init(&dac,
+                      &dac_device[0],
+                      &pin_dac0_dev,
+                      NULL,
+                      44100) == 0);
+    BTASSERT(dac_stream_init(&stream,
+                             &dac,
+                             &buffers_p[0],
+                             membersof(buffers_p),
+                             membersof(buffers[0]),
+                             fill,
+                             &stream) == 0);
+
+    next_sample = 0;
+    fill_length = membersof(buffers[0]);
+    BTASSERT(dac_stream_start(&stream) == 0);
+    BTASSERT(dac_stream_start(&stream) == -EBUSY);
+
+    /* All buffers are filled on start, and refilled in order. */
+    BTASSERT(next_sample == 12);
+    BTASSERT(convert(&samples[0], membersof(samples)) == 0);
+
+    for (i = 0; i < membersof(samples); i++) {
+        BTASSERTI(samples[i], ==, i);
+    }
+
+    BTASSERT(next_sample == 28);
+    BTASSERT(dac_stream_get_underruns(&stream) == 0);
+
+    BTASSERT(dac_stream_stop(&stream) == 0);
+    BTASSERT(convert(&samples[0], 1) == -1);
+
+    return (0);
+}
+
+static int test_underrun(void)
+{
+    uint32_t samples[12];
+
+    next_sample = 0;
+    fill_length = membersof(buffers[0]);
+    BTASSERT(dac_stream_start(&stream) == 0);
+
+    /* The producer is late. The last sample is held. */
+    fill_length = 1;
+    BTASSERT(convert(&samples[0], 4) == 0);
+    BTASSERT(dac_stream_get_underruns(&stream) == 1);
+    fill_length = 0;
+    BTASSERT(convert(&samples[0], 4) == 0);
+    BTASSERT(dac_stream_get_underruns(&stream) == 2);
+    fill_length = membersof(buffers[0]);
+    BTASSERT(convert(&samples[0], 12) == 0);
+    BTASSERT(dac_stream_get_underruns(&stream) == 2);
+
+    /* Buffers from before the underrun. */
+    BTASSERTI(samples[0], ==, 8);
+    BTASSERTI(samples[3], ==, 11);
+
+    /* One sample and padding. */
+    BTASSERTI(samples[4], ==, 12);
+    BTASSERTI(samples[5], ==, 12);
+    BTASSERTI(samples[7], ==, 12);
+
+    /* Nothing at all. */
+    BTASSERTI(samples[8], ==, 12);
+    BTASSERTI(samples[11], ==, 12);
+
+    BTASSERT(dac_stream_stop(&stream) == 0);
+
+    /* The counter is cleared on start. */
+    BTASSERT(dac_stream_start(&stream) == 0);
+    BTASSERT(dac_stream_get_underruns(&stream) == 0);
+    BTASSERT(dac_stream_stop(&stream) == 0);
+
+    return (0);
+}
+
+int main()
+{
+    struct harness_testcase_t testcases[] = {
+        { test_stream, "test_stream" },
+        { test_underrun, "test_underrun" },
+        { NULL, NULL }
+    };
+
+    sys_start();
+
+    harness_run(testcases);
+
+    return (0);
+}
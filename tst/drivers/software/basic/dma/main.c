@@ -0,0 +1,287 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2017-2018, Erik Moqvist
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use, copy,
+ * modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ * This file is part of the Simba project.
+ */
+
+#include "simba.h"
+
+static struct dma_driver_t channels[DMA_PORT_CHANNELS_MAX + 1];
+
+struct callback_t {
+    int count;
+    int res;
+    struct dma_driver_t *drv_p;
+    struct sem_t sem;
+};
+
+static void on_complete(void *arg_p, int res)
+{
+    struct callback_t *callback_p;
+
+    callback_p = arg_p;
+    callback_p->count++;
+    callback_p->res = res;
+    sem_give_isr(&callback_p->sem, 1);
+}
+
+static int test_init(void)
+{
+    int i;
+
+    BTASSERT(dma_module_init() == 0);
+    BTASSERT(dma_module_init() == 0);
+
+    /* Allocate all channels. */
+    for (i = 0; i < DMA_PORT_CHANNELS_MAX; i++) {
+        BTASSERT(dma_init(&channels[i],
+                          &dma_device[0],
+                          DMA_REQUEST_NONE) == 0);
+    }
+
+    BTASSERT(dma_init(&channels[i],
+                      &dma_device[0],
+                      DMA_REQUEST_NONE) == -EBUSY);
+
+    /* Channels are freed by deinit. */
+    BTASSERT(dma_deinit(&channels[1]) == 0);
+    BTASSERT(dma_init(&channels[i],
+                      &dma_device[0],
+                      DMA_REQUEST_NONE) == 0);
+    BTASSERT(dma_deinit(&channels[i]) == 0);
+
+    for (i = 0; i < DMA_PORT_CHANNELS_MAX; i++) {
+        if (i != 1) {
+            BTASSERT(dma_deinit(&channels[i]) == 0);
+        }
+    }
+
+    return (0);
+}
+
+static int test_transfer_init(void)
+{
+    struct dma_transfer_t transfer;
+    uint8_t src[4] = { 0 };
+    uint8_t dst[4];
+
+    BTASSERT(dma_transfer_init(&transfer,
+                               3,
+                               &dst[0],
+                               &src[0],
+                               sizeof(src),
+                               DMA_WIDTH_8) == -EINVAL);
+    BTASSERT(dma_transfer_init(&transfer,
+                               DMA_MEMORY_TO_MEMORY,
+                               &dst[0],
+                               &src[0],
+                               sizeof(src),
+                               3) == -EINVAL);
+    BTASSERT(dma_transfer_init(&transfer,
+                               DMA_MEMORY_TO_MEMORY,
+                               &dst[0],
+                               &src[0],
+                               DMA_PORT_LENGTH_MAX + 1,
+                               DMA_WIDTH_8) == -EINVAL);
+
+    return (0);
+}
+
+static int test_memory_to_memory(void)
+{
+    struct dma_driver_t dma;
+    struct dma_transfer_t transfer;
+    static uint32_t src[16];
+    static uint32_t dst[16];
+    int i;
+
+    for (i = 0; i < membersof(src); i++) {
+        src[i] = (0x01010101 * i);
+    }
+
+    BTASSERT(dma_init(&dma, &dma_device[0], DMA_REQUEST_NONE) == 0);
+    BTASSERT(dma_transfer_init(&transfer,
+                               DMA_MEMORY_TO_MEMORY,
+                               &dst[0],
+                               &src[0],
+                               membersof(src),
+                               DMA_WIDTH_32) == 0);
+    BTASSERT(dma_transfer(&dma, &transfer) == 0);
+    BTASSERTM(&dst[0], &src[0], sizeof(src));
+
+    /* Nothing ongoing. */
+    BTASSERT(dma_async_wait(&dma) == 0);
+    BTASSERT(dma_get_remaining(&dma) == 0);
+
+    BTASSERT(dma_deinit(&dma) == 0);
+
+    return (0);
+}
+
+static int test_memory_to_peripheral(void)
+{
+    struct dma_driver_t dma;
+    struct dma_transfer_t transfer;
+    struct callback_t callback;
+    static const uint16_t src[4] = { 1, 2, 3, 4 };
+    volatile uint16_t data_register;
+
+    callback.count = 0;
+    sem_init(&callback.sem, 1, 1);
+    data_register = 0;
+
+    BTASSERT(dma_init(&dma, &dma_device[0], 1) == 0);
+    BTASSERT(dma_transfer_init(&transfer,
+                               DMA_MEMORY_TO_PERIPHERAL,
+                               &data_register,
+                               &src[0],
+                               membersof(src),
+                               DMA_WIDTH_16) == 0);
+    BTASSERT(dma_transfer_set_callback(&transfer,
+                                       on_complete,
+                                       &callback) == 0);
+    BTASSERT(dma_async_start(&dma, &transfer) == 0);
+    BTASSERT(dma_async_start(&dma, &transfer) == -EBUSY);
+    BTASSERT(dma_get_remaining(&dma) == 4);
+    BTASSERT(dma_async_wait(&dma) == 0);
+
+    /* The peripheral address is not incremented. */
+    BTASSERT(data_register == 4);
+    BTASSERT(callback.count == 1);
+    BTASSERT(callback.res == 0);
+
+    BTASSERT(dma_deinit(&dma) == 0);
+
+    return (0);
+}
+
+static int test_peripheral_to_memory_circular(void)
+{
+    struct dma_driver_t dma;
+    struct dma_transfer_t transfer;
+    struct callback_t callback;
+    uint8_t dst[8];
+    volatile uint8_t data_register;
+    int i;
+
+    callback.count = 0;
+    sem_init(&callback.sem, 1, 1);
+    data_register = 0xa5;
+    memset(&dst[0], 0, sizeof(dst));
+
+    BTASSERT(dma_init(&dma, &dma_device[1], 2) == 0);
+    BTASSERT(dma_transfer_init(&transfer,
+                               DMA_PERIPHERAL_TO_MEMORY,
+                               &dst[0],
+                               &data_register,
+                               membersof(dst),
+                               DMA_WIDTH_8 | DMA_CIRCULAR) == 0);
+    BTASSERT(dma_transfer_set_callback(&transfer,
+                                       on_complete,
+                                       &callback) == 0);
+    BTASSERT(dma_async_start(&dma, &transfer) == 0);
+
+    /* The callback is called each lap. */
+    for (i = 0; i < 3; i++) {
+        BTASSERT(sem_take(&callback.sem, NULL) == 0);
+    }
+
+    BTASSERT(callback.count >= 3);
+
+    for (i = 0; i < membersof(dst); i++) {
+        BTASSERT(dst[i] == 0xa5);
+    }
+
+    /* A circular transfer is ended by stopping it. */
+    BTASSERT(dma_stop(&dma) == 0);
+    BTASSERT(dma_async_wait(&dma) == -ECANCELED);
+    BTASSERT(dma_get_remaining(&dma) == 0);
+
+    BTASSERT(dma_deinit(&dma) == 0);
+
+    return (0);
+}
+
+static void *stop_main(void *arg_p)
+{
+    thrd_set_name("stop");
+    thrd_sleep_ms(50);
+    dma_stop(arg_p);
+    thrd_suspend(NULL);
+
+    return (NULL);
+}
+
+static int test_stop_waiting(void)
+{
+    struct dma_driver_t dma;
+    struct dma_transfer_t transfer;
+    static THRD_STACK(stack, 1024);
+    uint8_t dst[8];
+    volatile uint8_t data_register;
+
+    data_register = 0;
+
+    BTASSERT(dma_init(&dma, &dma_device[0], 3) == 0);
+    BTASSERT(dma_transfer_init(&transfer,
+                               DMA_PERIPHERAL_TO_MEMORY,
+                               &dst[0],
+                               &data_register,
+                               membersof(dst),
+                               DMA_WIDTH_8 | DMA_CIRCULAR) == 0);
+    BTASSERT(dma_async_start(&dma, &transfer) == 0);
+    BTASSERT(thrd_spawn(stop_main,
+                        &dma,
+                        0,
+                        stack,
+                        sizeof(stack)) != NULL);
+
+    /* Resumed by the stop thread. */
+    BTASSERT(dma_async_wait(&dma) == -ECANCELED);
+
+    BTASSERT(dma_deinit(&dma) == 0);
+
+    return (0);
+}
+
+int main()
+{
+    struct harness_testcase_t testcases[] = {
+        { test_init, "test_init" },
+        { test_transfer_init, "test_transfer_init" },
+        { test_memory_to_memory, "test_memory_to_memory" },
+        { test_memory_to_peripheral, "test_memory_to_peripheral" },
+        { test_peripheral_to_memory_circular,
+          "test_peripheral_to_memory_circular" },
+        { test_stop_waiting, "test_stop_waiting" },
+        { NULL, NULL }
+    };
+
+    sys_start();
+
+    harness_run(testcases);
+
+    return (0);
+}
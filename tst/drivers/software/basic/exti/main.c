@@ -0,0 +1,199 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2017-2018, Erik Moqvist
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use, copy,
+ * modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ * This file is part of the Simba project.
+ */
+
+#include "simba.h"
+
+static THRD_STACK(edges_stack, 1024);
+
+/**
+ * Simulate an edge by calling the interrupt callback.
+ */
+static void edge(struct exti_capture_t *capture_p)
+{
+    sys_lock();
+    capture_p->exti.on_interrupt(capture_p->exti.arg_p);
+    sys_unlock();
+}
+
+static void *edges_main(void *arg_p)
+{
+    thrd_set_name("edges");
+    thrd_sleep_ms(10);
+    edge(arg_p);
+    edge(arg_p);
+    thrd_suspend(NULL);
+
+    return (NULL);
+}
+
+static int test_init(void)
+{
+    struct exti_capture_t capture;
+    uint32_t buf[4];
+
+    BTASSERT(exti_capture_init(&capture,
+                               &exti_device[0],
+                               EXTI_TRIGGER_RISING_EDGE,
+                               &buf[0],
+                               membersof(buf)) == 0);
+
+    return (0);
+}
+
+static int test_read_batch(void)
+{
+    struct exti_capture_t capture;
+    uint32_t buf[4];
+    uint32_t timestamps[8];
+
+    BTASSERT(exti_capture_init(&capture,
+                               &exti_device[0],
+                               EXTI_TRIGGER_RISING_EDGE,
+                               &buf[0],
+                               membersof(buf)) == 0);
+    BTASSERT(exti_capture_start(&capture) == 0);
+
+    edge(&capture);
+    thrd_sleep_ms(1);
+    edge(&capture);
+    edge(&capture);
+
+    /* All captured edges in one read, oldest first. */
+    BTASSERT(exti_capture_read(&capture,
+                               &timestamps[0],
+                               membersof(timestamps),
+                               NULL) == 3);
+    BTASSERT(timestamps[1] - timestamps[0] >= 1000);
+    BTASSERT(timestamps[2] - timestamps[1] < 1000);
+
+    /* Limited by the read length. */
+    edge(&capture);
+    edge(&capture);
+    BTASSERT(exti_capture_read(&capture, &timestamps[0], 1, NULL) == 1);
+    BTASSERT(exti_capture_read(&capture, &timestamps[1], 1, NULL) == 1);
+    BTASSERT(timestamps[1] - timestamps[0] < 1000);
+    BTASSERT(exti_capture_get_overflows(&capture) == 0);
+
+    BTASSERT(exti_capture_stop(&capture) == 0);
+
+    return (0);
+}
+
+static int test_overflow(void)
+{
+    struct exti_capture_t capture;
+    uint32_t buf[4];
+    uint32_t timestamps[8];
+    int i;
+
+    BTASSERT(exti_capture_init(&capture,
+                               &exti_device[0],
+                               EXTI_TRIGGER_BOTH_EDGES,
+                               &buf[0],
+                               membersof(buf)) == 0);
+    BTASSERT(exti_capture_start(&capture) == 0);
+
+    for (i = 0; i < 6; i++) {
+        edge(&capture);
+    }
+
+    BTASSERT(exti_capture_get_overflows(&capture) == 2);
+    BTASSERT(exti_capture_read(&capture,
+                               &timestamps[0],
+                               membersof(timestamps),
+                               NULL) == 4);
+
+    /* The ring buffer wraps around. */
+    for (i = 0; i < 3; i++) {
+        edge(&capture);
+    }
+
+    BTASSERT(exti_capture_read(&capture,
+                               &timestamps[0],
+                               membersof(timestamps),
+                               NULL) == 3);
+    BTASSERT(exti_capture_get_overflows(&capture) == 2);
+
+    BTASSERT(exti_capture_stop(&capture) == 0);
+
+    return (0);
+}
+
+static int test_read_wait(void)
+{
+    struct exti_capture_t capture;
+    uint32_t buf[4];
+    uint32_t timestamps[8];
+    struct time_t timeout;
+
+    BTASSERT(exti_capture_init(&capture,
+                               &exti_device[0],
+                               EXTI_TRIGGER_FALLING_EDGE,
+                               &buf[0],
+                               membersof(buf)) == 0);
+    BTASSERT(exti_capture_start(&capture) == 0);
+
+    timeout.seconds = 0;
+    timeout.nanoseconds = 10000000;
+    BTASSERT(exti_capture_read(&capture,
+                               &timestamps[0],
+                               membersof(timestamps),
+                               &timeout) == -ETIMEDOUT);
+
+    /* Woken by the first edge from another thread. */
+    BTASSERT(thrd_spawn(edges_main,
+                        &capture,
+                        0,
+                        edges_stack,
+                        sizeof(edges_stack)) != NULL);
+    BTASSERT(exti_capture_read(&capture,
+                               &timestamps[0],
+                               membersof(timestamps),
+                               NULL) >= 1);
+
+    BTASSERT(exti_capture_stop(&capture) == 0);
+
+    return (0);
+}
+
+int main()
+{
+    struct harness_testcase_t testcases[] = {
+        { test_init, "test_init" },
+        { test_read_batch, "test_read_batch" },
+        { test_overflow, "test_overflow" },
+        { test_read_wait, "test_read_wait" },
+        { NULL, NULL }
+    };
+
+    sys_start();
+
+    harness_run(testcases);
+
+    return (0);
+}
@@ -0,0 +1,144 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2018, Erik Moqvist
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use, copy,
+ * modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ * This file is part of the Simba project.
+ */
+
+#include "simba.h"
+
+/**
+ * Sleep mode the idle thread would enter with given number of ticks
+ * until the next timer expires.
+ */
+static int idle_mode(uint32_t ticks)
+{
+    int mode;
+
+    sys_lock();
+    mode = power_idle_enter_isr(ticks);
+    power_idle_exit_isr(mode);
+    sys_unlock();
+
+    return (mode);
+}
+
+static int test_init(void)
+{
+    BTASSERT(power_module_init() == 0);
+    BTASSERT(power_module_init() == 0);
+
+    /* Take over the constraint of the started console UART. */
+    BTASSERT(idle_mode(0xffffffff) == POWER_MODE_IDLE);
+    BTASSERT(power_stay_awake_release(POWER_MODE_IDLE) == 0);
+
+    return (0);
+}
+
+static int test_idle_mode(void)
+{
+    /* Sleep only if no timer is running. */
+    BTASSERT(idle_mode(0xffffffff) == POWER_MODE_SLEEP);
+    BTASSERT(idle_mode(1) == POWER_MODE_IDLE);
+    BTASSERT(idle_mode(1000) == POWER_MODE_IDLE);
+
+    return (0);
+}
+
+static int test_stay_awake(void)
+{
+    /* Constraints nest. */
+    BTASSERT(power_stay_awake_acquire(POWER_MODE_IDLE) == 0);
+    BTASSERT(power_stay_awake_acquire(POWER_MODE_IDLE) == 0);
+    BTASSERT(idle_mode(0xffffffff) == POWER_MODE_IDLE);
+    BTASSERT(power_stay_awake_release(POWER_MODE_IDLE) == 0);
+    BTASSERT(idle_mode(0xffffffff) == POWER_MODE_IDLE);
+    BTASSERT(power_stay_awake_release(POWER_MODE_IDLE) == 0);
+    BTASSERT(idle_mode(0xffffffff) == POWER_MODE_SLEEP);
+
+    /* The deepest mode is not constraining. */
+    BTASSERT(power_stay_awake_acquire(POWER_MODE_SLEEP) == 0);
+    BTASSERT(idle_mode(0xffffffff) == POWER_MODE_SLEEP);
+    BTASSERT(power_stay_awake_release(POWER_MODE_SLEEP) == 0);
+
+    /* Bad mode and unbalanced release. */
+    BTASSERT(power_stay_awake_acquire(-1) == -EINVAL);
+    BTASSERT(power_stay_awake_acquire(POWER_MODE_MAX) == -EINVAL);
+    BTASSERT(power_stay_awake_release(POWER_MODE_IDLE) == -EINVAL);
+
+    return (0);
+}
+
+static int test_dma_transfer(void)
+{
+    struct dma_driver_t dma;
+    struct dma_transfer_t transfer;
+    uint8_t dst[8];
+    volatile uint8_t data_register;
+
+    data_register = 0;
+
+    BTASSERT(dma_init(&dma, &dma_device[0], 1) == 0);
+    BTASSERT(dma_transfer_init(&transfer,
+                               DMA_PERIPHERAL_TO_MEMORY,
+                               &dst[0],
+                               &data_register,
+                               membersof(dst),
+                               DMA_WIDTH_8 | DMA_CIRCULAR) == 0);
+
+    /* No sleep while the transfer is in flight. */
+    BTASSERT(dma_async_start(&dma, &transfer) == 0);
+    BTASSERT(idle_mode(0xffffffff) == POWER_MODE_IDLE);
+    BTASSERT(dma_stop(&dma) == 0);
+    BTASSERT(idle_mode(0xffffffff) == POWER_MODE_SLEEP);
+
+    /* Released on completion. */
+    transfer.flags = DMA_WIDTH_8;
+    BTASSERT(dma_transfer(&dma, &transfer) == 0);
+    BTASSERT(idle_mode(0xffffffff) == POWER_MODE_SLEEP);
+
+    BTASSERT(dma_deinit(&dma) == 0);
+
+    /* Give back the console UART constraint. */
+    BTASSERT(power_stay_awake_acquire(POWER_MODE_IDLE) == 0);
+
+    return (0);
+}
+
+int main()
+{
+    struct harness_testcase_t testcases[] = {
+        { test_init, "test_init" },
+        { test_idle_mode, "test_idle_mode" },
+        { test_stay_awake, "test_stay_awake" },
+        { test_dma_transfer, "test_dma_transfer" },
+        { NULL, NULL }
+    };
+
+    sys_start();
+
+    harness_run(testcases);
+
+    return (0);
+}
@@ -0,0 +1,154 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2017-2018, Erik Moqvist
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use, copy,
+ * modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ * This file is part of the Simba project.
+ */
+
+#include "simba.h"
+
+static struct pin_device_t *pins[] = {
+    &pin_d2_dev,
+    &pin_d3_dev,
+    &pin_d4_dev,
+    &pin_d5_dev,
+    &pin_d6_dev,
+    &pin_d7_dev,
+    &pin_d8_dev,
+    &pin_d9_dev,
+    &pin_d10_dev
+};
+
+static int test_start_stop(void)
+{
+    struct pwm_soft_driver_t pwm_soft[2];
+
+    BTASSERT(pwm_soft_init(&pwm_soft[0],
+                           pins[0],
+                           pwm_soft_duty_cycle(25)) == 0);
+    BTASSERT(pwm_soft_init(&pwm_soft[1],
+                           pins[1],
+                           pwm_soft_duty_cycle(25)) == 0);
+
+    /* Both pins are set high at the start of the period. */
+    BTASSERT(pwm_soft_start(&pwm_soft[0]) == 0);
+    BTASSERT(pwm_soft_start(&pwm_soft[1]) == 0);
+    BTASSERT(pins[0]->value == 1);
+    BTASSERT(pins[1]->value == 1);
+
+    BTASSERT(pwm_soft_stop(&pwm_soft[0]) == 0);
+    BTASSERT(pwm_soft_stop(&pwm_soft[1]) == 0);
+
+    return (0);
+}
+
+static int test_set_duty_cycle(void)
+{
+    struct pwm_soft_driver_t pwm_soft;
+
+    BTASSERT(pwm_soft_init(&pwm_soft, pins[0], pwm_soft_duty_cycle(10)) == 0);
+    BTASSERT(pwm_soft_start(&pwm_soft) == 0);
+
+    /* Moved edge. */
+    BTASSERT(pwm_soft_set_duty_cycle(&pwm_soft,
+                                     pwm_soft_duty_cycle(50)) == 0);
+    BTASSERT(pwm_soft_duty_cycle_as_percent(
+                 pwm_soft_get_duty_cycle(&pwm_soft)) == 50);
+    BTASSERT(pins[0]->value == 1);
+
+    /* Out of and back into the edge table. */
+    BTASSERT(pwm_soft_set_duty_cycle(&pwm_soft, 0) == 0);
+    BTASSERT(pins[0]->value == 0);
+    BTASSERT(pwm_soft_set_duty_cycle(&pwm_soft,
+                                     pwm_soft_duty_cycle(100)) == 0);
+    BTASSERT(pins[0]->value == 1);
+    BTASSERT(pwm_soft_set_duty_cycle(&pwm_soft,
+                                     pwm_soft_duty_cycle(75)) == 0);
+    BTASSERT(pins[0]->value == 1);
+
+    BTASSERT(pwm_soft_stop(&pwm_soft) == 0);
+
+    return (0);
+}
+
+static int test_channels_max(void)
+{
+    struct pwm_soft_driver_t pwm_soft[CONFIG_PWM_SOFT_CHANNELS_MAX + 1];
+    int i;
+
+    for (i = 0; i < membersof(pwm_soft); i++) {
+        BTASSERT(pwm_soft_init(&pwm_soft[i],
+                               pins[i],
+                               pwm_soft_duty_cycle(10 * (i + 1))) == 0);
+    }
+
+    for (i = 0; i < CONFIG_PWM_SOFT_CHANNELS_MAX; i++) {
+        BTASSERT(pwm_soft_start(&pwm_soft[i]) == 0);
+    }
+
+    BTASSERT(pwm_soft_start(&pwm_soft[i]) == -ENOMEM);
+
+    /* Full and empty duty cycles do not use a channel. */
+    BTASSERT(pwm_soft_set_duty_cycle(&pwm_soft[i], 0) == 0);
+
+    for (i = 0; i < CONFIG_PWM_SOFT_CHANNELS_MAX; i++) {
+        BTASSERT(pwm_soft_stop(&pwm_soft[i]) == 0);
+    }
+
+    return (0);
+}
+
+static int test_set_frequency(void)
+{
+    struct pwm_soft_driver_t pwm_soft;
+
+    BTASSERT(pwm_soft_init(&pwm_soft, pins[0], pwm_soft_duty_cycle(50)) == 0);
+    BTASSERT(pwm_soft_start(&pwm_soft) == 0);
+
+    /* Not allowed with started software PWM:s. */
+    BTASSERT(pwm_soft_set_frequency(1000) == -1);
+
+    BTASSERT(pwm_soft_stop(&pwm_soft) == 0);
+    BTASSERT(pwm_soft_set_frequency(1000) == 0);
+    BTASSERT(pwm_soft_get_frequency() == 1000);
+
+    return (0);
+}
+
+int main()
+{
+    struct harness_testcase_t testcases[] = {
+        { test_start_stop, "test_start_stop" },
+        { test_set_duty_cycle, "test_set_duty_cycle" },
+        { test_channels_max, "test_channels_max" },
+        { test_set_frequency, "test_set_frequency" },
+        { NULL, NULL }
+    };
+
+    sys_start();
+
+    harness_run(testcases);
+
+    return (0);
+}
@@ -0,0 +1,146 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2014-2018, Erik Moqvist
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use, copy,
+ * modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ * This file is part of the Simba project.
+ */
+
+#include "simba.h"
+
+static int test_init(void)
+{
+    BTASSERT(random_module_init() == 0);
+    BTASSERT(random_module_init() == 0);
+
+    return (0);
+}
+
+static int test_crypto_read(void)
+{
+    uint8_t buf[32];
+
+    /* The hardware random number generator of the Linux port always
+       returns zero, so the key is all zeros and the output is the
+       ChaCha20 test vector from RFC 7539. The first four bytes were
+       used to seed the fast generator. */
+    BTASSERT(random_crypto_read(&buf[0], 28) == 28);
+    BTASSERTM(&buf[0],
+              "\x51\x57\x48\x8d\x77\x24\xe0\x3f"
+              "\xb8\xd8\x4a\x37\x6a\x43\xb8\xf4"
+              "\x15\x18\xa1\x1c\xc3\x87\xb6\x69"
+              "\xb2\xee\x65\x86",
+              28);
+
+    /* The next block is generated with the first half of the
+       previous block as key. */
+    BTASSERT(random_crypto_read(&buf[0], 32) == 32);
+    BTASSERTM(&buf[0],
+              "\xaf\xbd\xad\x28\x45\xb9\x3c\xdb"
+              "\xb2\xfe\x64\x63\xd2\xfe\x16\x2a"
+              "\xda\xe0\xf6\xe6\x76\xf0\x49\x42"
+              "\x18\xf5\xce\x05\x96\xe7\x9f\x5c",
+              32);
+
+    return (0);
+}
+
+static int test_crypto_reseed(void)
+{
+    uint8_t buf[200];
+    uint8_t zeros[16];
+
+    memset(&zeros[0], 0, sizeof(zeros));
+
+    /* Read over a few reseeds. */
+    memset(&buf[0], 0, sizeof(buf));
+    BTASSERT(random_crypto_read(&buf[0], sizeof(buf)) == sizeof(buf));
+    BTASSERT(memcmp(&buf[184], &zeros[0], sizeof(zeros)) != 0);
+
+    BTASSERT(random_crypto_reseed() == 0);
+    memset(&buf[0], 0, sizeof(buf));
+    BTASSERT(random_crypto_read(&buf[0], 16) == 16);
+    BTASSERT(memcmp(&buf[0], &zeros[0], sizeof(zeros)) != 0);
+
+    /* From isr context. */
+    sys_lock();
+    BTASSERT(random_crypto_read_isr(&buf[0], 3) == 3);
+    sys_unlock();
+
+    return (0);
+}
+
+static int test_fast_read(void)
+{
+    uint32_t values[8];
+    uint32_t ones;
+    int i;
+
+    /* The same seed gives the same sequence. */
+    BTASSERT(random_fast_seed(0) == 0);
+
+    for (i = 0; i < membersof(values); i++) {
+        values[i] = random_fast_read();
+    }
+
+    BTASSERT(random_fast_seed(0) == 0);
+
+    for (i = 0; i < membersof(values); i++) {
+        BTASSERT(random_fast_read() == values[i]);
+    }
+
+    /* Another seed gives another sequence. */
+    BTASSERT(random_fast_seed(1) == 0);
+    BTASSERT(random_fast_read() != values[0]);
+
+    /* About half of the bits are set. */
+    ones = 0;
+
+    for (i = 0; i < 1000; i++) {
+        sys_lock();
+        ones += __builtin_popcount(random_fast_read_isr());
+        sys_unlock();
+    }
+
+    BTASSERT(ones > 15000, "%lu", (unsigned long)ones);
+    BTASSERT(ones < 17000, "%lu", (unsigned long)ones);
+
+    return (0);
+}
+
+int main()
+{
+    struct harness_testcase_t testcases[] = {
+        { test_init, "test_init" },
+        { test_crypto_read, "test_crypto_read" },
+        { test_crypto_reseed, "test_crypto_reseed" },
+        { test_fast_read, "test_fast_read" },
+        { NULL, NULL }
+    };
+
+    sys_start();
+
+    harness_run(testcases);
+
+    return (0);
+}
@@ -0,0 +1,262 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2014-2018, Erik Moqvist
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use, copy,
+ * modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ * This file is part of the Simba project.
+ */
+
+#include "simba.h"
+
+#define RS_DEV_P      &pin_device[0]
+#define ENABLE_DEV_P  &pin_device[1]
+#define DATA_4_DEV_P  &pin_device[2]
+#define DATA_5_DEV_P  &pin_device[3]
+#define DATA_6_DEV_P  &pin_device[4]
+#define DATA_7_DEV_P  &pin_device[5]
+
+#define COMMAND(byte) (byte)
+#define DATA(byte) (0x100 | (byte))
+
+/* A model of the display bus, decoding written nibbles into
+   commands and data bytes. */
+static struct {
+    int rs;
+    uint8_t nibble;
+    int number_of_nibbles;
+    uint8_t high_nibble;
+    int log[64];
+    int length;
+} bus;
+
+static struct hd44780_driver_t hd44780;
+static uint8_t framebuffer[HD44780_FRAMEBUFFER_SIZE(2, 16)];
+
+int STUB(pin_device_write)(const struct pin_device_t *dev_p, int value)
+{
+    int bit;
+
+    if (dev_p == DATA_4_DEV_P) {
+        bit = 0x8;
+    } else if (dev_p == DATA_5_DEV_P) {
+        bit = 0x4;
+    } else if (dev_p == DATA_6_DEV_P) {
+        bit = 0x2;
+    } else {
+        bit = 0x1;
+    }
+
+    if (value) {
+        bus.nibble |= bit;
+    } else {
+        bus.nibble &= ~bit;
+    }
+
+    return (0);
+}
+
+int STUB(pin_port_device_write_high)(const struct pin_device_t *dev_p)
+{
+    if (dev_p == RS_DEV_P) {
+        bus.rs = 1;
+    } else if (dev_p == ENABLE_DEV_P) {
+        /* Nibble latched. */
+        if ((bus.number_of_nibbles % 2) == 0) {
+            bus.high_nibble = bus.nibble;
+        } else if (bus.length < membersof(bus.log)) {
+            bus.log[bus.length++] = ((bus.rs << 8)
+                                     | (bus.high_nibble << 4)
+                                     | bus.nibble);
+        }
+
+        bus.number_of_nibbles++;
+    }
+
+    return (0);
+}
+
+int STUB(pin_port_device_write_low)(const struct pin_device_t *dev_p)
+{
+    if (dev_p == RS_DEV_P) {
+        bus.rs = 0;
+    }
+
+    return (0);
+}
+
+int STUB(time_busy_wait_us)(int microseconds)
+{
+    return (0);
+}
+
+int STUB(thrd_sleep_ms)(int milliseconds)
+{
+    return (0);
+}
+
+int STUB(thrd_sleep_us)(long microseconds)
+{
+    return (0);
+}
+
+/**
+ * Compare the bus log to given commands and data bytes, and clear the
+ * log.
+ */
+static int assert_bus(const int *expected_p, int length)
+{
+    int i;
+
+    BTASSERTI(bus.length, ==, length);
+
+    for (i = 0; i < length; i++) {
+        BTASSERTI(bus.log[i], ==, expected_p[i]);
+    }
+
+    bus.length = 0;
+
+    return (0);
+}
+
+static int test_init(void)
+{
+    BTASSERT(hd44780_module_init() == 0);
+    BTASSERT(hd44780_init(&hd44780,
+                          RS_DEV_P,
+                          ENABLE_DEV_P,
+                          DATA_4_DEV_P,
+                          DATA_5_DEV_P,
+                          DATA_6_DEV_P,
+                          DATA_7_DEV_P,
+                          2,
+                          16) == 0);
+
+    /* No framebuffer. */
+    BTASSERT(hd44780_flush(&hd44780) == -ENOSYS);
+
+    /* Too small. */
+    BTASSERT(hd44780_framebuffer_init(&hd44780,
+                                      &framebuffer[0],
+                                      sizeof(framebuffer) - 1) == -EINVAL);
+    BTASSERT(hd44780_framebuffer_init(&hd44780,
+                                      &framebuffer[0],
+                                      sizeof(framebuffer)) == 0);
+
+    BTASSERT(hd44780_start(&hd44780) == 0);
+    BTASSERT(bus.length > 0);
+    bus.length = 0;
+
+    return (0);
+}
+
+static int test_flush(void)
+{
+    static const int display_1[] = {
+        COMMAND(0x80),
+        DATA('1'), DATA('2'), DATA(':'), DATA('0'), DATA('0')
+    };
+    static const int display_2[] = {
+        COMMAND(0x84), DATA('1')
+    };
+
+    /* Nothing is written before flushing. */
+    BTASSERT(hd44780_display(&hd44780, "12:00") == 0);
+    BTASSERT(bus.length == 0);
+
+    BTASSERT(hd44780_flush(&hd44780) == 5);
+    BTASSERT(assert_bus(display_1, membersof(display_1)) == 0);
+
+    /* Unmodified. */
+    BTASSERT(hd44780_display(&hd44780, "12:00") == 0);
+    BTASSERT(hd44780_flush(&hd44780) == 0);
+    BTASSERT(bus.length == 0);
+
+    /* Only the last digit. */
+    BTASSERT(hd44780_display(&hd44780, "12:01") == 0);
+    BTASSERT(hd44780_flush(&hd44780) == 1);
+    BTASSERT(assert_bus(display_2, membersof(display_2)) == 0);
+
+    return (0);
+}
+
+static int test_coalesce(void)
+{
+    static const int expected[] = {
+        COMMAND(0x84), DATA('2'),
+        COMMAND(0xc3), DATA('a'), DATA('b'),
+        COMMAND(0xca), DATA('d')
+    };
+
+    BTASSERT(hd44780_cursor_move(&hd44780, 1, 3) == 0);
+    BTASSERT(hd44780_write(&hd44780, "ab") == 0);
+    BTASSERT(hd44780_cursor_move(&hd44780, 1, 10) == 0);
+    BTASSERT(hd44780_put(&hd44780, 'c') == 0);
+    BTASSERT(hd44780_cursor_move(&hd44780, 0, 4) == 0);
+    BTASSERT(hd44780_put(&hd44780, '2') == 0);
+    BTASSERT(hd44780_cursor_move(&hd44780, 1, 10) == 0);
+    BTASSERT(hd44780_put(&hd44780, 'd') == 0);
+    BTASSERT(bus.length == 0);
+
+    BTASSERT(hd44780_flush(&hd44780) == 4);
+    BTASSERT(assert_bus(expected, membersof(expected)) == 0);
+
+    return (0);
+}
+
+static int test_clear(void)
+{
+    static const int expected[] = {
+        COMMAND(0x80),
+        DATA(' '), DATA(' '), DATA(' '), DATA(' '), DATA(' '),
+        COMMAND(0xc3), DATA(' '), DATA(' '),
+        COMMAND(0xca), DATA(' '),
+        /* The visible cursor is moved back home. */
+        COMMAND(0x80)
+    };
+
+    BTASSERT(hd44780_cursor_show(&hd44780) == 0);
+    bus.length = 0;
+
+    BTASSERT(hd44780_clear(&hd44780) == 0);
+    BTASSERT(hd44780_flush(&hd44780) == 8);
+    BTASSERT(assert_bus(expected, membersof(expected)) == 0);
+
+    return (0);
+}
+
+int main()
+{
+    struct harness_testcase_t testcases[] = {
+        { test_init, "test_init" },
+        { test_flush, "test_flush" },
+        { test_coalesce, "test_coalesce" },
+        { test_clear, "test_clear" },
+        { NULL, NULL }
+    };
+
+    sys_start();
+
+    harness_run(testcases);
+
+    return (0);
+}
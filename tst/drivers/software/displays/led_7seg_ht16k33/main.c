@@ -0,0 +1,103 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2014-2018, Erik Moqvist
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use, copy,
+ * modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ * This file is part of the Simba project.
+ */
+
+#include "simba.h"
+#include "drivers/network/i2c_soft_mock.h"
+
+#define ADDRESS LED_7SEG_HT16K33_DEFAULT_I2C_ADDR
+
+static struct led_7seg_ht16k33_driver_t display;
+static struct i2c_soft_driver_t i2c;
+
+static int test_start(void)
+{
+    mock_write_i2c_soft_module_init(0);
+    BTASSERT(led_7seg_ht16k33_module_init() == 0);
+    BTASSERT(led_7seg_ht16k33_init(&display, &i2c, ADDRESS) == 0);
+
+    mock_write_i2c_soft_start(0);
+    mock_write_i2c_soft_scan(ADDRESS, 1);
+    mock_write_i2c_soft_write(ADDRESS, "\x21", 1, 1);
+    mock_write_i2c_soft_write(ADDRESS, "\x81", 1, 1);
+    mock_write_i2c_soft_write(ADDRESS, "\xef", 1, 1);
+    BTASSERT(led_7seg_ht16k33_start(&display) == 0);
+
+    return (0);
+}
+
+static int test_display(void)
+{
+    /* The whole display is written the first time. */
+    BTASSERT(led_7seg_ht16k33_set_num(&display, 1234, 10) == 0);
+    mock_write_i2c_soft_write(ADDRESS,
+                              "\x00\x06\x00\x5b\x00\x00\x00\x4f\x00\x66",
+                              10,
+                              10);
+    BTASSERT(led_7seg_ht16k33_display(&display) == 0);
+
+    /* Unchanged. */
+    BTASSERT(led_7seg_ht16k33_set_num(&display, 1234, 10) == 0);
+    BTASSERT(led_7seg_ht16k33_display(&display) == 0);
+
+    /* Only the last digit. */
+    BTASSERT(led_7seg_ht16k33_set_num(&display, 1235, 10) == 0);
+    mock_write_i2c_soft_write(ADDRESS, "\x08\x6d", 2, 2);
+    BTASSERT(led_7seg_ht16k33_display(&display) == 0);
+
+    /* Several updates are coalesced into one write of the changed
+       range, from the colon to the last digit. */
+    BTASSERT(led_7seg_ht16k33_set_num(&display, 1236, 10) == 0);
+    BTASSERT(led_7seg_ht16k33_show_colon(&display, 1) == 0);
+    BTASSERT(led_7seg_ht16k33_set_num(&display, 1237, 10) == 0);
+    mock_write_i2c_soft_write(ADDRESS, "\x04\x02\x00\x4f\x00\x07", 6, 6);
+    BTASSERT(led_7seg_ht16k33_display(&display) == 0);
+
+    /* A failed write is retried by the next display. */
+    BTASSERT(led_7seg_ht16k33_show_dot(&display, 0, 1) == 0);
+    mock_write_i2c_soft_write(ADDRESS, "\x00\x86", 2, -EIO);
+    BTASSERT(led_7seg_ht16k33_display(&display) == -EIO);
+    mock_write_i2c_soft_write(ADDRESS, "\x00\x86", 2, 2);
+    BTASSERT(led_7seg_ht16k33_display(&display) == 0);
+
+    return (0);
+}
+
+int main()
+{
+    struct harness_testcase_t testcases[] = {
+        { test_start, "test_start" },
+        { test_display, "test_display" },
+        { NULL, NULL }
+    };
+
+    sys_start();
+
+    harness_run(testcases);
+
+    return (0);
+}
@@ -0,0 +1,146 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2018, Erik Moqvist
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use, copy,
+ * modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ * This file is part of the Simba project.
+ */
+
+#include "simba.h"
+
+static struct can_driver_t can;
+static struct can_frame_t rxbuf[8];
+
+static void rx(uint32_t id, int extended_frame)
+{
+    struct can_frame_t frame;
+
+    memset(&frame, 0, sizeof(frame));
+    frame.id = id;
+    frame.extended_frame = extended_frame;
+    frame.size = 1;
+    frame.data.u8[0] = id;
+
+    sys_lock();
+    can_port_device_rx_isr(&can_device[0], &frame);
+    sys_unlock();
+}
+
+static int test_read_many(void)
+{
+    struct can_frame_t frames[4];
+
+    BTASSERT(can_module_init() == 0);
+    BTASSERT(can_init(&can,
+                      &can_device[0],
+                      CAN_SPEED_500KBPS,
+                      &rxbuf[0],
+                      sizeof(rxbuf)) == 0);
+    BTASSERT(can_start(&can) == 0);
+
+    rx(1, 0);
+    rx(2, 0);
+    rx(3, 1);
+
+    /* All buffered frames are read in a single call. */
+    BTASSERT(can_read_many(&can, &frames[0], membersof(frames)) == 3);
+    BTASSERT(frames[0].id == 1);
+    BTASSERT(frames[1].id == 2);
+    BTASSERT(frames[2].id == 3);
+    BTASSERT(frames[2].extended_frame == 1);
+    BTASSERT(frames[0].timestamp <= frames[2].timestamp);
+
+    /* Limited by the array length. */
+    rx(4, 0);
+    rx(5, 0);
+    rx(6, 0);
+    BTASSERT(can_read_many(&can, &frames[0], 2) == 2);
+    BTASSERT(frames[0].id == 4);
+    BTASSERT(frames[1].id == 5);
+    BTASSERT(can_read_many(&can, &frames[0], 2) == 1);
+    BTASSERT(frames[0].id == 6);
+
+    BTASSERT(can_stop(&can) == 0);
+
+    return (0);
+}
+
+static int test_filters(void)
+{
+    struct can_frame_t frames[4];
+    static const struct can_filter_t filters[] = {
+        { .id = 0x100, .mask = 0x7f0, .extended_frame = 0 },
+        { .id = 0x12345678, .mask = 0x1fffffff, .extended_frame = 1 }
+    };
+
+    BTASSERT(can_init(&can,
+                      &can_device[0],
+                      CAN_SPEED_500KBPS,
+                      &rxbuf[0],
+                      sizeof(rxbuf)) == 0);
+    BTASSERT(can_set_filters(&can, &filters[0], membersof(filters)) == 0);
+    BTASSERT(can_start(&can) == 0);
+
+    rx(0x100, 0);
+    rx(0x200, 0);
+    rx(0x10f, 0);
+    rx(0x100, 1);
+    rx(0x12345678, 1);
+    rx(0x12345679, 1);
+
+    BTASSERT(can_read_many(&can, &frames[0], membersof(frames)) == 3);
+    BTASSERT(frames[0].id == 0x100);
+    BTASSERT(frames[0].extended_frame == 0);
+    BTASSERT(frames[1].id == 0x10f);
+    BTASSERT(frames[2].id == 0x12345678);
+    BTASSERT(frames[2].extended_frame == 1);
+
+    /* Accept all frames again. */
+    BTASSERT(can_stop(&can) == 0);
+    BTASSERT(can_set_filters(&can, NULL, 0) == 0);
+    BTASSERT(can_start(&can) == 0);
+
+    rx(0x200, 0);
+    BTASSERT(can_read(&can, &frames[0], sizeof(frames[0]))
+             == sizeof(frames[0]));
+    BTASSERT(frames[0].id == 0x200);
+
+    BTASSERT(can_stop(&can) == 0);
+
+    return (0);
+}
+
+int main()
+{
+    struct harness_testcase_t testcases[] = {
+        { test_read_many, "test_read_many" },
+        { test_filters, "test_filters" },
+        { NULL, NULL }
+    };
+
+    sys_start();
+
+    harness_run(testcases);
+
+    return (0);
+}
@@ -0,0 +1,209 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2018, Erik Moqvist
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use, copy,
+ * modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ * This file is part of the Simba project.
+ */
+
+#include "simba.h"
+
+static struct i2c_driver_t i2c[2];
+
+struct callback_t {
+    int count;
+    int order[4];
+    ssize_t res[4];
+};
+
+static struct callback_t callback;
+
+static void on_complete(void *arg_p, ssize_t res)
+{
+    callback.order[callback.count] = (int)(uintptr_t)arg_p;
+    callback.res[callback.count] = res;
+    callback.count++;
+}
+
+static int test_init(void)
+{
+    BTASSERT(i2c_module_init() == 0);
+    BTASSERT(i2c_module_init() == 0);
+
+    BTASSERT(i2c_init(&i2c[0],
+                      &i2c_device[0],
+                      I2C_BAUDRATE_100KBPS,
+                      -1) == 0);
+    BTASSERT(i2c_init(&i2c[1],
+                      &i2c_device[0],
+                      I2C_BAUDRATE_400KBPS,
+                      -1) == 0);
+    BTASSERT(i2c_start(&i2c[0]) == 0);
+
+    return (0);
+}
+
+static int test_write(void)
+{
+    uint8_t buf[3];
+
+    memset(&buf[0], 0, sizeof(buf));
+
+    BTASSERT(i2c_write(&i2c[0], 0x12, &buf[0], sizeof(buf)) == 3);
+
+    /* Reads always fails in this port. */
+    BTASSERT(i2c_read(&i2c[0], 0x12, &buf[0], sizeof(buf)) == -1);
+
+    return (0);
+}
+
+static int test_transaction_init(void)
+{
+    struct i2c_transaction_t transaction;
+    struct i2c_message_t message;
+    uint8_t buf[4];
+
+    message.buf_p = &buf[0];
+    message.size = sizeof(buf);
+    message.flags = I2C_MESSAGE_WRITE;
+
+    BTASSERT(i2c_transaction_init(&transaction, 0x12, &message, 1) == 0);
+    BTASSERT(i2c_transaction_set_callback(&transaction,
+                                          on_complete,
+                                          NULL) == 0);
+
+    /* A transaction that was never queued is not waited for. */
+    BTASSERT(i2c_transaction_wait(&transaction) == 0);
+
+    return (0);
+}
+
+static int test_async(void)
+{
+    struct i2c_transaction_t transactions[3];
+    struct i2c_message_t messages[4];
+    uint8_t reg;
+    uint8_t buf[6];
+    int i;
+
+    memset(&callback, 0, sizeof(callback));
+    reg = 0xf7;
+
+    /* Write register, repeated start and read. */
+    messages[0].buf_p = &reg;
+    messages[0].size = sizeof(reg);
+    messages[0].flags = I2C_MESSAGE_WRITE;
+    messages[1].buf_p = &buf[0];
+    messages[1].size = sizeof(buf);
+    messages[1].flags = I2C_MESSAGE_READ;
+
+    /* Two writes. */
+    messages[2].buf_p = &buf[0];
+    messages[2].size = 2;
+    messages[2].flags = I2C_MESSAGE_WRITE;
+    messages[3].buf_p = &buf[2];
+    messages[3].size = 4;
+    messages[3].flags = I2C_MESSAGE_WRITE;
+
+    BTASSERT(i2c_transaction_init(&transactions[0],
+                                  0x76,
+                                  &messages[0],
+                                  2) == 0);
+    BTASSERT(i2c_transaction_init(&transactions[1],
+                                  0x44,
+                                  &messages[2],
+                                  2) == 0);
+    BTASSERT(i2c_transaction_init(&transactions[2],
+                                  0x68,
+                                  &messages[3],
+                                  1) == 0);
+
+    for (i = 0; i < membersof(transactions); i++) {
+        BTASSERT(i2c_transaction_set_callback(&transactions[i],
+                                              on_complete,
+                                              (void *)(uintptr_t)i) == 0);
+    }
+
+    /* Queue transactions of both drivers on the bus. */
+    BTASSERT(i2c_transfer_async(&i2c[0], &transactions[0]) == 0);
+    BTASSERT(i2c_transfer_async(&i2c[1], &transactions[1]) == 0);
+    BTASSERT(i2c_transfer_async(&i2c[0], &transactions[2]) == 0);
+
+    BTASSERT(i2c_transaction_wait(&transactions[0]) == -1);
+    BTASSERT(i2c_transaction_wait(&transactions[1]) == 6);
+    BTASSERT(i2c_transaction_wait(&transactions[2]) == 4);
+
+    /* Completed in queue order. */
+    BTASSERT(callback.count == 3);
+
+    for (i = 0; i < membersof(transactions); i++) {
+        BTASSERT(callback.order[i] == i);
+    }
+
+    BTASSERT(callback.res[0] == -1);
+    BTASSERT(callback.res[1] == 6);
+    BTASSERT(callback.res[2] == 4);
+
+    /* Completed transactions can be queued again. */
+    BTASSERT(i2c_transfer_async(&i2c[1], &transactions[1]) == 0);
+    BTASSERT(i2c_transaction_wait(&transactions[1]) == 6);
+    BTASSERT(callback.count == 4);
+
+    return (0);
+}
+
+static int test_write_read(void)
+{
+    uint8_t reg;
+    uint8_t buf[2];
+
+    reg = 0x00;
+
+    /* Reads always fails in this port. */
+    BTASSERT(i2c_write_read(&i2c[0],
+                            0x68,
+                            &reg,
+                            sizeof(reg),
+                            &buf[0],
+                            sizeof(buf)) == -1);
+
+    return (0);
+}
+
+int main()
+{
+    struct harness_testcase_t testcases[] = {
+        { test_init, "test_init" },
+        { test_write, "test_write" },
+        { test_transaction_init, "test_transaction_init" },
+        { test_async, "test_async" },
+        { test_write_read, "test_write_read" },
+        { NULL, NULL }
+    };
+
+    sys_start();
+
+    harness_run(testcases);
+
+    return (0);
+}
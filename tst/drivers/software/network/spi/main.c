@@ -0,0 +1,211 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2018, Erik Moqvist
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use, copy,
+ * modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ * This file is part of the Simba project.
+ */
+
+#include "simba.h"
+
+static struct spi_driver_t spi[2];
+
+struct callback_t {
+    int count;
+    int order[4];
+    int ss[4];
+    ssize_t res[4];
+};
+
+static struct callback_t callback;
+
+static void on_complete(void *arg_p, ssize_t res)
+{
+    struct spi_driver_t *drv_p;
+
+    drv_p = arg_p;
+    callback.order[callback.count] = (drv_p - &spi[0]);
+    callback.ss[callback.count] = drv_p->ss.dev_p->value;
+    callback.res[callback.count] = res;
+    callback.count++;
+}
+
+static int test_init(void)
+{
+    BTASSERT(spi_module_init() == 0);
+    BTASSERT(spi_module_init() == 0);
+
+    BTASSERT(spi_init(&spi[0],
+                      &spi_device[0],
+                      &pin_d10_dev,
+                      SPI_MODE_MASTER,
+                      SPI_SPEED_1MBPS,
+                      0,
+                      0) == 0);
+    BTASSERT(spi_init(&spi[1],
+                      &spi_device[0],
+                      &pin_d9_dev,
+                      SPI_MODE_MASTER,
+                      SPI_SPEED_1MBPS,
+                      0,
+                      0) == 0);
+
+    BTASSERT(spi_deselect(&spi[0]) == 0);
+    BTASSERT(spi_deselect(&spi[1]) == 0);
+
+    return (0);
+}
+
+static int test_transfer(void)
+{
+    uint8_t buf[4];
+
+    memset(&buf[0], 0, sizeof(buf));
+
+    BTASSERT(spi_take_bus(&spi[0]) == 0);
+    BTASSERT(spi_select(&spi[0]) == 0);
+    BTASSERT(spi_transfer(&spi[0], &buf[0], &buf[0], sizeof(buf)) == 4);
+    BTASSERT(spi_read(&spi[0], &buf[0], sizeof(buf)) == 4);
+    BTASSERT(spi_write(&spi[0], &buf[0], sizeof(buf)) == 4);
+    BTASSERT(spi_deselect(&spi[0]) == 0);
+    BTASSERT(spi_give_bus(&spi[0]) == 0);
+
+    return (0);
+}
+
+static int test_transaction_init(void)
+{
+    struct spi_transaction_t transaction;
+    uint8_t buf[4];
+
+    BTASSERT(spi_transaction_init(&transaction,
+                                  &buf[0],
+                                  NULL,
+                                  sizeof(buf),
+                                  SPI_TRANSACTION_SELECT) == 0);
+    BTASSERT(spi_transaction_set_callback(&transaction,
+                                          on_complete,
+                                          &spi[0]) == 0);
+
+    /* A transaction that was never queued is not waited for. */
+    BTASSERT(spi_transaction_wait(&transaction) == 0);
+
+    return (0);
+}
+
+static int test_async_pipelined(void)
+{
+    struct spi_transaction_t transactions[3];
+    uint8_t command;
+    uint8_t buf[8];
+    int i;
+
+    memset(&callback, 0, sizeof(callback));
+    command = 0x03;
+
+    /* A command followed by a data read within the same slave
+       select, then a write to the second slave. */
+    BTASSERT(spi_transaction_init(&transactions[0],
+                                  NULL,
+                                  &command,
+                                  1,
+                                  SPI_TRANSACTION_SELECT) == 0);
+    BTASSERT(spi_transaction_init(&transactions[1],
+                                  &buf[0],
+                                  NULL,
+                                  sizeof(buf),
+                                  SPI_TRANSACTION_DESELECT) == 0);
+    BTASSERT(spi_transaction_init(&transactions[2],
+                                  NULL,
+                                  &buf[0],
+                                  3,
+                                  (SPI_TRANSACTION_SELECT
+                                   | SPI_TRANSACTION_DESELECT)) == 0);
+
+    for (i = 0; i < 2; i++) {
+        BTASSERT(spi_transaction_set_callback(&transactions[i],
+                                              on_complete,
+                                              &spi[0]) == 0);
+    }
+
+    BTASSERT(spi_transaction_set_callback(&transactions[2],
+                                          on_complete,
+                                          &spi[1]) == 0);
+
+    BTASSERT(spi_take_bus(&spi[0]) == 0);
+    BTASSERT(spi_transfer_async(&spi[0], &transactions[0]) == 0);
+    BTASSERT(spi_transfer_async(&spi[0], &transactions[1]) == 0);
+    BTASSERT(spi_give_bus(&spi[0]) == 0);
+
+    BTASSERT(spi_take_bus(&spi[1]) == 0);
+    BTASSERT(spi_transfer_async(&spi[1], &transactions[2]) == 0);
+    BTASSERT(spi_give_bus(&spi[1]) == 0);
+
+    /* Wait in reverse order. */
+    BTASSERT(spi_transaction_wait(&transactions[2]) == 3);
+    BTASSERT(spi_transaction_wait(&transactions[1]) == 8);
+    BTASSERT(spi_transaction_wait(&transactions[0]) == 1);
+
+    /* Completed in queue order, with the slave select pin low until
+       the last transfer of each slave was complete. */
+    BTASSERT(callback.count == 3);
+    BTASSERT(callback.order[0] == 0);
+    BTASSERT(callback.ss[0] == 0);
+    BTASSERT(callback.res[0] == 1);
+    BTASSERT(callback.order[1] == 0);
+    BTASSERT(callback.ss[1] == 1);
+    BTASSERT(callback.res[1] == 8);
+    BTASSERT(callback.order[2] == 1);
+    BTASSERT(callback.ss[2] == 1);
+    BTASSERT(callback.res[2] == 3);
+
+    /* The bus was reconfigured for the second slave. */
+    BTASSERT(spi_device[0].drv_p == &spi[1]);
+
+    /* The transactions can be queued again once complete. */
+    BTASSERT(spi_take_bus(&spi[0]) == 0);
+    BTASSERT(spi_transfer_async(&spi[0], &transactions[0]) == 0);
+    BTASSERT(spi_transaction_wait(&transactions[0]) == 1);
+    BTASSERT(spi_deselect(&spi[0]) == 0);
+    BTASSERT(spi_give_bus(&spi[0]) == 0);
+    BTASSERT(callback.count == 4);
+
+    return (0);
+}
+
+int main()
+{
+    struct harness_testcase_t testcases[] = {
+        { test_init, "test_init" },
+        { test_transfer, "test_transfer" },
+        { test_transaction_init, "test_transaction_init" },
+        { test_async_pipelined, "test_async_pipelined" },
+        { NULL, NULL }
+    };
+
+    sys_start();
+
+    harness_run(testcases);
+
+    return (0);
+}
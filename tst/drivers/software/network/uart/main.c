@@ -0,0 +1,160 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2018, Erik Moqvist
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use, copy,
+ * modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ * This file is part of the Simba project.
+ */
+
+#include "simba.h"
+
+static struct uart_driver_t uart;
+static uint8_t rxbuf[16];
+static int writer_done;
+
+static void rx(const char *buf_p, size_t size)
+{
+    sys_lock();
+    uart_port_device_rx_isr(&uart_device[1], buf_p, size);
+    sys_unlock();
+}
+
+static void *writer_main(void *arg_p)
+{
+    thrd_set_name("writer");
+
+    uart_write(&uart, "hi\n", 3);
+    writer_done = 1;
+
+    thrd_suspend(NULL);
+
+    return (NULL);
+}
+
+static int test_rts_cts(void)
+{
+    char buf[8];
+    int i;
+
+    BTASSERT(uart_module_init() == 0);
+    BTASSERT(uart_init(&uart,
+                       &uart_device[1],
+                       115200,
+                       &rxbuf[0],
+                       sizeof(rxbuf)) == 0);
+    BTASSERT(uart_set_flow_control(&uart,
+                                   UART_FLOW_CONTROL_RTS_CTS,
+                                   &pin_d2_dev,
+                                   8,
+                                   4) == 0);
+    BTASSERT(uart_start(&uart) == 0);
+    BTASSERT(pin_d2_dev.value == 0);
+
+    /* Stop the sender at the high water mark. */
+    rx("0123456", 7);
+    BTASSERT(pin_d2_dev.value == 0);
+    rx("7", 1);
+    BTASSERT(pin_d2_dev.value == 1);
+    rx("89", 2);
+    BTASSERT(pin_d2_dev.value == 1);
+
+    /* Resume the sender once drained to the low water mark. */
+    BTASSERT(uart_read(&uart, &buf[0], 4) == 4);
+    BTASSERT(memcmp(&buf[0], "0123", 4) == 0);
+    BTASSERT(pin_d2_dev.value == 1);
+    BTASSERT(uart_read(&uart, &buf[0], 2) == 2);
+    BTASSERT(memcmp(&buf[0], "45", 2) == 0);
+    BTASSERT(pin_d2_dev.value == 0);
+
+    for (i = 0; i < 4; i++) {
+        BTASSERT(uart_read(&uart, &buf[i], 1) == 1);
+    }
+
+    BTASSERT(memcmp(&buf[0], "6789", 4) == 0);
+    BTASSERT(uart_stop(&uart) == 0);
+
+    return (0);
+}
+
+static int test_xon_xoff(void)
+{
+    static THRD_STACK(stack, 1024);
+    char buf[8];
+    char xon;
+    char xoff;
+
+    xon = UART_XON;
+    xoff = UART_XOFF;
+
+    BTASSERT(uart_init(&uart,
+                       &uart_device[1],
+                       115200,
+                       &rxbuf[0],
+                       sizeof(rxbuf)) == 0);
+    BTASSERT(uart_set_flow_control(&uart,
+                                   UART_FLOW_CONTROL_XON_XOFF,
+                                   NULL,
+                                   8,
+                                   4) == 0);
+    BTASSERT(uart_start(&uart) == 0);
+
+    /* A received XOFF stops transmission and is not written to the
+       receive queue. */
+    rx("ab", 2);
+    rx(&xoff, 1);
+    rx("c", 1);
+
+    writer_done = 0;
+    BTASSERT(thrd_spawn(writer_main,
+                        NULL,
+                        0,
+                        stack,
+                        sizeof(stack)) != NULL);
+    thrd_sleep_ms(20);
+    BTASSERT(writer_done == 0);
+
+    rx(&xon, 1);
+    thrd_sleep_ms(20);
+    BTASSERT(writer_done == 1);
+
+    BTASSERT(uart_read(&uart, &buf[0], 3) == 3);
+    BTASSERT(memcmp(&buf[0], "abc", 3) == 0);
+    BTASSERT(uart_stop(&uart) == 0);
+
+    return (0);
+}
+
+int main()
+{
+    struct harness_testcase_t testcases[] = {
+        { test_rts_cts, "test_rts_cts" },
+        { test_xon_xoff, "test_xon_xoff" },
+        { NULL, NULL }
+    };
+
+    sys_start();
+
+    harness_run(testcases);
+
+    return (0);
+}
@@ -160,6 +160,103 @@ static int test_read_unescape(void)
     return (0);
 }
 
+static int test_decoder(void)
+{
+    struct xbee_decoder_t decoder;
+    struct xbee_frame_t frame;
+    size_t size;
+    size_t i;
+    const uint8_t buf[] = {
+        /* Garbage before the first frame. */
+        0x55, 0x66,
+        /* Escaped data. */
+        0x7e, 0x00, 0x02, 0x23, 0x7d, 0x31, 0xcb,
+        /* AT Command Response. */
+        0x7e, 0x00, 0x05, 0x88, 0x01, 0x44, 0x4c, 0x00, 0xe6
+    };
+    const uint8_t bad_crc[] = {
+        0x7e, 0x00, 0x01, 0x8a, 0x00
+    };
+    const uint8_t interrupted[] = {
+        0x7e, 0x00, 0x05, 0x88,
+        0x7e, 0x00, 0x02, 0x8a, 0x06, 0x6f
+    };
+    const uint8_t bad_escape[] = {
+        0x7e, 0x00, 0x02, 0x23, 0x7d, 0x00
+    };
+    const uint8_t too_big[] = {
+        0x7e, 0x00, 0xff
+    };
+
+    BTASSERT(xbee_decoder_init(&decoder, &frame) == 0);
+
+    /* Two frames in one buffer. */
+    size = sizeof(buf);
+    BTASSERTI(xbee_decoder_input(&decoder, &buf[0], &size), ==, 1);
+    BTASSERTI(size, ==, 9);
+    BTASSERTI(frame.type, ==, 0x23);
+    BTASSERTI(frame.data.size, ==, 1);
+    BTASSERTI(frame.data.buf[0], ==, 0x11);
+
+    size = (sizeof(buf) - 9);
+    BTASSERTI(xbee_decoder_input(&decoder, &buf[9], &size), ==, 1);
+    BTASSERTI(size, ==, sizeof(buf) - 9);
+    BTASSERTI(frame.type, ==, XBEE_FRAME_TYPE_AT_COMMAND_RESPONSE);
+    BTASSERTI(frame.data.size, ==, 4);
+    BTASSERTM(&frame.data.buf[0], "\x01""DL\x00", 4);
+
+    /* One byte at a time. */
+    for (i = 9; i < sizeof(buf) - 1; i++) {
+        size = 1;
+        BTASSERTI(xbee_decoder_input(&decoder, &buf[i], &size), ==, 0);
+        BTASSERTI(size, ==, 1);
+    }
+
+    size = 1;
+    BTASSERTI(xbee_decoder_input(&decoder, &buf[i], &size), ==, 1);
+    BTASSERTI(frame.type, ==, XBEE_FRAME_TYPE_AT_COMMAND_RESPONSE);
+    BTASSERTI(frame.data.size, ==, 4);
+
+    /* Bad CRC. */
+    size = sizeof(bad_crc);
+    BTASSERTI(xbee_decoder_input(&decoder, &bad_crc[0], &size), ==, -EPROTO);
+    BTASSERTI(size, ==, sizeof(bad_crc));
+
+    /* A frame delimiter in a frame starts a new frame. */
+    size = sizeof(interrupted);
+    BTASSERTI(xbee_decoder_input(&decoder,
+                                 &interrupted[0],
+                                 &size), ==, -EPROTO);
+    BTASSERTI(size, ==, 5);
+
+    size = (sizeof(interrupted) - 5);
+    BTASSERTI(xbee_decoder_input(&decoder,
+                                 &interrupted[5],
+                                 &size), ==, 1);
+    BTASSERTI(frame.type, ==, XBEE_FRAME_TYPE_MODEM_STATUS);
+    BTASSERTI(frame.data.size, ==, 1);
+    BTASSERTI(frame.data.buf[0], ==, 0x06);
+
+    /* Bad escaped byte. */
+    size = sizeof(bad_escape);
+    BTASSERTI(xbee_decoder_input(&decoder,
+                                 &bad_escape[0],
+                                 &size), ==, -EPROTO);
+    BTASSERTI(size, ==, sizeof(bad_escape));
+
+    /* Too big frame. */
+    size = sizeof(too_big);
+    BTASSERTI(xbee_decoder_input(&decoder, &too_big[0], &size), ==, -ENOMEM);
+    BTASSERTI(size, ==, sizeof(too_big));
+
+    /* Data after a dropped frame is ignored until next delimiter. */
+    size = sizeof(buf);
+    BTASSERTI(xbee_decoder_input(&decoder, &buf[0], &size), ==, 1);
+    BTASSERTI(frame.type, ==, 0x23);
+
+    return (0);
+}
+
 static int test_frame_type_as_string(void)
 {
     const char *actual_p;
@@ -550,6 +647,7 @@ int main()
         { test_write_at, "test_write_at" },
         { test_write_tx_request, "test_write_tx_request" },
         { test_read_unescape, "test_read_unescape" },
+        { test_decoder, "test_decoder" },
         { test_frame_type_as_string, "test_frame_type_as_string" },
         { test_tx_status_as_string, "test_tx_status_as_string" },
         { test_modem_status_as_string, "test_modem_status_as_string" },
@@ -37,6 +37,11 @@ static THRD_STACK(client_stack, 512);
 static struct queue_t queue;
 static uint8_t queue_buf[256];
 
+static ssize_t transport_read(void *self_p, void *buf_p, size_t size)
+{
+    return (size);
+}
+
 static int test_init(void)
 {
     BTASSERT(xbee_client_module_init() == 0);
@@ -46,7 +51,7 @@ static int test_init(void)
     BTASSERT(queue_init(&queue, &queue_buf[0], sizeof(queue_buf)) == 0);
 
     BTASSERT(chan_init(&transport,
-                       chan_read_null,
+                       transport_read,
                        chan_write_null,
                        chan_size_null) == 0);
     BTASSERT(xbee_client_init(&xbee,
@@ -77,7 +82,7 @@ static int test_rx_packet_16_bits_address(void)
     frame.type = 0x81;
     frame.data.size = 7;
     memcpy(&frame.data.buf[0], "\x12\x34\x37\x05""foo", frame.data.size);
-    harness_mock_write("xbee_read(): return (frame)",
+    harness_mock_write("xbee_decoder_input(): return (frame)",
                        &frame,
                        sizeof(frame));
     mask = 1;
@@ -111,7 +116,7 @@ static int test_rx_packet_64_bits_address(void)
     memcpy(&frame.data.buf[0],
            "\x88\x77\x66\x55\x44\x33\x22\x11"
            "\x00\x01""foobar", frame.data.size);
-    harness_mock_write("xbee_read(): return (frame)",
+    harness_mock_write("xbee_decoder_input(): return (frame)",
                        &frame,
                        sizeof(frame));
     mask = 1;
@@ -143,7 +148,7 @@ static int test_rx_packet_16_bits_address_short(void)
     frame.type = 0x81;
     frame.data.size = 7;
     memcpy(&frame.data.buf[0], "\x12\x34\x37\x05""bar", frame.data.size);
-    harness_mock_write("xbee_read(): return (frame)",
+    harness_mock_write("xbee_decoder_input(): return (frame)",
                        &frame,
                        sizeof(frame));
     mask = 1;
@@ -177,7 +182,7 @@ static int test_rx_packet_64_bits_address_short(void)
     memcpy(&frame.data.buf[0],
            "\x88\x77\x66\x55\x44\x33\x22\x11"
            "\x00\x01""hello", frame.data.size);
-    harness_mock_write("xbee_read(): return (frame)",
+    harness_mock_write("xbee_decoder_input(): return (frame)",
                        &frame,
                        sizeof(frame));
     mask = 1;
@@ -207,7 +212,7 @@ static int test_rx_packet_16_bits_address_bad_size(void)
     frame.type = 0x81;
     frame.data.size = 3;
     memcpy(&frame.data.buf[0], "\x12\x34\x37", frame.data.size);
-    harness_mock_write("xbee_read(): return (frame)",
+    harness_mock_write("xbee_decoder_input(): return (frame)",
                        &frame,
                        sizeof(frame));
     mask = 1;
@@ -233,7 +238,7 @@ static int test_rx_packet_64_bits_address_bad_size(void)
     memcpy(&frame.data.buf[0],
            "\x88\x77\x66\x55\x44\x33\x22\x11"
            "\x00", frame.data.size);
-    harness_mock_write("xbee_read(): return (frame)",
+    harness_mock_write("xbee_decoder_input(): return (frame)",
                        &frame,
                        sizeof(frame));
     mask = 1;
@@ -259,7 +264,7 @@ static int test_rx_packet_16_bits_address_no_data(void)
     frame.type = 0x81;
     frame.data.size = 4;
     memcpy(&frame.data.buf[0], "\x12\x34\x37\x05", frame.data.size);
-    harness_mock_write("xbee_read(): return (frame)",
+    harness_mock_write("xbee_decoder_input(): return (frame)",
                        &frame,
                        sizeof(frame));
     mask = 1;
@@ -292,7 +297,7 @@ static int test_rx_packet_64_bits_address_no_data(void)
     memcpy(&frame.data.buf[0],
            "\x88\x77\x66\x55\x44\x33\x22\x11"
            "\x00\x01", frame.data.size);
-    harness_mock_write("xbee_read(): return (frame)",
+    harness_mock_write("xbee_decoder_input(): return (frame)",
                        &frame,
                        sizeof(frame));
     mask = 1;
@@ -322,7 +327,7 @@ static int test_tx_packet_16_bits_address(void)
     frame.type = 0x89;
     frame.data.size = 2;
     memcpy(&frame.data.buf[0], "\x01\x00", frame.data.size);
-    harness_mock_write("xbee_read(): return (frame)",
+    harness_mock_write("xbee_decoder_input(): return (frame)",
                        &frame,
                        sizeof(frame));
     mask = 1;
@@ -417,7 +422,7 @@ static int test_pin_set_mode(void)
     frame.type = 0x88;
     frame.data.size = 4;
     memcpy(&frame.data.buf[0], "\x03""D0\x00", frame.data.size);
-    harness_mock_write("xbee_read(): return (frame)",
+    harness_mock_write("xbee_decoder_input(): return (frame)",
                        &frame,
                        sizeof(frame));
     mask = 1;
@@ -445,7 +450,7 @@ static int test_pin_write_high(void)
     frame.type = 0x88;
     frame.data.size = 4;
     memcpy(&frame.data.buf[0], "\x04""D0\x00", frame.data.size);
-    harness_mock_write("xbee_read(): return (frame)",
+    harness_mock_write("xbee_decoder_input(): return (frame)",
                        &frame,
                        sizeof(frame));
     mask = 1;
@@ -473,7 +478,7 @@ static int test_pin_toggle(void)
     frame.type = 0x88;
     frame.data.size = 4;
     memcpy(&frame.data.buf[0], "\x05""D0\x00", frame.data.size);
-    harness_mock_write("xbee_read(): return (frame)",
+    harness_mock_write("xbee_decoder_input(): return (frame)",
                        &frame,
                        sizeof(frame));
     mask = 1;
@@ -481,7 +486,7 @@ static int test_pin_toggle(void)
 
     /* Toggle high. */
     frame.data.buf[0] = 6;
-    harness_mock_write("xbee_read(): return (frame)",
+    harness_mock_write("xbee_decoder_input(): return (frame)",
                        &frame,
                        sizeof(frame));
     mask = 1;
@@ -515,7 +520,7 @@ static int test_at_command_read_u8(void)
     frame.type = 0x88;
     frame.data.size = 5;
     memcpy(&frame.data.buf[0], "\x07""DL\x00\xbe", frame.data.size);
-    harness_mock_write("xbee_read(): return (frame)",
+    harness_mock_write("xbee_decoder_input(): return (frame)",
                        &frame,
                        sizeof(frame));
     mask = 1;
@@ -547,7 +552,7 @@ static int test_at_command_read_u16(void)
     frame.type = 0x88;
     frame.data.size = 6;
     memcpy(&frame.data.buf[0], "\x08""DL\x00\xca\xfe", frame.data.size);
-    harness_mock_write("xbee_read(): return (frame)",
+    harness_mock_write("xbee_decoder_input(): return (frame)",
                        &frame,
                        sizeof(frame));
     mask = 1;
@@ -581,7 +586,7 @@ static int test_at_command_read_u32(void)
     memcpy(&frame.data.buf[0],
            "\x09""DL\x00\xbe\xef\xba\xbe",
            frame.data.size);
-    harness_mock_write("xbee_read(): return (frame)",
+    harness_mock_write("xbee_decoder_input(): return (frame)",
                        &frame,
                        sizeof(frame));
     mask = 1;
@@ -612,7 +617,7 @@ static int test_at_command_write_u8(void)
     frame.type = 0x88;
     frame.data.size = 4;
     memcpy(&frame.data.buf[0], "\x0a""DL\x00", frame.data.size);
-    harness_mock_write("xbee_read(): return (frame)",
+    harness_mock_write("xbee_decoder_input(): return (frame)",
                        &frame,
                        sizeof(frame));
     mask = 1;
@@ -639,7 +644,7 @@ static int test_at_command_write_u16(void)
     frame.type = 0x88;
     frame.data.size = 4;
     memcpy(&frame.data.buf[0], "\x0b""DL\x00", frame.data.size);
-    harness_mock_write("xbee_read(): return (frame)",
+    harness_mock_write("xbee_decoder_input(): return (frame)",
                        &frame,
                        sizeof(frame));
     mask = 1;
@@ -668,7 +673,7 @@ static int test_at_command_write_u32(void)
     frame.type = 0x88;
     frame.data.size = 4;
     memcpy(&frame.data.buf[0], "\x0c""DL\x00", frame.data.size);
-    harness_mock_write("xbee_read(): return (frame)",
+    harness_mock_write("xbee_decoder_input(): return (frame)",
                        &frame,
                        sizeof(frame));
     mask = 1;
@@ -699,7 +704,7 @@ static int test_at_command_error(void)
     frame.type = 0x88;
     frame.data.size = 4;
     memcpy(&frame.data.buf[0], "\x0d""DL\x01", frame.data.size);
-    harness_mock_write("xbee_read(): return (frame)",
+    harness_mock_write("xbee_decoder_input(): return (frame)",
                        &frame,
                        sizeof(frame));
     mask = 1;
@@ -731,7 +736,7 @@ static int test_tx_packet_negative_response(void)
     frame.type = 0x89;
     frame.data.size = 2;
     memcpy(&frame.data.buf[0], "\x0e\x01", frame.data.size);
-    harness_mock_write("xbee_read(): return (frame)",
+    harness_mock_write("xbee_decoder_input(): return (frame)",
                        &frame,
                        sizeof(frame));
     mask = 1;
@@ -756,6 +761,114 @@ static int test_tx_packet_negative_response(void)
     return (0);
 }
 
+static int test_tx_packet_async(void)
+{
+    struct xbee_frame_t frame;
+    struct xbee_client_address_t receiver;
+    uint32_t mask;
+    int frame_ids[3];
+    int i;
+
+    receiver.type = xbee_client_address_type_16_bits_t;
+    receiver.buf[0] = 0x56;
+    receiver.buf[1] = 0x78;
+
+    /* Write three packets without waiting for their TX Status. */
+    for (i = 0; i < membersof(frame_ids); i++) {
+        frame_ids[i] = xbee_client_write_to_async(&xbee,
+                                                  "hello",
+                                                  5,
+                                                  &receiver);
+        BTASSERTI(frame_ids[i], >, 0);
+    }
+
+    BTASSERTI(frame_ids[0], !=, frame_ids[1]);
+    BTASSERTI(frame_ids[0], !=, frame_ids[2]);
+    BTASSERTI(frame_ids[1], !=, frame_ids[2]);
+
+    for (i = 0; i < membersof(frame_ids); i++) {
+        harness_mock_read("xbee_write(frame)", &frame, sizeof(frame));
+        BTASSERTI(frame.type, ==, XBEE_FRAME_TYPE_TX_REQUEST_16_BIT_ADDRESS);
+        BTASSERTI(frame.data.size, ==, 9);
+        BTASSERTI(frame.data.buf[0], ==, frame_ids[i]);
+        BTASSERTM(&frame.data.buf[1], "\x56\x78\x00hello", 8);
+    }
+
+    /* TX Status of the last packet is received first. */
+    frame.type = 0x89;
+    frame.data.size = 2;
+    frame.data.buf[0] = frame_ids[2];
+    frame.data.buf[1] = 0x00;
+    harness_mock_write("xbee_decoder_input(): return (frame)",
+                       &frame,
+                       sizeof(frame));
+    mask = 1;
+    event_write(&event, &mask, sizeof(mask));
+
+    BTASSERTI(xbee_client_write_to_wait(&xbee, frame_ids[2]), ==, 0);
+
+    /* Negative TX Status of the first packet. */
+    frame.data.buf[0] = frame_ids[0];
+    frame.data.buf[1] = 0x01;
+    harness_mock_write("xbee_decoder_input(): return (frame)",
+                       &frame,
+                       sizeof(frame));
+    event_write(&event, &mask, sizeof(mask));
+
+    BTASSERTI(xbee_client_write_to_wait(&xbee, frame_ids[0]), ==, -EPROTO);
+
+    /* No TX Status of the second packet. */
+    BTASSERTI(xbee_client_write_to_wait(&xbee, frame_ids[1]), ==, -ETIMEDOUT);
+
+    /* All frame ids are free. */
+    for (i = 0; i < membersof(frame_ids); i++) {
+        BTASSERTI(xbee_client_write_to_wait(&xbee, frame_ids[i]), ==, -EINVAL);
+    }
+
+    return (0);
+}
+
+static int test_tx_packet_async_pending_max(void)
+{
+    struct xbee_frame_t frame;
+    struct xbee_client_address_t receiver;
+    int frame_ids[CONFIG_XBEE_CLIENT_PENDING_MAX];
+    int i;
+
+    receiver.type = xbee_client_address_type_16_bits_t;
+    receiver.buf[0] = 0x56;
+    receiver.buf[1] = 0x78;
+
+    for (i = 0; i < membersof(frame_ids); i++) {
+        frame_ids[i] = xbee_client_write_to_async(&xbee,
+                                                  "a",
+                                                  1,
+                                                  &receiver);
+        BTASSERTI(frame_ids[i], >, 0);
+        harness_mock_read("xbee_write(frame)", &frame, sizeof(frame));
+    }
+
+    /* No free frame id. */
+    BTASSERTI(xbee_client_write_to_async(&xbee,
+                                         "a",
+                                         1,
+                                         &receiver), ==, -ETIMEDOUT);
+
+    for (i = 0; i < membersof(frame_ids); i++) {
+        BTASSERTI(xbee_client_write_to_wait(&xbee, frame_ids[i]),
+                  ==,
+                  -ETIMEDOUT);
+    }
+
+    /* Too big packet. */
+    BTASSERTI(xbee_client_write_to_async(&xbee,
+                                         &frame.data.buf[0],
+                                         XBEE_DATA_MAX,
+                                         &receiver), ==, -EMSGSIZE);
+
+    return (0);
+}
+
 static int test_print_address(void)
 {
     struct xbee_client_address_t address;
@@ -818,19 +931,28 @@ int STUB(xbee_init)(struct xbee_driver_t *self_p,
     return (0);
 }
 
-int STUB(xbee_read)(struct xbee_driver_t *self_p,
-                    struct xbee_frame_t *frame_p)
+int STUB(xbee_decoder_init)(struct xbee_decoder_t *self_p,
+                            struct xbee_frame_t *frame_p)
+{
+    self_p->frame_p = frame_p;
+
+    return (0);
+}
+
+int STUB(xbee_decoder_input)(struct xbee_decoder_t *self_p,
+                             const uint8_t *buf_p,
+                             size_t *size_p)
 {
     uint32_t mask;
 
     mask = 1;
     event_read(&event, &mask, sizeof(mask));
 
-    harness_mock_read("xbee_read(): return (frame)",
-                      frame_p,
-                      sizeof(*frame_p));
+    harness_mock_read("xbee_decoder_input(): return (frame)",
+                      self_p->frame_p,
+                      sizeof(*self_p->frame_p));
 
-    return (0);
+    return (1);
 }
 
 int STUB(xbee_write)(struct xbee_driver_t *self_p,
@@ -902,6 +1024,11 @@ int main()
             test_tx_packet_negative_response,
             "test_tx_packet_negative_response"
         },
+        { test_tx_packet_async, "test_tx_packet_async" },
+        {
+            test_tx_packet_async_pending_max,
+            "test_tx_packet_async_pending_max"
+        },
         { test_print_address, "test_print_address" },
         { NULL, NULL }
     };
@@ -0,0 +1,313 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2014-2018, Erik Moqvist
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use, copy,
+ * modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ * This file is part of the Simba project.
+ */
+
+#include "simba.h"
+
+#define PD_SCK_DEV_P   &pin_device[0]
+#define DOUT_0_DEV_P   &pin_device[1]
+#define DOUT_1_DEV_P   &pin_device[2]
+#define OTHER_DEV_P    &pin_device[3]
+
+/* A model of two HX711 sharing the PD_SCK pin. */
+static struct {
+    int sck;
+    int pulses;
+    int resets;
+    struct {
+        int ready;
+        int32_t value;
+    } devices[2];
+} model;
+
+static struct hx711_driver_t drivers[2];
+static struct hx711_sample_t bufs[2][4];
+static struct hx711_sampler_device_t devices[2];
+static struct hx711_sampler_t sampler;
+
+static void model_set_ready(int32_t value_0, int32_t value_1)
+{
+    sys_lock();
+    model.pulses = 0;
+    model.devices[0].ready = 1;
+    model.devices[0].value = value_0;
+    model.devices[1].ready = 1;
+    model.devices[1].value = value_1;
+    sys_unlock();
+}
+
+static int sample(void)
+{
+    int res;
+
+    sys_lock();
+    res = hx711_sampler_sample_isr(&sampler);
+    sys_unlock();
+
+    return (res);
+}
+
+static int test_init(void)
+{
+    struct hx711_driver_t other;
+    struct hx711_sampler_device_t other_devices[2];
+
+    BTASSERT(hx711_module_init() == 0);
+    BTASSERT(hx711_init(&drivers[0], PD_SCK_DEV_P, DOUT_0_DEV_P, 1, 0) == 0);
+    BTASSERT(hx711_init(&drivers[1], PD_SCK_DEV_P, DOUT_1_DEV_P, 1, 0) == 0);
+    BTASSERT(hx711_sampler_device_init(&devices[0],
+                                       &drivers[0],
+                                       &bufs[0][0],
+                                       membersof(bufs[0])) == 0);
+    BTASSERT(hx711_sampler_device_init(&devices[1],
+                                       &drivers[1],
+                                       &bufs[1][0],
+                                       membersof(bufs[1])) == 0);
+    BTASSERT(hx711_sampler_init(&sampler,
+                                &devices[0],
+                                membersof(devices),
+                                hx711_channel_gain_b_32_t) == 0);
+
+    /* All devices must share the PD_SCK pin. */
+    BTASSERT(hx711_init(&other, OTHER_DEV_P, DOUT_1_DEV_P, 1, 0) == 0);
+    other_devices[0] = devices[0];
+    BTASSERT(hx711_sampler_device_init(&other_devices[1],
+                                       &other,
+                                       &bufs[1][0],
+                                       membersof(bufs[1])) == 0);
+    BTASSERTI(hx711_sampler_init(&sampler,
+                                 &other_devices[0],
+                                 membersof(other_devices),
+                                 hx711_channel_gain_b_32_t), ==, -EINVAL);
+    BTASSERT(hx711_sampler_init(&sampler,
+                                &devices[0],
+                                membersof(devices),
+                                hx711_channel_gain_b_32_t) == 0);
+
+    return (0);
+}
+
+static int test_start(void)
+{
+    BTASSERT(hx711_sampler_start(&sampler, NULL) == 0);
+
+    /* All devices reset by holding PD_SCK high. */
+    BTASSERTI(model.resets, ==, 1);
+    BTASSERTI(model.sck, ==, 0);
+
+    return (0);
+}
+
+static int test_sample_not_ready(void)
+{
+    struct time_t timeout;
+    struct hx711_sample_t samples[1];
+
+    model_set_ready(1, 2);
+    model.devices[1].ready = 0;
+
+    BTASSERTI(sample(), ==, 0);
+    BTASSERTI(model.pulses, ==, 0);
+
+    timeout.seconds = 0;
+    timeout.nanoseconds = 0;
+    BTASSERTI(hx711_sampler_read(&devices[0],
+                                 &samples[0],
+                                 membersof(samples),
+                                 &timeout), ==, -ETIMEDOUT);
+
+    return (0);
+}
+
+static int test_sample(void)
+{
+    struct hx711_sample_t samples[4];
+
+    model_set_ready(0x123456, 0x800001);
+    BTASSERTI(sample(), ==, 1);
+
+    /* 24 data bits and two channel B gain 32 pulses. */
+    BTASSERTI(model.pulses, ==, 26);
+
+    model_set_ready(0x7fffff, 0xffffff);
+    BTASSERTI(sample(), ==, 1);
+
+    /* Samples in the ring buffer of each device. */
+    BTASSERTI(hx711_sampler_read(&devices[0],
+                                 &samples[0],
+                                 membersof(samples),
+                                 NULL), ==, 2);
+    BTASSERTI(samples[0].value, ==, 0x123456);
+    BTASSERTI(samples[1].value, ==, 0x7fffff);
+    BTASSERT(time_compare(&samples[1].timestamp,
+                          &samples[0].timestamp) != time_compare_less_than_t);
+
+    BTASSERTI(hx711_sampler_read(&devices[1],
+                                 &samples[0],
+                                 1,
+                                 NULL), ==, 1);
+    BTASSERTI(samples[0].value, ==, (int32_t)0xff800001);
+    BTASSERTI(hx711_sampler_read(&devices[1],
+                                 &samples[0],
+                                 1,
+                                 NULL), ==, 1);
+    BTASSERTI(samples[0].value, ==, -1);
+
+    return (0);
+}
+
+static int test_overflow(void)
+{
+    int i;
+    struct hx711_sample_t samples[8];
+
+    for (i = 0; i < 5; i++) {
+        model_set_ready(i, -i);
+        BTASSERTI(sample(), ==, 1);
+    }
+
+    BTASSERTI(hx711_sampler_get_overflows(&devices[0]), ==, 1);
+    BTASSERTI(hx711_sampler_get_overflows(&devices[1]), ==, 1);
+
+    /* The oldest samples are kept. */
+    BTASSERTI(hx711_sampler_read(&devices[0],
+                                 &samples[0],
+                                 membersof(samples),
+                                 NULL), ==, 4);
+
+    for (i = 0; i < 4; i++) {
+        BTASSERTI(samples[i].value, ==, i);
+    }
+
+    BTASSERTI(hx711_sampler_read(&devices[1],
+                                 &samples[0],
+                                 membersof(samples),
+                                 NULL), ==, 4);
+    BTASSERTI(samples[3].value, ==, -3);
+
+    return (0);
+}
+
+static int test_timer(void)
+{
+    struct time_t period;
+    struct time_t timeout;
+    struct hx711_sample_t samples[1];
+
+    BTASSERT(hx711_sampler_stop(&sampler) == 0);
+
+    /* Sampled by the timer when ready. */
+    period.seconds = 0;
+    period.nanoseconds = 10000000;
+    BTASSERT(hx711_sampler_start(&sampler, &period) == 0);
+    BTASSERTI(model.resets, ==, 2);
+
+    model_set_ready(0x654321, 0x000100);
+
+    timeout.seconds = 1;
+    timeout.nanoseconds = 0;
+    BTASSERTI(hx711_sampler_read(&devices[0],
+                                 &samples[0],
+                                 membersof(samples),
+                                 &timeout), ==, 1);
+    BTASSERTI(samples[0].value, ==, 0x654321);
+    BTASSERTI(hx711_sampler_read(&devices[1],
+                                 &samples[0],
+                                 membersof(samples),
+                                 &timeout), ==, 1);
+    BTASSERTI(samples[0].value, ==, 0x000100);
+
+    BTASSERT(hx711_sampler_stop(&sampler) == 0);
+
+    return (0);
+}
+
+int STUB(pin_port_device_set_mode)(const struct pin_device_t *dev_p,
+                                   int mode)
+{
+    return (0);
+}
+
+int STUB(pin_port_device_read)(const struct pin_device_t *dev_p)
+{
+    int i;
+
+    i = (dev_p == DOUT_0_DEV_P ? 0 : 1);
+
+    /* DOUT is low when ready, and then outputs the sample MSB
+       first. */
+    if (model.pulses == 0) {
+        return (!model.devices[i].ready);
+    } else if (model.pulses <= 24) {
+        return ((model.devices[i].value >> (24 - model.pulses)) & 1);
+    } else {
+        return (1);
+    }
+}
+
+int STUB(pin_port_device_write_high)(const struct pin_device_t *dev_p)
+{
+    model.sck = 1;
+    model.pulses++;
+
+    return (0);
+}
+
+int STUB(pin_port_device_write_low)(const struct pin_device_t *dev_p)
+{
+    model.sck = 0;
+
+    return (0);
+}
+
+void STUB(time_busy_wait_us)(int microseconds)
+{
+    /* PD_SCK high for more than 60 us resets the devices. */
+    if ((model.sck == 1) && (microseconds > 60)) {
+        model.resets++;
+        model.pulses = 0;
+    }
+}
+
+int main()
+{
+    struct harness_testcase_t testcases[] = {
+        { test_init, "test_init" },
+        { test_start, "test_start" },
+        { test_sample_not_ready, "test_sample_not_ready" },
+        { test_sample, "test_sample" },
+        { test_overflow, "test_overflow" },
+        { test_timer, "test_timer" },
+        { NULL, NULL }
+    };
+
+    sys_start();
+
+    harness_run(testcases);
+
+    return (0);
+}
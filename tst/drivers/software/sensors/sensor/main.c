@@ -0,0 +1,364 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2014-2018, Erik Moqvist
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use, copy,
+ * modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ * This file is part of the Simba project.
+ */
+
+#include "simba.h"
+
+/* Fake physical buses. */
+static int i2c;
+static int owi;
+
+struct fake_t {
+    int value;
+    int reads;
+};
+
+static int starts;
+static int start_res;
+static struct bus_t bus;
+static struct queue_t queue;
+static int queue_buf[16];
+static struct bus_listener_t listeners[4];
+static struct sensor_scheduler_t scheduler;
+static int sample_buf[2];
+
+static int fake_start(void *arg_p)
+{
+    starts++;
+
+    return (start_res);
+}
+
+static ssize_t fake_read(struct sensor_t *sensor_p,
+                         void *buf_p,
+                         size_t size)
+{
+    struct fake_t *fake_p;
+
+    fake_p = sensor_p->arg_p;
+    fake_p->reads++;
+
+    if (fake_p->value < 0) {
+        return (-EIO);
+    }
+
+    memcpy(buf_p, &fake_p->value, sizeof(fake_p->value));
+
+    return (sizeof(fake_p->value));
+}
+
+static int read_sample(int *value_p)
+{
+    if (queue_size(&queue) < sizeof(*value_p)) {
+        return (-1);
+    }
+
+    return (queue_read(&queue, value_p, sizeof(*value_p)));
+}
+
+static int test_init(void)
+{
+    int i;
+
+    BTASSERT(bus_init(&bus) == 0);
+    BTASSERT(queue_init(&queue, &queue_buf[0], sizeof(queue_buf)) == 0);
+
+    for (i = 0; i < membersof(listeners); i++) {
+        BTASSERT(bus_listener_init(&listeners[i], i, &queue) == 0);
+        BTASSERT(bus_attach(&bus, &listeners[i]) == 0);
+    }
+
+    BTASSERT(sensor_scheduler_init(&scheduler,
+                                   &bus,
+                                   &sample_buf[0],
+                                   sizeof(sample_buf)) == 0);
+
+    /* Nothing to do. */
+    BTASSERT(sensor_scheduler_process(&scheduler) == 1000);
+
+    return (0);
+}
+
+static int test_read_immediate(void)
+{
+    struct sensor_t sensor;
+    struct fake_t fake;
+    int value;
+    int timeout;
+
+    fake.value = 5;
+    fake.reads = 0;
+    BTASSERT(sensor_init(&sensor,
+                         0,
+                         50,
+                         &i2c,
+                         fake_read,
+                         &fake,
+                         sizeof(int)) == 0);
+    BTASSERT(sensor_scheduler_add(&scheduler, &sensor) == 0);
+
+    /* The first sample is due immediately. */
+    timeout = sensor_scheduler_process(&scheduler);
+    BTASSERT(timeout > 40, "%d", timeout);
+    BTASSERT(timeout <= 50, "%d", timeout);
+    BTASSERT(fake.reads == 1);
+    BTASSERT(read_sample(&value) == sizeof(value));
+    BTASSERT(value == 5);
+
+    /* Not due yet. */
+    BTASSERT(sensor_scheduler_process(&scheduler) > 0);
+    BTASSERT(fake.reads == 1);
+
+    /* Next period. */
+    fake.value = 6;
+    thrd_sleep_ms(timeout);
+    BTASSERT(sensor_scheduler_process(&scheduler) > 0);
+    BTASSERT(fake.reads == 2);
+    BTASSERT(read_sample(&value) == sizeof(value));
+    BTASSERT(value == 6);
+
+    BTASSERT(sensor_scheduler_remove(&scheduler, &sensor) == 0);
+    BTASSERT(sensor_scheduler_remove(&scheduler, &sensor) == -ENOENT);
+
+    return (0);
+}
+
+static int test_shared_start(void)
+{
+    struct sensor_t sensors[2];
+    struct fake_t fakes[2];
+    int value;
+    int timeout;
+    int i;
+
+    starts = 0;
+    start_res = 20;
+
+    for (i = 0; i < 2; i++) {
+        fakes[i].value = (10 + i);
+        fakes[i].reads = 0;
+        BTASSERT(sensor_init(&sensors[i],
+                             i,
+                             100,
+                             &owi,
+                             fake_read,
+                             &fakes[i],
+                             sizeof(int)) == 0);
+        BTASSERT(sensor_set_start(&sensors[i], fake_start, &owi) == 0);
+        BTASSERT(sensor_scheduler_add(&scheduler, &sensors[i]) == 0);
+    }
+
+    /* One conversion is started for both sensors. */
+    timeout = sensor_scheduler_process(&scheduler);
+    BTASSERT(timeout > 10, "%d", timeout);
+    BTASSERT(timeout <= 20, "%d", timeout);
+    BTASSERT(starts == 1);
+    BTASSERT(fakes[0].reads == 0);
+    BTASSERT(fakes[1].reads == 0);
+
+    /* Both samples are read when the conversion is done. */
+    thrd_sleep_ms(timeout);
+    timeout = sensor_scheduler_process(&scheduler);
+    BTASSERT(timeout > 60, "%d", timeout);
+    BTASSERT(starts == 1);
+    BTASSERT(fakes[0].reads == 1);
+    BTASSERT(fakes[1].reads == 1);
+    BTASSERT(read_sample(&value) == sizeof(value));
+    BTASSERT(value == 10);
+    BTASSERT(read_sample(&value) == sizeof(value));
+    BTASSERT(value == 11);
+
+    /* A failed start skips the sample of all sensors sharing it. */
+    start_res = -EIO;
+    thrd_sleep_ms(timeout);
+    BTASSERT(sensor_scheduler_process(&scheduler) > 60);
+    BTASSERT(starts == 2);
+    BTASSERT(sensor_get_errors(&sensors[0]) == 1);
+    BTASSERT(sensor_get_errors(&sensors[1]) == 1);
+    BTASSERT(fakes[1].reads == 1);
+    BTASSERT(read_sample(&value) == -1);
+
+    for (i = 0; i < 2; i++) {
+        BTASSERT(sensor_scheduler_remove(&scheduler, &sensors[i]) == 0);
+    }
+
+    return (0);
+}
+
+static int test_bus_order(void)
+{
+    struct sensor_t sensors[4];
+    struct fake_t fakes[4];
+    void *buses[4] = { &i2c, &owi, &i2c, &owi };
+    int value;
+    int i;
+
+    for (i = 0; i < 4; i++) {
+        fakes[i].value = i;
+        fakes[i].reads = 0;
+        BTASSERT(sensor_init(&sensors[i],
+                             i,
+                             100,
+                             buses[i],
+                             fake_read,
+                             &fakes[i],
+                             sizeof(int)) == 0);
+        BTASSERT(sensor_scheduler_add(&scheduler, &sensors[i]) == 0);
+    }
+
+    /* Sensors are read bus by bus. */
+    BTASSERT(sensor_scheduler_process(&scheduler) > 0);
+    BTASSERT(read_sample(&value) == sizeof(value));
+    BTASSERT(value == 0);
+    BTASSERT(read_sample(&value) == sizeof(value));
+    BTASSERT(value == 2);
+    BTASSERT(read_sample(&value) == sizeof(value));
+    BTASSERT(value == 1);
+    BTASSERT(read_sample(&value) == sizeof(value));
+    BTASSERT(value == 3);
+
+    for (i = 0; i < 4; i++) {
+        BTASSERT(sensor_scheduler_remove(&scheduler, &sensors[i]) == 0);
+    }
+
+    return (0);
+}
+
+static int test_read_error(void)
+{
+    struct sensor_t sensor;
+    struct fake_t fake;
+    int value;
+
+    fake.value = -1;
+    fake.reads = 0;
+    BTASSERT(sensor_init(&sensor,
+                         0,
+                         100,
+                         &i2c,
+                         fake_read,
+                         &fake,
+                         sizeof(int)) == 0);
+    BTASSERT(sensor_scheduler_add(&scheduler, &sensor) == 0);
+
+    BTASSERT(sensor_scheduler_process(&scheduler) > 0);
+    BTASSERT(fake.reads == 1);
+    BTASSERT(sensor_get_errors(&sensor) == 1);
+    BTASSERT(read_sample(&value) == -1);
+
+    BTASSERT(sensor_scheduler_remove(&scheduler, &sensor) == 0);
+
+    /* Too big sample. */
+    BTASSERT(sensor_init(&sensor,
+                         0,
+                         100,
+                         &i2c,
+                         fake_read,
+                         &fake,
+                         3 * sizeof(int)) == 0);
+    BTASSERT(sensor_scheduler_add(&scheduler, &sensor) == -EINVAL);
+
+    return (0);
+}
+
+static int test_ds18b20(void)
+{
+    struct owi_driver_t owi_driver;
+    struct ds18b20_driver_t driver;
+    struct sensor_ds18b20_t sensors[2];
+    uint8_t ids[2][8];
+    int value;
+    int i;
+
+    driver.owi_p = &owi_driver;
+
+    for (i = 0; i < 2; i++) {
+        memset(&ids[i][0], i, sizeof(ids[i]));
+        BTASSERT(sensor_ds18b20_init(&sensors[i],
+                                     i,
+                                     1000,
+                                     &driver,
+                                     &ids[i][0]) == 0);
+        BTASSERT(sensor_scheduler_add(&scheduler, &sensors[i].base) == 0);
+    }
+
+    /* One conversion for both sensors. */
+    starts = 0;
+    BTASSERT(sensor_scheduler_process(&scheduler) > 700);
+    BTASSERT(starts == 1);
+    BTASSERT(read_sample(&value) == -1);
+
+    thrd_sleep_ms(DS18B20_CONVERT_TIME_MS);
+    BTASSERT(sensor_scheduler_process(&scheduler) > 0);
+    BTASSERT(starts == 1);
+    BTASSERT(read_sample(&value) == sizeof(value));
+    BTASSERT(value == 16 * 20);
+    BTASSERT(read_sample(&value) == sizeof(value));
+    BTASSERT(value == 16 * 21);
+
+    for (i = 0; i < 2; i++) {
+        BTASSERT(sensor_scheduler_remove(&scheduler,
+                                         &sensors[i].base) == 0);
+    }
+
+    return (0);
+}
+
+int main()
+{
+    struct harness_testcase_t testcases[] = {
+        { test_init, "test_init" },
+        { test_read_immediate, "test_read_immediate" },
+        { test_shared_start, "test_shared_start" },
+        { test_bus_order, "test_bus_order" },
+        { test_read_error, "test_read_error" },
+        { test_ds18b20, "test_ds18b20" },
+        { NULL, NULL }
+    };
+
+    sys_start();
+
+    harness_run(testcases);
+
+    return (0);
+}
+
+int STUB(ds18b20_convert_async)(struct ds18b20_driver_t *self_p)
+{
+    starts++;
+
+    return (0);
+}
+
+int STUB(ds18b20_read_fixed_point)(struct ds18b20_driver_t *self_p,
+                                   const uint8_t *id_p,
+                                   int *temp_p)
+{
+    *temp_p = (16 * (20 + id_p[0]));
+
+    return (0);
+}
@@ -0,0 +1,431 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2014-2018, Erik Moqvist
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use, copy,
+ * modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ * This file is part of the Simba project.
+ */
+
+
+#include "simba.h"
+
+#define BLOCK_SIZE                                       1024
+#define BLOCK_COUNT                                         2
+#define EEPROM_SIZE                                       256
+#define PAGE_SIZE                                          16
+
+/* A RAM backed NOR flash. Programming can only clear bits. */
+static uint8_t flash_memory[BLOCK_SIZE * BLOCK_COUNT];
+static int erase_counts[BLOCK_COUNT];
+
+/* Number of flash operations left until a simulated power loss, or
+   -1 to never lose power. */
+static int operations_left = -1;
+
+static struct flash_driver_t flash;
+static struct eeprom_journal_driver_t eeprom;
+static uint16_t eeprom_index[EEPROM_JOURNAL_INDEX_LENGTH(EEPROM_SIZE,
+                                                         PAGE_SIZE)];
+static const struct eeprom_journal_block_t blocks[BLOCK_COUNT] = {
+    { .address = 0, .size = BLOCK_SIZE },
+    { .address = BLOCK_SIZE, .size = BLOCK_SIZE }
+};
+
+/* Expected EEPROM content. */
+static uint8_t model[EEPROM_SIZE];
+static uint8_t buf[EEPROM_SIZE];
+
+static int power_lost(void)
+{
+    if (operations_left == 0) {
+        return (1);
+    }
+
+    if (operations_left > 0) {
+        operations_left--;
+    }
+
+    return (0);
+}
+
+ssize_t STUB(flash_read)(struct flash_driver_t *self_p,
+                         void *dst_p,
+                         uintptr_t src,
+                         size_t size)
+{
+    if (src + size > sizeof(flash_memory)) {
+        return (-EINVAL);
+    }
+
+    memcpy(dst_p, &flash_memory[src], size);
+
+    return (size);
+}
+
+ssize_t STUB(flash_write)(struct flash_driver_t *self_p,
+                          uintptr_t dst,
+                          const void *src_p,
+                          size_t size)
+{
+    const uint8_t *u8_src_p;
+    size_t i;
+
+    if (dst + size > sizeof(flash_memory)) {
+        return (-EINVAL);
+    }
+
+    if (power_lost()) {
+        return (-EIO);
+    }
+
+    u8_src_p = src_p;
+
+    for (i = 0; i < size; i++) {
+        flash_memory[dst + i] &= u8_src_p[i];
+    }
+
+    return (size);
+}
+
+int STUB(flash_erase)(struct flash_driver_t *self_p,
+                      uintptr_t addr,
+                      size_t size)
+{
+    if ((addr % BLOCK_SIZE) != 0) {
+        return (-EINVAL);
+    }
+
+    if (addr + size > sizeof(flash_memory)) {
+        return (-EINVAL);
+    }
+
+    if (power_lost()) {
+        return (-EIO);
+    }
+
+    memset(&flash_memory[addr], 0xff, size);
+    erase_counts[addr / BLOCK_SIZE]++;
+
+    return (0);
+}
+
+static int init_and_mount(void)
+{
+    BTASSERT(eeprom_journal_init(&eeprom,
+                                 &flash,
+                                 &blocks[0],
+                                 membersof(blocks),
+                                 EEPROM_SIZE,
+                                 PAGE_SIZE,
+                                 &eeprom_index[0]) == 0);
+    BTASSERT(eeprom_journal_mount(&eeprom) == 0);
+
+    return (0);
+}
+
+static int write_and_update_model(uintptr_t dst,
+                                  const void *src_p,
+                                  size_t size)
+{
+    BTASSERT(eeprom_journal_write(&eeprom, dst, src_p, size) == size);
+    memcpy(&model[dst], src_p, size);
+
+    return (0);
+}
+
+static int check_model(void)
+{
+    memset(&buf[0], 0, sizeof(buf));
+    BTASSERT(eeprom_journal_read(&eeprom,
+                                 &buf[0],
+                                 0,
+                                 sizeof(buf)) == sizeof(buf));
+    BTASSERT(memcmp(&buf[0], &model[0], sizeof(model)) == 0);
+
+    return (0);
+}
+
+static int test_format_mount(void)
+{
+    BTASSERT(eeprom_journal_module_init() == 0);
+
+    memset(&flash_memory[0], 0xff, sizeof(flash_memory));
+
+    BTASSERT(eeprom_journal_init(&eeprom,
+                                 &flash,
+                                 &blocks[0],
+                                 membersof(blocks),
+                                 EEPROM_SIZE,
+                                 PAGE_SIZE,
+                                 &eeprom_index[0]) == 0);
+
+    /* Not mounted. */
+    BTASSERT(eeprom_journal_read(&eeprom, &buf[0], 0, 1) == -ENOTMOUNTED);
+    BTASSERT(eeprom_journal_write(&eeprom, 0, &buf[0], 1) == -ENOTMOUNTED);
+
+    /* Erased flash has no valid block. */
+    BTASSERT(eeprom_journal_mount(&eeprom) == -1);
+
+    BTASSERT(eeprom_journal_format(&eeprom) == 0);
+    BTASSERT(eeprom_journal_mount(&eeprom) == 0);
+
+    /* All bytes are 0xff after formatting. */
+    memset(&model[0], 0xff, sizeof(model));
+    BTASSERT(check_model() == 0);
+
+    /* Header, snapshot and an empty journal. */
+    BTASSERT(eeprom_journal_get_free(&eeprom) == BLOCK_SIZE - 8 - EEPROM_SIZE);
+
+    /* Out of range. */
+    BTASSERT(eeprom_journal_read(&eeprom, &buf[0], EEPROM_SIZE, 1) == -EINVAL);
+    BTASSERT(eeprom_journal_read(&eeprom,
+                                 &buf[0],
+                                 EEPROM_SIZE - 1,
+                                 2) == -EINVAL);
+    BTASSERT(eeprom_journal_write(&eeprom,
+                                  EEPROM_SIZE - 1,
+                                  &buf[0],
+                                  2) == -EINVAL);
+
+    return (0);
+}
+
+static int test_read_write(void)
+{
+    ssize_t free;
+    size_t i;
+
+    /* Within one page. A record is an eight bytes header and the
+       data padded to a multiple of four bytes. */
+    BTASSERT(write_and_update_model(3, "hello", 5) == 0);
+    BTASSERT(check_model() == 0);
+    BTASSERT(eeprom_journal_get_free(&eeprom)
+             == BLOCK_SIZE - 8 - EEPROM_SIZE - 16);
+
+    /* Over three pages. */
+    for (i = 0; i < 40; i++) {
+        buf[i] = i;
+    }
+
+    BTASSERT(write_and_update_model(10, &buf[0], 40) == 0);
+    BTASSERT(check_model() == 0);
+
+    /* Overwrite parts of earlier records. */
+    BTASSERT(write_and_update_model(12, "abc", 3) == 0);
+    BTASSERT(write_and_update_model(2, "xy", 2) == 0);
+    BTASSERT(check_model() == 0);
+
+    /* Unaligned reads. */
+    BTASSERT(eeprom_journal_read(&eeprom, &buf[0], 4, 9) == 9);
+    BTASSERT(memcmp(&buf[0], &model[4], 9) == 0);
+    BTASSERT(eeprom_journal_read(&eeprom, &buf[0], 47, 1) == 1);
+    BTASSERT(buf[0] == model[47]);
+
+    /* Identical data is not written. */
+    free = eeprom_journal_get_free(&eeprom);
+    BTASSERT(eeprom_journal_write(&eeprom, 3, "yello", 5) == 5);
+    BTASSERT(eeprom_journal_get_free(&eeprom) == free);
+
+    return (0);
+}
+
+static int test_vwrite(void)
+{
+    struct iov_uintptr_t dst[2];
+    struct iov_t src[2];
+
+    dst[0].address = 100;
+    dst[0].size = 4;
+    src[0].buf_p = "1234";
+    dst[1].address = EEPROM_SIZE - 2;
+    dst[1].size = 2;
+    src[1].buf_p = "56";
+
+    BTASSERT(eeprom_journal_vwrite(&eeprom, &dst[0], &src[0], 2) == 6);
+    memcpy(&model[100], "1234", 4);
+    memcpy(&model[EEPROM_SIZE - 2], "56", 2);
+    BTASSERT(check_model() == 0);
+
+    /* No buffer is written if any range is out of bounds. */
+    dst[1].address = EEPROM_SIZE - 1;
+    src[0].buf_p = "abcd";
+    BTASSERT(eeprom_journal_vwrite(&eeprom, &dst[0], &src[0], 2) == -EINVAL);
+    BTASSERT(check_model() == 0);
+
+    return (0);
+}
+
+static int test_remount(void)
+{
+    ssize_t free;
+
+    free = eeprom_journal_get_free(&eeprom);
+
+    /* The index is rebuilt from the journal. */
+    memset(&eeprom_index[0], 0, sizeof(eeprom_index));
+    BTASSERT(init_and_mount() == 0);
+    BTASSERT(check_model() == 0);
+    BTASSERT(eeprom_journal_get_free(&eeprom) == free);
+
+    return (0);
+}
+
+static int test_compaction(void)
+{
+    int i;
+    int erase_count;
+    uint8_t value[8];
+
+    erase_count = (erase_counts[0] + erase_counts[1]);
+
+    /* Each write appends a 16 bytes record. */
+    for (i = 0; i < 200; i++) {
+        memset(&value[0], i, sizeof(value));
+        BTASSERT(write_and_update_model((i * 8) % EEPROM_SIZE,
+                                        &value[0],
+                                        sizeof(value)) == 0);
+    }
+
+    BTASSERT(check_model() == 0);
+
+    /* Compacted every 47 writes, alternating between the blocks. */
+    BTASSERT(erase_counts[0] + erase_counts[1] - erase_count == 4);
+    BTASSERT(abs(erase_counts[0] - erase_counts[1]) <= 1);
+
+    BTASSERT(init_and_mount() == 0);
+    BTASSERT(check_model() == 0);
+
+    /* Compact explicitly. */
+    BTASSERT(eeprom_journal_compact(&eeprom) == 0);
+    BTASSERT(eeprom_journal_get_free(&eeprom) == BLOCK_SIZE - 8 - EEPROM_SIZE);
+    BTASSERT(check_model() == 0);
+    BTASSERT(init_and_mount() == 0);
+    BTASSERT(check_model() == 0);
+
+    return (0);
+}
+
+static int test_power_loss(void)
+{
+    uintptr_t address;
+    int erase_count;
+    ssize_t free;
+
+    /* A write that never reaches the flash. */
+    operations_left = 0;
+    BTASSERT(eeprom_journal_write(&eeprom, 0, "fail", 4) == -1);
+    operations_left = -1;
+    BTASSERT(init_and_mount() == 0);
+    BTASSERT(check_model() == 0);
+
+    /* A partially written record is ignored, and the journal is
+       considered full. */
+    free = eeprom_journal_get_free(&eeprom);
+    address = (eeprom.current.block_p->address + eeprom.current.offset);
+    BTASSERT(eeprom_journal_write(&eeprom, 0, "torn", 4) == 4);
+    flash_memory[address + 8 + 2] = 0;
+    BTASSERT(init_and_mount() == 0);
+    BTASSERT(check_model() == 0);
+    BTASSERT(eeprom_journal_get_free(&eeprom) == 0);
+
+    erase_count = (erase_counts[0] + erase_counts[1]);
+    BTASSERT(write_and_update_model(0, "torn", 4) == 0);
+    BTASSERT(erase_counts[0] + erase_counts[1] == erase_count + 1);
+    BTASSERT(eeprom_journal_get_free(&eeprom)
+             == BLOCK_SIZE - 8 - EEPROM_SIZE - 12);
+    BTASSERT(free != 0);
+
+    /* Power loss after erasing the next block during compaction. The
+       previous block is used on next mount. */
+    operations_left = 3;
+    BTASSERT(eeprom_journal_compact(&eeprom) == -1);
+    operations_left = -1;
+    BTASSERT(init_and_mount() == 0);
+    BTASSERT(check_model() == 0);
+    BTASSERT(eeprom_journal_get_free(&eeprom)
+             == BLOCK_SIZE - 8 - EEPROM_SIZE - 12);
+
+    return (0);
+}
+
+static int test_image(void)
+{
+    struct {
+        uint32_t crc;
+        uint16_t revision;
+        uint16_t valid;
+    } header;
+    size_t i;
+
+    /* An image in the same format as a software EEPROM chunk created
+       by the build system. The rest of the block is zero. */
+    memset(&flash_memory[0], 0, sizeof(flash_memory));
+
+    for (i = 0; i < EEPROM_SIZE; i++) {
+        model[i] = (i * 3);
+    }
+
+    header.crc = crc_32(0, &model[0], sizeof(model));
+    header.revision = 0;
+    header.valid = 0xa5c3;
+    memcpy(&flash_memory[0], &header, sizeof(header));
+    memcpy(&flash_memory[8], &model[0], sizeof(model));
+
+    BTASSERT(init_and_mount() == 0);
+    BTASSERT(check_model() == 0);
+    BTASSERT(eeprom_journal_get_free(&eeprom) == 0);
+
+    /* First write compacts into the other block. */
+    BTASSERT(write_and_update_model(17, "image!", 6) == 0);
+    BTASSERT(eeprom.current.block_p == &blocks[1]);
+    BTASSERT(check_model() == 0);
+    BTASSERT(init_and_mount() == 0);
+    BTASSERT(check_model() == 0);
+
+    /* A bad snapshot crc makes the block invalid. */
+    memset(&flash_memory[0], 0xff, sizeof(flash_memory));
+    memcpy(&flash_memory[0], &header, sizeof(header));
+    BTASSERT(eeprom_journal_mount(&eeprom) == -1);
+
+    return (0);
+}
+
+int main()
+{
+    struct harness_testcase_t testcases[] = {
+        { test_format_mount, "test_format_mount" },
+        { test_read_write, "test_read_write" },
+        { test_vwrite, "test_vwrite" },
+        { test_remount, "test_remount" },
+        { test_compaction, "test_compaction" },
+        { test_power_loss, "test_power_loss" },
+        { test_image, "test_image" },
+        { NULL, NULL }
+    };
+
+    sys_start();
+
+    harness_run(testcases);
+
+    return (0);
+}
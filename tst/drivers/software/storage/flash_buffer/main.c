@@ -0,0 +1,238 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2014-2018, Erik Moqvist
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use, copy,
+ * modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ * This file is part of the Simba project.
+ */
+
+#include "simba.h"
+#include "drivers/storage/flash_mock.h"
+
+static struct flash_driver_t flash;
+static uint8_t page[16];
+
+static int test_write_coalescing(void)
+{
+    struct flash_buffer_t buffer;
+    uint8_t buf[16];
+    int i;
+
+    BTASSERT(flash_buffer_init(&buffer, &flash, &page[0], sizeof(page)) == 0);
+
+    for (i = 0; i < membersof(buf); i++) {
+        buf[i] = i;
+    }
+
+    /* Four small writes are programmed once the page is complete. */
+    mock_write_flash_write(0x1000, &buf[0], 16, 16);
+
+    for (i = 0; i < 4; i++) {
+        BTASSERT(flash_buffer_write(&buffer,
+                                    0x1000 + 4 * i,
+                                    &buf[4 * i],
+                                    4) == 4);
+    }
+
+    /* Nothing to flush. */
+    BTASSERT(flash_buffer_flush(&buffer) == 0);
+
+    return (0);
+}
+
+static int test_read_your_writes(void)
+{
+    struct flash_buffer_t buffer;
+    uint8_t buf[8];
+    uint8_t flash_buf[8];
+
+    BTASSERT(flash_buffer_init(&buffer, &flash, &page[0], sizeof(page)) == 0);
+
+    BTASSERT(flash_buffer_write(&buffer, 0x1004, "abc", 3) == 3);
+
+    /* Pending data replaces the flash memory contents. */
+    memset(&flash_buf[0], 0, sizeof(flash_buf));
+    mock_write_flash_read(&flash_buf[0], 0x1000, 8, 8);
+
+    BTASSERT(flash_buffer_read(&buffer, &buf[0], 0x1000, 8) == 8);
+    BTASSERTM(&buf[0], "\x00\x00\x00\x00" "abc" "\x00", 8);
+
+    mock_write_flash_write(0x1004, "abc", 3, 3);
+
+    BTASSERT(flash_buffer_flush(&buffer) == 0);
+
+    return (0);
+}
+
+static int test_non_consecutive(void)
+{
+    struct flash_buffer_t buffer;
+
+    BTASSERT(flash_buffer_init(&buffer, &flash, &page[0], sizeof(page)) == 0);
+
+    BTASSERT(flash_buffer_write(&buffer, 0x1000, "ab", 2) == 2);
+
+    mock_write_flash_write(0x1000, "ab", 2, 2);
+
+    BTASSERT(flash_buffer_write(&buffer, 0x1008, "cd", 2) == 2);
+
+    mock_write_flash_write(0x1008, "cd", 2, 2);
+
+    BTASSERT(flash_buffer_flush(&buffer) == 0);
+
+    return (0);
+}
+
+static int test_whole_pages(void)
+{
+    struct flash_buffer_t buffer;
+    uint8_t buf[40];
+    int i;
+
+    BTASSERT(flash_buffer_init(&buffer, &flash, &page[0], sizeof(page)) == 0);
+
+    for (i = 0; i < membersof(buf); i++) {
+        buf[i] = i;
+    }
+
+    /* Whole pages are programmed directly, the rest is buffered. */
+    mock_write_flash_write(0x1000, &buf[0], 32, 32);
+
+    BTASSERT(flash_buffer_write(&buffer, 0x1000, &buf[0], 40) == 40);
+
+    mock_write_flash_write(0x1020, &buf[32], 8, 8);
+
+    BTASSERT(flash_buffer_flush(&buffer) == 0);
+
+    return (0);
+}
+
+static int test_page_boundary(void)
+{
+    struct flash_buffer_t buffer;
+
+    BTASSERT(flash_buffer_init(&buffer, &flash, &page[0], sizeof(page)) == 0);
+
+    /* Pending data never crosses a page boundary. */
+    mock_write_flash_write(0x100c, "abcd", 4, 4);
+
+    BTASSERT(flash_buffer_write(&buffer, 0x100c, "abcdefgh", 8) == 8);
+
+    mock_write_flash_write(0x1010, "efgh", 4, 4);
+
+    BTASSERT(flash_buffer_flush(&buffer) == 0);
+
+    return (0);
+}
+
+static int test_erase(void)
+{
+    struct flash_buffer_t buffer;
+
+    BTASSERT(flash_buffer_init(&buffer, &flash, &page[0], sizeof(page)) == 0);
+
+    BTASSERT(flash_buffer_write(&buffer, 0x1000, "ab", 2) == 2);
+
+    /* Pending data is programmed before erasing. */
+    mock_write_flash_write(0x1000, "ab", 2, 2);
+    mock_write_flash_erase(0x1000, 0x100, 0);
+
+    BTASSERT(flash_buffer_erase(&buffer, 0x1000, 0x100) == 0);
+
+    return (0);
+}
+
+static int test_erase_ahead(void)
+{
+    struct flash_buffer_t buffer;
+    uint8_t buf[4];
+    uint8_t flash_buf[4];
+
+    BTASSERT(flash_buffer_init(&buffer, &flash, &page[0], sizeof(page)) == 0);
+
+    BTASSERT(flash_buffer_erase_ahead(&buffer, 0x2000, 0x200, 0x100) == 0);
+
+    /* Scheduled sectors reads as erased. */
+    memset(&flash_buf[0], 0, sizeof(flash_buf));
+    mock_write_flash_read(&flash_buf[0], 0x20fe, 4, 4);
+
+    BTASSERT(flash_buffer_read(&buffer, &buf[0], 0x20fe, 4) == 4);
+    BTASSERTM(&buf[0], "\xff\xff\xff\xff", 4);
+
+    /* Erase the first sector in the background. */
+    mock_write_flash_erase(0x2000, 0x100, 0);
+
+    BTASSERT(flash_buffer_erase_next(&buffer) == 1);
+
+    /* Writing to the second sector erases it first. */
+    BTASSERT(flash_buffer_write(&buffer, 0x2100, "ab", 2) == 2);
+
+    mock_write_flash_erase(0x2100, 0x100, 0);
+    mock_write_flash_write(0x2100, "ab", 2, 2);
+
+    BTASSERT(flash_buffer_flush(&buffer) == 0);
+
+    /* All sectors erased. */
+    BTASSERT(flash_buffer_erase_next(&buffer) == 0);
+
+    return (0);
+}
+
+static int test_write_fail(void)
+{
+    struct flash_buffer_t buffer;
+
+    BTASSERT(flash_buffer_init(&buffer, &flash, &page[0], sizeof(page)) == 0);
+
+    BTASSERT(flash_buffer_write(&buffer, 0x1000, "ab", 2) == 2);
+
+    mock_write_flash_write(0x1000, "ab", 2, -1);
+
+    BTASSERT(flash_buffer_flush(&buffer) == -1);
+
+    /* The pending data is dropped. */
+    BTASSERT(flash_buffer_flush(&buffer) == 0);
+
+    return (0);
+}
+
+int main()
+{
+    struct harness_testcase_t testcases[] = {
+        { test_write_coalescing, "test_write_coalescing" },
+        { test_read_your_writes, "test_read_your_writes" },
+        { test_non_consecutive, "test_non_consecutive" },
+        { test_whole_pages, "test_whole_pages" },
+        { test_page_boundary, "test_page_boundary" },
+        { test_erase, "test_erase" },
+        { test_erase_ahead, "test_erase_ahead" },
+        { test_write_fail, "test_write_fail" },
+        { NULL, NULL }
+    };
+
+    sys_start();
+
+    harness_run(testcases);
+
+    return (0);
+}
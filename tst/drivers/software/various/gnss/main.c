@@ -375,6 +375,50 @@ static int test_read_wrong_crc(void)
     return (0);
 }
 
+static int test_read_fix_on_bus(void)
+{
+    int i;
+    char sentences[] =
+        "$GPGGA,123519,4807.038,N,01131.000,E,1,08,0.9,545.4,M,46.9,M,,*47\r\n"
+        "$GPRMC,123519,A,4807.038,N,01131.000,W,022.4,084.4,230394,003.1,W*78\r\n";
+    struct bus_t bus;
+    struct bus_listener_t listener;
+    struct queue_t fixes;
+    struct gnss_fix_t fix;
+    char fixes_buf[2 * sizeof(fix)];
+
+    BTASSERT(bus_init(&bus) == 0);
+    BTASSERT(queue_init(&fixes, &fixes_buf[0], sizeof(fixes_buf)) == 0);
+    BTASSERT(bus_listener_init(&listener, 5, &fixes) == 0);
+    BTASSERT(bus_attach(&bus, &listener) == 0);
+
+    BTASSERTI(gnss_set_bus(&gnss, &bus, 5), ==, 0);
+    BTASSERTI(gnss_set_sentence_types(
+                  &gnss,
+                  NMEA_SENTENCE_TYPE_MASK(nmea_sentence_type_rmc_t)), ==, 0);
+
+    for (i = 0; i < strlen(sentences); i++) {
+        mock_write_chan_read(&sentences[i], 1, 1);
+    }
+
+    /* The GGA sentence is skipped. */
+    BTASSERTI(gnss_read(&gnss), ==, 0);
+    BTASSERTI(queue_size(&fixes), ==, sizeof(fix));
+    BTASSERTI(queue_read(&fixes, &fix, sizeof(fix)), ==, sizeof(fix));
+    BTASSERTI(fix.type, ==, nmea_sentence_type_rmc_t);
+    BTASSERTI(fix.date.year, ==, 94);
+    BTASSERTI(fix.date.second, ==, 19);
+    BTASSERTI(fix.latitude, ==, 48117300);
+    BTASSERTI(fix.longitude, ==, -11516666);
+    BTASSERTI(fix.speed, ==, 11523);
+
+    BTASSERTI(gnss_set_bus(&gnss, NULL, 0), ==, 0);
+    BTASSERTI(gnss_set_sentence_types(&gnss,
+                                      NMEA_SENTENCE_TYPE_MASK_ALL), ==, 0);
+
+    return (0);
+}
+
 static int test_write(void)
 {
     mock_write_chan_write("$GPFOO,BAR*2C\r\n", 15, 15);
@@ -398,6 +442,7 @@ int main()
         { test_read_start_not_first, "test_read_start_not_first" },
         { test_read_unsupported_sentence, "test_read_unsupported_sentence" },
         { test_read_wrong_crc, "test_read_wrong_crc" },
+        { test_read_fix_on_bus, "test_read_fix_on_bus" },
         { test_write, "test_write" },
         { NULL, NULL }
     };
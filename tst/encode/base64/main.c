@@ -69,6 +69,119 @@ static char *decoded[] = {
     "foobar"
 };
 
+/**
+ * The original character at a time implementation, used for
+ * comparison.
+ */
+static char reference_index_to_encoded(int index)
+{
+    if ((index >= 0) && (index <= 25)) {
+        return ('A' + index - 0);
+    } else if ((index >= 26) && (index <= 51)) {
+        return ('a' + index - 26);
+    } else if ((index >= 52) && (index <= 61)) {
+        return ('0' + index - 52);
+    } else if (index == 62) {
+        return ('+');
+    } else if (index == 63) {
+        return ('/');
+    } else {
+        return ('=');
+    }
+}
+
+static int reference_encoded_to_index(char encoded)
+{
+    if ((encoded >= 'A') && (encoded <= 'Z')) {
+        return (0 + encoded - 'A');
+    } else if ((encoded >= 'a') && (encoded <= 'z')) {
+        return (26 + encoded - 'a');
+    } else if ((encoded >= '0') && (encoded <= '9')) {
+        return (52 + encoded - '0');
+    } else if (encoded == '+') {
+        return (62);
+    } else if (encoded == '/') {
+        return (63);
+    } else if (encoded == '=') {
+        return (0);
+    }
+
+    return (-1);
+}
+
+static void reference_encode(char *dst_p, const uint8_t *s_p, size_t size)
+{
+    int i;
+    int j;
+    int index;
+
+    for (i = 0, j = 0; i < size; i += 3, j += 4) {
+        index = ((s_p[i + 0] & 0xfc) >> 2);
+        dst_p[j + 0] = reference_index_to_encoded(index);
+        index = ((s_p[i + 0] & 0x03) << 4);
+
+        if (i + 1 < size) {
+            index |= ((s_p[i + 1] & 0xf0) >> 4);
+            dst_p[j + 1] = reference_index_to_encoded(index);
+            index = (s_p[i + 1] & 0x0f) << 2;
+
+            if (i + 2 < size) {
+                index |= ((s_p[i + 2] & 0xc0) >> 6);
+                dst_p[j + 2] = reference_index_to_encoded(index);
+                index = (s_p[i + 2] & 0x3f);
+                dst_p[j + 3] = reference_index_to_encoded(index);
+            } else {
+                dst_p[j + 2] = reference_index_to_encoded(index);
+                dst_p[j + 3] = reference_index_to_encoded(64);
+            }
+        } else {
+            dst_p[j + 1] = reference_index_to_encoded(index);
+            dst_p[j + 2] = reference_index_to_encoded(64);
+            dst_p[j + 3] = reference_index_to_encoded(64);
+        }
+    }
+}
+
+static int reference_decode(uint8_t *d_p, const char *src_p, size_t size)
+{
+    int i;
+    int j;
+    int index[4];
+
+    for (i = 0, j = 0; i < size; i += 4, j += 3) {
+        index[0] = reference_encoded_to_index(src_p[i + 0]);
+        index[1] = reference_encoded_to_index(src_p[i + 1]);
+        index[2] = reference_encoded_to_index(src_p[i + 2]);
+        index[3] = reference_encoded_to_index(src_p[i + 3]);
+
+        if ((index[0] == -1)
+            || (index[1] == -1)
+            || (index[2] == -1)
+            || (index[3] == -1)) {
+            return (-1);
+        }
+
+        d_p[j] = ((index[0] << 2) | (index[1] >> 4));
+        d_p[j + 1] = ((index[1] << 4) | (index[2] >> 2));
+        d_p[j + 2] = ((index[2] << 6) | index[3]);
+    }
+
+    return (0);
+}
+
+static void fill_pseudo_random(uint8_t *buf_p, size_t size)
+{
+    uint32_t state;
+    size_t i;
+
+    state = 0x12345678;
+
+    for (i = 0; i < size; i++) {
+        state = (1103515245 * state + 12345);
+        buf_p[i] = (state >> 16);
+    }
+}
+
 static int test_encode(void)
 {
     int i;
@@ -143,11 +256,226 @@ static int test_decode(void)
     return (0);
 }
 
+static int test_compare(void)
+{
+    uint8_t data[100];
+    char encoded[136];
+    char reference_encoded[136];
+    uint8_t decoded[102];
+    uint8_t reference_decoded[102];
+    size_t size;
+    size_t encoded_size;
+    int c;
+
+    fill_pseudo_random(&data[0], sizeof(data));
+
+    for (size = 0; size <= sizeof(data); size++) {
+        encoded_size = (4 * DIV_CEIL(size, 3));
+        BTASSERT(base64_encode(&encoded[0], &data[0], size) == 0);
+        reference_encode(&reference_encoded[0], &data[0], size);
+        BTASSERTM(&encoded[0], &reference_encoded[0], encoded_size);
+
+        BTASSERT(base64_decode(&decoded[0], &encoded[0], encoded_size) == 0);
+        BTASSERT(reference_decode(&reference_decoded[0],
+                                  &encoded[0],
+                                  encoded_size) == 0);
+        BTASSERTM(&decoded[0], &reference_decoded[0], 3 * encoded_size / 4);
+        BTASSERTM(&decoded[0], &data[0], size);
+    }
+
+    /* Every character, valid or not. */
+    for (c = 0; c < 256; c++) {
+        memset(&encoded[0], 'A', 4);
+        encoded[c % 4] = c;
+        BTASSERTI(base64_decode(&decoded[0], &encoded[0], 4), ==,
+                  reference_decode(&reference_decoded[0], &encoded[0], 4));
+
+        if (reference_decode(&reference_decoded[0], &encoded[0], 4) == 0) {
+            BTASSERTM(&decoded[0], &reference_decoded[0], 3);
+        }
+    }
+
+    return (0);
+}
+
+static int test_encoder(void)
+{
+    struct base64_encoder_t encoder;
+    struct queue_t queue;
+    char queue_buf[400];
+    char buf[400];
+    size_t length;
+    size_t offset;
+    size_t chunk_size;
+    size_t size;
+
+    length = strlen(decoded_text);
+
+    /* Various chunk sizes, including larger than the internal
+       buffer. */
+    for (chunk_size = 1; chunk_size < 70; chunk_size++) {
+        BTASSERT(queue_init(&queue, &queue_buf[0], sizeof(queue_buf)) == 0);
+        BTASSERT(base64_encoder_init(&encoder, &queue) == 0);
+
+        for (offset = 0; offset < length; offset += size) {
+            size = MIN(chunk_size, length - offset);
+            BTASSERTI(base64_encoder_write(&encoder,
+                                           &decoded_text[offset],
+                                           size), ==, size);
+        }
+
+        BTASSERT(base64_encoder_flush(&encoder) == 0);
+        BTASSERTI(queue_size(&queue), ==, strlen(encoded_text));
+        BTASSERT(queue_read(&queue, &buf[0], strlen(encoded_text))
+                 == strlen(encoded_text));
+        BTASSERTM(&buf[0], &encoded_text[0], strlen(encoded_text));
+    }
+
+    /* Nothing to flush. */
+    BTASSERT(base64_encoder_init(&encoder, &queue) == 0);
+    BTASSERT(base64_encoder_write(&encoder, "Man", 3) == 3);
+    BTASSERT(base64_encoder_flush(&encoder) == 0);
+    BTASSERT(queue_read(&queue, &buf[0], 4) == 4);
+    BTASSERTM(&buf[0], "TWFu", 4);
+    BTASSERT(queue_size(&queue) == 0);
+
+    return (0);
+}
+
+static int test_decoder(void)
+{
+    struct base64_decoder_t decoder;
+    struct queue_t queue;
+    char queue_buf[400];
+    char buf[400];
+    size_t length;
+    size_t offset;
+    size_t chunk_size;
+    size_t size;
+    int i;
+
+    length = strlen(encoded_text);
+
+    for (chunk_size = 1; chunk_size < 70; chunk_size++) {
+        BTASSERT(queue_init(&queue, &queue_buf[0], sizeof(queue_buf)) == 0);
+        BTASSERT(base64_decoder_init(&decoder, &queue) == 0);
+
+        for (offset = 0; offset < length; offset += size) {
+            size = MIN(chunk_size, length - offset);
+            BTASSERTI(base64_decoder_write(&decoder,
+                                           &encoded_text[offset],
+                                           size), ==, size);
+        }
+
+        BTASSERT(base64_decoder_flush(&decoder) == 0);
+
+        /* Padding is not decoded. */
+        BTASSERTI(queue_size(&queue), ==, strlen(decoded_text));
+        BTASSERT(queue_read(&queue, &buf[0], strlen(decoded_text))
+                 == strlen(decoded_text));
+        BTASSERTM(&buf[0], &decoded_text[0], strlen(decoded_text));
+    }
+
+    for (i = 0; i < membersof(encoded); i++) {
+        BTASSERT(base64_decoder_init(&decoder, &queue) == 0);
+        BTASSERTI(base64_decoder_write(&decoder,
+                                       encoded[i],
+                                       strlen(encoded[i])), ==,
+                  strlen(encoded[i]));
+        BTASSERT(base64_decoder_flush(&decoder) == 0);
+        BTASSERTI(queue_size(&queue), ==, strlen(decoded[i]));
+        BTASSERT(queue_read(&queue,
+                            &buf[0],
+                            strlen(decoded[i])) == strlen(decoded[i]));
+        BTASSERTM(&buf[0], decoded[i], strlen(decoded[i]));
+    }
+
+    /* Bad character and incomplete data. */
+    BTASSERT(base64_decoder_init(&decoder, &queue) == 0);
+    BTASSERT(base64_decoder_write(&decoder, "TW\x01u", 4) == -EINVAL);
+    BTASSERT(base64_decoder_init(&decoder, &queue) == 0);
+    BTASSERT(base64_decoder_write(&decoder, "TWF", 3) == 3);
+    BTASSERT(base64_decoder_flush(&decoder) == -EINVAL);
+    BTASSERT(queue_size(&queue) == 0);
+
+    return (0);
+}
+
+static int test_benchmark(void)
+{
+    static uint8_t data[480];
+    static char encoded[640];
+    struct time_t start;
+    struct time_t stop;
+    int i;
+    unsigned long us[2];
+
+    fill_pseudo_random(&data[0], sizeof(data));
+
+    time_get(&start);
+
+    for (i = 0; i < 1000; i++) {
+        reference_encode(&encoded[0], &data[0], sizeof(data));
+    }
+
+    time_get(&stop);
+    time_subtract(&stop, &stop, &start);
+    us[0] = (stop.seconds * 1000000 + stop.nanoseconds / 1000);
+
+    time_get(&start);
+
+    for (i = 0; i < 1000; i++) {
+        base64_encode(&encoded[0], &data[0], sizeof(data));
+    }
+
+    time_get(&stop);
+    time_subtract(&stop, &stop, &start);
+    us[1] = (stop.seconds * 1000000 + stop.nanoseconds / 1000);
+
+    std_printf(FSTR("Encoding 1000 times %u bytes took %lu us, "
+                    "%lu us before.\r\n"),
+               (unsigned int)sizeof(data),
+               us[1],
+               us[0]);
+
+    time_get(&start);
+
+    for (i = 0; i < 1000; i++) {
+        reference_decode(&data[0], &encoded[0], sizeof(encoded));
+    }
+
+    time_get(&stop);
+    time_subtract(&stop, &stop, &start);
+    us[0] = (stop.seconds * 1000000 + stop.nanoseconds / 1000);
+
+    time_get(&start);
+
+    for (i = 0; i < 1000; i++) {
+        base64_decode(&data[0], &encoded[0], sizeof(encoded));
+    }
+
+    time_get(&stop);
+    time_subtract(&stop, &stop, &start);
+    us[1] = (stop.seconds * 1000000 + stop.nanoseconds / 1000);
+
+    std_printf(FSTR("Decoding 1000 times %u bytes took %lu us, "
+                    "%lu us before.\r\n"),
+               (unsigned int)sizeof(encoded),
+               us[1],
+               us[0]);
+
+    return (0);
+}
+
 int main()
 {
     struct harness_testcase_t testcases[] = {
         { test_encode, "test_encode" },
         { test_decode, "test_decode" },
+        { test_compare, "test_compare" },
+        { test_encoder, "test_encoder" },
+        { test_decoder, "test_decoder" },
+        { test_benchmark, "test_benchmark" },
         { NULL, NULL }
     };
 
@@ -0,0 +1,444 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2014-2018, Erik Moqvist
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use, copy,
+ * modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ * This file is part of the Simba project.
+ */
+
+
+#include "simba.h"
+
+/* Compressed data is read from and written to memory. */
+struct memory_chan_t {
+    struct chan_t base;
+    uint8_t *buf_p;
+    size_t size;
+    size_t pos;
+};
+
+static struct memory_chan_t input;
+static struct memory_chan_t output;
+static uint8_t input_buf[512];
+static uint8_t output_buf[4096];
+static uint8_t text[2048];
+static uint8_t decoded[2048];
+static uint8_t encoder_window[512];
+static uint8_t decoder_window[512];
+static struct deflate_encoder_t encoder;
+static struct deflate_decoder_t decoder;
+
+/* Compressed with zlib, using dynamic Huffman codes. */
+static const uint8_t dynamic_compressed[] = {
+    0xd4, 0x8b, 0x4b, 0x0e, 0x83, 0x20, 0x14, 0x45, 0xb7, 0x72, 0xc3, 0xd8,
+    0x10, 0xd1, 0x3a, 0x71, 0x1d, 0xdd, 0x80, 0x9f, 0xd7, 0x8a, 0x4a, 0xc1,
+    0x07, 0x68, 0xad, 0xe9, 0xde, 0x4b, 0xd2, 0x35, 0x38, 0x70, 0x7a, 0x3e,
+    0x87, 0x08, 0x64, 0x1c, 0x71, 0x13, 0x22, 0x93, 0xa8, 0x51, 0x28, 0x59,
+    0x65, 0x10, 0x43, 0x34, 0xba, 0xd7, 0x61, 0x4f, 0xe4, 0x96, 0x4b, 0x95,
+    0x88, 0x63, 0xf2, 0xfe, 0xdf, 0xa8, 0x5c, 0x95, 0xb2, 0xf8, 0x66, 0x38,
+    0xae, 0x39, 0xdf, 0x07, 0xc2, 0x12, 0x75, 0x37, 0xa1, 0x65, 0xbb, 0xbd,
+    0xf0, 0xb0, 0x6f, 0x8c, 0xd1, 0x38, 0x0f, 0xbb, 0x12, 0x23, 0x24, 0x3d,
+    0x37, 0x9f, 0x1d, 0xbd, 0x7d, 0xca, 0x13, 0xe3, 0x1f, 0x00, 0x00, 0x00,
+    0xff, 0xff
+};
+
+static const char dynamic_decompressed[] =
+    "{\"temperature\": 21.5, \"humidity\": 40.1, \"pressure\": 1013.2}, "
+    "{\"temperature\": 21.5, \"humidity\": 40.1, \"pressure\": 1013.2}, "
+    "{\"temperature\": 21.5, \"humidity\": 40.1, \"pressure\": 1013.2}, "
+    "{\"temperature\": 21.5, \"humidity\": 40.1, \"pressure\": 1013.2}, "
+    "The quick brown fox jumps over the lazy dog. "
+    "The quick brown fox jumps over the lazy dog. "
+    "The quick brown fox jumps over the lazy dog. ";
+
+static ssize_t memory_read(void *self_p, void *buf_p, size_t size)
+{
+    struct memory_chan_t *chan_p;
+
+    chan_p = self_p;
+    size = MIN(size, chan_p->size - chan_p->pos);
+    memcpy(buf_p, &chan_p->buf_p[chan_p->pos], size);
+    chan_p->pos += size;
+
+    return (size);
+}
+
+static ssize_t memory_write(void *self_p, const void *buf_p, size_t size)
+{
+    struct memory_chan_t *chan_p;
+
+    chan_p = self_p;
+
+    if (size > chan_p->size - chan_p->pos) {
+        return (-1);
+    }
+
+    memcpy(&chan_p->buf_p[chan_p->pos], buf_p, size);
+    chan_p->pos += size;
+
+    return (size);
+}
+
+static void memory_init(struct memory_chan_t *chan_p,
+                        void *buf_p,
+                        size_t size)
+{
+    chan_init(&chan_p->base, memory_read, memory_write, chan_size_null);
+    chan_p->buf_p = buf_p;
+    chan_p->size = size;
+    chan_p->pos = 0;
+}
+
+/**
+ * Decompress given data with the four bytes of the empty stored
+ * block appended, as a websocket permessage-deflate receiver does.
+ */
+static void input_init(const uint8_t *buf_p, size_t size)
+{
+    memcpy(&input_buf[0], buf_p, size);
+    memcpy(&input_buf[size], "\x00\x00\xff\xff", 4);
+    memory_init(&input, &input_buf[0], size + 4);
+}
+
+/**
+ * Append the four bytes of the empty stored block not written by
+ * the encoder to the compressed data.
+ */
+static size_t output_finish(void)
+{
+    memory_write(&output, "\x00\x00\xff\xff", 4);
+
+    return (output.pos);
+}
+
+/**
+ * Some JSON telemetry.
+ */
+static size_t create_text(void)
+{
+    size_t size;
+    int i;
+
+    size = 0;
+
+    for (i = 0; size < sizeof(text) - 128; i++) {
+        size += std_sprintf((char *)&text[size],
+                            FSTR("{\"id\": %d, \"temperature\": %d, "
+                                 "\"state\": \"%s\"}\n"),
+                            i,
+                            (i * 7) % 40,
+                            (i % 3) == 0 ? "idle" : "running");
+    }
+
+    return (size);
+}
+
+static int test_encode(void)
+{
+    memory_init(&output, &output_buf[0], sizeof(output_buf));
+    BTASSERT(deflate_encoder_init(&encoder, &output, 15, NULL) == 0);
+
+    /* The example in RFC 7692, without the trailing 0x00 0x00 0xff
+       0xff. */
+    BTASSERT(deflate_encoder_write(&encoder, "Hello", 5) == 5);
+    BTASSERT(deflate_encoder_flush(&encoder) == 0);
+    BTASSERT(output.pos == 7);
+    BTASSERT(memcmp(&output_buf[0],
+                    "\xf2\x48\xcd\xc9\xc9\x07\x00",
+                    7) == 0);
+
+    /* An empty message is a single byte. */
+    output.pos = 0;
+    BTASSERT(deflate_encoder_flush(&encoder) == 0);
+    BTASSERT(output.pos == 1);
+    BTASSERT(output_buf[0] == 0x00);
+
+    /* Without a window earlier data is not referred to. */
+    output.pos = 0;
+    BTASSERT(deflate_encoder_write(&encoder, "Hello", 5) == 5);
+    BTASSERT(deflate_encoder_flush(&encoder) == 0);
+    BTASSERT(output.pos == 7);
+
+    return (0);
+}
+
+static int test_encode_window(void)
+{
+    memory_init(&output, &output_buf[0], sizeof(output_buf));
+    BTASSERT(deflate_encoder_init(&encoder,
+                                  &output,
+                                  9,
+                                  &encoder_window[0]) == 0);
+
+    BTASSERT(deflate_encoder_write(&encoder, "Hello", 5) == 5);
+    BTASSERT(deflate_encoder_flush(&encoder) == 0);
+    BTASSERT(output.pos == 7);
+
+    /* The second message is a match in the first. The RFC 7692
+       example compresses it to five bytes, with a literal and a
+       match. */
+    output.pos = 0;
+    BTASSERT(deflate_encoder_write(&encoder, "Hello", 5) == 5);
+    BTASSERT(deflate_encoder_flush(&encoder) == 0);
+    BTASSERT(output.pos == 4);
+    BTASSERT(memcmp(&output_buf[0], "\x02\x13\x00\x00", 4) == 0);
+
+    return (0);
+}
+
+static int test_decode(void)
+{
+    /* Fixed Huffman codes. */
+    input_init((uint8_t *)"\xf2\x48\xcd\xc9\xc9\x07\x00", 7);
+    BTASSERT(deflate_decoder_init(&decoder, &input, 15, NULL) == 0);
+    BTASSERT(deflate_decoder_read(&decoder,
+                                  &decoded[0],
+                                  sizeof(decoded)) == 5);
+    BTASSERT(memcmp(&decoded[0], "Hello", 5) == 0);
+
+    /* Stored block. */
+    input_init((uint8_t *)"\x00\x05\x00\xfa\xff\x48\x65\x6c\x6c\x6f\x00", 11);
+    BTASSERT(deflate_decoder_init(&decoder, &input, 15, NULL) == 0);
+    BTASSERT(deflate_decoder_read(&decoder,
+                                  &decoded[0],
+                                  sizeof(decoded)) == 5);
+    BTASSERT(memcmp(&decoded[0], "Hello", 5) == 0);
+    BTASSERT(deflate_decoder_read(&decoder,
+                                  &decoded[0],
+                                  sizeof(decoded)) == 0);
+
+    /* Dynamic Huffman codes. Data not fitting in the buffer is
+       dropped. */
+    input_init(&dynamic_compressed[0], sizeof(dynamic_compressed) - 4);
+    BTASSERT(deflate_decoder_init(&decoder, &input, 15, NULL) == 0);
+    BTASSERT(deflate_decoder_read(&decoder,
+                                  &decoded[0],
+                                  sizeof(decoded)) == 379);
+    BTASSERT(memcmp(&decoded[0], &dynamic_decompressed[0], 379) == 0);
+
+    input_init(&dynamic_compressed[0], sizeof(dynamic_compressed) - 4);
+    BTASSERT(deflate_decoder_init(&decoder, &input, 15, NULL) == 0);
+    BTASSERT(deflate_decoder_read(&decoder, &decoded[0], 100) == 100);
+    BTASSERT(memcmp(&decoded[0], &dynamic_decompressed[0], 100) == 0);
+    BTASSERT(input.pos == input.size);
+
+    return (0);
+}
+
+static int test_decode_window(void)
+{
+    size_t size;
+    ssize_t res;
+
+    /* Read in chunks. */
+    input_init(&dynamic_compressed[0], sizeof(dynamic_compressed) - 4);
+    BTASSERT(deflate_decoder_init(&decoder,
+                                  &input,
+                                  9,
+                                  &decoder_window[0]) == 0);
+    size = 0;
+
+    while (1) {
+        res = deflate_decoder_read(&decoder, &decoded[size], 7);
+
+        if (res == 0) {
+            break;
+        }
+
+        BTASSERT(res > 0);
+        size += res;
+    }
+
+    BTASSERT(size == 379);
+    BTASSERT(memcmp(&decoded[0], &dynamic_decompressed[0], 379) == 0);
+
+    /* The second message refers to the first. */
+    input_init((uint8_t *)"\xf2\x48\xcd\xc9\xc9\x07\x00", 7);
+    BTASSERT(deflate_decoder_read(&decoder,
+                                  &decoded[0],
+                                  sizeof(decoded)) == 5);
+    BTASSERT(deflate_decoder_read(&decoder,
+                                  &decoded[0],
+                                  sizeof(decoded)) == 0);
+    input_init((uint8_t *)"\xf2\x00\x11\x00\x00", 5);
+    BTASSERT(deflate_decoder_read(&decoder,
+                                  &decoded[0],
+                                  sizeof(decoded)) == 5);
+    BTASSERT(memcmp(&decoded[0], "Hello", 5) == 0);
+
+    return (0);
+}
+
+static int test_decode_bad(void)
+{
+    /* Reserved block type. */
+    input_init((uint8_t *)"\x06", 1);
+    BTASSERT(deflate_decoder_init(&decoder, &input, 15, NULL) == 0);
+    BTASSERT(deflate_decoder_read(&decoder,
+                                  &decoded[0],
+                                  sizeof(decoded)) == -EPROTO);
+
+    /* A match before the start of the data. */
+    input_init((uint8_t *)"\xf2\x00\x11\x00\x00", 5);
+    BTASSERT(deflate_decoder_init(&decoder, &input, 15, NULL) == 0);
+    BTASSERT(deflate_decoder_read(&decoder,
+                                  &decoded[0],
+                                  sizeof(decoded)) == -EPROTO);
+
+    /* Bad stored block length. */
+    input_init((uint8_t *)"\x00\x05\x00\xfa\xfe", 5);
+    BTASSERT(deflate_decoder_init(&decoder, &input, 15, NULL) == 0);
+    BTASSERT(deflate_decoder_read(&decoder,
+                                  &decoded[0],
+                                  sizeof(decoded)) == -EPROTO);
+
+    return (0);
+}
+
+static int test_round_trip(void)
+{
+    size_t size;
+    size_t compressed_size;
+    size_t decoded_size;
+    ssize_t res;
+    int window_bits;
+
+    size = create_text();
+
+    for (window_bits = 8; window_bits <= 15; window_bits++) {
+        memory_init(&output, &output_buf[0], sizeof(output_buf));
+        BTASSERT(deflate_encoder_init(&encoder,
+                                      &output,
+                                      window_bits,
+                                      NULL) == 0);
+        BTASSERT(deflate_encoder_write(&encoder, &text[0], size) == size);
+        BTASSERT(deflate_encoder_flush(&encoder) == 0);
+        compressed_size = output_finish();
+        BTASSERT(compressed_size < size / 3);
+
+        /* One read without a window. */
+        memory_init(&input, &output_buf[0], compressed_size);
+        BTASSERT(deflate_decoder_init(&decoder, &input, 15, NULL) == 0);
+        BTASSERT(deflate_decoder_read(&decoder,
+                                      &decoded[0],
+                                      sizeof(decoded)) == size);
+        BTASSERT(memcmp(&decoded[0], &text[0], size) == 0);
+
+        /* Reads in chunks with a window. */
+        if (window_bits <= 9) {
+            memory_init(&input, &output_buf[0], compressed_size);
+            BTASSERT(deflate_decoder_init(&decoder,
+                                          &input,
+                                          window_bits,
+                                          &decoder_window[0]) == 0);
+            decoded_size = 0;
+
+            do {
+                res = deflate_decoder_read(&decoder,
+                                           &decoded[decoded_size],
+                                           33);
+                BTASSERT(res >= 0);
+                decoded_size += res;
+            } while (res > 0);
+
+            BTASSERT(decoded_size == size);
+            BTASSERT(memcmp(&decoded[0], &text[0], size) == 0);
+        }
+    }
+
+    /* Written in chunks with a window. */
+    memory_init(&output, &output_buf[0], sizeof(output_buf));
+    BTASSERT(deflate_encoder_init(&encoder,
+                                  &output,
+                                  9,
+                                  &encoder_window[0]) == 0);
+    BTASSERT(deflate_encoder_write(&encoder, &text[0], 1000) == 1000);
+    BTASSERT(deflate_encoder_write(&encoder, &text[1000], 1) == 1);
+    BTASSERT(deflate_encoder_write(&encoder,
+                                   &text[1001],
+                                   size - 1001) == size - 1001);
+    BTASSERT(deflate_encoder_flush(&encoder) == 0);
+
+    memory_init(&input, &output_buf[0], output_finish());
+    BTASSERT(deflate_decoder_init(&decoder,
+                                  &input,
+                                  9,
+                                  &decoder_window[0]) == 0);
+    BTASSERT(deflate_decoder_read(&decoder,
+                                  &decoded[0],
+                                  sizeof(decoded)) == size);
+    BTASSERT(memcmp(&decoded[0], &text[0], size) == 0);
+
+    return (0);
+}
+
+static int test_benchmark(void)
+{
+    size_t size;
+    int i;
+    struct time_t start;
+    struct time_t stop;
+    unsigned long us;
+
+    size = create_text();
+    time_get(&start);
+
+    for (i = 0; i < 100; i++) {
+        memory_init(&output, &output_buf[0], sizeof(output_buf));
+        BTASSERT(deflate_encoder_init(&encoder, &output, 10, NULL) == 0);
+        BTASSERT(deflate_encoder_write(&encoder, &text[0], size) == size);
+        BTASSERT(deflate_encoder_flush(&encoder) == 0);
+    }
+
+    time_get(&stop);
+    time_subtract(&stop, &stop, &start);
+    us = (stop.seconds * 1000000 + stop.nanoseconds / 1000);
+
+    std_printf(FSTR("Compressed %u bytes into %u bytes 100 times in "
+                    "%lu us.\r\n"),
+               (unsigned int)size,
+               (unsigned int)output.pos,
+               us);
+
+    return (0);
+}
+
+int main()
+{
+    struct harness_testcase_t testcases[] = {
+        { test_encode, "test_encode" },
+        { test_encode_window, "test_encode_window" },
+        { test_decode, "test_decode" },
+        { test_decode_window, "test_decode_window" },
+        { test_decode_bad, "test_decode_bad" },
+        { test_round_trip, "test_round_trip" },
+        { test_benchmark, "test_benchmark" },
+        { NULL, NULL }
+    };
+
+    sys_start();
+
+    harness_run(testcases);
+
+    return (0);
+}
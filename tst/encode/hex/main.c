@@ -28,6 +28,70 @@
 
 #include "simba.h"
 
+/**
+ * The original implementation, used for comparison.
+ */
+static int reference_to_nibble(int ch)
+{
+    ch = tolower(ch);
+
+    if ((ch >= '0') && (ch <= '9')) {
+        return (ch - '0');
+    } else if ((ch >= 'a') && (ch <= 'f')) {
+        return (ch - 'a' + 10);
+    } else {
+        return (-EINVAL);
+    }
+}
+
+static int reference_from_nibble(uint8_t nibble)
+{
+    if (nibble < 10) {
+        return (nibble + '0');
+    } else {
+        return (nibble + 'a' - 10);
+    }
+}
+
+static int reference_to_bin(uint8_t *dst_p, const char *src_p, size_t size)
+{
+    size_t i;
+    int ch;
+
+    size /= 2;
+
+    for (i = 0; i < size; i++) {
+        ch = reference_to_nibble(src_p[2 * i]);
+
+        if (ch < 0) {
+            return (ch);
+        }
+
+        dst_p[i] = ((uint8_t)ch << 4);
+        ch = reference_to_nibble(src_p[2 * i + 1]);
+
+        if (ch < 0) {
+            return (ch);
+        }
+
+        dst_p[i] |= (uint8_t)ch;
+    }
+
+    return (size);
+}
+
+static void reference_from_bin(char *dst_p, const uint8_t *src_p, size_t size)
+{
+    size_t i;
+
+    for (i = 0; i < size; i++) {
+        dst_p[2 * i] = reference_from_nibble((src_p[i] >> 4) & 0x0f);
+        dst_p[2 * i + 1] = reference_from_nibble(src_p[i] & 0x0f);
+    }
+
+    dst_p[2 * size] = '\0';
+}
+
 static int test_to_bin(void)
 {
     uint8_t encoded[8];
@@ -76,6 +140,106 @@ static int test_from_bin(void)
     return (0);
 }
 
+static int test_compare(void)
+{
+    uint8_t data[256];
+    char encoded[513];
+    char reference_encoded[513];
+    uint8_t decoded[1];
+    uint8_t reference_decoded[1];
+    char pair[2];
+    int i;
+
+    for (i = 0; i < 256; i++) {
+        data[i] = i;
+    }
+
+    BTASSERT(hex_from_bin(&encoded[0], &data[0], sizeof(data)) == 512);
+    reference_from_bin(&reference_encoded[0], &data[0], sizeof(data));
+    BTASSERTM(&encoded[0], &reference_encoded[0], sizeof(encoded));
+
+    /* Every character, valid or not. */
+    for (i = 0; i < 512; i++) {
+        pair[0] = (i < 256 ? i : 'a');
+        pair[1] = (i < 256 ? '0' : i - 256);
+        BTASSERTI(hex_to_bin(&decoded[0], &pair[0], 2), ==,
+                  reference_to_bin(&reference_decoded[0], &pair[0], 2));
+
+        if (reference_to_bin(&reference_decoded[0], &pair[0], 2) == 1) {
+            BTASSERTI(decoded[0], ==, reference_decoded[0]);
+        }
+    }
+
+    return (0);
+}
+
+static int test_benchmark(void)
+{
+    static uint8_t data[256];
+    static char encoded[513];
+    struct time_t start;
+    struct time_t stop;
+    int i;
+    unsigned long us[2];
+
+    for (i = 0; i < 256; i++) {
+        data[i] = i;
+    }
+
+    time_get(&start);
+
+    for (i = 0; i < 1000; i++) {
+        reference_from_bin(&encoded[0], &data[0], sizeof(data));
+    }
+
+    time_get(&stop);
+    time_subtract(&stop, &stop, &start);
+    us[0] = (stop.seconds * 1000000 + stop.nanoseconds / 1000);
+
+    time_get(&start);
+
+    for (i = 0; i < 1000; i++) {
+        hex_from_bin(&encoded[0], &data[0], sizeof(data));
+    }
+
+    time_get(&stop);
+    time_subtract(&stop, &stop, &start);
+    us[1] = (stop.seconds * 1000000 + stop.nanoseconds / 1000);
+
+    std_printf(FSTR("Converting 1000 times %u bytes to hex took %lu us, "
+                    "%lu us before.\r\n"),
+               (unsigned int)sizeof(data),
+               us[1],
+               us[0]);
+
+    time_get(&start);
+
+    for (i = 0; i < 1000; i++) {
+        reference_to_bin(&data[0], &encoded[0], 512);
+    }
+
+    time_get(&stop);
+    time_subtract(&stop, &stop, &start);
+    us[0] = (stop.seconds * 1000000 + stop.nanoseconds / 1000);
+
+    time_get(&start);
+
+    for (i = 0; i < 1000; i++) {
+        hex_to_bin(&data[0], &encoded[0], 512);
+    }
+
+    time_get(&stop);
+    time_subtract(&stop, &stop, &start);
+    us[1] = (stop.seconds * 1000000 + stop.nanoseconds / 1000);
+
+    std_printf(FSTR("Converting 1000 times 512 hex characters took %lu us, "
+                    "%lu us before.\r\n"),
+               us[1],
+               us[0]);
+
+    return (0);
+}
+
 int main()
 {
     struct harness_testcase_t testcases[] = {
@@ -83,6 +247,8 @@ int main()
         { test_to_bin_non_hex_character, "test_to_bin_non_hex_character" },
         { test_to_bin_odd_length, "test_to_bin_odd_length" },
         { test_from_bin, "test_from_bin" },
+        { test_compare, "test_compare" },
+        { test_benchmark, "test_benchmark" },
         { NULL, NULL }
     };
 
@@ -831,6 +831,206 @@ static int test_get(void)
     return (0);
 }
 
+static char stream_events[256];
+
+static int stream_callback(void *arg_p,
+                           enum json_event_type_t type,
+                           const char *buf_p,
+                           size_t size)
+{
+    static const char prefixes[] = "{}[]ksp";
+    char *end_p;
+
+    end_p = &stream_events[strlen(stream_events)];
+
+    if (buf_p == NULL) {
+        std_sprintf(end_p, FSTR("%c "), prefixes[type]);
+    } else {
+        BTASSERT(strlen(buf_p) == size);
+        std_sprintf(end_p, FSTR("%c:%s "), prefixes[type], buf_p);
+    }
+
+    return (0);
+}
+
+static int stream_parse(const char *path_p,
+                        const char *js_p,
+                        size_t chunk_size)
+{
+    struct json_stream_t stream;
+    char buf[8];
+    size_t size;
+    int res;
+
+    stream_events[0] = '\0';
+    BTASSERT(json_stream_init(&stream,
+                              &buf[0],
+                              sizeof(buf),
+                              stream_callback,
+                              NULL) == 0);
+    BTASSERT(json_stream_set_path(&stream, path_p) == 0);
+
+    while (*js_p != '\0') {
+        size = MIN(chunk_size, strlen(js_p));
+        res = json_stream_input(&stream, js_p, size);
+
+        if (res != 0) {
+            return (res);
+        }
+
+        js_p += size;
+    }
+
+    return (0);
+}
+
+static int test_stream(void)
+{
+    size_t chunk_size;
+    const char js[] =
+        "{\"a\": [1, -2.5, true, null], \"b\" : {\"c\":\"d\\\"e\"},"
+        " \"f\":{}, \"g\":[]}";
+
+    /* Any chunk size gives the same result. */
+    for (chunk_size = 1; chunk_size <= sizeof(js); chunk_size++) {
+        BTASSERTI(stream_parse(NULL, &js[0], chunk_size), ==, 0);
+        BTASSERTM(&stream_events[0],
+                  "{ k:a [ p:1 p:-2.5 p:true p:null ] k:b { k:c s:d\\\"e } "
+                  "k:f { } k:g [ ] } ",
+                  strlen(stream_events) + 1);
+    }
+
+    /* Root primitive, completed by whitespace. */
+    BTASSERTI(stream_parse(NULL, "123 \"foo\"", 1), ==, 0);
+    BTASSERTM(&stream_events[0], "p:123 s:foo ", strlen(stream_events) + 1);
+
+    return (0);
+}
+
+static int test_stream_path(void)
+{
+    const char js[] =
+        "{\"name\":\"a very long name that does not fit in the buffer\","
+        "\"sensors\":[{\"id\":1,\"type\":\"temp\"},"
+        "{\"type\":\"hum\",\"id\":2,\"ids\":[3]},"
+        "{\"id\":{\"x\":4}}]}";
+
+    BTASSERTI(stream_parse("$.sensors[*].id", &js[0], 5), ==, 0);
+    BTASSERTM(&stream_events[0],
+              "p:1 p:2 { k:x p:4 } ",
+              strlen(stream_events) + 1);
+
+    BTASSERTI(stream_parse("$.sensors[1]", &js[0], 5), ==, 0);
+    BTASSERTM(&stream_events[0],
+              "{ k:type s:hum k:id p:2 k:ids [ p:3 ] } ",
+              strlen(stream_events) + 1);
+
+    BTASSERTI(stream_parse("$.*[2].*.x", &js[0], 5), ==, 0);
+    BTASSERTM(&stream_events[0], "p:4 ", strlen(stream_events) + 1);
+
+    BTASSERTI(stream_parse("$.missing", &js[0], 5), ==, 0);
+    BTASSERTM(&stream_events[0], "", 1);
+
+    /* The name does not fit in the buffer. */
+    BTASSERTI(stream_parse("$.name", &js[0], 5), ==, JSON_ERROR_NOMEM);
+
+    return (0);
+}
+
+static int test_stream_bad(void)
+{
+    struct json_stream_t stream;
+    char buf[8];
+
+    BTASSERTI(stream_parse(NULL, "{\"a\" 1}", 1), ==, JSON_ERROR_INVAL);
+    BTASSERTI(stream_parse(NULL, "{\"a\":1]", 1), ==, JSON_ERROR_INVAL);
+    BTASSERTI(stream_parse(NULL, "[1,]", 1), ==, JSON_ERROR_INVAL);
+    BTASSERTI(stream_parse(NULL, "{1:2}", 1), ==, JSON_ERROR_INVAL);
+    BTASSERTI(stream_parse(NULL, "[1:2]", 1), ==, JSON_ERROR_INVAL);
+    BTASSERTI(stream_parse(NULL, "[[[[[[[[[1]]]]]]]]]", 1),
+              ==,
+              JSON_ERROR_NOMEM);
+
+    /* Bad paths. */
+    BTASSERT(json_stream_init(&stream,
+                              &buf[0],
+                              sizeof(buf),
+                              stream_callback,
+                              NULL) == 0);
+    BTASSERTI(json_stream_set_path(&stream, "a"), ==, -EINVAL);
+    BTASSERTI(json_stream_set_path(&stream, "$a"), ==, -EINVAL);
+    BTASSERTI(json_stream_set_path(&stream, "$.a."), ==, -EINVAL);
+    BTASSERTI(json_stream_set_path(&stream, "$[1"), ==, -EINVAL);
+    BTASSERTI(json_stream_set_path(&stream, "$[a]"), ==, -EINVAL);
+    BTASSERTI(json_stream_set_path(&stream, "$[1].a[*]"), ==, 0);
+
+    return (0);
+}
+
+static int test_writer(void)
+{
+    struct json_writer_t writer;
+    struct queue_t queue;
+    char queue_buf[256];
+    char buf[8];
+    char output[160];
+    const char expected[] =
+        "{\"id\":-2147483648,\"values\":[0,1.250,-0.05,12],"
+        "\"name\":\"a \\\"quoted\\\" name\\\\\\n\\u0001\","
+        "\"on\":true,\"off\":false,\"none\":null,\"empty\":{},"
+        "\"nested\":[[],{\"a\":[1]}]}";
+
+    BTASSERT(queue_init(&queue, &queue_buf[0], sizeof(queue_buf)) == 0);
+    BTASSERT(json_writer_init(&writer, &queue, &buf[0], sizeof(buf)) == 0);
+
+    BTASSERT(json_writer_begin_object(&writer) == 0);
+    BTASSERT(json_writer_key(&writer, "id") == 0);
+    BTASSERT(json_writer_integer(&writer, -2147483647L - 1) == 0);
+    BTASSERT(json_writer_key(&writer, "values") == 0);
+    BTASSERT(json_writer_begin_array(&writer) == 0);
+    BTASSERT(json_writer_integer(&writer, 0) == 0);
+    BTASSERT(json_writer_decimal(&writer, 1250, 3) == 0);
+    BTASSERT(json_writer_decimal(&writer, -5, 2) == 0);
+    BTASSERT(json_writer_decimal(&writer, 12, 0) == 0);
+    BTASSERT(json_writer_end_array(&writer) == 0);
+    BTASSERT(json_writer_key(&writer, "name") == 0);
+    BTASSERT(json_writer_string(&writer, "a \"quoted\" name\\\n\x01") == 0);
+    BTASSERT(json_writer_key(&writer, "on") == 0);
+    BTASSERT(json_writer_boolean(&writer, 1) == 0);
+    BTASSERT(json_writer_key(&writer, "off") == 0);
+    BTASSERT(json_writer_boolean(&writer, 0) == 0);
+    BTASSERT(json_writer_key(&writer, "none") == 0);
+    BTASSERT(json_writer_null(&writer) == 0);
+    BTASSERT(json_writer_key(&writer, "empty") == 0);
+    BTASSERT(json_writer_begin_object(&writer) == 0);
+    BTASSERT(json_writer_end_object(&writer) == 0);
+    BTASSERT(json_writer_key(&writer, "nested") == 0);
+    BTASSERT(json_writer_begin_array(&writer) == 0);
+    BTASSERT(json_writer_begin_array(&writer) == 0);
+    BTASSERT(json_writer_end_array(&writer) == 0);
+    BTASSERT(json_writer_begin_object(&writer) == 0);
+    BTASSERT(json_writer_key(&writer, "a") == 0);
+    BTASSERT(json_writer_begin_array(&writer) == 0);
+    BTASSERT(json_writer_integer(&writer, 1) == 0);
+    BTASSERT(json_writer_end_array(&writer) == 0);
+    BTASSERT(json_writer_end_object(&writer) == 0);
+    BTASSERT(json_writer_end_array(&writer) == 0);
+    BTASSERT(json_writer_end_object(&writer) == 0);
+
+    /* The last, partially filled, buffer is written when flushed. */
+    BTASSERTI(queue_size(&queue), >, 0);
+    BTASSERTI(queue_size(&queue), <, strlen(expected));
+
+    BTASSERTI(json_writer_flush(&writer), ==, strlen(expected));
+    BTASSERTI(queue_size(&queue), ==, strlen(expected));
+    BTASSERTI(queue_read(&queue, &output[0], strlen(expected)),
+              ==,
+              strlen(expected));
+    BTASSERTM(&output[0], &expected[0], strlen(expected));
+
+    return (0);
+}
+
 int main()
 {
     struct harness_testcase_t testcases[] = {
@@ -852,6 +1052,10 @@ int main()
         { test_dumps_fail, "test_dumps_fail" },
         { test_dump, "test_dump" },
         { test_get, "test_get" },
+        { test_stream, "test_stream" },
+        { test_stream_path, "test_stream_path" },
+        { test_stream_bad, "test_stream_bad" },
+        { test_writer, "test_writer" },
         { NULL, NULL }
     };
 
@@ -895,6 +895,410 @@ static int test_decode_bad_position(void)
     return (0);
 }
 
+/**
+ * Feed given string to given decoder and return the result of the
+ * last byte.
+ */
+static int decoder_input_string(struct nmea_decoder_t *decoder_p,
+                                const char *string_p,
+                                struct nmea_sentence_t *decoded_p)
+{
+    int res;
+
+    res = 0;
+
+    while (*string_p != '\0') {
+        res = nmea_decoder_input(decoder_p, *string_p++, decoded_p);
+
+        if ((res != 0) && (*string_p != '\0')) {
+            return (-1000);
+        }
+    }
+
+    return (res);
+}
+
+static int test_decoder(void)
+{
+    struct nmea_decoder_t decoder;
+    struct nmea_sentence_t decoded;
+
+    BTASSERTI(nmea_decoder_init(&decoder, NMEA_SENTENCE_TYPE_MASK_ALL), ==, 0);
+
+    /* Garbage before the first sentence. */
+    BTASSERTI(decoder_input_string(&decoder, "00*\r\n", &decoded), ==, 0);
+
+    /* GGA. */
+    BTASSERTI(decoder_input_string(
+                  &decoder,
+                  "$GPGGA,123519,4807.038,N,01131.000,E,1,08,0.9,545.4,"
+                  "M,46.9,M,,*47\r\n",
+                  &decoded), ==, 1);
+    BTASSERTI(decoded.type, ==, nmea_sentence_type_gga_t);
+    BTASSERTM(decoded.gga.time_of_fix_p, "123519", strlen("123519") + 1);
+    BTASSERTM(decoded.gga.longitude.angle_p, "01131.000", strlen("01131.000") + 1);
+    BTASSERTM(decoded.gga.height_of_geoid.unit_p, "M", strlen("M") + 1);
+
+    /* GLL with position and time in different order than in the
+       struct. */
+    BTASSERTI(decoder_input_string(
+                  &decoder,
+                  "$GPGLL,4916.45,N,12311.12,W,225444,A,*1D\r\n",
+                  &decoded), ==, 1);
+    BTASSERTI(decoded.type, ==, nmea_sentence_type_gll_t);
+    BTASSERTM(decoded.gll.time_of_fix_p, "225444", strlen("225444") + 1);
+    BTASSERTM(decoded.gll.latitude.angle_p, "4916.45", strlen("4916.45") + 1);
+    BTASSERTM(decoded.gll.data_active_p, "A", strlen("A") + 1);
+
+    /* GSV. */
+    BTASSERTI(decoder_input_string(
+                  &decoder,
+                  "$GPGSV,2,1,08,01,40,083,46,02,17,308,41,12,07,344,39,"
+                  "14,22,228,45*75\r\n",
+                  &decoded), ==, 1);
+    BTASSERTI(decoded.type, ==, nmea_sentence_type_gsv_t);
+    BTASSERTM(decoded.gsv.satellites[3].snr_p, "45", strlen("45") + 1);
+
+    /* Raw. */
+    BTASSERTI(decoder_input_string(&decoder,
+                                   "$GOO,,,,,,*47\r\n",
+                                   &decoded), ==, 1);
+    BTASSERTI(decoded.type, ==, nmea_sentence_type_raw_t);
+    BTASSERTM(decoded.raw.str_p, "GOO,,,,,,", strlen("GOO,,,,,,") + 1);
+
+    return (0);
+}
+
+static int test_decoder_bad(void)
+{
+    struct nmea_decoder_t decoder;
+    struct nmea_sentence_t decoded;
+
+    BTASSERTI(nmea_decoder_init(&decoder, NMEA_SENTENCE_TYPE_MASK_ALL), ==, 0);
+
+    /* Wrong CRC. */
+    BTASSERTI(decoder_input_string(&decoder,
+                                   "$GPFOO,BAR*2D\r\n",
+                                   &decoded), ==, -EPROTO);
+
+    /* Corrupt CRC. */
+    BTASSERTI(decoder_input_string(&decoder,
+                                   "$GPFOO,BAR*2X",
+                                   &decoded), ==, -EPROTO);
+
+    /* Missing carrige return. */
+    BTASSERTI(decoder_input_string(&decoder,
+                                   "$GPFOO,BAR*2C\n",
+                                   &decoded), ==, -EPROTO);
+
+    /* Too few fields, with a lower case CRC. */
+    BTASSERTI(decoder_input_string(&decoder,
+                                   "$GPGLL,,,,,,*50\r\n",
+                                   &decoded), ==, -EPROTO);
+    BTASSERTI(decoder_input_string(&decoder,
+                                   "$GPGGA,,,,,,,,,,,,,*7a\r\n",
+                                   &decoded), ==, -EPROTO);
+
+    /* Not a GNSS talker. The rest of the sentence is skipped. */
+    BTASSERTI(decoder_input_string(&decoder,
+                                   "$PFOO,",
+                                   &decoded), ==, -EPROTO);
+    BTASSERTI(decoder_input_string(&decoder,
+                                   "BAR*6B\r\n",
+                                   &decoded), ==, 0);
+
+    /* A new sentence start in the line termination. */
+    BTASSERTI(decoder_input_string(&decoder,
+                                   "$GPFOO,BAR*2C\r$",
+                                   &decoded), ==, -EPROTO);
+    BTASSERTI(decoder_input_string(&decoder,
+                                   "GPFOO,BAR*2C\r\n",
+                                   &decoded), ==, 1);
+
+    /* The decoder still works. */
+    BTASSERTI(decoder_input_string(&decoder,
+                                   "$GPGGA,,,,,,,,,,,,,,*56\r\n",
+                                   &decoded), ==, 1);
+
+    return (0);
+}
+
+static int test_decoder_skip(void)
+{
+    struct nmea_decoder_t decoder;
+    struct nmea_sentence_t decoded;
+
+    BTASSERTI(nmea_decoder_init(
+                  &decoder,
+                  (NMEA_SENTENCE_TYPE_MASK(nmea_sentence_type_gga_t)
+                   | NMEA_SENTENCE_TYPE_MASK(nmea_sentence_type_rmc_t))), ==, 0);
+
+    /* Skipped sentences are not decoded, not even their CRC. */
+    BTASSERTI(decoder_input_string(
+                  &decoder,
+                  "$GPGSV,2,1,08,01,40,083,46,02,17,308,41,12,07,344,39,"
+                  "14,22,228,45*00\r\n",
+                  &decoded), ==, 0);
+    BTASSERTI(decoder_input_string(&decoder,
+                                   "$GOO,,,,,,*47\r\n",
+                                   &decoded), ==, 0);
+
+    BTASSERTI(decoder_input_string(&decoder,
+                                   "$GPGGA,,,,,,,,,,,,,,*56\r\n",
+                                   &decoded), ==, 1);
+    BTASSERTI(decoded.type, ==, nmea_sentence_type_gga_t);
+
+    return (0);
+}
+
+static int test_decode_view(void)
+{
+    static const char gga[] =
+        "$GPGGA,123519,4807.038,N,01131.000,E,1,08,0.9,545.4,M,-46.9,M,,*6A\r\n";
+    struct nmea_view_t view;
+    const char *field_p;
+    size_t size;
+    int hour;
+    int minute;
+    int second;
+    int millisecond;
+    long value;
+
+    BTASSERTI(nmea_decode_view(&view, &gga[0], strlen(gga)), ==, 15);
+    BTASSERTI(view.type, ==, nmea_sentence_type_gga_t);
+
+    /* Fields refer to the sentence, which is not modified. */
+    field_p = nmea_view_field(&view, 0, &size);
+    BTASSERT(field_p == &gga[1]);
+    BTASSERTI(size, ==, 5);
+    field_p = nmea_view_field(&view, 2, &size);
+    BTASSERTI(size, ==, 8);
+    BTASSERTM(field_p, "4807.038,", 9);
+    field_p = nmea_view_field(&view, 14, &size);
+    BTASSERTI(size, ==, 0);
+    BTASSERT(nmea_view_field(&view, 15, &size) == NULL);
+    BTASSERT(nmea_view_field(&view, -1, &size) == NULL);
+
+    /* Fix time. */
+    BTASSERTI(nmea_view_decode_fix_time(&view,
+                                        1,
+                                        &hour,
+                                        &minute,
+                                        &second,
+                                        &millisecond), ==, 0);
+    BTASSERTI(hour, ==, 12);
+    BTASSERTI(minute, ==, 35);
+    BTASSERTI(second, ==, 19);
+    BTASSERTI(millisecond, ==, 0);
+
+    /* Latitude and longitude. */
+    BTASSERTI(nmea_view_decode_position(&view, 2, &value), ==, 0);
+    BTASSERTI(value, ==, 48000000 + (7038000 / 60));
+    BTASSERTI(nmea_view_decode_position(&view, 4, &value), ==, 0);
+    BTASSERTI(value, ==, 11000000 + (31000000 / 60));
+
+    /* Fixed-point values. */
+    BTASSERTI(nmea_view_decode_fixed(&view, 8, 1, &value), ==, 0);
+    BTASSERTI(value, ==, 9);
+    BTASSERTI(nmea_view_decode_fixed(&view, 9, 2, &value), ==, 0);
+    BTASSERTI(value, ==, 54540);
+    BTASSERTI(nmea_view_decode_fixed(&view, 9, 0, &value), ==, 0);
+    BTASSERTI(value, ==, 545);
+    BTASSERTI(nmea_view_decode_fixed(&view, 11, 1, &value), ==, 0);
+    BTASSERTI(value, ==, -469);
+    BTASSERTI(nmea_view_decode_fixed(&view, 7, 0, &value), ==, 0);
+    BTASSERTI(value, ==, 8);
+
+    /* Bad, empty and missing fields. */
+    BTASSERTI(nmea_view_decode_fixed(&view, 10, 0, &value), ==, -EPROTO);
+    BTASSERTI(nmea_view_decode_fixed(&view, 13, 0, &value), ==, -ENODATA);
+    BTASSERTI(nmea_view_decode_fixed(&view, 15, 0, &value), ==, -EPROTO);
+    BTASSERTI(nmea_view_decode_position(&view, 1, &value), ==, -EPROTO);
+    BTASSERTI(nmea_view_decode_position(&view, 3, &value), ==, -EPROTO);
+    BTASSERTI(nmea_view_decode_position(&view, 13, &value), ==, -ENODATA);
+    BTASSERTI(nmea_view_decode_fix_time(&view,
+                                        2,
+                                        &hour,
+                                        &minute,
+                                        &second,
+                                        &millisecond), ==, -EPROTO);
+
+    return (0);
+}
+
+static int test_decode_view_rmc(void)
+{
+    static const char rmc[] =
+        "$GPRMC,225446.25,A,4916.45,N,12311.12,W,000.5,054.7,191194,"
+        "020.3,E*41\r\n";
+    struct nmea_view_t view;
+    int hour;
+    int minute;
+    int second;
+    int millisecond;
+    int year;
+    int month;
+    int date;
+    long value;
+
+    BTASSERTI(nmea_decode_view(&view, &rmc[0], strlen(rmc)), ==, 12);
+    BTASSERTI(view.type, ==, nmea_sentence_type_rmc_t);
+
+    /* Sub-seconds at 20 Hz. */
+    BTASSERTI(nmea_view_decode_fix_time(&view,
+                                        1,
+                                        &hour,
+                                        &minute,
+                                        &second,
+                                        &millisecond), ==, 0);
+    BTASSERTI(hour, ==, 22);
+    BTASSERTI(minute, ==, 54);
+    BTASSERTI(second, ==, 46);
+    BTASSERTI(millisecond, ==, 250);
+
+    BTASSERTI(nmea_view_decode_position(&view, 5, &value), ==, 0);
+    BTASSERTI(value, ==, -(123000000 + (11120000 / 60)));
+
+    /* Speed in knots with three decimals. */
+    BTASSERTI(nmea_view_decode_fixed(&view, 7, 3, &value), ==, 0);
+    BTASSERTI(value, ==, 500);
+
+    BTASSERTI(nmea_view_decode_date(&view,
+                                    9,
+                                    &year,
+                                    &month,
+                                    &date), ==, 0);
+    BTASSERTI(year, ==, 94);
+    BTASSERTI(month, ==, 11);
+    BTASSERTI(date, ==, 19);
+
+    /* Magnetic variation. */
+    BTASSERTI(nmea_view_decode_fixed(&view, 10, 1, &value), ==, 0);
+    BTASSERTI(value, ==, 203);
+
+    return (0);
+}
+
+static int test_decode_view_bad(void)
+{
+    struct nmea_view_t view;
+    char sentence[] = "$GPGLL,1,2,3,4,5*4D\r\n";
+
+    BTASSERTI(nmea_decode_view(&view, &sentence[0], strlen(sentence)), ==, 6);
+    BTASSERTI(view.type, ==, nmea_sentence_type_gll_t);
+
+    /* Too short, bad dollar sign, asterix, line termination and
+       CRC. */
+    BTASSERTI(nmea_decode_view(&view, "$G*\r\n", 5), ==, -EPROTO);
+    sentence[0] = '#';
+    BTASSERTI(nmea_decode_view(&view, &sentence[0], strlen(sentence)),
+              ==,
+              -EPROTO);
+    sentence[0] = '$';
+    sentence[16] = ',';
+    BTASSERTI(nmea_decode_view(&view, &sentence[0], strlen(sentence)),
+              ==,
+              -EPROTO);
+    sentence[16] = '*';
+    sentence[20] = '\r';
+    BTASSERTI(nmea_decode_view(&view, &sentence[0], strlen(sentence)),
+              ==,
+              -EPROTO);
+    sentence[20] = '\n';
+    sentence[18] = 'E';
+    BTASSERTI(nmea_decode_view(&view, &sentence[0], strlen(sentence)),
+              ==,
+              -EPROTO);
+    sentence[18] = 'x';
+    BTASSERTI(nmea_decode_view(&view, &sentence[0], strlen(sentence)),
+              ==,
+              -EPROTO);
+
+    /* Too many fields. */
+    BTASSERTI(nmea_decode_view(&view,
+                               "$GPXXX,,,,,,,,,,,,,,,,,,,,,,,,*4F\r\n",
+                               35),
+              ==,
+              -ENOMEM);
+
+    /* Unknown type. */
+    BTASSERTI(nmea_decode_view(&view,
+                               "$GPXXX,,,,,,,,,,,,,,,,,,,,,,,*63\r\n",
+                               34),
+              ==,
+              24);
+    BTASSERTI(view.type, ==, nmea_sentence_type_raw_t);
+
+    return (0);
+}
+
+static int test_decode_view_benchmark(void)
+{
+    static const char gga[] =
+        "$GPGGA,123519,4807.038,N,01131.000,E,1,08,0.9,545.4,M,46.9,M,,*47\r\n";
+    char buf[sizeof(gga)];
+    struct nmea_sentence_t decoded;
+    struct nmea_view_t view;
+    struct time_t start;
+    struct time_t stop;
+    int hour;
+    int minute;
+    int second;
+    int millisecond;
+    long latitude;
+    long longitude;
+    long altitude;
+    int i;
+    unsigned long us[2];
+
+    time_get(&start);
+
+    for (i = 0; i < 1000; i++) {
+        memcpy(&buf[0], &gga[0], sizeof(buf));
+        nmea_decode(&decoded, &buf[0], sizeof(buf) - 1);
+        nmea_decode_fix_time(decoded.gga.time_of_fix_p,
+                             &hour,
+                             &minute,
+                             &second);
+        nmea_decode_position(&decoded.gga.latitude, &latitude);
+        nmea_decode_position(&decoded.gga.longitude, &longitude);
+        std_strtodfp(decoded.gga.altitude.value_p, &altitude, 1);
+    }
+
+    time_get(&stop);
+    time_subtract(&stop, &stop, &start);
+    us[0] = (stop.seconds * 1000000 + stop.nanoseconds / 1000);
+
+    time_get(&start);
+
+    for (i = 0; i < 1000; i++) {
+        nmea_decode_view(&view, &gga[0], sizeof(gga) - 1);
+        nmea_view_decode_fix_time(&view,
+                                  1,
+                                  &hour,
+                                  &minute,
+                                  &second,
+                                  &millisecond);
+        nmea_view_decode_position(&view, 2, &latitude);
+        nmea_view_decode_position(&view, 4, &longitude);
+        nmea_view_decode_fixed(&view, 9, 1, &altitude);
+    }
+
+    time_get(&stop);
+    time_subtract(&stop, &stop, &start);
+    us[1] = (stop.seconds * 1000000 + stop.nanoseconds / 1000);
+
+    std_printf(FSTR("Decoding 1000 GGA sentences took %lu us using a view "
+                    "and %lu us using nmea_decode().\r\n"),
+               us[1],
+               us[0]);
+
+    BTASSERTI(latitude, ==, 48000000 + (7038000 / 60));
+    BTASSERTI(altitude, ==, 5454);
+
+    return (0);
+}
+
 int main()
 {
     struct harness_testcase_t testcases[] = {
@@ -936,6 +1340,13 @@ int main()
         { test_decode_bad_date, "test_decode_bad_date" },
         { test_decode_position, "test_decode_position" },
         { test_decode_bad_position, "test_decode_bad_position" },
+        { test_decoder, "test_decoder" },
+        { test_decoder_bad, "test_decoder_bad" },
+        { test_decoder_skip, "test_decoder_skip" },
+        { test_decode_view, "test_decode_view" },
+        { test_decode_view_rmc, "test_decode_view_rmc" },
+        { test_decode_view_bad, "test_decode_view_bad" },
+        { test_decode_view_benchmark, "test_decode_view_benchmark" },
         { NULL, NULL }
     };
 
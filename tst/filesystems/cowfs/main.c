@@ -0,0 +1,561 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2014-2018, Erik Moqvist
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use, copy,
+ * modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ * This file is part of the Simba project.
+ */
+
+#include "simba.h"
+
+#define BLOCK_SIZE                                        512
+#define BLOCK_COUNT                                        64
+
+/* A RAM backed NOR flash. Programming can only clear bits. */
+static uint8_t flash_memory[BLOCK_SIZE * BLOCK_COUNT];
+static uint8_t flash_backup[BLOCK_SIZE * BLOCK_COUNT];
+static int erase_counts[BLOCK_COUNT];
+
+/* Number of flash operations left until a simulated power loss, or
+   -1 to never lose power. */
+static int operations_left = -1;
+
+static struct flash_driver_t flash;
+static struct cowfs_t cowfs;
+static uint8_t buf[4 * BLOCK_SIZE];
+static uint8_t data[4 * BLOCK_SIZE];
+
+static int power_lost(void)
+{
+    if (operations_left == 0) {
+        return (1);
+    }
+
+    if (operations_left > 0) {
+        operations_left--;
+    }
+
+    return (0);
+}
+
+ssize_t STUB(flash_read)(struct flash_driver_t *self_p,
+                         void *dst_p,
+                         uintptr_t src,
+                         size_t size)
+{
+    if (src + size > sizeof(flash_memory)) {
+        return (-EINVAL);
+    }
+
+    memcpy(dst_p, &flash_memory[src], size);
+
+    return (size);
+}
+
+ssize_t STUB(flash_write)(struct flash_driver_t *self_p,
+                          uintptr_t dst,
+                          const void *src_p,
+                          size_t size)
+{
+    const uint8_t *u8_src_p;
+    size_t i;
+
+    if (dst + size > sizeof(flash_memory)) {
+        return (-EINVAL);
+    }
+
+    if (power_lost()) {
+        return (-EIO);
+    }
+
+    u8_src_p = src_p;
+
+    for (i = 0; i < size; i++) {
+        flash_memory[dst + i] &= u8_src_p[i];
+    }
+
+    return (size);
+}
+
+int STUB(flash_erase)(struct flash_driver_t *self_p,
+                      uintptr_t addr,
+                      size_t size)
+{
+    if ((addr % BLOCK_SIZE) != 0) {
+        return (-EINVAL);
+    }
+
+    if (addr + size > sizeof(flash_memory)) {
+        return (-EINVAL);
+    }
+
+    if (power_lost()) {
+        return (-EIO);
+    }
+
+    memset(&flash_memory[addr], 0xff, size);
+    erase_counts[addr / BLOCK_SIZE]++;
+
+    return (0);
+}
+
+static void fill_data(int seed)
+{
+    size_t i;
+
+    for (i = 0; i < sizeof(data); i++) {
+        data[i] = (7 * i + seed);
+    }
+}
+
+static int write_file(const char *path_p, size_t size)
+{
+    struct cowfs_file_t file;
+
+    BTASSERT(cowfs_file_open(&cowfs,
+                             &file,
+                             path_p,
+                             FS_CREAT | FS_WRITE | FS_TRUNC) == 0);
+    BTASSERT(cowfs_file_write(&file, &data[0], size) == size);
+    BTASSERT(cowfs_file_close(&file) == 0);
+
+    return (0);
+}
+
+static int read_file(const char *path_p, size_t size)
+{
+    struct cowfs_file_t file;
+
+    BTASSERT(cowfs_file_open(&cowfs, &file, path_p, FS_READ) == 0);
+    BTASSERT(cowfs_file_size(&file) == size);
+    memset(&buf[0], 0, sizeof(buf));
+    BTASSERT(cowfs_file_read(&file, &buf[0], sizeof(buf)) == size);
+    BTASSERT(memcmp(&buf[0], &data[0], size) == 0);
+    BTASSERT(cowfs_file_read(&file, &buf[0], 1) == 0);
+    BTASSERT(cowfs_file_close(&file) == 0);
+
+    return (0);
+}
+
+static int test_format_mount(void)
+{
+    struct fs_stat_t stat;
+
+    memset(&flash_memory[0], 0xff, sizeof(flash_memory));
+
+    BTASSERT(cowfs_init(&cowfs,
+                        &flash,
+                        0,
+                        BLOCK_SIZE,
+                        BLOCK_COUNT) == 0);
+
+    /* Erased flash is not a file system. */
+    BTASSERT(cowfs_mount(&cowfs) == -EIO);
+
+    BTASSERT(cowfs_format(&cowfs) == 0);
+    BTASSERT(cowfs_mount(&cowfs) == 0);
+
+    /* A different geometry is rejected. */
+    BTASSERT(cowfs_init(&cowfs,
+                        &flash,
+                        0,
+                        BLOCK_SIZE,
+                        BLOCK_COUNT / 2) == 0);
+    BTASSERT(cowfs_mount(&cowfs) == -EINVAL);
+
+    BTASSERT(cowfs_init(&cowfs,
+                        &flash,
+                        0,
+                        BLOCK_SIZE,
+                        BLOCK_COUNT) == 0);
+    BTASSERT(cowfs_mount(&cowfs) == 0);
+
+    BTASSERT(cowfs_stat(&cowfs, "/", &stat) == 0);
+    BTASSERT(stat.type == FS_TYPE_DIR);
+    BTASSERT(cowfs_stat(&cowfs, "foo", &stat) == -ENOENT);
+
+    return (0);
+}
+
+static int test_read_write(void)
+{
+    struct cowfs_file_t file;
+    struct fs_stat_t stat;
+    size_t size;
+
+    fill_data(0);
+
+    /* Files spanning from zero to several blocks. */
+    for (size = 0; size <= sizeof(data); size += 397) {
+        BTASSERT(write_file("data.bin", size) == 0);
+        BTASSERT(read_file("data.bin", size) == 0);
+        BTASSERT(cowfs_stat(&cowfs, "data.bin", &stat) == 0);
+        BTASSERT(stat.type == FS_TYPE_FILE);
+        BTASSERT(stat.size == size);
+    }
+
+    /* Write in small chunks. */
+    BTASSERT(cowfs_file_open(&cowfs,
+                             &file,
+                             "/chunks.bin",
+                             FS_CREAT | FS_WRITE) == 0);
+
+    for (size = 0; size < sizeof(data); size += 13) {
+        BTASSERT(cowfs_file_write(&file,
+                                  &data[size],
+                                  MIN(13, sizeof(data) - size))
+                 == MIN(13, sizeof(data) - size));
+    }
+
+    BTASSERT(cowfs_file_size(&file) == sizeof(data));
+    BTASSERT(cowfs_file_close(&file) == 0);
+    BTASSERT(read_file("chunks.bin", sizeof(data)) == 0);
+
+    /* Open flags. */
+    BTASSERT(cowfs_file_open(&cowfs,
+                             &file,
+                             "chunks.bin",
+                             FS_CREAT | FS_EXCL | FS_WRITE) == -EEXIST);
+    BTASSERT(cowfs_file_open(&cowfs, &file, "missing", FS_READ) == -ENOENT);
+    BTASSERT(cowfs_file_open(&cowfs, &file, "chunks.bin", FS_READ) == 0);
+    BTASSERT(cowfs_file_write(&file, &data[0], 1) == -EACCES);
+    BTASSERT(cowfs_file_close(&file) == 0);
+    BTASSERT(cowfs_file_open(&cowfs,
+                             &file,
+                             "0123456789012345678901234567890123456789",
+                             FS_CREAT | FS_WRITE) == -ENAMETOOLONG);
+
+    BTASSERT(cowfs_remove(&cowfs, "chunks.bin") == 0);
+    BTASSERT(cowfs_remove(&cowfs, "chunks.bin") == -ENOENT);
+
+    return (0);
+}
+
+static int test_seek(void)
+{
+    struct cowfs_file_t file;
+    int pos;
+
+    fill_data(1);
+    BTASSERT(write_file("seek.bin", sizeof(data)) == 0);
+
+    BTASSERT(cowfs_file_open(&cowfs,
+                             &file,
+                             "seek.bin",
+                             FS_READ | FS_WRITE) == 0);
+
+    /* Random access reads, backwards through the skip-list. */
+    for (pos = sizeof(data) - 10; pos > 10; pos -= 311) {
+        BTASSERT(cowfs_file_seek(&file, pos, FS_SEEK_SET) == 0);
+        BTASSERT(cowfs_file_tell(&file) == pos);
+        BTASSERT(cowfs_file_read(&file, &buf[0], 10) == 10);
+        BTASSERT(memcmp(&buf[0], &data[pos], 10) == 0);
+    }
+
+    /* Overwrite in the middle of the file. */
+    BTASSERT(cowfs_file_seek(&file, 1000, FS_SEEK_SET) == 0);
+    memset(&data[1000], 'a', 100);
+    BTASSERT(cowfs_file_write(&file, &data[1000], 100) == 100);
+    BTASSERT(cowfs_file_tell(&file) == 1100);
+    BTASSERT(cowfs_file_read(&file, &buf[0], 10) == 10);
+    BTASSERT(memcmp(&buf[0], &data[1100], 10) == 0);
+
+    /* Read back the whole file. */
+    BTASSERT(cowfs_file_seek(&file, 0, FS_SEEK_SET) == 0);
+    BTASSERT(cowfs_file_read(&file, &buf[0], sizeof(buf)) == sizeof(data));
+    BTASSERT(memcmp(&buf[0], &data[0], sizeof(data)) == 0);
+    BTASSERT(cowfs_file_close(&file) == 0);
+    BTASSERT(read_file("seek.bin", sizeof(data)) == 0);
+
+    /* Writing after the end of the file fills the gap with zeros. */
+    fill_data(2);
+    BTASSERT(write_file("gap.bin", 100) == 0);
+    BTASSERT(cowfs_file_open(&cowfs, &file, "gap.bin", FS_WRITE) == 0);
+    BTASSERT(cowfs_file_seek(&file, 700, FS_SEEK_END) == 0);
+    BTASSERT(cowfs_file_write(&file, "x", 1) == 1);
+    BTASSERT(cowfs_file_seek(&file, -1, FS_SEEK_CUR) == 0);
+    BTASSERT(cowfs_file_tell(&file) == 800);
+    BTASSERT(cowfs_file_seek(&file, -1000, FS_SEEK_CUR) == -EINVAL);
+    BTASSERT(cowfs_file_close(&file) == 0);
+    memset(&data[100], 0, 700);
+    data[800] = 'x';
+    BTASSERT(read_file("gap.bin", 801) == 0);
+
+    /* Append. */
+    BTASSERT(cowfs_file_open(&cowfs,
+                             &file,
+                             "gap.bin",
+                             FS_WRITE | FS_APPEND) == 0);
+    BTASSERT(cowfs_file_write(&file, &data[801], 100) == 100);
+    BTASSERT(cowfs_file_close(&file) == 0);
+    BTASSERT(read_file("gap.bin", 901) == 0);
+
+    BTASSERT(cowfs_remove(&cowfs, "gap.bin") == 0);
+    BTASSERT(cowfs_remove(&cowfs, "seek.bin") == 0);
+
+    return (0);
+}
+
+static int test_directories(void)
+{
+    struct cowfs_dir_t dir;
+    struct fs_dir_entry_t entry;
+    struct fs_stat_t stat;
+    char path[32];
+    int i;
+    int count;
+
+    fill_data(3);
+
+    BTASSERT(cowfs_mkdir(&cowfs, "dir") == 0);
+    BTASSERT(cowfs_mkdir(&cowfs, "dir") == -EEXIST);
+    BTASSERT(cowfs_mkdir(&cowfs, "dir/sub") == 0);
+    BTASSERT(cowfs_mkdir(&cowfs, "missing/sub") == -ENOENT);
+    BTASSERT(cowfs_stat(&cowfs, "dir/sub", &stat) == 0);
+    BTASSERT(stat.type == FS_TYPE_DIR);
+    BTASSERT(write_file("dir/sub/file.txt", 10) == 0);
+    BTASSERT(read_file("/dir/sub/file.txt", 10) == 0);
+    BTASSERT(cowfs_stat(&cowfs, "dir/sub/file.txt/x", &stat) == -ENOTDIR);
+
+    /* Enough files to not fit in one metadata pair. */
+    for (i = 0; i < 40; i++) {
+        std_sprintf(&path[0], FSTR("dir/file-%d"), i);
+        BTASSERT(write_file(&path[0], i) == 0);
+    }
+
+    BTASSERT(cowfs_dir_open(&cowfs, &dir, "dir") == 0);
+    count = 0;
+
+    while (cowfs_dir_read(&dir, &entry) == 1) {
+        if (strcmp(&entry.name[0], "sub") == 0) {
+            BTASSERT(entry.type == FS_TYPE_DIR);
+        } else {
+            BTASSERT(entry.type == FS_TYPE_FILE);
+            BTASSERT(entry.size == atoi(&entry.name[5]));
+        }
+
+        count++;
+    }
+
+    BTASSERT(count == 41);
+    BTASSERT(cowfs_dir_close(&dir) == 0);
+
+    for (i = 0; i < 40; i++) {
+        std_sprintf(&path[0], FSTR("dir/file-%d"), i);
+        BTASSERT(read_file(&path[0], i) == 0);
+    }
+
+    /* Only empty directories can be removed. */
+    BTASSERT(cowfs_remove(&cowfs, "dir/sub") == -ENOTEMPTY);
+    BTASSERT(cowfs_remove(&cowfs, "dir/sub/file.txt") == 0);
+    BTASSERT(cowfs_remove(&cowfs, "dir/sub") == 0);
+
+    for (i = 0; i < 40; i++) {
+        std_sprintf(&path[0], FSTR("dir/file-%d"), i);
+        BTASSERT(cowfs_remove(&cowfs, &path[0]) == 0);
+    }
+
+    BTASSERT(cowfs_remove(&cowfs, "dir") == 0);
+    BTASSERT(cowfs_dir_open(&cowfs, &dir, "dir") == -ENOENT);
+    BTASSERT(cowfs_dir_open(&cowfs, &dir, "/") == 0);
+    BTASSERT(cowfs_dir_read(&dir, &entry) == 1);
+    BTASSERT(strcmp(&entry.name[0], "data.bin") == 0);
+    BTASSERT(cowfs_dir_read(&dir, &entry) == 0);
+
+    return (0);
+}
+
+static int test_remount(void)
+{
+    fill_data(4);
+    BTASSERT(write_file("remount.bin", 1234) == 0);
+    BTASSERT(cowfs_unmount(&cowfs) == 0);
+
+    memset(&cowfs, 0, sizeof(cowfs));
+    BTASSERT(cowfs_init(&cowfs,
+                        &flash,
+                        0,
+                        BLOCK_SIZE,
+                        BLOCK_COUNT) == 0);
+    BTASSERT(cowfs_mount(&cowfs) == 0);
+    BTASSERT(read_file("remount.bin", 1234) == 0);
+
+    return (0);
+}
+
+static int test_power_loss(void)
+{
+    struct cowfs_file_t file;
+    int operations;
+    int res;
+    int old;
+
+    fill_data(5);
+    BTASSERT(write_file("power.bin", 1500) == 0);
+
+    /* Lose power after every possible number of flash operations
+       when replacing the file contents. The file shall always
+       contain either its old or new contents after a remount. */
+    for (operations = 0; ; operations++) {
+        memcpy(&flash_backup[0], &flash_memory[0], sizeof(flash_memory));
+        fill_data(6);
+        operations_left = operations;
+        res = cowfs_file_open(&cowfs,
+                              &file,
+                              "power.bin",
+                              FS_WRITE | FS_TRUNC);
+
+        if (res == 0) {
+            res = cowfs_file_write(&file, &data[0], 1700);
+
+            if (cowfs_file_close(&file) != 0) {
+                res = -EIO;
+            }
+        }
+
+        operations_left = -1;
+        BTASSERT(cowfs_init(&cowfs,
+                            &flash,
+                            0,
+                            BLOCK_SIZE,
+                            BLOCK_COUNT) == 0);
+        BTASSERT(cowfs_mount(&cowfs) == 0);
+        BTASSERT(cowfs_file_open(&cowfs, &file, "power.bin", FS_READ) == 0);
+        old = (cowfs_file_size(&file) == 1500);
+        BTASSERT(cowfs_file_close(&file) == 0);
+
+        if (old) {
+            fill_data(5);
+            BTASSERT(read_file("power.bin", 1500) == 0);
+        } else {
+            BTASSERT(read_file("power.bin", 1700) == 0);
+        }
+
+        if (res == 1700) {
+            BTASSERT(old == 0);
+            break;
+        }
+
+        memcpy(&flash_memory[0], &flash_backup[0], sizeof(flash_memory));
+        BTASSERT(cowfs_mount(&cowfs) == 0);
+    }
+
+    BTASSERT(operations > 0);
+
+    return (0);
+}
+
+static int test_wear_levelling(void)
+{
+    int i;
+    int max;
+    struct cowfs_file_t file;
+
+    memset(&erase_counts[0], 0, sizeof(erase_counts));
+    fill_data(7);
+
+    /* Metadata pairs are moved every CONFIG_COWFS_BLOCK_CYCLES
+       commits, so no block is erased once per commit. */
+    for (i = 0; i < 200; i++) {
+        BTASSERT(write_file("wear.bin", 10) == 0);
+    }
+
+    max = 0;
+
+    for (i = 0; i < BLOCK_COUNT; i++) {
+        max = MAX(max, erase_counts[i]);
+    }
+
+    BTASSERT(max < 100);
+    BTASSERT(read_file("wear.bin", 10) == 0);
+
+    /* Fill the file system. */
+    BTASSERT(cowfs_file_open(&cowfs,
+                             &file,
+                             "full.bin",
+                             FS_CREAT | FS_WRITE) == 0);
+
+    while (1) {
+        if (cowfs_file_write(&file, &data[0], sizeof(data)) != sizeof(data)) {
+            break;
+        }
+    }
+
+    BTASSERT(cowfs_file_close(&file) == 0);
+    BTASSERT(cowfs_remove(&cowfs, "full.bin") == 0);
+    BTASSERT(write_file("wear.bin", sizeof(data)) == 0);
+    BTASSERT(read_file("wear.bin", sizeof(data)) == 0);
+
+    return (0);
+}
+
+static int test_fs(void)
+{
+    static struct fs_filesystem_t filesystem;
+    struct fs_file_t file;
+    struct fs_stat_t stat;
+    char buf[16];
+
+    BTASSERT(fs_filesystem_init_generic(&filesystem,
+                                        "/cowfs",
+                                        &cowfs.ops) == 0);
+    BTASSERT(fs_filesystem_register(&filesystem) == 0);
+
+    BTASSERT(fs_mkdir("/cowfs/fs") == 0);
+    BTASSERT(fs_open(&file, "/cowfs/fs/foo.txt", FS_CREAT | FS_RDWR) == 0);
+    BTASSERT(fs_write(&file, "hello!", 6) == 6);
+    BTASSERT(fs_seek(&file, 1, FS_SEEK_SET) == 0);
+    BTASSERT(fs_tell(&file) == 1);
+    BTASSERT(fs_read(&file, &buf[0], sizeof(buf)) == 5);
+    BTASSERT(memcmp(&buf[0], "ello!", 5) == 0);
+    BTASSERT(fs_close(&file) == 0);
+    BTASSERT(fs_stat("/cowfs/fs/foo.txt", &stat) == 0);
+    BTASSERT(stat.type == FS_TYPE_FILE);
+    BTASSERT(stat.size == 6);
+    BTASSERT(fs_remove("/cowfs/fs/foo.txt") == 0);
+    BTASSERT(fs_remove("/cowfs/fs") == 0);
+    BTASSERT(fs_stat("/cowfs/fs", &stat) != 0);
+
+    return (0);
+}
+
+int main()
+{
+    struct harness_testcase_t testcases[] = {
+        { test_format_mount, "test_format_mount" },
+        { test_read_write, "test_read_write" },
+        { test_seek, "test_seek" },
+        { test_directories, "test_directories" },
+        { test_remount, "test_remount" },
+        { test_power_loss, "test_power_loss" },
+        { test_wear_levelling, "test_wear_levelling" },
+        { test_fs, "test_fs" },
+        { NULL, NULL }
+    };
+
+    sys_start();
+
+    harness_run(testcases);
+
+    return (0);
+}
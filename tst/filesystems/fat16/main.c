@@ -37,6 +37,7 @@ static struct fat16_t fs;
 
 #if defined(ARCH_LINUX)
 static FILE *file_p = NULL;
+static int number_of_writes = 0;
 
 static ssize_t linux_read_block(void *arg_p,
                                 void *dst_p,
@@ -71,10 +72,49 @@ static ssize_t linux_write_block(void *arg_p,
         return (-1);
     }
 
+    number_of_writes++;
+
     fflush(file_p);
 
     return (SD_BLOCK_SIZE);
 }
+
+static int number_of_read_blocks_calls = 0;
+static int number_of_write_blocks_calls = 0;
+
+static ssize_t linux_read_blocks(void *arg_p,
+                                 void *dst_p,
+                                 uint32_t src_block,
+                                 size_t count)
+{
+    if (fseek(arg_p, SD_BLOCK_SIZE * src_block, SEEK_SET) != 0) {
+        return (-1);
+    }
+
+    number_of_read_blocks_calls++;
+
+    return (fread(dst_p, 1, SD_BLOCK_SIZE * count, arg_p));
+}
+
+static ssize_t linux_write_blocks(void *arg_p,
+                                  uint32_t dst_block,
+                                  const void *src_p,
+                                  size_t count)
+{
+    if (fseek(arg_p, SD_BLOCK_SIZE * dst_block, SEEK_SET) != 0) {
+        return (-1);
+    }
+
+    if (fwrite(src_p, 1, SD_BLOCK_SIZE * count, arg_p)
+        != SD_BLOCK_SIZE * count) {
+        return (-1);
+    }
+
+    fflush(file_p);
+    number_of_write_blocks_calls++;
+
+    return (SD_BLOCK_SIZE * count);
+}
 #endif
 
 int test_init(void)
@@ -437,6 +477,324 @@ static int test_seek(void)
     return (0);
 }
 
+static int test_cache(void)
+{
+#if defined(ARCH_LINUX) && (CONFIG_FAT16_CACHE_BLOCKS >= 3)
+    struct fat16_file_t log;
+    char buf[64];
+    int writes;
+    int i;
+
+    BTASSERT(fat16_file_open(&fs,
+                             &log,
+                             "LOG.TXT",
+                             O_CREAT | O_WRITE) == 0);
+
+    /* Append 16 blocks of data. FAT, directory and data blocks are
+       cached at the same time, so only full data blocks should be
+       written until the file is closed. */
+    writes = number_of_writes;
+
+    for (i = 0; i < 16 * 512; i += sizeof(buf)) {
+        memset(&buf[0], (char)(i / 512), sizeof(buf));
+        BTASSERT(fat16_file_write(&log,
+                                  &buf[0],
+                                  sizeof(buf)) == sizeof(buf));
+    }
+
+    BTASSERT(number_of_writes - writes == 15);
+
+    /* The last data block, the FAT block and its mirror, and the
+       directory block. */
+    BTASSERT(fat16_file_close(&log) == 0);
+    BTASSERT(number_of_writes - writes == 19);
+
+    /* Read it back. */
+    BTASSERT(fat16_file_open(&fs, &log, "LOG.TXT", O_READ) == 0);
+    BTASSERT(fat16_file_size(&log) == 16 * 512);
+
+    for (i = 0; i < 16 * 512; i += sizeof(buf)) {
+        BTASSERT(fat16_file_read(&log, &buf[0], sizeof(buf)) == sizeof(buf));
+        BTASSERT(buf[0] == (char)(i / 512));
+        BTASSERT(buf[sizeof(buf) - 1] == (char)(i / 512));
+    }
+
+    BTASSERT(fat16_file_close(&log) == 0);
+
+    return (0);
+#else
+    return (1);
+#endif
+}
+
+static int test_stream(void)
+{
+#if defined(ARCH_LINUX) && (CONFIG_FAT16_CACHE_BLOCKS >= 3)
+    struct fat16_file_t log;
+    char buf[512];
+    int writes;
+    int i;
+
+    BTASSERT(fat16_file_open(&fs,
+                             &log,
+                             "STREAM.TXT",
+                             O_CREAT | O_WRITE | O_SYNC | O_STREAM) == 0);
+
+    /* Reserve two clusters of four blocks each. */
+    BTASSERT(fat16_file_preallocate(&log, 8 * 512) == 0);
+    BTASSERT(fat16_file_size(&log) == 0);
+
+    /* Only the data block is written by each synchronous write, as
+       the clusters are already allocated and the directory entry is
+       not updated until the file is closed. */
+    writes = number_of_writes;
+
+    for (i = 0; i < 8; i++) {
+        memset(&buf[0], 'a' + i, sizeof(buf));
+        BTASSERT(fat16_file_write(&log,
+                                  &buf[0],
+                                  sizeof(buf)) == sizeof(buf));
+        BTASSERT(number_of_writes - writes == i + 1);
+    }
+
+    /* Already reserved. */
+    BTASSERT(fat16_file_preallocate(&log, 8 * 512) == 0);
+
+    /* The directory block. */
+    BTASSERT(fat16_file_close(&log) == 0);
+    BTASSERT(number_of_writes - writes == 9);
+
+    /* Read it back. Writes are appended at the end of the file. */
+    BTASSERT(fat16_file_open(&fs, &log, "STREAM.TXT", O_RDWR | O_STREAM) == 0);
+    BTASSERT(fat16_file_size(&log) == 8 * 512);
+    BTASSERT(fat16_file_write(&log, "z", 1) == 1);
+    BTASSERT(fat16_file_seek(&log, 0, FAT16_SEEK_SET) == 0);
+
+    for (i = 0; i < 8; i++) {
+        BTASSERT(fat16_file_read(&log, &buf[0], sizeof(buf)) == sizeof(buf));
+        BTASSERT(buf[0] == 'a' + i);
+        BTASSERT(buf[sizeof(buf) - 1] == 'a' + i);
+    }
+
+    BTASSERT(fat16_file_read(&log, &buf[0], sizeof(buf)) == 1);
+    BTASSERT(buf[0] == 'z');
+    BTASSERT(fat16_file_close(&log) == 0);
+
+    /* Not open for writing. */
+    BTASSERT(fat16_file_open(&fs, &log, "STREAM.TXT", O_READ) == 0);
+    BTASSERT(fat16_file_preallocate(&log, 16 * 512) == -1);
+    BTASSERT(fat16_file_close(&log) == 0);
+
+    return (0);
+#else
+    return (1);
+#endif
+}
+
+static int test_fat32(void)
+{
+#if defined(ARCH_LINUX) && (CONFIG_FAT16_FAT32 == 1)
+    static struct fat16_t fs32;
+    FILE *sdcard32_p;
+    struct fat16_file_t file;
+    struct fat16_dir_t dir;
+    struct fat16_dir_entry_t entry;
+    char buf[600];
+    char filename[16];
+    fat_t free_count;
+    fat_t next_free;
+    int number_of_entries;
+    int i;
+
+    /* An empty 36 MB sd card file, large enough for FAT32 with one
+       block per cluster. */
+    sdcard32_p = fopen("sdcard32", "w+b");
+    BTASSERT(sdcard32_p != NULL);
+    BTASSERT(fseek(sdcard32_p, 73728 * 512 - 1, SEEK_SET) == 0);
+    BTASSERT(fputc(0, sdcard32_p) == 0);
+
+    BTASSERT(fat16_init(&fs32,
+                        linux_read_block,
+                        linux_write_block,
+                        sdcard32_p,
+                        0) == 0);
+    BTASSERT(fat16_format_fat32(&fs32, 16384) == -1);
+    BTASSERT(fat16_format_fat32(&fs32, 73728) == 0);
+    BTASSERT(fat16_mount(&fs32) == 0);
+    BTASSERT(fat16_print(&fs32, sys_get_stdout()) == 0);
+    BTASSERT(fs32.fat_type == 32);
+    BTASSERT(fs32.blocks_per_cluster == 1);
+    BTASSERT(fs32.free_count == fs32.cluster_count - 1);
+    BTASSERT(fs32.next_free == 3);
+
+    /* A file of many clusters. */
+    for (i = 0; i < sizeof(buf); i++) {
+        buf[i] = i;
+    }
+
+    BTASSERT(fat16_file_open(&fs32,
+                             &file,
+                             "LOG.TXT",
+                             O_CREAT | O_WRITE) == 0);
+
+    for (i = 0; i < 20; i++) {
+        BTASSERT(fat16_file_write(&file, &buf[0], sizeof(buf)) == sizeof(buf));
+    }
+
+    BTASSERT(fat16_file_close(&file) == 0);
+    BTASSERT(fs32.free_count == fs32.cluster_count - 1 - 24);
+    BTASSERT(fs32.next_free == 3 + 24);
+
+    /* More files than fits in the first cluster of the root
+       directory. */
+    for (i = 0; i < 40; i++) {
+        std_sprintf(filename, FSTR("FILE%d.TXT"), i);
+        BTASSERT(fat16_file_open(&fs32,
+                                 &file,
+                                 filename,
+                                 O_CREAT | O_WRITE) == 0);
+        BTASSERT(fat16_file_write(&file, filename, 4) == 4);
+        BTASSERT(fat16_file_close(&file) == 0);
+    }
+
+    /* A file with a cluster number above 65535. */
+    fs32.next_free = 70000;
+    BTASSERT(fat16_dir_open(&fs32, &dir, "DATA", O_CREAT | O_WRITE) == 0);
+    BTASSERT(fat16_dir_close(&dir) == 0);
+    BTASSERT(fat16_file_open(&fs32,
+                             &file,
+                             "DATA/HIGH.TXT",
+                             O_CREAT | O_WRITE) == 0);
+    BTASSERT(fat16_file_write(&file, "high", 4) == 4);
+    BTASSERT(file.first_cluster > 70000);
+    BTASSERT(fat16_file_close(&file) == 0);
+
+    /* The free cluster hints are stored in the FSInfo block. */
+    free_count = fs32.free_count;
+    next_free = fs32.next_free;
+    BTASSERT(fat16_unmount(&fs32) == 0);
+    BTASSERT(fat16_mount(&fs32) == 0);
+    BTASSERT(fs32.free_count == free_count);
+    BTASSERT(fs32.next_free == next_free);
+
+    /* Read it all back. */
+    BTASSERT(fat16_file_open(&fs32, &file, "LOG.TXT", O_READ) == 0);
+    BTASSERT(fat16_file_size(&file) == 20 * sizeof(buf));
+
+    for (i = 0; i < 20; i++) {
+        memset(&buf[0], -1, sizeof(buf));
+        BTASSERT(fat16_file_read(&file, &buf[0], sizeof(buf)) == sizeof(buf));
+        BTASSERT(buf[0] == 0);
+        BTASSERT(buf[sizeof(buf) - 1] == (char)(sizeof(buf) - 1));
+    }
+
+    BTASSERT(fat16_file_close(&file) == 0);
+
+    BTASSERT(fat16_file_open(&fs32, &file, "FILE39.TXT", O_READ) == 0);
+    BTASSERT(fat16_file_read(&file, &buf[0], 4) == 4);
+    BTASSERT(memcmp(&buf[0], "FILE", 4) == 0);
+    BTASSERT(fat16_file_close(&file) == 0);
+
+    BTASSERT(fat16_file_open(&fs32, &file, "DATA/HIGH.TXT", O_READ) == 0);
+    BTASSERT(fat16_file_read(&file, &buf[0], 4) == 4);
+    BTASSERT(memcmp(&buf[0], "high", 4) == 0);
+    BTASSERT(fat16_file_close(&file) == 0);
+
+    /* List the root directory. */
+    BTASSERT(fat16_dir_open(&fs32, &dir, ".", O_READ) == 0);
+    number_of_entries = 0;
+
+    while (fat16_dir_read(&dir, &entry) == 1) {
+        number_of_entries++;
+    }
+
+    BTASSERT(number_of_entries == 42, "%d", number_of_entries);
+    BTASSERT(fat16_dir_close(&dir) == 0);
+
+    /* Preallocated clusters are contiguous. */
+    BTASSERT(fat16_file_open(&fs32,
+                             &file,
+                             "PRE.TXT",
+                             O_CREAT | O_WRITE) == 0);
+    BTASSERT(fat16_file_preallocate(&file, 10 * 512) == 0);
+    BTASSERT(fs32.free_count == free_count - 10);
+    BTASSERT(fat16_file_truncate(&file, 512) == 0);
+    BTASSERT(fat16_file_size(&file) == 512);
+    BTASSERT(fs32.free_count == free_count - 1);
+    BTASSERT(fat16_file_close(&file) == 0);
+
+    BTASSERT(fat16_unmount(&fs32) == 0);
+    fclose(sdcard32_p);
+
+    return (0);
+#else
+    return (1);
+#endif
+}
+
+static int test_blocks(void)
+{
+#if defined(ARCH_LINUX)
+    static uint8_t buf[10 * 512 + 100];
+    struct fat16_file_t file;
+    int i;
+
+    BTASSERT(fat16_set_blocks_callbacks(&fs,
+                                        linux_read_blocks,
+                                        linux_write_blocks) == 0);
+
+    for (i = 0; i < sizeof(buf); i++) {
+        buf[i] = (i / 512 + i);
+    }
+
+    /* Write ten blocks and a bit. Whole blocks are written cluster by
+       cluster, four blocks per cluster, and the rest is cached. */
+    BTASSERT(fat16_file_open(&fs,
+                             &file,
+                             "BLOCKS.TXT",
+                             O_CREAT | O_WRITE) == 0);
+    BTASSERT(fat16_file_write(&file, &buf[0], sizeof(buf)) == sizeof(buf));
+    BTASSERT(number_of_write_blocks_calls == 3);
+    BTASSERT(fat16_file_close(&file) == 0);
+
+    /* Read it back. */
+    memset(&buf[0], 0, sizeof(buf));
+    BTASSERT(fat16_file_open(&fs, &file, "BLOCKS.TXT", O_READ) == 0);
+    BTASSERT(fat16_file_read(&file, &buf[0], sizeof(buf)) == sizeof(buf));
+    BTASSERT(number_of_read_blocks_calls > 0);
+    BTASSERT(fat16_file_close(&file) == 0);
+
+    for (i = 0; i < sizeof(buf); i++) {
+        BTASSERT(buf[i] == (uint8_t)(i / 512 + i), "i = %d", i);
+    }
+
+    /* A read of whole blocks returns data written to the cache but
+       not yet to the device. */
+    BTASSERT(fat16_file_open(&fs, &file, "BLOCKS.TXT", O_RDWR) == 0);
+    BTASSERT(fat16_file_write(&file, "0123456789", 10) == 10);
+    BTASSERT(fat16_file_seek(&file, 0, FAT16_SEEK_SET) == 0);
+    BTASSERT(fat16_file_read(&file, &buf[0], 2048) == 2048);
+    BTASSERT(memcmp(&buf[0], "0123456789", 10) == 0);
+    BTASSERT(buf[10] == 10);
+    BTASSERT(buf[2047] == (uint8_t)(3 + 2047));
+
+    /* Whole blocks written directly replace cached blocks. */
+    BTASSERT(fat16_file_seek(&file, 0, FAT16_SEEK_SET) == 0);
+    memset(&buf[0], 'a', 2048);
+    BTASSERT(fat16_file_write(&file, &buf[0], 2048) == 2048);
+    BTASSERT(fat16_file_seek(&file, 0, FAT16_SEEK_SET) == 0);
+    BTASSERT(fat16_file_read(&file, &buf[0], 10) == 10);
+    BTASSERT(memcmp(&buf[0], "aaaaaaaaaa", 10) == 0);
+    BTASSERT(fat16_file_close(&file) == 0);
+
+    BTASSERT(fat16_set_blocks_callbacks(&fs, NULL, NULL) == 0);
+
+    return (0);
+#else
+    return (1);
+#endif
+}
+
 static int test_unmount(void)
 {
     BTASSERT(fat16_unmount(&fs) == 0);
@@ -463,6 +821,10 @@ int main()
         { test_truncate, "test_truncate" },
         { test_append, "test_append" },
         { test_seek, "test_seek" },
+        { test_blocks, "test_blocks" },
+        { test_cache, "test_cache" },
+        { test_stream, "test_stream" },
+        { test_fat32, "test_fat32" },
         { test_unmount, "test_unmount" },
         { NULL, NULL }
     };
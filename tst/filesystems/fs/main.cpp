@@ -185,6 +185,8 @@ static int tmp_bar(int argc,
     return (0);
 }
 
+FS_COMMAND_DEFINE(tmp_static_bar, "/tmp/static/bar", tmp_bar, NULL);
+
 static struct queue_t qout;
 static char qoutbuf[BUFFER_SIZE];
 
@@ -275,6 +277,128 @@ static int test_command(void)
     return (0);
 }
 
+static int test_command_deregister(void)
+{
+    struct fs_command_t command;
+    struct fs_counter_t counter;
+    char buf[64];
+
+    BTASSERT(fs_command_init(&command, FSTR("/tmp/baz"), tmp_bar, NULL) == 0);
+    BTASSERT(fs_command_register(&command) == 0);
+
+    strcpy(buf, "/tmp/baz");
+    BTASSERT(fs_call(buf, NULL, &qout, NULL) == 0);
+
+    BTASSERT(fs_command_deregister(&command) == 0);
+    BTASSERT(fs_command_deregister(&command) == -ENOENT);
+
+    strcpy(buf, "/tmp/baz");
+    BTASSERT(fs_call(buf, NULL, &qout, NULL) == -ENOCOMMAND);
+    BTASSERT(harness_expect(&qout, "\n", NULL) > 0);
+
+    /* The neighbours of the removed command are still registered. */
+    strcpy(buf, "/tmp/bar");
+    BTASSERT(fs_call(buf, NULL, &qout, NULL) == 0);
+    strcpy(buf, "/tmp/foo/bar 1 2");
+    BTASSERT(fs_call(buf, NULL, &qout, NULL) == 0);
+    BTASSERT(harness_expect(&qout, "\n", NULL) > 0);
+
+    /* Counter. */
+    BTASSERT(fs_counter_init(&counter, FSTR("/tmp/counter"), 0) == 0);
+    BTASSERT(fs_counter_register(&counter) == 0);
+    BTASSERT(fs_counter_deregister(&counter) == 0);
+    BTASSERT(fs_counter_deregister(&counter) == -ENOENT);
+
+    strcpy(buf, "/tmp/counter");
+    BTASSERT(fs_call(buf, NULL, &qout, NULL) == -ENOCOMMAND);
+    BTASSERT(harness_expect(&qout, "\n", NULL) > 0);
+
+    return (0);
+}
+
+static int test_command_index(void)
+{
+#if defined(ARCH_LINUX)
+
+    static struct fs_command_t commands[80];
+    static char paths[80][16];
+    char buf[32];
+    int i;
+
+    /* Register commands in reverse order, more than fits in the
+       index. */
+    for (i = membersof(commands) - 1; i >= 0; i--) {
+        std_sprintf(&paths[i][0], FSTR("/tmp/index/%02d"), i);
+        BTASSERT(fs_command_init(&commands[i],
+                                 &paths[i][0],
+                                 tmp_bar,
+                                 NULL) == 0);
+        BTASSERT(fs_command_register(&commands[i]) == 0);
+    }
+
+    for (i = 0; i < membersof(commands); i++) {
+        std_sprintf(&buf[0], FSTR("tmp/index/%02d"), i);
+        BTASSERT(fs_call(buf, NULL, &qout, NULL) == 0);
+    }
+
+    strcpy(buf, "/tmp/ind");
+    BTASSERT(fs_auto_complete(buf) == 3);
+    BTASSERT(strcmp(buf, "/tmp/index/") == 0);
+    strcpy(buf, "/tmp/index/7");
+    BTASSERT(fs_auto_complete(buf) == 0);
+    strcpy(buf, "tmp/index/79");
+    BTASSERT(fs_auto_complete(buf) == 1);
+    BTASSERT(strcmp(buf, "tmp/index/79 ") == 0);
+
+    /* Remove every second command, making the index valid again. */
+    for (i = 0; i < membersof(commands); i += 2) {
+        BTASSERT(fs_command_deregister(&commands[i]) == 0);
+    }
+
+    for (i = 0; i < membersof(commands); i++) {
+        std_sprintf(&buf[0], FSTR("/tmp/index/%02d"), i);
+
+        if ((i % 2) == 0) {
+            BTASSERT(fs_call(buf, NULL, &qout, NULL) == -ENOCOMMAND);
+            BTASSERT(harness_expect(&qout, "\n", NULL) > 0);
+        } else {
+            BTASSERT(fs_call(buf, NULL, &qout, NULL) == 0);
+        }
+    }
+
+    strcpy(buf, "/tmp/ind");
+    BTASSERT(fs_auto_complete(buf) == 3);
+    BTASSERT(strcmp(buf, "/tmp/index/") == 0);
+    strcpy(buf, "/tmp/index/7");
+    BTASSERT(fs_auto_complete(buf) == 0);
+    strcpy(buf, "tmp/index/79");
+    BTASSERT(fs_auto_complete(buf) == 1);
+    BTASSERT(strcmp(buf, "tmp/index/79 ") == 0);
+    strcpy(buf, "/tmp/index/8");
+    BTASSERT(fs_auto_complete(buf) == -ENOENT);
+
+    strcpy(buf, "/tmp/index");
+    BTASSERT(fs_call(buf, NULL, &qout, NULL) == -ENOCOMMAND);
+    BTASSERT(harness_expect(&qout, "\n", NULL) > 0);
+    strcpy(buf, "/tmp/index/999");
+    BTASSERT(fs_call(buf, NULL, &qout, NULL) == -ENOCOMMAND);
+    BTASSERT(harness_expect(&qout, "\n", NULL) > 0);
+    strcpy(buf, "/tmp/bar");
+    BTASSERT(fs_call(buf, NULL, &qout, NULL) == 0);
+
+    for (i = 1; i < membersof(commands); i += 2) {
+        BTASSERT(fs_command_deregister(&commands[i]) == 0);
+    }
+
+    return (0);
+
+#else
+
+    return (1);
+
+#endif
+}
+
 static int test_counter(void)
 {
     char buf[384];
@@ -301,6 +425,54 @@ static int test_counter(void)
     return (0);
 }
 
+static int test_counter_snapshot(void)
+{
+    uint64_t value;
+
+    BTASSERT(fs_counter_set(&my_counter, 0xfffffffe) == 0);
+    BTASSERT(fs_counter_increment(&my_counter, 1) == 0);
+    BTASSERT(fs_counter_increment_isr(&my_counter, 2) == 0);
+    BTASSERT(fs_counter_get(&my_counter, &value) == 0);
+    BTASSERT(value == 0x100000001ull);
+    BTASSERT(fs_counter_set(&my_counter, 0) == 0);
+    BTASSERT(fs_counter_get(&my_counter, &value) == 0);
+    BTASSERT(value == 0);
+
+    return (0);
+}
+
+static int test_counters_export(void)
+{
+    char buf[64];
+    uint8_t data[64];
+    static const uint8_t expected[] = {
+        13, '/', 'y', 'o', 'u', 'r', '/', 'c', 'o', 'u', 'n', 't', 'e', 'r',
+        0x00, 0x00, 0x00, 0x01, 0x02, 0x03, 0x04, 0x05,
+        11, '/', 'm', 'y', '/', 'c', 'o', 'u', 'n', 't', 'e', 'r',
+        0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x07,
+        0
+    };
+
+    BTASSERT(fs_counter_set(&your_counter, 0x0102030405ull) == 0);
+    BTASSERT(fs_counter_increment(&my_counter, 7) == 0);
+
+    BTASSERT(fs_counters_export(&qout) == 2);
+    BTASSERT(queue_read(&qout, &data[0], sizeof(expected))
+             == sizeof(expected));
+    BTASSERTM(&data[0], &expected[0], sizeof(expected));
+
+    strcpy(buf, "filesystems/fs/counters/export");
+    BTASSERT(fs_call(buf, NULL, &qout, NULL) == 0);
+    BTASSERT(queue_read(&qout, &data[0], sizeof(expected))
+             == sizeof(expected));
+    BTASSERTM(&data[0], &expected[0], sizeof(expected));
+
+    BTASSERT(fs_counter_set(&your_counter, 0) == 0);
+    BTASSERT(fs_counter_set(&my_counter, 0) == 0);
+
+    return (0);
+}
+
 static int test_parameter(void)
 {
     char buf[256];
@@ -330,6 +502,43 @@ static int test_parameter(void)
     return (0);
 }
 
+static int test_command_static(void)
+{
+    char buf[CONFIG_FS_PATH_MAX];
+
+    BTASSERT(fs_static_commands_length == 1);
+    BTASSERT(fs_static_commands[0] == &fs_command_tmp_static_bar);
+
+    strcpy(buf, "/tmp/static/bar 1 2");
+    BTASSERT(fs_call(buf, NULL, &qout, NULL) == 0);
+
+    strcpy(buf, "tmp/static/bar");
+    BTASSERT(fs_call(buf, NULL, &qout, NULL) == 0);
+
+    strcpy(buf, "/tmp/static");
+    BTASSERT(fs_call(buf, NULL, &qout, NULL) == -ENOCOMMAND);
+    BTASSERT(harness_expect(&qout, "\n", NULL) > 0);
+
+    /* Auto-completion and listing merge static and registered
+       commands. */
+    strcpy(buf, "/tmp/s");
+    BTASSERT(fs_auto_complete(buf) == 6);
+    BTASSERT(strcmp(buf, "/tmp/static/") == 0);
+
+    strcpy(buf, "/tmp/static/");
+    BTASSERT(fs_auto_complete(buf) == 4);
+    BTASSERT(strcmp(buf, "/tmp/static/bar ") == 0);
+
+    BTASSERT(fs_list("/tmp", NULL, &qout) == 0);
+    BTASSERT(harness_expect(&qout,
+                            "bar\r\n"
+                            "foo/\r\n"
+                            "static/\r\n",
+                            NULL) > 0);
+
+    return (0);
+}
+
 static int test_list(void)
 {
     BTASSERT(fs_list("filesystems", NULL, &qout) == 0);
@@ -630,6 +839,109 @@ static int test_filesystem_generic(void)
     return (0);
 }
 
+static struct fs_filesystem_operations_t async_ops;
+static struct fs_filesystem_t asyncfs;
+static THRD_STACK(async_stack, 1024);
+static size_t async_write_sizes[4];
+static int async_number_of_writes;
+static int async_number_of_callbacks;
+
+static int async_file_open(struct fs_filesystem_t *filesystem_p,
+                           struct fs_file_t *self_p,
+                           const char *path_p,
+                           int flags)
+{
+    return (0);
+}
+
+static ssize_t async_file_write(struct fs_file_t *self_p,
+                                const void *src_p,
+                                size_t size)
+{
+    if (async_number_of_writes < (int)membersof(async_write_sizes)) {
+        async_write_sizes[async_number_of_writes] = size;
+    }
+
+    async_number_of_writes++;
+
+    return (size);
+}
+
+static void async_callback(struct fs_request_t *request_p, void *arg_p)
+{
+    async_number_of_callbacks++;
+    event_write((struct event_t *)arg_p,
+                &request_p->mask,
+                sizeof(request_p->mask));
+}
+
+static int test_filesystem_async(void)
+{
+    struct fs_file_t file;
+    struct fs_request_t requests[4];
+    struct event_t event;
+    uint32_t mask;
+    uint32_t done;
+    char buf[16];
+
+    async_ops.file_open = async_file_open;
+    async_ops.file_write = async_file_write;
+    BTASSERT(fs_filesystem_init_generic(&asyncfs,
+                                        "/async",
+                                        &async_ops) == 0);
+    BTASSERT(fs_filesystem_register(&asyncfs) == 0);
+    BTASSERT(fs_filesystem_async_start(&asyncfs,
+                                       async_stack,
+                                       sizeof(async_stack)) == 0);
+    BTASSERT(fs_filesystem_async_start(&asyncfs,
+                                       async_stack,
+                                       sizeof(async_stack)) == -EBUSY);
+    BTASSERT(event_init(&event) == 0);
+    BTASSERT(fs_open(&file, "/async/foo.txt", FS_WRITE) == 0);
+
+    /* Three writes of consecutive buffers are merged, but not the
+       fourth. */
+    BTASSERT(fs_request_init_event(&requests[0], &event, 0x1) == 0);
+    BTASSERT(fs_request_init_event(&requests[1], &event, 0x2) == 0);
+    BTASSERT(fs_request_init(&requests[2], async_callback, &event) == 0);
+    requests[2].mask = 0x4;
+    BTASSERT(fs_request_init_event(&requests[3], &event, 0x8) == 0);
+    BTASSERT(fs_write_async(&file, &buf[0], 4, &requests[0]) == 0);
+    BTASSERT(fs_write_async(&file, &buf[4], 4, &requests[1]) == 0);
+    BTASSERT(fs_write_async(&file, &buf[8], 2, &requests[2]) == 0);
+    BTASSERT(fs_write_async(&file, &buf[0], 3, &requests[3]) == 0);
+    async_number_of_writes = 0;
+    done = 0;
+
+    /* Wait for all requests to complete. */
+    while (done != 0xf) {
+        mask = (0xf & ~done);
+        BTASSERT(event_read(&event, &mask, sizeof(mask)) == sizeof(mask));
+        done |= mask;
+    }
+
+    BTASSERT(requests[0].res == 4);
+    BTASSERT(requests[1].res == 4);
+    BTASSERT(requests[2].res == 2);
+    BTASSERT(requests[3].res == 3);
+    BTASSERT(async_number_of_callbacks == 1);
+    BTASSERT(async_number_of_writes == 2);
+    BTASSERT(async_write_sizes[0] == 10);
+    BTASSERT(async_write_sizes[1] == 3);
+
+    /* A read, using the default read operation. */
+    BTASSERT(fs_request_init_event(&requests[0], &event, 0x1) == 0);
+    BTASSERT(fs_read_async(&file, &buf[0], 4, &requests[0]) == 0);
+    mask = 0x1;
+    BTASSERT(event_read(&event, &mask, sizeof(mask)) == sizeof(mask));
+    BTASSERT(mask == 0x1);
+    BTASSERT(requests[0].res == 4);
+
+    BTASSERT(fs_close(&file) == 0);
+
+    return (0);
+}
+
 static int test_filesystem(void)
 {
 #if defined(ARCH_LINUX)
@@ -827,6 +1139,168 @@ static int test_read_line(void)
 #endif
 }
 
+static struct fs_filesystem_operations_t buffered_ops;
+static struct fs_filesystem_t bufferedfs;
+static char buffered_data[256];
+static size_t buffered_size;
+static size_t buffered_pos;
+static int buffered_number_of_reads;
+static int buffered_number_of_writes;
+
+static int buffered_file_open(struct fs_filesystem_t *filesystem_p,
+                              struct fs_file_t *self_p,
+                              const char *path_p,
+                              int flags)
+{
+    if (flags & FS_BUFFERED) {
+        return (-1);
+    }
+
+    if (flags & FS_TRUNC) {
+        buffered_size = 0;
+    }
+
+    buffered_pos = 0;
+
+    return (0);
+}
+
+static int buffered_file_close(struct fs_file_t *self_p)
+{
+    return (0);
+}
+
+static ssize_t buffered_file_read(struct fs_file_t *self_p,
+                                  void *dst_p,
+                                  size_t size)
+{
+    buffered_number_of_reads++;
+    size = MIN(size, buffered_size - buffered_pos);
+    memcpy(dst_p, &buffered_data[buffered_pos], size);
+    buffered_pos += size;
+
+    return (size);
+}
+
+static ssize_t buffered_file_write(struct fs_file_t *self_p,
+                                   const void *src_p,
+                                   size_t size)
+{
+    buffered_number_of_writes++;
+    size = MIN(size, sizeof(buffered_data) - buffered_pos);
+    memcpy(&buffered_data[buffered_pos], src_p, size);
+    buffered_pos += size;
+    buffered_size = MAX(buffered_size, buffered_pos);
+
+    return (size);
+}
+
+static int buffered_file_seek(struct fs_file_t *self_p,
+                              int offset,
+                              int whence)
+{
+    switch (whence) {
+
+    case FS_SEEK_SET:
+        buffered_pos = offset;
+        break;
+
+    case FS_SEEK_CUR:
+        buffered_pos += offset;
+        break;
+
+    default:
+        buffered_pos = (buffered_size + offset);
+        break;
+    }
+
+    return (0);
+}
+
+static ssize_t buffered_file_tell(struct fs_file_t *self_p)
+{
+    return (buffered_pos);
+}
+
+static int test_buffered(void)
+{
+#if CONFIG_FS_FILE_BUFFER_SIZE > 0
+    struct fs_file_t file;
+    char line[16];
+    char buf[128];
+    int i;
+
+    buffered_ops.file_open = buffered_file_open;
+    buffered_ops.file_close = buffered_file_close;
+    buffered_ops.file_read = buffered_file_read;
+    buffered_ops.file_write = buffered_file_write;
+    buffered_ops.file_seek = buffered_file_seek;
+    buffered_ops.file_tell = buffered_file_tell;
+    BTASSERT(fs_filesystem_init_generic(&bufferedfs,
+                                        "/buffered",
+                                        &buffered_ops) == 0);
+    BTASSERT(fs_filesystem_register(&bufferedfs) == 0);
+
+    /* Small writes are written when the buffer is full. */
+    BTASSERT(fs_open(&file,
+                     "/buffered/lines.txt",
+                     FS_CREAT | FS_TRUNC | FS_RDWR | FS_BUFFERED) == 0);
+
+    for (i = 0; i < 30; i++) {
+        BTASSERT(fs_write(&file, "ab\n", 3) == 3);
+    }
+
+    BTASSERTI(buffered_number_of_writes, ==, 1);
+    BTASSERTI(fs_tell(&file), ==, 90);
+    BTASSERT(fs_seek(&file, 0, FS_SEEK_SET) == 0);
+    BTASSERTI(buffered_number_of_writes, ==, 2);
+    BTASSERTI(buffered_size, ==, 90);
+
+    /* Lines are read from the buffer. */
+    buffered_number_of_reads = 0;
+
+    for (i = 0; i < 30; i++) {
+        BTASSERTI(fs_read_line(&file, line, sizeof(line)), ==, 2);
+        BTASSERT(strcmp(line, "ab") == 0);
+    }
+
+    BTASSERTI(fs_read_line(&file, line, sizeof(line)), ==, -1);
+    BTASSERTI(buffered_number_of_reads, ==, 3);
+
+    /* Write after read-ahead at the user position. */
+    BTASSERT(fs_seek(&file, 3, FS_SEEK_SET) == 0);
+    BTASSERT(fs_read(&file, buf, 1) == 1);
+    BTASSERT(fs_seek(&file, 1, FS_SEEK_CUR) == 0);
+    BTASSERTI(fs_tell(&file), ==, 5);
+    BTASSERT(fs_write(&file, "XY", 2) == 2);
+    BTASSERTI(fs_tell(&file), ==, 7);
+    BTASSERT(fs_flush(&file) == 0);
+    BTASSERTM(&buffered_data[3], "abXYb\n", 6);
+
+    /* Large reads and writes are not buffered. */
+    BTASSERT(fs_seek(&file, 0, FS_SEEK_SET) == 0);
+    buffered_number_of_reads = 0;
+    BTASSERTI(fs_read(&file, buf, 80), ==, 80);
+    BTASSERTI(buffered_number_of_reads, ==, 1);
+    buffered_number_of_writes = 0;
+    BTASSERT(fs_seek(&file, 0, FS_SEEK_END) == 0);
+    BTASSERT(fs_write(&file, "c", 1) == 1);
+    BTASSERT(fs_write(&file, buf, sizeof(buf)) == sizeof(buf));
+    BTASSERTI(buffered_number_of_writes, ==, 2);
+    BTASSERTI(buffered_size, ==, 90 + 1 + sizeof(buf));
+
+    /* Closing writes buffered data. */
+    BTASSERT(fs_write(&file, "d", 1) == 1);
+    BTASSERT(fs_close(&file) == 0);
+    BTASSERTI(buffered_number_of_writes, ==, 3);
+    BTASSERTI(buffered_size, ==, 90 + 1 + sizeof(buf) + 1);
+
+    return (0);
+#else
+    return (1);
+#endif
+}
+
 static int test_cwd(void)
 {
 #if defined(ARCH_LINUX)
@@ -878,7 +1352,12 @@ int main()
         { test_init, "test_init" },
         { test_auto_complete, "test_auto_complete" },
         { test_command, "test_command" },
+        { test_command_deregister, "test_command_deregister" },
+        { test_command_index, "test_command_index" },
+        { test_command_static, "test_command_static" },
         { test_counter, "test_counter" },
+        { test_counter_snapshot, "test_counter_snapshot" },
+        { test_counters_export, "test_counters_export" },
         { test_parameter, "test_parameter" },
         { test_list, "test_list" },
         { test_split_merge, "test_split_merge" },
@@ -889,7 +1368,9 @@ int main()
         { test_filesystem_generic, "test_filesystem_generic" },
         { test_filesystem, "test_filesystem" },
         { test_filesystem_commands, "test_filesystem_commands" },
+        { test_filesystem_async, "test_filesystem_async" },
         { test_read_line, "test_read_line" },
+        { test_buffered, "test_buffered" },
         { test_cwd, "test_cwd" },
         { NULL, NULL }
     };
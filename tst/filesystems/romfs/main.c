@@ -0,0 +1,153 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2014-2018, Erik Moqvist
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use, copy,
+ * modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ * This file is part of the Simba project.
+ */
+
+#include "simba.h"
+
+extern const struct romfs_file_t romfs_files[];
+
+static struct romfs_t romfs;
+
+static int test_init(void)
+{
+    BTASSERT(romfs_init(&romfs, &romfs_files[0]) == 0);
+    BTASSERT(romfs.number_of_files == 3);
+
+    return (0);
+}
+
+static int test_find(void)
+{
+    const struct romfs_file_t *file_p;
+
+    file_p = romfs_find(&romfs, "hello.txt");
+    BTASSERT(file_p != NULL);
+    BTASSERT(file_p->size == 13);
+    BTASSERT(romfs_find(&romfs, "/dir/table.bin") == &romfs_files[0]);
+    BTASSERT(romfs_find(&romfs, "empty.txt") == &romfs_files[1]);
+    BTASSERT(romfs_find(&romfs, "dir") == NULL);
+    BTASSERT(romfs_find(&romfs, "zzz") == NULL);
+    BTASSERT(romfs_find(&romfs, "") == NULL);
+
+    return (0);
+}
+
+static int test_mmap(void)
+{
+    const void *buf_p;
+    const uint16_t *table_p;
+    size_t size;
+    int i;
+
+    BTASSERT(romfs_mmap(&romfs, "hello.txt", &buf_p, &size) == 0);
+    BTASSERT(size == 13);
+    BTASSERT(memcmp(buf_p, "Hello world!\n", 13) == 0);
+
+    /* The contents are not copied. */
+    BTASSERT(buf_p == romfs_files[2].buf_p);
+
+    /* A lookup table, aligned for direct access. */
+    BTASSERT(romfs_mmap(&romfs, "dir/table.bin", &buf_p, &size) == 0);
+    BTASSERT(size == 128);
+    BTASSERT(((uintptr_t)buf_p % 4) == 0);
+    table_p = buf_p;
+
+    for (i = 0; i < 64; i++) {
+        BTASSERT(table_p[i] == i * i);
+    }
+
+    BTASSERT(romfs_mmap(&romfs, "missing", &buf_p, &size) == -ENOENT);
+
+    return (0);
+}
+
+static int test_fs(void)
+{
+    static struct fs_filesystem_t filesystem;
+    struct fs_file_t file;
+    struct fs_file_t file2;
+    struct fs_file_t file3;
+    struct fs_stat_t stat;
+    const void *buf_p;
+    size_t size;
+    char buf[16];
+
+    BTASSERT(fs_filesystem_init_generic(&filesystem,
+                                        "/rom",
+                                        &romfs.ops) == 0);
+    BTASSERT(fs_filesystem_register(&filesystem) == 0);
+
+    BTASSERT(fs_mmap("/rom/hello.txt", &buf_p, &size) == 0);
+    BTASSERT(buf_p == romfs_files[2].buf_p);
+    BTASSERT(size == 13);
+    BTASSERT(fs_mmap("/rom/missing", &buf_p, &size) != 0);
+
+    BTASSERT(fs_stat("/rom/dir/table.bin", &stat) == 0);
+    BTASSERT(stat.type == FS_TYPE_FILE);
+    BTASSERT(stat.size == 128);
+
+    /* Read-only. */
+    BTASSERT(fs_open(&file, "/rom/hello.txt", FS_WRITE) != 0);
+    BTASSERT(fs_open(&file, "/rom/missing", FS_READ) != 0);
+
+    BTASSERT(fs_open(&file, "/rom/hello.txt", FS_READ) == 0);
+    BTASSERT(fs_read(&file, &buf[0], 5) == 5);
+    BTASSERT(memcmp(&buf[0], "Hello", 5) == 0);
+    BTASSERT(fs_tell(&file) == 5);
+    BTASSERT(fs_seek(&file, -2, FS_SEEK_END) == 0);
+    BTASSERT(fs_read(&file, &buf[0], sizeof(buf)) == 2);
+    BTASSERT(memcmp(&buf[0], "!\n", 2) == 0);
+    BTASSERT(fs_read(&file, &buf[0], sizeof(buf)) == 0);
+    BTASSERT(fs_seek(&file, 14, FS_SEEK_SET) != 0);
+    BTASSERT(fs_write(&file, "a", 1) != 1);
+
+    /* All files in the pool are in use. */
+    BTASSERT(fs_open(&file2, "/rom/empty.txt", FS_READ) == 0);
+    BTASSERT(fs_read(&file2, &buf[0], sizeof(buf)) == 0);
+    BTASSERT(fs_open(&file3, "/rom/empty.txt", FS_READ) != 0);
+    BTASSERT(fs_close(&file2) == 0);
+    BTASSERT(fs_close(&file) == 0);
+
+    return (0);
+}
+
+int main()
+{
+    struct harness_testcase_t testcases[] = {
+        { test_init, "test_init" },
+        { test_find, "test_find" },
+        { test_mmap, "test_mmap" },
+        { test_fs, "test_fs" },
+        { NULL, NULL }
+    };
+
+    sys_start();
+
+    harness_run(testcases);
+
+    return (0);
+}
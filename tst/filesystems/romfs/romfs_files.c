@@ -0,0 +1,45 @@
+/**
+ * This file was generated by romfs.py. Do not edit.
+ */
+
+#include "simba.h"
+
+static const uint8_t file_0[] __attribute__ ((aligned (4))) = {
+    0x00, 0x00, 0x01, 0x00, 0x04, 0x00, 0x09, 0x00, 0x10, 0x00, 0x19, 0x00,
+    0x24, 0x00, 0x31, 0x00, 0x40, 0x00, 0x51, 0x00, 0x64, 0x00, 0x79, 0x00,
+    0x90, 0x00, 0xa9, 0x00, 0xc4, 0x00, 0xe1, 0x00, 0x00, 0x01, 0x21, 0x01,
+    0x44, 0x01, 0x69, 0x01, 0x90, 0x01, 0xb9, 0x01, 0xe4, 0x01, 0x11, 0x02,
+    0x40, 0x02, 0x71, 0x02, 0xa4, 0x02, 0xd9, 0x02, 0x10, 0x03, 0x49, 0x03,
+    0x84, 0x03, 0xc1, 0x03, 0x00, 0x04, 0x41, 0x04, 0x84, 0x04, 0xc9, 0x04,
+    0x10, 0x05, 0x59, 0x05, 0xa4, 0x05, 0xf1, 0x05, 0x40, 0x06, 0x91, 0x06,
+    0xe4, 0x06, 0x39, 0x07, 0x90, 0x07, 0xe9, 0x07, 0x44, 0x08, 0xa1, 0x08,
+    0x00, 0x09, 0x61, 0x09, 0xc4, 0x09, 0x29, 0x0a, 0x90, 0x0a, 0xf9, 0x0a,
+    0x64, 0x0b, 0xd1, 0x0b, 0x40, 0x0c, 0xb1, 0x0c, 0x24, 0x0d, 0x99, 0x0d,
+    0x10, 0x0e, 0x89, 0x0e, 0x04, 0x0f, 0x81, 0x0f,
+};
+
+static const uint8_t file_2[] __attribute__ ((aligned (4))) = {
+    0x48, 0x65, 0x6c, 0x6c, 0x6f, 0x20, 0x77, 0x6f, 0x72, 0x6c, 0x64, 0x21,
+    0x0a,
+};
+
+const struct romfs_file_t romfs_files[] = {
+    {
+        .path_p = "dir/table.bin",
+        .buf_p = file_0,
+        .size = 128
+    },
+    {
+        .path_p = "empty.txt",
+        .buf_p = NULL,
+        .size = 0
+    },
+    {
+        .path_p = "hello.txt",
+        .buf_p = file_2,
+        .size = 13
+    },
+    {
+        .path_p = NULL
+    }
+};
@@ -371,6 +371,48 @@ static int test_read_write_performance(void)
     return (0);
 }
 
+static int test_gc_thread(void)
+{
+    static THRD_STACK(stack, 1024);
+    static char buf[256];
+    spiffs_file fd;
+    size_t i;
+    uint32_t gc_runs;
+    uint32_t free_blocks;
+
+    BTASSERT(spiffs_gc_thread_start(&fs, stack, sizeof(stack)) == 0);
+    BTASSERT(spiffs_gc_thread_start(&fs, stack, sizeof(stack)) == -EBUSY);
+
+    /* Write and delete a file larger than a block. */
+    fd = spiffs_open(&fs,
+                     "gc.txt",
+                     SPIFFS_CREAT | SPIFFS_TRUNC | SPIFFS_RDWR,
+                     0);
+    BTASSERT(fd >= 0);
+
+    for (i = 0; i < 2 * LOG_BLOCK_SIZE; i += sizeof(buf)) {
+        BTASSERT(spiffs_write(&fs, fd, buf, sizeof(buf)) == sizeof(buf));
+    }
+
+    BTASSERT(spiffs_close(&fs, fd) == 0);
+    BTASSERT(spiffs_remove(&fs, "gc.txt") == 0);
+
+    /* The garbage collector erases the deleted blocks when the file
+       system is idle. */
+    gc_runs = fs.stats_gc_runs;
+    free_blocks = fs.free_blocks;
+    thrd_sleep_ms(5 * CONFIG_SPIFFS_GC_THREAD_IDLE_MS);
+    BTASSERT(fs.stats_gc_runs > gc_runs);
+    BTASSERT(fs.free_blocks > free_blocks);
+
+    strcpy(buf, "/filesystems/spiffs/gc/runs");
+    BTASSERT(fs_call(buf, NULL, sys_get_stdout(), NULL) == 0);
+    strcpy(buf, "/filesystems/spiffs/cache/hits");
+    BTASSERT(fs_call(buf, NULL, sys_get_stdout(), NULL) == 0);
+
+    return (0);
+}
+
 int main()
 {
     struct harness_testcase_t testcases[] = {
@@ -378,6 +420,7 @@ int main()
         { test_format, "test_format" },
         { test_read_write, "test_read_write" },
         { test_read_write_performance, "test_read_write_performance" },
+        { test_gc_thread, "test_gc_thread" },
         { NULL, NULL }
     };
 
@@ -42,6 +42,93 @@ static int test_crc_32(void)
     return (0);
 }
 
+/**
+ * Bitwise crc 32 reference implementation.
+ */
+static uint32_t reference_crc_32(uint32_t crc,
+                                 const uint8_t *buf_p,
+                                 size_t size)
+{
+    size_t i;
+    int j;
+
+    crc ^= 0xffffffff;
+
+    for (i = 0; i < size; i++) {
+        crc ^= buf_p[i];
+
+        for (j = 0; j < 8; j++) {
+            crc = (crc >> 1) ^ (0xedb88320 & (-(crc & 1)));
+        }
+    }
+
+    return (~crc);
+}
+
+static int test_crc_32_sizes(void)
+{
+    uint8_t buf[80];
+    size_t offset;
+    size_t size;
+    size_t i;
+
+    for (i = 0; i < sizeof(buf); i++) {
+        buf[i] = (i * 37 + 11);
+    }
+
+    /* All alignments and sizes around the slice sizes. */
+    for (offset = 0; offset < 8; offset++) {
+        for (size = 0; size <= sizeof(buf) - offset; size++) {
+            BTASSERTI(crc_32(0x12345678, &buf[offset], size),
+                      ==,
+                      reference_crc_32(0x12345678, &buf[offset], size));
+        }
+    }
+
+    return (0);
+}
+
+static int test_crc_32_benchmark(void)
+{
+    static uint8_t buf[1024];
+    struct time_t start;
+    struct time_t stop;
+    uint32_t crc;
+    uint32_t expected_crc;
+    int i;
+    unsigned long us;
+
+    memset(&buf[0], 0xa5, sizeof(buf));
+    crc = 0;
+
+    time_get(&start);
+
+    for (i = 0; i < 256; i++) {
+        crc = crc_32(crc, &buf[0], sizeof(buf));
+    }
+
+    time_get(&stop);
+    time_subtract(&stop, &stop, &start);
+    us = (stop.seconds * 1000000 + stop.nanoseconds / 1000);
+
+    std_printf(OSTR("crc_32() of 256 kB took %lu us (%d slices, "
+                    "hardware %d), crc 0x%08lx.\r\n"),
+               us,
+               CONFIG_CRC_32_SLICES,
+               CONFIG_CRC_HARDWARE,
+               (unsigned long)crc);
+
+    expected_crc = 0;
+
+    for (i = 0; i < 256; i++) {
+        expected_crc = reference_crc_32(expected_crc, &buf[0], sizeof(buf));
+    }
+
+    BTASSERTI(crc, ==, expected_crc);
+
+    return (0);
+}
+
 static int test_crc_ccitt(void)
 {
     uint16_t crc;
@@ -101,6 +188,8 @@ int main()
 {
     struct harness_testcase_t testcases[] = {
         { test_crc_32, "test_crc_32" },
+        { test_crc_32_sizes, "test_crc_32_sizes" },
+        { test_crc_32_benchmark, "test_crc_32_benchmark" },
         { test_crc_ccitt, "test_crc_ccitt" },
         { test_crc_xmodem, "test_crc_xmodem" },
         { test_crc_7, "test_crc_7" },
@@ -0,0 +1,146 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2014-2018, Erik Moqvist
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use, copy,
+ * modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ * This file is part of the Simba project.
+ */
+
+#include "simba.h"
+
+static int test_crc_32(void)
+{
+    uint32_t crc;
+    char string[] = "The quick brown fox jumps over the lazy dog";
+
+    BTASSERT(crc_32(0, string, strlen(string)) == 0x414fa339);
+
+    crc = crc_32(0, string, 10);
+    BTASSERT(crc == 0xa3ec1434);
+    BTASSERT(crc_32(crc, &string[10], strlen(string) - 10) == 0x414fa339);
+
+    return (0);
+}
+
+/**
+ * Bitwise crc 32 reference implementation.
+ */
+static uint32_t reference_crc_32(uint32_t crc,
+                                 const uint8_t *buf_p,
+                                 size_t size)
+{
+    size_t i;
+    int j;
+
+    crc ^= 0xffffffff;
+
+    for (i = 0; i < size; i++) {
+        crc ^= buf_p[i];
+
+        for (j = 0; j < 8; j++) {
+            crc = (crc >> 1) ^ (0xedb88320 & (-(crc & 1)));
+        }
+    }
+
+    return (~crc);
+}
+
+static int test_crc_32_sizes(void)
+{
+    uint8_t buf[80];
+    size_t offset;
+    size_t size;
+    size_t i;
+
+    for (i = 0; i < sizeof(buf); i++) {
+        buf[i] = (i * 37 + 11);
+    }
+
+    /* All alignments and sizes around the slice sizes. */
+    for (offset = 0; offset < 8; offset++) {
+        for (size = 0; size <= sizeof(buf) - offset; size++) {
+            BTASSERTI(crc_32(0x12345678, &buf[offset], size),
+                      ==,
+                      reference_crc_32(0x12345678, &buf[offset], size));
+        }
+    }
+
+    return (0);
+}
+
+static int test_crc_32_benchmark(void)
+{
+    static uint8_t buf[1024];
+    struct time_t start;
+    struct time_t stop;
+    uint32_t crc;
+    uint32_t expected_crc;
+    int i;
+    unsigned long us;
+
+    memset(&buf[0], 0xa5, sizeof(buf));
+    crc = 0;
+
+    time_get(&start);
+
+    for (i = 0; i < 256; i++) {
+        crc = crc_32(crc, &buf[0], sizeof(buf));
+    }
+
+    time_get(&stop);
+    time_subtract(&stop, &stop, &start);
+    us = (stop.seconds * 1000000 + stop.nanoseconds / 1000);
+
+    std_printf(OSTR("crc_32() of 256 kB took %lu us (%d slices, "
+                    "hardware %d), crc 0x%08lx.\r\n"),
+               us,
+               CONFIG_CRC_32_SLICES,
+               CONFIG_CRC_HARDWARE,
+               (unsigned long)crc);
+
+    expected_crc = 0;
+
+    for (i = 0; i < 256; i++) {
+        expected_crc = reference_crc_32(expected_crc, &buf[0], sizeof(buf));
+    }
+
+    BTASSERTI(crc, ==, expected_crc);
+
+    return (0);
+}
+
+int main()
+{
+    struct harness_testcase_t testcases[] = {
+        { test_crc_32, "test_crc_32" },
+        { test_crc_32_sizes, "test_crc_32_sizes" },
+        { test_crc_32_benchmark, "test_crc_32_benchmark" },
+        { NULL, NULL }
+    };
+
+    sys_start();
+
+    harness_run(testcases);
+
+    return (0);
+}
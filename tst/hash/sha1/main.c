@@ -116,10 +116,38 @@ int test_sha1(void)
     return (0);
 }
 
+int test_unaligned(void)
+{
+    struct sha1_t foo;
+    uint8_t hash[20];
+    uint8_t buf[201];
+    int i;
+
+    for (i = 0; i < 200; i++) {
+        buf[i + 1] = i;
+    }
+
+    /* Complete blocks are hashed directly from the unaligned input
+       buffer. */
+    BTASSERT(sha1_init(&foo) == 0);
+    BTASSERT(sha1_update(&foo, &buf[1], 7) == 0);
+    BTASSERT(sha1_update(&foo, &buf[8], 64) == 0);
+    BTASSERT(sha1_update(&foo, &buf[72], 129) == 0);
+    BTASSERT(sha1_digest(&foo, hash) == 0);
+
+    BTASSERT(memcmp(hash,
+                    "\x54\xd1\x1e\x99\x12\x7d\x15\x97\x99\xdb"
+                    "\xce\x10\xf5\x1a\x75\xe6\x97\x78\x04\x78",
+                    20) == 0);
+
+    return (0);
+}
+
 int main()
 {
     struct harness_testcase_t testcases[] = {
         { test_sha1, "test_sha1" },
+        { test_unaligned, "test_unaligned" },
         { NULL, NULL }
     };
 
@@ -0,0 +1,223 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2018, Erik Moqvist
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use, copy,
+ * modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ * This file is part of the Simba project.
+ */
+
+#include "simba.h"
+
+int test_sha256(void)
+{
+    struct sha256_t foo;
+    uint8_t hash[32];
+    int i;
+    struct {
+        char *name_p;
+        char *input_p;
+        char *hash_p;
+    } testdata[] = {
+        {
+            .name_p = "Empty",
+            .input_p = "",
+            .hash_p =
+            "\xe3\xb0\xc4\x42\x98\xfc\x1c\x14\x9a\xfb\xf4\xc8\x99\x6f\xb9\x24"
+            "\x27\xae\x41\xe4\x64\x9b\x93\x4c\xa4\x95\x99\x1b\x78\x52\xb8\x55"
+        },
+        {
+            .name_p = "Abc",
+            .input_p = "abc",
+            .hash_p =
+            "\xba\x78\x16\xbf\x8f\x01\xcf\xea\x41\x41\x40\xde\x5d\xae\x22\x23"
+            "\xb0\x03\x61\xa3\x96\x17\x7a\x9c\xb4\x10\xff\x61\xf2\x00\x15\xad"
+        },
+        {
+            .name_p = "Dog",
+            .input_p = "The quick brown fox jumps over the lazy dog",
+            .hash_p =
+            "\xd7\xa8\xfb\xb3\x07\xd7\x80\x94\x69\xca\x9a\xbc\xb0\x08\x2e\x4f"
+            "\x8d\x56\x51\xe4\x6d\x3c\xdb\x76\x2d\x02\xd0\xbf\x37\xc9\xe5\x92"
+        },
+        {
+            .name_p = "55",
+            .input_p =
+            "aaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaa",
+            .hash_p =
+            "\x9f\x43\x90\xf8\xd3\x0c\x2d\xd9\x2e\xc9\xf0\x95\xb6\x5e\x2b\x9a"
+            "\xe9\xb0\xa9\x25\xa5\x25\x8e\x24\x1c\x9f\x1e\x91\x0f\x73\x43\x18"
+        },
+        {
+            .name_p = "56",
+            .input_p =
+            "aaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaa",
+            .hash_p =
+            "\xb3\x54\x39\xa4\xac\x6f\x09\x48\xb6\xd6\xf9\xe3\xc6\xaf\x0f\x5f"
+            "\x59\x0c\xe2\x0f\x1b\xde\x70\x90\xef\x79\x70\x68\x6e\xc6\x73\x8a"
+        },
+        {
+            .name_p = "64",
+            .input_p =
+            "aaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaa"
+            "aaaa",
+            .hash_p =
+            "\xff\xe0\x54\xfe\x7a\xe0\xcb\x6d\xc6\x5c\x3a\xf9\xb6\x1d\x52\x09"
+            "\xf4\x39\x85\x1d\xb4\x3d\x0b\xa5\x99\x73\x37\xdf\x15\x46\x68\xeb"
+        },
+        {
+            .name_p = "Long",
+            .input_p =
+            "abcdbcdecdefdefgefghfghighijhijkijkljklmklmnlmnomnopnopq",
+            .hash_p =
+            "\x24\x8d\x6a\x61\xd2\x06\x38\xb8\xe5\xc0\x26\x93\x0c\x3e\x60\x39"
+            "\xa3\x3c\xe4\x59\x64\xff\x21\x67\xf6\xec\xed\xd4\x19\xdb\x06\xc1"
+        }
+    };
+
+    /* Test vectors. */
+    for (i = 0; i < membersof(testdata); i++) {
+        std_printf(FSTR("%s\r\n"), testdata[i].name_p);
+
+        BTASSERT(sha256_init(&foo) == 0);
+        BTASSERT(sha256_update(&foo,
+                               testdata[i].input_p,
+                               strlen(testdata[i].input_p)) == 0);
+        BTASSERT(sha256_digest(&foo, hash) == 0);
+
+        BTASSERT(memcmp(hash, testdata[i].hash_p, 32) == 0);
+    }
+
+    /* Multiple updates. */
+    BTASSERT(sha256_init(&foo) == 0);
+
+    for (i = 0; i < 400; i++) {
+        BTASSERT(sha256_update(&foo, "1", 1) == 0);
+    }
+
+    BTASSERT(sha256_digest(&foo, hash) == 0);
+
+    BTASSERT(memcmp(hash,
+                    "\xb1\x25\x47\xda\x74\xee\x44\xf5"
+                    "\xba\x82\x9a\x26\xda\xe1\x03\x55"
+                    "\xc7\x61\xee\x17\xe9\x3f\x0c\xb1"
+                    "\xd3\xfc\x5c\xc0\x84\x03\xec\x58",
+                    32) == 0);
+
+    return (0);
+}
+
+int test_unaligned(void)
+{
+    struct sha256_t foo;
+    uint8_t hash[32];
+    uint8_t buf[201];
+    int i;
+
+    for (i = 0; i < 200; i++) {
+        buf[i + 1] = i;
+    }
+
+    /* Complete blocks are hashed directly from the unaligned input
+       buffer. */
+    BTASSERT(sha256_init(&foo) == 0);
+    BTASSERT(sha256_update(&foo, &buf[1], 7) == 0);
+    BTASSERT(sha256_update(&foo, &buf[8], 64) == 0);
+    BTASSERT(sha256_update(&foo, &buf[72], 129) == 0);
+    BTASSERT(sha256_digest(&foo, hash) == 0);
+
+    BTASSERT(memcmp(hash,
+                    "\x19\x01\xda\x1c\x9f\x69\x9b\x48"
+                    "\xf6\xb2\x63\x6e\x65\xcb\xf7\x3a"
+                    "\xbf\x99\xd0\x44\x1e\xf6\x7f\x5c"
+                    "\x54\x0a\x42\xf7\x05\x1d\xec\x6f",
+                    32) == 0);
+
+    return (0);
+}
+
+int test_hmac(void)
+{
+    struct sha256_hmac_t foo;
+    uint8_t hmac[32];
+    uint8_t key[131];
+
+    /* RFC 4231, test case 1. */
+    memset(&key[0], 0x0b, 20);
+    BTASSERT(sha256_hmac_init(&foo, &key[0], 20) == 0);
+    BTASSERT(sha256_hmac_update(&foo, "Hi There", 8) == 0);
+    BTASSERT(sha256_hmac_digest(&foo, &hmac[0]) == 0);
+
+    BTASSERT(memcmp(hmac,
+                    "\xb0\x34\x4c\x61\xd8\xdb\x38\x53"
+                    "\x5c\xa8\xaf\xce\xaf\x0b\xf1\x2b"
+                    "\x88\x1d\xc2\x00\xc9\x83\x3d\xa7"
+                    "\x26\xe9\x37\x6c\x2e\x32\xcf\xf7",
+                    32) == 0);
+
+    /* RFC 4231, test case 2, data given in two parts. */
+    BTASSERT(sha256_hmac_init(&foo, "Jefe", 4) == 0);
+    BTASSERT(sha256_hmac_update(&foo, "what do ya want ", 16) == 0);
+    BTASSERT(sha256_hmac_update(&foo, "for nothing?", 12) == 0);
+    BTASSERT(sha256_hmac_digest(&foo, &hmac[0]) == 0);
+
+    BTASSERT(memcmp(hmac,
+                    "\x5b\xdc\xc1\x46\xbf\x60\x75\x4e"
+                    "\x6a\x04\x24\x26\x08\x95\x75\xc7"
+                    "\x5a\x00\x3f\x08\x9d\x27\x39\x83"
+                    "\x9d\xec\x58\xb9\x64\xec\x38\x43",
+                    32) == 0);
+
+    /* RFC 4231, test case 6, key longer than the block size. */
+    memset(&key[0], 0xaa, sizeof(key));
+    BTASSERT(sha256_hmac_init(&foo, &key[0], sizeof(key)) == 0);
+    BTASSERT(sha256_hmac_update(
+                 &foo,
+                 "Test Using Larger Than Block-Size Key - Hash Key First",
+                 54) == 0);
+    BTASSERT(sha256_hmac_digest(&foo, &hmac[0]) == 0);
+
+    BTASSERT(memcmp(hmac,
+                    "\x60\xe4\x31\x59\x1e\xe0\xb6\x7f"
+                    "\x0d\x8a\x26\xaa\xcb\xf5\xb7\x7f"
+                    "\x8e\x0b\xc6\x21\x37\x28\xc5\x14"
+                    "\x05\x46\x04\x0f\x0e\xe3\x7f\x54",
+                    32) == 0);
+
+    return (0);
+}
+
+int main()
+{
+    struct harness_testcase_t testcases[] = {
+        { test_sha256, "test_sha256" },
+        { test_unaligned, "test_unaligned" },
+        { test_hmac, "test_hmac" },
+        { NULL, NULL }
+    };
+
+    sys_start();
+
+    harness_run(testcases);
+
+    return (0);
+}
@@ -0,0 +1,218 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2014-2018, Erik Moqvist
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use, copy,
+ * modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ * This file is part of the Simba project.
+ */
+
+#include "simba.h"
+
+static int test_encode_decode(void)
+{
+    struct coap_encoder_t encoder;
+    struct coap_message_t message;
+    uint8_t buf[64];
+    char path[32];
+    uint32_t value;
+    ssize_t size;
+
+    BTASSERT(coap_encoder_init(&encoder,
+                               &buf[0],
+                               sizeof(buf),
+                               COAP_TYPE_CONFIRMABLE,
+                               COAP_CODE_GET,
+                               0x1234,
+                               (uint8_t *)"\xab\xcd",
+                               2) == 0);
+    BTASSERT(coap_encoder_add_uint_option(&encoder,
+                                          COAP_OPTION_OBSERVE,
+                                          0) == 0);
+    BTASSERT(coap_encoder_add_path(&encoder, "/sensors/temp") == 0);
+    BTASSERT(coap_encoder_add_uint_option(&encoder,
+                                          COAP_OPTION_BLOCK2,
+                                          COAP_BLOCK(1, 0, 2)) == 0);
+    BTASSERT(coap_encoder_add_payload(&encoder, "hi", 2) == 0);
+    size = coap_encoder_get_size(&encoder);
+    BTASSERT(size == 25);
+    BTASSERT(memcmp(&buf[0],
+                    "\x42\x01\x12\x34\xab\xcd"
+                    "\x60"
+                    "\x57" "sensors"
+                    "\x04" "temp"
+                    "\xc1\x12"
+                    "\xff" "hi",
+                    size) == 0);
+
+    /* Options are not allowed after the payload, or out of order. */
+    BTASSERT(coap_encoder_add_uint_option(&encoder,
+                                          COAP_OPTION_SIZE2,
+                                          1) == -EINVAL);
+
+    BTASSERT(coap_message_decode(&message, &buf[0], size) == 0);
+    BTASSERT(message.type == COAP_TYPE_CONFIRMABLE);
+    BTASSERT(message.code == COAP_CODE_GET);
+    BTASSERT(message.message_id == 0x1234);
+    BTASSERT(message.token_size == 2);
+    BTASSERT(memcmp(&message.token[0], "\xab\xcd", 2) == 0);
+    BTASSERT(message.options.length == 4);
+    BTASSERT(message.payload_size == 2);
+    BTASSERT(memcmp(message.payload_p, "hi", 2) == 0);
+    BTASSERT(coap_message_get_uint_option(&message,
+                                          COAP_OPTION_OBSERVE,
+                                          &value) == 0);
+    BTASSERT(value == 0);
+    BTASSERT(coap_message_get_uint_option(&message,
+                                          COAP_OPTION_BLOCK2,
+                                          &value) == 0);
+    BTASSERT(COAP_BLOCK_NUM(value) == 1);
+    BTASSERT(COAP_BLOCK_MORE(value) == 0);
+    BTASSERT(COAP_BLOCK_SIZE(COAP_BLOCK_SZX(value)) == 64);
+    BTASSERT(coap_message_get_uint_option(&message,
+                                          COAP_OPTION_SIZE2,
+                                          &value) == -ENOENT);
+    BTASSERT(coap_message_get_path(&message, &path[0], sizeof(path)) == 13);
+    BTASSERT(strcmp(&path[0], "/sensors/temp") == 0);
+    BTASSERT(coap_message_get_path(&message, &path[0], 13) == -ENOMEM);
+
+    return (0);
+}
+
+static int test_extended_option(void)
+{
+    struct coap_encoder_t encoder;
+    struct coap_message_t message;
+    uint8_t value[300];
+    uint8_t buf[400];
+    char path[2];
+    ssize_t size;
+
+    memset(&value[0], 'a', sizeof(value));
+
+    /* Delta 13 to 268 and length 269 and more use extended bytes. */
+    BTASSERT(coap_encoder_init(&encoder,
+                               &buf[0],
+                               sizeof(buf),
+                               COAP_TYPE_NON_CONFIRMABLE,
+                               COAP_CODE_CONTENT,
+                               1,
+                               NULL,
+                               0) == 0);
+    BTASSERT(coap_encoder_add_option(&encoder, 20, &value[0], 13) == 0);
+    BTASSERT(coap_encoder_add_option(&encoder, 1000, &value[0], 300) == 0);
+    size = coap_encoder_get_size(&encoder);
+    BTASSERT(size == 4 + 3 + 13 + 5 + 300);
+    BTASSERT(memcmp(&buf[4], "\xdd\x07\x00", 3) == 0);
+    BTASSERT(memcmp(&buf[20], "\xee\x02\xc7\x00\x1f", 5) == 0);
+
+    BTASSERT(coap_message_decode(&message, &buf[0], size) == 0);
+    BTASSERT(message.options.length == 2);
+    BTASSERT(message.options.buf[0].number == 20);
+    BTASSERT(message.options.buf[0].size == 13);
+    BTASSERT(message.options.buf[1].number == 1000);
+    BTASSERT(message.options.buf[1].size == 300);
+    BTASSERT(message.payload_size == 0);
+
+    /* No Uri-Path options is the root. */
+    BTASSERT(coap_message_get_path(&message, &path[0], sizeof(path)) == 1);
+    BTASSERT(strcmp(&path[0], "/") == 0);
+
+    /* Too small buffer. */
+    BTASSERT(coap_encoder_init(&encoder,
+                               &buf[0],
+                               8,
+                               COAP_TYPE_NON_CONFIRMABLE,
+                               COAP_CODE_CONTENT,
+                               1,
+                               NULL,
+                               0) == 0);
+    BTASSERT(coap_encoder_add_payload(&encoder, &value[0], 5) == 0);
+    BTASSERT(coap_encoder_get_size(&encoder) == -ENOMEM);
+
+    return (0);
+}
+
+static int test_decode_bad(void)
+{
+    struct coap_message_t message;
+
+    /* Too short. */
+    BTASSERT(coap_message_decode(&message,
+                                 (uint8_t *)"\x40\x01\x00",
+                                 3) == -EBADMSG);
+
+    /* Bad version. */
+    BTASSERT(coap_message_decode(&message,
+                                 (uint8_t *)"\x80\x01\x00\x01",
+                                 4) == -EBADMSG);
+
+    /* Token too long. */
+    BTASSERT(coap_message_decode(&message,
+                                 (uint8_t *)"\x49\x01\x00\x01",
+                                 4) == -EBADMSG);
+
+    /* Payload marker without payload. */
+    BTASSERT(coap_message_decode(&message,
+                                 (uint8_t *)"\x40\x01\x00\x01\xff",
+                                 5) == -EBADMSG);
+
+    /* Option value past the end of the message. */
+    BTASSERT(coap_message_decode(&message,
+                                 (uint8_t *)"\x40\x01\x00\x01\xb4" "ab",
+                                 7) == -EBADMSG);
+
+    /* Reserved delta nibble 15. */
+    BTASSERT(coap_message_decode(&message,
+                                 (uint8_t *)"\x40\x01\x00\x01\xf0",
+                                 5) == -EBADMSG);
+
+    /* Empty message with a token. */
+    BTASSERT(coap_message_decode(&message,
+                                 (uint8_t *)"\x41\x00\x00\x01\x12",
+                                 5) == -EBADMSG);
+
+    /* An empty message. */
+    BTASSERT(coap_message_decode(&message,
+                                 (uint8_t *)"\x60\x00\x00\x01",
+                                 4) == 0);
+    BTASSERT(message.type == COAP_TYPE_ACKNOWLEDGEMENT);
+    BTASSERT(message.code == COAP_CODE_EMPTY);
+
+    return (0);
+}
+
+int main()
+{
+    struct harness_testcase_t testcases[] = {
+        { test_encode_decode, "test_encode_decode" },
+        { test_extended_option, "test_extended_option" },
+        { test_decode_bad, "test_decode_bad" },
+        { NULL, NULL }
+    };
+
+    sys_start();
+
+    harness_run(testcases);
+
+    return (0);
+}
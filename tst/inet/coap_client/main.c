@@ -0,0 +1,538 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2014-2018, Erik Moqvist
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use, copy,
+ * modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ * This file is part of the Simba project.
+ */
+
+#include "simba.h"
+
+extern void socket_stub_init(void);
+extern void socket_stub_input(const void *buf_p, size_t size);
+extern ssize_t socket_stub_output(void *buf_p, size_t size);
+
+static struct coap_client_t client;
+static uint8_t outbuf[512];
+
+/**
+ * Queue a message sent by the server to the client.
+ */
+static int respond(int type,
+                   int code,
+                   uint16_t message_id,
+                   uint16_t token,
+                   int observe,
+                   int32_t block,
+                   const void *payload_p,
+                   size_t payload_size)
+{
+    struct coap_encoder_t encoder;
+    uint8_t buf[128];
+    uint8_t token_buf[2];
+    ssize_t size;
+
+    token_buf[0] = (token >> 8);
+    token_buf[1] = token;
+
+    BTASSERT(coap_encoder_init(&encoder,
+                               &buf[0],
+                               sizeof(buf),
+                               type,
+                               code,
+                               message_id,
+                               &token_buf[0],
+                               code == COAP_CODE_EMPTY ? 0 : 2) == 0);
+
+    if (observe >= 0) {
+        BTASSERT(coap_encoder_add_uint_option(&encoder,
+                                              COAP_OPTION_OBSERVE,
+                                              observe) == 0);
+    }
+
+    if (block >= 0) {
+        BTASSERT(coap_encoder_add_uint_option(&encoder,
+                                              COAP_OPTION_BLOCK2,
+                                              block) == 0);
+    }
+
+    BTASSERT(coap_encoder_add_payload(&encoder,
+                                      payload_p,
+                                      payload_size) == 0);
+    size = coap_encoder_get_size(&encoder);
+    BTASSERT(size > 0);
+    socket_stub_input(&buf[0], size);
+
+    return (0);
+}
+
+/**
+ * Read and decode the next message sent by the client.
+ */
+static int sent(struct coap_message_t *message_p)
+{
+    ssize_t size;
+
+    size = socket_stub_output(&outbuf[0], sizeof(outbuf));
+    BTASSERT(size > 0);
+    BTASSERT(coap_message_decode(message_p, &outbuf[0], size) == 0);
+
+    return (0);
+}
+
+/**
+ * Read the next request sent by the client and check its header and
+ * path.
+ */
+static int sent_request(int type,
+                        int code,
+                        uint16_t message_id,
+                        uint16_t token,
+                        const char *path_p,
+                        struct coap_message_t *message_p)
+{
+    char path[32];
+
+    BTASSERT(sent(message_p) == 0);
+    BTASSERT(message_p->type == type);
+    BTASSERT(message_p->code == code);
+    BTASSERT(message_p->message_id == message_id);
+    BTASSERT(message_p->token_size == 2);
+    BTASSERT(message_p->token[0] == (token >> 8));
+    BTASSERT(message_p->token[1] == (token & 0xff));
+    BTASSERT(coap_message_get_path(message_p, &path[0], sizeof(path)) > 0);
+    BTASSERT(strcmp(&path[0], path_p) == 0);
+
+    return (0);
+}
+
+static int test_start(void)
+{
+    struct inet_addr_t addr;
+
+    socket_stub_init();
+
+    BTASSERT(inet_aton("1.2.3.4", &addr.ip) == 0);
+    addr.port = 5683;
+
+    BTASSERT(coap_client_init(&client, &addr) == 0);
+    BTASSERT(coap_client_start(&client) == 0);
+
+    return (0);
+}
+
+static int test_request(void)
+{
+    struct coap_message_t message;
+    char buf[16];
+    int code;
+
+    /* Piggybacked response. */
+    BTASSERT(respond(COAP_TYPE_ACKNOWLEDGEMENT,
+                     COAP_CODE_CONTENT,
+                     0,
+                     0x0000,
+                     -1,
+                     -1,
+                     "21",
+                     2) == 0);
+    BTASSERT(coap_client_request(&client,
+                                 COAP_TYPE_CONFIRMABLE,
+                                 COAP_CODE_GET,
+                                 "/temp",
+                                 NULL,
+                                 0,
+                                 &buf[0],
+                                 sizeof(buf),
+                                 &code) == 2);
+    BTASSERT(code == COAP_CODE_CONTENT);
+    BTASSERT(memcmp(&buf[0], "21", 2) == 0);
+    BTASSERT(sent_request(COAP_TYPE_CONFIRMABLE,
+                          COAP_CODE_GET,
+                          0,
+                          0x0000,
+                          "/temp",
+                          &message) == 0);
+    BTASSERT(socket_stub_output(&outbuf[0], sizeof(outbuf)) == -1);
+
+    /* Separate response. */
+    BTASSERT(respond(COAP_TYPE_ACKNOWLEDGEMENT,
+                     COAP_CODE_EMPTY,
+                     1,
+                     0,
+                     -1,
+                     -1,
+                     NULL,
+                     0) == 0);
+    BTASSERT(respond(COAP_TYPE_CONFIRMABLE,
+                     COAP_CODE_CHANGED,
+                     0x7000,
+                     0x0001,
+                     -1,
+                     -1,
+                     "ok",
+                     2) == 0);
+    BTASSERT(coap_client_request(&client,
+                                 COAP_TYPE_CONFIRMABLE,
+                                 COAP_CODE_PUT,
+                                 "/led",
+                                 "on",
+                                 2,
+                                 &buf[0],
+                                 sizeof(buf),
+                                 &code) == 2);
+    BTASSERT(code == COAP_CODE_CHANGED);
+    BTASSERT(memcmp(&buf[0], "ok", 2) == 0);
+    BTASSERT(sent_request(COAP_TYPE_CONFIRMABLE,
+                          COAP_CODE_PUT,
+                          1,
+                          0x0001,
+                          "/led",
+                          &message) == 0);
+    BTASSERT(message.payload_size == 2);
+    BTASSERT(memcmp(message.payload_p, "on", 2) == 0);
+    BTASSERT(sent(&message) == 0);
+    BTASSERT(message.type == COAP_TYPE_ACKNOWLEDGEMENT);
+    BTASSERT(message.code == COAP_CODE_EMPTY);
+    BTASSERT(message.message_id == 0x7000);
+
+    /* Non-confirmable request and response. */
+    BTASSERT(respond(COAP_TYPE_NON_CONFIRMABLE,
+                     COAP_CODE_CONTENT,
+                     0x7001,
+                     0x0002,
+                     -1,
+                     -1,
+                     "22",
+                     2) == 0);
+    BTASSERT(coap_client_request(&client,
+                                 COAP_TYPE_NON_CONFIRMABLE,
+                                 COAP_CODE_GET,
+                                 "/temp",
+                                 NULL,
+                                 0,
+                                 &buf[0],
+                                 sizeof(buf),
+                                 &code) == 2);
+    BTASSERT(code == COAP_CODE_CONTENT);
+    BTASSERT(memcmp(&buf[0], "22", 2) == 0);
+    BTASSERT(sent_request(COAP_TYPE_NON_CONFIRMABLE,
+                          COAP_CODE_GET,
+                          2,
+                          0x0002,
+                          "/temp",
+                          &message) == 0);
+    BTASSERT(socket_stub_output(&outbuf[0], sizeof(outbuf)) == -1);
+
+    return (0);
+}
+
+static int test_timeout(void)
+{
+    struct coap_message_t message;
+    char buf[16];
+    int code;
+    int i;
+
+    BTASSERT(coap_client_request(&client,
+                                 COAP_TYPE_CONFIRMABLE,
+                                 COAP_CODE_GET,
+                                 "/temp",
+                                 NULL,
+                                 0,
+                                 &buf[0],
+                                 sizeof(buf),
+                                 &code) == -ETIMEDOUT);
+
+    /* The request and all its retransmissions. */
+    for (i = 0; i < CONFIG_COAP_CLIENT_MAX_RETRANSMIT + 1; i++) {
+        BTASSERT(sent_request(COAP_TYPE_CONFIRMABLE,
+                              COAP_CODE_GET,
+                              3,
+                              0x0003,
+                              "/temp",
+                              &message) == 0);
+    }
+
+    BTASSERT(socket_stub_output(&outbuf[0], sizeof(outbuf)) == -1);
+
+    /* Reset by the server. */
+    BTASSERT(respond(COAP_TYPE_RESET,
+                     COAP_CODE_EMPTY,
+                     4,
+                     0,
+                     -1,
+                     -1,
+                     NULL,
+                     0) == 0);
+    BTASSERT(coap_client_request(&client,
+                                 COAP_TYPE_CONFIRMABLE,
+                                 COAP_CODE_GET,
+                                 "/temp",
+                                 NULL,
+                                 0,
+                                 &buf[0],
+                                 sizeof(buf),
+                                 &code) == -ECONNRESET);
+    BTASSERT(sent_request(COAP_TYPE_CONFIRMABLE,
+                          COAP_CODE_GET,
+                          4,
+                          0x0004,
+                          "/temp",
+                          &message) == 0);
+
+    return (0);
+}
+
+static int test_block2(void)
+{
+    struct coap_message_t message;
+    uint8_t payload[64];
+    uint8_t buf[128];
+    uint32_t value;
+    int code;
+    int i;
+
+    for (i = 0; i < sizeof(payload); i++) {
+        payload[i] = i;
+    }
+
+    BTASSERT(respond(COAP_TYPE_ACKNOWLEDGEMENT,
+                     COAP_CODE_CONTENT,
+                     5,
+                     0x0005,
+                     -1,
+                     COAP_BLOCK(0, 1, 2),
+                     &payload[0],
+                     64) == 0);
+    BTASSERT(respond(COAP_TYPE_ACKNOWLEDGEMENT,
+                     COAP_CODE_CONTENT,
+                     6,
+                     0x0005,
+                     -1,
+                     COAP_BLOCK(1, 0, 2),
+                     &payload[0],
+                     10) == 0);
+    BTASSERT(coap_client_request(&client,
+                                 COAP_TYPE_CONFIRMABLE,
+                                 COAP_CODE_GET,
+                                 "/big",
+                                 NULL,
+                                 0,
+                                 &buf[0],
+                                 sizeof(buf),
+                                 &code) == 74);
+    BTASSERT(code == COAP_CODE_CONTENT);
+    BTASSERT(buf[63] == 63);
+    BTASSERT(buf[64] == 0);
+    BTASSERT(buf[73] == 9);
+
+    BTASSERT(sent_request(COAP_TYPE_CONFIRMABLE,
+                          COAP_CODE_GET,
+                          5,
+                          0x0005,
+                          "/big",
+                          &message) == 0);
+    BTASSERT(coap_message_get_uint_option(&message,
+                                          COAP_OPTION_BLOCK2,
+                                          &value) == -ENOENT);
+    BTASSERT(sent_request(COAP_TYPE_CONFIRMABLE,
+                          COAP_CODE_GET,
+                          6,
+                          0x0005,
+                          "/big",
+                          &message) == 0);
+    BTASSERT(coap_message_get_uint_option(&message,
+                                          COAP_OPTION_BLOCK2,
+                                          &value) == 0);
+    BTASSERT(value == COAP_BLOCK(1, 0, 2));
+
+    /* Too small response buffer. */
+    BTASSERT(respond(COAP_TYPE_ACKNOWLEDGEMENT,
+                     COAP_CODE_CONTENT,
+                     7,
+                     0x0006,
+                     -1,
+                     -1,
+                     &payload[0],
+                     64) == 0);
+    BTASSERT(coap_client_request(&client,
+                                 COAP_TYPE_CONFIRMABLE,
+                                 COAP_CODE_GET,
+                                 "/big",
+                                 NULL,
+                                 0,
+                                 &buf[0],
+                                 32,
+                                 &code) == -EMSGSIZE);
+    BTASSERT(sent(&message) == 0);
+
+    return (0);
+}
+
+static int test_observe(void)
+{
+    struct coap_message_t message;
+    uint32_t value;
+    char buf[16];
+    int code;
+
+    BTASSERT(coap_client_read_notification(&client,
+                                           &buf[0],
+                                           sizeof(buf),
+                                           &code) == -ENOENT);
+
+    /* Register. */
+    BTASSERT(respond(COAP_TYPE_ACKNOWLEDGEMENT,
+                     COAP_CODE_CONTENT,
+                     8,
+                     0x0007,
+                     3,
+                     -1,
+                     "21",
+                     2) == 0);
+    BTASSERT(coap_client_observe(&client,
+                                 "/temp",
+                                 &buf[0],
+                                 sizeof(buf),
+                                 &code) == 2);
+    BTASSERT(code == COAP_CODE_CONTENT);
+    BTASSERT(memcmp(&buf[0], "21", 2) == 0);
+    BTASSERT(sent_request(COAP_TYPE_CONFIRMABLE,
+                          COAP_CODE_GET,
+                          8,
+                          0x0007,
+                          "/temp",
+                          &message) == 0);
+    BTASSERT(coap_message_get_uint_option(&message,
+                                          COAP_OPTION_OBSERVE,
+                                          &value) == 0);
+    BTASSERT(value == 0);
+
+    /* A non-confirmable notification. */
+    BTASSERT(respond(COAP_TYPE_NON_CONFIRMABLE,
+                     COAP_CODE_CONTENT,
+                     0x7100,
+                     0x0007,
+                     4,
+                     -1,
+                     "22",
+                     2) == 0);
+    BTASSERT(coap_client_read_notification(&client,
+                                           &buf[0],
+                                           sizeof(buf),
+                                           &code) == 2);
+    BTASSERT(code == COAP_CODE_CONTENT);
+    BTASSERT(memcmp(&buf[0], "22", 2) == 0);
+    BTASSERT(socket_stub_output(&outbuf[0], sizeof(outbuf)) == -1);
+
+    /* An unknown confirmable message is reset and a confirmable
+       notification is acknowledged. */
+    BTASSERT(respond(COAP_TYPE_CONFIRMABLE,
+                     COAP_CODE_CONTENT,
+                     0x7101,
+                     0x0099,
+                     5,
+                     -1,
+                     "99",
+                     2) == 0);
+    BTASSERT(respond(COAP_TYPE_CONFIRMABLE,
+                     COAP_CODE_CONTENT,
+                     0x7102,
+                     0x0007,
+                     5,
+                     -1,
+                     "23",
+                     2) == 0);
+    BTASSERT(coap_client_read_notification(&client,
+                                           &buf[0],
+                                           sizeof(buf),
+                                           &code) == 2);
+    BTASSERT(memcmp(&buf[0], "23", 2) == 0);
+    BTASSERT(sent(&message) == 0);
+    BTASSERT(message.type == COAP_TYPE_RESET);
+    BTASSERT(message.message_id == 0x7101);
+    BTASSERT(sent(&message) == 0);
+    BTASSERT(message.type == COAP_TYPE_ACKNOWLEDGEMENT);
+    BTASSERT(message.message_id == 0x7102);
+
+    /* No notification available. */
+    BTASSERT(coap_client_read_notification(&client,
+                                           &buf[0],
+                                           sizeof(buf),
+                                           &code) == -ETIMEDOUT);
+
+    /* Cancel. */
+    BTASSERT(respond(COAP_TYPE_ACKNOWLEDGEMENT,
+                     COAP_CODE_CONTENT,
+                     9,
+                     0x0007,
+                     -1,
+                     -1,
+                     "24",
+                     2) == 0);
+    BTASSERT(coap_client_cancel_observe(&client, "/temp") == 0);
+    BTASSERT(sent_request(COAP_TYPE_CONFIRMABLE,
+                          COAP_CODE_GET,
+                          9,
+                          0x0007,
+                          "/temp",
+                          &message) == 0);
+    BTASSERT(coap_message_get_uint_option(&message,
+                                          COAP_OPTION_OBSERVE,
+                                          &value) == 0);
+    BTASSERT(value == 1);
+    BTASSERT(coap_client_read_notification(&client,
+                                           &buf[0],
+                                           sizeof(buf),
+                                           &code) == -ENOENT);
+    BTASSERT(coap_client_cancel_observe(&client, "/temp") == -ENOENT);
+
+    return (0);
+}
+
+static int test_stop(void)
+{
+    BTASSERT(coap_client_stop(&client) == 0);
+
+    return (0);
+}
+
+int main()
+{
+    struct harness_testcase_t testcases[] = {
+        { test_start, "test_start" },
+        { test_request, "test_request" },
+        { test_timeout, "test_timeout" },
+        { test_block2, "test_block2" },
+        { test_observe, "test_observe" },
+        { test_stop, "test_stop" },
+        { NULL, NULL }
+    };
+
+    sys_start();
+
+    harness_run(testcases);
+
+    return (0);
+}
@@ -0,0 +1,142 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2014-2018, Erik Moqvist
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use, copy,
+ * modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ * This file is part of the Simba project.
+ */
+
+#include "simba.h"
+
+/* Datagrams are queued as their size followed by their data. */
+static struct queue_t qinput;
+static struct queue_t qoutput;
+static uint8_t qinputbuf[2048];
+static uint8_t qoutputbuf[2048];
+
+void socket_stub_init(void)
+{
+    queue_init(&qinput, &qinputbuf[0], sizeof(qinputbuf));
+    queue_init(&qoutput, &qoutputbuf[0], sizeof(qoutputbuf));
+}
+
+/**
+ * Queue a datagram to be received by the socket.
+ */
+void socket_stub_input(const void *buf_p, size_t size)
+{
+    chan_write(&qinput, &size, sizeof(size));
+    chan_write(&qinput, buf_p, size);
+}
+
+/**
+ * Read the next datagram sent on the socket.
+ *
+ * @return Datagram size, or -1 if no datagram has been sent.
+ */
+ssize_t socket_stub_output(void *buf_p, size_t size)
+{
+    size_t output_size;
+
+    if (queue_size(&qoutput) == 0) {
+        return (-1);
+    }
+
+    chan_read(&qoutput, &output_size, sizeof(output_size));
+    BTASSERT(output_size <= size);
+    chan_read(&qoutput, buf_p, output_size);
+
+    return (output_size);
+}
+
+int socket_module_init()
+{
+    return (0);
+}
+
+int socket_open_udp(struct socket_t *self_p)
+{
+    return (0);
+}
+
+int socket_close(struct socket_t *self_p)
+{
+    return (0);
+}
+
+int socket_bind(struct socket_t *self_p,
+                const struct inet_addr_t *local_addr_p)
+{
+    return (0);
+}
+
+int socket_set_timeout(struct socket_t *self_p,
+                       int operation,
+                       const struct time_t *timeout_p)
+{
+    return (0);
+}
+
+ssize_t socket_sendto(struct socket_t *self_p,
+                      const void *buf_p,
+                      size_t size,
+                      int flags,
+                      const struct inet_addr_t *remote_addr_p)
+{
+    char buf[16];
+
+    BTASSERT(strcmp(inet_ntoa(&remote_addr_p->ip, &buf[0]),
+                    "1.2.3.4") == 0);
+    BTASSERT(remote_addr_p->port == 5683);
+
+    chan_write(&qoutput, &size, sizeof(size));
+    chan_write(&qoutput, buf_p, size);
+
+    return (size);
+}
+
+/**
+ * Receive the next queued datagram from 1.2.3.4:5683, or time out if
+ * there is none.
+ */
+ssize_t socket_recvfrom(struct socket_t *self_p,
+                        void *buf_p,
+                        size_t size,
+                        int flags,
+                        struct inet_addr_t *remote_addr_p)
+{
+    size_t input_size;
+
+    if (queue_size(&qinput) == 0) {
+        return (-ETIMEDOUT);
+    }
+
+    chan_read(&qinput, &input_size, sizeof(input_size));
+    BTASSERT(input_size <= size);
+    chan_read(&qinput, buf_p, input_size);
+
+    inet_aton("1.2.3.4", &remote_addr_p->ip);
+    remote_addr_p->port = 5683;
+
+    return (input_size);
+}
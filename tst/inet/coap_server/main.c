@@ -0,0 +1,537 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2014-2018, Erik Moqvist
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use, copy,
+ * modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ * This file is part of the Simba project.
+ */
+
+#include "simba.h"
+
+extern void socket_stub_init(void);
+extern void socket_stub_input(const void *buf_p, size_t size);
+extern ssize_t socket_stub_output(void *buf_p, size_t size);
+
+static struct coap_server_t server;
+static uint8_t outbuf[512];
+static int temp_calls = 0;
+
+static int on_temp(struct coap_server_t *self_p,
+                   struct coap_server_request_t *request_p,
+                   struct coap_server_response_t *response_p)
+{
+    temp_calls++;
+    response_p->content_format = COAP_CONTENT_FORMAT_TEXT_PLAIN;
+    response_p->size = std_sprintf((char *)response_p->buf_p,
+                                   FSTR("%d"),
+                                   20 + temp_calls);
+
+    return (0);
+}
+
+static int on_big(struct coap_server_t *self_p,
+                  struct coap_server_request_t *request_p,
+                  struct coap_server_response_t *response_p)
+{
+    int i;
+
+    for (i = 0; i < 300; i++) {
+        response_p->buf_p[i] = i;
+    }
+
+    response_p->size = 300;
+
+    return (0);
+}
+
+static int on_echo(struct coap_server_t *self_p,
+                   struct coap_server_request_t *request_p,
+                   struct coap_server_response_t *response_p)
+{
+    memcpy(response_p->buf_p,
+           request_p->message_p->payload_p,
+           request_p->message_p->payload_size);
+    response_p->size = request_p->message_p->payload_size;
+
+    return (0);
+}
+
+static int on_files(struct coap_server_t *self_p,
+                    struct coap_server_request_t *request_p,
+                    struct coap_server_response_t *response_p)
+{
+    strcpy((char *)response_p->buf_p, request_p->path_p);
+    response_p->size = strlen(request_p->path_p);
+
+    return (0);
+}
+
+static int on_fail(struct coap_server_t *self_p,
+                   struct coap_server_request_t *request_p,
+                   struct coap_server_response_t *response_p)
+{
+    return (-1);
+}
+
+static const struct coap_server_route_t routes[] = {
+    { "/temp", on_temp, COAP_SERVER_ROUTE_GET },
+    { "/big", on_big, 0 },
+    { "/echo", on_echo, COAP_SERVER_ROUTE_POST | COAP_SERVER_ROUTE_PUT },
+    { "/files/", on_files, 0 },
+    { "/fail", on_fail, 0 },
+    { NULL, NULL, 0 }
+};
+
+/**
+ * Input a request to the server and let it handle it.
+ */
+static int request(int type,
+                   int code,
+                   uint16_t message_id,
+                   const char *path_p,
+                   int observe,
+                   int32_t block,
+                   const void *payload_p,
+                   size_t payload_size)
+{
+    struct coap_encoder_t encoder;
+    uint8_t buf[128];
+    ssize_t size;
+
+    BTASSERT(coap_encoder_init(&encoder,
+                               &buf[0],
+                               sizeof(buf),
+                               type,
+                               code,
+                               message_id,
+                               (uint8_t *)"\x01\x02",
+                               2) == 0);
+
+    if (observe >= 0) {
+        BTASSERT(coap_encoder_add_uint_option(&encoder,
+                                              COAP_OPTION_OBSERVE,
+                                              observe) == 0);
+    }
+
+    BTASSERT(coap_encoder_add_path(&encoder, path_p) == 0);
+
+    if (block >= 0) {
+        BTASSERT(coap_encoder_add_uint_option(&encoder,
+                                              COAP_OPTION_BLOCK2,
+                                              block) == 0);
+    }
+
+    BTASSERT(coap_encoder_add_payload(&encoder,
+                                      payload_p,
+                                      payload_size) == 0);
+    size = coap_encoder_get_size(&encoder);
+    BTASSERT(size > 0);
+    socket_stub_input(&buf[0], size);
+
+    return (coap_server_process(&server));
+}
+
+/**
+ * Read and decode the next message sent by the server.
+ */
+static int response(struct coap_message_t *message_p)
+{
+    ssize_t size;
+
+    size = socket_stub_output(&outbuf[0], sizeof(outbuf));
+    BTASSERT(size > 0);
+    BTASSERT(coap_message_decode(message_p, &outbuf[0], size) == 0);
+
+    return (0);
+}
+
+static int test_start(void)
+{
+    struct inet_addr_t addr;
+
+    socket_stub_init();
+
+    BTASSERT(inet_aton("127.0.0.1", &addr.ip) == 0);
+    addr.port = 5683;
+
+    BTASSERT(coap_server_init(&server, &addr, &routes[0]) == 0);
+    BTASSERT(coap_server_start(&server) == 0);
+
+    return (0);
+}
+
+static int test_get(void)
+{
+    struct coap_message_t message;
+    uint32_t value;
+
+    /* Confirmable requests get a piggybacked response. */
+    BTASSERT(request(COAP_TYPE_CONFIRMABLE,
+                     COAP_CODE_GET,
+                     0x100,
+                     "/temp",
+                     -1,
+                     -1,
+                     NULL,
+                     0) == 0);
+    BTASSERT(response(&message) == 0);
+    BTASSERT(message.type == COAP_TYPE_ACKNOWLEDGEMENT);
+    BTASSERT(message.code == COAP_CODE_CONTENT);
+    BTASSERT(message.message_id == 0x100);
+    BTASSERT(message.token_size == 2);
+    BTASSERT(memcmp(&message.token[0], "\x01\x02", 2) == 0);
+    BTASSERT(coap_message_get_uint_option(&message,
+                                          COAP_OPTION_CONTENT_FORMAT,
+                                          &value) == 0);
+    BTASSERT(value == COAP_CONTENT_FORMAT_TEXT_PLAIN);
+    BTASSERT(message.payload_size == 2);
+    BTASSERT(memcmp(message.payload_p, "21", 2) == 0);
+
+    /* A retransmission is answered with the same response without
+       calling the route again. */
+    BTASSERT(request(COAP_TYPE_CONFIRMABLE,
+                     COAP_CODE_GET,
+                     0x100,
+                     "/temp",
+                     -1,
+                     -1,
+                     NULL,
+                     0) == 0);
+    BTASSERT(response(&message) == 0);
+    BTASSERT(message.message_id == 0x100);
+    BTASSERT(memcmp(message.payload_p, "21", 2) == 0);
+    BTASSERT(temp_calls == 1);
+
+    /* Non-confirmable requests get a non-confirmable response. */
+    BTASSERT(request(COAP_TYPE_NON_CONFIRMABLE,
+                     COAP_CODE_GET,
+                     0x101,
+                     "temp",
+                     -1,
+                     -1,
+                     NULL,
+                     0) == 0);
+    BTASSERT(response(&message) == 0);
+    BTASSERT(message.type == COAP_TYPE_NON_CONFIRMABLE);
+    BTASSERT(message.code == COAP_CODE_CONTENT);
+    BTASSERT(memcmp(&message.token[0], "\x01\x02", 2) == 0);
+    BTASSERT(memcmp(message.payload_p, "22", 2) == 0);
+
+    return (0);
+}
+
+static int test_routes(void)
+{
+    struct coap_message_t message;
+
+    /* Not found. */
+    BTASSERT(request(COAP_TYPE_CONFIRMABLE,
+                     COAP_CODE_GET,
+                     0x200,
+                     "/missing",
+                     -1,
+                     -1,
+                     NULL,
+                     0) == 0);
+    BTASSERT(response(&message) == 0);
+    BTASSERT(message.code == COAP_CODE_NOT_FOUND);
+    BTASSERT(message.payload_size == 0);
+
+    /* Method not allowed. */
+    BTASSERT(request(COAP_TYPE_CONFIRMABLE,
+                     COAP_CODE_DELETE,
+                     0x201,
+                     "/temp",
+                     -1,
+                     -1,
+                     NULL,
+                     0) == 0);
+    BTASSERT(response(&message) == 0);
+    BTASSERT(message.code == COAP_CODE_METHOD_NOT_ALLOWED);
+
+    /* Request payload. */
+    BTASSERT(request(COAP_TYPE_CONFIRMABLE,
+                     COAP_CODE_POST,
+                     0x202,
+                     "/echo",
+                     -1,
+                     -1,
+                     "hello",
+                     5) == 0);
+    BTASSERT(response(&message) == 0);
+    BTASSERT(message.code == COAP_CODE_CHANGED);
+    BTASSERT(message.payload_size == 5);
+    BTASSERT(memcmp(message.payload_p, "hello", 5) == 0);
+
+    /* Prefix route. */
+    BTASSERT(request(COAP_TYPE_CONFIRMABLE,
+                     COAP_CODE_GET,
+                     0x203,
+                     "/files/a/b",
+                     -1,
+                     -1,
+                     NULL,
+                     0) == 0);
+    BTASSERT(response(&message) == 0);
+    BTASSERT(message.code == COAP_CODE_CONTENT);
+    BTASSERT(message.payload_size == 10);
+    BTASSERT(memcmp(message.payload_p, "/files/a/b", 10) == 0);
+
+    /* Failing route. */
+    BTASSERT(request(COAP_TYPE_CONFIRMABLE,
+                     COAP_CODE_GET,
+                     0x204,
+                     "/fail",
+                     -1,
+                     -1,
+                     NULL,
+                     0) == 0);
+    BTASSERT(response(&message) == 0);
+    BTASSERT(message.code == COAP_CODE_INTERNAL_SERVER_ERROR);
+
+    return (0);
+}
+
+static int test_block2(void)
+{
+    struct coap_message_t message;
+    uint32_t value;
+
+    /* The first block of 256 bytes. */
+    BTASSERT(request(COAP_TYPE_CONFIRMABLE,
+                     COAP_CODE_GET,
+                     0x300,
+                     "/big",
+                     -1,
+                     -1,
+                     NULL,
+                     0) == 0);
+    BTASSERT(response(&message) == 0);
+    BTASSERT(message.code == COAP_CODE_CONTENT);
+    BTASSERT(coap_message_get_uint_option(&message,
+                                          COAP_OPTION_BLOCK2,
+                                          &value) == 0);
+    BTASSERT(value == COAP_BLOCK(0, 1, 4));
+    BTASSERT(coap_message_get_uint_option(&message,
+                                          COAP_OPTION_SIZE2,
+                                          &value) == 0);
+    BTASSERT(value == 300);
+    BTASSERT(message.payload_size == 256);
+    BTASSERT(message.payload_p[255] == 255);
+
+    /* The second and last block. */
+    BTASSERT(request(COAP_TYPE_CONFIRMABLE,
+                     COAP_CODE_GET,
+                     0x301,
+                     "/big",
+                     -1,
+                     COAP_BLOCK(1, 0, 4),
+                     NULL,
+                     0) == 0);
+    BTASSERT(response(&message) == 0);
+    BTASSERT(coap_message_get_uint_option(&message,
+                                          COAP_OPTION_BLOCK2,
+                                          &value) == 0);
+    BTASSERT(value == COAP_BLOCK(1, 0, 4));
+    BTASSERT(coap_message_get_uint_option(&message,
+                                          COAP_OPTION_SIZE2,
+                                          &value) == -ENOENT);
+    BTASSERT(message.payload_size == 44);
+    BTASSERT(message.payload_p[0] == (uint8_t)256);
+
+    /* The client asks for smaller blocks. */
+    BTASSERT(request(COAP_TYPE_CONFIRMABLE,
+                     COAP_CODE_GET,
+                     0x302,
+                     "/big",
+                     -1,
+                     COAP_BLOCK(2, 0, 2),
+                     NULL,
+                     0) == 0);
+    BTASSERT(response(&message) == 0);
+    BTASSERT(coap_message_get_uint_option(&message,
+                                          COAP_OPTION_BLOCK2,
+                                          &value) == 0);
+    BTASSERT(value == COAP_BLOCK(2, 1, 2));
+    BTASSERT(message.payload_size == 64);
+    BTASSERT(message.payload_p[0] == 128);
+
+    /* The client asks for larger blocks than the server sends. */
+    BTASSERT(request(COAP_TYPE_CONFIRMABLE,
+                     COAP_CODE_GET,
+                     0x303,
+                     "/big",
+                     -1,
+                     COAP_BLOCK(0, 0, 6),
+                     NULL,
+                     0) == 0);
+    BTASSERT(response(&message) == 0);
+    BTASSERT(coap_message_get_uint_option(&message,
+                                          COAP_OPTION_BLOCK2,
+                                          &value) == 0);
+    BTASSERT(value == COAP_BLOCK(0, 1, 4));
+    BTASSERT(message.payload_size == 256);
+
+    return (0);
+}
+
+static int test_observe(void)
+{
+    struct coap_message_t message;
+    uint32_t value;
+    uint32_t sequence;
+    uint16_t message_id;
+
+    /* Register an observer. */
+    BTASSERT(request(COAP_TYPE_CONFIRMABLE,
+                     COAP_CODE_GET,
+                     0x400,
+                     "/temp",
+                     0,
+                     -1,
+                     NULL,
+                     0) == 0);
+    BTASSERT(response(&message) == 0);
+    BTASSERT(message.code == COAP_CODE_CONTENT);
+    BTASSERT(coap_message_get_uint_option(&message,
+                                          COAP_OPTION_OBSERVE,
+                                          &value) == 0);
+    BTASSERT(value == 0);
+
+    /* Notifications. */
+    BTASSERT(coap_server_notify(&server, "/big") == 0);
+    BTASSERT(coap_server_notify(&server, "/temp") == 1);
+    BTASSERT(response(&message) == 0);
+    BTASSERT(message.type == COAP_TYPE_NON_CONFIRMABLE);
+    BTASSERT(message.code == COAP_CODE_CONTENT);
+    BTASSERT(memcmp(&message.token[0], "\x01\x02", 2) == 0);
+    BTASSERT(coap_message_get_uint_option(&message,
+                                          COAP_OPTION_OBSERVE,
+                                          &value) == 0);
+    BTASSERT(value > 0);
+    BTASSERT(memcmp(message.payload_p, "24", 2) == 0);
+    message_id = message.message_id;
+    sequence = value;
+
+    BTASSERT(coap_server_notify(&server, "/temp") == 1);
+    BTASSERT(response(&message) == 0);
+    BTASSERT(coap_message_get_uint_option(&message,
+                                          COAP_OPTION_OBSERVE,
+                                          &value) == 0);
+    BTASSERT(value == sequence + 1);
+    BTASSERT(message.message_id == (uint16_t)(message_id + 1));
+    message_id = message.message_id;
+
+    /* A reset of the last notification cancels the observation. */
+    socket_stub_input("\x70\x00", 2);
+    outbuf[0] = 0x70;
+    outbuf[1] = 0x00;
+    outbuf[2] = (message_id >> 8);
+    outbuf[3] = message_id;
+    socket_stub_input(&outbuf[0], 4);
+    BTASSERT(coap_server_process(&server) == -EBADMSG);
+    BTASSERT(coap_server_process(&server) == 0);
+    BTASSERT(coap_server_notify(&server, "/temp") == 0);
+
+    /* Register and deregister. */
+    BTASSERT(request(COAP_TYPE_CONFIRMABLE,
+                     COAP_CODE_GET,
+                     0x401,
+                     "/temp",
+                     0,
+                     -1,
+                     NULL,
+                     0) == 0);
+    BTASSERT(response(&message) == 0);
+    BTASSERT(coap_server_notify(&server, "/temp") == 1);
+    BTASSERT(response(&message) == 0);
+    BTASSERT(request(COAP_TYPE_CONFIRMABLE,
+                     COAP_CODE_GET,
+                     0x402,
+                     "/temp",
+                     1,
+                     -1,
+                     NULL,
+                     0) == 0);
+    BTASSERT(response(&message) == 0);
+    BTASSERT(coap_message_get_uint_option(&message,
+                                          COAP_OPTION_OBSERVE,
+                                          &value) == -ENOENT);
+    BTASSERT(coap_server_notify(&server, "/temp") == 0);
+
+    return (0);
+}
+
+static int test_empty(void)
+{
+    struct coap_message_t message;
+
+    /* A ping is answered with a reset. */
+    socket_stub_input("\x40\x00\x05\x00", 4);
+    BTASSERT(coap_server_process(&server) == 0);
+    BTASSERT(response(&message) == 0);
+    BTASSERT(message.type == COAP_TYPE_RESET);
+    BTASSERT(message.code == COAP_CODE_EMPTY);
+    BTASSERT(message.message_id == 0x500);
+
+    /* A malformed confirmable message is rejected with a reset. */
+    socket_stub_input("\x40\x01\x05\x01\xff", 5);
+    BTASSERT(coap_server_process(&server) == -EBADMSG);
+    BTASSERT(response(&message) == 0);
+    BTASSERT(message.type == COAP_TYPE_RESET);
+    BTASSERT(message.message_id == 0x501);
+
+    /* Acknowledgements are ignored. */
+    socket_stub_input("\x60\x00\x05\x02", 4);
+    BTASSERT(coap_server_process(&server) == 0);
+    BTASSERT(socket_stub_output(&outbuf[0], sizeof(outbuf)) == -1);
+
+    return (0);
+}
+
+static int test_stop(void)
+{
+    BTASSERT(coap_server_stop(&server) == 0);
+
+    return (0);
+}
+
+int main()
+{
+    struct harness_testcase_t testcases[] = {
+        { test_start, "test_start" },
+        { test_get, "test_get" },
+        { test_routes, "test_routes" },
+        { test_block2, "test_block2" },
+        { test_observe, "test_observe" },
+        { test_empty, "test_empty" },
+        { test_stop, "test_stop" },
+        { NULL, NULL }
+    };
+
+    sys_start();
+
+    harness_run(testcases);
+
+    return (0);
+}
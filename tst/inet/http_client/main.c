@@ -0,0 +1,336 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2014-2018, Erik Moqvist
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use, copy,
+ * modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ * This file is part of the Simba project.
+ */
+
+#include "simba.h"
+#include "simba.h"
+
+extern void socket_stub_init(void);
+extern void socket_stub_input(void *buf_p, size_t size);
+extern void socket_stub_output(void *buf_p, size_t size);
+extern void socket_stub_close(void);
+extern void socket_stub_get_counters(int *opens_p,
+                                     int *closes_p,
+                                     int *opened_p);
+
+static struct http_client_t client;
+static char buf[256];
+
+static void input(const char *str_p)
+{
+    socket_stub_input((void *)str_p, strlen(str_p));
+}
+
+static int output_equals(const char *str_p)
+{
+    size_t size;
+
+    size = strlen(str_p);
+    socket_stub_output(&buf[0], size);
+    buf[size] = '\0';
+
+    return (strcmp(&buf[0], str_p) == 0);
+}
+
+static int counters_equal(int opens, int closes, int opened)
+{
+    int actual_opens;
+    int actual_closes;
+    int actual_opened;
+
+    socket_stub_get_counters(&actual_opens, &actual_closes, &actual_opened);
+
+    return ((actual_opens == opens)
+            && (actual_closes == closes)
+            && (actual_opened == opened));
+}
+
+static int test_init(void)
+{
+    socket_stub_init();
+
+    BTASSERT(http_client_init(&client, NULL) == 0);
+
+    return (0);
+}
+
+static int test_get(void)
+{
+    struct http_client_request_t request;
+    struct http_client_response_t response;
+
+    request.action = http_client_request_action_get_t;
+    request.host_p = "foo.com";
+    request.port = 80;
+    request.ssl = 0;
+    request.path_p = "/index.html";
+    request.headers_p = NULL;
+    request.body_p = NULL;
+
+    input("HTTP/1.1 200 OK\r\n"
+          "content-type: text/plain\r\n"
+          "Content-Length: 5\r\n"
+          "\r\n"
+          "hello");
+
+    BTASSERTI(http_client_request(&client, &request, &response), ==, 0);
+    BTASSERT(output_equals("GET /index.html HTTP/1.1\r\n"
+                           "Host: foo.com\r\n"
+                           "\r\n"));
+    BTASSERTI(response.code, ==, 200);
+    BTASSERTI(response.headers.content_length.present, ==, 1);
+    BTASSERTI(response.headers.content_length.value, ==, 5);
+    BTASSERTI(response.headers.content_type.present, ==, 1);
+    BTASSERT(strcmp(response.headers.content_type.value, "text/plain") == 0);
+
+    BTASSERTI(http_client_response_read(&client, &buf[0], 3), ==, 3);
+    BTASSERTI(http_client_response_read(&client, &buf[3], 8), ==, 2);
+    BTASSERT(memcmp(&buf[0], "hello", 5) == 0);
+    BTASSERTI(http_client_response_read(&client, &buf[0], 8), ==, 0);
+    BTASSERT(counters_equal(1, 0, 1));
+
+    return (0);
+}
+
+static int test_chunked_keep_alive(void)
+{
+    struct http_client_request_t request;
+    struct http_client_response_t response;
+    struct queue_t queue;
+    char queuebuf[32];
+
+    request.action = http_client_request_action_get_t;
+    request.host_p = "foo.com";
+    request.port = 80;
+    request.ssl = 0;
+    request.path_p = "/chunked";
+    request.headers_p = NULL;
+    request.body_p = NULL;
+
+    input("HTTP/1.1 200 OK\r\n"
+          "Transfer-Encoding: chunked\r\n"
+          "\r\n"
+          "4\r\n"
+          "Wiki\r\n"
+          "5;name=value\r\n"
+          "pedia\r\n"
+          "0\r\n"
+          "Trailer: foo\r\n"
+          "\r\n");
+
+    /* The connection from the previous test is reused. */
+    BTASSERT(http_client_request(&client, &request, &response) == 0);
+    BTASSERT(output_equals("GET /chunked HTTP/1.1\r\n"
+                           "Host: foo.com\r\n"
+                           "\r\n"));
+    BTASSERTI(response.code, ==, 200);
+    BTASSERTI(response.headers.content_length.present, ==, 0);
+
+    BTASSERT(queue_init(&queue, &queuebuf[0], sizeof(queuebuf)) == 0);
+    BTASSERTI(http_client_response_copy(&client, &queue), ==, 9);
+    BTASSERTI(queue_read(&queue, &buf[0], 9), ==, 9);
+    BTASSERT(memcmp(&buf[0], "Wikipedia", 9) == 0);
+    BTASSERT(counters_equal(1, 0, 1));
+
+    return (0);
+}
+
+static int test_post_connection_close(void)
+{
+    struct http_client_request_t request;
+    struct http_client_response_t response;
+
+    request.action = http_client_request_action_post_t;
+    request.host_p = "foo.com";
+    request.port = 80;
+    request.ssl = 0;
+    request.path_p = "/form";
+    request.headers_p = "Content-Type: text/plain\r\n";
+    request.body_p = "bar";
+    request.size = 3;
+
+    input("HTTP/1.1 204 No Content\r\n"
+          "Connection: close\r\n"
+          "\r\n");
+
+    BTASSERT(http_client_request(&client, &request, &response) == 0);
+    BTASSERT(output_equals("POST /form HTTP/1.1\r\n"
+                           "Host: foo.com\r\n"
+                           "Content-Length: 3\r\n"
+                           "Content-Type: text/plain\r\n"
+                           "\r\n"
+                           "bar"));
+    BTASSERTI(response.code, ==, 204);
+    BTASSERTI(http_client_response_read(&client, &buf[0], 8), ==, 0);
+    BTASSERT(counters_equal(1, 1, 0));
+
+    return (0);
+}
+
+static int test_reconnect(void)
+{
+    struct http_client_request_t request;
+    struct http_client_response_t response;
+
+    request.action = http_client_request_action_delete_t;
+    request.host_p = "foo.com";
+    request.port = 80;
+    request.ssl = 0;
+    request.path_p = "/a";
+    request.headers_p = NULL;
+    request.body_p = NULL;
+
+    input("HTTP/1.1 200 OK\r\n"
+          "Content-Length: 0\r\n"
+          "\r\n");
+
+    BTASSERT(http_client_request(&client, &request, &response) == 0);
+    BTASSERT(output_equals("DELETE /a HTTP/1.1\r\n"
+                           "Host: foo.com\r\n"
+                           "\r\n"));
+    BTASSERT(counters_equal(2, 1, 1));
+
+    /* The server closes the idle connection. The request is sent
+       again on a new connection. */
+    socket_stub_close();
+    input("HTTP/1.1 200 OK\r\n"
+          "Content-Length: 0\r\n"
+          "\r\n");
+
+    BTASSERT(http_client_request(&client, &request, &response) == 0);
+    BTASSERT(output_equals("DELETE /a HTTP/1.1\r\n"
+                           "Host: foo.com\r\n"
+                           "\r\n"
+                           "DELETE /a HTTP/1.1\r\n"
+                           "Host: foo.com\r\n"
+                           "\r\n"));
+    BTASSERTI(response.code, ==, 200);
+    BTASSERT(counters_equal(3, 2, 1));
+
+    return (0);
+}
+
+static int test_read_until_close(void)
+{
+    struct http_client_request_t request;
+    struct http_client_response_t response;
+
+    request.action = http_client_request_action_get_t;
+    request.host_p = "foo.com";
+    request.port = 80;
+    request.ssl = 0;
+    request.path_p = "/";
+    request.headers_p = NULL;
+    request.body_p = NULL;
+
+    input("HTTP/1.0 200 OK\r\n"
+          "\r\n"
+          "abc");
+
+    BTASSERT(http_client_request(&client, &request, &response) == 0);
+    BTASSERT(output_equals("GET / HTTP/1.1\r\n"
+                           "Host: foo.com\r\n"
+                           "\r\n"));
+
+    BTASSERTI(http_client_response_read(&client, &buf[0], 8), ==, 3);
+    BTASSERT(memcmp(&buf[0], "abc", 3) == 0);
+    socket_stub_close();
+    BTASSERTI(http_client_response_read(&client, &buf[0], 8), ==, 0);
+    BTASSERT(counters_equal(3, 3, 0));
+
+    return (0);
+}
+
+static int test_pool(void)
+{
+    struct http_client_request_t request;
+    struct http_client_response_t response;
+    int i;
+    static const char *hosts[] = { "a.com", "b.com", "a.com", "c.com" };
+
+    request.action = http_client_request_action_get_t;
+    request.port = 80;
+    request.ssl = 0;
+    request.path_p = "/";
+    request.headers_p = NULL;
+    request.body_p = NULL;
+
+    /* Two connections are kept open. The least recently used, to
+       b.com, is closed when c.com is requested. */
+    for (i = 0; i < membersof(hosts); i++) {
+        request.host_p = hosts[i];
+        input("HTTP/1.1 200 OK\r\n"
+              "Content-Length: 0\r\n"
+              "\r\n");
+        BTASSERT(http_client_request(&client, &request, &response) == 0);
+        std_sprintf(&buf[128],
+                    FSTR("GET / HTTP/1.1\r\n"
+                         "Host: %s\r\n"
+                         "\r\n"),
+                    hosts[i]);
+        BTASSERT(output_equals(&buf[128]));
+    }
+
+    BTASSERT(counters_equal(6, 4, 2));
+
+    /* A body that is not read closes the connection. */
+    request.host_p = "a.com";
+    input("HTTP/1.1 200 OK\r\n"
+          "Content-Length: 3\r\n"
+          "\r\n"
+          "abc");
+    BTASSERT(http_client_request(&client, &request, &response) == 0);
+    std_sprintf(&buf[128],
+                FSTR("GET / HTTP/1.1\r\n"
+                     "Host: a.com\r\n"
+                     "\r\n"));
+    BTASSERT(output_equals(&buf[128]));
+    BTASSERT(http_client_close(&client) == 0);
+    BTASSERT(counters_equal(6, 6, 0));
+
+    return (0);
+}
+
+int main()
+{
+    struct harness_testcase_t testcases[] = {
+        { test_init, "test_init" },
+        { test_get, "test_get" },
+        { test_chunked_keep_alive, "test_chunked_keep_alive" },
+        { test_post_connection_close, "test_post_connection_close" },
+        { test_reconnect, "test_reconnect" },
+        { test_read_until_close, "test_read_until_close" },
+        { test_pool, "test_pool" },
+        { NULL, NULL }
+    };
+
+    sys_start();
+
+    harness_run(testcases);
+
+    return (0);
+}
@@ -0,0 +1,151 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2014-2018, Erik Moqvist
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use, copy,
+ * modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ * This file is part of the Simba project.
+ */
+
+#include "simba.h"
+#include "simba.h"
+
+static struct queue_t qinput;
+static struct queue_t qoutput;
+static char qinputbuf[1024];
+static char qoutputbuf[1024];
+static int closed;
+static int opened;
+static int number_of_opens;
+static int number_of_closes;
+
+static ssize_t read(void *self_p,
+                    void *buf_p,
+                    size_t size)
+{
+    /* The server closed the connection. */
+    if (closed == 1) {
+        closed = 0;
+
+        return (0);
+    }
+
+    return (queue_read(&qinput, buf_p, size));
+}
+
+static ssize_t write(void *self_p,
+                     const void *buf_p,
+                     size_t size)
+{
+    return (chan_write(&qoutput, buf_p, size));
+}
+
+static size_t size(void *self_p)
+{
+    return (queue_size(&qinput));
+}
+
+int socket_module_init()
+{
+    return (0);
+}
+
+int socket_open_tcp(struct socket_t *self_p)
+{
+    number_of_opens++;
+    opened++;
+
+    return (chan_init(&self_p->base, read, write, size));
+}
+
+int socket_close(struct socket_t *self_p)
+{
+    number_of_closes++;
+    opened--;
+
+    return (0);
+}
+
+int socket_connect(struct socket_t *self_p,
+                   const struct inet_addr_t *addr_p)
+{
+    return (0);
+}
+
+int socket_gethostbyname(const char *hostname_p,
+                         struct inet_ip_addr_t *ip_p)
+{
+    ip_p->number = 0x7f000001;
+
+    return (0);
+}
+
+ssize_t socket_write(struct socket_t *self_p,
+                     const void *buf_p,
+                     size_t size)
+{
+    return (write(NULL, buf_p, size));
+}
+
+ssize_t socket_read(struct socket_t *self_p,
+                    void *buf_p,
+                    size_t size)
+{
+    return (read(NULL, buf_p, size));
+}
+
+ssize_t socket_size(struct socket_t *self_p)
+{
+    return (size(NULL));
+}
+
+void socket_stub_init()
+{
+    queue_init(&qinput, qinputbuf, sizeof(qinputbuf));
+    queue_init(&qoutput, qoutputbuf, sizeof(qoutputbuf));
+}
+
+void socket_stub_input(void *buf_p, size_t size)
+{
+    chan_write(&qinput, buf_p, size);
+}
+
+void socket_stub_output(void *buf_p, size_t size)
+{
+    chan_read(&qoutput, buf_p, size);
+}
+
+/**
+ * Make the next socket read return zero(0), as if the server closed
+ * the connection.
+ */
+void socket_stub_close()
+{
+    closed = 1;
+}
+
+void socket_stub_get_counters(int *opens_p, int *closes_p, int *opened_p)
+{
+    *opens_p = number_of_opens;
+    *closes_p = number_of_closes;
+    *opened_p = opened;
+}
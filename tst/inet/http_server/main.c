@@ -52,6 +52,10 @@ static int request_websocket_echo(struct http_server_connection_t *connection_p,
                                   struct http_server_request_t *request_p);
 static int request_404_not_found(struct http_server_connection_t *connection_p,
                                  struct http_server_request_t *request_p);
+static int request_sensor(struct http_server_connection_t *connection_p,
+                          struct http_server_request_t *request_p);
+static int request_sensor_value(struct http_server_connection_t *connection_p,
+                                struct http_server_request_t *request_p);
 
 static struct http_server_t foo;
 
@@ -60,14 +64,114 @@ static struct http_server_route_t routes[] = {
     { .path_p = "/auth.html", .callback = request_auth },
     { .path_p = "/form.html", .callback = request_form },
     { .path_p = "/websocket/echo", .callback = request_websocket_echo },
+    { .path_p = "/static/", .callback = http_server_route_static },
+    { .path_p = "/files/", .callback = http_server_route_static },
+    { .path_p = "/metrics", .callback = http_server_route_metrics },
+    {
+        .path_p = "/api/sensors/{id}/values/{index}",
+        .callback = request_sensor_value,
+        .actions = HTTP_SERVER_ROUTE_GET
+    },
+    {
+        .path_p = "/api/sensors/{id}",
+        .callback = request_sensor,
+        .actions = HTTP_SERVER_ROUTE_POST
+    },
+    {
+        .path_p = "/api/sensors/{id}",
+        .callback = request_sensor,
+        .actions = HTTP_SERVER_ROUTE_GET
+    },
     { .path_p = NULL, .callback = NULL }
 };
 
+static const char app_js_gz[] = "<gzipped app.js>";
+static const char app_js[] = "var a = 1;";
+
+static const struct http_server_static_file_t static_files[] = {
+    {
+        .path_p = "/static/app.js",
+        .content_type_p = "application/javascript",
+        .etag_p = "\"1234abcd\"",
+        .flags = HTTP_SERVER_STATIC_FILE_GZIP,
+        .buf_p = app_js_gz,
+        .size = sizeof(app_js_gz) - 1
+    },
+    {
+        .path_p = "/static/app.js",
+        .content_type_p = "application/javascript",
+        .etag_p = "\"5678abcd\"",
+        .flags = 0,
+        .buf_p = app_js,
+        .size = sizeof(app_js) - 1
+    },
+    {
+        .path_p = NULL
+    }
+};
+
+/* A file system with two files, "/www/files/hello.txt" and
+   "/www/files/style.css.gz". */
+static struct fs_filesystem_operations_t www_ops;
+static struct fs_filesystem_t wwwfs;
+static const char *www_file_p;
+static size_t www_file_left;
+
+static int ends_with(const char *str_p, const char *suffix_p)
+{
+    size_t length;
+    size_t suffix_length;
+
+    length = strlen(str_p);
+    suffix_length = strlen(suffix_p);
+
+    return ((length >= suffix_length)
+            && (strcmp(&str_p[length - suffix_length], suffix_p) == 0));
+}
+
+static int www_file_open(struct fs_filesystem_t *filesystem_p,
+                         struct fs_file_t *self_p,
+                         const char *path_p,
+                         int flags)
+{
+    if (ends_with(path_p, "files/hello.txt")) {
+        www_file_p = "Hello from the file system!";
+    } else if (ends_with(path_p, "files/style.css.gz")) {
+        www_file_p = "<gzipped style.css>";
+    } else {
+        return (-1);
+    }
+
+    www_file_left = strlen(www_file_p);
+
+    return (0);
+}
+
+static ssize_t www_file_read(struct fs_file_t *self_p,
+                             void *dst_p,
+                             size_t size)
+{
+    if (size > www_file_left) {
+        size = www_file_left;
+    }
+
+    memcpy(dst_p, www_file_p, size);
+    www_file_p += size;
+    www_file_left -= size;
+
+    return (size);
+}
+
 THRD_STACK(listener_stack, 2048);
 THRD_STACK(connection_stack, 2048);
 
 THRD_STACK(https_listener_stack, 2048);
 THRD_STACK(https_connection_stack, 2048);
+THRD_STACK(reactor_stack, 2048);
+
+static struct http_server_t bar;
+static struct reactor_t reactor;
+static struct thrd_t *reactor_thrd_p;
 
 /**
  * Handler for the index request.
@@ -187,7 +291,7 @@ static int request_404_not_found(struct http_server_connection_t *connection_p,
                                  struct http_server_request_t *request_p)
 {
     int res;
-    char content[64];
+    char content[96];
     size_t size;
     struct http_server_response_t response;
 
@@ -213,6 +317,121 @@ static int request_404_not_found(struct http_server_connection_t *connection_p,
     return (0);
 }
 
+/**
+ * Write given text as the response content.
+ */
+static int write_text(struct http_server_connection_t *connection_p,
+                      struct http_server_request_t *request_p,
+                      const char *text_p)
+{
+    struct http_server_response_t response;
+
+    response.code = http_server_response_code_200_ok_t;
+    response.content.type = http_server_content_type_text_plain_t;
+    response.content.buf_p = text_p;
+    response.content.size = strlen(text_p);
+
+    return (http_server_response_write(connection_p, request_p, &response));
+}
+
+/**
+ * Handler for the sensor requests.
+ */
+static int request_sensor(struct http_server_connection_t *connection_p,
+                          struct http_server_request_t *request_p)
+{
+    char buf[32];
+
+    BTASSERT(request_p->params.length == 1);
+
+    std_sprintf(&buf[0],
+                FSTR("%s %s"),
+                (request_p->action == http_server_request_action_get_t
+                 ? "get"
+                 : "post"),
+                request_p->params.values[0]);
+
+    return (write_text(connection_p, request_p, &buf[0]));
+}
+
+/**
+ * Handler for the sensor value request.
+ */
+static int request_sensor_value(struct http_server_connection_t *connection_p,
+                                struct http_server_request_t *request_p)
+{
+    char buf[40];
+
+    BTASSERT(request_p->params.length == 2);
+
+    std_sprintf(&buf[0],
+                FSTR("%s:%s"),
+                request_p->params.values[0],
+                request_p->params.values[1]);
+
+    return (write_text(connection_p, request_p, &buf[0]));
+}
+
+static void *reactor_main(void *arg_p)
+{
+    thrd_set_name("http_reactor");
+
+    reactor_run(&reactor);
+    thrd_suspend(NULL);
+
+    return (NULL);
+}
+
+static int test_reactor_start(void)
+{
+    static struct http_server_listener_t listener = {
+        .address_p = "127.0.0.1",
+        .port = 8080
+    };
+    static struct http_server_connection_t connections[] = {
+        {
+            .thrd = {
+                .name_p = "http_reactor_conn_0"
+            }
+        },
+        {
+            .thrd = {
+                .name_p = NULL
+            }
+        }
+    };
+
+    BTASSERT(http_server_init(&bar,
+                              &listener,
+                              connections,
+                              NULL,
+                              routes,
+                              request_404_not_found) == 0);
+    BTASSERT(reactor_init(&reactor) == 0);
+    BTASSERT(http_server_reactor_start(&bar, &reactor) == 0);
+
+    /* All connections are served by the reactor thread. */
+    reactor_thrd_p = thrd_spawn(reactor_main,
+                                NULL,
+                                0,
+                                reactor_stack,
+                                sizeof(reactor_stack));
+    BTASSERT(reactor_thrd_p != NULL);
+    thrd_set_log_mask(reactor_thrd_p, LOG_UPTO(DEBUG));
+
+    return (0);
+}
+
+static int test_reactor_stop(void)
+{
+    BTASSERT(reactor_stop(&reactor) == 0);
+
+    /* Let the reactor thread return from the loop. */
+    thrd_sleep_us(10000);
+
+    return (0);
+}
+
 static int test_start(void)
 {
     static struct http_server_listener_t listener = {
@@ -243,12 +462,23 @@ static int test_start(void)
         }
     };
 
+    www_ops.file_open = www_file_open;
+    www_ops.file_read = www_file_read;
+    BTASSERT(fs_filesystem_init_generic(&wwwfs, "/www", &www_ops) == 0);
+    BTASSERT(fs_filesystem_register(&wwwfs) == 0);
+
     BTASSERT(http_server_init(&foo,
                               &listener,
                               connections,
-                              NULL,
+                              "/www",
                               routes,
                               request_404_not_found) == 0);
+    BTASSERT(http_server_set_static_files(&foo, &static_files[0]) == 0);
+
+#if CONFIG_HTTP_SERVER_ROUTE_NODES_MAX > 0
+    /* The route index is used. */
+    BTASSERT(foo.route_index.length > 1);
+#endif
 
     BTASSERT(http_server_start(&foo) == 0);
 
@@ -516,6 +746,7 @@ static int test_request_url_too_long(void)
         "HTTP/1.1 400 Bad Request\r\n"
         "Content-Type: text/plain\r\n"
         "Content-Length: 32\r\n"
+        "Connection: close\r\n"
         "\r\n"
         "Failed to parse the HTTP header.";
 
@@ -553,6 +784,7 @@ static int test_request_header_field_too_long(void)
         "HTTP/1.1 400 Bad Request\r\n"
         "Content-Type: text/plain\r\n"
         "Content-Length: 32\r\n"
+        "Connection: close\r\n"
         "\r\n"
         "Failed to parse the HTTP header.";
 
@@ -566,6 +798,448 @@ static int test_request_header_field_too_long(void)
     return (0);
 }
 
+static int test_request_pipelined(void)
+{
+    char *str_p;
+    char buf[256];
+
+    /* Input the accept answer. */
+    socket_stub_accept();
+
+    /* Input two pipelined requests on the connection socket. The
+       second request asks the server to close the connection. */
+    str_p =
+        "GET /index.html HTTP/1.1\r\n"
+        "Connection: keep-alive\r\n"
+        "\r\n"
+        "GET /missing.html HTTP/1.1\r\n"
+        "Connection: close\r\n"
+        "\r\n";
+
+    socket_stub_input(str_p, strlen(str_p));
+
+    /* Read the responses and verify them. */
+    str_p =
+        "HTTP/1.1 200 OK\r\n"
+        "Content-Type: text/html\r\n"
+        "Content-Length: 8\r\n"
+        "\r\n"
+        "Welcome!"
+        "HTTP/1.1 404 Not Found\r\n"
+        "Content-Type: text/plain\r\n"
+        "Content-Length: 54\r\n"
+        "Connection: close\r\n"
+        "\r\n"
+        "The requested page '/missing.html' could not be found.";
+
+    socket_stub_output(buf, strlen(str_p));
+    buf[strlen(str_p)] = '\0';
+    BTASSERT(strcmp(buf, str_p) == 0);
+
+    socket_stub_wait_closed();
+
+    return (0);
+}
+
+static int test_request_max_requests(void)
+{
+    char *str_p;
+    char buf[256];
+    int i;
+
+    /* Input the accept answer. */
+    socket_stub_accept();
+
+    /* Input one request more than allowed on a connection. */
+    str_p =
+        "GET /index.html HTTP/1.1\r\n"
+        "\r\n";
+
+    for (i = 0; i < CONFIG_HTTP_SERVER_KEEP_ALIVE_MAX_REQUESTS + 1; i++) {
+        socket_stub_input(str_p, strlen(str_p));
+    }
+
+    /* All but the last response keeps the connection open. */
+    str_p =
+        "HTTP/1.1 200 OK\r\n"
+        "Content-Type: text/html\r\n"
+        "Content-Length: 8\r\n"
+        "\r\n"
+        "Welcome!";
+
+    for (i = 0; i < CONFIG_HTTP_SERVER_KEEP_ALIVE_MAX_REQUESTS - 1; i++) {
+        socket_stub_output(buf, strlen(str_p));
+        buf[strlen(str_p)] = '\0';
+        BTASSERT(strcmp(buf, str_p) == 0);
+    }
+
+    str_p =
+        "HTTP/1.1 200 OK\r\n"
+        "Content-Type: text/html\r\n"
+        "Content-Length: 8\r\n"
+        "Connection: close\r\n"
+        "\r\n"
+        "Welcome!";
+
+    socket_stub_output(buf, strlen(str_p));
+    buf[strlen(str_p)] = '\0';
+    BTASSERT(strcmp(buf, str_p) == 0);
+
+    socket_stub_wait_closed();
+    socket_stub_input_flush();
+
+    return (0);
+}
+
+static int test_request_close_idle(void)
+{
+    char *str_p;
+    char buf[256];
+    struct time_t start;
+    struct time_t stop;
+    struct time_t elapsed;
+
+    /* Input the accept answer. */
+    socket_stub_accept();
+
+    str_p =
+        "GET /index.html HTTP/1.1\r\n"
+        "\r\n";
+
+    socket_stub_input(str_p, strlen(str_p));
+
+    str_p =
+        "HTTP/1.1 200 OK\r\n"
+        "Content-Type: text/html\r\n"
+        "Content-Length: 8\r\n"
+        "\r\n"
+        "Welcome!";
+
+    socket_stub_output(buf, strlen(str_p));
+    buf[strlen(str_p)] = '\0';
+    BTASSERT(strcmp(buf, str_p) == 0);
+
+    /* The only connection thread is now idle. A new client closes it
+       long before the idle timeout. */
+    time_get(&start);
+    socket_stub_accept();
+    socket_stub_wait_closed();
+    time_get(&stop);
+    time_subtract(&elapsed, &stop, &start);
+    BTASSERT(elapsed.seconds == 0);
+    BTASSERT(elapsed.nanoseconds
+             < CONFIG_HTTP_SERVER_KEEP_ALIVE_TIMEOUT_MS * 1000000 / 2);
+
+    /* The new client is served by the freed connection thread. */
+    str_p =
+        "GET /index.html HTTP/1.1\r\n"
+        "Connection: close\r\n"
+        "\r\n";
+
+    socket_stub_input(str_p, strlen(str_p));
+
+    str_p =
+        "HTTP/1.1 200 OK\r\n"
+        "Content-Type: text/html\r\n"
+        "Content-Length: 8\r\n"
+        "Connection: close\r\n"
+        "\r\n"
+        "Welcome!";
+
+    socket_stub_output(buf, strlen(str_p));
+    buf[strlen(str_p)] = '\0';
+    BTASSERT(strcmp(buf, str_p) == 0);
+
+    socket_stub_wait_closed();
+
+    return (0);
+}
+
+/**
+ * Input given request on a new connection and verify the response.
+ */
+static int request_and_verify(const char *request_p,
+                              const char *response_p)
+{
+    char buf[256];
+
+    socket_stub_accept();
+    socket_stub_input((void *)request_p, strlen(request_p));
+    socket_stub_output(buf, strlen(response_p));
+    buf[strlen(response_p)] = '\0';
+    BTASSERT(strcmp(buf, response_p) == 0);
+    socket_stub_wait_closed();
+
+    return (0);
+}
+
+static int test_request_static(void)
+{
+    /* The gzip compressed file is preferred if accepted. */
+    BTASSERT(request_and_verify(
+                 "GET /static/app.js HTTP/1.1\r\n"
+                 "Accept-Encoding: gzip, deflate\r\n"
+                 "Connection: close\r\n"
+                 "\r\n",
+                 "HTTP/1.1 200 OK\r\n"
+                 "Content-Type: application/javascript\r\n"
+                 "Content-Length: 16\r\n"
+                 "Content-Encoding: gzip\r\n"
+                 "ETag: \"1234abcd\"\r\n"
+                 "Connection: close\r\n"
+                 "\r\n"
+                 "<gzipped app.js>") == 0);
+
+    /* Not accepting gzip, and the query string is ignored. */
+    BTASSERT(request_and_verify(
+                 "GET /static/app.js?v=2 HTTP/1.1\r\n"
+                 "Connection: close\r\n"
+                 "\r\n",
+                 "HTTP/1.1 200 OK\r\n"
+                 "Content-Type: application/javascript\r\n"
+                 "Content-Length: 10\r\n"
+                 "ETag: \"5678abcd\"\r\n"
+                 "Connection: close\r\n"
+                 "\r\n"
+                 "var a = 1;") == 0);
+
+    /* Not modified since the client has the file. */
+    BTASSERT(request_and_verify(
+                 "GET /static/app.js HTTP/1.1\r\n"
+                 "If-None-Match: \"5678abcd\"\r\n"
+                 "Connection: close\r\n"
+                 "\r\n",
+                 "HTTP/1.1 304 Not Modified\r\n"
+                 "ETag: \"5678abcd\"\r\n"
+                 "Connection: close\r\n"
+                 "\r\n") == 0);
+
+    return (0);
+}
+
+static int test_request_static_fs(void)
+{
+    /* Streamed in chunks of CONFIG_HTTP_SERVER_STATIC_CHUNK_SIZE
+       bytes. */
+    BTASSERT(request_and_verify(
+                 "GET /files/hello.txt HTTP/1.1\r\n"
+                 "Accept-Encoding: gzip\r\n"
+                 "Connection: close\r\n"
+                 "\r\n",
+                 "HTTP/1.1 200 OK\r\n"
+                 "Content-Type: text/plain\r\n"
+                 "Transfer-Encoding: chunked\r\n"
+                 "Connection: close\r\n"
+                 "\r\n"
+                 "10\r\n"
+                 "Hello from the f\r\n"
+                 "b\r\n"
+                 "ile system!\r\n"
+                 "0\r\n"
+                 "\r\n") == 0);
+
+    /* The gzip compressed file is served in place of the missing
+       file. */
+    BTASSERT(request_and_verify(
+                 "GET /files/style.css HTTP/1.1\r\n"
+                 "Accept-Encoding: deflate, gzip\r\n"
+                 "Connection: close\r\n"
+                 "\r\n",
+                 "HTTP/1.1 200 OK\r\n"
+                 "Content-Type: text/css\r\n"
+                 "Transfer-Encoding: chunked\r\n"
+                 "Content-Encoding: gzip\r\n"
+                 "Connection: close\r\n"
+                 "\r\n"
+                 "10\r\n"
+                 "<gzipped style.c\r\n"
+                 "3\r\n"
+                 "ss>\r\n"
+                 "0\r\n"
+                 "\r\n") == 0);
+
+    /* Missing files are passed to the no route callback. */
+    BTASSERT(request_and_verify(
+                 "GET /files/missing.txt HTTP/1.1\r\n"
+                 "Connection: close\r\n"
+                 "\r\n",
+                 "HTTP/1.1 404 Not Found\r\n"
+                 "Content-Type: text/plain\r\n"
+                 "Content-Length: 59\r\n"
+                 "Connection: close\r\n"
+                 "\r\n"
+                 "The requested page '/files/missing.txt' could not "
+                 "be found.") == 0);
+
+    return (0);
+}
+
+static int test_request_route_params(void)
+{
+    BTASSERT(request_and_verify(
+                 "GET /api/sensors/42?unit=celsius HTTP/1.1\r\n"
+                 "Connection: close\r\n"
+                 "\r\n",
+                 "HTTP/1.1 200 OK\r\n"
+                 "Content-Type: text/plain\r\n"
+                 "Content-Length: 6\r\n"
+                 "Connection: close\r\n"
+                 "\r\n"
+                 "get 42") == 0);
+
+    /* The POST handler comes first in the routes array. */
+    BTASSERT(request_and_verify(
+                 "POST /api/sensors/7 HTTP/1.1\r\n"
+                 "Connection: close\r\n"
+                 "\r\n",
+                 "HTTP/1.1 200 OK\r\n"
+                 "Content-Type: text/plain\r\n"
+                 "Content-Length: 6\r\n"
+                 "Connection: close\r\n"
+                 "\r\n"
+                 "post 7") == 0);
+
+    BTASSERT(request_and_verify(
+                 "GET /api/sensors/7/values/3 HTTP/1.1\r\n"
+                 "Connection: close\r\n"
+                 "\r\n",
+                 "HTTP/1.1 200 OK\r\n"
+                 "Content-Type: text/plain\r\n"
+                 "Content-Length: 3\r\n"
+                 "Connection: close\r\n"
+                 "\r\n"
+                 "7:3") == 0);
+
+    /* Only GET is routed for the values. */
+    BTASSERT(request_and_verify(
+                 "POST /api/sensors/7/values/3 HTTP/1.1\r\n"
+                 "Connection: close\r\n"
+                 "\r\n",
+                 "HTTP/1.1 404 Not Found\r\n"
+                 "Content-Type: text/plain\r\n"
+                 "Content-Length: 64\r\n"
+                 "Connection: close\r\n"
+                 "\r\n"
+                 "The requested page '/api/sensors/7/values/3' could not "
+                 "be found.") == 0);
+
+    /* A path parameter does not match an empty segment. */
+    BTASSERT(request_and_verify(
+                 "GET /api/sensors/ HTTP/1.1\r\n"
+                 "Connection: close\r\n"
+                 "\r\n",
+                 "HTTP/1.1 404 Not Found\r\n"
+                 "Content-Type: text/plain\r\n"
+                 "Content-Length: 54\r\n"
+                 "Connection: close\r\n"
+                 "\r\n"
+                 "The requested page '/api/sensors/' could not "
+                 "be found.") == 0);
+
+    /* Routes not ending with a '/' match the whole path. */
+    BTASSERT(request_and_verify(
+                 "GET /index.html.bak HTTP/1.1\r\n"
+                 "Connection: close\r\n"
+                 "\r\n",
+                 "HTTP/1.1 404 Not Found\r\n"
+                 "Content-Type: text/plain\r\n"
+                 "Content-Length: 56\r\n"
+                 "Connection: close\r\n"
+                 "\r\n"
+                 "The requested page '/index.html.bak' could not "
+                 "be found.") == 0);
+
+    return (0);
+}
+
+/**
+ * Read one line, including the CRLF, from the connection socket.
+ */
+static int read_line(char *buf_p, size_t size)
+{
+    size_t i;
+
+    for (i = 0; i < size - 1; i++) {
+        socket_stub_output(&buf_p[i], 1);
+
+        if ((i > 0) && (buf_p[i - 1] == '\r') && (buf_p[i] == '\n')) {
+            buf_p[i + 1] = '\0';
+
+            return (0);
+        }
+    }
+
+    return (-1);
+}
+
+static int test_request_metrics(void)
+{
+    struct fs_counter_t counter;
+    char line[96];
+    char body[1024];
+    const char *request_p;
+    long size;
+    size_t pos;
+
+    BTASSERT(fs_counter_init(&counter,
+                             FSTR("/test/http_server/metrics"),
+                             1234567890123ULL) == 0);
+    BTASSERT(fs_counter_register(&counter) == 0);
+
+    request_p =
+        "GET /metrics HTTP/1.1\r\n"
+        "Connection: close\r\n"
+        "\r\n";
+    socket_stub_accept();
+    socket_stub_input((void *)request_p, strlen(request_p));
+
+    BTASSERT(read_line(&line[0], sizeof(line)) == 0);
+    BTASSERTM(&line[0], "HTTP/1.1 200 OK\r\n", 18);
+    BTASSERT(read_line(&line[0], sizeof(line)) == 0);
+    BTASSERTM(&line[0],
+              "Content-Type: application/openmetrics-text; "
+              "version=1.0.0; charset=utf-8\r\n",
+              73);
+    BTASSERT(read_line(&line[0], sizeof(line)) == 0);
+    BTASSERTM(&line[0], "Transfer-Encoding: chunked\r\n", 29);
+    BTASSERT(read_line(&line[0], sizeof(line)) == 0);
+    BTASSERTM(&line[0], "Connection: close\r\n", 20);
+    BTASSERT(read_line(&line[0], sizeof(line)) == 0);
+    BTASSERTM(&line[0], "\r\n", 3);
+
+    /* Concatenate the chunks, all but the last at most
+       CONFIG_HTTP_SERVER_STATIC_CHUNK_SIZE bytes. */
+    pos = 0;
+
+    while (1) {
+        BTASSERT(read_line(&line[0], sizeof(line)) == 0);
+        BTASSERT(std_strtolb(&line[0], &size, 16) != NULL);
+        BTASSERT(size <= CONFIG_HTTP_SERVER_STATIC_CHUNK_SIZE);
+        BTASSERT(pos + size < sizeof(body));
+        socket_stub_output(&body[pos], size + 2);
+        BTASSERTM(&body[pos + size], "\r\n", 2);
+
+        if (size == 0) {
+            break;
+        }
+
+        pos += size;
+    }
+
+    body[pos] = '\0';
+    socket_stub_wait_closed();
+
+    BTASSERT(strstr(&body[0], "# TYPE fs_counter counter\n") == &body[0]);
+    BTASSERT(strstr(&body[0],
+                    "\nfs_counter_total{path=\"/test/http_server/metrics\"} "
+                    "1234567890123\n") != NULL);
+    BTASSERT(strcmp(&body[pos - 6], "# EOF\n") == 0);
+
+    BTASSERT(fs_counter_deregister(&counter) == 0);
+
+    return (0);
+}
+
 static int test_stop(void)
 {
     BTASSERT(http_server_stop(&foo) == 0);
@@ -635,8 +1309,8 @@ static int test_https_stop(void)
     BTASSERT(ssl_open_counter == 6);
     BTASSERT(ssl_close_counter == 6);
     BTASSERT(ssl_write_counter == 9);
-    BTASSERT(ssl_read_counter == 730);
-    BTASSERT(ssl_size_counter == 0);
+    BTASSERT(ssl_read_counter == 8);
+    BTASSERT(ssl_size_counter == 13);
 
     return (0);
 #else
@@ -647,6 +1321,13 @@ static int test_https_stop(void)
 int main()
 {
     struct harness_testcase_t testcases[] = {
+        { test_reactor_start, "test_reactor_start" },
+        { test_request_index, "test_reactor_request_index" },
+        { test_request_pipelined, "test_reactor_request_pipelined" },
+        { test_request_max_requests, "test_reactor_request_max_requests" },
+        { test_request_close_idle, "test_reactor_request_close_idle" },
+        { test_request_no_route, "test_reactor_request_no_route" },
+        { test_reactor_stop, "test_reactor_stop" },
         { test_start, "test_start" },
         { test_request_index, "test_request_index" },
         { test_request_index_with_query_string, "test_request_index_with_query_string" },
@@ -656,6 +1337,13 @@ int main()
         { test_request_no_route, "test_request_no_route" },
         { test_request_url_too_long, "test_request_url_too_long" },
         { test_request_header_field_too_long, "test_request_header_field_too_long" },
+        { test_request_pipelined, "test_request_pipelined" },
+        { test_request_max_requests, "test_request_max_requests" },
+        { test_request_close_idle, "test_request_close_idle" },
+        { test_request_static, "test_request_static" },
+        { test_request_static_fs, "test_request_static_fs" },
+        { test_request_route_params, "test_request_route_params" },
+        { test_request_metrics, "test_request_metrics" },
         { test_stop, "test_stop" },
         { test_https_start, "test_https_start" },
 #if CONFIG_HTTP_SERVER_SSL == 1
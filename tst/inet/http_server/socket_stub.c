@@ -34,6 +34,8 @@ static char qinputbuf[256];
 static char qoutputbuf[256];
 static struct event_t accept_events;
 static struct event_t closed_events;
+static struct socket_t *listener_p = NULL;
+static struct socket_t *accepted_p = NULL;
 
 static ssize_t read(void *self_p,
                     void *buf_p,
@@ -51,7 +53,31 @@ static ssize_t write(void *self_p,
 
 static size_t size(void *self_p)
 {
-    return (0);
+    return (chan_size(&qinput));
+}
+
+static size_t listener_size(void *self_p)
+{
+    return (event_size(&accept_events));
+}
+
+/**
+ * Resume any thread polling given socket.
+ */
+static void resume_if_polled(struct socket_t *socket_p)
+{
+    if (socket_p == NULL) {
+        return;
+    }
+
+    sys_lock();
+
+    if (chan_is_polled_isr(&socket_p->base)) {
+        thrd_resume_isr(socket_p->base.reader_p, 0);
+        socket_p->base.reader_p = NULL;
+    }
+
+    sys_unlock();
 }
 
 int socket_module_init()
@@ -96,7 +122,9 @@ int socket_bind(struct socket_t *self_p,
 
 int socket_listen(struct socket_t *self_p, int backlog)
 {
-    return (0);
+    listener_p = self_p;
+
+    return (chan_init(&self_p->base, read, write, listener_size));
 }
 
 int socket_connect(struct socket_t *self_p,
@@ -106,13 +134,14 @@ int socket_connect(struct socket_t *self_p,
 }
 
 int socket_accept(struct socket_t *self_p,
-                  struct socket_t *accepted_p,
+                  struct socket_t *socket_p,
                   struct inet_addr_t *addr_p)
 {
     uint32_t mask;
 
-    chan_init(&accepted_p->base, read, write, size);
-    
+    chan_init(&socket_p->base, read, write, size);
+    accepted_p = socket_p;
+
     mask = 0x1;
     event_read(&accept_events, &mask, sizeof(mask));
 
@@ -144,6 +173,13 @@ ssize_t socket_write(struct socket_t *self_p,
     return (write(NULL, buf_p, size));
 }
 
+ssize_t socket_writev(struct socket_t *self_p,
+                      const struct iov_t *iov_p,
+                      size_t length)
+{
+    return (-ENOSYS);
+}
+
 ssize_t socket_read(struct socket_t *self_p,
                     void *buf_p,
                     size_t size)
@@ -165,11 +201,13 @@ void socket_stub_accept()
 
     mask = 0x1;
     event_write(&accept_events, &mask, sizeof(mask));
+    resume_if_polled(listener_p);
 }
 
 void socket_stub_input(void *buf_p, size_t size)
 {
     chan_write(&qinput, buf_p, size);
+    resume_if_polled(accepted_p);
 }
 
 void socket_stub_output(void *buf_p, size_t size)
@@ -51,6 +51,7 @@ int ssl_socket_open(struct ssl_socket_t *self_p,
     BTASSERT(flags & SSL_SOCKET_SERVER_SIDE);
 
     ssl_open_counter++;
+    self_p->socket_p = socket_p;
 
     return (chan_init(&self_p->base,
                       (chan_read_fn_t)ssl_socket_read,
@@ -89,10 +90,9 @@ ssize_t ssl_socket_read(struct ssl_socket_t *self_p,
 
 ssize_t ssl_socket_size(struct ssl_socket_t *self_p)
 {
-    PRINT_FILE_LINE();
     BTASSERT(self_p != NULL);
 
     ssl_size_counter++;
 
-    return (0);
+    return (chan_size(self_p->socket_p));
 }
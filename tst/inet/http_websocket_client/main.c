@@ -66,6 +66,10 @@ static int test_connect(void)
         "Upgrade: WebSocket\r\n"
         "Connection: Upgrade\r\n"
         "Origin: SimbaWebSocketClient\r\n"
+#if CONFIG_HTTP_WEBSOCKET_DEFLATE == 1
+        "Sec-WebSocket-Extensions: permessage-deflate; "
+        "server_max_window_bits=10; client_max_window_bits=10\r\n"
+#endif
         "\r\n";
     socket_stub_output(buf, strlen(str_p));
     buf[strlen(str_p)] = '\0';
@@ -222,6 +226,115 @@ static int test_write(void)
     return (0);
 }
 
+#if CONFIG_HTTP_WEBSOCKET_DEFLATE == 1
+
+static int connect_deflate(const char *response_p)
+{
+    char *str_p;
+    int res;
+
+    socket_stub_init();
+
+    BTASSERT(http_websocket_client_init(&foo,
+                                        "localhost",
+                                        8090,
+                                        "/") == 0);
+
+    str_p = "HTTP/1.1 101 Switching Protocols\r\n";
+    socket_stub_input(str_p, strlen(str_p));
+    socket_stub_input((void *)response_p, strlen(response_p));
+    str_p = "\r\n";
+    socket_stub_input(str_p, strlen(str_p));
+
+    res = http_websocket_client_connect(&foo);
+
+    /* Drop the request. */
+    str_p =
+        "GET / HTTP/1.1\r\n"
+        "Host: localhost\r\n"
+        "Upgrade: WebSocket\r\n"
+        "Connection: Upgrade\r\n"
+        "Origin: SimbaWebSocketClient\r\n"
+        "Sec-WebSocket-Extensions: permessage-deflate; "
+        "server_max_window_bits=10; client_max_window_bits=10\r\n"
+        "\r\n";
+    socket_stub_output(buf, strlen(str_p));
+
+    return (res);
+}
+
+static int test_connect_deflate(void)
+{
+    /* Parameters not offered. */
+    BTASSERT(connect_deflate("Sec-WebSocket-Extensions: "
+                             "permessage-deflate; "
+                             "server_max_window_bits=12\r\n") == -EPROTO);
+    BTASSERT(connect_deflate("Sec-WebSocket-Extensions: "
+                             "permessage-deflate; "
+                             "client_max_window_bits\r\n") == -EPROTO);
+    BTASSERT(connect_deflate("Sec-WebSocket-Extensions: x-foo\r\n")
+             == -EPROTO);
+
+    /* Accepted with a smaller client window. */
+    BTASSERT(connect_deflate("Upgrade: websocket\r\n"
+                             "sec-websocket-extensions: "
+                             "permessage-deflate;client_max_window_bits=9\r\n")
+             == 0);
+    BTASSERT(foo.deflate.enabled == 1);
+    BTASSERT(foo.deflate.output.window_bits == 9);
+    BTASSERT(foo.deflate.input.window_bits == 10);
+
+    return (0);
+}
+
+static int test_read_deflate(void)
+{
+    /* Compressed by zlib with a 1024 bytes window. */
+    static const uint8_t message_1[] = {
+        0xc1, 0x13,
+        0xf2, 0x48, 0xcd, 0xc9, 0xc9, 0xd7, 0x51, 0x28, 0xcf, 0x2f,
+        0xca, 0x49, 0x51, 0x54, 0xf0, 0x40, 0xe6, 0x01, 0x00
+    };
+    static const uint8_t message_2[] = {
+        0x41, 0x02, 0x42, 0xe1,
+        0x80, 0x02, 0x00, 0x00
+    };
+
+    socket_stub_input((void *)&message_1[0], sizeof(message_1));
+    socket_stub_input((void *)&message_2[0], sizeof(message_2));
+    buf[0] = 0x81;
+    buf[1] = 0x03;
+    memcpy(&buf[2], "foo", 3);
+    socket_stub_input(buf, 5);
+
+    /* Messages are read as a stream. */
+    BTASSERT(http_websocket_client_read(&foo, buf, 20) == 20);
+    BTASSERT(memcmp(buf, "Hello, world! Hello,", 20) == 0);
+    BTASSERT(http_websocket_client_read(&foo, buf, 23) == 23);
+    BTASSERT(memcmp(buf, " world!Hello, world!foo", 23) == 0);
+
+    return (0);
+}
+
+static int test_write_deflate(void)
+{
+    static const uint8_t frame[] = {
+        0xc2, 0x87, 0x00, 0x00, 0x00, 0x00,
+        0xf2, 0x48, 0xcd, 0xc9, 0xc9, 0x07, 0x00
+    };
+
+    BTASSERT(http_websocket_client_write(&foo,
+                                         HTTP_TYPE_BINARY,
+                                         "Hello",
+                                         5) == 5);
+    socket_stub_output(buf, sizeof(frame));
+    BTASSERT(memcmp(buf, &frame[0], sizeof(frame)) == 0);
+
+    return (0);
+}
+
+#endif
+
 static int test_disconnect(void)
 {
     BTASSERT(http_websocket_client_disconnect(&foo) == 0);
@@ -235,6 +348,11 @@ int main()
         { test_connect, "test_connect" },
         { test_read, "test_read" },
         { test_write, "test_write" },
+#if CONFIG_HTTP_WEBSOCKET_DEFLATE == 1
+        { test_connect_deflate, "test_connect_deflate" },
+        { test_read_deflate, "test_read_deflate" },
+        { test_write_deflate, "test_write_deflate" },
+#endif
         { test_disconnect, "test_disconnect" },
         { NULL, NULL }
     };
@@ -100,6 +100,12 @@ int socket_connect(struct socket_t *self_p,
     return (0);
 }
 
+int socket_gethostbyname(const char *hostname_p,
+                         struct inet_ip_addr_t *ip_p)
+{
+    return (inet_aton(hostname_p, ip_p));
+}
+
 int socket_accept(struct socket_t *self_p,
                   struct socket_t *accepted_p,
                   struct inet_addr_t *addr_p)
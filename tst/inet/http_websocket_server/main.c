@@ -60,6 +60,7 @@ static int test_handshake(void)
     request.action = http_server_request_action_get_t;
     request.headers.sec_websocket_key.present = 1;
     strcpy(request.headers.sec_websocket_key.value, "");
+    request.headers.sec_websocket_extensions.present = 0;
 
     /* Perform the handshake. */
     BTASSERT(http_websocket_server_handshake(&server,
@@ -82,6 +83,7 @@ static int test_handshake_key_missing(void)
     /* Initialize the request.*/
     request.action = http_server_request_action_get_t;
     request.headers.sec_websocket_key.present = 0;
+    request.headers.sec_websocket_extensions.present = 0;
 
     /* Perform the handshake. */
     BTASSERT(http_websocket_server_handshake(&server,
@@ -98,6 +100,7 @@ static int test_handshake_bad_action(void)
     request.action = http_server_request_action_get_t + 1;
     request.headers.sec_websocket_key.present = 1;
     strcpy(request.headers.sec_websocket_key.value, "");
+    request.headers.sec_websocket_extensions.present = 0;
 
     /* Perform the handshake. */
     BTASSERT(http_websocket_server_handshake(&server,
@@ -224,6 +227,80 @@ static int test_read(void)
     return (0);
 }
 
+static int test_read_unaligned(void)
+{
+    int type;
+    int i;
+    uint8_t masking_key[4] = { 0x11, 0x22, 0x33, 0x44 };
+
+    /* Prepare socket input with 37 bytes of masked payload. */
+    buf[0] = 0x82; /* FIN & BINARY. */
+    buf[1] = 0xa5; /* MASK and 1 byte payload length. */
+    memcpy(&buf[2], &masking_key[0], 4);
+
+    for (i = 0; i < 37; i++) {
+        buf[6 + i] = (i ^ masking_key[i % 4]);
+    }
+
+    socket_stub_input(buf, 43);
+
+    /* Unmask into an unaligned buffer. */
+    BTASSERT(http_websocket_server_read(&server,
+                                        &type,
+                                        &buf[1],
+                                        sizeof(buf) - 1) == 37);
+
+    for (i = 0; i < 37; i++) {
+        BTASSERT(buf[1 + i] == i);
+    }
+
+    /* The payload does not fit in the given buffer. The leftover
+       data is discarded in chunks. */
+    buf[0] = 0x82;
+    buf[1] = 0xa5;
+    memcpy(&buf[2], &masking_key[0], 4);
+
+    for (i = 0; i < 37; i++) {
+        buf[6 + i] = (i ^ masking_key[i % 4]);
+    }
+
+    socket_stub_input(buf, 43);
+
+    BTASSERT(http_websocket_server_read(&server,
+                                        &type,
+                                        &buf[3],
+                                        6) == 6);
+
+    for (i = 0; i < 6; i++) {
+        BTASSERT(buf[3 + i] == i);
+    }
+
+    return (0);
+}
+
+static int test_writev(void)
+{
+    struct iov_t iov[2];
+
+    iov[0].buf_p = "foo";
+    iov[0].size = 3;
+    iov[1].buf_p = "bar";
+    iov[1].size = 3;
+
+    BTASSERT(http_websocket_server_writev(&server,
+                                          HTTP_TYPE_TEXT,
+                                          &iov[0],
+                                          2) == 6);
+
+    /* One frame with both buffers as payload. */
+    socket_stub_output(buf, 2 + 6);
+    BTASSERT(buf[0] == 0x81); /* FIN & TEXT. */
+    BTASSERT(buf[1] == 0x06); /* 6 bytes of payload. */
+    BTASSERT(memcmp(&buf[2], "foobar", 6) == 0);
+
+    return (0);
+}
+
 static int test_write(void)
 {
     buf[0] = 'f';
@@ -294,6 +371,261 @@ static int test_write(void)
     return (0);
 }
 
+#if CONFIG_HTTP_WEBSOCKET_DEFLATE == 1
+
+static int handshake_deflate(const char *offer_p, const char *response_p)
+{
+    struct http_server_request_t request;
+    char expected[320];
+    size_t size;
+
+    request.action = http_server_request_action_get_t;
+    request.headers.sec_websocket_key.present = 1;
+    strcpy(request.headers.sec_websocket_key.value, "");
+    request.headers.sec_websocket_extensions.present = 1;
+    strcpy(request.headers.sec_websocket_extensions.value, offer_p);
+
+    BTASSERT(http_websocket_server_handshake(&server, &request) == 0);
+
+    strcpy(&expected[0],
+           "HTTP/1.1 101 Switching Protocols\r\n"
+           "Upgrade: websocket\r\n"
+           "Connection: Upgrade\r\n"
+           "Sec-WebSocket-Accept: Kfh9QIsMVZcl6xEPYxPHzW8SZ8w=\r\n");
+
+    if (response_p != NULL) {
+        strcat(&expected[0], "Sec-WebSocket-Extensions: ");
+        strcat(&expected[0], response_p);
+        strcat(&expected[0], "\r\n");
+    }
+
+    strcat(&expected[0], "\r\n");
+    size = strlen(&expected[0]);
+    socket_stub_output(buf, size);
+    buf[size] = '\0';
+    BTASSERT(strcmp((char *)buf, &expected[0]) == 0);
+
+    return (0);
+}
+
+static int test_handshake_deflate(void)
+{
+    /* Offers with unknown parameters are declined. */
+    BTASSERT(handshake_deflate("permessage-deflate; foo=1", NULL) == 0);
+    BTASSERT(handshake_deflate("permessage-deflate; "
+                               "server_max_window_bits=7",
+                               NULL) == 0);
+    BTASSERT(server.deflate.enabled == 0);
+
+    /* The first valid offer is accepted. The window sizes are limited
+       by the configured window size. */
+    BTASSERT(handshake_deflate(
+                 "permessage-deflate; client_max_window_bits=16, "
+                 "permessage-deflate; server_max_window_bits=\"9\"; "
+                 "server_no_context_takeover",
+                 "permessage-deflate; server_max_window_bits=9; "
+                 "server_no_context_takeover; "
+                 "client_no_context_takeover") == 0);
+    BTASSERT(server.deflate.enabled == 1);
+
+    BTASSERT(handshake_deflate("permessage-deflate; client_max_window_bits",
+                               "permessage-deflate; "
+                               "server_max_window_bits=10; "
+                               "client_max_window_bits=10") == 0);
+    BTASSERT(server.deflate.enabled == 1);
+
+    return (0);
+}
+
+static void input_compressed_frame(uint8_t opcode,
+                                   const uint8_t *payload_p,
+                                   size_t size)
+{
+    uint8_t masking_key[4] = { 0x11, 0x22, 0x33, 0x44 };
+    size_t i;
+
+    buf[0] = opcode;
+    buf[1] = (INET_HTTP_WEBSOCKET_MASK | size);
+    memcpy(&buf[2], &masking_key[0], 4);
+
+    for (i = 0; i < size; i++) {
+        buf[6 + i] = (payload_p[i] ^ masking_key[i % 4]);
+    }
+
+    socket_stub_input(buf, 6 + size);
+}
+
+static int test_read_deflate(void)
+{
+    int type;
+    /* Compressed by zlib with a 1024 bytes window. */
+    static const uint8_t message_1[] = {
+        0xf2, 0x48, 0xcd, 0xc9, 0xc9, 0xd7, 0x51, 0x28, 0xcf, 0x2f,
+        0xca, 0x49, 0x51, 0x54, 0xf0, 0x40, 0xe6, 0x01, 0x00
+    };
+    static const uint8_t message_2[] = {
+        0x42, 0xe1, 0x00, 0x00
+    };
+
+    /* One frame. */
+    input_compressed_frame(0xc1, &message_1[0], sizeof(message_1));
+
+    BTASSERT(http_websocket_server_read(&server,
+                                        &type,
+                                        buf,
+                                        sizeof(buf)) == 27);
+    BTASSERT(memcmp(buf, "Hello, world! Hello, world!", 27) == 0);
+
+    /* Two frames, referring to the previous message. */
+    input_compressed_frame(0x41, &message_2[0], 2);
+    input_compressed_frame(0x80, &message_2[2], 2);
+
+    BTASSERT(http_websocket_server_read(&server,
+                                        &type,
+                                        buf,
+                                        sizeof(buf)) == 13);
+    BTASSERT(memcmp(buf, "Hello, world!", 13) == 0);
+
+    /* Truncated. */
+    input_compressed_frame(0xc1, &message_2[0], sizeof(message_2));
+
+    BTASSERT(http_websocket_server_read(&server, &type, buf, 5) == 5);
+    BTASSERT(memcmp(buf, "Hello", 5) == 0);
+
+    /* Uncompressed messages are still accepted. */
+    input_compressed_frame(0x81, (const uint8_t *)"foo", 3);
+
+    BTASSERT(http_websocket_server_read(&server,
+                                        &type,
+                                        buf,
+                                        sizeof(buf)) == 3);
+    BTASSERT(memcmp(buf, "foo", 3) == 0);
+
+    return (0);
+}
+
+static int test_write_deflate(void)
+{
+    static const uint8_t message_1[] = {
+        0xc2, 0x07, 0xf2, 0x48, 0xcd, 0xc9, 0xc9, 0x07, 0x00
+    };
+    static const uint8_t message_2[] = {
+        0xc2, 0x04, 0x02, 0x13, 0x00, 0x00
+    };
+
+    BTASSERT(http_websocket_server_write(&server,
+                                         HTTP_TYPE_BINARY,
+                                         "Hello",
+                                         5) == 5);
+    socket_stub_output(buf, sizeof(message_1));
+    BTASSERT(memcmp(buf, &message_1[0], sizeof(message_1)) == 0);
+
+    /* Refers to the previous message. */
+    BTASSERT(http_websocket_server_write(&server,
+                                         HTTP_TYPE_BINARY,
+                                         "Hello",
+                                         5) == 5);
+    socket_stub_output(buf, sizeof(message_2));
+    BTASSERT(memcmp(buf, &message_2[0], sizeof(message_2)) == 0);
+
+    return (0);
+}
+
+#if defined(ARCH_LINUX)
+
+static int test_write_deflate_frames(void)
+{
+    static uint8_t data[1024];
+    int type;
+    size_t i;
+    size_t size;
+    size_t frame_size;
+    uint32_t value;
+    int frames;
+    struct iov_t iov[2];
+
+    BTASSERT(handshake_deflate("permessage-deflate; "
+                               "server_no_context_takeover; "
+                               "client_no_context_takeover",
+                               "permessage-deflate; "
+                               "server_max_window_bits=10; "
+                               "server_no_context_takeover; "
+                               "client_no_context_takeover") == 0);
+
+    /* Hardly compressible data. */
+    value = 1;
+
+    for (i = 0; i < sizeof(data); i++) {
+        value = (1103515245 * value + 12345);
+        data[i] = (value >> 16);
+    }
+
+    iov[0].buf_p = &data[0];
+    iov[0].size = 512;
+    iov[1].buf_p = &data[512];
+    iov[1].size = 512;
+
+    BTASSERT(http_websocket_server_writev(&server,
+                                          HTTP_TYPE_BINARY,
+                                          &iov[0],
+                                          2) == sizeof(data));
+
+    /* Frames of at most the configured size. Only the first has the
+       RSV1 bit set. */
+    size = 0;
+    frames = 0;
+
+    while (1) {
+        socket_stub_output(&buf[size], 2);
+
+        if (frames == 0) {
+            BTASSERT((buf[size] & 0x7f) == 0x42);
+        } else {
+            BTASSERT((buf[size] & 0x7f) == 0x00);
+        }
+
+        frame_size = buf[size + 1];
+
+        if (frame_size == 126) {
+            socket_stub_output(&buf[size + 2], 2);
+            frame_size = ((buf[size + 2] << 8) | buf[size + 3]);
+            BTASSERT(frame_size <= CONFIG_HTTP_WEBSOCKET_DEFLATE_FRAME_SIZE);
+            socket_stub_output(&buf[size + 4], frame_size);
+            frame_size += 4;
+        } else {
+            socket_stub_output(&buf[size + 2], frame_size);
+            frame_size += 2;
+        }
+
+        frames++;
+
+        if (buf[size] & INET_HTTP_WEBSOCKET_FIN) {
+            size += frame_size;
+            break;
+        }
+
+        size += frame_size;
+    }
+
+    BTASSERT(frames > 1);
+
+    /* Read the written message. */
+    socket_stub_input(buf, size);
+    memset(buf, 0, sizeof(data));
+
+    BTASSERT(http_websocket_server_read(&server,
+                                        &type,
+                                        buf,
+                                        sizeof(buf)) == sizeof(data));
+    BTASSERT(memcmp(buf, &data[0], sizeof(data)) == 0);
+
+    return (0);
+}
+
+#endif
+
+#endif
+
 int main()
 {
     struct harness_testcase_t testcases[] = {
@@ -302,7 +634,17 @@ int main()
         { test_handshake_key_missing, "test_handshake_key_missing" },
         { test_handshake_bad_action, "test_handshake_bad_action" },
         { test_read, "test_read" },
+        { test_read_unaligned, "test_read_unaligned" },
         { test_write, "test_write" },
+        { test_writev, "test_writev" },
+#if CONFIG_HTTP_WEBSOCKET_DEFLATE == 1
+        { test_handshake_deflate, "test_handshake_deflate" },
+        { test_read_deflate, "test_read_deflate" },
+        { test_write_deflate, "test_write_deflate" },
+#    if defined(ARCH_LINUX)
+        { test_write_deflate_frames, "test_write_deflate_frames" },
+#    endif
+#endif
         { NULL, NULL }
     };
 
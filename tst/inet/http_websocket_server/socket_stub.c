@@ -132,6 +132,22 @@ ssize_t socket_write(struct socket_t *self_p,
     return (write(NULL, buf_p, size));
 }
 
+ssize_t socket_writev(struct socket_t *self_p,
+                      const struct iov_t *iov_p,
+                      size_t length)
+{
+    size_t i;
+    ssize_t size;
+
+    size = 0;
+
+    for (i = 0; i < length; i++) {
+        size += write(NULL, iov_p[i].buf_p, iov_p[i].size);
+    }
+
+    return (size);
+}
+
 ssize_t socket_read(struct socket_t *self_p,
                     void *buf_p,
                     size_t size)
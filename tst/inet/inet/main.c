@@ -77,12 +77,74 @@ static int test_inet_checksum(void)
     return (0);
 }
 
+/**
+ * Byte-wise reference implementation.
+ */
+static uint16_t checksum_sum_reference(const uint8_t *buf_p, size_t size)
+{
+    uint32_t acc;
+    size_t i;
+
+    acc = 0;
+
+    for (i = 0; i < size; i++) {
+        if ((i & 1) == 0) {
+            acc += (buf_p[i] << 8);
+        } else {
+            acc += buf_p[i];
+        }
+    }
+
+    while ((acc >> 16) != 0) {
+        acc = (acc >> 16) + (acc & 0xffff);
+    }
+
+    return (htons(acc));
+}
+
+static int test_inet_checksum_sum(void)
+{
+    static uint32_t words[64];
+    uint8_t *buf_p;
+    size_t offset;
+    size_t size;
+    int i;
+
+    buf_p = (uint8_t *)&words[0];
+
+    for (i = 0; i < sizeof(words); i++) {
+        buf_p[i] = (37 * i + 11);
+    }
+
+    /* All alignments and sizes. */
+    for (offset = 0; offset < 4; offset++) {
+        for (size = 0; size < 80; size++) {
+            BTASSERT(inet_checksum_sum(&buf_p[offset], size)
+                     == checksum_sum_reference(&buf_p[offset], size));
+        }
+    }
+
+    /* Many carries. */
+    memset(buf_p, 0xff, sizeof(words));
+
+    for (offset = 0; offset < 4; offset++) {
+        size = (sizeof(words) - offset);
+        BTASSERT(inet_checksum_sum(&buf_p[offset], size)
+                 == checksum_sum_reference(&buf_p[offset], size));
+        BTASSERT(inet_checksum_sum(&buf_p[offset], size - 1)
+                 == checksum_sum_reference(&buf_p[offset], size - 1));
+    }
+
+    return (0);
+}
+
 int main()
 {
     struct harness_testcase_t testcases[] = {
         { test_aton, "test_aton" },
         { test_ntoa, "test_ntoa" },
         { test_inet_checksum, "test_inet_checksum" },
+        { test_inet_checksum_sum, "test_inet_checksum_sum" },
         { NULL, NULL }
     };
 
@@ -28,6 +28,20 @@
 
 #include "simba.h"
 
+static struct can_frame_t frames[8];
+static int number_of_frames;
+
+ssize_t can_write(struct can_driver_t *self_p,
+                  const struct can_frame_t *frame_p,
+                  size_t size)
+{
+    BTASSERT(number_of_frames < membersof(frames));
+
+    frames[number_of_frames++] = *frame_p;
+
+    return (size);
+}
+
 static int test_input_single_frame(void)
 {
     struct isotp_t isotp;
@@ -460,6 +474,299 @@ static int test_output_multi_frame_unexpected_non_flow_control(
     return (0);
 }
 
+static int test_fd_single_frame(void)
+{
+    struct isotp_t isotp;
+    uint8_t message[64];
+    uint8_t frame[64];
+    size_t size;
+    int i;
+
+    for (i = 0; i < 62; i++) {
+        message[i] = i;
+    }
+
+    /* Output a 62 bytes single frame with the length in the second
+       byte. */
+    BTASSERT(isotp_init(&isotp, &message[0], 62, ISOTP_FLAGS_CAN_FD) == 0);
+    BTASSERT(isotp_output(&isotp, &frame[0], &size) == 62);
+    BTASSERT(size == 64);
+    BTASSERT(frame[0] == 0);
+    BTASSERT(frame[1] == 62);
+    BTASSERT(memcmp(&frame[2], &message[0], 62) == 0);
+
+    /* Input it. */
+    memset(&message[0], 0, sizeof(message));
+    BTASSERT(isotp_init(&isotp,
+                        &message[0],
+                        sizeof(message),
+                        ISOTP_FLAGS_CAN_FD) == 0);
+    BTASSERT(isotp_input(&isotp, &frame[0], 64) == 62);
+    BTASSERT(memcmp(&message[0], &frame[2], 62) == 0);
+
+    /* Short single frames in CAN FD frames has the length in the
+       first byte. */
+    frame[0] = (0 << 4) | 3;
+    BTASSERT(isotp_input(&isotp, &frame[0], 4) == 3);
+
+    /* Too long. */
+    frame[0] = 0;
+    frame[1] = 63;
+    BTASSERT(isotp_input(&isotp, &frame[0], 64) == -1);
+
+    return (0);
+}
+
+static int test_fd_multi_frame(void)
+{
+    struct isotp_t tx;
+    struct isotp_t rx;
+    uint8_t message[100];
+    uint8_t buf[100];
+    uint8_t frame[64];
+    size_t size;
+    int i;
+
+    for (i = 0; i < 100; i++) {
+        message[i] = i;
+    }
+
+    BTASSERT(isotp_init(&tx, &message[0], 100, ISOTP_FLAGS_CAN_FD) == 0);
+    BTASSERT(isotp_init(&rx, &buf[0], sizeof(buf), ISOTP_FLAGS_CAN_FD) == 0);
+
+    /* First frame with 62 bytes of data. */
+    BTASSERT(isotp_output(&tx, &frame[0], &size) == 0);
+    BTASSERT(size == 64);
+    BTASSERT(frame[0] == ((1 << 4) | 0));
+    BTASSERT(frame[1] == 100);
+    BTASSERT(isotp_input(&rx, &frame[0], size) == 0);
+
+    /* Flow control. */
+    BTASSERT(isotp_output(&rx, &frame[0], &size) == 0);
+    BTASSERT(size == 3);
+    BTASSERT(isotp_input(&tx, &frame[0], size) == 0);
+
+    /* The last 38 bytes in one consecutive frame. */
+    BTASSERT(isotp_output(&tx, &frame[0], &size) == 100);
+    BTASSERT(size == 39);
+    BTASSERT(frame[0] == ((2 << 4) | 1));
+    BTASSERT(isotp_input(&rx, &frame[0], size) == 100);
+    BTASSERT(memcmp(&buf[0], &message[0], 100) == 0);
+
+    return (0);
+}
+
+static int test_first_frame_escape(void)
+{
+    struct isotp_t isotp;
+    static uint8_t message[5000];
+    uint8_t frame[8];
+    size_t size;
+
+    BTASSERT(isotp_init(&isotp, &message[0], sizeof(message), 0) == 0);
+
+    /* Messages longer than 4095 bytes has a 32 bits length. */
+    BTASSERT(isotp_output(&isotp, &frame[0], &size) == 0);
+    BTASSERT(size == 8);
+    BTASSERT(frame[0] == ((1 << 4) | 0));
+    BTASSERT(frame[1] == 0);
+    BTASSERT(frame[2] == 0);
+    BTASSERT(frame[3] == 0);
+    BTASSERT(frame[4] == (5000 >> 8));
+    BTASSERT(frame[5] == (5000 & 0xff));
+
+    BTASSERT(isotp_init(&isotp, &message[0], sizeof(message), 0) == 0);
+    BTASSERT(isotp_input(&isotp, &frame[0], 8) == 0);
+    BTASSERT(isotp.message.size == 5000);
+    BTASSERT(isotp.message.offset == 2);
+
+    return (0);
+}
+
+static int test_block_size(void)
+{
+    struct isotp_t tx;
+    struct isotp_t rx;
+    char message[] = "1234567890abcdefghijklmnopqrstuvwxyz";
+    uint8_t buf[64];
+    uint8_t frame[8];
+    size_t size;
+    int i;
+
+    BTASSERT(isotp_init(&tx, (uint8_t *)&message[0], 34, 0) == 0);
+    BTASSERT(isotp_init(&rx, &buf[0], sizeof(buf), 0) == 0);
+    BTASSERT(isotp_set_flow_control(&rx, 2, 0xf3) == 0);
+
+    BTASSERT(isotp_output(&tx, &frame[0], &size) == 0);
+    BTASSERT(isotp_input(&rx, &frame[0], size) == 0);
+
+    /* Transmit two blocks of two consecutive frames. */
+    for (i = 0; i < 2; i++) {
+        /* The flow control has the block size and separation
+           time. */
+        BTASSERT(isotp_output(&rx, &frame[0], &size) == 0);
+        BTASSERT(size == 3);
+        BTASSERT(frame[0] == (3 << 4));
+        BTASSERT(frame[1] == 2);
+        BTASSERT(frame[2] == 0xf3);
+
+        if (i == 0) {
+            /* Wait. */
+            frame[0] = (3 << 4) | 1;
+            BTASSERT(isotp_input(&tx, &frame[0], 3) == 0);
+            BTASSERT(isotp_output(&tx, &frame[0], &size) == 0);
+            BTASSERT(size == 0);
+            frame[0] = (3 << 4) | 0;
+        }
+
+        BTASSERT(isotp_input(&tx, &frame[0], 3) == 0);
+        BTASSERT(isotp_get_separation_time_us(&tx) == 300);
+
+        BTASSERT(isotp_output(&tx, &frame[0], &size) == 0);
+        BTASSERT(isotp_input(&rx, &frame[0], size) == 0);
+
+        /* Second consecutive frame. */
+        BTASSERT(isotp_output(&tx, &frame[0], &size) == (i == 0 ? 0 : 34));
+        BTASSERT(isotp_input(&rx, &frame[0], size) == (i == 0 ? 0 : 34));
+
+        if (i == 0) {
+            /* Waiting for the next flow control frame. */
+            BTASSERT(isotp_output(&tx, &frame[0], &size) == 0);
+            BTASSERT(size == 0);
+        }
+    }
+
+    BTASSERT(memcmp(&buf[0], &message[0], 34) == 0);
+
+    return (0);
+}
+
+static int test_flow_control_overflow(void)
+{
+    struct isotp_t isotp;
+    char message[] = "1234567890abcdefghi";
+    uint8_t frame[8];
+    size_t size;
+
+    BTASSERT(isotp_init(&isotp, (uint8_t *)&message[0], 19, 0) == 0);
+    BTASSERT(isotp_output(&isotp, &frame[0], &size) == 0);
+
+    /* The receiver cannot take the message. */
+    frame[0] = (3 << 4) | 2;
+    frame[1] = 0;
+    frame[2] = 0;
+    BTASSERT(isotp_input(&isotp, &frame[0], 3) == -1);
+
+    return (0);
+}
+
+static int test_manager(void)
+{
+    struct isotp_manager_t manager;
+    struct isotp_session_t sessions[2];
+    struct isotp_session_t *session_p;
+    struct can_frame_t frame;
+    uint8_t buf[2][32];
+    char message[] = "1234567890abcdefghi";
+
+    number_of_frames = 0;
+
+    BTASSERT(isotp_manager_init(&manager,
+                                (struct can_driver_t *)1) == 0);
+    BTASSERT(isotp_manager_add_session(&manager,
+                                       &sessions[0],
+                                       0x10,
+                                       0x11,
+                                       &buf[0][0],
+                                       sizeof(buf[0]),
+                                       0) == 0);
+    BTASSERT(isotp_manager_add_session(&manager,
+                                       &sessions[1],
+                                       0x20,
+                                       0x21,
+                                       &buf[1][0],
+                                       sizeof(buf[1]),
+                                       0) == 0);
+    BTASSERT(isotp_manager_add_session(&manager,
+                                       &sessions[1],
+                                       0x20,
+                                       0x21,
+                                       &buf[1][0],
+                                       sizeof(buf[1]),
+                                       ISOTP_FLAGS_CAN_FD) == -ENOSYS);
+
+    /* Start a multi frame transmission in the first session. */
+    BTASSERT(isotp_manager_write(&manager,
+                                 &sessions[0],
+                                 (uint8_t *)&message[0],
+                                 19) == 0);
+    BTASSERT(isotp_manager_is_writing(&sessions[0]) == 1);
+    BTASSERT(isotp_manager_write(&manager,
+                                 &sessions[0],
+                                 (uint8_t *)&message[0],
+                                 19) == -EBUSY);
+    BTASSERT(number_of_frames == 1);
+    BTASSERT(frames[0].id == 0x11);
+    BTASSERT(frames[0].size == 8);
+    BTASSERT(frames[0].data.u8[0] == ((1 << 4) | 0));
+
+    /* A frame of another node is ignored. */
+    frame.id = 0x30;
+    frame.size = 2;
+    frame.data.u8[0] = (0 << 4) | 1;
+    frame.data.u8[1] = 'a';
+    BTASSERT(isotp_manager_input(&manager, &frame, &session_p) == 0);
+    BTASSERT(session_p == NULL);
+
+    /* A single frame in the second session. */
+    frame.id = 0x20;
+    BTASSERT(isotp_manager_input(&manager, &frame, &session_p) == 1);
+    BTASSERT(session_p == &sessions[1]);
+    BTASSERT(buf[1][0] == 'a');
+
+    /* A first frame in the first session, while its outgoing message
+       is waiting for a flow control frame. */
+    frame.id = 0x10;
+    frame.size = 8;
+    memcpy(&frame.data.u8[0], "\x10\x09""abcdef", 8);
+    BTASSERT(isotp_manager_input(&manager, &frame, &session_p) == 0);
+    BTASSERT(session_p == &sessions[0]);
+    BTASSERT(number_of_frames == 2);
+    BTASSERT(frames[1].id == 0x11);
+    BTASSERT(frames[1].size == 3);
+    BTASSERT(frames[1].data.u8[0] == (3 << 4));
+
+    /* Flow control of the outgoing message. Both consecutive frames
+       are transmitted. */
+    frame.size = 3;
+    memcpy(&frame.data.u8[0], "\x30\x00\x00", 3);
+    BTASSERT(isotp_manager_input(&manager, &frame, &session_p) == 0);
+    BTASSERT(number_of_frames == 4);
+    BTASSERT(frames[2].data.u8[0] == ((2 << 4) | 1));
+    BTASSERT(frames[3].data.u8[0] == ((2 << 4) | 2));
+    BTASSERT(frames[3].size == 7);
+    BTASSERT(isotp_manager_is_writing(&sessions[0]) == 0);
+
+    /* The rest of the incoming message. */
+    frame.size = 4;
+    memcpy(&frame.data.u8[0], "\x21""ghi", 4);
+    BTASSERT(isotp_manager_input(&manager, &frame, &session_p) == 9);
+    BTASSERT(session_p == &sessions[0]);
+    BTASSERT(memcmp(&buf[0][0], "abcdefghi", 9) == 0);
+
+    /* Single frame transmission. */
+    BTASSERT(isotp_manager_write(&manager,
+                                 &sessions[1],
+                                 (uint8_t *)&message[0],
+                                 3) == 3);
+    BTASSERT(isotp_manager_is_writing(&sessions[1]) == 0);
+    BTASSERT(number_of_frames == 5);
+    BTASSERT(frames[4].id == 0x21);
+    BTASSERT(frames[4].size == 4);
+
+    return (0);
+}
+
 int main()
 {
     struct harness_testcase_t testcases[] = {
@@ -485,6 +792,12 @@ int main()
           "test_input_bad_multi_frame_consecutive" },
         { test_output_multi_frame_unexpected_non_flow_control,
           "test_output_multi_frame_unexpected_non_flow_control" },
+        { test_fd_single_frame, "test_fd_single_frame" },
+        { test_fd_multi_frame, "test_fd_multi_frame" },
+        { test_first_frame_escape, "test_first_frame_escape" },
+        { test_block_size, "test_block_size" },
+        { test_flow_control_overflow, "test_flow_control_overflow" },
+        { test_manager, "test_manager" },
         { NULL, NULL }
     };
 
@@ -42,12 +42,25 @@ static struct queue_t qserverin;
 static char qoutbuf[64];
 static char qinbuf[64];
 static char qserveroutbuf[64];
-static char qserverinbuf[64];
+static char qserverinbuf[256];
 static struct thrd_t *self_p;
 
 THRD_STACK(stack, 1024);
 THRD_STACK(server_stack, 512);
 
+static struct mqtt_client_t reactor_client;
+static struct reactor_t reactor;
+static struct queue_t qreactorout;
+static struct queue_t qreactorin;
+static char qreactoroutbuf[64];
+static char qreactorinbuf[64];
+static struct sem_t reactor_sem;
+static struct sem_t reactor_user_sem;
+static int reactor_user_res;
+
+THRD_STACK(reactor_stack, 1024);
+THRD_STACK(reactor_user_stack, 1024);
+
 static void *server_main(void *arg_p)
 {
     int i;
@@ -107,6 +120,80 @@ static int on_error(struct mqtt_client_t *client_p,
     return (0);
 }
 
+/* A file system with a single file in RAM for the offline queue. */
+static struct fs_filesystem_t ramfs;
+static struct fs_filesystem_operations_t ramfs_ops;
+static uint8_t ramfs_buf[256];
+static size_t ramfs_size;
+static size_t ramfs_pos;
+
+static int ramfs_open(struct fs_filesystem_t *filesystem_p,
+                      struct fs_file_t *self_p,
+                      const char *path_p,
+                      int flags)
+{
+    if (flags & FS_TRUNC) {
+        ramfs_size = 0;
+    }
+
+    ramfs_pos = 0;
+
+    return (0);
+}
+
+static int ramfs_close(struct fs_file_t *self_p)
+{
+    return (0);
+}
+
+static ssize_t ramfs_read(struct fs_file_t *self_p,
+                          void *dst_p,
+                          size_t size)
+{
+    size = MIN(size, ramfs_size - ramfs_pos);
+    memcpy(dst_p, &ramfs_buf[ramfs_pos], size);
+    ramfs_pos += size;
+
+    return (size);
+}
+
+static ssize_t ramfs_write(struct fs_file_t *self_p,
+                           const void *src_p,
+                           size_t size)
+{
+    size = MIN(size, sizeof(ramfs_buf) - ramfs_pos);
+    memcpy(&ramfs_buf[ramfs_pos], src_p, size);
+    ramfs_pos += size;
+    ramfs_size = MAX(ramfs_size, ramfs_pos);
+
+    return (size);
+}
+
+static int ramfs_seek(struct fs_file_t *self_p, int offset, int whence)
+{
+    switch (whence) {
+
+    case FS_SEEK_SET:
+        ramfs_pos = offset;
+        break;
+
+    case FS_SEEK_CUR:
+        ramfs_pos += offset;
+        break;
+
+    default:
+        ramfs_pos = (ramfs_size + offset);
+        break;
+    }
+
+    return (0);
+}
+
+static ssize_t ramfs_tell(struct fs_file_t *self_p)
+{
+    return (ramfs_pos);
+}
+
 static int test_init(void)
 {
     struct thrd_t *thrd_p;
@@ -123,6 +210,19 @@ static int test_init(void)
                               on_publish,
                               on_error) == 0);
 
+    /* Offline queue. */
+    ramfs_ops.file_open = ramfs_open;
+    ramfs_ops.file_close = ramfs_close;
+    ramfs_ops.file_read = ramfs_read;
+    ramfs_ops.file_write = ramfs_write;
+    ramfs_ops.file_seek = ramfs_seek;
+    ramfs_ops.file_tell = ramfs_tell;
+    BTASSERT(fs_filesystem_init_generic(&ramfs, "/ram", &ramfs_ops) == 0);
+    BTASSERT(fs_filesystem_register(&ramfs) == 0);
+    BTASSERT(mqtt_client_offline_queue_init(&client,
+                                            "/ram/offline",
+                                            sizeof(ramfs_buf)) == 0);
+
     thrd_p = thrd_spawn(mqtt_client_main,
                         &client,
                         0,
@@ -330,7 +430,7 @@ static int test_subscribe(void)
     buf[0] = (9 << 4);
     buf[1] = 3;
     buf[2] = 0;
-    buf[3] = 1;
+    buf[3] = 2;
     buf[4] = 0;
     message.buf_p = buf;
     message.size = 5;
@@ -346,7 +446,7 @@ static int test_subscribe(void)
     BTASSERT(buf[0] == ((8 << 4) | 2));
     BTASSERT(buf[1] == 12);
     BTASSERT(buf[2] == 0);
-    BTASSERT(buf[3] == 1);
+    BTASSERT(buf[3] == 2);
     BTASSERT(buf[4] == 0);
     BTASSERT(buf[5] == 7);
     BTASSERT(buf[6] == 'f');
@@ -391,7 +491,7 @@ static int test_subscribe(void)
     buf[0] = (11 << 4);
     buf[1] = 2;
     buf[2] = 0;
-    buf[3] = 2;
+    buf[3] = 3;
     message.buf_p = buf;
     message.size = 4;
     BTASSERT(queue_write(&qserverin, &message, sizeof(message)) == sizeof(message));
@@ -405,7 +505,7 @@ static int test_subscribe(void)
     BTASSERT(buf[0] == ((10 << 4) | 2));
     BTASSERT(buf[1] == 11);
     BTASSERT(buf[2] == 0);
-    BTASSERT(buf[3] == 2);
+    BTASSERT(buf[3] == 3);
     BTASSERT(buf[4] == 0);
     BTASSERT(buf[5] == 7);
     BTASSERT(buf[6] == 'f');
@@ -563,6 +663,326 @@ static int test_incoming_publish_qos2(void)
     return (0);
 }
 
+static int test_incoming_publish_qos2_duplicate(void)
+{
+    static uint8_t publish[16] = {
+        ((3 << 4) | 0x8 | (2 << 1)), 14,
+        0, 7, 'f', 'o', 'o', '/', 'b', 'a', 'r',
+        0, 1,
+        'f', 'i', 'e'
+    };
+    static uint8_t pubrel[4] = { ((6 << 4) | 2), 2, 0, 1 };
+    uint8_t buf[4];
+    struct message_t message;
+
+    published_message_size = 0;
+
+    /* The server retransmits the message before releasing it. */
+    message.buf_p = publish;
+    message.size = sizeof(publish);
+    BTASSERT(queue_write(&qserverin, &message, sizeof(message)) == sizeof(message));
+    message.buf_p = NULL;
+    message.size = 4;
+    BTASSERT(queue_write(&qserverin, &message, sizeof(message)) == sizeof(message));
+
+    BTASSERT(queue_read(&qserverout, buf, 4) == 4);
+    BTASSERT(buf[0] == (5 << 4));
+    BTASSERT(buf[3] == 1);
+
+    /* Release the message. */
+    message.buf_p = pubrel;
+    message.size = sizeof(pubrel);
+    BTASSERT(queue_write(&qserverin, &message, sizeof(message)) == sizeof(message));
+    message.buf_p = NULL;
+    message.size = 4;
+    BTASSERT(queue_write(&qserverin, &message, sizeof(message)) == sizeof(message));
+
+    BTASSERT(queue_read(&qserverout, buf, 4) == 4);
+    BTASSERT(buf[0] == (7 << 4));
+    BTASSERT(buf[1] == 2);
+    BTASSERT(buf[2] == 0);
+    BTASSERT(buf[3] == 1);
+
+    /* The duplicate was not given to the application. */
+    BTASSERT(published_message_size == 0);
+    BTASSERT(client.inflight.incoming[0] == 0);
+
+    return (0);
+}
+
+/**
+ * Let the server forward given number of bytes written by the client
+ * to the test thread.
+ */
+static int server_forward(size_t size)
+{
+    struct message_t message;
+
+    message.buf_p = NULL;
+    message.size = size;
+
+    return (queue_write(&qserverin, &message, sizeof(message)));
+}
+
+/**
+ * Let the server write given packet to the client. The buffer must
+ * be valid until the server has written it.
+ */
+static int server_write(void *buf_p, size_t size)
+{
+    struct message_t message;
+
+    message.buf_p = buf_p;
+    message.size = size;
+
+    return (queue_write(&qserverin, &message, sizeof(message)));
+}
+
+/**
+ * Wait for the client to process all packets written by the server
+ * so far, using a ping.
+ */
+static int flush(void)
+{
+    static uint8_t response[2] = { (13 << 4), 0 };
+    uint8_t request[2];
+
+    BTASSERT(server_forward(2) == sizeof(struct message_t));
+    BTASSERT(server_write(&response[0], 2) == sizeof(struct message_t));
+    BTASSERT(mqtt_client_ping(&client) == 0);
+    BTASSERT(queue_read(&qserverout, &request[0], 2) == 2);
+    BTASSERT(request[0] == (12 << 4));
+
+    return (0);
+}
+
+static int publish_a(int qos)
+{
+    struct mqtt_application_message_t message;
+
+    message.topic.buf_p = "a";
+    message.topic.size = 1;
+    message.payload.buf_p = "b";
+    message.payload.size = 1;
+    message.qos = qos;
+
+    return (mqtt_client_publish(&client, &message));
+}
+
+static int test_publish_window(void)
+{
+    static uint8_t acks[CONFIG_MQTT_CLIENT_INFLIGHT_MAX + 1][4];
+    uint8_t buf[8];
+    int i;
+
+    /* Fill the window without any acknowledgements from the
+       server. */
+    for (i = 0; i < CONFIG_MQTT_CLIENT_INFLIGHT_MAX; i++) {
+        BTASSERT(server_forward(8) == sizeof(struct message_t));
+    }
+
+    for (i = 0; i < CONFIG_MQTT_CLIENT_INFLIGHT_MAX; i++) {
+        BTASSERT(publish_a(mqtt_qos_1_t) == 0);
+    }
+
+    BTASSERTI(client.inflight.length, ==, CONFIG_MQTT_CLIENT_INFLIGHT_MAX);
+
+    /* The messages have consecutive packet identifiers, starting
+       after the unsubscribe packet. */
+    for (i = 0; i < CONFIG_MQTT_CLIENT_INFLIGHT_MAX; i++) {
+        BTASSERTI(queue_read(&qserverout, &buf[0], 8), ==, 8);
+        BTASSERTI(buf[0], ==, ((3 << 4) | (1 << 1)));
+        BTASSERTI(buf[1], ==, 6);
+        BTASSERTI(buf[2], ==, 0);
+        BTASSERTI(buf[3], ==, 1);
+        BTASSERTI(buf[4], ==, 'a');
+        BTASSERTI(buf[5], ==, 0);
+        BTASSERTI(buf[6], ==, 4 + i);
+        BTASSERTI(buf[7], ==, 'b');
+    }
+
+    /* The next publish waits for a free entry in the window. */
+    acks[0][0] = (4 << 4);
+    acks[0][1] = 2;
+    acks[0][2] = 0;
+    acks[0][3] = 4;
+    BTASSERT(server_write(&acks[0][0], 4) == sizeof(struct message_t));
+    BTASSERT(server_forward(8) == sizeof(struct message_t));
+    BTASSERT(publish_a(mqtt_qos_1_t) == 0);
+    BTASSERTI(queue_read(&qserverout, &buf[0], 8), ==, 8);
+    BTASSERTI(buf[6], ==, 4 + CONFIG_MQTT_CLIENT_INFLIGHT_MAX);
+
+    /* Acknowledge the remaining messages in reverse order. */
+    for (i = CONFIG_MQTT_CLIENT_INFLIGHT_MAX; i > 0; i--) {
+        acks[i][0] = (4 << 4);
+        acks[i][1] = 2;
+        acks[i][2] = 0;
+        acks[i][3] = (4 + i);
+        BTASSERT(server_write(&acks[i][0], 4) == sizeof(struct message_t));
+    }
+
+    BTASSERT(flush() == 0);
+    BTASSERTI(client.inflight.length, ==, 0);
+
+    return (0);
+}
+
+static int test_publish_qos2(void)
+{
+    static uint8_t pubrec[4] = { (5 << 4), 2, 0, 9 };
+    static uint8_t pubcomp[4] = { (7 << 4), 2, 0, 9 };
+    uint8_t buf[8];
+
+    BTASSERT(server_forward(8) == sizeof(struct message_t));
+    BTASSERT(server_write(&pubrec[0], 4) == sizeof(struct message_t));
+    BTASSERT(server_forward(4) == sizeof(struct message_t));
+    BTASSERT(server_write(&pubcomp[0], 4) == sizeof(struct message_t));
+
+    BTASSERT(publish_a(mqtt_qos_2_t) == 0);
+
+    /* The publish message. */
+    BTASSERTI(queue_read(&qserverout, &buf[0], 8), ==, 8);
+    BTASSERTI(buf[0], ==, ((3 << 4) | (2 << 1)));
+    BTASSERTI(buf[5], ==, 0);
+    BTASSERTI(buf[6], ==, 9);
+
+    /* The release message sent when the server received it. */
+    BTASSERTI(queue_read(&qserverout, &buf[0], 4), ==, 4);
+    BTASSERTI(buf[0], ==, ((6 << 4) | 2));
+    BTASSERTI(buf[1], ==, 2);
+    BTASSERTI(buf[2], ==, 0);
+    BTASSERTI(buf[3], ==, 9);
+
+    BTASSERT(flush() == 0);
+    BTASSERTI(client.inflight.length, ==, 0);
+
+    return (0);
+}
+
+static int test_reconnect(void)
+{
+    static uint8_t pubrec[4] = { (5 << 4), 2, 0, 11 };
+    static uint8_t connack[4] = { 0x20, 2, 1, 0 };
+    static uint8_t puback[4] = { (4 << 4), 2, 0, 10 };
+    static uint8_t pubcomp[4] = { (7 << 4), 2, 0, 11 };
+    uint8_t buf[16];
+
+    /* A QoS 1 message waiting for PUBACK and a QoS 2 message waiting
+       for PUBCOMP. */
+    BTASSERT(server_forward(8) == sizeof(struct message_t));
+    BTASSERT(server_forward(8) == sizeof(struct message_t));
+    BTASSERT(server_write(&pubrec[0], 4) == sizeof(struct message_t));
+    BTASSERT(server_forward(4) == sizeof(struct message_t));
+
+    BTASSERT(publish_a(mqtt_qos_1_t) == 0);
+    BTASSERT(publish_a(mqtt_qos_2_t) == 0);
+
+    BTASSERTI(queue_read(&qserverout, &buf[0], 8), ==, 8);
+    BTASSERTI(buf[6], ==, 10);
+    BTASSERTI(queue_read(&qserverout, &buf[0], 8), ==, 8);
+    BTASSERTI(buf[6], ==, 11);
+    BTASSERTI(queue_read(&qserverout, &buf[0], 4), ==, 4);
+    BTASSERTI(buf[0], ==, ((6 << 4) | 2));
+    BTASSERTI(client.inflight.length, ==, 2);
+
+    /* Reconnect, resuming the session. */
+    memset(&conn_options, 0, sizeof(conn_options));
+    conn_options.resume_session = 1;
+
+    BTASSERT(server_forward(2 + 10 + 12) == sizeof(struct message_t));
+    BTASSERT(server_write(&connack[0], 4) == sizeof(struct message_t));
+    BTASSERT(server_forward(8) == sizeof(struct message_t));
+    BTASSERT(server_forward(4) == sizeof(struct message_t));
+
+    BTASSERTI(mqtt_client_connect(&client, &conn_options), ==, 0);
+
+    BTASSERTI(queue_read(&qserverout, &buf[0], 12), ==, 12);
+    BTASSERTI(buf[0], ==, 0x10);
+    BTASSERTI(buf[9], ==, 0);
+    BTASSERTI(queue_read(&qserverout, &buf[0], 12), ==, 12);
+
+    /* The QoS 1 message is retransmitted with the DUP flag set. */
+    BTASSERTI(queue_read(&qserverout, &buf[0], 8), ==, 8);
+    BTASSERTI(buf[0], ==, ((3 << 4) | 0x8 | (1 << 1)));
+    BTASSERTI(buf[6], ==, 10);
+    BTASSERTI(buf[7], ==, 'b');
+
+    /* The QoS 2 message is released again. */
+    BTASSERTI(queue_read(&qserverout, &buf[0], 4), ==, 4);
+    BTASSERTI(buf[0], ==, ((6 << 4) | 2));
+    BTASSERTI(buf[3], ==, 11);
+
+    BTASSERT(server_write(&puback[0], 4) == sizeof(struct message_t));
+    BTASSERT(server_write(&pubcomp[0], 4) == sizeof(struct message_t));
+    BTASSERT(flush() == 0);
+    BTASSERTI(client.inflight.length, ==, 0);
+
+    return (0);
+}
+
+static int test_publish_many(void)
+{
+    static uint8_t acks[CONFIG_MQTT_CLIENT_INFLIGHT_MAX + 1][4];
+    struct mqtt_application_message_t messages[CONFIG_MQTT_CLIENT_INFLIGHT_MAX + 2];
+    uint8_t buf[8];
+    int i;
+
+    for (i = 0; i < membersof(messages); i++) {
+        messages[i].topic.buf_p = "a";
+        messages[i].topic.size = 1;
+        messages[i].payload.buf_p = "b";
+        messages[i].payload.size = 1;
+        messages[i].qos = mqtt_qos_1_t;
+    }
+
+    messages[0].qos = mqtt_qos_0_t;
+
+    for (i = 0; i < membersof(acks); i++) {
+        acks[i][0] = (4 << 4);
+        acks[i][1] = 2;
+        acks[i][2] = 0;
+        acks[i][3] = (12 + i);
+    }
+
+    /* The last message is written once the server has acknowledged
+       the first one, as the window is full. */
+    BTASSERT(server_forward(6) == sizeof(struct message_t));
+
+    for (i = 0; i < CONFIG_MQTT_CLIENT_INFLIGHT_MAX; i++) {
+        BTASSERT(server_forward(8) == sizeof(struct message_t));
+    }
+
+    BTASSERT(server_write(&acks[0][0], 4) == sizeof(struct message_t));
+    BTASSERT(server_forward(8) == sizeof(struct message_t));
+
+    BTASSERT(mqtt_client_publish_many(&client,
+                                      &messages[0],
+                                      membersof(messages)) == 0);
+
+    BTASSERTI(queue_read(&qserverout, &buf[0], 6), ==, 6);
+    BTASSERTI(buf[0], ==, (3 << 4));
+    BTASSERTI(buf[1], ==, 4);
+    BTASSERTI(buf[4], ==, 'a');
+    BTASSERTI(buf[5], ==, 'b');
+
+    for (i = 0; i < CONFIG_MQTT_CLIENT_INFLIGHT_MAX + 1; i++) {
+        BTASSERTI(queue_read(&qserverout, &buf[0], 8), ==, 8);
+        BTASSERTI(buf[0], ==, ((3 << 4) | (1 << 1)));
+        BTASSERTI(buf[6], ==, 12 + i);
+    }
+
+    BTASSERTI(client.inflight.length, ==, CONFIG_MQTT_CLIENT_INFLIGHT_MAX);
+
+    for (i = 1; i < membersof(acks); i++) {
+        BTASSERT(server_write(&acks[i][0], 4) == sizeof(struct message_t));
+    }
+
+    BTASSERT(flush() == 0);
+    BTASSERTI(client.inflight.length, ==, 0);
+
+    return (0);
+}
+
 static int test_disconnect(void)
 {
     struct message_t message;
@@ -583,6 +1003,188 @@ static int test_disconnect(void)
     return (0);
 }
 
+static int test_offline_queue(void)
+{
+    static uint8_t connack[4] = { 0x20, 2, 0, 0 };
+    static uint8_t acks[2][4] = {
+        { (4 << 4), 2, 0, 17 },
+        { (4 << 4), 2, 0, 18 }
+    };
+    static uint8_t large[CONFIG_MQTT_CLIENT_INFLIGHT_BUFFER_SIZE];
+    struct mqtt_application_message_t message;
+    uint8_t buf[24];
+    uint32_t queued;
+
+    /* Messages published while disconnected are stored in the
+       file. */
+    BTASSERTI(client.state, ==, mqtt_client_state_disconnected_t);
+    BTASSERT(publish_a(mqtt_qos_0_t) == 0);
+    BTASSERT(publish_a(mqtt_qos_1_t) == 0);
+    BTASSERT(publish_a(mqtt_qos_1_t) == 0);
+    BTASSERT(publish_a(mqtt_qos_1_t) == 0);
+    queued = client.offline.counters.queued;
+    BTASSERTI(queued, ==, 4 * (8 + 2));
+    BTASSERTI(ramfs_size, ==, queued);
+
+    /* A message too big to be replayed is dropped. */
+    message.topic.buf_p = "a";
+    message.topic.size = 1;
+    message.payload.buf_p = &large[0];
+    message.payload.size = sizeof(large);
+    message.qos = mqtt_qos_1_t;
+    BTASSERTI(mqtt_client_publish(&client, &message), ==, -ENOSPC);
+    BTASSERTI(client.offline.counters.dropped, ==, 8 + 1 + sizeof(large));
+    BTASSERTI(ramfs_size, ==, queued);
+
+    /* Corrupt the last message, as if the append was interrupted. */
+    ramfs_buf[ramfs_size - 1] ^= 0xff;
+
+    /* The stored messages are published in order after the connect,
+       except the corrupt one. */
+    BTASSERT(server_forward(2 + 10 + 12) == sizeof(struct message_t));
+    BTASSERT(server_write(&connack[0], 4) == sizeof(struct message_t));
+    BTASSERT(server_forward(6) == sizeof(struct message_t));
+    BTASSERT(server_forward(8) == sizeof(struct message_t));
+    BTASSERT(server_forward(8) == sizeof(struct message_t));
+
+    BTASSERTI(mqtt_client_connect(&client, NULL), ==, 0);
+
+    BTASSERTI(queue_read(&qserverout, &buf[0], 24), ==, 24);
+    BTASSERTI(buf[0], ==, 0x10);
+    BTASSERTI(queue_read(&qserverout, &buf[0], 6), ==, 6);
+    BTASSERTI(buf[0], ==, (3 << 4));
+    BTASSERTI(queue_read(&qserverout, &buf[0], 8), ==, 8);
+    BTASSERTI(buf[0], ==, ((3 << 4) | (1 << 1)));
+    BTASSERTI(buf[6], ==, 17);
+    BTASSERTI(queue_read(&qserverout, &buf[0], 8), ==, 8);
+    BTASSERTI(buf[6], ==, 18);
+
+    BTASSERT(server_write(&acks[0][0], 4) == sizeof(struct message_t));
+    BTASSERT(server_write(&acks[1][0], 4) == sizeof(struct message_t));
+    BTASSERT(flush() == 0);
+
+    BTASSERTI(client.inflight.length, ==, 0);
+    BTASSERTI(client.offline.counters.replayed, ==, 3 * (8 + 2));
+    BTASSERTI(client.offline.counters.dropped,
+              ==,
+              8 + 1 + sizeof(large) + 8 + 2);
+    BTASSERTI(client.offline.size, ==, 0);
+    BTASSERTI(ramfs_size, ==, 0);
+
+    return (test_disconnect());
+}
+
+static size_t on_reactor_publish(struct mqtt_client_t *client_p,
+                                 const char *topic_p,
+                                 void *chin_p,
+                                 size_t size)
+{
+    strncpy(&published_topic[0], topic_p, sizeof(published_topic));
+    chan_read(chin_p, &published_message[0], size);
+    published_message_size = size;
+    sem_give(&reactor_sem, 1);
+
+    return (0);
+}
+
+static void *reactor_main(void *arg_p)
+{
+    thrd_set_name("mqtt_reactor");
+
+    reactor_run(&reactor);
+    thrd_suspend(NULL);
+
+    return (NULL);
+}
+
+/**
+ * Client API calls wait for the reactor, so they are made from
+ * another thread than the test thread acting as server.
+ */
+static void *reactor_user_main(void *arg_p)
+{
+    thrd_set_name("mqtt_reactor_user");
+
+    memset(&conn_options, 0, sizeof(conn_options));
+    reactor_user_res = mqtt_client_connect(&reactor_client, &conn_options);
+    sem_give(&reactor_sem, 1);
+    sem_take(&reactor_user_sem, NULL);
+    reactor_user_res = mqtt_client_disconnect(&reactor_client);
+    sem_give(&reactor_sem, 1);
+    thrd_suspend(NULL);
+
+    return (NULL);
+}
+
+static int test_reactor(void)
+{
+    static uint8_t connack[4] = { 0x20, 2, 0, 0 };
+    static uint8_t publish[14] = {
+        (3 << 4), 12, 0, 7, 'f', 'o', 'o', '/', 'b', 'a', 'r', 'f', 'i', 'e'
+    };
+    uint8_t buf[32];
+    ssize_t size;
+
+    BTASSERT(queue_init(&qreactorout,
+                        qreactoroutbuf,
+                        sizeof(qreactoroutbuf)) == 0);
+    BTASSERT(queue_init(&qreactorin,
+                        qreactorinbuf,
+                        sizeof(qreactorinbuf)) == 0);
+    BTASSERT(mqtt_client_init(&reactor_client,
+                              "mqtt_reactor_client",
+                              NULL,
+                              &qreactorout,
+                              &qreactorin,
+                              on_reactor_publish,
+                              on_error) == 0);
+    BTASSERT(reactor_init(&reactor) == 0);
+    BTASSERT(mqtt_client_reactor_add(&reactor_client, &reactor) == 0);
+    BTASSERT(thrd_spawn(reactor_main,
+                        NULL,
+                        0,
+                        reactor_stack,
+                        sizeof(reactor_stack)) != NULL);
+    BTASSERT(sem_init(&reactor_sem, 1, 1) == 0);
+    BTASSERT(sem_init(&reactor_user_sem, 1, 1) == 0);
+    BTASSERT(thrd_spawn(reactor_user_main,
+                        NULL,
+                        0,
+                        reactor_user_stack,
+                        sizeof(reactor_user_stack)) != NULL);
+
+    /* Connect. */
+    BTASSERTI(queue_read(&qreactorout, &buf[0], 2), ==, 2);
+    BTASSERTI(buf[0], ==, 0x10);
+    size = buf[1];
+    BTASSERTI(size, <=, sizeof(buf));
+    BTASSERTI(queue_read(&qreactorout, &buf[0], size), ==, size);
+    BTASSERTI(queue_write(&qreactorin, &connack[0], 4), ==, 4);
+    BTASSERT(sem_take(&reactor_sem, NULL) == 0);
+    BTASSERTI(reactor_user_res, ==, 0);
+
+    /* The control channel is polled again once the connection is
+       acknowledged. */
+    BTASSERTI(reactor_client.reactor.control_added, ==, 1);
+
+    /* Incoming publish. */
+    BTASSERTI(queue_write(&qreactorin, &publish[0], 14), ==, 14);
+    BTASSERT(sem_take(&reactor_sem, NULL) == 0);
+    BTASSERTM(&published_topic[0], "foo/bar", 8);
+    BTASSERTM(&published_message[0], "fie", 3);
+    BTASSERT(published_message_size == 3);
+
+    /* Disconnect. */
+    BTASSERT(sem_give(&reactor_user_sem, 1) == 0);
+    BTASSERTI(queue_read(&qreactorout, &buf[0], 2), ==, 2);
+    BTASSERTI(buf[0], ==, (14 << 4));
+    BTASSERTI(buf[1], ==, 0);
+    BTASSERT(sem_take(&reactor_sem, NULL) == 0);
+    BTASSERTI(reactor_user_res, ==, 0);
+
+    return (0);
+}
+
 int main()
 {
     struct harness_testcase_t testcases[] = {
@@ -594,7 +1196,17 @@ int main()
         { test_incoming_publish_qos0, "test_incoming_publish_qos0" },
         { test_incoming_publish_qos1, "test_incoming_publish_qos1" },
         { test_incoming_publish_qos2, "test_incoming_publish_qos2" },
+        {
+            test_incoming_publish_qos2_duplicate,
+            "test_incoming_publish_qos2_duplicate"
+        },
+        { test_publish_window, "test_publish_window" },
+        { test_publish_qos2, "test_publish_qos2" },
+        { test_reconnect, "test_reconnect" },
+        { test_publish_many, "test_publish_many" },
         { test_disconnect, "test_disconnect" },
+        { test_offline_queue, "test_offline_queue" },
+        { test_reactor, "test_reactor" },
         { NULL, NULL }
     };
 
@@ -102,6 +102,13 @@ ssize_t socket_write(struct socket_t *self_p,
     return (0);
 }
 
+ssize_t socket_writev(struct socket_t *self_p,
+                      const struct iov_t *iov_p,
+                      size_t length)
+{
+    return (0);
+}
+
 ssize_t socket_read(struct socket_t *self_p,
                     void *buf_p,
                     size_t size)
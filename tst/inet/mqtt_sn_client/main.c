@@ -0,0 +1,312 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2014-2018, Erik Moqvist
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use, copy,
+ * modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ * This file is part of the Simba project.
+ */
+
+#include "simba.h"
+
+extern void socket_stub_init(void);
+extern void socket_stub_input(const void *buf_p, size_t size);
+extern ssize_t socket_stub_output(void *buf_p, size_t size);
+
+static struct mqtt_sn_client_t client;
+static uint8_t outbuf[512];
+
+static struct {
+    int count;
+    uint16_t topic_id;
+    uint8_t buf[16];
+    size_t size;
+} published;
+
+static void on_publish(struct mqtt_sn_client_t *self_p,
+                       uint16_t topic_id,
+                       const void *buf_p,
+                       size_t size)
+{
+    published.count++;
+    published.topic_id = topic_id;
+    published.size = MIN(size, sizeof(published.buf));
+    memcpy(&published.buf[0], buf_p, published.size);
+}
+
+/**
+ * Check that the next message sent by the client is given message.
+ */
+static int sent(const void *buf_p, size_t size)
+{
+    BTASSERT(socket_stub_output(&outbuf[0], sizeof(outbuf)) == size);
+    BTASSERT(memcmp(&outbuf[0], buf_p, size) == 0);
+
+    return (0);
+}
+
+static int test_start(void)
+{
+    struct inet_addr_t addr;
+
+    socket_stub_init();
+
+    BTASSERT(inet_aton("1.2.3.4", &addr.ip) == 0);
+    addr.port = 10000;
+
+    BTASSERT(mqtt_sn_client_init(&client,
+                                 &addr,
+                                 "simba",
+                                 on_publish,
+                                 NULL) == 0);
+    BTASSERT(mqtt_sn_client_start(&client) == 0);
+
+    return (0);
+}
+
+static int test_publish_qos_minus_one(void)
+{
+    /* Sent to a predefined topic id without connecting. */
+    BTASSERT(mqtt_sn_client_publish(&client, 5, -1, "on", 2) == 0);
+    BTASSERT(sent("\x09\x0c\x61\x00\x05\x00\x00on", 9) == 0);
+    BTASSERT(socket_stub_output(&outbuf[0], sizeof(outbuf)) == -1);
+
+    /* Other QoS requires a connection. */
+    BTASSERT(mqtt_sn_client_publish(&client, 5, 0, "on", 2) == -ENOTCONN);
+
+    return (0);
+}
+
+static int test_connect(void)
+{
+    int i;
+
+    /* Rejected. */
+    socket_stub_input("\x03\x05\x03", 3);
+    BTASSERT(mqtt_sn_client_connect(&client, 60, 1) == -ECONNREFUSED);
+    BTASSERT(sent("\x0b\x04\x04\x01\x00\x3c" "simba", 11) == 0);
+
+    /* No response. */
+    BTASSERT(mqtt_sn_client_connect(&client, 60, 1) == -ETIMEDOUT);
+
+    for (i = 0; i < 1 + CONFIG_MQTT_SN_CLIENT_RETRY_MAX; i++) {
+        BTASSERT(sent("\x0b\x04\x04\x01\x00\x3c" "simba", 11) == 0);
+    }
+
+    /* Accepted after a retransmission. */
+    socket_stub_input(NULL, 0);
+    socket_stub_input("\x03\x05\x00", 3);
+    BTASSERT(mqtt_sn_client_connect(&client, 60, 0) == 0);
+    BTASSERT(sent("\x0b\x04\x00\x01\x00\x3c" "simba", 11) == 0);
+    BTASSERT(sent("\x0b\x04\x00\x01\x00\x3c" "simba", 11) == 0);
+    BTASSERT(socket_stub_output(&outbuf[0], sizeof(outbuf)) == -1);
+
+    return (0);
+}
+
+static int test_register(void)
+{
+    uint16_t topic_id;
+
+    /* Acknowledgements with other message ids are ignored. */
+    socket_stub_input("\x07\x0b\x00\x29\x00\x07\x00", 7);
+    socket_stub_input("\x07\x0b\x00\x2a\x00\x01\x00", 7);
+    BTASSERT(mqtt_sn_client_register(&client, "a/b", &topic_id) == 0);
+    BTASSERT(topic_id == 0x2a);
+    BTASSERT(sent("\x09\x0a\x00\x00\x00\x01" "a/b", 9) == 0);
+
+    /* Rejected. */
+    socket_stub_input("\x07\x0b\x00\x00\x00\x02\x02", 7);
+    BTASSERT(mqtt_sn_client_register(&client,
+                                     "c",
+                                     &topic_id) == -ECONNREFUSED);
+    BTASSERT(sent("\x07\x0a\x00\x00\x00\x02" "c", 7) == 0);
+
+    return (0);
+}
+
+static int test_publish(void)
+{
+    uint8_t buf[300];
+
+    /* QoS 0. */
+    BTASSERT(mqtt_sn_client_publish(&client, 0x2a, 0, "on", 2) == 0);
+    BTASSERT(sent("\x09\x0c\x00\x00\x2a\x00\x00on", 9) == 0);
+
+    /* QoS 1, retransmitted with the DUP flag set. */
+    socket_stub_input(NULL, 0);
+    socket_stub_input("\x07\x0d\x00\x2a\x00\x03\x00", 7);
+    BTASSERT(mqtt_sn_client_publish(&client, 0x2a, 1, "on", 2) == 0);
+    BTASSERT(sent("\x09\x0c\x20\x00\x2a\x00\x03on", 9) == 0);
+    BTASSERT(sent("\x09\x0c\xa0\x00\x2a\x00\x03on", 9) == 0);
+
+    /* A long message has a three bytes length field. */
+    memset(&buf[0], 'x', sizeof(buf));
+    BTASSERT(mqtt_sn_client_publish(&client,
+                                    0x2a,
+                                    0,
+                                    &buf[0],
+                                    sizeof(buf)) == 0);
+    BTASSERT(socket_stub_output(&outbuf[0], sizeof(outbuf)) == 309);
+    BTASSERT(memcmp(&outbuf[0], "\x01\x01\x35\x0c\x00\x00\x2a\x00\x00", 9) == 0);
+    BTASSERT(memcmp(&outbuf[9], &buf[0], sizeof(buf)) == 0);
+
+    /* Too long. */
+    BTASSERT(mqtt_sn_client_publish(&client,
+                                    0x2a,
+                                    0,
+                                    &outbuf[0],
+                                    sizeof(outbuf)) == -EMSGSIZE);
+
+    return (0);
+}
+
+static int test_subscribe(void)
+{
+    uint16_t topic_id;
+
+    /* A message published by the gateway before the subscribe
+       acknowledgement. */
+    socket_stub_input("\x0a\x0c\x20\x00\x2b\x00\x07xyz", 10);
+    socket_stub_input("\x08\x13\x20\x00\x2b\x00\x04\x00", 8);
+    BTASSERT(mqtt_sn_client_subscribe(&client, "e/f", 1, &topic_id) == 0);
+    BTASSERT(topic_id == 0x2b);
+    BTASSERT(sent("\x08\x12\x20\x00\x04" "e/f", 8) == 0);
+    BTASSERT(sent("\x07\x0d\x00\x2b\x00\x07\x00", 7) == 0);
+    BTASSERT(published.count == 1);
+    BTASSERT(published.topic_id == 0x2b);
+    BTASSERT(published.size == 3);
+    BTASSERT(memcmp(&published.buf[0], "xyz", 3) == 0);
+
+    return (0);
+}
+
+static int test_receive(void)
+{
+    struct time_t timeout;
+
+    timeout.seconds = 0;
+    timeout.nanoseconds = 0;
+
+    /* The gateway registers a topic name matching a wildcard
+       subscription. */
+    socket_stub_input("\x09\x0a\x00\x30\x00\x08" "g/h", 9);
+    BTASSERT(mqtt_sn_client_receive(&client, &timeout) == 0);
+    BTASSERT(sent("\x07\x0b\x00\x30\x00\x08\x00", 7) == 0);
+
+    socket_stub_input("\x08\x0c\x00\x00\x30\x00\x00z", 8);
+    BTASSERT(mqtt_sn_client_receive(&client, &timeout) == 0);
+    BTASSERT(socket_stub_output(&outbuf[0], sizeof(outbuf)) == -1);
+    BTASSERT(published.count == 2);
+    BTASSERT(published.topic_id == 0x30);
+    BTASSERT(published.size == 1);
+
+    /* Gateway ping. */
+    socket_stub_input("\x02\x16", 2);
+    BTASSERT(mqtt_sn_client_receive(&client, &timeout) == 0);
+    BTASSERT(sent("\x02\x17", 2) == 0);
+
+    /* Malformed. */
+    socket_stub_input("\x05\x0c\x00", 3);
+    BTASSERT(mqtt_sn_client_receive(&client, &timeout) == -ETIMEDOUT);
+
+    return (0);
+}
+
+static int test_ping(void)
+{
+    socket_stub_input("\x02\x17", 2);
+    BTASSERT(mqtt_sn_client_ping(&client) == 0);
+    BTASSERT(sent("\x02\x16", 2) == 0);
+
+    return (0);
+}
+
+static int test_sleep(void)
+{
+    socket_stub_input("\x02\x18", 2);
+    BTASSERT(mqtt_sn_client_sleep(&client, 600) == 0);
+    BTASSERT(sent("\x04\x18\x02\x58", 4) == 0);
+    BTASSERT(client.state == mqtt_sn_client_state_asleep_t);
+
+    BTASSERT(mqtt_sn_client_publish(&client, 0x2a, 0, "on", 2) == -ENOTCONN);
+    BTASSERT(mqtt_sn_client_sleep(&client, 600) == -ENOTCONN);
+
+    /* Messages buffered by the gateway are received when awake. */
+    socket_stub_input("\x09\x0c\x00\x00\x2b\x00\x00up", 9);
+    socket_stub_input("\x02\x17", 2);
+    BTASSERT(mqtt_sn_client_ping(&client) == 0);
+    BTASSERT(sent("\x07\x16" "simba", 7) == 0);
+    BTASSERT(published.count == 3);
+    BTASSERT(published.topic_id == 0x2b);
+    BTASSERT(memcmp(&published.buf[0], "up", 2) == 0);
+    BTASSERT(client.state == mqtt_sn_client_state_asleep_t);
+
+    /* Active again. */
+    socket_stub_input("\x03\x05\x00", 3);
+    BTASSERT(mqtt_sn_client_connect(&client, 60, 0) == 0);
+    BTASSERT(sent("\x0b\x04\x00\x01\x00\x3c" "simba", 11) == 0);
+    BTASSERT(client.state == mqtt_sn_client_state_active_t);
+
+    return (0);
+}
+
+static int test_disconnect(void)
+{
+    socket_stub_input("\x02\x18", 2);
+    BTASSERT(mqtt_sn_client_disconnect(&client) == 0);
+    BTASSERT(sent("\x02\x18", 2) == 0);
+    BTASSERT(client.state == mqtt_sn_client_state_disconnected_t);
+
+    return (0);
+}
+
+static int test_stop(void)
+{
+    BTASSERT(mqtt_sn_client_stop(&client) == 0);
+
+    return (0);
+}
+
+int main()
+{
+    struct harness_testcase_t testcases[] = {
+        { test_start, "test_start" },
+        { test_publish_qos_minus_one, "test_publish_qos_minus_one" },
+        { test_connect, "test_connect" },
+        { test_register, "test_register" },
+        { test_publish, "test_publish" },
+        { test_subscribe, "test_subscribe" },
+        { test_receive, "test_receive" },
+        { test_ping, "test_ping" },
+        { test_sleep, "test_sleep" },
+        { test_disconnect, "test_disconnect" },
+        { test_stop, "test_stop" },
+        { NULL, NULL }
+    };
+
+    sys_start();
+
+    harness_run(testcases);
+
+    return (0);
+}
@@ -28,7 +28,7 @@
 
 #include "simba.h"
 
-#define BUFFER_SIZE 128
+#define BUFFER_SIZE 256
 
 extern void socket_stub_input(void *buf_p, size_t size);
 extern void socket_stub_output(void *buf_p, size_t size);
@@ -163,6 +163,7 @@ static int test_cmd_ping(void)
 
 static int test_cmd_ping_bad_reply(void)
 {
+    uint8_t request[8];
     uint8_t reply[28];
     char buf[128];
 
@@ -182,7 +183,12 @@ static int test_cmd_ping_bad_reply(void)
     strcpy(buf, "inet/ping/ping 1.1.1.1\r\n");
     BTASSERT(fs_call(buf, NULL, &qout, NULL) == 0);
     BTASSERT(harness_expect(&qout, "Failed to ping '1.1.1.1'.\r\n", NULL) > 0);
-        
+
+    /* Remove the request from the socket stub. */
+    socket_stub_output(request, sizeof(request));
+    BTASSERT(request[0] == 8);
+    BTASSERT(request[5] == 3);
+
     return (0);
 }
 
@@ -207,6 +213,218 @@ static int test_cmd_ping_bad_input(void)
     return (0);
 }
 
+static struct ping_probe_t probe;
+
+/**
+ * Input an echo reply packet with given id and sequence number.
+ */
+static void input_reply(uint16_t id, uint16_t seqno)
+{
+    uint8_t reply[28];
+    uint16_t checksum;
+
+    memset(&reply[0], 0, sizeof(reply));
+    reply[24] = (id >> 8);
+    reply[25] = id;
+    reply[26] = (seqno >> 8);
+    reply[27] = seqno;
+    checksum = inet_checksum(&reply[20], 8);
+    reply[22] = (checksum >> 8);
+    reply[23] = checksum;
+    socket_stub_input(reply, sizeof(reply));
+}
+
+/**
+ * Read given number of echo requests from the output and check their
+ * sequence numbers.
+ */
+static int check_requests(uint16_t id, int length)
+{
+    uint8_t request[8];
+    int i;
+
+    for (i = 0; i < length; i++) {
+        socket_stub_output(request, sizeof(request));
+        BTASSERT(request[0] == 8);
+        BTASSERT(request[1] == 0);
+        BTASSERTI(inet_checksum(&request[0], sizeof(request)), ==, 0);
+        BTASSERTI(((request[4] << 8) | request[5]), ==, id);
+        BTASSERTI(((request[6] << 8) | request[7]), ==, i);
+    }
+
+    return (0);
+}
+
+static int test_probe(void)
+{
+    struct inet_ip_addr_t address;
+    struct time_t interval, timeout;
+    struct ping_probe_stats_t stats;
+    int i;
+
+    address.number = 0x1;
+    interval.seconds = 0;
+    interval.nanoseconds = 0;
+    timeout.seconds = 1;
+    timeout.nanoseconds = 0;
+
+    BTASSERT(ping_probe_init(&probe, &address, &interval, &timeout) == 0);
+
+    /* More requests than can be outstanding at a time. */
+    for (i = 0; i < 8; i++) {
+        input_reply(probe.id, i);
+    }
+
+    BTASSERT(ping_probe_run(&probe, 8) == 0);
+    BTASSERT(check_requests(probe.id, 8) == 0);
+
+    BTASSERT(ping_probe_get_stats(&probe, &stats) == 0);
+    BTASSERTI(stats.sent, ==, 8);
+    BTASSERTI(stats.received, ==, 8);
+    BTASSERTI(stats.lost, ==, 0);
+    BTASSERTI(stats.unexpected, ==, 0);
+    BTASSERT(stats.min_us <= stats.p50_us);
+    BTASSERT(stats.p50_us <= stats.p99_us);
+    BTASSERT(stats.p99_us <= stats.max_us);
+
+    /* Reset the statistics. */
+    BTASSERT(ping_probe_reset(&probe) == 0);
+    BTASSERT(ping_probe_get_stats(&probe, &stats) == 0);
+    BTASSERTI(stats.sent, ==, 0);
+    BTASSERTI(stats.received, ==, 0);
+    BTASSERTI(stats.max_us, ==, 0);
+
+    return (0);
+}
+
+static int test_probe_lost_and_unexpected(void)
+{
+    struct inet_ip_addr_t address;
+    struct time_t interval, timeout;
+    struct ping_probe_stats_t stats;
+
+    address.number = 0x1;
+    interval.seconds = 0;
+    interval.nanoseconds = 0;
+    timeout.seconds = 0;
+    timeout.nanoseconds = 50000000;
+
+    BTASSERT(ping_probe_init(&probe, &address, &interval, &timeout) == 0);
+
+    /* No reply to request 2, a duplicated reply to request 1 and a
+       reply to another ping, which is ignored. */
+    input_reply(probe.id, 0);
+    input_reply(probe.id, 1);
+    input_reply(probe.id, 1);
+    input_reply(probe.id + 1, 2);
+    input_reply(probe.id, 3);
+
+    BTASSERT(ping_probe_run(&probe, 4) == 0);
+    BTASSERT(check_requests(probe.id, 4) == 0);
+
+    BTASSERT(ping_probe_get_stats(&probe, &stats) == 0);
+    BTASSERTI(stats.sent, ==, 4);
+    BTASSERTI(stats.received, ==, 3);
+    BTASSERTI(stats.lost, ==, 1);
+    BTASSERTI(stats.unexpected, ==, 1);
+
+    return (0);
+}
+
+static int test_probe_interval(void)
+{
+    struct inet_ip_addr_t address;
+    struct time_t interval, timeout, start, stop, elapsed;
+    struct ping_probe_stats_t stats;
+
+    address.number = 0x1;
+    interval.seconds = 0;
+    interval.nanoseconds = 40000000;
+    timeout.seconds = 0;
+    timeout.nanoseconds = 10000000;
+
+    BTASSERT(ping_probe_init(&probe, &address, &interval, &timeout) == 0);
+
+    /* All requests are lost, and sent 40 ms apart. */
+    time_get(&start);
+    BTASSERT(ping_probe_run(&probe, 3) == 0);
+    time_get(&stop);
+    BTASSERT(check_requests(probe.id, 3) == 0);
+
+    time_subtract(&elapsed, &stop, &start);
+    BTASSERT((elapsed.seconds > 0) || (elapsed.nanoseconds >= 80000000));
+
+    BTASSERT(ping_probe_get_stats(&probe, &stats) == 0);
+    BTASSERTI(stats.sent, ==, 3);
+    BTASSERTI(stats.received, ==, 0);
+    BTASSERTI(stats.lost, ==, 3);
+    BTASSERTI(stats.min_us, ==, 0);
+    BTASSERTI(stats.max_us, ==, 0);
+
+    return (0);
+}
+
+static int test_cmd_probe(void)
+{
+    char buf[128];
+
+    /* The command probe gets the next id. */
+    input_reply(probe.id + 1, 0);
+    input_reply(probe.id + 1, 1);
+
+    strcpy(buf, "inet/ping/probe 1.1.1.1 2 0\r\n");
+    BTASSERT(fs_call(buf, NULL, &qout, NULL) == 0);
+    BTASSERT(harness_expect(&qout,
+                            "SENT  RECEIVED  LOST  UNEXPECTED  "
+                            "MIN(us)  P50(us)  P99(us)  MAX(us)\r\n"
+                            "   2         2     0           0  ",
+                            NULL) > 0);
+    BTASSERT(check_requests(probe.id + 1, 2) == 0);
+
+    /* Counters summed over all probes. */
+    strcpy(buf, "inet/ping/probe/sent");
+    BTASSERT(fs_call(buf, NULL, &qout, NULL) == 0);
+    BTASSERT(harness_expect(&qout, "0000000000000011\r\n", NULL) > 0);
+
+    strcpy(buf, "inet/ping/probe/received");
+    BTASSERT(fs_call(buf, NULL, &qout, NULL) == 0);
+    BTASSERT(harness_expect(&qout, "000000000000000d\r\n", NULL) > 0);
+
+    strcpy(buf, "inet/ping/probe/lost");
+    BTASSERT(fs_call(buf, NULL, &qout, NULL) == 0);
+    BTASSERT(harness_expect(&qout, "0000000000000004\r\n", NULL) > 0);
+
+    return (0);
+}
+
+static int test_cmd_probe_bad_input(void)
+{
+    char buf[128];
+
+    strcpy(buf, "inet/ping/probe 1.1.1.1 2\r\n");
+    BTASSERT(fs_call(buf, NULL, &qout, NULL) == -1);
+    BTASSERT(harness_expect(&qout,
+                            "Usage: probe <remote host> <count> "
+                            "<interval ms>\r\n",
+                            NULL) > 0);
+
+    strcpy(buf, "inet/ping/probe a.b.c.d 2 0\r\n");
+    BTASSERT(fs_call(buf, NULL, &qout, NULL) == -1);
+    BTASSERT(harness_expect(&qout,
+                            "Bad ip address 'a.b.c.d'.\r\n",
+                            NULL) > 0);
+
+    strcpy(buf, "inet/ping/probe 1.1.1.1 x 0\r\n");
+    BTASSERT(fs_call(buf, NULL, &qout, NULL) == -1);
+    BTASSERT(harness_expect(&qout, "Bad count 'x'.\r\n", NULL) > 0);
+
+    strcpy(buf, "inet/ping/probe 1.1.1.1 2 -1\r\n");
+    BTASSERT(fs_call(buf, NULL, &qout, NULL) == -1);
+    BTASSERT(harness_expect(&qout, "Bad interval '-1'.\r\n", NULL) > 0);
+
+    return (0);
+}
+
 int main()
 {
     struct harness_testcase_t testcases[] = {
@@ -215,6 +433,11 @@ int main()
         { test_cmd_ping, "test_cmd_ping" },
         { test_cmd_ping_bad_reply, "test_cmd_ping_bad_reply" },
         { test_cmd_ping_bad_input, "test_cmd_ping_bad_input" },
+        { test_probe, "test_probe" },
+        { test_probe_lost_and_unexpected, "test_probe_lost_and_unexpected" },
+        { test_probe_interval, "test_probe_interval" },
+        { test_cmd_probe, "test_cmd_probe" },
+        { test_cmd_probe_bad_input, "test_cmd_probe_bad_input" },
         { NULL, NULL }
     };
 
@@ -116,6 +116,70 @@ static int test_truncate_input(void)
     return (0);
 }
 
+static int test_input_buffer(void)
+{
+    size_t consumed;
+    uint8_t buf[80];
+    int i;
+
+    /* A frame split over two calls. */
+    BTASSERT(slip_input_buffer(&slip,
+                               (uint8_t *)"\xc0\x01\x02\xdb",
+                               4,
+                               &consumed) == 0);
+    BTASSERT(consumed == 4);
+    BTASSERT(slip_input_buffer(&slip,
+                               (uint8_t *)"\xdc\x03\xdb\xdd\xc0",
+                               5,
+                               &consumed) == 5);
+    BTASSERT(consumed == 5);
+    BTASSERT(memcmp(slip.rx.buf_p, "\x01\x02\xc0\x03\xdb", 5) == 0);
+
+    /* Two frames in one buffer. */
+    BTASSERT(slip_input_buffer(&slip,
+                               (uint8_t *)"\xc0\x04\x05\xc0\x06\xc0",
+                               6,
+                               &consumed) == 2);
+    BTASSERT(consumed == 4);
+    BTASSERT(memcmp(slip.rx.buf_p, "\x04\x05", 2) == 0);
+    BTASSERT(slip_input_buffer(&slip,
+                               (uint8_t *)"\x06\xc0",
+                               2,
+                               &consumed) == 1);
+    BTASSERT(consumed == 2);
+    BTASSERT(slip.rx.buf_p[0] == 0x06);
+
+    /* Bad byte after escape byte. */
+    BTASSERT(slip_input_buffer(&slip,
+                               (uint8_t *)"\xc0\x07\xdb\x00\x08",
+                               5,
+                               &consumed) == -1);
+    BTASSERT(consumed == 4);
+
+    /* Truncated frame. */
+    buf[0] = 0xc0;
+
+    for (i = 1; i < sizeof(buf); i++) {
+        buf[i] = i;
+    }
+
+    BTASSERT(slip_input_buffer(&slip,
+                               &buf[0],
+                               sizeof(buf),
+                               &consumed) == -1);
+    BTASSERT(consumed == sizeof(buf));
+    BTASSERT(slip_input_buffer(&slip,
+                               (uint8_t *)"\xc0",
+                               1,
+                               &consumed) == sizeof(slip_buf));
+
+    for (i = 0; i < sizeof(slip_buf); i++) {
+        BTASSERT(slip.rx.buf_p[i] == i + 1);
+    }
+
+    return (0);
+}
+
 int main()
 {
     struct harness_testcase_t testcases[] = {
@@ -124,6 +188,7 @@ int main()
         { test_output, "test_output" },
         { test_bad_input, "test_bad_input" },
         { test_truncate_input, "test_truncate_input" },
+        { test_input_buffer, "test_input_buffer" },
         { NULL, NULL }
     };
 
@@ -0,0 +1,195 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2014-2018, Erik Moqvist
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use, copy,
+ * modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ * This file is part of the Simba project.
+ */
+
+#include "simba.h"
+
+/* Leap indicator 0, version 4 and mode 4 (server). */
+#define HEADER                                          0x24
+
+extern void socket_stub_set_server(int respond,
+                                   uint8_t header,
+                                   uint8_t stratum,
+                                   struct time_t *offset_p);
+
+static struct sntp_client_t client;
+static struct time_t timeout = { .seconds = 1, .nanoseconds = 0 };
+
+static void set_server(int respond,
+                       uint8_t header,
+                       uint8_t stratum,
+                       long seconds,
+                       long nanoseconds)
+{
+    struct time_t offset;
+
+    offset.seconds = seconds;
+    offset.nanoseconds = nanoseconds;
+    socket_stub_set_server(respond, header, stratum, &offset);
+}
+
+static long elapsed_ms(struct time_t *elapsed_p)
+{
+    return (1000L * elapsed_p->seconds + elapsed_p->nanoseconds / 1000000);
+}
+
+static int test_init(void)
+{
+    struct inet_addr_t server;
+
+    BTASSERT(sntp_client_module_init() == 0);
+    BTASSERT(sntp_client_module_init() == 0);
+
+    BTASSERT(inet_aton("192.168.0.1", &server.ip) == 0);
+    server.port = 123;
+    BTASSERT(sntp_client_init(&client, &server) == 0);
+    BTASSERTI(sntp_client_get_poll_interval(&client), ==, 64);
+
+    return (0);
+}
+
+static int test_step(void)
+{
+    struct time_t before;
+    struct time_t after;
+    struct time_t elapsed;
+
+    /* The server is 10 seconds ahead. */
+    set_server(1, HEADER, 2, 10, 0);
+
+    BTASSERT(time_get(&before) == 0);
+    BTASSERTI(sntp_client_sync(&client, &timeout), ==, 0);
+    BTASSERT(time_get(&after) == 0);
+
+    time_subtract(&elapsed, &after, &before);
+    BTASSERTI(elapsed_ms(&elapsed), >=, 9990);
+    BTASSERTI(elapsed_ms(&elapsed), <=, 10010);
+    BTASSERTI(client.offset.seconds, >=, 9);
+    BTASSERTI(client.offset.seconds, <=, 10);
+    BTASSERTI(client.delay, >=, 0);
+    BTASSERTI(client.jitter, ==, 0);
+    BTASSERTI(sntp_client_get_poll_interval(&client), ==, 64);
+    BTASSERTI(time_adjust_get_remaining(), ==, 0);
+
+    return (0);
+}
+
+static int test_slew(void)
+{
+    struct time_t before;
+    struct time_t after;
+    struct time_t elapsed;
+
+    /* A small offset is adjusted gradually and the poll interval is
+       doubled. */
+    set_server(1, HEADER, 2, 0, 10000000);
+
+    BTASSERT(time_get(&before) == 0);
+    BTASSERTI(sntp_client_sync(&client, &timeout), ==, 0);
+    BTASSERT(time_get(&after) == 0);
+
+    time_subtract(&elapsed, &after, &before);
+    BTASSERTI(elapsed_ms(&elapsed), <, 5);
+    BTASSERTI(time_adjust_get_remaining(), >, 9000);
+    BTASSERTI(time_adjust_get_remaining(), <=, 10000);
+    BTASSERTI(client.jitter, ==, 0);
+    BTASSERTI(sntp_client_get_poll_interval(&client), ==, 128);
+
+    /* A new adjustment replaces the remaining part. */
+    set_server(1, HEADER, 2, 0, -2000000);
+
+    BTASSERTI(sntp_client_sync(&client, &timeout), ==, 0);
+    BTASSERTI(time_adjust_get_remaining(), <, -1000);
+    BTASSERTI(time_adjust_get_remaining(), >=, -2100);
+    BTASSERTI(client.jitter, >, 2900);
+    BTASSERTI(client.jitter, <, 3100);
+    BTASSERTI(sntp_client_get_poll_interval(&client), ==, 256);
+
+    /* An offset above the poll threshold halves the poll interval. */
+    set_server(1, HEADER, 2, 0, 100000000);
+
+    BTASSERTI(sntp_client_sync(&client, &timeout), ==, 0);
+    BTASSERTI(time_adjust_get_remaining(), >, 99000);
+    BTASSERTI(sntp_client_get_poll_interval(&client), ==, 128);
+
+    return (0);
+}
+
+static int test_bad_response(void)
+{
+    /* Kiss-of-death packet. */
+    set_server(1, HEADER, 0, 0, 0);
+    BTASSERTI(sntp_client_sync(&client, &timeout), ==, -EPROTO);
+    BTASSERTI(sntp_client_get_poll_interval(&client), ==, 1024);
+
+    /* Unsynchronized server. */
+    set_server(1, 0xc0 | HEADER, 2, 0, 0);
+    BTASSERTI(sntp_client_sync(&client, &timeout), ==, -EPROTO);
+
+    /* Not a server. */
+    set_server(1, 0x23, 2, 0, 0);
+    BTASSERTI(sntp_client_sync(&client, &timeout), ==, -EPROTO);
+
+    return (0);
+}
+
+static int test_timeout(void)
+{
+    struct time_t short_timeout;
+
+    short_timeout.seconds = 0;
+    short_timeout.nanoseconds = 10000000;
+
+    /* Successful synchronization after the step. */
+    set_server(1, HEADER, 2, 0, 0);
+    BTASSERTI(sntp_client_sync(&client, &timeout), ==, 0);
+    BTASSERTI(sntp_client_get_poll_interval(&client), ==, 1024);
+
+    set_server(0, HEADER, 2, 0, 0);
+    BTASSERTI(sntp_client_sync(&client, &short_timeout), ==, -ETIMEDOUT);
+    BTASSERTI(sntp_client_get_poll_interval(&client), ==, 1024);
+
+    return (0);
+}
+
+int main()
+{
+    struct harness_testcase_t testcases[] = {
+        { test_init, "test_init" },
+        { test_step, "test_step" },
+        { test_slew, "test_slew" },
+        { test_bad_response, "test_bad_response" },
+        { test_timeout, "test_timeout" },
+        { NULL, NULL }
+    };
+
+    sys_start();
+
+    harness_run(testcases);
+
+    return (0);
+}
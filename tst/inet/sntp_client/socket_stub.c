@@ -0,0 +1,213 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2014-2018, Erik Moqvist
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use, copy,
+ * modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ * This file is part of the Simba project.
+ */
+
+#include "simba.h"
+
+static struct queue_t qinput;
+static char qinputbuf[128];
+
+static struct {
+    int respond;
+    uint8_t header;
+    uint8_t stratum;
+    struct time_t offset;
+    struct inet_addr_t address;
+} server;
+
+static ssize_t read(void *self_p,
+                    void *buf_p,
+                    size_t size)
+{
+    return (queue_read(&qinput, buf_p, size));
+}
+
+static ssize_t write(void *self_p,
+                     const void *buf_p,
+                     size_t size)
+{
+    return (size);
+}
+
+static void timestamp_add(uint8_t *buf_p, struct time_t *offset_p)
+{
+    uint32_t seconds;
+    uint32_t fraction;
+    uint64_t value;
+
+    seconds = (((uint32_t)buf_p[0] << 24)
+               | ((uint32_t)buf_p[1] << 16)
+               | ((uint32_t)buf_p[2] << 8)
+               | buf_p[3]);
+    fraction = (((uint32_t)buf_p[4] << 24)
+                | ((uint32_t)buf_p[5] << 16)
+                | ((uint32_t)buf_p[6] << 8)
+                | buf_p[7]);
+    value = (((uint64_t)seconds << 32) | fraction);
+    value += ((int64_t)offset_p->seconds * 4294967296LL);
+    value += (((int64_t)offset_p->nanoseconds * 4294967296LL)
+              / 1000000000L);
+    seconds = (value >> 32);
+    fraction = value;
+
+    buf_p[0] = (seconds >> 24);
+    buf_p[1] = (seconds >> 16);
+    buf_p[2] = (seconds >> 8);
+    buf_p[3] = seconds;
+    buf_p[4] = (fraction >> 24);
+    buf_p[5] = (fraction >> 16);
+    buf_p[6] = (fraction >> 8);
+    buf_p[7] = fraction;
+}
+
+int socket_module_init()
+{
+    queue_init(&qinput, qinputbuf, sizeof(qinputbuf));
+
+    return (0);
+}
+
+int socket_open_tcp(struct socket_t *self_p)
+{
+    return (-1);
+}
+
+int socket_open_udp(struct socket_t *self_p)
+{
+    return (chan_init(&self_p->base,
+                      (chan_read_fn_t)socket_read,
+                      (chan_write_fn_t)socket_write,
+                      (chan_size_fn_t)socket_size));
+}
+
+int socket_open_raw(struct socket_t *self_p)
+{
+    return (-1);
+}
+
+int socket_close(struct socket_t *self_p)
+{
+    return (0);
+}
+
+int socket_bind(struct socket_t *self_p,
+                const struct inet_addr_t *local_addr_p)
+{
+    return (0);
+}
+
+int socket_listen(struct socket_t *self_p, int backlog)
+{
+    return (0);
+}
+
+int socket_connect(struct socket_t *self_p,
+                   const struct inet_addr_t *addr_p)
+{
+    return (0);
+}
+
+int socket_accept(struct socket_t *self_p,
+                  struct socket_t *accepted_p,
+                  struct inet_addr_t *addr_p)
+{
+    return (0);
+}
+
+ssize_t socket_sendto(struct socket_t *self_p,
+                      const void *buf_p,
+                      size_t size,
+                      int flags,
+                      const struct inet_addr_t *remote_addr_p)
+{
+    uint8_t response[48];
+
+    if (size != sizeof(response)) {
+        return (-1);
+    }
+
+    server.address = *remote_addr_p;
+
+    if (server.respond == 0) {
+        return (size);
+    }
+
+    /* Respond with the client transmit timestamp as originate
+       timestamp, and the same timestamp plus the server offset as
+       receive and transmit timestamps. */
+    memset(&response[0], 0, sizeof(response));
+    response[0] = server.header;
+    response[1] = server.stratum;
+    memcpy(&response[24], &((uint8_t *)buf_p)[40], 8);
+    memcpy(&response[32], &((uint8_t *)buf_p)[40], 8);
+    timestamp_add(&response[32], &server.offset);
+    memcpy(&response[40], &response[32], 8);
+    chan_write(&qinput, &response[0], sizeof(response));
+
+    return (size);
+}
+
+ssize_t socket_recvfrom(struct socket_t *self_p,
+                        void *buf_p,
+                        size_t size,
+                        int flags,
+                        struct inet_addr_t *remote_addr_p)
+{
+    *remote_addr_p = server.address;
+
+    return (read(NULL, buf_p, size));
+}
+
+ssize_t socket_write(struct socket_t *self_p,
+                     const void *buf_p,
+                     size_t size)
+{
+    return (write(NULL, buf_p, size));
+}
+
+ssize_t socket_read(struct socket_t *self_p,
+                    void *buf_p,
+                    size_t size)
+{
+    return (read(NULL, buf_p, size));
+}
+
+ssize_t socket_size(struct socket_t *self_p)
+{
+    return (queue_size(&qinput));
+}
+
+void socket_stub_set_server(int respond,
+                            uint8_t header,
+                            uint8_t stratum,
+                            struct time_t *offset_p)
+{
+    server.respond = respond;
+    server.header = header;
+    server.stratum = stratum;
+    server.offset = *offset_p;
+}
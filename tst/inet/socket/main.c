@@ -28,6 +28,12 @@
 
 #include "simba.h"
 
+#define BENCHMARK_OPERATIONS                              1000
+
+#ifndef LWIP_TCPIP_CORE_LOCKING
+#    define LWIP_TCPIP_CORE_LOCKING                            0
+#endif
+
 int test_init(void)
 {
     struct socket_t socket;
@@ -40,10 +46,222 @@ int test_init(void)
     return (0);
 }
 
+/**
+ * Measure the rate of socket operations calling into the TCP/IP
+ * stack. Connecting an UDP socket only sets the default remote
+ * address, so the cost is dominated by getting to and from the core
+ * context. Build the suite with CDEFS += LWIP_TCPIP_CORE_LOCKING=1 to
+ * compare with the core locking mode.
+ */
+int test_benchmark(void)
+{
+    struct socket_t udp;
+    struct inet_addr_t addr;
+    struct time_t start;
+    struct time_t stop;
+    struct time_t duration;
+    unsigned long micros;
+    int i;
+
+    BTASSERT(socket_open_udp(&udp) == 0);
+    BTASSERT(inet_aton("127.0.0.1", &addr.ip) == 0);
+    addr.port = 9000;
+
+    BTASSERT(time_get(&start) == 0);
+
+    for (i = 0; i < BENCHMARK_OPERATIONS; i++) {
+        BTASSERT(socket_connect(&udp, &addr) == 0);
+    }
+
+    BTASSERT(time_get(&stop) == 0);
+    BTASSERT(time_subtract(&duration, &stop, &start) == 0);
+
+    micros = (duration.seconds * 1000000 + duration.nanoseconds / 1000);
+
+    if (micros == 0) {
+        micros = 1;
+    }
+
+    std_printf(FSTR("core locking: %d, %d operations in %lu us "
+                    "(%lu operations/s)\r\n"),
+               LWIP_TCPIP_CORE_LOCKING,
+               BENCHMARK_OPERATIONS,
+               micros,
+               (1000000ul * BENCHMARK_OPERATIONS) / micros);
+
+    BTASSERT(socket_close(&udp) == 0);
+
+    return (0);
+}
+
+static struct queue_t queues[2];
+static char queue_bufs[2][16];
+static THRD_STACK(writer_stack, 1024);
+
+static void *writer_main(void *arg_p)
+{
+    thrd_sleep_ms(20);
+    BTASSERTN(queue_write(&queues[1], "b", 1) == 1);
+
+    thrd_suspend(NULL);
+
+    return (NULL);
+}
+
+int test_poll(void)
+{
+    struct socket_pollfd_t fds[2];
+    struct time_t timeout;
+    char c;
+
+    BTASSERT(queue_init(&queues[0], &queue_bufs[0][0], 16) == 0);
+    BTASSERT(queue_init(&queues[1], &queue_bufs[1][0], 16) == 0);
+
+    fds[0].chan_p = &queues[0];
+    fds[0].events = SOCKET_POLLIN;
+    fds[1].chan_p = &queues[1];
+    fds[1].events = SOCKET_POLLIN;
+
+    /* No data available. */
+    timeout.seconds = 0;
+    timeout.nanoseconds = 0;
+    BTASSERTI(socket_poll(&fds[0], 2, &timeout), ==, 0);
+    BTASSERTI(fds[0].revents, ==, 0);
+    BTASSERTI(fds[1].revents, ==, 0);
+
+    /* Data in the first queue. */
+    BTASSERTI(queue_write(&queues[0], "a", 1), ==, 1);
+    BTASSERTI(socket_poll(&fds[0], 2, NULL), ==, 1);
+    BTASSERTI(fds[0].revents, ==, SOCKET_POLLIN);
+    BTASSERTI(fds[1].revents, ==, 0);
+
+    /* Writable events are reported along with readable ones. */
+    fds[1].events = (SOCKET_POLLIN | SOCKET_POLLOUT);
+    BTASSERTI(socket_poll(&fds[0], 2, NULL), ==, 2);
+    BTASSERTI(fds[0].revents, ==, SOCKET_POLLIN);
+    BTASSERTI(fds[1].revents, ==, SOCKET_POLLOUT);
+    BTASSERTI(queue_read(&queues[0], &c, 1), ==, 1);
+    BTASSERTI(c, ==, 'a');
+
+    /* Wait for another thread to write to the second queue. */
+    fds[1].events = SOCKET_POLLIN;
+    BTASSERT(thrd_spawn(writer_main,
+                        NULL,
+                        0,
+                        writer_stack,
+                        sizeof(writer_stack)) != NULL);
+    timeout.seconds = 1;
+    timeout.nanoseconds = 0;
+    BTASSERTI(socket_poll(&fds[0], 2, &timeout), ==, 1);
+    BTASSERTI(fds[0].revents, ==, 0);
+    BTASSERTI(fds[1].revents, ==, SOCKET_POLLIN);
+    BTASSERTI(queue_read(&queues[1], &c, 1), ==, 1);
+    BTASSERTI(c, ==, 'b');
+
+    return (0);
+}
+
+int test_poll_timeout(void)
+{
+    struct socket_pollfd_t fds[1];
+    struct time_t timeout;
+    struct time_t start;
+    struct time_t stop;
+    struct time_t duration;
+
+    fds[0].chan_p = &queues[0];
+    fds[0].events = SOCKET_POLLIN;
+
+    timeout.seconds = 0;
+    timeout.nanoseconds = 30000000;
+
+    BTASSERT(time_get(&start) == 0);
+    BTASSERTI(socket_poll(&fds[0], 1, &timeout), ==, 0);
+    BTASSERT(time_get(&stop) == 0);
+    BTASSERT(time_subtract(&duration, &stop, &start) == 0);
+    BTASSERTI(fds[0].revents, ==, 0);
+    BTASSERTI(duration.seconds, ==, 0);
+    BTASSERTI(duration.nanoseconds, >=, 20000000);
+
+    /* The queue is no longer polled. */
+    BTASSERTI(queue_write(&queues[0], "c", 1), ==, 1);
+    BTASSERTI(socket_poll(&fds[0], 1, &timeout), ==, 1);
+    BTASSERTI(fds[0].revents, ==, SOCKET_POLLIN);
+
+    return (0);
+}
+
+int test_options(void)
+{
+    struct socket_t socket;
+    struct time_t timeout;
+
+    timeout.seconds = 1;
+    timeout.nanoseconds = 0;
+
+    BTASSERTI(socket_set_timeout(&socket, SOCKET_TIMEOUT_RECV, &timeout),
+              ==,
+              0);
+    BTASSERTI(socket.options.recv_timeout.seconds, ==, 1);
+    BTASSERTI(socket_set_timeout(&socket, SOCKET_TIMEOUT_SEND, NULL), ==, 0);
+    BTASSERTI(socket.options.send_timeout.seconds, ==, -1);
+    BTASSERTI(socket_set_timeout(&socket, SOCKET_TIMEOUT_CONNECT, &timeout),
+              ==,
+              0);
+    BTASSERTI(socket.options.connect_timeout.seconds, ==, 1);
+    BTASSERTI(socket_set_timeout(&socket, 3, &timeout), ==, -EINVAL);
+
+    BTASSERTI(socket_set_nonblocking(&socket, 1), ==, 0);
+    BTASSERTI(socket.options.nonblocking, ==, 1);
+    BTASSERTI(socket_set_nonblocking(&socket, 0), ==, 0);
+    BTASSERTI(socket.options.nonblocking, ==, 0);
+
+    return (0);
+}
+
+int test_gethostbyname(void)
+{
+    struct inet_ip_addr_t ip;
+    char buf[64];
+
+    BTASSERT(socket_module_init() == 0);
+
+    /* Dotted decimal addresses are not looked up. */
+    BTASSERT(socket_gethostbyname("192.168.0.1", &ip) == 0);
+    BTASSERT(ip.number == htonl(0xc0a80001));
+
+    /* Cache commands. */
+    BTASSERT(socket_dns_cache_flush() == 0);
+
+#if CONFIG_SOCKET_FS_COMMAND_DNS_CACHE_LIST == 1
+    strcpy(buf, "/inet/socket/dns_cache/list");
+    BTASSERT(fs_call(buf, NULL, sys_get_stdout(), NULL) == 0);
+#endif
+
+#if CONFIG_SOCKET_FS_COMMAND_DNS_CACHE_FLUSH == 1
+    strcpy(buf, "/inet/socket/dns_cache/flush");
+    BTASSERT(fs_call(buf, NULL, sys_get_stdout(), NULL) == 0);
+#endif
+
+    /* Skip the lookup if the TCP/IP stack is not available. */
+#if defined(ARCH_LINUX)
+    BTASSERT(socket_gethostbyname("simba.example.com", &ip) == -ENOSYS);
+
+    return (1);
+#endif
+
+    return (0);
+}
+
 int main()
 {
     struct harness_testcase_t testcases[] = {
         { test_init, "test_init" },
+        { test_benchmark, "test_benchmark" },
+        { test_poll, "test_poll" },
+        { test_poll_timeout, "test_poll_timeout" },
+        { test_options, "test_options" },
+        { test_gethostbyname, "test_gethostbyname" },
         { NULL, NULL }
     };
 
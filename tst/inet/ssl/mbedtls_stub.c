@@ -35,6 +35,7 @@
 #include "mbedtls/x509.h"
 #include "mbedtls/ssl.h"
 #include "mbedtls/ssl_cookie.h"
+#include "mbedtls/ssl_ticket.h"
 #include "mbedtls/net_sockets.h"
 #include "mbedtls/error.h"
 #include "mbedtls/debug.h"
@@ -235,3 +236,74 @@ int mbedtls_ssl_set_hostname(mbedtls_ssl_context *ssl_p,
     
     return (0);
 }
+
+void mbedtls_ssl_session_init(mbedtls_ssl_session *session_p)
+{
+}
+
+void mbedtls_ssl_session_free(mbedtls_ssl_session *session_p)
+{
+}
+
+int mbedtls_ssl_get_session(const mbedtls_ssl_context *ssl_p,
+                            mbedtls_ssl_session *session_p)
+{
+    return (0);
+}
+
+int mbedtls_ssl_set_session(mbedtls_ssl_context *ssl_p,
+                            const mbedtls_ssl_session *session_p)
+{
+    return (0);
+}
+
+void mbedtls_ssl_ticket_init(mbedtls_ssl_ticket_context *ctx_p)
+{
+}
+
+int mbedtls_ssl_ticket_setup(mbedtls_ssl_ticket_context *ctx_p,
+                             int (*f_rng)(void *, unsigned char *, size_t),
+                             void *p_rng,
+                             mbedtls_cipher_type_t cipher,
+                             uint32_t lifetime)
+{
+    return (0);
+}
+
+void mbedtls_ssl_ticket_free(mbedtls_ssl_ticket_context *ctx_p)
+{
+}
+
+int mbedtls_ssl_ticket_write(void *p_ticket,
+                             const mbedtls_ssl_session *session_p,
+                             unsigned char *start_p,
+                             const unsigned char *end_p,
+                             size_t *tlen_p,
+                             uint32_t *lifetime_p)
+{
+    return (-1);
+}
+
+int mbedtls_ssl_ticket_parse(void *p_ticket,
+                             mbedtls_ssl_session *session_p,
+                             unsigned char *buf_p,
+                             size_t len)
+{
+    return (-1);
+}
+
+void mbedtls_ssl_conf_session_tickets_cb(mbedtls_ssl_config *conf_p,
+                                         mbedtls_ssl_ticket_write_t *f_ticket_write,
+                                         mbedtls_ssl_ticket_parse_t *f_ticket_parse,
+                                         void *p_ticket)
+{
+}
+
+int mbedtls_entropy_add_source(mbedtls_entropy_context *ctx_p,
+                               mbedtls_entropy_f_source_ptr f_source,
+                               void *p_source,
+                               size_t threshold,
+                               int strong)
+{
+    return (0);
+}
@@ -36,7 +36,8 @@ extern void socket_stub_wait_closed(void);
 extern void socket_stub_close_connection(void);
 
 static struct tftp_server_t server;
-static THRD_STACK(listener_stack, 2048);
+static THRD_STACK(listener_stack, 4096);
+static uint8_t inbuf[2][1100];
 
 static int test_start(void)
 {
@@ -242,6 +243,155 @@ static int test_write(void)
     return (0);
 }
 
+static int test_read_options(void)
+{
+    struct fs_file_t file;
+    uint8_t byte;
+    uint8_t buf[1028];
+    int i;
+
+    BTASSERT(fs_open(&file, "foo.txt", FS_WRITE | FS_CREAT | FS_TRUNC) == 0);
+
+    byte = 0;
+
+    for (i = 0; i < 1201; i++) {
+        BTASSERT(fs_write(&file, &byte, 1) == 1);
+        byte++;
+    }
+
+    BTASSERT(fs_close(&file) == 0);
+
+    /* Input read request packet with options. The unknown option is
+       ignored. */
+    memcpy(&inbuf[0][0],
+           "\x00""\x01""foo.txt""\x00""octet""\x00"
+           "BLKSIZE""\x00""600""\x00"
+           "foo""\x00""bar""\x00"
+           "windowsize""\x00""2""\x00"
+           "tsize""\x00""0""\x00",
+           56);
+    socket_stub_input(0, &inbuf[0][0], 56);
+
+    /* Wait for the option acknowledgement. */
+    socket_stub_output(&buf[0], 38);
+    BTASSERT(memcmp(&buf[0],
+                    "\x00""\x06"
+                    "blksize""\x00""600""\x00"
+                    "windowsize""\x00""2""\x00"
+                    "tsize""\x00""1201""\x00",
+                    38) == 0);
+
+    /* Acknowledge the options. */
+    socket_stub_input(1, "\x00""\x04""\x00""\x00", 4);
+
+    /* Wait for a window of two data packets, (bytes 0..599) and
+       (bytes 600..1199). */
+    byte = 0;
+
+    for (i = 1; i <= 2; i++) {
+        socket_stub_output(&buf[0], 604);
+        BTASSERT(buf[0] == 0);
+        BTASSERT(buf[1] == 3);
+        BTASSERT(buf[2] == 0);
+        BTASSERT(buf[3] == i);
+        BTASSERT(buf[4] == (uint8_t)(600 * (i - 1)));
+        BTASSERT(buf[603] == (uint8_t)(600 * i - 1));
+    }
+
+    /* Acknowledge the first block only. The window is retransmitted
+       from block two. */
+    socket_stub_input(1, "\x00""\x04""\x00""\x01", 4);
+
+    socket_stub_output(&buf[0], 604);
+    BTASSERT(buf[3] == 2);
+    BTASSERT(buf[4] == (uint8_t)600);
+
+    /* The last data packet (byte 1200). */
+    socket_stub_output(&buf[0], 5);
+    BTASSERT(buf[0] == 0);
+    BTASSERT(buf[1] == 3);
+    BTASSERT(buf[2] == 0);
+    BTASSERT(buf[3] == 3);
+    BTASSERT(buf[4] == (uint8_t)1200);
+
+    /* Input last acknowlegement packet. */
+    socket_stub_input(1, "\x00""\x04""\x00""\x03", 4);
+
+    thrd_sleep_ms(10);
+
+    return (0);
+}
+
+static int test_write_options(void)
+{
+    struct fs_file_t file;
+    uint8_t byte;
+    uint8_t buf[1028];
+    int i;
+
+    /* Input write request packet with a too big block size. */
+    memcpy(&inbuf[0][0],
+           "\x00""\x02""bar.txt""\x00""octet""\x00"
+           "blksize""\x00""2000""\x00"
+           "windowsize""\x00""2""\x00",
+           42);
+    socket_stub_input(0, &inbuf[0][0], 42);
+
+    /* Wait for the option acknowledgement. */
+    socket_stub_output(&buf[0], 28);
+    BTASSERT(memcmp(&buf[0],
+                    "\x00""\x06"
+                    "blksize""\x00""1024""\x00"
+                    "windowsize""\x00""2""\x00",
+                    28) == 0);
+
+    /* Write a window of two data packets (bytes 0..2047). Only the
+       second is acknowledged. */
+    for (i = 0; i < 2; i++) {
+        inbuf[i][0] = 0;
+        inbuf[i][1] = 3;
+        inbuf[i][2] = 0;
+        inbuf[i][3] = (i + 1);
+        memset(&inbuf[i][4], i + 1, 1024);
+        socket_stub_input(2, &inbuf[i][0], 1028);
+        thrd_sleep_ms(10);
+    }
+
+    socket_stub_output(&buf[0], 4);
+    BTASSERT(memcmp(&buf[0], "\x00""\x04""\x00""\x02", 4) == 0);
+
+    /* Block four out of order. The last received block is
+       acknowledged again. */
+    inbuf[0][3] = 4;
+    socket_stub_input(2, &inbuf[0][0], 14);
+
+    socket_stub_output(&buf[0], 4);
+    BTASSERT(memcmp(&buf[0], "\x00""\x04""\x00""\x02", 4) == 0);
+
+    /* The last data packet (bytes 2048..2057). */
+    inbuf[0][3] = 3;
+    memset(&inbuf[0][4], 3, 10);
+    socket_stub_input(2, &inbuf[0][0], 14);
+
+    socket_stub_output(&buf[0], 4);
+    BTASSERT(memcmp(&buf[0], "\x00""\x04""\x00""\x03", 4) == 0);
+
+    thrd_sleep_ms(10);
+
+    /* Verify the contents of the file created by the TFTP server. */
+    BTASSERT(fs_open(&file, "bar.txt", FS_READ) == 0);
+
+    for (i = 0; i < 2058; i++) {
+        BTASSERT(fs_read(&file, &byte, 1) == 1);
+        BTASSERT(byte == (i / 1024) + 1);
+    }
+
+    BTASSERT(fs_read(&file, &byte, 1) == 0);
+    BTASSERT(fs_close(&file) == 0);
+
+    return (0);
+}
+
 static int test_read_timeout(void)
 {
     struct fs_file_t file;
@@ -376,6 +526,8 @@ int main()
         { test_start, "test_start" },
         { test_read, "test_read" },
         { test_write, "test_write" },
+        { test_read_options, "test_read_options" },
+        { test_write_options, "test_write_options" },
         { test_read_timeout, "test_read_timeout" },
         { test_write_timeout, "test_write_timeout" },
         { test_bad_request, "test_bad_request" },
@@ -0,0 +1,460 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2014-2018, Erik Moqvist
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use, copy,
+ * modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ * This file is part of the Simba project.
+ */
+
+/* Benchmarks of kernel and synchronization primitives. The results
+   are the number of cycles per iteration, see
+   harness_run_benchmarks(). */
+
+#include "simba.h"
+
+#if defined(ARCH_ESP32)
+#    define STACK_SIZE 1024
+#elif defined(ARCH_ARM64)
+#    define STACK_SIZE 4096
+#else
+#    define STACK_SIZE 512
+#endif
+
+#define TIMERS_MAX                                          64
+#define CHANNELS_MAX                                        32
+
+static THRD_STACK(yield_stack, STACK_SIZE);
+static THRD_STACK(resume_stack, STACK_SIZE);
+static THRD_STACK(queue_stack, STACK_SIZE);
+static THRD_STACK(sem_stack, STACK_SIZE);
+static THRD_STACK(mutex_stack, STACK_SIZE);
+
+static struct thrd_t *main_p;
+static struct thrd_t *yield_thrd_p;
+static struct thrd_t *resume_thrd_p;
+
+static volatile int yielding;
+
+static struct queue_t queue_ping;
+static struct queue_t queue_pong;
+static uint32_t queue_ping_buf[1];
+static uint32_t queue_pong_buf[1];
+
+static struct sem_t sem_ping;
+static struct sem_t sem_pong;
+
+static struct mutex_t mutex;
+static struct sem_t mutex_go;
+static struct sem_t mutex_done;
+
+static struct timer_t timers[TIMERS_MAX];
+static struct timer_t timer;
+static int number_of_active_timers;
+
+static struct queue_t channels[CHANNELS_MAX];
+static uint8_t channels_buf[CHANNELS_MAX][4];
+static struct chan_list_t list;
+static struct chan_list_elem_t list_elements[CHANNELS_MAX];
+static int number_of_polled_channels;
+
+/**
+ * Yields to the main thread while the yield benchmark is running.
+ */
+static void *yield_main(void *arg_p)
+{
+    thrd_set_name("yield");
+
+    while (1) {
+        if (yielding == 1) {
+            thrd_yield();
+        } else {
+            thrd_suspend(NULL);
+        }
+    }
+
+    return (NULL);
+}
+
+/**
+ * Resumes the main thread every time it is resumed.
+ */
+static void *resume_main(void *arg_p)
+{
+    thrd_set_name("resume");
+
+    while (1) {
+        thrd_suspend(NULL);
+        thrd_resume(main_p, 0);
+    }
+
+    return (NULL);
+}
+
+static void *queue_main(void *arg_p)
+{
+    uint32_t value;
+
+    thrd_set_name("queue");
+
+    while (1) {
+        queue_read(&queue_ping, &value, sizeof(value));
+        queue_write(&queue_pong, &value, sizeof(value));
+    }
+
+    return (NULL);
+}
+
+static void *sem_main(void *arg_p)
+{
+    thrd_set_name("sem");
+
+    while (1) {
+        sem_take(&sem_ping, NULL);
+        sem_give(&sem_pong, 1);
+    }
+
+    return (NULL);
+}
+
+/**
+ * Waits for the mutex held by the main thread.
+ */
+static void *mutex_main(void *arg_p)
+{
+    thrd_set_name("mutex");
+
+    while (1) {
+        sem_take(&mutex_go, NULL);
+        mutex_lock(&mutex);
+        mutex_unlock(&mutex);
+        sem_give(&mutex_done, 1);
+    }
+
+    return (NULL);
+}
+
+static void timer_cb(void *arg_p)
+{
+}
+
+/**
+ * Start given number of timers with timeouts shorter than the
+ * benchmarked timer's, so the benchmarked timer is inserted after
+ * all of them.
+ */
+static void timers_set_active(int number_of_timers)
+{
+    while (number_of_active_timers < number_of_timers) {
+        timer_start(&timers[number_of_active_timers]);
+        number_of_active_timers++;
+    }
+
+    while (number_of_active_timers > number_of_timers) {
+        number_of_active_timers--;
+        timer_stop(&timers[number_of_active_timers]);
+    }
+}
+
+/**
+ * Poll given number of channels, with data in the last channel only.
+ */
+static void channels_set_polled(int number_of_channels)
+{
+    int i;
+
+    if (number_of_polled_channels == number_of_channels) {
+        return;
+    }
+
+    chan_list_destroy(&list);
+    chan_list_init(&list, &list_elements[0], membersof(list_elements));
+
+    for (i = 0; i < number_of_channels; i++) {
+        chan_list_add(&list, &channels[i]);
+    }
+
+    number_of_polled_channels = number_of_channels;
+}
+
+static int benchmark_thrd_yield(int iterations)
+{
+    int i;
+
+    yielding = 1;
+    thrd_resume(yield_thrd_p, 0);
+
+    /* Two context switches per iteration. */
+    for (i = 0; i < iterations; i++) {
+        thrd_yield();
+    }
+
+    /* Let the yield thread suspend itself. */
+    yielding = 0;
+    thrd_yield();
+
+    return (0);
+}
+
+static int benchmark_thrd_resume_isr(int iterations)
+{
+    int i;
+
+    /* Resume the thread from "interrupt context" and wait for it to
+       run and resume the main thread. */
+    for (i = 0; i < iterations; i++) {
+        sys_lock();
+        thrd_resume_isr(resume_thrd_p, 0);
+        sys_unlock();
+        thrd_suspend(NULL);
+    }
+
+    return (0);
+}
+
+static int benchmark_queue_round_trip(int iterations)
+{
+    int i;
+    uint32_t value;
+
+    for (i = 0; i < iterations; i++) {
+        value = i;
+        queue_write(&queue_ping, &value, sizeof(value));
+        queue_read(&queue_pong, &value, sizeof(value));
+
+        if (value != (uint32_t)i) {
+            return (-1);
+        }
+    }
+
+    return (0);
+}
+
+static int benchmark_sem_handoff(int iterations)
+{
+    int i;
+
+    for (i = 0; i < iterations; i++) {
+        sem_give(&sem_ping, 1);
+        sem_take(&sem_pong, NULL);
+    }
+
+    return (0);
+}
+
+static int benchmark_mutex_lock_unlock(int iterations)
+{
+    int i;
+
+    for (i = 0; i < iterations; i++) {
+        mutex_lock(&mutex);
+        mutex_unlock(&mutex);
+    }
+
+    return (0);
+}
+
+static int benchmark_mutex_handoff(int iterations)
+{
+    int i;
+
+    /* The mutex thread has higher priority than the main thread. It
+       runs when the main thread yields, and blocks on the mutex until
+       the main thread unlocks it. */
+    for (i = 0; i < iterations; i++) {
+        mutex_lock(&mutex);
+        sem_give(&mutex_go, 1);
+        thrd_yield();
+        mutex_unlock(&mutex);
+        sem_take(&mutex_done, NULL);
+    }
+
+    return (0);
+}
+
+static int benchmark_timer_start_stop(int iterations, int number_of_timers)
+{
+    int i;
+
+    timers_set_active(number_of_timers);
+
+    for (i = 0; i < iterations; i++) {
+        timer_start(&timer);
+        timer_stop(&timer);
+    }
+
+    return (0);
+}
+
+static int benchmark_timer_start_stop_0(int iterations)
+{
+    return (benchmark_timer_start_stop(iterations, 0));
+}
+
+static int benchmark_timer_start_stop_8(int iterations)
+{
+    return (benchmark_timer_start_stop(iterations, 8));
+}
+
+static int benchmark_timer_start_stop_64(int iterations)
+{
+    return (benchmark_timer_start_stop(iterations, 64));
+}
+
+static int benchmark_chan_list_poll(int iterations, int number_of_channels)
+{
+    int i;
+    uint8_t value;
+    void *chan_p;
+
+    channels_set_polled(number_of_channels);
+
+    for (i = 0; i < iterations; i++) {
+        value = i;
+        queue_write(&channels[number_of_channels - 1],
+                    &value,
+                    sizeof(value));
+        chan_p = chan_list_poll(&list, NULL);
+
+        if (chan_p != &channels[number_of_channels - 1]) {
+            return (-1);
+        }
+
+        queue_read(chan_p, &value, sizeof(value));
+    }
+
+    return (0);
+}
+
+static int benchmark_chan_list_poll_1(int iterations)
+{
+    return (benchmark_chan_list_poll(iterations, 1));
+}
+
+static int benchmark_chan_list_poll_8(int iterations)
+{
+    return (benchmark_chan_list_poll(iterations, 8));
+}
+
+static int benchmark_chan_list_poll_32(int iterations)
+{
+    return (benchmark_chan_list_poll(iterations, 32));
+}
+
+static int init(void)
+{
+    int i;
+    struct time_t timeout;
+
+    main_p = thrd_self();
+
+    queue_init(&queue_ping, &queue_ping_buf[0], sizeof(queue_ping_buf));
+    queue_init(&queue_pong, &queue_pong_buf[0], sizeof(queue_pong_buf));
+    sem_init(&sem_ping, 1, 1);
+    sem_init(&sem_pong, 1, 1);
+    mutex_init(&mutex);
+    sem_init(&mutex_go, 1, 1);
+    sem_init(&mutex_done, 1, 1);
+
+    for (i = 0; i < TIMERS_MAX; i++) {
+        timeout.seconds = (1000 + i);
+        timeout.nanoseconds = 0;
+        timer_init(&timers[i], &timeout, timer_cb, NULL, 0);
+    }
+
+    timeout.seconds = 2000;
+    timeout.nanoseconds = 0;
+    timer_init(&timer, &timeout, timer_cb, NULL, 0);
+    number_of_active_timers = 0;
+
+    for (i = 0; i < CHANNELS_MAX; i++) {
+        queue_init(&channels[i], &channels_buf[i][0], sizeof(channels_buf[i]));
+    }
+
+    chan_list_init(&list, &list_elements[0], membersof(list_elements));
+    number_of_polled_channels = 0;
+
+    /* The yield thread has the same priority as the main thread, and
+       all other threads higher priority. */
+    yield_thrd_p = thrd_spawn(yield_main,
+                              NULL,
+                              0,
+                              yield_stack,
+                              sizeof(yield_stack));
+    resume_thrd_p = thrd_spawn(resume_main,
+                               NULL,
+                               -1,
+                               resume_stack,
+                               sizeof(resume_stack));
+    thrd_spawn(queue_main, NULL, -1, queue_stack, sizeof(queue_stack));
+    thrd_spawn(sem_main, NULL, -1, sem_stack, sizeof(sem_stack));
+    thrd_spawn(mutex_main, NULL, -1, mutex_stack, sizeof(mutex_stack));
+
+    if ((yield_thrd_p == NULL) || (resume_thrd_p == NULL)) {
+        return (-1);
+    }
+
+    /* Let all threads block. */
+    thrd_yield();
+
+    return (0);
+}
+
+static int test_benchmarks(void)
+{
+    struct harness_benchmark_t benchmarks[] = {
+        { benchmark_thrd_yield, "thrd_yield" },
+        { benchmark_thrd_resume_isr, "thrd_resume_isr" },
+        { benchmark_queue_round_trip, "queue_round_trip" },
+        { benchmark_sem_handoff, "sem_handoff" },
+        { benchmark_mutex_lock_unlock, "mutex_lock_unlock" },
+        { benchmark_mutex_handoff, "mutex_handoff" },
+        { benchmark_timer_start_stop_0, "timer_start_stop_0" },
+        { benchmark_timer_start_stop_8, "timer_start_stop_8" },
+        { benchmark_timer_start_stop_64, "timer_start_stop_64" },
+        { benchmark_chan_list_poll_1, "chan_list_poll_1" },
+        { benchmark_chan_list_poll_8, "chan_list_poll_8" },
+        { benchmark_chan_list_poll_32, "chan_list_poll_32" },
+        { NULL, NULL }
+    };
+
+    BTASSERT(init() == 0);
+    BTASSERT(harness_run_benchmarks(&benchmarks[0]) == 0);
+
+    timers_set_active(0);
+
+    return (0);
+}
+
+int main()
+{
+    struct harness_testcase_t testcases[] = {
+        { test_benchmarks, "test_benchmarks" },
+        { NULL, NULL }
+    };
+
+    sys_start();
+
+    harness_run(testcases);
+
+    return (0);
+}
@@ -0,0 +1,256 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2014-2018, Erik Moqvist
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use, copy,
+ * modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ * This file is part of the Simba project.
+ */
+
+#include "simba.h"
+
+#if defined(ARCH_ESP32) || defined(ARCH_PPC)
+static THRD_STACK(writer_stacks[2], 512);
+#elif defined(ARCH_ARM64)
+static THRD_STACK(writer_stacks[2], 1024);
+#else
+static THRD_STACK(writer_stacks[2], 256);
+#endif
+
+struct counter_t {
+    int id;
+    int count;
+    struct time_t timeout;
+};
+
+static struct coro_scheduler_t scheduler;
+static struct chan_list_elem_t elements[3];
+static char trace[16];
+static int trace_length;
+static struct queue_t queue;
+static char queue_buf[8];
+static struct event_t event;
+
+static int yield_main(struct coro_t *self_p, void *arg_p)
+{
+    struct counter_t *counter_p;
+
+    counter_p = arg_p;
+
+    CORO_BEGIN(self_p);
+
+    for (counter_p->count = 0; counter_p->count < 3; counter_p->count++) {
+        trace[trace_length++] = ('a' + counter_p->id);
+        CORO_YIELD(self_p);
+    }
+
+    CORO_END(self_p);
+}
+
+static int sleep_main(struct coro_t *self_p, void *arg_p)
+{
+    struct counter_t *counter_p;
+
+    counter_p = arg_p;
+
+    CORO_BEGIN(self_p);
+
+    CORO_SLEEP(self_p, &counter_p->timeout);
+    trace[trace_length++] = ('a' + counter_p->id);
+
+    CORO_END(self_p);
+}
+
+static int queue_main(struct coro_t *self_p, void *arg_p)
+{
+    char c;
+
+    CORO_BEGIN(self_p);
+
+    while (1) {
+        CORO_AWAIT_CHAN(self_p, &queue);
+        BTASSERTI(queue_read(&queue, &c, 1), ==, 1);
+
+        if (c == '.') {
+            break;
+        }
+
+        trace[trace_length++] = c;
+    }
+
+    CORO_END(self_p);
+}
+
+static int event_main(struct coro_t *self_p, void *arg_p)
+{
+    uint32_t mask;
+
+    CORO_BEGIN(self_p);
+
+    CORO_AWAIT_CHAN(self_p, &event);
+    mask = 0x1;
+    BTASSERTI(event_read(&event, &mask, sizeof(mask)), ==, sizeof(mask));
+    trace[trace_length++] = 'e';
+
+    CORO_END(self_p);
+}
+
+static void *writer_main(void *arg_p)
+{
+    uint32_t mask;
+
+    thrd_sleep_ms(10);
+    queue_write(&queue, "x", 1);
+    thrd_sleep_ms(10);
+    mask = 0x1;
+    event_write(&event, &mask, sizeof(mask));
+    thrd_sleep_ms(10);
+    queue_write(&queue, "y.", 2);
+
+    return (NULL);
+}
+
+static int test_yield(void)
+{
+    struct coro_t coros[2];
+    struct counter_t counters[2];
+
+    trace_length = 0;
+    counters[0].id = 0;
+    counters[1].id = 1;
+
+    BTASSERT(coro_scheduler_init(&scheduler,
+                                 &elements[0],
+                                 membersof(elements)) == 0);
+    BTASSERT(coro_spawn(&coros[0], &scheduler, yield_main, &counters[0]) == 0);
+    BTASSERT(coro_spawn(&coros[1], &scheduler, yield_main, &counters[1]) == 0);
+    BTASSERT(coro_scheduler_run(&scheduler) == 0);
+
+    /* The coroutines take turns. */
+    BTASSERTI(trace_length, ==, 6);
+    BTASSERTM(&trace[0], "ababab", 6);
+
+    return (0);
+}
+
+static int test_sleep(void)
+{
+    struct coro_t coros[3];
+    struct counter_t counters[3];
+    int i;
+    int timeouts_ms[3] = { 30, 10, 20 };
+
+    trace_length = 0;
+
+    BTASSERT(coro_scheduler_init(&scheduler,
+                                 &elements[0],
+                                 membersof(elements)) == 0);
+
+    for (i = 0; i < membersof(coros); i++) {
+        counters[i].id = i;
+        counters[i].timeout.seconds = 0;
+        counters[i].timeout.nanoseconds = (timeouts_ms[i] * 1000000L);
+        BTASSERT(coro_spawn(&coros[i],
+                            &scheduler,
+                            sleep_main,
+                            &counters[i]) == 0);
+    }
+
+    BTASSERT(coro_scheduler_run(&scheduler) == 0);
+
+    /* Shortest sleep first. */
+    BTASSERTI(trace_length, ==, 3);
+    BTASSERTM(&trace[0], "bca", 3);
+
+    return (0);
+}
+
+static int test_await_chan(void)
+{
+    struct coro_t coros[2];
+
+    trace_length = 0;
+
+    BTASSERT(queue_init(&queue, &queue_buf[0], sizeof(queue_buf)) == 0);
+    BTASSERT(event_init(&event) == 0);
+    BTASSERT(coro_scheduler_init(&scheduler,
+                                 &elements[0],
+                                 membersof(elements)) == 0);
+    BTASSERT(coro_spawn(&coros[0], &scheduler, queue_main, NULL) == 0);
+    BTASSERT(coro_spawn(&coros[1], &scheduler, event_main, NULL) == 0);
+    BTASSERT(thrd_spawn(writer_main,
+                        NULL,
+                        10,
+                        writer_stacks[0],
+                        sizeof(writer_stacks[0])) != NULL);
+    BTASSERT(coro_scheduler_run(&scheduler) == 0);
+
+    BTASSERTI(trace_length, ==, 3);
+    BTASSERTM(&trace[0], "xey", 3);
+
+    return (0);
+}
+
+static int test_too_many_channels(void)
+{
+    struct coro_t coros[2];
+    struct chan_list_elem_t element;
+
+    trace_length = 0;
+
+    BTASSERT(queue_init(&queue, &queue_buf[0], sizeof(queue_buf)) == 0);
+    BTASSERT(event_init(&event) == 0);
+
+    /* Only room for the scheduler event, so the channels are
+       polled. */
+    BTASSERT(coro_scheduler_init(&scheduler, &element, 1) == 0);
+    BTASSERT(coro_spawn(&coros[0], &scheduler, queue_main, NULL) == 0);
+    BTASSERT(coro_spawn(&coros[1], &scheduler, event_main, NULL) == 0);
+    BTASSERT(thrd_spawn(writer_main,
+                        NULL,
+                        10,
+                        writer_stacks[1],
+                        sizeof(writer_stacks[1])) != NULL);
+    BTASSERT(coro_scheduler_run(&scheduler) == 0);
+
+    BTASSERTI(trace_length, ==, 3);
+    BTASSERTM(&trace[0], "xey", 3);
+
+    return (0);
+}
+
+int main()
+{
+    struct harness_testcase_t testcases[] = {
+        { test_yield, "test_yield" },
+        { test_sleep, "test_sleep" },
+        { test_await_chan, "test_await_chan" },
+        { test_too_many_channels, "test_too_many_channels" },
+        { NULL, NULL }
+    };
+
+    sys_start();
+
+    harness_run(testcases);
+
+    return (0);
+}
@@ -356,6 +356,104 @@ int test_errno(void)
     return (0);
 }
 
+int test_lock_prio(void)
+{
+    int state1;
+    int state2;
+    struct time_t time;
+
+    /* Nested critical sections. */
+    state1 = sys_lock_prio(0x80);
+    state2 = sys_lock_prio(0x40);
+    sys_unlock_prio(state2);
+    sys_unlock_prio(state1);
+
+    /* The system is unlocked again. */
+    sys_lock();
+    sys_unlock();
+    BTASSERT(time_get(&time) == 0);
+
+    return (0);
+}
+
+static int memory_usage(void *arg_p,
+                        struct sys_memory_usage_t *usage_p)
+{
+    usage_p->used = -1;
+    usage_p->used_max = *(ssize_t *)arg_p;
+
+    return (0);
+}
+
+int test_memory(void)
+{
+    static uint8_t buf[64];
+    static ssize_t used_max = 16;
+    static struct sys_memory_region_t static_region;
+    static struct sys_memory_region_t dynamic_region;
+    struct sys_memory_usage_t usage;
+
+    BTASSERT(sys_memory_region_init(&static_region,
+                                    "test_static",
+                                    &buf[0],
+                                    sizeof(buf),
+                                    NULL,
+                                    NULL) == 0);
+    BTASSERT(sys_memory_region_register(&static_region) == 0);
+    BTASSERT(sys_memory_region_init(&dynamic_region,
+                                    "test_dynamic",
+                                    NULL,
+                                    128,
+                                    memory_usage,
+                                    &used_max) == 0);
+    BTASSERT(sys_memory_region_register(&dynamic_region) == 0);
+
+    /* A region without a usage callback is always fully used. */
+    BTASSERT(sys_memory_region_get_usage(&static_region, &usage) == 0);
+    BTASSERTI(usage.size, ==, 64);
+    BTASSERTI(usage.used, ==, 64);
+    BTASSERTI(usage.used_max, ==, 64);
+
+    BTASSERT(sys_memory_region_get_usage(&dynamic_region, &usage) == 0);
+    BTASSERTI(usage.size, ==, 128);
+    BTASSERTI(usage.used, ==, -1);
+    BTASSERTI(usage.used_max, ==, 16);
+
+    BTASSERT(sys_memory_print(sys_get_stdout()) == 0);
+
+#if CONFIG_SYS_FS_COMMANDS == 1
+    char command[32];
+
+    strcpy(command, "/kernel/sys/memory");
+    BTASSERT(fs_call(command, chan_null(), sys_get_stdout(), NULL) == 0);
+#endif
+
+    return (0);
+}
+
+int test_start(void)
+{
+    static char buf[64];
+    struct queue_t queue;
+
+    /* The services are started by sys_start() itself. */
+    BTASSERT(sys_start_wait() == 0);
+
+    /* No start times are measured by default. */
+    BTASSERT(queue_init(&queue, &buf[0], sizeof(buf)) == 0);
+    BTASSERT(sys_start_print(&queue) == -ENOSYS);
+
+#if CONFIG_SYS_FS_COMMANDS == 1
+    char command[32];
+
+    strcpy(command, "/kernel/sys/start");
+    BTASSERT(fs_call(command, chan_null(), sys_get_stdout(), NULL)
+             == -ENOSYS);
+#endif
+
+    return (0);
+}
+
 int main()
 {
     struct harness_testcase_t testcases[] = {
@@ -377,6 +475,9 @@ int main()
 #if !defined(BOARD_ARDUINO_NANO) && !defined(BOARD_ARDUINO_UNO) && !defined(BOARD_ARDUINO_PRO_MICRO)
         { test_errno, "test_errno" },
 #endif
+        { test_lock_prio, "test_lock_prio" },
+        { test_memory, "test_memory" },
+        { test_start, "test_start" },
         { NULL, NULL }
     };
 
@@ -0,0 +1,74 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2014-2018, Erik Moqvist
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use, copy,
+ * modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ * This file is part of the Simba project.
+ */
+
+
+#include "simba.h"
+
+static int test_start_wait(void)
+{
+    /* No services to wait for in this test suite, but the deferred
+       start thread still has to signal that it is done. */
+    BTASSERT(sys_start_wait() == 0);
+    BTASSERT(sys_start_wait() == 0);
+
+    return (0);
+}
+
+static int test_start_print(void)
+{
+    static char buf[1024];
+    struct queue_t queue;
+    char command[32];
+
+    BTASSERT(queue_init(&queue, &buf[0], sizeof(buf)) == 0);
+    BTASSERT(sys_start_print(&queue) == 0);
+    BTASSERT(harness_expect(&queue, "NAME ", NULL) > 0);
+    BTASSERT(harness_expect(&queue, "\r\nthrd ", NULL) > 0);
+    BTASSERT(harness_expect(&queue, "\r\nuart ", NULL) > 0);
+    BTASSERT(harness_expect(&queue, "\r\ntotal ", NULL) > 0);
+
+    strcpy(command, "/kernel/sys/start");
+    BTASSERT(fs_call(command, chan_null(), sys_get_stdout(), NULL) == 0);
+
+    return (0);
+}
+
+int main()
+{
+    struct harness_testcase_t testcases[] = {
+        { test_start_wait, "test_start_wait" },
+        { test_start_print, "test_start_print" },
+        { NULL, NULL }
+    };
+
+    sys_start();
+
+    harness_run(testcases);
+
+    return (0);
+}
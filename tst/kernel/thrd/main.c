@@ -31,14 +31,20 @@
 #if defined(ARCH_ESP32)
 static THRD_STACK(suspend_resume_stack, 512);
 static THRD_STACK(terminate_stack, 512);
+static THRD_STACK(ready_order_stacks[4], 512);
 #elif defined(ARCH_ARM64)
 static THRD_STACK(suspend_resume_stack, 4096);
 static THRD_STACK(terminate_stack, 4096);
+static THRD_STACK(ready_order_stacks[4], 4096);
 #else
 static THRD_STACK(suspend_resume_stack, 256);
 static THRD_STACK(terminate_stack, 256);
+static THRD_STACK(ready_order_stacks[4], 256);
 #endif
 
+static int ready_order[4];
+static int ready_order_length;
+
 static void *suspend_resume_main(void *arg_p)
 {
     thrd_set_name("resumer");
@@ -47,6 +53,13 @@ static void *suspend_resume_main(void *arg_p)
     return (NULL);
 }
 
+static void *ready_order_main(void *arg_p)
+{
+    ready_order[ready_order_length++] = (int)(uintptr_t)arg_p;
+
+    return (NULL);
+}
+
 static void *terminate_main(void *arg_p)
 {
     thrd_set_name("terminate");
@@ -91,6 +104,23 @@ int test_suspend_resume(void)
     return (0);
 }
 
+int test_suspend_zero_timeout(void)
+{
+    struct time_t timeout;
+
+    timeout.seconds = 0;
+    timeout.nanoseconds = 0;
+
+    /* The thread keeps running on a zero timeout... */
+    BTASSERTI(thrd_suspend(&timeout), ==, -ETIMEDOUT);
+
+    /* ...so a resume is saved for the next suspend. */
+    BTASSERTI(thrd_resume(thrd_self(), 4), ==, 0);
+    BTASSERTI(thrd_suspend(NULL), ==, 4);
+
+    return (0);
+}
+
 int test_terminate(void)
 {
     struct thrd_t *thrd_p;
@@ -288,6 +318,59 @@ int test_env(void)
     return (0);
 }
 
+int test_env_many(void)
+{
+    struct thrd_environment_variable_t variables[16];
+    char names[16][4];
+    char values[16][4];
+    int i;
+
+    BTASSERT(thrd_init_env(variables, membersof(variables)) == 0);
+
+    for (i = 0; i < membersof(variables); i++) {
+        std_sprintf(&names[i][0], FSTR("N%d"), i);
+        std_sprintf(&values[i][0], FSTR("V%d"), i);
+        BTASSERT(thrd_set_env(&names[i][0], &values[i][0]) == 0);
+    }
+
+    /* No free space. */
+    BTASSERT(thrd_set_env("N16", "V16") == -1);
+    BTASSERT(thrd_get_env("N16") == NULL);
+
+    for (i = 0; i < membersof(variables); i++) {
+        BTASSERT(thrd_get_env(&names[i][0]) == &values[i][0]);
+    }
+
+    /* Remove every other variable. */
+    for (i = 0; i < membersof(variables); i += 2) {
+        BTASSERT(thrd_set_env(&names[i][0], NULL) == 0);
+    }
+
+    for (i = 0; i < membersof(variables); i++) {
+        if ((i % 2) == 0) {
+            BTASSERT(thrd_get_env(&names[i][0]) == NULL);
+        } else {
+            BTASSERT(thrd_get_env(&names[i][0]) == &values[i][0]);
+        }
+    }
+
+    /* Removing a missing variable is not an error. */
+    BTASSERT(thrd_set_env("N0", NULL) == 0);
+
+    /* Add the removed variables again, in reverse order. */
+    for (i = membersof(variables) - 2; i >= 0; i -= 2) {
+        BTASSERT(thrd_set_env(&names[i][0], &values[i][0]) == 0);
+    }
+
+    for (i = 0; i < membersof(variables); i++) {
+        BTASSERT(thrd_get_env(&names[i][0]) == &values[i][0]);
+    }
+
+    BTASSERT(thrd_init_env(NULL, 0) == 0);
+
+    return (0);
+}
+
 int test_get_by_name(void)
 {
     BTASSERT(thrd_get_by_name("main") == thrd_self());
@@ -373,6 +456,37 @@ int test_stack_heap(void)
     return (0);
 }
 
+int test_ready_order(void)
+{
+    int i;
+    int prios[4] = { 12, 10, 11, 10 };
+
+    ready_order_length = 0;
+
+    /* All spawned threads have lower priority than the main thread
+       and are scheduled first when it sleeps. */
+    for (i = 0; i < membersof(prios); i++) {
+        BTASSERT(thrd_spawn(ready_order_main,
+                            (void *)(uintptr_t)i,
+                            prios[i],
+                            ready_order_stacks[i],
+                            sizeof(ready_order_stacks[i])) != NULL);
+    }
+
+    BTASSERT(ready_order_length == 0);
+    BTASSERT(thrd_sleep_ms(10) == 0);
+
+    /* Highest priority first, and first in first out within a
+       priority level. */
+    BTASSERTI(ready_order_length, ==, 4);
+    BTASSERTI(ready_order[0], ==, 1);
+    BTASSERTI(ready_order[1], ==, 3);
+    BTASSERTI(ready_order[2], ==, 2);
+    BTASSERTI(ready_order[3], ==, 0);
+
+    return (0);
+}
+
 int test_prio_list(void)
 {
     struct thrd_prio_list_t list;
@@ -397,6 +511,7 @@ int main()
         { test_init, "test_init" },
 #if !defined(BOARD_ARDUINO_NANO) && !defined(BOARD_ARDUINO_UNO) && !defined(BOARD_ARDUINO_PRO_MICRO)
         { test_suspend_resume, "test_suspend_resume" },
+        { test_suspend_zero_timeout, "test_suspend_zero_timeout" },
         { test_terminate, "test_terminate" },
 #endif
         { test_yield, "test_yield" },
@@ -409,6 +524,7 @@ int main()
 #    endif
 #    if CONFIG_THRD_ENV == 1
         { test_env, "test_env" },
+        { test_env_many, "test_env_many" },
 #    endif
         { test_get_by_name, "test_get_by_name" },
         { test_stack_top_bottom, "test_stack_top_bottom" },
@@ -416,6 +532,7 @@ int main()
         { test_monitor_thread, "test_monitor_thread" },
 #    endif
         { test_stack_heap, "test_stack_heap" },
+        { test_ready_order, "test_ready_order" },
         { test_prio_list, "test_prio_list" },
 #endif
         { NULL, NULL }
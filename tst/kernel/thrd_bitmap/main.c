@@ -0,0 +1,197 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2014-2018, Erik Moqvist
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use, copy,
+ * modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ * This file is part of the Simba project.
+ */
+
+
+#include "simba.h"
+
+#if defined(ARCH_ESP32)
+static THRD_STACK(suspend_resume_stack, 512);
+static THRD_STACK(terminate_stack, 512);
+static THRD_STACK(ready_order_stacks[4], 512);
+static THRD_STACK(set_prio_stacks[2], 512);
+#elif defined(ARCH_ARM64)
+static THRD_STACK(suspend_resume_stack, 4096);
+static THRD_STACK(terminate_stack, 4096);
+static THRD_STACK(ready_order_stacks[4], 4096);
+static THRD_STACK(set_prio_stacks[2], 4096);
+#else
+static THRD_STACK(suspend_resume_stack, 256);
+static THRD_STACK(terminate_stack, 256);
+static THRD_STACK(ready_order_stacks[4], 256);
+static THRD_STACK(set_prio_stacks[2], 256);
+#endif
+
+static int ready_order[4];
+static int ready_order_length;
+
+static void *suspend_resume_main(void *arg_p)
+{
+    thrd_set_name("resumer");
+    thrd_resume(arg_p, 3);
+
+    return (NULL);
+}
+
+static void *ready_order_main(void *arg_p)
+{
+    ready_order[ready_order_length++] = (int)(uintptr_t)arg_p;
+
+    return (NULL);
+}
+
+static void *terminate_main(void *arg_p)
+{
+    thrd_set_name("terminate");
+    thrd_suspend(NULL);
+
+    /* Should never get here. */
+    BTASSERTN(0);
+
+    return (NULL);
+}
+
+static int test_suspend_resume(void)
+{
+    struct thrd_t *thrd_p;
+
+    thrd_p = thrd_spawn(suspend_resume_main,
+                        thrd_self(),
+                        10,
+                        suspend_resume_stack,
+                        sizeof(suspend_resume_stack));
+
+    BTASSERT(thrd_suspend(NULL) == 3);
+    BTASSERT(thrd_join(thrd_p) == 0);
+
+    return (0);
+}
+
+static int test_terminate(void)
+{
+    struct thrd_t *thrd_p;
+
+    /* Higher priority than the main thread. */
+    thrd_p = thrd_spawn(terminate_main,
+                        thrd_self(),
+                        -10,
+                        terminate_stack,
+                        sizeof(terminate_stack));
+    thrd_yield();
+
+    BTASSERT(thrd_terminate(thrd_p) == 0);
+    BTASSERT(thrd_resume(thrd_p, 0) == -1);
+
+    return (0);
+}
+
+static int test_yield_sleep(void)
+{
+    BTASSERT(thrd_yield() == 0);
+    BTASSERT(thrd_sleep_ms(1) == 0);
+    BTASSERT(thrd_sleep_us(1000) == 0);
+
+    return (0);
+}
+
+static int test_ready_order(void)
+{
+    int i;
+    int prios[4] = { 12, 10, 11, 10 };
+
+    ready_order_length = 0;
+
+    /* All spawned threads have lower priority than the main thread
+       and are scheduled first when it sleeps. */
+    for (i = 0; i < membersof(prios); i++) {
+        BTASSERT(thrd_spawn(ready_order_main,
+                            (void *)(uintptr_t)i,
+                            prios[i],
+                            ready_order_stacks[i],
+                            sizeof(ready_order_stacks[i])) != NULL);
+    }
+
+    BTASSERT(ready_order_length == 0);
+    BTASSERT(thrd_sleep_ms(10) == 0);
+
+    /* Highest priority first, and first in first out within a
+       priority level. */
+    BTASSERTI(ready_order_length, ==, 4);
+    BTASSERTI(ready_order[0], ==, 1);
+    BTASSERTI(ready_order[1], ==, 3);
+    BTASSERTI(ready_order[2], ==, 2);
+    BTASSERTI(ready_order[3], ==, 0);
+
+    return (0);
+}
+
+static int test_set_prio(void)
+{
+    struct thrd_t *thrd_p;
+
+    ready_order_length = 0;
+
+    BTASSERT((thrd_p = thrd_spawn(ready_order_main,
+                                  (void *)0,
+                                  10,
+                                  set_prio_stacks[0],
+                                  sizeof(set_prio_stacks[0]))) != NULL);
+    BTASSERT(thrd_spawn(ready_order_main,
+                        (void *)1,
+                        11,
+                        set_prio_stacks[1],
+                        sizeof(set_prio_stacks[1])) != NULL);
+
+    /* Lower the priority of a ready thread, moving it to another
+       priority level. */
+    BTASSERT(thrd_set_prio(thrd_p, 12) == 0);
+
+    BTASSERT(thrd_sleep_ms(10) == 0);
+    BTASSERTI(ready_order_length, ==, 2);
+    BTASSERTI(ready_order[0], ==, 1);
+    BTASSERTI(ready_order[1], ==, 0);
+
+    return (0);
+}
+
+int main()
+{
+    struct harness_testcase_t testcases[] = {
+        { test_suspend_resume, "test_suspend_resume" },
+        { test_terminate, "test_terminate" },
+        { test_yield_sleep, "test_yield_sleep" },
+        { test_ready_order, "test_ready_order" },
+        { test_set_prio, "test_set_prio" },
+        { NULL, NULL }
+    };
+
+    sys_start();
+
+    harness_run(testcases);
+
+    return (0);
+}
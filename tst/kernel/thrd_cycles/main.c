@@ -0,0 +1,90 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2014-2018, Erik Moqvist
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use, copy,
+ * modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ * This file is part of the Simba project.
+ */
+
+
+#include "simba.h"
+
+static int test_cycles(void)
+{
+    struct thrd_t *thrd_p;
+    uint32_t switches;
+    uint64_t total;
+    char command[64];
+    struct queue_t out;
+    static char buf[2048];
+
+    thrd_p = thrd_self();
+    switches = thrd_p->statistics.cycles.switches;
+    total = thrd_p->statistics.cycles.total;
+
+    /* Each sleep swaps the main thread out at least once. */
+    BTASSERT(thrd_sleep_ms(2) == 0);
+    BTASSERT(thrd_sleep_ms(2) == 0);
+
+    BTASSERTI(thrd_p->statistics.cycles.switches, >=, switches + 2);
+    BTASSERT(thrd_p->statistics.cycles.total >= total);
+    BTASSERT(thrd_p->statistics.cycles.max_slice
+             <= thrd_p->statistics.cycles.total);
+
+    strcpy(command, "/kernel/thrd/context_switches");
+    BTASSERT(fs_call(command, NULL, sys_get_stdout(), NULL) == 0);
+
+    strcpy(command, "/kernel/thrd/list");
+    BTASSERT(fs_call(command, NULL, sys_get_stdout(), NULL) == 0);
+
+    BTASSERT(queue_init(&out, &buf[0], sizeof(buf)) == 0);
+    BTASSERT(thrd_print_openmetrics(&out) == 0);
+    BTASSERTI(harness_expect(&out,
+                             "# TYPE thrd_cpu_usage_percent gauge\n",
+                             NULL), >, 0);
+    BTASSERTI(harness_expect(&out, "# TYPE thrd_scheduled counter\n", NULL), >, 0);
+    BTASSERTI(harness_expect(&out,
+                             "thrd_scheduled_total{thread=\"main\"} ",
+                             NULL), >, 0);
+    BTASSERTI(harness_expect(&out, "# TYPE thrd_switches counter\n", NULL), >, 0);
+    BTASSERTI(harness_expect(&out, "# TYPE thrd_cycles counter\n", NULL), >, 0);
+    BTASSERTI(harness_expect(&out,
+                             "thrd_cycles_total{thread=\"main\"} ",
+                             NULL), >, 0);
+
+    return (0);
+}
+
+int main()
+{
+    struct harness_testcase_t testcases[] = {
+        { test_cycles, "test_cycles" },
+        { NULL, NULL }
+    };
+
+    sys_start();
+
+    harness_run(testcases);
+
+    return (0);
+}
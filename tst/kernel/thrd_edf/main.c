@@ -0,0 +1,169 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2014-2018, Erik Moqvist
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use, copy,
+ * modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ * This file is part of the Simba project.
+ */
+
+
+#include "simba.h"
+
+static THRD_STACK(edf_stacks[4], 1024);
+static THRD_STACK(edf_periodic_stack, 1024);
+static int edf_results[3];
+static int ready_order[4];
+static int ready_order_length;
+
+static void *ready_order_main(void *arg_p)
+{
+    ready_order[ready_order_length++] = (int)(uintptr_t)arg_p;
+
+    return (NULL);
+}
+
+static void *edf_periodic_main(void *arg_p)
+{
+    struct time_t period;
+    struct time_t deadline;
+    struct time_t budget;
+    struct time_t start;
+    struct time_t now;
+    struct time_t duration;
+
+    period.seconds = 0;
+    period.nanoseconds = 100000000;
+    deadline.seconds = 0;
+    deadline.nanoseconds = 50000000;
+    budget.seconds = 0;
+    budget.nanoseconds = 20000000;
+    thrd_set_edf(thrd_self(), &period, &deadline, &budget);
+
+    /* Sleeping past the deadline misses it. */
+    thrd_sleep_ms(80);
+    edf_results[0] = thrd_wait_period();
+
+    /* Running for longer than the budget is an overrun. */
+    time_get(&start);
+
+    do {
+        time_get(&now);
+        time_subtract(&duration, &now, &start);
+    } while (duration.nanoseconds < 100000000);
+
+    edf_results[1] = thrd_wait_period();
+
+    /* A short job meets its deadline. */
+    edf_results[2] = thrd_wait_period();
+
+    thrd_set_edf(thrd_self(), NULL, NULL, NULL);
+
+    return (NULL);
+}
+
+static int test_edf(void)
+{
+    struct thrd_t *threads[4];
+    struct thrd_t *thrd_p;
+    struct time_t period;
+    struct time_t deadline;
+    char command[64];
+    int i;
+
+    /* Thread 0 has a fixed priority lower than the EDF class, and
+       thread 3 has a higher. */
+    int prios[4] = { 10, 10, 10, -1 };
+
+    ready_order_length = 0;
+
+    for (i = 0; i < membersof(threads); i++) {
+        threads[i] = thrd_spawn(ready_order_main,
+                                (void *)(uintptr_t)i,
+                                prios[i],
+                                edf_stacks[i],
+                                sizeof(edf_stacks[i]));
+        BTASSERT(threads[i] != NULL);
+    }
+
+    period.seconds = 0;
+    period.nanoseconds = 0;
+    BTASSERT(thrd_set_edf(threads[1], &period, NULL, NULL) == -EINVAL);
+    BTASSERT(thrd_wait_period() == -EINVAL);
+
+    /* Thread 2 has an earlier deadline than thread 1. */
+    period.seconds = 1;
+    period.nanoseconds = 0;
+    deadline.seconds = 0;
+    deadline.nanoseconds = 500000000;
+    BTASSERT(thrd_set_edf(threads[1], &period, &deadline, NULL) == 0);
+    deadline.nanoseconds = 200000000;
+    BTASSERT(thrd_set_edf(threads[2], &period, &deadline, NULL) == 0);
+    BTASSERTI(threads[1]->prio, ==, CONFIG_THRD_EDF_PRIO);
+
+    BTASSERT(ready_order_length == 0);
+    BTASSERT(thrd_sleep_ms(10) == 0);
+
+    BTASSERTI(ready_order_length, ==, 4);
+    BTASSERTI(ready_order[0], ==, 3);
+    BTASSERTI(ready_order[1], ==, 2);
+    BTASSERTI(ready_order[2], ==, 1);
+    BTASSERTI(ready_order[3], ==, 0);
+
+    /* Periodic thread with deadline miss and budget overrun. */
+    thrd_p = thrd_spawn(edf_periodic_main,
+                        NULL,
+                        5,
+                        edf_periodic_stack,
+                        sizeof(edf_periodic_stack));
+    BTASSERT(thrd_p != NULL);
+    BTASSERT(thrd_join(thrd_p) == 0);
+
+    BTASSERTI(edf_results[0], ==, 1);
+    BTASSERTI(edf_results[2], ==, 0);
+    BTASSERTI(thrd_p->edf.deadline_misses, >=, 1);
+    BTASSERTI(thrd_p->edf.budget_overruns, >=, 1);
+    BTASSERTI(thrd_p->prio, ==, 5);
+
+    strcpy(command, "/kernel/thrd/edf/deadline_misses");
+    BTASSERT(fs_call(command, NULL, sys_get_stdout(), NULL) == 0);
+
+    strcpy(command, "/kernel/thrd/edf/budget_overruns");
+    BTASSERT(fs_call(command, NULL, sys_get_stdout(), NULL) == 0);
+
+    return (0);
+}
+
+
+int main()
+{
+    struct harness_testcase_t testcases[] = {
+        { test_edf, "test_edf" },
+        { NULL, NULL }
+    };
+
+    sys_start();
+
+    harness_run(testcases);
+
+    return (0);
+}
@@ -0,0 +1,178 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2014-2018, Erik Moqvist
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use, copy,
+ * modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ * This file is part of the Simba project.
+ */
+
+
+#include "simba.h"
+
+static int test_env(void)
+{
+    struct thrd_environment_variable_t global_variables[2];
+    struct thrd_environment_variable_t variables[4];
+
+    /* Default thread environment is setup correctly. */
+    BTASSERT(thrd_get_env("FOO") == NULL);
+
+    /* Set and get are not possible for a thread without an
+       environment. */
+    BTASSERT(thrd_init_env(NULL, 0) == 0);
+    BTASSERT(thrd_set_env("CWD", "/") == -1);
+    BTASSERT(thrd_get_env("CWD") == NULL);
+
+    /* Initialize the global environment. */
+    BTASSERT(thrd_init_global_env(global_variables,
+                                  membersof(global_variables)) == 0);
+
+    /* Set and get global variables. */
+    BTASSERT(thrd_set_global_env("N1", "G1") == 0);
+    BTASSERT(thrd_get_global_env("N1") != NULL);
+    BTASSERT(strcmp(thrd_get_global_env("N1"), "G1") == 0);
+
+    BTASSERT(thrd_set_global_env("N2", "G2") == 0);
+    BTASSERT(thrd_get_global_env("N2") != NULL);
+    BTASSERT(strcmp(thrd_get_env("N2"), "G2") == 0);
+
+    /* Get from global environment using the thread local get
+       function. */
+    BTASSERT(thrd_get_env("N1") != NULL);
+    BTASSERT(strcmp(thrd_get_env("N1"), "G1") == 0);
+
+    /* Initialize the environment for the current thread. */
+    BTASSERT(thrd_init_env(variables, membersof(variables)) == 0);
+
+    /* Set and get variables. The global N1 is overridden. */
+    BTASSERT(thrd_set_env("N1", "L1") == 0);
+    BTASSERT(thrd_get_env("N1") != NULL);
+    BTASSERT(strcmp(thrd_get_env("N1"), "L1") == 0);
+
+    BTASSERT(thrd_set_env("N2", "L2") == 0);
+    BTASSERT(thrd_get_env("N2") != NULL);
+    BTASSERT(strcmp(thrd_get_env("N2"), "L2") == 0);
+
+    BTASSERT(thrd_set_env("N3", "L3") == 0);
+    BTASSERT(thrd_get_env("N3") != NULL);
+    BTASSERT(strcmp(thrd_get_env("N3"), "L3") == 0);
+
+    BTASSERT(thrd_set_env("N4", "L4") == 0);
+    BTASSERT(thrd_get_env("N4") != NULL);
+    BTASSERT(strcmp(thrd_get_env("N4"), "L4") == 0);
+
+    /* Overwrite a value. */
+    BTASSERT(thrd_set_env("N4", "L44") == 0);
+    BTASSERT(thrd_get_env("N4") != NULL);
+    BTASSERT(strcmp(thrd_get_env("N4"), "L44") == 0);
+
+    /* No free space. */
+    BTASSERT(thrd_set_env("N5", "L5") == -1);
+
+    /* Remove a variable. */
+    BTASSERT(thrd_set_env("N2", NULL) == 0);
+
+    /* Set and get another variable. */
+    BTASSERT(thrd_set_env("N6", "L6") == 0);
+    BTASSERT(thrd_get_env("N6") != NULL);
+    BTASSERT(strcmp(thrd_get_env("N6"), "L6") == 0);
+
+    /* Get a non-existing variable. */
+    BTASSERT(thrd_get_env("N7") == NULL);
+
+    /* Remove the local environment. */
+    BTASSERT(thrd_init_env(NULL, 0) == 0);
+
+    /* Remove the global environment. */
+    BTASSERT(thrd_init_global_env(NULL, 0) == 0);
+
+    return (0);
+}
+
+static int test_env_many(void)
+{
+    struct thrd_environment_variable_t variables[16];
+    char names[16][4];
+    char values[16][4];
+    int i;
+
+    BTASSERT(thrd_init_env(variables, membersof(variables)) == 0);
+
+    for (i = 0; i < membersof(variables); i++) {
+        std_sprintf(&names[i][0], FSTR("N%d"), i);
+        std_sprintf(&values[i][0], FSTR("V%d"), i);
+        BTASSERT(thrd_set_env(&names[i][0], &values[i][0]) == 0);
+    }
+
+    /* No free space. */
+    BTASSERT(thrd_set_env("N16", "V16") == -1);
+    BTASSERT(thrd_get_env("N16") == NULL);
+
+    for (i = 0; i < membersof(variables); i++) {
+        BTASSERT(thrd_get_env(&names[i][0]) == &values[i][0]);
+    }
+
+    /* Remove every other variable. */
+    for (i = 0; i < membersof(variables); i += 2) {
+        BTASSERT(thrd_set_env(&names[i][0], NULL) == 0);
+    }
+
+    for (i = 0; i < membersof(variables); i++) {
+        if ((i % 2) == 0) {
+            BTASSERT(thrd_get_env(&names[i][0]) == NULL);
+        } else {
+            BTASSERT(thrd_get_env(&names[i][0]) == &values[i][0]);
+        }
+    }
+
+    /* Removing a missing variable is not an error. */
+    BTASSERT(thrd_set_env("N0", NULL) == 0);
+
+    /* Add the removed variables again, in reverse order. */
+    for (i = membersof(variables) - 2; i >= 0; i -= 2) {
+        BTASSERT(thrd_set_env(&names[i][0], &values[i][0]) == 0);
+    }
+
+    for (i = 0; i < membersof(variables); i++) {
+        BTASSERT(thrd_get_env(&names[i][0]) == &values[i][0]);
+    }
+
+    BTASSERT(thrd_init_env(NULL, 0) == 0);
+
+    return (0);
+}
+
+int main()
+{
+    struct harness_testcase_t testcases[] = {
+        { test_env, "test_env" },
+        { test_env_many, "test_env_many" },
+        { NULL, NULL }
+    };
+
+    sys_start();
+
+    harness_run(testcases);
+
+    return (0);
+}
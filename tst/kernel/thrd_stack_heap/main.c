@@ -0,0 +1,98 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2014-2018, Erik Moqvist
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use, copy,
+ * modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ * This file is part of the Simba project.
+ */
+
+
+#include "simba.h"
+
+static void *suspend_resume_main(void *arg_p)
+{
+    thrd_set_name("resumer");
+    thrd_resume(arg_p, 3);
+
+    return (NULL);
+}
+
+static int test_stack_heap(void)
+{
+    void *stack_p;
+    void *stack_2_p;
+    struct thrd_t *thrd_p;
+
+    /* A freed stack is reused by the next allocation of the same size
+       class. */
+    stack_p = thrd_stack_alloc(1000);
+    BTASSERT(stack_p != NULL);
+    BTASSERTI(thrd_stack_free(stack_p), ==, 0);
+    BTASSERT(thrd_stack_alloc(900) == stack_p);
+
+    /* A bigger size class gives another stack. */
+    stack_2_p = thrd_stack_alloc(2000);
+    BTASSERT(stack_2_p != NULL);
+    BTASSERT(stack_2_p != stack_p);
+    BTASSERTI(thrd_stack_free(stack_2_p), ==, 0);
+
+    /* Bigger than the biggest size class. */
+    stack_2_p = thrd_stack_alloc(3000);
+    BTASSERT(stack_2_p != NULL);
+    BTASSERTI(thrd_stack_free(stack_2_p), ==, 0);
+
+    /* Spawn a thread on the pooled stack and then reuse it. */
+    thrd_p = thrd_spawn(suspend_resume_main,
+                        thrd_self(),
+                        10,
+                        stack_p,
+                        1000);
+    BTASSERT(thrd_p != NULL);
+    BTASSERTI(thrd_suspend(NULL), ==, 3);
+    BTASSERT(thrd_join(thrd_p) == 0);
+#if CONFIG_PROFILE_STACK == 1
+    BTASSERT(thrd_get_max_stack_usage(thrd_p) >= 0);
+    BTASSERT(thrd_get_max_stack_usage(thrd_p) <= thrd_p->stack_size);
+#else
+    BTASSERTI(thrd_get_max_stack_usage(thrd_p), ==, -ENOSYS);
+#endif
+    BTASSERTI(thrd_stack_free(stack_p), ==, 0);
+    BTASSERT(thrd_stack_alloc(1000) == stack_p);
+    BTASSERTI(thrd_stack_free(stack_p), ==, 0);
+
+    return (0);
+}
+
+int main()
+{
+    struct harness_testcase_t testcases[] = {
+        { test_stack_heap, "test_stack_heap" },
+        { NULL, NULL }
+    };
+
+    sys_start();
+
+    harness_run(testcases);
+
+    return (0);
+}
@@ -357,6 +357,169 @@ static int test_micros(void)
     return (0);
 }
 
+static int test_cycles(void)
+{
+    uint64_t start;
+    uint64_t stop;
+    uint64_t elapsed;
+
+    BTASSERTI(time_cycles_frequency(), >, 0);
+
+    /* Monotonic. */
+    start = time_cycles();
+    stop = time_cycles();
+    BTASSERT(stop >= start);
+
+    start = time_monotonic_us();
+    thrd_sleep_ms(10);
+    stop = time_monotonic_us();
+    elapsed = (stop - start);
+    std_printf(OSTR("Slept %lu us.\r\n"), (unsigned long)elapsed);
+    BTASSERT(elapsed >= 9000);
+    BTASSERT(elapsed < 1000000);
+
+    /* Conversion, also of values overflowing 64 bits when multiplied
+       by one million. */
+    BTASSERT(time_cycles_set_frequency(3000) == 0);
+    BTASSERTI(time_cycles_frequency(), ==, 3000);
+    BTASSERT(time_cycles_to_us(4500) == 1500000);
+    BTASSERT(time_cycles_to_us(0xffffffffffffULL) == 93824992236885000ULL);
+    BTASSERT(time_cycles_to_us(3000ULL * 0xffffffffffULL)
+             == 1000000ULL * 0xffffffffffULL);
+    BTASSERT(time_cycles_set_frequency(0) == 0);
+    BTASSERTI(time_cycles_frequency(), !=, 3000);
+
+    return (0);
+}
+
+/**
+ * Read the offset between the time and the uptime, between given
+ * lower and upper bounds.
+ */
+static void read_offset(struct time_t *lower_p, struct time_t *upper_p)
+{
+    struct time_t uptime;
+    struct time_t now;
+
+    sys_uptime(&uptime);
+    time_get(&now);
+    time_subtract(upper_p, &now, &uptime);
+    sys_uptime(&uptime);
+    time_subtract(lower_p, &now, &uptime);
+}
+
+static long time_to_us(struct time_t *time_p)
+{
+    return (1000000L * time_p->seconds + time_p->nanoseconds / 1000);
+}
+
+static int test_adjust(void)
+{
+    struct time_t lower1;
+    struct time_t upper1;
+    struct time_t lower2;
+    struct time_t upper2;
+    struct time_t difference;
+    long remaining;
+
+    /* A small adjustment is completed within 100 ms, increasing the
+       offset between the time and the uptime by 20 microseconds. */
+    read_offset(&lower1, &upper1);
+    BTASSERT(time_adjust(20) == 0);
+    thrd_sleep_ms(100);
+    BTASSERTI(time_adjust_get_remaining(), ==, 0);
+    read_offset(&lower2, &upper2);
+
+    time_subtract(&difference, &upper2, &lower1);
+    BTASSERTI(time_to_us(&difference), >=, 19);
+    time_subtract(&difference, &lower2, &upper1);
+    BTASSERTI(time_to_us(&difference), <=, 21);
+
+    /* At most CONFIG_TIME_ADJUST_RATE_PPM microseconds per second. */
+    BTASSERT(time_adjust(1000000) == 0);
+    thrd_sleep_ms(100);
+    remaining = time_adjust_get_remaining();
+    std_printf(OSTR("Remaining %ld us.\r\n"), remaining);
+    BTASSERTI(remaining, <=, 1000000 - CONFIG_TIME_ADJUST_RATE_PPM / 10);
+    BTASSERTI(remaining, >, 1000000 - CONFIG_TIME_ADJUST_RATE_PPM);
+
+    /* A new adjustment replaces the remaining part. */
+    BTASSERT(time_adjust(-1000000) == 0);
+    BTASSERTI(time_adjust_get_remaining(), ==, -1000000);
+
+    /* Setting the time cancels the adjustment. */
+    BTASSERT(time_get(&lower1) == 0);
+    BTASSERT(time_set(&lower1) == 0);
+    BTASSERTI(time_adjust_get_remaining(), ==, 0);
+
+    return (0);
+}
+
+static int test_format(void)
+{
+    char buf[32];
+    struct time_t time;
+    uint16_t fat_date;
+    uint16_t fat_time;
+
+    /* Log timestamps, formatted and cached. */
+    time.seconds = 12;
+    time.nanoseconds = 34000000;
+    BTASSERTI(time_format_log_timestamp(&buf[0], sizeof(buf), &time), ==, 6);
+    BTASSERTM(&buf[0], "12.034", 7);
+    time.nanoseconds = 999999999;
+    BTASSERTI(time_format_log_timestamp(&buf[0], sizeof(buf), &time), ==, 6);
+    BTASSERTM(&buf[0], "12.999", 7);
+    time.seconds = 1451347199;
+    time.nanoseconds = 500000000;
+    BTASSERTI(time_format_log_timestamp(&buf[0], sizeof(buf), &time), ==, 14);
+    BTASSERTM(&buf[0], "1451347199.500", 15);
+    BTASSERTI(time_format_log_timestamp(&buf[0], 15, &time), ==, -ENOMEM);
+
+    /* No FAT date before 1980. */
+    time.seconds = 0;
+    time.nanoseconds = 0;
+    BTASSERT(time_set(&time) == 0);
+    BTASSERTI(time_format_rfc1123(&buf[0], sizeof(buf)), ==, 29);
+    BTASSERTM(&buf[0], "Thu, 01 Jan 1970 00:00:00 GMT", 30);
+    BTASSERTI(time_format_fat(&fat_date, &fat_time), ==, -ERANGE);
+
+    /* The time of day is advanced within a day. */
+    time.seconds = (1451347199 - 60);
+    BTASSERT(time_set(&time) == 0);
+    BTASSERTI(time_format_rfc1123(&buf[0], sizeof(buf)), ==, 29);
+    BTASSERTM(&buf[0], "Mon, 28 Dec 2015 23:58:59 GMT", 30);
+    time.seconds = (1451347199 - 1);
+    BTASSERT(time_set(&time) == 0);
+    BTASSERTI(time_format_rfc1123(&buf[0], sizeof(buf)), ==, 29);
+    BTASSERTM(&buf[0], "Mon, 28 Dec 2015 23:59:58 GMT", 30);
+    BTASSERT(time_format_fat(&fat_date, &fat_time) == 0);
+    BTASSERTI(fat_date, ==, ((35 << 9) | (12 << 5) | 28));
+    BTASSERTI(fat_time, ==, ((23 << 11) | (59 << 5) | 29));
+
+    /* The date is converted again when the day changes. */
+    time.seconds = 1451347199;
+    time.nanoseconds = 990000000;
+    BTASSERT(time_set(&time) == 0);
+    thrd_sleep_ms(20);
+    BTASSERTI(time_format_rfc1123(&buf[0], sizeof(buf)), ==, 29);
+    BTASSERTM(&buf[0], "Tue, 29 Dec 2015 00:00:00 GMT", 30);
+    BTASSERT(time_format_fat(&fat_date, &fat_time) == 0);
+    BTASSERTI(fat_date, ==, ((35 << 9) | (12 << 5) | 29));
+    BTASSERTI(fat_time, ==, 0);
+
+    /* Time set backwards. */
+    time.seconds = 915148800;
+    time.nanoseconds = 0;
+    BTASSERT(time_set(&time) == 0);
+    BTASSERTI(time_format_rfc1123(&buf[0], sizeof(buf)), ==, 29);
+    BTASSERTM(&buf[0], "Fri, 01 Jan 1999 00:00:00 GMT", 30);
+
+    BTASSERTI(time_format_rfc1123(&buf[0], 29), ==, -ENOMEM);
+
+    return (0);
+}
+
 int main()
 {
     struct harness_testcase_t testcases[] = {
@@ -367,6 +530,9 @@ int main()
         { test_subtract, "test_subtract" },
         { test_compare, "test_compare" },
         { test_micros, "test_micros" },
+        { test_cycles, "test_cycles" },
+        { test_adjust, "test_adjust" },
+        { test_format, "test_format" },
         { NULL, NULL }
     };
 
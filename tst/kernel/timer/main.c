@@ -202,11 +202,119 @@ int test_multiple_timers(void)
     return (0);
 }
 
+int test_long_timeout(void)
+{
+    uint32_t mask;
+    uint32_t callback_mask;
+    struct timer_t timer;
+    struct time_t timeout = {
+        .seconds = 0,
+        .nanoseconds = 250000000
+    };
+    struct time_t start, stop, elapsed;
+
+    event_init(&event);
+    callback_mask = 0x1;
+
+    /* Longer than a full turn of the timer wheel, if used. */
+    BTASSERT(timer_init(&timer,
+                        &timeout,
+                        callback,
+                        &callback_mask,
+                        0) == 0);
+    BTASSERT(sys_uptime(&start) == 0);
+    BTASSERT(timer_start(&timer) == 0);
+
+    mask = 0x1;
+    event_read(&event, &mask, sizeof(mask));
+
+    BTASSERT(sys_uptime(&stop) == 0);
+    BTASSERT(time_subtract(&elapsed, &stop, &start) == 0);
+    BTASSERTI(elapsed.seconds, ==, 0);
+    BTASSERTI(elapsed.nanoseconds, >=, 250000000);
+    BTASSERTI(elapsed.nanoseconds, <, 300000000);
+    BTASSERT(timer_stop(&timer) == 0);
+
+    return (0);
+}
+
+int test_stop_restart(void)
+{
+    uint32_t mask;
+    uint32_t callback_mask;
+    struct timer_t timer;
+    struct time_t timeout = {
+        .seconds = 0,
+        .nanoseconds = 50000000
+    };
+
+    event_init(&event);
+    callback_mask = 0x1;
+
+    BTASSERT(timer_init(&timer,
+                        &timeout,
+                        callback,
+                        &callback_mask,
+                        0) == 0);
+
+    /* Never started. */
+    BTASSERT(timer_stop(&timer) == 0);
+
+    /* Stop before expiry. */
+    BTASSERT(timer_start(&timer) == 0);
+    BTASSERT(timer_stop(&timer) == 1);
+    BTASSERT(timer_stop(&timer) == 0);
+    thrd_sleep_ms(100);
+    BTASSERT(event_size(&event) == 0);
+
+    /* Restart an already started timer. */
+    BTASSERT(timer_start(&timer) == 0);
+    BTASSERT(timer_start(&timer) == 0);
+    mask = 0x1;
+    event_read(&event, &mask, sizeof(mask));
+    thrd_sleep_ms(100);
+    BTASSERT(event_size(&event) == 0);
+    BTASSERT(timer_stop(&timer) == 0);
+
+    return (0);
+}
+
+int test_channel_hint(void)
+{
+    uint32_t mask;
+    uint32_t callback_mask;
+    struct timer_t timer;
+    struct time_t timeout = {
+        .seconds = 0,
+        .nanoseconds = 20000000
+    };
+
+    event_init(&event);
+    callback_mask = 0x1;
+
+    /* The hint is ignored by system tick timers. */
+    BTASSERT(timer_init(&timer,
+                        &timeout,
+                        callback,
+                        &callback_mask,
+                        TIMER_CHANNEL(3)) == 0);
+    BTASSERT(timer_start(&timer) == 0);
+
+    mask = 0x1;
+    event_read(&event, &mask, sizeof(mask));
+    BTASSERT(timer_stop(&timer) == 0);
+
+    return (0);
+}
+
 int main()
 {
     struct harness_testcase_t testcases[] = {
         { test_single_shot, "test_single_shot" },
         { test_periodic, "test_periodic" },
+        { test_long_timeout, "test_long_timeout" },
+        { test_stop_restart, "test_stop_restart" },
+        { test_channel_hint, "test_channel_hint" },
 #if !defined(BOARD_ARDUINO_NANO) && !defined(BOARD_ARDUINO_UNO) && !defined(BOARD_ARDUINO_PRO_MICRO)
         { test_multiple_timers, "test_multiple_timers" },
 #endif
@@ -0,0 +1,165 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2014-2018, Erik Moqvist
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use, copy,
+ * modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ * This file is part of the Simba project.
+ */
+
+#include "simba.h"
+
+struct event_t event;
+
+static struct sem_t deferred_sem;
+static struct sem_t blocked_sem;
+static const char *deferred_thrd_name_p;
+static int deferred_count;
+
+static void deferred_callback(void *arg_p)
+{
+    uint32_t mask;
+
+    /* Called from the timer thread, so not isr safe functions may be
+       called. */
+    deferred_thrd_name_p = thrd_get_name();
+    deferred_count++;
+    mask = *(uint32_t *)arg_p;
+    event_write(&event, &mask, sizeof(mask));
+}
+
+static void blocking_callback(void *arg_p)
+{
+    sem_give(&deferred_sem, 1);
+    sem_take(&blocked_sem, NULL);
+}
+
+static int test_deferred(void)
+{
+    uint32_t mask;
+    uint32_t callback_mask;
+    struct timer_t timer;
+    struct time_t timeout = {
+        .seconds = 0,
+        .nanoseconds = 30000000
+    };
+
+    event_init(&event);
+    callback_mask = 0x1;
+    deferred_count = 0;
+
+    BTASSERT(timer_init(&timer,
+                        &timeout,
+                        deferred_callback,
+                        &callback_mask,
+                        TIMER_DEFERRED) == 0);
+    BTASSERT(timer_start(&timer) == 0);
+
+    mask = 0x1;
+    event_read(&event, &mask, sizeof(mask));
+    BTASSERT(strcmp(deferred_thrd_name_p, "timer") == 0);
+    BTASSERTI(deferred_count, ==, 1);
+    BTASSERT(timer_stop(&timer) == 0);
+
+    /* Periodic deferred timer. */
+    BTASSERT(timer_init(&timer,
+                        &timeout,
+                        deferred_callback,
+                        &callback_mask,
+                        TIMER_DEFERRED | TIMER_PERIODIC) == 0);
+    BTASSERT(timer_start(&timer) == 0);
+
+    while (deferred_count < 4) {
+        mask = 0x1;
+        event_read(&event, &mask, sizeof(mask));
+    }
+
+    BTASSERT(timer_stop(&timer) == 1);
+    thrd_sleep_ms(100);
+    BTASSERTI(deferred_count, ==, 4);
+
+    return (0);
+}
+
+static int test_deferred_stop_pending(void)
+{
+    uint32_t callback_mask;
+    struct timer_t blocking_timer;
+    struct timer_t timer;
+    struct time_t timeout = {
+        .seconds = 0,
+        .nanoseconds = 20000000
+    };
+
+    event_init(&event);
+    sem_init(&deferred_sem, 1, 1);
+    sem_init(&blocked_sem, 1, 1);
+    callback_mask = 0x1;
+    deferred_count = 0;
+
+    /* Keep the timer thread busy in the first callback. */
+    BTASSERT(timer_init(&blocking_timer,
+                        &timeout,
+                        blocking_callback,
+                        NULL,
+                        TIMER_DEFERRED) == 0);
+    BTASSERT(timer_start(&blocking_timer) == 0);
+    BTASSERT(sem_take(&deferred_sem, NULL) == 0);
+
+    /* The second timer expires, but its callback is not called as
+       the timer thread is busy. */
+    BTASSERT(timer_init(&timer,
+                        &timeout,
+                        deferred_callback,
+                        &callback_mask,
+                        TIMER_DEFERRED) == 0);
+    BTASSERT(timer_start(&timer) == 0);
+    thrd_sleep_ms(50);
+    BTASSERTI(deferred_count, ==, 0);
+
+    /* Stopping the pending timer removes it. */
+    BTASSERT(timer_stop(&timer) == 1);
+    BTASSERT(timer_stop(&timer) == 0);
+
+    sem_give(&blocked_sem, 1);
+    thrd_sleep_ms(50);
+    BTASSERTI(deferred_count, ==, 0);
+    BTASSERT(event_size(&event) == 0);
+
+    return (0);
+}
+
+
+int main()
+{
+    struct harness_testcase_t testcases[] = {
+        { test_deferred, "test_deferred" },
+        { test_deferred_stop_pending, "test_deferred_stop_pending" },
+        { NULL, NULL }
+    };
+
+    sys_start();
+
+    harness_run(testcases);
+
+    return (0);
+}
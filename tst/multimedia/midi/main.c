@@ -35,10 +35,260 @@ int test_map(void)
     return (0);
 }
 
+static struct midi_event_t events[64];
+static size_t number_of_events;
+static int number_of_batches;
+static uint8_t sysex[128];
+static size_t sysex_size;
+static int sysex_flags[8];
+static int number_of_sysex_chunks;
+
+static void on_events(void *arg_p,
+                      const struct midi_event_t *events_p,
+                      size_t length)
+{
+    memcpy(&events[number_of_events], events_p, sizeof(*events_p) * length);
+    number_of_events += length;
+    number_of_batches++;
+}
+
+static void on_sysex(void *arg_p,
+                     const uint8_t *buf_p,
+                     size_t size,
+                     int flags)
+{
+    memcpy(&sysex[sysex_size], buf_p, size);
+    sysex_size += size;
+    sysex_flags[number_of_sysex_chunks] = flags;
+    number_of_sysex_chunks++;
+}
+
+static void reset(struct midi_parser_t *parser_p)
+{
+    number_of_events = 0;
+    number_of_batches = 0;
+    sysex_size = 0;
+    number_of_sysex_chunks = 0;
+    midi_parser_init(parser_p, on_events, on_sysex, NULL);
+}
+
+static int assert_event(int index,
+                        uint8_t status,
+                        uint8_t data0,
+                        uint8_t data1)
+{
+    BTASSERTI(events[index].status, ==, status);
+    BTASSERTI(events[index].data[0], ==, data0);
+    BTASSERTI(events[index].data[1], ==, data1);
+
+    return (0);
+}
+
+static int test_parser_running_status(void)
+{
+    struct midi_parser_t parser;
+    uint8_t input[] = {
+        /* Note on and two more with running status. */
+        0x91, 60, 100, 62, 101, 64, 0,
+        /* Program change with running status. */
+        0xc2, 5, 6,
+        /* Pitch bend. */
+        0xe0, 0x00, 0x40
+    };
+
+    reset(&parser);
+    BTASSERT(midi_parser_write(&parser, &input[0], sizeof(input)) == 0);
+    BTASSERT(number_of_events == 6);
+    BTASSERT(number_of_batches == 1);
+    BTASSERT(assert_event(0, 0x91, 60, 100) == 0);
+    BTASSERT(assert_event(1, 0x91, 62, 101) == 0);
+    BTASSERT(assert_event(2, 0x91, 64, 0) == 0);
+    BTASSERT(assert_event(3, 0xc2, 5, 0) == 0);
+    BTASSERT(assert_event(4, 0xc2, 6, 0) == 0);
+    BTASSERT(assert_event(5, 0xe0, 0x00, 0x40) == 0);
+
+    /* A message split over several writes. */
+    reset(&parser);
+    BTASSERT(midi_parser_write(&parser, &input[0], 2) == 0);
+    BTASSERT(number_of_events == 0);
+    BTASSERT(midi_parser_write(&parser, &input[2], 2) == 0);
+    BTASSERT(number_of_events == 1);
+    BTASSERT(midi_parser_write(&parser, &input[4], 1) == 0);
+    BTASSERT(number_of_events == 2);
+    BTASSERT(assert_event(1, 0x91, 62, 101) == 0);
+
+    /* Data without status is discarded. */
+    reset(&parser);
+    BTASSERT(midi_parser_write(&parser, &input[1], 2) == 0);
+    BTASSERT(number_of_events == 0);
+    BTASSERT(midi_parser_get_discarded(&parser) == 2);
+
+    return (0);
+}
+
+static int test_parser_real_time(void)
+{
+    struct midi_parser_t parser;
+    uint8_t input[] = {
+        0x90, MIDI_TIMING_CLOCK, 60, MIDI_ACTIVE_SENSING, 100,
+        MIDI_START, 61, 102, MIDI_STOP
+    };
+
+    reset(&parser);
+    BTASSERT(midi_parser_write(&parser, &input[0], sizeof(input)) == 0);
+    BTASSERT(number_of_events == 6);
+    BTASSERT(assert_event(0, MIDI_TIMING_CLOCK, 0, 0) == 0);
+    BTASSERT(assert_event(1, MIDI_ACTIVE_SENSING, 0, 0) == 0);
+    BTASSERT(assert_event(2, 0x90, 60, 100) == 0);
+    BTASSERT(assert_event(3, MIDI_START, 0, 0) == 0);
+    BTASSERT(assert_event(4, 0x90, 61, 102) == 0);
+    BTASSERT(assert_event(5, MIDI_STOP, 0, 0) == 0);
+
+    return (0);
+}
+
+static int test_parser_system_common(void)
+{
+    struct midi_parser_t parser;
+    uint8_t input[] = {
+        0x90, 60, 100,
+        MIDI_SONG_POSITION_POINTER, 1, 2,
+        /* Running status was cleared by the system common message. */
+        61, 100,
+        MIDI_SONG_SELECT, 3,
+        MIDI_TUNE_REQUEST
+    };
+
+    reset(&parser);
+    BTASSERT(midi_parser_write(&parser, &input[0], sizeof(input)) == 0);
+    BTASSERT(number_of_events == 4);
+    BTASSERT(assert_event(0, 0x90, 60, 100) == 0);
+    BTASSERT(assert_event(1, MIDI_SONG_POSITION_POINTER, 1, 2) == 0);
+    BTASSERT(assert_event(2, MIDI_SONG_SELECT, 3, 0) == 0);
+    BTASSERT(assert_event(3, MIDI_TUNE_REQUEST, 0, 0) == 0);
+    BTASSERT(midi_parser_get_discarded(&parser) == 2);
+
+    return (0);
+}
+
+static int test_parser_sysex(void)
+{
+    struct midi_parser_t parser;
+    uint8_t input[80];
+    int i;
+
+    /* A long SysEx message with a real-time message in it. */
+    input[0] = MIDI_SYSEX_START;
+
+    for (i = 1; i < 71; i++) {
+        input[i] = i;
+    }
+
+    input[71] = MIDI_TIMING_CLOCK;
+    input[72] = 71;
+    input[73] = MIDI_SYSEX_END;
+    input[74] = 0x80;
+    input[75] = 60;
+    input[76] = 0;
+
+    reset(&parser);
+    BTASSERT(midi_parser_write(&parser, &input[0], 77) == 0);
+    BTASSERT(number_of_sysex_chunks == 3);
+    BTASSERT(sysex_flags[0] == MIDI_PARSER_SYSEX_FIRST);
+    BTASSERT(sysex_flags[1] == 0);
+    BTASSERT(sysex_flags[2] == MIDI_PARSER_SYSEX_LAST);
+    BTASSERT(sysex_size == 71);
+
+    for (i = 0; i < 71; i++) {
+        BTASSERT(sysex[i] == i + 1);
+    }
+
+    BTASSERT(number_of_events == 2);
+    BTASSERT(assert_event(0, MIDI_TIMING_CLOCK, 0, 0) == 0);
+    BTASSERT(assert_event(1, 0x80, 60, 0) == 0);
+
+    /* A SysEx message ended by another status byte. */
+    input[0] = MIDI_SYSEX_START;
+    input[1] = 0x7e;
+    input[2] = 0x90;
+    input[3] = 60;
+    input[4] = 100;
+
+    reset(&parser);
+    BTASSERT(midi_parser_write(&parser, &input[0], 5) == 0);
+    BTASSERT(number_of_sysex_chunks == 1);
+    BTASSERT(sysex_flags[0] == (MIDI_PARSER_SYSEX_FIRST
+                                | MIDI_PARSER_SYSEX_LAST));
+    BTASSERT(sysex_size == 1);
+    BTASSERT(number_of_events == 1);
+    BTASSERT(assert_event(0, 0x90, 60, 100) == 0);
+
+    /* SysEx data is discarded without a callback. */
+    input[2] = MIDI_SYSEX_END;
+    midi_parser_init(&parser, on_events, NULL, NULL);
+    BTASSERT(midi_parser_write(&parser, &input[0], 3) == 0);
+    BTASSERT(midi_parser_get_discarded(&parser) == 0);
+
+    return (0);
+}
+
+static int test_parser_batches(void)
+{
+    struct midi_parser_t parser;
+    uint8_t input[1 + 2 * 20];
+    int i;
+
+    input[0] = 0x90;
+
+    for (i = 0; i < 20; i++) {
+        input[1 + 2 * i] = i;
+        input[2 + 2 * i] = 100;
+    }
+
+    reset(&parser);
+    BTASSERT(midi_parser_write(&parser, &input[0], sizeof(input)) == 0);
+    BTASSERT(number_of_events == 20);
+    BTASSERT(number_of_batches == 3);
+
+    for (i = 0; i < 20; i++) {
+        BTASSERT(assert_event(i, 0x90, i, 100) == 0);
+    }
+
+    return (0);
+}
+
+static int test_parser_read(void)
+{
+    struct midi_parser_t parser;
+    struct queue_t queue;
+    uint8_t queue_buf[64];
+    uint8_t input[] = {
+        0x90, 60, 100, 61, 101, 62, 102, 63, 103, 64, 104,
+        65, 105, 66, 106, 67, 107, 68, 108
+    };
+
+    BTASSERT(queue_init(&queue, &queue_buf[0], sizeof(queue_buf)) == 0);
+    BTASSERT(queue_write(&queue, &input[0], sizeof(input)) == sizeof(input));
+
+    reset(&parser);
+    BTASSERT(midi_parser_read(&parser, &queue) == sizeof(input));
+    BTASSERT(number_of_events == 9);
+    BTASSERT(assert_event(8, 0x90, 68, 108) == 0);
+    BTASSERT(queue_size(&queue) == 0);
+
+    return (0);
+}
+
 int main()
 {
     struct harness_testcase_t testcases[] = {
         { test_map, "test_map" },
+        { test_parser_running_status, "test_parser_running_status" },
+        { test_parser_real_time, "test_parser_real_time" },
+        { test_parser_system_common, "test_parser_system_common" },
+        { test_parser_sysex, "test_parser_sysex" },
+        { test_parser_batches, "test_parser_batches" },
+        { test_parser_read, "test_parser_read" },
         { NULL, NULL }
     };
 
@@ -0,0 +1,275 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2014-2018, Erik Moqvist
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use, copy,
+ * modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ * This file is part of the Simba project.
+ */
+
+#include "simba.h"
+
+#define SAMPLE_RATE 44100
+
+static struct mixer_t mixer;
+static int32_t samples[SAMPLE_RATE / 10];
+
+static int32_t max_abs(int32_t *samples_p, size_t length)
+{
+    size_t i;
+    int32_t value;
+
+    value = 0;
+
+    for (i = 0; i < length; i++) {
+        if (abs(samples_p[i]) > value) {
+            value = abs(samples_p[i]);
+        }
+    }
+
+    return (value);
+}
+
+static int test_init(void)
+{
+    BTASSERT(mixer_init(&mixer, SAMPLE_RATE) == 0);
+    BTASSERT(mixer_get_active_voices(&mixer) == 0);
+    BTASSERT(mixer_get_stolen_voices(&mixer) == 0);
+
+    /* Bad arguments. */
+    BTASSERT(mixer_set_waveform(&mixer,
+                                16,
+                                mixer_waveform_sine,
+                                MIXER_WAVEFORM_LENGTH) == -EINVAL);
+    BTASSERT(mixer_set_waveform(&mixer,
+                                0,
+                                mixer_waveform_sine,
+                                100) == -EINVAL);
+    BTASSERT(mixer_set_envelope(&mixer, 0, 0, 32768, 0) == -EINVAL);
+    BTASSERT(mixer_set_output_shift(&mixer, 32) == -EINVAL);
+    BTASSERT(mixer_note_on(&mixer, 0, 128, 127) == -EINVAL);
+    BTASSERT(mixer_note_on(&mixer, 0, 60, 128) == -EINVAL);
+    BTASSERT(mixer_note_on(&mixer, -1, 60, 127) == -EINVAL);
+
+    /* Silence. */
+    BTASSERT(mixer_render(&mixer, samples, membersof(samples)) == 0);
+    BTASSERT(max_abs(samples, membersof(samples)) == 0);
+
+    return (0);
+}
+
+static int test_frequency(void)
+{
+    size_t i;
+    int crossings;
+
+    BTASSERT(mixer_init(&mixer, SAMPLE_RATE) == 0);
+
+    /* A4 is 440 Hz, 88 zero crossings in 100 ms. */
+    BTASSERT(mixer_note_on(&mixer, 0, MIDI_NOTE_A4, 127) == 0);
+    BTASSERT(mixer_get_active_voices(&mixer) == 1);
+    BTASSERT(mixer_render(&mixer, samples, membersof(samples)) == 0);
+
+    crossings = 0;
+
+    for (i = 1; i < membersof(samples); i++) {
+        if ((samples[i - 1] < 0) != (samples[i] < 0)) {
+            crossings++;
+        }
+    }
+
+    BTASSERT_IN_RANGE(crossings, 87, 89);
+    BTASSERT_IN_RANGE(max_abs(samples, membersof(samples)), 32700, 32767);
+
+    /* Half velocity is half amplitude. */
+    BTASSERT(mixer_init(&mixer, SAMPLE_RATE) == 0);
+    BTASSERT(mixer_note_on(&mixer, 0, MIDI_NOTE_A0, 64) == 0);
+    BTASSERT(mixer_render(&mixer, samples, membersof(samples)) == 0);
+    BTASSERT_IN_RANGE(max_abs(samples, membersof(samples)), 16400, 16520);
+
+    return (0);
+}
+
+static int test_envelope(void)
+{
+    BTASSERT(mixer_init(&mixer, SAMPLE_RATE) == 0);
+    BTASSERT(mixer_set_waveform(&mixer,
+                                0,
+                                mixer_waveform_square,
+                                MIXER_WAVEFORM_LENGTH) == 0);
+    BTASSERT(mixer_set_envelope(&mixer, 100, 100, 16384, 200) == 0);
+    BTASSERT(mixer_note_on(&mixer, 0, MIDI_NOTE_A4, 127) == 0);
+
+    /* Attack. */
+    BTASSERT(mixer_render(&mixer, samples, 50) == 0);
+    BTASSERT_IN_RANGE(abs(samples[0]), 0, 400);
+    BTASSERT_IN_RANGE(abs(samples[49]), 15800, 16400);
+    BTASSERT(mixer_render(&mixer, samples, 50) == 0);
+    BTASSERT_IN_RANGE(abs(samples[49]), 32000, 32767);
+
+    /* Decay. */
+    BTASSERT(mixer_render(&mixer, samples, 100) == 0);
+    BTASSERT_IN_RANGE(abs(samples[49]), 24000, 24900);
+    BTASSERT_IN_RANGE(abs(samples[99]), 16450, 16650);
+
+    /* Sustain. */
+    BTASSERT(mixer_render(&mixer, samples, 1000) == 0);
+    BTASSERT_IN_RANGE(abs(samples[0]), 16300, 16400);
+    BTASSERT_IN_RANGE(abs(samples[999]), 16300, 16400);
+    BTASSERT(mixer_get_active_voices(&mixer) == 1);
+
+    /* Release. */
+    BTASSERT(mixer_note_off(&mixer, 0, MIDI_NOTE_A4) == 0);
+    BTASSERT(mixer_render(&mixer, samples, 100) == 0);
+    BTASSERT_IN_RANGE(abs(samples[99]), 8000, 8300);
+    BTASSERT(mixer_get_active_voices(&mixer) == 1);
+    BTASSERT(mixer_render(&mixer, samples, 200) == 0);
+    BTASSERT(samples[100] == 0);
+    BTASSERT(samples[199] == 0);
+    BTASSERT(mixer_get_active_voices(&mixer) == 0);
+
+    /* Zero sustain ends the note after the decay. */
+    BTASSERT(mixer_set_envelope(&mixer, 0, 100, 0, 0) == 0);
+    BTASSERT(mixer_note_on(&mixer, 0, MIDI_NOTE_A4, 127) == 0);
+    BTASSERT(mixer_render(&mixer, samples, 64) == 0);
+    BTASSERT(mixer_get_active_voices(&mixer) == 1);
+    BTASSERT(mixer_render(&mixer, samples, 64) == 0);
+    BTASSERT(mixer_get_active_voices(&mixer) == 0);
+
+    /* Velocity zero is a note off. */
+    BTASSERT(mixer_set_envelope(&mixer, 0, 0, 32767, 0) == 0);
+    BTASSERT(mixer_note_on(&mixer, 0, MIDI_NOTE_A4, 127) == 0);
+    BTASSERT(mixer_note_on(&mixer, 0, MIDI_NOTE_A4, 0) == 0);
+    BTASSERT(mixer_render(&mixer, samples, 64) == 0);
+    BTASSERT(mixer_get_active_voices(&mixer) == 0);
+
+    return (0);
+}
+
+static int test_voice_stealing(void)
+{
+    int i;
+
+    BTASSERT(mixer_init(&mixer, SAMPLE_RATE) == 0);
+    BTASSERT(mixer_set_envelope(&mixer, 0, 0, 32767, 1000) == 0);
+
+    for (i = 0; i < CONFIG_MIXER_VOICES_MAX; i++) {
+        BTASSERT(mixer_note_on(&mixer, 0, 40 + i, 100) == 0);
+    }
+
+    BTASSERT(mixer_get_active_voices(&mixer) == CONFIG_MIXER_VOICES_MAX);
+    BTASSERT(mixer_get_stolen_voices(&mixer) == 0);
+
+    /* Restarting a playing note does not use another voice. */
+    BTASSERT(mixer_note_on(&mixer, 0, 41, 100) == 0);
+    BTASSERT(mixer_get_stolen_voices(&mixer) == 0);
+
+    /* The oldest voice, note 40, is stolen. */
+    BTASSERT(mixer_note_on(&mixer, 1, 40, 100) == 0);
+    BTASSERT(mixer_get_stolen_voices(&mixer) == 1);
+    BTASSERT(mixer.voices[0].channel == 1);
+    BTASSERT(mixer.voices[0].note == 40);
+
+    /* A releasing voice is stolen before the oldest voice. */
+    BTASSERT(mixer_note_off(&mixer, 0, 45) == 0);
+    BTASSERT(mixer_render(&mixer, samples, 64) == 0);
+    BTASSERT(mixer.voices[5].state == MIXER_VOICE_STATE_RELEASE);
+    BTASSERT(mixer_note_on(&mixer, 1, 41, 100) == 0);
+    BTASSERT(mixer_get_stolen_voices(&mixer) == 2);
+    BTASSERT(mixer.voices[5].channel == 1);
+    BTASSERT(mixer.voices[5].note == 41);
+    BTASSERT(mixer.voices[1].channel == 0);
+
+    /* Release all notes. */
+    BTASSERT(mixer_all_notes_off(&mixer) == 0);
+    BTASSERT(mixer_render(&mixer, samples, 1100) == 0);
+    BTASSERT(mixer_get_active_voices(&mixer) == 0);
+
+    return (0);
+}
+
+static int test_muted(void)
+{
+    BTASSERT(mixer_init(&mixer, SAMPLE_RATE) == 0);
+    BTASSERT(mixer_note_on(&mixer, 3, MIDI_NOTE_A4, 127) == 0);
+    BTASSERT(mixer_set_muted(&mixer, 3, 1) == 0);
+    BTASSERT(mixer_render(&mixer, samples, 256) == 0);
+    BTASSERT(max_abs(samples, 256) == 0);
+    BTASSERT(mixer_set_muted(&mixer, 3, 0) == 0);
+    BTASSERT(mixer_render(&mixer, samples, 256) == 0);
+    BTASSERT(max_abs(samples, 256) > 30000);
+
+    return (0);
+}
+
+static int test_render_dac(void)
+{
+    uint32_t dac_samples[100];
+    size_t i;
+
+    BTASSERT(mixer_init(&mixer, SAMPLE_RATE) == 0);
+
+    /* Silence is the middle of the range. */
+    BTASSERT(mixer_render_dac(&mixer, dac_samples, 100) == 0);
+
+    for (i = 0; i < 100; i++) {
+        BTASSERT(dac_samples[i] == 2048);
+    }
+
+    /* A square wave with the output shift 8 is 2048 +- 128. */
+    BTASSERT(mixer_set_waveform(&mixer,
+                                0,
+                                mixer_waveform_square,
+                                MIXER_WAVEFORM_LENGTH) == 0);
+    BTASSERT(mixer_note_on(&mixer, 0, MIDI_NOTE_A4, 127) == 0);
+    BTASSERT(mixer_render_dac(&mixer, dac_samples, 100) == 0);
+    BTASSERT(dac_samples[1] == 2048 + 127);
+
+    /* Saturation. */
+    BTASSERT(mixer_set_output_shift(&mixer, 0) == 0);
+    BTASSERT(mixer_dac_stream_fill_isr(&mixer, dac_samples, 100) == 100);
+
+    for (i = 0; i < 100; i++) {
+        BTASSERT((dac_samples[i] == 0) || (dac_samples[i] == 4095));
+    }
+
+    return (0);
+}
+
+int main()
+{
+    struct harness_testcase_t testcases[] = {
+        { test_init, "test_init" },
+        { test_frequency, "test_frequency" },
+        { test_envelope, "test_envelope" },
+        { test_voice_stealing, "test_voice_stealing" },
+        { test_muted, "test_muted" },
+        { test_render_dac, "test_render_dac" },
+        { NULL, NULL }
+    };
+
+    sys_start();
+
+    harness_run(testcases);
+
+    return (0);
+}
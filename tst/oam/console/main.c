@@ -0,0 +1,153 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2014-2018, Erik Moqvist
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use, copy,
+ * modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ * This file is part of the Simba project.
+ */
+
+#include "simba.h"
+
+static char data[200];
+
+/**
+ * Let the drain thread empty the output buffer.
+ */
+static void drain(void)
+{
+    thrd_sleep_ms(20);
+}
+
+static int test_init(void)
+{
+    memset(&data[0], '-', sizeof(data));
+    data[sizeof(data) - 2] = '\r';
+    data[sizeof(data) - 1] = '\n';
+
+    BTASSERT(console_set_output_policy(3) == -EINVAL);
+
+    return (0);
+}
+
+static int test_drop_newest(void)
+{
+    void *chout_p;
+    uint32_t dropped;
+
+    chout_p = console_get_output_channel();
+    drain();
+    dropped = console_get_output_dropped();
+
+    /* The drain thread has lower priority than this thread, so only
+       the buffer size is written. */
+    BTASSERT(console_set_output_policy(
+                 CONFIG_START_CONSOLE_OUTPUT_POLICY_DROP_NEWEST) == 0);
+    BTASSERT(chan_write(chout_p, &data[100], 100) == 100);
+    BTASSERT(console_get_output_dropped() == dropped + 36);
+    BTASSERT(chan_write(chout_p, &data[190], 10) == 10);
+    BTASSERT(console_get_output_dropped() == dropped + 46);
+    BTASSERT(console_set_output_policy(
+                 CONFIG_START_CONSOLE_OUTPUT_POLICY_BLOCK) == 0);
+    drain();
+
+    return (0);
+}
+
+static int test_drop_oldest(void)
+{
+    void *chout_p;
+    uint32_t dropped;
+
+    chout_p = console_get_output_channel();
+    drain();
+    dropped = console_get_output_dropped();
+
+    BTASSERT(console_set_output_policy(
+                 CONFIG_START_CONSOLE_OUTPUT_POLICY_DROP_OLDEST) == 0);
+    BTASSERT(chan_write(chout_p, &data[100], 100) == 100);
+    BTASSERT(console_get_output_dropped() == dropped + 36);
+    BTASSERT(chan_write(chout_p, &data[190], 10) == 10);
+    BTASSERT(console_get_output_dropped() == dropped + 46);
+    BTASSERT(console_set_output_policy(
+                 CONFIG_START_CONSOLE_OUTPUT_POLICY_BLOCK) == 0);
+    drain();
+
+    return (0);
+}
+
+static int test_block(void)
+{
+    void *chout_p;
+    uint32_t dropped;
+
+    chout_p = console_get_output_channel();
+    dropped = console_get_output_dropped();
+
+    /* Waits for the drain thread instead of dropping. */
+    BTASSERT(chan_write(chout_p, &data[0], sizeof(data)) == sizeof(data));
+    BTASSERT(console_get_output_dropped() == dropped);
+
+    return (0);
+}
+
+static int test_priority(void)
+{
+    void *chout_p;
+    void *priority_chout_p;
+    uint32_t dropped;
+
+    chout_p = console_get_output_channel();
+    priority_chout_p = console_get_priority_output_channel();
+    drain();
+    dropped = console_get_output_dropped();
+
+    /* Priority output is not dropped when the buffer is full. */
+    BTASSERT(console_set_output_policy(
+                 CONFIG_START_CONSOLE_OUTPUT_POLICY_DROP_NEWEST) == 0);
+    BTASSERT(chan_write(chout_p, &data[136], 64) == 64);
+    BTASSERT(chan_write(priority_chout_p, &data[190], 10) == 10);
+    BTASSERT(console_get_output_dropped() == dropped);
+    BTASSERT(console_set_output_policy(
+                 CONFIG_START_CONSOLE_OUTPUT_POLICY_BLOCK) == 0);
+    drain();
+
+    return (0);
+}
+
+int main()
+{
+    struct harness_testcase_t testcases[] = {
+        { test_init, "test_init" },
+        { test_drop_newest, "test_drop_newest" },
+        { test_drop_oldest, "test_drop_oldest" },
+        { test_block, "test_block" },
+        { test_priority, "test_priority" },
+        { NULL, NULL }
+    };
+
+    sys_start();
+
+    harness_run(testcases);
+
+    return (0);
+}
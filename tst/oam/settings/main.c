@@ -400,6 +400,23 @@ static int test_cmd_list_after_updates(void)
 #endif
 }
 
+static int test_lookup_by_name(void)
+{
+    char buf[8];
+
+    BTASSERTI(settings_read_by_name("string", &buf[0], 4), ==, 4);
+    BTASSERTI(settings_read_by_name("string_space", &buf[0], 4), ==, 4);
+    BTASSERTI(settings_read_by_name("string_escape", &buf[0], 8), ==, 8);
+    BTASSERTI(settings_read_by_name("max_name_length_40_123456789012345678901",
+                                    &buf[0],
+                                    4), ==, 4);
+    BTASSERTI(settings_read_by_name("strin", &buf[0], 4), ==, -EINVAL);
+    BTASSERTI(settings_read_by_name("string_", &buf[0], 4), ==, -EINVAL);
+    BTASSERTI(settings_read_by_name("", &buf[0], 4), ==, -EINVAL);
+
+    return (0);
+}
+
 int main()
 {
     struct harness_testcase_t testcases[] = {
@@ -416,6 +433,7 @@ int main()
         { test_setting_blob_read_write, "test_setting_blob_read_write" },
         { test_read_write_by_name, "test_read_write_by_name" },
         { test_cmd_list_after_updates, "test_cmd_list_after_updates" },
+        { test_lookup_by_name, "test_lookup_by_name" },
         { NULL, NULL }
     };
 
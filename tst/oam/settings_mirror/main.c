@@ -0,0 +1,116 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2014-2018, Erik Moqvist
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use, copy,
+ * modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ * This file is part of the Simba project.
+ */
+
+
+#include "simba.h"
+
+static char qbuf[128];
+static struct queue_t queue;
+
+static int test_reset(void)
+{
+    int32_t int32;
+
+    BTASSERTI(settings_reset_all(), ==, 0);
+    BTASSERTI(settings_flush(), ==, 0);
+    BTASSERTI(nvm_read(&int32, SETTING_INT32_ADDR, 4), ==, 4);
+    BTASSERTI(int32, ==, -2);
+
+    return (0);
+}
+
+static int test_read_write(void)
+{
+    int32_t int32;
+    char buf[8];
+
+    /* Read from the mirror. */
+    BTASSERTI(setting_int32_read(&int32), ==, 0);
+    BTASSERTI(int32, ==, -2);
+    BTASSERTI(settings_read_by_name("string", &buf[0], 4), ==, 4);
+    BTASSERTM(&buf[0], "y", 2);
+
+    /* Written to the mirror only. */
+    BTASSERTI(setting_int32_write(55), ==, 0);
+    int32 = 0;
+    BTASSERTI(setting_int32_read(&int32), ==, 0);
+    BTASSERTI(int32, ==, 55);
+    BTASSERTI(nvm_read(&int32, SETTING_INT32_ADDR, 4), ==, 4);
+    BTASSERTI(int32, ==, -2);
+
+    return (0);
+}
+
+static int test_flush(void)
+{
+    int32_t int32;
+    char buf[64];
+
+    /* Write back. */
+    BTASSERTI(settings_flush(), ==, 0);
+    BTASSERTI(nvm_read(&int32, SETTING_INT32_ADDR, 4), ==, 4);
+    BTASSERTI(int32, ==, 55);
+    BTASSERTI(settings_flush(), ==, 0);
+
+    /* Unmodified values are not written. */
+    BTASSERTI(setting_int32_write(55), ==, 0);
+    BTASSERTI(setting_string_write("fs"), ==, 0);
+    BTASSERTI(nvm_write(SETTING_INT32_ADDR, "\x00\x00\x00\x00", 4), ==, 4);
+
+    strcpy(buf, "oam/settings/flush foo");
+    BTASSERTI(fs_call(buf, NULL, &queue, NULL), ==, -EINVAL);
+    BTASSERTI(harness_expect(&queue, "Usage: flush\r\n", NULL), ==, 14);
+    strcpy(buf, "oam/settings/flush");
+    BTASSERTI(fs_call(buf, NULL, &queue, NULL), ==, 0);
+
+    /* The string is in the same block as the integer. */
+    BTASSERTI(nvm_read(&buf[0], SETTING_STRING_ADDR, 3), ==, 3);
+    BTASSERTM(&buf[0], "fs", 3);
+    BTASSERTI(nvm_read(&int32, SETTING_INT32_ADDR, 4), ==, 4);
+    BTASSERTI(int32, ==, 55);
+
+    return (0);
+}
+
+int main()
+{
+    struct harness_testcase_t testcases[] = {
+        { test_reset, "test_reset" },
+        { test_read_write, "test_read_write" },
+        { test_flush, "test_flush" },
+        { NULL, NULL }
+    };
+
+    sys_start();
+
+    queue_init(&queue, qbuf, sizeof(qbuf));
+
+    harness_run(testcases);
+
+    return (0);
+}
@@ -84,6 +84,18 @@ static THRD_STACK(shell_stack, 1024);
 #endif
 static struct shell_t shell;
 
+static char qbatchinbuf[64];
+static QUEUE_INIT_DECL(qbatchin, qbatchinbuf, sizeof(qbatchinbuf));
+static char qbatchoutbuf[128];
+static QUEUE_INIT_DECL(qbatchout, qbatchoutbuf, sizeof(qbatchoutbuf));
+
+#if defined(ARCH_ARM64)
+static THRD_STACK(batch_shell_stack, 2048);
+#else
+static THRD_STACK(batch_shell_stack, 1024);
+#endif
+static struct shell_t batch_shell;
+
 #define BUFFER_SIZE 512
 
 static int test_init(void)
@@ -733,6 +745,35 @@ static int test_comment(void)
     return (0);
 }
 
+static int test_batch_mode(void)
+{
+    BTASSERT(shell_init(&batch_shell,
+                        &qbatchin,
+                        &qbatchout,
+                        NULL,
+                        "batch_shell",
+                        NULL,
+                        NULL) == 0);
+    BTASSERT(shell_set_batch_mode(&batch_shell, 1) == 0);
+    BTASSERT(thrd_spawn(shell_main,
+                        &batch_shell,
+                        0,
+                        batch_shell_stack,
+                        sizeof(batch_shell_stack)) != NULL);
+
+    /* No echo, no prompt and no line editing. */
+    chan_write(&qbatchin, "/tmp/bar 3\r\n", 12);
+    BTASSERTI(harness_expect(&qbatchout, "bar 6\nOK\r\n", NULL), ==, 10);
+
+    chan_write(&qbatchin, "\n# comment\n/1/2\n", 17);
+    BTASSERTI(harness_expect(&qbatchout,
+                             "/1/2: command not found\r\n"
+                             "ERROR(-1003)\r\n",
+                             NULL), ==, 39);
+
+    return (0);
+}
+
 static int test_logout(void)
 {
     /* Logout. */
@@ -769,6 +810,7 @@ int main()
         { test_history_up_down, "test_history_up_down" },
         { test_history_search, "test_history_search" },
         { test_comment, "test_comment" },
+        { test_batch_mode, "test_batch_mode" },
         { test_logout, "test_logout" },
         { NULL, NULL }
     };
@@ -33,6 +33,7 @@
 static struct soam_t soam;
 static uint8_t txbuf[TX_BUFFER_SIZE];
 static uint8_t queuebuf[256];
+static uint8_t compressionbuf[TX_BUFFER_SIZE];
 
 static struct queue_t chout;
 static struct fs_command_t cmd_foo;
@@ -415,6 +416,176 @@ static int test_stdout(void)
     return (0);
 }
 
+/**
+ * Read a packet and verify its header and crc. Returns the payload
+ * size.
+ */
+static ssize_t read_packet(uint8_t *buf_p, int type_flags)
+{
+    size_t size;
+    uint16_t crc;
+
+    BTASSERT(chan_read(&chout, &buf_p[0], 5) == 5);
+    BTASSERTI(buf_p[0], ==, type_flags);
+    size = ((buf_p[3] << 8) | buf_p[4]);
+    BTASSERT(chan_read(&chout, &buf_p[5], size) == size);
+    crc = ((buf_p[size + 3] << 8) | buf_p[size + 4]);
+    BTASSERT(crc_ccitt(0xffff, &buf_p[0], size + 3) == crc);
+
+    return (size - 2);
+}
+
+static int test_batch(void)
+{
+    uint8_t buf[64];
+    uint8_t data[60];
+
+    memset(&data[0], 'x', sizeof(data));
+
+    BTASSERT(soam_set_batching(&soam, 1) == 0);
+
+    /* Two small stdout packets in one batch packet. */
+    BTASSERT(soam_write(&soam, 0x20, "ab", 2) == 2);
+    BTASSERT(soam_write(&soam, 0x20, "cde", 3) == 3);
+    BTASSERT(chan_size(&chout) == 0);
+    BTASSERT(soam_flush(&soam) == 0);
+
+    BTASSERTI(read_packet(&buf[0], 0xd1), ==, 11);
+    BTASSERTM(&buf[5], "\x20\x00\x02" "ab" "\x20\x00\x03" "cde", 11);
+    BTASSERT(soam_flush(&soam) == 0);
+    BTASSERT(chan_size(&chout) == 0);
+
+    /* The second record does not fit and is moved to the next batch
+       packet. */
+    BTASSERT(soam_write(&soam, 0x20, &data[0], 20) == 20);
+    BTASSERT(soam_write(&soam, 0x10, &data[0], 20) == 20);
+    BTASSERTI(read_packet(&buf[0], 0xd1), ==, 23);
+    BTASSERTM(&buf[5], "\x20\x00\x14", 3);
+    BTASSERTM(&buf[8], &data[0], 20);
+    BTASSERT(soam_flush(&soam) == 0);
+    BTASSERTI(read_packet(&buf[0], 0xd1), ==, 23);
+    BTASSERTM(&buf[5], "\x10\x00\x14", 3);
+    BTASSERTM(&buf[8], &data[0], 20);
+
+    /* A record larger than a batch packet is sent as a regular
+       packet. */
+    BTASSERT(soam_write(&soam, 0x20, &data[0], 60) == 19);
+    BTASSERTI(read_packet(&buf[0], 0x20), ==, 41);
+    BTASSERTM(&buf[5], &data[0], 41);
+    BTASSERTI(read_packet(&buf[0], 0x23), ==, 19);
+    BTASSERTM(&buf[5], &data[0], 19);
+    BTASSERT(soam_flush(&soam) == 0);
+    BTASSERT(chan_size(&chout) == 0);
+
+    /* Other packet types are not batched, and the pending batch
+       packet is sent before them. */
+    BTASSERT(soam_write(&soam, 0x20, "ab", 2) == 2);
+    BTASSERT(soam_write(&soam, 0x70, "\x00\x00\x00\x00", 4) == 4);
+    BTASSERTI(read_packet(&buf[0], 0xd1), ==, 5);
+    BTASSERTM(&buf[5], "\x20\x00\x02" "ab", 5);
+    BTASSERTI(read_packet(&buf[0], 0x71), ==, 4);
+
+    /* Pending records are sent when batching is disabled. */
+    BTASSERT(soam_write(&soam, 0x30, "log", 3) == 3);
+    BTASSERT(soam_set_batching(&soam, 0) == 0);
+    BTASSERTI(read_packet(&buf[0], 0xd1), ==, 6);
+    BTASSERTM(&buf[5], "\x30\x00\x03" "log", 6);
+    BTASSERT(soam_write(&soam, 0x20, "ab", 2) == 2);
+    BTASSERTI(read_packet(&buf[0], 0x21), ==, 2);
+    BTASSERT(chan_size(&chout) == 0);
+
+    return (0);
+}
+
+/**
+ * LZSS decompress given data into given buffer.
+ */
+static ssize_t decompress(uint8_t *dst_p,
+                          const uint8_t *src_p,
+                          size_t size)
+{
+    size_t pos;
+    size_t dst_pos;
+    size_t offset;
+    size_t length;
+    int flags;
+    int bit;
+
+    pos = 0;
+    dst_pos = 0;
+
+    while (pos < size) {
+        flags = src_p[pos++];
+
+        for (bit = 0; (bit < 8) && (pos < size); bit++) {
+            if (flags & (1 << bit)) {
+                offset = (((src_p[pos] << 4) | (src_p[pos + 1] >> 4)) + 1);
+                length = ((src_p[pos + 1] & 0xf) + 3);
+                pos += 2;
+
+                while (length > 0) {
+                    dst_p[dst_pos] = dst_p[dst_pos - offset];
+                    dst_pos++;
+                    length--;
+                }
+            } else {
+                dst_p[dst_pos++] = src_p[pos++];
+            }
+        }
+    }
+
+    return (dst_pos);
+}
+
+static int test_compression(void)
+{
+    uint8_t buf[64];
+    uint8_t data[40];
+    uint8_t decompressed[40];
+    ssize_t size;
+    int i;
+
+    for (i = 0; i < 20; i++) {
+        data[i] = 'a';
+        data[20 + i] = (i ^ 0x5a);
+    }
+
+    BTASSERT(soam_set_compression_buffer(&soam,
+                                         &compressionbuf[0],
+                                         sizeof(compressionbuf)) == 0);
+
+    /* Compressible command response data. */
+    BTASSERT(soam_write(&soam, 0x60, &data[0], 20) == 20);
+    size = read_packet(&buf[0], 0x65);
+    BTASSERT(size < 20);
+    BTASSERTI(decompress(&decompressed[0], &buf[5], size), ==, 20);
+    BTASSERTM(&decompressed[0], &data[0], 20);
+
+    /* Compressible printf command response data. */
+    BTASSERT(soam_write(&soam, 0x50, &data[0], 40) == 40);
+    size = read_packet(&buf[0], 0x55);
+    BTASSERT(size < 40);
+    BTASSERTI(decompress(&decompressed[0], &buf[5], size), ==, 40);
+    BTASSERTM(&decompressed[0], &data[0], 40);
+
+    /* Incompressible data. */
+    BTASSERT(soam_write(&soam, 0x60, &data[20], 16) == 16);
+    BTASSERTI(read_packet(&buf[0], 0x61), ==, 16);
+    BTASSERTM(&buf[5], &data[20], 16);
+
+    /* Other packet types are never compressed. */
+    BTASSERT(soam_write(&soam, 0x20, &data[0], 20) == 20);
+    BTASSERTI(read_packet(&buf[0], 0x21), ==, 20);
+    BTASSERTM(&buf[5], &data[0], 20);
+
+    BTASSERT(soam_set_compression_buffer(&soam, NULL, 0) == 0);
+    BTASSERT(soam_write(&soam, 0x60, &data[0], 20) == 20);
+    BTASSERTI(read_packet(&buf[0], 0x61), ==, 20);
+    BTASSERT(chan_size(&chout) == 0);
+
+    return (0);
+}
+
 int main()
 {
     struct harness_testcase_t testcases[] = {
@@ -425,6 +596,8 @@ int main()
         { test_bad_input, "test_bad_input" },
         { test_invalid_type, "test_invalid_type" },
         { test_stdout, "test_stdout" },
+        { test_batch, "test_batch" },
+        { test_compression, "test_compression" },
         { NULL, NULL }
     };
 
@@ -32,9 +32,9 @@
 #define APPLICATION_ADDRESS                      0x00000000
 #define APPLICATION_SIZE                         0x20000000
 
-static uint8_t inbuf[128];
-static uint8_t outbuf[128];
-static char buf[128];
+static uint8_t inbuf[256];
+static uint8_t outbuf[256];
+static char buf[256];
 
 static int test_send_file_kermit(void)
 {
@@ -50,7 +50,7 @@ static int test_send_file_kermit(void)
         "\x01#$B+\r";
 
     static char output[] =
-        "\x01""0 Y~!  -#N1N\" !~(\r"
+        "\x01""0 Y~!  -#N1N&(*j)\r"
         "\x01#!Y?\r"
         "\x01#\"Y@\r"
         "\x01##YA\r"
@@ -70,10 +70,59 @@ static int test_send_file_kermit(void)
     return (0);
 }
 
+static int test_send_file_kermit_sliding_window(void)
+{
+    struct queue_t qin;
+    struct queue_t qout;
+
+    /* Packet 2 is lost and packet 3 is received before it, the ACK of
+       packet 2 is lost, packet 3 is corrupted and packet 4 is a long
+       packet. */
+    static char input[] =
+        "\x01""9 S~/ @-#Y3~^>J)0___F\"U1@?\r"
+        "\x01""%!Dab.\r"
+        "\x01""%#Def8\r"
+        "\x01""%\"Dcd3\r"
+        "\x01""%\"Dcd3\r"
+        "\x01""%#Def9\r"
+        "\x01""%#Def8\r"
+        "\x01"" $D \"-g?\r"
+        "\x01""#%ZD\r"
+        "\x01""#&B-\r";
+
+    static char output[] =
+        "\x01""0 Y~!  -#N1N&(*j)\r"
+        "\x01""#!Y?\r"
+        "\x01""#\"N5\r"
+        "\x01""##N6\r"
+        "\x01""#\"Y@\r"
+        "\x01""#\"Y@\r"
+        "\x01""##N6\r"
+        "\x01""##YA\r"
+        "\x01""#$YB\r"
+        "\x01""#%YC\r"
+        "\x01""#&YD\r"
+        "File transfer completed successfully.\r\n";
+
+    queue_init(&qin, inbuf, sizeof(inbuf));
+    queue_init(&qout, outbuf, sizeof(outbuf));
+
+    upgrade_kermit_init(&qin, &qout);
+
+    queue_write(&qin, input, sizeof(input) - 1);
+    BTASSERT(upgrade_kermit_load_file() == 0);
+    queue_read(&qout, buf, sizeof(output) - 1);
+    BTASSERT(memcmp(output, buf, sizeof(output) - 1) == 0);
+
+    return (0);
+}
+
 int main()
 {
     struct harness_testcase_t testcases[] = {
         { test_send_file_kermit, "test_send_file_kermit" },
+        { test_send_file_kermit_sliding_window,
+          "test_send_file_kermit_sliding_window" },
         { NULL, NULL }
     };
 
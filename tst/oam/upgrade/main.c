@@ -28,8 +28,14 @@
 
 #include "simba.h"
 
+extern uint8_t upgrade_test_application[256];
+extern uint8_t upgrade_test_uploaded[256];
+extern size_t upgrade_test_uploaded_size;
+
 static int test_bootloader(void)
 {
+    BTASSERT(upgrade_module_init() == 0);
+
     BTASSERT(upgrade_bootloader_enter() == -1);
     BTASSERT(upgrade_bootloader_stay_set() == 0);
     BTASSERT(upgrade_bootloader_stay_get() == 1);
@@ -49,13 +55,13 @@ static int test_binary_upload(void)
         /* Data size. */
         0, 0, 0, 2,
         /* Data SHA1. */
-        1, 2, 3, 4, 5, 6, 7, 8,
-        9, 0, 1, 2, 3, 4, 5, 6,
-        7, 8, 9, 0,
+        0xda, 0x23, 0x61, 0x4e, 0x02, 0x46, 0x9a, 0x0d,
+        0x7c, 0x7b, 0xd1, 0xbd, 0xab, 0x5c, 0x9c, 0x47,
+        0x4b, 0x19, 0x04, 0xdc,
         /* Data description. */
         'f', 'o', 'o', '\0',
         /* Header CRC. */
-        0x91, 0x9e, 0x50, 0x12,
+        0xba, 0x9e, 0x1d, 0x80,
         /* Data. */
         'a', 'b'
     };
@@ -63,6 +69,27 @@ static int test_binary_upload(void)
     BTASSERT(upgrade_binary_upload_begin() == 0);
     BTASSERT(upgrade_binary_upload(&header_data_size_2[0], 42) == 0);
     BTASSERT(upgrade_binary_upload_end() == 0);
+    BTASSERT(upgrade_test_uploaded_size == 2);
+    BTASSERT(memcmp(&upgrade_test_uploaded[0], "ab", 2) == 0);
+
+    /* Data split over several calls. */
+    BTASSERT(upgrade_binary_upload_begin() == 0);
+    BTASSERT(upgrade_binary_upload(&header_data_size_2[0], 41) == 0);
+    BTASSERT(upgrade_binary_upload(&header_data_size_2[41], 1) == 0);
+    BTASSERT(upgrade_binary_upload_end() == 0);
+    BTASSERT(upgrade_test_uploaded_size == 2);
+    BTASSERT(memcmp(&upgrade_test_uploaded[0], "ab", 2) == 0);
+
+    /* Missing data. */
+    BTASSERT(upgrade_binary_upload_begin() == 0);
+    BTASSERT(upgrade_binary_upload(&header_data_size_2[0], 41) == 0);
+    BTASSERT(upgrade_binary_upload_end() == -1);
+
+    /* Corrupt data. */
+    header_data_size_2[41] = 'c';
+    BTASSERT(upgrade_binary_upload_begin() == 0);
+    BTASSERT(upgrade_binary_upload(&header_data_size_2[0], 42) == 0);
+    BTASSERT(upgrade_binary_upload_end() == -1);
 
     return (0);
 }
@@ -175,11 +202,111 @@ static int test_binary_upload_long_header(void)
     return (0);
 }
 
+static int test_binary_upload_patch(void)
+{
+    uint8_t patch[96] = {
+        /* Version. */
+        0, 0, 0, 2,
+        /* Header size. */
+        0, 0, 0, 68,
+        /* Data size. */
+        0, 0, 0, 200,
+        /* Data SHA1. */
+        0x77, 0x20, 0xec, 0xf9, 0xe5, 0xa8, 0x69, 0xb6,
+        0x43, 0x06, 0x95, 0x11, 0x86, 0x0f, 0x3b, 0x80,
+        0xf5, 0xf4, 0x9f, 0xf8,
+        /* Data format. */
+        0, 0, 0, 1,
+        /* Current application size. */
+        0, 0, 0, 200,
+        /* Current application SHA1. */
+        0x60, 0x71, 0xe0, 0x33, 0x8c, 0x68, 0xd8, 0xfb,
+        0xc6, 0xce, 0x92, 0xfe, 0x6b, 0xa2, 0x08, 0xfe,
+        0xa2, 0xb6, 0x8c, 0xf1,
+        /* Data description. */
+        'f', 'o', 'o', '\0',
+        /* Header CRC. */
+        0x2f, 0xed, 0xdb, 0xe9,
+        /* Copy 50 bytes. */
+        1, 50,
+        /* Add 4 bytes. */
+        2, 4, 0xf5, 0xe4, 0xe1, 0xcf,
+        /* Copy 46 bytes. */
+        1, 46,
+        /* Write 10 bytes. */
+        3, 10, '0', '1', '2', '3', '4', '5', '6', '7', '8', '9',
+        /* Copy 50 bytes. */
+        1, 50,
+        /* Skip 10 bytes. */
+        4, 20,
+        /* Copy 40 bytes. */
+        1, 40
+    };
+    uint8_t expected[200];
+    size_t i;
+
+    /* The current application and the expected application. */
+    for (i = 0; i < 200; i++) {
+        upgrade_test_application[i] = (i * 7);
+    }
+
+    memcpy(&expected[0], &upgrade_test_application[0], 100);
+    memcpy(&expected[50], "SIMB", 4);
+    memcpy(&expected[100], "0123456789", 10);
+    memcpy(&expected[110], &upgrade_test_application[100], 50);
+    memcpy(&expected[160], &upgrade_test_application[160], 40);
+
+    BTASSERT(upgrade_binary_upload_begin() == 0);
+    BTASSERT(upgrade_binary_upload(&patch[0], 96) == 0);
+    BTASSERT(upgrade_binary_upload_end() == 0);
+    BTASSERT(upgrade_test_uploaded_size == 200);
+    BTASSERT(memcmp(&upgrade_test_uploaded[0], &expected[0], 200) == 0);
+
+    /* One byte at a time. */
+    BTASSERT(upgrade_binary_upload_begin() == 0);
+
+    for (i = 0; i < 96; i++) {
+        BTASSERT(upgrade_binary_upload(&patch[i], 1) == 0);
+    }
+
+    BTASSERT(upgrade_binary_upload_end() == 0);
+    BTASSERT(upgrade_test_uploaded_size == 200);
+    BTASSERT(memcmp(&upgrade_test_uploaded[0], &expected[0], 200) == 0);
+
+    /* Truncated patch. */
+    BTASSERT(upgrade_binary_upload_begin() == 0);
+    BTASSERT(upgrade_binary_upload(&patch[0], 95) == 0);
+    BTASSERT(upgrade_binary_upload_end() == -1);
+
+    /* Bad operation. */
+    patch[68] = 5;
+    BTASSERT(upgrade_binary_upload_begin() == 0);
+    BTASSERT(upgrade_binary_upload(&patch[0], 96) == -1);
+    BTASSERT(upgrade_binary_upload_end() == -1);
+    patch[68] = 1;
+
+    /* Copy outside the current application. */
+    patch[95] = 41;
+    BTASSERT(upgrade_binary_upload_begin() == 0);
+    BTASSERT(upgrade_binary_upload(&patch[0], 96) == -1);
+    BTASSERT(upgrade_binary_upload_end() == -1);
+    patch[95] = 40;
+
+    /* The patch is created from another application. */
+    upgrade_test_application[0]++;
+    BTASSERT(upgrade_binary_upload_begin() == 0);
+    BTASSERT(upgrade_binary_upload(&patch[0], 96) == -1);
+    BTASSERT(upgrade_binary_upload_end() == -1);
+
+    return (0);
+}
+
 int main()
 {
     struct harness_testcase_t testcases[] = {
         { test_bootloader, "test_bootloader" },
         { test_binary_upload, "test_binary_upload" },
+        { test_binary_upload_patch, "test_binary_upload_patch" },
         { test_binary_upload_bad_version, "test_binary_upload_bad_version" },
         { test_binary_upload_bad_crc, "test_binary_upload_bad_crc" },
         { test_binary_upload_short_header, "test_binary_upload_short_header" },
@@ -402,7 +402,7 @@ static int test_request_download(void)
     BTASSERT(queue_read(&qout, &size, sizeof(size)) == sizeof(size));
     BTASSERT(size == 0x40);
     BTASSERT(queue_read(&qout, &max_size, sizeof(max_size)) == sizeof(max_size));
-    BTASSERT(ntohl(max_size) == 4096);
+    BTASSERT(ntohl(max_size) == CONFIG_UPGRADE_UDS_MAX_NUMBER_OF_BLOCK_LENGTH);
 
     return (0);
 }
@@ -423,12 +423,17 @@ static int test_transfer_data(void)
         0x00, 0x00, 0x00, 0x01,
         /* Bad length. */
         0, 0, 0, 1, 0x36,
-        /* /\* Transfer too much data. *\/ */
-        /* 0, 0, 0, 4, 0x36, 0x01, 0x5a, 0x5a, */
+        /* Transfer too much data. */
+        0, 0, 0, 6, 0x36, 0x01, 0x5a, 0x5a, 0x5a, 0x5a,
         /* Transfer wrong sequence number. */
         0, 0, 0, 3, 0x36, 0x02, 0x5a,
         /* Transfer ok. */
-        0, 0, 0, 3, 0x36, 0x01, 0x5a
+        0, 0, 0, 3, 0x36, 0x01, 0x5a,
+        /* Retransmission of the previous block. */
+        0, 0, 0, 3, 0x36, 0x01, 0x5a,
+        /* Transfer ok, back to back. */
+        0, 0, 0, 5, 0x36, 0x02, 0x5a, 0x5a, 0x5a,
+        0, 0, 0, 3, 0x36, 0x03, 0x5a
     };
     int32_t length;
     uint8_t code;
@@ -460,7 +465,7 @@ static int test_transfer_data(void)
     BTASSERT(queue_read(&qout, &size, sizeof(size)) == sizeof(size));
     BTASSERT(size == 0x40);
     BTASSERT(queue_read(&qout, &max_size, sizeof(max_size)) == sizeof(max_size));
-    BTASSERT(ntohl(max_size) == 4096);
+    BTASSERT(ntohl(max_size) == CONFIG_UPGRADE_UDS_MAX_NUMBER_OF_BLOCK_LENGTH);
 
     /* Bad length. */
     BTASSERT(upgrade_uds_handle_service(&uds) == -1);
@@ -471,14 +476,14 @@ static int test_transfer_data(void)
     BTASSERT(response[1] == 0x36);
     BTASSERT(response[2] == 0x13);
 
-    /* /\* Transfer too much data. *\/ */
-    /* BTASSERT(upgrade_uds_handle_service(&uds) == -1); */
-    /* BTASSERT(queue_read(&qout, &length, sizeof(length)) == sizeof(length)); */
-    /* BTASSERT(ntohl(length) == 3); */
-    /* BTASSERT(queue_read(&qout, response, 3) == 3); */
-    /* BTASSERT(response[0] == 0x7f); */
-    /* BTASSERT(response[1] == 0x36); */
-    /* BTASSERT(response[2] == 0x31); */
+    /* Transfer too much data. */
+    BTASSERT(upgrade_uds_handle_service(&uds) == -1);
+    BTASSERT(queue_read(&qout, &length, sizeof(length)) == sizeof(length));
+    BTASSERT(ntohl(length) == 3);
+    BTASSERT(queue_read(&qout, response, 3) == 3);
+    BTASSERT(response[0] == 0x7f);
+    BTASSERT(response[1] == 0x36);
+    BTASSERT(response[2] == 0x31);
 
     /* Transfer wrong sequence counter. */
     BTASSERT(upgrade_uds_handle_service(&uds) == -1);
@@ -500,6 +505,37 @@ static int test_transfer_data(void)
                         sizeof(block_sequence_counter)) == sizeof(block_sequence_counter));
     BTASSERT(block_sequence_counter == 0x01);
 
+    /* Retransmission of the previous block. */
+    BTASSERT(upgrade_uds_handle_service(&uds) == 0);
+    BTASSERT(queue_read(&qout, &length, sizeof(length)) == sizeof(length));
+    BTASSERT(ntohl(length) == 2);
+    BTASSERT(queue_read(&qout, &code, sizeof(code)) == sizeof(code));
+    BTASSERT(code == 0x76);
+    BTASSERT(queue_read(&qout,
+                        &block_sequence_counter,
+                        sizeof(block_sequence_counter)) == sizeof(block_sequence_counter));
+    BTASSERT(block_sequence_counter == 0x01);
+
+    /* Transfer ok, back to back. */
+    BTASSERT(upgrade_uds_handle_service(&uds) == 0);
+    BTASSERT(upgrade_uds_handle_service(&uds) == 0);
+    BTASSERT(queue_read(&qout, &length, sizeof(length)) == sizeof(length));
+    BTASSERT(ntohl(length) == 2);
+    BTASSERT(queue_read(&qout, &code, sizeof(code)) == sizeof(code));
+    BTASSERT(code == 0x76);
+    BTASSERT(queue_read(&qout,
+                        &block_sequence_counter,
+                        sizeof(block_sequence_counter)) == sizeof(block_sequence_counter));
+    BTASSERT(block_sequence_counter == 0x02);
+    BTASSERT(queue_read(&qout, &length, sizeof(length)) == sizeof(length));
+    BTASSERT(ntohl(length) == 2);
+    BTASSERT(queue_read(&qout, &code, sizeof(code)) == sizeof(code));
+    BTASSERT(code == 0x76);
+    BTASSERT(queue_read(&qout,
+                        &block_sequence_counter,
+                        sizeof(block_sequence_counter)) == sizeof(block_sequence_counter));
+    BTASSERT(block_sequence_counter == 0x03);
+
     return (0);
 }
 
@@ -563,7 +599,7 @@ static int test_request_transfer_exit(void)
     BTASSERT(queue_read(&qout, &size, sizeof(size)) == sizeof(size));
     BTASSERT(size == 0x40);
     BTASSERT(queue_read(&qout, &max_size, sizeof(max_size)) == sizeof(max_size));
-    BTASSERT(ntohl(max_size) == 4096);
+    BTASSERT(ntohl(max_size) == CONFIG_UPGRADE_UDS_MAX_NUMBER_OF_BLOCK_LENGTH);
 
     /* Transfer ok. */
     BTASSERT(upgrade_uds_handle_service(&uds) == 0);
@@ -26,6 +26,12 @@
  * This file is part of the Simba project.
  */
 
+/* The current application read when applying patches, and the
+   uploaded application. */
+uint8_t upgrade_test_application[256];
+uint8_t upgrade_test_uploaded[256];
+size_t upgrade_test_uploaded_size;
+
 static int upgrade_port_bootloader_enter()
 {
     return (-1);
@@ -87,26 +93,37 @@ static int upgrade_port_application_is_valid()
     return (0);
 }
 
+static int upgrade_port_application_read(void *dst_p,
+                                         size_t src,
+                                         size_t size)
+{
+    if (src + size > sizeof(upgrade_test_application)) {
+        return (-1);
+    }
+
+    memcpy(dst_p, &upgrade_test_application[src], size);
+
+    return (0);
+}
+
 static int upgrade_port_binary_upload_begin()
 {
+    upgrade_test_uploaded_size = 0;
+
     return (0);
 }
 
 static int upgrade_port_binary_upload(const void *buf_p,
                                       size_t size)
 {
-    static int counter = 0;
-
-    counter++;
-
-    if (counter == 1) {
-        BTASSERT(size == 2);
-        BTASSERT(memcmp(buf_p, "ab", 2) == 0);
-
-        return (0);
+    if (upgrade_test_uploaded_size + size > sizeof(upgrade_test_uploaded)) {
+        return (-1);
     }
 
-    return (-1);
+    memcpy(&upgrade_test_uploaded[upgrade_test_uploaded_size], buf_p, size);
+    upgrade_test_uploaded_size += size;
+
+    return (0);
 }
 
 static int upgrade_port_binary_upload_end()
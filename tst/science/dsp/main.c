@@ -0,0 +1,263 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2014-2018, Erik Moqvist
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use, copy,
+ * modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ * This file is part of the Simba project.
+ */
+
+#include "simba.h"
+#include <math.h>
+
+static int test_fir_q15(void)
+{
+    struct dsp_fir_q15_t fir;
+    static const int16_t coeffs[] = { 16384, 8192, -8192 };
+    int16_t state[2 * membersof(coeffs)];
+    int16_t samples[5] = { 32767, 0, 0, 0, 0 };
+
+    BTASSERT(dsp_fir_q15_init(&fir,
+                              &coeffs[0],
+                              &state[0],
+                              membersof(coeffs)) == 0);
+
+    /* Impulse response, in place and in two calls. */
+    BTASSERT(dsp_fir_q15_process(&fir, &samples[0], &samples[0], 2) == 0);
+    BTASSERT(dsp_fir_q15_process(&fir, &samples[2], &samples[2], 3) == 0);
+    BTASSERTI(samples[0], ==, 16383);
+    BTASSERTI(samples[1], ==, 8191);
+    BTASSERTI(samples[2], ==, -8192);
+    BTASSERTI(samples[3], ==, 0);
+    BTASSERTI(samples[4], ==, 0);
+
+    /* Full scale input. */
+    samples[0] = 32767;
+    samples[1] = 32767;
+    samples[2] = -32768;
+    samples[3] = -32768;
+    BTASSERT(dsp_fir_q15_process(&fir, &samples[0], &samples[0], 4) == 0);
+    BTASSERTI(samples[1], ==, 24575);
+    BTASSERTI(samples[3], ==, -32768);
+
+    return (0);
+}
+
+static int test_fir_q31(void)
+{
+    struct dsp_fir_q31_t fir;
+    static const int32_t coeffs[] = { 0x40000000, 0x20000000 };
+    int32_t state[2 * membersof(coeffs)];
+    int32_t samples[3] = { INT32_MAX, 0, 0 };
+
+    BTASSERT(dsp_fir_q31_init(&fir,
+                              &coeffs[0],
+                              &state[0],
+                              membersof(coeffs)) == 0);
+    BTASSERT(dsp_fir_q31_process(&fir,
+                                 &samples[0],
+                                 &samples[0],
+                                 membersof(samples)) == 0);
+    BTASSERTI(samples[0], ==, 0x3fffffff);
+    BTASSERTI(samples[1], ==, 0x1fffffff);
+    BTASSERTI(samples[2], ==, 0);
+
+    return (0);
+}
+
+static int test_biquad_q15(void)
+{
+    struct dsp_biquad_q15_t biquad;
+    int16_t state[8];
+    int16_t samples[4] = { 32767, 0, 0, 0 };
+
+    /* Two stages, y[n] = x[n] + 0.5 * y[n - 1] followed by a pass
+       through stage, with coefficients scaled by 1/2. */
+    static const int16_t coeffs[] = {
+        16384, 0, 0, -8192, 0,
+        16384, 0, 0, 0, 0
+    };
+
+    BTASSERT(dsp_biquad_q15_init(&biquad, &coeffs[0], &state[0], 2, 1) == 0);
+    BTASSERT(dsp_biquad_q15_process(&biquad,
+                                    &samples[0],
+                                    &samples[0],
+                                    membersof(samples)) == 0);
+    BTASSERTI(samples[0], ==, 32767);
+    BTASSERTI(samples[1], ==, 16383);
+    BTASSERTI(samples[2], ==, 8191);
+    BTASSERTI(samples[3], ==, 4095);
+
+    return (0);
+}
+
+static int test_biquad_q31(void)
+{
+    struct dsp_biquad_q31_t biquad;
+    int32_t state[4];
+    int32_t samples[3] = { INT32_MAX, 0, 0 };
+
+    /* y[n] = 0.5 * x[n] + 0.5 * y[n - 1]. */
+    static const int32_t coeffs[] = {
+        0x40000000, 0, 0, -0x40000000, 0
+    };
+
+    BTASSERT(dsp_biquad_q31_init(&biquad, &coeffs[0], &state[0], 1, 0) == 0);
+    BTASSERT(dsp_biquad_q31_process(&biquad,
+                                    &samples[0],
+                                    &samples[0],
+                                    membersof(samples)) == 0);
+    BTASSERTI(samples[0], ==, 0x3fffffff);
+    BTASSERTI(samples[1], ==, 0x1fffffff);
+    BTASSERTI(samples[2], ==, 0x0fffffff);
+
+    return (0);
+}
+
+static int test_decimator_q15(void)
+{
+    struct dsp_decimator_q15_t decimator;
+    static const int16_t coeffs[] = { 16384, 16384 };
+    int16_t state[2 * membersof(coeffs)];
+    int16_t samples[10];
+    int i;
+
+    for (i = 0; i < membersof(samples); i++) {
+        samples[i] = (1000 * i);
+    }
+
+    BTASSERT(dsp_decimator_q15_init(&decimator,
+                                    &coeffs[0],
+                                    &state[0],
+                                    membersof(coeffs),
+                                    3) == 0);
+
+    /* Averages of input samples 0 and -1, 3 and 2, 6 and 5, and 9 and
+       8. */
+    BTASSERTI(dsp_decimator_q15_process(&decimator,
+                                        &samples[0],
+                                        &samples[0],
+                                        5), ==, 2);
+    BTASSERTI(dsp_decimator_q15_process(&decimator,
+                                        &samples[5],
+                                        &samples[2],
+                                        5), ==, 2);
+    BTASSERTI(samples[0], ==, 0);
+    BTASSERTI(samples[1], ==, 2500);
+    BTASSERTI(samples[2], ==, 5500);
+    BTASSERTI(samples[3], ==, 8500);
+
+    return (0);
+}
+
+static int test_fft_q15(void)
+{
+    int16_t buf[2 * 64];
+    int16_t magnitudes[64];
+    int i;
+
+    /* A constant is transformed to the first bin. */
+    for (i = 0; i < 16; i++) {
+        buf[2 * i] = 1000;
+        buf[2 * i + 1] = 0;
+    }
+
+    BTASSERT(dsp_fft_q15(&buf[0], 16) == 0);
+    BTASSERTI(buf[0], ==, 1000);
+    BTASSERTI(buf[1], ==, 0);
+
+    for (i = 1; i < 16; i++) {
+        BTASSERTI(buf[2 * i], ==, 0);
+        BTASSERTI(buf[2 * i + 1], ==, 0);
+    }
+
+    /* A cosine with frequency 5 has half the amplitude in bins 5 and
+       59. */
+    for (i = 0; i < 64; i++) {
+        buf[2 * i] = (16384.0f * cosf(2.0f * MATH_PI * 5 * i / 64));
+        buf[2 * i + 1] = 0;
+    }
+
+    BTASSERT(dsp_fft_q15(&buf[0], 64) == 0);
+    BTASSERT(dsp_magnitude_q15(&buf[0], &magnitudes[0], 64) == 0);
+
+    for (i = 0; i < 64; i++) {
+        if ((i == 5) || (i == 59)) {
+            BTASSERTI(magnitudes[i], >=, 8192 - 16);
+            BTASSERTI(magnitudes[i], <=, 8192 + 16);
+        } else {
+            BTASSERTI(magnitudes[i], <=, 16);
+        }
+    }
+
+    return (0);
+}
+
+static int test_rms_peak_q15(void)
+{
+    static const int16_t square[] = { 16384, -16384, 16384, -16384 };
+    static const int16_t minimum[] = { 0, -32768, 100 };
+
+    BTASSERTI(dsp_rms_q15(&square[0], membersof(square)), ==, 16384);
+    BTASSERTI(dsp_peak_q15(&square[0], membersof(square)), ==, 16384);
+    BTASSERTI(dsp_rms_q15(&minimum[0], membersof(minimum)), ==, 18918);
+    BTASSERTI(dsp_peak_q15(&minimum[0], membersof(minimum)), ==, 32767);
+
+    return (0);
+}
+
+static int test_q15_from_adc(void)
+{
+    uint16_t samples[3] = { 0, 2048, 4095 };
+
+    /* In place conversion of 12 bits samples. */
+    BTASSERT(dsp_q15_from_adc(&samples[0],
+                              (int16_t *)&samples[0],
+                              membersof(samples),
+                              12) == 0);
+    BTASSERTI(((int16_t *)samples)[0], ==, -32768);
+    BTASSERTI(((int16_t *)samples)[1], ==, 0);
+    BTASSERTI(((int16_t *)samples)[2], ==, 32752);
+
+    return (0);
+}
+
+int main()
+{
+    struct harness_testcase_t testcases[] = {
+        { test_fir_q15, "test_fir_q15" },
+        { test_fir_q31, "test_fir_q31" },
+        { test_biquad_q15, "test_biquad_q15" },
+        { test_biquad_q31, "test_biquad_q31" },
+        { test_decimator_q15, "test_decimator_q15" },
+        { test_fft_q15, "test_fft_q15" },
+        { test_rms_peak_q15, "test_rms_peak_q15" },
+        { test_q15_from_adc, "test_q15_from_adc" },
+        { NULL, NULL }
+    };
+
+    sys_start();
+
+    harness_run(testcases);
+
+    return (0);
+}
@@ -27,6 +27,7 @@
  */
 
 #include "simba.h"
+#include <math.h>
 
 struct value_t {
     int integer;
@@ -193,6 +194,152 @@ static int test_log10_fixed_point(void)
     return (0);
 }
 
+static double to_double(int32_t value, int precision)
+{
+    return ((double)value / (1 << precision));
+}
+
+static int32_t from_double(double value, int precision)
+{
+    return (round(value * (1 << precision)));
+}
+
+static int test_sqrt_fixed_point(void)
+{
+    BTASSERTI(math_sqrt_fixed_point(0, 16), ==, 0);
+    BTASSERTI(math_sqrt_fixed_point(4 << 16, 16), ==, 2 << 16);
+    BTASSERTI(math_sqrt_fixed_point(2 << 16, 16), ==, 92681);
+    BTASSERTI(math_sqrt_fixed_point(1 << 14, 16), ==, 1 << 15);
+    BTASSERTI(math_sqrt_fixed_point(0xffffffff, 16), ==, 16777215);
+    BTASSERTI(math_sqrt_fixed_point(0xffffffff, 31), ==, 3037000499UL);
+    BTASSERTI(math_sqrt_fixed_point(1 << 30, 30), ==, 1 << 30);
+
+    return (0);
+}
+
+static int test_sin_cos_fixed_point(void)
+{
+    double angle;
+    double max_error;
+    int precision;
+    int i;
+
+    BTASSERTI(math_sin_fixed_point(0, 16), ==, 0);
+    BTASSERTI(math_cos_fixed_point(0, 16), ==, 1 << 16);
+    BTASSERTI(math_sin_fixed_point(from_double(M_PI / 2, 16), 16),
+              ==,
+              1 << 16);
+    BTASSERTI(math_cos_fixed_point(from_double(M_PI, 16), 16),
+              ==,
+              -(1 << 16));
+
+    max_error = 0.0;
+    precision = 28;
+
+    for (i = -4000; i <= 4000; i++) {
+        angle = (i * 0.001953125);
+        max_error = fmax(max_error,
+                         fabs(to_double(math_sin_fixed_point(
+                                            from_double(angle, precision),
+                                            precision),
+                                        precision)
+                              - sin(angle)));
+        max_error = fmax(max_error,
+                         fabs(to_double(math_cos_fixed_point(
+                                            from_double(angle, precision),
+                                            precision),
+                                        precision)
+                              - cos(angle)));
+    }
+
+    std_printf(OSTR("sin and cos max error: %d e-9\r\n"),
+               (int)(1e9 * max_error));
+    BTASSERT(max_error < 5e-6);
+
+    return (0);
+}
+
+static int test_atan2_fixed_point(void)
+{
+    double angle;
+    double max_error;
+    int precision;
+    int i;
+    int j;
+
+    precision = 29;
+
+    BTASSERTI(math_atan2_fixed_point(0, 0, 16), ==, 0);
+    BTASSERTI(math_atan2_fixed_point(0, 1, 16), ==, 0);
+    BTASSERTI(math_atan2_fixed_point(1, 0, 16), ==, from_double(M_PI / 2, 16));
+    BTASSERTI(math_atan2_fixed_point(0, -1, 16), ==, from_double(M_PI, 16));
+    BTASSERTI(math_atan2_fixed_point(-1, -1, 16),
+              ==,
+              from_double(-3 * M_PI / 4, 16));
+
+    max_error = 0.0;
+
+    for (i = -50; i <= 50; i++) {
+        for (j = -50; j <= 50; j++) {
+            angle = to_double(math_atan2_fixed_point(i * 40000000,
+                                                     j * 1234567,
+                                                     precision),
+                              precision);
+            max_error = fmax(max_error,
+                             fabs(angle - atan2(i * 40000000.0,
+                                                j * 1234567.0)));
+            angle = to_double(math_atan2_fixed_point(i, j, precision),
+                              precision);
+            max_error = fmax(max_error, fabs(angle - atan2(i, j)));
+        }
+    }
+
+    std_printf(OSTR("atan2 max error: %d e-9\r\n"), (int)(1e9 * max_error));
+    BTASSERT(max_error < 1e-8);
+
+    return (0);
+}
+
+static int test_exp_fixed_point(void)
+{
+    double x;
+    double max_error;
+    int precision;
+    int i;
+
+    BTASSERTI(math_exp2_fixed_point(0, 16), ==, 1 << 16);
+    BTASSERTI(math_exp2_fixed_point(3 << 16, 16), ==, 8 << 16);
+    BTASSERTI(math_exp2_fixed_point(-1 << 16, 16), ==, 1 << 15);
+    BTASSERTI(math_exp2_fixed_point(15 << 16, 16), ==, INT32_MAX);
+    BTASSERTI(math_exp2_fixed_point(-18 << 16, 16), ==, 0);
+    BTASSERTI(math_exp_fixed_point(0, 16), ==, 1 << 16);
+    BTASSERTI(math_exp_fixed_point(1 << 16, 16), ==, from_double(M_E, 16));
+    BTASSERTI(math_exp_fixed_point(30000 << 16, 16), ==, INT32_MAX);
+    BTASSERTI(math_exp_fixed_point(-30000 << 16, 16), ==, 0);
+
+    max_error = 0.0;
+    precision = 24;
+
+    for (i = -2000; i <= 400; i++) {
+        x = (i * 0.00390625);
+        /* Relative error, excluding the output resolution. */
+        max_error = fmax(max_error,
+                         (fabs(to_double(math_exp_fixed_point(
+                                             from_double(x, precision),
+                                             precision),
+                                         precision)
+                               - exp(from_double(x, precision)
+                                     / (double)(1 << precision)))
+                          - 1.0 / (1 << precision)) / exp(x));
+    }
+
+    std_printf(OSTR("exp max relative error: %d e-9\r\n"),
+               (int)(1e9 * max_error));
+    BTASSERT(max_error < 1e-8);
+
+    return (0);
+}
+
 int main()
 {
     struct harness_testcase_t testcases[] = {
@@ -201,6 +348,10 @@ int main()
         { test_log2_fixed_point, "test_log2_fixed_point" },
         { test_ln_fixed_point, "test_ln_fixed_point" },
         { test_log10_fixed_point, "test_log10_fixed_point" },
+        { test_sqrt_fixed_point, "test_sqrt_fixed_point" },
+        { test_sin_cos_fixed_point, "test_sin_cos_fixed_point" },
+        { test_atan2_fixed_point, "test_atan2_fixed_point" },
+        { test_exp_fixed_point, "test_exp_fixed_point" },
         { NULL, NULL }
     };
 
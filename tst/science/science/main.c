@@ -176,6 +176,97 @@ static int test_mps_from_mph(void)
     return (0);
 }
 
+static int test_pressure_to_altitude_fixed_point(void)
+{
+    int32_t altitude;
+
+    /* 22633 Pa, 10999.7 meters. */
+    altitude = science_pressure_to_altitude_fixed_point(22633, 101325, 8);
+    BTASSERT_IN_RANGE(altitude, 10999.68 * 256, 10999.78 * 256);
+
+    /* 46563 Pa, 6096.0 meters. */
+    altitude = science_pressure_to_altitude_fixed_point(46563, 101325, 8);
+    BTASSERT_IN_RANGE(altitude, 6095.98 * 256, 6096.08 * 256);
+
+    /* 101225 Pa, 8.3 meters. */
+    altitude = science_pressure_to_altitude_fixed_point(101225, 101325, 16);
+    BTASSERT_IN_RANGE(altitude, 8.28 * 65536, 8.38 * 65536);
+
+    /* 101325 Pa, 0.0 meters. */
+    altitude = science_pressure_to_altitude_fixed_point(101325, 101325, 8);
+    BTASSERT_IN_RANGE(altitude, -2, 2);
+
+    /* 121023 Pa, -1524.0 meters. */
+    altitude = science_pressure_to_altitude_fixed_point(121023, 101325, 8);
+    BTASSERT_IN_RANGE(altitude, -1524.03 * 256, -1523.93 * 256);
+
+    /* 99000 Pa, 84.7 meters with sea level pressure 100000 Pa. */
+    altitude = science_pressure_to_altitude_fixed_point(99000, 100000, 8);
+    BTASSERT_IN_RANGE(altitude, 84.64 * 256, 84.74 * 256);
+
+    /* Too low pressure. */
+    BTASSERT(science_pressure_to_altitude_fixed_point(22632, 101325, 8)
+             == INT32_MIN);
+
+    /* Bad precision. */
+    BTASSERT(science_pressure_to_altitude_fixed_point(101325, 101325, 17)
+             == INT32_MIN);
+
+    return (0);
+}
+
+static int test_pressure_from_altitude_fixed_point(void)
+{
+    int32_t pressure;
+
+    /* 22632 Pa, 11000.0 meters. */
+    pressure = science_pressure_from_altitude_fixed_point(10999.9 * 256,
+                                                          101325,
+                                                          8);
+    BTASSERT_IN_RANGE(pressure, 22632, 22633);
+
+    /* 46563 Pa, 6096.0 meters. */
+    pressure = science_pressure_from_altitude_fixed_point(6096 << 8,
+                                                          101325,
+                                                          8);
+    BTASSERT_IN_RANGE(pressure, 46563, 46564);
+
+    /* 101325 Pa, 0.0 meters. */
+    pressure = science_pressure_from_altitude_fixed_point(0, 101325, 8);
+    BTASSERT(pressure == 101325);
+
+    /* 121023 Pa, -1524.0 meters. */
+    pressure = science_pressure_from_altitude_fixed_point(-1524 << 8,
+                                                          101325,
+                                                          8);
+    BTASSERT_IN_RANGE(pressure, 121023, 121024);
+
+    /* Too high altitude. */
+    BTASSERT(science_pressure_from_altitude_fixed_point(11000 << 8,
+                                                        101325,
+                                                        8) == -EINVAL);
+
+    return (0);
+}
+
+static int test_speed_fixed_point(void)
+{
+    /* Q16.16. */
+    BTASSERT(science_mps_to_kmph_fixed_point(1 << 16) == 235930);
+    BTASSERT(science_mps_from_kmph_fixed_point(235930) == 65536);
+    BTASSERT(science_mps_to_knots_fixed_point(1 << 16) == 127392);
+    BTASSERT(science_mps_from_knots_fixed_point(1 << 16) == 33715);
+    BTASSERT(science_mps_to_mph_fixed_point(1 << 16) == 146600);
+    BTASSERT(science_mps_from_mph_fixed_point(1 << 16) == 29297);
+
+    /* Integer speeds and negative speeds. */
+    BTASSERT(science_mps_to_kmph_fixed_point(10) == 36);
+    BTASSERT(science_mps_to_kmph_fixed_point(-10) == -36);
+    BTASSERT(science_mps_from_kmph_fixed_point(36) == 10);
+
+    return (0);
+}
+
 int main()
 {
     struct harness_testcase_t testcases[] = {
@@ -188,6 +279,15 @@ int main()
         { test_mps_from_knots, "test_mps_from_knots" },
         { test_mps_to_mph, "test_mps_to_mph" },
         { test_mps_from_mph, "test_mps_from_mph" },
+        {
+            test_pressure_to_altitude_fixed_point,
+            "test_pressure_to_altitude_fixed_point"
+        },
+        {
+            test_pressure_from_altitude_fixed_point,
+            "test_pressure_from_altitude_fixed_point"
+        },
+        { test_speed_fixed_point, "test_speed_fixed_point" },
         { NULL, NULL }
     };
 
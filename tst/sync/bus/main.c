@@ -30,6 +30,7 @@
 
 #define ID_FOO 0x0
 #define ID_BAR 0x1
+#define ID_FIE 0x2
 
 static int test_init(void)
 {
@@ -163,6 +164,111 @@ static int test_multiple_ids(void)
     return (0);
 }
 
+static int test_write_many(void)
+{
+    struct bus_t bus;
+    struct bus_listener_t chans[3];
+    struct queue_t queues[2];
+    char bufs[2][32];
+    struct bus_message_t messages[3];
+    int foo, bar, fie;
+    int value;
+
+    BTASSERT(bus_init(&bus) == 0);
+    BTASSERT(queue_init(&queues[0], bufs[0], sizeof(bufs[0])) == 0);
+    BTASSERT(queue_init(&queues[1], bufs[1], sizeof(bufs[1])) == 0);
+    BTASSERT(bus_listener_init(&chans[0], ID_FOO, &queues[0]) == 0);
+    BTASSERT(bus_listener_init(&chans[1], ID_FIE, &queues[1]) == 0);
+    BTASSERT(bus_listener_init(&chans[2], ID_FOO, &queues[1]) == 0);
+    BTASSERT(bus_attach(&bus, &chans[0]) == 0);
+    BTASSERT(bus_attach(&bus, &chans[1]) == 0);
+    BTASSERT(bus_attach(&bus, &chans[2]) == 0);
+
+    /* Write one message of each id. Bar has no listener. */
+    foo = 1;
+    bar = 2;
+    fie = 3;
+    messages[0].id = ID_FOO;
+    messages[0].buf_p = &foo;
+    messages[0].size = sizeof(foo);
+    messages[1].id = ID_BAR;
+    messages[1].buf_p = &bar;
+    messages[1].size = sizeof(bar);
+    messages[2].id = ID_FIE;
+    messages[2].buf_p = &fie;
+    messages[2].size = sizeof(fie);
+    BTASSERTI(bus_write_many(&bus, &messages[0], 3), ==, 3);
+
+    BTASSERT(queue_read(&queues[0], &value, sizeof(value)) == sizeof(value));
+    BTASSERTI(value, ==, 1);
+    BTASSERT(queue_read(&queues[1], &value, sizeof(value)) == sizeof(value));
+    BTASSERTI(value, ==, 1);
+    BTASSERT(queue_read(&queues[1], &value, sizeof(value)) == sizeof(value));
+    BTASSERTI(value, ==, 3);
+    BTASSERTI(queue_size(&queues[0]), ==, 0);
+    BTASSERTI(queue_size(&queues[1]), ==, 0);
+
+    BTASSERT(bus_detach(&bus, &chans[0]) == 0);
+    BTASSERT(bus_detach(&bus, &chans[1]) == 0);
+    BTASSERT(bus_detach(&bus, &chans[2]) == 0);
+    BTASSERT(bus_detach(&bus, &chans[2]) == -1);
+
+    return (0);
+}
+
+static int test_write_shared(void)
+{
+    struct bus_t bus;
+    struct bus_listener_t chans[2];
+    struct queue_t queues[2];
+    char bufs[2][32];
+    struct heap_t heap;
+    char heap_buffer[256];
+    size_t sizes[8] = { 16, 32, 64, 128, 256, 512, 512, 512 };
+    int *foo_p;
+    int *value_p;
+
+    BTASSERT(heap_init(&heap, heap_buffer, sizeof(heap_buffer), sizes) == 0);
+    BTASSERT(bus_init(&bus) == 0);
+    BTASSERT(queue_init(&queues[0], bufs[0], sizeof(bufs[0])) == 0);
+    BTASSERT(queue_init(&queues[1], bufs[1], sizeof(bufs[1])) == 0);
+    BTASSERT(bus_listener_init(&chans[0], ID_FOO, &queues[0]) == 0);
+    BTASSERT(bus_listener_init(&chans[1], ID_FOO, &queues[1]) == 0);
+
+    foo_p = heap_alloc(&heap, sizeof(*foo_p));
+    BTASSERT(foo_p != NULL);
+    *foo_p = 7;
+
+    /* No listeners. */
+    BTASSERTI(bus_write_shared(&bus, ID_FOO, &heap, foo_p), ==, 0);
+
+    /* Both listeners get a reference to the same buffer. */
+    BTASSERT(bus_attach(&bus, &chans[0]) == 0);
+    BTASSERT(bus_attach(&bus, &chans[1]) == 0);
+    BTASSERTI(bus_write_shared(&bus, ID_FOO, &heap, foo_p), ==, 2);
+
+    BTASSERT(queue_read(&queues[0],
+                        &value_p,
+                        sizeof(value_p)) == sizeof(value_p));
+    BTASSERT(value_p == foo_p);
+    BTASSERTI(*value_p, ==, 7);
+    BTASSERTI(heap_free(&heap, value_p), ==, 2);
+
+    BTASSERT(queue_read(&queues[1],
+                        &value_p,
+                        sizeof(value_p)) == sizeof(value_p));
+    BTASSERT(value_p == foo_p);
+    BTASSERTI(heap_free(&heap, value_p), ==, 1);
+
+    /* The writer reference. */
+    BTASSERTI(heap_free(&heap, foo_p), ==, 0);
+
+    BTASSERT(bus_detach(&bus, &chans[0]) == 0);
+    BTASSERT(bus_detach(&bus, &chans[1]) == 0);
+
+    return (0);
+}
+
 int main()
 {
     struct harness_testcase_t testcases[] = {
@@ -170,6 +276,8 @@ int main()
         { test_attach_detach, "test_attach_detach" },
         { test_write_read, "test_write_read" },
         { test_multiple_ids, "test_multiple_ids" },
+        { test_write_many, "test_write_many" },
+        { test_write_shared, "test_write_shared" },
         { NULL, NULL }
     };
 
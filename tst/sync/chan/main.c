@@ -130,6 +130,99 @@ static int test_filter(void)
     return (0);
 }
 
+static ssize_t writev_cb(void *self_p,
+                         const struct iov_t *iov_p,
+                         size_t length)
+{
+    size_t i;
+    size_t size;
+
+    size = 0;
+
+    for (i = 0; i < length; i++) {
+        memcpy(&buffer[size], iov_p[i].buf_p, iov_p[i].size);
+        size += iov_p[i].size;
+    }
+
+    return (size);
+}
+
+static int test_writev(void)
+{
+    struct chan_t chan;
+    struct iov_t iov[3];
+    ssize_t res;
+
+    BTASSERT(chan_init(&chan,
+                       chan_read_null,
+                       write_mock,
+                       chan_size_null) == 0);
+
+    iov[0].buf_p = "ab";
+    iov[0].size = 2;
+    iov[1].buf_p = NULL;
+    iov[1].size = 0;
+    iov[2].buf_p = "cde";
+    iov[2].size = 3;
+
+    /* Generic implementation writing one element at a time, skipping
+       empty elements. */
+    res = 2;
+    harness_mock_write("write_mock(): return (res)", &res, sizeof(res));
+    res = 3;
+    harness_mock_write("write_mock(): return (res)", &res, sizeof(res));
+    BTASSERTI(chan_writev(&chan, &iov[0], 3), ==, 5);
+    BTASSERT(harness_mock_assert("write_mock(buf_p)", "ab", 2) == 0);
+    BTASSERT(harness_mock_assert("write_mock(buf_p)", "cde", 3) == 0);
+
+    /* Short write stops the iteration. */
+    res = 1;
+    harness_mock_write("write_mock(): return (res)", &res, sizeof(res));
+    BTASSERTI(chan_writev(&chan, &iov[0], 3), ==, 1);
+    BTASSERT(harness_mock_assert("write_mock(buf_p)", "ab", 2) == 0);
+
+    /* Errors are returned as is. */
+    res = -EIO;
+    harness_mock_write("write_mock(): return (res)", &res, sizeof(res));
+    BTASSERTI(chan_writev(&chan, &iov[0], 3), ==, -EIO);
+    BTASSERT(harness_mock_assert("write_mock(buf_p)", "ab", 2) == 0);
+
+#if CONFIG_CHAN_WRITEV == 1
+    /* Native implementation. */
+    BTASSERT(chan_set_writev_cb(&chan, writev_cb) == 0);
+    memset(buffer, -1, sizeof(buffer));
+    BTASSERTI(chan_writev(&chan, &iov[0], 3), ==, 5);
+    BTASSERTM(&buffer[0], "abcde", 5);
+
+    /* The write filter is not vectored, so the generic
+       implementation is used. */
+    BTASSERT(chan_set_write_filter_cb(&chan, write_filter) == 0);
+    write_filter_return_value = 0;
+    res = 2;
+    harness_mock_write("write_mock(): return (res)", &res, sizeof(res));
+    res = 3;
+    harness_mock_write("write_mock(): return (res)", &res, sizeof(res));
+    BTASSERTI(chan_writev(&chan, &iov[0], 3), ==, 5);
+    BTASSERT(harness_mock_assert("write_mock(buf_p)", "ab", 2) == 0);
+    BTASSERT(harness_mock_assert("write_mock(buf_p)", "cde", 3) == 0);
+    BTASSERT(chan_set_write_filter_cb(&chan, NULL) == 0);
+
+    /* Setting the write callback removes the native
+       implementation. */
+    BTASSERT(chan_set_write_cb(&chan, write_mock) == 0);
+    res = 5;
+    harness_mock_write("write_mock(): return (res)", &res, sizeof(res));
+    iov[0].buf_p = "abcde";
+    iov[0].size = 5;
+    BTASSERTI(chan_writev(&chan, &iov[0], 1), ==, 5);
+    BTASSERT(harness_mock_assert("write_mock(buf_p)", "abcde", 5) == 0);
+#else
+    BTASSERT(chan_set_writev_cb(&chan, writev_cb) == -ENOSYS);
+#endif
+
+    return (0);
+}
+
 static int test_null_channels(void)
 {
     struct chan_t chan;
@@ -275,14 +368,30 @@ static int test_putc(void)
     return (0);
 }
 
+static int test_pollset(void)
+{
+    struct chan_pollset_t pollset;
+    struct queue_t queue;
+    char buf[8];
+
+    /* Poll sets are disabled by default. */
+    BTASSERT(queue_init(&queue, &buf[0], sizeof(buf)) == 0);
+    BTASSERT(chan_pollset_init(&pollset) == 0);
+    BTASSERTI(chan_pollset_add(&pollset, &queue), ==, -ENOSYS);
+
+    return (0);
+}
+
 int main()
 {
     struct harness_testcase_t testcases[] = {
         { test_filter, "test_filter" },
+        { test_writev, "test_writev" },
         { test_null_channels, "test_null_channels" },
         { test_list, "test_list" },
         { test_getc, "test_getc" },
         { test_putc, "test_putc" },
+        { test_pollset, "test_pollset" },
         { NULL, NULL }
     };
 
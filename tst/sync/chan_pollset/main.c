@@ -0,0 +1,135 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2014-2018, Erik Moqvist
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use, copy,
+ * modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ * This file is part of the Simba project.
+ */
+
+
+#include "simba.h"
+
+static struct queue_t pollset_queues[3];
+static char pollset_buffers[3][8];
+static THRD_STACK(pollset_writer_stack, 1024);
+
+static void *pollset_writer_main(void *arg_p)
+{
+    thrd_sleep_ms(20);
+    BTASSERTN(queue_write(&pollset_queues[2], "c", 1) == 1);
+    thrd_suspend(NULL);
+
+    return (NULL);
+}
+
+static int test_pollset(void)
+{
+    struct chan_pollset_t pollset;
+    struct time_t timeout;
+    void *chans[3];
+    char value[2];
+    int i;
+
+    timeout.seconds = 0;
+    timeout.nanoseconds = 10000000;
+
+    for (i = 0; i < 3; i++) {
+        BTASSERT(queue_init(&pollset_queues[i],
+                            &pollset_buffers[i][0],
+                            sizeof(pollset_buffers[i])) == 0);
+    }
+
+    BTASSERT(chan_pollset_init(&pollset) == 0);
+
+    /* Data written before the channel was added is reported. */
+    BTASSERTI(queue_write(&pollset_queues[1], "b", 1), ==, 1);
+
+    for (i = 0; i < 3; i++) {
+        BTASSERTI(chan_pollset_add(&pollset, &pollset_queues[i]), ==, 0);
+    }
+
+    BTASSERTI(chan_pollset_add(&pollset, &pollset_queues[0]), ==, -EBUSY);
+
+    /* Two ready channels, reported in write order. */
+    BTASSERTI(queue_write(&pollset_queues[0], "aa", 2), ==, 2);
+    BTASSERTI(chan_pollset_wait(&pollset, &chans[0], 3, NULL), ==, 2);
+    BTASSERT(chans[0] == &pollset_queues[1]);
+    BTASSERT(chans[1] == &pollset_queues[0]);
+
+    /* A channel with data left is reported again. */
+    BTASSERTI(queue_read(&pollset_queues[1], &value[0], 1), ==, 1);
+    BTASSERTI(queue_read(&pollset_queues[0], &value[0], 1), ==, 1);
+    BTASSERTI(chan_pollset_wait(&pollset, &chans[0], 3, NULL), ==, 1);
+    BTASSERT(chans[0] == &pollset_queues[0]);
+    BTASSERTI(queue_read(&pollset_queues[0], &value[0], 1), ==, 1);
+
+    /* No data. */
+    BTASSERTI(chan_pollset_wait(&pollset, &chans[0], 3, &timeout),
+              ==,
+              -ETIMEDOUT);
+
+    /* Wait for another thread to write. */
+    BTASSERT(thrd_spawn(pollset_writer_main,
+                        NULL,
+                        0,
+                        pollset_writer_stack,
+                        sizeof(pollset_writer_stack)) != NULL);
+    BTASSERTI(chan_pollset_wait(&pollset, &chans[0], 3, NULL), ==, 1);
+    BTASSERT(chans[0] == &pollset_queues[2]);
+    BTASSERTI(queue_read(&pollset_queues[2], &value[0], 1), ==, 1);
+    BTASSERTI(value[0], ==, 'c');
+
+    /* Only length channels are returned at a time. */
+    BTASSERTI(queue_write(&pollset_queues[0], "a", 1), ==, 1);
+    BTASSERTI(queue_write(&pollset_queues[1], "b", 1), ==, 1);
+    BTASSERTI(chan_pollset_wait(&pollset, &chans[0], 1, NULL), ==, 1);
+    BTASSERT(chans[0] == &pollset_queues[0]);
+    BTASSERTI(queue_read(&pollset_queues[0], &value[0], 1), ==, 1);
+
+    /* A removed channel is not reported. */
+    BTASSERTI(chan_pollset_remove(&pollset, &pollset_queues[1]), ==, 0);
+    BTASSERTI(chan_pollset_remove(&pollset, &pollset_queues[1]), ==, -1);
+    BTASSERTI(chan_pollset_wait(&pollset, &chans[0], 3, &timeout),
+              ==,
+              -ETIMEDOUT);
+
+    for (i = 0; i < 3; i += 2) {
+        BTASSERTI(chan_pollset_remove(&pollset, &pollset_queues[i]), ==, 0);
+    }
+
+    return (0);
+}
+
+int main()
+{
+    struct harness_testcase_t testcases[] = {
+        { test_pollset, "test_pollset" },
+        { NULL, NULL }
+    };
+
+    sys_start();
+
+    harness_run(testcases);
+
+    return (0);
+}
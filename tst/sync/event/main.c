@@ -36,10 +36,18 @@
 static struct event_t tester_event_tx;
 static struct event_t tester_event_rx;
 
+static struct event_t waiters_event;
+static struct sem_t waiters_sem;
+static uint32_t waiter_masks[2];
+
 #if defined(ARCH_ARM64)
 static THRD_STACK(tester_stack, 1024);
+static THRD_STACK(waiter_0_stack, 1024);
+static THRD_STACK(waiter_1_stack, 1024);
 #else
 static THRD_STACK(tester_stack, 512);
+static THRD_STACK(waiter_0_stack, 512);
+static THRD_STACK(waiter_1_stack, 512);
 #endif
 
 static void *tester_main(void *arg_p)
@@ -73,6 +81,34 @@ static void *tester_main(void *arg_p)
     return (0);
 }
 
+static void *waiter_0_main(void *arg_p)
+{
+    /* Wait for any of the two events. */
+    waiter_masks[0] = (EVENT_BIT_2 | EVENT_BIT_3);
+    BTASSERTN(event_wait(&waiters_event,
+                         &waiter_masks[0],
+                         0,
+                         NULL) == 0);
+    sem_give(&waiters_sem, 1);
+    thrd_suspend(NULL);
+
+    return (NULL);
+}
+
+static void *waiter_1_main(void *arg_p)
+{
+    /* Wait for both events and clear them. */
+    waiter_masks[1] = (EVENT_BIT_2 | EVENT_BIT_3);
+    BTASSERTN(event_wait(&waiters_event,
+                         &waiter_masks[1],
+                         EVENT_WAIT_ALL | EVENT_WAIT_CLEAR,
+                         NULL) == 0);
+    sem_give(&waiters_sem, 1);
+    thrd_suspend(NULL);
+
+    return (NULL);
+}
+
 static int test_init(void)
 {
     BTASSERT(event_init(&tester_event_rx) == 0);
@@ -330,6 +366,80 @@ static int test_try_read(void)
     return (0);
 }
 
+static int test_wait(void)
+{
+    struct event_t event;
+    struct time_t timeout;
+    uint32_t mask;
+
+    timeout.seconds = 0;
+    timeout.nanoseconds = 10000000;
+
+    BTASSERT(event_init(&event) == 0);
+
+    mask = (EVENT_BIT_0 | EVENT_BIT_1);
+    BTASSERT(event_write(&event, &mask, sizeof(mask)) == 4);
+
+    /* Already set events, not cleared. */
+    mask = (EVENT_BIT_0 | EVENT_BIT_2);
+    BTASSERTI(event_wait(&event, &mask, 0, NULL), ==, 0);
+    BTASSERTI(mask, ==, EVENT_BIT_0);
+
+    /* Already set events, cleared. */
+    mask = EVENT_BIT_0;
+    BTASSERTI(event_wait(&event, &mask, EVENT_WAIT_CLEAR, NULL), ==, 0);
+    BTASSERTI(mask, ==, EVENT_BIT_0);
+
+    /* Only one of two events is set. */
+    mask = (EVENT_BIT_0 | EVENT_BIT_1);
+    BTASSERTI(event_wait(&event, &mask, EVENT_WAIT_ALL, &timeout),
+              ==,
+              -ETIMEDOUT);
+    BTASSERTI(mask, ==, EVENT_BIT_1);
+
+    mask = (EVENT_BIT_1 | EVENT_BIT_2);
+    BTASSERTI(event_wait(&event, &mask, 0, &timeout), ==, 0);
+    BTASSERTI(mask, ==, EVENT_BIT_1);
+
+    return (0);
+}
+
+static int test_wait_multiple(void)
+{
+    uint32_t mask;
+
+    BTASSERT(event_init(&waiters_event) == 0);
+    BTASSERT(sem_init(&waiters_sem, 2, 2) == 0);
+
+    BTASSERT(thrd_spawn(waiter_0_main,
+                        NULL,
+                        0,
+                        waiter_0_stack,
+                        sizeof(waiter_0_stack)) != NULL);
+    BTASSERT(thrd_spawn(waiter_1_main,
+                        NULL,
+                        0,
+                        waiter_1_stack,
+                        sizeof(waiter_1_stack)) != NULL);
+    thrd_sleep_ms(10);
+
+    /* Only the any waiter is resumed. */
+    mask = EVENT_BIT_2;
+    BTASSERT(event_write(&waiters_event, &mask, sizeof(mask)) == 4);
+    BTASSERT(sem_take(&waiters_sem, NULL) == 0);
+    BTASSERTI(waiter_masks[0], ==, EVENT_BIT_2);
+    BTASSERTI(waiters_event.mask, ==, EVENT_BIT_2);
+
+    /* The all waiter is resumed and clears both events. */
+    mask = EVENT_BIT_3;
+    BTASSERT(event_write(&waiters_event, &mask, sizeof(mask)) == 4);
+    BTASSERT(sem_take(&waiters_sem, NULL) == 0);
+    BTASSERTI(waiter_masks[1], ==, EVENT_BIT_2 | EVENT_BIT_3);
+    BTASSERTI(event_size(&waiters_event), ==, 0);
+
+    return (0);
+}
+
 int main()
 {
     struct harness_testcase_t testcases[] = {
@@ -342,6 +452,8 @@ int main()
         { test_write_not_read_mask, "test_write_not_read_mask" },
         { test_clear, "test_clear" },
         { test_try_read, "test_try_read" },
+        { test_wait, "test_wait" },
+        { test_wait_multiple, "test_wait_multiple" },
         { NULL, NULL }
     };
 
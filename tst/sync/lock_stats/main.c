@@ -0,0 +1,154 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2014-2018, Erik Moqvist
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use, copy,
+ * modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ * This file is part of the Simba project.
+ */
+
+#include "simba.h"
+
+static THRD_STACK(holder_stack, 1024);
+static struct mutex_t mutex;
+static struct sem_t sem;
+
+static void *holder_main(void *arg_p)
+{
+    thrd_set_name("holder");
+
+    /* Hold the mutex for a while with the main thread waiting. */
+    mutex_lock(&mutex);
+    sem_give(&sem, 1);
+    thrd_sleep_ms(20);
+    mutex_unlock(&mutex);
+
+    thrd_suspend(NULL);
+
+    return (NULL);
+}
+
+static int test_init(void)
+{
+    BTASSERT(lock_stats_module_init() == 0);
+    BTASSERT(lock_stats_module_init() == 0);
+
+    return (0);
+}
+
+static int test_mutex(void)
+{
+    BTASSERT(mutex_init(&mutex) == 0);
+    BTASSERTI(mutex.stats.count, ==, 0);
+    BTASSERT(lock_stats_register(&mutex.stats, "mutex") == 0);
+
+    /* Uncontended. */
+    BTASSERT(mutex_lock(&mutex) == 0);
+    thrd_sleep_ms(10);
+    BTASSERT(mutex_unlock(&mutex) == 0);
+    BTASSERTI(mutex.stats.count, ==, 1);
+    BTASSERTI(mutex.stats.holders, ==, 0);
+    BTASSERTI(mutex.stats.max_hold_time, >=, 9000);
+    BTASSERTI(mutex.stats.max_wait_time, <, 9000);
+
+    /* Contended. */
+    BTASSERT(sem_init(&sem, 1, 1) == 0);
+    BTASSERT(thrd_spawn(holder_main,
+                        NULL,
+                        0,
+                        holder_stack,
+                        sizeof(holder_stack)) != NULL);
+    BTASSERT(sem_take(&sem, NULL) == 0);
+    BTASSERT(mutex_lock(&mutex) == 0);
+    BTASSERT(mutex_unlock(&mutex) == 0);
+    BTASSERTI(mutex.stats.count, ==, 3);
+    BTASSERTI(mutex.stats.holders, ==, 0);
+    BTASSERTI(mutex.stats.max_wait_time, >=, 15000);
+    BTASSERTI(mutex.stats.max_hold_time, >=, 15000);
+    BTASSERT(mutex.stats.hold_time >= mutex.stats.max_hold_time);
+
+    return (0);
+}
+
+static int test_rwlock(void)
+{
+    struct rwlock_t rwlock;
+
+    BTASSERT(rwlock_init(&rwlock) == 0);
+
+    /* The lock is held from the first reader takes it until the last
+       reader gives it. */
+    BTASSERT(rwlock_reader_take(&rwlock) == 0);
+    BTASSERT(rwlock_reader_take(&rwlock) == 0);
+    BTASSERTI(rwlock.stats.holders, ==, 2);
+    BTASSERT(rwlock_reader_give(&rwlock) == 0);
+    thrd_sleep_ms(10);
+    BTASSERTI(rwlock.stats.hold_time, ==, 0);
+    BTASSERT(rwlock_reader_give(&rwlock) == 0);
+    BTASSERTI(rwlock.stats.max_hold_time, >=, 9000);
+
+    BTASSERT(rwlock_writer_take(&rwlock) == 0);
+    BTASSERT(rwlock_writer_give(&rwlock) == 0);
+    BTASSERTI(rwlock.stats.count, ==, 3);
+    BTASSERTI(rwlock.stats.holders, ==, 0);
+
+    return (0);
+}
+
+static int test_fs(void)
+{
+    char command[64];
+    struct queue_t out;
+    char buf[1024];
+
+    BTASSERT(queue_init(&out, &buf[0], sizeof(buf)) == 0);
+
+    strcpy(command, "/sync/locks/list");
+    BTASSERT(fs_call(command, NULL, &out, NULL) == 0);
+    BTASSERTI(harness_expect(&out, "NAME       COUNT", NULL), >, 0);
+    BTASSERTI(harness_expect(&out, "mutex           3", NULL), >, 0);
+    BTASSERTI(harness_expect(&out, "sys", NULL), >, 0);
+
+    strcpy(command, "/sync/locks/reset");
+    BTASSERT(fs_call(command, NULL, &out, NULL) == 0);
+    BTASSERTI(mutex.stats.count, ==, 0);
+    BTASSERTI(mutex.stats.max_hold_time, ==, 0);
+
+    return (0);
+}
+
+int main()
+{
+    struct harness_testcase_t testcases[] = {
+        { test_init, "test_init" },
+        { test_mutex, "test_mutex" },
+        { test_rwlock, "test_rwlock" },
+        { test_fs, "test_fs" },
+        { NULL, NULL }
+    };
+
+    sys_start();
+
+    harness_run(testcases);
+
+    return (0);
+}
@@ -0,0 +1,217 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2014-2018, Erik Moqvist
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use, copy,
+ * modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ * This file is part of the Simba project.
+ */
+
+#include "simba.h"
+
+static struct mailbox_slot_t echo_rx_slots[4];
+static struct mailbox_t echo_rx;
+static struct mailbox_slot_t echo_tx_slots[1];
+static struct mailbox_t echo_tx;
+
+#if defined(ARCH_ARM64)
+static THRD_STACK(echo_stack, 1024);
+#else
+static THRD_STACK(echo_stack, 512);
+#endif
+
+static int messages[4];
+
+static void *echo_main(void *arg_p)
+{
+    void *message_p;
+
+    while (1) {
+        BTASSERTN(mailbox_receive(&echo_rx, &message_p, NULL) == 0);
+        BTASSERTN(mailbox_send(&echo_tx, message_p, 0, NULL) == 0);
+    }
+
+    return (NULL);
+}
+
+static int test_init(void)
+{
+    BTASSERT(mailbox_init(&echo_rx,
+                          &echo_rx_slots[0],
+                          membersof(echo_rx_slots)) == 0);
+    BTASSERT(mailbox_init(&echo_tx,
+                          &echo_tx_slots[0],
+                          membersof(echo_tx_slots)) == 0);
+
+    BTASSERT(thrd_spawn(echo_main,
+                        NULL,
+                        1,
+                        echo_stack,
+                        sizeof(echo_stack)) != NULL);
+
+    return (0);
+}
+
+static int test_priority(void)
+{
+    struct mailbox_slot_t slots[4];
+    struct mailbox_t mailbox;
+    void *message_p;
+
+    BTASSERT(mailbox_init(&mailbox, &slots[0], membersof(slots)) == 0);
+    BTASSERTI(mailbox_size(&mailbox), ==, 0);
+
+    /* Higher priority first, and in send order within a
+       priority. */
+    BTASSERT(mailbox_send(&mailbox, &messages[0], 0, NULL) == 0);
+    BTASSERT(mailbox_send(&mailbox, &messages[1], 5, NULL) == 0);
+    BTASSERT(mailbox_send(&mailbox, &messages[2], -1, NULL) == 0);
+    BTASSERT(mailbox_send(&mailbox, &messages[3], 0, NULL) == 0);
+    BTASSERTI(mailbox_size(&mailbox), ==, 4);
+
+    /* Full. */
+    sys_lock();
+    BTASSERTI(mailbox_send_isr(&mailbox, &messages[0], 0), ==, -EAGAIN);
+    sys_unlock();
+
+    BTASSERT(mailbox_receive(&mailbox, &message_p, NULL) == 0);
+    BTASSERT(message_p == &messages[2]);
+    BTASSERT(mailbox_receive(&mailbox, &message_p, NULL) == 0);
+    BTASSERT(message_p == &messages[0]);
+
+    /* Wrap around the end of the slots. */
+    BTASSERT(mailbox_send(&mailbox, &messages[2], 5, NULL) == 0);
+    BTASSERT(mailbox_send(&mailbox, &messages[0], -3, NULL) == 0);
+
+    BTASSERT(mailbox_receive(&mailbox, &message_p, NULL) == 0);
+    BTASSERT(message_p == &messages[0]);
+    BTASSERT(mailbox_receive(&mailbox, &message_p, NULL) == 0);
+    BTASSERT(message_p == &messages[3]);
+    BTASSERT(mailbox_receive(&mailbox, &message_p, NULL) == 0);
+    BTASSERT(message_p == &messages[1]);
+
+    sys_lock();
+    BTASSERTI(mailbox_receive_isr(&mailbox, &message_p), ==, 0);
+    BTASSERT(message_p == &messages[2]);
+    BTASSERTI(mailbox_receive_isr(&mailbox, &message_p), ==, -EAGAIN);
+    sys_unlock();
+
+    return (0);
+}
+
+static int test_timeout(void)
+{
+    struct mailbox_slot_t slots[1];
+    struct mailbox_t mailbox;
+    void *message_p;
+    struct time_t timeout;
+
+    timeout.seconds = 0;
+    timeout.nanoseconds = 10000000;
+
+    BTASSERT(mailbox_init(&mailbox, &slots[0], membersof(slots)) == 0);
+
+    /* Empty. */
+    BTASSERTI(mailbox_receive(&mailbox, &message_p, &timeout),
+              ==,
+              -ETIMEDOUT);
+
+    /* Full. */
+    BTASSERT(mailbox_send(&mailbox, &messages[0], 0, &timeout) == 0);
+    BTASSERTI(mailbox_send(&mailbox, &messages[1], 0, &timeout),
+              ==,
+              -ETIMEDOUT);
+
+    BTASSERT(mailbox_receive(&mailbox, &message_p, &timeout) == 0);
+    BTASSERT(message_p == &messages[0]);
+    BTASSERTI(mailbox_size(&mailbox), ==, 0);
+
+    return (0);
+}
+
+static int test_threads(void)
+{
+    int i;
+    void *message_p;
+
+    /* The echo thread waits for a free slot in the echo tx mailbox
+       after the first message. */
+    for (i = 0; i < 3; i++) {
+        BTASSERT(mailbox_send(&echo_rx, &messages[i], 0, NULL) == 0);
+    }
+
+    thrd_sleep_ms(10);
+    BTASSERTI(mailbox_size(&echo_tx), ==, 1);
+
+    for (i = 0; i < 3; i++) {
+        BTASSERT(mailbox_receive(&echo_tx, &message_p, NULL) == 0);
+        BTASSERT(message_p == &messages[i]);
+    }
+
+    BTASSERTI(mailbox_size(&echo_rx), ==, 0);
+
+    return (0);
+}
+
+static int test_chan(void)
+{
+    void *message_p;
+    struct time_t timeout;
+
+    timeout.seconds = 0;
+    timeout.nanoseconds = 10000000;
+
+    BTASSERT(chan_poll(&echo_tx, &timeout) == NULL);
+
+    message_p = &messages[3];
+    BTASSERTI(chan_write(&echo_rx, &message_p, sizeof(message_p)),
+              ==,
+              sizeof(message_p));
+    BTASSERT(chan_poll(&echo_tx, NULL) == &echo_tx);
+    BTASSERTI(chan_size(&echo_tx), ==, 1);
+
+    message_p = NULL;
+    BTASSERTI(chan_read(&echo_tx, &message_p, sizeof(message_p)),
+              ==,
+              sizeof(message_p));
+    BTASSERT(message_p == &messages[3]);
+
+    return (0);
+}
+
+int main()
+{
+    struct harness_testcase_t testcases[] = {
+        { test_init, "test_init" },
+        { test_priority, "test_priority" },
+        { test_timeout, "test_timeout" },
+        { test_threads, "test_threads" },
+        { test_chan, "test_chan" },
+        { NULL, NULL }
+    };
+
+    sys_start();
+
+    harness_run(testcases);
+
+    return (0);
+}
@@ -110,10 +110,19 @@ static int test_multi_thread(void)
     return (0);
 }
 
+static int test_prio_ceiling(void)
+{
+    /* Priority ceiling requires priority inheritance. */
+    BTASSERT(mutex_set_prio_ceiling(&mutex, 0) == -ENOSYS);
+
+    return (0);
+}
+
 int main()
 {
     struct harness_testcase_t testcases[] = {
         { test_multi_thread, "test_multi_thread" },
+        { test_prio_ceiling, "test_prio_ceiling" },
         { NULL, NULL }
     };
 
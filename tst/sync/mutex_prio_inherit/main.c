@@ -0,0 +1,388 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2017-2018, Erik Moqvist
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use, copy,
+ * modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ * This file is part of the Simba project.
+ */
+
+#include "simba.h"
+
+#define ITERATIONS 100
+
+static struct mutex_t mutex;
+static int global_counter = 0;
+static int t0_counter = 0;
+static int t1_counter = 0;
+static int is_locked = 0;
+
+#if defined(ARCH_ESP32) || defined(ARCH_PPC)
+static THRD_STACK(t0_stack, 512);
+static THRD_STACK(t1_stack, 512);
+#elif defined(ARCH_ARM64) || defined(ARCH_MIPS)
+static THRD_STACK(t0_stack, 1024);
+static THRD_STACK(t1_stack, 1024);
+#else
+static THRD_STACK(t0_stack, 224);
+static THRD_STACK(t1_stack, 224);
+#endif
+
+#if defined(ARCH_ESP32) || defined(ARCH_PPC)
+static THRD_STACK(low_stack, 512);
+static THRD_STACK(medium_stack, 512);
+#elif defined(ARCH_ARM64) || defined(ARCH_MIPS)
+static THRD_STACK(low_stack, 1024);
+static THRD_STACK(medium_stack, 1024);
+#else
+static THRD_STACK(low_stack, 224);
+static THRD_STACK(medium_stack, 224);
+#endif
+
+#if defined(ARCH_ESP32) || defined(ARCH_PPC)
+static THRD_STACK(nested_stack, 512);
+static THRD_STACK(chain_low_stack, 512);
+static THRD_STACK(chain_medium_stack, 512);
+#elif defined(ARCH_ARM64) || defined(ARCH_MIPS)
+static THRD_STACK(nested_stack, 1024);
+static THRD_STACK(chain_low_stack, 1024);
+static THRD_STACK(chain_medium_stack, 1024);
+#else
+static THRD_STACK(nested_stack, 224);
+static THRD_STACK(chain_low_stack, 224);
+static THRD_STACK(chain_medium_stack, 224);
+#endif
+
+static struct mutex_t inherit_mutex;
+static struct mutex_t nested_mutexes[2];
+static int nested_prios[3];
+static struct mutex_t chain_mutexes[2];
+static int chain_prios[2];
+static struct thrd_t *main_thrd_p;
+static int low_prios[2];
+static char order[3];
+static int order_length;
+
+static void *low_main(void *arg_p)
+{
+    mutex_lock(&inherit_mutex);
+
+    /* Wait for the main thread to be ready to lock the mutex. */
+    thrd_resume(main_thrd_p, 0);
+    thrd_suspend(NULL);
+
+    low_prios[0] = thrd_get_prio();
+    order[order_length++] = 'l';
+    mutex_unlock(&inherit_mutex);
+    low_prios[1] = thrd_get_prio();
+
+    return (NULL);
+}
+
+static void *medium_main(void *arg_p)
+{
+    order[order_length++] = 'm';
+
+    return (NULL);
+}
+
+static void *nested_main(void *arg_p)
+{
+    mutex_lock(&nested_mutexes[0]);
+    mutex_lock(&nested_mutexes[1]);
+
+    /* Wait for the main thread to be ready to lock the first
+       mutex. */
+    thrd_resume(main_thrd_p, 0);
+    thrd_suspend(NULL);
+
+    /* The first mutex is still wanted by the main thread after the
+       second is unlocked. */
+    nested_prios[0] = thrd_get_prio();
+    mutex_unlock(&nested_mutexes[1]);
+    nested_prios[1] = thrd_get_prio();
+    mutex_unlock(&nested_mutexes[0]);
+    nested_prios[2] = thrd_get_prio();
+
+    return (NULL);
+}
+
+static void *chain_low_main(void *arg_p)
+{
+    mutex_lock(&chain_mutexes[0]);
+
+    /* Wait for the other threads to be blocked. */
+    thrd_resume(main_thrd_p, 0);
+    thrd_suspend(NULL);
+
+    chain_prios[0] = thrd_get_prio();
+    mutex_unlock(&chain_mutexes[0]);
+    chain_prios[1] = thrd_get_prio();
+
+    return (NULL);
+}
+
+static void *chain_medium_main(void *arg_p)
+{
+    mutex_lock(&chain_mutexes[1]);
+    thrd_resume(main_thrd_p, 0);
+
+    /* Blocks on the mutex held by the low priority thread. */
+    mutex_lock(&chain_mutexes[0]);
+    mutex_unlock(&chain_mutexes[0]);
+    mutex_unlock(&chain_mutexes[1]);
+
+    return (NULL);
+}
+
+static void *mutex_main(void *arg_p)
+{
+    int i;
+    int *counter_p;
+
+    counter_p = arg_p;
+
+    for (i = 0; i < ITERATIONS; i++) {
+        mutex_lock(&mutex);
+
+        if (is_locked == 1) {
+            (*counter_p) = ITERATIONS;
+            break;
+        }
+
+        is_locked = 1;
+        thrd_sleep_ms(1);
+        is_locked = 0;
+        global_counter++;
+        mutex_unlock(&mutex);
+        (*counter_p)++;
+    }
+
+    thrd_suspend(NULL);
+
+    return (NULL);
+}
+
+static int test_multi_thread(void)
+{
+    int done;
+
+    BTASSERT(mutex_module_init() == 0);
+    BTASSERT(mutex_module_init() == 0);
+    BTASSERT(mutex_init(&mutex) == 0);
+
+    thrd_spawn(mutex_main,
+               &t0_counter,
+               -10,
+               t0_stack,
+               sizeof(t0_stack));
+    thrd_spawn(mutex_main,
+               &t1_counter,
+               -10,
+               t1_stack,
+               sizeof(t1_stack));
+
+    done = 0;
+
+    while (done == 0) {
+        sys_lock();
+        done = ((t0_counter == ITERATIONS) && (t1_counter == ITERATIONS));
+        sys_unlock();
+        thrd_yield();
+    }
+
+    BTASSERTI(t0_counter, ==, ITERATIONS);
+    BTASSERTI(t1_counter, ==, ITERATIONS);
+    BTASSERTI(global_counter, ==, t0_counter + t1_counter);
+
+    return (0);
+}
+
+static int test_prio_inherit(void)
+{
+    int prio;
+    struct thrd_t *low_p;
+
+    BTASSERT(mutex_init(&inherit_mutex) == 0);
+    main_thrd_p = thrd_self();
+    prio = thrd_get_prio();
+    order_length = 0;
+
+    /* Let the low priority thread lock the mutex. */
+    low_p = thrd_spawn(low_main,
+                       NULL,
+                       prio + 20,
+                       low_stack,
+                       sizeof(low_stack));
+    BTASSERT(low_p != NULL);
+    BTASSERT(thrd_suspend(NULL) == 0);
+
+    /* The medium priority thread must not run before the low priority
+       thread unlocks the mutex. */
+    BTASSERT(thrd_spawn(medium_main,
+                        NULL,
+                        prio + 10,
+                        medium_stack,
+                        sizeof(medium_stack)) != NULL);
+    BTASSERT(thrd_resume(low_p, 0) == 0);
+    BTASSERT(mutex_lock(&inherit_mutex) == 0);
+
+    /* The low priority thread inherited the priority of this
+       thread. */
+    BTASSERTI(low_prios[0], ==, prio);
+    BTASSERTI(low_prios[1], ==, prio + 20);
+    BTASSERTI(order_length, ==, 1);
+    BTASSERTI(order[0], ==, 'l');
+    BTASSERT(mutex_unlock(&inherit_mutex) == 0);
+
+    BTASSERT(thrd_join(low_p) == 0);
+    thrd_sleep_ms(10);
+    BTASSERTI(order_length, ==, 2);
+    BTASSERTI(order[1], ==, 'm');
+    BTASSERTI(thrd_get_prio(), ==, prio);
+
+    return (0);
+}
+
+static int test_prio_ceiling(void)
+{
+    int prio;
+    struct mutex_t ceiling_mutex;
+
+    prio = thrd_get_prio();
+
+    BTASSERT(mutex_init(&ceiling_mutex) == 0);
+    BTASSERT(mutex_set_prio_ceiling(&ceiling_mutex, prio - 5) == 0);
+
+    BTASSERT(mutex_lock(&ceiling_mutex) == 0);
+    BTASSERTI(thrd_get_prio(), ==, prio - 5);
+    BTASSERT(mutex_unlock(&ceiling_mutex) == 0);
+    BTASSERTI(thrd_get_prio(), ==, prio);
+
+    /* A ceiling lower than the thread priority has no effect. */
+    BTASSERT(mutex_set_prio_ceiling(&ceiling_mutex, prio + 5) == 0);
+    BTASSERT(mutex_lock(&ceiling_mutex) == 0);
+    BTASSERTI(thrd_get_prio(), ==, prio);
+    BTASSERT(mutex_unlock(&ceiling_mutex) == 0);
+
+    return (0);
+}
+
+static int test_nested(void)
+{
+    int prio;
+    struct thrd_t *nested_p;
+
+    BTASSERT(mutex_init(&nested_mutexes[0]) == 0);
+    BTASSERT(mutex_init(&nested_mutexes[1]) == 0);
+    main_thrd_p = thrd_self();
+    prio = thrd_get_prio();
+
+    /* Let the low priority thread lock both mutexes. */
+    nested_p = thrd_spawn(nested_main,
+                          NULL,
+                          prio + 20,
+                          nested_stack,
+                          sizeof(nested_stack));
+    BTASSERT(nested_p != NULL);
+    BTASSERT(thrd_suspend(NULL) == 0);
+
+    BTASSERT(thrd_resume(nested_p, 0) == 0);
+    BTASSERT(mutex_lock(&nested_mutexes[0]) == 0);
+    BTASSERT(mutex_unlock(&nested_mutexes[0]) == 0);
+    BTASSERT(thrd_join(nested_p) == 0);
+
+    /* The inherited priority is kept until the mutex wanted by this
+       thread is unlocked. */
+    BTASSERTI(nested_prios[0], ==, prio);
+    BTASSERTI(nested_prios[1], ==, prio);
+    BTASSERTI(nested_prios[2], ==, prio + 20);
+    BTASSERTI(thrd_get_prio(), ==, prio);
+
+    return (0);
+}
+
+static int test_transitive(void)
+{
+    int prio;
+    struct thrd_t *low_p;
+    struct thrd_t *medium_p;
+
+    BTASSERT(mutex_init(&chain_mutexes[0]) == 0);
+    BTASSERT(mutex_init(&chain_mutexes[1]) == 0);
+    main_thrd_p = thrd_self();
+    prio = thrd_get_prio();
+
+    /* The low priority thread locks the first mutex. */
+    low_p = thrd_spawn(chain_low_main,
+                       NULL,
+                       prio + 20,
+                       chain_low_stack,
+                       sizeof(chain_low_stack));
+    BTASSERT(low_p != NULL);
+    BTASSERT(thrd_suspend(NULL) == 0);
+
+    /* The medium priority thread locks the second mutex and blocks
+       on the first. */
+    medium_p = thrd_spawn(chain_medium_main,
+                          NULL,
+                          prio + 10,
+                          chain_medium_stack,
+                          sizeof(chain_medium_stack));
+    BTASSERT(medium_p != NULL);
+    BTASSERT(thrd_suspend(NULL) == 0);
+    thrd_sleep_ms(10);
+    BTASSERTI(low_p->prio, ==, prio + 10);
+
+    /* Blocking on the second mutex raises the priority of both
+       threads. */
+    BTASSERT(thrd_resume(low_p, 0) == 0);
+    BTASSERT(mutex_lock(&chain_mutexes[1]) == 0);
+    BTASSERT(mutex_unlock(&chain_mutexes[1]) == 0);
+    BTASSERT(thrd_join(low_p) == 0);
+    BTASSERT(thrd_join(medium_p) == 0);
+
+    BTASSERTI(chain_prios[0], ==, prio);
+    BTASSERTI(chain_prios[1], ==, prio + 20);
+    BTASSERTI(medium_p->prio, ==, prio + 10);
+    BTASSERTI(thrd_get_prio(), ==, prio);
+
+    return (0);
+}
+
+int main()
+{
+    struct harness_testcase_t testcases[] = {
+        { test_multi_thread, "test_multi_thread" },
+        { test_prio_inherit, "test_prio_inherit" },
+        { test_prio_ceiling, "test_prio_ceiling" },
+        { test_nested, "test_nested" },
+        { test_transitive, "test_transitive" },
+        { NULL, NULL }
+    };
+
+    sys_start();
+
+    harness_run(testcases);
+
+    return (0);
+}
@@ -537,6 +537,65 @@ static int test_ignore(void)
     return (0);
 }
 
+static int test_peek_commit(void)
+{
+    struct queue_t foo;
+    char foobuf[8];
+    char buf[4];
+    void *buf_p;
+
+    BTASSERT(queue_init(&foo, &foobuf[0], sizeof(foobuf)) == 0);
+
+    /* Nothing to peek at in an empty queue. */
+    BTASSERTI(queue_peek_contiguous(&foo, &buf_p), ==, 0);
+
+    /* Write three bytes in place. */
+    BTASSERTI(queue_reserve_contiguous(&foo, &buf_p), ==, 7);
+    memcpy(buf_p, "abc", 3);
+    BTASSERTI(queue_commit(&foo, 3), ==, 3);
+    BTASSERTI(queue_size(&foo), ==, 3);
+
+    /* Parse them in place and release two. */
+    BTASSERTI(queue_peek_contiguous(&foo, &buf_p), ==, 3);
+    BTASSERTM(buf_p, "abc", 3);
+    BTASSERTI(queue_consume(&foo, 2), ==, 2);
+    BTASSERTI(queue_size(&foo), ==, 1);
+
+    /* Fill up to the end of the buffer. */
+    BTASSERTI(queue_reserve_contiguous(&foo, &buf_p), ==, 5);
+    memcpy(buf_p, "defgh", 5);
+    BTASSERTI(queue_commit(&foo, 5), ==, 5);
+
+    /* Wrap around. */
+    BTASSERTI(queue_reserve_contiguous(&foo, &buf_p), ==, 1);
+    memcpy(buf_p, "i", 1);
+    BTASSERTI(queue_commit(&foo, 1), ==, 1);
+    BTASSERTI(queue_peek_contiguous(&foo, &buf_p), ==, 6);
+    BTASSERTM(buf_p, "cdefgh", 6);
+    BTASSERTI(queue_consume(&foo, 6), ==, 6);
+
+    /* Mix with the copying read. */
+    BTASSERTI(queue_read(&foo, &buf[0], 1), ==, 1);
+    BTASSERTI(buf[0], ==, 'i');
+    BTASSERTI(queue_size(&foo), ==, 0);
+
+    /* Peek and consume from isr. */
+    BTASSERTI(queue_write(&foo, "jk", 2), ==, 2);
+    sys_lock();
+    BTASSERTI(queue_peek_contiguous_isr(&foo, &buf_p), ==, 2);
+    BTASSERTM(buf_p, "jk", 2);
+    BTASSERTI(queue_consume_isr(&foo, 2), ==, 2);
+    sys_unlock();
+    BTASSERTI(queue_size(&foo), ==, 0);
+
+    /* No writes to a stopped queue. */
+    BTASSERT(queue_stop(&foo) == 0);
+    BTASSERTI(queue_reserve_contiguous(&foo, &buf_p), ==, -1);
+    BTASSERTI(queue_commit(&foo, 1), ==, -1);
+
+    return (0);
+}
+
 static int test_read_write_zero(void)
 {
     int a[2];
@@ -548,6 +607,40 @@ static int test_read_write_zero(void)
     return (0);
 }
 
+static int test_writev(void)
+{
+    struct queue_t foo;
+    char foobuf[8];
+    struct iov_t iov[3];
+    char buf[8];
+
+    BTASSERT(queue_init(&foo, &foobuf[0], sizeof(foobuf)) == 0);
+
+    iov[0].buf_p = "ab";
+    iov[0].size = 2;
+    iov[1].buf_p = NULL;
+    iov[1].size = 0;
+    iov[2].buf_p = "cdef";
+    iov[2].size = 4;
+
+    /* All elements fits in the buffer. */
+    BTASSERTI(queue_writev(&foo, &iov[0], 3), ==, 6);
+    BTASSERTI(queue_size(&foo), ==, 6);
+    BTASSERTI(queue_read(&foo, &buf[0], 6), ==, 6);
+    BTASSERTM(&buf[0], "abcdef", 6);
+
+    /* Through the channel interface. */
+    BTASSERTI(chan_writev(&foo, &iov[0], 3), ==, 6);
+    BTASSERTI(queue_read(&foo, &buf[0], 6), ==, 6);
+    BTASSERTM(&buf[0], "abcdef", 6);
+
+    /* Empty vector. */
+    BTASSERTI(queue_writev(&foo, &iov[0], 0), ==, 0);
+    BTASSERTI(queue_size(&foo), ==, 0);
+
+    return (0);
+}
+
 int main()
 {
     struct harness_testcase_t testcases[] = {
@@ -561,7 +654,9 @@ int main()
         { test_nested_poll, "test_nested_poll" },
         { test_non_blocking, "test_non_blocking" },
         { test_ignore, "test_ignore" },
+        { test_peek_commit, "test_peek_commit" },
         { test_read_write_zero, "test_read_write_zero" },
+        { test_writev, "test_writev" },
         { NULL, NULL }
     };
 
@@ -0,0 +1,263 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2014-2018, Erik Moqvist
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use, copy,
+ * modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ * This file is part of the Simba project.
+ */
+
+#include "simba.h"
+
+static struct reactor_t reactor;
+static struct queue_t queue;
+static char queue_buf[16];
+static int chan_count;
+static int work_count;
+static int timer_count;
+
+static THRD_STACK(producer_stack, 1024);
+
+static void on_chan(void *arg_p)
+{
+    char c;
+
+    if (queue_read(arg_p, &c, sizeof(c)) == sizeof(c)) {
+        chan_count++;
+    }
+}
+
+static void on_work(void *arg_p)
+{
+    work_count++;
+}
+
+static void on_timer(void *arg_p)
+{
+    timer_count++;
+
+    if (arg_p != NULL) {
+        reactor_stop(arg_p);
+    }
+}
+
+static int test_init(void)
+{
+    BTASSERT(reactor_init(&reactor) == 0);
+    BTASSERT(queue_init(&queue, &queue_buf[0], sizeof(queue_buf)) == 0);
+
+    return (0);
+}
+
+static int test_chan(void)
+{
+    struct reactor_chan_t reactor_chan;
+    struct time_t timeout;
+
+    timeout.seconds = 0;
+    timeout.nanoseconds = 10000000;
+
+    BTASSERT(reactor_chan_init(&reactor_chan, &queue, on_chan, &queue) == 0);
+    BTASSERT(reactor_chan_add(&reactor, &reactor_chan) == 0);
+    BTASSERT(reactor_run_once(&reactor, &timeout) == -ETIMEDOUT);
+
+    /* The callback reads one byte at a time, and is called as long as
+       there is data. */
+    chan_count = 0;
+    BTASSERT(queue_write(&queue, "ab", 2) == 2);
+    BTASSERTI(reactor_run_once(&reactor, &timeout), ==, 1);
+    BTASSERTI(chan_count, ==, 1);
+    BTASSERTI(reactor_run_once(&reactor, &timeout), ==, 1);
+    BTASSERTI(chan_count, ==, 2);
+    BTASSERT(reactor_run_once(&reactor, &timeout) == -ETIMEDOUT);
+
+    /* Removed channels are not polled. */
+    BTASSERT(reactor_chan_remove(&reactor, &reactor_chan) == 0);
+    BTASSERT(reactor_chan_remove(&reactor, &reactor_chan) == -ENOENT);
+    BTASSERT(queue_write(&queue, "c", 1) == 1);
+    BTASSERT(reactor_run_once(&reactor, &timeout) == -ETIMEDOUT);
+    BTASSERTI(chan_count, ==, 2);
+
+    /* Data written before the channel is added. */
+    BTASSERT(reactor_chan_add(&reactor, &reactor_chan) == 0);
+    BTASSERTI(reactor_run_once(&reactor, &timeout), ==, 1);
+    BTASSERTI(chan_count, ==, 3);
+    BTASSERT(reactor_chan_remove(&reactor, &reactor_chan) == 0);
+
+    return (0);
+}
+
+static int test_work(void)
+{
+    struct reactor_work_t work;
+    struct time_t timeout;
+
+    timeout.seconds = 0;
+    timeout.nanoseconds = 10000000;
+
+    work_count = 0;
+    BTASSERT(reactor_work_init(&work, on_work, NULL) == 0);
+    BTASSERT(reactor_work_cancel(&work) == -ENOENT);
+
+    /* Submitted once. */
+    BTASSERT(reactor_work_submit(&reactor, &work) == 0);
+    BTASSERT(reactor_work_submit(&reactor, &work) == -EBUSY);
+    BTASSERTI(reactor_run_once(&reactor, &timeout), ==, 1);
+    BTASSERTI(work_count, ==, 1);
+    BTASSERT(reactor_run_once(&reactor, &timeout) == -ETIMEDOUT);
+
+    /* Cancelled before called. The loop is still woken up. */
+    BTASSERT(reactor_work_submit(&reactor, &work) == 0);
+    BTASSERT(reactor_work_cancel(&work) == 0);
+    BTASSERTI(reactor_run_once(&reactor, &timeout), ==, 0);
+    BTASSERTI(work_count, ==, 1);
+    BTASSERT(reactor_run_once(&reactor, &timeout) == -ETIMEDOUT);
+
+    return (0);
+}
+
+static int test_timer(void)
+{
+    struct reactor_timer_t timer;
+    struct time_t timeout;
+    struct time_t start;
+    struct time_t stop;
+    struct time_t elapsed;
+    int i;
+
+    timeout.seconds = 0;
+    timeout.nanoseconds = 50000000;
+
+    /* Single shot. */
+    timer_count = 0;
+    BTASSERT(reactor_timer_init(&timer,
+                                &reactor,
+                                &timeout,
+                                on_timer,
+                                NULL,
+                                0) == 0);
+    time_get(&start);
+    BTASSERT(reactor_timer_start(&timer) == 0);
+    BTASSERTI(reactor_run_once(&reactor, NULL), ==, 1);
+    time_get(&stop);
+    BTASSERTI(timer_count, ==, 1);
+    time_subtract(&elapsed, &stop, &start);
+    BTASSERT(elapsed.seconds == 0);
+    BTASSERTI(elapsed.nanoseconds, >=, 40000000);
+
+    /* Stopped before expiry. */
+    BTASSERT(reactor_timer_start(&timer) == 0);
+    BTASSERT(reactor_timer_stop(&timer) == 0);
+    timeout.nanoseconds = 100000000;
+    BTASSERT(reactor_run_once(&reactor, &timeout) == -ETIMEDOUT);
+    BTASSERTI(timer_count, ==, 1);
+
+    /* Periodic. */
+    timeout.nanoseconds = 10000000;
+    BTASSERT(reactor_timer_init(&timer,
+                                &reactor,
+                                &timeout,
+                                on_timer,
+                                NULL,
+                                TIMER_PERIODIC) == 0);
+    BTASSERT(reactor_timer_start(&timer) == 0);
+
+    for (i = 0; i < 3; i++) {
+        BTASSERTI(reactor_run_once(&reactor, NULL), ==, 1);
+    }
+
+    BTASSERT(reactor_timer_stop(&timer) == 0);
+    BTASSERTI(timer_count, ==, 4);
+
+    return (0);
+}
+
+static void *producer_main(void *arg_p)
+{
+    int i;
+
+    thrd_set_name("producer");
+
+    for (i = 0; i < 32; i++) {
+        BTASSERTN(queue_write(&queue, "x", 1) == 1);
+
+        if ((i % 4) == 0) {
+            thrd_yield();
+        }
+    }
+
+    thrd_suspend(NULL);
+
+    return (NULL);
+}
+
+static int test_run(void)
+{
+    struct reactor_chan_t reactor_chan;
+    struct reactor_timer_t timer;
+    struct time_t timeout;
+
+    /* Serve the producer thread until the timer stops the loop. */
+    chan_count = 0;
+    timer_count = 0;
+    timeout.seconds = 0;
+    timeout.nanoseconds = 200000000;
+
+    BTASSERT(reactor_chan_init(&reactor_chan, &queue, on_chan, &queue) == 0);
+    BTASSERT(reactor_chan_add(&reactor, &reactor_chan) == 0);
+    BTASSERT(reactor_timer_init(&timer,
+                                &reactor,
+                                &timeout,
+                                on_timer,
+                                &reactor,
+                                0) == 0);
+    BTASSERT(reactor_timer_start(&timer) == 0);
+    BTASSERT(thrd_spawn(producer_main,
+                        NULL,
+                        0,
+                        producer_stack,
+                        sizeof(producer_stack)) != NULL);
+    BTASSERT(reactor_run(&reactor) == 0);
+    BTASSERTI(timer_count, ==, 1);
+    BTASSERTI(chan_count, ==, 32);
+    BTASSERT(reactor_chan_remove(&reactor, &reactor_chan) == 0);
+
+    return (0);
+}
+
+int main()
+{
+    struct harness_testcase_t testcases[] = {
+        { test_init, "test_init" },
+        { test_chan, "test_chan" },
+        { test_work, "test_work" },
+        { test_timer, "test_timer" },
+        { test_run, "test_run" },
+        { NULL, NULL }
+    };
+
+    sys_start();
+
+    harness_run(testcases);
+
+    return (0);
+}
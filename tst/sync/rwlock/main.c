@@ -34,18 +34,45 @@ static THRD_STACK(writer_1_stack, 1024);
 static THRD_STACK(writer_2_stack, 1024);
 static THRD_STACK(reader_0_stack, 1024);
 static THRD_STACK(reader_1_stack, 1024);
+static THRD_STACK(order_stacks[11], 1024);
 #else
 static THRD_STACK(writer_0_stack, 512);
 static THRD_STACK(writer_1_stack, 512);
 static THRD_STACK(writer_2_stack, 512);
 static THRD_STACK(reader_0_stack, 512);
 static THRD_STACK(reader_1_stack, 512);
+static THRD_STACK(order_stacks[11], 512);
 #endif
 
-
 static volatile int count;
 struct rwlock_t count_lock;
 
+/* Order in which the lock was taken by the order threads. Each
+   order thread has its own stack, as a stack cannot be reused after
+   the thread terminated on all ports. */
+static int order_stacks_used;
+static struct rwlock_t order_lock;
+static char order[4];
+static volatile int order_length;
+
+static void *order_writer_main(void *arg_p)
+{
+    rwlock_writer_take(&order_lock);
+    order[order_length++] = *(char *)arg_p;
+    rwlock_writer_give(&order_lock);
+
+    return (NULL);
+}
+
+static void *order_reader_main(void *arg_p)
+{
+    rwlock_reader_take(&order_lock);
+    order[order_length++] = *(char *)arg_p;
+    rwlock_reader_give(&order_lock);
+
+    return (NULL);
+}
+
 static void *writer_main(void *arg_p)
 {
     int i;
@@ -137,11 +164,165 @@ static int test_multi_thread(void)
     return (0);
 }
 
+/**
+ * Spawn given order threads, one at a time, letting each block on the
+ * lock held by the main thread. Then give the lock and wait for all
+ * threads to take it.
+ */
+static struct thrd_t *spawn_order_thread(void *(*main)(void *),
+                                        char *name_p,
+                                        int prio)
+{
+    return (thrd_spawn(main,
+                       name_p,
+                       prio,
+                       order_stacks[order_stacks_used++],
+                       sizeof(order_stacks[0])));
+}
+
+static int spawn_order_threads(void *(*mains[])(void *),
+                               char *names_p,
+                               int *prios_p,
+                               int length,
+                               int writer)
+{
+    struct thrd_t *thrds[3];
+    int i;
+
+    order_length = 0;
+
+    for (i = 0; i < length; i++) {
+        thrds[i] = spawn_order_thread(mains[i], &names_p[i], prios_p[i]);
+        BTASSERT(thrds[i] != NULL);
+        thrd_sleep_ms(10);
+    }
+
+    BTASSERT(order_length == 0);
+
+    if (writer == 1) {
+        BTASSERT(rwlock_writer_give(&order_lock) == 0);
+    } else {
+        BTASSERT(rwlock_reader_give(&order_lock) == 0);
+    }
+
+    for (i = 0; i < length; i++) {
+        BTASSERT(thrd_join(thrds[i]) == 0);
+    }
+
+    BTASSERT(order_length == length);
+
+    return (0);
+}
+
+static int test_writer_preference(void)
+{
+    void *(*mains[])(void *) = { order_writer_main, order_reader_main };
+    int prios[] = { 10, 10 };
+
+    /* A reader arriving after a waiting writer waits for the
+       writer. */
+    BTASSERT(rwlock_init(&order_lock) == 0);
+    BTASSERT(rwlock_reader_take(&order_lock) == 0);
+    BTASSERT(spawn_order_threads(mains, "wr", prios, 2, 0) == 0);
+    BTASSERT(memcmp(&order[0], "wr", 2) == 0);
+
+    return (0);
+}
+
+static int test_reader_preference(void)
+{
+    void *(*mains[])(void *) = { order_writer_main, order_reader_main };
+    int prios[] = { 10, 10 };
+    struct thrd_t *thrd_p;
+
+    BTASSERT(rwlock_init(&order_lock) == 0);
+    BTASSERT(rwlock_set_policy(&order_lock, 3) == -EINVAL);
+    BTASSERT(rwlock_set_policy(&order_lock,
+                               RWLOCK_POLICY_READER_PREFERENCE) == 0);
+
+    /* The reader takes the lock even if a writer is waiting. */
+    BTASSERT(rwlock_reader_take(&order_lock) == 0);
+    order_length = 0;
+    thrd_p = spawn_order_thread(order_writer_main, "w", 10);
+    BTASSERT(thrd_p != NULL);
+    thrd_sleep_ms(10);
+    BTASSERT(rwlock_reader_take(&order_lock) == 0);
+    BTASSERT(rwlock_reader_give(&order_lock) == 0);
+    BTASSERT(order_length == 0);
+    BTASSERT(rwlock_reader_give(&order_lock) == 0);
+    BTASSERT(thrd_join(thrd_p) == 0);
+    BTASSERT(order_length == 1);
+
+    /* Waiting readers are woken before waiting writers. */
+    BTASSERT(rwlock_writer_take(&order_lock) == 0);
+    BTASSERT(spawn_order_threads(mains, "wr", prios, 2, 1) == 0);
+    BTASSERT(memcmp(&order[0], "rw", 2) == 0);
+
+    return (0);
+}
+
+static int test_prio(void)
+{
+    void *(*writers[])(void *) = {
+        order_writer_main, order_writer_main, order_writer_main
+    };
+    void *(*mixed[])(void *) = {
+        order_writer_main, order_reader_main, order_reader_main
+    };
+    int prios[] = { 12, 10, 11 };
+    int mixed_prios[] = { 11, 10, 12 };
+
+    /* Writers are woken in priority order. */
+    BTASSERT(rwlock_init(&order_lock) == 0);
+    BTASSERT(rwlock_writer_take(&order_lock) == 0);
+    BTASSERT(spawn_order_threads(writers, "abc", prios, 3, 1) == 0);
+    BTASSERT(memcmp(&order[0], "bca", 3) == 0);
+
+    /* Readers with higher priority than the highest priority waiting
+       writer go first, lower priority readers after the writer. */
+    BTASSERT(rwlock_set_policy(&order_lock, RWLOCK_POLICY_PRIO) == 0);
+    BTASSERT(rwlock_writer_take(&order_lock) == 0);
+    BTASSERT(spawn_order_threads(mixed, "wrs", mixed_prios, 3, 1) == 0);
+    BTASSERT(memcmp(&order[0], "rws", 3) == 0);
+
+    return (0);
+}
+
+static int test_optimistic_read(void)
+{
+    struct rwlock_t foo;
+    uint32_t sequence;
+
+    BTASSERT(rwlock_init(&foo) == 0);
+
+    /* No writer. */
+    sequence = rwlock_optimistic_read_begin(&foo);
+    BTASSERT(rwlock_optimistic_read_retry(&foo, sequence) == 0);
+
+    /* A writer took the lock during the read. */
+    sequence = rwlock_optimistic_read_begin(&foo);
+    BTASSERT(rwlock_writer_take(&foo) == 0);
+    BTASSERT(rwlock_writer_give(&foo) == 0);
+    BTASSERT(rwlock_optimistic_read_retry(&foo, sequence) == 1);
+
+    /* Readers do not affect optimistic reads. */
+    sequence = rwlock_optimistic_read_begin(&foo);
+    BTASSERT(rwlock_reader_take(&foo) == 0);
+    BTASSERT(rwlock_reader_give(&foo) == 0);
+    BTASSERT(rwlock_optimistic_read_retry(&foo, sequence) == 0);
+
+    return (0);
+}
+
 int main()
 {
     struct harness_testcase_t testcases[] = {
         { test_one_thread, "test_one_thread" },
         { test_multi_thread, "test_multi_thread" },
+        { test_writer_preference, "test_writer_preference" },
+        { test_reader_preference, "test_reader_preference" },
+        { test_prio, "test_prio" },
+        { test_optimistic_read, "test_optimistic_read" },
         { NULL, NULL }
     };
 
@@ -0,0 +1,238 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2014-2018, Erik Moqvist
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use, copy,
+ * modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ * This file is part of the Simba project.
+ */
+
+#include "simba.h"
+
+#define STRESS_SIZE                                      4096
+
+static THRD_STACK(writer_stacks[3], 1024);
+
+static struct spsc_queue_t queue;
+static char buf[8];
+
+static void *chunk_writer_main(void *arg_p)
+{
+    char data[4];
+    int i;
+    int j;
+
+    /* Write 0..31 in chunks of four bytes. */
+    for (i = 0; i < 8; i++) {
+        for (j = 0; j < 4; j++) {
+            data[j] = (4 * i + j);
+        }
+
+        while (spsc_queue_unused_size(&queue) < 4) {
+            thrd_sleep_ms(1);
+        }
+
+        BTASSERTN(spsc_queue_write(&queue, &data[0], 4) == 4);
+        thrd_sleep_ms(1);
+    }
+
+    return (NULL);
+}
+
+static void *isr_writer_main(void *arg_p)
+{
+    char value;
+
+    thrd_sleep_ms(10);
+
+    value = 5;
+    sys_lock();
+    BTASSERTN(spsc_queue_write_isr(&queue, &value, 1) == 1);
+    sys_unlock();
+
+    return (NULL);
+}
+
+static void *stress_writer_main(void *arg_p)
+{
+    size_t i;
+    size_t n;
+    char data[3];
+
+    i = 0;
+
+    while (i < STRESS_SIZE) {
+        data[0] = i;
+        data[1] = (i + 1);
+        data[2] = (i + 2);
+        n = spsc_queue_write(&queue, &data[0], MIN(3, STRESS_SIZE - i));
+
+        if (n == 0) {
+            thrd_yield();
+        }
+
+        i += n;
+    }
+
+    return (NULL);
+}
+
+static int test_init(void)
+{
+    BTASSERT(spsc_queue_init(&queue, &buf[0], sizeof(buf)) == 0);
+    BTASSERTI(spsc_queue_size(&queue), ==, 0);
+    BTASSERTI(spsc_queue_unused_size(&queue), ==, 8);
+
+    return (0);
+}
+
+static int test_write_read(void)
+{
+    char data[10];
+    int i;
+    int round;
+
+    BTASSERT(spsc_queue_init(&queue, &buf[0], sizeof(buf)) == 0);
+
+    /* Wrap around the buffer a few times. */
+    for (round = 0; round < 5; round++) {
+        for (i = 0; i < 5; i++) {
+            data[i] = (10 * round + i);
+        }
+
+        BTASSERTI(spsc_queue_write(&queue, &data[0], 5), ==, 5);
+        BTASSERTI(spsc_queue_size(&queue), ==, 5);
+        BTASSERTI(spsc_queue_unused_size(&queue), ==, 3);
+        memset(&data[0], 0, sizeof(data));
+        BTASSERTI(chan_read(&queue, &data[0], 5), ==, 5);
+        BTASSERTI(spsc_queue_size(&queue), ==, 0);
+
+        for (i = 0; i < 5; i++) {
+            BTASSERTI(data[i], ==, 10 * round + i);
+        }
+    }
+
+    /* Write more than fits. */
+    BTASSERTI(spsc_queue_write(&queue, &data[0], 10), ==, 8);
+    BTASSERTI(spsc_queue_write(&queue, &data[0], 1), ==, 0);
+    BTASSERTI(spsc_queue_unused_size(&queue), ==, 0);
+    BTASSERTI(chan_read(&queue, &data[0], 8), ==, 8);
+
+    return (0);
+}
+
+static int test_blocking_read(void)
+{
+    struct thrd_t *thrd_p;
+    char data[32];
+    int i;
+
+    BTASSERT(spsc_queue_init(&queue, &buf[0], sizeof(buf)) == 0);
+
+    thrd_p = thrd_spawn(chunk_writer_main,
+                        NULL,
+                        1,
+                        writer_stacks[0],
+                        sizeof(writer_stacks[0]));
+    BTASSERT(thrd_p != NULL);
+
+    /* Read more than the buffer size. */
+    BTASSERTI(chan_read(&queue, &data[0], sizeof(data)), ==, sizeof(data));
+    BTASSERT(thrd_join(thrd_p) == 0);
+
+    for (i = 0; i < sizeof(data); i++) {
+        BTASSERTI(data[i], ==, i);
+    }
+
+    return (0);
+}
+
+static int test_poll(void)
+{
+    struct thrd_t *thrd_p;
+    struct time_t timeout;
+    char value;
+
+    BTASSERT(spsc_queue_init(&queue, &buf[0], sizeof(buf)) == 0);
+
+    timeout.seconds = 0;
+    timeout.nanoseconds = 10000000;
+    BTASSERT(chan_poll(&queue, &timeout) == NULL);
+
+    thrd_p = thrd_spawn(isr_writer_main,
+                        NULL,
+                        1,
+                        writer_stacks[1],
+                        sizeof(writer_stacks[1]));
+    BTASSERT(thrd_p != NULL);
+
+    BTASSERT(chan_poll(&queue, NULL) == &queue);
+    BTASSERTI(chan_read(&queue, &value, 1), ==, 1);
+    BTASSERTI(value, ==, 5);
+    BTASSERT(thrd_join(thrd_p) == 0);
+
+    return (0);
+}
+
+static int test_stress(void)
+{
+    struct thrd_t *thrd_p;
+    size_t i;
+    char value;
+
+    BTASSERT(spsc_queue_init(&queue, &buf[0], sizeof(buf)) == 0);
+
+    thrd_p = thrd_spawn(stress_writer_main,
+                        NULL,
+                        1,
+                        writer_stacks[2],
+                        sizeof(writer_stacks[2]));
+    BTASSERT(thrd_p != NULL);
+
+    for (i = 0; i < STRESS_SIZE; i++) {
+        BTASSERTI(chan_read(&queue, &value, 1), ==, 1);
+        BTASSERTI((uint8_t)value, ==, (uint8_t)i);
+    }
+
+    BTASSERT(thrd_join(thrd_p) == 0);
+    BTASSERTI(spsc_queue_size(&queue), ==, 0);
+
+    return (0);
+}
+
+int main()
+{
+    struct harness_testcase_t testcases[] = {
+        { test_init, "test_init" },
+        { test_write_read, "test_write_read" },
+        { test_blocking_read, "test_blocking_read" },
+        { test_poll, "test_poll" },
+        { test_stress, "test_stress" },
+        { NULL, NULL }
+    };
+
+    sys_start();
+
+    harness_run(testcases);
+
+    return (0);
+}
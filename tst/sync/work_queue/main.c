@@ -0,0 +1,198 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2014-2018, Erik Moqvist
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use, copy,
+ * modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ * This file is part of the Simba project.
+ */
+
+#include "simba.h"
+
+#if defined(ARCH_ESP32) || defined(ARCH_PPC)
+static THRD_STACK(stacks[2], 512);
+static THRD_STACK(single_stack, 512);
+#elif defined(ARCH_ARM64)
+static THRD_STACK(stacks[2], 1024);
+static THRD_STACK(single_stack, 1024);
+#else
+static THRD_STACK(stacks[2], 256);
+static THRD_STACK(single_stack, 256);
+#endif
+
+static struct work_queue_t queue;
+static struct work_queue_t single_queue;
+
+static int order[8];
+static int order_length;
+
+static void work_main(void *arg_p)
+{
+    order[order_length++] = (int)(uintptr_t)arg_p;
+}
+
+static int test_init(void)
+{
+    BTASSERT(work_queue_init(&queue,
+                             10,
+                             &stacks[0],
+                             sizeof(stacks[0]),
+                             membersof(stacks)) == 0);
+    BTASSERT(work_queue_init(&single_queue,
+                             10,
+                             &single_stack[0],
+                             sizeof(single_stack),
+                             1) == 0);
+
+    return (0);
+}
+
+static int test_submit(void)
+{
+    int i;
+    struct work_t works[4];
+
+    order_length = 0;
+
+    for (i = 0; i < membersof(works); i++) {
+        BTASSERT(work_init(&works[i], work_main, (void *)(uintptr_t)i) == 0);
+        BTASSERT(work_queue_submit(&single_queue, &works[i]) == 0);
+    }
+
+    /* A pending work item can not be submitted again. */
+    BTASSERT(work_queue_submit(&single_queue, &works[0]) == -EBUSY);
+
+    /* Let the worker run. Work items are executed in submission
+       order. */
+    BTASSERT(order_length == 0);
+    thrd_sleep_ms(10);
+    BTASSERTI(order_length, ==, 4);
+
+    for (i = 0; i < membersof(works); i++) {
+        BTASSERTI(order[i], ==, i);
+    }
+
+    /* Executed work items can be submitted again. */
+    BTASSERT(work_queue_submit(&queue, &works[0]) == 0);
+    BTASSERT(work_queue_submit(&queue, &works[1]) == 0);
+    thrd_sleep_ms(10);
+    BTASSERTI(order_length, ==, 6);
+
+    return (0);
+}
+
+static int test_submit_isr(void)
+{
+    struct work_t work;
+
+    order_length = 0;
+
+    BTASSERT(work_init(&work, work_main, (void *)7) == 0);
+
+    sys_lock();
+    BTASSERT(work_queue_submit_isr(&queue, &work) == 0);
+    BTASSERT(work_queue_submit_isr(&queue, &work) == -EBUSY);
+    sys_unlock();
+
+    thrd_sleep_ms(10);
+    BTASSERTI(order_length, ==, 1);
+    BTASSERTI(order[0], ==, 7);
+
+    return (0);
+}
+
+static int test_delayed(void)
+{
+    struct work_t work;
+    struct time_t delay;
+
+    order_length = 0;
+    delay.seconds = 0;
+    delay.nanoseconds = 50000000;
+
+    BTASSERT(work_init(&work, work_main, (void *)3) == 0);
+    BTASSERT(work_queue_submit_delayed(&queue, &work, &delay) == 0);
+    BTASSERT(work_queue_submit_delayed(&queue, &work, &delay) == -EBUSY);
+    BTASSERT(work_queue_submit(&queue, &work) == -EBUSY);
+
+    thrd_sleep_ms(10);
+    BTASSERTI(order_length, ==, 0);
+    thrd_sleep_ms(100);
+    BTASSERTI(order_length, ==, 1);
+    BTASSERTI(order[0], ==, 3);
+
+    return (0);
+}
+
+static int test_cancel(void)
+{
+    struct work_t works[2];
+    struct time_t delay;
+
+    order_length = 0;
+    delay.seconds = 0;
+    delay.nanoseconds = 20000000;
+
+    BTASSERT(work_init(&works[0], work_main, (void *)0) == 0);
+    BTASSERT(work_init(&works[1], work_main, (void *)1) == 0);
+
+    /* Not submitted. */
+    BTASSERT(work_cancel(&works[0]) == -ENOENT);
+
+    /* Cancel a pending and a delayed work item. */
+    BTASSERT(work_queue_submit(&single_queue, &works[0]) == 0);
+    BTASSERT(work_queue_submit_delayed(&single_queue,
+                                       &works[1],
+                                       &delay) == 0);
+    BTASSERT(work_cancel(&works[0]) == 0);
+    BTASSERT(work_cancel(&works[1]) == 0);
+    BTASSERT(work_cancel(&works[1]) == -ENOENT);
+
+    thrd_sleep_ms(50);
+    BTASSERTI(order_length, ==, 0);
+
+    /* A cancelled work item can be submitted again. */
+    BTASSERT(work_queue_submit(&single_queue, &works[1]) == 0);
+    thrd_sleep_ms(10);
+    BTASSERTI(order_length, ==, 1);
+    BTASSERTI(order[0], ==, 1);
+
+    return (0);
+}
+
+int main()
+{
+    struct harness_testcase_t testcases[] = {
+        { test_init, "test_init" },
+        { test_submit, "test_submit" },
+        { test_submit_isr, "test_submit_isr" },
+        { test_delayed, "test_delayed" },
+        { test_cancel, "test_cancel" },
+        { NULL, NULL }
+    };
+
+    sys_start();
+
+    harness_run(testcases);
+
+    return (0);
+}
@@ -464,6 +464,205 @@ static int test_get_complex(void)
     return (0);
 }
 
+static int test_index(void)
+{
+    struct configfile_t configfile;
+    struct configfile_index_entry_t entries[8];
+    char buf[] =
+        "ignored = outside of any section\n"
+        "[shopping list]\r\n"
+        "milkshake: 1\r\n"
+        "milk: 3\r\n"
+        "\tham: 2\r\n"
+        "#cheese: 1 cheddar\r\n"
+        "[clothes\r\n"
+        "skirt = 1\n"
+        "[shopping list]\n"
+        "cheese = 2 brie\n"
+        "milk = 4\n"
+        "malformed ; 1\n"
+        "eggs = 12";
+    char value[16];
+    long long_value;
+
+    BTASSERT(configfile_init(&configfile, buf, sizeof(buf)) == 0);
+
+    /* Too small index. */
+    BTASSERT(configfile_index(&configfile, &entries[0], 5) == -ENOMEM);
+
+    BTASSERT(configfile_index(&configfile,
+                              &entries[0],
+                              membersof(entries)) == 7);
+
+    /* Not mixed up with 'milkshake', and the first 'milk' wins. */
+    BTASSERT(configfile_get(&configfile,
+                            "shopping list",
+                            "milk",
+                            &value[0],
+                            sizeof(value)) == &value[0]);
+    BTASSERT(strcmp(&value[0], "3") == 0);
+
+    BTASSERT(configfile_get_long(&configfile,
+                                 "shopping list",
+                                 "milkshake",
+                                 &long_value) == 0);
+    BTASSERT(long_value == 1);
+
+    /* The section name ends at the line termination. */
+    BTASSERT(configfile_get(&configfile,
+                            "clothes",
+                            "skirt",
+                            &value[0],
+                            sizeof(value)) == &value[0]);
+    BTASSERT(strcmp(&value[0], "1") == 0);
+
+    /* In the second 'shopping list' section. */
+    BTASSERT(configfile_get(&configfile,
+                            "shopping list",
+                            "cheese",
+                            &value[0],
+                            sizeof(value)) == &value[0]);
+    BTASSERT(strcmp(&value[0], "2 brie") == 0);
+
+    /* Leading whitespace, comment, wrong section, bad format, bad
+       line termination and missing. */
+    BTASSERT(configfile_get(&configfile,
+                            "shopping list",
+                            "ham",
+                            &value[0],
+                            sizeof(value)) == NULL);
+    BTASSERT(configfile_get(&configfile,
+                            "shopping list",
+                            "#cheese",
+                            &value[0],
+                            sizeof(value)) == NULL);
+    BTASSERT(configfile_get(&configfile,
+                            "clothes",
+                            "milk",
+                            &value[0],
+                            sizeof(value)) == NULL);
+    BTASSERT(configfile_get(&configfile,
+                            "shopping list",
+                            "malformed",
+                            &value[0],
+                            sizeof(value)) == NULL);
+    BTASSERT(configfile_get(&configfile,
+                            "shopping list",
+                            "eggs",
+                            &value[0],
+                            sizeof(value)) == NULL);
+    BTASSERT(configfile_get(&configfile,
+                            "",
+                            "ignored",
+                            &value[0],
+                            sizeof(value)) == NULL);
+    BTASSERT(configfile_get(&configfile,
+                            "shopping list",
+                            "mil",
+                            &value[0],
+                            sizeof(value)) == NULL);
+
+    /* Value too long. */
+    BTASSERT(configfile_get(&configfile,
+                            "shopping list",
+                            "cheese",
+                            &value[0],
+                            3) == NULL);
+
+    return (0);
+}
+
+static int test_index_file(void)
+{
+    static const char config[] =
+        "; last modified 1 April 2001 by John Doe\n"
+        "[owner]\n"
+        "name = John Doe\n"
+        "organization = Acme Widgets Inc.\n"
+        "\n"
+        "[database]\n"
+        "; use IP address in case network name resolution is not working\n"
+        "server = 192.0.2.62\n"
+        "port = 143\n"
+        "file = \"payroll.dat\"\n";
+    static const struct romfs_file_t files[] = {
+        { "config.ini", &config[0], sizeof(config) - 1 },
+        { NULL, NULL, 0 }
+    };
+    static struct romfs_t romfs;
+    static struct fs_filesystem_t filesystem;
+    struct fs_file_t file;
+    struct configfile_t configfile;
+    struct configfile_index_entry_t entries[5];
+    char value[32];
+    long long_value;
+
+    BTASSERT(romfs_init(&romfs, &files[0]) == 0);
+    BTASSERT(fs_filesystem_init_generic(&filesystem,
+                                        "/rom",
+                                        &romfs.ops) == 0);
+    BTASSERT(fs_filesystem_register(&filesystem) == 0);
+    BTASSERT(fs_open(&file, "/rom/config.ini", FS_READ) == 0);
+
+    BTASSERT(configfile_init_file(&configfile, &file) == 0);
+
+    /* The file can only be read using the index. */
+    BTASSERT(configfile_get(&configfile,
+                            "owner",
+                            "name",
+                            &value[0],
+                            sizeof(value)) == NULL);
+
+    BTASSERT(configfile_index(&configfile,
+                              &entries[0],
+                              membersof(entries)) == 5);
+
+    /* Read in the reverse order to seek backwards. */
+    BTASSERT(configfile_get(&configfile,
+                            "database",
+                            "file",
+                            &value[0],
+                            sizeof(value)) == &value[0]);
+    BTASSERT(strcmp(&value[0], "\"payroll.dat\"") == 0);
+
+    BTASSERT(configfile_get_long(&configfile,
+                                 "database",
+                                 "port",
+                                 &long_value) == 0);
+    BTASSERT(long_value == 143);
+
+    BTASSERT(configfile_get(&configfile,
+                            "database",
+                            "server",
+                            &value[0],
+                            sizeof(value)) == &value[0]);
+    BTASSERT(strcmp(&value[0], "192.0.2.62") == 0);
+
+    BTASSERT(configfile_get(&configfile,
+                            "owner",
+                            "organization",
+                            &value[0],
+                            sizeof(value)) == &value[0]);
+    BTASSERT(strcmp(&value[0], "Acme Widgets Inc.") == 0);
+
+    BTASSERT(configfile_get(&configfile,
+                            "owner",
+                            "name",
+                            &value[0],
+                            sizeof(value)) == &value[0]);
+    BTASSERT(strcmp(&value[0], "John Doe") == 0);
+
+    BTASSERT(configfile_get(&configfile,
+                            "owner",
+                            "port",
+                            &value[0],
+                            sizeof(value)) == NULL);
+
+    BTASSERT(fs_close(&file) == 0);
+
+    return (0);
+}
+
 int main()
 {
     struct harness_testcase_t testcases[] = {
@@ -480,6 +679,8 @@ int main()
         { test_get_value_too_long, "test_get_value_too_long" },
         { test_get_complex, "test_get_complex" },
         { test_set, "test_set" },
+        { test_index, "test_index" },
+        { test_index_file, "test_index_file" },
         { NULL, NULL }
     };
 
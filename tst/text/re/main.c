@@ -28,6 +28,18 @@
 
 #include "simba.h"
 
+extern FAR const struct re_dfa_t re_dfa_foo;
+extern FAR const struct re_dfa_t re_dfa_dot;
+extern FAR const struct re_dfa_t re_dfa_dotall;
+extern FAR const struct re_dfa_t re_dfa_repetitions;
+extern FAR const struct re_dfa_t re_dfa_non_greedy;
+extern FAR const struct re_dfa_t re_dfa_one_or_more_non_greedy;
+extern FAR const struct re_dfa_t re_dfa_zero_or_one_non_greedy;
+extern FAR const struct re_dfa_t re_dfa_set;
+extern FAR const struct re_dfa_t re_dfa_set_ignorecase;
+extern FAR const struct re_dfa_t re_dfa_members;
+extern FAR const struct re_dfa_t re_dfa_nested;
+
 int test_init(void)
 {
     BTASSERT(re_module_init() == 0);
@@ -355,6 +367,85 @@ int test_complex(void)
     return (0);
 }
 
+int test_dfa(void)
+{
+    char re[64];
+    int i, j;
+    const char *input_p;
+    struct {
+        FAR const struct re_dfa_t *dfa_p;
+        const char *pattern_p;
+        char flags;
+        const char *inputs[6];
+    } datas[] = {
+        {
+            &re_dfa_foo, "foo", RE_IGNORECASE,
+            { "foo", "FoO", "fo", "foobar", "BAR", NULL }
+        },
+        {
+            &re_dfa_dot, "a.b.c", 0,
+            { "a\nb\nc", "a b c", "aXbYcZ", "a b", NULL }
+        },
+        {
+            &re_dfa_dotall, "a.b.c", RE_DOTALL,
+            { "a\nb\nc", "a b c", "a\nb", NULL }
+        },
+        {
+            &re_dfa_repetitions, "<.*<b{1}.\?\?.?c>*", 0,
+            { "<a><b><c>>", "<<bc", "<<b", "<<bxc>>>", "<<b<c", NULL }
+        },
+        {
+            &re_dfa_non_greedy, "<.*?>", 0,
+            { "<p>foo</p>", "<>>", "<", "", NULL }
+        },
+        {
+            &re_dfa_one_or_more_non_greedy, "<.+?>", 0,
+            { "<p>foo</p>", "<>>", "<>", "<\n>", NULL }
+        },
+        {
+            &re_dfa_zero_or_one_non_greedy, "<.\?\?>", 0,
+            { "<p>foo</p>", "<>>", "<", "<ab>", NULL }
+        },
+        {
+            &re_dfa_set, "[a-zA-Z0-9_]+\\s*[]\\-]?", 0,
+            { "foo_1 \t]", "foo-", "Bar", " foo", "a  ]]", NULL }
+        },
+        {
+            &re_dfa_set_ignorecase, "[a-c\\d]+", RE_IGNORECASE,
+            { "aBc1d", "CAB", "d", "0xff", NULL }
+        },
+        {
+            &re_dfa_members, "\\w{2}\\d+", 0,
+            { "ab123c", "a1", "a_9", "__", "ab", NULL }
+        }
+    };
+
+    /* The result must be the same as for the interpreter. */
+    for (i = 0; i < membersof(datas); i++) {
+        BTASSERT(re_compile(re,
+                            datas[i].pattern_p,
+                            datas[i].flags,
+                            sizeof(re)) != NULL);
+
+        for (j = 0; datas[i].inputs[j] != NULL; j++) {
+            input_p = datas[i].inputs[j];
+            std_printf(OSTR("%s: '%s'\r\n"), datas[i].pattern_p, input_p);
+            BTASSERTI(re_dfa_match(datas[i].dfa_p, input_p, strlen(input_p)),
+                      ==,
+                      re_match(re, input_p, strlen(input_p), NULL, NULL));
+        }
+    }
+
+    /* Linear time for a pattern the interpreter spends exponential
+       time on. */
+    input_p = "aaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaa";
+    BTASSERTI(re_dfa_match(&re_dfa_nested, input_p, strlen(input_p)), ==, -1);
+    BTASSERTI(re_dfa_match(&re_dfa_nested, "aaab", 4), ==, 4);
+    BTASSERTI(re_dfa_match(&re_dfa_nested, "b", 1), ==, 1);
+
+    return (0);
+}
+
 int test_compile(void)
 {
     char re[64];
@@ -392,6 +483,7 @@ int main()
         { test_alternatives, "test_alternatives" },
         { test_greed, "test_greed" },
         { test_complex, "test_complex" },
+        { test_dfa, "test_dfa" },
         { test_compile, "test_compile" },
         { NULL, NULL }
     };
@@ -184,7 +184,7 @@ static int test_vfprintf(void)
     return (0);
 }
 
-#if CONFIG_FLOAT == 1
+#if CONFIG_STD_PRINTF_FLOAT == 1
 
 static int test_sprintf_double(void)
 {
@@ -287,6 +287,34 @@ static int test_sprintf_unsigned(void)
     return (0);
 }
 
+static int test_sprintf_long_long(void)
+{
+#if CONFIG_STD_PRINTF_LONG_LONG == 1
+    char buf[48];
+    ssize_t size;
+
+    size = std_sprintf(&buf[0], FSTR("%llu"), 18446744073709551615ULL);
+    BTASSERTI(size, ==, 20);
+    BTASSERTM(&buf[0], "18446744073709551615", size + 1);
+
+    size = std_sprintf(&buf[0], FSTR("%lld"), -9223372036854775807LL - 1);
+    BTASSERTI(size, ==, 20);
+    BTASSERTM(&buf[0], "-9223372036854775808", size + 1);
+
+    size = std_sprintf(&buf[0], FSTR("%llx"), 0x123456789abcdef0ULL);
+    BTASSERTI(size, ==, 16);
+    BTASSERTM(&buf[0], "123456789abcdef0", size + 1);
+
+    size = std_sprintf(&buf[0], FSTR("%05llu %llu %lu"), 12ULL, 0ULL, 7UL);
+    BTASSERTI(size, ==, 9);
+    BTASSERTM(&buf[0], "00012 0 7", size + 1);
+
+    return (0);
+#else
+    return (1);
+#endif
+}
+
 static int test_sprintf_far_string(void)
 {
     char buf[8];
@@ -606,9 +634,15 @@ static int test_strtod(void)
     BTASSERT(strtod_test("0.09e02", 7, 9.0, 9.0) == 0);
     /* http://thread.gmane.org/gmane.editors.vim.devel/19268/ */
     BTASSERT(strtod_test("0.9999999999999999999999999999999999", 36, 1.0, 1.0) == 0);
-    BTASSERT(strtod_test("2.2250738585072010e-308", 23, .0, .0) == 0); // BUG
+    BTASSERT(strtod_test("2.2250738585072010e-308",
+                         23,
+                         2.2250738585072010e-308,
+                         2.2250738585072010e-308) == 0);
     /* PHP (slashdot.jp): http://opensource.slashdot.jp/story/11/01/08/0527259/PHP%E3%81%AE%E6%B5%AE%E5%8B%95%E5%B0%8F%E6%95%B0%E7%82%B9%E5%87%A6%E7%90%86%E3%81%AB%E7%84%A1%E9%99%90%E3%83%AB%E3%83%BC%E3%83%97%E3%81%AE%E3%83%90%E3%82%B0 */
-    BTASSERT(strtod_test("2.2250738585072011e-308", 23, .0, .0) == 0);
+    BTASSERT(strtod_test("2.2250738585072011e-308",
+                         23,
+                         2.2250738585072011e-308,
+                         2.2250738585072011e-308) == 0);
     /* Gauche: http://blog.practical-scheme.net/gauche/20110203-bitten-by-floating-point-numbers-again */
     BTASSERT(strtod_test("2.2250738585072012e-308",
                          23,
@@ -622,6 +656,24 @@ static int test_strtod(void)
                          23,
                          2.2250738585072014e-308l,
                          2.2250738585072014e-308l) == 0);
+
+    /* Correct rounding, compared to the C library. */
+    const char *strings[] = {
+        "0.1", "3.14159", "4.35", "-0.0", "1e22", "1e23", "123.456e-10",
+        "9007199254740993", "123456789012345678", "0.000001",
+        "1.7976931348623157e308", "5e-324", "1e400", "1e-400",
+        "299792458", "-273.15", "6.02214076e23", "1.00000000000000011"
+    };
+    const char *end_p;
+    double value;
+    int i;
+
+    for (i = 0; i < membersof(strings); i++) {
+        std_printf(FSTR("%s\r\n"), strings[i]);
+        end_p = std_strtod(strings[i], &value);
+        BTASSERT(end_p == &strings[i][strlen(strings[i])]);
+        BTASSERT(value == strtod(strings[i], NULL));
+    }
 #endif
 
     return (0);
@@ -678,6 +730,18 @@ static int test_strtodfp(void)
     const char value_12[] = "x.123";
     BTASSERT(std_strtodfp(&value_12[0], &value, 6) == NULL);
 
+    const char value_13[] = "-1.5";
+    BTASSERT(std_strtodfp(&value_13[0], &value, 2) == &value_13[4]);
+    BTASSERTI(value, ==, -150);
+
+    const char value_14[] = "-0.25x";
+    BTASSERT(std_strtodfp(&value_14[0], &value, 3) == &value_14[5]);
+    BTASSERTI(value, ==, -250);
+
+    const char value_15[] = "0.000000000000000000001234";
+    BTASSERT(std_strtodfp(&value_15[0], &value, 6) == &value_15[8]);
+    BTASSERTI(value, ==, 0);
+
     return (0);
 }
 
@@ -704,6 +768,91 @@ static int test_hexdump(void)
     return (0);
 }
 
+static int test_sprintf_digits(void)
+{
+    char buf[128];
+    ssize_t size;
+
+    /* Odd and even number of digits, and pair boundaries. */
+    size = std_sprintf(&buf[0],
+                       FSTR("%u %u %u %u %u %u %lu %ld %x %lx"),
+                       0, 9, 10, 99, 100, 65535, 1234567890UL,
+                       -2147483647L - 1, 0xabcd, 0x1234cdefUL);
+    BTASSERTI(size, ==, 56);
+    BTASSERTM(&buf[0],
+              "0 9 10 99 100 65535 1234567890 -2147483648 abcd 1234cdef",
+              size + 1);
+
+    /* Text longer than the output buffer. */
+    size = std_fprintf(chan_null(),
+                       FSTR("0123456789012345678901234567890123456789"
+                            "0123456789012345678901234567890123456789"
+                            "%08d"),
+                       -12);
+    BTASSERTI(size, ==, 88);
+
+    return (0);
+}
+
+static int test_printf_benchmark(void)
+{
+    char buf[96];
+    struct time_t start;
+    struct time_t stop;
+    int i;
+    unsigned long us;
+
+    time_get(&start);
+
+    for (i = 0; i < 10000; i++) {
+        std_snprintf(&buf[0],
+                     sizeof(buf),
+                     FSTR("%lu:info:%s: value %d, counter %lu, "
+                          "flags 0x%08lx, name '%-8s'\r\n"),
+                     (unsigned long)i,
+                     "benchmark",
+                     -i,
+                     12345678UL,
+                     0xdeadbeefUL,
+                     "foo");
+    }
+
+    time_get(&stop);
+    time_subtract(&stop, &stop, &start);
+    us = (stop.seconds * 1000000 + stop.nanoseconds / 1000);
+
+    std_printf(FSTR("10000 std_snprintf() took %lu us.\r\n"), us);
+    BTASSERTM(&buf[0],
+              "9999:info:benchmark: value -9999, counter 12345678, "
+              "flags 0xdeadbeef, name 'foo     '\r\n",
+              strlen(&buf[0]) + 1);
+
+    time_get(&start);
+
+    for (i = 0; i < 10000; i++) {
+        std_fprintf(chan_null(),
+                    FSTR("%lu:info:%s: value %d, counter %lu, "
+                         "flags 0x%08lx, name '%-8s'\r\n"),
+                    (unsigned long)i,
+                    "benchmark",
+                    -i,
+                    12345678UL,
+                    0xdeadbeefUL,
+                    "foo");
+    }
+
+    time_get(&stop);
+    time_subtract(&stop, &stop, &start);
+    us = (stop.seconds * 1000000 + stop.nanoseconds / 1000);
+
+    std_printf(FSTR("10000 std_fprintf() took %lu us with a %d bytes "
+                    "output buffer.\r\n"),
+               us,
+               CONFIG_STD_OUTPUT_BUFFER_MAX);
+
+    return (0);
+}
+
 static int test_printf_isr(void)
 {
     struct time_t timeout;
@@ -743,12 +892,15 @@ int main()
         { test_strlen, "test_strlen" },
         { test_sprintf_double, "test_sprintf_double" },
         { test_sprintf_unsigned, "test_sprintf_unsigned" },
+        { test_sprintf_long_long, "test_sprintf_long_long" },
         { test_sprintf_far_string, "test_sprintf_far_string" },
         { test_strip, "test_strip" },
         { test_libc, "test_libc" },
         { test_strtod, "test_strtod" },
         { test_strtodfp, "test_strtodfp" },
         { test_hexdump, "test_hexdump" },
+        { test_sprintf_digits, "test_sprintf_digits" },
+        { test_printf_benchmark, "test_printf_benchmark" },
         { test_printf_isr, "test_printf_isr" },
         { NULL, NULL }
     };